@@ -320,6 +320,20 @@ struct m0_addb2_mach {
 	 * @see mach_buffer(), SENSOR_THRESHOLD.
 	 */
 	unsigned                        ma_sensor_skip;
+	/**
+	 * Depth of the first label in the context stack, for which tracing is
+	 * disabled by m0_addb2_filter_opcode_set(), or M0_ADDB2_LABEL_MAX if
+	 * there is no such label.
+	 *
+	 * Nothing is placed in the trace while this label is in the context.
+	 *
+	 * @see mach_muted().
+	 */
+	unsigned                        ma_mute;
+	/**
+	 * Counter of sampled records, see filter_sample().
+	 */
+	uint64_t                        ma_sample;
 	uint64_t                        ma_magix;
 #if DEBUG_OWNERSHIP
 	char                            ma_name[100];
@@ -399,7 +413,11 @@ static void add(struct m0_addb2_mach *mach, uint64_t id, int n,
 		const uint64_t *value);
 static void pack(struct m0_addb2_mach *mach);
 static uint64_t tag(uint8_t code, uint64_t id);
-static void sensor_place(struct m0_addb2_mach *m, struct m0_addb2_sensor *s);
+static void sensor_place(struct m0_addb2_mach *m, struct m0_addb2_sensor *s,
+			 bool muted);
+static bool mach_muted(const struct m0_addb2_mach *m);
+static bool filter_data(struct m0_addb2_mach *m, uint64_t id);
+static bool filter_label(uint64_t id, int n, const uint64_t *value);
 static void record_consume(struct m0_addb2_mach *m,
 			   uint64_t id, int n, const uint64_t *value);
 static bool trace_invariant(const struct m0_addb2_trace *tr);
@@ -425,7 +443,12 @@ void m0_addb2_push(uint64_t id, int n, const uint64_t *value)
 		 * add() might allocate a new trace buffer and mach_buffer()
 		 * will place all stacked labels to the buffer.
 		 */
-		add(m, tag(PUSH | n, id), n, value);
+		if (!mach_muted(m)) {
+			if (filter_label(id, n, value))
+				add(m, tag(PUSH | n, id), n, value);
+			else
+				m->ma_mute = MACH_DEPTH(m);
+		}
 		MACH_DEPTH(m)++;
 		e = mach_top(m);
 		v = e->e_recval;
@@ -444,6 +467,7 @@ void m0_addb2_pop(uint64_t id)
 	if (m != NULL) {
 		struct tentry          *e = mach_top(m);
 		struct m0_addb2_sensor *s;
+		bool                    muted = mach_muted(m);
 
 		M0_PRE(MACH_DEPTH(m) > 0);
 		M0_PRE(!m->ma_stopping);
@@ -452,13 +476,16 @@ void m0_addb2_pop(uint64_t id)
 			       e->e_recval->va_id, id);
 
 		m0_tl_teardown(sensor, &e->e_sensor, s) {
-			sensor_place(m, s);
+			sensor_place(m, s, muted);
 			s->s_ops->so_fini(s);
 		}
 		sensor_tlist_fini(&e->e_sensor);
-		add(m, tag(POP, id), 0, NULL);
+		if (!muted)
+			add(m, tag(POP, id), 0, NULL);
 		/* decrease the depth *after* add(), see m0_addb2_push(). */
 		-- MACH_DEPTH(m);
+		if (m->ma_mute == MACH_DEPTH(m))
+			m->ma_mute = M0_ADDB2_LABEL_MAX;
 		mach_put(m);
 	}
 }
@@ -471,7 +498,8 @@ void m0_addb2_add(uint64_t id, int n, const uint64_t *value)
 		M0_PRE(n <= ARRAY_SIZE(m->ma_label[0].e_value));
 		M0_PRE(!m->ma_stopping);
 
-		add(m, tag(DATA | n, id), n, value);
+		if (!mach_muted(m) && filter_data(m, id))
+			add(m, tag(DATA | n, id), n, value);
 		record_consume(m, id, n, value);
 		mach_put(m);
 	}
@@ -496,7 +524,8 @@ void m0_addb2_sensor_add(struct m0_addb2_sensor *s, uint64_t id, unsigned nr,
 		s->s_nr  = nr;
 		s->s_ops = ops;
 		sensor_tlink_init_at_tail(s, &te->e_sensor);
-		sensor_place(m, s);
+		sensor_place(m, s,
+			     (unsigned)(te - m->ma_label) >= m->ma_mute);
 		mach_put(m);
 	}
 }
@@ -509,7 +538,7 @@ void m0_addb2_sensor_del(struct m0_addb2_sensor *s)
 		M0_PRE(!m->ma_stopping);
 
 		if (sensor_tlink_is_in(s)) {
-			sensor_place(m, s);
+			sensor_place(m, s, mach_muted(m));
 			sensor_tlist_del(s);
 		}
 		sensor_tlink_fini(s);
@@ -529,6 +558,7 @@ m0_addb2_mach_init(const struct m0_addb2_mach_ops *ops, void *cookie)
 		mach->ma_ops = ops;
 		mach->ma_cookie = cookie;
 		mach->ma_packed = m0_time_now();
+		mach->ma_mute = M0_ADDB2_LABEL_MAX;
 		m0_mutex_init(&mach->ma_lock);
 		m0_semaphore_init(&mach->ma_idlewait, 0);
 		buf_tlist_init(&mach->ma_idle);
@@ -785,6 +815,114 @@ void m0_addb2_module_fini(void)
 	m0_free(m0_addb2_module_get());
 }
 
+static struct m0_addb2_filter *filter(void)
+{
+	return &m0_addb2_module_get()->am_filter;
+}
+
+void m0_addb2_filter_level_set(uint64_t lo, uint64_t hi,
+			       enum m0_addb2_level level)
+{
+	struct m0_addb2_filter *f = filter();
+	uint64_t                i;
+
+	M0_PRE(lo <= hi && hi <= M0_AVI_EXTERNAL_RANGE_1);
+	M0_PRE(M0_IN(level, (M0_ADDB2_LEVEL_ALL, M0_ADDB2_LEVEL_SAMPLED,
+			     M0_ADDB2_LEVEL_OFF)));
+
+	for (i = lo / M0_ADDB2_FILTER_GRAIN;
+	     i < hi / M0_ADDB2_FILTER_GRAIN; ++i)
+		f->af_level[i] = level;
+	f->af_active = true;
+}
+
+void m0_addb2_filter_rate_set(uint32_t rate)
+{
+	filter()->af_rate = rate;
+	filter()->af_active = true;
+}
+
+void m0_addb2_filter_phase_rate_set(uint32_t rate)
+{
+	filter()->af_phase_rate = rate;
+	filter()->af_active = true;
+}
+
+void m0_addb2_filter_opcode_set(uint64_t opcode, bool enabled)
+{
+	struct m0_addb2_filter *f = filter();
+
+	M0_PRE(opcode < M0_ADDB2_FILTER_OPCODE_NR);
+
+	if (enabled)
+		f->af_opmute[opcode / 64] &= ~M0_BITS(opcode % 64);
+	else
+		f->af_opmute[opcode / 64] |= M0_BITS(opcode % 64);
+	f->af_active = true;
+}
+
+void m0_addb2_filter_reset(void)
+{
+	M0_SET0(filter());
+}
+
+/**
+ * Implements 1-in-"rate" sampling. The first record is always placed.
+ */
+static bool filter_sample(struct m0_addb2_mach *m, uint32_t rate)
+{
+	return rate <= 1 || m->ma_sample++ % rate == 0;
+}
+
+/**
+ * Returns true iff a data record with the given identifier should be placed in
+ * the trace.
+ */
+static bool filter_data(struct m0_addb2_mach *m, uint64_t id)
+{
+	const struct m0_addb2_filter *f = filter();
+
+	if (!f->af_active)
+		return true;
+	if (id < M0_AVI_EXTERNAL_RANGE_1) {
+		switch (f->af_level[id / M0_ADDB2_FILTER_GRAIN]) {
+		case M0_ADDB2_LEVEL_OFF:
+			return false;
+		case M0_ADDB2_LEVEL_SAMPLED:
+			return filter_sample(m, f->af_rate);
+		default:
+			break;
+		}
+	}
+	if (M0_IN(id, (M0_AVI_PHASE, M0_AVI_STATE)))
+		return filter_sample(m, f->af_phase_rate);
+	return true;
+}
+
+/**
+ * Returns true iff a label should be placed in the trace. When false is
+ * returned, the label and everything in its context are muted.
+ *
+ * M0_AVI_FOM label has fom type identifier as the second value, see
+ * fop/fom.c:fom_addb2_push().
+ */
+static bool filter_label(uint64_t id, int n, const uint64_t *value)
+{
+	const struct m0_addb2_filter *f = filter();
+
+	return !f->af_active || id != M0_AVI_FOM || n < 2 ||
+		value[1] >= M0_ADDB2_FILTER_OPCODE_NR ||
+		(f->af_opmute[value[1] / 64] & M0_BITS(value[1] % 64)) == 0;
+}
+
+/**
+ * True iff tracing is disabled for the current context of the machine.
+ */
+static bool mach_muted(const struct m0_addb2_mach *m)
+{
+	return m->ma_mute < MACH_DEPTH(m);
+}
+
 /**
  * Returns current buffer with at least "space" bytes free.
  */
@@ -826,7 +964,9 @@ static struct buffer *mach_buffer(struct m0_addb2_mach *mach)
 			int n = 0;
 
 			M0_CNT_DEC(mach->ma_idle_nr);
-			for (i = 0; i < MACH_DEPTH(mach); ++i) {
+			/* Muted labels are not placed, see m0_addb2_push(). */
+			for (i = 0; i < min_check(MACH_DEPTH(mach),
+						  mach->ma_mute); ++i) {
 				struct tentry          *e = &mach->ma_label[i];
 				struct m0_addb2_value  *v = e->e_recval;
 				struct m0_addb2_sensor *s;
@@ -850,7 +990,7 @@ static struct buffer *mach_buffer(struct m0_addb2_mach *mach)
 						break;
 					}
 					if (n >= mach->ma_sensor_skip)
-						sensor_place(mach, s);
+						sensor_place(mach, s, false);
 					++n;
 				} m0_tl_endfor;
 			}
@@ -1062,7 +1202,8 @@ static struct tentry *mach_top(struct m0_addb2_mach *m)
 /**
  * Reads the sensor measurement and adds it to the current trace buffer.
  */
-static void sensor_place(struct m0_addb2_mach *m, struct m0_addb2_sensor *s)
+static void sensor_place(struct m0_addb2_mach *m, struct m0_addb2_sensor *s,
+			 bool muted)
 {
 	int nr = s->s_nr;
 
@@ -1073,7 +1214,8 @@ static void sensor_place(struct m0_addb2_mach *m, struct m0_addb2_sensor *s)
 		uint64_t area[nr]; /* VLA! */
 
 		s->s_ops->so_snapshot(s, area);
-		add(m, tag(SENSOR | nr, s->s_id), nr, area);
+		if (!muted)
+			add(m, tag(SENSOR | nr, s->s_id), nr, area);
 		record_consume(m, s->s_id, nr, area);
 	}
 }
@@ -432,6 +432,57 @@ void *m0_addb2_mach_cookie(const struct m0_addb2_mach *mach);
 int m0_addb2_module_init(void);
 void m0_addb2_module_fini(void);
 
+/**
+ * Filtering levels for records in a range of identifiers.
+ *
+ * @see m0_addb2_filter_level_set().
+ */
+enum m0_addb2_level {
+	/** All records are placed in the trace. This is the default. */
+	M0_ADDB2_LEVEL_ALL,
+	/** One record out of m0_addb2_filter_rate_set() is placed. */
+	M0_ADDB2_LEVEL_SAMPLED,
+	/** No records are placed in the trace. */
+	M0_ADDB2_LEVEL_OFF
+};
+
+/**
+ * Run-time filtering of addb2 traces.
+ *
+ * Filtering is applied when a record is added (m0_addb2_add()) or a label is
+ * pushed (m0_addb2_push()) and only affects what is placed in trace buffers
+ * (and hence stored or sent over network). Online CONSUMERS (philters,
+ * histograms, stats) still see all records.
+ *
+ * Filter state is global (per m0 instance) and can be changed at any time,
+ * e.g., from a configuration or a control request handler. Changes become
+ * visible to other threads eventually. Concurrent calls to the setters below
+ * should be serialised by the caller.
+ *
+ * - m0_addb2_filter_level_set() sets the level for a range of per-module
+ *   identifiers (below M0_AVI_EXTERNAL_RANGE_1, see addb2/identifier.h);
+ *
+ * - m0_addb2_filter_rate_set() sets N for 1-in-N sampling of records in
+ *   ranges with M0_ADDB2_LEVEL_SAMPLED level;
+ *
+ * - m0_addb2_filter_phase_rate_set() sets N for 1-in-N sampling of state
+ *   machine transition records (M0_AVI_PHASE and M0_AVI_STATE);
+ *
+ * - m0_addb2_filter_opcode_set() disables or enables tracing of FOMs of a given
+ *   type: nothing is placed in the trace while a M0_AVI_FOM label of a
+ *   disabled type is in the context;
+ *
+ * - m0_addb2_filter_reset() restores the default (trace everything) state.
+ *
+ * Sampling is done per machine: for N <= 1 every record is placed.
+ */
+void m0_addb2_filter_level_set(uint64_t lo, uint64_t hi,
+			       enum m0_addb2_level level);
+void m0_addb2_filter_rate_set(uint32_t rate);
+void m0_addb2_filter_phase_rate_set(uint32_t rate);
+void m0_addb2_filter_opcode_set(uint64_t opcode, bool enabled);
+void m0_addb2_filter_reset(void);
+
 /* Internal interface. */
 
 /**
@@ -453,6 +504,8 @@ struct m0_addb2_trace_obj {
 	struct m0_tlink       o_linkage;
 	/** Pointer to the machine in which the trace was generated. */
 	struct m0_addb2_mach *o_mach;
+	/** Linkage into the lock-free submission stack of a sys object. */
+	struct m0_addb2_trace_obj *o_next;
 	/**
 	 * Completion call-back.
 	 *
@@ -45,6 +45,9 @@
 #include "lib/varr.h"
 #include "lib/getopts.h"
 #include "lib/uuid.h"                  /* m0_node_uuid_string_set */
+#include "lib/atomic.h"
+#include "lib/semaphore.h"
+#include "lib/hash.h"                  /* m0_hash */
 
 #include "rpc/item.h"                  /* m0_rpc_item_type_lookup */
 #include "rpc/rpc_opcodes_xc.h"        /* m0_xc_M0_RPC_OPCODES_enum */
@@ -82,6 +85,7 @@
 #include "stob/addb2.h"
 #include "stob/addb2_xc.h"                /* m0_xc_m0_stio_req_states_enum */
 #include "net/addb2.h"
+#include "cm/addb2.h"
 #include "ioservice/io_addb2.h"
 #include "cas/cas_addb2.h"
 #include "m0t1fs/linux_kernel/m0t1fs_addb2.h"
@@ -112,6 +116,8 @@ struct m0_addb2__context {
 	struct fom                    c_fom;
 	const struct m0_addb2_record *c_rec;
 	const struct m0_addb2_value  *c_val;
+	/** Output stream: stdout or a per-frame buffer, see frame_dump(). */
+	FILE                         *c_out;
 };
 
 struct plugin
@@ -146,6 +152,8 @@ static void context_fill(struct m0_addb2__context *ctx,
 
 static void file_dump(struct m0_stob_domain *dom, const char *fname,
 		      const uint64_t start_time, const uint64_t stop_time);
+static void file_pdump(struct m0_stob *stob, const char *fname,
+		       const uint64_t start_time, const uint64_t stop_time);
 
 static int  plugin_load(struct plugin *plugin);
 static void plugin_unload(struct plugin *plugin);
@@ -172,6 +180,9 @@ static bool json_output = false;
 static const char *json_extra_data = NULL;
 static m0_bindex_t offset = 0;
 static int delay = 0;
+static int threads = 1;
+static const char *index_path = NULL;
+static uint64_t fom_addr = 0;
 
 extern void m0_dix_cm_repair_cpx_init(void);
 extern void m0_dix_cm_repair_cpx_fini(void);
@@ -239,7 +250,15 @@ int main(int argc, char **argv)
 			M0_FORMATARG('s', "Capture start time in nanosecs since epoch",
 				     "%"PRIu64, &start_time),
 			M0_FORMATARG('e', "Capture finish time in nanosecs since epoch",
-				     "%"PRIu64, &stop_time)
+				     "%"PRIu64, &stop_time),
+			M0_FORMATARG('F', "Only dump records of the FOM with "
+				     "this address", "%"SCNx64, &fom_addr),
+			M0_FORMATARG('t', "Number of frame decoding threads",
+				     "%i", &threads),
+			M0_STRINGARG('i', "Frame index file, created if missing",
+				    LAMBDA(void, (const char *path) {
+					    index_path = strdup(path);
+					}))
 			);
 	if (result != 0)
 		err(EX_USAGE, "Wrong option: %d", result);
@@ -256,6 +275,12 @@ int main(int argc, char **argv)
 	if ((delay != 0 || offset != 0) && optind + 1 < argc)
 		err(EX_USAGE,
 		    "Staring offset and continuous dump imply single file.");
+	if (threads < 1)
+		err(EX_USAGE, "Wrong number of threads: %i.", threads);
+	if (index_path != NULL && optind + 1 < argc)
+		err(EX_USAGE, "Index file implies single file.");
+	if (delay != 0 && (threads > 1 || index_path != NULL))
+		err(EX_USAGE, "Continuous dump is sequential.");
 	result = m0_stob_domain_init(buf, "directio=true", &dom);
 	if (result == 0)
 		m0_stob_domain_destroy(dom);
@@ -353,6 +378,26 @@ static bool intrps_equal(const struct m0_addb2__id_intrp *intrp0,
     return memcmp(intrp0, intrp1, sizeof(struct m0_addb2__id_intrp)) == 0;
 }
 
+static bool rec_has_fom(const struct m0_addb2_record *rec, uint64_t addr)
+{
+	return m0_exists(i, rec->ar_label_nr,
+			 rec->ar_label[i].va_id == M0_AVI_FOM &&
+			 rec->ar_label[i].va_nr > 0 &&
+			 rec->ar_label[i].va_data[0] == addr);
+}
+
+/**
+ * Returns true iff the record is within the time range and, when -F is given,
+ * in the context of the given FOM.
+ */
+static bool rec_matches(const struct m0_addb2_record *rec,
+			const uint64_t start_time, const uint64_t stop_time)
+{
+	return start_time <= rec->ar_val.va_time &&
+		rec->ar_val.va_time <= stop_time &&
+		(fom_addr == 0 || rec_has_fom(rec, fom_addr));
+}
+
 static void file_dump(struct m0_stob_domain *dom, const char *fname,
 		      const uint64_t start_time, const uint64_t stop_time)
 {
@@ -379,6 +424,11 @@ static void file_dump(struct m0_stob_domain *dom, const char *fname,
 	result = stat(fname, &buf);
 	if (result != 0)
 		err(EX_NOINPUT, "Cannot stat: %d", result);
+	if (threads > 1 || index_path != NULL) {
+		file_pdump(stob, fname, start_time, stop_time);
+		m0_stob_destroy(stob, NULL);
+		return;
+	}
 	do {
 		result = m0_addb2_sit_init(&sit, stob, offset);
 		if (delay > 0 && result == -EPROTO) {
@@ -391,9 +441,9 @@ static void file_dump(struct m0_stob_domain *dom, const char *fname,
 			err(EX_DATAERR, "Cannot initialise iterator: %d",
 			    result);
 		while ((result = m0_addb2_sit_next(sit, &rec)) > 0) {
-			if (start_time <= rec->ar_val.va_time &&
-			    rec->ar_val.va_time <= stop_time) {
-				rec_dump(&(struct m0_addb2__context){}, rec);
+			if (rec_matches(rec, start_time, stop_time)) {
+				rec_dump(&(struct m0_addb2__context){
+						.c_out = stdout }, rec);
 				if (rec->ar_val.va_id == M0_AVI_SIT)
 					offset = rec->ar_val.va_data[3];
 			}
@@ -405,6 +455,317 @@ static void file_dump(struct m0_stob_domain *dom, const char *fname,
 	m0_stob_destroy(stob, NULL);
 }
 
+/*
+ * Parallel and indexed dump.
+ *
+ * Frames (see addb2/storage.c) are independent: each trace in a frame starts
+ * with the re-pushed context of its machine. file_pdump() scans frame headers,
+ * then worker threads decode frames into per-frame memory streams, which are
+ * printed in frame order by the main thread. At most PDUMP_WINDOW frames per
+ * thread are decoded ahead of the printed one.
+ *
+ * While decoding, per-frame time range and a bloom filter of FOM addresses
+ * (M0_AVI_FOM labels) are collected. With -i this information is saved in an
+ * index file next to the dump, and used by subsequent runs to skip frames
+ * outside of the -s/-e time range or not containing the -F FOM.
+ *
+ * Interpreters from plugins (-p) must be re-entrant to be used with -t.
+ */
+
+enum {
+	PDUMP_WINDOW  = 4,
+	INDEX_BLOOM   = 256,
+	INDEX_VERSION = 1
+};
+
+struct frame {
+	uint64_t            fr_seqno;
+	m0_bindex_t         fr_offset;
+	uint64_t            fr_tmin;
+	uint64_t            fr_tmax;
+	uint64_t            fr_bloom[INDEX_BLOOM / 64];
+	/** Frame output, produced by open_memstream(3). */
+	char               *fr_out;
+	size_t              fr_size;
+	/** Upped when the frame is decoded. */
+	struct m0_semaphore fr_ready;
+};
+
+struct pdump {
+	struct m0_stob      *pd_stob;
+	m0_bcount_t          pd_stob_size;
+	struct frame        *pd_frame;
+	uint32_t             pd_nr;
+	uint32_t             pd_nr_max;
+	/** True iff frame information was loaded from the index file. */
+	bool                 pd_indexed;
+	uint64_t             pd_start;
+	uint64_t             pd_stop;
+	/** Index of the next frame to decode. */
+	struct m0_atomic64   pd_next;
+	/** Limits the number of decoded, but not yet printed frames. */
+	struct m0_semaphore  pd_window;
+};
+
+static void bloom_bits(uint64_t addr, unsigned *b0, unsigned *b1)
+{
+	uint64_t h = m0_hash(addr);
+
+	*b0 = h % INDEX_BLOOM;
+	*b1 = (h >> 32) % INDEX_BLOOM;
+}
+
+static void bloom_add(struct frame *f, uint64_t addr)
+{
+	unsigned b0;
+	unsigned b1;
+
+	bloom_bits(addr, &b0, &b1);
+	f->fr_bloom[b0 / 64] |= M0_BITS(b0 % 64);
+	f->fr_bloom[b1 / 64] |= M0_BITS(b1 % 64);
+}
+
+static bool bloom_has(const struct frame *f, uint64_t addr)
+{
+	unsigned b0;
+	unsigned b1;
+
+	bloom_bits(addr, &b0, &b1);
+	return (f->fr_bloom[b0 / 64] & M0_BITS(b0 % 64)) != 0 &&
+		(f->fr_bloom[b1 / 64] & M0_BITS(b1 % 64)) != 0;
+}
+
+static bool frame_selected(const struct pdump *pd, const struct frame *f)
+{
+	return !pd->pd_indexed ||
+		(f->fr_tmin <= pd->pd_stop && pd->pd_start <= f->fr_tmax &&
+		 (fom_addr == 0 || bloom_has(f, fom_addr)));
+}
+
+static void frame_account(struct frame *f, const struct m0_addb2_record *rec)
+{
+	int i;
+
+	if (rec->ar_val.va_time != 0) {
+		f->fr_tmin = min64u(f->fr_tmin, rec->ar_val.va_time);
+		f->fr_tmax = max64u(f->fr_tmax, rec->ar_val.va_time);
+	}
+	for (i = 0; i < rec->ar_label_nr; ++i) {
+		if (rec->ar_label[i].va_id == M0_AVI_FOM &&
+		    rec->ar_label[i].va_nr > 0)
+			bloom_add(f, rec->ar_label[i].va_data[0]);
+	}
+}
+
+static void frame_dump(struct pdump *pd, struct frame *f)
+{
+	struct m0_addb2_sit    *sit;
+	struct m0_addb2_record *rec;
+	FILE                   *out;
+	int                     result;
+
+	if (!frame_selected(pd, f))
+		return;
+	out = open_memstream(&f->fr_out, &f->fr_size);
+	if (out == NULL)
+		err(EX_OSERR, "Cannot open memory stream");
+	result = m0_addb2_sit_frame_init(&sit, pd->pd_stob,
+			&(struct m0_addb2_frame_header) {
+				.he_offset    = f->fr_offset,
+				.he_stob_size = pd->pd_stob_size });
+	if (result != 0)
+		err(EX_DATAERR, "Cannot initialise frame iterator at %"PRIx64
+		    ": %d", f->fr_offset, result);
+	while ((result = m0_addb2_sit_next(sit, &rec)) > 0) {
+		if (rec->ar_val.va_id == M0_AVI_SIT &&
+		    rec->ar_val.va_data[0] != f->fr_seqno)
+			errx(EX_DATAERR, "Stale index: frame at %"PRIx64
+			     " has seqno %"PRIu64", expected %"PRIu64".",
+			     f->fr_offset, rec->ar_val.va_data[0], f->fr_seqno);
+		if (!pd->pd_indexed)
+			frame_account(f, rec);
+		if (rec_matches(rec, pd->pd_start, pd->pd_stop))
+			rec_dump(&(struct m0_addb2__context){ .c_out = out },
+				 rec);
+	}
+	if (result != 0)
+		err(EX_DATAERR, "Iterator error: %d", result);
+	m0_addb2_sit_fini(sit);
+	fclose(out);
+}
+
+static void pdump_worker(struct pdump *pd)
+{
+	int64_t idx;
+
+	while (true) {
+		m0_semaphore_down(&pd->pd_window);
+		idx = m0_atomic64_add_return(&pd->pd_next, 1) - 1;
+		if (idx >= pd->pd_nr) {
+			m0_semaphore_up(&pd->pd_window);
+			break;
+		}
+		frame_dump(pd, &pd->pd_frame[idx]);
+		m0_semaphore_up(&pd->pd_frame[idx].fr_ready);
+	}
+}
+
+static struct frame *frame_add(struct pdump *pd)
+{
+	struct frame *f;
+
+	if (pd->pd_nr == pd->pd_nr_max) {
+		uint32_t      nr = max32u(pd->pd_nr_max * 2, 1024);
+		struct frame *area;
+
+		M0_ALLOC_ARR(area, nr);
+		if (area == NULL)
+			err(EX_OSERR, "Cannot allocate frame index");
+		memcpy(area, pd->pd_frame, pd->pd_nr * sizeof area[0]);
+		m0_free(pd->pd_frame);
+		pd->pd_frame = area;
+		pd->pd_nr_max = nr;
+	}
+	f = &pd->pd_frame[pd->pd_nr++];
+	f->fr_tmin = UINT64_MAX;
+	return f;
+}
+
+static int frame_header(const struct m0_addb2_frame_header *h, void *datum)
+{
+	struct pdump *pd = datum;
+	struct frame *f  = frame_add(pd);
+
+	f->fr_seqno = h->he_seqno;
+	f->fr_offset = h->he_offset;
+	pd->pd_stob_size = h->he_stob_size;
+	return 0;
+}
+
+/**
+ * Loads the index file. Returns -ESTALE if the index does not correspond to the
+ * dumped file.
+ */
+static int index_load(struct pdump *pd, const struct stat *st)
+{
+	FILE     *idx = fopen(index_path, "r");
+	uint64_t  size;
+	uint64_t  mtime;
+	int       version;
+	int       result;
+
+	if (idx == NULL)
+		return -errno;
+	result = fscanf(idx, "m0addb2dump-index %i %"SCNu64" %"SCNu64
+			" %"SCNu64"\n", &version, &size, &mtime,
+			&pd->pd_stob_size) == 4 ? 0 : -EPROTO;
+	if (result == 0 && (version != INDEX_VERSION || size != st->st_size ||
+			    mtime != st->st_mtime))
+		result = -ESTALE;
+	while (result == 0) {
+		struct frame f = { .fr_tmin = 0 };
+		int          nr;
+
+		nr = fscanf(idx, "%"SCNu64" %"SCNx64" %"SCNu64" %"SCNu64
+			    " %"SCNx64" %"SCNx64" %"SCNx64" %"SCNx64"\n",
+			    &f.fr_seqno, &f.fr_offset, &f.fr_tmin, &f.fr_tmax,
+			    &f.fr_bloom[0], &f.fr_bloom[1], &f.fr_bloom[2],
+			    &f.fr_bloom[3]);
+		M0_CASSERT(ARRAY_SIZE(f.fr_bloom) == 4);
+		if (nr == EOF)
+			break;
+		if (nr != 8)
+			result = -EPROTO;
+		else
+			*frame_add(pd) = f;
+	}
+	fclose(idx);
+	if (result != 0)
+		pd->pd_nr = 0;
+	pd->pd_indexed = result == 0;
+	return result;
+}
+
+static void index_save(const struct pdump *pd, const struct stat *st)
+{
+	FILE    *idx = fopen(index_path, "w");
+	uint32_t i;
+
+	if (idx == NULL)
+		err(EX_CANTCREAT, "Cannot create index %s", index_path);
+	fprintf(idx, "m0addb2dump-index %i %"PRIu64" %"PRIu64" %"PRIu64"\n",
+		INDEX_VERSION, (uint64_t)st->st_size, (uint64_t)st->st_mtime,
+		pd->pd_stob_size);
+	for (i = 0; i < pd->pd_nr; ++i) {
+		const struct frame *f = &pd->pd_frame[i];
+
+		fprintf(idx, "%"PRIu64" %"PRIx64" %"PRIu64" %"PRIu64
+			" %"PRIx64" %"PRIx64" %"PRIx64" %"PRIx64"\n",
+			f->fr_seqno, f->fr_offset, f->fr_tmin, f->fr_tmax,
+			f->fr_bloom[0], f->fr_bloom[1], f->fr_bloom[2],
+			f->fr_bloom[3]);
+	}
+	if (fclose(idx) != 0)
+		err(EX_IOERR, "Cannot write index %s", index_path);
+}
+
+static void file_pdump(struct m0_stob *stob, const char *fname,
+		       const uint64_t start_time, const uint64_t stop_time)
+{
+	struct pdump      pd = {
+		.pd_stob  = stob,
+		.pd_start = start_time,
+		.pd_stop  = stop_time
+	};
+	struct m0_thread *worker;
+	struct stat       st;
+	uint32_t          i;
+	int               result;
+
+	if (stat(fname, &st) != 0)
+		err(EX_NOINPUT, "Cannot stat %s", fname);
+	if (index_path == NULL || index_load(&pd, &st) != 0) {
+		result = m0_addb2_sit_frames(stob, offset, &frame_header, &pd);
+		if (result != 0)
+			err(EX_DATAERR, "Cannot scan frames: %d", result);
+	}
+	M0_ALLOC_ARR(worker, threads);
+	if (worker == NULL)
+		err(EX_OSERR, "Cannot allocate threads");
+	for (i = 0; i < pd.pd_nr; ++i)
+		m0_semaphore_init(&pd.pd_frame[i].fr_ready, 0);
+	m0_semaphore_init(&pd.pd_window, PDUMP_WINDOW * threads);
+	m0_atomic64_set(&pd.pd_next, 0);
+	for (i = 0; i < threads; ++i) {
+		result = M0_THREAD_INIT(&worker[i], struct pdump *, NULL,
+					&pdump_worker, &pd, "m0addb2dump%u", i);
+		if (result != 0)
+			err(EX_OSERR, "Cannot start thread: %d", result);
+	}
+	for (i = 0; i < pd.pd_nr; ++i) {
+		struct frame *f = &pd.pd_frame[i];
+
+		m0_semaphore_down(&f->fr_ready);
+		if (f->fr_out != NULL) {
+			fwrite(f->fr_out, 1, f->fr_size, stdout);
+			free(f->fr_out);
+			f->fr_out = NULL;
+		}
+		m0_semaphore_up(&pd.pd_window);
+	}
+	for (i = 0; i < threads; ++i) {
+		m0_thread_join(&worker[i]);
+		m0_thread_fini(&worker[i]);
+	}
+	if (index_path != NULL && !pd.pd_indexed)
+		index_save(&pd, &st);
+	for (i = 0; i < pd.pd_nr; ++i)
+		m0_semaphore_fini(&pd.pd_frame[i].fr_ready);
+	m0_semaphore_fini(&pd.pd_window);
+	m0_free(worker);
+	m0_free(pd.pd_frame);
+}
+
 static void dec(struct m0_addb2__context *ctx, const uint64_t *v, char *buf)
 {
 	sprintf(buf, "%"PRId64, v[0]);
@@ -1017,7 +1378,8 @@ static void attr(struct m0_addb2__context *ctx, const uint64_t *v, char *buf)
 		  ARRAY_SIZE(dix_values) },
 		{ &m0_xc_m0_avi_rpc_labels_enum, rpc_values,
 		  ARRAY_SIZE(rpc_values) },
-	}, *vn = NULL;
+	};
+	typeof(&vnmap[0]) vn = NULL;
 	uint64_t attr_name                  = v[0];
 	uint64_t attr_val                   = v[1];
 	struct m0_xcode_enum *attr_name_xen = NULL;
@@ -1109,6 +1471,7 @@ struct m0_addb2__id_intrp ids[] = {
 	{ M0_AVI_FOM_ACTIVE,      "fom-active",      { HIST } },
 	{ M0_AVI_RUNQ,            "runq",            { HIST } },
 	{ M0_AVI_WAIL,            "wail",            { HIST } },
+	{ M0_AVI_FOM_SHED,        "fom-shed",        { HIST } },
 	{ M0_AVI_AST,             "ast" },
 	{ M0_AVI_LOCALITY_FORQ_DURATION, "loc-forq-duration", { TIMED },
 	  { "duration" } },
@@ -1145,6 +1508,7 @@ struct m0_addb2__id_intrp ids[] = {
 	{ M0_AVI_STOB_IOQ_INFLIGHT, "stob-ioq-inflight", { HIST } },
 	{ M0_AVI_STOB_IOQ_QUEUED, "stob-ioq-queued", { HIST } },
 	{ M0_AVI_STOB_IOQ_GOT,    "stob-ioq-got",    { HIST } },
+	{ M0_AVI_STOB_IOQ_MERGED, "stob-ioq-merged", { HIST } },
 
 	{ M0_AVI_RPC_LOCK,        "rpc-machine-lock", { &ptr } },
 	{ M0_AVI_RPC_REPLIED,     "rpc-replied",      { &ptr, &rpcop } },
@@ -1154,6 +1518,15 @@ struct m0_addb2__id_intrp ids[] = {
 	  { &dec, &dec, &dec, &dec }, { "id", "opcode", "xid", "session_id" } },
 	{ M0_AVI_RPC_ITEM_ID_FETCH, "rpc-item-id-fetch",
 	  { &dec, &dec, &dec, &dec }, { "id", "opcode", "xid", "session_id" } },
+	{ M0_AVI_RPC_FRM_PACKET,  "rpc-frm-packet",
+	  { &ptr, &dec, &dec, &dec }, { "frm", "policy", "items", "bytes" } },
+	{ M0_AVI_RPC_FRM_HOLD,    "rpc-frm-hold",
+	  { &ptr, &dec, &duration }, { "frm", "policy", "hold" } },
+
+	{ M0_AVI_CM_PROXY_STALL,  "cm-proxy-stall",
+	  { &dec, &duration }, { "proxy", "stall" } },
+	{ M0_AVI_CM_PROXY_WND,    "cm-proxy-wnd",
+	  { &dec, &dec, &dec }, { "proxy", "wnd", "rate" } },
 
 	{ M0_AVI_DTX0_SM_STATE,     "dtx0-state",    { &dtx0_state, SKIP2  } },
 	{ M0_AVI_DTX0_SM_COUNTER,   "",
@@ -1174,9 +1547,16 @@ struct m0_addb2__id_intrp ids[] = {
 	  .ii_spec   = &beop_state_counter },
 	{ M0_AVI_BE_TX_TO_GROUP,  "tx-to-gr", { &dec, &dec, &dec },
 	  { "tx_id", "gr_id", "inout" } },
+	{ M0_AVI_BE_BTREE_LRU,    "btree-lru",       { &dec, &dec, &dec, &dec,
+						       &dec, &dec },
+	  { "hit", "miss", "evict", "hot_evict", "hot_nr", "cold_nr" } },
+	{ M0_AVI_BE_SEG_RESIDENT, "be-seg-resident", { &dec, &dec, &dec },
+	  { "seg_id", "resident", "size" } },
 	{ M0_AVI_NET_BUF,         "net-buf",         { &ptr, &dec, &_clock,
 						       &duration, &dec, &dec },
 	  { "buf", "qtype", "time", "duration", "status", "len" } },
+	{ M0_AVI_NET_MR_CACHE,    "net-mr-cache",    { &dec, &dec, &dec, &dec },
+	  { "hit", "miss", "evict", "lru_nr" } },
 	{ M0_AVI_FOP_TYPES_RANGE_START,   "",
 	  .ii_repeat = M0_AVI_FOP_TYPES_RANGE_END-M0_AVI_FOP_TYPES_RANGE_START,
 	  .ii_spec   = &fop_counter },
@@ -1336,28 +1716,28 @@ static void rec_dump(struct m0_addb2__context *ctx,
 	for (i = 0; i < rec->ar_label_nr; ++i)
 		context_fill(ctx, &rec->ar_label[i]);
 	if (json_output)
-		printf("{");
+		fprintf(ctx->c_out, "{");
 	val_dump(ctx, "* ", &rec->ar_val, 0, !flatten);
 	if (json_output && rec->ar_label_nr > 0)
-		printf(",");
+		fprintf(ctx->c_out, ",");
 	for (i = 0; i < rec->ar_label_nr; ++i) {
 		val_dump(ctx, "| ", &rec->ar_label[i], 8, !flatten);
 		if (json_output && i < rec->ar_label_nr - 1)
-			printf(",");
+			fprintf(ctx->c_out, ",");
 	}
 	if (json_output) {
 		if (json_extra_data != NULL)
-			printf(",%s}\n", json_extra_data);
+			fprintf(ctx->c_out, ",%s}\n", json_extra_data);
 		else
-			puts("}");
+			fputs("}\n", ctx->c_out);
 	} else if (flatten) {
-		puts("");
+		fputc('\n', ctx->c_out);
 	}
 }
 
-static int pad(int indent)
+static int pad(FILE *out, int indent)
 {
-	return indent > 0 ? printf("%*.*s", indent, indent,
+	return indent > 0 ? fprintf(out, "%*.*s", indent, indent,
 		   "                                                    ") : 0;
 }
 
@@ -1386,26 +1766,27 @@ static void val_dump_json(struct m0_addb2__context *ctx,
 	ctx->c_val = val;
 	if (output_timestamp && val->va_time != 0) {
 		_clock(ctx, &val->va_time, buf);
-		printf("\"timestamp\":%s,", buf);
+		fprintf(ctx->c_out, "\"timestamp\":%s,", buf);
 	}
 	if (intrp != NULL && intrp->ii_spec != NULL) {
 		intrp->ii_spec(ctx, buf);
 		// FIXME: rename "spec" to something meaningful
-		printf("\"spec\":%s", buf);
+		fprintf(ctx->c_out, "\"spec\":%s", buf);
 		return;
 	}
 	if (intrp != NULL) {
 		need_braces = count_nonempty_vals(val) > 1;
-		printf("\"%s\":%s", intrp->ii_name, need_braces ? "{" : "");
+		fprintf(ctx->c_out, "\"%s\":%s", intrp->ii_name,
+			need_braces ? "{" : "");
 		 /* boolean attributes (flags) */
 		if (val->va_nr == 0)
-			printf("true");
+			fprintf(ctx->c_out, "true");
 		else if (intrp->ii_print != NULL &&
 			 intrp->ii_print[0] == &hist)
-			printf("true,");
+			fprintf(ctx->c_out, "true,");
 	}
 	else {
-		printf("\"m0addb2dump[%s:%u]:%" PRIu64 "\"",
+		fprintf(ctx->c_out, "\"m0addb2dump[%s:%u]:%" PRIu64 "\"",
 			__FILE__, __LINE__, val->va_id);
 	}
 	for (i = 0; i < val->va_nr; ++i) {
@@ -1433,12 +1814,13 @@ static void val_dump_json(struct m0_addb2__context *ctx,
 				if (intrp->ii_print[i] == &ptr ||
 				    intrp->ii_print[i] == &duration)
 					need_comma = i < val->va_nr - 1;
-				printf("%s%s", buf, need_comma ? "," : "");
+				fprintf(ctx->c_out, "%s%s", buf,
+					need_comma ? "," : "");
 			}
 		}
 	}
 	if (need_braces)
-		printf("}");
+		fprintf(ctx->c_out, "}");
 #undef BEND
 }
 
@@ -1453,21 +1835,21 @@ static void val_dump_plaintext(struct m0_addb2__context *ctx, const char *prefix
 #define BEND (buf + strlen(buf))
 
 	ctx->c_val = val;
-	printf("%s", prefix);
-	pad(indent);
+	fprintf(ctx->c_out, "%s", prefix);
+	pad(ctx->c_out, indent);
 	if (indent == 0 && val->va_time != 0) {
 		_clock(ctx, &val->va_time, buf);
-		printf("%s ", buf);
+		fprintf(ctx->c_out, "%s ", buf);
 	}
 	if (intrp != NULL && intrp->ii_spec != NULL) {
 		intrp->ii_spec(ctx, buf);
-		printf("%s%s", buf, cr ? "\n" : " ");
+		fprintf(ctx->c_out, "%s%s", buf, cr ? "\n" : " ");
 		return;
 	}
 	if (intrp != NULL)
-		printf("%-16s ", intrp->ii_name);
+		fprintf(ctx->c_out, "%-16s ", intrp->ii_name);
 	else
-		printf(U64" ", val->va_id);
+		fprintf(ctx->c_out, U64" ", val->va_id);
 	for (i = 0, indent = 0; i < val->va_nr; ++i) {
 		buf[0] = 0;
 		if (intrp == NULL)
@@ -1484,11 +1866,11 @@ static void val_dump_plaintext(struct m0_addb2__context *ctx, const char *prefix
 			}
 		}
 		if (i > 0)
-			indent += printf(", ");
-		indent += pad(WIDTH * i - indent);
-		indent += printf("%s", buf);
+			indent += fprintf(ctx->c_out, ", ");
+		indent += pad(ctx->c_out, WIDTH * i - indent);
+		indent += fprintf(ctx->c_out, "%s", buf);
 	}
-	printf("%s", cr ? "\n" : " ");
+	fprintf(ctx->c_out, "%s", cr ? "\n" : " ");
 #undef BEND
 }
 
@@ -1564,8 +1946,9 @@ static void libbfd_fini(void)
 
 static void libbfd_resolve(uint64_t delta, char *buf)
 {
-	static uint64_t    cached = 0;
-	static const char *name   = NULL;
+	/* Per-thread, because frames are decoded in parallel. */
+	static __thread uint64_t    cached = 0;
+	static __thread const char *name   = NULL;
 
 	if (abfd == NULL)
 		;
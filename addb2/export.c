@@ -0,0 +1,399 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2015-2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+/**
+ * @addtogroup addb2
+ *
+ * @{
+ */
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_ADDB
+
+#include <stdarg.h>
+#include <stdio.h>                     /* vsnprintf */
+#include <unistd.h>                    /* close */
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>                 /* inet_pton, htons */
+
+#include "lib/trace.h"
+#include "lib/errno.h"                 /* ENOSPC, ENOMEM, EINVAL */
+#include "lib/memory.h"
+#include "lib/misc.h"                  /* M0_SET0 */
+#include "addb2/counter.h"
+#include "addb2/internal.h"            /* VALUE_MAX_NR */
+#include "addb2/export.h"
+
+enum {
+	/**
+	 * Size of the buffer used in push mode. Fits in a UDP datagram.
+	 */
+	EXPORT_PUSH_BUF = 60000
+};
+
+M0_INTERNAL int m0_addb2_export_init(struct m0_addb2_export *ex,
+				     uint32_t nr_max)
+{
+	M0_PRE(M0_IS0(ex));
+
+	M0_ALLOC_ARR(ex->ae_metric, nr_max);
+	if (ex->ae_metric == NULL)
+		return M0_ERR(-ENOMEM);
+	ex->ae_nr_max = nr_max;
+	ex->ae_sock   = -1;
+	m0_mutex_init(&ex->ae_lock);
+	return 0;
+}
+
+M0_INTERNAL void m0_addb2_export_fini(struct m0_addb2_export *ex)
+{
+	M0_PRE(!ex->ae_started && !ex->ae_pushing);
+
+	m0_mutex_fini(&ex->ae_lock);
+	m0_free(ex->ae_metric);
+	M0_SET0(ex);
+}
+
+static struct m0_addb2_export_metric *export_find(struct m0_addb2_export *ex,
+						  uint64_t id)
+{
+	uint32_t lo = 0;
+	uint32_t hi = ex->ae_nr;
+
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+
+		if (ex->ae_metric[mid].em_id < id)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo < ex->ae_nr && ex->ae_metric[lo].em_id == id ?
+		&ex->ae_metric[lo] : NULL;
+}
+
+M0_INTERNAL int m0_addb2_export_metric_add(struct m0_addb2_export *ex,
+					   uint64_t id, const char *name,
+					   enum m0_addb2_export_kind kind)
+{
+	struct m0_addb2_export_metric *m;
+	uint32_t                       i;
+
+	M0_PRE(!ex->ae_started);
+	M0_PRE(M0_IN(kind, (M0_AEK_COUNTER, M0_AEK_HIST, M0_AEK_GAUGE)));
+
+	if (export_find(ex, id) != NULL)
+		return M0_ERR(-EEXIST);
+	if (ex->ae_nr == ex->ae_nr_max)
+		return M0_ERR(-ENOSPC);
+	/* Keep the array sorted by identifier, see export_find(). */
+	for (i = ex->ae_nr; i > 0 && ex->ae_metric[i - 1].em_id > id; --i)
+		ex->ae_metric[i] = ex->ae_metric[i - 1];
+	m = &ex->ae_metric[i];
+	*m = (struct m0_addb2_export_metric) {
+		.em_id   = id,
+		.em_name = name,
+		.em_kind = kind,
+		.em_min  = INT64_MAX,
+		.em_max  = INT64_MIN
+	};
+	ex->ae_nr++;
+	return 0;
+}
+
+/**
+ * Returns true iff the record is a snapshot of a registered sensor. The
+ * payload size distinguishes sensor snapshots from data records with the same
+ * identifier (e.g., M0_ADDB2_TIMED()).
+ */
+static bool export_matches(struct m0_addb2_philter *ph,
+			   const struct m0_addb2_record *rec)
+{
+	struct m0_addb2_export        *ex = ph->ph_datum;
+	struct m0_addb2_export_metric *m  = export_find(ex, rec->ar_val.va_id);
+	unsigned                       nr = rec->ar_val.va_nr;
+
+	if (m == NULL)
+		return false;
+	switch (m->em_kind) {
+	case M0_AEK_COUNTER:
+		return nr == M0_ADDB2_COUNTER_VALS;
+	case M0_AEK_HIST:
+		return nr == VALUE_MAX_NR;
+	case M0_AEK_GAUGE:
+		return nr >= 1;
+	default:
+		M0_IMPOSSIBLE("Wrong kind.");
+	}
+}
+
+static void export_counter(struct m0_addb2_export_metric *m,
+			   const struct m0_addb2_counter_data *d)
+{
+	if (d->cod_nr == 0 || d->cod_nr == ~0ULL) /* Empty or overflown. */
+		return;
+	m->em_nr  += d->cod_nr;
+	m->em_sum += d->cod_sum;
+	m->em_min  = min64(m->em_min, d->cod_min);
+	m->em_max  = max64(m->em_max, d->cod_max);
+}
+
+static void export_fire(const struct m0_addb2_source   *src,
+			const struct m0_addb2_philter  *ph,
+			const struct m0_addb2_callback *callback,
+			const struct m0_addb2_record   *rec)
+{
+	struct m0_addb2_export          *ex   = callback->ca_datum;
+	struct m0_addb2_export_metric   *m;
+	const uint64_t                  *area = rec->ar_val.va_data;
+	const struct m0_addb2_hist_data *hd;
+	int                              i;
+
+	m = export_find(ex, rec->ar_val.va_id);
+	M0_ASSERT(m != NULL);
+	m0_mutex_lock(&ex->ae_lock);
+	switch (m->em_kind) {
+	case M0_AEK_COUNTER:
+		export_counter(m, (const void *)area);
+		break;
+	case M0_AEK_HIST:
+		export_counter(m, (const void *)area);
+		hd = (const void *)(area + M0_ADDB2_COUNTER_VALS);
+		m->em_hmin = hd->hd_min;
+		m->em_hmax = hd->hd_max;
+		for (i = 0; i < ARRAY_SIZE(m->em_bucket); ++i)
+			m->em_bucket[i] += hd->hd_bucket[i];
+		break;
+	case M0_AEK_GAUGE:
+		m->em_sum = area[0];
+		break;
+	default:
+		M0_IMPOSSIBLE("Wrong kind.");
+	}
+	m0_mutex_unlock(&ex->ae_lock);
+}
+
+M0_INTERNAL void m0_addb2_export_start(struct m0_addb2_export *ex)
+{
+	M0_PRE(!ex->ae_started);
+
+	m0_addb2_philter_init(&ex->ae_philter, &export_matches, ex);
+	m0_addb2_callback_init(&ex->ae_callback, &export_fire, ex);
+	m0_addb2_callback_add(&ex->ae_philter, &ex->ae_callback);
+	m0_addb2_philter_global_add(&ex->ae_philter);
+	ex->ae_started = true;
+}
+
+M0_INTERNAL void m0_addb2_export_stop(struct m0_addb2_export *ex)
+{
+	M0_PRE(ex->ae_started);
+
+	m0_addb2_philter_global_del(&ex->ae_philter);
+	m0_addb2_callback_del(&ex->ae_callback);
+	m0_addb2_callback_fini(&ex->ae_callback);
+	m0_addb2_philter_fini(&ex->ae_philter);
+	ex->ae_started = false;
+}
+
+static int out(char *buf, m0_bcount_t size, m0_bcount_t *pos,
+	       const char *format, ...)
+	__attribute__ ((format (printf, 4, 5)));
+
+static int out(char *buf, m0_bcount_t size, m0_bcount_t *pos,
+	       const char *format, ...)
+{
+	va_list ap;
+	int     nr;
+
+	va_start(ap, format);
+	nr = vsnprintf(buf + *pos, size - *pos, format, ap);
+	va_end(ap);
+	if (nr < 0 || *pos + nr >= size)
+		return M0_ERR(-ENOSPC);
+	*pos += nr;
+	return 0;
+}
+
+static int export_metric_text(const struct m0_addb2_export_metric *m,
+			      char *buf, m0_bcount_t size, m0_bcount_t *pos)
+{
+	const char *n = m->em_name;
+	uint64_t    cumulative = 0;
+	int         rc = 0;
+	int         i;
+
+	switch (m->em_kind) {
+	case M0_AEK_COUNTER:
+		rc = out(buf, size, pos, "# TYPE %s summary\n"
+			 "%s_sum %"PRIi64"\n%s_count %"PRIu64"\n",
+			 n, n, m->em_sum, n, m->em_nr);
+		if (rc == 0 && m->em_nr > 0)
+			rc = out(buf, size, pos, "# TYPE %s_min gauge\n"
+				 "%s_min %"PRIi64"\n# TYPE %s_max gauge\n"
+				 "%s_max %"PRIi64"\n",
+				 n, n, m->em_min, n, n, m->em_max);
+		break;
+	case M0_AEK_HIST:
+		/*
+		 * Bucket 0 counts values below hd_min, the last bucket counts
+		 * values at or above hd_max, see m0_addb2_hist_bucket().
+		 */
+		rc = out(buf, size, pos, "# TYPE %s histogram\n", n);
+		for (i = 0; rc == 0 && i < M0_ADDB2_HIST_BUCKETS - 1; ++i) {
+			cumulative += m->em_bucket[i];
+			rc = out(buf, size, pos,
+				 "%s_bucket{le=\"%"PRIi64"\"} %"PRIu64"\n", n,
+				 m->em_hmin + i * (m->em_hmax - m->em_hmin) /
+				 (M0_ADDB2_HIST_BUCKETS - 2), cumulative);
+		}
+		rc = rc ?: out(buf, size, pos,
+			       "%s_bucket{le=\"+Inf\"} %"PRIu64"\n"
+			       "%s_sum %"PRIi64"\n%s_count %"PRIu64"\n",
+			       n, max64u(m->em_nr, cumulative +
+					 m->em_bucket[i]),
+			       n, m->em_sum, n, m->em_nr);
+		break;
+	case M0_AEK_GAUGE:
+		rc = out(buf, size, pos, "# TYPE %s gauge\n%s %"PRIi64"\n",
+			 n, n, m->em_sum);
+		break;
+	default:
+		M0_IMPOSSIBLE("Wrong kind.");
+	}
+	return rc;
+}
+
+M0_INTERNAL int m0_addb2_export_text(struct m0_addb2_export *ex,
+				     char *buf, m0_bcount_t size)
+{
+	m0_bcount_t pos = 0;
+	uint32_t    i;
+	int         rc = 0;
+
+	M0_PRE(size > 0);
+
+	buf[0] = 0;
+	/*
+	 * Formatting does not allocate memory, nor otherwise produce addb2
+	 * records, which would re-enter export_fire() under the lock.
+	 */
+	m0_mutex_lock(&ex->ae_lock);
+	for (i = 0; rc == 0 && i < ex->ae_nr; ++i)
+		rc = export_metric_text(&ex->ae_metric[i], buf, size, &pos);
+	m0_mutex_unlock(&ex->ae_lock);
+	return rc ?: pos;
+}
+
+static void export_push_thread(struct m0_addb2_export *ex)
+{
+	int rc;
+
+	while (!m0_semaphore_timeddown(&ex->ae_stop,
+				       m0_time_from_now(0, ex->ae_period))) {
+		rc = m0_addb2_export_text(ex, ex->ae_buf, EXPORT_PUSH_BUF);
+		if (rc < 0) {
+			M0_LOG(M0_WARN, "Export does not fit: %i.", rc);
+			continue;
+		}
+		/*
+		 * Connected UDP socket: errors (e.g., ECONNREFUSED while
+		 * nobody listens) are not fatal, keep pushing.
+		 */
+		if (send(ex->ae_sock, ex->ae_buf, rc, 0) < 0)
+			M0_LOG(M0_DEBUG, "send: %i.", -errno);
+	}
+}
+
+M0_INTERNAL int m0_addb2_export_push_start(struct m0_addb2_export *ex,
+					   const char *ip, uint16_t port,
+					   m0_time_t period)
+{
+	struct sockaddr_in sin = {
+		.sin_family = AF_INET,
+		.sin_port   = htons(port)
+	};
+	int                rc;
+
+	M0_PRE(!ex->ae_pushing);
+	M0_PRE(period > 0);
+
+	if (inet_pton(AF_INET, ip, &sin.sin_addr) != 1)
+		return M0_ERR_INFO(-EINVAL, "Wrong address: '%s'.", ip);
+	ex->ae_buf = m0_alloc(EXPORT_PUSH_BUF);
+	if (ex->ae_buf == NULL)
+		return M0_ERR(-ENOMEM);
+	ex->ae_sock = socket(AF_INET, SOCK_DGRAM, 0);
+	if (ex->ae_sock < 0) {
+		rc = M0_ERR(-errno);
+		goto free;
+	}
+	if (connect(ex->ae_sock, (void *)&sin, sizeof sin) != 0) {
+		rc = M0_ERR(-errno);
+		goto close;
+	}
+	ex->ae_period = period;
+	m0_semaphore_init(&ex->ae_stop, 0);
+	rc = M0_THREAD_INIT(&ex->ae_thread, struct m0_addb2_export *, NULL,
+			    &export_push_thread, ex, "m0_addb2_exp");
+	if (rc == 0) {
+		ex->ae_pushing = true;
+		return 0;
+	}
+	m0_semaphore_fini(&ex->ae_stop);
+close:
+	close(ex->ae_sock);
+	ex->ae_sock = -1;
+free:
+	m0_free0(&ex->ae_buf);
+	return M0_RC(rc);
+}
+
+M0_INTERNAL void m0_addb2_export_push_stop(struct m0_addb2_export *ex)
+{
+	M0_PRE(ex->ae_pushing);
+
+	m0_semaphore_up(&ex->ae_stop);
+	m0_thread_join(&ex->ae_thread);
+	m0_thread_fini(&ex->ae_thread);
+	m0_semaphore_fini(&ex->ae_stop);
+	close(ex->ae_sock);
+	ex->ae_sock = -1;
+	m0_free0(&ex->ae_buf);
+	ex->ae_pushing = false;
+}
+
+#undef M0_TRACE_SUBSYSTEM
+
+/** @} end of addb2 group */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -0,0 +1,178 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2015-2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __MOTR_ADDB2_EXPORT_H__
+#define __MOTR_ADDB2_EXPORT_H__
+
+/**
+ * @defgroup addb2
+ *
+ * Addb2 live exporter
+ * -------------------
+ *
+ * Exporter is an online CONSUMER (see addb2/consumer.h), which accumulates the
+ * values of addb2 counters (m0_addb2_counter), histograms (m0_addb2_hist) and
+ * single-value sensors (e.g., m0_addb2_list_counter) as they are produced by
+ * any addb2 machine, and makes them available without going through addb2
+ * storage and m0addb2dump.
+ *
+ * Metrics to export are registered by their addb2 identifiers with
+ * m0_addb2_export_metric_add(). m0_addb2_export_start() installs a global
+ * philter (m0_addb2_philter_global_add()) that matches sensor records with the
+ * registered identifiers. Counter and histogram snapshots are deltas (a
+ * snapshot resets the sensor), the exporter sums them into cumulative values.
+ *
+ * Accumulated values are rendered in Prometheus text exposition format:
+ *
+ *     - pull mode: m0_addb2_export_text() formats metrics into a buffer, which
+ *       the caller serves as it sees fit (an http handler, a node-exporter
+ *       text file, etc.);
+ *
+ *     - push mode: m0_addb2_export_push_start() starts a thread, which
+ *       periodically sends the formatted metrics as a UDP datagram to a given
+ *       address.
+ *
+ * Values are as fresh as sensor records are: sensors are read when a trace
+ * buffer is started and when their context is popped, see
+ * m0_addb2_force_all().
+ *
+ * @{
+ */
+
+#include "lib/types.h"
+#include "lib/mutex.h"
+#include "lib/semaphore.h"
+#include "lib/thread.h"
+#include "lib/time.h"
+#include "addb2/consumer.h"
+#include "addb2/histogram.h"
+
+enum m0_addb2_export_kind {
+	/** m0_addb2_counter: exported as a summary (sum, count, min, max). */
+	M0_AEK_COUNTER,
+	/** m0_addb2_hist: exported as a histogram. */
+	M0_AEK_HIST,
+	/** A sensor with a single value (e.g., a list length): a gauge. */
+	M0_AEK_GAUGE,
+	M0_AEK_NR
+};
+
+/**
+ * An exported metric.
+ */
+struct m0_addb2_export_metric {
+	/** Sensor identifier. */
+	uint64_t                  em_id;
+	/** Metric name, used as is in the output. */
+	const char               *em_name;
+	enum m0_addb2_export_kind em_kind;
+	/** Cumulative number of measurements (counters and histograms). */
+	uint64_t                  em_nr;
+	/** Cumulative sum of measurements, or the last value of a gauge. */
+	int64_t                   em_sum;
+	int64_t                   em_min;
+	int64_t                   em_max;
+	/** Histogram range, as in the last snapshot. */
+	int64_t                   em_hmin;
+	int64_t                   em_hmax;
+	/** Cumulative histogram buckets. */
+	uint64_t                  em_bucket[M0_ADDB2_HIST_BUCKETS];
+};
+
+struct m0_addb2_export {
+	/** Protects accumulated values in ->ae_metric[]. */
+	struct m0_mutex                ae_lock;
+	/** Registered metrics, sorted by identifier. */
+	struct m0_addb2_export_metric *ae_metric;
+	uint32_t                       ae_nr;
+	uint32_t                       ae_nr_max;
+	bool                           ae_started;
+	struct m0_addb2_philter        ae_philter;
+	struct m0_addb2_callback       ae_callback;
+	/* Push mode. */
+	bool                           ae_pushing;
+	int                            ae_sock;
+	struct m0_thread               ae_thread;
+	struct m0_semaphore            ae_stop;
+	m0_time_t                      ae_period;
+	char                          *ae_buf;
+};
+
+M0_INTERNAL int  m0_addb2_export_init(struct m0_addb2_export *ex,
+				      uint32_t nr_max);
+M0_INTERNAL void m0_addb2_export_fini(struct m0_addb2_export *ex);
+
+/**
+ * Registers a metric to be exported.
+ *
+ * "name" must be a valid Prometheus metric name. It is not copied.
+ *
+ * @pre !ex->ae_started
+ */
+M0_INTERNAL int  m0_addb2_export_metric_add(struct m0_addb2_export *ex,
+					    uint64_t id, const char *name,
+					    enum m0_addb2_export_kind kind);
+
+/**
+ * Starts consuming records produced by addb2 machines.
+ *
+ * @note Global philters are not synchronised with concurrent record
+ * consumption, so the exporter should be started and stopped while addb2
+ * machines are quiescent, e.g., during process start-up and shutdown.
+ */
+M0_INTERNAL void m0_addb2_export_start(struct m0_addb2_export *ex);
+M0_INTERNAL void m0_addb2_export_stop(struct m0_addb2_export *ex);
+
+/**
+ * Formats exported metrics in Prometheus text format.
+ *
+ * Returns the length of the output (not counting the terminating NUL) or
+ * -ENOSPC if the output does not fit in the buffer.
+ */
+M0_INTERNAL int  m0_addb2_export_text(struct m0_addb2_export *ex,
+				      char *buf, m0_bcount_t size);
+
+/**
+ * Starts sending exported metrics every "period" to UDP address "ip":"port".
+ */
+M0_INTERNAL int  m0_addb2_export_push_start(struct m0_addb2_export *ex,
+					    const char *ip, uint16_t port,
+					    m0_time_t period);
+M0_INTERNAL void m0_addb2_export_push_stop(struct m0_addb2_export *ex);
+
+/** @} end of addb2 group */
+#endif /* __MOTR_ADDB2_EXPORT_H__ */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -99,6 +99,8 @@ enum m0_addb2_value_id {
 	M0_AVI_LONG_LOCK,
 	/** Measurement: generic attribute. */
 	M0_AVI_ATTR,
+	/** Measurement: run queue length of a locality sharing a fom. */
+	M0_AVI_FOM_SHED,
 
 	M0_AVI_LIB_RANGE_START     = 0x3000,
 	/** Measurement: memory allocation. */
@@ -117,6 +119,7 @@ enum m0_addb2_value_id {
 	M0_AVI_DIX_RANGE_START     = 0xe000,
 	M0_AVI_KEM_RANGE_START     = 0xf000,
 	M0_AVI_DTM0_RANGE_START    = 0xf200,
+	M0_AVI_CM_RANGE_START      = 0xf400,
 
 	/**
 	 * Ranges reserved for using in external projects (S3, NFS)
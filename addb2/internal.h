@@ -92,6 +92,40 @@ enum {
 	M0_ADDB2_GLOBAL_PHILTERS = 512
 };
 
+enum {
+	/**
+	 * Granularity (in identifiers) of m0_addb2_filter_level_set(). Smallest
+	 * distance between per-module range starts in addb2/identifier.h.
+	 */
+	M0_ADDB2_FILTER_GRAIN     = 0x200,
+	M0_ADDB2_FILTER_LEVEL_NR  = 0x10000 / M0_ADDB2_FILTER_GRAIN,
+	/**
+	 * Number of fom type identifiers that can be disabled by
+	 * m0_addb2_filter_opcode_set(). Fop opcodes are 12 bits, see
+	 * M0_AVI_FOP_TYPES_RANGE_START.
+	 */
+	M0_ADDB2_FILTER_OPCODE_NR = 0x1000
+};
+
+/**
+ * Run-time trace filter, see m0_addb2_filter_level_set().
+ */
+struct m0_addb2_filter {
+	/**
+	 * True iff any filtering is configured. Allows the common case to skip
+	 * the checks.
+	 */
+	bool     af_active;
+	/** Sampling rate for ranges with M0_ADDB2_LEVEL_SAMPLED level. */
+	uint32_t af_rate;
+	/** Sampling rate for M0_AVI_PHASE and M0_AVI_STATE records. */
+	uint32_t af_phase_rate;
+	/** enum m0_addb2_level, indexed by id / M0_ADDB2_FILTER_GRAIN. */
+	uint8_t  af_level[M0_ADDB2_FILTER_LEVEL_NR];
+	/** Bitmap of disabled fom types. */
+	uint64_t af_opmute[M0_ADDB2_FILTER_OPCODE_NR / 64];
+};
+
 /**
  * Global addb2 state (per m0 instance).
  */
@@ -104,6 +138,10 @@ struct m0_addb2_module {
 	 * Array of global philters.
 	 */
 	struct m0_addb2_philter *am_philter[M0_ADDB2_GLOBAL_PHILTERS];
+	/**
+	 * Trace filter.
+	 */
+	struct m0_addb2_filter   am_filter;
 };
 
 M0_INTERNAL struct m0_addb2_module *m0_addb2_module_get(void);
@@ -83,6 +83,11 @@ struct m0_addb2_sit {
 	 */
 	m0_bindex_t                  s_trace_idx;
 	bool                         s_fired;
+	/**
+	 * If true, iteration stops at the end of the first frame, see
+	 * m0_addb2_sit_frame_init().
+	 */
+	bool                         s_single;
 };
 
 static bool header_is_valid(const struct m0_addb2_sit *it,
@@ -136,6 +141,58 @@ int m0_addb2_sit_init(struct m0_addb2_sit **out,
 	return result;
 }
 
+int m0_addb2_sit_frame_init(struct m0_addb2_sit **out, struct m0_stob *stob,
+			    const struct m0_addb2_frame_header *h)
+{
+	struct m0_addb2_frame_header  copy = *h;
+	struct m0_addb2_sit          *it;
+	int                           result;
+
+	M0_PRE(h->he_offset != 0);
+
+	M0_ALLOC_PTR(it);
+	if (it == NULL)
+		return M0_ERR(-ENOMEM);
+	result = it_alloc(it, stob);
+	if (result == 0) {
+		it->s_size   = h->he_stob_size;
+		it->s_single = true;
+		m0_addb2_source_init(&it->s_src);
+		result = it_init(it, &copy, h->he_offset);
+		if (result == 0)
+			*out = it;
+		else
+			m0_addb2_sit_fini(it);
+	} else
+		m0_free(it);
+	return M0_RC(result);
+}
+
+int m0_addb2_sit_frames(struct m0_stob *stob, m0_bindex_t start,
+			int (*frame)(const struct m0_addb2_frame_header *h,
+				     void *datum),
+			void *datum)
+{
+	struct m0_addb2_frame_header  h;
+	struct m0_addb2_frame_header  next;
+	struct m0_addb2_sit          *it;
+	int                           result;
+
+	result = m0_addb2_sit_init(&it, stob, start);
+	if (result != 0)
+		return M0_RC(result);
+	h = it->s_current;
+	while ((result = frame(&h, datum)) == 0) {
+		/* Same termination condition as in it_next(). */
+		if (header_read(it, &next, header_next(it, &h)) != 0 ||
+		    next.he_seqno != h.he_seqno + 1)
+			break;
+		h = next;
+	}
+	m0_addb2_sit_fini(it);
+	return M0_RC(result);
+}
+
 void m0_addb2_sit_fini(struct m0_addb2_sit *it)
 {
 	if (it->s_cursor.cu_trace != NULL)
@@ -305,6 +362,8 @@ static int it_next(struct m0_addb2_sit *it, struct m0_addb2_record **out)
 		it->s_trace_ptr += it->s_trace.tr_nr + 1;
 		it_trace_set(it);
 		result = +1;
+	} else if (it->s_single) {
+		result = 0;
 	} else {
 		next.he_offset = header_next(it, h);
 		/*
@@ -596,6 +596,7 @@ static int frame_init(struct frame *frame, struct m0_addb2_storage *stor)
 		frame->f_buf[0] = frame->f_area;
 		frame->f_buf[1] = frame->f_area + BSIZE;
 		io->si_opcode = SIO_WRITE;
+		io->si_class  = SIC_BACKGROUND;
 		io->si_user   = (struct m0_bufvec) {
 			.ov_vec = {
 				.v_nr    = ARRAY_SIZE(frame->f_count),
@@ -183,6 +183,28 @@ void m0_addb2_sit_fini(struct m0_addb2_sit *it);
  */
 struct m0_addb2_source *m0_addb2_sit_source(struct m0_addb2_sit *it);
 
+/**
+ * Calls "frame" for headers of all frames on the stob, oldest first, without
+ * reading frame bodies. "start" has the same meaning as in m0_addb2_sit_init().
+ *
+ * Iteration stops when "frame" returns non-zero, this value is returned.
+ */
+int  m0_addb2_sit_frames(struct m0_stob *stob, m0_bindex_t start,
+			 int (*frame)(const struct m0_addb2_frame_header *h,
+				      void *datum),
+			 void *datum);
+
+/**
+ * Initialises the iterator over the records of a single frame. Only
+ * h->he_offset and h->he_stob_size are used, as returned by
+ * m0_addb2_sit_frames().
+ *
+ * Frames are independent: iterators over different frames of the same stob
+ * can be used concurrently.
+ */
+int  m0_addb2_sit_frame_init(struct m0_addb2_sit **out, struct m0_stob *stob,
+			     const struct m0_addb2_frame_header *h);
+
 /** @} end of addb2 group */
 #endif /* __MOTR_ADDB2_STORAGE_H__ */
 
@@ -52,6 +52,19 @@
  * All back-end processing is done in the AST context. The AST is posted to the
  * current locality by sys_post().
  *
+ * Submission of traces (m0_addb2_sys_submit()) takes no locks in the common
+ * case: a trace is pushed onto a lock-free stack (m0_addb2_sys::sy_stack) and
+ * only the submitter that finds the stack empty posts the AST. The AST moves
+ * all the stacked traces to m0_addb2_sys::sy_queue in submission order
+ * (sys_queue_grab()) and hands them to the back-end.
+ *
+ * The AST cannot be posted before m0_addb2_sys_sm_start() or after
+ * m0_addb2_sys_sm_stop(), and the queue is not drained while there is no
+ * back-end. Traces submitted meanwhile are picked up by the AST that
+ * m0_addb2_sys_sm_start(), m0_addb2_sys_net_start(),
+ * m0_addb2_sys_stor_start() and m0_addb2_sys_attach() post when there are
+ * pending traces (sys_kick()).
+ *
  * @{
  */
 
@@ -61,6 +74,7 @@
 #include "lib/arith.h"                  /* M0_CNT_DEC, M0_CNT_INC */
 #include "lib/errno.h"                  /* ENOMEM */
 #include "lib/memory.h"                 /* M0_ALLOC_PTR, m0_free */
+#include "lib/atomic.h"                 /* m0_atomic64_cas_ptr */
 #include "lib/finject.h"
 #include "lib/locality.h"
 #include "lib/trace.h"
@@ -85,8 +99,8 @@ struct m0_addb2_sys {
 	 */
 	struct m0_addb2_config   sy_conf;
 	/**
-	 * Lock for all fields of this structure, except for ->sy_queue,
-	 * ->sy_queued and ->sy_astwait.
+	 * Lock for all fields of this structure, except for ->sy_stack,
+	 * ->sy_queued, ->sy_ast and ->sy_astwait.
 	 */
 	struct m0_mutex          sy_lock;
 	/**
@@ -97,23 +111,30 @@ struct m0_addb2_sys {
 	 * Network back-end.
 	 */
 	struct m0_addb2_net     *sy_net;
+	/**
+	 * Lock-free stack of submitted traces (linked through
+	 * m0_addb2_trace_obj::o_next), the most recent first.
+	 *
+	 * Traces are pushed by m0_addb2_sys_submit() and moved to ->sy_queue
+	 * by sys_queue_grab().
+	 */
+	struct m0_addb2_trace_obj *sy_stack;
 	/**
 	 * Addb2 trace queue.
 	 *
-	 * Addb2 traces are queued on this list (via
-	 * m0_addb2_trace_obj::o_linkage, tr_tlist) by m0_addb2_sys_submit() and
+	 * Addb2 traces taken off ->sy_stack are queued on this list (via
+	 * m0_addb2_trace_obj::o_linkage, tr_tlist) in submission order and
 	 * de-qeued in the AST context by sys_balance().
 	 */
 	struct m0_tl             sy_queue;
 	/**
-	 * Length of ->sy_queue.
+	 * Total number of records in ->sy_stack and ->sy_queue.
 	 */
-	m0_bcount_t              sy_queued;
+	struct m0_atomic64       sy_queued;
 	/**
-	 * This lock protects for ->sy_queue, ->sy_queued and ->sy_astwait. A
-	 * separate lock is needed to make it possible to call
-	 * m0_addb2_sys_submit() under other locks. ->sy_qlock nests within
-	 * ->sy_lock.
+	 * This lock protects ->sy_ast and ->sy_astwait. A separate lock is
+	 * needed to make it possible to call m0_addb2_sys_submit() under other
+	 * locks. ->sy_qlock nests within ->sy_lock.
 	 */
 	struct m0_mutex          sy_qlock;
 	struct m0_sm_ast         sy_ast;
@@ -155,12 +176,14 @@ struct m0_addb2_sys {
 
 static void sys_ast(struct m0_sm_group *grp, struct m0_sm_ast *ast);
 static void sys_post(struct m0_addb2_sys *sys);
+static void sys_kick(struct m0_addb2_sys *sys);
 static void sys_idle(struct m0_addb2_mach *mach);
 static void sys_lock(struct m0_addb2_sys *sys);
 static void sys_unlock(struct m0_addb2_sys *sys);
 static void sys_qlock(struct m0_addb2_sys *sys);
 static void sys_qunlock(struct m0_addb2_sys *sys);
 static void sys_balance(struct m0_addb2_sys *sys);
+static void sys_queue_grab(struct m0_addb2_sys *sys);
 static bool sys_invariant(const struct m0_addb2_sys *sys);
 static bool sys_queue_invariant(const struct m0_addb2_sys *sys);
 static int  sys_submit(struct m0_addb2_mach *mach,
@@ -199,6 +222,7 @@ int m0_addb2_sys_init(struct m0_addb2_sys **out,
 		 */
 		sys->sy_astwait.aw_allowed = false;
 		tr_tlist_init(&sys->sy_queue);
+		m0_atomic64_set(&sys->sy_queued, 0);
 		mach_tlist_init(&sys->sy_pool);
 		mach_tlist_init(&sys->sy_granted);
 		mach_tlist_init(&sys->sy_moribund);
@@ -232,15 +256,17 @@ void m0_addb2_sys_fini(struct m0_addb2_sys *sys)
 	sys_lock(sys);
 	sys_balance(sys);
 	sys_unlock(sys);
-	if (sys->sy_queued > 0)
+	sys_queue_grab(sys);
+	if (m0_atomic64_get(&sys->sy_queued) > 0)
 		M0_LOG(M0_NOTICE, "Records lost: %" PRIi64 "/%zi.",
-		       sys->sy_queued, tr_tlist_length(&sys->sy_queue));
+		       m0_atomic64_get(&sys->sy_queued),
+		       tr_tlist_length(&sys->sy_queue));
 	m0_tl_teardown(tr, &sys->sy_queue, to) {
 		/*
 		 * Update the counter *before* calling m0_addb2_trace_done(),
 		 * because it might invoke sys_invariant() via sys_idle().
 		 */
-		sys->sy_queued -= to->o_tr.tr_nr;
+		m0_atomic64_sub(&sys->sy_queued, to->o_tr.tr_nr);
 		m0_addb2_trace_done(&to->o_tr);
 	}
 	m0_tl_for(mach, &sys->sy_moribund, m) {
@@ -315,6 +341,8 @@ int m0_addb2_sys_net_start(struct m0_addb2_sys *sys)
 
 	sys_lock(sys);
 	sys->sy_net = m0_addb2_net_init();
+	if (sys->sy_net != NULL)
+		sys_kick(sys);
 	sys_unlock(sys);
 	return sys->sy_net != NULL ? 0 : M0_ERR(-ENOMEM);
 }
@@ -363,6 +391,8 @@ int m0_addb2_sys_stor_start(struct m0_addb2_sys *sys, const char *location,
 	sys_lock(sys);
 	sys->sy_stor = m0_addb2_storage_init(location, key, mkfs, force,
 					     &sys_stor_ops, size, sys);
+	if (sys->sy_stor != NULL)
+		sys_kick(sys);
 	sys_unlock(sys);
 	return sys->sy_stor != NULL ? 0 : M0_ERR(-ENOMEM);
 }
@@ -379,6 +409,7 @@ void m0_addb2_sys_sm_start(struct m0_addb2_sys *sys)
 	sys_qlock(sys);
 	sys->sy_astwait.aw_allowed = true;
 	sys_qunlock(sys);
+	sys_kick(sys);
 }
 
 void m0_addb2_sys_sm_stop(struct m0_addb2_sys *sys)
@@ -392,17 +423,29 @@ void m0_addb2_sys_sm_stop(struct m0_addb2_sys *sys)
 int m0_addb2_sys_submit(struct m0_addb2_sys *sys,
 			struct m0_addb2_trace_obj *obj)
 {
-	sys_qlock(sys);
-	if (sys->sy_queued + obj->o_tr.tr_nr <= sys->sy_conf.co_queue_max) {
-		sys->sy_queued += obj->o_tr.tr_nr;
-		tr_tlink_init_at_tail(obj, &sys->sy_queue);
-		sys_post(sys);
-	} else {
+	struct m0_addb2_trace_obj *head;
+	int64_t                    nr = obj->o_tr.tr_nr;
+
+	if (m0_atomic64_add_return(&sys->sy_queued, nr) >
+	    sys->sy_conf.co_queue_max) {
+		m0_atomic64_sub(&sys->sy_queued, nr);
 		M0_LOG(M0_DEBUG, "Queue overflow.");
-		obj = NULL;
+		return 0;
 	}
-	sys_qunlock(sys);
-	return obj != NULL;
+	do {
+		head = *(struct m0_addb2_trace_obj * volatile *)&sys->sy_stack;
+		obj->o_next = head;
+	} while (!m0_atomic64_cas_ptr((void **)&sys->sy_stack, head, obj));
+	/*
+	 * Whoever makes the stack non-empty posts the AST, which takes all the
+	 * traces stacked by the moment it runs.
+	 */
+	if (head == NULL) {
+		sys_qlock(sys);
+		sys_post(sys);
+		sys_qunlock(sys);
+	}
+	return 1;
 }
 
 void m0_addb2_sys_attach(struct m0_addb2_sys *sys, struct m0_addb2_sys *src)
@@ -410,6 +453,7 @@ void m0_addb2_sys_attach(struct m0_addb2_sys *sys, struct m0_addb2_sys *src)
 	sys_lock(sys);
 	sys->sy_net  = src->sy_net;
 	sys->sy_stor = src->sy_stor;
+	sys_kick(sys);
 	sys_unlock(sys);
 }
 
@@ -446,18 +490,15 @@ static void sys_balance(struct m0_addb2_sys *sys)
 
 	M0_PRE(sys_invariant(sys));
 	if (sys->sy_stor != NULL || sys->sy_net != NULL) {
-		sys_qlock(sys);
+		sys_queue_grab(sys);
 		while ((obj = tr_tlist_pop(&sys->sy_queue)) != NULL) {
-			sys->sy_queued -= obj->o_tr.tr_nr;
-			sys_qunlock(sys);
+			m0_atomic64_sub(&sys->sy_queued, obj->o_tr.tr_nr);
 			if (m0_get()->i_disable_addb2_storage ||
 			    (sys->sy_stor != NULL ?
 			     m0_addb2_storage_submit(sys->sy_stor, obj) :
 			     m0_addb2_net_submit(sys->sy_net, obj)) == 0)
 				m0_addb2_trace_done(&obj->o_tr);
-			sys_qlock(sys);
 		}
-		sys_qunlock(sys);
 	}
 	m0_tl_teardown(mach, &sys->sy_deathrow, m) {
 		m0_addb2_mach_fini(m);
@@ -466,6 +507,32 @@ static void sys_balance(struct m0_addb2_sys *sys)
 	M0_POST(sys_invariant(sys));
 }
 
+/**
+ * Moves all the traces from the lock-free stack to the tail of the queue,
+ * restoring the submission order.
+ */
+static void sys_queue_grab(struct m0_addb2_sys *sys)
+{
+	struct m0_addb2_trace_obj *head;
+	struct m0_addb2_trace_obj *fifo = NULL;
+	struct m0_addb2_trace_obj *next;
+
+	do {
+		head = *(struct m0_addb2_trace_obj * volatile *)&sys->sy_stack;
+	} while (head != NULL &&
+		 !m0_atomic64_cas_ptr((void **)&sys->sy_stack, head, NULL));
+	for (; head != NULL; head = next) {
+		next = head->o_next;
+		head->o_next = fifo;
+		fifo = head;
+	}
+	for (; fifo != NULL; fifo = next) {
+		next = fifo->o_next;
+		fifo->o_next = NULL;
+		tr_tlink_init_at_tail(fifo, &sys->sy_queue);
+	}
+}
+
 void (*m0_addb2__sys_submit_trap)(struct m0_addb2_sys *sys,
 				  struct m0_addb2_trace_obj *obj) = NULL;
 
@@ -491,6 +558,19 @@ static void sys_post(struct m0_addb2_sys *sys)
 				    m0_locality_here()->lo_grp, &sys->sy_ast);
 }
 
+/**
+ * Posts the AST if there are traces that no AST is going to pick up, because
+ * they were submitted while the AST could not be posted or there was no
+ * back-end.
+ */
+static void sys_kick(struct m0_addb2_sys *sys)
+{
+	sys_qlock(sys);
+	if (m0_atomic64_get(&sys->sy_queued) > 0)
+		sys_post(sys);
+	sys_qunlock(sys);
+}
+
 /**
  * Implementation of m0_addb2_mach_ops::apo_idle().
  *
@@ -568,6 +648,11 @@ static void sys_ast(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 		M0_SET0(counter);
 		m0_addb2_counter_add(counter, id, -1);
 	}
+	/*
+	 * Empty the stack even without a back-end, so that the next submitter
+	 * posts the AST again.
+	 */
+	sys_queue_grab(sys);
 	sys_balance(sys);
 	sys_qlock(sys);
 	m0_sm_ast_wait_signal(&sys->sy_astwait);
@@ -679,16 +764,16 @@ static bool sys_invariant(const struct m0_addb2_sys *sys)
 	return  _0C(m0_mutex_is_locked(&sys->sy_lock)) &&
 		_0C(m0_thread_tls()->tls_addb2_mach == NULL) && /* sys_lock() */
 		_0C(M0_CHECK_EX(sys_size(sys) == sys->sy_total)) &&
-		_0C(sys->sy_total <= sys->sy_conf.co_pool_max);
+		_0C(sys->sy_total <= sys->sy_conf.co_pool_max) &&
+		/* Submitters account records before stacking them. */
+		_0C(M0_CHECK_EX(m0_tl_reduce(tr, t, &sys->sy_queue,
+					     0, + t->o_tr.tr_nr) <=
+				m0_atomic64_get(&sys->sy_queued)));
 }
 
 static bool sys_queue_invariant(const struct m0_addb2_sys *sys)
 {
-	return  _0C(m0_mutex_is_locked(&sys->sy_qlock)) &&
-		_0C(sys->sy_queued <= sys->sy_conf.co_queue_max) &&
-		_0C(M0_CHECK_EX(sys->sy_queued == m0_tl_reduce(tr, t,
-						       &sys->sy_queue,
-						       0, + t->o_tr.tr_nr)));
+	return  _0C(m0_mutex_is_locked(&sys->sy_qlock));
 }
 
 #undef M0_TRACE_SUBSYSTEM
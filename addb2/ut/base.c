@@ -24,6 +24,7 @@
 #include "lib/trace.h"
 #include "ut/ut.h"
 #include "addb2/addb2.h"
+#include "addb2/identifier.h"
 
 #include "addb2/ut/common.h"
 
@@ -428,6 +429,112 @@ static void sensor_depth(void)
 	M0_UT_ASSERT(found == seq);
 }
 
+/**
+ * "filter-level" test: disable a range, sample another one; check that the
+ * generated trace contains only the selected records.
+ */
+static void filter_level(void)
+{
+	struct m0_addb2_mach *m;
+	int                   i;
+
+	shouldbe = &(struct m0_addb2_trace) {
+		.tr_body = (uint64_t[]){
+			0x2000000000000000 | LABEL_ID_0,   /* DATA 17, 0 */
+			SKIPME,                            /* time-stamp */
+			0x2000000000000000 | (M0_AVI_LIB_RANGE_START + 1),
+			SKIPME,                            /* time-stamp */
+			0x2000000000000000 | (M0_AVI_LIB_RANGE_START + 1),
+			SKIPME,                            /* time-stamp */
+			END
+		}
+	};
+
+	m0_addb2_filter_level_set(M0_AVI_GENERAL_RANGE_START,
+				  M0_AVI_FOM_RANGE_START, M0_ADDB2_LEVEL_OFF);
+	m0_addb2_filter_level_set(M0_AVI_LIB_RANGE_START,
+				  M0_AVI_RM_RANGE_START,
+				  M0_ADDB2_LEVEL_SAMPLED);
+	m0_addb2_filter_rate_set(3);
+	m = mach_set(&check_submit);
+	m0_addb2_add(M0_AVI_GENERAL_RANGE_START + 1, 0, NULL);
+	m0_addb2_add(LABEL_ID_0, 0, NULL);
+	for (i = 0; i < 4; ++i)
+		m0_addb2_add(M0_AVI_LIB_RANGE_START + 1, 0, NULL);
+	mach_put(m);
+	m0_addb2_filter_reset();
+}
+
+/**
+ * "filter-phase" test: check 1-in-N sampling of state transition records.
+ */
+static void filter_phase(void)
+{
+	struct m0_addb2_mach *m;
+	int                   i;
+
+	shouldbe = &(struct m0_addb2_trace) {
+		.tr_body = (uint64_t[]){
+			0x2100000000000000 | M0_AVI_PHASE, /* DATA PHASE, 1 */
+			SKIPME,                            /* time-stamp */
+			payload[0],
+			0x2100000000000000 | M0_AVI_PHASE, /* DATA PHASE, 1 */
+			SKIPME,                            /* time-stamp */
+			payload[2],
+			END
+		}
+	};
+
+	m0_addb2_filter_phase_rate_set(2);
+	m = mach_set(&check_submit);
+	for (i = 0; i < 4; ++i)
+		m0_addb2_add(M0_AVI_PHASE, 1, payload + i);
+	mach_put(m);
+	m0_addb2_filter_reset();
+}
+
+/**
+ * "filter-opcode" test: disable a fom type, check that nothing is placed in the
+ * trace while a fom of this type is in the context.
+ */
+static void filter_opcode(void)
+{
+	struct m0_addb2_mach *m;
+
+	shouldbe = &(struct m0_addb2_trace) {
+		.tr_body = (uint64_t[]){
+			0x1000000000000000 | LABEL_ID_0,   /* PUSH 17, 0 */
+			SKIPME,                            /* time-stamp */
+			0x2000000000000000 | (LABEL_ID_0 + 3), /* DATA 1a, 0 */
+			SKIPME,                            /* time-stamp */
+			0x1200000000000000 | M0_AVI_FOM,   /* PUSH FOM, 2 */
+			SKIPME,                            /* time-stamp */
+			1,
+			8,
+			0xf000000000000000 | M0_AVI_FOM,   /* POP */
+			SKIPME,                            /* time-stamp */
+			0xf000000000000000 | LABEL_ID_0,   /* POP */
+			SKIPME,                            /* time-stamp */
+			END
+		}
+	};
+
+	m0_addb2_filter_opcode_set(7, false);
+	m = mach_set(&check_submit);
+	m0_addb2_push(LABEL_ID_0, 0, NULL);
+	M0_ADDB2_PUSH(M0_AVI_FOM, 1, 7);
+	m0_addb2_add(LABEL_ID_0 + 1, 0, NULL);
+	m0_addb2_push(LABEL_ID_0 + 2, 0, NULL);
+	m0_addb2_pop(LABEL_ID_0 + 2);
+	m0_addb2_pop(M0_AVI_FOM);
+	m0_addb2_add(LABEL_ID_0 + 3, 0, NULL);
+	M0_ADDB2_PUSH(M0_AVI_FOM, 1, 8);
+	m0_addb2_pop(M0_AVI_FOM);
+	m0_addb2_pop(LABEL_ID_0);
+	mach_put(m);
+	m0_addb2_filter_reset();
+}
+
 struct m0_ut_suite addb2_base_ut = {
 	.ts_name = "addb2-base",
 	.ts_init = NULL,
@@ -443,6 +550,9 @@ struct m0_ut_suite addb2_base_ut = {
 		{ "full",          &full },
 		{ "stop-idle",     &stop_idle },
 		{ "sensor-depth",  &sensor_depth },
+		{ "filter-level",  &filter_level },
+		{ "filter-phase",  &filter_phase },
+		{ "filter-opcode", &filter_opcode },
 		{ NULL, NULL }
 	}
 };
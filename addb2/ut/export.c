@@ -0,0 +1,212 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2015-2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_UT
+
+#include <string.h>                    /* strstr */
+#include <unistd.h>                    /* close */
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "lib/trace.h"
+#include "lib/errno.h"                 /* EEXIST, ENOSPC, EINVAL */
+#include "ut/ut.h"
+#include "addb2/addb2.h"
+#include "addb2/counter.h"
+#include "addb2/histogram.h"
+#include "addb2/export.h"
+
+#include "addb2/ut/common.h"
+
+enum {
+	LABEL   = 0x17,
+	COUNTER = 0x18,
+	HIST    = 0x19,
+	GAUGE   = 0x1a
+};
+
+static struct m0_addb2_export ex;
+static char                   text[4096];
+
+static int null_submit(const struct m0_addb2_mach *mach,
+		       struct m0_addb2_trace *trace)
+{
+	return 0;
+}
+
+static void export_setup(void)
+{
+	int rc;
+
+	M0_SET0(&ex);
+	rc = m0_addb2_export_init(&ex, 3);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_addb2_export_metric_add(&ex, HIST, "ut_hist", M0_AEK_HIST) ?:
+		m0_addb2_export_metric_add(&ex, COUNTER, "ut_counter",
+					   M0_AEK_COUNTER) ?:
+		m0_addb2_export_metric_add(&ex, GAUGE, "ut_gauge",
+					   M0_AEK_GAUGE);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_addb2_export_metric_add(&ex, GAUGE, "ut_dup", M0_AEK_GAUGE);
+	M0_UT_ASSERT(rc == -EEXIST);
+	rc = m0_addb2_export_metric_add(&ex, GAUGE + 1, "ut_more",
+					M0_AEK_GAUGE);
+	M0_UT_ASSERT(rc == -ENOSPC);
+	m0_addb2_export_start(&ex);
+}
+
+/**
+ * Produces counter, histogram and gauge records in a test machine.
+ */
+static void export_produce(void)
+{
+	struct m0_addb2_mach   *m;
+	struct m0_addb2_counter c = {};
+	struct m0_addb2_hist    h = {};
+	uint64_t                gauge = 42;
+
+	m = mach_set(&null_submit);
+	m0_addb2_push(LABEL, 0, NULL);
+	m0_addb2_counter_add(&c, COUNTER, -1);
+	m0_addb2_hist_add(&h, 0, 100, HIST, -1);
+	m0_addb2_counter_mod(&c, 1);
+	m0_addb2_counter_mod(&c, 2);
+	m0_addb2_counter_mod(&c, 3);
+	m0_addb2_hist_mod(&h, 5);
+	m0_addb2_hist_mod(&h, 50);
+	m0_addb2_hist_mod(&h, 150);
+	/* Data record with the counter identifier, must be ignored. */
+	M0_ADDB2_ADD(COUNTER, 1000, 1000);
+	m0_addb2_add(GAUGE, 1, &gauge);
+	m0_addb2_counter_del(&c);
+	m0_addb2_hist_del(&h);
+	m0_addb2_pop(LABEL);
+	mach_put(m);
+}
+
+static void export_teardown(void)
+{
+	m0_addb2_export_stop(&ex);
+	m0_addb2_export_fini(&ex);
+}
+
+/**
+ * "export-text" test: produce some records, check the text format output.
+ */
+static void export_text(void)
+{
+	int rc;
+
+	export_setup();
+	rc = m0_addb2_export_text(&ex, text, sizeof text);
+	M0_UT_ASSERT(rc > 0);
+	M0_UT_ASSERT(strstr(text, "ut_counter_count 0\n") != NULL);
+	M0_UT_ASSERT(strstr(text, "ut_counter_min") == NULL);
+	export_produce();
+	rc = m0_addb2_export_text(&ex, text, sizeof text);
+	M0_UT_ASSERT(rc == strlen(text));
+	M0_UT_ASSERT(strstr(text, "# TYPE ut_counter summary\n") != NULL);
+	M0_UT_ASSERT(strstr(text, "ut_counter_sum 6\n") != NULL);
+	M0_UT_ASSERT(strstr(text, "ut_counter_count 3\n") != NULL);
+	M0_UT_ASSERT(strstr(text, "ut_counter_min 1\n") != NULL);
+	M0_UT_ASSERT(strstr(text, "ut_counter_max 3\n") != NULL);
+	M0_UT_ASSERT(strstr(text, "# TYPE ut_hist histogram\n") != NULL);
+	M0_UT_ASSERT(strstr(text, "ut_hist_bucket{le=\"0\"} 0\n") != NULL);
+	M0_UT_ASSERT(strstr(text, "ut_hist_bucket{le=\"8\"} 1\n") != NULL);
+	M0_UT_ASSERT(strstr(text, "ut_hist_bucket{le=\"+Inf\"} 3\n") != NULL);
+	M0_UT_ASSERT(strstr(text, "ut_hist_sum 205\n") != NULL);
+	M0_UT_ASSERT(strstr(text, "ut_gauge 42\n") != NULL);
+	/* Counters are cumulative. */
+	export_produce();
+	rc = m0_addb2_export_text(&ex, text, sizeof text);
+	M0_UT_ASSERT(rc > 0);
+	M0_UT_ASSERT(strstr(text, "ut_counter_count 6\n") != NULL);
+	M0_UT_ASSERT(strstr(text, "ut_hist_sum 410\n") != NULL);
+	rc = m0_addb2_export_text(&ex, text, 10);
+	M0_UT_ASSERT(rc == -ENOSPC);
+	export_teardown();
+}
+
+/**
+ * "export-push" test: receive pushed metrics over a UDP socket.
+ */
+static void export_push(void)
+{
+	struct sockaddr_in sin = {
+		.sin_family      = AF_INET,
+		.sin_addr.s_addr = htonl(INADDR_LOOPBACK)
+	};
+	socklen_t          len = sizeof sin;
+	struct timeval     tv  = { .tv_sec = 10 };
+	ssize_t            nr;
+	int                sock;
+	int                rc;
+
+	sock = socket(AF_INET, SOCK_DGRAM, 0);
+	M0_UT_ASSERT(sock >= 0);
+	rc = bind(sock, (void *)&sin, sizeof sin) ?:
+		getsockname(sock, (void *)&sin, &len) ?:
+		setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv);
+	M0_UT_ASSERT(rc == 0);
+	export_setup();
+	export_produce();
+	rc = m0_addb2_export_push_start(&ex, "127.0.0.1", ntohs(sin.sin_port),
+					M0_TIME_ONE_MSEC * 10);
+	M0_UT_ASSERT(rc == 0);
+	nr = recv(sock, text, sizeof text - 1, 0);
+	M0_UT_ASSERT(nr > 0);
+	text[nr] = 0;
+	M0_UT_ASSERT(strstr(text, "ut_counter_count 3\n") != NULL);
+	M0_UT_ASSERT(strstr(text, "ut_gauge 42\n") != NULL);
+	m0_addb2_export_push_stop(&ex);
+	rc = m0_addb2_export_push_start(&ex, "no-such-address", 1,
+					M0_TIME_ONE_MSEC);
+	M0_UT_ASSERT(rc == -EINVAL);
+	export_teardown();
+	close(sock);
+}
+
+struct m0_ut_suite addb2_export_ut = {
+	.ts_name = "addb2-export",
+	.ts_init = NULL,
+	.ts_fini = NULL,
+	.ts_tests = {
+		{ "export-text", &export_text },
+		{ "export-push", &export_push },
+		{ NULL, NULL }
+	}
+};
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -37,6 +37,8 @@
 #include "addb2/sys.h"
 
 #include "addb2/ut/common.h"
+#include "lib/atomic.h"
+#include "ut/threads.h"                /* M0_UT_THREADS_DEFINE */
 
 static const struct m0_addb2_config noqueue = {
 		.co_buffer_size = 4096,
@@ -268,6 +270,127 @@ static void sm_add(void)
 	m0_semaphore_fini(&ast_wait);
 }
 
+enum {
+	/** How long to wait for the sys AST, in seconds. */
+	AST_WAIT_SEC = 5
+};
+
+/*
+ * Traces submitted before m0_addb2_sys_sm_start() and before a back-end is
+ * started are picked up by the AST posted by the start functions.
+ */
+static void sm_late(void)
+{
+	struct m0_addb2_sys   *s;
+	struct m0_addb2_mach  *m;
+	struct m0_addb2_config longqueue = queue;
+	struct m0_addb2_mach  *orig;
+	struct m0_thread_tls  *tls = m0_thread_tls();
+	int                    result;
+
+	longqueue.co_queue_max = 1000000;
+	m0_addb2__sys_submit_trap = &submit_trap;
+	m0_addb2__sys_ast_trap = &ast_trap;
+	m0_semaphore_init(&ast_wait, 0);
+	sys_submitted = 0;
+	m0_fi_enable("sys_submit", "trap");
+	m0_fi_enable("sys_ast", "trap");
+
+	result = m0_addb2_sys_init(&s, &longqueue);
+	M0_UT_ASSERT(result == 0);
+	m = m0_addb2_sys_get(s);
+	M0_UT_ASSERT(m != NULL);
+	orig = tls->tls_addb2_mach;
+	tls->tls_addb2_mach = m;
+
+	/* No AST can be posted yet. */
+	while (sys_submitted == 0)
+		M0_ADDB2_ADD(1132);
+	m0_addb2_sys_sm_start(s);
+	/* The AST takes the traces off the stack, there is no back-end. */
+	M0_UT_ASSERT(m0_semaphore_timeddown(&ast_wait,
+				m0_time_from_now(AST_WAIT_SEC, 0)));
+	/* The AST hands the queued traces to the new back-end. */
+	result = m0_addb2_sys_net_start(s);
+	M0_UT_ASSERT(result == 0);
+	M0_UT_ASSERT(m0_semaphore_timeddown(&ast_wait,
+				m0_time_from_now(AST_WAIT_SEC, 0)));
+	m0_addb2__sys_ast_trap = NULL;
+
+	tls->tls_addb2_mach = orig;
+	m0_addb2_sys_put(s, m);
+	m0_addb2_sys_net_stop(s);
+	m0_addb2_sys_fini(s);
+
+	m0_fi_disable("sys_submit", "trap");
+	m0_fi_disable("sys_ast", "trap");
+	m0_semaphore_fini(&ast_wait);
+}
+
+enum {
+	MT_THREAD_NR = 8,
+	MT_ADD_NR    = 10000
+};
+
+static struct m0_atomic64 mt_submitted;
+static void mt_submit_trap(struct m0_addb2_sys *sys,
+			   struct m0_addb2_trace_obj *obj)
+{
+	m0_atomic64_inc(&mt_submitted);
+}
+
+struct mt_param {
+	struct m0_addb2_sys *mp_sys;
+	int                  mp_idx;
+};
+
+static void mt_thread(struct mt_param *p)
+{
+	struct m0_thread_tls *tls = m0_thread_tls();
+	struct m0_addb2_mach *orig;
+	struct m0_addb2_mach *m;
+	int                   i;
+
+	m = m0_addb2_sys_get(p->mp_sys);
+	M0_UT_ASSERT(m != NULL);
+	orig = tls->tls_addb2_mach;
+	tls->tls_addb2_mach = m;
+	for (i = 0; i < MT_ADD_NR; ++i)
+		M0_ADDB2_ADD(10 + p->mp_idx, i, 7, 6, 5);
+	tls->tls_addb2_mach = orig;
+	m0_addb2_sys_put(p->mp_sys, m);
+}
+
+M0_UT_THREADS_DEFINE(addb2_sys_mt, &mt_thread);
+
+/* Concurrent submission of traces from several machines. */
+static void queue_mt(void)
+{
+	struct m0_addb2_sys   *s;
+	struct m0_addb2_config conf = queue;
+	struct mt_param        param[MT_THREAD_NR];
+	int                    i;
+	int                    result;
+
+	conf.co_queue_max = 100000000;
+	conf.co_pool_min  = MT_THREAD_NR;
+	conf.co_pool_max  = MT_THREAD_NR;
+	m0_atomic64_set(&mt_submitted, 0);
+	m0_addb2__sys_submit_trap = &mt_submit_trap;
+	m0_fi_enable("sys_submit", "trap");
+	result = m0_addb2_sys_init(&s, &conf);
+	M0_UT_ASSERT(result == 0);
+	for (i = 0; i < MT_THREAD_NR; ++i)
+		param[i] = (struct mt_param) { .mp_sys = s, .mp_idx = i };
+	M0_UT_THREADS_START(addb2_sys_mt, MT_THREAD_NR, param);
+	M0_UT_THREADS_STOP(addb2_sys_mt);
+	/* Each thread fills several 4K buffers. */
+	M0_UT_ASSERT(m0_atomic64_get(&mt_submitted) >= MT_THREAD_NR);
+	m0_addb2_sys_fini(s);
+	m0_fi_disable("sys_submit", "trap");
+	m0_addb2__sys_submit_trap = NULL;
+}
+
 struct m0_ut_suite addb2_sys_ut = {
 	.ts_name = "addb2-sys",
 	.ts_init = NULL,
@@ -281,6 +404,8 @@ struct m0_ut_suite addb2_sys_ut = {
 		{ "noqueue-add",   &noqueue_add,              "Nikita" },
 		{ "queue-add",     &queue_add,                "Nikita" },
 		{ "sm-add",        &sm_add,                   "Nikita" },
+		{ "sm-late",       &sm_late },
+		{ "queue-mt",      &queue_mt,                 "Nikita" },
 		{ NULL, NULL }
 	}
 };
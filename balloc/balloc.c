@@ -32,12 +32,14 @@
 #include "dtm/dtm.h"	   /* m0_dtx */
 #include "be/tx_bulk.h"    /* m0_be_tx_bulk */
 #include "be/op.h"         /* m0_be_op_active */
+#include "be/domain.h"     /* m0_be_domain_is_ready */
 #include "lib/misc.h"	   /* M0_SET0 */
 #include "lib/errno.h"
 #include "lib/arith.h"	   /* min_check, m0_is_po2 */
 #include "lib/memory.h"
 #include "lib/byteorder.h" /* m0_byteorder_cpu_to_be64() */
 #include "lib/locality.h"  /* m0_locality0_get */
+#include "lib/atomic.h"    /* m0_mb */
 #include "balloc.h"
 #include "motr/magic.h"
 
@@ -64,6 +66,8 @@ struct balloc_allocation_context {
 	struct m0_balloc              *bac_ctxt;
 	struct m0_be_tx               *bac_tx;
 	struct m0_balloc_allocate_req *bac_req;
+	/** Stream searched first, NULL if the request has an explicit goal. */
+	struct m0_balloc_stream       *bac_stream;
 	struct m0_ext                  bac_orig; /*< original */
 	struct m0_ext                  bac_goal; /*< after normalization */
 	struct m0_ext                  bac_best; /*< best available */
@@ -220,6 +224,7 @@ static m0_bindex_t zone_start_get(struct m0_balloc_group_info *grp,
 static int allocate_blocks(int cr, struct balloc_allocation_context *bac,
 			   struct m0_balloc_group_info *grp, m0_bcount_t len,
 			   enum m0_balloc_allocation_flag alloc_type);
+static int balloc_try_goal(struct balloc_allocation_context *bac);
 static m0_bcount_t group_spare_freeblocks_get(struct m0_balloc_group_info *grp)
 {
 	return grp->bgi_spare.bzp_freeblocks;
@@ -363,19 +368,91 @@ balloc_bn2gn(m0_bindex_t blockno, struct m0_balloc *cb)
 	return blockno >> cb->cb_sb.bsb_gsbits;
 }
 
+static struct m0_mutex *bgi_mutex(struct m0_balloc_group_info *grp)
+{
+	return &grp->bgi_mutex.bm_u.mutex;
+}
+
+static void balloc_group_info_init(struct m0_balloc_group_info *gi,
+				   struct m0_balloc *cb);
+
+static void balloc_group_free_set(struct m0_balloc *cb,
+				  struct m0_balloc_group_info *gi)
+{
+	cb->cb_group_free[gi->bgi_groupno] =
+		min64u(group_freeblocks_get(gi),
+		       M0_BALLOC_GROUP_FREE_UNKNOWN - 1);
+}
+
+/**
+ * Returns true when the group is known to have less than len free blocks in
+ * the normal zone. The group does not have to be loaded.
+ */
+static bool balloc_group_is_short(const struct m0_balloc *cb,
+				  m0_bindex_t groupno, m0_bcount_t len)
+{
+	uint32_t nr = cb->cb_group_free[groupno];
+
+	return nr != M0_BALLOC_GROUP_FREE_UNKNOWN && nr < len;
+}
+
+/**
+ * Returns the group info, loading the group descriptor on the first use of
+ * the group. Only the group number and the lock are set up at mount.
+ */
 M0_INTERNAL struct m0_balloc_group_info *m0_balloc_gn2info(struct m0_balloc *cb,
 							   m0_bindex_t groupno)
 {
-	return cb->cb_group_info == NULL ? NULL : &cb->cb_group_info[groupno];
+	struct m0_balloc_group_info *gi;
+
+	if (cb->cb_group_info == NULL)
+		return NULL;
+	gi = &cb->cb_group_info[groupno];
+	if (!(gi->bgi_state & M0_BALLOC_GROUP_INFO_INIT)) {
+		m0_mutex_lock(bgi_mutex(gi));
+		if (!(gi->bgi_state & M0_BALLOC_GROUP_INFO_INIT))
+			balloc_group_info_init(gi, cb);
+		m0_mutex_unlock(bgi_mutex(gi));
+	}
+	return gi;
 }
 
-static struct m0_mutex *bgi_mutex(struct m0_balloc_group_info *grp)
+/* Adds the extent to the size index of the zone if the index is built. */
+static void lext_index_add(struct m0_balloc_zone_param *zp,
+			   struct m0_lext              *le)
 {
-	return &grp->bgi_mutex.bm_u.mutex;
+	if (zp->bzp_size_class == NULL)
+		return;
+	le->le_size_class = m0_log2(m0_ext_length(&le->le_ext));
+	M0_ASSERT(le->le_size_class < M0_BALLOC_SIZE_CLASS_NR);
+	m0_list_add(&zp->bzp_size_class[le->le_size_class], &le->le_size_link);
+	zp->bzp_size_class_mask |= M0_BITS(le->le_size_class);
 }
 
-static void lext_del(struct m0_lext *le)
+static void lext_index_del(struct m0_balloc_zone_param *zp,
+			   struct m0_lext              *le)
 {
+	if (zp->bzp_size_class == NULL ||
+	    !m0_list_link_is_in(&le->le_size_link))
+		return;
+	m0_list_del(&le->le_size_link);
+	if (m0_list_is_empty(&zp->bzp_size_class[le->le_size_class]))
+		zp->bzp_size_class_mask &= ~M0_BITS(le->le_size_class);
+}
+
+/* Moves the extent to its size class after the extent length is changed. */
+static void lext_index_update(struct m0_balloc_zone_param *zp,
+			      struct m0_ext               *ex)
+{
+	struct m0_lext *le = container_of(ex, struct m0_lext, le_ext);
+
+	lext_index_del(zp, le);
+	lext_index_add(zp, le);
+}
+
+static void lext_del(struct m0_balloc_zone_param *zp, struct m0_lext *le)
+{
+	lext_index_del(zp, le);
 	m0_list_del(&le->le_link);
 	if (le->le_is_alloc)
 		m0_free(le);
@@ -391,10 +468,116 @@ static struct m0_lext* lext_create(struct m0_ext *ex)
 
 	le->le_is_alloc = true;
 	le->le_ext = *ex;
+	m0_list_link_init(&le->le_size_link);
 
 	return le;
 }
 
+/*
+ * Builds the size index of the zone. Extents which are already in the zone
+ * list are added to the index.
+ */
+static int zone_index_init(struct m0_balloc_zone_param *zp)
+{
+	struct m0_lext *le;
+	int             i;
+
+	if (zp->bzp_size_class != NULL)
+		return 0;
+	M0_ALLOC_ARR(zp->bzp_size_class, M0_BALLOC_SIZE_CLASS_NR);
+	if (zp->bzp_size_class == NULL)
+		return M0_ERR(-ENOMEM);
+	for (i = 0; i < M0_BALLOC_SIZE_CLASS_NR; ++i)
+		m0_list_init(&zp->bzp_size_class[i]);
+	zp->bzp_size_class_mask = 0;
+	m0_list_for_each_entry(&zp->bzp_extents, le, struct m0_lext, le_link) {
+		m0_list_link_init(&le->le_size_link);
+		lext_index_add(zp, le);
+	}
+	return 0;
+}
+
+static void zone_index_fini(struct m0_balloc_zone_param *zp)
+{
+	int i;
+
+	if (zp->bzp_size_class == NULL)
+		return;
+	for (i = 0; i < M0_BALLOC_SIZE_CLASS_NR; ++i)
+		m0_list_fini(&zp->bzp_size_class[i]);
+	m0_free0(&zp->bzp_size_class);
+	zp->bzp_size_class_mask = 0;
+}
+
+static bool zone_index_invariant(struct m0_balloc_zone_param *zp)
+{
+	struct m0_lext *le;
+	size_t          nr = 0;
+	int             i;
+
+	if (zp->bzp_size_class == NULL)
+		return true;
+	m0_list_for_each_entry(&zp->bzp_extents, le, struct m0_lext, le_link) {
+		if (le->le_size_class != m0_log2(m0_ext_length(&le->le_ext)) ||
+		    !m0_list_contains(&zp->bzp_size_class[le->le_size_class],
+				      &le->le_size_link))
+			return false;
+		++nr;
+	}
+	for (i = 0; i < M0_BALLOC_SIZE_CLASS_NR; ++i) {
+		if (m0_list_is_empty(&zp->bzp_size_class[i]) ==
+		    !!(zp->bzp_size_class_mask & M0_BITS(i)))
+			return false;
+		nr -= m0_list_length(&zp->bzp_size_class[i]);
+	}
+	return nr == 0;
+}
+
+/* Length of the longest free extent: it is in the highest size class. */
+static m0_bcount_t zone_index_maxchunk(struct m0_balloc_zone_param *zp)
+{
+	struct m0_lext *le;
+	m0_bcount_t     maxchunk = 0;
+
+	M0_PRE(zp->bzp_size_class != NULL);
+
+	if (zp->bzp_size_class_mask == 0)
+		return 0;
+	m0_list_for_each_entry(&zp->bzp_size_class[
+				       m0_log2(zp->bzp_size_class_mask)],
+			       le, struct m0_lext, le_size_link)
+		maxchunk = max_check(maxchunk, m0_ext_length(&le->le_ext));
+	return maxchunk;
+}
+
+/* Is there a free extent of at least len blocks in the zone? */
+static bool zone_index_has(struct m0_balloc_zone_param *zp, m0_bcount_t len)
+{
+	unsigned        c = m0_log2(len);
+	struct m0_lext *le;
+
+	M0_PRE(zp->bzp_size_class != NULL);
+
+	if (c + 1 < M0_BALLOC_SIZE_CLASS_NR &&
+	    (zp->bzp_size_class_mask & ~(M0_BITS(c + 1) - 1)) != 0)
+		return true;
+	m0_list_for_each_entry(&zp->bzp_size_class[c], le,
+			       struct m0_lext, le_size_link) {
+		if (m0_ext_length(&le->le_ext) >= len)
+			return true;
+	}
+	return false;
+}
+
+M0_INTERNAL bool
+m0_balloc_group_index_invariant(const struct m0_balloc_group_info *grp)
+{
+	struct m0_balloc_group_info *gi = (struct m0_balloc_group_info *)grp;
+
+	return zone_index_invariant(&gi->bgi_normal) &&
+	       zone_index_invariant(&gi->bgi_spare);
+}
+
 static void extents_release(struct m0_balloc_group_info *grp,
 			    enum m0_balloc_allocation_flag zone_type)
 {
@@ -406,7 +589,7 @@ static void extents_release(struct m0_balloc_group_info *grp,
 	zp = is_spare(zone_type) ? &grp->bgi_spare : &grp->bgi_normal;
 	while ((l = m0_list_first(&zp->bzp_extents)) != NULL) {
 		le = m0_list_entry(l, struct m0_lext, le_link);
-		lext_del(le);
+		lext_del(zp, le);
 		++frags;
 	}
 	M0_LOG(M0_DEBUG, "zone_type = %d, grp=%p grpno=%" PRIu64 " list_frags=%d"
@@ -423,6 +606,8 @@ M0_INTERNAL int m0_balloc_release_extents(struct m0_balloc_group_info *grp)
 
 	extents_release(grp, M0_BALLOC_SPARE_ZONE);
 	extents_release(grp, M0_BALLOC_NORMAL_ZONE);
+	zone_index_fini(&grp->bgi_spare);
+	zone_index_fini(&grp->bgi_normal);
 	m0_free0(&grp->bgi_extents);
 	return 0;
 }
@@ -464,8 +649,15 @@ static void balloc_format_init(struct m0_balloc *cb)
 	m0_format_footer_update(cb);
 }
 
-static int balloc_group_info_init(struct m0_balloc_group_info *gi,
-				  struct m0_balloc *cb)
+/**
+   Loads the group descriptor into the group info. The group lock is held.
+
+   A group whose descriptor cannot be read keeps the error in bgi_rc, which is
+   returned by m0_balloc_load_extents() and by the allocations that pick the
+   group.
+ */
+static void balloc_group_info_init(struct m0_balloc_group_info *gi,
+				   struct m0_balloc *cb)
 {
 	struct m0_balloc_group_desc     gd = {};
 	struct m0_balloc_super_block   *sb = &cb->cb_sb;
@@ -476,65 +668,182 @@ static int balloc_group_info_init(struct m0_balloc_group_info *gi,
 	m0_bcount_t                     spare_zone_size;
 	int                             rc;
 
+	M0_PRE(m0_mutex_is_locked(bgi_mutex(gi)));
+
 	groupno = m0_byteorder_cpu_to_be64(gi->bgi_groupno);
 	key = (struct m0_buf)M0_BUF_INIT_PTR(&groupno);
 	rc = btree_lookup_sync(cb->cb_db_group_desc, &key, &val, false);
-	if (rc == 0) {
-		gi->bgi_state   = M0_BALLOC_GROUP_INFO_INIT;
-		gi->bgi_extents = NULL;
-
-		spare_zone_size =
-			m0_stob_ad_spares_calc(cb->cb_sb.bsb_groupsize);
-		normal_zone_size = cb->cb_sb.bsb_groupsize - spare_zone_size;
-
-		balloc_zone_init(&gi->bgi_normal, M0_BALLOC_NORMAL_ZONE,
-				 gd.bgd_groupno << sb->bsb_gsbits,
-				 normal_zone_size,
-				 gd.bgd_freeblocks, gd.bgd_fragments,
-				 gd.bgd_maxchunk);
+	if (rc != 0) {
+		M0_LOG(M0_ERROR, "grp=%"PRIu64" descriptor lookup failed: "
+		       "rc=%d", gi->bgi_groupno, rc);
+		M0_SET0(&gd);
+		gd.bgd_groupno = gi->bgi_groupno;
+	}
+	gi->bgi_rc = rc;
+	gi->bgi_extents = NULL;
+
+	spare_zone_size = m0_stob_ad_spares_calc(cb->cb_sb.bsb_groupsize);
+	normal_zone_size = cb->cb_sb.bsb_groupsize - spare_zone_size;
+
+	balloc_zone_init(&gi->bgi_normal, M0_BALLOC_NORMAL_ZONE,
+			 gd.bgd_groupno << sb->bsb_gsbits,
+			 normal_zone_size,
+			 gd.bgd_freeblocks, gd.bgd_fragments,
+			 gd.bgd_maxchunk);
 #ifdef __SPARE__SPACE__
-		balloc_zone_init(&gi->bgi_spare, M0_BALLOC_SPARE_ZONE,
-				 gd.bgd_sparestart, spare_zone_size,
-				 gd.bgd_spare_freeblocks, gd.bgd_spare_frags,
-				 gd.bgd_spare_maxchunk);
+	balloc_zone_init(&gi->bgi_spare, M0_BALLOC_SPARE_ZONE,
+			 gd.bgd_sparestart, spare_zone_size,
+			 gd.bgd_spare_freeblocks, gd.bgd_spare_frags,
+			 gd.bgd_spare_maxchunk);
 #else
-		balloc_zone_init(&gi->bgi_spare, M0_BALLOC_SPARE_ZONE,
-				 ((gd.bgd_groupno) << sb->bsb_gsbits) +
-				 normal_zone_size,
-				 spare_zone_size, 0, 0, 0);
+	balloc_zone_init(&gi->bgi_spare, M0_BALLOC_SPARE_ZONE,
+			 ((gd.bgd_groupno) << sb->bsb_gsbits) +
+			 normal_zone_size,
+			 spare_zone_size, 0, 0, 0);
 #endif
-		m0_mutex_init(bgi_mutex(gi));
-	}
-	return rc;
+	if (rc == 0)
+		balloc_group_free_set(cb, gi);
+	/* Unlocked readers in m0_balloc_gn2info() see complete zones. */
+	m0_mb();
+	gi->bgi_state = M0_BALLOC_GROUP_INFO_INIT;
 }
 
 static void balloc_group_info_fini(struct m0_balloc_group_info *gi)
 {
 	m0_mutex_fini(bgi_mutex(gi));
-	m0_list_fini(&gi->bgi_normal.bzp_extents);
-	m0_list_fini(&gi->bgi_spare.bzp_extents);
+	if (gi->bgi_state & M0_BALLOC_GROUP_INFO_INIT) {
+		m0_list_fini(&gi->bgi_normal.bzp_extents);
+		m0_list_fini(&gi->bgi_spare.bzp_extents);
+	}
 }
 
+/**
+   Sets up the group info array. Group descriptors are loaded lazily by
+   m0_balloc_gn2info(), so that mount does not read all of them.
+ */
 static int balloc_group_info_load(struct m0_balloc *bal)
 {
 	struct m0_balloc_group_info *gi;
 	m0_bcount_t                  i;
-	int                          rc = 0;
 
-	M0_LOG(M0_INFO, "Loading group info...");
+	M0_LOG(M0_INFO, "Setting up group info...");
+	M0_ALLOC_ARR(bal->cb_group_free, bal->cb_sb.bsb_groupcount);
+	if (bal->cb_group_free == NULL)
+		return M0_ERR(-ENOMEM);
 	for (i = 0; i < bal->cb_sb.bsb_groupcount; ++i) {
 		gi = &bal->cb_group_info[i];
 		gi->bgi_groupno = i;
-		rc = balloc_group_info_init(gi, bal);
-		if (rc != 0)
-			break;
+		gi->bgi_state   = 0;
+		m0_mutex_init(bgi_mutex(gi));
+		bal->cb_group_free[i] = M0_BALLOC_GROUP_FREE_UNKNOWN;
+	}
+	return M0_RC(0);
+}
+
+static void balloc_warmup(struct m0_balloc *bal)
+{
+	m0_bcount_t i;
+
+	for (i = 0; i < bal->cb_sb.bsb_groupcount &&
+		    !bal->cb_warmup->bw_stop; ++i)
+		(void)m0_balloc_gn2info(bal, i);
+	M0_LOG(M0_INFO, "Loaded %"PRIu64" groups", i);
+}
+
+/** Starts background loading of groups, see m0_balloc_warmup. */
+static void balloc_warmup_start(struct m0_balloc *bal)
+{
+	int rc;
+
+	M0_PRE(bal->cb_warmup == NULL);
 
-		/* TODO verify the super_block info based on the group info */
+	if (bal->cb_sb.bsb_groupcount < M0_BALLOC_WARMUP_GROUPS)
+		return;
+	M0_ALLOC_PTR(bal->cb_warmup);
+	if (bal->cb_warmup == NULL)
+		return;
+	rc = M0_THREAD_INIT(&bal->cb_warmup->bw_thread, struct m0_balloc *,
+			    NULL, &balloc_warmup, bal, "m0_balloc_warm");
+	if (rc != 0) {
+		/* Groups are still loaded on demand. */
+		M0_LOG(M0_WARN, "Cannot start group loading: rc=%d", rc);
+		m0_free0(&bal->cb_warmup);
 	}
-	while (rc != 0 && i > 0) {
-		balloc_group_info_fini(&bal->cb_group_info[--i]);
+}
+
+static void balloc_warmup_stop(struct m0_balloc *bal)
+{
+	if (bal->cb_warmup != NULL) {
+		bal->cb_warmup->bw_stop = true;
+		m0_thread_join(&bal->cb_warmup->bw_thread);
+		m0_thread_fini(&bal->cb_warmup->bw_thread);
+		m0_free0(&bal->cb_warmup);
 	}
-	return M0_RC(rc);
+}
+
+/**
+   Splits groups into contiguous slices, one per allocation stream.
+
+   Streams are not created when there are fewer than two groups per stream
+   for at least two streams, the shared search is used then.
+ */
+static int balloc_streams_init(struct m0_balloc *bal)
+{
+	m0_bcount_t ngroups = bal->cb_sb.bsb_groupcount;
+	uint32_t    nr;
+	uint32_t    i;
+
+	M0_PRE(bal->cb_streams == NULL);
+
+	nr = min64u(M0_BALLOC_STREAM_NR, ngroups / 2);
+	if (nr < 2)
+		return M0_RC(0);
+	M0_ALLOC_ARR(bal->cb_streams, nr);
+	if (bal->cb_streams == NULL)
+		return M0_ERR(-ENOMEM);
+	for (i = 0; i < nr; ++i) {
+		struct m0_balloc_stream *bs = &bal->cb_streams[i];
+
+		bs->bs_first  = ngroups * i / nr;
+		bs->bs_nr     = ngroups * (i + 1) / nr - bs->bs_first;
+		bs->bs_cursor = bs->bs_first;
+	}
+	bal->cb_stream_nr = nr;
+	M0_LOG(M0_INFO, "Stream Count = %"PRIu32, nr);
+	return M0_RC(0);
+}
+
+/** Returns the stream of the current locality or NULL if there is none. */
+static struct m0_balloc_stream *balloc_stream_here(struct m0_balloc *bal)
+{
+	return bal->cb_streams == NULL ? NULL :
+		&bal->cb_streams[m0_locality_here()->lo_idx %
+				 bal->cb_stream_nr];
+}
+
+/**
+   Returns the i-th group to search.
+
+   With a stream, the groups of its slice come first, starting from the
+   stream cursor, followed by the rest of the groups. Otherwise groups are
+   searched starting from the group of the goal. In both cases each group
+   is returned exactly once for i in [0, bsb_groupcount).
+ */
+static m0_bindex_t balloc_search_group(struct balloc_allocation_context *bac,
+				       m0_bcount_t i)
+{
+	struct m0_balloc_stream *bs      = bac->bac_stream;
+	m0_bcount_t              ngroups = bac->bac_ctxt->cb_sb.bsb_groupcount;
+
+	M0_PRE(i < ngroups);
+
+	if (bs == NULL)
+		return (balloc_bn2gn(bac->bac_goal.e_start, bac->bac_ctxt) + i) %
+			ngroups;
+	if (i < bs->bs_nr)
+		return bs->bs_first +
+			(bs->bs_cursor - bs->bs_first + i) % bs->bs_nr;
+	return (bs->bs_first + i) % ngroups;
 }
 
 /**
@@ -548,16 +857,24 @@ static void balloc_fini_internal(struct m0_balloc *bal)
 
 	M0_ENTRY();
 
+	balloc_warmup_stop(bal);
 	if (bal->cb_group_info != NULL) {
 		for (i = 0 ; i < bal->cb_sb.bsb_groupcount; i++) {
 			gi = &bal->cb_group_info[i];
-			m0_balloc_lock_group(gi);
-			m0_balloc_release_extents(gi);
-			m0_balloc_unlock_group(gi);
+			if (gi->bgi_state & M0_BALLOC_GROUP_INFO_INIT) {
+				m0_balloc_lock_group(gi);
+				m0_balloc_release_extents(gi);
+				m0_balloc_unlock_group(gi);
+			}
 			balloc_group_info_fini(gi);
 		}
 		m0_free0(&bal->cb_group_info);
 	}
+	m0_free0(&bal->cb_group_free);
+	m0_free0(&bal->cb_streams);
+	bal->cb_stream_nr = 0;
+	m0_free0(&bal->cb_prealloc);
+	m0_free0(&bal->cb_free);
 
 	M0_BTREE_OP_SYNC_WITH_RC(&b_op,
 				 m0_btree_close(bal->cb_db_group_extents,
@@ -634,6 +951,153 @@ static int sb_update(struct m0_balloc *bal, struct m0_sm_group *grp)
 	return M0_RC(rc);
 }
 
+static struct m0_balloc_free *balloc_free_here(struct m0_balloc *bal)
+{
+	return &bal->cb_free[m0_locality_here()->lo_idx % M0_BALLOC_FREE_NR];
+}
+
+/** Adds @nr (negative for an allocation) to the free blocks of a zone. */
+static void balloc_free_add(struct m0_balloc *bal, bool spare, int64_t nr)
+{
+	struct m0_balloc_free *bf = balloc_free_here(bal);
+
+#ifdef __SPARE_SPACE__
+	if (spare) {
+		m0_atomic64_add(&bf->bf_spare, nr);
+		return;
+	}
+#endif
+	m0_atomic64_add(&bf->bf_blocks, nr);
+}
+
+static int64_t balloc_free_take(struct m0_atomic64 *cnt)
+{
+	int64_t nr = m0_atomic64_get(cnt);
+
+	m0_atomic64_sub(cnt, nr);
+	return nr;
+}
+
+/** Moves the changes of the per-locality counters to the super block. */
+static void balloc_free_fold(struct m0_balloc *bal)
+{
+	int i;
+
+	M0_PRE(m0_mutex_is_locked(&bal->cb_sb_mutex.bm_u.mutex));
+
+	for (i = 0; bal->cb_free != NULL && i < M0_BALLOC_FREE_NR; ++i) {
+		bal->cb_sb.bsb_freeblocks +=
+			balloc_free_take(&bal->cb_free[i].bf_blocks);
+#ifdef __SPARE_SPACE__
+		bal->cb_sb.bsb_freespare +=
+			balloc_free_take(&bal->cb_free[i].bf_spare);
+#endif
+	}
+}
+
+M0_INTERNAL m0_bcount_t m0_balloc_free_blocks(const struct m0_balloc *cb)
+{
+	m0_bcount_t nr = cb->cb_sb.bsb_freeblocks;
+	int         i;
+
+	for (i = 0; cb->cb_free != NULL && i < M0_BALLOC_FREE_NR; ++i)
+		nr += m0_atomic64_get(&cb->cb_free[i].bf_blocks);
+	return nr;
+}
+
+#ifdef __SPARE_SPACE__
+M0_INTERNAL m0_bcount_t m0_balloc_free_spare(const struct m0_balloc *cb)
+{
+	m0_bcount_t nr = cb->cb_sb.bsb_freespare;
+	int         i;
+
+	for (i = 0; cb->cb_free != NULL && i < M0_BALLOC_FREE_NR; ++i)
+		nr += m0_atomic64_get(&cb->cb_free[i].bf_spare);
+	return nr;
+}
+#endif
+
+M0_INTERNAL void m0_balloc_sb_writeback_set(struct m0_balloc *cb,
+					    m0_time_t         interval)
+{
+	m0_mutex_lock(&cb->cb_sb_mutex.bm_u.mutex);
+	cb->cb_sb_wb_interval = interval;
+	cb->cb_sb_wb_due = 0;
+	m0_mutex_unlock(&cb->cb_sb_mutex.bm_u.mutex);
+}
+
+/**
+ * Writes the free block counters back to the super block in @tx, if
+ * m0_balloc::cb_sb_wb_interval passed since the last write-back.
+ *
+ * Counters written back by a transaction may include changes of concurrent
+ * transactions which are lost on a crash. It is fine, because the counters are
+ * rebuilt from the group descriptors on the next mount then, see
+ * M0_BALLOC_SB_WRITEBACK.
+ */
+static void balloc_sb_writeback(struct m0_balloc *bal, struct m0_be_tx *tx)
+{
+	m0_time_t now = m0_time_now();
+
+	/* Unlocked check, most of transactions don't write back. */
+	if (now < bal->cb_sb_wb_due)
+		return;
+	m0_mutex_lock(&bal->cb_sb_mutex.bm_u.mutex);
+	if (now >= bal->cb_sb_wb_due) {
+		balloc_free_fold(bal);
+		bal->cb_sb.bsb_state |= M0_BALLOC_SB_DIRTY;
+		balloc_sb_sync(bal, tx);
+		bal->cb_sb_wb_due = m0_time_add(now, bal->cb_sb_wb_interval);
+	}
+	m0_mutex_unlock(&bal->cb_sb_mutex.bm_u.mutex);
+}
+
+/**
+ * Rebuilds the free block counters of the super block from the group
+ * descriptors, which are updated in the same transactions as the group
+ * extents. A descriptor that cannot be read fails the mount.
+ */
+static int balloc_sb_rebuild(struct m0_balloc *bal)
+{
+	struct m0_balloc_group_desc  gd;
+	struct m0_balloc_super_block *sb = &bal->cb_sb;
+	struct m0_buf                key;
+	struct m0_buf                val;
+	m0_bindex_t                  groupno;
+	m0_bcount_t                  freeblocks = 0;
+#ifdef __SPARE_SPACE__
+	m0_bcount_t                  freespare = 0;
+#endif
+	m0_bcount_t                  i;
+	int                          rc;
+
+	M0_ENTRY();
+	for (i = 0; i < sb->bsb_groupcount; ++i) {
+		M0_SET0(&gd);
+		groupno = m0_byteorder_cpu_to_be64(i);
+		key = (struct m0_buf)M0_BUF_INIT_PTR(&groupno);
+		val = (struct m0_buf)M0_BUF_INIT_PTR(&gd);
+		rc = btree_lookup_sync(bal->cb_db_group_desc, &key, &val,
+				       false);
+		if (rc != 0) {
+			M0_LOG(M0_ERROR, "grp=%"PRIu64" descriptor lookup "
+			       "failed: rc=%d", i, rc);
+			return M0_ERR(rc);
+		}
+		freeblocks += gd.bgd_freeblocks;
+#ifdef __SPARE_SPACE__
+		freespare += gd.bgd_spare_freeblocks;
+#endif
+	}
+	M0_LOG(M0_WARN, "Free blocks rebuilt: %"PRIu64" -> %"PRIu64,
+	       sb->bsb_freeblocks, freeblocks);
+	sb->bsb_freeblocks = freeblocks;
+#ifdef __SPARE_SPACE__
+	sb->bsb_freespare = freespare;
+#endif
+	return M0_RC(0);
+}
+
 static int balloc_sb_write(struct m0_balloc            *bal,
 			   struct m0_balloc_format_req *req,
 			   struct m0_sm_group          *grp)
@@ -665,7 +1129,7 @@ static int balloc_sb_write(struct m0_balloc            *bal,
 	gettimeofday(&now, NULL);
 	/* TODO verification of these parameters */
 	sb->bsb_magic		= M0_BALLOC_SB_MAGIC;
-	sb->bsb_state		= 0;
+	sb->bsb_state		= M0_BALLOC_SB_WRITEBACK;
 	sb->bsb_version		= M0_BALLOC_SB_VERSION;
 
 	/*
@@ -905,7 +1369,8 @@ static int balloc_groups_write(struct m0_balloc *bal)
 		},
 		.tbc_workers_nr            = 0x40,
 		.tbc_partitions_nr         = 1,
-		.tbc_work_items_per_tx_max = 1,
+		.tbc_work_items_per_tx_max = 0x10,
+		.tbc_autotune              = true,
 		.tbc_dom                   = bal->cb_be_seg->bs_domain,
 		.tbc_datum                 = &bgs,
 		.tbc_do                    = &balloc_group_write_do,
@@ -1015,6 +1480,7 @@ static int balloc_gi_sync(struct m0_balloc *cb,
 	key = (struct m0_buf)M0_BUF_INIT_PTR(&groupno);
 	val = (struct m0_buf)M0_BUF_INIT_PTR(&gd);
 	rc = btree_update_sync(cb->cb_db_group_desc, tx, &key, &val);
+	balloc_group_free_set(cb, gi);
 
 	gi->bgi_state &= ~M0_BALLOC_GROUP_INFO_DIRTY;
 
@@ -1028,6 +1494,7 @@ static int sb_mount(struct m0_balloc *bal, struct m0_sm_group *grp)
 	gettimeofday(&now, NULL);
 	bal->cb_sb.bsb_mnt_time = ((uint64_t)now.tv_sec) << 32 | now.tv_usec;
 	++bal->cb_sb.bsb_mnt_count;
+	bal->cb_sb.bsb_state |= M0_BALLOC_SB_WRITEBACK;
 
 	return sb_update(bal, grp);
 }
@@ -1048,21 +1515,45 @@ static int balloc_init_internal(struct m0_balloc *bal,
 {
 	int                        rc;
 	struct m0_btree_op         b_op = {};
-	struct m0_btree_rec_key_op ge_keycmp = { .rko_keycmp = ge_tree_cmp, };
+	struct m0_btree_rec_key_op ge_keycmp = {
+		.rko_keycmp = ge_tree_cmp,
+		.rko_flags  = M0_BKF_U64,
+	};
 
 	M0_ENTRY();
 
 	bal->cb_be_seg = seg;
 	bal->cb_group_info = NULL;
+	bal->cb_group_free = NULL;
+	bal->cb_warmup = NULL;
+	bal->cb_streams = NULL;
+	bal->cb_stream_nr = 0;
+	bal->cb_sb_wb_interval = M0_BALLOC_SB_WRITEBACK_INTERVAL;
+	bal->cb_sb_wb_due = 0;
 	m0_mutex_init(&bal->cb_sb_mutex.bm_u.mutex);
 
+	M0_ALLOC_ARR(bal->cb_free, M0_BALLOC_FREE_NR);
+	if (bal->cb_free == NULL)
+		return M0_ERR(-ENOMEM);
+
+	M0_ALLOC_ARR(bal->cb_prealloc, M0_BALLOC_PREALLOC_NR);
+	if (bal->cb_prealloc == NULL) {
+		m0_free0(&bal->cb_free);
+		return M0_ERR(-ENOMEM);
+	}
+
 	M0_ALLOC_PTR(bal->cb_db_group_desc);
-	if (bal->cb_db_group_desc == NULL)
+	if (bal->cb_db_group_desc == NULL) {
+		m0_free0(&bal->cb_prealloc);
+		m0_free0(&bal->cb_free);
 		return M0_ERR(-ENOMEM);
+	}
 
 	M0_ALLOC_PTR(bal->cb_db_group_extents);
 	if (bal->cb_db_group_extents == NULL) {
 		m0_free0(&bal->cb_db_group_desc);
+		m0_free0(&bal->cb_prealloc);
+		m0_free0(&bal->cb_free);
 		return M0_ERR(-ENOMEM);
 	}
 
@@ -1089,9 +1580,11 @@ static int balloc_init_internal(struct m0_balloc *bal,
 		req.bfr_groupsize = blocks_per_group;
 		req.bfr_spare_reserved_blocks = spare_blocks_per_group;
 
-		rc = balloc_format(bal, &req, grp);
+		rc = balloc_format(bal, &req, grp) ?: balloc_streams_init(bal);
 		if (rc != 0)
 			balloc_fini_internal(bal);
+		else
+			balloc_warmup_start(bal);
 		return M0_RC(rc);
 	}
 
@@ -1102,6 +1595,13 @@ static int balloc_init_internal(struct m0_balloc *bal,
 
 	M0_LOG(M0_INFO, "Group Count = %"PRIu64, bal->cb_sb.bsb_groupcount);
 
+	/* Not unmounted cleanly, written back counters may be stale. */
+	if (bal->cb_sb.bsb_state & M0_BALLOC_SB_WRITEBACK) {
+		rc = balloc_sb_rebuild(bal);
+		if (rc != 0)
+			goto out;
+	}
+
 	M0_ALLOC_ARR(bal->cb_group_info, bal->cb_sb.bsb_groupcount);
 	rc = bal->cb_group_info == NULL ? M0_ERR(-ENOMEM) : 0;
 	if (rc == 0) {
@@ -1109,10 +1609,12 @@ static int balloc_init_internal(struct m0_balloc *bal,
 		if (rc != 0)
 			m0_free0(&bal->cb_group_info);
 	}
-	rc = rc ?: sb_mount(bal, grp);
+	rc = rc ?: balloc_streams_init(bal) ?: sb_mount(bal, grp);
 out:
 	if (rc != 0)
 		balloc_fini_internal(bal);
+	else
+		balloc_warmup_start(bal);
 	return M0_RC(rc);
 }
 
@@ -1135,6 +1637,7 @@ static int balloc_init_ac(struct balloc_allocation_context *bac,
 	bac->bac_flags	  = req->bar_flags;
 	bac->bac_status	  = M0_BALLOC_AC_CONTINUE;
 	bac->bac_criteria = 0;
+	bac->bac_stream	  = req->bar_goal == 0 ? balloc_stream_here(motr) : NULL;
 
 	if (req->bar_goal == 0)
 		req->bar_goal = motr->cb_last;
@@ -1153,9 +1656,146 @@ static int balloc_init_ac(struct balloc_allocation_context *bac,
 }
 
 
+static bool balloc_prealloc_is_live(const struct m0_balloc_prealloc *bp,
+				    m0_time_t now)
+{
+	return bp->bp_owner != 0 && bp->bp_expire > now &&
+		!m0_ext_is_empty(&bp->bp_ext);
+}
+
+/** Returns the window slot of the owner or NULL. */
+static struct m0_balloc_prealloc *balloc_prealloc_find(struct m0_balloc *bal,
+						       uint64_t owner)
+{
+	int i;
+
+	M0_PRE(m0_mutex_is_locked(&bal->cb_sb_mutex.bm_u.mutex));
+	M0_PRE(owner != 0);
+
+	for (i = 0; i < M0_BALLOC_PREALLOC_NR; ++i) {
+		if (bal->cb_prealloc[i].bp_owner == owner)
+			return &bal->cb_prealloc[i];
+	}
+	return NULL;
+}
+
+/**
+   Moves the window of the owner past the just allocated extent, or opens a
+   new window right after it. The least recently used slot is reused when
+   all slots are taken.
+ */
+static void balloc_prealloc_update(struct m0_balloc *bal, uint64_t owner,
+				   const struct m0_ext *ext)
+{
+	struct m0_balloc_prealloc *bp;
+	m0_time_t                  now = m0_time_now();
+	int                        i;
+
+	M0_PRE(m0_mutex_is_locked(&bal->cb_sb_mutex.bm_u.mutex));
+
+	if (owner == 0)
+		return;
+	bp = balloc_prealloc_find(bal, owner);
+	if (bp != NULL && balloc_prealloc_is_live(bp, now) &&
+	    m0_ext_is_in(&bp->bp_ext, ext->e_end)) {
+		bp->bp_ext.e_start = ext->e_end;
+	} else {
+		/* unused slots have zero expiration time and are taken first */
+		if (bp == NULL) {
+			bp = &bal->cb_prealloc[0];
+			for (i = 1; i < M0_BALLOC_PREALLOC_NR; ++i) {
+				if (bal->cb_prealloc[i].bp_expire <
+				    bp->bp_expire)
+					bp = &bal->cb_prealloc[i];
+			}
+		}
+		bp->bp_owner = owner;
+		bp->bp_ext.e_start = ext->e_end;
+		bp->bp_ext.e_end = ext->e_end + M0_BALLOC_PREALLOC_LEN;
+		m0_ext_init(&bp->bp_ext);
+	}
+	bp->bp_expire = m0_time_add(now, M0_BALLOC_PREALLOC_TIMEOUT);
+}
+
+static void balloc_prealloc_release(struct m0_balloc *bal, uint64_t owner)
+{
+	struct m0_balloc_prealloc *bp;
+
+	m0_mutex_lock(&bal->cb_sb_mutex.bm_u.mutex);
+	bp = balloc_prealloc_find(bal, owner);
+	if (bp != NULL)
+		M0_SET0(bp);
+	m0_mutex_unlock(&bal->cb_sb_mutex.bm_u.mutex);
+}
+
+/**
+   Places the final extent past the preallocation windows of other owners
+   when the best extent has room for it. Otherwise the blocks of the window
+   are taken. Called under the group lock.
+ */
+static void balloc_prealloc_avoid(struct balloc_allocation_context *bac)
+{
+	struct m0_balloc          *bal   = bac->bac_ctxt;
+	struct m0_ext             *fin   = &bac->bac_final;
+	m0_bcount_t                len   = m0_ext_length(fin);
+	m0_time_t                  now   = m0_time_now();
+	struct m0_balloc_prealloc *bp;
+	bool                       moved;
+	int                        i;
+
+	m0_mutex_lock(&bal->cb_sb_mutex.bm_u.mutex);
+	do {
+		moved = false;
+		for (i = 0; i < M0_BALLOC_PREALLOC_NR; ++i) {
+			bp = &bal->cb_prealloc[i];
+			if (bp->bp_owner == bac->bac_req->bar_owner ||
+			    !balloc_prealloc_is_live(bp, now) ||
+			    !m0_ext_are_overlapping(&bp->bp_ext, fin))
+				continue;
+			if (bp->bp_ext.e_end + len > bac->bac_best.e_end)
+				goto out;
+			fin->e_start = bp->bp_ext.e_end;
+			fin->e_end = fin->e_start + len;
+			moved = true;
+		}
+	} while (moved);
+out:
+	m0_mutex_unlock(&bal->cb_sb_mutex.bm_u.mutex);
+}
+
+/**
+   Tries to allocate at the start of the preallocation window of the owner.
+
+   The window is dropped if its blocks are not free any more.
+ */
 static int balloc_use_prealloc(struct balloc_allocation_context *bac)
 {
-	return 0;
+	struct m0_balloc          *bal   = bac->bac_ctxt;
+	uint64_t                   owner = bac->bac_req->bar_owner;
+	m0_bcount_t                len   = m0_ext_length(&bac->bac_goal);
+	struct m0_balloc_prealloc *bp;
+	m0_bindex_t                start = 0;
+	int                        rc;
+
+	if (owner == 0)
+		return 0;
+	m0_mutex_lock(&bal->cb_sb_mutex.bm_u.mutex);
+	bp = balloc_prealloc_find(bal, owner);
+	if (bp != NULL && balloc_prealloc_is_live(bp, m0_time_now()))
+		start = bp->bp_ext.e_start;
+	m0_mutex_unlock(&bal->cb_sb_mutex.bm_u.mutex);
+	if (start == 0)
+		return 0;
+
+	bac->bac_goal.e_start = start;
+	bac->bac_goal.e_end   = start + len;
+	rc = balloc_try_goal(bac);
+	if (rc == 0 && bac->bac_status != M0_BALLOC_AC_FOUND) {
+		M0_LOG(M0_DEBUG, "owner=%"PRIx64" window is taken", owner);
+		balloc_prealloc_release(bal, owner);
+		bac->bac_goal = bac->bac_orig;
+	}
+	return M0_RC(rc);
 }
 
 static bool is_spare(uint64_t alloc_flags)
@@ -1188,16 +1828,16 @@ static bool balloc_got_freespace(const struct m0_balloc *ctx,
 	int rc;
 	M0_ENTRY();
 
-	M0_LOG(M0_DEBUG, "bsb_freeblocks=%llu blocks=%llu",
-	       (unsigned long long)ctx->cb_sb.bsb_freeblocks,
+	M0_LOG(M0_DEBUG, "freeblocks=%llu blocks=%llu",
+	       (unsigned long long)m0_balloc_free_blocks(ctx),
 	       (unsigned long long)blocks);
 	rc =
 #ifdef __SPARE_SPACE__
-	is_any(alloc_flags) ? (ctx->cb_sb.bsb_freespare >= blocks ||
-				    ctx->cb_sb.bsb_freeblocks >= blocks) :
-	      is_spare(alloc_flags) ? ctx->cb_sb.bsb_freespare >= blocks :
+	is_any(alloc_flags) ? (m0_balloc_free_spare(ctx) >= blocks ||
+				    m0_balloc_free_blocks(ctx) >= blocks) :
+	      is_spare(alloc_flags) ? m0_balloc_free_spare(ctx) >= blocks :
 #endif
-		(ctx->cb_sb.bsb_freeblocks >= blocks);
+		(m0_balloc_free_blocks(ctx) >= blocks);
 
 	M0_LEAVE();
 	return M0_RC(rc);
@@ -1306,11 +1946,18 @@ M0_INTERNAL int m0_balloc_load_extents(struct m0_balloc *cb,
 		 (int)group_spare_fragments_get(grp));
 	M0_PRE(m0_mutex_is_locked(bgi_mutex(grp)));
 
+	if (grp->bgi_rc != 0)
+		return M0_ERR(grp->bgi_rc);
 	if (grp->bgi_extents != NULL) {
 		M0_LOG(M0_DEBUG, "Already loaded");
 		return M0_RC(0);
 	}
 
+	rc = zone_index_init(&grp->bgi_normal) ?:
+	     zone_index_init(&grp->bgi_spare);
+	if (rc != 0)
+		return M0_RC(rc);
+
 	M0_ALLOC_ARR(grp->bgi_extents, group_fragments_get(grp) +
 		     group_spare_fragments_get(grp) + 1);
 	if (grp->bgi_extents == NULL)
@@ -1345,11 +1992,14 @@ M0_INTERNAL int m0_balloc_load_extents(struct m0_balloc *cb,
 		ex->le_ext.e_end   = m0_byteorder_be64_to_cpu(ex->le_ext.e_end);
 		ex->le_ext.e_start = *(m0_bindex_t*)val.b_addr;
 		m0_ext_init(&ex->le_ext);
-		if (m0_ext_is_partof(&normal_range, &ex->le_ext))
+		m0_list_link_init(&ex->le_size_link);
+		if (m0_ext_is_partof(&normal_range, &ex->le_ext)) {
 			m0_list_add_tail(group_normal_ext(grp), &ex->le_link);
-		else if (m0_ext_is_partof(&spare_range, &ex->le_ext))
+			lext_index_add(&grp->bgi_normal, ex);
+		} else if (m0_ext_is_partof(&spare_range, &ex->le_ext)) {
 			m0_list_add_tail(group_spare_ext(grp), &ex->le_link);
-		else {
+			lext_index_add(&grp->bgi_spare, ex);
+		} else {
 			M0_LOG(M0_ERROR, "Invalid extent");
 			M0_ASSERT(false);
 		}
@@ -1401,11 +2051,18 @@ M0_INTERNAL int m0_balloc_load_extents(struct m0_balloc *cb,
 		 (int)group_spare_fragments_get(grp));
 	M0_PRE(m0_mutex_is_locked(bgi_mutex(grp)));
 
+	if (grp->bgi_rc != 0)
+		return M0_ERR(grp->bgi_rc);
 	if (grp->bgi_extents != NULL) {
 		M0_LOG(M0_DEBUG, "Already loaded");
 		return M0_RC(0);
 	}
 
+	rc = zone_index_init(&grp->bgi_normal) ?:
+	     zone_index_init(&grp->bgi_spare);
+	if (rc != 0)
+		return M0_RC(rc);
+
 	if (group_fragments_get(grp) +
 	    group_spare_fragments_get(grp) == 0) {
 		M0_LOG(M0_NOTICE, "zero fragments");
@@ -1441,13 +2098,16 @@ M0_INTERNAL int m0_balloc_load_extents(struct m0_balloc *cb,
 		if (rc != 0)
 			break;
 		m0_ext_init(&ex->le_ext);
+		m0_list_link_init(&ex->le_size_link);
 		if (m0_ext_is_partof(&normal_range, &ex->le_ext)) {
 			m0_list_add_tail(group_normal_ext(grp), &ex->le_link);
+			lext_index_add(&grp->bgi_normal, ex);
 			++normal_frags;
 			zone_params_update(grp, &ex->le_ext,
 					   M0_BALLOC_NORMAL_ZONE);
 		} else if (m0_ext_is_partof(&spare_range, &ex->le_ext)) {
 			m0_list_add_tail(group_spare_ext(grp), &ex->le_link);
+			lext_index_add(&grp->bgi_spare, ex);
 			++spare_frags;
 			zone_params_update(grp, &ex->le_ext,
 					   M0_BALLOC_SPARE_ZONE);
@@ -1532,6 +2192,9 @@ static int balloc_find_extent_buddy(struct balloc_allocation_context *bac,
 	M0_LOG(M0_DEBUG, "start=%" PRIu64 " len=%"PRIu64,
 	       zp->bzp_range.e_start, len);
 
+	if (zp->bzp_size_class != NULL && !zone_index_has(zp, len))
+		return 0;
+
 	start = zp->bzp_range.e_start;
 	m0_list_for_each_entry(&zp->bzp_extents, le, struct m0_lext, le_link) {
 		frag = &le->le_ext;
@@ -1590,6 +2253,7 @@ static int balloc_use_best_found(struct balloc_allocation_context *bac,
 
 	bac->bac_final.e_end = bac->bac_final.e_start +
 		min_check(m0_ext_length(&bac->bac_best), len);
+	balloc_prealloc_avoid(bac);
 	M0_LOG(M0_DEBUG, "final="EXT_F, EXT_P(&bac->bac_final));
 	bac->bac_status = M0_BALLOC_AC_FOUND;
 
@@ -1692,7 +2356,8 @@ static int balloc_alloc_db_update(struct m0_balloc *motr, struct m0_be_tx *tx,
 
 	balloc_debug_dump_extent("current=", cur);
 
-	if (m0_ext_length(cur) == zp->bzp_maxchunk) {
+	if (m0_ext_length(cur) == zp->bzp_maxchunk &&
+	    zp->bzp_size_class == NULL) {
 		/* find next to max sized chunk */
 		maxchunk = 0;
 		m0_list_for_each_entry(&zp->bzp_extents, le,
@@ -1720,6 +2385,7 @@ static int balloc_alloc_db_update(struct m0_balloc *motr, struct m0_be_tx *tx,
 			/* |      |  tgt  |                    | */
 			/* +------+-------+--------------------+ */
 			cur->e_end = tgt->e_start;
+			lext_index_update(zp, cur);
 			rc = balloc_ext_insert(db, tx, *cur);
 			if (rc != 0)
 				return M0_RC(rc);
@@ -1730,7 +2396,7 @@ static int balloc_alloc_db_update(struct m0_balloc *motr, struct m0_be_tx *tx,
 			/* |     tgt     |                     | */
 			/* +-------------+---------------------+ */
 			le = container_of(cur, struct m0_lext, le_ext);
-			lext_del(le);
+			lext_del(zp, le);
 			zp->bzp_fragments--;
 		}
 	} else {
@@ -1741,6 +2407,7 @@ static int balloc_alloc_db_update(struct m0_balloc *motr, struct m0_be_tx *tx,
 		/* |     tgt    |                      | */
 		/* +------------+----------------------+ */
 		cur->e_start = tgt->e_end;
+		lext_index_update(zp, cur);
 		rc = balloc_ext_update(db, tx, *cur);
 		if (rc != 0)
 			return M0_RC(rc);
@@ -1763,25 +2430,23 @@ static int balloc_alloc_db_update(struct m0_balloc *motr, struct m0_be_tx *tx,
 			}
 			lcur = container_of(cur, struct m0_lext, le_ext);
 			m0_list_add_before(&lcur->le_link, &le->le_link);
+			lext_index_add(zp, le);
 			zp->bzp_fragments++;
 			maxchunk = max_check(maxchunk, m0_ext_length(&new));
 		}
 	}
+	/* the longest extent after the allocation is known from the index */
+	if (zp->bzp_size_class != NULL)
+		maxchunk = zone_index_maxchunk(zp);
+	M0_POST_EX(zone_index_invariant(zp));
 	zp->bzp_maxchunk = maxchunk;
 	zp->bzp_freeblocks -= m0_ext_length(tgt);
 
 	grp->bgi_state |= M0_BALLOC_GROUP_INFO_DIRTY;
 
-	m0_mutex_lock(&motr->cb_sb_mutex.bm_u.mutex);
-#ifdef __SPARE_SPACE__
-	if (is_spare(alloc_type))
-		motr->cb_sb.bsb_freespare -= m0_ext_length(tgt);
-	else
-#endif
-		motr->cb_sb.bsb_freeblocks -= m0_ext_length(tgt);
-	motr->cb_sb.bsb_state |= M0_BALLOC_SB_DIRTY;
-	balloc_sb_sync(motr, tx);
-	m0_mutex_unlock(&motr->cb_sb_mutex.bm_u.mutex);
+	balloc_free_add(motr, is_spare(alloc_type),
+			-(int64_t)m0_ext_length(tgt));
+	balloc_sb_writeback(motr, tx);
 
 	rc = balloc_gi_sync(motr, tx, grp);
 
@@ -1862,6 +2527,7 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 				return M0_RC(rc);
 			}
 			m0_list_add(&zp->bzp_extents, &le->le_link);
+			lext_index_add(zp, le);
 			++zp->bzp_fragments;
 			maxchunk = max_check(maxchunk, m0_ext_length(tgt));
 		} else {
@@ -1881,6 +2547,7 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 					return M0_RC(rc);
 				}
 				m0_list_add_after(&lcur->le_link, &le->le_link);
+				lext_index_add(zp, le);
 				++zp->bzp_fragments;
 				maxchunk = max_check(maxchunk, m0_ext_length(tgt));
 			} else {
@@ -1894,6 +2561,7 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 				if (rc != 0)
 					return M0_RC(rc);
 				cur->e_end = tgt->e_end;
+				lext_index_update(zp, cur);
 				rc = balloc_ext_insert(db, tx, *cur);
 				if (rc != 0)
 					return M0_RC(rc);
@@ -1917,6 +2585,7 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 				return M0_RC(rc);
 			}
 			m0_list_add_before(&lcur->le_link, &le->le_link);
+			lext_index_add(zp, le);
 			++zp->bzp_fragments;
 			maxchunk = max_check(maxchunk, m0_ext_length(tgt));
 		} else {
@@ -1927,6 +2596,7 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 			/* +-----+---------+-------------------+ */
 			M0_ASSERT(tgt->e_end == cur->e_start);
 			cur->e_start = tgt->e_start;
+			lext_index_update(zp, cur);
 			rc = balloc_ext_update(db, tx, *cur);
 			if (rc != 0)
 				return M0_RC(rc);
@@ -1946,11 +2616,12 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 			if (rc != 0)
 				return M0_RC(rc);
 			cur->e_start = pre->e_start;
+			lext_index_update(zp, cur);
 			rc = balloc_ext_update(db, tx, *cur);
 			if (rc != 0)
 				return M0_RC(rc);
 			le = container_of(pre, struct m0_lext, le_ext);
-			lext_del(le);
+			lext_del(zp, le);
 			--zp->bzp_fragments;
 			maxchunk = max_check(maxchunk, m0_ext_length(cur));
 		} else if (pre->e_end == tgt->e_start) {
@@ -1964,6 +2635,7 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 			if (rc != 0)
 				return M0_RC(rc);
 			pre->e_end = tgt->e_end;
+			lext_index_update(zp, pre);
 			rc = balloc_ext_insert(db, tx, *pre);
 			if (rc != 0)
 				return M0_RC(rc);
@@ -1975,6 +2647,7 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 			/* |          |  tgt  |                | */
 			/* +----------+-------+----------------+ */
 			cur->e_start = tgt->e_start;
+			lext_index_update(zp, cur);
 			rc = balloc_ext_update(db, tx, *cur);
 			if (rc != 0)
 				return M0_RC(rc);
@@ -1994,27 +2667,19 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 				return M0_RC(rc);
 			}
 			m0_list_add_before(&lcur->le_link, &le->le_link);
+			lext_index_add(zp, le);
 			++zp->bzp_fragments;
 			maxchunk = max_check(maxchunk, m0_ext_length(tgt));
 		}
 	}
+	M0_POST_EX(zone_index_invariant(zp));
 	zp->bzp_maxchunk = maxchunk;
 	zp->bzp_freeblocks += m0_ext_length(tgt);
 
 	grp->bgi_state |= M0_BALLOC_GROUP_INFO_DIRTY;
 
-	m0_mutex_lock(&motr->cb_sb_mutex.bm_u.mutex);
-	if (is_spare(alloc_flag))
-#ifdef __SPARE_SPACE__
-		motr->cb_sb.bsb_freespare += m0_ext_length(tgt);
-#else
-		motr->cb_sb.bsb_freeblocks += m0_ext_length(tgt);
-#endif
-	else
-		motr->cb_sb.bsb_freeblocks += m0_ext_length(tgt);
-	motr->cb_sb.bsb_state |= M0_BALLOC_SB_DIRTY;
-	balloc_sb_sync(motr, tx);
-	m0_mutex_unlock(&motr->cb_sb_mutex.bm_u.mutex);
+	balloc_free_add(motr, is_spare(alloc_flag), m0_ext_length(tgt));
+	balloc_sb_writeback(motr, tx);
 
 	rc = balloc_gi_sync(motr, tx, grp);
 
@@ -2312,6 +2977,37 @@ static int balloc_measure_extent(struct balloc_allocation_context *bac,
 	return M0_RC(rc);
 }
 
+/*
+ * Measures the extents which satisfy the goal, smaller size classes first.
+ * Size classes below the goal length are not looked at.
+ */
+static void balloc_index_scan_group(struct balloc_allocation_context *bac,
+				    struct m0_balloc_group_info *grp,
+				    struct m0_balloc_zone_param *zp,
+				    enum m0_balloc_allocation_flag alloc_flag,
+				    int end_of_group)
+{
+	m0_bcount_t     len = m0_ext_length(&bac->bac_goal);
+	struct m0_lext *le;
+	unsigned        c;
+
+	M0_PRE(zp->bzp_size_class != NULL);
+
+	for (c = m0_log2(len); c < M0_BALLOC_SIZE_CLASS_NR; ++c) {
+		if ((zp->bzp_size_class_mask & M0_BITS(c)) == 0)
+			continue;
+		m0_list_for_each_entry(&zp->bzp_size_class[c], le,
+				       struct m0_lext, le_size_link) {
+			if (m0_ext_length(&le->le_ext) < len)
+				continue;
+			balloc_measure_extent(bac, grp, alloc_flag,
+					      &le->le_ext, end_of_group);
+			if (bac->bac_status != M0_BALLOC_AC_CONTINUE)
+				return;
+		}
+	}
+}
+
 /**
  * This function scans the specified group for a goal. If maximal
  * group is locked.
@@ -2320,6 +3016,7 @@ static int balloc_wild_scan_group(struct balloc_allocation_context *bac,
 				  struct m0_balloc_group_info *grp,
 				  enum m0_balloc_allocation_flag alloc_flag)
 {
+	struct m0_balloc_zone_param *zp;
 	struct m0_list  *list;
 	m0_bcount_t	 free;
 	struct m0_ext	*ex;
@@ -2331,12 +3028,12 @@ static int balloc_wild_scan_group(struct balloc_allocation_context *bac,
 #ifdef __SPARE_SPACE__
 	free = is_spare(bac->bac_flags) ? group_spare_freeblocks_get(grp) :
 		group_freeblocks_get(grp);
-	list = is_spare(alloc_flag) ? &grp->bgi_spare.bzp_extents :
-		 &grp->bgi_normal.bzp_extents;
+	zp = is_spare(alloc_flag) ? &grp->bgi_spare : &grp->bgi_normal;
 #else
 	free = group_freeblocks_get(grp);
-	list = &grp->bgi_normal.bzp_extents;
+	zp = &grp->bgi_normal;
 #endif
+	list = &zp->bzp_extents;
 
 	/**
 	 * Check to detect the block allocation request which came earlier
@@ -2366,6 +3063,21 @@ static int balloc_wild_scan_group(struct balloc_allocation_context *bac,
 		(unsigned long long)grp->bgi_groupno,
 		(unsigned long long)free);
 
+	/*
+	 * Look up extents satisfying the goal in the size index first. The
+	 * whole list is scanned only if there is no such extent, to find the
+	 * best smaller one.
+	 */
+	if (zp->bzp_size_class != NULL) {
+		balloc_index_scan_group(bac, grp, zp, alloc_flag, end_of_group);
+		if (bac->bac_status != M0_BALLOC_AC_CONTINUE)
+			return M0_RC(0);
+		if (m0_ext_length(&bac->bac_best) >=
+		    m0_ext_length(&bac->bac_goal))
+			return M0_RC(balloc_check_limits(bac, grp, 1,
+							 alloc_flag));
+	}
+
 	m0_list_for_each_entry(list, le, struct m0_lext, le_link) {
 		ex = &le->le_ext;
 		if (m0_ext_length(ex) > free) {
@@ -2404,6 +3116,7 @@ static int balloc_try_best_found(struct balloc_allocation_context *bac,
 	struct m0_ext		    *cur = NULL;
 	struct m0_lext		    *le;
 	struct m0_list              *list;
+	struct m0_balloc_zone_param *zp;
 	int			     rc = -ENOENT;
 
 	M0_ENTRY();
@@ -2422,17 +3135,28 @@ static int balloc_try_best_found(struct balloc_allocation_context *bac,
 		goto out;
 
 	rc = -ENOENT;
-	list = is_spare(alloc_flag) ? group_spare_ext(grp) :
-		 group_normal_ext(grp);
-	m0_list_for_each_entry(list, le, struct m0_lext, le_link) {
-		ex = &le->le_ext;
-		if (m0_ext_equal(ex, best)) {
-			rc = balloc_use_best_found(bac,
-						   zone_start_get(grp,
-								  alloc_flag));
-			break;
-		} else if (ex->e_start > best->e_start)
-			goto out;
+	zp = is_spare(alloc_flag) ? &grp->bgi_spare : &grp->bgi_normal;
+	if (zp->bzp_size_class != NULL) {
+		/* the best extent can only be in its size class */
+		list = &zp->bzp_size_class[m0_log2(m0_ext_length(best))];
+		m0_list_for_each_entry(list, le, struct m0_lext, le_size_link) {
+			if (m0_ext_equal(&le->le_ext, best)) {
+				rc = balloc_use_best_found(bac,
+					zone_start_get(grp, alloc_flag));
+				break;
+			}
+		}
+	} else {
+		list = &zp->bzp_extents;
+		m0_list_for_each_entry(list, le, struct m0_lext, le_link) {
+			ex = &le->le_ext;
+			if (m0_ext_equal(ex, best)) {
+				rc = balloc_use_best_found(bac,
+					zone_start_get(grp, alloc_flag));
+				break;
+			} else if (ex->e_start > best->e_start)
+				goto out;
+		}
 	}
 
 	/* update db according to the allocation result */
@@ -2479,6 +3203,58 @@ static bool is_free_space_unavailable(struct m0_balloc_group_info *grp,
 			group_freeblocks_get(grp) == 0;
 }
 
+/**
+   Tries to allocate the requested length exactly at the goal.
+
+   This keeps extents allocated for consecutive writes to the same object
+   physically contiguous. The goal group is skipped if it is busy. Only the
+   normal zone is tried.
+ */
+static int balloc_try_goal(struct balloc_allocation_context *bac)
+{
+	struct m0_balloc_group_info *grp;
+	struct m0_lext              *le;
+	struct m0_ext               *goal  = &bac->bac_goal;
+	m0_bindex_t                  group;
+	int                          rc;
+
+	M0_ENTRY("goal="EXT_F, EXT_P(goal));
+
+	if (!is_normal(bac->bac_flags))
+		return M0_RC(0);
+	group = balloc_bn2gn(goal->e_start, bac->bac_ctxt);
+	if (group >= bac->bac_ctxt->cb_sb.bsb_groupcount ||
+	    balloc_group_is_short(bac->bac_ctxt, group, m0_ext_length(goal)))
+		return M0_RC(0);
+	grp = m0_balloc_gn2info(bac->bac_ctxt, group);
+	if (m0_balloc_trylock_group(grp) != 0)
+		return M0_RC(0);
+	if (group_freeblocks_get(grp) < m0_ext_length(goal)) {
+		m0_balloc_unlock_group(grp);
+		return M0_RC(0);
+	}
+	rc = m0_balloc_load_extents(bac->bac_ctxt, grp);
+	if (rc == 0) {
+		m0_list_for_each_entry(group_normal_ext(grp), le,
+				       struct m0_lext, le_link) {
+			if (le->le_ext.e_start > goal->e_start)
+				break;
+			if (!m0_ext_is_partof(&le->le_ext, goal))
+				continue;
+			bac->bac_found++;
+			bac->bac_final = *goal;
+			bac->bac_status = M0_BALLOC_AC_FOUND;
+			rc = balloc_alloc_db_update(bac->bac_ctxt, bac->bac_tx,
+						    grp, &bac->bac_final,
+						    M0_BALLOC_NORMAL_ZONE,
+						    &le->le_ext);
+			break;
+		}
+	}
+	m0_balloc_unlock_group(grp);
+	return M0_RC(rc);
+}
+
 static int
 balloc_regular_allocator(struct balloc_allocation_context *bac)
 {
@@ -2495,15 +3271,14 @@ balloc_regular_allocator(struct balloc_allocation_context *bac)
 	M0_ENTRY("goal=0x%lx len=%d",
 		(unsigned long)bac->bac_goal.e_start, (int)len);
 
-#if 0
 	/* first, try the goal */
-	rc = balloc_find_by_goal(bac);
-	if (rc != 0 || bac->bac_status == M0_BALLOC_AC_FOUND ||
-	    (bac->bac_flags & M0_BALLOC_HINT_GOAL_ONLY)) {
-		M0_LEAVE();
-		return M0_RC(rc);
+	if ((bac->bac_flags & M0_BALLOC_HINT_TRY_GOAL) &&
+	    bac->bac_stream == NULL) {
+		rc = balloc_try_goal(bac);
+		if (rc != 0 || bac->bac_status == M0_BALLOC_AC_FOUND ||
+		    (bac->bac_flags & M0_BALLOC_HINT_GOAL_ONLY))
+			goto out;
 	}
-#endif
 
 	bac->bac_order2 = 0;
 	/*
@@ -2524,17 +3299,17 @@ repeat:
 		M0_LOG(M0_DEBUG, "cr=%d", cr);
 		bac->bac_criteria = cr;
 		/*
-		 * searching for the right group start
-		 * from the goal value specified
+		 * searching for the right group start from the stream
+		 * cursor or from the goal value specified
 		 */
-		group = balloc_bn2gn(bac->bac_goal.e_start, bac->bac_ctxt);
-
-		for (i = 0; i < ngroups; group++, i++) {
+		for (i = 0; i < ngroups; i++) {
 			struct m0_balloc_group_info *grp;
 
-			if (group >= ngroups)
-				group = 0;
-
+			group = balloc_search_group(bac, i);
+			/* Skip empty groups without loading them. */
+			if (!is_spare(bac->bac_flags) &&
+			    balloc_group_is_short(bac->bac_ctxt, group, 1))
+				continue;
 			grp = m0_balloc_gn2info(bac->bac_ctxt, group);
 			// m0_balloc_debug_dump_group("searching group ...",
 			//			 grp);
@@ -2545,6 +3320,11 @@ repeat:
 				/* This group is under processing by others. */
 				continue;
 			}
+			if (grp->bgi_rc != 0) {
+				rc = M0_ERR(grp->bgi_rc);
+				m0_balloc_unlock_group(grp);
+				goto out;
+			}
 
 			/* quick check to skip empty groups */
 			if (is_free_space_unavailable(grp, bac->bac_flags)) {
@@ -2613,6 +3393,13 @@ repeat:
 			goto repeat;
 		}
 	}
+	if (bac->bac_status == M0_BALLOC_AC_FOUND && bac->bac_stream != NULL) {
+		struct m0_balloc_stream *bs = bac->bac_stream;
+
+		group = balloc_bn2gn(bac->bac_final.e_start, bac->bac_ctxt);
+		if (group >= bs->bs_first && group < bs->bs_first + bs->bs_nr)
+			bs->bs_cursor = group;
+	}
 out:
 	M0_LEAVE();
 	if (rc == 0 && bac->bac_status != M0_BALLOC_AC_FOUND) {
@@ -2702,17 +3489,18 @@ int balloc_allocate_internal(struct m0_balloc *ctx,
 	balloc_init_ac(&bac, ctx, tx, req);
 
 	/* Step 1. query the pre-allocation */
-	if (!balloc_use_prealloc(&bac)) {
+	rc = balloc_use_prealloc(&bac);
+	if (rc == 0 && bac.bac_status != M0_BALLOC_AC_FOUND) {
 		/* we did not find suitable free space in prealloc. */
 
 		balloc_normalize_request(&bac);
 
 		/* Step 2. Iterate over groups */
 		rc = balloc_regular_allocator(&bac);
-		if (rc == 0 && bac.bac_status == M0_BALLOC_AC_FOUND) {
-			/* store the result in req and they will be returned */
-			req->bar_result = bac.bac_final;
-		}
+	}
+	if (rc == 0 && bac.bac_status == M0_BALLOC_AC_FOUND) {
+		/* store the result in req and they will be returned */
+		req->bar_result = bac.bac_final;
 	}
 out:
 	return M0_RC(rc);
@@ -2908,6 +3696,10 @@ static int balloc_reserve_extent(struct m0_ad_balloc *ballroom,
 	/* Take lock of the group. */
 	m0_balloc_lock_group(grp);
 
+	if (grp->bgi_rc != 0) {
+		rc = M0_ERR(grp->bgi_rc);
+		goto out_unlock;
+	}
 	/* Check if space is available in group. */
 	if (is_free_space_unavailable(grp, alloc_zone)) {
 		rc = M0_ERR(-ENOSPC);
@@ -2950,7 +3742,7 @@ out:
  */
 static int balloc_alloc(struct m0_ad_balloc *ballroom, struct m0_dtx *tx,
 			m0_bcount_t count, struct m0_ext *out,
-			uint64_t alloc_zone)
+			uint64_t alloc_zone, uint64_t owner)
 {
 	struct m0_balloc              *motr = b2m0(ballroom);
 	struct m0_balloc_allocate_req  req;
@@ -2964,15 +3756,17 @@ static int balloc_alloc(struct m0_ad_balloc *ballroom, struct m0_dtx *tx,
 
 	req.bar_goal  = out->e_start; /* this also plays as the goal */
 	req.bar_len   = count;
+	req.bar_owner = owner;
 #ifdef __SPARE_SPACE__
 	req.bar_flags = alloc_zone /*M0_BALLOC_HINT_DATA | M0_BALLOC_HINT_TRY_GOAL*/;
 #else
-	req.bar_flags = M0_BALLOC_NORMAL_ZONE;
+	req.bar_flags = M0_BALLOC_NORMAL_ZONE |
+			(alloc_zone & M0_BALLOC_HINT_TRY_GOAL);
 #endif
 
 	M0_SET0(out);
 
-	freeblocks = motr->cb_sb.bsb_freeblocks;
+	freeblocks = m0_balloc_free_blocks(motr);
 	rc = balloc_allocate_internal(motr, &tx->tx_betx, &req);
 	if (rc == 0) {
 		if (m0_ext_is_empty(&req.bar_result)) {
@@ -2983,13 +3777,14 @@ static int balloc_alloc(struct m0_ad_balloc *ballroom, struct m0_dtx *tx,
 			m0_ext_init(out);
 			m0_mutex_lock(&motr->cb_sb_mutex.bm_u.mutex);
 			motr->cb_last = out->e_end;
+			balloc_prealloc_update(motr, owner, out);
 			m0_mutex_unlock(&motr->cb_sb_mutex.bm_u.mutex);
 		}
 	}
 	M0_LOG(M0_DEBUG, "BAlloc=%p rc=%d freeblocks %llu -> %llu",
 			 motr, rc,
 			 (unsigned long long)freeblocks,
-			 (unsigned long long)motr->cb_sb.bsb_freeblocks);
+			 (unsigned long long)m0_balloc_free_blocks(motr));
 
 
 	return M0_RC(rc);
@@ -3010,12 +3805,12 @@ static int balloc_free(struct m0_ad_balloc *ballroom, struct m0_dtx *tx,
 	req.bfr_physical = ext->e_start;
 	req.bfr_len	 = m0_ext_length(ext);
 
-	freeblocks = motr->cb_sb.bsb_freeblocks;
+	freeblocks = m0_balloc_free_blocks(motr);
 	rc = balloc_free_internal(motr, &tx->tx_betx, &req);
 	M0_LOG(M0_DEBUG, "BFree=%p rc=%d freeblocks %llu -> %llu",
 			 motr, rc,
 			 (unsigned long long)freeblocks,
-			 (unsigned long long)motr->cb_sb.bsb_freeblocks);
+			 (unsigned long long)m0_balloc_free_blocks(motr));
 	if (rc == 0)
 		motr->cb_last = ext->e_start;
 
@@ -3042,11 +3837,43 @@ static int balloc_init(struct m0_ad_balloc *ballroom, struct m0_be_seg *db,
 	return M0_RC(rc);
 }
 
-static void balloc_fini(struct m0_ad_balloc *ballroom)
+/**
+ * drop the preallocation window of the owner.
+ */
+static void balloc_release(struct m0_ad_balloc *ballroom, uint64_t owner)
+{
+	M0_PRE(owner != 0);
+	balloc_prealloc_release(b2m0(ballroom), owner);
+}
+
+static void balloc_fini(struct m0_ad_balloc *ballroom,
+			struct m0_sm_group *grp)
 {
 	struct m0_balloc *motr = b2m0(ballroom);
+	int               rc;
 
 	M0_ENTRY();
+	M0_PRE(m0_sm_group_is_locked(grp));
+
+	if (!m0_be_domain_is_ready(motr->cb_be_seg->bs_domain)) {
+		/*
+		 * No transactions can be opened. The persistent super block
+		 * still has M0_BALLOC_SB_WRITEBACK set, so the free counters
+		 * are rebuilt from the group descriptors on the next mount.
+		 */
+		M0_LOG(M0_WARN, "BE is stopping, free blocks are rebuilt "
+		       "on the next mount");
+	} else {
+		/* Write the exact counters, they are not rebuilt then. */
+		m0_mutex_lock(&motr->cb_sb_mutex.bm_u.mutex);
+		balloc_free_fold(motr);
+		motr->cb_sb.bsb_state &= ~M0_BALLOC_SB_WRITEBACK;
+		m0_mutex_unlock(&motr->cb_sb_mutex.bm_u.mutex);
+		rc = sb_update(motr, grp);
+		if (rc != 0)
+			M0_LOG(M0_WARN, "super block update failed: rc=%d, "
+			       "free blocks are rebuilt on the next mount", rc);
+	}
 
 	balloc_fini_internal(motr);
 
@@ -3058,6 +3885,7 @@ static const struct m0_ad_balloc_ops balloc_ops = {
 	.bo_fini	   = balloc_fini,
 	.bo_alloc	   = balloc_alloc,
 	.bo_free	   = balloc_free,
+	.bo_release	   = balloc_release,
 	.bo_alloc_credit   = balloc_alloc_credit,
 	.bo_free_credit    = balloc_free_credit,
 	.bo_reserve_extent = balloc_reserve_extent,
@@ -3072,7 +3900,10 @@ static int balloc_trees_create(struct m0_balloc    *bal,
 	struct m0_btree_type       bt;
 	struct m0_btree_op         b_op = {};
 	struct m0_fid              fid;
-	struct m0_btree_rec_key_op ge_keycmp = {.rko_keycmp = ge_tree_cmp, };
+	struct m0_btree_rec_key_op ge_keycmp = {
+		.rko_keycmp = ge_tree_cmp,
+		.rko_flags  = M0_BKF_U64,
+	};
 
 	M0_ALLOC_PTR(bal->cb_db_group_extents);
 	if (bal->cb_db_group_extents == NULL)
@@ -29,6 +29,9 @@
 #include "lib/types.h"
 #include "lib/list.h"
 #include "lib/mutex.h"
+#include "lib/thread.h"
+#include "lib/time.h"
+#include "lib/atomic.h"
 #include "btree/btree.h"
 #include "format/format.h"
 #include "stob/ad.h"
@@ -127,13 +130,52 @@ enum m0_balloc_allocation_flag {
 	M0_BALLOC_NORMAL_ZONE             = 1 << 13,
 };
 
+enum {
+	/** Number of size classes of free extents, see bzp_size_class. */
+	M0_BALLOC_SIZE_CLASS_NR = 64,
+	/** Maximal number of allocation streams, see m0_balloc_stream. */
+	M0_BALLOC_STREAM_NR     = 16,
+	/** Number of preallocation windows, see m0_balloc_prealloc. */
+	M0_BALLOC_PREALLOC_NR   = 64,
+	/** Length of a new preallocation window, in blocks. */
+	M0_BALLOC_PREALLOC_LEN  = 4096,
+	/**
+	 * Minimal number of groups for which group descriptors are loaded
+	 * in background after mount, see m0_balloc_warmup.
+	 */
+	M0_BALLOC_WARMUP_GROUPS = 4096,
+	/** Value of m0_balloc::cb_group_free[] for a group not loaded yet. */
+	M0_BALLOC_GROUP_FREE_UNKNOWN = 0xffffffff,
+	/** Number of per-locality free block counters, see m0_balloc_free. */
+	M0_BALLOC_FREE_NR       = 64,
+};
+
+/** Preallocation windows unused for this long are dropped. */
+#define M0_BALLOC_PREALLOC_TIMEOUT M0_MKTIME(30, 0)
+
+/**
+ * Default interval of the super block write-back, see
+ * m0_balloc::cb_sb_wb_interval.
+ */
+#define M0_BALLOC_SB_WRITEBACK_INTERVAL M0_MKTIME(10, 0)
+
 struct m0_balloc_zone_param {
 	enum m0_balloc_allocation_flag  bzp_type;
 	struct m0_ext                   bzp_range;
 	m0_bcount_t                     bzp_freeblocks;
 	m0_bcount_t                     bzp_fragments;
 	m0_bcount_t                     bzp_maxchunk;
+	/** Free extents ordered by address. */
 	struct m0_list                  bzp_extents;
+	/**
+	 * Free extents indexed by size: an extent of length len is in the
+	 * list bzp_size_class[m0_log2(len)]. The array is allocated with the
+	 * extents in m0_balloc_load_extents() and freed in
+	 * m0_balloc_release_extents(), NULL otherwise.
+	 */
+	struct m0_list                 *bzp_size_class;
+	/** Bit i is set iff bzp_size_class[i] is not empty. */
+	uint64_t                        bzp_size_class_mask;
 };
 
 /** Linked extents */
@@ -141,6 +183,9 @@ struct m0_lext {
 	/** Is allocated separately from bgi_extents array? */
 	bool                le_is_alloc;
 	struct m0_list_link le_link;
+	/** Linkage to m0_balloc_zone_param::bzp_size_class[le_size_class]. */
+	struct m0_list_link le_size_link;
+	unsigned            le_size_class;
 	struct m0_ext       le_ext;
 };
 
@@ -158,10 +203,15 @@ struct m0_balloc_group_info {
 	struct m0_lext              *bgi_extents;
 	/** per-group lock */
 	struct m0_be_mutex           bgi_mutex;
+	/**
+	 * Error of the group descriptor lookup, returned by allocations and
+	 * frees in the group.
+	 */
+	int                          bgi_rc;
 };
 
 enum m0_balloc_group_info_state {
-	/** inited from disk */
+	/** inited from disk, on the first m0_balloc_gn2info() of the group */
 	M0_BALLOC_GROUP_INFO_INIT = 1 << 0,
 	/** dirty, need sync */
 	M0_BALLOC_GROUP_INFO_DIRTY = 1 << 1,
@@ -202,6 +252,13 @@ struct m0_balloc_super_block {
 
 enum m0_balloc_super_block_state {
 	M0_BALLOC_SB_DIRTY =  1 << 0,
+	/**
+	 * Free block counters of the super block are written back lazily and
+	 * may be behind the group descriptors. Set while balloc is mounted and
+	 * cleared by a clean unmount; if it is found set on mount, the
+	 * counters are rebuilt from the group descriptors.
+	 */
+	M0_BALLOC_SB_WRITEBACK = 1 << 1,
 };
 
 enum m0_balloc_super_block_version {
@@ -222,11 +279,83 @@ enum {
 	BALLOC_ROOT_NODE_SIZE = 4096,
 };
 
+/**
+ * Background loading of group descriptors.
+ *
+ * Descriptors are loaded on the first use of a group, see
+ * m0_balloc_gn2info(). For balloc with at least M0_BALLOC_WARMUP_GROUPS
+ * groups a thread started at mount loads the remaining ones in group order,
+ * so that allocations do not pay for the lookups later.
+ */
+struct m0_balloc_warmup {
+	struct m0_thread bw_thread;
+	/** Set by balloc fini to stop the thread. */
+	bool             bw_stop;
+};
+
 /**
    BE-backed in-memory data structure for the balloc environment.
 
    It includes pointers to db, various flags and parameters.
  */
+/**
+ * Allocation stream.
+ *
+ * Each stream owns a contiguous slice of groups. Allocations without an
+ * explicit goal made from a locality search the groups of the locality's
+ * stream first, starting from the group where the stream allocated last
+ * time, so that localities do not contend on the same group locks. When
+ * the slice has no suitable space the regular search over all groups is
+ * used.
+ */
+struct m0_balloc_stream {
+	/** First group of the slice. */
+	m0_bindex_t bs_first;
+	/** Number of groups in the slice. */
+	m0_bcount_t bs_nr;
+	/**
+	 * Group where the stream allocated last time. This is only a hint, it
+	 * is updated without a lock.
+	 */
+	m0_bindex_t bs_cursor;
+};
+
+/**
+ * Preallocation window.
+ *
+ * Blocks right after the last allocation of an owner (an object), reserved
+ * in memory for its next allocations. Nothing is written to the BE segment
+ * until the blocks are really allocated, so a window is lost, not leaked,
+ * on restart. Other owners place their allocations past the window when the
+ * free extent is large enough and take the blocks otherwise; the window is
+ * then dropped at the owner's next allocation.
+ */
+struct m0_balloc_prealloc {
+	/** Owner of the window, 0 if the slot is unused. */
+	uint64_t      bp_owner;
+	/** Reserved blocks. */
+	struct m0_ext bp_ext;
+	/** The window is dropped after this time. */
+	m0_time_t     bp_expire;
+};
+
+/**
+ * Free block counter of a locality.
+ *
+ * Allocations and frees change the counter of the current locality instead
+ * of the super block, so that transactions neither capture the super block
+ * nor share a cache line for the counters. The changes are moved to the super
+ * block by the periodic write-back, see m0_balloc::cb_sb_wb_interval.
+ */
+struct m0_balloc_free {
+	/** Change of free blocks since the last write-back. */
+	struct m0_atomic64 bf_blocks;
+#ifdef __SPARE_SPACE__
+	/** Change of free spare blocks since the last write-back. */
+	struct m0_atomic64 bf_spare;
+#endif
+} __AAL(64);
+
 struct m0_balloc {
 	struct m0_format_header      cb_header;
 
@@ -268,6 +397,36 @@ struct m0_balloc {
 
 	/** array of group info */
 	struct m0_balloc_group_info *cb_group_info;
+	/** array of allocation streams, NULL when there are too few groups */
+	struct m0_balloc_stream     *cb_streams;
+	/** number of elements in cb_streams */
+	uint32_t                     cb_stream_nr;
+	/**
+	 * array of M0_BALLOC_PREALLOC_NR preallocation windows, protected by
+	 * cb_sb_mutex
+	 */
+	struct m0_balloc_prealloc   *cb_prealloc;
+	/**
+	 * array of free block counts of the normal zones as of the last
+	 * written group descriptors, saturated below
+	 * M0_BALLOC_GROUP_FREE_UNKNOWN. Updated under the group lock and read
+	 * without it to skip groups without loading them.
+	 */
+	uint32_t                    *cb_group_free;
+	/** background group loading, NULL when not running */
+	struct m0_balloc_warmup     *cb_warmup;
+	/** array of M0_BALLOC_FREE_NR per-locality free block counters */
+	struct m0_balloc_free       *cb_free;
+	/**
+	 * Interval of the super block write-back. An allocation or free
+	 * captures the super block only if this time passed since the last
+	 * write-back, 0 makes every one of them capture it. Set to
+	 * M0_BALLOC_SB_WRITEBACK_INTERVAL on mount, see
+	 * m0_balloc_sb_writeback_set().
+	 */
+	m0_time_t                    cb_sb_wb_interval;
+	/** time of the next write-back, protected by cb_sb_mutex */
+	m0_time_t                    cb_sb_wb_due;
 	/** super block lock */
 	struct m0_be_mutex           cb_sb_mutex;
 	struct m0_be_seg            *cb_be_seg;
@@ -326,6 +485,8 @@ struct m0_balloc_allocate_req {
         struct m0_ext   bar_result;  /*< [out]physical offset, result */
 
 	void           *bar_prealloc;/*< [in][out]User opaque prealloc result */
+	uint64_t	bar_owner;   /*< [in]owner of the preallocation window,
+				      * 0 for none */
 };
 
 /**
@@ -382,6 +543,25 @@ M0_INTERNAL int m0_balloc_create(uint64_t              cid,
 
 M0_INTERNAL void m0_balloc_group_desc_init(struct m0_balloc_group_desc *desc);
 
+/**
+   Returns the number of free blocks, including the changes not yet written
+   back to the super block.
+ */
+M0_INTERNAL m0_bcount_t m0_balloc_free_blocks(const struct m0_balloc *cb);
+
+#ifdef __SPARE_SPACE__
+/** Returns the number of free spare blocks, see m0_balloc_free_blocks(). */
+M0_INTERNAL m0_bcount_t m0_balloc_free_spare(const struct m0_balloc *cb);
+#endif
+
+/**
+   Sets the interval of the super block write-back of a mounted balloc, see
+   m0_balloc::cb_sb_wb_interval. The next allocation or free writes the
+   counters back.
+ */
+M0_INTERNAL void m0_balloc_sb_writeback_set(struct m0_balloc *cb,
+					    m0_time_t         interval);
+
 /* Interfaces for UT */
 M0_INTERNAL void m0_balloc_debug_dump_sb(const char *tag,
 					 struct m0_balloc_super_block *sb);
@@ -390,6 +570,9 @@ M0_INTERNAL void m0_balloc_debug_dump_group_extent(const char *tag,
 						   *grp);
 
 M0_INTERNAL int m0_balloc_release_extents(struct m0_balloc_group_info *grp);
+/** Checks that the size index of loaded group extents matches the extents. */
+M0_INTERNAL bool
+m0_balloc_group_index_invariant(const struct m0_balloc_group_info *grp);
 M0_INTERNAL int m0_balloc_load_extents(struct m0_balloc *cb,
 				       struct m0_balloc_group_info *grp);
 M0_INTERNAL struct m0_balloc_group_info *m0_balloc_gn2info(struct m0_balloc *cb,
@@ -61,8 +61,9 @@ bool balloc_ut_invariant(struct m0_balloc *motr_balloc,
 			 struct m0_ext alloc_ext,
 			 int balloc_invariant_flag)
 {
-	m0_bcount_t len = m0_ext_length(&alloc_ext);
-	m0_bcount_t group;
+	struct m0_balloc_group_info *grp;
+	m0_bcount_t                  len = m0_ext_length(&alloc_ext);
+	m0_bcount_t                  group;
 
 	group = alloc_ext.e_start >> motr_balloc->cb_sb.bsb_gsbits;
 
@@ -82,10 +83,32 @@ bool balloc_ut_invariant(struct m0_balloc *motr_balloc,
 		 return false;
 	}
 
-	return motr_balloc->cb_group_info[group].bgi_normal.bzp_freeblocks ==
+	grp = m0_balloc_gn2info(motr_balloc, group);
+	return grp->bgi_normal.bzp_freeblocks ==
 		prev_group_info_free_blocks[group] &&
-		motr_balloc->cb_sb.bsb_freeblocks ==
-		prev_free_blocks;
+		m0_balloc_free_blocks(motr_balloc) ==
+		prev_free_blocks &&
+		m0_balloc_group_index_invariant(grp);
+}
+
+/** Checks that allocation streams split all groups into slices. */
+static bool balloc_ut_streams_check(const struct m0_balloc *motr_balloc)
+{
+	m0_bindex_t next = 0;
+	uint32_t    i;
+
+	if (motr_balloc->cb_streams == NULL)
+		return motr_balloc->cb_stream_nr == 0;
+	for (i = 0; i < motr_balloc->cb_stream_nr; ++i) {
+		const struct m0_balloc_stream *bs = &motr_balloc->cb_streams[i];
+
+		if (bs->bs_first != next || bs->bs_nr == 0 ||
+		    bs->bs_cursor < bs->bs_first ||
+		    bs->bs_cursor >= bs->bs_first + bs->bs_nr)
+			return false;
+		next += bs->bs_nr;
+	}
+	return next == motr_balloc->cb_sb.bsb_groupcount;
 }
 
 /**
@@ -126,13 +149,20 @@ int test_balloc_ut_ops(struct m0_be_ut_backend *ut_be, struct m0_be_seg *seg,
 
 	if (rc != 0)
 		goto out;
+	M0_UT_ASSERT(balloc_ut_streams_check(motr_balloc));
 
-	prev_free_blocks = motr_balloc->cb_sb.bsb_freeblocks;
+	prev_free_blocks = m0_balloc_free_blocks(motr_balloc);
 	M0_ALLOC_ARR(prev_group_info_free_blocks, GROUP_SIZE);
 
+	/* Group descriptors are loaded on the first use. */
+	M0_UT_ASSERT(!(motr_balloc->cb_group_info[0].bgi_state &
+		       M0_BALLOC_GROUP_INFO_INIT));
 	for (i = 0; i < GROUP_SIZE; ++i) {
 		prev_group_info_free_blocks[i] =
-			motr_balloc->cb_group_info[i].bgi_normal.bzp_freeblocks;
+			m0_balloc_gn2info(motr_balloc, i)->
+			bgi_normal.bzp_freeblocks;
+		M0_UT_ASSERT(motr_balloc->cb_group_free[i] ==
+			     prev_group_info_free_blocks[i]);
 	}
 
 	for (i = 0; i < MAX; ++i) {
@@ -150,9 +180,15 @@ int test_balloc_ut_ops(struct m0_be_ut_backend *ut_be, struct m0_be_seg *seg,
 					&motr_balloc->cb_ballroom, tx, &tmp,
 					M0_BALLOC_NORMAL_ZONE);
 		} else {
+			/* continue right after the previous extent */
+			tmp.e_start = tmp.e_end;
 			rc = motr_balloc->cb_ballroom.ab_ops->bo_alloc(
 					&motr_balloc->cb_ballroom, &dtx,
-				        count, &tmp, M0_BALLOC_NORMAL_ZONE);
+					count, &tmp, M0_BALLOC_NORMAL_ZONE |
+					M0_BALLOC_HINT_TRY_GOAL, 0);
+			/* all extents fit into the group of the first one */
+			M0_UT_ASSERT(ergo(rc == 0 && i > 0,
+					  tmp.e_start == ext[i - 1].e_end));
 		}
 
 		M0_UT_ASSERT(rc == 0);
@@ -166,6 +202,7 @@ int test_balloc_ut_ops(struct m0_be_ut_backend *ut_be, struct m0_be_seg *seg,
 		/* The result extent length should be less than	or equal to the
 		 * requested length. */
 		M0_UT_ASSERT(m0_ext_length(&ext[i]) <= count);
+		M0_UT_ASSERT(balloc_ut_streams_check(motr_balloc));
 		M0_UT_ASSERT(balloc_ut_invariant(motr_balloc, ext[i],
 						 INVAR_ALLOC));
 		M0_LOG(M0_INFO, "%3d:rc=%d: req=%5d, got=%5d: "
@@ -190,6 +227,7 @@ int test_balloc_ut_ops(struct m0_be_ut_backend *ut_be, struct m0_be_seg *seg,
 			if (rc == 0)
 				m0_balloc_debug_dump_group_extent(
 					"balloc ut", grp);
+			M0_UT_ASSERT(m0_balloc_group_index_invariant(grp));
 			m0_balloc_release_extents(grp);
 			m0_balloc_unlock_group(grp);
 		}
@@ -232,8 +270,8 @@ int test_balloc_ut_ops(struct m0_be_ut_backend *ut_be, struct m0_be_seg *seg,
 		m0_ut_be_tx_end(tx);
 	}
 
-	M0_UT_ASSERT(motr_balloc->cb_sb.bsb_freeblocks == prev_free_blocks);
-	if (motr_balloc->cb_sb.bsb_freeblocks != prev_free_blocks) {
+	M0_UT_ASSERT(m0_balloc_free_blocks(motr_balloc) == prev_free_blocks);
+	if (m0_balloc_free_blocks(motr_balloc) != prev_free_blocks) {
 		M0_LOG(M0_ERROR, "Size mismatch during block reclaim");
 		rc = -EINVAL;
 	}
@@ -248,6 +286,7 @@ int test_balloc_ut_ops(struct m0_be_ut_backend *ut_be, struct m0_be_seg *seg,
 			if (rc == 0)
 				m0_balloc_debug_dump_group_extent(
 					"balloc ut", grp);
+			M0_UT_ASSERT(m0_balloc_group_index_invariant(grp));
 			M0_UT_ASSERT(grp->bgi_normal.bzp_freeblocks ==
 				     motr_balloc->cb_sb.bsb_groupsize -
 				     spare_size);
@@ -256,7 +295,8 @@ int test_balloc_ut_ops(struct m0_be_ut_backend *ut_be, struct m0_be_seg *seg,
 		}
 	}
 
-	motr_balloc->cb_ballroom.ab_ops->bo_fini(&motr_balloc->cb_ballroom);
+	motr_balloc->cb_ballroom.ab_ops->bo_fini(&motr_balloc->cb_ballroom,
+						 grp);
 
 out:
 	m0_free(prev_group_info_free_blocks);
@@ -299,6 +339,86 @@ void test_reserve_extent()
 	m0_be_ut_backend_fini(&ut_be);
 }
 
+enum {
+	PREALLOC_UT_OWNERS = 2,
+	PREALLOC_UT_ROUNDS = 8,
+	PREALLOC_UT_LEN    = 256,
+};
+
+/**
+ * Interleaved allocations of several owners get contiguous space per owner
+ * from their preallocation windows.
+ */
+void test_prealloc()
+{
+	struct m0_be_ut_backend	 ut_be;
+	struct m0_be_ut_seg	 ut_seg;
+	struct m0_sm_group      *grp;
+	struct m0_balloc        *bal;
+	struct m0_ad_balloc     *ballroom;
+	struct m0_dtx            dtx = {};
+	struct m0_be_tx         *tx  = &dtx.tx_betx;
+	struct m0_be_tx_credit   cred;
+	struct m0_ext            ext[PREALLOC_UT_ROUNDS][PREALLOC_UT_OWNERS];
+	int                      i;
+	int                      j;
+	int                      rc;
+
+	M0_SET0(&ut_be);
+	m0_be_ut_backend_init(&ut_be);
+	m0_be_ut_seg_init(&ut_seg, &ut_be, 1ULL << 24);
+	grp = m0_be_ut_backend_sm_group_lookup(&ut_be);
+	rc = m0_balloc_create(0, ut_seg.bus_seg, grp, &bal,
+			      &M0_FID_INIT(0, 1));
+	M0_UT_ASSERT(rc == 0);
+	ballroom = &bal->cb_ballroom;
+	rc = ballroom->ab_ops->bo_init(ballroom, ut_seg.bus_seg,
+				       BALLOC_DEF_BLOCK_SHIFT,
+				       BALLOC_DEF_CONTAINER_SIZE,
+				       BALLOC_DEF_BLOCKS_PER_GROUP,
+				       m0_stob_ad_spares_calc(
+					       BALLOC_DEF_BLOCKS_PER_GROUP));
+	M0_UT_ASSERT(rc == 0);
+
+	for (i = 0; i < PREALLOC_UT_ROUNDS; ++i) {
+		for (j = 0; j < PREALLOC_UT_OWNERS; ++j) {
+			cred = M0_BE_TX_CREDIT(0, 0);
+			ballroom->ab_ops->bo_alloc_credit(ballroom, 1, &cred);
+			m0_ut_be_tx_begin(tx, &ut_be, &cred);
+			ext[i][j] = (struct m0_ext) {};
+			rc = ballroom->ab_ops->bo_alloc(ballroom, &dtx,
+							PREALLOC_UT_LEN,
+							&ext[i][j],
+							M0_BALLOC_NORMAL_ZONE,
+							j + 1);
+			M0_UT_ASSERT(rc == 0);
+			M0_UT_ASSERT(m0_ext_length(&ext[i][j]) ==
+				     PREALLOC_UT_LEN);
+			M0_UT_ASSERT(ergo(i > 0, ext[i][j].e_start ==
+					  ext[i - 1][j].e_end));
+			m0_ut_be_tx_end(tx);
+		}
+	}
+	for (j = 0; j < PREALLOC_UT_OWNERS; ++j)
+		ballroom->ab_ops->bo_release(ballroom, j + 1);
+
+	for (i = 0; i < PREALLOC_UT_ROUNDS; ++i) {
+		for (j = 0; j < PREALLOC_UT_OWNERS; ++j) {
+			cred = M0_BE_TX_CREDIT(0, 0);
+			ballroom->ab_ops->bo_free_credit(ballroom, 1, &cred);
+			m0_ut_be_tx_begin(tx, &ut_be, &cred);
+			rc = ballroom->ab_ops->bo_free(ballroom, &dtx,
+						       &ext[i][j]);
+			M0_UT_ASSERT(rc == 0);
+			m0_ut_be_tx_end(tx);
+		}
+	}
+
+	ballroom->ab_ops->bo_fini(ballroom, grp);
+	m0_be_ut_seg_fini(&ut_seg);
+	m0_be_ut_backend_fini(&ut_be);
+}
+
 static int test_balloc_ut_suite_init(void)
 {
 	m0_btree_glob_init();
@@ -318,6 +438,7 @@ struct m0_ut_suite balloc_ut = {
         .ts_tests = {
 		{ "balloc", test_balloc},
 		{ "reserve blocks for extmap", test_reserve_extent},
+		{ "preallocation windows", test_prealloc},
 		{ NULL, NULL }
         }
 };
@@ -52,6 +52,20 @@ enum m0_avi_be_labels {
 	M0_AVI_BE_TX_ATTR_RA_PREP_TC_REG_SIZE,
 	M0_AVI_BE_TX_ATTR_RA_CAPT_TC_REG_NR,
 	M0_AVI_BE_TX_ATTR_RA_CAPT_TC_REG_SIZE,
+
+	M0_AVI_BE_BTREE_LRU,
+
+	M0_AVI_BE_TX_ATTR_RA_AREA_REUSED,
+	/** Sum of sizes of the regions captured by transactions of a group */
+	M0_AVI_BE_GROUP_ATTR_CAPTURED_SIZE,
+	/** Size of the group regions after merging, it goes to the log */
+	M0_AVI_BE_GROUP_ATTR_REG_SIZE,
+	/** Freeze timeout chosen for a group by the engine */
+	M0_AVI_BE_GROUP_ATTR_FREEZE_TIMEOUT,
+	/** Number of transactions after which a group is frozen */
+	M0_AVI_BE_GROUP_ATTR_TX_TARGET,
+	/** Resident size of a segment, see m0_be_seg_residency_scan(). */
+	M0_AVI_BE_SEG_RESIDENT,
 } M0_XCA_ENUM;
 
 /** @} end of be group */
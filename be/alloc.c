@@ -31,6 +31,10 @@
 #include "lib/memory.h"         /* m0_addr_is_aligned */
 #include "lib/errno.h"          /* ENOSPC */
 #include "lib/misc.h"           /* memset, M0_BITS, m0_forall */
+#include "lib/atomic.h"         /* m0_mb */
+#include "lib/processor.h"      /* m0_processor_id_get */
+#include "lib/time.h"           /* m0_time_now */
+#include "lib/finject.h"        /* M0_FI_ENABLED */
 #include "motr/magic.h"
 #include "be/domain.h"          /* m0_be_domain */
 
@@ -167,10 +171,43 @@
  * - allocator credit includes 2 * size requested for alignment shift greater
  *   than M0_BE_ALLOC_SHIFT_MIN;
  * - it is not truly O(1) allocator; see m0_be_fl documentation for explanation;
- * - there is one big allocator lock that protects all allocations/deallocation.
+ * - there is one big allocator lock that protects all allocations/deallocation
+ *   which are not served by the chunk caches.
  *
  * Locks
- * Allocator lock (m0_mutex) is used to protect all allocator data.
+ * Allocator lock (m0_mutex) is used to protect all allocator data except the
+ * chunk caches. Each cache is protected by its own lock, which is never taken
+ * together with the allocator lock, except in m0_be_allocator_destroy().
+ *
+ * Chunk caches
+ * ------------
+ *
+ * Each allocator has M0_BE_ALLOC_CACHE_NR caches (m0_be_alloc_cache) of free
+ * chunks of the normal zone, indexed by the core the call is made on, like
+ * localities are. m0_be_free_aligned() puts a chunk not larger than
+ * M0_BE_ALLOC_CACHE_SIZE_MAX to the current cache if there is room in the
+ * class of its size and alignment. m0_be_alloc_aligned() takes a chunk from
+ * the class of the requested size and alignment. Neither takes the allocator
+ * lock, so small allocations and deallocations from different localities do
+ * not contend.
+ *
+ * A cached chunk remains used for the rest of the allocator: it is not in the
+ * free lists, bac_free is false and it is accounted as used in the allocator
+ * statistics. The only persistent change done by m0_be_free_aligned() and
+ * m0_be_alloc_aligned() of a cached chunk is bac_linkage_free, which is unused
+ * for used chunks, and is captured in the transaction of the call. While the
+ * chunk is cached, the link points to itself and to m0_be_allocator's
+ * ba_cache_gen.
+ *
+ * After a restart the caches are empty, the chunks cached before it are
+ * orphans (be_alloc_chunk_is_orphan()). An orphan is reclaimed as free when an
+ * adjacent chunk is freed through the allocator lock or the allocator is
+ * destroyed. m0_be_allocator_destroy() also returns all the cached chunks to
+ * the free lists.
+ *
+ * The caches are used only for the normal zone of at least
+ * M0_BE_ALLOC_CACHE_ZONE_MIN bytes, as cached chunks are not merged with
+ * adjacent free chunks.
  *
  * Space reservation for DIX recovery
  * ----------------------------------
@@ -739,6 +776,156 @@ static bool be_alloc_chunk_trymerge(struct m0_be_allocator *a,
 	return chunks_were_merged;
 }
 
+static bool be_alloc_cache_is_on(const struct m0_be_allocator *a)
+{
+	return a->ba_cache_force ||
+	       a->ba_h[M0_BAP_NORMAL]->bah_size >= M0_BE_ALLOC_CACHE_ZONE_MIN;
+}
+
+static struct m0_be_alloc_cache *be_alloc_cache_here(struct m0_be_allocator *a)
+{
+	return &a->ba_cache[m0_processor_id_get() % M0_BE_ALLOC_CACHE_NR];
+}
+
+/**
+ * Marks a used chunk as cached or not cached in its bac_linkage_free.
+ *
+ * The link is updated concurrently with be_alloc_chunk_is_orphan() calls under
+ * the allocator lock, so the generation is set before and cleared after the
+ * self pointer.
+ */
+static void be_alloc_chunk_cached_set(struct m0_be_allocator *a,
+				      struct m0_be_tx        *tx,
+				      struct be_alloc_chunk  *c,
+				      bool                    cached)
+{
+	struct m0_be_list_link *link = &c->bac_linkage_free;
+
+	if (cached) {
+		link->bll_next = (struct m0_be_list_link *)a->ba_cache_gen;
+		m0_mb();
+		link->bll_prev = link;
+	} else {
+		link->bll_prev = NULL;
+		m0_mb();
+		link->bll_next = NULL;
+	}
+	if (tx != NULL)
+		M0_BE_TX_CAPTURE_PTR(a->ba_seg, tx, link);
+}
+
+/**
+ * Returns true iff the chunk was cached by another instance of the allocator,
+ * i.e. before the restart, and can be reclaimed. Free chunks are never cached
+ * and bac_linkage_free of other used chunks is either zeroed or poisoned.
+ */
+static bool be_alloc_chunk_is_orphan(const struct m0_be_allocator *a,
+				     struct be_alloc_chunk        *c)
+{
+	struct m0_be_list_link *link = &c->bac_linkage_free;
+	struct m0_be_list_link *next;
+
+	next = link->bll_next;
+	m0_mb();
+	return !c->bac_free && link->bll_prev == link &&
+	       next != (struct m0_be_list_link *)a->ba_cache_gen;
+}
+
+/**
+ * Takes a chunk of at least size bytes allocated with the given alignment from
+ * the cache of the current locality.
+ */
+static struct be_alloc_chunk *
+be_alloc_cache_get(struct m0_be_allocator *a,
+		   struct m0_be_tx        *tx,
+		   m0_bcount_t             size,
+		   unsigned                shift,
+		   bool                    chunk_align)
+{
+	struct m0_be_alloc_cache       *cache;
+	struct m0_be_alloc_cache_class *cls;
+	struct be_alloc_chunk          *c = NULL;
+	m0_bcount_t                     size_max;
+	int                             i;
+
+	if (!be_alloc_cache_is_on(a) || size > M0_BE_ALLOC_CACHE_SIZE_MAX)
+		return NULL;
+
+	/* Do not waste more than a chunk header, see be_alloc_chunk_split(). */
+	size_max = m0_align(size, 1UL << M0_BE_ALLOC_SHIFT_MIN) + sizeof *c;
+	cache = be_alloc_cache_here(a);
+	m0_mutex_lock(&cache->bca_lock);
+	for (i = 0; i < ARRAY_SIZE(cache->bca_class); ++i) {
+		cls = &cache->bca_class[i];
+		if (cls->bcc_nr > 0 && cls->bcc_shift == shift &&
+		    cls->bcc_chunk_align == chunk_align &&
+		    cls->bcc_size >= size && cls->bcc_size <= size_max) {
+			c = cls->bcc_chunk[--cls->bcc_nr];
+			cache->bca_bytes -= cls->bcc_size;
+			++cache->bca_hit;
+			break;
+		}
+	}
+	m0_mutex_unlock(&cache->bca_lock);
+
+	if (c != NULL) {
+		M0_ASSERT(c->bac_magic0 == M0_BE_ALLOC_MAGIC0 &&
+			  c->bac_magic1 == M0_BE_ALLOC_MAGIC1);
+		M0_ASSERT(!c->bac_free && c->bac_size >= size);
+		be_alloc_chunk_cached_set(a, tx, c, false);
+	}
+	return c;
+}
+
+/**
+ * Puts a used chunk to the cache of the current locality. Returns false if the
+ * chunk can not be cached.
+ */
+static bool be_alloc_cache_put(struct m0_be_allocator *a,
+			       struct m0_be_tx        *tx,
+			       struct be_alloc_chunk  *c)
+{
+	struct m0_be_alloc_cache       *cache;
+	struct m0_be_alloc_cache_class *cls = NULL;
+	struct m0_be_alloc_cache_class *unused = NULL;
+	m0_bcount_t                     size = c->bac_size;
+	int                             i;
+
+	if (!be_alloc_cache_is_on(a) || c->bac_zone != M0_BAP_NORMAL ||
+	    size > M0_BE_ALLOC_CACHE_SIZE_MAX)
+		return false;
+
+	cache = be_alloc_cache_here(a);
+	m0_mutex_lock(&cache->bca_lock);
+	for (i = 0; i < ARRAY_SIZE(cache->bca_class) &&
+	     cache->bca_bytes + size <= M0_BE_ALLOC_CACHE_BYTES_MAX; ++i) {
+		if (cache->bca_class[i].bcc_nr == 0) {
+			unused = unused ?: &cache->bca_class[i];
+		} else if (cache->bca_class[i].bcc_size == size &&
+			   cache->bca_class[i].bcc_shift == c->bac_align_shift &&
+			   cache->bca_class[i].bcc_chunk_align ==
+			   c->bac_chunk_align) {
+			cls = &cache->bca_class[i];
+			break;
+		}
+	}
+	if (cls == NULL && unused != NULL) {
+		cls = unused;
+		cls->bcc_size        = size;
+		cls->bcc_shift       = c->bac_align_shift;
+		cls->bcc_chunk_align = c->bac_chunk_align;
+	}
+	if (cls != NULL && cls->bcc_nr < ARRAY_SIZE(cls->bcc_chunk)) {
+		be_alloc_chunk_cached_set(a, tx, c, true);
+		cls->bcc_chunk[cls->bcc_nr++] = c;
+		cache->bca_bytes += size;
+		++cache->bca_put;
+	} else
+		cls = NULL;
+	m0_mutex_unlock(&cache->bca_lock);
+	return cls != NULL;
+}
+
 M0_INTERNAL int m0_be_allocator_init(struct m0_be_allocator *a,
 				     struct m0_be_seg *seg)
 {
@@ -753,6 +940,12 @@ M0_INTERNAL int m0_be_allocator_init(struct m0_be_allocator *a,
 	/* See comment in m0_be_btree_init(). */
 	M0_SET0(&a->ba_lock);
 	m0_mutex_init(&a->ba_lock);
+	M0_SET_ARR0(a->ba_cache);
+	for (i = 0; i < ARRAY_SIZE(a->ba_cache); ++i)
+		m0_mutex_init(&a->ba_cache[i].bca_lock);
+	/* Odd, so that it never equals to a link pointer. */
+	a->ba_cache_gen   = m0_time_now() | 1;
+	a->ba_cache_force = M0_FI_ENABLED("cache_force");
 
 	a->ba_seg = seg;
 	seg_hdr = (struct m0_be_seg_hdr *)seg->bs_addr;
@@ -773,6 +966,12 @@ M0_INTERNAL void m0_be_allocator_fini(struct m0_be_allocator *a)
 
 	for (i = 0; i < M0_BAP_NR; ++i)
 		be_allocator_stats_print(&a->ba_h[i]->bah_stats);
+	for (i = 0; i < ARRAY_SIZE(a->ba_cache); ++i) {
+		M0_LOG(M0_DEBUG, "cache=%d hit=%"PRIu64" put=%"PRIu64" "
+		       "bytes=%"PRIu64, i, a->ba_cache[i].bca_hit,
+		       a->ba_cache[i].bca_put, a->ba_cache[i].bca_bytes);
+		m0_mutex_fini(&a->ba_cache[i].bca_lock);
+	}
 	m0_mutex_fini(&a->ba_lock);
 
 	M0_LEAVE();
@@ -907,6 +1106,85 @@ M0_INTERNAL int m0_be_allocator_create(struct m0_be_allocator *a,
 	return 0;
 }
 
+/**
+ * Frees a used chunk. Adjacent orphans are freed as well.
+ * Allocator lock should be held.
+ */
+static struct be_alloc_chunk *be_alloc_chunk_free(struct m0_be_allocator *a,
+						  struct m0_be_tx        *tx,
+						  struct be_alloc_chunk  *c)
+{
+	enum m0_be_alloc_zone_type     ztype = c->bac_zone;
+	struct m0_be_allocator_header *h = a->ba_h[ztype];
+	struct be_alloc_chunk         *prev;
+	struct be_alloc_chunk         *next;
+	bool                           chunks_were_merged;
+
+	be_alloc_chunk_mark_free(a, ztype, tx, c);
+	/* update stats before c->bac_size gets modified due to merge */
+	be_allocator_stats_update(&h->bah_stats, c->bac_size, false, false);
+	prev = be_alloc_chunk_prev(a, ztype, c);
+	next = be_alloc_chunk_next(a, ztype, c);
+	if (prev != NULL && be_alloc_chunk_is_orphan(a, prev)) {
+		be_allocator_stats_update(&h->bah_stats, prev->bac_size,
+					  false, false);
+		be_alloc_chunk_mark_free(a, ztype, tx, prev);
+	}
+	if (next != NULL && be_alloc_chunk_is_orphan(a, next)) {
+		be_allocator_stats_update(&h->bah_stats, next->bac_size,
+					  false, false);
+		be_alloc_chunk_mark_free(a, ztype, tx, next);
+	}
+	chunks_were_merged = be_alloc_chunk_trymerge(a, ztype, tx,
+			prev, c);
+	if (chunks_were_merged)
+		c = prev;
+	be_alloc_chunk_trymerge(a, ztype, tx, c, next);
+	return c;
+}
+
+/** Frees all the cached chunks and orphans. Allocator lock should be held. */
+static void be_alloc_cache_drain(struct m0_be_allocator *a,
+				 struct m0_be_tx        *tx)
+{
+	struct m0_be_alloc_cache       *cache;
+	struct m0_be_alloc_cache_class *cls;
+	struct be_alloc_chunk          *c;
+	int                             i;
+	int                             j;
+	int                             z;
+
+	for (i = 0; i < ARRAY_SIZE(a->ba_cache); ++i) {
+		cache = &a->ba_cache[i];
+		m0_mutex_lock(&cache->bca_lock);
+		for (j = 0; j < ARRAY_SIZE(cache->bca_class); ++j) {
+			cls = &cache->bca_class[j];
+			while (cls->bcc_nr > 0) {
+				c = cls->bcc_chunk[--cls->bcc_nr];
+				be_alloc_chunk_cached_set(a, tx, c, false);
+				be_alloc_chunk_free(a, tx, c);
+			}
+		}
+		cache->bca_bytes = 0;
+		m0_mutex_unlock(&cache->bca_lock);
+	}
+	for (z = 0; z < M0_BAP_NR; ++z) {
+		c = chunks_all_be_list_head(&a->ba_h[z]->bah_chunks);
+		while (c != NULL) {
+			if (be_alloc_chunk_is_orphan(a, c)) {
+				be_alloc_chunk_free(a, tx, c);
+				/* the list could have changed, start over */
+				c = chunks_all_be_list_head(
+					&a->ba_h[z]->bah_chunks);
+			} else {
+				c = chunks_all_be_list_next(
+					&a->ba_h[z]->bah_chunks, c);
+			}
+		}
+		be_allocator_stats_capture(a, z, tx);
+	}
+}
+
 M0_INTERNAL void m0_be_allocator_destroy(struct m0_be_allocator *a,
 					 struct m0_be_tx *tx)
 {
@@ -917,6 +1195,7 @@ M0_INTERNAL void m0_be_allocator_destroy(struct m0_be_allocator *a,
 	m0_mutex_lock(&a->ba_lock);
 	M0_PRE_EX(m0_be_allocator__invariant(a));
 
+	be_alloc_cache_drain(a, tx);
 	for (z = 0; z < M0_BAP_NR; ++z)
 		be_allocator_header_destroy(a, z, tx);
 
@@ -951,6 +1230,8 @@ M0_INTERNAL void m0_be_allocator_credit(struct m0_be_allocator *a,
 	struct m0_be_tx_credit         cred_free_flag;
 	struct m0_be_tx_credit         cred_chunk_size;
 	struct m0_be_tx_credit         stats_credit;
+	struct m0_be_tx_credit         cred_cached;
+	struct m0_be_tx_credit         cred_free = {};
 	struct m0_be_tx_credit         tmp;
 	struct be_alloc_chunk          chunk;
 
@@ -958,6 +1239,7 @@ M0_INTERNAL void m0_be_allocator_credit(struct m0_be_allocator *a,
 	cred_free_flag  = M0_BE_TX_CREDIT_PTR(&chunk.bac_free);
 	cred_chunk_size = M0_BE_TX_CREDIT_PTR(&chunk.bac_size);
 	stats_credit    = M0_BE_TX_CREDIT_PTR(&h->bah_stats);
+	cred_cached     = M0_BE_TX_CREDIT_PTR(&chunk.bac_linkage_free);
 
 	m0_be_tx_credit_add(&cred_allocator,
 			    &M0_BE_TX_CREDIT_PTR(&h->bah_size));
@@ -1001,6 +1283,11 @@ M0_INTERNAL void m0_be_allocator_credit(struct m0_be_allocator *a,
 	m0_be_tx_credit_add(&cred_mark_free, &cred_free_flag);
 	m0_be_fl_credit(&h->bah_fl, M0_BFL_ADD, &cred_mark_free);
 
+	/* be_alloc_chunk_free() of the chunk and of 2 orphans */
+	m0_be_tx_credit_mac(&cred_free, &cred_mark_free, 3);
+	m0_be_tx_credit_mac(&cred_free, &chunk_trymerge_credit, 2);
+	m0_be_tx_credit_add(&cred_free, &cred_cached);
+
 	switch (optype) {
 		case M0_BAO_CREATE:
 			tmp = M0_BE_TX_CREDIT(0, 0);
@@ -1016,20 +1303,26 @@ M0_INTERNAL void m0_be_allocator_credit(struct m0_be_allocator *a,
 			m0_be_fl_credit(&h->bah_fl, M0_BFL_DESTROY, &tmp);
 			m0_be_tx_credit_add(&tmp, &chunk_del_fini_credit);
 			m0_be_tx_credit_mac(&tmp, &cred_list_destroy, 2);
+			m0_be_tx_credit_add(&tmp, &stats_credit);
 			m0_be_tx_credit_mac(accum, &tmp, M0_BAP_NR);
+			/* be_alloc_cache_drain() */
+			m0_be_tx_credit_mac(accum, &cred_free,
+					    M0_BE_ALLOC_CACHE_NR *
+					    M0_BE_ALLOC_CACHE_CLASS_NR *
+					    M0_BE_ALLOC_CACHE_DEPTH);
 			break;
 		case M0_BAO_ALLOC_ALIGNED:
 			m0_be_tx_credit_add(accum, &cred_split);
 			m0_be_tx_credit_add(accum, &mem_zero_credit);
 			m0_be_tx_credit_add(accum, &stats_credit);
+			m0_be_tx_credit_add(accum, &cred_cached);
 			break;
 		case M0_BAO_ALLOC:
 			m0_be_allocator_credit(a, M0_BAO_ALLOC_ALIGNED, size,
 					       M0_BE_ALLOC_SHIFT_MIN, accum);
 			break;
 		case M0_BAO_FREE_ALIGNED:
-			m0_be_tx_credit_add(accum, &cred_mark_free);
-			m0_be_tx_credit_mac(accum, &chunk_trymerge_credit, 2);
+			m0_be_tx_credit_add(accum, &cred_free);
 			m0_be_tx_credit_add(accum, &stats_credit);
 			break;
 		case M0_BAO_FREE:
@@ -1065,6 +1358,21 @@ M0_INTERNAL void m0_be_alloc_aligned(struct m0_be_allocator *a,
 
 	m0_be_op_active(op);
 
+	if (zonemask == M0_BITS(M0_BAP_NORMAL)) {
+		c = be_alloc_cache_get(a, tx, size, shift, chunk_align);
+		if (c != NULL) {
+			memset(&c->bac_mem, 0, size);
+			m0_be_tx_capture(tx, &M0_BE_REG(a->ba_seg, size,
+							&c->bac_mem));
+			*ptr = &c->bac_mem;
+			M0_LOG(M0_DEBUG, "allocator=%p size=%"PRIu64" "
+			       "shift=%u c=%p ptr=%p cached", a, size, shift,
+			       c, *ptr);
+			m0_be_op_done(op);
+			return;
+		}
+	}
+
 	m0_mutex_lock(&a->ba_lock);
 	M0_PRE_EX(m0_be_allocator__invariant(a));
 
@@ -1142,9 +1450,6 @@ M0_INTERNAL void m0_be_free_aligned(struct m0_be_allocator *a,
 {
 	enum m0_be_alloc_zone_type  ztype;
 	struct be_alloc_chunk      *c;
-	struct be_alloc_chunk      *prev;
-	struct be_alloc_chunk      *next;
-	bool		            chunks_were_merged;
 
 	M0_PRE(ptr != NULL);
 	M0_PRE(m0_reduce(z, M0_BAP_NR, 0,
@@ -1152,27 +1457,24 @@ M0_INTERNAL void m0_be_free_aligned(struct m0_be_allocator *a,
 
 	m0_be_op_active(op);
 
+	c = be_alloc_chunk_addr(ptr);
+	M0_PRE(!c->bac_free);
+	if (be_alloc_cache_put(a, tx, c)) {
+		M0_LOG(M0_DEBUG, "allocator=%p c=%p c->bac_size=%"PRIu64" "
+		       "cached", a, c, c->bac_size);
+		m0_be_op_done(op);
+		return;
+	}
+
 	m0_mutex_lock(&a->ba_lock);
 	M0_PRE_EX(m0_be_allocator__invariant(a));
 
-	c = be_alloc_chunk_addr(ptr);
 	M0_PRE(be_alloc_chunk_invariant(a, c));
-	M0_PRE(!c->bac_free);
 	ztype = c->bac_zone;
 	M0_LOG(M0_DEBUG, "allocator=%p c=%p c->bac_size=%" PRIu64 " zone=%d "
 			"data=%p", a, c, c->bac_size, c->bac_zone, &c->bac_mem);
 	/* algorithm starts here */
-	be_alloc_chunk_mark_free(a, ztype, tx, c);
-	/* update stats before c->bac_size gets modified due to merge */
-	be_allocator_stats_update(&a->ba_h[ztype]->bah_stats,
-			c->bac_size, false, false);
-	prev = be_alloc_chunk_prev(a, ztype, c);
-	next = be_alloc_chunk_next(a, ztype, c);
-	chunks_were_merged = be_alloc_chunk_trymerge(a, ztype, tx,
-			prev, c);
-	if (chunks_were_merged)
-		c = prev;
-	be_alloc_chunk_trymerge(a, ztype, tx, c, next);
+	c = be_alloc_chunk_free(a, tx, c);
 	be_allocator_stats_capture(a, ztype, tx);
 	/* and ends here */
 	M0_POST(c->bac_free);
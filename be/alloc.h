@@ -31,6 +31,7 @@ struct m0_be_op;
 struct m0_be_seg;
 struct m0_be_tx;
 struct m0_be_tx_credit;
+struct be_alloc_chunk;
 
 /**
  * @defgroup be Meta-data back-end
@@ -128,6 +129,53 @@ struct m0_be_allocator_stats {
 
 struct m0_be_allocator_header;
 
+enum {
+	/** Number of per-locality chunk caches of an allocator. */
+	M0_BE_ALLOC_CACHE_NR         = 16,
+	/** Number of size and alignment classes in a cache. */
+	M0_BE_ALLOC_CACHE_CLASS_NR   = 8,
+	/** Maximum number of chunks of a class kept in a cache. */
+	M0_BE_ALLOC_CACHE_DEPTH      = 8,
+	/** Chunks larger than this are never cached. */
+	M0_BE_ALLOC_CACHE_SIZE_MAX   = 1 << 16,
+	/** Maximum number of bytes of the chunks kept in a cache. */
+	M0_BE_ALLOC_CACHE_BYTES_MAX  = 1 << 18,
+	/** Caches are used only if the normal zone is at least that large. */
+	M0_BE_ALLOC_CACHE_ZONE_MIN   = 1 << 30,
+};
+
+/** Free chunks of the same size and alignment, see m0_be_alloc_cache. */
+struct m0_be_alloc_cache_class {
+	/** be_alloc_chunk::bac_size of the chunks of the class. */
+	m0_bcount_t            bcc_size;
+	/** be_alloc_chunk::bac_align_shift of the chunks of the class. */
+	unsigned               bcc_shift;
+	/** be_alloc_chunk::bac_chunk_align of the chunks of the class. */
+	bool                   bcc_chunk_align;
+	/** Number of chunks in bcc_chunk[], the class is unused if 0. */
+	uint32_t               bcc_nr;
+	struct be_alloc_chunk *bcc_chunk[M0_BE_ALLOC_CACHE_DEPTH];
+};
+
+/**
+ * @brief Per-locality cache of free chunks.
+ *
+ * m0_be_free() of a small chunk puts it to the cache of the current locality
+ * and m0_be_alloc() of the same size and alignment takes it back, both without
+ * taking m0_be_allocator::ba_lock. See "Chunk caches" in be/alloc.c.
+ */
+struct m0_be_alloc_cache {
+	/** Protects the cache. */
+	struct m0_mutex                bca_lock;
+	struct m0_be_alloc_cache_class bca_class[M0_BE_ALLOC_CACHE_CLASS_NR];
+	/** Total size of the cached chunks. */
+	m0_bcount_t                    bca_bytes;
+	/** Number of allocations served by the cache. */
+	uint64_t                       bca_hit;
+	/** Number of frees which put the chunk to the cache. */
+	uint64_t                       bca_put;
+};
+
 /** @brief Allocator */
 struct m0_be_allocator {
 	/**
@@ -143,6 +191,15 @@ struct m0_be_allocator {
 	struct m0_mutex                ba_lock;
 	/** Internal allocator data. It is stored inside the segment. */
 	struct m0_be_allocator_header *ba_h[M0_BAP_NR];
+	/** Chunk caches, indexed by locality. */
+	struct m0_be_alloc_cache       ba_cache[M0_BE_ALLOC_CACHE_NR];
+	/**
+	 * Identifies the chunks cached since m0_be_allocator_init(). Chunks
+	 * cached before it are reclaimed, see be_alloc_chunk_is_orphan().
+	 */
+	uint64_t                       ba_cache_gen;
+	/** Use the caches regardless of M0_BE_ALLOC_CACHE_ZONE_MIN. */
+	bool                           ba_cache_force;
 };
 
 /**
@@ -237,6 +237,7 @@ static int be_domain_seg_open(struct m0_be_domain *dom,
 	if (rc == 0) {
 		m0_be_seg_init(seg, stob, dom, M0_BE_SEG_FAKE_ID);
 		m0_stob_put(stob);
+		seg->bs_map_cfg = dom->bd_cfg.bc_seg_map_cfg;
 		rc = m0_be_seg_open(seg);
 		if (rc == 0) {
 			(void)m0_be_allocator_init(m0_be_seg_allocator(seg),
@@ -381,7 +382,10 @@ be_domain_log_cleanup(const char *stob_domain_location,
 			0, log_cfg->lc_store_cfg.lsc_stob_domain_key);
 	}
 	log_cfg->lc_store_cfg.lsc_stob_domain_location = location;
-	log_cfg->lc_store_cfg.lsc_stob_domain_init_cfg = "directio=true";
+	/* The log uses direct I/O unless configured otherwise. */
+	if (log_cfg->lc_store_cfg.lsc_stob_domain_init_cfg == NULL)
+		log_cfg->lc_store_cfg.lsc_stob_domain_init_cfg =
+			"directio=true";
 	if (create) {
 		rc = m0_stob_domain_destroy_location(
 			log_cfg->lc_store_cfg.lsc_stob_domain_location);
@@ -644,6 +648,11 @@ M0_INTERNAL bool m0_be_domain_is_locked(const struct m0_be_domain *dom)
 	return true;
 }
 
+M0_INTERNAL bool m0_be_domain_is_ready(const struct m0_be_domain *dom)
+{
+	return dom->bd_module.m_cur == M0_BE_DOMAIN_LEVEL_READY;
+}
+
 M0_INTERNAL void m0_be_domain__0type_register(struct m0_be_domain *dom,
 					      struct m0_be_0type  *type)
 {
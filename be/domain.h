@@ -101,6 +101,8 @@ struct m0_be_domain_cfg {
 	 * The sum of all array elements should be 100.
 	 */
 	uint32_t                     bc_zone_pcnt[M0_BAP_NR];
+	/** Memory mapping configuration for all segments of the domain. */
+	struct m0_be_seg_map_cfg     bc_seg_map_cfg;
 
 	/*
 	 * Next fields are for mkfs mode only.
@@ -204,6 +206,11 @@ struct m0_be_seg *m0_be_domain_seg0_get(struct m0_be_domain *dom);
 /* TODO remove the function after BE log becomes a part of BE domain */
 M0_INTERNAL struct m0_be_log *m0_be_domain_log(struct m0_be_domain *dom);
 M0_INTERNAL bool m0_be_domain_is_locked(const struct m0_be_domain *dom);
+/**
+ * Returns true iff the domain is fully started and hasn't begun finalisation,
+ * i.e. transactions can still be opened in it.
+ */
+M0_INTERNAL bool m0_be_domain_is_ready(const struct m0_be_domain *dom);
 
 /**
  * Returns existing BE segment if @addr is inside it. Returns NULL otherwise.
@@ -43,6 +43,31 @@ M0_TL_DESCR_DEFINE(lrec, "DTM0 Log", static, struct m0_dtm0_log_rec,
 M0_TL_DEFINE(lrec, static, struct m0_dtm0_log_rec);
 
 
+enum {
+	/** Number of buckets in the hash index of a volatile log. */
+	DTM0_VLOG_HT_BUCKET_NR = 1024,
+};
+
+static uint64_t lrec_hash(const struct m0_htable   *ht,
+			  const struct m0_dtm0_tid *id)
+{
+	return m0_hash(id->dti_ts.dts_phys ^ m0_fid_hash(&id->dti_fid)) %
+		ht->h_bucket_nr;
+}
+
+static bool lrec_key_eq(const struct m0_dtm0_tid *left,
+			const struct m0_dtm0_tid *right)
+{
+	return left->dti_ts.dts_phys == right->dti_ts.dts_phys &&
+		m0_fid_eq(&left->dti_fid, &right->dti_fid);
+}
+
+M0_HT_DESCR_DEFINE(lrec_ht, "DTM0 Log hash", static, struct m0_dtm0_log_rec,
+		   dlr_hlink, dlr_hmagic, M0_BE_DTM0_LOG_HREC_MAGIX,
+		   M0_BE_DTM0_LOG_HT_MAGIX, dlr_txd.dtd_id, lrec_hash,
+		   lrec_key_eq);
+M0_HT_DEFINE(lrec_ht, static, struct m0_dtm0_log_rec, struct m0_dtm0_tid);
+
 M0_BE_LIST_DESCR_DEFINE(lrec, "DTM0 PLog", static, struct m0_dtm0_log_rec,
 			u.dlr_link, dlr_magic, M0_BE_DTM0_LOG_REC_MAGIX,
 			M0_BE_DTM0_LOG_MAGIX);
@@ -78,7 +103,12 @@ M0_INTERNAL int m0_be_dtm0_log_alloc(struct m0_be_dtm0_log **out)
 		return M0_ERR(-ENOMEM);
 
 	M0_ALLOC_PTR(log->u.dl_inmem);
-	if (log->u.dl_inmem == NULL) {
+	M0_ALLOC_PTR(log->dl_inmem_ht);
+	if (log->u.dl_inmem == NULL || log->dl_inmem_ht == NULL ||
+	    lrec_ht_htable_init(log->dl_inmem_ht,
+				DTM0_VLOG_HT_BUCKET_NR) != 0) {
+		m0_free(log->dl_inmem_ht);
+		m0_free(log->u.dl_inmem);
 		m0_free(log);
 		return M0_ERR(-ENOMEM);
 	}
@@ -120,6 +150,8 @@ M0_INTERNAL void m0_be_dtm0_log_free(struct m0_be_dtm0_log *log)
 {
 	M0_PRE(!log->dl_is_persistent);
 
+	lrec_ht_htable_fini(log->dl_inmem_ht);
+	m0_free(log->dl_inmem_ht);
 	m0_free(log->u.dl_inmem);
 	m0_free(log);
 }
@@ -281,13 +313,26 @@ struct m0_dtm0_log_rec *m0_be_dtm0_log_find(struct m0_be_dtm0_log    *log,
 		} m0_be_list_endfor;
 		return lrec;
 	} else {
-		return m0_tl_find(lrec, rec, log->u.dl_inmem,
-				  m0_dtm0_tid_cmp(log->dl_cs,
-						  &rec->dlr_txd.dtd_id,
-						  id) == M0_DTS_EQ);
+		return lrec_ht_htable_lookup(log->dl_inmem_ht, id);
 	}
 }
 
+static void vlog_rec_add(struct m0_be_dtm0_log  *log,
+			 struct m0_dtm0_log_rec *rec)
+{
+	lrec_tlink_init_at_tail(rec, log->u.dl_inmem);
+	lrec_ht_tlink_init(rec);
+	lrec_ht_htable_add(log->dl_inmem_ht, rec);
+}
+
+static void vlog_rec_del(struct m0_be_dtm0_log  *log,
+			 struct m0_dtm0_log_rec *rec)
+{
+	lrec_ht_htable_del(log->dl_inmem_ht, rec);
+	lrec_ht_tlink_fini(rec);
+	lrec_tlist_del(rec);
+}
+
 static int log_rec_init(struct m0_dtm0_log_rec **rec,
 			struct m0_be_tx         *tx,
 			struct m0_dtm0_tx_desc  *txd,
@@ -406,7 +451,7 @@ static int dtm0_log__insert(struct m0_be_dtm0_log  *log,
 		rc = log_rec_init(&rec, tx, txd, payload);
 		if (rc != 0)
 			return rc;
-		lrec_tlink_init_at_tail(rec, log->u.dl_inmem);
+		vlog_rec_add(log, rec);
 	}
 
 	return rc;
@@ -499,12 +544,12 @@ M0_INTERNAL int m0_be_dtm0_log_prune(struct m0_be_dtm0_log    *log,
 
 	/* rec is a pointer to the record matching the input id. Delete all the
 	 * previous records and then this record. */
-	while ((currec = lrec_tlist_pop(log->u.dl_inmem)) != rec) {
+	do {
+		currec = lrec_tlist_head(log->u.dl_inmem);
 		M0_ASSERT(m0_dtm0_log_rec__invariant(currec));
+		vlog_rec_del(log, currec);
 		log_rec_fini(currec, tx);
-	}
-
-	log_rec_fini(rec, tx);
+	} while (currec != rec);
 	return rc;
 }
 
@@ -521,12 +566,14 @@ M0_INTERNAL void m0_be_dtm0_log_clear(struct m0_be_dtm0_log *log)
 
 	m0_mutex_lock(&log->dl_lock);
 
-	m0_tl_teardown(lrec, log->u.dl_inmem, rec) {
+	m0_tl_for (lrec, log->u.dl_inmem, rec) {
 		M0_ASSERT(m0_dtm0_log_rec__invariant(rec));
 		M0_ASSERT(m0_dtm0_tx_desc_state_eq(&rec->dlr_dtx.dd_txd,
 						   M0_DTPS_PERSISTENT));
+		vlog_rec_del(log, rec);
 		log_rec_fini(rec, NULL);
-	}
+	} m0_tl_endfor;
+	M0_POST(lrec_ht_htable_is_empty(log->dl_inmem_ht));
 	M0_POST(lrec_tlist_is_empty(log->u.dl_inmem));
 
 	m0_mutex_unlock(&log->dl_lock);
@@ -543,7 +590,7 @@ M0_INTERNAL int m0_be_dtm0_volatile_log_insert(struct m0_be_dtm0_log  *log,
 	if (rc != 0)
 		return M0_ERR(rc);
 
-	lrec_tlink_init_at_tail(rec, log->u.dl_inmem);
+	vlog_rec_add(log, rec);
 	return M0_RC(rc);
 }
 
@@ -560,7 +607,7 @@ M0_INTERNAL void m0_be_dtm0_volatile_log_del(struct m0_be_dtm0_log  *log,
 {
 	M0_PRE(m0_mutex_is_locked(&log->dl_lock));
 
-	lrec_tlist_del(rec);
+	vlog_rec_del(log, rec);
 	if (fini)
 		log_rec_fini(rec, NULL);
 }
@@ -640,6 +687,87 @@ M0_INTERNAL int m0_be_dtm0_plog_prune(struct m0_be_dtm0_log    *log,
 	return 0;
 }
 
+/**
+ * A record can be pruned in bulk when it is persistent on all participants and
+ * older than the horizon. Only the head of the list is pruned, so that the
+ * order of the remaining records is not disturbed.
+ */
+static bool plog_rec_is_prunable(struct m0_be_dtm0_log   *log,
+				 struct m0_dtm0_log_rec  *rec,
+				 const struct m0_dtm0_ts *horizon)
+{
+	return m0_dtm0_tx_desc_state_eq(&rec->dlr_txd, M0_DTPS_PERSISTENT) &&
+		m0_dtm0_ts_cmp(log->dl_cs, &rec->dlr_txd.dtd_id.dti_ts,
+			       horizon) == M0_DTS_LT;
+}
+
+M0_INTERNAL uint32_t m0_be_dtm0_plog_prune_bulk_credit(
+					struct m0_be_dtm0_log   *log,
+					const struct m0_dtm0_ts *horizon,
+					uint32_t                 max,
+					struct m0_be_tx_credit  *accum)
+{
+	struct m0_dtm0_log_rec *rec;
+	uint32_t                nr = 0;
+
+	M0_PRE(m0_be_dtm0_log__invariant(log));
+	M0_PRE(log->dl_is_persistent);
+	M0_PRE(m0_mutex_is_locked(&log->dl_lock));
+
+	m0_be_list_for(lrec, log->u.dl_persist, rec) {
+		if (nr == max || !plog_rec_is_prunable(log, rec, horizon))
+			break;
+		m0_be_dtm0_log_credit(M0_DTML_PRUNE, NULL, NULL,
+				      log->dl_seg, rec, accum);
+		++nr;
+	} m0_be_list_endfor;
+
+	return nr;
+}
+
+M0_INTERNAL uint32_t m0_be_dtm0_plog_prune_bulk(struct m0_be_dtm0_log   *log,
+						struct m0_be_tx         *tx,
+						const struct m0_dtm0_ts *horizon,
+						uint32_t                 max)
+{
+	struct m0_dtm0_log_rec *rec;
+	uint32_t                nr = 0;
+
+	M0_PRE(m0_be_dtm0_log__invariant(log));
+	M0_PRE(log->dl_is_persistent);
+	M0_PRE(m0_mutex_is_locked(&log->dl_lock));
+
+	m0_be_list_for(lrec, log->u.dl_persist, rec) {
+		if (nr == max || !plog_rec_is_prunable(log, rec, horizon))
+			break;
+		lrec_be_list_del(log->u.dl_persist, tx, rec);
+		lrec_be_tlink_destroy(rec, tx);
+		plog_rec_fini(&rec, log, tx);
+		++nr;
+	} m0_be_list_endfor;
+
+	return nr;
+}
+
+M0_INTERNAL void m0_be_dtm0_plog_horizon(struct m0_be_dtm0_log *log,
+					 struct m0_dtm0_ts     *horizon)
+{
+	struct m0_dtm0_log_rec *rec;
+
+	M0_PRE(m0_be_dtm0_log__invariant(log));
+	M0_PRE(log->dl_is_persistent);
+	M0_PRE(m0_mutex_is_locked(&log->dl_lock));
+
+	m0_dtm0_clk_src_now(log->dl_cs, horizon);
+	m0_be_list_for(lrec, log->u.dl_persist, rec) {
+		if (!m0_dtm0_tx_desc_state_eq(&rec->dlr_txd,
+					      M0_DTPS_PERSISTENT) &&
+		    m0_dtm0_ts_cmp(log->dl_cs, &rec->dlr_txd.dtd_id.dti_ts,
+				   horizon) == M0_DTS_LT)
+			*horizon = rec->dlr_txd.dtd_id.dti_ts;
+	} m0_be_list_endfor;
+}
+
 static const struct m0_dtm0_tid dtm0_log_iter_tid0 =
 		(struct m0_dtm0_tid) { .dti_ts = { .dts_phys = ~0 } };
 
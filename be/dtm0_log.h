@@ -27,6 +27,7 @@
 #include "dtm0/tx_desc.h"       /* m0_dtm0_tx_desc */
 #include "fid/fid.h"            /* m0_fid */
 #include "lib/buf.h"            /* m0_buf */
+#include "lib/hash.h"           /* m0_hlink */
 #include "dtm0/dtx.h"           /* struct m0_dtm0_dtx */
 
 struct m0_be_tx;
@@ -176,6 +177,13 @@ struct m0_dtm0_log_rec {
 						   */
 	} u;
 	struct m0_buf          dlr_payload;
+	/*
+	 * Volatile log only: linkage into the hash index of the log. These
+	 * fields are kept at the end, so that the layout of the part stored
+	 * within a persistent log does not change.
+	 */
+	struct m0_hlink        dlr_hlink;
+	uint64_t               dlr_hmagic;
 };
 
 /**
@@ -207,6 +215,11 @@ struct m0_be_dtm0_log {
 		/** Volatile list, used if !dl_is_persistent */
 		struct m0_tl      *dl_inmem;
 	} u;
+	/**
+	 * Hash index over dl_inmem records by tx id (volatile log only),
+	 * keeps lookups under dl_lock O(1).
+	 */
+	struct m0_htable          *dl_inmem_ht;
 };
 
 /**
@@ -467,6 +480,58 @@ M0_INTERNAL int m0_be_dtm0_plog_prune(struct m0_be_dtm0_log    *log,
 				      struct m0_be_tx          *tx,
 				      const struct m0_dtm0_tid *id);
 
+/**
+ * Bulk pruning of the persistent log.
+ *
+ * Counts the records at the head of the persistent log that are persistent on
+ * all participants and older than the horizon, stopping at the first record
+ * that is not, or after "max" records. Credits for deletion of the counted
+ * records are added to "accum". The returned count is meant to be passed as
+ * "max" to m0_be_dtm0_plog_prune_bulk() in a transaction prepared with these
+ * credits; the log lock may be released in between, since records are only
+ * appended at the tail and the prunable prefix can only grow.
+ *
+ * @pre log->dl_is_persistent
+ * @pre m0_be_dtm0_log__invariant(log)
+ * @pre m0_mutex_is_locked(&log->dl_lock)
+ *
+ * @return the number of records that can be pruned.
+ */
+M0_INTERNAL uint32_t m0_be_dtm0_plog_prune_bulk_credit(
+					struct m0_be_dtm0_log   *log,
+					const struct m0_dtm0_ts *horizon,
+					uint32_t                 max,
+					struct m0_be_tx_credit  *accum);
+
+/**
+ * Removes up to "max" records from the head of the persistent log that are
+ * persistent on all participants and older than the horizon, in the
+ * transaction "tx".
+ *
+ * @pre log->dl_is_persistent
+ * @pre m0_be_dtm0_log__invariant(log)
+ * @pre m0_mutex_is_locked(&log->dl_lock)
+ *
+ * @return the number of records removed.
+ */
+M0_INTERNAL uint32_t m0_be_dtm0_plog_prune_bulk(struct m0_be_dtm0_log   *log,
+						struct m0_be_tx         *tx,
+						const struct m0_dtm0_ts *horizon,
+						uint32_t                 max);
+
+/**
+ * Returns the oldest timestamp of the persistent log records that are not yet
+ * persistent on all participants, or the current time of the log clock if
+ * there are no such records. Every operation older than the returned value
+ * that has a record in the log is persistent everywhere.
+ *
+ * @pre log->dl_is_persistent
+ * @pre m0_be_dtm0_log__invariant(log)
+ * @pre m0_mutex_is_locked(&log->dl_lock)
+ */
+M0_INTERNAL void m0_be_dtm0_plog_horizon(struct m0_be_dtm0_log *log,
+					 struct m0_dtm0_ts     *horizon);
+
 /**
  * Given a pointer to a dtm0 volatile log clear the log and finalize it.
  *
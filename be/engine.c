@@ -29,6 +29,9 @@
 #include "lib/errno.h"          /* ENOMEM */
 #include "lib/misc.h"           /* m0_forall */
 #include "lib/time.h"           /* m0_time_now */
+#include "lib/arith.h"          /* min_check */
+#include "addb2/addb2.h"        /* M0_ADDB2_ADD */
+#include "be/addb2.h"           /* M0_AVI_BE_GROUP_ATTR_FREEZE_TIMEOUT */
 
 #include "be/tx_service.h"      /* m0_be_tx_service_init */
 #include "be/tx_group.h"        /* m0_be_tx_group */
@@ -157,6 +160,12 @@ M0_INTERNAL int m0_be_engine_init(struct m0_be_engine     *en,
 
 	m0_semaphore_init(&en->eng_recovery_wait_sem, 0);
 	en->eng_recovery_finished = false;
+	en->eng_recovery_seq      = 0;
+	en->eng_adaptive = (struct m0_be_engine_adaptive) {
+		.ea_tx_target = en_cfg->bec_group_cfg.tgc_tx_nr_max,
+		.ea_timeout   = en_cfg->bec_group_freeze_timeout_max,
+	};
+	M0_SET0(&en->eng_stats);
 
 	M0_POST(m0_be_engine__invariant(en));
 	return M0_RC(0);
@@ -380,6 +389,33 @@ static void be_engine_group_timer_disarm(struct m0_sm_group *sm_grp,
 	M0_LEAVE();
 }
 
+static void be_engine_group_timer_force(struct m0_sm_group *sm_grp,
+                                        struct m0_sm_ast   *ast)
+{
+	struct m0_be_tx_group *gr    = M0_AMB(gr, ast, tg_close_timer_force);
+	struct m0_be_engine   *en    = gr->tg_engine;
+	struct m0_sm_timer    *timer = &gr->tg_close_timer;
+	int                    rc;
+
+	M0_ENTRY("en=%p gr=%p sm_grp=%p", en, gr, sm_grp);
+	be_engine_lock(en);
+	gr->tg_close_forced = false;
+	/*
+	 * If the timer isn't armed yet, be_engine_group_timer_arm() picks the
+	 * new deadline up. If it's disarmed, the group is already closed.
+	 */
+	if (gr->tg_state == M0_BGS_OPEN && m0_sm_timer_is_armed(timer)) {
+		m0_sm_timer_cancel(timer);
+		m0_sm_timer_fini(timer);
+		m0_sm_timer_init(timer);
+		rc = m0_sm_timer_start(timer, sm_grp, &be_engine_group_timer_cb,
+				       gr->tg_close_deadline);
+		M0_ASSERT_INFO(rc == 0, "rc = %d", rc);
+	}
+	be_engine_unlock(en);
+	M0_LEAVE();
+}
+
 static void be_engine_group_freeze(struct m0_be_engine   *en,
                                    struct m0_be_tx_group *gr)
 {
@@ -417,6 +453,101 @@ static void be_engine_group_tryclose(struct m0_be_engine   *en,
 	}
 }
 
+enum {
+	/** Weight of a new sample in the moving averages is 1/2^shift. */
+	BE_ENGINE_ADAPTIVE_SHIFT = 3,
+};
+
+static m0_time_t be_engine_adaptive_avg(m0_time_t avg, m0_time_t sample)
+{
+	return avg == 0 ? sample :
+	       avg - (avg >> BE_ENGINE_ADAPTIVE_SHIFT) +
+	       (sample >> BE_ENGINE_ADAPTIVE_SHIFT);
+}
+
+static void be_engine_adaptive_update(struct m0_be_engine *en)
+{
+	struct m0_be_engine_adaptive *ea    = &en->eng_adaptive;
+	struct m0_be_engine_cfg      *cfg   = en->eng_cfg;
+	m0_time_t                     t_min = cfg->bec_group_freeze_timeout_min;
+	m0_time_t                     t_max = cfg->bec_group_freeze_timeout_max;
+	m0_time_t                     interval;
+	uint64_t                      target;
+
+	M0_PRE(be_engine_is_locked(en));
+
+	target = cfg->bec_group_cfg.tgc_tx_nr_max;
+	if (ea->ea_tx_interval == 0) {
+		ea->ea_tx_target = target;
+		ea->ea_timeout   = t_max;
+		return;
+	}
+	/* Interval is limited so the multiplication below doesn't overflow. */
+	interval = min_check(ea->ea_tx_interval, t_max);
+	if (ea->ea_log_latency != 0) {
+		target = min_check(ea->ea_log_latency / ea->ea_tx_interval,
+				   target);
+		target = max_check(target, (uint64_t)1);
+	}
+	ea->ea_tx_target = target;
+	ea->ea_timeout   = min_check(max_check(target * interval, t_min),
+				     t_max);
+}
+
+static void be_engine_adaptive_tx_arrived(struct m0_be_engine *en)
+{
+	struct m0_be_engine_adaptive *ea  = &en->eng_adaptive;
+	m0_time_t                     now = m0_time_now();
+
+	M0_PRE(be_engine_is_locked(en));
+
+	if (ea->ea_tx_last != 0 && now > ea->ea_tx_last) {
+		ea->ea_tx_interval =
+			be_engine_adaptive_avg(ea->ea_tx_interval,
+					       now - ea->ea_tx_last);
+		be_engine_adaptive_update(en);
+	}
+	ea->ea_tx_last = now;
+}
+
+/** The group has enough transactions to be frozen by the adaptive sizing. */
+static bool be_engine_adaptive_is_full(struct m0_be_engine   *en,
+				       struct m0_be_tx_group *gr)
+{
+	return en->eng_cfg->bec_group_adaptive &&
+	       m0_be_tx_group_tx_nr(gr) >= en->eng_adaptive.ea_tx_target;
+}
+
+M0_INTERNAL void m0_be_engine__tx_group_logged(struct m0_be_engine   *en,
+					       struct m0_be_tx_group *gr,
+					       m0_time_t              latency)
+{
+	struct m0_be_engine_adaptive *ea = &en->eng_adaptive;
+	struct m0_be_engine_stats    *es = &en->eng_stats;
+
+	M0_ENTRY("en=%p gr=%p latency=%"PRIu64, en, gr, latency);
+	be_engine_lock(en);
+	es->es_groups++;
+	es->es_tx           += m0_be_tx_group_tx_nr(gr);
+	es->es_tx_max       += gr->tg_cfg.tgc_tx_nr_max;
+	es->es_reg_size     += gr->tg_used.tc_reg_size;
+	es->es_reg_size_max += gr->tg_size.tc_reg_size;
+	es->es_log_size     += m0_be_group_format_log_size(&gr->tg_od);
+	es->es_log_time     += latency;
+	if (en->eng_cfg->bec_group_adaptive) {
+		ea->ea_log_latency =
+			be_engine_adaptive_avg(ea->ea_log_latency,
+					       max_check(latency,
+							 (m0_time_t)1));
+		be_engine_adaptive_update(en);
+		M0_LOG(M0_DEBUG, "log_latency=%"PRIu64" tx_target=%"PRIu32
+		       " timeout=%"PRIu64,
+		       ea->ea_log_latency, ea->ea_tx_target, ea->ea_timeout);
+	}
+	be_engine_unlock(en);
+	M0_LEAVE();
+}
+
 static void be_engine_group_timeout_arm(struct m0_be_engine   *en,
                                         struct m0_be_tx_group *gr)
 {
@@ -426,16 +557,29 @@ static void be_engine_group_timeout_arm(struct m0_be_engine   *en,
 	m0_time_t           delay;
 	uint64_t            grouping_q_length;
 	uint64_t            tx_per_group_max;
+	uint64_t            gid;
 
 	M0_ENTRY("en=%p gr=%p sm_grp=%p", en, gr, sm_grp);
 	M0_PRE(be_engine_is_locked(en));
 
 	grouping_q_length = etx_tlist_length(&en->eng_txs[M0_BTS_GROUPING]);
 	M0_ASSERT(grouping_q_length > 0);
-	tx_per_group_max = en->eng_cfg->bec_group_cfg.tgc_tx_nr_max;
-	grouping_q_length = min_check(grouping_q_length, tx_per_group_max);
-	delay = t_min + (t_max - t_min) * grouping_q_length / tx_per_group_max;
+	if (en->eng_cfg->bec_group_adaptive) {
+		tx_per_group_max = en->eng_adaptive.ea_tx_target;
+		delay = en->eng_adaptive.ea_timeout;
+	} else {
+		tx_per_group_max = en->eng_cfg->bec_group_cfg.tgc_tx_nr_max;
+		grouping_q_length = min_check(grouping_q_length,
+					      tx_per_group_max);
+		delay = t_min + (t_max - t_min) * grouping_q_length /
+			tx_per_group_max;
+	}
 	delay = min_check(delay, en->eng_cfg->bec_group_freeze_timeout_limit);
+	gid = m0_sm_id_get(&gr->tg_fom.tgf_gen.fo_sm_phase);
+	M0_ADDB2_ADD(M0_AVI_ATTR, gid, M0_AVI_BE_GROUP_ATTR_FREEZE_TIMEOUT,
+		     delay);
+	M0_ADDB2_ADD(M0_AVI_ATTR, gid, M0_AVI_BE_GROUP_ATTR_TX_TARGET,
+		     tx_per_group_max);
 	gr->tg_close_deadline = m0_time_now() + delay;
 	gr->tg_close_timer_arm.sa_cb = &be_engine_group_timer_arm;
 	m0_sm_ast_post(sm_grp, &gr->tg_close_timer_arm);
@@ -477,9 +621,12 @@ static int be_engine_tx_trygroup(struct m0_be_engine *en,
 			if (rc == 0)
 				m0_be_tx__group_assign(tx, gr);
 		}
+		if (rc == 0 && en->eng_cfg->bec_group_adaptive)
+			be_engine_adaptive_tx_arrived(en);
 		if (rc == -EXFULL ||
 		    m0_be_tx__is_fast(tx) ||
-		    m0_be_tx__is_exclusive(tx)) {
+		    m0_be_tx__is_exclusive(tx) ||
+		    (rc == 0 && be_engine_adaptive_is_full(en, gr))) {
 			be_engine_group_freeze(en, gr);
 		} else if (rc == 0 && m0_be_tx_group_tx_nr(gr) == 1) {
 			be_engine_group_timeout_arm(en, gr);
@@ -526,6 +673,10 @@ static void be_engine_try_recovery(struct m0_be_engine *en)
 		if (gr == NULL)
 			break;
 		m0_be_tx_group_recovery_prepare(gr, &en->eng_log);
+		gr->tg_recovery_seq       = ++en->eng_recovery_seq;
+		gr->tg_recovery_decoded   = false;
+		gr->tg_recovery_reapplied = false;
+		gr->tg_recovery_waiting   = false;
 		be_engine_group_freeze(en, gr);
 		be_engine_group_tryclose(en, gr);
 		group_recovery_started = true;
@@ -538,6 +689,79 @@ static void be_engine_try_recovery(struct m0_be_engine *en)
 		 !!group_recovery_started, !!en->eng_recovery_finished);
 }
 
+/*
+ * Log records may be replayed by several groups at once, see
+ * m0_be_engine_cfg::bec_recovery_group_nr. Log reads, decoding and
+ * reconstruction of transactions are independent. Placing is ordered by the
+ * log position in the m0_be_pd I/O scheduler. So only m0_be_tx_group_reapply()
+ * of the groups with overlapping regions has to be done in the log order.
+ */
+static bool be_engine_recovery_group_blocks(struct m0_be_tx_group *prev,
+					    struct m0_be_tx_group *gr)
+{
+	return prev->tg_recovery_seq != 0 &&
+	       prev->tg_recovery_seq < gr->tg_recovery_seq &&
+	       !prev->tg_recovery_reapplied &&
+	       (!prev->tg_recovery_decoded ||
+		m0_be_reg_area_are_overlapping(&prev->tg_reg_area,
+					       &gr->tg_reg_area));
+}
+
+static void be_engine_recovery_reapply_wakeup(struct m0_be_engine *en)
+{
+	struct m0_be_tx_group *gr;
+	size_t                 i;
+
+	M0_PRE(be_engine_is_locked(en));
+
+	for (i = 0; i < en->eng_group_nr; ++i) {
+		gr = &en->eng_group[i];
+		if (gr->tg_recovery_waiting) {
+			gr->tg_recovery_waiting = false;
+			m0_be_tx_group_reapply_wakeup(gr);
+		}
+	}
+}
+
+M0_INTERNAL void
+m0_be_engine__recovery_group_decoded(struct m0_be_engine   *en,
+				     struct m0_be_tx_group *gr)
+{
+	be_engine_lock(en);
+	gr->tg_recovery_decoded = true;
+	be_engine_recovery_reapply_wakeup(en);
+	be_engine_unlock(en);
+}
+
+M0_INTERNAL void
+m0_be_engine__recovery_group_reapplied(struct m0_be_engine   *en,
+				       struct m0_be_tx_group *gr)
+{
+	be_engine_lock(en);
+	M0_PRE(gr->tg_recovery_decoded);
+	gr->tg_recovery_reapplied = true;
+	be_engine_recovery_reapply_wakeup(en);
+	be_engine_unlock(en);
+}
+
+M0_INTERNAL bool
+m0_be_engine__recovery_reapply_may_start(struct m0_be_engine   *en,
+					 struct m0_be_tx_group *gr)
+{
+	bool may_start;
+
+	be_engine_lock(en);
+	M0_PRE(gr->tg_recovery_decoded && !gr->tg_recovery_reapplied);
+	may_start = !m0_exists(i, en->eng_group_nr,
+			       be_engine_recovery_group_blocks(
+					&en->eng_group[i], gr));
+	gr->tg_recovery_waiting = !may_start;
+	be_engine_unlock(en);
+	M0_LOG(M0_DEBUG, "gr=%p seq=%"PRIu64" may_start=%d",
+	       gr, gr->tg_recovery_seq, !!may_start);
+	return may_start;
+}
+
 static struct m0_be_tx *be_engine_recovery_tx_find(struct m0_be_engine *en,
 						   enum m0_be_tx_state  state)
 {
@@ -685,6 +909,7 @@ M0_INTERNAL void m0_be_engine__tx_force(struct m0_be_engine *en,
 					struct m0_be_tx     *tx)
 {
 	struct m0_be_tx_group *grp;
+	m0_time_t              deadline;
 
 
 	M0_ENTRY("en=%p tx=%p", en, tx);
@@ -710,6 +935,22 @@ M0_INTERNAL void m0_be_engine__tx_force(struct m0_be_engine *en,
 	// if (m0_be_tx_state(tx) < M0_BTS_LOGGED)
 	// 	be_engine_group_close(en, grp, true);
 
+	/*
+	 * Instead of closing the group right away, bring its close deadline
+	 * closer, so that concurrent forces (e.g. fsync requests of different
+	 * clients) share one group close.
+	 */
+	deadline = m0_time_now() + en->eng_cfg->bec_group_freeze_timeout_min;
+	if (grp->tg_state == M0_BGS_OPEN && deadline < grp->tg_close_deadline) {
+		grp->tg_close_deadline = deadline;
+		if (!grp->tg_close_forced) {
+			grp->tg_close_forced = true;
+			grp->tg_close_timer_force.sa_cb =
+				&be_engine_group_timer_force;
+			m0_sm_ast_post(m0_be_tx_group__sm_group(grp),
+				       &grp->tg_close_timer_force);
+		}
+	}
 	be_engine_unlock(en);
 }
 
@@ -792,6 +1033,7 @@ static int be_engine_group_start(struct m0_be_engine *en, size_t index)
 M0_INTERNAL int m0_be_engine_start(struct m0_be_engine *en)
 {
 	m0_time_t recovery_time = 0;
+	size_t    recovery_group_nr;
 	int       rc = 0;
 	size_t    i;
 
@@ -800,19 +1042,26 @@ M0_INTERNAL int m0_be_engine_start(struct m0_be_engine *en)
 	M0_PRE(be_engine_invariant(en));
 
 	/*
-	 * Run BE recovery having only one group.
-	 * This prevents having m0_be_tx_group_reapply() called in wrong order,
-	 * i.e. not in the same order as corresponding log records in the log.
-	 * See EOS-7888 and linked tickets for an example of what happens if
-	 * the order of m0_be_tx_group_reapply() is wrong.
-	 *
-	 * An alternative solution would be to enforce the right order for
-	 * m0_be_tx_group_reapply(), but with group rewrite this solution
-	 * wouldn't be needed anymore. One group for recovery is just easier.
+	 * Run BE recovery having bec_recovery_group_nr groups, only one group
+	 * by default.
+	 * m0_be_tx_group_reapply() must not be called in wrong order for the
+	 * groups with overlapping regions, i.e. not in the same order as
+	 * corresponding log records in the log. See EOS-7888 and linked
+	 * tickets for an example of what happens if the order of
+	 * m0_be_tx_group_reapply() is wrong. With more than one group the
+	 * order is enforced by m0_be_engine__recovery_reapply_may_start().
 	 */
-	rc = be_engine_group_start(en, 0);
-	if (rc != 0)
-		return M0_ERR(rc);
+	recovery_group_nr = max_check(en->eng_cfg->bec_recovery_group_nr,
+				      (size_t)1);
+	recovery_group_nr = min_check(recovery_group_nr, en->eng_group_nr);
+	for (i = 0; i < recovery_group_nr; ++i) {
+		rc = be_engine_group_start(en, i);
+		if (rc != 0) {
+			be_engine_group_stop_nr(en, i);
+			be_engine_unlock(en);
+			return M0_ERR(rc);
+		}
+	}
 
 	recovery_time = m0_time_now();
 	be_engine_try_recovery(en);
@@ -833,7 +1082,7 @@ M0_INTERNAL int m0_be_engine_start(struct m0_be_engine *en)
 		/* XXX workaround END */
 	}
 	be_engine_lock(en);
-	for (i = 1; i < en->eng_group_nr; ++i) {
+	for (i = recovery_group_nr; i < en->eng_group_nr; ++i) {
 		rc = be_engine_group_start(en, i);
 		if (rc != 0)
 			break;
@@ -884,6 +1133,93 @@ M0_INTERNAL void m0_be_engine_full_log_cb(struct m0_be_log *log)
 	m0_be_log_discard_sync(&dom->bd_log_discard);
 }
 
+M0_INTERNAL int m0_be_engine_log_resize(struct m0_be_engine *en,
+					m0_bcount_t          size)
+{
+	struct m0_be_log *log = &en->eng_log;
+	m0_bcount_t       buf_size;
+	m0_bcount_t       tx_size;
+	int               rc;
+
+	M0_ENTRY("en=%p size=%"PRIu64, en, size);
+
+	be_engine_lock(en);
+	M0_PRE(be_engine_invariant(en));
+	tx_size = m0_be_group_format_log_reserved_size(log,
+					&en->eng_cfg->bec_tx_size_max,
+					en->eng_cfg->bec_tx_payload_max);
+	rc = m0_be_log_store_resize_check(&log->lg_store, size, &buf_size);
+	if (rc == 0 && buf_size < tx_size)
+		rc = M0_ERR_INFO(-EINVAL, "buf_size=%"PRIu64" tx_size=%"PRIu64,
+				 buf_size, tx_size);
+	if (rc == 0 && m0_be_log_recovery_record_available(log))
+		rc = M0_ERR(-EBUSY);
+	rc = rc ?: m0_be_log_resize(log, size);
+	/* don't wait for the log discard timeout to drain the log */
+	if (rc == 0 && m0_be_log_resize_is_pending(log))
+		m0_be_log_discard_sync(&en->eng_domain->bd_log_discard);
+	M0_POST(be_engine_invariant(en));
+	be_engine_unlock(en);
+
+	return M0_RC(rc);
+}
+
+M0_INTERNAL void m0_be_engine_tunables_get(struct m0_be_engine          *en,
+					   struct m0_be_engine_tunables *t)
+{
+	struct m0_be_engine_cfg *cfg = en->eng_cfg;
+
+	be_engine_lock(en);
+	*t = (struct m0_be_engine_tunables) {
+		.bet_tx_active_max = cfg->bec_tx_active_max,
+		.bet_group_freeze_timeout_min =
+			cfg->bec_group_freeze_timeout_min,
+		.bet_group_freeze_timeout_max =
+			cfg->bec_group_freeze_timeout_max,
+		.bet_group_freeze_timeout_limit =
+			cfg->bec_group_freeze_timeout_limit,
+	};
+	be_engine_unlock(en);
+}
+
+M0_INTERNAL void m0_be_engine_stats_get(struct m0_be_engine       *en,
+					struct m0_be_engine_stats *stats)
+{
+	be_engine_lock(en);
+	*stats = en->eng_stats;
+	be_engine_unlock(en);
+}
+
+M0_INTERNAL int m0_be_engine_tunables_set(struct m0_be_engine *en,
+				const struct m0_be_engine_tunables *t)
+{
+	struct m0_be_engine_cfg *cfg = en->eng_cfg;
+
+	M0_ENTRY("en=%p tx_active_max=%"PRIu64" timeout=[%"PRIu64
+		 ", %"PRIu64"] limit=%"PRIu64, en, t->bet_tx_active_max,
+		 t->bet_group_freeze_timeout_min,
+		 t->bet_group_freeze_timeout_max,
+		 t->bet_group_freeze_timeout_limit);
+
+	if (t->bet_tx_active_max == 0 ||
+	    t->bet_group_freeze_timeout_min > t->bet_group_freeze_timeout_max ||
+	    t->bet_group_freeze_timeout_limit == 0)
+		return M0_ERR(-EINVAL);
+
+	be_engine_lock(en);
+	M0_PRE(be_engine_invariant(en));
+	cfg->bec_tx_active_max              = t->bet_tx_active_max;
+	cfg->bec_group_freeze_timeout_min   = t->bet_group_freeze_timeout_min;
+	cfg->bec_group_freeze_timeout_max   = t->bet_group_freeze_timeout_max;
+	cfg->bec_group_freeze_timeout_limit = t->bet_group_freeze_timeout_limit;
+	/* a bigger tx_active_max may let waiting transactions in */
+	be_engine_got_tx_grouping(en);
+	M0_POST(be_engine_invariant(en));
+	be_engine_unlock(en);
+
+	return M0_RC(0);
+}
+
 M0_INTERNAL struct m0_be_tx *m0_be_engine__tx_find(struct m0_be_engine *en,
 						   uint64_t             id)
 {
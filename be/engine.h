@@ -80,10 +80,24 @@ struct m0_be_engine_cfg {
 	m0_time_t		   bec_group_freeze_timeout_min;
 	m0_time_t		   bec_group_freeze_timeout_max;
 	m0_time_t                  bec_group_freeze_timeout_limit;
+	/**
+	 * Adapt the group freeze timeout and the number of transactions per
+	 * group to the load instead of using the static values above.
+	 * @see m0_be_engine_adaptive.
+	 */
+	bool                       bec_group_adaptive;
 	/** Request handler for group foms and engine timeouts */
 	struct m0_reqh		  *bec_reqh;
 	/** Wait in m0_be_engine_start() until recovery is finished. */
 	bool			   bec_wait_for_recovery;
+	/**
+	 * Number of groups which replay the log during recovery. Log records
+	 * are read, decoded and placed by the groups in parallel, only the
+	 * groups with overlapping regions are reapplied in the log order.
+	 * 0 and 1 mean that log records are replayed one by one. It is
+	 * limited by bec_group_nr.
+	 */
+	size_t			   bec_recovery_group_nr;
 	/** BE domain the engine belongs to. */
 	struct m0_be_domain	  *bec_domain;
 	struct m0_be_log_discard  *bec_log_discard;
@@ -94,6 +108,53 @@ struct m0_be_engine_cfg {
 	struct m0_mutex           *bec_lock;
 };
 
+/**
+ * State of the adaptive group sizing (m0_be_engine_cfg::bec_group_adaptive).
+ *
+ * The engine keeps moving averages of the transaction inter-arrival time and
+ * of the group log write latency. A group is frozen as soon as it has as many
+ * transactions as arrive during one log write (ea_tx_target), because waiting
+ * longer only adds latency to the transactions already in the group. The
+ * freeze timeout is the time needed for ea_tx_target transactions to arrive,
+ * bounded by bec_group_freeze_timeout_min and bec_group_freeze_timeout_max.
+ *
+ * All fields are protected by the engine lock.
+ */
+struct m0_be_engine_adaptive {
+	/** Time when the last transaction was added to a group. */
+	m0_time_t ea_tx_last;
+	/** Moving average of the time between transaction arrivals. */
+	m0_time_t ea_tx_interval;
+	/** Moving average of the group log write latency. */
+	m0_time_t ea_log_latency;
+	/** Number of transactions after which an open group is frozen. */
+	uint32_t  ea_tx_target;
+	/** Group freeze timeout. */
+	m0_time_t ea_timeout;
+};
+
+/**
+ * Statistics of the groups logged by the engine, see m0_be_engine_stats_get().
+ * Fill ratios of the groups are es_tx / es_tx_max and es_reg_size /
+ * es_reg_size_max.
+ */
+struct m0_be_engine_stats {
+	/** Number of logged groups. */
+	uint64_t    es_groups;
+	/** Number of transactions in the logged groups. */
+	uint64_t    es_tx;
+	/** Sum of m0_be_tx_group_cfg::tgc_tx_nr_max of the logged groups. */
+	uint64_t    es_tx_max;
+	/** Sum of the region sizes captured by the logged groups. */
+	m0_bcount_t es_reg_size;
+	/** Sum of the region size limits of the logged groups. */
+	m0_bcount_t es_reg_size_max;
+	/** Size of the log records written. */
+	m0_bcount_t es_log_size;
+	/** Sum of the log record write latencies. */
+	m0_time_t   es_log_time;
+};
+
 struct m0_be_engine {
 	struct m0_be_engine_cfg   *eng_cfg;
 	/**
@@ -118,6 +179,11 @@ struct m0_be_engine {
 	struct m0_be_domain       *eng_domain;
 	struct m0_semaphore        eng_recovery_wait_sem;
 	bool                       eng_recovery_finished;
+	/** Sequence number of the last log record taken for recovery. */
+	uint64_t                   eng_recovery_seq;
+	/** Adaptive group sizing. */
+	struct m0_be_engine_adaptive eng_adaptive;
+	struct m0_be_engine_stats  eng_stats;
 };
 
 M0_INTERNAL bool m0_be_engine__invariant(struct m0_be_engine *en);
@@ -153,9 +219,72 @@ M0_INTERNAL void m0_be_engine__tx_group_ready(struct m0_be_engine   *en,
 M0_INTERNAL void m0_be_engine__tx_group_discard(struct m0_be_engine   *en,
 						struct m0_be_tx_group *gr);
 
+/**
+ * Log record of the group has been written in @latency time. It is used by the
+ * adaptive group sizing and is accounted in m0_be_engine::eng_stats.
+ */
+M0_INTERNAL void m0_be_engine__tx_group_logged(struct m0_be_engine   *en,
+					       struct m0_be_tx_group *gr,
+					       m0_time_t              latency);
+
+/* next functions should be called from m0_be_tx_group recovery */
+
+/** Regions of the recovering group are known. */
+M0_INTERNAL void
+m0_be_engine__recovery_group_decoded(struct m0_be_engine   *en,
+				     struct m0_be_tx_group *gr);
+/** Regions of the recovering group have been copied to the segments. */
+M0_INTERNAL void
+m0_be_engine__recovery_group_reapplied(struct m0_be_engine   *en,
+				       struct m0_be_tx_group *gr);
+/**
+ * Returns true iff the recovering group may reapply its regions, i.e. every
+ * group with an earlier log record has either been reapplied or has no regions
+ * overlapping with the regions of the group. Otherwise the group is woken up
+ * with m0_be_tx_group_reapply_wakeup() when it's time to check again.
+ */
+M0_INTERNAL bool
+m0_be_engine__recovery_reapply_may_start(struct m0_be_engine   *en,
+					 struct m0_be_tx_group *gr);
+
 M0_INTERNAL void m0_be_engine_got_log_space_cb(struct m0_be_log *log);
 M0_INTERNAL void m0_be_engine_full_log_cb(struct m0_be_log *log);
 
+/**
+ * Resizes the log online, see m0_be_log_resize(). New transactions wait until
+ * the log is drained and the new size is applied.
+ *
+ * @return -EINVAL the biggest transaction doesn't fit into the new log.
+ */
+M0_INTERNAL int m0_be_engine_log_resize(struct m0_be_engine *en,
+					m0_bcount_t          size);
+
+/**
+ * Engine parameters which can be changed while the engine is running.
+ * They have the same meaning as the m0_be_engine_cfg fields of the same name.
+ */
+struct m0_be_engine_tunables {
+	uint64_t  bet_tx_active_max;
+	m0_time_t bet_group_freeze_timeout_min;
+	m0_time_t bet_group_freeze_timeout_max;
+	m0_time_t bet_group_freeze_timeout_limit;
+};
+
+M0_INTERNAL void m0_be_engine_tunables_get(struct m0_be_engine          *en,
+					   struct m0_be_engine_tunables *t);
+/**
+ * Changes the engine parameters online. Groups already armed keep their
+ * timeouts, the new values are used from the next group.
+ *
+ * @return -EINVAL the parameters are inconsistent.
+ */
+M0_INTERNAL int m0_be_engine_tunables_set(struct m0_be_engine *en,
+				const struct m0_be_engine_tunables *t);
+
+/** Returns statistics of the groups logged since the engine start. */
+M0_INTERNAL void m0_be_engine_stats_get(struct m0_be_engine       *en,
+					struct m0_be_engine_stats *stats);
+
 M0_INTERNAL struct m0_be_tx *m0_be_engine__tx_find(struct m0_be_engine *en,
 						   uint64_t             id);
 M0_INTERNAL int
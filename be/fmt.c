@@ -31,6 +31,7 @@
 #include "lib/misc.h"           /* container_of */
 #include "lib/errno.h"          /* ENOMEM */
 #include "lib/memory.h"         /* M0_ALLOC_ARR */
+#include "lib/arith.h"          /* min64u */
 #include "xcode/xcode.h"        /* m0_xcode_ctx */
 
 /**
@@ -305,6 +306,8 @@ M0_INTERNAL void m0_be_fmt_group_reset(struct m0_be_fmt_group *fg)
 	content->fmc_reg_area.cra_nr = 0;
 	fg->fg_header.fgh_reg_nr     = 0;
 	fg->fg_header.fgh_tx_nr      = 0;
+	fg->fg_header.fgh_info.gi_unknown &=
+		~(uint64_t)M0_BE_FMT_GROUP_COMPRESSED;
 
 
 	M0_ASSERT(cheader->fch_txs.cht_tx != NULL);
@@ -374,6 +377,7 @@ M0_INTERNAL void m0_be_fmt_group_reg_add(struct m0_be_fmt_group     *fg,
 	ra  = &fg->fg_content.fmc_reg_area;
 	hra = &fg->fg_content_header.fch_reg_area;
 
+	M0_PRE(!m0_be_fmt_group_is_compressed(fg));
 	M0_ASSERT(ra->cra_nr  < cfg->fgc_reg_nr_max);
 	M0_ASSERT(hra->chr_nr < cfg->fgc_reg_nr_max);
 	M0_ASSERT(fg->fg_header.fgh_reg_nr < cfg->fgc_reg_nr_max);
@@ -402,6 +406,7 @@ M0_INTERNAL void m0_be_fmt_group_reg_by_id(const struct m0_be_fmt_group *fg,
 	const struct m0_be_fmt_content_reg_area        *ra;
 
 	M0_PRE(index < m0_be_fmt_group_reg_nr(fg));
+	M0_PRE(!m0_be_fmt_group_is_compressed(fg));
 
 	ra  = &fg->fg_content.fmc_reg_area;
 	hra = &fg->fg_content_header.fch_reg_area;
@@ -485,7 +490,8 @@ M0_INTERNAL bool m0_be_fmt_group_sanity_check(struct m0_be_fmt_group *fg)
 	return _0C(ra->cra_nr  < cfg->fgc_reg_nr_max) &&
 		_0C(hra->chr_nr < cfg->fgc_reg_nr_max) &&
 		_0C(fg->fg_header.fgh_reg_nr < cfg->fgc_reg_nr_max) &&
-		_0C(hra->chr_nr == ra->cra_nr) &&
+		_0C(m0_be_fmt_group_is_compressed(fg) ? ra->cra_nr == 1 :
+		    hra->chr_nr == ra->cra_nr) &&
 		_0C(hra->chr_nr == fg->fg_header.fgh_reg_nr) &&
 		_0C(cheader->fch_txs.cht_tx != NULL) &&
 		_0C(cheader->fch_reg_area.chr_reg != NULL) &&
@@ -498,6 +504,324 @@ M0_INTERNAL bool m0_be_fmt_group_sanity_check(struct m0_be_fmt_group *fg)
 		_0C(ht->cht_nr == fg->fg_header.fgh_tx_nr);
 }
 
+/*
+ * Compression of the group region data.
+ *
+ * Data of all regions of a group is compressed as one block in LZ4 block
+ * format: a sequence of (token, literals, offset, match length) records, the
+ * last record has literals only. Greedy matching with a single-entry hash
+ * table is used, which gives most of the gain on the typical BE log contents
+ * (zeroed memory, btree nodes with repeated keys, small updates of large
+ * structures) at the cost of a memcpy-like pass over the data.
+ */
+enum {
+	BE_FMT_LZ_HASH_SHIFT    = 12,
+	BE_FMT_LZ_HASH_NR       = 1 << BE_FMT_LZ_HASH_SHIFT,
+	BE_FMT_LZ_MATCH_MIN     = 4,
+	/* last match has to start at least MFLIMIT bytes before the end */
+	BE_FMT_LZ_MFLIMIT       = 12,
+	/* last LAST_LITERALS bytes are always literals */
+	BE_FMT_LZ_LAST_LITERALS = 5,
+	BE_FMT_LZ_OFFSET_MAX    = 0xffff,
+	BE_FMT_LZ_LEN_MASK      = 0xf,
+	/* regions smaller than this are not worth compressing */
+	BE_FMT_LZ_SIZE_MIN      = 0x100,
+};
+
+static uint32_t be_fmt_lz_hash(const unsigned char *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof v);
+	return (v * 2654435761U) >> (32 - BE_FMT_LZ_HASH_SHIFT);
+}
+
+static unsigned char *be_fmt_lz_len_put(unsigned char *op,
+					unsigned char *oend,
+					m0_bcount_t    len)
+{
+	for (; len >= 0xff; len -= 0xff) {
+		if (op == oend)
+			return NULL;
+		*op++ = 0xff;
+	}
+	if (op == oend)
+		return NULL;
+	*op++ = len;
+	return op;
+}
+
+/* match_len == 0 means that it's the last sequence */
+static unsigned char *be_fmt_lz_seq_put(unsigned char       *op,
+					unsigned char       *oend,
+					const unsigned char *lit,
+					m0_bcount_t          lit_len,
+					m0_bcount_t          offset,
+					m0_bcount_t          match_len)
+{
+	unsigned char *token;
+	m0_bcount_t    len;
+
+	if (op == oend)
+		return NULL;
+	token  = op++;
+	*token = min64u(lit_len, BE_FMT_LZ_LEN_MASK) << 4;
+	if (lit_len >= BE_FMT_LZ_LEN_MASK) {
+		op = be_fmt_lz_len_put(op, oend, lit_len - BE_FMT_LZ_LEN_MASK);
+		if (op == NULL)
+			return NULL;
+	}
+	if (oend - op < lit_len)
+		return NULL;
+	memcpy(op, lit, lit_len);
+	op += lit_len;
+	if (match_len == 0)
+		return op;
+	if (oend - op < 2)
+		return NULL;
+	*op++ = offset & 0xff;
+	*op++ = offset >> 8;
+	len = match_len - BE_FMT_LZ_MATCH_MIN;
+	*token |= min64u(len, BE_FMT_LZ_LEN_MASK);
+	if (len >= BE_FMT_LZ_LEN_MASK)
+		op = be_fmt_lz_len_put(op, oend, len - BE_FMT_LZ_LEN_MASK);
+	return op;
+}
+
+/**
+ * Compresses src into dst.
+ *
+ * @param hash work area of BE_FMT_LZ_HASH_NR elements
+ * @return size of the compressed data or 0 if it doesn't fit into dst.
+ */
+static m0_bcount_t be_fmt_lz_compress(const unsigned char *src,
+				      m0_bcount_t          size,
+				      unsigned char       *dst,
+				      m0_bcount_t          dst_size,
+				      uint32_t            *hash)
+{
+	const unsigned char *ip      = src;
+	const unsigned char *anchor  = src;
+	const unsigned char *end     = src + size;
+	const unsigned char *mflimit = src + (size > BE_FMT_LZ_MFLIMIT ?
+					      size - BE_FMT_LZ_MFLIMIT : 0);
+	const unsigned char *ref;
+	unsigned char       *op      = dst;
+	unsigned char       *oend    = dst + dst_size;
+	m0_bcount_t          len;
+	uint32_t             h;
+
+	M0_PRE(size < UINT32_MAX);
+
+	/* positions are stored +1, 0 means empty slot */
+	memset(hash, 0, sizeof hash[0] * BE_FMT_LZ_HASH_NR);
+	while (ip < mflimit) {
+		h       = be_fmt_lz_hash(ip);
+		ref     = hash[h] == 0 ? NULL : src + hash[h] - 1;
+		hash[h] = ip - src + 1;
+		if (ref == NULL || ip - ref > BE_FMT_LZ_OFFSET_MAX ||
+		    memcmp(ref, ip, BE_FMT_LZ_MATCH_MIN) != 0) {
+			/* skip faster through incompressible data */
+			ip += 1 + ((ip - anchor) >> 6);
+			continue;
+		}
+		len = BE_FMT_LZ_MATCH_MIN;
+		while (ip + len < end - BE_FMT_LZ_LAST_LITERALS &&
+		       ref[len] == ip[len])
+			++len;
+		op = be_fmt_lz_seq_put(op, oend, anchor, ip - anchor,
+				       ip - ref, len);
+		if (op == NULL)
+			return 0;
+		ip    += len;
+		anchor = ip;
+	}
+	op = be_fmt_lz_seq_put(op, oend, anchor, end - anchor, 0, 0);
+	return op == NULL ? 0 : op - dst;
+}
+
+static const unsigned char *be_fmt_lz_len_get(const unsigned char *ip,
+					      const unsigned char *iend,
+					      m0_bcount_t         *len)
+{
+	unsigned char b;
+
+	do {
+		if (ip == iend)
+			return NULL;
+		b = *ip++;
+		*len += b;
+	} while (b == 0xff);
+	return ip;
+}
+
+/**
+ * Decompresses src into dst. Size of the decompressed data has to be
+ * exactly dst_size.
+ */
+static int be_fmt_lz_decompress(const unsigned char *src,
+				m0_bcount_t          size,
+				unsigned char       *dst,
+				m0_bcount_t          dst_size)
+{
+	const unsigned char *ip   = src;
+	const unsigned char *iend = src + size;
+	unsigned char       *op   = dst;
+	unsigned char       *oend = dst + dst_size;
+	m0_bcount_t          offset;
+	m0_bcount_t          len;
+	unsigned char        token;
+
+	while (ip < iend) {
+		token = *ip++;
+		len   = token >> 4;
+		if (len == BE_FMT_LZ_LEN_MASK) {
+			ip = be_fmt_lz_len_get(ip, iend, &len);
+			if (ip == NULL)
+				return M0_ERR(-EPROTO);
+		}
+		if (iend - ip < len || oend - op < len)
+			return M0_ERR(-EPROTO);
+		memcpy(op, ip, len);
+		op += len;
+		ip += len;
+		if (ip == iend)
+			break;
+		if (iend - ip < 2)
+			return M0_ERR(-EPROTO);
+		offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > op - dst)
+			return M0_ERR(-EPROTO);
+		len = token & BE_FMT_LZ_LEN_MASK;
+		if (len == BE_FMT_LZ_LEN_MASK) {
+			ip = be_fmt_lz_len_get(ip, iend, &len);
+			if (ip == NULL)
+				return M0_ERR(-EPROTO);
+		}
+		len += BE_FMT_LZ_MATCH_MIN;
+		if (oend - op < len)
+			return M0_ERR(-EPROTO);
+		if (offset >= len) {
+			memcpy(op, op - offset, len);
+			op += len;
+		} else {
+			/* overlapping match: repeats the last offset bytes */
+			for (; len > 0; --len, ++op)
+				*op = op[-offset];
+		}
+	}
+	return op == oend ? 0 : M0_ERR(-EPROTO);
+}
+
+M0_INTERNAL bool
+m0_be_fmt_group_is_compressed(const struct m0_be_fmt_group *fg)
+{
+	return (fg->fg_header.fgh_info.gi_unknown &
+		M0_BE_FMT_GROUP_COMPRESSED) != 0;
+}
+
+M0_INTERNAL m0_bcount_t
+m0_be_fmt_group_compress_buf_size(const struct m0_be_fmt_group_cfg *cfg)
+{
+	return sizeof(uint32_t) * BE_FMT_LZ_HASH_NR +
+	       cfg->fgc_reg_size_max * 2;
+}
+
+M0_INTERNAL bool m0_be_fmt_group_compress(struct m0_be_fmt_group *fg,
+					  struct m0_buf          *buf)
+{
+	const struct m0_be_fmt_group_cfg  *cfg  = (void *)fg->fg_cfg;
+	struct m0_be_fmt_content_reg_area *ra   = &fg->fg_content.fmc_reg_area;
+	uint32_t                          *hash = buf->b_addr;
+	unsigned char                     *raw;
+	unsigned char                     *out;
+	m0_bcount_t                        size = 0;
+	m0_bcount_t                        size_compressed;
+	uint32_t                           i;
+
+	M0_PRE(buf->b_nob >= m0_be_fmt_group_compress_buf_size(cfg));
+	M0_PRE(!m0_be_fmt_group_is_compressed(fg));
+
+	for (i = 0; i < ra->cra_nr; ++i)
+		size += ra->cra_reg[i].b_nob;
+	if (size < BE_FMT_LZ_SIZE_MIN)
+		return false;
+	M0_ASSERT(size <= cfg->fgc_reg_size_max);
+
+	raw  = (unsigned char *)&hash[BE_FMT_LZ_HASH_NR];
+	out  = raw + cfg->fgc_reg_size_max;
+	size = 0;
+	for (i = 0; i < ra->cra_nr; ++i) {
+		memcpy(raw + size, ra->cra_reg[i].b_addr, ra->cra_reg[i].b_nob);
+		size += ra->cra_reg[i].b_nob;
+	}
+	/* compressed data is useful only if it is smaller */
+	size_compressed = be_fmt_lz_compress(raw, size, out, size - 1, hash);
+	M0_LOG(M0_DEBUG, "reg_nr=%"PRIu32" size=%"PRIu64" "
+	       "size_compressed=%"PRIu64, ra->cra_nr, size, size_compressed);
+	if (size_compressed == 0)
+		return false;
+
+	ra->cra_nr     = 1;
+	ra->cra_reg[0] = M0_BUF_INIT(size_compressed, out);
+	fg->fg_header.fgh_info.gi_unknown |= M0_BE_FMT_GROUP_COMPRESSED;
+	return true;
+}
+
+M0_INTERNAL int m0_be_fmt_group_decompress(struct m0_be_fmt_group *fg)
+{
+	struct m0_be_fmt_content_header_reg_area *hra;
+	struct m0_be_fmt_content_reg_area        *ra;
+	struct m0_buf                            *regs;
+	unsigned char                            *raw;
+	m0_bcount_t                               size = 0;
+	m0_bcount_t                               reg_size;
+	uint32_t                                  i;
+	int                                       rc;
+
+	if (!m0_be_fmt_group_is_compressed(fg))
+		return 0;
+
+	ra  = &fg->fg_content.fmc_reg_area;
+	hra = &fg->fg_content_header.fch_reg_area;
+	if (ra->cra_nr != 1 || hra->chr_nr == 0 ||
+	    hra->chr_nr != fg->fg_header.fgh_reg_nr)
+		return M0_ERR(-EPROTO);
+	for (i = 0; i < hra->chr_nr; ++i) {
+		reg_size = hra->chr_reg[i].chg_size;
+		if (size + reg_size < size)
+			return M0_ERR(-EPROTO);
+		size += reg_size;
+	}
+	if (size == 0)
+		return M0_ERR(-EPROTO);
+	raw = m0_alloc(size);
+	M0_ALLOC_ARR(regs, hra->chr_nr);
+	rc = raw == NULL || regs == NULL ? M0_ERR(-ENOMEM) :
+	     be_fmt_lz_decompress(ra->cra_reg[0].b_addr, ra->cra_reg[0].b_nob,
+				  raw, size);
+	for (i = 0, size = 0; rc == 0 && i < hra->chr_nr; ++i) {
+		reg_size = hra->chr_reg[i].chg_size;
+		rc = m0_buf_copy(&regs[i], &M0_BUF_INIT(reg_size, raw + size));
+		size += reg_size;
+	}
+	if (rc == 0) {
+		/* the same layout as if the group was decoded uncompressed */
+		m0_free(ra->cra_reg[0].b_addr);
+		m0_free(ra->cra_reg);
+		ra->cra_reg = regs;
+		ra->cra_nr  = hra->chr_nr;
+		fg->fg_header.fgh_info.gi_unknown &=
+			~(uint64_t)M0_BE_FMT_GROUP_COMPRESSED;
+	} else if (regs != NULL) {
+		m0_forall(j, hra->chr_nr, (m0_buf_free(&regs[j]), true));
+		m0_free(regs);
+	}
+	m0_free(raw);
+	return M0_RC(rc);
+}
+
 /* -------------------------------------------------------------------------- */
 
 #define M0_BE_FMT_DEFINE_INIT_SIMPLE(name)                              \
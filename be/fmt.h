@@ -124,8 +124,22 @@ struct m0_buf;
 struct m0_be_group_format;
 struct m0_be_fmt_log_record_header;
 
+/** Flags of m0_be_fmt_group_info::gi_unknown. */
+enum m0_be_fmt_group_flags {
+	/**
+	 * Data of all regions is compressed into the only element of
+	 * m0_be_fmt_content_reg_area::cra_reg.
+	 * @see m0_be_fmt_group_compress(), m0_be_fmt_group_decompress()
+	 */
+	M0_BE_FMT_GROUP_COMPRESSED = 1 << 0,
+};
+
 struct m0_be_fmt_group_info {
-	/* there is nothing we can do with unknown field. */
+	/*
+	 * m0_be_fmt_group_flags. The field is zero in groups written before
+	 * the flags were introduced, the name is kept to keep xcode
+	 * representation the same.
+	 */
 	uint64_t gi_unknown;
 } M0_XCA_RECORD M0_XCA_DOMAIN(be);
 
@@ -195,6 +209,11 @@ struct m0_be_fmt_log_store_header {
 	/* circular buffer configuration */
 	m0_bindex_t fsh_cbuf_offset;
 	m0_bcount_t fsh_cbuf_size;
+	/* log position that is mapped to the beginning of circular buffer */
+	m0_bindex_t fsh_cbuf_base;
+	/* striping configuration, fsh_cbuf_size is the sum for all stripes */
+	unsigned    fsh_stripe_nr;
+	m0_bcount_t fsh_stripe_unit;
 } M0_XCA_RECORD M0_XCA_DOMAIN(be);
 
 struct m0_be_fmt_group_cfg;
@@ -382,6 +401,31 @@ m0_be_fmt_group_info_get(struct m0_be_fmt_group *fg);
 
 M0_INTERNAL bool m0_be_fmt_group_sanity_check(struct m0_be_fmt_group *fg);
 
+M0_INTERNAL bool
+m0_be_fmt_group_is_compressed(const struct m0_be_fmt_group *fg);
+/** Size of the work buffer for m0_be_fmt_group_compress(). */
+M0_INTERNAL m0_bcount_t
+m0_be_fmt_group_compress_buf_size(const struct m0_be_fmt_group_cfg *cfg);
+/**
+ * Compresses data of all regions of the group into buf.
+ *
+ * Region headers are not changed, so m0_be_fmt_group_size() of the group
+ * never exceeds m0_be_fmt_group_size_max(). Nothing is done if the compressed
+ * data isn't smaller than the original region data. buf has to stay valid
+ * until the group is encoded. No regions can be added after the call.
+ *
+ * @return true if the regions are compressed.
+ */
+M0_INTERNAL bool m0_be_fmt_group_compress(struct m0_be_fmt_group *fg,
+					  struct m0_buf          *buf);
+/**
+ * Restores regions of a decoded group compressed with
+ * m0_be_fmt_group_compress(). Does nothing for uncompressed groups.
+ * The group can be freed with m0_be_fmt_group_decoded_free() after the call
+ * regardless of the result.
+ */
+M0_INTERNAL int m0_be_fmt_group_decompress(struct m0_be_fmt_group *fg);
+
 M0_BE_FMT_DECLARE(cblock);
 M0_BE_FMT_DECLARE(log_record_header);
 
@@ -121,6 +121,10 @@ struct m0_be_io {
 	/** The op passed to m0_be_io_sched_add() */
 	struct m0_be_op        *bio_sched_op_user;
 	struct m0_ext           bio_ext;
+	/** @see m0_be_io_barrier_enable */
+	bool                    bio_sched_barrier;
+	bool                    bio_sched_launched;
+	bool                    bio_sched_done;
 };
 
 M0_INTERNAL int m0_be_io_init(struct m0_be_io *bio);
@@ -168,6 +172,12 @@ M0_INTERNAL m0_bcount_t m0_be_io_size(struct m0_be_io *bio);
 M0_INTERNAL void m0_be_io_sync_enable(struct m0_be_io *bio);
 M0_INTERNAL bool m0_be_io_sync_is_enabled(struct m0_be_io *bio);
 
+/**
+ * m0_be_io_sched launches the I/O only after all I/Os queued before it are
+ * finished. Cleared by m0_be_io_reset().
+ */
+M0_INTERNAL void m0_be_io_barrier_enable(struct m0_be_io *bio);
+
 M0_INTERNAL enum m0_stob_io_opcode m0_be_io_opcode(struct m0_be_io *io);
 
 M0_INTERNAL void m0_be_io_configure(struct m0_be_io        *bio,
@@ -33,6 +33,7 @@
 #include "be/io_sched.h"
 
 #include "lib/ext.h"            /* m0_ext */
+#include "lib/arith.h"          /* max32u */
 
 #include "be/op.h"              /* m0_be_op */
 #include "be/io.h"              /* m0_be_io_launch */
@@ -55,8 +56,11 @@ M0_INTERNAL int m0_be_io_sched_init(struct m0_be_io_sched     *sched,
 		sched->bis_cfg = *cfg;
 	m0_mutex_init(&sched->bis_lock);
 	sched_io_tlist_init(&sched->bis_ios);
-	sched->bis_io_in_progress = false;
-	sched->bis_pos = sched->bis_cfg.bisc_pos_start;
+	sched->bis_io_nr        = 0;
+	sched->bis_io_exclusive = false;
+	sched->bis_io_retiring  = false;
+	sched->bis_pos          = sched->bis_cfg.bisc_pos_start;
+	sched->bis_pos_launch   = sched->bis_pos;
 
 	return 0;
 }
@@ -90,56 +94,88 @@ static bool be_io_sched_invariant(struct m0_be_io_sched *sched)
 		    sched_io_tlist_next(&sched->bis_ios, io)->bio_ext.e_start);
 }
 
+static uint32_t be_io_sched_io_nr_max(struct m0_be_io_sched *sched)
+{
+	return max32u(sched->bis_cfg.bisc_io_nr_max, 1);
+}
+
+static bool be_io_sched_can_launch(struct m0_be_io_sched *sched,
+				   struct m0_be_io       *io)
+{
+	bool exclusive = io->bio_sched_barrier ||
+			 m0_ext_is_empty(&io->bio_ext);
+
+	return io->bio_ext.e_start == sched->bis_pos_launch &&
+	       !sched->bis_io_exclusive &&
+	       sched->bis_io_nr < be_io_sched_io_nr_max(sched) &&
+	       ergo(exclusive, sched->bis_io_nr == 0);
+}
+
 static void be_io_sched_launch_next(struct m0_be_io_sched *sched)
 {
 	struct m0_be_io *io;
 
 	M0_PRE(m0_be_io_sched_is_locked(sched));
 
-	if (!sched->bis_io_in_progress) {
-		io = sched_io_tlist_head(&sched->bis_ios);
-		M0_ASSERT(ergo(io != NULL,
-			       sched->bis_pos <= io->bio_ext.e_start));
-		if (io != NULL) {
-			M0_LOG(M0_DEBUG, "bis_pos=%" PRIu64 " "
-			       "io->bio_ext.e_start=%"PRIu64,
-			       sched->bis_pos, io->bio_ext.e_start);
-		}
-		if (io != NULL && io->bio_ext.e_start == sched->bis_pos) {
-			sched->bis_io_in_progress = true;
-			M0_LOG(M0_DEBUG, "sched=%p io=%p pos=%"PRId64,
-			       sched, io, sched->bis_pos);
-			m0_be_op_active(io->bio_sched_op_user);
-			m0_be_io_launch(io, &io->bio_sched_op);
-		}
+	io = m0_tl_find(sched_io, io, &sched->bis_ios, !io->bio_sched_launched);
+	while (io != NULL && be_io_sched_can_launch(sched, io)) {
+		M0_LOG(M0_DEBUG, "sched=%p io=%p pos=%"PRId64" io_nr=%"PRIu32,
+		       sched, io, sched->bis_pos_launch, sched->bis_io_nr);
+		io->bio_sched_launched = true;
+		++sched->bis_io_nr;
+		sched->bis_io_exclusive = m0_ext_is_empty(&io->bio_ext);
+		sched->bis_pos_launch = io->bio_ext.e_end;
+		m0_be_op_active(io->bio_sched_op_user);
+		m0_be_io_launch(io, &io->bio_sched_op);
+		io = sched_io_tlist_next(&sched->bis_ios, io);
+	}
+	if (io != NULL) {
+		M0_ASSERT(sched->bis_pos_launch <= io->bio_ext.e_start);
+		M0_LOG(M0_DEBUG, "bis_pos_launch=%" PRIu64 " "
+		       "io->bio_ext.e_start=%"PRIu64" io_nr=%"PRIu32,
+		       sched->bis_pos_launch, io->bio_ext.e_start,
+		       sched->bis_io_nr);
 	}
 }
 
-static void be_io_sched_launch_next_locked(struct m0_be_io_sched *sched)
-{
-	m0_be_io_sched_lock(sched);
-	be_io_sched_launch_next(sched);
-	m0_be_io_sched_unlock(sched);
-}
-
+/*
+ * Finished I/Os are removed from the queue and their user ops are signalled
+ * only from the head of the queue, so the users see I/Os finished in the
+ * m0_ext order. Only one thread does this at a time: the user op callbacks
+ * are called without the scheduler lock and they shouldn't be reordered.
+ */
 static void be_io_sched_cb(struct m0_be_op *op, void *param)
 {
 	struct m0_be_io       *io    = param;
 	struct m0_be_io_sched *sched = io->bio_sched;
+	struct m0_be_op       *op_user;
 
 	M0_LOG(M0_DEBUG, "sched=%p io=%p", sched, io);
 
-	M0_PRE(io->bio_ext.e_start == sched->bis_pos);
-
 	m0_be_io_sched_lock(sched);
-	sched_io_tlink_del_fini(io);
-	m0_be_op_fini(&io->bio_sched_op);
-	sched->bis_io_in_progress = false;
-	sched->bis_pos = io->bio_ext.e_end;
+	M0_PRE(io->bio_sched_launched && !io->bio_sched_done);
+	M0_PRE(sched->bis_io_nr > 0);
+	io->bio_sched_done = true;
+	--sched->bis_io_nr;
+	if (m0_ext_is_empty(&io->bio_ext))
+		sched->bis_io_exclusive = false;
+	if (!sched->bis_io_retiring) {
+		sched->bis_io_retiring = true;
+		while ((io = sched_io_tlist_head(&sched->bis_ios)) != NULL &&
+		       io->bio_sched_done) {
+			M0_ASSERT(io->bio_ext.e_start == sched->bis_pos);
+			sched_io_tlink_del_fini(io);
+			m0_be_op_fini(&io->bio_sched_op);
+			sched->bis_pos = io->bio_ext.e_end;
+			op_user = io->bio_sched_op_user;
+			m0_be_io_sched_unlock(sched);
+			m0_be_op_done(op_user);
+			m0_be_io_sched_lock(sched);
+		}
+		sched->bis_io_retiring = false;
+	}
+	be_io_sched_launch_next(sched);
 	m0_be_io_sched_unlock(sched);
-
-	m0_be_op_done(io->bio_sched_op_user);
-	be_io_sched_launch_next_locked(sched);
 }
 
 static void be_io_sched_insert(struct m0_be_io_sched *sched,
@@ -204,6 +240,8 @@ M0_INTERNAL void m0_be_io_sched_add(struct m0_be_io_sched *sched,
 	m0_be_op_callback_set(&io->bio_sched_op, &be_io_sched_cb,
 			      io, M0_BOS_GC);
 	io->bio_sched_op_user = op;
+	io->bio_sched_launched = false;
+	io->bio_sched_done = false;
 	be_io_sched_launch_next(sched);
 }
 
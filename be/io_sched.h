@@ -42,6 +42,11 @@ struct m0_ext;
 struct m0_be_io_sched_cfg {
 	/** start position for m0_be_io_sched::bis_pos */
 	m0_bcount_t bisc_pos_start;
+	/**
+	 * Maximum number of I/Os launched at the same time.
+	 * 0 means 1, i.e. I/Os are executed one by one.
+	 */
+	uint32_t    bisc_io_nr_max;
 };
 
 /*
@@ -59,16 +64,29 @@ struct m0_be_io_sched_cfg {
  * - read I/O:
  *   - doesn't have m0_ext assigned (subject to change);
  *   - is launched after the last write I/O (at the time the read I/O is added
- *     to the scheduler's queue) from the queue is finished.
+ *     to the scheduler's queue) from the queue is finished;
+ *   - no other I/O is launched until the read I/O is finished;
+ * - up to m0_be_io_sched_cfg::bisc_io_nr_max I/Os are in flight at the same
+ *   time. I/O with m0_be_io_barrier_enable() is launched only after all
+ *   I/Os before it are finished;
+ * - the user ops are signalled in the m0_ext order regardless of the order
+ *   in which the I/Os are actually finished.
  */
 struct m0_be_io_sched {
 	struct m0_be_io_sched_cfg bis_cfg;
 	/** list of m0_be_io-s under scheduler's control */
 	struct m0_tl              bis_ios;
 	struct m0_mutex           bis_lock;
-	bool                      bis_io_in_progress;
-	/** position for the next I/O */
+	/** number of launched and not yet finished I/Os */
+	uint32_t                  bis_io_nr;
+	/** read I/O is in flight */
+	bool                      bis_io_exclusive;
+	/** some thread signals the user ops for the finished I/Os */
+	bool                      bis_io_retiring;
+	/** position for the next I/O to finish */
 	m0_bcount_t               bis_pos;
+	/** position for the next I/O to launch */
+	m0_bcount_t               bis_pos_launch;
 };
 
 M0_INTERNAL int m0_be_io_sched_init(struct m0_be_io_sched     *sched,
@@ -26,6 +26,7 @@
 #include "be/log.h"
 #include "be/fmt.h"
 #include "be/op.h"              /* m0_be_op */
+#include "be/io.h"              /* m0_be_io_barrier_enable */
 #include "be/ha.h"              /* m0_be_io_err_send */
 
 #include "lib/arith.h"          /* m0_align */
@@ -54,6 +55,7 @@ enum {
 };
 
 static void be_log_header_update(struct m0_be_log *log);
+static void be_log_resize_try(struct m0_be_log *log);
 static int  be_log_header_write(struct m0_be_log            *log,
 				struct m0_be_fmt_log_header *log_hdr);
 
@@ -85,6 +87,7 @@ static int be_log_level_enter(struct m0_module *module)
 		log->lg_prev_record      = 0;
 		log->lg_prev_record_size = 0;
 		log->lg_unplaced_exists  = false;
+		log->lg_resize_size      = 0;
 		m0_mutex_init(&log->lg_record_state_lock);
 		record_tlist_init(&log->lg_records);
 		m0_be_op_init(&log->lg_header_read_op);
@@ -546,6 +549,7 @@ M0_INTERNAL void m0_be_log_record_discard(struct m0_be_log *log,
 
 	M0_POST(m0_be_log__invariant(log));
 
+	be_log_resize_try(log);
 	log->lg_got_space_cb(log);
 }
 
@@ -817,6 +821,14 @@ M0_INTERNAL void m0_be_log_record_io_launch(struct m0_be_log_record *record,
 		be_log_header_io(log, M0_BE_LOG_STORE_IO_WRITE,
 				 &log->lg_header_write_op);
 	}
+	/*
+	 * The last I/O of the record makes it valid (commit block for
+	 * tx_group), so it is written only after all previous I/Os are
+	 * finished. The rest of I/Os may be in flight at the same time with
+	 * I/Os of other records.
+	 */
+	m0_be_io_barrier_enable(m0_be_log_io_be_io(
+				record->lgr_io[record->lgr_io_nr - 1]));
 	for (i = 0; i < record->lgr_io_nr; ++i) {
 		m0_be_op_set_add(&record->lgr_record_op,
 				 record->lgr_op[i]);
@@ -855,7 +867,7 @@ M0_INTERNAL int m0_be_log_reserve(struct m0_be_log *log, m0_bcount_t size)
 
 	M0_PRE(m0_be_log__invariant(log));
 
-	if (log->lg_free < size)  {
+	if (log->lg_free < size || log->lg_resize_size != 0) {
 		rc = -EAGAIN;
 	} else {
 		log->lg_free     -= size;
@@ -875,11 +887,68 @@ M0_INTERNAL void m0_be_log_unreserve(struct m0_be_log *log, m0_bcount_t size)
 	log->lg_free     += size;
 	log->lg_reserved -= size;
 
+	be_log_resize_try(log);
 	log->lg_got_space_cb(log);
 
 	M0_LEAVE("log="BL_F, BL_P(log));
 }
 
+/*
+ * Applies pending resize if the log is empty. The log header is written
+ * before the log store header: if the latter isn't written then the log is
+ * just empty with the old size.
+ */
+static void be_log_resize_try(struct m0_be_log *log)
+{
+	m0_bindex_t pos = log->lg_current;
+	int         rc;
+
+	if (log->lg_resize_size == 0 || log->lg_reserved != 0 ||
+	    log->lg_discarded != log->lg_current || log->lg_unplaced_exists)
+		return;
+
+	M0_ENTRY("log="BL_F" size=%"PRIu64, BL_P(log), log->lg_resize_size);
+	m0_be_log_header__set(&log->lg_header, pos, 0, 0);
+	rc = be_log_header_write(log, &log->lg_header);
+	rc = rc ?: m0_be_log_store_resize(&log->lg_store,
+					  log->lg_resize_size, pos);
+	if (rc == 0) {
+		log->lg_prev_record      = 0;
+		log->lg_prev_record_size = 0;
+		log->lg_free = m0_be_log_store_buf_size(&log->lg_store);
+	} else {
+		M0_LOG(M0_ERROR, "log resize failed: rc=%d size=%"PRIu64,
+		       rc, log->lg_resize_size);
+	}
+	log->lg_resize_size = 0;
+	M0_POST(m0_be_log__invariant(log));
+	M0_LEAVE("log="BL_F" rc=%d", BL_P(log), rc);
+}
+
+M0_INTERNAL int m0_be_log_resize(struct m0_be_log *log, m0_bcount_t size)
+{
+	int rc;
+
+	M0_ENTRY("log="BL_F" size=%"PRIu64, BL_P(log), size);
+	M0_PRE(m0_be_log__invariant(log));
+
+	if (log->lg_resize_size != 0 || log->lg_unplaced_exists)
+		return M0_ERR(-EBUSY);
+	rc = m0_be_log_store_resize_check(&log->lg_store, size, NULL);
+	if (rc == 0) {
+		log->lg_resize_size = size;
+		be_log_resize_try(log);
+		if (log->lg_resize_size == 0)
+			log->lg_got_space_cb(log);
+	}
+	return M0_RC(rc);
+}
+
+M0_INTERNAL bool m0_be_log_resize_is_pending(struct m0_be_log *log)
+{
+	return log->lg_resize_size != 0;
+}
+
 M0_INTERNAL uint32_t m0_be_log_bshift(struct m0_be_log *log)
 {
 	return m0_be_log_store_bshift(&log->lg_store);
@@ -153,6 +153,17 @@
  * Recovery is responsible for re-applying all unplaced and following them log
  * records.
  *
+ * <b>Online resize</b>
+ *
+ * m0_be_log_resize() changes size of the log store circular buffer while the
+ * log is open. Log stops giving new reservations (m0_be_log_reserve() returns
+ * -EAGAIN) until all records are discarded. Then new size is applied: the
+ * log header is written with the current position as discarded one and
+ * log_store maps positions starting from the current position to the new
+ * circular buffer. lc_got_space_cb is called after that. Log in this state
+ * looks like a newly created: recovery finds nothing before the current
+ * position.
+ *
  * <b>Log record iterator</b>
  *
  * Log record iterator is a structure that contains only information from log
@@ -312,6 +323,8 @@ struct m0_be_log {
 	struct m0_be_op          lg_header_read_op;
 	/* op for log header write */
 	struct m0_be_op          lg_header_write_op;
+	/** Pending m0_be_log_resize() size, 0 if nothing is pending. */
+	m0_bcount_t              lg_resize_size;
 };
 
 /* m0_be_log */
@@ -486,6 +499,16 @@ M0_INTERNAL int m0_be_log_reserve(struct m0_be_log *log, m0_bcount_t size);
  */
 M0_INTERNAL void m0_be_log_unreserve(struct m0_be_log *log, m0_bcount_t size);
 
+/**
+ * Resizes the log online, see "Online resize" above. @size has the same
+ * meaning as m0_be_log_store_cfg::lsc_size.
+ *
+ * @return -EINVAL log store can't have such size;
+ * @return -EBUSY another resize is pending or there are unplaced records.
+ */
+M0_INTERNAL int m0_be_log_resize(struct m0_be_log *log, m0_bcount_t size);
+M0_INTERNAL bool m0_be_log_resize_is_pending(struct m0_be_log *log);
+
 /** Returns optimal block shift for the underlying storage. */
 M0_INTERNAL uint32_t m0_be_log_bshift(struct m0_be_log *log);
 
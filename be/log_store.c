@@ -27,6 +27,7 @@
 #include "lib/errno.h"          /* ENOMEM */
 #include "lib/memory.h"         /* m0_alloc */
 #include "lib/misc.h"           /* M0_SET0 */
+#include "lib/arith.h"          /* m0_align */
 
 #include "be/fmt.h"             /* m0_be_fmt_log_header */
 #include "be/log.h"             /* m0_be_log_io */
@@ -75,7 +76,9 @@ M0_INTERNAL bool m0_be_log_store__invariant(struct m0_be_log_store *ls)
 	return true;
 }
 
-static int be_log_store_zero(struct m0_be_log_store *ls, m0_bcount_t ls_size)
+static int be_log_store_zero(struct m0_be_log_store *ls,
+			     struct m0_stob         *stob,
+			     m0_bcount_t             ls_size)
 {
 	m0_bindex_t pos;
 	m0_bcount_t size;
@@ -83,13 +86,13 @@ static int be_log_store_zero(struct m0_be_log_store *ls, m0_bcount_t ls_size)
 	void       *zero;
 	int         rc;
 
-	bshift = m0_stob_block_shift(ls->ls_stob);
+	bshift = m0_stob_block_shift(stob);
 	zero   = m0_alloc_aligned(M0_BE_LOG_STORE_WRITE_SIZE_MAX, bshift);
 	rc     = zero == NULL ? -ENOMEM : 0;
 	for (pos = 0; rc == 0 && pos < ls_size;
 	     pos += M0_BE_LOG_STORE_WRITE_SIZE_MAX) {
 		size = min64(ls_size - pos, M0_BE_LOG_STORE_WRITE_SIZE_MAX);
-		rc   = m0_be_io_single(ls->ls_stob, SIO_WRITE, zero, pos, size);
+		rc   = m0_be_io_single(stob, SIO_WRITE, zero, pos, size);
 	}
 	m0_free_aligned(zero, M0_BE_LOG_STORE_WRITE_SIZE_MAX, bshift);
 
@@ -116,18 +119,45 @@ be_log_store_header_validate(struct m0_be_fmt_log_store_header *header,
 	       header->fsh_rbuf_size_aligned);
 	M0_LOG(M0_DEBUG, "cbuf_offset = %"PRIu64,    header->fsh_cbuf_offset);
 	M0_LOG(M0_DEBUG, "cbuf_size = %"PRIu64,      header->fsh_cbuf_size);
+	M0_LOG(M0_DEBUG, "cbuf_base = %"PRIu64,      header->fsh_cbuf_base);
+	M0_LOG(M0_DEBUG, "stripe_nr = %u",           header->fsh_stripe_nr);
+	M0_LOG(M0_DEBUG, "stripe_unit = %"PRIu64,    header->fsh_stripe_unit);
 	M0_LOG(M0_DEBUG, "log store header end");
 
 	return header->fsh_size > 0 &&
 	       header->fsh_rbuf_nr > 0 &&
+	       header->fsh_stripe_nr > 0 &&
+	       header->fsh_cbuf_size > 0 &&
 	       header->fsh_cbuf_offset >=
 	       header->fsh_rbuf_offset + header->fsh_rbuf_nr *
 					 header->fsh_rbuf_size_aligned &&
-	       header->fsh_cbuf_offset +
-	       header->fsh_cbuf_size <= header->fsh_size &&
+	       header->fsh_cbuf_offset + header->fsh_cbuf_size /
+			header->fsh_stripe_nr <= header->fsh_size &&
 	       m0_is_aligned(header->fsh_rbuf_offset, alignment) &&
 	       m0_is_aligned(header->fsh_rbuf_size_aligned, alignment) &&
-	       m0_is_aligned(header->fsh_cbuf_offset, alignment);
+	       m0_is_aligned(header->fsh_cbuf_offset, alignment) &&
+	       ergo(header->fsh_stripe_nr > 1,
+		    header->fsh_stripe_unit > 0 &&
+		    m0_is_aligned(header->fsh_stripe_unit, alignment) &&
+		    header->fsh_cbuf_size % (header->fsh_stripe_unit *
+					     header->fsh_stripe_nr) == 0);
+}
+
+/* Circular buffer size for the backing stobs of the given size. */
+static m0_bcount_t
+be_log_store_cbuf_size(const struct m0_be_fmt_log_store_header *header,
+		       m0_bcount_t                              size)
+{
+	m0_bcount_t stripe_size;
+
+	if (size <= header->fsh_cbuf_offset)
+		return 0;
+	stripe_size = size - header->fsh_cbuf_offset;
+	if (header->fsh_stripe_nr > 1) {
+		stripe_size = m0_round_down(stripe_size,
+					    header->fsh_stripe_unit);
+	}
+	return stripe_size * header->fsh_stripe_nr;
 }
 
 static int be_log_store_rbuf_alloc(struct m0_be_log_store *ls,
@@ -231,6 +261,89 @@ static void be_log_store_rbuf_arr_free(struct m0_be_log_store *ls)
 	m0_free(ls->ls_rbuf_read_buf);
 }
 
+static int be_log_store_header_write(struct m0_be_log_store *ls,
+				     struct m0_stob         *stob)
+{
+	return m0_be_io_single(stob, SIO_WRITE, ls->ls_header_buf.b_addr, 0,
+			       ls->ls_header_buf.b_nob);
+}
+
+static int be_log_store_stripe_init(struct m0_be_log_store *ls,
+				    unsigned                index)
+{
+	struct m0_be_log_store_cfg *cfg = &ls->ls_cfg;
+	struct m0_stob_id           stob_id = cfg->lsc_stob_id;
+	struct m0_stob             *stob;
+	const char                 *create_cfg;
+	int                         rc;
+
+	M0_PRE(index > 0);
+
+	stob_id.si_fid.f_key += index;
+	rc = m0_stob_find(&stob_id, &stob);
+	if (rc != 0)
+		return M0_ERR(rc);
+	if (m0_stob_state_get(stob) == CSS_UNKNOWN)
+		rc = m0_stob_locate(stob);
+	if (rc == 0 && ls->ls_create_mode) {
+		create_cfg = cfg->lsc_stripe_create_cfg == NULL ? NULL :
+			     cfg->lsc_stripe_create_cfg[index - 1];
+		rc = m0_stob_create(stob, NULL, create_cfg);
+		if (rc == 0 && !cfg->lsc_stob_dont_zero)
+			rc = be_log_store_zero(ls, stob, cfg->lsc_size);
+		rc = rc ?: be_log_store_header_write(ls, stob);
+	} else if (rc == 0 && m0_stob_state_get(stob) != CSS_EXISTS) {
+		rc = M0_ERR(-ENOENT);
+	}
+	if (rc == 0)
+		ls->ls_stobs[index] = stob;
+	else
+		m0_stob_put(stob);
+	return M0_RC_INFO(rc, "stob_id="STOB_ID_F, STOB_ID_P(&stob_id));
+}
+
+static void be_log_store_stripe_fini(struct m0_be_log_store *ls,
+				     unsigned                index)
+{
+	int rc;
+
+	M0_PRE(index > 0);
+
+	if (ls->ls_destroy_mode) {
+		rc = m0_stob_destroy(ls->ls_stobs[index], NULL);
+		M0_ASSERT_INFO(rc == 0, "rc = %d", rc); /* XXX */
+	} else {
+		m0_stob_put(ls->ls_stobs[index]);
+	}
+}
+
+static void be_log_store_stripes_fini(struct m0_be_log_store *ls)
+{
+	while (ls->ls_stripe_nr > 1)
+		be_log_store_stripe_fini(ls, --ls->ls_stripe_nr);
+	m0_free(ls->ls_stobs);
+}
+
+static int be_log_store_stripes_init(struct m0_be_log_store *ls)
+{
+	unsigned nr = ls->ls_header.fsh_stripe_nr;
+	int      rc = 0;
+
+	M0_ALLOC_ARR(ls->ls_stobs, nr);
+	if (ls->ls_stobs == NULL)
+		return M0_ERR(-ENOMEM);
+	ls->ls_stobs[0]  = ls->ls_stob;
+	ls->ls_stripe_nr = 1;
+	while (rc == 0 && ls->ls_stripe_nr < nr) {
+		rc = be_log_store_stripe_init(ls, ls->ls_stripe_nr);
+		if (rc == 0)
+			++ls->ls_stripe_nr;
+	}
+	if (rc != 0)
+		be_log_store_stripes_fini(ls);
+	return M0_RC(rc);
+}
+
 static int be_log_store_level_enter(struct m0_module *module)
 {
 	struct m0_be_fmt_log_store_header *header;
@@ -305,7 +418,8 @@ static int be_log_store_level_enter(struct m0_module *module)
 			M0_ASSERT(ergo(ls->ls_cfg.lsc_stob_create_cfg != NULL,
 				       !ls->ls_cfg.lsc_stob_dont_zero));
 			return ls->ls_cfg.lsc_stob_dont_zero ? 0 :
-			       be_log_store_zero(ls, ls->ls_cfg.lsc_size);
+			       be_log_store_zero(ls, ls->ls_stob,
+						 ls->ls_cfg.lsc_size);
 		}
 		return 0;
 	case M0_BE_LOG_STORE_LEVEL_LS_HEADER_INIT:
@@ -336,10 +450,15 @@ static int be_log_store_level_enter(struct m0_module *module)
 		header->fsh_cbuf_offset = header->fsh_rbuf_offset +
 					  header->fsh_rbuf_nr *
 					  header->fsh_rbuf_size_aligned;
-		header->fsh_cbuf_size = header->fsh_size -
-					header->fsh_cbuf_offset;
-		M0_ASSERT(be_log_store_header_validate(header, alignment));
-		return 0;
+		header->fsh_cbuf_base   = 0;
+		header->fsh_stripe_nr   = max_check(ls->ls_cfg.lsc_stripe_nr,
+						    1U);
+		header->fsh_stripe_unit = header->fsh_stripe_nr == 1 ? 0 :
+					  ls->ls_cfg.lsc_stripe_unit;
+		header->fsh_cbuf_size = be_log_store_cbuf_size(header,
+							header->fsh_size);
+		return be_log_store_header_validate(header, alignment) ?
+		       0 : M0_ERR(-EINVAL);
 	case M0_BE_LOG_STORE_LEVEL_HEADER_ENCODE:
 		if (!ls->ls_create_mode)
 			return 0;
@@ -365,8 +484,12 @@ static int be_log_store_level_enter(struct m0_module *module)
 			header    = &ls->ls_header;
 			if (!be_log_store_header_validate(header, alignment))
 				rc = M0_ERR(-EINVAL);
+			/* nothing before the base is in the circular buffer */
+			ls->ls_offset_discarded = header->fsh_cbuf_base;
 		}
 		return rc;
+	case M0_BE_LOG_STORE_LEVEL_STRIPES:
+		return be_log_store_stripes_init(ls);
 	case M0_BE_LOG_STORE_LEVEL_RBUF_ARR_ALLOC:
 		M0_ALLOC_ARR(ls->ls_rbuf_write_lio, ls->ls_header.fsh_rbuf_nr);
 		M0_ALLOC_ARR(ls->ls_rbuf_write_op,  ls->ls_header.fsh_rbuf_nr);
@@ -436,6 +559,9 @@ static void be_log_store_level_leave(struct m0_module *module)
 	case M0_BE_LOG_STORE_LEVEL_HEADER_IO:
 	case M0_BE_LOG_STORE_LEVEL_HEADER_DECODE:
 		break;
+	case M0_BE_LOG_STORE_LEVEL_STRIPES:
+		be_log_store_stripes_fini(ls);
+		break;
 	case M0_BE_LOG_STORE_LEVEL_RBUF_ARR_ALLOC:
 		be_log_store_rbuf_arr_free(ls);
 		break;
@@ -510,6 +636,11 @@ static const struct m0_modlev be_log_store_levels[] = {
 		.ml_enter = be_log_store_level_enter,
 		.ml_leave = be_log_store_level_leave,
 	},
+	[M0_BE_LOG_STORE_LEVEL_STRIPES] = {
+		.ml_name  = "M0_BE_LOG_STORE_LEVEL_STRIPES",
+		.ml_enter = be_log_store_level_enter,
+		.ml_leave = be_log_store_level_leave,
+	},
 	[M0_BE_LOG_STORE_LEVEL_RBUF_ARR_ALLOC] = {
 		.ml_name  = "M0_BE_LOG_STORE_LEVEL_RBUF_ARR_ALLOC",
 		.ml_enter = be_log_store_level_enter,
@@ -598,10 +729,22 @@ M0_INTERNAL m0_bcount_t m0_be_log_store_buf_size(struct m0_be_log_store *ls)
 	return ls->ls_header.fsh_cbuf_size;
 }
 
+/*
+ * Striped I/O is split at every stripe unit boundary. accum->bic_reg_size is
+ * used as the I/O size if it's already there.
+ */
 M0_INTERNAL void m0_be_log_store_io_credit(struct m0_be_log_store *ls,
 					   struct m0_be_io_credit *accum)
 {
-	m0_be_io_credit_add(accum, &M0_BE_IO_CREDIT(1, 0, 1));
+	m0_bcount_t size;
+	m0_bcount_t nr = 1;
+
+	if (ls->ls_stripe_nr > 1) {
+		size = accum->bic_reg_size != 0 ? accum->bic_reg_size :
+		       ls->ls_header.fsh_cbuf_size;
+		nr   = size / ls->ls_header.fsh_stripe_unit + 2;
+	}
+	m0_be_io_credit_add(accum, &M0_BE_IO_CREDIT(nr, 0, nr));
 }
 
 M0_INTERNAL int m0_be_log_store_io_window(struct m0_be_log_store *ls,
@@ -630,18 +773,70 @@ M0_INTERNAL void m0_be_log_store_io_discard(struct m0_be_log_store *ls,
 static m0_bindex_t be_log_store_phys_addr(struct m0_be_log_store *ls,
 					  m0_bindex_t             position)
 {
+	M0_PRE(position >= ls->ls_header.fsh_cbuf_base);
 	return ls->ls_header.fsh_cbuf_offset +
-	       position % ls->ls_header.fsh_cbuf_size;
+	       (position - ls->ls_header.fsh_cbuf_base) %
+	       ls->ls_header.fsh_cbuf_size;
+}
+
+/*
+ * The I/O is re-added piece by piece, every piece is inside one stripe unit.
+ * Stripe unit u of the circular buffer is located on the stripe u % nr at
+ * offset (u / nr) * unit within the circular buffer area of the stripe.
+ */
+static void be_log_store_io_translate_striped(struct m0_be_log_store *ls,
+					      m0_bindex_t             position,
+					      struct m0_be_io        *bio)
+{
+	struct m0_be_fmt_log_store_header *header = &ls->ls_header;
+	m0_bcount_t                        unit = header->fsh_stripe_unit;
+	m0_bcount_t                        size;
+	m0_bcount_t                        piece;
+	m0_bindex_t                        offset;
+	m0_bindex_t                        su;
+	char                              *ptr;
+	bool                               sync;
+
+	/* log I/O is a single buffer, see m0_be_log_record_io_prepare() */
+	M0_PRE(bio->bio_stob_nr == 1 && bio->bio_vec_pos == 1 &&
+	       bio->bio_part[0].bip_stob == NULL);
+
+	ptr  = bio->bio_bv_user.ov_buf[0];
+	size = bio->bio_bv_user.ov_vec.v_count[0];
+	sync = m0_be_io_sync_is_enabled(bio);
+	m0_be_io_reset(bio);
+	if (sync)
+		m0_be_io_sync_enable(bio);
+	while (size > 0) {
+		offset = be_log_store_phys_addr(ls, position) -
+			 header->fsh_cbuf_offset;
+		su     = offset / unit;
+		piece  = min64u(size, unit - offset % unit);
+		m0_be_io_add(bio, ls->ls_stobs[su % ls->ls_stripe_nr], ptr,
+			     header->fsh_cbuf_offset +
+			     su / ls->ls_stripe_nr * unit + offset % unit,
+			     piece);
+		ptr      += piece;
+		position += piece;
+		size     -= piece;
+	}
+	m0_be_io_vec_pack(bio);
+	m0_be_io_sort(bio);
 }
 
 M0_INTERNAL void m0_be_log_store_io_translate(struct m0_be_log_store *ls,
 					      m0_bindex_t             position,
 					      struct m0_be_io        *bio)
 {
-	m0_bcount_t size = m0_be_io_size(bio);
-	m0_bindex_t phys = be_log_store_phys_addr(ls, position);
+	m0_bcount_t size;
+	m0_bindex_t phys;
 
-	/* @note We support I/O to a single stob only. */
+	if (ls->ls_stripe_nr > 1) {
+		be_log_store_io_translate_striped(ls, position, bio);
+		return;
+	}
+	size = m0_be_io_size(bio);
+	phys = be_log_store_phys_addr(ls, position);
 	m0_be_io_stob_assign(bio, ls->ls_stob, 0, size);
 	m0_be_io_stob_move(bio, ls->ls_stob, phys,
 			   ls->ls_header.fsh_cbuf_offset,
@@ -742,8 +937,8 @@ m0_be_log_store_rbuf_io_reset(struct m0_be_log_store       *ls,
 		}
 		m0_be_log_io_reset(lio);
 		bio = m0_be_log_io_be_io(lio);
-		m0_be_io_add(bio, ls->ls_stob, buf->b_addr,
-			     offset + size * i, size);
+		m0_be_io_add(bio, ls->ls_stobs[i % ls->ls_stripe_nr],
+			     buf->b_addr, offset + size * i, size);
 		m0_be_io_configure(bio, opcode);
 		m0_be_op_reset(op);
 	}
@@ -756,6 +951,9 @@ M0_INTERNAL bool m0_be_log_store_overwrites(struct m0_be_log_store *ls,
 {
 	m0_bindex_t end;
 
+	/* nothing before fsh_cbuf_base is in the circular buffer */
+	if (position < ls->ls_header.fsh_cbuf_base)
+		return false;
 	end      = be_log_store_phys_addr(ls, index + size);
 	index    = be_log_store_phys_addr(ls, index);
 	position = be_log_store_phys_addr(ls, position);
@@ -768,7 +966,60 @@ M0_INTERNAL bool
 m0_be_log_store_contains_stob(struct m0_be_log_store  *ls,
                               const struct m0_stob_id *stob_id)
 {
-	return m0_stob_id_eq(stob_id, m0_stob_id_get(ls->ls_stob));
+	return m0_exists(i, ls->ls_stripe_nr,
+			 m0_stob_id_eq(stob_id,
+				       m0_stob_id_get(ls->ls_stobs[i])));
+}
+
+M0_INTERNAL int m0_be_log_store_resize_check(struct m0_be_log_store *ls,
+					     m0_bcount_t             size,
+					     m0_bcount_t            *buf_size)
+{
+	struct m0_be_fmt_log_store_header header = ls->ls_header;
+	uint64_t alignment = 1ULL << m0_be_log_store_bshift(ls);
+
+	header.fsh_size      = size;
+	header.fsh_cbuf_size = be_log_store_cbuf_size(&header, size);
+	if (!be_log_store_header_validate(&header, alignment))
+		return M0_ERR_INFO(-EINVAL, "size=%"PRIu64, size);
+	if (buf_size != NULL)
+		*buf_size = header.fsh_cbuf_size;
+	return 0;
+}
+
+M0_INTERNAL int m0_be_log_store_resize(struct m0_be_log_store *ls,
+				       m0_bcount_t             size,
+				       m0_bindex_t             position)
+{
+	struct m0_be_fmt_log_store_header header = ls->ls_header;
+	m0_bcount_t                       buf_size;
+	unsigned                          i;
+	int                               rc;
+
+	M0_ENTRY("ls=%p size=%"PRIu64" position=%"PRIu64, ls, size, position);
+	M0_PRE(position >= ls->ls_header.fsh_cbuf_base);
+
+	rc = m0_be_log_store_resize_check(ls, size, &buf_size);
+	if (rc != 0)
+		return M0_RC(rc);
+	ls->ls_header.fsh_size      = size;
+	ls->ls_header.fsh_cbuf_size = buf_size;
+	ls->ls_header.fsh_cbuf_base = position;
+	rc = m0_be_fmt_log_store_header_encode_buf(&ls->ls_header,
+						   &ls->ls_header_buf);
+	/*
+	 * Stripe 0 is written the last: its header is read during open and
+	 * the rest of stripes are not used until it's written.
+	 */
+	for (i = ls->ls_stripe_nr; rc == 0 && i > 0; --i)
+		rc = be_log_store_header_write(ls, ls->ls_stobs[i - 1]);
+	if (rc == 0) {
+		ls->ls_offset_discarded = max64u(ls->ls_offset_discarded,
+						 position);
+	} else {
+		ls->ls_header = header;
+	}
+	return M0_RC(rc);
 }
 
 /** @} end of be group */
@@ -63,7 +63,16 @@ struct m0_stob;
  *   storage I/O.
  *
  * Highlights
- * - log store uses stobs as a backing store.
+ * - log store uses stobs as a backing store;
+ * - backing store may consist of several stobs (stripes). Circular buffer is
+ *   split into fsh_stripe_unit-sized pieces which are distributed round-robin
+ *   between the stripes, so consecutive log records go to different stobs.
+ *   Every stripe has the same layout and a copy of log store header.
+ *   Redundant buffers are distributed between the stripes too;
+ * - circular buffer may be resized with m0_be_log_store_resize() while the
+ *   log is open. Positions starting from fsh_cbuf_base are mapped to the new
+ *   circular buffer, the user guarantees that everything before it is
+ *   discarded.
  *
  * Log store hides such knowledge as number of stobs, fragmentation, redundant
  * buffers and their positions.
@@ -95,11 +104,8 @@ struct m0_stob;
  *
  * Limitations
  * - infinite persistent storage is actually limited by M0_BINDEX_MAX, so
- *   interface provides I/O for range [0, M0_BINDEX_MAX];
- * - current implementation uses one stob as a backing storage.
- *
- * Future directions
- * - interface for log store expand/shrink.
+ *   interface provides I/O for range [fsh_cbuf_base, M0_BINDEX_MAX];
+ * - number of stripes can't be changed after m0_be_log_store_create().
  *
  */
 
@@ -116,6 +122,7 @@ enum {
 	M0_BE_LOG_STORE_LEVEL_HEADER_ENCODE,
 	M0_BE_LOG_STORE_LEVEL_HEADER_IO,
 	M0_BE_LOG_STORE_LEVEL_HEADER_DECODE,
+	M0_BE_LOG_STORE_LEVEL_STRIPES,
 	M0_BE_LOG_STORE_LEVEL_RBUF_ARR_ALLOC,
 	M0_BE_LOG_STORE_LEVEL_RBUF_INIT,
 	M0_BE_LOG_STORE_LEVEL_RBUF_ASSIGN,
@@ -167,7 +174,7 @@ struct m0_be_log_store_cfg {
 	 */
 	const char       *lsc_stob_domain_create_cfg;
 
-	/** Total size of backing stob. */
+	/** Total size of backing stob (of every stripe stob). */
 	m0_bcount_t       lsc_size;
 	/** m0_stob_create() 3rd parameter for the backing store stob. */
 	const char       *lsc_stob_create_cfg;
@@ -180,6 +187,20 @@ struct m0_be_log_store_cfg {
 	unsigned          lsc_rbuf_nr;
 	/** Size of redundant buffer. */
 	m0_bcount_t       lsc_rbuf_size;
+	/**
+	 * Number of stripe stobs. 0 is the same as 1: lsc_stob_id is the only
+	 * backing store stob. Stripe i has the same stob id with key
+	 * increased by i.
+	 */
+	unsigned          lsc_stripe_nr;
+	/** Stripe unit, must be aligned to the stob block size. */
+	m0_bcount_t       lsc_stripe_unit;
+	/**
+	 * m0_stob_create() 3rd parameter for the stripe stobs, element i - 1
+	 * is used for stripe i (stripe 0 uses lsc_stob_create_cfg).
+	 * May be NULL.
+	 */
+	const char      **lsc_stripe_create_cfg;
 };
 
 struct m0_be_log_store {
@@ -190,6 +211,12 @@ struct m0_be_log_store {
 	struct m0_module                  ls_module;
 
 	struct m0_stob                   *ls_stob;
+	/**
+	 * Stripe stobs, ls_stobs[0] == ls_stob.
+	 * Array size is m0_be_log_store::ls_stripe_nr.
+	 */
+	struct m0_stob                  **ls_stobs;
+	unsigned                          ls_stripe_nr;
 	/*
 	 * Temporary solution.
 	 * @see m0_be_log_store_cfg::lsc_stob_domain_location
@@ -270,6 +297,23 @@ M0_INTERNAL void m0_be_log_store_io_discard(struct m0_be_log_store *ls,
 					    m0_bindex_t		    offset,
 					    struct m0_be_op	   *op);
 
+/**
+ * Resizes the circular buffer. @size has the same meaning as
+ * m0_be_log_store_cfg::lsc_size. Positions starting from @position are
+ * translated to the new circular buffer starting from its beginning.
+ * Log store header is written synchronously to every stripe.
+ *
+ * @pre the user doesn't need anything before @position and there is no
+ *      I/O in progress.
+ */
+M0_INTERNAL int m0_be_log_store_resize(struct m0_be_log_store *ls,
+				       m0_bcount_t             size,
+				       m0_bindex_t             position);
+/** Returns circular buffer size after m0_be_log_store_resize(ls, size). */
+M0_INTERNAL int m0_be_log_store_resize_check(struct m0_be_log_store *ls,
+					     m0_bcount_t             size,
+					     m0_bcount_t            *buf_size);
+
 M0_INTERNAL bool m0_be_log_store_overwrites(struct m0_be_log_store *ls,
 					    m0_bindex_t             index,
 					    m0_bcount_t             size,
@@ -30,6 +30,7 @@
 #include "lib/errno.h"        /* ENOMEM */
 #include "lib/time.h"         /* m0_time_now */
 #include "lib/atomic.h"       /* m0_atomic64 */
+#include "lib/arith.h"        /* m0_align */
 
 #include "motr/version.h"     /* m0_build_info_get */
 
@@ -37,8 +38,14 @@
 
 #include "be/seg_internal.h"  /* m0_be_seg_hdr */
 #include "be/io.h"            /* m0_be_io */
+#include "be/addb2.h"         /* M0_AVI_BE_SEG_RESIDENT */
+#include "addb2/addb2.h"      /* M0_ADDB2_ADD */
 
 #include <sys/mman.h>         /* mmap */
+#include <limits.h>           /* CHAR_BIT */
+#include <sys/syscall.h>      /* SYS_mbind */
+#include <unistd.h>           /* syscall */
+#include <linux/mempolicy.h>  /* MPOL_INTERLEAVE */
 #include <search.h>           /* twalk */
 
 /**
@@ -321,13 +328,100 @@ static void be_seg_madvise(struct m0_be_seg *seg, m0_bcount_t dump_limit,
 
 }
 
+static m0_bcount_t be_seg_map_size(const struct m0_be_seg_map_cfg *cfg,
+				   m0_bcount_t                     size)
+{
+	return cfg->bsmc_pages == M0_BE_SEG_MAP_PAGES_HUGETLB ?
+	       m0_align(size, M0_BE_SEG_HUGE_PAGE_SIZE) : size;
+}
+
+/**
+ * Applies NUMA policy of the segment configuration to the mapping.
+ *
+ * Failures are not fatal: the policy only affects performance. Note that for
+ * M0_BE_SEG_MAP_PAGES_FILE the policy applies to the pages modified in the
+ * segment but not to the page cache pages.
+ */
+static void be_seg_mbind(const struct m0_be_seg_map_cfg *cfg,
+			 void *addr, m0_bcount_t size)
+{
+	unsigned long nodes = cfg->bsmc_numa_nodes;
+	unsigned long maxnode = sizeof(nodes) * CHAR_BIT + 1;
+	int           mode;
+	long          rc = 0;
+
+	if (cfg->bsmc_numa == M0_BE_SEG_MAP_NUMA_DEFAULT)
+		return;
+	mode = cfg->bsmc_numa == M0_BE_SEG_MAP_NUMA_INTERLEAVE ?
+	       MPOL_INTERLEAVE : MPOL_BIND;
+	if (nodes == 0)
+		rc = syscall(SYS_get_mempolicy, NULL, &nodes, maxnode,
+			     NULL, MPOL_F_MEMS_ALLOWED);
+	if (rc == 0)
+		rc = syscall(SYS_mbind, addr, size, mode, &nodes, maxnode, 0);
+	if (rc == 0)
+		M0_LOG(M0_INFO, "mbind(%p, %"PRIu64", %d, %lx)",
+		       addr, size, mode, nodes);
+	else
+		M0_LOG(M0_WARN, "mbind(%p, %"PRIu64", %d, %lx) failed: %d",
+		       addr, size, mode, nodes, -errno);
+}
+
+/**
+ * Maps the segment described by @g at its address.
+ *
+ * Anonymous mappings (huge pages) are filled with the segment contents here,
+ * after the NUMA policy is set, so pages are allocated according to it.
+ */
+static int be_seg_map(struct m0_be_seg *seg, const struct m0_be_seg_geom *g)
+{
+	const struct m0_be_seg_map_cfg *cfg  = &seg->bs_map_cfg;
+	bool                            anon;
+	m0_bcount_t                     size = be_seg_map_size(cfg, g->sg_size);
+	m0_bcount_t                     done;
+	m0_bcount_t                     len;
+	void                           *p;
+	int                             flags;
+	int                             fd;
+	int                             rc = 0;
+
+	anon  = cfg->bsmc_pages != M0_BE_SEG_MAP_PAGES_FILE;
+	fd    = anon ? -1 : m0_stob_fd(seg->bs_stob);
+	flags = MAP_FIXED | MAP_PRIVATE | MAP_NORESERVE;
+	if (anon)
+		flags |= MAP_ANONYMOUS;
+	if (cfg->bsmc_pages == M0_BE_SEG_MAP_PAGES_HUGETLB) {
+		if (!m0_is_aligned((uint64_t)g->sg_addr,
+				   M0_BE_SEG_HUGE_PAGE_SIZE))
+			return M0_ERR_INFO(-EINVAL, "sg_addr=%p", g->sg_addr);
+		flags |= MAP_HUGETLB;
+	}
+	p = mmap(g->sg_addr, size, PROT_READ | PROT_WRITE, flags,
+		 fd, anon ? 0 : g->sg_offset);
+	if (p != g->sg_addr)
+		return M0_ERR_INFO(-errno, "p=%p g->sg_addr=%p fd=%d flags=%x",
+				   p, g->sg_addr, fd, flags);
+	be_seg_mbind(cfg, p, size);
+	if (cfg->bsmc_pages == M0_BE_SEG_MAP_PAGES_THP &&
+	    madvise(p, size, MADV_HUGEPAGE) != 0)
+		M0_LOG(M0_WARN, "madvise(%p, %"PRIu64", MADV_HUGEPAGE) = %d",
+		       p, size, -errno);
+	for (done = 0; anon && rc == 0 && done < g->sg_size; done += len) {
+		len = min_check(g->sg_size - done,
+				(m0_bcount_t)M0_BE_SEG_READ_SIZE_MAX);
+		rc = m0_be_io_single(seg->bs_stob, SIO_READ, p + done,
+				     g->sg_offset + done, len);
+	}
+	if (rc != 0)
+		munmap(p, size);
+	return M0_RC(rc);
+}
+
 M0_INTERNAL int m0_be_seg_open(struct m0_be_seg *seg)
 {
 	const struct m0_be_seg_geom *g;
 	struct m0_be_seg_hdr        *hdr;
 	const char                  *runtime_be_version;
-	void                        *p;
-	int                          fd;
 	int                          rc;
 
 	M0_ENTRY("seg=%p", seg);
@@ -361,15 +455,11 @@ M0_INTERNAL int m0_be_seg_open(struct m0_be_seg *seg)
 		return M0_ERR(-ENOENT);
 	}
 
-	fd = m0_stob_fd(seg->bs_stob);
-	p = mmap(g->sg_addr, g->sg_size, PROT_READ | PROT_WRITE,
-		 MAP_FIXED | MAP_PRIVATE | MAP_NORESERVE, fd, g->sg_offset);
-	if (p != g->sg_addr) {
-		rc = M0_ERR_INFO(-errno, "p=%p g->sg_addr=%p fd=%d",
-				 p, g->sg_addr, fd);
+	rc = be_seg_map(seg, g);
+	if (rc != 0) {
 		/* `g' is a part of `hdr'. Don't print it after free. */
 		m0_free(hdr);
-		return rc;
+		return M0_ERR(rc);
 	}
 
 	/* rc = be_seg_read_all(seg, &hdr); */
@@ -380,11 +470,15 @@ M0_INTERNAL int m0_be_seg_open(struct m0_be_seg *seg)
 		seg->bs_addr     = g->sg_addr;
 		seg->bs_offset   = g->sg_offset;
 		seg->bs_gen	 = g->sg_gen;
+		seg->bs_resident     = 0;
+		seg->bs_resident_acc = 0;
+		seg->bs_resident_pos = 0;
 		seg->bs_state    = M0_BSS_OPENED;
 		be_seg_madvise(seg, M0_BE_SEG_CORE_DUMP_LIMIT, MADV_DONTDUMP);
 		be_seg_madvise(seg,                      0ULL, MADV_DONTFORK);
 	} else {
-		munmap(g->sg_addr, g->sg_size);
+		munmap(g->sg_addr, be_seg_map_size(&seg->bs_map_cfg,
+						   g->sg_size));
 	}
 
 	m0_free(hdr);
@@ -396,11 +490,149 @@ M0_INTERNAL void m0_be_seg_close(struct m0_be_seg *seg)
 	M0_ENTRY("seg=%p", seg);
 	M0_PRE(seg->bs_state == M0_BSS_OPENED);
 
-	munmap(seg->bs_addr, seg->bs_size);
+	munmap(seg->bs_addr, be_seg_map_size(&seg->bs_map_cfg, seg->bs_size));
 	seg->bs_state = M0_BSS_CLOSED;
 	M0_LEAVE();
 }
 
+/**
+ * Trims [*addr, *addr + *size) to the pages which are completely inside it.
+ *
+ * Returns false if there are no such pages.
+ */
+static bool be_seg_pages_trim(void **addr, m0_bcount_t *size)
+{
+	uint64_t start = m0_align((uint64_t)*addr, M0_BE_SEG_PAGE_SIZE);
+	uint64_t end   = ((uint64_t)*addr + *size) &
+			 ~(M0_BE_SEG_PAGE_SIZE - 1);
+
+	if (start >= end)
+		return false;
+	*addr = (void *)start;
+	*size = end - start;
+	return true;
+}
+
+M0_INTERNAL int m0_be_seg_advise(struct m0_be_seg *seg, void *addr,
+				 m0_bcount_t size, enum m0_be_seg_advice advice)
+{
+	int flag;
+
+	M0_PRE(m0_be_seg_contains(seg, addr));
+	M0_PRE(m0_be_seg_contains(seg, addr + size - 1));
+
+	switch (advice) {
+	case M0_BE_SEG_ADV_WILLNEED:
+		flag = MADV_WILLNEED;
+		break;
+#ifdef MADV_COLD
+	case M0_BE_SEG_ADV_COLD:
+		flag = MADV_COLD;
+		break;
+#endif
+#ifdef MADV_PAGEOUT
+	case M0_BE_SEG_ADV_PAGEOUT:
+		flag = MADV_PAGEOUT;
+		break;
+#endif
+	default:
+		return -ENOSYS;
+	}
+	if (advice == M0_BE_SEG_ADV_WILLNEED) {
+		/* Reading the partial pages in does no harm. */
+		size += (uint64_t)addr & (M0_BE_SEG_PAGE_SIZE - 1);
+		addr  = (void *)((uint64_t)addr & ~(M0_BE_SEG_PAGE_SIZE - 1));
+		size  = m0_align(size, M0_BE_SEG_PAGE_SIZE);
+	} else if (!be_seg_pages_trim(&addr, &size))
+		return 0;
+	return madvise(addr, size, flag) == 0 ? 0 : -errno;
+}
+
+M0_INTERNAL int m0_be_seg_pages_drop(struct m0_be_seg *seg, void *addr,
+				     m0_bcount_t size)
+{
+	void *p;
+
+	M0_PRE(m0_be_seg_contains(seg, addr));
+	M0_PRE(m0_be_seg_contains(seg, addr + size - 1));
+
+	if (!be_seg_pages_trim(&addr, &size))
+		return 0;
+	switch (seg->bs_map_cfg.bsmc_pages) {
+	case M0_BE_SEG_MAP_PAGES_FILE:
+		/*
+		 * Pages of a private file mapping are read from the file
+		 * after MADV_DONTNEED. Unlike munmap() and mmap() it keeps the
+		 * range mapped, so there is no window in which an access to
+		 * the range faults.
+		 */
+		if (madvise(addr, size, MADV_DONTNEED) != 0)
+			return M0_ERR_INFO(-errno, "addr=%p size=%"PRIu64,
+					   addr, size);
+		return 0;
+	case M0_BE_SEG_MAP_PAGES_THP:
+		/* MAP_FIXED atomically replaces the anonymous pages. */
+		p = mmap(addr, size, PROT_READ | PROT_WRITE,
+			 MAP_FIXED | MAP_PRIVATE | MAP_NORESERVE,
+			 m0_stob_fd(seg->bs_stob), m0_be_seg_offset(seg, addr));
+		if (p == MAP_FAILED)
+			return M0_ERR_INFO(-errno, "addr=%p size=%"PRIu64,
+					   addr, size);
+		return 0;
+	default:
+		/* Huge pages can only be replaced as a whole. */
+		return M0_ERR(-ENOTSUP);
+	}
+}
+
+M0_INTERNAL int m0_be_seg_resident(struct m0_be_seg *seg, void *addr,
+				   m0_bcount_t size, m0_bcount_t *resident)
+{
+	enum { VEC_NR = 4096 };
+	unsigned char vec[VEC_NR];
+	m0_bcount_t   len;
+	m0_bcount_t   i;
+
+	M0_PRE(m0_be_seg_contains(seg, addr));
+	M0_PRE(m0_be_seg_contains(seg, addr + size - 1));
+
+	*resident = 0;
+	if (!be_seg_pages_trim(&addr, &size))
+		return 0;
+	for (; size > 0; addr += len, size -= len) {
+		len = min_check(size, (m0_bcount_t)VEC_NR *
+				M0_BE_SEG_PAGE_SIZE);
+		if (mincore(addr, len, vec) != 0)
+			return M0_ERR_INFO(-errno, "addr=%p len=%"PRIu64,
+					   addr, len);
+		for (i = 0; i < len / M0_BE_SEG_PAGE_SIZE; ++i)
+			*resident += (vec[i] & 1) * M0_BE_SEG_PAGE_SIZE;
+	}
+	return 0;
+}
+
+M0_INTERNAL void m0_be_seg_residency_scan(struct m0_be_seg *seg)
+{
+	m0_bcount_t len;
+	m0_bcount_t resident;
+
+	M0_PRE(seg->bs_state == M0_BSS_OPENED);
+
+	len = min_check(seg->bs_size - seg->bs_resident_pos,
+			(m0_bcount_t)M0_BE_SEG_RESIDENCY_SCAN_SIZE);
+	if (m0_be_seg_resident(seg, seg->bs_addr + seg->bs_resident_pos, len,
+			       &resident) == 0)
+		seg->bs_resident_acc += resident;
+	seg->bs_resident_pos += len;
+	if (seg->bs_resident_pos == seg->bs_size) {
+		seg->bs_resident     = seg->bs_resident_acc;
+		seg->bs_resident_acc = 0;
+		seg->bs_resident_pos = 0;
+		M0_ADDB2_ADD(M0_AVI_BE_SEG_RESIDENT, seg->bs_id,
+			     seg->bs_resident, seg->bs_size);
+	}
+}
+
 M0_INTERNAL bool m0_be_seg_contains(const struct m0_be_seg *seg,
 				    const void *addr)
 {
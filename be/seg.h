@@ -58,6 +58,63 @@ enum {
 	M0_BE_SEG_FAKE_ID = ~0,
 	/** Segments' addr, size, offset has to be aligned by this boundary */
 	M0_BE_SEG_PAGE_SIZE = 1ULL << 12,
+	/** Huge page size for M0_BE_SEG_MAP_PAGES_HUGETLB. */
+	M0_BE_SEG_HUGE_PAGE_SIZE = 1ULL << 21,
+	/** Part of the segment checked by one m0_be_seg_residency_scan(). */
+	M0_BE_SEG_RESIDENCY_SCAN_SIZE = 1ULL << 30,
+};
+
+/** Access hints for a segment range, see m0_be_seg_advise(). */
+enum m0_be_seg_advice {
+	/** The range will be accessed soon (MADV_WILLNEED). */
+	M0_BE_SEG_ADV_WILLNEED,
+	/** The range is unlikely to be accessed soon (MADV_COLD). */
+	M0_BE_SEG_ADV_COLD,
+	/** The range should be reclaimed now (MADV_PAGEOUT). */
+	M0_BE_SEG_ADV_PAGEOUT,
+};
+
+/** Kind of pages backing the segment memory. */
+enum m0_be_seg_map_pages {
+	/** Private mapping of the segment stob, pages are read on access. */
+	M0_BE_SEG_MAP_PAGES_FILE,
+	/**
+	 * Anonymous mapping with transparent huge pages (MADV_HUGEPAGE). The
+	 * segment is read to memory in m0_be_seg_open().
+	 */
+	M0_BE_SEG_MAP_PAGES_THP,
+	/**
+	 * Anonymous mapping backed by hugetlbfs pages (MAP_HUGETLB). The
+	 * segment is read to memory in m0_be_seg_open(). Segment address has
+	 * to be aligned to M0_BE_SEG_HUGE_PAGE_SIZE and enough huge pages have
+	 * to be reserved in the system.
+	 */
+	M0_BE_SEG_MAP_PAGES_HUGETLB,
+};
+
+/** NUMA memory policy for the segment memory, see mbind(2). */
+enum m0_be_seg_map_numa {
+	/** Policy of the thread which touches the page first. */
+	M0_BE_SEG_MAP_NUMA_DEFAULT,
+	/** Pages are interleaved over the nodes (MPOL_INTERLEAVE). */
+	M0_BE_SEG_MAP_NUMA_INTERLEAVE,
+	/** Pages are allocated on the nodes only (MPOL_BIND). */
+	M0_BE_SEG_MAP_NUMA_BIND,
+};
+
+/**
+ * How the segment is mapped to memory in m0_be_seg_open().
+ *
+ * It is not stored in the segment and may differ between runs.
+ */
+struct m0_be_seg_map_cfg {
+	enum m0_be_seg_map_pages bsmc_pages;
+	enum m0_be_seg_map_numa  bsmc_numa;
+	/**
+	 * Bitmask of the NUMA nodes for bsmc_numa. 0 means all the nodes the
+	 * process is allowed to use.
+	 */
+	uint64_t                 bsmc_numa_nodes;
 };
 
 #define M0_BE_SEG_PG_PRESENT       0x8000000000000000ULL
@@ -80,6 +137,20 @@ struct m0_be_seg {
 	 */
 	struct m0_be_allocator bs_allocator;
 	struct m0_be_domain   *bs_domain;
+	/**
+	 * Memory mapping configuration. It is used by m0_be_seg_open() and
+	 * may be changed while the segment is not opened.
+	 */
+	struct m0_be_seg_map_cfg bs_map_cfg;
+	/**
+	 * Resident size of the segment memory, as found by the last complete
+	 * pass of m0_be_seg_residency_scan().
+	 */
+	m0_bcount_t            bs_resident;
+	/** Resident size found by the current pass so far. */
+	m0_bcount_t            bs_resident_acc;
+	/** Offset in the segment of the current pass. */
+	m0_bcount_t            bs_resident_pos;
 	int                    bs_state;
 	uint64_t               bs_magic;
 	struct m0_tlink        bs_linkage;
@@ -135,6 +206,41 @@ M0_INTERNAL bool m0_be_seg_contains(const struct m0_be_seg *seg,
 M0_INTERNAL m0_bindex_t m0_be_seg_offset(const struct m0_be_seg *seg,
 					 const void *addr);
 
+/**
+ * Gives a hint about the future use of the segment memory in [addr, addr +
+ * size). Pages partially outside of the range are only affected by
+ * M0_BE_SEG_ADV_WILLNEED.
+ *
+ * Returns -ENOSYS if the hint is not supported by the system. Hints are only
+ * about performance, the caller may ignore failures.
+ */
+M0_INTERNAL int m0_be_seg_advise(struct m0_be_seg *seg, void *addr,
+				 m0_bcount_t size, enum m0_be_seg_advice advice);
+
+/**
+ * Drops the segment memory in [addr, addr + size), the pages are read from the
+ * segment stob again on the next access. Pages partially outside of the range
+ * are not dropped.
+ *
+ * The range must not have changes which are not placed to the stob yet.
+ * Concurrent accesses to the range are allowed while the memory is dropped.
+ */
+M0_INTERNAL int m0_be_seg_pages_drop(struct m0_be_seg *seg, void *addr,
+				     m0_bcount_t size);
+
+/** Returns the resident size of the segment memory in [addr, addr + size). */
+M0_INTERNAL int m0_be_seg_resident(struct m0_be_seg *seg, void *addr,
+				   m0_bcount_t size, m0_bcount_t *resident);
+
+/**
+ * Checks residency of the next M0_BE_SEG_RESIDENCY_SCAN_SIZE bytes of the
+ * segment. When the whole segment is checked, updates m0_be_seg::bs_resident
+ * and posts it to addb2 (M0_AVI_BE_SEG_RESIDENT).
+ *
+ * The caller is responsible for serialisation of the calls for a segment.
+ */
+M0_INTERNAL void m0_be_seg_residency_scan(struct m0_be_seg *seg);
+
 /** XXX @todo s/bs_reserved/m0_be_seg_reserved/ everywhere */
 M0_INTERNAL m0_bcount_t m0_be_seg_reserved(const struct m0_be_seg *seg);
 M0_INTERNAL struct m0_be_allocator *m0_be_seg_allocator(struct m0_be_seg *seg);
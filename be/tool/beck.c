@@ -125,6 +125,12 @@ struct scanner {
 	uint64_t	     s_gen;
 	/* Set variable when correct generation identifier has been found */
 	bool	             s_gen_found;
+	/** The scanner stops at this offset (exclusive). */
+	off_t		     s_end;
+	/** Thread running scan() for this scanner in the parallel scan mode. */
+	struct m0_thread     s_scan_thread;
+	/** Result of scan() in the parallel scan mode. */
+	int		     s_result;
 };
 
 struct stats {
@@ -410,6 +416,8 @@ static off_t nv_scan_offset_get(off_t snapshot_size);
 static void  nv_scan_offset_update(void);
 
 static void scanner_thread(struct scanner *s);
+static int  scan_parallel(struct scanner *src, const char *spath,
+			  uint32_t nr);
 static const struct recops btreeops;
 static const struct recops bnodeops;
 static const struct recops seghdrops;
@@ -495,7 +503,9 @@ enum {
 	 * The value of 44MB for DEFAULT_BE_MAX_TX_REG_SZ was picked from the
 	 * routine m0_be_ut_backend_cfg_default()
 	 */
-	DEFAULT_BE_MAX_TX_REG_SZ = (44 * 1024 * 1024ULL)
+	DEFAULT_BE_MAX_TX_REG_SZ = (44 * 1024 * 1024ULL),
+	/** Maximum number of scanners in the parallel scan mode (-j). */
+	MAX_SCAN_WORKERS_NR      = 32,
 };
 
 /** It is used to recover meta data of component catalogue store. */
@@ -528,6 +538,11 @@ static bool  disable_directio = false;
 static bool  signaled = false;
 static bool  resume_scan = false;
 static bool  mmap_be_segment = false;
+/** Don't verify keys and values of btree nodes, see "-M" option. */
+static bool  meta_only = false;
+static uint32_t scan_workers_nr = 1;
+/** Protects record, btree and generation statistics. */
+static struct m0_mutex stats_lock;
 
 static const char *offset_file = NULL;
 
@@ -622,7 +637,12 @@ int main(int argc, char **argv)
 				beck_builder.b_dom_path = s;
 			})),
 		   M0_FLAGARG('m', "MMAP BE segment file. Useful for "
-			      "developer debugging.", &mmap_be_segment));
+			      "developer debugging.", &mmap_be_segment),
+		   M0_FORMATARG('j', "Number of threads scanning the snapshot "
+				"in parallel.", "%u", &scan_workers_nr),
+		   M0_FLAGARG('M', "Metadata only: check records and btree "
+			      "nodes, skip keys and values. Implies dry run.",
+			      &meta_only));
 	if (result != 0)
 		errx(EX_USAGE, "Wrong option: %d.", result);
 	if (ut) {
@@ -636,6 +656,15 @@ int main(int argc, char **argv)
 
 	if (mmap_be_segment)
 		dry_run = true; /* Force dry run mode when asked to mmap. */
+	if (meta_only)
+		dry_run = true; /* Nothing to build without keys and values. */
+	if (scan_workers_nr == 0 || scan_workers_nr > MAX_SCAN_WORKERS_NR)
+		errx(EX_USAGE, "Number of scan threads (-j) must be in "
+		     "[1, %d].", MAX_SCAN_WORKERS_NR);
+	if (scan_workers_nr > 1 && spath == NULL)
+		errx(EX_USAGE, "Parallel scan needs snapshot path (-s).");
+	if (scan_workers_nr > 1 && resume_scan)
+		errx(EX_USAGE, "Parallel scan can't be resumed (-R).");
 
 	if (dry_run)
 		printf("Running in read-only mode.\n");
@@ -667,6 +696,7 @@ int main(int argc, char **argv)
 		      err(EX_NOINPUT, "Cannot seek snapshot to the beginning.");
 		printf("Snapshot size: %" PRId64 ".\n", beck_scanner.s_size);
 	}
+	beck_scanner.s_end = beck_scanner.s_size;
 
 	if (beck_builder.b_be_config_file && !dry_run && !print_gen_id) {
 		fp = fopen(beck_builder.b_be_config_file, "r");
@@ -772,7 +802,10 @@ int main(int argc, char **argv)
 		printf("Press CTRL+C to quit.\n");
 		signal(SIGINT, sig_handler);
 	}
-	result = scan(&beck_scanner);
+	if (scan_workers_nr > 1)
+		result = scan_parallel(&beck_scanner, spath, scan_workers_nr);
+	else
+		result = scan(&beck_scanner);
 	printf("\n Pending to process bnodes=%"PRIu64 " It may take some time",
 	       beck_scanner.s_bnode_q.q_nr);
 	qput(&beck_scanner.s_bnode_q, scanner_action(sizeof(struct action),
@@ -818,6 +851,84 @@ static void scanner_thread(struct scanner *s)
 	} while (ba->bna_act.a_opc != AO_DONE);
 }
 
+static void scan_worker_thread(struct scanner *s)
+{
+	s->s_result = scan(s);
+}
+
+/**
+ * Splits the snapshot into @nr ranges and scans them in parallel. Every range
+ * has its own scanner with a separate file handle, bnode queue and bnode
+ * processing thread. Builder actions go to the same builder queue src->s_q.
+ *
+ * A record is processed by the scanner whose range contains the beginning of
+ * the record.
+ */
+static int scan_parallel(struct scanner *src, const char *spath, uint32_t nr)
+{
+	struct scanner *ws;
+	struct scanner *s;
+	off_t           range;
+	uint32_t        i;
+	int             result = 0;
+
+	M0_PRE(nr > 1);
+
+	M0_ALLOC_ARR(ws, nr);
+	if (ws == NULL)
+		return M0_ERR(-ENOMEM);
+	range = m0_align(src->s_end / nr + 1, sizeof(uint64_t));
+	for (i = 0; i < nr; ++i) {
+		s = &ws[i];
+		scanner_init(s);
+		s->s_byte               = src->s_byte;
+		s->s_print_invalid_oids = src->s_print_invalid_oids;
+		s->s_size               = src->s_size;
+		s->s_seg                = src->s_seg;
+		s->s_q                  = src->s_q;
+		s->s_max_reg_size       = src->s_max_reg_size;
+		s->s_gen                = src->s_gen;
+		s->s_gen_found          = src->s_gen_found;
+		s->s_off                = min64(range * i, src->s_end);
+		s->s_end                = i == nr - 1 ? src->s_end :
+					  min64(range * (i + 1), src->s_end);
+		/* the chunk cache is empty */
+		s->s_chunk_pos          = -(off_t)sizeof s->s_chunk;
+		s->s_file = fopen(spath, "r");
+		if (s->s_file == NULL)
+			err(EX_NOINPUT, "Cannot open snapshot \"%s\".", spath);
+		qinit(&s->s_bnode_q, MAX_SCAN_QUEUED / nr);
+		result = M0_THREAD_INIT(&s->s_thread, struct scanner *,
+					NULL, &scanner_thread, s,
+					"scanner%u", i);
+		if (result != 0)
+			err(EX_CONFIG, "Cannot start scanner thread.");
+		result = M0_THREAD_INIT(&s->s_scan_thread, struct scanner *,
+					NULL, &scan_worker_thread, s,
+					"scan%u", i);
+		if (result != 0)
+			err(EX_CONFIG, "Cannot start scan thread.");
+	}
+	for (i = 0; i < nr; ++i) {
+		s = &ws[i];
+		m0_thread_join(&s->s_scan_thread);
+		m0_thread_fini(&s->s_scan_thread);
+		result = result ?: s->s_result;
+	}
+	for (i = 0; i < nr; ++i) {
+		s = &ws[i];
+		qput(&s->s_bnode_q, scanner_action(sizeof(struct action),
+						   AO_DONE, NULL));
+		m0_thread_join(&s->s_thread);
+		m0_thread_fini(&s->s_thread);
+		qfini(&s->s_bnode_q);
+		fclose(s->s_file);
+		scanner_fini(s);
+	}
+	m0_free(ws);
+	return result;
+}
+
 static char iobuf[4*1024*1024];
 
 enum { DELTA = 60 };
@@ -969,6 +1080,8 @@ static int scan(struct scanner *s)
 	off_t    lastnvsaveoff;
 	uint64_t lastrecord = 0;
 	uint64_t lastdata = 0;
+
+	result = 0;
 	if (resume_scan && !dry_run) {
 		s->s_off = nv_scan_offset_get(s->s_size);
 		M0_LOG(M0_DEBUG, "Resuming Scan from Offset = %li", s->s_off);
@@ -977,8 +1090,10 @@ static int scan(struct scanner *s)
 	}
 	lastoff	      = s->s_off;
 	lastnvsaveoff = s->s_off;
+	/* iobuf is shared by all scanners, it's not used without buffering */
 	setvbuf(s->s_file, iobuf, _IONBF, sizeof iobuf);
-	while (!signaled && (result = get(s, &magic, sizeof magic)) == 0) {
+	while (!signaled && s->s_off < s->s_end &&
+	       (result = get(s, &magic, sizeof magic)) == 0) {
 		if (magic == M0_FORMAT_HEADER_MAGIC) {
 			s->s_off -= sizeof magic;
 			parse(s);
@@ -1007,7 +1122,7 @@ static int scan(struct scanner *s)
 		/** save scanner offset if scanner and bnode queue's
 		 * are empty and scanner has progressed by delta bytes
 		 */
-		if (!dry_run &&
+		if (!dry_run && s == &beck_scanner &&
 		    (s->s_off - lastnvsaveoff >
 		     NV_OFFSET_SAVE_DELTA_IN_BYTES) &&
 		    isqempty(&s->s_bnode_q) &&
@@ -1076,8 +1191,10 @@ static int parse(struct scanner *s)
 			r = &rt[M0_FORMAT_TYPE_NR];
 			RLOG(M0_INFO, "U", s, r, &tag);
 		}
+		m0_mutex_lock(&stats_lock);
 		r->r_stats.s_found++;
 		r->r_stats.s_align[!!(s->s_off & 07)]++;
+		m0_mutex_unlock(&stats_lock);
 		/* Only process btree, bnode and segment header records. */
 		if (M0_IN(idx, (M0_FORMAT_TYPE_BE_BTREE,
 				M0_FORMAT_TYPE_BE_BNODE,
@@ -1142,11 +1259,13 @@ static int init(void)
 		}
 		M0_ASSERT(j < e->xe_nr);
 	}
+	m0_mutex_init(&stats_lock);
 	return 0;
 }
 
 static void fini(void)
 {
+	m0_mutex_fini(&stats_lock);
 }
 
 static int recdo(struct scanner *s, const struct m0_format_tag *tag,
@@ -1179,7 +1298,9 @@ static int recdo(struct scanner *s, const struct m0_format_tag *tag,
 			if (result != 0) {
 				RLOG(M0_DEBUG, "С", s, r, tag);
 				FLOG(M0_DEBUG, result, s);
+				m0_mutex_lock(&stats_lock);
 				r->r_stats.s_chksum++;
+				m0_mutex_unlock(&stats_lock);
 			} else {
 				RLOG(M0_DEBUG, "R", s, r, tag);
 				if (r->r_ops != NULL &&
@@ -1189,7 +1310,9 @@ static int recdo(struct scanner *s, const struct m0_format_tag *tag,
 		} else {
 			RLOG(M0_DEBUG, "V", s, r, tag);
 			FLOG(M0_DEBUG, result, s);
+			m0_mutex_lock(&stats_lock);
 			r->r_stats.s_version++;
+			m0_mutex_unlock(&stats_lock);
 			if (r->r_ops != NULL && r->r_ops->ro_ver != NULL)
 				result = r->r_ops->ro_ver(s, r, buf);
 		}
@@ -1284,7 +1407,9 @@ static int btree(struct scanner *s, struct rectype *r, char *buf)
 		generation_id_print(s->s_gen);
 	}
 	b = &bt[idx];
+	m0_mutex_lock(&stats_lock);
 	b->b_stats.c_tree++;
+	m0_mutex_unlock(&stats_lock);
 	return 0;
 }
 
@@ -1333,18 +1458,20 @@ static int bnode(struct scanner *s, struct rectype *r, char *buf)
 	}
 	b = &bt[idx];
 	c = &b->b_stats;
-	c->c_node++;
-	if (b->b_proc != NULL) {
+	if (b->b_proc != NULL && !meta_only) {
 		ba = scanner_action(sizeof *ba, AO_INIT, NULL);
 		ba->bna_offset = s->s_start_off;
 		qput(&s->s_bnode_q, &ba->bna_act);
 	}
+	m0_mutex_lock(&stats_lock);
+	c->c_node++;
 	c->c_kv += node->bt_num_active_key;
 	if (node->bt_isleaf) {
 		c->c_leaf++;
 	} else
 		c->c_fanout += node->bt_num_active_key + 1;
 	c->c_maxlevel = max64(c->c_maxlevel, node->bt_level);
+	m0_mutex_unlock(&stats_lock);
 	return 0;
 }
 
@@ -1666,6 +1793,7 @@ static void genadd(uint64_t gen)
 {
 	int i;
 
+	m0_mutex_lock(&stats_lock);
 	for (i = 0; i < ARRAY_SIZE(g); ++i) {
 		if (g[i].g_gen == gen || g[i].g_count == 0) {
 			g[i].g_count++;
@@ -1673,6 +1801,7 @@ static void genadd(uint64_t gen)
 			break;
 		}
 	}
+	m0_mutex_unlock(&stats_lock);
 }
 
 static int nv_scan_offset_init(uint64_t workers_nr,
@@ -2221,6 +2350,7 @@ static void be_cfg_update(struct m0_be_domain_cfg *cfg,
 					M0_BE_TX_CREDIT(value1_64, value2_64);
 		}
 	} else if (m0_streq(str_key, "bpdc_seg_io_nr") ||
+		   m0_streq(str_key, "bisc_io_nr_max") ||
 		   m0_streq(str_key, "ldsc_items_max") ||
 		   m0_streq(str_key, "ldsc_items_threshold")) {
 
@@ -2234,6 +2364,9 @@ static void be_cfg_update(struct m0_be_domain_cfg *cfg,
 
 		if (m0_streq(str_key, "bpdc_seg_io_nr")) {
 			cfg->bc_pd_cfg.bpdc_seg_io_nr = value1_32;
+		} else if (m0_streq(str_key, "bisc_io_nr_max")) {
+			cfg->bc_log.lc_sched_cfg.lsch_io_sched_cfg.
+				bisc_io_nr_max = value1_32;
 		} else if (m0_streq(str_key, "ldsc_items_max")) {
 			cfg->bc_log_discard_cfg.ldsc_items_max = value1_32;
 		} else if (m0_streq(str_key, "ldsc_items_threshold")) {
@@ -2267,6 +2400,8 @@ static void be_cfg_update(struct m0_be_domain_cfg *cfg,
 		else if (m0_streq(str_key, "bec_group_freeze_timeout_limit"))
 			cfg->bc_engine.bec_group_freeze_timeout_limit =
 								value1_64;
+		else if (m0_streq(str_key, "bec_group_adaptive"))
+			cfg->bc_engine.bec_group_adaptive = value1_64 != 0;
 		else if (m0_streq(str_key, "lc_full_threshold"))
 			cfg->bc_log.lc_full_threshold = value1_64;
 		else if (m0_streq(str_key, "ldsc_sync_timeout"))
@@ -2436,7 +2571,9 @@ static bool btree_kv_post_is_valid(struct scanner *s,
 static void btree_bad_kv_count_update(uint64_t type, int count)
 {
 	M0_LOG(M0_DEBUG, "Discarded kv = %d from btree = %"PRIu64, count, type);
+	m0_mutex_lock(&stats_lock);
 	bt[type].b_stats.c_kv_bad += count;
+	m0_mutex_unlock(&stats_lock);
 }
 
 static bool fid_without_type_eq(const struct m0_fid *fid0,
@@ -2476,69 +2613,27 @@ static struct cache_slot *cache_insert(struct cache *c,
 	return slot;
 }
 
-static int ctg_get_callback(struct m0_btree_cb *cb, struct m0_btree_rec *rec)
-{
-	struct m0_btree_rec     *datum = cb->c_datum;
-
-	/** Only copy the Value for the caller. */
-	m0_bufvec_copy(&datum->r_val, &rec->r_val,
-		       m0_vec_count(&rec->r_val.ov_vec));
-	return 0;
-}
-
 /**
  * Get config root pool version fid from key and value which are generated by
  * mkfs. In EES, Layout is fixed with this pool fid.
  */
 static int ctg_pver_fid_get(struct m0_fid *fid)
 {
-	struct m0_buf        key;
-	struct m0_buf        val;
-	uint8_t              kdata[M0_CAS_CTG_KEY_HDR_SIZE +
-				   sizeof(struct m0_fid)];
-	uint8_t              vdata[M0_CAS_CTG_VAL_HDR_SIZE +
-				   sizeof(struct m0_dix_layout)];
+	struct m0_dix_layout layout;
+	struct m0_fid        cfid;
 	uint64_t             i;
 	int                  rc;
-	void                *k_ptr;
-	void                *v_ptr;
-	m0_bcount_t          ksize;
-	m0_bcount_t          vsize;
-	struct m0_btree      *btree    = m0_ctg_ctidx()->cc_tree;
-	struct m0_btree_op   kv_op     = {};
-	struct m0_btree_rec  rec       = {
-		.r_key.k_data = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize),
-		.r_val        = M0_BUFVEC_INIT_BUF(&v_ptr, &vsize),
-		};
-	struct m0_btree_cb   get_cb    = {
-		.c_act   = ctg_get_callback,
-		.c_datum = &rec,
-		};
-
-	*((uint64_t *)(kdata)) = sizeof(struct m0_fid);
-	key = M0_BUF_INIT(ARRAY_SIZE(kdata), kdata);
-	val = M0_BUF_INIT(ARRAY_SIZE(vdata), vdata);
 
 	M0_CASSERT(M0_DIX_FID_DEVICE_ID_BITS > 0);
 	for (i = 0; i < M0_DIX_FID_DEVICE_ID_BITS; i++) {
-		*((struct m0_fid *)(kdata + M0_CAS_CTG_KEY_HDR_SIZE)) =
-			M0_FID_TINIT('T', i << M0_DIX_FID_DEVICE_ID_OFFSET,
-				     0x02);
-		k_ptr = key.b_addr;
-		ksize = key.b_nob;
-		v_ptr = val.b_addr;
-		vsize = val.b_nob;
-
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					m0_btree_get(btree,
-						     &rec.r_key, &get_cb,
-						     BOF_EQUAL, &kv_op));
+		cfid = M0_FID_TINIT('T', i << M0_DIX_FID_DEVICE_ID_OFFSET,
+				    0x02);
+		rc = m0_ctg_ctidx_lookup_sync(&cfid, &layout);
 		if (rc == 0)
 			break;
 	}
 	if (rc == 0) {
-		*fid = ((struct m0_dix_layout *)
-			(vdata + M0_CAS_CTG_VAL_HDR_SIZE))->u.dl_desc.ld_pver;
+		*fid = layout.u.dl_desc.ld_pver;
 	} else
 		M0_LOG(M0_ERROR, "Failed to get pool version fid, rc = %d", rc);
 	return rc;
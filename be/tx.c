@@ -358,6 +358,9 @@ static void addb2_add_tx_attrs(const struct m0_be_tx *tx)
         M0_ADDB2_ADD(M0_AVI_ATTR, tx_sm_id,
 		     M0_AVI_BE_TX_ATTR_RA_AREA_USED,
 		     tx->t_reg_area.bra_area_used);
+        M0_ADDB2_ADD(M0_AVI_ATTR, tx_sm_id,
+		     M0_AVI_BE_TX_ATTR_RA_AREA_REUSED,
+		     tx->t_reg_area.bra_area_reused);
         M0_ADDB2_ADD(M0_AVI_ATTR, tx_sm_id,
 		     M0_AVI_BE_TX_ATTR_RA_PREP_TC_REG_NR,
 		     tx->t_reg_area.bra_prepared.tc_reg_nr);
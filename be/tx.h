@@ -535,9 +535,10 @@ M0_INTERNAL void m0_be_tx_get(struct m0_be_tx *tx);
 M0_INTERNAL void m0_be_tx_put(struct m0_be_tx *tx);
 
 /**
- * Forces the tx's group to close immediately by explictly calling
- * m0_be_tx_group_close(), which in turn triggers the logging of all
- * the lingering transactions in this group.
+ * Asks the engine to log the tx's group soon. The group is frozen no later
+ * than m0_be_engine_cfg::bec_group_freeze_timeout_min after the first force,
+ * so all transactions forced in the meantime are logged by the same group
+ * instead of each of them closing a group of its own.
  */
 M0_INTERNAL void m0_be_tx_force(struct m0_be_tx *tx);
 
@@ -60,6 +60,12 @@
  *          - m0_be_op_done(tb->btb_op)
  *
  * @endverbatim
+ *
+ * With auto-tuning be_tx_bulk_queue_get_cb() parks the worker instead of
+ * getting an item if the worker's rank in its partition is not less than
+ * m0_be_tx_bulk_stats::tbs_workers_per_partition. be_tx_bulk_unpark() posts
+ * tbw_queue_get for the worker again. Tuning is done in be_tx_bulk_gc_cb(),
+ * see be_tx_bulk_tune().
  * @{
  */
 
@@ -72,9 +78,11 @@
 #include "lib/locality.h"       /* m0_locality_get */
 #include "lib/chan.h"           /* m0_clink */
 #include "lib/errno.h"          /* ENOENT */
+#include "lib/arith.h"          /* max64u */
 
 #include "be/tx.h"              /* m0_be_tx */
 #include "be/domain.h"          /* m0_be_domain__group_limits */ /* XXX */
+#include "be/log.h"             /* m0_be_log */
 
 #include "sm/sm.h"              /* m0_sm_ast */
 
@@ -86,6 +94,15 @@ enum {
 	 * This value can be tuned to increase performance.
 	 */
 	BE_TX_BULK_WORKER_MAX = 0x40,
+	/** Default m0_be_tx_bulk_cfg::tbc_latency_target. */
+	BE_TX_BULK_LATENCY_TARGET = 100 * M0_TIME_ONE_MSEC,
+	/**
+	 * Minimum number of persistent transactions in a tuning period. A
+	 * period is not shorter than one transaction per running worker.
+	 */
+	BE_TX_BULK_TUNE_PERIOD_TX = 0x10,
+	/** Work per tx and parallelism are not raised below this free log. */
+	BE_TX_BULK_LOG_FREE_PCT_MIN = 25,
 };
 
 struct be_tx_bulk_item {
@@ -104,6 +121,8 @@ struct be_tx_bulk_worker {
 	uint64_t                tbw_index;
 	uint64_t                tbw_partition;
 	uint64_t                tbw_locality;
+	/** Index of the worker among the workers of its partition. */
+	uint64_t                tbw_rank;
 	struct m0_be_tx         tbw_tx;
 	struct m0_be_tx_bulk   *tbw_tb;
 	struct be_tx_bulk_item *tbw_item;
@@ -121,6 +140,10 @@ struct be_tx_bulk_worker {
 	bool                    tbw_failed;
 	bool                    tbw_done;
 	bool                    tbw_terminate_order;
+	/** The worker waits for be_tx_bulk_unpark(). */
+	bool                    tbw_parked;
+	/** m0_be_tx_open() time of tbw_tx. */
+	m0_time_t               tbw_open_time;
 };
 
 static void be_tx_bulk_finish_cb(struct m0_sm_group *grp,
@@ -278,10 +301,22 @@ M0_INTERNAL int m0_be_tx_bulk_init(struct m0_be_tx_bulk     *tb,
 		                    + (tb->btb_worker[j].tbw_partition == i)),
 		          (workers_per_partition, workers_per_partition - 1))));
 	}
+	tb->btb_workers_per_partition_max = 0;
 	for (i = 0; i < tb->btb_cfg.tbc_workers_nr; ++i) {
 		worker = &tb->btb_worker[i];
 		worker->tbw_grp = m0_locality_get(worker->tbw_locality)->lo_grp;
+		worker->tbw_rank = m0_reduce(j, i, 0,
+			+ (tb->btb_worker[j].tbw_partition ==
+			   worker->tbw_partition));
+		tb->btb_workers_per_partition_max =
+			max64u(tb->btb_workers_per_partition_max,
+			       worker->tbw_rank + 1);
 	}
+	tb->btb_ended = false;
+	tb->btb_stats.tbs_items_per_tx = tb->btb_cfg.tbc_autotune ? 1 :
+		tb->btb_cfg.tbc_work_items_per_tx_max;
+	tb->btb_stats.tbs_workers_per_partition = tb->btb_cfg.tbc_autotune ? 1 :
+		tb->btb_workers_per_partition_max;
 	return M0_RC(rc);
 }
 
@@ -314,6 +349,121 @@ static void be_tx_bulk_unlock(struct m0_be_tx_bulk *tb)
 }
 
 
+/**
+ * Posts tbw_queue_get for the parked workers which are allowed to run now, or
+ * for all of them if the work is ending.
+ */
+static void be_tx_bulk_unpark(struct m0_be_tx_bulk *tb, bool all)
+{
+	struct be_tx_bulk_worker *worker;
+	uint64_t                  i;
+
+	M0_PRE(m0_mutex_is_locked(&tb->btb_lock));
+
+	for (i = 0; i < tb->btb_cfg.tbc_workers_nr; ++i) {
+		worker = &tb->btb_worker[i];
+		if (worker->tbw_parked &&
+		    (all || worker->tbw_rank <
+		     tb->btb_stats.tbs_workers_per_partition)) {
+			worker->tbw_parked = false;
+			m0_sm_ast_post(worker->tbw_grp, &worker->tbw_queue_get);
+		}
+	}
+}
+
+static bool be_tx_bulk_park(struct be_tx_bulk_worker *worker)
+{
+	struct m0_be_tx_bulk *tb = worker->tbw_tb;
+	bool                  parked;
+
+	be_tx_bulk_lock(tb);
+	parked = tb->btb_cfg.tbc_autotune && !tb->btb_ended &&
+		 !tb->btb_tx_open_failed &&
+		 worker->tbw_rank >= tb->btb_stats.tbs_workers_per_partition;
+	worker->tbw_parked = parked;
+	be_tx_bulk_unlock(tb);
+	return parked;
+}
+
+static bool be_tx_bulk_log_has_space(struct m0_be_tx_bulk *tb)
+{
+	struct m0_be_log *log = m0_be_domain_log(tb->btb_cfg.tbc_dom);
+
+	/* Unlocked read: it's only a hint for the tuning. */
+	return log->lg_free * 100 >=
+	       m0_be_log_store_buf_size(&log->lg_store) *
+	       BE_TX_BULK_LOG_FREE_PCT_MIN;
+}
+
+static void be_tx_bulk_tune_period(struct m0_be_tx_bulk *tb)
+{
+	struct m0_be_tx_bulk_stats *st = &tb->btb_stats;
+	m0_time_t                   target;
+	m0_time_t                   latency;
+	bool                        log_has_space;
+
+	M0_PRE(m0_mutex_is_locked(&tb->btb_lock));
+
+	target = tb->btb_cfg.tbc_latency_target ?: BE_TX_BULK_LATENCY_TARGET;
+	latency = tb->btb_tune_latency_sum / tb->btb_tune_tx_nr;
+	log_has_space = be_tx_bulk_log_has_space(tb);
+	if (latency <= target && log_has_space) {
+		if (st->tbs_items_per_tx <
+		    tb->btb_cfg.tbc_work_items_per_tx_max) {
+			st->tbs_items_per_tx = min64u(st->tbs_items_per_tx * 2,
+				tb->btb_cfg.tbc_work_items_per_tx_max);
+			++st->tbs_tune_up_nr;
+		} else if (st->tbs_workers_per_partition <
+			   tb->btb_workers_per_partition_max) {
+			st->tbs_workers_per_partition =
+				min64u(st->tbs_workers_per_partition * 2,
+				       tb->btb_workers_per_partition_max);
+			be_tx_bulk_unpark(tb, false);
+			++st->tbs_tune_up_nr;
+		}
+	} else {
+		if (st->tbs_workers_per_partition > 1) {
+			--st->tbs_workers_per_partition;
+			++st->tbs_tune_down_nr;
+		} else if (st->tbs_items_per_tx > 1) {
+			st->tbs_items_per_tx /= 2;
+			++st->tbs_tune_down_nr;
+		}
+	}
+	M0_LOG(M0_DEBUG, "tb=%p latency=%"PRIu64" target=%"PRIu64" "
+	       "log_has_space=%d items_per_tx=%"PRIu64" "
+	       "workers_per_partition=%"PRIu64, tb, latency, target,
+	       !!log_has_space, st->tbs_items_per_tx,
+	       st->tbs_workers_per_partition);
+	tb->btb_tune_tx_nr = 0;
+	tb->btb_tune_latency_sum = 0;
+}
+
+/** Accounts a persistent transaction and adjusts the limits if it's time. */
+static void be_tx_bulk_tune(struct m0_be_tx_bulk *tb,
+                            uint64_t              items_nr,
+                            m0_time_t             latency)
+{
+	struct m0_be_tx_bulk_stats *st = &tb->btb_stats;
+
+	be_tx_bulk_lock(tb);
+	st->tbs_items_nr += items_nr;
+	++st->tbs_tx_nr;
+	st->tbs_latency_sum += latency;
+	st->tbs_latency_max = max64u(st->tbs_latency_max, latency);
+	st->tbs_last = m0_time_now();
+	if (tb->btb_cfg.tbc_autotune) {
+		++tb->btb_tune_tx_nr;
+		tb->btb_tune_latency_sum += latency;
+		if (tb->btb_tune_tx_nr >=
+		    max64u(BE_TX_BULK_TUNE_PERIOD_TX,
+			   st->tbs_workers_per_partition *
+			   tb->btb_cfg.tbc_partitions_nr))
+			be_tx_bulk_tune_period(tb);
+	}
+	be_tx_bulk_unlock(tb);
+}
+
 static void be_tx_bulk_queues_drain(struct m0_be_tx_bulk *tb)
 {
 	struct be_tx_bulk_item data;
@@ -358,6 +508,14 @@ static void be_tx_bulk_finish_cb(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 			tb->btb_rc = tb->btb_worker[i].tbw_rc ?: tb->btb_rc;
 		tb->btb_done = true;
 		M0_LOG(M0_DEBUG, "setting tb=%p btb_done = true", tb);
+		M0_LOG(M0_INFO, "tb=%p items_nr=%"PRIu64" tx_nr=%"PRIu64" "
+		       "items_per_sec=%"PRIu64" latency_max=%"PRIu64" "
+		       "items_per_tx=%"PRIu64" workers_per_partition=%"PRIu64,
+		       tb, tb->btb_stats.tbs_items_nr, tb->btb_stats.tbs_tx_nr,
+		       m0_be_tx_bulk_stats_items_per_sec(&tb->btb_stats),
+		       tb->btb_stats.tbs_latency_max,
+		       tb->btb_stats.tbs_items_per_tx,
+		       tb->btb_stats.tbs_workers_per_partition);
 	}
 	be_tx_bulk_unlock(tb);
 	if (done) {
@@ -385,6 +543,8 @@ static void be_tx_bulk_queue_get_cb(struct m0_sm_group *grp,
 	}
 	if (tb->btb_tx_open_failed) {
 		m0_sm_ast_post(worker->tbw_grp, &worker->tbw_finish);
+	} else if (be_tx_bulk_park(worker)) {
+		M0_LOG(M0_DEBUG, "worker=%p parked", worker);
 	} else {
 		m0_be_op_reset(&worker->tbw_op);
 		m0_be_queue_lock(bq);
@@ -430,6 +590,7 @@ static void be_tx_bulk_open(struct be_tx_bulk_worker *worker,
 
 	m0_be_tx_prep(tx, cred);
 	m0_be_tx_payload_prep(tx, cred_payload);
+	worker->tbw_open_time = m0_time_now();
 	m0_be_tx_open(tx);
 }
 
@@ -441,6 +602,7 @@ static void be_tx_bulk_init_cb(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 	struct m0_be_tx_bulk     *tb = worker->tbw_tb;
 	struct m0_be_queue       *bq = &tb->btb_q[worker->tbw_partition];
 	m0_bcount_t               accum_payload_size = 0;
+	uint64_t                  items_max;
 	bool                      successful;
 
 	M0_PRE(ast == &worker->tbw_init);
@@ -450,11 +612,13 @@ static void be_tx_bulk_init_cb(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 
 	accum_credit       = worker->tbw_item[0].bbd_credit;
 	accum_payload_size = worker->tbw_item[0].bbd_payload_size;
+	be_tx_bulk_lock(tb);
+	items_max = tb->btb_stats.tbs_items_per_tx;
+	be_tx_bulk_unlock(tb);
 	/* optimisation: don't take the lock when per tx limit is only 1 item */
-	if (tb->btb_cfg.tbc_work_items_per_tx_max > 1) {
+	if (items_max > 1) {
 		m0_be_queue_lock(bq);
-		while (worker->tbw_items_nr <
-		       tb->btb_cfg.tbc_work_items_per_tx_max) {
+		while (worker->tbw_items_nr < items_max) {
 			data = &worker->tbw_item[worker->tbw_items_nr];
 			if (!M0_BE_QUEUE_PEEK(bq, data))
 				break;
@@ -495,6 +659,7 @@ static bool be_tx_bulk_open_cb(struct m0_clink *clink)
 		} else {
 			be_tx_bulk_lock(tb);
 			tb->btb_tx_open_failed = true;
+			be_tx_bulk_unpark(tb, true);
 			be_tx_bulk_unlock(tb);
 			worker->tbw_rc = tx->t_sm.sm_rc;
 			M0_LOG(M0_ERROR, "tx=%p rc=%d", tx, worker->tbw_rc);
@@ -549,6 +714,11 @@ static void be_tx_bulk_gc_cb(struct m0_be_tx *tx, void *param)
 	M0_PRE(tx == &worker->tbw_tx);
 
 	tb = worker->tbw_tb;
+	/* tbw_rc != 0: tx open has failed, @see be_tx_bulk_open_cb() */
+	if (worker->tbw_rc == 0)
+		be_tx_bulk_tune(tb, worker->tbw_items_nr,
+				m0_time_sub(m0_time_now(),
+					    worker->tbw_open_time));
 	for (i = 0; i < worker->tbw_items_nr; ++i) {
 		M0_LOG(M0_DEBUG, "worker=%p tbw_index=%" PRIu64 " bbd_user=%p",
 		       worker, worker->tbw_index, worker->tbw_item[i].bbd_user);
@@ -570,6 +740,10 @@ M0_INTERNAL void m0_be_tx_bulk_run(struct m0_be_tx_bulk *tb,
 
 	M0_ENTRY();
 	tb->btb_op = op;
+	be_tx_bulk_lock(tb);
+	tb->btb_stats.tbs_start = m0_time_now();
+	tb->btb_stats.tbs_last  = tb->btb_stats.tbs_start;
+	be_tx_bulk_unlock(tb);
 	m0_be_op_active(tb->btb_op);
 	for (i = 0; i < tb->btb_cfg.tbc_workers_nr; ++i) {
 		worker = &tb->btb_worker[i];
@@ -620,6 +794,10 @@ M0_INTERNAL void m0_be_tx_bulk_end(struct m0_be_tx_bulk *tb)
 {
 	uint64_t i;
 
+	be_tx_bulk_lock(tb);
+	tb->btb_ended = true;
+	be_tx_bulk_unpark(tb, true);
+	be_tx_bulk_unlock(tb);
 	for (i = 0; i < tb->btb_cfg.tbc_partitions_nr; ++i) {
 		m0_be_queue_lock(&tb->btb_q[i]);
 		m0_be_queue_end(&tb->btb_q[i]);
@@ -638,6 +816,23 @@ M0_INTERNAL int m0_be_tx_bulk_status(struct m0_be_tx_bulk *tb)
 	return rc;
 }
 
+M0_INTERNAL void m0_be_tx_bulk_stats_get(struct m0_be_tx_bulk       *tb,
+                                         struct m0_be_tx_bulk_stats *stats)
+{
+	be_tx_bulk_lock(tb);
+	*stats = tb->btb_stats;
+	be_tx_bulk_unlock(tb);
+}
+
+M0_INTERNAL uint64_t
+m0_be_tx_bulk_stats_items_per_sec(const struct m0_be_tx_bulk_stats *stats)
+{
+	m0_time_t elapsed = m0_time_sub(stats->tbs_last, stats->tbs_start);
+
+	return elapsed == 0 ? 0 :
+	       stats->tbs_items_nr * M0_TIME_ONE_SECOND / elapsed;
+}
+
 #undef M0_TRACE_SUBSYSTEM
 
 /** @} end of be group */
@@ -26,6 +26,7 @@
 #define __MOTR_BE_TX_BULK_H__
 
 #include "lib/types.h"          /* uint32_t */
+#include "lib/time.h"           /* m0_time_t */
 #include "lib/mutex.h"          /* m0_mutex */
 
 #include "be/queue.h"           /* m0_be_queue */
@@ -39,6 +40,29 @@
  *
  * @see m0_be_ut_tx_bulk_usecase() for an example.
  *
+ * Auto-tuning
+ *
+ * With m0_be_tx_bulk_cfg::tbc_autotune the amount of work per transaction and
+ * the number of workers running for each partition are adjusted at run time.
+ * Both start at 1. After every tuning period (a number of persistent
+ * transactions) the average latency from m0_be_tx_open() to the transaction
+ * becoming persistent is compared with m0_be_tx_bulk_cfg::tbc_latency_target
+ * and the free space of BE log is checked:
+ * - if the latency is below the target and the log has enough free space,
+ *   work items per transaction are doubled up to tbc_work_items_per_tx_max,
+ *   and once at the maximum, workers per partition are doubled up to the
+ *   number of workers in the partition;
+ * - otherwise a worker per partition is parked, and when there is already
+ *   only one worker per partition running, work items per transaction are
+ *   halved.
+ * Workers are spread across localities (see m0_be_tx_bulk_init()), so the
+ * number of running workers per partition is the parallelism across
+ * localities. A parked worker doesn't take work from the queue until it's
+ * unparked by the tuning or until m0_be_tx_bulk_end() is called.
+ *
+ * m0_be_tx_bulk_stats_get() returns throughput statistics regardless of
+ * tbc_autotune.
+ *
  * Future directions
  * - use m0_fom instead of asts
  * - use m0_module for init()/fini()
@@ -66,6 +90,13 @@ struct m0_be_tx_bulk_cfg {
 	uint64_t                 tbc_workers_nr;
 	uint64_t                 tbc_partitions_nr;
 	uint64_t                 tbc_work_items_per_tx_max;
+	/** Adjust work per tx and parallelism at run time. */
+	bool                     tbc_autotune;
+	/**
+	 * Commit latency the auto-tuning aims at.
+	 * 0 means BE_TX_BULK_LATENCY_TARGET (be/tx_bulk.c).
+	 */
+	m0_time_t                tbc_latency_target;
 	/** BE domain for transactions */
 	struct m0_be_domain     *tbc_dom;
 	/** it's passed as a parameter to m0_be_tx_bulk_cfg::tbc_do() */
@@ -86,6 +117,28 @@ struct m0_be_tx_bulk_cfg {
 	                                   uint64_t              partition);
 };
 
+/** @see m0_be_tx_bulk_stats_get() */
+struct m0_be_tx_bulk_stats {
+	/** Work items which have become persistent. */
+	uint64_t                  tbs_items_nr;
+	/** Transactions which have become persistent. */
+	uint64_t                  tbs_tx_nr;
+	/** Sum of open-to-persistent latencies of the transactions. */
+	m0_time_t                 tbs_latency_sum;
+	m0_time_t                 tbs_latency_max;
+	/** Time of m0_be_tx_bulk_run(). */
+	m0_time_t                 tbs_start;
+	/** Time the last transaction has become persistent. */
+	m0_time_t                 tbs_last;
+	/** Current work items per transaction limit. */
+	uint64_t                  tbs_items_per_tx;
+	/** Current number of workers running for each partition. */
+	uint64_t                  tbs_workers_per_partition;
+	/** How many times the limits above were raised and lowered. */
+	uint64_t                  tbs_tune_up_nr;
+	uint64_t                  tbs_tune_down_nr;
+};
+
 struct m0_be_tx_bulk {
 	struct m0_be_tx_bulk_cfg  btb_cfg;
 	struct m0_be_queue       *btb_q;
@@ -101,6 +154,15 @@ struct m0_be_tx_bulk {
 	bool                      btb_termination_in_progress;
 	struct m0_be_op          *btb_op;
 	struct m0_be_op           btb_kill_put_op;
+	/** Protected by btb_lock. */
+	struct m0_be_tx_bulk_stats btb_stats;
+	/** Maximum number of workers running for a partition. */
+	uint64_t                  btb_workers_per_partition_max;
+	/** Persistent transactions in the current tuning period. */
+	uint64_t                  btb_tune_tx_nr;
+	m0_time_t                 btb_tune_latency_sum;
+	/** m0_be_tx_bulk_end() has been called. */
+	bool                      btb_ended;
 };
 
 M0_INTERNAL int m0_be_tx_bulk_init(struct m0_be_tx_bulk     *tb,
@@ -130,6 +192,16 @@ M0_INTERNAL void m0_be_tx_bulk_end(struct m0_be_tx_bulk *tb);
  */
 M0_INTERNAL int m0_be_tx_bulk_status(struct m0_be_tx_bulk *tb);
 
+/**
+ * Gets a snapshot of m0_be_tx_bulk statistics.
+ * Can be called at any time after m0_be_tx_bulk_run().
+ */
+M0_INTERNAL void m0_be_tx_bulk_stats_get(struct m0_be_tx_bulk       *tb,
+                                         struct m0_be_tx_bulk_stats *stats);
+/** Work items per second from m0_be_tx_bulk_run() to the last persistent tx. */
+M0_INTERNAL uint64_t
+m0_be_tx_bulk_stats_items_per_sec(const struct m0_be_tx_bulk_stats *stats);
+
 
 /** @} end of be group */
 #endif /* __MOTR_BE_TX_BULK_H__ */
@@ -28,6 +28,7 @@
 #include "lib/misc.h"        /* M0_SET0 */
 #include "lib/errno.h"       /* ENOSPC */
 #include "lib/memory.h"      /* M0_ALLOC_PTR */
+#include "lib/time.h"        /* m0_time_now */
 
 #include "be/tx_internal.h"  /* m0_be_tx__reg_area */
 #include "be/domain.h"       /* m0_be_domain_seg */
@@ -86,7 +87,9 @@ static void be_tx_group_reg_area_gather(struct m0_be_tx_group *gr)
 	struct m0_be_tx_credit  used;
 	struct m0_be_tx_credit  prepared;
 	struct m0_be_tx_credit  captured;
+	struct m0_be_tx_credit  captured_total = {};
 	struct m0_be_tx        *tx;
+	uint64_t                gid;
 
 	M0_LOG(M0_DEBUG, "gr=%p tx_nr=%zu", gr, m0_be_tx_group_tx_nr(gr));
 	/* XXX check if it's the right place */
@@ -98,6 +101,7 @@ static void be_tx_group_reg_area_gather(struct m0_be_tx_group *gr)
 			m0_be_reg_area_prepared(ra, &prepared);
 			m0_be_reg_area_captured(ra, &captured);
 			m0_be_reg_area_used(ra, &used);
+			m0_be_tx_credit_add(&captured_total, &captured);
 			M0_LOG(M0_DEBUG, "tx=%p t_prepared="BETXCR_F" "
 			       "t_payload_prepared=%" PRId64 " "
 			       "captured="BETXCR_F" "
@@ -109,6 +113,18 @@ static void be_tx_group_reg_area_gather(struct m0_be_tx_group *gr)
 		m0_be_reg_area_merger_merge_to(&gr->tg_merger, &gr->tg_reg_area);
 	}
 	m0_be_reg_area_optimize(&gr->tg_reg_area);
+	/*
+	 * Capture inflation: the same hot regions are captured by many
+	 * transactions of the group, but only the merged regions are logged.
+	 */
+	m0_be_reg_area_used(&gr->tg_reg_area, &used);
+	M0_LOG(M0_DEBUG, "gr=%p captured="BETXCR_F" used="BETXCR_F,
+	       gr, BETXCR_P(&captured_total), BETXCR_P(&used));
+	gid = m0_sm_id_get(&gr->tg_fom.tgf_gen.fo_sm_phase);
+	M0_ADDB2_ADD(M0_AVI_ATTR, gid, M0_AVI_BE_GROUP_ATTR_CAPTURED_SIZE,
+		     captured_total.tc_reg_size);
+	M0_ADDB2_ADD(M0_AVI_ATTR, gid, M0_AVI_BE_GROUP_ATTR_REG_SIZE,
+		     used.tc_reg_size);
 }
 
 static void be_tx_group_payload_gather(struct m0_be_tx_group *gr)
@@ -216,6 +232,7 @@ M0_INTERNAL int m0_be_tx_group_init(struct m0_be_tx_group     *gr,
 		.gfc_log = gr_cfg->tgc_log,
 		.gfc_log_discard = gr_cfg->tgc_log_discard,
 		.gfc_pd = gr_cfg->tgc_pd,
+		.gfc_compress = gr_cfg->tgc_log_compress,
 	};
 	/* XXX temporary block begin */
 	gr->tg_size             = gr_cfg->tgc_size_max;
@@ -435,6 +452,7 @@ M0_INTERNAL void m0_be_tx_group_encode(struct m0_be_tx_group *gr)
 M0_INTERNAL void m0_be_tx_group_log_write(struct m0_be_tx_group *gr,
 					  struct m0_be_op       *op)
 {
+	gr->tg_log_write_start = m0_time_now();
 	m0_be_group_format_log_write(&gr->tg_od, op);
 }
 
@@ -450,6 +468,11 @@ m0_be_tx_group__tx_state_post(struct m0_be_tx_group *gr,
 
 	M0_ASSERT(m0_be_tx_group_tx_nr(gr) > 0);
 
+	if (state == M0_BTS_LOGGED && !gr->tg_recovering) {
+		m0_be_engine__tx_group_logged(gr->tg_engine, gr,
+					      m0_time_now() -
+					      gr->tg_log_write_start);
+	}
 	M0_BE_TX_GROUP_TX_FORALL(gr, tx) {
 		if (del_tx_from_group)
 			m0_be_tx_group_tx_del(gr, tx);
@@ -579,6 +602,7 @@ M0_INTERNAL int m0_be_tx_group_reconstruct(struct m0_be_tx_group *gr,
 {
 	be_tx_group_reconstruct_reg_area(gr);
 	be_tx_group_reconstruct_transactions(gr, sm_grp);
+	m0_be_engine__recovery_group_decoded(gr->tg_engine, gr);
 	return 0; /* XXX no error handling yet. It will be fixed. */
 }
 
@@ -613,6 +637,16 @@ m0_be_tx_group_reconstruct_tx_close(struct m0_be_tx_group *gr,
 	} m0_tl_endfor;
 }
 
+M0_INTERNAL bool m0_be_tx_group_reapply_may_start(struct m0_be_tx_group *gr)
+{
+	return m0_be_engine__recovery_reapply_may_start(gr->tg_engine, gr);
+}
+
+M0_INTERNAL void m0_be_tx_group_reapply_wakeup(struct m0_be_tx_group *gr)
+{
+	m0_be_tx_group_fom_reapply(&gr->tg_fom);
+}
+
 /*
  * It will perform actual I/O when paged implemented so op is added
  * to the function parameters list.
@@ -627,6 +661,7 @@ M0_INTERNAL int m0_be_tx_group_reapply(struct m0_be_tx_group *gr,
 	M0_BE_REG_AREA_FORALL(&gr->tg_reg_area, rd) {
 		memcpy(rd->rd_reg.br_addr, rd->rd_buf, rd->rd_reg.br_size);
 	};
+	m0_be_engine__recovery_group_reapplied(gr->tg_engine, gr);
 
 	m0_be_op_done(op);
 	return 0;
@@ -72,6 +72,8 @@ struct m0_be_tx_group_cfg {
 	struct m0_be_log	      *tgc_log;
 	struct m0_be_log_discard      *tgc_log_discard;
 	struct m0_be_pd               *tgc_pd;
+	/** Compress log records of the group, @see gfc_compress. */
+	bool                           tgc_log_compress;
 	/** reqh for the group fom. */
 	struct m0_reqh		      *tgc_reqh;
 	/** Group format configuration. Is set by the group. */
@@ -141,9 +143,27 @@ struct m0_be_tx_group {
 	struct m0_sm_timer         tg_close_timer;
 	struct m0_sm_ast           tg_close_timer_arm;
 	struct m0_sm_ast           tg_close_timer_disarm;
+	/** Re-arms the close timer for a deadline shortened by a force. */
+	struct m0_sm_ast           tg_close_timer_force;
+	/** tg_close_timer_force is posted. Protected by the engine lock. */
+	bool                       tg_close_forced;
 	m0_time_t                  tg_close_deadline;
+	/** Time when the log record write has been started. */
+	m0_time_t                  tg_log_write_start;
 	/** Group state. Is used and set by the engine. */
 	enum m0_be_tx_group_state  tg_state;
+	/*
+	 * Fields for the recovery ordering. Are set and used by the engine
+	 * under the engine lock. @see m0_be_engine__recovery_reapply_may_start()
+	 */
+	/** Position of the group's log record in the recovery order. */
+	uint64_t                   tg_recovery_seq;
+	/** Regions of the recovering group are known. */
+	bool                       tg_recovery_decoded;
+	/** Regions of the recovering group have been reapplied. */
+	bool                       tg_recovery_reapplied;
+	/** The group fom waits until it may reapply the regions. */
+	bool                       tg_recovery_waiting;
 };
 
 M0_INTERNAL bool m0_be_tx_group__invariant(struct m0_be_tx_group *gr);
@@ -231,6 +251,12 @@ M0_INTERNAL void m0_be_tx_group_reconstruct_tx_open(struct m0_be_tx_group *gr,
 M0_INTERNAL void
 m0_be_tx_group_reconstruct_tx_close(struct m0_be_tx_group *gr,
                                     struct m0_be_op       *op_gc);
+/**
+ * Returns true iff m0_be_tx_group_reapply() may be called for the group now.
+ * Otherwise the group fom is woken up by m0_be_tx_group_reapply_wakeup().
+ */
+M0_INTERNAL bool m0_be_tx_group_reapply_may_start(struct m0_be_tx_group *gr);
+M0_INTERNAL void m0_be_tx_group_reapply_wakeup(struct m0_be_tx_group *gr);
 M0_INTERNAL int m0_be_tx_group_reapply(struct m0_be_tx_group *gr,
 				       struct m0_be_op       *op);
 
@@ -202,6 +202,8 @@ static int tx_group_fom_tick(struct m0_fom *fom)
 		m0_fom_phase_set(fom, TGS_REAPPLY);
 		return M0_FSO_AGAIN;
 	case TGS_REAPPLY:
+		if (!m0_be_tx_group_reapply_may_start(gr))
+			return M0_FSO_WAIT;
 		m0_be_op_reset(op);
 		rc = m0_be_tx_group_reapply(gr, op);
 		M0_ASSERT_INFO(rc == 0, "rc = %d", rc); /* XXX notify engine */
@@ -317,6 +319,16 @@ static void be_tx_group_fom_stable(struct m0_sm_group *_, struct m0_sm_ast *ast)
 	M0_LEAVE();
 }
 
+static void be_tx_group_fom_reapply(struct m0_sm_group *_,
+				    struct m0_sm_ast   *ast)
+{
+	struct m0_be_tx_group_fom *m = M0_AMB(m, ast, tgf_ast_reapply);
+
+	M0_ENTRY();
+	be_tx_group_fom_iff_waiting_wakeup(&m->tgf_gen);
+	M0_LEAVE();
+}
+
 static void be_tx_group_fom_stop(struct m0_sm_group *gr, struct m0_sm_ast *ast)
 {
 	struct m0_be_tx_group_fom *m = M0_AMB(m, ast, tgf_ast_stop);
@@ -346,6 +358,7 @@ M0_INTERNAL void m0_be_tx_group_fom_init(struct m0_be_tx_group_fom *m,
 	m->tgf_ast_handle  = _AST(be_tx_group_fom_handle);
 	m->tgf_ast_stable  = _AST(be_tx_group_fom_stable);
 	m->tgf_ast_stop    = _AST(be_tx_group_fom_stop);
+	m->tgf_ast_reapply = _AST(be_tx_group_fom_reapply);
 #undef _AST
 
 	m0_semaphore_init(&m->tgf_start_sem, 0);
@@ -414,6 +427,11 @@ M0_INTERNAL void m0_be_tx_group_fom_stable(struct m0_be_tx_group_fom *gf)
 	be_tx_group_fom_ast_post(gf, &gf->tgf_ast_stable);
 }
 
+M0_INTERNAL void m0_be_tx_group_fom_reapply(struct m0_be_tx_group_fom *gf)
+{
+	be_tx_group_fom_ast_post(gf, &gf->tgf_ast_reapply);
+}
+
 M0_INTERNAL struct m0_sm_group *
 m0_be_tx_group_fom__sm_group(struct m0_be_tx_group_fom *m)
 {
@@ -59,6 +59,7 @@ struct m0_be_tx_group_fom {
 	struct m0_sm_ast       tgf_ast_handle;
 	struct m0_sm_ast       tgf_ast_stable;
 	struct m0_sm_ast       tgf_ast_stop;
+	struct m0_sm_ast       tgf_ast_reapply;
 	struct m0_semaphore    tgf_start_sem;
 	struct m0_semaphore    tgf_finish_sem;
 	bool                   tgf_recovery_mode;
@@ -76,6 +77,8 @@ M0_INTERNAL void m0_be_tx_group_fom_stop(struct m0_be_tx_group_fom *gf);
 
 M0_INTERNAL void m0_be_tx_group_fom_handle(struct m0_be_tx_group_fom *m);
 M0_INTERNAL void m0_be_tx_group_fom_stable(struct m0_be_tx_group_fom *gf);
+/** Wakes up the fom waiting in TGS_REAPPLY phase. */
+M0_INTERNAL void m0_be_tx_group_fom_reapply(struct m0_be_tx_group_fom *gf);
 
 M0_INTERNAL struct m0_sm_group *
 m0_be_tx_group_fom__sm_group(struct m0_be_tx_group_fom *m);
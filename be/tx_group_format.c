@@ -34,6 +34,7 @@
 #include "lib/memory.h"      /* m0_alloc */
 #include "lib/misc.h"        /* M0_SET0 */
 #include "lib/errno.h"       /* ENOMEM */
+#include "lib/buf.h"         /* m0_buf_alloc */
 
 #include "module/instance.h" /* m0_get */
 
@@ -102,7 +103,11 @@ static int be_group_format_level_enter(struct m0_module *module)
 	case M0_BE_GROUP_FORMAT_LEVEL_LOG_RECORD_ALLOCATE:
 		return m0_be_log_record_allocate(&gft->gft_log_record);
 	case M0_BE_GROUP_FORMAT_LEVEL_ALLOCATED:
-		return 0;
+		if (!gft->gft_cfg.gfc_compress)
+			return 0;
+		return m0_buf_alloc(&gft->gft_compress_buf,
+				    m0_be_fmt_group_compress_buf_size(
+					&gft->gft_cfg.gfc_fmt_cfg));
 	default:
 		return M0_ERR(-ENOSYS);
 	}
@@ -154,6 +159,7 @@ static void be_group_format_level_leave(struct m0_module *module)
 		}
 		if (gft->gft_pd_io != NULL)
 			m0_be_pd_io_put(gft->gft_cfg.gfc_pd, gft->gft_pd_io);
+		m0_buf_free(&gft->gft_compress_buf);
 		break;
 	default:
 		M0_IMPOSSIBLE("Unexpected m0_module level");
@@ -360,6 +366,7 @@ M0_INTERNAL int m0_be_group_format_decode(struct m0_be_group_format *gft)
 	m0_bufvec_cursor_init(&cur, bvec);
 	rc = rc ?: m0_be_fmt_cblock_decode(&gft->gft_fmt_cblock_decoded,
 					   &cur, M0_BE_FMT_DECODE_CFG_DEFAULT);
+	rc = rc ?: m0_be_fmt_group_decompress(gft->gft_fmt_group_decoded);
 	return rc;
 }
 
@@ -457,6 +464,12 @@ m0_be_group_format_log_position(const struct m0_be_group_format *gft)
 	return m0_be_log_record_position(&gft->gft_log_record);
 }
 
+M0_INTERNAL m0_bcount_t
+m0_be_group_format_log_size(const struct m0_be_group_format *gft)
+{
+	return gft->gft_log_record.lgr_size;
+}
+
 M0_INTERNAL m0_bindex_t
 m0_be_group_format_log_discarded(const struct m0_be_group_format *gft)
 {
@@ -471,6 +484,9 @@ m0_be_group_format_log_use(struct m0_be_group_format *gft,
 	m0_bcount_t              size_group;
 	m0_bcount_t              size_cblock;
 
+	if (gft->gft_cfg.gfc_compress)
+		(void)m0_be_fmt_group_compress(&gft->gft_fmt_group,
+					       &gft->gft_compress_buf);
 	size_group  = m0_be_fmt_group_size(&gft->gft_fmt_group);
 	size_cblock = m0_be_fmt_cblock_size(&gft->gft_fmt_cblock);
 
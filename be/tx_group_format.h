@@ -104,6 +104,13 @@ struct m0_be_group_format_cfg {
 	struct m0_be_log           *gfc_log;
 	struct m0_be_log_discard   *gfc_log_discard;
 	struct m0_be_pd            *gfc_pd;
+	/**
+	 * Compress region data of the group before it is written to the log.
+	 * Requires additional m0_be_fmt_group_compress_buf_size() bytes of
+	 * memory for each group. Compressed log records are decoded
+	 * regardless of this option.
+	 */
+	bool                        gfc_compress;
 };
 
 struct m0_be_group_format {
@@ -114,6 +121,8 @@ struct m0_be_group_format {
 	struct m0_be_fmt_cblock        gft_fmt_cblock;
 	struct m0_be_fmt_group        *gft_fmt_group_decoded;
 	struct m0_be_fmt_cblock       *gft_fmt_cblock_decoded;
+	/** Work buffer for compression, is allocated if gfc_compress */
+	struct m0_buf                  gft_compress_buf;
 
 	struct m0_be_log              *gft_log;
 	struct m0_be_log_record_iter   gft_log_record_iter;
@@ -188,6 +197,10 @@ m0_be_group_format_log_use(struct m0_be_group_format *gft,
 M0_INTERNAL m0_bindex_t
 m0_be_group_format_log_position(const struct m0_be_group_format *gft);
 
+/** Returns size of the log record after m0_be_group_format_log_use(). */
+M0_INTERNAL m0_bcount_t
+m0_be_group_format_log_size(const struct m0_be_group_format *gft);
+
 /** Returns BE log discarded pointer at m0_be_group_format_log_use() time. */
 M0_INTERNAL m0_bindex_t
 m0_be_group_format_log_discarded(const struct m0_be_group_format *gft);
@@ -664,7 +664,13 @@ static void be_reg_area_add_copy(void *data, struct m0_be_reg_d *rd)
 	M0_PRE(m0_be_reg_d__invariant(rd));
 	M0_PRE(rd->rd_buf == NULL);
 
-	rd->rd_buf = be_reg_area_alloc(ra, rd->rd_reg.br_size);
+	if (ra->bra_area_reuse != NULL) {
+		rd->rd_buf          = ra->bra_area_reuse;
+		ra->bra_area_reuse  = NULL;
+		ra->bra_area_reused += rd->rd_reg.br_size;
+	} else {
+		rd->rd_buf = be_reg_area_alloc(ra, rd->rd_reg.br_size);
+	}
 	be_reg_d_cpy(rd->rd_buf, rd);
 }
 
@@ -748,6 +754,39 @@ static const struct m0_be_regmap_ops be_reg_area_ops_data_nocopy = {
 	.rmo_split = be_reg_area_split,
 };
 
+/*
+ * Hot regions, like btree nodes, are captured again and again in the same
+ * transaction. If the new region is covered by already captured regions which
+ * are adjacent both in the segment and in bra_area then the part of bra_area
+ * with the old data of the new region isn't used by any region after
+ * m0_be_regmap_add(), so the new data is copied there. The region is still
+ * added to the regmap as a separate one to keep generation index accounting.
+ */
+static void be_reg_area_reuse_find(struct m0_be_reg_area    *ra,
+				   const struct m0_be_reg_d *rd)
+{
+	struct m0_be_reg_d_tree *rdt = &ra->bra_map.br_rdt;
+	struct m0_be_reg_d      *first;
+	struct m0_be_reg_d      *rdi;
+	struct m0_be_reg_d      *next;
+
+	M0_PRE(ra->bra_area_reuse == NULL);
+
+	if (ra->bra_type != M0_BE_REG_AREA_DATA_COPY)
+		return;
+	first = m0_be_rdt_find(rdt, be_reg_d_fb(rd));
+	if (first == NULL || be_reg_d_fb(first) > be_reg_d_fb(rd))
+		return;
+	for (rdi = first; be_reg_d_lb(rdi) < be_reg_d_lb(rd); rdi = next) {
+		next = m0_be_rdt_next(rdt, rdi);
+		if (next == NULL || be_reg_d_fb(next) != be_reg_d_lb1(rdi) ||
+		    next->rd_buf != rdi->rd_buf + be_reg_d_size(rdi))
+			return;
+	}
+	ra->bra_area_reuse = first->rd_buf +
+			     (be_reg_d_fb(rd) - be_reg_d_fb(first));
+}
+
 M0_INTERNAL void m0_be_reg_area_capture(struct m0_be_reg_area *ra,
 					struct m0_be_reg_d    *rd)
 {
@@ -766,7 +805,9 @@ M0_INTERNAL void m0_be_reg_area_capture(struct m0_be_reg_area *ra,
 		       BETXCR_F" prepared="BETXCR_F" region_size=%"PRId64,
 		       BETXCR_P(captured), BETXCR_P(prepared), reg_size);
 
+	be_reg_area_reuse_find(ra, rd);
 	m0_be_regmap_add(&ra->bra_map, rd);
+	M0_ASSERT(ra->bra_area_reuse == NULL);
 
 	M0_POST(m0_be_reg_d__invariant(rd));
 	M0_POST(m0_be_reg_area__invariant(ra));
@@ -799,7 +840,8 @@ M0_INTERNAL void m0_be_reg_area_reset(struct m0_be_reg_area *ra)
 	M0_PRE(m0_be_reg_area__invariant(ra));
 
 	m0_be_regmap_reset(&ra->bra_map);
-	ra->bra_area_used = 0;
+	ra->bra_area_used   = 0;
+	ra->bra_area_reused = 0;
 	M0_SET0(&ra->bra_captured);
 
 	M0_POST(m0_be_reg_area__invariant(ra));
@@ -822,6 +864,24 @@ m0_be_reg_area_next(struct m0_be_reg_area *ra, struct m0_be_reg_d *prev)
 	return m0_be_regmap_next(&ra->bra_map, prev);
 }
 
+M0_INTERNAL bool m0_be_reg_area_are_overlapping(struct m0_be_reg_area *ra1,
+						struct m0_be_reg_area *ra2)
+{
+	struct m0_be_reg_d *rd1 = m0_be_reg_area_first(ra1);
+	struct m0_be_reg_d *rd2 = m0_be_reg_area_first(ra2);
+
+	/* regions in a reg_area are disjoint and sorted by address */
+	while (rd1 != NULL && rd2 != NULL) {
+		if (be_reg_d_are_overlapping(rd1, rd2))
+			return true;
+		if (be_reg_d_lb(rd1) < be_reg_d_lb(rd2))
+			rd1 = m0_be_reg_area_next(ra1, rd1);
+		else
+			rd2 = m0_be_reg_area_next(ra2, rd2);
+	}
+	return false;
+}
+
 M0_INTERNAL int
 m0_be_reg_area_merger_init(struct m0_be_reg_area_merger *brm,
                            int                           reg_area_nr_max)
@@ -245,6 +245,17 @@ struct m0_be_reg_area {
 	 * Used to catch credit calculation errors.
 	 */
 	struct m0_be_tx_credit    bra_captured;
+	/**
+	 * M0_BE_REG_AREA_DATA_COPY: place in bra_area for the data of the
+	 * region being captured, if the region lies inside of an already
+	 * captured region. NULL means a new place is allocated.
+	 */
+	char                     *bra_area_reuse;
+	/**
+	 * Number of bytes captured in place of previously captured data
+	 * instead of being copied to a newly allocated place in bra_area.
+	 */
+	m0_bcount_t               bra_area_reused;
 };
 
 /**
@@ -296,6 +307,10 @@ M0_INTERNAL struct m0_be_reg_d *m0_be_reg_area_first(struct m0_be_reg_area *ra);
 M0_INTERNAL struct m0_be_reg_d *
 m0_be_reg_area_next(struct m0_be_reg_area *ra, struct m0_be_reg_d *prev);
 
+/** Returns true iff there is a byte captured in both reg_areas. */
+M0_INTERNAL bool m0_be_reg_area_are_overlapping(struct m0_be_reg_area *ra1,
+						struct m0_be_reg_area *ra2);
+
 #define M0_BE_REG_AREA_FORALL(ra, rd)                   \
 	for ((rd) = m0_be_reg_area_first(ra);           \
 	     (rd) != NULL;                              \
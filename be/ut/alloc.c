@@ -635,6 +635,97 @@ M0_INTERNAL void m0_be_ut_alloc_align(void)
 	M0_SET0(ut_be);
 }
 
+static void be_ut_alloc_cache_totals(struct m0_be_allocator *a,
+				     uint64_t               *put,
+				     uint64_t               *hit,
+				     uint64_t               *nr)
+{
+	struct m0_be_alloc_cache *cache;
+	int                       i;
+	int                       j;
+
+	*put = *hit = *nr = 0;
+	for (i = 0; i < ARRAY_SIZE(a->ba_cache); ++i) {
+		cache = &a->ba_cache[i];
+		m0_mutex_lock(&cache->bca_lock);
+		*put += cache->bca_put;
+		*hit += cache->bca_hit;
+		for (j = 0; j < ARRAY_SIZE(cache->bca_class); ++j)
+			*nr += cache->bca_class[j].bcc_nr;
+		m0_mutex_unlock(&cache->bca_lock);
+	}
+}
+
+M0_INTERNAL void m0_be_ut_alloc_cache(void)
+{
+	struct m0_be_ut_backend *ut_be = &be_ut_alloc_backend;
+	struct m0_be_ut_seg      ut_seg;
+	struct m0_be_allocator  *a;
+	void                    *ptrs[BE_UT_ALLOC_PTR_NR];
+	m0_bcount_t              size = 100;
+	uint64_t                 put;
+	uint64_t                 hit;
+	uint64_t                 nr;
+	int                      rc;
+	int                      round;
+	int                      i;
+
+	m0_be_ut_backend_init(ut_be);
+	m0_be_ut_seg_init(&ut_seg, ut_be, BE_UT_ALLOC_SEG_SIZE);
+	/* The segment is too small for the caches to be used otherwise. */
+	m0_fi_enable("m0_be_allocator_init", "cache_force");
+	m0_be_ut_seg_allocator_init(&ut_seg, ut_be);
+	m0_fi_disable("m0_be_allocator_init", "cache_force");
+	a = m0_be_seg_allocator(ut_seg.bus_seg);
+
+	for (round = 0; round < 2; ++round) {
+		for (i = 0; i < ARRAY_SIZE(ptrs); ++i) {
+			M0_BE_UT_TRANSACT(ut_be, tx, cred,
+				(m0_be_allocator_credit(a, M0_BAO_ALLOC, size,
+							0, &cred),
+				 m0_be_tx_credit_add(&cred,
+					&M0_BE_TX_CREDIT(1, size))),
+				(M0_BE_OP_SYNC(op, m0_be_alloc(a, tx, &op,
+							       &ptrs[i], size)),
+				 M0_UT_ASSERT(ptrs[i] != NULL),
+				 /* chunks taken from the caches are zeroed */
+				 M0_UT_ASSERT(m0_forall(j, size,
+					((char *)ptrs[i])[j] == 0)),
+				 memset(ptrs[i], 0xCC, size),
+				 m0_be_tx_capture(tx, &M0_BE_REG(ut_seg.bus_seg,
+							size, ptrs[i]))));
+		}
+		if (round > 0) {
+			be_ut_alloc_cache_totals(a, &put, &hit, &nr);
+			M0_UT_ASSERT(hit + nr == put);
+		}
+		for (i = 0; i < ARRAY_SIZE(ptrs); ++i) {
+			M0_BE_UT_TRANSACT(ut_be, tx, cred,
+				m0_be_allocator_credit(a, M0_BAO_FREE, size, 0,
+						       &cred),
+				M0_BE_OP_SYNC(op, m0_be_free(a, tx, &op,
+							     ptrs[i])));
+		}
+		be_ut_alloc_cache_totals(a, &put, &hit, &nr);
+		M0_UT_ASSERT(put > 0 && nr > 0);
+	}
+
+	/*
+	 * Chunks which are still cached become orphans after the allocator is
+	 * re-initialised, m0_be_allocator_destroy() has to reclaim them.
+	 */
+	m0_be_allocator_fini(a);
+	rc = m0_be_allocator_init(a, ut_seg.bus_seg);
+	M0_UT_ASSERT(rc == 0);
+	be_ut_alloc_cache_totals(a, &put, &hit, &nr);
+	M0_UT_ASSERT(put == 0 && nr == 0);
+
+	m0_be_ut_seg_allocator_fini(&ut_seg, ut_be);
+	m0_be_ut_seg_fini(&ut_seg);
+	m0_be_ut_backend_fini(ut_be);
+	M0_SET0(ut_be);
+}
+
 #undef M0_TRACE_SUBSYSTEM
 
 /*
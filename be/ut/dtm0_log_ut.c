@@ -561,6 +561,111 @@ static void persistent_log_operate(struct m0_be_dtm0_log *log)
 
  }
 
+static void plog_update_sync(struct m0_be_dtm0_log  *log,
+			     struct m0_dtm0_tx_desc *txd,
+			     struct m0_buf          *buf)
+{
+	struct m0_be_tx_credit cred = {};
+	struct m0_be_tx        tx = {};
+	int                    rc;
+
+	m0_be_dtm0_log_credit(M0_DTML_EXECUTED, txd, buf, seg, NULL, &cred);
+	m0_be_ut_tx_init(&tx, ut_be);
+	m0_be_tx_prep(&tx, &cred);
+	rc = m0_be_tx_open_sync(&tx);
+	M0_UT_ASSERT(rc == 0);
+	m0_mutex_lock(&log->dl_lock);
+	rc = m0_be_dtm0_log_update(log, &tx, txd, buf);
+	m0_mutex_unlock(&log->dl_lock);
+	M0_UT_ASSERT(rc == 0);
+	m0_be_tx_close_sync(&tx);
+	m0_be_tx_fini(&tx);
+}
+
+static uint32_t plog_prune_bulk_sync(struct m0_be_dtm0_log   *log,
+				     const struct m0_dtm0_ts *horizon,
+				     uint32_t                 max)
+{
+	struct m0_be_tx_credit cred = {};
+	struct m0_be_tx        tx = {};
+	uint32_t               nr;
+	uint32_t               pruned;
+	int                    rc;
+
+	m0_mutex_lock(&log->dl_lock);
+	nr = m0_be_dtm0_plog_prune_bulk_credit(log, horizon, max, &cred);
+	m0_mutex_unlock(&log->dl_lock);
+	if (nr == 0)
+		return 0;
+	m0_be_ut_tx_init(&tx, ut_be);
+	m0_be_tx_prep(&tx, &cred);
+	rc = m0_be_tx_open_sync(&tx);
+	M0_UT_ASSERT(rc == 0);
+	m0_mutex_lock(&log->dl_lock);
+	pruned = m0_be_dtm0_plog_prune_bulk(log, &tx, horizon, nr);
+	m0_mutex_unlock(&log->dl_lock);
+	m0_be_tx_close_sync(&tx);
+	m0_be_tx_fini(&tx);
+	M0_UT_ASSERT(pruned == nr);
+	return pruned;
+}
+
+/*
+ * Records 0..9 have timestamps 1..10. All of them but the "hole" are
+ * persistent on all participants. Bulk pruning must stop at the horizon, at
+ * the hole and at the given limit.
+ */
+static void persistent_log_prune_bulk(struct m0_be_dtm0_log *log)
+{
+	enum { HOLE = 5 };
+	struct m0_dtm0_tx_desc  txd[UT_DTM0_LOG_MAX_LOG_REC];
+	struct m0_buf           buf[UT_DTM0_LOG_MAX_LOG_REC] = {};
+	struct m0_dtm0_ts       horizon = {};
+	struct m0_dtm0_log_rec *rec;
+	int                     i;
+	int                     j;
+	int                     rc;
+
+	for (i = 0; i < UT_DTM0_LOG_MAX_LOG_REC; ++i) {
+		rc = ut_dl_init(&txd[i], &buf[i], i);
+		M0_UT_ASSERT(rc == 0);
+		for (j = 0; j < txd[i].dtd_ps.dtp_nr; ++j)
+			p_state_set(&txd[i].dtd_ps.dtp_pa[j],
+				    i == HOLE && j == 0 ? M0_DTPS_EXECUTED :
+				    M0_DTPS_PERSISTENT);
+		plog_update_sync(log, &txd[i], &buf[i]);
+	}
+
+	/* Only records with ts 1..3 are below the horizon, take 2 of them. */
+	horizon.dts_phys = 4;
+	M0_UT_ASSERT(plog_prune_bulk_sync(log, &horizon, 2) == 2);
+	M0_UT_ASSERT(plog_prune_bulk_sync(log, &horizon, 2) == 1);
+	M0_UT_ASSERT(plog_prune_bulk_sync(log, &horizon, 2) == 0);
+
+	/* The hole stops pruning. */
+	horizon.dts_phys = UT_DTM0_LOG_MAX_LOG_REC + 1;
+	M0_UT_ASSERT(plog_prune_bulk_sync(log, &horizon, ~0) == HOLE - 3);
+	m0_mutex_lock(&log->dl_lock);
+	for (i = 0; i < UT_DTM0_LOG_MAX_LOG_REC; ++i) {
+		rec = m0_be_dtm0_log_find(log, &txd[i].dtd_id);
+		M0_UT_ASSERT((rec == NULL) == (i < HOLE));
+	}
+	m0_mutex_unlock(&log->dl_lock);
+
+	p_state_set(&txd[HOLE].dtd_ps.dtp_pa[0], M0_DTPS_PERSISTENT);
+	plog_update_sync(log, &txd[HOLE], &buf[HOLE]);
+	M0_UT_ASSERT(plog_prune_bulk_sync(log, &horizon, ~0) ==
+		     UT_DTM0_LOG_MAX_LOG_REC - HOLE);
+	m0_mutex_lock(&log->dl_lock);
+	M0_UT_ASSERT(m0_forall(k, UT_DTM0_LOG_MAX_LOG_REC,
+			       m0_be_dtm0_log_find(log, &txd[k].dtd_id) ==
+			       NULL));
+	m0_mutex_unlock(&log->dl_lock);
+
+	for (i = 0; i < UT_DTM0_LOG_MAX_LOG_REC; ++i)
+		ut_dl_fini(&txd[i], &buf[i]);
+}
+
 static void dtm0_log_check(const struct m0_be_dtm0_log *log)
 {
 }
@@ -591,6 +696,8 @@ static void m0_be_ut_dtm0_log_test(void)
 	m0_be_ut_seg_reload(ut_seg);
 	m0_be_dtm0_log_init(log, seg, &cs, true);
 
+	persistent_log_prune_bulk(log);
+
 	dtm0_log_check(log);
 	persistent_log_destroy(log);
 
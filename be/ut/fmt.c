@@ -685,6 +685,119 @@ Motr panic reason: signo: 11
 	}
 }
 
+enum {
+	BE_UT_FMT_GROUP_COMPRESS_REG_NR   = 0x10,
+	BE_UT_FMT_GROUP_COMPRESS_REG_SIZE = 0x400,
+};
+
+/*
+ * Checks that compressed group is decoded to the same regions and that
+ * incompressible or truncated region data is handled.
+ */
+void m0_be_ut_fmt_group_compress(void)
+{
+	enum {
+		REG_NR   = BE_UT_FMT_GROUP_COMPRESS_REG_NR,
+		REG_SIZE = BE_UT_FMT_GROUP_COMPRESS_REG_SIZE,
+	};
+	struct m0_be_fmt_group_cfg  cfg = CFG(1, REG_NR, 0x10,
+					      REG_NR * REG_SIZE);
+	struct m0_be_fmt_group      group = {};
+	struct m0_be_fmt_group     *group_decoded;
+	struct m0_be_fmt_reg        freg;
+	struct m0_buf               encoded;
+	struct m0_buf               buf;
+	struct m0_bufvec            bvec_encoded;
+	struct m0_bufvec_cursor     cur_encoded;
+	m0_bcount_t                 size;
+	uint64_t                    seed = 42;
+	uint64_t                    payload = 0;
+	unsigned char              *data;
+	bool                        compressed;
+	int                         rc;
+	int                         i;
+	int                         j;
+
+	data = m0_alloc(REG_NR * REG_SIZE);
+	M0_UT_ASSERT(data != NULL);
+	rc = m0_buf_alloc(&buf, m0_be_fmt_group_compress_buf_size(&cfg));
+	M0_UT_ASSERT(rc == 0);
+	size = m0_be_fmt_group_size_max(&cfg);
+	rc = m0_buf_alloc(&encoded, size);
+	M0_UT_ASSERT(rc == 0);
+	bvec_encoded = M0_BUFVEC_INIT_BUF(&encoded.b_addr, &encoded.b_nob);
+	rc = m0_be_fmt_group_init(&group, &cfg);
+	M0_UT_ASSERT(rc == 0);
+
+	/* i == 0: compressible, i == 1: random, i == 2: too small */
+	for (i = 0; i < 3; ++i) {
+		for (j = 0; j < REG_NR * REG_SIZE; ++j)
+			data[j] = i == 1 ? m0_rnd64(&seed) :
+				  j % 3 == 0 ? j / REG_SIZE : 0;
+		m0_be_fmt_group_tx_add(&group, &TX(&payload, sizeof payload,
+						   1));
+		for (j = 0; j < (i == 2 ? 1 : REG_NR); ++j) {
+			m0_be_fmt_group_reg_add(&group,
+				&REG(i == 2 ? 0x10 : REG_SIZE - j,
+				     (void *)(0x400000000000ULL + j * REG_SIZE),
+				     data + j * REG_SIZE));
+		}
+		size = m0_be_fmt_group_size(&group);
+		compressed = m0_be_fmt_group_compress(&group, &buf);
+		M0_UT_ASSERT(compressed == (i == 0));
+		M0_UT_ASSERT(compressed ==
+			     m0_be_fmt_group_is_compressed(&group));
+		M0_UT_ASSERT(m0_be_fmt_group_sanity_check(&group));
+		M0_UT_ASSERT(ergo(compressed,
+				  m0_be_fmt_group_size(&group) < size / 4));
+
+		m0_bufvec_cursor_init(&cur_encoded, &bvec_encoded);
+		rc = m0_be_fmt_group_encode(&group, &cur_encoded);
+		M0_UT_ASSERT(rc == 0);
+		m0_bufvec_cursor_init(&cur_encoded, &bvec_encoded);
+		rc = m0_be_fmt_group_decode(&group_decoded, &cur_encoded,
+					    M0_BE_FMT_DECODE_CFG_DEFAULT);
+		M0_UT_ASSERT(rc == 0);
+		M0_UT_ASSERT(m0_be_fmt_group_is_compressed(group_decoded) ==
+			     compressed);
+		rc = m0_be_fmt_group_decompress(group_decoded);
+		M0_UT_ASSERT(rc == 0);
+		M0_UT_ASSERT(!m0_be_fmt_group_is_compressed(group_decoded));
+		M0_UT_ASSERT(m0_be_fmt_group_reg_nr(group_decoded) ==
+			     m0_be_fmt_group_reg_nr(&group));
+		for (j = 0; j < m0_be_fmt_group_reg_nr(group_decoded); ++j) {
+			m0_be_fmt_group_reg_by_id(group_decoded, j, &freg);
+			M0_UT_ASSERT(freg.fr_addr ==
+				     (void *)(0x400000000000ULL +
+					      j * REG_SIZE));
+			M0_UT_ASSERT(memcmp(freg.fr_buf, data + j * REG_SIZE,
+					    freg.fr_size) == 0);
+		}
+		m0_be_fmt_group_decoded_free(group_decoded);
+
+		if (compressed) {
+			/* truncated compressed data */
+			m0_bufvec_cursor_init(&cur_encoded, &bvec_encoded);
+			rc = m0_be_fmt_group_decode(&group_decoded,
+						    &cur_encoded,
+						M0_BE_FMT_DECODE_CFG_DEFAULT);
+			M0_UT_ASSERT(rc == 0);
+			--group_decoded->fg_content.fmc_reg_area.cra_reg[0].
+				b_nob;
+			rc = m0_be_fmt_group_decompress(group_decoded);
+			M0_UT_ASSERT(rc == -EPROTO);
+			m0_be_fmt_group_decoded_free(group_decoded);
+		}
+		m0_be_fmt_group_reset(&group);
+		M0_UT_ASSERT(!m0_be_fmt_group_is_compressed(&group));
+	}
+
+	m0_be_fmt_group_fini(&group);
+	m0_buf_free(&encoded);
+	m0_buf_free(&buf);
+	m0_free(data);
+}
+
 /** @} end of be group */
 
 #undef M0_TRACE_SUBSYSTEM
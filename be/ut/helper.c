@@ -312,6 +312,7 @@ void m0_be_ut_backend_cfg_default(struct m0_be_domain_cfg *cfg)
 			},
 			.lc_sched_cfg = {
 				.lsch_io_sched_cfg = {
+					.bisc_io_nr_max = 4,
 				},
 			},
 			.lc_full_threshold = 20 * (1 << 20),
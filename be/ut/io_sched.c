@@ -66,6 +66,7 @@ struct be_ut_io_sched_io_state {
 	enum be_ut_io_sched_io_op  sis_op;
 	m0_time_t                  sis_time;
 	struct m0_be_io           *sis_io;
+	struct m0_ext              sis_ext;
 	/* TODO dependencies etc. */
 };
 
@@ -107,6 +108,8 @@ struct be_ut_io_sched_test {
 	struct m0_atomic64                st_io_ready_pos_del;
 	struct m0_semaphore               st_io_ready_sem;
 	struct m0_atomic64               *st_ext_index;
+	/* every st_barrier_mod-th I/O has barrier enabled, 0 - none */
+	int                               st_barrier_mod;
 };
 
 static struct m0_be_io_sched  be_ut_io_sched_scheduler;
@@ -166,6 +169,7 @@ static void be_ut_io_sched_io_completion_cb(struct m0_be_op *op, void *param)
 		.sis_op   = BE_UT_IO_SCHED_IO_FINISH,
 		.sis_time = m0_time_now(),
 		.sis_io   = bio,
+		.sis_ext  = bio->bio_ext,
 	};
 	be_ut_io_sched_io_state_add(test, &io_state);
 	be_ut_io_sched_io_ready_add(test, bio, op);
@@ -178,6 +182,7 @@ static void be_ut_io_sched_io_start_cb(struct m0_be_op *op, void *param)
 		.sis_op   = BE_UT_IO_SCHED_IO_START,
 		.sis_time = m0_time_now(),
 		.sis_io   = bio,
+		.sis_ext  = bio->bio_ext,
 	};
 	be_ut_io_sched_io_state_add(m0_be_io_user_data(bio), &io_state);
 }
@@ -233,6 +238,8 @@ static void be_ut_io_sched_thread(void *param)
 		m0_be_io_add(bio, stob, &test->st_data, offset,
 			     sizeof(test->st_data));
 		m0_be_io_configure(bio, SIO_WRITE);
+		if (test->st_barrier_mod != 0 && i % test->st_barrier_mod == 0)
+			m0_be_io_barrier_enable(bio);
 		len = m0_rnd64(&test->st_seed) % BE_UT_IO_SCHED_EXT_SIZE_MAX +
 		      (m0_rnd64(&test->st_seed) & 0xff) + 1;
 		ext.e_end   = m0_atomic64_add_return(test->st_ext_index, len);
@@ -260,9 +267,22 @@ be_ut_io_sched_states_check(struct be_ut_io_sched_io_state *states,
 			     int                            states_nr,
 			     struct m0_atomic64            *states_pos)
 {
-	int pos = m0_atomic64_get(states_pos);
+	m0_bcount_t pos_start  = 0;
+	m0_bcount_t pos_finish = 0;
+	int         pos = m0_atomic64_get(states_pos);
+	int         i;
 
 	M0_UT_ASSERT(pos == states_nr);
+	/* I/Os are launched and finished in m0_ext order */
+	for (i = 0; i < states_nr; ++i) {
+		if (states[i].sis_op == BE_UT_IO_SCHED_IO_START) {
+			M0_UT_ASSERT(pos_start <= states[i].sis_ext.e_start);
+			pos_start = states[i].sis_ext.e_end;
+		} else {
+			M0_UT_ASSERT(pos_finish <= states[i].sis_ext.e_start);
+			pos_finish = states[i].sis_ext.e_end;
+		}
+	}
 	/* TODO additional checks */
 }
 
@@ -278,15 +298,16 @@ M0_UT_THREADS_DEFINE(be_ut_io_sched, &be_ut_io_sched_thread);
  * 3) Checks that all start and completion callbacks for m0_be_io was called
  * in the right order.
  *
- * @note Currently m0_be_io_sched executes m0_be_io one by one in the
+ * @note m0_be_io_sched launches up to io_nr_max m0_be_io at a time in the
  * order they are added to the scheduler queue.
  */
-void m0_be_ut_io_sched(void)
+static void be_ut_io_sched_run(uint32_t io_nr_max, int barrier_mod)
 {
 	struct be_ut_io_sched_io_state *states;
 	struct be_ut_io_sched_test     *tests;
 	struct m0_be_io_sched_cfg       cfg = {
 		.bisc_pos_start = 0x1234,
+		.bisc_io_nr_max = io_nr_max,
 	};
 	struct m0_be_io_sched          *sched = &be_ut_io_sched_scheduler;
 	struct m0_atomic64              states_pos;
@@ -317,6 +338,7 @@ void m0_be_ut_io_sched(void)
 			.st_states_nr    = states_nr,
 			.st_states_pos   = &states_pos,
 			.st_ext_index    = &ext_index,
+			.st_barrier_mod  = barrier_mod,
 		};
 	}
 
@@ -334,6 +356,21 @@ void m0_be_ut_io_sched(void)
 	m0_free(tests);
 }
 
+void m0_be_ut_io_sched(void)
+{
+	be_ut_io_sched_run(1, 0);
+}
+
+/**
+ * The same as m0_be_ut_io_sched(), but several I/Os are in flight at the same
+ * time and some of them are barriers.
+ */
+void m0_be_ut_io_sched_parallel(void)
+{
+	be_ut_io_sched_run(8, 0);
+	be_ut_io_sched_run(8, 5);
+}
+
 /** @} end of be group */
 #undef M0_TRACE_SUBSYSTEM
 
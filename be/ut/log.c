@@ -676,6 +676,57 @@ void m0_be_ut_log_api(void)
 	m0_mutex_fini(&lock);
 }
 
+/* Resize is applied when the log is drained, the new size survives reopen. */
+void m0_be_ut_log_resize(void)
+{
+	struct m0_be_log_record record = {};
+	struct m0_be_op         op     = {};
+	struct m0_be_log        log    = {};
+	struct m0_mutex         lock   = {};
+	m0_bcount_t             buf_size;
+	m0_bcount_t             size;
+	m0_bindex_t             index;
+	int                     rc;
+
+	m0_mutex_init(&lock);
+	be_ut_log_init(&log, &lock);
+	buf_size = m0_be_log_store_buf_size(&log.lg_store);
+
+	m0_mutex_lock(&lock);
+	rc = m0_be_log_resize(&log, 1);
+	M0_UT_ASSERT(rc == -EINVAL);
+	m0_mutex_unlock(&lock);
+
+	be_ut_log_record_write_sync(&log, &lock, &index, &size);
+	be_ut_log_record_init_write_one(&record, &log, &lock, &op);
+	m0_mutex_lock(&lock);
+	rc = m0_be_log_resize(&log, BE_UT_LOG_SIZE * 2);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_be_log_resize_is_pending(&log));
+	rc = m0_be_log_resize(&log, BE_UT_LOG_SIZE * 2);
+	M0_UT_ASSERT(rc == -EBUSY);
+	/* new reservations wait for the resize */
+	rc = m0_be_log_reserve(&log, 1 << m0_be_log_bshift(&log));
+	M0_UT_ASSERT(rc == -EAGAIN);
+	m0_mutex_unlock(&lock);
+	be_ut_log_record_wait_fini_one(&record, &lock, &op, true);
+
+	M0_UT_ASSERT(!m0_be_log_resize_is_pending(&log));
+	M0_UT_ASSERT(m0_be_log_store_buf_size(&log.lg_store) > buf_size);
+	buf_size = m0_be_log_store_buf_size(&log.lg_store);
+	be_ut_log_record_write_sync(&log, &lock, &index, &size);
+
+	m0_be_log_close(&log);
+	rc = be_ut_log_open(&log, &lock);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_be_log_store_buf_size(&log.lg_store) == buf_size);
+	be_ut_log_curr_pos_check(&log, index);
+	be_ut_log_recover_and_discard(&log, &lock);
+
+	be_ut_log_fini(&log);
+	m0_mutex_fini(&lock);
+}
+
 /* Simple UT shows example of log usage. */
 void m0_be_ut_log_user(void)
 {
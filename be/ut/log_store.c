@@ -263,6 +263,8 @@ enum {
 	BE_UT_LOG_STORE_NR              = 0x10,
 	BE_UT_LOG_STORE_RBUF_NR         = 0x8,
 	BE_UT_LOG_STORE_RBUF_SIZE       = 0x456,
+	BE_UT_LOG_STORE_STRIPE_NR       = 0x3,
+	BE_UT_LOG_STORE_STRIPE_UNIT     = 0x1000,
 };
 
 #define BE_UT_LOG_STORE_SDOM_INIT_CFG "directio=true"
@@ -410,8 +412,9 @@ void m0_be_ut_log_store_create_random(void)
 }
 
 static void
-be_ut_log_store_test(void (*func)(struct m0_be_log_store *ls,
-				  bool                    first_run))
+be_ut_log_store_test_striped(void (*func)(struct m0_be_log_store *ls,
+					  bool                    first_run),
+			     unsigned stripe_nr)
 {
 	struct m0_be_log_store_cfg ls_cfg = be_ut_log_store_cfg;
 	struct m0_be_log_store     ls     = {};
@@ -419,6 +422,10 @@ be_ut_log_store_test(void (*func)(struct m0_be_log_store *ls,
 	int                        rc;
 	int                        i;
 
+	if (stripe_nr > 1) {
+		ls_cfg.lsc_stripe_nr   = stripe_nr;
+		ls_cfg.lsc_stripe_unit = BE_UT_LOG_STORE_STRIPE_UNIT;
+	}
 	be_ut_log_store_stob_domain_init(&sdom);
 
 	m0_stob_id_make(0, BE_UT_LOG_STORE_STOB_KEY_BEGIN,
@@ -438,6 +445,13 @@ be_ut_log_store_test(void (*func)(struct m0_be_log_store *ls,
 	be_ut_log_store_stob_domain_fini(sdom);
 }
 
+static void
+be_ut_log_store_test(void (*func)(struct m0_be_log_store *ls,
+				  bool                    first_run))
+{
+	be_ut_log_store_test_striped(func, 1);
+}
+
 enum {
 	BE_UT_LOG_STORE_IO_WINDOW_STEP    = 0x1,
 	BE_UT_LOG_STORE_IO_WINDOW_STEP_NR = 0x100000,
@@ -736,6 +750,56 @@ void m0_be_ut_log_store_rbuf(void)
 	be_ut_log_store_test(&be_ut_log_store_rbuf);
 }
 
+void m0_be_ut_log_store_stripe(void)
+{
+	be_ut_log_store_test_striped(&be_ut_log_store_io_translate,
+				     BE_UT_LOG_STORE_STRIPE_NR);
+	be_ut_log_store_test_striped(&be_ut_log_store_rbuf,
+				     BE_UT_LOG_STORE_STRIPE_NR);
+}
+
+static void be_ut_log_store_resize(struct m0_be_log_store *ls,
+				   bool                    first_run)
+{
+	m0_bcount_t buf_size = m0_be_log_store_buf_size(ls);
+	m0_bcount_t new_size;
+	m0_bindex_t base = ls->ls_header.fsh_cbuf_base;
+	m0_bindex_t position;
+	m0_bcount_t length;
+	int         rc;
+
+	if (!first_run) {
+		/* the new size survives close/open */
+		M0_UT_ASSERT(base > 0);
+		rc = m0_be_log_store_io_window(ls, base, &length);
+		M0_UT_ASSERT(rc == 0);
+		M0_UT_ASSERT(length == buf_size);
+		return;
+	}
+	rc = m0_be_log_store_resize_check(ls, 1, NULL);
+	M0_UT_ASSERT(rc == -EINVAL);
+
+	new_size = ls->ls_header.fsh_size * 2;
+	position = m0_round_down(buf_size / 2,
+				 1ULL << m0_be_log_store_bshift(ls));
+	rc = m0_be_log_store_resize(ls, new_size, position);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_be_log_store_buf_size(ls) > buf_size);
+	M0_UT_ASSERT(ls->ls_header.fsh_cbuf_base == position);
+	rc = m0_be_log_store_io_window(ls, position, &length);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(length == m0_be_log_store_buf_size(ls));
+	/* nothing before the new base could be overwritten */
+	M0_UT_ASSERT(!m0_be_log_store_overwrites(ls, 0, 1, position));
+}
+
+void m0_be_ut_log_store_resize(void)
+{
+	be_ut_log_store_test(&be_ut_log_store_resize);
+	be_ut_log_store_test_striped(&be_ut_log_store_resize,
+				     BE_UT_LOG_STORE_STRIPE_NR);
+}
+
 /* @todo test rbuf and cbuf intersections on a backing storage */
 
 #undef M0_TRACE_SUBSYSTEM
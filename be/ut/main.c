@@ -56,16 +56,20 @@ extern void m0_be_ut_regmap_simple(void);
 extern void m0_be_ut_regmap_random(void);
 extern void m0_be_ut_reg_area_simple(void);
 extern void m0_be_ut_reg_area_random(void);
+extern void m0_be_ut_reg_area_reuse(void);
 extern void m0_be_ut_reg_area_merge(void);
+extern void m0_be_ut_reg_area_overlap(void);
 
 extern void m0_be_ut_fmt_log_header(void);
 extern void m0_be_ut_fmt_cblock(void);
 extern void m0_be_ut_fmt_group(void);
 extern void m0_be_ut_fmt_group_size_max(void);
 extern void m0_be_ut_fmt_group_size_max_rnd(void);
+extern void m0_be_ut_fmt_group_compress(void);
 
 extern void m0_be_ut_io(void);
 extern void m0_be_ut_io_sched(void);
+extern void m0_be_ut_io_sched_parallel(void);
 
 extern void m0_be_ut_log_store_create_simple(void);
 extern void m0_be_ut_log_store_create_random(void);
@@ -73,6 +77,8 @@ extern void m0_be_ut_log_store_io_window(void);
 extern void m0_be_ut_log_store_io_discard(void);
 extern void m0_be_ut_log_store_io_translate(void);
 extern void m0_be_ut_log_store_rbuf(void);
+extern void m0_be_ut_log_store_stripe(void);
+extern void m0_be_ut_log_store_resize(void);
 
 extern void m0_be_ut_log_sched(void);
 
@@ -82,6 +88,7 @@ extern void m0_be_ut_log_discard_getput(void);
 extern void m0_be_ut_log_user(void);
 extern void m0_be_ut_log_api(void);
 extern void m0_be_ut_log_header(void);
+extern void m0_be_ut_log_resize(void);
 extern void m0_be_ut_log_unplaced(void);
 extern void m0_be_ut_log_multi(void);
 
@@ -91,6 +98,7 @@ extern void m0_be_ut_pd_usecase(void);
 
 extern void m0_be_ut_seg_open_close(void);
 extern void m0_be_ut_seg_io(void);
+extern void m0_be_ut_seg_map(void);
 extern void m0_be_ut_seg_multiple(void);
 extern void m0_be_ut_seg_large(void);
 extern void m0_be_ut_seg_large_multiple(void);
@@ -113,6 +121,7 @@ extern void m0_be_ut_tx_persistence(void);
 extern void m0_be_ut_tx_fast(void);
 extern void m0_be_ut_tx_concurrent(void);
 extern void m0_be_ut_tx_concurrent_excl(void);
+extern void m0_be_ut_tx_concurrent_adaptive(void);
 extern void m0_be_ut_tx_force(void);
 extern void m0_be_ut_tx_gc(void);
 extern void m0_be_ut_tx_payload(void);
@@ -131,6 +140,7 @@ extern void m0_be_ut_tx_bulk_medium_tx_multi(void);
 extern void m0_be_ut_tx_bulk_medium_cred(void);
 extern void m0_be_ut_tx_bulk_large_cred(void);
 extern void m0_be_ut_tx_bulk_parallel_1_15(void);
+extern void m0_be_ut_tx_bulk_autotune(void);
 
 extern void m0_be_ut_fl(void);
 
@@ -142,6 +152,7 @@ extern void m0_be_ut_alloc_oom(void);
 extern void m0_be_ut_alloc_info(void);
 extern void m0_be_ut_alloc_spare(void);
 extern void m0_be_ut_alloc_align(void);
+extern void m0_be_ut_alloc_cache(void);
 
 extern void m0_be_ut_list(void);
 extern void m0_be_ut_emap(void);
@@ -160,7 +171,8 @@ struct m0_ut_suite be_ut = {
 				 "  exclude:  ["
 				 "    emap,"
 				 "    tx-concurrent,"
-				 "    tx-concurrent-excl"
+				 "    tx-concurrent-excl,"
+				 "    tx-concurrent-adaptive"
 				 "  ] }",
 	.ts_init = NULL,
 	.ts_fini = NULL,
@@ -188,26 +200,33 @@ struct m0_ut_suite be_ut = {
 // XXX		{ "regmap-random",           m0_be_ut_regmap_random           },
 // XXX		{ "reg_area-simple",         m0_be_ut_reg_area_simple         },
 		{ "reg_area-random",         m0_be_ut_reg_area_random         },
+		{ "reg_area-reuse",          m0_be_ut_reg_area_reuse          },
 		{ "reg_area-merge",          m0_be_ut_reg_area_merge          },
+		{ "reg_area-overlap",        m0_be_ut_reg_area_overlap        },
 		{ "fmt-log_header",          m0_be_ut_fmt_log_header          },
 		{ "fmt-cblock",              m0_be_ut_fmt_cblock              },
 		{ "fmt-group",               m0_be_ut_fmt_group               },
 		{ "fmt-group_size_max",      m0_be_ut_fmt_group_size_max      },
 		{ "fmt-group_size_max_rnd",  m0_be_ut_fmt_group_size_max_rnd  },
+		{ "fmt-group_compress",      m0_be_ut_fmt_group_compress      },
 		{ "io-noop",                 m0_be_ut_io                      },
 		{ "io_sched",                m0_be_ut_io_sched                },
+		{ "io_sched-parallel",       m0_be_ut_io_sched_parallel       },
 		{ "log_store-create_simple", m0_be_ut_log_store_create_simple },
 		{ "log_store-create_random", m0_be_ut_log_store_create_random },
 		{ "log_store-io_window",     m0_be_ut_log_store_io_window     },
 		{ "log_store-io_discard",    m0_be_ut_log_store_io_discard    },
 		{ "log_store-io_translate",  m0_be_ut_log_store_io_translate  },
 		{ "log_store-rbuf",          m0_be_ut_log_store_rbuf          },
+		{ "log_store-stripe",        m0_be_ut_log_store_stripe        },
+		{ "log_store-resize",        m0_be_ut_log_store_resize        },
 		{ "log_sched-noop",          m0_be_ut_log_sched               },
 		{ "log_discard-usecase",     m0_be_ut_log_discard_usecase     },
 		{ "log_discard-getput",      m0_be_ut_log_discard_getput      },
 		{ "log-user",                m0_be_ut_log_user                },
 		{ "log-api",                 m0_be_ut_log_api                 },
 		{ "log-header",              m0_be_ut_log_header              },
+		{ "log-resize",              m0_be_ut_log_resize              },
 		{ "log-unplaced",            m0_be_ut_log_unplaced            },
 /* XXX this test writes and discards records in random order
 		{ "log-multi",               m0_be_ut_log_multi               },
@@ -216,6 +235,7 @@ struct m0_ut_suite be_ut = {
 		{ "pd-usecase",              m0_be_ut_pd_usecase              },
 		{ "seg-open",                m0_be_ut_seg_open_close          },
 		{ "seg-io",                  m0_be_ut_seg_io                  },
+		{ "seg-map",                 m0_be_ut_seg_map                 },
 		{ "seg-multiple",            m0_be_ut_seg_multiple            },
 		{ "seg-large",               m0_be_ut_seg_large               },
 		{ "seg-large-multiple",      m0_be_ut_seg_large_multiple      },
@@ -239,6 +259,7 @@ struct m0_ut_suite be_ut = {
 		{ "tx-callback",             m0_be_ut_tx_callback             },
 		{ "tx-concurrent",           m0_be_ut_tx_concurrent           },
 		{ "tx-concurrent-excl",      m0_be_ut_tx_concurrent_excl      },
+		{ "tx-concurrent-adaptive",  m0_be_ut_tx_concurrent_adaptive  },
 		{ "tx_bulk-usecase",         m0_be_ut_tx_bulk_usecase         },
 		{ "tx_bulk-empty",           m0_be_ut_tx_bulk_empty           },
 		{ "tx_bulk-error_reg",       m0_be_ut_tx_bulk_error_reg       },
@@ -252,6 +273,7 @@ struct m0_ut_suite be_ut = {
 		{ "tx_bulk-medium_cred",     m0_be_ut_tx_bulk_medium_cred     },
 		{ "tx_bulk-large_cred",      m0_be_ut_tx_bulk_large_cred      },
 		{ "tx_bulk-parallel_1_15",   m0_be_ut_tx_bulk_parallel_1_15   },
+		{ "tx_bulk-autotune",        m0_be_ut_tx_bulk_autotune        },
 		{ "fl",                      m0_be_ut_fl                      },
 		{ "alloc-init",              m0_be_ut_alloc_init_fini         },
 		{ "alloc-create",            m0_be_ut_alloc_create_destroy    },
@@ -261,6 +283,7 @@ struct m0_ut_suite be_ut = {
 		{ "alloc-info",              m0_be_ut_alloc_info              },
 		{ "alloc-spare",             m0_be_ut_alloc_spare             },
                 { "alloc-align",             m0_be_ut_alloc_align             },
+		{ "alloc-cache",             m0_be_ut_alloc_cache             },
 		{ "obj",                     m0_be_ut_obj_test                },
 		{ "actrec",                  m0_be_ut_actrec_test             },
 #endif /* __KERNEL__ */
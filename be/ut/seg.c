@@ -122,6 +122,49 @@ M0_INTERNAL void m0_be_ut_seg_io(void)
 	m0_be_ut_seg_fini(&ut_seg);
 }
 
+/*
+ * Writes to the segment stob and checks that the data is seen in memory after
+ * the segment is reopened with different mapping configurations.
+ * M0_BE_SEG_MAP_PAGES_HUGETLB is not tested: it needs huge pages reserved in
+ * the system.
+ */
+M0_INTERNAL void m0_be_ut_seg_map(void)
+{
+	static const struct m0_be_seg_map_cfg cfgs[] = {
+		{ .bsmc_pages = M0_BE_SEG_MAP_PAGES_THP },
+		{ .bsmc_numa  = M0_BE_SEG_MAP_NUMA_INTERLEAVE },
+		{ .bsmc_pages = M0_BE_SEG_MAP_PAGES_THP,
+		  .bsmc_numa  = M0_BE_SEG_MAP_NUMA_BIND,
+		  .bsmc_numa_nodes = 1 },
+		{ .bsmc_pages = M0_BE_SEG_MAP_PAGES_FILE },
+	};
+	static char         data[BE_UT_SEG_IO_SIZE];
+	struct m0_be_ut_seg ut_seg;
+	struct m0_be_seg   *seg;
+	struct m0_be_reg    reg;
+	uint64_t            seed = 0;
+	int                 rc;
+	int                 i;
+	int                 j;
+
+	m0_be_ut_seg_init(&ut_seg, NULL, BE_UT_SEG_SIZE);
+	seg = ut_seg.bus_seg;
+	reg = M0_BE_REG(seg, BE_UT_SEG_IO_SIZE,
+			seg->bs_addr + BE_UT_SEG_IO_OFFS);
+	for (i = 0; i < ARRAY_SIZE(cfgs); ++i) {
+		for (j = 0; j < ARRAY_SIZE(data); ++j)
+			data[j] = m0_rnd64(&seed) & 0xFF;
+		rc = m0_be_seg__write(&reg, data);
+		M0_UT_ASSERT(rc == 0);
+		m0_be_seg_close(seg);
+		seg->bs_map_cfg = cfgs[i];
+		rc = m0_be_seg_open(seg);
+		M0_UT_ASSERT(rc == 0);
+		M0_UT_ASSERT(memcmp(reg.br_addr, data, reg.br_size) == 0);
+	}
+	m0_be_ut_seg_fini(&ut_seg);
+}
+
 enum {
 	BE_UT_SEG_THREAD_NR     = 0x10,
 	BE_UT_SEG_PER_THREAD    = 0x10,
@@ -40,6 +40,7 @@
 #include "ut/ut.h"
 
 #include "be/ut/helper.h"       /* m0_be_ut_backend */
+#include "be/domain.h"          /* m0_be_domain_engine */
 
 void m0_be_ut_tx_usecase_success(void)
 {
@@ -697,15 +698,22 @@ static void be_ut_tx_thread(struct be_ut_tx_thread_state *state)
 	m0_be_ut_backend_thread_exit(state->tts_ut_be);
 }
 
-void m0_be_ut_tx_concurrent_helper(bool exclusive)
+static void be_ut_tx_concurrent_run(bool exclusive, bool adaptive)
 {
 	static struct be_ut_tx_thread_state threads[BE_UT_TX_C_THREAD_NR];
 	struct m0_be_ut_backend             ut_be;
+	struct m0_be_domain_cfg             cfg;
+	struct m0_be_engine_cfg            *en_cfg = &cfg.bc_engine;
+	struct m0_be_engine_adaptive       *ea;
+	struct m0_be_engine_stats           es;
 	int                                 i;
 	int                                 rc;
 
 	M0_SET0(&ut_be);
-	m0_be_ut_backend_init(&ut_be);
+	m0_be_ut_backend_cfg_default(&cfg);
+	en_cfg->bec_group_adaptive = adaptive;
+	rc = m0_be_ut_backend_init_cfg(&ut_be, &cfg, true);
+	M0_UT_ASSERT(rc == 0);
 
 	for (i = 0; i < ARRAY_SIZE(threads); ++i) {
 		threads[i].tts_ut_be     = &ut_be;
@@ -724,10 +732,32 @@ void m0_be_ut_tx_concurrent_helper(bool exclusive)
 		M0_UT_ASSERT(rc == 0);
 		m0_thread_fini(&threads[i].tts_thread);
 	}
+	m0_be_engine_stats_get(m0_be_domain_engine(&ut_be.but_dom), &es);
+	M0_UT_ASSERT(es.es_groups > 0);
+	M0_UT_ASSERT(es.es_tx >= es.es_groups);
+	M0_UT_ASSERT(es.es_tx <= es.es_tx_max);
+	M0_UT_ASSERT(es.es_log_size > 0);
+	if (adaptive) {
+		ea = &m0_be_domain_engine(&ut_be.but_dom)->eng_adaptive;
+		M0_UT_ASSERT(ea->ea_tx_interval > 0);
+		M0_UT_ASSERT(ea->ea_log_latency > 0);
+		M0_UT_ASSERT(ea->ea_tx_target >= 1);
+		M0_UT_ASSERT(ea->ea_tx_target <=
+			     en_cfg->bec_group_cfg.tgc_tx_nr_max);
+		M0_UT_ASSERT(ea->ea_timeout >=
+			     en_cfg->bec_group_freeze_timeout_min);
+		M0_UT_ASSERT(ea->ea_timeout <=
+			     en_cfg->bec_group_freeze_timeout_max);
+	}
 
 	m0_be_ut_backend_fini(&ut_be);
 }
 
+void m0_be_ut_tx_concurrent_helper(bool exclusive)
+{
+	be_ut_tx_concurrent_run(exclusive, false);
+}
+
 void m0_be_ut_tx_concurrent(void)
 {
 	m0_be_ut_tx_concurrent_helper(false);
@@ -738,6 +768,11 @@ void m0_be_ut_tx_concurrent_excl(void)
 	m0_be_ut_tx_concurrent_helper(true);
 }
 
+void m0_be_ut_tx_concurrent_adaptive(void)
+{
+	be_ut_tx_concurrent_run(false, true);
+}
+
 enum {
 	BE_UT_TX_CAPTURING_SEG_SIZE = 0x10000,
 	BE_UT_TX_CAPTURING_TX_NR    = 0x10,
@@ -880,6 +880,154 @@ void m0_be_ut_tx_bulk_parallel_1_15(void)
 
 }
 
+enum {
+	BE_UT_TX_BULK_AUTOTUNE_PARTITIONS_NR = 4,
+	BE_UT_TX_BULK_AUTOTUNE_WORKERS_NR    = 0x10,
+	BE_UT_TX_BULK_AUTOTUNE_ITEMS_PER_TX  = 8,
+	BE_UT_TX_BULK_AUTOTUNE_ITEMS_NR      = 0x2000,
+};
+
+struct be_ut_tx_bulk_autotune {
+	struct m0_be_seg           *bua_seg;
+	uint64_t                   *bua_val;
+	struct m0_mutex             bua_lock;
+	/* the last seen statistics and maximums over the run */
+	struct m0_be_tx_bulk_stats  bua_stats;
+	uint64_t                    bua_items_per_tx_max;
+	uint64_t                    bua_workers_max;
+};
+
+static void be_ut_tx_bulk_autotune_work_put(struct m0_be_tx_bulk *tb,
+                                            bool                  success,
+                                            void                 *ptr)
+{
+	struct be_ut_tx_bulk_autotune *bua = ptr;
+	uint64_t                       partition;
+	uint64_t                       i;
+
+	for (i = 0; i < BE_UT_TX_BULK_AUTOTUNE_ITEMS_NR; ++i) {
+		partition = i % BE_UT_TX_BULK_AUTOTUNE_PARTITIONS_NR;
+		M0_BE_OP_SYNC(op,
+			      m0_be_tx_bulk_put(tb, &op,
+			                        &M0_BE_TX_CREDIT_TYPE(uint64_t),
+			                        0, partition, &bua->bua_val[i]));
+	}
+	m0_be_tx_bulk_end(tb);
+}
+
+static void be_ut_tx_bulk_autotune_do(struct m0_be_tx_bulk *tb,
+                                      struct m0_be_tx      *tx,
+                                      struct m0_be_op      *op,
+                                      void                 *datum,
+                                      void                 *user,
+                                      uint64_t              worker_index,
+                                      uint64_t              partition)
+{
+	struct be_ut_tx_bulk_autotune *bua = datum;
+	uint64_t                      *value = user;
+
+	m0_be_op_active(op);
+	*value = partition;
+	M0_BE_TX_CAPTURE_PTR(bua->bua_seg, tx, value);
+	m0_be_op_done(op);
+}
+
+static void be_ut_tx_bulk_autotune_done(struct m0_be_tx_bulk *tb,
+                                        void                 *datum,
+                                        void                 *user,
+                                        uint64_t              worker_index,
+                                        uint64_t              partition)
+{
+	struct be_ut_tx_bulk_autotune *bua = datum;
+	struct m0_be_tx_bulk_stats     stats;
+
+	m0_be_tx_bulk_stats_get(tb, &stats);
+	m0_mutex_lock(&bua->bua_lock);
+	if (stats.tbs_items_nr > bua->bua_stats.tbs_items_nr)
+		bua->bua_stats = stats;
+	bua->bua_items_per_tx_max = max64u(bua->bua_items_per_tx_max,
+					   stats.tbs_items_per_tx);
+	bua->bua_workers_max = max64u(bua->bua_workers_max,
+				      stats.tbs_workers_per_partition);
+	m0_mutex_unlock(&bua->bua_lock);
+}
+
+static void be_ut_tx_bulk_autotune_test_prepare(struct m0_be_ut_backend *ut_be,
+                                                struct m0_be_ut_seg     *ut_seg,
+                                                void                    *ptr)
+{
+	struct be_ut_tx_bulk_autotune *bua = ptr;
+
+	bua->bua_seg = ut_seg->bus_seg;
+	m0_be_ut_alloc(ut_be, ut_seg, (void **)&bua->bua_val,
+		       BE_UT_TX_BULK_AUTOTUNE_ITEMS_NR *
+		       sizeof(bua->bua_val[0]));
+	M0_UT_ASSERT(bua->bua_val != NULL);
+}
+
+static void be_ut_tx_bulk_autotune_run(struct be_ut_tx_bulk_autotune *bua,
+                                       m0_time_t latency_target)
+{
+	struct be_ut_tx_bulk_be_ctx *be_ctx;
+	struct m0_be_tx_bulk_cfg     tb_cfg = {
+		.tbc_q_cfg                 = {
+			.bqc_q_size_max       = BE_UT_TX_BULK_Q_SIZE_MAX,
+			.bqc_producers_nr_max = 1,
+		},
+		.tbc_workers_nr            = BE_UT_TX_BULK_AUTOTUNE_WORKERS_NR,
+		.tbc_partitions_nr         =
+			BE_UT_TX_BULK_AUTOTUNE_PARTITIONS_NR,
+		.tbc_work_items_per_tx_max =
+			BE_UT_TX_BULK_AUTOTUNE_ITEMS_PER_TX,
+		.tbc_autotune              = true,
+		.tbc_latency_target        = latency_target,
+		.tbc_datum                 = bua,
+		.tbc_do                    = &be_ut_tx_bulk_autotune_do,
+		.tbc_done                  = &be_ut_tx_bulk_autotune_done,
+	};
+	struct m0_be_tx_bulk_stats  *st = &bua->bua_stats;
+
+	m0_mutex_init(&bua->bua_lock);
+	be_ut_tx_bulk_test_init(&be_ctx, NULL,
+	                        &be_ut_tx_bulk_autotune_test_prepare, bua);
+	be_ut_tx_bulk_test_run(be_ctx, &tb_cfg,
+			       &be_ut_tx_bulk_autotune_work_put, bua, true);
+	M0_UT_ASSERT(m0_forall(i, BE_UT_TX_BULK_AUTOTUNE_ITEMS_NR,
+		     bua->bua_val[i] ==
+		     i % BE_UT_TX_BULK_AUTOTUNE_PARTITIONS_NR));
+	be_ut_tx_bulk_test_fini(be_ctx);
+	m0_mutex_fini(&bua->bua_lock);
+
+	M0_UT_ASSERT(st->tbs_items_nr == BE_UT_TX_BULK_AUTOTUNE_ITEMS_NR);
+	M0_UT_ASSERT(st->tbs_tx_nr > 0 && st->tbs_tx_nr <= st->tbs_items_nr);
+	M0_UT_ASSERT(st->tbs_latency_max <= st->tbs_latency_sum);
+	M0_UT_ASSERT(m0_be_tx_bulk_stats_items_per_sec(st) > 0);
+	M0_UT_ASSERT(st->tbs_tune_up_nr + st->tbs_tune_down_nr > 0);
+	M0_UT_ASSERT(bua->bua_items_per_tx_max <=
+		     BE_UT_TX_BULK_AUTOTUNE_ITEMS_PER_TX);
+	M0_UT_ASSERT(bua->bua_workers_max <=
+		     BE_UT_TX_BULK_AUTOTUNE_WORKERS_NR /
+		     BE_UT_TX_BULK_AUTOTUNE_PARTITIONS_NR);
+}
+
+void m0_be_ut_tx_bulk_autotune(void)
+{
+	struct be_ut_tx_bulk_autotune *bua;
+
+	M0_ALLOC_PTR(bua);
+	M0_UT_ASSERT(bua != NULL);
+	/* the target is always met: the limits only grow */
+	be_ut_tx_bulk_autotune_run(bua, M0_TIME_NEVER);
+	M0_UT_ASSERT(bua->bua_stats.tbs_tune_up_nr > 0);
+	/* the target is never met: the limits stay at the minimum */
+	M0_SET0(bua);
+	be_ut_tx_bulk_autotune_run(bua, 1);
+	M0_UT_ASSERT(bua->bua_stats.tbs_tune_up_nr == 0);
+	M0_UT_ASSERT(bua->bua_items_per_tx_max == 1);
+	M0_UT_ASSERT(bua->bua_workers_max == 1);
+	m0_free(bua);
+}
+
 #undef M0_TRACE_SUBSYSTEM
 
 /** @} end of be group */
@@ -802,6 +802,50 @@ void m0_be_ut_reg_area_random(void)
 	m0_be_ut_seg_fini(&ut_seg);
 }
 
+/*
+ * Regions captured inside of already captured regions reuse their place in
+ * the reg_area buffer.
+ */
+void m0_be_ut_reg_area_reuse(void)
+{
+	enum { S = BE_UT_RA_SIZE };
+	struct m0_be_ut_seg ut_seg;
+	struct {
+		bool        capture;
+		m0_bcount_t begin;
+		m0_bcount_t end;
+		m0_bcount_t used;
+		m0_bcount_t reused;
+	} test[] = {
+		{ true,  0,     S,     S,         0          },
+		{ true,  4,     8,     S,         4          },
+		{ true,  0,     S,     S,         S + 4      },
+		{ true,  S - 4, S,     S,         S + 8      },
+		{ true,  0,     1,     S,         S + 9      },
+		{ true,  0,     S / 2, S,         S * 3 / 2 + 9 },
+		/* a hole between captured regions */
+		{ false, 8,     12,    S,         S * 3 / 2 + 9 },
+		{ true,  0,     S / 2, S * 3 / 2, S * 3 / 2 + 9 },
+	};
+	int                 i;
+
+	m0_be_ut_seg_init(&ut_seg, NULL, BE_UT_RA_SEG_SIZE);
+	be_ut_ra_seg = ut_seg.bus_seg;
+	be_ut_ra_rand_seed = 0;
+
+	be_ut_reg_area_init(S * 4 / BE_UT_RA_R_SIZE);
+	for (i = 0; i < ARRAY_SIZE(test); ++i) {
+		be_ut_reg_area_do(test[i].begin, test[i].end, test[i].capture);
+		M0_UT_ASSERT(be_ut_ra_reg_area.bra_area_used == test[i].used);
+		M0_UT_ASSERT(be_ut_ra_reg_area.bra_area_reused ==
+			     test[i].reused);
+	}
+	m0_be_reg_area_reset(&be_ut_ra_reg_area);
+	M0_UT_ASSERT(be_ut_ra_reg_area.bra_area_reused == 0);
+	be_ut_reg_area_fini();
+	m0_be_ut_seg_fini(&ut_seg);
+}
+
 /* backend UT reg area merge. R == region */
 enum {
 	BE_UT_RA_MERGE_SEG_SIZE	   = 0x10000,
@@ -1039,6 +1083,72 @@ void m0_be_ut_reg_area_merge(void)
 	m0_be_ut_seg_fini(&ut_seg);
 }
 
+enum {
+	BE_UT_RA_OVERLAP_SIZE = 0x40,
+	BE_UT_RA_OVERLAP_R_NR = 4,
+	BE_UT_RA_OVERLAP_ITER = 0x1000,
+};
+
+static void be_ut_reg_area_overlap_fill(struct m0_be_reg_area *ra,
+					bool                  *byte,
+					uint64_t              *seed)
+{
+	struct m0_be_reg_d rd;
+	m0_bindex_t        begin;
+	m0_bcount_t        size;
+	int                i;
+
+	m0_be_reg_area_reset(ra);
+	memset(byte, 0, sizeof(bool) * BE_UT_RA_OVERLAP_SIZE);
+	for (i = 0; i < BE_UT_RA_OVERLAP_R_NR; ++i) {
+		begin = m0_rnd64(seed) % BE_UT_RA_OVERLAP_SIZE;
+		size  = m0_rnd64(seed) % (BE_UT_RA_OVERLAP_SIZE - begin) + 1;
+		rd = (struct m0_be_reg_d) {
+			.rd_reg = M0_BE_REG(be_ut_ra_merge_seg, size,
+				    be_ut_reg_area_merge_offs2addr(begin)),
+			.rd_buf = NULL,
+		};
+		m0_be_reg_area_capture(ra, &rd);
+		memset(&byte[begin], 1, sizeof(bool) * size);
+	}
+}
+
+void m0_be_ut_reg_area_overlap(void)
+{
+	struct m0_be_reg_area ra[2];
+	struct m0_be_ut_seg   ut_seg;
+	uint64_t              seed = 42;
+	bool                  byte[2][BE_UT_RA_OVERLAP_SIZE];
+	bool                  overlap;
+	int                   rc;
+	int                   i;
+	int                   j;
+
+	m0_be_ut_seg_init(&ut_seg, NULL, BE_UT_RA_MERGE_SEG_SIZE);
+	be_ut_ra_merge_seg = ut_seg.bus_seg;
+	for (i = 0; i < ARRAY_SIZE(ra); ++i) {
+		/* a region may be split in two by a captured one */
+		rc = m0_be_reg_area_init(&ra[i], &M0_BE_TX_CREDIT(
+				 BE_UT_RA_OVERLAP_R_NR * 2,
+				 BE_UT_RA_OVERLAP_R_NR * BE_UT_RA_OVERLAP_SIZE),
+					 M0_BE_REG_AREA_DATA_COPY);
+		M0_UT_ASSERT(rc == 0);
+	}
+	for (i = 0; i < BE_UT_RA_OVERLAP_ITER; ++i) {
+		for (j = 0; j < ARRAY_SIZE(ra); ++j)
+			be_ut_reg_area_overlap_fill(&ra[j], byte[j], &seed);
+		overlap = m0_exists(k, BE_UT_RA_OVERLAP_SIZE,
+				    byte[0][k] && byte[1][k]);
+		M0_UT_ASSERT(m0_be_reg_area_are_overlapping(&ra[0], &ra[1]) ==
+			     overlap);
+		M0_UT_ASSERT(m0_be_reg_area_are_overlapping(&ra[1], &ra[0]) ==
+			     overlap);
+	}
+	for (i = 0; i < ARRAY_SIZE(ra); ++i)
+		m0_be_reg_area_fini(&ra[i]);
+	m0_be_ut_seg_fini(&ut_seg);
+}
+
 /*
  *  Local variables:
  *  c-indentation-style: "K&R"
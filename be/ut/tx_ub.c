@@ -0,0 +1,452 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2013-2021 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+
+/**
+ * @addtogroup be
+ *
+ * BE transaction benchmark, "be-tx-ub" set of m0ub.
+ *
+ * Every thread opens, captures and closes nr / threads transactions one by
+ * one, waiting until each of them is logged. Benchmarks of the set differ in
+ * the shape of the transactions: number and size of the captured regions.
+ * Regions of a thread do not overlap with regions of other threads and are
+ * captured again by every transaction of the thread.
+ *
+ * Options ("-o name=value,..."):
+ * - threads, nr: number of threads and of transactions of all threads;
+ * - regs, reg_size: override the transaction shape of all benchmarks;
+ * - groups, grp_tx: m0_be_engine_cfg::bec_group_nr and
+ *   m0_be_tx_group_cfg::tgc_tx_nr_max;
+ * - timeout_min, timeout_max: group freeze timeouts, in microseconds;
+ * - adaptive=1: m0_be_engine_cfg::bec_group_adaptive;
+ * - log=null: the log stob is a symlink to /dev/null, so that the engine and
+ *   group code is measured without the log device. Default is log=stob.
+ *
+ * For every benchmark transactions per second, percentiles of the open and
+ * commit (close to logged) latencies, log bandwidth and group fill ratios (by
+ * the number of transactions and by the captured size) are printed.
+ *
+ * @{
+ */
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_UT
+#include "lib/trace.h"
+
+#include <stdio.h>              /* printf */
+#include <stdlib.h>             /* qsort */
+
+#include "lib/arith.h"          /* M0_3WAY */
+#include "lib/misc.h"           /* M0_BITS */
+#include "lib/memory.h"         /* M0_ALLOC_ARR */
+#include "lib/string.h"         /* m0_strdup */
+#include "lib/thread.h"         /* M0_THREAD_INIT */
+#include "lib/errno.h"          /* EINVAL */
+#include "lib/ub.h"
+
+#include "be/ut/helper.h"       /* m0_be_ut_backend */
+#include "be/domain.h"          /* m0_be_domain_engine */
+#include "be/engine.h"          /* m0_be_engine_stats_get */
+
+enum {
+	BE_UB_TX_THREADS  = 4,
+	BE_UB_TX_NR       = 10000,
+	BE_UB_TX_REGS_MAX = 64,
+	BE_UB_TX_REG_MAX  = 4096,
+};
+
+struct be_ub_tx_thread {
+	struct m0_thread  bxt_thread;
+	uint32_t          bxt_idx;
+};
+
+static struct {
+	/* Options. */
+	uint32_t                  bux_threads;
+	uint32_t                  bux_nr;
+	uint32_t                  bux_regs_opt;
+	uint32_t                  bux_reg_size_opt;
+	uint32_t                  bux_groups;
+	uint32_t                  bux_grp_tx;
+	m0_time_t                 bux_timeout_min;
+	m0_time_t                 bux_timeout_max;
+	bool                      bux_adaptive;
+	bool                      bux_null;
+	/* Benchmark. */
+	uint32_t                  bux_regs;
+	uint32_t                  bux_reg_size;
+	struct m0_be_ut_backend   bux_be;
+	struct m0_be_seg         *bux_seg;
+	m0_time_t                *bux_open;
+	m0_time_t                *bux_commit;
+	m0_time_t                 bux_start;
+	m0_time_t                 bux_end;
+	struct m0_be_engine_stats bux_stats;
+} be_ub_tx;
+
+/** Address of the region @reg of the thread @idx. */
+static void *be_ub_tx_reg_addr(uint32_t idx, uint32_t reg)
+{
+	struct m0_be_seg *seg = be_ub_tx.bux_seg;
+
+	/* Regions are not adjacent, otherwise they are merged. */
+	return seg->bs_addr + m0_be_seg_reserved(seg) +
+	       ((m0_bcount_t)idx * BE_UB_TX_REGS_MAX + reg) *
+	       BE_UB_TX_REG_MAX * 2;
+}
+
+static void be_ub_tx_thread(struct be_ub_tx_thread *t)
+{
+	struct m0_be_ut_backend *ut_be = &be_ub_tx.bux_be;
+	struct m0_be_seg        *seg   = be_ub_tx.bux_seg;
+	struct m0_be_tx          tx;
+	struct m0_be_tx_credit   cred;
+	uint32_t                 share = be_ub_tx.bux_nr / be_ub_tx.bux_threads;
+	uint32_t                 size  = be_ub_tx.bux_reg_size;
+	uint32_t                 i;
+	uint32_t                 j;
+	m0_time_t                start;
+	void                    *addr;
+	int                      rc;
+
+	cred = M0_BE_TX_CREDIT(be_ub_tx.bux_regs,
+			       (m0_bcount_t)be_ub_tx.bux_regs * size);
+	for (i = t->bxt_idx * share; i < (t->bxt_idx + 1) * share; i++) {
+		M0_SET0(&tx);
+		m0_be_ut_tx_init(&tx, ut_be);
+		m0_be_tx_prep(&tx, &cred);
+		start = m0_time_now();
+		rc = m0_be_tx_open_sync(&tx);
+		M0_UB_ASSERT(rc == 0);
+		be_ub_tx.bux_open[i] = m0_time_now() - start;
+		for (j = 0; j < be_ub_tx.bux_regs; j++) {
+			addr = be_ub_tx_reg_addr(t->bxt_idx, j);
+			memset(addr, (char)i, size);
+			m0_be_tx_capture(&tx, &M0_BE_REG(seg, size, addr));
+		}
+		start = m0_time_now();
+		m0_be_tx_close(&tx);
+		rc = m0_be_tx_timedwait(&tx, M0_BITS(M0_BTS_LOGGED,
+						     M0_BTS_PLACED,
+						     M0_BTS_DONE),
+					M0_TIME_NEVER);
+		M0_UB_ASSERT(rc == 0);
+		be_ub_tx.bux_commit[i] = m0_time_now() - start;
+		rc = m0_be_tx_timedwait(&tx, M0_BITS(M0_BTS_DONE),
+					M0_TIME_NEVER);
+		M0_UB_ASSERT(rc == 0);
+		m0_be_tx_fini(&tx);
+	}
+	m0_be_ut_backend_thread_exit(ut_be);
+}
+
+static void be_ub_tx_round(int iter)
+{
+	struct m0_be_engine    *en;
+	struct be_ub_tx_thread *t;
+	uint32_t                i;
+	int                     rc;
+
+	en = m0_be_domain_engine(&be_ub_tx.bux_be.but_dom);
+	M0_ALLOC_ARR(t, be_ub_tx.bux_threads);
+	M0_UB_ASSERT(t != NULL);
+
+	m0_be_engine_stats_get(en, &be_ub_tx.bux_stats);
+	be_ub_tx.bux_start = m0_time_now();
+	for (i = 0; i < be_ub_tx.bux_threads; i++) {
+		t[i].bxt_idx = i;
+		rc = M0_THREAD_INIT(&t[i].bxt_thread, struct be_ub_tx_thread *,
+				    NULL, &be_ub_tx_thread, &t[i],
+				    "be-tx-ub-%d", i);
+		M0_UB_ASSERT(rc == 0);
+	}
+	for (i = 0; i < be_ub_tx.bux_threads; i++) {
+		m0_thread_join(&t[i].bxt_thread);
+		m0_thread_fini(&t[i].bxt_thread);
+	}
+	be_ub_tx.bux_end = m0_time_now();
+	m0_free(t);
+}
+
+static int be_ub_tx_lat_cmp(const void *a, const void *b)
+{
+	return M0_3WAY(*(const m0_time_t *)a, *(const m0_time_t *)b);
+}
+
+static double be_ub_tx_lat(const m0_time_t *lat, uint32_t nr, uint32_t pm)
+{
+	return lat[(uint64_t)nr * pm / 1000] / 1000.0;
+}
+
+static double be_ub_tx_ratio(uint64_t part, uint64_t whole)
+{
+	return whole == 0 ? 0.0 : 100.0 * part / whole;
+}
+
+/** Prints the results of the benchmark which just finished. */
+static void be_ub_tx_report(const char *name)
+{
+	struct m0_be_engine       *en;
+	struct m0_be_engine_stats  s;
+	struct m0_be_engine_stats *s0 = &be_ub_tx.bux_stats;
+	uint32_t                   nr = be_ub_tx.bux_nr / be_ub_tx.bux_threads *
+					be_ub_tx.bux_threads;
+	m0_time_t                  elapsed;
+	uint64_t                   groups;
+
+	en = m0_be_domain_engine(&be_ub_tx.bux_be.but_dom);
+	m0_be_engine_stats_get(en, &s);
+	elapsed = max64u(be_ub_tx.bux_end - be_ub_tx.bux_start, 1);
+	groups  = s.es_groups - s0->es_groups;
+
+	qsort(be_ub_tx.bux_open, nr, sizeof be_ub_tx.bux_open[0],
+	      &be_ub_tx_lat_cmp);
+	qsort(be_ub_tx.bux_commit, nr, sizeof be_ub_tx.bux_commit[0],
+	      &be_ub_tx_lat_cmp);
+	printf("\n\t%s regs=%u reg_size=%u threads=%u groups=%u grp_tx=%u "
+	       "log=%s%s nr=%u: %.0f tx/s, open p50 %.2f us, "
+	       "commit p50 %.2f us, p99 %.2f us, p99.9 %.2f us, "
+	       "log %.2f MB/s, %.2f us/record, groups %"PRIu64", "
+	       "%.1f tx/group, fill %.1f%% (tx), %.1f%% (size)\n",
+	       name, be_ub_tx.bux_regs, be_ub_tx.bux_reg_size,
+	       be_ub_tx.bux_threads, be_ub_tx.bux_groups, be_ub_tx.bux_grp_tx,
+	       be_ub_tx.bux_null ? "null" : "stob",
+	       be_ub_tx.bux_adaptive ? " adaptive" : "", nr,
+	       (double)nr * M0_TIME_ONE_SECOND / elapsed,
+	       be_ub_tx_lat(be_ub_tx.bux_open, nr, 500),
+	       be_ub_tx_lat(be_ub_tx.bux_commit, nr, 500),
+	       be_ub_tx_lat(be_ub_tx.bux_commit, nr, 990),
+	       be_ub_tx_lat(be_ub_tx.bux_commit, nr, 999),
+	       (double)(s.es_log_size - s0->es_log_size) *
+	       M0_TIME_ONE_SECOND / elapsed / (1 << 20),
+	       groups == 0 ? 0.0 :
+	       (double)(s.es_log_time - s0->es_log_time) / groups / 1000.0,
+	       groups,
+	       groups == 0 ? 0.0 : (double)(s.es_tx - s0->es_tx) / groups,
+	       be_ub_tx_ratio(s.es_tx - s0->es_tx,
+			      s.es_tx_max - s0->es_tx_max),
+	       be_ub_tx_ratio(s.es_reg_size - s0->es_reg_size,
+			      s.es_reg_size_max - s0->es_reg_size_max));
+}
+
+static void be_ub_tx_shape(uint32_t regs, uint32_t reg_size)
+{
+	be_ub_tx.bux_regs = be_ub_tx.bux_regs_opt ?: regs;
+	be_ub_tx.bux_reg_size = be_ub_tx.bux_reg_size_opt ?: reg_size;
+}
+
+static void be_ub_tx_init_small(void)
+{
+	be_ub_tx_shape(1, 64);
+}
+
+static void be_ub_tx_init_medium(void)
+{
+	be_ub_tx_shape(16, 512);
+}
+
+static void be_ub_tx_init_large(void)
+{
+	be_ub_tx_shape(BE_UB_TX_REGS_MAX, BE_UB_TX_REG_MAX);
+}
+
+static void be_ub_tx_fini_small(void)
+{
+	be_ub_tx_report("small");
+}
+
+static void be_ub_tx_fini_medium(void)
+{
+	be_ub_tx_report("medium");
+}
+
+static void be_ub_tx_fini_large(void)
+{
+	be_ub_tx_report("large");
+}
+
+/** Parses "name=value,..." benchmark options. */
+static int be_ub_tx_opts_parse(const char *opts)
+{
+	char *str;
+	char *tok;
+	char *save;
+	char  name[16];
+	char  val[16];
+	int   rc = 0;
+
+	if (opts == NULL)
+		return 0;
+	str = m0_strdup(opts);
+	if (str == NULL)
+		return M0_ERR(-ENOMEM);
+	for (tok = strtok_r(str, ",", &save); tok != NULL && rc == 0;
+	     tok = strtok_r(NULL, ",", &save)) {
+		if (sscanf(tok, "%15[^=]=%15s", name, val) != 2)
+			rc = M0_ERR(-EINVAL);
+		else if (strcmp(name, "threads") == 0)
+			be_ub_tx.bux_threads = atoi(val);
+		else if (strcmp(name, "nr") == 0)
+			be_ub_tx.bux_nr = atoi(val);
+		else if (strcmp(name, "regs") == 0)
+			be_ub_tx.bux_regs_opt = atoi(val);
+		else if (strcmp(name, "reg_size") == 0)
+			be_ub_tx.bux_reg_size_opt = atoi(val);
+		else if (strcmp(name, "groups") == 0)
+			be_ub_tx.bux_groups = atoi(val);
+		else if (strcmp(name, "grp_tx") == 0)
+			be_ub_tx.bux_grp_tx = atoi(val);
+		else if (strcmp(name, "timeout_min") == 0)
+			be_ub_tx.bux_timeout_min = atoll(val) *
+						   1000;
+		else if (strcmp(name, "timeout_max") == 0)
+			be_ub_tx.bux_timeout_max = atoll(val) *
+						   1000;
+		else if (strcmp(name, "adaptive") == 0)
+			be_ub_tx.bux_adaptive = atoi(val) != 0;
+		else if (strcmp(name, "log") == 0) {
+			be_ub_tx.bux_null = strcmp(val, "null") == 0;
+			if (!be_ub_tx.bux_null && strcmp(val, "stob") != 0)
+				rc = M0_ERR(-EINVAL);
+		} else
+			rc = M0_ERR(-EINVAL);
+	}
+	m0_free(str);
+	if (rc == 0 && (be_ub_tx.bux_threads == 0 ||
+			be_ub_tx.bux_nr < be_ub_tx.bux_threads ||
+			be_ub_tx.bux_regs_opt > BE_UB_TX_REGS_MAX ||
+			be_ub_tx.bux_reg_size_opt > BE_UB_TX_REG_MAX ||
+			be_ub_tx.bux_groups == 0 || be_ub_tx.bux_grp_tx == 0 ||
+			be_ub_tx.bux_timeout_min > be_ub_tx.bux_timeout_max))
+		rc = M0_ERR(-EINVAL);
+	return rc;
+}
+
+static int be_ub_tx_init(const char *opts)
+{
+	struct m0_be_domain_cfg  cfg;
+	struct m0_be_engine_cfg *en_cfg = &cfg.bc_engine;
+	struct m0_be_log_cfg    *log_cfg = &cfg.bc_log;
+	m0_bcount_t              size;
+	int                      rc;
+
+	M0_SET0(&be_ub_tx.bux_be);
+	m0_be_ut_backend_cfg_default(&cfg);
+	be_ub_tx.bux_threads      = BE_UB_TX_THREADS;
+	be_ub_tx.bux_nr           = BE_UB_TX_NR;
+	be_ub_tx.bux_regs_opt     = 0;
+	be_ub_tx.bux_reg_size_opt = 0;
+	be_ub_tx.bux_groups       = en_cfg->bec_group_nr;
+	be_ub_tx.bux_grp_tx       = en_cfg->bec_group_cfg.tgc_tx_nr_max;
+	be_ub_tx.bux_timeout_min  = en_cfg->bec_group_freeze_timeout_min;
+	be_ub_tx.bux_timeout_max  = en_cfg->bec_group_freeze_timeout_max;
+	be_ub_tx.bux_adaptive     = false;
+	be_ub_tx.bux_null         = false;
+	rc = be_ub_tx_opts_parse(opts);
+	if (rc != 0)
+		return rc;
+	if (be_ub_tx.bux_threads > en_cfg->bec_tx_active_max)
+		en_cfg->bec_tx_active_max = be_ub_tx.bux_threads;
+	en_cfg->bec_group_nr                 = be_ub_tx.bux_groups;
+	en_cfg->bec_group_cfg.tgc_tx_nr_max  = be_ub_tx.bux_grp_tx;
+	en_cfg->bec_group_freeze_timeout_min = be_ub_tx.bux_timeout_min;
+	en_cfg->bec_group_freeze_timeout_max = be_ub_tx.bux_timeout_max;
+	en_cfg->bec_group_adaptive           = be_ub_tx.bux_adaptive;
+	if (be_ub_tx.bux_null) {
+		/* Symlink can't be opened with O_DIRECT and must be zeroed. */
+		log_cfg->lc_store_cfg.lsc_stob_domain_init_cfg =
+			"directio=false";
+		log_cfg->lc_store_cfg.lsc_stob_create_cfg = "/dev/null";
+		log_cfg->lc_store_cfg.lsc_stob_dont_zero  = false;
+	}
+
+	M0_ALLOC_ARR(be_ub_tx.bux_open, be_ub_tx.bux_nr);
+	M0_ALLOC_ARR(be_ub_tx.bux_commit, be_ub_tx.bux_nr);
+	if (be_ub_tx.bux_open == NULL || be_ub_tx.bux_commit == NULL) {
+		m0_free0(&be_ub_tx.bux_open);
+		m0_free0(&be_ub_tx.bux_commit);
+		return M0_ERR(-ENOMEM);
+	}
+	rc = m0_be_ut_backend_init_cfg(&be_ub_tx.bux_be, &cfg, true);
+	if (rc != 0) {
+		m0_free0(&be_ub_tx.bux_open);
+		m0_free0(&be_ub_tx.bux_commit);
+		return M0_ERR(rc);
+	}
+	size = m0_align((m0_bcount_t)be_ub_tx.bux_threads * BE_UB_TX_REGS_MAX *
+			BE_UB_TX_REG_MAX * 2, 1 << 20) + (1 << 20);
+	m0_be_ut_backend_seg_add2(&be_ub_tx.bux_be, size, false, NULL,
+				  &be_ub_tx.bux_seg);
+	return 0;
+}
+
+static void be_ub_tx_fini(void)
+{
+	m0_be_ut_backend_seg_del(&be_ub_tx.bux_be, be_ub_tx.bux_seg);
+	m0_be_ut_backend_fini(&be_ub_tx.bux_be);
+	m0_free0(&be_ub_tx.bux_open);
+	m0_free0(&be_ub_tx.bux_commit);
+}
+
+struct m0_ub_set m0_be_tx_ub = {
+	.us_name = "be-tx-ub",
+	.us_init = be_ub_tx_init,
+	.us_fini = be_ub_tx_fini,
+	.us_run  = {
+		{ .ub_name  = "small",
+		  .ub_iter  = 1,
+		  .ub_init  = be_ub_tx_init_small,
+		  .ub_round = be_ub_tx_round,
+		  .ub_fini  = be_ub_tx_fini_small },
+
+		{ .ub_name  = "medium",
+		  .ub_iter  = 1,
+		  .ub_init  = be_ub_tx_init_medium,
+		  .ub_round = be_ub_tx_round,
+		  .ub_fini  = be_ub_tx_fini_medium },
+
+		{ .ub_name  = "large",
+		  .ub_iter  = 1,
+		  .ub_init  = be_ub_tx_init_large,
+		  .ub_round = be_ub_tx_round,
+		  .ub_fini  = be_ub_tx_fini_large },
+
+		{ .ub_name = NULL }
+	}
+};
+
+#undef M0_TRACE_SUBSYSTEM
+
+/** @} end of be group */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -564,6 +564,8 @@
 #include "be/engine.h"     /** m0_be_engine_tx_size_max() */
 #include "motr/iem.h"       /* M0_MOTR_IEM_DESC */
 #include "be/alloc.h"      /** m0_be_chunk_header_size() */
+#include "be/addb2.h"      /** M0_AVI_BE_BTREE_LRU */
+#include "addb2/addb2.h"   /** M0_ADDB2_ADD() */
 
 
 #ifndef __KERNEL__
@@ -572,6 +574,13 @@
 #include <unistd.h>
 #include <sys/mman.h>
 #include "ut/ut.h"          /** struct m0_ut_suite */
+#include "lib/ub.h"         /** struct m0_ub_set */
+#include "lib/string.h"     /** m0_strdup() */
+#if defined(__x86_64__)
+#include <immintrin.h>      /** _mm_cmpeq_epi8() */
+#elif defined(__aarch64__)
+#include <arm_neon.h>       /** vceqq_u8() */
+#endif
 #endif
 
 #define AVOID_BE_SEGMENT                  0
@@ -613,6 +622,7 @@ enum btree_node_type {
 	BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE     = 2,
 	BNT_VARIABLE_KEYSIZE_FIXED_VALUESIZE     = 3,
 	BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE  = 4,
+	BNT_PREFIX_KEYSIZE_VARIABLE_VALUESIZE    = 5,
 };
 
 enum {
@@ -841,6 +851,13 @@ struct td {
 	struct m0_be_seg           *t_seg;    /** Segment hosting tree nodes. */
 	struct m0_fid               t_fid;    /** Fid of the tree. */
 	struct m0_btree_rec_key_op  t_keycmp; /** User Key compare function */
+
+	/**
+	 * Number of times the tree lock was released by a writer, see
+	 * lock_op_unlock(). Readers sample it before the traversal to find out
+	 * if the traversed path could have been modified.
+	 */
+	struct m0_atomic64          t_wseq;
 };
 
 /** Special values that can be passed to bnode_move() as 'nr' parameter. */
@@ -1126,6 +1143,14 @@ struct nd {
 	 * does not indicated anything about node descriptor validity.
 	 */
 	bool                    n_be_node_valid;
+
+	/**
+	 * Set when the node descriptor was found in an LRU list by bnode_get(),
+	 * i.e. the node was referenced again after all the previous users had
+	 * released it. Such nodes are kept in btree_lru_hot_nds, see
+	 * bnode_put().
+	 */
+	bool                    n_lru_hot;
 };
 
 enum node_opcode {
@@ -1189,7 +1214,7 @@ static int64_t    bnode_get  (struct node_op *op, struct td *tree,
 			      struct segaddr *addr, int nxt);
 static void       bnode_put  (struct node_op *op, struct nd *node);
 
-static void bnode_crc_validate(struct nd *node);
+static int bnode_crc_validate(struct nd *node, int from, bool repair);
 
 static int64_t    bnode_free(struct node_op *op, struct nd *node,
 			     struct m0_be_tx *tx, int nxt);
@@ -1240,6 +1265,8 @@ static void bnode_capture(struct slot *slot, struct m0_be_tx *tx);
 
 static void bnode_lock(struct nd *node);
 static void bnode_unlock(struct nd *node);
+static void bnode_read_lock(struct nd *node);
+static void bnode_read_unlock(struct nd *node);
 static void bnode_fini(const struct nd *node);
 
 /**
@@ -1255,7 +1282,12 @@ struct node_header {
 	uint32_t      h_crc_type;
 	uint64_t      h_gen;
 	struct m0_fid h_fid;
-	uint64_t      h_opaque;
+	/**
+	 * Number of records in the subtree rooted at this node, combined with
+	 * BTREE_NR_COUNTED, for the trees created with M0_BTF_SUBTREE_COUNTS.
+	 * Zero in the nodes of the other trees.
+	 */
+	uint64_t      h_subtree_nr;
 };
 
 /**
@@ -1354,6 +1386,9 @@ struct m0_btree_oimpl {
 	/** Used to store height of tree at the beginning of any operation **/
 	unsigned                   i_height;
 
+	/** Value of td::t_wseq at the beginning of the traversal. */
+	int64_t                    i_wseq;
+
 	/** Node descriptor for cookie if it is going to be used. **/
 	struct nd                 *i_cookie_node;
 
@@ -1391,17 +1426,40 @@ M0_INTERNAL bool m0_crc32_chk(const void *data, uint64_t len,
 M0_INTERNAL void m0_crc32(const void *data, uint64_t len,
 			  uint64_t *cksum);
 /**
- * Node descriptor LRU list.
+ * Node descriptor LRU lists.
  * Following actions will be performed on node descriptors:
  * 1. If nds are not active, they will be moved from btree_active_nds to
- * btree_lru_nds list head.
- * 2. If the nds in btree_lru_nds become active, they will be moved to
+ * btree_lru_hot_nds list head if they are internal nodes or were referenced
+ * again while in LRU (nd::n_lru_hot), otherwise to btree_lru_nds list head.
+ * 2. If the nds in LRU lists become active, they will be moved to
  * btree_active_nds list head.
  * 3. Based on certain conditions, the nds can be freed from btree_lru_nds
- * list tail.
+ * list tail and, once it is empty, from btree_lru_hot_nds list tail.
+ *
+ * This way leaves touched only once by a large scan (e.g. m0_btree_iter()
+ * during repair) are evicted before the internal nodes and the frequently
+ * used leaves of the other trees.
  */
 static struct m0_tl     btree_lru_nds;
 
+/** Node descriptor LRU list of internal and re-referenced nodes. */
+static struct m0_tl     btree_lru_hot_nds;
+
+/**
+ * LRU statistics, protected by list_lock. Posted to addb2 by
+ * m0_btree_lrulist_purge().
+ */
+static struct {
+	/** Number of bnode_get() calls which found the nd in an LRU list. */
+	uint64_t ls_hit;
+	/** Number of bnode_get() calls which had to allocate a new nd. */
+	uint64_t ls_miss;
+	/** Number of nds freed from btree_lru_nds. */
+	uint64_t ls_evict;
+	/** Number of nds freed from btree_lru_hot_nds. */
+	uint64_t ls_hot_evict;
+} lru_stats;
+
 /**
  * Active node descriptor list contains the node descriptors that are
  * currently in use by the trees.
@@ -1446,6 +1504,12 @@ static int64_t lru_space_wm_target;
  */
 static int64_t lru_space_wm_high;
 
+/**
+ * When the record CRCs of the leaves are verified, see
+ * m0_btree_crc_verify_set().
+ */
+static enum m0_btree_crc_verify btree_crc_verify = M0_BCV_FIRST_FETCH;
+
 /**
  * LRU trickle release configuration from sysconfig/motr.
  */
@@ -1651,6 +1715,36 @@ static void bnode_val_resize(struct slot *slot, int vsize_diff)
 	slot->s_node->n_type->nt_val_resize(slot, vsize_diff);
 }
 
+/**
+ * Compares two keys in the key order of the tree the node belongs to.
+ *
+ * Without user provided comparison function keys are compared by memcmp()
+ * over the length of the shorter key. Nodes with prefix separators
+ * (variable_kv_prefix_format) additionally order a key after its own prefix,
+ * otherwise a separator would compare equal to all the keys it is a prefix of.
+ */
+static int bnode_key_cmp(const struct nd *node, const struct m0_btree_key *k0,
+			 const struct m0_btree_key *k1)
+{
+	struct m0_btree_rec_key_op *keycmp = &node->n_tree->t_keycmp;
+	struct m0_bufvec_cursor     cur_0;
+	struct m0_bufvec_cursor     cur_1;
+	int                         diff;
+
+	if (keycmp->rko_keycmp != NULL)
+		return keycmp->rko_keycmp(k0->k_data.ov_buf[0],
+					  k1->k_data.ov_buf[0]);
+
+	m0_bufvec_cursor_init(&cur_0, &k0->k_data);
+	m0_bufvec_cursor_init(&cur_1, &k1->k_data);
+	diff = m0_bufvec_cursor_cmp(&cur_0, &cur_1);
+	if (diff == 0 &&
+	    node->n_type->nt_id == BNT_PREFIX_KEYSIZE_VARIABLE_VALUESIZE)
+		diff = M0_3WAY(m0_vec_count(&k0->k_data.ov_vec),
+			       m0_vec_count(&k1->k_data.ov_vec));
+	return diff;
+}
+
 static bool bnode_find(struct slot *slot, struct m0_btree_key *find_key)
 {
 	int                         i     = -1;
@@ -1659,8 +1753,6 @@ static bool bnode_find(struct slot *slot, struct m0_btree_key *find_key)
 	void                       *p_key;
 	struct slot                 key_slot;
 	m0_bcount_t                 ksize;
-	struct m0_bufvec_cursor     cur_1;
-	struct m0_bufvec_cursor     cur_2;
 	int                         diff;
 	int                         m;
 	struct m0_btree_rec_key_op *keycmp = &slot->s_node->n_tree->t_keycmp;
@@ -1672,24 +1764,27 @@ static bool bnode_find(struct slot *slot, struct m0_btree_key *find_key)
 	M0_PRE(bnode_invariant(slot->s_node));
 	M0_PRE(find_key->k_data.ov_vec.v_nr == 1);
 
+	/**
+	 * Node formats with fixed size keys provide their own search routine.
+	 * It can only be used when the key order is known to the node: either
+	 * the tree has no user key comparison function, or the function is
+	 * declared to be memcmp() or uint64_t array ordered, see
+	 * m0_btree_keycmp_flags. Otherwise key order is opaque to the node.
+	 */
+	if (slot->s_node->n_type->nt_find != NULL &&
+	    find_key->k_data.ov_vec.v_count[0] == bnode_keysize(slot->s_node) &&
+	    (keycmp->rko_keycmp == NULL ||
+	     (keycmp->rko_flags & M0_BKF_MEMCMP) ||
+	     ((keycmp->rko_flags & M0_BKF_U64) &&
+	      bnode_keysize(slot->s_node) % sizeof(uint64_t) == 0)))
+		return slot->s_node->n_type->nt_find(slot, find_key);
+
 	while (i + 1 < j) {
 		m = (i + j) / 2;
 
 		key_slot.s_idx = m;
 		bnode_key(&key_slot);
-
-		if (keycmp->rko_keycmp != NULL) {
-			void     *key_data;
-			void     *find_data;
-
-			key_data = M0_BUFVEC_DATA(&key.k_data);
-			find_data = M0_BUFVEC_DATA(&find_key->k_data);
-			diff = keycmp->rko_keycmp(key_data, find_data);
-		} else {
-			m0_bufvec_cursor_init(&cur_1, &key.k_data);
-			m0_bufvec_cursor_init(&cur_2, &find_key->k_data);
-			diff = m0_bufvec_cursor_cmp(&cur_1, &cur_2);
-		}
+		diff = bnode_key_cmp(slot->s_node, &key, find_key);
 
 		M0_ASSERT(i < m && m < j);
 		if (diff < 0)
@@ -1765,6 +1860,21 @@ static void bnode_unlock(struct nd *node)
 	m0_rwlock_write_unlock(&node->n_lock);
 }
 
+/**
+ * Takes the node lock in shared mode. It is used by the tree traversals which
+ * only read the node (lookup and iteration), so that they do not serialise on
+ * the upper level nodes which are visited by every operation.
+ */
+static void bnode_read_lock(struct nd *node)
+{
+	m0_rwlock_read_lock(&node->n_lock);
+}
+
+static void bnode_read_unlock(struct nd *node)
+{
+	m0_rwlock_read_unlock(&node->n_lock);
+}
+
 static void bnode_fini(const struct nd *node)
 {
 	node->n_type->nt_fini(node);
@@ -1820,8 +1930,10 @@ M0_INTERNAL void m0_btree_glob_init(void)
 	lru_space_used           = 0;
 	m0_btree_lrulist_set_lru_config(0, 0, 0, 0);
 
-	/* Initialtise lru list, active list and lock. */
+	/* Initialtise lru lists, active list and lock. */
+	M0_SET0(&lru_stats);
 	ndlist_tlist_init(&btree_lru_nds);
+	ndlist_tlist_init(&btree_lru_hot_nds);
 	ndlist_tlist_init(&btree_active_nds);
 	m0_rwlock_init(&list_lock);
 }
@@ -1838,6 +1950,14 @@ M0_INTERNAL void m0_btree_glob_fini(void)
 		}
 	ndlist_tlist_fini(&btree_lru_nds);
 
+	if (!ndlist_tlist_is_empty(&btree_lru_hot_nds))
+		m0_tl_teardown(ndlist, &btree_lru_hot_nds, node) {
+			ndlist_tlink_fini(node);
+			m0_rwlock_fini(&node->n_lock);
+			m0_free(node);
+		}
+	ndlist_tlist_fini(&btree_lru_hot_nds);
+
 	if (!ndlist_tlist_is_empty(&btree_active_nds))
 		m0_tl_teardown(ndlist, &btree_active_nds, node) {
 			ndlist_tlink_fini(node);
@@ -1890,6 +2010,23 @@ M0_INTERNAL void m0_btree_lrulist_set_lru_config(int64_t slow_lru_mem_release,
 	       lru_trickle_release_en ? "true" : "false");
 }
 
+M0_INTERNAL void m0_btree_lrulist_get_lru_config(int64_t *slow_lru_mem_release,
+						 int64_t *wm_low,
+						 int64_t *wm_target,
+						 int64_t *wm_high)
+{
+	*slow_lru_mem_release = lru_trickle_release_en ? 1 : 0;
+	*wm_low               = lru_space_wm_low;
+	*wm_target            = lru_space_wm_target;
+	*wm_high              = lru_space_wm_high;
+}
+
+M0_INTERNAL void m0_btree_crc_verify_set(enum m0_btree_crc_verify mode)
+{
+	M0_PRE(M0_IN(mode, (M0_BCV_FETCH, M0_BCV_FIRST_FETCH, M0_BCV_SCRUB)));
+	btree_crc_verify = mode;
+}
+
 /**
  * Tells if the segment address is aligned to 512 bytes.
  * This function should be called right after the allocation to make sure that
@@ -1944,19 +2081,22 @@ uint32_t segaddr_ntype_get(const struct segaddr *addr)
 
 	M0_IN(h->h_node_type, (BNT_FIXED_FORMAT,
 			       BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE,
-			       BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE));
+			       BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE,
+			       BNT_PREFIX_KEYSIZE_VARIABLE_VALUESIZE));
 	return h->h_node_type;
 }
 
 static const struct node_type fixed_format;
 static const struct node_type fixed_ksize_variable_vsize_format;
 static const struct node_type variable_kv_format;
+static const struct node_type variable_kv_prefix_format;
 
 static const struct node_type *btree_node_format[] = {
 	[BNT_FIXED_FORMAT]                        = &fixed_format,
 	[BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE]    = &fixed_ksize_variable_vsize_format,
 	[BNT_VARIABLE_KEYSIZE_FIXED_VALUESIZE]    = NULL,
 	[BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE] = &variable_kv_format,
+	[BNT_PREFIX_KEYSIZE_VARIABLE_VALUESIZE]   = &variable_kv_prefix_format,
 };
 
 
@@ -1993,6 +2133,7 @@ static int64_t tree_get(struct node_op *op, struct segaddr *addr, int nxt)
 	if (tree == NULL) {
 		tree = m0_alloc(sizeof *tree);
 		m0_rwlock_init(&tree->t_lock);
+		m0_atomic64_set(&tree->t_wseq, 0);
 		m0_rwlock_write_lock(&tree->t_lock);
 
 		tree->t_ref = 1;
@@ -2121,6 +2262,8 @@ static int64_t bnode_get(struct node_op *op, struct td *tree,
 			ndlist_tlist_add(&btree_active_nds, op->no_node);
 			lru_space_used -= (m0_be_chunk_header_size() +
 					   op->no_node->n_size);
+			op->no_node->n_lru_hot = true;
+			lru_stats.ls_hit++;
 			/**
 			 * Update nd::n_tree  to point to tree descriptor as we
 			 * as we had set it to NULL in bnode_put(). For more
@@ -2129,6 +2272,14 @@ static int64_t bnode_get(struct node_op *op, struct td *tree,
 			op->no_node->n_tree = tree;
 		}
 		bnode_unlock(op->no_node);
+		/**
+		 * The node was not in use, so nobody else can access it while
+		 * list_lock is held.
+		 */
+		if (in_lrulist && btree_crc_verify == M0_BCV_FETCH &&
+		    !(IS_INTERNAL_NODE(op->no_node)) &&
+		    bnode_crctype_get(op->no_node) != M0_BCT_NO_CRC)
+			bnode_crc_validate(op->no_node, 0, true);
 	} else {
 		/**
 		 * Validating the seg header again to avoid the following
@@ -2177,22 +2328,30 @@ static int64_t bnode_get(struct node_op *op, struct td *tree,
 		node->n_txref         = 0;
 		node->n_size          = nt->nt_nsize(node);
 		node->n_be_node_valid = true;
+		node->n_lru_hot       = false;
 		node->n_seg           = tree == NULL ? NULL : tree->t_seg;
 		m0_rwlock_init(&node->n_lock);
 		op->no_node           = node;
+		lru_stats.ls_miss++;
 		nt->nt_opaque_set(addr, node);
 		ndlist_tlink_init_at(op->no_node, &btree_active_nds);
 
-		if (!(IS_INTERNAL_NODE(op->no_node)) &&
+		if (btree_crc_verify != M0_BCV_SCRUB &&
+		    !(IS_INTERNAL_NODE(op->no_node)) &&
 		    bnode_crctype_get(op->no_node) != M0_BCT_NO_CRC) {
-			bnode_crc_validate(op->no_node);
+			bnode_crc_validate(op->no_node, 0, true);
 		}
 	}
 	m0_rwlock_write_unlock(&list_lock);
 	return nxt;
 }
 
-static void bnode_crc_validate(struct nd *node)
+/**
+ * Verifies the CRCs of the records of the leaf starting from index from.
+ * Corrupted records are deleted from the node if repair is true. Returns the
+ * number of corrupted records.
+ */
+static int bnode_crc_validate(struct nd *node, int from, bool repair)
 {
 	struct slot             node_slot;
 	m0_bcount_t             ksize;
@@ -2201,6 +2360,7 @@ static void bnode_crc_validate(struct nd *node)
 	void                   *p_val;
 	int                     i;
 	int                     count;
+	int                     corrupt = 0;
 	bool                    rc = true;
 	enum m0_btree_crc_type  crc_type;
 
@@ -2210,7 +2370,7 @@ static void bnode_crc_validate(struct nd *node)
 	crc_type = bnode_crctype_get(node);
 	M0_ASSERT(crc_type != M0_BCT_NO_CRC);
 
-	for (i = 0; i < count; i++)
+	for (i = from; i < count; i++)
 	{
 		node_slot.s_idx = i;
 		bnode_rec(&node_slot);
@@ -2237,9 +2397,15 @@ static void bnode_crc_validate(struct nd *node)
 					 "data corruption for object with \
 					  possible key: %d..., hence removing \
 					  the object", *(int*)p_key);
-			bnode_del(node_slot.s_node, node_slot.s_idx);
+			corrupt++;
+			if (repair) {
+				bnode_del(node_slot.s_node, node_slot.s_idx);
+				i--;
+				count--;
+			}
 		}
 	}
+	return corrupt;
 }
 
 /**
@@ -2267,7 +2433,11 @@ static void bnode_put(struct node_op *op, struct nd *node)
 		 * active list and add to lru list
 		 */
 		ndlist_tlist_del(node);
-		ndlist_tlist_add(&btree_lru_nds, node);
+		ndlist_tlist_add(node->n_lru_hot ||
+				 (node->n_be_node_valid &&
+				  segaddr_header_isvalid(&node->n_addr) &&
+				  node->n_type->nt_level(node) > 0) ?
+				 &btree_lru_hot_nds : &btree_lru_nds, node);
 		lru_space_used += (m0_be_chunk_header_size() + node->n_size);
 		purge_check = true;
 
@@ -2436,6 +2606,7 @@ static bool ff_isoverflow(const struct nd *node, int max_ksize,
 static void ff_fid(const struct nd *node, struct m0_fid *fid);
 static void ff_rec(struct slot *slot);
 static void ff_node_key(struct slot *slot);
+static bool ff_find(struct slot *slot, const struct m0_btree_key *key);
 static void ff_child(struct slot *slot, struct segaddr *addr);
 static bool ff_isfit(struct slot *slot);
 static void ff_done(struct slot *slot, bool modified);
@@ -2498,6 +2669,7 @@ static const struct node_type fixed_format = {
 	.nt_done                      = ff_done,
 	.nt_make                      = ff_make,
 	.nt_val_resize                = ff_val_resize,
+	.nt_find                      = ff_find,
 	.nt_fix                       = ff_fix,
 	.nt_cut                       = ff_cut,
 	.nt_del                       = ff_del,
@@ -2814,6 +2986,183 @@ static void ff_node_key(struct slot *slot)
 	slot->s_rec.r_key.k_data.ov_buf[0] = ff_key(slot->s_node, slot->s_idx);
 }
 
+enum {
+	/**
+	 * Once the binary search range of ff_find() shrinks to this many keys,
+	 * remaining keys are scanned linearly. Keys in the fixed format node
+	 * are contiguous, so the scan is prefetch friendly and, for 16-byte
+	 * keys, compares several keys per vector instruction.
+	 */
+	FF_FIND_SCAN_NR = 16,
+	FF_KEY16_SIZE   = 16,
+};
+
+/**
+ * Compares 16-byte keys k0 and k1 with memcmp() semantics.
+ *
+ * Vector instructions locate the first differing byte in one step instead of
+ * a byte-by-byte loop. Falls back to memcmp() in kernel and on platforms
+ * without SSE2/NEON.
+ */
+static inline int ff_key16_cmp(const uint8_t *k0, const uint8_t *k1)
+{
+#if !defined(__KERNEL__) && defined(__x86_64__)
+	__m128i  v0   = _mm_loadu_si128((const __m128i *)k0);
+	__m128i  v1   = _mm_loadu_si128((const __m128i *)k1);
+	uint32_t diff = _mm_movemask_epi8(_mm_cmpeq_epi8(v0, v1)) ^ 0xffff;
+	int      idx;
+
+	if (diff == 0)
+		return 0;
+	idx = __builtin_ctz(diff);
+	return (int)k0[idx] - (int)k1[idx];
+#elif !defined(__KERNEL__) && defined(__aarch64__)
+	uint8x16_t eq   = vceqq_u8(vld1q_u8(k0), vld1q_u8(k1));
+	/* Narrow the per-byte mask to 4 bits per byte. */
+	uint64_t   diff = ~vget_lane_u64(vreinterpret_u64_u8(
+			      vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+	int        idx;
+
+	if (diff == 0)
+		return 0;
+	idx = __builtin_ctzll(diff) >> 2;
+	return (int)k0[idx] - (int)k1[idx];
+#else
+	return memcmp(k0, k1, FF_KEY16_SIZE);
+#endif
+}
+
+static inline int ff_key_cmp(const void *k0, const void *k1, int ksize)
+{
+	return ksize == FF_KEY16_SIZE ? ff_key16_cmp(k0, k1) :
+					memcmp(k0, k1, ksize);
+}
+
+/**
+ * Compares keys k0 and k1 as arrays of native uint64_t, see M0_BKF_U64.
+ * Keys in a fixed format node are not necessarily 8-byte aligned.
+ */
+static inline int ff_key_u64_cmp(const void *k0, const void *k1, int ksize)
+{
+	uint64_t w0;
+	uint64_t w1;
+	int      i;
+
+	for (i = 0; i < ksize; i += sizeof w0) {
+		memcpy(&w0, (const char *)k0 + i, sizeof w0);
+		memcpy(&w1, (const char *)k1 + i, sizeof w1);
+		if (w0 != w1)
+			return M0_3WAY(w0, w1);
+	}
+	return 0;
+}
+
+/**
+ * Scans keys [lo, hi) of a node with 16-byte keys and returns the index of the
+ * first key which is not less than find_key (or hi if there is no such key).
+ * With AVX2 two adjacent keys are checked for equality in a single compare.
+ */
+static int ff_key16_scan(const struct nd *node, int lo, int hi,
+			 const uint8_t *find_key, int *diff)
+{
+#if !defined(__KERNEL__) && defined(__AVX2__)
+	__m256i fk = _mm256_broadcastsi128_si256(
+			_mm_loadu_si128((const __m128i *)find_key));
+
+	for (; lo + 1 < hi; lo += 2) {
+		const uint8_t *k    = ff_key(node, lo);
+		uint32_t       eq   = _mm256_movemask_epi8(
+				_mm256_cmpeq_epi8(
+				    _mm256_loadu_si256((const __m256i *)k),
+				    fk));
+		uint32_t       ne0  = ~eq & 0xffff;
+		uint32_t       ne1  = ~eq >> 16;
+		int            idx;
+
+		if (ne0 == 0) {
+			*diff = 0;
+			return lo;
+		}
+		idx = __builtin_ctz(ne0);
+		if (k[idx] > find_key[idx]) {
+			*diff = 1;
+			return lo;
+		}
+		if (ne1 == 0) {
+			*diff = 0;
+			return lo + 1;
+		}
+		idx = __builtin_ctz(ne1);
+		if (k[FF_KEY16_SIZE + idx] > find_key[idx]) {
+			*diff = 1;
+			return lo + 1;
+		}
+	}
+#endif
+	for (; lo < hi; lo++) {
+		*diff = ff_key16_cmp(ff_key(node, lo), find_key);
+		if (*diff >= 0)
+			break;
+	}
+	return lo;
+}
+
+/**
+ * Search routine for fixed format nodes whose keys are ordered by memcmp(), or
+ * as uint64_t arrays when the tree key comparison function has M0_BKF_U64.
+ *
+ * Unlike the generic bnode_find(), this neither builds bufvec cursors nor calls
+ * through the key comparison callback for every probe. The range is narrowed
+ * by binary search and the last FF_FIND_SCAN_NR keys are scanned linearly.
+ */
+static bool ff_find(struct slot *slot, const struct m0_btree_key *find_key)
+{
+	const struct nd *node  = slot->s_node;
+	struct ff_head  *h     = ff_data(node);
+	int              ksize = h->ff_ksize;
+	const void      *fkey  = find_key->k_data.ov_buf[0];
+	bool             u64   = node->n_tree->t_keycmp.rko_keycmp != NULL &&
+				 !(node->n_tree->t_keycmp.rko_flags &
+				   M0_BKF_MEMCMP);
+	int            (*cmp)(const void *, const void *, int);
+	int              lo    = 0;
+	int              hi    = bnode_key_count(node);
+	int              diff  = 1;
+	int              m;
+
+	M0_PRE(find_key->k_data.ov_vec.v_nr == 1);
+	M0_PRE(find_key->k_data.ov_vec.v_count[0] == ksize);
+	M0_PRE(ergo(u64, (node->n_tree->t_keycmp.rko_flags & M0_BKF_U64) &&
+			 ksize % sizeof(uint64_t) == 0));
+
+	cmp = u64 ? ff_key_u64_cmp : ff_key_cmp;
+	while (hi - lo > FF_FIND_SCAN_NR) {
+		m    = lo + (hi - lo) / 2;
+		diff = cmp(ff_key(node, m), fkey, ksize);
+		if (diff < 0)
+			lo = m + 1;
+		else if (diff > 0)
+			hi = m;
+		else {
+			slot->s_idx = m;
+			return true;
+		}
+	}
+
+	if (ksize == FF_KEY16_SIZE && !u64)
+		lo = ff_key16_scan(node, lo, hi, fkey, &diff);
+	else {
+		for (; lo < hi; lo++) {
+			diff = cmp(ff_key(node, lo), fkey, ksize);
+			if (diff >= 0)
+				break;
+		}
+	}
+
+	slot->s_idx = lo;
+	return lo < hi && diff == 0;
+}
+
 static void ff_child(struct slot *slot, struct segaddr *addr)
 {
 	const struct nd *node = slot->s_node;
@@ -4443,6 +4792,73 @@ static const struct node_type variable_kv_format = {
 	/* .nt_valsize_get        = ff_valsize_get, */
 };
 
+/**
+ * Variable sized keys and values node format with prefix separators.
+ *
+ * On-disk layout of the node is the same as of variable_kv_format, this node
+ * type differs only in the keys which are installed in the internal nodes.
+ * When a leaf splits, the parent does not get a copy of the first key of the
+ * right sibling, instead it gets the shortest prefix of that key which is
+ * still greater than the last key of the left sibling (see
+ * btree_separator_ksize()). For keys sharing long common prefixes (bucket
+ * name plus object path) this keeps internal node keys a few bytes long,
+ * which increases fan-out of the internal nodes and reduces tree height.
+ *
+ * Leaf keys are kept intact, as cursors and callbacks are given pointers to
+ * the keys inside the leaf node memory.
+ *
+ * Prefix separators are only valid for memcmp() ordered keys, so they are not
+ * used by trees which have user provided key comparison function. Such trees
+ * behave exactly as trees with variable_kv_format nodes. In trees without the
+ * comparison function a key is ordered after all of its prefixes (see
+ * bnode_key_cmp()), so that a separator directs the lookups of the keys it is
+ * a prefix of to the right sibling.
+ */
+static const struct node_type variable_kv_prefix_format = {
+	.nt_id                        = BNT_PREFIX_KEYSIZE_VARIABLE_VALUESIZE,
+	.nt_name                      = "m0_bnode_variable_kv_prefix_format",
+	.nt_init                      = vkvv_init,
+	.nt_fini                      = vkvv_fini,
+	.nt_crctype_get               = vkvv_crctype_get,
+	.nt_rec_count                 = vkvv_rec_count,
+	.nt_space                     = vkvv_space,
+	.nt_level                     = vkvv_level,
+	.nt_shift                     = vkvv_shift,
+	.nt_nsize                     = vkvv_nsize,
+	.nt_keysize                   = vkvv_keysize,
+	.nt_valsize                   = vkvv_valsize,
+	.nt_max_ksize                 = vkvv_max_ksize,
+	.nt_isunderflow               = vkvv_isunderflow,
+	.nt_isoverflow                = vkvv_isoverflow,
+	.nt_fid                       = vkvv_fid,
+	.nt_rec                       = vkvv_rec,
+	.nt_key                       = vkvv_node_key,
+	.nt_child                     = vkvv_child,
+	.nt_isfit                     = vkvv_isfit,
+	.nt_done                      = vkvv_done,
+	.nt_make                      = vkvv_make,
+	.nt_val_resize                = vkvv_val_resize,
+	.nt_fix                       = vkvv_fix,
+	.nt_cut                       = vkvv_cut,
+	.nt_del                       = vkvv_del,
+	.nt_set_level                 = vkvv_set_level,
+	.nt_set_rec_count             = vkvv_set_rec_count,
+	.nt_move                      = generic_move,
+	.nt_invariant                 = vkvv_invariant,
+	.nt_expensive_invariant       = vkvv_expensive_invariant,
+	.nt_isvalid                   = segaddr_header_isvalid,
+	.nt_verify                    = vkvv_verify,
+	.nt_opaque_set                = vkvv_opaque_set,
+	.nt_opaque_get                = vkvv_opaque_get,
+	.nt_capture                   = vkvv_capture,
+	.nt_create_delete_credit_size = vkvv_create_delete_credit_size,
+	.nt_node_alloc_credit         = vkvv_node_alloc_credit,
+	.nt_node_free_credit          = vkvv_node_free_credit,
+	.nt_rec_put_credit            = vkvv_rec_put_credit,
+	.nt_rec_update_credit         = vkvv_rec_update_credit,
+	.nt_rec_del_credit            = vkvv_rec_del_credit,
+};
+
 struct dir_rec {
 	uint32_t key_offset;
 	uint32_t val_offset;
@@ -4903,8 +5319,9 @@ static bool vkvv_invariant(const struct nd *node)
 	struct vkvv_head *h = vkvv_data(node);
 
 	return  _0C(h->vkvv_fmt.hd_magic == M0_FORMAT_HEADER_MAGIC) &&
-		_0C(h->vkvv_seg.h_node_type ==
-		    BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE);
+		_0C(M0_IN(h->vkvv_seg.h_node_type,
+			  (BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE,
+			   BNT_PREFIX_KEYSIZE_VARIABLE_VALUESIZE)));
 }
 
 /**
@@ -5580,6 +5997,8 @@ static const struct node_type* btree_nt_from_bt(const struct m0_btree_type *bt)
 		return &fixed_ksize_variable_vsize_format;
 	else if (bt->ksize == -1 && bt->vsize != -1)
 		M0_ASSERT(0); /** Currently we do not support this */
+	else if (bt->tt_flags & M0_BTF_PREFIX_KEYS)
+		return &variable_kv_prefix_format;
 	else
 		return &variable_kv_format;; /** Replace with correct type. */
 }
@@ -5799,6 +6218,16 @@ M0_INTERNAL void m0_btree_truncate_credit(struct m0_be_tx        *tx,
 	m0_be_tx_credit_mac(accum, &cred, *limit);
 }
 
+M0_INTERNAL void m0_btree_truncate_nr_credit(struct m0_btree        *tree,
+					     struct m0_be_tx_credit *accum,
+					     m0_bcount_t             nr)
+{
+	struct m0_be_tx_credit cred = {};
+
+	bnode_free_credit(tree->t_desc->t_root, &cred);
+	m0_be_tx_credit_mac(accum, &cred, nr);
+}
+
 /**
  *  --------------------------------------------
  *  Section END - Btree Credit
@@ -5855,17 +6284,17 @@ static bool path_check(struct m0_btree_oimpl *oi, struct td *tree,
 
 	while (total_level >= 0) {
 		l_node = oi->i_level[total_level].l_node;
-		bnode_lock(l_node);
+		bnode_read_lock(l_node);
 		if (!bnode_isvalid(l_node)) {
-			bnode_unlock(l_node);
+			bnode_read_unlock(l_node);
 			bnode_op_fini(&oi->i_nop);
 			return false;
 		}
 		if (oi->i_level[total_level].l_seq != l_node->n_seq) {
-			bnode_unlock(l_node);
+			bnode_read_unlock(l_node);
 			return false;
 		}
-		bnode_unlock(l_node);
+		bnode_read_unlock(l_node);
 		total_level--;
 	}
 	return true;
@@ -5884,17 +6313,17 @@ static bool sibling_node_check(struct m0_btree_oimpl *oi)
 	if (l_sibling == NULL || oi->i_pivot == -1)
 		return true;
 
-	bnode_lock(l_sibling);
+	bnode_read_lock(l_sibling);
 	if (!bnode_isvalid(l_sibling)) {
-		bnode_unlock(l_sibling);
+		bnode_read_unlock(l_sibling);
 		bnode_op_fini(&oi->i_nop);
 		return false;
 	}
 	if (oi->i_level[oi->i_used].l_sib_seq != l_sibling->n_seq) {
-		bnode_unlock(l_sibling);
+		bnode_read_unlock(l_sibling);
 		return false;
 	}
-	bnode_unlock(l_sibling);
+	bnode_read_unlock(l_sibling);
 	return true;
 }
 
@@ -5910,9 +6339,40 @@ static int64_t lock_op_init(struct m0_sm_op *bo_op, struct node_op  *i_nop,
 
 static void lock_op_unlock(struct td *tree)
 {
+	m0_atomic64_inc(&tree->t_wseq);
 	m0_rwlock_write_unlock(&tree->t_lock);
 }
 
+/**
+ * Takes the tree lock in shared mode. Operations which do not modify the tree
+ * (GET and ITER) are excluded from the writers by this lock but they run in
+ * parallel with each other.
+ */
+static int64_t lock_op_read_init(struct m0_sm_op *bo_op,
+				 struct node_op *i_nop, struct td *tree,
+				 int nxt)
+{
+	m0_rwlock_read_lock(&tree->t_lock);
+	return nxt;
+}
+
+static void lock_op_read_unlock(struct td *tree)
+{
+	m0_rwlock_read_unlock(&tree->t_lock);
+}
+
+/**
+ * Returns true if no writer has released the tree lock since the traversal
+ * started. As nodes are only modified under the tree lock, the traversed path
+ * is then known to be intact and the per-node sequence numbers need not be
+ * validated. Has to be called with the tree lock held.
+ */
+static bool tree_seq_check(struct m0_btree_oimpl *oi, struct td *tree)
+{
+	return !cookie_is_used() &&
+	       oi->i_wseq == m0_atomic64_get(&tree->t_wseq);
+}
+
 static void level_put(struct m0_btree_oimpl *oi)
 {
 	int i;
@@ -6003,6 +6463,122 @@ static void btree_node_capture_enlist(struct m0_btree_oimpl *oi,
 	}
 }
 
+/** Marks node_header::h_subtree_nr of the nodes of the counted trees. */
+#define BTREE_NR_COUNTED (1ULL << 63)
+
+static struct node_header *segaddr_nheader(const struct segaddr *addr)
+{
+	return segaddr_addr(addr) + sizeof(struct m0_format_header);
+}
+
+/**
+ * Returns true if the nodes of the tree keep the record counts of their
+ * subtrees, see M0_BTF_SUBTREE_COUNTS. The mark is persistent in the root.
+ */
+static bool btree_is_counted(const struct td *tree)
+{
+	return segaddr_nheader(&tree->t_root->n_addr)->h_subtree_nr &
+	       BTREE_NR_COUNTED;
+}
+
+/** Returns the number of records in the subtree rooted at addr. */
+static uint64_t segaddr_subtree_nr(const struct segaddr *addr)
+{
+	return segaddr_nheader(addr)->h_subtree_nr & ~BTREE_NR_COUNTED;
+}
+
+static void bnode_subtree_nr_set(const struct nd *node, uint64_t nr)
+{
+	segaddr_nheader(&node->n_addr)->h_subtree_nr = BTREE_NR_COUNTED | nr;
+}
+
+/**
+ * Sets the subtree record count of the node from its records, or from the
+ * counts of its children for internal nodes.
+ */
+static void bnode_subtree_nr_recount(struct nd *node)
+{
+	struct slot    s  = { .s_node = node };
+	struct segaddr child;
+	uint64_t       nr = 0;
+
+	if (bnode_level(node) == 0)
+		nr = bnode_rec_count(node);
+	else {
+		for (s.s_idx = 0; s.s_idx < bnode_rec_count(node); s.s_idx++) {
+			bnode_child(&s, &child);
+			nr += segaddr_subtree_nr(&child);
+		}
+	}
+	bnode_subtree_nr_set(node, nr);
+}
+
+/**
+ * Updates the subtree record counts of the nodes on the path of a completed
+ * put operation, which added delta records to the tree. Nodes split by the
+ * operation are recounted bottom-up, after their children, the other nodes of
+ * the path gain delta records.
+ */
+static void btree_put_subtree_nr_update(struct m0_btree_oimpl *oi,
+					const struct td *tree, int delta)
+{
+	struct level *lev;
+	int           i;
+
+	if (!btree_is_counted(tree))
+		return;
+
+	for (i = oi->i_used; i >= 0; i--) {
+		lev = &oi->i_level[i];
+		if (lev->l_alloc_in_use) {
+			bnode_subtree_nr_recount(lev->l_alloc);
+			bnode_fix(lev->l_alloc);
+			/**
+			 * Split of the root has moved its records to
+			 * i_extra_node, see btree_put_root_split_handle().
+			 */
+			if (i == 0) {
+				bnode_subtree_nr_recount(oi->i_extra_node);
+				bnode_fix(oi->i_extra_node);
+			}
+			bnode_subtree_nr_recount(lev->l_node);
+		} else if (delta != 0) {
+			bnode_subtree_nr_set(lev->l_node, delta +
+				     segaddr_subtree_nr(&lev->l_node->n_addr));
+			btree_node_capture_enlist(oi, lev->l_node,
+						  bnode_rec_count(lev->l_node));
+		} else
+			continue;
+		bnode_fix(lev->l_node);
+	}
+}
+
+/**
+ * Decrements the subtree record counts of the nodes remaining on the path of a
+ * completed delete operation.
+ */
+static void btree_del_subtree_nr_update(struct m0_btree_oimpl *oi,
+					const struct td *tree)
+{
+	struct level *lev;
+	int           i;
+
+	if (!btree_is_counted(tree))
+		return;
+
+	for (i = oi->i_used; i >= 0; i--) {
+		lev = &oi->i_level[i];
+		if (lev->l_freenode)
+			continue;
+		bnode_subtree_nr_set(lev->l_node,
+				     segaddr_subtree_nr(&lev->l_node->n_addr) -
+				     1);
+		bnode_fix(lev->l_node);
+		btree_node_capture_enlist(oi, lev->l_node,
+					  bnode_rec_count(lev->l_node));
+	}
+}
+
 /**
  * Checks if given segaddr is within segment boundaries.
 */
@@ -6166,6 +6742,55 @@ static int64_t btree_put_root_split_handle(struct m0_btree_op *bop,
 	return P_CAPTURE;
 }
 
+/**
+ * Returns the size of the key which gets installed in the parent node after
+ * split of a leaf node. The installed key is the first key of the right node.
+ *
+ * For node formats with prefix separators (variable_kv_prefix_format) only
+ * the shortest prefix of that key which is still greater than the last key of
+ * the left node is needed to direct the lookups, so the size of that prefix is
+ * returned. For other formats the complete key size is returned.
+ *
+ * @param left is the left node (l_alloc) after split.
+ * @param right is the right node (l_node) after split.
+ */
+static m0_bcount_t btree_separator_ksize(const struct nd *left,
+					 const struct nd *right)
+{
+	struct slot  lslot = { .s_node = left };
+	struct slot  rslot = { .s_node = right, .s_idx = 0 };
+	void        *p_lkey;
+	void        *p_rkey;
+	m0_bcount_t  lksize;
+	m0_bcount_t  rksize;
+	const char  *lkey;
+	const char  *rkey;
+	m0_bcount_t  i;
+
+	rslot.s_rec.r_key.k_data = M0_BUFVEC_INIT_BUF(&p_rkey, &rksize);
+	bnode_key(&rslot);
+
+	if (right->n_type->nt_id != BNT_PREFIX_KEYSIZE_VARIABLE_VALUESIZE ||
+	    bnode_level(right) != 0 ||
+	    right->n_tree->t_keycmp.rko_keycmp != NULL)
+		return rksize;
+
+	lslot.s_idx = bnode_rec_count(left) - 1;
+	lslot.s_rec.r_key.k_data = M0_BUFVEC_INIT_BUF(&p_lkey, &lksize);
+	bnode_key(&lslot);
+
+	lkey = p_lkey;
+	rkey = p_rkey;
+	for (i = 0; i < min_check(lksize, rksize) && lkey[i] == rkey[i]; i++)
+		;
+	/**
+	 * Last key of the left node is smaller than the first key of the right
+	 * node, hence the right key can not be a prefix of the left one.
+	 */
+	M0_ASSERT(i < rksize);
+	return i + 1;
+}
+
 /**
  * This function is called when there is overflow and splitting needs to be
  * done. It will move some records from right node(l_node) to left node(l_alloc)
@@ -6175,17 +6800,16 @@ static int64_t btree_put_root_split_handle(struct m0_btree_op *bop,
  * @param allocated_node It is the newly allocated node, where we want to move
  * record.
  * @param current_node It is the current node, from where we want to move record
+ * @param nr number of records to move, see btree_put_split_nr()
  * @param rec It is the given record for which we want to find slot
  * @param tgt result of record find will get stored in tgt slot
  */
 static void btree_put_split_and_find(struct nd *allocated_node,
-				     struct nd *current_node,
+				     struct nd *current_node, int nr,
 				     struct m0_btree_rec *rec, struct slot *tgt)
 {
 	struct slot              right_slot;
 	struct slot              left_slot;
-	struct m0_bufvec_cursor  cur_1;
-	struct m0_bufvec_cursor  cur_2;
 	int                      diff;
 	m0_bcount_t              ksize;
 	void                    *p_key;
@@ -6201,7 +6825,7 @@ static void btree_put_split_and_find(struct nd *allocated_node,
 
 	bnode_set_level(allocated_node, bnode_level(current_node));
 
-	bnode_move(current_node, allocated_node, D_LEFT, NR_EVEN);
+	bnode_move(current_node, allocated_node, D_LEFT, nr);
 
 	/**
 	 * Assert that nodes still contain minimum number of records in the node
@@ -6217,16 +6841,8 @@ static void btree_put_split_and_find(struct nd *allocated_node,
 	REC_INIT(&right_slot.s_rec, &p_key, &ksize, &p_val, &vsize);
 	bnode_key(&right_slot);
 
-	if (current_node->n_tree->t_keycmp.rko_keycmp != NULL) {
-		diff = current_node->n_tree->t_keycmp.rko_keycmp(
-				M0_BUFVEC_DATA(&rec->r_key.k_data),
-				M0_BUFVEC_DATA(&right_slot.s_rec.r_key.k_data));
-	} else {
-		m0_bufvec_cursor_init(&cur_1, &rec->r_key.k_data);
-		m0_bufvec_cursor_init(&cur_2, &right_slot.s_rec.r_key.k_data);
-
-		diff = m0_bufvec_cursor_cmp(&cur_1, &cur_2);
-	}
+	diff = bnode_key_cmp(current_node, &rec->r_key,
+			     &right_slot.s_rec.r_key);
 	tgt->s_node = diff < 0 ? left_slot.s_node : right_slot.s_node;
 
 	/**
@@ -6239,15 +6855,8 @@ static void btree_put_split_and_find(struct nd *allocated_node,
 		left_slot.s_idx = bnode_key_count(left_slot.s_node);
 		REC_INIT(&left_slot.s_rec, &p_key, &ksize, &p_val, &vsize);
 		bnode_key(&left_slot);
-		if (current_node->n_tree->t_keycmp.rko_keycmp != NULL) {
-			diff = current_node->n_tree->t_keycmp.rko_keycmp(
-				 M0_BUFVEC_DATA(&rec->r_key.k_data),
-				 M0_BUFVEC_DATA(&left_slot.s_rec.r_key.k_data));
-		} else {
-			m0_bufvec_cursor_init(&cur_2,
-					      &left_slot.s_rec.r_key.k_data);
-			diff = m0_bufvec_cursor_cmp(&cur_1, &cur_2);
-		}
+		diff = bnode_key_cmp(current_node, &rec->r_key,
+				     &left_slot.s_rec.r_key);
 		if (diff > 0) {
 			tgt->s_idx = bnode_key_count(left_slot.s_node) + 1;
 			return;
@@ -6257,7 +6866,32 @@ static void btree_put_split_and_find(struct nd *allocated_node,
 }
 
 /**
- * This function is responsible to handle the overflow at node at particular
+ * Returns the number of records to be moved to the new (left) node when the
+ * node at given level is split.
+ *
+ * Records are normally split evenly. For BOF_APPEND operations inserting past
+ * the last record of the node, the left node keeps m0_btree_op::bo_fill
+ * percent of the records and only the remaining ones stay with the new record,
+ * so that sorted input does not leave half-full nodes behind.
+ */
+static int btree_put_split_nr(const struct m0_btree_op *bop,
+			      const struct level *lev)
+{
+	struct nd *node = lev->l_node;
+	int        min_rec_count;
+	int        nr;
+
+	if (!(bop->bo_flags & BOF_APPEND) || lev->l_idx < bnode_key_count(node))
+		return NR_EVEN;
+
+	min_rec_count = bnode_level(node) > 0 ? 2 : 1;
+	nr = bnode_rec_count(node) * bop->bo_fill / 100;
+	return max32(min32(nr, bnode_rec_count(node) - min_rec_count),
+		     min_rec_count);
+}
+
+/**
+ * This function is responsible to handle the overflow at node at particular
  * level. It will get called when given record is not able to fit in node. This
  * function will split the node and update bop->bo_rec which needs to get added
  * at parent node.
@@ -6302,7 +6936,9 @@ static int64_t btree_put_makespace_phase(struct m0_btree_op *bop)
 
 	lev->l_alloc_in_use = true;
 
-	btree_put_split_and_find(lev->l_alloc, lev->l_node, &bop->bo_rec, &tgt);
+	btree_put_split_and_find(lev->l_alloc, lev->l_node,
+				 btree_put_split_nr(bop, lev), &bop->bo_rec,
+				 &tgt);
 
 	if (!oi->i_key_found) {
 		/* PUT operation */
@@ -6372,6 +7008,7 @@ static int64_t btree_put_makespace_phase(struct m0_btree_op *bop)
 	node_slot.s_idx = 0;
 	REC_INIT(&node_slot.s_rec, &p_key, &ksize, &p_val, &vsize);
 	bnode_key(&node_slot);
+	ksize = btree_separator_ksize(lev->l_alloc, lev->l_node);
 	new_rec.r_key = node_slot.s_rec.r_key;
 
 	newv_ptr      = &(lev->l_alloc->n_addr);
@@ -6414,7 +7051,8 @@ static int64_t btree_put_makespace_phase(struct m0_btree_op *bop)
 
 		lev->l_alloc_in_use = true;
 
-		btree_put_split_and_find(lev->l_alloc, lev->l_node, &new_rec,
+		btree_put_split_and_find(lev->l_alloc, lev->l_node,
+					 btree_put_split_nr(bop, lev), &new_rec,
 					 &tgt);
 
 		tgt.s_rec = new_rec;
@@ -6841,6 +7479,7 @@ static int64_t btree_put_kv_tick(struct m0_sm_op *smop)
 		return P_CAPTURE;
 	}
 	case P_CAPTURE:
+		btree_put_subtree_nr_update(oi, tree, oi->i_key_found ? 0 : 1);
 		btree_tx_nodes_capture(oi, bop->bo_tx);
 		lock_op_unlock(tree);
 		return m0_sm_op_sub(&bop->bo_op, P_CLEANUP, P_FINI);
@@ -7105,6 +7744,10 @@ static int64_t btree_create_tree_tick(struct m0_sm_op *smop)
 		m0_rwlock_write_lock(&bop->bo_arbor->t_desc->t_lock);
 		bop->bo_arbor->t_desc->t_height = bop->bo_arbor->t_height;
 		bop->bo_arbor->t_desc->t_keycmp = bop->bo_keycmp;
+		if (data->bt->tt_flags & M0_BTF_SUBTREE_COUNTS) {
+			bnode_subtree_nr_set(oi->i_nop.no_node, 0);
+			bnode_fix(oi->i_nop.no_node);
+		}
 		node_slot.s_node                = oi->i_nop.no_node;
 		node_slot.s_idx                 = 0;
 		bnode_capture(&node_slot, bop->bo_tx);
@@ -7289,29 +7932,29 @@ static int  btree_sibling_first_key(struct m0_btree_oimpl *oi, struct td *tree)
 
 	for (i = oi->i_used - 1; i >= 0; i--) {
 		lev = &oi->i_level[i];
-		bnode_lock(lev->l_node);
+		bnode_read_lock(lev->l_node);
 		if (lev->l_idx < bnode_key_count(lev->l_node)) {
 			s.s_node = oi->i_nop.no_node = lev->l_node;
 			s.s_idx = lev->l_idx + 1;
-			bnode_unlock(lev->l_node);
+			bnode_read_unlock(lev->l_node);
 			while (i < oi->i_used) {
 				curr_node = oi->i_nop.no_node;
-				bnode_lock(curr_node);
+				bnode_read_lock(curr_node);
 
 				if (!bnode_isvalid(curr_node) ||
 				    (oi->i_pivot > 0 &&
 				     bnode_rec_count(curr_node) == 0)) {
-						bnode_unlock(curr_node);
+						bnode_read_unlock(curr_node);
 						return M0_ERR(-EACCES);
 				}
 
 				bnode_child(&s, &child);
 				if (!address_in_segment(child)) {
-					bnode_unlock(curr_node);
+					bnode_read_unlock(curr_node);
 					return M0_ERR(-EFAULT);
 				}
 				i++;
-				bnode_unlock(curr_node);
+				bnode_read_unlock(curr_node);
 				bnode_get(&oi->i_nop, tree, &child, P_CLEANUP);
 				if (oi->i_nop.no_op.o_sm.sm_rc != 0)
 					return oi->i_nop.no_op.o_sm.sm_rc;
@@ -7322,7 +7965,7 @@ static int  btree_sibling_first_key(struct m0_btree_oimpl *oi, struct td *tree)
 			}
 			return 0;
 		}
-		bnode_unlock(lev->l_node);
+		bnode_read_unlock(lev->l_node);
 	}
 	return -ENOENT;
 }
@@ -7362,8 +8005,8 @@ static int64_t btree_get_kv_tick(struct m0_sm_op *smop)
 			return P_SETUP;
 	case P_LOCKALL:
 		M0_ASSERT(bop->bo_flags & BOF_LOCKALL);
-		return lock_op_init(&bop->bo_op, &bop->bo_i->i_nop,
-				    bop->bo_arbor->t_desc, P_SETUP);
+		return lock_op_read_init(&bop->bo_op, &bop->bo_i->i_nop,
+				         bop->bo_arbor->t_desc, P_SETUP);
 	case P_SETUP:
 		oi->i_height = tree->t_height;
 		memset(&oi->i_level, 0, sizeof oi->i_level);
@@ -7371,6 +8014,7 @@ static int64_t btree_get_kv_tick(struct m0_sm_op *smop)
 		/** Fall through to P_DOWN. */
 	case P_DOWN:
 		oi->i_used = 0;
+		oi->i_wseq = m0_atomic64_get(&tree->t_wseq);
 		return bnode_get(&oi->i_nop, tree, &tree->t_root->n_addr,
 				 P_NEXTDOWN);
 	case P_NEXTDOWN:
@@ -7382,7 +8026,7 @@ static int64_t btree_get_kv_tick(struct m0_sm_op *smop)
 			lev->l_node = oi->i_nop.no_node;
 			s.s_node = oi->i_nop.no_node;
 
-			bnode_lock(lev->l_node);
+			bnode_read_lock(lev->l_node);
 			lev->l_seq = lev->l_node->n_seq;
 
 			/**
@@ -7397,7 +8041,7 @@ static int64_t btree_get_kv_tick(struct m0_sm_op *smop)
 			 */
 			if (!bnode_isvalid(lev->l_node) || (oi->i_used > 0 &&
 			    bnode_rec_count(lev->l_node) == 0)) {
-				bnode_unlock(lev->l_node);
+				bnode_read_unlock(lev->l_node);
 				return m0_sm_op_sub(&bop->bo_op, P_CLEANUP,
 						    P_SETUP);
 			}
@@ -7420,7 +8064,7 @@ static int64_t btree_get_kv_tick(struct m0_sm_op *smop)
 
 				bnode_child(&s, &child);
 				if (!address_in_segment(child)) {
-					bnode_unlock(lev->l_node);
+					bnode_read_unlock(lev->l_node);
 					bnode_op_fini(&oi->i_nop);
 					return fail(bop, M0_ERR(-EFAULT));
 				}
@@ -7428,21 +8072,21 @@ static int64_t btree_get_kv_tick(struct m0_sm_op *smop)
 				if (oi->i_used >= oi->i_height) {
 					/* If height of tree increased. */
 					oi->i_used = oi->i_height - 1;
-					bnode_unlock(lev->l_node);
+					bnode_read_unlock(lev->l_node);
 					return m0_sm_op_sub(&bop->bo_op,
 							    P_CLEANUP, P_SETUP);
 				}
-				bnode_unlock(lev->l_node);
+				bnode_read_unlock(lev->l_node);
 				return bnode_get(&oi->i_nop, tree, &child,
 						 P_NEXTDOWN);
 			} else {
 				if ((lev->l_idx == bnode_key_count(lev->l_node)) &&
 				    (!oi->i_key_found) &&
 				    (bop->bo_flags & BOF_SLANT)) {
-					bnode_unlock(lev->l_node);
+					bnode_read_unlock(lev->l_node);
 					return P_SIBLING;
 				}
-				bnode_unlock(lev->l_node);
+				bnode_read_unlock(lev->l_node);
 				return P_LOCK;
 			}
 		} else {
@@ -7462,38 +8106,39 @@ static int64_t btree_get_kv_tick(struct m0_sm_op *smop)
 			return P_LOCK;
 		}
 
-		bnode_lock(lev->l_sibling);
+		bnode_read_lock(lev->l_sibling);
 		lev->l_sib_seq = lev->l_sibling->n_seq;
-		bnode_unlock(lev->l_sibling);
+		bnode_read_unlock(lev->l_sibling);
 
 		return P_LOCK;
 	}
 	case P_LOCK:
 		if (!lock_acquired)
-			return lock_op_init(&bop->bo_op, &bop->bo_i->i_nop,
-					    bop->bo_arbor->t_desc, P_CHECK);
+			return lock_op_read_init(&bop->bo_op, &bop->bo_i->i_nop,
+					         bop->bo_arbor->t_desc, P_CHECK);
 		/** Fall through if LOCK is already acquired. */
 	case P_CHECK:
-		if (!path_check(oi, tree, &bop->bo_rec.r_key.k_cookie) ||
-		    !sibling_node_check(oi)) {
+		if (!tree_seq_check(oi, tree) &&
+		    (!path_check(oi, tree, &bop->bo_rec.r_key.k_cookie) ||
+		     !sibling_node_check(oi))) {
 			oi->i_trial++;
 			if (oi->i_trial >= MAX_TRIALS) {
 				M0_ASSERT_INFO((bop->bo_flags & BOF_LOCKALL) ==
 					       0, "Get record failure in tree"
 					       "lock mode");
 				bop->bo_flags |= BOF_LOCKALL;
-				lock_op_unlock(tree);
+				lock_op_read_unlock(tree);
 				return m0_sm_op_sub(&bop->bo_op, P_CLEANUP,
 						    P_LOCKALL);
 			}
 			if (oi->i_height != tree->t_height) {
 				/* If height has changed. */
-				lock_op_unlock(tree);
+				lock_op_read_unlock(tree);
 				return m0_sm_op_sub(&bop->bo_op, P_CLEANUP,
 				                    P_SETUP);
 			} else {
 				/* If height is same, put back all the nodes. */
-				lock_op_unlock(tree);
+				lock_op_read_unlock(tree);
 				level_put(oi);
 				return P_DOWN;
 			}
@@ -7530,7 +8175,7 @@ static int64_t btree_get_kv_tick(struct m0_sm_op *smop)
 			if (oi->i_key_found)
 				bnode_rec(&s);
 			else if (bop->bo_flags & BOF_EQUAL) {
-				lock_op_unlock(tree);
+				lock_op_read_unlock(tree);
 				return fail(bop, -ENOENT);
 			} else { /** bop->bo_flags & BOF_SLANT */
 				if (lev->l_idx < count)
@@ -7542,7 +8187,7 @@ static int64_t btree_get_kv_tick(struct m0_sm_op *smop)
 						bnode_rec(&s);
 					} else {
 						bnode_op_fini(&oi->i_nop);
-						lock_op_unlock(tree);
+						lock_op_read_unlock(tree);
 						return fail(bop, -ENOENT);
 					}
 				}
@@ -7555,7 +8200,7 @@ static int64_t btree_get_kv_tick(struct m0_sm_op *smop)
 				bnode_rec(&s);
 			} else {
 				/** Only root node is present and is empty. */
-				lock_op_unlock(tree);
+				lock_op_read_unlock(tree);
 				return fail(bop, -ENOENT);
 			}
 		}
@@ -7563,7 +8208,7 @@ static int64_t btree_get_kv_tick(struct m0_sm_op *smop)
 		if (bop->bo_cb.c_act != NULL)
 			rc = bop->bo_cb.c_act(&bop->bo_cb, &s.s_rec);
 
-		lock_op_unlock(tree);
+		lock_op_read_unlock(tree);
 		if (rc != 0)
 			return fail(bop, rc);
 		return m0_sm_op_sub(&bop->bo_op, P_CLEANUP, P_FINI);
@@ -7581,6 +8226,55 @@ static int64_t btree_get_kv_tick(struct m0_sm_op *smop)
 }
 
 /** Iterator state machine. */
+/**
+ * Called when the iterator leaves the current leaf for its sibling. If both
+ * leaves have the same parent, advises the kernel to page in the leaf which is
+ * m0_btree_op::bo_prefetch leaves past the sibling, in the direction of the
+ * iteration. As the iteration proceeds, this keeps the page-in of that many
+ * leaves ahead in flight while the records of the current leaf are processed.
+ *
+ * All the nodes of the tree are of the same size, so the size of the parent is
+ * used and the header of the leaf, which is not in memory yet, is not touched.
+ * The advice is a hint only, errors are ignored.
+ */
+static void btree_iter_prefetch(struct m0_btree_op *bop)
+{
+#ifndef __KERNEL__
+	struct m0_btree_oimpl *oi     = bop->bo_i;
+	struct level          *parent;
+	struct slot            s      = {};
+	struct segaddr         child;
+	uintptr_t              pgmask = m0_pagesize_get() - 1;
+	uintptr_t              start;
+	uintptr_t              end;
+	int                    idx;
+
+	if (bop->bo_prefetch == 0 || oi->i_used == 0 ||
+	    oi->i_pivot != oi->i_used - 1)
+		return;
+
+	parent = &oi->i_level[oi->i_pivot];
+	idx    = parent->l_idx + ((bop->bo_flags & BOF_NEXT) ?
+				  (int)bop->bo_prefetch + 1 :
+				  -(int)bop->bo_prefetch - 1);
+	s.s_node = parent->l_node;
+	s.s_idx  = idx;
+	bnode_read_lock(parent->l_node);
+	if (idx >= 0 && idx <= bnode_key_count(parent->l_node) &&
+	    bnode_isvalid(parent->l_node)) {
+		bnode_child(&s, &child);
+		if (address_in_segment(child)) {
+			start = (uintptr_t)segaddr_addr(&child) & ~pgmask;
+			end   = ((uintptr_t)segaddr_addr(&child) +
+				 parent->l_node->n_size + pgmask) & ~pgmask;
+			(void)madvise((void *)start, end - start,
+				      MADV_WILLNEED);
+		}
+	}
+	bnode_read_unlock(parent->l_node);
+#endif
+}
+
 static int64_t btree_iter_kv_tick(struct m0_sm_op *smop)
 {
 	struct m0_btree_op    *bop            = M0_AMB(bop, smop, bo_op);
@@ -7609,8 +8303,8 @@ static int64_t btree_iter_kv_tick(struct m0_sm_op *smop)
 			return P_SETUP;
 	case P_LOCKALL:
 		M0_ASSERT(bop->bo_flags & BOF_LOCKALL);
-		return lock_op_init(&bop->bo_op, &bop->bo_i->i_nop,
-				    bop->bo_arbor->t_desc, P_SETUP);
+		return lock_op_read_init(&bop->bo_op, &bop->bo_i->i_nop,
+				         bop->bo_arbor->t_desc, P_SETUP);
 	case P_SETUP:
 		oi->i_height = tree->t_height;
 		memset(&oi->i_level, 0, sizeof oi->i_level);
@@ -7619,6 +8313,7 @@ static int64_t btree_iter_kv_tick(struct m0_sm_op *smop)
 	case P_DOWN:
 		oi->i_used  = 0;
 		oi->i_pivot = -1;
+		oi->i_wseq  = m0_atomic64_get(&tree->t_wseq);
 		return bnode_get(&oi->i_nop, tree, &tree->t_root->n_addr,
 				 P_NEXTDOWN);
 	case P_NEXTDOWN:
@@ -7630,7 +8325,7 @@ static int64_t btree_iter_kv_tick(struct m0_sm_op *smop)
 			lev->l_node = oi->i_nop.no_node;
 			s.s_node = oi->i_nop.no_node;
 
-			bnode_lock(lev->l_node);
+			bnode_read_lock(lev->l_node);
 			lev->l_seq = lev->l_node->n_seq;
 
 			/**
@@ -7645,7 +8340,7 @@ static int64_t btree_iter_kv_tick(struct m0_sm_op *smop)
 			 */
 			if (!bnode_isvalid(lev->l_node) || (oi->i_used > 0 &&
 			    bnode_rec_count(lev->l_node) == 0)) {
-				bnode_unlock(lev->l_node);
+				bnode_read_unlock(lev->l_node);
 				return m0_sm_op_sub(&bop->bo_op, P_CLEANUP,
 						    P_SETUP);
 			}
@@ -7674,7 +8369,7 @@ static int64_t btree_iter_kv_tick(struct m0_sm_op *smop)
 
 				bnode_child(&s, &child);
 				if (!address_in_segment(child)) {
-					bnode_unlock(lev->l_node);
+					bnode_read_unlock(lev->l_node);
 					bnode_op_fini(&oi->i_nop);
 					return fail(bop, M0_ERR(-EFAULT));
 				}
@@ -7682,11 +8377,11 @@ static int64_t btree_iter_kv_tick(struct m0_sm_op *smop)
 				if (oi->i_used >= oi->i_height) {
 					/* If height of tree increased. */
 					oi->i_used = oi->i_height - 1;
-					bnode_unlock(lev->l_node);
+					bnode_read_unlock(lev->l_node);
 					return m0_sm_op_sub(&bop->bo_op,
 							    P_CLEANUP, P_SETUP);
 				}
-				bnode_unlock(lev->l_node);
+				bnode_read_unlock(lev->l_node);
 				return bnode_get(&oi->i_nop, tree, &child,
 						 P_NEXTDOWN);
 			} else	{
@@ -7707,10 +8402,10 @@ static int64_t btree_iter_kv_tick(struct m0_sm_op *smop)
 				 *   leftmost for PREV flag).
 				 */
 				if (index_is_valid(lev) || oi->i_pivot == -1) {
-					bnode_unlock(lev->l_node);
+					bnode_read_unlock(lev->l_node);
 					return P_LOCK;
 				}
-				bnode_unlock(lev->l_node);
+				bnode_read_unlock(lev->l_node);
 				/**
 				 * We are here, it means we want to load
 				 * sibling node of the leaf node.
@@ -7720,18 +8415,19 @@ static int64_t btree_iter_kv_tick(struct m0_sm_op *smop)
 				 * idx's child node else clean up and restart
 				 * state machine.
 				 */
+				btree_iter_prefetch(bop);
 				lev = &oi->i_level[oi->i_pivot];
-				bnode_lock(lev->l_node);
+				bnode_read_lock(lev->l_node);
 				if (!bnode_isvalid(lev->l_node) ||
 				    (oi->i_pivot > 0 &&
 				     bnode_rec_count(lev->l_node) == 0)) {
-					bnode_unlock(lev->l_node);
+					bnode_read_unlock(lev->l_node);
 					bnode_op_fini(&oi->i_nop);
 					return m0_sm_op_sub(&bop->bo_op,
 							    P_CLEANUP, P_SETUP);
 				}
 				if (lev->l_seq != lev->l_node->n_seq) {
-					bnode_unlock(lev->l_node);
+					bnode_read_unlock(lev->l_node);
 					return m0_sm_op_sub(&bop->bo_op,
 							    P_CLEANUP, P_SETUP);
 				}
@@ -7748,12 +8444,12 @@ static int64_t btree_iter_kv_tick(struct m0_sm_op *smop)
 
 				bnode_child(&s, &child);
 				if (!address_in_segment(child)) {
-					bnode_unlock(lev->l_node);
+					bnode_read_unlock(lev->l_node);
 					bnode_op_fini(&oi->i_nop);
 					return fail(bop, M0_ERR(-EFAULT));
 				}
 				oi->i_pivot++;
-				bnode_unlock(lev->l_node);
+				bnode_read_unlock(lev->l_node);
 				return bnode_get(&oi->i_nop, tree, &child,
 						 P_SIBLING);
 			}
@@ -7769,7 +8465,7 @@ static int64_t btree_iter_kv_tick(struct m0_sm_op *smop)
 			lev = &oi->i_level[oi->i_pivot];
 			lev->l_sibling = oi->i_nop.no_node;
 			s.s_node = oi->i_nop.no_node;
-			bnode_lock(lev->l_sibling);
+			bnode_read_lock(lev->l_sibling);
 			lev->l_sib_seq = lev->l_sibling->n_seq;
 
 			/**
@@ -7785,7 +8481,7 @@ static int64_t btree_iter_kv_tick(struct m0_sm_op *smop)
 			if (!bnode_isvalid(lev->l_sibling) ||
 			    (oi->i_pivot > 0 &&
 			     bnode_rec_count(lev->l_sibling) == 0)) {
-				bnode_unlock(lev->l_sibling);
+				bnode_read_unlock(lev->l_sibling);
 				return m0_sm_op_sub(&bop->bo_op, P_CLEANUP,
 						    P_SETUP);
 			}
@@ -7795,22 +8491,22 @@ static int64_t btree_iter_kv_tick(struct m0_sm_op *smop)
 					  bnode_key_count(s.s_node);
 				bnode_child(&s, &child);
 				if (!address_in_segment(child)) {
-					bnode_unlock(lev->l_sibling);
+					bnode_read_unlock(lev->l_sibling);
 					bnode_op_fini(&oi->i_nop);
 					return fail(bop, M0_ERR(-EFAULT));
 				}
 				oi->i_pivot++;
 				if (oi->i_pivot >= oi->i_height) {
 					/* If height of tree increased. */
-					bnode_unlock(lev->l_sibling);
+					bnode_read_unlock(lev->l_sibling);
 					return m0_sm_op_sub(&bop->bo_op,
 							    P_CLEANUP, P_SETUP);
 				}
-				bnode_unlock(lev->l_sibling);
+				bnode_read_unlock(lev->l_sibling);
 				return bnode_get(&oi->i_nop, tree, &child,
 						 P_SIBLING);
 			} else {
-				bnode_unlock(lev->l_sibling);
+				bnode_read_unlock(lev->l_sibling);
 				return P_LOCK;
 			}
 		} else {
@@ -7819,29 +8515,30 @@ static int64_t btree_iter_kv_tick(struct m0_sm_op *smop)
 		}
 	case P_LOCK:
 		if (!lock_acquired)
-			return lock_op_init(&bop->bo_op, &bop->bo_i->i_nop,
-					    bop->bo_arbor->t_desc, P_CHECK);
+			return lock_op_read_init(&bop->bo_op, &bop->bo_i->i_nop,
+					         bop->bo_arbor->t_desc, P_CHECK);
 		/** Fall through if LOCK is already acquired. */
 	case P_CHECK:
-		if (!path_check(oi, tree, &bop->bo_rec.r_key.k_cookie) ||
-		    !sibling_node_check(oi)) {
+		if (!tree_seq_check(oi, tree) &&
+		    (!path_check(oi, tree, &bop->bo_rec.r_key.k_cookie) ||
+		     !sibling_node_check(oi))) {
 			oi->i_trial++;
 			if (oi->i_trial >= MAX_TRIALS) {
 				M0_ASSERT_INFO((bop->bo_flags & BOF_LOCKALL) ==
 					       0, "Iterator failure in tree"
 					       "lock mode");
 				bop->bo_flags |= BOF_LOCKALL;
-				lock_op_unlock(tree);
+				lock_op_read_unlock(tree);
 				return m0_sm_op_sub(&bop->bo_op, P_CLEANUP,
 						    P_LOCKALL);
 			}
 			if (oi->i_height != tree->t_height) {
-				lock_op_unlock(tree);
+				lock_op_read_unlock(tree);
 				return m0_sm_op_sub(&bop->bo_op, P_CLEANUP,
 				                    P_SETUP);
 			} else {
 				/* If height is same, put back all the nodes. */
-				lock_op_unlock(tree);
+				lock_op_read_unlock(tree);
 				level_put(oi);
 				return P_DOWN;
 			}
@@ -7870,7 +8567,7 @@ static int64_t btree_iter_kv_tick(struct m0_sm_op *smop)
 			bnode_rec(&s);
 		} else if (oi->i_pivot == -1) {
 			/* Handle rightmost/leftmost key case. */
-			lock_op_unlock(tree);
+			lock_op_read_unlock(tree);
 			return fail(bop, -ENOENT);
 		} else {
 			/* Return sibling record based on flag. */
@@ -7880,7 +8577,7 @@ static int64_t btree_iter_kv_tick(struct m0_sm_op *smop)
 			bnode_rec(&s);
 		}
 		rc = bop->bo_cb.c_act(&bop->bo_cb, &s.s_rec);
-		lock_op_unlock(tree);
+		lock_op_read_unlock(tree);
 		if (rc != 0)
 			return fail(bop, rc);
 		return m0_sm_op_sub(&bop->bo_op, P_CLEANUP, P_FINI);
@@ -8395,6 +9092,7 @@ static int64_t btree_del_kv_tick(struct m0_sm_op *smop)
 		return btree_del_resolve_underflow(bop);
 	}
 	case P_CAPTURE:
+		btree_del_subtree_nr_update(oi, tree);
 		btree_tx_nodes_capture(oi, bop->bo_tx);
 		return P_FREENODE;
 	case P_FREENODE : {
@@ -8519,6 +9217,10 @@ static int64_t btree_truncate_tick(struct m0_sm_op *smop)
 		 */
 		if (oi->i_used == 0) {
 			bnode_set_level(lev->l_node, 0);
+			if (btree_is_counted(tree)) {
+				bnode_subtree_nr_set(lev->l_node, 0);
+				bnode_fix(lev->l_node);
+			}
 			bnode_capture(&node_slot, bop->bo_tx);
 			lock_op_unlock(tree);
 			return m0_sm_op_sub(&bop->bo_op, P_CLEANUP, P_FINI);
@@ -8547,6 +9249,10 @@ static int64_t btree_truncate_tick(struct m0_sm_op *smop)
 		 */
 		if (rec_count == 0) {
 			bnode_set_level(parent->l_node, 0);
+			if (btree_is_counted(tree)) {
+				bnode_subtree_nr_set(parent->l_node, 0);
+				bnode_fix(parent->l_node);
+			}
 			node_slot.s_node = parent->l_node;
 			node_slot.s_idx  = 0;
 			bnode_capture(&node_slot, bop->bo_tx);
@@ -8576,33 +9282,18 @@ static int64_t btree_truncate_tick(struct m0_sm_op *smop)
 }
 
 #ifndef __KERNEL__
-static int unmap_node(void* addr, int64_t size)
-{
-	return munmap(addr, size);
-}
-
-static int remap_node(void* addr, int64_t size, struct m0_be_seg *seg)
-{
-	void *p;
-	m0_bcount_t file_offset = (m0_bcount_t)(addr - seg->bs_addr);
-	p = mmap(addr, size, PROT_READ | PROT_WRITE,
-		 MAP_FIXED | MAP_PRIVATE | MAP_NORESERVE,
-		 m0_stob_fd(seg->bs_stob), file_offset);
-	if (p == MAP_FAILED)
-		return M0_ERR(-EFAULT);
-	return 0;
-}
-
 /**
- * This function will try to unmap and remap the nodes in LRU list to free up
- * virtual page memory. The amount of memory to be freed will be given, and
- * attempt will be made to free up the requested size.
- *
- * @param size the total size in bytes to be freed from the swap.
+ * Drops the memory of the nodes from the tail of the given LRU list until
+ * either size bytes or num_nodes nodes were freed, whichever is specified.
+ * size and num_nodes are updated to reflect the remaining amount. The segment
+ * of the last freed node is returned in *last. Should be called with list_lock
+ * held.
  *
- * @return int the total size in bytes that was freed.
+ * @return the total size in bytes that was freed.
  */
-M0_INTERNAL int64_t m0_btree_lrulist_purge(int64_t size, int64_t num_nodes)
+static int64_t btree_lru_list_purge(struct m0_tl *list, int64_t *size,
+				    int64_t *num_nodes, uint64_t *evicted,
+				    struct m0_be_seg **last)
 {
 	struct nd              *node;
 	struct nd              *prev;
@@ -8613,14 +9304,10 @@ M0_INTERNAL int64_t m0_btree_lrulist_purge(int64_t size, int64_t num_nodes)
 	struct m0_be_allocator *a;
 	int                     rc;
 
-	M0_PRE(size >= 0 && num_nodes >= 0);
-	M0_PRE((size == 0 && num_nodes != 0) || (size != 0 && num_nodes == 0));
-
-	m0_rwlock_write_lock(&list_lock);
-	node = ndlist_tlist_tail(&btree_lru_nds);
-	while (node != NULL && (size > 0 || num_nodes > 0)) {
+	node = ndlist_tlist_tail(list);
+	while (node != NULL && (*size > 0 || *num_nodes > 0)) {
 		curr_size = 0;
-		prev      = ndlist_tlist_prev(&btree_lru_nds, node);
+		prev      = ndlist_tlist_prev(list, node);
 		if (node->n_txref == 0 && node->n_ref == 0) {
 			curr_size = node->n_size + m0_be_chunk_header_size();
 			seg       = node->n_seg;
@@ -8629,28 +9316,67 @@ M0_INTERNAL int64_t m0_btree_lrulist_purge(int64_t size, int64_t num_nodes)
 			rnode    -= m0_be_chunk_header_size();
 
 			m0_mutex_lock(&a->ba_lock);
-			rc = unmap_node(rnode, curr_size);
+			rc = m0_be_seg_pages_drop(seg, rnode, curr_size);
 			if (rc == 0) {
-				rc = remap_node(rnode, curr_size, seg);
-				if (rc == 0) {
-					if (size > 0)
-						size -= curr_size;
-					if (num_nodes > 0)
-						--num_nodes;
-					total_size += curr_size;
-					ndlist_tlink_del_fini(node);
-					lru_space_used -= curr_size;
-					m0_rwlock_fini(&node->n_lock);
-					m0_free(node);
-				} else
-					M0_LOG(M0_ERROR,
-					       "Remapping of memory failed");
+				if (*size > 0)
+					*size -= curr_size;
+				if (*num_nodes > 0)
+					--*num_nodes;
+				total_size += curr_size;
+				ndlist_tlink_del_fini(node);
+				lru_space_used -= curr_size;
+				m0_rwlock_fini(&node->n_lock);
+				m0_free(node);
+				++*evicted;
+				*last = seg;
 			} else
-				M0_LOG(M0_ERROR, "Unmapping of memory failed");
+				M0_LOG(M0_ERROR, "Dropping of memory failed");
 			m0_mutex_unlock(&a->ba_lock);
 		}
 		node = prev;
 	}
+	return total_size;
+}
+
+/**
+ * This function will try to drop the memory of the nodes in LRU lists to free
+ * up virtual page memory. The amount of memory to be freed will be given, and
+ * attempt will be made to free up the requested size. Nodes from
+ * btree_lru_nds are freed first, btree_lru_hot_nds is only purged when the
+ * former list does not have enough nodes.
+ *
+ * Residency of the segment the nodes were freed from is checked by parts on
+ * each purge, see m0_be_seg_residency_scan().
+ *
+ * @param size the total size in bytes to be freed from the swap.
+ *
+ * @return int the total size in bytes that was freed.
+ */
+M0_INTERNAL int64_t m0_btree_lrulist_purge(int64_t size, int64_t num_nodes)
+{
+	struct m0_be_seg *seg = NULL;
+	int64_t           total_size;
+	int64_t           hot_nr;
+	int64_t           cold_nr;
+
+	M0_PRE(size >= 0 && num_nodes >= 0);
+	M0_PRE((size == 0 && num_nodes != 0) || (size != 0 && num_nodes == 0));
+
+	m0_rwlock_write_lock(&list_lock);
+	total_size = btree_lru_list_purge(&btree_lru_nds, &size, &num_nodes,
+					  &lru_stats.ls_evict, &seg);
+	if (size > 0 || num_nodes > 0)
+		total_size += btree_lru_list_purge(&btree_lru_hot_nds, &size,
+						   &num_nodes,
+						   &lru_stats.ls_hot_evict,
+						   &seg);
+	if (seg != NULL)
+		m0_be_seg_residency_scan(seg);
+	hot_nr  = ndlist_tlist_length(&btree_lru_hot_nds);
+	cold_nr = ndlist_tlist_length(&btree_lru_nds);
+	M0_ADDB2_ADD(M0_AVI_BE_BTREE_LRU, lru_stats.ls_hit, lru_stats.ls_miss,
+		     lru_stats.ls_evict, lru_stats.ls_hot_evict, hot_nr,
+		     cold_nr);
 	m0_rwlock_write_unlock(&list_lock);
 	return total_size;
 }
@@ -8829,6 +9555,7 @@ M0_INTERNAL void m0_btree_iter(struct m0_btree *arbor,
 	bop->bo_tx        = NULL;
 	bop->bo_seg       = NULL;
 	bop->bo_i         = NULL;
+	bop->bo_prefetch  = 0;
 	m0_sm_op_init(&bop->bo_op, &btree_iter_kv_tick, &bop->bo_op_exec,
 		      &btree_conf, &bop->bo_sm_group);
 }
@@ -8936,721 +9663,1047 @@ M0_INTERNAL void m0_btree_truncate(struct m0_btree *arbor, m0_bcount_t limit,
 	m0_sm_op_init(&bop->bo_op, &btree_truncate_tick, &bop->bo_op_exec,
 		      &btree_conf, &bop->bo_sm_group);
 }
-struct cursor_cb_data {
-	struct m0_btree_rec ccd_rec;
-	m0_bcount_t         ccd_keysz;
-	m0_bcount_t         ccd_valsz;
-};
-
-static int btree_cursor_kv_get_cb(struct m0_btree_cb  *cb,
-				  struct m0_btree_rec *rec)
+/**
+ * Compares two keys in the key order of the tree.
+ */
+static int btree_key_cmp(struct td *tree, const struct m0_btree_key *k0,
+			 const struct m0_btree_key *k1)
 {
-	struct m0_btree_cursor  *datum = cb->c_datum;
-	struct m0_bufvec_cursor  cur;
-
-	/** Currently we support bufvec with only one segment. */
-	M0_ASSERT(M0_BUFVEC_SEG_COUNT(&rec->r_key.k_data) == 1 &&
-		  M0_BUFVEC_SEG_COUNT(&rec->r_val) == 1);
-
-	/** Save returned Key and Value in the iterator */
-	m0_bufvec_cursor_init(&cur, &rec->r_key.k_data);
-	datum->bc_key = M0_BUF_INIT(m0_bufvec_cursor_step(&cur),
-				    m0_bufvec_cursor_addr(&cur));
-
-	m0_bufvec_cursor_init(&cur, &rec->r_val);
-	datum->bc_val = M0_BUF_INIT(m0_bufvec_cursor_step(&cur),
-				    m0_bufvec_cursor_addr(&cur));
-
-	return 0;
+	return bnode_key_cmp(tree->t_root, k0, k1);
 }
 
-M0_INTERNAL void m0_btree_cursor_init(struct m0_btree_cursor *it,
-				      struct m0_btree        *arbor)
+static bool btree_keys_are_sorted(struct td *tree,
+				  const struct m0_btree_key *keys, uint32_t nr,
+				  size_t stride)
 {
-	M0_SET0(it);
-	it->bc_arbor = arbor;
+	const struct m0_btree_key *prev = NULL;
+	const struct m0_btree_key *key;
+	uint32_t                   i;
+
+	for (i = 0; i < nr; i++, prev = key) {
+		key = (void *)keys + i * stride;
+		if (prev != NULL && btree_key_cmp(tree, prev, key) > 0)
+			return false;
+	}
+	return true;
 }
 
-M0_INTERNAL void m0_btree_cursor_fini(struct m0_btree_cursor *it)
+/**
+ * Puts back the nodes held by m0_btree_mget() starting from the given level.
+ */
+static void btree_mget_path_put(struct node_op *nop, struct nd **path,
+				int from, int to)
 {
+	for (; from < to; from++) {
+		if (path[from] != NULL) {
+			bnode_put(nop, path[from]);
+			path[from] = NULL;
+		}
+	}
 }
 
-M0_INTERNAL int m0_btree_cursor_get(struct m0_btree_cursor     *it,
-				    const struct m0_btree_key *key,
-				    bool                       slant)
+/**
+ * Checks whether the leaf can answer a lookup of key without walking down
+ * from the root again, i.e. key lies between the first and the last key of the
+ * leaf. Keys outside of this range may still be absent from the tree, but only
+ * a full descent can tell.
+ */
+static bool btree_mget_leaf_covers(struct td *tree, struct nd *leaf,
+				   const struct m0_btree_key *key)
 {
-	struct m0_btree_op    kv_op = {};
-	struct m0_btree_cb    cursor_cb;
-	uint64_t              flags = slant ? BOF_SLANT : BOF_EQUAL;
-	int                   rc;
+	struct slot  s = { .s_node = leaf };
+	m0_bcount_t  ksize;
+	void        *p_key;
+	int          count = bnode_key_count(leaf);
 
-	cursor_cb.c_act   = btree_cursor_kv_get_cb;
-	cursor_cb.c_datum = it;
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-				      m0_btree_get(it->bc_arbor, key,
-						   &cursor_cb, flags, &kv_op));
-	return rc;
+	if (count == 0)
+		return false;
+	s.s_rec.r_key.k_data = M0_BUFVEC_INIT_BUF(&p_key, &ksize);
+	s.s_idx = 0;
+	bnode_key(&s);
+	if (btree_key_cmp(tree, &s.s_rec.r_key, key) > 0)
+		return false;
+	s.s_idx = count - 1;
+	bnode_key(&s);
+	return btree_key_cmp(tree, key, &s.s_rec.r_key) <= 0;
 }
 
-static int btree_cursor_iter(struct m0_btree_cursor *it,
-			     enum m0_btree_op_flags  dir)
+M0_INTERNAL int m0_btree_mget(struct m0_btree *arbor,
+			      const struct m0_btree_key *keys, uint32_t nr,
+			      const struct m0_btree_cb *cb, uint32_t *nr_done)
 {
-	struct m0_btree_op    kv_op = {};
-	struct m0_btree_cb    cursor_cb;
-	struct m0_btree_key   key;
-	int                   rc;
-
-	M0_ASSERT(M0_IN(dir, (BOF_NEXT, BOF_PREV)));
+	struct td          *tree   = arbor->t_desc;
+	struct node_op      nop    = {};
+	struct nd          *path[MAX_TREE_HEIGHT] = {};
+	int                 height = 0;
+	struct m0_btree_cb  ucb    = *cb;
+	uint32_t            done   = 0;
+	uint32_t            i;
+	int                 rc     = 0;
 
-	cursor_cb.c_act   = btree_cursor_kv_get_cb;
-	cursor_cb.c_datum = it;
+	M0_PRE(cb != NULL && cb->c_act != NULL);
+	M0_PRE(btree_keys_are_sorted(tree, keys, nr, sizeof keys[0]));
 
-	key.k_data = M0_BUFVEC_INIT_BUF(&it->bc_key.b_addr, &it->bc_key.b_nob);
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-				      m0_btree_iter(it->bc_arbor,
-						    &key,
-						    &cursor_cb, dir, &kv_op));
-	return rc;
-}
+	/**
+	 * The tree lock excludes writers (see lock_op_read_init()), so the
+	 * nodes on the path stay valid for the whole batch and the leaf can be
+	 * reused by consecutive keys.
+	 */
+	m0_rwlock_read_lock(&tree->t_lock);
+	for (i = 0; i < nr && rc == 0; i++) {
+		const struct m0_btree_key *key  = &keys[i];
+		struct nd                 *leaf = height > 0 ?
+						  path[height - 1] : NULL;
+		struct slot                s    = {};
+		m0_bcount_t                ksize;
+		m0_bcount_t                vsize;
+		void                      *p_key;
+		void                      *p_val;
+		bool                       found;
+
+		if (leaf == NULL || !btree_mget_leaf_covers(tree, leaf, key)) {
+			struct segaddr addr = tree->t_root->n_addr;
+
+			btree_mget_path_put(&nop, path, 0, height);
+			height = 0;
+			while (true) {
+				nop.no_op.o_sm.sm_rc = 0;
+				bnode_get(&nop, tree, &addr, P_NEXTDOWN);
+				if (nop.no_op.o_sm.sm_rc != 0) {
+					rc = nop.no_op.o_sm.sm_rc;
+					break;
+				}
+				M0_ASSERT(height < MAX_TREE_HEIGHT);
+				path[height++] = nop.no_node;
+				s.s_node = nop.no_node;
+				if (bnode_level(s.s_node) == 0)
+					break;
+				if (bnode_find(&s, (struct m0_btree_key *)key))
+					s.s_idx++;
+				bnode_child(&s, &addr);
+				if (!address_in_segment(addr)) {
+					rc = M0_ERR(-EFAULT);
+					break;
+				}
+			}
+			if (rc != 0)
+				break;
+			leaf = path[height - 1];
+		}
 
-M0_INTERNAL int m0_btree_cursor_next(struct m0_btree_cursor *it)
-{
-	return btree_cursor_iter(it, BOF_NEXT);
-}
+		s.s_node = leaf;
+		REC_INIT(&s.s_rec, &p_key, &ksize, &p_val, &vsize);
+		bnode_read_lock(leaf);
+		found = bnode_find(&s, (struct m0_btree_key *)key);
+		if (found) {
+			bnode_rec(&s);
+			s.s_rec.r_flags = M0_BSC_SUCCESS;
+		} else {
+			s.s_rec.r_key        = *key;
+			s.s_rec.r_val.ov_vec.v_nr = 0;
+			s.s_rec.r_flags      = M0_BSC_KEY_NOT_FOUND;
+		}
+		bnode_read_unlock(leaf);
+		rc = ucb.c_act(&ucb, &s.s_rec);
+		if (rc == 0)
+			done++;
+	}
+	btree_mget_path_put(&nop, path, 0, height);
+	m0_rwlock_read_unlock(&tree->t_lock);
 
-M0_INTERNAL int m0_btree_cursor_prev(struct m0_btree_cursor *it)
-{
-	return btree_cursor_iter(it, BOF_PREV);
+	if (nr_done != NULL)
+		*nr_done = done;
+	return M0_RC(rc);
 }
 
-M0_INTERNAL int m0_btree_cursor_first(struct m0_btree_cursor *it)
+/**
+ * Default put callback of m0_btree_mput(): copies the caller record into the
+ * tree.
+ */
+static int btree_mput_copy_cb(struct m0_btree_cb *cb, struct m0_btree_rec *rec)
 {
-	struct m0_btree_op    kv_op = {};
-	struct m0_btree_cb    cursor_cb;
-	int                   rc;
+	struct m0_btree_rec *src = cb->c_datum;
 
-	cursor_cb.c_act   = btree_cursor_kv_get_cb;
-	cursor_cb.c_datum = it;
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-				      m0_btree_minkey(it->bc_arbor, &cursor_cb,
-						      0, &kv_op));
-	return rc;
+	if (rec->r_flags != M0_BSC_SUCCESS)
+		return M0_ERR(-rec->r_flags);
+	COPY_RECORD(rec, src);
+	return 0;
 }
 
-M0_INTERNAL int m0_btree_cursor_last(struct m0_btree_cursor *it)
+M0_INTERNAL int m0_btree_mput(struct m0_btree *arbor,
+			      const struct m0_btree_rec *recs, uint32_t nr,
+			      const struct m0_btree_cb *cb, struct m0_be_tx *tx,
+			      uint32_t *nr_done)
 {
-	struct m0_btree_op    kv_op = {};
-	struct m0_btree_cb    cursor_cb;
-	int                   rc;
+	struct m0_btree_op kv_op = {};
+	struct m0_btree_cb copy_cb = { .c_act = btree_mput_copy_cb };
+	uint32_t           i;
+	int                rc = 0;
 
-	cursor_cb.c_act   = btree_cursor_kv_get_cb;
-	cursor_cb.c_datum = it;
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-				      m0_btree_maxkey(it->bc_arbor, &cursor_cb,
-						      0, &kv_op));
-	return rc;
-}
+	M0_PRE(btree_keys_are_sorted(arbor->t_desc, &recs[0].r_key, nr,
+				     sizeof recs[0]));
 
-M0_INTERNAL void m0_btree_cursor_put(struct m0_btree_cursor *it)
-{
-	/** Do nothing. */
+	for (i = 0; i < nr && rc == 0; i++) {
+		copy_cb.c_datum = (void *)&recs[i];
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_put(arbor, &recs[i],
+							   cb ?: &copy_cb,
+							   &kv_op, tx));
+	}
+	if (nr_done != NULL)
+		*nr_done = rc == 0 ? nr : i - 1;
+	return M0_RC(rc);
 }
 
-M0_INTERNAL void m0_btree_cursor_kv_get(struct m0_btree_cursor *it,
-					struct m0_buf *key, struct m0_buf *val)
+/** Initialises bop for the BOF_APPEND insertion of rec. */
+static void btree_append(struct m0_btree *arbor, const struct m0_btree_rec *rec,
+			 const struct m0_btree_cb *cb, uint32_t fill,
+			 struct m0_btree_op *bop, struct m0_be_tx *tx)
 {
-	if (key)
-		*key = M0_BUF_INIT(it->bc_key.b_nob, it->bc_key.b_addr);
-	if (val)
-		*val = M0_BUF_INIT(it->bc_val.b_nob, it->bc_val.b_addr);
+	m0_btree_put(arbor, rec, cb, bop, tx);
+	bop->bo_flags |= BOF_APPEND;
+	bop->bo_fill   = fill;
 }
 
-M0_INTERNAL bool m0_btree_is_empty(struct m0_btree *btree)
+M0_INTERNAL int m0_btree_bulk_load(struct m0_btree *arbor,
+				   const struct m0_btree_rec *recs, uint32_t nr,
+				   uint32_t fill, struct m0_be_tx *tx,
+				   uint32_t *nr_done)
 {
-	M0_PRE(btree != NULL);
-	M0_PRE(btree->t_desc->t_root != NULL);
-	return (bnode_rec_count(btree->t_desc->t_root) == 0);
+	struct m0_btree_op kv_op = {};
+	struct m0_btree_cb copy_cb = { .c_act = btree_mput_copy_cb };
+	uint32_t           i;
+	int                rc = 0;
+
+	M0_PRE(fill > 0 && fill <= 100);
+	M0_PRE(btree_keys_are_sorted(arbor->t_desc, &recs[0].r_key, nr,
+				     sizeof recs[0]));
+
+	for (i = 0; i < nr && rc == 0; i++) {
+		copy_cb.c_datum = (void *)&recs[i];
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      btree_append(arbor, &recs[i],
+							   &copy_cb, fill,
+							   &kv_op, tx));
+	}
+	if (nr_done != NULL)
+		*nr_done = rc == 0 ? nr : i - 1;
+	return M0_RC(rc);
 }
 
-#ifndef __KERNEL__
 /**
- *  --------------------------
- *  Section START - Unit Tests
- *  --------------------------
+ * Finds the records of the node with keys in [from, to). For a leaf these are
+ * records [*lo, *hi), for an internal node children [*lo, *hi] contain keys of
+ * the range.
  */
+static void bnode_range_find(struct nd *node, const struct m0_btree_key *from,
+			     const struct m0_btree_key *to, int *lo, int *hi)
+{
+	struct slot s = { .s_node = node };
+
+	*lo = 0;
+	*hi = bnode_key_count(node);
+	if (from != NULL) {
+		if (bnode_find(&s, (struct m0_btree_key *)from) &&
+		    bnode_level(node) > 0)
+			s.s_idx++;
+		*lo = s.s_idx;
+	}
+	if (to != NULL) {
+		bnode_find(&s, (struct m0_btree_key *)to);
+		*hi = s.s_idx;
+	}
+}
 
 /**
- * The code contained below is 'ut'. This is a little experiment to contain the
- * ut code in the same file containing the functionality code. We are open to
- * changes iff enough reasons are found that this model either does not work or
- * is not intuitive or maintainable.
+ * Adds to *count the number of records of the subtree rooted at addr with keys
+ * in [from, to). NULL from (to) means that all keys of the subtree are known to
+ * be not less than from (less than to).
+ *
+ * Subtrees entirely within the range contribute the record counts kept in
+ * their roots when the tree is counted, otherwise their leaves are visited.
  */
+static int btree_count_range_node(struct td *tree, struct segaddr *addr,
+				  const struct m0_btree_key *from,
+				  const struct m0_btree_key *to,
+				  uint64_t *count)
+{
+	struct node_op  nop = {};
+	struct nd      *node;
+	struct slot     s   = {};
+	struct segaddr  child;
+	bool            counted;
+	int             lo;
+	int             hi;
+	int             i;
+	int             rc  = 0;
+
+	bnode_get(&nop, tree, addr, P_NEXTDOWN);
+	if (nop.no_op.o_sm.sm_rc != 0)
+		return nop.no_op.o_sm.sm_rc;
+	node     = nop.no_node;
+	s.s_node = node;
+	counted  = btree_is_counted(tree);
+
+	bnode_read_lock(node);
+	if (from == NULL && to == NULL && counted) {
+		*count += segaddr_subtree_nr(&node->n_addr);
+		bnode_read_unlock(node);
+		bnode_put(&nop, node);
+		return 0;
+	}
+	bnode_range_find(node, from, to, &lo, &hi);
+	if (bnode_level(node) == 0) {
+		/** Records [lo, hi) of a leaf are in the range. */
+		*count += max32(hi - lo, 0);
+		bnode_read_unlock(node);
+		bnode_put(&nop, node);
+		return 0;
+	}
+	bnode_read_unlock(node);
 
-static struct m0_be_ut_backend *ut_be;
-static struct m0_be_ut_seg     *ut_seg;
-static struct m0_be_seg        *seg;
-static bool                     btree_ut_initialised = false;
+	/**
+	 * Children [lo, hi] of an internal node contain keys of the range, all
+	 * the children but the first and the last one are entirely within it.
+	 */
+	for (i = lo; i <= hi && rc == 0; i++) {
+		bnode_read_lock(node);
+		s.s_idx = i;
+		bnode_child(&s, &child);
+		bnode_read_unlock(node);
+		if (!address_in_segment(child)) {
+			rc = M0_ERR(-EFAULT);
+			break;
+		}
+		if (counted && i != lo && i != hi) {
+			*count += segaddr_subtree_nr(&child);
+			continue;
+		}
+		rc = btree_count_range_node(tree, &child,
+					    i == lo ? from : NULL,
+					    i == hi ? to : NULL, count);
+	}
+	bnode_put(&nop, node);
+	return rc;
+}
 
-static void btree_ut_init(void)
+M0_INTERNAL int m0_btree_count_range(struct m0_btree *arbor,
+				     const struct m0_btree_key *from,
+				     const struct m0_btree_key *to,
+				     uint64_t *count)
 {
-	if (!btree_ut_initialised) {
-		btree_ut_initialised = true;
-	}
+	struct td      *tree = arbor->t_desc;
+	struct segaddr  addr;
+	int             rc;
+
+	*count = 0;
+	/** The tree lock excludes writers, see lock_op_read_init(). */
+	m0_rwlock_read_lock(&tree->t_lock);
+	addr = tree->t_root->n_addr;
+	rc = btree_count_range_node(tree, &addr, from, to, count);
+	m0_rwlock_read_unlock(&tree->t_lock);
+	return M0_RC(rc);
 }
 
-static void btree_ut_fini(void)
+/** State of m0_btree_del_range(). */
+struct btree_range_data {
+	struct td       *brd_tree;
+	struct m0_be_tx *brd_tx;
+	/** Number of records which may still be deleted. */
+	uint32_t         brd_budget;
+	bool             brd_counted;
+};
+
+/**
+ * Frees the node, which is no longer referenced by its parent, in the same way
+ * as btree_truncate_tick() does. Only the node header is captured.
+ */
+static void btree_range_node_free(struct btree_range_data *d,
+				  struct node_op *nop, struct nd *node)
 {
-	btree_ut_initialised = false;
+	struct slot s = { .s_node = node, .s_idx = 0 };
+
+	bnode_lock(node);
+	bnode_set_rec_count(node, 0);
+	bnode_fini(node);
+	bnode_unlock(node);
+	bnode_capture(&s, d->brd_tx);
+	nop->no_opc = NOP_FREE;
+	bnode_free(nop, node, d->brd_tx, 0);
 }
 
 /**
- * In this unit test we exercise a few tree operations in invalid conditions
- * only.
+ * Frees all the nodes of the subtree rooted at addr without looking at its
+ * keys and adds the number of its records to *nr.
+ *
+ * Children are freed from the last one and removed from their parent one by
+ * one, so that on a failure the subtree stays consistent.
  */
-static void ut_basic_tree_oper_icp(void)
+static int btree_subtree_free(struct btree_range_data *d, struct segaddr *addr,
+			      uint64_t *nr)
 {
-	void                   *invalid_addr = (void *)0xbadbadbadbad;
-	struct m0_btree         btree;
-	struct m0_btree_type    btree_type = {  .tt_id = M0_BT_UT_KV_OPS,
-						.ksize = 8,
-						.vsize = 8, };
-	struct m0_be_tx         tx_data    = {};
-	struct m0_be_tx        *tx         = &tx_data;
-	struct m0_btree_op      b_op       = {};
-	struct m0_be_tx_credit  cred       = {};
-	void                   *temp_node;
-	int                     rc;
-	struct m0_fid           fid        = M0_FID_TINIT('b', 0, 1);
-	uint32_t                rnode_sz   = m0_pagesize_get();
-	uint32_t                rnode_sz_shift;
-	struct m0_buf           buf;
+	struct node_op  nop = {};
+	struct nd      *node;
+	struct slot     s   = {};
+	struct segaddr  child;
+	int             rc  = 0;
+
+	bnode_get(&nop, d->brd_tree, addr, P_NEXTDOWN);
+	if (nop.no_op.o_sm.sm_rc != 0)
+		return nop.no_op.o_sm.sm_rc;
+	node     = nop.no_node;
+	s.s_node = node;
+
+	if (bnode_level(node) == 0)
+		*nr += bnode_rec_count(node);
+	while (bnode_level(node) > 0 && bnode_rec_count(node) > 0) {
+		s.s_idx = bnode_rec_count(node) - 1;
+		bnode_child(&s, &child);
+		rc = address_in_segment(child) ?
+		     btree_subtree_free(d, &child, nr) : M0_ERR(-EFAULT);
+		if (rc != 0)
+			break;
+		bnode_lock(node);
+		bnode_del(node, s.s_idx);
+		bnode_done(&s, false);
+		bnode_unlock(node);
+	}
+	if (rc == 0) {
+		btree_range_node_free(d, &nop, node);
+		return 0;
+	}
 
-	btree_ut_init();
+	bnode_lock(node);
+	if (d->brd_counted)
+		bnode_subtree_nr_recount(node);
+	bnode_seq_cnt_update(node);
+	bnode_fix(node);
+	bnode_unlock(node);
+	s.s_idx = bnode_rec_count(node);
+	bnode_capture(&s, d->brd_tx);
+	bnode_put(&nop, node);
+	return rc;
+}
 
-	M0_ASSERT(rnode_sz != 0 && m0_is_po2(rnode_sz));
-	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
-	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
-			       rnode_sz_shift, &cred);
-	m0_btree_create_credit(&btree_type, &cred, 1);
+/**
+ * Deletes records with keys in [from, to) from the subtree rooted at node,
+ * stopping when the budget is exhausted, and adds the number of deleted
+ * records to *nr. NULL from (to) means that the range is not bounded from that
+ * side within the subtree.
+ *
+ * Only the nodes on the boundaries of the range are edited record by record.
+ * Leaves entirely within the range are unlinked as a whole, in counted trees
+ * whole subtrees are freed with btree_subtree_free() if the budget allows.
+ * Children left empty are freed and removed from the node.
+ */
+static int btree_del_range_node(struct btree_range_data *d, struct nd *node,
+				const struct m0_btree_key *from,
+				const struct m0_btree_key *to, uint64_t *nr)
+{
+	struct node_op  nop     = {};
+	struct slot     s       = { .s_node = node };
+	struct segaddr  child;
+	struct nd      *cnode;
+	uint64_t        deleted = 0;
+	uint64_t        cnr;
+	bool            removed;
+	bool            first   = true;
+	int             mod     = -1;
+	int             lo;
+	int             hi;
+	int             rc      = 0;
+
+	bnode_range_find(node, from, to, &lo, &hi);
+	if (bnode_level(node) == 0 && node != d->brd_tree->t_root &&
+	    lo == 0 && hi == bnode_rec_count(node) && hi <= d->brd_budget) {
+		/**
+		 * The whole leaf is in the range: drop its records at once,
+		 * the caller unlinks and frees the leaf.
+		 */
+		bnode_lock(node);
+		bnode_set_rec_count(node, 0);
+		bnode_unlock(node);
+		d->brd_budget -= hi;
+		*nr += hi;
+		return 0;
+	}
+	if (bnode_level(node) == 0) {
+		bnode_lock(node);
+		for (s.s_idx = lo; s.s_idx < hi && d->brd_budget > 0; hi--) {
+			bnode_del(node, s.s_idx);
+			bnode_done(&s, false);
+			d->brd_budget--;
+			deleted++;
+		}
+		bnode_unlock(node);
+		if (deleted > 0)
+			mod = lo;
+	}
 
-	/** Prepare transaction to capture tree operations. */
-	m0_be_ut_tx_init(tx, ut_be);
-	m0_be_tx_prep(tx, &cred);
-	rc = m0_be_tx_open_sync(tx);
-	M0_ASSERT(rc == 0);
+	for (s.s_idx = lo; bnode_level(node) > 0 && s.s_idx <= hi &&
+	     d->brd_budget > 0; first = false) {
+		bnode_child(&s, &child);
+		if (!address_in_segment(child)) {
+			rc = M0_ERR(-EFAULT);
+			break;
+		}
+		cnr = 0;
+		/**
+		 * A subtree entirely within the range is freed without
+		 * visiting its keys if the budget covers its records.
+		 */
+		if (d->brd_counted && (!first || from == NULL) &&
+		    (s.s_idx != hi || to == NULL))
+			cnr = segaddr_subtree_nr(&child);
+		if (cnr > 0 && cnr <= d->brd_budget) {
+			cnr = 0;
+			rc = btree_subtree_free(d, &child, &cnr);
+			d->brd_budget -= min64u(cnr, d->brd_budget);
+			deleted += cnr;
+			removed = rc == 0;
+		} else {
+			bnode_get(&nop, d->brd_tree, &child, P_NEXTDOWN);
+			rc = nop.no_op.o_sm.sm_rc;
+			if (rc != 0)
+				break;
+			cnode = nop.no_node;
+			cnr   = 0;
+			rc = btree_del_range_node(d, cnode,
+						  first ? from : NULL,
+						  s.s_idx == hi ? to : NULL,
+						  &cnr);
+			deleted += cnr;
+			removed = rc == 0 && bnode_rec_count(cnode) == 0;
+			if (removed)
+				btree_range_node_free(d, &nop, cnode);
+			else
+				bnode_put(&nop, cnode);
+		}
+		if (rc != 0)
+			break;
+		if (removed) {
+			/**
+			 * Keys of the next child are not less than the key of
+			 * the removed record, hence the key of the previous
+			 * record still separates them.
+			 */
+			bnode_lock(node);
+			bnode_del(node, s.s_idx);
+			bnode_done(&s, false);
+			bnode_unlock(node);
+			if (mod == -1)
+				mod = s.s_idx;
+			hi--;
+		} else
+			s.s_idx++;
+	}
 
-	/**
-	 *  Run a invalid scenario which:
-	 *  1) Attempts to create a btree with invalid address
-	 *
-	 * This scenario is invalid because the root node address is incorrect.
-	 * In this case m0_btree_create() will return -EFAULT.
-	 */
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(invalid_addr,
-				      rnode_sz, &btree_type, M0_BCT_NO_CRC,
-				      &b_op, &btree, seg, &fid, tx, NULL));
-	M0_ASSERT(rc == -EFAULT);
-	m0_be_tx_close_sync(tx);
-	m0_be_tx_fini(tx);
+	if (deleted > 0 || mod != -1) {
+		bnode_lock(node);
+		if (d->brd_counted)
+			bnode_subtree_nr_set(node,
+				     segaddr_subtree_nr(&node->n_addr) -
+				     deleted);
+		bnode_seq_cnt_update(node);
+		bnode_fix(node);
+		bnode_unlock(node);
+		s.s_idx = mod != -1 ? mod : bnode_rec_count(node);
+		bnode_capture(&s, d->brd_tx);
+	}
+	*nr += deleted;
+	return rc;
+}
 
-	/**
-	 *  Run a invalid scenario which:
-	 *  1) Attempts to open a btree with invalid address
-	 *
-	 * This scenario is invalid because the root node address is incorrect.
-	 * In this case m0_btree_open() will return -EFAULT.
-	 */
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_open(invalid_addr,
-							   rnode_sz, &btree,
-							   seg, &b_op, NULL));
-	M0_ASSERT(rc == -EFAULT);
+/**
+ * Lowers the tree after m0_btree_del_range(): the root without children
+ * becomes an empty leaf, the root with a single child takes over the records
+ * of the child, as btree_del_resolve_underflow() does.
+ */
+static void btree_del_range_root_fix(struct btree_range_data *d,
+				     struct m0_btree *arbor)
+{
+	struct td      *tree = d->brd_tree;
+	struct nd      *root = tree->t_root;
+	struct node_op  nop  = {};
+	struct slot     s    = { .s_node = root, .s_idx = 0 };
+	struct segaddr  child;
+	struct nd      *cnode;
+	int             level;
+
+	if (bnode_level(root) > 0 && bnode_rec_count(root) == 0) {
+		bnode_lock(root);
+		bnode_set_level(root, 0);
+		if (d->brd_counted)
+			bnode_subtree_nr_set(root, 0);
+		bnode_fix(root);
+		bnode_unlock(root);
+		bnode_capture(&s, d->brd_tx);
+		tree->t_height  = 1;
+		arbor->t_height = tree->t_height;
+	}
+	while (bnode_level(root) > 0 && bnode_rec_count(root) == 1) {
+		bnode_child(&s, &child);
+		bnode_get(&nop, tree, &child, P_NEXTDOWN);
+		if (nop.no_op.o_sm.sm_rc != 0)
+			break;
+		cnode = nop.no_node;
+		level = bnode_level(root);
+
+		bnode_lock(root);
+		bnode_lock(cnode);
+		bnode_del(root, 0);
+		bnode_done(&s, false);
+		bnode_set_level(root, level - 1);
+		bnode_move(cnode, root, D_RIGHT, NR_MAX);
+		M0_ASSERT(bnode_rec_count(cnode) == 0);
+		bnode_seq_cnt_update(root);
+		bnode_fix(root);
+		bnode_unlock(cnode);
+		bnode_unlock(root);
+		bnode_capture(&s, d->brd_tx);
+		btree_range_node_free(d, &nop, cnode);
+
+		tree->t_height--;
+		arbor->t_height = tree->t_height;
+	}
+}
 
-	/**
-	 *  Run a invalid scenario which:
-	 *  1) Creates a btree
-	 *  2) Opens the btree
-	 *  3) Destroys the btree
-	 *
-	 * This scenario is invalid because we are trying to destroy a tree that
-	 * has not been closed. Thus, we should get -EPERM error from
-	 * m0_btree_destroy().
-	 */
+M0_INTERNAL int m0_btree_del_range(struct m0_btree *arbor,
+				   const struct m0_btree_key *from,
+				   const struct m0_btree_key *to,
+				   uint32_t limit, struct m0_be_tx *tx,
+				   uint32_t *nr_done)
+{
+	struct td               *tree = arbor->t_desc;
+	struct btree_range_data  data = {
+		.brd_tree   = tree,
+		.brd_tx     = tx,
+		.brd_budget = limit,
+	};
+	uint64_t                 done = 0;
+	int                      rc;
 
-	m0_be_ut_tx_init(tx, ut_be);
-	m0_be_tx_prep(tx, &cred);
-	rc = m0_be_tx_open_sync(tx);
-	M0_ASSERT(rc == 0);
-	/** Create temp node space*/
-	buf = M0_BUF_INIT(rnode_sz, NULL);
-	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
-	temp_node = buf.b_addr;
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(temp_node,
-				      rnode_sz, &btree_type, M0_BCT_NO_CRC,
-				      &b_op, &btree, seg, &fid, tx, NULL));
-	M0_ASSERT(rc == 0);
-	m0_be_tx_close_sync(tx);
-	m0_be_tx_fini(tx);
+	M0_PRE(limit > 0);
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_open(temp_node, rnode_sz,
-							   &btree, seg, &b_op,
-							   NULL));
-	M0_ASSERT(rc == 0);
+	/** Nodes are only modified under the tree lock, see lock_op_init(). */
+	m0_rwlock_write_lock(&tree->t_lock);
+	data.brd_counted = btree_is_counted(tree);
+	rc = btree_del_range_node(&data, tree->t_root, from, to, &done);
+	btree_del_range_root_fix(&data, arbor);
+	lock_op_unlock(tree);
 
-	cred = M0_BE_TX_CREDIT(0, 0);
-	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
-			       rnode_sz_shift, &cred);
-	m0_btree_destroy_credit(b_op.bo_arbor, NULL, &cred, 1);
+	M0_ASSERT(done <= limit);
+	if (nr_done != NULL)
+		*nr_done = done;
+	return M0_RC(rc);
+}
 
-	m0_be_ut_tx_init(tx, ut_be);
-	m0_be_tx_prep(tx, &cred);
-	rc = m0_be_tx_open_sync(tx);
-	M0_ASSERT(rc == 0);
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(b_op.bo_arbor,
-							      &b_op, tx));
-	M0_ASSERT(rc == -EPERM);
-	M0_SET0(&btree);
-	buf = M0_BUF_INIT(rnode_sz, temp_node);
-	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
-	m0_be_tx_close_sync(tx);
-	m0_be_tx_fini(tx);
+M0_INTERNAL int m0_btree_scrub_init(struct m0_btree_scrub *scrub,
+				    struct m0_btree       *arbor)
+{
+	M0_SET0(scrub);
+	scrub->bs_arbor   = arbor;
+	scrub->bs_bufsize = arbor->t_desc->t_root->n_size;
+	scrub->bs_key     = m0_alloc(scrub->bs_bufsize);
+	return scrub->bs_key == NULL ? M0_ERR(-ENOMEM) : 0;
+}
 
-	/**
-	 *  Run a invalid scenario which:
-	 *  1) Creates a btree
-	 *  2) Close the btree
-	 *  3) Again Attempt to close the btree
-	 *
-	 * This scenario is invalid because we are trying to destroy a tree that
-	 * has been already destroyed. Thus, we should get -EINVAL error from
-	 * m0_btree_destroy().
-	 */
+M0_INTERNAL void m0_btree_scrub_fini(struct m0_btree_scrub *scrub)
+{
+	m0_free(scrub->bs_key);
+	M0_SET0(scrub);
+}
 
-	/** Create temp node space*/
-	cred = M0_BE_TX_CREDIT(0, 0);
-	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
-			       rnode_sz_shift, &cred);
-	m0_btree_create_credit(&btree_type, &cred, 1);
+/**
+ * Verifies the leaves of the subtree rooted at addr with keys not less than
+ * from, decrementing *budget for every verified leaf. Returns 1 when the budget
+ * is exhausted, after saving the first key of the next leaf in scrub->bs_key.
+ */
+static int btree_scrub_node(struct m0_btree_scrub *scrub, struct td *tree,
+			    struct segaddr *addr,
+			    const struct m0_btree_key *from, uint32_t *budget)
+{
+	struct node_op  nop = {};
+	struct nd      *node;
+	struct slot     s   = {};
+	struct segaddr  child;
+	void           *p_key;
+	m0_bcount_t     ksize;
+	int             lo  = 0;
+	int             hi;
+	int             i;
+	int             rc  = 0;
+
+	bnode_get(&nop, tree, addr, P_NEXTDOWN);
+	if (nop.no_op.o_sm.sm_rc != 0)
+		return nop.no_op.o_sm.sm_rc;
+	node     = nop.no_node;
+	s.s_node = node;
+
+	bnode_read_lock(node);
+	hi = bnode_key_count(node);
+	if (from != NULL) {
+		if (bnode_find(&s, (struct m0_btree_key *)from) &&
+		    bnode_level(node) > 0)
+			s.s_idx++;
+		lo = s.s_idx;
+	}
+	if (bnode_level(node) == 0) {
+		if (lo < hi && *budget == 0) {
+			s.s_idx = lo;
+			s.s_rec.r_key.k_data = M0_BUFVEC_INIT_BUF(&p_key,
+								  &ksize);
+			bnode_key(&s);
+			M0_ASSERT(ksize <= scrub->bs_bufsize);
+			memcpy(scrub->bs_key, p_key, ksize);
+			scrub->bs_ksize = ksize;
+			rc = 1;
+		} else if (lo < hi) {
+			scrub->bs_corrupt += bnode_crc_validate(node, lo,
+								false);
+			scrub->bs_nodes++;
+			--*budget;
+		}
+		bnode_read_unlock(node);
+		bnode_put(&nop, node);
+		return rc;
+	}
+	bnode_read_unlock(node);
+
+	for (i = lo; i <= hi && rc == 0; i++) {
+		bnode_read_lock(node);
+		s.s_idx = i;
+		bnode_child(&s, &child);
+		bnode_read_unlock(node);
+		if (!address_in_segment(child)) {
+			rc = M0_ERR(-EFAULT);
+			break;
+		}
+		rc = btree_scrub_node(scrub, tree, &child,
+				      i == lo ? from : NULL, budget);
+	}
+	bnode_put(&nop, node);
+	return rc;
+}
 
-	/** Prepare transaction to capture tree operations. */
-	m0_be_ut_tx_init(tx, ut_be);
-	m0_be_tx_prep(tx, &cred);
-	rc = m0_be_tx_open_sync(tx);
-	M0_ASSERT(rc == 0);
+M0_INTERNAL int m0_btree_scrub_step(struct m0_btree_scrub *scrub, uint32_t nr)
+{
+	struct td           *tree = scrub->bs_arbor->t_desc;
+	struct segaddr       addr;
+	m0_bcount_t          ksize = scrub->bs_ksize;
+	struct m0_btree_key  from  = {
+		.k_data = M0_BUFVEC_INIT_BUF(&scrub->bs_key, &ksize),
+	};
+	int                  rc;
 
-	buf = M0_BUF_INIT(rnode_sz, NULL);
-	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
-	temp_node = buf.b_addr;
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(temp_node, rnode_sz,
-				      &btree_type, M0_BCT_NO_CRC, &b_op,
-				      &btree, seg, &fid, tx, NULL));
-	M0_ASSERT(rc == 0);
-	m0_be_tx_close_sync(tx);
-	m0_be_tx_fini(tx);
+	M0_PRE(nr > 0);
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_close(b_op.bo_arbor,
-							    &b_op));
-	M0_ASSERT(rc == 0);
-	M0_SET0(&btree);
+	if (bnode_crctype_get(tree->t_root) == M0_BCT_NO_CRC) {
+		scrub->bs_pass++;
+		return 0;
+	}
+	m0_rwlock_read_lock(&tree->t_lock);
+	addr = tree->t_root->n_addr;
+	rc = btree_scrub_node(scrub, tree, &addr,
+			      scrub->bs_ksize == 0 ? NULL : &from, &nr);
+	m0_rwlock_read_unlock(&tree->t_lock);
+	if (rc == 1)
+		return 0;
+	if (rc == 0) {
+		/** The last leaf is verified, the next walk starts over. */
+		scrub->bs_ksize = 0;
+		scrub->bs_pass++;
+	}
+	return M0_RC(rc);
+}
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_close(b_op.bo_arbor,
-							    &b_op));
-	M0_ASSERT(rc == -EINVAL);
-	M0_SET0(&btree);
+M0_INTERNAL int m0_btree_mdel(struct m0_btree *arbor,
+			      const struct m0_btree_key *keys, uint32_t nr,
+			      const struct m0_btree_cb *cb, struct m0_be_tx *tx,
+			      uint32_t *nr_done)
+{
+	struct m0_btree_op kv_op = {};
+	uint32_t           i;
+	int                rc = 0;
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_open(temp_node, rnode_sz,
-							   &btree, seg, &b_op,
-							   NULL));
-	M0_ASSERT(rc == 0);
+	M0_PRE(btree_keys_are_sorted(arbor->t_desc, keys, nr, sizeof keys[0]));
 
-	cred = M0_BE_TX_CREDIT(0, 0);
-	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
-			       rnode_sz_shift, &cred);
-	m0_btree_destroy_credit(b_op.bo_arbor, NULL, &cred, 1);
+	for (i = 0; i < nr && rc == 0; i++)
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_del(arbor, &keys[i], cb,
+							   &kv_op, tx));
+	if (nr_done != NULL)
+		*nr_done = rc == 0 ? nr : i - 1;
+	return M0_RC(rc);
+}
 
-	m0_be_ut_tx_init(tx, ut_be);
-	m0_be_tx_prep(tx, &cred);
-	rc = m0_be_tx_open_sync(tx);
-	M0_ASSERT(rc == 0);
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(b_op.bo_arbor,
-							      &b_op, tx));
-	M0_ASSERT(rc == 0);
-	M0_SET0(&btree);
-	buf = M0_BUF_INIT(rnode_sz, temp_node);
-	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
-	m0_be_tx_close_sync(tx);
-	m0_be_tx_fini(tx);
+M0_INTERNAL void m0_btree_mput_credit(const struct m0_btree    *arbor,
+				      const struct m0_btree_rec *recs,
+				      uint32_t                   nr,
+				      struct m0_be_tx_credit    *accum)
+{
+	uint32_t i;
 
-	btree_ut_fini();
+	for (i = 0; i < nr; i++)
+		m0_btree_put_credit(arbor, 1,
+				    m0_vec_count(&recs[i].r_key.k_data.ov_vec),
+				    m0_vec_count(&recs[i].r_val.ov_vec), accum);
 }
 
-struct ut_cb_data {
-	/** Key that needs to be stored or retrieved. */
-	struct m0_btree_key      *key;
+M0_INTERNAL void m0_btree_mdel_credit(const struct m0_btree     *arbor,
+				      const struct m0_btree_key *keys,
+				      uint32_t                   nr,
+				      m0_bcount_t                vsize,
+				      struct m0_be_tx_credit    *accum)
+{
+	uint32_t i;
 
-	/** Value associated with the key that is to be stored or retrieved. */
-	struct m0_bufvec         *value;
+	for (i = 0; i < nr; i++)
+		m0_btree_del_credit(arbor, 1,
+				    m0_vec_count(&keys[i].k_data.ov_vec),
+				    vsize, accum);
+}
 
-	/** If value is retrieved (GET) then check if has expected contents. */
-	bool                      check_value;
+M0_INTERNAL void m0_btree_bulk_load_credit(const struct m0_btree  *arbor,
+					   uint32_t                nr,
+					   m0_bcount_t             ksize,
+					   m0_bcount_t             vsize,
+					   uint32_t                fill,
+					   struct m0_be_tx_credit *accum)
+{
+	struct nd              *root = arbor->t_desc->t_root;
+	struct m0_be_tx_credit  cred = {};
+	uint64_t                per_node;
+	uint64_t                splits;
 
-	/** Indicates if CRC is present in the last word of the value. */
-	enum m0_btree_crc_type    crc;
+	M0_PRE(fill > 0 && fill <= 100);
+	/**
+	 * Appended records split only the right-most nodes, each split leaves
+	 * a node filled up to "fill". Record overhead is not known here, so
+	 * assume that a record takes twice its payload in the node. Internal
+	 * levels add at most as many splits as the leaf level does.
+	 */
+	per_node = max64u((uint64_t)root->n_size * fill / 100 /
+			  (2 * (ksize + vsize)), 1);
+	splits   = 2 * (nr / per_node + 1) + MAX_TREE_HEIGHT;
 
-	bool                      embedded_ksize;
+	bnode_rec_put_credit(root, ksize, vsize, &cred);
+	btree_callback_credit(&cred);
+	m0_be_tx_credit_mac(accum, &cred, nr);
 
-	bool                      embedded_vsize;
+	M0_SET0(&cred);
+	btree_node_split_credit(arbor, ksize, vsize, &cred);
+	m0_be_tx_credit_mac(accum, &cred, splits);
+}
 
-	/**
-	 *  This field is filled by the callback routine with the flags which
-	 *  the CB routine received from the _tick(). This flag can then be
-	 *  analyzed by the caller for further processing.
-	 */
-	uint32_t                  flags;
+struct cursor_cb_data {
+	struct m0_btree_rec ccd_rec;
+	m0_bcount_t         ccd_keysz;
+	m0_bcount_t         ccd_valsz;
 };
 
-/**
- * Put callback will receive record pointer from put routine which will contain
- * r_flag which will indicate SUCCESS or ERROR code.
- * If put routine is able to find the record, it will set SUCCESS code and
- * callback routine needs to put key-value to the given record and return
- * success code.
- * else put routine will set the ERROR code to indicate failure and it is
- * expected to return ERROR code by callback routine.
- */
-static int ut_btree_kv_put_cb(struct m0_btree_cb *cb, struct m0_btree_rec *rec)
+static int btree_cursor_kv_get_cb(struct m0_btree_cb  *cb,
+				  struct m0_btree_rec *rec)
 {
-	struct m0_bufvec_cursor  scur;
-	struct m0_bufvec_cursor  dcur;
-	m0_bcount_t              ksize;
-	m0_bcount_t              vsize;
-	struct ut_cb_data       *datum = cb->c_datum;
-
-	/** The caller can look at these flags if he needs to. */
-	datum->flags = rec->r_flags;
-	M0_ASSERT(datum->flags == M0_BSC_SUCCESS);
-
-	ksize = m0_vec_count(&datum->key->k_data.ov_vec);
-	M0_ASSERT(m0_vec_count(&rec->r_key.k_data.ov_vec) >= ksize);
+	struct m0_btree_cursor  *datum = cb->c_datum;
+	struct m0_bufvec_cursor  cur;
 
-	vsize = m0_vec_count(&datum->value->ov_vec);
-	M0_ASSERT(m0_vec_count(&rec->r_val.ov_vec) >= vsize);
+	/** Currently we support bufvec with only one segment. */
+	M0_ASSERT(M0_BUFVEC_SEG_COUNT(&rec->r_key.k_data) == 1 &&
+		  M0_BUFVEC_SEG_COUNT(&rec->r_val) == 1);
 
-	m0_bufvec_cursor_init(&scur, &datum->key->k_data);
-	m0_bufvec_cursor_init(&dcur, &rec->r_key.k_data);
-	rec->r_key.k_data.ov_vec.v_count[0] =
-	m0_vec_count(&datum->key->k_data.ov_vec);
-	m0_bufvec_cursor_copy(&dcur, &scur, ksize);
+	/** Save returned Key and Value in the iterator */
+	m0_bufvec_cursor_init(&cur, &rec->r_key.k_data);
+	datum->bc_key = M0_BUF_INIT(m0_bufvec_cursor_step(&cur),
+				    m0_bufvec_cursor_addr(&cur));
 
-	m0_bufvec_cursor_init(&scur, datum->value);
-	m0_bufvec_cursor_init(&dcur, &rec->r_val);
-	rec->r_val.ov_vec.v_count[0]=
-	m0_vec_count(&datum->value->ov_vec);
-	m0_bufvec_cursor_copy(&dcur, &scur, vsize);
+	m0_bufvec_cursor_init(&cur, &rec->r_val);
+	datum->bc_val = M0_BUF_INIT(m0_bufvec_cursor_step(&cur),
+				    m0_bufvec_cursor_addr(&cur));
 
 	return 0;
 }
 
-static int ut_btree_kv_get_cb(struct m0_btree_cb *cb, struct m0_btree_rec *rec)
+M0_INTERNAL void m0_btree_cursor_init(struct m0_btree_cursor *it,
+				      struct m0_btree        *arbor)
 {
-	struct m0_bufvec_cursor  scur;
-	struct m0_bufvec_cursor  dcur;
-	m0_bcount_t              ksize;
-	m0_bcount_t              vsize;
-	struct ut_cb_data       *datum = cb->c_datum;
-	int                      i      = 0;
+	M0_SET0(it);
+	it->bc_arbor    = arbor;
+	it->bc_prefetch = M0_BTREE_CURSOR_PREFETCH;
+}
 
-	/** The caller can look at these flags if he needs to. */
-	datum->flags = rec->r_flags;
+M0_INTERNAL void m0_btree_cursor_prefetch_set(struct m0_btree_cursor *it,
+					      uint32_t                nr)
+{
+	it->bc_prefetch = nr;
+}
 
-	M0_ASSERT(rec->r_flags == M0_BSC_SUCCESS);
+M0_INTERNAL void m0_btree_cursor_fini(struct m0_btree_cursor *it)
+{
+}
 
-	if (datum->embedded_ksize) {
-		/** Extract Key size present in the 2nd word.*/
-		m0_bufvec_cursor_init(&scur, &rec->r_key.k_data);
-		m0_bufvec_cursor_move(&scur, sizeof(uint64_t));
-		m0_bufvec_cursor_copyfrom(&scur, &ksize, sizeof(ksize));
-		ksize = m0_byteorder_cpu_to_be64(ksize);
-		M0_PRE(ksize <= MAX_KEY_SIZE &&
-		       m0_vec_count(&rec->r_key.k_data.ov_vec) == ksize);
-	} else {
-		ksize = m0_vec_count(&rec->r_key.k_data.ov_vec);
-		M0_PRE(m0_vec_count(&datum->key->k_data.ov_vec) >= ksize);
-	}
+M0_INTERNAL int m0_btree_cursor_get(struct m0_btree_cursor     *it,
+				    const struct m0_btree_key *key,
+				    bool                       slant)
+{
+	struct m0_btree_op    kv_op = {};
+	struct m0_btree_cb    cursor_cb;
+	uint64_t              flags = slant ? BOF_SLANT : BOF_EQUAL;
+	int                   rc;
 
-	if (datum->embedded_vsize) {
-		/** Extract Value size present in the 2nd word.*/
-		m0_bufvec_cursor_init(&scur, &rec->r_val);
-		m0_bufvec_cursor_move(&scur, sizeof(uint64_t));
-		m0_bufvec_cursor_copyfrom(&scur, &vsize, sizeof(vsize));
-		vsize = m0_byteorder_cpu_to_be64(vsize);
-		M0_PRE(vsize <= MAX_VAL_SIZE &&
-		       m0_vec_count(&rec->r_val.ov_vec) == vsize);
-	} else {
-		vsize = m0_vec_count(&rec->r_val.ov_vec);
-		M0_PRE(m0_vec_count(&datum->value->ov_vec) >= vsize);
-	}
+	cursor_cb.c_act   = btree_cursor_kv_get_cb;
+	cursor_cb.c_datum = it;
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+				      m0_btree_get(it->bc_arbor, key,
+						   &cursor_cb, flags, &kv_op));
+	return rc;
+}
 
-	/** Copy Key and Value from the btree node to the caller's data space */
-	m0_bufvec_cursor_init(&dcur, &datum->key->k_data);
-	m0_bufvec_cursor_init(&scur, &rec->r_key.k_data);
-	m0_bufvec_cursor_copy(&dcur, &scur, ksize);
+/** Initialises bop for m0_btree_iter() with leaf prefetch of the cursor. */
+static void btree_cursor_iter_init(struct m0_btree_cursor    *it,
+				   const struct m0_btree_key *key,
+				   const struct m0_btree_cb  *cb,
+				   enum m0_btree_op_flags     dir,
+				   struct m0_btree_op        *bop)
+{
+	m0_btree_iter(it->bc_arbor, key, cb, dir, bop);
+	bop->bo_prefetch = it->bc_prefetch;
+}
 
-	m0_bufvec_cursor_init(&dcur, datum->value);
-	m0_bufvec_cursor_init(&scur, &rec->r_val);
-	m0_bufvec_cursor_copy(&dcur, &scur, vsize);
+static int btree_cursor_iter(struct m0_btree_cursor *it,
+			     enum m0_btree_op_flags  dir)
+{
+	struct m0_btree_op    kv_op = {};
+	struct m0_btree_cb    cursor_cb;
+	struct m0_btree_key   key;
+	int                   rc;
 
-	if (datum->check_value) {
-		struct m0_bufvec_cursor kcur;
-		struct m0_bufvec_cursor vcur;
-		m0_bcount_t             v_off;
-		bool                    check_failed = false;
-		uint64_t                key;
-		uint64_t                value;
-		m0_bcount_t             valuelen     = vsize;
+	M0_ASSERT(M0_IN(dir, (BOF_NEXT, BOF_PREV)));
 
-		v_off = 0;
+	cursor_cb.c_act   = btree_cursor_kv_get_cb;
+	cursor_cb.c_datum = it;
 
-		/**
-		 *  Key present in the 1st word is repeated in the Value array
-		 *  except in word #2 which contains the size of the Value. Use
-		 *  this Key to make sure all the words in the Value array are
-		 *  correct.
-		 */
-		m0_bufvec_cursor_init(&kcur, &rec->r_key.k_data);
-		m0_bufvec_cursor_copyfrom(&kcur, &key, sizeof(key));
-		m0_bufvec_cursor_init(&vcur, &rec->r_val);
+	key.k_data = M0_BUFVEC_INIT_BUF(&it->bc_key.b_addr, &it->bc_key.b_nob);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+				      btree_cursor_iter_init(it, &key,
+							     &cursor_cb, dir,
+							     &kv_op));
+	return rc;
+}
 
-		if (datum->crc != M0_BCT_NO_CRC &&
-		    datum->crc != M0_BCT_BTREE_ENC_RAW_HASH)
-			valuelen -= sizeof(uint64_t);
+M0_INTERNAL int m0_btree_cursor_next(struct m0_btree_cursor *it)
+{
+	return btree_cursor_iter(it, BOF_NEXT);
+}
 
-		while (v_off < valuelen) {
-			m0_bufvec_cursor_copyfrom(&vcur, &value, sizeof(value));
-			v_off += sizeof(value);
+M0_INTERNAL int m0_btree_cursor_prev(struct m0_btree_cursor *it)
+{
+	return btree_cursor_iter(it, BOF_PREV);
+}
 
-			if (i++ == 1)
-				/** Skip the element containing value size.*/
-				continue;
+M0_INTERNAL int m0_btree_cursor_first(struct m0_btree_cursor *it)
+{
+	struct m0_btree_op    kv_op = {};
+	struct m0_btree_cb    cursor_cb;
+	int                   rc;
 
-			if (key != value)
-				check_failed = true;
-		}
+	cursor_cb.c_act   = btree_cursor_kv_get_cb;
+	cursor_cb.c_datum = it;
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+				      m0_btree_minkey(it->bc_arbor, &cursor_cb,
+						      0, &kv_op));
+	return rc;
+}
 
-		/**
-		 * If check_failed then maybe this entry was updated in which
-		 * case we use the complement of the key for comparison.
-		 */
-		if (check_failed) {
-			v_off = 0;
-			m0_bufvec_cursor_init(&vcur, &rec->r_val);
-			key = ~key;
-			i = 0;
+M0_INTERNAL int m0_btree_cursor_last(struct m0_btree_cursor *it)
+{
+	struct m0_btree_op    kv_op = {};
+	struct m0_btree_cb    cursor_cb;
+	int                   rc;
 
-			while (v_off < valuelen) {
-				m0_bufvec_cursor_copyfrom(&vcur, &value,
-							  sizeof(value));
-				v_off += sizeof(value);
+	cursor_cb.c_act   = btree_cursor_kv_get_cb;
+	cursor_cb.c_datum = it;
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+				      m0_btree_maxkey(it->bc_arbor, &cursor_cb,
+						      0, &kv_op));
+	return rc;
+}
 
-				if (i++ == 1)
-					continue;
+M0_INTERNAL void m0_btree_cursor_put(struct m0_btree_cursor *it)
+{
+	/** Do nothing. */
+}
 
-				if (key != value)
-					M0_ASSERT(0);
-			}
-		}
-	}
-
-	/** Verify the CRC if present. */
-	if (datum->crc != M0_BCT_NO_CRC) {
-		uint64_t value_ary[vsize / sizeof(uint64_t)];
-		uint64_t csum_in_value;
-		uint64_t calculated_csum;
-
-		m0_bufvec_cursor_init(&scur, &rec->r_val);
-		m0_bufvec_cursor_copyfrom(&scur, value_ary, sizeof(value_ary));
-
-		if (datum->crc == M0_BCT_USER_ENC_RAW_HASH) {
-			vsize -= sizeof(uint64_t);
-			m0_bufvec_cursor_init(&scur, &rec->r_val);
-			m0_bufvec_cursor_move(&scur, vsize);
-			m0_bufvec_cursor_copyfrom(&scur, &csum_in_value,
-						  sizeof(csum_in_value));
-
-			calculated_csum = m0_hash_fnc_fnv1(value_ary, vsize);
-			M0_ASSERT(csum_in_value == calculated_csum);
-		} else if (datum->crc == M0_BCT_BTREE_ENC_RAW_HASH) {
-			void *p_crc = rec->r_val.ov_buf[0] + vsize;
-			calculated_csum = m0_hash_fnc_fnv1(value_ary, vsize);
-			M0_ASSERT(*(uint64_t*)(p_crc) == calculated_csum);
-		} else if (datum->crc == M0_BCT_USER_ENC_FORMAT_FOOTER)
-			M0_ASSERT(m0_format_footer_verify(value_ary, false) == 0);
-	}
+M0_INTERNAL void m0_btree_cursor_kv_get(struct m0_btree_cursor *it,
+					struct m0_buf *key, struct m0_buf *val)
+{
+	if (key)
+		*key = M0_BUF_INIT(it->bc_key.b_nob, it->bc_key.b_addr);
+	if (val)
+		*val = M0_BUF_INIT(it->bc_val.b_nob, it->bc_val.b_addr);
+}
 
-	return 0;
+M0_INTERNAL bool m0_btree_is_empty(struct m0_btree *btree)
+{
+	M0_PRE(btree != NULL);
+	M0_PRE(btree->t_desc->t_root != NULL);
+	return (bnode_rec_count(btree->t_desc->t_root) == 0);
 }
 
+#ifndef __KERNEL__
 /**
- * Callback will be called before deleting value. If needed, caller can copy the
- * content of record.
+ *  --------------------------
+ *  Section START - Unit Tests
+ *  --------------------------
  */
-static int ut_btree_kv_del_cb(struct m0_btree_cb *cb, struct m0_btree_rec *rec)
-{
-	m0_bcount_t              ksize;
-	struct ut_cb_data       *datum = cb->c_datum;
 
-	/** The caller can look at the record if he needs to. */
-	ksize = m0_vec_count(&datum->key->k_data.ov_vec);
-	M0_PRE(ksize <= MAX_KEY_SIZE + sizeof(uint64_t) &&
-	       m0_vec_count(&rec->r_key.k_data.ov_vec) == ksize);
-	M0_PRE(m0_vec_count(&rec->r_val.ov_vec) <=
-	       MAX_VAL_SIZE + sizeof(uint64_t));
+/**
+ * The code contained below is 'ut'. This is a little experiment to contain the
+ * ut code in the same file containing the functionality code. We are open to
+ * changes iff enough reasons are found that this model either does not work or
+ * is not intuitive or maintainable.
+ */
 
-	datum->flags = rec->r_flags;
-	M0_ASSERT(datum->flags == M0_BSC_SUCCESS);
+static struct m0_be_ut_backend *ut_be;
+static struct m0_be_ut_seg     *ut_seg;
+static struct m0_be_seg        *seg;
+static bool                     btree_ut_initialised = false;
 
-	return 0;
+static void btree_ut_init(void)
+{
+	if (!btree_ut_initialised) {
+		btree_ut_initialised = true;
+	}
 }
 
-static int ut_btree_kv_update_cb(struct m0_btree_cb *cb,
-				 struct m0_btree_rec *rec)
+static void btree_ut_fini(void)
 {
-	struct m0_bufvec_cursor  scur;
-	struct m0_bufvec_cursor  dcur;
-	m0_bcount_t              vsize;
-	struct ut_cb_data       *datum = cb->c_datum;
-
-	/** The caller can look at these flags if he needs to. */
-	datum->flags = rec->r_flags;
-	M0_ASSERT(datum->flags == M0_BSC_SUCCESS);
-
-	vsize = m0_vec_count(&datum->value->ov_vec);
-	M0_ASSERT(m0_vec_count(&rec->r_val.ov_vec) == vsize);
-
-	m0_bufvec_cursor_init(&scur, datum->value);
-	m0_bufvec_cursor_init(&dcur, &rec->r_val);
-	rec->r_val.ov_vec.v_count[0]=
-	m0_vec_count(&datum->value->ov_vec);
-	m0_bufvec_cursor_copy(&dcur, &scur, vsize);
-
-	return 0;
+	btree_ut_initialised = false;
 }
 
-#if (AVOID_BE_SEGMENT == 1)
-enum {
-	MIN_STREAM_CNT         = 5,
-	MAX_STREAM_CNT         = 20,
-
-	MIN_RECS_PER_STREAM    = 5,
-	MAX_RECS_PER_STREAM    = 2048,
-
-	MAX_RECS_PER_THREAD    = 10000, /** Records count for each thread */
-
-	MIN_TREE_LOOPS         = 1000,
-	MAX_TREE_LOOPS         = 2000,
-	MAX_RECS_FOR_TREE_TEST = 100,
-
-	RANDOM_TREE_COUNT      = -1,
-	RANDOM_THREAD_COUNT    = -1,
-
-	/** Key/Value array size used in UTs. Increment for CRC in Value. */
-	KEY_ARR_ELE_COUNT      = MAX_KEY_SIZE / sizeof(uint64_t),
-	VAL_ARR_ELE_COUNT      = MAX_VAL_SIZE / sizeof(uint64_t),
-	RANDOM_KEY_SIZE        = -1,
-	RANDOM_VALUE_SIZE      = -1,
-
-	BE_UT_SEG_SIZE         = 0,
-	MAX_TEST_RETRIES       = 20,
-};
-#else
-enum {
-	MIN_STREAM_CNT         = 5,
-	MAX_STREAM_CNT         = 10,
-
-	MIN_RECS_PER_STREAM    = 5,
-	MAX_RECS_PER_STREAM    = 200,
-
-	MAX_RECS_PER_THREAD    = 1000, /** Records count for each thread */
-
-	MIN_TREE_LOOPS         = 50,
-	MAX_TREE_LOOPS         = 100,
-	MAX_RECS_FOR_TREE_TEST = 50,
-
-	RANDOM_TREE_COUNT      = -1,
-	RANDOM_THREAD_COUNT    = -1,
-
-	/** Key/Value array size used in UTs. Increment for CRC in Value. */
-	KEY_ARR_ELE_COUNT      = MAX_KEY_SIZE / sizeof(uint64_t),
-	VAL_ARR_ELE_COUNT      = MAX_VAL_SIZE / sizeof(uint64_t),
-	RANDOM_KEY_SIZE        = -1,
-	RANDOM_VALUE_SIZE      = -1,
-
-	BE_UT_SEG_SIZE         = 10ULL * 1024ULL * 1024ULL * 1024ULL,
-	MAX_TEST_RETRIES       = 20,
-};
-#endif
-
 /**
- * This unit test exercises the KV operations triggered by multiple streams.
+ * In this unit test we exercise a few tree operations in invalid conditions
+ * only.
  */
-static void ut_multi_stream_kv_oper(void)
+static void ut_basic_tree_oper_icp(void)
 {
-	void                   *rnode;
-	int                     i;
-	time_t                  curr_time;
-	struct m0_btree_cb      ut_cb;
-	struct m0_be_tx         tx_data         = {};
-	struct m0_be_tx        *tx              = &tx_data;
-	struct m0_be_tx_credit  cred            = {};
-	struct m0_btree_op      b_op            = {};
-	uint32_t                stream_count    = 0;
-	uint64_t                recs_per_stream = 0;
-	struct m0_btree_op      kv_op           = {};
-	struct m0_btree        *tree;
-	struct m0_btree         btree = {};
-	struct m0_btree_type    btree_type      = {.tt_id = M0_BT_UT_KV_OPS,
-						  .ksize = sizeof(uint64_t),
-						  .vsize = btree_type.ksize*2,
-						  };
-	uint64_t                key;
-	uint64_t                value[btree_type.vsize / sizeof(uint64_t)];
-	m0_bcount_t             ksize           = sizeof key;
-	m0_bcount_t             vsize           = sizeof value;
-	void                   *k_ptr           = &key;
-	void                   *v_ptr           = &value;
+	void                   *invalid_addr = (void *)0xbadbadbadbad;
+	struct m0_btree         btree;
+	struct m0_btree_type    btree_type = {  .tt_id = M0_BT_UT_KV_OPS,
+						.ksize = 8,
+						.vsize = 8, };
+	struct m0_be_tx         tx_data    = {};
+	struct m0_be_tx        *tx         = &tx_data;
+	struct m0_btree_op      b_op       = {};
+	struct m0_be_tx_credit  cred       = {};
+	void                   *temp_node;
 	int                     rc;
-	struct m0_buf           buf;
-	uint64_t                maxkey          = 0;
-	uint64_t                minkey          = UINT64_MAX;
-	uint32_t                rnode_sz        = m0_pagesize_get();
+	struct m0_fid           fid        = M0_FID_TINIT('b', 0, 1);
+	uint32_t                rnode_sz   = m0_pagesize_get();
 	uint32_t                rnode_sz_shift;
-	struct m0_fid           fid             = M0_FID_TINIT('b', 0, 1);
-
-	M0_ENTRY();
-
-	time(&curr_time);
-	M0_LOG(M0_INFO, "Using seed %lu", curr_time);
-	srandom(curr_time);
-
-	stream_count = (random() % (MAX_STREAM_CNT - MIN_STREAM_CNT)) +
-			MIN_STREAM_CNT;
-
-	recs_per_stream = (random()%
-			   (MAX_RECS_PER_STREAM - MIN_RECS_PER_STREAM)) +
-			    MIN_RECS_PER_STREAM;
+	struct m0_buf           buf;
 
 	btree_ut_init();
-	/**
-	 *  Run valid scenario:
-	 *  1) Create a btree
-	 *  2) Adds records in multiple streams to the created tree.
-	 *  3) Confirms the records are present in the tree.
-	 *  4) Deletes all the records from the tree using multiple streams.
-	 *  5) Close the btree
-	 *  6) Destroy the btree
-	 *
-	 *  Capture each operation in a separate transaction.
-	 */
 
 	M0_ASSERT(rnode_sz != 0 && m0_is_po2(rnode_sz));
 	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
@@ -9665,634 +10718,588 @@ static void ut_multi_stream_kv_oper(void)
 	rc = m0_be_tx_open_sync(tx);
 	M0_ASSERT(rc == 0);
 
-	/** Create temp node space and use it as root node for btree */
-	buf = M0_BUF_INIT(rnode_sz, NULL);
-	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
-	rnode = buf.b_addr;
-
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(rnode, rnode_sz,
-							     &btree_type,
-							     M0_BCT_NO_CRC,
-							     &b_op, &btree, seg,
-							     &fid, tx, NULL));
-	M0_ASSERT(rc == M0_BSC_SUCCESS);
+	/**
+	 *  Run a invalid scenario which:
+	 *  1) Attempts to create a btree with invalid address
+	 *
+	 * This scenario is invalid because the root node address is incorrect.
+	 * In this case m0_btree_create() will return -EFAULT.
+	 */
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(invalid_addr,
+				      rnode_sz, &btree_type, M0_BCT_NO_CRC,
+				      &b_op, &btree, seg, &fid, tx, NULL));
+	M0_ASSERT(rc == -EFAULT);
 	m0_be_tx_close_sync(tx);
 	m0_be_tx_fini(tx);
 
-	tree = b_op.bo_arbor;
-
-	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-	m0_btree_put_credit(tree, 1, ksize, vsize, &cred);
-	{
-		struct m0_be_tx_credit  cred2 = {};
-
-		m0_btree_put_credit2(&btree_type, rnode_sz, 1, ksize, vsize,
-				     &cred2);
-		M0_ASSERT(m0_be_tx_credit_eq(&cred,  &cred2));
-	}
+	/**
+	 *  Run a invalid scenario which:
+	 *  1) Attempts to open a btree with invalid address
+	 *
+	 * This scenario is invalid because the root node address is incorrect.
+	 * In this case m0_btree_open() will return -EFAULT.
+	 */
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_open(invalid_addr,
+							   rnode_sz, &btree,
+							   seg, &b_op, NULL));
+	M0_ASSERT(rc == -EFAULT);
 
-	for (i = 1; i <= recs_per_stream; i++) {
-		struct ut_cb_data    put_data;
-		struct m0_btree_rec  rec;
-		uint32_t             stream_num;
+	/**
+	 *  Run a invalid scenario which:
+	 *  1) Creates a btree
+	 *  2) Opens the btree
+	 *  3) Destroys the btree
+	 *
+	 * This scenario is invalid because we are trying to destroy a tree that
+	 * has not been closed. Thus, we should get -EPERM error from
+	 * m0_btree_destroy().
+	 */
 
-		rec.r_key.k_data   = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize);
-		rec.r_val          = M0_BUFVEC_INIT_BUF(&v_ptr, &vsize);
-		rec.r_crc_type     = M0_BCT_NO_CRC;
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+	/** Create temp node space*/
+	buf = M0_BUF_INIT(rnode_sz, NULL);
+	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	temp_node = buf.b_addr;
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(temp_node,
+				      rnode_sz, &btree_type, M0_BCT_NO_CRC,
+				      &b_op, &btree, seg, &fid, tx, NULL));
+	M0_ASSERT(rc == 0);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
 
-		for (stream_num = 0; stream_num < stream_count; stream_num++) {
-			int k;
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_open(temp_node, rnode_sz,
+							   &btree, seg, &b_op,
+							   NULL));
+	M0_ASSERT(rc == 0);
 
-			key = i + (stream_num * recs_per_stream);
-			if (key < minkey)
-				minkey = key;
-			if (key > maxkey)
-				maxkey = key;
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_destroy_credit(b_op.bo_arbor, NULL, &cred, 1);
 
-			key = m0_byteorder_cpu_to_be64(key);
-			for (k = 0; k < ARRAY_SIZE(value); k++) {
-				value[k] = key;
-			}
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(b_op.bo_arbor,
+							      &b_op, tx));
+	M0_ASSERT(rc == -EPERM);
+	M0_SET0(&btree);
+	buf = M0_BUF_INIT(rnode_sz, temp_node);
+	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
 
-			put_data.key       = &rec.r_key;
-			put_data.value     = &rec.r_val;
+	/**
+	 *  Run a invalid scenario which:
+	 *  1) Creates a btree
+	 *  2) Close the btree
+	 *  3) Again Attempt to close the btree
+	 *
+	 * This scenario is invalid because we are trying to destroy a tree that
+	 * has been already destroyed. Thus, we should get -EINVAL error from
+	 * m0_btree_destroy().
+	 */
 
-			ut_cb.c_act        = ut_btree_kv_put_cb;
-			ut_cb.c_datum      = &put_data;
+	/** Create temp node space*/
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_create_credit(&btree_type, &cred, 1);
 
-			m0_be_ut_tx_init(tx, ut_be);
-			m0_be_tx_prep(tx, &cred);
-			rc = m0_be_tx_open_sync(tx);
-			M0_ASSERT(rc == 0);
+	/** Prepare transaction to capture tree operations. */
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
 
-			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-						      m0_btree_put(tree, &rec,
-								   &ut_cb,
-								   &kv_op, tx));
-			M0_ASSERT(rc == 0 && put_data.flags == M0_BSC_SUCCESS);
-			m0_be_tx_close_sync(tx);
-			m0_be_tx_fini(tx);
-		}
-	}
+	buf = M0_BUF_INIT(rnode_sz, NULL);
+	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	temp_node = buf.b_addr;
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(temp_node, rnode_sz,
+				      &btree_type, M0_BCT_NO_CRC, &b_op,
+				      &btree, seg, &fid, tx, NULL));
+	M0_ASSERT(rc == 0);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
 
-	{
-		/** Min/Max key verification test. */
-		struct ut_cb_data    get_data;
-		struct m0_btree_key  get_key;
-		struct m0_bufvec     get_value;
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_close(b_op.bo_arbor,
+							    &b_op));
+	M0_ASSERT(rc == 0);
+	M0_SET0(&btree);
 
-		get_key.k_data          = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize);
-		get_value               = M0_BUFVEC_INIT_BUF(&v_ptr, &vsize);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_close(b_op.bo_arbor,
+							    &b_op));
+	M0_ASSERT(rc == -EINVAL);
+	M0_SET0(&btree);
 
-		get_data.key            = &get_key;
-		get_data.value          = &get_value;
-		get_data.check_value    = true;
-		get_data.crc            = M0_BCT_NO_CRC;
-		get_data.embedded_ksize = false;
-		get_data.embedded_vsize = false;
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_open(temp_node, rnode_sz,
+							   &btree, seg, &b_op,
+							   NULL));
+	M0_ASSERT(rc == 0);
 
-		ut_cb.c_act             = ut_btree_kv_get_cb;
-		ut_cb.c_datum           = &get_data;
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_destroy_credit(b_op.bo_arbor, NULL, &cred, 1);
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_minkey(tree, &ut_cb, 0,
-							      &kv_op));
-		M0_ASSERT(rc == M0_BSC_SUCCESS &&
-			  minkey == m0_byteorder_be64_to_cpu(key));
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(b_op.bo_arbor,
+							      &b_op, tx));
+	M0_ASSERT(rc == 0);
+	M0_SET0(&btree);
+	buf = M0_BUF_INIT(rnode_sz, temp_node);
+	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_maxkey(tree, &ut_cb, 0,
-							      &kv_op));
-		M0_ASSERT(rc == M0_BSC_SUCCESS &&
-			  maxkey == m0_byteorder_be64_to_cpu(key));
-	}
+	btree_ut_fini();
+}
 
-	for (i = 1; i <= (recs_per_stream*stream_count); i++) {
-		struct ut_cb_data    get_data;
-		struct m0_btree_key  get_key;
-		struct m0_bufvec     get_value;
-		uint64_t             find_key;
-		void                *find_key_ptr      = &find_key;
-		m0_bcount_t          find_key_size     = sizeof find_key;
-		struct m0_btree_key  find_key_in_tree;
+struct ut_cb_data {
+	/** Key that needs to be stored or retrieved. */
+	struct m0_btree_key      *key;
 
-		find_key = m0_byteorder_cpu_to_be64(i);
-		find_key_in_tree.k_data =
-			M0_BUFVEC_INIT_BUF(&find_key_ptr, &find_key_size);
+	/** Value associated with the key that is to be stored or retrieved. */
+	struct m0_bufvec         *value;
 
-		get_key.k_data = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize);
-		get_value      = M0_BUFVEC_INIT_BUF(&v_ptr, &vsize);
+	/** If value is retrieved (GET) then check if has expected contents. */
+	bool                      check_value;
 
-		get_data.key            = &get_key;
-		get_data.value          = &get_value;
-		get_data.check_value    = true;
-		get_data.crc            = M0_BCT_NO_CRC;
-		get_data.embedded_ksize = false;
-		get_data.embedded_vsize = false;
+	/** Indicates if CRC is present in the last word of the value. */
+	enum m0_btree_crc_type    crc;
 
-		ut_cb.c_act    = ut_btree_kv_get_cb;
-		ut_cb.c_datum  = &get_data;
+	bool                      embedded_ksize;
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_get(tree,
-							   &find_key_in_tree,
-							   &ut_cb, BOF_EQUAL,
-							   &kv_op));
-		M0_ASSERT(rc == M0_BSC_SUCCESS &&
-			  i == m0_byteorder_be64_to_cpu(key));
-	}
+	bool                      embedded_vsize;
 
-	{
-		/** UT for Cursor verification. */
-		struct m0_btree_cursor *cursor;
-		struct m0_buf           cur_key;
-		struct m0_buf           cur_val;
-		uint64_t                find_key;
-		void                   *find_key_ptr  = &find_key;
-		m0_bcount_t             find_key_size = sizeof find_key;
-		struct m0_btree_key     find_key_in_tree;
+	/**
+	 *  This field is filled by the callback routine with the flags which
+	 *  the CB routine received from the _tick(). This flag can then be
+	 *  analyzed by the caller for further processing.
+	 */
+	uint32_t                  flags;
+};
 
-		M0_ALLOC_PTR(cursor);
-		M0_ASSERT(cursor != NULL);
+/**
+ * Put callback will receive record pointer from put routine which will contain
+ * r_flag which will indicate SUCCESS or ERROR code.
+ * If put routine is able to find the record, it will set SUCCESS code and
+ * callback routine needs to put key-value to the given record and return
+ * success code.
+ * else put routine will set the ERROR code to indicate failure and it is
+ * expected to return ERROR code by callback routine.
+ */
+static int ut_btree_kv_put_cb(struct m0_btree_cb *cb, struct m0_btree_rec *rec)
+{
+	struct m0_bufvec_cursor  scur;
+	struct m0_bufvec_cursor  dcur;
+	m0_bcount_t              ksize;
+	m0_bcount_t              vsize;
+	struct ut_cb_data       *datum = cb->c_datum;
 
-		m0_btree_cursor_init(cursor, tree);
-		/** Get and verify the first key. */
-		find_key = m0_byteorder_cpu_to_be64(1);
-		find_key_in_tree.k_data =
-			M0_BUFVEC_INIT_BUF(&find_key_ptr, &find_key_size);
-		rc = m0_btree_cursor_get(cursor, &find_key_in_tree, false);
-		M0_ASSERT(rc == 0);
+	/** The caller can look at these flags if he needs to. */
+	datum->flags = rec->r_flags;
+	M0_ASSERT(datum->flags == M0_BSC_SUCCESS);
 
-		m0_btree_cursor_kv_get(cursor, &cur_key, &cur_val);
-		key = *(uint64_t*)cur_key.b_addr;
-		M0_ASSERT(m0_byteorder_be64_to_cpu(key) == 1);
+	ksize = m0_vec_count(&datum->key->k_data.ov_vec);
+	M0_ASSERT(m0_vec_count(&rec->r_key.k_data.ov_vec) >= ksize);
 
-		/** Verify the next key till the last key of btree.*/
-		for (i = 1; i < (recs_per_stream*stream_count); i++) {
-			rc = m0_btree_cursor_next(cursor);
-			M0_ASSERT(rc == 0);
-			m0_btree_cursor_kv_get(cursor, &cur_key, &cur_val);
-			key = *(uint64_t*)cur_key.b_addr;
-			M0_ASSERT(m0_byteorder_be64_to_cpu(key) - 1 == i);
-		}
-		/** There should not be any key after last key.*/
-		rc = m0_btree_cursor_next(cursor);
-		M0_ASSERT(rc == -ENOENT);
+	vsize = m0_vec_count(&datum->value->ov_vec);
+	M0_ASSERT(m0_vec_count(&rec->r_val.ov_vec) >= vsize);
 
-		/**
-		 * Cursor is at the last key. Verify the previous key till the
-		 * first key of btree.
-		 */
-		for (i = (recs_per_stream*stream_count); i > 1; i--) {
-			rc = m0_btree_cursor_prev(cursor);
-			M0_ASSERT(rc == 0);
-			m0_btree_cursor_kv_get(cursor, &cur_key, &cur_val);
-			key = *(uint64_t*)cur_key.b_addr;
-			M0_ASSERT(m0_byteorder_be64_to_cpu(key) + 1 == i);
-		}
-		/** There should not be any key before first key.*/
-		rc = m0_btree_cursor_prev(cursor);
-		M0_ASSERT(rc == -ENOENT);
+	m0_bufvec_cursor_init(&scur, &datum->key->k_data);
+	m0_bufvec_cursor_init(&dcur, &rec->r_key.k_data);
+	rec->r_key.k_data.ov_vec.v_count[0] =
+	m0_vec_count(&datum->key->k_data.ov_vec);
+	m0_bufvec_cursor_copy(&dcur, &scur, ksize);
 
-		/** The last key should be equal to max key. */
-		rc = m0_btree_cursor_last(cursor);
-		M0_ASSERT(rc == 0);
-		m0_btree_cursor_kv_get(cursor, &cur_key, &cur_val);
-		key = *(uint64_t*)cur_key.b_addr;
-		M0_ASSERT(m0_byteorder_be64_to_cpu(key) ==
-			  (recs_per_stream*stream_count));
+	m0_bufvec_cursor_init(&scur, datum->value);
+	m0_bufvec_cursor_init(&dcur, &rec->r_val);
+	rec->r_val.ov_vec.v_count[0]=
+	m0_vec_count(&datum->value->ov_vec);
+	m0_bufvec_cursor_copy(&dcur, &scur, vsize);
 
-		/** The first key should be equal to min key. */
-		rc = m0_btree_cursor_first(cursor);
-		M0_ASSERT(rc == 0);
-		m0_btree_cursor_kv_get(cursor, &cur_key, &cur_val);
-		key = *(uint64_t*)cur_key.b_addr;
-		M0_ASSERT(m0_byteorder_be64_to_cpu(key) == 1);
-		m0_btree_cursor_fini(cursor);
-		m0_free(cursor);
-	}
+	return 0;
+}
 
-	cred = M0_BE_TX_CREDIT(0, 0);
-	m0_btree_del_credit(tree, 1, ksize, -1, &cred);
-	{
-		struct m0_be_tx_credit  cred2 = {};
+static int ut_btree_kv_get_cb(struct m0_btree_cb *cb, struct m0_btree_rec *rec)
+{
+	struct m0_bufvec_cursor  scur;
+	struct m0_bufvec_cursor  dcur;
+	m0_bcount_t              ksize;
+	m0_bcount_t              vsize;
+	struct ut_cb_data       *datum = cb->c_datum;
+	int                      i      = 0;
 
-		m0_btree_del_credit2(&btree_type, rnode_sz, 1, ksize, vsize,
-				     &cred2);
-		M0_ASSERT(m0_be_tx_credit_eq(&cred,  &cred2));
-	}
+	/** The caller can look at these flags if he needs to. */
+	datum->flags = rec->r_flags;
 
-	for (i = 1; i <= recs_per_stream; i++) {
-		uint64_t            del_key;
-		struct m0_btree_key del_key_in_tree;
-		void                *p_del_key      = &del_key;
-		m0_bcount_t         del_key_size    = sizeof del_key;
-		struct ut_cb_data   del_data;
-		uint32_t            stream_num;
+	M0_ASSERT(rec->r_flags == M0_BSC_SUCCESS);
 
-		del_data = (struct ut_cb_data){.key = &del_key_in_tree,
-			.value       = NULL,
-			.check_value = false,
-			.crc         = M0_BCT_NO_CRC,
-		};
+	if (datum->embedded_ksize) {
+		/** Extract Key size present in the 2nd word.*/
+		m0_bufvec_cursor_init(&scur, &rec->r_key.k_data);
+		m0_bufvec_cursor_move(&scur, sizeof(uint64_t));
+		m0_bufvec_cursor_copyfrom(&scur, &ksize, sizeof(ksize));
+		ksize = m0_byteorder_cpu_to_be64(ksize);
+		M0_PRE(ksize <= MAX_KEY_SIZE &&
+		       m0_vec_count(&rec->r_key.k_data.ov_vec) == ksize);
+	} else {
+		ksize = m0_vec_count(&rec->r_key.k_data.ov_vec);
+		M0_PRE(m0_vec_count(&datum->key->k_data.ov_vec) >= ksize);
+	}
 
-		del_key_in_tree.k_data = M0_BUFVEC_INIT_BUF(&p_del_key,
-							    &del_key_size);
+	if (datum->embedded_vsize) {
+		/** Extract Value size present in the 2nd word.*/
+		m0_bufvec_cursor_init(&scur, &rec->r_val);
+		m0_bufvec_cursor_move(&scur, sizeof(uint64_t));
+		m0_bufvec_cursor_copyfrom(&scur, &vsize, sizeof(vsize));
+		vsize = m0_byteorder_cpu_to_be64(vsize);
+		M0_PRE(vsize <= MAX_VAL_SIZE &&
+		       m0_vec_count(&rec->r_val.ov_vec) == vsize);
+	} else {
+		vsize = m0_vec_count(&rec->r_val.ov_vec);
+		M0_PRE(m0_vec_count(&datum->value->ov_vec) >= vsize);
+	}
 
-		ut_cb.c_act   = ut_btree_kv_del_cb;
-		ut_cb.c_datum = &del_data;
+	/** Copy Key and Value from the btree node to the caller's data space */
+	m0_bufvec_cursor_init(&dcur, &datum->key->k_data);
+	m0_bufvec_cursor_init(&scur, &rec->r_key.k_data);
+	m0_bufvec_cursor_copy(&dcur, &scur, ksize);
 
-		for (stream_num = 0; stream_num < stream_count; stream_num++) {
-			struct m0_btree_cb *del_cb;
-			del_key = i + (stream_num * recs_per_stream);
-			del_key = m0_byteorder_cpu_to_be64(del_key);
+	m0_bufvec_cursor_init(&dcur, datum->value);
+	m0_bufvec_cursor_init(&scur, &rec->r_val);
+	m0_bufvec_cursor_copy(&dcur, &scur, vsize);
 
-			del_cb = (del_key % 5 == 0) ? NULL : &ut_cb;
-			m0_be_ut_tx_init(tx, ut_be);
-			m0_be_tx_prep(tx, &cred);
-			rc = m0_be_tx_open_sync(tx);
-			M0_ASSERT(rc == 0);
+	if (datum->check_value) {
+		struct m0_bufvec_cursor kcur;
+		struct m0_bufvec_cursor vcur;
+		m0_bcount_t             v_off;
+		bool                    check_failed = false;
+		uint64_t                key;
+		uint64_t                value;
+		m0_bcount_t             valuelen     = vsize;
 
-			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-						      m0_btree_del(tree,
-							      &del_key_in_tree,
-							      del_cb,
-							      &kv_op, tx));
-			M0_ASSERT(rc == 0 && del_data.flags == M0_BSC_SUCCESS);
-			m0_be_tx_close_sync(tx);
-			m0_be_tx_fini(tx);
-		}
-	}
+		v_off = 0;
 
-	cred = M0_BE_TX_CREDIT(0, 0);
-	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
-			       rnode_sz_shift, &cred);
-	m0_btree_destroy_credit(tree, NULL, &cred, 1);
+		/**
+		 *  Key present in the 1st word is repeated in the Value array
+		 *  except in word #2 which contains the size of the Value. Use
+		 *  this Key to make sure all the words in the Value array are
+		 *  correct.
+		 */
+		m0_bufvec_cursor_init(&kcur, &rec->r_key.k_data);
+		m0_bufvec_cursor_copyfrom(&kcur, &key, sizeof(key));
+		m0_bufvec_cursor_init(&vcur, &rec->r_val);
 
-	m0_be_ut_tx_init(tx, ut_be);
-	m0_be_tx_prep(tx, &cred);
-	rc = m0_be_tx_open_sync(tx);
-	M0_ASSERT(rc == 0);
+		if (datum->crc != M0_BCT_NO_CRC &&
+		    datum->crc != M0_BCT_BTREE_ENC_RAW_HASH)
+			valuelen -= sizeof(uint64_t);
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(tree, &b_op, tx));
-	M0_ASSERT(rc == 0);
-	M0_SET0(&btree);
+		while (v_off < valuelen) {
+			m0_bufvec_cursor_copyfrom(&vcur, &value, sizeof(value));
+			v_off += sizeof(value);
 
-	/** Delete temp node space which was used as root node for the tree. */
-	buf = M0_BUF_INIT(rnode_sz, rnode);
-	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+			if (i++ == 1)
+				/** Skip the element containing value size.*/
+				continue;
 
-	m0_be_tx_close_sync(tx);
-	m0_be_tx_fini(tx);
+			if (key != value)
+				check_failed = true;
+		}
 
-	btree_ut_fini();
-}
+		/**
+		 * If check_failed then maybe this entry was updated in which
+		 * case we use the complement of the key for comparison.
+		 */
+		if (check_failed) {
+			v_off = 0;
+			m0_bufvec_cursor_init(&vcur, &rec->r_val);
+			key = ~key;
+			i = 0;
 
-struct btree_ut_thread_info {
-	struct m0_thread      ti_q;           /** Used for thread operations. */
-	struct m0_bitmap      ti_cpu_map;     /** CPU map to run this thread. */
-	uint64_t              ti_key_first;     /** First Key value to use. */
-	uint64_t              ti_key_count;     /** Keys to use. */
-	uint64_t              ti_key_incr;     /** Key value to increment by. */
-	uint16_t              ti_thread_id;     /** Thread ID <= 65535. */
-	struct m0_btree      *ti_tree;          /** Tree for KV operations */
-	int                   ti_key_size;      /** Key size in bytes. */
-	int                   ti_value_size;    /** Value size in bytes. */
-	bool                  ti_random_bursts; /** Burstiness in IO pattern. */
-	uint64_t              ti_rng_seed_base; /** Base used for RNG seed. */
-	uint64_t              ti_crc_type;      /** CRC type of records. */
+			while (v_off < valuelen) {
+				m0_bufvec_cursor_copyfrom(&vcur, &value,
+							  sizeof(value));
+				v_off += sizeof(value);
 
-	/**
-	 *  The fields below are used by the thread functions (init and func)
-	 *  to share information. These fields should not be touched by thread
-	 *  launcher.
-	 */
-	struct random_data  ti_random_buf;    /** Buffer used by random func. */
-	char               *ti_rnd_state_ptr; /** State array used by RNG. */
-};
+				if (i++ == 1)
+					continue;
 
-/**
- *  All the threads wait for this variable to turn TRUE.
- *  The main thread sets to TRUE once it has initialized all the threads so
- *  that all the threads start running on different CPU cores and can compete
- *  for the same btree nodes to work on thus exercising possible race
- *  conditions.
- */
-static volatile int64_t thread_run;
+				if (key != value)
+					M0_ASSERT(0);
+			}
+		}
+	}
 
+	/** Verify the CRC if present. */
+	if (datum->crc != M0_BCT_NO_CRC) {
+		uint64_t value_ary[vsize / sizeof(uint64_t)];
+		uint64_t csum_in_value;
+		uint64_t calculated_csum;
 
-static struct m0_atomic64 threads_quiesced;
-static struct m0_atomic64 threads_running;
+		m0_bufvec_cursor_init(&scur, &rec->r_val);
+		m0_bufvec_cursor_copyfrom(&scur, value_ary, sizeof(value_ary));
 
-#define  UT_START_THREADS()                                                   \
-	thread_run = 1
-
-#define  UT_STOP_THREADS()                                                    \
-	thread_run = 0
-
-#define UT_THREAD_WAIT()                                                      \
-	do {                                                                  \
-		while (thread_run == 0)                                       \
-			;                                                     \
-	} while (0)
+		if (datum->crc == M0_BCT_USER_ENC_RAW_HASH) {
+			vsize -= sizeof(uint64_t);
+			m0_bufvec_cursor_init(&scur, &rec->r_val);
+			m0_bufvec_cursor_move(&scur, vsize);
+			m0_bufvec_cursor_copyfrom(&scur, &csum_in_value,
+						  sizeof(csum_in_value));
 
-#define UT_THREAD_QUIESCE_IF_REQUESTED()                                      \
-	do {                                                                  \
-		if (thread_run == 0) {                                        \
-			m0_atomic64_inc(&threads_quiesced);                   \
-			UT_THREAD_WAIT();                                     \
-			m0_atomic64_dec(&threads_quiesced);                   \
-		}                                                             \
-	} while (0)
+			calculated_csum = m0_hash_fnc_fnv1(value_ary, vsize);
+			M0_ASSERT(csum_in_value == calculated_csum);
+		} else if (datum->crc == M0_BCT_BTREE_ENC_RAW_HASH) {
+			void *p_crc = rec->r_val.ov_buf[0] + vsize;
+			calculated_csum = m0_hash_fnc_fnv1(value_ary, vsize);
+			M0_ASSERT(*(uint64_t*)(p_crc) == calculated_csum);
+		} else if (datum->crc == M0_BCT_USER_ENC_FORMAT_FOOTER)
+			M0_ASSERT(m0_format_footer_verify(value_ary, false) == 0);
+	}
 
-#define UT_REQUEST_PEER_THREADS_TO_QUIESCE()                                  \
-	do {                                                                  \
-		bool try_again;                                               \
-		do {                                                          \
-			try_again = false;                                    \
-			if (m0_atomic64_cas((int64_t *)&thread_run, 1, 0)) {  \
-				while (m0_atomic64_get(&threads_quiesced) <   \
-				      m0_atomic64_get(&threads_running) - 1)  \
-					;                                     \
-			} else {                                              \
-				UT_THREAD_QUIESCE_IF_REQUESTED();             \
-				try_again = true;                             \
-			}                                                     \
-		} while (try_again);                                          \
-	} while (0)
+	return 0;
+}
 
 /**
- * Thread init function which will do basic setup such as setting CPU affinity
- * and initializing the RND seed for the thread. Any other initialization that
- * might be needed such as resource allocation/initialization for the thread
- * handler function can also be done here.
+ * Callback will be called before deleting value. If needed, caller can copy the
+ * content of record.
  */
-static int btree_ut_thread_init(struct btree_ut_thread_info *ti)
+static int ut_btree_kv_del_cb(struct m0_btree_cb *cb, struct m0_btree_rec *rec)
 {
-	int rc;
-
-	M0_ALLOC_ARR(ti->ti_rnd_state_ptr, 64);
-	if (ti->ti_rnd_state_ptr == NULL) {
-		return -ENOMEM;
-	}
-
-	M0_SET0(&ti->ti_random_buf);
-	initstate_r(ti->ti_rng_seed_base, ti->ti_rnd_state_ptr, 64,
-		    &ti->ti_random_buf);
+	m0_bcount_t              ksize;
+	struct ut_cb_data       *datum = cb->c_datum;
 
-	srandom_r(ti->ti_thread_id + 1, &ti->ti_random_buf);
+	/** The caller can look at the record if he needs to. */
+	ksize = m0_vec_count(&datum->key->k_data.ov_vec);
+	M0_PRE(ksize <= MAX_KEY_SIZE + sizeof(uint64_t) &&
+	       m0_vec_count(&rec->r_key.k_data.ov_vec) == ksize);
+	M0_PRE(m0_vec_count(&rec->r_val.ov_vec) <=
+	       MAX_VAL_SIZE + sizeof(uint64_t));
 
-	rc = m0_thread_confine(&ti->ti_q, &ti->ti_cpu_map);
+	datum->flags = rec->r_flags;
+	M0_ASSERT(datum->flags == M0_BSC_SUCCESS);
 
-	m0_bitmap_fini(&ti->ti_cpu_map);
-	return rc;
+	return 0;
 }
 
-#define FILL_KEY(key, ksize, data)                                             \
-	do {                                                                   \
-		uint32_t i;                                                    \
-		key[0] = data;                                                 \
-		key[1] = m0_byteorder_cpu_to_be64(ksize);                      \
-		for (i = 2; i < (ksize / sizeof(key[0])); i++)                 \
-			key[i] = data;                                         \
-	} while (0);
+static int ut_btree_kv_update_cb(struct m0_btree_cb *cb,
+				 struct m0_btree_rec *rec)
+{
+	struct m0_bufvec_cursor  scur;
+	struct m0_bufvec_cursor  dcur;
+	m0_bcount_t              vsize;
+	struct ut_cb_data       *datum = cb->c_datum;
 
-#define FILL_VALUE(value, vsize, data, crc)                                    \
-	do {                                                                   \
-		uint32_t i = 0;                                                \
-		if (crc == M0_BCT_NO_CRC) {                                    \
-			value[0] = data;                                       \
-			value[1] = m0_byteorder_cpu_to_be64(vsize);            \
-			for (i = 2; i < (vsize / sizeof(value[0])); i++)       \
-				value[i] = data;                               \
-		} else if (crc == M0_BCT_USER_ENC_RAW_HASH) {                  \
-			value[0] = data;                                       \
-			value[1] = m0_byteorder_cpu_to_be64(vsize);            \
-			for (i = 2; i < ((vsize / sizeof(value[0]) - 1)); i++) \
-				value[i] = data;                               \
-			value[i] = m0_hash_fnc_fnv1(value,                     \
-						    vsize - sizeof(value[0])); \
-		} else if (crc == M0_BCT_USER_ENC_FORMAT_FOOTER) {             \
-			struct m0_format_header *header;                       \
-			struct m0_format_footer *footer;                       \
-			struct m0_format_tag     tag = {                       \
-				.ot_version = 1,                               \
-				.ot_type = 2,                                  \
-				.ot_size = (vsize -                            \
-					    sizeof(struct m0_format_footer)),  \
-			};                                                     \
-                                                                               \
-			M0_CASSERT(sizeof(*header) % sizeof(value[0]) == 0);   \
-			M0_CASSERT(sizeof(*footer) % sizeof(value[0]) == 0);   \
-                                                                               \
-			header = (struct m0_format_header *)value;             \
-			m0_format_header_pack(header, &tag);                   \
-			for (i = (sizeof(*header)/sizeof(value[0]));           \
-			     i < ARRAY_SIZE(value) - (sizeof(*footer) /        \
-						      sizeof(value[0]));       \
-			     i++) {                                            \
-				value[i] = data;                               \
-			}                                                      \
-			m0_format_footer_update(value);                        \
-		} else if (crc == M0_BCT_BTREE_ENC_RAW_HASH) {                 \
-			value[0] = data;                                       \
-			value[1] = m0_byteorder_cpu_to_be64(vsize);            \
-			for (i = 2; i < (vsize / sizeof(value[0])); i++)       \
-				value[i] = data;                               \
-		}                                                              \
-	} while (0);
+	/** The caller can look at these flags if he needs to. */
+	datum->flags = rec->r_flags;
+	M0_ASSERT(datum->flags == M0_BSC_SUCCESS);
 
-#define GET_RANDOM_KEYSIZE(karray, kfirst, kiter_start, kincr)                 \
-	({                                                                     \
-		uint64_t random_size;                                          \
-		random_size = (((kfirst - kiter_start) / kincr) %              \
-			       (KEY_ARR_ELE_COUNT - 1)) + 2;                   \
-		random_size *= sizeof(karray[0]);                              \
-		random_size;                                                   \
-	})
+	vsize = m0_vec_count(&datum->value->ov_vec);
+	M0_ASSERT(m0_vec_count(&rec->r_val.ov_vec) == vsize);
 
-#define GET_RANDOM_VALSIZE(varray, kfirst, kiter_start, kincr, crc)            \
-	({                                                                     \
-		uint64_t random_size = 0;                                      \
-		if (crc == M0_BCT_NO_CRC || crc == M0_BCT_BTREE_ENC_RAW_HASH ) \
-			random_size = (((kfirst - kiter_start) / kincr) %      \
-					(VAL_ARR_ELE_COUNT - 1)) + 2;          \
-		else if (crc == M0_BCT_USER_ENC_RAW_HASH)                      \
-			random_size = (((kfirst - kiter_start) / kincr) %      \
-					(VAL_ARR_ELE_COUNT - 2)) + 3;          \
-		else if (crc == M0_BCT_USER_ENC_FORMAT_FOOTER)                 \
-			random_size = (((kfirst - kiter_start) / kincr) %      \
-					(VAL_ARR_ELE_COUNT - 4)) + 5;          \
-		random_size *= sizeof(varray[0]);                              \
-		random_size;                                                   \
-	})
+	m0_bufvec_cursor_init(&scur, datum->value);
+	m0_bufvec_cursor_init(&dcur, &rec->r_val);
+	rec->r_val.ov_vec.v_count[0]=
+	m0_vec_count(&datum->value->ov_vec);
+	m0_bufvec_cursor_copy(&dcur, &scur, vsize);
 
-/**
- * This routine is a thread handler which launches PUT, GET, ITER, SLANT and DEL
- * operations on the btree passed as parameter.
- */
-static void btree_ut_kv_oper_thread_handler(struct btree_ut_thread_info *ti)
-{
-	uint64_t                key[KEY_ARR_ELE_COUNT];
-	uint64_t                value[VAL_ARR_ELE_COUNT];
-	void                   *k_ptr         = &key;
-	void                   *v_ptr         = &value;
-	m0_bcount_t             ksize         = ti->ti_key_size;
-	m0_bcount_t             vsize         = ti->ti_value_size;
-	struct m0_btree_rec     rec;
-	struct m0_btree_cb      ut_cb;
-	struct ut_cb_data       data;
+	return 0;
+}
 
-	uint64_t                get_key[ARRAY_SIZE(key)];
-	uint64_t                get_value[ARRAY_SIZE(value)];
-	m0_bcount_t             get_ksize;
-	m0_bcount_t             get_vsize;
-	void                   *get_k_ptr     = &get_key;
-	void                   *get_v_ptr     = &get_value;
-	struct m0_btree_rec     get_rec;
-	struct m0_btree_cb      ut_get_cb;
-	struct ut_cb_data       get_data;
+#if (AVOID_BE_SEGMENT == 1)
+enum {
+	MIN_STREAM_CNT         = 5,
+	MAX_STREAM_CNT         = 20,
 
-	uint64_t                key_iter_start;
-	uint64_t                key_end;
-	struct m0_btree_op      kv_op        = {};
-	struct m0_btree        *tree;
-	bool                    ksize_random =
-					ti->ti_key_size == RANDOM_KEY_SIZE;
-	bool                    vsize_random =
-					ti->ti_value_size == RANDOM_VALUE_SIZE;
-	struct m0_be_tx         tx_data;
-	struct m0_be_tx        *tx           = &tx_data;
-	struct m0_be_tx_credit  put_cred     = {};
-	struct m0_be_tx_credit  update_cred  = {};
-	struct m0_be_tx_credit  del_cred     = {};
-	enum m0_btree_crc_type  crc          = ti->ti_crc_type;
+	MIN_RECS_PER_STREAM    = 5,
+	MAX_RECS_PER_STREAM    = 2048,
 
-	/**
-	 *  Currently our thread routine only supports Keys and Values which are
-	 *  a multiple of 8 bytes.
-	 */
-	M0_ASSERT(ti->ti_key_size == RANDOM_KEY_SIZE ||
-		  (ti->ti_key_size % sizeof(uint64_t) == 0 &&
-		   ti->ti_key_size > sizeof(key[0]) &&
-		   ti->ti_key_size <= sizeof(key)));
-	M0_ASSERT(ti->ti_value_size == RANDOM_VALUE_SIZE ||
-		  (ti->ti_value_size % sizeof(uint64_t) == 0 &&
-		   ((crc == M0_BCT_USER_ENC_RAW_HASH &&
-		     ti->ti_value_size > sizeof(value[0]) * 2) ||
-		    (crc == M0_BCT_NO_CRC &&
-		     ti->ti_value_size > sizeof(value[0])) ||
-		    (crc == M0_BCT_BTREE_ENC_RAW_HASH &&
-		     ti->ti_value_size > sizeof(value[0]))) &&
-		   ti->ti_value_size <= sizeof(value)));
+	MAX_RECS_PER_THREAD    = 10000, /** Records count for each thread */
 
-	M0_CASSERT(KEY_ARR_ELE_COUNT > 1 && VAL_ARR_ELE_COUNT > 1);
+	MIN_TREE_LOOPS         = 1000,
+	MAX_TREE_LOOPS         = 2000,
+	MAX_RECS_FOR_TREE_TEST = 100,
 
-	key_iter_start = ti->ti_key_first;
-	key_end        = ti->ti_key_first +
-			 (ti->ti_key_count * ti->ti_key_incr) - ti->ti_key_incr;
+	RANDOM_TREE_COUNT      = -1,
+	RANDOM_THREAD_COUNT    = -1,
 
-	rec.r_key.k_data   = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize);
-	rec.r_val          = M0_BUFVEC_INIT_BUF(&v_ptr, &vsize);
+	/** Key/Value array size used in UTs. Increment for CRC in Value. */
+	KEY_ARR_ELE_COUNT      = MAX_KEY_SIZE / sizeof(uint64_t),
+	VAL_ARR_ELE_COUNT      = MAX_VAL_SIZE / sizeof(uint64_t),
+	RANDOM_KEY_SIZE        = -1,
+	RANDOM_VALUE_SIZE      = -1,
 
-	data.key           = &rec.r_key;
-	data.value         = &rec.r_val;
+	BE_UT_SEG_SIZE         = 0,
+	MAX_TEST_RETRIES       = 20,
+};
+#else
+enum {
+	MIN_STREAM_CNT         = 5,
+	MAX_STREAM_CNT         = 10,
 
-	ut_cb.c_act        = ut_btree_kv_put_cb;
-	ut_cb.c_datum      = &data;
+	MIN_RECS_PER_STREAM    = 5,
+	MAX_RECS_PER_STREAM    = 200,
 
-	get_rec.r_key.k_data   = M0_BUFVEC_INIT_BUF(&get_k_ptr, &get_ksize);
-	get_rec.r_val          = M0_BUFVEC_INIT_BUF(&get_v_ptr, &get_vsize);
+	MAX_RECS_PER_THREAD    = 1000, /** Records count for each thread */
 
-	get_data.key            = &get_rec.r_key;
-	get_data.value          = &get_rec.r_val;
-	get_data.check_value    = true;
-	get_data.crc            = crc;
-	get_data.embedded_ksize = true;
-	get_data.embedded_vsize = true;
+	MIN_TREE_LOOPS         = 50,
+	MAX_TREE_LOOPS         = 100,
+	MAX_RECS_FOR_TREE_TEST = 50,
 
-	ut_get_cb.c_act        = ut_btree_kv_get_cb;
-	ut_get_cb.c_datum      = &get_data;
+	RANDOM_TREE_COUNT      = -1,
+	RANDOM_THREAD_COUNT    = -1,
 
-	tree                   = ti->ti_tree;
+	/** Key/Value array size used in UTs. Increment for CRC in Value. */
+	KEY_ARR_ELE_COUNT      = MAX_KEY_SIZE / sizeof(uint64_t),
+	VAL_ARR_ELE_COUNT      = MAX_VAL_SIZE / sizeof(uint64_t),
+	RANDOM_KEY_SIZE        = -1,
+	RANDOM_VALUE_SIZE      = -1,
 
-	/** Wait till all the threads have been initialised. */
-	UT_THREAD_WAIT();
-	m0_atomic64_inc(&threads_running);
+	BE_UT_SEG_SIZE         = 10ULL * 1024ULL * 1024ULL * 1024ULL,
+	MAX_TEST_RETRIES       = 20,
+};
+#endif
 
-	put_cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-	m0_btree_put_credit(tree, 1, ksize, vsize, &put_cred);
+/**
+ * This unit test exercises the KV operations triggered by multiple streams.
+ */
+static void ut_multi_stream_kv_oper(void)
+{
+	void                   *rnode;
+	int                     i;
+	time_t                  curr_time;
+	struct m0_btree_cb      ut_cb;
+	struct m0_be_tx         tx_data         = {};
+	struct m0_be_tx        *tx              = &tx_data;
+	struct m0_be_tx_credit  cred            = {};
+	struct m0_btree_op      b_op            = {};
+	uint32_t                stream_count    = 0;
+	uint64_t                recs_per_stream = 0;
+	struct m0_btree_op      kv_op           = {};
+	struct m0_btree        *tree;
+	struct m0_btree         btree = {};
+	struct m0_btree_type    btree_type      = {.tt_id = M0_BT_UT_KV_OPS,
+						  .ksize = sizeof(uint64_t),
+						  .vsize = btree_type.ksize*2,
+						  };
+	uint64_t                key;
+	uint64_t                value[btree_type.vsize / sizeof(uint64_t)];
+	m0_bcount_t             ksize           = sizeof key;
+	m0_bcount_t             vsize           = sizeof value;
+	void                   *k_ptr           = &key;
+	void                   *v_ptr           = &value;
+	int                     rc;
+	struct m0_buf           buf;
+	uint64_t                maxkey          = 0;
+	uint64_t                minkey          = UINT64_MAX;
+	uint32_t                rnode_sz        = m0_pagesize_get();
+	uint32_t                rnode_sz_shift;
+	struct m0_fid           fid             = M0_FID_TINIT('b', 0, 1);
 
-	update_cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-	m0_btree_update_credit(tree, 1, ksize, vsize, &update_cred);
+	M0_ENTRY();
 
-	del_cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-	m0_btree_del_credit(tree, 1, ksize, -1, &del_cred);
+	time(&curr_time);
+	M0_LOG(M0_INFO, "Using seed %lu", curr_time);
+	srandom(curr_time);
 
-	while (key_iter_start <= key_end) {
-		uint64_t  key_first;
-		uint64_t  key_last;
-		uint64_t  keys_put_count = 0;
-		uint64_t  keys_found_count = 0;
-		int       i;
-		int32_t   r;
-		uint64_t  iter_dir;
-		uint64_t  del_key;
-		int       rc;
-		uint64_t  kdata;
+	stream_count = (random() % (MAX_STREAM_CNT - MIN_STREAM_CNT)) +
+			MIN_STREAM_CNT;
 
-		key_first = key_iter_start;
-		if (ti->ti_random_bursts) {
-			random_r(&ti->ti_random_buf, &r);
-			if (key_first == key_end)
-				key_last = key_end;
-			else
-				key_last = (r % (key_end - key_first)) +
-					   key_first;
+	recs_per_stream = (random()%
+			   (MAX_RECS_PER_STREAM - MIN_RECS_PER_STREAM)) +
+			    MIN_RECS_PER_STREAM;
 
-			key_last = (key_last / ti->ti_key_incr) *
-				   ti->ti_key_incr + ti->ti_key_first;
-		} else
-			key_last = key_end;
+	btree_ut_init();
+	/**
+	 *  Run valid scenario:
+	 *  1) Create a btree
+	 *  2) Adds records in multiple streams to the created tree.
+	 *  3) Confirms the records are present in the tree.
+	 *  4) Deletes all the records from the tree using multiple streams.
+	 *  5) Close the btree
+	 *  6) Destroy the btree
+	 *
+	 *  Capture each operation in a separate transaction.
+	 */
 
-		/** PUT keys and their corresponding values in the tree. */
+	M0_ASSERT(rnode_sz != 0 && m0_is_po2(rnode_sz));
+	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_create_credit(&btree_type, &cred, 1);
 
-		ut_cb.c_act   = ut_btree_kv_put_cb;
-		ut_cb.c_datum = &data;
+	/** Prepare transaction to capture tree operations. */
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
 
-		while (key_first <= key_last - ti->ti_key_incr) {
-			/**
-			 * for variable key/value size, the size will increment
-			 * in multiple of 8 after each iteration. The size will
-			 * wrap around on reaching MAX_KEY_SIZE. To make sure
-			 * there is atleast one key and size, arr_size is
-			 * incremented by 1.
-			 */
-			ksize = ksize_random ?
-				GET_RANDOM_KEYSIZE(key, key_first,
-						   key_iter_start,
-						   ti->ti_key_incr):
-				ti->ti_key_size;
-			vsize = vsize_random ?
-				GET_RANDOM_VALSIZE(value, key_first,
-						   key_iter_start,
-						   ti->ti_key_incr, crc) :
-				ti->ti_value_size;
-			/**
-			 *  Embed the thread-id in LSB so that different threads
-			 *  will target the same node thus causing race
-			 *  conditions useful to mimic and test btree operations
-			 *  in a loaded system.
-			 */
-			kdata = (key_first << (sizeof(ti->ti_thread_id) * 8)) +
-				ti->ti_thread_id;
-			kdata = m0_byteorder_cpu_to_be64(kdata);
+	/** Create temp node space and use it as root node for btree */
+	buf = M0_BUF_INIT(rnode_sz, NULL);
+	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	rnode = buf.b_addr;
 
-			FILL_KEY(key, ksize, kdata);
-			FILL_VALUE(value, vsize, kdata, crc);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(rnode, rnode_sz,
+							     &btree_type,
+							     M0_BCT_NO_CRC,
+							     &b_op, &btree, seg,
+							     &fid, tx, NULL));
+	M0_ASSERT(rc == M0_BSC_SUCCESS);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+
+	tree = b_op.bo_arbor;
+
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_btree_put_credit(tree, 1, ksize, vsize, &cred);
+	{
+		struct m0_be_tx_credit  cred2 = {};
+
+		m0_btree_put_credit2(&btree_type, rnode_sz, 1, ksize, vsize,
+				     &cred2);
+		M0_ASSERT(m0_be_tx_credit_eq(&cred,  &cred2));
+	}
+
+	for (i = 1; i <= recs_per_stream; i++) {
+		struct ut_cb_data    put_data;
+		struct m0_btree_rec  rec;
+		uint32_t             stream_num;
+
+		rec.r_key.k_data   = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize);
+		rec.r_val          = M0_BUFVEC_INIT_BUF(&v_ptr, &vsize);
+		rec.r_crc_type     = M0_BCT_NO_CRC;
+
+		for (stream_num = 0; stream_num < stream_count; stream_num++) {
+			int k;
+
+			key = i + (stream_num * recs_per_stream);
+			if (key < minkey)
+				minkey = key;
+			if (key > maxkey)
+				maxkey = key;
+
+			key = m0_byteorder_cpu_to_be64(key);
+			for (k = 0; k < ARRAY_SIZE(value); k++) {
+				value[k] = key;
+			}
+
+			put_data.key       = &rec.r_key;
+			put_data.value     = &rec.r_val;
+
+			ut_cb.c_act        = ut_btree_kv_put_cb;
+			ut_cb.c_datum      = &put_data;
 
 			m0_be_ut_tx_init(tx, ut_be);
-			m0_be_tx_prep(tx, &put_cred);
+			m0_be_tx_prep(tx, &cred);
 			rc = m0_be_tx_open_sync(tx);
 			M0_ASSERT(rc == 0);
 
@@ -10300,619 +11307,1713 @@ static void btree_ut_kv_oper_thread_handler(struct btree_ut_thread_info *ti)
 						      m0_btree_put(tree, &rec,
 								   &ut_cb,
 								   &kv_op, tx));
-			M0_ASSERT(rc == 0 && data.flags == M0_BSC_SUCCESS);
+			M0_ASSERT(rc == 0 && put_data.flags == M0_BSC_SUCCESS);
 			m0_be_tx_close_sync(tx);
 			m0_be_tx_fini(tx);
-
-			keys_put_count++;
-			key_first += ti->ti_key_incr;
-
-			UT_THREAD_QUIESCE_IF_REQUESTED();
 		}
+	}
 
-		/** Verify btree_update with BOF_INSERT_IF_NOT_FOUND flag.
-		 * 1. call update operation for non-existing record, which
-		 *    should return -ENOENT.
-		 * 2. call update operation for non-existing record with,
-		 *    BOF_INSERT_IF_NOT_FOUND flag which should insert record
-		 *    and return success.
-		 */
-		ut_cb.c_datum = &data;
+	{
+		/** Min/Max key verification test. */
+		struct ut_cb_data    get_data;
+		struct m0_btree_key  get_key;
+		struct m0_bufvec     get_value;
 
-		ksize = ksize_random ?
-			GET_RANDOM_KEYSIZE(key, key_first, key_iter_start,
-					   ti->ti_key_incr):
-			ti->ti_key_size;
-		vsize = vsize_random ?
-			GET_RANDOM_VALSIZE(value, key_first, key_iter_start,
-					   ti->ti_key_incr, crc) :
-			ti->ti_value_size;
+		get_key.k_data          = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize);
+		get_value               = M0_BUFVEC_INIT_BUF(&v_ptr, &vsize);
 
-		kdata = (key_first << (sizeof(ti->ti_thread_id) * 8)) +
-			ti->ti_thread_id;
-		kdata = m0_byteorder_cpu_to_be64(kdata);
-
-		FILL_KEY(key, ksize, kdata);
-		FILL_VALUE(value, vsize, kdata, crc);
+		get_data.key            = &get_key;
+		get_data.value          = &get_value;
+		get_data.check_value    = true;
+		get_data.crc            = M0_BCT_NO_CRC;
+		get_data.embedded_ksize = false;
+		get_data.embedded_vsize = false;
 
-		m0_be_ut_tx_init(tx, ut_be);
-		m0_be_tx_prep(tx, &put_cred);
-		rc = m0_be_tx_open_sync(tx);
-		M0_ASSERT(rc == 0);
+		ut_cb.c_act             = ut_btree_kv_get_cb;
+		ut_cb.c_datum           = &get_data;
 
-		ut_cb.c_act = ut_btree_kv_update_cb;
 		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_update(tree, &rec,
-							      &ut_cb, 0,
-							      &kv_op, tx));
-		M0_ASSERT(rc == M0_ERR(-ENOENT));
+					      m0_btree_minkey(tree, &ut_cb, 0,
+							      &kv_op));
+		M0_ASSERT(rc == M0_BSC_SUCCESS &&
+			  minkey == m0_byteorder_be64_to_cpu(key));
 
-		ut_cb.c_act = ut_btree_kv_put_cb;
 		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					m0_btree_update(tree, &rec,
-							&ut_cb,
-							BOF_INSERT_IF_NOT_FOUND,
-							&kv_op, tx));
+					      m0_btree_maxkey(tree, &ut_cb, 0,
+							      &kv_op));
+		M0_ASSERT(rc == M0_BSC_SUCCESS &&
+			  maxkey == m0_byteorder_be64_to_cpu(key));
+	}
 
-		M0_ASSERT(rc == 0 && data.flags == M0_BSC_SUCCESS);
-		m0_be_tx_close_sync(tx);
-		m0_be_tx_fini(tx);
+	for (i = 1; i <= (recs_per_stream*stream_count); i++) {
+		struct ut_cb_data    get_data;
+		struct m0_btree_key  get_key;
+		struct m0_bufvec     get_value;
+		uint64_t             find_key;
+		void                *find_key_ptr      = &find_key;
+		m0_bcount_t          find_key_size     = sizeof find_key;
+		struct m0_btree_key  find_key_in_tree;
 
-		keys_put_count++;
-		key_first += ti->ti_key_incr;
+		find_key = m0_byteorder_cpu_to_be64(i);
+		find_key_in_tree.k_data =
+			M0_BUFVEC_INIT_BUF(&find_key_ptr, &find_key_size);
 
-		/** Verify btree_update for value size increase/decrease. */
+		get_key.k_data = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize);
+		get_value      = M0_BUFVEC_INIT_BUF(&v_ptr, &vsize);
 
-		key_first     = key_iter_start;
-		ut_cb.c_act   = ut_btree_kv_update_cb;
-		ut_cb.c_datum = &data;
-		while (vsize_random && key_first <= key_last) {
-			vsize = GET_RANDOM_VALSIZE(value, key_first,
-						   key_iter_start,
-						   ti->ti_key_incr, crc);
-			/**
-			 * Skip updating value size for max val size as
-			 * it can create array outbound for val[]
-			 */
-			if (vsize >= (VAL_ARR_ELE_COUNT * sizeof(value[0]))) {
-				key_first += (ti->ti_key_incr * 5);
-				continue;
-			}
-			/** Test value size increase case. */
-			vsize += sizeof(value[0]);
-			ksize = ksize_random ?
-				GET_RANDOM_KEYSIZE(key, key_first,
-						    key_iter_start,
-						    ti->ti_key_incr):
-				ti->ti_key_size;
+		get_data.key            = &get_key;
+		get_data.value          = &get_value;
+		get_data.check_value    = true;
+		get_data.crc            = M0_BCT_NO_CRC;
+		get_data.embedded_ksize = false;
+		get_data.embedded_vsize = false;
 
-			kdata = (key_first << (sizeof(ti->ti_thread_id) * 8)) +
-				 ti->ti_thread_id;
-			kdata = m0_byteorder_cpu_to_be64(kdata);
+		ut_cb.c_act    = ut_btree_kv_get_cb;
+		ut_cb.c_datum  = &get_data;
 
-			FILL_KEY(key, ksize, kdata);
-			FILL_VALUE(value, vsize, kdata, crc);
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_get(tree,
+							   &find_key_in_tree,
+							   &ut_cb, BOF_EQUAL,
+							   &kv_op));
+		M0_ASSERT(rc == M0_BSC_SUCCESS &&
+			  i == m0_byteorder_be64_to_cpu(key));
+	}
 
-			m0_be_ut_tx_init(tx, ut_be);
-			m0_be_tx_prep(tx, &update_cred);
-			rc = m0_be_tx_open_sync(tx);
-			M0_ASSERT(rc == 0);
+	{
+		/** UT for Cursor verification. */
+		struct m0_btree_cursor *cursor;
+		struct m0_buf           cur_key;
+		struct m0_buf           cur_val;
+		uint64_t                find_key;
+		void                   *find_key_ptr  = &find_key;
+		m0_bcount_t             find_key_size = sizeof find_key;
+		struct m0_btree_key     find_key_in_tree;
 
-			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-						      m0_btree_update(tree,
-								      &rec,
-								      &ut_cb, 0,
-								      &kv_op,
-								      tx));
-			M0_ASSERT(rc == 0 && data.flags == M0_BSC_SUCCESS);
+		M0_ALLOC_PTR(cursor);
+		M0_ASSERT(cursor != NULL);
 
-			m0_be_tx_close_sync(tx);
-			m0_be_tx_fini(tx);
+		m0_btree_cursor_init(cursor, tree);
+		/** Get and verify the first key. */
+		find_key = m0_byteorder_cpu_to_be64(1);
+		find_key_in_tree.k_data =
+			M0_BUFVEC_INIT_BUF(&find_key_ptr, &find_key_size);
+		rc = m0_btree_cursor_get(cursor, &find_key_in_tree, false);
+		M0_ASSERT(rc == 0);
 
-			/** Test value size decrease case. */
-			vsize -= sizeof(value[0]);
-			FILL_VALUE(value, vsize, kdata, crc);
+		m0_btree_cursor_kv_get(cursor, &cur_key, &cur_val);
+		key = *(uint64_t*)cur_key.b_addr;
+		M0_ASSERT(m0_byteorder_be64_to_cpu(key) == 1);
 
-			m0_be_ut_tx_init(tx, ut_be);
-			m0_be_tx_prep(tx, &update_cred);
-			rc = m0_be_tx_open_sync(tx);
+		/** Verify the next key till the last key of btree.*/
+		for (i = 1; i < (recs_per_stream*stream_count); i++) {
+			rc = m0_btree_cursor_next(cursor);
 			M0_ASSERT(rc == 0);
-
-			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-						      m0_btree_update(tree,
-								      &rec,
-								      &ut_cb, 0,
-								      &kv_op,
-								      tx));
-			M0_ASSERT(rc == 0 && data.flags == M0_BSC_SUCCESS);
-
-			m0_be_tx_close_sync(tx);
-			m0_be_tx_fini(tx);
-
-			key_first += (ti->ti_key_incr * 5);
+			m0_btree_cursor_kv_get(cursor, &cur_key, &cur_val);
+			key = *(uint64_t*)cur_key.b_addr;
+			M0_ASSERT(m0_byteorder_be64_to_cpu(key) - 1 == i);
 		}
+		/** There should not be any key after last key.*/
+		rc = m0_btree_cursor_next(cursor);
+		M0_ASSERT(rc == -ENOENT);
 
 		/**
-		 * Execute one error case where we PUT a key which already
-		 * exists in the btree.
+		 * Cursor is at the last key. Verify the previous key till the
+		 * first key of btree.
 		 */
-		key_first = key_iter_start;
-		if ((key_last - key_first) > (ti->ti_key_incr * 2))
-			key_first += ti->ti_key_incr;
+		for (i = (recs_per_stream*stream_count); i > 1; i--) {
+			rc = m0_btree_cursor_prev(cursor);
+			M0_ASSERT(rc == 0);
+			m0_btree_cursor_kv_get(cursor, &cur_key, &cur_val);
+			key = *(uint64_t*)cur_key.b_addr;
+			M0_ASSERT(m0_byteorder_be64_to_cpu(key) + 1 == i);
+		}
+		/** There should not be any key before first key.*/
+		rc = m0_btree_cursor_prev(cursor);
+		M0_ASSERT(rc == -ENOENT);
 
-		ksize = ksize_random ?
-			GET_RANDOM_KEYSIZE(key, key_first, key_iter_start,
-					   ti->ti_key_incr):
-			ti->ti_key_size;
+		/** The last key should be equal to max key. */
+		rc = m0_btree_cursor_last(cursor);
+		M0_ASSERT(rc == 0);
+		m0_btree_cursor_kv_get(cursor, &cur_key, &cur_val);
+		key = *(uint64_t*)cur_key.b_addr;
+		M0_ASSERT(m0_byteorder_be64_to_cpu(key) ==
+			  (recs_per_stream*stream_count));
 
-		kdata = (key_first << (sizeof(ti->ti_thread_id) * 8)) +
-			ti->ti_thread_id;
-		kdata = m0_byteorder_cpu_to_be64(kdata);
+		/** The first key should be equal to min key. */
+		rc = m0_btree_cursor_first(cursor);
+		M0_ASSERT(rc == 0);
+		m0_btree_cursor_kv_get(cursor, &cur_key, &cur_val);
+		key = *(uint64_t*)cur_key.b_addr;
+		M0_ASSERT(m0_byteorder_be64_to_cpu(key) == 1);
+		m0_btree_cursor_fini(cursor);
+		m0_free(cursor);
+	}
 
-		FILL_KEY(key, ksize, kdata);
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_btree_del_credit(tree, 1, ksize, -1, &cred);
+	{
+		struct m0_be_tx_credit  cred2 = {};
 
-		/** Skip initializing the value as this is an error case */
+		m0_btree_del_credit2(&btree_type, rnode_sz, 1, ksize, vsize,
+				     &cred2);
+		M0_ASSERT(m0_be_tx_credit_eq(&cred,  &cred2));
+	}
 
-		m0_be_ut_tx_init(tx, ut_be);
-		m0_be_tx_prep(tx, &put_cred);
-		rc = m0_be_tx_open_sync(tx);
-		M0_ASSERT(rc == 0);
+	for (i = 1; i <= recs_per_stream; i++) {
+		uint64_t            del_key;
+		struct m0_btree_key del_key_in_tree;
+		void                *p_del_key      = &del_key;
+		m0_bcount_t         del_key_size    = sizeof del_key;
+		struct ut_cb_data   del_data;
+		uint32_t            stream_num;
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_put(tree, &rec, &ut_cb,
-							   &kv_op, tx));
-		M0_ASSERT(rc == M0_ERR(-EEXIST));
-		m0_be_tx_close_sync(tx);
-		m0_be_tx_fini(tx);
+		del_data = (struct ut_cb_data){.key = &del_key_in_tree,
+			.value       = NULL,
+			.check_value = false,
+			.crc         = M0_BCT_NO_CRC,
+		};
 
-		/** Modify 20% of the values which have been inserted. */
+		del_key_in_tree.k_data = M0_BUFVEC_INIT_BUF(&p_del_key,
+							    &del_key_size);
 
-		key_first     = key_iter_start;
-		ut_cb.c_act   = ut_btree_kv_update_cb;
-		ut_cb.c_datum = &data;
+		ut_cb.c_act   = ut_btree_kv_del_cb;
+		ut_cb.c_datum = &del_data;
 
-		while (key_first <= key_last) {
-			/**
-			 *  Embed the thread-id in LSB so that different threads
-			 *  will target the same node thus causing race
-			 *  conditions useful to mimic and test btree operations
-			 *  in a loaded system.
-			 */
-			ksize = ksize_random ?
-				GET_RANDOM_KEYSIZE(key, key_first,
-						   key_iter_start,
-						   ti->ti_key_incr):
-				ti->ti_key_size;
-			vsize = vsize_random ?
-				GET_RANDOM_VALSIZE(value, key_first,
-						   key_iter_start,
-						   ti->ti_key_incr, crc) :
-				ti->ti_value_size;
-
-			kdata = (key_first << (sizeof(ti->ti_thread_id) * 8)) +
-				 ti->ti_thread_id;
-			kdata = m0_byteorder_cpu_to_be64(kdata);
-
-			FILL_KEY(key, ksize, kdata);
-			kdata = ~kdata;
-			FILL_VALUE(value, vsize, kdata, crc);
+		for (stream_num = 0; stream_num < stream_count; stream_num++) {
+			struct m0_btree_cb *del_cb;
+			del_key = i + (stream_num * recs_per_stream);
+			del_key = m0_byteorder_cpu_to_be64(del_key);
 
+			del_cb = (del_key % 5 == 0) ? NULL : &ut_cb;
 			m0_be_ut_tx_init(tx, ut_be);
-			m0_be_tx_prep(tx, &update_cred);
+			m0_be_tx_prep(tx, &cred);
 			rc = m0_be_tx_open_sync(tx);
 			M0_ASSERT(rc == 0);
 
 			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-						      m0_btree_update(tree,
-								      &rec,
-								      &ut_cb, 0,
-								      &kv_op,
-								      tx));
-			M0_ASSERT(rc == 0 && data.flags == M0_BSC_SUCCESS);
+						      m0_btree_del(tree,
+							      &del_key_in_tree,
+							      del_cb,
+							      &kv_op, tx));
+			M0_ASSERT(rc == 0 && del_data.flags == M0_BSC_SUCCESS);
 			m0_be_tx_close_sync(tx);
 			m0_be_tx_fini(tx);
-
-			key_first += (ti->ti_key_incr * 5);
 		}
+	}
 
-		/**
-		 * Execute one error case where we UPDATE a key that does not
-		 * exist in the btree.
-		 */
-		key_first = key_iter_start;
-		ksize = ksize_random ?
-			GET_RANDOM_KEYSIZE(key, key_first, key_iter_start,
-					   ti->ti_key_incr) :
-			ti->ti_key_size;
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_destroy_credit(tree, NULL, &cred, 1);
 
-		kdata = (key_first << (sizeof(ti->ti_thread_id) * 8)) +
-			 (typeof(ti->ti_thread_id))-1;
-		kdata = m0_byteorder_cpu_to_be64(kdata);
-		FILL_KEY(key, ksize, kdata);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
 
-		/** Skip initializing the value as this is an error case */
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(tree, &b_op, tx));
+	M0_ASSERT(rc == 0);
+	M0_SET0(&btree);
 
-		m0_be_ut_tx_init(tx, ut_be);
-		m0_be_tx_prep(tx, &update_cred);
-		rc = m0_be_tx_open_sync(tx);
-		M0_ASSERT(rc == 0);
+	/** Delete temp node space which was used as root node for the tree. */
+	buf = M0_BUF_INIT(rnode_sz, rnode);
+	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_update(tree, &rec,
-							      &ut_cb, 0,
-							      &kv_op, tx));
-		M0_ASSERT(rc == M0_ERR(-ENOENT));
-		m0_be_tx_close_sync(tx);
-		m0_be_tx_fini(tx);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
 
-		/** GET and ITERATE over the keys which we inserted above. */
+	btree_ut_fini();
+}
 
-		/**  Randomly decide the iteration direction. */
-		random_r(&ti->ti_random_buf, &r);
+struct btree_ut_thread_info {
+	struct m0_thread      ti_q;           /** Used for thread operations. */
+	struct m0_bitmap      ti_cpu_map;     /** CPU map to run this thread. */
+	uint64_t              ti_key_first;     /** First Key value to use. */
+	uint64_t              ti_key_count;     /** Keys to use. */
+	uint64_t              ti_key_incr;     /** Key value to increment by. */
+	uint16_t              ti_thread_id;     /** Thread ID <= 65535. */
+	struct m0_btree      *ti_tree;          /** Tree for KV operations */
+	int                   ti_key_size;      /** Key size in bytes. */
+	int                   ti_value_size;    /** Value size in bytes. */
+	bool                  ti_random_bursts; /** Burstiness in IO pattern. */
+	uint64_t              ti_rng_seed_base; /** Base used for RNG seed. */
+	uint64_t              ti_crc_type;      /** CRC type of records. */
 
-		key_first = key_iter_start;
-		if (r % 2) {
-			/** Iterate forward. */
-			iter_dir = BOF_NEXT;
-			ksize = ksize_random ?
-				GET_RANDOM_KEYSIZE(key, key_first,
-						   key_iter_start,
-						   ti->ti_key_incr) :
-				ti->ti_key_size;
+	/**
+	 *  The fields below are used by the thread functions (init and func)
+	 *  to share information. These fields should not be touched by thread
+	 *  launcher.
+	 */
+	struct random_data  ti_random_buf;    /** Buffer used by random func. */
+	char               *ti_rnd_state_ptr; /** State array used by RNG. */
+};
 
-			kdata = (key_first <<
-				  (sizeof(ti->ti_thread_id) * 8)) +
-				 ti->ti_thread_id;
-			kdata = m0_byteorder_cpu_to_be64(kdata);
-			FILL_KEY(key, ksize, kdata);
-		} else {
-			/** Iterate backward. */
-			iter_dir = BOF_PREV;
-			ksize = ksize_random ?
-				GET_RANDOM_KEYSIZE(key, key_last,
-						   key_iter_start,
-						   ti->ti_key_incr) :
-				ti->ti_key_size;
+/**
+ *  All the threads wait for this variable to turn TRUE.
+ *  The main thread sets to TRUE once it has initialized all the threads so
+ *  that all the threads start running on different CPU cores and can compete
+ *  for the same btree nodes to work on thus exercising possible race
+ *  conditions.
+ */
+static volatile int64_t thread_run;
 
-			kdata = (key_last <<
-				  (sizeof(ti->ti_thread_id) * 8)) +
-				 ti->ti_thread_id;
-			kdata = m0_byteorder_cpu_to_be64(kdata);
-			FILL_KEY(key, ksize, kdata);
-		}
-		get_ksize = ksize;
-		get_vsize = ti->ti_value_size;
-		get_data.check_value = true; /** Compare value with key */
-		get_data.crc         = crc;
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_get(tree, &rec.r_key,
-							   &ut_get_cb,
-							   BOF_EQUAL, &kv_op));
-		M0_ASSERT(rc == 0);
+static struct m0_atomic64 threads_quiesced;
+static struct m0_atomic64 threads_running;
 
-		keys_found_count++;
+#define  UT_START_THREADS()                                                   \
+	thread_run = 1
 
-		while (1) {
-			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-						      m0_btree_iter(tree,
-								    &rec.r_key,
-								    &ut_get_cb,
-								    iter_dir,
-								    &kv_op));
-			if (rc == -ENOENT)
-				break;
+#define  UT_STOP_THREADS()                                                    \
+	thread_run = 0
 
-			keys_found_count++;
+#define UT_THREAD_WAIT()                                                      \
+	do {                                                                  \
+		while (thread_run == 0)                                       \
+			;                                                     \
+	} while (0)
 
-			/** Copy over the gotten key for the next search. */
-			ksize = get_ksize;
-			for (i = 0; i < ksize / sizeof(get_key[0]); i++) {
-				key[i] = get_key[i];
-			}
+#define UT_THREAD_QUIESCE_IF_REQUESTED()                                      \
+	do {                                                                  \
+		if (thread_run == 0) {                                        \
+			m0_atomic64_inc(&threads_quiesced);                   \
+			UT_THREAD_WAIT();                                     \
+			m0_atomic64_dec(&threads_quiesced);                   \
+		}                                                             \
+	} while (0)
 
-			UT_THREAD_QUIESCE_IF_REQUESTED();
-		}
+#define UT_REQUEST_PEER_THREADS_TO_QUIESCE()                                  \
+	do {                                                                  \
+		bool try_again;                                               \
+		do {                                                          \
+			try_again = false;                                    \
+			if (m0_atomic64_cas((int64_t *)&thread_run, 1, 0)) {  \
+				while (m0_atomic64_get(&threads_quiesced) <   \
+				      m0_atomic64_get(&threads_running) - 1)  \
+					;                                     \
+			} else {                                              \
+				UT_THREAD_QUIESCE_IF_REQUESTED();             \
+				try_again = true;                             \
+			}                                                     \
+		} while (try_again);                                          \
+	} while (0)
 
-		/**
-		 * For single thread, keys_found_count should be equal to
-		 * keys_put_count. But for multi-thread, multiple threads can
-		 * put records, hence keys_found_count will be greater than
-		 * keys_put_count.
-		 */
-		M0_ASSERT(keys_found_count >= keys_put_count);
+/**
+ * Thread init function which will do basic setup such as setting CPU affinity
+ * and initializing the RND seed for the thread. Any other initialization that
+ * might be needed such as resource allocation/initialization for the thread
+ * handler function can also be done here.
+ */
+static int btree_ut_thread_init(struct btree_ut_thread_info *ti)
+{
+	int rc;
 
-		/**
-		 * Test for MIN and MAX keys.
-		 * Testing is difficult since multiple threads will be adding
-		 * or deleting keys from the btree at any time. To get around
-		 * this we first quiesce all the threads and then work with
-		 * the current btree to find out the MIN and the MAX values.
-		 * To confirm if the values are MIN and MAX we will iterate
-		 * the PREV and NEXT values for both MIN key and MAX key.
-		 * In case of MIN key the PREV iterator should FAIL but NEXT
-		 * iterator should succeed. Conversely for MAX key the PREV
-		 * iterator should succeed while the NEXT iterator should fail.
-		 */
-		UT_REQUEST_PEER_THREADS_TO_QUIESCE();
+	M0_ALLOC_ARR(ti->ti_rnd_state_ptr, 64);
+	if (ti->ti_rnd_state_ptr == NULL) {
+		return -ENOMEM;
+	}
 
-		/** Fill a value in the buffer which cannot be the MIN key */
-		ksize = ksize_random ?
-			GET_RANDOM_KEYSIZE(key, key_first, key_iter_start,
-					   ti->ti_key_incr) :
-			ti->ti_key_size;
-		kdata = ((key_last + 1) << (sizeof(ti->ti_thread_id) * 8)) +
-			ti->ti_thread_id;
-		kdata = m0_byteorder_cpu_to_be64(kdata);
-		FILL_KEY(get_key, ksize, kdata);
+	M0_SET0(&ti->ti_random_buf);
+	initstate_r(ti->ti_rng_seed_base, ti->ti_rnd_state_ptr, 64,
+		    &ti->ti_random_buf);
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_minkey(tree, &ut_get_cb,
-							      0, &kv_op));
-		M0_ASSERT(rc == 0);
+	srandom_r(ti->ti_thread_id + 1, &ti->ti_random_buf);
 
-		ksize = get_ksize;
-		for (i = 0; i < get_ksize / sizeof(get_key[0]); i++)
-			key[i] = get_key[i];
+	rc = m0_thread_confine(&ti->ti_q, &ti->ti_cpu_map);
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_iter(tree, &rec.r_key,
-							    &ut_get_cb,
-							    BOF_NEXT, &kv_op));
-		M0_ASSERT((rc == 0) ||
-			  (rc == -ENOENT && key_iter_start == key_last));
-		/**
-		 * The second condition in the above assert is rare but can
+	m0_bitmap_fini(&ti->ti_cpu_map);
+	return rc;
+}
+
+#define FILL_KEY(key, ksize, data)                                             \
+	do {                                                                   \
+		uint32_t i;                                                    \
+		key[0] = data;                                                 \
+		key[1] = m0_byteorder_cpu_to_be64(ksize);                      \
+		for (i = 2; i < (ksize / sizeof(key[0])); i++)                 \
+			key[i] = data;                                         \
+	} while (0);
+
+#define FILL_VALUE(value, vsize, data, crc)                                    \
+	do {                                                                   \
+		uint32_t i = 0;                                                \
+		if (crc == M0_BCT_NO_CRC) {                                    \
+			value[0] = data;                                       \
+			value[1] = m0_byteorder_cpu_to_be64(vsize);            \
+			for (i = 2; i < (vsize / sizeof(value[0])); i++)       \
+				value[i] = data;                               \
+		} else if (crc == M0_BCT_USER_ENC_RAW_HASH) {                  \
+			value[0] = data;                                       \
+			value[1] = m0_byteorder_cpu_to_be64(vsize);            \
+			for (i = 2; i < ((vsize / sizeof(value[0]) - 1)); i++) \
+				value[i] = data;                               \
+			value[i] = m0_hash_fnc_fnv1(value,                     \
+						    vsize - sizeof(value[0])); \
+		} else if (crc == M0_BCT_USER_ENC_FORMAT_FOOTER) {             \
+			struct m0_format_header *header;                       \
+			struct m0_format_footer *footer;                       \
+			struct m0_format_tag     tag = {                       \
+				.ot_version = 1,                               \
+				.ot_type = 2,                                  \
+				.ot_size = (vsize -                            \
+					    sizeof(struct m0_format_footer)),  \
+			};                                                     \
+                                                                               \
+			M0_CASSERT(sizeof(*header) % sizeof(value[0]) == 0);   \
+			M0_CASSERT(sizeof(*footer) % sizeof(value[0]) == 0);   \
+                                                                               \
+			header = (struct m0_format_header *)value;             \
+			m0_format_header_pack(header, &tag);                   \
+			for (i = (sizeof(*header)/sizeof(value[0]));           \
+			     i < ARRAY_SIZE(value) - (sizeof(*footer) /        \
+						      sizeof(value[0]));       \
+			     i++) {                                            \
+				value[i] = data;                               \
+			}                                                      \
+			m0_format_footer_update(value);                        \
+		} else if (crc == M0_BCT_BTREE_ENC_RAW_HASH) {                 \
+			value[0] = data;                                       \
+			value[1] = m0_byteorder_cpu_to_be64(vsize);            \
+			for (i = 2; i < (vsize / sizeof(value[0])); i++)       \
+				value[i] = data;                               \
+		}                                                              \
+	} while (0);
+
+#define GET_RANDOM_KEYSIZE(karray, kfirst, kiter_start, kincr)                 \
+	({                                                                     \
+		uint64_t random_size;                                          \
+		random_size = (((kfirst - kiter_start) / kincr) %              \
+			       (KEY_ARR_ELE_COUNT - 1)) + 2;                   \
+		random_size *= sizeof(karray[0]);                              \
+		random_size;                                                   \
+	})
+
+#define GET_RANDOM_VALSIZE(varray, kfirst, kiter_start, kincr, crc)            \
+	({                                                                     \
+		uint64_t random_size = 0;                                      \
+		if (crc == M0_BCT_NO_CRC || crc == M0_BCT_BTREE_ENC_RAW_HASH ) \
+			random_size = (((kfirst - kiter_start) / kincr) %      \
+					(VAL_ARR_ELE_COUNT - 1)) + 2;          \
+		else if (crc == M0_BCT_USER_ENC_RAW_HASH)                      \
+			random_size = (((kfirst - kiter_start) / kincr) %      \
+					(VAL_ARR_ELE_COUNT - 2)) + 3;          \
+		else if (crc == M0_BCT_USER_ENC_FORMAT_FOOTER)                 \
+			random_size = (((kfirst - kiter_start) / kincr) %      \
+					(VAL_ARR_ELE_COUNT - 4)) + 5;          \
+		random_size *= sizeof(varray[0]);                              \
+		random_size;                                                   \
+	})
+
+/**
+ * This routine is a thread handler which launches PUT, GET, ITER, SLANT and DEL
+ * operations on the btree passed as parameter.
+ */
+static void btree_ut_kv_oper_thread_handler(struct btree_ut_thread_info *ti)
+{
+	uint64_t                key[KEY_ARR_ELE_COUNT];
+	uint64_t                value[VAL_ARR_ELE_COUNT];
+	void                   *k_ptr         = &key;
+	void                   *v_ptr         = &value;
+	m0_bcount_t             ksize         = ti->ti_key_size;
+	m0_bcount_t             vsize         = ti->ti_value_size;
+	struct m0_btree_rec     rec;
+	struct m0_btree_cb      ut_cb;
+	struct ut_cb_data       data;
+
+	uint64_t                get_key[ARRAY_SIZE(key)];
+	uint64_t                get_value[ARRAY_SIZE(value)];
+	m0_bcount_t             get_ksize;
+	m0_bcount_t             get_vsize;
+	void                   *get_k_ptr     = &get_key;
+	void                   *get_v_ptr     = &get_value;
+	struct m0_btree_rec     get_rec;
+	struct m0_btree_cb      ut_get_cb;
+	struct ut_cb_data       get_data;
+
+	uint64_t                key_iter_start;
+	uint64_t                key_end;
+	struct m0_btree_op      kv_op        = {};
+	struct m0_btree        *tree;
+	bool                    ksize_random =
+					ti->ti_key_size == RANDOM_KEY_SIZE;
+	bool                    vsize_random =
+					ti->ti_value_size == RANDOM_VALUE_SIZE;
+	struct m0_be_tx         tx_data;
+	struct m0_be_tx        *tx           = &tx_data;
+	struct m0_be_tx_credit  put_cred     = {};
+	struct m0_be_tx_credit  update_cred  = {};
+	struct m0_be_tx_credit  del_cred     = {};
+	enum m0_btree_crc_type  crc          = ti->ti_crc_type;
+
+	/**
+	 *  Currently our thread routine only supports Keys and Values which are
+	 *  a multiple of 8 bytes.
+	 */
+	M0_ASSERT(ti->ti_key_size == RANDOM_KEY_SIZE ||
+		  (ti->ti_key_size % sizeof(uint64_t) == 0 &&
+		   ti->ti_key_size > sizeof(key[0]) &&
+		   ti->ti_key_size <= sizeof(key)));
+	M0_ASSERT(ti->ti_value_size == RANDOM_VALUE_SIZE ||
+		  (ti->ti_value_size % sizeof(uint64_t) == 0 &&
+		   ((crc == M0_BCT_USER_ENC_RAW_HASH &&
+		     ti->ti_value_size > sizeof(value[0]) * 2) ||
+		    (crc == M0_BCT_NO_CRC &&
+		     ti->ti_value_size > sizeof(value[0])) ||
+		    (crc == M0_BCT_BTREE_ENC_RAW_HASH &&
+		     ti->ti_value_size > sizeof(value[0]))) &&
+		   ti->ti_value_size <= sizeof(value)));
+
+	M0_CASSERT(KEY_ARR_ELE_COUNT > 1 && VAL_ARR_ELE_COUNT > 1);
+
+	key_iter_start = ti->ti_key_first;
+	key_end        = ti->ti_key_first +
+			 (ti->ti_key_count * ti->ti_key_incr) - ti->ti_key_incr;
+
+	rec.r_key.k_data   = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize);
+	rec.r_val          = M0_BUFVEC_INIT_BUF(&v_ptr, &vsize);
+
+	data.key           = &rec.r_key;
+	data.value         = &rec.r_val;
+
+	ut_cb.c_act        = ut_btree_kv_put_cb;
+	ut_cb.c_datum      = &data;
+
+	get_rec.r_key.k_data   = M0_BUFVEC_INIT_BUF(&get_k_ptr, &get_ksize);
+	get_rec.r_val          = M0_BUFVEC_INIT_BUF(&get_v_ptr, &get_vsize);
+
+	get_data.key            = &get_rec.r_key;
+	get_data.value          = &get_rec.r_val;
+	get_data.check_value    = true;
+	get_data.crc            = crc;
+	get_data.embedded_ksize = true;
+	get_data.embedded_vsize = true;
+
+	ut_get_cb.c_act        = ut_btree_kv_get_cb;
+	ut_get_cb.c_datum      = &get_data;
+
+	tree                   = ti->ti_tree;
+
+	/** Wait till all the threads have been initialised. */
+	UT_THREAD_WAIT();
+	m0_atomic64_inc(&threads_running);
+
+	put_cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_btree_put_credit(tree, 1, ksize, vsize, &put_cred);
+
+	update_cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_btree_update_credit(tree, 1, ksize, vsize, &update_cred);
+
+	del_cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_btree_del_credit(tree, 1, ksize, -1, &del_cred);
+
+	while (key_iter_start <= key_end) {
+		uint64_t  key_first;
+		uint64_t  key_last;
+		uint64_t  keys_put_count = 0;
+		uint64_t  keys_found_count = 0;
+		int       i;
+		int32_t   r;
+		uint64_t  iter_dir;
+		uint64_t  del_key;
+		int       rc;
+		uint64_t  kdata;
+
+		key_first = key_iter_start;
+		if (ti->ti_random_bursts) {
+			random_r(&ti->ti_random_buf, &r);
+			if (key_first == key_end)
+				key_last = key_end;
+			else
+				key_last = (r % (key_end - key_first)) +
+					   key_first;
+
+			key_last = (key_last / ti->ti_key_incr) *
+				   ti->ti_key_incr + ti->ti_key_first;
+		} else
+			key_last = key_end;
+
+		/** PUT keys and their corresponding values in the tree. */
+
+		ut_cb.c_act   = ut_btree_kv_put_cb;
+		ut_cb.c_datum = &data;
+
+		while (key_first <= key_last - ti->ti_key_incr) {
+			/**
+			 * for variable key/value size, the size will increment
+			 * in multiple of 8 after each iteration. The size will
+			 * wrap around on reaching MAX_KEY_SIZE. To make sure
+			 * there is atleast one key and size, arr_size is
+			 * incremented by 1.
+			 */
+			ksize = ksize_random ?
+				GET_RANDOM_KEYSIZE(key, key_first,
+						   key_iter_start,
+						   ti->ti_key_incr):
+				ti->ti_key_size;
+			vsize = vsize_random ?
+				GET_RANDOM_VALSIZE(value, key_first,
+						   key_iter_start,
+						   ti->ti_key_incr, crc) :
+				ti->ti_value_size;
+			/**
+			 *  Embed the thread-id in LSB so that different threads
+			 *  will target the same node thus causing race
+			 *  conditions useful to mimic and test btree operations
+			 *  in a loaded system.
+			 */
+			kdata = (key_first << (sizeof(ti->ti_thread_id) * 8)) +
+				ti->ti_thread_id;
+			kdata = m0_byteorder_cpu_to_be64(kdata);
+
+			FILL_KEY(key, ksize, kdata);
+			FILL_VALUE(value, vsize, kdata, crc);
+
+			m0_be_ut_tx_init(tx, ut_be);
+			m0_be_tx_prep(tx, &put_cred);
+			rc = m0_be_tx_open_sync(tx);
+			M0_ASSERT(rc == 0);
+
+			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+						      m0_btree_put(tree, &rec,
+								   &ut_cb,
+								   &kv_op, tx));
+			M0_ASSERT(rc == 0 && data.flags == M0_BSC_SUCCESS);
+			m0_be_tx_close_sync(tx);
+			m0_be_tx_fini(tx);
+
+			keys_put_count++;
+			key_first += ti->ti_key_incr;
+
+			UT_THREAD_QUIESCE_IF_REQUESTED();
+		}
+
+		/** Verify btree_update with BOF_INSERT_IF_NOT_FOUND flag.
+		 * 1. call update operation for non-existing record, which
+		 *    should return -ENOENT.
+		 * 2. call update operation for non-existing record with,
+		 *    BOF_INSERT_IF_NOT_FOUND flag which should insert record
+		 *    and return success.
+		 */
+		ut_cb.c_datum = &data;
+
+		ksize = ksize_random ?
+			GET_RANDOM_KEYSIZE(key, key_first, key_iter_start,
+					   ti->ti_key_incr):
+			ti->ti_key_size;
+		vsize = vsize_random ?
+			GET_RANDOM_VALSIZE(value, key_first, key_iter_start,
+					   ti->ti_key_incr, crc) :
+			ti->ti_value_size;
+
+		kdata = (key_first << (sizeof(ti->ti_thread_id) * 8)) +
+			ti->ti_thread_id;
+		kdata = m0_byteorder_cpu_to_be64(kdata);
+
+		FILL_KEY(key, ksize, kdata);
+		FILL_VALUE(value, vsize, kdata, crc);
+
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &put_cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
+
+		ut_cb.c_act = ut_btree_kv_update_cb;
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_update(tree, &rec,
+							      &ut_cb, 0,
+							      &kv_op, tx));
+		M0_ASSERT(rc == M0_ERR(-ENOENT));
+
+		ut_cb.c_act = ut_btree_kv_put_cb;
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					m0_btree_update(tree, &rec,
+							&ut_cb,
+							BOF_INSERT_IF_NOT_FOUND,
+							&kv_op, tx));
+
+		M0_ASSERT(rc == 0 && data.flags == M0_BSC_SUCCESS);
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+
+		keys_put_count++;
+		key_first += ti->ti_key_incr;
+
+		/** Verify btree_update for value size increase/decrease. */
+
+		key_first     = key_iter_start;
+		ut_cb.c_act   = ut_btree_kv_update_cb;
+		ut_cb.c_datum = &data;
+		while (vsize_random && key_first <= key_last) {
+			vsize = GET_RANDOM_VALSIZE(value, key_first,
+						   key_iter_start,
+						   ti->ti_key_incr, crc);
+			/**
+			 * Skip updating value size for max val size as
+			 * it can create array outbound for val[]
+			 */
+			if (vsize >= (VAL_ARR_ELE_COUNT * sizeof(value[0]))) {
+				key_first += (ti->ti_key_incr * 5);
+				continue;
+			}
+			/** Test value size increase case. */
+			vsize += sizeof(value[0]);
+			ksize = ksize_random ?
+				GET_RANDOM_KEYSIZE(key, key_first,
+						    key_iter_start,
+						    ti->ti_key_incr):
+				ti->ti_key_size;
+
+			kdata = (key_first << (sizeof(ti->ti_thread_id) * 8)) +
+				 ti->ti_thread_id;
+			kdata = m0_byteorder_cpu_to_be64(kdata);
+
+			FILL_KEY(key, ksize, kdata);
+			FILL_VALUE(value, vsize, kdata, crc);
+
+			m0_be_ut_tx_init(tx, ut_be);
+			m0_be_tx_prep(tx, &update_cred);
+			rc = m0_be_tx_open_sync(tx);
+			M0_ASSERT(rc == 0);
+
+			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+						      m0_btree_update(tree,
+								      &rec,
+								      &ut_cb, 0,
+								      &kv_op,
+								      tx));
+			M0_ASSERT(rc == 0 && data.flags == M0_BSC_SUCCESS);
+
+			m0_be_tx_close_sync(tx);
+			m0_be_tx_fini(tx);
+
+			/** Test value size decrease case. */
+			vsize -= sizeof(value[0]);
+			FILL_VALUE(value, vsize, kdata, crc);
+
+			m0_be_ut_tx_init(tx, ut_be);
+			m0_be_tx_prep(tx, &update_cred);
+			rc = m0_be_tx_open_sync(tx);
+			M0_ASSERT(rc == 0);
+
+			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+						      m0_btree_update(tree,
+								      &rec,
+								      &ut_cb, 0,
+								      &kv_op,
+								      tx));
+			M0_ASSERT(rc == 0 && data.flags == M0_BSC_SUCCESS);
+
+			m0_be_tx_close_sync(tx);
+			m0_be_tx_fini(tx);
+
+			key_first += (ti->ti_key_incr * 5);
+		}
+
+		/**
+		 * Execute one error case where we PUT a key which already
+		 * exists in the btree.
+		 */
+		key_first = key_iter_start;
+		if ((key_last - key_first) > (ti->ti_key_incr * 2))
+			key_first += ti->ti_key_incr;
+
+		ksize = ksize_random ?
+			GET_RANDOM_KEYSIZE(key, key_first, key_iter_start,
+					   ti->ti_key_incr):
+			ti->ti_key_size;
+
+		kdata = (key_first << (sizeof(ti->ti_thread_id) * 8)) +
+			ti->ti_thread_id;
+		kdata = m0_byteorder_cpu_to_be64(kdata);
+
+		FILL_KEY(key, ksize, kdata);
+
+		/** Skip initializing the value as this is an error case */
+
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &put_cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_put(tree, &rec, &ut_cb,
+							   &kv_op, tx));
+		M0_ASSERT(rc == M0_ERR(-EEXIST));
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+
+		/** Modify 20% of the values which have been inserted. */
+
+		key_first     = key_iter_start;
+		ut_cb.c_act   = ut_btree_kv_update_cb;
+		ut_cb.c_datum = &data;
+
+		while (key_first <= key_last) {
+			/**
+			 *  Embed the thread-id in LSB so that different threads
+			 *  will target the same node thus causing race
+			 *  conditions useful to mimic and test btree operations
+			 *  in a loaded system.
+			 */
+			ksize = ksize_random ?
+				GET_RANDOM_KEYSIZE(key, key_first,
+						   key_iter_start,
+						   ti->ti_key_incr):
+				ti->ti_key_size;
+			vsize = vsize_random ?
+				GET_RANDOM_VALSIZE(value, key_first,
+						   key_iter_start,
+						   ti->ti_key_incr, crc) :
+				ti->ti_value_size;
+
+			kdata = (key_first << (sizeof(ti->ti_thread_id) * 8)) +
+				 ti->ti_thread_id;
+			kdata = m0_byteorder_cpu_to_be64(kdata);
+
+			FILL_KEY(key, ksize, kdata);
+			kdata = ~kdata;
+			FILL_VALUE(value, vsize, kdata, crc);
+
+			m0_be_ut_tx_init(tx, ut_be);
+			m0_be_tx_prep(tx, &update_cred);
+			rc = m0_be_tx_open_sync(tx);
+			M0_ASSERT(rc == 0);
+
+			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+						      m0_btree_update(tree,
+								      &rec,
+								      &ut_cb, 0,
+								      &kv_op,
+								      tx));
+			M0_ASSERT(rc == 0 && data.flags == M0_BSC_SUCCESS);
+			m0_be_tx_close_sync(tx);
+			m0_be_tx_fini(tx);
+
+			key_first += (ti->ti_key_incr * 5);
+		}
+
+		/**
+		 * Execute one error case where we UPDATE a key that does not
+		 * exist in the btree.
+		 */
+		key_first = key_iter_start;
+		ksize = ksize_random ?
+			GET_RANDOM_KEYSIZE(key, key_first, key_iter_start,
+					   ti->ti_key_incr) :
+			ti->ti_key_size;
+
+		kdata = (key_first << (sizeof(ti->ti_thread_id) * 8)) +
+			 (typeof(ti->ti_thread_id))-1;
+		kdata = m0_byteorder_cpu_to_be64(kdata);
+		FILL_KEY(key, ksize, kdata);
+
+		/** Skip initializing the value as this is an error case */
+
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &update_cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_update(tree, &rec,
+							      &ut_cb, 0,
+							      &kv_op, tx));
+		M0_ASSERT(rc == M0_ERR(-ENOENT));
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+
+		/** GET and ITERATE over the keys which we inserted above. */
+
+		/**  Randomly decide the iteration direction. */
+		random_r(&ti->ti_random_buf, &r);
+
+		key_first = key_iter_start;
+		if (r % 2) {
+			/** Iterate forward. */
+			iter_dir = BOF_NEXT;
+			ksize = ksize_random ?
+				GET_RANDOM_KEYSIZE(key, key_first,
+						   key_iter_start,
+						   ti->ti_key_incr) :
+				ti->ti_key_size;
+
+			kdata = (key_first <<
+				  (sizeof(ti->ti_thread_id) * 8)) +
+				 ti->ti_thread_id;
+			kdata = m0_byteorder_cpu_to_be64(kdata);
+			FILL_KEY(key, ksize, kdata);
+		} else {
+			/** Iterate backward. */
+			iter_dir = BOF_PREV;
+			ksize = ksize_random ?
+				GET_RANDOM_KEYSIZE(key, key_last,
+						   key_iter_start,
+						   ti->ti_key_incr) :
+				ti->ti_key_size;
+
+			kdata = (key_last <<
+				  (sizeof(ti->ti_thread_id) * 8)) +
+				 ti->ti_thread_id;
+			kdata = m0_byteorder_cpu_to_be64(kdata);
+			FILL_KEY(key, ksize, kdata);
+		}
+		get_ksize = ksize;
+		get_vsize = ti->ti_value_size;
+		get_data.check_value = true; /** Compare value with key */
+		get_data.crc         = crc;
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_get(tree, &rec.r_key,
+							   &ut_get_cb,
+							   BOF_EQUAL, &kv_op));
+		M0_ASSERT(rc == 0);
+
+		keys_found_count++;
+
+		while (1) {
+			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+						      m0_btree_iter(tree,
+								    &rec.r_key,
+								    &ut_get_cb,
+								    iter_dir,
+								    &kv_op));
+			if (rc == -ENOENT)
+				break;
+
+			keys_found_count++;
+
+			/** Copy over the gotten key for the next search. */
+			ksize = get_ksize;
+			for (i = 0; i < ksize / sizeof(get_key[0]); i++) {
+				key[i] = get_key[i];
+			}
+
+			UT_THREAD_QUIESCE_IF_REQUESTED();
+		}
+
+		/**
+		 * For single thread, keys_found_count should be equal to
+		 * keys_put_count. But for multi-thread, multiple threads can
+		 * put records, hence keys_found_count will be greater than
+		 * keys_put_count.
+		 */
+		M0_ASSERT(keys_found_count >= keys_put_count);
+
+		/**
+		 * Test for MIN and MAX keys.
+		 * Testing is difficult since multiple threads will be adding
+		 * or deleting keys from the btree at any time. To get around
+		 * this we first quiesce all the threads and then work with
+		 * the current btree to find out the MIN and the MAX values.
+		 * To confirm if the values are MIN and MAX we will iterate
+		 * the PREV and NEXT values for both MIN key and MAX key.
+		 * In case of MIN key the PREV iterator should FAIL but NEXT
+		 * iterator should succeed. Conversely for MAX key the PREV
+		 * iterator should succeed while the NEXT iterator should fail.
+		 */
+		UT_REQUEST_PEER_THREADS_TO_QUIESCE();
+
+		/** Fill a value in the buffer which cannot be the MIN key */
+		ksize = ksize_random ?
+			GET_RANDOM_KEYSIZE(key, key_first, key_iter_start,
+					   ti->ti_key_incr) :
+			ti->ti_key_size;
+		kdata = ((key_last + 1) << (sizeof(ti->ti_thread_id) * 8)) +
+			ti->ti_thread_id;
+		kdata = m0_byteorder_cpu_to_be64(kdata);
+		FILL_KEY(get_key, ksize, kdata);
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_minkey(tree, &ut_get_cb,
+							      0, &kv_op));
+		M0_ASSERT(rc == 0);
+
+		ksize = get_ksize;
+		for (i = 0; i < get_ksize / sizeof(get_key[0]); i++)
+			key[i] = get_key[i];
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_iter(tree, &rec.r_key,
+							    &ut_get_cb,
+							    BOF_NEXT, &kv_op));
+		M0_ASSERT((rc == 0) ||
+			  (rc == -ENOENT && key_iter_start == key_last));
+		/**
+		 * The second condition in the above assert is rare but can
 		 * happen if only one Key is present in the btree. We presume
 		 * that no Keys from other other threads are currently present
 		 * in the btree and also the current thread  added just one
 		 * key in this iteration.
 		 */
 
-		for (i = 0; i < ksize / sizeof(key[1]); i++)
-			get_key[i] = key[i];
+		for (i = 0; i < ksize / sizeof(key[1]); i++)
+			get_key[i] = key[i];
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_iter(tree, &rec.r_key,
+							    &ut_get_cb,
+							    BOF_PREV, &kv_op));
+		M0_ASSERT(rc == -ENOENT);
+
+		kdata = ((key_iter_start - 1) <<
+			 (sizeof(ti->ti_thread_id) * 8)) + ti->ti_thread_id;
+		kdata = m0_byteorder_cpu_to_be64(kdata);
+		FILL_KEY(get_key, ksize, kdata);
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_maxkey(tree, &ut_get_cb,
+							      0, &kv_op));
+		M0_ASSERT(rc == 0);
+
+		ksize = get_ksize;
+		for (i = 0; i < get_ksize / sizeof(get_key[0]); i++)
+			key[i] = get_key[i];
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_iter(tree, &rec.r_key,
+							    &ut_get_cb,
+							    BOF_PREV, &kv_op));
+		M0_ASSERT((rc == 0) ||
+			  (rc == -ENOENT && key_iter_start == key_last));
+
+		for (i = 0; i < ARRAY_SIZE(key); i += sizeof(key[0]))
+			get_key[i] = key[i];
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_iter(tree, &rec.r_key,
+							    &ut_get_cb,
+							    BOF_NEXT, &kv_op));
+		M0_ASSERT(rc == -ENOENT);
+
+		UT_START_THREADS();
+
+		/**
+		 *  Test slant only if possible. If the increment counter is
+		 *  more than 1 we can provide the intermediate value to be got
+		 *  in slant mode.
+		 */
+
+		if (ti->ti_key_incr > 1) {
+			uint64_t            slant_key;
+			uint64_t            got_key;
+			struct m0_btree_rec r;
+			struct m0_btree_cb  cb;
+
+			M0_ASSERT(key_first >= 1);
+
+			slant_key = key_first;
+			get_data.check_value = false;
+			get_data.crc         = crc;
+
+			/**
+			 *  The following short named variables are used just
+			 *  to maintain the code decorum by limiting code lines
+			 *  within 80 chars..
+			 */
+			r = rec;
+			cb = ut_get_cb;
+
+			do {
+				ksize = ksize_random ?
+					GET_RANDOM_KEYSIZE(key, slant_key,
+							   key_iter_start,
+							   ti->ti_key_incr) :
+					ti->ti_key_size;
+
+				/**
+				 *  Alternate between using the exact number as
+				 *  Key for slant and a previous number as Key
+				 *  for slant to test for both scenarios.
+				 */
+				kdata = (slant_key % 2) ? slant_key - 1 :
+							   slant_key;
+				kdata = (kdata <<
+					  (sizeof(ti->ti_thread_id) * 8)) +
+					 ti->ti_thread_id;
+				kdata = m0_byteorder_cpu_to_be64(kdata);
+				FILL_KEY(key, ksize, kdata);
+
+				M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+							 m0_btree_get(tree,
+								      &r.r_key,
+								      &cb,
+								      BOF_SLANT,
+								      &kv_op));
+
+				/**
+				 *  If multiple threads are running then slant
+				 *  could return us the value which was added
+				 *  by a different thread. We anyways make sure
+				 *  that the got value (without the embedded
+				 *  thread ID) is more than the slant value.
+				 */
+				got_key = m0_byteorder_cpu_to_be64(get_key[0]);
+				got_key >>= (sizeof(ti->ti_thread_id) * 8);
+				M0_ASSERT(got_key == slant_key);
+
+				slant_key += ti->ti_key_incr;
+
+				UT_THREAD_QUIESCE_IF_REQUESTED();
+			} while (slant_key <= key_last);
+		}
+
+		/**
+		 *  DEL the keys which we had created in this iteration. The
+		 *  direction of traversing the delete keys is randomly
+		 *  selected.
+		 */
+		random_r(&ti->ti_random_buf, &r);
+
+		key_first = key_iter_start;
+		del_key = (r % 2 == 0) ? key_first : key_last;
+
+		ut_cb.c_act   = ut_btree_kv_del_cb;
+		ut_cb.c_datum = &data;
+		while (keys_put_count) {
+			ksize = ksize_random ?
+				GET_RANDOM_KEYSIZE(key, del_key, key_iter_start,
+						   ti->ti_key_incr) :
+				ti->ti_key_size;
+
+			kdata = (del_key << (sizeof(ti->ti_thread_id) * 8)) +
+				 ti->ti_thread_id;
+			kdata = m0_byteorder_cpu_to_be64(kdata);
+			FILL_KEY(key, ksize, kdata);
+
+			m0_be_ut_tx_init(tx, ut_be);
+			m0_be_tx_prep(tx, &del_cred);
+			rc = m0_be_tx_open_sync(tx);
+			M0_ASSERT(rc == 0);
+
+			M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+						 m0_btree_del(tree, &rec.r_key,
+							      &ut_cb,
+							      &kv_op, tx));
+			M0_ASSERT(rc == 0 && data.flags == M0_BSC_SUCCESS);
+			m0_be_tx_close_sync(tx);
+			m0_be_tx_fini(tx);
+
+			del_key = (r % 2 == 0) ? del_key + ti->ti_key_incr :
+						 del_key - ti->ti_key_incr;
+			keys_put_count--;
+
+			UT_THREAD_QUIESCE_IF_REQUESTED();
+		}
+
+		/**
+		 *  Verify deleted Keys are not 'visible'.
+		 *  We try to read the first key and last key added in this
+		 *  iteration from the btree and make sure ENOENT error is
+		 *  returned for each of the Keys.
+		 */
+		key_first = key_iter_start;
+
+		ksize = ksize_random ?
+			GET_RANDOM_KEYSIZE(key, key_first, key_iter_start,
+					   ti->ti_key_incr) :
+			ti->ti_key_size;
+
+		kdata = (key_first << (sizeof(ti->ti_thread_id) * 8)) +
+			ti->ti_thread_id;
+		kdata = m0_byteorder_cpu_to_be64(kdata);
+		FILL_KEY(key, ksize, kdata);
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_get(tree,
+							   &rec.r_key,
+							   &ut_get_cb,
+							   BOF_EQUAL, &kv_op));
+		M0_ASSERT(rc == -ENOENT);
+
+		if (key_first != key_last) {
+			ksize = ksize_random ?
+				GET_RANDOM_KEYSIZE(key, key_last,
+						   key_iter_start,
+						   ti->ti_key_incr) :
+				ti->ti_key_size;
+
+			kdata = (key_last << (sizeof(ti->ti_thread_id) * 8)) +
+				ti->ti_thread_id;
+			kdata = m0_byteorder_cpu_to_be64(kdata);
+			FILL_KEY(key, ksize, kdata);
+
+			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+						      m0_btree_get(tree,
+								   &rec.r_key,
+								   &ut_get_cb,
+								   BOF_EQUAL,
+								   &kv_op));
+			M0_ASSERT(rc == -ENOENT);
+		}
+
+		/**
+		 *  Try to delete the first key and last key added in this
+		 *  iteration from the btree and make sure ENOENT error is
+		 *  returned for each of the Keys.
+		 */
+		key_first = key_iter_start;
+
+		ksize = ksize_random ?
+			GET_RANDOM_KEYSIZE(key, key_first, key_iter_start,
+					   ti->ti_key_incr) :
+			ti->ti_key_size;
+
+		kdata = (key_first << (sizeof(ti->ti_thread_id) * 8)) +
+			 ti->ti_thread_id;
+		kdata = m0_byteorder_cpu_to_be64(kdata);
+		FILL_KEY(key, ksize, kdata);
+
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &del_cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_del(tree, &rec.r_key,
+							   &ut_cb, &kv_op,
+							   tx));
+		M0_ASSERT(rc == -ENOENT);
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+
+		if (key_first != key_last) {
+			ksize = ksize_random ?
+				GET_RANDOM_KEYSIZE(key, key_last,
+						   key_iter_start,
+						   ti->ti_key_incr) :
+				ti->ti_key_size;
+
+			kdata = (key_last << (sizeof(ti->ti_thread_id) * 8)) +
+				ti->ti_thread_id;
+			kdata = m0_byteorder_cpu_to_be64(kdata);
+			FILL_KEY(key, ksize, kdata);
+
+			m0_be_ut_tx_init(tx, ut_be);
+			m0_be_tx_prep(tx, &del_cred);
+			rc = m0_be_tx_open_sync(tx);
+			M0_ASSERT(rc == 0);
+
+			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+						      m0_btree_del(tree,
+								   &rec.r_key,
+								   &ut_cb,
+								   &kv_op, tx));
+			M0_ASSERT(rc == -ENOENT);
+			m0_be_tx_close_sync(tx);
+			m0_be_tx_fini(tx);
+		}
+
+		key_iter_start = key_last + ti->ti_key_incr;
+
+		UT_THREAD_QUIESCE_IF_REQUESTED();
+	}
+
+	m0_atomic64_dec(&threads_running);
+	/** Free resources. */
+	m0_free(ti->ti_rnd_state_ptr);
+
+	m0_be_ut_backend_thread_exit(ut_be);
+}
+
+/**
+ * This function allocates an array pointed by cpuid_ptr and fills it with the
+ * CPU ID of the CPUs which are currently online.
+ */
+static void online_cpu_id_get(uint16_t **cpuid_ptr, uint16_t *cpu_count)
+{
+	size_t           cpu_max;
+	uint32_t         cpuid;
+	struct m0_bitmap map_cpu_online  = {};
+	int              rc;
+
+	*cpu_count = 0;
+	cpu_max = m0_processor_nr_max();
+	rc = m0_bitmap_init(&map_cpu_online, cpu_max);
+	if (rc != 0)
+		return;
+
+	m0_processors_online(&map_cpu_online);
+
+	for (cpuid = 0; cpuid < map_cpu_online.b_nr; cpuid++) {
+		if (m0_bitmap_get(&map_cpu_online, cpuid)) {
+			(*cpu_count)++;
+		}
+	}
+
+	if (*cpu_count) {
+		M0_ALLOC_ARR(*cpuid_ptr, *cpu_count);
+		M0_ASSERT(*cpuid_ptr != NULL);
+
+		*cpu_count = 0;
+		for (cpuid = 0; cpuid < map_cpu_online.b_nr; cpuid++) {
+			if (m0_bitmap_get(&map_cpu_online, cpuid)) {
+				(*cpuid_ptr)[*cpu_count] = cpuid;
+				(*cpu_count)++;
+			}
+		}
+	}
+
+	m0_bitmap_fini(&map_cpu_online);
+}
+
+static void btree_ut_kv_size_get(enum btree_node_type bnt, int *ksize,
+				 int *vsize)
+{
+	uint32_t ksize_to_use = 2 * sizeof(uint64_t);
+
+	ksize_to_use += sizeof(uint64_t); /** To accomodate size within the Key. */
+
+	switch (bnt) {
+	case BNT_FIXED_FORMAT:
+		*ksize = ksize_to_use;
+		*vsize = ksize_to_use;
+		break;
+	case BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE:
+		*ksize = ksize_to_use;
+		*vsize = RANDOM_VALUE_SIZE;
+		break;
+	case BNT_VARIABLE_KEYSIZE_FIXED_VALUESIZE:
+		*ksize = RANDOM_KEY_SIZE;
+		*vsize = ksize_to_use;
+		break;
+	case BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE:
+	case BNT_PREFIX_KEYSIZE_VARIABLE_VALUESIZE:
+		*ksize = RANDOM_KEY_SIZE;
+		*vsize = RANDOM_VALUE_SIZE;
+		break;
+	}
+}
+
+/**
+ * This test launches multiple threads which launch KV operations against one
+ * btree in parallel. If thread_count is passed as '0' then one thread per core
+ * is launched. If tree_count is passed as '0' then one tree per thread is
+ * created.
+ */
+static void btree_ut_kv_oper(int32_t thread_count, int32_t tree_count,
+			     enum btree_node_type bnt)
+{
+	int                           rc;
+	struct btree_ut_thread_info  *ti;
+	int                           i;
+	struct m0_btree             **ut_trees;
+	uint16_t                      cpu;
+	void                         *rnode;
+	struct m0_btree_op            b_op         = {};
+	int                           ksize = 0;
+	int                           vsize = 0;
+	struct m0_btree_type          btree_type;
+	struct m0_be_tx_credit        cred;
+	struct m0_be_tx               tx_data      = {};
+	struct m0_be_tx              *tx           = &tx_data;
+	struct m0_fid                 fid          = M0_FID_TINIT('b', 0, 1);
+	struct m0_buf                 buf;
+	uint16_t                     *cpuid_ptr;
+	uint16_t                      cpu_count;
+	size_t                        cpu_max;
+	time_t                        curr_time;
+	uint32_t                      rnode_sz        = m0_pagesize_get();
+	uint32_t                      rnode_sz_shift;
+
+	M0_ENTRY();
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_iter(tree, &rec.r_key,
-							    &ut_get_cb,
-							    BOF_PREV, &kv_op));
-		M0_ASSERT(rc == -ENOENT);
+	btree_ut_kv_size_get(bnt, &ksize, &vsize);
+	btree_type.tt_id = M0_BT_UT_KV_OPS;
+	btree_type.ksize = ksize;
+	btree_type.vsize = vsize;
+	btree_type.tt_flags = bnt == BNT_PREFIX_KEYSIZE_VARIABLE_VALUESIZE ?
+			      M0_BTF_PREFIX_KEYS : 0;
 
-		kdata = ((key_iter_start - 1) <<
-			 (sizeof(ti->ti_thread_id) * 8)) + ti->ti_thread_id;
-		kdata = m0_byteorder_cpu_to_be64(kdata);
-		FILL_KEY(get_key, ksize, kdata);
+	time(&curr_time);
+	M0_LOG(M0_INFO, "Using seed %lu", curr_time);
+	srandom(curr_time);
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_maxkey(tree, &ut_get_cb,
-							      0, &kv_op));
+	/**
+	 *  1) Create btree(s) to be used by all the threads.
+	 *  2) Assign CPU cores to the threads.
+	 *  3) Init and Start the threads which do KV operations.
+	 *  4) Wait till all the threads are done.
+	 *  5) Close the btree
+	 *  6) Destroy the btree
+	 */
+
+	btree_ut_init();
+
+	online_cpu_id_get(&cpuid_ptr, &cpu_count);
+
+	if (thread_count == 0)
+		thread_count = cpu_count - 1; /** Skip Core-0 */
+	else if (thread_count == RANDOM_THREAD_COUNT) {
+		thread_count = 1;
+		if (cpu_count > 2) {
+			/**
+			 *  Avoid the extreme cases i.e. thread_count
+			 *  cannot be 1 or cpu_count - 1
+			 */
+			thread_count = (random() % (cpu_count - 2)) + 1;
+		}
+	}
+
+	if (tree_count == 0)
+		tree_count = thread_count;
+	else if (tree_count == RANDOM_TREE_COUNT) {
+		tree_count = 1;
+		if (thread_count > 2) {
+			/**
+			 *  Avoid the extreme cases i.e. tree_count
+			 *  cannot be 1 or thread_count
+			 */
+			tree_count = (random() % (thread_count - 1)) + 1;
+		}
+	}
+
+	M0_ASSERT(thread_count >= tree_count);
+
+	UT_STOP_THREADS();
+	m0_atomic64_set(&threads_running, 0);
+	m0_atomic64_set(&threads_quiesced, 0);
+
+	M0_ALLOC_ARR(ut_trees, tree_count);
+	M0_ASSERT(ut_trees != NULL);
+	struct m0_btree btree[tree_count];
+
+	/**
+	 *  Add credits count needed for allocating node space and creating node
+	 *  layout on it.
+	 */
+	M0_ASSERT(rnode_sz != 0 && m0_is_po2(rnode_sz));
+	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_create_credit(&btree_type, &cred, 1);
+	for (i = 0; i < tree_count; i++) {
+		M0_SET0(&b_op);
+
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &cred);
+		rc = m0_be_tx_open_sync(tx);
 		M0_ASSERT(rc == 0);
 
-		ksize = get_ksize;
-		for (i = 0; i < get_ksize / sizeof(get_key[0]); i++)
-			key[i] = get_key[i];
+		/** Create temp node space and use it as root node for btree */
+		buf = M0_BUF_INIT(rnode_sz, NULL);
+		M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+		rnode = buf.b_addr;
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_iter(tree, &rec.r_key,
-							    &ut_get_cb,
-							    BOF_PREV, &kv_op));
-		M0_ASSERT((rc == 0) ||
-			  (rc == -ENOENT && key_iter_start == key_last));
+		M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+					 m0_btree_create(rnode, rnode_sz,
+							 &btree_type,
+							 M0_BCT_NO_CRC, &b_op,
+							 &btree[i], seg, &fid,
+							 tx, NULL));
+		M0_ASSERT(rc == M0_BSC_SUCCESS);
 
-		for (i = 0; i < ARRAY_SIZE(key); i += sizeof(key[0]))
-			get_key[i] = key[i];
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+		ut_trees[i] = b_op.bo_arbor;
+	}
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_iter(tree, &rec.r_key,
-							    &ut_get_cb,
-							    BOF_NEXT, &kv_op));
-		M0_ASSERT(rc == -ENOENT);
+	M0_ALLOC_ARR(ti, thread_count);
+	M0_ASSERT(ti != NULL);
 
-		UT_START_THREADS();
+	cpu_max = m0_processor_nr_max();
 
-		/**
-		 *  Test slant only if possible. If the increment counter is
-		 *  more than 1 we can provide the intermediate value to be got
-		 *  in slant mode.
-		 */
+	cpu = 1; /** We skip Core-0 for Linux kernel and other processes. */
+	for (i = 0; i < thread_count; i++) {
+		rc = m0_bitmap_init(&ti[i].ti_cpu_map, cpu_max);
+		m0_bitmap_set(&ti[i].ti_cpu_map, cpuid_ptr[cpu], true);
+		cpu++;
+		if (cpu >= cpu_count)
+			/**
+			 *  Circle around if thread count is higher than the
+			 *  CPU cores in the system.
+			 */
+			cpu = 1;
 
-		if (ti->ti_key_incr > 1) {
-			uint64_t            slant_key;
-			uint64_t            got_key;
-			struct m0_btree_rec r;
-			struct m0_btree_cb  cb;
+		ti[i].ti_key_first  = 1;
+		ti[i].ti_key_count  = MAX_RECS_PER_THREAD;
+		ti[i].ti_key_incr   = 5;
+		ti[i].ti_thread_id  = i;
+		ti[i].ti_tree       = ut_trees[i % tree_count];
+		ti[i].ti_key_size   = btree_type.ksize;
+		ti[i].ti_value_size = btree_type.vsize;
+		ti[i].ti_random_bursts = (thread_count > 1);
+		do {
+			ti[i].ti_rng_seed_base = random();
+		} while (ti[i].ti_rng_seed_base == 0);
+	}
 
-			M0_ASSERT(key_first >= 1);
+	for (i = 0; i < thread_count; i++) {
+		rc = M0_THREAD_INIT(&ti[i].ti_q, struct btree_ut_thread_info *,
+				    btree_ut_thread_init,
+				    &btree_ut_kv_oper_thread_handler, &ti[i],
+				    "Thread-%d", i);
+		M0_ASSERT(rc == 0);
+	}
 
-			slant_key = key_first;
-			get_data.check_value = false;
-			get_data.crc         = crc;
+	/** Initialized all the threads by now. Let's get rolling ... */
+	UT_START_THREADS();
+
+	for (i = 0; i < thread_count;i++) {
+		m0_thread_join(&ti[i].ti_q);
+		m0_thread_fini(&ti[i].ti_q);
+	}
+
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_destroy_credit(ut_trees[0], NULL, &cred, 1);
+	for (i = 0; i < tree_count; i++) {
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
+
+		rnode = segaddr_addr(&ut_trees[i]->t_desc->t_root->n_addr);
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+					      m0_btree_destroy(ut_trees[i],
+							       &b_op, tx));
+		M0_ASSERT(rc == 0);
+		M0_SET0(&btree[i]);
+		buf = M0_BUF_INIT(rnode_sz, rnode);
+		M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+	}
+
+	m0_free0(&cpuid_ptr);
+	m0_free(ut_trees);
+	m0_free(ti);
+	btree_ut_fini();
+
+	M0_LEAVE();
+}
+
+static void ut_st_st_kv_oper(void)
+{
+	int i;
+	for (i = 1; i <= BNT_PREFIX_KEYSIZE_VARIABLE_VALUESIZE; i++)
+	{
+		if (btree_node_format[i] != NULL)
+			btree_ut_kv_oper(1, 1, i);
+	}
+}
+
+static void ut_mt_st_kv_oper(void)
+{
+	int i;
+	for (i = 1; i <= BNT_PREFIX_KEYSIZE_VARIABLE_VALUESIZE; i++)
+	{
+		if (btree_node_format[i] != NULL)
+			btree_ut_kv_oper(0, 1, i);
+	}
+}
+
+static void ut_mt_mt_kv_oper(void)
+{
+	int i;
+	for (i = 1; i <= BNT_PREFIX_KEYSIZE_VARIABLE_VALUESIZE; i++)
+	{
+		if (btree_node_format[i] != NULL)
+			btree_ut_kv_oper(0, 0, i);
+	}
+}
+
+static void ut_rt_rt_kv_oper(void)
+{
+	int i;
+	for (i = 1; i <= BNT_PREFIX_KEYSIZE_VARIABLE_VALUESIZE; i++)
+	{
+		if (btree_node_format[i] != NULL)
+			btree_ut_kv_oper(RANDOM_THREAD_COUNT, RANDOM_TREE_COUNT,
+					 i);
+	}
+}
+
+/**
+ * This routine is a thread handler primarily involved in creating, opening,
+ * closing and destroying btree. To run out-of-sync with other threads it also
+ * launches PUT, GET, ITER and DEL operations on the btree for a random count.
+ */
+static void btree_ut_tree_oper_thread_handler(struct btree_ut_thread_info *ti)
+{
+	uint64_t               key;
+	uint64_t               value;
+	m0_bcount_t            ksize = sizeof key;
+	m0_bcount_t            vsize = sizeof value;
+	void                  *k_ptr = &key;
+	void                  *v_ptr = &value;
+	struct m0_btree_rec    rec   = {
+				     .r_key.k_data = M0_BUFVEC_INIT_BUF(&k_ptr,
+									&ksize),
+				     .r_val        = M0_BUFVEC_INIT_BUF(&v_ptr,
+									&vsize),
+				     .r_flags      = 0,
+				     };
+	struct ut_cb_data      data  = {
+					.key            = &rec.r_key,
+					.value          = &rec.r_val,
+					.check_value    = false,
+					.crc            = M0_BCT_NO_CRC,
+					.flags          = 0,
+					.embedded_ksize = false,
+					.embedded_vsize = false,
+				       };
+	struct m0_btree_cb     ut_cb   = {
+					  .c_act       = ut_btree_kv_put_cb,
+					  .c_datum     = &data,
+					 };
+	int32_t                loop_count;
+	struct m0_btree_op     kv_op           = {};
+	void                  *rnode;
+	struct m0_btree_type   btree_type      = {.tt_id = M0_BT_UT_KV_OPS,
+					          .ksize = sizeof(key),
+					          .vsize = sizeof(value),
+					         };
+	struct m0_be_tx         tx_data         = {};
+	struct m0_be_tx        *tx             = &tx_data;
+	struct m0_be_tx_credit  cred           = {};
+	struct m0_fid           fid            = M0_FID_TINIT('b', 0, 1);
+	int                     rc;
+	uint32_t                rnode_sz       = m0_pagesize_get();
+	uint32_t                rnode_sz_shift;
+	struct m0_buf           buf;
 
-			/**
-			 *  The following short named variables are used just
-			 *  to maintain the code decorum by limiting code lines
-			 *  within 80 chars..
-			 */
-			r = rec;
-			cb = ut_get_cb;
+	random_r(&ti->ti_random_buf, &loop_count);
+	loop_count %= (MAX_TREE_LOOPS - MIN_TREE_LOOPS);
+	loop_count += MIN_TREE_LOOPS;
 
-			do {
-				ksize = ksize_random ?
-					GET_RANDOM_KEYSIZE(key, slant_key,
-							   key_iter_start,
-							   ti->ti_key_incr) :
-					ti->ti_key_size;
+	UT_THREAD_WAIT();
+	m0_atomic64_inc(&threads_running);
 
-				/**
-				 *  Alternate between using the exact number as
-				 *  Key for slant and a previous number as Key
-				 *  for slant to test for both scenarios.
-				 */
-				kdata = (slant_key % 2) ? slant_key - 1 :
-							   slant_key;
-				kdata = (kdata <<
-					  (sizeof(ti->ti_thread_id) * 8)) +
-					 ti->ti_thread_id;
-				kdata = m0_byteorder_cpu_to_be64(kdata);
-				FILL_KEY(key, ksize, kdata);
+	M0_ASSERT(rnode_sz != 0 && m0_is_po2(rnode_sz));
+	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
 
-				M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-							 m0_btree_get(tree,
-								      &r.r_key,
-								      &cb,
-								      BOF_SLANT,
-								      &kv_op));
+	/** Prepare transaction to capture tree operations. */
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
 
-				/**
-				 *  If multiple threads are running then slant
-				 *  could return us the value which was added
-				 *  by a different thread. We anyways make sure
-				 *  that the got value (without the embedded
-				 *  thread ID) is more than the slant value.
-				 */
-				got_key = m0_byteorder_cpu_to_be64(get_key[0]);
-				got_key >>= (sizeof(ti->ti_thread_id) * 8);
-				M0_ASSERT(got_key == slant_key);
+	/** Create temp node space and use it as root node for btree */
+	buf = M0_BUF_INIT(rnode_sz, NULL);
+	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	rnode = buf.b_addr;
 
-				slant_key += ti->ti_key_incr;
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
 
-				UT_THREAD_QUIESCE_IF_REQUESTED();
-			} while (slant_key <= key_last);
-		}
+	while (loop_count--) {
+		struct m0_btree_op b_op      = {};
+		struct m0_btree    *tree;
+		struct m0_btree    btree;
+		int32_t            rec_count;
+		uint32_t           i;
 
 		/**
-		 *  DEL the keys which we had created in this iteration. The
-		 *  direction of traversing the delete keys is randomly
-		 *  selected.
+		 * 1) Create a tree
+		 * 2) Add a few random count of records in the tree.
+		 * 3) Close the tree
+		 * 4) Open the tree
+		 * 5) Confirm the records are present in the tree.
+		 * 6) Close the tree
+		 * 4) Open the tree
+		 * 5) Delete all the records from the tree.
+		 * 6) Close the tree
+		 * 7) Destroy the tree
 		 */
-		random_r(&ti->ti_random_buf, &r);
+		cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+		m0_btree_create_credit(&btree_type, &cred, 1);
 
-		key_first = key_iter_start;
-		del_key = (r % 2 == 0) ? key_first : key_last;
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+					      m0_btree_create(rnode, rnode_sz,
+							      &btree_type,
+							      M0_BCT_NO_CRC,
+							      &b_op, &btree,
+							      seg, &fid, tx,
+							      NULL));
+		M0_ASSERT(rc == 0);
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+		tree = b_op.bo_arbor;
 
-		ut_cb.c_act   = ut_btree_kv_del_cb;
-		ut_cb.c_datum = &data;
-		while (keys_put_count) {
-			ksize = ksize_random ?
-				GET_RANDOM_KEYSIZE(key, del_key, key_iter_start,
-						   ti->ti_key_incr) :
-				ti->ti_key_size;
+		random_r(&ti->ti_random_buf, &rec_count);
+		rec_count %= MAX_RECS_FOR_TREE_TEST;
+		rec_count = rec_count ? : (MAX_RECS_FOR_TREE_TEST / 2);
 
-			kdata = (del_key << (sizeof(ti->ti_thread_id) * 8)) +
-				 ti->ti_thread_id;
-			kdata = m0_byteorder_cpu_to_be64(kdata);
-			FILL_KEY(key, ksize, kdata);
+		ut_cb.c_act = ut_btree_kv_put_cb;
+
+		cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+		m0_btree_put_credit(tree, 1, ksize, vsize, &cred);
+		for (i = 1; i <= rec_count; i++) {
+			value = key = i;
 
 			m0_be_ut_tx_init(tx, ut_be);
-			m0_be_tx_prep(tx, &del_cred);
+			m0_be_tx_prep(tx, &cred);
 			rc = m0_be_tx_open_sync(tx);
 			M0_ASSERT(rc == 0);
 
-			M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-						 m0_btree_del(tree, &rec.r_key,
-							      &ut_cb,
-							      &kv_op, tx));
+			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+						      m0_btree_put(tree, &rec,
+								   &ut_cb,
+								   &kv_op, tx));
 			M0_ASSERT(rc == 0 && data.flags == M0_BSC_SUCCESS);
 			m0_be_tx_close_sync(tx);
 			m0_be_tx_fini(tx);
-
-			del_key = (r % 2 == 0) ? del_key + ti->ti_key_incr :
-						 del_key - ti->ti_key_incr;
-			keys_put_count--;
-
-			UT_THREAD_QUIESCE_IF_REQUESTED();
 		}
 
-		/**
-		 *  Verify deleted Keys are not 'visible'.
-		 *  We try to read the first key and last key added in this
-		 *  iteration from the btree and make sure ENOENT error is
-		 *  returned for each of the Keys.
-		 */
-		key_first = key_iter_start;
-
-		ksize = ksize_random ?
-			GET_RANDOM_KEYSIZE(key, key_first, key_iter_start,
-					   ti->ti_key_incr) :
-			ti->ti_key_size;
-
-		kdata = (key_first << (sizeof(ti->ti_thread_id) * 8)) +
-			ti->ti_thread_id;
-		kdata = m0_byteorder_cpu_to_be64(kdata);
-		FILL_KEY(key, ksize, kdata);
-
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_get(tree,
-							   &rec.r_key,
-							   &ut_get_cb,
-							   BOF_EQUAL, &kv_op));
-		M0_ASSERT(rc == -ENOENT);
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+					      m0_btree_close(tree, &b_op));
+		M0_ASSERT(rc == 0);
+		M0_SET0(&btree);
 
-		if (key_first != key_last) {
-			ksize = ksize_random ?
-				GET_RANDOM_KEYSIZE(key, key_last,
-						   key_iter_start,
-						   ti->ti_key_incr) :
-				ti->ti_key_size;
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+					      m0_btree_open(rnode, rnode_sz,
+							    tree, seg, &b_op,
+							    NULL));
+		M0_ASSERT(rc == 0);
 
-			kdata = (key_last << (sizeof(ti->ti_thread_id) * 8)) +
-				ti->ti_thread_id;
-			kdata = m0_byteorder_cpu_to_be64(kdata);
-			FILL_KEY(key, ksize, kdata);
+		ut_cb.c_act = ut_btree_kv_get_cb;
+		for (i = 1; i <= rec_count; i++) {
+			value = key = i;
 
 			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
 						      m0_btree_get(tree,
 								   &rec.r_key,
-								   &ut_get_cb,
+								   &ut_cb,
 								   BOF_EQUAL,
 								   &kv_op));
-			M0_ASSERT(rc == -ENOENT);
+			M0_ASSERT(data.flags == M0_BSC_SUCCESS && rc == 0);
 		}
 
-		/**
-		 *  Try to delete the first key and last key added in this
-		 *  iteration from the btree and make sure ENOENT error is
-		 *  returned for each of the Keys.
-		 */
-		key_first = key_iter_start;
-
-		ksize = ksize_random ?
-			GET_RANDOM_KEYSIZE(key, key_first, key_iter_start,
-					   ti->ti_key_incr) :
-			ti->ti_key_size;
-
-		kdata = (key_first << (sizeof(ti->ti_thread_id) * 8)) +
-			 ti->ti_thread_id;
-		kdata = m0_byteorder_cpu_to_be64(kdata);
-		FILL_KEY(key, ksize, kdata);
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+					      m0_btree_close(tree, &b_op));
+		M0_ASSERT(rc == 0);
+		M0_SET0(&btree);
 
-		m0_be_ut_tx_init(tx, ut_be);
-		m0_be_tx_prep(tx, &del_cred);
-		rc = m0_be_tx_open_sync(tx);
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+					      m0_btree_open(rnode, rnode_sz,
+							    tree, seg, &b_op,
+							    NULL));
 		M0_ASSERT(rc == 0);
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_del(tree, &rec.r_key,
-							   &ut_cb, &kv_op,
-							   tx));
-		M0_ASSERT(rc == -ENOENT);
-		m0_be_tx_close_sync(tx);
-		m0_be_tx_fini(tx);
-
-		if (key_first != key_last) {
-			ksize = ksize_random ?
-				GET_RANDOM_KEYSIZE(key, key_last,
-						   key_iter_start,
-						   ti->ti_key_incr) :
-				ti->ti_key_size;
+		ut_cb.c_act = ut_btree_kv_del_cb;
 
-			kdata = (key_last << (sizeof(ti->ti_thread_id) * 8)) +
-				ti->ti_thread_id;
-			kdata = m0_byteorder_cpu_to_be64(kdata);
-			FILL_KEY(key, ksize, kdata);
+		cred = M0_BE_TX_CREDIT(0, 0);
+		m0_btree_del_credit(tree, 1, ksize, -1, &cred);
+		for (i = 1; i <= rec_count; i++) {
+			value = key = i;
 
 			m0_be_ut_tx_init(tx, ut_be);
-			m0_be_tx_prep(tx, &del_cred);
+			m0_be_tx_prep(tx, &cred);
 			rc = m0_be_tx_open_sync(tx);
 			M0_ASSERT(rc == 0);
 
@@ -10921,218 +13022,93 @@ static void btree_ut_kv_oper_thread_handler(struct btree_ut_thread_info *ti)
 								   &rec.r_key,
 								   &ut_cb,
 								   &kv_op, tx));
-			M0_ASSERT(rc == -ENOENT);
+			M0_ASSERT(data.flags == M0_BSC_SUCCESS && rc == 0);
 			m0_be_tx_close_sync(tx);
 			m0_be_tx_fini(tx);
 		}
 
-		key_iter_start = key_last + ti->ti_key_incr;
-
-		UT_THREAD_QUIESCE_IF_REQUESTED();
-	}
-
-	m0_atomic64_dec(&threads_running);
-	/** Free resources. */
-	m0_free(ti->ti_rnd_state_ptr);
-
-	m0_be_ut_backend_thread_exit(ut_be);
-}
+		cred = M0_BE_TX_CREDIT(0, 0);
+		m0_btree_destroy_credit(tree, NULL, &cred, 1);
 
-/**
- * This function allocates an array pointed by cpuid_ptr and fills it with the
- * CPU ID of the CPUs which are currently online.
- */
-static void online_cpu_id_get(uint16_t **cpuid_ptr, uint16_t *cpu_count)
-{
-	size_t           cpu_max;
-	uint32_t         cpuid;
-	struct m0_bitmap map_cpu_online  = {};
-	int              rc;
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
 
-	*cpu_count = 0;
-	cpu_max = m0_processor_nr_max();
-	rc = m0_bitmap_init(&map_cpu_online, cpu_max);
-	if (rc != 0)
-		return;
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+					      m0_btree_destroy(tree,
+							       &b_op, tx));
+		M0_ASSERT(rc == 0);
+		M0_SET0(&btree);
 
-	m0_processors_online(&map_cpu_online);
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
 
-	for (cpuid = 0; cpuid < map_cpu_online.b_nr; cpuid++) {
-		if (m0_bitmap_get(&map_cpu_online, cpuid)) {
-			(*cpu_count)++;
-		}
+		/** Error Case */
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+					      m0_btree_open(rnode, rnode_sz,
+							    tree, seg, &b_op,
+							    NULL));
+		M0_ASSERT(rc == -EINVAL);
 	}
 
-	if (*cpu_count) {
-		M0_ALLOC_ARR(*cpuid_ptr, *cpu_count);
-		M0_ASSERT(*cpuid_ptr != NULL);
-
-		*cpu_count = 0;
-		for (cpuid = 0; cpuid < map_cpu_online.b_nr; cpuid++) {
-			if (m0_bitmap_get(&map_cpu_online, cpuid)) {
-				(*cpuid_ptr)[*cpu_count] = cpuid;
-				(*cpu_count)++;
-			}
-		}
-	}
+	m0_atomic64_dec(&threads_running);
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
 
-	m0_bitmap_fini(&map_cpu_online);
-}
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
 
-static void btree_ut_kv_size_get(enum btree_node_type bnt, int *ksize,
-				 int *vsize)
-{
-	uint32_t ksize_to_use = 2 * sizeof(uint64_t);
+	/** Delete temp node space which was used as root node for the tree. */
+	buf = M0_BUF_INIT(rnode_sz, rnode);
+	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
 
-	ksize_to_use += sizeof(uint64_t); /** To accomodate size within the Key. */
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
 
-	switch (bnt) {
-	case BNT_FIXED_FORMAT:
-		*ksize = ksize_to_use;
-		*vsize = ksize_to_use;
-		break;
-	case BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE:
-		*ksize = ksize_to_use;
-		*vsize = RANDOM_VALUE_SIZE;
-		break;
-	case BNT_VARIABLE_KEYSIZE_FIXED_VALUESIZE:
-		*ksize = RANDOM_KEY_SIZE;
-		*vsize = ksize_to_use;
-		break;
-	case BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE:
-		*ksize = RANDOM_KEY_SIZE;
-		*vsize = RANDOM_VALUE_SIZE;
-		break;
-	}
+	m0_be_ut_backend_thread_exit(ut_be);
 }
 
-/**
- * This test launches multiple threads which launch KV operations against one
- * btree in parallel. If thread_count is passed as '0' then one thread per core
- * is launched. If tree_count is passed as '0' then one tree per thread is
- * created.
- */
-static void btree_ut_kv_oper(int32_t thread_count, int32_t tree_count,
-			     enum btree_node_type bnt)
+static void btree_ut_num_threads_tree_oper(uint32_t thread_count)
 {
-	int                           rc;
-	struct btree_ut_thread_info  *ti;
-	int                           i;
-	struct m0_btree             **ut_trees;
-	uint16_t                      cpu;
-	void                         *rnode;
-	struct m0_btree_op            b_op         = {};
-	int                           ksize = 0;
-	int                           vsize = 0;
-	struct m0_btree_type          btree_type;
-	struct m0_be_tx_credit        cred;
-	struct m0_be_tx               tx_data      = {};
-	struct m0_be_tx              *tx           = &tx_data;
-	struct m0_fid                 fid          = M0_FID_TINIT('b', 0, 1);
-	struct m0_buf                 buf;
-	uint16_t                     *cpuid_ptr;
-	uint16_t                      cpu_count;
-	size_t                        cpu_max;
-	time_t                        curr_time;
-	uint32_t                      rnode_sz        = m0_pagesize_get();
-	uint32_t                      rnode_sz_shift;
+	uint16_t                    *cpuid_ptr;
+	uint16_t                     cpu_count;
+	size_t                       cpu_max;
+	struct btree_ut_thread_info *ti;
+	uint16_t                     cpu;
+	int                          i;
+	int                          rc;
+	time_t                       curr_time;
 
 	M0_ENTRY();
 
-	btree_ut_kv_size_get(bnt, &ksize, &vsize);
-	btree_type.tt_id = M0_BT_UT_KV_OPS;
-	btree_type.ksize = ksize;
-	btree_type.vsize = vsize;
-
-	time(&curr_time);
-	M0_LOG(M0_INFO, "Using seed %lu", curr_time);
-	srandom(curr_time);
-
-	/**
-	 *  1) Create btree(s) to be used by all the threads.
-	 *  2) Assign CPU cores to the threads.
-	 *  3) Init and Start the threads which do KV operations.
-	 *  4) Wait till all the threads are done.
-	 *  5) Close the btree
-	 *  6) Destroy the btree
-	 */
-
-	btree_ut_init();
-
-	online_cpu_id_get(&cpuid_ptr, &cpu_count);
-
-	if (thread_count == 0)
-		thread_count = cpu_count - 1; /** Skip Core-0 */
-	else if (thread_count == RANDOM_THREAD_COUNT) {
-		thread_count = 1;
-		if (cpu_count > 2) {
-			/**
-			 *  Avoid the extreme cases i.e. thread_count
-			 *  cannot be 1 or cpu_count - 1
-			 */
-			thread_count = (random() % (cpu_count - 2)) + 1;
-		}
-	}
-
-	if (tree_count == 0)
-		tree_count = thread_count;
-	else if (tree_count == RANDOM_TREE_COUNT) {
-		tree_count = 1;
-		if (thread_count > 2) {
-			/**
-			 *  Avoid the extreme cases i.e. tree_count
-			 *  cannot be 1 or thread_count
-			 */
-			tree_count = (random() % (thread_count - 1)) + 1;
-		}
-	}
-
-	M0_ASSERT(thread_count >= tree_count);
-
-	UT_STOP_THREADS();
-	m0_atomic64_set(&threads_running, 0);
-	m0_atomic64_set(&threads_quiesced, 0);
-
-	M0_ALLOC_ARR(ut_trees, tree_count);
-	M0_ASSERT(ut_trees != NULL);
-	struct m0_btree btree[tree_count];
-
-	/**
-	 *  Add credits count needed for allocating node space and creating node
-	 *  layout on it.
-	 */
-	M0_ASSERT(rnode_sz != 0 && m0_is_po2(rnode_sz));
-	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
-	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
-			       rnode_sz_shift, &cred);
-	m0_btree_create_credit(&btree_type, &cred, 1);
-	for (i = 0; i < tree_count; i++) {
-		M0_SET0(&b_op);
-
-		m0_be_ut_tx_init(tx, ut_be);
-		m0_be_tx_prep(tx, &cred);
-		rc = m0_be_tx_open_sync(tx);
-		M0_ASSERT(rc == 0);
-
-		/** Create temp node space and use it as root node for btree */
-		buf = M0_BUF_INIT(rnode_sz, NULL);
-		M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
-		rnode = buf.b_addr;
-
-		M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-					 m0_btree_create(rnode, rnode_sz,
-							 &btree_type,
-							 M0_BCT_NO_CRC, &b_op,
-							 &btree[i], seg, &fid,
-							 tx, NULL));
-		M0_ASSERT(rc == M0_BSC_SUCCESS);
-
-		m0_be_tx_close_sync(tx);
-		m0_be_tx_fini(tx);
-		ut_trees[i] = b_op.bo_arbor;
+	time(&curr_time);
+	M0_LOG(M0_INFO, "Using seed %lu", curr_time);
+	srandom(curr_time);
+
+	btree_ut_init();
+	online_cpu_id_get(&cpuid_ptr, &cpu_count);
+
+	if (thread_count == 0)
+		thread_count = cpu_count - 1; /** Skip Core-0 */
+	else if (thread_count == RANDOM_THREAD_COUNT) {
+		thread_count = 1;
+		if (cpu_count > 2) {
+			/**
+			 *  Avoid the extreme cases i.e. thread_count
+			 *  cannot be 1 or cpu_count - 1
+			 */
+			thread_count = (random() % (cpu_count - 2)) + 1;
+		}
 	}
 
+	UT_STOP_THREADS();
+	m0_atomic64_set(&threads_running, 0);
+	m0_atomic64_set(&threads_quiesced, 0);
+
 	M0_ALLOC_ARR(ti, thread_count);
 	M0_ASSERT(ti != NULL);
 
@@ -11150,167 +13126,190 @@ static void btree_ut_kv_oper(int32_t thread_count, int32_t tree_count,
 			 */
 			cpu = 1;
 
-		ti[i].ti_key_first  = 1;
-		ti[i].ti_key_count  = MAX_RECS_PER_THREAD;
-		ti[i].ti_key_incr   = 5;
 		ti[i].ti_thread_id  = i;
-		ti[i].ti_tree       = ut_trees[i % tree_count];
-		ti[i].ti_key_size   = btree_type.ksize;
-		ti[i].ti_value_size = btree_type.vsize;
-		ti[i].ti_random_bursts = (thread_count > 1);
-		do {
-			ti[i].ti_rng_seed_base = random();
-		} while (ti[i].ti_rng_seed_base == 0);
 	}
 
 	for (i = 0; i < thread_count; i++) {
 		rc = M0_THREAD_INIT(&ti[i].ti_q, struct btree_ut_thread_info *,
 				    btree_ut_thread_init,
-				    &btree_ut_kv_oper_thread_handler, &ti[i],
+				    &btree_ut_tree_oper_thread_handler, &ti[i],
 				    "Thread-%d", i);
 		M0_ASSERT(rc == 0);
 	}
 
-	/** Initialized all the threads by now. Let's get rolling ... */
+	/** Initialized all the threads. Now start the chaos ... */
 	UT_START_THREADS();
 
-	for (i = 0; i < thread_count;i++) {
+	for (i = 0; i < thread_count; i++) {
 		m0_thread_join(&ti[i].ti_q);
 		m0_thread_fini(&ti[i].ti_q);
 	}
 
-	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
-			       rnode_sz_shift, &cred);
-	m0_btree_destroy_credit(ut_trees[0], NULL, &cred, 1);
-	for (i = 0; i < tree_count; i++) {
-		m0_be_ut_tx_init(tx, ut_be);
-		m0_be_tx_prep(tx, &cred);
-		rc = m0_be_tx_open_sync(tx);
-		M0_ASSERT(rc == 0);
-
-		rnode = segaddr_addr(&ut_trees[i]->t_desc->t_root->n_addr);
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-					      m0_btree_destroy(ut_trees[i],
-							       &b_op, tx));
-		M0_ASSERT(rc == 0);
-		M0_SET0(&btree[i]);
-		buf = M0_BUF_INIT(rnode_sz, rnode);
-		M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
-		m0_be_tx_close_sync(tx);
-		m0_be_tx_fini(tx);
-	}
-
 	m0_free0(&cpuid_ptr);
-	m0_free(ut_trees);
 	m0_free(ti);
 	btree_ut_fini();
-
-	M0_LEAVE();
 }
 
-static void ut_st_st_kv_oper(void)
+static void ut_st_tree_oper(void)
 {
-	int i;
-	for (i = 1; i <= BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE; i++)
-	{
-		if (btree_node_format[i] != NULL)
-			btree_ut_kv_oper(1, 1, i);
-	}
+	btree_ut_num_threads_tree_oper(1);
 }
 
-static void ut_mt_st_kv_oper(void)
+static void ut_mt_tree_oper(void)
 {
-	int i;
-	for (i = 1; i <= BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE; i++)
-	{
-		if (btree_node_format[i] != NULL)
-			btree_ut_kv_oper(0, 1, i);
-	}
+	btree_ut_num_threads_tree_oper(0);
 }
-
-static void ut_mt_mt_kv_oper(void)
+/**
+ * Note that tree is ASSUMED to be closed before calling this function.
+ */
+static bool validate_nodes_on_be_segment(struct segaddr *rnode_segaddr)
 {
-	int i;
-	for (i = 1; i <= BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE; i++)
-	{
-		if (btree_node_format[i] != NULL)
-			btree_ut_kv_oper(0, 0, i);
-	}
-}
+	const struct node_type     *nt;
+	struct {
+		struct segaddr node_segaddr;
+		uint16_t       rec_idx;
+		}                   stack[MAX_TREE_HEIGHT + 1];
+	uint32_t                    stack_level = 0;
+	struct nd                   n;
+	struct slot                 s       = { .s_node = &n };
+	uint16_t                    rec_idx = 0;
 
-static void ut_rt_rt_kv_oper(void)
-{
-	int i;
-	for (i = 1; i <= BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE; i++)
-	{
-		if (btree_node_format[i] != NULL)
-			btree_ut_kv_oper(RANDOM_THREAD_COUNT, RANDOM_TREE_COUNT,
-					 i);
+	nt = btree_node_format[segaddr_ntype_get(rnode_segaddr)];
+	n.n_addr = *rnode_segaddr;
+	#if (AVOID_BE_SEGMENT == 0)
+		M0_ASSERT(nt->nt_opaque_get(&n.n_addr) == NULL);
+	#endif
+
+	while (true) {
+		/**
+		 * Move down towards leaf node only if we have child nodes still
+		 * to traverse.
+		 */
+		if (nt->nt_level(&n) > 0 &&
+		    rec_idx < nt->nt_rec_count(&n)) {
+			stack[stack_level].node_segaddr = n.n_addr,
+			stack[stack_level].rec_idx      = rec_idx,
+			stack_level++;
+			s.s_idx = rec_idx;
+			nt->nt_child(&s, &n.n_addr);
+			n.n_addr.as_core = (uint64_t)segaddr_addr(&n.n_addr);
+			#if (AVOID_BE_SEGMENT == 0)
+				M0_ASSERT(nt->nt_opaque_get(&n.n_addr) == NULL);
+			#endif
+			rec_idx = 0;
+			continue;
+		}
+
+		/**
+		 * We are at the leaf node. Validate it before going back to
+		 * parent.
+		 */
+
+		M0_ASSERT(nt->nt_isvalid(&n.n_addr));
+#if (AVOID_BE_SEGMENT == 0)
+		M0_ASSERT(nt->nt_opaque_get(&n.n_addr) == NULL);
+#endif
+		if (stack_level == 0)
+			break;
+
+		/**
+		 * Start moving up towards parent (or grand-parent) till we find
+		 * an ancestor whose child nodes are still to be traversed. If
+		 * we find an ancestor whose child nodes are still to be
+		 * traversed then we pick the next child node on the right.
+		 */
+		do {
+			stack_level--;
+			rec_idx  = stack[stack_level].rec_idx + 1;
+			n.n_addr = stack[stack_level].node_segaddr;
+		} while (rec_idx >= nt->nt_rec_count(&n) &&
+			 stack_level > 0);
 	}
+
+	return true;
 }
 
 /**
- * This routine is a thread handler primarily involved in creating, opening,
- * closing and destroying btree. To run out-of-sync with other threads it also
- * launches PUT, GET, ITER and DEL operations on the btree for a random count.
+ * This unit test exercises different KV operations and confirms the changes
+ * persist across cluster reboots.
  */
-static void btree_ut_tree_oper_thread_handler(struct btree_ut_thread_info *ti)
+static void ut_btree_persistence(void)
 {
-	uint64_t               key;
-	uint64_t               value;
-	m0_bcount_t            ksize = sizeof key;
-	m0_bcount_t            vsize = sizeof value;
-	void                  *k_ptr = &key;
-	void                  *v_ptr = &value;
-	struct m0_btree_rec    rec   = {
-				     .r_key.k_data = M0_BUFVEC_INIT_BUF(&k_ptr,
-									&ksize),
-				     .r_val        = M0_BUFVEC_INIT_BUF(&v_ptr,
-									&vsize),
-				     .r_flags      = 0,
-				     };
-	struct ut_cb_data      data  = {
-					.key            = &rec.r_key,
-					.value          = &rec.r_val,
-					.check_value    = false,
-					.crc            = M0_BCT_NO_CRC,
-					.flags          = 0,
-					.embedded_ksize = false,
-					.embedded_vsize = false,
-				       };
-	struct m0_btree_cb     ut_cb   = {
-					  .c_act       = ut_btree_kv_put_cb,
-					  .c_datum     = &data,
-					 };
-	int32_t                loop_count;
-	struct m0_btree_op     kv_op           = {};
-	void                  *rnode;
-	struct m0_btree_type   btree_type      = {.tt_id = M0_BT_UT_KV_OPS,
-					          .ksize = sizeof(key),
-					          .vsize = sizeof(value),
-					         };
-	struct m0_be_tx         tx_data         = {};
-	struct m0_be_tx        *tx             = &tx_data;
-	struct m0_be_tx_credit  cred           = {};
-	struct m0_fid           fid            = M0_FID_TINIT('b', 0, 1);
-	int                     rc;
-	uint32_t                rnode_sz       = m0_pagesize_get();
-	uint32_t                rnode_sz_shift;
-	struct m0_buf           buf;
+	void                        *rnode;
+	int                          i;
+	struct m0_btree_cb           ut_cb;
+	struct m0_be_tx             tx_data         = {};
+	struct m0_be_tx            *tx              = &tx_data;
+	struct m0_be_tx_credit      cred            = {};
+	struct m0_btree_op          b_op            = {};
+	uint64_t                    rec_count       = MAX_RECS_PER_STREAM;
+	struct m0_btree_op          kv_op           = {};
+	struct m0_btree            *tree;
+	struct m0_btree             btree;
+	const struct m0_btree_type  bt              = {
+						     .tt_id = M0_BT_UT_KV_OPS,
+						     .ksize = sizeof(uint64_t),
+						     .vsize = bt.ksize * 2,
+						};
+	const struct node_type     *nt;
+	struct segaddr              rnode_segaddr;
+	uint64_t                    key;
+	uint64_t                    value[bt.vsize / sizeof(uint64_t)];
+	m0_bcount_t                 ksize           = sizeof key;
+	m0_bcount_t                 vsize           = sizeof value;
+	void                       *k_ptr           = &key;
+	void                       *v_ptr           = &value;
+	int                         rc;
+	struct m0_buf               buf;
+	uint32_t                    rnode_sz        = m0_pagesize_get();
+	struct m0_fid               fid             = M0_FID_TINIT('b', 0, 1);
+	uint32_t                    rnode_sz_shift;
+	struct m0_btree_rec         rec             = {
+			    .r_key.k_data = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize),
+			    .r_val        = M0_BUFVEC_INIT_BUF(&v_ptr, &vsize),
+			    .r_crc_type   = M0_BCT_NO_CRC,
+			};
+	struct ut_cb_data           put_data;
+	struct ut_cb_data           get_data;
 
-	random_r(&ti->ti_random_buf, &loop_count);
-	loop_count %= (MAX_TREE_LOOPS - MIN_TREE_LOOPS);
-	loop_count += MIN_TREE_LOOPS;
+	M0_ENTRY();
 
-	UT_THREAD_WAIT();
-	m0_atomic64_inc(&threads_running);
+	rec_count = (rec_count / 2) * 2; /** Make rec_count a multiple of 2 */
+
+	btree_ut_init();
+	/**
+	 *  Run the following scenario:
+	 *  1) Create a btree
+	 *  2) Add records in the created tree.
+	 *  3) Reload the BE segment.
+	 *  4) Confirm all the records are present in the tree.
+	 *  5) Delete records with EVEN numbered Keys.
+	 *  6) Reload the BE segment.
+	 *  7) Confirm all the records with EVEN numbered Keys are missing while
+	 *     the records with ODD numbered Keys are present in the tree.
+	 *  8) Now add back records with EVEN numbered Keys (the same records
+	 *     which were deleted in step 6)
+	 *  9) Delete records with ODD numbered Keys from the btree.
+	 * 10) Reload the BE segment.
+	 * 11) Confirm records with EVEN numbered Keys are present while the
+	 *     records with ODD numbered Keys are missing from the tree.
+	 * 12) Delete all records with EVEN numbered Keys from the tree.
+	 * 13) Reload the BE segment.
+	 * 14) Search for the records with all the EVEN and ODD numbered Keys,
+	 *     no record should be found in the tree.
+	 * 15) Destroy the btree
+	 * 16) Reload the BE segment.
+	 * 17) Try to open the destroyed tree. This should fail.
+	 *
+	 *  Capture each operation in a separate transaction.
+	 */
 
 	M0_ASSERT(rnode_sz != 0 && m0_is_po2(rnode_sz));
 	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
 	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
 	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
 			       rnode_sz_shift, &cred);
+	m0_btree_create_credit(&bt, &cred, 1);
 
 	/** Prepare transaction to capture tree operations. */
 	m0_be_ut_tx_init(tx, ut_be);
@@ -11323,336 +13322,415 @@ static void btree_ut_tree_oper_thread_handler(struct btree_ut_thread_info *ti)
 	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
 	rnode = buf.b_addr;
 
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(rnode, rnode_sz,
+							     &bt,
+							     M0_BCT_NO_CRC,
+							     &b_op, &btree,seg,
+							     &fid, tx, NULL));
+	M0_ASSERT(rc == M0_BSC_SUCCESS);
 	m0_be_tx_close_sync(tx);
 	m0_be_tx_fini(tx);
 
-	while (loop_count--) {
-		struct m0_btree_op b_op      = {};
-		struct m0_btree    *tree;
-		struct m0_btree    btree;
-		int32_t            rec_count;
-		uint32_t           i;
+	tree = b_op.bo_arbor;
 
-		/**
-		 * 1) Create a tree
-		 * 2) Add a few random count of records in the tree.
-		 * 3) Close the tree
-		 * 4) Open the tree
-		 * 5) Confirm the records are present in the tree.
-		 * 6) Close the tree
-		 * 4) Open the tree
-		 * 5) Delete all the records from the tree.
-		 * 6) Close the tree
-		 * 7) Destroy the tree
-		 */
-		cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-		m0_btree_create_credit(&btree_type, &cred, 1);
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_btree_put_credit(tree, 1, ksize, vsize, &cred);
+
+	put_data.key       = &rec.r_key;
+	put_data.value     = &rec.r_val;
+
+	ut_cb.c_act        = ut_btree_kv_put_cb;
+	ut_cb.c_datum      = &put_data;
+
+	for (i = 1; i <= rec_count; i++) {
+		int      k;
+
+		key = m0_byteorder_cpu_to_be64(i);
+		for (k = 0; k < ARRAY_SIZE(value); k++)
+			value[k] = key;
 
 		m0_be_ut_tx_init(tx, ut_be);
 		m0_be_tx_prep(tx, &cred);
 		rc = m0_be_tx_open_sync(tx);
 		M0_ASSERT(rc == 0);
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-					      m0_btree_create(rnode, rnode_sz,
-							      &btree_type,
-							      M0_BCT_NO_CRC,
-							      &b_op, &btree,
-							      seg, &fid, tx,
-							      NULL));
-		M0_ASSERT(rc == 0);
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_put(tree, &rec,
+							   &ut_cb,
+							   &kv_op, tx));
+		M0_ASSERT(rc == 0 && put_data.flags == M0_BSC_SUCCESS);
 		m0_be_tx_close_sync(tx);
 		m0_be_tx_fini(tx);
-		tree = b_op.bo_arbor;
+	}
 
-		random_r(&ti->ti_random_buf, &rec_count);
-		rec_count %= MAX_RECS_FOR_TREE_TEST;
-		rec_count = rec_count ? : (MAX_RECS_FOR_TREE_TEST / 2);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_close(tree, &b_op));
+	M0_ASSERT(rc == 0);
+	M0_SET0(&btree);
 
-		ut_cb.c_act = ut_btree_kv_put_cb;
+	/**
+	 * Confirm root node on BE segment is valid and the opaque pointer in
+	 * the node is NULL.
+	 */
+	rnode_segaddr.as_core = (uint64_t)rnode;
+	nt = btree_node_format[segaddr_ntype_get(&rnode_segaddr)];
+	M0_ASSERT(nt->nt_isvalid(&rnode_segaddr) &&
+		  nt->nt_opaque_get(&rnode_segaddr) == NULL);
 
-		cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-		m0_btree_put_credit(tree, 1, ksize, vsize, &cred);
-		for (i = 1; i <= rec_count; i++) {
-			value = key = i;
 
+	/** Re-map the BE segment.*/
+	m0_be_seg_close(ut_seg->bus_seg);
+	rc = madvise(rnode, rnode_sz, MADV_NORMAL);
+	M0_ASSERT(rc == -1 && errno == ENOMEM); /** Assert BE segment unmapped*/
+	m0_be_seg_open(ut_seg->bus_seg);
+
+	/** Confirm nodes on BE segment are still valid. */
+	rnode_segaddr.as_core = (uint64_t)rnode;
+	validate_nodes_on_be_segment(&rnode_segaddr);
+
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+				      m0_btree_open(rnode, rnode_sz, tree, seg,
+						    &b_op, NULL));
+	M0_ASSERT(rc == 0);
+
+	get_data.key            = &rec.r_key;
+	get_data.value          = &rec.r_val;
+	get_data.check_value    = true;
+	get_data.crc            = M0_BCT_NO_CRC;
+	get_data.embedded_ksize = false;
+	get_data.embedded_vsize = false;
+
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_btree_del_credit(tree, 1, ksize, vsize, &cred);
+
+	for (i = 1; i <= rec_count; i++) {
+		uint64_t             f_key;
+		void                *f_key_ptr  = &f_key;
+		m0_bcount_t          f_key_size  = sizeof f_key;
+		struct m0_btree_key  key_in_tree;
+
+		f_key = m0_byteorder_cpu_to_be64(i);
+		key_in_tree.k_data =
+				    M0_BUFVEC_INIT_BUF(&f_key_ptr, &f_key_size);
+		ut_cb.c_act             = ut_btree_kv_get_cb;
+		ut_cb.c_datum           = &get_data;
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_get(tree,
+							   &key_in_tree,
+							   &ut_cb, BOF_EQUAL,
+							   &kv_op));
+		M0_ASSERT(rc == M0_BSC_SUCCESS &&
+			  i == m0_byteorder_be64_to_cpu(key));
+
+		if (i % 2 == 0) {
 			m0_be_ut_tx_init(tx, ut_be);
 			m0_be_tx_prep(tx, &cred);
 			rc = m0_be_tx_open_sync(tx);
 			M0_ASSERT(rc == 0);
 
+			ut_cb.c_act             = ut_btree_kv_del_cb;
+			ut_cb.c_datum           = &get_data;
+
 			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-						      m0_btree_put(tree, &rec,
+						      m0_btree_del(tree,
+								   &key_in_tree,
 								   &ut_cb,
 								   &kv_op, tx));
-			M0_ASSERT(rc == 0 && data.flags == M0_BSC_SUCCESS);
+			M0_ASSERT(rc == 0);
 			m0_be_tx_close_sync(tx);
 			m0_be_tx_fini(tx);
 		}
+	}
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-					      m0_btree_close(tree, &b_op));
-		M0_ASSERT(rc == 0);
-		M0_SET0(&btree);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_close(tree, &b_op));
+	M0_ASSERT(rc == 0);
+	M0_SET0(&btree);
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-					      m0_btree_open(rnode, rnode_sz,
-							    tree, seg, &b_op,
-							    NULL));
-		M0_ASSERT(rc == 0);
+	/**
+	 * Confirm root node on BE segment is valid and the opaque pointer in
+	 * the node is NULL.
+	 */
+	rnode_segaddr.as_core = (uint64_t)rnode;
+	nt = btree_node_format[segaddr_ntype_get(&rnode_segaddr)];
+	M0_ASSERT(nt->nt_isvalid(&rnode_segaddr) &&
+		  nt->nt_opaque_get(&rnode_segaddr) == NULL);
 
-		ut_cb.c_act = ut_btree_kv_get_cb;
-		for (i = 1; i <= rec_count; i++) {
-			value = key = i;
+	/** Re-map the BE segment.*/
+	m0_be_seg_close(ut_seg->bus_seg);
+	rc = madvise(rnode, rnode_sz, MADV_NORMAL);
+	M0_ASSERT(rc == -1 && errno == ENOMEM); /** Assert BE segment unmapped*/
+	m0_be_seg_open(ut_seg->bus_seg);
+
+	/** Confirm nodes on BE segment are still valid. */
+	rnode_segaddr.as_core = (uint64_t)rnode;
+	validate_nodes_on_be_segment(&rnode_segaddr);
+
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+				      m0_btree_open(rnode, rnode_sz, tree, seg,
+						    &b_op, NULL));
+	M0_ASSERT(rc == 0);
+
+	get_data.key            = &rec.r_key;
+	get_data.value          = &rec.r_val;
+	get_data.check_value    = true;
+	get_data.crc            = M0_BCT_NO_CRC;
+	get_data.embedded_ksize = false;
+	get_data.embedded_vsize = false;
+
+	for (i = 1; i <= rec_count; i++) {
+		int                  k;
+		uint64_t             f_key;
+		void                *f_key_ptr  = &f_key;
+		m0_bcount_t          f_key_size  = sizeof f_key;
+		struct m0_btree_key  key_in_tree;
+
+		f_key = m0_byteorder_cpu_to_be64(i);
+		key_in_tree.k_data =
+				    M0_BUFVEC_INIT_BUF(&f_key_ptr, &f_key_size);
+		ut_cb.c_act             = ut_btree_kv_get_cb;
+		ut_cb.c_datum           = &get_data;
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_get(tree,
+							   &key_in_tree,
+							   &ut_cb, BOF_EQUAL,
+							   &kv_op));
+		M0_ASSERT((i % 2 != 0 && rc == M0_BSC_SUCCESS) ||
+			  (i % 2 == 0 && rc == M0_ERR(-ENOENT)));
+
+		if (i % 2 != 0) {
+			cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+			m0_btree_del_credit(tree, 1, ksize, vsize, &cred);
+
+			m0_be_ut_tx_init(tx, ut_be);
+			m0_be_tx_prep(tx, &cred);
+			rc = m0_be_tx_open_sync(tx);
+			M0_ASSERT(rc == 0);
+
+			ut_cb.c_act             = ut_btree_kv_del_cb;
+			ut_cb.c_datum           = &get_data;
+
+			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+						      m0_btree_del(tree,
+								   &key_in_tree,
+								   &ut_cb,
+								   &kv_op, tx));
+			M0_ASSERT(rc == 0);
+			m0_be_tx_close_sync(tx);
+			m0_be_tx_fini(tx);
+		} else {
+			cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+			m0_btree_put_credit(tree, 1, ksize, vsize, &cred);
+
+			m0_be_ut_tx_init(tx, ut_be);
+			m0_be_tx_prep(tx, &cred);
+			rc = m0_be_tx_open_sync(tx);
+			M0_ASSERT(rc == 0);
+
+			key = m0_byteorder_cpu_to_be64(i);
+			for (k = 0; k < ARRAY_SIZE(value); k++)
+				value[k] = key;
+
+			ut_cb.c_act        = ut_btree_kv_put_cb;
+			ut_cb.c_datum      = &put_data;
 
 			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-						      m0_btree_get(tree,
-								   &rec.r_key,
+						      m0_btree_put(tree, &rec,
 								   &ut_cb,
-								   BOF_EQUAL,
-								   &kv_op));
-			M0_ASSERT(data.flags == M0_BSC_SUCCESS && rc == 0);
+								   &kv_op, tx));
+			M0_ASSERT(rc == 0 && put_data.flags == M0_BSC_SUCCESS);
+			m0_be_tx_close_sync(tx);
+			m0_be_tx_fini(tx);
 		}
+	}
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-					      m0_btree_close(tree, &b_op));
-		M0_ASSERT(rc == 0);
-		M0_SET0(&btree);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_close(tree, &b_op));
+	M0_ASSERT(rc == 0);
+	M0_SET0(&btree);
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-					      m0_btree_open(rnode, rnode_sz,
-							    tree, seg, &b_op,
-							    NULL));
-		M0_ASSERT(rc == 0);
+	/**
+	 * Confirm root node on BE segment is valid and the opaque pointer in
+	 * the node is NULL.
+	 */
+	rnode_segaddr.as_core = (uint64_t)rnode;
+	nt = btree_node_format[segaddr_ntype_get(&rnode_segaddr)];
+	M0_ASSERT(nt->nt_isvalid(&rnode_segaddr) &&
+		  nt->nt_opaque_get(&rnode_segaddr) == NULL);
 
-		ut_cb.c_act = ut_btree_kv_del_cb;
+	/** Re-map the BE segment.*/
+	m0_be_seg_close(ut_seg->bus_seg);
+	rc = madvise(rnode, rnode_sz, MADV_NORMAL);
+	M0_ASSERT(rc == -1 && errno == ENOMEM); /** Assert BE segment unmapped*/
+	m0_be_seg_open(ut_seg->bus_seg);
 
-		cred = M0_BE_TX_CREDIT(0, 0);
-		m0_btree_del_credit(tree, 1, ksize, -1, &cred);
-		for (i = 1; i <= rec_count; i++) {
-			value = key = i;
+	/** Confirm nodes on BE segment are still valid. */
+	rnode_segaddr.as_core = (uint64_t)rnode;
+	validate_nodes_on_be_segment(&rnode_segaddr);
+
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+				      m0_btree_open(rnode, rnode_sz, tree, seg,
+						    &b_op, NULL));
+	M0_ASSERT(rc == 0);
+
+	get_data.key            = &rec.r_key;
+	get_data.value          = &rec.r_val;
+	get_data.check_value    = true;
+	get_data.embedded_ksize = false;
+	get_data.embedded_vsize = false;
+
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_btree_del_credit(tree, 1, ksize, vsize, &cred);
+
+	for (i = 1; i <= rec_count; i++) {
+		uint64_t             f_key;
+		void                *f_key_ptr  = &f_key;
+		m0_bcount_t          f_key_size  = sizeof f_key;
+		struct m0_btree_key  key_in_tree;
+
+		f_key = m0_byteorder_cpu_to_be64(i);
+		key_in_tree.k_data =
+				    M0_BUFVEC_INIT_BUF(&f_key_ptr, &f_key_size);
+		ut_cb.c_act        = ut_btree_kv_get_cb;
+		ut_cb.c_datum      = &get_data;
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_get(tree,
+							   &key_in_tree,
+							   &ut_cb, BOF_EQUAL,
+							   &kv_op));
+		M0_ASSERT((i % 2 == 0 && rc == M0_BSC_SUCCESS) ||
+			  (i % 2 != 0 && rc == M0_ERR(-ENOENT)));
 
+		if (i % 2 == 0) {
 			m0_be_ut_tx_init(tx, ut_be);
 			m0_be_tx_prep(tx, &cred);
 			rc = m0_be_tx_open_sync(tx);
 			M0_ASSERT(rc == 0);
 
+			ut_cb.c_act             = ut_btree_kv_del_cb;
+			ut_cb.c_datum           = &get_data;
+
 			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
 						      m0_btree_del(tree,
-								   &rec.r_key,
+								   &key_in_tree,
 								   &ut_cb,
 								   &kv_op, tx));
-			M0_ASSERT(data.flags == M0_BSC_SUCCESS && rc == 0);
+			M0_ASSERT(rc == 0);
 			m0_be_tx_close_sync(tx);
 			m0_be_tx_fini(tx);
 		}
+	}
 
-		cred = M0_BE_TX_CREDIT(0, 0);
-		m0_btree_destroy_credit(tree, NULL, &cred, 1);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_close(tree, &b_op));
+	M0_ASSERT(rc == 0);
+	M0_SET0(&btree);
+	/**
+	 * Confirm root node on BE segment is valid and the opaque pointer in
+	 * the node is NULL.
+	 */
+	rnode_segaddr.as_core = (uint64_t)rnode;
+	nt = btree_node_format[segaddr_ntype_get(&rnode_segaddr)];
+	M0_ASSERT(nt->nt_isvalid(&rnode_segaddr) &&
+		  nt->nt_opaque_get(&rnode_segaddr) == NULL);
 
-		m0_be_ut_tx_init(tx, ut_be);
-		m0_be_tx_prep(tx, &cred);
-		rc = m0_be_tx_open_sync(tx);
-		M0_ASSERT(rc == 0);
+	/** Re-map the BE segment.*/
+	m0_be_seg_close(ut_seg->bus_seg);
+	rc = madvise(rnode, rnode_sz, MADV_NORMAL);
+	M0_ASSERT(rc == -1 && errno == ENOMEM); /** Assert BE segment unmapped*/
+	m0_be_seg_open(ut_seg->bus_seg);
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-					      m0_btree_destroy(tree,
-							       &b_op, tx));
-		M0_ASSERT(rc == 0);
-		M0_SET0(&btree);
+	/** Confirm nodes on BE segment are still valid. */
+	rnode_segaddr.as_core = (uint64_t)rnode;
+	validate_nodes_on_be_segment(&rnode_segaddr);
 
-		m0_be_tx_close_sync(tx);
-		m0_be_tx_fini(tx);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+				      m0_btree_open(rnode, rnode_sz, tree, seg,
+						    &b_op, NULL));
+	M0_ASSERT(rc == 0);
 
-		/** Error Case */
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-					      m0_btree_open(rnode, rnode_sz,
-							    tree, seg, &b_op,
-							    NULL));
-		M0_ASSERT(rc == -EINVAL);
+	get_data.key            = &rec.r_key;
+	get_data.value          = &rec.r_val;
+	get_data.check_value    = true;
+	get_data.embedded_ksize = false;
+	get_data.embedded_vsize = false;
+
+	for (i = 1; i <= rec_count; i++) {
+		uint64_t            f_key;
+		void                *f_key_ptr  = &f_key;
+		m0_bcount_t         f_key_size  = sizeof f_key;
+		struct m0_btree_key key_in_tree;
+
+		f_key = m0_byteorder_cpu_to_be64(i);
+		key_in_tree.k_data =
+				     M0_BUFVEC_INIT_BUF(&f_key_ptr, &f_key_size);
+		ut_cb.c_act        = ut_btree_kv_get_cb;
+		ut_cb.c_datum      = &get_data;
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_get(tree,
+							   &key_in_tree,
+							   &ut_cb, BOF_EQUAL,
+							   &kv_op));
+		M0_ASSERT(rc == M0_ERR(-ENOENT));
 	}
 
-	m0_atomic64_dec(&threads_running);
 	cred = M0_BE_TX_CREDIT(0, 0);
-	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
-			       rnode_sz_shift, &cred);
+	m0_btree_destroy_credit(tree, NULL, &cred, 1);
 
 	m0_be_ut_tx_init(tx, ut_be);
 	m0_be_tx_prep(tx, &cred);
 	rc = m0_be_tx_open_sync(tx);
 	M0_ASSERT(rc == 0);
 
-	/** Delete temp node space which was used as root node for the tree. */
-	buf = M0_BUF_INIT(rnode_sz, rnode);
-	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(tree, &b_op, tx));
+	M0_ASSERT(rc == 0);
+	M0_SET0(&btree);
 
 	m0_be_tx_close_sync(tx);
 	m0_be_tx_fini(tx);
 
-	m0_be_ut_backend_thread_exit(ut_be);
-}
-
-static void btree_ut_num_threads_tree_oper(uint32_t thread_count)
-{
-	uint16_t                    *cpuid_ptr;
-	uint16_t                     cpu_count;
-	size_t                       cpu_max;
-	struct btree_ut_thread_info *ti;
-	uint16_t                     cpu;
-	int                          i;
-	int                          rc;
-	time_t                       curr_time;
-
-	M0_ENTRY();
-
-	time(&curr_time);
-	M0_LOG(M0_INFO, "Using seed %lu", curr_time);
-	srandom(curr_time);
-
-	btree_ut_init();
-	online_cpu_id_get(&cpuid_ptr, &cpu_count);
-
-	if (thread_count == 0)
-		thread_count = cpu_count - 1; /** Skip Core-0 */
-	else if (thread_count == RANDOM_THREAD_COUNT) {
-		thread_count = 1;
-		if (cpu_count > 2) {
-			/**
-			 *  Avoid the extreme cases i.e. thread_count
-			 *  cannot be 1 or cpu_count - 1
-			 */
-			thread_count = (random() % (cpu_count - 2)) + 1;
-		}
-	}
-
-	UT_STOP_THREADS();
-	m0_atomic64_set(&threads_running, 0);
-	m0_atomic64_set(&threads_quiesced, 0);
-
-	M0_ALLOC_ARR(ti, thread_count);
-	M0_ASSERT(ti != NULL);
-
-	cpu_max = m0_processor_nr_max();
-
-	cpu = 1; /** We skip Core-0 for Linux kernel and other processes. */
-	for (i = 0; i < thread_count; i++) {
-		rc = m0_bitmap_init(&ti[i].ti_cpu_map, cpu_max);
-		m0_bitmap_set(&ti[i].ti_cpu_map, cpuid_ptr[cpu], true);
-		cpu++;
-		if (cpu >= cpu_count)
-			/**
-			 *  Circle around if thread count is higher than the
-			 *  CPU cores in the system.
-			 */
-			cpu = 1;
-
-		ti[i].ti_thread_id  = i;
-	}
-
-	for (i = 0; i < thread_count; i++) {
-		rc = M0_THREAD_INIT(&ti[i].ti_q, struct btree_ut_thread_info *,
-				    btree_ut_thread_init,
-				    &btree_ut_tree_oper_thread_handler, &ti[i],
-				    "Thread-%d", i);
-		M0_ASSERT(rc == 0);
-	}
-
-	/** Initialized all the threads. Now start the chaos ... */
-	UT_START_THREADS();
-
-	for (i = 0; i < thread_count; i++) {
-		m0_thread_join(&ti[i].ti_q);
-		m0_thread_fini(&ti[i].ti_q);
-	}
+	/** Re-map the BE segment.*/
+	m0_be_seg_close(ut_seg->bus_seg);
+	rc = madvise(rnode, rnode_sz, MADV_NORMAL);
+	M0_ASSERT(rc == -1 && errno == ENOMEM); /** Assert BE segment unmapped*/
+	m0_be_seg_open(ut_seg->bus_seg);
 
-	m0_free0(&cpuid_ptr);
-	m0_free(ti);
-	btree_ut_fini();
-}
 
-static void ut_st_tree_oper(void)
-{
-	btree_ut_num_threads_tree_oper(1);
-}
+	/**
+	 * Confirm root node on BE segment is not valid and the opaque
+	 * pointer in the node is NULL.
+	 */
+	rnode_segaddr.as_core = (uint64_t)rnode;
+	nt = btree_node_format[segaddr_ntype_get(&rnode_segaddr)];
+	M0_ASSERT(!nt->nt_isvalid(&rnode_segaddr) &&
+		  nt->nt_opaque_get(&rnode_segaddr) == NULL);
 
-static void ut_mt_tree_oper(void)
-{
-	btree_ut_num_threads_tree_oper(0);
-}
-/**
- * Note that tree is ASSUMED to be closed before calling this function.
- */
-static bool validate_nodes_on_be_segment(struct segaddr *rnode_segaddr)
-{
-	const struct node_type     *nt;
-	struct {
-		struct segaddr node_segaddr;
-		uint16_t       rec_idx;
-		}                   stack[MAX_TREE_HEIGHT + 1];
-	uint32_t                    stack_level = 0;
-	struct nd                   n;
-	struct slot                 s       = { .s_node = &n };
-	uint16_t                    rec_idx = 0;
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+				      m0_btree_open(rnode, rnode_sz, tree, seg,
+						    &b_op, NULL));
+	M0_ASSERT(rc == -EINVAL);
 
-	nt = btree_node_format[segaddr_ntype_get(rnode_segaddr)];
-	n.n_addr = *rnode_segaddr;
-	#if (AVOID_BE_SEGMENT == 0)
-		M0_ASSERT(nt->nt_opaque_get(&n.n_addr) == NULL);
-	#endif
 
-	while (true) {
-		/**
-		 * Move down towards leaf node only if we have child nodes still
-		 * to traverse.
-		 */
-		if (nt->nt_level(&n) > 0 &&
-		    rec_idx < nt->nt_rec_count(&n)) {
-			stack[stack_level].node_segaddr = n.n_addr,
-			stack[stack_level].rec_idx      = rec_idx,
-			stack_level++;
-			s.s_idx = rec_idx;
-			nt->nt_child(&s, &n.n_addr);
-			n.n_addr.as_core = (uint64_t)segaddr_addr(&n.n_addr);
-			#if (AVOID_BE_SEGMENT == 0)
-				M0_ASSERT(nt->nt_opaque_get(&n.n_addr) == NULL);
-			#endif
-			rec_idx = 0;
-			continue;
-		}
+	/** Delete temp node space which was used as root node for the tree. */
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
 
-		/**
-		 * We are at the leaf node. Validate it before going back to
-		 * parent.
-		 */
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
 
-		M0_ASSERT(nt->nt_isvalid(&n.n_addr));
-#if (AVOID_BE_SEGMENT == 0)
-		M0_ASSERT(nt->nt_opaque_get(&n.n_addr) == NULL);
-#endif
-		if (stack_level == 0)
-			break;
+	buf = M0_BUF_INIT(rnode_sz, rnode);
+	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
 
-		/**
-		 * Start moving up towards parent (or grand-parent) till we find
-		 * an ancestor whose child nodes are still to be traversed. If
-		 * we find an ancestor whose child nodes are still to be
-		 * traversed then we pick the next child node on the right.
-		 */
-		do {
-			stack_level--;
-			rec_idx  = stack[stack_level].rec_idx + 1;
-			n.n_addr = stack[stack_level].node_segaddr;
-		} while (rec_idx >= nt->nt_rec_count(&n) &&
-			 stack_level > 0);
-	}
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
 
-	return true;
+	btree_ut_fini();
 }
 
-/**
- * This unit test exercises different KV operations and confirms the changes
- * persist across cluster reboots.
- */
-static void ut_btree_persistence(void)
+static void ut_btree_truncate(void)
 {
 	void                        *rnode;
 	int                          i;
@@ -11670,8 +13748,6 @@ static void ut_btree_persistence(void)
 						     .ksize = sizeof(uint64_t),
 						     .vsize = bt.ksize * 2,
 						};
-	const struct node_type     *nt;
-	struct segaddr              rnode_segaddr;
 	uint64_t                    key;
 	uint64_t                    value[bt.vsize / sizeof(uint64_t)];
 	m0_bcount_t                 ksize           = sizeof key;
@@ -11689,39 +13765,178 @@ static void ut_btree_persistence(void)
 			    .r_crc_type   = M0_BCT_NO_CRC,
 			};
 	struct ut_cb_data           put_data;
-	struct ut_cb_data           get_data;
+	m0_bcount_t                 limit;
 
 	M0_ENTRY();
 
-	rec_count = (rec_count / 2) * 2; /** Make rec_count a multiple of 2 */
-
 	btree_ut_init();
+
+	M0_ASSERT(rnode_sz != 0 && m0_is_po2(rnode_sz));
+	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_create_credit(&bt, &cred, 1);
+
+	/** Prepare transaction to capture tree operations. */
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+
+	/** Create temp node space and use it as root node for btree */
+	buf = M0_BUF_INIT(rnode_sz, NULL);
+	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	rnode = buf.b_addr;
+
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(rnode, rnode_sz,
+							     &bt,
+							     M0_BCT_NO_CRC,
+							     &b_op, &btree, seg,
+							     &fid, tx, NULL));
+	M0_ASSERT(rc == M0_BSC_SUCCESS);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+
+	tree = b_op.bo_arbor;
+
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_btree_put_credit(tree, 1, ksize, vsize, &cred);
+
+	put_data.key       = &rec.r_key;
+	put_data.value     = &rec.r_val;
+
+	ut_cb.c_act        = ut_btree_kv_put_cb;
+	ut_cb.c_datum      = &put_data;
+
+	for (i = 1; i <= rec_count; i++) {
+		int      k;
+
+		key = m0_byteorder_cpu_to_be64(i);
+		for (k = 0; k < ARRAY_SIZE(value); k++)
+			value[k] = key;
+
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_put(tree, &rec,
+							   &ut_cb,
+							   &kv_op, tx));
+		M0_ASSERT(rc == 0 && put_data.flags == M0_BSC_SUCCESS);
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+	}
+
 	/**
-	 *  Run the following scenario:
-	 *  1) Create a btree
-	 *  2) Add records in the created tree.
-	 *  3) Reload the BE segment.
-	 *  4) Confirm all the records are present in the tree.
-	 *  5) Delete records with EVEN numbered Keys.
-	 *  6) Reload the BE segment.
-	 *  7) Confirm all the records with EVEN numbered Keys are missing while
-	 *     the records with ODD numbered Keys are present in the tree.
-	 *  8) Now add back records with EVEN numbered Keys (the same records
-	 *     which were deleted in step 6)
-	 *  9) Delete records with ODD numbered Keys from the btree.
-	 * 10) Reload the BE segment.
-	 * 11) Confirm records with EVEN numbered Keys are present while the
-	 *     records with ODD numbered Keys are missing from the tree.
-	 * 12) Delete all records with EVEN numbered Keys from the tree.
-	 * 13) Reload the BE segment.
-	 * 14) Search for the records with all the EVEN and ODD numbered Keys,
-	 *     no record should be found in the tree.
-	 * 15) Destroy the btree
-	 * 16) Reload the BE segment.
-	 * 17) Try to open the destroyed tree. This should fail.
+	 * The test assumes that "limit" will be more than the total number of
+	 * nodes present in the record. Hence only one function call to
+	 * m0_btree_truncate is sufficient.
+	 */
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_btree_truncate_credit(tx, tree, &cred, &limit);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+				      m0_btree_truncate(tree, limit, tx,
+							&kv_op));
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+
+	/** Verify the tree is empty */
+	M0_ASSERT(m0_btree_is_empty(tree));
+
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_destroy_credit(tree, NULL, &cred, 1);
+
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(tree, &b_op, tx));
+	M0_ASSERT(rc == 0);
+	M0_SET0(&btree);
+
+	/** Delete temp node space which was used as root node for the tree. */
+	buf = M0_BUF_INIT(rnode_sz, rnode);
+	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+
+	btree_ut_fini();
+}
+
+static void ut_lru_test(void)
+{
+	void                       *rnode;
+	int                         i;
+	int64_t                     mem_after_alloc;
+	int64_t                     mem_init;
+	int64_t                     mem_increased;
+	int64_t                     mem_freed;
+	int64_t                     mem_after_free;
+	uint64_t                    hot_nr;
+	struct m0_btree_cb          ut_cb;
+	struct m0_be_tx             tx_data         = {};
+	struct m0_be_tx            *tx              = &tx_data;
+	struct m0_be_tx_credit      cred            = {};
+	struct m0_btree_op          b_op            = {};
+	uint64_t                    rec_count       = MAX_RECS_PER_STREAM*50;
+	struct m0_btree_op          kv_op           = {};
+	struct m0_btree            *tree;
+	struct m0_btree             btree;
+	const struct m0_btree_type  bt              = {
+						     .tt_id = M0_BT_UT_KV_OPS,
+						     .ksize = sizeof(uint64_t),
+						     .vsize = bt.ksize * 2,
+						};
+	uint64_t                    key;
+	uint64_t                    value[bt.vsize / sizeof(uint64_t)];
+	m0_bcount_t                 ksize           = sizeof key;
+	m0_bcount_t                 vsize           = sizeof value;
+	void                       *k_ptr           = &key;
+	void                       *v_ptr           = &value;
+	int                         rc;
+	struct m0_buf               buf;
+	uint32_t                    rnode_sz        = m0_pagesize_get();
+	struct m0_fid               fid             = M0_FID_TINIT('b', 0, 1);
+	uint32_t                    rnode_sz_shift;
+	struct m0_btree_rec         rec             = {
+			    .r_key.k_data = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize),
+			    .r_val        = M0_BUFVEC_INIT_BUF(&v_ptr, &vsize),
+			};
+	struct ut_cb_data           put_data;
+	bool                        restart_test    = false;
+	int                         retry_cnt       = 0;
+	m0_bcount_t                 limit;
+	/**
+	 * In this UT, we are testing the functionality of LRU list purge and
+	 * be-allocator with chunk align parameter.
 	 *
-	 *  Capture each operation in a separate transaction.
+	 * 1. Allocate and fill up the btree with multiple records.
+	 * 2. Verify the size increase in memory. If size increase in memory is
+	 *    negative then go to step 5 and restart the test (step 1).
+	 * 3. Use the m0_btree_lrulist_purge() to reduce the size by freeing up
+	 *    the unused nodes present in LRU list.
+	 * 4. Verify the reduction in size.
+	 * 5. Cleanup btree and allocated resources.
 	 */
+	M0_ENTRY();
+
+	btree_ut_init();
+
+start_lru_test:
+	mem_init = sysconf(_SC_AVPHYS_PAGES) * sysconf(_SC_PAGESIZE);
+	M0_LOG(M0_INFO,"Mem Init (%"PRId64").\n",mem_init);
 
 	M0_ASSERT(rnode_sz != 0 && m0_is_po2(rnode_sz));
 	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
@@ -11730,13 +13945,13 @@ static void ut_btree_persistence(void)
 			       rnode_sz_shift, &cred);
 	m0_btree_create_credit(&bt, &cred, 1);
 
-	/** Prepare transaction to capture tree operations. */
+	/* Prepare transaction to capture tree operations. */
 	m0_be_ut_tx_init(tx, ut_be);
 	m0_be_tx_prep(tx, &cred);
 	rc = m0_be_tx_open_sync(tx);
 	M0_ASSERT(rc == 0);
 
-	/** Create temp node space and use it as root node for btree */
+	/* Create temp node space and use it as root node for btree */
 	buf = M0_BUF_INIT(rnode_sz, NULL);
 	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
 	rnode = buf.b_addr;
@@ -11744,7 +13959,7 @@ static void ut_btree_persistence(void)
 	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(rnode, rnode_sz,
 							     &bt,
 							     M0_BCT_NO_CRC,
-							     &b_op, &btree,seg,
+							     &b_op, &btree, seg,
 							     &fid, tx, NULL));
 	M0_ASSERT(rc == M0_BSC_SUCCESS);
 	m0_be_tx_close_sync(tx);
@@ -11782,420 +13997,418 @@ static void ut_btree_persistence(void)
 		m0_be_tx_fini(tx);
 	}
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_close(tree, &b_op));
-	M0_ASSERT(rc == 0);
-	M0_SET0(&btree);
-
-	/**
-	 * Confirm root node on BE segment is valid and the opaque pointer in
-	 * the node is NULL.
-	 */
-	rnode_segaddr.as_core = (uint64_t)rnode;
-	nt = btree_node_format[segaddr_ntype_get(&rnode_segaddr)];
-	M0_ASSERT(nt->nt_isvalid(&rnode_segaddr) &&
-		  nt->nt_opaque_get(&rnode_segaddr) == NULL);
-
-
-	/** Re-map the BE segment.*/
-	m0_be_seg_close(ut_seg->bus_seg);
-	rc = madvise(rnode, rnode_sz, MADV_NORMAL);
-	M0_ASSERT(rc == -1 && errno == ENOMEM); /** Assert BE segment unmapped*/
-	m0_be_seg_open(ut_seg->bus_seg);
-
-	/** Confirm nodes on BE segment are still valid. */
-	rnode_segaddr.as_core = (uint64_t)rnode;
-	validate_nodes_on_be_segment(&rnode_segaddr);
-
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-				      m0_btree_open(rnode, rnode_sz, tree, seg,
-						    &b_op, NULL));
-	M0_ASSERT(rc == 0);
-
-	get_data.key            = &rec.r_key;
-	get_data.value          = &rec.r_val;
-	get_data.check_value    = true;
-	get_data.crc            = M0_BCT_NO_CRC;
-	get_data.embedded_ksize = false;
-	get_data.embedded_vsize = false;
-
-	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-	m0_btree_del_credit(tree, 1, ksize, vsize, &cred);
-
-	for (i = 1; i <= rec_count; i++) {
-		uint64_t             f_key;
-		void                *f_key_ptr  = &f_key;
-		m0_bcount_t          f_key_size  = sizeof f_key;
-		struct m0_btree_key  key_in_tree;
-
-		f_key = m0_byteorder_cpu_to_be64(i);
-		key_in_tree.k_data =
-				    M0_BUFVEC_INIT_BUF(&f_key_ptr, &f_key_size);
-		ut_cb.c_act             = ut_btree_kv_get_cb;
-		ut_cb.c_datum           = &get_data;
-
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_get(tree,
-							   &key_in_tree,
-							   &ut_cb, BOF_EQUAL,
-							   &kv_op));
-		M0_ASSERT(rc == M0_BSC_SUCCESS &&
-			  i == m0_byteorder_be64_to_cpu(key));
+	mem_after_alloc = sysconf(_SC_AVPHYS_PAGES) * sysconf(_SC_PAGESIZE);
+	mem_increased   = mem_init - mem_after_alloc;
+	if (mem_increased < 0) {
+		restart_test = true;
+		retry_cnt++;
+		M0_LOG(M0_INFO, "Memory increased is negative because "
+				"Mem After Alloc (%"PRId64") is greater than "
+				"Mem Init (%"PRId64"), This can "
+				"happen due to other processes in system "
+				"might have released memory, hence cleaning up "
+				"the records and restarting the test.",
+				mem_after_alloc, mem_init);
 
-		if (i % 2 == 0) {
-			m0_be_ut_tx_init(tx, ut_be);
-			m0_be_tx_prep(tx, &cred);
-			rc = m0_be_tx_open_sync(tx);
-			M0_ASSERT(rc == 0);
+		/* Cleanup records and tree then restart the test. */
+		if (retry_cnt < MAX_TEST_RETRIES)
+			goto cleanup;
+		else
+			M0_ASSERT_INFO(mem_increased > 0,
+				       "Memory is still getting freed, hence "
+				       "exiting test with failure.");
+	}
 
-			ut_cb.c_act             = ut_btree_kv_del_cb;
-			ut_cb.c_datum           = &get_data;
+	M0_LOG(M0_INFO, "Mem After Alloc (%"PRId64") || Mem Increase (%"PRId64").\n",
+			 mem_after_alloc, mem_increased);
 
-			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-						      m0_btree_del(tree,
-								   &key_in_tree,
-								   &ut_cb,
-								   &kv_op, tx));
-			M0_ASSERT(rc == 0);
-			m0_be_tx_close_sync(tx);
-			m0_be_tx_fini(tx);
-		}
-	}
+	M0_ASSERT(ndlist_tlist_length(&btree_lru_nds) +
+		  ndlist_tlist_length(&btree_lru_hot_nds) > 0);
+	M0_ASSERT(m0_tl_forall(ndlist, n, &btree_lru_nds,
+			       bnode_level(n) == 0));
+	hot_nr         = ndlist_tlist_length(&btree_lru_hot_nds);
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_close(tree, &b_op));
-	M0_ASSERT(rc == 0);
-	M0_SET0(&btree);
+	mem_freed      = m0_btree_lrulist_purge(mem_increased/2, 0);
+	/** Hot nodes are freed only after all the other LRU nodes. */
+	M0_ASSERT(ndlist_tlist_length(&btree_lru_hot_nds) == hot_nr ||
+		  ndlist_tlist_is_empty(&btree_lru_nds));
+	mem_after_free = sysconf(_SC_AVPHYS_PAGES) * sysconf(_SC_PAGESIZE);
+	M0_LOG(M0_INFO, "Mem After Free (%"PRId64") || Mem freed (%"PRId64").\n",
+			 mem_after_free, mem_freed);
 
+cleanup:
 	/**
-	 * Confirm root node on BE segment is valid and the opaque pointer in
-	 * the node is NULL.
+	 * The test assumes that "limit" will be more than the total number of
+	 * nodes present in the record. Hence only one function call to
+	 * m0_btree_truncate is sufficient.
 	 */
-	rnode_segaddr.as_core = (uint64_t)rnode;
-	nt = btree_node_format[segaddr_ntype_get(&rnode_segaddr)];
-	M0_ASSERT(nt->nt_isvalid(&rnode_segaddr) &&
-		  nt->nt_opaque_get(&rnode_segaddr) == NULL);
-
-	/** Re-map the BE segment.*/
-	m0_be_seg_close(ut_seg->bus_seg);
-	rc = madvise(rnode, rnode_sz, MADV_NORMAL);
-	M0_ASSERT(rc == -1 && errno == ENOMEM); /** Assert BE segment unmapped*/
-	m0_be_seg_open(ut_seg->bus_seg);
-
-	/** Confirm nodes on BE segment are still valid. */
-	rnode_segaddr.as_core = (uint64_t)rnode;
-	validate_nodes_on_be_segment(&rnode_segaddr);
-
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-				      m0_btree_open(rnode, rnode_sz, tree, seg,
-						    &b_op, NULL));
-	M0_ASSERT(rc == 0);
-
-	get_data.key            = &rec.r_key;
-	get_data.value          = &rec.r_val;
-	get_data.check_value    = true;
-	get_data.crc            = M0_BCT_NO_CRC;
-	get_data.embedded_ksize = false;
-	get_data.embedded_vsize = false;
-
-	for (i = 1; i <= rec_count; i++) {
-		int                  k;
-		uint64_t             f_key;
-		void                *f_key_ptr  = &f_key;
-		m0_bcount_t          f_key_size  = sizeof f_key;
-		struct m0_btree_key  key_in_tree;
-
-		f_key = m0_byteorder_cpu_to_be64(i);
-		key_in_tree.k_data =
-				    M0_BUFVEC_INIT_BUF(&f_key_ptr, &f_key_size);
-		ut_cb.c_act             = ut_btree_kv_get_cb;
-		ut_cb.c_datum           = &get_data;
-
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_get(tree,
-							   &key_in_tree,
-							   &ut_cb, BOF_EQUAL,
-							   &kv_op));
-		M0_ASSERT((i % 2 != 0 && rc == M0_BSC_SUCCESS) ||
-			  (i % 2 == 0 && rc == M0_ERR(-ENOENT)));
-
-		if (i % 2 != 0) {
-			cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-			m0_btree_del_credit(tree, 1, ksize, vsize, &cred);
-
-			m0_be_ut_tx_init(tx, ut_be);
-			m0_be_tx_prep(tx, &cred);
-			rc = m0_be_tx_open_sync(tx);
-			M0_ASSERT(rc == 0);
-
-			ut_cb.c_act             = ut_btree_kv_del_cb;
-			ut_cb.c_datum           = &get_data;
-
-			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-						      m0_btree_del(tree,
-								   &key_in_tree,
-								   &ut_cb,
-								   &kv_op, tx));
-			M0_ASSERT(rc == 0);
-			m0_be_tx_close_sync(tx);
-			m0_be_tx_fini(tx);
-		} else {
-			cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-			m0_btree_put_credit(tree, 1, ksize, vsize, &cred);
-
-			m0_be_ut_tx_init(tx, ut_be);
-			m0_be_tx_prep(tx, &cred);
-			rc = m0_be_tx_open_sync(tx);
-			M0_ASSERT(rc == 0);
-
-			key = m0_byteorder_cpu_to_be64(i);
-			for (k = 0; k < ARRAY_SIZE(value); k++)
-				value[k] = key;
-
-			ut_cb.c_act        = ut_btree_kv_put_cb;
-			ut_cb.c_datum      = &put_data;
-
-			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-						      m0_btree_put(tree, &rec,
-								   &ut_cb,
-								   &kv_op, tx));
-			M0_ASSERT(rc == 0 && put_data.flags == M0_BSC_SUCCESS);
-			m0_be_tx_close_sync(tx);
-			m0_be_tx_fini(tx);
-		}
-	}
-
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_close(tree, &b_op));
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_btree_truncate_credit(tx, tree, &cred, &limit);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
 	M0_ASSERT(rc == 0);
-	M0_SET0(&btree);
 
-	/**
-	 * Confirm root node on BE segment is valid and the opaque pointer in
-	 * the node is NULL.
-	 */
-	rnode_segaddr.as_core = (uint64_t)rnode;
-	nt = btree_node_format[segaddr_ntype_get(&rnode_segaddr)];
-	M0_ASSERT(nt->nt_isvalid(&rnode_segaddr) &&
-		  nt->nt_opaque_get(&rnode_segaddr) == NULL);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+				      m0_btree_truncate(tree, limit, tx,
+							&kv_op));
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
 
-	/** Re-map the BE segment.*/
-	m0_be_seg_close(ut_seg->bus_seg);
-	rc = madvise(rnode, rnode_sz, MADV_NORMAL);
-	M0_ASSERT(rc == -1 && errno == ENOMEM); /** Assert BE segment unmapped*/
-	m0_be_seg_open(ut_seg->bus_seg);
+	/* Verify the tree is empty */
+	M0_ASSERT(m0_btree_is_empty(tree));
 
-	/** Confirm nodes on BE segment are still valid. */
-	rnode_segaddr.as_core = (uint64_t)rnode;
-	validate_nodes_on_be_segment(&rnode_segaddr);
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_destroy_credit(tree, NULL, &cred, 1);
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-				      m0_btree_open(rnode, rnode_sz, tree, seg,
-						    &b_op, NULL));
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
 	M0_ASSERT(rc == 0);
 
-	get_data.key            = &rec.r_key;
-	get_data.value          = &rec.r_val;
-	get_data.check_value    = true;
-	get_data.embedded_ksize = false;
-	get_data.embedded_vsize = false;
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(tree, &b_op, tx));
+	M0_ASSERT(rc == 0);
+	M0_SET0(&btree);
 
-	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-	m0_btree_del_credit(tree, 1, ksize, vsize, &cred);
+	/* Delete temp node space which was used as root node for the tree. */
+	buf = M0_BUF_INIT(rnode_sz, rnode);
+	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
 
-	for (i = 1; i <= rec_count; i++) {
-		uint64_t             f_key;
-		void                *f_key_ptr  = &f_key;
-		m0_bcount_t          f_key_size  = sizeof f_key;
-		struct m0_btree_key  key_in_tree;
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
 
-		f_key = m0_byteorder_cpu_to_be64(i);
-		key_in_tree.k_data =
-				    M0_BUFVEC_INIT_BUF(&f_key_ptr, &f_key_size);
-		ut_cb.c_act        = ut_btree_kv_get_cb;
-		ut_cb.c_datum      = &get_data;
+	if (restart_test) {
+		restart_test = false;
+		/* When restarting test, Re-map the BE segment. */
+		m0_be_seg_close(ut_seg->bus_seg);
+		rc = madvise(rnode, rnode_sz, MADV_NORMAL);
+		M0_ASSERT(rc == -1 && errno == ENOMEM);
+		m0_be_seg_open(ut_seg->bus_seg);
+		m0_nanosleep(m0_time(2, 0), NULL);
+		goto start_lru_test;
+	}
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_get(tree,
-							   &key_in_tree,
-							   &ut_cb, BOF_EQUAL,
-							   &kv_op));
-		M0_ASSERT((i % 2 == 0 && rc == M0_BSC_SUCCESS) ||
-			  (i % 2 != 0 && rc == M0_ERR(-ENOENT)));
+	btree_ut_fini();
+}
 
-		if (i % 2 == 0) {
-			m0_be_ut_tx_init(tx, ut_be);
-			m0_be_tx_prep(tx, &cred);
-			rc = m0_be_tx_open_sync(tx);
-			M0_ASSERT(rc == 0);
+/**
+ * This test launches multiple threads each of of which create different btree's
+ * which host records with different CRC type embedded within them.
+ */
+static void ut_btree_crc_test(void)
+{
+	int                         rc;
+	struct btree_ut_thread_info *ti;
+	int                         i;
+	uint16_t                    cpu;
+	void                        *rnode;
+	struct m0_btree_op          b_op           = {};
+	struct btree_crc_data {
+				struct m0_btree_type    bcr_btree_type;
+				enum m0_btree_crc_type  bcr_crc_type;
+			      } btrees_with_crc[] = {
+			{
+				{
+					BNT_FIXED_FORMAT, 2 * sizeof(uint64_t),
+					2 * sizeof(uint64_t)
+				},
+				M0_BCT_NO_CRC,
+			},
+			{
+				{
+					BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE,
+					2 * sizeof(uint64_t), RANDOM_VALUE_SIZE
+				},
+				M0_BCT_NO_CRC,
+			},
+			{
+				{
+					BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE,
+					RANDOM_KEY_SIZE, RANDOM_VALUE_SIZE
+				},
+				M0_BCT_NO_CRC,
+			},
+			{
+				{
+					BNT_FIXED_FORMAT, 2 * sizeof(uint64_t),
+					3 * sizeof(uint64_t)
+				},
+				M0_BCT_USER_ENC_RAW_HASH,
+			},
+			{
+				{
+					BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE,
+					2 * sizeof(uint64_t), RANDOM_VALUE_SIZE
+				},
+				M0_BCT_USER_ENC_RAW_HASH,
+			},
+			{
+				{
+					BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE,
+					RANDOM_KEY_SIZE, RANDOM_VALUE_SIZE
+				},
+				M0_BCT_USER_ENC_RAW_HASH,
+			},
+			{
+				{
+					BNT_FIXED_FORMAT, 2 * sizeof(uint64_t),
+					2 * sizeof(uint64_t)
+				},
+				M0_BCT_BTREE_ENC_RAW_HASH,
+			},
+			{
+				{
+					BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE,
+					2 * sizeof(uint64_t), RANDOM_VALUE_SIZE
+				},
+				M0_BCT_BTREE_ENC_RAW_HASH,
+			},
+			{
+				{
+					BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE,
+					RANDOM_KEY_SIZE, RANDOM_VALUE_SIZE
+				},
+				M0_BCT_BTREE_ENC_RAW_HASH,
+			},
+		};
+	uint16_t                    thread_count = ARRAY_SIZE(btrees_with_crc);
+	struct m0_be_tx_credit      cred;
+	struct m0_be_tx             tx_data        = {};
+	struct m0_be_tx             *tx            = &tx_data;
+	struct m0_fid               fid            = M0_FID_TINIT('b', 0, 1);
+	struct m0_buf               buf;
+	uint16_t                    *cpuid_ptr;
+	uint16_t                    cpu_count;
+	size_t                      cpu_max;
+	time_t                      curr_time;
+	uint32_t                    rnode_sz       = sysconf(_SC_PAGESIZE);
+	uint32_t                    rnode_sz_shift;
+	struct m0_btree             btree[thread_count];
 
-			ut_cb.c_act             = ut_btree_kv_del_cb;
-			ut_cb.c_datum           = &get_data;
+	M0_ENTRY();
 
-			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-						      m0_btree_del(tree,
-								   &key_in_tree,
-								   &ut_cb,
-								   &kv_op, tx));
-			M0_ASSERT(rc == 0);
-			m0_be_tx_close_sync(tx);
-			m0_be_tx_fini(tx);
-		}
-	}
+	M0_ASSERT(rnode_sz != 0 && m0_is_po2(rnode_sz));
+	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
+
+	M0_ALLOC_ARR(ti, thread_count);
+	M0_ASSERT(ti != NULL);
+
+	time(&curr_time);
+	M0_LOG(M0_INFO, "Using seed %lu", curr_time);
+	srandom(curr_time);
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_close(tree, &b_op));
-	M0_ASSERT(rc == 0);
-	M0_SET0(&btree);
 	/**
-	 * Confirm root node on BE segment is valid and the opaque pointer in
-	 * the node is NULL.
+	 *  1) Assign CPU cores to the threads.
+	 *  2) Create btree(s) to be used by all the threads.
+	 *  3) Init and Start the threads which do KV operations.
+	 *  4) Wait till all the threads are done.
+	 *  5) Close the btree
+	 *  6) Destroy the btree
 	 */
-	rnode_segaddr.as_core = (uint64_t)rnode;
-	nt = btree_node_format[segaddr_ntype_get(&rnode_segaddr)];
-	M0_ASSERT(nt->nt_isvalid(&rnode_segaddr) &&
-		  nt->nt_opaque_get(&rnode_segaddr) == NULL);
 
-	/** Re-map the BE segment.*/
-	m0_be_seg_close(ut_seg->bus_seg);
-	rc = madvise(rnode, rnode_sz, MADV_NORMAL);
-	M0_ASSERT(rc == -1 && errno == ENOMEM); /** Assert BE segment unmapped*/
-	m0_be_seg_open(ut_seg->bus_seg);
+	btree_ut_init();
 
-	/** Confirm nodes on BE segment are still valid. */
-	rnode_segaddr.as_core = (uint64_t)rnode;
-	validate_nodes_on_be_segment(&rnode_segaddr);
+	online_cpu_id_get(&cpuid_ptr, &cpu_count);
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-				      m0_btree_open(rnode, rnode_sz, tree, seg,
-						    &b_op, NULL));
-	M0_ASSERT(rc == 0);
+	UT_STOP_THREADS();
+	m0_atomic64_set(&threads_running, 0);
+	m0_atomic64_set(&threads_quiesced, 0);
 
-	get_data.key            = &rec.r_key;
-	get_data.value          = &rec.r_val;
-	get_data.check_value    = true;
-	get_data.embedded_ksize = false;
-	get_data.embedded_vsize = false;
+	M0_ALLOC_ARR(ti, thread_count);
+	M0_ASSERT(ti != NULL);
 
-	for (i = 1; i <= rec_count; i++) {
-		uint64_t            f_key;
-		void                *f_key_ptr  = &f_key;
-		m0_bcount_t         f_key_size  = sizeof f_key;
-		struct m0_btree_key key_in_tree;
+	cpu_max = m0_processor_nr_max();
 
-		f_key = m0_byteorder_cpu_to_be64(i);
-		key_in_tree.k_data =
-				     M0_BUFVEC_INIT_BUF(&f_key_ptr, &f_key_size);
-		ut_cb.c_act        = ut_btree_kv_get_cb;
-		ut_cb.c_datum      = &get_data;
+	cpu = 1; /** We skip Core-0 for Linux kernel and other processes. */
+	for (i = 0; i < thread_count; i++) {
+		enum m0_btree_crc_type  crc_type;
+		struct m0_btree_type    btree_type;
+
+		crc_type = btrees_with_crc[i].bcr_crc_type;
+		btree_type = btrees_with_crc[i].bcr_btree_type;
+
+		rc = m0_bitmap_init(&ti[i].ti_cpu_map, cpu_max);
+		m0_bitmap_set(&ti[i].ti_cpu_map, cpuid_ptr[cpu], true);
+		cpu++;
+		if (cpu >= cpu_count)
+			/**
+			 *  Circle around if thread count is higher than the
+			 *  CPU cores in the system.
+			 */
+			cpu = 1;
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_get(tree,
-							   &key_in_tree,
-							   &ut_cb, BOF_EQUAL,
-							   &kv_op));
-		M0_ASSERT(rc == M0_ERR(-ENOENT));
-	}
+		ti[i].ti_key_first  = 1;
+		ti[i].ti_key_count  = MAX_RECS_PER_THREAD;
+		ti[i].ti_key_incr   = 5;
+		ti[i].ti_thread_id  = i;
+		ti[i].ti_key_size   = btree_type.ksize;
+		ti[i].ti_value_size = btree_type.vsize;
+		ti[i].ti_crc_type   = crc_type;
+		ti[i].ti_random_bursts = (thread_count > 1);
+		do {
+			ti[i].ti_rng_seed_base = random();
+		} while (ti[i].ti_rng_seed_base == 0);
 
-	cred = M0_BE_TX_CREDIT(0, 0);
-	m0_btree_destroy_credit(tree, NULL, &cred, 1);
+		M0_SET0(&b_op);
 
-	m0_be_ut_tx_init(tx, ut_be);
-	m0_be_tx_prep(tx, &cred);
-	rc = m0_be_tx_open_sync(tx);
-	M0_ASSERT(rc == 0);
+		cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+		m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
+				       rnode_sz_shift, &cred);
+		m0_btree_create_credit(&btree_type, &cred, 1);
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(tree, &b_op, tx));
-	M0_ASSERT(rc == 0);
-	M0_SET0(&btree);
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
 
-	m0_be_tx_close_sync(tx);
-	m0_be_tx_fini(tx);
+		/** Create temp node space and use it as root node for btree */
+		buf = M0_BUF_INIT(rnode_sz, NULL);
+		M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+		rnode = buf.b_addr;
 
-	/** Re-map the BE segment.*/
-	m0_be_seg_close(ut_seg->bus_seg);
-	rc = madvise(rnode, rnode_sz, MADV_NORMAL);
-	M0_ASSERT(rc == -1 && errno == ENOMEM); /** Assert BE segment unmapped*/
-	m0_be_seg_open(ut_seg->bus_seg);
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+					      m0_btree_create(rnode, rnode_sz,
+							      &btree_type,
+							      crc_type, &b_op,
+							      &btree[i], seg,
+							      &fid, tx, NULL));
+		M0_ASSERT(rc == M0_BSC_SUCCESS);
 
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
 
-	/**
-	 * Confirm root node on BE segment is not valid and the opaque
-	 * pointer in the node is NULL.
-	 */
-	rnode_segaddr.as_core = (uint64_t)rnode;
-	nt = btree_node_format[segaddr_ntype_get(&rnode_segaddr)];
-	M0_ASSERT(!nt->nt_isvalid(&rnode_segaddr) &&
-		  nt->nt_opaque_get(&rnode_segaddr) == NULL);
+		ti[i].ti_tree = &btree[i];
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-				      m0_btree_open(rnode, rnode_sz, tree, seg,
-						    &b_op, NULL));
-	M0_ASSERT(rc == -EINVAL);
+		rc = M0_THREAD_INIT(&ti[i].ti_q, struct btree_ut_thread_info *,
+				    btree_ut_thread_init,
+				    &btree_ut_kv_oper_thread_handler, &ti[i],
+				    "Thread-%d", i);
+		M0_ASSERT(rc == 0);
+	}
 
+	/** Initialized all the threads. Now start the test ... */
+	UT_START_THREADS();
 
-	/** Delete temp node space which was used as root node for the tree. */
-	cred = M0_BE_TX_CREDIT(0, 0);
+	for (i = 0; i < thread_count; i++) {
+		m0_thread_join(&ti[i].ti_q);
+		m0_thread_fini(&ti[i].ti_q);
+	}
+
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
 	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
 			       rnode_sz_shift, &cred);
+	m0_btree_destroy_credit(&btree[0], NULL, &cred, 1);
+	for (i = 0; i < thread_count; i++) {
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
 
-	m0_be_ut_tx_init(tx, ut_be);
-	m0_be_tx_prep(tx, &cred);
-	rc = m0_be_tx_open_sync(tx);
-	M0_ASSERT(rc == 0);
-
-	buf = M0_BUF_INIT(rnode_sz, rnode);
-	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
-
-	m0_be_tx_close_sync(tx);
-	m0_be_tx_fini(tx);
+		rnode = segaddr_addr(&btree[i].t_desc->t_root->n_addr);
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+					      m0_btree_destroy(&btree[i],
+							       &b_op, tx));
+		M0_ASSERT(rc == 0);
+		M0_SET0(&btree[i]);
+		buf = M0_BUF_INIT(rnode_sz, rnode);
+		M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+	}
 
+	m0_free0(&cpuid_ptr);
+	m0_free(ti);
 	btree_ut_fini();
+
+	M0_LEAVE();
 }
 
-static void ut_btree_truncate(void)
+/**
+ * This unit test creates records in the nodes and then simulates the loading
+ * of those nodes across cluster reboots.
+ */
+static void ut_btree_crc_persist_test_internal(struct m0_btree_type   *bt,
+					       enum m0_btree_crc_type  crc_type)
 {
-	void                        *rnode;
-	int                          i;
-	struct m0_btree_cb           ut_cb;
-	struct m0_be_tx             tx_data         = {};
-	struct m0_be_tx            *tx              = &tx_data;
-	struct m0_be_tx_credit      cred            = {};
-	struct m0_btree_op          b_op            = {};
-	uint64_t                    rec_count       = MAX_RECS_PER_STREAM;
-	struct m0_btree_op          kv_op           = {};
+	void                       *rnode;
+	int                         i;
+	struct m0_btree_cb          ut_cb;
+	struct m0_be_tx             tx_data        = {};
+	struct m0_be_tx            *tx             = &tx_data;
+	struct m0_be_tx_credit      cred           = {};
+	struct m0_btree_op          b_op           = {};
+	uint64_t                    rec_count      = MAX_RECS_PER_STREAM;
+	struct m0_btree_op          kv_op          = {};
 	struct m0_btree            *tree;
 	struct m0_btree             btree;
-	const struct m0_btree_type  bt              = {
-						     .tt_id = M0_BT_UT_KV_OPS,
-						     .ksize = sizeof(uint64_t),
-						     .vsize = bt.ksize * 2,
-						};
 	uint64_t                    key;
-	uint64_t                    value[bt.vsize / sizeof(uint64_t)];
-	m0_bcount_t                 ksize           = sizeof key;
-	m0_bcount_t                 vsize           = sizeof value;
-	void                       *k_ptr           = &key;
-	void                       *v_ptr           = &value;
+	uint64_t                    value[VAL_ARR_ELE_COUNT];
+	uint64_t                    kdata;
+	m0_bcount_t                 ksize          = sizeof(key);
+	m0_bcount_t                 vsize          = sizeof(value);
+	void                       *k_ptr          = &key;
+	void                       *v_ptr          = &value;
 	int                         rc;
 	struct m0_buf               buf;
-	uint32_t                    rnode_sz        = m0_pagesize_get();
-	struct m0_fid               fid             = M0_FID_TINIT('b', 0, 1);
+	const struct node_type     *nt;
+	struct segaddr              rnode_segaddr;
+	uint32_t                    rnode_sz       = m0_pagesize_get();
+	struct m0_fid               fid            = M0_FID_TINIT('b', 0, 1);
 	uint32_t                    rnode_sz_shift;
-	struct m0_btree_rec         rec             = {
-			    .r_key.k_data = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize),
-			    .r_val        = M0_BUFVEC_INIT_BUF(&v_ptr, &vsize),
-			    .r_crc_type   = M0_BCT_NO_CRC,
-			};
+	struct m0_btree_rec         rec            = {
+				    .r_key.k_data  = M0_BUFVEC_INIT_BUF(&k_ptr,
+								       &ksize),
+				    .r_val         = M0_BUFVEC_INIT_BUF(&v_ptr,
+								       &vsize),
+				    .r_crc_type    = crc_type,
+						    };
 	struct ut_cb_data           put_data;
+	struct ut_cb_data           get_data;
 	m0_bcount_t                 limit;
 
+	M0_ASSERT(bt->ksize == RANDOM_VALUE_SIZE || bt->ksize == sizeof(key));
+	M0_ASSERT(bt->vsize == RANDOM_VALUE_SIZE ||
+		  (bt->vsize % sizeof(uint64_t) == 0 &&
+		   (((crc_type == M0_BCT_NO_CRC &&
+		     bt->vsize > sizeof(value[0])) ||
+		    (crc_type == M0_BCT_USER_ENC_RAW_HASH &&
+		     bt->vsize > sizeof(value[0]) * 2) ||
+		    (crc_type == M0_BCT_USER_ENC_FORMAT_FOOTER &&
+		     bt->vsize > (sizeof(value[0]) +
+				  sizeof(struct m0_format_header) +
+				  sizeof(struct m0_format_footer))) ||
+		    (crc_type == M0_BCT_BTREE_ENC_RAW_HASH &&
+		     bt->vsize > sizeof(value[0]))) &&
+		    bt->vsize <= sizeof(value))));
+
+	M0_CASSERT(VAL_ARR_ELE_COUNT > 1);
+
 	M0_ENTRY();
 
+	rec_count = (rec_count / 2) * 2; /** Make rec_count a multiple of 2 */
+
 	btree_ut_init();
+	/**
+	 *  Run the following scenario:
+	 *  1) Create a btree
+	 *  2) Add records in the created tree.
+	 *  3) Reload the BE segment.
+	 *  4) Confirm all the records are present in the tree and CRC matches.
+	 *  5) Modify the Value for all the records.
+	 *  6) Reload the BE segment.
+	 *  7) Confirm all the records are present in the tree and CRC matches.
+	 *
+	 *  Capture each operation in a separate transaction.
+	 */
 
 	M0_ASSERT(rnode_sz != 0 && m0_is_po2(rnode_sz));
 	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
 	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
 	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
 			       rnode_sz_shift, &cred);
-	m0_btree_create_credit(&bt, &cred, 1);
+	m0_btree_create_credit(bt, &cred, 1);
 
 	/** Prepare transaction to capture tree operations. */
 	m0_be_ut_tx_init(tx, ut_be);
@@ -12208,52 +14421,177 @@ static void ut_btree_truncate(void)
 	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
 	rnode = buf.b_addr;
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(rnode, rnode_sz,
-							     &bt,
-							     M0_BCT_NO_CRC,
-							     &b_op, &btree, seg,
-							     &fid, tx, NULL));
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+				      m0_btree_create(rnode, rnode_sz, bt,
+						      crc_type, &b_op, &btree,
+						      seg, &fid, tx, NULL));
 	M0_ASSERT(rc == M0_BSC_SUCCESS);
 	m0_be_tx_close_sync(tx);
 	m0_be_tx_fini(tx);
 
-	tree = b_op.bo_arbor;
+	tree = b_op.bo_arbor;
+
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_btree_put_credit(tree, 1, ksize, vsize, &cred);
+
+	put_data.key       = &rec.r_key;
+	put_data.value     = &rec.r_val;
+
+	ut_cb.c_act        = ut_btree_kv_put_cb;
+	ut_cb.c_datum      = &put_data;
+
+	for (i = 1; i <= rec_count; i++) {
+		key = m0_byteorder_cpu_to_be64(i);
+
+		vsize = bt->vsize == RANDOM_VALUE_SIZE ?
+			GET_RANDOM_VALSIZE(value, i, 1, 1, crc_type) :
+			bt->vsize;
+
+		FILL_VALUE(value, vsize, key, crc_type);
+
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_put(tree, &rec,
+							   &ut_cb,
+							   &kv_op, tx));
+		M0_ASSERT(rc == 0 && put_data.flags == M0_BSC_SUCCESS);
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+	}
+
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_close(tree, &b_op));
+	M0_ASSERT(rc == 0);
+	M0_SET0(&btree);
+
+	/**
+	 * Confirm root node on BE segment is valid and the opaque pointer in
+	 * the node is NULL.
+	 */
+	rnode_segaddr.as_core = (uint64_t)rnode;
+	nt = btree_node_format[segaddr_ntype_get(&rnode_segaddr)];
+	M0_ASSERT(nt->nt_isvalid(&rnode_segaddr) &&
+		  nt->nt_opaque_get(&rnode_segaddr) == NULL);
 
-	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-	m0_btree_put_credit(tree, 1, ksize, vsize, &cred);
+	/** Re-map the BE segment.*/
+	m0_be_seg_close(ut_seg->bus_seg);
+	rc = madvise(rnode, rnode_sz, MADV_NORMAL);
+	M0_ASSERT(rc == -1 && errno == ENOMEM); /** Assert BE segment unmapped*/
+	m0_be_seg_open(ut_seg->bus_seg);
 
-	put_data.key       = &rec.r_key;
-	put_data.value     = &rec.r_val;
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+				      m0_btree_open(rnode, rnode_sz, tree, seg,
+						    &b_op, NULL));
+	M0_ASSERT(rc == 0);
 
-	ut_cb.c_act        = ut_btree_kv_put_cb;
-	ut_cb.c_datum      = &put_data;
+	get_data.key            = &rec.r_key;
+	get_data.value          = &rec.r_val;
+	get_data.check_value    = false;
+	get_data.crc            = crc_type;
+	get_data.embedded_ksize = false;
+	get_data.embedded_vsize = false;
 
 	for (i = 1; i <= rec_count; i++) {
-		int      k;
+		uint64_t             f_key;
+		void                *f_kptr  = &f_key;
+		m0_bcount_t          f_ksize = sizeof f_key;
+		struct m0_btree_key  key_in_tree;
+
+		f_key              = m0_byteorder_cpu_to_be64(i);
+		key_in_tree.k_data = M0_BUFVEC_INIT_BUF(&f_kptr, &f_ksize);
+		vsize              = sizeof(value);
+		ut_cb.c_act        = ut_btree_kv_get_cb;
+		ut_cb.c_datum      = &get_data;
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_get(tree, &key_in_tree,
+							   &ut_cb, BOF_EQUAL,
+							   &kv_op));
+		M0_ASSERT(rc == M0_BSC_SUCCESS &&
+			  i == m0_byteorder_be64_to_cpu(key));
 
+		/** Update the Value of this Record. */
 		key = m0_byteorder_cpu_to_be64(i);
-		for (k = 0; k < ARRAY_SIZE(value); k++)
-			value[k] = key;
+
+		vsize = bt->vsize == RANDOM_VALUE_SIZE ?
+			GET_RANDOM_VALSIZE(value, i, 1, 1, crc_type) :
+			bt->vsize;
+
+		/** Modify Value for the above Key. */
+		kdata = m0_byteorder_cpu_to_be64(rec_count + i);
+		FILL_VALUE(value, vsize, kdata, crc_type);
 
 		m0_be_ut_tx_init(tx, ut_be);
 		m0_be_tx_prep(tx, &cred);
 		rc = m0_be_tx_open_sync(tx);
 		M0_ASSERT(rc == 0);
 
+		ut_cb.c_act        = ut_btree_kv_update_cb;
+		ut_cb.c_datum      = &put_data;
+
 		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_put(tree, &rec,
-							   &ut_cb,
-							   &kv_op, tx));
+					      m0_btree_update(tree, &rec,
+							      &ut_cb, 0,
+							      &kv_op, tx));
 		M0_ASSERT(rc == 0 && put_data.flags == M0_BSC_SUCCESS);
 		m0_be_tx_close_sync(tx);
 		m0_be_tx_fini(tx);
 	}
 
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_close(tree, &b_op));
+	M0_ASSERT(rc == 0);
+	M0_SET0(&btree);
+
 	/**
-	 * The test assumes that "limit" will be more than the total number of
-	 * nodes present in the record. Hence only one function call to
-	 * m0_btree_truncate is sufficient.
+	 * Confirm root node on BE segment is valid and the opaque pointer in
+	 * the node is NULL.
 	 */
+	rnode_segaddr.as_core = (uint64_t)rnode;
+	nt = btree_node_format[segaddr_ntype_get(&rnode_segaddr)];
+	M0_ASSERT(nt->nt_isvalid(&rnode_segaddr) &&
+		  nt->nt_opaque_get(&rnode_segaddr) == NULL);
+
+	/** Re-map the BE segment.*/
+	m0_be_seg_close(ut_seg->bus_seg);
+	rc = madvise(rnode, rnode_sz, MADV_NORMAL);
+	M0_ASSERT(rc == -1 && errno == ENOMEM); /** Assert BE segment unmapped*/
+	m0_be_seg_open(ut_seg->bus_seg);
+
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+				      m0_btree_open(rnode, rnode_sz, tree, seg,
+						    &b_op, NULL));
+	M0_ASSERT(rc == 0);
+
+	get_data.key            = &rec.r_key;
+	get_data.value          = &rec.r_val;
+	get_data.check_value    = false;
+	get_data.crc            = crc_type;
+	get_data.embedded_ksize = false;
+	get_data.embedded_vsize = false;
+
+	for (i = 1; i <= rec_count; i++) {
+		uint64_t             f_key;
+		void                *f_kptr  = &f_key;
+		m0_bcount_t          f_ksize = sizeof f_key;
+		struct m0_btree_key  key_in_tree;
+
+		f_key              = m0_byteorder_cpu_to_be64(i);
+		key_in_tree.k_data = M0_BUFVEC_INIT_BUF(&f_kptr, &f_ksize);
+		ut_cb.c_act        = ut_btree_kv_get_cb;
+		ut_cb.c_datum      = &get_data;
+		vsize              = sizeof(value);
+
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_get(tree, &key_in_tree,
+							   &ut_cb, BOF_EQUAL,
+							   &kv_op));
+		M0_ASSERT(rc == M0_BSC_SUCCESS &&
+			  i == m0_byteorder_be64_to_cpu(key));
+	}
+
 	cred = M0_BE_TX_CREDIT(0, 0);
 	m0_btree_truncate_credit(tx, tree, &cred, &limit);
 	m0_be_ut_tx_init(tx, ut_be);
@@ -12271,8 +14609,6 @@ static void ut_btree_truncate(void)
 	M0_ASSERT(m0_btree_is_empty(tree));
 
 	cred = M0_BE_TX_CREDIT(0, 0);
-	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
-			       rnode_sz_shift, &cred);
 	m0_btree_destroy_credit(tree, NULL, &cred, 1);
 
 	m0_be_ut_tx_init(tx, ut_be);
@@ -12284,7 +14620,19 @@ static void ut_btree_truncate(void)
 	M0_ASSERT(rc == 0);
 	M0_SET0(&btree);
 
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+
 	/** Delete temp node space which was used as root node for the tree. */
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+
 	buf = M0_BUF_INIT(rnode_sz, rnode);
 	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
 
@@ -12294,82 +14642,211 @@ static void ut_btree_truncate(void)
 	btree_ut_fini();
 }
 
-static void ut_lru_test(void)
+/** TBD: Implement function to print the BTree. */
+M0_INTERNAL void btree_dbg_print(struct m0_btree btree)
+{
+}
+
+static void ut_btree_crc_persist_test(void)
+{
+	struct btree_crc_data {
+		struct m0_btree_type    bcr_btree_type;
+		enum m0_btree_crc_type  bcr_crc_type;
+	} btrees_with_crc[] = {
+		{
+			{
+				BNT_FIXED_FORMAT, sizeof(uint64_t),
+				2 * sizeof(uint64_t)
+			},
+			M0_BCT_NO_CRC,
+		},
+		{
+			{
+				BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE,
+				sizeof(uint64_t), RANDOM_VALUE_SIZE
+			},
+			M0_BCT_NO_CRC,
+		},
+		{
+			{
+				BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE,
+				sizeof(uint64_t), RANDOM_VALUE_SIZE
+			},
+			M0_BCT_NO_CRC,
+		},
+		{
+			{
+				BNT_FIXED_FORMAT, sizeof(uint64_t),
+				3 * sizeof(uint64_t)
+			},
+			M0_BCT_USER_ENC_RAW_HASH,
+		},
+		{
+			{
+				BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE,
+				sizeof(uint64_t), RANDOM_VALUE_SIZE
+			},
+			M0_BCT_USER_ENC_RAW_HASH,
+		},
+		{
+			{
+				BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE,
+				sizeof(uint64_t), RANDOM_VALUE_SIZE
+			},
+			M0_BCT_USER_ENC_RAW_HASH,
+		},
+		{
+			{
+				BNT_FIXED_FORMAT, sizeof(uint64_t),
+				6 * sizeof(uint64_t)
+			},
+			M0_BCT_USER_ENC_FORMAT_FOOTER,
+		},
+		{
+			{
+				BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE,
+				sizeof(uint64_t), RANDOM_VALUE_SIZE
+			},
+			M0_BCT_USER_ENC_FORMAT_FOOTER,
+		},
+		{
+			{
+				BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE,
+				sizeof(uint64_t), RANDOM_VALUE_SIZE
+			},
+			M0_BCT_USER_ENC_FORMAT_FOOTER,
+		},
+		{
+			{
+				BNT_FIXED_FORMAT, sizeof(uint64_t),
+				2 * sizeof(uint64_t)
+			},
+			M0_BCT_BTREE_ENC_RAW_HASH,
+		},
+		{
+			{
+				BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE,
+				sizeof(uint64_t), RANDOM_VALUE_SIZE
+			},
+			M0_BCT_BTREE_ENC_RAW_HASH,
+		},
+		{
+			{
+				BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE,
+				RANDOM_VALUE_SIZE, RANDOM_VALUE_SIZE
+			},
+			M0_BCT_BTREE_ENC_RAW_HASH,
+		},
+	};
+	uint32_t test_count = ARRAY_SIZE(btrees_with_crc);
+	uint32_t i;
+
+
+	for (i = 0; i < test_count; i++) {
+		struct m0_btree_type   *bt = &btrees_with_crc[i].bcr_btree_type;
+		enum m0_btree_crc_type  crc = btrees_with_crc[i].bcr_crc_type;
+		ut_btree_crc_persist_test_internal(bt, crc);
+	}
+
+}
+
+enum {
+	UT_BATCH_NR = 500,
+};
+
+struct ut_batch_get_data {
+	uint64_t ubg_next;
+	uint32_t ubg_found;
+};
+
+static int ut_btree_batch_get_cb(struct m0_btree_cb *cb,
+				 struct m0_btree_rec *rec)
+{
+	struct ut_batch_get_data *d = cb->c_datum;
+	uint64_t                  key;
+	uint64_t                  val;
+
+	key = m0_byteorder_be64_to_cpu(*(uint64_t *)rec->r_key.k_data.ov_buf[0]);
+	M0_ASSERT(key == d->ubg_next);
+	d->ubg_next += 1;
+	if (rec->r_flags == M0_BSC_SUCCESS) {
+		val = *(uint64_t *)rec->r_val.ov_buf[0];
+		M0_ASSERT(val == key * 3);
+		d->ubg_found++;
+	} else
+		M0_ASSERT(rec->r_flags == M0_BSC_KEY_NOT_FOUND);
+	return 0;
+}
+
+/**
+ * This unit test exercises m0_btree_mput(), m0_btree_mget() and
+ * m0_btree_mdel(): all records are inserted in one batch, every other record
+ * is deleted in another batch and a lookup batch over the whole key range is
+ * expected to find exactly the remaining records.
+ */
+static void ut_btree_batch_ops(void)
 {
 	void                       *rnode;
 	int                         i;
-	int64_t                     mem_after_alloc;
-	int64_t                     mem_init;
-	int64_t                     mem_increased;
-	int64_t                     mem_freed;
-	int64_t                     mem_after_free;
-	struct m0_btree_cb          ut_cb;
-	struct m0_be_tx             tx_data         = {};
-	struct m0_be_tx            *tx              = &tx_data;
-	struct m0_be_tx_credit      cred            = {};
-	struct m0_btree_op          b_op            = {};
-	uint64_t                    rec_count       = MAX_RECS_PER_STREAM*50;
-	struct m0_btree_op          kv_op           = {};
+	struct m0_be_tx             tx_data  = {};
+	struct m0_be_tx            *tx       = &tx_data;
+	struct m0_be_tx_credit      cred     = {};
+	struct m0_btree_op          b_op     = {};
 	struct m0_btree            *tree;
 	struct m0_btree             btree;
-	const struct m0_btree_type  bt              = {
-						     .tt_id = M0_BT_UT_KV_OPS,
-						     .ksize = sizeof(uint64_t),
-						     .vsize = bt.ksize * 2,
-						};
-	uint64_t                    key;
-	uint64_t                    value[bt.vsize / sizeof(uint64_t)];
-	m0_bcount_t                 ksize           = sizeof key;
-	m0_bcount_t                 vsize           = sizeof value;
-	void                       *k_ptr           = &key;
-	void                       *v_ptr           = &value;
-	int                         rc;
+	const struct m0_btree_type  bt       = {
+						.tt_id = M0_BT_UT_KV_OPS,
+						.ksize = sizeof(uint64_t),
+						.vsize = sizeof(uint64_t),
+					     };
+	uint64_t                   *keys;
+	uint64_t                   *vals;
+	void                      **kptr;
+	void                      **vptr;
+	struct m0_btree_rec        *recs;
+	struct m0_btree_key        *dkeys;
+	m0_bcount_t                 size     = sizeof(uint64_t);
+	struct m0_btree_cb          get_cb;
+	struct ut_batch_get_data    get_data = {};
 	struct m0_buf               buf;
-	uint32_t                    rnode_sz        = m0_pagesize_get();
-	struct m0_fid               fid             = M0_FID_TINIT('b', 0, 1);
+	uint32_t                    rnode_sz = m0_pagesize_get();
+	struct m0_fid               fid      = M0_FID_TINIT('b', 0, 1);
 	uint32_t                    rnode_sz_shift;
-	struct m0_btree_rec         rec             = {
-			    .r_key.k_data = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize),
-			    .r_val        = M0_BUFVEC_INIT_BUF(&v_ptr, &vsize),
-			};
-	struct ut_cb_data           put_data;
-	bool                        restart_test    = false;
-	int                         retry_cnt       = 0;
-	m0_bcount_t                 limit;
-	/**
-	 * In this UT, we are testing the functionality of LRU list purge and
-	 * be-allocator with chunk align parameter.
-	 *
-	 * 1. Allocate and fill up the btree with multiple records.
-	 * 2. Verify the size increase in memory. If size increase in memory is
-	 *    negative then go to step 5 and restart the test (step 1).
-	 * 3. Use the m0_btree_lrulist_purge() to reduce the size by freeing up
-	 *    the unused nodes present in LRU list.
-	 * 4. Verify the reduction in size.
-	 * 5. Cleanup btree and allocated resources.
-	 */
-	M0_ENTRY();
+	uint32_t                    done;
+	int                         rc;
 
 	btree_ut_init();
 
-start_lru_test:
-	mem_init = sysconf(_SC_AVPHYS_PAGES) * sysconf(_SC_PAGESIZE);
-	M0_LOG(M0_INFO,"Mem Init (%"PRId64").\n",mem_init);
+	M0_ALLOC_ARR(keys, UT_BATCH_NR);
+	M0_ALLOC_ARR(vals, UT_BATCH_NR);
+	M0_ALLOC_ARR(kptr, UT_BATCH_NR);
+	M0_ALLOC_ARR(vptr, UT_BATCH_NR);
+	M0_ALLOC_ARR(recs, UT_BATCH_NR);
+	M0_ALLOC_ARR(dkeys, UT_BATCH_NR);
+	M0_UT_ASSERT(keys != NULL && vals != NULL && kptr != NULL &&
+		     vptr != NULL && recs != NULL && dkeys != NULL);
+
+	for (i = 0; i < UT_BATCH_NR; i++) {
+		keys[i] = m0_byteorder_cpu_to_be64(i);
+		vals[i] = i * 3;
+		kptr[i] = &keys[i];
+		vptr[i] = &vals[i];
+		recs[i].r_key.k_data = M0_BUFVEC_INIT_BUF(&kptr[i], &size);
+		recs[i].r_val        = M0_BUFVEC_INIT_BUF(&vptr[i], &size);
+		recs[i].r_crc_type   = M0_BCT_NO_CRC;
+	}
 
-	M0_ASSERT(rnode_sz != 0 && m0_is_po2(rnode_sz));
 	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
 	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
 	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
 			       rnode_sz_shift, &cred);
 	m0_btree_create_credit(&bt, &cred, 1);
 
-	/* Prepare transaction to capture tree operations. */
 	m0_be_ut_tx_init(tx, ut_be);
 	m0_be_tx_prep(tx, &cred);
 	rc = m0_be_tx_open_sync(tx);
 	M0_ASSERT(rc == 0);
 
-	/* Create temp node space and use it as root node for btree */
 	buf = M0_BUF_INIT(rnode_sz, NULL);
 	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
 	rnode = buf.b_addr;
@@ -12382,783 +14859,1387 @@ start_lru_test:
 	M0_ASSERT(rc == M0_BSC_SUCCESS);
 	m0_be_tx_close_sync(tx);
 	m0_be_tx_fini(tx);
-
 	tree = b_op.bo_arbor;
 
+	/** Insert all records in a single batch. */
 	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-	m0_btree_put_credit(tree, 1, ksize, vsize, &cred);
-
-	put_data.key       = &rec.r_key;
-	put_data.value     = &rec.r_val;
-
-	ut_cb.c_act        = ut_btree_kv_put_cb;
-	ut_cb.c_datum      = &put_data;
-
-	for (i = 1; i <= rec_count; i++) {
-		int      k;
-
-		key = m0_byteorder_cpu_to_be64(i);
-		for (k = 0; k < ARRAY_SIZE(value); k++)
-			value[k] = key;
-
-		m0_be_ut_tx_init(tx, ut_be);
-		m0_be_tx_prep(tx, &cred);
-		rc = m0_be_tx_open_sync(tx);
-		M0_ASSERT(rc == 0);
-
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_put(tree, &rec,
-							   &ut_cb,
-							   &kv_op, tx));
-		M0_ASSERT(rc == 0 && put_data.flags == M0_BSC_SUCCESS);
-		m0_be_tx_close_sync(tx);
-		m0_be_tx_fini(tx);
-	}
+	m0_btree_mput_credit(tree, recs, UT_BATCH_NR, &cred);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+	rc = m0_btree_mput(tree, recs, UT_BATCH_NR, NULL, tx, &done);
+	M0_UT_ASSERT(rc == 0 && done == UT_BATCH_NR);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
 
-	mem_after_alloc = sysconf(_SC_AVPHYS_PAGES) * sysconf(_SC_PAGESIZE);
-	mem_increased   = mem_init - mem_after_alloc;
-	if (mem_increased < 0) {
-		restart_test = true;
-		retry_cnt++;
-		M0_LOG(M0_INFO, "Memory increased is negative because "
-				"Mem After Alloc (%"PRId64") is greater than "
-				"Mem Init (%"PRId64"), This can "
-				"happen due to other processes in system "
-				"might have released memory, hence cleaning up "
-				"the records and restarting the test.",
-				mem_after_alloc, mem_init);
+	/** Re-inserting an existing record fails and stops the batch. */
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_btree_mput_credit(tree, recs, 1, &cred);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+	rc = m0_btree_mput(tree, recs, 1, NULL, tx, &done);
+	M0_UT_ASSERT(rc == -EEXIST && done == 0);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
 
-		/* Cleanup records and tree then restart the test. */
-		if (retry_cnt < MAX_TEST_RETRIES)
-			goto cleanup;
-		else
-			M0_ASSERT_INFO(mem_increased > 0,
-				       "Memory is still getting freed, hence "
-				       "exiting test with failure.");
-	}
+	for (i = 0; i < UT_BATCH_NR; i++)
+		dkeys[i] = recs[i].r_key;
 
-	M0_LOG(M0_INFO, "Mem After Alloc (%"PRId64") || Mem Increase (%"PRId64").\n",
-			 mem_after_alloc, mem_increased);
+	get_cb.c_act   = ut_btree_batch_get_cb;
+	get_cb.c_datum = &get_data;
+	rc = m0_btree_mget(tree, dkeys, UT_BATCH_NR, &get_cb, &done);
+	M0_UT_ASSERT(rc == 0 && done == UT_BATCH_NR);
+	M0_UT_ASSERT(get_data.ubg_found == UT_BATCH_NR);
 
-	M0_ASSERT(ndlist_tlist_length(&btree_lru_nds) > 0);
+	/** Delete records with odd keys in a single batch. */
+	for (i = 0; i < UT_BATCH_NR / 2; i++)
+		dkeys[i] = recs[2 * i + 1].r_key;
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_btree_mdel_credit(tree, dkeys, UT_BATCH_NR / 2, size, &cred);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+	rc = m0_btree_mdel(tree, dkeys, UT_BATCH_NR / 2, NULL, tx, &done);
+	M0_UT_ASSERT(rc == 0 && done == UT_BATCH_NR / 2);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
 
-	mem_freed      = m0_btree_lrulist_purge(mem_increased/2, 0);
-	mem_after_free = sysconf(_SC_AVPHYS_PAGES) * sysconf(_SC_PAGESIZE);
-	M0_LOG(M0_INFO, "Mem After Free (%"PRId64") || Mem freed (%"PRId64").\n",
-			 mem_after_free, mem_freed);
+	for (i = 0; i < UT_BATCH_NR; i++)
+		dkeys[i] = recs[i].r_key;
+	M0_SET0(&get_data);
+	rc = m0_btree_mget(tree, dkeys, UT_BATCH_NR, &get_cb, &done);
+	M0_UT_ASSERT(rc == 0 && done == UT_BATCH_NR);
+	M0_UT_ASSERT(get_data.ubg_found == UT_BATCH_NR - UT_BATCH_NR / 2);
 
-cleanup:
-	/**
-	 * The test assumes that "limit" will be more than the total number of
-	 * nodes present in the record. Hence only one function call to
-	 * m0_btree_truncate is sufficient.
-	 */
-	cred = M0_BE_TX_CREDIT(0, 0);
-	m0_btree_truncate_credit(tx, tree, &cred, &limit);
+	/** Remove the rest and destroy the tree. */
+	for (i = 0; i < UT_BATCH_NR - UT_BATCH_NR / 2; i++)
+		dkeys[i] = recs[2 * i].r_key;
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_btree_mdel_credit(tree, dkeys, i, size, &cred);
 	m0_be_ut_tx_init(tx, ut_be);
 	m0_be_tx_prep(tx, &cred);
 	rc = m0_be_tx_open_sync(tx);
 	M0_ASSERT(rc == 0);
-
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-				      m0_btree_truncate(tree, limit, tx,
-							&kv_op));
+	rc = m0_btree_mdel(tree, dkeys, i, NULL, tx, NULL);
+	M0_UT_ASSERT(rc == 0);
 	m0_be_tx_close_sync(tx);
 	m0_be_tx_fini(tx);
-
-	/* Verify the tree is empty */
-	M0_ASSERT(m0_btree_is_empty(tree));
+	M0_UT_ASSERT(m0_btree_is_empty(tree));
 
 	cred = M0_BE_TX_CREDIT(0, 0);
 	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
 			       rnode_sz_shift, &cred);
 	m0_btree_destroy_credit(tree, NULL, &cred, 1);
-
 	m0_be_ut_tx_init(tx, ut_be);
 	m0_be_tx_prep(tx, &cred);
 	rc = m0_be_tx_open_sync(tx);
 	M0_ASSERT(rc == 0);
-
 	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(tree, &b_op, tx));
 	M0_ASSERT(rc == 0);
 	M0_SET0(&btree);
-
-	/* Delete temp node space which was used as root node for the tree. */
 	buf = M0_BUF_INIT(rnode_sz, rnode);
 	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
-
 	m0_be_tx_close_sync(tx);
 	m0_be_tx_fini(tx);
 
-	if (restart_test) {
-		restart_test = false;
-		/* When restarting test, Re-map the BE segment. */
-		m0_be_seg_close(ut_seg->bus_seg);
-		rc = madvise(rnode, rnode_sz, MADV_NORMAL);
-		M0_ASSERT(rc == -1 && errno == ENOMEM);
-		m0_be_seg_open(ut_seg->bus_seg);
-		m0_nanosleep(m0_time(2, 0), NULL);
-		goto start_lru_test;
-	}
-
+	m0_free(dkeys);
+	m0_free(recs);
+	m0_free(vptr);
+	m0_free(kptr);
+	m0_free(vals);
+	m0_free(keys);
 	btree_ut_fini();
 }
 
-/**
- * This test launches multiple threads each of of which create different btree's
- * which host records with different CRC type embedded within them.
- */
-static void ut_btree_crc_test(void)
-{
-	int                         rc;
-	struct btree_ut_thread_info *ti;
-	int                         i;
-	uint16_t                    cpu;
-	void                        *rnode;
-	struct m0_btree_op          b_op           = {};
-	struct btree_crc_data {
-				struct m0_btree_type    bcr_btree_type;
-				enum m0_btree_crc_type  bcr_crc_type;
-			      } btrees_with_crc[] = {
-			{
-				{
-					BNT_FIXED_FORMAT, 2 * sizeof(uint64_t),
-					2 * sizeof(uint64_t)
-				},
-				M0_BCT_NO_CRC,
-			},
-			{
-				{
-					BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE,
-					2 * sizeof(uint64_t), RANDOM_VALUE_SIZE
-				},
-				M0_BCT_NO_CRC,
-			},
-			{
-				{
-					BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE,
-					RANDOM_KEY_SIZE, RANDOM_VALUE_SIZE
-				},
-				M0_BCT_NO_CRC,
-			},
-			{
-				{
-					BNT_FIXED_FORMAT, 2 * sizeof(uint64_t),
-					3 * sizeof(uint64_t)
-				},
-				M0_BCT_USER_ENC_RAW_HASH,
-			},
-			{
-				{
-					BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE,
-					2 * sizeof(uint64_t), RANDOM_VALUE_SIZE
-				},
-				M0_BCT_USER_ENC_RAW_HASH,
-			},
-			{
-				{
-					BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE,
-					RANDOM_KEY_SIZE, RANDOM_VALUE_SIZE
-				},
-				M0_BCT_USER_ENC_RAW_HASH,
-			},
-			{
-				{
-					BNT_FIXED_FORMAT, 2 * sizeof(uint64_t),
-					2 * sizeof(uint64_t)
-				},
-				M0_BCT_BTREE_ENC_RAW_HASH,
-			},
-			{
-				{
-					BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE,
-					2 * sizeof(uint64_t), RANDOM_VALUE_SIZE
-				},
-				M0_BCT_BTREE_ENC_RAW_HASH,
-			},
-			{
-				{
-					BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE,
-					RANDOM_KEY_SIZE, RANDOM_VALUE_SIZE
-				},
-				M0_BCT_BTREE_ENC_RAW_HASH,
-			},
-		};
-	uint16_t                    thread_count = ARRAY_SIZE(btrees_with_crc);
-	struct m0_be_tx_credit      cred;
-	struct m0_be_tx             tx_data        = {};
-	struct m0_be_tx             *tx            = &tx_data;
-	struct m0_fid               fid            = M0_FID_TINIT('b', 0, 1);
-	struct m0_buf               buf;
-	uint16_t                    *cpuid_ptr;
-	uint16_t                    cpu_count;
-	size_t                      cpu_max;
-	time_t                      curr_time;
-	uint32_t                    rnode_sz       = sysconf(_SC_PAGESIZE);
-	uint32_t                    rnode_sz_shift;
-	struct m0_btree             btree[thread_count];
+enum {
+	UT_PREFIX_NR    = 4000,
+	UT_PREFIX_KSIZE = 64,
+};
 
-	M0_ENTRY();
+static int ut_btree_prefix_get_cb(struct m0_btree_cb *cb,
+				  struct m0_btree_rec *rec)
+{
+	uint32_t *found = cb->c_datum;
+
+	if (rec->r_flags == M0_BSC_SUCCESS) {
+		M0_ASSERT(*(uint64_t *)rec->r_val.ov_buf[0] == *found);
+		(*found)++;
+	}
+	return 0;
+}
+
+/**
+ * Fills a tree of the given type with UT_PREFIX_NR records, looks all of them
+ * up, then deletes them and destroys the tree. Returns the height of the
+ * filled tree and the size of the largest key found in the root node.
+ */
+static void ut_btree_prefix_tree_run(const struct m0_btree_type *bt,
+				     struct m0_btree_rec *recs,
+				     struct m0_btree_key *keys,
+				     uint32_t *height, m0_bcount_t *root_ksize)
+{
+	void                   *rnode;
+	struct m0_be_tx         tx_data  = {};
+	struct m0_be_tx        *tx       = &tx_data;
+	struct m0_be_tx_credit  cred;
+	struct m0_btree_op      b_op     = {};
+	struct m0_btree        *tree;
+	struct m0_btree         btree;
+	struct m0_btree_cb      get_cb;
+	struct m0_buf           buf;
+	struct nd              *root;
+	struct slot             s;
+	void                   *p_key;
+	m0_bcount_t             ksize;
+	uint32_t                rnode_sz = m0_pagesize_get();
+	struct m0_fid           fid      = M0_FID_TINIT('b', 0, 1);
+	uint32_t                rnode_sz_shift;
+	uint32_t                found    = 0;
+	uint32_t                done;
+	int                     i;
+	int                     rc;
 
-	M0_ASSERT(rnode_sz != 0 && m0_is_po2(rnode_sz));
 	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_create_credit(bt, &cred, 1);
 
-	M0_ALLOC_ARR(ti, thread_count);
-	M0_ASSERT(ti != NULL);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
 
-	time(&curr_time);
-	M0_LOG(M0_INFO, "Using seed %lu", curr_time);
-	srandom(curr_time);
+	buf = M0_BUF_INIT(rnode_sz, NULL);
+	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	rnode = buf.b_addr;
 
-	/**
-	 *  1) Assign CPU cores to the threads.
-	 *  2) Create btree(s) to be used by all the threads.
-	 *  3) Init and Start the threads which do KV operations.
-	 *  4) Wait till all the threads are done.
-	 *  5) Close the btree
-	 *  6) Destroy the btree
-	 */
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(rnode, rnode_sz,
+							     bt, M0_BCT_NO_CRC,
+							     &b_op, &btree, seg,
+							     &fid, tx, NULL));
+	M0_ASSERT(rc == M0_BSC_SUCCESS);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+	tree = b_op.bo_arbor;
+
+	for (i = 0; i < UT_PREFIX_NR; i += UT_BATCH_NR) {
+		cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+		m0_btree_mput_credit(tree, &recs[i], UT_BATCH_NR, &cred);
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
+		rc = m0_btree_mput(tree, &recs[i], UT_BATCH_NR, NULL, tx,
+				   &done);
+		M0_UT_ASSERT(rc == 0 && done == UT_BATCH_NR);
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+	}
+
+	get_cb.c_act   = ut_btree_prefix_get_cb;
+	get_cb.c_datum = &found;
+	rc = m0_btree_mget(tree, keys, UT_PREFIX_NR, &get_cb, &done);
+	M0_UT_ASSERT(rc == 0 && done == UT_PREFIX_NR);
+	M0_UT_ASSERT(found == UT_PREFIX_NR);
+
+	*height     = tree->t_height;
+	*root_ksize = 0;
+	root        = tree->t_desc->t_root;
+	s.s_node    = root;
+	s.s_rec.r_key.k_data = M0_BUFVEC_INIT_BUF(&p_key, &ksize);
+	for (i = 0; bnode_level(root) > 0 && i < bnode_key_count(root); i++) {
+		s.s_idx = i;
+		bnode_key(&s);
+		*root_ksize = max_check(*root_ksize, ksize);
+	}
+
+	for (i = 0; i < UT_PREFIX_NR; i += UT_BATCH_NR) {
+		cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+		m0_btree_mdel_credit(tree, &keys[i], UT_BATCH_NR,
+				     sizeof(uint64_t), &cred);
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
+		rc = m0_btree_mdel(tree, &keys[i], UT_BATCH_NR, NULL, tx,
+				   &done);
+		M0_UT_ASSERT(rc == 0 && done == UT_BATCH_NR);
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+	}
+	M0_UT_ASSERT(m0_btree_is_empty(tree));
+
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_destroy_credit(tree, NULL, &cred, 1);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(tree, &b_op, tx));
+	M0_ASSERT(rc == 0);
+	buf = M0_BUF_INIT(rnode_sz, rnode);
+	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+}
+
+/**
+ * This unit test stores keys sharing a long common prefix (as object paths of
+ * a bucket do) in trees with variable_kv_format and variable_kv_prefix_format
+ * nodes. Both trees have to return all the records; the tree with prefix
+ * separators has to keep shorter keys in its root and must not be higher.
+ */
+static void ut_btree_prefix_keys(void)
+{
+	char                 (*kbuf)[UT_PREFIX_KSIZE];
+	uint64_t              *vals;
+	void                 **kptr;
+	void                 **vptr;
+	m0_bcount_t           *ksize;
+	m0_bcount_t            vsize = sizeof(uint64_t);
+	struct m0_btree_rec   *recs;
+	struct m0_btree_key   *keys;
+	struct m0_btree_type   bt    = {
+					.tt_id = M0_BT_UT_KV_OPS,
+					.ksize = -1,
+					.vsize = -1,
+				       };
+	uint32_t               height;
+	uint32_t               prefix_height;
+	m0_bcount_t            root_ksize;
+	m0_bcount_t            prefix_root_ksize;
+	int                    i;
 
 	btree_ut_init();
 
-	online_cpu_id_get(&cpuid_ptr, &cpu_count);
+	M0_ALLOC_ARR(kbuf, UT_PREFIX_NR);
+	M0_ALLOC_ARR(vals, UT_PREFIX_NR);
+	M0_ALLOC_ARR(kptr, UT_PREFIX_NR);
+	M0_ALLOC_ARR(vptr, UT_PREFIX_NR);
+	M0_ALLOC_ARR(ksize, UT_PREFIX_NR);
+	M0_ALLOC_ARR(recs, UT_PREFIX_NR);
+	M0_ALLOC_ARR(keys, UT_PREFIX_NR);
+	M0_UT_ASSERT(kbuf != NULL && vals != NULL && kptr != NULL &&
+		     vptr != NULL && ksize != NULL && recs != NULL &&
+		     keys != NULL);
+
+	for (i = 0; i < UT_PREFIX_NR; i++) {
+		ksize[i] = snprintf(kbuf[i], UT_PREFIX_KSIZE,
+				    "s3-bucket/photos/2021/%08x/IMG_%08x.jpg",
+				    i, (uint32_t)random());
+		vals[i] = i;
+		kptr[i] = kbuf[i];
+		vptr[i] = &vals[i];
+		recs[i].r_key.k_data = M0_BUFVEC_INIT_BUF(&kptr[i], &ksize[i]);
+		recs[i].r_val        = M0_BUFVEC_INIT_BUF(&vptr[i], &vsize);
+		recs[i].r_crc_type   = M0_BCT_NO_CRC;
+		keys[i]              = recs[i].r_key;
+	}
 
-	UT_STOP_THREADS();
-	m0_atomic64_set(&threads_running, 0);
-	m0_atomic64_set(&threads_quiesced, 0);
+	ut_btree_prefix_tree_run(&bt, recs, keys, &height, &root_ksize);
+	bt.tt_flags = M0_BTF_PREFIX_KEYS;
+	ut_btree_prefix_tree_run(&bt, recs, keys, &prefix_height,
+				 &prefix_root_ksize);
+
+	M0_UT_ASSERT(prefix_height <= height);
+	M0_UT_ASSERT(prefix_root_ksize < root_ksize);
+	M0_UT_ASSERT(prefix_root_ksize < ksize[0]);
+
+	m0_free(keys);
+	m0_free(recs);
+	m0_free(ksize);
+	m0_free(vptr);
+	m0_free(kptr);
+	m0_free(vals);
+	m0_free(kbuf);
+	btree_ut_fini();
+}
 
-	M0_ALLOC_ARR(ti, thread_count);
-	M0_ASSERT(ti != NULL);
+enum {
+	UT_PGET_READERS = 4,
+	UT_PGET_NR      = 2000,
+	UT_PGET_ROUNDS  = 20,
+};
 
-	cpu_max = m0_processor_nr_max();
+struct ut_pget_reader {
+	struct m0_thread  upr_thread;
+	struct m0_btree  *upr_tree;
+	uint32_t          upr_found;
+};
 
-	cpu = 1; /** We skip Core-0 for Linux kernel and other processes. */
-	for (i = 0; i < thread_count; i++) {
-		enum m0_btree_crc_type  crc_type;
-		struct m0_btree_type    btree_type;
+static int ut_btree_pget_cb(struct m0_btree_cb *cb, struct m0_btree_rec *rec)
+{
+	uint64_t *val = cb->c_datum;
 
-		crc_type = btrees_with_crc[i].bcr_crc_type;
-		btree_type = btrees_with_crc[i].bcr_btree_type;
+	*val = rec->r_flags == M0_BSC_SUCCESS ?
+	       *(uint64_t *)rec->r_val.ov_buf[0] : UINT64_MAX;
+	return 0;
+}
 
-		rc = m0_bitmap_init(&ti[i].ti_cpu_map, cpu_max);
-		m0_bitmap_set(&ti[i].ti_cpu_map, cpuid_ptr[cpu], true);
-		cpu++;
-		if (cpu >= cpu_count)
-			/**
-			 *  Circle around if thread count is higher than the
-			 *  CPU cores in the system.
-			 */
-			cpu = 1;
+/** Looks up all the even keys, which are never modified by the writer. */
+static void ut_btree_pget_reader(struct ut_pget_reader *r)
+{
+	struct m0_btree_op   kv_op = {};
+	struct m0_btree_key  key;
+	struct m0_btree_cb   cb;
+	uint64_t             kdata;
+	uint64_t             val;
+	void                *kptr  = &kdata;
+	m0_bcount_t          ksize = sizeof kdata;
+	int                  round;
+	int                  i;
+	int                  rc;
+
+	key.k_data = M0_BUFVEC_INIT_BUF(&kptr, &ksize);
+	cb.c_act   = ut_btree_pget_cb;
+	cb.c_datum = &val;
+	for (round = 0; round < UT_PGET_ROUNDS; round++) {
+		for (i = 0; i < UT_PGET_NR; i += 2) {
+			kdata = m0_byteorder_cpu_to_be64(i);
+			val   = 0;
+			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					m0_btree_get(r->upr_tree, &key, &cb,
+						     BOF_EQUAL, &kv_op));
+			M0_ASSERT(rc == 0 && val == i * 3);
+			r->upr_found++;
+		}
+	}
+}
 
-		ti[i].ti_key_first  = 1;
-		ti[i].ti_key_count  = MAX_RECS_PER_THREAD;
-		ti[i].ti_key_incr   = 5;
-		ti[i].ti_thread_id  = i;
-		ti[i].ti_key_size   = btree_type.ksize;
-		ti[i].ti_value_size = btree_type.vsize;
-		ti[i].ti_crc_type   = crc_type;
-		ti[i].ti_random_bursts = (thread_count > 1);
-		do {
-			ti[i].ti_rng_seed_base = random();
-		} while (ti[i].ti_rng_seed_base == 0);
+/**
+ * This unit test runs lookups from several threads while the main thread
+ * keeps inserting and deleting records in between the looked up keys, so that
+ * the readers share the upper level nodes with each other and with the nodes
+ * being split and merged by the writer.
+ */
+static void ut_btree_parallel_get(void)
+{
+	void                       *rnode;
+	struct ut_pget_reader      *readers;
+	struct m0_be_tx             tx_data  = {};
+	struct m0_be_tx            *tx       = &tx_data;
+	struct m0_be_tx_credit      cred;
+	struct m0_btree_op          b_op     = {};
+	struct m0_btree            *tree;
+	struct m0_btree             btree;
+	const struct m0_btree_type  bt       = {
+						.tt_id = M0_BT_UT_KV_OPS,
+						.ksize = sizeof(uint64_t),
+						.vsize = sizeof(uint64_t),
+					     };
+	uint64_t                   *keys;
+	uint64_t                   *vals;
+	void                      **kptr;
+	void                      **vptr;
+	struct m0_btree_rec        *recs;
+	struct m0_btree_key        *dkeys;
+	m0_bcount_t                 size     = sizeof(uint64_t);
+	struct m0_buf               buf;
+	uint32_t                    rnode_sz = m0_pagesize_get();
+	struct m0_fid               fid      = M0_FID_TINIT('b', 0, 1);
+	uint32_t                    rnode_sz_shift;
+	uint32_t                    done;
+	int                         i;
+	int                         rc;
 
-		M0_SET0(&b_op);
+	btree_ut_init();
 
-		cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-		m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
-				       rnode_sz_shift, &cred);
-		m0_btree_create_credit(&btree_type, &cred, 1);
+	M0_ALLOC_ARR(readers, UT_PGET_READERS);
+	M0_ALLOC_ARR(keys, UT_PGET_NR);
+	M0_ALLOC_ARR(vals, UT_PGET_NR);
+	M0_ALLOC_ARR(kptr, UT_PGET_NR);
+	M0_ALLOC_ARR(vptr, UT_PGET_NR);
+	M0_ALLOC_ARR(recs, UT_PGET_NR);
+	M0_ALLOC_ARR(dkeys, UT_PGET_NR);
+	M0_UT_ASSERT(readers != NULL && keys != NULL && vals != NULL &&
+		     kptr != NULL && vptr != NULL && recs != NULL &&
+		     dkeys != NULL);
+
+	for (i = 0; i < UT_PGET_NR; i++) {
+		keys[i] = m0_byteorder_cpu_to_be64(i);
+		vals[i] = i * 3;
+		kptr[i] = &keys[i];
+		vptr[i] = &vals[i];
+		recs[i].r_key.k_data = M0_BUFVEC_INIT_BUF(&kptr[i], &size);
+		recs[i].r_val        = M0_BUFVEC_INIT_BUF(&vptr[i], &size);
+		recs[i].r_crc_type   = M0_BCT_NO_CRC;
+		dkeys[i]             = recs[i].r_key;
+	}
+
+	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_create_credit(&bt, &cred, 1);
+
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+
+	buf = M0_BUF_INIT(rnode_sz, NULL);
+	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	rnode = buf.b_addr;
+
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(rnode, rnode_sz,
+							     &bt,
+							     M0_BCT_NO_CRC,
+							     &b_op, &btree, seg,
+							     &fid, tx, NULL));
+	M0_ASSERT(rc == M0_BSC_SUCCESS);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+	tree = b_op.bo_arbor;
 
+	/** Insert the even keys, these are looked up by the readers. */
+	for (i = 0; i < UT_PGET_NR; i += 2) {
+		cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+		m0_btree_mput_credit(tree, &recs[i], 1, &cred);
 		m0_be_ut_tx_init(tx, ut_be);
 		m0_be_tx_prep(tx, &cred);
 		rc = m0_be_tx_open_sync(tx);
 		M0_ASSERT(rc == 0);
-
-		/** Create temp node space and use it as root node for btree */
-		buf = M0_BUF_INIT(rnode_sz, NULL);
-		M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
-		rnode = buf.b_addr;
-
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-					      m0_btree_create(rnode, rnode_sz,
-							      &btree_type,
-							      crc_type, &b_op,
-							      &btree[i], seg,
-							      &fid, tx, NULL));
-		M0_ASSERT(rc == M0_BSC_SUCCESS);
-
+		rc = m0_btree_mput(tree, &recs[i], 1, NULL, tx, &done);
+		M0_UT_ASSERT(rc == 0 && done == 1);
 		m0_be_tx_close_sync(tx);
 		m0_be_tx_fini(tx);
+	}
 
-		ti[i].ti_tree = &btree[i];
-
-		rc = M0_THREAD_INIT(&ti[i].ti_q, struct btree_ut_thread_info *,
-				    btree_ut_thread_init,
-				    &btree_ut_kv_oper_thread_handler, &ti[i],
-				    "Thread-%d", i);
+	for (i = 0; i < UT_PGET_READERS; i++) {
+		readers[i].upr_tree = tree;
+		rc = M0_THREAD_INIT(&readers[i].upr_thread,
+				    struct ut_pget_reader *, NULL,
+				    &ut_btree_pget_reader, &readers[i],
+				    "pget-%d", i);
 		M0_ASSERT(rc == 0);
 	}
 
-	/** Initialized all the threads. Now start the test ... */
-	UT_START_THREADS();
+	/** Insert and delete the odd keys while the readers are running. */
+	for (i = 1; i < UT_PGET_NR; i += 2) {
+		cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+		m0_btree_mput_credit(tree, &recs[i], 1, &cred);
+		m0_btree_mdel_credit(tree, &dkeys[i], 1, size, &cred);
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
+		rc = m0_btree_mput(tree, &recs[i], 1, NULL, tx, NULL);
+		M0_UT_ASSERT(rc == 0);
+		if (i % 4 == 1) {
+			rc = m0_btree_mdel(tree, &dkeys[i], 1, NULL, tx, NULL);
+			M0_UT_ASSERT(rc == 0);
+		}
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+	}
 
-	for (i = 0; i < thread_count; i++) {
-		m0_thread_join(&ti[i].ti_q);
-		m0_thread_fini(&ti[i].ti_q);
+	for (i = 0; i < UT_PGET_READERS; i++) {
+		m0_thread_join(&readers[i].upr_thread);
+		m0_thread_fini(&readers[i].upr_thread);
+		M0_UT_ASSERT(readers[i].upr_found ==
+			     UT_PGET_ROUNDS * UT_PGET_NR / 2);
 	}
 
-	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
-			       rnode_sz_shift, &cred);
-	m0_btree_destroy_credit(&btree[0], NULL, &cred, 1);
-	for (i = 0; i < thread_count; i++) {
+	/** Remove the remaining records and destroy the tree. */
+	for (i = 0; i < UT_PGET_NR; i++) {
+		if (i % 4 == 1)
+			continue;
+		cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+		m0_btree_mdel_credit(tree, &dkeys[i], 1, size, &cred);
 		m0_be_ut_tx_init(tx, ut_be);
 		m0_be_tx_prep(tx, &cred);
 		rc = m0_be_tx_open_sync(tx);
 		M0_ASSERT(rc == 0);
-
-		rnode = segaddr_addr(&btree[i].t_desc->t_root->n_addr);
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-					      m0_btree_destroy(&btree[i],
-							       &b_op, tx));
-		M0_ASSERT(rc == 0);
-		M0_SET0(&btree[i]);
-		buf = M0_BUF_INIT(rnode_sz, rnode);
-		M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+		rc = m0_btree_mdel(tree, &dkeys[i], 1, NULL, tx, NULL);
+		M0_UT_ASSERT(rc == 0);
 		m0_be_tx_close_sync(tx);
 		m0_be_tx_fini(tx);
 	}
+	M0_UT_ASSERT(m0_btree_is_empty(tree));
 
-	m0_free0(&cpuid_ptr);
-	m0_free(ti);
-	btree_ut_fini();
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_destroy_credit(tree, NULL, &cred, 1);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(tree, &b_op, tx));
+	M0_ASSERT(rc == 0);
+	buf = M0_BUF_INIT(rnode_sz, rnode);
+	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
 
-	M0_LEAVE();
+	m0_free(dkeys);
+	m0_free(recs);
+	m0_free(vptr);
+	m0_free(kptr);
+	m0_free(vals);
+	m0_free(keys);
+	m0_free(readers);
+	btree_ut_fini();
 }
 
+enum {
+	UT_BULK_NR    = 20000,
+	UT_BULK_BATCH = 5000,
+	UT_BULK_FILL  = 90,
+};
+
 /**
- * This unit test creates records in the nodes and then simulates the loading
- * of those nodes across cluster reboots.
+ * Stores UT_BULK_NR sorted records either with m0_btree_bulk_load() or with
+ * m0_btree_mput(), verifies them and returns the number of leaves, which is
+ * the number of children of the root for the 2-level tree built here.
  */
-static void ut_btree_crc_persist_test_internal(struct m0_btree_type   *bt,
-					       enum m0_btree_crc_type  crc_type)
+static void ut_btree_bulk_tree_run(bool bulk, struct m0_btree_rec *recs,
+				   struct m0_btree_key *keys,
+				   uint32_t *leaves)
 {
 	void                       *rnode;
-	int                         i;
-	struct m0_btree_cb          ut_cb;
-	struct m0_be_tx             tx_data        = {};
-	struct m0_be_tx            *tx             = &tx_data;
-	struct m0_be_tx_credit      cred           = {};
-	struct m0_btree_op          b_op           = {};
-	uint64_t                    rec_count      = MAX_RECS_PER_STREAM;
-	struct m0_btree_op          kv_op          = {};
+	struct m0_be_tx             tx_data  = {};
+	struct m0_be_tx            *tx       = &tx_data;
+	struct m0_be_tx_credit      cred;
+	struct m0_btree_op          b_op     = {};
 	struct m0_btree            *tree;
 	struct m0_btree             btree;
-	uint64_t                    key;
-	uint64_t                    value[VAL_ARR_ELE_COUNT];
-	uint64_t                    kdata;
-	m0_bcount_t                 ksize          = sizeof(key);
-	m0_bcount_t                 vsize          = sizeof(value);
-	void                       *k_ptr          = &key;
-	void                       *v_ptr          = &value;
-	int                         rc;
+	const struct m0_btree_type  bt       = {
+						.tt_id = M0_BT_UT_KV_OPS,
+						.ksize = sizeof(uint64_t),
+						.vsize = sizeof(uint64_t),
+					     };
+	struct m0_btree_cb          get_cb;
 	struct m0_buf               buf;
-	const struct node_type     *nt;
-	struct segaddr              rnode_segaddr;
-	uint32_t                    rnode_sz       = m0_pagesize_get();
-	struct m0_fid               fid            = M0_FID_TINIT('b', 0, 1);
+	uint32_t                    rnode_sz = m0_pagesize_get();
+	struct m0_fid               fid      = M0_FID_TINIT('b', 0, 1);
 	uint32_t                    rnode_sz_shift;
-	struct m0_btree_rec         rec            = {
-				    .r_key.k_data  = M0_BUFVEC_INIT_BUF(&k_ptr,
-								       &ksize),
-				    .r_val         = M0_BUFVEC_INIT_BUF(&v_ptr,
-								       &vsize),
-				    .r_crc_type    = crc_type,
-						    };
-	struct ut_cb_data           put_data;
-	struct ut_cb_data           get_data;
-	m0_bcount_t                 limit;
-
-	M0_ASSERT(bt->ksize == RANDOM_VALUE_SIZE || bt->ksize == sizeof(key));
-	M0_ASSERT(bt->vsize == RANDOM_VALUE_SIZE ||
-		  (bt->vsize % sizeof(uint64_t) == 0 &&
-		   (((crc_type == M0_BCT_NO_CRC &&
-		     bt->vsize > sizeof(value[0])) ||
-		    (crc_type == M0_BCT_USER_ENC_RAW_HASH &&
-		     bt->vsize > sizeof(value[0]) * 2) ||
-		    (crc_type == M0_BCT_USER_ENC_FORMAT_FOOTER &&
-		     bt->vsize > (sizeof(value[0]) +
-				  sizeof(struct m0_format_header) +
-				  sizeof(struct m0_format_footer))) ||
-		    (crc_type == M0_BCT_BTREE_ENC_RAW_HASH &&
-		     bt->vsize > sizeof(value[0]))) &&
-		    bt->vsize <= sizeof(value))));
-
-	M0_CASSERT(VAL_ARR_ELE_COUNT > 1);
-
-	M0_ENTRY();
-
-	rec_count = (rec_count / 2) * 2; /** Make rec_count a multiple of 2 */
-
-	btree_ut_init();
-	/**
-	 *  Run the following scenario:
-	 *  1) Create a btree
-	 *  2) Add records in the created tree.
-	 *  3) Reload the BE segment.
-	 *  4) Confirm all the records are present in the tree and CRC matches.
-	 *  5) Modify the Value for all the records.
-	 *  6) Reload the BE segment.
-	 *  7) Confirm all the records are present in the tree and CRC matches.
-	 *
-	 *  Capture each operation in a separate transaction.
-	 */
+	uint64_t                    val;
+	uint32_t                    done;
+	int                         i;
+	int                         rc;
 
-	M0_ASSERT(rnode_sz != 0 && m0_is_po2(rnode_sz));
 	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
 	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
 	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
 			       rnode_sz_shift, &cred);
-	m0_btree_create_credit(bt, &cred, 1);
+	m0_btree_create_credit(&bt, &cred, 1);
 
-	/** Prepare transaction to capture tree operations. */
 	m0_be_ut_tx_init(tx, ut_be);
 	m0_be_tx_prep(tx, &cred);
 	rc = m0_be_tx_open_sync(tx);
 	M0_ASSERT(rc == 0);
 
-	/** Create temp node space and use it as root node for btree */
 	buf = M0_BUF_INIT(rnode_sz, NULL);
 	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
 	rnode = buf.b_addr;
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-				      m0_btree_create(rnode, rnode_sz, bt,
-						      crc_type, &b_op, &btree,
-						      seg, &fid, tx, NULL));
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(rnode, rnode_sz,
+							     &bt,
+							     M0_BCT_NO_CRC,
+							     &b_op, &btree, seg,
+							     &fid, tx, NULL));
 	M0_ASSERT(rc == M0_BSC_SUCCESS);
 	m0_be_tx_close_sync(tx);
 	m0_be_tx_fini(tx);
-
 	tree = b_op.bo_arbor;
 
-	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
-	m0_btree_put_credit(tree, 1, ksize, vsize, &cred);
-
-	put_data.key       = &rec.r_key;
-	put_data.value     = &rec.r_val;
-
-	ut_cb.c_act        = ut_btree_kv_put_cb;
-	ut_cb.c_datum      = &put_data;
-
-	for (i = 1; i <= rec_count; i++) {
-		key = m0_byteorder_cpu_to_be64(i);
+	for (i = 0; i < UT_BULK_NR; i += UT_BULK_BATCH) {
+		cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+		if (bulk)
+			m0_btree_bulk_load_credit(tree, UT_BULK_BATCH,
+						  sizeof(uint64_t),
+						  sizeof(uint64_t),
+						  UT_BULK_FILL, &cred);
+		else
+			m0_btree_mput_credit(tree, &recs[i], UT_BULK_BATCH,
+					     &cred);
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
+		rc = bulk ? m0_btree_bulk_load(tree, &recs[i], UT_BULK_BATCH,
+					       UT_BULK_FILL, tx, &done) :
+			    m0_btree_mput(tree, &recs[i], UT_BULK_BATCH, NULL,
+					  tx, &done);
+		M0_UT_ASSERT(rc == 0 && done == UT_BULK_BATCH);
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+	}
 
-		vsize = bt->vsize == RANDOM_VALUE_SIZE ?
-			GET_RANDOM_VALSIZE(value, i, 1, 1, crc_type) :
-			bt->vsize;
+	get_cb.c_act   = ut_btree_pget_cb;
+	get_cb.c_datum = &val;
+	for (i = 0; i < UT_BULK_NR; i++) {
+		rc = m0_btree_mget(tree, &keys[i], 1, &get_cb, &done);
+		M0_UT_ASSERT(rc == 0 && done == 1 && val == i * 3);
+	}
 
-		FILL_VALUE(value, vsize, key, crc_type);
+	M0_UT_ASSERT(tree->t_height == 2);
+	*leaves = bnode_rec_count(tree->t_desc->t_root);
 
+	for (i = 0; i < UT_BULK_NR; i += UT_BULK_BATCH) {
+		cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+		m0_btree_mdel_credit(tree, &keys[i], UT_BULK_BATCH,
+				     sizeof(uint64_t), &cred);
 		m0_be_ut_tx_init(tx, ut_be);
 		m0_be_tx_prep(tx, &cred);
 		rc = m0_be_tx_open_sync(tx);
 		M0_ASSERT(rc == 0);
-
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_put(tree, &rec,
-							   &ut_cb,
-							   &kv_op, tx));
-		M0_ASSERT(rc == 0 && put_data.flags == M0_BSC_SUCCESS);
+		rc = m0_btree_mdel(tree, &keys[i], UT_BULK_BATCH, NULL, tx,
+				   &done);
+		M0_UT_ASSERT(rc == 0 && done == UT_BULK_BATCH);
 		m0_be_tx_close_sync(tx);
 		m0_be_tx_fini(tx);
 	}
+	M0_UT_ASSERT(m0_btree_is_empty(tree));
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_close(tree, &b_op));
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_destroy_credit(tree, NULL, &cred, 1);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
 	M0_ASSERT(rc == 0);
-	M0_SET0(&btree);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(tree, &b_op, tx));
+	M0_ASSERT(rc == 0);
+	buf = M0_BUF_INIT(rnode_sz, rnode);
+	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+}
 
-	/**
-	 * Confirm root node on BE segment is valid and the opaque pointer in
-	 * the node is NULL.
-	 */
-	rnode_segaddr.as_core = (uint64_t)rnode;
-	nt = btree_node_format[segaddr_ntype_get(&rnode_segaddr)];
-	M0_ASSERT(nt->nt_isvalid(&rnode_segaddr) &&
-		  nt->nt_opaque_get(&rnode_segaddr) == NULL);
+/**
+ * This unit test loads the same sorted records with m0_btree_bulk_load() and
+ * with m0_btree_mput(). Both trees have to return all the records, the bulk
+ * loaded one has to use considerably fewer leaves.
+ */
+static void ut_btree_bulk_load(void)
+{
+	uint64_t             *keys;
+	uint64_t             *vals;
+	void                **kptr;
+	void                **vptr;
+	struct m0_btree_rec  *recs;
+	struct m0_btree_key  *bkeys;
+	m0_bcount_t           size = sizeof(uint64_t);
+	uint32_t              bulk_leaves;
+	uint32_t              leaves;
+	int                   i;
 
-	/** Re-map the BE segment.*/
-	m0_be_seg_close(ut_seg->bus_seg);
-	rc = madvise(rnode, rnode_sz, MADV_NORMAL);
-	M0_ASSERT(rc == -1 && errno == ENOMEM); /** Assert BE segment unmapped*/
-	m0_be_seg_open(ut_seg->bus_seg);
+	btree_ut_init();
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-				      m0_btree_open(rnode, rnode_sz, tree, seg,
-						    &b_op, NULL));
-	M0_ASSERT(rc == 0);
+	M0_ALLOC_ARR(keys, UT_BULK_NR);
+	M0_ALLOC_ARR(vals, UT_BULK_NR);
+	M0_ALLOC_ARR(kptr, UT_BULK_NR);
+	M0_ALLOC_ARR(vptr, UT_BULK_NR);
+	M0_ALLOC_ARR(recs, UT_BULK_NR);
+	M0_ALLOC_ARR(bkeys, UT_BULK_NR);
+	M0_UT_ASSERT(keys != NULL && vals != NULL && kptr != NULL &&
+		     vptr != NULL && recs != NULL && bkeys != NULL);
+
+	for (i = 0; i < UT_BULK_NR; i++) {
+		keys[i] = m0_byteorder_cpu_to_be64(i);
+		vals[i] = i * 3;
+		kptr[i] = &keys[i];
+		vptr[i] = &vals[i];
+		recs[i].r_key.k_data = M0_BUFVEC_INIT_BUF(&kptr[i], &size);
+		recs[i].r_val        = M0_BUFVEC_INIT_BUF(&vptr[i], &size);
+		recs[i].r_crc_type   = M0_BCT_NO_CRC;
+		bkeys[i]             = recs[i].r_key;
+	}
 
-	get_data.key            = &rec.r_key;
-	get_data.value          = &rec.r_val;
-	get_data.check_value    = false;
-	get_data.crc            = crc_type;
-	get_data.embedded_ksize = false;
-	get_data.embedded_vsize = false;
+	ut_btree_bulk_tree_run(true, recs, bkeys, &bulk_leaves);
+	ut_btree_bulk_tree_run(false, recs, bkeys, &leaves);
+	M0_UT_ASSERT(bulk_leaves * 3 < leaves * 2);
 
-	for (i = 1; i <= rec_count; i++) {
-		uint64_t             f_key;
-		void                *f_kptr  = &f_key;
-		m0_bcount_t          f_ksize = sizeof f_key;
-		struct m0_btree_key  key_in_tree;
+	m0_free(bkeys);
+	m0_free(recs);
+	m0_free(vptr);
+	m0_free(kptr);
+	m0_free(vals);
+	m0_free(keys);
+	btree_ut_fini();
+}
 
-		f_key              = m0_byteorder_cpu_to_be64(i);
-		key_in_tree.k_data = M0_BUFVEC_INIT_BUF(&f_kptr, &f_ksize);
-		vsize              = sizeof(value);
-		ut_cb.c_act        = ut_btree_kv_get_cb;
-		ut_cb.c_datum      = &get_data;
+enum {
+	UT_RANGE_NR    = 10000,
+	UT_RANGE_LIMIT = 700,
+};
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_get(tree, &key_in_tree,
-							   &ut_cb, BOF_EQUAL,
-							   &kv_op));
-		M0_ASSERT(rc == M0_BSC_SUCCESS &&
-			  i == m0_byteorder_be64_to_cpu(key));
+/** Returns m0_btree_count_range() of [from, to), negative bound is NULL. */
+static uint64_t ut_btree_range_count(struct m0_btree *tree, int64_t from,
+				     int64_t to)
+{
+	uint64_t             kfrom = m0_byteorder_cpu_to_be64(from);
+	uint64_t             kto   = m0_byteorder_cpu_to_be64(to);
+	void                *pfrom = &kfrom;
+	void                *pto   = &kto;
+	m0_bcount_t          size  = sizeof(uint64_t);
+	struct m0_btree_key  key_from;
+	struct m0_btree_key  key_to;
+	uint64_t             count;
+	int                  rc;
 
-		/** Update the Value of this Record. */
-		key = m0_byteorder_cpu_to_be64(i);
+	key_from.k_data = M0_BUFVEC_INIT_BUF(&pfrom, &size);
+	key_to.k_data   = M0_BUFVEC_INIT_BUF(&pto, &size);
+	rc = m0_btree_count_range(tree, from < 0 ? NULL : &key_from,
+				  to < 0 ? NULL : &key_to, &count);
+	M0_UT_ASSERT(rc == 0);
+	return count;
+}
 
-		vsize = bt->vsize == RANDOM_VALUE_SIZE ?
-			GET_RANDOM_VALSIZE(value, i, 1, 1, crc_type) :
-			bt->vsize;
+/**
+ * Deletes [from, to) with m0_btree_del_range() calls of UT_RANGE_LIMIT
+ * records, each in its own transaction. Returns the number of deleted records.
+ */
+static uint64_t ut_btree_range_del(struct m0_btree *tree, int64_t from,
+				   int64_t to)
+{
+	uint64_t                kfrom = m0_byteorder_cpu_to_be64(from);
+	uint64_t                kto   = m0_byteorder_cpu_to_be64(to);
+	void                   *pfrom = &kfrom;
+	void                   *pto   = &kto;
+	m0_bcount_t             size  = sizeof(uint64_t);
+	struct m0_btree_key     key_from;
+	struct m0_btree_key     key_to;
+	struct m0_be_tx         tx_data = {};
+	struct m0_be_tx        *tx      = &tx_data;
+	struct m0_be_tx_credit  cred;
+	uint64_t                total   = 0;
+	uint32_t                done;
+	int                     rc;
 
-		/** Modify Value for the above Key. */
-		kdata = m0_byteorder_cpu_to_be64(rec_count + i);
-		FILL_VALUE(value, vsize, kdata, crc_type);
+	key_from.k_data = M0_BUFVEC_INIT_BUF(&pfrom, &size);
+	key_to.k_data   = M0_BUFVEC_INIT_BUF(&pto, &size);
+	do {
+		cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+		m0_btree_del_credit(tree, UT_RANGE_LIMIT, size, size, &cred);
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
+		rc = m0_btree_del_range(tree, from < 0 ? NULL : &key_from,
+					to < 0 ? NULL : &key_to, UT_RANGE_LIMIT,
+					tx, &done);
+		M0_UT_ASSERT(rc == 0 && done <= UT_RANGE_LIMIT);
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+		total += done;
+	} while (done == UT_RANGE_LIMIT);
+	return total;
+}
+
+/** Returns the record count kept in the root, see M0_BTF_SUBTREE_COUNTS. */
+static uint64_t ut_btree_root_nr(struct m0_btree *tree)
+{
+	M0_UT_ASSERT(btree_is_counted(tree->t_desc));
+	return segaddr_subtree_nr(&tree->t_desc->t_root->n_addr);
+}
+
+static void ut_btree_range_run(uint32_t flags)
+{
+	void                       *rnode;
+	struct m0_be_tx             tx_data  = {};
+	struct m0_be_tx            *tx       = &tx_data;
+	struct m0_be_tx_credit      cred;
+	struct m0_btree_op          b_op     = {};
+	struct m0_btree            *tree;
+	struct m0_btree             btree;
+	const struct m0_btree_type  bt       = {
+						.tt_id = M0_BT_UT_KV_OPS,
+						.ksize = sizeof(uint64_t),
+						.vsize = sizeof(uint64_t),
+						.tt_flags = flags,
+					     };
+	bool                        counted  = flags & M0_BTF_SUBTREE_COUNTS;
+	uint64_t                   *keys;
+	uint64_t                   *vals;
+	void                      **kptr;
+	void                      **vptr;
+	struct m0_btree_rec        *recs;
+	struct m0_btree_cb          get_cb;
+	struct m0_btree_cursor      cursor;
+	struct m0_buf               kbuf;
+	m0_bcount_t                 size     = sizeof(uint64_t);
+	struct m0_buf               buf;
+	uint32_t                    rnode_sz = m0_pagesize_get();
+	struct m0_fid               fid      = M0_FID_TINIT('b', 0, 1);
+	uint32_t                    rnode_sz_shift;
+	uint64_t                    val;
+	uint32_t                    done;
+	uint32_t                    nr;
+	int                         i;
+	int                         rc;
+
+	M0_ALLOC_ARR(keys, UT_RANGE_NR);
+	M0_ALLOC_ARR(vals, UT_RANGE_NR);
+	M0_ALLOC_ARR(kptr, UT_RANGE_NR);
+	M0_ALLOC_ARR(vptr, UT_RANGE_NR);
+	M0_ALLOC_ARR(recs, UT_RANGE_NR);
+	M0_UT_ASSERT(keys != NULL && vals != NULL && kptr != NULL &&
+		     vptr != NULL && recs != NULL);
+
+	/** Keys are 10, 20, ..., so that range bounds may fall between. */
+	for (i = 0; i < UT_RANGE_NR; i++) {
+		keys[i] = m0_byteorder_cpu_to_be64((i + 1) * 10);
+		vals[i] = i * 3;
+		kptr[i] = &keys[i];
+		vptr[i] = &vals[i];
+		recs[i].r_key.k_data = M0_BUFVEC_INIT_BUF(&kptr[i], &size);
+		recs[i].r_val        = M0_BUFVEC_INIT_BUF(&vptr[i], &size);
+		recs[i].r_crc_type   = M0_BCT_NO_CRC;
+	}
+
+	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_create_credit(&bt, &cred, 1);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+	buf = M0_BUF_INIT(rnode_sz, NULL);
+	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	rnode = buf.b_addr;
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(rnode, rnode_sz,
+							     &bt,
+							     M0_BCT_NO_CRC,
+							     &b_op, &btree, seg,
+							     &fid, tx, NULL));
+	M0_ASSERT(rc == M0_BSC_SUCCESS);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+	tree = b_op.bo_arbor;
+
+	M0_UT_ASSERT(btree_is_counted(tree->t_desc) == counted);
+	M0_UT_ASSERT(ut_btree_range_count(tree, -1, -1) == 0);
+
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_btree_bulk_load_credit(tree, UT_RANGE_NR, size, size, 100, &cred);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+	rc = m0_btree_bulk_load(tree, recs, UT_RANGE_NR, 100, tx, &done);
+	M0_UT_ASSERT(rc == 0 && done == UT_RANGE_NR);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+
+	M0_UT_ASSERT(ut_btree_range_count(tree, -1, -1) == UT_RANGE_NR);
+	M0_UT_ASSERT(ut_btree_range_count(tree, 10, -1) == UT_RANGE_NR);
+	M0_UT_ASSERT(ut_btree_range_count(tree, 11, -1) == UT_RANGE_NR - 1);
+	M0_UT_ASSERT(ut_btree_range_count(tree, -1, 10) == 0);
+	M0_UT_ASSERT(ut_btree_range_count(tree, -1, 11) == 1);
+	M0_UT_ASSERT(ut_btree_range_count(tree, 100, 200) == 10);
+	M0_UT_ASSERT(ut_btree_range_count(tree, 95, 205) == 11);
+	M0_UT_ASSERT(ut_btree_range_count(tree, 500, 500) == 0);
+	M0_UT_ASSERT(ut_btree_range_count(tree, 600, 500) == 0);
+	M0_UT_ASSERT(ut_btree_range_count(tree, 20000, 80005) == 6001);
+	M0_UT_ASSERT(!counted || ut_btree_root_nr(tree) == UT_RANGE_NR);
+
+	/** Walk the tree with cursors prefetching leaves in both directions. */
+	m0_btree_cursor_init(&cursor, tree);
+	m0_btree_cursor_prefetch_set(&cursor, 8);
+	for (i = 0, rc = m0_btree_cursor_first(&cursor); rc == 0;
+	     i++, rc = m0_btree_cursor_next(&cursor)) {
+		m0_btree_cursor_kv_get(&cursor, &kbuf, NULL);
+		M0_UT_ASSERT(*(uint64_t *)kbuf.b_addr == keys[i]);
+	}
+	M0_UT_ASSERT(rc == -ENOENT && i == UT_RANGE_NR);
+	m0_btree_cursor_prefetch_set(&cursor, 1);
+	for (i = UT_RANGE_NR - 1, rc = m0_btree_cursor_last(&cursor); rc == 0;
+	     i--, rc = m0_btree_cursor_prev(&cursor)) {
+		m0_btree_cursor_kv_get(&cursor, &kbuf, NULL);
+		M0_UT_ASSERT(*(uint64_t *)kbuf.b_addr == keys[i]);
+	}
+	M0_UT_ASSERT(rc == -ENOENT && i == -1);
+	m0_btree_cursor_fini(&cursor);
+
+	/** Delete keys 20000 to 79990, i.e. records [1999, 7999). */
+	M0_UT_ASSERT(ut_btree_range_del(tree, 19995, 80000) == 6000);
+	M0_UT_ASSERT(ut_btree_range_count(tree, -1, -1) == UT_RANGE_NR - 6000);
+	M0_UT_ASSERT(ut_btree_range_count(tree, 19990, 80000) == 1);
+
+	get_cb.c_act   = ut_btree_pget_cb;
+	get_cb.c_datum = &val;
+	for (i = 0; i < UT_RANGE_NR; i++) {
+		rc = m0_btree_mget(tree, &recs[i].r_key, 1, &get_cb, &done);
+		M0_UT_ASSERT(rc == 0 && done == 1);
+		M0_UT_ASSERT(val == (i < 1999 || i >= 7999 ? i * 3 :
+				     UINT64_MAX));
+	}
+	M0_UT_ASSERT(!counted || ut_btree_root_nr(tree) == UT_RANGE_NR - 6000);
 
+	/** Put the deleted records back, counts follow the splits. */
+	for (i = 1999; i < 7999; i += nr) {
+		nr = min32u(UT_RANGE_LIMIT, 7999 - i);
+		cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+		m0_btree_mput_credit(tree, &recs[i], nr, &cred);
 		m0_be_ut_tx_init(tx, ut_be);
 		m0_be_tx_prep(tx, &cred);
 		rc = m0_be_tx_open_sync(tx);
 		M0_ASSERT(rc == 0);
-
-		ut_cb.c_act        = ut_btree_kv_update_cb;
-		ut_cb.c_datum      = &put_data;
-
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_update(tree, &rec,
-							      &ut_cb, 0,
-							      &kv_op, tx));
-		M0_ASSERT(rc == 0 && put_data.flags == M0_BSC_SUCCESS);
+		rc = m0_btree_mput(tree, &recs[i], nr, NULL, tx, &done);
+		M0_UT_ASSERT(rc == 0 && done == nr);
 		m0_be_tx_close_sync(tx);
 		m0_be_tx_fini(tx);
 	}
+	M0_UT_ASSERT(ut_btree_range_count(tree, -1, -1) == UT_RANGE_NR);
+	M0_UT_ASSERT(ut_btree_range_count(tree, 20000, 80005) == 6001);
+	M0_UT_ASSERT(!counted || ut_btree_root_nr(tree) == UT_RANGE_NR);
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_close(tree, &b_op));
+	M0_UT_ASSERT(ut_btree_range_del(tree, 95, 99995) == UT_RANGE_NR - 10);
+	M0_UT_ASSERT(ut_btree_range_count(tree, -1, -1) == 10);
+	M0_UT_ASSERT(!counted || ut_btree_root_nr(tree) == 10);
+	M0_UT_ASSERT(ut_btree_range_del(tree, -1, -1) == 10);
+	M0_UT_ASSERT(m0_btree_is_empty(tree));
+
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_destroy_credit(tree, NULL, &cred, 1);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
 	M0_ASSERT(rc == 0);
-	M0_SET0(&btree);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(tree, &b_op, tx));
+	M0_ASSERT(rc == 0);
+	buf = M0_BUF_INIT(rnode_sz, rnode);
+	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
 
-	/**
-	 * Confirm root node on BE segment is valid and the opaque pointer in
-	 * the node is NULL.
-	 */
-	rnode_segaddr.as_core = (uint64_t)rnode;
-	nt = btree_node_format[segaddr_ntype_get(&rnode_segaddr)];
-	M0_ASSERT(nt->nt_isvalid(&rnode_segaddr) &&
-		  nt->nt_opaque_get(&rnode_segaddr) == NULL);
+	m0_free(recs);
+	m0_free(vptr);
+	m0_free(kptr);
+	m0_free(vals);
+	m0_free(keys);
+}
 
-	/** Re-map the BE segment.*/
-	m0_be_seg_close(ut_seg->bus_seg);
-	rc = madvise(rnode, rnode_sz, MADV_NORMAL);
-	M0_ASSERT(rc == -1 && errno == ENOMEM); /** Assert BE segment unmapped*/
-	m0_be_seg_open(ut_seg->bus_seg);
+/**
+ * This unit test checks m0_btree_count_range() against the expected counts
+ * for various ranges and walks the records with prefetching cursors, then
+ * deletes a range in the middle of the tree with m0_btree_del_range() and
+ * verifies the records around its boundaries. It runs both on a plain tree and
+ * on a tree keeping subtree record counts.
+ */
+static void ut_btree_range_ops(void)
+{
+	btree_ut_init();
+	ut_btree_range_run(0);
+	ut_btree_range_run(M0_BTF_SUBTREE_COUNTS);
+	btree_ut_fini();
+}
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-				      m0_btree_open(rnode, rnode_sz, tree, seg,
-						    &b_op, NULL));
-	M0_ASSERT(rc == 0);
+/** Flips a bit of the value in place, breaking its CRC. */
+static int ut_btree_scrub_corrupt_cb(struct m0_btree_cb  *cb,
+				     struct m0_btree_rec *rec)
+{
+	*(char *)rec->r_val.ov_buf[0] ^= 1;
+	return 0;
+}
 
-	get_data.key            = &rec.r_key;
-	get_data.value          = &rec.r_val;
-	get_data.check_value    = false;
-	get_data.crc            = crc_type;
-	get_data.embedded_ksize = false;
-	get_data.embedded_vsize = false;
+/** Runs m0_btree_scrub_step()s of nr leaves until the walk completes. */
+static int ut_btree_scrub_pass(struct m0_btree_scrub *scrub, uint32_t nr)
+{
+	uint64_t pass  = scrub->bs_pass;
+	int      steps = 0;
+	int      rc;
 
-	for (i = 1; i <= rec_count; i++) {
-		uint64_t             f_key;
-		void                *f_kptr  = &f_key;
-		m0_bcount_t          f_ksize = sizeof f_key;
-		struct m0_btree_key  key_in_tree;
+	do {
+		rc = m0_btree_scrub_step(scrub, nr);
+		M0_UT_ASSERT(rc == 0);
+		steps++;
+	} while (scrub->bs_pass == pass);
+	return steps;
+}
 
-		f_key              = m0_byteorder_cpu_to_be64(i);
-		key_in_tree.k_data = M0_BUFVEC_INIT_BUF(&f_kptr, &f_ksize);
-		ut_cb.c_act        = ut_btree_kv_get_cb;
-		ut_cb.c_datum      = &get_data;
-		vsize              = sizeof(value);
+/**
+ * This unit test fills a tree with records carrying user CRCs, verifies them
+ * with incremental scrub steps, corrupts a record and checks that the next walk
+ * of the scrubber finds it.
+ */
+static void ut_btree_scrub(void)
+{
+	void                       *rnode;
+	struct m0_be_tx             tx_data  = {};
+	struct m0_be_tx            *tx       = &tx_data;
+	struct m0_be_tx_credit      cred;
+	struct m0_btree_op          b_op     = {};
+	struct m0_btree_op          kv_op    = {};
+	struct m0_btree            *tree;
+	struct m0_btree             btree;
+	const struct m0_btree_type  bt       = {
+						.tt_id = M0_BT_UT_KV_OPS,
+						.ksize = sizeof(uint64_t),
+						.vsize = 2 * sizeof(uint64_t),
+					     };
+	uint64_t                   *keys;
+	uint64_t                   *vals;
+	void                      **kptr;
+	void                      **vptr;
+	struct m0_btree_rec        *recs;
+	struct m0_btree_cb          cb       = {
+					.c_act = ut_btree_scrub_corrupt_cb,
+				     };
+	struct m0_btree_scrub       scrub;
+	m0_bcount_t                 ksize    = sizeof(uint64_t);
+	m0_bcount_t                 vsize    = 2 * sizeof(uint64_t);
+	struct m0_buf               buf;
+	uint32_t                    rnode_sz = m0_pagesize_get();
+	struct m0_fid               fid      = M0_FID_TINIT('b', 0, 1);
+	uint32_t                    rnode_sz_shift;
+	uint64_t                    leaves;
+	uint32_t                    done;
+	int                         steps;
+	int                         i;
+	int                         rc;
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_get(tree, &key_in_tree,
-							   &ut_cb, BOF_EQUAL,
-							   &kv_op));
-		M0_ASSERT(rc == M0_BSC_SUCCESS &&
-			  i == m0_byteorder_be64_to_cpu(key));
+	btree_ut_init();
+	m0_btree_crc_verify_set(M0_BCV_SCRUB);
+
+	M0_ALLOC_ARR(keys, UT_RANGE_NR);
+	M0_ALLOC_ARR(vals, 2 * UT_RANGE_NR);
+	M0_ALLOC_ARR(kptr, UT_RANGE_NR);
+	M0_ALLOC_ARR(vptr, UT_RANGE_NR);
+	M0_ALLOC_ARR(recs, UT_RANGE_NR);
+	M0_UT_ASSERT(keys != NULL && vals != NULL && kptr != NULL &&
+		     vptr != NULL && recs != NULL);
+
+	/** The last word of every value is the hash of the rest of it. */
+	for (i = 0; i < UT_RANGE_NR; i++) {
+		keys[i]         = m0_byteorder_cpu_to_be64(i + 1);
+		vals[2 * i]     = i * 7;
+		vals[2 * i + 1] = m0_hash_fnc_fnv1(&vals[2 * i],
+						   sizeof(uint64_t));
+		kptr[i] = &keys[i];
+		vptr[i] = &vals[2 * i];
+		recs[i].r_key.k_data = M0_BUFVEC_INIT_BUF(&kptr[i], &ksize);
+		recs[i].r_val        = M0_BUFVEC_INIT_BUF(&vptr[i], &vsize);
+		recs[i].r_crc_type   = M0_BCT_USER_ENC_RAW_HASH;
 	}
 
-	cred = M0_BE_TX_CREDIT(0, 0);
-	m0_btree_truncate_credit(tx, tree, &cred, &limit);
+	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_create_credit(&bt, &cred, 1);
 	m0_be_ut_tx_init(tx, ut_be);
 	m0_be_tx_prep(tx, &cred);
 	rc = m0_be_tx_open_sync(tx);
 	M0_ASSERT(rc == 0);
-
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-				      m0_btree_truncate(tree, limit, tx,
-							&kv_op));
+	buf = M0_BUF_INIT(rnode_sz, NULL);
+	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	rnode = buf.b_addr;
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+				      m0_btree_create(rnode, rnode_sz, &bt,
+						      M0_BCT_USER_ENC_RAW_HASH,
+						      &b_op, &btree, seg,
+						      &fid, tx, NULL));
+	M0_ASSERT(rc == M0_BSC_SUCCESS);
 	m0_be_tx_close_sync(tx);
 	m0_be_tx_fini(tx);
+	tree = b_op.bo_arbor;
 
-	/** Verify the tree is empty */
-	M0_ASSERT(m0_btree_is_empty(tree));
-
-	cred = M0_BE_TX_CREDIT(0, 0);
-	m0_btree_destroy_credit(tree, NULL, &cred, 1);
-
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_btree_bulk_load_credit(tree, UT_RANGE_NR, ksize, vsize, 100, &cred);
 	m0_be_ut_tx_init(tx, ut_be);
 	m0_be_tx_prep(tx, &cred);
 	rc = m0_be_tx_open_sync(tx);
 	M0_ASSERT(rc == 0);
-
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(tree, &b_op, tx));
-	M0_ASSERT(rc == 0);
-	M0_SET0(&btree);
-
+	rc = m0_btree_bulk_load(tree, recs, UT_RANGE_NR, 100, tx, &done);
+	M0_UT_ASSERT(rc == 0 && done == UT_RANGE_NR);
 	m0_be_tx_close_sync(tx);
 	m0_be_tx_fini(tx);
 
-	/** Delete temp node space which was used as root node for the tree. */
+	rc = m0_btree_scrub_init(&scrub, tree);
+	M0_UT_ASSERT(rc == 0);
+	steps  = ut_btree_scrub_pass(&scrub, 3);
+	leaves = scrub.bs_nodes;
+	M0_UT_ASSERT(scrub.bs_pass == 1 && scrub.bs_corrupt == 0);
+	M0_UT_ASSERT(leaves > 3 && steps == (leaves + 2) / 3);
+
+	/** Corrupt a record in the middle and the last record of the tree. */
+	for (i = UT_RANGE_NR / 2; i < UT_RANGE_NR; i += UT_RANGE_NR / 2 - 1) {
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_get(tree, &recs[i].r_key,
+							   &cb, BOF_EQUAL,
+							   &kv_op));
+		M0_UT_ASSERT(rc == 0);
+	}
+	ut_btree_scrub_pass(&scrub, 1);
+	M0_UT_ASSERT(scrub.bs_pass == 2 && scrub.bs_corrupt == 2);
+	M0_UT_ASSERT(scrub.bs_nodes == 2 * leaves);
+	m0_btree_scrub_fini(&scrub);
+
+	do {
+		cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+		m0_btree_del_credit(tree, UT_RANGE_LIMIT, ksize, vsize, &cred);
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
+		rc = m0_btree_del_range(tree, NULL, NULL, UT_RANGE_LIMIT, tx,
+					&done);
+		M0_UT_ASSERT(rc == 0);
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+	} while (done == UT_RANGE_LIMIT);
+	M0_UT_ASSERT(m0_btree_is_empty(tree));
+
 	cred = M0_BE_TX_CREDIT(0, 0);
 	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
 			       rnode_sz_shift, &cred);
-
+	m0_btree_destroy_credit(tree, NULL, &cred, 1);
 	m0_be_ut_tx_init(tx, ut_be);
 	m0_be_tx_prep(tx, &cred);
 	rc = m0_be_tx_open_sync(tx);
 	M0_ASSERT(rc == 0);
-
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(tree, &b_op, tx));
+	M0_ASSERT(rc == 0);
 	buf = M0_BUF_INIT(rnode_sz, rnode);
 	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
-
 	m0_be_tx_close_sync(tx);
 	m0_be_tx_fini(tx);
 
+	m0_free(recs);
+	m0_free(vptr);
+	m0_free(kptr);
+	m0_free(vals);
+	m0_free(keys);
+	m0_btree_crc_verify_set(M0_BCV_FIRST_FETCH);
 	btree_ut_fini();
 }
 
-/** TBD: Implement function to print the BTree. */
-M0_INTERNAL void btree_dbg_print(struct m0_btree btree)
+enum {
+	/** Number of records fitting into the root (leaf) node of the tree. */
+	UT_FF_FIND_NR = 64,
+};
+
+static int ut_btree_u128_cmp(const void *key0, const void *key1)
 {
+	return m0_uint128_cmp(key0, key1);
 }
 
-static void ut_btree_crc_persist_test(void)
+/**
+ * Populates a fixed format tree with 16-byte keys and checks that ff_find(),
+ * called on its root leaf node, finds every stored key and positions the slot
+ * of a missing key according to the key order of the tree.
+ */
+static void ut_btree_ff_find_run(struct m0_btree_rec_key_op *keycmp)
 {
-	struct btree_crc_data {
-		struct m0_btree_type    bcr_btree_type;
-		enum m0_btree_crc_type  bcr_crc_type;
-	} btrees_with_crc[] = {
-		{
-			{
-				BNT_FIXED_FORMAT, sizeof(uint64_t),
-				2 * sizeof(uint64_t)
-			},
-			M0_BCT_NO_CRC,
-		},
-		{
-			{
-				BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE,
-				sizeof(uint64_t), RANDOM_VALUE_SIZE
-			},
-			M0_BCT_NO_CRC,
-		},
-		{
-			{
-				BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE,
-				sizeof(uint64_t), RANDOM_VALUE_SIZE
-			},
-			M0_BCT_NO_CRC,
-		},
-		{
-			{
-				BNT_FIXED_FORMAT, sizeof(uint64_t),
-				3 * sizeof(uint64_t)
-			},
-			M0_BCT_USER_ENC_RAW_HASH,
-		},
-		{
-			{
-				BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE,
-				sizeof(uint64_t), RANDOM_VALUE_SIZE
-			},
-			M0_BCT_USER_ENC_RAW_HASH,
-		},
-		{
-			{
-				BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE,
-				sizeof(uint64_t), RANDOM_VALUE_SIZE
-			},
-			M0_BCT_USER_ENC_RAW_HASH,
-		},
-		{
-			{
-				BNT_FIXED_FORMAT, sizeof(uint64_t),
-				6 * sizeof(uint64_t)
-			},
-			M0_BCT_USER_ENC_FORMAT_FOOTER,
-		},
-		{
-			{
-				BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE,
-				sizeof(uint64_t), RANDOM_VALUE_SIZE
-			},
-			M0_BCT_USER_ENC_FORMAT_FOOTER,
-		},
-		{
-			{
-				BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE,
-				sizeof(uint64_t), RANDOM_VALUE_SIZE
-			},
-			M0_BCT_USER_ENC_FORMAT_FOOTER,
-		},
-		{
-			{
-				BNT_FIXED_FORMAT, sizeof(uint64_t),
-				2 * sizeof(uint64_t)
-			},
-			M0_BCT_BTREE_ENC_RAW_HASH,
-		},
-		{
-			{
-				BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE,
-				sizeof(uint64_t), RANDOM_VALUE_SIZE
-			},
-			M0_BCT_BTREE_ENC_RAW_HASH,
-		},
-		{
-			{
-				BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE,
-				RANDOM_VALUE_SIZE, RANDOM_VALUE_SIZE
-			},
-			M0_BCT_BTREE_ENC_RAW_HASH,
-		},
-	};
-	uint32_t test_count = ARRAY_SIZE(btrees_with_crc);
-	uint32_t i;
+	void                       *rnode;
+	struct m0_be_tx             tx_data  = {};
+	struct m0_be_tx            *tx       = &tx_data;
+	struct m0_be_tx_credit      cred;
+	struct m0_btree_op          b_op     = {};
+	struct m0_btree_op          kv_op    = {};
+	struct m0_btree            *tree;
+	struct m0_btree             btree;
+	const struct m0_btree_type  bt       = {
+						.tt_id = M0_BT_UT_KV_OPS,
+						.ksize = FF_KEY16_SIZE,
+						.vsize = sizeof(uint64_t),
+					       };
+	struct m0_uint128           keys[UT_FF_FIND_NR];
+	struct m0_uint128           key;
+	uint64_t                    value;
+	m0_bcount_t                 ksize    = sizeof key;
+	m0_bcount_t                 vsize    = sizeof value;
+	void                       *k_ptr    = &key;
+	void                       *v_ptr    = &value;
+	struct m0_btree_rec         rec      = {
+			    .r_key.k_data = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize),
+			    .r_val        = M0_BUFVEC_INIT_BUF(&v_ptr, &vsize),
+			    .r_crc_type   = M0_BCT_NO_CRC,
+			};
+	struct m0_btree_key         nkey;
+	void                       *p_nkey;
+	m0_bcount_t                 nksize;
+	struct m0_btree_cb          ut_cb;
+	struct ut_cb_data           put_data;
+	struct m0_buf               buf;
+	struct nd                  *root;
+	struct slot                 s;
+	uint32_t                    rnode_sz = m0_pagesize_get();
+	struct m0_fid               fid      = M0_FID_TINIT('b', 0, 1);
+	uint32_t                    rnode_sz_shift;
+	m0_bcount_t                 limit;
+	int                         i;
+	int                         rc;
+
+	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_create_credit(&bt, &cred, 1);
+
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
 
+	buf = M0_BUF_INIT(rnode_sz, NULL);
+	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	rnode = buf.b_addr;
 
-	for (i = 0; i < test_count; i++) {
-		struct m0_btree_type   *bt = &btrees_with_crc[i].bcr_btree_type;
-		enum m0_btree_crc_type  crc = btrees_with_crc[i].bcr_crc_type;
-		ut_btree_crc_persist_test_internal(bt, crc);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_create(rnode, rnode_sz,
+							     &bt, M0_BCT_NO_CRC,
+							     &b_op, &btree, seg,
+							     &fid, tx, keycmp));
+	M0_ASSERT(rc == M0_BSC_SUCCESS);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+	tree = b_op.bo_arbor;
+
+	cred = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	m0_btree_put_credit(tree, 1, ksize, vsize, &cred);
+	put_data.key   = &rec.r_key;
+	put_data.value = &rec.r_val;
+	ut_cb.c_act    = ut_btree_kv_put_cb;
+	ut_cb.c_datum  = &put_data;
+
+	/**
+	 * Random high halves make memcmp() and uint64_t orders of the keys
+	 * differ on little-endian machines, distinct low halves keep the keys
+	 * unique.
+	 */
+	for (i = 0; i < UT_FF_FIND_NR; i++) {
+		keys[i].u_hi = ((uint64_t)random() << 32) | random();
+		keys[i].u_lo = i;
+		key   = keys[i];
+		value = i;
+
+		m0_be_ut_tx_init(tx, ut_be);
+		m0_be_tx_prep(tx, &cred);
+		rc = m0_be_tx_open_sync(tx);
+		M0_ASSERT(rc == 0);
+		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					      m0_btree_put(tree, &rec, &ut_cb,
+							   &kv_op, tx));
+		M0_UT_ASSERT(rc == 0 && put_data.flags == M0_BSC_SUCCESS);
+		m0_be_tx_close_sync(tx);
+		m0_be_tx_fini(tx);
+	}
+
+	root = tree->t_desc->t_root;
+	M0_UT_ASSERT(root->n_type == &fixed_format && bnode_level(root) == 0);
+	M0_UT_ASSERT(bnode_key_count(root) == UT_FF_FIND_NR);
+
+	nkey.k_data = M0_BUFVEC_INIT_BUF(&p_nkey, &nksize);
+	s.s_node    = root;
+	s.s_rec.r_key = nkey;
+	for (i = 0; i < 2 * UT_FF_FIND_NR; i++) {
+		if (i < UT_FF_FIND_NR)
+			key = keys[i];
+		else {
+			key.u_hi = ((uint64_t)random() << 32) | random();
+			key.u_lo = i;
+		}
+		rc = ff_find(&s, &rec.r_key);
+		M0_UT_ASSERT(rc == (i < UT_FF_FIND_NR));
+		M0_UT_ASSERT(s.s_idx <= bnode_key_count(root));
+		if (s.s_idx < bnode_key_count(root)) {
+			bnode_key(&s);
+			M0_UT_ASSERT(M0_3WAY(bnode_key_cmp(root, &s.s_rec.r_key,
+							   &rec.r_key), 0) ==
+				     (rc ? 0 : 1));
+		}
+		if (s.s_idx > 0) {
+			s.s_idx--;
+			bnode_key(&s);
+			M0_UT_ASSERT(bnode_key_cmp(root, &s.s_rec.r_key,
+						   &rec.r_key) < 0);
+		}
+		M0_UT_ASSERT(bnode_find(&s, &rec.r_key) == rc);
+	}
+
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_btree_truncate_credit(tx, tree, &cred, &limit);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+				      m0_btree_truncate(tree, limit, tx,
+							&kv_op));
+	M0_UT_ASSERT(rc == 0);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+	M0_UT_ASSERT(m0_btree_is_empty(tree));
+
+	cred = M0_BE_TX_CREDIT(0, 0);
+	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_destroy_credit(tree, NULL, &cred, 1);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_ASSERT(rc == 0);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op, m0_btree_destroy(tree, &b_op, tx));
+	M0_ASSERT(rc == 0);
+	buf = M0_BUF_INIT(rnode_sz, rnode);
+	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+}
+
+/**
+ * Checks that the vectorised key comparison used by ff_find() orders 16-byte
+ * keys exactly as memcmp() does, including keys differing in a single byte,
+ * and that ff_find() searches real nodes of trees without key comparison
+ * function and with M0_BKF_U64 ordered one.
+ */
+static void ut_btree_ff_key_cmp(void)
+{
+	struct m0_btree_rec_key_op keycmp = {
+		.rko_keycmp = ut_btree_u128_cmp,
+		.rko_flags  = M0_BKF_U64,
+	};
+	uint8_t                    k0[FF_KEY16_SIZE];
+	uint8_t                    k1[FF_KEY16_SIZE];
+	struct m0_uint128          u0;
+	struct m0_uint128          u1;
+	int                        i;
+	int                        j;
+	int                        v;
+	int                        exp;
+
+	for (i = 0; i < 10000; i++) {
+		for (j = 0; j < FF_KEY16_SIZE; j++)
+			k0[j] = k1[j] = random();
+		if (i % 2 == 0) {
+			j = random() % FF_KEY16_SIZE;
+			k1[j] = random();
+		}
+		for (v = 0; v < 2; v++) {
+			exp = memcmp(k0, k1, sizeof k0);
+			M0_UT_ASSERT(M0_3WAY(ff_key16_cmp(k0, k1), 0) ==
+				     M0_3WAY(exp, 0));
+			M0_UT_ASSERT(M0_3WAY(ff_key_cmp(k0, k1, sizeof k0),
+					     0) == M0_3WAY(exp, 0));
+			memcpy(&u0, k0, sizeof u0);
+			memcpy(&u1, k1, sizeof u1);
+			exp = m0_uint128_cmp(&u0, &u1);
+			M0_UT_ASSERT(M0_3WAY(ff_key_u64_cmp(k0, k1, sizeof k0),
+					     0) == M0_3WAY(exp, 0));
+			memcpy(k1, k0, sizeof k0);
+		}
 	}
 
+	btree_ut_init();
+	ut_btree_ff_find_run(NULL);
+	ut_btree_ff_find_run(&keycmp);
+	btree_ut_fini();
 }
 
 static int ut_btree_suite_init(void)
@@ -13221,10 +16302,547 @@ struct m0_ut_suite btree_ut = {
 		{"btree_truncate",                  ut_btree_truncate},
 		{"btree_crc_test",                  ut_btree_crc_test},
 		{"btree_crc_persist_test",          ut_btree_crc_persist_test},
+		{"btree_ff_key_cmp",                ut_btree_ff_key_cmp},
+		{"btree_batch_ops",                 ut_btree_batch_ops},
+		{"btree_prefix_keys",               ut_btree_prefix_keys},
+		{"btree_parallel_get",              ut_btree_parallel_get},
+		{"btree_bulk_load",                 ut_btree_bulk_load},
+		{"btree_range_ops",                 ut_btree_range_ops},
+		{"btree_scrub",                     ut_btree_scrub},
 		{NULL, NULL}
 	}
 };
 
+/**
+ *  ------------------------------
+ *  Section START - Btree benchmark
+ *  ------------------------------
+ *
+ * Benchmark of m0_btree_put(), m0_btree_get(), cursor iteration and
+ * m0_btree_del(), run by m0ub (see ut/m0ub.c). Every benchmark processes
+ * ubc_nr records by ubc_threads threads sharing one tree and prints the
+ * throughput, the 50th and 99th percentile latencies of the operation and the
+ * node descriptor cache hit ratio. The configuration can be changed through
+ * the m0ub "-o" option, e.g.:
+ *
+ * @verbatim
+ * m0ub -t btree-ub -o type=vkvv,ksize=32,vsize=128,threads=8,nr=1000000
+ * @endverbatim
+ *
+ * type is one of ff, fkvv, vkvv or prefix (variable_kv_prefix_format).
+ */
+
+enum {
+	UB_BTREE_NR        = 100000,
+	UB_BTREE_TX_OPS    = 64,
+	UB_BTREE_THREADS   = 4,
+	UB_BTREE_KSIZE     = 16,
+	UB_BTREE_VSIZE     = 64,
+	UB_BTREE_VAL_MAX   = 1024,
+};
+
+static struct {
+	enum btree_node_type  ubc_type;
+	uint32_t              ubc_ksize;
+	uint32_t              ubc_vsize;
+	uint32_t              ubc_threads;
+	uint32_t              ubc_nr;
+	struct m0_btree      *ubc_tree;
+	struct m0_btree       ubc_btree;
+	struct m0_btree_type  ubc_bt;
+	void                 *ubc_rnode;
+	/** Latency of every operation of the current benchmark. */
+	m0_time_t            *ubc_lat;
+	m0_time_t             ubc_start;
+	m0_time_t             ubc_end;
+	uint64_t              ubc_hit;
+	uint64_t              ubc_miss;
+} ub_btree;
+
+struct ub_btree_thread {
+	struct m0_thread ubt_thread;
+	uint32_t         ubt_idx;
+	/** Operation to run on every record of the thread share. */
+	void           (*ubt_op)(struct ub_btree_thread *t, uint32_t i,
+				 struct m0_be_tx *tx);
+	bool             ubt_update;
+};
+
+static const char *ub_btree_type_names[] = {
+	[BNT_FIXED_FORMAT]                         = "ff",
+	[BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE]     = "fkvv",
+	[BNT_VARIABLE_KEYSIZE_VARIABLE_VALUESIZE]  = "vkvv",
+	[BNT_PREFIX_KEYSIZE_VARIABLE_VALUESIZE]    = "prefix",
+};
+
+/**
+ * Builds the key of i-th record. Multiplication by an odd constant is a
+ * bijection, so the keys are unique and inserted in a random order.
+ */
+static void ub_btree_key(uint32_t i, uint8_t *buf)
+{
+	uint64_t k = m0_byteorder_cpu_to_be64((i + 1) * 0x9E3779B97F4A7C15ULL);
+
+	memset(buf, 'k', ub_btree.ubc_ksize);
+	memcpy(buf, &k, min32u(sizeof k, ub_btree.ubc_ksize));
+}
+
+static int ub_btree_val_cb(struct m0_btree_cb *cb, struct m0_btree_rec *rec)
+{
+	struct m0_btree_rec *src = cb->c_datum;
+
+	if (rec->r_flags != M0_BSC_SUCCESS)
+		return -rec->r_flags;
+	if (src != NULL)
+		COPY_RECORD(rec, src);
+	return 0;
+}
+
+static void ub_btree_put(struct ub_btree_thread *t, uint32_t i,
+			 struct m0_be_tx *tx)
+{
+	uint8_t              kbuf[ub_btree.ubc_ksize];
+	uint8_t              vbuf[UB_BTREE_VAL_MAX];
+	void                *kptr  = kbuf;
+	void                *vptr  = vbuf;
+	m0_bcount_t          ksize = ub_btree.ubc_ksize;
+	m0_bcount_t          vsize = ub_btree.ubc_vsize;
+	struct m0_btree_rec  rec   = {
+		.r_key.k_data = M0_BUFVEC_INIT_BUF(&kptr, &ksize),
+		.r_val        = M0_BUFVEC_INIT_BUF(&vptr, &vsize),
+		.r_crc_type   = M0_BCT_NO_CRC,
+	};
+	struct m0_btree_cb   cb    = {
+		.c_act   = ub_btree_val_cb,
+		.c_datum = &rec,
+	};
+	struct m0_btree_op   kv_op = {};
+	int                  rc;
+
+	ub_btree_key(i, kbuf);
+	memset(vbuf, 'v', vsize);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+				      m0_btree_put(ub_btree.ubc_tree, &rec,
+						   &cb, &kv_op, tx));
+	M0_UB_ASSERT(rc == 0);
+}
+
+static void ub_btree_get(struct ub_btree_thread *t, uint32_t i,
+			 struct m0_be_tx *tx)
+{
+	uint8_t              kbuf[ub_btree.ubc_ksize];
+	void                *kptr  = kbuf;
+	m0_bcount_t          ksize = ub_btree.ubc_ksize;
+	struct m0_btree_key  key   = {
+		.k_data = M0_BUFVEC_INIT_BUF(&kptr, &ksize),
+	};
+	struct m0_btree_cb   cb    = { .c_act = ub_btree_val_cb };
+	struct m0_btree_op   kv_op = {};
+	int                  rc;
+
+	ub_btree_key(i, kbuf);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+				      m0_btree_get(ub_btree.ubc_tree, &key,
+						   &cb, BOF_EQUAL, &kv_op));
+	M0_UB_ASSERT(rc == 0);
+}
+
+static void ub_btree_del(struct ub_btree_thread *t, uint32_t i,
+			 struct m0_be_tx *tx)
+{
+	uint8_t              kbuf[ub_btree.ubc_ksize];
+	void                *kptr  = kbuf;
+	m0_bcount_t          ksize = ub_btree.ubc_ksize;
+	struct m0_btree_key  key   = {
+		.k_data = M0_BUFVEC_INIT_BUF(&kptr, &ksize),
+	};
+	struct m0_btree_op   kv_op = {};
+	int                  rc;
+
+	ub_btree_key(i, kbuf);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+				      m0_btree_del(ub_btree.ubc_tree, &key,
+						   NULL, &kv_op, tx));
+	M0_UB_ASSERT(rc == 0);
+}
+
+/**
+ * Runs t->ubt_op for every record of the thread share, UB_BTREE_TX_OPS
+ * records per transaction for updates. Transaction open and close are not
+ * included in the latencies.
+ */
+static void ub_btree_thread_run(struct ub_btree_thread *t)
+{
+	struct m0_be_tx         tx_data = {};
+	struct m0_be_tx        *tx      = NULL;
+	struct m0_be_tx_credit  cred    = {};
+	uint32_t                share   = ub_btree.ubc_nr /
+					  ub_btree.ubc_threads;
+	uint32_t                i;
+	uint32_t                j;
+	m0_time_t               start;
+	int                     rc;
+
+	if (t->ubt_update) {
+		m0_btree_put_credit(ub_btree.ubc_tree, UB_BTREE_TX_OPS,
+				    ub_btree.ubc_ksize, ub_btree.ubc_vsize,
+				    &cred);
+		m0_btree_del_credit(ub_btree.ubc_tree, UB_BTREE_TX_OPS,
+				    ub_btree.ubc_ksize, ub_btree.ubc_vsize,
+				    &cred);
+	}
+	for (i = t->ubt_idx * share; i < (t->ubt_idx + 1) * share;
+	     i += UB_BTREE_TX_OPS) {
+		if (t->ubt_update) {
+			tx = &tx_data;
+			M0_SET0(tx);
+			m0_be_ut_tx_init(tx, ut_be);
+			m0_be_tx_prep(tx, &cred);
+			rc = m0_be_tx_open_sync(tx);
+			M0_UB_ASSERT(rc == 0);
+		}
+		for (j = i; j < min32u(i + UB_BTREE_TX_OPS,
+				       (t->ubt_idx + 1) * share); j++) {
+			start = m0_time_now();
+			t->ubt_op(t, j, tx);
+			ub_btree.ubc_lat[j] = m0_time_now() - start;
+		}
+		if (t->ubt_update) {
+			m0_be_tx_close_sync(tx);
+			m0_be_tx_fini(tx);
+		}
+	}
+}
+
+/**
+ * Walks the thread share of records with a cursor. The keys are scrambled,
+ * so every thread starts from its own slice of the key space.
+ */
+static void ub_btree_thread_iter(struct ub_btree_thread *t)
+{
+	struct m0_btree_cursor  cursor;
+	uint64_t                kstart;
+	void                   *kptr  = &kstart;
+	m0_bcount_t             ksize = sizeof kstart;
+	struct m0_btree_key     key   = {
+		.k_data = M0_BUFVEC_INIT_BUF(&kptr, &ksize),
+	};
+	uint32_t                share = ub_btree.ubc_nr / ub_btree.ubc_threads;
+	uint32_t                i;
+	m0_time_t               start;
+	int                     rc;
+
+	kstart = m0_byteorder_cpu_to_be64(UINT64_MAX / ub_btree.ubc_threads *
+					  t->ubt_idx);
+	m0_btree_cursor_init(&cursor, ub_btree.ubc_tree);
+	rc = m0_btree_cursor_get(&cursor, &key, true);
+	for (i = t->ubt_idx * share; i < (t->ubt_idx + 1) * share; i++) {
+		start = m0_time_now();
+		rc = rc ?: m0_btree_cursor_next(&cursor);
+		if (rc == -ENOENT)
+			rc = m0_btree_cursor_first(&cursor);
+		M0_UB_ASSERT(rc == 0);
+		ub_btree.ubc_lat[i] = m0_time_now() - start;
+	}
+	m0_btree_cursor_fini(&cursor);
+}
+
+static void ub_btree_thread(struct ub_btree_thread *t)
+{
+	if (t->ubt_op != NULL)
+		ub_btree_thread_run(t);
+	else
+		ub_btree_thread_iter(t);
+}
+
+static int ub_btree_lat_cmp(const void *a, const void *b)
+{
+	return M0_3WAY(*(const m0_time_t *)a, *(const m0_time_t *)b);
+}
+
+/** Runs one benchmark round: op (or iteration if NULL) in every thread. */
+static void ub_btree_round(void (*op)(struct ub_btree_thread *, uint32_t,
+				      struct m0_be_tx *), bool update)
+{
+	struct ub_btree_thread *t;
+	uint32_t                i;
+	int                     rc;
+
+	M0_ALLOC_ARR(t, ub_btree.ubc_threads);
+	M0_UB_ASSERT(t != NULL);
+
+	m0_rwlock_read_lock(&list_lock);
+	ub_btree.ubc_hit  = lru_stats.ls_hit;
+	ub_btree.ubc_miss = lru_stats.ls_miss;
+	m0_rwlock_read_unlock(&list_lock);
+
+	ub_btree.ubc_start = m0_time_now();
+	for (i = 0; i < ub_btree.ubc_threads; i++) {
+		t[i].ubt_idx    = i;
+		t[i].ubt_op     = op;
+		t[i].ubt_update = update;
+		rc = M0_THREAD_INIT(&t[i].ubt_thread, struct ub_btree_thread *,
+				    NULL, &ub_btree_thread, &t[i],
+				    "btree-ub-%d", i);
+		M0_UB_ASSERT(rc == 0);
+	}
+	for (i = 0; i < ub_btree.ubc_threads; i++) {
+		m0_thread_join(&t[i].ubt_thread);
+		m0_thread_fini(&t[i].ubt_thread);
+	}
+	ub_btree.ubc_end = m0_time_now();
+	m0_free(t);
+}
+
+static void ub_btree_round_put(int iter)
+{
+	ub_btree_round(ub_btree_put, true);
+}
+
+static void ub_btree_round_get(int iter)
+{
+	ub_btree_round(ub_btree_get, false);
+}
+
+static void ub_btree_round_iter(int iter)
+{
+	ub_btree_round(NULL, false);
+}
+
+static void ub_btree_round_del(int iter)
+{
+	ub_btree_round(ub_btree_del, true);
+}
+
+/** Prints the results of the benchmark which just finished. */
+static void ub_btree_report(const char *name)
+{
+	uint32_t  nr = ub_btree.ubc_nr / ub_btree.ubc_threads *
+		       ub_btree.ubc_threads;
+	m0_time_t elapsed = max64u(ub_btree.ubc_end - ub_btree.ubc_start, 1);
+	uint64_t  hit;
+	uint64_t  miss;
+
+	m0_rwlock_read_lock(&list_lock);
+	hit  = lru_stats.ls_hit - ub_btree.ubc_hit;
+	miss = lru_stats.ls_miss - ub_btree.ubc_miss;
+	m0_rwlock_read_unlock(&list_lock);
+
+	qsort(ub_btree.ubc_lat, nr, sizeof ub_btree.ubc_lat[0],
+	      &ub_btree_lat_cmp);
+	printf("\n\t%s %s ksize=%u vsize=%u threads=%u nr=%u: %.0f ops/s, "
+	       "p50 %.2f us, p99 %.2f us, node cache hit %.1f%%, height %u\n",
+	       name, ub_btree_type_names[ub_btree.ubc_type],
+	       ub_btree.ubc_ksize, ub_btree.ubc_vsize, ub_btree.ubc_threads,
+	       nr, (double)nr * M0_TIME_ONE_SECOND / elapsed,
+	       ub_btree.ubc_lat[nr / 2] / 1000.0,
+	       ub_btree.ubc_lat[nr * 99 / 100] / 1000.0,
+	       hit + miss == 0 ? 100.0 : 100.0 * hit / (hit + miss),
+	       ub_btree.ubc_tree->t_height);
+}
+
+static void ub_btree_fini_put(void)
+{
+	ub_btree_report("put");
+}
+
+static void ub_btree_fini_get(void)
+{
+	ub_btree_report("get");
+}
+
+static void ub_btree_fini_iter(void)
+{
+	ub_btree_report("iter");
+}
+
+static void ub_btree_fini_del(void)
+{
+	ub_btree_report("del");
+}
+
+/** Parses "name=value,..." benchmark options. */
+static int ub_btree_opts_parse(const char *opts)
+{
+	char     *str;
+	char     *tok;
+	char     *save;
+	char      name[16];
+	char      val[16];
+	uint32_t  i;
+	int       rc = 0;
+
+	if (opts == NULL)
+		return 0;
+	str = m0_strdup(opts);
+	if (str == NULL)
+		return M0_ERR(-ENOMEM);
+	for (tok = strtok_r(str, ",", &save); tok != NULL && rc == 0;
+	     tok = strtok_r(NULL, ",", &save)) {
+		if (sscanf(tok, "%15[^=]=%15s", name, val) != 2)
+			rc = M0_ERR(-EINVAL);
+		else if (strcmp(name, "type") == 0) {
+			rc = M0_ERR(-EINVAL);
+			for (i = 0; i < ARRAY_SIZE(ub_btree_type_names); i++) {
+				if (ub_btree_type_names[i] != NULL &&
+				    strcmp(val, ub_btree_type_names[i]) == 0) {
+					ub_btree.ubc_type = i;
+					rc = 0;
+				}
+			}
+		} else if (strcmp(name, "ksize") == 0)
+			ub_btree.ubc_ksize = atoi(val);
+		else if (strcmp(name, "vsize") == 0)
+			ub_btree.ubc_vsize = atoi(val);
+		else if (strcmp(name, "threads") == 0)
+			ub_btree.ubc_threads = atoi(val);
+		else if (strcmp(name, "nr") == 0)
+			ub_btree.ubc_nr = atoi(val);
+		else
+			rc = M0_ERR(-EINVAL);
+	}
+	m0_free(str);
+	if (rc == 0 && (ub_btree.ubc_ksize < sizeof(uint64_t) ||
+			ub_btree.ubc_vsize == 0 ||
+			ub_btree.ubc_vsize > UB_BTREE_VAL_MAX ||
+			ub_btree.ubc_threads == 0 ||
+			ub_btree.ubc_nr < ub_btree.ubc_threads))
+		rc = M0_ERR(-EINVAL);
+	return rc;
+}
+
+static int ub_btree_init(const char *opts)
+{
+	struct m0_be_tx         tx_data  = {};
+	struct m0_be_tx        *tx       = &tx_data;
+	struct m0_be_tx_credit  cred     = M0_BE_TX_CB_CREDIT(0, 0, 0);
+	struct m0_btree_op      b_op     = {};
+	struct m0_buf           buf;
+	uint32_t                rnode_sz = m0_pagesize_get();
+	uint32_t                rnode_sz_shift;
+	struct m0_fid           fid      = M0_FID_TINIT('b', 0, 1);
+	struct m0_btree_type   *bt       = &ub_btree.ubc_bt;
+	int                     rc;
+
+	ub_btree.ubc_type    = BNT_FIXED_FORMAT;
+	ub_btree.ubc_ksize   = UB_BTREE_KSIZE;
+	ub_btree.ubc_vsize   = UB_BTREE_VSIZE;
+	ub_btree.ubc_threads = UB_BTREE_THREADS;
+	ub_btree.ubc_nr      = UB_BTREE_NR;
+	rc = ub_btree_opts_parse(opts);
+	if (rc != 0)
+		return rc;
+
+	M0_ALLOC_ARR(ub_btree.ubc_lat, ub_btree.ubc_nr);
+	if (ub_btree.ubc_lat == NULL)
+		return M0_ERR(-ENOMEM);
+
+	bt->tt_id    = M0_BT_UT_KV_OPS;
+	bt->ksize    = ub_btree.ubc_type == BNT_FIXED_FORMAT ||
+		       ub_btree.ubc_type ==
+		       BNT_FIXED_KEYSIZE_VARIABLE_VALUESIZE ?
+		       ub_btree.ubc_ksize : -1;
+	bt->vsize    = ub_btree.ubc_type == BNT_FIXED_FORMAT ?
+		       ub_btree.ubc_vsize : -1;
+	bt->tt_flags = ub_btree.ubc_type ==
+		       BNT_PREFIX_KEYSIZE_VARIABLE_VALUESIZE ?
+		       M0_BTF_PREFIX_KEYS : 0;
+
+	ut_btree_suite_init();
+
+	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
+	m0_be_allocator_credit(NULL, M0_BAO_ALLOC_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_create_credit(bt, &cred, 1);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_UB_ASSERT(rc == 0);
+	buf = M0_BUF_INIT(rnode_sz, NULL);
+	M0_BE_ALLOC_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	ub_btree.ubc_rnode = buf.b_addr;
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+				      m0_btree_create(ub_btree.ubc_rnode,
+						      rnode_sz, bt,
+						      M0_BCT_NO_CRC, &b_op,
+						      &ub_btree.ubc_btree,
+						      seg, &fid, tx, NULL));
+	M0_UB_ASSERT(rc == 0);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+	ub_btree.ubc_tree = b_op.bo_arbor;
+	return 0;
+}
+
+static void ub_btree_fini(void)
+{
+	struct m0_be_tx         tx_data  = {};
+	struct m0_be_tx        *tx       = &tx_data;
+	struct m0_be_tx_credit  cred     = M0_BE_TX_CREDIT(0, 0);
+	struct m0_btree_op      b_op     = {};
+	struct m0_buf           buf;
+	uint32_t                rnode_sz = m0_pagesize_get();
+	uint32_t                rnode_sz_shift;
+	int                     rc;
+
+	M0_UB_ASSERT(m0_btree_is_empty(ub_btree.ubc_tree));
+	rnode_sz_shift = __builtin_ffsl(rnode_sz) - 1;
+	m0_be_allocator_credit(NULL, M0_BAO_FREE_ALIGNED, rnode_sz,
+			       rnode_sz_shift, &cred);
+	m0_btree_destroy_credit(ub_btree.ubc_tree, NULL, &cred, 1);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_UB_ASSERT(rc == 0);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
+				      m0_btree_destroy(ub_btree.ubc_tree,
+						       &b_op, tx));
+	M0_UB_ASSERT(rc == 0);
+	buf = M0_BUF_INIT(rnode_sz, ub_btree.ubc_rnode);
+	M0_BE_FREE_ALIGN_BUF_SYNC(&buf, rnode_sz_shift, seg, tx);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+
+	ut_btree_suite_fini();
+	m0_free(ub_btree.ubc_lat);
+}
+
+/** Benchmarks are run in order: the tree is emptied by the last one. */
+struct m0_ub_set m0_btree_ub = {
+	.us_name = "btree-ub",
+	.us_init = ub_btree_init,
+	.us_fini = ub_btree_fini,
+	.us_run  = {
+		{ .ub_name  = "put",
+		  .ub_iter  = 1,
+		  .ub_round = ub_btree_round_put,
+		  .ub_fini  = ub_btree_fini_put },
+
+		{ .ub_name  = "get",
+		  .ub_iter  = 1,
+		  .ub_round = ub_btree_round_get,
+		  .ub_fini  = ub_btree_fini_get },
+
+		{ .ub_name  = "iter",
+		  .ub_iter  = 1,
+		  .ub_round = ub_btree_round_iter,
+		  .ub_fini  = ub_btree_fini_iter },
+
+		{ .ub_name  = "del",
+		  .ub_iter  = 1,
+		  .ub_round = ub_btree_round_del,
+		  .ub_fini  = ub_btree_fini_del },
+
+		{ .ub_name = NULL }
+	}
+};
+
+/**
+ *  ----------------------------
+ *  Section END - Btree benchmark
+ *  ----------------------------
+ */
+
 #endif  /** KERNEL */
 #undef M0_TRACE_SUBSYSTEM
 
@@ -102,10 +102,53 @@ enum m0_btree_crc_type {
 	M0_BCT_BTREE_ENC_RAW_HASH,
 };
 
+/**
+ * When the CRCs of the records of the leaf nodes of trees with crc type other
+ * than M0_BCT_NO_CRC are verified. See m0_btree_crc_verify_set().
+ */
+enum m0_btree_crc_verify {
+	/**
+	 *  Verify the leaf every time it is fetched while not in use, that is
+	 *  also when its node descriptor is taken back from the LRU list.
+	 */
+	M0_BCV_FETCH,
+	/**
+	 *  Verify the leaf the first time it is fetched after the restart, or
+	 *  after its node descriptor was purged from the LRU list. This is the
+	 *  default.
+	 */
+	M0_BCV_FIRST_FETCH,
+	/**
+	 *  Do not verify on fetch, leaves are verified by m0_btree_scrub_step()
+	 *  which is expected to be called periodically by the owner of the tree.
+	 */
+	M0_BCV_SCRUB,
+};
+
+enum m0_btree_type_flags {
+	/**
+	 *  Internal nodes of the tree keep the shortest key prefixes which
+	 *  separate the child nodes, instead of the full copies of the leaf keys.
+	 *  This is only used by the trees with variable key size and without
+	 *  user provided key comparison function, the flag is ignored otherwise.
+	 */
+	M0_BTF_PREFIX_KEYS = 1 << 0,
+	/**
+	 *  Every node of the tree keeps the number of records in its subtree.
+	 *  m0_btree_count_range() and m0_btree_del_range() use the counts to
+	 *  skip the subtrees entirely within the range. The mark is persistent,
+	 *  it is taken from the root when the tree is opened. Counts are only
+	 *  exact again after m0_btree_truncate() has emptied the tree.
+	 */
+	M0_BTF_SUBTREE_COUNTS = 1 << 1,
+};
+
 struct m0_btree_type {
 	enum m0_btree_types tt_id;
 	int ksize;
 	int vsize;
+	/** Bitmask of m0_btree_type_flags. */
+	uint32_t tt_flags;
 };
 
 
@@ -131,12 +174,33 @@ struct m0_btree_cb {
 	void *c_datum;
 };
 
+/**
+ * Properties of the key ordering implemented by m0_btree_rec_key_op.
+ *
+ * They allow the node search routines of fixed key size formats to compare
+ * keys directly, without calling rko_keycmp() for every probe. A flag may only
+ * be set if rko_keycmp() orders every pair of keys of the tree exactly as
+ * described, including returning 0 only for identical keys.
+ */
+enum m0_btree_keycmp_flags {
+	/** rko_keycmp() orders keys as memcmp() of the whole key does. */
+	M0_BKF_MEMCMP = 1 << 0,
+	/**
+	 * Keys are arrays of uint64_t in native byte order (e.g. struct m0_fid,
+	 * struct m0_uint128 or a single uint64_t) and rko_keycmp() compares
+	 * them element by element, as m0_fid_cmp() does.
+	 */
+	M0_BKF_U64    = 1 << 1,
+};
+
 struct m0_btree_rec_key_op {
 	/**
 	 * Key comparison function will return -ve, 0 or +ve value depending on
 	 * how key0 and key1 compare in key ordering.
 	 */
-	int (*rko_keycmp)(const void *key0, const void *key1);
+	int      (*rko_keycmp)(const void *key0, const void *key1);
+	/** Bitmask of m0_btree_keycmp_flags describing rko_keycmp(). */
+	uint32_t rko_flags;
 };
 /**
  * This structure is used to hold the data that is passed to m0_tree_create.
@@ -153,6 +217,25 @@ struct m0_btree_idata {
 	struct m0_fid                fid;
 };
 
+/**
+ * State of an incremental walk over the leaves of a tree verifying their record
+ * CRCs, see m0_btree_scrub_step().
+ */
+struct m0_btree_scrub {
+	struct m0_btree *bs_arbor;
+	/** First key of the leaf where the next step starts. */
+	void            *bs_key;
+	/** Size of bs_key, 0 if the next step starts from the smallest key. */
+	m0_bcount_t      bs_ksize;
+	m0_bcount_t      bs_bufsize;
+	/** Number of leaves verified so far. */
+	uint64_t         bs_nodes;
+	/** Number of records with mismatching CRC found so far. */
+	uint64_t         bs_corrupt;
+	/** Number of completed walks over the whole tree. */
+	uint64_t         bs_pass;
+};
+
 enum m0_btree_rec_type {
 	M0_BRT_VALUE = 1,
 	M0_BRT_CHILD = 2,
@@ -181,6 +264,11 @@ enum m0_btree_op_flags {
 	BOF_EQUAL                   = M0_BITS(4),
 	BOF_SLANT                   = M0_BITS(5),
 	BOF_INSERT_IF_NOT_FOUND     = M0_BITS(6),
+	/**
+	 * Records are inserted in key order past the existing ones, see
+	 * m0_btree_bulk_load().
+	 */
+	BOF_APPEND                  = M0_BITS(7),
 };
 
 /**
@@ -198,6 +286,11 @@ enum m0_btree_opflag {
 	M0_BOF_UNIQUE = 1 << 0
 };
 
+enum {
+	/** Default leaf prefetch distance of btree cursors. */
+	M0_BTREE_CURSOR_PREFETCH = 4,
+};
+
 /**
  * Users for triggering LRU list purge.
  */
@@ -283,6 +376,15 @@ M0_INTERNAL void m0_btree_truncate_credit(struct m0_be_tx        *tx,
 					  struct m0_btree        *tree,
 					  struct m0_be_tx_credit *accum,
 					  m0_bcount_t            *limit);
+
+/**
+ * Calculates the credits for freeing at most "nr" nodes of the tree by
+ * m0_btree_truncate(). Used by callers that want smaller transactions than
+ * m0_btree_truncate_credit() allows.
+ */
+M0_INTERNAL void m0_btree_truncate_nr_credit(struct m0_btree        *tree,
+					     struct m0_be_tx_credit *accum,
+					     m0_bcount_t             nr);
 /**
  * Btree functions related to tree management
  */
@@ -497,6 +599,129 @@ M0_INTERNAL void m0_btree_truncate(struct m0_btree *arbor, m0_bcount_t limit,
 				   struct m0_be_tx *tx,
 				   struct m0_btree_op *bop);
 
+/**
+ * Batched lookup of nr keys.
+ *
+ * Keys must be sorted in the key order of the tree. The callback is invoked
+ * once per key, in order. For a key which is not present in the tree, the
+ * callback receives the searched key, an empty value and r_flags set to
+ * M0_BSC_KEY_NOT_FOUND. Consecutive keys falling into the same leaf are looked
+ * up in that leaf without walking down from the root again.
+ *
+ * The operation is synchronous and holds the tree lock for the whole batch.
+ *
+ * @param arbor   is the pointer to btree.
+ * @param keys    array of nr sorted keys.
+ * @param cb      callback invoked for every key.
+ * @param nr_done if not NULL, returns the number of keys fully processed.
+ *
+ * @return 0 if successful, otherwise the first error returned by the callback
+ *         or by the tree.
+ */
+M0_INTERNAL int m0_btree_mget(struct m0_btree *arbor,
+			      const struct m0_btree_key *keys, uint32_t nr,
+			      const struct m0_btree_cb *cb, uint32_t *nr_done);
+
+/**
+ * Batched insertion of nr records sorted by key.
+ *
+ * If cb is NULL, key and value of every record are copied into the tree,
+ * otherwise cb is invoked for every record, in order, as m0_btree_put() would
+ * do. The transaction should have credits for the whole batch, see
+ * m0_btree_mput_credit(). Processing stops at the first failure.
+ */
+M0_INTERNAL int m0_btree_mput(struct m0_btree *arbor,
+			      const struct m0_btree_rec *recs, uint32_t nr,
+			      const struct m0_btree_cb *cb, struct m0_be_tx *tx,
+			      uint32_t *nr_done);
+
+/**
+ * Loads nr records sorted by key into the tree. All the keys should be greater
+ * than the keys already present in the tree, e.g. the tree is empty or was
+ * populated by the previous m0_btree_bulk_load() calls.
+ *
+ * Unlike m0_btree_mput(), the nodes filled by the records are split so that
+ * they remain filled up to fill percent, instead of being split in halves, and
+ * upper levels receive a separator per such node. The resulting tree has the
+ * same shape as a tree built bottom-up. The transaction should have credits
+ * for the whole batch, see m0_btree_bulk_load_credit(). Key and value of every
+ * record are copied into the tree. Processing stops at the first failure.
+ *
+ * @param fill node fill factor in percent, 1 to 100.
+ */
+M0_INTERNAL int m0_btree_bulk_load(struct m0_btree *arbor,
+				   const struct m0_btree_rec *recs, uint32_t nr,
+				   uint32_t fill, struct m0_be_tx *tx,
+				   uint32_t *nr_done);
+
+/**
+ * Deletes up to limit records with keys in [from, to), in key order. NULL from
+ * or to means that the range is not bounded from that side.
+ *
+ * Only the nodes on the boundaries of the range are edited record by record,
+ * the leaves entirely within the range are unlinked from their parents and
+ * freed as a whole. With M0_BTF_SUBTREE_COUNTS whole subtrees are freed
+ * without looking at their keys, so the cost depends on the tree height and
+ * the number of nodes freed rather than on the number of records.
+ *
+ * The number of deleted records is returned in nr_done. If it equals limit,
+ * more records of the range may remain in the tree and the call should be
+ * repeated, possibly in another transaction. The transaction should have
+ * m0_btree_del_credit() for limit records.
+ */
+M0_INTERNAL int m0_btree_del_range(struct m0_btree *arbor,
+				   const struct m0_btree_key *from,
+				   const struct m0_btree_key *to,
+				   uint32_t limit, struct m0_be_tx *tx,
+				   uint32_t *nr_done);
+
+/**
+ * Counts the records with keys in [from, to). NULL from or to means that the
+ * range is not bounded from that side.
+ *
+ * Only the nodes on the boundaries of the range are searched, the leaves
+ * entirely within the range contribute their record counts, so the cost is
+ * proportional to the number of leaves in the range rather than to the number
+ * of records. With M0_BTF_SUBTREE_COUNTS the subtrees entirely within the range
+ * contribute the counts kept in their roots and the cost is proportional to
+ * the tree height.
+ */
+M0_INTERNAL int m0_btree_count_range(struct m0_btree *arbor,
+				     const struct m0_btree_key *from,
+				     const struct m0_btree_key *to,
+				     uint64_t *count);
+
+/**
+ * Sets the mode of the verification of the record CRCs of the leaf nodes for
+ * all the trees. The default is M0_BCV_FIRST_FETCH.
+ */
+M0_INTERNAL void m0_btree_crc_verify_set(enum m0_btree_crc_verify mode);
+
+M0_INTERNAL int  m0_btree_scrub_init(struct m0_btree_scrub *scrub,
+				     struct m0_btree       *arbor);
+M0_INTERNAL void m0_btree_scrub_fini(struct m0_btree_scrub *scrub);
+
+/**
+ * Verifies the record CRCs of up to nr leaves of the tree, starting where the
+ * previous step stopped. When the last leaf of the tree is verified the walk
+ * starts again from the first one and scrub->bs_pass is incremented.
+ *
+ * Only the tree read lock is held by the step, so a background scrubber with a
+ * small nr does not stall the lookups. Corrupted records are reported and
+ * counted in scrub->bs_corrupt but not deleted, as there is no transaction to
+ * delete them in.
+ */
+M0_INTERNAL int  m0_btree_scrub_step(struct m0_btree_scrub *scrub, uint32_t nr);
+
+/**
+ * Batched deletion of nr keys sorted in the key order of the tree.
+ * Processing stops at the first failure.
+ */
+M0_INTERNAL int m0_btree_mdel(struct m0_btree *arbor,
+			      const struct m0_btree_key *keys, uint32_t nr,
+			      const struct m0_btree_cb *cb, struct m0_be_tx *tx,
+			      uint32_t *nr_done);
+
 /**
  * Initialises cursor and its internal structures.
  *
@@ -527,6 +752,18 @@ M0_INTERNAL int m0_btree_cursor_get(struct m0_btree_cursor    *it,
 				    const struct m0_btree_key *key,
 				    bool                       slant);
 
+/**
+ * Sets the number of leaves, ahead of the current one, whose pages are
+ * requested from the BE segment in advance by m0_btree_cursor_next() and
+ * m0_btree_cursor_prev(). Zero disables the prefetch. The default is
+ * M0_BTREE_CURSOR_PREFETCH.
+ *
+ * @param it  is pointer to cursor structure.
+ * @param nr  prefetch distance in leaves.
+ */
+M0_INTERNAL void m0_btree_cursor_prefetch_set(struct m0_btree_cursor *it,
+					      uint32_t                nr);
+
 /**
  * Fills cursor internal buffers with key and value obtained from the
  * next position in tree. The operation is unprotected from concurrent btree
@@ -725,6 +962,38 @@ M0_INTERNAL void m0_btree_del_credit2(const struct m0_btree_type *type,
 				      m0_bcount_t                 vsize,
 				      struct m0_be_tx_credit     *accum);
 
+/**
+ * Calculates credits required to m0_btree_mput() nr records and adds them to
+ * accum. Actual key and value size of every record is taken into account.
+ */
+M0_INTERNAL void m0_btree_mput_credit(const struct m0_btree    *arbor,
+				      const struct m0_btree_rec *recs,
+				      uint32_t                   nr,
+				      struct m0_be_tx_credit    *accum);
+
+/**
+ * Calculates credits required to m0_btree_mdel() nr keys, assuming that each
+ * deleted value has size vsize, and adds them to accum.
+ */
+M0_INTERNAL void m0_btree_mdel_credit(const struct m0_btree     *arbor,
+				      const struct m0_btree_key *keys,
+				      uint32_t                   nr,
+				      m0_bcount_t                vsize,
+				      struct m0_be_tx_credit    *accum);
+
+/**
+ * Calculates credits required to m0_btree_bulk_load() nr records with key size
+ * ksize and value size vsize with given fill factor and adds them to accum.
+ * This is much less than m0_btree_mput_credit() for the same records, because
+ * appended records do not split nodes on every insertion.
+ */
+M0_INTERNAL void m0_btree_bulk_load_credit(const struct m0_btree  *arbor,
+					   uint32_t                nr,
+					   m0_bcount_t             ksize,
+					   m0_bcount_t             vsize,
+					   uint32_t                fill,
+					   struct m0_be_tx_credit *accum);
+
 #include "btree/internal.h"
 
 M0_INTERNAL int     m0_btree_mod_init(void);
@@ -738,6 +1007,10 @@ M0_INTERNAL void    m0_btree_lrulist_set_lru_config(int64_t slow_lru_mem_release
 						    int64_t wm_low,
 						    int64_t wm_target,
 						    int64_t wm_high);
+M0_INTERNAL void    m0_btree_lrulist_get_lru_config(int64_t *slow_release,
+						    int64_t *wm_low,
+						    int64_t *wm_target,
+						    int64_t *wm_high);
 
 #define M0_BTREE_OP_SYNC_WITH_RC(bop, action)                           \
 	({                                                              \
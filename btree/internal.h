@@ -48,6 +48,10 @@ struct m0_btree_op {
 	struct m0_be_seg           *bo_seg;
 	uint64_t                    bo_flags;
 	m0_bcount_t                 bo_limit;
+	/** Node fill factor in percent for BOF_APPEND operations. */
+	uint32_t                    bo_fill;
+	/** Leaf prefetch distance of M0_BO_ITER, see btree_iter_prefetch(). */
+	uint32_t                    bo_prefetch;
 	struct m0_btree_oimpl      *bo_i;
 	struct m0_btree_idata       bo_data;
 	struct m0_btree_rec_key_op  bo_keycmp;
@@ -69,6 +73,8 @@ struct m0_btree_cursor {
 	struct m0_buf    bc_val;
 	struct m0_btree *bc_arbor;
 	struct m0_be_op  bc_op;
+	/** Number of leaves to prefetch ahead of the cursor. */
+	uint32_t         bc_prefetch;
 };
 
 struct td;
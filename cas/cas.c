@@ -64,7 +64,8 @@ static int cas_fops_init(const struct m0_sm_conf           *sm_conf,
 			 .xt        = m0_cas_op_xc,
 			 .fom_ops   = fom_ops,
 			 .sm        = sm_conf,
-			 .svc_type  = svctype);
+			 .svc_type  = svctype,
+			 .flags     = M0_FOP_TYPE_FLAG_DECODE_ARENA);
 	M0_FOP_TYPE_INIT(&cas_put_fopt,
 			 .name      = "cas-put",
 			 .opcode    = M0_CAS_PUT_FOP_OPCODE,
@@ -73,7 +74,8 @@ static int cas_fops_init(const struct m0_sm_conf           *sm_conf,
 			 .xt        = m0_cas_op_xc,
 			 .fom_ops   = fom_ops,
 			 .sm        = sm_conf,
-			 .svc_type  = svctype);
+			 .svc_type  = svctype,
+			 .flags     = M0_FOP_TYPE_FLAG_DECODE_ARENA);
 	M0_FOP_TYPE_INIT(&cas_del_fopt,
 			 .name      = "cas-del",
 			 .opcode    = M0_CAS_DEL_FOP_OPCODE,
@@ -82,7 +84,8 @@ static int cas_fops_init(const struct m0_sm_conf           *sm_conf,
 			 .xt        = m0_cas_op_xc,
 			 .fom_ops   = fom_ops,
 			 .sm        = sm_conf,
-			 .svc_type  = svctype);
+			 .svc_type  = svctype,
+			 .flags     = M0_FOP_TYPE_FLAG_DECODE_ARENA);
 	M0_FOP_TYPE_INIT(&cas_cur_fopt,
 			 .name      = "cas-cur",
 			 .opcode    = M0_CAS_CUR_FOP_OPCODE,
@@ -90,7 +93,8 @@ static int cas_fops_init(const struct m0_sm_conf           *sm_conf,
 			 .xt        = m0_cas_op_xc,
 			 .fom_ops   = fom_ops,
 			 .sm        = sm_conf,
-			 .svc_type  = svctype);
+			 .svc_type  = svctype,
+			 .flags     = M0_FOP_TYPE_FLAG_DECODE_ARENA);
 	M0_FOP_TYPE_INIT(&cas_rep_fopt,
 			 .name      = "cas-rep",
 			 .opcode    = M0_CAS_REP_FOP_OPCODE,
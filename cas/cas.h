@@ -342,8 +342,49 @@ enum m0_cas_op_flags {
 	 * NO DTM is needed for this operation.
 	 */
 	COF_NO_DTM = 1 << 11,
+	/**
+	 * NEXT returns only records with keys starting with
+	 * m0_cas_filter::cf_prefix. Iteration is started at the prefix if the
+	 * start key is smaller and ends with -ENOENT at the first key past the
+	 * prefix. Filtered out records are not counted against the number of
+	 * requested records.
+	 */
+	COF_PREFIX    = 1 << 12,
+	/**
+	 * NEXT ends with -ENOENT at the first key greater than or equal to
+	 * m0_cas_filter::cf_end.
+	 */
+	COF_END_KEY   = 1 << 13,
+	/**
+	 * NEXT rolls up keys containing m0_cas_filter::cf_delim after the
+	 * prefix (or after the beginning of the key without ::COF_PREFIX)
+	 * into a single record. Key of this record is the common prefix up to
+	 * and including the delimiter, its value is empty. Keys under the
+	 * common prefix are skipped on the service without being sent.
+	 *
+	 * This is "list objects with prefix and delimiter" of S3.
+	 */
+	COF_DELIMITER = 1 << 14,
+	/**
+	 * Creates volatile catalogues (CAS-PUT on meta, see
+	 * m0_cas_index_create()).
+	 *
+	 * Volatile catalogue is kept in the memory of CAS service only.
+	 * Operations on it bypass BE transactions and DTM0, so they are not
+	 * persistent: the catalogue and all its records are lost on the
+	 * service restart. Volatile catalogues are not listed by CAS-CUR on
+	 * meta and are not repaired or re-balanced. Index drop detects
+	 * volatile catalogues without this flag.
+	 *
+	 * Intended for ephemeral indices (caches, temporary results), which
+	 * can be re-built by the user after a failure.
+	 */
+	COF_VOLATILE  = 1 << 15,
 };
 
+/** Flags of NEXT operation, which are evaluated with m0_cas_op::cg_filter. */
+#define COF_FILTER (COF_PREFIX | COF_END_KEY | COF_DELIMITER)
+
 enum m0_cas_opcode {
 	CO_GET,
 	CO_PUT,
@@ -366,6 +407,38 @@ enum m0_cas_type {
 	CT_MEM
 } M0_XCA_ENUM;
 
+/**
+ * Filter of CAS-CUR operation evaluated by the service inside the cursor loop.
+ *
+ * Only the fields enabled by ::COF_FILTER flags are used, only ordinary
+ * catalogues can be filtered and ::COF_SLANT is mandatory.
+ */
+struct m0_cas_filter {
+	/** Key prefix, see ::COF_PREFIX. */
+	struct m0_buf cf_prefix;
+	/** Exclusive upper bound of keys, see ::COF_END_KEY. */
+	struct m0_buf cf_end;
+	/** Delimiter of the roll-up, see ::COF_DELIMITER. */
+	struct m0_buf cf_delim;
+} M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
+
+/**
+ * Consecutive records of a multi-catalogue operation addressed to the same
+ * catalogue.
+ */
+struct m0_cas_ctg_range {
+	/** Catalogue the records are addressed to. */
+	struct m0_cas_id cgr_id;
+	/** Number of records in the range, should be non-zero. */
+	uint64_t         cgr_nr;
+} M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
+
+/** Catalogues of a multi-catalogue operation, see m0_cas_op::cg_ctgs. */
+struct m0_cas_ctg_ranges {
+	uint64_t                 cgs_nr;
+	struct m0_cas_ctg_range *cgs_ranges;
+} M0_XCA_SEQUENCE M0_XCA_DOMAIN(rpc);
+
 /**
  * CAS-GET, CAS-PUT, CAS-DEL and CAS-CUR fops.
  *
@@ -394,10 +467,27 @@ struct m0_cas_op {
 	 */
 	uint32_t               cg_flags;
 
+	/** Filter of CAS-CUR operation, see ::COF_FILTER. */
+	struct m0_cas_filter   cg_filter;
+
 	/**
 	 * Transaction descriptor associated with CAS operation.
 	 */
 	struct m0_dtm0_tx_desc cg_txd;
+
+	/**
+	 * Catalogues of a multi-catalogue CAS-PUT or CAS-DEL, empty for an
+	 * operation on the single catalogue ->cg_id.
+	 *
+	 * The input records are split into consecutive ranges, one per
+	 * catalogue, in the order of ->cgs_ranges[]. Catalogue fids should be
+	 * strictly ascending and ->cg_id should be equal to the first one.
+	 * All records are processed in a single BE transaction with all the
+	 * catalogues locked, so the operation is applied atomically.
+	 *
+	 * Only ordinary catalogues are supported.
+	 */
+	struct m0_cas_ctg_ranges cg_ctgs;
 } M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
 
 /**
@@ -187,7 +187,12 @@ static int creq_op_alloc(uint64_t           recs_nr,
 
 static void creq_op_free(struct m0_cas_op *op)
 {
+	uint64_t i;
+
 	if (op != NULL) {
+		for (i = 0; i < op->cg_ctgs.cgs_nr; i++)
+			m0_cas_id_fini(&op->cg_ctgs.cgs_ranges[i].cgr_id);
+		m0_free(op->cg_ctgs.cgs_ranges);
 		m0_dtm0_tx_desc_fini(&op->cg_txd);
 		m0_cas_id_fini(&op->cg_id);
 		m0_free(op->cg_rec.cr_rec);
@@ -1324,7 +1329,8 @@ M0_INTERNAL int m0_cas_req_wait(struct m0_cas_req *req, uint64_t states,
 M0_INTERNAL int m0_cas_index_create(struct m0_cas_req      *req,
 				    const struct m0_cas_id *cids,
 				    uint64_t                cids_nr,
-				    struct m0_dtx          *dtx)
+				    struct m0_dtx          *dtx,
+				    uint32_t                flags)
 {
 	struct m0_cas_op      *op;
 	enum m0_cas_req_state  next_state;
@@ -1334,8 +1340,10 @@ M0_INTERNAL int m0_cas_index_create(struct m0_cas_req      *req,
 	M0_PRE(req->ccr_sess != NULL);
 	M0_PRE(m0_cas_req_is_locked(req));
 	M0_PRE(m0_forall(i, cids_nr, m0_cas_id_invariant(&cids[i])));
+	M0_PRE((flags & ~COF_VOLATILE) == 0);
 	(void)dtx;
-	rc = cas_index_req_prepare(req, cids, cids_nr, cids_nr, false, 0, &op);
+	rc = cas_index_req_prepare(req, cids, cids_nr, cids_nr, false, flags,
+				   &op);
 	if (rc != 0)
 		return M0_ERR(rc);
 	rc = creq_fop_create_and_prepare(req, &cas_put_fopt, op, &next_state);
@@ -1786,6 +1794,17 @@ M0_INTERNAL int m0_cas_next(struct m0_cas_req *req,
 			    struct m0_bufvec  *start_keys,
 			    uint32_t          *recs_nr,
 			    uint32_t           flags)
+{
+	return m0_cas_next_filtered(req, index, start_keys, recs_nr, flags,
+				    NULL);
+}
+
+M0_INTERNAL int m0_cas_next_filtered(struct m0_cas_req          *req,
+				     struct m0_cas_id           *index,
+				     struct m0_bufvec           *start_keys,
+				     uint32_t                   *recs_nr,
+				     uint32_t                    flags,
+				     const struct m0_cas_filter *filter)
 {
 	struct m0_cas_op      *op;
 	enum m0_cas_req_state  next_state;
@@ -1797,12 +1816,18 @@ M0_INTERNAL int m0_cas_next(struct m0_cas_req *req,
 	M0_PRE(start_keys != NULL);
 	M0_PRE(m0_cas_req_is_locked(req));
 	M0_PRE(m0_cas_id_invariant(index));
-	/* Only slant, exclude start key, and versioned flags are allowed. */
+	/*
+	 * Only slant, exclude start key, versioned and filter flags are
+	 * allowed.
+	 */
 	M0_PRE((flags & ~(COF_SLANT | COF_EXCLUDE_START_KEY |
-			  COF_VERSIONED | COF_SHOW_DEAD)) == 0);
+			  COF_VERSIONED | COF_SHOW_DEAD | COF_FILTER)) == 0);
 	/* COF_SHOW_DEAD cannot be used without COF_VERSIONED */
 	M0_PRE(ergo((flags & COF_SHOW_DEAD) != 0,
 		    (flags & COF_VERSIONED) != 0));
+	/* Filter is evaluated from the slant position. */
+	M0_PRE(((flags & COF_FILTER) != 0) == (filter != NULL));
+	M0_PRE(ergo(filter != NULL, (flags & COF_SLANT) != 0));
 
 	for (i = 0; i < start_keys->ov_vec.v_nr; i++)
 		max_replies_nr += recs_nr[i];
@@ -1812,6 +1837,8 @@ M0_INTERNAL int m0_cas_next(struct m0_cas_req *req,
 		return M0_ERR(rc);
 	for (i = 0; i < start_keys->ov_vec.v_nr; i++)
 		op->cg_rec.cr_rec[i].cr_rc = recs_nr[i];
+	if (filter != NULL)
+		op->cg_filter = *filter;
 	req->ccr_keys = start_keys;
 	rc = creq_fop_create_and_prepare(req, &cas_cur_fopt, op,
 					 &next_state);
@@ -1879,6 +1906,114 @@ M0_INTERNAL int m0_cas_del(struct m0_cas_req *req,
 	return M0_RC(rc);
 }
 
+static int cas_ctgs_prepare(struct m0_cas_op       *op,
+			    const struct m0_cas_id *ids,
+			    const uint64_t         *recs_nr,
+			    uint32_t                ids_nr)
+{
+	struct m0_cas_ctg_range *r;
+	uint32_t                 i;
+	int                      rc = 0;
+
+	M0_ALLOC_ARR(op->cg_ctgs.cgs_ranges, ids_nr);
+	if (op->cg_ctgs.cgs_ranges == NULL)
+		return M0_ERR(-ENOMEM);
+	op->cg_ctgs.cgs_nr = ids_nr;
+	for (i = 0; i < ids_nr && rc == 0; i++) {
+		r = &op->cg_ctgs.cgs_ranges[i];
+		r->cgr_id = ids[i];
+		r->cgr_nr = recs_nr[i];
+		if (m0_fid_type_getfid(&ids[i].ci_fid) == &m0_cctg_fid_type) {
+			M0_ASSERT(ids[i].ci_layout.dl_type == DIX_LTYPE_DESCR);
+			rc = m0_dix_ldesc_copy(&r->cgr_id.ci_layout.u.dl_desc,
+					       &ids[i].ci_layout.u.dl_desc);
+		}
+	}
+	return M0_RC(rc);
+}
+
+static int cas_multi_op(struct m0_cas_req      *req,
+			struct m0_fop_type     *ftype,
+			struct m0_cas_id       *ids,
+			const uint64_t         *recs_nr,
+			uint32_t                ids_nr,
+			const struct m0_bufvec *keys,
+			const struct m0_bufvec *values,
+			struct m0_dtx          *dtx,
+			uint32_t                flags)
+{
+	struct m0_cas_op *op;
+	int               rc;
+
+	M0_ENTRY();
+	M0_PRE(ids_nr > 0);
+	M0_PRE(m0_forall(i, ids_nr, m0_cas_id_invariant(&ids[i]) &&
+			 recs_nr[i] > 0 &&
+			 ergo(i > 0, m0_fid_cmp(&ids[i - 1].ci_fid,
+						&ids[i].ci_fid) < 0)));
+	M0_PRE(m0_reduce(i, ids_nr, 0, + recs_nr[i]) == keys->ov_vec.v_nr);
+
+	rc = cas_req_prep(req, &ids[0], keys, values, keys->ov_vec.v_nr,
+			  flags, &op);
+	if (rc != 0)
+		return M0_ERR(rc);
+	rc = cas_ctgs_prepare(op, ids, recs_nr, ids_nr) ?:
+		m0_dtx0_txd_copy(dtx, &op->cg_txd);
+	if (rc != 0)
+		return M0_ERR(rc);
+	rc = creq_fop_create(req, ftype, op);
+	if (rc != 0)
+		return M0_ERR(rc);
+	/*
+	 * Records of all catalogues should be processed in the same
+	 * transaction, so the request can not be fragmented.
+	 */
+	if (m0_rpc_item_max_payload_exceeded(&req->ccr_fop->f_item,
+					     req->ccr_sess)) {
+		creq_fop_destroy(req);
+		return M0_ERR(-E2BIG);
+	}
+	cas_fop_send(req);
+	cas_req_state_set(req, CASREQ_SENT);
+	return M0_RC(0);
+}
+
+M0_INTERNAL int m0_cas_multi_put(struct m0_cas_req      *req,
+				 struct m0_cas_id       *ids,
+				 const uint64_t         *recs_nr,
+				 uint32_t                ids_nr,
+				 const struct m0_bufvec *keys,
+				 const struct m0_bufvec *values,
+				 struct m0_dtx          *dtx,
+				 uint32_t                flags)
+{
+	M0_PRE(keys != NULL);
+	M0_PRE(values != NULL);
+	M0_PRE(keys->ov_vec.v_nr == values->ov_vec.v_nr);
+	M0_PRE(m0_cas_req_is_locked(req));
+	M0_PRE(!(flags & COF_CREATE) || !(flags & COF_OVERWRITE));
+	M0_PRE((flags &
+		~(COF_CREATE | COF_OVERWRITE | COF_CROW | COF_SYNC_WAIT |
+		  COF_SKIP_LAYOUT | COF_VERSIONED | COF_NO_DTM)) == 0);
+	return cas_multi_op(req, &cas_put_fopt, ids, recs_nr, ids_nr,
+			    keys, values, dtx, flags);
+}
+
+M0_INTERNAL int m0_cas_multi_del(struct m0_cas_req *req,
+				 struct m0_cas_id  *ids,
+				 const uint64_t    *recs_nr,
+				 uint32_t           ids_nr,
+				 struct m0_bufvec  *keys,
+				 struct m0_dtx     *dtx,
+				 uint32_t           flags)
+{
+	M0_PRE(keys != NULL);
+	M0_PRE(m0_cas_req_is_locked(req));
+	M0_PRE((flags & ~(COF_DEL_LOCK | COF_SYNC_WAIT | COF_VERSIONED)) == 0);
+	return cas_multi_op(req, &cas_del_fopt, ids, recs_nr, ids_nr,
+			    keys, NULL, dtx, flags);
+}
+
 M0_INTERNAL void m0_cas_del_rep(struct m0_cas_req       *req,
 				uint64_t                 idx,
 				struct m0_cas_rec_reply *rep)
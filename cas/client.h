@@ -319,14 +319,18 @@ M0_INTERNAL int m0_cas_req_wait(struct m0_cas_req *req, uint64_t states,
  * Creates new indices.
  *
  * It is not needed to keep CAS ids array accessible until request is processed.
+ * Flag @ref m0_cas_op_flags::COF_VOLATILE can be set in flags to create
+ * catalogues that are kept in CAS service memory only.
  *
  * @pre m0_cas_req_is_locked(req)
+ * @pre (flags & ~COF_VOLATILE) == 0
  * @see m0_cas_index_create_rep()
  */
 M0_INTERNAL int m0_cas_index_create(struct m0_cas_req      *req,
 				    const struct m0_cas_id *cids,
 				    uint64_t                cids_nr,
-				    struct m0_dtx          *dtx);
+				    struct m0_dtx          *dtx,
+				    uint32_t                flags);
 
 /**
  * Gets execution result of m0_cas_index_create() request.
@@ -531,6 +535,24 @@ M0_INTERNAL int m0_cas_next(struct m0_cas_req *req,
 			    uint32_t          *recs_nr,
 			    uint32_t           flags);
 
+/**
+ * Same as m0_cas_next(), but records are filtered by the service according to
+ * @filter before they are sent, see ::COF_FILTER.
+ *
+ * @filter buffers should be accessible until the request is processed.
+ *
+ * @pre (flags & COF_FILTER) != 0
+ * @pre (flags & COF_SLANT) != 0
+ * @pre m0_cas_req_is_locked(req)
+ * @see m0_cas_next_rep()
+ */
+M0_INTERNAL int m0_cas_next_filtered(struct m0_cas_req          *req,
+				     struct m0_cas_id           *index,
+				     struct m0_bufvec           *start_keys,
+				     uint32_t                   *recs_nr,
+				     uint32_t                    flags,
+				     const struct m0_cas_filter *filter);
+
 /**
  * Gets execution result of m0_cas_next() request.
  *
@@ -576,6 +598,49 @@ M0_INTERNAL void m0_cas_del_rep(struct m0_cas_req       *req,
 				uint64_t                 idx,
 				struct m0_cas_rec_reply *rep);
 
+/**
+ * Inserts records to several indices atomically.
+ *
+ * Records are split into consecutive ranges: the first recs_nr[0] keys and
+ * values go to ids[0], the next recs_nr[1] ones go to ids[1] and so on. All
+ * records are sent in a single fop and are inserted in a single transaction
+ * on the service, see m0_cas_op::cg_ctgs.
+ *
+ * The request is not fragmented: -E2BIG is returned if the records do not
+ * fit into a single fop.
+ *
+ * @pre ids_nr > 0
+ * @pre index fids are strictly ascending
+ * @pre m0_cas_req_is_locked(req)
+ * @see m0_cas_put(), m0_cas_put_rep()
+ */
+M0_INTERNAL int m0_cas_multi_put(struct m0_cas_req      *req,
+				 struct m0_cas_id       *ids,
+				 const uint64_t         *recs_nr,
+				 uint32_t                ids_nr,
+				 const struct m0_bufvec *keys,
+				 const struct m0_bufvec *values,
+				 struct m0_dtx          *dtx,
+				 uint32_t                flags);
+
+/**
+ * Deletes records from several indices atomically.
+ *
+ * Keys are split between indices as in m0_cas_multi_put().
+ *
+ * @pre ids_nr > 0
+ * @pre index fids are strictly ascending
+ * @pre m0_cas_req_is_locked(req)
+ * @see m0_cas_del(), m0_cas_del_rep()
+ */
+M0_INTERNAL int m0_cas_multi_del(struct m0_cas_req *req,
+				 struct m0_cas_id  *ids,
+				 const uint64_t    *recs_nr,
+				 uint32_t           ids_nr,
+				 struct m0_bufvec  *keys,
+				 struct m0_dtx     *dtx,
+				 uint32_t           flags);
+
 M0_INTERNAL int  m0_cas_sm_conf_init(void);
 M0_INTERNAL void m0_cas_sm_conf_fini(void);
 
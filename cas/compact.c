@@ -0,0 +1,671 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2015-2021 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_CAS
+
+#include "lib/trace.h"
+#include "lib/memory.h"
+#include "lib/assert.h"
+#include "lib/arith.h"         /* max64u */
+#include "lib/cond.h"          /* m0_cond */
+#include "lib/time.h"          /* m0_time_now */
+#include "fop/fop.h"           /* M0_FOP_TYPE_INIT */
+#include "fop/fom_long_lock.h"
+#include "fop/fom_generic.h"
+#include "rpc/rpc_opcodes.h"
+#include "rpc/item.h"          /* M0_RPC_ITEM_TYPE_REQUEST */
+#include "dtm0/service.h"      /* m0_dtm0_service_find */
+#include "dtm0/pruner.h"       /* m0_dtm0_pruner_horizon */
+#include "cas/ctg_store.h"
+#include "cas/compact.h"
+#include "motr/setup.h"
+
+/**
+ * @page cas-compact Versioned catalogues compaction
+ *
+ * DEL of a versioned record (COF_VERSIONED) leaves a tombstone in the
+ * catalogue, so that PUTs and DELs delivered out of order are applied by
+ * version. Once every participant has seen the operation, the tombstone is not
+ * needed, but it still takes space and is skipped by every NEXT.
+ *
+ * Compaction fom walks all ordinary catalogues from meta catalogue and removes
+ * tombstones older than the DTM0 pruner horizon. A catalogue is scanned in
+ * chunks of CPC_SCAN_MAX records without long locks. Found tombstones are
+ * removed in a transaction of their own, under meta read lock and catalogue
+ * write lock, if the record still has the same version. The fom is restarted
+ * after each transaction, like the index garbage collector, and waits for
+ * CPC_DELAY before each chunk, so that it stays in the background. After a
+ * pass over all catalogues the fom sleeps for CPC_PERIOD_SEC.
+ *
+ * @subsection cpc-lspec-state State Specification
+ *
+ * @verbatim
+ *
+ *                      FOPH_INIT
+ *                          |
+ *                          V
+ *                   [generic phases]
+ *                          .
+ *                          .
+ *                          V
+ *                M0_FOPH_AUTHORISATION
+ *                          |
+ *                          V
+ * SUCCESS<-------------CPC_SCAN<--+ next chunk
+ *                          |      |
+ *                          +------+
+ *                          V
+ *                      TXN_INIT
+ *                          |
+ *                          V
+ *                     CPC_CREDITS
+ *                          |
+ *                          V
+ *                      TXN_OPEN
+ *                          |
+ *                          V
+ *                    CPC_META_LOCK
+ *                          |
+ *                          V
+ *                    CPC_CTG_LOCK
+ *                          |
+ *                          V
+ *                     CPC_DELETE
+ *                          |
+ *                          V
+ *                       SUCCESS
+ * @endverbatim
+ */
+
+static size_t cpc_fom_home_locality (const struct m0_fom *fom);
+static int    cpc_fom_tick          (struct m0_fom *fom);
+static void   cpc_fom_fini          (struct m0_fom *fom);
+
+enum {
+	/** Maximum number of tombstones removed in a transaction. */
+	CPC_BATCH      = 128,
+	/** Maximum number of records examined in a tick. */
+	CPC_SCAN_MAX   = 4096,
+	/** Delay before each chunk of a pass. */
+	CPC_DELAY      = 10 * M0_TIME_ONE_MSEC,
+	/** Delay between passes. */
+	CPC_PERIOD_SEC = 600
+};
+
+enum cpc_fom_phase {
+	CPC_META_LOCK = M0_FOPH_TYPE_SPECIFIC,
+	CPC_SCAN,
+	CPC_CREDITS,
+	CPC_CTG_LOCK,
+	CPC_DELETE,
+	CPC_NR
+};
+
+struct cpc_fom {
+	struct m0_fom              cp_fom;
+	struct m0_fop              cp_fop;
+	struct m0_reqh            *cp_reqh;
+	struct m0_long_lock_link   cp_meta;
+	struct m0_long_lock_addb2  cp_meta_addb2;
+	struct m0_long_lock_link   cp_lock;
+	struct m0_long_lock_addb2  cp_lock_addb2;
+	/** Catalogue being compacted. */
+	struct m0_fid              cp_fid;
+	/** cp_fid is scanned up to the end, move to the next catalogue. */
+	bool                       cp_fid_done;
+	/** The next key to scan in cp_fid. */
+	struct m0_buf              cp_key;
+	/** Catalogue locked in CPC_CTG_LOCK. */
+	struct m0_cas_ctg         *cp_ctg;
+	struct m0_ctg_tbs          cp_tbs[CPC_BATCH];
+	uint32_t                   cp_tbs_nr;
+	/** Time to wait before the next CPC_SCAN tick. */
+	m0_time_t                  cp_delay;
+	/** True while cp_timeout is armed. */
+	bool                       cp_wait;
+	struct m0_fom_timeout      cp_timeout;
+	/** Start a new fom to continue the pass after this one. */
+	bool                       cp_restart;
+};
+
+struct cpc_context {
+	struct m0_mutex             cc_mutex;
+	struct m0_cond              cc_cond;
+	struct cpc_fom             *cc_fom;
+	bool                        cc_running;
+	bool                        cc_stopping;
+	/** The fom is in a pass, not sleeping between passes. */
+	bool                        cc_in_pass;
+	/** Number of passes to be completed before the fom sleeps. */
+	uint64_t                    cc_pass_req;
+	/** Wakes the fom sleeping in CPC_SCAN. */
+	struct m0_sm_ast            cc_ast;
+	bool                        cc_ast_posted;
+	bool                        cc_ut_horizon_set;
+	struct m0_dtm0_ts           cc_ut_horizon;
+	struct m0_cas_compact_stats cc_stats;
+};
+
+static struct cpc_context cpc;
+
+static const struct m0_fom_ops cpc_fom_ops = {
+	.fo_fini          = &cpc_fom_fini,
+	.fo_tick          = &cpc_fom_tick,
+	.fo_home_locality = &cpc_fom_home_locality
+};
+
+M0_INTERNAL struct m0_fop_type cpc_fake_fopt;
+
+static const struct m0_fom_type_ops cpc_fom_type_ops = {
+	.fto_create = NULL
+};
+
+static struct m0_sm_state_descr cpc_fom_phases[] = {
+	[CPC_SCAN] = {
+		.sd_name      = "cpc-scan",
+		.sd_allowed   = M0_BITS(M0_FOPH_TXN_INIT, M0_FOPH_SUCCESS)
+	},
+	[CPC_CREDITS] = {
+		.sd_name      = "cpc-credits-get",
+		.sd_allowed   = M0_BITS(M0_FOPH_TXN_OPEN)
+	},
+	[CPC_META_LOCK] = {
+		.sd_name      = "cpc-meta-lock",
+		.sd_allowed   = M0_BITS(CPC_CTG_LOCK)
+	},
+	[CPC_CTG_LOCK] = {
+		.sd_name      = "cpc-ctg-lock",
+		.sd_allowed   = M0_BITS(CPC_DELETE)
+	},
+	[CPC_DELETE] = {
+		.sd_name      = "cpc-delete",
+		.sd_allowed   = M0_BITS(M0_FOPH_SUCCESS)
+	},
+};
+
+struct m0_sm_trans_descr cpc_fom_trans[] = {
+	[ARRAY_SIZE(m0_generic_phases_trans)] =
+	{ "cpc-starting",     M0_FOPH_TXN_INIT,  CPC_SCAN },
+	{ "cpc-batch-found",  CPC_SCAN,          M0_FOPH_TXN_INIT },
+	{ "cpc-no-job",       CPC_SCAN,          M0_FOPH_SUCCESS },
+	{ "cpc-starting",     M0_FOPH_TXN_OPEN,  CPC_CREDITS },
+	{ "cpc-credits",      CPC_CREDITS,       M0_FOPH_TXN_OPEN },
+	{ "cpc-meta-locked",  CPC_META_LOCK,     CPC_CTG_LOCK },
+	{ "cpc-ctg-locked",   CPC_CTG_LOCK,      CPC_DELETE },
+	{ "cpc-done",         CPC_DELETE,        M0_FOPH_SUCCESS }
+};
+
+static struct m0_sm_conf cpc_sm_conf = {
+	.scf_name      = "cas-compact-fom",
+	.scf_nr_states = ARRAY_SIZE(cpc_fom_phases),
+	.scf_state     = cpc_fom_phases,
+	.scf_trans_nr  = ARRAY_SIZE(cpc_fom_trans),
+	.scf_trans     = cpc_fom_trans
+};
+
+static size_t cpc_fom_home_locality(const struct m0_fom *fom)
+{
+	return 0;
+}
+
+static void cpc_tbs_free(struct cpc_fom *fom)
+{
+	uint32_t i;
+
+	for (i = 0; i < fom->cp_tbs_nr; ++i)
+		m0_buf_free(&fom->cp_tbs[i].ct_key);
+	fom->cp_tbs_nr = 0;
+}
+
+static void cpc_unlock(struct cpc_fom *fom)
+{
+	if (fom->cp_ctg != NULL) {
+		m0_long_unlock(m0_ctg_lock(fom->cp_ctg), &fom->cp_lock);
+		fom->cp_ctg = NULL;
+	}
+	m0_long_unlock(m0_ctg_lock(m0_ctg_meta()), &fom->cp_meta);
+}
+
+static int cpc_horizon(struct cpc_fom *fom, struct m0_dtm0_ts *horizon)
+{
+	struct m0_dtm0_service *dtms;
+
+	if (cpc.cc_ut_horizon_set) {
+		*horizon = cpc.cc_ut_horizon;
+		return 0;
+	}
+	dtms = m0_dtm0_service_find(fom->cp_reqh);
+	if (dtms == NULL || dtms->dos_log == NULL ||
+	    dtms->dos_origin != DTM0_ON_PERSISTENT)
+		return -ENOENT;
+	m0_dtm0_pruner_horizon(dtms->dos_log, horizon);
+	return 0;
+}
+
+/**
+ * Completes a pass over all catalogues. Returns true if the fom should stay
+ * alive for the next pass.
+ */
+static bool cpc_pass_end(struct cpc_fom *fom, bool can_continue)
+{
+	bool more;
+
+	fom->cp_fid = M0_FID0;
+	fom->cp_fid_done = false;
+	m0_buf_free(&fom->cp_key);
+
+	m0_mutex_lock(&cpc.cc_mutex);
+	cpc.cc_stats.cs_passes++;
+	more = cpc.cc_stats.cs_passes < cpc.cc_pass_req;
+	cpc.cc_in_pass = more && can_continue;
+	m0_cond_broadcast(&cpc.cc_cond);
+	m0_mutex_unlock(&cpc.cc_mutex);
+
+	fom->cp_delay = more ? CPC_DELAY : M0_MKTIME(CPC_PERIOD_SEC, 0);
+	return can_continue;
+}
+
+/** Finds the next batch of tombstones, returns false at the end of pass. */
+static bool cpc_scan(struct cpc_fom *fom, const struct m0_dtm0_ts *horizon)
+{
+	struct m0_cas_ctg *ctg;
+	struct m0_fid      fid;
+	uint32_t           nr = CPC_BATCH;
+	bool               eot;
+	int                rc;
+
+	rc = m0_ctg_meta_next_ctg(&fom->cp_fid, fom->cp_fid_done, &fid, &ctg);
+	if (rc != 0) {
+		if (rc != -ENOENT)
+			M0_LOG(M0_WARN, "meta lookup error %d", rc);
+		return false;
+	}
+	if (fom->cp_fid_done || !m0_fid_eq(&fid, &fom->cp_fid)) {
+		fom->cp_fid = fid;
+		fom->cp_fid_done = false;
+		m0_buf_free(&fom->cp_key);
+	}
+	rc = m0_ctg_tbs_scan(ctg, &fom->cp_key, horizon, fom->cp_tbs, &nr,
+			     CPC_SCAN_MAX, &eot);
+	fom->cp_tbs_nr = nr;
+	if (rc != 0) {
+		M0_LOG(M0_WARN, "scan of "FID_F" failed: %d",
+		       FID_P(&fom->cp_fid), rc);
+		cpc_tbs_free(fom);
+		m0_buf_free(&fom->cp_key);
+		eot = true;
+	}
+	fom->cp_fid_done = eot;
+	return true;
+}
+
+static int cpc_fom_tick(struct m0_fom *fom0)
+{
+	struct cpc_fom         *fom    = M0_AMB(fom, fom0, cp_fom);
+	int                     phase  = m0_fom_phase(fom0);
+	int                     result = M0_FSO_AGAIN;
+	struct m0_be_tx_credit *cred   = &fom0->fo_tx.tx_betx_cred;
+	struct m0_cas_ctg      *ctg;
+	struct m0_dtm0_ts       horizon;
+	uint64_t                removed = 0;
+	uint32_t                i;
+	bool                    stopping;
+	int                     rc;
+
+	M0_ENTRY("fom %p phase %d", fom, phase);
+
+	switch (phase) {
+	case M0_FOPH_INIT ... M0_FOPH_NR - 1:
+		if (phase == M0_FOPH_FAILURE) {
+			cpc_unlock(fom);
+			cpc_tbs_free(fom);
+		}
+		result = m0_fom_tick_generic(fom0);
+		/*
+		 * Intercept generic fom control flow the same way as index
+		 * garbage collector does, see cgc_fom_tick().
+		 */
+		if (phase == M0_FOPH_AUTHORISATION)
+			m0_fom_phase_set(fom0, CPC_SCAN);
+		if (phase == M0_FOPH_TXN_INIT)
+			m0_fom_phase_set(fom0, CPC_CREDITS);
+		if (phase == M0_FOPH_TXN_COMMIT)
+			m0_fom_phase_set(fom0, M0_FOPH_TXN_LOGGED_WAIT);
+		break;
+	case CPC_SCAN:
+		if (fom->cp_wait) {
+			m0_fom_timeout_fini(&fom->cp_timeout);
+			fom->cp_wait = false;
+		}
+		m0_mutex_lock(&cpc.cc_mutex);
+		stopping = cpc.cc_stopping;
+		if (!stopping && fom->cp_delay == 0)
+			cpc.cc_in_pass = true;
+		m0_mutex_unlock(&cpc.cc_mutex);
+		if (stopping) {
+			m0_fom_phase_set(fom0, M0_FOPH_SUCCESS);
+			break;
+		}
+		if (fom->cp_delay != 0) {
+			/* Let user requests use the locality and BE. */
+			m0_fom_timeout_init(&fom->cp_timeout);
+			m0_fom_timeout_wait_on(&fom->cp_timeout, fom0,
+					       m0_time_add(m0_time_now(),
+							   fom->cp_delay));
+			fom->cp_delay = 0;
+			fom->cp_wait = true;
+			result = M0_FSO_WAIT;
+			break;
+		}
+		rc = cpc_horizon(fom, &horizon);
+		if (rc != 0 || !cpc_scan(fom, &horizon)) {
+			M0_LOG(M0_DEBUG, "pass done, rc=%d", rc);
+			if (!cpc_pass_end(fom, rc == 0))
+				m0_fom_phase_set(fom0, M0_FOPH_SUCCESS);
+		} else if (fom->cp_tbs_nr == 0)
+			fom->cp_delay = CPC_DELAY;
+		else
+			m0_fom_phase_set(fom0, M0_FOPH_TXN_INIT);
+		break;
+	case CPC_CREDITS:
+		rc = m0_ctg_meta_find_ctg(m0_ctg_meta(), &fom->cp_fid, &ctg);
+		if (rc == 0) {
+			for (i = 0; i < fom->cp_tbs_nr; ++i)
+				m0_ctg_tbs_del_credit(ctg, &fom->cp_tbs[i],
+						      cred);
+		}
+		m0_fom_phase_set(fom0, M0_FOPH_TXN_OPEN);
+		break;
+	case CPC_META_LOCK:
+		fom->cp_ctg = NULL;
+		result = m0_long_read_lock(m0_ctg_lock(m0_ctg_meta()),
+					   &fom->cp_meta, CPC_CTG_LOCK);
+		result = M0_FOM_LONG_LOCK_RETURN(result);
+		break;
+	case CPC_CTG_LOCK:
+		/*
+		 * The catalogue could be dropped after the scan. Meta read lock
+		 * keeps it alive from now on.
+		 */
+		rc = m0_ctg_meta_find_ctg(m0_ctg_meta(), &fom->cp_fid, &ctg);
+		if (rc != 0) {
+			m0_fom_phase_set(fom0, CPC_DELETE);
+			break;
+		}
+		fom->cp_ctg = ctg;
+		result = m0_long_write_lock(m0_ctg_lock(ctg), &fom->cp_lock,
+					    CPC_DELETE);
+		result = M0_FOM_LONG_LOCK_RETURN(result);
+		break;
+	case CPC_DELETE:
+		for (i = 0; fom->cp_ctg != NULL && i < fom->cp_tbs_nr; ++i) {
+			rc = m0_ctg_tbs_del(fom->cp_ctg, m0_fom_tx(fom0),
+					    &fom->cp_tbs[i]);
+			if (rc == 0)
+				removed++;
+			else if (!M0_IN(rc, (-EEXIST, -ENOENT)))
+				M0_LOG(M0_WARN, "tombstone removal error %d",
+				       rc);
+		}
+		cpc_unlock(fom);
+		m0_mutex_lock(&cpc.cc_mutex);
+		cpc.cc_stats.cs_txs++;
+		cpc.cc_stats.cs_removed += removed;
+		cpc.cc_stats.cs_skipped += fom->cp_tbs_nr - removed;
+		m0_mutex_unlock(&cpc.cc_mutex);
+		M0_LOG(M0_DEBUG, "removed %"PRIu64" of %u tombstones",
+		       removed, fom->cp_tbs_nr);
+		cpc_tbs_free(fom);
+		/* Commit the transaction and continue in a new fom. */
+		fom->cp_restart = true;
+		fom->cp_delay = CPC_DELAY;
+		m0_fom_phase_set(fom0, M0_FOPH_SUCCESS);
+		break;
+	}
+	return M0_RC(result);
+}
+
+static void cpc_wakeup_ast(struct m0_sm_group *grp, struct m0_sm_ast *ast)
+{
+	struct cpc_fom *fom;
+
+	m0_mutex_lock(&cpc.cc_mutex);
+	cpc.cc_ast_posted = false;
+	fom = cpc.cc_fom;
+	/*
+	 * The timer is armed only while the fom waits in CPC_SCAN, and it is
+	 * fired in this group, so the fom can't be woken up twice.
+	 */
+	if (fom != NULL && fom->cp_wait &&
+	    m0_sm_timer_is_armed(&fom->cp_timeout.to_timer)) {
+		m0_fom_timeout_cancel(&fom->cp_timeout);
+		m0_fom_wakeup(&fom->cp_fom);
+	}
+	m0_mutex_unlock(&cpc.cc_mutex);
+}
+
+static void cpc_wakeup_post(void)
+{
+	M0_PRE(m0_mutex_is_locked(&cpc.cc_mutex));
+
+	if (cpc.cc_fom != NULL && !cpc.cc_ast_posted) {
+		cpc.cc_ast_posted = true;
+		cpc.cc_ast.sa_cb = &cpc_wakeup_ast;
+		m0_sm_ast_post(&cpc.cc_fom->cp_fom.fo_loc->fl_group,
+			       &cpc.cc_ast);
+	}
+}
+
+M0_INTERNAL void m0_cas_compact_init(void)
+{
+	M0_ENTRY();
+	m0_sm_conf_extend(m0_generic_conf.scf_state, cpc_fom_phases,
+			  m0_generic_conf.scf_nr_states);
+	m0_sm_conf_trans_extend(&m0_generic_conf, &cpc_sm_conf);
+	cpc_fom_phases[M0_FOPH_TXN_INIT].sd_allowed |= M0_BITS(CPC_SCAN);
+	cpc_fom_phases[M0_FOPH_TXN_OPEN].sd_allowed |= M0_BITS(CPC_CREDITS);
+	m0_sm_conf_init(&cpc_sm_conf);
+	m0_mutex_init(&cpc.cc_mutex);
+	m0_cond_init(&cpc.cc_cond, &cpc.cc_mutex);
+	cpc.cc_running = false;
+	cpc.cc_stopping = false;
+	cpc.cc_ut_horizon_set = false;
+	M0_SET0(&cpc.cc_stats);
+	/* Fake fop for generic fom transactions, see m0_cas_gc_init(). */
+	M0_FOP_TYPE_INIT(&cpc_fake_fopt,
+			 .name      = "cas-compact-fake",
+			 .opcode    = M0_CAS_CPF_FOP_OPCODE,
+			 .rpc_flags = M0_RPC_ITEM_TYPE_REQUEST |
+				      M0_RPC_ITEM_TYPE_MUTABO,
+			 .fom_ops   = &cpc_fom_type_ops,
+			 .sm        = &cpc_sm_conf,
+			 .svc_type  = &m0_cas_service_type);
+	M0_LEAVE();
+}
+
+M0_INTERNAL void m0_cas_compact_fini(void)
+{
+	M0_ENTRY();
+	M0_PRE(!cpc.cc_running);
+	m0_fop_type_fini(&cpc_fake_fopt);
+	m0_cond_fini(&cpc.cc_cond);
+	m0_mutex_fini(&cpc.cc_mutex);
+	m0_sm_conf_fini(&cpc_sm_conf);
+	M0_LEAVE();
+}
+
+static void cpc_fop_release(struct m0_ref *ref)
+{
+	struct m0_fop *fop = container_of(ref, struct m0_fop, f_ref);
+
+	/* Fop is a part of cpc_fom, it shouldn't be freed. */
+	m0_fop_fini(fop);
+}
+
+static void cpc_start_fom(struct cpc_fom *fom)
+{
+	struct m0_fom *fom0 = &fom->cp_fom;
+	struct m0_fop *fop  = &fom->cp_fop;
+
+	m0_fop_init(fop, &cpc_fake_fopt, NULL, &cpc_fop_release);
+	m0_fom_init(fom0, &fop->f_type->ft_fom_type,
+		    &cpc_fom_ops, fop, NULL, fom->cp_reqh);
+	fom0->fo_local = true;
+	m0_long_lock_link_init(&fom->cp_meta, fom0, &fom->cp_meta_addb2);
+	m0_long_lock_link_init(&fom->cp_lock, fom0, &fom->cp_lock_addb2);
+	m0_fom_queue(fom0);
+}
+
+/**
+ * Finalises current compaction fom and, maybe, continues in a new one.
+ */
+static void cpc_fom_fini(struct m0_fom *fom0)
+{
+	struct cpc_fom *fom = M0_AMB(fom, fom0, cp_fom);
+
+	M0_ENTRY();
+	M0_ASSERT(fom0->fo_fop == &fom->cp_fop);
+	m0_mutex_lock(&cpc.cc_mutex);
+	/* See cgc_fom_fini() about references of the fake fop. */
+	m0_ref_put(&fom0->fo_fop->f_ref);
+	m0_ref_put(&fom0->fo_fop->f_ref);
+	fom0->fo_fop = NULL;
+	m0_fom_fini(fom0);
+	m0_long_lock_link_fini(&fom->cp_lock);
+	m0_long_lock_link_fini(&fom->cp_meta);
+	if (fom->cp_restart && !cpc.cc_stopping) {
+		fom->cp_restart = false;
+		M0_SET0(fom0);
+		M0_SET0(&fom->cp_fop);
+		cpc_start_fom(fom);
+	} else {
+		cpc_tbs_free(fom);
+		m0_buf_free(&fom->cp_key);
+		m0_free(fom);
+		cpc.cc_fom = NULL;
+		cpc.cc_running = false;
+		cpc.cc_in_pass = false;
+		m0_ctg_store_fini();
+		m0_cond_broadcast(&cpc.cc_cond);
+	}
+	m0_mutex_unlock(&cpc.cc_mutex);
+	M0_LEAVE();
+}
+
+M0_INTERNAL void m0_cas_compact_start(struct m0_reqh_service *service)
+{
+	struct cpc_fom         *fom;
+	struct m0_reqh         *reqh = service->rs_reqh;
+	struct m0_reqh_context *rctx;
+	struct m0_be_domain    *dom;
+	int                     rc;
+
+	M0_ENTRY();
+	/* Check if UT domain is preset */
+	dom = m0_cas__ut_svc_be_get(service);
+	if (dom == NULL) {
+		rctx = m0_cs_reqh_context(reqh);
+		dom = rctx->rc_beseg->bs_domain;
+	}
+
+	m0_mutex_lock(&cpc.cc_mutex);
+	if (cpc.cc_stopping) {
+		/* Service is stopping: nothing to do. */
+	} else if (!cpc.cc_running) {
+		M0_ALLOC_PTR(fom);
+		rc = fom == NULL ? -ENOMEM : m0_ctg_store_init(dom);
+		if (rc != 0) {
+			M0_LOG(M0_WARN, "compaction start error rc=%d", rc);
+			m0_free(fom);
+		} else {
+			fom->cp_reqh = reqh;
+			cpc.cc_fom = fom;
+			cpc.cc_running = true;
+			cpc.cc_in_pass = true;
+			cpc.cc_pass_req = cpc.cc_stats.cs_passes + 1;
+			cpc_start_fom(fom);
+		}
+	} else if (cpc.cc_in_pass) {
+		cpc.cc_pass_req = max64u(cpc.cc_pass_req,
+					 cpc.cc_stats.cs_passes + 2);
+	} else {
+		cpc.cc_pass_req = max64u(cpc.cc_pass_req,
+					 cpc.cc_stats.cs_passes + 1);
+		cpc_wakeup_post();
+	}
+	m0_mutex_unlock(&cpc.cc_mutex);
+	M0_LEAVE();
+}
+
+M0_INTERNAL void m0_cas_compact_stop(void)
+{
+	M0_ENTRY();
+	m0_mutex_lock(&cpc.cc_mutex);
+	cpc.cc_stopping = true;
+	cpc_wakeup_post();
+	while (cpc.cc_running)
+		m0_cond_wait(&cpc.cc_cond);
+	cpc.cc_stopping = false;
+	m0_mutex_unlock(&cpc.cc_mutex);
+	M0_LEAVE();
+}
+
+M0_INTERNAL void m0_cas_compact_wait_sync(void)
+{
+	M0_ENTRY();
+	m0_mutex_lock(&cpc.cc_mutex);
+	while (cpc.cc_running && cpc.cc_stats.cs_passes < cpc.cc_pass_req)
+		m0_cond_wait(&cpc.cc_cond);
+	m0_mutex_unlock(&cpc.cc_mutex);
+	M0_LEAVE();
+}
+
+M0_INTERNAL void m0_cas_compact_stats_get(struct m0_cas_compact_stats *stats)
+{
+	m0_mutex_lock(&cpc.cc_mutex);
+	*stats = cpc.cc_stats;
+	m0_mutex_unlock(&cpc.cc_mutex);
+}
+
+M0_INTERNAL void m0_cas_compact__ut_horizon_set(const struct m0_dtm0_ts *ts)
+{
+	m0_mutex_lock(&cpc.cc_mutex);
+	cpc.cc_ut_horizon_set = ts != NULL;
+	if (ts != NULL)
+		cpc.cc_ut_horizon = *ts;
+	m0_mutex_unlock(&cpc.cc_mutex);
+}
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
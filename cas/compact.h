@@ -0,0 +1,97 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2015-2021 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __MOTR_CAS_COMPACT_H__
+#define __MOTR_CAS_COMPACT_H__
+
+#include "lib/types.h"
+
+/* Import */
+struct m0_reqh_service;
+struct m0_dtm0_ts;
+
+/**
+ * Progress of versioned catalogues compaction since m0_cas_compact_init().
+ *
+ * @see m0_cas_compact_stats_get()
+ */
+struct m0_cas_compact_stats {
+	/** Number of completed passes over all catalogues. */
+	uint64_t cs_passes;
+	/** Number of BE transactions used to remove tombstones. */
+	uint64_t cs_txs;
+	/** Number of removed tombstones. */
+	uint64_t cs_removed;
+	/** Number of tombstones overwritten before they could be removed. */
+	uint64_t cs_skipped;
+};
+
+/** Initialises versioned catalogues compaction. */
+M0_INTERNAL void m0_cas_compact_init(void);
+
+/** Finalises versioned catalogues compaction. */
+M0_INTERNAL void m0_cas_compact_fini(void);
+
+/**
+ * Starts compaction of versioned catalogues of the CAS service.
+ *
+ * Compaction removes tombstones older than the DTM0 pruner horizon (see
+ * m0_dtm0_pruner_horizon()) from all catalogues, a batch per transaction,
+ * and repeats this periodically until m0_cas_compact_stop(). Does nothing if
+ * DTM0 service is not running.
+ *
+ * Can be called when compaction is already running. In this case one more
+ * pass is done right after the current one.
+ */
+M0_INTERNAL void m0_cas_compact_start(struct m0_reqh_service *service);
+
+/** Stops compaction and waits until it is stopped. */
+M0_INTERNAL void m0_cas_compact_stop(void);
+
+/** Waits until the current pass of compaction completes. */
+M0_INTERNAL void m0_cas_compact_wait_sync(void);
+
+/** Returns the progress of compaction. */
+M0_INTERNAL void m0_cas_compact_stats_get(struct m0_cas_compact_stats *stats);
+
+/**
+ * Makes compaction use the given horizon instead of the DTM0 pruner one.
+ * NULL restores the default behaviour. For UTs.
+ */
+M0_INTERNAL void m0_cas_compact__ut_horizon_set(const struct m0_dtm0_ts *ts);
+
+#endif /* __MOTR_CAS_COMPACT_H__ */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -28,14 +28,20 @@
 #include "lib/assert.h"
 #include "lib/errno.h"               /* ENOMEM, EPROTO */
 #include "lib/ext.h"                 /* m0_ext */
+#include "lib/atomic.h"              /* m0_atomic64 */
+#include "lib/hash.h"                /* m0_hash */
+#include "lib/hash_fnc.h"            /* m0_hash_fnc_city */
 #include "be/domain.h"               /* m0_be_domain_seg_first */
 #include "be/op.h"
 #include "module/instance.h"
+#include "lib/locality.h"            /* m0_fom_dom */
+#include "fop/fom.h"                 /* m0_fom_domain */
 #include "fop/fom_long_lock.h"       /* m0_long_lock */
 #include "cas/ctg_store.h"
 #include "cas/index_gc.h"
 #include "dix/fid_convert.h"        /* m0_dix_fid_convert_cctg2dix */
 #include "motr/setup.h"
+#include "motr/magic.h"
 
 
 struct m0_ctg_store {
@@ -76,6 +82,12 @@ struct m0_ctg_store {
 	 * Flag indicating whether catalogue store is initialised or not.
 	 */
 	bool                 cs_initialised;
+
+	/** Volatile catalogues, see m0_ctg_vol_insert(). */
+	struct m0_htable     cs_vol;
+
+	/** Mutex to protect cs_vol. */
+	struct m0_mutex      cs_vol_guard;
 };
 
 /* Data schema for CAS catalogues { */
@@ -114,12 +126,57 @@ struct meta_value {
 M0_BASSERT(sizeof(struct generic_value) + sizeof(struct m0_cas_ctg *) ==
 	   sizeof(struct meta_value));
 
+/** Index layout descriptor as stored in ctidx, see ::ctidx_layout. */
+struct ctidx_ldesc {
+	uint32_t            cl_hash_fnc;
+	struct m0_fid       cl_pver;
+	struct m0_dix_imask cl_imask;
+};
+
+/**
+ * Layout parts that do not fit into ::ctidx_ldesc: the partition table of a
+ * HASH_FNC_RANGE layout and the number of data fragments of an erasure-coded
+ * layout. They are kept in a separate ctidx record, see ctidx_ext_fid().
+ */
+struct ctidx_ext {
+	uint32_t             ce_ec_data;
+	struct m0_dix_ranges ce_ranges;
+};
+
+/**
+ * Component catalogue layout as stored in ctidx.
+ *
+ * The ctidx btree has fixed-size values. This structure keeps the size and
+ * the field offsets m0_dix_layout had when existing ctidx trees were created,
+ * so their records stay readable. The in-memory m0_dix_layout is converted
+ * with ctidx_layout_pack() and ctidx_layout_unpack().
+ */
+struct ctidx_layout {
+	uint32_t cl_type;
+	union {
+		uint64_t                      cl_id;
+		struct ctidx_ldesc            cl_desc;
+		struct m0_dix_capture_ldesc   cl_cap_desc;
+		struct m0_dix_composite_ldesc cl_comp_desc;
+		/** Value of an extension record, cl_type == CTIDX_LTYPE_EXT. */
+		struct ctidx_ext              cl_ext;
+	} u;
+};
+M0_BASSERT(sizeof(struct ctidx_layout) == 48);
+
+enum {
+	/** Layout type of ctidx extension records. */
+	CTIDX_LTYPE_EXT    = 0x100,
+	/** Fid type of ctidx extension record keys, differs from 'T'. */
+	CTIDX_EXT_FID_TYPE = 'L',
+};
+
 /* The value type used in ctidx catalogue */
 struct layout_value {
 	struct generic_value lv_gval;
-	struct m0_dix_layout lv_layout;
+	struct ctidx_layout  lv_layout;
 };
-M0_BASSERT(sizeof(struct generic_value) + sizeof(struct m0_dix_layout) ==
+M0_BASSERT(sizeof(struct generic_value) + sizeof(struct ctidx_layout) ==
 	   sizeof(struct layout_value));
 
 /* } end of schema. */
@@ -131,6 +188,62 @@ enum cursor_phase {
 	CPH_NEXT
 };
 
+enum {
+	/** Number of buckets of m0_ctg_store::cs_vol. */
+	CTG_VOL_BUCKET_NR = 64,
+	/** Minimal size of the records array of a volatile catalogue. */
+	CTG_VOL_REC_MIN   = 16,
+};
+
+/** Record of a volatile catalogue. */
+struct ctg_vol_rec {
+	/** Key in the format of btree keys, see ::generic_key. */
+	struct m0_buf vr_key;
+	/** Value as provided by the user. */
+	struct m0_buf vr_val;
+};
+
+/**
+ * Volatile catalogue, see m0_ctg_vol_insert().
+ *
+ * Catalogue descriptor is embedded, so users of the catalogue store handle
+ * volatile catalogues the same way as BE ones.
+ */
+struct ctg_vol {
+	/** Catalogue descriptor with m0_cas_ctg::cc_volatile set. */
+	struct m0_cas_ctg   cv_ctg;
+	struct m0_fid       cv_fid;
+	/** Fid and layout (for component catalogue) given at creation. */
+	struct m0_cas_id    cv_cid;
+	/** Value returned by meta lookups, points to ctg_vol::cv_ctg. */
+	struct meta_value   cv_meta;
+	/** Records sorted by keys, see ctg_cmp(). */
+	struct ctg_vol_rec *cv_rec;
+	/** Number of records. */
+	uint64_t            cv_nr;
+	/** Number of allocated elements of ctg_vol::cv_rec[]. */
+	uint64_t            cv_size;
+	/** Linkage into m0_ctg_store::cs_vol. */
+	struct m0_hlink     cv_link;
+	uint64_t            cv_magic;
+};
+
+static uint64_t ctg_vol_hash(const struct m0_htable *htable, const void *key)
+{
+	return m0_fid_hash(key) % htable->h_bucket_nr;
+}
+
+static bool ctg_vol_key_eq(const void *key1, const void *key2)
+{
+	return m0_fid_eq(key1, key2);
+}
+
+M0_HT_DESCR_DEFINE(ctg_vol, "Volatile catalogues", static, struct ctg_vol,
+		   cv_link, cv_magic, M0_CAS_CTG_VOL_MAGIC,
+		   M0_CAS_CTG_VOL_HEAD_MAGIC, cv_fid, ctg_vol_hash,
+		   ctg_vol_key_eq);
+M0_HT_DEFINE(ctg_vol, static, struct ctg_vol, struct m0_fid);
+
 static struct m0_be_seg *cas_seg(struct m0_be_domain *dom);
 
 static bool ctg_op_is_versioned(const struct m0_ctg_op *op);
@@ -142,8 +255,10 @@ static int  ctg_kbuf_unpack  (struct m0_buf *buf);
 static int  ctg_kbuf_get     (struct m0_buf *dst, const struct m0_buf *src,
 			      bool enabled_fi);
 static void ctg_init         (struct m0_cas_ctg *ctg, struct m0_be_seg *seg);
-static void ctg_open         (struct m0_cas_ctg *ctg, struct m0_be_seg *seg);
+static void ctg_open         (struct m0_cas_ctg *ctg, struct m0_be_seg *seg,
+			      enum cas_tree_type ctype);
 static void ctg_fini         (struct m0_cas_ctg *ctg);
+static void ctg_filter_free  (struct m0_cas_ctg *ctg);
 static void ctg_destroy      (struct m0_cas_ctg *ctg, struct m0_be_tx *tx);
 static int  ctg_meta_selfadd (struct m0_btree *meta, struct m0_be_tx *tx);
 static void ctg_meta_delete  (struct m0_btree  *meta,
@@ -174,6 +289,11 @@ static int  ctg_exec         (struct m0_ctg_op    *ctg_op,
 			      const struct m0_buf *key,
 			      int                  next_phase);
 static void ctg_store_release(struct m0_ref *ref);
+static bool ctidx_layout_has_ext(const struct m0_dix_layout *layout);
+static int  ctidx_ext_del    (const struct m0_fid *cfid, struct m0_be_tx *tx);
+static int  ctg_ctidx_op_put (struct m0_ctg_op *ctg_op, struct m0_be_tx *tx);
+static int  ctg_ctidx_op_get (struct m0_ctg_op *ctg_op);
+static void ctg_vol_free(struct ctg_vol *vol);
 
 static m0_bcount_t ctg_ksize (const void *key);
 
@@ -183,6 +303,11 @@ static int versioned_put_sync        (struct m0_ctg_op *ctg_op);
 static int versioned_get_sync        (struct m0_ctg_op *op);
 static int versioned_cursor_next_sync(struct m0_ctg_op *op, bool alive_only);
 static int versioned_cursor_get_sync (struct m0_ctg_op *op, bool alive_only);
+static int versioned_put_get_cb      (struct m0_btree_cb  *cb,
+				      struct m0_btree_rec *rec);
+static void ctg_filter_delete        (struct m0_cas_ctg   *ctg,
+				      const struct m0_buf *key);
+static bool ctg_is_ordinary          (const struct m0_cas_ctg *ctg);
 
 /**
  * Mutex to provide thread-safety for catalogue store singleton initialisation.
@@ -315,15 +440,15 @@ static int ctg_vbuf_as_ctg(const struct m0_buf *buf, struct m0_cas_ctg **ctg)
 /**
  * Get the layout from an unpacked ::layout_value (cctidx value).
  */
-static int ctg_vbuf_as_layout(const struct m0_buf    *buf,
-			      struct m0_dix_layout **layout)
+static int ctg_vbuf_as_layout(const struct m0_buf   *buf,
+			      struct ctidx_layout  **layout)
 {
 	struct generic_value *gv = M0_AMB(gv, buf->b_addr, gv_data);
 	struct layout_value  *lv = M0_AMB(lv, gv, lv_gval);
 
 	M0_ENTRY();
 
-	if (buf->b_nob == sizeof(struct m0_dix_layout)) {
+	if (buf->b_nob == sizeof(struct ctidx_layout)) {
 		*layout = &lv->lv_layout;
 		return M0_RC(0);
 	} else
@@ -401,6 +526,22 @@ static int ctg_cmp(const void *opaque_key_left, const void *opaque_key_right)
 		M0_3WAY(left->gk_length, right->gk_length);
 }
 
+/**
+ * Returns key comparison operations of a catalogue of the given type.
+ *
+ * Keys of meta and catalogue-index catalogues are fixed size fid_key-s having
+ * the same gk_length, so ctg_cmp() orders them as memcmp() of the whole key
+ * does and the btree can search their nodes without calling ctg_cmp().
+ */
+static struct m0_btree_rec_key_op ctg_keycmp(enum cas_tree_type ctype)
+{
+	return (struct m0_btree_rec_key_op) {
+		.rko_keycmp = ctg_cmp,
+		.rko_flags  = M0_IN(ctype, (CTT_META, CTT_CTIDX)) ?
+			      M0_BKF_MEMCMP : 0,
+	};
+}
+
 static void ctg_init(struct m0_cas_ctg *ctg, struct m0_be_seg *seg)
 {
 	m0_format_header_pack(&ctg->cc_head, &(struct m0_format_tag){
@@ -410,16 +551,21 @@ static void ctg_init(struct m0_cas_ctg *ctg, struct m0_be_seg *seg)
 	});
 	M0_ENTRY();
 	m0_long_lock_init(m0_ctg_lock(ctg));
+	/* Catalogues are read-locked by foms of all localities. */
+	m0_long_lock_rd_init(m0_ctg_lock(ctg), m0_fom_dom()->fd_localities_nr);
 	m0_mutex_init(&ctg->cc_chan_guard.bm_u.mutex);
 	m0_chan_init(&ctg->cc_chan.bch_chan, &ctg->cc_chan_guard.bm_u.mutex);
 	ctg->cc_inited = true;
+	ctg->cc_filter = NULL;
+	ctg->cc_volatile = false;
 	m0_format_footer_update(ctg);
 }
 
-static void ctg_open(struct m0_cas_ctg *ctg, struct m0_be_seg *seg)
+static void ctg_open(struct m0_cas_ctg *ctg, struct m0_be_seg *seg,
+		     enum cas_tree_type ctype)
 {
-	struct m0_btree_op         b_op = {};
-	struct m0_btree_rec_key_op key_cmp = { .rko_keycmp = ctg_cmp, };
+	struct m0_btree_op         b_op    = {};
+	struct m0_btree_rec_key_op key_cmp = ctg_keycmp(ctype);
 	int                        rc;
 
 	ctg_init(ctg, seg);
@@ -441,6 +587,7 @@ static void ctg_fini(struct m0_cas_ctg *ctg)
 	M0_ENTRY("ctg=%p", ctg);
 
 	ctg->cc_inited = false;
+	ctg_filter_free(ctg);
 	if (ctg->cc_tree != NULL) {
 		rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
 					   m0_btree_close(ctg->cc_tree, &b_op));
@@ -452,6 +599,54 @@ static void ctg_fini(struct m0_cas_ctg *ctg)
 	m0_mutex_fini(&ctg->cc_chan_guard.bm_u.mutex);
 }
 
+enum {
+	/** Records of the declared size a node should hold. */
+	CTG_NODE_RECS         = 32,
+	/**
+	 * Per-record overhead of a variable format node and of CAS key and
+	 * value headers.
+	 */
+	CTG_NODE_REC_OVERHEAD = 32,
+};
+
+static bool        ctg_node_size_on      = false;
+static m0_bcount_t ctg_node_size_kv_size = 0;
+
+M0_INTERNAL void m0_ctg_node_size_adaptive(bool enable, m0_bcount_t kv_size)
+{
+	ctg_node_size_on      = enable;
+	ctg_node_size_kv_size = kv_size;
+}
+
+M0_INTERNAL int m0_ctg_node_size(m0_bcount_t kv_size)
+{
+	m0_bcount_t need  = CTG_NODE_RECS * (kv_size + CTG_NODE_REC_OVERHEAD);
+	int         nsize = m0_pagesize_get();
+
+	while (nsize < M0_CTG_ROOT_NODE_SIZE && nsize < need)
+		nsize <<= 1;
+	return min_check(nsize, (int)M0_CTG_ROOT_NODE_SIZE);
+}
+
+/**
+ * Node size of a new catalogue of the given type, see
+ * m0_ctg_node_size_adaptive().
+ */
+static int ctg_node_size_pick(enum cas_tree_type ctype)
+{
+	uint64_t    nr      = ctg_store.cs_state == NULL ? 0 :
+				ctg_store.cs_state->cs_rec_nr;
+	m0_bcount_t kv_size = ctg_node_size_kv_size;
+
+	if (ctype != CTT_CTG || !ctg_node_size_on)
+		return M0_CTG_ROOT_NODE_SIZE;
+	/* Counters stick to ~0ULL on overflow, see ctg_state_update(). */
+	if (kv_size == 0 && nr != 0 && nr != ~0ULL &&
+	    ctg_store.cs_state->cs_rec_size != ~0ULL)
+		kv_size = ctg_store.cs_state->cs_rec_size / nr;
+	return kv_size == 0 ? M0_CTG_ROOT_NODE_SIZE : m0_ctg_node_size(kv_size);
+}
+
 int m0_ctg_create(struct m0_be_seg *seg, struct m0_be_tx *tx,
 		  struct m0_cas_ctg **out,
 		  const struct m0_fid *cas_fid, enum cas_tree_type ctype)
@@ -459,13 +654,14 @@ int m0_ctg_create(struct m0_be_seg *seg, struct m0_be_tx *tx,
 	struct m0_cas_ctg          *ctg;
 	int                         rc;
 	struct m0_btree_op          b_op    = {};
-	struct m0_btree_rec_key_op  key_cmp = { .rko_keycmp = ctg_cmp, };
+	struct m0_btree_rec_key_op  key_cmp = ctg_keycmp(ctype);
 	struct m0_fid              *fid     = &M0_FID_TINIT('b',
 							cas_fid->f_container,
 							cas_fid->f_key);
 	struct m0_btree_type        bt      = {
 		.tt_id = M0_BT_CAS_CTG,
 	};
+	int                         nsize   = ctg_node_size_pick(ctype);
 
 	M0_PRE(M0_IN(ctype, (CTT_CTG, CTT_META, CTT_DEADIDX, CTT_CTIDX)));
 
@@ -500,9 +696,13 @@ int m0_ctg_create(struct m0_be_seg *seg, struct m0_be_tx *tx,
 	if (ctg->cc_tree == NULL)
 		return M0_ERR(-ENOMEM);
 
+	/*
+	 * The root node takes the beginning of cc_node, the other nodes of the
+	 * tree are of the root node size.
+	 */
+	M0_LOG(M0_DEBUG, "fid="FID_F" nsize=%d", FID_P(fid), nsize);
 	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
-				      m0_btree_create(&ctg->cc_node,
-						      sizeof ctg->cc_node,
+				      m0_btree_create(&ctg->cc_node, nsize,
 						      &bt, M0_BCT_NO_CRC,
 						      &b_op, ctg->cc_tree,
 						      seg, fid, tx, &key_cmp));
@@ -594,6 +794,136 @@ M0_INTERNAL int m0_ctg_meta_find_ctg(struct m0_cas_ctg    *meta,
 	return M0_RC(rc);
 }
 
+M0_INTERNAL int m0_ctg_meta_next_ctg(const struct m0_fid  *from,
+				     bool                  exclude,
+				     struct m0_fid        *fid,
+				     struct m0_cas_ctg   **ctg)
+{
+	struct m0_btree_cursor cursor;
+	struct fid_key         key_data = FID_KEY_INIT(from);
+	void                  *k_ptr    = &key_data;
+	m0_bcount_t            ksize    = sizeof key_data;
+	struct m0_btree_key    r_key    = {
+		.k_data = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize),
+	};
+	struct m0_buf          key;
+	struct m0_buf          val;
+	int                    rc;
+
+	m0_btree_cursor_init(&cursor, m0_ctg_meta()->cc_tree);
+	for (rc = m0_btree_cursor_get(&cursor, &r_key, true); rc == 0;
+	     rc = m0_btree_cursor_next(&cursor)) {
+		m0_btree_cursor_kv_get(&cursor, &key, &val);
+		*fid = ((struct fid_key *)key.b_addr)->fk_fid;
+		if (exclude && m0_fid_eq(fid, from))
+			continue;
+		rc = ctg_vbuf_unpack(&val, NULL) ?:
+			ctg_vbuf_as_ctg(&val, ctg);
+		if (rc != 0)
+			break;
+		if (ctg_is_ordinary(*ctg)) {
+			m0_ctg_try_init(*ctg);
+			break;
+		}
+	}
+	m0_btree_cursor_fini(&cursor);
+	return M0_RC(rc);
+}
+
+M0_INTERNAL int m0_ctg_tbs_scan(struct m0_cas_ctg       *ctg,
+				struct m0_buf           *from,
+				const struct m0_dtm0_ts *horizon,
+				struct m0_ctg_tbs       *tbs,
+				uint32_t                *nr,
+				uint32_t                 scan_max,
+				bool                    *eot)
+{
+	struct m0_btree_cursor cursor;
+	struct m0_btree_key    r_key = {
+		.k_data = M0_BUFVEC_INIT_BUF(&from->b_addr, &from->b_nob),
+	};
+	struct m0_buf          key;
+	struct m0_buf          val;
+	struct m0_crv          crv;
+	m0_bcount_t            vnob;
+	uint32_t               max = *nr;
+	uint32_t               i;
+	int                    rc;
+
+	M0_PRE(max > 0 && scan_max > 0);
+
+	*nr = 0;
+	*eot = false;
+	m0_btree_cursor_init(&cursor, ctg->cc_tree);
+	rc = from->b_nob == 0 ? m0_btree_cursor_first(&cursor) :
+		m0_btree_cursor_get(&cursor, &r_key, true);
+	for (i = 0; rc == 0 && i < scan_max && *nr < max;
+	     ++i, rc = m0_btree_cursor_next(&cursor)) {
+		m0_btree_cursor_kv_get(&cursor, &key, &val);
+		vnob = val.b_nob;
+		rc = ctg_vbuf_unpack(&val, &crv);
+		if (rc != 0)
+			break;
+		if (!m0_crv_is_none(&crv) && m0_crv_tbs(&crv) &&
+		    m0_crv_ts(&crv).dts_phys < horizon->dts_phys) {
+			rc = m0_buf_copy(&tbs[*nr].ct_key, &key);
+			if (rc != 0)
+				break;
+			tbs[*nr].ct_vnob = vnob;
+			tbs[(*nr)++].ct_ver = crv;
+		}
+	}
+	m0_buf_free(from);
+	if (rc == 0) {
+		m0_btree_cursor_kv_get(&cursor, &key, NULL);
+		rc = m0_buf_copy(from, &key);
+	} else if (rc == -ENOENT) {
+		*eot = true;
+		rc = 0;
+	}
+	m0_btree_cursor_fini(&cursor);
+	return M0_RC(rc);
+}
+
+M0_INTERNAL void m0_ctg_tbs_del_credit(struct m0_cas_ctg       *ctg,
+				       const struct m0_ctg_tbs *tbs,
+				       struct m0_be_tx_credit  *accum)
+{
+	m0_btree_del_credit(ctg->cc_tree, 1, tbs->ct_key.b_nob, tbs->ct_vnob,
+			    accum);
+}
+
+M0_INTERNAL int m0_ctg_tbs_del(struct m0_cas_ctg       *ctg,
+			       struct m0_be_tx         *tx,
+			       const struct m0_ctg_tbs *tbs)
+{
+	struct m0_btree_op  kv_op = {};
+	void               *k_ptr = tbs->ct_key.b_addr;
+	m0_bcount_t         ksize = tbs->ct_key.b_nob;
+	struct m0_btree_key r_key = {
+		.k_data = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize),
+	};
+	struct m0_crv       crv   = M0_CRV_INIT_NONE;
+	struct m0_btree_cb  cb    = {
+		.c_act   = versioned_put_get_cb,
+		.c_datum = &crv,
+	};
+	int                 rc;
+
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+				      m0_btree_get(ctg->cc_tree, &r_key, &cb,
+						   BOF_EQUAL, &kv_op));
+	if (rc != 0)
+		return M0_RC(rc);
+	if (m0_crv_cmp(&crv, &tbs->ct_ver) != 0)
+		return M0_RC(-EEXIST);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+				      m0_btree_del(ctg->cc_tree, &r_key, NULL,
+						   &kv_op, tx));
+	if (rc == 0)
+		ctg_filter_delete(ctg, &tbs->ct_key);
+	return M0_RC(rc);
+}
 
 static int ctg_meta_put_cb(struct m0_btree_cb *cb, struct m0_btree_rec *rec)
 {
@@ -797,7 +1127,7 @@ static int ctg_store__init(struct m0_be_seg *seg, struct m0_cas_state *state)
 
 	ctg_store.cs_state = state;
 	m0_mutex_init(&state->cs_ctg_init_mutex.bm_u.mutex);
-	ctg_open(state->cs_meta, seg);
+	ctg_open(state->cs_meta, seg, CTT_META);
 
 	/* Searching for catalogue-index catalogue. */
 	rc = m0_ctg_meta_find_ctg(state->cs_meta, &m0_cas_ctidx_fid,
@@ -805,8 +1135,8 @@ static int ctg_store__init(struct m0_be_seg *seg, struct m0_cas_state *state)
 	     m0_ctg_meta_find_ctg(state->cs_meta, &m0_cas_dead_index_fid,
 			          &ctg_store.cs_dead_index);
 	if (rc == 0) {
-		ctg_open(ctg_store.cs_ctidx, seg);
-		ctg_open(ctg_store.cs_dead_index, seg);
+		ctg_open(ctg_store.cs_ctidx, seg, CTT_CTIDX);
+		ctg_open(ctg_store.cs_dead_index, seg, CTT_DEADIDX);
 	} else {
 		ctg_store.cs_ctidx = NULL;
 		ctg_store.cs_dead_index = NULL;
@@ -930,6 +1260,9 @@ M0_INTERNAL int m0_ctg_store_init(struct m0_be_domain *dom)
 		goto end;
 	}
 
+	result = ctg_vol_htable_init(&ctg_store.cs_vol, CTG_VOL_BUCKET_NR);
+	if (result != 0)
+		goto end;
 	/**
 	 * @todo Use 0type.
 	 */
@@ -950,11 +1283,13 @@ M0_INTERNAL int m0_ctg_store_init(struct m0_be_domain *dom)
 
 	if (result == 0) {
 		m0_mutex_init(&ctg_store.cs_state_mutex);
+		m0_mutex_init(&ctg_store.cs_vol_guard);
 		m0_long_lock_init(&ctg_store.cs_del_lock);
 		m0_ref_init(&ctg_store.cs_ref, 1, ctg_store_release);
 		ctg_store.cs_be_domain = dom;
 		ctg_store.cs_initialised = true;
-	}
+	} else
+		ctg_vol_htable_fini(&ctg_store.cs_vol);
 end:
 	m0_mutex_unlock(&cs_init_guard);
 	return M0_RC(result);
@@ -963,8 +1298,16 @@ end:
 static void ctg_store_release(struct m0_ref *ref)
 {
 	struct m0_ctg_store *ctg_store = M0_AMB(ctg_store, ref, cs_ref);
+	struct ctg_vol      *vol;
 
 	M0_ENTRY();
+	/* Volatile catalogues do not survive catalogue store finalisation. */
+	m0_htable_for(ctg_vol, vol, &ctg_store->cs_vol) {
+		ctg_vol_htable_del(&ctg_store->cs_vol, vol);
+		ctg_vol_free(vol);
+	} m0_htable_endfor;
+	ctg_vol_htable_fini(&ctg_store->cs_vol);
+	m0_mutex_fini(&ctg_store->cs_vol_guard);
 	m0_mutex_fini(&ctg_store->cs_state_mutex);
 	ctg_store->cs_state = NULL;
 	ctg_store->cs_ctidx = NULL;
@@ -1064,7 +1407,7 @@ M0_INTERNAL void m0_ctg_try_init(struct m0_cas_ctg *ctg)
 	 */
 	if (ctg != NULL && !ctg->cc_inited) {
 		M0_LOG(M0_DEBUG, "ctg_init %p", ctg);
-		ctg_open(ctg, cas_seg(ctg_store.cs_be_domain));
+		ctg_open(ctg, cas_seg(ctg_store.cs_be_domain), CTT_CTG);
 	} else
 		M0_LOG(M0_DEBUG, "ctg %p zero or inited", ctg);
 	m0_mutex_unlock(&ctg_store.cs_state->cs_ctg_init_mutex.bm_u.mutex);
@@ -1077,6 +1420,543 @@ static bool ctg_is_ordinary(const struct m0_cas_ctg *ctg)
 			    m0_ctg_meta()));
 }
 
+/* Key filters { */
+
+enum {
+	/** Counters per key, gives about 1% of false positives. */
+	CTG_FILTER_CNT_PER_KEY = 10,
+	CTG_FILTER_HASH_NR     = 7,
+	CTG_FILTER_CNT_MAX     = 0xf,
+	/** Minimal number of keys a filter is sized for. */
+	CTG_FILTER_KEYS_MIN    = 1024,
+};
+
+/**
+ * Counting Bloom filter of keys of an ordinary catalogue.
+ *
+ * The filter is built on the first lookup in the catalogue after the process
+ * start by the scan of catalogue btree and is updated by inserts and deletes
+ * afterwards. Lookup of a key absent in the filter returns -ENOENT without
+ * btree descent, false positives only cost the usual btree lookup.
+ *
+ * Counters are 4 bits wide, saturated counters are never decremented. The
+ * filter is sized for twice the number of keys found by the scan and is
+ * dropped when more keys are added to it, to be rebuilt on the next lookup.
+ *
+ * Lookups read and build the filter under the catalogue read lock, inserts and
+ * deletes update or drop it under the write lock (see cas_is_ro() in
+ * cas/service.c). Concurrent builds are serialised by ctg_filter_guard.
+ */
+struct m0_ctg_filter {
+	/** Number of counters, power of 2. */
+	uint64_t  cf_nr;
+	/** Number of keys the filter is sized for. */
+	uint64_t  cf_keys_max;
+	/** Number of keys added to the filter, including the scanned ones. */
+	uint64_t  cf_added;
+	/** Counters, two per byte. */
+	uint8_t  *cf_cnt;
+};
+
+static bool               ctg_filter_on = false;
+static struct m0_atomic64 ctg_filter_neg;
+static struct m0_mutex    ctg_filter_guard = M0_MUTEX_SINIT(&ctg_filter_guard);
+
+M0_INTERNAL void m0_ctg_filter_enable(bool enable)
+{
+	ctg_filter_on = enable;
+}
+
+M0_INTERNAL uint64_t m0_ctg_filter_neg_nr(void)
+{
+	return m0_atomic64_get(&ctg_filter_neg);
+}
+
+static uint64_t ctg_filter_idx(const struct m0_ctg_filter *f,
+			       const struct m0_buf *key, uint32_t i)
+{
+	uint64_t h1 = m0_hash_fnc_city(key->b_addr, key->b_nob);
+	uint64_t h2 = m0_hash(h1) | 1;
+
+	return (h1 + i * h2) & (f->cf_nr - 1);
+}
+
+static uint8_t ctg_filter_cnt(const struct m0_ctg_filter *f, uint64_t idx)
+{
+	return (f->cf_cnt[idx / 2] >> (idx % 2 * 4)) & CTG_FILTER_CNT_MAX;
+}
+
+static void ctg_filter_cnt_set(struct m0_ctg_filter *f, uint64_t idx,
+			       uint8_t cnt)
+{
+	uint8_t *byte  = &f->cf_cnt[idx / 2];
+	unsigned shift = idx % 2 * 4;
+
+	*byte = (*byte & ~(CTG_FILTER_CNT_MAX << shift)) | cnt << shift;
+}
+
+static bool ctg_filter_has(const struct m0_ctg_filter *f,
+			   const struct m0_buf *key)
+{
+	return m0_forall(i, CTG_FILTER_HASH_NR,
+			 ctg_filter_cnt(f, ctg_filter_idx(f, key, i)) != 0);
+}
+
+static void ctg_filter_add(struct m0_ctg_filter *f, const struct m0_buf *key)
+{
+	uint64_t idx;
+	uint8_t  cnt;
+	uint32_t i;
+
+	for (i = 0; i < CTG_FILTER_HASH_NR; i++) {
+		idx = ctg_filter_idx(f, key, i);
+		cnt = ctg_filter_cnt(f, idx);
+		if (cnt < CTG_FILTER_CNT_MAX)
+			ctg_filter_cnt_set(f, idx, cnt + 1);
+	}
+	f->cf_added++;
+}
+
+static void ctg_filter_remove(struct m0_ctg_filter *f,
+			      const struct m0_buf  *key)
+{
+	uint64_t idx;
+	uint8_t  cnt;
+	uint32_t i;
+
+	for (i = 0; i < CTG_FILTER_HASH_NR; i++) {
+		idx = ctg_filter_idx(f, key, i);
+		cnt = ctg_filter_cnt(f, idx);
+		if (cnt > 0 && cnt < CTG_FILTER_CNT_MAX)
+			ctg_filter_cnt_set(f, idx, cnt - 1);
+	}
+}
+
+static void ctg_filter_free(struct m0_cas_ctg *ctg)
+{
+	if (ctg->cc_filter != NULL) {
+		m0_free(ctg->cc_filter->cf_cnt);
+		m0_free0(&ctg->cc_filter);
+	}
+}
+
+/** Counts keys of the catalogue and adds them to the filter if it is given. */
+static int ctg_filter_scan(struct m0_cas_ctg    *ctg,
+			   struct m0_ctg_filter *f,
+			   uint64_t             *nr)
+{
+	struct m0_btree_cursor cursor;
+	struct m0_buf          key;
+	int                    rc;
+
+	*nr = 0;
+	m0_btree_cursor_init(&cursor, ctg->cc_tree);
+	for (rc = m0_btree_cursor_first(&cursor); rc == 0;
+	     rc = m0_btree_cursor_next(&cursor)) {
+		if (f != NULL) {
+			m0_btree_cursor_kv_get(&cursor, &key, NULL);
+			ctg_filter_add(f, &key);
+		}
+		++*nr;
+	}
+	m0_btree_cursor_fini(&cursor);
+	return rc == -ENOENT ? 0 : rc;
+}
+
+static struct m0_ctg_filter *ctg_filter_build(struct m0_cas_ctg *ctg)
+{
+	struct m0_ctg_filter *f = NULL;
+	uint64_t              nr;
+	int                   rc;
+
+	m0_mutex_lock(&ctg_filter_guard);
+	if (ctg->cc_filter != NULL) {
+		f = ctg->cc_filter;
+		goto unlock;
+	}
+	rc = ctg_filter_scan(ctg, NULL, &nr);
+	if (rc != 0)
+		goto err;
+	M0_ALLOC_PTR(f);
+	if (f == NULL) {
+		rc = -ENOMEM;
+		goto err;
+	}
+	f->cf_keys_max = max64u(2 * nr, CTG_FILTER_KEYS_MIN);
+	for (f->cf_nr = 2; f->cf_nr < f->cf_keys_max * CTG_FILTER_CNT_PER_KEY;)
+		f->cf_nr <<= 1;
+	f->cf_cnt = m0_alloc(f->cf_nr / 2);
+	rc = f->cf_cnt == NULL ? -ENOMEM : ctg_filter_scan(ctg, f, &nr);
+	if (rc != 0) {
+		m0_free(f->cf_cnt);
+		m0_free0(&f);
+		goto err;
+	}
+	ctg->cc_filter = f;
+	M0_LOG(M0_DEBUG, "ctg=%p keys=%"PRIu64" counters=%"PRIu64,
+	       ctg, nr, f->cf_nr);
+	goto unlock;
+err:
+	M0_LOG(M0_WARN, "Cannot build filter of ctg=%p: rc=%d", ctg, rc);
+unlock:
+	m0_mutex_unlock(&ctg_filter_guard);
+	return f;
+}
+
+/** Returns false if the key is known to be absent in the catalogue. */
+static bool ctg_filter_may_have(struct m0_cas_ctg   *ctg,
+				const struct m0_buf *key)
+{
+	struct m0_ctg_filter *f;
+
+	if (!ctg_filter_on || !ctg_is_ordinary(ctg))
+		return true;
+	f = ctg->cc_filter ?: ctg_filter_build(ctg);
+	if (f == NULL || ctg_filter_has(f, key))
+		return true;
+	m0_atomic64_inc(&ctg_filter_neg);
+	return false;
+}
+
+static void ctg_filter_insert(struct m0_cas_ctg   *ctg,
+			      const struct m0_buf *key)
+{
+	struct m0_ctg_filter *f = ctg->cc_filter;
+
+	if (f == NULL)
+		return;
+	if (f->cf_added < f->cf_keys_max)
+		ctg_filter_add(f, key);
+	else
+		ctg_filter_free(ctg);
+}
+
+static void ctg_filter_delete(struct m0_cas_ctg   *ctg,
+			      const struct m0_buf *key)
+{
+	if (ctg->cc_filter != NULL)
+		ctg_filter_remove(ctg->cc_filter, key);
+}
+
+/* } Key filters */
+
+/* Volatile catalogues { */
+
+static struct ctg_vol *ctg_vol_of(struct m0_cas_ctg *ctg)
+{
+	M0_PRE(ctg->cc_volatile);
+	return container_of(ctg, struct ctg_vol, cv_ctg);
+}
+
+static struct ctg_vol *ctg_vol_find(const struct m0_fid *fid)
+{
+	struct ctg_vol *vol;
+
+	m0_mutex_lock(&ctg_store.cs_vol_guard);
+	vol = ctg_vol_htable_lookup(&ctg_store.cs_vol, fid);
+	m0_mutex_unlock(&ctg_store.cs_vol_guard);
+	return vol;
+}
+
+static int ctg_vol_create(const struct m0_cas_id *cid)
+{
+	struct ctg_vol *vol;
+	int             rc = 0;
+
+	vol = m0_alloc_aligned(sizeof *vol, M0_CTG_SHIFT);
+	if (vol == NULL)
+		return M0_ERR(-ENOMEM);
+	vol->cv_fid = cid->ci_fid;
+	vol->cv_cid.ci_fid = cid->ci_fid;
+	vol->cv_cid.ci_layout.dl_type = cid->ci_layout.dl_type;
+	if (cid->ci_layout.dl_type == DIX_LTYPE_DESCR)
+		rc = m0_dix_ldesc_copy(&vol->cv_cid.ci_layout.u.dl_desc,
+				       &cid->ci_layout.u.dl_desc);
+	else
+		vol->cv_cid.ci_layout = cid->ci_layout;
+	if (rc != 0) {
+		m0_free_aligned(vol, sizeof *vol, M0_CTG_SHIFT);
+		return M0_ERR(rc);
+	}
+	ctg_init(&vol->cv_ctg, NULL);
+	vol->cv_ctg.cc_volatile = true;
+	vol->cv_meta = META_VALUE_INIT(&vol->cv_ctg);
+	ctg_vol_tlink_init(vol);
+	m0_mutex_lock(&ctg_store.cs_vol_guard);
+	ctg_vol_htable_add(&ctg_store.cs_vol, vol);
+	m0_mutex_unlock(&ctg_store.cs_vol_guard);
+	return M0_RC(0);
+}
+
+static void ctg_vol_free(struct ctg_vol *vol)
+{
+	uint64_t i;
+
+	for (i = 0; i < vol->cv_nr; i++) {
+		m0_buf_free(&vol->cv_rec[i].vr_key);
+		m0_buf_free(&vol->cv_rec[i].vr_val);
+	}
+	m0_free(vol->cv_rec);
+	if (vol->cv_cid.ci_layout.dl_type == DIX_LTYPE_DESCR)
+		m0_dix_ldesc_fini(&vol->cv_cid.ci_layout.u.dl_desc);
+	ctg_fini(&vol->cv_ctg);
+	ctg_vol_tlink_fini(vol);
+	m0_free_aligned(vol, sizeof *vol, M0_CTG_SHIFT);
+}
+
+/**
+ * Looks the key up in the volatile catalogue. Returns true if the key is
+ * found, "pos" is set to the position of the key or, if it is not found, of
+ * the first greater key.
+ */
+static bool ctg_vol_pos(const struct ctg_vol *vol, const struct m0_buf *key,
+			uint64_t *pos)
+{
+	uint64_t lo = 0;
+	uint64_t hi = vol->cv_nr;
+	uint64_t mid;
+	int      cmp;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		cmp = ctg_cmp(vol->cv_rec[mid].vr_key.b_addr, key->b_addr);
+		if (cmp == 0) {
+			*pos = mid;
+			return true;
+		} else if (cmp < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	*pos = lo;
+	return false;
+}
+
+static int ctg_vol_rec_insert(struct ctg_vol      *vol,
+			      uint64_t             pos,
+			      const struct m0_buf *key,
+			      const struct m0_buf *val)
+{
+	struct ctg_vol_rec  rec = {};
+	struct ctg_vol_rec *arr;
+	uint64_t            size;
+	int                 rc;
+
+	if (vol->cv_nr == vol->cv_size) {
+		size = max64u(vol->cv_size * 2, CTG_VOL_REC_MIN);
+		M0_ALLOC_ARR(arr, size);
+		if (arr == NULL)
+			return M0_ERR(-ENOMEM);
+		if (vol->cv_nr != 0)
+			memcpy(arr, vol->cv_rec, vol->cv_nr * sizeof arr[0]);
+		m0_free(vol->cv_rec);
+		vol->cv_rec = arr;
+		vol->cv_size = size;
+	}
+	rc = m0_buf_copy(&rec.vr_key, key) ?: m0_buf_copy(&rec.vr_val, val);
+	if (rc != 0) {
+		m0_buf_free(&rec.vr_key);
+		return M0_ERR(rc);
+	}
+	memmove(&vol->cv_rec[pos + 1], &vol->cv_rec[pos],
+		(vol->cv_nr - pos) * sizeof vol->cv_rec[0]);
+	vol->cv_rec[pos] = rec;
+	vol->cv_nr++;
+	return M0_RC(0);
+}
+
+static int ctg_vol_rec_update(struct ctg_vol      *vol,
+			      uint64_t             pos,
+			      const struct m0_buf *val)
+{
+	struct m0_buf copy = {};
+	int           rc;
+
+	rc = m0_buf_copy(&copy, val);
+	if (rc == 0) {
+		m0_buf_free(&vol->cv_rec[pos].vr_val);
+		vol->cv_rec[pos].vr_val = copy;
+	}
+	return M0_RC(rc);
+}
+
+static void ctg_vol_rec_delete(struct ctg_vol *vol, uint64_t pos)
+{
+	m0_buf_free(&vol->cv_rec[pos].vr_key);
+	m0_buf_free(&vol->cv_rec[pos].vr_val);
+	memmove(&vol->cv_rec[pos], &vol->cv_rec[pos + 1],
+		(vol->cv_nr - pos - 1) * sizeof vol->cv_rec[0]);
+	vol->cv_nr--;
+}
+
+/**
+ * Executes the operation on a volatile catalogue synchronously. Fom
+ * transaction is not used, the semantics of flags is the same as for BE
+ * catalogues, except for ::COF_VERSIONED which is ignored.
+ */
+static int ctg_op_exec_volatile(struct m0_ctg_op *ctg_op, int next_phase)
+{
+	struct ctg_vol     *vol  = ctg_vol_of(ctg_op->co_ctg);
+	struct m0_be_op    *beop = ctg_beop(ctg_op);
+	int                 opc  = ctg_op->co_opcode;
+	uint32_t            flags = ctg_op->co_flags;
+	struct ctg_vol_rec *rec;
+	uint64_t            pos   = 0;
+	bool                found = false;
+	int                 rc;
+	M0_ENTRY();
+
+	M0_PRE(ctg_op->co_ct == CT_BTREE);
+	M0_PRE(ergo(opc == CO_CUR,
+		    M0_IN(ctg_op->co_cur_phase, (CPH_GET, CPH_NEXT))));
+
+	if (opc != CO_CUR || ctg_op->co_cur_phase == CPH_GET)
+		found = ctg_vol_pos(vol, &ctg_op->co_key, &pos);
+	switch (opc) {
+	case CO_PUT:
+		if (!found)
+			rc = ctg_vol_rec_insert(vol, pos, &ctg_op->co_key,
+						&ctg_op->co_val);
+		else if (flags & COF_OVERWRITE)
+			rc = ctg_vol_rec_update(vol, pos, &ctg_op->co_val);
+		else
+			rc = (flags & COF_CREATE) ? 0 : -EEXIST;
+		break;
+	case CO_GET:
+		if (found)
+			ctg_op->co_out_val = vol->cv_rec[pos].vr_val;
+		rc = found ? 0 : -ENOENT;
+		break;
+	case CO_DEL:
+		if (found)
+			ctg_vol_rec_delete(vol, pos);
+		rc = found ? 0 : -ENOENT;
+		break;
+	case CO_CUR:
+		if (ctg_op->co_cur_phase == CPH_NEXT)
+			pos = ctg_op->co_vol_pos + 1;
+		else if (!found && !(flags & COF_SLANT))
+			pos = vol->cv_nr;
+		if (pos < vol->cv_nr) {
+			rec = &vol->cv_rec[pos];
+			ctg_op->co_vol_pos = pos;
+			ctg_op->co_out_key = rec->vr_key;
+			ctg_op->co_out_val = rec->vr_val;
+			rc = ctg_kbuf_unpack(&ctg_op->co_out_key);
+		} else
+			rc = -ENOENT;
+		break;
+	default:
+		M0_IMPOSSIBLE("The other operations are not allowed here.");
+	}
+	ctg_op->co_rc = rc;
+
+	if (opc == CO_CUR) {
+		/* See ctg_op_exec_versioned(). */
+		m0_be_op_fini(beop);
+		M0_SET0(beop);
+	} else {
+		m0_be_op_active(beop);
+		m0_be_op_done(beop);
+	}
+	if (next_phase >= 0)
+		m0_fom_phase_set(ctg_op->co_fom, next_phase);
+	return M0_RC(M0_FSO_AGAIN);
+}
+
+/** Completes meta lookup of the volatile catalogue. */
+static int ctg_vol_meta_lookup(struct m0_ctg_op *ctg_op,
+			       struct ctg_vol   *vol,
+			       int               next_phase)
+{
+	ctg_op->co_ctg = m0_ctg_meta();
+	ctg_op->co_ct = CT_META;
+	ctg_op->co_out_val = M0_BUF_INIT(sizeof vol->cv_meta.mv_ctg,
+					 vol->cv_meta.mv_gval.gv_data);
+	ctg_op->co_rc = 0;
+	m0_be_op_active(&ctg_op->co_beop);
+	m0_be_op_done(&ctg_op->co_beop);
+	m0_fom_phase_set(ctg_op->co_fom, next_phase);
+	return M0_FSO_AGAIN;
+}
+
+M0_INTERNAL int m0_ctg_vol_insert(struct m0_ctg_op       *ctg_op,
+				  const struct m0_cas_id *cid,
+				  int                     next_phase)
+{
+	struct m0_cas_ctg *ctg;
+	int                rc;
+
+	M0_PRE(ctg_op != NULL);
+	M0_PRE(cid != NULL);
+	M0_PRE(ctg_op->co_beop.bo_sm.sm_state == M0_BOS_INIT);
+	M0_ENTRY("fid="FID_F, FID_P(&cid->ci_fid));
+
+	ctg_op->co_ctg = m0_ctg_meta();
+	ctg_op->co_ct = CT_META;
+	ctg_op->co_opcode = CO_PUT;
+	m0_be_op_active(&ctg_op->co_beop);
+	rc = m0_ctg_meta_find_ctg(m0_ctg_meta(), &cid->ci_fid, &ctg);
+	if (rc == 0 || (rc == -ENOENT && ctg_vol_find(&cid->ci_fid) != NULL))
+		rc = -EEXIST;
+	else if (rc == -ENOENT)
+		rc = ctg_vol_create(cid);
+	m0_be_op_done(&ctg_op->co_beop);
+	if (rc == -EEXIST && (ctg_op->co_flags & COF_CREATE))
+		rc = 0;
+	ctg_op->co_rc = rc;
+	m0_fom_phase_set(ctg_op->co_fom, next_phase);
+	return M0_RC(M0_FSO_AGAIN);
+}
+
+M0_INTERNAL bool m0_ctg_is_volatile(const struct m0_cas_ctg *ctg)
+{
+	return ctg->cc_volatile;
+}
+
+M0_INTERNAL bool m0_ctg_vol_exists(const struct m0_fid *fid)
+{
+	return ctg_vol_find(fid) != NULL;
+}
+
+M0_INTERNAL int m0_ctg_vol_layout_check(const struct m0_cas_id *cid)
+{
+	struct ctg_vol *vol;
+	int             rc;
+
+	m0_mutex_lock(&ctg_store.cs_vol_guard);
+	vol = ctg_vol_htable_lookup(&ctg_store.cs_vol, &cid->ci_fid);
+	if (vol == NULL)
+		rc = -ENOENT;
+	else if (!m0_dix_layout_eq(&cid->ci_layout, &vol->cv_cid.ci_layout))
+		rc = M0_ERR(-EKEYEXPIRED);
+	else
+		rc = 0;
+	m0_mutex_unlock(&ctg_store.cs_vol_guard);
+	return rc;
+}
+
+M0_INTERNAL void m0_ctg_vol_forget(struct m0_cas_ctg *ctg)
+{
+	struct ctg_vol *vol = ctg_vol_of(ctg);
+
+	M0_ENTRY("fid="FID_F, FID_P(&vol->cv_fid));
+	m0_mutex_lock(&ctg_store.cs_vol_guard);
+	ctg_vol_htable_del(&ctg_store.cs_vol, vol);
+	m0_mutex_unlock(&ctg_store.cs_vol_guard);
+	M0_LEAVE();
+}
+
+M0_INTERNAL void m0_ctg_vol_destroy(struct m0_cas_ctg *ctg)
+{
+	struct ctg_vol *vol = ctg_vol_of(ctg);
+
+	M0_PRE(!ctg_vol_tlink_is_in(vol));
+	ctg_vol_free(vol);
+}
+
+/* } Volatile catalogues */
+
 /* Callback after completion of operation. */
 static bool ctg_op_cb(struct m0_clink *clink)
 {
@@ -1324,6 +2204,12 @@ static int ctg_op_exec_normal(struct m0_ctg_op *ctg_op, int next_phase)
 	switch (CTG_OP_COMBINE(opc, ct)) {
 	case CTG_OP_COMBINE(CO_PUT, CT_BTREE):
 		m0_be_op_active(beop);
+		if (ctg_op->co_ctg == ctg_store.cs_ctidx) {
+			M0_ASSERT(!(ctg_op->co_flags & COF_OVERWRITE));
+			rc = ctg_ctidx_op_put(ctg_op, tx);
+			m0_be_op_done(beop);
+			break;
+		}
 
 		vsize = sizeof(struct generic_value) + ctg_op->co_val.b_nob;
 		rec.r_key.k_data = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize);
@@ -1342,6 +2228,8 @@ static int ctg_op_exec_normal(struct m0_ctg_op *ctg_op, int next_phase)
 						      m0_btree_put(btree, &rec,
 								   &cb, &kv_op,
 								   tx));
+		if (rc == 0)
+			ctg_filter_insert(ctg_op->co_ctg, key);
 		m0_be_op_done(beop);
 		break;
 	case CTG_OP_COMBINE(CO_PUT, CT_META): {
@@ -1397,10 +2285,14 @@ static int ctg_op_exec_normal(struct m0_ctg_op *ctg_op, int next_phase)
 		m0_be_op_active(beop);
 		rec.r_key.k_data = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize);
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_get(btree, &rec.r_key,
-							   &cb, BOF_EQUAL,
-							   &kv_op));
+		if (!ctg_filter_may_have(ctg_op->co_ctg, key))
+			rc = -ENOENT;
+		else if (ctg_op->co_ctg == ctg_store.cs_ctidx)
+			rc = ctg_ctidx_op_get(ctg_op);
+		else
+			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					m0_btree_get(btree, &rec.r_key,
+						     &cb, BOF_EQUAL, &kv_op));
 		m0_be_op_done(beop);
 		break;
 	case CTG_OP_COMBINE(CO_MIN, CT_BTREE):
@@ -1430,9 +2322,15 @@ static int ctg_op_exec_normal(struct m0_ctg_op *ctg_op, int next_phase)
 		m0_be_op_active(beop);
 		rec.r_key.k_data = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize);
 
-		rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-					      m0_btree_del(btree, &rec.r_key,
-							   NULL, &kv_op, tx));
+		if (ctg_op->co_ctg == ctg_store.cs_ctidx)
+			rc = ctidx_ext_del(&((struct fid_key *)
+					     key->b_addr)->fk_fid, tx);
+		if (rc == 0)
+			rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+					m0_btree_del(btree, &rec.r_key,
+						     NULL, &kv_op, tx));
+		if (rc == 0)
+			ctg_filter_delete(ctg_op->co_ctg, key);
 		m0_be_op_done(beop);
 		break;
 	case CTG_OP_COMBINE(CO_GC, CT_META):
@@ -1472,10 +2370,14 @@ static int ctg_op_exec_versioned(struct m0_ctg_op *ctg_op, int next_phase)
 	switch (CTG_OP_COMBINE(opc, ct)) {
 	case CTG_OP_COMBINE(CO_PUT, CT_BTREE):
 	case CTG_OP_COMBINE(CO_DEL, CT_BTREE):
+		/* Tombstones stay in the btree, keep them in the filter. */
 		rc = versioned_put_sync(ctg_op);
+		if (rc == 0)
+			ctg_filter_insert(ctg_op->co_ctg, &ctg_op->co_key);
 		break;
 	case CTG_OP_COMBINE(CO_GET, CT_BTREE):
-		rc = versioned_get_sync(ctg_op);
+		rc = ctg_filter_may_have(ctg_op->co_ctg, &ctg_op->co_key) ?
+			versioned_get_sync(ctg_op) : -ENOENT;
 		break;
 	case CTG_OP_COMBINE(CO_CUR, CT_BTREE):
 		if (ctg_op->co_cur_phase == CPH_GET)
@@ -1523,6 +2425,8 @@ static int ctg_op_exec_versioned(struct m0_ctg_op *ctg_op, int next_phase)
 static int ctg_op_exec(struct m0_ctg_op *ctg_op, int next_phase)
 {
 	M0_ENTRY();
+	if (ctg_op->co_ct == CT_BTREE && ctg_op->co_ctg->cc_volatile)
+		return ctg_op_exec_volatile(ctg_op, next_phase);
 	ctg_op->co_is_versioned = ctg_op_is_versioned(ctg_op);
 
 	return ctg_op->co_is_versioned ?
@@ -1585,6 +2489,11 @@ M0_INTERNAL int m0_ctg_meta_insert(struct m0_ctg_op    *ctg_op,
 	M0_PRE(ctg_op->co_beop.bo_sm.sm_state == M0_BOS_INIT);
 
 	ctg_op->co_opcode = CO_PUT;
+	if (ctg_vol_find(fid) != NULL) {
+		ctg_op->co_rc = M0_ERR(-EEXIST);
+		m0_fom_phase_set(ctg_op->co_fom, next_phase);
+		return M0_FSO_AGAIN;
+	}
 
 	return ctg_meta_exec(ctg_op, fid, next_phase);
 }
@@ -1606,12 +2515,17 @@ M0_INTERNAL int m0_ctg_meta_lookup(struct m0_ctg_op    *ctg_op,
 				   const struct m0_fid *fid,
 				   int                  next_phase)
 {
+	struct ctg_vol *vol;
+
 	M0_PRE(ctg_op != NULL);
 	M0_PRE(fid != NULL);
 	M0_PRE(ctg_op->co_beop.bo_sm.sm_state == M0_BOS_INIT);
 	M0_ENTRY();
 
 	ctg_op->co_opcode = CO_GET;
+	vol = ctg_vol_find(fid);
+	if (vol != NULL)
+		return ctg_vol_meta_lookup(ctg_op, vol, next_phase);
 
 	return ctg_meta_exec(ctg_op, fid, next_phase);
 }
@@ -2086,7 +3000,16 @@ M0_INTERNAL void m0_ctg_drop_credit(struct m0_fom          *fom,
 				    struct m0_cas_ctg      *ctg,
 				    m0_bcount_t            *limit)
 {
-	m0_btree_truncate_credit(m0_fom_tx(fom), ctg->cc_tree, accum, limit);
+	struct m0_be_tx_credit cred = {};
+	m0_bcount_t            max  = *limit;
+
+	m0_btree_truncate_credit(m0_fom_tx(fom), ctg->cc_tree, &cred, limit);
+	if (max != 0 && max < *limit) {
+		*limit = max;
+		M0_SET0(&cred);
+		m0_btree_truncate_nr_credit(ctg->cc_tree, &cred, max);
+	}
+	m0_be_tx_credit_add(accum, &cred);
 }
 
 M0_INTERNAL void m0_ctg_dead_clean_credit(struct m0_be_tx_credit *accum)
@@ -2135,10 +3058,12 @@ static void ctg_ctidx_op_credits(struct m0_cas_id       *cid,
 				 bool                    insert,
 				 struct m0_be_tx_credit *accum)
 {
-	const struct m0_dix_imask *imask;
-	struct m0_btree           *btree = ctg_store.cs_ctidx->cc_tree;
-	m0_bcount_t                knob;
-	m0_bcount_t                vnob;
+	const struct m0_dix_imask  *imask;
+	const struct m0_dix_ranges *ranges;
+	struct m0_btree            *btree = ctg_store.cs_ctidx->cc_tree;
+	m0_bcount_t                 knob;
+	m0_bcount_t                 vnob;
+	uint32_t                    i;
 
 	knob = sizeof(struct fid_key);
 	vnob = sizeof(struct layout_value);
@@ -2146,6 +3071,14 @@ static void ctg_ctidx_op_credits(struct m0_cas_id       *cid,
 		m0_btree_put_credit(btree, 1, knob, vnob, accum);
 	else
 		m0_btree_del_credit(btree, 1, knob, vnob, accum);
+	/*
+	 * The extension record. The layout of a deleted catalogue is not known
+	 * in advance, so deletion always reserves for it.
+	 */
+	if (insert && ctidx_layout_has_ext(&cid->ci_layout))
+		m0_btree_put_credit(btree, 1, knob, vnob, accum);
+	else if (!insert)
+		m0_btree_del_credit(btree, 1, knob, vnob, accum);
 
 	imask = &cid->ci_layout.u.dl_desc.ld_imask;
 	if (!m0_dix_imask_is_empty(imask)) {
@@ -2161,6 +3094,17 @@ static void ctg_ctidx_op_credits(struct m0_cas_id       *cid,
 					       0, accum);
 
 	}
+	ranges = &cid->ci_layout.u.dl_desc.ld_ranges;
+	if (ranges->dr_nr != 0) {
+		m0_be_allocator_credit(NULL, insert ? M0_BAO_ALLOC :
+				       M0_BAO_FREE, ranges->dr_nr *
+				       sizeof(ranges->dr_part[0]), 0, accum);
+		for (i = 0; i < ranges->dr_nr; i++)
+			m0_be_allocator_credit(NULL, insert ? M0_BAO_ALLOC :
+					       M0_BAO_FREE,
+					       ranges->dr_part[i].dr_start.b_nob,
+					       0, accum);
+	}
 }
 
 M0_INTERNAL void m0_ctg_ctidx_insert_credits(struct m0_cas_id       *cid,
@@ -2181,132 +3125,319 @@ M0_INTERNAL void m0_ctg_ctidx_delete_credits(struct m0_cas_id       *cid,
 	ctg_ctidx_op_credits(cid, false, accum);
 }
 
-static int ctg_ctidx_get_cb(struct m0_btree_cb *cb, struct m0_btree_rec *rec)
+static bool ctidx_layout_has_ext(const struct m0_dix_layout *layout)
 {
-	int                    rc;
-	struct                 m0_buf btree_val;
-	struct m0_dix_layout **layout = cb->c_datum;
+	return layout->dl_type == DIX_LTYPE_DESCR &&
+	       (layout->u.dl_desc.ld_ranges.dr_nr != 0 ||
+		layout->u.dl_desc.ld_ec_data != 0);
+}
+
+/**
+ * Key of the extension record of component catalogue @cfid. The fid type
+ * keeps extension records apart from component catalogue records.
+ */
+static void ctidx_ext_fid(struct m0_fid *ext, const struct m0_fid *cfid)
+{
+	*ext = *cfid;
+	m0_fid_tchange(ext, CTIDX_EXT_FID_TYPE);
+}
+
+static void ctidx_layout_pack(struct ctidx_layout        *dst,
+			      const struct m0_dix_layout *src)
+{
+	M0_SET0(dst);
+	dst->cl_type = src->dl_type;
+	switch (src->dl_type) {
+	case DIX_LTYPE_ID:
+		dst->u.cl_id = src->u.dl_id;
+		break;
+	case DIX_LTYPE_DESCR:
+		dst->u.cl_desc.cl_hash_fnc = src->u.dl_desc.ld_hash_fnc;
+		dst->u.cl_desc.cl_pver     = src->u.dl_desc.ld_pver;
+		dst->u.cl_desc.cl_imask    = src->u.dl_desc.ld_imask;
+		break;
+	case DIX_LTYPE_CAPTURE_DESCR:
+		dst->u.cl_cap_desc = src->u.dl_cap_desc;
+		break;
+	case DIX_LTYPE_COMPOSITE_DESCR:
+		dst->u.cl_comp_desc = src->u.dl_comp_desc;
+		break;
+	}
+}
+
+/**
+ * Converts a stored layout into m0_dix_layout. The extension parts are left
+ * empty, see ctidx_ext_get().
+ */
+static void ctidx_layout_unpack(struct m0_dix_layout      *dst,
+				const struct ctidx_layout *src)
+{
+	M0_SET0(dst);
+	dst->dl_type = src->cl_type;
+	switch (src->cl_type) {
+	case DIX_LTYPE_ID:
+		dst->u.dl_id = src->u.cl_id;
+		break;
+	case DIX_LTYPE_DESCR:
+		dst->u.dl_desc.ld_hash_fnc = src->u.cl_desc.cl_hash_fnc;
+		dst->u.dl_desc.ld_pver     = src->u.cl_desc.cl_pver;
+		dst->u.dl_desc.ld_imask    = src->u.cl_desc.cl_imask;
+		break;
+	case DIX_LTYPE_CAPTURE_DESCR:
+		dst->u.dl_cap_desc = src->u.cl_cap_desc;
+		break;
+	case DIX_LTYPE_COMPOSITE_DESCR:
+		dst->u.dl_comp_desc = src->u.cl_comp_desc;
+		break;
+	}
+}
+
+struct ctidx_put_cb_data {
+	const struct m0_fid       *d_fid;
+	const struct ctidx_layout *d_layout;
+};
+
+static int ctidx_put_cb(struct m0_btree_cb *cb, struct m0_btree_rec *rec)
+{
+	struct ctidx_put_cb_data *datum      = cb->c_datum;
+	struct fid_key            key_data   = FID_KEY_INIT(datum->d_fid);
+	struct layout_value       value_data =
+		LAYOUT_VALUE_INIT(datum->d_layout);
+
+	/* Copy key in btree */
+	M0_ASSERT(m0_vec_count(&rec->r_key.k_data.ov_vec) == sizeof key_data);
+	m0_memmove(rec->r_key.k_data.ov_buf[0], &key_data, sizeof key_data);
+
+	/* Copy value in btree */
+	M0_ASSERT(m0_vec_count(&rec->r_val.ov_vec) == sizeof value_data);
+	m0_memmove(rec->r_val.ov_buf[0], &value_data, sizeof value_data);
+	return 0;
+}
+
+static int ctidx_put(const struct m0_fid       *fid,
+		     const struct ctidx_layout *layout,
+		     struct m0_be_tx           *tx)
+{
+	struct fid_key           key_data   = FID_KEY_INIT(fid);
+	struct m0_buf            key        = M0_BUF_INIT_PTR(&key_data);
+	struct layout_value      value_data = LAYOUT_VALUE_INIT(layout);
+	struct m0_buf            value      = M0_BUF_INIT_PTR(&value_data);
+	struct m0_btree_op       kv_op      = {};
+	struct m0_btree_rec      rec        = {
+		.r_key.k_data = M0_BUFVEC_INIT_BUF(&key.b_addr, &key.b_nob),
+		.r_val        = M0_BUFVEC_INIT_BUF(&value.b_addr, &value.b_nob),
+		.r_crc_type   = M0_BCT_NO_CRC,
+	};
+	struct ctidx_put_cb_data cb_data    = {
+		.d_fid    = fid,
+		.d_layout = layout,
+	};
+	struct m0_btree_cb       put_cb     = {
+		.c_act   = ctidx_put_cb,
+		.c_datum = &cb_data,
+	};
+
+	return M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+				m0_btree_put(ctg_store.cs_ctidx->cc_tree, &rec,
+					     &put_cb, &kv_op, tx));
+}
+
+static int ctidx_get_cb(struct m0_btree_cb *cb, struct m0_btree_rec *rec)
+{
+	struct ctidx_layout *out = cb->c_datum;
+	struct ctidx_layout *layout;
+	struct m0_buf        btree_val;
+	int                  rc;
 
 	m0_buf_init(&btree_val, rec->r_val.ov_buf[0],
 		    m0_vec_count(&rec->r_val.ov_vec));
 	rc = ctg_vbuf_unpack(&btree_val, NULL) ?:
-	     ctg_vbuf_as_layout(&btree_val, layout);
+	     ctg_vbuf_as_layout(&btree_val, &layout);
+	if (rc == 0)
+		*out = *layout;
 	return rc;
 }
 
-M0_INTERNAL int m0_ctg_ctidx_lookup_sync(const struct m0_fid  *fid,
-					 struct m0_dix_layout **layout)
-{
-	struct fid_key       key_data  = FID_KEY_INIT(fid);
-	struct m0_buf        key       = M0_BUF_INIT_PTR(&key_data);
-	struct m0_cas_ctg   *ctidx     = m0_ctg_ctidx();
-	struct m0_btree_op   kv_op     = {};
-	struct m0_btree_rec  rec       = {};
-	void                *k_ptr;
-	m0_bcount_t          ksize;
-	int                  rc;
-	struct m0_btree_cb   get_cb    = {
-		.c_act   = ctg_ctidx_get_cb,
+static int ctidx_get(const struct m0_fid *fid, struct ctidx_layout *layout)
+{
+	struct fid_key      key_data = FID_KEY_INIT(fid);
+	struct m0_buf       key      = M0_BUF_INIT_PTR(&key_data);
+	struct m0_btree_op  kv_op    = {};
+	struct m0_btree_key r_key    = {
+		.k_data = M0_BUFVEC_INIT_BUF(&key.b_addr, &key.b_nob),
+	};
+	struct m0_btree_cb  get_cb   = {
+		.c_act   = ctidx_get_cb,
 		.c_datum = layout,
-		};
-
-	M0_PRE(fid != NULL);
-	M0_PRE(layout != NULL);
+	};
 
-	if (ctidx == NULL)
-		return M0_ERR(-EFAULT);
+	return M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+				m0_btree_get(ctg_store.cs_ctidx->cc_tree,
+					     &r_key, &get_cb, BOF_EQUAL,
+					     &kv_op));
+}
 
-	*layout = NULL;
+static int ctidx_del(const struct m0_fid *fid, struct m0_be_tx *tx)
+{
+	struct fid_key      key_data = FID_KEY_INIT(fid);
+	struct m0_buf       key      = M0_BUF_INIT_PTR(&key_data);
+	struct m0_btree_op  kv_op    = {};
+	struct m0_btree_key r_key    = {
+		.k_data = M0_BUFVEC_INIT_BUF(&key.b_addr, &key.b_nob),
+	};
 
-	k_ptr = key.b_addr;
-	ksize = key.b_nob;
+	/** @todo Make it asynchronous. */
+	return M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
+				m0_btree_del(ctg_store.cs_ctidx->cc_tree,
+					     &r_key, NULL, &kv_op, tx));
+}
 
-	rec.r_key.k_data = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize);
+/**
+ * Stores the partition table and the number of data fragments of @layout in
+ * the extension record of component catalogue @cfid.
+ */
+static int ctidx_ext_put(const struct m0_fid        *cfid,
+			 const struct m0_dix_layout *layout,
+			 struct m0_be_tx            *tx)
+{
+	const struct m0_dix_ranges *ranges = &layout->u.dl_desc.ld_ranges;
+	struct m0_be_seg           *seg    = cas_seg(tx->t_engine->eng_domain);
+	struct ctidx_layout         ext;
+	struct m0_fid               efid;
+	struct m0_dix_range        *part;
+	struct m0_buf              *start;
+	uint32_t                    i;
+
+	M0_SET0(&ext);
+	ext.cl_type = CTIDX_LTYPE_EXT;
+	ext.u.cl_ext.ce_ec_data = layout->u.dl_desc.ld_ec_data;
+	if (ranges->dr_nr != 0) {
+		/** @todo Make it asynchronous. */
+		M0_BE_ALLOC_ARR_SYNC(part, ranges->dr_nr, seg, tx);
+		for (i = 0; i < ranges->dr_nr; i++) {
+			part[i] = ranges->dr_part[i];
+			start = &part[i].dr_start;
+			if (start->b_nob == 0)
+				continue;
+			M0_BE_ALLOC_BUF_SYNC(start, seg, tx);
+			memcpy(start->b_addr, ranges->dr_part[i].dr_start.b_addr,
+			       start->b_nob);
+			m0_be_tx_capture(tx, &M0_BE_REG(seg, start->b_nob,
+							start->b_addr));
+		}
+		m0_be_tx_capture(tx, &M0_BE_REG(seg, ranges->dr_nr *
+						sizeof part[0], part));
+		ext.u.cl_ext.ce_ranges.dr_nr   = ranges->dr_nr;
+		ext.u.cl_ext.ce_ranges.dr_part = part;
+	}
+	ctidx_ext_fid(&efid, cfid);
+	return ctidx_put(&efid, &ext, tx);
+}
 
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-				      m0_btree_get(ctidx->cc_tree, &rec.r_key,
-						   &get_cb, BOF_EQUAL, &kv_op));
+/**
+ * Fills the partition table and the number of data fragments of @layout
+ * from the extension record of component catalogue @cfid. The partition
+ * table stays in BE segment.
+ */
+static int ctidx_ext_get(const struct m0_fid  *cfid,
+			 struct m0_dix_layout *layout)
+{
+	struct ctidx_layout ext;
+	struct m0_fid       efid;
+	int                 rc;
 
+	ctidx_ext_fid(&efid, cfid);
+	rc = ctidx_get(&efid, &ext);
+	if (rc == -ENOENT)
+		/* The layout has neither partitions nor EC values. */
+		return M0_RC(0);
+	if (rc == 0 && ext.cl_type != CTIDX_LTYPE_EXT)
+		rc = M0_ERR(-EPROTO);
+	if (rc == 0) {
+		layout->u.dl_desc.ld_ec_data = ext.u.cl_ext.ce_ec_data;
+		layout->u.dl_desc.ld_ranges  = ext.u.cl_ext.ce_ranges;
+	}
 	return M0_RC(rc);
 }
 
-struct ctg_ctidx_put_cb_data {
-	const struct m0_cas_id *d_cid;
-	struct m0_be_tx        *d_tx;
-};
+static int ctidx_ext_del(const struct m0_fid *cfid, struct m0_be_tx *tx)
+{
+	struct m0_be_seg     *seg = cas_seg(tx->t_engine->eng_domain);
+	struct ctidx_layout   ext;
+	struct m0_dix_ranges *ranges;
+	struct m0_fid         efid;
+	uint32_t              i;
+	int                   rc;
+
+	ctidx_ext_fid(&efid, cfid);
+	rc = ctidx_get(&efid, &ext);
+	if (rc == -ENOENT)
+		return M0_RC(0);
+	if (rc != 0)
+		return M0_ERR(rc);
+	ranges = &ext.u.cl_ext.ce_ranges;
+	if (ranges->dr_nr != 0) {
+		/** @todo Make it asynchronous. */
+		for (i = 0; i < ranges->dr_nr; i++)
+			if (ranges->dr_part[i].dr_start.b_nob != 0)
+				M0_BE_FREE_PTR_SYNC(
+					ranges->dr_part[i].dr_start.b_addr,
+					seg, tx);
+		M0_BE_FREE_PTR_SYNC(ranges->dr_part, seg, tx);
+	}
+	return ctidx_del(&efid, tx);
+}
 
-static int ctg_ctidx_put_cb(struct m0_btree_cb *cb, struct m0_btree_rec *rec)
+M0_INTERNAL int m0_ctg_ctidx_lookup_sync(const struct m0_fid  *fid,
+					 struct m0_dix_layout *layout)
 {
-	struct ctg_ctidx_put_cb_data *datum      = cb->c_datum;
-	const struct m0_cas_id       *cid        = datum->d_cid;
-	struct m0_be_tx              *tx         = datum->d_tx;
-	struct fid_key                key_data   = FID_KEY_INIT(&cid->ci_fid);
-	struct layout_value           value_data =
-		LAYOUT_VALUE_INIT(&cid->ci_layout);
-	struct m0_dix_layout         *layout;
-	struct m0_ext                *im_range;
-	const struct m0_dix_imask    *imask;
-	m0_bcount_t                   size;
+	struct ctidx_layout stored;
+	int                 rc;
 
-	/* Copy key in btree */
-	M0_ASSERT(m0_vec_count(&rec->r_key.k_data.ov_vec) == sizeof key_data);
-	m0_memmove(rec->r_key.k_data.ov_buf[0], &key_data, sizeof key_data);
+	M0_PRE(fid != NULL);
+	M0_PRE(layout != NULL);
 
-	/* Copy value in btree */
-	M0_ASSERT(m0_vec_count(&rec->r_val.ov_vec) == sizeof value_data);
-	m0_memmove(rec->r_val.ov_buf[0], &value_data, sizeof value_data);
+	if (m0_ctg_ctidx() == NULL)
+		return M0_ERR(-EFAULT);
 
-	layout = &((struct layout_value *)
-			   (rec->r_val.ov_buf[0]))->lv_layout;
-	imask = &cid->ci_layout.u.dl_desc.ld_imask;
+	rc = ctidx_get(fid, &stored);
+	if (rc == 0) {
+		ctidx_layout_unpack(layout, &stored);
+		if (layout->dl_type == DIX_LTYPE_DESCR)
+			rc = ctidx_ext_get(fid, layout);
+	}
+	return M0_RC(rc);
+}
+
+M0_INTERNAL int m0_ctg_ctidx_insert_sync(const struct m0_cas_id *cid,
+					 struct m0_be_tx        *tx)
+{
+	const struct m0_dix_imask *imask = &cid->ci_layout.u.dl_desc.ld_imask;
+	struct m0_be_seg          *seg   = cas_seg(tx->t_engine->eng_domain);
+	struct m0_cas_ctg         *ctidx = m0_ctg_ctidx();
+	struct ctidx_layout        stored;
+	struct m0_ext             *im_range;
+	m0_bcount_t                size;
+	int                        rc;
+
+	ctidx_layout_pack(&stored, &cid->ci_layout);
 	if (!m0_dix_imask_is_empty(imask)) {
 		/*
 		* Alloc memory in BE segment for imask ranges
 		* and copy them.
 		*/
 		/** @todo Make it asynchronous. */
-		M0_BE_ALLOC_ARR_SYNC(im_range, imask->im_nr,
-				     cas_seg(tx->t_engine->eng_domain), tx);
+		M0_BE_ALLOC_ARR_SYNC(im_range, imask->im_nr, seg, tx);
 		size = imask->im_nr * sizeof(struct m0_ext);
 		memcpy(im_range, imask->im_range, size);
-		m0_be_tx_capture(tx, &M0_BE_REG(
-					cas_seg(tx->t_engine->eng_domain),
-					size, im_range));
+		m0_be_tx_capture(tx, &M0_BE_REG(seg, size, im_range));
 		/* Assign newly allocated imask ranges. */
-		layout->u.dl_desc.ld_imask.im_range = im_range;
+		stored.u.cl_desc.cl_imask.im_range = im_range;
 	}
-
-	return 0;
-}
-M0_INTERNAL int m0_ctg_ctidx_insert_sync(const struct m0_cas_id *cid,
-					 struct m0_be_tx        *tx)
-{
 	/* The key is a component catalogue FID. */
-	int                          rc;
-	struct fid_key               key_data   = FID_KEY_INIT(&cid->ci_fid);
-	struct m0_buf                key        = M0_BUF_INIT_PTR(&key_data);
-	struct layout_value          value_data =
-		LAYOUT_VALUE_INIT(&cid->ci_layout);
-	struct m0_buf                value      = M0_BUF_INIT_PTR(&value_data);
-	struct m0_cas_ctg           *ctidx      = m0_ctg_ctidx();
-	struct m0_btree_op           kv_op      = {};
-	struct m0_btree_rec          rec        = {
-		.r_key.k_data = M0_BUFVEC_INIT_BUF(&key.b_addr, &key.b_nob),
-		.r_val        = M0_BUFVEC_INIT_BUF(&value.b_addr, &value.b_nob),
-		.r_crc_type   = M0_BCT_NO_CRC,
-	};
-	struct ctg_ctidx_put_cb_data cb_data    = {
-		.d_cid = cid,
-		.d_tx  = tx,
-		};
-	struct m0_btree_cb            put_cb    = {
-		.c_act   = ctg_ctidx_put_cb,
-		.c_datum = &cb_data,
-		};
-
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
-				      m0_btree_put(ctidx->cc_tree, &rec,
-						   &put_cb, &kv_op, tx));
+	rc = ctidx_put(&cid->ci_fid, &stored, tx);
+	if (rc == 0 && ctidx_layout_has_ext(&cid->ci_layout))
+		rc = ctidx_ext_put(&cid->ci_fid, &cid->ci_layout, tx);
 	M0_ASSERT(rc == 0);
 	m0_chan_broadcast_lock(&ctidx->cc_chan.bch_chan);
 	return M0_RC(rc);
@@ -2315,43 +3446,68 @@ M0_INTERNAL int m0_ctg_ctidx_insert_sync(const struct m0_cas_id *cid,
 M0_INTERNAL int m0_ctg_ctidx_delete_sync(const struct m0_cas_id *cid,
 					 struct m0_be_tx        *tx)
 {
-	struct m0_dix_layout *layout;
+	struct m0_dix_layout  layout;
 	struct m0_dix_imask  *imask;
+	struct m0_cas_ctg    *ctidx = m0_ctg_ctidx();
 	int                   rc;
-	/* The key is a component catalogue FID. */
-	struct fid_key        key_data = FID_KEY_INIT(&cid->ci_fid);
-	struct m0_buf         key      = M0_BUF_INIT_PTR(&key_data);
-	struct m0_cas_ctg    *ctidx    = m0_ctg_ctidx();
-	struct m0_btree_op    kv_op  = {};
-	struct m0_btree_key   r_key  = {
-		.k_data  = M0_BUFVEC_INIT_BUF(&key.b_addr, &key.b_nob),
-	};
 
 	/* Firstly we should free buffer allocated for imask ranges array. */
 	rc = m0_ctg_ctidx_lookup_sync(&cid->ci_fid, &layout);
 	if (rc != 0)
 		return M0_ERR(rc);
 
-	imask = &layout->u.dl_desc.ld_imask;
+	imask = &layout.u.dl_desc.ld_imask;
 	if (!m0_dix_imask_is_empty(imask)) {
 		/** @todo Make it asynchronous. */
 		M0_BE_FREE_PTR_SYNC(imask->im_range,
 				    cas_seg(tx->t_engine->eng_domain),
 				    tx);
-		imask->im_range = NULL;
-		imask->im_nr = 0;
 	}
-
-	/** @todo Make it asynchronous. */
-	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op, m0_btree_del(ctidx->cc_tree,
-							   &r_key, NULL,
-							   &kv_op, tx));
-
+	/* The key is a component catalogue FID. */
+	rc = ctidx_ext_del(&cid->ci_fid, tx) ?:
+	     ctidx_del(&cid->ci_fid, tx);
 	M0_ASSERT(rc == 0);
 	m0_chan_broadcast_lock(&ctidx->cc_chan.bch_chan);
 	return rc == 0 ? rc : M0_ERR(rc);
 }
 
+/**
+ * Puts the m0_dix_layout value of @ctg_op into ctidx, converting it into
+ * the stored format.
+ */
+static int ctg_ctidx_op_put(struct m0_ctg_op *ctg_op, struct m0_be_tx *tx)
+{
+	struct fid_key             *fk     = ctg_op->co_key.b_addr;
+	const struct m0_dix_layout *layout = ctg_op->co_val.b_addr;
+	struct ctidx_layout         stored;
+	int                         rc;
+
+	if (ctg_op->co_val.b_nob != sizeof *layout)
+		return M0_ERR(-EPROTO);
+	ctidx_layout_pack(&stored, layout);
+	rc = ctidx_put(&fk->fk_fid, &stored, tx);
+	if (rc == 0 && ctidx_layout_has_ext(layout))
+		rc = ctidx_ext_put(&fk->fk_fid, layout, tx);
+	if (rc == 0)
+		m0_chan_broadcast_lock(&ctg_op->co_ctg->cc_chan.bch_chan);
+	return M0_RC(rc);
+}
+
+/**
+ * Looks up the layout of a component catalogue in ctidx. The result is
+ * returned in m0_ctg_op::co_layout.
+ */
+static int ctg_ctidx_op_get(struct m0_ctg_op *ctg_op)
+{
+	struct fid_key *fk = ctg_op->co_key.b_addr;
+	int             rc;
+
+	rc = m0_ctg_ctidx_lookup_sync(&fk->fk_fid, &ctg_op->co_layout);
+	if (rc == 0)
+		ctg_op->co_out_val = M0_BUF_INIT_PTR(&ctg_op->co_layout);
+	return rc;
+}
+
 M0_INTERNAL int m0_ctg_mem_place(struct m0_ctg_op    *ctg_op,
 				 const struct m0_buf *buf,
 				 int                  next_phase)
@@ -2477,7 +3633,7 @@ M0_INTERNAL int ctg_index_btree_dump(struct m0_motr *motr_ctx,
 	struct m0_btree_cursor  cursor;
 	int                     rc;
 
-	ctg_open(ctg, cas_seg(&motr_ctx->cc_reqh_ctx.rc_be.but_dom));
+	ctg_open(ctg, cas_seg(&motr_ctx->cc_reqh_ctx.rc_be.but_dom), CTT_CTG);
 
 	m0_btree_cursor_init(&cursor, ctg->cc_tree);
 	for (rc = m0_btree_cursor_first(&cursor); rc == 0;
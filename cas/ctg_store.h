@@ -127,6 +127,9 @@ enum cas_tree_type {
 	 */
 	CTT_CTIDX,
 };
+
+struct m0_ctg_filter;
+
 /** CAS catalogue. */
 struct m0_cas_ctg {
 	struct m0_format_header cc_head;
@@ -149,6 +152,16 @@ struct m0_cas_ctg {
 	 * meta.
 	 */
 	bool                    cc_inited;
+	/**
+	 * Volatile filter of catalogue keys answering lookups of missing keys,
+	 * see m0_ctg_filter_enable().
+	 */
+	struct m0_ctg_filter   *cc_filter;
+	/**
+	 * Whether the catalogue is volatile, i.e. kept in memory only and not
+	 * present in meta, see ::COF_VOLATILE.
+	 */
+	bool                    cc_volatile;
 } M0_XCA_RECORD M0_XCA_DOMAIN(be);
 
 enum m0_cas_ctg_format_version {
@@ -251,6 +264,8 @@ struct m0_ctg_op {
 	struct m0_buf             co_out_key;
 	/** Value out buffer. */
 	struct m0_buf             co_out_val;
+	/** Layout looked up in ctidx, co_out_val points to it. */
+	struct m0_dix_layout      co_layout;
 	/* Version of the co_out_val+co_out_key record. */
 	struct m0_crv             co_out_ver;
 	struct m0_buf             co_mem_buf;
@@ -262,6 +277,8 @@ struct m0_ctg_op {
 	uint32_t                  co_flags;
 	/** Operation result code. */
 	int                       co_rc;
+	/** Cursor position in a volatile catalogue, see ::COF_VOLATILE. */
+	uint64_t                  co_vol_pos;
 	/**
 	 * Maximum number of records (limit) allowed to be deleted in CO_TRUNC
 	 * operation, see m0_ctg_truncate().
@@ -693,6 +710,10 @@ M0_INTERNAL void m0_ctg_ctidx_insert_credits(struct m0_cas_id       *cid,
  * 'accum' contains credits that are necessary to delete 'limit' number of
  * records. 'limit' is a maximum number of records that can be deleted in one BE
  * transaction.
+ *
+ * If '*limit' is not 0 on entry, it caps the number of btree nodes freed in
+ * one transaction, so that callers can keep transactions smaller than BE
+ * allows.
  */
 M0_INTERNAL void m0_ctg_drop_credit(struct m0_fom          *fom,
 				    struct m0_be_tx_credit *accum,
@@ -761,12 +782,13 @@ M0_INTERNAL int m0_ctg_ctidx_delete_sync(const struct m0_cas_id *cid,
  *
  * @param[in]  fid    FID of component catalogue.
  * @param[out] layout Layout of index which component catalogue with FID @fid
- *                    belongs to.
+ *                    belongs to. Imask ranges and partitions of the layout
+ *                    point into BE segment.
  *
  * @ret 0 on success or negative error code.
  */
-M0_INTERNAL int m0_ctg_ctidx_lookup_sync(const struct m0_fid   *fid,
-					 struct m0_dix_layout **layout);
+M0_INTERNAL int m0_ctg_ctidx_lookup_sync(const struct m0_fid  *fid,
+					 struct m0_dix_layout *layout);
 
 M0_INTERNAL int  m0_ctg_mem_place(struct m0_ctg_op    *ctg_op,
 				  const struct m0_buf *buf,
@@ -787,6 +809,41 @@ M0_INTERNAL uint64_t m0_ctg_rec_nr(void);
  */
 M0_INTERNAL uint64_t m0_ctg_rec_size(void);
 
+/**
+ * Enables or disables in-memory filters of keys of ordinary catalogues.
+ *
+ * When enabled, the filter of a catalogue is built on the first lookup in the
+ * catalogue and lookups of most missing keys are answered without the btree
+ * descent. Filters are disabled by default.
+ */
+M0_INTERNAL void m0_ctg_filter_enable(bool enable);
+
+/** Number of lookups answered by key filters, since the process has started. */
+M0_INTERNAL uint64_t m0_ctg_filter_neg_nr(void);
+
+/**
+ * Returns the btree node size for a catalogue with records of kv_size bytes
+ * (key and value, without CAS headers): the smallest power of 2 between the
+ * page size and M0_CTG_ROOT_NODE_SIZE, large enough for a few dozens of such
+ * records.
+ */
+M0_INTERNAL int m0_ctg_node_size(m0_bcount_t kv_size);
+
+/**
+ * Enables or disables the adaptive node size of new ordinary catalogues.
+ *
+ * By default all the catalogues have M0_CTG_ROOT_NODE_SIZE nodes. When the
+ * adaptive node size is enabled, catalogues created from now on get nodes of
+ * m0_ctg_node_size() for the declared kv_size or, if kv_size is 0, for the
+ * average size of the records in the catalogue store. Small-record catalogues
+ * then occupy less BE space per node, big-record ones are split less often.
+ *
+ * An existing catalogue keeps its node size. Records a lot bigger than the
+ * declared or average size may not fit into the nodes of a catalogue created
+ * for small records, so kv_size should be the maximal expected record size.
+ */
+M0_INTERNAL void m0_ctg_node_size_adaptive(bool enable, m0_bcount_t kv_size);
+
 /**
  * Returns a reference to the catalogue store "delete" long lock.
  *
@@ -839,6 +896,116 @@ M0_INTERNAL int m0_ctg_meta_find_ctg(struct m0_cas_ctg    *meta,
 			             const struct m0_fid  *ctg_fid,
 			             struct m0_cas_ctg   **ctg);
 
+/**
+ * Finds the first ordinary catalogue with fid not less than "from" (greater
+ * than "from" if "exclude" is set) in meta catalogue synchronously.
+ *
+ * @retval -ENOENT there are no such catalogues.
+ */
+M0_INTERNAL int m0_ctg_meta_next_ctg(const struct m0_fid  *from,
+				     bool                  exclude,
+				     struct m0_fid        *fid,
+				     struct m0_cas_ctg   **ctg);
+
+/** A tombstone found by m0_ctg_tbs_scan(). */
+struct m0_ctg_tbs {
+	/** On-disk key of the record, a copy owned by the caller. */
+	struct m0_buf ct_key;
+	/** Size of the on-disk value of the record. */
+	m0_bcount_t   ct_vnob;
+	/** Version of the tombstone. */
+	struct m0_crv ct_ver;
+};
+
+/**
+ * Collects tombstones of a versioned catalogue that are older than the
+ * horizon, synchronously.
+ *
+ * Scanning starts from the on-disk key "from" (inclusive), or from the first
+ * record if "from" is empty. At most "scan_max" records are examined and at
+ * most "*nr" tombstones are returned in "tbs". On return "*nr" is the number
+ * of collected tombstones and "from" is replaced with a copy of the next key
+ * to examine, or emptied if the end of catalogue is reached ("*eot").
+ *
+ * Only the btree short-term locks are taken: the records are re-checked by
+ * m0_ctg_tbs_del() under catalogue lock.
+ */
+M0_INTERNAL int m0_ctg_tbs_scan(struct m0_cas_ctg       *ctg,
+				struct m0_buf           *from,
+				const struct m0_dtm0_ts *horizon,
+				struct m0_ctg_tbs       *tbs,
+				uint32_t                *nr,
+				uint32_t                 scan_max,
+				bool                    *eot);
+
+/** Calculates credits for m0_ctg_tbs_del() of a tombstone. */
+M0_INTERNAL void m0_ctg_tbs_del_credit(struct m0_cas_ctg       *ctg,
+				       const struct m0_ctg_tbs *tbs,
+				       struct m0_be_tx_credit  *accum);
+
+/**
+ * Removes the tombstone from the catalogue synchronously, if the record still
+ * has the same version.
+ *
+ * @pre Catalogue is write-locked by the caller.
+ * @retval -EEXIST the record was overwritten after m0_ctg_tbs_scan().
+ * @retval -ENOENT the record is gone.
+ */
+M0_INTERNAL int m0_ctg_tbs_del(struct m0_cas_ctg       *ctg,
+			       struct m0_be_tx         *tx,
+			       const struct m0_ctg_tbs *tbs);
+
+/**
+ * Creates a volatile catalogue, see ::COF_VOLATILE.
+ *
+ * The catalogue is kept in memory only: it is not inserted into meta, its
+ * records are never captured in BE transactions and are lost on process
+ * restart, as is the catalogue itself. Volatile catalogue is found by
+ * m0_ctg_meta_lookup() and is handled by the rest of catalogue operations as
+ * an ordinary one. Layout of a component catalogue is kept along with the
+ * catalogue instead of catalogue-index, see m0_ctg_vol_layout_check().
+ *
+ * Records are kept in a sorted array, lookups are logarithmic, inserts and
+ * deletes are linear in the number of records. Concurrent access is
+ * serialised by the catalogue lock (m0_ctg_lock()) as for BE catalogues. The
+ * catalogue is created and destroyed under the write lock of meta.
+ *
+ * @retval -EEXIST volatile or BE catalogue with this fid exists.
+ */
+M0_INTERNAL int m0_ctg_vol_insert(struct m0_ctg_op       *ctg_op,
+				  const struct m0_cas_id *cid,
+				  int                     next_phase);
+
+/** Checks whether the catalogue is volatile. */
+M0_INTERNAL bool m0_ctg_is_volatile(const struct m0_cas_ctg *ctg);
+
+/** Checks whether there is a volatile catalogue with the given fid. */
+M0_INTERNAL bool m0_ctg_vol_exists(const struct m0_fid *fid);
+
+/**
+ * Matches the layout of a component catalogue against the layout stored with
+ * the volatile catalogue at creation.
+ *
+ * @retval -ENOENT there is no volatile catalogue with cid->ci_fid.
+ * @retval -EKEYEXPIRED layouts do not match.
+ */
+M0_INTERNAL int m0_ctg_vol_layout_check(const struct m0_cas_id *cid);
+
+/**
+ * Removes the volatile catalogue from the set of volatile catalogues, so it
+ * is not found by meta lookups anymore. The catalogue stays valid until
+ * m0_ctg_vol_destroy().
+ */
+M0_INTERNAL void m0_ctg_vol_forget(struct m0_cas_ctg *ctg);
+
+/**
+ * Frees the volatile catalogue removed by m0_ctg_vol_forget() along with its
+ * records.
+ *
+ * @pre The catalogue is not used by anyone.
+ */
+M0_INTERNAL void m0_ctg_vol_destroy(struct m0_cas_ctg *ctg);
+
 /** Get btree ops for ctg tree. */
 M0_INTERNAL const struct m0_btree_rec_key_op *m0_ctg_btree_ops(void);
 
@@ -26,12 +26,14 @@
 #include "lib/memory.h"
 #include "lib/assert.h"
 #include "lib/cond.h"          /* m0_cond */
+#include "lib/time.h"          /* m0_time_now */
 #include "fop/fop.h"           /* M0_FOP_TYPE_INIT */
 #include "fop/fom_long_lock.h"
 #include "fop/fom_generic.h"
 #include "rpc/rpc_opcodes.h"
 #include "rpc/item.h"          /* M0_RPC_ITEM_TYPE_REQUEST */
 #include "cas/ctg_store.h"
+#include "cas/index_gc.h"
 #include "motr/setup.h"
 
 /**
@@ -87,6 +89,17 @@
  *                          V
  *                       SUCCESS
  * @endverbatim
+ *
+ * @subsection cgc-rate Rate of garbage collection
+ *
+ * m0_btree_truncate() frees whole btree nodes, so the cost of a transaction
+ * depends on the number of nodes, not records. A transaction frees at most
+ * gc.cgc_nodes_per_tx nodes, which is much less than BE allows. When a
+ * catalogue is not empty after a transaction, the next fom waits for
+ * gc.cgc_delay in CGC_LOOKUP before taking the next chunk. This way a big
+ * catalogue is destroyed in the background, leaving the BE log and locality 0
+ * to the user requests. Both values are set by m0_cas_gc_rate_set() (m0d
+ * options -1 and -2), progress is reported by m0_cas_gc_stats_get().
  */
 
 
@@ -95,6 +108,15 @@ static size_t cgc_fom_home_locality (const struct m0_fom *fom);
 static int    cgc_fom_tick          (struct m0_fom *fom);
 static void   cgc_fom_fini          (struct m0_fom *fom);
 static void   cgc_retry             (void);
+static void   cgc_stats_update      (uint64_t txs, uint64_t nodes,
+				     uint64_t ctgs, m0_time_t paused);
+
+enum {
+	/** Default maximum number of btree nodes freed in a transaction. */
+	CGC_NODES_PER_TX = 256,
+	/** Default delay between transactions of the same catalogue. */
+	CGC_DELAY        = 10 * M0_TIME_ONE_MSEC
+};
 
 enum cgc_fom_phase {
 	CGC_TREE_CLEAN = M0_FOPH_TYPE_SPECIFIC,
@@ -119,6 +141,12 @@ struct cgc_fom {
 	struct m0_buf              cg_ctg_key;
 	struct m0_reqh            *cg_reqh;
 	m0_bcount_t                cg_del_limit;
+	/** Catalogue was not emptied by the previous transaction. */
+	bool                       cg_pace;
+	/** True while cg_timeout is armed. */
+	bool                       cg_pace_wait;
+	m0_time_t                  cg_pace_start;
+	struct m0_fom_timeout      cg_timeout;
 };
 
 struct cgc_context {
@@ -127,6 +155,10 @@ struct cgc_context {
 	int              cgc_running;
 	bool             cgc_waiting;
 	struct m0_be_op *cgc_op;
+	m0_bcount_t      cgc_nodes_per_tx;
+	m0_time_t        cgc_delay;
+	/** Protected by cgc_mutex. */
+	struct m0_cas_gc_stats cgc_stats;
 };
 
 static struct cgc_context gc;
@@ -269,6 +301,27 @@ static int cgc_fom_tick(struct m0_fom *fom0)
 			m0_fom_phase_set(fom0, M0_FOPH_TXN_LOGGED_WAIT);
 		break;
 	case CGC_LOOKUP:
+		if (fom->cg_pace_wait) {
+			m0_fom_timeout_fini(&fom->cg_timeout);
+			fom->cg_pace_wait = false;
+			cgc_stats_update(0, 0, 0, m0_time_now() -
+					 fom->cg_pace_start);
+		}
+		if (fom->cg_pace) {
+			/*
+			 * Let the previous transaction reach the log and other
+			 * foms use the locality before the next chunk.
+			 */
+			fom->cg_pace = false;
+			fom->cg_pace_wait = true;
+			fom->cg_pace_start = m0_time_now();
+			m0_fom_timeout_init(&fom->cg_timeout);
+			m0_fom_timeout_wait_on(&fom->cg_timeout, fom0,
+					       m0_time_add(fom->cg_pace_start,
+							   gc.cgc_delay));
+			result = M0_FSO_WAIT;
+			break;
+		}
 		m0_ctg_op_init(ctg_op, fom0, 0);
 		fom->cg_ctg_op_initialized = true;
 		/*
@@ -331,6 +384,7 @@ static int cgc_fom_tick(struct m0_fom *fom0)
 		 * its open in the generic fom.
 		 */
 		m0_ctg_dead_clean_credit(&fom0->fo_tx.tx_betx_cred);
+		fom->cg_del_limit = gc.cgc_nodes_per_tx;
 		m0_ctg_drop_credit(fom0, &fom0->fo_tx.tx_betx_cred,
 				   fom->cg_ctg, &fom->cg_del_limit);
 		m0_fom_phase_set(fom0, M0_FOPH_TXN_OPEN);
@@ -355,6 +409,7 @@ static int cgc_fom_tick(struct m0_fom *fom0)
 		rc = m0_ctg_op_rc(ctg_op);
 		m0_ctg_op_fini(ctg_op);
 		fom->cg_ctg_op_initialized = false;
+		cgc_stats_update(1, fom->cg_del_limit, 0, 0);
 		if (rc == 0 && m0_btree_is_empty(fom->cg_ctg->cc_tree)) {
 			M0_LOG(M0_DEBUG, "tree cleaned, now drop it");
 			m0_ctg_op_init(ctg_op, fom0, 0);
@@ -366,6 +421,7 @@ static int cgc_fom_tick(struct m0_fom *fom0)
 			m0_long_unlock(m0_ctg_lock(m0_ctg_dead_index()),
 			       &fom->cg_dead_index);
 			cgc_retry();
+			fom->cg_pace = true;
 			/*
 			 * If out of credits. Commit transaction and
 			 * start from the very beginning, by creating
@@ -401,6 +457,7 @@ static int cgc_fom_tick(struct m0_fom *fom0)
 			       &fom->cg_dead_index);
 		m0_ctg_op_fini(ctg_op);
 		fom->cg_ctg_op_initialized = false;
+		cgc_stats_update(0, 0, 1, 0);
 		/*
 		 * Retry: maybe, have more trees to drop.
 		 */
@@ -414,6 +471,17 @@ static int cgc_fom_tick(struct m0_fom *fom0)
 	return M0_RC(result);
 }
 
+static void cgc_stats_update(uint64_t txs, uint64_t nodes, uint64_t ctgs,
+			     m0_time_t paused)
+{
+	m0_mutex_lock(&gc.cgc_mutex);
+	gc.cgc_stats.gs_txs    += txs;
+	gc.cgc_stats.gs_nodes  += nodes;
+	gc.cgc_stats.gs_ctgs   += ctgs;
+	gc.cgc_stats.gs_paused += paused;
+	m0_mutex_unlock(&gc.cgc_mutex);
+}
+
 static void cgc_retry(void)
 {
 	/*
@@ -437,6 +505,8 @@ M0_INTERNAL void m0_cas_gc_init(void)
 	m0_mutex_init(&gc.cgc_mutex);
 	m0_cond_init(&gc.cgc_cond, &gc.cgc_mutex);
 	gc.cgc_running = 0;
+	M0_SET0(&gc.cgc_stats);
+	m0_cas_gc_rate_set(0, 0);
 
 	/*
 	 * Actually we do not need a fop. But generic fom wants it, and it must
@@ -616,6 +686,21 @@ M0_INTERNAL void m0_cas_gc_wait_async(struct m0_be_op *beop)
 	M0_LEAVE();
 }
 
+M0_INTERNAL void m0_cas_gc_rate_set(m0_bcount_t nodes_per_tx, m0_time_t delay)
+{
+	m0_mutex_lock(&gc.cgc_mutex);
+	gc.cgc_nodes_per_tx = nodes_per_tx ?: CGC_NODES_PER_TX;
+	gc.cgc_delay        = delay ?: CGC_DELAY;
+	m0_mutex_unlock(&gc.cgc_mutex);
+}
+
+M0_INTERNAL void m0_cas_gc_stats_get(struct m0_cas_gc_stats *stats)
+{
+	m0_mutex_lock(&gc.cgc_mutex);
+	*stats = gc.cgc_stats;
+	m0_mutex_unlock(&gc.cgc_mutex);
+}
+
 #undef M0_TRACE_SUBSYSTEM
 
 /*
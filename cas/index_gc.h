@@ -25,10 +25,32 @@
 #ifndef __MOTR_CAS_INDEX_GC_H__
 #define __MOTR_CAS_INDEX_GC_H__
 
+#include "lib/types.h"
+#include "lib/time.h"          /* m0_time_t */
+
 /* Import */
 struct m0_reqh;
 struct m0_be_op;
 
+/**
+ * Progress of index garbage collector since m0_cas_gc_init().
+ *
+ * @see m0_cas_gc_stats_get()
+ */
+struct m0_cas_gc_stats {
+	/** Number of BE transactions used to destroy catalogues. */
+	uint64_t  gs_txs;
+	/**
+	 * Number of btree nodes the transactions were able to free. This is an
+	 * upper bound of the number of freed nodes.
+	 */
+	uint64_t  gs_nodes;
+	/** Number of destroyed catalogues. */
+	uint64_t  gs_ctgs;
+	/** Time garbage collector waited between transactions. */
+	m0_time_t gs_paused;
+};
+
 /** Initialises index garbage collector. */
 M0_INTERNAL void m0_cas_gc_init(void);
 
@@ -63,6 +85,21 @@ M0_INTERNAL void m0_cas_gc_wait_async(struct m0_be_op *beop);
  */
 M0_INTERNAL void m0_cas_gc_wait_sync(void);
 
+/**
+ * Sets the rate of index garbage collection.
+ *
+ * A catalogue is destroyed by a sequence of transactions, each freeing at most
+ * 'nodes_per_tx' btree nodes. Garbage collector waits for 'delay' before
+ * starting the next transaction of the same catalogue, so that destruction of
+ * a big catalogue doesn't take the whole BE log and locality 0.
+ *
+ * 0 stands for the default value of a parameter.
+ */
+M0_INTERNAL void m0_cas_gc_rate_set(m0_bcount_t nodes_per_tx, m0_time_t delay);
+
+/** Returns the progress of garbage collector. */
+M0_INTERNAL void m0_cas_gc_stats_get(struct m0_cas_gc_stats *stats);
+
 #endif /* __MOTR_CAS_INDEX_GC_H__ */
 
 /*
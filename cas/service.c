@@ -28,6 +28,7 @@
 #include "dtm0/service.h"            /* m0_dtm0_service API */
 #include "lib/trace.h"
 #include "lib/memory.h"
+#include "lib/objcache.h"            /* m0_objcache */
 #include "lib/finject.h"
 #include "lib/assert.h"
 #include "lib/arith.h"               /* min_check, M0_3WAY */
@@ -54,6 +55,7 @@
 #include "cas/cas.h"
 #include "cas/cas_xc.h"
 #include "cas/index_gc.h"
+#include "cas/compact.h"
 #include "motr/setup.h"              /* m0_reqh_context */
 
 /**
@@ -142,6 +144,10 @@
  *   single FOP. Bulk RPC transmission should be used in this case (not
  *   implemented yet).
  * - Per-FOM BE transaction is used to perform modifications of index B-trees.
+ *   A multi-catalogue CAS-PUT or CAS-DEL (m0_cas_op::cg_ctgs) modifies
+ *   several catalogues in the same transaction. Such a FOM loops over
+ *   CAS_CHECK_PRE/CAS_CHECK, CAS_META_LOOKUP/CAS_META_LOOKUP_DONE and CAS_LOCK
+ *   once per catalogue and keeps all of them write-locked till the end.
  * - B-tree for meta-index is stored in zero BE segment of motr global BE
  *   domain. Other B-trees are stored in BE segment of the request handler.
  *
@@ -330,6 +336,15 @@ struct cas_kv {
 	struct m0_buf ckv_val;
 };
 
+/**
+ * Catalogue of a multi-catalogue operation, see m0_cas_op::cg_ctgs.
+ */
+struct cas_mctg {
+	struct m0_cas_ctg        *mc_ctg;
+	struct m0_long_lock_link  mc_lock;
+	struct m0_long_lock_addb2 mc_lock_addb2;
+};
+
 struct cas_fom {
 	struct m0_fom             cf_fom;
 	uint64_t                  cf_ipos;
@@ -348,6 +363,23 @@ struct cas_fom {
 	bool                      cf_op_checked;
 	uint64_t                  cf_curpos;
 	bool                      cf_startkey_excluded;
+	/**
+	 * Number of records of the current NEXT iteration dropped by
+	 * m0_cas_op::cg_filter.
+	 */
+	uint64_t                  cf_filtered;
+	/** The filter ended the current NEXT iteration. */
+	bool                      cf_filter_eof;
+	/**
+	 * Size of the common prefix the current record is rolled up to by
+	 * ::COF_DELIMITER, 0 if the record is sent as is.
+	 */
+	m0_bcount_t               cf_rollup_nob;
+	/**
+	 * Key the cursor is moved to after a rolled up common prefix, to skip
+	 * the records under it.
+	 */
+	struct m0_buf             cf_seek;
 	/**
 	 * Key/value pairs from incoming FOP.
 	 * They are loaded once from incoming RPC AT buffers
@@ -368,6 +400,28 @@ struct cas_fom {
 	 * Index descriptors for dropped indices (moved to dead_index).
 	 */
 	struct m0_cas_ctg       **cf_moved_ctgs;
+	/**
+	 * Catalogues of a multi-catalogue operation, in the order of
+	 * m0_cas_op::cg_ctgs. ->cf_ctg is not used by such an operation.
+	 */
+	struct cas_mctg          *cf_mctg;
+	/** ->cf_mctg array size. */
+	uint64_t                  cf_mctg_nr;
+	/**
+	 * Position in ->cf_mctg of the catalogue being checked, looked up or
+	 * locked.
+	 */
+	uint64_t                  cf_mpos;
+	/**
+	 * The operation addresses volatile catalogues only and is executed
+	 * without BE transaction, see ::COF_VOLATILE.
+	 */
+	bool                      cf_volatile;
+	/**
+	 * Layout of the component catalogue is looked up in catalogue-index
+	 * in CAS_CHECK_PRE, i.e. the catalogue is not volatile.
+	 */
+	bool                      cf_ctidx_lookup;
 	struct m0_fom_thralldom   cf_thrall;
 	int                       cf_thrall_rc;
 	/* ADDB2 structures to collect long-lock contention metrics. */
@@ -492,6 +546,18 @@ static int  cas_id_check(const struct m0_cas_id *cid,
 			 const struct cas_fom   *fom);
 static int  cas_device_check(const struct cas_fom   *fom,
 			     const struct m0_cas_id *cid);
+static bool cas_filter_is_valid(const struct m0_cas_op *op,
+				enum m0_cas_opcode opc, enum m0_cas_type ct)
+{
+	const struct m0_cas_filter *f     = &op->cg_filter;
+	uint32_t                    flags = op->cg_flags;
+
+	return opc == CO_CUR && ct == CT_BTREE && (flags & COF_SLANT) &&
+		ergo(flags & COF_PREFIX, f->cf_prefix.b_nob != 0) &&
+		ergo(flags & COF_END_KEY, f->cf_end.b_nob != 0) &&
+		ergo(flags & COF_DELIMITER, f->cf_delim.b_nob != 0);
+}
+
 static int cas_op_check(struct m0_cas_op *op,
 			struct cas_fom   *fom,
 			bool              is_index_drop);
@@ -508,6 +574,14 @@ static int cas_kv_load_done(struct cas_fom *fom, enum m0_cas_opcode  opc,
 static int cas_ctg_crow_handle(struct cas_fom *fom,
 			       const struct m0_cas_id *cid);
 
+static int cas_ctgs_check(const struct m0_cas_op *op, enum m0_cas_opcode opc,
+			  enum m0_cas_type ct);
+static struct m0_cas_id *cas_fom_cid(const struct cas_fom *fom);
+static bool cas_fom_ctg_is_last(const struct cas_fom *fom);
+static bool cas_fom_is_volatile(const struct cas_fom *fom);
+static struct m0_cas_ctg *cas_rec_ctg(const struct cas_fom *fom,
+				      uint64_t rec_pos);
+
 static int cas_ctidx_mem_place(struct cas_fom *fom,
 			       const struct m0_cas_id *in_cid, int next);
 static int cas_ctidx_mem_free(struct cas_fom *fom, int next);
@@ -524,6 +598,7 @@ static const struct m0_fom_ops               cas_fom_ops;
 static const struct m0_fom_type_ops          cas_fom_type_ops;
 static       struct m0_sm_conf               cas_sm_conf;
 static       struct m0_sm_state_descr        cas_fom_phases[];
+static       struct m0_objcache              cas_fom_cache;
 
 M0_INTERNAL void m0_cas_svc_init(void)
 {
@@ -536,12 +611,16 @@ M0_INTERNAL void m0_cas_svc_init(void)
 		M0_BITS(M0_FOPH_TXN_LOGGED_WAIT);
 	m0_sm_conf_init(&cas_sm_conf);
 	m0_reqh_service_type_register(&m0_cas_service_type);
+	m0_objcache_init(&cas_fom_cache, "cas fom", sizeof(struct cas_fom));
 	m0_cas_gc_init();
+	m0_cas_compact_init();
 }
 
 M0_INTERNAL void m0_cas_svc_fini(void)
 {
+	m0_cas_compact_fini();
 	m0_cas_gc_fini();
+	m0_objcache_fini(&cas_fom_cache);
 	m0_reqh_service_type_unregister(&m0_cas_service_type);
 	m0_sm_conf_fini(&cas_sm_conf);
 }
@@ -644,6 +723,8 @@ static int cas_service_start(struct m0_reqh_service *svc)
 		 * If no pending index drop, it finishes soon.
 		 */
 		m0_cas_gc_start(svc);
+		/* Remove stale tombstones of versioned catalogues. */
+		m0_cas_compact_start(svc);
 		rc = cas_service_sdev_id_set(service);
 	}
 	return rc;
@@ -651,6 +732,7 @@ static int cas_service_start(struct m0_reqh_service *svc)
 
 static void cas_service_prepare_to_stop(struct m0_reqh_service *svc)
 {
+	m0_cas_compact_stop();
 	/* Wait until garbage collector destroys all dead indices. */
 	m0_cas_gc_wait_sync();
 }
@@ -709,13 +791,16 @@ static int cas_fom_create(struct m0_fop *fop,
 	struct m0_cas_rep *repdata;
 	struct m0_cas_rec *repv;
 	struct cas_kv     *ikv;
+	struct cas_mctg   *mctg;
 	uint64_t           in_nr;
 	uint64_t           out_nr;
+	uint64_t           mctg_nr;
+	uint64_t           i;
 
 	if (!cas_service_started(fop, reqh))
 		return M0_ERR(-EAGAIN);
 
-	M0_ALLOC_PTR(fom);
+	fom = m0_objcache_alloc(&cas_fom_cache);
 	/**
 	 * @todo Validity (cas_is_valid()) of input records is not checked here,
 	 * so "out_nr" can be bogus. Cannot check validity at this point,
@@ -740,12 +825,21 @@ static int cas_fom_create(struct m0_fop *fop,
 		M0_ALLOC_ARR(repv, out_nr);
 	else
 		repv = NULL;
+
+	mctg_nr = ((struct m0_cas_op *)m0_fop_data(fop))->cg_ctgs.cgs_nr;
+	if (mctg_nr != 0)
+		M0_ALLOC_ARR(mctg, mctg_nr);
+	else
+		mctg = NULL;
 	if (fom != NULL && repfop != NULL &&
 	    (in_nr == 0 || ikv != NULL) &&
-	    (out_nr == 0 || repv != NULL)) {
+	    (out_nr == 0 || repv != NULL) &&
+	    (mctg_nr == 0 || mctg != NULL)) {
 		*out = fom0 = &fom->cf_fom;
 		fom->cf_ikv = ikv;
 		fom->cf_ikv_nr = in_nr;
+		fom->cf_mctg = mctg;
+		fom->cf_mctg_nr = mctg_nr;
 		repdata = m0_fop_data(repfop);
 		repdata->cgr_rep.cr_nr  = out_nr;
 		repdata->cgr_rep.cr_rec = repv;
@@ -761,12 +855,16 @@ static int cas_fom_create(struct m0_fop *fop,
 				       &fom->cf_dead_index_addb2);
 		m0_long_lock_link_init(&fom->cf_del_lock, fom0,
 				       &fom->cf_del_lock_addb2);
+		for (i = 0; i < mctg_nr; i++)
+			m0_long_lock_link_init(&mctg[i].mc_lock, fom0,
+					       &mctg[i].mc_lock_addb2);
 		return M0_RC(0);
 	} else {
 		m0_free(ikv);
+		m0_free(mctg);
 		m0_free(repfop);
 		m0_free(repv);
-		m0_free(fom);
+		m0_objcache_free(&cas_fom_cache, fom);
 		return M0_ERR(-ENOMEM);
 	}
 }
@@ -798,13 +896,24 @@ static int cas_at_reply(struct m0_rpc_at_buf *in,
 	return m0_rpc_at_reply(in, out, repbuf, fom, next_phase);
 }
 
-static void cas_at_fini(struct m0_rpc_at_buf *ab)
+static void cas_at_fini(struct m0_fop *fop, struct m0_rpc_at_buf *ab)
 {
 	if (cas_in_ut()) {
 		ab->ab_type = M0_RPC_AT_EMPTY;
 		return;
 	}
 
+	/*
+	 * Decoded data of an incoming fop are released with the fop, see
+	 * M0_FOP_TYPE_FLAG_DECODE_ARENA. ab_recv has the layout of ab_send.
+	 */
+	if (ab->ab_type == M0_RPC_AT_INLINE &&
+	    m0_fop_arena_owns(fop, ab->u.ab_buf.b_addr))
+		ab->u.ab_buf = M0_BUF_INIT0;
+	else if (M0_IN(ab->ab_type, (M0_RPC_AT_BULK_SEND,
+				     M0_RPC_AT_BULK_RECV)) &&
+		 m0_fop_arena_owns(fop, ab->u.ab_send.bdd_desc.nbd_data))
+		M0_SET0(&ab->u.ab_send.bdd_desc);
 	m0_rpc_at_fini(ab);
 }
 
@@ -1042,12 +1151,129 @@ static bool cas_key_need_to_send(struct cas_fom *fom, enum m0_cas_opcode opc,
 	return key_send;
 }
 
+/**
+ * Builds the smallest key greater than all keys starting with @prefix: @prefix
+ * with trailing 0xff bytes dropped and the last byte incremented.
+ *
+ * @retval -ENOENT there is no such key, @prefix consists of 0xff bytes.
+ */
+static int cas_prefix_succ(const struct m0_buf *prefix, struct m0_buf *succ)
+{
+	const uint8_t *p   = prefix->b_addr;
+	m0_bcount_t    nob = prefix->b_nob;
+	int            rc;
+
+	while (nob > 0 && p[nob - 1] == 0xff)
+		--nob;
+	if (nob == 0)
+		return -ENOENT;
+	rc = m0_buf_copy(succ, &M0_BUF_INIT(nob, prefix->b_addr));
+	if (rc == 0)
+		((uint8_t *)succ->b_addr)[nob - 1]++;
+	return M0_RC(rc);
+}
+
+static bool cas_buf_has_prefix(const struct m0_buf *buf,
+			       const struct m0_buf *prefix)
+{
+	return buf->b_nob >= prefix->b_nob &&
+		memcmp(buf->b_addr, prefix->b_addr, prefix->b_nob) == 0;
+}
+
+/**
+ * Evaluates m0_cas_op::cg_filter against the current record of NEXT iteration.
+ *
+ * Sets @send if the record (or the common prefix it is rolled up to) should
+ * be sent. Otherwise the record is dropped, or the iteration is over if
+ * cas_fom::cf_filter_eof is set.
+ *
+ * A rolled up record is followed by the move of the cursor past the common
+ * prefix, so that keys under it are not even visited. If the start key with
+ * ::COF_EXCLUDE_START_KEY is the common prefix itself, then the common prefix
+ * is dropped, which allows to continue listing from the last returned record.
+ */
+static int cas_filter(struct cas_fom *fom, enum m0_cas_opcode opc,
+		      enum m0_cas_type ct, struct m0_cas_op *op,
+		      uint64_t rec_pos, bool *send)
+{
+	const struct m0_cas_filter *f     = &op->cg_filter;
+	uint32_t                    flags = op->cg_flags;
+	struct m0_buf               key;
+	struct m0_buf               val;
+	struct m0_buf               in_key;
+	struct m0_buf               in_val;
+	struct m0_buf               common;
+	m0_bcount_t                 start = 0;
+	m0_bcount_t                 i;
+	int                         rc;
+
+	*send = true;
+	if (opc != CO_CUR || ct != CT_BTREE || (flags & COF_FILTER) == 0)
+		return 0;
+	m0_ctg_cursor_kv_get(&fom->cf_ctg_op, &key, &val);
+	if ((flags & COF_END_KEY) && m0_buf_cmp(&key, &f->cf_end) >= 0) {
+		fom->cf_filter_eof = true;
+		*send = false;
+		return 0;
+	}
+	if (flags & COF_PREFIX) {
+		if (!cas_buf_has_prefix(&key, &f->cf_prefix)) {
+			/* Keys of the prefix are contiguous in the catalogue. */
+			if (m0_buf_cmp(&key, &f->cf_prefix) > 0)
+				fom->cf_filter_eof = true;
+			else
+				fom->cf_filtered++;
+			*send = false;
+			return 0;
+		}
+		start = f->cf_prefix.b_nob;
+	}
+	if (!(flags & COF_DELIMITER))
+		return 0;
+	for (i = start; i + f->cf_delim.b_nob <= key.b_nob; ++i) {
+		if (memcmp(key.b_addr + i, f->cf_delim.b_addr,
+			   f->cf_delim.b_nob) == 0)
+			break;
+	}
+	if (i + f->cf_delim.b_nob > key.b_nob)
+		return 0;
+	common = M0_BUF_INIT(i + f->cf_delim.b_nob, key.b_addr);
+	m0_buf_free(&fom->cf_seek);
+	rc = cas_prefix_succ(&common, &fom->cf_seek);
+	if (rc == -ENOENT) {
+		/* Nothing past the common prefix, this is the last record. */
+		fom->cf_filter_eof = true;
+		rc = 0;
+	}
+	if (rc != 0)
+		return M0_ERR(rc);
+	if (fom->cf_curpos == 0 && (flags & COF_EXCLUDE_START_KEY)) {
+		cas_incoming_kv(fom, rec_pos, &in_key, &in_val);
+		if (m0_buf_eq(&common, &in_key)) {
+			fom->cf_filtered++;
+			*send = false;
+			return 0;
+		}
+	}
+	fom->cf_rollup_nob = common.b_nob;
+	return 0;
+}
+
+/** Returns the number of records sent by the current NEXT iteration. */
+static uint64_t cas_cur_sent_nr(const struct cas_fom *fom)
+{
+	return fom->cf_curpos - fom->cf_filtered -
+		(fom->cf_startkey_excluded ? 1 : 0);
+}
+
 static void cas_fom_cleanup(struct cas_fom *fom, bool ctg_op_fini)
 {
 	struct m0_ctg_op  *ctg_op     = &fom->cf_ctg_op;
 	struct m0_cas_ctg *meta       = m0_ctg_meta();
 	struct m0_cas_ctg *ctidx      = m0_ctg_ctidx();
 	struct m0_cas_ctg *dead_index = m0_ctg_dead_index();
+	struct cas_mctg   *mctg;
+	uint64_t           i;
 
 	m0_long_unlock(m0_ctg_lock(meta), &fom->cf_meta);
 	m0_long_unlock(m0_ctg_lock(ctidx), &fom->cf_ctidx);
@@ -1055,6 +1281,12 @@ static void cas_fom_cleanup(struct cas_fom *fom, bool ctg_op_fini)
 	m0_long_unlock(m0_ctg_del_lock(), &fom->cf_del_lock);
 	if (fom->cf_ctg != NULL)
 		m0_long_unlock(m0_ctg_lock(fom->cf_ctg), &fom->cf_lock);
+	for (i = 0; i < fom->cf_mctg_nr; i++) {
+		mctg = &fom->cf_mctg[i];
+		if (mctg->mc_ctg != NULL)
+			m0_long_unlock(m0_ctg_lock(mctg->mc_ctg),
+				       &mctg->mc_lock);
+	}
 	if (ctg_op_fini) {
 		if (m0_ctg_cursor_is_initialised(ctg_op))
 			m0_ctg_cursor_fini(ctg_op);
@@ -1247,8 +1479,9 @@ static int cas_fom_tick(struct m0_fom *fom0)
 	enum m0_cas_opcode  opc     = m0_cas_opcode(fom0->fo_fop);
 	enum m0_cas_type    ct      = cas_type(fom0);
 	bool                is_meta = ct == CT_META;
-	struct m0_cas_ctg  *ctg     = fom->cf_ctg;
 	size_t              ipos    = fom->cf_ipos;
+	struct m0_cas_ctg  *ctg     = cas_rec_ctg(fom, ipos);
+	struct m0_cas_id   *cid     = cas_fom_cid(fom);
 	struct m0_cas_id   *icid    = &fom->cf_in_cids[ipos];
 	struct m0_ctg_op   *ctg_op  = &fom->cf_ctg_op;
 	struct cas_service *service = M0_AMB(service,
@@ -1257,9 +1490,12 @@ static int cas_fom_tick(struct m0_fom *fom0)
 	struct m0_cas_ctg  *ctidx   = m0_ctg_ctidx();
 	struct m0_cas_rec  *rec     = NULL;
 	bool                is_dtm0_used = ENABLE_DTM0 &&
-					   !m0_dtm0_tx_desc_is_none(&op->cg_txd);
+					   !m0_dtm0_tx_desc_is_none(&op->cg_txd) &&
+					   !fom->cf_volatile;
 	bool                is_index_drop;
+	bool                is_multi = op->cg_ctgs.cgs_nr != 0;
 	bool                do_ctidx;
+	bool                send;
 	int                 next_phase;
 
 	M0_ENTRY("fom %p phase %d (%s) op_flag=0x%x", fom, phase,
@@ -1327,19 +1563,29 @@ static int cas_fom_tick(struct m0_fom *fom0)
 		}
 		break;
 	case CAS_CHECK_PRE:
-		rc = cas_id_check(&op->cg_id, fom);
-		if (rc == 0) {
-			if (cas_fid_is_cctg(&op->cg_id.ci_fid))
-				result = cas_ctidx_lookup(fom, &op->cg_id,
-							  CAS_CHECK);
-			else
-				m0_fom_phase_set(fom0, CAS_CHECK);
-		} else
+		rc = (fom->cf_mpos == 0 ? cas_ctgs_check(op, opc, ct) : 0) ?:
+			cas_id_check(cid, fom);
+		fom->cf_ctidx_lookup = false;
+		if (rc == 0 && cas_fid_is_cctg(&cid->ci_fid)) {
+			/* Layout of a volatile catalogue is kept with it. */
+			rc = m0_ctg_vol_layout_check(cid);
+			fom->cf_ctidx_lookup = rc == -ENOENT;
+		}
+		if (fom->cf_ctidx_lookup)
+			result = cas_ctidx_lookup(fom, cid, CAS_CHECK);
+		else if (rc == 0)
+			m0_fom_phase_set(fom0, CAS_CHECK);
+		else
 			m0_fom_phase_move(fom0, M0_ERR(rc), M0_FOPH_FAILURE);
 		break;
 	case CAS_CHECK:
 		rc = cas_op_check(op, fom, is_index_drop);
-		if (rc == 0) {
+		if (rc == 0 && !cas_fom_ctg_is_last(fom)) {
+			/* Check the next catalogue of multi-catalogue op. */
+			fom->cf_mpos++;
+			m0_fom_phase_set(fom0, CAS_CHECK_PRE);
+		} else if (rc == 0) {
+			fom->cf_mpos = 0;
 			fom->cf_op_checked = true;
 			M0_ADDB2_ADD(M0_AVI_ATTR,
 				     m0_sm_id_get(&fom0->fo_sm_phase),
@@ -1350,6 +1596,8 @@ static int cas_fom_tick(struct m0_fom *fom0)
 			m0_fom_phase_move(fom0, M0_ERR(rc), M0_FOPH_FAILURE);
 		break;
 	case CAS_START:
+		/* Catalogues are looked up again after CROW. */
+		fom->cf_mpos = 0;
 		if (is_meta) {
 			/*
 			 * Assign meta to ctg to re-use CAS_LOCK state.
@@ -1369,19 +1617,29 @@ static int cas_fom_tick(struct m0_fom *fom0)
 	case CAS_META_LOOKUP:
 		m0_ctg_op_init(&fom->cf_ctg_op, fom0, 0);
 		result = m0_ctg_meta_lookup(ctg_op,
-					    &op->cg_id.ci_fid,
+					    &cid->ci_fid,
 					    CAS_META_LOOKUP_DONE);
 		break;
 	case CAS_META_LOOKUP_DONE:
 		rc = m0_ctg_op_rc(ctg_op);
 		if (rc == 0) {
-			fom->cf_ctg = m0_ctg_meta_lookup_result(ctg_op);
-			M0_ASSERT(fom->cf_ctg != NULL);
-			m0_fom_phase_set(fom0, CAS_LOAD_KEY);
+			ctg = m0_ctg_meta_lookup_result(ctg_op);
+			M0_ASSERT(ctg != NULL);
+			if (is_multi)
+				fom->cf_mctg[fom->cf_mpos].mc_ctg = ctg;
+			else
+				fom->cf_ctg = ctg;
+			if (cas_fom_ctg_is_last(fom)) {
+				fom->cf_mpos = 0;
+				m0_fom_phase_set(fom0, CAS_LOAD_KEY);
+			} else {
+				fom->cf_mpos++;
+				m0_fom_phase_set(fom0, CAS_META_LOOKUP);
+			}
 		} else if (rc == -ENOENT && opc == CO_PUT &&
 			   (op->cg_flags & COF_CROW)) {
 			m0_long_unlock(m0_ctg_lock(meta), &fom->cf_meta);
-			rc = cas_ctg_crow_handle(fom, &op->cg_id);
+			rc = cas_ctg_crow_handle(fom, cid);
 			if (rc == 0) {
 				m0_fom_phase_set(fom0, CAS_CTG_CROW_DONE);
 				result = M0_FSO_WAIT;
@@ -1457,6 +1715,24 @@ static int cas_fom_tick(struct m0_fom *fom0)
 		m0_fom_phase_set(fom0, CAS_LOAD_KEY);
 		break;
 	case CAS_LOCK:
+		if (is_multi) {
+			/*
+			 * Catalogues are write-locked one by one in the
+			 * ascending order of their fids, so that concurrent
+			 * multi-catalogue operations do not deadlock.
+			 */
+			ctg = fom->cf_mctg[fom->cf_mpos].mc_ctg;
+			i = fom->cf_mpos;
+			next_phase = cas_fom_ctg_is_last(fom) ? CAS_PREP :
+								CAS_LOCK;
+			fom->cf_mpos = next_phase == CAS_LOCK ? i + 1 : 0;
+			result = m0_long_write_lock(m0_ctg_lock(ctg),
+						    &fom->cf_mctg[i].mc_lock,
+						    next_phase);
+			result = M0_FOM_LONG_LOCK_RETURN(result);
+			fom->cf_ipos = 0;
+			break;
+		}
 		M0_ASSERT(ctg != NULL);
 		/*
 		 * In case of index drop use cf_meta lock: we need cf_lock to
@@ -1491,7 +1767,7 @@ static int cas_fom_tick(struct m0_fom *fom0)
 		}
 
 		for (i = 0; i < op->cg_rec.cr_nr; i++)
-			cas_prep(fom, opc, ct, ctg, i,
+			cas_prep(fom, opc, ct, cas_rec_ctg(fom, i), i,
 				 &fom0->fo_tx.tx_betx_cred);
 		fom->cf_ipos = 0;
 		fom->cf_opos = 0;
@@ -1504,6 +1780,16 @@ static int cas_fom_tick(struct m0_fom *fom0)
 				       cas_op(fom0)->cg_flags);
 		}
 
+		/*
+		 * Volatile catalogues are not in BE: fom transaction is not
+		 * opened and is finalised in M0_FOPH_TXN_COMMIT, DTM0 is not
+		 * used.
+		 */
+		fom->cf_volatile = cas_fom_is_volatile(fom);
+		if (fom->cf_volatile) {
+			m0_fom_phase_set(fom0, CAS_TXN_OPENED);
+			break;
+		}
 		/*
 		 * If dtm0 is used we need to calculate credits for creating
 		 * a dtm0 log record.
@@ -1617,6 +1903,18 @@ static int cas_fom_tick(struct m0_fom *fom0)
 			 * We will need catalogue later to lock it.
 			 */
 			fom->cf_moved_ctgs[ipos] = fom->cf_ctg;
+			if (m0_ctg_is_volatile(fom->cf_ctg)) {
+				/*
+				 * Volatile catalogue is not in meta and is
+				 * not collected by the garbage collector. It
+				 * is freed in CAS_IDROP_LOCKED, when nobody
+				 * uses it.
+				 */
+				m0_ctg_vol_forget(fom->cf_ctg);
+				fom->cf_ctg = NULL;
+				m0_fom_phase_set(fom0, CAS_IDROP_LOOP);
+				break;
+			}
 			/*
 			 * Insert to dead index, then can remove from meta.
 			 */
@@ -1710,6 +2008,10 @@ static int cas_fom_tick(struct m0_fom *fom0)
 		 */
 		m0_long_unlock(m0_ctg_lock(fom->cf_moved_ctgs[ipos]),
 			       &fom->cf_lock);
+		if (m0_ctg_is_volatile(fom->cf_moved_ctgs[ipos])) {
+			m0_ctg_vol_destroy(fom->cf_moved_ctgs[ipos]);
+			fom->cf_moved_ctgs[ipos] = NULL;
+		}
 		m0_fom_phase_set(fom0, CAS_PREPARE_SEND);
 		break;
 	case CAS_IDROP_START_GC:
@@ -1730,16 +2032,25 @@ static int cas_fom_tick(struct m0_fom *fom0)
 				  &cas_out_at(rep, fom->cf_opos)->cr_ver);
 		if (rec->cr_rc == 0) {
 			rec->cr_rc = m0_ctg_op_rc(ctg_op);
+			if (rec->cr_rc == 0)
+				rec->cr_rc = cas_filter(fom, opc, ct, op, ipos,
+							&send);
 			if (rec->cr_rc == 0) {
-				if (cas_key_need_to_send(fom, opc, ct, op,
-							 ipos)){
+				if (!send && fom->cf_filter_eof) {
+					/* Reply as if the end is reached. */
+					rec->cr_rc = -ENOENT;
+				} else if (send &&
+					   cas_key_need_to_send(fom, opc, ct,
+								op, ipos)) {
 					rec->cr_rc =
 						cas_prep_send(fom, opc, ct);
 					if (rec->cr_rc == 0)
 						next_phase = CAS_SEND_KEY;
 				} else {
-					if (opc == CO_CUR)
+					if (opc == CO_CUR) {
 						fom->cf_curpos++;
+						fom->cf_rollup_nob = 0;
+					}
 					next_phase = CAS_LOOP;
 				}
 			}
@@ -1809,8 +2120,8 @@ static void cas_fom_fini(struct m0_fom *fom0)
 		rec = cas_at(op, i);
 
 		/* Finalise input AT buffers. */
-		cas_at_fini(&rec->cr_key);
-		cas_at_fini(&rec->cr_val);
+		cas_at_fini(fom0->fo_fop, &rec->cr_key);
+		cas_at_fini(fom0->fo_fop, &rec->cr_val);
 	}
 
 	if (cas_in_ut() && cas__ut_cb_done != NULL)
@@ -1821,17 +2132,104 @@ static void cas_fom_fini(struct m0_fom *fom0)
 	m0_free(fom->cf_in_cids);
 	m0_free(fom->cf_moved_ctgs);
 	m0_free(fom->cf_ikv);
+	m0_buf_free(&fom->cf_seek);
 	m0_long_lock_link_fini(&fom->cf_meta);
 	m0_long_lock_link_fini(&fom->cf_lock);
 	m0_long_lock_link_fini(&fom->cf_ctidx);
 	m0_long_lock_link_fini(&fom->cf_dead_index);
 	m0_long_lock_link_fini(&fom->cf_del_lock);
+	for (i = 0; i < fom->cf_mctg_nr; i++)
+		m0_long_lock_link_fini(&fom->cf_mctg[i].mc_lock);
+	m0_free(fom->cf_mctg);
 	m0_fom_fini(fom0);
-	m0_free(fom);
+	m0_objcache_free(&cas_fom_cache, fom);
 	if (cas_in_ut() && cas__ut_cb_fini != NULL)
 		cas__ut_cb_fini(fom0);
 }
 
+/**
+ * Checks catalogues of a multi-catalogue operation, see m0_cas_op::cg_ctgs.
+ */
+static int cas_ctgs_check(const struct m0_cas_op *op, enum m0_cas_opcode opc,
+			  enum m0_cas_type ct)
+{
+	const struct m0_cas_ctg_ranges *ctgs = &op->cg_ctgs;
+	const struct m0_cas_ctg_range  *r    = ctgs->cgs_ranges;
+	uint64_t                        nr   = 0;
+	uint64_t                        i;
+
+	if (ctgs->cgs_nr == 0)
+		return 0;
+	if (!M0_IN(opc, (CO_PUT, CO_DEL)) || ct != CT_BTREE ||
+	    !m0_fid_eq(&op->cg_id.ci_fid, &r[0].cgr_id.ci_fid))
+		return M0_ERR(-EPROTO);
+	for (i = 0; i < ctgs->cgs_nr; i++) {
+		if (r[i].cgr_nr == 0 ||
+		    (i > 0 && m0_fid_cmp(&r[i - 1].cgr_id.ci_fid,
+					 &r[i].cgr_id.ci_fid) >= 0))
+			return M0_ERR(-EPROTO);
+		nr += r[i].cgr_nr;
+	}
+	return nr == op->cg_rec.cr_nr ? 0 : M0_ERR(-EPROTO);
+}
+
+/**
+ * Returns the catalogue the fom works with: m0_cas_op::cg_id or the
+ * catalogue at ->cf_mpos of a multi-catalogue operation.
+ */
+static struct m0_cas_id *cas_fom_cid(const struct cas_fom *fom)
+{
+	struct m0_cas_op *op = cas_op(&fom->cf_fom);
+
+	return op->cg_ctgs.cgs_nr == 0 ? &op->cg_id :
+		&op->cg_ctgs.cgs_ranges[fom->cf_mpos].cgr_id;
+}
+
+/** Whether the catalogue at ->cf_mpos is the last one to be processed. */
+static bool cas_fom_ctg_is_last(const struct cas_fom *fom)
+{
+	return fom->cf_mpos + 1 >= cas_op(&fom->cf_fom)->cg_ctgs.cgs_nr;
+}
+
+/**
+ * Whether the operation addresses volatile catalogues only, so that BE
+ * transaction is not needed. Meta-catalogue operation creates volatile
+ * catalogues with ::COF_VOLATILE or drops existing ones.
+ */
+static bool cas_fom_is_volatile(const struct cas_fom *fom)
+{
+	struct m0_cas_op   *op  = cas_op(&fom->cf_fom);
+	enum m0_cas_opcode  opc = m0_cas_opcode(fom->cf_fom.fo_fop);
+
+	if (cas_type(&fom->cf_fom) != CT_META)
+		return op->cg_ctgs.cgs_nr == 0 && fom->cf_ctg != NULL &&
+			m0_ctg_is_volatile(fom->cf_ctg);
+	else if (opc == CO_PUT)
+		return op->cg_flags & COF_VOLATILE;
+	else
+		return opc == CO_DEL && fom->cf_in_cids_nr != 0 &&
+			m0_forall(i, fom->cf_in_cids_nr,
+				  m0_ctg_vol_exists(&fom->cf_in_cids[i].ci_fid));
+}
+
+/**
+ * Returns the catalogue the record at rec_pos is addressed to, ->cf_ctg for
+ * a single catalogue operation.
+ */
+static struct m0_cas_ctg *cas_rec_ctg(const struct cas_fom *fom,
+				      uint64_t rec_pos)
+{
+	const struct m0_cas_ctg_ranges *ctgs = &cas_op(&fom->cf_fom)->cg_ctgs;
+	uint64_t                        i;
+
+	for (i = 0; i < ctgs->cgs_nr; i++) {
+		if (rec_pos < ctgs->cgs_ranges[i].cgr_nr)
+			return fom->cf_mctg[i].mc_ctg;
+		rec_pos -= ctgs->cgs_ranges[i].cgr_nr;
+	}
+	return fom->cf_ctg;
+}
+
 static const struct m0_fid *cas_fid(const struct m0_fom *fom)
 {
 	return &cas_op(fom)->cg_id.ci_fid;
@@ -1961,14 +2359,17 @@ static int cas_op_check(struct m0_cas_op *op,
 	enum m0_cas_type            ct      = cas_type(fom0);
 	bool                        is_meta = ct == CT_META;
 	struct m0_ctg_op           *ctg_op  = &fom->cf_ctg_op;
-	const struct m0_cas_id     *cid     = &op->cg_id;
+	const struct m0_cas_id     *cid     = cas_fom_cid(fom);
 	uint32_t                    flags   = cas_op(fom0)->cg_flags;
 	struct m0_buf               buf;
 	const struct m0_dix_layout *layout;
 	struct m0_dix_layout       *stored_layout;
 	int                         rc = 0;
 
-	if (cas_fid_is_cctg(&cid->ci_fid)) {
+	if ((flags & COF_FILTER) && !cas_filter_is_valid(op, opc, ct))
+		rc = M0_ERR(-EPROTO);
+
+	if (rc == 0 && fom->cf_ctidx_lookup) {
 		rc = m0_ctg_op_rc(ctg_op);
 		if (rc == 0) {
 			m0_ctg_lookup_result(ctg_op, &buf);
@@ -1987,7 +2388,7 @@ static int cas_op_check(struct m0_cas_op *op,
 	}
 
 	if (rc == 0) {
-		rc = cas_device_check(fom, &op->cg_id);
+		rc = cas_device_check(fom, cid);
 		if (rc == 0 && is_meta && fom->cf_ikv_nr != 0) {
 			M0_ALLOC_ARR(fom->cf_in_cids, fom->cf_ikv_nr);
 			if (fom->cf_in_cids == NULL)
@@ -2006,7 +2407,7 @@ static int cas_op_check(struct m0_cas_op *op,
 			}
 		}
 	}
-	if (rc == 0)
+	if (rc == 0 && cas_fom_ctg_is_last(fom))
 		/*
 		 * Note: fill cf_in_cids there.
 		 */
@@ -2264,6 +2665,7 @@ static int cas_exec(struct cas_fom *fom, enum m0_cas_opcode opc,
 	struct m0_buf              vbuf;
 	struct m0_cas_id          *cid;
 	struct m0_cas_rec         *rec;
+	struct m0_cas_filter      *filter;
 	enum m0_fom_phase_outcome  ret = M0_FSO_AGAIN;
 	M0_ENTRY("opc=%d ct=%d", opc, ct);
 
@@ -2313,7 +2715,9 @@ static int cas_exec(struct cas_fom *fom, enum m0_cas_opcode opc,
 		ret = m0_ctg_meta_lookup(ctg_op, &cid->ci_fid, next);
 		break;
 	case CTG_OP_COMBINE(CO_PUT, CT_META):
-		ret = m0_ctg_meta_insert(ctg_op, &cid->ci_fid, next);
+		ret = (flags & COF_VOLATILE) ?
+			m0_ctg_vol_insert(ctg_op, cid, next) :
+			m0_ctg_meta_insert(ctg_op, &cid->ci_fid, next);
 		break;
 	case CTG_OP_COMBINE(CO_GC, CT_META):
 		ret = m0_ctg_gc_wait(ctg_op, next);
@@ -2330,11 +2734,21 @@ static int cas_exec(struct cas_fom *fom, enum m0_cas_opcode opc,
 			if (ct == CT_META)
 				m0_ctg_meta_cursor_get(ctg_op, &cid->ci_fid,
 						       next);
-			else
+			else {
+				filter = &cas_op(fom0)->cg_filter;
+				/* Start from the prefix, if it is greater. */
+				if ((flags & COF_PREFIX) &&
+				    m0_buf_cmp(&kbuf, &filter->cf_prefix) < 0)
+					kbuf = filter->cf_prefix;
 				m0_ctg_cursor_get(ctg_op, &kbuf, next);
+			}
 		} else if (ct == CT_META)
 			m0_ctg_meta_cursor_next(ctg_op, next);
-		else
+		else if (fom->cf_seek.b_nob != 0) {
+			/* Skip records under the rolled up common prefix. */
+			m0_ctg_cursor_get(ctg_op, &fom->cf_seek, next);
+			m0_buf_free(&fom->cf_seek);
+		} else
 			m0_ctg_cursor_next(ctg_op, next);
 		break;
 	}
@@ -2352,7 +2766,10 @@ static bool cas_ctidx_op_needed(struct cas_fom *fom, enum m0_cas_opcode opc,
 	case CTG_OP_COMBINE(CO_PUT, CT_META):
 	case CTG_OP_COMBINE(CO_DEL, CT_META):
 		cid = &fom->cf_in_cids[rec_pos];
-		if (cas_fid_is_cctg(&cid->ci_fid))
+		/* Layout of a volatile catalogue is kept with it. */
+		if (cas_fid_is_cctg(&cid->ci_fid) &&
+		    !(opc == CO_PUT &&
+		      (cas_op(&fom->cf_fom)->cg_flags & COF_VOLATILE)))
 			is_needed = true;
 		break;
 	default:
@@ -2516,6 +2933,11 @@ static int cas_prep_send(struct cas_fom *fom, enum m0_cas_opcode opc,
 	case CTG_OP_COMBINE(CO_CUR, CT_BTREE):
 	case CTG_OP_COMBINE(CO_CUR, CT_META):
 		m0_ctg_cursor_kv_get(ctg_op, &key, &val);
+		if (fom->cf_rollup_nob != 0) {
+			/* Common prefix of ::COF_DELIMITER has no value. */
+			key.b_nob = fom->cf_rollup_nob;
+			val = M0_BUF_INIT0;
+		}
 		rc = cas_place(&fom->cf_out_key, &key, rpc_cutoff);
 		if (ct == CT_BTREE && rc == 0)
 			rc = cas_place(&fom->cf_out_val, &val,
@@ -2541,13 +2963,11 @@ static int cas_done(struct cas_fom *fom, struct m0_cas_op *op,
 	rc = rec_out->cr_rc;
 	if (opc == CO_CUR) {
 		fom->cf_curpos++;
+		fom->cf_rollup_nob = 0;
 		if (rc == 0 && ctg_rc == 0)
-			rc = fom->cf_startkey_excluded ?
-				fom->cf_curpos - 1 : fom->cf_curpos;
-		if (ctg_rc == 0 &&
-		    ((fom->cf_curpos < rec->cr_rc) ||
-		     (fom->cf_startkey_excluded &&
-		      (fom->cf_curpos < rec->cr_rc + 1)))) {
+			rc = cas_cur_sent_nr(fom);
+		if (ctg_rc == 0 && !fom->cf_filter_eof &&
+		    cas_cur_sent_nr(fom) < rec->cr_rc) {
 			/* Continue with the same iteration. */
 			--fom->cf_ipos;
 		} else {
@@ -2558,6 +2978,9 @@ static int cas_done(struct cas_fom *fom, struct m0_cas_op *op,
 			m0_ctg_cursor_put(&fom->cf_ctg_op);
 			fom->cf_curpos = 0;
 			fom->cf_startkey_excluded = false;
+			fom->cf_filtered = 0;
+			fom->cf_filter_eof = false;
+			m0_buf_free(&fom->cf_seek);
 		}
 	} else
 		m0_ctg_op_fini(&fom->cf_ctg_op);
@@ -2776,7 +3199,8 @@ static const struct m0_fom_ops cas_fom_ops = {
 };
 
 static const struct m0_fom_type_ops cas_fom_type_ops = {
-	.fto_create = &cas_fom_create
+	.fto_create = &cas_fom_create,
+	.fto_prio   = M0_FOM_PRIO_HIGH
 };
 
 static struct m0_sm_state_descr cas_fom_phases[] = {
@@ -2786,7 +3210,8 @@ static struct m0_sm_state_descr cas_fom_phases[] = {
 	},
 	[CAS_CHECK] = {
 		.sd_name      = "cas-op-check",
-		.sd_allowed   = M0_BITS(M0_FOPH_INIT, M0_FOPH_FAILURE)
+		.sd_allowed   = M0_BITS(M0_FOPH_INIT, CAS_CHECK_PRE,
+					M0_FOPH_FAILURE)
 	},
 	[CAS_START] = {
 		.sd_name      = "start",
@@ -2803,7 +3228,7 @@ static struct m0_sm_state_descr cas_fom_phases[] = {
 	[CAS_META_LOOKUP_DONE] = {
 		.sd_name      = "meta-lookup-done",
 		.sd_allowed   = M0_BITS(CAS_CTG_CROW_DONE, CAS_LOAD_KEY,
-					M0_FOPH_FAILURE)
+					CAS_META_LOOKUP, M0_FOPH_FAILURE)
 	},
 	[CAS_CTG_CROW_DONE] = {
 		.sd_name      = "ctg-crow-done",
@@ -2811,7 +3236,7 @@ static struct m0_sm_state_descr cas_fom_phases[] = {
 	},
 	[CAS_LOCK] = {
 		.sd_name      = "lock",
-		.sd_allowed   = M0_BITS(CAS_CTIDX_LOCK, CAS_PREP)
+		.sd_allowed   = M0_BITS(CAS_CTIDX_LOCK, CAS_PREP, CAS_LOCK)
 	},
 	[CAS_CTIDX_LOCK] = {
 		.sd_name      = "ctidx_lock",
@@ -2832,7 +3257,8 @@ static struct m0_sm_state_descr cas_fom_phases[] = {
 	},
 	[CAS_PREP] = {
 		.sd_name      = "prep",
-		.sd_allowed   = M0_BITS(M0_FOPH_TXN_OPEN, M0_FOPH_FAILURE)
+		.sd_allowed   = M0_BITS(M0_FOPH_TXN_OPEN, CAS_TXN_OPENED,
+					M0_FOPH_FAILURE)
 	},
 	[CAS_TXN_OPENED] = {
 		.sd_name      = "txn-opened",
@@ -2909,7 +3335,8 @@ static struct m0_sm_state_descr cas_fom_phases[] = {
 	},
 	[CAS_INSERT_TO_DEAD] = {
 		.sd_name      = "insert-dead-index",
-		.sd_allowed   = M0_BITS(CAS_DELETE_FROM_META, CAS_PREPARE_SEND)
+		.sd_allowed   = M0_BITS(CAS_DELETE_FROM_META, CAS_IDROP_LOOP,
+					CAS_PREPARE_SEND)
 	},
 	[CAS_DELETE_FROM_META] = {
 		.sd_name      = "detele-from-meta",
@@ -2947,6 +3374,7 @@ struct m0_sm_trans_descr cas_fom_trans[] = {
 	{ "cas-op-check_pre_failed", CAS_CHECK_PRE,     M0_FOPH_FAILURE },
 	{ "cas-op-checked",       CAS_CHECK,            M0_FOPH_INIT },
 	{ "cas-op-check-failed",  CAS_CHECK,            M0_FOPH_FAILURE },
+	{ "cas-op-check-next",    CAS_CHECK,            CAS_CHECK_PRE },
 	{ "tx-initialised",       M0_FOPH_TXN_OPEN,     CAS_START },
 	{ "ctg-op?",              CAS_START,            CAS_META_LOCK },
 	{ "meta-op?",             CAS_START,            CAS_LOAD_KEY },
@@ -2954,6 +3382,7 @@ struct m0_sm_trans_descr cas_fom_trans[] = {
 	{ "meta-lookup-launched", CAS_META_LOOKUP,      CAS_META_LOOKUP_DONE },
 	{ "key-alloc-failure",    CAS_META_LOOKUP,      M0_FOPH_FAILURE },
 	{ "meta-lookup-done",     CAS_META_LOOKUP_DONE, CAS_LOAD_KEY },
+	{ "meta-lookup-next",     CAS_META_LOOKUP_DONE, CAS_META_LOOKUP },
 	{ "meta-lookup-fail",     CAS_META_LOOKUP_DONE, M0_FOPH_FAILURE },
 	{ "ctg-crow-done",        CAS_META_LOOKUP_DONE, CAS_CTG_CROW_DONE },
 	{ "ctg-crow-success",     CAS_CTG_CROW_DONE,    CAS_START },
@@ -2969,7 +3398,9 @@ struct m0_sm_trans_descr cas_fom_trans[] = {
 	{ "kv-setup-failure",     CAS_LOAD_DONE,        M0_FOPH_FAILURE },
 	{ "index-locked",         CAS_LOCK,             CAS_PREP },
 	{ "meta-locked",          CAS_LOCK,             CAS_CTIDX_LOCK },
+	{ "index-lock-next",      CAS_LOCK,             CAS_LOCK },
 	{ "tx-credit-calculated", CAS_PREP,             M0_FOPH_TXN_OPEN },
+	{ "tx-not-needed",        CAS_PREP,             CAS_TXN_OPENED },
 	{ "keys-vals-invalid",    CAS_PREP,             M0_FOPH_FAILURE },
 	{ "txn-opened-ctg-op?",   CAS_TXN_OPENED,       CAS_META_UNLOCK },
 	{ "txn-opened-meta-op?",  CAS_TXN_OPENED,       CAS_LOOP },
@@ -3008,6 +3439,7 @@ struct m0_sm_trans_descr cas_fom_trans[] = {
 	{ "dead-index-locked",    CAS_DEAD_INDEX_LOCK,  CAS_LOCK },
 	{ "dead-index-inserted",  CAS_INSERT_TO_DEAD,   CAS_DELETE_FROM_META },
 	{ "meta-lookup-fail",     CAS_INSERT_TO_DEAD,   CAS_PREPARE_SEND },
+	{ "volatile-forgotten",   CAS_INSERT_TO_DEAD,   CAS_IDROP_LOOP },
 	{ "meta-deleted",         CAS_DELETE_FROM_META, CAS_IDROP_LOOP },
 	{ "meta-deleted-ctidx",   CAS_DELETE_FROM_META, CAS_CTIDX },
 	{ "dead-index-ins-fail",  CAS_DELETE_FROM_META, CAS_PREPARE_SEND },
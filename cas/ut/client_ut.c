@@ -39,6 +39,7 @@
 #include "lib/finject.h"
 #include "dtm0/dtx.h"                  /* m0_dtm0_dtx */
 #include "cas/cas.h"                   /* m0_crv      */
+#include "cas/compact.h"               /* m0_cas_compact_start */
 
 #define SERVER_LOG_FILE_NAME       "cas_server.log"
 #define IFID(x, y) M0_FID_TINIT('i', (x), (y))
@@ -278,7 +279,7 @@ static int ut_idx_crdel_wrp(enum idx_operation       op,
 
 	m0_cas_req_lock(&req);
 	if (op == IDX_CREATE)
-		rc = m0_cas_index_create(&req, cids, ids_nr, NULL);
+		rc = m0_cas_index_create(&req, cids, ids_nr, NULL, flags);
 	else
 		rc = m0_cas_index_delete(&req, cids, ids_nr, NULL, flags);
 	/* wait results */
@@ -332,6 +333,16 @@ static int ut_idx_create(struct cl_ctx            *cctx,
 	return ut_idx_crdel_wrp(IDX_CREATE, cctx, ids, ids_nr, NULL, rep, 0);
 }
 
+static int ut_idx_flagged_create(struct cl_ctx           *cctx,
+				 const struct m0_fid     *ids,
+				 uint64_t                 ids_nr,
+				 struct m0_cas_rec_reply *rep,
+				 uint32_t                 flags)
+{
+	return ut_idx_crdel_wrp(IDX_CREATE, cctx, ids, ids_nr, NULL,
+				rep, flags);
+}
+
 static int ut_lookup_idx(struct cl_ctx           *cctx,
 			 const struct m0_fid     *ids,
 			 uint64_t                 ids_nr,
@@ -622,13 +633,14 @@ static void ut_next_rep_clear(struct m0_cas_next_reply *rep, uint64_t nr)
 	}
 }
 
-static int ut_next_rec(struct cl_ctx            *cctx,
-		       struct m0_cas_id         *index,
-		       struct m0_bufvec         *start_keys,
-		       uint32_t                 *recs_nr,
-		       struct m0_cas_next_reply *rep,
-		       uint64_t                 *count,
-		       uint32_t                  flags)
+static int ut_next_rec_filtered(struct cl_ctx              *cctx,
+				struct m0_cas_id           *index,
+				struct m0_bufvec           *start_keys,
+				uint32_t                   *recs_nr,
+				struct m0_cas_next_reply   *rep,
+				uint64_t                   *count,
+				uint32_t                    flags,
+				const struct m0_cas_filter *filter)
 {
 	struct m0_cas_req  req;
 	struct m0_chan    *chan;
@@ -645,7 +657,8 @@ static int ut_next_rec(struct cl_ctx            *cctx,
 	m0_clink_add_lock(chan, &cctx->cl_wait.aw_clink);
 
 	m0_cas_req_lock(&req);
-	rc = m0_cas_next(&req, index, start_keys, recs_nr, flags);
+	rc = m0_cas_next_filtered(&req, index, start_keys, recs_nr, flags,
+				  filter);
 	if (rc == 0) {
 		/* wait results */
 		m0_cas_req_wait(&req, M0_BITS(CASREQ_FINAL), M0_TIME_NEVER);
@@ -670,6 +683,18 @@ static int ut_next_rec(struct cl_ctx            *cctx,
 	return rc;
 }
 
+static int ut_next_rec(struct cl_ctx            *cctx,
+		       struct m0_cas_id         *index,
+		       struct m0_bufvec         *start_keys,
+		       uint32_t                 *recs_nr,
+		       struct m0_cas_next_reply *rep,
+		       uint64_t                 *count,
+		       uint32_t                  flags)
+{
+	return ut_next_rec_filtered(cctx, index, start_keys, recs_nr, rep,
+				    count, flags, NULL);
+}
+
 static int ut_rec_common_del(struct cl_ctx           *cctx,
 			     struct m0_cas_id        *index,
 			     const struct m0_bufvec  *keys,
@@ -2155,6 +2180,115 @@ static void next_fail(void)
 	casc_ut_fini(&casc_ut_sctx, &casc_ut_cctx);
 }
 
+static bool next_rep_key_is(const struct m0_cas_next_reply *rep,
+			     const char                     *key)
+{
+	return rep->cnp_rc == 0 &&
+		m0_buf_eq(&rep->cnp_key, &M0_BUF_INITS((char *)key));
+}
+
+static void next_filter(void)
+{
+	static const char       *names[] = {
+		"a", "b/1", "b/2", "b/3", "c/x/1", "c/x/2", "c/y", "d", "e/1"
+	};
+	struct m0_cas_rec_reply  rep[ARRAY_SIZE(names)];
+	struct m0_cas_next_reply next_rep[ARRAY_SIZE(names) + 1];
+	const struct m0_fid      ifid = IFID(2, 3);
+	struct m0_cas_id         index = {};
+	struct m0_cas_filter     filter = {};
+	struct m0_bufvec         keys;
+	struct m0_bufvec         values;
+	struct m0_bufvec         start;
+	uint32_t                 recs_nr;
+	uint64_t                 rep_count;
+	uint64_t                 zero = 0;
+	int                      rc;
+	int                      i;
+
+	casc_ut_init(&casc_ut_sctx, &casc_ut_cctx);
+	M0_SET_ARR0(rep);
+	M0_SET_ARR0(next_rep);
+	rc = m0_bufvec_empty_alloc(&keys, ARRAY_SIZE(names)) ?:
+		m0_bufvec_empty_alloc(&values, ARRAY_SIZE(names));
+	M0_UT_ASSERT(rc == 0);
+	for (i = 0; i < ARRAY_SIZE(names); i++) {
+		keys.ov_buf[i] = (char *)names[i];
+		keys.ov_vec.v_count[i] = strlen(names[i]);
+		values.ov_buf[i] = &zero;
+		values.ov_vec.v_count[i] = sizeof zero;
+	}
+	rc = ut_idx_create(&casc_ut_cctx, &ifid, 1, rep);
+	M0_UT_ASSERT(rc == 0);
+	index.ci_fid = ifid;
+	rc = ut_rec_put(&casc_ut_cctx, &index, &keys, &values, rep, 0);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_forall(i, ARRAY_SIZE(names), rep[i].crr_rc == 0));
+
+	rc = m0_bufvec_alloc(&start, 1, 4);
+	M0_UT_ASSERT(rc == 0);
+	recs_nr = ARRAY_SIZE(names);
+
+	/* Prefix: only "c/..." keys, the end of index after them. */
+	*(char *)start.ov_buf[0] = 'a';
+	start.ov_vec.v_count[0] = 1;
+	filter.cf_prefix = M0_BUF_INITS("c/");
+	rc = ut_next_rec_filtered(&casc_ut_cctx, &index, &start, &recs_nr,
+				  next_rep, &rep_count, COF_SLANT | COF_PREFIX,
+				  &filter);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(rep_count == 4);
+	M0_UT_ASSERT(next_rep_key_is(&next_rep[0], "c/x/1"));
+	M0_UT_ASSERT(next_rep_key_is(&next_rep[1], "c/x/2"));
+	M0_UT_ASSERT(next_rep_key_is(&next_rep[2], "c/y"));
+	M0_UT_ASSERT(next_rep[3].cnp_rc == -ENOENT);
+	ut_next_rep_clear(next_rep, rep_count);
+
+	/* Delimiter: common prefixes are returned once, without values. */
+	filter = (struct m0_cas_filter) { .cf_delim = M0_BUF_INITS("/") };
+	rc = ut_next_rec_filtered(&casc_ut_cctx, &index, &start, &recs_nr,
+				  next_rep, &rep_count,
+				  COF_SLANT | COF_DELIMITER, &filter);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(rep_count == 6);
+	M0_UT_ASSERT(next_rep_key_is(&next_rep[0], "a"));
+	M0_UT_ASSERT(next_rep_key_is(&next_rep[1], "b/"));
+	M0_UT_ASSERT(next_rep[1].cnp_val.b_nob == 0);
+	M0_UT_ASSERT(next_rep_key_is(&next_rep[2], "c/"));
+	M0_UT_ASSERT(next_rep_key_is(&next_rep[3], "d"));
+	M0_UT_ASSERT(next_rep_key_is(&next_rep[4], "e/"));
+	M0_UT_ASSERT(next_rep[5].cnp_rc == -ENOENT);
+	ut_next_rep_clear(next_rep, rep_count);
+
+	/*
+	 * Prefix, delimiter and end key, continued from the returned common
+	 * prefix: "c/x/" is not returned again.
+	 */
+	filter = (struct m0_cas_filter) {
+		.cf_prefix = M0_BUF_INITS("c/"),
+		.cf_delim  = M0_BUF_INITS("/"),
+		.cf_end    = M0_BUF_INITS("c/z")
+	};
+	memcpy(start.ov_buf[0], "c/x/", 4);
+	start.ov_vec.v_count[0] = 4;
+	rc = ut_next_rec_filtered(&casc_ut_cctx, &index, &start, &recs_nr,
+				  next_rep, &rep_count,
+				  COF_SLANT | COF_EXCLUDE_START_KEY | COF_FILTER,
+				  &filter);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(rep_count == 2);
+	M0_UT_ASSERT(next_rep_key_is(&next_rep[0], "c/y"));
+	M0_UT_ASSERT(next_rep[1].cnp_rc == -ENOENT);
+	ut_next_rep_clear(next_rep, rep_count);
+
+	rc = ut_idx_delete(&casc_ut_cctx, &ifid, 1, rep);
+	M0_UT_ASSERT(rc == 0);
+	m0_bufvec_free(&start);
+	m0_bufvec_free2(&keys);
+	m0_bufvec_free2(&values);
+	casc_ut_fini(&casc_ut_sctx, &casc_ut_cctx);
+}
+
 static void next_multi_common(struct m0_bufvec *keys, struct m0_bufvec *values)
 {
 	struct m0_cas_rec_reply  rep[COUNT];
@@ -3154,6 +3288,183 @@ static void get_ver_exposed(void)
 	casc_ut_fini(&casc_ut_sctx, &casc_ut_cctx);
 }
 
+/*
+ * Checks that compaction removes tombstones older than the horizon and keeps
+ * alive records and newer tombstones.
+ */
+static void compact_ver(void)
+{
+	enum { V_PAST, V_FUTURE, V_NR };
+	struct m0_bufvec             keys;
+	struct m0_bufvec             values;
+	struct m0_bufvec             kodd;
+	struct m0_bufvec             keven;
+	int                          rc;
+	uint64_t                     version[V_NR] = { 2, 3 };
+	int                          i;
+	struct m0_cas_id             index = {};
+	struct m0_cas_rec_reply      rep;
+	const struct m0_fid          ifid = IFID(2, 3);
+	struct m0_reqh              *reqh;
+	struct m0_reqh_service      *cas;
+	struct m0_cas_compact_stats  before;
+	struct m0_cas_compact_stats  after;
+
+	casc_ut_init(&casc_ut_sctx, &casc_ut_cctx);
+	reqh = &casc_ut_sctx.rsx_motr_ctx.cc_reqh_ctx.rc_reqh;
+	cas = m0_reqh_service_find(&m0_cas_service_type, reqh);
+	M0_UT_ASSERT(cas != NULL);
+	rc = ut_idx_create(&casc_ut_cctx, &ifid, 1, &rep);
+	M0_UT_ASSERT(rc == 0);
+	index.ci_fid = ifid;
+
+	rc = m0_bufvec_alloc(&keys, COUNT, sizeof(uint64_t));
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_bufvec_alloc(&values, keys.ov_vec.v_nr, sizeof(uint64_t));
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_bufvec_alloc(&kodd, keys.ov_vec.v_nr / 2, sizeof(uint64_t));
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_bufvec_alloc(&keven, keys.ov_vec.v_nr / 2, sizeof(uint64_t));
+	M0_UT_ASSERT(rc == 0);
+
+	for (i = 0; i < keys.ov_vec.v_nr; i++) {
+		*(uint64_t*)keys.ov_buf[i] = i;
+		*(uint64_t*)values.ov_buf[i] = i;
+		memcpy(((i & 0x01) == 0 ? &keven : &kodd)->ov_buf[i / 2],
+		       keys.ov_buf[i], keys.ov_vec.v_count[i]);
+	}
+
+	put_get_verified(&index, &keys, &values, &values, version[V_PAST],
+			 COF_VERSIONED | COF_OVERWRITE,
+			 COF_VERSIONED);
+	del_get_verified(&index, &kodd, version[V_FUTURE],
+			 COF_VERSIONED, COF_VERSIONED);
+
+	/* Tombstones are newer than the horizon: nothing is removed. */
+	m0_cas_compact__ut_horizon_set(&(struct m0_dtm0_ts) {
+					.dts_phys = version[V_FUTURE] });
+	m0_cas_compact_stats_get(&before);
+	m0_cas_compact_start(cas);
+	m0_cas_compact_wait_sync();
+	m0_cas_compact_stats_get(&after);
+	M0_UT_ASSERT(after.cs_passes > before.cs_passes);
+	M0_UT_ASSERT(after.cs_removed == before.cs_removed);
+	M0_UT_ASSERT(has_tombstones(&index, &kodd));
+
+	/* All tombstones are behind the horizon. */
+	m0_cas_compact__ut_horizon_set(&(struct m0_dtm0_ts) {
+					.dts_phys = version[V_FUTURE] + 1 });
+	before = after;
+	m0_cas_compact_start(cas);
+	m0_cas_compact_wait_sync();
+	m0_cas_compact_stats_get(&after);
+	M0_UT_ASSERT(after.cs_removed - before.cs_removed == kodd.ov_vec.v_nr);
+	M0_UT_ASSERT(after.cs_txs > before.cs_txs);
+	M0_UT_ASSERT(has_versions(&index, &kodd, 0, COF_VERSIONED));
+	M0_UT_ASSERT(has_versions(&index, &keven,
+				  version[V_PAST], COF_VERSIONED));
+	m0_cas_compact__ut_horizon_set(NULL);
+
+	m0_bufvec_free(&keys);
+	m0_bufvec_free(&values);
+	m0_bufvec_free(&keven);
+	m0_bufvec_free(&kodd);
+
+	rc = ut_idx_delete(&casc_ut_cctx, &ifid, 1, &rep);
+	M0_UT_ASSERT(rc == 0);
+	casc_ut_fini(&casc_ut_sctx, &casc_ut_cctx);
+}
+
+/*
+ * Checks that a volatile catalogue supports the same record operations as the
+ * persistent one and is dropped by the usual index delete.
+ */
+static void volatile_ctg(void)
+{
+	struct m0_cas_rec_reply  rep[COUNT];
+	struct m0_cas_get_reply  get_rep[COUNT];
+	struct m0_cas_next_reply next_rep[COUNT];
+	const struct m0_fid      ifid = IFID(2, 3);
+	struct m0_cas_id         index = {};
+	struct m0_bufvec         keys;
+	struct m0_bufvec         values;
+	struct m0_bufvec         start_key;
+	uint32_t                 recs_nr = COUNT;
+	uint64_t                 rep_count;
+	int                      rc;
+
+	casc_ut_init(&casc_ut_sctx, &casc_ut_cctx);
+	M0_SET_ARR0(rep);
+	M0_SET_ARR0(get_rep);
+	M0_SET_ARR0(next_rep);
+	rc = m0_bufvec_alloc(&keys, COUNT, sizeof(uint64_t));
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_bufvec_alloc(&values, COUNT, sizeof(uint64_t));
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_bufvec_alloc(&start_key, 1, sizeof(uint64_t));
+	M0_UT_ASSERT(rc == 0);
+	m0_forall(i, keys.ov_vec.v_nr, (*(uint64_t*)keys.ov_buf[i]   = i,
+					*(uint64_t*)values.ov_buf[i] = i * i,
+					true));
+	value_create(start_key.ov_vec.v_count[0], 0, start_key.ov_buf[0]);
+
+	rc = ut_idx_flagged_create(&casc_ut_cctx, &ifid, 1, rep, COF_VOLATILE);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(rep[0].crr_rc == 0);
+	rc = ut_lookup_idx(&casc_ut_cctx, &ifid, 1, rep);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(rep[0].crr_rc == 0);
+	/* Neither volatile nor persistent catalogue can shadow it. */
+	rc = ut_idx_flagged_create(&casc_ut_cctx, &ifid, 1, rep, COF_VOLATILE);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(rep[0].crr_rc == -EEXIST);
+	rc = ut_idx_create(&casc_ut_cctx, &ifid, 1, rep);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(rep[0].crr_rc == -EEXIST);
+
+	index.ci_fid = ifid;
+	rc = ut_rec_put(&casc_ut_cctx, &index, &keys, &values, rep, 0);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_forall(i, COUNT, rep[i].crr_rc == 0));
+	rc = ut_rec_put(&casc_ut_cctx, &index, &keys, &values, rep, 0);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_forall(i, COUNT, rep[i].crr_rc == -EEXIST));
+	rc = ut_rec_get(&casc_ut_cctx, &index, &keys, get_rep);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_forall(i, COUNT, get_rep[i].cge_rc == 0 &&
+			       memcmp(get_rep[i].cge_val.b_addr,
+				      values.ov_buf[i],
+				      values.ov_vec.v_count[i]) == 0));
+	ut_get_rep_clear(get_rep, COUNT);
+	rc = ut_next_rec(&casc_ut_cctx, &index, &start_key, &recs_nr, next_rep,
+			 &rep_count, 0);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(rep_count == COUNT);
+	M0_UT_ASSERT(m0_forall(i, rep_count,
+			       next_rep[i].cnp_rc == 0 &&
+			       next_rep_equals(&next_rep[i], keys.ov_buf[i],
+					       values.ov_buf[i])));
+	ut_next_rep_clear(next_rep, rep_count);
+	rc = ut_rec_del(&casc_ut_cctx, &index, &keys, rep, 0);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_forall(i, COUNT, rep[i].crr_rc == 0));
+	rc = ut_rec_get(&casc_ut_cctx, &index, &keys, get_rep);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_forall(i, COUNT, get_rep[i].cge_rc == -ENOENT));
+
+	rc = ut_idx_delete(&casc_ut_cctx, &ifid, 1, rep);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(rep[0].crr_rc == 0);
+	rc = ut_lookup_idx(&casc_ut_cctx, &ifid, 1, rep);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(rep[0].crr_rc == -ENOENT);
+
+	m0_bufvec_free(&start_key);
+	m0_bufvec_free(&keys);
+	m0_bufvec_free(&values);
+	casc_ut_fini(&casc_ut_sctx, &casc_ut_cctx);
+}
+
 static void del(void)
 {
 	struct m0_bufvec keys;
@@ -3290,6 +3601,116 @@ static void del_n(void)
 	casc_ut_fini(&casc_ut_sctx, &casc_ut_cctx);
 }
 
+static int ut_rec_multi(struct cl_ctx           *cctx,
+			struct m0_cas_id        *ids,
+			const uint64_t          *recs_nr,
+			uint32_t                 ids_nr,
+			struct m0_bufvec        *keys,
+			const struct m0_bufvec  *values,
+			struct m0_cas_rec_reply *rep)
+{
+	struct m0_cas_req  req;
+	int                rc;
+	uint64_t           i;
+
+	M0_SET0(&req);
+	m0_cas_req_init(&req, &cctx->cl_rpc_ctx.rcx_session,
+			m0_locality0_get()->lo_grp);
+	m0_clink_init(&cctx->cl_wait.aw_clink, NULL);
+	m0_clink_add_lock(&req.ccr_sm.sm_chan, &cctx->cl_wait.aw_clink);
+
+	m0_cas_req_lock(&req);
+	rc = values != NULL ?
+		m0_cas_multi_put(&req, ids, recs_nr, ids_nr, keys, values,
+				 NULL, 0) :
+		m0_cas_multi_del(&req, ids, recs_nr, ids_nr, keys, NULL, 0);
+	if (rc == 0) {
+		m0_cas_req_wait(&req, M0_BITS(CASREQ_FINAL), M0_TIME_NEVER);
+		rc = m0_cas_req_generic_rc(&req);
+		if (rc == 0) {
+			M0_UT_ASSERT(m0_cas_req_nr(&req) == keys->ov_vec.v_nr);
+			for (i = 0; i < keys->ov_vec.v_nr; i++)
+				(values != NULL ? m0_cas_put_rep :
+				 m0_cas_del_rep)(&req, i, &rep[i]);
+		}
+	}
+	m0_cas_req_unlock(&req);
+	m0_clink_del_lock(&cctx->cl_wait.aw_clink);
+	m0_cas_req_fini_lock(&req);
+	m0_clink_fini(&cctx->cl_wait.aw_clink);
+	return rc;
+}
+
+static void multi_ctg(void)
+{
+	struct m0_cas_rec_reply rep[COUNT];
+	struct m0_cas_get_reply get_rep[COUNT];
+	const struct m0_fid     ifids[2] = { IFID(2, 3), IFID(2, 4) };
+	struct m0_cas_id        ids[2] = {};
+	uint64_t                recs_nr[2] = { COUNT / 2, COUNT - COUNT / 2 };
+	struct m0_bufvec        keys;
+	struct m0_bufvec        values;
+	struct m0_bufvec        k[2];
+	uint64_t                i;
+	int                     rc;
+
+	casc_ut_init(&casc_ut_sctx, &casc_ut_cctx);
+	rc = m0_bufvec_alloc(&keys, COUNT, sizeof(uint64_t));
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_bufvec_alloc(&values, COUNT, sizeof(uint64_t));
+	M0_UT_ASSERT(rc == 0);
+	m0_forall(i, keys.ov_vec.v_nr, (*(uint64_t*)keys.ov_buf[i]   = i,
+					*(uint64_t*)values.ov_buf[i] = i * i,
+					true));
+	/* Keys of each index. */
+	k[0] = M0_BUFVEC_INIT_BUF(keys.ov_buf, keys.ov_vec.v_count);
+	k[0].ov_vec.v_nr = recs_nr[0];
+	k[1] = M0_BUFVEC_INIT_BUF(keys.ov_buf + recs_nr[0],
+				  keys.ov_vec.v_count + recs_nr[0]);
+	k[1].ov_vec.v_nr = recs_nr[1];
+
+	M0_SET_ARR0(rep);
+	rc = ut_idx_create(&casc_ut_cctx, ifids, 2, rep);
+	M0_UT_ASSERT(rc == 0);
+	for (i = 0; i < 2; i++)
+		ids[i].ci_fid = ifids[i];
+
+	/* Insert records into both indices with the single fop. */
+	rc = ut_rec_multi(&casc_ut_cctx, ids, recs_nr, 2, &keys, &values, rep);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_forall(i, COUNT, rep[i].crr_rc == 0));
+	for (i = 0; i < 2; i++) {
+		rc = ut_rec_get(&casc_ut_cctx, &ids[i], &k[i], get_rep);
+		M0_UT_ASSERT(rc == 0);
+		M0_UT_ASSERT(m0_forall(j, recs_nr[i], get_rep[j].cge_rc == 0 &&
+			*(uint64_t *)get_rep[j].cge_val.b_addr ==
+			*(uint64_t *)values.ov_buf[j + i * recs_nr[0]]));
+		ut_get_rep_clear(get_rep, recs_nr[i]);
+		/* Records of the other index are not inserted here. */
+		rc = ut_rec_get(&casc_ut_cctx, &ids[i], &k[1 - i], get_rep);
+		M0_UT_ASSERT(rc == 0);
+		M0_UT_ASSERT(m0_forall(j, recs_nr[1 - i],
+				       get_rep[j].cge_rc == -ENOENT));
+	}
+
+	/* Delete records from both indices with the single fop. */
+	rc = ut_rec_multi(&casc_ut_cctx, ids, recs_nr, 2, &keys, NULL, rep);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_forall(i, COUNT, rep[i].crr_rc == 0));
+	for (i = 0; i < 2; i++) {
+		rc = ut_rec_get(&casc_ut_cctx, &ids[i], &k[i], get_rep);
+		M0_UT_ASSERT(rc == 0);
+		M0_UT_ASSERT(m0_forall(j, recs_nr[i],
+				       get_rep[j].cge_rc == -ENOENT));
+	}
+
+	rc = ut_idx_delete(&casc_ut_cctx, ifids, 2, rep);
+	M0_UT_ASSERT(rc == 0);
+	m0_bufvec_free(&keys);
+	m0_bufvec_free(&values);
+	casc_ut_fini(&casc_ut_sctx, &casc_ut_cctx);
+}
+
 static void null_value(void)
 {
 	struct m0_cas_rec_reply  rep[COUNT];
@@ -3911,6 +4332,7 @@ struct m0_ut_suite cas_client_ut = {
 		{ "next-multi",             next_multi,             "Egor"   },
 		{ "next-bulk",              next_bulk,              "Leonid" },
 		{ "next-multi-bulk",        next_multi_bulk,        "Leonid" },
+		{ "next-filter",            next_filter,            "Leonid" },
 		{ "put",                    put,                    "Leonid" },
 		{ "put-bulk",               put_bulk,               "Leonid" },
 		{ "put-create",             put_create,             "Sergey" },
@@ -3928,6 +4350,7 @@ struct m0_ut_suite cas_client_ut = {
 		{ "del-fail",               del_fail,               "Leonid" },
 		{ "delN",                   del_n,                  "Leonid" },
 		{ "null-value",             null_value,             "Egor"   },
+		{ "multi-ctg",              multi_ctg,              "Leonid" },
 		{ "idx-tree-insert",        idx_tree_insert,        "Leonid" },
 		{ "idx-tree-delete",        idx_tree_delete,        "Leonid" },
 		{ "idx-tree-delete-fail",   idx_tree_delete_fail,   "Leonid" },
@@ -3942,6 +4365,8 @@ struct m0_ut_suite cas_client_ut = {
 		{ "put-del-ver",            put_del_ver,            "Ivan"   },
 		{ "next-ver-exposed",       next_ver_exposed,       "Ivan"   },
 		{ "get-ver-exposed",        get_ver_exposed,        "Ivan"   },
+		{ "compact-ver",            compact_ver,            "Ivan"   },
+		{ "volatile-ctg",           volatile_ctg,           "Leonid" },
 		{ NULL, NULL }
 	}
 };
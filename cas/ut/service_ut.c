@@ -38,9 +38,12 @@
 #include "reqh/reqh.h"
 #include "reqh/reqh_service.h"
 #include "be/ut/helper.h"                 /* m0_be_ut_backend */
+#include "ut/be.h"                        /* m0_ut_be_tx_begin */
 
 #include "cas/cas.h"
 #include "cas/cas_xc.h"
+#include "cas/ctg_store.h"                /* m0_ctg_filter_enable */
+#include "cas/index_gc.h"                 /* m0_cas_gc_rate_set */
 #include "rpc/at.h"
 #include "fdmi/fdmi.h"
 #include "rpc/rpc_machine.h"
@@ -657,6 +660,155 @@ static void cctg_create_delete(void)
 	fini();
 }
 
+static int ctidx_raw_put_cb(struct m0_btree_cb *cb, struct m0_btree_rec *rec)
+{
+	struct m0_btree_rec *datum = cb->c_datum;
+
+	m0_bufvec_copy(&rec->r_key.k_data, &datum->r_key.k_data,
+		       m0_vec_count(&datum->r_key.k_data.ov_vec));
+	m0_bufvec_copy(&rec->r_val, &datum->r_val,
+		       m0_vec_count(&datum->r_val.ov_vec));
+	return 0;
+}
+
+/**
+ * Test that a component catalogue layout stored in ctidx before partitioned
+ * and erasure-coded layouts were added is read back.
+ */
+static void cctg_old_layout(void)
+{
+	/* DIX_LTYPE_DESCR m0_dix_layout as it was stored in ctidx. */
+	struct old_layout {
+		uint32_t dl_type;
+		struct {
+			uint32_t            ld_hash_fnc;
+			struct m0_fid       ld_pver;
+			struct m0_dix_imask ld_imask;
+		} dl_desc;
+	};
+	struct {
+		uint64_t      k_len;
+		struct m0_fid k_fid;
+	}                       kdata = {
+		.k_len = sizeof(struct m0_fid),
+		.k_fid = TFID(1, 1),
+	};
+	struct {
+		uint64_t          v_len;
+		struct m0_crv     v_ver;
+		struct old_layout v_layout;
+	}                       vdata;
+	void                   *k_ptr = &kdata;
+	void                   *v_ptr = &vdata;
+	m0_bcount_t             ksize = sizeof kdata;
+	m0_bcount_t             vsize = sizeof vdata;
+	struct m0_btree_rec     rec = {
+		.r_key.k_data = M0_BUFVEC_INIT_BUF(&k_ptr, &ksize),
+		.r_val        = M0_BUFVEC_INIT_BUF(&v_ptr, &vsize),
+		.r_crc_type   = M0_BCT_NO_CRC,
+	};
+	struct m0_btree_cb      put_cb = {
+		.c_act   = ctidx_raw_put_cb,
+		.c_datum = &rec,
+	};
+	struct m0_btree_op      kv_op  = {};
+	struct m0_be_tx_credit  cred   = {};
+	struct m0_be_tx         tx;
+	struct m0_cas_id        cid    = { .ci_fid = TFID(1, 1) };
+	struct m0_dix_layout    layout;
+	struct m0_btree        *btree;
+	int                     rc;
+
+	M0_CASSERT(sizeof(struct old_layout) == 48);
+	init();
+	M0_SET0(&vdata);
+	vdata.v_len = sizeof vdata.v_layout;
+	vdata.v_ver = M0_CRV_INIT_NONE;
+	vdata.v_layout.dl_type = DIX_LTYPE_DESCR;
+	vdata.v_layout.dl_desc.ld_hash_fnc = HASH_FNC_CITY;
+	vdata.v_layout.dl_desc.ld_pver = M0_FID_INIT(10, 10);
+
+	btree = m0_ctg_ctidx()->cc_tree;
+	m0_btree_put_credit(btree, 1, ksize, vsize, &cred);
+	m0_ut_be_tx_begin(&tx, &be, &cred);
+	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op, m0_btree_put(btree, &rec,
+							   &put_cb, &kv_op,
+							   &tx));
+	M0_UT_ASSERT(rc == 0);
+	m0_ut_be_tx_end(&tx);
+
+	rc = m0_ctg_ctidx_lookup_sync(&cid.ci_fid, &layout);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(layout.dl_type == DIX_LTYPE_DESCR);
+	M0_UT_ASSERT(layout.u.dl_desc.ld_hash_fnc == HASH_FNC_CITY);
+	M0_UT_ASSERT(m0_fid_eq(&layout.u.dl_desc.ld_pver,
+			       &M0_FID_INIT(10, 10)));
+	M0_UT_ASSERT(m0_dix_imask_is_empty(&layout.u.dl_desc.ld_imask));
+	M0_UT_ASSERT(layout.u.dl_desc.ld_ranges.dr_nr == 0);
+	M0_UT_ASSERT(layout.u.dl_desc.ld_ec_data == 0);
+
+	/* The record is served and deleted by CAS service too. */
+	cid.ci_layout.dl_type = DIX_LTYPE_DESCR;
+	cid.ci_layout.u.dl_desc.ld_hash_fnc = HASH_FNC_CITY;
+	cid.ci_layout.u.dl_desc.ld_pver = M0_FID_INIT(10, 10);
+	meta_cid_submit(&cas_get_fopt, &cid);
+	M0_UT_ASSERT(rep_check(0, 0, BUNSET, BUNSET));
+	meta_cid_submit(&cas_del_fopt, &cid);
+	M0_UT_ASSERT(rep_check(0, 0, BUNSET, BUNSET));
+	rc = m0_ctg_ctidx_lookup_sync(&cid.ci_fid, &layout);
+	M0_UT_ASSERT(rc == -ENOENT);
+	fini();
+}
+
+/**
+ * Test that partitions and the number of data fragments of a layout survive
+ * the ctidx round trip.
+ */
+static void cctg_range_layout(void)
+{
+	struct m0_cas_id     cid = { .ci_fid = TFID(1, 1) };
+	struct m0_dix_ldesc *desc = &cid.ci_layout.u.dl_desc;
+	struct m0_dix_ldesc *stored;
+	struct m0_dix_layout layout;
+	struct m0_buf        bounds[] = {
+		M0_BUF_INITS("g"),
+		M0_BUF_INITS("p"),
+	};
+	uint32_t             i;
+	int                  rc;
+
+	init();
+	cid.ci_layout.dl_type = DIX_LTYPE_DESCR;
+	rc = m0_dix_ldesc_range_init(desc, bounds, ARRAY_SIZE(bounds),
+				     &M0_FID_INIT(10, 10));
+	M0_UT_ASSERT(rc == 0);
+	m0_dix_ldesc_ec_set(desc, 2);
+	meta_cid_submit(&cas_put_fopt, &cid);
+	M0_UT_ASSERT(rep_check(0, 0, BUNSET, BUNSET));
+
+	rc = m0_ctg_ctidx_lookup_sync(&cid.ci_fid, &layout);
+	M0_UT_ASSERT(rc == 0);
+	stored = &layout.u.dl_desc;
+	M0_UT_ASSERT(stored->ld_hash_fnc == desc->ld_hash_fnc);
+	M0_UT_ASSERT(stored->ld_ec_data == 2);
+	M0_UT_ASSERT(stored->ld_ranges.dr_nr == desc->ld_ranges.dr_nr);
+	for (i = 0; i < desc->ld_ranges.dr_nr; i++) {
+		M0_UT_ASSERT(m0_buf_eq(&stored->ld_ranges.dr_part[i].dr_start,
+				       &desc->ld_ranges.dr_part[i].dr_start));
+		M0_UT_ASSERT(stored->ld_ranges.dr_part[i].dr_group ==
+			     desc->ld_ranges.dr_part[i].dr_group);
+	}
+	/* Stored and received layouts match. */
+	meta_cid_submit(&cas_get_fopt, &cid);
+	M0_UT_ASSERT(rep_check(0, 0, BUNSET, BUNSET));
+	meta_cid_submit(&cas_del_fopt, &cid);
+	M0_UT_ASSERT(rep_check(0, 0, BUNSET, BUNSET));
+	rc = m0_ctg_ctidx_lookup_sync(&cid.ci_fid, &layout);
+	M0_UT_ASSERT(rc == -ENOENT);
+	m0_dix_ldesc_fini(desc);
+	fini();
+}
+
 /**
  * Test index creation and index lookup.
  */
@@ -1178,6 +1330,69 @@ static void lookup_restart(void)
 	fini();
 }
 
+/**
+ * Test lookups with catalogue key filter.
+ */
+static void lookup_filter(void)
+{
+	uint64_t neg_nr;
+
+	m0_ctg_filter_enable(true);
+	init();
+	meta_fid_submit(&cas_put_fopt, &ifid);
+	insert_odd(&ifid);
+	neg_nr = m0_ctg_filter_neg_nr();
+	lookup_all(&ifid);
+	M0_UT_ASSERT(m0_ctg_filter_neg_nr() > neg_nr);
+	/* The filter is updated by inserts and deletes. */
+	index_op(&cas_put_fopt, &ifid, CB(2), 4);
+	M0_UT_ASSERT(rep_check(0, 0, BUNSET, BUNSET));
+	index_op(&cas_get_fopt, &ifid, CB(2), NOVAL);
+	M0_UT_ASSERT(rep_check(0, 0, BUNSET, BSET));
+	index_op(&cas_del_fopt, &ifid, CB(1), NOVAL);
+	M0_UT_ASSERT(rep_check(0, 0, BUNSET, BUNSET));
+	index_op(&cas_get_fopt, &ifid, CB(1), NOVAL);
+	M0_UT_ASSERT(rep_check(0, -ENOENT, BUNSET, BUNSET));
+	fini();
+	m0_ctg_filter_enable(false);
+}
+
+/**
+ * Test a catalogue with the adaptive node size, before and after restart.
+ */
+static void node_size_adaptive(void)
+{
+	int result;
+
+	M0_UT_ASSERT(m0_ctg_node_size(0) == m0_pagesize_get());
+	M0_UT_ASSERT(m0_ctg_node_size(1 << 20) == M0_CTG_ROOT_NODE_SIZE);
+	M0_UT_ASSERT(m0_ctg_node_size(500) > m0_ctg_node_size(50));
+	m0_ctg_node_size_adaptive(true, 2 * sizeof(uint64_t));
+	init();
+	meta_fid_submit(&cas_put_fopt, &ifid);
+	insert_odd(&ifid);
+	lookup_all(&ifid);
+	service_stop();
+
+	m0_reqh_rpc_mach_tlink_init_at_tail(&rpc_machine,
+					    &reqh.rh_rpc_machines);
+
+	result = m0_reqh_service_allocate(&fdmi, &m0_fdmi_service_type, NULL);
+	M0_UT_ASSERT(result == 0);
+	m0_reqh_service_init(fdmi, &reqh, NULL);
+	result = m0_reqh_service_start(fdmi);
+	M0_UT_ASSERT(result == 0);
+
+	result = m0_reqh_service_allocate(&cas, &m0_cas_service_type, NULL);
+	M0_UT_ASSERT(result == 0);
+	m0_reqh_service_init(cas, &reqh, NULL);
+	m0_cas__ut_svc_be_set(cas, &be.but_dom);
+	m0_reqh_service_start(cas);
+	lookup_all(&ifid);
+	fini();
+	m0_ctg_node_size_adaptive(false, 0);
+}
+
 /**
  * Test iteration over multiple values (with restart).
  */
@@ -1951,6 +2166,48 @@ static void create_insert_drop_fail()
 	create_insert_drop_with_fail(true);
 }
 
+/**
+ * Checks that a big catalogue is destroyed in several paced transactions.
+ */
+static void create_insert_drop_paced(void)
+{
+	struct m0_cas_id       nonce0 = { .ci_fid = IFID(2, 3) };
+	struct m0_cas_gc_stats before;
+	struct m0_cas_gc_stats after;
+	int                    i;
+
+	init();
+	m0_cas_gc_rate_set(1, M0_TIME_ONE_MSEC);
+	meta_fop_submit(&cas_put_fopt,
+			(struct meta_rec[]) {
+				{ .cid = nonce0 } },
+			1);
+	M0_UT_ASSERT(rep.cgr_rc == 0);
+	for (i = 0 ; i < BIG_ROWS_NUMBER ; ++i) {
+		index_op(&cas_put_fopt, &nonce0.ci_fid, i+1, i+2);
+		M0_UT_ASSERT(rep.cgr_rc == 0);
+		M0_UT_ASSERT(rep_check(0, 0, BUNSET, BUNSET));
+	}
+	m0_cas_gc_stats_get(&before);
+	meta_fop_submit(&cas_del_fopt,
+			(struct meta_rec[]) {
+				{ .cid = nonce0 } },
+			1);
+	M0_UT_ASSERT(rep.cgr_rc == 0);
+	meta_fop_submit(&cas_gc_fopt,
+			(struct meta_rec[]) {
+				{ .cid = nonce0 }},
+			1);
+	m0_cas_gc_stats_get(&after);
+	M0_UT_ASSERT(after.gs_ctgs == before.gs_ctgs + 1);
+	M0_UT_ASSERT(after.gs_txs > before.gs_txs + 1);
+	M0_UT_ASSERT(after.gs_nodes - before.gs_nodes ==
+		     after.gs_txs - before.gs_txs);
+	M0_UT_ASSERT(after.gs_paused > before.gs_paused);
+	m0_cas_gc_rate_set(0, 0);
+	fini();
+}
+
 static void init_cgc_fail_fini(void)
 {
 	m0_fi_enable_once("cgc_fom_tick", "fail_in_cgc_generic_phase");
@@ -1999,6 +2256,8 @@ struct m0_ut_suite cas_service_ut = {
 		{ "delete-2",                &delete_2,              "Nikita" },
 		{ "lookup-N",                &lookup_N,              "Nikita" },
 		{ "lookup-restart",          &lookup_restart,        "Nikita" },
+		{ "lookup-filter",           &lookup_filter,         "Nikita" },
+		{ "node-size-adaptive",      &node_size_adaptive,    "Nikita" },
 		{ "cur-N",                   &cur_N,                 "Nikita" },
 		{ "meta-mt",                 &meta_mt,               "Nikita" },
 		{ "meta-insert-fail",        &meta_insert_fail,      "Leonid" },
@@ -2017,10 +2276,13 @@ struct m0_ut_suite cas_service_ut = {
 		{ "multi-create-drop",       &multi_create_drop,     "Eugene" },
 		{ "create-insert-drop",      &create_insert_drop,    "Eugene" },
 		{ "create-insert-drop-fail", &create_insert_drop_fail, "Hua"  },
+		{ "insert-drop-paced", &create_insert_drop_paced, "Leonid" },
 		{ "init-cgc-fail-fini",      &init_cgc_fail_fini,    "Hua"    },
 		{ "cctg-create",             &cctg_create,           "Sergey" },
 		{ "cctg-create-lookup",      &cctg_create_lookup,    "Sergey" },
 		{ "cctg-create-delete",      &cctg_create_delete,    "Sergey" },
+		{ "cctg-old-layout",         &cctg_old_layout,       "Nikita" },
+		{ "cctg-range-layout",       &cctg_range_layout,     "Nikita" },
 		{ "server-restart-nomkfs",   &server_restart_nomkfs, "Egor"   },
 		{ NULL, NULL }
 	}
@@ -464,6 +464,7 @@ M0_INTERNAL void m0_cm_ag_out_interval(const struct m0_cm *cm,
 	ag = m0_cm_ag_out_lo(cm);
 	if (ag != NULL)
 		m0_cm_ag_id_copy(&out_interval->sw_lo, &ag->cag_id);
+	m0_cm_cp_pumps_out_lo(cm, &out_interval->sw_lo);
 }
 
 static void cm_ag_get(struct m0_cm_aggr_group *ag)
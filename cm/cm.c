@@ -366,11 +366,11 @@
    there is a possibilty that the copy machine operation is in-progress while
    the reqh is being shutdown, this situation is taken care by
    m0_reqh_shutdown() mechanism as mentioned above. Thus the copy machine pump
-   FOM (m0_cm::cm_cp_pump) is created when copy machine operation starts and
-   destroyed when copy machine operation stops, until then it is alive within
-   the reqh. Thus using m0_reqh_shutdown_wait() mechanism we are sure that copy
-   machine is IDLE and operation is completed before the m0_cm_fini() is
-   invoked.
+   FOMs (m0_cm::cm_cp_pump[]) are created when copy machine operation starts
+   and destroyed when copy machine operation stops, until then they are alive
+   within the reqh. Thus using m0_reqh_shutdown_wait() mechanism we are sure
+   that copy machine is IDLE and operation is completed before the m0_cm_fini()
+   is invoked.
    @note Presently services are stopped only during reqh shutdown.
 
    @subsection CMDLD-lspec-thread Threading and Concurrency Model
@@ -1051,7 +1051,7 @@ M0_INTERNAL int m0_cm_data_next(struct m0_cm *cm, struct m0_cm_cp *cp)
 
 M0_INTERNAL bool m0_cm_has_more_data(const struct m0_cm *cm)
 {
-	return !m0_cm_cp_pump_is_complete(&cm->cm_cp_pump);
+	return !m0_cm_cp_pumps_are_complete(cm);
 }
 
 M0_INTERNAL struct m0_net_buffer *m0_cm_buffer_get(struct m0_net_buffer_pool
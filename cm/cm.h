@@ -253,8 +253,14 @@ struct m0_cm {
 	uint64_t                         cm_nr_proxy_updated;
 	uint64_t                         cm_proxy_active_nr;
 
-	/** Copy packet pump FOM for this copy machine. */
-	struct m0_cm_cp_pump             cm_cp_pump;
+	/**
+	 * Copy packet pump FOMs for this copy machine, cm_cp_pump[0] is the
+	 * primary one.
+	 */
+	struct m0_cm_cp_pump             cm_cp_pump[M0_CM_PUMP_MAX];
+
+	/** Number of pumps in use, set by m0_cm_cp_pump_prepare(). */
+	uint32_t                         cm_pump_nr;
 
 	struct m0_cm_sw_update           cm_sw_update;
 
@@ -314,9 +320,21 @@ struct m0_cm_ops {
 	 * with meta data of next data object to be restructured, i.e. fid,
 	 * aggregation group, &c.
 	 * Also attaches data buffer to m0_cm_cp::c_data, if successful.
+	 *
+	 * With several pumps, copy packets of different pumps
+	 * (m0_cm_cp::c_pump) come in any interleaving. Each pump has to be
+	 * given the next item of its own partition of the data set, in
+	 * increasing aggregation group order within the partition. A pump
+	 * waiting in cmo_data_next() (M0_FSO_WAIT) doesn't hold the others.
 	 */
 	int (*cmo_data_next)(struct m0_cm *cm, struct m0_cm_cp *cp);
 
+	/**
+	 * Returns the number of pump FOMs the copy machine can partition its
+	 * data set for. Optional, a single pump is used if NULL.
+	 */
+	uint32_t (*cmo_pump_nr)(struct m0_cm *cm);
+
 	/**
 	 * Calculates next relevant aggregation group id and returns it in
 	 * the "id_next".
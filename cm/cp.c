@@ -517,7 +517,8 @@ static struct m0_sm_state_descr m0_cm_cp_state_descr[] = {
 	[M0_CCP_TX_DONE] = {
 		.sd_flags       = 0,
 		.sd_name        = "TX Done",
-		.sd_allowed     = M0_BITS(M0_CCP_IO_WAIT, M0_CCP_FAIL)
+		.sd_allowed     = M0_BITS(M0_CCP_WRITE, M0_CCP_IO_WAIT,
+					  M0_CCP_FAIL)
 	},
 	[M0_CCP_IO_WAIT] = {
 		.sd_flags       = 0,
@@ -174,6 +174,12 @@ struct m0_cm_cp {
 	/** Index of this copy packet in aggregation group. */
 	uint64_t                   c_ag_cp_idx;
 
+	/**
+	 * Index of the pump (in m0_cm::cm_cp_pump[]) which has created the
+	 * copy packet, it's 0 for the copy packets received from the network.
+	 */
+	uint32_t                   c_pump;
+
 	/**
 	 * Bitmap of the indices of copy packets in an aggregation
 	 * group that have been transformed to this resultant copy packet.
@@ -35,10 +35,12 @@
 #include "motr/setup.h" /* CS_MAX_EP_ADDR_LEN */
 #include "fop/fom.h"
 
+#include "addb2/addb2.h"
 #include "cm/cm.h"
 #include "cm/cp.h"
 #include "cm/proxy.h"
 #include "cm/ag.h"
+#include "cm/addb2.h"
 
 /**
    @addtogroup CMPROXY
@@ -104,6 +106,12 @@ M0_INTERNAL int m0_cm_proxy_init(struct m0_cm_proxy *proxy, uint64_t px_id,
 	proxy->px_endpoint = endpoint;
 	proxy->px_is_done = false;
 	proxy->px_epoch = 0;
+	proxy->px_wnd = M0_CM_PROXY_WND_INIT;
+	proxy->px_inflight = 0;
+	proxy->px_done_nr = 0;
+	proxy->px_rate_ts = 0;
+	proxy->px_rate = 0;
+	proxy->px_stall_ts = 0;
 	return 0;
 }
 
@@ -149,6 +157,16 @@ M0_INTERNAL void m0_cm_proxy_cp_add(struct m0_cm_proxy *pxy,
 	M0_LEAVE();
 }
 
+M0_INTERNAL void m0_cm_proxy_cp_park(struct m0_cm_proxy *pxy,
+				     struct m0_cm_cp *cp)
+{
+	M0_PRE(m0_cm_proxy_is_locked(pxy));
+
+	if (pxy->px_stall_ts == 0)
+		pxy->px_stall_ts = m0_time_now();
+	m0_cm_proxy_cp_add(pxy, cp);
+}
+
 static void cm_proxy_cp_del(struct m0_cm_proxy *pxy,
 			    struct m0_cm_cp *cp)
 {
@@ -188,6 +206,11 @@ static void __wake_up_pending_cps(struct m0_cm_proxy *pxy)
 {
 	struct m0_cm_cp *cp;
 
+	if (pxy->px_stall_ts != 0) {
+		M0_ADDB2_ADD(M0_AVI_CM_PROXY_STALL, pxy->px_id,
+			     m0_time_sub(m0_time_now(), pxy->px_stall_ts));
+		pxy->px_stall_ts = 0;
+	}
 	m0_tl_for(proxy_cp, &pxy->px_pending_cps, cp) {
 		cm_proxy_cp_del(pxy, cp);
 		/* wakeup pending copy packet foms */
@@ -643,6 +666,60 @@ M0_INTERNAL uint64_t m0_cm_proxy_nr(struct m0_cm *cm)
 	return proxy_tlist_length(&cm->cm_proxies);
 }
 
+M0_INTERNAL bool m0_cm_proxy_wnd_take(struct m0_cm_proxy *pxy)
+{
+	M0_PRE(m0_cm_proxy_is_locked(pxy));
+
+	if (pxy->px_inflight >= pxy->px_wnd)
+		return false;
+	M0_CNT_INC(pxy->px_inflight);
+	return true;
+}
+
+static void proxy_wnd_resize(struct m0_cm_proxy *pxy, m0_time_t now,
+			     uint64_t bufs_free)
+{
+	m0_time_t elapsed = m0_time_sub(now, pxy->px_rate_ts);
+	uint64_t  rate;
+	uint64_t  wnd;
+	uint64_t  share;
+
+	M0_PRE(elapsed > 0);
+
+	rate = pxy->px_done_nr * M0_TIME_ONE_SECOND / elapsed;
+	pxy->px_rate = pxy->px_rate == 0 ? rate : (pxy->px_rate * 3 + rate) / 4;
+	pxy->px_done_nr = 0;
+	pxy->px_rate_ts = now;
+
+	/* Grows at most twice per interval, to probe for more throughput. */
+	wnd = min64u(pxy->px_rate * M0_CM_PROXY_WND_HORIZON /
+		     M0_TIME_ONE_SECOND, 2 * (uint64_t)pxy->px_wnd);
+	/* Keeps a share of free buffers for the other replicas. */
+	share = bufs_free / max64u(pxy->px_cm->cm_proxy_nr, 1) +
+		pxy->px_inflight;
+	wnd = min64u(wnd, share);
+	pxy->px_wnd = m0_clip64u(M0_CM_PROXY_WND_MIN, M0_CM_PROXY_WND_MAX, wnd);
+	M0_ADDB2_ADD(M0_AVI_CM_PROXY_WND, pxy->px_id, pxy->px_wnd,
+		     pxy->px_rate);
+}
+
+M0_INTERNAL void m0_cm_proxy_wnd_put(struct m0_cm_proxy *pxy,
+				     uint64_t bufs_free)
+{
+	m0_time_t now = m0_time_now();
+
+	M0_PRE(m0_cm_proxy_is_locked(pxy));
+
+	M0_CNT_DEC(pxy->px_inflight);
+	++pxy->px_done_nr;
+	if (pxy->px_rate_ts == 0)
+		pxy->px_rate_ts = now;
+	else if (m0_time_sub(now, pxy->px_rate_ts) >= M0_CM_PROXY_WND_INTERVAL)
+		proxy_wnd_resize(pxy, now, bufs_free);
+	if (pxy->px_inflight < pxy->px_wnd)
+		__wake_up_pending_cps(pxy);
+}
+
 M0_INTERNAL bool m0_cm_proxy_agid_is_in_sw(struct m0_cm_proxy *pxy,
 					   struct m0_cm_ag_id *id)
 {
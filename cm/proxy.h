@@ -54,6 +54,17 @@ enum m0_proxy_state {
 	M0_PX_FAILED    /* 5 */
 };
 
+enum {
+	/** Initial in-flight window of a replica. */
+	M0_CM_PROXY_WND_INIT     = 32,
+	M0_CM_PROXY_WND_MIN      = 4,
+	M0_CM_PROXY_WND_MAX      = 512,
+	/** Interval of throughput measurement of a replica. */
+	M0_CM_PROXY_WND_INTERVAL = 200 * M0_TIME_ONE_MSEC,
+	/** Time in which a replica should complete its in-flight window. */
+	M0_CM_PROXY_WND_HORIZON  = 500 * M0_TIME_ONE_MSEC,
+};
+
 /**
  * Represents remote replica and stores its details including its sliding
  * window.
@@ -109,6 +120,29 @@ struct m0_cm_proxy {
 	 */
 	struct m0_tl            px_pending_cps;
 
+	/**
+	 * Number of copy packets addressed to the replica which may be in
+	 * flight at the same time. Adapted to the observed throughput of
+	 * the replica and local buffer availability.
+	 * @see m0_cm_proxy_wnd_put()
+	 */
+	uint32_t                px_wnd;
+
+	/** Copy packets sent to the replica and not yet completed. */
+	uint32_t                px_inflight;
+
+	/** Copy packets completed since px_rate_ts. */
+	uint64_t                px_done_nr;
+
+	/** Start of the current throughput measurement interval. */
+	m0_time_t               px_rate_ts;
+
+	/** Observed throughput of the replica, copy packets per second. */
+	uint64_t                px_rate;
+
+	/** Since when copy packets wait in px_pending_cps, 0 if they don't. */
+	m0_time_t               px_stall_ts;
+
 	struct m0_mutex         px_mutex;
 
 	struct m0_rpc_conn     *px_conn;
@@ -193,6 +227,34 @@ M0_INTERNAL void m0_cm_proxy_cp_add(struct m0_cm_proxy *pxy,
 
 M0_INTERNAL uint64_t m0_cm_proxy_nr(struct m0_cm *cm);
 
+/**
+ * Parks the copy packet in m0_cm_proxy::px_pending_cps until the sliding
+ * window or the in-flight window of the replica opens.
+ */
+M0_INTERNAL void m0_cm_proxy_cp_park(struct m0_cm_proxy *pxy,
+				     struct m0_cm_cp *cp);
+
+/**
+ * Takes a slot of the in-flight window of the replica for a copy packet
+ * about to be sent.
+ *
+ * @retval false the window is full, the copy packet should be parked.
+ */
+M0_INTERNAL bool m0_cm_proxy_wnd_take(struct m0_cm_proxy *pxy);
+
+/**
+ * Returns the slot taken by m0_cm_proxy_wnd_take() once the copy packet is
+ * delivered (or failed) and wakes up parked copy packets.
+ *
+ * Every M0_CM_PROXY_WND_INTERVAL the window is resized to the number of
+ * copy packets the replica completes in M0_CM_PROXY_WND_HORIZON, so that
+ * a slow replica does not collect a long queue of sends while fast ones
+ * are not limited. The window is further bounded by the replica's share
+ * of bufs_free, the number of free local buffers.
+ */
+M0_INTERNAL void m0_cm_proxy_wnd_put(struct m0_cm_proxy *pxy,
+				     uint64_t bufs_free);
+
 M0_INTERNAL bool m0_cm_proxy_agid_is_in_sw(struct m0_cm_proxy *pxy,
 					   struct m0_cm_ag_id *id);
 
@@ -97,7 +97,12 @@ static const struct m0_fom_type_ops cm_cp_pump_fom_type_ops = {
 
 static struct m0_cm *pump2cm(const struct m0_cm_cp_pump *cp_pump)
 {
-	return container_of(cp_pump, struct m0_cm, cm_cp_pump);
+	return cp_pump->p_cm;
+}
+
+static bool pump_is_primary(const struct m0_cm_cp_pump *cp_pump)
+{
+	return cp_pump->p_idx == 0;
 }
 
 static bool cm_cp_pump_invariant(const struct m0_cm_cp_pump *cp_pump)
@@ -125,6 +130,7 @@ static int cpp_alloc(struct m0_cm_cp_pump *cp_pump)
 		pump_move(cp_pump, -ENOMEM, CPP_FAIL);
 	} else {
 		m0_cm_cp_fom_init(cm, cp, NULL, NULL);
+		cp->c_pump = cp_pump->p_idx;
 		cp_pump->p_cp = cp;
 		pump_move(cp_pump, 0, CPP_DATA_NEXT);
 	}
@@ -149,6 +155,8 @@ static int cpp_data_next(struct m0_cm_cp_pump *cp_pump)
 		goto enodata;
 	}
 	rc = m0_cm_data_next(cm, cp);
+	if (rc == M0_FSO_AGAIN && cp->c_ag != NULL)
+		cp_pump->p_last_ag_id = cp->c_ag->cag_id;
 	if (rc != 0)
 		m0_cm_sw_remote_update(cm);
 enodata:
@@ -187,12 +195,73 @@ enodata:
 	return M0_RC(rc);
 }
 
+static void peer_complete_wakeup(struct m0_sm_group *grp,
+				 struct m0_sm_ast *ast)
+{
+	struct m0_cm_cp_pump *pump = ast->sa_datum;
+
+	if (m0_fom_phase(&pump->p_fom) == CPP_COMPLETE &&
+	    m0_fom_is_waiting(&pump->p_fom))
+		m0_fom_ready(&pump->p_fom);
+}
+
+static void complete_wakeup(struct m0_sm_group *grp, struct m0_sm_ast *ast);
+
+/**
+ * Lets the secondary pumps, waiting in CPP_COMPLETE, finish once the copy
+ * machine operation is complete.
+ */
+static void pumps_finish(struct m0_cm *cm)
+{
+	struct m0_cm_cp_pump *pump;
+	uint32_t              i;
+
+	M0_PRE(m0_cm_is_locked(cm));
+
+	for (i = 1; i < cm->cm_pump_nr; ++i) {
+		pump = &cm->cm_cp_pump[i];
+		pump->p_finish = true;
+		pump->p_wakeup.sa_cb = complete_wakeup;
+		m0_sm_ast_post(&pump->p_fom.fo_loc->fl_group, &pump->p_wakeup);
+	}
+}
+
+/**
+ * A secondary pump has run out of data. It tells the primary one, which
+ * waits for all the pumps before completing the operation, and waits for
+ * pumps_finish().
+ */
+static int cpp_complete_secondary(struct m0_cm_cp_pump *cp_pump)
+{
+	struct m0_cm         *cm = pump2cm(cp_pump);
+	struct m0_cm_cp_pump *primary = &cm->cm_cp_pump[0];
+	bool                  finish;
+	M0_ENTRY("pump=%p idx=%"PRIu32, cp_pump, cp_pump->p_idx);
+
+	m0_cm_lock(cm);
+	if (!cp_pump->p_complete_posted) {
+		cp_pump->p_complete_posted = true;
+		cp_pump->p_peer_wakeup.sa_cb = peer_complete_wakeup;
+		cp_pump->p_peer_wakeup.sa_datum = primary;
+		m0_sm_ast_post(&primary->p_fom.fo_loc->fl_group,
+			       &cp_pump->p_peer_wakeup);
+	}
+	finish = cp_pump->p_finish;
+	m0_cm_unlock(cm);
+	if (!finish)
+		return M0_RC(M0_FSO_WAIT);
+	pump_move(cp_pump, 0, CPP_FINI);
+	return M0_RC(M0_FSO_WAIT);
+}
+
 static int cpp_complete(struct m0_cm_cp_pump *cp_pump)
 {
 	struct m0_cm *cm = pump2cm(cp_pump);
 	int           rc;
 	M0_ENTRY();
 
+	if (!pump_is_primary(cp_pump))
+		return cpp_complete_secondary(cp_pump);
 	m0_cm_lock(cm);
 	M0_LOG(M0_DEBUG, "aggr in = %"PRIx64 " aggr out= %"PRIx64
 			 " swu complete= %d proxy_nr= %"PRIu64,
@@ -202,7 +271,8 @@ static int cpp_complete(struct m0_cm_cp_pump *cp_pump)
 			 cm->cm_proxy_nr);
 
 	if (!m0_cm_aggr_group_tlists_are_empty(cm) ||
-	    !cm->cm_sw_update.swu_is_complete) {
+	    !cm->cm_sw_update.swu_is_complete ||
+	    !m0_cm_cp_pumps_are_complete(cm)) {
 		if (cm->cm_proxy_nr == 0)
 			m0_cm_frozen_ag_cleanup(cm, NULL);
 		m0_cm_sw_remote_update(cm);
@@ -211,6 +281,8 @@ static int cpp_complete(struct m0_cm_cp_pump *cp_pump)
 	}
 
 	rc = m0_cm_complete(cm);
+	if (rc != -EAGAIN)
+		pumps_finish(cm);
 	m0_cm_unlock(cm);
 	if (rc == -EAGAIN)
 		return M0_RC(M0_FSO_WAIT);
@@ -385,7 +457,11 @@ static int (*pump_action[]) (struct m0_cm_cp_pump *cp_pump) = {
 
 static uint64_t cm_cp_pump_fom_locality(const struct m0_fom *fom)
 {
-	return fom->fo_type->ft_id;
+	const struct m0_cm_cp_pump *cp_pump =
+		container_of(fom, struct m0_cm_cp_pump, p_fom);
+
+	/* Pumps of a copy machine run in different localities. */
+	return fom->fo_type->ft_id + cp_pump->p_idx;
 }
 
 static int cm_cp_pump_fom_tick(struct m0_fom *fom)
@@ -423,6 +499,40 @@ bool m0_cm_cp_pump_is_complete(const struct m0_cm_cp_pump *cp_pump)
 						     CPP_STOP));
 }
 
+M0_INTERNAL bool m0_cm_cp_pumps_are_complete(const struct m0_cm *cm)
+{
+	uint32_t i;
+
+	/* Secondary pumps finish without going through CPP_STOP. */
+	for (i = 1; i < cm->cm_pump_nr; ++i) {
+		if (!M0_IN(m0_fom_phase(&cm->cm_cp_pump[i].p_fom),
+			   (CPP_COMPLETE, CPP_FINI)))
+			return false;
+	}
+	return m0_cm_cp_pump_is_complete(&cm->cm_cp_pump[0]);
+}
+
+M0_INTERNAL void m0_cm_cp_pumps_out_lo(const struct m0_cm *cm,
+				       struct m0_cm_ag_id *lo)
+{
+	const struct m0_cm_cp_pump *pump;
+	uint32_t                    i;
+
+	M0_PRE(m0_cm_is_locked(cm));
+
+	if (cm->cm_pump_nr < 2)
+		return;
+	for (i = 0; i < cm->cm_pump_nr; ++i) {
+		pump = &cm->cm_cp_pump[i];
+		if (M0_IN(m0_fom_phase(&pump->p_fom),
+			  (CPP_COMPLETE, CPP_STOP, CPP_FINI)))
+			continue;
+		if (!m0_cm_ag_id_is_set(lo) ||
+		    m0_cm_ag_id_cmp(&pump->p_last_ag_id, lo) < 0)
+			*lo = pump->p_last_ag_id;
+	}
+}
+
 M0_INTERNAL void m0_cm_cp_pump_init(struct m0_cm_type *cmtype)
 {
 	m0_fom_type_init(&cmtype->ct_pump_fomt, cmtype->ct_fom_id + 2,
@@ -433,19 +543,34 @@ M0_INTERNAL void m0_cm_cp_pump_init(struct m0_cm_type *cmtype)
 M0_INTERNAL void m0_cm_cp_pump_prepare(struct m0_cm *cm)
 {
 	struct m0_cm_cp_pump *cp_pump;
+	uint32_t              i;
 	M0_ENTRY("cm = %p", cm);
 
 	M0_PRE(m0_cm_is_locked(cm));
 
-	cp_pump = &cm->cm_cp_pump;
-	m0_cm_cp_pump_bob_init(cp_pump);
-	m0_fom_init(&cp_pump->p_fom, &cm->cm_type->ct_pump_fomt,
-		    &cm_cp_pump_fom_ops, NULL, NULL, cm->cm_service.rs_reqh);
+	cm->cm_pump_nr = cm->cm_ops->cmo_pump_nr == NULL ? 1 :
+		max32u(min32u(cm->cm_ops->cmo_pump_nr(cm), M0_CM_PUMP_MAX), 1);
+	for (i = 0; i < cm->cm_pump_nr; ++i) {
+		cp_pump = &cm->cm_cp_pump[i];
+		m0_cm_cp_pump_bob_init(cp_pump);
+		cp_pump->p_cm = cm;
+		cp_pump->p_idx = i;
+		cp_pump->p_finish = false;
+		cp_pump->p_complete_posted = false;
+		M0_SET0(&cp_pump->p_last_ag_id);
+		m0_fom_init(&cp_pump->p_fom, &cm->cm_type->ct_pump_fomt,
+			    &cm_cp_pump_fom_ops, NULL, NULL,
+			    cm->cm_service.rs_reqh);
+	}
+	M0_LEAVE("pump_nr=%"PRIu32, cm->cm_pump_nr);
 }
 
 M0_INTERNAL void m0_cm_cp_pump_destroy(struct m0_cm *cm)
 {
-	cm_cp_pump_fom_fini(&cm->cm_cp_pump.p_fom);
+	uint32_t i;
+
+	for (i = 0; i < cm->cm_pump_nr; ++i)
+		cm_cp_pump_fom_fini(&cm->cm_cp_pump[i].p_fom);
 }
 
 static void complete_wakeup(struct m0_sm_group *grp, struct m0_sm_ast *ast)
@@ -479,14 +604,20 @@ static bool pump_cb(struct m0_clink *link)
 M0_INTERNAL void m0_cm_cp_pump_start(struct m0_cm *cm)
 {
 	struct m0_cm_cp_pump *cp_pump;
+	uint32_t              i;
 	M0_ENTRY("cm = %p", cm);
 
 	M0_PRE(m0_cm_is_locked(cm));
 
-	cp_pump = &cm->cm_cp_pump;
+	/*
+	 * Only the primary pump waits for m0_cm::cm_complete, the others are
+	 * woken up by pumps_finish().
+	 */
+	cp_pump = &cm->cm_cp_pump[0];
 	m0_clink_init(&cp_pump->p_complete, pump_cb);
 	m0_clink_add(&cm->cm_complete, &cp_pump->p_complete);
-	m0_fom_queue(&cp_pump->p_fom);
+	for (i = 0; i < cm->cm_pump_nr; ++i)
+		m0_fom_queue(&cm->cm_cp_pump[i].p_fom);
 	M0_LEAVE();
 }
 
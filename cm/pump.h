@@ -26,6 +26,7 @@
 #define __MOTR_CM_PUMP_H__
 
 #include "fop/fom.h"
+#include "cm/ag.h"           /* m0_cm_ag_id */
 
 /**
    @addtogroup CM
@@ -45,6 +46,13 @@ struct m0_cm_type;
  * pool is exhausted). When a copy packet FOM terminates and frees its buffer
  * in the pool, it wakes up the pump FOM (using m0_cm_sw_fill()) to create more
  * copy packets.
+ *
+ * A copy machine can run several pump FOMs (see m0_cm_ops::cmo_pump_nr()),
+ * each in its own locality. The copy machine partitions its iteration space
+ * among them: m0_cm_cp::c_pump tells m0_cm_ops::cmo_data_next() which pump,
+ * and so which partition, the copy packet belongs to. Pump 0 is the primary
+ * one: once all the pumps have run out of data, it completes and stops the
+ * copy machine operation, after which the other pumps finish.
  */
 struct m0_cm_cp_pump {
 	/** pump FOM. */
@@ -61,6 +69,29 @@ struct m0_cm_cp_pump {
 	uint64_t               p_magix;
 	struct m0_clink        p_complete;
 	struct m0_sm_ast       p_wakeup;
+	struct m0_cm          *p_cm;
+	/** Index of the pump in m0_cm::cm_cp_pump[]. */
+	uint32_t               p_idx;
+	/**
+	 * Aggregation group of the last copy packet configured by the pump.
+	 * With several pumps, the outgoing sliding window can't start above
+	 * it until the pump completes, see m0_cm_ag_out_interval().
+	 */
+	struct m0_cm_ag_id     p_last_ag_id;
+	/**
+	 * Set on a secondary pump by the primary one, when the copy machine
+	 * operation is complete.
+	 */
+	bool                   p_finish;
+	/** The secondary pump has told the primary one it is complete. */
+	bool                   p_complete_posted;
+	/** Wakes the primary pump up when a secondary pump completes. */
+	struct m0_sm_ast       p_peer_wakeup;
+};
+
+enum {
+	/** Maximum number of pump FOMs of a copy machine. */
+	M0_CM_PUMP_MAX = 8,
 };
 
 M0_INTERNAL void m0_cm_cp_pump_init(struct m0_cm_type *cmtype);
@@ -78,6 +109,14 @@ M0_INTERNAL void m0_cm_cp_pump_destroy(struct m0_cm *cm);
 M0_INTERNAL void m0_cm_cp_pump_wakeup(struct m0_cm *cm);
 
 M0_INTERNAL bool m0_cm_cp_pump_is_complete(const struct m0_cm_cp_pump *cp_pump);
+/** True iff all the pumps of the copy machine have run out of data. */
+M0_INTERNAL bool m0_cm_cp_pumps_are_complete(const struct m0_cm *cm);
+/**
+ * Lowers "lo" to the last aggregation group of the pumps still running, when
+ * the copy machine has several pumps.
+ */
+M0_INTERNAL void m0_cm_cp_pumps_out_lo(const struct m0_cm *cm,
+				       struct m0_cm_ag_id *lo);
 /** @} endgroup CM */
 
 /* __MOTR_CM_PUMP_H__ */
@@ -45,7 +45,26 @@ enum m0_cm_op {
 	CM_OP_REPAIR_STATUS,
 	CM_OP_REBALANCE_STATUS,
 	CM_OP_REPAIR_ABORT,
-	CM_OP_REBALANCE_ABORT
+	CM_OP_REBALANCE_ABORT,
+	CM_OP_REPAIR_THROTTLE,
+	CM_OP_REBALANCE_THROTTLE
+};
+
+/**
+ * Modifiers of copy machine operations, carried in trigger_fop::flags.
+ */
+enum m0_cm_op_flags {
+	/**
+	 * CM_OP_REPAIR repairs most degraded parity groups first.
+	 * @see m0_sns_cm::sc_prio
+	 */
+	CM_OP_FLAG_PRIO   = 1 << 0,
+	/**
+	 * CM_OP_REPAIR writes reconstructed units to their own positions on
+	 * the failed devices, which are already replaced, instead of spares.
+	 * @see m0_sns_cm::sc_direct
+	 */
+	CM_OP_FLAG_DIRECT = 1 << 1,
 };
 
 /**
@@ -162,7 +162,9 @@ static int trigger_fom_tick(struct m0_fom *fom)
 					     CM_OP_REPAIR_ABORT,
 					     CM_OP_REBALANCE_ABORT,
 					     CM_OP_REPAIR_STATUS,
-					     CM_OP_REBALANCE_STATUS))) {
+					     CM_OP_REBALANCE_STATUS,
+					     CM_OP_REPAIR_THROTTLE,
+					     CM_OP_REBALANCE_THROTTLE))) {
 				m0_fom_phase_set(fom, M0_TPH_PREPARE);
 				return M0_FSO_AGAIN;
 			}
@@ -215,6 +217,19 @@ static int prepare(struct m0_fom *fom)
 		return M0_FSO_WAIT;
 	}
 
+	if (M0_IN(treq->op, (CM_OP_REPAIR_THROTTLE,
+			     CM_OP_REBALANCE_THROTTLE))) {
+		struct trigger_rep_fop *trep = m0_fop_data(fom->fo_rep_fop);
+
+		/* Rate limits apply in any copy machine state. */
+		trep->rc = tfom->tf_ops->fto_throttle != NULL ?
+			   tfom->tf_ops->fto_throttle(fom) : M0_ERR(-ENOSYS);
+		m0_rpc_reply_post(m0_fop_to_rpc_item(fom->fo_fop),
+				  m0_fop_to_rpc_item(fom->fo_rep_fop));
+		m0_fom_phase_set(fom, M0_FOPH_FINISH);
+		return M0_FSO_WAIT;
+	}
+
 	m0_cm_lock(cm);
 	cm_state = m0_cm_state_get(cm);
 	m0_cm_unlock(cm);
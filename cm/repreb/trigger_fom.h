@@ -40,6 +40,12 @@ struct m0_fom_trigger_ops {
 	struct m0_fop_type* (*fto_type)(uint32_t op);
 	uint64_t (*fto_progress)(struct m0_fom *fom, bool reinit_counter);
 	void (*fto_prepare)(struct m0_fom *fom);
+	/**
+	 * Applies the rate limits of a CM_OP_*_THROTTLE operation. Optional,
+	 * the operation fails with -ENOSYS if the copy machine has no
+	 * throttle.
+	 */
+	int (*fto_throttle)(struct m0_fom *fom);
 };
 
 struct m0_trigger_fom {
@@ -44,12 +44,29 @@ struct failure_data {
 	uint64_t *fd_index;
 } M0_XCA_SEQUENCE M0_XCA_DOMAIN(rpc);
 
+/**
+ * Rate limits of copy machine I/O carried by CM_OP_*_THROTTLE operations.
+ * Zeroes mean no limit.
+ */
+struct trigger_throttle {
+	/** Bytes per second of a device. */
+	uint64_t tt_bytes_per_sec;
+	/** I/O operations per second of a device. */
+	uint64_t tt_iops;
+	/** Target latency of client I/O, in nanoseconds. */
+	uint64_t tt_latency;
+} M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
+
 /**
  * Simplistic implementation of repair trigger fop for testing purposes
  * only.
  */
 struct trigger_fop {
-	uint32_t op;
+	uint32_t                op;
+	/** Bitmask of enum m0_cm_op_flags. */
+	uint32_t                flags;
+	/** Used by CM_OP_REPAIR_THROTTLE and CM_OP_REBALANCE_THROTTLE only. */
+	struct trigger_throttle throttle;
 } M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
 
 struct trigger_rep_fop {
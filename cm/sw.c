@@ -96,11 +96,11 @@ M0_INTERNAL int m0_cm_sw_onwire_init(struct m0_cm *cm,
 		sw_onwire->swo_cm_status = M0_PX_FAILED;
 	else if (m0_cm_state_get(cm) == M0_CMS_READY)
 			sw_onwire->swo_cm_status = M0_PX_READY;
-	else if ((!m0_cm_cp_pump_is_complete(&cm->cm_cp_pump) ||
+	else if ((!m0_cm_cp_pumps_are_complete(cm) ||
 		 !cm->cm_sw_update.swu_is_complete) &&
 		 m0_cm_state_get(cm) == M0_CMS_ACTIVE)
 			sw_onwire->swo_cm_status = M0_PX_ACTIVE;
-	else if (m0_cm_cp_pump_is_complete(&cm->cm_cp_pump) &&
+	else if (m0_cm_cp_pumps_are_complete(cm) &&
 		 cm->cm_sw_update.swu_is_complete &&
 		 !m0_cm_aggr_group_tlists_are_empty(cm))
 			sw_onwire->swo_cm_status = M0_PX_COMPLETE;
@@ -27,6 +27,7 @@
 
 #include "sns/cm/cm.h"
 #include "cm/ut/common_service.h"  /* cmut_rmach_ctx */
+#include "cm/proxy.h"
 #include "rpc/rpclib.h"            /* m0_rpc_server_ctx */
 #include "lib/fs.h"                /* m0_file_read */
 #include "ut/misc.h"               /* M0_UT_PATH */
@@ -131,7 +132,7 @@ static void cm_setup_ut(void)
 	M0_UT_ASSERT(rc == 0);
 	cm->cm_sw_update.swu_is_complete = true;
 	while (m0_fom_domain_is_idle_for(&cm->cm_service) ||
-	       !m0_cm_cp_pump_is_complete(&cm->cm_cp_pump))
+	       !m0_cm_cp_pumps_are_complete(cm))
                m0_nanosleep(m0_time(0, 200000), NULL);
 
 	m0_cm_lock(cm);
@@ -337,6 +338,52 @@ static void cm_ag_ut(void)
 	cm_ut_service_cleanup();
 }
 
+static void cm_proxy_wnd_ut(void)
+{
+	struct m0_cm_ag_id  id = {};
+	struct m0_cm_proxy  pxy = {};
+	struct m0_cm        cm = {};
+	uint32_t            i;
+	int                 rc;
+
+	cm.cm_proxy_nr = 2;
+	rc = m0_cm_proxy_init(&pxy, 0, &id, &id, "ut-proxy");
+	M0_UT_ASSERT(rc == 0);
+	pxy.px_cm = &cm;
+
+	m0_cm_proxy_lock(&pxy);
+	for (i = 0; i < M0_CM_PROXY_WND_INIT; ++i)
+		M0_UT_ASSERT(m0_cm_proxy_wnd_take(&pxy));
+	M0_UT_ASSERT(!m0_cm_proxy_wnd_take(&pxy));
+	/* The first completion starts throughput measurement. */
+	m0_cm_proxy_wnd_put(&pxy, 1000);
+	M0_UT_ASSERT(pxy.px_wnd == M0_CM_PROXY_WND_INIT);
+	M0_UT_ASSERT(m0_cm_proxy_wnd_take(&pxy));
+
+	/* A fast replica gets a larger window. */
+	pxy.px_done_nr = 10000;
+	pxy.px_rate_ts = m0_time_sub(m0_time_now(), M0_TIME_ONE_SECOND);
+	m0_cm_proxy_wnd_put(&pxy, 1000);
+	M0_UT_ASSERT(pxy.px_wnd == 2 * M0_CM_PROXY_WND_INIT);
+
+	/* ... bounded by its share of free buffers. */
+	pxy.px_done_nr = 10000;
+	pxy.px_rate_ts = m0_time_sub(m0_time_now(), M0_TIME_ONE_SECOND);
+	m0_cm_proxy_wnd_put(&pxy, 20);
+	M0_UT_ASSERT(pxy.px_wnd == 20 / 2 + pxy.px_inflight);
+
+	/* A replica which does not complete anything shrinks to minimum. */
+	pxy.px_rate = 0;
+	pxy.px_rate_ts = m0_time_sub(m0_time_now(), m0_time(10, 0));
+	m0_cm_proxy_wnd_put(&pxy, 1000);
+	M0_UT_ASSERT(pxy.px_wnd == M0_CM_PROXY_WND_MIN);
+	while (pxy.px_inflight > 0)
+		m0_cm_proxy_wnd_put(&pxy, 1000);
+	m0_cm_proxy_unlock(&pxy);
+
+	m0_cm_proxy_fini(&pxy);
+}
+
 struct m0_ut_suite cm_generic_ut = {
         .ts_name = "cm-ut",
         .ts_init = &cm_ut_init,
@@ -349,6 +396,7 @@ struct m0_ut_suite cm_generic_ut = {
 		{ "cm_ready_failure_ut",   cm_ready_failure_ut   },
 		{ "cm_start_failure_ut",   cm_start_failure_ut   },
 		{ "cm_ag_ut",              cm_ag_ut              },
+		{ "cm_proxy_wnd_ut",       cm_proxy_wnd_ut       },
 		{ NULL, NULL }
         }
 };
@@ -40,6 +40,8 @@
 #include "lib/memory.h"
 #include "lib/bitstring.h"
 #include "lib/locality.h"
+#include "lib/mutex.h"
+#include "lib/hash_fnc.h"  /* m0_hash_fnc_fnv1 */
 
 #include "cob/cob.h"
 
@@ -588,6 +590,196 @@ static int omg_cmp(const void *key0, const void *key1)
 }
 
 
+enum {
+	/** Number of entries of each table of m0_cob_cache. */
+	COB_CACHE_NR = 512
+};
+
+/** Cached namespace record. */
+struct cob_cache_ns {
+	/** NULL when the entry is empty. */
+	struct m0_cob_nskey *ccn_key;
+	struct m0_cob_nsrec  ccn_rec;
+};
+
+/** Cached object index record. */
+struct cob_cache_oi {
+	struct m0_cob_oikey  cco_key;
+	/** NULL when the entry is empty. */
+	struct m0_cob_nskey *cco_nskey;
+};
+
+/**
+ * Lookup cache of a cob domain. A new record replaces the one in its slot.
+ */
+struct m0_cob_cache {
+	struct m0_mutex     cc_lock;
+	/**
+	 * Incremented by every invalidation. A lookup inserts its result
+	 * only if no invalidation happened since it started.
+	 */
+	uint64_t            cc_gen;
+	struct cob_cache_ns cc_ns[COB_CACHE_NR];
+	struct cob_cache_oi cc_oi[COB_CACHE_NR];
+};
+
+static void cob_cache_init(struct m0_cob_domain *dom)
+{
+	M0_ALLOC_PTR(dom->cd_cache);
+	if (dom->cd_cache != NULL)
+		m0_mutex_init(&dom->cd_cache->cc_lock);
+}
+
+static void cob_cache_fini(struct m0_cob_domain *dom)
+{
+	struct m0_cob_cache *cache = dom->cd_cache;
+	int                  i;
+
+	if (cache == NULL)
+		return;
+	for (i = 0; i < COB_CACHE_NR; ++i) {
+		m0_free(cache->cc_ns[i].ccn_key);
+		m0_free(cache->cc_oi[i].cco_nskey);
+	}
+	m0_mutex_fini(&cache->cc_lock);
+	m0_free0(&dom->cd_cache);
+}
+
+static struct cob_cache_ns *cob_cache_ns_slot(struct m0_cob_cache *cache,
+					      const struct m0_cob_nskey *key)
+{
+	return &cache->cc_ns[m0_hash_fnc_fnv1(key, m0_cob_nskey_size(key)) %
+			     COB_CACHE_NR];
+}
+
+static struct cob_cache_oi *cob_cache_oi_slot(struct m0_cob_cache *cache,
+					      const struct m0_cob_oikey *key)
+{
+	return &cache->cc_oi[(m0_fid_hash(&key->cok_fid) + key->cok_linkno) %
+			     COB_CACHE_NR];
+}
+
+static struct m0_cob_nskey *cob_nskey_dup(struct m0_cob_nskey *key)
+{
+	struct m0_cob_nskey *dup;
+
+	return m0_cob_nskey_make(&dup, &key->cnk_pfid,
+				 m0_bitstring_buf_get(&key->cnk_name),
+				 m0_bitstring_len_get(&key->cnk_name)) == 0 ?
+		dup : NULL;
+}
+
+/** Returns the generation to pass to the insertion after a tree lookup. */
+static uint64_t cob_cache_gen(struct m0_cob_domain *dom)
+{
+	uint64_t gen;
+
+	m0_mutex_lock(&dom->cd_cache->cc_lock);
+	gen = dom->cd_cache->cc_gen;
+	m0_mutex_unlock(&dom->cd_cache->cc_lock);
+	return gen;
+}
+
+static bool cob_cache_ns_get(struct m0_cob_domain *dom,
+			     const struct m0_cob_nskey *key,
+			     struct m0_cob_nsrec *rec)
+{
+	struct cob_cache_ns *ns;
+	bool                 found;
+
+	if (dom->cd_cache == NULL)
+		return false;
+	m0_mutex_lock(&dom->cd_cache->cc_lock);
+	ns = cob_cache_ns_slot(dom->cd_cache, key);
+	found = ns->ccn_key != NULL && m0_cob_nskey_cmp(ns->ccn_key, key) == 0;
+	if (found)
+		*rec = ns->ccn_rec;
+	m0_mutex_unlock(&dom->cd_cache->cc_lock);
+	return found;
+}
+
+static void cob_cache_ns_put(struct m0_cob_domain *dom,
+			     struct m0_cob_nskey *key,
+			     const struct m0_cob_nsrec *rec, uint64_t gen)
+{
+	struct cob_cache_ns *ns;
+	struct m0_cob_nskey *dup = cob_nskey_dup(key);
+
+	if (dup == NULL)
+		return;
+	m0_mutex_lock(&dom->cd_cache->cc_lock);
+	if (dom->cd_cache->cc_gen == gen) {
+		ns = cob_cache_ns_slot(dom->cd_cache, key);
+		M0_SWAP(ns->ccn_key, dup);
+		ns->ccn_rec = *rec;
+	}
+	m0_mutex_unlock(&dom->cd_cache->cc_lock);
+	m0_free(dup);
+}
+
+/** Returns a copy of the cached namespace key or NULL. */
+static struct m0_cob_nskey *cob_cache_oi_get(struct m0_cob_domain *dom,
+					     const struct m0_cob_oikey *key)
+{
+	struct cob_cache_oi *oi;
+	struct m0_cob_nskey *nskey = NULL;
+
+	if (dom->cd_cache == NULL)
+		return NULL;
+	m0_mutex_lock(&dom->cd_cache->cc_lock);
+	oi = cob_cache_oi_slot(dom->cd_cache, key);
+	if (oi->cco_nskey != NULL && m0_fid_eq(&oi->cco_key.cok_fid,
+					       &key->cok_fid) &&
+	    oi->cco_key.cok_linkno == key->cok_linkno)
+		nskey = cob_nskey_dup(oi->cco_nskey);
+	m0_mutex_unlock(&dom->cd_cache->cc_lock);
+	return nskey;
+}
+
+static void cob_cache_oi_put(struct m0_cob_domain *dom,
+			     const struct m0_cob_oikey *key,
+			     struct m0_cob_nskey *nskey, uint64_t gen)
+{
+	struct cob_cache_oi *oi;
+	struct m0_cob_nskey *dup = cob_nskey_dup(nskey);
+
+	if (dup == NULL)
+		return;
+	m0_mutex_lock(&dom->cd_cache->cc_lock);
+	if (dom->cd_cache->cc_gen == gen) {
+		oi = cob_cache_oi_slot(dom->cd_cache, key);
+		oi->cco_key = *key;
+		M0_SWAP(oi->cco_nskey, dup);
+	}
+	m0_mutex_unlock(&dom->cd_cache->cc_lock);
+	m0_free(dup);
+}
+
+/**
+ * Drops cached records of the fid. Called after the namespace or object
+ * index records of the fid are changed in the trees.
+ */
+static void cob_cache_fid_drop(struct m0_cob_domain *dom,
+			       const struct m0_fid *fid)
+{
+	struct m0_cob_cache *cache = dom->cd_cache;
+	int                  i;
+
+	if (cache == NULL)
+		return;
+	m0_mutex_lock(&cache->cc_lock);
+	++cache->cc_gen;
+	for (i = 0; i < COB_CACHE_NR; ++i) {
+		if (cache->cc_ns[i].ccn_key != NULL &&
+		    m0_fid_eq(&cache->cc_ns[i].ccn_rec.cnr_fid, fid))
+			m0_free0(&cache->cc_ns[i].ccn_key);
+		if (cache->cc_oi[i].cco_nskey != NULL &&
+		    m0_fid_eq(&cache->cc_oi[i].cco_key.cok_fid, fid))
+			m0_free0(&cache->cc_oi[i].cco_nskey);
+	}
+	m0_mutex_unlock(&cache->cc_lock);
+}
+
 M0_UNUSED static char *cob_dom_id_make(char *buf, const struct m0_cob_domain_id *id,
 			     const char *prefix)
 {
@@ -611,7 +803,7 @@ int m0_cob_domain_init(struct m0_cob_domain *dom, struct m0_be_seg *seg)
 
 	M0_ALLOC_PTR(dom->cd_object_index);
 	M0_ASSERT(dom->cd_object_index);
-	keycmp.rko_keycmp = oi_cmp;
+	keycmp = (struct m0_btree_rec_key_op){ .rko_keycmp = oi_cmp };
 	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
 				      m0_btree_open(&dom->cd_oi_node,
 						    sizeof dom->cd_oi_node,
@@ -621,7 +813,7 @@ int m0_cob_domain_init(struct m0_cob_domain *dom, struct m0_be_seg *seg)
 
 	M0_ALLOC_PTR(dom->cd_namespace);
 	M0_ASSERT(dom->cd_namespace);
-	keycmp.rko_keycmp = ns_cmp;
+	keycmp = (struct m0_btree_rec_key_op){ .rko_keycmp = ns_cmp };
 	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
 				      m0_btree_open(&dom->cd_ns_node,
 						    sizeof dom->cd_ns_node,
@@ -631,7 +823,10 @@ int m0_cob_domain_init(struct m0_cob_domain *dom, struct m0_be_seg *seg)
 
 	M0_ALLOC_PTR(dom->cd_fileattr_basic);
 	M0_ASSERT(dom->cd_fileattr_basic);
-	keycmp.rko_keycmp = fb_cmp;
+	keycmp = (struct m0_btree_rec_key_op){
+		.rko_keycmp = fb_cmp,
+		.rko_flags  = M0_BKF_U64,
+	};
 	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
 				      m0_btree_open(&dom->cd_fa_basic_node,
 						    sizeof dom->cd_fa_basic_node,
@@ -641,7 +836,10 @@ int m0_cob_domain_init(struct m0_cob_domain *dom, struct m0_be_seg *seg)
 
 	M0_ALLOC_PTR(dom->cd_fileattr_omg);
 	M0_ASSERT(dom->cd_fileattr_omg);
-	keycmp.rko_keycmp = omg_cmp;
+	keycmp = (struct m0_btree_rec_key_op){
+		.rko_keycmp = omg_cmp,
+		.rko_flags  = M0_BKF_U64,
+	};
 	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
 				      m0_btree_open(&dom->cd_fa_omg_node,
 						    sizeof dom->cd_fa_omg_node,
@@ -651,7 +849,7 @@ int m0_cob_domain_init(struct m0_cob_domain *dom, struct m0_be_seg *seg)
 
 	M0_ALLOC_PTR(dom->cd_fileattr_ea);
 	M0_ASSERT(dom->cd_fileattr_ea);
-	keycmp.rko_keycmp = ea_cmp;
+	keycmp = (struct m0_btree_rec_key_op){ .rko_keycmp = ea_cmp };
 	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
 				      m0_btree_open(&dom->cd_fa_ea_node,
 						    sizeof dom->cd_fa_ea_node,
@@ -661,7 +859,7 @@ int m0_cob_domain_init(struct m0_cob_domain *dom, struct m0_be_seg *seg)
 
 	M0_ALLOC_PTR(dom->cd_bytecount);
 	M0_ASSERT(dom->cd_bytecount);
-	keycmp.rko_keycmp = bc_cmp;
+	keycmp = (struct m0_btree_rec_key_op){ .rko_keycmp = bc_cmp };
 	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
 				      m0_btree_open(&dom->cd_bc_node,
 						    sizeof dom->cd_bc_node,
@@ -670,6 +868,7 @@ int m0_cob_domain_init(struct m0_cob_domain *dom, struct m0_be_seg *seg)
 	M0_ASSERT(rc == 0);
 
 	m0_rwlock_init(&dom->cd_lock.bl_u.rwlock);
+	cob_cache_init(dom);
 
 	return M0_RC(0);
 }
@@ -725,6 +924,7 @@ void m0_cob_domain_fini(struct m0_cob_domain *dom)
 		m0_free0(&dom->cd_bytecount);
 	}
 
+	cob_cache_fini(dom);
 	m0_rwlock_fini(&dom->cd_lock.bl_u.rwlock);
 }
 
@@ -829,6 +1029,7 @@ int m0_cob_domain_create_prepared(struct m0_cob_domain          **out,
 
 	dom->cd_id = *cdid;
 	M0_BE_TX_CAPTURE_PTR(seg, tx, &dom->cd_id);
+	cob_cache_init(dom);
 
 	m0_format_footer_update(dom);
 	M0_BE_TX_CAPTURE_PTR(seg, tx, &dom->cd_footer);
@@ -837,7 +1038,7 @@ int m0_cob_domain_create_prepared(struct m0_cob_domain          **out,
 		.ksize = sizeof(struct m0_cob_oikey),
 		.vsize = -1,
 	};
-	keycmp.rko_keycmp = oi_cmp;
+	keycmp = (struct m0_btree_rec_key_op){ .rko_keycmp = oi_cmp };
 	fid = M0_FID_TINIT('b', M0_BT_COB_OBJECT_INDEX, cdid->id);
 	M0_ALLOC_PTR(dom->cd_object_index);
 	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
@@ -853,7 +1054,7 @@ int m0_cob_domain_create_prepared(struct m0_cob_domain          **out,
 				    .ksize = -1,
 				    .vsize = -1,
 				   };
-	keycmp.rko_keycmp = ns_cmp;
+	keycmp = (struct m0_btree_rec_key_op){ .rko_keycmp = ns_cmp };
 	fid = M0_FID_TINIT('b', M0_BT_COB_NAMESPACE, cdid->id);
 	M0_ALLOC_PTR(dom->cd_namespace);
 	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
@@ -869,7 +1070,10 @@ int m0_cob_domain_create_prepared(struct m0_cob_domain          **out,
 		.ksize = sizeof(struct m0_cob_fabkey),
 		.vsize = -1,
 	};
-	keycmp.rko_keycmp = fb_cmp;
+	keycmp = (struct m0_btree_rec_key_op){
+		.rko_keycmp = fb_cmp,
+		.rko_flags  = M0_BKF_U64,
+	};
 	fid = M0_FID_TINIT('b', M0_BT_COB_FILEATTR_BASIC, cdid->id);
 	M0_ALLOC_PTR(dom->cd_fileattr_basic);
 	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
@@ -885,7 +1089,10 @@ int m0_cob_domain_create_prepared(struct m0_cob_domain          **out,
 				     .ksize = sizeof (struct m0_cob_omgkey),
 				     .vsize = sizeof (struct m0_cob_omgrec),
 				   };
-	keycmp.rko_keycmp = omg_cmp;
+	keycmp = (struct m0_btree_rec_key_op){
+		.rko_keycmp = omg_cmp,
+		.rko_flags  = M0_BKF_U64,
+	};
 	fid = M0_FID_TINIT('b', M0_BT_COB_FILEATTR_OMG, cdid->id);
 	M0_ALLOC_PTR(dom->cd_fileattr_omg);
 	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
@@ -901,7 +1108,7 @@ int m0_cob_domain_create_prepared(struct m0_cob_domain          **out,
 		.ksize = -1,
 		.vsize = -1,
 	};
-	keycmp.rko_keycmp = ea_cmp;
+	keycmp = (struct m0_btree_rec_key_op){ .rko_keycmp = ea_cmp };
 	fid = M0_FID_TINIT('b', M0_BT_COB_FILEATTR_EA, cdid->id);
 	M0_ALLOC_PTR(dom->cd_fileattr_ea);
 	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
@@ -917,7 +1124,7 @@ int m0_cob_domain_create_prepared(struct m0_cob_domain          **out,
 		.ksize = m0_cob_bckey_size(),
 		.vsize = m0_cob_bcrec_size(),
 	};
-	keycmp.rko_keycmp = bc_cmp;
+	keycmp = (struct m0_btree_rec_key_op){ .rko_keycmp = bc_cmp };
 	fid = M0_FID_TINIT('b', M0_BT_COB_BYTECOUNT, cdid->id);
 	M0_ALLOC_PTR(dom->cd_bytecount);
 	rc = M0_BTREE_OP_SYNC_WITH_RC(&b_op,
@@ -1440,17 +1647,25 @@ M0_INTERNAL int m0_cob_bc_update(struct m0_cob *cob,
  */
 static int cob_ns_lookup(struct m0_cob *cob)
 {
-	struct m0_buf   key;
-	struct m0_buf   val;
-	int             rc;
+	struct m0_cob_domain *dom = cob->co_dom;
+	struct m0_buf         key;
+	struct m0_buf         val;
+	uint64_t              gen;
+	int                   rc = 0;
 
 	M0_PRE(cob->co_nskey != NULL &&
 	       m0_fid_is_set(&cob->co_nskey->cnk_pfid));
 
-	m0_buf_init(&key, cob->co_nskey, m0_cob_nskey_size(cob->co_nskey));
-	m0_buf_init(&val, &cob->co_nsrec, sizeof cob->co_nsrec);
-
-	rc = cob_table_lookup(cob->co_dom->cd_namespace, &key, &val);
+	if (!cob_cache_ns_get(dom, cob->co_nskey, &cob->co_nsrec)) {
+		m0_buf_init(&key, cob->co_nskey,
+			    m0_cob_nskey_size(cob->co_nskey));
+		m0_buf_init(&val, &cob->co_nsrec, sizeof cob->co_nsrec);
+		gen = dom->cd_cache != NULL ? cob_cache_gen(dom) : 0;
+		rc = cob_table_lookup(dom->cd_namespace, &key, &val);
+		if (rc == 0 && dom->cd_cache != NULL)
+			cob_cache_ns_put(dom, cob->co_nskey, &cob->co_nsrec,
+					 gen);
+	}
 	if (rc == 0) {
 		cob->co_flags |= M0_CA_NSREC;
 		M0_ASSERT(cob->co_nsrec.cnr_linkno > 0 ||
@@ -1509,6 +1724,9 @@ static int cob_oi_lookup(struct m0_cob *cob)
 		.c_act   = cob_oi_lookup_callback,
 		.c_datum = cob,
 	};
+	struct m0_cob_domain *dom         = cob->co_dom;
+	struct m0_cob_nskey  *nskey;
+	uint64_t              gen;
 
 	if (cob->co_flags & M0_CA_NSKEY)
 		return 0;
@@ -1518,9 +1736,18 @@ static int cob_oi_lookup(struct m0_cob *cob)
 		cob->co_flags &= ~M0_CA_NSKEY_FREE;
 	}
 
+	nskey = cob_cache_oi_get(dom, &cob->co_oikey);
+	if (nskey != NULL) {
+		cob->co_nskey = nskey;
+		cob->co_flags |= (M0_CA_NSKEY | M0_CA_NSKEY_FREE);
+		return M0_RC(0);
+	}
+	gen = dom->cd_cache != NULL ? cob_cache_gen(dom) : 0;
 	rc = M0_BTREE_OP_SYNC_WITH_RC(&kv_op,
 				      m0_btree_get(tree, &key, &oi_lookup_cb,
 						   BOF_SLANT, &kv_op));
+	if (rc == 0 && dom->cd_cache != NULL)
+		cob_cache_oi_put(dom, &cob->co_oikey, cob->co_nskey, gen);
 
 	return M0_RC(rc);
 }
@@ -2199,6 +2426,7 @@ M0_INTERNAL int m0_cob_update(struct m0_cob *cob,
 		m0_buf_init(&val, &cob->co_nsrec, sizeof cob->co_nsrec);
 		rc = cob_table_update(cob->co_dom->cd_namespace,
 				      tx, &key, &val);
+		cob_cache_fid_drop(cob->co_dom, m0_cob_fid(cob));
 	}
 
 	if (rc == 0 && fabrec != NULL) {
@@ -2266,6 +2494,8 @@ M0_INTERNAL int m0_cob_name_add(struct m0_cob *cob,
 	m0_format_footer_update(nsrec);
 	m0_buf_init(&val, nsrec, sizeof *nsrec);
 	rc = cob_table_insert(cob->co_dom->cd_namespace, tx, &key, &val);
+	/* Slant object index lookups of the fid can find the new record. */
+	cob_cache_fid_drop(cob->co_dom, &nsrec->cnr_fid);
 	if (rc != 0) {
 		m0_buf_init(&key, &oikey, sizeof oikey);
 		cob_table_delete(cob->co_dom->cd_object_index, tx, &key);
@@ -2313,6 +2543,7 @@ M0_INTERNAL int m0_cob_name_del(struct m0_cob *cob,
 	rc = cob_table_delete(cob->co_dom->cd_object_index, tx, &key);
 
 out:
+	cob_cache_fid_drop(cob->co_dom, m0_cob_fid(cob));
 	return M0_RC(rc);
 }
 
@@ -2370,6 +2601,7 @@ M0_INTERNAL int m0_cob_name_update(struct m0_cob *cob,
 			  m0_bitstring_len_get(&tgtkey->cnk_name));
 	cob->co_flags |= M0_CA_NSKEY_FREE;
 out:
+	cob_cache_fid_drop(cob->co_dom, &nsrec.cnr_fid);
 	return M0_RC(rc);
 }
 
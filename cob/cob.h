@@ -269,6 +269,8 @@ struct m0_cob_domain_id {
 
    Note: has to be allocated with m0_be_alloc()
 */
+struct m0_cob_cache;
+
 struct m0_cob_domain {
 	struct m0_format_header cd_header;
 	struct m0_cob_domain_id cd_id;
@@ -287,6 +289,8 @@ struct m0_cob_domain {
 	struct m0_btree *cd_fileattr_omg;   /** Pointer to fileattr_omg tree */
 	struct m0_btree *cd_fileattr_ea;    /** Pointer to fileattr_ea tree */
 	struct m0_btree *cd_bytecount;      /** Pointer to bytecount tree */
+	/** Volatile lookup cache, NULL if it could not be allocated. */
+	struct m0_cob_cache *cd_cache;
 
 	/**
 	 *  Root nodes for the above trees follow here. These root nodes
@@ -599,14 +603,14 @@ struct m0_cob_bcrec {
  * is specified in its allocation time.
  *
  * <b>Caching and concurrency</b>
- * Cobs are not cached by cob domain, neither by cob API users.
- * Rationale is the following:
- *
- * - we use db[45] for storing metadata and it already has cache that may work
- * in a way that satisfies our needs;
+ * Cobs are not cached by cob domain, neither by cob API users. Each cob is
+ * populated from the trees by m0_cob_lookup() or m0_cob_locate().
  *
- * - using cache means substantial complications with locking and concurrent
- * access. Currently these issues are completely covered by db[45].
+ * The cob domain caches the records those lookups read instead: namespace
+ * records by name and object index records by oikey, in a bounded,
+ * direct-mapped table (m0_cob_domain::cd_cache). Every namespace or object
+ * index update of a fid drops the cached records of that fid. A lookup that
+ * was running during the update does not insert its result.
  */
 struct m0_cob {
 	struct m0_cob_domain  *co_dom;
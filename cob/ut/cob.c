@@ -314,6 +314,57 @@ static void test_locate(void)
 	M0_UT_ASSERT(rc != 0);
 }
 
+/** Updates the cob between cached lookups, makes sure lookups see it. */
+static void test_cache(void)
+{
+	struct m0_cob_nskey    *nskey;
+	struct m0_cob_nsrec     nsrec;
+	struct m0_fid           pfid;
+	struct m0_be_tx         tx_;
+	struct m0_be_tx	       *tx = &tx_;
+	struct m0_be_tx_credit  accum = {};
+	int                     rc;
+
+	m0_fid_set(&pfid, 0x123, 0x456);
+	m0_cob_nskey_make(&nskey, &pfid, test_name, strlen(test_name));
+	rc = m0_cob_lookup(dom, nskey, M0_CA_NSKEY_FREE, &cob);
+	M0_UT_ASSERT(rc == 0);
+	nsrec = cob->co_nsrec;
+	M0_UT_ASSERT(nsrec.cnr_size == 0);
+	m0_cob_put(cob);
+
+	/* Served from the cache. */
+	m0_cob_nskey_make(&nskey, &pfid, test_name, strlen(test_name));
+	rc = m0_cob_lookup(dom, nskey, M0_CA_NSKEY_FREE, &cob);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_fid_eq(m0_cob_fid(cob), &nsrec.cnr_fid));
+
+	m0_cob_tx_credit(dom, M0_COB_OP_UPDATE, &accum);
+	ut_tx_open(tx, &accum);
+	nsrec.cnr_size = 4096;
+	rc = m0_cob_update(cob, &nsrec, NULL, NULL, tx);
+	M0_UT_ASSERT(rc == 0);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+	m0_cob_put(cob);
+
+	m0_cob_nskey_make(&nskey, &pfid, test_name, strlen(test_name));
+	rc = m0_cob_lookup(dom, nskey, M0_CA_NSKEY_FREE, &cob);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(cob->co_nsrec.cnr_size == 4096);
+	m0_cob_put(cob);
+
+	/* Twice, the second time from the cache. */
+	rc = _locate(0xabc, 0xdef);
+	M0_UT_ASSERT(rc == 0);
+	m0_cob_put(cob);
+	rc = _locate(0xabc, 0xdef);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(cob->co_nsrec.cnr_size == 4096);
+	M0_UT_ASSERT(m0_fid_eq(&cob->co_nskey->cnk_pfid, &pfid));
+	m0_cob_put(cob);
+}
+
 static void test_delete(void)
 {
 	struct m0_be_tx         tx_;
@@ -350,6 +401,7 @@ struct m0_ut_suite cob_ut = {
 		{ "cob-locate",   test_locate },
 		{ "cob-add-name", test_add_name },
 		{ "cob-del-name", test_del_name },
+		{ "cob-cache",    test_cache },
 		{ "cob-delete",   test_delete },
 		{ "cob-fini",     test_fini },
 		{ NULL, NULL }
@@ -35,7 +35,9 @@
  * @defgroup conf_dlspec_cache Configuration Cache (lspec)
  *
  * The implementation of m0_conf_cache::ca_registry is based on linked
- * list data structure.
+ * list data structure. Lookups are served from the published snapshot
+ * (m0_conf_cache_snap), an open-addressing hash table sized to at most
+ * half occupancy.
  *
  * @see @ref conf, @ref conf-lspec
  *
@@ -71,6 +73,9 @@ m0_conf_cache_init(struct m0_conf_cache *cache, struct m0_mutex *lock)
 	cache->ca_lock = lock;
 	cache->ca_ver  = 0;
 	cache->ca_fid_counter = 0;
+	cache->ca_snap = NULL;
+	cache->ca_ha_batch = false;
+	m0_chan_init(&cache->ca_ha_batch_chan, lock);
 
 	M0_LEAVE();
 }
@@ -102,18 +107,88 @@ M0_INTERNAL bool m0_conf_cache_contains(struct m0_conf_cache *cache,
 	return ret;
 }
 
+static struct m0_conf_obj *
+snap_lookup(const struct m0_conf_cache_snap *snap, const struct m0_fid *id)
+{
+	const struct m0_conf_cache_slot *slot;
+	uint32_t                         mask = snap->cs_size - 1;
+	uint32_t                         i;
+
+	for (i = m0_fid_hash(id) & mask;; i = (i + 1) & mask) {
+		slot = &snap->cs_slot[i];
+		if (slot->cs_obj == NULL || m0_fid_eq(&slot->cs_fid, id))
+			return slot->cs_obj;
+	}
+}
+
 M0_INTERNAL struct m0_conf_obj *
 m0_conf_cache_lookup(const struct m0_conf_cache *cache,
 		     const struct m0_fid *id)
 {
+	const struct m0_conf_cache_snap *snap = cache->ca_snap;
+	struct m0_conf_obj              *obj;
+
+	if (snap != NULL) {
+		obj = snap_lookup(snap, id);
+		if (obj != NULL)
+			return obj;
+	}
 	return m0_tl_find(m0_conf_cache, obj, &cache->ca_registry,
 			  m0_fid_eq(&obj->co_id, id));
 }
 
+static void snap_unpublish(struct m0_conf_cache *cache)
+{
+	if (cache->ca_snap != NULL) {
+		m0_free(cache->ca_snap->cs_slot);
+		m0_free(cache->ca_snap);
+		cache->ca_snap = NULL;
+	}
+}
+
+M0_INTERNAL int m0_conf_cache_publish(struct m0_conf_cache *cache)
+{
+	struct m0_conf_cache_snap *snap;
+	struct m0_conf_obj        *obj;
+	uint64_t                   nr;
+	uint32_t                   i;
+
+	M0_ENTRY("cache=%p", cache);
+	M0_PRE(m0_conf_cache_is_locked(cache));
+
+	nr = m0_conf_cache_tlist_length(&cache->ca_registry);
+	M0_ALLOC_PTR(snap);
+	if (snap == NULL)
+		return M0_ERR(-ENOMEM);
+	for (snap->cs_size = 2; snap->cs_size < 2 * nr; snap->cs_size <<= 1)
+		;
+	M0_ALLOC_ARR(snap->cs_slot, snap->cs_size);
+	if (snap->cs_slot == NULL) {
+		m0_free(snap);
+		return M0_ERR(-ENOMEM);
+	}
+	m0_tl_for(m0_conf_cache, &cache->ca_registry, obj) {
+		for (i = m0_fid_hash(&obj->co_id) & (snap->cs_size - 1);
+		     snap->cs_slot[i].cs_obj != NULL;
+		     i = (i + 1) & (snap->cs_size - 1))
+			;
+		snap->cs_slot[i] = (struct m0_conf_cache_slot) {
+			.cs_fid = obj->co_id,
+			.cs_obj = obj
+		};
+	} m0_tl_endfor;
+	snap_unpublish(cache);
+	cache->ca_snap = snap;
+	M0_LOG(M0_DEBUG, "published %"PRIu64" objects", nr);
+	return M0_RC(0);
+}
+
 static void _obj_del(struct m0_conf_obj *obj)
 {
 	M0_ENTRY("obj="FID_F, FID_P(&obj->co_id));
 
+	/* The object is freed below and the snapshot points to it. */
+	snap_unpublish(obj->co_cache);
 	m0_conf_cache_tlist_del(obj);
 	m0_conf_obj_delete(obj);
 
@@ -187,6 +262,8 @@ M0_INTERNAL void m0_conf_cache_fini(struct m0_conf_cache *cache)
 	m0_conf_cache_lock(cache);
 	m0_conf_cache_clean(cache, NULL);
 	m0_conf_cache_tlist_fini(&cache->ca_registry);
+	m0_chan_fini(&cache->ca_ha_batch_chan);
+	snap_unpublish(cache);
 	m0_conf_cache_unlock(cache);
 
 	M0_LEAVE();
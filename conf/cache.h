@@ -58,7 +58,13 @@ M0_TL_DECLARE(m0_conf_cache, M0_INTERNAL, struct m0_conf_obj);
  * @section conf-fspec-cache-thread Concurrency control
  *
  * m0_conf_cache::ca_lock should be acquired prior to modifying cached
- * configuration objects.
+ * configuration objects and prior to m0_conf_cache_lookup().
+ *
+ * Once the configuration is loaded, m0_conf_cache_publish() takes a
+ * snapshot of the registry: a fid->object hash table, which
+ * m0_conf_cache_lookup() probes before falling back to the registry scan.
+ * Deletion of any registered object frees the snapshot, as its slots point
+ * to the objects being freed.
  *
  * @see @ref conf_dfspec_cache "Detailed Functional Specification"
  */
@@ -90,6 +96,24 @@ enum m0_conf_version {
 	M0_CONF_VER_TEMP = ~0,
 };
 
+/** Slot of m0_conf_cache_snap hash table. */
+struct m0_conf_cache_slot {
+	struct m0_fid       cs_fid;
+	struct m0_conf_obj *cs_obj;
+};
+
+/**
+ * Snapshot of m0_conf_cache::ca_registry.
+ *
+ * @see m0_conf_cache_publish()
+ */
+struct m0_conf_cache_snap {
+	/** Number of slots, power of 2. */
+	uint32_t                   cs_size;
+	/** Hash table with linear probing, keyed by m0_fid_hash(). */
+	struct m0_conf_cache_slot *cs_slot;
+};
+
 /** Configuration cache. */
 struct m0_conf_cache {
 	/**
@@ -109,6 +133,20 @@ struct m0_conf_cache {
 	 * fids of newly created m0_conf_objv objects.
 	 */
 	uint64_t         ca_fid_counter;
+
+	/** Published snapshot of the registry or NULL. */
+	struct m0_conf_cache_snap          *ca_snap;
+
+	/**
+	 * Set while m0_ha_state_accept() applies a set of HA notes. Work
+	 * that m0_conf_obj::co_ha_chan subscribers do per notification but
+	 * which only depends on the resulting states can be deferred until
+	 * ca_ha_batch_chan is broadcast at the end of the set.
+	 */
+	bool                                ca_ha_batch;
+
+	/** Broadcast under the cache lock after a set of HA notes. */
+	struct m0_chan                      ca_ha_batch_chan;
 };
 
 /** Initialises configuration cache. */
@@ -173,12 +211,24 @@ M0_INTERNAL bool m0_conf_cache_contains(struct m0_conf_cache *cache,
 /**
  * Searches for a configuration object given its identity (type & id).
  *
+ * The caller must hold the cache lock: neither the registry nor the
+ * published snapshot may change or be freed during the search.
+ *
  * Returns NULL if there is no such object in the cache.
  */
 M0_INTERNAL struct m0_conf_obj *
 m0_conf_cache_lookup(const struct m0_conf_cache *cache,
 		     const struct m0_fid *id);
 
+/**
+ * Publishes a snapshot of the registry, so that m0_conf_cache_lookup() of a
+ * registered object is a hash table probe instead of a list scan.
+ * Called after the configuration has been (re)loaded.
+ *
+ * @pre  m0_conf_cache_is_locked(cache)
+ */
+M0_INTERNAL int m0_conf_cache_publish(struct m0_conf_cache *cache);
+
 /**
  * Creates conf string representation of all objects in the cache,
  * except m0_conf_dir objects.
@@ -1599,6 +1599,9 @@ static int confc_cache_preload(struct m0_confc *confc, const char *local_conf)
 			rc = cached_obj_update(confc, M0_CONFX_AT(enc, i));
 		m0_confx_free(enc);
 	}
+	if (rc == 0)
+		/* Lookups fall back to the registry if this fails. */
+		(void)m0_conf_cache_publish(&confc->cc_cache);
 	return M0_RC(rc);
 }
 
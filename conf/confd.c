@@ -525,6 +525,8 @@ M0_INTERNAL int m0_confd_cache_create(struct m0_conf_cache **out,
 	m0_conf_cache_init(*out, cache_lock);
 	m0_conf_cache_lock(*out);
 	rc = confd_cache_preload(*out, confstr);
+	if (rc == 0)
+		(void)m0_conf_cache_publish(*out);
 	m0_conf_cache_unlock(*out);
 	if (rc == 0)
 		return M0_RC(0);
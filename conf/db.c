@@ -161,6 +161,7 @@ static int confdb_table_init(struct m0_be_seg     *seg,
 	int                         rc;
 	struct m0_btree_rec_key_op  keycmp = {
 					.rko_keycmp = (void *)&m0_fid_cmp,
+					.rko_flags  = M0_BKF_U64,
 					};
 
 	M0_ENTRY();
@@ -704,6 +705,7 @@ M0_INTERNAL int m0_confdb_read(struct m0_be_seg *seg, struct m0_confx **out)
 	struct m0_btree_op          b_op    = {};
 	struct m0_btree_rec_key_op  keycmp  = {
 					.rko_keycmp = (void *) &m0_fid_cmp,
+					.rko_flags  = M0_BKF_U64,
 					};
 
 	M0_ENTRY();
@@ -750,6 +752,7 @@ M0_INTERNAL int m0_confdb_truncate_credit(struct m0_be_seg       *seg,
 	struct m0_btree_op          b_op    = {};
 	struct m0_btree_rec_key_op  keycmp  = {
 					.rko_keycmp = (void *) &m0_fid_cmp,
+					.rko_flags  = M0_BKF_U64,
 					};
 	M0_ENTRY();
 
@@ -779,6 +782,7 @@ M0_INTERNAL int m0_confdb_truncate(struct m0_be_seg *seg,
 	struct m0_btree_op          b_op    = {};
 	struct m0_btree_rec_key_op  keycmp  = {
 					.rko_keycmp = (void *) &m0_fid_cmp,
+					.rko_flags  = M0_BKF_U64,
 					};
 
 	M0_ENTRY();
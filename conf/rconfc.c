@@ -732,6 +732,12 @@ static void rconfc_conf_full_load(struct m0_sm_group *grp,
 	     m0_conf_full_load(root);
 	if (root != NULL)
 		m0_confc_close(&root->rt_obj);
+	if (rc == 0) {
+		/* Lookups fall back to the registry if this fails. */
+		m0_conf_cache_lock(cache);
+		(void)m0_conf_cache_publish(cache);
+		m0_conf_cache_unlock(cache);
+	}
 	/*
 	 * The configuration might be loaded. Now we need to invoke
 	 * rconfc_ha_restore() to re-associate the kept clinks with their
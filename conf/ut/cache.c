@@ -128,6 +128,40 @@ static void test_cache(void)
 	m0_conf_cache_unlock(&m0_conf_ut_cache);
 }
 
+static void test_publish(void)
+{
+	struct m0_conf_obj *objs[16];
+	struct m0_conf_obj *obj;
+	int                 i;
+	int                 rc;
+
+	for (i = 0; i < ARRAY_SIZE(objs); ++i)
+		ut_conf_obj_create(&M0_FID_TINIT('p', 100, i), &objs[i]);
+	m0_conf_cache_lock(&m0_conf_ut_cache);
+	rc = m0_conf_cache_publish(&m0_conf_ut_cache);
+	m0_conf_cache_unlock(&m0_conf_ut_cache);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_conf_ut_cache.ca_snap != NULL);
+	m0_conf_cache_lock(&m0_conf_ut_cache);
+	for (i = 0; i < ARRAY_SIZE(objs); ++i)
+		M0_UT_ASSERT(m0_conf_cache_lookup(&m0_conf_ut_cache,
+						  &objs[i]->co_id) == objs[i]);
+	m0_conf_cache_unlock(&m0_conf_ut_cache);
+	/* Added after publication: found in the registry. */
+	ut_conf_obj_create(&M0_FID_TINIT('p', 100, 999), &obj);
+	M0_UT_ASSERT(m0_conf_ut_cache.ca_snap != NULL);
+	/* Deletion frees the snapshot. */
+	ut_conf_obj_delete(obj);
+	M0_UT_ASSERT(m0_conf_ut_cache.ca_snap == NULL);
+	for (i = 0; i < ARRAY_SIZE(objs); ++i) {
+		m0_conf_cache_lock(&m0_conf_ut_cache);
+		M0_UT_ASSERT(m0_conf_cache_lookup(&m0_conf_ut_cache,
+						  &objs[i]->co_id) == objs[i]);
+		m0_conf_cache_unlock(&m0_conf_ut_cache);
+		ut_conf_obj_delete(objs[i]);
+	}
+}
+
 static void test_obj_find(void)
 {
 	int                 rc;
@@ -190,6 +224,7 @@ struct m0_ut_suite conf_ut = {
 	.ts_tests = {
 		{ "obj-xtors",   test_obj_xtors },
 		{ "cache",       test_cache     },
+		{ "publish",     test_publish   },
 		{ "obj-find",    test_obj_find  },
 		{ "obj-fill",    test_obj_fill  },
 		{ "dir-add-del", test_dir_add_del },
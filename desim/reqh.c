@@ -0,0 +1,668 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stddef.h>                /* offsetof */
+#include <string.h>
+#include <errno.h>
+
+#include "lib/assert.h"
+#include "lib/misc.h"              /* ARRAY_SIZE, container_of */
+#include "motr/magic.h"
+#include "desim/sim.h"
+#include "desim/reqh.h"
+
+/**
+   @addtogroup desim desim
+   @{
+ */
+
+struct reqh_grp {
+	struct reqh_conf *rg_conf;
+	struct m0_tl      rg_foms;
+	unsigned          rg_nr;
+	sim_time_t        rg_opened;
+};
+
+struct reqh_pkt {
+	struct reqh_frm  *rp_frm;
+	struct m0_tl      rp_items;
+};
+
+M0_TL_DESCR_DEFINE(fom, "foms", static, struct reqh_fom,
+		   fo_linkage, fo_magic, M0_DESIM_REQH_FOM_MAGIC,
+		   M0_DESIM_REQH_FOM_HEAD_MAGIC);
+M0_TL_DEFINE(fom, static, struct reqh_fom);
+
+static void loc_enqueue(struct reqh_conf *conf, struct reqh_fom *fom);
+static void frm_add(struct reqh_frm *frm, struct reqh_fom *fom);
+
+static struct sim *reqh_sim(struct reqh_conf *conf)
+{
+	return conf->rc_loc[0].rl_thread.st_sim;
+}
+
+static sim_time_t reqh_now(struct reqh_conf *conf)
+{
+	return reqh_sim(conf)->ss_bolt;
+}
+
+static sim_time_t net_delay(struct reqh_conf *conf, unsigned long nob)
+{
+	return sim_rnd(conf->rc_net_delay_min, conf->rc_net_delay_max) +
+		(conf->rc_net_rate != 0 ?
+		 nob * 1000000000ULL / conf->rc_net_rate : 0);
+}
+
+static unsigned long frm_item_size(const struct reqh_frm *frm)
+{
+	return frm->rf_reply ? frm->rf_conf->rc_reply_size :
+		frm->rf_conf->rc_item_size;
+}
+
+static bool frm_is_ready(const struct reqh_frm *frm)
+{
+	struct reqh_conf *conf = frm->rf_conf;
+
+	return frm->rf_nr > 0 &&
+		(frm->rf_nr >= conf->rc_frm_items_max ||
+		 frm->rf_nob >= conf->rc_frm_nob_max ||
+		 reqh_now(conf) >= fom_tlist_head(&frm->rf_queue)->fo_queued +
+		 conf->rc_frm_timeout);
+}
+
+static int frm_timeout(struct sim_callout *call)
+{
+	struct reqh_frm *frm = call->sc_datum;
+
+	if (frm_is_ready(frm))
+		sim_chan_signal(&frm->rf_wake);
+	return 1;
+}
+
+static void frm_add(struct reqh_frm *frm, struct reqh_fom *fom)
+{
+	struct reqh_conf *conf = frm->rf_conf;
+
+	fom->fo_queued = reqh_now(conf);
+	if (frm->rf_nr == 0)
+		sim_timer_add(reqh_sim(conf), conf->rc_frm_timeout,
+			      frm_timeout, frm);
+	fom_tlist_add_tail(&frm->rf_queue, fom);
+	frm->rf_nr++;
+	frm->rf_nob += frm_item_size(frm);
+	if (frm_is_ready(frm))
+		sim_chan_signal(&frm->rf_wake);
+}
+
+static int pkt_deliver(struct sim_callout *call)
+{
+	struct reqh_pkt  *pkt  = call->sc_datum;
+	struct reqh_conf *conf = pkt->rp_frm->rf_conf;
+	struct reqh_fom  *fom;
+
+	while ((fom = fom_tlist_pop(&pkt->rp_items)) != NULL) {
+		if (pkt->rp_frm->rf_reply) {
+			fom->fo_replied = true;
+			sim_chan_signal(&fom->fo_thread->rt_reply);
+		} else {
+			fom->fo_phase = 0;
+			fom->fo_phase_start = reqh_now(conf);
+			loc_enqueue(conf, fom);
+		}
+	}
+	fom_tlist_fini(&pkt->rp_items);
+	sim_free(pkt);
+	return 1;
+}
+
+/**
+ * rpc formation loop: forms a packet from the queued items and posts its
+ * delivery. Packet transfers of a session overlap, as with
+ * max_rpcs_in_flight greater than 1.
+ */
+static void frm_loop(struct sim *s, struct sim_thread *t, void *arg)
+{
+	struct reqh_frm  *frm  = arg;
+	struct reqh_conf *conf = frm->rf_conf;
+	struct reqh_pkt  *pkt;
+	struct reqh_fom  *fom;
+	unsigned          nr;
+	unsigned long     nob;
+
+	while (1) {
+		while (!frm_is_ready(frm)) {
+			sim_chan_wait(&frm->rf_wake, t);
+			if (conf->rc_shutdown)
+				sim_thread_exit(t);
+		}
+		pkt = sim_alloc(sizeof *pkt);
+		pkt->rp_frm = frm;
+		fom_tlist_init(&pkt->rp_items);
+		nr  = 0;
+		nob = 0;
+		while (frm->rf_nr > 0 && nr < conf->rc_frm_items_max &&
+		       nob < conf->rc_frm_nob_max) {
+			fom = fom_tlist_pop(&frm->rf_queue);
+			cnt_mod(&conf->rc_cnt_frm, s->ss_bolt - fom->fo_queued);
+			fom_tlist_add_tail(&pkt->rp_items, fom);
+			frm->rf_nr--;
+			frm->rf_nob -= frm_item_size(frm);
+			nob += frm_item_size(frm);
+			nr++;
+		}
+		if (frm->rf_nr > 0) {
+			fom = fom_tlist_head(&frm->rf_queue);
+			sim_timer_add(s, fom->fo_queued + conf->rc_frm_timeout >
+				      s->ss_bolt ? fom->fo_queued +
+				      conf->rc_frm_timeout - s->ss_bolt : 0,
+				      frm_timeout, frm);
+		}
+		cnt_mod(&conf->rc_cnt_pkt, nr);
+		sim_log(s, SLL_TRACE, "%s#%u: packet %u %lu\n",
+			frm->rf_reply ? "reply" : "request", frm->rf_id, nr,
+			nob);
+		sim_sleep(t, conf->rc_frm_delay);
+		sim_timer_add(s, net_delay(conf, nob), pkt_deliver, pkt);
+	}
+}
+
+static void loc_enqueue(struct reqh_conf *conf, struct reqh_fom *fom)
+{
+	struct reqh_loc *loc = &conf->rc_loc[fom->fo_key %
+					     conf->rc_nr_localities];
+
+	cnt_mod(&loc->rl_cnt_runq, loc->rl_nr);
+	fom->fo_queued = reqh_now(conf);
+	fom_tlist_add_tail(&loc->rl_runq, fom);
+	loc->rl_nr++;
+	sim_chan_signal(&loc->rl_wake);
+}
+
+/**
+ * Moves the fom to the next phase. Returns false and queues the reply when
+ * the fom is done.
+ */
+static bool fom_phase_next(struct reqh_conf *conf, struct reqh_fom *fom)
+{
+	sim_time_t now = reqh_now(conf);
+
+	cnt_mod(&conf->rc_phase[fom->fo_phase].rp_cnt,
+		now - fom->fo_phase_start);
+	fom->fo_phase_start = now;
+	if (++fom->fo_phase < conf->rc_nr_phases)
+		return true;
+	frm_add(&conf->rc_sfrm[fom->fo_thread->rt_id / conf->rc_nr_threads],
+		fom);
+	return false;
+}
+
+static void fom_resume(struct reqh_conf *conf, struct reqh_fom *fom)
+{
+	if (fom_phase_next(conf, fom))
+		loc_enqueue(conf, fom);
+}
+
+static int fom_wakeup(struct sim_callout *call)
+{
+	struct reqh_fom *fom = call->sc_datum;
+
+	fom_resume(fom->fo_thread->rt_conf, fom);
+	return 1;
+}
+
+static bool grp_join(struct reqh_conf *conf, struct reqh_fom *fom);
+static void grp_close(struct reqh_conf *conf);
+
+static int grp_logged(struct sim_callout *call)
+{
+	struct reqh_grp  *grp  = call->sc_datum;
+	struct reqh_conf *conf = grp->rg_conf;
+	struct reqh_grp  *cur;
+	struct reqh_fom  *fom;
+
+	cnt_mod(&conf->rc_cnt_grp_time, reqh_now(conf) - grp->rg_opened);
+	while ((fom = fom_tlist_pop(&grp->rg_foms)) != NULL)
+		fom_resume(conf, fom);
+	fom_tlist_fini(&grp->rg_foms);
+	sim_free(grp);
+	M0_ASSERT(conf->rc_grp_inflight > 0);
+	conf->rc_grp_inflight--;
+	cur = conf->rc_grp;
+	if (cur != NULL && (cur->rg_nr >= conf->rc_grp_tx_max ||
+			    reqh_now(conf) >= cur->rg_opened +
+			    conf->rc_grp_timeout))
+		grp_close(conf);
+	return 1;
+}
+
+/**
+ * Closes and logs the current group, unless too many groups are being
+ * logged already. Foms waiting for a group are added to the next one.
+ */
+static void grp_close(struct reqh_conf *conf)
+{
+	struct reqh_grp *grp = conf->rc_grp;
+	struct reqh_fom *fom;
+	sim_time_t       delay;
+
+	M0_PRE(grp != NULL && grp->rg_nr > 0);
+
+	if (conf->rc_grp_inflight >= conf->rc_grp_inflight_max)
+		return;
+	conf->rc_grp_inflight++;
+	conf->rc_grp = NULL;
+	cnt_mod(&conf->rc_cnt_grp, grp->rg_nr);
+	delay = sim_rnd(conf->rc_log_delay_min, conf->rc_log_delay_max);
+	if (conf->rc_log_rate != 0)
+		delay += grp->rg_nr * conf->rc_tx_log_size * 1000000000ULL /
+			conf->rc_log_rate;
+	sim_log(reqh_sim(conf), SLL_TRACE, "group: %u %llu\n",
+		grp->rg_nr, delay);
+	sim_timer_add(reqh_sim(conf), delay, grp_logged, grp);
+	while ((conf->rc_grp == NULL ||
+		conf->rc_grp->rg_nr < conf->rc_grp_tx_max) &&
+	       (fom = fom_tlist_pop(&conf->rc_tx_wait)) != NULL) {
+		cnt_mod(&conf->rc_cnt_tx_wait, reqh_now(conf) - fom->fo_queued);
+		if (grp_join(conf, fom))
+			fom_resume(conf, fom);
+	}
+}
+
+static int grp_timeout(struct sim_callout *call)
+{
+	struct reqh_conf *conf = call->sc_datum;
+	struct reqh_grp  *cur  = conf->rc_grp;
+
+	if (cur != NULL &&
+	    reqh_now(conf) >= cur->rg_opened + conf->rc_grp_timeout)
+		grp_close(conf);
+	return 1;
+}
+
+/**
+ * Adds the fom transaction to the current group. Returns true iff the fom
+ * can proceed to the next phase right away.
+ */
+static bool grp_join(struct reqh_conf *conf, struct reqh_fom *fom)
+{
+	struct reqh_grp *grp = conf->rc_grp;
+
+	if (grp != NULL && grp->rg_nr >= conf->rc_grp_tx_max) {
+		fom->fo_queued = reqh_now(conf);
+		fom_tlist_add_tail(&conf->rc_tx_wait, fom);
+		return false;
+	}
+	if (grp == NULL) {
+		grp = conf->rc_grp = sim_alloc(sizeof *grp);
+		grp->rg_conf   = conf;
+		grp->rg_opened = reqh_now(conf);
+		fom_tlist_init(&grp->rg_foms);
+		sim_timer_add(reqh_sim(conf), conf->rc_grp_timeout,
+			      grp_timeout, conf);
+	}
+	grp->rg_nr++;
+	if (conf->rc_tx_sync)
+		fom_tlist_add_tail(&grp->rg_foms, fom);
+	if (grp->rg_nr >= conf->rc_grp_tx_max)
+		grp_close(conf);
+	return !conf->rc_tx_sync;
+}
+
+/**
+ * Executes fom phases on the locality thread until the fom waits or is
+ * done.
+ */
+static void fom_run(struct reqh_conf *conf, struct sim_thread *t,
+		    struct reqh_fom *fom)
+{
+	struct reqh_phase *ph;
+
+	do {
+		ph = &conf->rc_phase[fom->fo_phase];
+		sim_sleep(t, sim_rnd(ph->rp_cpu_min, ph->rp_cpu_max));
+		if (ph->rp_tx) {
+			if (!grp_join(conf, fom))
+				return;
+		} else if (ph->rp_wait_max > 0) {
+			sim_timer_add(t->st_sim, sim_rnd(ph->rp_wait_min,
+							 ph->rp_wait_max),
+				      fom_wakeup, fom);
+			return;
+		}
+	} while (fom_phase_next(conf, fom));
+}
+
+static void loc_loop(struct sim *s, struct sim_thread *t, void *arg)
+{
+	struct reqh_loc  *loc  = arg;
+	struct reqh_conf *conf = loc->rl_conf;
+	struct reqh_fom  *fom;
+
+	while (1) {
+		while (fom_tlist_is_empty(&loc->rl_runq)) {
+			sim_chan_wait(&loc->rl_wake, t);
+			if (conf->rc_shutdown)
+				sim_thread_exit(t);
+		}
+		fom = fom_tlist_pop(&loc->rl_runq);
+		loc->rl_nr--;
+		cnt_mod(&conf->rc_cnt_runq, s->ss_bolt - fom->fo_queued);
+		fom_run(conf, t, fom);
+	}
+}
+
+static void client_loop(struct sim *s, struct sim_thread *t, void *arg)
+{
+	struct reqh_thread *rt   = container_of(t, struct reqh_thread,
+						    rt_thread);
+	struct reqh_conf   *conf = arg;
+	struct reqh_fom    *fom  = &rt->rt_fom;
+	unsigned long       i;
+
+	for (i = 0; i < conf->rc_nr_ops; ++i) {
+		sim_sleep(t, sim_rnd(conf->rc_think_min, conf->rc_think_max));
+		fom->fo_replied = false;
+		fom->fo_start   = s->ss_bolt;
+		frm_add(&conf->rc_cfrm[rt->rt_id / conf->rc_nr_threads], fom);
+		while (!fom->fo_replied)
+			sim_chan_wait(&rt->rt_reply, t);
+		cnt_mod(&conf->rc_cnt_op, s->ss_bolt - fom->fo_start);
+		conf->rc_done++;
+	}
+	sim_thread_exit(t);
+}
+
+static int reqh_threads_start(struct sim_callout *call)
+{
+	struct reqh_conf *conf = call->sc_datum;
+	unsigned          nr   = conf->rc_nr_clients * conf->rc_nr_threads;
+	unsigned          i;
+
+	for (i = 0; i < conf->rc_nr_localities; ++i)
+		sim_thread_init(call->sc_sim, &conf->rc_loc[i].rl_thread, 0,
+				loc_loop, &conf->rc_loc[i]);
+	for (i = 0; i < conf->rc_nr_clients; ++i) {
+		sim_thread_init(call->sc_sim, &conf->rc_cfrm[i].rf_thread, 0,
+				frm_loop, &conf->rc_cfrm[i]);
+		sim_thread_init(call->sc_sim, &conf->rc_sfrm[i].rf_thread, 0,
+				frm_loop, &conf->rc_sfrm[i]);
+	}
+	for (i = 0; i < nr; ++i)
+		sim_thread_init(call->sc_sim, &conf->rc_thread[i].rt_thread, 0,
+				client_loop, conf);
+	return 1;
+}
+
+static void frm_init(struct reqh_frm *frm, struct reqh_conf *conf,
+		     unsigned id, bool reply)
+{
+	frm->rf_conf  = conf;
+	frm->rf_id    = id;
+	frm->rf_reply = reply;
+	fom_tlist_init(&frm->rf_queue);
+	sim_chan_init(&frm->rf_wake, "%s#%u::wake",
+		      reply ? "reply" : "request", id);
+}
+
+static void frm_fini(struct reqh_frm *frm)
+{
+	fom_tlist_fini(&frm->rf_queue);
+	sim_chan_fini(&frm->rf_wake);
+}
+
+M0_INTERNAL void reqh_init(struct sim *s, struct reqh_conf *conf)
+{
+	unsigned nr = conf->rc_nr_clients * conf->rc_nr_threads;
+	unsigned i;
+
+	M0_PRE(conf->rc_nr_localities > 0);
+	M0_PRE(conf->rc_nr_phases > 0 && conf->rc_nr_phases <= REQH_PHASE_MAX);
+	M0_PRE(conf->rc_frm_items_max > 0 && conf->rc_frm_nob_max > 0);
+	M0_PRE(conf->rc_grp_tx_max > 0 && conf->rc_grp_inflight_max > 0);
+
+	conf->rc_shutdown = 0;
+	conf->rc_done     = 0;
+	fom_tlist_init(&conf->rc_tx_wait);
+	cnt_init(&conf->rc_cnt_op, NULL, "reqh::op");
+	cnt_init(&conf->rc_cnt_frm, NULL, "reqh::frm_wait");
+	cnt_init(&conf->rc_cnt_pkt, NULL, "reqh::pkt_items");
+	cnt_init(&conf->rc_cnt_runq, NULL, "reqh::runq_wait");
+	cnt_init(&conf->rc_cnt_tx_wait, NULL, "reqh::tx_wait");
+	cnt_init(&conf->rc_cnt_grp, NULL, "reqh::grp_tx");
+	cnt_init(&conf->rc_cnt_grp_time, NULL, "reqh::grp_time");
+	for (i = 0; i < conf->rc_nr_phases; ++i)
+		cnt_init(&conf->rc_phase[i].rp_cnt, NULL, "reqh::phase#%u:%s",
+			 i, conf->rc_phase[i].rp_name ?: "");
+
+	conf->rc_loc = sim_alloc(conf->rc_nr_localities *
+				 sizeof conf->rc_loc[0]);
+	for (i = 0; i < conf->rc_nr_localities; ++i) {
+		struct reqh_loc *loc = &conf->rc_loc[i];
+
+		loc->rl_conf = conf;
+		fom_tlist_init(&loc->rl_runq);
+		sim_chan_init(&loc->rl_wake, "loc#%u::wake", i);
+		cnt_init(&loc->rl_cnt_runq, NULL, "loc#%u::runq", i);
+		/* for reqh_sim() before the threads are started. */
+		loc->rl_thread.st_sim = s;
+	}
+	conf->rc_cfrm = sim_alloc(conf->rc_nr_clients *
+				  sizeof conf->rc_cfrm[0]);
+	conf->rc_sfrm = sim_alloc(conf->rc_nr_clients *
+				  sizeof conf->rc_sfrm[0]);
+	for (i = 0; i < conf->rc_nr_clients; ++i) {
+		frm_init(&conf->rc_cfrm[i], conf, i, false);
+		frm_init(&conf->rc_sfrm[i], conf, i, true);
+	}
+	conf->rc_thread = sim_alloc(nr * sizeof conf->rc_thread[0]);
+	for (i = 0; i < nr; ++i) {
+		struct reqh_thread *rt = &conf->rc_thread[i];
+
+		rt->rt_conf = conf;
+		rt->rt_id   = i;
+		rt->rt_fom.fo_thread = rt;
+		rt->rt_fom.fo_key    = i;
+		fom_tlink_init(&rt->rt_fom);
+		sim_chan_init(&rt->rt_reply, "thread#%u::reply", i);
+	}
+	sim_timer_add(s, 0, reqh_threads_start, conf);
+}
+
+M0_INTERNAL void reqh_fini(struct reqh_conf *conf)
+{
+	struct sim *s  = reqh_sim(conf);
+	unsigned    nr = conf->rc_nr_clients * conf->rc_nr_threads;
+	unsigned    i;
+
+	conf->rc_shutdown = 1;
+	for (i = 0; i < conf->rc_nr_localities; ++i)
+		sim_chan_broadcast(&conf->rc_loc[i].rl_wake);
+	for (i = 0; i < conf->rc_nr_clients; ++i) {
+		sim_chan_broadcast(&conf->rc_cfrm[i].rf_wake);
+		sim_chan_broadcast(&conf->rc_sfrm[i].rf_wake);
+	}
+	/* drain events added during finalisation. */
+	sim_run(s);
+
+	for (i = 0; i < nr; ++i) {
+		struct reqh_thread *rt = &conf->rc_thread[i];
+
+		sim_thread_fini(&rt->rt_thread);
+		fom_tlink_fini(&rt->rt_fom);
+		sim_chan_fini(&rt->rt_reply);
+	}
+	sim_free(conf->rc_thread);
+	for (i = 0; i < conf->rc_nr_clients; ++i) {
+		sim_thread_fini(&conf->rc_cfrm[i].rf_thread);
+		sim_thread_fini(&conf->rc_sfrm[i].rf_thread);
+		frm_fini(&conf->rc_cfrm[i]);
+		frm_fini(&conf->rc_sfrm[i]);
+	}
+	sim_free(conf->rc_cfrm);
+	sim_free(conf->rc_sfrm);
+	for (i = 0; i < conf->rc_nr_localities; ++i) {
+		struct reqh_loc *loc = &conf->rc_loc[i];
+
+		sim_thread_fini(&loc->rl_thread);
+		fom_tlist_fini(&loc->rl_runq);
+		sim_chan_fini(&loc->rl_wake);
+		cnt_fini(&loc->rl_cnt_runq);
+	}
+	sim_free(conf->rc_loc);
+	M0_ASSERT(conf->rc_grp == NULL);
+	fom_tlist_fini(&conf->rc_tx_wait);
+	for (i = 0; i < conf->rc_nr_phases; ++i)
+		cnt_fini(&conf->rc_phase[i].rp_cnt);
+	cnt_fini(&conf->rc_cnt_op);
+	cnt_fini(&conf->rc_cnt_frm);
+	cnt_fini(&conf->rc_cnt_pkt);
+	cnt_fini(&conf->rc_cnt_runq);
+	cnt_fini(&conf->rc_cnt_tx_wait);
+	cnt_fini(&conf->rc_cnt_grp);
+	cnt_fini(&conf->rc_cnt_grp_time);
+}
+
+#define REQH_PARAM(field)					\
+	{ #field, offsetof(struct reqh_conf, rc_ ## field),	\
+	  sizeof(((struct reqh_conf *)NULL)->rc_ ## field) }
+
+static const struct {
+	const char *p_name;
+	size_t      p_offset;
+	size_t      p_size;
+} reqh_params[] = {
+	REQH_PARAM(nr_clients),
+	REQH_PARAM(nr_threads),
+	REQH_PARAM(nr_ops),
+	REQH_PARAM(item_size),
+	REQH_PARAM(reply_size),
+	REQH_PARAM(think_min),
+	REQH_PARAM(think_max),
+	REQH_PARAM(frm_items_max),
+	REQH_PARAM(frm_nob_max),
+	REQH_PARAM(frm_timeout),
+	REQH_PARAM(frm_delay),
+	REQH_PARAM(net_delay_min),
+	REQH_PARAM(net_delay_max),
+	REQH_PARAM(net_rate),
+	REQH_PARAM(nr_localities),
+	REQH_PARAM(grp_tx_max),
+	REQH_PARAM(grp_timeout),
+	REQH_PARAM(grp_inflight_max),
+	REQH_PARAM(tx_log_size),
+	REQH_PARAM(log_delay_min),
+	REQH_PARAM(log_delay_max),
+	REQH_PARAM(log_rate),
+	REQH_PARAM(tx_sync)
+};
+
+#undef REQH_PARAM
+
+static int reqh_param_set(struct reqh_conf *conf, const char *name,
+			  unsigned long long val)
+{
+	char  *field;
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(reqh_params); ++i) {
+		if (strcmp(reqh_params[i].p_name, name) != 0)
+			continue;
+		field = (char *)conf + reqh_params[i].p_offset;
+		switch (reqh_params[i].p_size) {
+		case sizeof(bool):
+			*(bool *)field = val != 0;
+			break;
+		case sizeof(unsigned):
+			*(unsigned *)field = val;
+			break;
+		case sizeof(unsigned long long):
+			*(unsigned long long *)field = val;
+			break;
+		default:
+			M0_IMPOSSIBLE("Unexpected parameter size.");
+		}
+		return 0;
+	}
+	return -ENOENT;
+}
+
+M0_INTERNAL int reqh_conf_load(struct reqh_conf *conf, const char *path)
+{
+	struct reqh_phase *ph;
+	FILE              *f;
+	char               line[256];
+	char               name[64];
+	char               tx[8];
+	unsigned long long val;
+	unsigned           lineno = 0;
+	unsigned           nr_phases = 0;
+	int                nr;
+	int                rc = 0;
+
+	f = fopen(path, "r");
+	if (f == NULL)
+		return -errno;
+	while (rc == 0 && fgets(line, sizeof line, f) != NULL) {
+		++lineno;
+		if (sscanf(line, " %63s", name) != 1 || name[0] == '#')
+			continue;
+		if (strcmp(name, "phase") == 0) {
+			if (nr_phases == REQH_PHASE_MAX) {
+				rc = -E2BIG;
+				break;
+			}
+			ph = &conf->rc_phase[nr_phases];
+			*tx = 0;
+			nr = sscanf(line, " phase %63s %llu %llu %llu %llu %7s",
+				    name, &ph->rp_cpu_min, &ph->rp_cpu_max,
+				    &ph->rp_wait_min, &ph->rp_wait_max, tx);
+			if (nr < 5 || ph->rp_cpu_min > ph->rp_cpu_max ||
+			    ph->rp_wait_min > ph->rp_wait_max) {
+				rc = -EINVAL;
+				break;
+			}
+			ph->rp_tx = strcmp(tx, "tx") == 0;
+			ph->rp_name = strdup(name);
+			conf->rc_nr_phases = ++nr_phases;
+		} else if (sscanf(line, " %63s %llu", name, &val) != 2)
+			rc = -EINVAL;
+		else
+			rc = reqh_param_set(conf, name, val);
+	}
+	if (rc != 0)
+		fprintf(stderr, "%s:%u: cannot parse \"%s\": %d\n",
+			path, lineno, name, rc);
+	fclose(f);
+	return rc;
+}
+
+/** @} end of desim group */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
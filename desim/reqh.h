@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __MOTR_DESIM_REQH_H__
+#define __MOTR_DESIM_REQH_H__
+
+#include "lib/tlist.h"
+#include "lib/types.h"
+#include "desim/sim.h"
+
+/**
+   @addtogroup desim desim
+
+   <b>Request handler model</b>
+
+   reqh.[ch] model the path of a request through a motr server: rpc
+   formation, fom locality scheduler and BE group commit.
+
+   Each client thread has a single request (a fom) in flight. The request is
+   queued to the client rpc formation, which sends a packet when it has
+   reqh_conf::rc_frm_items_max items, reqh_conf::rc_frm_nob_max bytes or when
+   its oldest item has waited for reqh_conf::rc_frm_timeout. A packet arrives
+   at the server after a network delay.
+
+   On the server a fom is executed by the handler thread of its home locality
+   (chosen by the client thread, as a fid hash would be). A fom goes through
+   reqh_conf::rc_phase[] phases. A phase takes some time on the locality
+   thread (rp_cpu_*), after which the fom either proceeds to the next phase
+   on the same thread or waits for rp_wait_* without holding the thread (a
+   stob i/o, say) and is queued back to the locality run-queue.
+
+   A transactional phase (rp_tx) adds the fom transaction to the current BE
+   group. A group is closed when it has reqh_conf::rc_grp_tx_max
+   transactions or reqh_conf::rc_grp_timeout after it was opened, and is
+   logged if there are fewer than reqh_conf::rc_grp_inflight_max groups
+   being logged; otherwise foms block until the full group can be closed, as
+   they do in m0_be_tx_open(). With reqh_conf::rc_tx_sync the fom waits
+   until its group is logged.
+
+   The reply goes through the server rpc formation of the client session and
+   wakes the client thread up.
+
+   All times are in nanoseconds and can be taken directly from addb2: phase
+   and state timelines of foms (fom-phase and fom-state records), sizes and
+   timings of BE groups (tx-to-gr and be-tx records). See reqh_conf_load()
+   and scripts/addb-py/chronometry/desim_conf.py.
+
+   @{
+ */
+
+enum {
+	REQH_PHASE_MAX = 32
+};
+
+struct reqh_phase {
+	char              *rp_name;
+	/** Service time on the locality thread. */
+	sim_time_t         rp_cpu_min;
+	sim_time_t         rp_cpu_max;
+	/** Time waited off the locality thread after the service. */
+	sim_time_t         rp_wait_min;
+	sim_time_t         rp_wait_max;
+	/**
+	 * The fom closes its transaction at the end of the phase. The wait of
+	 * such a phase is the wait for the group, rp_wait_* are not used.
+	 */
+	bool               rp_tx;
+	/** Time from the phase start to the next phase, as addb2 reports. */
+	struct cnt         rp_cnt;
+};
+
+/** rpc formation queue of a session, in one direction. */
+struct reqh_frm {
+	struct reqh_conf  *rf_conf;
+	bool               rf_reply;
+	unsigned           rf_id;
+	struct m0_tl       rf_queue;
+	unsigned           rf_nr;
+	unsigned long      rf_nob;
+	struct sim_chan    rf_wake;
+	struct sim_thread  rf_thread;
+};
+
+struct reqh_loc {
+	struct reqh_conf  *rl_conf;
+	struct m0_tl       rl_runq;
+	unsigned           rl_nr;
+	struct sim_chan    rl_wake;
+	struct sim_thread  rl_thread;
+	/** Run-queue length seen by a fom queued to the locality. */
+	struct cnt         rl_cnt_runq;
+};
+
+/** A request: a fom on the server, a client operation on the client. */
+struct reqh_fom {
+	struct reqh_thread *fo_thread;
+	unsigned            fo_key;
+	unsigned            fo_phase;
+	bool                fo_replied;
+	sim_time_t          fo_start;
+	sim_time_t          fo_phase_start;
+	sim_time_t          fo_queued;
+	struct m0_tlink     fo_linkage;
+	uint64_t            fo_magic;
+};
+
+struct reqh_thread {
+	struct sim_thread   rt_thread;
+	struct reqh_conf   *rt_conf;
+	unsigned            rt_id;
+	struct reqh_fom     rt_fom;
+	struct sim_chan     rt_reply;
+};
+
+struct reqh_grp;
+
+struct reqh_conf {
+	/* workload */
+	unsigned            rc_nr_clients;
+	unsigned            rc_nr_threads;
+	unsigned long       rc_nr_ops;
+	unsigned long       rc_item_size;
+	unsigned long       rc_reply_size;
+	sim_time_t          rc_think_min;
+	sim_time_t          rc_think_max;
+	/* rpc formation */
+	unsigned            rc_frm_items_max;
+	unsigned long       rc_frm_nob_max;
+	sim_time_t          rc_frm_timeout;
+	sim_time_t          rc_frm_delay;
+	/* network */
+	sim_time_t          rc_net_delay_min;
+	sim_time_t          rc_net_delay_max;
+	unsigned long long  rc_net_rate;
+	/* fom locality scheduler */
+	unsigned            rc_nr_localities;
+	unsigned            rc_nr_phases;
+	struct reqh_phase   rc_phase[REQH_PHASE_MAX];
+	/* BE group commit */
+	unsigned            rc_grp_tx_max;
+	sim_time_t          rc_grp_timeout;
+	unsigned            rc_grp_inflight_max;
+	unsigned long       rc_tx_log_size;
+	sim_time_t          rc_log_delay_min;
+	sim_time_t          rc_log_delay_max;
+	unsigned long long  rc_log_rate;
+	bool                rc_tx_sync;
+
+	/* state */
+	int                 rc_shutdown;
+	unsigned long       rc_done;
+	struct reqh_thread *rc_thread;
+	struct reqh_frm    *rc_cfrm;
+	struct reqh_frm    *rc_sfrm;
+	struct reqh_loc    *rc_loc;
+	struct reqh_grp    *rc_grp;
+	unsigned            rc_grp_inflight;
+	/** foms waiting for the full current group to be closed. */
+	struct m0_tl        rc_tx_wait;
+
+	/** Client operation latency. */
+	struct cnt          rc_cnt_op;
+	/** Time a request waits in rpc formation. */
+	struct cnt          rc_cnt_frm;
+	/** Items in a packet. */
+	struct cnt          rc_cnt_pkt;
+	/** Time a fom waits in a locality run-queue. */
+	struct cnt          rc_cnt_runq;
+	/** Time a fom waits for a group to be closed. */
+	struct cnt          rc_cnt_tx_wait;
+	/** Transactions in a logged group. */
+	struct cnt          rc_cnt_grp;
+	/** Time from group open to group logged. */
+	struct cnt          rc_cnt_grp_time;
+};
+
+M0_INTERNAL void reqh_init(struct sim *s, struct reqh_conf *conf);
+M0_INTERNAL void reqh_fini(struct reqh_conf *conf);
+
+/**
+ * Loads configuration parameters from a file.
+ *
+ * Each line is either "<parameter> <value>", where parameter is a name of
+ * a reqh_conf field without the "rc_" prefix (e.g., "grp_tx_max 256"), or
+ * "phase <name> <cpu_min> <cpu_max> <wait_min> <wait_max> [tx]", adding a fom
+ * phase. Empty lines and lines starting with '#' are ignored. Phases of the
+ * file replace the phases already in the configuration.
+ */
+M0_INTERNAL int reqh_conf_load(struct reqh_conf *conf, const char *path);
+
+#endif /* __MOTR_DESIM_REQH_H__ */
+
+/** @} end of desim group */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
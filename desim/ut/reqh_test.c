@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include <stdlib.h>                /* exit */
+
+#include "motr/init.h"
+#include "lib/thread.h"            /* LAMBDA */
+#include "lib/getopts.h"
+
+#include "desim/sim.h"
+#include "desim/reqh.h"
+
+/**
+   @addtogroup desim desim
+   @{
+ */
+
+/*
+ * Defaults roughly follow a 4KB ioservice write fom. Use -f with a file
+ * produced by scripts/addb-py/chronometry/desim_conf.py to model a measured
+ * configuration.
+ */
+static struct reqh_conf reqh = {
+	.rc_nr_clients       =        4,
+	.rc_nr_threads       =       16,
+	.rc_nr_ops           =     1000,
+	.rc_item_size        =     4096,
+	.rc_reply_size       =      128,
+	.rc_think_min        =        0,
+	.rc_think_max        =    10000,
+	.rc_frm_items_max    =       16,
+	.rc_frm_nob_max      =  1 << 17,
+	.rc_frm_timeout      =    20000,
+	.rc_frm_delay        =     2000,
+	.rc_net_delay_min    =    10000, /* microsecond */
+	.rc_net_delay_max    =    20000,
+	.rc_net_rate         = 1000000000, /* 1GB/sec */
+	.rc_nr_localities    =        8,
+	.rc_nr_phases        =        5,
+	.rc_phase = {
+		{ "init",      5000,  10000,      0,       0, false },
+		{ "tx-open",   2000,   5000,      0,       0, false },
+		{ "stob-io",  10000,  20000, 100000,  500000, false },
+		{ "tx-close",  5000,  10000,      0,       0, true  },
+		{ "reply",     2000,   5000,      0,       0, false }
+	},
+	.rc_grp_tx_max       =      256,
+	.rc_grp_timeout      =  1000000, /* millisecond */
+	.rc_grp_inflight_max =        2,
+	.rc_tx_log_size      =     8192,
+	.rc_log_delay_min    =   500000,
+	.rc_log_delay_max    =  1000000,
+	.rc_log_rate         = 500000000,
+	.rc_tx_sync          =    false
+};
+
+int main(int argc, char **argv)
+{
+	struct sim s;
+	int        result;
+
+	result = m0_init(NULL);
+	M0_ASSERT(result == 0);
+
+	result = M0_GETOPTS(argv[0], argc, argv,
+	    M0_HELPARG('h'),
+	    M0_STRINGARG('f', "configuration file",
+		LAMBDA(void, (const char *path) {
+			if (reqh_conf_load(&reqh, path) != 0)
+				exit(EXIT_FAILURE);
+		})),
+	    M0_FORMATARG('c', "clients", "%u", &reqh.rc_nr_clients),
+	    M0_FORMATARG('t', "threads", "%u", &reqh.rc_nr_threads),
+	    M0_FORMATARG('n', "operations per thread", "%lu",
+			 &reqh.rc_nr_ops),
+	    M0_FORMATARG('l', "localities", "%u", &reqh.rc_nr_localities),
+	    M0_FORMATARG('i', "rpc items max", "%u",
+			 &reqh.rc_frm_items_max),
+	    M0_FORMATARG('g', "group transactions max", "%u",
+			 &reqh.rc_grp_tx_max),
+	    M0_FORMATARG('G', "groups in flight max", "%u",
+			 &reqh.rc_grp_inflight_max),
+	    M0_VOIDARG('s', "wait for transaction log",
+		       LAMBDA(void, (void){ reqh.rc_tx_sync = true; } )),
+	    M0_VOIDARG('v', "increase verbosity",
+		       LAMBDA(void, (void){ sim_log_level++; } )));
+
+	M0_ASSERT(result == 0);
+
+	sim_init(&s);
+	reqh_init(&s, &reqh);
+	sim_run(&s);
+	cnt_dump_all();
+	/* operations per second and average latency in microseconds. */
+	sim_log(&s, SLL_WARN, "%10.2f %10.2f\n",
+		1000000000.0 * reqh.rc_done / s.ss_bolt,
+		reqh.rc_cnt_op.c_nr != 0 ?
+		reqh.rc_cnt_op.c_sum / 1000.0 / reqh.rc_cnt_op.c_nr : 0.0);
+	reqh_fini(&reqh);
+	sim_fini(&s);
+	m0_fini();
+	return 0;
+}
+
+/** @} end of desim group */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
@@ -30,6 +30,7 @@
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_DIX
 #include "lib/trace.h"
 #include "lib/ext.h"    /* struct m0_ext */
+#include "lib/memory.h" /* M0_ALLOC_ARR */
 #include "sm/sm.h"
 #include "pool/pool.h"  /* m0_pools_common, m0_pool_version_find */
 #include "dix/layout.h"
@@ -127,6 +128,11 @@ static void dix_cli_state_set(struct m0_dix_cli     *cli,
 	m0_sm_state_set(&cli->dx_sm, state);
 }
 
+enum {
+	/** Number of slots in m0_dix_cli::dx_lcache. */
+	DIX_LCACHE_NR = 1024
+};
+
 M0_INTERNAL int m0_dix_cli_init(struct m0_dix_cli       *cli,
 				struct m0_sm_group      *sm_group,
 				struct m0_pools_common  *pc,
@@ -135,6 +141,10 @@ M0_INTERNAL int m0_dix_cli_init(struct m0_dix_cli       *cli,
 {
 	M0_ENTRY();
 	M0_SET0(cli);
+	M0_ALLOC_ARR(cli->dx_lcache, DIX_LCACHE_NR);
+	if (cli->dx_lcache == NULL)
+		return M0_ERR(-ENOMEM);
+	m0_mutex_init(&cli->dx_lcache_lock);
 	cli->dx_pc   = pc;
 	cli->dx_ldom = ldom;
 	cli->dx_pver = m0_pool_version_find(pc, pver);
@@ -267,10 +277,16 @@ M0_INTERNAL void m0_dix_cli_stop_lock(struct m0_dix_cli *cli)
 
 M0_INTERNAL void m0_dix_cli_fini(struct m0_dix_cli *cli)
 {
+	uint32_t i;
+
 	M0_PRE(m0_dix_cli_is_locked(cli));
 	m0_dix_ldesc_fini(&cli->dx_root);
 	m0_dix_ldesc_fini(&cli->dx_layout);
 	m0_dix_ldesc_fini(&cli->dx_ldescr);
+	for (i = 0; i < DIX_LCACHE_NR; i++)
+		m0_dix_ldesc_fini(&cli->dx_lcache[i].ls_desc);
+	m0_free0(&cli->dx_lcache);
+	m0_mutex_fini(&cli->dx_lcache_lock);
 	m0_sm_fini(&cli->dx_sm);
 	cli->dx_dtms = NULL;
 }
@@ -285,6 +301,57 @@ M0_INTERNAL void m0_dix_cli_fini_lock(struct m0_dix_cli *cli)
 	m0_sm_group_unlock(grp);
 }
 
+static struct m0_dix_lcache_slot *dix_lcache_slot(struct m0_dix_cli   *cli,
+						 const struct m0_fid *fid)
+{
+	return &cli->dx_lcache[m0_fid_hash(fid) % DIX_LCACHE_NR];
+}
+
+M0_INTERNAL bool m0_dix__lcache_get(struct m0_dix_cli *cli,
+				    struct m0_dix     *dix)
+{
+	struct m0_dix_lcache_slot *slot = dix_lcache_slot(cli, &dix->dd_fid);
+	bool                       hit;
+
+	M0_PRE(dix->dd_layout.dl_type == DIX_LTYPE_UNKNOWN);
+	m0_mutex_lock(&cli->dx_lcache_lock);
+	hit = m0_fid_eq(&slot->ls_fid, &dix->dd_fid) &&
+	      m0_dix_desc_set(dix, &slot->ls_desc) == 0;
+	m0_mutex_unlock(&cli->dx_lcache_lock);
+	if (!hit)
+		dix->dd_layout.dl_type = DIX_LTYPE_UNKNOWN;
+	return hit;
+}
+
+M0_INTERNAL void m0_dix__lcache_put(struct m0_dix_cli   *cli,
+				    const struct m0_dix *dix)
+{
+	struct m0_dix_lcache_slot *slot = dix_lcache_slot(cli, &dix->dd_fid);
+
+	M0_PRE(dix->dd_layout.dl_type == DIX_LTYPE_DESCR);
+	m0_mutex_lock(&cli->dx_lcache_lock);
+	m0_dix_ldesc_fini(&slot->ls_desc);
+	if (m0_dix_ldesc_copy(&slot->ls_desc,
+			      &dix->dd_layout.u.dl_desc) == 0)
+		slot->ls_fid = dix->dd_fid;
+	else
+		slot->ls_fid = M0_FID0;
+	m0_mutex_unlock(&cli->dx_lcache_lock);
+}
+
+M0_INTERNAL void m0_dix__lcache_del(struct m0_dix_cli   *cli,
+				    const struct m0_fid *fid)
+{
+	struct m0_dix_lcache_slot *slot = dix_lcache_slot(cli, fid);
+
+	m0_mutex_lock(&cli->dx_lcache_lock);
+	if (m0_fid_eq(&slot->ls_fid, fid)) {
+		m0_dix_ldesc_fini(&slot->ls_desc);
+		slot->ls_fid = M0_FID0;
+	}
+	m0_mutex_unlock(&cli->dx_lcache_lock);
+}
+
 M0_INTERNAL int m0_dix__root_set(const struct m0_dix_cli *cli,
 				 struct m0_dix           *out)
 {
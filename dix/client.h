@@ -155,6 +155,7 @@
  */
 
 #include "lib/chan.h"   /* m0_clink */
+#include "lib/mutex.h"  /* m0_mutex */
 #include "sm/sm.h"      /* m0_sm */
 #include "dix/layout.h" /* m0_dix_ldesc */
 #include "dix/meta.h"   /* m0_dix_meta_req */
@@ -179,6 +180,15 @@ enum m0_dix_cli_state {
         DIXCLI_FAILURE,
 };
 
+/**
+ * Slot of the layout cache of DIX client, see m0_dix_cli::dx_lcache.
+ */
+struct m0_dix_lcache_slot {
+	/** Index fid, M0_FID0 if the slot is empty. */
+	struct m0_fid       ls_fid;
+	struct m0_dix_ldesc ls_desc;
+};
+
 struct m0_dix_cli {
 	struct m0_sm             dx_sm;
 	struct m0_clink          dx_clink;
@@ -193,6 +203,18 @@ struct m0_dix_cli {
 	struct m0_dix_ldesc      dx_layout;
 	struct m0_dix_ldesc      dx_ldescr;
 	struct m0_dtm0_service  *dx_dtms;
+	/**
+	 * Layout descriptors of ordinary indices found by previous requests,
+	 * so that the layout lookup in the "layout" meta-index is skipped.
+	 *
+	 * The cache is direct-mapped by index fid and lives as long as the
+	 * client. A stale layout is detected by CAS service, which compares
+	 * the received layout with the stored one (-EKEYEXPIRED), and is
+	 * dropped then. Requests of different SM groups share the cache, so
+	 * it is protected by ->dx_lcache_lock.
+	 */
+	struct m0_dix_lcache_slot *dx_lcache;
+	struct m0_mutex            dx_lcache_lock;
 
 	/**
 	 * The callback function is triggerred to update FSYNC records
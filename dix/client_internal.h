@@ -65,6 +65,23 @@ M0_INTERNAL int m0_dix__ldescr_set(const struct m0_dix_cli *cli,
 M0_INTERNAL struct m0_pool_version *m0_dix_pver(const struct m0_dix_cli *cli,
 						const struct m0_dix     *dix);
 
+/**
+ * Sets layout descriptor of 'dix' from the client layout cache.
+ *
+ * @pre dix->dd_layout.dl_type == DIX_LTYPE_UNKNOWN
+ * @retval true the layout is cached, dix->dd_layout is DIX_LTYPE_DESCR now.
+ */
+M0_INTERNAL bool m0_dix__lcache_get(struct m0_dix_cli *cli,
+				    struct m0_dix     *dix);
+
+/** Remembers layout descriptor of 'dix' in the client layout cache. */
+M0_INTERNAL void m0_dix__lcache_put(struct m0_dix_cli   *cli,
+				    const struct m0_dix *dix);
+
+/** Forgets the cached layout of the index with the given fid. */
+M0_INTERNAL void m0_dix__lcache_del(struct m0_dix_cli   *cli,
+				    const struct m0_fid *fid);
+
 /** @} end of dix group */
 #endif /* __MOTR_DIX_CLIENT_INTERNAL_H__ */
 
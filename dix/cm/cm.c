@@ -179,7 +179,10 @@
   process.
 
   @subsection DIXCMDLD-lspec-cm-start Copy machine startup
-  Starts and initialises DIX copy machine data iterator.
+  Starts and initialises DIX copy machine data iterators. Repair starts
+  m0_dix_cm::dcm_it_nr iterators in different localities, each of them
+  retrieves the records whose key hash falls into its share, so that records
+  of all catalogues are processed concurrently. Re-balance uses one iterator.
   @see m0_dix_cm_iter_start()
 
   @subsection DIXCMDLD-lspec-cm-data-next Copy machine data iterator
@@ -207,7 +210,10 @@
   corresponding parity group needs reconstruction, if yes then checks whether it
   serves the unit that contains data and has the lowest index in scope of parity
   group, if so then this node is responsible for data reconstruction. After that
-  the destination is determined and copy packet is created.
+  the destination is determined and copy packet is created. Concurrent
+  iterators run the loop independently, each skipping the keys it doesn't own,
+  and m0_dix_cm_data_next() takes records from the iterators which have them
+  retrieved.
 
   @subsection DIXCMDLD-lspec-cm-sliding-window Copy machine sliding window
   DIX copy machine supports only infinite sliding window that does not
@@ -331,6 +337,10 @@ M0_INTERNAL void m0_dix_cm_type_deregister(void)
 
 M0_INTERNAL int m0_dix_cm_setup(struct m0_cm *cm)
 {
+	struct m0_dix_cm *dcm = cm2dix(cm);
+
+	dcm->dcm_it_nr = dcm->dcm_type == &dix_repair_dcmt ?
+		M0_DIX_CM_ITER_NR : 1;
 	return M0_RC(0);
 }
 
@@ -343,6 +353,57 @@ M0_INTERNAL int m0_dix_cm_prepare(struct m0_cm *cm)
 	return M0_RC(0);
 }
 
+static bool dix_cm_iter_ready_cb(struct m0_clink *cl)
+{
+	struct m0_dix_cm_iter *iter = M0_AMB(iter, cl, di_ready_clink);
+	struct m0_dix_cm      *dcm  = container_of(iter - iter->di_idx,
+						  struct m0_dix_cm, dcm_it[0]);
+
+	m0_chan_lock(&dcm->dcm_it_ready);
+	iter->di_ready = true;
+	m0_chan_broadcast(&dcm->dcm_it_ready);
+	m0_chan_unlock(&dcm->dcm_it_ready);
+	return false;
+}
+
+static bool dix_cm_iters_drained(struct m0_dix_cm *dcm, uint32_t nr)
+{
+	bool drained;
+
+	m0_chan_lock(&dcm->dcm_it_ready);
+	drained = m0_forall(i, nr, !dcm->dcm_it[i].di_pending ||
+				   dcm->dcm_it[i].di_ready);
+	m0_chan_unlock(&dcm->dcm_it_ready);
+	return drained;
+}
+
+/**
+ * Stops the first @nr iterators. Iterators retrieving a record requested by
+ * m0_dix_cm_data_next() are waited for first, as the iterator can only be
+ * stopped while it is idle.
+ */
+static void dix_cm_iters_stop(struct m0_dix_cm *dcm, uint32_t nr)
+{
+	struct m0_dix_cm_iter *iter;
+	struct m0_clink        clink;
+	uint32_t               i;
+
+	m0_clink_init(&clink, NULL);
+	m0_clink_add_lock(&dcm->dcm_it_ready, &clink);
+	while (!dix_cm_iters_drained(dcm, nr))
+		m0_chan_wait(&clink);
+	m0_clink_del_lock(&clink);
+	m0_clink_fini(&clink);
+
+	for (i = 0; i < nr; i++) {
+		iter = &dcm->dcm_it[i];
+		m0_clink_del_lock(&iter->di_ready_clink);
+		m0_clink_fini(&iter->di_ready_clink);
+		m0_dix_cm_iter_stop(iter);
+		M0_SET0(iter);
+	}
+}
+
 static bool dix_cm_proxies_completed_cb(struct m0_clink *cl)
 {
 	struct m0_dix_cm        *dcm = M0_AMB(dcm, cl, dcm_proxies_completed);
@@ -369,10 +430,14 @@ M0_INTERNAL int m0_dix_cm_start(struct m0_cm *cm)
 	struct m0_dix_cm        *dcm  = cm2dix(cm);
 	struct m0_cm_aggr_group *ag   = NULL;
 	struct m0_reqh          *reqh = cm->cm_service.rs_reqh;
+	struct m0_dix_cm_iter   *iter;
+	uint32_t                 i;
 	int                      rc;
 	M0_ENTRY();
 
 	M0_PRE(m0_cm_is_locked(cm));
+	M0_PRE(dcm->dcm_it_nr > 0 && dcm->dcm_it_nr <= M0_DIX_CM_ITER_MAX);
+	M0_PRE(dcm->dcm_type == &dix_repair_dcmt || dcm->dcm_it_nr == 1);
 
 	if (!proxy_tlist_is_empty(&cm->cm_proxies)) {
 		/* Create end-marker ag and add it into ag incoming list. */
@@ -396,11 +461,28 @@ M0_INTERNAL int m0_dix_cm_start(struct m0_cm *cm)
 	 * iterator to start. It prevents usual locality->CM locking order that
 	 * can lead to deadlock.
 	 */
+	m0_mutex_init(&dcm->dcm_it_guard);
+	m0_chan_init(&dcm->dcm_it_ready, &dcm->dcm_it_guard);
+	dcm->dcm_it_cur = 0;
 	m0_cm_unlock(cm);
-	rc = m0_dix_cm_iter_start(&dcm->dcm_it, dcm->dcm_type, reqh,
-				  m0_cm_rpc_machine_find(reqh)->rm_bulk_cutoff);
+	for (i = 0, rc = 0; i < dcm->dcm_it_nr && rc == 0; i++) {
+		iter = &dcm->dcm_it[i];
+		rc = m0_dix_cm_iter_start(iter, dcm->dcm_type, reqh,
+				m0_cm_rpc_machine_find(reqh)->rm_bulk_cutoff,
+				i, dcm->dcm_it_nr);
+		if (rc == 0) {
+			m0_clink_init(&iter->di_ready_clink,
+				      dix_cm_iter_ready_cb);
+			m0_clink_add_lock(&iter->di_completed,
+					  &iter->di_ready_clink);
+		}
+	}
+	if (rc != 0)
+		dix_cm_iters_stop(dcm, i - 1);
 	m0_cm_lock(cm);
 	if (rc != 0) {
+		m0_chan_fini_lock(&dcm->dcm_it_ready);
+		m0_mutex_fini(&dcm->dcm_it_guard);
 		if (ag != NULL) {
 			m0_cm_aggr_group_fini(ag);
 			m0_free(ag);
@@ -438,9 +520,16 @@ M0_INTERNAL void m0_dix_cm_stop(struct m0_cm *cm)
 	}
 	/* release the cm lock, because m0_dix_cm_iter_stop() may block. */
 	m0_cm_unlock(cm);
-	m0_dix_cm_iter_stop(&dcm->dcm_it);
+	dix_cm_iters_stop(dcm, dcm->dcm_it_nr);
 	m0_cm_lock(cm);
-	M0_SET0(&dcm->dcm_it);
+	m0_chan_fini_lock(&dcm->dcm_it_ready);
+	m0_mutex_fini(&dcm->dcm_it_guard);
+	if (dcm->dcm_held_valid) {
+		m0_buf_free(&dcm->dcm_held.dr_key);
+		m0_buf_free(&dcm->dcm_held.dr_val);
+		dcm->dcm_held_valid = false;
+	}
+	dcm->dcm_iter_eof = false;
 	dcm->dcm_stop_time = m0_time_now();
 
 	if (dcm->dcm_stats_key >= 0) {
@@ -532,20 +621,141 @@ static int dix_cm_ag_setup(struct m0_cm    *cm,
 	return M0_RC(rc);
 }
 
+/**
+ * Adds a record retrieved by the iterator to the copy packet. A copy packet
+ * carries records of one component catalogue targeted to one device, so
+ * @taken is set to false if the record belongs to another copy packet.
+ * The record is freed on error.
+ */
+static int dix_cm_cp_rec_take(struct m0_dix_cm     *dcm,
+			      struct m0_cm_cp      *cp,
+			      struct m0_dix_cm_rec *rec,
+			      bool                 *taken)
+{
+	struct m0_dix_cm_cp *dix_cp = M0_AMB(dix_cp, cp, dc_base);
+	struct m0_cm_proxy  *proxy;
+	struct m0_fid        remote_cctg_fid = {};
+	struct m0_fid        dix_fid = {};
+	int                  rc;
+
+	/*
+	 * Convert FID of local component catalogue to FID of remote component
+	 * catalogue.
+	 */
+	m0_dix_fid_convert_cctg2dix(&rec->dr_cctg_fid, &dix_fid);
+	m0_dix_fid_convert_dix2cctg(&dix_fid, &remote_cctg_fid,
+				    rec->dr_sdev_id);
+	*taken = false;
+	if (dix_cp->dc_rec_nr == 0) {
+		/* Setup aggregation group. */
+		rc = dix_cm_ag_setup(&dcm->dcm_base, cp, &rec->dr_cctg_fid,
+				     rec->dr_pos);
+		if (rc != 0)
+			goto err;
+		proxy = dix_cm_sdev2proxy(dcm, rec->dr_sdev_id);
+		M0_ASSERT(proxy != NULL);
+		cp->c_cm_proxy           = proxy;
+		dix_cp->dc_ctg_fid       = remote_cctg_fid;
+		dix_cp->dc_ctg_op_flags |= COF_CREATE;
+		dix_cp->dc_is_local      = true;
+	} else if (!m0_fid_eq(&dix_cp->dc_ctg_fid, &remote_cctg_fid))
+		return M0_RC(0);
+	rc = m0_dix_cm_cp_rec_add(dix_cp, &rec->dr_key, &rec->dr_val);
+	if (rc != 0)
+		goto err;
+	*taken = true;
+	return M0_RC(0);
+err:
+	m0_buf_free(&rec->dr_key);
+	m0_buf_free(&rec->dr_val);
+	return M0_ERR(rc);
+}
+
+/**
+ * Returns true if the copy packet is to be sent without more records.
+ *
+ * Re-balance deletes every record from the local catalogue once the iterator
+ * moves past it, so re-balance copy packets carry one record each and a record
+ * is deleted only after it is transferred.
+ */
+static bool dix_cm_cp_is_ready(struct m0_dix_cm    *dcm,
+			       struct m0_dix_cm_cp *dix_cp)
+{
+	return dcm->dcm_type != &dix_repair_dcmt ||
+	       m0_dix_cm_cp_is_full(dix_cp);
+}
+
+static int dix_cm_cp_ready(struct m0_dix_cm *dcm, struct m0_dix_cm_cp *dix_cp)
+{
+	int rc;
+
+	rc = m0_dix_cm_cp_recs_pack(dix_cp, dcm->dcm_it[0].di_cutoff);
+	if (rc != 0)
+		return M0_ERR(rc);
+	dcm->dcm_cp_in_progress = true;
+	return M0_FSO_AGAIN;
+}
+
+/**
+ * Makes idle iterators retrieve the next record, unless the previous copy
+ * packet is still being processed, and returns an iterator which has retrieved
+ * its record, starting from m0_dix_cm::dcm_it_cur, so that records of one
+ * iterator go to the same copy packet while they can.
+ *
+ * If no record is retrieved yet, NULL is returned and the pump FOM is made to
+ * wait for any of the iterators.
+ */
+static struct m0_dix_cm_iter *dix_cm_iter_wait(struct m0_dix_cm *dcm)
+{
+	struct m0_dix_cm_iter *iter;
+	struct m0_fom         *pfom = &dcm->dcm_base.cm_cp_pump[0].p_fom;
+	uint32_t               i;
+
+	if (!dcm->dcm_cp_in_progress) {
+		for (i = 0; i < dcm->dcm_it_nr; i++) {
+			iter = &dcm->dcm_it[i];
+			if (!iter->di_pending && !iter->di_done) {
+				iter->di_pending = true;
+				m0_dix_cm_iter_next(iter);
+			}
+		}
+	}
+	m0_chan_lock(&dcm->dcm_it_ready);
+	for (i = 0, iter = NULL; i < dcm->dcm_it_nr && iter == NULL; i++) {
+		iter = &dcm->dcm_it[(dcm->dcm_it_cur + i) % dcm->dcm_it_nr];
+		if (!iter->di_ready)
+			iter = NULL;
+	}
+	if (iter != NULL) {
+		iter->di_ready = false;
+		dcm->dcm_it_cur = iter->di_idx;
+	} else if (!dcm->dcm_cp_in_progress) {
+		/* Completed copy packet wakes the pump FOM up otherwise. */
+		m0_fom_wait_on(pfom, &dcm->dcm_it_ready, &pfom->fo_cb);
+		M0_LOG(M0_DEBUG, "pump fom %p going to wait for iterators",
+		       pfom);
+	}
+	m0_chan_unlock(&dcm->dcm_it_ready);
+	return iter;
+}
+
+/**
+ * Fills the copy packet by records retrieved by the iterators.
+ *
+ * Repair packs records of one component catalogue targeted to one device into
+ * a copy packet, until M0_DIX_CM_CP_REC_MAX records or M0_DIX_CM_CP_NOB_MAX
+ * bytes are collected, so that per record RPC and transaction overhead of the
+ * target is amortised. The copy packet is filled during several calls: the
+ * function returns M0_FSO_WAIT while the iterators are retrieving the next
+ * records. The end of data is reported once all iterators reach it.
+ */
 M0_INTERNAL int m0_dix_cm_data_next(struct m0_cm *cm, struct m0_cm_cp *cp)
 {
 	struct m0_dix_cm      *dcm  = cm2dix(cm);
-	struct m0_dix_cm_iter *iter = &dcm->dcm_it;
-	struct m0_fom         *pfom = &cm->cm_cp_pump.p_fom;
-	struct m0_dix_cm_cp   *dix_cp;
-	struct m0_buf          key = {};
-	struct m0_buf          val = {};
-	struct m0_cm_proxy    *proxy;
-	struct m0_fid          local_cctg_fid = {};
-	struct m0_fid          remote_cctg_fid = {};
-	struct m0_fid          dix_fid = {};
-	uint64_t               processed_recs_nr;
-	uint32_t               sdev_id = (uint32_t)-1;
+	struct m0_dix_cm_iter *iter;
+	struct m0_dix_cm_cp   *dix_cp = M0_AMB(dix_cp, cp, dc_base);
+	struct m0_dix_cm_rec   rec;
+	bool                   taken;
 	int                    rc;
 
 	/* Inc progress counter. */
@@ -558,66 +768,56 @@ M0_INTERNAL int m0_dix_cm_data_next(struct m0_cm *cm, struct m0_cm_cp *cp)
 		return M0_RC(-ENODATA);
 	}
 
-	if (!dcm->dcm_iter_inprogress) {
-		if (!dcm->dcm_cp_in_progress) {
-			m0_chan_lock(&iter->di_completed);
-			m0_fom_wait_on(pfom, &iter->di_completed, &pfom->fo_cb);
-			m0_chan_unlock(&iter->di_completed);
-			m0_dix_cm_iter_next(iter);
-			dcm->dcm_iter_inprogress = true;
-			M0_LOG(M0_DEBUG, "pump fom %p going to wait for "
-					 "iter fom %p",
-					 pfom, &iter->di_fom);
-		}
-		return M0_FSO_WAIT;
-	} else {
-		dcm->dcm_iter_inprogress = false;
-		/* Set proxy for copy packet and fill key/value AT buffers. */
-		rc = m0_dix_cm_iter_get(iter, &key, &val, &sdev_id);
-		if (rc != 0) {
-			if (rc == -ENODATA)
-				cm->cm_last_out_hi = GRP_END_MARK_ID;
-			return M0_ERR(rc);
-		}
-		/* Setup aggregation group. */
-		m0_dix_cm_iter_cur_pos(iter, &local_cctg_fid,
-				       &processed_recs_nr);
-		rc = dix_cm_ag_setup(cm, cp, &local_cctg_fid,
-				     processed_recs_nr);
-		if (rc == 0) {
-			dix_cp = M0_AMB(dix_cp, cp, dc_base);
-			M0_ASSERT(dix_cp != NULL);
-			proxy = dix_cm_sdev2proxy(dcm, sdev_id);
-			M0_ASSERT(proxy != NULL);
-			cp->c_cm_proxy = proxy;
-			dix_cp->dc_key = key;
-			dix_cp->dc_val = val;
-
-			/*
-			 * Convert FID of local component catalogue to FID of
-			 * remote component catalogue,
-			 */
-			m0_dix_fid_convert_cctg2dix(&local_cctg_fid, &dix_fid);
-			m0_dix_fid_convert_dix2cctg(&dix_fid, &remote_cctg_fid,
-						    sdev_id);
+	if (dcm->dcm_iter_eof) {
+		cm->cm_last_out_hi = GRP_END_MARK_ID;
+		return M0_ERR(-ENODATA);
+	}
 
-			dix_cp->dc_ctg_fid       = remote_cctg_fid;
-			dix_cp->dc_ctg_op_flags |= COF_CREATE;
-			dix_cp->dc_is_local      = true;
-			dcm->dcm_cp_in_progress  = true;
+	if (dix_cp->dc_rec_nr == 0 && dcm->dcm_held_valid) {
+		dcm->dcm_held_valid = false;
+		rc = dix_cm_cp_rec_take(dcm, cp, &dcm->dcm_held, &taken);
+		if (rc != 0)
+			return M0_ERR(rc);
+		M0_ASSERT(taken);
+		if (dix_cm_cp_is_ready(dcm, dix_cp))
+			return dix_cm_cp_ready(dcm, dix_cp);
+	}
 
-			rc = M0_FSO_AGAIN;
-		} else {
+	while ((iter = dix_cm_iter_wait(dcm)) != NULL) {
+		rec = (struct m0_dix_cm_rec) { .dr_sdev_id = (uint32_t)-1 };
+		iter->di_pending = false;
+		rc = m0_dix_cm_iter_get(iter, &rec.dr_key, &rec.dr_val,
+					&rec.dr_sdev_id);
+		if (rc != 0)
+			iter->di_done = true;
+		if (rc == -ENODATA &&
+		    !m0_forall(i, dcm->dcm_it_nr, dcm->dcm_it[i].di_done))
+			continue;
+		if (rc == -ENODATA && dix_cp->dc_rec_nr > 0) {
 			/*
-			 * Key/value buffers are not needed anymore in error
-			 * case. In case rc == 0 we will destroy these key and
-			 * val in dix_cp_fop_release().
+			 * Send the last copy packet, end of data is reported
+			 * next.
 			 */
-			m0_buf_free(&key);
-			m0_buf_free(&val);
+			dcm->dcm_iter_eof = true;
+			return dix_cm_cp_ready(dcm, dix_cp);
+		} else if (rc != 0) {
+			if (rc == -ENODATA)
+				cm->cm_last_out_hi = GRP_END_MARK_ID;
+			return M0_ERR(rc);
+		}
+		m0_dix_cm_iter_cur_pos(iter, &rec.dr_cctg_fid, &rec.dr_pos);
+		rc = dix_cm_cp_rec_take(dcm, cp, &rec, &taken);
+		if (rc != 0)
+			return M0_ERR(rc);
+		if (!taken) {
+			dcm->dcm_held       = rec;
+			dcm->dcm_held_valid = true;
+			return dix_cm_cp_ready(dcm, dix_cp);
 		}
-		return rc;
+		if (dix_cm_cp_is_ready(dcm, dix_cp))
+			return dix_cm_cp_ready(dcm, dix_cp);
 	}
+	return M0_FSO_WAIT;
 }
 
 M0_INTERNAL bool m0_dix_is_peer(struct m0_cm               *cm,
@@ -113,6 +113,21 @@ struct m0_dix_cm_stats {
 	uint64_t dcs_write_size;
 };
 
+/** Key/value record retrieved by DIX copy machine iterator. */
+struct m0_dix_cm_rec {
+	struct m0_buf dr_key;
+	struct m0_buf dr_val;
+	/** Device the record is targeted to. */
+	uint32_t      dr_sdev_id;
+	/** Local component catalogue of the record. */
+	struct m0_fid dr_cctg_fid;
+	/**
+	 * Number of processed records of the catalogue, see
+	 * m0_dix_cm_iter_cur_pos().
+	 */
+	uint64_t      dr_pos;
+};
+
 /** DIX copy machine context. */
 struct m0_dix_cm {
 	/* Base copy machine context. */
@@ -124,8 +139,32 @@ struct m0_dix_cm {
 	/** Operation that dix copy machine is going to execute. */
 	enum m0_cm_op          dcm_op;
 
-	/** DIX copy machine data iterator. */
-	struct m0_dix_cm_iter  dcm_it;
+	/**
+	 * DIX copy machine data iterators, running concurrently. Records are
+	 * split among the first dcm_it_nr of them, see m0_dix_cm_iter.
+	 */
+	struct m0_dix_cm_iter  dcm_it[M0_DIX_CM_ITER_MAX];
+
+	/**
+	 * Number of iterators started by m0_dix_cm_start(). It is set to
+	 * M0_DIX_CM_ITER_NR for repair by m0_dix_cm_setup() and can be changed
+	 * before the copy machine is started. Re-balance always uses one
+	 * iterator, because it deletes a record only after the copy packet
+	 * carrying it is processed, see m0_dix_cm_data_next().
+	 */
+	uint32_t               dcm_it_nr;
+
+	/** Iterator m0_dix_cm_data_next() takes records from first. */
+	uint32_t               dcm_it_cur;
+
+	/**
+	 * Channel signalled when a requested record is retrieved by any of the
+	 * iterators, see m0_dix_cm_iter::di_ready.
+	 */
+	struct m0_chan         dcm_it_ready;
+
+	/** Guard for dcm_it_ready and m0_dix_cm_iter::di_ready. */
+	struct m0_mutex        dcm_it_guard;
 
 	/**
 	 * Start time for DIX copy machine. This is recorded when the ready fop
@@ -142,14 +181,23 @@ struct m0_dix_cm {
 	/** Key for locality data that store total read/write size. */
 	int                    dcm_stats_key;
 
+	/** Indicates whether current CP is under processing. */
+	bool                   dcm_cp_in_progress;
+
 	/**
-	 * Indicates whether CM iterator is in process of retrieving next
-	 * value.
+	 * Record which does not belong to the copy packet being filled by
+	 * m0_dix_cm_data_next(), it starts the next copy packet.
 	 */
-	bool                   dcm_iter_inprogress;
+	struct m0_dix_cm_rec   dcm_held;
 
-	/** Indicates whether current CP is under processing. */
-	bool                   dcm_cp_in_progress;
+	/** True if dcm_held contains a record. */
+	bool                   dcm_held_valid;
+
+	/**
+	 * All iterators reached the end of data while the last copy packet was
+	 * being filled.
+	 */
+	bool                   dcm_iter_eof;
 
 	/**
 	 * Clink to detect that all proxies completed their local pump FOM.
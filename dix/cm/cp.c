@@ -114,6 +114,150 @@ static int dix_cm_cp_dtx_failure(struct m0_cm_cp *cp)
 	return tx->t_sm.sm_rc;
 }
 
+M0_INTERNAL int m0_dix_cm_cp_rec_add(struct m0_dix_cm_cp *dix_cp,
+				     struct m0_buf       *key,
+				     struct m0_buf       *val)
+{
+	M0_PRE(dix_cp->dc_is_local);
+	M0_PRE(dix_cp->dc_rec_nr < M0_DIX_CM_CP_REC_MAX);
+
+	if (dix_cp->dc_keys == NULL) {
+		M0_ALLOC_ARR(dix_cp->dc_keys, M0_DIX_CM_CP_REC_MAX);
+		M0_ALLOC_ARR(dix_cp->dc_vals, M0_DIX_CM_CP_REC_MAX);
+		if (dix_cp->dc_keys == NULL || dix_cp->dc_vals == NULL) {
+			m0_free0(&dix_cp->dc_keys);
+			m0_free0(&dix_cp->dc_vals);
+			return M0_ERR(-ENOMEM);
+		}
+	}
+	dix_cp->dc_keys[dix_cp->dc_rec_nr] = *key;
+	dix_cp->dc_vals[dix_cp->dc_rec_nr] = *val;
+	dix_cp->dc_rec_nob += key->b_nob + val->b_nob;
+	M0_CNT_INC(dix_cp->dc_rec_nr);
+	return M0_RC(0);
+}
+
+M0_INTERNAL bool m0_dix_cm_cp_is_full(const struct m0_dix_cm_cp *dix_cp)
+{
+	return dix_cp->dc_rec_nr == M0_DIX_CM_CP_REC_MAX ||
+	       dix_cp->dc_rec_nob >= M0_DIX_CM_CP_NOB_MAX;
+}
+
+/** Frees the records owned by a local copy packet. */
+static void dix_cm_cp_recs_free(struct m0_dix_cm_cp *dix_cp)
+{
+	uint32_t i;
+
+	if (dix_cp->dc_is_local && dix_cp->dc_keys != NULL) {
+		for (i = 0; i < dix_cp->dc_rec_nr; ++i) {
+			m0_buf_free(&dix_cp->dc_keys[i]);
+			m0_buf_free(&dix_cp->dc_vals[i]);
+		}
+	}
+	m0_free0(&dix_cp->dc_keys);
+	m0_free0(&dix_cp->dc_vals);
+}
+
+static m0_bcount_t dix_cm_cp_packed_nob(const struct m0_buf *bufs,
+					uint32_t             nr)
+{
+	m0_bcount_t nob = 0;
+	uint32_t    i;
+
+	for (i = 0; i < nr; ++i)
+		nob += sizeof(uint64_t) + m0_align(bufs[i].b_nob, 8);
+	return nob;
+}
+
+static int dix_cm_cp_pack(struct m0_buf       *dst,
+			  const struct m0_buf *bufs,
+			  uint32_t             nr,
+			  m0_bcount_t          cutoff)
+{
+	m0_bcount_t  nob = dix_cm_cp_packed_nob(bufs, nr);
+	char        *cur;
+	uint32_t     i;
+
+	M0_PRE(dst->b_nob == 0 && dst->b_addr == NULL);
+
+	/* Buffers are sent using bulk from the cutoff, see m0_rpc_at_add(). */
+	if (nob >= cutoff)
+		dst->b_addr = m0_alloc_aligned(nob, m0_pageshift_get());
+	else
+		dst->b_addr = m0_alloc(nob);
+	if (dst->b_addr == NULL)
+		return M0_ERR(-ENOMEM);
+	dst->b_nob = nob;
+	for (cur = dst->b_addr, i = 0; i < nr; ++i) {
+		*(uint64_t *)cur = bufs[i].b_nob;
+		cur += sizeof(uint64_t);
+		memcpy(cur, bufs[i].b_addr, bufs[i].b_nob);
+		cur += m0_align(bufs[i].b_nob, 8);
+	}
+	return M0_RC(0);
+}
+
+static int dix_cm_cp_unpack(const struct m0_buf *src,
+			    struct m0_buf       *bufs,
+			    uint32_t             nr)
+{
+	char        *cur = src->b_addr;
+	m0_bcount_t  left = src->b_nob;
+	uint64_t     nob;
+	uint32_t     i;
+
+	for (i = 0; i < nr; ++i) {
+		if (left < sizeof(uint64_t))
+			return M0_ERR(-EPROTO);
+		nob = *(uint64_t *)cur;
+		cur  += sizeof(uint64_t);
+		left -= sizeof(uint64_t);
+		if (nob > left)
+			return M0_ERR(-EPROTO);
+		bufs[i] = M0_BUF_INIT(nob, cur);
+		nob = min64u(m0_align(nob, 8), left);
+		cur  += nob;
+		left -= nob;
+	}
+	return left == 0 ? M0_RC(0) : M0_ERR(-EPROTO);
+}
+
+M0_INTERNAL int m0_dix_cm_cp_recs_pack(struct m0_dix_cm_cp *dix_cp,
+				       m0_bcount_t          cutoff)
+{
+	int rc;
+
+	M0_PRE(dix_cp->dc_is_local && dix_cp->dc_rec_nr > 0);
+
+	rc = dix_cm_cp_pack(&dix_cp->dc_key, dix_cp->dc_keys,
+			    dix_cp->dc_rec_nr, cutoff) ?:
+	     dix_cm_cp_pack(&dix_cp->dc_val, dix_cp->dc_vals,
+			    dix_cp->dc_rec_nr, cutoff);
+	if (rc != 0)
+		m0_buf_free(&dix_cp->dc_key);
+	else
+		dix_cm_cp_recs_free(dix_cp);
+	return M0_RC(rc);
+}
+
+/** Finds the records of an incoming copy packet in the packed buffers. */
+static int dix_cm_cp_recs_unpack(struct m0_dix_cm_cp *dix_cp)
+{
+	M0_PRE(!dix_cp->dc_is_local && dix_cp->dc_keys == NULL);
+
+	if (dix_cp->dc_rec_nr == 0 ||
+	    dix_cp->dc_rec_nr > M0_DIX_CM_CP_REC_MAX)
+		return M0_ERR(-EPROTO);
+	M0_ALLOC_ARR(dix_cp->dc_keys, dix_cp->dc_rec_nr);
+	M0_ALLOC_ARR(dix_cp->dc_vals, dix_cp->dc_rec_nr);
+	if (dix_cp->dc_keys == NULL || dix_cp->dc_vals == NULL)
+		return M0_ERR(-ENOMEM);
+	return dix_cm_cp_unpack(&dix_cp->dc_key, dix_cp->dc_keys,
+				dix_cp->dc_rec_nr) ?:
+	       dix_cm_cp_unpack(&dix_cp->dc_val, dix_cp->dc_vals,
+				dix_cp->dc_rec_nr);
+}
+
 static int dix_cm_cp_incoming_kv(struct m0_rpc_at_buf *ab_key,
 				 struct m0_rpc_at_buf *ab_val,
 				 struct m0_buf        *key,
@@ -141,6 +285,8 @@ static void dixcpx_to_dixcp(const struct m0_dix_cpx *dix_cpx,
 
 	dix_cp->dc_ctg_fid = dix_cpx->dcx_ctg_fid;
 	dix_cp->dc_ctg_op_flags = dix_cpx->dcx_ctg_op_flags;
+	dix_cp->dc_rec_nr = dix_cpx->dcx_rec_nr;
+	dix_cp->dc_rec_cur = 0;
 
 	dix_cp->dc_base.c_prio = dix_cpx->dcx_cp.cpx_prio;
 
@@ -280,6 +426,7 @@ M0_INTERNAL void m0_dix_cm_cp_free(struct m0_cm_cp *cp)
 
 	if (cp->c_ag != NULL)
 		m0_cm_ag_cp_del(cp->c_ag, cp);
+	dix_cm_cp_recs_free(dix_cp);
 	m0_free(dix_cp);
 }
 
@@ -287,7 +434,7 @@ M0_INTERNAL int m0_dix_cm_cp_fini(struct m0_cm_cp *cp)
 {
 	struct m0_dix_cm_cp  *dix_cp = cp2dixcp(cp);
 	struct m0_dix_cm     *dcm = cp2dixcm(cp);
-	struct m0_cm_cp_pump *pump = &dcm->dcm_base.cm_cp_pump;
+	struct m0_cm_cp_pump *pump = &dcm->dcm_base.cm_cp_pump[0];
 
 	M0_ENTRY();
 	if (dix_cp->dc_is_local) {
@@ -369,7 +516,8 @@ M0_INTERNAL int m0_dix_cm_cp_write_pre(struct m0_cm_cp *cp)
 		rc = dix_cm_cp_incoming_kv(&dix_cpx->dcx_ab_key,
 					   &dix_cpx->dcx_ab_val,
 					   &dix_cp->dc_key,
-					   &dix_cp->dc_val);
+					   &dix_cp->dc_val) ?:
+		     dix_cm_cp_recs_unpack(dix_cp);
 	if (rc == 0) {
 		struct m0_cas_ctg *meta = m0_ctg_meta();
 
@@ -395,13 +543,16 @@ M0_INTERNAL int m0_dix_cm_cp_tx_open(struct m0_cm_cp *cp)
 	struct m0_fom          *fom = &cp->c_fom;
 	struct m0_dix_cm_cp    *dix_cp = cp2dixcp(cp);
 	struct m0_be_tx_credit *accum = &fom->fo_tx.tx_betx_cred;
+	uint32_t                i;
 
 	dix_cp->dc_ctg_op_rc = 0;
 	m0_dtx_init(&fom->fo_tx, m0_fom_reqh(fom)->rh_beseg->bs_domain,
 		    &fom->fo_loc->fl_group);
 
-	m0_ctg_insert_credit(dix_cp->dc_ctg, dix_cp->dc_key.b_nob,
-			     dix_cp->dc_val.b_nob, accum);
+	/* All records of the copy packet are inserted in one transaction. */
+	for (i = 0; i < dix_cp->dc_rec_nr; ++i)
+		m0_ctg_insert_credit(dix_cp->dc_ctg, dix_cp->dc_keys[i].b_nob,
+				     dix_cp->dc_vals[i].b_nob, accum);
 
 	m0_dtx_open(&fom->fo_tx);
 
@@ -432,14 +583,15 @@ M0_INTERNAL int m0_dix_cm_cp_write(struct m0_cm_cp *cp)
 			result = dix_cm_fom_tx_wait(fom);
 		}
 	} else {
-		m0_dtx_opened(&fom->fo_tx);
+		if (dix_cp->dc_rec_cur == 0)
+			m0_dtx_opened(&fom->fo_tx);
 		m0_ctg_op_init(ctg_op, &cp->c_fom,
 			       (dix_cp->dc_ctg_op_flags |
 				(repair ? COF_RESERVE : 0)));
 		cp->c_io_op = M0_CM_CP_WRITE;
 		result = m0_ctg_insert(ctg_op, dix_cp->dc_ctg,
-				       &dix_cp->dc_key,
-				       &dix_cp->dc_val,
+				       &dix_cp->dc_keys[dix_cp->dc_rec_cur],
+				       &dix_cp->dc_vals[dix_cp->dc_rec_cur],
 				       M0_CCP_TX_DONE);
 		if (result < 0)
 			rc = result;
@@ -466,6 +618,10 @@ M0_INTERNAL int m0_dix_cm_cp_tx_done(struct m0_cm_cp *cp)
 		/* @todo: Can not finalise here in active state. */
 		fom->fo_tx.tx_state = M0_DTX_DONE;
 		rc = dix_cm_cp_dtx_failure(cp);
+	} else if (dix_cp->dc_ctg_op_rc == 0 &&
+		   ++dix_cp->dc_rec_cur < dix_cp->dc_rec_nr) {
+		/* Insert the next record in the same transaction. */
+		m0_fom_phase_set(fom, M0_CCP_WRITE);
 	} else {
 		m0_dtx_done(&fom->fo_tx);
 		m0_fom_phase_set(fom, M0_CCP_IO_WAIT);
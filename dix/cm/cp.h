@@ -86,10 +86,44 @@ struct m0_dix_cm_cp {
 	/** Key/value transmission phase. */
 	int                        dc_phase_transmit;
 
-	/** Buffer for key. */
+	/**
+	 * Buffer for keys. Keys of all records are packed into it, each
+	 * preceded by its 64-bit length and padded to 8 bytes.
+	 */
 	struct m0_buf              dc_key;
-	/** Buffer for value. */
+	/** Buffer for values, packed the same way as keys. */
 	struct m0_buf              dc_val;
+
+	/** Number of key/value records carried by the copy packet. */
+	uint32_t                   dc_rec_nr;
+
+	/**
+	 * Total size of keys and values of the records added by
+	 * m0_dix_cm_cp_rec_add().
+	 */
+	m0_bcount_t                dc_rec_nob;
+
+	/**
+	 * Keys of the records. Keys of a local copy packet are owned by it
+	 * until they are packed into dc_key, keys of an incoming copy packet
+	 * point into dc_key.
+	 */
+	struct m0_buf             *dc_keys;
+	/** Values of the records, see dc_keys. */
+	struct m0_buf             *dc_vals;
+
+	/** Record inserted by an incoming copy packet. */
+	uint32_t                   dc_rec_cur;
+};
+
+enum {
+	/** Maximum number of records in a DIX copy packet. */
+	M0_DIX_CM_CP_REC_MAX = 128,
+	/**
+	 * Size of keys and values, after which no more records are added to
+	 * a DIX copy packet.
+	 */
+	M0_DIX_CM_CP_NOB_MAX = 256 * 1024,
 };
 
 /** Key/value transmission phases. */
@@ -285,6 +319,35 @@ M0_INTERNAL void m0_dix_cm_cp_free(struct m0_cm_cp *cp);
  */
 M0_INTERNAL int m0_dix_cm_cp_fini(struct m0_cm_cp *cp);
 
+/**
+ * Adds a key/value record to local DIX copy packet, which owns key and value
+ * on success.
+ *
+ * @ret 0 on success or -ENOMEM.
+ */
+M0_INTERNAL int m0_dix_cm_cp_rec_add(struct m0_dix_cm_cp *dix_cp,
+				     struct m0_buf       *key,
+				     struct m0_buf       *val);
+
+/**
+ * Returns true if no more records should be added to DIX copy packet, see
+ * M0_DIX_CM_CP_REC_MAX and M0_DIX_CM_CP_NOB_MAX.
+ */
+M0_INTERNAL bool m0_dix_cm_cp_is_full(const struct m0_dix_cm_cp *dix_cp);
+
+/**
+ * Packs the records added by m0_dix_cm_cp_rec_add() into
+ * m0_dix_cm_cp::dc_key and m0_dix_cm_cp::dc_val to be sent.
+ *
+ * @param dix_cp DIX copy packet.
+ * @param cutoff Size from which packed buffers are page aligned to be sent
+ *               using bulk.
+ *
+ * @ret 0 on success or -ENOMEM.
+ */
+M0_INTERNAL int m0_dix_cm_cp_recs_pack(struct m0_dix_cm_cp *dix_cp,
+				       m0_bcount_t          cutoff);
+
 /**
  * Fills target component catalogue fid of DIX copy packet.
  *
@@ -52,6 +52,9 @@ struct m0_dix_cpx {
 	/** Copy packet fom phase before sending it onwire. */
 	uint32_t             dcx_phase;
 
+	/** Number of key/value records packed into dcx_ab_key, dcx_ab_val. */
+	uint32_t             dcx_rec_nr;
+
 	struct m0_rpc_at_buf dcx_ab_key;
 	struct m0_rpc_at_buf dcx_ab_val;
 } M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
@@ -25,6 +25,7 @@
 #include "lib/trace.h"
 
 #include "lib/memory.h"
+#include "lib/hash_fnc.h"  /* m0_hash_fnc_fnv1 */
 #include "sm/sm.h"
 #include "fop/fom.h"
 #include "dix/cm/cm.h"   /* m0_dix_cm_type */
@@ -210,7 +211,40 @@ static int dix_cm_iter_buf_copy(struct m0_buf *dst,
 
 static uint64_t dix_cm_iter_fom_locality(const struct m0_fom *fom)
 {
-	return fom->fo_type->ft_id;
+	const struct m0_dix_cm_iter *iter = M0_AMB(iter, fom, di_fom);
+
+	/* Spread concurrent iterators over localities. */
+	return fom->fo_type->ft_id + iter->di_idx;
+}
+
+static struct m0_dix_cm *dix_cm_iter_dcm(struct m0_dix_cm_iter *iter)
+{
+	return container_of(iter - iter->di_idx, struct m0_dix_cm, dcm_it[0]);
+}
+
+/**
+ * Returns true if the record with the given key is retrieved by this iterator,
+ * see m0_dix_cm_iter.
+ */
+static bool dix_cm_iter_owns(const struct m0_dix_cm_iter *iter,
+			     const struct m0_buf         *key)
+{
+	return iter->di_nr <= 1 ||
+		m0_hash_fnc_fnv1(key->b_addr, key->b_nob) % iter->di_nr ==
+		iter->di_idx;
+}
+
+/**
+ * Takes catalogue store "delete" lock, see m0_ctg_del_lock(). Repair
+ * iterators don't modify catalogues and share the lock, so that concurrent
+ * iterators exclude record deletion by CAS service but not each other.
+ */
+static int dix_cm_iter_del_lock(struct m0_dix_cm_iter *iter, int next_phase)
+{
+	return M0_FOM_LONG_LOCK_RETURN(m0_long_lock(m0_ctg_del_lock(),
+				dix_cm_iter_dcm(iter)->dcm_type !=
+				&dix_repair_dcmt,
+				&iter->di_del_lock_link, next_phase));
 }
 
 static bool dix_cm_iter_meta_clink_cb(struct m0_clink *cl)
@@ -975,7 +1009,7 @@ static int dix_cm_iter_next_key(struct m0_dix_cm_iter *iter,
 
 	M0_ENTRY();
 
-	dix_cm = container_of(iter, struct m0_dix_cm, dcm_it);
+	dix_cm = dix_cm_iter_dcm(iter);
 	m0_dix_fid_convert_cctg2dix(&iter->di_cctg_fid, &dix_fid);
 	layout.dl_type = DIX_LTYPE_DESCR;
 	layout.u.dl_desc = iter->di_ldesc;
@@ -1034,7 +1068,7 @@ static void dix_cm_iter_meta_unlock(struct m0_dix_cm_iter *iter)
 static int dix_cm_iter_fom_tick(struct m0_fom *fom)
 {
 	struct m0_dix_cm_iter *iter = M0_AMB(iter, fom, di_fom);
-	struct m0_dix_cm      *dix_cm = M0_AMB(dix_cm, iter, dcm_it);
+	struct m0_dix_cm      *dix_cm = dix_cm_iter_dcm(iter);
 	uint8_t                min_key = 0;
 	struct m0_buf          kbuf = M0_BUF_INIT(sizeof min_key, &min_key);
 	struct m0_buf          key = {};
@@ -1065,10 +1099,7 @@ static int dix_cm_iter_fom_tick(struct m0_fom *fom)
 						       DIX_ITER_DEL_LOCK));
 		break;
 	case DIX_ITER_DEL_LOCK:
-		result = M0_FOM_LONG_LOCK_RETURN(m0_long_write_lock(
-						       m0_ctg_del_lock(),
-						       &iter->di_del_lock_link,
-						       DIX_ITER_CTIDX_START));
+		result = dix_cm_iter_del_lock(iter, DIX_ITER_CTIDX_START);
 		break;
 	case DIX_ITER_CTIDX_START:
 	case DIX_ITER_CTIDX_REPOS:
@@ -1086,13 +1117,36 @@ static int dix_cm_iter_fom_tick(struct m0_fom *fom)
 	case DIX_ITER_NEXT_CCTG:
 		rc = m0_ctg_op_rc(&iter->di_ctidx_op);
 		if (rc == 0) {
-			struct m0_dix_layout *layout;
+			struct m0_dix_layout layout;
 
 			m0_ctg_cursor_kv_get(&iter->di_ctidx_op, &key, &val);
+			if (!m0_dix_fid_validate_cctg(key.b_addr)) {
+				/*
+				 * Not a component catalogue: an extension
+				 * record of a stored layout.
+				 */
+				m0_fom_phase_set(fom, DIX_ITER_CTIDX_NEXT);
+				break;
+			}
 			iter->di_cctg_fid = *(struct m0_fid *)key.b_addr;
-			layout = (struct m0_dix_layout *)val.b_addr;
-			M0_ASSERT(layout->dl_type == DIX_LTYPE_DESCR);
-			iter->di_ldesc = layout->u.dl_desc;
+			/* Stored layouts are kept in several ctidx records. */
+			rc = m0_ctg_ctidx_lookup_sync(&iter->di_cctg_fid,
+						      &layout);
+			M0_ASSERT(rc != 0 || layout.dl_type == DIX_LTYPE_DESCR);
+			if (rc == 0 && m0_dix_ldesc_is_ec(&layout.u.dl_desc)) {
+				/*
+				 * Records are copied whole, a spare would get
+				 * a duplicate of some value fragment instead
+				 * of the lost one, see dix/ec.h.
+				 */
+				M0_LOG(M0_ERROR, "Catalogue "FID_F" of an "
+				       "erasure-coded index is skipped.",
+				       FID_P(&iter->di_cctg_fid));
+				m0_fom_phase_set(fom, DIX_ITER_CTIDX_NEXT);
+				break;
+			}
+			if (rc == 0)
+				iter->di_ldesc = layout.u.dl_desc;
 			iter->di_cctg_processed_recs_nr = 0;
 		}
 		m0_long_read_unlock(m0_ctg_lock(m0_ctg_ctidx()),
@@ -1203,10 +1257,10 @@ static int dix_cm_iter_fom_tick(struct m0_fom *fom)
 					     &tmp_key,
 					     &tmp_val);
 			if (!m0_buf_eq(&iter->di_prev_key, &tmp_key)) {
-				rc = dix_cm_iter_next_key(iter,
-							  &tmp_key,
-							  &tmp_val,
-							  &is_coordinator);
+				if (dix_cm_iter_owns(iter, &tmp_key))
+					rc = dix_cm_iter_next_key(
+						iter, &tmp_key, &tmp_val,
+						&is_coordinator);
 				m0_buf_free(&iter->di_prev_key);
 				M0_CNT_INC(iter->di_processed_recs_nr);
 				M0_CNT_INC(iter->di_cctg_processed_recs_nr);
@@ -1338,8 +1392,7 @@ static int dix_cm_iter_fom_tick(struct m0_fom *fom)
 		}
 		break;
 	case DIX_ITER_IDLE_FIN:
-		m0_long_write_unlock(m0_ctg_del_lock(),
-				     &iter->di_del_lock_link);
+		m0_long_unlock(m0_ctg_del_lock(), &iter->di_del_lock_link);
 		iter->di_prev_key = iter->di_key;
 		M0_SET0(&iter->di_key);
 		m0_buf_free(&iter->di_val);
@@ -1347,10 +1400,8 @@ static int dix_cm_iter_fom_tick(struct m0_fom *fom)
 		if (iter->di_stop)
 			m0_fom_phase_set(fom, DIX_ITER_EOF);
 		else
-			result = M0_FOM_LONG_LOCK_RETURN(m0_long_write_lock(
-						       m0_ctg_del_lock(),
-						       &iter->di_del_lock_link,
-						       DIX_ITER_CCTG_CHECK));
+			result = dix_cm_iter_del_lock(iter,
+						      DIX_ITER_CCTG_CHECK);
 		break;
 	case DIX_ITER_CCTG_CHECK:
 		if (!iter->di_meta_modified) {
@@ -1429,11 +1480,16 @@ M0_INTERNAL void m0_dix_cm_iter_type_register(struct m0_dix_cm_type *dcmt)
 M0_INTERNAL int m0_dix_cm_iter_start(struct m0_dix_cm_iter *iter,
 				     struct m0_dix_cm_type *dcmt,
 				     struct m0_reqh        *reqh,
-				     m0_bcount_t            rpc_cutoff)
+				     m0_bcount_t            rpc_cutoff,
+				     uint32_t               idx,
+				     uint32_t               nr)
 {
-	M0_ENTRY("iter = %p", iter);
+	M0_ENTRY("iter = %p idx = %u nr = %u", iter, idx, nr);
 	M0_PRE(M0_IS0(iter));
+	M0_PRE(idx < nr && nr <= M0_DIX_CM_ITER_MAX);
 	iter->di_cutoff = rpc_cutoff;
+	iter->di_idx = idx;
+	iter->di_nr = nr;
 	m0_mutex_init(&iter->di_ch_guard);
 	m0_chan_init(&iter->di_completed, &iter->di_ch_guard);
 	m0_fom_init(&iter->di_fom, &dcmt->dct_iter_fomt, &dix_cm_iter_fom_ops,
@@ -1467,7 +1523,7 @@ M0_INTERNAL int m0_dix_cm_iter_get(struct m0_dix_cm_iter *iter,
 				   struct m0_buf         *val,
 				   uint32_t              *sdev_id)
 {
-	struct m0_dix_cm   *dcm = container_of(iter, struct m0_dix_cm, dcm_it);
+	struct m0_dix_cm   *dcm = dix_cm_iter_dcm(iter);
 	struct m0_poolmach *pm;
 	uint64_t            tgt;
 
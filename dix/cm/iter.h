@@ -42,7 +42,27 @@
 struct m0_dix_cm_type;
 struct m0_reqh;
 
-/** DIX copy machine data iterator. */
+enum {
+	/**
+	 * Default number of concurrent repair iterators of a DIX copy
+	 * machine, see m0_dix_cm::dcm_it_nr.
+	 */
+	M0_DIX_CM_ITER_NR  = 4,
+	/** Maximal number of concurrent iterators of a DIX copy machine. */
+	M0_DIX_CM_ITER_MAX = 16,
+};
+
+/**
+ * DIX copy machine data iterator.
+ *
+ * A copy machine runs m0_dix_cm::dcm_it_nr iterators concurrently, in
+ * different localities. Every iterator walks all local component catalogues
+ * with its own cursors, but retrieves only the records it owns: a record
+ * belongs to the iterator di_idx if the hash of its key modulo di_nr is
+ * di_idx. Keys of every catalogue are thus split among the iterators and
+ * the expensive part of the iteration (target calculation, copying and
+ * sending of records) is done in parallel.
+ */
 struct m0_dix_cm_iter {
 	/**
 	 * Iterator state machine (FOM).
@@ -169,6 +189,32 @@ struct m0_dix_cm_iter {
 
 	/** Minimal threshold in bytes for transmission using bulk. */
 	m0_bcount_t                di_cutoff;
+
+	/** Index of the iterator in m0_dix_cm::dcm_it[]. */
+	uint32_t                   di_idx;
+
+	/** Number of iterators the records are split among. */
+	uint32_t                   di_nr;
+
+	/*
+	 * Fields below are used by the copy machine pump FOM, see
+	 * m0_dix_cm_data_next().
+	 */
+
+	/** Next record is requested, but not taken by m0_dix_cm_iter_get(). */
+	bool                       di_pending;
+
+	/**
+	 * The requested record is retrieved. Protected by
+	 * m0_dix_cm::dcm_it_guard.
+	 */
+	bool                       di_ready;
+
+	/** Iterator returned end of data or failure. */
+	bool                       di_done;
+
+	/** Clink on di_completed setting di_ready. */
+	struct m0_clink            di_ready_clink;
 };
 
 /**
@@ -182,17 +228,21 @@ M0_INTERNAL void m0_dix_cm_iter_type_register(struct m0_dix_cm_type *dcmt);
  * Starts DIX CM iterator by queueing of corresponding FOM for execution.
  * Function always returns success for now.
  *
- * @param iter       DIX CM iterator.
+ * @param iter       DIX CM iterator, m0_dix_cm::dcm_it[idx].
  * @param dcmt       DIX CM iterator type.
  * @param reqh       Corresponding request handler.
  * @param rpc_cutoff Threshold in bytes for transmission using bulk.
+ * @param idx        Index of the iterator.
+ * @param nr         Number of iterators the records are split among.
  *
  * @ret 0 On success.
  */
 M0_INTERNAL int m0_dix_cm_iter_start(struct m0_dix_cm_iter *iter,
 				     struct m0_dix_cm_type *dcmt,
 				     struct m0_reqh        *reqh,
-				     m0_bcount_t            rpc_cutoff);
+				     m0_bcount_t            rpc_cutoff,
+				     uint32_t               idx,
+				     uint32_t               nr);
 
 /**
  * Wakes up DIX CM iterator FOM to move the iterator to the next record.
@@ -70,6 +70,7 @@ static int dixcp_to_dixcpx(struct m0_dix_cm_cp *dix_cp,
 	dix_cpx->dcx_ctg_op_flags = dix_cp->dc_ctg_op_flags;
 	dix_cpx->dcx_cp.cpx_prio = cp->c_prio;
 	dix_cpx->dcx_phase = M0_CCP_SEND;
+	dix_cpx->dcx_rec_nr = dix_cp->dc_rec_nr;
 	m0_cm_ag_id_copy(&dix_cpx->dcx_cp.cpx_ag_id, &cp->c_ag->cag_id);
 	m0_bitmap_onwire_init(&dix_cpx->dcx_cp.cpx_bm, 0);
 
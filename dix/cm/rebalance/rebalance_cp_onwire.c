@@ -38,7 +38,8 @@ static int dix_rebalance_cp_fom_create(struct m0_fop *fop, struct m0_fom **m,
 				       struct m0_reqh *reqh);
 
 const struct m0_fom_type_ops dix_rebalance_cp_fom_type_ops = {
-        .fto_create = dix_rebalance_cp_fom_create
+        .fto_create = dix_rebalance_cp_fom_create,
+        .fto_prio   = M0_FOM_PRIO_LOW
 };
 
 static int dix_rebalance_cp_fom_create(struct m0_fop *fop, struct m0_fom **m,
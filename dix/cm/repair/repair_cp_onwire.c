@@ -37,7 +37,8 @@ static int dix_repair_cp_fom_create(struct m0_fop *fop, struct m0_fom **m,
 				    struct m0_reqh *reqh);
 
 const struct m0_fom_type_ops dix_repair_cp_fom_type_ops = {
-        .fto_create = dix_repair_cp_fom_create
+        .fto_create = dix_repair_cp_fom_create,
+        .fto_prio   = M0_FOM_PRIO_LOW
 };
 
 static int dix_repair_cp_fom_create(struct m0_fop *fop, struct m0_fom **m,
@@ -169,7 +169,7 @@ static struct m0_dix_cm_iter* iter_ut_iter(struct m0_reqh_service *svc)
 					    cm_service);
 	struct m0_dix_cm *dix_cm = container_of(cm, struct m0_dix_cm, dcm_base);
 
-	return &dix_cm->dcm_it;
+	return &dix_cm->dcm_it[0];
 }
 
 struct iter_ut_dev_id {
@@ -740,7 +740,8 @@ static void start_stop(void)
 	iter_ut_init(&repair_svc, &dix_repair_cmt.ct_stype);
 	iter = iter_ut_iter(repair_svc);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_dix_cm_iter_stop(iter);
 	iter_ut_fini(repair_svc);
@@ -776,7 +777,8 @@ static void empty_store(void)
 	iter_ut_init(&repair_svc, &dix_repair_cmt.ct_stype);
 	iter = iter_ut_iter(repair_svc);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	rc = iter_ut_next_sync(iter, &key, &val, &sdev_id);
 	M0_ASSERT(rc == -ENODATA);
@@ -801,7 +803,8 @@ static void empty_cctg(void)
 	iter_ut_ctidx_insert(&cctg_fid1);
 	iter = iter_ut_iter(repair_svc);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	rc = iter_ut_next_sync(iter, &key, &val, &sdev_id);
 	M0_ASSERT(rc == -ENODATA);
@@ -826,7 +829,8 @@ static void cctg_not_found(void)
 	 */
 	iter_ut_ctidx_insert(&cctg_fid);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	rc = iter_ut_next_sync(iter, &key, &val, &sdev_id);
 	M0_ASSERT(rc == -ENOENT);
@@ -880,7 +884,8 @@ static void test_dix_rec(uint32_t cctg_count, uint32_t rec_count)
 			iter_ut_insert(cctg, 100 * i + j, j * j);
 	}
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	for (i = 0; i < cctg_count; i++) {
 		for (j = 0; j < rec_count; j++) {
@@ -910,6 +915,84 @@ static void multi_rec(void)
 	test_dix_rec(10, 20);
 }
 
+enum {
+	MULTI_ITER_CCTG_NR = 4,
+	MULTI_ITER_REC_NR  = 50,
+	MULTI_ITER_NR      = 3,
+};
+
+/**
+ * Concurrent iterators walk the same catalogues, every record is retrieved by
+ * exactly one of them.
+ */
+static void multi_iter(void)
+{
+	struct m0_dix_cm_iter *iters;
+	struct m0_fid          cctg_fid;
+	struct m0_cas_ctg     *cctg;
+	struct m0_buf          key;
+	struct m0_buf          val;
+	uint32_t               sdev_id;
+	uint64_t               k;
+	bool                   seen[MULTI_ITER_CCTG_NR][MULTI_ITER_REC_NR] = {};
+	bool                   eof[MULTI_ITER_NR] = {};
+	int                    recs_nr[MULTI_ITER_NR] = {};
+	int                    i;
+	int                    j;
+	int                    rc;
+
+	iter_ut_init(&repair_svc, &dix_repair_cmt.ct_stype);
+	iters = iter_ut_iter(repair_svc);
+	for (i = 0; i < MULTI_ITER_CCTG_NR; i++) {
+		cctg_fid = M0_FID_TINIT('T', 1, i);
+		iter_ut_ctidx_insert(&cctg_fid);
+		iter_ut_meta_insert(&cctg_fid);
+		cctg = iter_ut_meta_lookup(&cctg_fid);
+		for (j = 0; j < MULTI_ITER_REC_NR; j++)
+			iter_ut_insert(cctg, 100 * i + j, j);
+	}
+	m0_fi_enable("dix_cm_is_repair_coordinator", "always_coordinator");
+	m0_fi_enable("dix_cm_repair_tgts_get", "single_target");
+	for (i = 0; i < MULTI_ITER_NR; i++) {
+		M0_SET0(&iters[i]);
+		rc = m0_dix_cm_iter_start(&iters[i], &dix_repair_dcmt, &reqh,
+					  RPC_CUTOFF, i, MULTI_ITER_NR);
+		M0_UT_ASSERT(rc == 0);
+	}
+	while (!m0_forall(n, MULTI_ITER_NR, eof[n])) {
+		for (i = 0; i < MULTI_ITER_NR; i++) {
+			if (eof[i])
+				continue;
+			rc = iter_ut_next_sync(&iters[i], &key, &val,
+					       &sdev_id);
+			M0_UT_ASSERT(M0_IN(rc, (0, -ENODATA)));
+			if (rc == -ENODATA) {
+				eof[i] = true;
+				continue;
+			}
+			k = buf_value(&key);
+			M0_UT_ASSERT(k / 100 < MULTI_ITER_CCTG_NR &&
+				     k % 100 < MULTI_ITER_REC_NR);
+			M0_UT_ASSERT(buf_value(&val) == k % 100);
+			M0_UT_ASSERT(!seen[k / 100][k % 100]);
+			seen[k / 100][k % 100] = true;
+			recs_nr[i]++;
+			m0_buf_free(&key);
+			m0_buf_free(&val);
+		}
+	}
+	M0_UT_ASSERT(m0_forall(n, MULTI_ITER_CCTG_NR * MULTI_ITER_REC_NR,
+			       seen[n / MULTI_ITER_REC_NR]
+				   [n % MULTI_ITER_REC_NR]));
+	/* Records are split among the iterators. */
+	M0_UT_ASSERT(m0_forall(n, MULTI_ITER_NR, recs_nr[n] > 0));
+	for (i = 0; i < MULTI_ITER_NR; i++)
+		m0_dix_cm_iter_stop(&iters[i]);
+	iter_ut_fini(repair_svc);
+	m0_fi_disable("dix_cm_is_repair_coordinator", "always_coordinator");
+	m0_fi_disable("dix_cm_repair_tgts_get", "single_target");
+}
+
 static void iter_ut_insert_cctg_fid(struct m0_fid *cctg_fid,
 				    uint32_t container,
 				    uint64_t key,
@@ -963,7 +1046,8 @@ static void rep_coordinator(void)
 	cctg = iter_ut_insert_lookup_cctg(1, 0, 104);
 	iter_ut_insert(cctg, 10, 20);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_repair_tgts_get", "single_target");
@@ -993,7 +1077,8 @@ static void rep_coordinator(void)
 	device_state_set(4, M0_PNDS_FAILED);
 	device_state_set(9, M0_PNDS_FAILED);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_repair_tgts_get", "single_target");
@@ -1021,7 +1106,8 @@ static void rep_coordinator(void)
 	cctg = iter_ut_insert_lookup_cctg(1, 0, 109);
 	iter_ut_insert(cctg, 10, 20);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_repair_tgts_get", "single_target");
@@ -1054,7 +1140,8 @@ static void rep_coordinator(void)
 	device_state_set(6, M0_PNDS_FAILED);
 	device_state_set(5, M0_PNDS_FAILED);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_repair_tgts_get", "single_target");
@@ -1144,7 +1231,8 @@ static void iter_ut_rep_validate(struct m0_dix_cm_iter *iter,
 	int                         rc;
 
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_UT_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -1803,7 +1891,8 @@ static void many_keys_rep(void)
 	iter_ut_insert(cctg, 12, 40);
 	device_repairing_set(4);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -1867,7 +1956,8 @@ static void user_concur_rep(void)
 	iter_ut_insert(cctg, 12, 40);
 	device_repairing_set(4);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 
 	/* Delete the first record. */
@@ -1894,7 +1984,8 @@ static void user_concur_rep(void)
 	iter_ut_insert(cctg, 12, 40);
 	device_repairing_set(4);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -1922,7 +2013,8 @@ static void user_concur_rep(void)
 	iter_ut_insert(cctg, 12, 40);
 	device_repairing_set(4);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -1948,7 +2040,8 @@ static void user_concur_rep(void)
 	iter_ut_insert(cctg, 12, 40);
 	device_repairing_set(4);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -2001,7 +2094,8 @@ static void ctg_del_concur_rep(uint8_t index)
 
 	device_repairing_set(9);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_repair_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 
 	m0_fi_enable_once("dix_cm_is_repair_coordinator", "always_coordinator");
@@ -2106,7 +2200,8 @@ static void one_dev_reb(void)
 	iter_ut_insert(cctg, 10, 20);
 	device_rebalancing_set(9);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -2155,7 +2250,8 @@ static void reb_coordinator(void)
 	device_repaired_set(4);
 	device_rebalancing_set(9);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -2193,7 +2289,8 @@ static void reb_coordinator(void)
 	device_repaired_set(4);
 	device_rebalancing_set(9);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -2238,7 +2335,8 @@ static void reb_coordinator(void)
 	device_repaired_set(4);
 	device_rebalancing_set(1);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -2286,7 +2384,8 @@ static void outside_dev_reb(void)
 	iter_ut_insert(cctg, 10, 20);
 	device_rebalancing_set(3);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -2329,7 +2428,8 @@ static void outside_dev_reb(void)
 	device_rebalancing_set(3);
 	device_rebalancing_set(9);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -2374,7 +2474,8 @@ static void outside_dev_reb(void)
 	device_rebalancing_set(9);
 	device_rebalancing_set(0);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -2423,7 +2524,8 @@ static void reb_unused(void)
 	spare_slot_unused_set();
 	device_rebalancing_set(9);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -2460,7 +2562,8 @@ static void reb_unused(void)
 	iter_ut_insert(cctg, 10, 20);
 	device_rebalancing_set(9);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -2504,7 +2607,8 @@ static void reb_unused(void)
 	spare_slot_unused_set();
 	device_rebalancing_set(1);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -2552,7 +2656,8 @@ static void reb_unused(void)
 	spare_slot_unused_set();
 	device_rebalancing_set(0);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -2606,7 +2711,8 @@ static void many_keys_reb(void)
 	iter_ut_insert(cctg, 12, 40);
 	device_rebalancing_set(9);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -2669,7 +2775,8 @@ static void user_concur_reb(void)
 	iter_ut_insert(cctg, 12, 40);
 	device_rebalancing_set(9);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	/* Delete the first record. */
 	iter_ut_delete(cctg, 10, 20);
@@ -2694,7 +2801,8 @@ static void user_concur_reb(void)
 	iter_ut_insert(cctg, 12, 40);
 	device_rebalancing_set(9);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -2720,7 +2828,8 @@ static void user_concur_reb(void)
 	iter_ut_insert(cctg, 12, 40);
 	device_rebalancing_set(9);
 	M0_SET0(iter);
-	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF);
+	rc = m0_dix_cm_iter_start(iter, &dix_rebalance_dcmt, &reqh, RPC_CUTOFF,
+				  0, 1);
 	M0_ASSERT(rc == 0);
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_parity_group");
 	m0_fi_enable_once("dix_cm_iter_next_key", "print_spare_usage");
@@ -2752,6 +2861,7 @@ struct m0_ut_suite dix_cm_iter_ut = {
 		{ "cctg-not-found",      cctg_not_found,      "Egor"   },
 		{ "one-rec",             one_rec,             "Egor"   },
 		{ "multi-rec",           multi_rec,           "Egor"   },
+		{ "multi-iter",          multi_iter,          "Egor"   },
 		{ "rep-coordinator",     rep_coordinator,     "Sergey" },
 		{ "one-dev-fail",        one_dev_fail,        "Sergey" },
 		{ "two-devs-fail",       two_devs_fail,       "Sergey" },
@@ -0,0 +1,205 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "dix/ec.h"
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_DIX
+#include "lib/trace.h"
+#include "lib/errno.h"          /* EIO */
+#include "lib/memory.h"         /* M0_ALLOC_ARR */
+#include "lib/buf.h"            /* m0_buf */
+#include "lib/misc.h"           /* memcpy */
+#include "motr/magic.h"         /* M0_DIX_EC_MAGIC */
+#include "sns/parity_math.h"    /* m0_parity_math */
+
+/**
+ * @addtogroup dix
+ *
+ * @{
+ */
+
+/** Size of the value part of fragments, it is padded with zeroes. */
+static m0_bcount_t dix_ec_frag_size(m0_bcount_t len, uint32_t data_nr)
+{
+	return max64u((len + data_nr - 1) / data_nr, 1);
+}
+
+M0_INTERNAL int m0_dix_ec_encode(const struct m0_buf *val,
+				 uint32_t             data_nr,
+				 uint32_t             parity_nr,
+				 struct m0_buf       *area,
+				 struct m0_buf       *frags)
+{
+	struct m0_parity_math  math;
+	struct m0_dix_ec_hdr  *hdr;
+	struct m0_buf         *blocks;
+	m0_bcount_t            size = dix_ec_frag_size(val->b_nob, data_nr);
+	m0_bcount_t            off;
+	uint32_t               nr = data_nr + parity_nr;
+	uint32_t               i;
+	int                    rc;
+
+	M0_PRE(data_nr > 0 && parity_nr > 0);
+
+	M0_ALLOC_ARR(blocks, nr);
+	if (blocks == NULL)
+		return M0_ERR(-ENOMEM);
+	rc = m0_buf_alloc(area, nr * (sizeof *hdr + size));
+	if (rc != 0) {
+		m0_free(blocks);
+		return M0_ERR(rc);
+	}
+	rc = m0_parity_math_init(&math, data_nr, parity_nr);
+	if (rc != 0) {
+		m0_buf_free(area);
+		m0_free(blocks);
+		return M0_ERR(rc);
+	}
+	for (i = 0; i < nr; i++) {
+		hdr = area->b_addr + i * (sizeof *hdr + size);
+		*hdr = (struct m0_dix_ec_hdr) {
+			.deh_magic   = M0_DIX_EC_MAGIC,
+			.deh_len     = val->b_nob,
+			.deh_frag    = i,
+			.deh_data_nr = data_nr,
+		};
+		frags[i]  = M0_BUF_INIT(sizeof *hdr + size, hdr);
+		blocks[i] = M0_BUF_INIT(size, hdr + 1);
+		off = i * size;
+		if (i < data_nr && off < val->b_nob)
+			memcpy(blocks[i].b_addr, val->b_addr + off,
+			       min64u(size, val->b_nob - off));
+	}
+	m0_parity_math_calculate(&math, blocks, blocks + data_nr);
+	m0_parity_math_fini(&math);
+	m0_free(blocks);
+	return M0_RC(0);
+}
+
+static bool dix_ec_frag_is_valid(const struct m0_buf        *frag,
+				 const struct m0_dix_ec_hdr *first,
+				 uint32_t                    nr,
+				 uint32_t                    data_nr)
+{
+	const struct m0_dix_ec_hdr *hdr = frag->b_addr;
+
+	return frag->b_nob > sizeof *hdr &&
+	       hdr->deh_magic == M0_DIX_EC_MAGIC &&
+	       hdr->deh_data_nr == data_nr &&
+	       hdr->deh_frag < nr &&
+	       frag->b_nob - sizeof *hdr ==
+	       dix_ec_frag_size(hdr->deh_len, data_nr) &&
+	       ergo(first != NULL, hdr->deh_len == first->deh_len);
+}
+
+M0_INTERNAL int m0_dix_ec_decode(const struct m0_buf *frags,
+				 uint32_t             nr,
+				 uint32_t             data_nr,
+				 struct m0_buf       *val)
+{
+	struct m0_parity_math       math;
+	const struct m0_dix_ec_hdr *first = NULL;
+	const struct m0_dix_ec_hdr *hdr;
+	struct m0_buf               area = M0_BUF_INIT0;
+	struct m0_buf               fails = M0_BUF_INIT0;
+	struct m0_buf              *blocks;
+	uint8_t                    *failed;
+	m0_bcount_t                 size = 0;
+	m0_bcount_t                 off;
+	uint32_t                    present = 0;
+	uint32_t                    i;
+	int                         rc;
+
+	M0_PRE(data_nr > 0 && data_nr < nr);
+
+	M0_ALLOC_ARR(blocks, nr);
+	if (blocks == NULL)
+		return M0_ERR(-ENOMEM);
+	rc = m0_buf_alloc(&fails, nr);
+	if (rc != 0)
+		goto out;
+	failed = fails.b_addr;
+	memset(failed, 1, nr);
+	for (i = 0; i < nr; i++) {
+		if (frags[i].b_nob == 0 ||
+		    !dix_ec_frag_is_valid(&frags[i], first, nr, data_nr))
+			continue;
+		hdr = frags[i].b_addr;
+		if (first == NULL) {
+			first = hdr;
+			size  = frags[i].b_nob - sizeof *hdr;
+			rc    = m0_buf_alloc(&area, nr * size);
+			if (rc != 0)
+				goto out;
+		}
+		if (failed[hdr->deh_frag] == 0)
+			continue;
+		failed[hdr->deh_frag] = 0;
+		memcpy(area.b_addr + hdr->deh_frag * size, hdr + 1, size);
+		present++;
+	}
+	if (present < data_nr) {
+		rc = M0_ERR_INFO(-EIO, "present=%u data_nr=%u",
+				 present, data_nr);
+		goto out;
+	}
+	for (i = 0; i < nr; i++)
+		blocks[i] = M0_BUF_INIT(size, area.b_addr + i * size);
+	if (memchr(failed, 1, data_nr) != NULL) {
+		rc = m0_parity_math_init(&math, data_nr, nr - data_nr);
+		if (rc != 0)
+			goto out;
+		rc = m0_parity_math_recover(&math, blocks, blocks + data_nr,
+					    &fails, M0_LA_INVERSE);
+		m0_parity_math_fini(&math);
+		if (rc != 0)
+			goto out;
+	}
+	*val = M0_BUF_INIT0;
+	rc = first->deh_len == 0 ? 0 : m0_buf_alloc(val, first->deh_len);
+	if (rc != 0)
+		goto out;
+	for (i = 0, off = 0; off < val->b_nob; i++, off += size)
+		memcpy(val->b_addr + off, blocks[i].b_addr,
+		       min64u(size, val->b_nob - off));
+out:
+	m0_buf_free(&area);
+	m0_buf_free(&fails);
+	m0_free(blocks);
+	return M0_RC(rc);
+}
+
+#undef M0_TRACE_SUBSYSTEM
+/** @} end of dix group */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -0,0 +1,105 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __MOTR_DIX_EC_H__
+#define __MOTR_DIX_EC_H__
+
+#include "lib/types.h"          /* uint32_t */
+
+/**
+ * @addtogroup dix
+ *
+ * Erasure-coded values of an index with m0_dix_ldesc::ld_ec_data != 0.
+ *
+ * Keys are replicated to the first N + K units of the record parity group as
+ * usual. The value is split into d = ld_ec_data data fragments, N + K - d
+ * parity fragments are calculated with m0_parity_math, and unit i stores
+ * fragment i as its value. A record survives the loss of N + K - d units and
+ * takes (N + K) / d of the value size instead of N + K.
+ *
+ * Every fragment starts with m0_dix_ec_hdr, so it can be decoded without
+ * knowing which unit it was read from. This way fragments written to spare
+ * units by PUT are usable too.
+ *
+ * NEXT returns values as stored, so it is refused for such indices. DIX repair
+ * and re-balance copy records as they are, which would duplicate a surviving
+ * fragment instead of restoring the lost one, so they skip such indices.
+ *
+ * @{
+ */
+
+struct m0_buf;
+
+/** Header of a value fragment. */
+struct m0_dix_ec_hdr {
+	/** M0_DIX_EC_MAGIC. */
+	uint64_t deh_magic;
+	/** Size of the value. */
+	uint64_t deh_len;
+	/** Fragment index, data fragments go first. */
+	uint32_t deh_frag;
+	/** Number of data fragments. */
+	uint32_t deh_data_nr;
+};
+
+/**
+ * Splits 'val' into 'data_nr' data and 'parity_nr' parity fragments.
+ *
+ * Fragments are placed to 'area', which is allocated here and shall be freed
+ * by the caller, frags[i] points to fragment i in it.
+ */
+M0_INTERNAL int m0_dix_ec_encode(const struct m0_buf *val,
+				 uint32_t             data_nr,
+				 uint32_t             parity_nr,
+				 struct m0_buf       *area,
+				 struct m0_buf       *frags);
+
+/**
+ * Restores the value from fragments.
+ *
+ * 'frags' has 'nr' elements, which are fragments in any order or empty
+ * buffers. Duplicate fragments are allowed. 'val' is allocated here.
+ *
+ * Returns -EIO if there are less than 'data_nr' distinct valid fragments.
+ */
+M0_INTERNAL int m0_dix_ec_decode(const struct m0_buf *frags,
+				 uint32_t             nr,
+				 uint32_t             data_nr,
+				 struct m0_buf       *val);
+
+/** @} end of dix group */
+#endif /* __MOTR_DIX_EC_H__ */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -108,6 +108,16 @@ M0_INTERNAL void m0_dix_layout_fini(struct m0_dix_linst *li)
 		m0_layout_put(m0_pdl_to_layout(li->li_pl));
 }
 
+static uint64_t dix_range_group(const struct m0_dix_ldesc *ldesc,
+				void                      *val,
+				m0_bcount_t                len)
+{
+	struct m0_buf key = M0_BUF_INIT(len, val);
+
+	return ldesc->ld_ranges.dr_part[
+		m0_dix_ldesc_range_find(ldesc, &key)].dr_group;
+}
+
 static void dix_hash(struct m0_dix_ldesc *ldesc,
 		     struct m0_buf       *buf,
 		     uint64_t            *hash)
@@ -134,6 +144,9 @@ static void dix_hash(struct m0_dix_ldesc *ldesc,
 		case HASH_FNC_CITY:
 			*hash = m0_hash_fnc_city(val, len);
 			break;
+		case HASH_FNC_RANGE:
+			*hash = dix_range_group(ldesc, val, len);
+			break;
 		default:
 			M0_IMPOSSIBLE("Incorrect hash function type");
 	}
@@ -144,31 +157,55 @@ static bool unit_is_valid(struct m0_pdclust_attr *attr, uint64_t unit)
 	return unit < attr->pa_N + attr->pa_K + attr->pa_S;
 }
 
+static void dix_group_target(struct m0_dix_linst *inst,
+			     uint64_t             group,
+			     uint64_t             unit,
+			     uint64_t            *out_id)
+{
+	struct m0_pdclust_src_addr src;
+	struct m0_pdclust_tgt_addr tgt;
+
+	src.sa_group = group;
+	src.sa_unit = unit;
+	if (M0_FI_ENABLED("pdcluster-map"))
+		m0_pdclust_instance_map(inst->li_pi, &src, &tgt);
+	else
+		m0_fd_fwd_map(inst->li_pi, &src, &tgt);
+	*out_id = tgt.ta_obj;
+}
+
 M0_INTERNAL void m0_dix_target(struct m0_dix_linst *inst,
 			       uint64_t             unit,
 			       struct m0_buf       *key,
 			       uint64_t            *out_id)
 {
-	struct m0_pdclust_src_addr src;
-	struct m0_pdclust_tgt_addr tgt;
+	uint64_t group = 0;
 
 	M0_PRE(inst != NULL);
 	M0_PRE(inst->li_pl != NULL);
 	M0_PRE(key != NULL);
 	M0_PRE(unit_is_valid(&inst->li_pl->pl_attr, unit));
 	if (key->b_addr != NULL)
-		dix_hash(inst->li_ldescr, key, &src.sa_group);
-	else
-		src.sa_group = 0;
-	src.sa_unit = unit;
-	if (M0_FI_ENABLED("pdcluster-map"))
-		m0_pdclust_instance_map(inst->li_pi, &src, &tgt);
-	else
-		m0_fd_fwd_map(inst->li_pi, &src, &tgt);
-	*out_id = tgt.ta_obj;
+		dix_hash(inst->li_ldescr, key, &group);
+	else if (m0_dix_ldesc_is_range(inst->li_ldescr))
+		group = inst->li_ldescr->ld_ranges.dr_part[0].dr_group;
+	dix_group_target(inst, group, unit, out_id);
 	M0_LOG(M0_DEBUG,
 	       "Key %p, group/unit [%" PRIx64 ",%" PRIx64 "] -> target %"PRIx64,
-			key, src.sa_group, unit, *out_id);
+			key, group, unit, *out_id);
+}
+
+M0_INTERNAL void m0_dix_range_target(struct m0_dix_linst *inst,
+				     uint32_t             part,
+				     uint64_t             unit,
+				     uint64_t            *out_id)
+{
+	M0_PRE(inst != NULL);
+	M0_PRE(m0_dix_ldesc_is_range(inst->li_ldescr));
+	M0_PRE(part < inst->li_ldescr->ld_ranges.dr_nr);
+	M0_PRE(unit_is_valid(&inst->li_pl->pl_attr, unit));
+	dix_group_target(inst, inst->li_ldescr->ld_ranges.dr_part[part].dr_group,
+			 unit, out_id);
 }
 
 M0_INTERNAL int m0_dix_ldesc_init(struct m0_dix_ldesc       *ld,
@@ -189,17 +226,180 @@ M0_INTERNAL int m0_dix_ldesc_init(struct m0_dix_ldesc       *ld,
 	return rc;
 }
 
+static void dix_ranges_fini(struct m0_dix_ranges *ranges)
+{
+	uint32_t i;
+
+	for (i = 0; i < ranges->dr_nr; i++)
+		m0_buf_free(&ranges->dr_part[i].dr_start);
+	m0_free0(&ranges->dr_part);
+	ranges->dr_nr = 0;
+}
+
+static int dix_ranges_copy(struct m0_dix_ranges       *dst,
+			   const struct m0_dix_ranges *src)
+{
+	uint32_t i;
+	int      rc = 0;
+
+	M0_SET0(dst);
+	if (src->dr_nr == 0)
+		return 0;
+	M0_ALLOC_ARR(dst->dr_part, src->dr_nr);
+	if (dst->dr_part == NULL)
+		return M0_ERR(-ENOMEM);
+	dst->dr_nr = src->dr_nr;
+	for (i = 0; i < src->dr_nr && rc == 0; i++) {
+		dst->dr_part[i].dr_group = src->dr_part[i].dr_group;
+		rc = m0_buf_copy(&dst->dr_part[i].dr_start,
+				 &src->dr_part[i].dr_start);
+	}
+	if (rc != 0)
+		dix_ranges_fini(dst);
+	return M0_RC(rc);
+}
+
+static bool dix_ranges_eq(const struct m0_dix_ranges *r1,
+			  const struct m0_dix_ranges *r2)
+{
+	return r1->dr_nr == r2->dr_nr &&
+		m0_forall(i, r1->dr_nr,
+			  r1->dr_part[i].dr_group == r2->dr_part[i].dr_group &&
+			  m0_buf_eq(&r1->dr_part[i].dr_start,
+				    &r2->dr_part[i].dr_start));
+}
+
+M0_INTERNAL int m0_dix_ldesc_range_init(struct m0_dix_ldesc *ld,
+					const struct m0_buf *bounds,
+					uint32_t             bounds_nr,
+					struct m0_fid       *pver)
+{
+	struct m0_dix_ranges *ranges = &ld->ld_ranges;
+	uint32_t              i;
+	int                   rc = 0;
+
+	M0_PRE(ld != NULL);
+	M0_PRE(m0_forall(i, bounds_nr, bounds[i].b_nob != 0));
+	M0_PRE(m0_forall(i, bounds_nr,
+			 i == 0 || m0_buf_cmp(&bounds[i - 1], &bounds[i]) < 0));
+	M0_SET0(ld);
+	M0_ALLOC_ARR(ranges->dr_part, bounds_nr + 1);
+	if (ranges->dr_part == NULL)
+		return M0_ERR(-ENOMEM);
+	ranges->dr_nr = bounds_nr + 1;
+	for (i = 0; i < ranges->dr_nr; i++)
+		ranges->dr_part[i].dr_group = i;
+	for (i = 0; i < bounds_nr && rc == 0; i++)
+		rc = m0_buf_copy(&ranges->dr_part[i + 1].dr_start, &bounds[i]);
+	if (rc != 0) {
+		dix_ranges_fini(ranges);
+		return M0_ERR(rc);
+	}
+	ld->ld_hash_fnc = HASH_FNC_RANGE;
+	ld->ld_pver     = *pver;
+	return M0_RC(0);
+}
+
+M0_INTERNAL bool m0_dix_ldesc_is_range(const struct m0_dix_ldesc *ld)
+{
+	return ld->ld_hash_fnc == HASH_FNC_RANGE;
+}
+
+M0_INTERNAL void m0_dix_ldesc_ec_set(struct m0_dix_ldesc *ld,
+				     uint32_t             data_nr)
+{
+	ld->ld_ec_data = data_nr;
+}
+
+M0_INTERNAL bool m0_dix_ldesc_is_ec(const struct m0_dix_ldesc *ld)
+{
+	return ld->ld_ec_data != 0;
+}
+
+M0_INTERNAL uint32_t m0_dix_ldesc_range_find(const struct m0_dix_ldesc *ld,
+					     const struct m0_buf       *key)
+{
+	const struct m0_dix_ranges *ranges = &ld->ld_ranges;
+	uint32_t                    lo = 0;
+	uint32_t                    hi;
+	uint32_t                    mid;
+
+	M0_PRE(m0_dix_ldesc_is_range(ld));
+	M0_PRE(ranges->dr_nr > 0);
+	/* The first partition starts with the empty key, which is min. */
+	hi = ranges->dr_nr;
+	while (hi - lo > 1) {
+		mid = lo + (hi - lo) / 2;
+		if (m0_buf_cmp(&ranges->dr_part[mid].dr_start, key) <= 0)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+M0_INTERNAL int m0_dix_ldesc_range_split(struct m0_dix_ldesc *ld,
+					 const struct m0_buf *key,
+					 uint64_t             group)
+{
+	struct m0_dix_ranges *ranges = &ld->ld_ranges;
+	struct m0_dix_range  *part;
+	struct m0_buf         start;
+	uint32_t              pos;
+	int                   rc;
+
+	M0_PRE(m0_dix_ldesc_is_range(ld));
+	M0_PRE(key->b_nob != 0);
+	pos = m0_dix_ldesc_range_find(ld, key);
+	if (m0_buf_eq(&ranges->dr_part[pos].dr_start, key))
+		return M0_ERR(-EEXIST);
+	rc = m0_buf_copy(&start, key);
+	if (rc != 0)
+		return M0_ERR(rc);
+	M0_ALLOC_ARR(part, ranges->dr_nr + 1);
+	if (part == NULL) {
+		m0_buf_free(&start);
+		return M0_ERR(-ENOMEM);
+	}
+	pos++;
+	memcpy(part, ranges->dr_part, pos * sizeof part[0]);
+	memcpy(part + pos + 1, ranges->dr_part + pos,
+	       (ranges->dr_nr - pos) * sizeof part[0]);
+	part[pos].dr_start = start;
+	part[pos].dr_group = group;
+	m0_free(ranges->dr_part);
+	ranges->dr_part = part;
+	ranges->dr_nr++;
+	return M0_RC(0);
+}
+
+M0_INTERNAL void m0_dix_ldesc_range_merge(struct m0_dix_ldesc *ld,
+					  uint32_t             part)
+{
+	struct m0_dix_ranges *ranges = &ld->ld_ranges;
+
+	M0_PRE(m0_dix_ldesc_is_range(ld));
+	M0_PRE(part > 0 && part < ranges->dr_nr);
+	m0_buf_free(&ranges->dr_part[part].dr_start);
+	memmove(ranges->dr_part + part, ranges->dr_part + part + 1,
+		(ranges->dr_nr - part - 1) * sizeof ranges->dr_part[0]);
+	ranges->dr_nr--;
+}
+
 M0_INTERNAL int m0_dix_ldesc_copy(struct m0_dix_ldesc       *dst,
 				  const struct m0_dix_ldesc *src)
 {
 	dst->ld_hash_fnc = src->ld_hash_fnc;
 	dst->ld_pver     = src->ld_pver;
-	return m0_dix_imask_copy(&dst->ld_imask, &src->ld_imask);
+	dst->ld_ec_data  = src->ld_ec_data;
+	return m0_dix_imask_copy(&dst->ld_imask, &src->ld_imask) ?:
+		dix_ranges_copy(&dst->ld_ranges, &src->ld_ranges);
 }
 
 M0_INTERNAL void m0_dix_ldesc_fini(struct m0_dix_ldesc *ld)
 {
 	m0_dix_imask_fini(&ld->ld_imask);
+	dix_ranges_fini(&ld->ld_ranges);
 }
 
 M0_INTERNAL
@@ -231,10 +431,15 @@ int m0_dix_layout_iter_init(struct m0_dix_layout_iter *iter,
 				layout_id, pver, ldesc);
 	if (rc != 0)
 		return M0_ERR(rc);
-	rc = m0_dix_imask_apply(key->b_addr, key->b_nob,
-				&ldesc->ld_imask,
-				&iter->dit_key.b_addr,
-				&iter->dit_key.b_nob);
+	if (m0_dix_ldesc_is_range(ldesc)) {
+		/* Partitions are looked up by the whole key. */
+		rc = m0_buf_copy(&iter->dit_key, key);
+		iter->dit_key.b_nob *= 8;
+	} else
+		rc = m0_dix_imask_apply(key->b_addr, key->b_nob,
+					&ldesc->ld_imask,
+					&iter->dit_key.b_addr,
+					&iter->dit_key.b_nob);
 	if (rc != 0) {
 		m0_dix_layout_fini(&iter->dit_linst);
 		return M0_ERR(rc);
@@ -343,7 +548,9 @@ M0_INTERNAL bool m0_dix_layout_eq(const struct m0_dix_layout *layout1,
 
 	return ldesc1->ld_hash_fnc == ldesc2->ld_hash_fnc &&
 		m0_fid_eq(&ldesc1->ld_pver, &ldesc2->ld_pver) &&
-		m0_dix_imask_eq(&ldesc1->ld_imask, &ldesc2->ld_imask);
+		m0_dix_imask_eq(&ldesc1->ld_imask, &ldesc2->ld_imask) &&
+		dix_ranges_eq(&ldesc1->ld_ranges, &ldesc2->ld_ranges) &&
+		ldesc1->ld_ec_data == ldesc2->ld_ec_data;
 }
 
 #undef M0_TRACE_SUBSYSTEM
@@ -70,13 +70,45 @@ enum dix_layout_type {
 enum m0_dix_hash_fnc_type {
 	HASH_FNC_NONE,
 	HASH_FNC_FNV1,
-	HASH_FNC_CITY
+	HASH_FNC_CITY,
+	/**
+	 * Records are not hashed, the key space is split into ordered
+	 * partitions (m0_dix_ldesc::ld_ranges) and all records of a partition
+	 * belong to the same parity group. NEXT is sent to the targets of the
+	 * partitions it walks through only, instead of all targets of the pool
+	 * version. Identity mask is not used.
+	 */
+	HASH_FNC_RANGE
 };
 
+/** Partition of a range-partitioned layout, see ::HASH_FNC_RANGE. */
+struct m0_dix_range {
+	/**
+	 * The smallest key of the partition. The partition ends before the
+	 * start key of the next one. Empty for the first partition.
+	 */
+	struct m0_buf dr_start;
+	/** Parity group of the partition records. */
+	uint64_t      dr_group;
+} M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
+
+/** Partitions of a range-partitioned layout ordered by their start keys. */
+struct m0_dix_ranges {
+	uint32_t             dr_nr;
+	struct m0_dix_range *dr_part;
+} M0_XCA_SEQUENCE M0_XCA_DOMAIN(rpc);
+
 struct m0_dix_ldesc {
-	uint32_t            ld_hash_fnc;
-	struct m0_fid       ld_pver;
-	struct m0_dix_imask ld_imask;
+	uint32_t             ld_hash_fnc;
+	struct m0_fid        ld_pver;
+	struct m0_dix_imask  ld_imask;
+	/** Partitions, only for ::HASH_FNC_RANGE. */
+	struct m0_dix_ranges ld_ranges;
+	/**
+	 * Number of data fragments of erasure-coded values, 0 if values are
+	 * replicated. See dix/ec.h and m0_dix_ldesc_ec_set().
+	 */
+	uint32_t             ld_ec_data;
 } M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
 
 struct m0_dix_capture_ldesc {
@@ -193,6 +225,69 @@ M0_INTERNAL int m0_dix_ldesc_init(struct m0_dix_ldesc       *ld,
 				  enum m0_dix_hash_fnc_type  htype,
 				  struct m0_fid             *pver);
 
+/**
+ * Initialises range-partitioned layout descriptor, see ::HASH_FNC_RANGE.
+ *
+ * 'bounds' are start keys of all partitions but the first one, they should be
+ * sorted in ascending order. Partition i is placed to parity group i.
+ */
+M0_INTERNAL int m0_dix_ldesc_range_init(struct m0_dix_ldesc *ld,
+					const struct m0_buf *bounds,
+					uint32_t             bounds_nr,
+					struct m0_fid       *pver);
+
+/** Checks whether layout descriptor is range-partitioned. */
+M0_INTERNAL bool m0_dix_ldesc_is_range(const struct m0_dix_ldesc *ld);
+
+/** Returns the index of the partition holding 'key'. */
+M0_INTERNAL uint32_t m0_dix_ldesc_range_find(const struct m0_dix_ldesc *ld,
+					     const struct m0_buf       *key);
+
+/**
+ * Splits the partition holding 'key' into two, the second one starts at 'key'
+ * and is placed to parity group 'group'.
+ *
+ * If 'group' is the group of the split partition, no record changes its
+ * targets. Otherwise, records of the new partition should be moved by the
+ * caller: they are read with the old descriptor and written with the new one.
+ *
+ * Returns -EEXIST if a partition already starts at 'key'.
+ */
+M0_INTERNAL int m0_dix_ldesc_range_split(struct m0_dix_ldesc *ld,
+					 const struct m0_buf *key,
+					 uint64_t             group);
+
+/**
+ * Merges partition 'part' into the preceding one. Records of the merged
+ * partition are placed to the group of the preceding partition, so they
+ * should be moved by the caller if the groups differ.
+ */
+M0_INTERNAL void m0_dix_ldesc_range_merge(struct m0_dix_ldesc *ld,
+					  uint32_t             part);
+
+/**
+ * Makes values of the index erasure-coded with 'data_nr' data fragments, see
+ * dix/ec.h. 'data_nr' should be less than N + K of the index pool version,
+ * records survive N + K - data_nr failures. 0 makes values replicated.
+ *
+ * NEXT of such an index fails with -EOPNOTSUPP, values should be read with
+ * GET. DIX repair and re-balance skip catalogues of such an index.
+ */
+M0_INTERNAL void m0_dix_ldesc_ec_set(struct m0_dix_ldesc *ld,
+				     uint32_t             data_nr);
+
+/** Checks whether values of the index are erasure-coded. */
+M0_INTERNAL bool m0_dix_ldesc_is_ec(const struct m0_dix_ldesc *ld);
+
+/**
+ * Calculates target for specified 'unit' in parity group of partition 'part'
+ * of range-partitioned layout instance.
+ */
+M0_INTERNAL void m0_dix_range_target(struct m0_dix_linst *inst,
+				     uint32_t             part,
+				     uint64_t             unit,
+				     uint64_t            *out_id);
+
 /**
  * Copies layout descriptor.
  *
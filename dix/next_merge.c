@@ -30,170 +30,399 @@
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_DIX
 #include "lib/trace.h"
 
-#include "lib/arith.h"        /* min64 */
+#include "lib/arith.h"        /* min32u */
 #include "lib/memory.h"       /* M0_ALLOC_ARR */
 #include "pool/pool.h"        /* m0_pool_version */
 #include "lib/errno.h"
 #include "dix/client.h"
 #include "dix/req.h"
+#include "dix/layout.h"       /* m0_dix_range_target */
 #include "lib/finject.h"
 
-#define NOENT (-ENOENT)
-#define PROCESSING_IS_DONE (-ENOKEY)
-
-static void sc_result_add(struct m0_dix_next_sort_ctx  *key_ctx,
-			  uint32_t                      cidx,
-			  struct m0_dix_next_resultset *rs,
-			  uint32_t                      key_id,
-			  struct m0_cas_next_reply     *rep);
+enum {
+	/** Minimal number of records requested from a component catalogue. */
+	DIX_NEXT_BATCH_MIN = 16,
+	/**
+	 * A stream is requested again together with a drained stream of the
+	 * same starting key if it has no more than ds_asked >>
+	 * DIX_NEXT_LOW_SHIFT records left.
+	 */
+	DIX_NEXT_LOW_SHIFT = 2,
+};
 
 static int sc_rep_cmp(const struct m0_cas_next_reply *a,
 		      const struct m0_cas_next_reply *b)
 {
-	if (a == NULL && b == NULL)
-		return 0;
-	if (a == NULL)
-		return -1;
-	if (b == NULL)
-		return 1;
-	return memcmp(a->cnp_key.b_addr, b->cnp_key.b_addr,
-		      min64(a->cnp_key.b_nob, b->cnp_key.b_nob)) ?:
-		M0_3WAY(a->cnp_key.b_nob, b->cnp_key.b_nob);
+	return m0_buf_cmp(&a->cnp_key, &b->cnp_key);
 }
 
-static bool sc_rep_le(const struct m0_cas_next_reply *a,
-		      const struct m0_cas_next_reply *b)
+static bool sc_stream_is_empty(const struct m0_dix_next_stream *st)
 {
-	return sc_rep_cmp(a, b) < 0;
+	return st->ds_pos == st->ds_nr;
 }
 
-static bool sc_rep_eq(const struct m0_cas_next_reply *a,
-		      const struct m0_cas_next_reply *b)
+static void sc_stream_ask(struct m0_dix_next_stream *st, uint32_t nr)
 {
-	return sc_rep_cmp(a, b) == 0;
+	st->ds_asked  = nr;
+	st->ds_eof    = false;
+	st->ds_refill = true;
 }
 
-static void sc_next(struct m0_dix_next_sort_ctx *ctx)
+static void sc_stream_fini(struct m0_dix_next_stream *st)
 {
-	ctx->sc_pos++;
-	if (ctx->sc_pos >= ctx->sc_reps_nr)
-		ctx->sc_done = true;
-}
+	uint32_t i;
 
-static int sc_rep_get(struct m0_dix_next_sort_ctx  *ctx,
-		      struct m0_cas_next_reply    **rep)
-{
-	*rep = NULL;
-	if (ctx->sc_reps_nr != 0 &&
-	    (ctx->sc_done || ctx->sc_pos >= ctx->sc_reps_nr))
-		return PROCESSING_IS_DONE;
-	if (ctx->sc_stop || ctx->sc_reps_nr == 0)
-		return NOENT;
-	*rep = &ctx->sc_reps[ctx->sc_pos];
-	if ((*rep)->cnp_rc == NOENT) {
-		ctx->sc_stop = true;
-		return NOENT;
+	for (i = st->ds_pos; i < st->ds_nr; i++) {
+		m0_buf_free(&st->ds_reps[i].cnp_key);
+		m0_buf_free(&st->ds_reps[i].cnp_val);
 	}
-	return 0;
+	m0_free0(&st->ds_reps);
+	m0_buf_free(&st->ds_last);
+	st->ds_nr     = 0;
+	st->ds_pos    = 0;
+	st->ds_eof    = true;
+	st->ds_refill = false;
 }
 
 /**
- * Sets sorting context current position to the first record retrieved for
- * 'key_idx' starting key.
+ * Appends 'nr' records of the sorting context CAS reply starting from 'pos' to
+ * the stream, dropping already consumed stream records.
+ *
+ * Keys and values are taken over from the CAS request if it is given,
+ * otherwise (UT) they are copied.
  */
-static int sc_key_pos_set(struct m0_dix_next_sort_ctx *ctx,
-			  uint32_t                     key_idx,
-			  const uint32_t              *recs_nr)
+static int sc_stream_load(struct m0_dix_next_sort_ctx *ctx,
+			  struct m0_cas_req           *creq,
+			  struct m0_dix_next_stream   *st,
+			  uint32_t                     pos,
+			  uint32_t                     nr)
 {
-	uint32_t                  pos = 0;
-	uint32_t                  start_pos = 0;
-	uint32_t                  i;
+	struct m0_cas_next_reply *reps;
 	struct m0_cas_next_reply *rep;
+	uint32_t                  left = st->ds_nr - st->ds_pos;
+	uint32_t                  i;
+	int                       rc = 0;
 
-	if (ctx->sc_reps_nr == 0) {
-		ctx->sc_stop = true;
+	if (nr == 0)
 		return 0;
+	M0_ALLOC_ARR(reps, left + nr);
+	if (reps == NULL)
+		return M0_ERR(-ENOMEM);
+	if (left != 0)
+		memcpy(reps, &st->ds_reps[st->ds_pos], left * sizeof reps[0]);
+	for (i = 0; i < nr && rc == 0; i++) {
+		rep = &reps[left + i];
+		if (creq != NULL) {
+			*rep = ctx->sc_reps[pos + i];
+			m0_cas_rep_mlock(creq, pos + i);
+		} else
+			rc = m0_buf_copy(&rep->cnp_key,
+					 &ctx->sc_reps[pos + i].cnp_key) ?:
+			     m0_buf_copy(&rep->cnp_val,
+					 &ctx->sc_reps[pos + i].cnp_val);
 	}
+	m0_free(st->ds_reps);
+	st->ds_reps = reps;
+	st->ds_nr   = left + i;
+	st->ds_pos  = 0;
+	m0_buf_free(&st->ds_last);
+	return rc ?: m0_buf_copy(&st->ds_last, &reps[st->ds_nr - 1].cnp_key);
+}
 
-	for (i = 0; i < key_idx && pos < ctx->sc_reps_nr; i++) {
-		rep = &ctx->sc_reps[pos];
-		start_pos += recs_nr[i];
-		/** @todo: Why it is so? */
-		if (rep->cnp_rc == NOENT) {
-			pos++;
+/**
+ * Splits CAS reply loaded to the sorting context into the streams requested by
+ * the last CAS NEXT.
+ *
+ * Records of the requested streams go one after another in the order of
+ * starting keys. Records of a stream end either with a record carrying
+ * non-zero return code (no more records in the component catalogue or an
+ * error) or after all requested records.
+ */
+static int sc_load(struct m0_dix_next_sort_ctx *ctx,
+		   struct m0_cas_req           *creq,
+		   uint32_t                     keys_nr)
+{
+	struct m0_dix_next_stream *st;
+	uint32_t                   pos = 0;
+	uint32_t                   nr;
+	uint32_t                   key;
+	int                        rc = 0;
+
+	for (key = 0; key < keys_nr && rc == 0; key++) {
+		st = &ctx->sc_streams[key];
+		if (!st->ds_refill)
 			continue;
+		for (nr = 0; nr < st->ds_asked && pos + nr < ctx->sc_reps_nr &&
+			     ctx->sc_reps[pos + nr].cnp_rc == 0; nr++)
+			;
+		rc = sc_stream_load(ctx, creq, st, pos, nr);
+		pos += nr;
+		if (nr < st->ds_asked) {
+			st->ds_eof = true;
+			/* Skip the record terminating the stream. */
+			if (pos < ctx->sc_reps_nr)
+				pos++;
 		}
-		for (; pos < start_pos && pos < ctx->sc_reps_nr; pos++);
+		st->ds_refill = false;
 	}
-	ctx->sc_pos = pos;
-	ctx->sc_stop = false;
-	return ctx->sc_pos;
+	m0_free0(&ctx->sc_reps);
+	ctx->sc_reps_nr = 0;
+	return M0_RC(rc);
+}
+
+static struct m0_dix_next_sort_ctx *
+sc_find(struct m0_dix_next_resultset *rs, uint32_t sdev_idx)
+{
+	struct m0_dix_next_sort_ctx_arr *arr = &rs->nrs_sctx_arr;
+	uint32_t                         i;
+
+	for (i = 0; i < arr->sca_nr; i++)
+		if (arr->sca_ctx[i].sc_sdev_idx == sdev_idx)
+			return &arr->sca_ctx[i];
+	return NULL;
 }
 
 /**
- * Searches for the minimal value in all sort contexts.
+ * Returns layout instance of the index if it is range-partitioned, NULL
+ * otherwise.
  *
- * After minimal value is found, all sort contexts current positions are moved
- * to the first value that is bigger than found minimal value.
- *
- * Function out values:
- * m0_cas_next_reply *rep - minimal value for all sort contexts
- * m0_dix_next_sort_ctx *ret_ctx - sort context which contains "rep"
- * ret_idx - number of rep in cas_next_rep array
+ * For range-partitioned layouts there is a sorting context for every target of
+ * the pool version (context index is the target) and only the targets of the
+ * current partition of a starting key are merged, see m0_dix_next_results::
+ * drs_part. Records of a partition are stored on its targets only, so the
+ * merge of a partition is complete when these targets have no more records
+ * before the start of the next partition.
+ */
+static struct m0_dix_linst *sc_range_linst(const struct m0_dix_req *req)
+{
+	struct m0_dix_rop_ctx *rop = req->dr_rop;
+	struct m0_dix_linst   *linst;
+
+	if (rop == NULL || rop->dg_rec_ops_nr == 0)
+		return NULL;
+	linst = &rop->dg_rec_ops[0].dgp_iter.dit_linst;
+	return m0_dix_ldesc_is_range(linst->li_ldescr) ? linst : NULL;
+}
+
+/** Checks whether the target holds records of the partition. */
+static bool sc_in_part(struct m0_dix_linst *linst, uint32_t part,
+		       uint32_t tgt)
+{
+	const struct m0_pdclust_attr *attr = &linst->li_pl->pl_attr;
+	uint64_t                      unit_tgt;
+	uint32_t                      unit;
+
+	/* Data and parity units, records are not kept on spares. */
+	for (unit = 0; unit < attr->pa_N + attr->pa_K; unit++) {
+		m0_dix_range_target(linst, part, unit, &unit_tgt);
+		if (unit_tgt == tgt)
+			return true;
+	}
+	return false;
+}
+
+/** Start key of the partition following 'part', NULL for the last one. */
+static const struct m0_buf *sc_part_end(struct m0_dix_linst *linst,
+					uint32_t             part)
+{
+	const struct m0_dix_ranges *ranges;
+
+	if (linst == NULL)
+		return NULL;
+	ranges = &linst->li_ldescr->ld_ranges;
+	return part + 1 < ranges->dr_nr ? &ranges->dr_part[part + 1].dr_start :
+					  NULL;
+}
+
+/** Checks whether the current stream record is past the partition end. */
+static bool sc_stream_is_past(const struct m0_dix_next_stream *st,
+			      const struct m0_buf             *end)
+{
+	return end != NULL && !sc_stream_is_empty(st) &&
+		m0_buf_cmp(&st->ds_reps[st->ds_pos].cnp_key, end) >= 0;
+}
+
+static bool sc_heap_lt(const struct m0_dix_next_sort_ctx_arr *arr,
+		       uint32_t key, uint32_t a, uint32_t b)
+{
+	const struct m0_dix_next_stream *sa = &arr->sca_ctx[a].sc_streams[key];
+	const struct m0_dix_next_stream *sb = &arr->sca_ctx[b].sc_streams[key];
+
+	return sc_rep_cmp(&sa->ds_reps[sa->ds_pos],
+			  &sb->ds_reps[sb->ds_pos]) < 0;
+}
+
+/**
+ * Restores heap property below 'pos' in the heap of sorting contexts ordered
+ * by current records of their 'key' streams.
+ */
+static void sc_heap_down(const struct m0_dix_next_sort_ctx_arr *arr,
+			 uint32_t key, uint32_t *heap, uint32_t nr,
+			 uint32_t pos)
+{
+	uint32_t child;
+
+	while ((child = 2 * pos + 1) < nr) {
+		if (child + 1 < nr &&
+		    sc_heap_lt(arr, key, heap[child + 1], heap[child]))
+			child++;
+		if (!sc_heap_lt(arr, key, heap[child], heap[pos]))
+			break;
+		M0_SWAP(heap[child], heap[pos]);
+		pos = child;
+	}
+}
+
+/**
+ * Marks streams of the starting key to be requested again: drained ones and
+ * ones running low.
+ */
+static void sc_key_refill(struct m0_dix_next_resultset *rs, uint32_t key,
+			  struct m0_dix_linst *linst)
+{
+	struct m0_dix_next_sort_ctx_arr *arr = &rs->nrs_sctx_arr;
+	struct m0_dix_next_results      *res = &rs->nrs_res[key];
+	struct m0_dix_next_stream       *st;
+	const struct m0_buf             *end = sc_part_end(linst,
+							   res->drs_part);
+	uint32_t                         need = res->drs_nr - res->drs_pos;
+	uint32_t                         i;
+
+	for (i = 0; i < arr->sca_nr; i++) {
+		st = &arr->sca_ctx[i].sc_streams[key];
+		if (st->ds_eof ||
+		    st->ds_nr - st->ds_pos > st->ds_asked >> DIX_NEXT_LOW_SHIFT)
+			continue;
+		if (linst != NULL && (sc_stream_is_past(st, end) ||
+				      !sc_in_part(linst, res->drs_part, i)))
+			continue;
+		sc_stream_ask(st, max32u(1, min32u(need, 2 * st->ds_asked)));
+	}
+}
+
+/**
+ * Starts streams of the targets of the new current partition of the starting
+ * key, which were not requested yet.
  *
- * Returns true if for current starting key there are no more records in all
- * sorting contexts.
+ * Returns true if some streams are to be requested.
  */
-static bool sc_min_val_get(struct m0_dix_next_sort_ctx_arr  *ctxarr,
-			   struct m0_cas_next_reply        **rep,
-			   struct m0_dix_next_sort_ctx     **ret_ctx,
-			   uint32_t                         *ret_idx)
+static bool sc_part_start(struct m0_dix_req *req, uint32_t key,
+			  struct m0_dix_linst *linst)
 {
-	uint32_t                     ctx_id;
-	uint32_t                     done_cnt  = 0;
-	uint32_t                     nokey_cnt = 0;
-	struct m0_dix_next_sort_ctx *ctx;
-	struct m0_dix_next_sort_ctx *ctx_arr;
-	struct m0_cas_next_reply    *min       = NULL;
-	struct m0_cas_next_reply    *val;
-	int                          rc;
+	struct m0_dix_next_resultset    *rs = &req->dr_rs;
+	struct m0_dix_next_sort_ctx_arr *arr = &rs->nrs_sctx_arr;
+	struct m0_dix_next_results      *res = &rs->nrs_res[key];
+	struct m0_dix_next_stream       *st;
+	struct m0_buf                    from;
+	uint32_t                         i;
+	bool                             asked = false;
 
-	*ret_ctx = NULL;
-	ctx_arr  = ctxarr->sca_ctx;
-	/* Find minimal value in sort contexts. */
-	for (ctx_id = 0; ctx_id < ctxarr->sca_nr; ctx_id++) {
-		ctx = &ctx_arr[ctx_id];
-		rc = sc_rep_get(ctx, &val);
-		if (rc == NOENT) {
-			nokey_cnt++;
+	/*
+	 * There are no records between the last merged one and the start of
+	 * the partition, so the stream can start right after the last merged
+	 * record (or the starting key).
+	 */
+	from = res->drs_pos > 0 ? res->drs_reps[res->drs_pos - 1].cnp_key :
+		M0_BUF_INIT(req->dr_keys->ov_vec.v_count[key],
+			    req->dr_keys->ov_buf[key]);
+	for (i = 0; i < arr->sca_nr; i++) {
+		st = &arr->sca_ctx[i].sc_streams[key];
+		if (st->ds_asked != 0 || !sc_in_part(linst, res->drs_part, i) ||
+		    m0_dix_tgt2sdev(linst, i)->pd_state != M0_PNDS_ONLINE)
 			continue;
-		}
-		if (rc == PROCESSING_IS_DONE) {
-			done_cnt++;
+		m0_buf_free(&st->ds_last);
+		if (m0_buf_copy(&st->ds_last, &from) != 0)
+			/* Treated as unavailable component catalogue. */
 			continue;
+		sc_stream_ask(st, res->drs_nr - res->drs_pos);
+		asked = true;
+	}
+	return asked;
+}
+
+/**
+ * Merges records of the starting key streams into the result.
+ *
+ * Returns true if the merge is blocked by a drained stream and the key streams
+ * are marked to be requested again.
+ */
+static bool sc_key_merge(struct m0_dix_req *req, uint32_t key, uint32_t *heap)
+{
+	struct m0_dix_next_resultset    *rs = &req->dr_rs;
+	struct m0_dix_next_sort_ctx_arr *arr = &rs->nrs_sctx_arr;
+	struct m0_dix_next_results      *res = &rs->nrs_res[key];
+	struct m0_dix_linst             *linst = sc_range_linst(req);
+	const struct m0_dix_ranges      *ranges;
+	const struct m0_buf             *end;
+	struct m0_dix_next_stream       *st;
+	struct m0_cas_next_reply        *rep;
+	uint32_t                         nr;
+	uint32_t                         i;
+	bool                             blocked;
+
+	if (res->drs_done)
+		return false;
+	while (true) {
+		end = sc_part_end(linst, res->drs_part);
+		nr = 0;
+		blocked = false;
+		for (i = 0; i < arr->sca_nr; i++) {
+			st = &arr->sca_ctx[i].sc_streams[key];
+			if (linst != NULL && !sc_in_part(linst, res->drs_part,
+							 i))
+				continue;
+			if (!sc_stream_is_empty(st)) {
+				if (!sc_stream_is_past(st, end))
+					heap[nr++] = i;
+			} else if (!st->ds_eof)
+				blocked = true;
 		}
-		if (sc_rep_eq(NULL, min) || sc_rep_le(val, min)) {
-			min = val;
-			*ret_ctx = ctx;
-			*ret_idx = ctx->sc_pos;
+		for (i = nr / 2; i > 0; i--)
+			sc_heap_down(arr, key, heap, nr, i - 1);
+		while (!blocked && nr > 0 && res->drs_pos < res->drs_nr) {
+			st  = &arr->sca_ctx[heap[0]].sc_streams[key];
+			rep = &st->ds_reps[st->ds_pos++];
+			/* Drop another replica of the last record. */
+			if (res->drs_pos > 0 &&
+			    sc_rep_cmp(rep,
+				       &res->drs_reps[res->drs_pos - 1]) == 0) {
+				m0_buf_free(&rep->cnp_key);
+				m0_buf_free(&rep->cnp_val);
+			} else
+				res->drs_reps[res->drs_pos++] = *rep;
+			if (sc_stream_is_empty(st)) {
+				blocked = !st->ds_eof;
+				heap[0] = heap[--nr];
+			} else if (sc_stream_is_past(st, end))
+				heap[0] = heap[--nr];
+			sc_heap_down(arr, key, heap, nr, 0);
 		}
+		if (blocked && res->drs_pos < res->drs_nr) {
+			sc_key_refill(rs, key, linst);
+			return true;
+		}
+		if (linst == NULL || res->drs_pos == res->drs_nr)
+			break;
+		/* The partition is merged, continue with the next one. */
+		ranges = &linst->li_ldescr->ld_ranges;
+		if (res->drs_part + 1 == ranges->dr_nr)
+			break;
+		res->drs_part++;
+		if (sc_part_start(req, key, linst))
+			return true;
 	}
-	*rep = min;
-	if (done_cnt == ctxarr->sca_nr || nokey_cnt == ctxarr->sca_nr)
-		return true;
-
-	/* Advance positions (if necessary) in all sort contexts. */
-	for (ctx_id = 0; ctx_id < ctxarr->sca_nr; ctx_id++) {
-		ctx = &ctx_arr[ctx_id];
-		if (ctx->sc_stop)
-			continue;
-		sc_rep_get(ctx, &val);
-		if (val == NULL || sc_rep_eq(val, min))
-			sc_next(ctx);
-	}
+	res->drs_done = true;
+	for (i = 0; i < arr->sca_nr; i++)
+		sc_stream_fini(&arr->sca_ctx[i].sc_streams[key]);
 	return false;
 }
 
+static uint32_t sc_refill_nr(const struct m0_dix_next_resultset *rs,
+			     const struct m0_dix_next_sort_ctx  *ctx)
+{
+	return m0_count(i, rs->nrs_res_nr, ctx->sc_streams[i].ds_refill);
+}
+
 static int dix_rs_vals_alloc(struct m0_dix_next_resultset *rs,
 			     uint32_t key_idx, uint32_t nr)
 {
@@ -210,11 +439,11 @@ static int dix_rs_vals_alloc(struct m0_dix_next_resultset *rs,
 }
 
 /**
- * Loads all CAS replies for NEXT request in sorting contexts.
+ * Loads CAS replies for the last round of NEXT requests in sorting contexts.
  *
- * There is exactly one sorting context for one CAS reply. One CAS reply carries
- * retrieved records for all starting keys in a linear array from one component
- * catalogue.
+ * There is exactly one sorting context for one component catalogue. Sorting
+ * contexts are assigned to CAS requests of the first round, requests of the
+ * following rounds are sent to some of these component catalogues only.
  */
 static int dix_data_load(struct m0_dix_req            *req,
 			 struct m0_dix_next_resultset *rs)
@@ -222,121 +451,215 @@ static int dix_data_load(struct m0_dix_req            *req,
 	struct m0_dix_cas_rop       *cas_rop;
 	struct m0_cas_req           *creq;
 	struct m0_dix_rop_ctx       *rop = req->dr_rop;
+	struct m0_dix_linst         *linst = sc_range_linst(req);
 	struct m0_dix_next_sort_ctx *ctx;
 	uint32_t                     ctx_id = 0;
-	struct m0_dix_next_sort_ctx *ctxs;
 	uint32_t                     i;
+	int                          rc;
 
-	ctxs = rs->nrs_sctx_arr.sca_ctx;
 	m0_tl_for(cas_rop, &rop->dg_cas_reqs, cas_rop) {
-		ctx             = &ctxs[ctx_id++];
+		if (rs->nrs_round == 0) {
+			if (linst != NULL)
+				ctx = sc_find(rs, cas_rop->crp_sdev_idx);
+			else {
+				M0_ASSERT(ctx_id < rs->nrs_sctx_arr.sca_nr);
+				ctx = &rs->nrs_sctx_arr.sca_ctx[ctx_id++];
+				ctx->sc_sdev_idx = cas_rop->crp_sdev_idx;
+			}
+			M0_ASSERT(ctx != NULL);
+			for (i = 0; i < cas_rop->crp_keys_nr; i++)
+				sc_stream_ask(&ctx->sc_streams[
+					      cas_rop->crp_attrs[i].cra_item],
+					      cas_rop->crp_recs_nr[i]);
+		} else
+			ctx = sc_find(rs, cas_rop->crp_sdev_idx);
+		M0_ASSERT(ctx != NULL);
 		creq            = &cas_rop->crp_creq;
-		ctx->sc_creq    = creq;
 		ctx->sc_reps_nr = m0_cas_req_nr(creq);
-		if (ctx->sc_reps_nr == 0)
-			continue;
-		M0_ALLOC_ARR(ctx->sc_reps, ctx->sc_reps_nr);
-		if (ctx->sc_reps == NULL) {
-			/* Free already allocated reps. */
-			for (i = 0; i < ctx_id; i++)
-				m0_free(ctxs[i].sc_reps);
-			return M0_ERR(-ENOMEM);
+		if (ctx->sc_reps_nr != 0) {
+			M0_ALLOC_ARR(ctx->sc_reps, ctx->sc_reps_nr);
+			if (ctx->sc_reps == NULL)
+				return M0_ERR(-ENOMEM);
 		}
 		for (i = 0; i < ctx->sc_reps_nr; i++)
 			m0_cas_next_rep(creq, i, &ctx->sc_reps[i]);
+		rc = sc_load(ctx, creq, rs->nrs_res_nr);
+		if (rc != 0)
+			return M0_ERR(rc);
 	} m0_tl_endfor;
-	M0_ASSERT(ctx_id == rs->nrs_sctx_arr.sca_nr);
+	return M0_RC(0);
+}
+
+/**
+ * Initialises result set of NEXT for range-partitioned layout: a sorting
+ * context for every target and the partition of every starting key.
+ */
+static int sc_range_init(struct m0_dix_req *req, struct m0_dix_linst *linst)
+{
+	struct m0_dix_next_resultset *rs = &req->dr_rs;
+	uint32_t                      nr = m0_dix_devices_nr(linst);
+	uint32_t                      i;
+	int                           rc;
+
+	rc = m0_dix_rs_init(rs, req->dr_items_nr, nr);
+	if (rc != 0)
+		return M0_ERR(rc);
+	for (i = 0; i < nr; i++)
+		rs->nrs_sctx_arr.sca_ctx[i].sc_sdev_idx =
+			m0_dix_tgt2sdev(linst, i)->pd_sdev_idx;
+	for (i = 0; i < req->dr_items_nr; i++)
+		rs->nrs_res[i].drs_part = m0_dix_ldesc_range_find(
+			linst->li_ldescr,
+			&M0_BUF_INIT(req->dr_keys->ov_vec.v_count[i],
+				     req->dr_keys->ov_buf[i]));
 	return M0_RC(0);
 }
 
 M0_INTERNAL int m0_dix_next_result_prepare(struct m0_dix_req *req)
 {
-	struct m0_cas_next_reply        *rep;
-	struct m0_cas_next_reply        *last_rep = NULL;
 	struct m0_dix_next_sort_ctx_arr *ctx_arr;
-	struct m0_dix_next_sort_ctx     *ctxs;
-	uint32_t                         i;
-	uint32_t                         key_id;
+	struct m0_dix_next_stream       *st;
+	struct m0_dix_cas_rop           *cas_rop;
+	struct m0_dix_next_resultset    *rs = &req->dr_rs;
+	uint64_t                         start_keys_nr = req->dr_items_nr;
+	uint32_t                        *heap = NULL;
 	uint32_t                         ctx_id;
-	const uint32_t                  *recs_nr;
-	uint64_t                         start_keys_nr;
-	struct m0_dix_next_resultset    *rs;
-	uint32_t                         ctxs_nr;
-	bool                             done = false;
-	uint32_t                         rc = 0;
-
-	recs_nr       = req->dr_recs_nr;
-	start_keys_nr = req->dr_items_nr;
-	rs            = &req->dr_rs;
-	if (!M0_FI_ENABLED("mock_data_load")) {
-		ctxs_nr = req->dr_rop->dg_cas_reqs_nr;
-		rc = m0_dix_rs_init(rs, start_keys_nr, ctxs_nr);
-	} else
-		ctxs_nr = rs->nrs_sctx_arr.sca_nr;
-	if (rc != 0)
-		goto end;
-	for (i = 0; rc == 0 && i < start_keys_nr; i++)
-		rc = dix_rs_vals_alloc(rs, i, recs_nr[i]);
-	if (rc != 0)
-		goto end;
+	uint32_t                         key_id;
+	uint32_t                         refill_nr = 0;
+	struct m0_dix_linst             *linst = sc_range_linst(req);
+	bool                             mock = M0_FI_ENABLED("mock_data_load");
+	int                              rc = 0;
+
+	M0_ENTRY("req=%p round=%u", req, rs->nrs_round);
+	if (!mock && rs->nrs_round == 0)
+		rc = linst != NULL ? sc_range_init(req, linst) :
+			m0_dix_rs_init(rs, start_keys_nr,
+				       req->dr_rop->dg_cas_reqs_nr);
+	for (key_id = 0; rs->nrs_round == 0 && rc == 0 &&
+			 key_id < start_keys_nr; key_id++)
+		rc = dix_rs_vals_alloc(rs, key_id, req->dr_recs_nr[key_id]);
 	ctx_arr = &rs->nrs_sctx_arr;
-	/*
-	 * Initialise all contexts and load all results from cas_rop into sort
-	 * contexts.
-	 */
-	ctxs = ctx_arr->sca_ctx;
-	if (!M0_FI_ENABLED("mock_data_load"))
+	if (rc == 0 && !mock)
 		rc = dix_data_load(req, rs);
+	/* UT fills sorting contexts and marks requested streams itself. */
+	for (ctx_id = 0; rc == 0 && mock && ctx_id < ctx_arr->sca_nr;
+	     ctx_id++)
+		rc = sc_load(&ctx_arr->sca_ctx[ctx_id], NULL, start_keys_nr);
+	/* Keys and values of loaded records are mlocked. */
+	if (!mock)
+		m0_tl_for(cas_rop, &req->dr_rop->dg_cas_reqs, cas_rop) {
+			m0_cas_req_fini(&cas_rop->crp_creq);
+		} m0_tl_endfor;
 	if (rc != 0)
-		goto end;
-	/* Scan all results and merge-sort values into resultset. */
-	for (key_id = 0; !done && rc == 0 && key_id < start_keys_nr; key_id++) {
-		uint32_t                     cidx    = 0;
-		struct m0_dix_next_sort_ctx *key_ctx = NULL;
-
-		/* Setup key position for all contexts. */
-		for (ctx_id = 0; ctx_id < ctxs_nr; ctx_id++)
-			sc_key_pos_set(&ctxs[ctx_id], key_id, recs_nr);
-		i = 0;
-		while (rc == 0 && i < recs_nr[key_id]) {
-			if ((done = sc_min_val_get(ctx_arr, &rep, &key_ctx,
-						   &cidx)))
-				break;
-			if (rep != NULL &&
-			   (i == 0 || !sc_rep_eq(last_rep, rep))) {
-				sc_result_add(key_ctx, cidx, rs, key_id, rep);
-				last_rep = rep;
-				i++;
+		return M0_ERR(rc);
+	/* Streams requested from unavailable component catalogues. */
+	for (ctx_id = 0; ctx_id < ctx_arr->sca_nr; ctx_id++) {
+		for (key_id = 0; key_id < start_keys_nr; key_id++) {
+			st = &ctx_arr->sca_ctx[ctx_id].sc_streams[key_id];
+			if (st->ds_refill) {
+				st->ds_refill = false;
+				st->ds_eof    = true;
 			}
 		}
 	}
-	/* Free all creqs. We don't need any data from them. */
-	if (!M0_FI_ENABLED("mock_data_load"))
-		for (ctx_id = 0; ctx_id < ctxs_nr; ctx_id++)
-			m0_cas_req_fini(ctxs[ctx_id].sc_creq);
-	return rc;
-end:
-	if (!M0_FI_ENABLED("mock_data_load"))
-		m0_dix_rs_fini(rs);
-	return rc;
+	rs->nrs_round++;
+	if (ctx_arr->sca_nr == 0)
+		return M0_RC(0);
+	M0_ALLOC_ARR(heap, ctx_arr->sca_nr);
+	if (heap == NULL)
+		return M0_ERR(-ENOMEM);
+	for (key_id = 0; key_id < start_keys_nr; key_id++)
+		sc_key_merge(req, key_id, heap);
+	m0_free(heap);
+	refill_nr = m0_count(i, ctx_arr->sca_nr,
+			     sc_refill_nr(rs, &ctx_arr->sca_ctx[i]) > 0);
+	return M0_RC(refill_nr);
 }
 
-static int sc_init(struct m0_dix_next_sort_ctx_arr *ctx_arr, uint32_t nr)
+M0_INTERNAL int m0_dix_next_cas_rop_fill(struct m0_dix_next_resultset *rs,
+					 struct m0_dix_next_sort_ctx  *ctx,
+					 struct m0_dix_cas_rop        *cas_rop)
 {
+	struct m0_dix_next_stream *st;
+	uint32_t                   nr = sc_refill_nr(rs, ctx);
+	uint32_t                   key_id;
+	uint32_t                   i = 0;
+	int                        rc;
+
+	M0_PRE(nr > 0);
+	M0_ALLOC_ARR(cas_rop->crp_attrs, nr);
+	M0_ALLOC_ARR(cas_rop->crp_recs_nr, nr);
+	if (cas_rop->crp_attrs == NULL || cas_rop->crp_recs_nr == NULL)
+		return M0_ERR(-ENOMEM);
+	rc = m0_bufvec_empty_alloc(&cas_rop->crp_keys, nr);
+	if (rc != 0)
+		return M0_ERR(rc);
+	for (key_id = 0; key_id < rs->nrs_res_nr; key_id++) {
+		st = &ctx->sc_streams[key_id];
+		if (!st->ds_refill)
+			continue;
+		cas_rop->crp_keys.ov_vec.v_count[i] = st->ds_last.b_nob;
+		cas_rop->crp_keys.ov_buf[i]         = st->ds_last.b_addr;
+		cas_rop->crp_attrs[i].cra_item      = key_id;
+		cas_rop->crp_recs_nr[i]             = st->ds_asked;
+		i++;
+	}
+	cas_rop->crp_keys_nr = nr;
+	return M0_RC(0);
+}
+
+M0_INTERNAL uint32_t m0_dix_next_batch(uint32_t                      recs_nr,
+				       const struct m0_pdclust_attr *attr)
+{
+	uint64_t per_tgt;
+
+	M0_PRE(attr->pa_P > 0);
+	/* Every target holds (N + K) / P of all records. */
+	per_tgt = ((uint64_t)recs_nr * (attr->pa_N + attr->pa_K) +
+		   attr->pa_P - 1) / attr->pa_P;
+	return min64u(recs_nr, max64u(DIX_NEXT_BATCH_MIN, 2 * per_tgt));
+}
+
+static int sc_init(struct m0_dix_next_sort_ctx_arr *ctx_arr, uint32_t nr,
+		   uint32_t keys_nr)
+{
+	struct m0_dix_next_sort_ctx *ctx;
+	uint32_t                     i;
+	uint32_t                     j;
+
 	ctx_arr->sca_nr = nr;
 	M0_ALLOC_ARR(ctx_arr->sca_ctx, ctx_arr->sca_nr);
 	if (ctx_arr->sca_ctx == NULL)
 		return M0_ERR(-ENOMEM);
+	for (i = 0; i < nr; i++) {
+		ctx = &ctx_arr->sca_ctx[i];
+		M0_ALLOC_ARR(ctx->sc_streams, keys_nr);
+		if (ctx->sc_streams == NULL)
+			return M0_ERR(-ENOMEM);
+		for (j = 0; j < keys_nr; j++)
+			ctx->sc_streams[j].ds_eof = true;
+	}
 	return 0;
 }
 
-static void sc_fini(struct m0_dix_next_sort_ctx_arr *ctx_arr)
+static void sc_fini(struct m0_dix_next_sort_ctx_arr *ctx_arr,
+		    uint32_t                         keys_nr)
 {
-	uint32_t i;
+	struct m0_dix_next_sort_ctx *ctx;
+	uint32_t                     i;
+	uint32_t                     j;
 
-	for (i = 0; i < ctx_arr->sca_nr; i++)
-		m0_free(ctx_arr->sca_ctx[i].sc_reps);
-	m0_free(ctx_arr->sca_ctx);
+	for (i = 0; i < ctx_arr->sca_nr; i++) {
+		ctx = &ctx_arr->sca_ctx[i];
+		m0_free(ctx->sc_reps);
+		if (ctx->sc_streams == NULL)
+			continue;
+		for (j = 0; j < keys_nr; j++)
+			sc_stream_fini(&ctx->sc_streams[j]);
+		m0_free(ctx->sc_streams);
+	}
+	m0_free0(&ctx_arr->sca_ctx);
+	ctx_arr->sca_nr = 0;
 }
 
 M0_INTERNAL int m0_dix_rs_init(struct m0_dix_next_resultset *rs,
@@ -346,10 +669,11 @@ M0_INTERNAL int m0_dix_rs_init(struct m0_dix_next_resultset *rs,
 	int rc;
 
 	rs->nrs_res_nr = start_keys_nr;
+	rs->nrs_round  = 0;
 	M0_ALLOC_ARR(rs->nrs_res, start_keys_nr);
 	if (rs->nrs_res == NULL)
 		return M0_ERR(-ENOMEM);
-	rc = sc_init(&rs->nrs_sctx_arr, sctx_nr);
+	rc = sc_init(&rs->nrs_sctx_arr, sctx_nr, start_keys_nr);
 	return rc;
 }
 
@@ -363,51 +687,19 @@ M0_INTERNAL void m0_dix_rs_fini(struct m0_dix_next_resultset *rs)
 	if (rs->nrs_res != NULL) {
 		for (i = 0; i < rs->nrs_res_nr; i++) {
 			/*
-			 * Free result keys and values, cause all reps are
-			 * mlocked in sc_result_add(). All other keys and values
-			 * have been destroyed by m0_cas_req_fini() at the end
-			 * of m0_dix_next_result_prepare().
+			 * Keys and values of results are owned by the result
+			 * set, unless they are mlocked by the user.
 			 */
 			res = &rs->nrs_res[i];
-			if (!M0_FI_ENABLED("mock_data_load"))
-				for (j = 0; j < rs->nrs_res[i].drs_pos; j++) {
-					m0_buf_free(&res->drs_reps[j]->cnp_key);
-					m0_buf_free(&res->drs_reps[j]->cnp_val);
-				}
+			for (j = 0; j < res->drs_pos; j++) {
+				m0_buf_free(&res->drs_reps[j].cnp_key);
+				m0_buf_free(&res->drs_reps[j].cnp_val);
+			}
 			m0_free(res->drs_reps);
 		}
-		m0_free(rs->nrs_res);
+		m0_free0(&rs->nrs_res);
 	}
-	sc_fini(&rs->nrs_sctx_arr);
-}
-
-/*
- * Key_ctx and cidx (cas key index) are required to hold record in memory.
- * Key/value pair is deallocated in m0_dix_req_fini()->m0_dix_rs_fini().
- */
-static void sc_result_add(struct m0_dix_next_sort_ctx  *key_ctx,
-			  uint32_t                      cidx,
-			  struct m0_dix_next_resultset *rs,
-			  uint32_t                      key_id,
-			  struct m0_cas_next_reply     *rep)
-{
-	struct m0_cas_next_reply   **reps;
-	struct m0_dix_next_results  *res;
-
-	M0_ASSERT(key_ctx != NULL);
-	M0_ASSERT(rs->nrs_res[key_id].drs_pos < rs->nrs_res[key_id].drs_nr);
-	M0_ASSERT(key_id < rs->nrs_res_nr);
-	/*
-	 * Value will be freed at m0_dix_req_fini().
-	 * Pointers to keys and vals are stored in next_resultset.
-	 * Position sc_pos (returned from sc_min_val_get()) is equal to position
-	 * in cas_rep array, that's why we can use cidx for mlock.
-	 */
-	if (!M0_FI_ENABLED("mock_data_load"))
-		m0_cas_rep_mlock(key_ctx->sc_creq, cidx);
-	res  = &rs->nrs_res[key_id];
-	reps = res->drs_reps;
-	reps[res->drs_pos++] = rep;
+	sc_fini(&rs->nrs_sctx_arr, rs->nrs_res_nr);
 }
 
 #undef M0_TRACE_SUBSYSTEM
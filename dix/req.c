@@ -45,6 +45,7 @@
 #include "dix/client_internal.h" /* m0_dix_pver */
 #include "dix/fid_convert.h"
 #include "dix/dix_addb.h"
+#include "dix/ec.h"      /* m0_dix_ec_encode */
 #include "dtm0/dtx.h"   /* m0_dtx0_* API */
 
 static struct m0_sm_state_descr dix_req_states[] = {
@@ -155,6 +156,8 @@ static void dix_ldescr_resolve(struct m0_dix_req *req);
 static void dix_discovery_completed(struct m0_dix_req *req);
 static int dix_idxop_reqs_send(struct m0_dix_req *req);
 static void dix_discovery(struct m0_dix_req *req);
+static void dix_req_connected_ast(struct m0_sm_group *grp,
+				  struct m0_sm_ast   *ast);
 
 static int dix_id_layouts_nr(struct m0_dix_req *req);
 static int dix_unknown_layouts_nr(struct m0_dix_req *req);
@@ -167,6 +170,30 @@ static bool dix_req_is_idxop(const struct m0_dix_req *req)
 	return M0_IN(req->dr_type, (DIX_CREATE, DIX_DELETE, DIX_CCTGS_LOOKUP));
 }
 
+/**
+ * Checks whether request is NEXT sent to all targets of the pool version.
+ *
+ * NEXT of an index with range-partitioned layout is sent to the targets of the
+ * partition holding the starting key, like PUT. Following partitions are
+ * queried when the merge reaches them, see m0_dix_next_result_prepare().
+ */
+static bool dix_req_is_next_all(const struct m0_dix_req *req)
+{
+	const struct m0_dix_layout *layout = &req->dr_indices[0].dd_layout;
+
+	return req->dr_type == DIX_NEXT &&
+		!(layout->dl_type == DIX_LTYPE_DESCR &&
+		  m0_dix_ldesc_is_range(&layout->u.dl_desc));
+}
+
+/** Checks whether values of the index under operation are erasure-coded. */
+static bool dix_req_is_ec(const struct m0_dix_req *req)
+{
+	return !req->dr_is_meta && req->dr_indices_nr == 1 &&
+	       req->dr_indices[0].dd_layout.dl_type == DIX_LTYPE_DESCR &&
+	       m0_dix_ldesc_is_ec(&req->dr_indices[0].dd_layout.u.dl_desc);
+}
+
 static struct m0_sm_group *dix_req_smgrp(const struct m0_dix_req *req)
 {
 	return req->dr_sm.sm_grp;
@@ -216,6 +243,8 @@ static void dix_req_init(struct m0_dix_req  *req,
 	req->dr_is_meta = meta;
 	m0_sm_init(&req->dr_sm, &dix_req_sm_conf, DIXREQ_INIT, grp);
 	m0_sm_addb2_counter_init(&req->dr_sm);
+	m0_reqh_service_connect_waiter_init(&req->dr_conn_wait, grp,
+					    &dix_req_connected_ast);
 }
 
 M0_INTERNAL void m0_dix_mreq_init(struct m0_dix_req  *req,
@@ -274,6 +303,16 @@ static int dix_unknown_layouts_nr(struct m0_dix_req *req)
 	return dix_type_layouts_nr(req, DIX_LTYPE_UNKNOWN);
 }
 
+/**
+ * Whether layouts found by the request are taken from and put to the client
+ * layout cache, see m0_dix_cli::dx_lcache.
+ */
+static bool dix_lcache_is_used(const struct m0_dix_req *req)
+{
+	return !req->dr_is_meta &&
+		!M0_IN(req->dr_type, (DIX_CREATE, DIX_DELETE));
+}
+
 static void dix_to_mdix_map(const struct m0_dix_req *req,
 			    const struct m0_dix_meta_req *mreq)
 {
@@ -306,6 +345,11 @@ static void dix_layout_find_ast_cb(struct m0_sm_group *grp,
 				M0_ASSERT(state == DIXREQ_LAYOUT_DISCOVERY);
 				rc2 = m0_dix_layout_rep_get(meta_req, k,
 					      &req->dr_indices[k].dd_layout);
+				if (rc2 == 0 && dix_lcache_is_used(req) &&
+				    req->dr_indices[k].dd_layout.dl_type ==
+				    DIX_LTYPE_DESCR)
+					m0_dix__lcache_put(req->dr_cli,
+							   &req->dr_indices[k]);
 				break;
 			case DIX_LTYPE_ID:
 				M0_ASSERT(state == DIXREQ_LID_DISCOVERY);
@@ -728,7 +772,8 @@ static int dix_idxop_req_send(struct m0_dix_idxop_req *idxop_req,
 			switch (dreq->dr_type) {
 			case DIX_CREATE:
 				rc = m0_cas_index_create(&creq->ds_creq, &cid,
-							 1, dreq->dr_dtx);
+							 1, dreq->dr_dtx,
+							 flags & COF_VOLATILE);
 				break;
 			case DIX_DELETE:
 				if (idxop_req->dcr_del_phase2)
@@ -886,7 +931,8 @@ static int dix_idxop_meta_update(struct m0_dix_req *req)
 	m0_clink_init(&req->dr_clink, dix_idxop_meta_update_clink_cb);
 	m0_clink_add_lock(&meta_req->dmr_chan, &req->dr_clink);
 	rc = create ?
-	     m0_dix_layout_put(meta_req, fids, layouts, fids_nr, req->dr_flags) :
+	     m0_dix_layout_put(meta_req, fids, layouts, fids_nr,
+			       req->dr_flags & ~COF_VOLATILE) :
 	     m0_dix_layout_del(meta_req, fids, fids_nr);
 	if (rc != 0) {
 		m0_clink_del_lock(&req->dr_clink);
@@ -1003,7 +1049,7 @@ M0_INTERNAL int m0_dix_create(struct m0_dix_req   *req,
 	M0_PRE(m0_forall(i, indices_nr,
 	       indices[i].dd_layout.dl_type != DIX_LTYPE_UNKNOWN));
 	M0_PRE(ergo(req->dr_is_meta, dix_id_layouts_nr(req) == 0));
-	M0_PRE((flags & ~(COF_CROW | COF_SKIP_LAYOUT)) == 0);
+	M0_PRE((flags & ~(COF_CROW | COF_SKIP_LAYOUT | COF_VOLATILE)) == 0);
 	req->dr_dtx = dtx;
 	/*
 	 * Save indices identifiers in two arrays. Indices identifiers in
@@ -1097,12 +1143,53 @@ static void addb2_add_dix_req_attrs(const struct m0_dix_req *req)
 			     req->dr_vals->ov_vec.v_nr);
 }
 
-static void dix_discovery_completed(struct m0_dix_req *req)
+/**
+ * Returns true if the request is parked until the connection to one of the CAS
+ * services it can be sent to is established, see
+ * m0_pools_common::pc_lazy_connect. The request is resumed by
+ * dix_req_connected_ast().
+ *
+ * A failed connection doesn't fail the request here: the CAS request to that
+ * service fails, as with the contexts connected at client initialisation.
+ */
+static bool dix_req_connect_wait(struct m0_dix_req *req)
 {
-	M0_ENTRY();
-	dix_req_state_set(req, DIXREQ_DISCOVERY_DONE);
-	addb2_add_dix_req_attrs(req);
+	struct m0_pools_common     *pc = req->dr_cli->dx_pc;
+	struct m0_pool_version     *pver;
+	struct m0_poolmach_state   *pms;
+	struct m0_pooldev          *sdev;
+	struct m0_reqh_service_ctx *svc;
+	uint32_t                    i;
+	uint32_t                    k;
+	bool                        wait = false;
+
+	if (!pc->pc_lazy_connect)
+		return false;
+	for (i = 0; i < req->dr_indices_nr && !wait; i++) {
+		if (req->dr_indices[i].dd_layout.dl_type != DIX_LTYPE_DESCR)
+			continue;
+		pver = dix_pver_find(req,
+			&req->dr_indices[i].dd_layout.u.dl_desc.ld_pver);
+		if (pver == NULL)
+			continue;
+		m0_rwlock_read_lock(&pver->pv_mach.pm_lock);
+		pms = pver->pv_mach.pm_state;
+		for (k = 0; k < pms->pst_nr_devices && !wait; k++) {
+			sdev = &pms->pst_devices_array[k];
+			if (!M0_IN(sdev->pd_state, (M0_PNDS_ONLINE,
+						    M0_PNDS_SNS_REBALANCING)))
+				continue;
+			svc = pc->pc_dev2svc[sdev->pd_sdev_idx].pds_ctx;
+			wait = m0_reqh_service_connect_waiter_arm(
+					&req->dr_conn_wait, svc);
+		}
+		m0_rwlock_read_unlock(&pver->pv_mach.pm_lock);
+	}
+	return wait;
+}
 
+static void dix_req_exec(struct m0_dix_req *req)
+{
 	/*
 	 * All layouts have been resolved, all types are DIX_LTYPE_DESCR,
 	 * perform dix operation.
@@ -1113,24 +1200,76 @@ static void dix_discovery_completed(struct m0_dix_req *req)
 	case DIX_CCTGS_LOOKUP:
 		dix_idxop(req);
 		break;
+	case DIX_NEXT:
+		/*
+		 * Values of an erasure-coded index are stored as fragments,
+		 * which NEXT can not decode. Such values are read with GET.
+		 */
+		if (dix_req_is_ec(req)) {
+			dix_req_failure(req, M0_ERR(-EOPNOTSUPP));
+			break;
+		}
+		/* Fall through. */
 	case DIX_GET:
 	case DIX_PUT:
 	case DIX_DEL:
-	case DIX_NEXT:
 		dix_rop(req);
 		break;
 	default:
 		M0_IMPOSSIBLE("Unknown request type %u", req->dr_type);
 	}
+}
+
+static void dix_req_connected_ast(struct m0_sm_group *grp,
+				  struct m0_sm_ast   *ast)
+{
+	struct m0_dix_req *req = M0_AMB(req, ast, dr_conn_wait.scw_ast);
+
+	(void)grp;
+	M0_PRE(dix_req_state(req) == DIXREQ_DISCOVERY_DONE);
+	if (!dix_req_connect_wait(req))
+		dix_req_exec(req);
+}
+
+static void dix_discovery_completed(struct m0_dix_req *req)
+{
+	M0_ENTRY();
+	dix_req_state_set(req, DIXREQ_DISCOVERY_DONE);
+	addb2_add_dix_req_attrs(req);
+	if (!dix_req_connect_wait(req))
+		dix_req_exec(req);
 	M0_LEAVE();
 }
 
+/**
+ * Resolves unknown layouts from the client layout cache, which saves the
+ * round trip to the "layout" meta-index for indices accessed before.
+ *
+ * Layouts of created and deleted indices are dropped from the cache instead.
+ */
+static void dix_lcache_resolve(struct m0_dix_req *req)
+{
+	struct m0_dix *index;
+	uint32_t       i;
+
+	if (req->dr_is_meta)
+		return;
+	for (i = 0; i < req->dr_indices_nr; i++) {
+		index = &req->dr_indices[i];
+		if (!dix_lcache_is_used(req))
+			m0_dix__lcache_del(req->dr_cli, &index->dd_fid);
+		else if (index->dd_layout.dl_type == DIX_LTYPE_UNKNOWN)
+			(void)m0_dix__lcache_get(req->dr_cli, index);
+	}
+}
+
 static void dix_discovery_ast(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 {
 	struct m0_dix_req *req = container_of(ast, struct m0_dix_req, dr_ast);
 	M0_ENTRY();
 
 	(void)grp;
+	dix_lcache_resolve(req);
 	if (dix_unknown_layouts_nr(req) > 0)
 		dix_layout_find(req);
 	else if (dix_id_layouts_nr(req) > 0)
@@ -1261,6 +1400,31 @@ static void dix_rec_op_fini(struct m0_dix_rec_op *rec_op)
 {
 	m0_dix_layout_iter_fini(&rec_op->dgp_iter);
 	m0_free(rec_op->dgp_units);
+	m0_free(rec_op->dgp_ec_frags);
+	m0_buf_free(&rec_op->dgp_ec_area);
+}
+
+/** Splits the value of PUT record operation into fragments, see dix/ec.h. */
+static int dix_rec_op_ec_encode(struct m0_dix_req    *req,
+				struct m0_dix_rec_op *rec_op)
+{
+	const struct m0_bufvec *vals    = req->dr_vals;
+	uint64_t                item    = rec_op->dgp_item;
+	uint32_t                nr      = m0_dix_liter_spare_offset(
+						&rec_op->dgp_iter);
+	uint32_t                data_nr = req->dr_indices[0].dd_layout.u.
+					  dl_desc.ld_ec_data;
+	struct m0_buf           val;
+
+	M0_PRE(req->dr_type == DIX_PUT);
+	M0_PRE(data_nr < nr);
+	M0_ALLOC_ARR(rec_op->dgp_ec_frags, nr);
+	if (rec_op->dgp_ec_frags == NULL)
+		return M0_ERR(-ENOMEM);
+	val = M0_BUF_INIT(vals->ov_vec.v_count[item], vals->ov_buf[item]);
+	return M0_RC(m0_dix_ec_encode(&val, data_nr, nr - data_nr,
+				      &rec_op->dgp_ec_area,
+				      rec_op->dgp_ec_frags));
 }
 
 static int dix_cas_rop_alloc(struct m0_dix_req *req, uint32_t sdev,
@@ -1284,6 +1448,7 @@ static int dix_cas_rop_alloc(struct m0_dix_req *req, uint32_t sdev,
 static void dix_cas_rop_fini(struct m0_dix_cas_rop *cas_rop)
 {
 	m0_free(cas_rop->crp_attrs);
+	m0_free(cas_rop->crp_recs_nr);
 	m0_bufvec_free2(&cas_rop->crp_keys);
 	m0_bufvec_free2(&cas_rop->crp_vals);
 	cas_rop_tlink_fini(cas_rop);
@@ -1320,6 +1485,10 @@ static int dix_rop_ctx_init(struct m0_dix_req      *req,
 	M0_PRE(keys_nr != 0);
 	ldesc = &dix->dd_layout.u.dl_desc;
 	rop->dg_pver = dix_pver_find(req, &ldesc->ld_pver);
+	if (dix_req_is_ec(req) &&
+	    ldesc->ld_ec_data >= rop->dg_pver->pv_attr.pa_N +
+				 rop->dg_pver->pv_attr.pa_K)
+		return M0_ERR_INFO(-EINVAL, "ld_ec_data=%u", ldesc->ld_ec_data);
 	M0_ALLOC_ARR(rop->dg_rec_ops, keys_nr);
 	M0_ALLOC_ARR(rop->dg_target_rop, rop->dg_pver->pv_attr.pa_P);
 	if (rop->dg_rec_ops == NULL || rop->dg_target_rop == NULL)
@@ -1329,6 +1498,11 @@ static int dix_rop_ctx_init(struct m0_dix_req      *req,
 		rc = dix_rec_op_init(&rop->dg_rec_ops[i], req, req->dr_cli,
 				     rop->dg_pver, &req->dr_indices[0], &key,
 				     indices == NULL ? i : indices[i]);
+		if (rc == 0 && req->dr_type == DIX_PUT && dix_req_is_ec(req)) {
+			rc = dix_rec_op_ec_encode(req, &rop->dg_rec_ops[i]);
+			if (rc != 0)
+				dix_rec_op_fini(&rop->dg_rec_ops[i]);
+		}
 		if (rc != 0) {
 			for (i = 0; i < rop->dg_rec_ops_nr; i++)
 				dix_rec_op_fini(&rop->dg_rec_ops[i]);
@@ -1618,6 +1792,103 @@ static void dix_cas_rop_rc_update(struct m0_dix_cas_rop *cas_rop, int rc)
 	}
 }
 
+/**
+ * Sends the next round of NEXT requests to component catalogues, which records
+ * are necessary to continue merge sorting.
+ */
+static int dix_next_refill(struct m0_dix_req *req)
+{
+	struct m0_dix_rop_ctx        *rop = req->dr_rop;
+	struct m0_dix_next_resultset *rs = &req->dr_rs;
+	struct m0_dix_next_sort_ctx  *ctx;
+	struct m0_dix_cas_rop        *cas_rop;
+	uint32_t                      i;
+	int                           rc = 0;
+
+	M0_ENTRY("req=%p", req);
+	dix_cas_rops_fini(&rop->dg_cas_reqs);
+	rop->dg_cas_reqs_nr  = 0;
+	rop->dg_completed_nr = 0;
+	for (i = 0; i < rs->nrs_sctx_arr.sca_nr && rc == 0; i++) {
+		ctx = &rs->nrs_sctx_arr.sca_ctx[i];
+		if (!m0_exists(k, rs->nrs_res_nr, ctx->sc_streams[k].ds_refill))
+			continue;
+		rc = dix_cas_rop_alloc(req, ctx->sc_sdev_idx, &cas_rop);
+		if (rc == 0) {
+			cas_rop->crp_flags |= COF_EXCLUDE_START_KEY;
+			/*
+			 * Streams of a range-partitioned index can start at a
+			 * key of another partition, which is not in the
+			 * component catalogue.
+			 */
+			if (!dix_req_is_next_all(req))
+				cas_rop->crp_flags |= COF_SLANT;
+			rc = m0_dix_next_cas_rop_fill(rs, ctx, cas_rop);
+		}
+	}
+	return M0_RC(rc ?: dix_cas_rops_send(req));
+}
+
+/**
+ * Restores erasure-coded values of GET records from the fragments received
+ * from all the units and finalises CAS requests.
+ *
+ * A record is -ENOENT if no fragment is found and some units report -ENOENT.
+ */
+static int dix_ec_get_complete(struct m0_dix_req *req)
+{
+	struct m0_dix_rop_ctx   *rop = req->dr_rop;
+	struct m0_pdclust_attr  *attr = &rop->dg_pver->pv_attr;
+	struct m0_dix_cas_rop   *cas_rop;
+	struct m0_cas_get_reply  rep;
+	struct m0_dix_item      *ditem;
+	struct m0_buf           *frags;
+	uint32_t                *got;
+	bool                    *enoent;
+	uint32_t                 nr = attr->pa_N + attr->pa_K;
+	uint32_t                 data_nr;
+	uint64_t                 item;
+	uint32_t                 i;
+	int                      rc = 0;
+
+	data_nr = req->dr_indices[0].dd_layout.u.dl_desc.ld_ec_data;
+	M0_ALLOC_ARR(frags, req->dr_items_nr * nr);
+	M0_ALLOC_ARR(got, req->dr_items_nr);
+	M0_ALLOC_ARR(enoent, req->dr_items_nr);
+	if (frags == NULL || got == NULL || enoent == NULL)
+		rc = M0_ERR(-ENOMEM);
+	m0_tl_for (cas_rop, &rop->dg_cas_reqs, cas_rop) {
+		if (rc != 0 || m0_cas_req_generic_rc(&cas_rop->crp_creq) != 0)
+			continue;
+		for (i = 0; i < cas_rop->crp_keys_nr; i++) {
+			item = cas_rop->crp_attrs[i].cra_item;
+			m0_cas_get_rep(&cas_rop->crp_creq, i, &rep);
+			if (rep.cge_rc == 0 && got[item] < nr)
+				frags[item * nr + got[item]++] = rep.cge_val;
+			else if (rep.cge_rc == -ENOENT)
+				enoent[item] = true;
+		}
+	} m0_tl_endfor;
+	for (item = 0; rc == 0 && item < req->dr_items_nr; item++) {
+		ditem = &req->dr_items[item];
+		if (ditem->dxi_rc != 0)
+			continue;
+		if (got[item] == 0 && enoent[item])
+			ditem->dxi_rc = -ENOENT;
+		else
+			ditem->dxi_rc = m0_dix_ec_decode(&frags[item * nr], nr,
+							 data_nr,
+							 &ditem->dxi_val);
+	}
+	m0_tl_for (cas_rop, &rop->dg_cas_reqs, cas_rop) {
+		m0_cas_req_fini(&cas_rop->crp_creq);
+	} m0_tl_endfor;
+	m0_free(enoent);
+	m0_free(got);
+	m0_free(frags);
+	return M0_RC(rc);
+}
+
 static void dix_rop_completed(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 {
 	struct m0_dix_req     *req = ast->sa_datum;
@@ -1625,11 +1896,28 @@ static void dix_rop_completed(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 	struct m0_dix_rop_ctx *rop_del_phase2 = NULL;
 	bool                   del_phase2 = false;
 	struct m0_dix_cas_rop *cas_rop;
+	int                    rc = 0;
 
 	(void)grp;
-	if (req->dr_type == DIX_NEXT)
-		m0_dix_next_result_prepare(req);
-	else {
+	/*
+	 * CAS service rejects the operation if the layout sent along does not
+	 * match the stored one, forget the (possibly cached) stale layout.
+	 */
+	if (!req->dr_is_meta &&
+	    m0_tl_exists(cas_rop, cas_rop, &rop->dg_cas_reqs,
+			 m0_cas_req_generic_rc(&cas_rop->crp_creq) ==
+			 -EKEYEXPIRED))
+		m0_dix__lcache_del(req->dr_cli, &req->dr_indices[0].dd_fid);
+	if (req->dr_type == DIX_NEXT) {
+		rc = m0_dix_next_result_prepare(req);
+		if (rc > 0) {
+			rc = dix_next_refill(req);
+			if (rc == 0)
+				return;
+		}
+	} else if (req->dr_type == DIX_GET && dix_req_is_ec(req)) {
+		rc = dix_ec_get_complete(req);
+	} else {
 		/*
 		 * Consider DIX request to be successful if there is at least
 		 * one successful CAS request.
@@ -1652,9 +1940,11 @@ static void dix_rop_completed(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 		del_phase2 = dix_rop_del_phase2_rop(req, &rop_del_phase2) > 0;
 
 	dix_rop_ctx_fini(rop);
-	if (req->dr_type == DIX_GET &&
-	    m0_exists(i, req->dr_items_nr,
-		      dix_item_get_has_failed(&req->dr_items[i]))) {
+	if (rc != 0) {
+		dix_req_failure(req, M0_ERR(rc));
+	} else if (req->dr_type == DIX_GET && !dix_req_is_ec(req) &&
+		   m0_exists(i, req->dr_items_nr,
+			     dix_item_get_has_failed(&req->dr_items[i]))) {
 		dix_req_state_set(req, DIXREQ_GET_RESEND);
 		dix_get_req_resend(req);
 	} else if (req->dr_type == DIX_DEL && del_phase2) {
@@ -1764,7 +2054,7 @@ static int dix_cas_rops_send(struct m0_dix_req *req)
 			case DIX_NEXT:
 				rc = m0_cas_next(creq, &cctg_id,
 						 &cas_rop->crp_keys,
-						 req->dr_recs_nr,
+						 cas_rop->crp_recs_nr,
 						 cas_rop->crp_flags |
 						 COF_SLANT);
 				break;
@@ -1810,7 +2100,7 @@ static int dix_cas_rops_send(struct m0_dix_req *req)
 static void dix_rop_tgt_iter_begin(const struct m0_dix_req *req,
 				   struct m0_dix_rec_op    *rec_op)
 {
-	if (req->dr_type == DIX_NEXT)
+	if (dix_req_is_next_all(req))
 		rec_op->dgp_next_tgt = 0;
 	else
 		m0_dix_layout_iter_reset(&rec_op->dgp_iter);
@@ -1823,7 +2113,7 @@ static uint32_t dix_rop_tgt_iter_max(struct m0_dix_req    *req,
 	enum dix_req_type          type = req->dr_type;
 
 	M0_ASSERT(M0_IN(type, (DIX_GET, DIX_PUT, DIX_DEL, DIX_NEXT)));
-	if (type == DIX_NEXT)
+	if (dix_req_is_next_all(req))
 		/*
 		 * NEXT operation should be sent to all devices, because the
 		 * distribution of keys over devices is unknown. Therefore, all
@@ -1845,7 +2135,7 @@ static void dix_rop_tgt_iter_next(const struct m0_dix_req *req,
 				  uint64_t                *target,
 				  bool                    *is_spare)
 {
-	if (req->dr_type != DIX_NEXT) {
+	if (!dix_req_is_next_all(req)) {
 		*is_spare = m0_dix_liter_unit_classify(&rec_op->dgp_iter,
 				rec_op->dgp_iter.dit_unit) == M0_PUT_SPARE;
 		m0_dix_layout_iter_next(&rec_op->dgp_iter, target);
@@ -1886,6 +2176,20 @@ static uint32_t dix_rop_max_failures(struct m0_dix_rop_ctx *rop)
 	return pver->pv_mach.pm_state->pst_max_device_failures;
 }
 
+/**
+ * Number of parity fragments of an erasure-coded value, that is the number of
+ * unit failures a record survives.
+ */
+static uint32_t dix_rop_ec_parity_nr(const struct m0_dix_req *req)
+{
+	struct m0_pdclust_attr *attr = &req->dr_rop->dg_pver->pv_attr;
+	uint32_t                data_nr = req->dr_indices[0].dd_layout.u.
+					  dl_desc.ld_ec_data;
+
+	return attr->pa_N + attr->pa_K > data_nr ?
+	       attr->pa_N + attr->pa_K - data_nr : 0;
+}
+
 static uint32_t dix_rec_op_spare_offset(struct m0_dix_rec_op *rec_op)
 {
 	return m0_dix_liter_spare_offset(&rec_op->dgp_iter);
@@ -2035,6 +2339,7 @@ static void dix_rop_failed_unit_tgt(struct m0_dix_req    *req,
 			spare_offset = dix_rec_op_spare_offset(rec_op);
 			unit = spare_offset + spare_slot;
 			rec_op->dgp_units[unit].dpu_is_spare = false;
+			rec_op->dgp_units[unit].dpu_ec_frag = pgu->dpu_ec_frag;
 		}
 		break;
 	case DIX_DEL:
@@ -2117,6 +2422,7 @@ static void dix_rop_units_set(struct m0_dix_req *req)
 				       "We do not operate with spares in DTM0");
 			pd = m0_dix_tgt2sdev(&rec_op->dgp_iter.dit_linst, tgt);
 			dix_pg_unit_pd_assign(unit, pd);
+			unit->dpu_ec_frag = j;
 		}
 	}
 
@@ -2138,9 +2444,10 @@ static void dix_rop_units_set(struct m0_dix_req *req)
 
 	/*
 	 * Only one CAS GET request should be sent for every record.
-	 * Choose the best destination for every record.
+	 * Choose the best destination for every record. Fragments of an
+	 * erasure-coded value are read from all the available units.
 	 */
-	if (req->dr_type == DIX_GET) {
+	if (req->dr_type == DIX_GET && !dix_req_is_ec(req)) {
 		for (i = 0; i < rop->dg_rec_ops_nr; i++)
 			dix_online_unit_choose(req, &rop->dg_rec_ops[i]);
 	}
@@ -2190,6 +2497,8 @@ static int dix_cas_rops_alloc(struct m0_dix_req *req)
 	}
 
 	max_failures = dix_rop_max_failures(rop);
+	if (dix_req_is_ec(req) && M0_IN(req->dr_type, (DIX_PUT, DIX_GET)))
+		max_failures = min32u(max_failures, dix_rop_ec_parity_nr(req));
 	for (i = 0; i < rop->dg_rec_ops_nr; i++) {
 		rec_op = &rop->dg_rec_ops[i];
 		/*
@@ -2272,6 +2581,14 @@ static int dix_cas_rops_alloc(struct m0_dix_req *req)
 			if (rc != 0)
 				goto end;
 		}
+		if (req->dr_type == DIX_NEXT) {
+			M0_ALLOC_ARR(cas_rop->crp_recs_nr,
+				     cas_rop->crp_keys_nr);
+			if (cas_rop->crp_recs_nr == NULL) {
+				rc = M0_ERR(-ENOMEM);
+				goto end;
+			}
+		}
 		cas_rop->crp_cur_key = 0;
 	} m0_tl_endfor;
 
@@ -2309,6 +2626,7 @@ static int dix_cas_rops_fill(struct m0_dix_req *req)
 	struct m0_bufvec       *keys;
 	struct m0_bufvec       *vals;
 	struct m0_buf          *key;
+	struct m0_buf          *frag;
 	uint32_t                idx;
 	struct m0_dix_pg_unit  *unit;
 
@@ -2328,12 +2646,25 @@ static int dix_cas_rops_fill(struct m0_dix_req *req)
 			idx = map[tgt]->crp_cur_key;
 			keys->ov_vec.v_count[idx] = key->b_nob;
 			keys->ov_buf[idx]         = key->b_addr;
-			if (req->dr_type == DIX_PUT) {
+			if (req->dr_type == DIX_PUT &&
+			    rec_op->dgp_ec_frags != NULL) {
+				frag = &rec_op->dgp_ec_frags[unit->dpu_ec_frag];
+				vals->ov_vec.v_count[idx] = frag->b_nob;
+				vals->ov_buf[idx]         = frag->b_addr;
+			} else if (req->dr_type == DIX_PUT) {
 				vals->ov_vec.v_count[idx] =
 					req->dr_vals->ov_vec.v_count[item];
 				vals->ov_buf[idx] =
 					req->dr_vals->ov_buf[item];
 			}
+			/* Every target of a partition holds all its records. */
+			if (req->dr_type == DIX_NEXT)
+				map[tgt]->crp_recs_nr[idx] =
+					!dix_req_is_next_all(req) ?
+					req->dr_recs_nr[item] :
+					m0_dix_next_batch(
+						req->dr_recs_nr[item],
+						&rop->dg_pver->pv_attr);
 			map[tgt]->crp_attrs[idx].cra_item = item;
 			map[tgt]->crp_cur_key++;
 		}
@@ -2473,16 +2804,16 @@ M0_INTERNAL void m0_dix_next_rep(const struct m0_dix_req  *req,
 {
 	const struct m0_dix_next_resultset  *rs = &req->dr_rs;
 	struct m0_dix_next_results          *res;
-	struct m0_cas_next_reply           **reps;
+	struct m0_cas_next_reply            *reps;
 
 	M0_ASSERT(rs != NULL);
 	M0_ASSERT(key_idx < rs->nrs_res_nr);
 	res  = &rs->nrs_res[key_idx];
 	reps = res->drs_reps;
 	M0_ASSERT(val_idx < res->drs_pos);
-	M0_ASSERT(reps[val_idx]->cnp_rc == 0);
-	rep->dnr_key = reps[val_idx]->cnp_key;
-	rep->dnr_val = reps[val_idx]->cnp_val;
+	M0_ASSERT(reps[val_idx].cnp_rc == 0);
+	rep->dnr_key = reps[val_idx].cnp_key;
+	rep->dnr_val = reps[val_idx].cnp_val;
 }
 
 M0_INTERNAL uint32_t m0_dix_next_rep_nr(const struct m0_dix_req *req,
@@ -2542,7 +2873,7 @@ M0_INTERNAL void m0_dix_next_rep_mlock(struct m0_dix_req *req,
 {
 	struct m0_dix_next_resultset  *rs = &req->dr_rs;
 	struct m0_dix_next_results    *res;
-	struct m0_cas_next_reply     **reps;
+	struct m0_cas_next_reply      *reps;
 
 	M0_PRE(dix_req_state(req) == DIXREQ_FINAL);
 	M0_PRE(req->dr_type == DIX_NEXT);
@@ -2551,8 +2882,8 @@ M0_INTERNAL void m0_dix_next_rep_mlock(struct m0_dix_req *req,
 	res  = &rs->nrs_res[key_idx];
 	reps = res->drs_reps;
 	M0_PRE(val_idx < res->drs_pos);
-	reps[val_idx]->cnp_val = M0_BUF_INIT0;
-	reps[val_idx]->cnp_key = M0_BUF_INIT0;
+	reps[val_idx].cnp_val = M0_BUF_INIT0;
+	reps[val_idx].cnp_key = M0_BUF_INIT0;
 }
 
 static void dix_item_fini(const struct m0_dix_req *req,
@@ -2591,6 +2922,7 @@ M0_INTERNAL void m0_dix_req_fini(struct m0_dix_req *req)
 	m0_free(req->dr_recs_nr);
 	m0_free(req->dr_rop);
 	m0_dix_rs_fini(&req->dr_rs);
+	m0_reqh_service_connect_waiter_fini(&req->dr_conn_wait);
 	m0_sm_fini(&req->dr_sm);
 }
 
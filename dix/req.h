@@ -82,6 +82,7 @@
 #include "pool/pool_machine.h" /* m0_poolmach_versions */
 #include "dix/layout.h"        /* m0_dix_layout */
 #include "dix/req_internal.h"  /* m0_dix_idxop_ctx */
+#include "reqh/reqh_service.h" /* m0_reqh_service_connect_waiter */
 
 /* Import */
 struct m0_bufvec;
@@ -112,31 +113,58 @@ struct m0_dix {
 	struct m0_dix_layout dd_layout;
 };
 
+/**
+ * Records retrieved for one starting key from one component catalogue.
+ *
+ * Records are sorted, because CAS service returns them in the catalogue order.
+ * Records before 'ds_pos' are already consumed by the merge.
+ */
+struct m0_dix_next_stream {
+	struct m0_cas_next_reply *ds_reps;
+	uint32_t                  ds_nr;
+	uint32_t                  ds_pos;
+	/** Number of records requested by the last CAS NEXT for the stream. */
+	uint32_t                  ds_asked;
+	/** Key of the last record received, start key of a follow-up NEXT. */
+	struct m0_buf             ds_last;
+	/** Component catalogue has no more records. */
+	bool                      ds_eof;
+	/** Stream is (to be) requested by the current CAS NEXT. */
+	bool                      ds_refill;
+};
+
 /**
  * Sorting context for merge sorting NEXT results.
  *
- * There is exactly one sorting context per CAS reply carrying records from one
- * component catalogue. All records from CAS reply are loaded to 'sc_reps'
- * before sorting algorithm starts. Sorting context has current position that is
- * advanced during sorting algorithm.
- *
- * Sorting algorithm for every starting key requested in NEXT operation
- * basically do the following:
- * - In every sorting context find first record related to this starting key and
- *   sets current position to it.
- * - Goes through all sorting contexts looking at records at current position
- *   and find the record with minimal key among them.
- * - Add found record to a result set.
- * - Advances current position in all sorting contexts, so it points to the
- *   first record with a key bigger than the found one.
+ * There is exactly one sorting context per component catalogue queried by NEXT
+ * operation. CAS reply carries records for all starting keys requested from
+ * the component catalogue in a linear array. It is loaded to 'sc_reps' and
+ * then split into per starting key streams.
+ *
+ * Sorting algorithm for every starting key requested in NEXT operation is a
+ * k-way merge of streams for the key from all sorting contexts:
+ * - Streams are kept in a binary heap ordered by keys of their current
+ *   records.
+ * - The minimal record is taken from the heap top and added to the result,
+ *   unless it is a duplicate of the last added one (there are several replicas
+ *   of every record).
+ * - If a stream is drained, but its component catalogue may have more records,
+ *   then nothing after the last record of the stream can be added to the
+ *   result yet. The merge for the key stops and a follow-up CAS NEXT starting
+ *   from the last record is sent to this component catalogue only, together
+ *   with requests for other streams of the key running low. The merge is
+ *   resumed when replies are received.
+ *
+ * Component catalogues are asked for a fraction of the requested records at
+ * first (see m0_dix_next_batch()), so most records are retrieved once.
  */
 struct m0_dix_next_sort_ctx {
-	struct m0_cas_req        *sc_creq;
-	struct m0_cas_next_reply *sc_reps;
-	uint32_t                  sc_reps_nr;
-	bool                      sc_stop;
-	bool                      sc_done;
-	uint32_t                  sc_pos;
+	struct m0_cas_next_reply  *sc_reps;
+	uint32_t                   sc_reps_nr;
+	/** Storage device of the component catalogue. */
+	uint32_t                   sc_sdev_idx;
+	/** Streams for every starting key. */
+	struct m0_dix_next_stream *sc_streams;
 };
 
 struct m0_dix_next_sort_ctx_arr {
@@ -151,9 +179,16 @@ struct m0_dix_next_sort_ctx_arr {
  * exactly one such structure for every starting key.
  */
 struct m0_dix_next_results {
-	struct m0_cas_next_reply  **drs_reps;
+	struct m0_cas_next_reply   *drs_reps;
 	uint32_t                    drs_nr;
 	uint32_t                    drs_pos;
+	/** No more records can be added. */
+	bool                        drs_done;
+	/**
+	 * Partition being merged for range-partitioned layouts, see
+	 * ::HASH_FNC_RANGE.
+	 */
+	uint32_t                    drs_part;
 };
 
 /**
@@ -166,6 +201,8 @@ struct m0_dix_next_resultset {
 	struct m0_dix_next_results      *nrs_res;
 	uint32_t                         nrs_res_nr;
 	struct m0_dix_next_sort_ctx_arr  nrs_sctx_arr;
+	/** Number of CAS NEXT rounds merged so far. */
+	uint32_t                         nrs_round;
 };
 
 enum dix_req_type {
@@ -244,6 +281,11 @@ struct m0_dix_req {
 	struct m0_dix_rop_ctx        *dr_rop;
 	/** AST posted to request state machine group on different events. */
 	struct m0_sm_ast              dr_ast;
+	/**
+	 * Waits for the connections to CAS services, when they are connected
+	 * lazily (m0_pools_common::pc_lazy_connect).
+	 */
+	struct m0_reqh_service_connect_waiter dr_conn_wait;
 	/** DIX request type. */
 	enum dix_req_type             dr_type;
 	/** Result set for DIX_NEXT operation. */
@@ -42,6 +42,8 @@
 struct m0_dix_req;
 struct m0_pool_version;
 struct m0_dix_next_resultset;
+struct m0_dix_next_sort_ctx;
+struct m0_pdclust_attr;
 
 struct m0_dix_item {
 	struct m0_buf dxi_key;
@@ -102,6 +104,8 @@ struct m0_dix_cas_rop {
 	struct m0_bufvec          crp_vals;
 	/** Additional attributes for every key in crp_keys. */
 	struct m0_dix_crop_attrs *crp_attrs;
+	/** Number of records to retrieve for every key in crp_keys (NEXT). */
+	uint32_t                 *crp_recs_nr;
 	struct m0_tlink           crp_linkage;
 	uint64_t                  crp_magix;
 	/**
@@ -136,6 +140,12 @@ struct m0_dix_pg_unit {
 	bool                   dpu_unavail;
 	bool                   dpu_is_spare;
 	bool                   dpu_del_phase2;
+	/**
+	 * Fragment of an erasure-coded value stored in the unit (PUT). It is
+	 * the unit number for data and parity units and the number of the
+	 * replaced unit for a spare unit.
+	 */
+	uint32_t               dpu_ec_frag;
 };
 
 struct m0_dix_rec_op {
@@ -157,6 +167,10 @@ struct m0_dix_rec_op {
 	 * group units.
 	 */
 	uint32_t                  dgp_failed_devs_nr;
+	/** Fragments of an erasure-coded value (PUT), see dix/ec.h. */
+	struct m0_buf            *dgp_ec_frags;
+	/** Memory holding dgp_ec_frags. */
+	struct m0_buf             dgp_ec_area;
 };
 
 struct m0_dix_rop_ctx {
@@ -182,9 +196,35 @@ M0_TL_DECLARE(cas_rop, M0_INTERNAL, struct m0_dix_cas_rop);
  * Since NEXT operation queries all component catalogues for subsequent records,
  * then on completion received records shall be sorted, duplicates shall be
  * filtered and excessive records shall be thrown away from result.
+ *
+ * Merge for a starting key can't proceed past the last record received from a
+ * component catalogue until more records are retrieved from it. Such component
+ * catalogues are to be queried again, see m0_dix_next_cas_rop_fill(), and the
+ * merge is resumed by the next call on completion of these requests.
+ *
+ * @retval >0 number of component catalogues to be queried again.
+ * @retval 0  result set is complete.
  */
 M0_INTERNAL int m0_dix_next_result_prepare(struct m0_dix_req *req);
 
+/**
+ * Fills CAS request for the next round of NEXT operation to the component
+ * catalogue of the sorting context.
+ *
+ * Request shall be sent with COF_EXCLUDE_START_KEY flag, as starting keys are
+ * the last keys received from the component catalogue.
+ */
+M0_INTERNAL int m0_dix_next_cas_rop_fill(struct m0_dix_next_resultset *rs,
+					 struct m0_dix_next_sort_ctx  *ctx,
+					 struct m0_dix_cas_rop        *cas_rop);
+
+/**
+ * Number of records to request from every component catalogue in the first
+ * round of NEXT operation for 'recs_nr' records.
+ */
+M0_INTERNAL uint32_t m0_dix_next_batch(uint32_t                      recs_nr,
+				       const struct m0_pdclust_attr *attr);
+
 /**
  * Initialise result set for NEXT operation.
  *
@@ -34,7 +34,9 @@
 #include "dix/layout.h"
 #include "dix/meta.h"
 #include "dix/client.h"
+#include "dix/client_internal.h"   /* m0_dix__lcache_get */
 #include "dix/fid_convert.h"
+#include "dix/ec.h"
 #include "ut/ut.h"
 #include "ut/misc.h"
 
@@ -1737,6 +1739,50 @@ static void dix_put(void)
 	ut_service_fini();
 }
 
+static void dix_layout_cache(void)
+{
+	struct m0_dix      index;
+	struct m0_dix      unknown = {};
+	struct m0_dix      cached = {};
+	struct m0_dix_cli *cli = &dix_ut_cctx.cl_cli;
+	struct m0_bufvec   keys;
+	struct m0_bufvec   vals;
+	struct dix_rep_arr rep;
+	int                rc;
+
+	ut_service_init();
+	dix_index_init(&index, 1);
+	dix_kv_alloc_and_fill(&keys, &vals, COUNT);
+	rc = dix_common_idx_op(&index, 1, REQ_CREATE);
+	M0_UT_ASSERT(rc == 0);
+	/* Layout is not known, it's looked up and cached. */
+	unknown.dd_fid = index.dd_fid;
+	unknown.dd_layout.dl_type = DIX_LTYPE_UNKNOWN;
+	cached = unknown;
+	M0_UT_ASSERT(!m0_dix__lcache_get(cli, &cached));
+	rc = dix_ut_put(&unknown, &keys, &vals, 0, &rep);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_forall(i, COUNT, rep.dra_rep[i].dre_rc == 0));
+	dix_rep_free(&rep);
+	M0_UT_ASSERT(m0_dix__lcache_get(cli, &cached));
+	M0_UT_ASSERT(m0_dix_layout_eq(&cached.dd_layout, &index.dd_layout));
+	m0_dix_fini(&cached);
+	/* Next request uses the cached layout. */
+	rc = dix_ut_get(&unknown, &keys, &rep);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_forall(i, COUNT, rep.dra_rep[i].dre_rc == 0));
+	dix_vals_check(&rep, COUNT);
+	dix_rep_free(&rep);
+	/* Index deletion drops the cached layout. */
+	rc = dix_common_idx_op(&index, 1, REQ_DELETE);
+	M0_UT_ASSERT(rc == 0);
+	cached = unknown;
+	M0_UT_ASSERT(!m0_dix__lcache_get(cli, &cached));
+	dix_kv_destroy(&keys, &vals);
+	dix_index_fini(&index);
+	ut_service_fini();
+}
+
 static void dix_put_overwrite(void)
 {
 	struct m0_dix      index;
@@ -2246,6 +2292,218 @@ static void dix_next(void)
 	ut_service_fini();
 }
 
+static void dix_range_index_init(struct m0_dix *index, uint32_t id,
+				 uint64_t *bounds, uint32_t bounds_nr)
+{
+	struct m0_dix_ldesc *ldesc = &index->dd_layout.u.dl_desc;
+	struct m0_buf       *bufs;
+	uint32_t             i;
+	int                  rc;
+
+	M0_ALLOC_ARR(bufs, bounds_nr);
+	M0_UT_ASSERT(bufs != NULL);
+	for (i = 0; i < bounds_nr; i++)
+		bufs[i] = M0_BUF_INIT_PTR(&bounds[i]);
+	rc = m0_dix_ldesc_range_init(ldesc, bufs, bounds_nr,
+				     &dix_ut_cctx.cl_pver);
+	m0_free(bufs);
+	M0_UT_ASSERT(rc == 0);
+	index->dd_layout.dl_type = DIX_LTYPE_DESCR;
+	index->dd_fid            = DFID(1, id);
+}
+
+static void dix_range_layout(void)
+{
+	struct m0_dix       index;
+	struct m0_dix_ldesc copy;
+	uint64_t            bounds[] = { 3, 7 };
+	uint64_t            key;
+	struct m0_buf       kbuf = M0_BUF_INIT_PTR(&key);
+	int                 rc;
+
+	M0_SET0(&index);
+	dix_range_index_init(&index, 1, bounds, ARRAY_SIZE(bounds));
+	M0_UT_ASSERT(m0_dix_ldesc_is_range(&index.dd_layout.u.dl_desc));
+	M0_UT_ASSERT(index.dd_layout.u.dl_desc.ld_ranges.dr_nr == 3);
+	key = 0;
+	M0_UT_ASSERT(m0_dix_ldesc_range_find(&index.dd_layout.u.dl_desc,
+					     &kbuf) == 0);
+	key = 3;
+	M0_UT_ASSERT(m0_dix_ldesc_range_find(&index.dd_layout.u.dl_desc,
+					     &kbuf) == 1);
+	key = 9;
+	M0_UT_ASSERT(m0_dix_ldesc_range_find(&index.dd_layout.u.dl_desc,
+					     &kbuf) == 2);
+	/* Split [3, 7) at 5. */
+	key = 5;
+	rc = m0_dix_ldesc_range_split(&index.dd_layout.u.dl_desc, &kbuf, 10);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_dix_ldesc_range_split(&index.dd_layout.u.dl_desc, &kbuf, 10);
+	M0_UT_ASSERT(rc == -EEXIST);
+	M0_UT_ASSERT(index.dd_layout.u.dl_desc.ld_ranges.dr_nr == 4);
+	key = 6;
+	M0_UT_ASSERT(m0_dix_ldesc_range_find(&index.dd_layout.u.dl_desc,
+					     &kbuf) == 2);
+	M0_UT_ASSERT(index.dd_layout.u.dl_desc.ld_ranges.dr_part[2].dr_group ==
+		     10);
+	rc = m0_dix_ldesc_copy(&copy, &index.dd_layout.u.dl_desc);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(copy.ld_ranges.dr_nr == 4);
+	/* Merge it back. */
+	m0_dix_ldesc_range_merge(&index.dd_layout.u.dl_desc, 2);
+	M0_UT_ASSERT(index.dd_layout.u.dl_desc.ld_ranges.dr_nr == 3);
+	M0_UT_ASSERT(m0_dix_ldesc_range_find(&index.dd_layout.u.dl_desc,
+					     &kbuf) == 1);
+	m0_dix_ldesc_fini(&copy);
+	dix_index_fini(&index);
+}
+
+static void dix_next_range(void)
+{
+	struct m0_dix      index;
+	struct m0_bufvec   keys;
+	struct m0_bufvec   next_keys;
+	struct m0_bufvec   vals;
+	struct dix_rep_arr rep;
+	uint64_t           bounds[] = { 3, 7 };
+	uint32_t           recs_nr;
+	int                rc;
+
+	ut_service_init();
+	dix_range_index_init(&index, 1, bounds, ARRAY_SIZE(bounds));
+	dix_kv_alloc_and_fill(&keys, &vals, COUNT);
+	dix_index_create_and_fill(&index, &keys, &vals, 0);
+	rc = m0_bufvec_alloc(&next_keys, 1, sizeof (uint64_t));
+	M0_UT_ASSERT(rc == 0);
+
+	/* All records, through all partitions. */
+	*(uint64_t *)next_keys.ov_buf[0] = dix_key(0);
+	recs_nr = COUNT;
+	rc = dix_ut_next(&index, &next_keys, &recs_nr, 0, &rep);
+	M0_UT_ASSERT(rc == 0);
+	dix_vals_check(&rep, COUNT);
+	dix_rep_free(&rep);
+
+	/* Within a partition. */
+	*(uint64_t *)next_keys.ov_buf[0] = dix_key(3);
+	recs_nr = 3;
+	rc = dix_ut_next(&index, &next_keys, &recs_nr, 0, &rep);
+	M0_UT_ASSERT(rc == 0);
+	dix__vals_check(&rep, 3, 0, 2);
+	dix_rep_free(&rep);
+
+	/* Across the partition boundary, excluding start key. */
+	*(uint64_t *)next_keys.ov_buf[0] = dix_key(2);
+	recs_nr = 5;
+	rc = dix_ut_next(&index, &next_keys, &recs_nr, COF_EXCLUDE_START_KEY,
+			 &rep);
+	M0_UT_ASSERT(rc == 0);
+	dix__vals_check(&rep, 3, 0, 4);
+	dix_rep_free(&rep);
+
+	m0_bufvec_free(&next_keys);
+	dix_kv_destroy(&keys, &vals);
+	dix_index_fini(&index);
+	ut_service_fini();
+}
+
+static void dix_ec_encdec(void)
+{
+	uint8_t       data[100];
+	struct m0_buf val = M0_BUF_INIT(sizeof data, data);
+	struct m0_buf area = M0_BUF_INIT0;
+	struct m0_buf out;
+	struct m0_buf frags[4];
+	struct m0_buf got[4];
+	uint32_t      i;
+	int           rc;
+
+	for (i = 0; i < sizeof data; i++)
+		data[i] = i * 7;
+	rc = m0_dix_ec_encode(&val, 2, 2, &area, frags);
+	M0_UT_ASSERT(rc == 0);
+	/* All the fragments, in the reverse order. */
+	for (i = 0; i < 4; i++)
+		got[i] = frags[3 - i];
+	rc = m0_dix_ec_decode(got, 4, 2, &out);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_buf_eq(&out, &val));
+	m0_buf_free(&out);
+	/* Both data fragments are lost. */
+	got[0] = frags[2];
+	got[1] = frags[3];
+	got[2] = got[3] = M0_BUF_INIT0;
+	rc = m0_dix_ec_decode(got, 4, 2, &out);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_buf_eq(&out, &val));
+	m0_buf_free(&out);
+	/* A duplicate does not replace a lost fragment. */
+	got[0] = frags[3];
+	rc = m0_dix_ec_decode(got, 4, 2, &out);
+	M0_UT_ASSERT(rc == -EIO);
+	m0_buf_free(&area);
+}
+
+static void dix_ec(void)
+{
+	struct m0_dix      index;
+	struct m0_bufvec   keys;
+	struct m0_bufvec   vals;
+	struct m0_bufvec   start_key;
+	uint32_t           recs_nr = COUNT;
+	struct dix_rep_arr rep;
+	int                rc;
+
+	ut_service_init();
+	/* N + K = 3: 2 data and 1 parity fragments. */
+	dix_predictable_index_init(&index, 1);
+	m0_dix_ldesc_ec_set(&index.dd_layout.u.dl_desc, 2);
+	dix_kv_alloc_and_fill(&keys, &vals, COUNT);
+	dix_index_create_and_fill(&index, &keys, &vals, 0);
+	dix_predictable_sdev_ids_fill(&index);
+	rc = dix_ut_get(&index, &keys, &rep);
+	M0_UT_ASSERT(rc == 0);
+	dix_vals_check(&rep, COUNT);
+	dix_rep_free(&rep);
+
+	/* NEXT can not decode values. */
+	rc = m0_bufvec_alloc(&start_key, 1, sizeof(uint64_t));
+	M0_UT_ASSERT(rc == 0);
+	*(uint64_t *)start_key.ov_buf[0] = 0;
+	rc = dix_ut_next(&index, &start_key, &recs_nr, 0, &rep);
+	M0_UT_ASSERT(rc == -EOPNOTSUPP);
+	dix_rep_free(&rep);
+	m0_bufvec_free(&start_key);
+
+	/* A data fragment is lost. */
+	rc = dix_cctg_records_del(&index, &keys, dix_sdev_id(PG_UNIT_DATA));
+	M0_UT_ASSERT(rc == 0);
+	rc = dix_ut_get(&index, &keys, &rep);
+	M0_UT_ASSERT(rc == 0);
+	dix_vals_check(&rep, COUNT);
+	dix_rep_free(&rep);
+
+	/* Too many fragments are lost. */
+	rc = dix_cctg_records_del(&index, &keys, dix_sdev_id(PG_UNIT_PARITY0));
+	M0_UT_ASSERT(rc == 0);
+	rc = dix_ut_get(&index, &keys, &rep);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_forall(i, COUNT, rep.dra_rep[i].dre_rc == -EIO));
+	dix_rep_free(&rep);
+
+	rc = dix_ut_del(&index, &keys, &rep);
+	M0_UT_ASSERT(rc == 0);
+	dix_rep_free(&rep);
+	rc = dix_ut_get(&index, &keys, &rep);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_forall(i, COUNT, rep.dra_rep[i].dre_rc == -ENOENT));
+	dix_rep_free(&rep);
+
+	dix_kv_destroy(&keys, &vals);
+	dix_index_fini(&index);
+	ut_service_fini();
+}
+
 static void dix_next_crow(void)
 {
 	struct m0_dix      index;
@@ -3233,8 +3491,6 @@ void next_merge(void)
 	int                           it;
 
 	m0_fi_enable("m0_dix_next_result_prepare", "mock_data_load");
-	m0_fi_enable("sc_result_add", "mock_data_load");
-	m0_fi_enable("m0_dix_rs_fini", "mock_data_load");
 	for (it = 0; it < ARRAY_SIZE(cases); it++) {
 		/* Create test data. */
 		cases[it](&cas_reps, &dix_reps, &recs_nr,
@@ -3252,6 +3508,12 @@ void next_merge(void)
 			/* Array with cas reps for ctx_id. */
 			creps = cas_reps.ov_buf[ctx_id];
 			ctx->sc_reps_nr = creps->ov_vec.v_nr;
+			for (key_id = 0; key_id < start_keys_nr; key_id++) {
+				ctx->sc_streams[key_id].ds_asked  =
+					recs_nr[key_id];
+				ctx->sc_streams[key_id].ds_eof    = false;
+				ctx->sc_streams[key_id].ds_refill = true;
+			}
 			M0_ALLOC_ARR(ctx->sc_reps, ctx->sc_reps_nr);
 			for (key_id = 0; key_id < ctx->sc_reps_nr; key_id++) {
 				crep = (struct m0_cas_next_reply *)
@@ -3267,8 +3529,88 @@ void next_merge(void)
 		case_data_free(&cas_reps, &dix_reps, recs_nr, &start_keys);
 	}
 	m0_fi_disable("m0_dix_next_result_prepare", "mock_data_load");
-	m0_fi_disable("sc_result_add", "mock_data_load");
-	m0_fi_disable("m0_dix_rs_fini", "mock_data_load");
+}
+
+static void sc_stream_mock(struct m0_dix_next_sort_ctx *ctx, uint32_t key_id,
+			   uint64_t *keys, uint32_t nr, uint32_t asked)
+{
+	struct m0_dix_next_stream *st = &ctx->sc_streams[key_id];
+	uint32_t                   i;
+
+	st->ds_asked  = asked;
+	st->ds_eof    = false;
+	st->ds_refill = true;
+	ctx->sc_reps_nr = nr;
+	M0_ALLOC_ARR(ctx->sc_reps, nr);
+	M0_UT_ASSERT(ctx->sc_reps != NULL);
+	/* Zero key stands for the end of the component catalogue. */
+	for (i = 0; i < nr; i++) {
+		if (keys[i] == 0) {
+			ctx->sc_reps[i].cnp_rc = -ENOENT;
+			continue;
+		}
+		ctx->sc_reps[i].cnp_key = M0_BUF_INIT_PTR(&keys[i]);
+		ctx->sc_reps[i].cnp_val = M0_BUF_INIT_PTR(&keys[i]);
+	}
+}
+
+/*
+ * Merge can't go past the last record of a drained stream until more records
+ * are retrieved from its component catalogue.
+ *
+ * int nrs[]   = {4};
+ * int arr1[]  = {1, 2} + {4, NO};
+ * int arr2[]  = {2, 3};
+ * Result must be: 1 2 3 4
+ */
+static void next_merge_refill(void)
+{
+	struct m0_dix_next_resultset *rs;
+	struct m0_dix_req             req;
+	struct m0_dix_cas_rop         cas_rop;
+	struct m0_dix_next_reply      rep;
+	struct m0_dix_next_sort_ctx  *ctxs;
+	uint32_t                      recs_nr = 4;
+	uint64_t                      arr1[] = { 1, 2 };
+	uint64_t                      arr2[] = { 2, 3 };
+	uint64_t                      arr1_next[] = { 4, 0 };
+	uint64_t                      i;
+	int                           rc;
+
+	M0_SET0(&req);
+	M0_SET0(&cas_rop);
+	m0_fi_enable("m0_dix_next_result_prepare", "mock_data_load");
+	req.dr_recs_nr  = &recs_nr;
+	req.dr_items_nr = 1;
+	rs = &req.dr_rs;
+	rc = m0_dix_rs_init(rs, 1, 2);
+	M0_UT_ASSERT(rc == 0);
+	ctxs = rs->nrs_sctx_arr.sca_ctx;
+	sc_stream_mock(&ctxs[0], 0, arr1, ARRAY_SIZE(arr1), 2);
+	sc_stream_mock(&ctxs[1], 0, arr2, ARRAY_SIZE(arr2), 2);
+	/* Only the first component catalogue is asked for 2 more records. */
+	rc = m0_dix_next_result_prepare(&req);
+	M0_UT_ASSERT(rc == 1);
+	M0_UT_ASSERT(m0_dix_next_rep_nr(&req, 0) == 2);
+	M0_UT_ASSERT(!ctxs[1].sc_streams[0].ds_refill);
+	rc = m0_dix_next_cas_rop_fill(rs, &ctxs[0], &cas_rop);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(cas_rop.crp_keys_nr == 1);
+	M0_UT_ASSERT(cas_rop.crp_recs_nr[0] == 2);
+	M0_UT_ASSERT(*(uint64_t *)cas_rop.crp_keys.ov_buf[0] == 2);
+	m0_free(cas_rop.crp_attrs);
+	m0_free(cas_rop.crp_recs_nr);
+	m0_bufvec_free2(&cas_rop.crp_keys);
+	sc_stream_mock(&ctxs[0], 0, arr1_next, ARRAY_SIZE(arr1_next), 2);
+	rc = m0_dix_next_result_prepare(&req);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_dix_next_rep_nr(&req, 0) == 4);
+	for (i = 0; i < 4; i++) {
+		m0_dix_next_rep(&req, 0, i, &rep);
+		M0_UT_ASSERT(*(uint64_t *)rep.dnr_key.b_addr == i + 1);
+	}
+	m0_dix_rs_fini(rs);
+	m0_fi_disable("m0_dix_next_result_prepare", "mock_data_load");
 }
 
 static void server_is_down(void)
@@ -3309,6 +3651,7 @@ struct m0_ut_suite dix_client_ut = {
 		{ "list",                   dix_list            },
 		{ "put",                    dix_put             },
 		{ "put-overwrite",          dix_put_overwrite   },
+		{ "layout-cache",           dix_layout_cache    },
 		{ "put-crow",               dix_put_crow        },
 		{ "put-dgmode",             dix_put_dgmode      },
 		{ "get",                    dix_get             },
@@ -3319,12 +3662,17 @@ struct m0_ut_suite dix_client_ut = {
 		{ "next-crow",              dix_next_crow       },
 		{ "next-dgmode",            dix_next_dgmode     },
 		{ "next-transient-dgmode",  dix_next_transient_dgmode },
+		{ "range-layout",           dix_range_layout    },
+		{ "next-range",             dix_next_range      },
+		{ "ec-encdec",              dix_ec_encdec       },
+		{ "ec",                     dix_ec              },
 		{ "del",                    dix_del             },
 		{ "del-dgmode",             dix_del_dgmode      },
 		{ "null-value",             dix_null_value      },
 		{ "cctgs-lookup",           dix_cctgs_lookup    },
 		{ "local-failures",         local_failures      },
 		{ "next-merge",             next_merge          },
+		{ "next-merge-refill",      next_merge_refill   },
 		{ "server-is-down",         server_is_down      },
 		{ NULL, NULL }
 	}
@@ -74,6 +74,7 @@ M0_INTERNAL void m0_dtx_init(struct m0_dtx *tx,
 		      NULL, NULL, NULL, NULL);
 	tx->tx_betx_cred = M0_BE_TX_CREDIT(0, 0);
 	tx->tx_state = M0_DTX_INIT;
+	tx->tx_fol_skip = false;
 	m0_fol_rec_init(&tx->tx_fol_rec, NULL);
 }
 
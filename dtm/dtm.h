@@ -559,6 +559,11 @@ struct m0_dtx {
 	struct m0_be_tx        tx_betx;
 	struct m0_be_tx_credit tx_betx_cred;
 	struct m0_fol_rec      tx_fol_rec;
+	/**
+	 * FOL record is not generated for this transaction, because nothing
+	 * consumes it. See m0_fom_fol_is_needed().
+	 */
+	bool                   tx_fol_skip;
 	/* It is the real dtx here (at least on the originator side). */
 	struct m0_dtm0_dtx    *tx_dtx;
 };
@@ -23,7 +23,9 @@
 #include "lib/trace.h"
 
 #include "dtm0/clk_src.h"
-#include "lib/assert.h" /* M0_PRE */
+#include "lib/assert.h"    /* M0_PRE */
+#include "lib/atomic.h"    /* m0_atomic64_cas */
+#include "lib/processor.h" /* m0_processor_id_get */
 
 
 struct m0_dtm0_clk_src_ops {
@@ -34,15 +36,21 @@ struct m0_dtm0_clk_src_ops {
 
 /* See M0_DTM0_CS_PHYS for details */
 static const struct m0_dtm0_clk_src_ops cs_phys_ops;
+/* See M0_DTM0_CS_HLC for details */
+static const struct m0_dtm0_clk_src_ops cs_hlc_ops;
 
 M0_INTERNAL void m0_dtm0_clk_src_init(struct m0_dtm0_clk_src *cs,
 				      enum m0_dtm0_cs_types   type)
 {
+	int i;
+
 	M0_ENTRY();
-	M0_PRE(M0_IN(type, (M0_DTM0_CS_PHYS)));
+	M0_PRE(M0_IN(type, (M0_DTM0_CS_PHYS, M0_DTM0_CS_HLC)));
 	m0_mutex_init(&cs->cs_phys_lock);
 	cs->cs_last = M0_DTM0_TS_MIN;
-	cs->cs_ops = &cs_phys_ops;
+	for (i = 0; i < ARRAY_SIZE(cs->cs_slots); ++i)
+		cs->cs_slots[i].cls_last = i;
+	cs->cs_ops = type == M0_DTM0_CS_PHYS ? &cs_phys_ops : &cs_hlc_ops;
 	M0_LEAVE();
 }
 
@@ -50,7 +58,7 @@ M0_INTERNAL void m0_dtm0_clk_src_fini(struct m0_dtm0_clk_src *cs)
 {
 	M0_ENTRY();
 	M0_PRE(cs);
-	M0_PRE(M0_IN(cs->cs_ops, (&cs_phys_ops)));
+	M0_PRE(M0_IN(cs->cs_ops, (&cs_phys_ops, &cs_hlc_ops)));
 	m0_mutex_fini(&cs->cs_phys_lock);
 	cs->cs_last = M0_DTM0_TS_INIT;
 	cs->cs_ops = NULL;
@@ -115,6 +123,35 @@ static const struct m0_dtm0_clk_src_ops cs_phys_ops = {
 	.cso_now      = cs_phys_now,
 };
 
+/* Hybrid clock implementation */
+
+static void cs_hlc_now(struct m0_dtm0_clk_src *cs, struct m0_dtm0_ts *now)
+{
+	const int64_t            mask = M0_DTM0_CS_HLC_SLOT_NR - 1;
+	int64_t                  idx;
+	int64_t                  last;
+	int64_t                  next;
+	struct m0_dtm0_clk_slot *slot;
+
+	M0_PRE(M0_IN(cs->cs_ops, (&cs_hlc_ops)));
+
+	idx  = m0_processor_id_get() & mask;
+	slot = &cs->cs_slots[idx];
+	do {
+		last = ((volatile struct m0_dtm0_clk_slot *)slot)->cls_last;
+		next = (m0_time_now() & ~mask) | idx;
+		if (next <= last)
+			next = last + M0_DTM0_CS_HLC_SLOT_NR;
+	} while (!m0_atomic64_cas(&slot->cls_last, last, next));
+
+	now->dts_phys = next;
+}
+
+static const struct m0_dtm0_clk_src_ops cs_hlc_ops = {
+	.cso_cmp      = cs_phys_cmp,
+	.cso_now      = cs_hlc_now,
+};
+
 M0_INTERNAL bool m0_dtm0_ts_is_none(const struct m0_dtm0_ts *ts)
 {
 	return ts->dts_phys == 0;
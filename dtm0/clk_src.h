@@ -61,6 +61,10 @@
  * corresponding source clock.
  *   The user must ensure to use only one type of clock source in the system.
  * The module provides no protection against such cases.
+ *
+ *   The physical clock serialises all CS.NOW callers on a mutex. The hybrid
+ * clock (M0_DTM0_CS_HLC) takes no locks: every processor hands out timestamps
+ * from its own slot with an atomic compare-and-swap, see M0_DTM0_CS_HLC.
  */
 
 
@@ -85,6 +89,24 @@ enum m0_dtm0_cs_types {
 	 * then user should always check the clock drift value.
 	 */
 	M0_DTM0_CS_PHYS,
+	/*
+	 * Hybrid logical clock.
+	 * Timestamps are physical time in nanoseconds where the low
+	 * M0_DTM0_CS_HLC_SLOT_BITS bits are replaced with the index of the
+	 * slot (processor) the timestamp was taken on. Each slot is advanced
+	 * with an atomic compare-and-swap, so that timestamps from one slot are
+	 * strictly monotonic, timestamps from different slots never collide,
+	 * and every timestamp is not older than the physical time it was taken
+	 * at. When a slot is asked for timestamps faster than the physical
+	 * clock moves, it runs ahead of physical time by the number of extra
+	 * requests. Comparison is the same as for the physical clock.
+	 */
+	M0_DTM0_CS_HLC,
+};
+
+enum {
+	M0_DTM0_CS_HLC_SLOT_BITS = 6,
+	M0_DTM0_CS_HLC_SLOT_NR   = 1 << M0_DTM0_CS_HLC_SLOT_BITS,
 };
 
 /** A data type that represents a timestamp (see CS.TS).*/
@@ -120,11 +142,19 @@ enum m0_dtm0_ts_ord {
 
 struct m0_dtm_clk_src_ops;
 
+/** Last timestamp handed out by a slot of the hybrid clock. */
+struct m0_dtm0_clk_slot {
+	int64_t cls_last;
+	/* Keeps slots on separate cache lines. */
+	char    cls_pad[56];
+};
+
 /** Instance of a specific clock source. */
 struct m0_dtm0_clk_src {
 	const struct m0_dtm0_clk_src_ops *cs_ops;
 	struct m0_dtm0_ts                 cs_last;
 	struct m0_mutex                   cs_phys_lock;
+	struct m0_dtm0_clk_slot           cs_slots[M0_DTM0_CS_HLC_SLOT_NR];
 };
 
 /** Compares two timestamps. See CS.TS.CMP */
@@ -43,6 +43,14 @@ enum {
 	 */
 	DRLINK_CONNECT_TIMEOUT_SEC = 1,
 	DRLINK_DISCONN_TIMEOUT_SEC = DRLINK_CONNECT_TIMEOUT_SEC,
+	/**
+	 * Maximal number of PERSISTENT notices coalesced into one message.
+	 * A batch that reaches this size is sent without waiting for the
+	 * timer.
+	 */
+	DRLINK_PBATCH_MAX = 64,
+	/** How long the first notice in a batch waits for other ones. */
+	DRLINK_PBATCH_DELAY_NS = 1000000,
 };
 
 struct drlink_fom {
@@ -55,6 +63,13 @@ struct drlink_fom {
 	struct m0_co_op          df_co_op;
 	bool                     df_wait_for_ack;
 	uint64_t                 df_parent_sm_id;
+	/**
+	 * Remote process whose pending PERSISTENT notices are sent by this
+	 * FOM once df_pbatch_to expires. NULL when the message is known at
+	 * the moment the FOM is created.
+	 */
+	struct dtm0_process     *df_pbatch_proc;
+	struct m0_fom_timeout    df_pbatch_to;
 };
 
 static struct drlink_fom *fom2drlink_fom(struct m0_fom *fom)
@@ -131,24 +146,18 @@ static void dtm0_req_fop_fini(struct dtm0_req_fop *req)
 	m0_buf_free(&req->dtr_payload);
 }
 
-static int drlink_fom_init(struct drlink_fom            *fom,
-			   struct m0_dtm0_service       *svc,
-			   struct m0_be_op              *op,
-			   const struct m0_fid          *tgt,
-			   const struct dtm0_req_fop    *req,
-			   const struct m0_fom          *parent_fom,
-			   bool                          wait_for_ack)
+/** Allocates the FOP that carries a copy of the given request. */
+static int drlink_fom_fop_set(struct drlink_fom         *fom,
+			      struct m0_dtm0_service    *svc,
+			      const struct dtm0_req_fop *req,
+			      bool                       wait_for_ack)
 {
 	struct m0_rpc_machine  *mach;
 	struct m0_reqh         *reqh;
 	struct dtm0_req_fop    *owned_req;
 	struct m0_fop          *fop;
 
-	M0_ENTRY();
-	M0_PRE(fom != NULL);
-	M0_PRE(svc != NULL);
-	M0_PRE(req != NULL);
-	M0_PRE(m0_fid_is_valid(tgt));
+	M0_PRE(fom->df_rfop == NULL);
 
 	reqh = svc->dos_generic.rs_reqh;
 	mach = m0_reqh_rpc_mach_tlist_head(&reqh->rh_rpc_machines);
@@ -174,16 +183,53 @@ static int drlink_fom_init(struct drlink_fom            *fom,
 	 */
 	fop->f_opaque = wait_for_ack ? fom : NULL;
 
+	/* TODO: can we use fom->fo_fop instead? */
+	fom->df_rfop = fop;
+	return 0;
+}
+
+/**
+ * Initialises a drlink FOM. Either @req is the message to be sent, or
+ * @pbatch_proc is the process whose pending PERSISTENT notices are sent
+ * (see ::m0_dtm0_pmsg_post).
+ */
+static int drlink_fom_init(struct drlink_fom            *fom,
+			   struct m0_dtm0_service       *svc,
+			   struct m0_be_op              *op,
+			   const struct m0_fid          *tgt,
+			   const struct dtm0_req_fop    *req,
+			   const struct m0_fom          *parent_fom,
+			   bool                          wait_for_ack,
+			   struct dtm0_process          *pbatch_proc)
+{
+	struct m0_reqh *reqh;
+	int             rc;
+
+	M0_ENTRY();
+	M0_PRE(fom != NULL);
+	M0_PRE(svc != NULL);
+	M0_PRE((req == NULL) != (pbatch_proc == NULL));
+	M0_PRE(m0_fid_is_valid(tgt));
+
+	reqh = svc->dos_generic.rs_reqh;
+
+	if (req != NULL) {
+		rc = drlink_fom_fop_set(fom, svc, req, wait_for_ack);
+		if (rc != 0)
+			return M0_ERR(rc);
+	}
+
 	m0_fom_init(&fom->df_gen, &drlink_fom_type, &drlink_fom_ops,
 		    NULL, NULL, reqh);
 
-	/* TODO: can we use fom->fo_fop instead? */
-	fom->df_rfop =  fop;
 	fom->df_svc  =  svc;
 	fom->df_op   = op;
 	fom->df_tgt  = *tgt;
 	fom->df_wait_for_ack = wait_for_ack;
 	fom->df_parent_sm_id = m0_sm_id_get(&parent_fom->fo_sm_phase);
+	fom->df_pbatch_proc = pbatch_proc;
+	if (pbatch_proc != NULL)
+		m0_fom_timeout_init(&fom->df_pbatch_to);
 
 	m0_co_context_init(&fom->df_co);
 	m0_co_op_init(&fom->df_co_op);
@@ -199,6 +245,8 @@ static void drlink_fom_fini(struct m0_fom *fom)
 	struct drlink_fom *df = fom2drlink_fom(fom);
 	if (df->df_rfop != NULL)
 		m0_fop_put_lock(df->df_rfop);
+	if (df->df_pbatch_proc != NULL)
+		m0_fom_timeout_fini(&df->df_pbatch_to);
 	m0_co_op_fini(&df->df_co_op);
 	m0_fom_fini(fom);
 	m0_free(fom);
@@ -242,10 +290,58 @@ static int find_or_add(struct m0_dtm0_service *dtms,
 	return M0_RC(rc);
 }
 
+/**
+ * Prepares a PERSISTENT message for the batch. A batch of one notice is sent
+ * as an ordinary PERSISTENT message. The request shares descriptors with the
+ * batch, only dtr_payload has to be freed by the caller.
+ */
+static int drlink_pbatch_req_init(struct dtm0_req_fop    *req,
+				  struct dtm0_pmsg_batch *batch)
+{
+	M0_PRE(batch->dpb_nr > 0);
+
+	*req = (struct dtm0_req_fop) { .dtr_msg = DTM_PERSISTENT };
+	if (batch->dpb_nr == 1) {
+		req->dtr_txr = batch->dpb_txd[0];
+		return 0;
+	}
+	req->dtr_flags = M0_BITS(M0_DMF_PBATCH);
+	return m0_xcode_obj_enc_to_buf(&M0_XCODE_OBJ(dtm0_pmsg_batch_xc, batch),
+				       &req->dtr_payload.b_addr,
+				       &req->dtr_payload.b_nob);
+}
+
+/** Detaches pending notices of the process and prepares the FOP for them. */
+static int drlink_pbatch_take(struct drlink_fom *drf)
+{
+	struct dtm0_process    *proc = drf->df_pbatch_proc;
+	struct dtm0_pmsg_batch  batch;
+	struct dtm0_req_fop     req;
+	int                     rc = 0;
+
+	m0_mutex_lock(&proc->dop_pbatch_lock);
+	M0_ASSERT(proc->dop_pbatch_armed);
+	batch = proc->dop_pbatch;
+	proc->dop_pbatch = (struct dtm0_pmsg_batch) {};
+	proc->dop_pbatch_armed = false;
+	m0_mutex_unlock(&proc->dop_pbatch_lock);
+
+	/* The batch is empty if it was sent because it got full. */
+	if (batch.dpb_nr > 0) {
+		rc = drlink_pbatch_req_init(&req, &batch) ?:
+			drlink_fom_fop_set(drf, drf->df_svc, &req,
+					   drf->df_wait_for_ack);
+		m0_buf_free(&req.dtr_payload);
+	}
+	m0_dtm0_pmsg_batch_fini(&batch);
+	return M0_RC(rc);
+}
+
 enum drlink_fom_state {
 	DRF_INIT = M0_FOM_PHASE_INIT,
 	DRF_DONE = M0_FOM_PHASE_FINISH,
 	DRF_LOCKING = M0_FOM_PHASE_NR,
+	DRF_BATCHING,
 	DRF_DISCONNECTING,
 	DRF_CONNECTING,
 	DRF_SENDING,
@@ -257,7 +353,8 @@ enum drlink_fom_state {
 static struct m0_sm_state_descr drlink_fom_states[] = {
 	[DRF_INIT] = {
 		.sd_name      = "DRF_INIT",
-		.sd_allowed   = M0_BITS(DRF_LOCKING, DRF_FAILED),
+		.sd_allowed   = M0_BITS(DRF_LOCKING, DRF_BATCHING,
+					DRF_FAILED),
 		.sd_flags     = M0_SDF_INITIAL,
 	},
 	/* terminal states */
@@ -283,6 +380,9 @@ static struct m0_sm_state_descr drlink_fom_states[] = {
 					   DRF_CONNECTING,
 					   DRF_SENDING,
 					   DRF_FAILED)),
+	_ST(DRF_BATCHING,          M0_BITS(DRF_LOCKING,
+					   DRF_DONE,
+					   DRF_FAILED)),
 	_ST(DRF_DISCONNECTING,        M0_BITS(DRF_CONNECTING,
 					      DRF_FAILED)),
 	_ST(DRF_CONNECTING,        M0_BITS(DRF_SENDING,
@@ -495,6 +595,23 @@ static void drlink_coro_fom_tick(struct m0_co_context *context)
 
 	drlink_addb_drf2parent_relate(drf);
 
+	if (drf->df_pbatch_proc != NULL) {
+		/* Let other PERSISTENT notices for the process join in. */
+		m0_fom_phase_set(fom, DRF_BATCHING);
+		rc = m0_fom_timeout_wait_on(&drf->df_pbatch_to, fom,
+					    m0_time_from_now(0,
+						     DRLINK_PBATCH_DELAY_NS));
+		if (rc == 0)
+			M0_CO_YIELD_RC(context, M0_FSO_WAIT);
+		rc = drlink_pbatch_take(drf);
+		if (rc != 0) {
+			reason = "Cannot prepare a batch of PERSISTENT notices";
+			goto out;
+		}
+		if (drf->df_rfop == NULL)
+			goto out;
+	}
+
 	m0_mutex_lock(&drf->df_svc->dos_generic.rs_mutex);
 	rc = find_or_add(drf->df_svc, &drf->df_tgt, &F(proc));
 	/*
@@ -589,26 +706,35 @@ static void drlink_coro_fom_tick(struct m0_co_context *context)
 	/* Safety: FOP (and item) can be released only in ::drlink_fom_fini. */
 	drlink_addb_drf2item_relate(drf);
 
+	/*
+	 * The link is not used after the item is posted, so that the lock is
+	 * released before waiting for the reply. It lets other messages to
+	 * the same process (e.g. a window of REDOs) be in flight at once.
+	 * If the link is re-connected meanwhile, the item is cancelled and
+	 * the reply callback is called with an error.
+	 */
+	m0_long_write_unlock(&F(proc)->dop_llock, &F(llink));
+	m0_long_lock_link_fini(&F(llink));
+
 	if (drf->df_wait_for_ack) {
 		M0_CO_YIELD_RC(context,
 			       m0_co_op_tick_ret(&drf->df_co_op, fom,
 						 DRF_WAITING_FOR_REPLY));
 		m0_co_op_reset(&drf->df_co_op);
 		rc = m0_rpc_item_error(&drf->df_rfop->f_item);
-		if (rc != 0) {
+		if (rc != 0)
 			reason = "Rpc item error";
-			goto unlock;
-		}
 	}
+	goto put;
 
 unlock:
+	m0_long_write_unlock(&F(proc)->dop_llock, &F(llink));
+	m0_long_lock_link_fini(&F(llink));
+put:
 	if (drf->df_rfop != NULL) {
 		m0_fop_put_lock(drf->df_rfop);
 		drf->df_rfop = NULL;
 	}
-
-	m0_long_write_unlock(&F(proc)->dop_llock, &F(llink));
-	m0_long_lock_link_fini(&F(llink));
 out:
 	/* TODO handle the error */
 	if (rc != 0) {
@@ -659,7 +785,8 @@ M0_INTERNAL int m0_dtm0_req_post(struct m0_dtm0_service    *svc,
 	if (fom == NULL)
 		return M0_ERR(-ENOMEM);
 
-	rc = drlink_fom_init(fom, svc, op, tgt, req, parent_fom, wait_for_ack);
+	rc = drlink_fom_init(fom, svc, op, tgt, req, parent_fom, wait_for_ack,
+			     NULL);
 
 	if (rc == 0)
 		m0_fom_queue(&fom->df_gen);
@@ -669,6 +796,64 @@ M0_INTERNAL int m0_dtm0_req_post(struct m0_dtm0_service    *svc,
 	return rc == 0 ? M0_RC(rc) : M0_ERR(rc);
 }
 
+M0_INTERNAL int m0_dtm0_pmsg_post(struct m0_dtm0_service       *svc,
+				  const struct m0_dtm0_tx_desc *txd,
+				  const struct m0_fid          *tgt,
+				  const struct m0_fom          *parent_fom)
+{
+	struct dtm0_process    *proc;
+	struct dtm0_pmsg_batch  full = {};
+	struct dtm0_req_fop     req;
+	struct drlink_fom      *fom;
+	bool                    arm = false;
+	int                     rc;
+
+	M0_ENTRY("tgt=" FID_F, FID_P(tgt));
+
+	m0_mutex_lock(&svc->dos_generic.rs_mutex);
+	rc = find_or_add(svc, tgt, &proc);
+	m0_mutex_unlock(&svc->dos_generic.rs_mutex);
+	if (rc != 0)
+		return M0_ERR(rc);
+
+	m0_mutex_lock(&proc->dop_pbatch_lock);
+	rc = m0_dtm0_pmsg_batch_add(&proc->dop_pbatch, txd, DRLINK_PBATCH_MAX);
+	if (rc == 0) {
+		if (proc->dop_pbatch.dpb_nr == DRLINK_PBATCH_MAX) {
+			full = proc->dop_pbatch;
+			proc->dop_pbatch = (struct dtm0_pmsg_batch) {};
+		} else if (!proc->dop_pbatch_armed)
+			arm = proc->dop_pbatch_armed = true;
+	}
+	m0_mutex_unlock(&proc->dop_pbatch_lock);
+	if (rc != 0)
+		return M0_ERR(rc);
+
+	if (full.dpb_nr > 0) {
+		/* Flush on size, the armed FOM will find a new batch. */
+		rc = drlink_pbatch_req_init(&req, &full) ?:
+			m0_dtm0_req_post(svc, NULL, &req, tgt, parent_fom,
+					 true);
+		m0_buf_free(&req.dtr_payload);
+		m0_dtm0_pmsg_batch_fini(&full);
+	} else if (arm) {
+		/* Flush on timer, see DRF_BATCHING in drlink_coro_fom_tick. */
+		rc = M0_ALLOC_PTR(fom) == NULL ? -ENOMEM :
+			drlink_fom_init(fom, svc, NULL, tgt, NULL, parent_fom,
+					true, proc);
+		if (rc == 0)
+			m0_fom_queue(&fom->df_gen);
+		else {
+			m0_free(fom);
+			/* The notice will be sent with the next batch. */
+			m0_mutex_lock(&proc->dop_pbatch_lock);
+			proc->dop_pbatch_armed = false;
+			m0_mutex_unlock(&proc->dop_pbatch_lock);
+		}
+	}
+	return rc == 0 ? M0_RC(rc) : M0_ERR(rc);
+}
+
 /*
  *  Local variables:
  *  c-indentation-style: "K&R"
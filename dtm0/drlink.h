@@ -32,6 +32,9 @@
  * to connect to the target process (if there is no connection) and then
  * it sends the DTM0 message (for example, PERSISTENT).
  *
+ * PERSISTENT notices are posted with ::m0_dtm0_pmsg_post. Notices bound for
+ * the same remote process are accumulated and sent in one message, either
+ * when the batch gets full or after a short delay.
  */
 
 /* import */
@@ -41,6 +44,7 @@ struct m0_dtm0_service;
 struct m0_fid;
 struct m0_fom;
 struct m0_be_op;
+struct m0_dtm0_tx_desc;
 
 M0_INTERNAL int  m0_dtm0_rpc_link_mod_init(void);
 M0_INTERNAL void m0_dtm0_rpc_link_mod_fini(void);
@@ -67,6 +71,22 @@ M0_INTERNAL int m0_dtm0_req_post(struct m0_dtm0_service    *svc,
 				 const struct m0_fom       *parent_fom,
 				 bool                       wait_for_ack);
 
+/**
+ * Asynchronously send a PERSISTENT notice for the transaction to a remote
+ * DTM0 service. The notice is coalesced with other notices bound for the
+ * same remote process. The local service waits for the ACK.
+ * @param svc local DTM0 service.
+ * @param txd descriptor of the transaction. It is copied.
+ * @param tgt FID of the remote DTM0 service.
+ * @param parent_fom FOM that caused this notice (used by ADDB).
+ * @return An error is returned if there is not enough resources (-ENOMEM) or
+ *         if the remote service does not exist in the conf cache (-ENOENT).
+ */
+M0_INTERNAL int m0_dtm0_pmsg_post(struct m0_dtm0_service       *svc,
+				  const struct m0_dtm0_tx_desc *txd,
+				  const struct m0_fid          *tgt,
+				  const struct m0_fom          *parent_fom);
+
 #endif /* __MOTR_DTM0_DRLINK_H__ */
 
 /*
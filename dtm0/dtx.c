@@ -316,18 +316,11 @@ static void dtx_done(struct m0_dtm0_dtx *dtx)
 	M0_LEAVE();
 }
 
-static void dtx_persistent_ast_cb(struct m0_sm_group *grp,
-				  struct m0_sm_ast   *ast)
+static void dtx_persistent_apply(struct m0_be_dtm0_log        *log,
+				 const struct m0_dtm0_tx_desc *txd)
 {
-	struct m0_dtm0_log_rec       *rec;
-	struct m0_dtm0_dtx           *dtx;
-	struct m0_dtm0_pmsg_ast      *pma = ast->sa_datum;
-	struct m0_fop                *fop = pma->p_fop;
-	struct m0_be_dtm0_log        *log = pma->p_log;
-	struct dtm0_req_fop          *req = m0_fop_data(fop);
-	const struct m0_dtm0_tx_desc *txd = &req->dtr_txr;
-
-	M0_ENTRY("fop=%p", fop);
+	struct m0_dtm0_log_rec *rec;
+	struct m0_dtm0_dtx     *dtx;
 
 	m0_mutex_lock(&log->dl_lock);
 	rec = m0_be_dtm0_log_find(log, &txd->dtd_id);
@@ -347,6 +340,18 @@ static void dtx_persistent_ast_cb(struct m0_sm_group *grp,
 		m0_sm_state_set(&dtx->dd_sm, M0_DDS_STABLE);
 	}
 	m0_mutex_unlock(&log->dl_lock);
+}
+
+static void dtx_persistent_ast_cb(struct m0_sm_group *grp,
+				  struct m0_sm_ast   *ast)
+{
+	struct m0_dtm0_pmsg_ast *pma = ast->sa_datum;
+	struct m0_fop           *fop = pma->p_fop;
+	struct dtm0_req_fop     *req = m0_fop_data(fop);
+
+	M0_ENTRY("fop=%p", fop);
+
+	dtx_persistent_apply(pma->p_log, &req->dtr_txr);
 
 	m0_free(pma);
 	m0_fop_put_lock(fop); /* it was taken in ::m0_dtm0_dtx_post_pmsg */
@@ -402,6 +407,75 @@ M0_INTERNAL void m0_dtm0_dtx_pmsg_post(struct m0_be_dtm0_log *log,
 	M0_LEAVE();
 }
 
+/** An AST object for a descriptor that came in a batched persistent message. */
+struct dtx_pmsg_txd_ast {
+	struct m0_sm_ast        pta_ast;
+	struct m0_dtm0_tx_desc  pta_txd;
+	struct m0_be_dtm0_log  *pta_log;
+};
+
+static void dtx_persistent_txd_ast_cb(struct m0_sm_group *grp,
+				      struct m0_sm_ast   *ast)
+{
+	struct dtx_pmsg_txd_ast *pta = M0_AMB(pta, ast, pta_ast);
+
+	M0_ENTRY("txid=" DTID0_F, DTID0_P(&pta->pta_txd.dtd_id));
+	dtx_persistent_apply(pta->pta_log, &pta->pta_txd);
+	m0_dtm0_tx_desc_fini(&pta->pta_txd);
+	m0_free(pta);
+	M0_LEAVE();
+}
+
+static void dtx_pmsg_txd_post(struct m0_be_dtm0_log        *log,
+			      const struct m0_dtm0_tx_desc *txd)
+{
+	struct dtx_pmsg_txd_ast *pta;
+	struct m0_sm_group      *dtx_sm_grp;
+	struct m0_dtm0_log_rec  *rec;
+	int                      rc;
+
+	M0_PRE(m0_mutex_is_locked(&log->dl_lock));
+
+	rec = m0_be_dtm0_log_find(log, &txd->dtd_id);
+	dtx_sm_grp = rec != NULL ? rec->dlr_dtx.dd_sm.sm_grp : NULL;
+	if (dtx_sm_grp == NULL)
+		return;
+
+	/*
+	 * The descriptor belongs to the batch owned by the Pmsg FOM,
+	 * so that the AST gets its own copy.
+	 */
+	rc = M0_ALLOC_PTR(pta) == NULL ? -ENOMEM :
+		m0_dtm0_tx_desc_copy(txd, &pta->pta_txd);
+	if (rc == 0) {
+		pta->pta_log = log;
+		pta->pta_ast.sa_cb = dtx_persistent_txd_ast_cb;
+		/* pta will be freed by ::dtx_persistent_txd_ast_cb */
+		m0_sm_ast_post(dtx_sm_grp, &pta->pta_ast);
+	} else {
+		M0_LOG(M0_WARN, "Pmsg for " DTID0_F " is dropped: %d",
+		       DTID0_P(&txd->dtd_id), rc);
+		m0_free(pta);
+	}
+}
+
+M0_INTERNAL void m0_dtm0_dtx_pmsg_txd_post(struct m0_be_dtm0_log        *log,
+					   const struct m0_dtm0_tx_desc *txd,
+					   uint32_t                      nr)
+{
+	uint32_t i;
+
+	M0_PRE(!log->dl_is_persistent);
+
+	M0_ENTRY("nr=%"PRIu32, nr);
+
+	m0_mutex_lock(&log->dl_lock);
+	for (i = 0; i < nr; ++i)
+		dtx_pmsg_txd_post(log, &txd[i]);
+	m0_mutex_unlock(&log->dl_lock);
+	M0_LEAVE();
+}
+
 M0_INTERNAL struct m0_dtx* m0_dtx0_alloc(struct m0_dtm0_service *svc,
 					 struct m0_sm_group     *grp)
 {
@@ -140,6 +140,19 @@ M0_INTERNAL void m0_dtx0_done(struct m0_dtx *dtx);
 M0_INTERNAL void m0_dtm0_dtx_pmsg_post(struct m0_be_dtm0_log *log,
 				       struct m0_fop         *fop);
 
+/**
+ * Launches asynchronous processing of the descriptors carried by a batched
+ * persistent message. The log is locked once for the whole batch. The
+ * descriptors are copied, so that the caller may release them right after
+ * the call.
+ * @param log A pointer to the DTM0 log.
+ * @param txd An array of descriptors with partial updates to be applied.
+ * @param nr  Number of descriptors in the array.
+ */
+M0_INTERNAL void m0_dtm0_dtx_pmsg_txd_post(struct m0_be_dtm0_log        *log,
+					   const struct m0_dtm0_tx_desc *txd,
+					   uint32_t                      nr);
+
 /**
  * Puts a copy of dtx's transaction descriptor into "dst".
  * User is responsible for m0_dtm0_tx_desc_fini() lasing of 'dst'.
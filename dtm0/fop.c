@@ -49,6 +49,8 @@ struct dtm0_fom {
 	struct m0_fom           dtf_fom;
 	struct m0_fom_thralldom dtf_thrall;
 	int                     dtf_thrall_rc;
+	/** Decoded descriptors of a batched PERSISTENT message or NULL. */
+	struct dtm0_pmsg_batch *dtf_pbatch;
 };
 
 static int dtm0_emsg_fom_tick(struct m0_fom *fom);
@@ -213,6 +215,59 @@ M0_INTERNAL int m0_dtm0_fop_init(void)
 }
 
 
+M0_INTERNAL int m0_dtm0_pmsg_batch_add(struct dtm0_pmsg_batch       *batch,
+				       const struct m0_dtm0_tx_desc *txd,
+				       uint32_t                      max)
+{
+	int rc;
+
+	M0_PRE(batch->dpb_nr < max);
+
+	if (batch->dpb_txd == NULL) {
+		M0_ALLOC_ARR(batch->dpb_txd, max);
+		if (batch->dpb_txd == NULL)
+			return M0_ERR(-ENOMEM);
+	}
+	rc = m0_dtm0_tx_desc_copy(txd, &batch->dpb_txd[batch->dpb_nr]);
+	if (rc == 0)
+		batch->dpb_nr++;
+	return M0_RC(rc);
+}
+
+M0_INTERNAL void m0_dtm0_pmsg_batch_fini(struct dtm0_pmsg_batch *batch)
+{
+	uint32_t i;
+
+	for (i = 0; i < batch->dpb_nr; ++i)
+		m0_dtm0_tx_desc_fini(&batch->dpb_txd[i]);
+	m0_free(batch->dpb_txd);
+	M0_SET0(batch);
+}
+
+static int dtm0_pmsg_batch_decode(struct dtm0_req_fop     *req,
+				  struct dtm0_pmsg_batch **out)
+{
+	struct dtm0_pmsg_batch *batch;
+	int                     rc;
+
+	M0_PRE(req->dtr_msg == DTM_PERSISTENT);
+
+	*out = NULL;
+	if (!(req->dtr_flags & M0_BITS(M0_DMF_PBATCH)))
+		return 0;
+	if (M0_ALLOC_PTR(batch) == NULL)
+		return M0_ERR(-ENOMEM);
+	rc = m0_xcode_obj_dec_from_buf(
+		&M0_XCODE_OBJ(dtm0_pmsg_batch_xc, batch),
+		req->dtr_payload.b_addr, req->dtr_payload.b_nob);
+	if (rc != 0) {
+		m0_xcode_free_obj(&M0_XCODE_OBJ(dtm0_pmsg_batch_xc, batch));
+		return M0_ERR_INFO(rc, "Could not decode a Pmsg batch");
+	}
+	*out = batch;
+	return M0_RC(0);
+}
+
 /*
   Allocates a fom.
  */
@@ -259,6 +314,13 @@ static int dtm0_fom_create(struct m0_fop *fop,
 		m0_fom_init(&fom->dtf_fom, &fop->f_type->ft_fom_type,
 			    &dtm0_emsg_fom_ops, fop, repfop, reqh);
 	} else if (req->dtr_msg == DTM_PERSISTENT) {
+		rc = dtm0_pmsg_batch_decode(req, &fom->dtf_pbatch);
+		if (rc != 0) {
+			m0_free(pma);
+			m0_fop_put_lock(repfop);
+			m0_free(fom);
+			return M0_ERR(rc);
+		}
 		m0_fom_init(&fom->dtf_fom, &fop->f_type->ft_fom_type,
 			    &dtm0_pmsg_fom_ops, fop, repfop, reqh);
 	} else if (req->dtr_msg == DTM_REDO) {
@@ -275,10 +337,15 @@ static int dtm0_fom_create(struct m0_fop *fop,
 
 static void dtm0_fom_fini(struct m0_fom *fom)
 {
+	struct dtm0_fom *dfom = M0_AMB(dfom, fom, dtf_fom);
+
 	M0_PRE(fom != NULL);
 
 	m0_fom_fini(fom);
-	m0_free(fom);
+	if (dfom->dtf_pbatch != NULL)
+		m0_xcode_free_obj(&M0_XCODE_OBJ(dtm0_pmsg_batch_xc,
+						dfom->dtf_pbatch));
+	m0_free(dfom);
 }
 
 static size_t dtm0_fom_locality(const struct m0_fom *fom)
@@ -313,8 +380,8 @@ M0_INTERNAL int m0_dtm0_on_committed(struct m0_fom            *fom,
 	const struct m0_dtm0_log_rec *rec;
 	const struct m0_fid          *target;
 	const struct m0_fid          *source;
-	struct dtm0_req_fop           req = { .dtr_msg = DTM_PERSISTENT };
-	struct m0_dtm0_tx_desc       *txd = &req.dtr_txr;
+	struct m0_dtm0_tx_desc        txd_copy = {};
+	struct m0_dtm0_tx_desc       *txd = &txd_copy;
 	int                           rc;
 	int                           i;
 
@@ -364,7 +431,7 @@ M0_INTERNAL int m0_dtm0_on_committed(struct m0_fom            *fom,
 		if (m0_fid_eq(target, source))
 			target = &txd->dtd_id.dti_fid;
 
-		rc = m0_dtm0_req_post(dtms, NULL, &req, target, fom, true);
+		rc = m0_dtm0_pmsg_post(dtms, txd, target, fom);
 		if (rc != 0) {
 			M0_LOG(M0_WARN, "Failed to send PERSISTENT msg "
 				    FID_F " -> " FID_F " (%d).",
@@ -388,31 +455,46 @@ out:
  * A FOM tick to handle a DTM0 PERSISTENT message (Pmsg).
  * A group of Pmsgs is sent whenever a local transaction gets committed
  * (see ::m0_dtm0_on_committed). This routine is the recipient of such
- * messages.
+ * messages. A Pmsg carries either a single descriptor or a batch of them
+ * (see ::m0_dtm0_pmsg_post), both are handled in the same way.
  */
 static int dtm0_pmsg_fom_tick(struct m0_fom *fom)
 {
 	int                       result = M0_FSO_AGAIN;
+	struct   dtm0_fom        *dfom = M0_AMB(dfom, fom, dtf_fom);
 	struct   m0_dtm0_service *svc;
 	struct   m0_buf           buf = {};
 	struct   dtm0_rep_fop    *rep;
 	struct   dtm0_req_fop    *req = m0_fop_data(fom->fo_fop);
 	int                       phase = m0_fom_phase(fom);
 	struct   m0_be_tx_credit  cred = {};
+	struct   m0_dtm0_tx_desc *txd;
+	uint32_t                  txd_nr;
+	uint32_t                  i;
+	int                       rc;
 
 	M0_PRE(req->dtr_msg == DTM_PERSISTENT);
 	M0_ENTRY("fom %p phase %d", fom, phase);
 
+	if (dfom->dtf_pbatch != NULL) {
+		txd    = dfom->dtf_pbatch->dpb_txd;
+		txd_nr = dfom->dtf_pbatch->dpb_nr;
+	} else {
+		txd    = &req->dtr_txr;
+		txd_nr = 1;
+	}
+
 	switch (phase) {
 	case M0_FOPH_INIT ... M0_FOPH_NR - 1:
 		result = m0_fom_tick_generic(fom);
 		if (m0_dtm0_is_a_persistent_dtm(fom->fo_service) &&
 		    m0_fom_phase(fom) == M0_FOPH_TXN_OPEN) {
 			M0_ASSERT(phase == M0_FOPH_TXN_INIT);
-			m0_be_dtm0_log_credit(M0_DTML_PERSISTENT,
-					      &req->dtr_txr, &buf,
-					      m0_fom_reqh(fom)->rh_beseg,
-					      NULL, &cred);
+			for (i = 0; i < txd_nr; ++i)
+				m0_be_dtm0_log_credit(M0_DTML_PERSISTENT,
+						      &txd[i], &buf,
+						      m0_fom_reqh(fom)->rh_beseg,
+						      NULL, &cred);
 			m0_be_tx_credit_add(&fom->fo_tx.tx_betx_cred, &cred);
 		}
 		break;
@@ -439,12 +521,21 @@ static int dtm0_pmsg_fom_tick(struct m0_fom *fom)
 			 * modifed right here. We have to post an AST
 			 * to ensure DTX is modifed under the group lock held.
 			 */
-			m0_dtm0_dtx_pmsg_post(svc->dos_log, fom->fo_fop);
+			if (dfom->dtf_pbatch == NULL)
+				m0_dtm0_dtx_pmsg_post(svc->dos_log,
+						      fom->fo_fop);
+			else
+				m0_dtm0_dtx_pmsg_txd_post(svc->dos_log,
+							  txd, txd_nr);
 			rep->dr_rc = 0;
 		} else {
-			rep->dr_rc = m0_dtm0_logrec_update(svc->dos_log,
+			rep->dr_rc = 0;
+			for (i = 0; i < txd_nr; ++i) {
+				rc = m0_dtm0_logrec_update(svc->dos_log,
 							   &fom->fo_tx.tx_betx,
-							   &req->dtr_txr, &buf);
+							   &txd[i], &buf);
+				rep->dr_rc = rep->dr_rc ?: rc;
+			}
 		}
 
 		/* We do not handle any failures of Pmsg processing. */
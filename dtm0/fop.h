@@ -53,8 +53,23 @@ enum m0_dtm0s_msg {
 enum m0_dtm0_msg_flags {
 	M0_DMF_EOL,
 	M0_DMF_EVICTION,
+	/**
+	 * DTM_PERSISTENT message carries a dtm0_pmsg_batch encoded in
+	 * dtm0_req_fop::dtr_payload instead of a single descriptor in
+	 * dtm0_req_fop::dtr_txr.
+	 */
+	M0_DMF_PBATCH,
 };
 
+/**
+ * A set of transaction descriptors whose PERSISTENT notices are coalesced
+ * into one DTM0 message (see ::m0_dtm0_pmsg_post).
+ */
+struct dtm0_pmsg_batch {
+	uint32_t                dpb_nr;
+	struct m0_dtm0_tx_desc *dpb_txd;
+} M0_XCA_SEQUENCE M0_XCA_DOMAIN(rpc);
+
 /** A DTM0 message sent as an RPC request to remote DTM0 services. */
 struct dtm0_req_fop {
 	uint32_t               dtr_msg M0_XCA_FENUM(m0_dtm0s_msg);
@@ -87,6 +102,17 @@ struct dtm0_rep_fop {
 M0_INTERNAL int m0_dtm0_on_committed(struct m0_fom            *fom,
 				     const struct m0_dtm0_tid *id);
 
+/**
+ * Appends a copy of the descriptor to the batch.
+ * The array of descriptors is allocated for @max items on the first call.
+ *
+ * @pre batch->dpb_nr < max
+ */
+M0_INTERNAL int m0_dtm0_pmsg_batch_add(struct dtm0_pmsg_batch       *batch,
+				       const struct m0_dtm0_tx_desc *txd,
+				       uint32_t                      max);
+M0_INTERNAL void m0_dtm0_pmsg_batch_fini(struct dtm0_pmsg_batch *batch);
+
 M0_INTERNAL int m0_dtm0_logrec_update(struct m0_be_dtm0_log  *log,
 				      struct m0_be_tx        *tx,
 				      struct m0_dtm0_tx_desc *txd,
@@ -58,6 +58,18 @@ M0_INTERNAL int m0_dtm0_req_post(struct m0_dtm0_service    *svc,
 	return 0;
 }
 
+M0_INTERNAL int m0_dtm0_pmsg_post(struct m0_dtm0_service       *svc,
+				  const struct m0_dtm0_tx_desc *txd,
+				  const struct m0_fid          *tgt,
+				  const struct m0_fom          *parent_fom)
+{
+	(void) svc;
+	(void) txd;
+	(void) tgt;
+	(void) parent_fom;
+	return 0;
+}
+
 #include "dtm0/recovery.h"
 
 M0_INTERNAL int m0_drm_domain_init(void)
@@ -25,10 +25,15 @@
  * @{
  */
 
-#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_XXX
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_DTM0
 #include "lib/trace.h"
 
 #include "dtm0/pruner.h"
+#include "be/dtm0_log.h"       /* m0_be_dtm0_plog_horizon */
+#include "be/domain.h"         /* m0_be_domain_tx_size_max */
+#include "be/tx.h"             /* m0_be_tx */
+#include "lib/memory.h"        /* M0_ALLOC_PTR */
+#include "lib/errno.h"         /* ENOMEM */
 
 M0_INTERNAL int m0_dtm0_pruner_init(struct m0_dtm0_pruner     *dpn,
 				    struct m0_dtm0_pruner_cfg *dpn_cfg)
@@ -47,6 +52,92 @@ M0_INTERNAL void m0_dtm0_pruner_start(struct m0_dtm0_pruner *dpn)
 M0_INTERNAL void m0_dtm0_pruner_stop(struct m0_dtm0_pruner *dpn)
 {
 }
+
+M0_INTERNAL void m0_dtm0_pruner_horizon(struct m0_be_dtm0_log *log,
+					struct m0_dtm0_ts     *horizon)
+{
+	m0_mutex_lock(&log->dl_lock);
+	m0_be_dtm0_plog_horizon(log, horizon);
+	m0_mutex_unlock(&log->dl_lock);
+	horizon->dts_phys = horizon->dts_phys > M0_DTM0_PRUNER_HORIZON_LAG ?
+		horizon->dts_phys - M0_DTM0_PRUNER_HORIZON_LAG : 0;
+}
+
+/**
+ * Removes one batch of records. Credits are calculated under the log lock,
+ * the lock is released while the transaction is being opened and the batch
+ * is removed under the lock again. The batch cannot get larger in between,
+ * because new records are appended to the tail of the log only.
+ */
+static int pruner_prune_batch(struct m0_be_dtm0_log   *log,
+			      struct m0_sm_group      *grp,
+			      struct m0_be_domain     *bedom,
+			      const struct m0_dtm0_ts *horizon,
+			      uint32_t                *nr)
+{
+	struct m0_be_tx_credit  cred;
+	struct m0_be_tx_credit  cred_max;
+	m0_bcount_t             payload_max;
+	struct m0_be_tx        *tx;
+	uint32_t                max = M0_DTM0_PRUNER_BULK_MAX;
+	int                     rc;
+
+	m0_be_domain_tx_size_max(bedom, &cred_max, &payload_max);
+	m0_mutex_lock(&log->dl_lock);
+	do {
+		cred = M0_BE_TX_CREDIT(0, 0);
+		*nr = m0_be_dtm0_plog_prune_bulk_credit(log, horizon, max,
+							&cred);
+	} while (*nr > 1 && !m0_be_tx_credit_le(&cred, &cred_max) &&
+		 (max = *nr / 2) > 0);
+	m0_mutex_unlock(&log->dl_lock);
+	if (*nr == 0)
+		return 0;
+
+	M0_ALLOC_PTR(tx);
+	if (tx == NULL) {
+		*nr = 0;
+		return M0_ERR(-ENOMEM);
+	}
+	m0_be_tx_init(tx, 0, bedom, grp, NULL, NULL, NULL, NULL);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	if (rc == 0) {
+		m0_mutex_lock(&log->dl_lock);
+		*nr = m0_be_dtm0_plog_prune_bulk(log, tx, horizon, *nr);
+		m0_mutex_unlock(&log->dl_lock);
+		m0_be_tx_close_sync(tx);
+	} else
+		*nr = 0;
+	m0_be_tx_fini(tx);
+	m0_free(tx);
+	return M0_RC(rc);
+}
+
+M0_INTERNAL int m0_dtm0_pruner_prune_bulk(struct m0_be_dtm0_log *log,
+					  struct m0_sm_group    *grp,
+					  struct m0_be_domain   *bedom,
+					  uint64_t              *pruned)
+{
+	struct m0_dtm0_ts horizon;
+	uint64_t          total = 0;
+	uint32_t          nr;
+	int               rc;
+
+	M0_ENTRY("log=%p", log);
+	M0_PRE(log->dl_is_persistent);
+
+	m0_dtm0_pruner_horizon(log, &horizon);
+	do {
+		rc = pruner_prune_batch(log, grp, bedom, &horizon, &nr);
+		total += nr;
+	} while (rc == 0 && nr > 0);
+
+	if (pruned != NULL)
+		*pruned = total;
+	return M0_RC_INFO(rc, "pruned=%"PRIu64, total);
+}
+
 #undef M0_TRACE_SUBSYSTEM
 
 /** @} end of XXX group */
@@ -24,6 +24,8 @@
 #ifndef __MOTR___DTM0_PRUNER_H__
 #define __MOTR___DTM0_PRUNER_H__
 
+#include "lib/time.h"          /* M0_TIME_ONE_SECOND */
+
 /**
  * @defgroup dtm0
  *
@@ -52,8 +54,31 @@
  *       /|\             +----+
  *        +------ F -----| HA |
  *                       +----+
+ *
+ *   Pruner horizon is the timestamp such that every operation older than it has
+ * been seen by all its participants. Versions and tombstones of such
+ * operations are not needed to order them against other operations anymore, so
+ * CAS compaction removes tombstones older than the horizon (see
+ * cas/compact.c). The horizon is the oldest operation in the local log that is
+ * not persistent everywhere, moved back by M0_DTM0_PRUNER_HORIZON_LAG to cover
+ * operations still in flight to this participant.
  */
 
+struct m0_be_dtm0_log;
+struct m0_be_domain;
+struct m0_sm_group;
+struct m0_dtm0_ts;
+
+/** How long an operation may travel before it reaches the log. */
+#define M0_DTM0_PRUNER_HORIZON_LAG (60ULL * M0_TIME_ONE_SECOND)
+
+/**
+ * Maximum number of log records removed in a single transaction by
+ * m0_dtm0_pruner_prune_bulk(). It is further reduced when the transaction
+ * would not fit into the BE transaction size limit.
+ */
+enum { M0_DTM0_PRUNER_BULK_MAX = 4096 };
+
 struct m0_dtm0_pruner {
 };
 
@@ -66,6 +91,24 @@ M0_INTERNAL void m0_dtm0_pruner_fini(struct m0_dtm0_pruner *dpn);
 M0_INTERNAL void m0_dtm0_pruner_start(struct m0_dtm0_pruner *dpn);
 M0_INTERNAL void m0_dtm0_pruner_stop(struct m0_dtm0_pruner *dpn);
 
+/** Returns the pruner horizon of the persistent log. Takes the log lock. */
+M0_INTERNAL void m0_dtm0_pruner_horizon(struct m0_be_dtm0_log *log,
+					struct m0_dtm0_ts     *horizon);
+
+/**
+ * Removes from the head of the persistent log all the records that are
+ * persistent on all participants and older than the pruner horizon. Records
+ * are removed in batches of up to M0_DTM0_PRUNER_BULK_MAX records per
+ * transaction instead of one transaction per record, so that the log BE
+ * footprint stays bounded under high dtx rates. Blocks on transaction open
+ * and close.
+ *
+ * @param pruned Optional. Returns the number of records removed.
+ */
+M0_INTERNAL int m0_dtm0_pruner_prune_bulk(struct m0_be_dtm0_log *log,
+					  struct m0_sm_group    *grp,
+					  struct m0_be_domain   *bedom,
+					  uint64_t              *pruned);
 
 /** @} end of dtm0 group */
 #endif /* __MOTR___DTM0_PRUNER_H__ */
@@ -797,6 +797,13 @@ enum {
 	 * queue (with help of be-op-or-set). It shall be EOL-only queue.
 	 */
 	EOLQ_MAX_LEN = 100,
+
+	/*
+	 * Number of REDO messages a remote recovery FOM keeps in flight
+	 * towards its participant. The next log record is read while the
+	 * previous REDOs are being delivered and applied.
+	 */
+	REDO_WINDOW = 8,
 };
 
 struct recovery_fom {
@@ -844,6 +851,16 @@ struct recovery_fom {
 	 * with ::rf_last_known_ha_state unless we have HA epochs.
 	 */
 	bool                            rf_last_known_eol;
+
+	/**
+	 * Completion ops of REDO messages sent by ::dtm0_restore and
+	 * ::dtm0_evict. REDO number N uses rf_redo_ops[N % REDO_WINDOW].
+	 */
+	struct m0_be_op                 rf_redo_ops[REDO_WINDOW];
+	/** Number of REDO messages posted so far. */
+	uint64_t                        rf_redo_posted;
+	/** Number of posted REDO messages that have been completed. */
+	uint64_t                        rf_redo_acked;
 };
 
 enum eolq_item_type {
@@ -1188,7 +1205,9 @@ static const struct m0_fom_ops recovery_fom_ops = {
 };
 
 static struct m0_fom_type recovery_fom_type;
-static const struct m0_fom_type_ops recovery_fom_type_ops = {};
+static const struct m0_fom_type_ops recovery_fom_type_ops = {
+	.fto_prio = M0_FOM_PRIO_LOW
+};
 
 M0_INTERNAL int m0_drm_domain_init(void)
 {
@@ -1676,11 +1695,61 @@ static bool participated(const struct m0_dtm0_log_rec *record,
 				   svc));
 }
 
+static void redo_window_init(struct recovery_fom *rf)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(rf->rf_redo_ops); ++i) {
+		M0_SET0(&rf->rf_redo_ops[i]);
+		m0_be_op_init(&rf->rf_redo_ops[i]);
+	}
+	rf->rf_redo_posted = 0;
+	rf->rf_redo_acked = 0;
+}
+
+static void redo_window_fini(struct recovery_fom *rf)
+{
+	int i;
+
+	M0_PRE(rf->rf_redo_posted == rf->rf_redo_acked);
+	for (i = 0; i < ARRAY_SIZE(rf->rf_redo_ops); ++i)
+		m0_be_op_fini(&rf->rf_redo_ops[i]);
+}
+
+/** Returns the op for the next REDO message. */
+static struct m0_be_op *redo_window_op(struct recovery_fom *rf)
+{
+	M0_PRE(rf->rf_redo_posted - rf->rf_redo_acked < REDO_WINDOW);
+	return &rf->rf_redo_ops[rf->rf_redo_posted++ % REDO_WINDOW];
+}
+
+/**
+ * Waits until no more than "nr" REDO messages are in flight.
+ * REDOs are completed in the order they were posted.
+ */
+static void redo_window_shrink(struct m0_fom *fom, uint64_t nr)
+{
+	struct recovery_fom *rf = M0_AMB(rf, fom, rf_base);
+
+	M0_CO_REENTER(CO(fom));
+
+	while (rf->rf_redo_posted - rf->rf_redo_acked > nr) {
+		M0_CO_YIELD_RC(CO(fom), m0_be_op_tick_ret(
+			&rf->rf_redo_ops[rf->rf_redo_acked % REDO_WINDOW],
+			fom, RFS_WAITING));
+		m0_be_op_reset(
+			&rf->rf_redo_ops[rf->rf_redo_acked % REDO_WINDOW]);
+		rf->rf_redo_acked++;
+	}
+}
+
 /**
  * Restore missing transactions on remote participant.
  *
  * Implements part of recovery process.  Healthy ONLINE participant will iterate
  * through the local DTM log and send all needed REDOs to a remote peer.
+ * Up to REDO_WINDOW REDOs are in flight at once; the EOL message is sent only
+ * after all of them have been completed.
  */
 static void dtm0_restore(struct m0_fom        *fom,
 			 enum m0_ha_obj_state *out,
@@ -1693,7 +1762,6 @@ static void dtm0_restore(struct m0_fom        *fom,
 
 	M0_CO_REENTER(CO(fom),
 		      struct m0_fid       initiator;
-		      struct m0_be_op     reply_op;
 		      bool                next;
 		      struct m0_dtm0_tid  last_dtx_id;
 		      bool                last_dtx_met;
@@ -1735,8 +1803,7 @@ static void dtm0_restore(struct m0_fom        *fom,
 	/* XXX: race condition in the case where we are stopping the FOM. */
 	F(initiator) = recovery_fom_local(rf->rf_m)->rf_tgt_svc;
 
-	M0_SET0(&F(reply_op));
-	m0_be_op_init(&F(reply_op));
+	redo_window_init(rf);
 
 	/*
 	 * last_dtx_met and next seem to have very close meaning, but they are
@@ -1749,6 +1816,9 @@ static void dtm0_restore(struct m0_fom        *fom,
 	 * need both flags to define what to do.
 	 */
 	do {
+		/* Make room for the next REDO. */
+		M0_CO_FUN(CO(fom), redo_window_shrink(fom, REDO_WINDOW - 1));
+
 		if (F(last_dtx_met)) {
 			/*
 			 * Last iteration reached the RECOVERING mark in the
@@ -1792,6 +1862,13 @@ static void dtm0_restore(struct m0_fom        *fom,
 		 * current implementation, EOL flags should be sent on a
 		 * separate message, which must not have any payload.
 		 */
+		if (!F(next)) {
+			/*
+			 * EOL must not overtake REDOs in flight. The record
+			 * holds no data here, so that it is safe to yield.
+			 */
+			M0_CO_FUN(CO(fom), redo_window_shrink(fom, 0));
+		}
 		redo = (struct dtm0_req_fop) {
 			.dtr_msg       = DTM_REDO,
 			.dtr_initiator = F(initiator),
@@ -1812,19 +1889,17 @@ static void dtm0_restore(struct m0_fom        *fom,
 		 */
 		recovery_machine_redo_post(rf->rf_m, &rf->rf_base,
 					   &rf->rf_tgt_svc,
-					   &redo, &F(reply_op));
-
-		if (F(next))
-			m0_dtm0_log_iter_rec_fini(&record);
+					   &redo, redo_window_op(rf));
 
 		M0_LOG(M0_DEBUG, "out-redo: (m=%p) " REDO_F,
 		       rf->rf_m, REDO_P(&redo));
-		M0_CO_YIELD_RC(CO(fom), m0_be_op_tick_ret(&F(reply_op),
-							  fom, RFS_WAITING));
-		m0_be_op_reset(&F(reply_op));
+
+		if (F(next))
+			m0_dtm0_log_iter_rec_fini(&record);
 	} while (F(next));
 
-	m0_be_op_fini(&F(reply_op));
+	M0_CO_FUN(CO(fom), redo_window_shrink(fom, 0));
+	redo_window_fini(rf);
 
 	recovery_machine_log_iter_fini(rf->rf_m, &rf->rf_log_iter);
 	M0_SET0(&rf->rf_log_iter);
@@ -1856,7 +1931,6 @@ static void dtm0_evict(struct m0_fom *fom,
 	M0_CO_REENTER(CO(fom),
 		      struct dtm0_req_fop redo;
 		      struct m0_fid       initiator;
-		      struct m0_be_op     reply_op;
 		      bool                next;
 		      struct m0_dtm0_tid  last_dtx_id;
 		      bool                last_dtx_met;
@@ -1899,8 +1973,7 @@ static void dtm0_evict(struct m0_fom *fom,
 	/* XXX: race condition in the case where we are stopping the FOM. */
 	F(initiator) = recovery_fom_local(rf->rf_m)->rf_tgt_svc;
 
-	M0_SET0(&F(reply_op));
-	m0_be_op_init(&F(reply_op));
+	redo_window_init(rf);
 
 	/*
 	 * last_dtx_met and next seem to have very close meaning, but they are
@@ -1966,15 +2039,15 @@ static void dtm0_evict(struct m0_fom *fom,
 			       F(i), FID_P(&tx_pa->p_fid), tx_pa->p_state);
 			if (tx_pa->p_state == M0_DTPS_PERSISTENT)
 				continue;
+			M0_CO_FUN(CO(fom), redo_window_shrink(fom,
+							      REDO_WINDOW - 1));
+			/* tx_pa is not a frame variable. */
+			tx_pa = &F(record).dlr_txd.dtd_ps.dtp_pa[F(i)];
 			recovery_machine_redo_post(rf->rf_m, &rf->rf_base,
 						   &tx_pa->p_fid,
-						   &F(redo), &F(reply_op));
+						   &F(redo), redo_window_op(rf));
 			M0_LOG(M0_DEBUG, "out-redo: (m=%p) " REDO_F,
 			       rf->rf_m, REDO_P(&F(redo)));
-			M0_CO_YIELD_RC(CO(fom), m0_be_op_tick_ret(
-							&F(reply_op), fom,
-							RFS_WAITING));
-			m0_be_op_reset(&F(reply_op));
 		}
 
 		m0_dtm0_log_iter_rec_fini(&F(record));
@@ -1983,7 +2056,8 @@ static void dtm0_evict(struct m0_fom *fom,
 			break;
 	} while (true);
 
-	m0_be_op_fini(&F(reply_op));
+	M0_CO_FUN(CO(fom), redo_window_shrink(fom, 0));
+	redo_window_fini(rf);
 
 	recovery_machine_log_iter_fini(rf->rf_m, &rf->rf_log_iter);
 	M0_SET0(&rf->rf_log_iter);
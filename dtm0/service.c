@@ -98,7 +98,7 @@ static void dtm0_service__init(struct m0_dtm0_service *s)
 	m0_dtm0_service_bob_init(s);
 	dopr_tlist_init(&s->dos_processes);
 	m0_dtm0_dtx_domain_init();
-	m0_dtm0_clk_src_init(&s->dos_clk_src, M0_DTM0_CS_PHYS);
+	m0_dtm0_clk_src_init(&s->dos_clk_src, M0_DTM0_CS_HLC);
 }
 
 static void dtm0_service__fini(struct m0_dtm0_service *s)
@@ -495,6 +495,7 @@ M0_INTERNAL int dtm0_process_init(struct dtm0_process    *proc,
 	proc->dop_rep = m0_strdup(rem_proc_conf->pc_endpoint);
 
 	m0_long_lock_init(&proc->dop_llock);
+	m0_mutex_init(&proc->dop_pbatch_lock);
 
 	return M0_RC(0);
 }
@@ -504,6 +505,9 @@ M0_INTERNAL void dtm0_process_fini(struct dtm0_process *proc)
 	dopr_tlink_fini(proc);
 	m0_free(proc->dop_rep);
 	m0_long_lock_fini(&proc->dop_llock);
+	M0_ASSERT(!proc->dop_pbatch_armed);
+	m0_dtm0_pmsg_batch_fini(&proc->dop_pbatch);
+	m0_mutex_fini(&proc->dop_pbatch_lock);
 }
 
 M0_INTERNAL void dtm0_service_conns_term(struct m0_dtm0_service *service)
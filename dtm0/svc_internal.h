@@ -28,6 +28,8 @@
 /* import */
 #include "fop/fom_long_lock.h"       /* m0_long_lock */
 #include "rpc/link.h"                /* m0_rpc_link */
+#include "lib/mutex.h"               /* m0_mutex */
+#include "dtm0/fop.h"                /* dtm0_pmsg_batch */
 struct m0_dtm0_service;
 
 /* export */
@@ -69,6 +71,15 @@ struct dtm0_process {
 	 * See ::m0_dtm0_req_post.
 	 */
 	struct m0_long_lock     dop_llock;
+	/** Protects dop_pbatch and dop_pbatch_armed. */
+	struct m0_mutex         dop_pbatch_lock;
+	/**
+	 * PERSISTENT notices waiting to be sent to this process in one
+	 * message. See ::m0_dtm0_pmsg_post.
+	 */
+	struct dtm0_pmsg_batch  dop_pbatch;
+	/** True iff a drlink FOM is going to flush dop_pbatch. */
+	bool                    dop_pbatch_armed;
 };
 
 M0_INTERNAL int dtm0_process_init(struct dtm0_process    *proc,
@@ -27,6 +27,9 @@
 #include "lib/errno.h"  /* EINVAL */
 #include "lib/string.h" /* m0_asprintf, m0_streq */
 #include "lib/memory.h" /* m0_free */
+#include "lib/misc.h"   /* m0_array_sort */
+#include "lib/time.h"   /* m0_time_now */
+#include "ut/threads.h" /* M0_UT_THREADS_DEFINE */
 
 /* test if a timestamp can be converted into a string */
 static void ts_format(void)
@@ -95,7 +98,7 @@ static void now_min_max(void)
 }
 
 /* test if clock is always advancing forward */
-static void now_and_then(void)
+static void now_and_then_type(enum m0_dtm0_cs_types type)
 {
 	struct m0_dtm0_clk_src dcs;
 	struct m0_dtm0_ts      first;
@@ -103,7 +106,7 @@ static void now_and_then(void)
 	struct m0_dtm0_ts      third;
 	int                    rc;
 
-	m0_dtm0_clk_src_init(&dcs, M0_DTM0_CS_PHYS);
+	m0_dtm0_clk_src_init(&dcs, type);
 
 	m0_dtm0_clk_src_now(&dcs, &first);
 	m0_dtm0_clk_src_now(&dcs, &second);
@@ -119,6 +122,76 @@ static void now_and_then(void)
 	m0_dtm0_clk_src_fini(&dcs);
 }
 
+static void now_and_then(void)
+{
+	now_and_then_type(M0_DTM0_CS_PHYS);
+}
+
+static void hlc_now_and_then(void)
+{
+	now_and_then_type(M0_DTM0_CS_HLC);
+}
+
+enum {
+	HLC_UT_THREAD_NR = 8,
+	HLC_UT_TS_NR     = 0x1000,
+};
+
+struct hlc_ut_thread {
+	struct m0_dtm0_clk_src *hut_cs;
+	uint64_t               *hut_ts;
+};
+
+static void hlc_ut_thread(struct hlc_ut_thread *t)
+{
+	struct m0_dtm0_ts now;
+	m0_time_t         before;
+	int               i;
+
+	for (i = 0; i < HLC_UT_TS_NR; ++i) {
+		before = m0_time_now();
+		m0_dtm0_clk_src_now(t->hut_cs, &now);
+		/* Bounded by physical time from below. */
+		M0_UT_ASSERT(now.dts_phys >=
+			     (before & ~(M0_DTM0_CS_HLC_SLOT_NR - 1)));
+		t->hut_ts[i] = now.dts_phys;
+	}
+}
+
+M0_UT_THREADS_DEFINE(hlc_ut, &hlc_ut_thread);
+
+/* test that concurrent callers never get the same timestamp */
+static void hlc_threads(void)
+{
+	struct m0_dtm0_clk_src dcs;
+	struct hlc_ut_thread   threads[HLC_UT_THREAD_NR];
+	uint64_t              *ts;
+	int                    i;
+	int                    j;
+
+	M0_ALLOC_ARR(ts, HLC_UT_THREAD_NR * HLC_UT_TS_NR);
+	M0_UT_ASSERT(ts != NULL);
+	m0_dtm0_clk_src_init(&dcs, M0_DTM0_CS_HLC);
+	for (i = 0; i < HLC_UT_THREAD_NR; ++i)
+		threads[i] = (struct hlc_ut_thread) {
+			.hut_cs = &dcs,
+			.hut_ts = &ts[i * HLC_UT_TS_NR],
+		};
+	M0_UT_THREADS_START(hlc_ut, HLC_UT_THREAD_NR, threads);
+	M0_UT_THREADS_STOP(hlc_ut);
+	m0_dtm0_clk_src_fini(&dcs);
+
+	for (i = 0; i < HLC_UT_THREAD_NR; ++i) {
+		for (j = 1; j < HLC_UT_TS_NR; ++j)
+			M0_UT_ASSERT(threads[i].hut_ts[j - 1] <
+				     threads[i].hut_ts[j]);
+	}
+	m0_array_sort(ts, HLC_UT_THREAD_NR * HLC_UT_TS_NR);
+	for (i = 1; i < HLC_UT_THREAD_NR * HLC_UT_TS_NR; ++i)
+		M0_UT_ASSERT(ts[i - 1] < ts[i]);
+	m0_free(ts);
+}
+
 struct m0_ut_suite dtm0_clk_src_ut = {
 	.ts_name   = "dtm0-clk-src-ut",
 	.ts_init   = NULL,
@@ -129,6 +202,8 @@ struct m0_ut_suite dtm0_clk_src_ut = {
 		{ "phys-now",              get_now          },
 		{ "phys-now-min-max",      now_min_max      },
 		{ "phys-now-and-then",     now_and_then     },
+		{ "hlc-now-and-then",      hlc_now_and_then },
+		{ "hlc-threads",           hlc_threads      },
 		{ NULL, NULL }
 	}
 };
@@ -21,6 +21,7 @@
 
 #include "dtm0/clk_src.h"
 #include "dtm0/fop.h"
+#include "dtm0/fop_xc.h"
 #include "dtm0/helper.h"
 #include "dtm0/service.h"
 #include "dtm0/tx_desc.h"
@@ -104,6 +105,57 @@ static void cas_xcode_test(void)
 	m0_xcode_free_obj(&M0_XCODE_OBJ(m0_cas_op_xc, op_out));
 }
 
+static void pmsg_batch_xcode_test(void)
+{
+	enum { BATCH_NR = 3 };
+	struct dtm0_pmsg_batch  batch = {};
+	struct dtm0_pmsg_batch *out;
+	struct m0_dtm0_tx_pa    pa[2] = {
+		{ .p_fid = M0_FID_TINIT('s', 1, 1),
+		  .p_state = M0_DTPS_PERSISTENT },
+		{ .p_fid = M0_FID_TINIT('s', 1, 2),
+		  .p_state = M0_DTPS_EXECUTED },
+	};
+	struct m0_dtm0_tx_desc  txd = {
+		.dtd_id = { .dti_fid = M0_FID_TINIT('s', 1, 3) },
+		.dtd_ps = { .dtp_nr = ARRAY_SIZE(pa), .dtp_pa = pa },
+	};
+	void                   *buf;
+	m0_bcount_t             len;
+	int                     rc;
+	int                     i;
+
+	for (i = 0; i < BATCH_NR; ++i) {
+		txd.dtd_id.dti_ts.dts_phys = i + 1;
+		rc = m0_dtm0_pmsg_batch_add(&batch, &txd, BATCH_NR);
+		M0_UT_ASSERT(rc == 0);
+	}
+	M0_UT_ASSERT(batch.dpb_nr == BATCH_NR);
+
+	rc = m0_xcode_obj_enc_to_buf(&M0_XCODE_OBJ(dtm0_pmsg_batch_xc, &batch),
+				     &buf, &len);
+	M0_UT_ASSERT(rc == 0);
+	M0_ALLOC_PTR(out);
+	M0_UT_ASSERT(out != NULL);
+	rc = m0_xcode_obj_dec_from_buf(&M0_XCODE_OBJ(dtm0_pmsg_batch_xc, out),
+				       buf, len);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(out->dpb_nr == BATCH_NR);
+	for (i = 0; i < BATCH_NR; ++i) {
+		txd.dtd_id.dti_ts.dts_phys = i + 1;
+		M0_UT_ASSERT(memcmp(&out->dpb_txd[i].dtd_id, &txd.dtd_id,
+				    sizeof txd.dtd_id) == 0);
+		M0_UT_ASSERT(out->dpb_txd[i].dtd_ps.dtp_nr == ARRAY_SIZE(pa));
+		M0_UT_ASSERT(memcmp(out->dpb_txd[i].dtd_ps.dtp_pa, pa,
+				    sizeof pa) == 0);
+	}
+
+	m0_xcode_free_obj(&M0_XCODE_OBJ(dtm0_pmsg_batch_xc, out));
+	m0_free(buf);
+	m0_dtm0_pmsg_batch_fini(&batch);
+	M0_UT_ASSERT(batch.dpb_nr == 0 && batch.dpb_txd == NULL);
+}
+
 
 enum ut_sides {
 	UT_SIDE_SRV,
@@ -1458,6 +1510,7 @@ struct m0_ut_suite dtm0_ut = {
 	.ts_name = "dtm0-ut",
 	.ts_tests = {
 		{ "xcode",                    cas_xcode_test              },
+		{ "pmsg-batch-xcode",         pmsg_batch_xcode_test       },
 		{ "drlink-simple",           &m0_dtm0_ut_drlink_simple    },
 		{ "domain_init-fini",        &m0_dtm0_ut_domain_init_fini },
 		{ "remach-init-fini",         remach_init_fini            },
@@ -42,16 +42,26 @@ M0_INTERNAL void m0_fdmi_filter_init(struct m0_fdmi_filter    *flt)
 	M0_PRE(flt != NULL);
 
 	flt->ff_root = NULL;
+	flt->ff_prog = NULL;
 
 	M0_LEAVE();
 }
 
+static void filter_prog_free(struct m0_fdmi_filter *flt)
+{
+	if (flt->ff_prog != NULL) {
+		m0_free(flt->ff_prog->fp_insn);
+		m0_free0(&flt->ff_prog);
+	}
+}
+
 M0_INTERNAL void m0_fdmi_filter_root_set(struct m0_fdmi_filter    *flt,
 			                 struct m0_fdmi_flt_node  *root)
 {
 	M0_ENTRY();
 	M0_PRE(flt != NULL);
 	M0_PRE(root != NULL);
+	filter_prog_free(flt);
 	flt->ff_root = root;
 	M0_LEAVE();
 }
@@ -114,6 +124,7 @@ M0_INTERNAL void m0_fdmi_filter_fini(struct m0_fdmi_filter *flt)
 {
 	M0_ENTRY("flt=%p", flt);
 
+	filter_prog_free(flt);
 	if (flt->ff_root != NULL) {
 		free_flt_node(flt->ff_root);
 		flt->ff_root = NULL;
@@ -113,11 +113,18 @@ enum m0_fdmi_flt_op_code {
 	M0_FFO_TOTAL_OPS_CNT
 };
 
+struct m0_fdmi_flt_prog;
+
 /**
  * FDMI filter expression
  */
 struct m0_fdmi_filter {
 	struct m0_fdmi_flt_node    *ff_root; /**< Root of the expression tree */
+	/**
+	 * Expression compiled by the evaluator on the first evaluation,
+	 * @see m0_fdmi_eval_flt().
+	 */
+	struct m0_fdmi_flt_prog    *ff_prog;
 };
 
 /**
@@ -249,6 +256,43 @@ struct m0_fdmi_flt_node {
 M0_INTERNAL int m0_fdmi_flt_node_xc_type(const struct m0_xcode_obj   *par,
 					 const struct m0_xcode_type **out);
 
+/**
+ * Instruction of a compiled filter expression.
+ *
+ * Instructions are in postfix order of the tree: operands are pushed to the
+ * evaluation stack, an operation pops its operands and pushes the result.
+ */
+struct m0_fdmi_flt_insn {
+	/** Type of the tree node (@ref m0_fdmi_flt_node_type) */
+	uint32_t                     fi_type;
+	/** Operation code (@ref m0_fdmi_flt_op_code) */
+	uint32_t                     fi_op_code;
+	/** Number of operands of the operation */
+	int                          fi_opnds_nr;
+	/** Variable node, which value is retrieved on evaluation */
+	struct m0_fdmi_flt_var_node *fi_var;
+	/** Constant operand or the value of a folded constant subtree */
+	struct m0_fdmi_flt_operand   fi_opnd;
+};
+
+/**
+ * Compiled FDMI filter expression.
+ *
+ * A program is valid for the evaluator context and the set of its operation
+ * handlers it was compiled for, it is recompiled when they change.
+ */
+struct m0_fdmi_flt_prog {
+	/** Evaluator context the program is compiled for */
+	const void              *fp_ctx;
+	/** Generation of operation handlers of the context */
+	uint64_t                 fp_gen;
+	/** Number of instructions */
+	uint32_t                 fp_nr;
+	/** Maximal depth of the evaluation stack */
+	uint32_t                 fp_depth;
+	struct m0_fdmi_flt_insn *fp_insn;
+};
+
 /**
  * Prints filter node into string (@ref m0_xcode_print is used).
  *
@@ -25,6 +25,9 @@
 
 #include "lib/types.h"
 #include "lib/errno.h"
+#include "lib/memory.h"
+#include "lib/arith.h"          /* max32u */
+#include "lib/misc.h"           /* M0_SET0 */
 
 #include "fdmi/filter.h"
 #include "fdmi/flt_eval.h"
@@ -111,6 +114,7 @@ M0_INTERNAL int m0_fdmi_eval_add_op_cb(struct m0_fdmi_eval_ctx *ctx,
 		rc = -EEXIST;
 	} else {
 		ctx->opers[op] = cb;
+		ctx->opers_gen++;
 	}
 
 	return M0_RC(rc);
@@ -123,6 +127,7 @@ M0_INTERNAL void m0_fdmi_eval_del_op_cb(struct m0_fdmi_eval_ctx *ctx,
 	M0_PRE(op < M0_FFO_TOTAL_OPS_CNT);
 
 	ctx->opers[op] = NULL;
+	ctx->opers_gen++;
 
 	M0_LEAVE();
 }
@@ -131,6 +136,7 @@ M0_INTERNAL void m0_fdmi_eval_init(struct m0_fdmi_eval_ctx *ctx)
 {
 	M0_ENTRY("ctx=%p", ctx);
 	M0_SET_ARR0(ctx->opers);
+	ctx->opers_gen = 0;
 	init_std_operation_handlers(ctx->opers);
 	M0_LEAVE();
 }
@@ -181,16 +187,216 @@ static int eval_flt_node(struct m0_fdmi_eval_ctx    *ctx,
 	return M0_RC(rc);
 }
 
+enum {
+	/** Depth of the evaluation stack of compiled filters */
+	FLT_PROG_STACK_NR = 16
+};
+
+/** Counts nodes of the tree, checking that operations fit the evaluator. */
+static int prog_node_nr(struct m0_fdmi_flt_node *node, uint32_t *nr)
+{
+	struct m0_fdmi_flt_op_node *on = &node->ffn_u.ffn_oper;
+	int                         rc = 0;
+	int                         i;
+
+	++*nr;
+	if (node->ffn_type != M0_FLT_OPERATION_NODE)
+		return 0;
+	if (on->ffon_op_code >= M0_FFO_TOTAL_OPS_CNT ||
+	    on->ffon_opnds.fno_cnt > FDMI_FLT_MAX_OPNDS_NR)
+		return M0_ERR(-EINVAL);
+	for (i = 0; i < on->ffon_opnds.fno_cnt && rc == 0; i++)
+		rc = prog_node_nr(on->ffon_opnds.fno_opnds[i].ffnp_ptr, nr);
+	return rc;
+}
+
+/**
+ * Appends instructions evaluating the subtree to the program. @depth is the
+ * depth of the evaluation stack before the subtree result is pushed.
+ */
+static int prog_emit(struct m0_fdmi_eval_ctx *ctx,
+		     struct m0_fdmi_flt_prog *prog,
+		     struct m0_fdmi_flt_node *node,
+		     uint32_t                 depth)
+{
+	struct m0_fdmi_flt_op_node *on = &node->ffn_u.ffn_oper;
+	struct m0_fdmi_flt_operands operands = {0};
+	struct m0_fdmi_flt_operand  res;
+	struct m0_fdmi_flt_insn    *insn;
+	uint32_t                    start = prog->fp_nr;
+	uint32_t                    child;
+	bool                        constant = true;
+	int                         rc;
+	int                         i;
+
+	if (depth + 1 > FLT_PROG_STACK_NR)
+		return M0_ERR(-E2BIG);
+	prog->fp_depth = max32u(prog->fp_depth, depth + 1);
+
+	switch (node->ffn_type) {
+	case M0_FLT_OPERATION_NODE:
+		for (i = 0; i < on->ffon_opnds.fno_cnt; i++) {
+			child = prog->fp_nr;
+			rc = prog_emit(ctx, prog,
+				       on->ffon_opnds.fno_opnds[i].ffnp_ptr,
+				       depth + i);
+			if (rc != 0)
+				return M0_ERR(rc);
+			constant &= prog->fp_nr == child + 1 &&
+			    prog->fp_insn[child].fi_type == M0_FLT_OPERAND_NODE;
+		}
+		/* Fold operations on constants, operations are pure. */
+		if (constant) {
+			for (i = 0; i < on->ffon_opnds.fno_cnt; i++)
+				operands.ffp_operands[operands.ffp_count++] =
+					prog->fp_insn[start + i].fi_opnd;
+			if (ctx->opers[on->ffon_op_code](&operands,
+							 &res) == 0) {
+				prog->fp_nr = start;
+				insn = &prog->fp_insn[prog->fp_nr++];
+				*insn = (struct m0_fdmi_flt_insn) {
+					.fi_type = M0_FLT_OPERAND_NODE,
+					.fi_opnd = res
+				};
+				break;
+			}
+		}
+		insn = &prog->fp_insn[prog->fp_nr++];
+		*insn = (struct m0_fdmi_flt_insn) {
+			.fi_type     = M0_FLT_OPERATION_NODE,
+			.fi_op_code  = on->ffon_op_code,
+			.fi_opnds_nr = on->ffon_opnds.fno_cnt
+		};
+		break;
+	case M0_FLT_OPERAND_NODE:
+		insn = &prog->fp_insn[prog->fp_nr++];
+		*insn = (struct m0_fdmi_flt_insn) {
+			.fi_type = M0_FLT_OPERAND_NODE,
+			.fi_opnd = node->ffn_u.ffn_operand
+		};
+		break;
+	case M0_FLT_VARIABLE_NODE:
+		insn = &prog->fp_insn[prog->fp_nr++];
+		*insn = (struct m0_fdmi_flt_insn) {
+			.fi_type = M0_FLT_VARIABLE_NODE,
+			.fi_var  = &node->ffn_u.ffn_var
+		};
+		break;
+	default:
+		M0_ASSERT(false);
+	}
+	return 0;
+}
+
+/**
+ * Returns the program of the filter compiled for the context, compiling it
+ * if needed. A filter too deep to be compiled is remembered as such, with an
+ * empty program.
+ */
+static int prog_get(struct m0_fdmi_eval_ctx  *ctx,
+		    struct m0_fdmi_filter    *flt,
+		    struct m0_fdmi_flt_prog **out)
+{
+	struct m0_fdmi_flt_prog *prog = flt->ff_prog;
+	uint32_t                 nr = 0;
+	int                      rc;
+
+	if (prog != NULL && prog->fp_ctx == ctx &&
+	    prog->fp_gen == ctx->opers_gen) {
+		*out = prog;
+		return prog->fp_insn != NULL ? 0 : -E2BIG;
+	}
+	rc = prog_node_nr(flt->ff_root, &nr);
+	if (rc != 0)
+		return M0_ERR(rc);
+	if (prog == NULL) {
+		M0_ALLOC_PTR(prog);
+		if (prog == NULL)
+			return M0_ERR(-ENOMEM);
+		flt->ff_prog = prog;
+	}
+	m0_free(prog->fp_insn);
+	M0_SET0(prog);
+	M0_ALLOC_ARR(prog->fp_insn, nr);
+	if (prog->fp_insn == NULL)
+		return M0_ERR(-ENOMEM);
+	rc = prog_emit(ctx, prog, flt->ff_root, 0);
+	M0_ASSERT(prog->fp_nr <= nr);
+	if (rc != 0)
+		m0_free0(&prog->fp_insn);
+	if (M0_IN(rc, (0, -E2BIG))) {
+		prog->fp_ctx = ctx;
+		prog->fp_gen = ctx->opers_gen;
+	}
+	*out = prog;
+	return M0_RC(rc);
+}
+
+static int prog_eval(struct m0_fdmi_eval_ctx      *ctx,
+		     struct m0_fdmi_flt_prog      *prog,
+		     struct m0_fdmi_flt_operand   *res,
+		     struct m0_fdmi_eval_var_info *var_info)
+{
+	struct m0_fdmi_flt_operand  stack[FLT_PROG_STACK_NR];
+	struct m0_fdmi_flt_operands operands;
+	struct m0_fdmi_flt_insn    *insn;
+	uint32_t                    top = 0;
+	uint32_t                    i;
+	int                         j;
+	int                         rc = 0;
+
+	M0_PRE(prog->fp_depth <= ARRAY_SIZE(stack));
+
+	for (i = 0; i < prog->fp_nr && rc == 0; i++) {
+		insn = &prog->fp_insn[i];
+		switch (insn->fi_type) {
+		case M0_FLT_OPERATION_NODE:
+			M0_ASSERT(top >= insn->fi_opnds_nr);
+			top -= insn->fi_opnds_nr;
+			operands.ffp_count = insn->fi_opnds_nr;
+			for (j = 0; j < insn->fi_opnds_nr; j++)
+				operands.ffp_operands[j] = stack[top + j];
+			rc = ctx->opers[insn->fi_op_code](&operands,
+							  &stack[top++]);
+			break;
+		case M0_FLT_OPERAND_NODE:
+			stack[top++] = insn->fi_opnd;
+			break;
+		case M0_FLT_VARIABLE_NODE:
+			if (var_info->get_value_cb != NULL)
+				rc = var_info->get_value_cb(var_info->user_data,
+							    insn->fi_var,
+							    &stack[top++]);
+			else
+				rc = -EINVAL;
+			break;
+		default:
+			M0_IMPOSSIBLE("Wrong instruction type.");
+		}
+	}
+	if (rc == 0) {
+		M0_ASSERT(top == 1);
+		*res = stack[0];
+	}
+	return M0_RC(rc);
+}
+
 M0_INTERNAL int m0_fdmi_eval_flt(struct m0_fdmi_eval_ctx      *ctx,
                                  struct m0_conf_fdmi_filter   *filter,
                                  struct m0_fdmi_eval_var_info *var_info)
 {
 	int                        rc;
 	struct m0_fdmi_flt_operand res;
+	struct m0_fdmi_flt_prog   *prog;
 
 	M0_ENTRY();
 
-	rc = eval_flt_node(ctx, filter->ff_filter.ff_root, &res, var_info);
+	rc = prog_get(ctx, &filter->ff_filter, &prog);
+	if (rc == 0)
+		rc = prog_eval(ctx, prog, &res, var_info);
+	else if (M0_IN(rc, (-E2BIG, -ENOMEM)))
+		rc = eval_flt_node(ctx, filter->ff_filter.ff_root, &res,
+				   var_info);
 
 	if (rc == 0) {
 		M0_ASSERT(res.ffo_type == M0_FF_OPND_BOOL);
@@ -60,6 +60,9 @@ struct m0_fdmi_eval_ctx {
 	/** Array of operation handlers. Index is code of
 	  * operation from @ref m0_fdmi_flt_op_code */
 	m0_fdmi_flt_op_cb_t  opers[M0_FFO_TOTAL_OPS_CNT];
+	/** Incremented when operation handlers change, compiled filters
+	  * are recompiled then. */
+	uint64_t             opers_gen;
 };
 
 /**
@@ -111,6 +114,12 @@ M0_INTERNAL void m0_fdmi_eval_del_op_cb(struct m0_fdmi_eval_ctx *ctx,
  *
  * Result of filter expression is always boolean.
  *
+ * The tree is compiled on the first evaluation into a flat program
+ * (m0_fdmi_filter::ff_prog), with subtrees not depending on variable nodes
+ * folded into constants. Later evaluations run the program, without tree
+ * traversal. Trees too deep for the evaluation stack are interpreted.
+ * Evaluations of the same filter should not run concurrently.
+ *
  * @param filter   FDMI filter
  * @param ctx      FDMI filter evaluator context
  * @param var_info Information about how to get value of variable nodes
@@ -23,6 +23,7 @@
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_FDMI
 #include "lib/trace.h"
 #include "lib/memory.h"
+#include "lib/arith.h"          /* min64u */
 #include "lib/finject.h" /* M0_FI_ENABLED */
 #include "lib/string.h"         /* strlen */
 
@@ -35,6 +36,8 @@
 #include "fop/fop.h"            /* m0_fop_fol_frag */
 #include "rpc/rpc_opcodes.h"    /* M0_CAS_PUT_FOP_OPCODE */
 #include "cas/cas.h"            /* m0_cas_op */
+#include "be/alloc.h"           /* M0_BE_ALLOC_PTR_SYNC */
+#include "be/seg_dict.h"        /* m0_be_seg_dict_lookup */
 
 
 /**
@@ -200,6 +203,15 @@
  *     during BE recovery and record them to DIX in FDMI plugin and now we have
  *     to do several major changes to Motr components archivecture already.
  *
+ * @subsection Consumption offset
+ *
+ * The FOL source keeps the lsn below which every posted record is released by
+ * all plugins (m0_fol_fdmi_src_offset()). The source dock timer FOM persists
+ * it in BE segment (struct m0_fol_fdmi_offset), and it is loaded when the
+ * source dock starts. Records of recovered transactions below the offset are
+ * not posted again, so that plugins do not get records they have consumed
+ * before the restart.
+ *
  * @{
  */
 
@@ -421,7 +433,6 @@ static int ffs_op_encode(struct m0_fdmi_src_rec *src_rec,
 {
 	struct m0_dtx      *dtx;
 	struct m0_fol_rec  *fol_rec;
-	struct m0_buf       local_buf = {};
 	int                 rc;
 
 	M0_ASSERT(buf != NULL);
@@ -435,46 +446,26 @@ static int ffs_op_encode(struct m0_fdmi_src_rec *src_rec,
 
 	fol_rec = &dtx->tx_fol_rec;
 
-	/**
-	 * @todo Q: (for FOL owners) FOL record does not provide API call to
-	 * calculate record size when encoded.  For now, I'll do double
-	 * allocation.  Alloc internal buf of max size, then encode, then
-	 * alloc with correct size, then copy, then dealloc inernal buf.  Can
-	 * be done properly once FOL record owner exports needed api call.
-	 */
-	rc = m0_buf_alloc(&local_buf, FOL_REC_MAXSIZE);
+	/* The record is encoded directly into a buffer of its size. */
+	rc = m0_buf_alloc(buf, m0_fol_rec_encoded_size(fol_rec));
 	if (rc != 0) {
-		return M0_ERR_INFO(rc, "Failed to allocate internal buffer "
-				   "for encoded FOL FDMI record.");
+		return M0_ERR_INFO(rc, "Failed to allocate encoded "
+				   "FOL FDMI record.");
 	}
 
-	rc = m0_fol_rec_encode(fol_rec, &local_buf);
-	if (rc != 0) {
+	rc = m0_fol_rec_encode(fol_rec, buf);
+	if (rc != 0)
 		M0_LOG(M0_ERROR,
 		       "Failed to encoded FOL FDMI record.");
-		goto done;
-	}
-
-	rc = m0_buf_alloc(buf, fol_rec->fr_header.rh_data_len);
-	if (rc != 0) {
-		M0_LOG(M0_ERROR,
-		       "Failed to allocate encoded FOL FDMI record.");
-		goto done;
-	}
-	memcpy(buf->b_addr, local_buf.b_addr, buf->b_nob);
+	else
+		buf->b_nob = fol_rec->fr_header.rh_data_len;
 
 	if (M0_FI_ENABLED("fail_in_final"))
 		rc = -EINVAL;
 
-done:
-	/* Finalization */
-	if (local_buf.b_addr != NULL)
-		m0_buf_free(&local_buf);
 	/* On-Error cleanup. */
-	if (rc < 0) {
-		if (buf->b_addr != NULL)
-			m0_buf_free(buf);
-	}
+	if (rc < 0)
+		m0_buf_free(buf);
 
 	return M0_RC(rc);
 }
@@ -565,6 +556,9 @@ M0_INTERNAL int m0_fol_fdmi_src_init(void)
 
 	ffs_tx_tlist_init(&m->fdm_s.fdms_ffs_locked_tx_list);
 	m0_mutex_init(&m->fdm_s.fdms_ffs_locked_tx_lock);
+	m->fdm_s.fdms_ffs_ctx.ffsc_lsn_posted = 0;
+	m->fdm_s.fdms_ffs_ctx.ffsc_lsn_loaded = 0;
+	m->fdm_s.fdms_ffs_ctx.ffsc_offset     = NULL;
 
 	m->fdm_s.fdms_ffs_ctx.ffsc_src->fs_node_eval  = ffs_op_node_eval;
 	m->fdm_s.fdms_ffs_ctx.ffsc_src->fs_get        = ffs_op_get;
@@ -639,10 +633,99 @@ M0_INTERNAL int m0_fol_fdmi_src_deinit(void)
 	return M0_RC(rc);
 }
 
+/* ------------------------------------------------------------------
+ * Persistent offset
+ * ------------------------------------------------------------------ */
+
+static const char ffs_offset_key[] = "fdmi_fol_offset";
+
+M0_INTERNAL uint64_t m0_fol_fdmi_src_offset(void)
+{
+	struct m0_fdmi_module_source *s = &m0_fdmi_module__get()->fdm_s;
+	struct m0_be_tx              *be_tx;
+	uint64_t                      lsn;
+
+	m0_mutex_lock(&s->fdms_ffs_locked_tx_lock);
+	lsn = s->fdms_ffs_ctx.ffsc_lsn_posted;
+	m0_tl_for(ffs_tx, &s->fdms_ffs_locked_tx_list, be_tx) {
+		lsn = min64u(lsn, be_tx->t_lsn);
+	} m0_tl_endfor;
+	lsn = max64u(lsn, s->fdms_ffs_ctx.ffsc_lsn_loaded);
+	m0_mutex_unlock(&s->fdms_ffs_locked_tx_lock);
+	return lsn;
+}
+
+M0_INTERNAL void m0_fol_fdmi_src_offset_load(struct m0_be_seg *seg)
+{
+	struct m0_fdmi_module      *m = m0_fdmi_module__get();
+	struct m0_fol_fdmi_src_ctx *ctx = &m->fdm_s.fdms_ffs_ctx;
+	struct m0_fol_fdmi_offset  *offset;
+	int                         rc;
+
+	rc = m0_be_seg_dict_lookup(seg, ffs_offset_key, (void **)&offset);
+	if (rc != 0)
+		return;
+	M0_ASSERT(offset->ffo_magic == M0_FOL_FDMI_OFFSET_MAGIC);
+	m0_mutex_lock(&m->fdm_s.fdms_ffs_locked_tx_lock);
+	ctx->ffsc_offset     = offset;
+	ctx->ffsc_lsn_loaded = offset->ffo_lsn;
+	ctx->ffsc_lsn_posted = max64u(ctx->ffsc_lsn_posted, offset->ffo_lsn);
+	m0_mutex_unlock(&m->fdm_s.fdms_ffs_locked_tx_lock);
+	M0_LOG(M0_INFO, "FOL FDMI records consumed up to lsn %"PRIu64,
+	       offset->ffo_lsn);
+}
+
+M0_INTERNAL void m0_fol_fdmi_src_offset_credit(struct m0_be_seg       *seg,
+                                               struct m0_be_tx_credit *accum)
+{
+	struct m0_fol_fdmi_src_ctx *ctx = &m0_fdmi_module__get()->fdm_s.
+					  fdms_ffs_ctx;
+
+	if (ctx->ffsc_offset == NULL) {
+		M0_BE_ALLOC_CREDIT_PTR(ctx->ffsc_offset, seg, accum);
+		m0_be_seg_dict_insert_credit(seg, ffs_offset_key, accum);
+	}
+	m0_be_tx_credit_add(accum, &M0_BE_TX_CREDIT_PTR(ctx->ffsc_offset));
+}
+
+M0_INTERNAL int m0_fol_fdmi_src_offset_store(struct m0_be_seg *seg,
+                                             struct m0_be_tx  *tx,
+                                             uint64_t          lsn)
+{
+	struct m0_fol_fdmi_src_ctx *ctx = &m0_fdmi_module__get()->fdm_s.
+					  fdms_ffs_ctx;
+	struct m0_fol_fdmi_offset  *offset = ctx->ffsc_offset;
+	int                         rc;
+
+	M0_ENTRY("lsn=%"PRIu64, lsn);
+	if (offset == NULL) {
+		M0_BE_ALLOC_PTR_SYNC(offset, seg, tx);
+		if (offset == NULL)
+			return M0_ERR(-ENOMEM);
+		rc = m0_be_seg_dict_insert(seg, tx, ffs_offset_key, offset);
+		if (rc != 0) {
+			M0_BE_FREE_PTR_SYNC(offset, seg, tx);
+			return M0_ERR(rc);
+		}
+		offset->ffo_magic = M0_FOL_FDMI_OFFSET_MAGIC;
+		ctx->ffsc_offset = offset;
+	}
+	offset->ffo_lsn = lsn;
+	M0_BE_TX_CAPTURE_PTR(seg, tx, offset);
+	return M0_RC(0);
+}
+
 /* ------------------------------------------------------------------
  * Entry point for FOM to start FDMI processing
  * ------------------------------------------------------------------ */
 
+M0_INTERNAL bool m0_fol_fdmi_is_needed(void)
+{
+	struct m0_fdmi_src_dock *src_dock = m0_fdmi_src_dock_get();
+
+	return src_dock->fsdc_started && src_dock->fsdc_filters_defined;
+}
+
 M0_INTERNAL void m0_fol_fdmi_post_record(struct m0_fom *fom)
 {
 	struct m0_fdmi_src_dock *src_dock = m0_fdmi_src_dock_get();
@@ -685,12 +768,24 @@ M0_INTERNAL void m0_fol_fdmi_post_record(struct m0_fom *fom)
 
 	m0_be_tx_lsn_get(be_tx, &dtx->tx_fol_rec.fr_header.rh_lsn,
 	                 &dtx->tx_fol_rec.fr_header.rh_lsn_discarded);
+	if (dtx->tx_fol_rec.fr_header.rh_lsn <
+	    m->fdm_s.fdms_ffs_ctx.ffsc_lsn_loaded) {
+		/* Consumed by all plugins before the restart. */
+		M0_LOG(M0_DEBUG, "skip consumed lsn %"PRIu64,
+		       dtx->tx_fol_rec.fr_header.rh_lsn);
+		return;
+	}
 	dtx->tx_fol_rec.fr_fdmi_rec.fsr_src  = m->fdm_s.fdms_ffs_ctx.ffsc_src;
 	dtx->tx_fol_rec.fr_fdmi_rec.fsr_dryrun = false;
 	dtx->tx_fol_rec.fr_fdmi_rec.fsr_data = NULL;
 
 	/* Post record. */
 	M0_FDMI_SOURCE_POST_RECORD(&dtx->tx_fol_rec.fr_fdmi_rec);
+	m0_mutex_lock(&m->fdm_s.fdms_ffs_locked_tx_lock);
+	m->fdm_s.fdms_ffs_ctx.ffsc_lsn_posted =
+		max64u(m->fdm_s.fdms_ffs_ctx.ffsc_lsn_posted,
+		       dtx->tx_fol_rec.fr_header.rh_lsn + 1);
+	m0_mutex_unlock(&m->fdm_s.fdms_ffs_locked_tx_lock);
 	M0_LOG(M0_DEBUG, "M0_FDMI_SOURCE_POST_RECORD fr_fdmi_rec=%p "
 	       "fsr_rec_id="U128X_F, &dtx->tx_fol_rec.fr_fdmi_rec,
 	       U128_P(&dtx->tx_fol_rec.fr_fdmi_rec.fsr_rec_id));
@@ -734,13 +829,37 @@ m0_fol_fdmi__filter_kv_substring_match(struct m0_buf  *value,
 	return true;
 }
 
+/** Returns CAS PUT or DEL operation of the fragment, NULL if it has none. */
+static struct m0_cas_op *ffs_frag_kv_op(struct m0_fol_frag *fol_frag)
+{
+	struct m0_fop_fol_frag *fop_fol_frag;
+
+	if (fol_frag->rp_ops->rpo_type != &m0_fop_fol_frag_type)
+		return NULL;
+	fop_fol_frag = fol_frag->rp_data;
+	if (fop_fol_frag->ffrp_fop_code != M0_CAS_PUT_FOP_OPCODE &&
+	    fop_fol_frag->ffrp_fop_code != M0_CAS_DEL_FOP_OPCODE)
+		return NULL;
+	M0_ASSERT(fop_fol_frag->ffrp_fop != NULL);
+	return fop_fol_frag->ffrp_fop;
+}
+
+M0_INTERNAL bool
+m0_fol_fdmi_filter_kv_substring_rec(struct m0_fdmi_src_rec *src_rec)
+{
+	struct m0_fol_rec *fol_rec;
+
+	fol_rec = container_of(src_rec, struct m0_fol_rec, fr_fdmi_rec);
+	return m0_tl_exists(m0_rec_frag, frag, &fol_rec->fr_frags,
+			    ffs_frag_kv_op(frag) != NULL);
+}
+
 M0_INTERNAL int
 m0_fol_fdmi_filter_kv_substring(struct m0_fdmi_eval_ctx      *ctx,
                                 struct m0_conf_fdmi_filter   *filter,
                                 struct m0_fdmi_eval_var_info *var_info)
 {
 	struct m0_fdmi_src_rec *src_rec = var_info->user_data;
-	struct m0_fop_fol_frag *fop_fol_frag;
 	struct m0_fol_frag     *fol_frag;
 	struct m0_fol_rec      *fol_rec;
 	struct m0_cas_rec      *cas_rec;
@@ -749,14 +868,9 @@ m0_fol_fdmi_filter_kv_substring(struct m0_fdmi_eval_ctx      *ctx,
 
 	fol_rec = container_of(src_rec, struct m0_fol_rec, fr_fdmi_rec);
 	m0_tl_for(m0_rec_frag, &fol_rec->fr_frags, fol_frag) {
-		if (fol_frag->rp_ops->rpo_type != &m0_fop_fol_frag_type)
-			continue;
-		fop_fol_frag = fol_frag->rp_data;
-		if (fop_fol_frag->ffrp_fop_code != M0_CAS_PUT_FOP_OPCODE &&
-		    fop_fol_frag->ffrp_fop_code != M0_CAS_DEL_FOP_OPCODE)
+		cas_op = ffs_frag_kv_op(fol_frag);
+		if (cas_op == NULL)
 			continue;
-		cas_op = fop_fol_frag->ffrp_fop;
-		M0_ASSERT(cas_op != NULL);
 		for (i = 0; i < cas_op->cg_rec.cr_nr; ++i) {
 			cas_rec = &cas_op->cg_rec.cr_rec[i];
 			if (m0_fol_fdmi__filter_kv_substring_match(
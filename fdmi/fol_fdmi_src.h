@@ -32,6 +32,9 @@ struct m0_fom;
 struct m0_conf_fdmi_filter;
 struct m0_fdmi_eval_ctx;
 struct m0_fdmi_eval_var_info;
+struct m0_be_seg;
+struct m0_be_tx;
+struct m0_be_tx_credit;
 
 /**
  * @defgroup fdmi_fol_src FDMI FOL source
@@ -50,6 +53,20 @@ struct ffs_fol_frag_handler {
 
 };
 
+/**
+ * Persistent consumption offset of the FOL source, allocated in the BE segment
+ * and found through the segment dictionary.
+ */
+struct m0_fol_fdmi_offset {
+	/** Holds M0_FOL_FDMI_OFFSET_MAGIC. */
+	uint64_t ffo_magic;
+	/**
+	 * Every FDMI FOL record with m0_fol_rec_header::rh_lsn less than this
+	 * lsn has been released by all plugins.
+	 */
+	uint64_t ffo_lsn;
+};
+
 /** FOL source internal context. */
 struct m0_fol_fdmi_src_ctx {
 	/** Holds M0_FOL_FDMI_SRC_CTX_MAGIC. */
@@ -65,6 +82,16 @@ struct m0_fol_fdmi_src_ctx {
 
 	/** Count of handlers in ffsc_frag_handler_vector. */
 	uint32_t                        ffsc_handler_number;
+
+	/**
+	 * Lsn following the largest one of the posted records. Protected by
+	 * m0_fdmi_module_source::fdms_ffs_locked_tx_lock.
+	 */
+	uint64_t                        ffsc_lsn_posted;
+	/** Offset stored by the previous run, 0 if none. */
+	uint64_t                        ffsc_lsn_loaded;
+	/** Persistent offset, NULL until loaded or created. */
+	struct m0_fol_fdmi_offset      *ffsc_offset;
 };
 
 /**
@@ -85,15 +112,49 @@ M0_INTERNAL void m0_fol_fdmi_src_fini(void);
  */
 M0_INTERNAL int m0_fol_fdmi_src_deinit(void);
 
+/**
+ * Returns true iff FOL records are delivered to FDMI plugins: the source dock
+ * is running and there are filters defined.
+ */
+M0_INTERNAL bool m0_fol_fdmi_is_needed(void);
+
 /** Submit new FOL entry to FDMI. */
 M0_INTERNAL void m0_fol_fdmi_post_record(struct m0_fom *fom);
 
+/**
+ * Returns the consumption offset of the FOL source: every posted record with
+ * a smaller lsn has been released by all plugins.
+ */
+M0_INTERNAL uint64_t m0_fol_fdmi_src_offset(void);
+
+/**
+ * Loads the offset persisted in the segment by a previous run. Records with a
+ * smaller lsn are not posted again, e.g. when they are reposted for the
+ * transactions recovered from BE log.
+ */
+M0_INTERNAL void m0_fol_fdmi_src_offset_load(struct m0_be_seg *seg);
+
+/** Credit of m0_fol_fdmi_src_offset_store(). */
+M0_INTERNAL void m0_fol_fdmi_src_offset_credit(struct m0_be_seg       *seg,
+                                               struct m0_be_tx_credit *accum);
+
+/** Persists the offset in the segment, allocating it on first use. */
+M0_INTERNAL int m0_fol_fdmi_src_offset_store(struct m0_be_seg *seg,
+                                             struct m0_be_tx  *tx,
+                                             uint64_t          lsn);
+
 /** Implements M0_FDMI_FILTER_TYPE_KV_SUBSTRING filter. */
 M0_INTERNAL int
 m0_fol_fdmi_filter_kv_substring(struct m0_fdmi_eval_ctx      *ctx,
                                 struct m0_conf_fdmi_filter   *filter,
                                 struct m0_fdmi_eval_var_info *var_info);
 
+/**
+ * Returns false iff the FOL record has no CAS PUT or DEL operations, so that
+ * no M0_FDMI_FILTER_TYPE_KV_SUBSTRING filter can match it.
+ */
+M0_INTERNAL bool
+m0_fol_fdmi_filter_kv_substring_rec(struct m0_fdmi_src_rec *src_rec);
 
 /** Internal function used to match the strings. Exported for UTs. */
 M0_INTERNAL bool
@@ -48,6 +48,9 @@ struct m0_fop_type m0_fop_fdmi_rec_not_fopt;
 struct m0_fop_type m0_fop_fdmi_rec_not_rep_fopt;
 struct m0_fop_type m0_fop_fdmi_rec_release_fopt;
 struct m0_fop_type m0_fop_fdmi_rec_release_rep_fopt;
+struct m0_fop_type m0_fop_fdmi_rec_batch_fopt;
+struct m0_fop_type m0_fop_fdmi_rec_batch_rep_fopt;
+struct m0_fop_type m0_fop_fdmi_rec_release_batch_fopt;
 
 extern const struct m0_fom_ops      fdmi_rr_fom_ops;
 extern const struct m0_fom_type_ops fdmi_rr_fom_type_ops;
@@ -83,6 +86,31 @@ M0_INTERNAL int m0_fdms_fopts_init(void)
 #endif
 			);
 
+	M0_FOP_TYPE_INIT(&m0_fop_fdmi_rec_batch_fopt,
+			 .name      = "FDMI record batch notification",
+			 .opcode    = M0_FDMI_RECORD_BATCH_OPCODE,
+			 .xt        = m0_fop_fdmi_rec_batch_xc,
+			 .rpc_flags = M0_RPC_ITEM_TYPE_REQUEST,
+#ifndef __KERNEL__
+			 .fom_ops   = m0_fdmi__pdock_fom_type_ops_get(),
+			 .svc_type  = &m0_fdmi_service_type,
+			 .sm        = &fdmi_plugin_dock_fom_sm_conf,
+#endif
+			 .fop_ops   = &m0_fdmi_fop_ops);
+
+	M0_FOP_TYPE_INIT(&m0_fop_fdmi_rec_release_batch_fopt,
+			 .name      = "FDMI record release batch",
+			 .opcode    = M0_FDMI_RECORD_RELEASE_BATCH_OPCODE,
+			 .xt        = m0_fop_fdmi_rec_release_batch_xc,
+			 .rpc_flags = M0_RPC_ITEM_TYPE_REQUEST,
+			 .fop_ops   = &m0_fdmi_fop_ops,
+#ifndef __KERNEL__
+			 .fom_ops   = &fdmi_rr_fom_type_ops,
+			 .svc_type  = &m0_fdmi_service_type,
+			 .sm        = &fdmi_rr_fom_sm_conf
+#endif
+			);
+
 
 	return 0;
 }
@@ -102,6 +130,12 @@ M0_INTERNAL int m0_fdms_rep_fopts_init(void)
 			 .rpc_flags = M0_RPC_ITEM_TYPE_REPLY,
 			 .sm        = &m0_generic_conf);
 
+	M0_FOP_TYPE_INIT(&m0_fop_fdmi_rec_batch_rep_fopt,
+			 .name      = "FDMI record batch notification reply",
+			 .opcode    = M0_FDMI_RECORD_BATCH_REP_OPCODE,
+			 .xt        = m0_fop_fdmi_rec_batch_reply_xc,
+			 .rpc_flags = M0_RPC_ITEM_TYPE_REPLY);
+
 	return 0;
 }
 
@@ -121,9 +155,12 @@ M0_INTERNAL void m0_fdms_fop_fini(void)
 {
         m0_fop_type_fini(&m0_fop_fdmi_rec_not_fopt);
         m0_fop_type_fini(&m0_fop_fdmi_rec_release_fopt);
+        m0_fop_type_fini(&m0_fop_fdmi_rec_batch_fopt);
+        m0_fop_type_fini(&m0_fop_fdmi_rec_release_batch_fopt);
 
         m0_fop_type_fini(&m0_fop_fdmi_rec_not_rep_fopt);
         m0_fop_type_fini(&m0_fop_fdmi_rec_release_rep_fopt);
+        m0_fop_type_fini(&m0_fop_fdmi_rec_batch_rep_fopt);
 
         m0_xc_fdmi_fops_fini();
 }
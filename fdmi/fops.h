@@ -35,6 +35,9 @@ extern struct m0_fop_type m0_fop_fdmi_rec_not_fopt;
 extern struct m0_fop_type m0_fop_fdmi_rec_not_rep_fopt;
 extern struct m0_fop_type m0_fop_fdmi_rec_release_fopt;
 extern struct m0_fop_type m0_fop_fdmi_rec_release_rep_fopt;
+extern struct m0_fop_type m0_fop_fdmi_rec_batch_fopt;
+extern struct m0_fop_type m0_fop_fdmi_rec_batch_rep_fopt;
+extern struct m0_fop_type m0_fop_fdmi_rec_release_batch_fopt;
 
 /**
    @addtogroup fdmi_sd_int
@@ -102,6 +105,46 @@ struct m0_fop_fdmi_rec_release_reply {
 	int frrr_rc;                  /**< release request result */
 } M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
 
+/** Array of FDMI records */
+struct m0_fdmi_rec_arr {
+	uint32_t                   fra_nr;
+	struct m0_fop_fdmi_record *fra_recs;
+} M0_XCA_SEQUENCE M0_XCA_DOMAIN(rpc);
+
+/**
+ * FDMI record batch notification body: records sent to a plugin dock in
+ * one fop.
+ */
+struct m0_fop_fdmi_rec_batch {
+	struct m0_fdmi_rec_arr frb_recs;
+} M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
+
+/**
+ * FDMI record batch notification reply body
+ */
+struct m0_fop_fdmi_rec_batch_reply {
+	int32_t  frbr_rc;
+	/**
+	 * Number of records the plugin dock is ready to accept on top of the
+	 * records it holds, the source dock keeps no more records in flight.
+	 */
+	uint32_t frbr_window;
+} M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
+
+/** Array of FDMI record releases */
+struct m0_fdmi_rec_release_arr {
+	uint32_t                        frra_nr;
+	struct m0_fop_fdmi_rec_release *frra_recs;
+} M0_XCA_SEQUENCE M0_XCA_DOMAIN(rpc);
+
+/**
+ * FDMI record release batch request body, replied with
+ * m0_fop_fdmi_rec_release_reply.
+ */
+struct m0_fop_fdmi_rec_release_batch {
+	struct m0_fdmi_rec_release_arr frrb_recs;
+} M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
+
 
 M0_INTERNAL int m0_fdms_fop_init(void);
 M0_INTERNAL void m0_fdms_fop_fini(void);
@@ -50,6 +50,20 @@ struct m0_fdmi_module_plugin {
 
 	struct m0_tl                 fdmp_fdmi_recs;
 	struct m0_mutex              fdmp_fdmi_recs_lock;
+	/*
+	 * Fields below are protected by fdmp_fdmi_recs_lock.
+	 */
+	/** Number of registered records not released by plugins yet. */
+	uint32_t                     fdmp_recs_nr;
+	/** Number of released records, release of which is not sent yet. */
+	uint32_t                     fdmp_release_nr;
+	/** Number of record notification FOMs in progress. */
+	uint32_t                     fdmp_foms_nr;
+	/**
+	 * Number of unreleased records the dock accepts, announced to source
+	 * docks in record batch replies.
+	 */
+	uint32_t                     fdmp_window;
 
 	bool                         fdmp_dock_inited;
 	/**
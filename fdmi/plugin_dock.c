@@ -30,6 +30,7 @@
 #include "lib/misc.h"         /* M0_IN */
 #include "lib/errno.h"        /* ENOMEM, EPROTO */
 #include "lib/memory.h"       /* M0_ALLOC_ARR, m0_free */
+#include "lib/string.h"       /* m0_streq */
 #include "lib/finject.h"      /* M0_FI_ENABLED */
 #include "net/lnet/lnet.h"    /* M0_NET_LNET_XEP_ADDR_LEN */
 #include "fop/fop.h"
@@ -64,6 +65,7 @@ struct m0_fop_type m0_pdock_fdmi_filters_enable_fopt;
 struct m0_fop_type m0_pdock_fdmi_filters_enable_rep_fopt;
 
 static void pdock_record_release(struct m0_ref *ref);
+static void pdock_release_flush(void);
 
 static int pdock_client_post(struct m0_fop                *fop,
 			     struct m0_rpc_session        *session,
@@ -322,6 +324,45 @@ struct m0_rpc_item_ops release_ri_ops = {
 	.rio_replied = release_replied
 };
 
+static void release_batch_replied(struct m0_rpc_item *item)
+{
+	struct m0_fdmi_module                *m = m0_fdmi_module__get();
+	struct m0_fop_fdmi_rec_release_batch *rdata;
+	struct m0_fop_fdmi_rec_release       *rr;
+	struct m0_fdmi_record_reg            *rreg;
+	uint32_t                              i;
+
+	M0_ENTRY("item %p, ri_error %d", item, item->ri_error);
+
+	rdata = m0_fop_data(m0_rpc_item_to_fop(item));
+	for (i = 0; i < rdata->frrb_recs.frra_nr; i++) {
+		rr = &rdata->frrb_recs.frra_recs[i];
+		m0_mutex_lock(&m->fdm_p.fdmp_fdmi_recs_lock);
+		rreg = m0_tl_find(fdmi_recs, r, &m->fdm_p.fdmp_fdmi_recs,
+				  r->frr_release_batched &&
+				  m0_uint128_eq(&rr->frr_frid,
+						&r->frr_rec->fr_rec_id));
+		if (rreg != NULL)
+			fdmi_recs_tlist_remove(rreg);
+		m0_mutex_unlock(&m->fdm_p.fdmp_fdmi_recs_lock);
+		if (rreg == NULL) {
+			M0_LOG(M0_ERROR,
+			       "fdmi record was not found in pdock: id = "
+			       U128X_F, U128_P(&rr->frr_frid));
+			continue;
+		}
+		m0_free(rreg->frr_ep_addr);
+		m0_fop_put(rreg->frr_fop);
+		m0_free(rreg);
+	}
+	m0_rpc_conn_pool_put(&m->fdm_p.fdmp_conn_pool, item->ri_session);
+	M0_LEAVE();
+}
+
+static const struct m0_rpc_item_ops release_batch_ri_ops = {
+	.rio_replied = release_batch_replied
+};
+
 /**
   Private pdock API. Plugin calls it via m0_fdmi_pd_ops::fpo_release_fdmi_rec()
   when done with FDMI record.
@@ -351,19 +392,23 @@ leave:
 
 M0_INTERNAL struct
 m0_fdmi_record_reg *m0_fdmi__pdock_fdmi_record_register(struct m0_fop *fop)
+{
+	if (M0_FI_ENABLED("fail_fdmi_rec_reg"))
+		return NULL;
+
+	return m0_fdmi__pdock_fdmi_rec_register(fop, m0_fop_data(fop));
+}
+
+M0_INTERNAL struct m0_fdmi_record_reg *
+m0_fdmi__pdock_fdmi_rec_register(struct m0_fop             *fop,
+				 struct m0_fop_fdmi_record *frec)
 {
 	struct m0_fdmi_module     *m = m0_fdmi_module__get();
-	struct m0_fop_fdmi_record *frec;
 	struct m0_fdmi_record_reg *rreg;
 
 	M0_ENTRY();
 	M0_ASSERT(m->fdm_p.fdmp_dock_inited);
 
-	if (M0_FI_ENABLED("fail_fdmi_rec_reg"))
-		return NULL;
-
-	frec = m0_fop_data(fop);
-
 	/* prepare record registration entry */
 
 	M0_ALLOC_PTR(rreg);
@@ -401,6 +446,7 @@ m0_fdmi_record_reg *m0_fdmi__pdock_fdmi_record_register(struct m0_fop *fop)
 	/* keep registration entry */
 	m0_mutex_lock(&m->fdm_p.fdmp_fdmi_recs_lock);
 	fdmi_recs_tlink_init_at_tail(rreg, &m->fdm_p.fdmp_fdmi_recs);
+	M0_CNT_INC(m->fdm_p.fdmp_recs_nr);
 	m0_mutex_unlock(&m->fdm_p.fdmp_fdmi_recs_lock);
 
 	test_print_fdmi_rec_list();
@@ -415,48 +461,71 @@ leave:
 }
 
 /**
- * Called when fdmi record refc just got to zero
+ * Called when fdmi record refc just got to zero. The release is sent
+ * later together with the releases of other records, unless there are
+ * enough of them already or no record notification is in progress.
  */
 static void pdock_record_release(struct m0_ref *ref)
 {
-	struct m0_fdmi_module          *m = m0_fdmi_module__get();
-	struct m0_fdmi_record_reg      *rreg;
-	struct m0_fop                  *req;
-	struct m0_fop_fdmi_rec_release *req_data;
-	int                             rc;
+	struct m0_fdmi_module     *m = m0_fdmi_module__get();
+	struct m0_fdmi_record_reg *rreg;
+	bool                       flush;
 
 	M0_ENTRY();
 
-	req      = NULL;
-	req_data = NULL;
-	rc       = 0;
-
 	rreg = container_of(ref, struct m0_fdmi_record_reg, frr_ref);
 
 	M0_LOG(M0_DEBUG, "Will send release for rreg %p, rid " U128X_F,
 	       rreg, U128_P(&rreg->frr_rec->fr_rec_id));
 
+	m0_mutex_lock(&m->fdm_p.fdmp_fdmi_recs_lock);
 	if (rreg->frr_ep_addr == NULL) {
 		/* No way to post anything over RPC */
-		rc = -EACCES;
-		m0_mutex_lock(&m->fdm_p.fdmp_fdmi_recs_lock);
 		fdmi_recs_tlist_remove(rreg);
+		M0_CNT_DEC(m->fdm_p.fdmp_recs_nr);
 		m0_mutex_unlock(&m->fdm_p.fdmp_fdmi_recs_lock);
 		if (rreg->frr_sess != NULL)
 			m0_rpc_conn_pool_put(&m->fdm_p.fdmp_conn_pool,
 					     rreg->frr_sess);
 		m0_free(rreg);
-
-		goto leave;
+		M0_LEAVE("rc=%d", -EACCES);
+		return;
 	}
+	/* The release may be retried after a failure to send it. */
+	if (!rreg->frr_release_pending && !rreg->frr_release_batched) {
+		rreg->frr_release_pending = true;
+		M0_CNT_INC(m->fdm_p.fdmp_release_nr);
+		M0_CNT_DEC(m->fdm_p.fdmp_recs_nr);
+	}
+	flush = m->fdm_p.fdmp_release_nr >= M0_FDMI_PDOCK_RELEASE_BATCH_NR ||
+		m->fdm_p.fdmp_foms_nr == 0;
+	m0_mutex_unlock(&m->fdm_p.fdmp_fdmi_recs_lock);
+
+	if (flush)
+		pdock_release_flush();
+	M0_LEAVE();
+}
+
+/**
+ * Sends the release of a single record with m0_fop_fdmi_rec_release.
+ */
+static int pdock_release_send_one(struct m0_fdmi_record_reg *rreg)
+{
+	struct m0_fdmi_module          *m = m0_fdmi_module__get();
+	struct m0_fop                  *req;
+	struct m0_fop_fdmi_rec_release *req_data;
+	int                             rc;
+
+	M0_ENTRY("rreg %p", rreg);
+
+	req = NULL;
 
 	/* Post release request */
 
 	M0_ALLOC_PTR(req_data);
 	if (req_data == NULL) {
 		M0_LOG(M0_ERROR, "request data allocation failed");
-		M0_RC(-ENOMEM);
-		return;
+		return M0_ERR(-ENOMEM);
 	}
 
 	req_data->frr_frt  = rreg->frr_rec->fr_rec_type;
@@ -508,7 +577,165 @@ leave:
 			m0_free(req);
 	}
 
-	M0_RC(rc);
+	return M0_RC(rc);
+}
+
+/**
+ * Sends releases of records received from the same endpoint in one
+ * m0_fop_fdmi_rec_release_batch.
+ */
+static int pdock_release_send(struct m0_fdmi_record_reg **regs, uint32_t nr)
+{
+	struct m0_fdmi_module                *m = m0_fdmi_module__get();
+	struct m0_fop_fdmi_rec_release_batch *req_data;
+	struct m0_fop_fdmi_rec_release       *rr;
+	struct m0_rpc_session                *sess;
+	struct m0_fop                        *req;
+	uint32_t                              i;
+	int                                   rc;
+
+	M0_ENTRY("nr %u", nr);
+	M0_PRE(nr > 0);
+
+	if (nr == 1)
+		return M0_RC(pdock_release_send_one(regs[0]));
+
+	M0_ALLOC_PTR(req_data);
+	if (req_data == NULL)
+		return M0_ERR(-ENOMEM);
+	M0_ALLOC_ARR(req_data->frrb_recs.frra_recs, nr);
+	if (req_data->frrb_recs.frra_recs == NULL) {
+		m0_free(req_data);
+		return M0_ERR(-ENOMEM);
+	}
+	req_data->frrb_recs.frra_nr = nr;
+	for (i = 0; i < nr; i++) {
+		rr = &req_data->frrb_recs.frra_recs[i];
+		rr->frr_frt  = regs[i]->frr_rec->fr_rec_type;
+		rr->frr_frid = regs[i]->frr_rec->fr_rec_id;
+	}
+
+	req = m0_fop_alloc(&m0_fop_fdmi_rec_release_batch_fopt, req_data,
+			   m0_fdmi__pdock_conn_pool_rpc_machine());
+	if (req == NULL) {
+		m0_free(req_data->frrb_recs.frra_recs);
+		m0_free(req_data);
+		return M0_ERR(-ENOMEM);
+	}
+
+	rc = m0_rpc_conn_pool_get_sync(&m->fdm_p.fdmp_conn_pool,
+				       regs[0]->frr_ep_addr, &sess);
+	if (rc == 0) {
+		for (i = 0; i < nr; i++)
+			regs[i]->frr_release_batched = true;
+		rc = pdock_client_post(req, sess, &release_batch_ri_ops);
+		if (rc != 0) {
+			for (i = 0; i < nr; i++)
+				regs[i]->frr_release_batched = false;
+			m0_rpc_conn_pool_put(&m->fdm_p.fdmp_conn_pool, sess);
+		}
+	}
+	if (rc != 0)
+		M0_LOG(M0_ERROR, "Failed to post release batch: ep = %s, "
+		       "nr = %u, rc = %d", regs[0]->frr_ep_addr, nr, rc);
+	m0_fop_put_lock(req);
+	return M0_RC(rc);
+}
+
+/**
+ * Sends pending releases, grouped by the endpoint records were received
+ * from. Releases failed to be sent stay pending and are retried on the
+ * next flush.
+ */
+static void pdock_release_flush(void)
+{
+	struct m0_fdmi_module     *m = m0_fdmi_module__get();
+	struct m0_fdmi_record_reg *regs[M0_FDMI_PDOCK_RELEASE_BATCH_NR];
+	struct m0_fdmi_record_reg *rreg;
+	const char                *ep;
+	uint32_t                   nr;
+	uint32_t                   i;
+	int                        rc;
+
+	M0_ENTRY();
+	do {
+		ep = NULL;
+		nr = 0;
+		m0_mutex_lock(&m->fdm_p.fdmp_fdmi_recs_lock);
+		m0_tl_for(fdmi_recs, &m->fdm_p.fdmp_fdmi_recs, rreg) {
+			if (!rreg->frr_release_pending)
+				continue;
+			if (ep == NULL)
+				ep = rreg->frr_ep_addr;
+			else if (!m0_streq(ep, rreg->frr_ep_addr))
+				continue;
+			rreg->frr_release_pending = false;
+			regs[nr++] = rreg;
+			if (nr == ARRAY_SIZE(regs))
+				break;
+		} m0_tl_endfor;
+		m->fdm_p.fdmp_release_nr -= nr;
+		m0_mutex_unlock(&m->fdm_p.fdmp_fdmi_recs_lock);
+		if (nr == 0)
+			break;
+
+		rc = pdock_release_send(regs, nr);
+		if (rc != 0) {
+			m0_mutex_lock(&m->fdm_p.fdmp_fdmi_recs_lock);
+			for (i = 0; i < nr; i++)
+				regs[i]->frr_release_pending = true;
+			m->fdm_p.fdmp_release_nr += nr;
+			m0_mutex_unlock(&m->fdm_p.fdmp_fdmi_recs_lock);
+		}
+	} while (rc == 0);
+	M0_LEAVE();
+}
+
+M0_INTERNAL void m0_fdmi__pdock_fom_start(void)
+{
+	struct m0_fdmi_module *m = m0_fdmi_module__get();
+
+	m0_mutex_lock(&m->fdm_p.fdmp_fdmi_recs_lock);
+	M0_CNT_INC(m->fdm_p.fdmp_foms_nr);
+	m0_mutex_unlock(&m->fdm_p.fdmp_fdmi_recs_lock);
+}
+
+M0_INTERNAL void m0_fdmi__pdock_fom_done(void)
+{
+	struct m0_fdmi_module *m = m0_fdmi_module__get();
+	bool                   flush;
+
+	m0_mutex_lock(&m->fdm_p.fdmp_fdmi_recs_lock);
+	M0_CNT_DEC(m->fdm_p.fdmp_foms_nr);
+	flush = m->fdm_p.fdmp_foms_nr == 0 && m->fdm_p.fdmp_release_nr > 0;
+	m0_mutex_unlock(&m->fdm_p.fdmp_fdmi_recs_lock);
+
+	if (flush)
+		pdock_release_flush();
+}
+
+M0_INTERNAL uint32_t m0_fdmi__pdock_window(void)
+{
+	struct m0_fdmi_module *m = m0_fdmi_module__get();
+	uint32_t               window;
+
+	m0_mutex_lock(&m->fdm_p.fdmp_fdmi_recs_lock);
+	window = m->fdm_p.fdmp_window > m->fdm_p.fdmp_recs_nr ?
+		 m->fdm_p.fdmp_window - m->fdm_p.fdmp_recs_nr : 0;
+	m0_mutex_unlock(&m->fdm_p.fdmp_fdmi_recs_lock);
+	return window;
+}
+
+/**
+ * Private pdock API. Plugin calls it via m0_fdmi_pd_ops::fpo_window_set().
+ */
+static void window_set(uint32_t window)
+{
+	struct m0_fdmi_module *m = m0_fdmi_module__get();
+
+	m0_mutex_lock(&m->fdm_p.fdmp_fdmi_recs_lock);
+	m->fdm_p.fdmp_window = window;
+	m0_mutex_unlock(&m->fdm_p.fdmp_fdmi_recs_lock);
 }
 
 /**
@@ -557,7 +784,8 @@ const struct m0_fdmi_pd_ops fdmi_pdo = {
 	.fpo_register_filter   = register_filter,
 	.fpo_enable_filters    = enable_filters,
 	.fpo_release_fdmi_rec  = release_fdmi_rec,
-	.fpo_deregister_plugin = deregister_plugin
+	.fpo_deregister_plugin = deregister_plugin,
+	.fpo_window_set        = window_set
 };
 
 const struct m0_fdmi_pd_ops *m0_fdmi_plugin_dock_api_get(void)
@@ -585,6 +813,10 @@ M0_INTERNAL int m0_fdmi__plugin_dock_init(void)
 	m0_mutex_init(&m->fdm_p.fdmp_fdmi_filters_lock);
 	fdmi_recs_tlist_init(&m->fdm_p.fdmp_fdmi_recs);
 	m0_mutex_init(&m->fdm_p.fdmp_fdmi_recs_lock);
+	m->fdm_p.fdmp_recs_nr    = 0;
+	m->fdm_p.fdmp_release_nr = 0;
+	m->fdm_p.fdmp_foms_nr    = 0;
+	m->fdm_p.fdmp_window     = M0_FDMI_PDOCK_WINDOW_DEFAULT;
 	m->fdm_p.fdmp_dock_inited = true;
 	return M0_RC(0);
 }
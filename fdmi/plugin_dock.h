@@ -108,6 +108,10 @@ struct m0_fdmi_record_reg {
    rpc session the release request was sent over
  */
 	struct m0_rpc_session          *frr_sess;
+	/** Released by plugins, waiting to be sent in a release batch. */
+	bool                            frr_release_pending;
+	/** Release is sent in a release batch, frr_sess is not used. */
+	bool                            frr_release_batched;
 
 	struct m0_ref                   frr_ref;    /**< reference counter */
 /** save pointer to initial fop */
@@ -156,6 +160,20 @@ struct m0_fdmi_pd_ops {
 	 */
 	void (*fpo_deregister_plugin) (struct m0_fid *filter_ids,
 				       uint64_t       filter_count);
+
+	/**
+	  Sets the number of records plugins are ready to hold unreleased.
+	  Source docks do not send more records while the plugin dock holds
+	  that many (M0_FDMI_PDOCK_WINDOW_DEFAULT by default).
+	 */
+	void (*fpo_window_set) (uint32_t window);
+};
+
+enum {
+	/** Default m0_fdmi_module_plugin::fdmp_window */
+	M0_FDMI_PDOCK_WINDOW_DEFAULT = 1024,
+	/** Maximal number of record releases sent in one fop */
+	M0_FDMI_PDOCK_RELEASE_BATCH_NR = 64
 };
 
 /**
@@ -26,6 +26,7 @@
 #include "lib/trace.h"
 #include "motr/magic.h"       /* M0_CONFC_MAGIC, M0_CONFC_CTX_MAGIC */
 #include "lib/misc.h"         /* M0_IN */
+#include "lib/arith.h"        /* max32u */
 #include "lib/errno.h"        /* ENOMEM, EPROTO */
 #include "lib/memory.h"       /* M0_ALLOC_ARR, m0_free */
 #include "rpc/rpc_opcodes.h"  /* M0_FDMI_PLUGIN_DOCK_OPCODE */
@@ -64,7 +65,9 @@ static struct m0_sm_state_descr fdmi_plugin_dock_state_descr[] = {
                 .sd_flags       = M0_SDF_INITIAL,
                 .sd_name        = "Init",
                 .sd_allowed     =
-		M0_BITS(FDMI_PLG_DOCK_FOM_FEED_PLUGINS_WITH_REC)
+		M0_BITS(FDMI_PLG_DOCK_FOM_FEED_PLUGINS_WITH_REC,
+			FDMI_PLG_DOCK_FOM_FINISH_WITH_REC,
+			FDMI_PLG_DOCK_FOM_FINI)
         },
 
         [FDMI_PLG_DOCK_FOM_FINI] = {
@@ -82,7 +85,10 @@ static struct m0_sm_state_descr fdmi_plugin_dock_state_descr[] = {
         [FDMI_PLG_DOCK_FOM_FINISH_WITH_REC] = {
                 .sd_flags       = 0,
                 .sd_name        = "Finish With Record",
-                .sd_allowed     = M0_BITS(FDMI_PLG_DOCK_FOM_FINI)
+                .sd_allowed     =
+		M0_BITS(FDMI_PLG_DOCK_FOM_FEED_PLUGINS_WITH_REC,
+			FDMI_PLG_DOCK_FOM_FINISH_WITH_REC,
+			FDMI_PLG_DOCK_FOM_FINI)
         },
 };
 
@@ -102,6 +108,63 @@ static const struct m0_fom_ops pdock_fom_ops = {
 	.fo_home_locality = pdock_fom_home_locality,
 };
 
+static bool pdock_fop_is_batch(const struct m0_fop *fop)
+{
+	return fop->f_type == &m0_fop_fdmi_rec_batch_fopt;
+}
+
+/**
+ * Registers records of a record batch notification and allocates its
+ * reply. The reply is filled when it is sent.
+ */
+static int pdock_fom_batch_init(struct pdock_fom  *pd_fom,
+				struct m0_fop     *fop,
+				struct m0_fop    **reply_fop)
+{
+	struct m0_fop_fdmi_rec_batch       *batch = m0_fop_data(fop);
+	struct m0_fop_fdmi_rec_batch_reply *rep;
+	uint32_t                            nr = batch->frb_recs.fra_nr;
+	uint32_t                            i;
+
+	M0_ENTRY("nr %u", nr);
+
+	pd_fom->pf_recs    = batch->frb_recs.fra_recs;
+	pd_fom->pf_recs_nr = nr;
+	M0_ALLOC_ARR(pd_fom->pf_rregs, max32u(nr, 1));
+	if (pd_fom->pf_rregs == NULL)
+		return M0_ERR(-ENOMEM);
+	for (i = 0; i < nr; i++) {
+		pd_fom->pf_rregs[i] = m0_fdmi__pdock_fdmi_rec_register(
+			fop, &pd_fom->pf_recs[i]);
+		if (pd_fom->pf_rregs[i] == NULL) {
+			M0_LOG(M0_ERROR, "FDMI record failed to register");
+			goto err;
+		}
+	}
+
+	M0_ALLOC_PTR(rep);
+	if (rep == NULL)
+		goto err;
+	*reply_fop = m0_fop_alloc(&m0_fop_fdmi_rec_batch_rep_fopt, rep,
+				  m0_fdmi__pdock_conn_pool_rpc_machine());
+	if (*reply_fop == NULL) {
+		m0_free(rep);
+		goto err;
+	}
+	if (m0_fop_to_rpc_item(fop)->ri_rmachine == NULL) {
+		/* No rpc machine in ut, reply is skipped. */
+		m0_free(*reply_fop);
+		m0_free(rep);
+		*reply_fop = NULL;
+	}
+	return M0_RC(0);
+err:
+	while (i-- > 0)
+		m0_ref_put(&pd_fom->pf_rregs[i]->frr_ref);
+	m0_free0(&pd_fom->pf_rregs);
+	return M0_ERR(-ENOMEM);
+}
+
 static int pdock_fom_create(struct m0_fop  *fop,
 			    struct m0_fom **out,
 			    struct m0_reqh *reqh)
@@ -125,6 +188,13 @@ static int pdock_fom_create(struct m0_fop  *fop,
 		return M0_RC(-ENOMEM);
 	M0_SET0(pd_fom);
 
+	if (pdock_fop_is_batch(fop)) {
+		rc = pdock_fom_batch_init(pd_fom, fop, &reply_fop);
+		if (rc != 0)
+			goto fom_fini;
+		goto fom_init;
+	}
+
 	M0_ALLOC_PTR(reply_fop_data);
 	if (reply_fop_data == NULL) {
 		rc = -ENOMEM;
@@ -156,6 +226,9 @@ static int pdock_fom_create(struct m0_fop  *fop,
 
 	/* get prepared to inspecting record guts */
 	frec = m0_fop_data(fop);
+	pd_fom->pf_rreg    = rreg;
+	pd_fom->pf_recs    = frec;
+	pd_fom->pf_recs_nr = 1;
 
 	/* set up reply fop */
 	reply_fop_data->frn_frt = frec->fr_rec_type;
@@ -176,6 +249,7 @@ static int pdock_fom_create(struct m0_fop  *fop,
 		reply_fop = NULL;
 	}
 
+fom_init:
 	/* set up fom */
 	fom = &pd_fom->pf_fom;
 
@@ -183,6 +257,7 @@ static int pdock_fom_create(struct m0_fop  *fop,
 		    &pdock_fom_ops, fop, reply_fop, reqh);
 
 	M0_ASSERT(m0_fom_phase(fom) == FDMI_PLG_DOCK_FOM_INIT);
+	m0_fdmi__pdock_fom_start();
 	*out = fom;
 
 	return M0_RC(0);
@@ -212,18 +287,63 @@ static void pdock_fom_fini(struct m0_fom *fom)
 		m0_fom_fini(fom);
 	}
 
+	m0_free(pd_fom->pf_rregs);
 	m0_free(pd_fom);
 
 	M0_LEAVE();
 }
 
+/** Moves the FOM to the record pf_recs[pf_idx]. */
+static void pdock_fom_rec_set(struct pdock_fom *pd_fom)
+{
+	/* reset position in filter id array */
+	pd_fom->pf_pos = 0;
+
+	/* unveil fop data */
+	pd_fom->pf_rec = &pd_fom->pf_recs[pd_fom->pf_idx];
+	if (pd_fom->pf_rregs != NULL)
+		pd_fom->pf_rreg = pd_fom->pf_rregs[pd_fom->pf_idx];
+
+	m0_fom_phase_set(&pd_fom->pf_fom,
+			 pd_fom->pf_rec->fr_matched_flts.fmf_count > 0 ?
+			 FDMI_PLG_DOCK_FOM_FEED_PLUGINS_WITH_REC :
+			 FDMI_PLG_DOCK_FOM_FINISH_WITH_REC);
+}
+
+static int pdock_fom_done(struct m0_fom *fom)
+{
+	/* Pending record releases may be posted. */
+	m0_fom_block_enter(fom);
+	m0_fdmi__pdock_fom_done();
+	m0_fom_block_leave(fom);
+
+	M0_LOG(M0_DEBUG, "set fom state FOM_FINI");
+	m0_fom_phase_set(fom, FDMI_PLG_DOCK_FOM_FINI);
+	return M0_FSO_WAIT;
+}
+
 static int pdock_fom_tick__init(struct m0_fom *fom)
 {
 	struct pdock_fom          *pd_fom;
 
 	M0_ENTRY();
 
-	if (fom->fo_rep_fop != NULL) {
+	pd_fom = container_of(fom, struct pdock_fom, pf_fom);
+
+	if (fom->fo_rep_fop != NULL && pdock_fop_is_batch(fom->fo_fop)) {
+		struct m0_fop_fdmi_rec_batch_reply *rep =
+			m0_fop_data(fom->fo_rep_fop);
+
+		/* Records of this batch are accounted already. */
+		rep->frbr_rc     = 0;
+		rep->frbr_window = m0_fdmi__pdock_window();
+
+		M0_LOG(M0_DEBUG, "send batch reply, nr %u, window %u",
+		       pd_fom->pf_recs_nr, rep->frbr_window);
+
+		m0_rpc_reply_post(m0_fop_to_rpc_item(fom->fo_fop),
+				  m0_fop_to_rpc_item(fom->fo_rep_fop));
+	} else if (fom->fo_rep_fop != NULL) {
 		struct m0_fop_fdmi_record *fdmi_rec =
 			(struct m0_fop_fdmi_record*) m0_fop_data(fom->fo_fop);
 
@@ -234,15 +354,12 @@ static int pdock_fom_tick__init(struct m0_fom *fom)
 				  m0_fop_to_rpc_item(fom->fo_rep_fop));
 	}
 
-	pd_fom = container_of(fom, struct pdock_fom, pf_fom);
-
-	/* reset position in filter id array */
-	pd_fom->pf_pos = 0;
-
-	/* unveil fop data */
-	pd_fom->pf_rec = m0_fop_data(fom->fo_fop);
-
-	m0_fom_phase_set(fom, FDMI_PLG_DOCK_FOM_FEED_PLUGINS_WITH_REC);
+	if (pd_fom->pf_recs_nr == 0) {
+		M0_LEAVE();
+		return pdock_fom_done(fom);
+	}
+	pd_fom->pf_idx = 0;
+	pdock_fom_rec_set(pd_fom);
 
 	M0_LEAVE();
 	return M0_FSO_AGAIN;
@@ -344,7 +461,9 @@ static int pdock_fom_tick__finish_with_rec(struct m0_fom *fom)
 
 	pd_fom = container_of(fom, struct pdock_fom, pf_fom);
 	frec   = pd_fom->pf_rec;
-	rreg   = m0_fdmi__pdock_record_reg_find(&frec->fr_rec_id);
+	/* Records of a batch may have the same id when re-sent. */
+	rreg   = pd_fom->pf_rregs != NULL ? pd_fom->pf_rreg :
+		 m0_fdmi__pdock_record_reg_find(&frec->fr_rec_id);
 	if (rreg != NULL) {
 		/**
 		 * Release record reg refc:
@@ -367,11 +486,14 @@ static int pdock_fom_tick__finish_with_rec(struct m0_fom *fom)
 		m0_fom_block_leave(fom);
 	}
 
-	M0_LOG(M0_DEBUG, "set fom state FOM_FINI");
-	m0_fom_phase_set(fom, FDMI_PLG_DOCK_FOM_FINI);
+	if (++pd_fom->pf_idx < pd_fom->pf_recs_nr) {
+		pdock_fom_rec_set(pd_fom);
+		M0_LEAVE();
+		return M0_FSO_AGAIN;
+	}
 
 	M0_LEAVE();
-	return M0_FSO_WAIT;
+	return pdock_fom_done(fom);
 }
 
 static int pdock_fom_tick(struct m0_fom *fom)
@@ -74,6 +74,26 @@ M0_INTERNAL int  m0_fdmi__plugin_dock_fom_init(void);
 M0_INTERNAL struct
 m0_fdmi_record_reg *m0_fdmi__pdock_fdmi_record_register(struct m0_fop *fop);
 
+/**
+   Registers a record of the notification fop, which may be a record batch.
+ */
+M0_INTERNAL struct m0_fdmi_record_reg *
+m0_fdmi__pdock_fdmi_rec_register(struct m0_fop             *fop,
+				 struct m0_fop_fdmi_record *frec);
+
+/**
+   Accounts a record notification FOM. Releases of records are sent
+   in batches, when there are enough of them or no FOM is in progress.
+ */
+M0_INTERNAL void m0_fdmi__pdock_fom_start(void);
+M0_INTERNAL void m0_fdmi__pdock_fom_done(void);
+
+/**
+   Returns the number of records the plugin dock accepts on top of the
+   unreleased ones.
+ */
+M0_INTERNAL uint32_t m0_fdmi__pdock_window(void);
+
 /**
    Plugin dock FOM context
  */
@@ -82,6 +102,15 @@ struct pdock_fom {
 	struct m0_fom              pf_fom;
 	/** FDMI record notification body */
 	struct m0_fop_fdmi_record *pf_rec;
+	/** Registration of pf_rec */
+	struct m0_fdmi_record_reg *pf_rreg;
+	/** Records of the notification, more than one for a record batch */
+	struct m0_fop_fdmi_record *pf_recs;
+	/** Registrations of pf_recs of a record batch, NULL otherwise */
+	struct m0_fdmi_record_reg **pf_rregs;
+	uint32_t                   pf_recs_nr;
+	/** Index of pf_rec in pf_recs */
+	uint32_t                   pf_idx;
 	/** Current position in filter ids array the FOM iterates on */
 	uint32_t                   pf_pos;
 	/** custom FOM finalisation routine, currently intended for use in UT */
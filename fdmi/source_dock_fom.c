@@ -24,6 +24,7 @@
 #include "lib/trace.h"
 
 #include "lib/memory.h"
+#include "lib/string.h"       /* m0_streq */
 #include "rpc/rpc_opcodes.h"  /* M0_FDMI_SOURCE_DOCK_OPCODE */
 #include "fop/fom_generic.h" /* m0_rpc_item_generic_reply_rc */
 #include "fdmi/fdmi.h"
@@ -40,19 +41,30 @@ static size_t fdmi_sd_fom_locality(const struct m0_fom *fom);
 static int sd_fom_send_record(struct fdmi_sd_fom *sd_fom,
 			      struct m0_fop      *fop,
 			      const char         *ep);
+
+/**
+ * Results of m0_fdmi_sd_filter_type_handler::ffth_rec_match() calls for the
+ * record being processed, bit i is for fdmi_filter_type_handlers[i].
+ */
+struct sd_rec_match {
+	uint32_t rm_checked;
+	uint32_t rm_matched;
+};
+
 static int fdmi_filter_calc(struct fdmi_sd_fom         *sd_fom,
 			    struct m0_fdmi_src_rec     *src_rec,
-			    struct m0_conf_fdmi_filter *fdmi_filter);
+			    struct m0_conf_fdmi_filter *fdmi_filter,
+			    struct sd_rec_match        *rec_match);
 
 static int fdmi_rr_fom_create(struct m0_fop *fop, struct m0_fom **out,
 			      struct m0_reqh *reqh);
 static void fdmi_rr_fom_fini(struct m0_fom *fom);
 static int fdmi_rr_fom_tick(struct m0_fom *fom);
 
-static void fdmi_rec_notif_replied(struct m0_rpc_item *item);
+static void fdmi_rec_batch_replied(struct m0_rpc_item *item);
 
-static const struct m0_rpc_item_ops fdmi_rec_not_item_ops = {
-	.rio_replied = fdmi_rec_notif_replied
+static const struct m0_rpc_item_ops fdmi_rec_batch_item_ops = {
+	.rio_replied = fdmi_rec_batch_replied
 };
 
 struct fdmi_pending_fop {
@@ -71,6 +83,13 @@ M0_TL_DESCR_DEFINE(pending_fops, "pending fops list", M0_INTERNAL,
 
 M0_TL_DEFINE(pending_fops, static, struct fdmi_pending_fop);
 
+M0_TL_DESCR_DEFINE(sd_plugins, "source dock plugins", static,
+		   struct fdmi_sd_plugin, sp_linkage, sp_magic,
+		   M0_FDMI_SRC_DOCK_PLUGIN_MAGIC,
+		   M0_FDMI_SRC_DOCK_PLUGIN_HEAD_MAGIC);
+
+M0_TL_DEFINE(sd_plugins, static, struct fdmi_sd_plugin);
+
 M0_TL_DESCR_DECLARE(fdmi_record_inflight, M0_EXTERN);
 M0_TL_DECLARE(fdmi_record_inflight, M0_EXTERN, struct m0_fdmi_src_rec);
 
@@ -147,7 +166,8 @@ enum fdmi_src_dock_timer_fom_phase {
 	FDMI_SRC_DOCK_TIMER_FOM_PHASE_INIT = M0_FOM_PHASE_INIT,
 	FDMI_SRC_DOCK_TIMER_FOM_PHASE_FINI = M0_FOM_PHASE_FINISH,
 	FDMI_SRC_DOCK_TIMER_FOM_PHASE_WAIT = M0_FOM_PHASE_NR,
-	FDMI_SRC_DOCK_TIMER_FOM_PHASE_ALARMED
+	FDMI_SRC_DOCK_TIMER_FOM_PHASE_ALARMED,
+	FDMI_SRC_DOCK_TIMER_FOM_PHASE_STORE
 };
 
 static struct m0_sm_state_descr fdmi_src_dock_timer_fom_state_descr[] = {
@@ -167,8 +187,14 @@ static struct m0_sm_state_descr fdmi_src_dock_timer_fom_state_descr[] = {
 		.sd_flags       = 0,
 		.sd_name        = "Alarmed",
 		.sd_allowed     = M0_BITS(FDMI_SRC_DOCK_TIMER_FOM_PHASE_WAIT,
+					  FDMI_SRC_DOCK_TIMER_FOM_PHASE_STORE,
 					  FDMI_SRC_DOCK_TIMER_FOM_PHASE_FINI)
 	},
+	[FDMI_SRC_DOCK_TIMER_FOM_PHASE_STORE] = {
+		.sd_flags       = 0,
+		.sd_name        = "OffsetStore",
+		.sd_allowed     = M0_BITS(FDMI_SRC_DOCK_TIMER_FOM_PHASE_WAIT)
+	},
 	[FDMI_SRC_DOCK_TIMER_FOM_PHASE_FINI] = {
 		.sd_flags       = M0_SDF_TERMINAL,
 		.sd_name        = "Fini",
@@ -317,6 +343,8 @@ m0_fdmi__src_dock_fom_start(struct m0_fdmi_src_dock *src_dock,
 	m0_fdmi_eval_init(&sd_fom->fsf_flt_eval);
 	m0_mutex_init(&sd_fom->fsf_pending_fops_lock);
 	pending_fops_tlist_init(&sd_fom->fsf_pending_fops);
+	m0_mutex_init(&sd_fom->fsf_plugins_lock);
+	sd_plugins_tlist_init(&sd_fom->fsf_plugins);
 	sd_fom->fsf_has_records = false;
 	m0_fom_init(fom, &fdmi_sd_fom_type, &fdmi_sd_fom_ops, NULL, NULL, reqh);
 	m0_fom_queue(fom);
@@ -329,6 +357,8 @@ m0_fdmi__src_dock_fom_start(struct m0_fdmi_src_dock *src_dock,
 			    NULL, NULL, reqh);
 		m0_fom_timeout_init(&timer_fom->fstf_timeout);
 		m0_semaphore_init(&timer_fom->fstf_shutdown, 0);
+		timer_fom->fstf_lsn_next = 0;
+		timer_fom->fstf_lsn_stored = 0;
 		m0_fom_queue(&timer_fom->fstf_fom);
 	}
 
@@ -382,6 +412,7 @@ static int apply_filters(struct fdmi_sd_fom     *sd_fom,
 	struct m0_fom              *fom = &sd_fom->fsf_fom;
 	struct m0_filterc_ctx      *filterc = &sd_fom->fsf_filter_ctx;
 	struct m0_conf_fdmi_filter *fdmi_filter;
+	struct sd_rec_match         rec_match = {};
 	int                         matched;
 	int                         rc = 0;
 	int                         ret;
@@ -397,7 +428,7 @@ static int apply_filters(struct fdmi_sd_fom     *sd_fom,
 		m0_fom_block_leave(fom);
 		if (ret > 0) {
 			matched = fdmi_filter_calc(sd_fom, src_rec,
-						   fdmi_filter);
+						   fdmi_filter, &rec_match);
 			src_rec->fsr_matched = (matched > 0);
 			if (matched < 0) {
 				/**
@@ -455,6 +486,7 @@ static void fdmi_sd_fom_fini(struct m0_fom *fom)
 {
 	struct fdmi_sd_fom    *sd_fom = M0_AMB(sd_fom, fom, fsf_fom);
 	struct m0_filterc_ctx *filterc_ctx = &sd_fom->fsf_filter_ctx;
+	struct fdmi_sd_plugin *plugin;
 
 	M0_ENTRY("fom %p", fom);
 
@@ -467,6 +499,18 @@ static void fdmi_sd_fom_fini(struct m0_fom *fom)
 	m0_rpc_conn_pool_fini(&sd_fom->fsf_conn_pool);
 	m0_mutex_fini(&sd_fom->fsf_pending_fops_lock);
 	pending_fops_tlist_fini(&sd_fom->fsf_pending_fops);
+	m0_tl_teardown(sd_plugins, &sd_fom->fsf_plugins, plugin) {
+		/* Batches with records are sent before the FOM finishes. */
+		if (plugin->sp_batch != NULL) {
+			M0_ASSERT(plugin->sp_batch->sb_nr == 0);
+			m0_fop_put_lock(plugin->sp_batch->sb_fop);
+			m0_free(plugin->sp_batch);
+		}
+		m0_free(plugin->sp_ep);
+		m0_free(plugin);
+	}
+	sd_plugins_tlist_fini(&sd_fom->fsf_plugins);
+	m0_mutex_fini(&sd_fom->fsf_plugins_lock);
 	sd_fom->fsf_has_records = false;
 	m0_semaphore_up(&sd_fom->fsf_shutdown);
 	m0_fom_fini(fom);
@@ -483,7 +527,7 @@ static int fdmi_post_fop(struct m0_fop *fop, struct m0_rpc_session *session)
 	M0_ENTRY("fop: %p, session: %p", fop, session);
 
 	item                     = &fop->f_item;
-	item->ri_ops             = &fdmi_rec_not_item_ops;
+	item->ri_ops             = &fdmi_rec_batch_item_ops;
 	item->ri_session         = session;
 	item->ri_prio            = M0_RPC_ITEM_PRIO_MID;
 
@@ -504,11 +548,15 @@ static bool pending_fop_clink_cb(struct m0_clink *clink)
 						      fti_clink);
 	struct fdmi_sd_fom      *sd_fom  = pending_fop->sd_fom;
 	struct m0_fop           *fop     = pending_fop->fti_fop;
-	struct m0_fdmi_src_rec  *src_rec = fop->f_opaque;
+	struct fdmi_sd_batch    *batch   = fop->f_opaque;
+	struct m0_fdmi_src_rec  *recs[FDMI_SD_BATCH_NR];
+	struct m0_fdmi_src_rec  *src_rec;
 	struct m0_rpc_session   *session = pending_fop->fti_session;
 	struct m0_fdmi_src_dock *sd_dock = M0_AMB(sd_dock, sd_fom, fsdc_sd_fom);
 	m0_time_t                now;
 	bool                     est;
+	uint32_t                 nr = batch->sb_nr;
+	uint32_t                 i;
 	int                      rc;
 	M0_ENTRY();
 
@@ -522,14 +570,17 @@ static bool pending_fop_clink_cb(struct m0_clink *clink)
 	m0_mutex_unlock(&sd_fom->fsf_pending_fops_lock);
 	m0_free(pending_fop);
 
-	if (est) {
-		rc = fdmi_post_fop(fop, session);
-		if (rc == 0) {
-			/*
-			 * At this moment, the fop may already fail and
-			 * fail replied.
-			 */
-			m0_mutex_lock(&sd_dock->fsdc_list_mutex);
+	/* The batch is freed when the fop is replied. */
+	memcpy(recs, batch->sb_recs, nr * sizeof recs[0]);
+	rc = est ? fdmi_post_fop(fop, session) : -ENOTCONN;
+	if (rc == 0) {
+		/*
+		 * At this moment, the fop may already fail and
+		 * fail replied.
+		 */
+		m0_mutex_lock(&sd_dock->fsdc_list_mutex);
+		for (i = 0; i < nr; i++) {
+			src_rec = recs[i];
 			if (!fdmi_record_inflight_tlink_is_in(src_rec)) {
 				fdmi_record_inflight_tlist_add_tail(
 					&sd_dock->fsdc_rec_inflight, src_rec);
@@ -537,35 +588,44 @@ static bool pending_fop_clink_cb(struct m0_clink *clink)
 						 "list id = " U128X_F,
 					U128_P(&src_rec->fsr_rec_id));
 			}
-			m0_mutex_unlock(&sd_dock->fsdc_list_mutex);
 		}
+		m0_mutex_unlock(&sd_dock->fsdc_list_mutex);
 	} else {
 		m0_rpc_conn_pool_put(&sd_fom->fsf_conn_pool, session);
 		/*
 		 * Destroy this session.
 		 */
 		m0_rpc_conn_pool_destroy(&sd_fom->fsf_conn_pool, session);
-		M0_LOG(M0_DEBUG, "CANNOT SEND src_rec =" U128X_F " ref cnt:%d",
-				  U128_P(&src_rec->fsr_rec_id),
-				  (int)m0_ref_read(&src_rec->fsr_ref));
-		m0_ref_put(&src_rec->fsr_ref);
-		m0_fdmi__fs_put(src_rec);
-
-		/*
-		 * re-send FDMI it, or release it.
-		 */
+		m0_mutex_lock(&sd_fom->fsf_plugins_lock);
+		batch->sb_plugin->sp_inflight -= batch->sb_nr;
+		m0_mutex_unlock(&sd_fom->fsf_plugins_lock);
 		now = m0_time_now();
-		if (m0_time_sub(now, src_rec->fsr_init_time) >
-		    m0_time(FDMI_SRC_DOCK_MAX_CHECKPOINT_TIME * 3, 0)) {
-			M0_LOG(M0_WARN, "Given up record %p, ID:" U128X_F,
-				 src_rec, U128_P(&src_rec->fsr_rec_id));
+		for (i = 0; i < batch->sb_nr; i++) {
+			src_rec = batch->sb_recs[i];
+			M0_LOG(M0_DEBUG, "CANNOT SEND src_rec =" U128X_F
+			       " ref cnt:%d", U128_P(&src_rec->fsr_rec_id),
+			       (int)m0_ref_read(&src_rec->fsr_ref));
 			m0_ref_put(&src_rec->fsr_ref);
 			m0_fdmi__fs_put(src_rec);
-		} else {
-			M0_LOG(M0_DEBUG, "Enqueue record again %p, ID:" U128X_F,
-				 src_rec, U128_P(&src_rec->fsr_rec_id));
-			m0_fdmi__enqueue(src_rec);
+
+			/*
+			 * re-send FDMI it, or release it.
+			 */
+			if (m0_time_sub(now, src_rec->fsr_init_time) >
+			    m0_time(FDMI_SRC_DOCK_MAX_CHECKPOINT_TIME * 3, 0)) {
+				M0_LOG(M0_WARN, "Given up record %p, ID:"
+				       U128X_F, src_rec,
+				       U128_P(&src_rec->fsr_rec_id));
+				m0_ref_put(&src_rec->fsr_ref);
+				m0_fdmi__fs_put(src_rec);
+			} else {
+				M0_LOG(M0_DEBUG, "Enqueue record again %p, "
+				       "ID:" U128X_F, src_rec,
+				       U128_P(&src_rec->fsr_rec_id));
+				m0_fdmi__enqueue(src_rec);
+			}
 		}
+		m0_free(batch);
 	}
 	m0_fop_put_lock(fop);
 	M0_LEAVE();
@@ -604,15 +664,27 @@ static int sd_fom_send_record(struct fdmi_sd_fom *sd_fom, struct m0_fop *fop,
 	int                    rc;
 	struct m0_rpc_session *session;
 	struct m0_fdmi_src_dock *src_dock = m0_fdmi_src_dock_get();
-	struct m0_fdmi_src_rec  *src_rec = fop->f_opaque;
+	struct fdmi_sd_batch    *batch = fop->f_opaque;
+	struct m0_fdmi_src_rec  *recs[FDMI_SD_BATCH_NR];
+	struct m0_fdmi_src_rec  *src_rec;
+	uint32_t                 nr = batch->sb_nr;
+	uint32_t                 i;
 
 	M0_LOG(M0_DEBUG, "sd_fom %p, sending fop %p to ep %s", sd_fom, fop, ep);
+	/*
+	 * The batch is freed when the fop is replied, which can happen
+	 * before the records are added to the inflight list.
+	 */
+	memcpy(recs, batch->sb_recs, nr * sizeof recs[0]);
 	rc = m0_rpc_conn_pool_get_async(&sd_fom->fsf_conn_pool, ep, &session);
 	if (rc == 0) {
 		rc = fdmi_post_fop(fop, session);
 		if (rc == 0) {
 			m0_mutex_lock(&src_dock->fsdc_list_mutex);
-			if (!fdmi_record_inflight_tlink_is_in(src_rec)) {
+			for (i = 0; i < nr; i++) {
+				src_rec = recs[i];
+				if (fdmi_record_inflight_tlink_is_in(src_rec))
+					continue;
 				fdmi_record_inflight_tlist_add_tail(
 					&src_dock->fsdc_rec_inflight, src_rec);
 				M0_LOG(M0_DEBUG, "added to inflight list id = "
@@ -645,95 +717,259 @@ static struct m0_rpc_machine *m0_fdmi__sd_conn_pool_rpc_machine(void)
 	return src_dock->fsdc_sd_fom.fsf_conn_pool.cp_rpc_mach;
 }
 
-static struct m0_fop *alloc_fdmi_rec_fop(int filter_num)
+/** Removes filters of the endpoint from the matched filters of the record. */
+static void sd_rec_filters_del(struct m0_fdmi_src_rec *src_rec,
+			       const char             *endpoint)
 {
-	struct m0_fop_fdmi_record *fop_data;
-	struct m0_fop             *fop;
+	struct m0_conf_fdmi_filter *flt;
+
+	m0_tl_for(fdmi_matched_filter_list, &src_rec->fsr_filter_list, flt) {
+		if (m0_streq(endpoint, flt->ff_endpoints[0]))
+			fdmi_matched_filter_list_tlink_del_fini(flt);
+	} m0_tl_endfor;
+}
 
-	M0_PRE(filter_num > 0);
+/**
+ * Fills a record of a batch with the record data and the filters matched for
+ * the endpoint, which are removed from the list of matched filters of the
+ * record.
+ */
+static int sd_rec_fill(struct m0_fdmi_src_rec    *src_rec,
+		       const char                *endpoint,
+		       struct m0_fop_fdmi_record *frec)
+{
+	struct m0_fdmi_flt_id_arr  *matched = &frec->fr_matched_flts;
+	struct m0_conf_fdmi_filter *flt;
+	int                         filter_num;
+	int                         k = 0;
+	int                         idx; /* XXX: TEMP */
+	int                         rc;
 
+	M0_ENTRY("src_rec %p, endpoint %s", src_rec, endpoint);
+	M0_PRE(m0_fdmi__record_is_valid(src_rec));
+
+	filter_num = filters_nr(src_rec, endpoint);
+	M0_ASSERT(filter_num > 0);
+	M0_ALLOC_ARR(matched->fmf_flt_id, filter_num);
+	if (matched->fmf_flt_id == NULL)
+		return M0_ERR(-ENOMEM);
+	m0_tl_for(fdmi_matched_filter_list, &src_rec->fsr_filter_list, flt) {
+		if (m0_streq(endpoint, flt->ff_endpoints[0]))
+			matched->fmf_flt_id[k++] = flt->ff_filter_id;
+	} m0_tl_endfor;
+	sd_rec_filters_del(src_rec, endpoint);
+	matched->fmf_count = filter_num;
+	frec->fr_rec_id    = src_rec->fsr_rec_id;
+	frec->fr_rec_type  = m0_fdmi__sd_rec_type_id_get(src_rec);
+
+	M0_LOG(M0_DEBUG, "FDMI record id = "U128X_F, U128_P(&frec->fr_rec_id));
+	M0_LOG(M0_DEBUG, "FDMI record type = %x", frec->fr_rec_type);
+	M0_LOG(M0_DEBUG, "*   matched filters count = [%d]",
+	       matched->fmf_count);
+	for (idx = 0; idx < matched->fmf_count; idx++) {
+		M0_LOG(M0_DEBUG, "*   [%4d] = "FID_SF, idx,
+		       FID_P(&matched->fmf_flt_id[idx]));
+	}
+
+	rc = src_rec->fsr_src->fs_encode(src_rec, &frec->fr_payload);
+	if (rc != 0) {
+		m0_free(matched->fmf_flt_id);
+		M0_SET0(frec);
+	}
+	return M0_RC(rc);
+}
+
+static struct fdmi_sd_batch *sd_batch_alloc(struct fdmi_sd_plugin *plugin)
+{
+	struct fdmi_sd_batch         *batch;
+	struct m0_fop_fdmi_rec_batch *fop_data;
+
+	M0_ALLOC_PTR(batch);
+	if (batch == NULL)
+		goto batch_alloc_fail;
 	M0_ALLOC_PTR(fop_data);
 	if (fop_data == NULL)
 		goto data_alloc_fail;
-	fop_data->fr_matched_flts.fmf_count = filter_num;
-
-	M0_ALLOC_ARR(fop_data->fr_matched_flts.fmf_flt_id, filter_num);
-	if (fop_data->fr_matched_flts.fmf_flt_id == NULL)
-		goto flts_alloc_fail;
-
-	fop = m0_fop_alloc(&m0_fop_fdmi_rec_not_fopt, fop_data,
-			   m0_fdmi__sd_conn_pool_rpc_machine());
-	if (fop == NULL)
+	M0_ALLOC_ARR(fop_data->frb_recs.fra_recs, FDMI_SD_BATCH_NR);
+	if (fop_data->frb_recs.fra_recs == NULL)
+		goto recs_alloc_fail;
+	batch->sb_fop = m0_fop_alloc(&m0_fop_fdmi_rec_batch_fopt, fop_data,
+				     m0_fdmi__sd_conn_pool_rpc_machine());
+	if (batch->sb_fop == NULL)
 		goto fop_alloc_fail;
-	return fop;
+	batch->sb_fop->f_opaque = batch;
+	batch->sb_plugin = plugin;
+	return batch;
 fop_alloc_fail:
-	m0_free(fop_data->fr_matched_flts.fmf_flt_id);
-flts_alloc_fail:
+	m0_free(fop_data->frb_recs.fra_recs);
+recs_alloc_fail:
 	m0_free(fop_data);
 data_alloc_fail:
+	m0_free(batch);
+batch_alloc_fail:
 	return NULL;
 }
 
-static struct m0_fop *fop_create(struct m0_fdmi_src_rec *src_rec,
-				 const char             *endpoint)
+/** Returns the plugin of the endpoint, adding it when not known yet. */
+static struct fdmi_sd_plugin *sd_plugin_get(struct fdmi_sd_fom *sd_fom,
+					    const char         *endpoint)
 {
-	int                         filter_num;
-	struct m0_conf_fdmi_filter *flt;
-	struct m0_conf_fdmi_filter *tmp;
-	int                         k;
-	struct m0_fop              *fop = NULL;
-	struct m0_fop_fdmi_record  *fop_data;
-	int                         idx; /* XXX: TEMP */
-	struct m0_fdmi_flt_id_arr  *matched = NULL;
-
-	M0_ENTRY("src_rec %p, endpoint %s", src_rec, endpoint);
-	M0_PRE(m0_fdmi__record_is_valid(src_rec));
+	struct fdmi_sd_plugin *plugin;
+
+	M0_PRE(m0_mutex_is_locked(&sd_fom->fsf_plugins_lock));
+
+	plugin = m0_tl_find(sd_plugins, p, &sd_fom->fsf_plugins,
+			    m0_streq(p->sp_ep, endpoint));
+	if (plugin != NULL)
+		return plugin;
+	M0_ALLOC_PTR(plugin);
+	if (plugin == NULL)
+		return NULL;
+	plugin->sp_ep = m0_strdup(endpoint);
+	if (plugin->sp_ep == NULL) {
+		m0_free(plugin);
+		return NULL;
+	}
+	plugin->sp_window = FDMI_SD_WINDOW_DEFAULT;
+	sd_plugins_tlink_init_at_tail(plugin, &sd_fom->fsf_plugins);
+	return plugin;
+}
 
-	filter_num = filters_nr(src_rec, endpoint);
-	if (filter_num > 0) {
-		fop = alloc_fdmi_rec_fop(filter_num);
-		if (fop == NULL)
-			return NULL;
-		fop_data = m0_fop_data(fop);
-		fop_data->fr_rec_id   = src_rec->fsr_rec_id;
-		fop_data->fr_rec_type = m0_fdmi__sd_rec_type_id_get(src_rec);
-		matched = &fop_data->fr_matched_flts;
-		k = 0;
-		while (k < filter_num) {
-			flt = fdmi_matched_filter_list_tlist_head(
-				&src_rec->fsr_filter_list);
-			if (m0_streq(endpoint, flt->ff_endpoints[0])) {
-				matched->fmf_flt_id[k++] = flt->ff_filter_id;
-				tmp = flt;
-				flt = fdmi_matched_filter_list_tlist_next(
-					&src_rec->fsr_filter_list, flt);
-				fdmi_matched_filter_list_tlink_del_fini(tmp);
-			} else {
-				flt = fdmi_matched_filter_list_tlist_next(
-					&src_rec->fsr_filter_list, flt);
-			}
-		}
-		M0_LOG(M0_DEBUG, "FDMI record id = "U128X_F,
-		       U128_P(&fop_data->fr_rec_id));
-		M0_LOG(M0_DEBUG, "FDMI record type = %x", fop_data->fr_rec_type);
-		M0_LOG(M0_DEBUG, "*   matched filters count = [%d]",
-		       matched->fmf_count);
-		for (idx = 0; idx < matched->fmf_count; idx++) {
-			M0_LOG(M0_DEBUG, "*   [%4d] = "FID_SF, idx,
-			       FID_P(&matched->fmf_flt_id[idx]));
+/**
+ * Sends the batch of the plugin, unless the plugin has records in flight
+ * and the batch does not fit into its window. The batch is then held until
+ * a reply to the batches in flight comes.
+ */
+static void sd_batch_send(struct fdmi_sd_fom    *sd_fom,
+			  struct fdmi_sd_plugin *plugin,
+			  bool                   force)
+{
+	struct fdmi_sd_batch   *batch;
+	struct m0_fdmi_src_rec *src_rec;
+	struct m0_fop          *fop;
+	uint32_t                nr;
+	uint32_t                i;
+	int                     rc;
+
+	m0_mutex_lock(&sd_fom->fsf_plugins_lock);
+	batch = plugin->sp_batch;
+	if (batch == NULL || batch->sb_nr == 0 ||
+	    (!force && plugin->sp_inflight > 0 &&
+	     plugin->sp_inflight + batch->sb_nr > plugin->sp_window)) {
+		m0_mutex_unlock(&sd_fom->fsf_plugins_lock);
+		return;
+	}
+	plugin->sp_batch = NULL;
+	plugin->sp_inflight += batch->sb_nr;
+	m0_mutex_unlock(&sd_fom->fsf_plugins_lock);
+
+	fop = batch->sb_fop;
+	nr  = batch->sb_nr;
+	M0_LOG(M0_DEBUG, "will send fop=%p with %u records to %s",
+	       fop, nr, plugin->sp_ep);
+	/*
+	 * Adding refs. They will be dropped when "FDMI record release"
+	 * is received. They are taken before sending, because the batch
+	 * may be replied and freed before sd_fom_send_record() returns.
+	 */
+	for (i = 0; i < nr; i++) {
+		src_rec = batch->sb_recs[i];
+		m0_fdmi__fs_get(src_rec);
+		m0_ref_get(&src_rec->fsr_ref);
+	}
+	rc = sd_fom_send_record(sd_fom, fop, plugin->sp_ep);
+	if (rc != 0) {
+		M0_LOG(M0_ERROR, "Failed to send %u records to %s: rc=%d",
+		       nr, plugin->sp_ep, rc);
+		m0_mutex_lock(&sd_fom->fsf_plugins_lock);
+		plugin->sp_inflight -= nr;
+		m0_mutex_unlock(&sd_fom->fsf_plugins_lock);
+		/* Send failure. Drop refs now. */
+		for (i = 0; i < nr; i++) {
+			src_rec = batch->sb_recs[i];
+			M0_LOG(M0_DEBUG, "src_rec ="U128X_F" ref cnt:%d",
+			       U128_P(&src_rec->fsr_rec_id),
+			       (int)m0_ref_read(&src_rec->fsr_ref));
+			m0_ref_put(&src_rec->fsr_ref);
+			m0_fdmi__fs_put(src_rec);
+			m0_ref_put(&src_rec->fsr_ref);
+			m0_fdmi__fs_put(src_rec);
 		}
+		m0_free(batch);
 	}
-	M0_LOG(M0_DEBUG, "ret fop %p", fop);
-	return fop;
+	m0_fop_put_lock(fop);
 }
 
-static int payload_encode(struct m0_fdmi_src_rec *src_rec, struct m0_fop *fop)
+/** Sends batches of all plugins. */
+static void sd_plugins_flush(struct fdmi_sd_fom *sd_fom, bool force)
 {
-	struct m0_fop_fdmi_record *rec = m0_fop_data(fop);
+	struct fdmi_sd_plugin *plugin;
 
-	M0_ENTRY("src_rec %p fop %p", src_rec, fop);
-	M0_PRE(m0_fdmi__record_is_valid(src_rec));
-	return M0_RC(src_rec->fsr_src->fs_encode(src_rec, &rec->fr_payload));
+	/* Plugins are added only by the source dock FOM. */
+	m0_tl_for(sd_plugins, &sd_fom->fsf_plugins, plugin) {
+		sd_batch_send(sd_fom, plugin, force);
+	} m0_tl_endfor;
+}
+
+/** Returns true iff there is a full batch held by the window. */
+static bool sd_plugins_blocked(struct fdmi_sd_fom *sd_fom)
+{
+	bool blocked;
+
+	m0_mutex_lock(&sd_fom->fsf_plugins_lock);
+	blocked = m0_tl_exists(sd_plugins, p, &sd_fom->fsf_plugins,
+			       p->sp_batch != NULL &&
+			       p->sp_batch->sb_nr == FDMI_SD_BATCH_NR);
+	m0_mutex_unlock(&sd_fom->fsf_plugins_lock);
+	return blocked;
+}
+
+/**
+ * Adds the record to the batch of the endpoint, the batch is sent when it
+ * is full.
+ */
+static int sd_batch_add(struct fdmi_sd_fom     *sd_fom,
+			struct m0_fdmi_src_rec *src_rec,
+			const char             *endpoint)
+{
+	struct fdmi_sd_plugin        *plugin;
+	struct fdmi_sd_batch         *batch;
+	struct m0_fop_fdmi_rec_batch *fop_data;
+	bool                          full;
+	int                           rc;
+
+	M0_ENTRY("src_rec %p, endpoint %s", src_rec, endpoint);
+
+	m0_mutex_lock(&sd_fom->fsf_plugins_lock);
+	plugin = sd_plugin_get(sd_fom, endpoint);
+	if (plugin != NULL && plugin->sp_batch == NULL)
+		plugin->sp_batch = sd_batch_alloc(plugin);
+	if (plugin == NULL || plugin->sp_batch == NULL) {
+		m0_mutex_unlock(&sd_fom->fsf_plugins_lock);
+		return M0_ERR(-ENOMEM);
+	}
+	batch = plugin->sp_batch;
+	/* The source dock FOM does not process records while blocked. */
+	M0_ASSERT(batch->sb_nr < FDMI_SD_BATCH_NR);
+	fop_data = m0_fop_data(batch->sb_fop);
+	rc = sd_rec_fill(src_rec, endpoint,
+			 &fop_data->frb_recs.fra_recs[batch->sb_nr]);
+	if (rc == 0) {
+		batch->sb_recs[batch->sb_nr++] = src_rec;
+		fop_data->frb_recs.fra_nr = batch->sb_nr;
+		/* Adding a ref. It will be dropped when reply is received. */
+		m0_fdmi__fs_get(src_rec);
+		m0_ref_get(&src_rec->fsr_ref);
+		M0_LOG(M0_DEBUG, "src_rec ="U128X_F" ref cnt:%d",
+				 U128_P(&src_rec->fsr_rec_id),
+				 (int)m0_ref_read(&src_rec->fsr_ref));
+	}
+	full = batch->sb_nr == FDMI_SD_BATCH_NR;
+	m0_mutex_unlock(&sd_fom->fsf_plugins_lock);
+
+	if (full)
+		sd_batch_send(sd_fom, plugin, false);
+	return M0_RC(rc);
 }
 
 static int sd_fom_process_matched_filters(struct m0_fdmi_src_dock *sd_ctx,
@@ -750,7 +986,6 @@ static int sd_fom_process_matched_filters(struct m0_fdmi_src_dock *sd_ctx,
 	       U128_P(&src_rec->fsr_rec_id));
 	while (!fdmi_matched_filter_list_tlist_is_empty(
 					&src_rec->fsr_filter_list)) {
-		struct m0_fop *fop;
 		matched_filter = fdmi_matched_filter_list_tlist_head(
 			&src_rec->fsr_filter_list);
 		/*
@@ -758,47 +993,18 @@ static int sd_fom_process_matched_filters(struct m0_fdmi_src_dock *sd_ctx,
 		 * for a filter => take 1st array item
 		 */
 		endpoint = matched_filter->ff_endpoints[0];
-		fop = fop_create(src_rec, endpoint);
-		if (fop == NULL)
-			continue;
-		M0_LOG(M0_DEBUG, "will send fop=%p fdmi rec:%p", fop, src_rec);
-		fop->f_opaque = src_rec;
-
-		/* @todo check rc and handle errors properly. */
-		rc = payload_encode(src_rec, fop);
-		M0_ASSERT(rc == 0);
-
-		/* Adding a ref. It will be dropped when reply is received. */
-		m0_fdmi__fs_get(src_rec);
-		m0_ref_get(&src_rec->fsr_ref);
-		M0_LOG(M0_DEBUG, "src_rec ="U128X_F" ref cnt:%d",
-				 U128_P(&src_rec->fsr_rec_id),
-				 (int)m0_ref_read(&src_rec->fsr_ref));
-
-		rc = sd_fom_send_record(&sd_ctx->fsdc_sd_fom, fop, endpoint);
-		if (rc == 0) {
-			/*
-			 * Adding a ref. It will be dropped when
-			 * "FDMI record release" is received.
-			 */
-			m0_fdmi__fs_get(src_rec);
-			m0_ref_get(&src_rec->fsr_ref);
-			M0_LOG(M0_DEBUG, "src_rec ="U128X_F" ref cnt:%d",
-					 U128_P(&src_rec->fsr_rec_id),
-					 (int)m0_ref_read(&src_rec->fsr_ref));
-			/**
-			 * @todo store map <fdmi record id, endpoint>,
-			 * Phase 2
-			 */
-		} else {
-			/* Send failure. Drop ref now. */
-			M0_LOG(M0_DEBUG, "src_rec ="U128X_F" ref cnt:%d",
-					 U128_P(&src_rec->fsr_rec_id),
-					 (int)m0_ref_read(&src_rec->fsr_ref));
-			m0_ref_put(&src_rec->fsr_ref);
-			m0_fdmi__fs_put(src_rec);
+		/*
+		 * Filters of the endpoint are removed from the list even when
+		 * the record is not added to the batch. The record is not
+		 * sent to the endpoint then.
+		 */
+		rc = sd_batch_add(&sd_ctx->fsdc_sd_fom, src_rec, endpoint);
+		if (rc != 0) {
+			M0_LOG(M0_ERROR, "Failed to send record "U128X_F
+			       " to %s: rc=%d", U128_P(&src_rec->fsr_rec_id),
+			       endpoint, rc);
+			sd_rec_filters_del(src_rec, endpoint);
 		}
-		m0_fop_put_lock(fop);
 	}
 	return M0_RC(rc);
 }
@@ -819,14 +1025,19 @@ static struct m0_fdmi_sd_filter_type_handler fdmi_filter_type_handlers[] = {
 		.ffth_handler = &m0_fdmi_eval_flt,
 	},
 	{
-		.ffth_id      = M0_FDMI_FILTER_TYPE_KV_SUBSTRING,
-		.ffth_handler = &m0_fol_fdmi_filter_kv_substring,
+		.ffth_id        = M0_FDMI_FILTER_TYPE_KV_SUBSTRING,
+		.ffth_handler   = &m0_fol_fdmi_filter_kv_substring,
+		.ffth_rec_match = &m0_fol_fdmi_filter_kv_substring_rec,
 	},
 };
 
+M0_BASSERT(ARRAY_SIZE(fdmi_filter_type_handlers) <=
+	   sizeof(((struct sd_rec_match *)NULL)->rm_checked) * 8);
+
 static int fdmi_filter_calc(struct fdmi_sd_fom         *sd_fom,
 			    struct m0_fdmi_src_rec     *src_rec,
-			    struct m0_conf_fdmi_filter *fdmi_filter)
+			    struct m0_conf_fdmi_filter *fdmi_filter,
+			    struct sd_rec_match        *rec_match)
 {
 	struct m0_fdmi_sd_filter_type_handler *handler;
 	struct m0_fdmi_eval_var_info           get_var_info;
@@ -843,6 +1054,15 @@ static int fdmi_filter_calc(struct fdmi_sd_fom         *sd_fom,
 	for (i = 0; i < ARRAY_SIZE(fdmi_filter_type_handlers); ++i) {
 		handler = &fdmi_filter_type_handlers[i];
 		if (handler->ffth_id == fdmi_filter->ff_type) {
+			if (handler->ffth_rec_match != NULL &&
+			    !(rec_match->rm_checked & M0_BITS(i))) {
+				rec_match->rm_checked |= M0_BITS(i);
+				if (handler->ffth_rec_match(src_rec))
+					rec_match->rm_matched |= M0_BITS(i);
+			}
+			if (handler->ffth_rec_match != NULL &&
+			    !(rec_match->rm_matched & M0_BITS(i)))
+				return M0_RC(0);
 			rc = handler->ffth_handler(&sd_fom->fsf_flt_eval,
 						   fdmi_filter,
 						   &get_var_info);
@@ -923,6 +1143,7 @@ static int fdmi_sd_fom_tick(struct m0_fom *fom)
 	struct m0_fdmi_src_dock *sd_ctx = M0_AMB(sd_ctx, sd_fom, fsdc_sd_fom);
 	struct m0_reqh_service  *rsvc = fom->fo_service;
 	struct m0_fdmi_src_rec  *src_rec;
+	bool                     stopping;
 	int                      rc;
 
 	M0_ENTRY("fom %p", fom);
@@ -943,13 +1164,35 @@ static int fdmi_sd_fom_tick(struct m0_fom *fom)
 
 		fdmi_sd_fom_check(sd_fom);
 
+		stopping = m0_reqh_service_state_get(rsvc) == M0_RST_STOPPING;
+		if (!stopping && sd_plugins_blocked(sd_fom)) {
+			sd_plugins_flush(sd_fom, false);
+			/*
+			 * A batch reply signals fsf_wake after updating the
+			 * window, check again under the channel lock.
+			 */
+			m0_mutex_lock(&sd_fom->fsf_chan_guard);
+			if (sd_plugins_blocked(sd_fom)) {
+				M0_LOG(M0_DEBUG, "wait for plugins window");
+				m0_fom_wait_on(fom, &sd_fom->fsf_wake,
+					       &fom->fo_cb);
+				m0_mutex_unlock(&sd_fom->fsf_chan_guard);
+				m0_fom_phase_set(fom,
+						 FDMI_SRC_DOCK_FOM_PHASE_WAIT);
+				return M0_RC(M0_FSO_WAIT);
+			}
+			m0_mutex_unlock(&sd_fom->fsf_chan_guard);
+		}
+
 		m0_mutex_lock(&sd_ctx->fsdc_list_mutex);
 		src_rec = fdmi_record_list_tlist_pop(
 			&sd_ctx->fsdc_posted_rec_list);
 		m0_mutex_unlock(&sd_ctx->fsdc_list_mutex);
 
 		if (src_rec == NULL) {
-			if (m0_reqh_service_state_get(rsvc) == M0_RST_STOPPING)
+			/* No more records for now, send partial batches. */
+			sd_plugins_flush(sd_fom, stopping);
+			if (stopping)
 				m0_fom_phase_set(fom,
 						 FDMI_SRC_DOCK_FOM_PHASE_FINI);
 			else {
@@ -998,47 +1241,73 @@ static int fdmi_sd_fom_tick(struct m0_fom *fom)
 	return M0_RC(M0_FSO_WAIT);
 }
 
-static void fdmi_rec_notif_replied(struct m0_rpc_item *item)
+static void fdmi_rec_batch_replied(struct m0_rpc_item *item)
 {
-	struct m0_fdmi_src_rec  *src_rec;
-	struct m0_fdmi_src_dock *src_dock;
-	struct m0_rpc_conn_pool *pool;
-	int                      rc;
-	int64_t                  ref_cnt;
+	struct m0_fop                      *fop = m0_rpc_item_to_fop(item);
+	struct fdmi_sd_batch               *batch = fop->f_opaque;
+	struct fdmi_sd_plugin              *plugin = batch->sb_plugin;
+	struct m0_fdmi_src_rec             *src_rec;
+	struct m0_fdmi_src_dock            *src_dock;
+	struct fdmi_sd_fom                 *sd_fom;
+	struct m0_rpc_conn_pool            *pool;
+	struct m0_fop_fdmi_rec_batch_reply *rep = NULL;
+	bool                                held;
+	uint32_t                            i;
+	int                                 rc;
+	int64_t                             ref_cnt;
 
 	M0_ENTRY("item=%p", item);
 
 	src_dock = m0_fdmi_src_dock_get();
-	src_rec = m0_rpc_item_to_fop(item)->f_opaque;
-	M0_ASSERT(m0_fdmi__record_is_valid(src_rec));
+	sd_fom = &src_dock->fsdc_sd_fom;
 
 	rc = item->ri_error ?: m0_rpc_item_generic_reply_rc(item->ri_reply);
+	if (rc == 0 && m0_rpc_item_to_fop(item->ri_reply)->f_type ==
+	    &m0_fop_fdmi_rec_batch_rep_fopt) {
+		rep = m0_fop_data(m0_rpc_item_to_fop(item->ri_reply));
+		rc = rep->frbr_rc;
+	}
 	if (rc != 0)
 		M0_LOG(M0_ERROR, "FDMI reply error %d item->ri_error %d to %s",
 		       rc, item->ri_error,
 		       m0_rpc_conn_addr(item->ri_session->s_conn));
 
-	pool = &src_dock->fsdc_sd_fom.fsf_conn_pool;
-	m0_rpc_conn_pool_put(pool, item->ri_session);
-	ref_cnt = m0_ref_read(&src_rec->fsr_ref);
-	M0_LOG(M0_DEBUG, "src_rec ="U128X_F" ref cnt:%d",
-			 U128_P(&src_rec->fsr_rec_id),
-			 (int)(ref_cnt - 1));
-	m0_ref_put(&src_rec->fsr_ref);
-	m0_fdmi__fs_put(src_rec);
+	m0_mutex_lock(&sd_fom->fsf_plugins_lock);
+	plugin->sp_inflight -= batch->sb_nr;
+	if (rc == 0 && rep != NULL)
+		plugin->sp_window = rep->frbr_window;
+	held = plugin->sp_batch != NULL;
+	m0_mutex_unlock(&sd_fom->fsf_plugins_lock);
 
-	/*
-	 * The "FDMI release" request may come before this reply.
-	 * So, the ref cnt may drop to zero at this moment.
-	 * In that case, the record is freed and no need to re-send again.
-	 */
-	if (rc != 0 && (ref_cnt - 1) > 0) {
+	pool = &sd_fom->fsf_conn_pool;
+	m0_rpc_conn_pool_put(pool, item->ri_session);
+	if (rc != 0)
 		m0_rpc_conn_pool_destroy(pool, item->ri_session);
-		m0_mutex_lock(&src_dock->fsdc_list_mutex);
-		fdmi_record_inflight_tlist_remove(src_rec);
-		M0_LOG(M0_DEBUG, "removed from inflight list id = " U128X_F,
-				U128_P(&src_rec->fsr_rec_id));
 
+	for (i = 0; i < batch->sb_nr; i++) {
+		src_rec = batch->sb_recs[i];
+		M0_ASSERT(m0_fdmi__record_is_valid(src_rec));
+		ref_cnt = m0_ref_read(&src_rec->fsr_ref);
+		M0_LOG(M0_DEBUG, "src_rec ="U128X_F" ref cnt:%d",
+				 U128_P(&src_rec->fsr_rec_id),
+				 (int)(ref_cnt - 1));
+		m0_ref_put(&src_rec->fsr_ref);
+		m0_fdmi__fs_put(src_rec);
+
+		/*
+		 * The "FDMI release" request may come before this reply.
+		 * So, the ref cnt may drop to zero at this moment.
+		 * In that case, the record is freed and no need to re-send
+		 * again.
+		 */
+		if (rc == 0 || (ref_cnt - 1) == 0)
+			continue;
+		m0_mutex_lock(&src_dock->fsdc_list_mutex);
+		if (fdmi_record_inflight_tlink_is_in(src_rec)) {
+			fdmi_record_inflight_tlist_remove(src_rec);
+			M0_LOG(M0_DEBUG, "removed from inflight list id = "
+			       U128X_F, U128_P(&src_rec->fsr_rec_id));
+		}
 		m0_mutex_unlock(&src_dock->fsdc_list_mutex);
 		/*
 		 * The failed fop will be released.
@@ -1055,6 +1324,10 @@ static void fdmi_rec_notif_replied(struct m0_rpc_item *item)
 				 src_rec, U128_P(&src_rec->fsr_rec_id));
 		m0_fdmi__enqueue(src_rec);
 	}
+	m0_free(batch);
+	/* The batch held by the window can be sent now. */
+	if (held)
+		m0_fdmi__src_dock_fom_wakeup(sd_fom);
 
 	M0_LEAVE();
 }
@@ -1112,13 +1385,22 @@ static void fdmi_rr_fom_fini(struct m0_fom *fom)
 static int fdmi_rr_fom_tick(struct m0_fom *fom)
 {
 	struct m0_fop_fdmi_rec_release       *fop_data;
+	struct m0_fop_fdmi_rec_release_batch *batch;
 	struct m0_fop_fdmi_rec_release_reply *reply_data;
 	struct m0_rpc_item                   *item;
+	uint32_t                              i;
 
 	M0_ENTRY("fom %p", fom);
 
-	fop_data = m0_fop_data(fom->fo_fop);
-	m0_fdmi__handle_release(&fop_data->frr_frid);
+	if (m0_fop_opcode(fom->fo_fop) == M0_FDMI_RECORD_RELEASE_BATCH_OPCODE) {
+		batch = m0_fop_data(fom->fo_fop);
+		for (i = 0; i < batch->frrb_recs.frra_nr; i++)
+			m0_fdmi__handle_release(
+				&batch->frrb_recs.frra_recs[i].frr_frid);
+	} else {
+		fop_data = m0_fop_data(fom->fo_fop);
+		m0_fdmi__handle_release(&fop_data->frr_frid);
+	}
 	reply_data = m0_fop_data(fom->fo_rep_fop);
 	reply_data->frrr_rc = 0;
 	item = m0_fop_to_rpc_item(fom->fo_rep_fop);
@@ -1140,13 +1422,85 @@ static void fdmi_sd_timer_fom_fini(struct m0_fom *fom)
 	M0_LEAVE();
 }
 
+static void sd_timer_arm(struct fdmi_sd_timer_fom *timer_fom)
+{
+	struct m0_fom *fom = &timer_fom->fstf_fom;
+
+	m0_fom_timeout_fini(&timer_fom->fstf_timeout);
+	m0_fom_timeout_init(&timer_fom->fstf_timeout);
+	m0_fom_timeout_wait_on(&timer_fom->fstf_timeout, fom,
+		       m0_time_from_now(FDMI_SOURCE_DOCK_TIMER_FOM_TIMEOUT, 0));
+	m0_fom_phase_set(fom, FDMI_SRC_DOCK_TIMER_FOM_PHASE_WAIT);
+}
+
+/**
+ * Returns true iff the offset observed at the previous alarm is to be stored,
+ * in which case the transaction storing it is initialised.
+ */
+static bool sd_timer_offset_store_start(struct fdmi_sd_timer_fom *timer_fom)
+{
+	struct m0_fom    *fom = &timer_fom->fstf_fom;
+	struct m0_be_seg *seg = m0_fom_reqh(fom)->rh_beseg;
+	uint64_t          lsn = timer_fom->fstf_lsn_next;
+
+	timer_fom->fstf_lsn_next = m0_fol_fdmi_src_offset();
+	if (seg == NULL || lsn <= timer_fom->fstf_lsn_stored)
+		return false;
+	timer_fom->fstf_lsn = lsn;
+	M0_SET0(&fom->fo_tx);
+	m0_dtx_init(&fom->fo_tx, seg->bs_domain, &fom->fo_loc->fl_group);
+	return true;
+}
+
+/** Returns true iff the transaction storing the offset is finalised. */
+static bool sd_timer_offset_store(struct fdmi_sd_timer_fom *timer_fom)
+{
+	struct m0_fom    *fom = &timer_fom->fstf_fom;
+	struct m0_dtx    *dtx = &fom->fo_tx;
+	struct m0_be_tx  *tx  = &dtx->tx_betx;
+	struct m0_be_seg *seg = m0_fom_reqh(fom)->rh_beseg;
+	int               rc;
+
+	switch (m0_be_tx_state(tx)) {
+	case M0_BTS_PREPARE:
+		m0_fol_fdmi_src_offset_credit(seg, &dtx->tx_betx_cred);
+		m0_dtx_open(dtx);
+		break;
+	case M0_BTS_ACTIVE:
+		if (dtx->tx_state != M0_DTX_INIT)
+			break;
+		m0_dtx_opened(dtx);
+		rc = m0_fol_fdmi_src_offset_store(seg, tx, timer_fom->fstf_lsn);
+		if (rc == 0)
+			timer_fom->fstf_lsn_stored = timer_fom->fstf_lsn;
+		else
+			M0_LOG(M0_ERROR, "Failed to store FOL FDMI offset "
+			       "%"PRIu64": rc=%d", timer_fom->fstf_lsn, rc);
+		m0_dtx_done(dtx);
+		break;
+	case M0_BTS_FAILED:
+		M0_LOG(M0_ERROR, "Failed to open offset tx: rc=%d",
+		       tx->t_sm.sm_rc);
+		/* fallthrough */
+	case M0_BTS_DONE:
+		m0_dtx_fini(dtx);
+		return true;
+	default:
+		break;
+	}
+	m0_fom_wait_on(fom, &tx->t_sm.sm_chan, &fom->fo_cb);
+	return false;
+}
+
 static int fdmi_sd_timer_fom_tick(struct m0_fom *fom)
 {
 	struct fdmi_sd_timer_fom *timer_fom = M0_AMB(timer_fom, fom, fstf_fom);
 	struct m0_reqh_service   *rsvc = fom->fo_service;
 	struct m0_fdmi_src_dock  *src_dock = m0_fdmi_src_dock_get();
+	struct m0_be_seg         *seg = m0_fom_reqh(fom)->rh_beseg;
 
-	if (m0_reqh_service_state_get(rsvc) == M0_RST_STOPPING) {
+	if (m0_reqh_service_state_get(rsvc) == M0_RST_STOPPING &&
+	    m0_fom_phase(fom) != FDMI_SRC_DOCK_TIMER_FOM_PHASE_STORE) {
 		M0_LOG(M0_DEBUG, "timer fom stopping");
 		m0_fom_timeout_cancel(&timer_fom->fstf_timeout);
 		m0_fom_phase_set(fom, FDMI_SRC_DOCK_TIMER_FOM_PHASE_FINI);
@@ -1155,6 +1509,8 @@ static int fdmi_sd_timer_fom_tick(struct m0_fom *fom)
 
 	switch (m0_fom_phase(fom)) {
 	case FDMI_SRC_DOCK_TIMER_FOM_PHASE_INIT:
+		if (seg != NULL)
+			m0_fol_fdmi_src_offset_load(seg);
 		m0_fom_phase_set(fom, FDMI_SRC_DOCK_TIMER_FOM_PHASE_WAIT);
 		return M0_RC(M0_FSO_AGAIN);
 	case FDMI_SRC_DOCK_TIMER_FOM_PHASE_WAIT:
@@ -1163,13 +1519,17 @@ static int fdmi_sd_timer_fom_tick(struct m0_fom *fom)
 		return M0_RC(M0_FSO_AGAIN);
 	case FDMI_SRC_DOCK_TIMER_FOM_PHASE_ALARMED:
 		M0_LOG(M0_DEBUG, "Now, WAKEUP the source dock fom");
-		m0_fom_timeout_fini(&timer_fom->fstf_timeout);
-		m0_fom_timeout_init(&timer_fom->fstf_timeout);
-		m0_fom_timeout_wait_on(&timer_fom->fstf_timeout, fom,
-		       m0_time_from_now(FDMI_SOURCE_DOCK_TIMER_FOM_TIMEOUT, 0));
-
-		m0_fom_phase_set(fom, FDMI_SRC_DOCK_TIMER_FOM_PHASE_WAIT);
 		m0_fdmi__src_dock_fom_wakeup(&src_dock->fsdc_sd_fom);
+		if (sd_timer_offset_store_start(timer_fom)) {
+			m0_fom_phase_set(fom,
+					 FDMI_SRC_DOCK_TIMER_FOM_PHASE_STORE);
+			return M0_RC(M0_FSO_AGAIN);
+		}
+		sd_timer_arm(timer_fom);
+		return M0_RC(M0_FSO_WAIT);
+	case FDMI_SRC_DOCK_TIMER_FOM_PHASE_STORE:
+		if (sd_timer_offset_store(timer_fom))
+			sd_timer_arm(timer_fom);
 		return M0_RC(M0_FSO_WAIT);
 	}
 	return M0_RC(M0_FSO_WAIT);
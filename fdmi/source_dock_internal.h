@@ -64,6 +64,42 @@ M0_TL_DECLARE(fdmi_record_list, M0_EXTERN, struct m0_fdmi_src_rec);
 M0_TL_DESCR_DECLARE(fdmi_matched_filter_list, M0_EXTERN);
 M0_TL_DECLARE(fdmi_matched_filter_list, M0_EXTERN, struct m0_conf_fdmi_filter);
 
+enum {
+	/** Maximal number of records sent to a plugin in one fop */
+	FDMI_SD_BATCH_NR       = 32,
+	/**
+	 * Number of records in flight to a plugin until the plugin dock
+	 * announces its window.
+	 */
+	FDMI_SD_WINDOW_DEFAULT = 4 * FDMI_SD_BATCH_NR
+};
+
+struct fdmi_sd_plugin;
+
+/** Records collected to be sent to a plugin in one m0_fop_fdmi_rec_batch */
+struct fdmi_sd_batch {
+	struct fdmi_sd_plugin  *sb_plugin;
+	struct m0_fop          *sb_fop;
+	uint32_t                sb_nr;
+	struct m0_fdmi_src_rec *sb_recs[FDMI_SD_BATCH_NR];
+};
+
+/**
+ * Plugin endpoint records are sent to. Created on the first record sent to
+ * the endpoint and kept until the source dock FOM finishes.
+ */
+struct fdmi_sd_plugin {
+	uint64_t              sp_magic;
+	struct m0_tlink       sp_linkage;
+	char                 *sp_ep;
+	/** Number of records sent in batches not replied yet. */
+	uint32_t              sp_inflight;
+	/** Window announced in the last batch reply. */
+	uint32_t              sp_window;
+	/** Batch being filled, or held until the window allows to send it. */
+	struct fdmi_sd_batch *sp_batch;
+};
+
 /** FDMI source dock FOM */
 struct fdmi_sd_fom {
 	struct m0_fom           fsf_fom;
@@ -78,6 +114,10 @@ struct fdmi_sd_fom {
 	struct m0_mutex         fsf_pending_fops_lock;
 	struct m0_semaphore     fsf_shutdown;
 	char                   *fsf_client_ep;
+	/** List of fdmi_sd_plugin-s, linked by fdmi_sd_plugin::sp_linkage. */
+	struct m0_tl            fsf_plugins;
+	/** Protects fsf_plugins and fields of its plugins. */
+	struct m0_mutex         fsf_plugins_lock;
 	bool                    fsf_has_records;
 	m0_time_t               fsf_last_checkpoint;
 };
@@ -88,11 +128,24 @@ struct fdmi_rr_fom {
 	struct m0_fom           frf_fom;
 };
 
-/** FDMI source dock timer FOM */
+/**
+ * FDMI source dock timer FOM.
+ *
+ * Besides waking the source dock FOM up, it persists the consumption offset of
+ * the FOL source (m0_fol_fdmi_src_offset()) when it advances. The offset is
+ * stored one period after it is observed: records of transactions logged
+ * concurrently in different localities are not posted in lsn order.
+ */
 struct fdmi_sd_timer_fom {
 	struct m0_fom           fstf_fom;
 	struct m0_fom_timeout   fstf_timeout;
 	struct m0_semaphore     fstf_shutdown;
+	/** Offset observed at the previous alarm. */
+	uint64_t                fstf_lsn_next;
+	/** Offset being stored. */
+	uint64_t                fstf_lsn;
+	/** Last offset stored. */
+	uint64_t                fstf_lsn_stored;
 };
 
 /** FDMI source dock main context */
@@ -149,6 +202,14 @@ struct m0_fdmi_sd_filter_type_handler {
 		(struct m0_fdmi_eval_ctx      *ctx,
 		 struct m0_conf_fdmi_filter   *filter,
 		 struct m0_fdmi_eval_var_info *var_info);
+	/**
+	 * Optional. Returns false if no filter of the type can match the
+	 * record, e.g. the record has no operations the filters look at.
+	 * Called once per record, filters of the type are not evaluated
+	 * for the record then.
+	 */
+	bool                        (*ffth_rec_match)
+		(struct m0_fdmi_src_rec *src_rec);
 };
 
 M0_INTERNAL void m0_fdmi__enqueue(struct m0_fdmi_src_rec *src_rec);
@@ -224,6 +224,84 @@ static void flt_set_op_cb(void)
 	m0_fdmi_eval_fini(&eval_ctx);
 }
 
+/* ------------------------------------------------------------------
+ * Test Case: compiled filters
+ * ------------------------------------------------------------------ */
+
+static int flt_test_var_calls;
+
+static int flt_test_var_get(void                        *user_data,
+			    struct m0_fdmi_flt_var_node *value_desc,
+			    struct m0_fdmi_flt_operand  *value)
+{
+	flt_test_var_calls++;
+	m0_fdmi_flt_uint_opnd_fill(value, *(uint64_t *)user_data);
+	return 0;
+}
+
+static void flt_eval_compiled(void)
+{
+	struct m0_fdmi_eval_var_info var_info = {
+		.get_value_cb = &flt_test_var_get
+	};
+	struct m0_conf_fdmi_filter   filter = {};
+	struct m0_fdmi_eval_ctx      eval_ctx;
+	struct m0_fdmi_flt_node     *root;
+	struct m0_buf                var;
+	uint64_t                     value;
+	int                          rc;
+	int                          i;
+
+	m0_fdmi_eval_init(&eval_ctx);
+	rc = m0_buf_copy(&var, &M0_BUF_INITS("field"));
+	M0_UT_ASSERT(rc == 0);
+	/* (field > 5) OR (3 > 4): the constant subtree is folded. */
+	root = m0_fdmi_flt_op_node_create(
+		M0_FFO_OR,
+		m0_fdmi_flt_op_node_create(M0_FFO_GT,
+					   m0_fdmi_flt_var_node_create(&var),
+					   m0_fdmi_flt_uint_node_create(5)),
+		m0_fdmi_flt_op_node_create(M0_FFO_GT,
+					   m0_fdmi_flt_uint_node_create(3),
+					   m0_fdmi_flt_uint_node_create(4)));
+	m0_fdmi_filter_init(&filter.ff_filter);
+	m0_fdmi_filter_root_set(&filter.ff_filter, root);
+	filter.ff_type = M0_FDMI_FILTER_TYPE_TREE;
+	var_info.user_data = &value;
+
+	for (value = 0; value < 10; value++) {
+		rc = m0_fdmi_eval_flt(&eval_ctx, &filter, &var_info);
+		M0_UT_ASSERT(rc == (value > 5));
+	}
+	M0_UT_ASSERT(flt_test_var_calls == 10);
+	M0_UT_ASSERT(filter.ff_filter.ff_prog != NULL);
+	M0_UT_ASSERT(filter.ff_filter.ff_prog->fp_nr == 5);
+
+	/* Changed operation handlers: the filter is recompiled. */
+	rc = m0_fdmi_eval_add_op_cb(&eval_ctx, M0_FFO_TEST, &flt_test_op_cb);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_fdmi_eval_flt(&eval_ctx, &filter, &var_info);
+	M0_UT_ASSERT(rc == 1);
+	M0_UT_ASSERT(filter.ff_filter.ff_prog->fp_gen == eval_ctx.opers_gen);
+	m0_fdmi_filter_fini(&filter.ff_filter);
+	M0_UT_ASSERT(filter.ff_filter.ff_prog == NULL);
+
+	/* Too deep for the evaluation stack: the tree is interpreted. */
+	root = m0_fdmi_flt_bool_node_create(true);
+	for (i = 0; i < 32; i++)
+		root = m0_fdmi_flt_op_node_create(
+			M0_FFO_OR, m0_fdmi_flt_bool_node_create(false), root);
+	m0_fdmi_filter_init(&filter.ff_filter);
+	m0_fdmi_filter_root_set(&filter.ff_filter, root);
+	for (i = 0; i < 2; i++) {
+		rc = m0_fdmi_eval_flt(&eval_ctx, &filter, &var_info);
+		M0_UT_ASSERT(rc == 1);
+		M0_UT_ASSERT(filter.ff_filter.ff_prog->fp_insn == NULL);
+	}
+	m0_fdmi_filter_fini(&filter.ff_filter);
+	m0_fdmi_eval_fini(&eval_ctx);
+}
+
 /* ------------------------------------------------------------------
  * Test Case: XCode conversions
  * ------------------------------------------------------------------ */
@@ -400,6 +478,7 @@ struct m0_ut_suite fdmi_filter_eval_ut = {
 		{ "simple-or",        flt_eval_simple_or },
 		{ "simple-gt",        flt_eval_simple_gt },
 		{ "callback",         flt_set_op_cb },
+		{ "compiled",         flt_eval_compiled },
 		/** @todo Move to filter tests */
 		{ "filter-xcode-str", flt_eval_flt_xcode_str },
 		{ "filter-str-ops",   flt_str_ops },
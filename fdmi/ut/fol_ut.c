@@ -31,6 +31,7 @@
 #include "fdmi/source_dock.h"
 #include "fdmi/source_dock_internal.h"
 #include "fdmi/fol_fdmi_src.h"
+#include "fdmi/module.h"               /* m0_fdmi_module__get */
 #include "rpc/rpc_opcodes.h"           /* M0_FDMI_RECORD_NOT_OPCODE */
 #include "lib/finject.h"
 
@@ -243,10 +244,14 @@ static void fdmi_fol_test_ops(enum ffs_ut_test_op test_op)
 
 	case FFS_UT_OPS_TEST_BASIC_OPS:
 		/* post record */
+		betx->t_lsn = 10;
+		m0_fdmi_module__get()->fdm_s.fdms_ffs_ctx.ffsc_lsn_posted = 0;
 		m0_fol_fdmi_post_record(&fom);
 		M0_UT_ASSERT(dummy_post_called);
 		m0_sm_asts_run(grp);
 		M0_UT_ASSERT(betx->t_ref == 1);
+		/* The record is not released yet. */
+		M0_UT_ASSERT(m0_fol_fdmi_src_offset() == 10);
 		/* processing start */
 		src_reg->fs_begin(dummy_rec_pointer);
 		/* get value */
@@ -302,6 +307,14 @@ static void fdmi_fol_test_ops(enum ffs_ut_test_op test_op)
 		 * decrement betx->t_ref. Maybe better way to run
 		 * ASTs exist */
 		m0_sm_asts_run(grp);
+		M0_UT_ASSERT(m0_fol_fdmi_src_offset() == 11);
+
+		/* Records consumed before a restart are not posted. */
+		m0_fdmi_module__get()->fdm_s.fdms_ffs_ctx.ffsc_lsn_loaded = 11;
+		dummy_post_called = false;
+		m0_fol_fdmi_post_record(&fom);
+		M0_UT_ASSERT(!dummy_post_called);
+		m0_fdmi_module__get()->fdm_s.fdms_ffs_ctx.ffsc_lsn_loaded = 0;
 
 		/* reset record_post back to orig value */
 		src_reg->fs_record_post = saved_fs_record_post;
@@ -411,6 +411,52 @@ void fdmi_pd_rec_inject_fini(void) {
 	m0_fdmi__plugin_dock_init();
 }
 
+/*----------------------------------------
+  fdmi_pd_batch_window
+  ----------------------------------------*/
+
+void fdmi_pd_batch_window(void)
+{
+	const struct m0_fdmi_pd_ops  *pdo = m0_fdmi_plugin_dock_api_get();
+	struct m0_fop_fdmi_record     recs[2] = {};
+	struct m0_fop_fdmi_rec_batch  batch = {
+		.frb_recs = { .fra_nr = ARRAY_SIZE(recs), .fra_recs = recs }
+	};
+	struct m0_fdmi_record_reg    *rreg;
+	struct m0_fop                *fop;
+	uint32_t                      window = m0_fdmi__pdock_window();
+	int                           i;
+
+	fop = m0_fop_alloc(&m0_fop_fdmi_rec_batch_fopt, &batch, (void*)1);
+	M0_UT_ASSERT(fop != NULL);
+	fop->f_item.ri_rmachine = NULL;
+
+	for (i = 0; i < ARRAY_SIZE(recs); i++) {
+		recs[i].fr_rec_id       = M0_UINT128(0x3333, i);
+		recs[i].fr_rec_type     = M0_FDMI_REC_TYPE_FOL;
+		recs[i].fr_matched_flts = farr;
+		rreg = m0_fdmi__pdock_fdmi_rec_register(fop, &recs[i]);
+		M0_UT_ASSERT(rreg != NULL);
+		M0_UT_ASSERT(rreg->frr_rec == &recs[i]);
+	}
+	/* Registered records are not counted in the window. */
+	M0_UT_ASSERT(m0_fdmi__pdock_window() == window - ARRAY_SIZE(recs));
+	(*pdo->fpo_window_set)(1);
+	M0_UT_ASSERT(m0_fdmi__pdock_window() == 0);
+
+	/* Records without endpoint are freed on release. */
+	for (i = 0; i < ARRAY_SIZE(recs); i++)
+		(*pdo->fpo_release_fdmi_rec)(&recs[i].fr_rec_id, &ffid);
+	M0_UT_ASSERT(m0_fdmi__pdock_window() == 1);
+	for (i = 0; i < ARRAY_SIZE(recs); i++)
+		M0_UT_ASSERT(m0_fdmi__pdock_record_reg_find(
+				     &recs[i].fr_rec_id) == NULL);
+
+	(*pdo->fpo_window_set)(M0_FDMI_PDOCK_WINDOW_DEFAULT);
+	M0_UT_ASSERT(m0_fdmi__pdock_window() == window);
+	m0_free(fop);
+}
+
 /*----------------------------------------
   fdmi_pd_fake_rec_reg
   ----------------------------------------*/
@@ -711,6 +757,7 @@ struct m0_ut_suite fdmi_pd_ut = {
 		{ "fdmi-pd-register-filter",    fdmi_pd_register_filter    },
 		{ "fdmi-pd-fom-norpc",          fdmi_pd_fom_norpc          },
 		{ "fdmi-pd-rec-inject-fini",    fdmi_pd_rec_inject_fini    },
+		{ "fdmi-pd-batch-window",       fdmi_pd_batch_window       },
 		{ "fdmi-pd-fake-release-nomem", fdmi_pd_fake_release_nomem },
 		{ "fdmi-pd-fake-release-rep",   fdmi_pd_fake_release_rep   },
 		{ "fdmi-pd-fake-rec-release",   fdmi_pd_fake_rec_release   },
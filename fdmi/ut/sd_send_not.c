@@ -221,10 +221,15 @@ static struct m0_fdmi_src *src_alloc()
 
 static void check_fop_content(struct m0_rpc_item *item)
 {
-	struct m0_fop_fdmi_record *fdmi_rec;
-	struct m0_buf              buf = M0_BUF_INITS(g_fdmi_data);
-
-	fdmi_rec = m0_fop_data(m0_rpc_item_to_fop(item));
+	struct m0_fop_fdmi_rec_batch *batch;
+	struct m0_fop_fdmi_record    *fdmi_rec;
+	struct m0_buf                 buf = M0_BUF_INITS(g_fdmi_data);
+
+	M0_UT_ASSERT(m0_rpc_item_to_fop(item)->f_type ==
+		     &m0_fop_fdmi_rec_batch_fopt);
+	batch = m0_fop_data(m0_rpc_item_to_fop(item));
+	M0_UT_ASSERT(batch->frb_recs.fra_nr == 1);
+	fdmi_rec = &batch->frb_recs.fra_recs[0];
 
 	M0_UT_ASSERT((void *)fdmi_rec->fr_rec_id.u_lo == &g_src_rec);
 	M0_UT_ASSERT(fdmi_rec->fr_rec_type == M0_FDMI_REC_TYPE_TEST);
@@ -272,6 +272,16 @@ static int fol_rec_encdec(struct m0_fol_rec *rec,
 	return 0;
 }
 
+static int fol_rec_header_pack(struct m0_fol_rec *rec, struct m0_buf *buf)
+{
+	m0_bcount_t             len = buf->b_nob;
+	struct m0_bufvec        bvec = M0_BUFVEC_INIT_BUF(&buf->b_addr, &len);
+	struct m0_bufvec_cursor cur;
+
+	m0_bufvec_cursor_init(&cur, &bvec);
+	return fol_rec_encdec(rec, &cur, M0_XCODE_ENCODE);
+}
+
 static int fol_record_pack(struct m0_fol_rec *rec, struct m0_buf *buf)
 {
 	struct m0_fol_frag     *frag;
@@ -311,21 +321,32 @@ static int fol_record_pack(struct m0_fol_rec *rec, struct m0_buf *buf)
 	return M0_RC(rc);
 }
 
+M0_INTERNAL m0_bcount_t m0_fol_rec_encoded_size(struct m0_fol_rec *rec)
+{
+	rec->fr_header.rh_frags_nr = m0_rec_frag_tlist_length(&rec->fr_frags);
+	return fol_record_pack_size(rec);
+}
+
 M0_INTERNAL int m0_fol_rec_encode(struct m0_fol_rec *rec, struct m0_buf *at)
 {
 	struct m0_fol_rec_header *h = &rec->fr_header;
-	size_t                    size;
+	m0_bcount_t               nob = at->b_nob;
+	int                       rc;
 
 	h->rh_magic = M0_FOL_REC_MAGIC;
 	h->rh_frags_nr = m0_rec_frag_tlist_length(&rec->fr_frags);
-
-	size = fol_record_pack_size(rec);
-	M0_ASSERT(M0_IS_8ALIGNED(size));
-	M0_ASSERT(size <= at->b_nob);
-
-	h->rh_data_len = size;
-
-	return fol_record_pack(rec, at);
+	/*
+	 * The record is encoded in a single pass, without computing its size
+	 * first. The header has fixed size, so it is re-encoded in place once
+	 * the length of the record is known.
+	 */
+	h->rh_data_len = 0;
+	rc = fol_record_pack(rec, at);
+	if (rc != 0)
+		return M0_ERR(rc);
+	h->rh_data_len = m0_align(at->b_nob, 8);
+	M0_ASSERT(h->rh_data_len <= nob);
+	return M0_RC(fol_rec_header_pack(rec, at));
 }
 
 M0_INTERNAL int m0_fol_rec_decode(struct m0_fol_rec *rec, struct m0_buf *at)
@@ -64,6 +64,9 @@
    m0_fol_rec_encode() is used to compose FOL record from FOL record descriptor
    and fragments. It encodes the FOL record fragments in the list
    m0_fol_rec:fr_frags in a buffer, which then will be added into the BE log.
+   The record is encoded in place, directly into the BE tx payload. It is not
+   generated at all for transactions opened while nothing consumes FOL
+   records, see m0_fom_fol_is_needed().
 
    @see m0_fol_rec_encode()
    @see m0_fol_rec_decode()
@@ -221,6 +224,13 @@ M0_INTERNAL void m0_fol_rec_fini(struct m0_fol_rec *rec);
  */
 M0_INTERNAL int m0_fol_rec_encode(struct m0_fol_rec *rec, struct m0_buf *at);
 
+/**
+ * Returns the size of the buffer m0_fol_rec_encode() needs for the record.
+ * The encoding is traversed, so it is only worth calling when the buffer is
+ * allocated for the record, not for the preallocated BE tx payload.
+ */
+M0_INTERNAL m0_bcount_t m0_fol_rec_encoded_size(struct m0_fol_rec *rec);
+
 /**
    Decodes a record into @rec from the specified buffer @at.
 
@@ -106,6 +106,7 @@ static void test_fol_frag_encdec(void)
 	struct m0_fol_frag *dec_frag;
 	struct m0_fol_frag  ut_rec_frag = {};
 	struct m0_buf      *buf         = &g_tx.t_payload;
+	m0_bcount_t         size;
 	int                 rc;
 
 	m0_fol_rec_init(&g_rec, &g_fol);
@@ -117,9 +118,12 @@ static void test_fol_frag_encdec(void)
 	m0_fol_frag_init(&ut_rec_frag, rec, &ut_frag_type);
 	m0_fol_frag_add(&g_rec, &ut_rec_frag);
 
+	size = m0_fol_rec_encoded_size(&g_rec);
 	/* Note, this function sets actual tx payload size for the buf. */
 	rc = m0_fol_rec_encode(&g_rec, buf);
 	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(g_rec.fr_header.rh_data_len == size);
+	M0_UT_ASSERT(buf->b_nob <= size);
 
 	m0_fol_rec_fini(&g_rec);
 
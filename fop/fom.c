@@ -53,6 +53,11 @@
 #include "fdmi/fol_fdmi_src.h"
 #include "motr/iem.h"
 
+#ifndef __KERNEL__
+#include <ucontext.h>                 /* makecontext, swapcontext */
+#include <sys/mman.h>                 /* mmap, mprotect */
+#endif
+
 /**
  * @addtogroup fom
  *
@@ -130,6 +135,40 @@
  * Thread state transitions, associated lists and counters are protected by
  * the group mutex.
  *
+ * <b>Scheduling classes</b>
+ *
+ * The run-queue of a locality is split by scheduling class
+ * (enum m0_fom_prio, m0_fom_locality::fl_runq[]). fom_dequeue() serves the
+ * highest non-empty class, except that a class passed over
+ * M0_FOM_PRIO_AGE_NR times in a row, or a class whose first fom has an
+ * expired deadline, goes first. Within a class foms with deadlines precede
+ * the others in deadline order (fom_enqueue()), the rest is FIFO.
+ *
+ * <b>Work sharing</b>
+ *
+ * A handler thread never releases the group lock of its locality while it
+ * has work to do, so an idle locality cannot take foms from the run-queue of
+ * a busy one. Instead, the busy locality gives them away. A handler thread
+ * going to sleep with an empty run-queue sets m0_fom_locality::fl_hungry. A
+ * handler whose run-queue is at least m0_fom_shed_set() long looks for a
+ * hungry locality before each phase transition (fom_shed()), claims it by
+ * clearing the flag, and moves to it a fom that has not executed any phase
+ * transition yet and whose type is locality-agnostic
+ * (m0_fom_type::ft_loc_agnostic). The fom is removed from the run-queue
+ * under the lock of its old group and is added to the run-queue of the new
+ * one by the adoptit() AST under the lock of the new group, so the fom is
+ * always protected by the group of m0_fom::fo_loc. The run-queue length of
+ * the sharing locality is recorded in m0_fom_locality::fl_shed_counter.
+ *
+ * <b>Locality placement</b>
+ *
+ * Each locality is confined to a single processor. The processors are taken
+ * from the online ones allowed by the process core mask and are selected and
+ * ordered by loc_place() according to m0_fom_placement_set(), using the
+ * topology reported by m0_processor_describe(): SMT siblings share
+ * m0_processor_descr::pd_pipeline. Locality indices do not have to match
+ * processor ids, m0_fom_domain::fd_cpu_loc maps one to the other.
+ *
  * @{
  */
 
@@ -138,6 +177,15 @@ enum {
 	HUNG_FOP_SEC_PERIOD   = 5,
 	HUNG_FOP_TIME_SEC_MAX = 2*60,
 	HUNG_FOP_TIME_SEC_IEM = 5*60,
+	/** Maximal number of run-queue foms scanned by fom_shed(). */
+	SHED_SCAN_NR          = 16,
+	/**
+	 * Size of the stack of a stackful fom, without the guard page below
+	 * it.
+	 */
+	FOM_STACK_SIZE        = 256 << 10,
+	/** Maximal number of free stacks kept by a locality. */
+	FOM_STACK_CACHE_NR    = 64,
 };
 
 /**
@@ -201,6 +249,9 @@ static void hung_foms_notify(struct m0_locality_chore *chore,
 static struct m0_sm_conf fom_states_conf0;
 M0_INTERNAL struct m0_sm_conf fom_states_conf;
 
+/** Run-queue length starting from which foms are shared, 0 to disable. */
+static uint32_t fom_shed_min = 0;
+
 /**
  * Fom domain operations.
  * @todo Support fom timeout functionality.
@@ -233,7 +284,8 @@ M0_INTERNAL bool m0_fom_group_is_locked(const struct m0_fom *fom)
 
 static bool is_in_runq(const struct m0_fom *fom)
 {
-	return runq_tlist_contains(&fom->fo_loc->fl_runq, fom);
+	return m0_exists(i, M0_FOM_PRIO_NR,
+			 runq_tlist_contains(&fom->fo_loc->fl_runq[i], fom));
 }
 
 static bool is_in_wail(const struct m0_fom *fom)
@@ -268,14 +320,17 @@ M0_INTERNAL bool m0_locality_invariant(const struct m0_fom_locality *loc)
 	return
 		_0C(loc != NULL && loc->fl_dom != NULL) &&
 		_0C(m0_mutex_is_locked(&loc->fl_group.s_lock)) &&
-		_0C(M0_CHECK_EX(m0_tlist_invariant(&runq_tl, &loc->fl_runq))) &&
+		_0C(M0_CHECK_EX(m0_forall(i, M0_FOM_PRIO_NR,
+				m0_tlist_invariant(&runq_tl,
+						   &loc->fl_runq[i])))) &&
 		_0C(M0_CHECK_EX(m0_tlist_invariant(&wail_tl, &loc->fl_wail))) &&
 		_0C(m0_tl_forall(thr, t, &loc->fl_threads,
 			     t->lt_loc == loc && thread_invariant(t))) &&
 		_0C(ergo(loc->fl_handler != NULL,
 		     thr_tlist_contains(&loc->fl_threads, loc->fl_handler))) &&
-		_0C(M0_CHECK_EX(m0_tl_forall(runq, fom, &loc->fl_runq,
-					 fom->fo_loc == loc))) &&
+		_0C(M0_CHECK_EX(m0_forall(i, M0_FOM_PRIO_NR,
+				m0_tl_forall(runq, fom, &loc->fl_runq[i],
+					     fom->fo_loc == loc)))) &&
 		_0C(M0_CHECK_EX(m0_tl_forall(wail, fom, &loc->fl_wail,
 					 fom->fo_loc == loc)));
 }
@@ -407,22 +462,56 @@ static bool fom_wait_time_is_out(const struct m0_fom_domain *dom,
 }
 
 /**
- * Enqueues fom into locality runq list and increments
+ * Returns the accounting of the fom type in the locality of the fom,
+ * allocating it on the first call. Returns NULL if the allocation fails.
+ */
+static struct m0_fom_type_stats *fom_type_stats(struct m0_fom *fom)
+{
+	struct m0_fom_locality   *loc = fom->fo_loc;
+	const struct m0_fom_type *ft  = fom->fo_type;
+	struct m0_fom_type_stats *st;
+	uint32_t                  nr;
+
+	if (ft->ft_id >= M0_OPCODES_NR)
+		return NULL;
+	st = loc->fl_type_stats[ft->ft_id];
+	if (st == NULL) {
+		nr = ft->ft_conf.scf_nr_states;
+		st = m0_alloc(sizeof *st + nr * sizeof st->fts_phase[0]);
+		if (st != NULL) {
+			st->fts_phase_nr = nr;
+			/* Readers access the array without the lock. */
+			m0_mb();
+			loc->fl_type_stats[ft->ft_id] = st;
+		}
+	}
+	return st;
+}
+
+/**
+ * Enqueues fom into the locality runq list of its class and increments
  * number of items in runq, m0_fom_locality::fl_runq_nr.
- * This function is invoked when a new fom is submitted for
- * execution or a waiting fom is re-scheduled for processing.
+ *
+ * Foms with deadlines are kept at the head of the list, in deadline order.
  *
  * @post m0_fom_invariant(fom)
  */
-static void fom_ready(struct m0_fom *fom)
-{
-	struct m0_fom_locality *loc;
-	bool                    empty;
-
-	fom_state_set(fom, M0_FOS_READY);
-	loc = fom->fo_loc;
-	empty = runq_tlist_is_empty(&loc->fl_runq);
-	runq_tlist_add_tail(&loc->fl_runq, fom);
+static void fom_enqueue(struct m0_fom *fom)
+{
+	struct m0_fom_locality *loc   = fom->fo_loc;
+	struct m0_tl           *list  = &loc->fl_runq[fom->fo_prio];
+	bool                    empty = loc->fl_runq_nr == 0;
+	struct m0_fom          *next;
+
+	M0_PRE(IS_IN_ARRAY(fom->fo_prio, loc->fl_runq));
+
+	next = fom->fo_deadline == 0 ? NULL :
+		m0_tl_find(runq, f, list, f->fo_deadline == 0 ||
+			   f->fo_deadline > fom->fo_deadline);
+	if (next != NULL)
+		runq_tlist_add_before(next, fom);
+	else
+		runq_tlist_add_tail(list, fom);
 	M0_CNT_INC(loc->fl_runq_nr);
 	m0_addb2_hist_mod(&loc->fl_runq_counter, loc->fl_runq_nr);
 	if (empty)
@@ -430,9 +519,23 @@ static void fom_ready(struct m0_fom *fom)
 	M0_POST(m0_fom_invariant(fom));
 }
 
+/**
+ * Moves fom to M0_FOS_READY and enqueues it.
+ * This function is invoked when a new fom is submitted for
+ * execution or a waiting fom is re-scheduled for processing.
+ */
+static void fom_ready(struct m0_fom *fom)
+{
+	fom_state_set(fom, M0_FOS_READY);
+	fom_enqueue(fom);
+}
+
 M0_INTERNAL void m0_fom_ready(struct m0_fom *fom)
 {
-	struct m0_fom_locality *loc = fom->fo_loc;
+	struct m0_fom_locality   *loc   = fom->fo_loc;
+	struct m0_fom_type_stats *st    = fom_type_stats(fom);
+	m0_time_t                 start = fom->fo_sm_state.sm_state_epoch;
+	int                       phase = m0_fom_phase(fom);
 
 	M0_PRE(m0_fom_invariant(fom));
 
@@ -440,6 +543,11 @@ M0_INTERNAL void m0_fom_ready(struct m0_fom *fom)
 	M0_CNT_DEC(loc->fl_wail_nr);
 	m0_addb2_hist_mod(&loc->fl_wail_counter, loc->fl_wail_nr);
 	fom_ready(fom);
+	if (st != NULL && phase < st->fts_phase_nr) {
+		st->fts_phase[phase].fps_wait_nr++;
+		st->fts_phase[phase].fps_wait +=
+			m0_time_sub(fom->fo_sm_state.sm_state_epoch, start);
+	}
 }
 
 static void readyit(struct m0_sm_group *grp, struct m0_sm_ast *ast)
@@ -516,6 +624,89 @@ static void queueit(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 	fom_ready(fom);
 }
 
+/**
+ * Adds a fom handed over by fom_shed() to the run-queue of its new locality.
+ */
+static void adoptit(struct m0_sm_group *grp, struct m0_sm_ast *ast)
+{
+	struct m0_fom *fom = container_of(ast, struct m0_fom, fo_cb.fc_ast);
+
+	M0_PRE(grp == &fom->fo_loc->fl_group);
+	M0_PRE(fom_state(fom) == M0_FOS_READY);
+
+	fom->fo_sm_phase.sm_grp = grp;
+	fom->fo_sm_state.sm_grp = grp;
+	fom->fo_sm_state.sm_addb2_stats =
+		m0_locality_data(fom_states_conf.scf_addb2_key - 1);
+	m0_fom_locality_inc(fom);
+	m0_atomic64_dec(&fom->fo_service->rs_fom_queued);
+	fom_enqueue(fom);
+}
+
+static bool fom_is_sheddable(const struct m0_fom *fom)
+{
+	return fom->fo_type->ft_loc_agnostic && fom->fo_transitions == 0 &&
+		fom->fo_pending == NULL &&
+		m0_fom_phase(fom) == M0_FOM_PHASE_INIT;
+}
+
+/**
+ * Hands a fresh fom of a locality-agnostic type over to a hungry locality,
+ * if the run-queue of loc is long enough. See the "Work sharing" section.
+ */
+static void fom_shed(struct m0_fom_locality *loc)
+{
+	struct m0_fom_domain   *dom = loc->fl_dom;
+	struct m0_fom_locality *tgt = NULL;
+	struct m0_fom          *fom;
+	size_t                  nr  = dom->fd_localities_nr;
+	size_t                  i;
+	int                     scan;
+
+	if (fom_shed_min == 0 || loc->fl_runq_nr < fom_shed_min)
+		return;
+	for (i = 0, scan = 0, fom = NULL;
+	     i < M0_FOM_PRIO_NR && scan < SHED_SCAN_NR; ++i) {
+		m0_tl_for(runq, &loc->fl_runq[i], fom) {
+			if (fom_is_sheddable(fom) || ++scan == SHED_SCAN_NR)
+				break;
+		} m0_tl_endfor;
+		if (fom != NULL && fom_is_sheddable(fom))
+			break;
+	}
+	if (fom == NULL || !fom_is_sheddable(fom))
+		return;
+	for (i = 1; i < nr; ++i) {
+		tgt = dom->fd_localities[(loc->fl_idx + i) % nr];
+		if (!tgt->fl_shutdown &&
+		    ergo(fom->fo_type->ft_nic_affine && dom->fd_nic_nr > 0,
+			 tgt->fl_idx < dom->fd_nic_nr) &&
+		    m0_atomic64_cas(&tgt->fl_hungry, 1, 0))
+			break;
+	}
+	if (i == nr)
+		return;
+	runq_tlist_del(fom);
+	M0_CNT_DEC(loc->fl_runq_nr);
+	m0_addb2_hist_mod(&loc->fl_runq_counter, loc->fl_runq_nr);
+	m0_addb2_hist_mod(&loc->fl_shed_counter, loc->fl_runq_nr);
+	/*
+	 * Keep the fom accounted as queued while it is in neither locality,
+	 * see m0_reqh_idle_wait_for().
+	 */
+	m0_atomic64_inc(&fom->fo_service->rs_fom_queued);
+	(void)m0_fom_locality_dec(fom);
+	fom->fo_loc = tgt;
+	fom->fo_loc_idx = tgt->fl_idx;
+	fom->fo_cb.fc_ast.sa_cb = &adoptit;
+	m0_sm_ast_post(&tgt->fl_group, &fom->fo_cb.fc_ast);
+}
+
+M0_INTERNAL void m0_fom_shed_set(uint32_t runq_min)
+{
+	fom_shed_min = runq_min;
+}
+
 static void thr_addb2_enter(struct m0_loc_thread *thr,
 			    struct m0_fom_locality *loc)
 {
@@ -626,7 +817,232 @@ M0_INTERNAL void m0_fom_block_leave(struct m0_fom *fom)
 	M0_ASSERT(m0_locality_invariant(loc));
 }
 
-M0_INTERNAL void m0_fom_queue(struct m0_fom *fom)
+#ifndef __KERNEL__
+
+/**
+ * Stack of a stackful fom.
+ *
+ * fs_ctx runs fom_co_main(), which calls m0_fom_ops::fo_tick() of fs_fom and
+ * switches back to fs_caller, that is, to fom_co_tick(), when the tick
+ * returns or the fom yields in m0_fom_co_wait(). A free stack stays parked in
+ * fom_co_main() and the next fom to use it is ticked by the same loop.
+ */
+struct m0_fom_stack {
+	ucontext_t       fs_ctx;
+	ucontext_t       fs_caller;
+	struct m0_fom   *fs_fom;
+	/** Result of the last tick, M0_FSO_WAIT when yielded. */
+	int              fs_rc;
+	/** True iff fs_fom waits in m0_fom_co_wait(). */
+	bool             fs_yielded;
+	/** Mapping of the stack, starting with a PROT_NONE guard page. */
+	void            *fs_mem;
+	size_t           fs_size;
+	/** Linkage into m0_fom_locality::fl_stacks. */
+	struct m0_tlink  fs_linkage;
+	uint64_t         fs_magix;
+};
+
+M0_TL_DESCR_DEFINE(stk, "fom stack", static, struct m0_fom_stack, fs_linkage,
+		   fs_magix, M0_FOM_STACK_MAGIC, M0_FOM_STACK_HEAD_MAGIC);
+M0_TL_DEFINE(stk, static, struct m0_fom_stack);
+
+/*
+ * makecontext(3) passes int arguments only, the stack pointer is split in two
+ * halves, as in desim/sim.c.
+ */
+static void fom_co_main(int p0, int p1)
+{
+	struct m0_fom_stack *stk = (void *)(((uint64_t)(uint32_t)p1 << 32) |
+					    (uint32_t)p0);
+
+	while (1) {
+		stk->fs_rc = stk->fs_fom->fo_ops->fo_tick(stk->fs_fom);
+		(void)swapcontext(&stk->fs_ctx, &stk->fs_caller);
+	}
+}
+
+static void fom_stack_free(struct m0_fom_stack *stk)
+{
+	stk_tlink_fini(stk);
+	munmap(stk->fs_mem, stk->fs_size);
+	m0_free(stk);
+}
+
+static struct m0_fom_stack *fom_stack_get(struct m0_fom_locality *loc)
+{
+	struct m0_fom_stack *stk = stk_tlist_pop(&loc->fl_stacks);
+	size_t               guard;
+	uint64_t             p;
+
+	if (stk != NULL) {
+		M0_CNT_DEC(loc->fl_stacks_nr);
+		return stk;
+	}
+	M0_ALLOC_PTR(stk);
+	if (stk == NULL)
+		return NULL;
+	/*
+	 * The stack grows down: an overflow hits the guard page and faults
+	 * instead of silently corrupting the memory below the stack.
+	 */
+	guard = m0_pagesize_get();
+	stk->fs_size = FOM_STACK_SIZE + guard;
+	stk->fs_mem  = mmap(NULL, stk->fs_size, PROT_READ | PROT_WRITE,
+			    MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+	if (stk->fs_mem == MAP_FAILED) {
+		m0_free(stk);
+		return NULL;
+	}
+	if (mprotect(stk->fs_mem, guard, PROT_NONE) != 0 ||
+	    getcontext(&stk->fs_ctx) != 0) {
+		munmap(stk->fs_mem, stk->fs_size);
+		m0_free(stk);
+		return NULL;
+	}
+	stk->fs_ctx.uc_stack.ss_sp   = (char *)stk->fs_mem + guard;
+	stk->fs_ctx.uc_stack.ss_size = FOM_STACK_SIZE;
+	stk->fs_ctx.uc_link          = NULL;
+	p = (uint64_t)stk;
+	makecontext(&stk->fs_ctx, (void (*)(void))&fom_co_main, 2,
+		    (int)(uint32_t)p, (int)(uint32_t)(p >> 32));
+	stk_tlink_init(stk);
+	return stk;
+}
+
+static void fom_stack_put(struct m0_fom_locality *loc,
+			  struct m0_fom_stack *stk)
+{
+	stk->fs_fom = NULL;
+	if (loc->fl_stacks_nr < FOM_STACK_CACHE_NR) {
+		stk_tlist_add(&loc->fl_stacks, stk);
+		M0_CNT_INC(loc->fl_stacks_nr);
+	} else
+		fom_stack_free(stk);
+}
+
+/**
+ * Executes a phase transition of a stackful fom on its stack, or resumes the
+ * transition that yielded. The stack is returned to the pool when the
+ * transition completes.
+ */
+static int fom_co_tick(struct m0_fom *fom)
+{
+	struct m0_fom_stack *stk = fom->fo_stack;
+	int                  rc;
+
+	if (stk == NULL) {
+		stk = fom_stack_get(fom->fo_loc);
+		if (stk == NULL)
+			/* No memory: run on the thread stack, no yields. */
+			return fom->fo_ops->fo_tick(fom);
+		stk->fs_fom = fom;
+		fom->fo_stack = stk;
+	}
+	rc = swapcontext(&stk->fs_caller, &stk->fs_ctx);
+	M0_ASSERT(rc == 0);
+	rc = stk->fs_rc;
+	if (!stk->fs_yielded) {
+		fom->fo_stack = NULL;
+		fom_stack_put(fom->fo_loc, stk);
+	}
+	return rc;
+}
+
+static void fom_co_yield(struct m0_fom *fom)
+{
+	struct m0_fom_stack *stk = fom->fo_stack;
+	int                  rc;
+
+	M0_PRE(stk != NULL && stk->fs_fom == fom);
+
+	stk->fs_rc = M0_FSO_WAIT;
+	stk->fs_yielded = true;
+	rc = swapcontext(&stk->fs_ctx, &stk->fs_caller);
+	M0_ASSERT(rc == 0);
+	stk->fs_yielded = false;
+}
+
+static void loc_stacks_init(struct m0_fom_locality *loc)
+{
+	stk_tlist_init(&loc->fl_stacks);
+	loc->fl_stacks_nr = 0;
+}
+
+static void loc_stacks_fini(struct m0_fom_locality *loc)
+{
+	struct m0_fom_stack *stk;
+
+	m0_tl_teardown(stk, &loc->fl_stacks, stk) {
+		M0_CNT_DEC(loc->fl_stacks_nr);
+		fom_stack_free(stk);
+	}
+	stk_tlist_fini(&loc->fl_stacks);
+}
+
+static int fom_tick(struct m0_fom *fom)
+{
+	return fom->fo_type->ft_stackful ? fom_co_tick(fom) :
+		fom->fo_ops->fo_tick(fom);
+}
+
+#else /* __KERNEL__ */
+
+static void loc_stacks_init(struct m0_fom_locality *loc)
+{
+}
+
+static void loc_stacks_fini(struct m0_fom_locality *loc)
+{
+}
+
+static int fom_tick(struct m0_fom *fom)
+{
+	return fom->fo_ops->fo_tick(fom);
+}
+
+#endif /* __KERNEL__ */
+
+M0_INTERNAL void m0_fom_co_wait(struct m0_fom *fom, struct m0_chan *chan)
+{
+	/* Channels guarded by the group lock stay locked by the handler. */
+	bool            own = chan->ch_guard != &fom->fo_loc->fl_group.s_lock;
+	struct m0_clink clink;
+
+	M0_PRE(m0_chan_is_locked(chan));
+	M0_PRE(fom_state(fom) == M0_FOS_RUNNING);
+	M0_PRE(fom->fo_cb.fc_state == M0_FCS_DONE);
+
+#ifndef __KERNEL__
+	if (fom->fo_stack != NULL) {
+		m0_fom_wait_on(fom, chan, &fom->fo_cb);
+		if (own)
+			m0_chan_unlock(chan);
+		fom_co_yield(fom);
+		if (own)
+			m0_chan_lock(chan);
+		return;
+	}
+#endif
+	m0_clink_init(&clink, NULL);
+	m0_clink_add(chan, &clink);
+	if (own)
+		m0_chan_unlock(chan);
+	m0_fom_block_enter(fom);
+	m0_chan_wait(&clink);
+	m0_fom_block_leave(fom);
+	if (own)
+		m0_chan_lock(chan);
+	m0_clink_del(&clink);
+	m0_clink_fini(&clink);
+}
+
+/**
+ * Assigns the fom to its home locality.
+ *
+ * Returns false if the fom was finalised because its service is stopped.
+ */
+static bool fom_queue_prepare(struct m0_fom *fom)
 {
 	struct m0_fom_domain *dom;
 	size_t                loc_idx;
@@ -637,7 +1053,9 @@ M0_INTERNAL void m0_fom_queue(struct m0_fom *fom)
 					      fom->fo_rep_fop);
 
 	dom = m0_fom_dom();
-	loc_idx = fom->fo_ops->fo_home_locality(fom) % dom->fd_localities_nr;
+	loc_idx = fom->fo_ops->fo_home_locality(fom) %
+		(fom->fo_type->ft_nic_affine && dom->fd_nic_nr > 0 ?
+		 dom->fd_nic_nr : dom->fd_localities_nr);
 	M0_ASSERT(loc_idx < dom->fd_localities_nr);
 	fom->fo_loc = dom->fd_localities[loc_idx];
 	fom->fo_loc_idx = loc_idx;
@@ -648,11 +1066,74 @@ M0_INTERNAL void m0_fom_queue(struct m0_fom *fom)
 		m0_fom_phase_set(fom, M0_FOM_PHASE_FINISH);
 		m0_fom_fini(fom);
 		M0_LEAVE("Service is already stopped, fom:%p", fom);
-		return;
+		return false;
 	}
 	m0_atomic64_inc(&fom->fo_service->rs_fom_queued);
 	fom->fo_cb.fc_ast.sa_cb = &queueit;
-	m0_sm_ast_post(&fom->fo_loc->fl_group, &fom->fo_cb.fc_ast);
+	M0_LEAVE();
+	return true;
+}
+
+M0_INTERNAL void m0_fom_prio_set(struct m0_fom *fom, enum m0_fom_prio prio)
+{
+	M0_PRE(M0_IN(prio, (M0_FOM_PRIO_NORMAL, M0_FOM_PRIO_HIGH,
+			    M0_FOM_PRIO_LOW)));
+	fom->fo_prio = prio;
+}
+
+M0_INTERNAL void m0_fom_deadline_set(struct m0_fom *fom, m0_time_t deadline)
+{
+	fom->fo_deadline = deadline;
+}
+
+M0_INTERNAL void m0_fom_queue(struct m0_fom *fom)
+{
+	if (fom_queue_prepare(fom))
+		m0_sm_ast_post(&fom->fo_loc->fl_group, &fom->fo_cb.fc_ast);
+}
+
+M0_INTERNAL void m0_fom_batch_init(struct m0_fom_batch *batch)
+{
+	M0_SET0(batch);
+}
+
+M0_INTERNAL void m0_fom_batch_add(struct m0_fom_batch *batch,
+				  struct m0_fom *fom)
+{
+	struct m0_sm_ast *ast = &fom->fo_cb.fc_ast;
+	uint32_t          i;
+
+	M0_PRE(batch->fb_nr <= ARRAY_SIZE(batch->fb_loc));
+
+	if (!fom_queue_prepare(fom))
+		return;
+	for (i = 0; i < batch->fb_nr; ++i) {
+		if (batch->fb_loc[i].fbl_loc == fom->fo_loc)
+			break;
+	}
+	if (i == ARRAY_SIZE(batch->fb_loc)) {
+		m0_sm_ast_post(&fom->fo_loc->fl_group, ast);
+		return;
+	}
+	M0_ASSERT(ast->sa_next == NULL);
+	if (i == batch->fb_nr) {
+		batch->fb_loc[i].fbl_loc  = fom->fo_loc;
+		batch->fb_loc[i].fbl_head = ast;
+		++batch->fb_nr;
+	} else
+		batch->fb_loc[i].fbl_tail->sa_next = ast;
+	batch->fb_loc[i].fbl_tail = ast;
+}
+
+M0_INTERNAL void m0_fom_batch_flush(struct m0_fom_batch *batch)
+{
+	uint32_t i;
+
+	for (i = 0; i < batch->fb_nr; ++i)
+		m0_sm_ast_chain_post(&batch->fb_loc[i].fbl_loc->fl_group,
+				     batch->fb_loc[i].fbl_head,
+				     batch->fb_loc[i].fbl_tail);
+	m0_fom_batch_init(batch);
 }
 
 /**
@@ -796,16 +1277,32 @@ static void *cb_next(struct m0_fom_callback *cb)
  */
 static void fom_exec(struct m0_fom *fom)
 {
-	int			rc;
-	struct m0_fom_locality *loc;
+	int			  rc;
+	struct m0_fom_locality   *loc;
+	struct m0_fom_type_stats *st    = fom_type_stats(fom);
+	m0_time_t                 start = fom->fo_sm_state.sm_state_epoch;
+	m0_time_t                 now;
+	int                       phase;
 
 	loc = fom->fo_loc;
 	fom->fo_thread = loc->fl_handler;
 	fom_state_set(fom, M0_FOS_RUNNING);
+	now = fom->fo_sm_state.sm_state_epoch;
+	if (st != NULL) {
+		st->fts_queue_nr++;
+		st->fts_queue += m0_time_sub(now, start);
+	}
 	do {
 		M0_ASSERT(m0_fom_invariant(fom));
 		M0_ASSERT(m0_fom_phase(fom) != M0_FOM_PHASE_FINISH);
-		rc = fom->fo_ops->fo_tick(fom);
+		phase = m0_fom_phase(fom);
+		rc = fom_tick(fom);
+		if (st != NULL && phase < st->fts_phase_nr) {
+			start = now;
+			now = m0_time_now();
+			st->fts_phase[phase].fps_run_nr++;
+			st->fts_phase[phase].fps_run += m0_time_sub(now, start);
+		}
 		if (FOM_PHASE_DEBUG) {
 			fom->fo_log[fom->fo_transitions %
 				    ARRAY_SIZE(fom->fo_log)] =
@@ -826,6 +1323,8 @@ static void fom_exec(struct m0_fom *fom)
 	M0_ASSERT(m0_fom_group_is_locked(fom));
 
 	if (m0_fom_phase(fom) == M0_FOM_PHASE_FINISH) {
+		if (st != NULL)
+			st->fts_done++;
 		/*
 		 * Finish fom itself.
 		 */
@@ -863,18 +1362,47 @@ static void fom_exec(struct m0_fom *fom)
 /**
  * Dequeues a fom from runq list of the locality.
  *
+ * Classes are tried from the highest to the lowest. The first non-empty one
+ * is served, unless a lower class has an expired deadline at its head or was
+ * passed over M0_FOM_PRIO_AGE_NR times.
+ *
  * @retval m0_fom if queue is not empty, NULL otherwise
  */
 static struct m0_fom *fom_dequeue(struct m0_fom_locality *loc)
 {
-	struct m0_fom *fom;
-
-	fom = runq_tlist_pop(&loc->fl_runq);
-	if (fom != NULL) {
-		M0_ASSERT(fom->fo_loc == loc);
-		M0_CNT_DEC(loc->fl_runq_nr);
-		m0_addb2_hist_mod(&loc->fl_runq_counter, loc->fl_runq_nr);
+	static const enum m0_fom_prio order[] = {
+		M0_FOM_PRIO_HIGH, M0_FOM_PRIO_NORMAL, M0_FOM_PRIO_LOW
+	};
+	struct m0_fom   *fom;
+	m0_time_t        now  = 0;
+	int              prio = -1;
+	enum m0_fom_prio p;
+	int              i;
+
+	M0_CASSERT(ARRAY_SIZE(order) == M0_FOM_PRIO_NR);
+
+	if (loc->fl_runq_nr == 0)
+		return NULL;
+	for (i = 0; i < ARRAY_SIZE(order); ++i) {
+		p = order[i];
+		fom = runq_tlist_head(&loc->fl_runq[p]);
+		if (fom == NULL)
+			continue;
+		if (prio == -1)
+			prio = p;
+		else if ((fom->fo_deadline != 0 &&
+			  fom->fo_deadline <= (now ?: (now = m0_time_now()))) ||
+			 ++loc->fl_runq_skip[p] >= M0_FOM_PRIO_AGE_NR) {
+			prio = p;
+			break;
+		}
 	}
+	M0_ASSERT(prio != -1);
+	loc->fl_runq_skip[prio] = 0;
+	fom = runq_tlist_pop(&loc->fl_runq[prio]);
+	M0_ASSERT(fom->fo_loc == loc);
+	M0_CNT_DEC(loc->fl_runq_nr);
+	m0_addb2_hist_mod(&loc->fl_runq_counter, loc->fl_runq_nr);
 	return fom;
 }
 
@@ -942,6 +1470,8 @@ static void loc_handler_thread(struct m0_loc_thread *th)
 			M0_ADDB2_IN(M0_AVI_AST, m0_sm_asts_run(&loc->fl_group));
 			M0_ADDB2_IN(M0_AVI_CHORE,
 				    m0_locality_chores_run(&loc->fl_locality));
+			m0_sm_wheel_run(&loc->fl_wheel);
+			fom_shed(loc);
 			fom = fom_dequeue(loc);
 			if (fom != NULL) {
 				fom_addb2_push(fom);
@@ -949,13 +1479,26 @@ static void loc_handler_thread(struct m0_loc_thread *th)
 				m0_addb2_pop(M0_AVI_FOM);
 			} else if (loc->fl_shutdown)
 				break;
-			else
+			else {
+				m0_time_t next;
+
+				next = m0_sm_wheel_next(&loc->fl_wheel);
+				if (fom_shed_min > 0)
+					(void)m0_atomic64_cas(&loc->fl_hungry,
+							      0, 1);
 				/*
 				 * Yes, sleep with the lock held. Knock on
 				 * &loc->fl_runrun or &loc->fl_group.s_clink to
-				 * wake.
+				 * wake. Timers armed on the group can be
+				 * added only by the handler (or while there is
+				 * no handler), so the deadline is up to date.
 				 */
-				m0_chan_wait(clink);
+				if (next == M0_TIME_NEVER)
+					m0_chan_wait(clink);
+				else
+					(void)m0_chan_timedwait(clink, next);
+				(void)m0_atomic64_cas(&loc->fl_hungry, 1, 0);
+			}
 		}
 		loc->fl_handler = NULL;
 		th->lt_state = IDLE;
@@ -1036,6 +1579,7 @@ static void loc_addb2_fini(struct m0_fom_locality *loc)
 static void loc_fini(struct m0_fom_locality *loc)
 {
 	struct m0_loc_thread *th;
+	int                   i;
 
 	loc->fl_shutdown = true;
 	m0_clink_signal(&loc->fl_group.s_clink);
@@ -1051,7 +1595,14 @@ static void loc_fini(struct m0_fom_locality *loc)
 	}
 	group_unlock(loc);
 
-	runq_tlist_fini(&loc->fl_runq);
+	for (i = 0; i < M0_FOM_PRIO_NR; ++i)
+		runq_tlist_fini(&loc->fl_runq[i]);
+	loc_stacks_fini(loc);
+	if (loc->fl_type_stats != NULL) {
+		for (i = 0; i < M0_OPCODES_NR; ++i)
+			m0_free(loc->fl_type_stats[i]);
+		m0_free0(&loc->fl_type_stats);
+	}
 	M0_ASSERT(loc->fl_runq_nr == 0);
 	wail_tlist_fini(&loc->fl_wail);
 	M0_ASSERT(loc->fl_wail_nr == 0);
@@ -1059,6 +1610,7 @@ static void loc_fini(struct m0_fom_locality *loc)
 	M0_ASSERT(m0_atomic64_get(&loc->fl_unblocking) == 0);
 	m0_chan_fini_lock(&loc->fl_idle);
 	m0_chan_fini_lock(&loc->fl_runrun);
+	m0_sm_wheel_fini(&loc->fl_wheel);
 	m0_sm_group_fini(&loc->fl_group);
 	m0_bitmap_fini(&loc->fl_processors);
 	loc_addb2_fini(loc);
@@ -1080,9 +1632,10 @@ static void loc_fini(struct m0_fom_locality *loc)
  * @param idx     index of locality within fom domain
  */
 static int loc_init(struct m0_fom_locality *loc, struct m0_fom_domain *dom,
-		    size_t idx)
+		    size_t idx, uint32_t cpu)
 {
 	int                   res;
+	int                   i;
 	struct m0_addb2_mach *orig = m0_thread_tls()->tls_addb2_mach;
 
 	M0_PRE(loc != NULL);
@@ -1096,7 +1649,10 @@ static int loc_init(struct m0_fom_locality *loc, struct m0_fom_domain *dom,
 		goto err;
 	}
 
-	runq_tlist_init(&loc->fl_runq);
+	for (i = 0; i < M0_FOM_PRIO_NR; ++i) {
+		runq_tlist_init(&loc->fl_runq[i]);
+		loc->fl_runq_skip[i] = 0;
+	}
 	loc->fl_runq_nr = 0;
 	wail_tlist_init(&loc->fl_wail);
 	loc->fl_wail_nr = 0;
@@ -1109,6 +1665,7 @@ static int loc_init(struct m0_fom_locality *loc, struct m0_fom_domain *dom,
 	m0_addb2_hist_add(&loc->fl_fom_active,   1, 30, M0_AVI_FOM_ACTIVE, -1);
 	m0_addb2_hist_add(&loc->fl_runq_counter, 1, 30, M0_AVI_RUNQ, -1);
 	m0_addb2_hist_add(&loc->fl_wail_counter, 1, 30, M0_AVI_WAIL, -1);
+	m0_addb2_hist_add(&loc->fl_shed_counter, 1, 30, M0_AVI_FOM_SHED, -1);
 	m0_addb2_hist_add_auto(&loc->fl_grp_addb2.ga_forq_hist, 1000,
 			       M0_AVI_LOCALITY_FORQ, -1);
 	m0_addb2_hist_add_auto(&loc->fl_chan_addb2.ca_wait_hist, 1000,
@@ -1124,17 +1681,23 @@ static int loc_init(struct m0_fom_locality *loc, struct m0_fom_domain *dom,
 			 &loc->fl_group, loc->fl_dom, loc->fl_idx);
 	m0_sm_group_init(&loc->fl_group);
 	loc->fl_group.s_addb2 = &loc->fl_grp_addb2;
+	m0_sm_wheel_init(&loc->fl_wheel, &loc->fl_group);
 	m0_chan_init(&loc->fl_runrun, &loc->fl_group.s_lock);
 	loc->fl_runrun.ch_addb2 = &loc->fl_chan_addb2;
 	thr_tlist_init(&loc->fl_threads);
 	m0_atomic64_set(&loc->fl_unblocking, 0);
+	loc->fl_hungry = 0;
+	loc_stacks_init(loc);
 	m0_chan_init(&loc->fl_idle, &loc->fl_group.s_lock);
 
-	res = m0_bitmap_init(&loc->fl_processors, dom->fd_localities_nr);
+	res = m0_bitmap_init(&loc->fl_processors, m0_processor_nr_max());
 	if (res == 0) {
-		int i;
-
-		m0_bitmap_set(&loc->fl_processors, idx, true);
+		M0_ALLOC_ARR(loc->fl_type_stats, M0_OPCODES_NR);
+		if (loc->fl_type_stats == NULL)
+			res = M0_ERR(-ENOMEM);
+	}
+	if (res == 0) {
+		m0_bitmap_set(&loc->fl_processors, cpu, true);
 		/* create a pool of idle threads plus the handler thread. */
 		group_lock(loc);
 		for (i = 0; i < LOC_IDLE_NR + 1; ++i) {
@@ -1159,6 +1722,80 @@ err:
 /*
  * Compose HW core mask with preset mask from instance
  */
+static uint32_t fom_place     = 0;
+static int      fom_place_nic = -1;
+
+/** Processor of a locality, see loc_place(). */
+struct loc_place {
+	uint32_t lp_cpu;
+	uint32_t lp_node;
+	uint32_t lp_core;
+	/** True iff the processor topology is known. */
+	bool     lp_known;
+};
+
+static int loc_place_cmp(const struct loc_place *p0,
+			 const struct loc_place *p1)
+{
+	/* Localities on the node of the network interface go first. */
+	return M0_3WAY((int)p0->lp_node != fom_place_nic,
+		       (int)p1->lp_node != fom_place_nic) ?:
+		M0_3WAY(p0->lp_node, p1->lp_node) ?:
+		M0_3WAY(p0->lp_cpu, p1->lp_cpu);
+}
+
+/*
+ * Selects processors of the localities from cpu_map and orders them
+ * according to fom_place. Returns the number of processors on the node of
+ * the network interface in nic_nr.
+ */
+static int loc_place(const struct m0_bitmap *cpu_map,
+		     struct loc_place **out, size_t *out_nr, size_t *nic_nr)
+{
+	struct m0_processor_descr pd;
+	struct loc_place         *lp;
+	size_t                    nr = 0;
+	size_t                    i;
+	size_t                    j;
+	bool                      numa = (fom_place & M0_FOM_PLACE_NUMA) ||
+					 fom_place_nic >= 0;
+
+	M0_ALLOC_ARR(lp, m0_bitmap_set_nr(cpu_map));
+	if (lp == NULL)
+		return M0_ERR(-ENOMEM);
+	for (i = 0; i < cpu_map->b_nr; ++i) {
+		if (!m0_bitmap_get(cpu_map, i))
+			continue;
+		lp[nr] = (struct loc_place) { .lp_cpu = i };
+		if (m0_processor_describe(i, &pd) == 0) {
+			lp[nr].lp_node  = pd.pd_numa_node;
+			lp[nr].lp_core  = pd.pd_pipeline;
+			lp[nr].lp_known = true;
+		}
+		if ((fom_place & M0_FOM_PLACE_CORE) && lp[nr].lp_known &&
+		    m0_exists(k, nr, lp[k].lp_known &&
+			      lp[k].lp_core == lp[nr].lp_core))
+			continue;
+		++nr;
+	}
+	/* Insertion sort: it is stable and there are few processors. */
+	for (i = 1; numa && i < nr; ++i) {
+		for (j = i; j > 0 && loc_place_cmp(&lp[j - 1], &lp[j]) > 0; --j)
+			M0_SWAP(lp[j - 1], lp[j]);
+	}
+	*out     = lp;
+	*out_nr  = nr;
+	*nic_nr  = m0_count(k, nr, (int)lp[k].lp_node == fom_place_nic);
+	return 0;
+}
+
+M0_INTERNAL void m0_fom_placement_set(uint32_t flags, int nic_node)
+{
+	M0_PRE((flags & ~(M0_FOM_PLACE_CORE | M0_FOM_PLACE_NUMA)) == 0);
+	fom_place     = flags;
+	fom_place_nic = nic_node;
+}
+
 static void core_mask_apply(struct m0_bitmap *onln_cpu_map)
 {
 	struct m0_bitmap *cores;
@@ -1181,12 +1818,55 @@ static void hung_foms_notify(struct m0_locality_chore *chore,
 						    fl_locality);
 	const struct m0_fom_domain *dom = floc->fl_dom;
 
-	(void)m0_tl_forall(runq, fom, &floc->fl_runq,
-			   dom->fd_ops->fdo_time_is_out(dom, fom));
+	int                         i;
+
+	for (i = 0; i < M0_FOM_PRIO_NR; ++i)
+		(void)m0_tl_forall(runq, fom, &floc->fl_runq[i],
+				   dom->fd_ops->fdo_time_is_out(dom, fom));
 	(void)m0_tl_forall(wail, fom, &floc->fl_wail,
 			   dom->fd_ops->fdo_time_is_out(dom, fom));
 }
 
+M0_INTERNAL int m0_fom_domain_type_stats(const struct m0_fom_domain *dom,
+					 uint64_t type_id,
+					 struct m0_fom_type_stats **out)
+{
+	struct m0_fom_type_stats  *sum = NULL;
+	struct m0_fom_type_stats  *st;
+	struct m0_fom_phase_stats *ps;
+	size_t                     i;
+	uint32_t                   j;
+	uint32_t                   nr;
+
+	M0_PRE(type_id < M0_OPCODES_NR);
+
+	for (i = 0; i < dom->fd_localities_nr; ++i) {
+		st = dom->fd_localities[i]->fl_type_stats[type_id];
+		if (st == NULL)
+			continue;
+		if (sum == NULL) {
+			sum = m0_alloc(sizeof *sum + st->fts_phase_nr *
+				       sizeof st->fts_phase[0]);
+			if (sum == NULL)
+				return M0_ERR(-ENOMEM);
+			sum->fts_phase_nr = st->fts_phase_nr;
+		}
+		sum->fts_done     += st->fts_done;
+		sum->fts_queue_nr += st->fts_queue_nr;
+		sum->fts_queue    += st->fts_queue;
+		nr = min32u(sum->fts_phase_nr, st->fts_phase_nr);
+		for (j = 0; j < nr; ++j) {
+			ps = &sum->fts_phase[j];
+			ps->fps_run_nr  += st->fts_phase[j].fps_run_nr;
+			ps->fps_run     += st->fts_phase[j].fps_run;
+			ps->fps_wait_nr += st->fts_phase[j].fps_wait_nr;
+			ps->fps_wait    += st->fts_phase[j].fps_wait;
+		}
+	}
+	*out = sum;
+	return sum != NULL ? 0 : -ENOENT;
+}
+
 M0_INTERNAL int m0_fom_domain_init(struct m0_fom_domain **out)
 {
 	struct m0_fom_domain   *dom;
@@ -1194,8 +1874,10 @@ M0_INTERNAL int m0_fom_domain_init(struct m0_fom_domain **out)
 	int                     result;
 	size_t                  cpu_max;
 	size_t                  cpu_nr;
+	size_t                  nic_nr;
 	size_t                  i;
 	struct m0_bitmap        cpu_map;
+	struct loc_place       *place;
 
 	M0_ENTRY();
 
@@ -1206,14 +1888,25 @@ M0_INTERNAL int m0_fom_domain_init(struct m0_fom_domain **out)
 
 	m0_processors_online(&cpu_map);
 	core_mask_apply(&cpu_map);
-	cpu_nr = m0_bitmap_set_nr(&cpu_map);
+	result = loc_place(&cpu_map, &place, &cpu_nr, &nic_nr);
+	m0_bitmap_fini(&cpu_map);
+	if (result != 0)
+		return M0_ERR(result);
 
 	M0_ALLOC_PTR(dom);
-	if (dom == NULL) {
-		m0_bitmap_fini(&cpu_map);
+	if (dom != NULL)
+		M0_ALLOC_ARR(dom->fd_cpu_loc, cpu_max);
+	if (dom == NULL || dom->fd_cpu_loc == NULL) {
+		m0_free(dom);
+		m0_free(place);
 		return M0_ERR(-ENOMEM);
 	}
 	dom->fd_ops = &m0_fom_dom_ops;
+	dom->fd_nic_nr = nic_nr;
+	for (i = 0; i < cpu_max; ++i)
+		dom->fd_cpu_loc[i] = i % cpu_nr;
+	for (i = 0; i < cpu_nr; ++i)
+		dom->fd_cpu_loc[place[i].lp_cpu] = i;
 
 	result = m0_addb2_sys_init(&dom->fd_addb2_sys,
 				   &(struct m0_addb2_config) {
@@ -1227,11 +1920,10 @@ M0_INTERNAL int m0_fom_domain_init(struct m0_fom_domain **out)
 		if (dom->fd_localities != NULL) {
 			dom->fd_localities_nr = cpu_nr;
 			for (i = 0; i < cpu_nr; ++i) {
-				/* Do not support holes in cpu mask. */
-				M0_ASSERT(m0_bitmap_get(&cpu_map, i));
 				M0_ALLOC_PTR(loc);
 				if (loc != NULL) {
-					result = loc_init(loc, dom, i);
+					result = loc_init(loc, dom, i,
+							  place[i].lp_cpu);
 					if (result == 0)
 						dom->fd_localities[i] = loc;
 					else
@@ -1260,7 +1952,7 @@ M0_INTERNAL int m0_fom_domain_init(struct m0_fom_domain **out)
 		} else
 			result = M0_ERR(-ENOMEM);
 	}
-	m0_bitmap_fini(&cpu_map);
+	m0_free(place);
 	if (result == 0)
 		*out = dom;
 	else {
@@ -1287,6 +1979,7 @@ M0_INTERNAL void m0_fom_domain_fini(struct m0_fom_domain *dom)
 	}
 	if (dom->fd_addb2_sys != NULL)
 		m0_addb2_sys_fini(dom->fd_addb2_sys);
+	m0_free(dom->fd_cpu_loc);
 	m0_free(dom);
 }
 
@@ -1347,6 +2040,7 @@ void m0_fom_fini(struct m0_fom *fom)
 					      fom->fo_rep_fop);
 	M0_PRE(m0_fom_phase(fom) == M0_FOM_PHASE_FINISH);
 	M0_PRE(fom->fo_pending == NULL);
+	M0_PRE(fom->fo_stack == NULL);
 
 	reqh = m0_fom_reqh(fom);
 	fom_state_set(fom, M0_FOS_FINISH);
@@ -1378,6 +2072,7 @@ void m0_fom_fini(struct m0_fom *fom)
 	 * global lock, fom and service finalisations should synchronise
 	 * through an RCU-like mechanism.
 	 */
+	m0_atomic64_dec(&fom->fo_service->rs_fom_active);
 	m0_chan_lock(&reqh->rh_sm_grp.s_chan);
 	if (m0_fom_locality_dec(fom))
 		m0_chan_broadcast(&reqh->rh_sm_grp.s_chan);
@@ -1400,6 +2095,11 @@ void m0_fom_init(struct m0_fom *fom, const struct m0_fom_type *fom_type,
 	fom->fo_ops	    = ops;
 	fom->fo_transitions = 0;
 	fom->fo_local	    = false;
+	fom->fo_refused     = false;
+	fom->fo_prio	    = fom_type->ft_ops != NULL ?
+			      fom_type->ft_ops->fto_prio : M0_FOM_PRIO_NORMAL;
+	fom->fo_deadline    = 0;
+	fom->fo_stack	    = NULL;
 	m0_fom_callback_init(&fom->fo_cb);
 	runq_tlink_init(fom);
 
@@ -1701,6 +2401,7 @@ M0_INTERNAL void m0_fom_sm_init(struct m0_fom *fom)
 		   M0_FOM_PHASE_INIT, fom_group);
 	m0_sm_init(&fom->fo_sm_state, &fom->fo_type->ft_state_conf,
 		   M0_FOS_INIT, fom_group);
+	m0_atomic64_inc(&fom->fo_service->rs_fom_active);
 }
 
 void m0_fom_phase_set(struct m0_fom *fom, int phase)
@@ -1757,6 +2458,15 @@ M0_INTERNAL int m0_fom_fol_rec_add(struct m0_fom *fom)
 	return M0_RC(m0_dtx_fol_add(&fom->fo_tx));
 }
 
+M0_INTERNAL bool m0_fom_fol_is_needed(const struct m0_fom *fom)
+{
+#ifndef __KERNEL__
+	return !fom->fo_local && m0_fol_fdmi_is_needed();
+#else
+	return !fom->fo_local;
+#endif
+}
+
 M0_INTERNAL void m0_fom_fdmi_record_post(struct m0_fom *fom)
 {
 #ifndef __KERNEL__
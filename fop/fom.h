@@ -179,6 +179,21 @@
  * guarantees listed in the "Concurrency" section are upheld for blocking phase
  * transitions.
  *
+ * <b>Stackful foms</b>
+ *
+ * In user space, phase transitions of foms whose type sets
+ * m0_fom_type::ft_stackful run on a stack of their own, taken from a
+ * per-locality pool. Such a phase transition can wait for a channel in the
+ * middle of a call stack with m0_fom_co_wait(): the fom yields, its stack is
+ * kept, the handler thread proceeds with other foms, and the phase transition
+ * is resumed where it stopped when the channel is signalled. No thread is
+ * consumed while waiting. For other foms m0_fom_co_wait() falls back to
+ * m0_fom_block_enter() and m0_fom_block_leave().
+ *
+ * A stackful phase transition must not hold mutexes or addb2 contexts across
+ * m0_fom_co_wait(): it can be resumed by a different handler thread of the
+ * locality.
+ *
  * <b>Locality</b>
  *
  * Request handler partitions resources into "localities" to improve resource
@@ -232,9 +247,75 @@ struct m0_long_lock;
 
 /* defined in fom.c */
 struct m0_loc_thread;
+struct m0_fom_stack;
 
 #define FOM_PHASE_DEBUG (1)
 
+/**
+ * Scheduling class of a fom.
+ *
+ * A locality executes ready foms of a higher class first. A class that was
+ * passed over M0_FOM_PRIO_AGE_NR times in a row is served next, so that
+ * lower classes are not starved.
+ *
+ * @see m0_fom_type_ops::fto_prio, m0_fom_prio_set()
+ */
+enum m0_fom_prio {
+	/** Default class of foms. */
+	M0_FOM_PRIO_NORMAL,
+	/** Latency-sensitive foms, e.g., client metadata requests. */
+	M0_FOM_PRIO_HIGH,
+	/** Background foms, e.g., repair and recovery. */
+	M0_FOM_PRIO_LOW,
+	M0_FOM_PRIO_NR
+};
+
+enum {
+	/**
+	 * Number of times a non-empty class can be passed over before it is
+	 * served.
+	 */
+	M0_FOM_PRIO_AGE_NR = 8
+};
+
+/** Time spent by foms of a type in a phase. */
+struct m0_fom_phase_stats {
+	/** Number of phase transitions executed from the phase. */
+	uint64_t  fps_run_nr;
+	/** Total time of these transitions. */
+	m0_time_t fps_run;
+	/** Number of waits in the phase. */
+	uint64_t  fps_wait_nr;
+	/** Total time of these waits. */
+	m0_time_t fps_wait;
+};
+
+/**
+ * Live accounting of the foms of a type.
+ *
+ * Each locality keeps an instance per fom type, updated by the handler under
+ * the group lock. m0_fom_domain_type_stats() sums them over the domain.
+ */
+struct m0_fom_type_stats {
+	/** Number of finished foms. */
+	uint64_t                  fts_done;
+	/** Number of times a fom was taken from the run-queue. */
+	uint64_t                  fts_queue_nr;
+	/** Total time foms spent in the run-queue. */
+	m0_time_t                 fts_queue;
+	/** Number of elements in fts_phase[], m0_fom_type::ft_conf states. */
+	uint32_t                  fts_phase_nr;
+	struct m0_fom_phase_stats fts_phase[0];
+};
+
+enum {
+	/**
+	 * Stats service object with the m0_fom_type_stats of a fom type has id
+	 * M0_FOM_STATS_ID_BASE + m0_fom_type::ft_id, see stats/stats_srv.c.
+	 */
+	M0_FOM_STATS_ID_BASE = 0x46530000
+};
+
 /**
  * A locality is a partition of computational resources dedicated to fom
  * execution on the node.
@@ -255,9 +336,20 @@ struct m0_loc_thread;
 struct m0_fom_locality {
 	struct m0_fom_domain          *fl_dom;
 
-	/** Run-queue */
-	struct m0_tl		       fl_runq;
+	/** Run-queues, one per scheduling class, see enum m0_fom_prio. */
+	struct m0_tl		       fl_runq[M0_FOM_PRIO_NR];
+	/** Total length of the run-queues. */
 	size_t			       fl_runq_nr;
+	/** Number of times each class was passed over, for aging. */
+	uint32_t                       fl_runq_skip[M0_FOM_PRIO_NR];
+	/**
+	 * Accounting of fom types, indexed by m0_fom_type::ft_id. Elements
+	 * are allocated when the first fom of the type is executed here.
+	 */
+	struct m0_fom_type_stats     **fl_type_stats;
+	/** Pool of free stacks of stackful foms. */
+	struct m0_tl                   fl_stacks;
+	uint32_t                       fl_stacks_nr;
 
 	/** Wait list */
 	struct m0_tl		       fl_wail;
@@ -272,6 +364,8 @@ struct m0_fom_locality {
 
 	/** State Machine (SM) group for AST call-backs */
 	struct m0_sm_group	       fl_group;
+	/** Wheel of the timers of fl_group, driven by the handler thread. */
+	struct m0_sm_wheel             fl_wheel;
 
 	/**
 	 *  Re-scheduling channel that the handler thread waits on for new work.
@@ -291,6 +385,12 @@ struct m0_fom_locality {
 	struct m0_tl                   fl_threads;
 	struct m0_atomic64             fl_unblocking;
 	struct m0_chan                 fl_idle;
+	/**
+	 * Set to 1 by the handler thread when it goes to sleep with an empty
+	 * run-queue, cleared by a locality handing a fom over to this one.
+	 * Accessed with m0_atomic64_cas().
+	 */
+	int64_t                        fl_hungry;
 	/** Resources allotted to the partition */
 	struct m0_bitmap	       fl_processors;
 	int                            fl_idx;
@@ -298,6 +398,8 @@ struct m0_fom_locality {
 	struct m0_addb2_hist           fl_fom_active;
 	struct m0_addb2_hist           fl_runq_counter;
 	struct m0_addb2_hist           fl_wail_counter;
+	/** Run-queue length of this locality when it shares a fom. */
+	struct m0_addb2_hist           fl_shed_counter;
 	struct m0_addb2_sensor         fl_clock;
 	struct m0_locality             fl_locality;
 	struct m0_sm_group_addb2       fl_grp_addb2;
@@ -313,6 +415,13 @@ struct m0_fom_locality {
  */
 M0_INTERNAL bool m0_locality_invariant(const struct m0_fom_locality *loc);
 
+/**
+ * Sets the run-queue length starting from which a locality hands fresh foms
+ * of locality-agnostic types (m0_fom_type::ft_loc_agnostic) over to idle
+ * localities. 0 disables work sharing, which is the default.
+ */
+M0_INTERNAL void m0_fom_shed_set(uint32_t runq_min);
+
 /**
  * Triggers the posting of statistics
  */
@@ -336,8 +445,59 @@ struct m0_fom_domain {
 	/** Long living foms detecting chore. */
 	struct m0_locality_chore        fd_hung_foms_chore;
 	struct m0_addb2_sys            *fd_addb2_sys;
+	/**
+	 * Locality index for each processor id, m0_locality_here() uses it.
+	 * Processors without a locality of their own are spread over all
+	 * localities.
+	 */
+	uint32_t                       *fd_cpu_loc;
+	/**
+	 * Number of localities on the NUMA node of the network interface.
+	 * These are the first localities of the domain. 0 if the node is not
+	 * known.
+	 */
+	size_t                          fd_nic_nr;
 };
 
+/** Locality placement flags, see m0_fom_placement_set(). */
+enum m0_fom_placement {
+	/**
+	 * A locality per physical core: SMT siblings of a processor that
+	 * already has a locality get none.
+	 */
+	M0_FOM_PLACE_CORE = 1 << 0,
+	/**
+	 * Localities of the same NUMA node get consecutive indices, so that
+	 * work sharing between neighbouring localities stays on the node.
+	 */
+	M0_FOM_PLACE_NUMA = 1 << 1,
+};
+
+/**
+ * Sets the placement of localities of the domains initialised afterwards.
+ *
+ * By default there is a locality per online processor of the process core
+ * mask, numbered in processor id order. flags is a bitmask of
+ * enum m0_fom_placement. A non-negative nic_node is the NUMA node of the
+ * network interface: localities on this node are numbered first and foms
+ * of m0_fom_type::ft_nic_affine types are kept in them. A nic_node implies
+ * M0_FOM_PLACE_NUMA.
+ */
+M0_INTERNAL void m0_fom_placement_set(uint32_t flags, int nic_node);
+
+/**
+ * Returns the sum of m0_fom_type_stats of the fom type over all localities
+ * of the domain. The result must be freed with m0_free().
+ *
+ * Counters are read without locks while the localities update them, so the
+ * result is not an atomic snapshot.
+ *
+ * @retval -ENOENT no fom of the type has been executed yet.
+ */
+M0_INTERNAL int m0_fom_domain_type_stats(const struct m0_fom_domain *dom,
+					 uint64_t type_id,
+					 struct m0_fom_type_stats **out);
+
 /** Operations vector attached to a domain. */
 struct m0_fom_domain_ops {
 	/**
@@ -501,8 +661,24 @@ struct m0_fom {
 	 *  e.g., undo or redo during recovery.
 	 */
 	bool                      fo_local;
+	/**
+	 * Set when the incoming request is refused by admission control, see
+	 * fom_phase_init(). The reply is marked with M0_RIF_BUSY.
+	 */
+	bool                      fo_refused;
 	/** Pointer to service instance. */
 	struct m0_reqh_service   *fo_service;
+	/** Scheduling class, initialised from m0_fom_type_ops::fto_prio. */
+	enum m0_fom_prio          fo_prio;
+	/**
+	 * Optional deadline of the fom, 0 if none. Within its class a fom with
+	 * a deadline is executed before foms without one, in deadline order,
+	 * and a fom whose deadline has passed is executed before foms of any
+	 * class.
+	 *
+	 * @see m0_fom_deadline_set()
+	 */
+	m0_time_t                 fo_deadline;
 	/**
 	 *  FOM linkage in the locality runq list or wait list
 	 *  Every access to the FOM via this linkage is
@@ -528,6 +704,11 @@ struct m0_fom {
 	 * Stack of pending call-backs.
 	 */
 	struct m0_fom_callback   *fo_pending;
+	/**
+	 * Stack of a stackful fom (m0_fom_type::ft_stackful) while its phase
+	 * transition runs or waits in m0_fom_co_wait(), NULL otherwise.
+	 */
+	struct m0_fom_stack      *fo_stack;
 #if FOM_PHASE_DEBUG
 	int                       fo_log[32];
 #endif
@@ -560,6 +741,61 @@ static inline struct m0_be_tx_credit *m0_fom_tx_credit(struct m0_fom *fom)
  */
 M0_INTERNAL void m0_fom_queue(struct m0_fom *fom);
 
+/**
+ * Sets the scheduling class of the fom. Takes effect the next time the fom
+ * is placed in the run-queue.
+ */
+M0_INTERNAL void m0_fom_prio_set(struct m0_fom *fom, enum m0_fom_prio prio);
+
+/**
+ * Sets the deadline of the fom, 0 to clear it. Takes effect the next time
+ * the fom is placed in the run-queue.
+ *
+ * @see m0_fom::fo_deadline
+ */
+M0_INTERNAL void m0_fom_deadline_set(struct m0_fom *fom, m0_time_t deadline);
+
+enum {
+	/** Maximal number of localities a fom batch collects foms for. */
+	M0_FOM_BATCH_LOC_NR = 8
+};
+
+/**
+ * A batch of foms waiting to be queued.
+ *
+ * m0_fom_batch_add() does what m0_fom_queue() does, except that the foms of
+ * the same locality are collected and m0_fom_batch_flush() posts them to the
+ * locality together, waking the locality once. This amortises the wakeups when
+ * a number of foms is created at once, e.g., for the items of an incoming rpc
+ * packet.
+ *
+ * A batch is owned by its user and is not protected by any lock.
+ */
+struct m0_fom_batch {
+	uint32_t                fb_nr;
+	struct {
+		struct m0_fom_locality *fbl_loc;
+		struct m0_sm_ast       *fbl_head;
+		struct m0_sm_ast       *fbl_tail;
+	}                       fb_loc[M0_FOM_BATCH_LOC_NR];
+};
+
+M0_INTERNAL void m0_fom_batch_init(struct m0_fom_batch *batch);
+
+/**
+ * Adds a fom to the batch.
+ *
+ * The fom is queued directly if the batch already collects foms for
+ * M0_FOM_BATCH_LOC_NR other localities.
+ *
+ * @pre m0_fom_phase(fom) == M0_FOM_PHASE_INIT
+ */
+M0_INTERNAL void m0_fom_batch_add(struct m0_fom_batch *batch,
+				  struct m0_fom *fom);
+
+/** Posts collected foms to their localities and empties the batch. */
+M0_INTERNAL void m0_fom_batch_flush(struct m0_fom_batch *batch);
+
 /**
  * Returns reqh the fom belongs to
  */
@@ -615,6 +851,25 @@ struct m0_fom_type {
 	      struct m0_sm_conf            ft_conf;
 	      struct m0_sm_conf            ft_state_conf;
 	const struct m0_reqh_service_type *ft_rstype;
+	/**
+	 * True iff foms of this type do not depend on their home locality
+	 * (m0_fom_ops::fo_home_locality()) until they start executing. A busy
+	 * locality can hand such foms over to an idle one, see the "Work
+	 * sharing" section of fom.c.
+	 */
+	bool                               ft_loc_agnostic;
+	/**
+	 * True iff phase transitions of foms of this type run on a stack of
+	 * their own and can wait with m0_fom_co_wait(). See the "Stackful
+	 * foms" section.
+	 */
+	bool                               ft_stackful;
+	/**
+	 * True iff foms of this type are network-heavy and should run in the
+	 * localities on the NUMA node of the network interface, see
+	 * m0_fom_placement_set().
+	 */
+	bool                               ft_nic_affine;
 };
 
 /**
@@ -649,6 +904,8 @@ struct m0_fom_type_ops {
 	/** Create a new fom for the given fop. */
 	int (*fto_create)(struct m0_fop *fop, struct m0_fom **out,
 			  struct m0_reqh *reqh);
+	/** Default scheduling class of foms of this type. */
+	enum m0_fom_prio fto_prio;
 };
 
 /** Fom operations vector. */
@@ -696,6 +953,18 @@ M0_INTERNAL void m0_fom_block_enter(struct m0_fom *fom);
  */
 M0_INTERNAL void m0_fom_block_leave(struct m0_fom *fom);
 
+/**
+ * Waits until the channel is signalled, from a phase transition of the fom.
+ *
+ * The caller holds the channel lock, which is released while waiting and
+ * re-acquired before the return, as with m0_cond_wait(). A stackful fom
+ * yields to the locality while waiting, other foms block the thread.
+ *
+ * @pre m0_chan_is_locked(chan)
+ * @pre fom->fo_cb.fc_state == M0_FCS_DONE
+ */
+M0_INTERNAL void m0_fom_co_wait(struct m0_fom *fom, struct m0_chan *chan);
+
 /**
  * Dequeues fom from the locality waiting queue and enqueues it into
  * locality runq list changing the state to M0_FOS_READY.
@@ -875,6 +1144,15 @@ M0_INTERNAL int m0_fom_addb2_init(struct m0_fom_type *type, uint64_t id);
  */
 M0_INTERNAL int m0_fom_fol_rec_add(struct m0_fom *fom);
 
+/**
+ * Returns true iff a FOL record has to be generated for the transaction of the
+ * fom. FDMI is the only consumer of FOL records, so the record, its fop
+ * fragment and the BE tx payload are not prepared while there are no FDMI
+ * filters. The decision is taken when the transaction is opened and kept in
+ * m0_dtx::tx_fol_skip.
+ */
+M0_INTERNAL bool m0_fom_fol_is_needed(const struct m0_fom *fom);
+
 /**
  * Post FDMI record for this fom. FDMI record in this case contains FOL record.
  */
@@ -141,12 +141,24 @@ struct fom_phase_desc {
  * Begins fom execution, transitions fom to its first
  * standard phase.
  *
+ * An incoming request fails with -EBUSY here if the run-queue of its
+ * locality is longer than m0_reqh::rh_runq_max, so that an overloaded
+ * locality replies quickly instead of queueing more work.
+ *
  * @see m0_fom_tick_generic()
  *
  * @retval M0_FSO_AGAIN, to execute next fom phase
  */
 static int fom_phase_init(struct m0_fom *fom)
 {
+	uint32_t runq_max = m0_fom_reqh(fom)->rh_runq_max;
+
+	if (runq_max != 0 && fom->fo_fop != NULL && !fom->fo_local &&
+	    m0_rpc_item_is_request(&fom->fo_fop->f_item) &&
+	    fom->fo_loc->fl_runq_nr >= runq_max) {
+		fom->fo_refused = true;
+		return -EBUSY;
+	}
 	return M0_FSO_AGAIN;
 }
 
@@ -270,9 +282,11 @@ static int fom_tx_open(struct m0_fom *fom)
 	if (fom_is_update(fom)) {
 		struct m0_dtx *dtx = &fom->fo_tx;
 
-		m0_be_tx_payload_prep(m0_fom_tx(fom), FOL_REC_MAXSIZE);
-		if (!fom->fo_local) {
+		dtx->tx_fol_skip = !m0_fom_fol_is_needed(fom);
+		if (!dtx->tx_fol_skip) {
 			int rc;
+
+			m0_be_tx_payload_prep(m0_fom_tx(fom), FOL_REC_MAXSIZE);
 			rc = m0_fop_fol_add(fom->fo_fop, fom->fo_rep_fop, dtx);
 			if (rc < 0)
 				return M0_RC(rc);
@@ -408,8 +422,8 @@ static int fom_fol_rec_add(struct m0_fom *fom)
 {
 	int rc;
 
-	if (fom_is_update(fom) &&
-	    !fom->fo_local && fom->fo_tx.tx_state == M0_DTX_OPEN) {
+	if (fom_is_update(fom) && !fom->fo_tx.tx_fol_skip &&
+	    fom->fo_tx.tx_state == M0_DTX_OPEN) {
 		rc = m0_fom_fol_rec_add(fom);
 		/*
 		 * FOL record itself might fail to encode due to insufficient
@@ -468,7 +482,7 @@ M0_INTERNAL int m0_fom_tx_logged_wait(struct m0_fom *fom)
 		;
 	else if (dtx->tx_state == M0_DTX_DONE) {
 		if (m0_be_tx_state(tx) >= M0_BTS_LOGGED) {
-			if (!fom->fo_local) {
+			if (!dtx->tx_fol_skip) {
 				m0_fom_fdmi_record_post(fom);
 				/*
 				 * This reference is taken in fom_fol_rec_add().
@@ -530,6 +544,8 @@ static int fom_queue_reply(struct m0_fom *fom)
 			m0_fop_to_rpc_item(fom->fo_rep_fop),
 			m0_fop_to_rpc_item(fom->fo_rep_fop)->ri_error);
 
+		if (fom->fo_refused)
+			fom->fo_rep_fop->f_item.ri_flags |= M0_RIF_BUSY;
 		m0_rpc_reply_post(m0_fop_to_rpc_item(fom->fo_fop),
 				  m0_fop_to_rpc_item(fom->fo_rep_fop));
 	}
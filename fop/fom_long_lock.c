@@ -31,10 +31,12 @@
 #include "fop/fom_long_lock.h"
 #include "lib/arith.h"
 #include "lib/misc.h"
+#include "lib/memory.h"
 #include "lib/bob.h"
 #include "motr/magic.h"
 #include "addb2/identifier.h" /* M0_AVI_LONG_LOCK */
 #include "addb2/addb2.h"      /* M0_ADDB2_ADD */
+#include "fop/fom.h"          /* m0_fom_locality */
 
 /**
  * Descriptor of typed list used in m0_long_lock with
@@ -71,11 +73,13 @@ M0_INTERNAL void m0_long_lock_link_init(struct m0_long_lock_link *link,
 	m0_lll_tlink_init(link);
 	link->lll_fom   = fom;
 	link->lll_addb2 = addb2;
+	link->lll_rd    = NULL;
 }
 
 M0_INTERNAL void m0_long_lock_link_fini(struct m0_long_lock_link *link)
 {
 	M0_PRE(!m0_lll_tlink_is_in(link));
+	M0_PRE(link->lll_rd == NULL);
 	link->lll_fom   = NULL;
 	link->lll_addb2 = NULL;
 	m0_lll_tlink_fini(link);
@@ -160,6 +164,7 @@ static bool lock_invariant(const struct m0_long_lock *lock)
 		     (m0_lll_tlist_length(&lock->l_owners) == 1)) &&
 
 		ergo(first != NULL, last != NULL) &&
+		ergo(lock->l_rd == NULL, m0_atomic64_get(&lock->l_wr_nr) == 0) &&
 
 		ergo(last != NULL && first != NULL,
 		     ergo(last->lll_lock_type == M0_LONG_LOCK_READER,
@@ -170,12 +175,19 @@ static bool lock_invariant(const struct m0_long_lock *lock)
  * True, iff "link" can acquire "lock", provided "link" is at the head of
  * waiters queue.
  */
+static bool rd_drained(const struct m0_long_lock *lock)
+{
+	return lock->l_rd == NULL ||
+		m0_forall(i, lock->l_rd_nr,
+			  m0_atomic64_get(&lock->l_rd[i].lr_nr) == 0);
+}
+
 static bool can_lock(const struct m0_long_lock *lock,
 		     const struct m0_long_lock_link *link)
 {
 	return link->lll_lock_type == M0_LONG_LOCK_READER ?
 		lock->l_state != M0_LONG_LOCK_WR_LOCKED :
-		lock->l_state == M0_LONG_LOCK_UNLOCKED;
+		lock->l_state == M0_LONG_LOCK_UNLOCKED && rd_drained(lock);
 }
 
 static void grant(struct m0_long_lock *lock, struct m0_long_lock_link *link)
@@ -189,19 +201,107 @@ static void grant(struct m0_long_lock *lock, struct m0_long_lock_link *link)
 	m0_lll_tlist_move_tail(&lock->l_owners, link);
 }
 
+/** Grants the lock to the waiters at the head of the queue, if possible. */
+static void waiters_grant(struct m0_long_lock *lock)
+{
+	struct m0_long_lock_link *next;
+
+	while ((next = m0_lll_tlist_head(&lock->l_waiters)) != NULL &&
+	       can_lock(lock, next)) {
+		grant(lock, next);
+
+		/**
+		 * Initially, here the following assertion was checked:
+		 * M0_ASSERT(next->lll_fom->fo_transitions_saved + 1
+		 *	     == next->lll_fom->fo_transitions);
+		 *
+		 * For the reason fom->fo_transitions counter is
+		 * updated after control returns from fom_tick()
+		 * without any locks taken, it can be so, that long
+		 * lock is queued to be taken by one fom (thread) and
+		 * the contorol is still inside fom_tick(), and other
+		 * fom (thread) has already unlocked() -> granted()
+		 * the long lock. In this case fom->fo_transitions is
+		 * still not updated, so fom->fo_transitions_saved can
+		 * be equal to fom->fo_transitions in this case. In other
+		 * cases it has to be greater by 1.
+		 */
+		M0_ASSERT(M0_IN(next->lll_fom->fo_transitions -
+				next->lll_fom->fo_transitions_saved, (1, 0)));
+		m0_fom_wakeup(next->lll_fom);
+	}
+}
+
+static struct m0_long_lock_rd *rd_counter(struct m0_long_lock *lock,
+					  const struct m0_fom *fom)
+{
+	return &lock->l_rd[fom->fo_loc->fl_idx % lock->l_rd_nr];
+}
+
+static void rd_unlock(struct m0_long_lock *lock, struct m0_long_lock_rd *rd)
+{
+	/*
+	 * The counter is decremented before l_wr_nr is checked, and a writer
+	 * increments l_wr_nr before it checks the counters in can_lock(), so
+	 * either the writer sees the counter drained or the reader sees the
+	 * writer and hands the lock over to it.
+	 */
+	if (m0_atomic64_dec_and_test(&rd->lr_nr) &&
+	    m0_atomic64_get(&lock->l_wr_nr) > 0) {
+		m0_mutex_lock(&lock->l_lock);
+		M0_ASSERT(lock_invariant(lock));
+		waiters_grant(lock);
+		M0_ASSERT(lock_invariant(lock));
+		m0_mutex_unlock(&lock->l_lock);
+	}
+}
+
+/**
+ * Takes a reader-optimised lock for reading without touching shared state,
+ * unless there are writers.
+ */
+static bool rd_lock(struct m0_long_lock *lock, struct m0_long_lock_link *link)
+{
+	struct m0_long_lock_rd *rd;
+
+	if (lock->l_rd == NULL || m0_atomic64_get(&lock->l_wr_nr) > 0)
+		return false;
+	rd = rd_counter(lock, link->lll_fom);
+	m0_atomic64_inc(&rd->lr_nr);
+	if (m0_atomic64_get(&lock->l_wr_nr) == 0) {
+		link->lll_rd = rd;
+		return true;
+	}
+	/* A writer came in between, back off to the regular path. */
+	rd_unlock(lock, rd);
+	return false;
+}
+
 static bool lock(struct m0_long_lock *lock, struct m0_long_lock_link *link,
 		 int next_phase)
 {
 	bool got_lock;
 	struct m0_fom *fom;
 
+	fom = link->lll_fom;
+	M0_PRE(fom != NULL);
+	M0_PRE(link->lll_rd == NULL);
+
+	if (link->lll_lock_type == M0_LONG_LOCK_READER) {
+		if (rd_lock(lock, link)) {
+			ll_addb2_reset(link);
+			ll_addb2_wait_finish(link);
+			m0_fom_phase_set(fom, next_phase);
+			return true;
+		}
+	} else if (lock->l_rd != NULL)
+		/* Send new readers to the regular path. */
+		m0_atomic64_inc(&lock->l_wr_nr);
+
 	m0_mutex_lock(&lock->l_lock);
 	M0_PRE(lock_invariant(lock));
 	M0_PRE(!m0_lll_tlink_is_in(link));
 
-	fom = link->lll_fom;
-	M0_PRE(fom != NULL);
-
 	got_lock = m0_lll_tlist_is_empty(&lock->l_waiters) &&
 		can_lock(lock, link);
 	ll_addb2_reset(link);
@@ -247,11 +347,18 @@ static void unlock(struct m0_long_lock *lock,
 		   bool check_ownership)
 {
 	struct m0_fom            *fom = link->lll_fom;
-	struct m0_long_lock_link *next;
+	struct m0_long_lock_rd   *rd  = link->lll_rd;
 
 	M0_ENTRY("lock=%p link=%p fom=%p check_ownership=%d",
 		 lock, link, link->lll_fom, !!check_ownership);
 
+	if (rd != NULL) {
+		M0_PRE(m0_fom_group_is_locked(fom));
+		link->lll_rd = NULL;
+		ll_addb2_post(link);
+		rd_unlock(lock, rd);
+		return;
+	}
 	m0_mutex_lock(&lock->l_lock);
 	if (check_ownership && !m0_lll_tlist_contains(&lock->l_owners, link)) {
 		m0_mutex_unlock(&lock->l_lock);
@@ -267,32 +374,10 @@ static void unlock(struct m0_long_lock *lock,
 		link->lll_lock_type == M0_LONG_LOCK_WRITER ||
 		m0_lll_tlist_is_empty(&lock->l_owners) ?
 		M0_LONG_LOCK_UNLOCKED : M0_LONG_LOCK_RD_LOCKED;
+	if (link->lll_lock_type == M0_LONG_LOCK_WRITER && lock->l_rd != NULL)
+		m0_atomic64_dec(&lock->l_wr_nr);
 	ll_addb2_post(link);
-	while ((next = m0_lll_tlist_head(&lock->l_waiters)) != NULL &&
-	       can_lock(lock, next)) {
-		grant(lock, next);
-
-		/**
-		 * Initially, here the following assertion was checked:
-		 * M0_ASSERT(next->lll_fom->fo_transitions_saved + 1
-		 *	     == next->lll_fom->fo_transitions);
-		 *
-		 * For the reason fom->fo_transitions counter is
-		 * updated after control returns from fom_tick()
-		 * without any locks taken, it can be so, that long
-		 * lock is queued to be taken by one fom (thread) and
-		 * the contorol is still inside fom_tick(), and other
-		 * fom (thread) has already unlocked() -> granted()
-		 * the long lock. In this case fom->fo_transitions is
-		 * still not updated, so fom->fo_transitions_saved can
-		 * be equal to fom->fo_transitions in this case. In other
-		 * cases it has to be greater by 1.
-		 */
-		M0_ASSERT(M0_IN(next->lll_fom->fo_transitions -
-				next->lll_fom->fo_transitions_saved, (1, 0)));
-		m0_fom_wakeup(next->lll_fom);
-	}
-
+	waiters_grant(lock);
 	M0_POST(lock_invariant(lock));
 	m0_mutex_unlock(&lock->l_lock);
 }
@@ -320,6 +405,9 @@ M0_INTERNAL bool m0_long_is_read_locked(struct m0_long_lock *lock,
 {
 	bool ret;
 
+	if (lock->l_rd != NULL &&
+	    m0_atomic64_get(&rd_counter(lock, fom)->lr_nr) > 0)
+		return true;
 	m0_mutex_lock(&lock->l_lock);
 	M0_ASSERT(lock_invariant(lock));
 	ret = lock->l_state == M0_LONG_LOCK_RD_LOCKED &&
@@ -353,13 +441,37 @@ M0_INTERNAL void m0_long_lock_init(struct m0_long_lock *lock)
 	m0_lll_tlist_init(&lock->l_waiters);
 
 	lock->l_state = M0_LONG_LOCK_UNLOCKED;
+	lock->l_rd    = NULL;
+	lock->l_rd_nr = 0;
+	m0_atomic64_set(&lock->l_wr_nr, 0);
 
 	m0_long_lock_bob_init(lock);
 }
 
+M0_INTERNAL void m0_long_lock_rd_init(struct m0_long_lock *lock, uint32_t nr)
+{
+	M0_PRE(lock->l_state == M0_LONG_LOCK_UNLOCKED);
+	M0_PRE(lock->l_rd == NULL);
+
+	if (nr < 2)
+		return;
+	M0_ALLOC_ARR_ALIGNED(lock->l_rd, nr, M0_LONG_LOCK_RD_SHIFT);
+	if (lock->l_rd != NULL)
+		lock->l_rd_nr = nr;
+}
+
 M0_INTERNAL void m0_long_lock_fini(struct m0_long_lock *lock)
 {
 	M0_ASSERT(lock->l_state == M0_LONG_LOCK_UNLOCKED);
+	M0_ASSERT(rd_drained(lock));
+	M0_ASSERT(m0_atomic64_get(&lock->l_wr_nr) == 0);
+
+	if (lock->l_rd != NULL) {
+		m0_free_aligned(lock->l_rd, lock->l_rd_nr * sizeof lock->l_rd[0],
+				M0_LONG_LOCK_RD_SHIFT);
+		lock->l_rd    = NULL;
+		lock->l_rd_nr = 0;
+	}
 
 	m0_long_lock_bob_fini(lock);
 
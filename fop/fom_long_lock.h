@@ -114,6 +114,20 @@
  * m0_long_lock::l_waiters lists. m0_fom_ready_remote() call is used to wake
  * FOMs up.
  *
+ * @section m0_long_lock-dld-rd Reader-optimised locks
+ * A lock taken mostly for reading by FOMs of all localities (e.g., a CAS
+ * catalogue) makes l_lock and the lists bounce between cores. Such a lock can
+ * be switched to reader-optimised mode by m0_long_lock_rd_init(). In this mode
+ * a reader, when no writer owns or waits for the lock, only increments the
+ * counter of its locality (m0_long_lock::l_rd[]) and does not take l_lock or
+ * appear in l_owners. A writer increments m0_long_lock::l_wr_nr first, which
+ * sends the following readers to the regular path, and then waits until the
+ * counters of all localities drop to zero. The last reader of a locality,
+ * unlocking while l_wr_nr is not zero, hands the lock over to the waiters.
+ *
+ * Readers which use the fast path are not visible in m0_long_lock::l_owners
+ * and m0_long_lock::l_state.
+ *
  * @defgroup m0_long_lock_API FOM long lock API
  * @{
  * @see @ref m0_long_lock-dld
@@ -124,6 +138,7 @@
 #include "lib/list.h"
 #include "lib/chan.h"
 #include "lib/mutex.h"
+#include "lib/atomic.h"
 #include "lib/bob.h"
 
 /**
@@ -167,6 +182,25 @@ struct m0_long_lock_link {
 	enum m0_long_lock_type     lll_lock_type;
 	/** ADDB2 information for link */
 	struct m0_long_lock_addb2 *lll_addb2;
+	/**
+	 * Counter of a reader-optimised lock through which the read lock is
+	 * held, NULL if the link is not a fast path reader.
+	 */
+	struct m0_long_lock_rd    *lll_rd;
+};
+
+enum {
+	/** log2 of the alignment of m0_long_lock_rd, a cache line. */
+	M0_LONG_LOCK_RD_SHIFT = 6
+};
+
+/**
+ * Count of fast path readers of a locality, see @ref m0_long_lock-dld-rd.
+ */
+struct m0_long_lock_rd {
+	struct m0_atomic64 lr_nr;
+	char               lr_pad[(1 << M0_LONG_LOCK_RD_SHIFT) -
+				  sizeof(struct m0_atomic64)];
 };
 
 /**
@@ -183,6 +217,14 @@ struct m0_long_lock {
 	enum m0_long_lock_state l_state;
 	/** Magic number. M0_LONG_LOCK_MAGIX */
 	uint64_t                l_magix;
+	/**
+	 * Per-locality reader counts, NULL unless the lock is
+	 * reader-optimised.
+	 */
+	struct m0_long_lock_rd *l_rd;
+	uint32_t                l_rd_nr;
+	/** Number of writers owning or waiting for a reader-optimised lock. */
+	struct m0_atomic64      l_wr_nr;
 };
 
 //#ifdef __KERNEL__
@@ -225,6 +267,15 @@ M0_INTERNAL void m0_long_lock_init(struct m0_long_lock *lock);
  */
 M0_INTERNAL void m0_long_lock_fini(struct m0_long_lock *lock);
 
+/**
+ * Switches the lock to reader-optimised mode with nr per-locality reader
+ * counters, see @ref m0_long_lock-dld-rd.
+ *
+ * The lock keeps working in the regular mode if nr < 2 or the counters
+ * cannot be allocated. Must be called right after m0_long_lock_init().
+ */
+M0_INTERNAL void m0_long_lock_rd_init(struct m0_long_lock *lock, uint32_t nr);
+
 /**
  * Obtains given lock for reading for given fom. Taking recursive read-lock is
  * not permitted. If the lock is not obtained the invoking FOM should wait; it
@@ -307,6 +358,9 @@ M0_INTERNAL void m0_long_unlock(struct m0_long_lock *lock,
 
 /**
  * @return true iff the lock is taken as a read-lock by the given fom.
+ *
+ * For a fast path reader of a reader-optimised lock, true iff some fom of the
+ * locality of the given fom holds the lock for reading this way.
  */
 M0_INTERNAL bool m0_long_is_read_locked(struct m0_long_lock *lock,
 					const struct m0_fom *fom);
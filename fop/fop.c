@@ -24,6 +24,8 @@
 #include "lib/trace.h"
 
 #include "lib/memory.h"
+#include "lib/arith.h"           /* m0_align */
+#include "lib/objcache.h"        /* m0_objcache */
 #include "lib/misc.h"            /* M0_SET0 */
 #include "lib/errno.h"
 #include "motr/magic.h"
@@ -42,8 +44,10 @@
    @{
  */
 
-static struct m0_mutex fop_types_lock;
-static struct m0_tl    fop_types_list;
+static struct m0_mutex    fop_types_lock;
+static struct m0_tl       fop_types_list;
+/** Cache of m0_fop structures of incoming fops and replies. */
+static struct m0_objcache fop_cache;
 
 M0_TL_DESCR_DEFINE(ft, "fop types", static, struct m0_fop_type,
 		   ft_linkage,	ft_magix,
@@ -67,6 +71,110 @@ M0_INTERNAL bool m0_fop_rpc_is_locked(struct m0_fop *fop)
 	return m0_rpc_machine_is_locked(fop->f_item.ri_rmachine);
 }
 
+/**
+ * A chunk of the fop arena. Chunks are allocated zeroed, as m0_xcode_alloc()
+ * does, and are never freed before the fop.
+ */
+struct m0_fop_arena {
+	struct m0_fop_arena *fa_next;
+	size_t               fa_size;
+	size_t               fa_used;
+	char                 fa_data[0];
+};
+
+enum {
+	/** Size of an arena chunk, including its header. */
+	FOP_ARENA_CHUNK = 4096,
+	FOP_ARENA_ALIGN = 8,
+};
+
+static void *fop_arena_alloc(struct m0_fop *fop, size_t nob)
+{
+	struct m0_fop_arena *a = fop->f_arena;
+	size_t               size;
+	void                *ptr;
+
+	nob = m0_align(nob, FOP_ARENA_ALIGN);
+	if (a == NULL || a->fa_used + nob > a->fa_size) {
+		size = max_check(sizeof *a + nob, (size_t)FOP_ARENA_CHUNK);
+		a = m0_alloc(size);
+		if (a == NULL)
+			return NULL;
+		a->fa_size = size - sizeof *a;
+		/*
+		 * Keep the chunk with more free space at the head, a large
+		 * allocation does not waste the rest of the current chunk.
+		 */
+		if (fop->f_arena != NULL &&
+		    a->fa_size - nob < fop->f_arena->fa_size -
+				       fop->f_arena->fa_used) {
+			a->fa_next = fop->f_arena->fa_next;
+			fop->f_arena->fa_next = a;
+		} else {
+			a->fa_next = fop->f_arena;
+			fop->f_arena = a;
+		}
+	}
+	ptr = a->fa_data + a->fa_used;
+	a->fa_used += nob;
+	return ptr;
+}
+
+static void fop_arena_fini(struct m0_fop *fop)
+{
+	struct m0_fop_arena *a;
+
+	while ((a = fop->f_arena) != NULL) {
+		fop->f_arena = a->fa_next;
+		m0_free(a);
+	}
+}
+
+M0_INTERNAL bool m0_fop_arena_owns(const struct m0_fop *fop, const void *addr)
+{
+	const struct m0_fop_arena *a;
+
+	for (a = fop->f_arena; a != NULL; a = a->fa_next) {
+		if ((const char *)addr >= a->fa_data &&
+		    (const char *)addr < a->fa_data + a->fa_used)
+			return true;
+	}
+	return false;
+}
+
+/** Decoding context of a fop of M0_FOP_TYPE_FLAG_DECODE_ARENA type. */
+struct fop_decode_ctx {
+	struct m0_xcode_ctx  fdc_xcx;
+	struct m0_fop       *fdc_fop;
+};
+
+static void *fop_decode_alloc(struct m0_xcode_cursor *it, size_t nob)
+{
+	struct m0_xcode_ctx   *xcx = M0_AMB(xcx, it, xcx_it);
+	struct fop_decode_ctx *ctx = M0_AMB(ctx, xcx, fdc_xcx);
+
+	return fop_arena_alloc(ctx->fdc_fop, nob);
+}
+
+static int fop_arena_decode(struct m0_fop *fop, struct m0_bufvec_cursor *cur)
+{
+	struct fop_decode_ctx ctx = { .fdc_fop = fop };
+	int                   result;
+
+	M0_PRE(m0_fop_data(fop) == NULL && fop->f_arena == NULL);
+
+	m0_xcode_ctx_init(&ctx.fdc_xcx, &M0_FOP_XCODE_OBJ(fop));
+	ctx.fdc_xcx.xcx_buf   = *cur;
+	ctx.fdc_xcx.xcx_alloc = fop_decode_alloc;
+	result = m0_xcode_decode(&ctx.fdc_xcx);
+	if (result == 0) {
+		*cur = ctx.fdc_xcx.xcx_buf;
+		fop->f_data.fd_data = m0_xcode_ctx_top(&ctx.fdc_xcx);
+	}
+	/* On failure the partially decoded data are freed with the arena. */
+	return result;
+}
+
 M0_INTERNAL int m0_fop_data_alloc(struct m0_fop *fop)
 {
 	M0_PRE(fop->f_data.fd_data == NULL && fop->f_type != NULL);
@@ -83,6 +191,7 @@ M0_INTERNAL void m0_fop_init(struct m0_fop *fop, struct m0_fop_type *fopt,
 
 	m0_ref_init(&fop->f_ref, 1, fop_release);
 	fop->f_type = fopt;
+	fop->f_arena = NULL;
 	M0_SET0(&fop->f_item);
 	m0_rpc_item_init(&fop->f_item, &fopt->ft_rpc_item_type);
 	fop->f_data.fd_data = data;
@@ -99,7 +208,7 @@ struct m0_fop *m0_fop_alloc(struct m0_fop_type *fopt, void *data,
 
 	M0_PRE(mach != NULL);
 
-	M0_ALLOC_PTR(fop);
+	fop = m0_fop_obj_alloc();
 	if (fop == NULL)
 		return NULL;
 
@@ -108,7 +217,7 @@ struct m0_fop *m0_fop_alloc(struct m0_fop_type *fopt, void *data,
 		int rc = m0_fop_data_alloc(fop);
 		if (rc != 0) {
 			m0_fop_fini(fop);
-			m0_free(fop);
+			m0_objcache_free(&fop_cache, fop);
 			return NULL;
 		}
 	}
@@ -139,7 +248,10 @@ M0_INTERNAL void m0_fop_fini(struct m0_fop *fop)
 	M0_PRE(M0_IN(m0_ref_read(&fop->f_ref), (0, 1)));
 
 	m0_rpc_item_fini(&fop->f_item);
-	if (fop->f_data.fd_data != NULL)
+	if (fop->f_arena != NULL) {
+		fop_arena_fini(fop);
+		fop->f_data.fd_data = NULL;
+	} else if (fop->f_data.fd_data != NULL)
 		m0_xcode_free_obj(&M0_FOP_XCODE_OBJ(fop));
 	M0_LEAVE();
 }
@@ -153,11 +265,16 @@ M0_INTERNAL void m0_fop_release(struct m0_ref *ref)
 
 	fop = container_of(ref, struct m0_fop, f_ref);
 	m0_fop_fini(fop);
-	m0_free(fop);
+	m0_objcache_free(&fop_cache, fop);
 
 	M0_LEAVE();
 }
 
+M0_INTERNAL struct m0_fop *m0_fop_obj_alloc(void)
+{
+	return m0_objcache_alloc(&fop_cache);
+}
+
 struct m0_fop *m0_fop_get(struct m0_fop *fop)
 {
 	uint64_t count = m0_ref_read(&fop->f_ref);
@@ -261,9 +378,10 @@ void m0_fop_type_init(struct m0_fop_type *ft,
 
 	rpc_type = &ft->ft_rpc_item_type;
 
-	ft->ft_name = args->name;
-	ft->ft_xt   = xt;
-	ft->ft_ops  = args->fop_ops;
+	ft->ft_name  = args->name;
+	ft->ft_xt    = xt;
+	ft->ft_ops   = args->fop_ops;
+	ft->ft_flags = args->flags;
 
 	rpc_type->rit_opcode = args->opcode;
 	rpc_type->rit_flags  = args->rpc_flags;
@@ -316,6 +434,7 @@ M0_INTERNAL int m0_fops_init(void)
 	m0_sm_conf_init(&fom_states_conf);
 	ft_tlist_init(&fop_types_list);
 	m0_mutex_init(&fop_types_lock);
+	m0_objcache_init(&fop_cache, "fop", sizeof(struct m0_fop));
 	m0_fom_ll_global_init();
 
 	m0_fop_fol_frag_type.rpt_xt  = m0_fop_fol_frag_xc;
@@ -327,6 +446,7 @@ M0_INTERNAL int m0_fops_init(void)
 
 M0_INTERNAL void m0_fops_fini(void)
 {
+	m0_objcache_fini(&fop_cache);
 	m0_mutex_fini(&fop_types_lock);
 	/* Do not finalise fop_types_list, it can be validly non-empty. */
 	m0_fol_frag_type_deregister(&m0_fop_fol_frag_type);
@@ -378,6 +498,9 @@ M0_INTERNAL int m0_fop_encdec(struct m0_fop           *fop,
 	int                 result;
 	struct m0_xcode_obj xo = M0_FOP_XCODE_OBJ(fop);
 
+	if (what == M0_XCODE_DECODE && m0_fop_data(fop) == NULL &&
+	    (fop->f_type->ft_flags & M0_FOP_TYPE_FLAG_DECODE_ARENA))
+		return fop_arena_decode(fop, cur);
 	result = m0_xcode_encdec(&xo, cur, what);
 	if (result == 0 && m0_fop_data(fop) == NULL)
 		fop->f_data.fd_data = xo.xo_ptr;
@@ -66,6 +66,7 @@ struct m0_xcode_type;
 struct m0_fop_data;
 struct m0_fop;
 struct m0_fop_fol_frag;
+struct m0_fop_arena;
 
 /**
     fop storage.
@@ -83,6 +84,12 @@ struct m0_fop {
 	struct m0_fop_data  f_data;
 	struct m0_rpc_item  f_item;
 	void               *f_opaque;
+	/**
+	 * Memory of the data of a fop decoded from the network, if its type
+	 * has M0_FOP_TYPE_FLAG_DECODE_ARENA. Released in one step by
+	 * m0_fop_fini().
+	 */
+	struct m0_fop_arena *f_arena;
 };
 
 /**
@@ -160,8 +167,16 @@ struct m0_fop *m0_fop_reply_alloc(struct m0_fop *req,
 /**
  * Default implementation of fop_release that can be passed to
  * m0_fop_init() when fop is not embedded in any other object.
+ *
+ * The fop goes to the fop object cache, see m0_fop_obj_alloc().
  */
 M0_INTERNAL void m0_fop_release(struct m0_ref *ref);
+
+/**
+ * Allocates a zeroed fop structure from the fop object cache. The fop should
+ * be initialised with m0_fop_release() as the release function.
+ */
+M0_INTERNAL struct m0_fop *m0_fop_obj_alloc(void);
 void *m0_fop_data(const struct m0_fop *fop);
 
 /**
@@ -234,9 +249,23 @@ struct m0_fop_type {
 	/** The rpc_item_type associated with rpc_item
 	    embedded with this fop. */
 	struct m0_rpc_item_type           ft_rpc_item_type;
+	/** Bitmask of m0_fop_type_flags. */
+	uint64_t                          ft_flags;
 	uint64_t                          ft_magix;
 };
 
+enum m0_fop_type_flags {
+	/**
+	 * All the data of a fop of this type decoded from the network are
+	 * allocated in a per-fop arena (m0_fop::f_arena), instead of a
+	 * separate allocation for each variable-size field.
+	 *
+	 * Handlers of such fops must not free or re-allocate decoded fields
+	 * individually, see m0_fop_arena_owns().
+	 */
+	M0_FOP_TYPE_FLAG_DECODE_ARENA = 1 << 0,
+};
+
 /**
     Iterates through the registered fop types.
 
@@ -294,6 +323,8 @@ struct __m0_fop_type_init_args {
 	const struct m0_rpc_item_type_ops *rpc_ops;
 	const struct m0_sm_conf           *sm;
 	const struct m0_reqh_service_type *svc_type;
+	/** Bitmask of m0_fop_type_flags. */
+	uint64_t                           flags;
 };
 
 void m0_fop_type_init(struct m0_fop_type *ft,
@@ -341,6 +372,13 @@ M0_INTERNAL int m0_fop_encdec(struct m0_fop           *fop,
 			      struct m0_bufvec_cursor *cur,
 			      enum m0_xcode_what       what);
 
+/**
+ * Returns true iff addr points to the memory allocated for the fop data when
+ * the fop was decoded in its arena (M0_FOP_TYPE_FLAG_DECODE_ARENA). Such
+ * memory is released with the fop and must not be freed by m0_free().
+ */
+M0_INTERNAL bool m0_fop_arena_owns(const struct m0_fop *fop, const void *addr);
+
 M0_INTERNAL int m0_fop_xc_type(const struct m0_xcode_obj   *par,
 			       const struct m0_xcode_type **out);
 
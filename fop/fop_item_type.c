@@ -76,7 +76,7 @@ m0_fop_item_type_default_decode(const struct m0_rpc_item_type *item_type,
 	 * allocated by caller; in xcode, even the top object is allocated,
 	 * so we don't need to allocate the fop->f_data->fd_data.
 	 */
-	M0_ALLOC_PTR(fop);
+	fop = m0_fop_obj_alloc();
 	if (fop == NULL)
 		return M0_ERR(-ENOMEM);
 
@@ -0,0 +1,371 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2017-2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "lib/memory.h"
+#include "lib/mutex.h"
+#include "lib/chan.h"
+#include "lib/thread.h"                     /* m0_thread_self */
+#include "lib/semaphore.h"
+#include "rpc/rpc_opcodes.h"
+#include "fop/fom.h"
+#include "reqh/reqh.h"
+#include "reqh/reqh_service.h"
+#include "ut/ut.h"
+
+/**
+ * Stackful fom test: a stackful fom yields in m0_fom_co_wait() in the middle of
+ * its tick and is resumed when the channel is signalled. A blocking fom of the
+ * same locality makes another thread the locality handler while the stackful
+ * fom waits, so that the tick is resumed on a different thread.
+ */
+
+struct co_fom {
+	struct m0_fom        cf_fom;
+	/** The fom blocks in m0_fom_block_enter() instead of waiting. */
+	bool                 cf_blocker;
+	/** Number of m0_fom_co_wait() calls to make. */
+	int                  cf_waits;
+	/** Threads running the tick before and after the wait. */
+	struct m0_thread    *cf_before;
+	struct m0_thread    *cf_after;
+	struct m0_semaphore  cf_sem_waiting;
+	struct m0_semaphore  cf_sem_resumed;
+	struct m0_semaphore  cf_sem_release;
+	struct m0_semaphore  cf_sem_fini;
+};
+
+enum co_fom_phase {
+	INIT   = M0_FOM_PHASE_INIT,
+	FINISH = M0_FOM_PHASE_FINISH,
+	PHASE1 = M0_FOM_PHASE_NR,
+};
+
+static struct m0_sm_state_descr co_fom_phases[] = {
+	[INIT] = {
+		.sd_flags   = M0_SDF_INITIAL,
+		.sd_name    = "init",
+		.sd_allowed = M0_BITS(PHASE1, FINISH)
+	},
+	[PHASE1] = {
+		.sd_name    = "phase1",
+		.sd_allowed = M0_BITS(FINISH)
+	},
+	[FINISH] = {
+		.sd_name    = "finish",
+		.sd_flags   = M0_SDF_TERMINAL,
+	}
+};
+
+static struct m0_sm_conf co_sm_conf = {
+	.scf_name      = "co_fom",
+	.scf_nr_states = ARRAY_SIZE(co_fom_phases),
+	.scf_state     = co_fom_phases,
+};
+
+static struct m0_fom_type co_fomt;
+static struct m0_fom_type co_block_fomt;
+
+static struct m0_reqh          coreqh;
+static struct m0_reqh_service *cosvc;
+static struct m0_mutex         co_lock;
+static struct m0_chan          co_chan;
+
+static void   co_fom_fini(struct m0_fom *fom);
+static int    co_fom_tick(struct m0_fom *fom);
+static size_t co_fom_home_locality(const struct m0_fom *fom);
+
+static const struct m0_fom_ops co_fom_ops = {
+	.fo_fini          = co_fom_fini,
+	.fo_tick          = co_fom_tick,
+	.fo_home_locality = co_fom_home_locality
+};
+
+static const struct m0_fom_type_ops co_fom_type_ops = {
+	.fto_create = NULL
+};
+
+/*************************************************/
+/*                  UT service                   */
+/*************************************************/
+
+static int cosvc_start(struct m0_reqh_service *svc)
+{
+	return 0;
+}
+
+static void cosvc_stop(struct m0_reqh_service *svc)
+{
+}
+
+static void cosvc_fini(struct m0_reqh_service *svc)
+{
+	m0_free(svc);
+}
+
+static const struct m0_reqh_service_ops cosvc_ops = {
+	.rso_start_async = &m0_reqh_service_async_start_simple,
+	.rso_start       = &cosvc_start,
+	.rso_stop        = &cosvc_stop,
+	.rso_fini        = &cosvc_fini
+};
+
+static int cosvc_type_allocate(struct m0_reqh_service            **svc,
+			       const struct m0_reqh_service_type  *stype)
+{
+	M0_ALLOC_PTR(*svc);
+	M0_UT_ASSERT(*svc != NULL);
+	(*svc)->rs_type = stype;
+	(*svc)->rs_ops = &cosvc_ops;
+	return 0;
+}
+
+static const struct m0_reqh_service_type_ops cosvc_type_ops = {
+	.rsto_service_allocate = &cosvc_type_allocate
+};
+
+static struct m0_reqh_service_type ut_co_service_type = {
+	.rst_name     = "co_ut",
+	.rst_ops      = &cosvc_type_ops,
+	.rst_level    = M0_RS_LEVEL_NORMAL,
+	.rst_typecode = M0_CST_DS2
+};
+
+/*************************************************/
+/*                 FOM routines                  */
+/*************************************************/
+
+static size_t co_fom_home_locality(const struct m0_fom *fom)
+{
+	return 1;
+}
+
+/** Waits on co_chan from a nested call, leaving frames on the fom stack. */
+static void co_fom_wait(struct co_fom *fom, int depth)
+{
+	if (depth > 0) {
+		co_fom_wait(fom, depth - 1);
+		return;
+	}
+	m0_mutex_lock(&co_lock);
+	fom->cf_before = m0_thread_self();
+	m0_semaphore_up(&fom->cf_sem_waiting);
+	m0_fom_co_wait(&fom->cf_fom, &co_chan);
+	fom->cf_after = m0_thread_self();
+	m0_mutex_unlock(&co_lock);
+}
+
+static int co_fom_tick(struct m0_fom *fom0)
+{
+	struct co_fom *fom = M0_AMB(fom, fom0, cf_fom);
+
+	if (fom->cf_blocker) {
+		/* Hand the locality to another thread until released. */
+		fom->cf_before = m0_thread_self();
+		m0_fom_block_enter(fom0);
+		m0_semaphore_up(&fom->cf_sem_waiting);
+		m0_semaphore_down(&fom->cf_sem_release);
+		m0_fom_block_leave(fom0);
+		m0_fom_phase_set(fom0, FINISH);
+		return M0_FSO_WAIT;
+	}
+	switch (m0_fom_phase(fom0)) {
+	case INIT:
+		for (; fom->cf_waits > 0; fom->cf_waits--) {
+			co_fom_wait(fom, 3);
+			m0_semaphore_up(&fom->cf_sem_resumed);
+		}
+		m0_fom_phase_set(fom0, PHASE1);
+		return M0_FSO_AGAIN;
+	case PHASE1:
+		m0_fom_phase_set(fom0, FINISH);
+		return M0_FSO_WAIT;
+	default:
+		M0_IMPOSSIBLE("Invalid phase");
+	}
+}
+
+static struct co_fom *co_fom_create(bool blocker, int waits)
+{
+	struct co_fom *fom;
+
+	M0_ALLOC_PTR(fom);
+	M0_UT_ASSERT(fom != NULL);
+	fom->cf_blocker = blocker;
+	fom->cf_waits   = waits;
+	m0_semaphore_init(&fom->cf_sem_waiting, 0);
+	m0_semaphore_init(&fom->cf_sem_resumed, 0);
+	m0_semaphore_init(&fom->cf_sem_release, 0);
+	m0_semaphore_init(&fom->cf_sem_fini, 0);
+	m0_fom_init(&fom->cf_fom, blocker ? &co_block_fomt : &co_fomt,
+		    &co_fom_ops, NULL, NULL, &coreqh);
+	m0_fom_queue(&fom->cf_fom);
+	return fom;
+}
+
+static void co_fom_destroy(struct co_fom *fom)
+{
+	/* Wait until the fom is finalised. */
+	m0_semaphore_down(&fom->cf_sem_fini);
+	m0_semaphore_fini(&fom->cf_sem_waiting);
+	m0_semaphore_fini(&fom->cf_sem_resumed);
+	m0_semaphore_fini(&fom->cf_sem_release);
+	m0_semaphore_fini(&fom->cf_sem_fini);
+	m0_free(fom);
+}
+
+static void co_fom_fini(struct m0_fom *fom0)
+{
+	struct co_fom *fom = M0_AMB(fom, fom0, cf_fom);
+
+	m0_fom_fini(fom0);
+	m0_semaphore_up(&fom->cf_sem_fini);
+}
+
+/** Signals co_chan once the stackful fom is parked on it. */
+static void co_signal(struct co_fom *fom)
+{
+	m0_semaphore_down(&fom->cf_sem_waiting);
+	/* The channel lock is released only after the fom has yielded. */
+	m0_mutex_lock(&co_lock);
+	M0_UT_ASSERT(m0_chan_has_waiters(&co_chan));
+	m0_chan_signal(&co_chan);
+	m0_mutex_unlock(&co_lock);
+	m0_semaphore_down(&fom->cf_sem_resumed);
+}
+
+/*************************************************/
+/*                 REQH routines                 */
+/*************************************************/
+
+static void co_init(void)
+{
+	int rc;
+
+	rc = M0_REQH_INIT(&coreqh,
+			  .rhia_dtm     = (void *)1,
+			  .rhia_mdstore = (void *)1,
+			  .rhia_fid     = &g_process_fid);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_reqh_service_allocate(&cosvc, &ut_co_service_type, NULL);
+	M0_UT_ASSERT(rc == 0);
+	m0_reqh_service_init(cosvc, &coreqh, NULL);
+	m0_reqh_service_start(cosvc);
+	m0_reqh_start(&coreqh);
+}
+
+static void co_fini(void)
+{
+	m0_reqh_service_prepare_to_stop(cosvc);
+	m0_reqh_idle_wait_for(&coreqh, cosvc);
+	m0_reqh_service_stop(cosvc);
+	m0_reqh_service_fini(cosvc);
+	m0_reqh_services_terminate(&coreqh);
+	m0_reqh_fini(&coreqh);
+}
+
+/*************************************************/
+/*                    Test cases                 */
+/*************************************************/
+
+static void co_wait_resume(void)
+{
+	struct co_fom *fom;
+	int            i;
+
+	co_init();
+	fom = co_fom_create(false, 3);
+	for (i = 0; i < 3; ++i) {
+		co_signal(fom);
+		M0_UT_ASSERT(fom->cf_before != NULL && fom->cf_after != NULL);
+	}
+	co_fom_destroy(fom);
+	co_fini();
+}
+
+static void co_wait_other_thread(void)
+{
+	struct co_fom *fom;
+	struct co_fom *blocker;
+
+	co_init();
+	fom = co_fom_create(false, 1);
+	m0_semaphore_down(&fom->cf_sem_waiting);
+	/*
+	 * The stackful fom is parked. The blocker takes the handler thread
+	 * away into m0_fom_block_enter(), another thread becomes the handler
+	 * of the locality and resumes the stackful fom.
+	 */
+	blocker = co_fom_create(true, 0);
+	m0_semaphore_down(&blocker->cf_sem_waiting);
+	m0_semaphore_up(&fom->cf_sem_waiting);
+	co_signal(fom);
+	/* The thread of the blocker is still blocked in the blocker tick. */
+	M0_UT_ASSERT(fom->cf_after != NULL);
+	M0_UT_ASSERT(fom->cf_after != blocker->cf_before);
+	m0_semaphore_up(&blocker->cf_sem_release);
+	co_fom_destroy(blocker);
+	co_fom_destroy(fom);
+	co_fini();
+}
+
+static int co_test_suite_init(void)
+{
+	m0_mutex_init(&co_lock);
+	m0_chan_init(&co_chan, &co_lock);
+	m0_fom_type_init(&co_fomt, M0_UT_CO_FOM_OPCODE,
+			 &co_fom_type_ops, &ut_co_service_type, &co_sm_conf);
+	co_fomt.ft_stackful = true;
+	m0_fom_type_init(&co_block_fomt, M0_UT_CO_BLOCK_FOM_OPCODE,
+			 &co_fom_type_ops, &ut_co_service_type, &co_sm_conf);
+	return 0;
+}
+
+static int co_test_suite_fini(void)
+{
+	m0_chan_fini_lock(&co_chan);
+	m0_mutex_fini(&co_lock);
+	return 0;
+}
+
+struct m0_ut_suite fom_co_ut = {
+	.ts_name = "fom-co-ut",
+	.ts_init = co_test_suite_init,
+	.ts_fini = co_test_suite_fini,
+	.ts_tests = {
+		{ "wait-resume",       co_wait_resume       },
+		{ "wait-other-thread", co_wait_other_thread },
+		{ NULL, NULL }
+	}
+};
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
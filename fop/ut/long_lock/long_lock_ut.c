@@ -51,14 +51,21 @@ static void test_long_lock_n(void)
 {
 	static struct m0_reqh *r[REQH_IN_UT_MAX] = { &rmach_ctx[0].rmc_reqh,
 						     &rmach_ctx[1].rmc_reqh };
-	rdwr_send_fop(r, REQH_IN_UT_MAX);
+	rdwr_send_fop(r, REQH_IN_UT_MAX, 0);
 }
 
 static void test_long_lock_1(void)
 {
 	static struct m0_reqh *r[1] = { &rmach_ctx[0].rmc_reqh };
 
-	rdwr_send_fop(r, 1);
+	rdwr_send_fop(r, 1, 0);
+}
+
+static void test_long_lock_rd(void)
+{
+	static struct m0_reqh *r[REQH_IN_UT_MAX] = { &rmach_ctx[0].rmc_reqh,
+						     &rmach_ctx[1].rmc_reqh };
+	rdwr_send_fop(r, REQH_IN_UT_MAX, 4);
 }
 
 static int ut_long_lock_service_start(struct m0_reqh_service *service)
@@ -163,6 +170,7 @@ struct m0_ut_suite m0_fop_lock_ut = {
 	.ts_tests = {
 		{ "fop-lock-1reqh", test_long_lock_1 },
 		{ "fop-lock-2reqh", test_long_lock_n },
+		{ "fop-lock-rd",    test_long_lock_rd },
 		{ NULL, NULL }
 	}
 };
@@ -106,6 +106,17 @@ static bool writer_check(struct m0_long_lock *lock)
 	return result;
 }
 
+/** Number of fast path readers of a reader-optimised lock. */
+static size_t fast_readers(const struct m0_long_lock *lock)
+{
+	size_t nr = 0;
+	int    i;
+
+	for (i = 0; i < lock->l_rd_nr; ++i)
+		nr += m0_atomic64_get(&lock->l_rd[i].lr_nr);
+	return nr;
+}
+
 /**
  * Checks expected readers and writers against actual.
  */
@@ -114,15 +125,19 @@ static bool lock_check(struct m0_long_lock *lock, enum tb_request_type type,
 {
 	bool result;
 	size_t owners_len;
+	size_t fast;
 
 	m0_mutex_lock(&lock->l_lock);
 
-	owners_len = m0_lll_tlist_length(&lock->l_owners);
+	fast = fast_readers(lock);
+	owners_len = m0_lll_tlist_length(&lock->l_owners) + fast;
 	result = owners_min <= owners_len && owners_len <= owners_max &&
 		m0_lll_tlist_length(&lock->l_waiters) == waiters &&
 
 		(type == RQ_WRITE) ? lock->l_state == M0_LONG_LOCK_WR_LOCKED :
-		(type == RQ_READ)  ? lock->l_state == M0_LONG_LOCK_RD_LOCKED :
+		(type == RQ_READ)  ? lock->l_state == M0_LONG_LOCK_RD_LOCKED ||
+				     (fast > 0 &&
+				      lock->l_state == M0_LONG_LOCK_UNLOCKED) :
 		false;
 
 	m0_mutex_unlock(&lock->l_lock);
@@ -293,13 +308,21 @@ static struct test_request test[3][RDWR_REQUEST_MAX] = {
 	},
 };
 
-static void rdwr_send_fop(struct m0_reqh **reqh, size_t reqh_nr)
+/**
+ * Runs the test sequences. If rd_nr is not 0, the lock is reader-optimised
+ * with rd_nr counters. The first reader of a sequence then takes the fast
+ * path, and the rest of the sequence goes through the queue as usual.
+ */
+static void rdwr_send_fop(struct m0_reqh **reqh, size_t reqh_nr,
+			  uint32_t rd_nr)
 {
 	int i;
 	int j;
 
 	for (j = 0; j < ARRAY_SIZE(test); ++j) {
 		m0_long_lock_init(&long_lock);
+		m0_long_lock_rd_init(&long_lock, rd_nr);
+		M0_UT_ASSERT((long_lock.l_rd != NULL) == (rd_nr > 1));
 
 		for (i = 0; test[j][i].tr_type != RQ_LAST; ++i) {
 			m0_chan_init(&chan[i], &long_lock.l_lock);
@@ -77,6 +77,7 @@
 #include "lib/time.h"           /* m0_time_from_now */
 
 #include "sm/sm.h"              /* m0_sm_state_descr */
+#include "xcode/xcode.h"        /* m0_xcode_data_size */
 #include "rpc/rpc.h"            /* m0_rpc_reply_post */
 #include "rpc/rpc_opcodes.h"    /* M0_HA_LINK_OUTGOING_OPCODE */
 
@@ -922,6 +923,7 @@ static int ha_link_incoming_fom_tick(struct m0_fom *fom)
 	struct m0_uint128              id_connection;
 	struct m0_ha_msg              *msg;
 	const char                    *ep;
+	uint32_t                       i;
 
 	req_fop = m0_fop_data(fom->fo_fop);
 	rep_fop = m0_fop_data(fom->fo_rep_fop);
@@ -930,9 +932,9 @@ static int ha_link_incoming_fom_tick(struct m0_fom *fom)
 	                 m0_fop_to_rpc_item(fom->fo_fop)->ri_session->s_conn);
 	M0_ENTRY("fom=%p req_fop=%p rep_fop=%p ep=%s",
 		 fom, req_fop, rep_fop, ep);
-	M0_LOG(M0_DEBUG, "ep=%p lmf_msg_nr=%" PRIu64 " lmf_id_remote="U128X_F" "
+	M0_LOG(M0_DEBUG, "ep=%p lms_nr=%" PRIu32 " lmf_id_remote="U128X_F" "
 	       "lmf_id_local="U128X_F" lmf_id_connection="U128X_F,
-	       ep, req_fop->lmf_msg_nr, U128_P(&req_fop->lmf_id_remote),
+	       ep, req_fop->lmf_msgs.lms_nr, U128_P(&req_fop->lmf_id_remote),
 	       U128_P(&req_fop->lmf_id_local),
 	       U128_P(&req_fop->lmf_id_connection));
 
@@ -941,8 +943,8 @@ static int ha_link_incoming_fom_tick(struct m0_fom *fom)
 	                                 &id_connection);
 	hli->hli_hl = hl;
 	M0_LOG(M0_DEBUG, "fom=%p hl=%p", fom, hl);
-	if (req_fop->lmf_msg_nr != 0) {
-		msg = &req_fop->lmf_msg;
+	for (i = 0; i < req_fop->lmf_msgs.lms_nr; ++i) {
+		msg = &req_fop->lmf_msgs.lms_msg[i];
 		M0_LOG(M0_DEBUG, "ep=%s lmf_id_remote="U128X_F" "
 		       "hm_fid="FID_F" hed_type=%d tag=%"PRIu64,
 		       ep, U128_P(&req_fop->lmf_id_remote), FID_P(&msg->hm_fid),
@@ -975,8 +977,8 @@ static int ha_link_incoming_fom_tick(struct m0_fom *fom)
 		rep_fop->lmr_rc = -EBADSLT;
 	} else {
 		m0_mutex_lock(&hl->hln_lock);
-		if (req_fop->lmf_msg_nr != 0)
-			ha_link_msg_received(hl, &req_fop->lmf_msg);
+		for (i = 0; i < req_fop->lmf_msgs.lms_nr; ++i)
+			ha_link_msg_received(hl, &req_fop->lmf_msgs.lms_msg[i]);
 		if (!hl->hln_no_new_delivered) {
 			ha_link_tags_update(hl, req_fop->lmf_out_next,
 			                    req_fop->lmf_in_delivered);
@@ -1055,6 +1057,7 @@ static int ha_link_incoming_fom_create(struct m0_fop   *fop,
 
 const struct m0_fom_type_ops m0_ha_link_incoming_fom_type_ops = {
 	.fto_create = &ha_link_incoming_fom_create,
+	.fto_prio   = M0_FOM_PRIO_HIGH,
 };
 
 enum ha_link_outgoing_fom_state {
@@ -1174,6 +1177,8 @@ static void ha_link_outgoing_fop_release(struct m0_ref *ref)
 	/* XXX bob_of */
 	hl = container_of(fop, struct m0_ha_link, hln_outgoing_fop);
 	M0_ENTRY("hl=%p fop=%p", hl, fop);
+	if (hl->hln_req_fop_data.lmf_msgs.lms_msg != &hl->hln_msg_one)
+		m0_free(hl->hln_req_fop_data.lmf_msgs.lms_msg);
 	fop->f_data.fd_data = NULL;
 	m0_fop_fini(fop);
 	m0_mutex_lock(&hl->hln_lock);
@@ -1184,11 +1189,49 @@ static void ha_link_outgoing_fop_release(struct m0_ref *ref)
 	M0_LEAVE();
 }
 
+/**
+ * Takes messages to send from hln_q_out, as many as fit in one fop.
+ * The first message is taken regardless of its size.
+ */
+static void ha_link_msg_to_send_fill(struct m0_ha_link *hl)
+{
+	struct m0_xcode_ctx  ctx;
+	struct m0_ha_msg    *msg;
+	m0_bcount_t          size_max;
+	m0_bcount_t          size = 0;
+	int                  len;
+
+	M0_PRE(m0_mutex_is_locked(&hl->hln_lock));
+	M0_PRE(hl->hln_msg_to_send_nr == 0);
+
+	size_max = m0_rpc_session_get_max_item_payload_size(
+						&hl->hln_rpc_link.rlk_sess);
+	size_max -= min_check(size_max,
+			      (m0_bcount_t)sizeof hl->hln_req_fop_data);
+	while (hl->hln_msg_to_send_nr < ARRAY_SIZE(hl->hln_msg_to_send)) {
+		msg = m0_ha_lq_next(&hl->hln_q_out);
+		if (msg == NULL)
+			break;
+		len = m0_xcode_data_size(&ctx,
+					 &M0_XCODE_OBJ(m0_ha_msg_xc, msg));
+		if (hl->hln_msg_to_send_nr > 0 &&
+		    (len < 0 || size + len > size_max)) {
+			(void)m0_ha_lq_try_unnext(&hl->hln_q_out);
+			break;
+		}
+		size += max_check(len, 0);
+		hl->hln_msg_to_send[hl->hln_msg_to_send_nr++] = msg;
+	}
+}
+
 static int ha_link_outgoing_fop_send(struct m0_ha_link *hl)
 {
 	struct m0_ha_link_msg_fop *req_fop = &hl->hln_req_fop_data;
 	struct m0_ha_link_params  *params;
 	struct m0_rpc_item        *item;
+	struct m0_ha_msg          *msgs = NULL;
+	uint32_t                   nr = hl->hln_msg_to_send_nr;
+	uint32_t                   i;
 
 	M0_ENTRY("hl=%p", hl);
 	M0_SET0(&hl->hln_outgoing_fop);
@@ -1196,13 +1239,22 @@ static int ha_link_outgoing_fop_send(struct m0_ha_link *hl)
 	m0_fop_init(&hl->hln_outgoing_fop, &m0_ha_link_msg_fopt,
 	            req_fop, &ha_link_outgoing_fop_release);
 
-	if (hl->hln_msg_to_send == NULL) {
-		req_fop->lmf_msg_nr = 0;
-	} else {
-		req_fop->lmf_msg_nr = 1;
-		req_fop->lmf_msg    = *hl->hln_msg_to_send;
-	}
+	if (nr > 1)
+		M0_ALLOC_ARR(msgs, nr);
 	m0_mutex_lock(&hl->hln_lock);
+	if (nr > 0 && msgs == NULL) {
+		/* Sends the rest of the messages with the next fops. */
+		for (; nr > 1; --nr)
+			(void)m0_ha_lq_try_unnext(&hl->hln_q_out);
+		hl->hln_msg_to_send_nr = nr;
+		msgs = &hl->hln_msg_one;
+	}
+	for (i = 0; i < nr; ++i)
+		msgs[i] = *hl->hln_msg_to_send[i];
+	req_fop->lmf_msgs = (struct m0_ha_link_msg_seq){
+		.lms_nr  = nr,
+		.lms_msg = msgs,
+	};
 	/* TODO use designated initialiser after m0_ha_msg become small */
 	params = &hl->hln_conn_cfg.hlcc_params;
 	req_fop->lmf_id_local       = params->hlp_id_local;
@@ -1212,14 +1264,12 @@ static int ha_link_outgoing_fop_send(struct m0_ha_link *hl)
 	ha_link_tags_in_out(hl, &req_fop->lmf_out_next,
 	                    &req_fop->lmf_in_delivered);
 	M0_LOG(M0_DEBUG, "lmf_id_remote="U128X_F" lmf_id_local="U128X_F" "
-	       "lmf_id_connection="U128X_F" lmf_msg_nr=%" PRIu64 " tag=%" PRIu64 " "
+	       "lmf_id_connection="U128X_F" lms_nr=%" PRIu32 " tag=%" PRIu64 " "
 	       "lmf_seq=%"PRIu64,
 	       U128_P(&req_fop->lmf_id_remote),
 	       U128_P(&req_fop->lmf_id_local),
 	       U128_P(&req_fop->lmf_id_connection),
-	       req_fop->lmf_msg_nr,
-	       hl->hln_msg_to_send == NULL ?
-	       M0_HA_MSG_TAG_UNKNOWN : m0_ha_msg_tag(hl->hln_msg_to_send),
+	       nr, nr == 0 ? M0_HA_MSG_TAG_UNKNOWN : m0_ha_msg_tag(&msgs[0]),
 	       req_fop->lmf_seq);
 	m0_mutex_unlock(&hl->hln_lock);
 	item = m0_fop_to_rpc_item(&hl->hln_outgoing_fop);
@@ -1259,6 +1309,7 @@ static int ha_link_outgoing_fop_replied(struct m0_ha_link *hl)
 	struct m0_rpc_item            *req_item;
 	uint64_t                       old_nr;
 	uint64_t                       nr;
+	uint32_t                       i;
 	int                            old_rc;
 	int                            rc;
 
@@ -1275,8 +1326,12 @@ static int ha_link_outgoing_fop_replied(struct m0_ha_link *hl)
 					    rep_fop->lmr_in_delivered);
 	}
 
-	if (rc != 0)
-		m0_ha_lq_try_unnext(&hl->hln_q_out);
+	if (rc != 0) {
+		i = 0;
+		do {
+			m0_ha_lq_try_unnext(&hl->hln_q_out);
+		} while (++i < hl->hln_msg_to_send_nr);
+	}
 
 	if (ha_link_backoff_check(hl, rc, &nr, &old_rc, &old_nr)) {
 		m0_ha_lq_tags_get(&hl->hln_q_out, &tags);
@@ -1364,7 +1419,7 @@ static int ha_link_outgoing_fom_tick(struct m0_fom *fom)
 
 	switch (phase) {
 	case HA_LINK_OUTGOING_STATE_INIT:
-		hl->hln_msg_to_send      = NULL;
+		hl->hln_msg_to_send_nr   = 0;
 		hl->hln_confirmed_update = false;
 		hl->hln_rpc_rc           = 0;
 		hl->hln_reply_rc         = 0;
@@ -1519,7 +1574,7 @@ static int ha_link_outgoing_fom_tick(struct m0_fom *fom)
 		}
 		return M0_RC(M0_FSO_WAIT);
 	case HA_LINK_OUTGOING_STATE_IDLE:
-		M0_ASSERT(hl->hln_msg_to_send == NULL);
+		M0_ASSERT(hl->hln_msg_to_send_nr == 0);
 		hl->hln_replied  = false;
 		hl->hln_released = false;
 		ha_link_cb_disconnecting_reused(hl);
@@ -1581,10 +1636,10 @@ static int ha_link_outgoing_fom_tick(struct m0_fom *fom)
 			return M0_RC(M0_FSO_AGAIN);
 		}
 		m0_mutex_lock(&hl->hln_lock);
-		hl->hln_msg_to_send = m0_ha_lq_next(&hl->hln_q_out);
+		ha_link_msg_to_send_fill(hl);
 		hl->hln_confirmed_update = ha_link_q_in_confirm_all(hl);
 		m0_mutex_unlock(&hl->hln_lock);
-		if (hl->hln_msg_to_send != NULL || hl->hln_confirmed_update) {
+		if (hl->hln_msg_to_send_nr > 0 || hl->hln_confirmed_update) {
 			m0_fom_phase_set(fom, HA_LINK_OUTGOING_STATE_SEND);
 			return M0_RC(M0_FSO_AGAIN);
 		}
@@ -1601,7 +1656,7 @@ static int ha_link_outgoing_fom_tick(struct m0_fom *fom)
 		if (replied) {
 			m0_mutex_lock(&hl->hln_lock);
 			hl->hln_reply_rc = ha_link_outgoing_fop_replied(hl);
-			hl->hln_msg_to_send = NULL;
+			hl->hln_msg_to_send_nr = 0;
 			m0_mutex_unlock(&hl->hln_lock);
 			if (hl->hln_reply_rc == 0)
 				hl->hln_confirmed_update = false;
@@ -1706,6 +1761,7 @@ static int ha_link_outgoing_fom_create(struct m0_fop   *fop,
 
 const struct m0_fom_type_ops m0_ha_link_outgoing_fom_type_ops = {
 	.fto_create = &ha_link_outgoing_fom_create,
+	.fto_prio   = M0_FOM_PRIO_HIGH,
 };
 
 M0_INTERNAL struct m0_rpc_session *m0_ha_link_rpc_session(struct m0_ha_link *hl)
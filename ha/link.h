@@ -214,7 +214,18 @@ struct m0_ha_link {
 	struct m0_mutex             hln_stop_chan_lock;
 	bool                        hln_waking_up;
 	struct m0_sm_ast            hln_waking_ast;
-	struct m0_ha_msg           *hln_msg_to_send;
+	/**
+	 * Messages of the outgoing fop. All messages pending in hln_q_out are
+	 * sent in one fop, up to M0_HA_LINK_MSG_BATCH_MAX messages and the
+	 * rpc item payload size.
+	 */
+	struct m0_ha_msg           *hln_msg_to_send[M0_HA_LINK_MSG_BATCH_MAX];
+	uint32_t                    hln_msg_to_send_nr;
+	/**
+	 * Copy of the message of the outgoing fop if the fop has a single
+	 * message or if the array of copies can't be allocated.
+	 */
+	struct m0_ha_msg            hln_msg_one;
 	/** It's protected by outgoing fom sm group lock */
 	bool                        hln_confirmed_update;
 	struct m0_fop               hln_outgoing_fop;
@@ -46,9 +46,19 @@ struct m0_ha_link_tags {
 	uint64_t hlt_assign;
 } M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
 
+enum {
+	/** Maximum number of messages sent in one m0_ha_link_msg_fop. */
+	M0_HA_LINK_MSG_BATCH_MAX = 32,
+};
+
+/** Messages of a m0_ha_link_msg_fop, in the order of their tags. */
+struct m0_ha_link_msg_seq {
+	uint32_t               lms_nr;
+	struct m0_ha_msg      *lms_msg;
+} M0_XCA_SEQUENCE M0_XCA_DOMAIN(rpc);
+
 struct m0_ha_link_msg_fop {
-	uint64_t               lmf_msg_nr;
-	struct m0_ha_msg       lmf_msg;
+	struct m0_ha_link_msg_seq lmf_msgs;
 	struct m0_uint128      lmf_id_local;
 	struct m0_uint128      lmf_id_remote;
 	struct m0_uint128      lmf_id_connection;
@@ -235,7 +235,13 @@ static void usage()
 			"[options: keep_latest]\n");
 	printf("    multi_release <fid> <offset> <len> <max_tier> "
 			"[options: keep_latest]\n");
-	printf("    set_write_tier <fid> <tier>\n\n");
+	printf("    set_write_tier <fid> <tier>\n");
+	printf("    migrate <fid_list> <offset> <len> <src_tier> "
+			"<tgt_tier> [options: mv,keep_prev,w2dest,"
+			"log=<path>]\n\n");
+	printf("  <fid_list> is a file with one <fid> per line. Objects are "
+	       "migrated in parallel\n"
+	       "  by the number of threads given by -j option.\n");
 	printf("  <fid> parameter format is [hi:]lo. "
 	                  "(hi == 0 if not specified.)\n");
 	printf("  The numbers are read in decimal, hexadecimal "
@@ -277,17 +283,25 @@ int read_fid(const char *s, struct m0_uint128 *fid)
 	return res;
 }
 
-static int parse_copy_subopt(char *opts, enum hsm_cp_flags *flags)
+/**
+ * Parse copy options.
+ * @param log	Set to the path of the migration log if given,
+ *		NULL if the option is not allowed.
+ */
+static int parse_copy_subopt(char *opts, enum hsm_cp_flags *flags,
+			     char **log)
 {
 	enum copy_opt {
 		OPT_MOVE = 0,
 		OPT_KEEP_PREV_VERS = 1,
 		OPT_WRITE_TO_DEST = 2,
+		OPT_LOG = 3,
 	};
 	char *const options[] = {
 		[OPT_MOVE]	     = "mv",
 		[OPT_KEEP_PREV_VERS] = "keep_prev",
 		[OPT_WRITE_TO_DEST]  = "w2dest",
+		[OPT_LOG]	     = "log",
 		NULL,
 	};
 	char *subopts = opts;
@@ -306,6 +320,14 @@ static int parse_copy_subopt(char *opts, enum hsm_cp_flags *flags)
 		case OPT_WRITE_TO_DEST:
 			*flags |= HSM_WRITE_TO_DEST;
 			break;
+
+		case OPT_LOG:
+			if (log == NULL || value == NULL) {
+				fprintf(stderr, "Unexpected option: log\n");
+				return -EINVAL;
+			}
+			*log = value;
+			break;
 		default:
 			fprintf(stderr, "Unexpected option: %s\n", value);
 			return -EINVAL;
@@ -343,8 +365,11 @@ static int parse_release_subopt(char *opts, enum hsm_rls_flags *flags)
 static const struct option option_tab[] = {
 	{"quiet", no_argument, NULL, 'q'},
 	{"verbose", required_argument, NULL, 'v'},
+	{"io-depth", required_argument, NULL, 'd'},
+	{"jobs", required_argument, NULL, 'j'},
+	{NULL, 0, NULL, 0},
 };
-#define SHORT_OPT "qv"
+#define SHORT_OPT "qvd:j:"
 
 static int parse_cmd_options(int argc, char **argv)
 {
@@ -361,6 +386,12 @@ static int parse_cmd_options(int argc, char **argv)
 			if (hsm_options.trace_level < LOG_DEBUG)
 				hsm_options.trace_level++;
 			break;
+		case 'd':
+			hsm_options.io_depth = atoi(optarg);
+			break;
+		case 'j':
+			hsm_options.migrate_threads = atoi(optarg);
+			break;
 		case ':':
 		case '?':
 		default:
@@ -374,6 +405,96 @@ static int parse_cmd_options(int argc, char **argv)
 int m0hsm_test_write(struct m0_uint128 id, off_t offset, size_t len, int seed);
 int m0hsm_test_read(struct m0_uint128 id, off_t offset, size_t len);
 
+/** Read the list of fids to be migrated, one per line */
+static int read_fid_list(const char *path, struct m0_uint128 **ids, int *nr)
+{
+	struct m0_uint128 *tt;
+	char line[128];
+	int size = 0;
+	FILE *f;
+	int rc = 0;
+
+	f = fopen(path, "r");
+	if (f == NULL) {
+		fprintf(stderr, "failed to open '%s': %s\n", path,
+			strerror(errno));
+		return -1;
+	}
+
+	*ids = NULL;
+	*nr = 0;
+	while (fgets(line, sizeof line, f) != NULL) {
+		if (*nr == size) {
+			size = size * 2 ?: 64;
+			tt = realloc(*ids, size * sizeof **ids);
+			if (tt == NULL) {
+				fprintf(stderr, "m0hsm: allocation error\n");
+				rc = -1;
+				break;
+			}
+			*ids = tt;
+		}
+		if (read_fid(line, &(*ids)[*nr]) <= 0) {
+			fprintf(stderr, "invalid fid in '%s': %s", path, line);
+			rc = -1;
+			break;
+		}
+		(*nr)++;
+	}
+	fclose(f);
+
+	if (rc) {
+		free(*ids);
+		*ids = NULL;
+	}
+	return rc;
+}
+
+static int run_migrate(int argc, char **argv)
+{
+	struct m0_uint128 *ids;
+	const char *path;
+	char *log = NULL;
+	off_t offset;
+	size_t len;
+	int src_tier;
+	int tgt_tier;
+	int nr;
+	enum hsm_cp_flags flags = 0;
+	int rc;
+
+	/* at least 5 arguments */
+	if (optind > argc - 5) {
+		usage();
+		return -1;
+	}
+	path = argv[optind];
+	optind++;
+	offset = read_arg64(argv[optind]);
+	optind++;
+	len = read_arg64(argv[optind]);
+	optind++;
+	src_tier = atoi(argv[optind]);
+	optind++;
+	tgt_tier = atoi(argv[optind]);
+	optind++;
+	if (src_tier > HSM_TIER_MAX || tgt_tier > HSM_TIER_MAX) {
+		fprintf(stderr, "Max tier index: %u\n", HSM_TIER_MAX);
+		return -1;
+	}
+	if (optind < argc)
+		if (parse_copy_subopt(argv[optind], &flags, &log))
+			 return -1;
+
+	if (read_fid_list(path, &ids, &nr))
+		return -1;
+
+	rc = m0hsm_migrate(ids, nr, src_tier, tgt_tier, offset, len, flags,
+			   log);
+	free(ids);
+	return rc;
+}
+
 static int run_cmd(int argc, char **argv)
 {
 	struct m0_uint128 id;
@@ -394,6 +515,9 @@ static int run_cmd(int argc, char **argv)
 	action = argv[optind];
 
 	optind++;
+	if (m0_streq(action, "migrate"))
+		return run_migrate(argc, argv);
+
 	id = M0_ID_APP;
 	rc = read_fid(argv[optind], &id);
 	if (rc <= 0) {
@@ -491,7 +615,7 @@ static int run_cmd(int argc, char **argv)
 			return -1;
 		}
 		if (optind < argc)
-			if (parse_copy_subopt(argv[optind], &flags))
+			if (parse_copy_subopt(argv[optind], &flags, NULL))
 				 return -1;
 
 		/* force move flag for 'move' action */
@@ -522,7 +646,7 @@ static int run_cmd(int argc, char **argv)
 			return -1;
 		}
 		if (optind < argc)
-			if (parse_copy_subopt(argv[optind], &flags))
+			if (parse_copy_subopt(argv[optind], &flags, NULL))
 				 return -1;
 
 		rc = m0hsm_stage(id, tgt_tier, offset, len, flags);
@@ -549,7 +673,7 @@ static int run_cmd(int argc, char **argv)
 			return -1;
 		}
 		if (optind < argc)
-			if (parse_copy_subopt(argv[optind], &flags))
+			if (parse_copy_subopt(argv[optind], &flags, NULL))
 				 return -1;
 
 		rc = m0hsm_archive(id, tgt_tier, offset, len, flags);
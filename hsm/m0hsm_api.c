@@ -38,6 +38,11 @@
 #include <stdarg.h>
 
 #include "lib/trace.h"
+#include "lib/arith.h"
+#include "lib/memory.h"
+#include "lib/mutex.h"
+#include "lib/thread.h"
+#include "lib/time.h"
 #include "conf/obj.h"
 #include "fid/fid.h"
 #include "motr/idx.h"
@@ -102,6 +107,18 @@ struct param {
 static struct param  hsm_rc_params[128];
 static struct m0_fid hsm_pools[MAX_POOLS] = {};
 
+/** Bandwidth limit of a tier, shared by all the copies to or from it */
+struct tier_bw {
+	/** bytes per second, 0 if unlimited */
+	uint64_t  tb_rate;
+	/** when the next transfer may start */
+	m0_time_t tb_next;
+};
+
+static struct tier_bw  hsm_tier_bw[MAX_POOLS] = {};
+/** protects hsm_tier_bw[].tb_next */
+static struct m0_mutex hsm_tier_bw_lock;
+
 static int read_params(FILE *in, struct param *p, int max_params)
 {
 	int ln, n=0;
@@ -144,6 +161,28 @@ static int hsm_pool_fid_set(struct param *p)
 	return 0;
 }
 
+static int hsm_tier_bw_set(struct param *p)
+{
+	int i;
+	char pname[32];
+	char *end;
+
+	for (i = 0; i < MAX_POOLS; i++) {
+		sprintf(pname, "M0_TIER%d_BW", i + 1);
+		if (strcmp(p->name, pname) == 0) {
+			hsm_tier_bw[i].tb_rate = strtoull(p->value, &end, 0);
+			if (end == p->value) {
+				ERROR("%s: failed to parse %s\n",
+				      __func__, pname);
+				return -1;
+			}
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
 static int hsm_pools_fids_set(struct param p[], int n)
 {
 	int i, rc;
@@ -153,6 +192,8 @@ static int hsm_pools_fids_set(struct param p[], int n)
 		DBG("%s: rc=%d\n", __func__, rc);
 		if (rc < 0)
 			return rc;
+		if (rc == 0 && hsm_tier_bw_set(p) < 0)
+			return -1;
 	}
 
 	if (i < 1) {
@@ -181,6 +222,7 @@ int m0hsm_init(struct m0_client *instance, struct m0_realm *uber_realm,
 
 	m0_instance   = instance;
 	m0_uber_realm = uber_realm;
+	m0_mutex_init(&hsm_tier_bw_lock);
 
 	if ((rc = read_params(options.rcfile, hsm_rc_params,
 			ARRAY_SIZE(hsm_rc_params))) < 0) {
@@ -1644,29 +1686,46 @@ struct io_ctx {
 	struct m0_bufvec   attr;
 };
 
-/** write a block to an open entity */
-static int do_io_op(struct m0_obj *obj, enum m0_obj_opcode opcode,
-		    struct io_ctx *ctx)
+/** launch an I/O operation on an open entity, without waiting for it */
+static int io_op_launch(struct m0_obj *obj, enum m0_obj_opcode opcode,
+			struct io_ctx *ctx, struct m0_op **op)
 {
-	struct m0_op *ops[1] = {NULL};
 	int rc;
-	ENTRY;
 
-	/* Create the write request */
-	m0_obj_op(obj, opcode, &ctx->ext, &ctx->data, &ctx->attr,
-		  0, 0, &ops[0]);
+	*op = NULL;
+	rc = m0_obj_op(obj, opcode, &ctx->ext, &ctx->data, &ctx->attr,
+		       0, 0, op);
+	if (rc)
+		return rc;
+	m0_op_launch(op, 1);
+	return 0;
+}
 
-	/* Launch the write request*/
-	m0_op_launch(ops, 1);
+/** wait for completion of an I/O operation and release it */
+static int io_op_wait(struct m0_op **op)
+{
+	int rc;
 
-	/* wait for completion */
-	rc = m0_op_wait(ops[0], M0_BITS(M0_OS_FAILED,
-					       M0_OS_STABLE),
-			       M0_TIME_NEVER) ?: m0_rc(ops[0]);
+	rc = m0_op_wait(*op, M0_BITS(M0_OS_FAILED, M0_OS_STABLE),
+			M0_TIME_NEVER) ?: m0_rc(*op);
 
 	/* finalize and release */
-	m0_op_fini(ops[0]);
-	m0_op_free(ops[0]);
+	m0_op_fini(*op);
+	m0_op_free(*op);
+	*op = NULL;
+
+	return rc;
+}
+
+/** write a block to an open entity */
+static int do_io_op(struct m0_obj *obj, enum m0_obj_opcode opcode,
+		    struct io_ctx *ctx)
+{
+	struct m0_op *op;
+	int rc;
+	ENTRY;
+
+	rc = io_op_launch(obj, opcode, ctx, &op) ?: io_op_wait(&op);
 
 	RETURN(rc);
 }
@@ -2103,7 +2162,52 @@ int m0hsm_test_read(struct m0_uint128 id, off_t offset, size_t len)
 	RETURN(rc);
 }
 
-/** copy an extent from one (flat) object to another */
+/**
+ * Wait until len bytes can be transferred to or from the tier without
+ * exceeding its bandwidth limit. Each transfer reserves a time slot
+ * of len / rate seconds after the slots reserved by the previous ones
+ * (from any thread), and sleeps until its slot comes.
+ */
+static void tier_bw_throttle(uint8_t tier, size_t len)
+{
+	struct tier_bw *bw;
+	m0_time_t	now;
+	m0_time_t	start;
+
+	if (tier < 1 || tier > MAX_POOLS)
+		return;
+	bw = &hsm_tier_bw[tier - 1];
+	if (bw->tb_rate == 0)
+		return;
+
+	m0_mutex_lock(&hsm_tier_bw_lock);
+	now = m0_time_now();
+	start = max_check(bw->tb_next, now);
+	bw->tb_next = m0_time_add(start, len * M0_TIME_ONE_SECOND /
+				  bw->tb_rate);
+	m0_mutex_unlock(&hsm_tier_bw_lock);
+
+	if (start > now)
+		m0_nanosleep(m0_time_sub(start, now), NULL);
+}
+
+/** an I/O buffer of a pipelined extent copy */
+struct copy_slot {
+	struct io_ctx	   cs_ctx;
+	/** operation in flight (NULL if none) */
+	struct m0_op	  *cs_op;
+	/** read from the source, or write to the target */
+	enum m0_obj_opcode cs_opcode;
+};
+
+/**
+ * Copy an extent from one (flat) object to another.
+ *
+ * The extent is copied by blocks of the optimal size of the target
+ * object, through up to options.io_depth buffers: each buffer is read
+ * from the source and then written to the target asynchronously, so
+ * that reads and writes of successive blocks overlap.
+ */
 static int copy_extent_data(struct m0_uint128 src_id,
 			    struct m0_uint128 tgt_id,
 		            const struct extent *range)
@@ -2111,10 +2215,18 @@ static int copy_extent_data(struct m0_uint128 src_id,
 	struct m0_obj src_obj = {};
 	struct m0_obj tgt_obj = {};
 	size_t block_size;
-	struct io_ctx ctx = {};
+	struct copy_slot *slots;
+	struct copy_slot *s;
+	uint8_t src_tier = hsm_prio2tier(src_id.u_hi);
+	uint8_t tgt_tier = hsm_prio2tier(tgt_id.u_hi);
+	unsigned depth;
+	unsigned busy = 0;
+	unsigned i;
 	size_t rest = range->len;
+	size_t len;
 	off_t start = range->off;
 	int rc;
+	int rc2;
 	ENTRY;
 
 	m0_obj_init(&src_obj, m0_uber_realm, &src_id,
@@ -2137,42 +2249,97 @@ static int copy_extent_data(struct m0_uint128 src_id,
 		goto fini;
 	}
 
-	VERB("Using I/O block size of %zu bytes\n", block_size);
+	depth = options.io_depth ?: HSM_IO_DEPTH_DEF;
+	depth = min_check(depth, (unsigned)HSM_IO_DEPTH_MAX);
+	/* no more buffers than blocks */
+	depth = min_check((uint64_t)depth,
+			  (rest + block_size - 1) / block_size) ?: 1;
 
-	for (; rest > 0; rest -= block_size, start += block_size) {
-		if (rest < block_size)
-			/* non full block */
-			block_size = rest;
+	VERB("Using I/O block size of %zu bytes, %u in flight\n",
+	     block_size, depth);
 
-		rc = prepare_io_ctx(&ctx, 1, block_size, true);
+	M0_ALLOC_ARR(slots, depth);
+	if (slots == NULL) {
+		rc = -ENOMEM;
+		goto fini;
+	}
+
+	/*
+	 * Buffers are used in turn: the write of a buffer is launched
+	 * once its read completes, and the read of the next block
+	 * is launched once its write completes.
+	 */
+	for (i = 0; rest > 0 || busy > 0; i = (i + 1) % depth) {
+		s = &slots[i];
+		if (s->cs_op != NULL) {
+			rc = io_op_wait(&s->cs_op);
+			busy--;
+			if (rc) {
+				ERROR("%s failed: rc=%d\n",
+				      s->cs_opcode == M0_OC_READ ?
+				      "read" : "write", rc);
+				break;
+			}
+			if (s->cs_opcode == M0_OC_READ) {
+				/* now write data to the target object */
+				tier_bw_throttle(tgt_tier,
+						 s->cs_ctx.curr_bsize);
+				s->cs_opcode = M0_OC_WRITE;
+				rc = io_op_launch(&tgt_obj, M0_OC_WRITE,
+						  &s->cs_ctx, &s->cs_op);
+				if (rc) {
+					ERROR("write launch failed: rc=%d\n",
+					      rc);
+					break;
+				}
+				busy++;
+				continue;
+			}
+		}
+		if (rest == 0)
+			continue;
+
+		/* non full last block */
+		len = min_check(rest, block_size);
+		rc = prepare_io_ctx(&s->cs_ctx, 1, len, true);
 		if (rc) {
 			ERROR("prepare_io_ctx() failed: rc=%d\n", rc);
-			goto fini;
+			break;
 		}
 
-		rc = map_io_ctx(&ctx, 1, block_size, start, NULL);
+		rc = map_io_ctx(&s->cs_ctx, 1, len, start, NULL);
 		if (rc) {
 			ERROR("map_io_ctx() failed: rc=%d\n", rc);
 			break;
 		}
 
 		/* read blocks */
-		rc = read_blocks(&src_obj, &ctx);
+		tier_bw_throttle(src_tier, len);
+		s->cs_opcode = M0_OC_READ;
+		rc = io_op_launch(&src_obj, M0_OC_READ, &s->cs_ctx, &s->cs_op);
 		if (rc) {
-			ERROR("read_blocks() failed: rc=%d\n", rc);
+			ERROR("read launch failed: rc=%d\n", rc);
 			break;
 		}
+		busy++;
+		rest -= len;
+		start += len;
+	}
 
-		/* now write data to the target object */
-		rc = write_blocks(&tgt_obj, &ctx);
-		if (rc) {
-			ERROR("write_blocks() failed: rc=%d\n", rc);
-			break;
+	for (i = 0; i < depth; i++) {
+		/* wait for the operations still in flight after an error */
+		if (slots[i].cs_op != NULL) {
+			rc2 = io_op_wait(&slots[i].cs_op);
+			if (rc2)
+				ERROR("%s failed: rc=%d\n",
+				      slots[i].cs_opcode == M0_OC_READ ?
+				      "read" : "write", rc2);
 		}
+		/* Free bufvec's and indexvec's */
+		if (slots[i].cs_ctx.curr_blocks != 0)
+			free_io_ctx(&slots[i].cs_ctx, true);
 	}
-
-	/* Free bufvec's and indexvec's */
-	free_io_ctx(&ctx, true);
+	m0_free(slots);
  fini:
 	m0_entity_fini(&tgt_obj.ob_entity);
  out_close_src:
@@ -2862,6 +3029,190 @@ int m0hsm_archive(struct m0_uint128 id, uint8_t tgt_tier,
 	RETURN(rc);
 }
 
+/** shared state of the threads of a migration */
+struct migrate_ctx {
+	const struct m0_uint128 *mc_ids;
+	int			 mc_nr;
+	/** ids found in the migration log, sorted */
+	struct m0_uint128	*mc_done;
+	int			 mc_done_nr;
+	uint8_t			 mc_src_tier;
+	uint8_t			 mc_tgt_tier;
+	off_t			 mc_off;
+	size_t			 mc_len;
+	enum hsm_cp_flags	 mc_flags;
+	FILE			*mc_log;
+	/** protects the fields below and the log */
+	struct m0_mutex		 mc_lock;
+	/** next object to be copied */
+	int			 mc_next;
+	/** error of the first failed copy */
+	int			 mc_rc;
+};
+
+static int id_cmp(const void *a, const void *b)
+{
+	const struct m0_uint128 *u0 = a;
+	const struct m0_uint128 *u1 = b;
+
+	return M0_3WAY(u0->u_hi, u1->u_hi) ?: M0_3WAY(u0->u_lo, u1->u_lo);
+}
+
+/**
+ * Load the ids of the objects already copied between the same tiers
+ * from the migration log.
+ */
+static int migrate_log_load(struct migrate_ctx *mc)
+{
+	struct m0_uint128 id;
+	struct m0_uint128 *done;
+	unsigned src;
+	unsigned tgt;
+	int size = 0;
+
+	rewind(mc->mc_log);
+	while (fscanf(mc->mc_log, "%" SCNx64 ":%" SCNx64 " %u %u\n",
+		      &id.u_hi, &id.u_lo, &src, &tgt) == 4) {
+		if (src != mc->mc_src_tier || tgt != mc->mc_tgt_tier)
+			continue;
+		if (mc->mc_done_nr == size) {
+			size = size * 2 ?: 64;
+			done = realloc(mc->mc_done, size * sizeof *done);
+			if (done == NULL)
+				return -ENOMEM;
+			mc->mc_done = done;
+		}
+		mc->mc_done[mc->mc_done_nr++] = id;
+	}
+	qsort(mc->mc_done, mc->mc_done_nr, sizeof *mc->mc_done, id_cmp);
+
+	return 0;
+}
+
+static bool migrate_is_done(const struct migrate_ctx *mc,
+			    const struct m0_uint128 *id)
+{
+	return mc->mc_done_nr > 0 &&
+		bsearch(id, mc->mc_done, mc->mc_done_nr,
+			sizeof *mc->mc_done, id_cmp) != NULL;
+}
+
+/** copy the objects of a migration until there is none left */
+static void migrate_thread(struct migrate_ctx *mc)
+{
+	const struct m0_uint128 *id;
+	int idx;
+	int rc;
+
+	while (1) {
+		m0_mutex_lock(&mc->mc_lock);
+		idx = mc->mc_next++;
+		m0_mutex_unlock(&mc->mc_lock);
+		if (idx >= mc->mc_nr)
+			break;
+
+		id = &mc->mc_ids[idx];
+		if (migrate_is_done(mc, id)) {
+			VERB("Object <%#" PRIx64 ":%#" PRIx64 "> already "
+			     "migrated: skipping\n", id->u_hi, id->u_lo);
+			continue;
+		}
+
+		rc = m0hsm_copy(*id, mc->mc_src_tier, mc->mc_tgt_tier,
+				mc->mc_off, mc->mc_len, mc->mc_flags);
+
+		m0_mutex_lock(&mc->mc_lock);
+		if (rc) {
+			ERROR("Failed to migrate object <%#" PRIx64
+			      ":%#" PRIx64 ">: rc=%d\n",
+			      id->u_hi, id->u_lo, rc);
+			if (mc->mc_rc == 0)
+				mc->mc_rc = rc;
+		} else if (mc->mc_log != NULL) {
+			fprintf(mc->mc_log, "%#" PRIx64 ":%#" PRIx64 " %u %u\n",
+				id->u_hi, id->u_lo, mc->mc_src_tier,
+				mc->mc_tgt_tier);
+			fflush(mc->mc_log);
+		}
+		m0_mutex_unlock(&mc->mc_lock);
+	}
+}
+
+int m0hsm_migrate(const struct m0_uint128 *ids, int nr, uint8_t src_tier,
+		  uint8_t tgt_tier, off_t offset, size_t length,
+		  enum hsm_cp_flags flags, const char *log_path)
+{
+	struct migrate_ctx mc = {
+		.mc_ids      = ids,
+		.mc_nr       = nr,
+		.mc_src_tier = src_tier,
+		.mc_tgt_tier = tgt_tier,
+		.mc_off      = offset,
+		.mc_len      = length,
+		.mc_flags    = flags,
+	};
+	struct m0_thread *threads;
+	int threads_nr;
+	int i;
+	int rc = 0;
+
+	ENTRY;
+
+	if (nr <= 0)
+		RETURN(0);
+
+	if (log_path != NULL) {
+		mc.mc_log = fopen(log_path, "a+");
+		if (mc.mc_log == NULL) {
+			rc = -errno;
+			ERROR("Failed to open migration log '%s': %s\n",
+			      log_path, strerror(-rc));
+			RETURN(rc);
+		}
+		rc = migrate_log_load(&mc);
+		if (rc)
+			goto out;
+		INFO("%d objects already migrated from tier %u to tier %u\n",
+		     mc.mc_done_nr, src_tier, tgt_tier);
+	}
+
+	threads_nr = min_check(options.migrate_threads ?: 1, (unsigned)nr);
+	M0_ALLOC_ARR(threads, threads_nr);
+	if (threads == NULL) {
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	m0_mutex_init(&mc.mc_lock);
+	for (i = 0; i < threads_nr; i++) {
+		rc = M0_THREAD_INIT(&threads[i], struct migrate_ctx *, NULL,
+				    &migrate_thread, &mc, "m0hsm_mig%d", i);
+		if (rc) {
+			ERROR("Failed to start migration thread: rc=%d\n",
+			      rc);
+			/* stop the threads already started */
+			m0_mutex_lock(&mc.mc_lock);
+			mc.mc_next = nr;
+			m0_mutex_unlock(&mc.mc_lock);
+			break;
+		}
+	}
+	threads_nr = i;
+	for (i = 0; i < threads_nr; i++) {
+		m0_thread_join(&threads[i]);
+		m0_thread_fini(&threads[i]);
+	}
+	m0_mutex_fini(&mc.mc_lock);
+	m0_free(threads);
+
+	rc = rc ?: mc.mc_rc;
+ out:
+	free(mc.mc_done);
+	if (mc.mc_log != NULL)
+		fclose(mc.mc_log);
+	RETURN(rc);
+}
+
 
 /*
  *  Local variables:
@@ -56,6 +56,18 @@ struct m0hsm_options {
 	FILE		  *log_stream;
 	/** rc-file with config params */
 	FILE		  *rcfile;
+	/** max number of I/O operations in flight when copying an extent
+	 *  (0 for the default: HSM_IO_DEPTH_DEF) */
+	unsigned	   io_depth;
+	/** max number of objects copied in parallel by m0hsm_migrate()
+	 *  (0 for the default: 1) */
+	unsigned	   migrate_threads;
+};
+
+/** Default and max number of I/O operations in flight on extent copy */
+enum {
+	HSM_IO_DEPTH_DEF = 4,
+	HSM_IO_DEPTH_MAX = 64,
 };
 
 /** Max Object Store I/O buffer size */
@@ -142,6 +154,34 @@ int m0hsm_copy(struct m0_uint128 obj_id, uint8_t src_tier_idx,
 	      uint8_t tgt_tier_idx, off_t offset, size_t length,
 	      enum hsm_cp_flags flags);
 
+/**
+ * Copy a region of many objects from one tier to another, as m0hsm_copy()
+ * does for each of them. Up to options.migrate_threads objects are copied
+ * in parallel. The objects must be distinct.
+ *
+ * Bandwidth consumed on a tier by all the copies can be limited with
+ * the M0_TIER<n>_BW parameter of the rc-file (bytes per second).
+ *
+ * If log_path is not NULL, the migration is resumable: every object copied
+ * successfully is appended to the log and the objects found in the log
+ * for the same tiers are skipped. Failures are not logged, so that
+ * the failed objects are retried when the migration is restarted.
+ *
+ * @param ids		Ids of the objects to be copied.
+ * @param nr		Number of objects.
+ * @param src_tier_idx	Source tier index (0 is the top tier).
+ * @param tgt_tier_idx	Target tier index (0 is the top tier).
+ * @param offset	Start offset of the region to be copied.
+ * @param length	Size of the region to be copied.
+ * @param flags		Set of OR'ed hsm_cp_flags.
+ * @param log_path	Path of the migration log, or NULL.
+ * @return 0 if all the objects were copied, else the error of the first
+ *	   failed copy.
+ */
+int m0hsm_migrate(const struct m0_uint128 *ids, int nr, uint8_t src_tier_idx,
+		  uint8_t tgt_tier_idx, off_t offset, size_t length,
+		  enum hsm_cp_flags flags, const char *log_path);
+
 /** release options */
 enum hsm_rls_flags {
 	HSM_KEEP_LATEST = (1 << 0), /**< Release all data versions in the given
@@ -74,6 +74,11 @@ static void cob_stob_create_credit(struct m0_fom *fom);
 static int cob_stob_delete_credit(struct m0_fom *fom);
 static struct m0_cob_domain *cdom_get(const struct m0_fom *fom);
 static int cob_ops_stob_find(struct m0_fom_cob_op *co);
+static void cob_fom_common_load(struct m0_fom_cob_op *cfom,
+				const struct m0_fop_cob_common *common);
+static int  cob_batch_fom_tick(struct m0_fom *fom);
+static void cob_batch_fom_fini(struct m0_fom *fom);
+static size_t cob_batch_fom_locality_get(const struct m0_fom *fom);
 static int cob_bytecount_decrement(struct m0_cob *cob, struct m0_cob_bckey *key,
 				   uint64_t bytecount, struct m0_be_tx *tx);
 
@@ -110,6 +115,11 @@ const struct m0_fom_type_ops cob_fom_type_ops = {
 	.fto_create = m0_cob_fom_create,
 };
 
+/** fom_type_ops for m0_fop_cob_create_batch fops. */
+const struct m0_fom_type_ops cob_batch_fom_type_ops = {
+	.fto_create = m0_cob_batch_fom_create,
+};
+
 /** Cob create fom ops. */
 static const struct m0_fom_ops cc_fom_ops = {
 	.fo_fini	  = cc_fom_fini,
@@ -131,6 +141,13 @@ static const struct m0_fom_ops ct_fom_ops = {
 	.fo_home_locality = cob_fom_locality_get
 };
 
+/** Cob create batch fom ops. */
+static const struct m0_fom_ops cob_batch_fom_ops = {
+	.fo_fini          = cob_batch_fom_fini,
+	.fo_tick          = cob_batch_fom_tick,
+	.fo_home_locality = cob_batch_fom_locality_get
+};
+
 /** Cob getattr fom ops. */
 static const struct m0_fom_ops cob_getattr_fom_ops = {
 	.fo_fini	  = cob_getattr_fom_fini,
@@ -282,6 +299,17 @@ static size_t cob_fom_locality_get(const struct m0_fom *fom)
 	return m0_cob_io_fom_locality(&cob_fom_get(fom)->fco_cfid);
 }
 
+static void cob_fom_common_load(struct m0_fom_cob_op *cfom,
+				const struct m0_fop_cob_common *common)
+{
+	cfom->fco_gfid = common->c_gobfid;
+	cfom->fco_cfid = common->c_cobfid;
+	m0_fid_convert_cob2stob(&cfom->fco_cfid, &cfom->fco_stob_id);
+	cfom->fco_cob_idx = common->c_cob_idx;
+	cfom->fco_cob_type = common->c_cob_type;
+	cfom->fco_flags = common->c_flags;
+}
+
 static int cob_fom_populate(struct m0_fom *fom)
 {
 	struct m0_fom_cob_op     *cfom;
@@ -294,12 +322,7 @@ static int cob_fom_populate(struct m0_fom *fom)
 	fop = fom->fo_fop;
 	common = m0_cobfop_common_get(fom->fo_fop);
 	cfom = cob_fom_get(fom);
-	cfom->fco_gfid = common->c_gobfid;
-	cfom->fco_cfid = common->c_cobfid;
-	m0_fid_convert_cob2stob(&cfom->fco_cfid, &cfom->fco_stob_id);
-	cfom->fco_cob_idx = common->c_cob_idx;
-	cfom->fco_cob_type = common->c_cob_type;
-	cfom->fco_flags = common->c_flags;
+	cob_fom_common_load(cfom, common);
 	cfom->fco_fop_type = m0_is_cob_create_fop(fop) ? M0_COB_OP_CREATE :
 				m0_is_cob_delete_fop(fop) ?
 				M0_COB_OP_DELETE : M0_COB_OP_TRUNCATE;
@@ -477,14 +500,13 @@ static int cob_setattr_fom_tick(struct m0_fom *fom)
 	return M0_RC(M0_FSO_AGAIN);
 }
 
-static bool cob_pool_version_mismatch(const struct m0_fom *fom)
+static bool cob_pool_version_mismatch(const struct m0_fom *fom,
+				      const struct m0_fop_cob_common *common)
 {
-	int                       rc;
-	struct m0_cob            *cob = NULL;
-	struct m0_fop_cob_common *common;
-	bool                      ret;
+	int            rc;
+	struct m0_cob *cob = NULL;
+	bool           ret;
 
-	common = m0_cobfop_common_get(fom->fo_fop);
 	rc = cob_locate(fom, &cob);
 	if (rc == 0 && cob != NULL) {
 		M0_LOG(M0_DEBUG, "cob pver"FID_F", common pver"FID_F,
@@ -633,7 +655,7 @@ static int cob_ops_fom_tick(struct m0_fom *fom)
 
 			/* Check if cob with different pool version exists. */
 			if (fop_type == M0_COB_OP_CREATE &&
-			    cob_pool_version_mismatch(fom)) {
+			    cob_pool_version_mismatch(fom, common)) {
 				M0_CNT_DEC(common->c_body.b_nlink);
 				fop_type = cob_op->fco_fop_type =
 					M0_COB_OP_DELETE;
@@ -807,6 +829,220 @@ tail:
 	return M0_RC(M0_FSO_AGAIN);
 }
 
+static struct m0_fom_cob_batch *cob_batch_get(const struct m0_fom *fom)
+{
+	return container_of(cob_fom_get(fom), struct m0_fom_cob_batch, cb_op);
+}
+
+static uint32_t cob_batch_nr(const struct m0_fom *fom)
+{
+	struct m0_fop_cob_create_batch *cb = m0_fop_data(fom->fo_fop);
+
+	return cb->ccb_ops.ccs_nr;
+}
+
+static struct m0_fop_cob_common *cob_batch_op(const struct m0_fom *fom,
+					      uint32_t idx)
+{
+	struct m0_fop_cob_create_batch *cb = m0_fop_data(fom->fo_fop);
+
+	M0_PRE(idx < cb->ccb_ops.ccs_nr);
+	return &cb->ccb_ops.ccs_ops[idx];
+}
+
+static int32_t *cob_batch_rc(const struct m0_fom *fom, uint32_t idx)
+{
+	struct m0_fop_cob_create_batch_reply *reply;
+
+	reply = m0_fop_data(fom->fo_rep_fop);
+	M0_PRE(idx < reply->ccbr_rcs.crs_nr);
+	return &reply->ccbr_rcs.crs_rc[idx];
+}
+
+/** Makes idx-th operation of the batch the current one of the fom. */
+static void cob_batch_op_load(struct m0_fom *fom, uint32_t idx)
+{
+	cob_fom_common_load(cob_fom_get(fom), cob_batch_op(fom, idx));
+}
+
+M0_INTERNAL int m0_cob_batch_fom_create(struct m0_fop *fop, struct m0_fom **out,
+					struct m0_reqh *reqh)
+{
+	struct m0_fop_cob_create_batch       *cb;
+	struct m0_fop_cob_create_batch_reply *reply;
+	struct m0_fom_cob_batch              *bfom;
+	struct m0_fop                        *rfop;
+
+	M0_PRE(fop != NULL);
+	M0_PRE(out != NULL);
+	M0_PRE(m0_is_cob_create_batch_fop(fop));
+
+	cb = m0_fop_data(fop);
+	if (cb->ccb_ops.ccs_nr == 0)
+		return M0_ERR(-EINVAL);
+	M0_ALLOC_PTR(bfom);
+	if (bfom == NULL)
+		return M0_ERR(-ENOMEM);
+	rfop = m0_fop_reply_alloc(fop, &m0_fop_cob_create_batch_reply_fopt);
+	if (rfop == NULL) {
+		m0_free(bfom);
+		return M0_ERR(-ENOMEM);
+	}
+	reply = m0_fop_data(rfop);
+	M0_ALLOC_ARR(reply->ccbr_rcs.crs_rc, cb->ccb_ops.ccs_nr);
+	if (reply->ccbr_rcs.crs_rc == NULL) {
+		m0_fop_put_lock(rfop);
+		m0_free(bfom);
+		return M0_ERR(-ENOMEM);
+	}
+	reply->ccbr_rcs.crs_nr = cb->ccb_ops.ccs_nr;
+
+	*out = &bfom->cb_op.fco_fom;
+	m0_fom_init(*out, &fop->f_type->ft_fom_type, &cob_batch_fom_ops,
+		    fop, rfop, reqh);
+	bfom->cb_op.fco_fop_type = M0_COB_OP_CREATE;
+	cob_batch_op_load(*out, 0);
+	M0_LOG(M0_DEBUG, "Cob create batch of %u operations, first "FID_F,
+	       cb->ccb_ops.ccs_nr, FID_P(&bfom->cb_op.fco_cfid));
+	return M0_RC(0);
+}
+
+static void cob_batch_fom_fini(struct m0_fom *fom)
+{
+	struct m0_fom_cob_batch *bfom = cob_batch_get(fom);
+
+	m0_fom_fini(fom);
+	m0_free(bfom);
+}
+
+static size_t cob_batch_fom_locality_get(const struct m0_fom *fom)
+{
+	return m0_cob_io_fom_locality(&cob_batch_op(fom, 0)->c_cobfid);
+}
+
+/**
+ * Accumulates the credits of the operations following the ones done in the
+ * previous transaction, as many as the transaction can take.
+ */
+static void cob_batch_credit(struct m0_fom *fom)
+{
+	struct m0_fom_cob_batch *bfom = cob_batch_get(fom);
+	struct m0_fom_cob_op    *cfom = &bfom->cb_op;
+	struct m0_be_tx_credit  *tx_cred = m0_fom_tx_credit(fom);
+	struct m0_be_tx_credit   cred;
+	uint32_t                 nr = cob_batch_nr(fom);
+	bool                     empty = true;
+
+	for (bfom->cb_cur = bfom->cb_end; bfom->cb_end < nr; ++bfom->cb_end) {
+		if (*cob_batch_rc(fom, bfom->cb_end) != 0)
+			continue;
+		cob_batch_op_load(fom, bfom->cb_end);
+		M0_SET0(&cred);
+		if (!cob_is_md(cfom))
+			m0_cc_stob_cr_credit(&cfom->fco_stob_id, &cred);
+		cob_op_credit(fom, M0_COB_OP_CREATE, &cred);
+		if (!empty && m0_be_should_break(m0_fom_tx(fom)->t_engine,
+						 tx_cred, &cred))
+			break;
+		m0_be_tx_credit_add(tx_cred, &cred);
+		empty = false;
+	}
+	cfom->fco_is_done = bfom->cb_end == nr;
+}
+
+/**
+ * Creates the cobs of a m0_fop_cob_create_batch fop.
+ *
+ * The generic phases are iterated once per transaction, as for a split cob
+ * delete: each transaction takes the operations, starting from
+ * m0_fom_cob_batch::cb_cur, whose credits fit in it. A failed operation does
+ * not fail the batch, its error is returned in the reply. Re-creation of a
+ * cob with a different pool version is not done in a batch, -ESTALE is
+ * returned for such an operation and the client has to resend it with
+ * m0_fop_cob_create.
+ */
+static int cob_batch_fom_tick(struct m0_fom *fom)
+{
+	struct m0_fom_cob_batch              *bfom = cob_batch_get(fom);
+	struct m0_fom_cob_op                 *cfom = &bfom->cb_op;
+	struct m0_fop_cob_create_batch_reply *reply;
+	struct m0_fop_cob_common             *common;
+	struct m0_cob_attr                    attr;
+	struct m0_be_tx                      *tx = m0_fom_tx(fom);
+	int32_t                              *rc;
+	uint32_t                              i;
+
+	reply = m0_fop_data(fom->fo_rep_fop);
+	M0_ENTRY("fom %p, phase %s, ops [%u, %u) of %u", fom,
+		 m0_fom_phase_name(fom, m0_fom_phase(fom)),
+		 bfom->cb_cur, bfom->cb_end, cob_batch_nr(fom));
+	if (m0_fom_phase(fom) < M0_FOPH_NR) {
+		switch (m0_fom_phase(fom)) {
+		case M0_FOPH_INIT:
+			for (i = 0; i < cob_batch_nr(fom); ++i) {
+				cob_batch_op_load(fom, i);
+				if (cob_pool_version_mismatch(fom,
+							cob_batch_op(fom, i)))
+					*cob_batch_rc(fom, i) = M0_ERR(-ESTALE);
+			}
+			break;
+		case M0_FOPH_TXN_OPEN:
+			cob_batch_credit(fom);
+			break;
+		case M0_FOPH_QUEUE_REPLY:
+			if (m0_fom_rc(fom) != 0)
+				break;
+			if (!cfom->fco_is_done) {
+				m0_fom_phase_set(fom, M0_FOPH_TXN_LOGGED_WAIT);
+				return M0_RC(M0_FSO_AGAIN);
+			}
+			if (m0_be_tx_state(tx) < M0_BTS_LOGGED) {
+				m0_fom_wait_on(fom, &tx->t_sm.sm_chan,
+					       &fom->fo_cb);
+				return M0_RC(M0_FSO_WAIT);
+			}
+			break;
+		case M0_FOPH_TXN_DONE_WAIT:
+			if (!cfom->fco_is_done && m0_fom_rc(fom) == 0) {
+				if (m0_fom_tx_done_wait(fom) != M0_FSO_AGAIN)
+					return M0_RC(M0_FSO_WAIT);
+				M0_SET0(tx);
+				m0_fom_phase_set(fom, M0_FOPH_TXN_INIT);
+			}
+			break;
+		}
+		return M0_RC(m0_fom_tick_generic(fom));
+	}
+
+	switch (m0_fom_phase(fom)) {
+	case M0_FOPH_COB_OPS_PREPARE:
+		m0_fom_phase_set(fom, M0_FOPH_COB_OPS_EXECUTE);
+		reply->ccbr_rc = 0;
+		return M0_RC(M0_FSO_AGAIN);
+	case M0_FOPH_COB_OPS_EXECUTE:
+		for (i = bfom->cb_cur; i < bfom->cb_end; ++i) {
+			rc = cob_batch_rc(fom, i);
+			if (*rc != 0)
+				continue;
+			common = cob_batch_op(fom, i);
+			cob_batch_op_load(fom, i);
+			M0_SET0(&attr);
+			m0_md_cob_wire2mem(&attr, &common->c_body);
+			*rc = cob_stob_create(fom, &attr);
+			if (*rc != 0)
+				M0_LOG(M0_ERROR, "Cob create of "FID_F" in a "
+				       "batch failed: rc=%d",
+				       FID_P(&cfom->fco_cfid), *rc);
+		}
+		m0_fom_phase_move(fom, 0, M0_FOPH_SUCCESS);
+		m0_fom_mod_rep_fill(&reply->ccbr_common.cor_mod_rep, fom);
+		break;
+	default:
+		M0_IMPOSSIBLE("Invalid phase for cob create batch fom.");
+	}
+	return M0_RC(M0_FSO_AGAIN);
+}
+
 M0_INTERNAL int m0_cc_stob_cr_credit(struct m0_stob_id *sid,
 				     struct m0_be_tx_credit *accum)
 {
@@ -95,9 +95,25 @@ struct m0_fom_cob_op {
 	uint64_t                 fco_flags;
 };
 
+/**
+ * Fom of a m0_fop_cob_create_batch fop. The operation being credited or
+ * executed is loaded into cb_op, so that the helpers of single cob operations
+ * can be used.
+ */
+struct m0_fom_cob_batch {
+	struct m0_fom_cob_op cb_op;
+	/** First operation of the current transaction. */
+	uint32_t             cb_cur;
+	/** End of the operations of the current transaction. */
+	uint32_t             cb_end;
+};
+
 M0_INTERNAL int m0_cob_fom_create(struct m0_fop *fop, struct m0_fom **out,
 				  struct m0_reqh *reqh);
 
+M0_INTERNAL int m0_cob_batch_fom_create(struct m0_fop *fop, struct m0_fom **out,
+					struct m0_reqh *reqh);
+
 /**
  * Create the cob for the cob domain.
  */
@@ -23,6 +23,7 @@
 #include "lib/trace.h"
 #include "lib/errno.h"
 #include "lib/memory.h"
+#include "lib/objcache.h"   /* m0_objcache */
 #include "lib/tlist.h"
 #include "lib/assert.h"
 #include "lib/misc.h"    /* M0_BITS */
@@ -606,6 +607,8 @@ static bool m0_io_fom_cob_rw_invariant(const struct m0_io_fom_cob_rw *io);
 static int net_buffer_acquire(struct m0_fom *);
 static int io_prepare(struct m0_fom *);
 static int io_launch(struct m0_fom *);
+static int stio_launch(struct m0_fom *fom, struct m0_file *file,
+		       struct m0_net_buffer *nb, uint32_t index);
 static int io_finish(struct m0_fom *);
 static int io_sync(struct m0_fom *fom);
 static int zero_copy_initiate(struct m0_fom *);
@@ -634,6 +637,20 @@ const struct m0_fom_type_ops io_fom_type_ops = {
 	.fto_create = m0_io_fom_cob_rw_create,
 };
 
+/** Cache of m0_io_fom_cob_rw structures. */
+static struct m0_objcache io_fom_cache;
+
+M0_INTERNAL void m0_io_foms_init(void)
+{
+	m0_objcache_init(&io_fom_cache, "io fom",
+			 sizeof(struct m0_io_fom_cob_rw));
+}
+
+M0_INTERNAL void m0_io_foms_fini(void)
+{
+	m0_objcache_fini(&io_fom_cache);
+}
+
 /**
  * I/O Read FOM state transition table.
  * @see DLD-bulk-server-lspec-state
@@ -657,11 +674,11 @@ static struct m0_io_fom_cob_rw_state_transition io_fom_read_st[] = {
 
 [M0_FOPH_IO_STOB_WAIT] =
 { M0_FOPH_IO_STOB_WAIT, &io_finish,
-  M0_FOPH_IO_ZERO_COPY_INIT, 0, "stobio-finish", },
+  M0_FOPH_IO_ZERO_COPY_INIT, M0_FOPH_IO_STOB_WAIT, "stobio-finish", },
 
 [M0_FOPH_IO_ZERO_COPY_INIT] =
 { M0_FOPH_IO_ZERO_COPY_INIT, &zero_copy_initiate,
-  0, M0_FOPH_IO_ZERO_COPY_WAIT, "zero-copy-initiate", },
+  M0_FOPH_IO_ZERO_COPY_WAIT, M0_FOPH_IO_ZERO_COPY_WAIT, "zero-copy-initiate", },
 
 [M0_FOPH_IO_ZERO_COPY_WAIT] =
 { M0_FOPH_IO_ZERO_COPY_WAIT, &zero_copy_finish,
@@ -697,15 +714,15 @@ static const struct m0_io_fom_cob_rw_state_transition io_fom_write_st[] = {
 
 [M0_FOPH_IO_ZERO_COPY_WAIT] =
 { M0_FOPH_IO_ZERO_COPY_WAIT, &zero_copy_finish,
-  M0_FOPH_IO_STOB_INIT, 0, "zero-copy-finish", },
+  M0_FOPH_IO_STOB_INIT, M0_FOPH_IO_ZERO_COPY_WAIT, "zero-copy-finish", },
 
 [M0_FOPH_IO_STOB_INIT] =
 { M0_FOPH_IO_STOB_INIT, &io_launch,
-  0, M0_FOPH_IO_STOB_WAIT, "stobio-launch", },
+  M0_FOPH_IO_STOB_WAIT, M0_FOPH_IO_STOB_WAIT, "stobio-launch", },
 
 [M0_FOPH_IO_STOB_WAIT] =
 { M0_FOPH_IO_STOB_WAIT, &io_finish,
-  M0_FOPH_IO_BUFFER_RELEASE, 0, "stobio-finish", },
+  M0_FOPH_IO_BUFFER_RELEASE, M0_FOPH_IO_STOB_WAIT, "stobio-finish", },
 
 [M0_FOPH_IO_BUFFER_RELEASE] =
 { M0_FOPH_IO_BUFFER_RELEASE, &net_buffer_release,
@@ -746,6 +763,7 @@ struct m0_sm_state_descr io_phases[] = {
 		.sd_name      = "stobio-finish",
 		.sd_allowed   = M0_BITS(M0_FOPH_IO_ZERO_COPY_INIT,
 					M0_FOPH_IO_BUFFER_RELEASE,
+					M0_FOPH_IO_STOB_WAIT,
 					M0_FOPH_FAILURE)
 	},
 	[M0_FOPH_IO_ZERO_COPY_INIT] = {
@@ -756,6 +774,7 @@ struct m0_sm_state_descr io_phases[] = {
 	[M0_FOPH_IO_ZERO_COPY_WAIT] = {
 		.sd_name      = "zero-copy-finish",
 		.sd_allowed   = M0_BITS(M0_FOPH_IO_BUFFER_RELEASE,
+					M0_FOPH_IO_ZERO_COPY_WAIT,
 					M0_FOPH_IO_STOB_INIT,
 					M0_FOPH_TXN_INIT,
 					M0_FOPH_FAILURE)
@@ -800,6 +819,7 @@ struct m0_sm_trans_descr io_phases_trans[] = {
 	{"stobio-wait-finished-buffer-release",
 	 M0_FOPH_IO_STOB_WAIT, M0_FOPH_IO_BUFFER_RELEASE},
 	{"stobio-wait-failed", M0_FOPH_IO_STOB_WAIT, M0_FOPH_FAILURE},
+	{"stobio-wait-more", M0_FOPH_IO_STOB_WAIT, M0_FOPH_IO_STOB_WAIT},
 	{"zero-copy-initiated",
 	 M0_FOPH_IO_ZERO_COPY_INIT, M0_FOPH_IO_ZERO_COPY_WAIT},
 	{"zero-copy-initiate-failed",
@@ -808,6 +828,8 @@ struct m0_sm_trans_descr io_phases_trans[] = {
 	 M0_FOPH_IO_ZERO_COPY_WAIT, M0_FOPH_IO_BUFFER_RELEASE},
 	{"zero-copy-wait-finished-stobio",
 	 M0_FOPH_IO_ZERO_COPY_WAIT, M0_FOPH_IO_STOB_INIT},
+	{"zero-copy-wait-more",
+	 M0_FOPH_IO_ZERO_COPY_WAIT, M0_FOPH_IO_ZERO_COPY_WAIT},
 	{"zero-copy-wait-finished-txn-open",
 	 M0_FOPH_IO_ZERO_COPY_WAIT, M0_FOPH_TXN_INIT},
 	{"zero-copy-wait-failed", M0_FOPH_IO_ZERO_COPY_WAIT, M0_FOPH_FAILURE},
@@ -845,7 +867,11 @@ static bool m0_io_fom_cob_rw_invariant(const struct m0_io_fom_cob_rw *io)
 		    stobio_tlist_length(&io->fcrw_stio_list)) &&
 		_0C(ergo(io->fcrw_num_stobio_launched <
 			 stobio_tlist_length(&io->fcrw_stio_list),
-			 m0_fom_phase(&io->fcrw_gen) == M0_FOPH_IO_STOB_WAIT));
+			 m0_fom_phase(&io->fcrw_gen) == M0_FOPH_IO_STOB_WAIT ||
+			 (io->fcrw_pipelined &&
+			  M0_IN(m0_fom_phase(&io->fcrw_gen),
+				(M0_FOPH_IO_ZERO_COPY_WAIT,
+				 M0_FOPH_IO_STOB_INIT)))));
 }
 
 static bool m0_stob_io_desc_invariant(const struct m0_stob_io_desc *stobio_desc)
@@ -868,12 +894,14 @@ static void stobio_complete_cb(struct m0_fom_callback *cb)
 	struct m0_stob_io_desc  *stio_desc;
 
 	M0_PRE(m0_fom_group_is_locked(fom));
-	M0_ASSERT(m0_fom_phase(fom) == M0_FOPH_IO_STOB_WAIT);
 	stio_desc = container_of(cb, struct m0_stob_io_desc, siod_fcb);
 	M0_ASSERT(m0_stob_io_desc_invariant(stio_desc));
 
 	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
 	M0_ASSERT(m0_io_fom_cob_rw_invariant(fom_obj));
+	M0_ASSERT(m0_fom_phase(fom) == M0_FOPH_IO_STOB_WAIT ||
+		  (fom_obj->fcrw_pipelined &&
+		   m0_fom_phase(fom) == M0_FOPH_IO_ZERO_COPY_WAIT));
 
 	/* Update checksum count in reply fop for read only */
 	if (m0_is_read_fop(fom->fo_fop)) {
@@ -889,7 +917,16 @@ static void stobio_complete_cb(struct m0_fom_callback *cb)
 	}
 
 	M0_CNT_DEC(fom_obj->fcrw_num_stobio_launched);
-	if (fom_obj->fcrw_num_stobio_launched == 0)
+	/*
+	 * A pipelined write waits for zero-copy in M0_FOPH_IO_ZERO_COPY_WAIT
+	 * and is woken up by rpc bulk, see zero_copy_pipe(). Otherwise the fom
+	 * is woken up as soon as stob io of a further buffer of the batch can
+	 * be launched, see stio_launch_more().
+	 */
+	if ((fom_obj->fcrw_num_stobio_launched == 0 ||
+	     fom_obj->fcrw_pipe_nb != NULL) &&
+	    m0_fom_phase(fom) == M0_FOPH_IO_STOB_WAIT &&
+	    m0_fom_is_waiting(fom))
 		m0_fom_ready(fom);
 }
 
@@ -1156,7 +1193,7 @@ M0_INTERNAL int m0_io_fom_cob_rw_create(struct m0_fop *fop, struct m0_fom **out,
 
 	M0_ENTRY("fop=%p", fop);
 
-	M0_ALLOC_PTR(fom_obj);
+	fom_obj = m0_objcache_alloc(&io_fom_cache);
 	if (fom_obj == NULL)
 		return M0_RC(-ENOMEM);
 
@@ -1164,7 +1201,7 @@ M0_INTERNAL int m0_io_fom_cob_rw_create(struct m0_fop *fop, struct m0_fom **out,
 		    m0_fop_reply_alloc(fop, &m0_fop_cob_readv_rep_fopt) :
 		    m0_fop_reply_alloc(fop, &m0_fop_cob_writev_rep_fopt);
 	if (rep_fop == NULL) {
-		m0_free(fom_obj);
+		m0_objcache_free(&io_fom_cache, fom_obj);
 		return M0_RC(-ENOMEM);
 	}
 
@@ -1187,6 +1224,10 @@ M0_INTERNAL int m0_io_fom_cob_rw_create(struct m0_fop *fop, struct m0_fom **out,
 	fom_obj->fcrw_num_stobio_launched = 0;
 	fom_obj->fcrw_bp                  = NULL;
 	fom_obj->fcrw_flags               = rwfop->crw_flags;
+	fom_obj->fcrw_pipelined           = m0_is_write_fop(fop) &&
+					    fom_obj->fcrw_ndesc > 1 &&
+					    (fom_obj->fcrw_flags &
+					     M0_IO_FLAG_PIPELINE);
 
 	netbufs_tlist_init(&fom_obj->fcrw_netbuf_list);
 	stobio_tlist_init(&fom_obj->fcrw_stio_list);
@@ -1271,7 +1312,13 @@ static int io_prepare(struct m0_fom *fom)
 				 device_state);
 		goto out;
 	}
-	if (device_state != M0_PNDS_ONLINE) {
+	/*
+	 * A replaced device serves the files which direct repair has already
+	 * reconstructed on it.
+	 */
+	if (device_state != M0_PNDS_ONLINE &&
+	    m0_sns_cm_fid_repair_done(&rwfop->crw_gfid, reqh,
+				      device_state) != SRS_REPAIR_DONE_DIRECT) {
 		M0_LOG(M0_DEBUG, "IO @"FID_F" on failed device: %d "
 				 "(state = %d)",
 				 FID_P(&rwfop->crw_fid),
@@ -1495,6 +1542,65 @@ static int nbuf_release_done(struct m0_fom *fom, int still_required)
 	return M0_FSO_AGAIN;
 }
 
+static bool io_is_inline(const struct m0_io_fom_cob_rw *fom_obj)
+{
+	return (fom_obj->fcrw_flags & M0_IO_FLAG_INLINE) &&
+		m0_is_read_fop(fom_obj->fcrw_gen.fo_fop);
+}
+
+/**
+ * Inline read
+ * Copies data of the batch of net buffers to the reply fop, in place of the
+ * zero-copy to the client buffers. The reply data buffer is allocated for
+ * all the descriptors with the first batch.
+ */
+static int io_inline_reply(struct m0_fom *fom)
+{
+	struct m0_io_fom_cob_rw     *fom_obj = M0_AMB(fom_obj, fom, fcrw_gen);
+	struct m0_fop_cob_rw        *rwfop   = io_rw_get(fom->fo_fop);
+	struct m0_fop_cob_rw_reply  *rwrep   = io_rw_rep_get(fom->fo_rep_fop);
+	struct m0_net_buf_desc_data *descs   = rwfop->crw_desc.id_descs;
+	struct m0_net_buffer        *nb;
+	struct m0_bufvec_cursor      cur;
+	m0_bcount_t                  off = 0;
+	m0_bcount_t                  nob;
+	m0_bcount_t                  used;
+	uint32_t                     i;
+	int                          rc = 0;
+
+	M0_ENTRY("fom=%p", fom);
+
+	for (i = 0; i < fom_obj->fcrw_curr_desc_index; ++i)
+		off += descs[i].bdd_used;
+	if (rwrep->rwr_data.b_addr == NULL) {
+		for (nob = off; i < fom_obj->fcrw_ndesc; ++i)
+			nob += descs[i].bdd_used;
+		rc = nob > M0_IO_INLINE_READ_MAX ? M0_ERR(-EMSGSIZE) :
+			m0_buf_alloc(&rwrep->rwr_data, nob);
+	}
+	if (rc != 0) {
+		nbuf_release_done(fom, 0);
+		m0_fom_phase_move(fom, rc, M0_FOPH_FAILURE);
+		M0_LEAVE();
+		return M0_FSO_AGAIN;
+	}
+	m0_tl_for(netbufs, &fom_obj->fcrw_netbuf_list, nb) {
+		used = descs[fom_obj->fcrw_curr_desc_index].bdd_used;
+		M0_ASSERT(off + used <= rwrep->rwr_data.b_nob);
+		m0_bufvec_cursor_init(&cur, &nb->nb_buffer);
+		nob = m0_bufvec_cursor_copyfrom(&cur,
+						rwrep->rwr_data.b_addr + off,
+						used);
+		M0_ASSERT(nob == used);
+		off += used;
+		fom_obj->fcrw_curr_desc_index++;
+	} m0_tl_endfor;
+	M0_LOG(M0_DEBUG, "Inline read, %"PRIu64" bytes", off);
+
+	M0_LEAVE();
+	return M0_FSO_AGAIN;
+}
+
 /**
  * Initiate zero-copy
  * Initiates zero-copy for batch of descriptors.
@@ -1530,10 +1636,19 @@ static int zero_copy_initiate(struct m0_fom *fom)
 
 	fom_obj->fcrw_phase_start_time = m0_time_now();
 
+	if (io_is_inline(fom_obj))
+		return io_inline_reply(fom);
+
 	fop   = fom->fo_fop;
 	rwfop = io_rw_get(fop);
 	rbulk = &fom_obj->fcrw_bulk;
 	m0_rpc_bulk_init(rbulk);
+	if (fom_obj->fcrw_pipelined) {
+		rbulk->rb_pipelined    = true;
+		fom_obj->fcrw_pipe_nb  = netbufs_tlist_head(&fom_obj->
+							     fcrw_netbuf_list);
+		fom_obj->fcrw_pipe_idx = fom_obj->fcrw_curr_desc_index;
+	}
 
 	M0_INVARIANT_EX(m0_tlist_invariant(&netbufs_tl,
 					   &fom_obj->fcrw_netbuf_list));
@@ -1612,6 +1727,100 @@ static int zero_copy_initiate(struct m0_fom *fom)
 	return M0_FSO_WAIT;
 }
 
+/** Returns the position of the net buffer in the list of acquired buffers. */
+static uint32_t netbuf_pos(struct m0_io_fom_cob_rw *fom_obj,
+			   const struct m0_net_buffer *nb)
+{
+	struct m0_net_buffer *b;
+	uint32_t              pos = 0;
+
+	m0_tl_for(netbufs, &fom_obj->fcrw_netbuf_list, b) {
+		if (b == nb)
+			break;
+		++pos;
+	} m0_tl_endfor;
+	M0_POST(pos < fom_obj->fcrw_batch_size);
+	return pos;
+}
+
+/**
+ * Zero-copy Pipeline
+ * Launches stob io of the net buffers with completed zero-copy, in the
+ * order of descriptors, and waits for the remaining buffers of the batch.
+ *
+ * Stob io of a buffer is not launched after a failure of zero-copy or of a
+ * stob io launch, the error is returned by io_finish() once launched stob
+ * io completes.
+ *
+ * @retval M0_FSO_WAIT zero-copy of some buffers is still in progress.
+ * @retval M0_FSO_AGAIN zero-copy of the batch completed.
+ */
+static int zero_copy_pipe(struct m0_fom *fom)
+{
+	struct m0_io_fom_cob_rw *fom_obj = M0_AMB(fom_obj, fom, fcrw_gen);
+	struct m0_rpc_bulk      *rbulk   = &fom_obj->fcrw_bulk;
+	struct m0_stob_io_desc  *stio    = fom_obj->fcrw_stio;
+	struct m0_file          *file    = NULL;
+	struct m0_net_buffer    *nb;
+	uint32_t                 base;
+	bool                     done;
+	int                      rc;
+
+	M0_ENTRY("fom=%p", fom);
+
+	base = fom_obj->fcrw_curr_desc_index - fom_obj->fcrw_batch_size;
+	rc = io_fom_cob2file(fom, &io_rw_get(fom->fo_fop)->crw_fid, &file);
+	if (rc != 0 && fom_obj->fcrw_rc == 0)
+		fom_obj->fcrw_rc = rc;
+	fom_obj->fcrw_bshift = m0_stob_block_shift(fom_obj->fcrw_stob);
+	do {
+		while ((nb = m0_rpc_bulk_done_pop(rbulk)) != NULL)
+			stio[base + netbuf_pos(fom_obj, nb)].siod_bulk_done =
+				true;
+		m0_mutex_lock(&rbulk->rb_mutex);
+		if (rbulk->rb_rc != 0 && fom_obj->fcrw_rc == 0)
+			fom_obj->fcrw_rc = rbulk->rb_rc;
+		m0_mutex_unlock(&rbulk->rb_mutex);
+		while (fom_obj->fcrw_pipe_nb != NULL &&
+		       stio[fom_obj->fcrw_pipe_idx].siod_bulk_done) {
+			if (fom_obj->fcrw_rc == 0) {
+				rc = stio_launch(fom, file,
+						 fom_obj->fcrw_pipe_nb,
+						 fom_obj->fcrw_pipe_idx);
+				if (rc != 0 && fom_obj->fcrw_rc == 0)
+					fom_obj->fcrw_rc = rc;
+			}
+			fom_obj->fcrw_pipe_nb = netbufs_tlist_next(
+				&fom_obj->fcrw_netbuf_list,
+				fom_obj->fcrw_pipe_nb);
+			fom_obj->fcrw_pipe_idx++;
+		}
+		m0_mutex_lock(&rbulk->rb_mutex);
+		done = rpcbulkbufs_tlist_is_empty(&rbulk->rb_buflist) &&
+		       rpcbulkbufs_tlist_is_empty(&rbulk->rb_donelist);
+		if (!done && rpcbulkbufs_tlist_is_empty(&rbulk->rb_donelist)) {
+			/* The next completion signals rb_chan. */
+			m0_fom_wait_on(fom, &rbulk->rb_chan, &fom->fo_cb);
+			m0_mutex_unlock(&rbulk->rb_mutex);
+			if (file != NULL)
+				m0_cob_put(container_of(file, struct m0_cob,
+							co_file));
+			M0_LEAVE("wait");
+			return M0_FSO_WAIT;
+		}
+		m0_mutex_unlock(&rbulk->rb_mutex);
+	} while (!done);
+
+	if (file != NULL)
+		m0_cob_put(container_of(file, struct m0_cob, co_file));
+	M0_ASSERT(fom_obj->fcrw_pipe_nb == NULL);
+	m0_rpc_bulk_fini(rbulk);
+	M0_LOG(M0_DEBUG, "Zero-copy finished, stob io launched %u rc=%d",
+	       fom_obj->fcrw_num_stobio_launched, fom_obj->fcrw_rc);
+	M0_LEAVE();
+	return M0_FSO_AGAIN;
+}
+
 /**
  * Zero-copy Finish
  * Check for zero-copy result.
@@ -1635,6 +1844,14 @@ static int zero_copy_finish(struct m0_fom *fom)
 	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
 	M0_ASSERT(m0_io_fom_cob_rw_invariant(fom_obj));
 
+	if (fom_obj->fcrw_pipelined)
+		return zero_copy_pipe(fom);
+	/* The data is already in the reply, no bulk has been initiated. */
+	if (io_is_inline(fom_obj)) {
+		M0_LEAVE();
+		return M0_FSO_AGAIN;
+	}
+
 	rbulk = &fom_obj->fcrw_bulk;
 
 	m0_mutex_lock(&rbulk->rb_mutex);
@@ -1677,10 +1894,173 @@ M0_INTERNAL uint64_t m0_io_size(struct m0_stob_io *sio, uint32_t bshift)
 	return off;
 }
 
+/**
+ * Launches stob io of the net buffer, which holds data of descriptor index.
+ */
+static int stio_launch(struct m0_fom *fom, struct m0_file *file,
+		       struct m0_net_buffer *nb, uint32_t index)
+{
+	struct m0_io_fom_cob_rw *fom_obj = M0_AMB(fom_obj, fom, fcrw_gen);
+	struct m0_fop           *fop     = fom->fo_fop;
+	struct m0_fop_cob_rw    *rwfop   = io_rw_get(fop);
+	struct m0_indexvec      *mem_ivec;
+	struct m0_stob_io_desc  *stio_desc;
+	struct m0_stob_io       *stio;
+	struct m0_stob          *stob;
+	m0_bcount_t              ivec_count;
+	struct m0_buf           *di_buf;
+	struct m0_bufvec         cksum_data;
+	int                      rc;
+
+	stio_desc   = &fom_obj->fcrw_stio[index];
+	stio        = &stio_desc->siod_stob_io;
+	stob        = fom_obj->fcrw_stob;
+	mem_ivec    = &stio->si_stob;
+	stobio_tlink_init(stio_desc);
+
+	M0_ADDB2_ADD(M0_AVI_FOM_TO_STIO, fom->fo_sm_phase.sm_id,
+		     stio->si_id);
+	/*
+	 * Copy aligned network buffer to stobio object.
+	 * Also trim network buffer as per I/O size.
+	 */
+	ivec_count = m0_vec_count(&mem_ivec->iv_vec);
+	rc = align_bufvec(fom, &stio->si_user, &nb->nb_buffer,
+			  ivec_count, fom_obj->fcrw_bshift);
+	if (rc != 0) {
+		/*
+		 * Since this stob io not added into list
+		 * yet, free it here.
+		 */
+		fom_obj->fcrw_rc = rc;
+		stio_desc_fini(stio_desc);
+		return rc;
+	}
+
+	if (m0_is_write_fop(fop)) {
+		uint32_t di_size = m0_di_size_get(file, ivec_count);
+		uint32_t curr_pos = m0_di_size_get(file,
+					fom_obj->fcrw_curr_size);
+
+		di_buf = &rwfop->crw_di_data;
+		if (di_buf != NULL) {
+			struct m0_buf buf = M0_BUF_INIT(di_size,
+					di_buf->b_addr + curr_pos);
+			cksum_data = (struct m0_bufvec)
+				M0_BUFVEC_INIT_BUF(&buf.b_addr,
+						   &buf.b_nob);
+			M0_ASSERT(file->fi_di_ops->do_check(file,
+				  mem_ivec, &nb->nb_buffer,
+				  &cksum_data));
+		}
+	}
+	stio->si_opcode = m0_is_write_fop(fop) ? SIO_WRITE : SIO_READ;
+
+	/*
+	 * The value is already bshifted during conversion of
+	 * m0_io_indexvec from on-wire to in-mem.
+	 * */
+	fom_obj->fcrw_curr_size += ivec_count;
+	stio_desc->siod_fcb.fc_bottom = stobio_complete_cb;
+	m0_mutex_lock(&stio->si_mutex);
+	m0_fom_callback_arm(fom, &stio->si_wait, &stio_desc->siod_fcb);
+	m0_mutex_unlock(&stio->si_mutex);
+
+	M0_LOG(M0_DEBUG, "launch fom: %p, start_time %" PRIi64 ", "
+	       "req_count: %" PRIx64 ", count: %" PRIx64 ", "
+	       "submitted: %" PRIx64 ", expect: %"PRIx64,
+	       fom, fom_obj->fcrw_fom_start_time,
+	       fom_obj->fcrw_req_count, fom_obj->fcrw_count,
+	       m0_vec_count(&stio->si_user.ov_vec), ivec_count);
+	fom_obj->fcrw_io_launch_time = m0_time_now();
+
+	rc = m0_stob_io_private_setup(stio, stob);
+	if (rc != 0) {
+		M0_LOG(M0_ERROR, "Can not setup adio for stob with"
+				 "id "FID_F" rc = %d",
+				 FID_P(&stob->so_id.si_fid), rc);
+		return rc;
+	}
+	/*
+	 * XXX: @todo: This makes sense for oostore mode as
+	 * there is no degraded write. Eventually write fop
+	 * should have the info. about the zone to which
+	 * write goes
+	 * (spare or non-spare unit of a parity group).
+	 */
+	if (m0_is_write_fop(fop) &&
+	    m0_stob_domain_is_of_type(stob->so_domain,
+				      &m0_stob_ad_type))
+		m0_stob_ad_balloc_set(stio, M0_BALLOC_NORMAL_ZONE);
+	rc = m0_stob_io_prepare_and_launch(stio, fom_obj->fcrw_stob,
+					   &fom->fo_tx, NULL);
+	if (rc != 0) {
+		M0_LOG(M0_ERROR, "stob_io_launch failed: rc=%d", rc);
+		m0_mutex_lock(&stio->si_mutex);
+		m0_fom_callback_cancel(&stio_desc->siod_fcb);
+		m0_mutex_unlock(&stio->si_mutex);
+		/*
+		 * Since this stob io not added into list
+		 * yet, free it here.
+		 */
+		fom_obj->fcrw_rc = rc;
+		stio_desc_fini(stio_desc);
+		return rc;
+	}
+
+	fom_obj->fcrw_req_count += ivec_count;
+	M0_ASSERT(fom_obj->fcrw_req_count > 0);
+	/* XXX Race condition here? what if the "stio_desc->siod_fcb"
+	 * is called before code reaches here?
+	 */
+	M0_CNT_INC(fom_obj->fcrw_num_stobio_launched);
+
+	stobio_tlist_add(&fom_obj->fcrw_stio_list, stio_desc);
+	return 0;
+}
+
+enum {
+	/** Maximal number of stob I/Os of a non-pipelined fom in flight. */
+	IO_STOBIO_INFLIGHT_MAX = 32,
+};
+
+/**
+ * Launches stob io for the net buffers of the batch starting from
+ * m0_io_fom_cob_rw::fcrw_pipe_nb, until IO_STOBIO_INFLIGHT_MAX of them
+ * are in flight. Stob io of the remaining buffers is launched by io_finish()
+ * as the launched ones complete, so that all the buffers of a fop are
+ * queued to the device together without an unbounded queue depth.
+ */
+static int stio_launch_more(struct m0_fom *fom)
+{
+	struct m0_io_fom_cob_rw *fom_obj = M0_AMB(fom_obj, fom, fcrw_gen);
+	struct m0_file          *file    = NULL;
+	int                      rc;
+
+	rc = io_fom_cob2file(fom, &io_rw_get(fom->fo_fop)->crw_fid, &file);
+	while (rc == 0 && fom_obj->fcrw_pipe_nb != NULL &&
+	       fom_obj->fcrw_num_stobio_launched < IO_STOBIO_INFLIGHT_MAX) {
+		rc = stio_launch(fom, file, fom_obj->fcrw_pipe_nb,
+				 fom_obj->fcrw_pipe_idx);
+		fom_obj->fcrw_pipe_nb = netbufs_tlist_next(
+			&fom_obj->fcrw_netbuf_list, fom_obj->fcrw_pipe_nb);
+		fom_obj->fcrw_pipe_idx++;
+	}
+	if (file != NULL)
+		m0_cob_put(container_of(file, struct m0_cob, co_file));
+	if (rc != 0) {
+		/* Do not launch more, wait for the launched ones. */
+		fom_obj->fcrw_pipe_nb = NULL;
+		fom_obj->fcrw_rc = fom_obj->fcrw_rc ?: rc;
+	}
+	return rc;
+}
+
 /**
  * Launch STOB I/O
  * Helper function to launch STOB I/O.
- * This function initiates STOB I/O for all index vecs.
+ * This function initiates STOB I/O for all index vecs, at most
+ * IO_STOBIO_INFLIGHT_MAX of them at a time, see stio_launch_more().
  * STOB I/O signaled on channel in m0_stob_io::si_wait.
  * There is a clink for each STOB I/O waiting on respective
  * m0_stob_io::si_wait. For every STOB I/O completion call-back
@@ -1698,9 +2078,6 @@ static int io_launch(struct m0_fom *fom)
 	int                      rc;
 	struct m0_fop           *fop;
 	struct m0_io_fom_cob_rw *fom_obj;
-	struct m0_net_buffer    *nb;
-	struct m0_fop_cob_rw    *rwfop;
-	struct m0_file          *file = NULL;
 	uint32_t                 index;
 
 	M0_PRE(fom != NULL);
@@ -1711,17 +2088,18 @@ static int io_launch(struct m0_fom *fom)
 
 	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
 	M0_ASSERT(m0_io_fom_cob_rw_invariant(fom_obj));
+	/* Stob io of a pipelined write is launched by zero_copy_pipe(). */
+	if (fom_obj->fcrw_pipelined) {
+		M0_LEAVE();
+		return fom_obj->fcrw_num_stobio_launched > 0 ?
+			M0_FSO_WAIT : M0_FSO_AGAIN;
+	}
 	M0_ASSERT(fom_obj->fcrw_num_stobio_launched == 0);
 	M0_ASSERT(fom_obj->fcrw_io.si_stob.iv_vec.v_nr > 0);
 
 	fom_obj->fcrw_phase_start_time = m0_time_now();
 
-	fop   = fom->fo_fop;
-	rwfop = io_rw_get(fop);
-
-	rc = io_fom_cob2file(fom, &rwfop->crw_fid, &file);
-	if (rc != 0)
-		goto out;
+	fop = fom->fo_fop;
 
 	/*
 	  Since the upper layer IO block size could differ with IO block size
@@ -1746,121 +2124,9 @@ static int io_launch(struct m0_fom *fom)
 	index -= m0_is_write_fop(fop) ?
 		netbufs_tlist_length(&fom_obj->fcrw_netbuf_list) : 0;
 
-	m0_tl_for(netbufs, &fom_obj->fcrw_netbuf_list, nb) {
-		struct m0_indexvec     *mem_ivec;
-		struct m0_stob_io_desc *stio_desc;
-		struct m0_stob_io      *stio;
-		struct m0_stob         *stob;
-		m0_bcount_t             ivec_count;
-		struct m0_buf          *di_buf;
-		struct m0_bufvec        cksum_data;
-		stio_desc   = &fom_obj->fcrw_stio[index++];
-		stio        = &stio_desc->siod_stob_io;
-		stob        = fom_obj->fcrw_stob;
-		mem_ivec    = &stio->si_stob;
-		stobio_tlink_init(stio_desc);
-
-		M0_ADDB2_ADD(M0_AVI_FOM_TO_STIO, fom->fo_sm_phase.sm_id,
-			     stio->si_id);
-		/*
-		 * Copy aligned network buffer to stobio object.
-		 * Also trim network buffer as per I/O size.
-		 */
-		ivec_count = m0_vec_count(&mem_ivec->iv_vec);
-		rc = align_bufvec(fom, &stio->si_user, &nb->nb_buffer,
-				  ivec_count, fom_obj->fcrw_bshift);
-		if (rc != 0) {
-			/*
-			 * Since this stob io not added into list
-			 * yet, free it here.
-			 */
-			fom_obj->fcrw_rc = rc;
-			stio_desc_fini(stio_desc);
-			break;
-		}
-
-		if (m0_is_write_fop(fop)) {
-			uint32_t di_size = m0_di_size_get(file, ivec_count);
-			uint32_t curr_pos = m0_di_size_get(file,
-						fom_obj->fcrw_curr_size);
-
-			di_buf = &rwfop->crw_di_data;
-			if (di_buf != NULL) {
-				struct m0_buf buf = M0_BUF_INIT(di_size,
-						di_buf->b_addr + curr_pos);
-				cksum_data = (struct m0_bufvec)
-					M0_BUFVEC_INIT_BUF(&buf.b_addr,
-							   &buf.b_nob);
-				M0_ASSERT(file->fi_di_ops->do_check(file,
-					  mem_ivec, &nb->nb_buffer,
-					  &cksum_data));
-			}
-		}
-		stio->si_opcode = m0_is_write_fop(fop) ? SIO_WRITE : SIO_READ;
-
-		/*
-		 * The value is already bshifted during conversion of
-		 * m0_io_indexvec from on-wire to in-mem.
-		 * */
-		fom_obj->fcrw_curr_size += ivec_count;
-		stio_desc->siod_fcb.fc_bottom = stobio_complete_cb;
-		m0_mutex_lock(&stio->si_mutex);
-		m0_fom_callback_arm(fom, &stio->si_wait, &stio_desc->siod_fcb);
-		m0_mutex_unlock(&stio->si_mutex);
-
-		M0_LOG(M0_DEBUG, "launch fom: %p, start_time %" PRIi64 ", "
-		       "req_count: %" PRIx64 ", count: %" PRIx64 ", "
-		       "submitted: %" PRIx64 ", expect: %"PRIx64,
-		       fom, fom_obj->fcrw_fom_start_time,
-		       fom_obj->fcrw_req_count, fom_obj->fcrw_count,
-		       m0_vec_count(&stio->si_user.ov_vec), ivec_count);
-		fom_obj->fcrw_io_launch_time = m0_time_now();
-
-		rc = m0_stob_io_private_setup(stio, stob);
-		if (rc != 0) {
-			M0_LOG(M0_ERROR, "Can not setup adio for stob with"
-					 "id "FID_F" rc = %d",
-					 FID_P(&stob->so_id.si_fid), rc);
-			break;
-		}
-		/*
-		 * XXX: @todo: This makes sense for oostore mode as
-		 * there is no degraded write. Eventually write fop
-		 * should have the info. about the zone to which
-		 * write goes
-		 * (spare or non-spare unit of a parity group).
-		 */
-		if (m0_is_write_fop(fop) &&
-		    m0_stob_domain_is_of_type(stob->so_domain,
-					      &m0_stob_ad_type))
-			m0_stob_ad_balloc_set(stio, M0_BALLOC_NORMAL_ZONE);
-		rc = m0_stob_io_prepare_and_launch(stio, fom_obj->fcrw_stob,
-						   &fom->fo_tx, NULL);
-		if (rc != 0) {
-			M0_LOG(M0_ERROR, "stob_io_launch failed: rc=%d", rc);
-			m0_mutex_lock(&stio->si_mutex);
-			m0_fom_callback_cancel(&stio_desc->siod_fcb);
-			m0_mutex_unlock(&stio->si_mutex);
-			/*
-			 * Since this stob io not added into list
-			 * yet, free it here.
-			 */
-			fom_obj->fcrw_rc = rc;
-			stio_desc_fini(stio_desc);
-			break;
-		}
-
-		fom_obj->fcrw_req_count += ivec_count;
-		M0_ASSERT(fom_obj->fcrw_req_count > 0);
-		/* XXX Race condition here? what if the "stio_desc->siod_fcb"
-		 * is called before code reaches here?
-		 */
-		M0_CNT_INC(fom_obj->fcrw_num_stobio_launched);
-
-		stobio_tlist_add(&fom_obj->fcrw_stio_list, stio_desc);
-	} m0_tl_endfor;
-
-	m0_cob_put(container_of(file, struct m0_cob, co_file));
+	fom_obj->fcrw_pipe_nb  = netbufs_tlist_head(&fom_obj->fcrw_netbuf_list);
+	fom_obj->fcrw_pipe_idx = index;
+	rc = stio_launch_more(fom);
 
 	M0_LOG(M0_DEBUG, "total  fom: %" PRIi64 ", expect: %"PRIi64,
 	       fom_obj->fcrw_fom_start_time,
@@ -1873,7 +2139,6 @@ static int io_launch(struct m0_fom *fom)
 		return M0_FSO_WAIT;
 	}
 
-out:
 	if (rc != 0) {
 		if (!M0_FI_ENABLED("keep-net-buffers"))
 			nbuf_release_done(fom, 0);
@@ -1887,6 +2152,30 @@ out:
 	return M0_FSO_AGAIN;
 }
 
+enum {
+	/** Weight of a new sample in m0_reqh_io_service::rios_io_latency. */
+	IO_LATENCY_SHIFT = 3,
+};
+
+/**
+ * Folds the stob I/O latency of a request into the moving average of the
+ * service.
+ *
+ * Concurrent updates may lose samples, which does not matter for an
+ * average.
+ */
+static void io_latency_account(struct m0_fom *fom, m0_time_t latency)
+{
+	struct m0_reqh_io_service *ios;
+	int64_t                    avg;
+
+	ios = container_of(fom->fo_service, struct m0_reqh_io_service,
+			   rios_gen);
+	avg = m0_atomic64_get(&ios->rios_io_latency);
+	avg += ((int64_t)latency - avg) >> IO_LATENCY_SHIFT;
+	m0_atomic64_set(&ios->rios_io_latency, avg);
+}
+
 /**
  * This function finish STOB I/O.
  * It's check for STOB I/O result and return back STOB instance.
@@ -1910,12 +2199,18 @@ static int io_finish(struct m0_fom *fom)
 
 	M0_ENTRY("fom=%p", fom);
 
+	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
+	M0_ASSERT(m0_io_fom_cob_rw_invariant(fom_obj));
+	if (fom_obj->fcrw_pipe_nb != NULL)
+		(void)stio_launch_more(fom);
+	if (fom_obj->fcrw_num_stobio_launched > 0) {
+		M0_LEAVE("wait");
+		return M0_FSO_WAIT;
+	}
+
 	if (M0_FI_ENABLED("fake_error"))
 		rc = -EINVAL;
 
-	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
-	M0_ASSERT(m0_io_fom_cob_rw_invariant(fom_obj));
-	M0_ASSERT(fom_obj->fcrw_num_stobio_launched == 0);
 	M0_INVARIANT_EX(m0_tlist_invariant(&stobio_tl,
 					   &fom_obj->fcrw_stio_list));
 	/*
@@ -1974,6 +2269,7 @@ static int io_finish(struct m0_fom *fom)
 	}
 
 	M0_LOG(M0_DEBUG, "STOB I/O finished.");
+	io_latency_account(fom, m0_time_now() - fom_obj->fcrw_io_launch_time);
 
 	M0_LEAVE();
 	return M0_FSO_AGAIN;
@@ -1991,6 +2287,8 @@ static int io_sync(struct m0_fom *fom)
 	    fom->fo_tx.tx_state != M0_DTX_INVALID &&
 	    m0_be_tx_state(tx) < M0_BTS_LOGGED) {
 		M0_LOG(M0_DEBUG, "fom wait for tx to be logged");
+		/* Share an early group close with other sync requests. */
+		m0_be_tx_force(tx);
 		m0_fom_wait_on(fom, &tx->t_sm.sm_chan, &fom->fo_cb);
 		return M0_FSO_WAIT;
 	} else
@@ -2290,13 +2588,19 @@ static int m0_io_fom_cob_rw_tick(struct m0_fom *fom)
 						 M0_COB_OP_BYTECOUNT_UPDATE, accum);
 			}
 		} else if (phase == M0_FOPH_AUTHORISATION) {
+			/*
+			 * The transaction is opened after the first zero-copy,
+			 * unless stob io is pipelined with zero-copy.
+			 */
 			rc = m0_fom_tick_generic(fom);
-			if (m0_fom_phase(fom) == M0_FOPH_TXN_INIT)
+			if (m0_fom_phase(fom) == M0_FOPH_TXN_INIT &&
+			    !fom_obj->fcrw_pipelined)
 				m0_fom_phase_set(fom, M0_FOPH_IO_FOM_PREPARE);
 			return M0_RC(rc);
 		} else if (phase == M0_FOPH_TXN_WAIT) {
 			rc = m0_fom_tick_generic(fom);
-			if (m0_fom_phase(fom) == M0_FOPH_IO_FOM_PREPARE)
+			if (m0_fom_phase(fom) == M0_FOPH_IO_FOM_PREPARE &&
+			    !fom_obj->fcrw_pipelined)
 				m0_fom_phase_set(fom, M0_FOPH_IO_STOB_INIT);
 			return M0_RC(rc);
 		} else if (phase == M0_FOPH_TXN_COMMIT) {
@@ -2470,7 +2774,7 @@ static void m0_io_fom_cob_rw_fini(struct m0_fom *fom)
 	}
 #endif
 	m0_fom_fini(fom);
-	m0_free(fom_obj);
+	m0_objcache_free(&io_fom_cache, fom_obj);
 }
 
 /**
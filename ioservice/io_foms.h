@@ -163,6 +163,11 @@ struct m0_stob_io_desc {
 	 * It should be pointed by m0_stob_io::si_fol_frag.
 	 */
 	struct m0_fol_frag       siod_fol_frag;
+	/**
+	 * Network transfer of the buffer of this stob io completed, used by
+	 * pipelined writes, see m0_io_fom_cob_rw::fcrw_pipelined.
+	 */
+	bool                     siod_bulk_done;
 };
 
 /**
@@ -232,6 +237,21 @@ struct m0_io_fom_cob_rw {
 	m0_time_t                        fcrw_io_launch_time;
 	/** The flags from m0_fop_cob_rw::crw_flags */
 	uint64_t                         fcrw_flags;
+	/**
+	 * Stob io of a net buffer is launched as soon as its zero-copy
+	 * completes, while other buffers of the batch are still in transfer.
+	 * Used for writes with several descriptors when the client asks for it
+	 * with M0_IO_FLAG_PIPELINE. The transaction is opened before the first
+	 * zero-copy then.
+	 */
+	bool                             fcrw_pipelined;
+	/**
+	 * Next net buffer of the batch to launch stob io for, NULL when stob
+	 * io of the whole batch is launched.
+	 */
+	struct m0_net_buffer            *fcrw_pipe_nb;
+	/** Descriptor index of fcrw_pipe_nb. */
+	uint32_t                         fcrw_pipe_idx;
 };
 
 /**
@@ -271,6 +291,10 @@ struct m0_io_fom_cob_rw_state_transition {
  */
 M0_INTERNAL const char *m0_io_fom_cob_rw_service_name(struct m0_fom *fom);
 
+/** Sets up the cache of I/O foms, called by m0_ios_register(). */
+M0_INTERNAL void m0_io_foms_init(void);
+M0_INTERNAL void m0_io_foms_fini(void);
+
 M0_INTERNAL int m0_io_cob_create(struct m0_cob_domain *cdom,
 				 struct m0_fid *fid,
 				 struct m0_fid *pver,
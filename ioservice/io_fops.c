@@ -82,6 +82,8 @@ struct m0_fop_type m0_fop_cob_getattr_reply_fopt;
 struct m0_fop_type m0_fop_fsync_ios_fopt;
 struct m0_fop_type m0_fop_cob_setattr_fopt;
 struct m0_fop_type m0_fop_cob_setattr_reply_fopt;
+struct m0_fop_type m0_fop_cob_create_batch_fopt;
+struct m0_fop_type m0_fop_cob_create_batch_reply_fopt;
 
 M0_EXPORTED(m0_fop_cob_writev_fopt);
 M0_EXPORTED(m0_fop_cob_readv_fopt);
@@ -101,6 +103,8 @@ static struct m0_fop_type *ioservice_fops[] = {
 	&m0_fop_fsync_ios_fopt,
 	&m0_fop_cob_setattr_fopt,
 	&m0_fop_cob_setattr_reply_fopt,
+	&m0_fop_cob_create_batch_fopt,
+	&m0_fop_cob_create_batch_reply_fopt,
 };
 
 /* Used for IO REQUEST items only. */
@@ -241,6 +245,7 @@ const struct m0_fop_type_ops io_fop_cd_ops = {
 
 extern struct m0_reqh_service_type m0_ios_type;
 extern const struct m0_fom_type_ops cob_fom_type_ops;
+extern const struct m0_fom_type_ops cob_batch_fom_type_ops;
 extern const struct m0_fom_type_ops io_fom_type_ops;
 
 extern struct m0_sm_conf io_conf;
@@ -257,6 +262,7 @@ M0_INTERNAL void m0_ioservice_fop_fini(void)
 	m0_fop_type_addb2_deinstrument(&m0_fop_cob_getattr_fopt);
 	m0_fop_type_addb2_deinstrument(&m0_fop_cob_setattr_fopt);
 	m0_fop_type_addb2_deinstrument(&m0_fop_cob_truncate_fopt);
+	m0_fop_type_addb2_deinstrument(&m0_fop_cob_create_batch_fopt);
 
 	m0_fop_type_fini(&m0_fop_cob_readv_fopt);
 	m0_fop_type_fini(&m0_fop_cob_writev_fopt);
@@ -272,6 +278,8 @@ M0_INTERNAL void m0_ioservice_fop_fini(void)
 	m0_fop_type_fini(&m0_fop_fsync_ios_fopt);
 	m0_fop_type_fini(&m0_fop_cob_setattr_fopt);
 	m0_fop_type_fini(&m0_fop_cob_setattr_reply_fopt);
+	m0_fop_type_fini(&m0_fop_cob_create_batch_fopt);
+	m0_fop_type_fini(&m0_fop_cob_create_batch_reply_fopt);
 
 #ifndef __KERNEL__
 	m0_sm_conf_fini(&io_conf);
@@ -310,7 +318,8 @@ M0_INTERNAL int m0_ioservice_fop_init(void)
 			 .sm        = &io_conf,
 			 .svc_type  = &m0_ios_type,
 #endif
-			 .rpc_ops   = &io_item_type_ops);
+			 .rpc_ops   = &io_item_type_ops,
+			 .flags     = M0_FOP_TYPE_FLAG_DECODE_ARENA);
 
 	M0_FOP_TYPE_INIT(&m0_fop_cob_writev_fopt,
 			 .name      = "write",
@@ -323,7 +332,8 @@ M0_INTERNAL int m0_ioservice_fop_init(void)
 			 .sm        = &io_conf,
 			 .svc_type  = &m0_ios_type,
 #endif
-			 .rpc_ops   = &io_item_type_ops);
+			 .rpc_ops   = &io_item_type_ops,
+			 .flags     = M0_FOP_TYPE_FLAG_DECODE_ARENA);
 
 	M0_FOP_TYPE_INIT(&m0_fop_cob_readv_rep_fopt,
 			 .name      = "read-reply",
@@ -424,13 +434,31 @@ M0_INTERNAL int m0_ioservice_fop_init(void)
 			 .xt        = m0_fop_cob_setattr_reply_xc,
 			 .rpc_flags = M0_RPC_ITEM_TYPE_REPLY);
 
+	M0_FOP_TYPE_INIT(&m0_fop_cob_create_batch_fopt,
+			 .name      = "cob-create-batch",
+			 .opcode    = M0_IOSERVICE_COB_CREATE_BATCH_OPCODE,
+			 .xt        = m0_fop_cob_create_batch_xc,
+			 .rpc_flags = M0_RPC_MUTABO_REQ,
+#ifndef __KERNEL__
+			 .fom_ops   = &cob_batch_fom_type_ops,
+			 .svc_type  = &m0_ios_type,
+#endif
+			 .sm        = p_cob_ops_conf);
+
+	M0_FOP_TYPE_INIT(&m0_fop_cob_create_batch_reply_fopt,
+			 .name      = "cob-create-batch-reply",
+			 .opcode    = M0_IOSERVICE_COB_CREATE_BATCH_REP_OPCODE,
+			 .xt        = m0_fop_cob_create_batch_reply_xc,
+			 .rpc_flags = M0_RPC_ITEM_TYPE_REPLY);
+
 	return  m0_fop_type_addb2_instrument(&m0_fop_cob_readv_fopt)   ?:
 		m0_fop_type_addb2_instrument(&m0_fop_cob_writev_fopt)  ?:
 		m0_fop_type_addb2_instrument(&m0_fop_cob_create_fopt)  ?:
 		m0_fop_type_addb2_instrument(&m0_fop_cob_delete_fopt)  ?:
 		m0_fop_type_addb2_instrument(&m0_fop_cob_getattr_fopt) ?:
 		m0_fop_type_addb2_instrument(&m0_fop_cob_setattr_fopt) ?:
-		m0_fop_type_addb2_instrument(&m0_fop_cob_truncate_fopt);
+		m0_fop_type_addb2_instrument(&m0_fop_cob_truncate_fopt) ?:
+		m0_fop_type_addb2_instrument(&m0_fop_cob_create_batch_fopt);
 }
 
 /**
@@ -982,6 +1010,13 @@ M0_INTERNAL bool m0_is_cob_setattr_fop(const struct m0_fop *fop)
 				M0_IOSERVICE_COB_SETATTR_OPCODE;
 }
 
+M0_INTERNAL bool m0_is_cob_create_batch_fop(const struct m0_fop *fop)
+{
+	M0_PRE(fop != NULL);
+	return fop->f_type->ft_rpc_item_type.rit_opcode ==
+				M0_IOSERVICE_COB_CREATE_BATCH_OPCODE;
+}
+
 M0_INTERNAL bool m0_is_cob_create_delete_fop(const struct m0_fop *fop)
 {
 	return m0_is_cob_create_fop(fop) || m0_is_cob_delete_fop(fop);
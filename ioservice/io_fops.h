@@ -228,6 +228,7 @@ M0_INTERNAL bool m0_is_cob_truncate_fop(const struct m0_fop *fop);
 M0_INTERNAL bool m0_is_cob_create_delete_fop(const struct m0_fop *fop);
 M0_INTERNAL bool m0_is_cob_getattr_fop(const struct m0_fop *fop);
 M0_INTERNAL bool m0_is_cob_setattr_fop(const struct m0_fop *fop);
+M0_INTERNAL bool m0_is_cob_create_batch_fop(const struct m0_fop *fop);
 M0_INTERNAL struct m0_fop_cob_common *m0_cobfop_common_get(struct m0_fop *fop);
 
 M0_INTERNAL void m0_dump_cob_attr(const struct m0_cob_attr *attr);
@@ -261,6 +262,8 @@ extern struct m0_fop_type m0_fop_cob_getattr_reply_fopt;
 extern struct m0_fop_type m0_fop_fsync_ios_fopt;
 extern struct m0_fop_type m0_fop_cob_setattr_fopt;
 extern struct m0_fop_type m0_fop_cob_setattr_reply_fopt;
+extern struct m0_fop_type m0_fop_cob_create_batch_fopt;
+extern struct m0_fop_type m0_fop_cob_create_batch_reply_fopt;
 
 extern struct m0_fom_type m0_io_fom_cob_rw_fomt;
 
@@ -338,6 +341,9 @@ struct m0_fop_cob_rw_reply {
 
    /** Checksum data returned to client during Read operation */
 	struct m0_buf		rwr_di_data_cksum;
+
+	/** Data of a M0_IO_FLAG_INLINE read, in the order of descriptors. */
+	struct m0_buf		rwr_data;
 } M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
 
 /**
@@ -365,7 +371,22 @@ enum m0_io_flags {
 	M0_IO_FLAG_CROW   = (1 << 0), /**< Create cob on write if not present */
 	M0_IO_FLAG_NOHOLE = (1 << 1), /**< Return error if read see holes */
 	/** Wait until the transaction is persistent. */
-	M0_IO_FLAG_SYNC   = (1 << 2)
+	M0_IO_FLAG_SYNC   = (1 << 2),
+	/**
+	 * Read data is returned in m0_fop_cob_rw_reply::rwr_data, the net buf
+	 * descriptors only give the sizes (bdd_used) of the client buffers.
+	 */
+	M0_IO_FLAG_INLINE = (1 << 3),
+	/**
+	 * Stob io of a write with several descriptors is pipelined with the
+	 * bulk transfer, see m0_io_fom_cob_rw::fcrw_pipelined.
+	 */
+	M0_IO_FLAG_PIPELINE = (1 << 4)
+};
+
+enum {
+	/** Maximal size of the data of a M0_IO_FLAG_INLINE read. */
+	M0_IO_INLINE_READ_MAX = 1 << 14
 };
 
 /**
@@ -524,6 +545,37 @@ struct m0_fop_cob_op_reply {
 	struct m0_fop_cob_op_rep_common cor_common;
 } M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
 
+/** Sequence of cob operations of a batch. */
+struct m0_fop_cob_common_seq {
+	uint32_t                  ccs_nr;
+	struct m0_fop_cob_common *ccs_ops;
+} M0_XCA_SEQUENCE M0_XCA_DOMAIN(rpc);
+
+/**
+ * On-wire representation of "cob create batch" request.
+ * Creates many component objects of the same ioservice with one fom, in as
+ * few transactions as the BE credit limits allow.
+ */
+struct m0_fop_cob_create_batch {
+	struct m0_fop_cob_common_seq ccb_ops;
+} M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
+
+/** Return codes of the operations of a batch, in the request order. */
+struct m0_fop_cob_rc_seq {
+	uint32_t  crs_nr;
+	int32_t  *crs_rc;
+} M0_XCA_SEQUENCE M0_XCA_DOMAIN(rpc);
+
+/**
+ * Reply for "cob create batch". ccbr_rc is the error of the batch as a whole,
+ * the results of individual operations are in ccbr_rcs.
+ */
+struct m0_fop_cob_create_batch_reply {
+	int32_t                         ccbr_rc;
+	struct m0_fop_cob_op_rep_common ccbr_common;
+	struct m0_fop_cob_rc_seq        ccbr_rcs;
+} M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
+
 /**
  * On-wire representation of "cob getattr" request.
  */
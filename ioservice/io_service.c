@@ -39,6 +39,7 @@
 #include "reqh/reqh_service.h"
 #include "reqh/reqh.h"
 #include "ioservice/io_fops.h"
+#include "ioservice/io_foms.h"      /* m0_io_foms_init */
 #include "ioservice/io_service.h"
 #include "ioservice/ios_start_sm.h"
 #include "pool/pool.h"
@@ -49,6 +50,8 @@
 #include "mdservice/fsync_fops.h"
 #include "module/instance.h"       /* m0_get */
 #include "ioservice/fid_convert.h" /* m0_fid_convert_gob2cob */
+#include "ioservice/storage_dev.h" /* m0_storage_devs_buffers_register */
+#include "motr/setup.h"           /* m0_cs_storage_devs_get */
 
 M0_TL_DESCR_DEFINE(bufferpools, "rpc machines associated with reqh",
 		   M0_INTERNAL,
@@ -162,6 +165,7 @@ M0_INTERNAL int m0_ios_register(void)
 	rc = m0_ioservice_fop_init();
 	if (rc != 0)
 		return M0_ERR_INFO(rc, "Unable to initialize fops");
+	m0_io_foms_init();
 	m0_reqh_service_type_register(&m0_ios_type);
 	m0_get()->i_ios_cdom_key = m0_reqh_lockers_allot();
 	ios_mds_conn_key = m0_reqh_lockers_allot();
@@ -177,6 +181,7 @@ M0_INTERNAL void m0_ios_unregister(void)
 	m0_reqh_lockers_free(m0_get()->i_ios_cdom_key);
 
 	m0_reqh_service_type_unregister(&m0_ios_type);
+	m0_io_foms_fini();
 	m0_ioservice_fop_fini();
 }
 
@@ -186,6 +191,50 @@ M0_INTERNAL bool m0_reqh_io_service_invariant(const struct m0_reqh_io_service
 	return rios->rios_magic == M0_IOS_REQH_SVC_MAGIC;
 }
 
+/**
+ * Registers the buffers of all buffer pools with the storage devices, so that
+ * the backing store can use them as io_uring fixed buffers.
+ *
+ * Buffers added to the pools later are not registered and are used as normal
+ * buffers.
+ */
+static void ios_buffers_register(struct m0_reqh_io_service *serv_obj)
+{
+	struct m0_rios_buffer_pool *bp;
+	struct m0_net_buffer       *nb;
+	struct m0_bufvec            bufs;
+	uint32_t                    nr = 0;
+	uint32_t                    i;
+	int                         rc;
+
+	m0_tl_for(bufferpools, &serv_obj->rios_buffer_pools, bp) {
+		m0_net_buffer_pool_lock(&bp->rios_bp);
+		nr += m0_net_pool_tlist_length(&bp->rios_bp.nbp_lru) *
+			bp->rios_bp.nbp_seg_nr;
+		m0_net_buffer_pool_unlock(&bp->rios_bp);
+	} m0_tl_endfor;
+	if (nr == 0 || m0_bufvec_empty_alloc(&bufs, nr) != 0)
+		return;
+	nr = 0;
+	m0_tl_for(bufferpools, &serv_obj->rios_buffer_pools, bp) {
+		m0_net_buffer_pool_lock(&bp->rios_bp);
+		m0_tl_for(m0_net_pool, &bp->rios_bp.nbp_lru, nb) {
+			for (i = 0; i < nb->nb_buffer.ov_vec.v_nr &&
+				     nr < bufs.ov_vec.v_nr; ++i, ++nr) {
+				bufs.ov_buf[nr] = nb->nb_buffer.ov_buf[i];
+				bufs.ov_vec.v_count[nr] =
+					nb->nb_buffer.ov_vec.v_count[i];
+			}
+		} m0_tl_endfor;
+		m0_net_buffer_pool_unlock(&bp->rios_bp);
+	} m0_tl_endfor;
+	bufs.ov_vec.v_nr = nr;
+	rc = m0_storage_devs_buffers_register(m0_cs_storage_devs_get(), &bufs);
+	if (rc != 0)
+		M0_LOG(M0_WARN, "Buffers are not registered: rc=%d", rc);
+	m0_bufvec_free2(&bufs);
+}
+
 /**
  * Create & initialise instance of buffer pool per domain.
  * 1. This function scans rpc_machines from request handler
@@ -277,6 +326,8 @@ M0_INTERNAL int m0_ios_create_buffer_pool(struct m0_reqh_service *service)
 
 	} m0_tl_endfor; /* rpc_machines */
 	m0_rwlock_read_unlock(&reqh->rh_rwlock);
+	if (rc == 0)
+		ios_buffers_register(serv_obj);
 
 	return M0_RC(rc);
 }
@@ -299,6 +350,7 @@ M0_INTERNAL void m0_ios_delete_buffer_pool(struct m0_reqh_service *service)
 	serv_obj = container_of(service, struct m0_reqh_io_service, rios_gen);
 	M0_ASSERT(m0_reqh_io_service_invariant(serv_obj));
 
+	m0_storage_devs_buffers_unregister(m0_cs_storage_devs_get());
 	m0_tl_for(bufferpools, &serv_obj->rios_buffer_pools, bp) {
 
 		M0_ASSERT(bp != NULL);
@@ -335,6 +387,7 @@ static int ios_allocate(struct m0_reqh_service **service,
 		return M0_ERR(-ENOMEM);
 
 	bufferpools_tlist_init(&ios->rios_buffer_pools);
+	m0_atomic64_set(&ios->rios_io_latency, 0);
 	ios->rios_magic = M0_IOS_REQH_SVC_MAGIC;
 
 	*service = &ios->rios_gen;
@@ -483,6 +536,20 @@ M0_INTERNAL void m0_ios_cdom_fini(struct m0_reqh *reqh)
 	m0_rwlock_write_unlock(&reqh->rh_rwlock);
 }
 
+M0_INTERNAL m0_time_t m0_ios_io_latency(struct m0_reqh *reqh)
+{
+	struct m0_reqh_service    *svc;
+	struct m0_reqh_io_service *ios;
+
+	M0_PRE(reqh != NULL);
+
+	svc = m0_reqh_service_find(&m0_ios_type, reqh);
+	if (svc == NULL)
+		return 0;
+	ios = container_of(svc, struct m0_reqh_io_service, rios_gen);
+	return m0_atomic64_get(&ios->rios_io_latency);
+}
+
 enum {
 	RPC_TIMEOUT          = 8, /* seconds */
 	MAX_NR_RPC_IN_FLIGHT = 100,
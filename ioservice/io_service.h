@@ -53,6 +53,7 @@
 #include "reqh/reqh_service.h"
 #include "lib/chan.h"
 #include "lib/tlist.h"
+#include "lib/atomic.h"
 #include "cob/cob.h"
 #include "layout/layout.h"
 #include "rpc/conn.h"
@@ -115,6 +116,11 @@ struct m0_reqh_io_service {
 
 	/** FOM to be notified about asynchronous start completion */
 	struct m0_fom               *rios_fom;
+	/**
+	 * Moving average of the stob I/O latency of client read and write
+	 * requests, in nanoseconds, see m0_ios_io_latency().
+	 */
+	struct m0_atomic64           rios_io_latency;
 	/** magic to check io service object */
 	uint64_t                     rios_magic;
 };
@@ -127,6 +133,16 @@ M0_INTERNAL void m0_ios_cdom_get(struct m0_reqh        *reqh,
 
 M0_INTERNAL void m0_ios_cdom_fini(struct m0_reqh *reqh);
 
+/**
+ * Returns the moving average of the stob I/O latency of client requests
+ * served by the ioservice of the reqh, 0 if there is no ioservice or no
+ * requests were served yet.
+ *
+ * Used by the SNS copy machine throttle to slow repair down when client
+ * I/O suffers from it.
+ */
+M0_INTERNAL m0_time_t m0_ios_io_latency(struct m0_reqh *reqh);
+
 struct m0_ios_mds_conn {
 	struct m0_rpc_conn    imc_conn;
 	struct m0_rpc_session imc_session;
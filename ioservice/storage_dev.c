@@ -142,6 +142,24 @@ M0_INTERNAL void m0_storage_devs_use_directio(struct m0_storage_devs *devs,
 	devs->sds_use_directio = directio;
 }
 
+M0_INTERNAL int m0_storage_devs_buffers_register(struct m0_storage_devs *devs,
+						 const struct m0_bufvec *bufs)
+{
+	if (devs->sds_type != M0_STORAGE_DEV_TYPE_AD ||
+	    devs->sds_back_domain == NULL)
+		return M0_RC(0);
+	return m0_stob_linux_domain_buffers_register(devs->sds_back_domain,
+						     bufs);
+}
+
+M0_INTERNAL void
+m0_storage_devs_buffers_unregister(struct m0_storage_devs *devs)
+{
+	if (devs->sds_type == M0_STORAGE_DEV_TYPE_AD &&
+	    devs->sds_back_domain != NULL)
+		m0_stob_linux_domain_buffers_unregister(devs->sds_back_domain);
+}
+
 M0_INTERNAL void m0_storage_devs_locks_disable(struct m0_storage_devs *devs)
 {
 	M0_PRE(!storage_devs_is_locked(devs));
@@ -689,13 +707,13 @@ M0_INTERNAL void m0_storage_dev_space(struct m0_storage_dev   *dev,
 		M0_ASSERT(balloc != NULL);
 		*space = (struct m0_storage_space) {
 #ifdef __SPARE_SPACE__
-			.sds_free_blocks = balloc->cb_sb.bsb_freeblocks +
-						balloc->cb_sb.bsb_freespare,
+			.sds_free_blocks = m0_balloc_free_blocks(balloc) +
+						m0_balloc_free_spare(balloc),
 #else
-			.sds_free_blocks = balloc->cb_sb.bsb_freeblocks,
+			.sds_free_blocks = m0_balloc_free_blocks(balloc),
 #endif
 			.sds_block_size  = balloc->cb_sb.bsb_blocksize,
-			.sds_avail_blocks = balloc->cb_sb.bsb_freeblocks,
+			.sds_avail_blocks = m0_balloc_free_blocks(balloc),
 			.sds_total_size  = balloc->cb_sb.bsb_totalsize,
 		};
 		break;
@@ -41,6 +41,7 @@ struct m0_dtx;
 struct m0_be_seg;
 struct m0_conf_sdev;
 struct m0_reqh;
+struct m0_bufvec;
 
 /**
  * @defgroup sdev Storage devices.
@@ -184,6 +185,21 @@ M0_INTERNAL void m0_storage_devs_unlock(struct m0_storage_devs *devs);
 M0_INTERNAL void m0_storage_devs_use_directio(struct m0_storage_devs *devs,
 					      bool                    directio);
 
+/**
+ * Registers buffers used for I/O with the backing store domain, so that it
+ * can execute I/O on them more efficiently.
+ *
+ * Only devices of M0_STORAGE_DEV_TYPE_AD are supported, otherwise does
+ * nothing. The buffers must stay allocated until
+ * m0_storage_devs_buffers_unregister().
+ *
+ * @see m0_stob_linux_domain_buffers_register()
+ */
+M0_INTERNAL int m0_storage_devs_buffers_register(struct m0_storage_devs *devs,
+						 const struct m0_bufvec *bufs);
+M0_INTERNAL void
+m0_storage_devs_buffers_unregister(struct m0_storage_devs *devs);
+
 /** Disable sdev locks. Use case: 1+0+0 configuration. */
 M0_INTERNAL void m0_storage_devs_locks_disable(struct m0_storage_devs *devs);
 
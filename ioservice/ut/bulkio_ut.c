@@ -131,8 +131,9 @@ struct m0_net_buffer_pool * ut_get_buffer_pool(struct m0_fom *fom)
  */
 static int bulkio_server_write_fom_tick(struct m0_fom *fom)
 {
-	int rc;
-	int phase0;
+	struct m0_io_fom_cob_rw *fom_obj = M0_AMB(fom_obj, fom, fcrw_gen);
+	int                      rc;
+	int                      phase0;
 
 	phase0 = m0_fom_phase(fom);
 	M0_LOG(M0_DEBUG, "phase=%d", phase0);
@@ -162,7 +163,13 @@ static int bulkio_server_write_fom_tick(struct m0_fom *fom)
 	        M0_UT_ASSERT(m0_fom_phase(fom) == M0_FOPH_IO_ZERO_COPY_WAIT);
 		break;
 	case M0_FOPH_IO_ZERO_COPY_WAIT:
-	        M0_UT_ASSERT(m0_fom_phase(fom) == M0_FOPH_TXN_INIT);
+		/* Pipelined writes open the transaction before zero-copy. */
+		if (fom_obj->fcrw_pipelined)
+			M0_UT_ASSERT(M0_IN(m0_fom_phase(fom),
+					   (M0_FOPH_IO_ZERO_COPY_WAIT,
+					    M0_FOPH_IO_STOB_INIT)));
+		else
+			M0_UT_ASSERT(m0_fom_phase(fom) == M0_FOPH_TXN_INIT);
 		break;
 	case M0_FOPH_IO_STOB_INIT:
 	        M0_UT_ASSERT(m0_fom_phase(fom) == M0_FOPH_IO_STOB_WAIT);
@@ -383,6 +390,8 @@ static int check_write_fom_tick(struct m0_fom *fom)
 	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
 	fop = fom->fo_fop;
 	rwfop = io_rw_get(fop);
+	/* The cases below test transitions of a non-pipelined write. */
+	fom_obj->fcrw_pipelined = false;
 
 	tm = m0_fop_tm_get(fop);
 	colour = m0_net_tm_colour_get(tm);
@@ -1737,6 +1746,8 @@ static void bulkio_server_read_write_multiple_nb(void)
 	}
 	op = M0_IOSERVICE_WRITEV_OPCODE;
 	fop_create_populate(0, op, buf_nr);
+	/* Launch stob io of each buffer as soon as its transfer completes. */
+	io_rw_get(&bp->bp_wfops[0]->if_fop)->crw_flags |= M0_IO_FLAG_PIPELINE;
 	bp->bp_wfops[0]->if_fop.f_type->ft_ops = &io_fop_rwv_ops;
 	io_fops_submit(0, op);
 	io_fops_destroy(bp);
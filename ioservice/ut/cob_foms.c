@@ -430,6 +430,49 @@ static void cobfoms_preexisting_cob(void)
 	cut->cu_gobindex++;
 }
 
+/*
+ * Creates cobs with one batch fop. The cobs exist when the batch is replied,
+ * so that single creates of them fail and single deletes succeed.
+ */
+static void cobfoms_create_batch(void)
+{
+	struct m0_fop                        *fop;
+	struct m0_fop_cob_create_batch       *cb;
+	struct m0_fop_cob_create_batch_reply *rep;
+	uint64_t                              i;
+	int                                   rc;
+
+	cobfoms_fop_thread_init(COB_FOP_NR, COB_FOP_NR);
+	fop = m0_fop_alloc(&m0_fop_cob_create_batch_fopt, NULL,
+			   &cut->cu_cctx.rcx_rpc_machine);
+	M0_UT_ASSERT(fop != NULL);
+	cb = m0_fop_data(fop);
+	M0_ALLOC_ARR(cb->ccb_ops.ccs_ops, COB_FOP_NR);
+	M0_UT_ASSERT(cb->ccb_ops.ccs_ops != NULL);
+	cb->ccb_ops.ccs_nr = COB_FOP_NR;
+	for (i = 0; i < COB_FOP_NR; ++i) {
+		cb->ccb_ops.ccs_ops[i] =
+			*m0_cobfop_common_get(cut->cu_createfops[i]);
+		cb->ccb_ops.ccs_ops[i].c_pver = CONF_PVER_FID;
+	}
+
+	rc = m0_rpc_post_sync(fop, &cut->cu_cctx.rcx_session, NULL,
+			      0 /* deadline */);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_rpc_item_wait_for_reply(&fop->f_item, M0_TIME_NEVER);
+	M0_UT_ASSERT(rc == 0);
+	rep = m0_fop_data(m0_rpc_item_to_fop(fop->f_item.ri_reply));
+	M0_UT_ASSERT(rep->ccbr_rc == 0);
+	M0_UT_ASSERT(rep->ccbr_rcs.crs_nr == COB_FOP_NR);
+	M0_UT_ASSERT(m0_forall(j, COB_FOP_NR, rep->ccbr_rcs.crs_rc[j] == 0));
+	m0_fop_put_lock(fop);
+
+	cobfoms_fops_dispatch(&m0_fop_cob_create_fopt, 0, -EEXIST);
+	cobfoms_fops_dispatch(&m0_fop_cob_delete_fopt, 0, 0);
+	cobfoms_fop_thread_fini(&m0_fop_cob_create_fopt,
+				&m0_fop_cob_delete_fopt);
+}
+
 static void cobfoms_del_nonexist_cob(void)
 {
 	cobfoms_send_internal(NULL, &m0_fop_cob_delete_fopt, 0, 0, -ENOENT,
@@ -1573,6 +1616,7 @@ struct m0_ut_suite cobfoms_ut = {
 		{ "cobfoms_multiple_fops",          cobfoms_multiple},
 		{ "cobfoms_preexisting_cob_create", cobfoms_preexisting_cob},
 		{ "cobfoms_delete_nonexistent_cob", cobfoms_del_nonexist_cob},
+		{ "cobfoms_create_batch",           cobfoms_create_batch},
 		{ "cobfoms_md_cob_fop",             md_cob_create_delete},
 		{ "cobfoms_create_cob_apitest",     cob_create_api_test},
 		{ "cobfoms_delete_cob_apitest",     cob_delete_api_test},
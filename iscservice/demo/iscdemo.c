@@ -41,8 +41,18 @@ enum isc_comp_type {
 	ICT_MAX,
 	ICT_MIN2, /* arrays of 8-byte doubles */
 	ICT_MAX2,
+	ICT_GREP,
+	ICT_CKSUM,
 };
 
+enum {
+	/** Default number of parity groups computed in parallel. */
+	ISC_GRP_WIN_DEF = 4,
+};
+
+/** String searched for by the grep computation. */
+static const char *grep_pattern;
+
 static int op_type_parse(const char *op_name)
 {
 	if (op_name == NULL)
@@ -57,11 +67,53 @@ static int op_type_parse(const char *op_name)
 		return ICT_MIN2;
 	else if (!strcmp(op_name, "max2"))
 		return ICT_MAX2;
+	else if (!strcmp(op_name, "grep"))
+		return ICT_GREP;
+	else if (!strcmp(op_name, "cksum"))
+		return ICT_CKSUM;
 	else
 		return -EINVAL;
 
 }
 
+static int targs_fill(struct isc_targs *ta, struct m0_layout_io_plop *iop)
+{
+	if (iop->iop_ext.iv_vec.v_nr == 0) {
+		ERR("at least 1 segment is required\n");
+		return -EINVAL;
+	}
+	ta->ist_cob = iop->iop_base.pl_ent;
+	return m0_indexvec_mem2wire(&iop->iop_ext, iop->iop_ext.iv_vec.v_nr, 0,
+				    &ta->ist_ioiv);
+}
+
+static int grep_input_prepare(struct m0_buf *out, struct m0_fid *comp_fid,
+			      struct m0_layout_io_plop *iop,
+			      uint32_t *reply_len)
+{
+	int              rc;
+	struct m0_buf    buf = M0_BUF_INIT0;
+	struct grep_args ga = {};
+
+	rc = targs_fill(&ga.ga_targs, iop);
+	if (rc != 0)
+		return rc;
+	ga.ga_pattern = M0_BUF_INITS((char *)grep_pattern);
+	rc = m0_xcode_obj_enc_to_buf(&M0_XCODE_OBJ(grep_args_xc, &ga),
+				     &buf.b_addr, &buf.b_nob);
+	if (rc != 0)
+		return rc;
+
+	*out = M0_BUF_INIT0; /* to avoid panic */
+	rc = m0_buf_copy_aligned(out, &buf, M0_0VEC_SHIFT);
+	m0_buf_free(&buf);
+
+	isc_fid_get("comp_grep", comp_fid);
+	*reply_len = CBL_DEFAULT_MAX;
+
+	return rc;
+}
+
 static int minmax_input_prepare(struct m0_buf *out, struct m0_fid *comp_fid,
 				struct m0_layout_io_plop *iop,
 				uint32_t *reply_len, enum isc_comp_type type)
@@ -70,13 +122,7 @@ static int minmax_input_prepare(struct m0_buf *out, struct m0_fid *comp_fid,
 	struct m0_buf buf = M0_BUF_INIT0;
 	struct isc_targs ta = {};
 
-	if (iop->iop_ext.iv_vec.v_nr == 0) {
-		ERR("at least 1 segment is required\n");
-		return -EINVAL;
-	}
-	ta.ist_cob = iop->iop_base.pl_ent;
-	rc = m0_indexvec_mem2wire(&iop->iop_ext, iop->iop_ext.iv_vec.v_nr, 0,
-				  &ta.ist_ioiv);
+	rc = targs_fill(&ta, iop);
 	if (rc != 0)
 		return rc;
 	rc = m0_xcode_obj_enc_to_buf(&M0_XCODE_OBJ(isc_targs_xc, &ta),
@@ -96,6 +142,8 @@ static int minmax_input_prepare(struct m0_buf *out, struct m0_fid *comp_fid,
 		isc_fid_get("comp_min2", comp_fid);
 	else if (type == ICT_MAX2)
 		isc_fid_get("comp_max2", comp_fid);
+	else if (type == ICT_CKSUM)
+		isc_fid_get("comp_cksum", comp_fid);
 
 	*reply_len = CBL_DEFAULT_MAX;
 
@@ -130,8 +178,11 @@ static int input_prepare(struct m0_buf *buf, struct m0_fid *comp_fid,
 	case ICT_MAX:
 	case ICT_MIN2:
 	case ICT_MAX2:
+	case ICT_CKSUM:
 		return minmax_input_prepare(buf, comp_fid, iop,
 					    reply_len, type);
+	case ICT_GREP:
+		return grep_input_prepare(buf, comp_fid, iop, reply_len);
 	}
 	return -EINVAL;
 }
@@ -362,6 +413,120 @@ static void *minmax2_output_prepare(struct m0_buf *result,
 	return prev;
 }
 
+/**
+ * Count the occurrences of the pattern crossing the boundary between
+ * two units: in the glued right edge of one unit and left edge of
+ * the next one.
+ */
+static uint64_t grep_edges_nr(const struct m0_buf *r, const struct m0_buf *l)
+{
+	char     *buf;
+	char     *p;
+	char     *end;
+	size_t    plen = strlen(grep_pattern);
+	uint64_t  nr = 0;
+
+	buf = m0_alloc(r->b_nob + l->b_nob);
+	if (buf == NULL) {
+		ERR("failed to allocate edges buffer\n");
+		return 0;
+	}
+	memcpy(buf, r->b_addr, r->b_nob);
+	memcpy(buf + r->b_nob, l->b_addr, l->b_nob);
+
+	end = buf + r->b_nob + l->b_nob;
+	for (p = buf; p < end &&
+	     (p = memmem(p, end - p, grep_pattern, plen)) != NULL; p++)
+		nr++;
+
+	m0_free(buf);
+
+	return nr;
+}
+
+static void grep_result_free_xcode_bufs(struct grep_result *r)
+{
+	m0_free(r->gr_lbuf.b_addr);
+	m0_free(r->gr_rbuf.b_addr);
+}
+
+static void *grep_output_prepare(struct m0_buf *result, bool last_unit,
+				 struct grep_result *prev)
+{
+	int                rc;
+	struct grep_result new = {};
+
+	rc = m0_xcode_obj_dec_from_buf(&M0_XCODE_OBJ(grep_result_xc, &new),
+				       result->b_addr, result->b_nob);
+	if (rc != 0) {
+		ERR("failed to parse result: rc=%d\n", rc);
+		goto out;
+	}
+	if (prev == NULL) {
+		M0_ALLOC_PTR(prev);
+		if (prev == NULL) {
+			grep_result_free_xcode_bufs(&new);
+			goto out;
+		}
+		*prev = new;
+		goto out;
+	}
+
+	/*
+	 * Count the occurrences crossing the boundary with the previous
+	 * unit, the right edge of this unit is kept for the next one.
+	 */
+	new.gr_nr += prev->gr_nr + grep_edges_nr(&prev->gr_rbuf,
+						 &new.gr_lbuf);
+	grep_result_free_xcode_bufs(prev);
+	*prev = new;
+ out:
+	/* Print the result. */
+	if (last_unit && prev != NULL) {
+		printf("nr=%lu\n", prev->gr_nr);
+		grep_result_free_xcode_bufs(prev);
+		m0_free(prev);
+		prev = NULL;
+	}
+
+	return prev;
+}
+
+static void *cksum_output_prepare(struct m0_buf *result, bool last_unit,
+				  struct cksum_result *prev)
+{
+	int                 rc;
+	struct cksum_result new = {};
+
+	rc = m0_xcode_obj_dec_from_buf(&M0_XCODE_OBJ(cksum_result_xc, &new),
+				       result->b_addr, result->b_nob);
+	if (rc != 0) {
+		ERR("failed to parse result: rc=%d\n", rc);
+		goto out;
+	}
+	if (prev == NULL) {
+		M0_ALLOC_PTR(prev);
+		if (prev != NULL)
+			*prev = new;
+		goto out;
+	}
+
+	/* Append the unit sums, see cksum_result. */
+	prev->cr_s2 += prev->cr_s1 * new.cr_len + new.cr_s2;
+	prev->cr_s1 += new.cr_s1;
+	prev->cr_len += new.cr_len;
+ out:
+	/* Print the result. */
+	if (last_unit && prev != NULL) {
+		printf("len=%lu cksum=%016lx%016lx\n", prev->cr_len,
+		       prev->cr_s2, prev->cr_s1);
+		m0_free(prev);
+		prev = NULL;
+	}
+
+	return prev;
+}
+
 /**
  * Deserialize the buffer at @result and do the final computation,
  * taking into account the previous result @out, and return the new one.
@@ -381,6 +546,10 @@ static void* output_process(struct m0_buf *result, bool last,
 	case ICT_MIN2:
 	case ICT_MAX2:
 		return minmax2_output_prepare(result, last, out, type);
+	case ICT_GREP:
+		return grep_output_prepare(result, last, out);
+	case ICT_CKSUM:
+		return cksum_output_prepare(result, last, out);
 	}
 	return NULL;
 }
@@ -389,11 +558,13 @@ char *prog;
 
 const char *help_str = "\
 \n\
-Usage: %s OPTIONS COMP OBJ_ID LEN\n\
+Usage: %s OPTIONS COMP OBJ_ID LEN [PATTERN]\n\
 \n\
- Supported COMPutations: ping, min, max, min2, max2.\n\
+ Supported COMPutations: ping, min, max, min2, max2, grep, cksum.\n\
  min, max - for floating point numbers in string format;\n\
- min2, max2 - for arrays of 8-byte doubles.\n\
+ min2, max2 - for arrays of 8-byte doubles;\n\
+ grep - number of occurrences of PATTERN string;\n\
+ cksum - Fletcher-like checksum of the object data.\n\
 \n\
  OBJ_ID is two uint64 numbers in hi:lo format (dec or hex)\n\
  LEN    is the length of object (in KiB)\n\
@@ -405,13 +576,14 @@ Usage: %s OPTIONS COMP OBJ_ID LEN\n\
    -p <fid>   profile fid\n\
 \n\
  Other non-mandatory options:\n\
+   -w <nr>  number of parity groups computed in parallel (default %d)\n\
    -v  increase verbosity (-vv to increase even more)\n\
    -h  this help\n\
 \n";
 
 static void usage()
 {
-	fprintf(stderr, help_str, prog);
+	fprintf(stderr, help_str, prog, ISC_GRP_WIN_DEF);
 	exit(1);
 }
 
@@ -436,29 +608,46 @@ int read_id(const char *s, struct m0_uint128 *id)
 	return res;
 }
 
-int launch_comp(struct m0_layout_plan *plan, int op_type, bool last)
+/**
+ * A parity group of the object the computation is dispatched to.
+ *
+ * Up to the window of groups are computed in parallel: the requests
+ * of the next groups are sent while the replies of the previous ones
+ * are being received and reduced, in the object order.
+ */
+struct isc_grp {
+	struct m0_op          *ig_op;
+	struct m0_layout_plan *ig_plan;
+	struct m0_indexvec     ig_ext;
+	struct m0_bufvec       ig_data;
+	struct m0_bufvec       ig_attr;
+	/** Number of requests of the group at isc_reqs. */
+	int                    ig_reqs_nr;
+	/** The last group of the object. */
+	bool                   ig_last;
+};
+
+/** Computation output reduced so far. */
+static void *comp_out = NULL;
+
+/**
+ * Sends the requests of the computation for all the units of the group.
+ */
+int launch_comp(struct isc_grp *grp, int op_type)
 {
-	int                    rc;
-	int                    reqs_nr = 0;
+	int                    rc = 0;
 	uint32_t               reply_len;
 	struct isc_req        *req;
 	struct m0_layout_plop *plop = NULL;
 	struct m0_layout_io_plop *iopl;
-	static void           *out_args = NULL; /* computation output */
-	const char            *conn_addr = NULL;
 	struct m0_fid          comp_fid;
 	struct m0_buf          buf;
 
 	for (;;) {
-		M0_ALLOC_PTR(req);
-		if (req == NULL) {
-			ERR("request allocation failed\n");
-			break;
-		}
-		rc = m0_layout_plan_get(plan, 0, &plop);
+		rc = m0_layout_plan_get(grp->ig_plan, 0, &plop);
 		if (rc != 0) {
 			ERR("failed to get plop: rc=%d\n", rc);
-			usage();
+			break;
 		}
 
 		if (plop->pl_type == M0_LAT_DONE)
@@ -469,16 +658,24 @@ int launch_comp(struct m0_layout_plan *plan, int op_type, bool last)
 
 		M0_ASSERT(plop->pl_type == M0_LAT_READ);
 
+		M0_ALLOC_PTR(req);
+		if (req == NULL) {
+			ERR("request allocation failed\n");
+			rc = -ENOMEM;
+			break;
+		}
+
 		m0_layout_plop_start(plop);
 
 		iopl = container_of(plop, struct m0_layout_io_plop, iop_base);
 
-		DBG("req=%d goff=%lu segs=%d\n", reqs_nr, iopl->iop_goff,
-		                                 iopl->iop_ext.iv_vec.v_nr);
+		DBG("req=%d goff=%lu segs=%d\n", grp->ig_reqs_nr,
+		    iopl->iop_goff, iopl->iop_ext.iv_vec.v_nr);
 		/* Prepare arguments for the computation. */
 		rc = input_prepare(&buf, &comp_fid, iopl, &reply_len, op_type);
 		if (rc != 0) {
 			m0_layout_plop_done(plop);
+			m0_free(req);
 			ERR("input preparation failed: %d\n", rc);
 			break;
 		}
@@ -493,30 +690,54 @@ int launch_comp(struct m0_layout_plan *plan, int op_type, bool last)
 		}
 
 		rc = isc_req_send(req);
-		conn_addr = m0_rpc_conn_addr(iopl->iop_session->s_conn);
+		/* The request is at isc_reqs even if it was not sent. */
+		grp->ig_reqs_nr++;
 		if (rc != 0) {
 			ERR("error from %s received: rc=%d\n",
-				conn_addr, rc);
+			    m0_rpc_conn_addr(iopl->iop_session->s_conn), rc);
+			req->cir_rc = rc;
+			req->cir_replied = true;
 			break;
 		}
-		reqs_nr++;
 	}
 
-	/* Wait for all the replies. */
-	while (reqs_nr-- > 0)
-		m0_semaphore_down(&isc_sem);
+	return rc;
+}
+
+/**
+ * Waits for the replies of the group requests and reduces them.
+ *
+ * The requests at isc_reqs are ordered by the object offset and the groups
+ * are completed in the order they were launched, so the requests of the group
+ * are at the head of the list.
+ */
+static int complete_comp(struct isc_grp *grp, int op_type)
+{
+	int                       rc = 0;
+	struct isc_req           *req;
+	struct m0_layout_io_plop *iopl;
+
+	while (grp->ig_reqs_nr-- > 0) {
+		M0_ASSERT(!m0_list_is_empty(&isc_reqs));
+		req = m0_list_entry(m0_list_first(&isc_reqs), struct isc_req,
+				    cir_link);
+		/* Replies to the other requests may be received first. */
+		while (!req->cir_replied)
+			m0_semaphore_down(&isc_sem);
+		m0_list_del(&req->cir_link);
 
-	/* Process the replies. */
-	m0_list_teardown(&isc_reqs, req, struct isc_req, cir_link) {
 		iopl = M0_AMB(iopl, req->cir_plop, iop_base);
-		DBG2("req=%d goff=%lu\n", ++reqs_nr, iopl->iop_goff);
-		if (rc == 0 && req->cir_rc == 0) {
+		DBG2("goff=%lu\n", iopl->iop_goff);
+		if (req->cir_rc == 0) {
 			if (op_type == ICT_PING)
-				out_args = (void*)conn_addr;
-			out_args = output_process(&req->cir_result,
-					  last && m0_list_is_empty(&isc_reqs),
-						  out_args, op_type);
-		}
+				comp_out = (void *)m0_rpc_conn_addr(
+						req->cir_rpc_sess->s_conn);
+			comp_out = output_process(&req->cir_result,
+						  grp->ig_last &&
+						  m0_list_is_empty(&isc_reqs),
+						  comp_out, op_type);
+		} else if (rc == 0)
+			rc = req->cir_rc;
 		m0_layout_plop_done(req->cir_plop);
 		isc_req_fini(req);
 		m0_free(req);
@@ -525,6 +746,50 @@ int launch_comp(struct m0_layout_plan *plan, int op_type, bool last)
 	return rc;
 }
 
+/**
+ * Builds the access plan of the group at @off and launches the computation
+ * on its units.
+ */
+static int grp_launch(struct isc_grp *grp, struct m0_obj *obj,
+		      m0_bindex_t off, int unit_sz, int units_nr, int op_type)
+{
+	int rc;
+
+	DBG("off=%lu unit_sz=%d units=%d\n", off, unit_sz, units_nr);
+
+	rc = alloc_segs(&grp->ig_data, &grp->ig_ext, &grp->ig_attr,
+			unit_sz, units_nr);
+	if (rc != 0) {
+		ERR("failed to alloc_segs: rc=%d\n", rc);
+		return rc;
+	}
+	set_exts(&grp->ig_ext, off, unit_sz);
+
+	rc = m0_obj_op(obj, M0_OC_READ, &grp->ig_ext, &grp->ig_data,
+		       &grp->ig_attr, 0, 0, &grp->ig_op);
+	if (rc != 0) {
+		ERR("failed to create op: rc=%d\n", rc);
+		free_segs(&grp->ig_data, &grp->ig_ext, &grp->ig_attr);
+		return rc;
+	}
+
+	grp->ig_plan = m0_layout_plan_build(grp->ig_op);
+	if (grp->ig_plan == NULL) {
+		ERR("failed to build access plan\n");
+		free_segs(&grp->ig_data, &grp->ig_ext, &grp->ig_attr);
+		return -ENOMEM;
+	}
+
+	return launch_comp(grp, op_type);
+}
+
+static void grp_fini(struct isc_grp *grp)
+{
+	m0_layout_plan_fini(grp->ig_plan);
+	free_segs(&grp->ig_data, &grp->ig_ext, &grp->ig_attr);
+	M0_SET0(grp);
+}
+
 static int open_entity(struct m0_entity *entity)
 {
 	int                  rc;
@@ -543,26 +808,26 @@ static int open_entity(struct m0_entity *entity)
 int main(int argc, char **argv)
 {
 	int                    rc;
+	int                    rc2;
 	int                    opt;
 	struct m0_client      *cinst = NULL;
-	struct m0_op          *op = NULL;
-	struct m0_layout_plan *plan;
 	struct m0_uint128      obj_id;
-	struct m0_indexvec     ext;
-	struct m0_bufvec       data;
-	struct m0_bufvec       attr;
 	struct m0_config       conf = {};
 	int                    op_type;
 	int                    unit_sz;
-	int                    units_nr;
+	int                    win = ISC_GRP_WIN_DEF;
+	int                    busy = 0;
+	int                    i;
 	m0_bcount_t            len;
 	m0_bcount_t            bs;
 	m0_bindex_t            off = 0;
 	struct m0_obj          obj = {};
+	struct isc_grp        *grps;
+	struct isc_grp        *grp;
 
 	prog = basename(strdup(argv[0]));
 
-	while ((opt = getopt(argc, argv, ":vhe:x:f:p:")) != -1) {
+	while ((opt = getopt(argc, argv, ":vhe:x:f:p:w:")) != -1) {
 		switch (opt) {
 		case 'e':
 			conf.mc_local_addr = optarg;
@@ -576,6 +841,13 @@ int main(int argc, char **argv)
 		case 'p':
 			conf.mc_profile = optarg;
 			break;
+		case 'w':
+			win = atoi(optarg);
+			if (win < 1) {
+				ERR("window should be at least 1\n");
+				usage();
+			}
+			break;
 		case 'v':
 			trace_level++;
 			break;
@@ -608,6 +880,18 @@ int main(int argc, char **argv)
 		usage();
 	}
 	len *= 1024;
+	if (op_type == ICT_GREP) {
+		if (argc - optind < 4)
+			usage();
+		grep_pattern = argv[optind + 3];
+		/* The edges of the units are sent back in the reply. */
+		if (strlen(grep_pattern) == 0 ||
+		    strlen(grep_pattern) > CBL_DEFAULT_MAX / 4) {
+			ERR("pattern length should be within [1, %d]\n",
+			    CBL_DEFAULT_MAX / 4);
+			usage();
+		}
+	}
 
 	m0trace_on = true;
 
@@ -633,36 +917,42 @@ int main(int argc, char **argv)
 	}
 	unit_sz = m0_obj_layout_id_to_unit_size(obj.ob_attr.oa_layout_id);
 
-	for (; rc == 0 && len > 0; len -= len < bs ? len : bs, off += bs) {
-		if (len < bs)
-			bs = (len + unit_sz - 1) / unit_sz * unit_sz;
-		units_nr = bs / unit_sz;
-		DBG("unit_sz=%d units=%d\n", unit_sz, units_nr);
+	M0_ALLOC_ARR(grps, win);
+	if (grps == NULL) {
+		ERR("failed to allocate groups\n");
+		usage();
+	}
 
-		rc = alloc_segs(&data, &ext, &attr, unit_sz, units_nr);
-		if (rc != 0) {
-			ERR("failed to alloc_segs: rc=%d\n", rc);
-			usage();
+	/*
+	 * The groups are used in turn: the group is completed before
+	 * the computation is launched on the next group of the object.
+	 */
+	for (i = 0; len > 0 || busy > 0; i = (i + 1) % win) {
+		grp = &grps[i];
+		if (grp->ig_plan != NULL) {
+			rc2 = complete_comp(grp, op_type);
+			rc = rc ?: rc2;
+			grp_fini(grp);
+			busy--;
 		}
-		set_exts(&ext, off, unit_sz);
-
-		rc = m0_obj_op(&obj, M0_OC_READ, &ext, &data, &attr, 0, 0, &op);
 		if (rc != 0) {
-			ERR("failed to create op: rc=%d\n", rc);
-			usage();
-		}
-
-		plan = m0_layout_plan_build(op);
-		if (plan == NULL) {
-			ERR("failed to build access plan\n");
-			usage();
+			/* Stop launching, complete the groups in flight. */
+			len = 0;
+			continue;
 		}
+		if (len == 0)
+			continue;
 
-		rc = launch_comp(plan, op_type, len <= bs ? true : false);
-
-		m0_layout_plan_fini(plan);
-		free_segs(&data, &ext, &attr);
+		if (len < bs)
+			bs = (len + unit_sz - 1) / unit_sz * unit_sz;
+		grp->ig_last = len <= bs;
+		rc = grp_launch(grp, &obj, off, unit_sz, bs / unit_sz, op_type);
+		if (grp->ig_plan != NULL)
+			busy++;
+		len -= len < bs ? len : bs;
+		off += bs;
 	}
+	m0_free(grps);
 
 	isc_fini(cinst);
 
@@ -62,18 +62,29 @@ int hello_world(struct m0_buf *in, struct m0_buf *out,
 }
 
 enum op {
-	MIN, MAX,  /* data format: floating point strings */
-	MIN2, MAX2 /* 8-bytes doubles */
+	MIN, MAX,   /* data format: floating point strings */
+	MIN2, MAX2, /* 8-bytes doubles */
+	GREP,       /* occurrences of a string */
+	CKSUM       /* checksum of the bytes */
 };
 
-int launch_io(struct m0_isc_comp_private *pdata, struct m0_buf *in, int *rc)
+int launch_io(enum op op, struct m0_isc_comp_private *pdata, struct m0_buf *in,
+	      int *rc)
 {
 	struct m0_stob_io *stio = (struct m0_stob_io *)pdata->icp_data;
 	struct m0_fom     *fom = pdata->icp_fom;
 	struct isc_targs   ta = {};
+	struct grep_args   ga = {};
 
-	*rc = m0_xcode_obj_dec_from_buf(&M0_XCODE_OBJ(isc_targs_xc, &ta),
-					in->b_addr, in->b_nob);
+	if (op == GREP) {
+		*rc = m0_xcode_obj_dec_from_buf(&M0_XCODE_OBJ(grep_args_xc,
+							      &ga),
+						in->b_addr, in->b_nob);
+		ta = ga.ga_targs;
+	} else
+		*rc = m0_xcode_obj_dec_from_buf(&M0_XCODE_OBJ(isc_targs_xc,
+							      &ta),
+						in->b_addr, in->b_nob);
 	if (*rc != 0) {
 		M0_LOG(M0_ERROR, "failed to xdecode args: rc=%d", *rc);
 		return M0_FSO_AGAIN;
@@ -213,8 +224,102 @@ int compute_minmax2(enum op op, struct m0_isc_comp_private *pdata,
 	return M0_FSO_AGAIN;
 }
 
+static uint64_t occurrences_nr(const char *buf, m0_bcount_t len,
+			       const struct m0_buf *pat)
+{
+	const char *p = buf;
+	const char *end = buf + len;
+	uint64_t    nr = 0;
+
+	while (p < end &&
+	       (p = memmem(p, end - p, pat->b_addr, pat->b_nob)) != NULL) {
+		nr++;
+		p++;
+	}
+
+	return nr;
+}
+
+int compute_grep(struct m0_buf *in, struct m0_isc_comp_private *pdata,
+		 struct m0_buf *out, int *rc)
+{
+	char               *p;
+	m0_bcount_t         len;
+	m0_bcount_t         edge;
+	struct grep_args    ga = {};
+	struct grep_result  res = {};
+	struct m0_buf       buf = M0_BUF_INIT0;
+
+	len = m0_isc_io_res((struct m0_stob_io *)pdata->icp_data, &p);
+	if (len < 0) {
+		*rc = M0_ERR_INFO((int)len, "failed to read data");
+		return M0_FSO_AGAIN;
+	}
+
+	*rc = m0_xcode_obj_dec_from_buf(&M0_XCODE_OBJ(grep_args_xc, &ga),
+					in->b_addr, in->b_nob);
+	if (*rc != 0) {
+		M0_LOG(M0_ERROR, "failed to xdecode args: rc=%d", *rc);
+		return M0_FSO_AGAIN;
+	}
+	if (ga.ga_pattern.b_nob == 0 || ga.ga_pattern.b_nob > len) {
+		*rc = M0_ERR(-EINVAL);
+		goto out;
+	}
+
+	/*
+	 * The edges are glued with the edges of the adjacent units
+	 * by the client, so that the occurrences crossing the units
+	 * boundaries are counted.
+	 */
+	edge = ga.ga_pattern.b_nob - 1;
+	res.gr_nr = occurrences_nr(p, len, &ga.ga_pattern);
+	res.gr_lbuf = M0_BUF_INIT(edge, p);
+	res.gr_rbuf = M0_BUF_INIT(edge, p + len - edge);
+
+	*rc = m0_xcode_obj_enc_to_buf(&M0_XCODE_OBJ(grep_result_xc, &res),
+				      &buf.b_addr, &buf.b_nob) ?:
+	      m0_buf_copy_aligned(out, &buf, M0_0VEC_SHIFT);
+
+	m0_buf_free(&buf);
+ out:
+	m0_xcode_free_obj(&M0_XCODE_OBJ(grep_args_xc, &ga));
+
+	return M0_FSO_AGAIN;
+}
+
+int compute_cksum(struct m0_isc_comp_private *pdata, struct m0_buf *out,
+		  int *rc)
+{
+	unsigned char       *p;
+	m0_bcount_t          len;
+	m0_bcount_t          i;
+	struct cksum_result  res = {};
+	struct m0_buf        buf = M0_BUF_INIT0;
+
+	len = m0_isc_io_res((struct m0_stob_io *)pdata->icp_data, (char**)&p);
+	if (len < 0) {
+		*rc = M0_ERR_INFO((int)len, "failed to read data");
+		return M0_FSO_AGAIN;
+	}
+
+	for (i = 0; i < len; i++) {
+		res.cr_s1 += p[i];
+		res.cr_s2 += res.cr_s1;
+	}
+	res.cr_len = len;
+
+	*rc = m0_xcode_obj_enc_to_buf(&M0_XCODE_OBJ(cksum_result_xc, &res),
+				      &buf.b_addr, &buf.b_nob) ?:
+	      m0_buf_copy_aligned(out, &buf, M0_0VEC_SHIFT);
+
+	m0_buf_free(&buf);
+
+	return M0_FSO_AGAIN;
+}
+
 /**
- * Do the computation of min/max.
+ * Do the computation over the unit data.
  *
  * This function is called two times by the ISC-implementation.
  * The 1st time we start the I/O to read the data from the object
@@ -223,8 +328,8 @@ int compute_minmax2(enum op op, struct m0_isc_comp_private *pdata,
  * data is ready. When I/O is complete and the data is ready, the
  * function is called again so we can actually do the computation.
  */
-int do_minmax(enum op op, struct m0_buf *in, struct m0_buf *out,
-	      struct m0_isc_comp_private *data, int *rc)
+int do_comp(enum op op, struct m0_buf *in, struct m0_buf *out,
+	    struct m0_isc_comp_private *data, int *rc)
 {
 	int                res;
 	struct m0_stob_io *stio = (struct m0_stob_io *)data->icp_data;
@@ -236,12 +341,16 @@ int do_minmax(enum op op, struct m0_buf *in, struct m0_buf *out,
 			return M0_FSO_AGAIN;
 		}
 		data->icp_data = stio;
-		res = launch_io(data, in, rc);
+		res = launch_io(op, data, in, rc);
 		if (*rc != -EAGAIN)
 			m0_free(stio);
 	} else {
 		if (op == MIN || op == MAX)
 			res = compute_minmax(op, data, out, rc);
+		else if (op == GREP)
+			res = compute_grep(in, data, out, rc);
+		else if (op == CKSUM)
+			res = compute_cksum(data, out, rc);
 		else /* MIN2 || MAX2 */
 			res = compute_minmax2(op, data, out, rc);
 		m0_isc_io_fini(stio);
@@ -268,25 +377,45 @@ int do_minmax(enum op op, struct m0_buf *in, struct m0_buf *out,
 int comp_min(struct m0_buf *in, struct m0_buf *out,
 	     struct m0_isc_comp_private *comp_data, int *rc)
 {
-	return do_minmax(MIN, in, out, comp_data, rc);
+	return do_comp(MIN, in, out, comp_data, rc);
 }
 
 int comp_max(struct m0_buf *in, struct m0_buf *out,
 	     struct m0_isc_comp_private *comp_data, int *rc)
 {
-	return do_minmax(MAX, in, out, comp_data, rc);
+	return do_comp(MAX, in, out, comp_data, rc);
 }
 
 int comp_min2(struct m0_buf *in, struct m0_buf *out,
 	      struct m0_isc_comp_private *comp_data, int *rc)
 {
-	return do_minmax(MIN2, in, out, comp_data, rc);
+	return do_comp(MIN2, in, out, comp_data, rc);
 }
 
 int comp_max2(struct m0_buf *in, struct m0_buf *out,
 	      struct m0_isc_comp_private *comp_data, int *rc)
 {
-	return do_minmax(MAX2, in, out, comp_data, rc);
+	return do_comp(MAX2, in, out, comp_data, rc);
+}
+
+/**
+ * Count the occurrences of a string in the unit data.
+ * The unit edges are returned to count the occurrences crossing
+ * the units boundaries, see grep_result.
+ */
+int comp_grep(struct m0_buf *in, struct m0_buf *out,
+	      struct m0_isc_comp_private *comp_data, int *rc)
+{
+	return do_comp(GREP, in, out, comp_data, rc);
+}
+
+/**
+ * Compute the checksum of the unit data, see cksum_result.
+ */
+int comp_cksum(struct m0_buf *in, struct m0_buf *out,
+	       struct m0_isc_comp_private *comp_data, int *rc)
+{
+	return do_comp(CKSUM, in, out, comp_data, rc);
 }
 
 static void comp_reg(const char *f_name, int (*ftn)(struct m0_buf *arg_in,
@@ -312,5 +441,7 @@ void motr_lib_init(void)
 	comp_reg("comp_max", comp_max);
 	comp_reg("comp_min2", comp_min2);
 	comp_reg("comp_max2", comp_max2);
+	comp_reg("comp_grep", comp_grep);
+	comp_reg("comp_cksum", comp_cksum);
 	m0_xc_iscservice_demo_libdemo_init();
 }
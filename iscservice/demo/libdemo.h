@@ -60,6 +60,42 @@ struct isc_targs {
 	struct m0_io_indexvec ist_ioiv;
 } M0_XCA_RECORD;
 
+/** Arguments of the grep computation. */
+struct grep_args {
+	/** Unit whereabouts. */
+	struct isc_targs ga_targs;
+	/** String to search for. */
+	struct m0_buf    ga_pattern;
+} M0_XCA_RECORD;
+
+/**
+ * Holds the result of grep computation over the unit.
+ *
+ * The occurrences which cross the units boundaries are found by the client
+ * code in the glued right edge of the unit and left edge of the next one.
+ */
+struct grep_result {
+	/** Number of occurrences of the pattern inside the unit. */
+	uint64_t      gr_nr;
+	/** First (pattern length - 1) bytes of the unit. */
+	struct m0_buf gr_lbuf;
+	/** Last (pattern length - 1) bytes of the unit. */
+	struct m0_buf gr_rbuf;
+} M0_XCA_RECORD;
+
+/**
+ * Holds the result of checksum computation over the unit: Fletcher-like
+ * sums modulo 2^64 of the bytes and of their running sums. The results of
+ * two adjacent units x and y are combined by the client code as:
+ * s1 = x.s1 + y.s1, s2 = x.s2 + x.s1 * y.len + y.s2.
+ */
+struct cksum_result {
+	/** Number of bytes summed. */
+	uint64_t cr_len;
+	uint64_t cr_s1;
+	uint64_t cr_s2;
+} M0_XCA_RECORD;
+
 #endif /* __MOTR_ISCSERVICE_DEMO_LIBDEMO_H__ */
 
 /*
@@ -170,6 +170,7 @@ void isc_req_replied(struct m0_rpc_item *item)
 	if (rc != 0)
 		ERR("rpc_at_rep_get() from %s failed: rc=%d\n", addr, rc);
  err:
+	req->cir_replied = true;
 	m0_semaphore_up(&isc_sem);
 }
 
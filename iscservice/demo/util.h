@@ -50,6 +50,8 @@ struct isc_req {
 	struct m0_buf          cir_result;
 	/** Error code for the computation. */
 	int                    cir_rc;
+	/** Set when the reply (or an error) is received. */
+	bool                   cir_replied;
 	/** RPC session of the ISC service. */
 	struct m0_rpc_session *cir_rpc_sess;
 	/** FOP for ISC service. */
@@ -94,7 +96,8 @@ int isc_req_prepare(struct isc_req *, struct m0_buf *args,
  * Sends a request asynchronously.
  *
  * The request is added to the isc_reqs list maintaining the order by
- * the object unit offset. On reply receipt, isc_sem(aphore) is up-ped.
+ * the object unit offset. On reply receipt, req->cir_replied is set
+ * and isc_sem(aphore) is up-ped.
  * The received reply is populated at req->cir_result.
  * The error code is returned at req->cir_rc.
  *
@@ -188,6 +188,109 @@ static void pdclust_unregister(struct m0_layout_domain *dom,
 {
 }
 
+/** A tile permutation in m0_pdclust_layout::pl_tile_lru. */
+struct pdclust_tile {
+	struct m0_fid pt_gfid;
+	uint64_t      pt_omega;
+	/** Logical time of the last access, 0 for an unused tile. */
+	uint64_t      pt_stamp;
+	/** tc_permute[], tc_inverse[] and tc_lcode[] of the tile, P each. */
+	uint32_t     *pt_perm;
+};
+
+static void tile_lru_init(struct m0_pdclust_layout *pl)
+{
+	m0_mutex_init(&pl->pl_tile_lru.tl_lock);
+	pl->pl_tile_lru.tl_tile = NULL;
+	pl->pl_tile_lru.tl_clock = 0;
+}
+
+static void tile_lru_fini(struct m0_pdclust_layout *pl)
+{
+	struct pdclust_tile_lru *lru = &pl->pl_tile_lru;
+	int                      i;
+
+	if (lru->tl_tile != NULL) {
+		for (i = 0; i < M0_PDCLUST_TILE_LRU_NR; ++i)
+			m0_free(lru->tl_tile[i].pt_perm);
+		m0_free(lru->tl_tile);
+	}
+	m0_mutex_fini(&lru->tl_lock);
+}
+
+static void tile_copy(uint32_t *dst, const uint32_t *src, uint32_t P)
+{
+	memcpy(dst, src, P * sizeof dst[0]);
+}
+
+/**
+ * Copies permutation of the tile (gfid, omega) from the layout cache to tc.
+ * Returns false if the layout does not cache the tile.
+ */
+static bool tile_lru_get(struct m0_pdclust_layout *pl,
+			 const struct m0_fid *gfid, uint64_t omega,
+			 struct tile_cache *tc)
+{
+	struct pdclust_tile_lru *lru = &pl->pl_tile_lru;
+	struct pdclust_tile     *tile;
+	uint32_t                 P = pl->pl_attr.pa_P;
+	bool                     found = false;
+	int                      i;
+
+	m0_mutex_lock(&lru->tl_lock);
+	for (i = 0; lru->tl_tile != NULL && i < M0_PDCLUST_TILE_LRU_NR; ++i) {
+		tile = &lru->tl_tile[i];
+		if (tile->pt_stamp != 0 && tile->pt_omega == omega &&
+		    m0_fid_eq(&tile->pt_gfid, gfid)) {
+			tile_copy(tc->tc_permute, tile->pt_perm, P);
+			tile_copy(tc->tc_inverse, tile->pt_perm + P, P);
+			tile_copy(tc->tc_lcode, tile->pt_perm + 2 * P, P);
+			tile->pt_stamp = ++lru->tl_clock;
+			found = true;
+			break;
+		}
+	}
+	m0_mutex_unlock(&lru->tl_lock);
+	return found;
+}
+
+/** Stores permutation of the tile (gfid, omega) from tc in the layout cache. */
+static void tile_lru_put(struct m0_pdclust_layout *pl,
+			 const struct m0_fid *gfid, uint64_t omega,
+			 const struct tile_cache *tc)
+{
+	struct pdclust_tile_lru *lru = &pl->pl_tile_lru;
+	struct pdclust_tile     *tile = NULL;
+	uint32_t                 P = pl->pl_attr.pa_P;
+	int                      i;
+
+	m0_mutex_lock(&lru->tl_lock);
+	if (lru->tl_tile == NULL) {
+		M0_ALLOC_ARR(lru->tl_tile, M0_PDCLUST_TILE_LRU_NR);
+		for (i = 0; lru->tl_tile != NULL &&
+			     i < M0_PDCLUST_TILE_LRU_NR; ++i) {
+			M0_ALLOC_ARR(lru->tl_tile[i].pt_perm, 3 * P);
+			if (lru->tl_tile[i].pt_perm == NULL)
+				break;
+		}
+	}
+	/* Replace the least recently used tile, the cache is best effort. */
+	for (i = 0; lru->tl_tile != NULL && i < M0_PDCLUST_TILE_LRU_NR; ++i) {
+		if (lru->tl_tile[i].pt_perm != NULL &&
+		    (tile == NULL || lru->tl_tile[i].pt_stamp < tile->pt_stamp))
+			tile = &lru->tl_tile[i];
+	}
+	if (tile != NULL) {
+		tile_copy(tile->pt_perm, tc->tc_permute, P);
+		tile_copy(tile->pt_perm + P, tc->tc_inverse, P);
+		tile_copy(tile->pt_perm + 2 * P, tc->tc_lcode, P);
+		tile->pt_gfid  = *gfid;
+		tile->pt_omega = omega;
+		tile->pt_stamp = ++lru->tl_clock;
+	}
+	m0_mutex_unlock(&lru->tl_lock);
+}
+
 /** Implementation of lo_fini for pdclust layout type. */
 static void pdclust_fini(struct m0_ref *ref)
 {
@@ -199,6 +302,7 @@ static void pdclust_fini(struct m0_ref *ref)
 
 	M0_ENTRY("lid %llu", (unsigned long long)l->l_id);
 	pl = m0_layout_to_pdl(l);
+	tile_lru_fini(pl);
 	m0_pdclust_layout_bob_fini(pl);
 	m0_layout__striped_fini(&pl->pl_base);
 	m0_free(pl);
@@ -231,6 +335,7 @@ err1_injected:
 	m0_layout__striped_init(&pl->pl_base, dom, lid,
 				&m0_pdclust_layout_type, &pdclust_ops);
 	m0_pdclust_layout_bob_init(pl);
+	tile_lru_init(pl);
 	m0_mutex_lock(&pl->pl_base.sl_base.l_lock);
 
 	*out = &pl->pl_base.sl_base;
@@ -252,6 +357,7 @@ static void pdclust_delete(struct m0_layout *l)
 
 	M0_ENTRY("lid %llu", (unsigned long long)l->l_id);
 	m0_mutex_unlock(&l->l_lock);
+	tile_lru_fini(pl);
 	m0_pdclust_layout_bob_fini(pl);
 	m0_layout__striped_delete(&pl->pl_base);
 	m0_free(pl);
@@ -346,6 +452,14 @@ M0_INTERNAL bool m0_pdclust_attr_check(const struct m0_pdclust_attr *attr)
 		       " or S==K): P=%"PRIu32" N=%"PRIu32" K=%"PRIu32
 		       " S=%"PRIu32, attr->pa_P, attr->pa_N, attr->pa_K,
 		       attr->pa_S);
+	if (res && attr->pa_local_nr != 0 &&
+	    (attr->pa_local_nr >= attr->pa_K ||
+	     attr->pa_N % attr->pa_local_nr != 0)) {
+		M0_LOG(M0_ERROR, "Bad pdclust attributes (N %% L != 0 or "
+		       "L >= K): N=%"PRIu32" K=%"PRIu32" L=%"PRIu32,
+		       attr->pa_N, attr->pa_K, attr->pa_local_nr);
+		res = false;
+	}
 	return res;
 }
 
@@ -364,6 +478,11 @@ M0_INTERNAL uint32_t m0_pdclust_S(const struct m0_pdclust_layout *pl)
 	return pl->pl_attr.pa_S;
 }
 
+M0_INTERNAL uint32_t m0_pdclust_local_nr(const struct m0_pdclust_layout *pl)
+{
+	return pl->pl_attr.pa_local_nr;
+}
+
 M0_INTERNAL uint32_t m0_pdclust_P(const struct m0_pdclust_layout *pl)
 {
 	return pl->pl_attr.pa_P;
@@ -665,7 +784,12 @@ static uint64_t permute_column(struct m0_pdclust_instance *pi,
 	M0_ASSERT(t < attr.pa_P);
 	tc = &pi->pi_tile_cache;
 
-	/* If cached values are for different tile, update the cache. */
+	/*
+	 * If cached values are for different tile, update the cache, from the
+	 * layout cache if possible.
+	 */
+	if (tc->tc_tile_no != omega && tile_lru_get(pl, gfid, omega, tc))
+		tc->tc_tile_no = omega;
 	if (tc->tc_tile_no != omega) {
 		uint32_t i;
 		uint64_t rstate;
@@ -686,6 +810,7 @@ static uint64_t permute_column(struct m0_pdclust_instance *pi,
 		permute(attr.pa_P, tc->tc_lcode,
 			tc->tc_permute, tc->tc_inverse);
 		tc->tc_tile_no = omega;
+		tile_lru_put(pl, gfid, omega, tc);
 	}
 
 	/**
@@ -743,6 +868,59 @@ M0_INTERNAL void m0_pdclust_instance_map(struct m0_pdclust_instance *pi,
 	M0_LEAVE("pi %p", pi);
 }
 
+M0_INTERNAL void m0_pdclust_instance_map_range(struct m0_pdclust_instance *pi,
+				       const struct m0_pdclust_src_addr *src,
+				       uint32_t nr,
+				       struct m0_pdclust_tgt_addr *tgt)
+{
+	struct m0_pdclust_layout *pl;
+	uint32_t                  W;
+	uint32_t                  P;
+	uint32_t                  C;
+	uint32_t                  L;
+	uint32_t                  i;
+	uint64_t                  omega;
+	uint64_t                  j;
+	uint64_t                  r;
+	uint64_t                  t;
+	uint64_t                  unit;
+
+	M0_PRE(pdclust_instance_invariant(pi));
+
+	M0_ENTRY("pi %p nr %u", pi, nr);
+
+	pl = pi_to_pl(pi);
+	W = pl->pl_attr.pa_N + pl->pl_attr.pa_K + pl->pl_attr.pa_S;
+	P = pl->pl_attr.pa_P;
+	C = pl->pl_C;
+	L = pl->pl_L;
+
+	M0_PRE(src->sa_unit < W);
+	m_dec(C, src->sa_group, &omega, &j);
+	unit = src->sa_unit;
+	m_dec(P, m_enc(W, j, unit), &r, &t);
+	for (i = 0; i < nr; ++i) {
+		tgt[i].ta_obj   = permute_column(pi, omega, t);
+		tgt[i].ta_frame = m_enc(L, omega, r);
+		/* Advance (r, t) and (j, unit) in lockstep. */
+		if (++t == P) {
+			t = 0;
+			++r;
+		}
+		if (++unit == W) {
+			unit = 0;
+			if (++j == C) {
+				/* L * P == C * W: next tile starts. */
+				M0_ASSERT(r == L && t == 0);
+				j = 0;
+				r = 0;
+				++omega;
+			}
+		}
+	}
+	M0_LEAVE("pi %p", pi);
+}
+
 M0_INTERNAL void m0_pdclust_instance_inv(struct m0_pdclust_instance *pi,
 					 const struct m0_pdclust_tgt_addr *tgt,
 					 struct m0_pdclust_src_addr *src)
@@ -887,7 +1065,8 @@ err2_injected:
 			if (M0_FI_ENABLED("parity_math_err"))
 				{ rc = -EPROTO; goto err3_injected; }
 			if (K > 0 && N != 1)
-				rc = m0_parity_math_init(&pi->pi_math, N, K);
+				rc = m0_parity_math_lrc_init(&pi->pi_math, N, K,
+						m0_pdclust_local_nr(pl));
 err3_injected:
 			if (rc == 0) {
 				m0_layout__instance_init(&pi->pi_base, fid, l,
@@ -109,6 +109,13 @@ struct m0_pdclust_attr {
 	/** Number of spare units in a partiy group. */
 	uint32_t           pa_S;
 
+	/**
+	 * Number of local parity groups, 0 for none. When non-zero, first
+	 * pa_local_nr parity units of a group are XOR parities of equal local
+	 * groups of data units (M0_PARITY_CAL_ALGO_LRC).
+	 */
+	uint32_t           pa_local_nr;
+
 	/**
 	 * Number of target objects over which this layout stripes the source.
 	 */
@@ -134,6 +141,13 @@ struct m0_layout_pdclust_rec {
 };
 M0_BASSERT(M0_IS_8ALIGNED(sizeof(struct m0_layout_pdclust_rec)));
 
+enum {
+	/** Number of tile permutations cached by a pdclust layout. */
+	M0_PDCLUST_TILE_LRU_NR = 16
+};
+
+struct pdclust_tile;
+
 /**
  * Extension of the generic m0_striped_layout for the parity de-clustered
  * layout type.
@@ -159,6 +173,23 @@ struct m0_pdclust_layout {
 	 */
 	uint32_t                  pl_L;
 
+	/**
+	 * Recently used tile permutations, shared by all instances of the
+	 * layout. An instance copies a permutation from here, when its own
+	 * m0_pdclust_instance::pi_tile_cache misses.
+	 */
+	struct pdclust_tile_lru {
+		/** Protects the fields below. */
+		struct m0_mutex      tl_lock;
+		/**
+		 * Array of M0_PDCLUST_TILE_LRU_NR tiles, allocated on the
+		 * first use.
+		 */
+		struct pdclust_tile *tl_tile;
+		/** Logical time of the last access to a tile. */
+		uint64_t             tl_clock;
+	}                         pl_tile_lru;
+
 	uint64_t                  pl_magic;
 };
 
@@ -275,11 +306,16 @@ M0_INTERNAL int m0_pdclust_build(struct m0_layout_domain *dom,
 				 struct m0_layout_enum *le,
 				 struct m0_pdclust_layout **out);
 
-/** Returns true iff pa_P >= pa_N + pa_K + pa_S */
+/**
+ * Returns true iff pa_P >= pa_N + pa_K + pa_S and local parity groups, if
+ * any, split data units evenly leaving at least one global parity unit.
+ */
 M0_INTERNAL bool m0_pdclust_attr_check(const struct m0_pdclust_attr *attr);
 M0_INTERNAL uint32_t m0_pdclust_N(const struct m0_pdclust_layout *pl);
 M0_INTERNAL uint32_t m0_pdclust_K(const struct m0_pdclust_layout *pl);
 M0_INTERNAL uint32_t m0_pdclust_S(const struct m0_pdclust_layout *pl);
+/** Returns number of local parity groups of the layout. */
+M0_INTERNAL uint32_t m0_pdclust_local_nr(const struct m0_pdclust_layout *pl);
 M0_INTERNAL uint32_t m0_pdclust_P(const struct m0_pdclust_layout *pl);
 M0_INTERNAL uint32_t m0_pdclust_size(const struct m0_pdclust_layout *pl);
 M0_INTERNAL uint64_t m0_pdclust_unit_size(const struct m0_pdclust_layout *pl);
@@ -309,6 +345,18 @@ m0_layout_instance_to_pdi(const struct m0_layout_instance *li);
 M0_INTERNAL void m0_pdclust_instance_map(struct m0_pdclust_instance *pi,
 					 const struct m0_pdclust_src_addr *src,
 					 struct m0_pdclust_tgt_addr *tgt);
+/**
+ * Batched layout mapping function.
+ *
+ * Maps nr consecutive source units, starting at src (unit numbers within a
+ * group first, then group numbers) to tgt[0], ..., tgt[nr - 1]. Equivalent to
+ * nr calls to m0_pdclust_instance_map(), but decodes the source address only
+ * once.
+ */
+M0_INTERNAL void m0_pdclust_instance_map_range(struct m0_pdclust_instance *pi,
+				       const struct m0_pdclust_src_addr *src,
+				       uint32_t nr,
+				       struct m0_pdclust_tgt_addr *tgt);
 /**
  * Reverse layout mapping function.
  *
@@ -30,8 +30,11 @@
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_LAYOUT
 #include "lib/trace.h"
 
+#include <stdlib.h>             /* qsort */
+
 #include "lib/tlist.h"
 #include "lib/hash.h"
+#include "lib/arith.h"          /* M0_3WAY */
 #include "motr/client.h"
 #include "motr/client_internal.h"
 #include "motr/io.h" /* m0_op_io */
@@ -70,82 +73,86 @@ struct m0_layout_plan {
 	struct m0_op              *lp_op;
 	/** Lock for protecting concurrent plan_get() calls. */
 	struct m0_mutex            lp_lock;
+	/** Number of targets (target_ioreq-s) of the plan. */
+	uint32_t                   lp_nr;
+	/**
+	 * All plops and relations of the plan are allocated at once by
+	 * m0_layout_plan_build(): an io plop and an OUT_READ plop per target
+	 * in lp_io and lp_out, the DONE plop, and 2 relations per target.
+	 */
+	struct m0_layout_io_plop  *lp_io;
+	struct m0_layout_plop     *lp_out;
+	struct m0_layout_plop      lp_done;
+	struct m0_layout_plop_rel *lp_rels;
 };
 
-static struct m0_layout_plop *
-plop_alloc_init(struct m0_layout_plan *plan, enum m0_layout_plop_type type,
-		struct target_ioreq *ti)
+static void plop_init(struct m0_layout_plan *plan, struct m0_layout_plop *plop,
+		      enum m0_layout_plop_type type, struct target_ioreq *ti)
 {
-	struct m0_layout_plop    *plop;
-	struct m0_layout_io_plop *iopl;
-
 	M0_PRE(m0_mutex_is_locked(&plan->lp_lock));
 
-	if (M0_IN(type, (M0_LAT_READ, M0_LAT_WRITE))) {
-		M0_ALLOC_PTR(iopl);
-		plop = iopl == NULL ? NULL : &iopl->iop_base;
-	} else
-		M0_ALLOC_PTR(plop);
-	if (plop == NULL)
-		return NULL;
-
-	pplops_tlink_init_at(plop, &plan->lp_plops);
+	pplops_tlink_init_at_tail(plop, &plan->lp_plops);
 	plop->pl_ti = ti;
 	plop->pl_type = type;
 	plop->pl_plan = plan;
 	plop->pl_state = M0_LPS_INIT;
 	pldeps_tlist_init(&plop->pl_deps);
 	plrdeps_tlist_init(&plop->pl_rdeps);
-
-	return plop;
 }
 
-static int add_plops_relation(struct m0_layout_plop *rdep,
-			      struct m0_layout_plop *dep)
+static void add_plops_relation(struct m0_layout_plop_rel *plrel,
+			       struct m0_layout_plop     *rdep,
+			       struct m0_layout_plop     *dep)
 {
-	struct m0_layout_plop_rel *plrel;
-
-	M0_ALLOC_PTR(plrel);
-	if (plrel == NULL)
-		return M0_ERR(-ENOMEM);
-
 	plrel->plr_dep = dep;
 	plrel->plr_rdep = rdep;
 	pldeps_tlink_init_at_tail(plrel, &rdep->pl_deps);
 	plrdeps_tlink_init_at_tail(plrel, &dep->pl_rdeps);
-
-	return 0;
 }
 
 static void del_plop_relations(struct m0_layout_plop *plop)
 {
 	struct m0_layout_plop_rel *rel;
 
-	m0_tl_teardown(pldeps, &plop->pl_deps, rel) {
+	m0_tl_teardown(pldeps, &plop->pl_deps, rel)
 		plrdeps_tlink_del_fini(rel);
-		m0_free(rel);
-	}
-	m0_tl_teardown(plrdeps, &plop->pl_rdeps, rel) {
+	m0_tl_teardown(plrdeps, &plop->pl_rdeps, rel)
 		pldeps_tlink_del_fini(rel);
-		m0_free(rel);
-	}
 	pldeps_tlist_fini(&plop->pl_deps);
 	plrdeps_tlist_fini(&plop->pl_rdeps);
 }
 
+/**
+ * Orders targets by their rpc sessions, so that fops of a session are
+ * submitted one after another and can be formed into the same rpc packets,
+ * then by the object offset.
+ */
+static int plan_ti_cmp(const void *a, const void *b)
+{
+	const struct target_ioreq *ti0 = *(const struct target_ioreq **)a;
+	const struct target_ioreq *ti1 = *(const struct target_ioreq **)b;
+
+	return M0_3WAY((uintptr_t)ti0->ti_session,
+		       (uintptr_t)ti1->ti_session) ?:
+	       M0_3WAY(ti0->ti_goff, ti1->ti_goff);
+}
+
 M0_INTERNAL struct m0_layout_plan * m0_layout_plan_build(struct m0_op *op)
 {
 	int                         rc;
 	struct m0_layout_plan      *plan;
 	struct m0_layout_plop      *plop;
 	struct m0_layout_plop      *plop_out;
-	struct m0_layout_plop      *plop_done;
 	struct m0_layout_io_plop   *iopl;
 	struct m0_op_common        *oc;
 	struct m0_op_obj           *oo;
 	struct m0_op_io            *ioo;
 	struct m0_layout_instance  *linst;
 	struct target_ioreq        *ti;
+	struct target_ioreq       **tis = NULL;
+	uint64_t                    colour = 0;
+	uint32_t                    nr;
+	uint32_t                    i;
 
 	M0_ENTRY("op=%p", op);
 
@@ -179,44 +186,66 @@ M0_INTERNAL struct m0_layout_plan * m0_layout_plan_build(struct m0_op *op)
 		goto out;
 
 	/*
-	 * There is no concurrency at this stage yet, but we take
-	 * the lock here because of the check at plop_alloc_init().
+	 * All plops of the plan are built in one go: the number of targets is
+	 * known after distribution, so the plops and relations are allocated
+	 * with one allocation per kind rather than per plop.
 	 */
-	m0_mutex_lock(&plan->lp_lock);
-
-	/* plops are added in LIFO order, so DONE goes 1st. */
-	plop_done = plop_alloc_init(plan, M0_LAT_DONE, NULL);
-	if (plop_done == NULL) {
+	nr = tioreqht_htable_size(&ioo->ioo_nwxfer.nxr_tioreqs_hash);
+	M0_ALLOC_ARR(tis, nr);
+	M0_ALLOC_ARR(plan->lp_io, nr);
+	M0_ALLOC_ARR(plan->lp_out, nr);
+	M0_ALLOC_ARR(plan->lp_rels, 2 * nr);
+	if (nr > 0 && (tis == NULL || plan->lp_io == NULL ||
+		       plan->lp_out == NULL || plan->lp_rels == NULL)) {
 		rc = M0_ERR(-ENOMEM);
 		goto out;
 	}
-
+	i = 0;
 	m0_htable_for(tioreqht, ti, &ioo->ioo_nwxfer.nxr_tioreqs_hash) {
-		/* Add OUT_READ before READ (LIFO order).  */
-		plop_out = plop_alloc_init(plan, M0_LAT_OUT_READ, NULL);
-		rc = add_plops_relation(plop_done, plop_out);
-		if (rc != 0)
-			break;
+		tis[i++] = ti;
+	} m0_htable_endfor;
+	M0_ASSERT(i == nr);
+	qsort(tis, nr, sizeof tis[0], &plan_ti_cmp);
 
-		plop = plop_alloc_init(plan, M0_LAT_READ, ti);
-		if (plop == NULL || plop_out == NULL) {
-			rc = M0_ERR(-ENOMEM);
-			break;
-		}
+	/*
+	 * There is no concurrency at this stage yet, but we take
+	 * the lock here because of the check at plop_init().
+	 */
+	m0_mutex_lock(&plan->lp_lock);
+	plan->lp_nr = nr;
+	/*
+	 * Plops are returned in the order they are added: READ and OUT_READ
+	 * of each target, DONE goes last. Plops of the targets sharing an rpc
+	 * session get the same colour.
+	 */
+	for (i = 0; i < nr; ++i) {
+		ti = tis[i];
+		if (i > 0 && ti->ti_session != tis[i - 1]->ti_session)
+			colour++;
+		iopl = &plan->lp_io[i];
+		plop = &iopl->iop_base;
+		plop_init(plan, plop, M0_LAT_READ, ti);
 		plop->pl_ent = ti->ti_fid;
-		iopl = container_of(plop, struct m0_layout_io_plop, iop_base);
+		plop->pl_colour = colour;
 		iopl->iop_ext  = ti->ti_ivec;
 		iopl->iop_data = ti->ti_bufvec;
 		iopl->iop_session = ti->ti_session;
 		iopl->iop_goff = ti->ti_goff;
-		rc = add_plops_relation(plop_out, plop);
-		if (rc != 0)
-			break;
-	} m0_htable_endfor;
+
+		plop_out = &plan->lp_out[i];
+		plop_init(plan, plop_out, M0_LAT_OUT_READ, NULL);
+		plop_out->pl_colour = colour;
+		add_plops_relation(&plan->lp_rels[2 * i], plop_out, plop);
+	}
+	plop_init(plan, &plan->lp_done, M0_LAT_DONE, NULL);
+	for (i = 0; i < nr; ++i)
+		add_plops_relation(&plan->lp_rels[2 * i + 1], &plan->lp_done,
+				   &plan->lp_out[i]);
 
 	m0_mutex_unlock(&plan->lp_lock);
 
  out:
+	m0_free(tis);
 	if (rc != 0) {
 		m0_layout_plan_fini(plan);
 		plan = NULL;
@@ -263,9 +292,11 @@ M0_INTERNAL void m0_layout_plan_fini(struct m0_layout_plan *plan)
 		/* For each plan_get(), plop_done() must be called. */
 		M0_ASSERT(M0_IN(plop->pl_state, (M0_LPS_INIT, M0_LPS_DONE)));
 		del_plop_relations(plop);
-		m0_free(plop);
 	}
 	pplops_tlist_fini(&plan->lp_plops);
+	m0_free(plan->lp_rels);
+	m0_free(plan->lp_out);
+	m0_free(plan->lp_io);
 
 	m0_mutex_unlock(&plan->lp_lock);
 	m0_mutex_fini(&plan->lp_lock);
@@ -296,6 +327,34 @@ M0_INTERNAL int m0_layout_plan_get(struct m0_layout_plan *plan, uint64_t colour,
 	return M0_RC(0);
 }
 
+M0_INTERNAL int m0_layout_plan_get_nr(struct m0_layout_plan  *plan,
+				      uint64_t                colour,
+				      struct m0_layout_plop **out,
+				      uint32_t                nr,
+				      uint32_t               *got)
+{
+	struct m0_layout_plop *plop;
+
+	M0_PRE(plan != NULL);
+	M0_PRE(out != NULL);
+	M0_PRE(got != NULL);
+	M0_PRE(plan->lp_op != NULL);
+
+	m0_mutex_lock(&plan->lp_lock);
+	plop = plan->lp_last_plop;
+	for (*got = 0; *got < nr; ++*got) {
+		plop = plop == NULL ? pplops_tlist_head(&plan->lp_plops) :
+				      pplops_tlist_next(&plan->lp_plops, plop);
+		if (plop == NULL)
+			break;
+		out[*got] = plop;
+		plan->lp_last_plop = plop;
+	}
+	m0_mutex_unlock(&plan->lp_lock);
+
+	return M0_RC(*got == 0 ? 1 : 0);
+}
+
 M0_INTERNAL int m0_layout_plop_start(struct m0_layout_plop *plop)
 {
 	M0_PRE(plop->pl_state == M0_LPS_INIT);
@@ -555,6 +555,20 @@ enum {
 M0_INTERNAL int m0_layout_plan_get(struct m0_layout_plan *plan, uint64_t colour,
 				   struct m0_layout_plop **out);
 
+/**
+ * Returns up to nr next plops in out[] with a single call, in the order
+ * m0_layout_plan_get() would return them. Plops of the targets sharing an
+ * rpc session follow each other.
+ *
+ * The number of returned plops is stored in *got. If there are no plops to
+ * return, +1 is returned.
+ */
+M0_INTERNAL int m0_layout_plan_get_nr(struct m0_layout_plan  *plan,
+				      uint64_t                colour,
+				      struct m0_layout_plop **out,
+				      uint32_t                nr,
+				      uint32_t               *got);
+
 /**
  * Instructs the implementation that the user starts processing of the plop.
  *
@@ -2494,8 +2494,11 @@ static void ldemo(struct m0_pdclust_instance *pi,
 	struct m0_pdclust_tgt_addr tgt;
 	struct m0_pdclust_src_addr src1;
 	struct m0_pdclust_attr     attr = pl->pl_attr;
+	struct m0_pdclust_tgt_addr range[3 * 20];
 	uint32_t                   W;
 	uint32_t                   unit;
+	uint32_t                   nr;
+	uint32_t                   i;
 
 	W = attr.pa_N + attr.pa_K + attr.pa_S;
 	src.sa_group = 0;
@@ -2505,6 +2508,26 @@ static void ldemo(struct m0_pdclust_instance *pi,
 		m0_pdclust_instance_inv(pi, &tgt, &src1);
 		M0_ASSERT(memcmp(&src, &src1, sizeof src) == 0);
 	}
+
+	/*
+	 * Map units of 3 tiles in one call, compare with unit by unit mapping,
+	 * which also goes back to tiles cached by the layout.
+	 */
+	nr = min32u(3 * pl->pl_C * W, ARRAY_SIZE(range));
+	src.sa_group = pl->pl_C - 1;
+	src.sa_unit  = W - 1;
+	m0_pdclust_instance_map_range(pi, &src, nr, range);
+	for (i = 0; i < nr; ++i) {
+		m0_pdclust_instance_map(pi, &src, &tgt);
+		M0_UT_ASSERT(tgt.ta_obj == range[i].ta_obj &&
+			     tgt.ta_frame == range[i].ta_frame);
+		m0_pdclust_instance_inv(pi, &range[i], &src1);
+		M0_UT_ASSERT(memcmp(&src, &src1, sizeof src) == 0);
+		if (++src.sa_unit == W) {
+			src.sa_unit = 0;
+			++src.sa_group;
+		}
+	}
 }
 
 /* Tests the APIs supported for m0_pdclust_instance object. */
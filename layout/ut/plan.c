@@ -303,6 +303,84 @@ static void test_plan_get_done(void)
 	M0_LEAVE();
 }
 
+static void test_plan_get_nr(void)
+{
+	int                         rc;
+	int                         i;
+	uint32_t                    got;
+	struct m0_client           *cinst = client_inst;
+	struct m0_pool_version     *pv;
+	struct m0_layout_plan      *plan;
+	struct m0_layout_plop      *plops[8];
+	struct m0_layout_io_plop   *iopl;
+	struct m0_op               *op = NULL;
+	struct m0_indexvec          ext;
+	struct m0_bufvec            data;
+	struct m0_bufvec            attr;
+	struct m0_realm             realm;
+	struct m0_obj               obj = {};
+
+	M0_ENTRY();
+
+	M0_UT_ASSERT(m0_indexvec_alloc(&ext, 2) == 0);
+	ext.iv_vec.v_count[0] = UT_DEFAULT_BLOCK_SIZE;
+	ext.iv_vec.v_count[1] = UT_DEFAULT_BLOCK_SIZE;
+	ext.iv_index[0] = 0;
+	ext.iv_index[1] = UT_DEFAULT_BLOCK_SIZE;
+	M0_UT_ASSERT(m0_bufvec_alloc(&data, 2, UT_DEFAULT_BLOCK_SIZE) == 0);
+	M0_UT_ASSERT(m0_bufvec_alloc(&attr, 2, 1) == 0);
+
+	rc = m0_pool_version_get(&cinst->m0c_pools_common, NULL, &pv);
+	M0_UT_ASSERT(rc == 0);
+	ut_realm_entity_setup(&realm, &obj.ob_entity, cinst);
+	obj.ob_attr.oa_bshift = M0_MIN_BUF_SHIFT;
+	obj.ob_attr.oa_pver   = pv->pv_id;
+	obj.ob_attr.oa_layout_id = M0_DEFAULT_LAYOUT_ID;
+
+	rc = m0_obj_op(&obj, M0_OC_READ, &ext, &data, &attr, 0, 0, &op);
+	M0_UT_ASSERT(rc == 0);
+
+	plan = m0_layout_plan_build(op);
+	M0_UT_ASSERT(plan != NULL);
+
+	/* All plops of both units are returned at once. */
+	rc = m0_layout_plan_get_nr(plan, 0, plops, ARRAY_SIZE(plops), &got);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(got == 5);
+	for (i = 0; i < 4; i += 2) {
+		M0_UT_ASSERT(plops[i]->pl_type == M0_LAT_READ);
+		M0_UT_ASSERT(plops[i + 1]->pl_type == M0_LAT_OUT_READ);
+		iopl = container_of(plops[i], struct m0_layout_io_plop,
+				    iop_base);
+		M0_UT_ASSERT(iopl->iop_goff == i / 2 * UT_DEFAULT_BLOCK_SIZE);
+		/* Targets of the same session have the same colour. */
+		M0_UT_ASSERT(plops[i]->pl_colour == plops[0]->pl_colour);
+	}
+	M0_UT_ASSERT(plops[4]->pl_type == M0_LAT_DONE);
+	for (i = 0; i < got; i++) {
+		m0_layout_plop_start(plops[i]);
+		plops[i]->pl_rc = 0;
+		m0_layout_plop_done(plops[i]);
+	}
+
+	rc = m0_layout_plan_get_nr(plan, 0, plops, ARRAY_SIZE(plops), &got);
+	M0_UT_ASSERT(rc == 1);
+	M0_UT_ASSERT(got == 0);
+
+	m0_layout_plan_fini(plan);
+
+	m0_op_fini(op);
+	m0_op_free(op);
+
+	m0_entity_fini(&obj.ob_entity);
+
+	m0_bufvec_free(&attr);
+	m0_bufvec_free(&data);
+	m0_indexvec_free(&ext);
+
+	M0_LEAVE();
+}
+
 /*
  * Note: In test_init() and test_fini(), need to use M0_ASSERT()
  * instead of M0_UT_ASSERT().
@@ -336,6 +414,7 @@ struct m0_ut_suite layout_access_plan_ut = {
 	.ts_tests = {
 		{ "layout-access-plan-build-fini", test_plan_build_fini },
 		{ "layout-access-plan-get-done", test_plan_get_done },
+		{ "layout-access-plan-get-nr", test_plan_get_nr },
 		{ NULL, NULL }
 	}
 };
@@ -21,11 +21,257 @@
 
 
 #include "lib/memory.h"               /* m0_alloc, m0_free */
+#include "lib/arith.h"                /* max3 */
+#include "lib/string.h"               /* memcpy, snprintf */
 #include "lib/cksum.h"
 
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_LIB
 #include "lib/trace.h"
 
+#ifndef __KERNEL__
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#endif
+#endif /* __KERNEL__ */
+
+enum {
+	/* Reflected CRC32C (Castagnoli) polynomial */
+	CRC32C_POLY = 0x82f63b78,
+	/* Number of bytes processed at once by crc32c_sw() */
+	CRC32C_SLICE_NR = 8
+};
+
+static uint32_t crc32c_table[CRC32C_SLICE_NR][256];
+
+/*
+ * crc32c_table[k][b] is the register after byte b followed by k zero bytes,
+ * which allows to process 8 bytes with 8 independent lookups.
+ */
+static void crc32c_mktable(void)
+{
+	uint32_t crc;
+	int      i;
+	int      j;
+
+	for (i = 0; i < 256; i++) {
+		crc = i;
+		for (j = 0; j < 8; j++)
+			crc = (crc >> 1) ^ (CRC32C_POLY & -(crc & 1));
+		crc32c_table[0][i] = crc;
+	}
+	for (i = 0; i < 256; i++) {
+		crc = crc32c_table[0][i];
+		for (j = 1; j < CRC32C_SLICE_NR; j++) {
+			crc = (crc >> 8) ^ crc32c_table[0][crc & 0xff];
+			crc32c_table[j][i] = crc;
+		}
+	}
+}
+
+static uint32_t crc32c_sw(uint32_t crc, const uint8_t *p, m0_bcount_t len)
+{
+	uint64_t w;
+
+	for (; len >= CRC32C_SLICE_NR; len -= CRC32C_SLICE_NR,
+					p += CRC32C_SLICE_NR) {
+		/* Little endian load, independent of the host byte order. */
+		w = crc ^ ((uint64_t)p[0]       | (uint64_t)p[1] << 8  |
+			   (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24 |
+			   (uint64_t)p[4] << 32 | (uint64_t)p[5] << 40 |
+			   (uint64_t)p[6] << 48 | (uint64_t)p[7] << 56);
+		crc = crc32c_table[7][w & 0xff] ^
+		      crc32c_table[6][(w >> 8) & 0xff] ^
+		      crc32c_table[5][(w >> 16) & 0xff] ^
+		      crc32c_table[4][(w >> 24) & 0xff] ^
+		      crc32c_table[3][(w >> 32) & 0xff] ^
+		      crc32c_table[2][(w >> 40) & 0xff] ^
+		      crc32c_table[1][(w >> 48) & 0xff] ^
+		      crc32c_table[0][w >> 56];
+	}
+	while (len-- > 0)
+		crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *p++) & 0xff];
+	return crc;
+}
+
+#if !defined(__KERNEL__) && defined(__x86_64__)
+
+static bool crc32c_hw_supported(void)
+{
+	return __builtin_cpu_supports("sse4.2");
+}
+
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hw(uint32_t crc, const uint8_t *p, m0_bcount_t len)
+{
+	uint64_t c = crc;
+	uint64_t w;
+
+	for (; len > 0 && ((uint64_t)p & 7) != 0; --len)
+		c = _mm_crc32_u8(c, *p++);
+	for (; len >= 8; len -= 8, p += 8) {
+		memcpy(&w, p, sizeof w);
+		c = _mm_crc32_u64(c, w);
+	}
+	for (; len > 0; --len)
+		c = _mm_crc32_u8(c, *p++);
+	return c;
+}
+
+#elif !defined(__KERNEL__) && defined(__aarch64__)
+
+static bool crc32c_hw_supported(void)
+{
+	return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+}
+
+__attribute__((target("+crc")))
+static uint32_t crc32c_hw(uint32_t crc, const uint8_t *p, m0_bcount_t len)
+{
+	uint64_t w;
+
+	for (; len > 0 && ((uint64_t)p & 7) != 0; --len)
+		crc = __crc32cb(crc, *p++);
+	for (; len >= 8; len -= 8, p += 8) {
+		memcpy(&w, p, sizeof w);
+		crc = __crc32cd(crc, w);
+	}
+	for (; len > 0; --len)
+		crc = __crc32cb(crc, *p++);
+	return crc;
+}
+
+#else
+
+static bool crc32c_hw_supported(void)
+{
+	return false;
+}
+
+static uint32_t crc32c_hw(uint32_t crc, const uint8_t *p, m0_bcount_t len)
+{
+	return crc32c_sw(crc, p, len);
+}
+
+#endif
+
+/*
+ * Selected lazily on the first use. Concurrent first users select the same
+ * implementation and build the same table, so the race is harmless.
+ */
+static uint32_t (*crc32c_fn)(uint32_t crc, const uint8_t *p,
+			     m0_bcount_t len);
+
+M0_INTERNAL uint32_t m0_crc32c(uint32_t crc, const void *data,
+			       m0_bcount_t len)
+{
+	if (crc32c_fn == NULL) {
+		if (crc32c_hw_supported()) {
+			crc32c_fn = &crc32c_hw;
+		} else {
+			crc32c_mktable();
+			crc32c_fn = &crc32c_sw;
+		}
+	}
+	return crc32c_fn(crc, data, len);
+}
+
+/*
+ * Product of a and b modulo the CRC32C polynomial. Polynomials are reflected
+ * as the CRC register: x^0 is the most significant bit.
+ */
+static uint32_t crc32c_multmodp(uint32_t a, uint32_t b)
+{
+	uint32_t m = 1U << 31;
+	uint32_t p = 0;
+
+	for (; a != 0; a &= ~m, m >>= 1) {
+		if (a & m)
+			p ^= b;
+		b = (b >> 1) ^ (CRC32C_POLY & -(b & 1));
+	}
+	return p;
+}
+
+M0_INTERNAL uint32_t m0_crc32c_combine(uint32_t crc1, uint32_t crc2,
+				       m0_bcount_t len2)
+{
+	uint32_t xn = 1U << 31;     /* x^0 */
+	uint32_t sq = 1U << 23;     /* x^8, a byte shift */
+
+	/* crc1 is shifted over len2 bytes: multiplied by x^(8 * len2). */
+	for (; len2 != 0; len2 >>= 1) {
+		if (len2 & 1)
+			xn = crc32c_multmodp(sq, xn);
+		sq = crc32c_multmodp(sq, sq);
+	}
+	return crc32c_multmodp(xn, crc1) ^ crc2;
+}
+
+/*
+ * Seed is hashed as the string of 3 hex numbers in 64 bytes, independent of
+ * the host byte order. Range for uint64_t is 0 to 18,446,744,073,709,551,615,
+ * at max 20 chars per var, for three var it will be 3*20, +1 '\0'. seed_str
+ * needs to be 61 bytes, round off and taking 64 bytes.
+ */
+enum { PI_SEED_STR_LEN = 64 };
+
+static void pi_seed_str(const struct m0_pi_seed *seed, char *seed_str)
+{
+	memset(seed_str, 0, PI_SEED_STR_LEN);
+	snprintf(seed_str, PI_SEED_STR_LEN, "%" PRIx64 "%" PRIx64 "%"PRIx64,
+		 seed->pis_obj_id.f_container, seed->pis_obj_id.f_key,
+		 seed->pis_data_unit_offset);
+}
+
+M0_INTERNAL int m0_calculate_crc32c(struct m0_crc32c_pi *pi,
+				    struct m0_pi_seed *seed,
+				    struct m0_bufvec *bvec,
+				    enum m0_pi_calc_flag flag,
+				    unsigned char *curr_context,
+				    unsigned char *pi_value_without_seed)
+{
+	char     seed_str[PI_SEED_STR_LEN];
+	uint32_t crc;
+	uint32_t i;
+
+	M0_ENTRY();
+
+	M0_PRE(pi != NULL);
+	M0_PRE(curr_context != NULL);
+	M0_PRE(ergo(bvec != NULL && bvec->ov_vec.v_nr != 0,
+		    bvec->ov_vec.v_count != NULL && bvec->ov_buf != NULL));
+
+	if (flag & M0_PI_CALC_UNIT_ZERO) {
+		pi->picrc_hdr.pih_size = sizeof(struct m0_crc32c_pi);
+		crc = ~(uint32_t)0;
+		memcpy(pi->picrc_prev_context, &crc, sizeof crc);
+	}
+	memcpy(&crc, pi->picrc_prev_context, sizeof crc);
+	if (bvec != NULL) {
+		for (i = 0; i < bvec->ov_vec.v_nr; i++)
+			crc = m0_crc32c(crc, bvec->ov_buf[i],
+					bvec->ov_vec.v_count[i]);
+	}
+	/* curr_context always has the unseeded register. */
+	memcpy(curr_context, &crc, sizeof crc);
+	if (pi_value_without_seed != NULL) {
+		i = ~crc;
+		memcpy(pi_value_without_seed, &i, sizeof i);
+	}
+	if (seed != NULL) {
+		pi_seed_str(seed, seed_str);
+		crc = m0_crc32c(crc, seed_str, sizeof seed_str);
+	}
+	if (!(flag & M0_PI_SKIP_CALC_FINAL)) {
+		crc = ~crc;
+		memcpy(pi->picrc_value, &crc, sizeof crc);
+	}
+	return M0_RC(0);
+}
+
 
 M0_INTERNAL int m0_calculate_md5_inc_context(
 		struct m0_md5_inc_context_pi *pi,
@@ -108,16 +354,9 @@ M0_INTERNAL int m0_calculate_md5_inc_context(
 
 	if (seed != NULL) {
 
-		/*
-		 * seed_str have string represention for 3 uint64_t(8 bytes)
-		 * range for uint64_t is 0 to 18,446,744,073,709,551,615 at
-		 * max 20 chars per var, for three var it will be 3*20, +1 '\0'.
-		 * seed_str needs to be 61 bytes, round off and taking 64 bytes.
-		 */
-		char seed_str[64] = {'\0'};
-		snprintf(seed_str, sizeof(seed_str), "%" PRIx64 "%" PRIx64 "%"PRIx64,
-				seed->pis_obj_id.f_container, seed->pis_obj_id.f_key,
-				seed->pis_data_unit_offset);
+		char seed_str[PI_SEED_STR_LEN];
+
+		pi_seed_str(seed, seed_str);
 		rc = MD5_Update(&context, (unsigned char *)seed_str,
 				sizeof(seed_str));
 		if (rc != 1) {
@@ -154,6 +393,8 @@ M0_INTERNAL uint64_t m0_calculate_cksum_size(struct m0_generic_pi *pi)
 	case M0_PI_TYPE_MD5:
 		return sizeof(struct m0_md5_pi);
 		break;
+	case M0_PI_TYPE_CRC:
+		return sizeof(struct m0_crc32c_pi);
 	}
 #endif
 	return 0;
@@ -161,8 +402,9 @@ M0_INTERNAL uint64_t m0_calculate_cksum_size(struct m0_generic_pi *pi)
 
 M0_INTERNAL uint64_t max_cksum_size(void)
 {
-	return (sizeof(struct m0_md5_pi) > sizeof(struct m0_md5_inc_context_pi) ?
-			sizeof(struct m0_md5_pi) : sizeof(struct m0_md5_inc_context_pi));
+	return max3(sizeof(struct m0_md5_pi),
+		    sizeof(struct m0_md5_inc_context_pi),
+		    sizeof(struct m0_crc32c_pi));
 }
 
 int m0_client_calculate_pi(struct m0_generic_pi *pi,
@@ -184,6 +426,11 @@ int m0_client_calculate_pi(struct m0_generic_pi *pi,
 						  pi_value_without_seed);
 		}
 		break;
+	case M0_PI_TYPE_CRC:
+		rc = m0_calculate_crc32c((struct m0_crc32c_pi *)pi, seed, bvec,
+					 flag, curr_context,
+					 pi_value_without_seed);
+		break;
 	}
 #endif
 	return M0_RC(rc);
@@ -229,6 +476,29 @@ bool m0_calc_verify_cksum_one_unit(struct m0_generic_pi *pi,
 		}
 		break;
 	}
+	case M0_PI_TYPE_CRC:
+	{
+		struct m0_crc32c_pi crc_pi = {};
+		unsigned char       curr_context[sizeof(uint32_t)];
+
+		memcpy(crc_pi.picrc_prev_context,
+		       ((struct m0_crc32c_pi *)pi)->picrc_prev_context,
+		       sizeof crc_pi.picrc_prev_context);
+		crc_pi.picrc_hdr.pih_type = M0_PI_TYPE_CRC;
+		m0_calculate_crc32c(&crc_pi, seed, bvec, M0_PI_NO_FLAG,
+				    curr_context, NULL);
+		if (memcmp(((struct m0_crc32c_pi *)pi)->picrc_value,
+			   crc_pi.picrc_value,
+			   sizeof crc_pi.picrc_value) == 0)
+			return true;
+		M0_LOG(M0_ERROR, "checksum fail "
+		       "f_container 0x%" PRIx64 " f_key 0x%"PRIx64
+		       " data_unit_offset 0x%"PRIx64,
+		       seed->pis_obj_id.f_container,
+		       seed->pis_obj_id.f_key,
+		       seed->pis_data_unit_offset);
+		return false;
+	}
 	default:
 		M0_IMPOSSIBLE("pi_type = %d", pi->pi_hdr.pih_type);
 	}
@@ -45,6 +45,16 @@ static const struct m0_bob_type htable_bobtype = {
 	.bt_check        = NULL,
 };
 
+enum {
+	/** Position of the level in m0_htable::h_state. */
+	HT_LEVEL_SHIFT   = 56,
+	HT_SPLIT_MASK    = (1ULL << HT_LEVEL_SHIFT) - 1,
+	/** Maximal number of objects walked by a fast lookup. */
+	HT_FAST_WALK_MAX = 256,
+	/** Number of fast lookup attempts before taking the bucket lock. */
+	HT_FAST_TRY_NR   = 3,
+};
+
 static bool htable_invariant(const struct m0_htable *htable);
 
 static void hbucket_init(const struct m0_ht_descr *d,
@@ -55,6 +65,7 @@ static void hbucket_init(const struct m0_ht_descr *d,
 
 	m0_tlist_init(d->hd_tldescr, &bucket->hb_objects);
 	m0_mutex_init(&bucket->hb_mutex);
+	m0_atomic64_set(&bucket->hb_seq, 0);
 }
 
 static void hbucket_fini(const struct m0_ht_descr *d,
@@ -72,32 +83,132 @@ static void *obj_key(const struct m0_ht_descr *hd, void *obj)
 	return obj + hd->hd_key_offset;
 }
 
+static bool htable_is_resizable(const struct m0_htable *htable)
+{
+	return htable->h_segs != NULL;
+}
+
+static uint64_t state_level(int64_t state)
+{
+	return (uint64_t)state >> HT_LEVEL_SHIFT;
+}
+
+static uint64_t state_split(int64_t state)
+{
+	return state & HT_SPLIT_MASK;
+}
+
+/** Calls the hash function as for a table of bucket_nr buckets. */
+static uint64_t htable_hash(const struct m0_htable *htable,
+			    uint64_t                bucket_nr,
+			    const void             *key)
+{
+	struct m0_htable shadow = {
+		.h_magic     = htable->h_magic,
+		.h_bucket_nr = bucket_nr,
+		.h_buckets   = htable->h_buckets,
+		.h_descr     = htable->h_descr
+	};
+
+	return htable->h_descr->hd_hash_func(&shadow, key);
+}
+
+/** Returns the id of the bucket of the key in the given table state. */
+static uint64_t htable_bucket_id(const struct m0_htable *htable,
+				 int64_t                 state,
+				 const void             *key)
+{
+	uint64_t nr;
+	uint64_t id;
+
+	if (!htable_is_resizable(htable))
+		return htable->h_descr->hd_hash_func(htable, key);
+	nr = htable->h_bucket_nr0 << state_level(state);
+	id = htable_hash(htable, nr, key);
+	return id < state_split(state) ? htable_hash(htable, nr << 1, key) : id;
+}
+
+static struct m0_hbucket *key_bucket(const struct m0_htable *htable,
+				     const void             *key)
+{
+	int64_t state = m0_atomic64_get(&htable->h_state);
+
+	/* Pairs with the barrier in htable_split(). */
+	m0_mb();
+	return m0_htable_bucket(htable, htable_bucket_id(htable, state, key));
+}
+
+static unsigned bucket_seg(const struct m0_htable *htable, uint64_t id)
+{
+	return id < htable->h_bucket_nr0 ? 0 :
+		m0_log2(id / htable->h_bucket_nr0) + 1;
+}
+
+M0_INTERNAL struct m0_hbucket *m0_htable_bucket(const struct m0_htable *htable,
+						uint64_t                id)
+{
+	unsigned seg;
+
+	if (!htable_is_resizable(htable) || id < htable->h_bucket_nr0)
+		return &htable->h_buckets[id];
+	seg = bucket_seg(htable, id);
+	return &htable->h_segs[seg][id - (htable->h_bucket_nr0 << (seg - 1))];
+}
+
+/**
+ * Marks the beginning and the end of a change of the bucket list, for
+ * m0_htable_cc_lookup_fast().
+ */
+static void hbucket_write_begin(const struct m0_htable *htable,
+				struct m0_hbucket      *bucket)
+{
+	if (htable_is_resizable(htable)) {
+		m0_atomic64_inc(&bucket->hb_seq);
+		m0_mb();
+	}
+}
+
+static void hbucket_write_end(const struct m0_htable *htable,
+			      struct m0_hbucket      *bucket)
+{
+	if (htable_is_resizable(htable)) {
+		m0_mb();
+		m0_atomic64_inc(&bucket->hb_seq);
+	}
+}
+
 static bool hbucket_invariant(const struct m0_ht_descr *desc,
 			      const struct m0_hbucket  *bucket,
-			      const struct m0_htable   *htable)
+			      const struct m0_htable   *htable,
+			      uint64_t                  index)
 {
-	uint64_t  index;
-	void     *amb;
-
-	index = bucket - htable->h_buckets;
+	int64_t  state = m0_atomic64_get(&htable->h_state);
+	void    *amb;
 
 	return
 		bucket != NULL &&
 		desc != NULL &&
 		m0_hbucket_forall_ol(desc->hd_tldescr, amb, bucket,
-				     index == desc->hd_hash_func(htable,
+				     index == htable_bucket_id(htable, state,
 				     obj_key(desc, amb)));
 }
 
 static bool htable_invariant(const struct m0_htable *htable)
 {
+	int64_t state = m0_atomic64_get(&htable->h_state);
+
 	return
 		m0_htable_bob_check(htable) &&
 		htable->h_bucket_nr >  0 &&
 		htable->h_buckets   != NULL &&
+		ergo(htable_is_resizable(htable),
+		     htable->h_bucket_nr ==
+		     (htable->h_bucket_nr0 << state_level(state)) +
+		     state_split(state)) &&
 		m0_forall(i, htable->h_bucket_nr,
 			  hbucket_invariant(htable->h_descr,
-					    &htable->h_buckets[i], htable));
+					    m0_htable_bucket(htable, i),
+					    htable, i));
 }
 
 M0_INTERNAL int m0_htable_init(const struct m0_ht_descr *d,
@@ -114,6 +225,9 @@ M0_INTERNAL int m0_htable_init(const struct m0_ht_descr *d,
 
 	htable->h_descr     = d;
 	htable->h_bucket_nr = bucket_nr;
+	htable->h_segs      = NULL;
+	m0_atomic64_set(&htable->h_state, 0);
+	m0_atomic64_set(&htable->h_nr, 0);
 	M0_ALLOC_ARR(htable->h_buckets, htable->h_bucket_nr);
 	if (htable->h_buckets == NULL)
 		return M0_ERR(-ENOMEM);
@@ -124,25 +238,174 @@ M0_INTERNAL int m0_htable_init(const struct m0_ht_descr *d,
 	return 0;
 }
 
+M0_INTERNAL int m0_htable_init_resizable(const struct m0_ht_descr *d,
+					 struct m0_htable         *htable,
+					 uint64_t                  bucket_nr)
+{
+	int rc;
+
+	rc = m0_htable_init(d, htable, bucket_nr);
+	if (rc != 0)
+		return M0_RC(rc);
+	M0_ALLOC_ARR(htable->h_segs, M0_HTABLE_SEG_NR);
+	if (htable->h_segs == NULL) {
+		m0_htable_fini(htable);
+		return M0_ERR(-ENOMEM);
+	}
+	htable->h_segs[0]    = htable->h_buckets;
+	htable->h_bucket_nr0 = bucket_nr;
+	m0_mutex_init(&htable->h_split_lock);
+	M0_POST_EX(htable_invariant(htable));
+	return 0;
+}
+
 M0_INTERNAL bool m0_htable_is_init(const struct m0_htable *htable)
 {
 	return htable_invariant(htable);
 }
 
+static int htable_seg_alloc(struct m0_htable *htable, unsigned seg)
+{
+	struct m0_hbucket *buckets;
+	uint64_t           nr = htable->h_bucket_nr0 << (seg - 1);
+	uint64_t           i;
+
+	M0_ALLOC_ARR(buckets, nr);
+	if (buckets == NULL)
+		return M0_ERR(-ENOMEM);
+	for (i = 0; i < nr; ++i)
+		hbucket_init(htable->h_descr, &buckets[i]);
+	/* Buckets are initialised before they are seen by lookups. */
+	m0_mb();
+	htable->h_segs[seg] = buckets;
+	return 0;
+}
+
+static bool htable_is_loaded(const struct m0_htable *htable)
+{
+	return htable_is_resizable(htable) &&
+		m0_atomic64_get(&htable->h_nr) >
+		htable->h_bucket_nr * M0_HTABLE_LOAD;
+}
+
+/**
+ * Splits the bucket at the split pointer, moving the objects which belong to
+ * the new bucket of the next level there.
+ *
+ * The caller holds m0_htable::h_split_lock or has exclusive access to the
+ * table. In the former case (locked == true) buckets are locked.
+ */
+static void htable_split(struct m0_htable *htable, bool locked)
+{
+	const struct m0_ht_descr *hd    = htable->h_descr;
+	int64_t                   state = m0_atomic64_get(&htable->h_state);
+	uint64_t                  level = state_level(state);
+	uint64_t                  split = state_split(state);
+	uint64_t                  nr    = htable->h_bucket_nr0 << level;
+	uint64_t                  id    = nr + split;
+	unsigned                  seg   = bucket_seg(htable, id);
+	struct m0_hbucket        *src;
+	struct m0_hbucket        *dst;
+	void                     *obj;
+
+	/* The table is left as is when it cannot grow further. */
+	if (seg >= M0_HTABLE_SEG_NR ||
+	    (htable->h_segs[seg] == NULL && htable_seg_alloc(htable, seg) != 0))
+		return;
+	src = m0_htable_bucket(htable, split);
+	dst = m0_htable_bucket(htable, id);
+	if (locked) {
+		m0_mutex_lock(&src->hb_mutex);
+		m0_mutex_lock(&dst->hb_mutex);
+	}
+	hbucket_write_begin(htable, src);
+	hbucket_write_begin(htable, dst);
+	m0_tlist_for(hd->hd_tldescr, &src->hb_objects, obj) {
+		if (htable_hash(htable, nr << 1, obj_key(hd, obj)) != split)
+			m0_tlist_move(hd->hd_tldescr, &dst->hb_objects, obj);
+	} m0_tlist_endfor;
+	m0_mb();
+	m0_atomic64_set(&htable->h_state, split + 1 == nr ?
+			(int64_t)((level + 1) << HT_LEVEL_SHIFT) : state + 1);
+	htable->h_bucket_nr = id + 1;
+	hbucket_write_end(htable, dst);
+	hbucket_write_end(htable, src);
+	if (locked) {
+		m0_mutex_unlock(&dst->hb_mutex);
+		m0_mutex_unlock(&src->hb_mutex);
+	}
+}
+
+static void hbucket_add(struct m0_htable  *htable,
+			struct m0_hbucket *bucket,
+			void              *amb)
+{
+	hbucket_write_begin(htable, bucket);
+	m0_tlist_add(htable->h_descr->hd_tldescr, &bucket->hb_objects, amb);
+	hbucket_write_end(htable, bucket);
+	if (htable_is_resizable(htable))
+		m0_atomic64_inc(&htable->h_nr);
+}
+
+static void hbucket_del(struct m0_htable  *htable,
+			struct m0_hbucket *bucket,
+			void              *amb)
+{
+	hbucket_write_begin(htable, bucket);
+	m0_tlist_del(htable->h_descr->hd_tldescr, amb);
+	hbucket_write_end(htable, bucket);
+	if (htable_is_resizable(htable))
+		m0_atomic64_dec(&htable->h_nr);
+}
+
+static void *hbucket_lookup(const struct m0_htable  *htable,
+			    const struct m0_hbucket *bucket,
+			    const void              *key)
+{
+	void *scan;
+
+	m0_tlist_for(htable->h_descr->hd_tldescr, &bucket->hb_objects, scan) {
+		if (htable->h_descr->hd_key_eq(obj_key(htable->h_descr, scan),
+					       key))
+			break;
+	} m0_tlist_endfor;
+
+	return scan;
+}
+
+/**
+ * Locks the bucket of the key. Retries if the bucket was split while being
+ * locked.
+ */
+static struct m0_hbucket *hbucket_lock(struct m0_htable *htable,
+				       const void       *key)
+{
+	struct m0_hbucket *bucket;
+	int64_t            state;
+
+	while (1) {
+		state = m0_atomic64_get(&htable->h_state);
+		m0_mb();
+		bucket = m0_htable_bucket(htable,
+				htable_bucket_id(htable, state, key));
+		m0_mutex_lock(&bucket->hb_mutex);
+		if (m0_atomic64_get(&htable->h_state) == state)
+			return bucket;
+		m0_mutex_unlock(&bucket->hb_mutex);
+	}
+}
+
 M0_INTERNAL void m0_htable_add(struct m0_htable *htable,
 			       void             *amb)
 {
-	uint64_t bucket_id;
-
 	M0_PRE_EX(htable_invariant(htable));
 	M0_PRE(amb != NULL);
 	M0_PRE(!m0_tlink_is_in(htable->h_descr->hd_tldescr, amb));
 
-	bucket_id = htable->h_descr->hd_hash_func(htable,
-			obj_key(htable->h_descr, amb));
-
-	m0_tlist_add(htable->h_descr->hd_tldescr,
-		     &htable->h_buckets[bucket_id].hb_objects, amb);
+	hbucket_add(htable, key_bucket(htable, obj_key(htable->h_descr, amb)),
+		    amb);
+	if (htable_is_loaded(htable))
+		htable_split(htable, false);
 	M0_POST_EX(htable_invariant(htable));
 	M0_POST(m0_tlink_is_in(htable->h_descr->hd_tldescr, amb));
 }
@@ -153,7 +416,8 @@ M0_INTERNAL void m0_htable_del(struct m0_htable *htable,
 	M0_PRE_EX(htable_invariant(htable));
 	M0_PRE(amb != NULL);
 
-	m0_tlist_del(htable->h_descr->hd_tldescr, amb);
+	hbucket_del(htable, key_bucket(htable, obj_key(htable->h_descr, amb)),
+		    amb);
 
 	M0_POST_EX(htable_invariant(htable));
 	M0_POST(!m0_tlink_is_in(htable->h_descr->hd_tldescr, amb));
@@ -162,84 +426,166 @@ M0_INTERNAL void m0_htable_del(struct m0_htable *htable,
 M0_INTERNAL void *m0_htable_lookup(const struct m0_htable *htable,
 				   const void             *key)
 {
-	void     *scan;
-	uint64_t  bucket_id;
-
 	M0_PRE_EX(htable_invariant(htable));
 
-	bucket_id = htable->h_descr->hd_hash_func(htable, key);
-
-	m0_tlist_for(htable->h_descr->hd_tldescr,
-		     &htable->h_buckets[bucket_id].hb_objects, scan) {
-		if (htable->h_descr->hd_key_eq(obj_key(htable->h_descr, scan),
-					       key))
-			break;
-	} m0_tlist_endfor;
-
-	return scan;
+	return hbucket_lookup(htable, key_bucket(htable, key), key);
 }
 
+/*
+ * Concurrent versions do not check the table invariant, which would walk
+ * buckets not locked by the caller.
+ */
+
 M0_INTERNAL void m0_htable_cc_add(struct m0_htable *htable,
 		                  void             *amb)
 {
+	struct m0_hbucket *bucket;
+
+	M0_PRE(m0_htable_bob_check(htable));
 	M0_PRE(amb != NULL);
 
-	m0_hbucket_lock(htable, obj_key(htable->h_descr, amb));
-	m0_htable_add(htable, amb);
-	m0_hbucket_unlock(htable, obj_key(htable->h_descr, amb));
+	bucket = hbucket_lock(htable, obj_key(htable->h_descr, amb));
+	M0_PRE(!m0_tlink_is_in(htable->h_descr->hd_tldescr, amb));
+	hbucket_add(htable, bucket, amb);
+	m0_mutex_unlock(&bucket->hb_mutex);
+	/* A concurrent split, if any, will do. */
+	if (htable_is_loaded(htable) &&
+	    m0_mutex_trylock(&htable->h_split_lock) == 0) {
+		if (htable_is_loaded(htable))
+			htable_split(htable, true);
+		m0_mutex_unlock(&htable->h_split_lock);
+	}
 }
 
 M0_INTERNAL void m0_htable_cc_del(struct m0_htable *htable,
 		                  void             *amb)
 {
+	struct m0_hbucket *bucket;
+
+	M0_PRE(m0_htable_bob_check(htable));
 	M0_PRE(amb != NULL);
 
-	m0_hbucket_lock(htable, obj_key(htable->h_descr, amb));
-	m0_htable_del(htable, amb);
-	m0_hbucket_unlock(htable, obj_key(htable->h_descr, amb));
+	bucket = hbucket_lock(htable, obj_key(htable->h_descr, amb));
+	hbucket_del(htable, bucket, amb);
+	m0_mutex_unlock(&bucket->hb_mutex);
 }
 
 M0_INTERNAL void *m0_htable_cc_lookup(struct m0_htable *htable,
 		                      const void  *key)
 {
-	void *obj;
+	struct m0_hbucket *bucket;
+	void              *obj;
 
+	M0_PRE(m0_htable_bob_check(htable));
 	M0_PRE(key != NULL);
 
-	m0_hbucket_lock(htable, key);
-	obj = m0_htable_lookup(htable, key);
-	m0_hbucket_unlock(htable, key);
+	bucket = hbucket_lock(htable, key);
+	obj = hbucket_lookup(htable, bucket, key);
+	m0_mutex_unlock(&bucket->hb_mutex);
 	return obj;
 }
 
+static struct m0_list_link *link_read(struct m0_list_link *const *link)
+{
+	return *(struct m0_list_link *const volatile *)link;
+}
+
+/**
+ * Walks the bucket list without the lock. The walk is valid if neither the
+ * table state nor the bucket sequence counter changed meanwhile. A link
+ * pointing to itself or NULL belongs to an object being deleted, the walk is
+ * cut then, as well as when it is too long, which happens when it follows
+ * an object moved to another bucket.
+ */
+M0_INTERNAL void *m0_htable_cc_lookup_fast(struct m0_htable *htable,
+					   const void       *key)
+{
+	const struct m0_ht_descr *hd = htable->h_descr;
+	struct m0_hbucket        *bucket;
+	struct m0_list           *head;
+	struct m0_list_link      *link;
+	struct m0_list_link      *next;
+	void                     *amb;
+	void                     *obj;
+	int64_t                   state;
+	int64_t                   seq;
+	int                       walk;
+	int                       try;
+
+	M0_PRE(htable_is_resizable(htable));
+	M0_PRE(key != NULL);
+
+	for (try = 0; try < HT_FAST_TRY_NR; ++try) {
+		state = m0_atomic64_get(&htable->h_state);
+		m0_mb();
+		bucket = m0_htable_bucket(htable,
+				htable_bucket_id(htable, state, key));
+		seq = m0_atomic64_get(&bucket->hb_seq);
+		if (seq & 1)
+			continue;
+		m0_mb();
+		head = &bucket->hb_objects.t_head;
+		link = link_read(&head->l_head);
+		obj  = NULL;
+		for (walk = 0; walk < HT_FAST_WALK_MAX &&
+			     link != (void *)head; ++walk) {
+			amb = (void *)link - hd->hd_tldescr->td_link_offset;
+			if (hd->hd_key_eq(obj_key(hd, amb), key)) {
+				obj = amb;
+				break;
+			}
+			next = link_read(&link->ll_next);
+			if (next == link || next == NULL)
+				break;
+			link = next;
+		}
+		m0_mb();
+		if (m0_atomic64_get(&bucket->hb_seq) == seq &&
+		    m0_atomic64_get(&htable->h_state) == state &&
+		    (obj != NULL || link == (void *)head))
+			return obj;
+	}
+	return m0_htable_cc_lookup(htable, key);
+}
+
 M0_INTERNAL void m0_hbucket_lock(struct m0_htable *htable,
 				 const void       *key)
 {
-	uint64_t bucket_id;
-
 	M0_PRE_EX(htable_invariant(htable));
 
-	bucket_id = htable->h_descr->hd_hash_func(htable, key);
-	m0_mutex_lock(&htable->h_buckets[bucket_id].hb_mutex);
+	(void)hbucket_lock(htable, key);
 }
 
 M0_INTERNAL void m0_hbucket_unlock(struct m0_htable *htable,
 				   const void       *key)
 {
-	uint64_t bucket_id;
-
 	M0_PRE_EX(htable_invariant(htable));
 
-	bucket_id = htable->h_descr->hd_hash_func(htable, key);
-	m0_mutex_unlock(&htable->h_buckets[bucket_id].hb_mutex);
+	/* The bucket cannot be split while it is locked. */
+	m0_mutex_unlock(&key_bucket(htable, key)->hb_mutex);
 }
 
 M0_INTERNAL void m0_htable_fini(struct m0_htable *htable)
 {
 	uint64_t nr;
+	unsigned seg;
 
 	M0_PRE_EX(htable_invariant(htable));
 
+	if (htable_is_resizable(htable)) {
+		for (seg = 1; seg < M0_HTABLE_SEG_NR &&
+			      htable->h_segs[seg] != NULL; ++seg) {
+			for (nr = 0; nr < htable->h_bucket_nr0 << (seg - 1);
+			     ++nr)
+				hbucket_fini(htable->h_descr,
+					     &htable->h_segs[seg][nr]);
+			m0_free(htable->h_segs[seg]);
+		}
+		m0_free(htable->h_segs);
+		m0_mutex_fini(&htable->h_split_lock);
+		htable->h_segs      = NULL;
+		htable->h_bucket_nr = htable->h_bucket_nr0;
+	}
 	for (nr = 0; nr < htable->h_bucket_nr; ++nr)
 		hbucket_fini(htable->h_descr, &htable->h_buckets[nr]);
 	m0_free(htable->h_buckets);
@@ -257,7 +603,7 @@ M0_INTERNAL bool m0_htable_is_empty(const struct m0_htable *htable)
 
 	for (nr = 0; nr < htable->h_bucket_nr; ++nr) {
 		if (!m0_tlist_is_empty(htable->h_descr->hd_tldescr,
-				&htable->h_buckets[nr].hb_objects))
+				&m0_htable_bucket(htable, nr)->hb_objects))
 			break;
 	}
 	return nr == htable->h_bucket_nr;
@@ -270,6 +616,8 @@ M0_INTERNAL uint64_t m0_htable_size(const struct m0_htable *htable)
 
 	M0_PRE_EX(htable_invariant(htable));
 
+	if (htable_is_resizable(htable))
+		return m0_atomic64_get(&htable->h_nr);
 	for (nr = 0; nr < htable->h_bucket_nr; ++nr)
 		len += m0_tlist_length(htable->h_descr->hd_tldescr,
 				&htable->h_buckets[nr].hb_objects);
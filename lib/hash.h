@@ -28,6 +28,7 @@
 #include "lib/types.h"
 #include "lib/tlist.h"
 #include "lib/mutex.h"
+#include "lib/atomic.h"
 
 /**
  * @defgroup hash Hash table.
@@ -143,6 +144,36 @@
  * m0_htable_for() and m0_htable_endfor() can be used to have a loop
  * over all objects in hashtable.
  *
+ * Resizable hash tables
+ * ---------------------
+ *
+ * A table initialised by m0_htable_init_resizable() grows as objects are
+ * added, using linear hashing: when the average bucket length exceeds
+ * M0_HTABLE_LOAD, one bucket (the one at the split pointer) is split in two.
+ * Buckets are split in order, so that the table doubles after as many splits
+ * as it had buckets at the beginning of the round. Buckets are allocated in
+ * segments and never move, the table never shrinks.
+ *
+ * The hash function of a resizable table is called with a m0_htable whose
+ * h_bucket_nr is a power-of-two multiple of the initial bucket number and
+ * must return f(key) % h_bucket_nr, with f() not depending on h_bucket_nr,
+ * as all hash functions in the example above do.
+ *
+ * A resizable table is used either with the plain functions, under the
+ * caller's exclusive lock, or with the concurrent (m0_htable_cc_*())
+ * functions only. m0_hbucket_lock() followed by m0_htable_add() is not
+ * supported for it, because an add may split a bucket.
+ *
+ * m0_htable_cc_lookup_fast() looks a resizable table up without taking locks:
+ * it walks the bucket optimistically and validates the walk against the
+ * bucket sequence counter, which writers increment before and after every
+ * change, falling back to m0_htable_cc_lookup() when the bucket changed. As
+ * there is no deferred reclamation in Motr, objects looked up this way may
+ * be freed only when no fast lookup runs concurrently, i.e. their memory
+ * must stay readable (the user typically keeps objects in a cache or pool),
+ * and the key comparison routine must not dereference pointers stored in
+ * the key.
+ *
  * @{
  */
 
@@ -157,13 +188,25 @@ struct m0_hbucket {
 	/**
 	 * A lock to guard concurrent access to the list of objects.
 	 */
-	struct m0_mutex hb_mutex;
+	struct m0_mutex    hb_mutex;
 	/**
 	 * List of objects which lie in same hash bucket.
 	 * A single m0_tl_descr object would be used by all
 	 * m0_hbucket::hb_objects lists in a single m0_hash object.
 	 */
-	struct m0_tl    hb_objects;
+	struct m0_tl       hb_objects;
+	/**
+	 * Sequence counter of a resizable table bucket: odd while the list of
+	 * objects is being changed. Used by m0_htable_cc_lookup_fast().
+	 */
+	struct m0_atomic64 hb_seq;
+};
+
+enum {
+	/** Average bucket length above which a resizable table grows. */
+	M0_HTABLE_LOAD    = 2,
+	/** Maximal number of bucket segments of a resizable table. */
+	M0_HTABLE_SEG_NR  = 40,
 };
 
 /**
@@ -186,6 +229,30 @@ struct m0_htable {
 
 	/** Associated hash table descriptor. */
 	const struct m0_ht_descr *h_descr;
+
+	/**
+	 * Bucket segments of a resizable table, NULL for a fixed one.
+	 * Segment 0 is h_buckets, segment k > 0 holds
+	 * h_bucket_nr0 << (k - 1) buckets following the buckets of the
+	 * previous segments.
+	 */
+	struct m0_hbucket       **h_segs;
+
+	/** Initial number of buckets of a resizable table. */
+	uint64_t                  h_bucket_nr0;
+
+	/**
+	 * Level of a resizable table (high 8 bits) and its split pointer
+	 * (the remaining bits): the table has h_bucket_nr0 << level buckets
+	 * plus the split pointer buckets already split in this round.
+	 */
+	struct m0_atomic64        h_state;
+
+	/** Number of objects in a resizable table. */
+	struct m0_atomic64        h_nr;
+
+	/** Serialises bucket splits of a resizable table. */
+	struct m0_mutex           h_split_lock;
 };
 
 /**
@@ -237,6 +304,15 @@ M0_INTERNAL int m0_htable_init(const struct m0_ht_descr *d,
 			       struct m0_htable         *htable,
 			       uint64_t                  bucket_nr);
 
+/**
+ * Initializes a hashtable which grows as objects are added.
+ * @param bucket_nr Initial number of buckets.
+ * @see m0_htable_init(), "Resizable hash tables" above.
+ */
+M0_INTERNAL int m0_htable_init_resizable(const struct m0_ht_descr *d,
+					 struct m0_htable         *htable,
+					 uint64_t                  bucket_nr);
+
 /* Checks if hash-table is initialised. */
 M0_INTERNAL bool m0_htable_is_init(const struct m0_htable *htable);
 
@@ -299,6 +375,17 @@ M0_INTERNAL void *m0_htable_lookup(const struct m0_htable *htable,
 M0_INTERNAL void *m0_htable_cc_lookup(struct m0_htable *htable,
 				      const void       *key);
 
+/**
+ * Lock-free version of m0_htable_cc_lookup() for resizable tables.
+ * @see "Resizable hash tables" above for the restrictions.
+ */
+M0_INTERNAL void *m0_htable_cc_lookup_fast(struct m0_htable *htable,
+					   const void       *key);
+
+/** Returns the bucket with the given id. */
+M0_INTERNAL struct m0_hbucket *m0_htable_bucket(const struct m0_htable *htable,
+						uint64_t                id);
+
 /** Returns if m0_htable contains any objects. */
 M0_INTERNAL bool m0_htable_is_empty(const struct m0_htable *htable);
 
@@ -354,6 +441,8 @@ M0_TL_DECLARE(name, scope, amb_type);                                        \
 									     \
 scope int name ## _htable_init(struct m0_htable *htable,		     \
 			       uint64_t          bucket_nr);		     \
+scope int name ## _htable_init_resizable(struct m0_htable *htable,	     \
+					 uint64_t          bucket_nr);	     \
 scope void name ## _htable_add(struct m0_htable *htable, amb_type *amb);     \
 scope void name ## _htable_del(struct m0_htable *htable, amb_type *amb);     \
 scope amb_type *name ## _htable_lookup(const struct m0_htable *htable,	     \
@@ -362,6 +451,8 @@ scope void name ## _htable_cc_add(struct m0_htable *htable, amb_type *amb);  \
 scope void name ## _htable_cc_del(struct m0_htable *htable, amb_type *amb);  \
 scope amb_type *name ## _htable_cc_lookup(struct m0_htable *htable,          \
 				          const key_type   *key);            \
+scope amb_type *name ## _htable_cc_lookup_fast(struct m0_htable *htable,     \
+					       const key_type   *key);       \
 scope void name ## _hbucket_lock(struct m0_htable *htable,                   \
 				 const key_type   *key);                     \
 scope void name ## _hbucket_unlock(struct m0_htable *htable,                 \
@@ -384,6 +475,12 @@ scope __AUN int name ## _htable_init(struct m0_htable *htable,		     \
 	return m0_htable_init(&name ## _ht, htable, bucket_nr);		     \
 }									     \
 									     \
+scope __AUN int name ## _htable_init_resizable(struct m0_htable *htable,    \
+					       uint64_t          bucket_nr)  \
+{									     \
+	return m0_htable_init_resizable(&name ## _ht, htable, bucket_nr);    \
+}									     \
+									     \
 scope __AUN void name ## _htable_add(struct m0_htable *htable,		     \
 				     amb_type         *amb)		     \
 {									     \
@@ -430,6 +527,13 @@ scope __AUN amb_type * name ## _htable_cc_lookup(struct m0_htable *htable,   \
 		                                 const key_type   *key)      \
 {                                                                            \
 	return m0_htable_cc_lookup(htable, key);                             \
+}                                                                            \
+                                                                             \
+scope __AUN amb_type * name ## _htable_cc_lookup_fast(                       \
+					struct m0_htable *htable,            \
+					const key_type   *key)               \
+{                                                                            \
+	return m0_htable_cc_lookup_fast(htable, key);                        \
 }                                                                            \
 									     \
 scope __AUN void name ## _htable_fini(struct m0_htable *htable)		     \
@@ -468,7 +572,7 @@ scope __AUN uint64_t name ## _htable_size(const struct m0_htable *htable)    \
 	typeof (htable) ht = (htable);					    \
 									    \
 	for (cnt = 0; cnt < ht->h_bucket_nr; ++cnt)	{		    \
-		if (!(m0_hbucket_forall(name, var, &ht->h_buckets[cnt],     \
+		if (!(m0_hbucket_forall(name, var, m0_htable_bucket(ht, cnt),\
 					 ({ __VA_ARGS__ ; }))))	            \
 			break;						    \
 	}								    \
@@ -486,7 +590,7 @@ scope __AUN uint64_t name ## _htable_size(const struct m0_htable *htable)    \
 	typeof (htable) ht = (htable);					    \
 									    \
 	for (__cnt = 0; __cnt < ht->h_bucket_nr; ++__cnt) {		    \
-		m0_tl_for(name, &ht->h_buckets[__cnt].hb_objects, var)
+		m0_tl_for(name, &m0_htable_bucket(ht, __cnt)->hb_objects, var)
 
 #define m0_htable_endfor m0_tl_endfor; }; })
 
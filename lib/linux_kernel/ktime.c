@@ -37,6 +37,15 @@
    @{
 */
 
+M0_INTERNAL int m0_clock_source_init(void)
+{
+	return 0;
+}
+
+M0_INTERNAL void m0_clock_source_fini(void)
+{
+}
+
 M0_INTERNAL m0_time_t m0_clock_gettime_wrapper(enum CLOCK_SOURCES clock_id)
 {
 	struct timespec ts;
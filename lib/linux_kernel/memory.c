@@ -21,6 +21,7 @@
 
 #include <linux/slab.h>
 #include <linux/module.h>
+#include <linux/percpu.h>
 
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_LIB
 #include "lib/assert.h"               /* M0_PRE */
@@ -126,6 +127,36 @@ M0_INTERNAL int m0_arch_dont_dump(void *p, size_t size)
 	return 0;
 }
 
+M0_INTERNAL int m0_arch_numa_bind(void *p, size_t size, uint32_t node)
+{
+	return 0;
+}
+
+/*
+ * Allocation statistics are kept per cpu, not to bounce a shared cache line
+ * on every allocation, and summed when read.
+ */
+static DEFINE_PER_CPU(int64_t, mem_alloc);
+static DEFINE_PER_CPU(int64_t, mem_freed);
+
+M0_INTERNAL void m0_arch_memory_stats_add(int64_t alloc, int64_t freed)
+{
+	this_cpu_add(mem_alloc, alloc);
+	this_cpu_add(mem_freed, freed);
+}
+
+M0_INTERNAL void m0_arch_memory_stats_get(int64_t *alloc, int64_t *freed)
+{
+	int cpu;
+
+	*alloc = 0;
+	*freed = 0;
+	for_each_possible_cpu(cpu) {
+		*alloc += per_cpu(mem_alloc, cpu);
+		*freed += per_cpu(mem_freed, cpu);
+	}
+}
+
 M0_INTERNAL int m0_arch_memory_init(void)
 {
 	return 0;
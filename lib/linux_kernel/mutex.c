@@ -47,9 +47,12 @@ M0_INTERNAL void m0_arch_mutex_fini(struct m0_arch_mutex *mutex)
 }
 M0_EXPORTED(m0_arch_mutex_fini);
 
-M0_INTERNAL void m0_arch_mutex_lock(struct m0_arch_mutex *mutex)
+M0_INTERNAL bool m0_arch_mutex_lock(struct m0_arch_mutex *mutex)
 {
+	if (mutex_trylock(&mutex->m_mutex))
+		return false;
 	mutex_lock(&mutex->m_mutex);
+	return true;
 }
 M0_EXPORTED(m0_arch_mutex_lock);
 
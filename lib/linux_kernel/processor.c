@@ -149,7 +149,8 @@ static inline uint32_t processor_numanodeid_get(m0_processor_nr_t id)
 
 /**
    Fetch pipeline id for a given processor.
-   Curently pipeline id is same as processor id.
+   SMT siblings share the pipeline of their physical core, so the id is
+   Physical Package Id (16-31) | Core Id (0-15).
 
    @param id -> id of the processor for which information is requested.
 
@@ -157,7 +158,7 @@ static inline uint32_t processor_numanodeid_get(m0_processor_nr_t id)
  */
 static inline uint32_t processor_pipelineid_get(m0_processor_nr_t id)
 {
-	return id;
+	return topology_physical_package_id(id) << 16 | topology_core_id(id);
 }
 
 /**
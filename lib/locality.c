@@ -150,7 +150,8 @@ M0_INTERNAL struct m0_locality *m0_locality_here(void)
 	if (glob->lg_dom == NULL || m0_thread_self() == &glob->lg_ast_thread)
 		return &glob->lg_fallback;
 	else
-		return m0_locality_get(m0_processor_id_get());
+		return m0_locality_get(glob->lg_dom->fd_cpu_loc[
+					       m0_processor_id_get()]);
 }
 
 M0_INTERNAL struct m0_locality *m0_locality_get(uint64_t value)
@@ -162,7 +163,7 @@ M0_INTERNAL struct m0_locality *m0_locality_get(uint64_t value)
 
 	M0_PRE(dom != NULL);
 	floc = dom->fd_localities[idx];
-	M0_ASSERT(m0_bitmap_get(&floc->fl_processors, idx));
+	M0_ASSERT(floc->fl_idx == idx);
 	return &floc->fl_locality;
 }
 
@@ -30,7 +30,6 @@
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_MEMORY
 #include "lib/arith.h"   /* min_type, m0_is_po2 */
 #include "lib/assert.h"
-#include "lib/atomic.h"
 #include "lib/trace.h"
 #include "lib/memory.h"
 #include "lib/finject.h"
@@ -95,21 +94,16 @@ M0_INTERNAL void   m0_arch_free_aligned(void *data, size_t size, unsigned shft);
 M0_INTERNAL int    m0_arch_pagesize_get(void);
 M0_INTERNAL int    m0_arch_pageshift_get(void);
 M0_INTERNAL int    m0_arch_dont_dump(void *p, size_t size);
+M0_INTERNAL int    m0_arch_numa_bind(void *p, size_t size, uint32_t node);
 M0_INTERNAL int    m0_arch_memory_init (void);
 M0_INTERNAL void   m0_arch_memory_fini (void);
-
-static struct m0_atomic64 allocated;
-static struct m0_atomic64 cumulative_alloc;
-static struct m0_atomic64 cumulative_free;
+M0_INTERNAL void   m0_arch_memory_stats_add(int64_t alloc, int64_t freed);
+M0_INTERNAL void   m0_arch_memory_stats_get(int64_t *alloc, int64_t *freed);
 
 static void alloc_tail(void *area, size_t size)
 {
-	if (DEV_MODE && area != NULL) {
-		size_t asize = m0_arch_alloc_size(area);
-
-		m0_atomic64_add(&allocated, asize);
-		m0_atomic64_add(&cumulative_alloc, asize);
-	}
+	if (DEV_MODE && area != NULL)
+		m0_arch_memory_stats_add(m0_arch_alloc_size(area), 0);
 }
 
 M0_INTERNAL void *m0_alloc_nz(size_t size)
@@ -152,10 +146,8 @@ void m0_free(void *data)
                 /* 5% of logs in m0trace log file is m0_free */
 		//M0_LOG(M0_DEBUG, "%p", data);
 
-		if (DEV_MODE) {
-			m0_atomic64_sub(&allocated, size);
-			m0_atomic64_add(&cumulative_free, size);
-		}
+		if (DEV_MODE)
+			m0_arch_memory_stats_add(0, size);
 		poison_before_free(data, size);
 		m0_arch_free(data);
 	}
@@ -216,19 +208,31 @@ M0_INTERNAL void m0_free_wired(void *data, size_t size, unsigned shift)
 
 M0_INTERNAL size_t m0_allocated(void)
 {
-	return m0_atomic64_get(&allocated);
+	int64_t alloc;
+	int64_t freed;
+
+	m0_arch_memory_stats_get(&alloc, &freed);
+	return alloc - freed;
 }
 M0_EXPORTED(m0_allocated);
 
 M0_INTERNAL size_t m0_allocated_total(void)
 {
-	return m0_atomic64_get(&cumulative_alloc);
+	int64_t alloc;
+	int64_t freed;
+
+	m0_arch_memory_stats_get(&alloc, &freed);
+	return alloc;
 }
 M0_EXPORTED(m0_allocated_total);
 
 M0_INTERNAL size_t m0_freed_total(void)
 {
-	return m0_atomic64_get(&cumulative_free);
+	int64_t alloc;
+	int64_t freed;
+
+	m0_arch_memory_stats_get(&alloc, &freed);
+	return freed;
 }
 M0_EXPORTED(m0_freed_total);
 
@@ -250,20 +254,27 @@ M0_INTERNAL int m0_dont_dump(void *p, size_t size)
 	return m0_arch_dont_dump(p, size);
 }
 
+M0_INTERNAL int m0_memory_numa_bind(void *p, size_t size, uint32_t node)
+{
+	int pagesize = m0_pagesize_get();
+	M0_PRE(((unsigned long)p / pagesize * pagesize) == (unsigned long)p);
+
+	return m0_arch_numa_bind(p, size, node);
+}
+
 M0_INTERNAL int m0_memory_init(void)
 {
-	m0_atomic64_set(&allocated, 0);
-	m0_atomic64_set(&cumulative_alloc, 0);
-	m0_atomic64_set(&cumulative_free, 0);
 	return m0_arch_memory_init();
 }
 
 M0_INTERNAL void m0_memory_fini(void)
 {
-	M0_LOG(M0_DEBUG, "allocated=%" PRIu64 " cumulative_alloc=%" PRIu64 " "
-	       "cumulative_free=%"PRIu64, m0_atomic64_get(&allocated),
-	       m0_atomic64_get(&cumulative_alloc),
-	       m0_atomic64_get(&cumulative_free));
+	int64_t alloc;
+	int64_t freed;
+
+	m0_arch_memory_stats_get(&alloc, &freed);
+	M0_LOG(M0_DEBUG, "allocated=%" PRIi64 " cumulative_alloc=%" PRIi64 " "
+	       "cumulative_free=%"PRIi64, alloc - freed, alloc, freed);
 	m0_arch_memory_fini();
 }
 
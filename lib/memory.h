@@ -175,6 +175,13 @@ M0_INTERNAL bool m0_is_poisoned(const void *p);
  */
 M0_INTERNAL int m0_dont_dump(void *p, size_t size);
 
+/**
+ * Makes the pages of this memory region prefer the numa node, moving the
+ * pages which are already allocated. See mbind(2), MPOL_PREFERRED.
+ * Does nothing in the kernel.
+ */
+M0_INTERNAL int m0_memory_numa_bind(void *p, size_t size, uint32_t node);
+
 /**
  * Wrapper function over memmove.
  */
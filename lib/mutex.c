@@ -49,14 +49,16 @@ M0_EXPORTED(m0_mutex_fini);
 M0_INTERNAL void m0_mutex_lock(struct m0_mutex *mutex)
 {
 	struct m0_mutex_addb2 *ma = mutex->m_addb2;
+	bool                   contended = false;
 
 	M0_PRE(m0_mutex_is_not_locked(mutex));
 	if (ma == NULL)
 		m0_arch_mutex_lock(&mutex->m_arch);
 	else {
 		M0_ADDB2_HIST(ma->ma_id, &ma->ma_wait, m0_ptr_wrap(mutex),
-			      m0_arch_mutex_lock(&mutex->m_arch));
+			      contended = m0_arch_mutex_lock(&mutex->m_arch));
 		ma->ma_taken = m0_time_now();
+		ma->ma_contended += contended;
 	}
 	M0_ASSERT(mutex->m_owner == NULL);
 	mutex->m_owner = m0_thread_self();
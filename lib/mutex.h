@@ -103,11 +103,19 @@ M0_INTERNAL bool m0_mutex_is_locked(const struct m0_mutex *mutex);
 */
 M0_INTERNAL bool m0_mutex_is_not_locked(const struct m0_mutex *mutex);
 
+/**
+ * Addb2 instrumentation of a mutex or of a class of mutexes sharing it.
+ *
+ * ma_wait accumulates wait time of all acquisitions, ma_contended counts
+ * those, which found the mutex held by another thread. Fields are updated
+ * with the mutex held.
+ */
 struct m0_mutex_addb2 {
 	m0_time_t            ma_taken;
 	struct m0_addb2_hist ma_hold;
 	struct m0_addb2_hist ma_wait;
 	uint64_t             ma_id;
+	uint64_t             ma_contended;
 };
 
 /*
@@ -116,7 +124,8 @@ struct m0_mutex_addb2 {
 
 M0_INTERNAL void m0_arch_mutex_init   (struct m0_arch_mutex *mutex);
 M0_INTERNAL void m0_arch_mutex_fini   (struct m0_arch_mutex *mutex);
-M0_INTERNAL void m0_arch_mutex_lock   (struct m0_arch_mutex *mutex);
+/** Returns true iff the mutex was held by another thread. */
+M0_INTERNAL bool m0_arch_mutex_lock   (struct m0_arch_mutex *mutex);
 M0_INTERNAL void m0_arch_mutex_unlock (struct m0_arch_mutex *mutex);
 M0_INTERNAL int  m0_arch_mutex_trylock(struct m0_arch_mutex *mutex);
 
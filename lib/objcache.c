@@ -0,0 +1,130 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2013-2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_MEMORY
+#include "lib/trace.h"
+
+#include "lib/objcache.h"
+#include "lib/assert.h"
+#include "lib/memory.h"    /* m0_alloc */
+#include "lib/misc.h"      /* M0_SET0 */
+#include "lib/processor.h" /* m0_processor_id_get */
+
+/**
+ * @addtogroup objcache
+ *
+ * @{
+ */
+
+static struct m0_objcache_core *objcache_here(struct m0_objcache *cache)
+{
+	return &cache->oc_core[m0_processor_id_get() % M0_OBJCACHE_NR];
+}
+
+M0_INTERNAL void m0_objcache_init(struct m0_objcache *cache, const char *name,
+				  size_t size)
+{
+	int i;
+
+	M0_PRE(size > 0);
+
+	M0_SET0(cache);
+	for (i = 0; i < ARRAY_SIZE(cache->oc_core); ++i)
+		m0_mutex_init(&cache->oc_core[i].occ_lock);
+	cache->oc_name  = name;
+	cache->oc_size  = size;
+	cache->oc_ready = true;
+}
+
+M0_INTERNAL void m0_objcache_fini(struct m0_objcache *cache)
+{
+	struct m0_objcache_core *core;
+	int                      i;
+
+	if (!cache->oc_ready)
+		return;
+	cache->oc_ready = false;
+	for (i = 0; i < ARRAY_SIZE(cache->oc_core); ++i) {
+		core = &cache->oc_core[i];
+		M0_LOG(M0_DEBUG, "%s: core=%i hit=%"PRIu64" miss=%"PRIu64,
+		       cache->oc_name, i, core->occ_hit, core->occ_miss);
+		while (core->occ_nr > 0)
+			m0_free(core->occ_obj[--core->occ_nr]);
+		m0_mutex_fini(&core->occ_lock);
+	}
+}
+
+M0_INTERNAL void *m0_objcache_alloc(struct m0_objcache *cache)
+{
+	struct m0_objcache_core *core;
+	void                    *obj = NULL;
+
+	M0_PRE(cache->oc_size > 0);
+
+	if (!cache->oc_ready)
+		return m0_alloc(cache->oc_size);
+	core = objcache_here(cache);
+	m0_mutex_lock(&core->occ_lock);
+	if (core->occ_nr > 0) {
+		obj = core->occ_obj[--core->occ_nr];
+		++core->occ_hit;
+	} else
+		++core->occ_miss;
+	m0_mutex_unlock(&core->occ_lock);
+	if (obj != NULL)
+		memset(obj, 0, cache->oc_size);
+	else
+		obj = m0_alloc(cache->oc_size);
+	return obj;
+}
+
+M0_INTERNAL void m0_objcache_free(struct m0_objcache *cache, void *obj)
+{
+	struct m0_objcache_core *core;
+
+	if (obj == NULL)
+		return;
+	if (cache->oc_ready) {
+		core = objcache_here(cache);
+		m0_mutex_lock(&core->occ_lock);
+		if (core->occ_nr < ARRAY_SIZE(core->occ_obj)) {
+			core->occ_obj[core->occ_nr++] = obj;
+			obj = NULL;
+		}
+		m0_mutex_unlock(&core->occ_lock);
+	}
+	m0_free(obj);
+}
+
+#undef M0_TRACE_SUBSYSTEM
+
+/** @} end of objcache group */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
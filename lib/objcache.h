@@ -0,0 +1,100 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2013-2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __MOTR_LIB_OBJCACHE_H__
+#define __MOTR_LIB_OBJCACHE_H__
+
+#include "lib/types.h"
+#include "lib/mutex.h"
+
+/**
+ * @defgroup objcache Object caches
+ *
+ * An object cache keeps freed objects of a fixed size for reuse, so that an
+ * object allocated and freed for every request does not go through the
+ * general purpose allocator each time.
+ *
+ * Like the chunk caches of the BE allocator, a cache consists of
+ * M0_OBJCACHE_NR per-core parts (m0_objcache_core), indexed by the core the
+ * call is made on. An object can be freed on a core other than the one it
+ * was allocated on: it goes to the part of the freeing core. Each part keeps
+ * at most M0_OBJCACHE_DEPTH objects, the rest are returned to m0_free(), so
+ * a burst of requests does not pin memory forever.
+ *
+ * Objects are allocated with m0_alloc(), thus an object allocated by the
+ * cache can be freed with m0_free() and vice versa.
+ *
+ * A finalised cache passes all calls to m0_alloc() and m0_free(), so objects
+ * can be freed after the cache is finalised.
+ *
+ * @{
+ */
+
+enum {
+	/** Number of per-core parts of a cache. */
+	M0_OBJCACHE_NR    = 16,
+	/** Maximal number of objects kept in a part. */
+	M0_OBJCACHE_DEPTH = 32,
+};
+
+/** Per-core part of m0_objcache. */
+struct m0_objcache_core {
+	struct m0_mutex  occ_lock;
+	uint32_t         occ_nr;
+	void            *occ_obj[M0_OBJCACHE_DEPTH];
+	/** Number of allocations served from the part. */
+	uint64_t         occ_hit;
+	/** Number of allocations that went to m0_alloc(). */
+	uint64_t         occ_miss;
+};
+
+struct m0_objcache {
+	size_t                  oc_size;
+	const char             *oc_name;
+	/** False if the cache is finalised. */
+	bool                    oc_ready;
+	struct m0_objcache_core oc_core[M0_OBJCACHE_NR];
+};
+
+M0_INTERNAL void m0_objcache_init(struct m0_objcache *cache, const char *name,
+				  size_t size);
+/** Frees the cached objects. */
+M0_INTERNAL void m0_objcache_fini(struct m0_objcache *cache);
+
+/** Returns a zeroed object or NULL. */
+M0_INTERNAL void *m0_objcache_alloc(struct m0_objcache *cache);
+M0_INTERNAL void m0_objcache_free(struct m0_objcache *cache, void *obj);
+
+/** @} end of objcache group */
+#endif /* __MOTR_LIB_OBJCACHE_H__ */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
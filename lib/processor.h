@@ -162,7 +162,8 @@ M0_INTERNAL m0_processor_nr_t m0_processor_id_get(void);
    |               | 3. If L2 is shared and L3 is not present, its             |
    |               |    Physical Package Id                                    |
    +---------------+-----------------------------------------------------------+
-   | pd_pipeline   | Same as pd_id                                             |
+   | pd_pipeline   | Physical Package Id (16-31) | Core Id (0-15), shared by   |
+   |               | SMT siblings                                              |
    +---------------+-----------------------------------------------------------+
    @endverbatim
  */
@@ -116,7 +116,11 @@ M0_INTERNAL int m0_time_init(void)
 {
 	m0_time_t realtime;
 	m0_time_t monotonic;
+	int       rc;
 
+	rc = m0_clock_source_init();
+	if (rc != 0)
+		return M0_ERR(rc);
 	if (M0_CLOCK_SOURCE == M0_CLOCK_SOURCE_REALTIME_MONOTONIC) {
 		monotonic = m0_clock_gettime_wrapper(M0_CLOCK_SOURCE_MONOTONIC);
 		realtime  = m0_clock_gettime_wrapper(M0_CLOCK_SOURCE_REALTIME);
@@ -129,6 +133,7 @@ M0_INTERNAL int m0_time_init(void)
 
 M0_INTERNAL void m0_time_fini(void)
 {
+	m0_clock_source_fini();
 } M0_EXPORTED(m0_time_fini);
 
 m0_time_t m0_time_now(void)
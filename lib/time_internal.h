@@ -37,6 +37,18 @@
 M0_INTERNAL m0_time_t m0_clock_gettime_wrapper(enum CLOCK_SOURCES clock_id);
 M0_INTERNAL m0_time_t m0_clock_gettimeofday_wrapper(void);
 
+/** Sets the platform clock sources up, called by m0_time_init(). */
+M0_INTERNAL int  m0_clock_source_init(void);
+M0_INTERNAL void m0_clock_source_fini(void);
+
+#ifndef __KERNEL__
+/**
+ * Switches reading of M0_CLOCK_SOURCE_MONOTONIC from the cpu cycle counter on
+ * or off. Returns true iff the cycle counter is used.
+ */
+M0_INTERNAL bool m0_clock_tsc_set(bool on);
+#endif
+
 
 /** @} end of time group */
 #endif /* __MOTR_LIB_TIME_INTERNAL_H__ */
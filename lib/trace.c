@@ -222,6 +222,91 @@ M0_INTERNAL void m0_trace_level_allow(unsigned level)
 }
 M0_EXPORTED(m0_trace_level_allow);
 
+/**
+ * Reserves record_len bytes in the trace buffer, not crossing its end.
+ * Returns the (not wrapped) position of the reserved space.
+ */
+static uint64_t trace_buf_alloc(struct m0_trace_buf_header *tbh,
+				uint32_t record_len)
+{
+	uint64_t pos;
+	uint64_t endpos;
+	uint32_t pos_in_buf;
+	uint32_t endpos_in_buf;
+
+	while (1) {
+		endpos = m0_atomic64_add_return(&tbh->tbh_cur_pos, record_len);
+		pos    = endpos - record_len;
+		pos_in_buf = pos & bufmask;
+		endpos_in_buf = endpos & bufmask;
+		/*
+		 * The record should not cross the buffer.
+		 */
+		if (pos_in_buf > endpos_in_buf && endpos_in_buf) {
+			memset(m0_logbuf + pos_in_buf, 0,
+			       m0_logbufsize - pos_in_buf);
+			memset(m0_logbuf, 0, endpos_in_buf);
+		} else
+			return pos;
+	}
+}
+
+#ifndef __KERNEL__
+/**
+ * Part of the trace buffer and range of record numbers owned by a thread.
+ *
+ * Threads contend on the trace buffer header only once per chunk, instead of
+ * twice per record. Unused tail of a chunk is left zeroed and is skipped by
+ * the trace parser, which restores the order of records by their timestamps.
+ *
+ * The buffer wraps around, so a chunk of a thread that traces rarely can be
+ * re-reserved by another thread. Such a chunk is abandoned as soon as the
+ * buffer position is within a chunk of lapping it.
+ */
+struct trace_chunk {
+	/** Trace buffer the chunk belongs to. */
+	const struct m0_trace_buf_header *tc_tbh;
+	/** Time the buffer was initialised, detects re-initialisation. */
+	m0_time_t                         tc_log_time;
+	uint64_t                          tc_pos;
+	uint64_t                          tc_end;
+	uint64_t                          tc_rec;
+	uint64_t                          tc_rec_end;
+};
+
+static __thread struct trace_chunk trace_chunk;
+
+static uint64_t trace_chunk_alloc(struct m0_trace_buf_header *tbh,
+				  uint32_t record_len, uint64_t *record_num)
+{
+	struct trace_chunk *tc = &trace_chunk;
+	uint64_t            pos;
+
+	if (tc->tc_tbh != tbh || tc->tc_log_time != tbh->tbh_log_time)
+		*tc = (struct trace_chunk) {
+			.tc_tbh      = tbh,
+			.tc_log_time = tbh->tbh_log_time
+		};
+	if (tc->tc_pos + record_len > tc->tc_end ||
+	    m0_atomic64_get(&tbh->tbh_cur_pos) - tc->tc_pos >
+	    m0_logbufsize - M0_TRACE_CHUNK_SIZE) {
+		tc->tc_pos = trace_buf_alloc(tbh, M0_TRACE_CHUNK_SIZE);
+		tc->tc_end = tc->tc_pos + M0_TRACE_CHUNK_SIZE;
+		memset(m0_logbuf + (tc->tc_pos & bufmask), 0,
+		       M0_TRACE_CHUNK_SIZE);
+	}
+	if (tc->tc_rec == tc->tc_rec_end) {
+		tc->tc_rec_end = m0_atomic64_add_return(&tbh->tbh_rec_cnt,
+							M0_TRACE_CHUNK_REC_NR);
+		tc->tc_rec = tc->tc_rec_end - M0_TRACE_CHUNK_REC_NR;
+	}
+	*record_num = ++tc->tc_rec;
+	pos = tc->tc_pos;
+	tc->tc_pos += record_len;
+	return pos;
+}
+#endif
+
 M0_INTERNAL void m0_trace_allot(const struct m0_trace_descr *td,
 				const void *body)
 {
@@ -229,9 +314,7 @@ M0_INTERNAL void m0_trace_allot(const struct m0_trace_descr *td,
 	uint32_t  header_len;
 	uint32_t  record_len;
 	uint32_t  pos_in_buf;
-	uint32_t  endpos_in_buf;
 	uint64_t  pos;
-	uint64_t  endpos;
 	uint32_t  str_data_size;
 	void     *body_in_buf;
 	char     *dst_str;
@@ -254,8 +337,6 @@ M0_INTERNAL void m0_trace_allot(const struct m0_trace_descr *td,
 	if (td->td_level > allowed_level)
 		return;
 
-	record_num = m0_atomic64_add_return(&tbh->tbh_rec_cnt, 1);
-
 	/*
 	 * Allocate space in trace buffer to store trace record header
 	 * (header_len bytes) and record payload (record_len bytes).
@@ -273,6 +354,10 @@ M0_INTERNAL void m0_trace_allot(const struct m0_trace_descr *td,
 	 * First free byte in the trace buffer is at "cur" offset. Note, that
 	 * cur is not wrapped to 0 when the end of the buffer is reached (that
 	 * would require additional synchronization between contending threads).
+	 *
+	 * In user space, a thread reserves a chunk of the buffer and a range
+	 * of record numbers at once and fills them without atomic operations,
+	 * see trace_chunk_alloc().
 	 */
 
 	header_len    = m0_align(sizeof *header, M0_TRACE_REC_ALIGN);
@@ -280,21 +365,17 @@ M0_INTERNAL void m0_trace_allot(const struct m0_trace_descr *td,
 	record_len    = header_len + m0_align(td->td_size, M0_TRACE_REC_ALIGN) +
 			m0_align(str_data_size, M0_TRACE_REC_ALIGN);
 
-	while (1) {
-		endpos = m0_atomic64_add_return(&tbh->tbh_cur_pos, record_len);
-		pos    = endpos - record_len;
-		pos_in_buf = pos & bufmask;
-		endpos_in_buf = endpos & bufmask;
-		/*
-		 * The record should not cross the buffer.
-		 */
-		if (pos_in_buf > endpos_in_buf && endpos_in_buf) {
-			memset(m0_logbuf + pos_in_buf, 0,
-			       m0_logbufsize - pos_in_buf);
-			memset(m0_logbuf, 0, endpos_in_buf);
-		} else
-			break;
+#ifndef __KERNEL__
+	if ((tbh->tbh_buf_flags & M0_TRACE_BUF_CHUNKED) &&
+	    record_len <= M0_TRACE_CHUNK_SIZE / 4)
+		pos = trace_chunk_alloc(tbh, record_len, &record_num);
+	else
+#endif
+	{
+		record_num = m0_atomic64_add_return(&tbh->tbh_rec_cnt, 1);
+		pos = trace_buf_alloc(tbh, record_len);
 	}
+	pos_in_buf = pos & bufmask;
 
 	m0_trace_stats_update(record_len);
 
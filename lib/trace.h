@@ -330,6 +330,15 @@ enum {
 	M0_TRACE_BUF_HEADER_SIZE = (1 << 16), /* 64KB */
 	/** Alignment for trace records in trace buffer */
 	M0_TRACE_REC_ALIGN = 8, /* word size on x86_64 */
+	/**
+	 * Part of trace buffer reserved by a thread at once, when the buffer
+	 * is M0_TRACE_BUF_CHUNKED.
+	 */
+	M0_TRACE_CHUNK_SIZE = (1 << 14), /* 16KB */
+	/** Number of trace record numbers reserved by a thread at once. */
+	M0_TRACE_CHUNK_REC_NR = 64,
+	/** Smallest trace buffer, divided into per-thread chunks. */
+	M0_TRACE_CHUNK_BUF_MIN = (1 << 20), /* 1MB */
 };
 
 extern struct m0_trace_buf_header *m0_logbuf_header; /**< Trace buffer header pointer */
@@ -343,6 +352,11 @@ enum m0_trace_buf_type {
 enum m0_trace_buf_flags {
 	M0_TRACE_BUF_MKFS  = 1 << 0,
 	M0_TRACE_BUF_DIRTY = 1 << 1,
+	/**
+	 * Threads place records in their own chunks of the buffer, records
+	 * are not ordered by position in the buffer.
+	 */
+	M0_TRACE_BUF_CHUNKED = 1 << 2,
 
 	M0_TRACE_BUF_FLAGS_MAX
 };
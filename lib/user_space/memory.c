@@ -24,9 +24,14 @@
 #include <unistd.h>
 #include <errno.h>
 #include <sys/mman.h>
+#include <pthread.h>
+#include <sys/syscall.h>      /* SYS_mbind */
+#include <linux/mempolicy.h>  /* MPOL_PREFERRED */
 
 #include "lib/arith.h"   /* min_type, m0_is_po2 */
 #include "lib/assert.h"
+#include "lib/atomic.h"
+#include "lib/list.h"
 #include "lib/memory.h"
 
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_MEMORY
@@ -45,6 +50,18 @@
    function that, given a pointer to an allocated block of memory, returns its
    size. On other platforms m0_allocates() is always 0.
 
+   Small blocks freed by m0_free() are kept in a per-thread cache of size
+   classes (multiples of MEM_CLASS_SIZE bytes) and handed out again by
+   m0_alloc() of the same thread, without going to malloc(3). A block is put
+   into the class of its usable size, rounded down, and taken from the class
+   of the requested size, rounded up, so it is always large enough. The
+   cached amount is bounded per class; the cache of a thread is returned to
+   malloc(3) when the thread exits. The cache needs malloc_usable_size() and
+   is only used between m0_arch_memory_init() and m0_arch_memory_fini().
+
+   Allocation statistics are kept per thread as well and summed when read,
+   so that allocations do not update shared counters.
+
    @{
 */
 
@@ -77,16 +94,186 @@ M0_INTERNAL size_t m0_arch_alloc_size(void *data)
 
 #endif
 
+enum {
+	/** Granularity of the per-thread cache size classes. */
+	MEM_CLASS_SIZE  = 16,
+	/** Number of size classes, the largest cached block is 512 bytes. */
+	MEM_CLASS_NR    = 32,
+	/** Maximal number of bytes cached in a size class. */
+	MEM_CLASS_BYTES = 16 * 1024,
+	/** Maximal number of blocks cached in a size class. */
+	MEM_CLASS_DEPTH = 64,
+};
+
+#ifdef HAVE_MALLINFO
+#define MEM_TCACHE (true)
+#else
+#define MEM_TCACHE (false)
+#endif
+
+/** Per-thread cache and allocation statistics. */
+struct mem_tcache {
+	/** Lists of free blocks, linked through their first word. */
+	void               *tc_free[MEM_CLASS_NR + 1];
+	uint32_t            tc_nr[MEM_CLASS_NR + 1];
+	/** Updated by the owner only, read by m0_arch_memory_stats_get(). */
+	struct m0_atomic64  tc_alloc;
+	struct m0_atomic64  tc_freed;
+	/** Linkage into mem_tcaches. */
+	struct m0_list_link tc_linkage;
+	bool                tc_live;
+};
+
+static __thread struct mem_tcache tcache;
+
+/** Set between m0_arch_memory_init() and m0_arch_memory_fini(). */
+static bool               tcache_on;
+static pthread_once_t     tcache_once = PTHREAD_ONCE_INIT;
+static pthread_key_t      tcache_key;
+/** Protects mem_tcaches and folding of statistics of exited threads. */
+static pthread_mutex_t    tcache_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct m0_list     mem_tcaches;
+/** Statistics of exited threads and of allocations without tcache. */
+static struct m0_atomic64 mem_alloc;
+static struct m0_atomic64 mem_freed;
+
+static void tcache_drain(struct mem_tcache *tc)
+{
+	void *block;
+	int   i;
+
+	for (i = 1; i <= MEM_CLASS_NR; ++i) {
+		while (tc->tc_free[i] != NULL) {
+			block = tc->tc_free[i];
+			tc->tc_free[i] = *(void **)block;
+			free(block);
+		}
+		tc->tc_nr[i] = 0;
+	}
+}
+
+/** Called at thread exit. */
+static void tcache_fini(void *arg)
+{
+	struct mem_tcache *tc = arg;
+
+	if (!tc->tc_live)
+		return;
+	tcache_drain(tc);
+	pthread_mutex_lock(&tcache_lock);
+	m0_atomic64_add(&mem_alloc, m0_atomic64_get(&tc->tc_alloc));
+	m0_atomic64_add(&mem_freed, m0_atomic64_get(&tc->tc_freed));
+	m0_atomic64_set(&tc->tc_alloc, 0);
+	m0_atomic64_set(&tc->tc_freed, 0);
+	m0_list_del(&tc->tc_linkage);
+	pthread_mutex_unlock(&tcache_lock);
+	pthread_setspecific(tcache_key, NULL);
+	tc->tc_live = false;
+}
+
+static void tcache_once_init(void)
+{
+	int rc;
+
+	m0_list_init(&mem_tcaches);
+	rc = pthread_key_create(&tcache_key, &tcache_fini);
+	M0_ASSERT(rc == 0);
+}
+
+/** Returns the cache of the calling thread, NULL if caches are not used. */
+static struct mem_tcache *tcache_get(void)
+{
+	struct mem_tcache *tc = &tcache;
+
+	if (!tcache_on)
+		return NULL;
+	if (!tc->tc_live) {
+		pthread_mutex_lock(&tcache_lock);
+		m0_list_add(&mem_tcaches, &tc->tc_linkage);
+		pthread_mutex_unlock(&tcache_lock);
+		pthread_setspecific(tcache_key, tc);
+		tc->tc_live = true;
+	}
+	return tc;
+}
+
+static uint32_t tcache_depth(size_t cls)
+{
+	return min_type(uint32_t, MEM_CLASS_DEPTH,
+			MEM_CLASS_BYTES / (cls * MEM_CLASS_SIZE));
+}
+
 void *m0_arch_alloc(size_t size)
 {
-	return malloc(size);
+	struct mem_tcache *tc;
+	size_t             cls = max_type(size_t, size, 1);
+	void              *block;
+
+	cls = (cls + MEM_CLASS_SIZE - 1) / MEM_CLASS_SIZE;
+	if (!MEM_TCACHE || cls > MEM_CLASS_NR)
+		return malloc(size);
+	tc = tcache_get();
+	if (tc != NULL && tc->tc_free[cls] != NULL) {
+		block = tc->tc_free[cls];
+		tc->tc_free[cls] = *(void **)block;
+		--tc->tc_nr[cls];
+		return block;
+	}
+	/* Allocate the whole class, so that the block returns to it. */
+	return malloc(cls * MEM_CLASS_SIZE);
 }
 
 void m0_arch_free(void *data)
 {
+	struct mem_tcache *tc;
+	size_t             cls;
+
+	if (MEM_TCACHE) {
+		cls = m0_arch_alloc_size(data) / MEM_CLASS_SIZE;
+		tc = tcache_get();
+		if (tc != NULL && cls > 0 && cls <= MEM_CLASS_NR &&
+		    tc->tc_nr[cls] < tcache_depth(cls)) {
+			*(void **)data = tc->tc_free[cls];
+			tc->tc_free[cls] = data;
+			++tc->tc_nr[cls];
+			return;
+		}
+	}
 	free(data);
 }
 
+M0_INTERNAL void m0_arch_memory_stats_add(int64_t alloc, int64_t freed)
+{
+	struct mem_tcache *tc = tcache_get();
+
+	if (tc != NULL) {
+		/* Single writer, no bus-locked operations needed. */
+		m0_atomic64_set(&tc->tc_alloc,
+				m0_atomic64_get(&tc->tc_alloc) + alloc);
+		m0_atomic64_set(&tc->tc_freed,
+				m0_atomic64_get(&tc->tc_freed) + freed);
+	} else {
+		m0_atomic64_add(&mem_alloc, alloc);
+		m0_atomic64_add(&mem_freed, freed);
+	}
+}
+
+M0_INTERNAL void m0_arch_memory_stats_get(int64_t *alloc, int64_t *freed)
+{
+	struct mem_tcache *tc;
+
+	pthread_once(&tcache_once, &tcache_once_init);
+	pthread_mutex_lock(&tcache_lock);
+	*alloc = m0_atomic64_get(&mem_alloc);
+	*freed = m0_atomic64_get(&mem_freed);
+	m0_list_for_each_entry(&mem_tcaches, tc, struct mem_tcache,
+			       tc_linkage) {
+		*alloc += m0_atomic64_get(&tc->tc_alloc);
+		*freed += m0_atomic64_get(&tc->tc_freed);
+	}
+	pthread_mutex_unlock(&tcache_lock);
+}
+
 M0_INTERNAL void m0_memmove(void *tgt, void *src, size_t size)
 {
 	memmove(tgt,src,size);
@@ -199,10 +386,31 @@ M0_INTERNAL int m0_arch_dont_dump(void *p, size_t size)
 	return rc;
 }
 
+M0_INTERNAL int m0_arch_numa_bind(void *p, size_t size, uint32_t node)
+{
+	enum {
+		NODE_MAX  = 1024,
+		LONG_BITS = 8 * sizeof(unsigned long)
+	};
+	unsigned long mask[NODE_MAX / LONG_BITS] = {};
+	int           rc;
+
+	if (node >= NODE_MAX)
+		return M0_ERR(-EINVAL);
+	mask[node / LONG_BITS] = 1UL << (node % LONG_BITS);
+	/* Called directly, not to make motr depend on libnuma. */
+	rc = syscall(SYS_mbind, p, size, MPOL_PREFERRED, mask, NODE_MAX + 1,
+		     MPOL_MF_MOVE);
+	return rc == 0 ? 0 : M0_ERR(-errno);
+}
+
 M0_INTERNAL int m0_arch_memory_init(void)
 {
 	void *nothing;
 
+	pthread_once(&tcache_once, &tcache_once_init);
+	tcache_on = true;
+
 	/*
 	 * m0_bitmap_init() relies on non-NULL-ness of m0_alloc(0) result.
 	 */
@@ -214,6 +422,10 @@ M0_INTERNAL int m0_arch_memory_init(void)
 
 M0_INTERNAL void m0_arch_memory_fini(void)
 {
+	/* Caches of other threads are drained when these threads exit. */
+	if (tcache.tc_live)
+		tcache_fini(&tcache);
+	tcache_on = false;
 }
 
 M0_INTERNAL int m0_arch_pagesize_get()
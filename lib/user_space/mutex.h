@@ -31,14 +31,38 @@
    @addtogroup mutex
 
    <b>User space mutex.</b>
+
+   When adaptive locking is enabled (M0_LOCK_ADAPTIVE=1 in the environment
+   or m0_lock_adaptive_set()), a thread finding the mutex held retries for a
+   while before sleeping in the kernel. The number of retries is adapted to
+   the time the mutex is usually held, as done by PTHREAD_MUTEX_ADAPTIVE_NP.
    @{
 */
 
 struct m0_arch_mutex {
 	/* POSIX mutex. */
 	pthread_mutex_t m_impl;
+	/* Average number of retries needed to take the mutex. */
+	int             m_spins;
 };
 
+/**
+ * Enables or disables adaptive spinning of mutexes and per-cpu reader
+ * counters of rwlocks initialised afterwards.
+ */
+M0_INTERNAL void m0_lock_adaptive_set(bool on);
+M0_INTERNAL bool m0_arch_lock_adaptive(void);
+
+/** Busy-wait loop hint. */
+static inline void m0_arch_lock_relax(void)
+{
+#if defined(__x86_64__)
+	asm volatile("pause" ::: "memory");
+#elif defined(__aarch64__)
+	asm volatile("yield" ::: "memory");
+#endif
+}
+
 #define M0_ARCH_MUTEX_SINIT(arch_m) { .m_impl = PTHREAD_MUTEX_INITIALIZER }
 
 /** @} end of mutex group */
@@ -716,14 +716,22 @@ static uint32_t processor_l2_cacheid_get(m0_processor_nr_t id)
 
 /**
    Fetch pipeline id for a given processor.
-   Curently pipeline id is same as processor id.
+   SMT siblings share the pipeline of their physical core, so the id is
+   Physical Package Id (16-31) | Core Id (0-15). If the topology is not
+   available, it's same as processor id.
 
    @param id -> id of the processor for which information is requested.
    @return id of pipeline for the given processor.
  */
-static inline uint32_t processor_pipelineid_get(m0_processor_nr_t id)
+static uint32_t processor_pipelineid_get(m0_processor_nr_t id)
 {
-	return id;
+	uint32_t coreid = processor_coreid_get(id);
+	uint32_t physid = processor_physid_get(id);
+
+	if (coreid == M0_PROCESSORS_INVALID_ID ||
+	    physid == M0_PROCESSORS_INVALID_ID)
+		return id;
+	return physid << 16 | coreid;
 }
 
 /**
@@ -20,64 +20,230 @@
  */
 
 
+#include <sched.h>        /* sched_getcpu, sched_yield */
+
+#include "lib/arith.h"    /* max32 */
 #include "lib/assert.h"
+#include "lib/memory.h"
+#include "lib/mutex.h"    /* m0_arch_lock_adaptive */
 #include "lib/rwlock.h"
+#include "lib/time.h"     /* m0_nanosleep */
 
 /**
    @addtogroup rwlock Read-write lock
 
    User space implementation is based on a posix rwlock
-   (pthread_rwlock_init(3))
+   (pthread_rwlock_init(3)), optionally with per-cpu reader counters.
+
+   A reader increments its counter and then checks rw_writer, a writer sets
+   rw_writer and then sums the counters. Both use sequentially consistent
+   atomics, so that either the reader sees the writer or the writer sees the
+   reader. A reader can decrement a counter of another cpu than it
+   incremented, only the sum of counters is meaningful.
+
+   A thread which already holds an adaptive read lock does not back off from
+   a waiting writer of the same lock: the writer cannot proceed until that
+   thread releases the lock, so backing off would deadlock a recursive
+   reader. Each thread keeps a table of adaptive locks it holds for reading
+   (rwlock_held[]). Only a lock found in the table skips the writer check, as
+   no writer can be past its wait for the counters to drain while the lock
+   is held. The table limits the number of distinct adaptive locks a thread
+   can hold for reading at once to RWLOCK_HELD_NR, and an adaptive read lock
+   must be released by the thread which took it.
+
+   A waiting writer backs off exponentially: it spins for a doubling number
+   of iterations, then yields the cpu, then sleeps for a doubling interval.
 
    @{
  */
 
+enum {
+	/** Number of reader counters, a power of 2. */
+	RWLOCK_SLOT_NR     = 16,
+	RWLOCK_SLOT_SHIFT  = 6,
+	/** Number of reader counter scans before a writer yields the cpu. */
+	RWLOCK_SPIN_MAX    = 10,
+	/** Relax iterations between scans double up to 1 << this. */
+	RWLOCK_SPIN_SHIFT  = 7,
+	/** Number of yields before a writer starts sleeping. */
+	RWLOCK_YIELD_MAX   = 100,
+	/** Writer sleep in ns, doubles up to MIN << SHIFT (about 1ms). */
+	RWLOCK_SLEEP_MIN   = 1000,
+	RWLOCK_SLEEP_SHIFT = 10,
+	/** Maximal number of adaptive locks a thread holds for reading. */
+	RWLOCK_HELD_NR     = 32,
+};
+
+/** An adaptive lock held for reading by the current thread. */
+struct rwlock_held {
+	const struct m0_rwlock *rh_lock;
+	/** Recursion depth. */
+	int                     rh_nr;
+};
+
+static __thread struct rwlock_held rwlock_held[RWLOCK_HELD_NR];
+/** Number of used rwlock_held[] entries. */
+static __thread int rwlock_held_nr;
+
+static struct rwlock_held *rwlock_held_find(const struct m0_rwlock *lock)
+{
+	int i;
+
+	for (i = 0; i < rwlock_held_nr; ++i) {
+		if (rwlock_held[i].rh_lock == lock)
+			return &rwlock_held[i];
+	}
+	return NULL;
+}
+
+/** Reader counter on its own cache line. */
+struct m0_rwlock_slot {
+	int64_t rs_nr;
+	char    rs_pad[(1 << RWLOCK_SLOT_SHIFT) - sizeof(int64_t)];
+};
+
+static struct m0_rwlock_slot *rwlock_slot(struct m0_rwlock *lock)
+{
+	int cpu = sched_getcpu();
+
+	return &lock->rw_readers[max32(cpu, 0) & (RWLOCK_SLOT_NR - 1)];
+}
+
+static int64_t rwlock_readers(const struct m0_rwlock *lock)
+{
+	int64_t nr = 0;
+	int     i;
+
+	for (i = 0; i < RWLOCK_SLOT_NR; ++i)
+		nr += __atomic_load_n(&lock->rw_readers[i].rs_nr,
+				      __ATOMIC_SEQ_CST);
+	return nr;
+}
+
+/** Waits after the i-th unsuccessful scan of reader counters. */
+static void rwlock_backoff(int i)
+{
+	int j;
+
+	if (i < RWLOCK_SPIN_MAX) {
+		for (j = 0; j < 1 << min32(i, RWLOCK_SPIN_SHIFT); ++j)
+			m0_arch_lock_relax();
+	} else if (i < RWLOCK_SPIN_MAX + RWLOCK_YIELD_MAX) {
+		sched_yield();
+	} else {
+		i -= RWLOCK_SPIN_MAX + RWLOCK_YIELD_MAX;
+		m0_nanosleep((m0_time_t)RWLOCK_SLEEP_MIN <<
+			     min32(i, RWLOCK_SLEEP_SHIFT), NULL);
+	}
+}
+
 M0_INTERNAL void m0_rwlock_init(struct m0_rwlock *lock)
 {
 	int rc;
 
 	rc = pthread_rwlock_init(&lock->rw_lock, NULL);
 	M0_ASSERT_INFO(rc == 0, "rc=%d", rc);
+	lock->rw_writer = 0;
+	/* Fall back to the posix rwlock when there is no memory. */
+	lock->rw_readers = !m0_arch_lock_adaptive() ? NULL :
+		m0_alloc_aligned(RWLOCK_SLOT_NR * sizeof lock->rw_readers[0],
+				 RWLOCK_SLOT_SHIFT);
 }
 
 M0_INTERNAL void m0_rwlock_fini(struct m0_rwlock *lock)
 {
 	int rc;
 
+	if (lock->rw_readers != NULL) {
+		M0_ASSERT(rwlock_readers(lock) == 0);
+		m0_free_aligned(lock->rw_readers,
+				RWLOCK_SLOT_NR * sizeof lock->rw_readers[0],
+				RWLOCK_SLOT_SHIFT);
+	}
 	rc = pthread_rwlock_destroy(&lock->rw_lock);
 	M0_ASSERT_INFO(rc == 0, "rc=%d", rc);
 }
 
 M0_INTERNAL void m0_rwlock_write_lock(struct m0_rwlock *lock)
 {
+	int i;
 	int rc;
 
 	rc = pthread_rwlock_wrlock(&lock->rw_lock);
 	M0_ASSERT_INFO(rc == 0, "rc=%d", rc);
+	if (lock->rw_readers != NULL) {
+		__atomic_store_n(&lock->rw_writer, 1, __ATOMIC_SEQ_CST);
+		for (i = 0; rwlock_readers(lock) != 0; ++i)
+			rwlock_backoff(i);
+	}
 }
 
 M0_INTERNAL void m0_rwlock_write_unlock(struct m0_rwlock *lock)
 {
 	int rc;
 
+	if (lock->rw_readers != NULL)
+		__atomic_store_n(&lock->rw_writer, 0, __ATOMIC_SEQ_CST);
 	rc = pthread_rwlock_unlock(&lock->rw_lock);
 	M0_ASSERT_INFO(rc == 0, "rc=%d", rc);
 }
 
 void m0_rwlock_read_lock(struct m0_rwlock *lock)
 {
-	int rc;
+	struct m0_rwlock_slot *slot;
+	struct rwlock_held    *held;
+	int                    rc;
 
-	rc = pthread_rwlock_rdlock(&lock->rw_lock);
-	M0_ASSERT_INFO(rc == 0, "rc=%d", rc);
+	if (lock->rw_readers == NULL) {
+		rc = pthread_rwlock_rdlock(&lock->rw_lock);
+		M0_ASSERT_INFO(rc == 0, "rc=%d", rc);
+		return;
+	}
+	held = rwlock_held_find(lock);
+	if (held != NULL) {
+		/* A recursive reader must not wait for the writer. */
+		__atomic_add_fetch(&rwlock_slot(lock)->rs_nr, 1,
+				   __ATOMIC_SEQ_CST);
+		++held->rh_nr;
+		return;
+	}
+	M0_ASSERT_INFO(rwlock_held_nr < RWLOCK_HELD_NR, "nr=%d",
+		       rwlock_held_nr);
+	while (1) {
+		slot = rwlock_slot(lock);
+		__atomic_add_fetch(&slot->rs_nr, 1, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&lock->rw_writer, __ATOMIC_SEQ_CST) == 0)
+			break;
+		__atomic_sub_fetch(&slot->rs_nr, 1, __ATOMIC_SEQ_CST);
+		/* Sleep until the writer releases the lock. */
+		rc = pthread_rwlock_rdlock(&lock->rw_lock);
+		M0_ASSERT_INFO(rc == 0, "rc=%d", rc);
+		rc = pthread_rwlock_unlock(&lock->rw_lock);
+		M0_ASSERT_INFO(rc == 0, "rc=%d", rc);
+	}
+	rwlock_held[rwlock_held_nr++] = (struct rwlock_held) {
+		.rh_lock = lock,
+		.rh_nr   = 1
+	};
 }
 
 void m0_rwlock_read_unlock(struct m0_rwlock *lock)
 {
-	int rc;
+	struct rwlock_held *held;
+	int                 rc;
 
-	rc = pthread_rwlock_unlock(&lock->rw_lock);
-	M0_ASSERT_INFO(rc == 0, "rc=%d", rc);
+	if (lock->rw_readers == NULL) {
+		rc = pthread_rwlock_unlock(&lock->rw_lock);
+		M0_ASSERT_INFO(rc == 0, "rc=%d", rc);
+	} else {
+		held = rwlock_held_find(lock);
+		/* Released by another thread than the one which took it. */
+		M0_ASSERT_INFO(held != NULL, "lock=%p", lock);
+		if (--held->rh_nr == 0)
+			*held = rwlock_held[--rwlock_held_nr];
+		__atomic_sub_fetch(&rwlock_slot(lock)->rs_nr, 1,
+				   __ATOMIC_RELEASE);
+	}
 }
 
 /** @} end of rwlock group */
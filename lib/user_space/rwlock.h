@@ -33,11 +33,32 @@
 */
 
 #include <pthread.h>
+
+#include "lib/types.h"
+
+struct m0_rwlock_slot;
+
 /**
    Blocking read-write lock.
+
+   When adaptive locking is enabled (see m0_lock_adaptive_set()) at
+   initialisation, readers do not touch the posix rwlock. A reader increments
+   a counter selected by its cpu and checks that there is no writer. A writer
+   takes the posix rwlock for writing, announces itself in rw_writer and waits
+   until the sum of reader counters drops to zero. Readers which find a
+   writer sleep by taking the posix rwlock for reading. Readers on different
+   cpus share no cache lines, which makes read locking scalable, at the price
+   of more expensive write locking. A thread already holding an adaptive read
+   lock is let through a waiting writer of the same lock, so that recursive
+   read locking does not deadlock. An adaptive read lock must be released by
+   the thread which took it.
  */
 struct m0_rwlock {
-        pthread_rwlock_t rw_lock;
+        pthread_rwlock_t       rw_lock;
+	/** Per-cpu reader counters, NULL when not used. */
+	struct m0_rwlock_slot *rw_readers;
+	/** True when a writer holds or is taking the lock. */
+	int                    rw_writer;
 };
 
 /** @} end of rwlock group */
@@ -20,8 +20,13 @@
  */
 
 
+#include <stdlib.h>     /* getenv */
+#include <string.h>     /* strcmp */
+#include <unistd.h>     /* sysconf */
+
 #include "lib/misc.h"   /* M0_SET0 */
 #include "lib/mutex.h"
+#include "lib/arith.h"  /* min32 */
 #include "lib/assert.h"
 #include "lib/errno.h"  /* EBUSY */
 
@@ -33,12 +38,39 @@
    @{
 */
 
+enum {
+	/** Maximal number of retries before a thread sleeps on a mutex. */
+	MUTEX_SPIN_MAX = 100,
+};
+
+/** 1 when adaptive locking is enabled, 0 when not, -1 when not known yet. */
+static int lock_adaptive = -1;
+
+M0_INTERNAL void m0_lock_adaptive_set(bool on)
+{
+	lock_adaptive = on;
+}
+
+M0_INTERNAL bool m0_arch_lock_adaptive(void)
+{
+	const char *env;
+
+	if (lock_adaptive < 0) {
+		/* Spinning is useless when the owner cannot run meanwhile. */
+		env = getenv("M0_LOCK_ADAPTIVE");
+		lock_adaptive = env != NULL && strcmp(env, "1") == 0 &&
+				sysconf(_SC_NPROCESSORS_ONLN) > 1;
+	}
+	return lock_adaptive;
+}
+
 M0_INTERNAL void m0_arch_mutex_init(struct m0_arch_mutex *mutex)
 {
 	int rc;
 
 	rc = pthread_mutex_init(&mutex->m_impl, NULL);
 	M0_ASSERT_INFO(rc == 0, "rc=%d", rc);
+	mutex->m_spins = 0;
 }
 
 M0_INTERNAL void m0_arch_mutex_fini(struct m0_arch_mutex *mutex)
@@ -49,12 +81,34 @@ M0_INTERNAL void m0_arch_mutex_fini(struct m0_arch_mutex *mutex)
 	M0_ASSERT_INFO(rc == 0, "rc=%d", rc);
 }
 
-M0_INTERNAL void m0_arch_mutex_lock(struct m0_arch_mutex *mutex)
+M0_INTERNAL bool m0_arch_mutex_lock(struct m0_arch_mutex *mutex)
 {
-	int rc;
+	bool adaptive;
+	int  spin_max = 0;
+	int  i;
+	int  rc;
 
+	rc = pthread_mutex_trylock(&mutex->m_impl);
+	if (rc == 0)
+		return false;
+	M0_ASSERT_INFO(rc == EBUSY, "rc=%d", rc);
+	adaptive = m0_arch_lock_adaptive();
+	if (adaptive) {
+		/* m_spins is only updated with the mutex held. */
+		spin_max = min32(MUTEX_SPIN_MAX, mutex->m_spins * 2 + 10);
+		for (i = 1; i < spin_max; ++i) {
+			m0_arch_lock_relax();
+			if (pthread_mutex_trylock(&mutex->m_impl) == 0) {
+				mutex->m_spins += (i - mutex->m_spins) / 8;
+				return true;
+			}
+		}
+	}
 	rc = pthread_mutex_lock(&mutex->m_impl);
 	M0_ASSERT_INFO(rc == 0, "rc=%d", rc);
+	if (adaptive)
+		mutex->m_spins += (spin_max - mutex->m_spins) / 8;
+	return true;
 }
 
 M0_INTERNAL void m0_arch_mutex_unlock(struct m0_arch_mutex *mutex)
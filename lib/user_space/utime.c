@@ -23,21 +23,271 @@
 #include "lib/time.h"            /* m0_time_t */
 #include "lib/time_internal.h"   /* m0_clock_gettime_wrapper */
 
+#include "lib/arith.h"           /* max64u */
 #include "lib/assert.h"          /* M0_ASSERT */
+#include "lib/atomic.h"          /* m0_atomic64 */
 #include "lib/misc.h"            /* M0_IN */
 #include "lib/errno.h"           /* ENOSYS */
 
 #include <sys/time.h>            /* gettimeofday */
 #include <time.h>                /* clock_gettime */
+#include <stdlib.h>              /* getenv */
+#include <string.h>              /* strcmp */
+#if defined(__x86_64__)
+#include <cpuid.h>               /* __get_cpuid */
+#endif
 
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_LIB
 #include "lib/trace.h"
 
+/**
+ * @addtogroup time
+ *
+ * Cycle counter clock
+ * -------------------
+ *
+ * When M0_CLOCK_TSC environment variable is "1" at m0_time_init(), and the
+ * cpu has a constant rate cycle counter synchronised between cores (invariant
+ * TSC on x86_64, CNTVCT on aarch64), M0_CLOCK_SOURCE_MONOTONIC is read from
+ * the counter instead of clock_gettime(), which makes m0_time_now() a few
+ * nanoseconds.
+ *
+ * Cycles are converted to nanoseconds by a factor calibrated against
+ * CLOCK_MONOTONIC at start. Every UTIME_TSC_RESYNC the first reader of the
+ * clock re-synchronises the conversion with CLOCK_MONOTONIC and corrects the
+ * factor over the elapsed period. The clock does not go back at a resync: the
+ * new base is the maximum of CLOCK_MONOTONIC and the current clock value, and
+ * readers use the conversion parameters under a sequence counter, so that a
+ * value read after the resync is not smaller than any value read before it.
+ *
+ * @{
+ */
+
+enum {
+	/** Period of re-synchronisation with CLOCK_MONOTONIC. */
+	UTIME_TSC_RESYNC = M0_TIME_ONE_SECOND,
+	/** Duration of the calibration at start. */
+	UTIME_TSC_CALIB  = 10 * M0_TIME_ONE_MSEC,
+};
+
+/** Conversion of the cycle counter to CLOCK_MONOTONIC. */
+struct utime_tsc {
+	/** Sequence counter, odd while the parameters below are changed. */
+	struct m0_atomic64 ut_seq;
+	/** Counter value and time of the conversion base. */
+	uint64_t           ut_cycles;
+	m0_time_t          ut_ns;
+	/** Nanoseconds per cycle, shifted left by 32 bits. */
+	uint64_t           ut_mult;
+	/** Counter value after which the conversion is resynchronised. */
+	uint64_t           ut_resync;
+	/** The last CLOCK_MONOTONIC sample, used to correct ut_mult. */
+	uint64_t           ut_ref_cycles;
+	m0_time_t          ut_ref_ns;
+	/** Non-zero while a thread resynchronises. */
+	int64_t            ut_busy;
+	bool               ut_on;
+};
+
+static struct utime_tsc utime_tsc;
+
+static m0_time_t monotonic_now(void)
+{
+	struct timespec tp;
+	int             rc;
+
+	rc = clock_gettime(CLOCK_MONOTONIC, &tp);
+	M0_ASSERT(rc == 0);
+	return M0_MKTIME(tp.tv_sec, tp.tv_nsec);
+}
+
+static inline uint64_t tsc_read(void)
+{
+#if defined(__x86_64__)
+	uint32_t lo;
+	uint32_t hi;
+
+	/* rdtscp waits for the preceding loads. */
+	asm volatile("rdtscp" : "=a"(lo), "=d"(hi) : : "rcx", "memory");
+	return ((uint64_t)hi << 32) | lo;
+#elif defined(__aarch64__)
+	uint64_t cycles;
+
+	asm volatile("isb; mrs %0, cntvct_el0" : "=r"(cycles) : : "memory");
+	return cycles;
+#else
+	return 0;
+#endif
+}
+
+/** Orders loads of clock readers, cheaper than m0_mb(). */
+static inline void tsc_rmb(void)
+{
+#if defined(__x86_64__)
+	asm volatile("" : : : "memory");
+#elif defined(__aarch64__)
+	asm volatile("dmb ishld" : : : "memory");
+#endif
+}
+
+static bool tsc_is_usable(void)
+{
+#if defined(__x86_64__)
+	unsigned eax;
+	unsigned ebx;
+	unsigned ecx;
+	unsigned edx;
+
+	/* Invariant TSC: constant rate, running in all C-, P- states. */
+	return __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) &&
+		(edx & M0_BITS(8)) != 0;
+#elif defined(__aarch64__)
+	return true;
+#else
+	return false;
+#endif
+}
+
+static uint64_t tsc_scale(uint64_t cycles, uint64_t mult)
+{
+	return ((unsigned __int128)cycles * mult) >> 32;
+}
+
+static m0_time_t tsc_ns(const struct utime_tsc *t, uint64_t cycles)
+{
+	return t->ut_ns + (cycles > t->ut_cycles ?
+			   tsc_scale(cycles - t->ut_cycles, t->ut_mult) : 0);
+}
+
+/** Samples the counter together with CLOCK_MONOTONIC. */
+static void tsc_sample(uint64_t *cycles, m0_time_t *ns)
+{
+	uint64_t before = tsc_read();
+
+	*ns = monotonic_now();
+	*cycles = before + (tsc_read() - before) / 2;
+}
+
+static void tsc_params_set(struct utime_tsc *t, uint64_t mult,
+			   uint64_t ref_cycles, m0_time_t ref_ns)
+{
+	uint64_t cycles;
+
+	m0_atomic64_inc(&t->ut_seq);
+	m0_mb();
+	cycles = tsc_read();
+	t->ut_ns = max64u(tsc_ns(t, cycles),
+			  ref_ns + tsc_scale(cycles - ref_cycles, mult));
+	t->ut_cycles = cycles;
+	t->ut_mult = mult;
+	t->ut_resync = cycles + ((unsigned __int128)UTIME_TSC_RESYNC << 32) /
+		mult;
+	t->ut_ref_cycles = ref_cycles;
+	t->ut_ref_ns = ref_ns;
+	m0_mb();
+	m0_atomic64_inc(&t->ut_seq);
+}
+
+static uint64_t tsc_mult(uint64_t cycles, m0_time_t ns)
+{
+	return cycles == 0 ? 0 : ((unsigned __int128)ns << 32) / cycles;
+}
+
+static void tsc_resync(struct utime_tsc *t)
+{
+	uint64_t  cycles;
+	m0_time_t ns;
+	uint64_t  mult;
+
+	tsc_sample(&cycles, &ns);
+	mult = cycles > t->ut_ref_cycles && ns > t->ut_ref_ns ?
+		tsc_mult(cycles - t->ut_ref_cycles, ns - t->ut_ref_ns) : 0;
+	tsc_params_set(t, mult != 0 ? mult : t->ut_mult, cycles, ns);
+}
+
+static m0_time_t tsc_now(void)
+{
+	struct utime_tsc *t = &utime_tsc;
+	int64_t           seq;
+	uint64_t          cycles;
+	m0_time_t         ns;
+	bool              resync;
+
+	do {
+		seq = m0_atomic64_get(&t->ut_seq);
+		tsc_rmb();
+		cycles = tsc_read();
+		ns = tsc_ns(t, cycles);
+		resync = cycles >= t->ut_resync;
+		tsc_rmb();
+	} while ((seq & 1) != 0 || m0_atomic64_get(&t->ut_seq) != seq);
+	if (resync && m0_atomic64_cas(&t->ut_busy, 0, 1)) {
+		tsc_resync(t);
+		m0_mb();
+		t->ut_busy = 0;
+	}
+	return ns;
+}
+
+M0_INTERNAL bool m0_clock_tsc_set(bool on)
+{
+	struct utime_tsc *t = &utime_tsc;
+	uint64_t          c0;
+	uint64_t          c1;
+	m0_time_t         r0;
+	m0_time_t         r1;
+	struct timespec   calib = {
+		.tv_sec  = 0,
+		.tv_nsec = UTIME_TSC_CALIB
+	};
+
+	if (!on || t->ut_on || !tsc_is_usable()) {
+		t->ut_on = t->ut_on && on;
+		return t->ut_on;
+	}
+	tsc_sample(&c0, &r0);
+	nanosleep(&calib, NULL);
+	tsc_sample(&c1, &r1);
+	if (c1 <= c0 || r1 <= r0) {
+		M0_LOG(M0_WARN, "Unusable cycle counter: %"PRIu64" %"PRIu64,
+		       c0, c1);
+		return false;
+	}
+	M0_SET0(t);
+	t->ut_cycles = c1;
+	t->ut_ns = r1;
+	tsc_params_set(t, tsc_mult(c1 - c0, r1 - r0), c1, r1);
+	m0_mb();
+	t->ut_on = true;
+	M0_LOG(M0_INFO, "Cycle counter clock: %"PRIu64" ns/2^32 cycles",
+	       t->ut_mult);
+	return true;
+}
+
+M0_INTERNAL int m0_clock_source_init(void)
+{
+	const char *var = getenv("M0_CLOCK_TSC");
+
+	if (var != NULL && strcmp(var, "1") == 0 && !m0_clock_tsc_set(true))
+		M0_LOG(M0_WARN, "M0_CLOCK_TSC is set, but the cycle counter "
+		       "cannot be used, clock_gettime() is used instead.");
+	return 0;
+}
+
+M0_INTERNAL void m0_clock_source_fini(void)
+{
+	(void)m0_clock_tsc_set(false);
+}
+
+/** @} end of time group */
+
 M0_INTERNAL m0_time_t m0_clock_gettime_wrapper(enum CLOCK_SOURCES clock_id)
 {
 	struct timespec tp;
 	int             rc;
 
+	if (clock_id == M0_CLOCK_SOURCE_MONOTONIC && utime_tsc.ut_on)
+		return tsc_now();
 	rc = clock_gettime((clockid_t)clock_id, &tp);
 	/* clock_gettime() can fail iff clock_id is invalid */
 	M0_ASSERT(rc == 0);
@@ -307,6 +307,8 @@ M0_INTERNAL void m0_arch_trace_buf_header_init(struct m0_trace_buf_header *tbh)
 		tbh->tbh_buf_flags |= M0_TRACE_BUF_MKFS;
 
 	tbh->tbh_buf_flags |= M0_TRACE_BUF_DIRTY;
+	if (tbh->tbh_buf_size >= M0_TRACE_CHUNK_BUF_MIN)
+		tbh->tbh_buf_flags |= M0_TRACE_BUF_CHUNKED;
 }
 
 static unsigned align(FILE *file, uint64_t align, uint64_t pos)
@@ -395,8 +397,14 @@ static void print_trace_buf_header(FILE *ofile,
 	if (tbh->tbh_buf_flags & M0_TRACE_BUF_MKFS) {
 		if (need_comma)
 			fprintf(ofile, ", ");
+		need_comma = true;
 		fprintf(ofile, "MKFS");
 	}
+	if (tbh->tbh_buf_flags & M0_TRACE_BUF_CHUNKED) {
+		if (need_comma)
+			fprintf(ofile, ", ");
+		fprintf(ofile, "CHUNKED");
+	}
 	fprintf(ofile, " ]\n");
 
 	fprintf(ofile, "  header_addr:        %p\n", tbh->tbh_header_addr);
@@ -527,6 +535,76 @@ enum {
 		((struct m0_trace_buf_header *)0)->tbh_magic_sym_addresses)
 };
 
+/** Parsed trace record, waiting to be printed in timestamp order. */
+struct trace_out_rec {
+	uint64_t  tor_timestamp;
+	uint64_t  tor_no;
+	char     *tor_yaml;
+};
+
+/**
+ * Records of a M0_TRACE_BUF_CHUNKED buffer. Threads fill their chunks of the
+ * buffer concurrently, so the records are merged by timestamp before output.
+ */
+struct trace_out {
+	struct trace_out_rec *to_rec;
+	size_t                to_nr;
+	size_t                to_alloc;
+};
+
+static int trace_out_add(struct trace_out *out,
+			 const struct m0_trace_rec_header *trh,
+			 const char *yaml)
+{
+	struct trace_out_rec *rec;
+	size_t                alloc;
+
+	if (out->to_nr == out->to_alloc) {
+		alloc = out->to_alloc * 2 ?: 4096;
+		rec = realloc(out->to_rec, alloc * sizeof rec[0]);
+		if (rec == NULL)
+			return -ENOMEM;
+		out->to_rec = rec;
+		out->to_alloc = alloc;
+	}
+	rec = &out->to_rec[out->to_nr];
+	rec->tor_yaml = strdup(yaml);
+	if (rec->tor_yaml == NULL)
+		return -ENOMEM;
+	rec->tor_timestamp = trh->trh_timestamp;
+	rec->tor_no = trh->trh_no;
+	++out->to_nr;
+	return 0;
+}
+
+static int trace_out_rec_cmp(const void *a, const void *b)
+{
+	const struct trace_out_rec *r0 = a;
+	const struct trace_out_rec *r1 = b;
+
+	return M0_3WAY(r0->tor_timestamp, r1->tor_timestamp) ?:
+		M0_3WAY(r0->tor_no, r1->tor_no);
+}
+
+static void trace_out_flush(struct trace_out *out, FILE *output_file)
+{
+	size_t i;
+
+	qsort(out->to_rec, out->to_nr, sizeof out->to_rec[0],
+	      &trace_out_rec_cmp);
+	for (i = 0; i < out->to_nr; ++i)
+		fprintf(output_file, "%s", out->to_rec[i].tor_yaml);
+}
+
+static void trace_out_fini(struct trace_out *out)
+{
+	size_t i;
+
+	for (i = 0; i < out->to_nr; ++i)
+		free(out->to_rec[i].tor_yaml);
+	free(out->to_rec);
+}
+
 /**
  * Parse log buffer from a trace file.
  *
@@ -556,6 +634,8 @@ M0_INTERNAL int m0_trace_parse(FILE *trace_file, FILE *output_file,
 	bool       td_is_sane;
 	char      *buf;
 
+	struct trace_out  out = {};
+	struct trace_out *sorted;
 	static char  yaml_buf[256 * 1024]; /* 256 KB */
 	ptrdiff_t   *td_offset;
 	ptrdiff_t    td_offsets[MAGIC_SYM_OFFSETS_MAX + 1] = { 0 };
@@ -595,6 +675,8 @@ M0_INTERNAL int m0_trace_parse(FILE *trace_file, FILE *output_file,
 	if (flags & M0_TRACE_PARSE_YAML_SINGLE_DOC_OUTPUT)
 		fprintf(output_file, "trace_records:\n");
 
+	sorted = tbh->tbh_buf_flags & M0_TRACE_BUF_CHUNKED ? &out : NULL;
+
 	while (!feof(trace_file)) {
 
 		/* At the beginning of a record */
@@ -610,13 +692,15 @@ M0_INTERNAL int m0_trace_parse(FILE *trace_file, FILE *output_file,
 					warnx("Got %zu bytes of magic instead"
 					      " of %zu", nr,
 					      sizeof trh.trh_magic);
-					return EX_DATAERR;
+					rc = EX_DATAERR;
+					goto out;
 				}
 				if (invalid_td_count > 0)
 					warnx("Total number of unknown trace"
 					      " records, that were skipped:"
 					      " %zu", invalid_td_count);
-				return EX_OK;
+				rc = EX_OK;
+				goto out;
 			}
 
 			pos += nr;
@@ -627,7 +711,8 @@ M0_INTERNAL int m0_trace_parse(FILE *trace_file, FILE *output_file,
 		nr  = fread(&trh.trh_sp, 1, n2r, trace_file);
 		if (nr != n2r) {
 			warnx("Got %zu bytes of record (need %zu)", nr, n2r);
-			return EX_DATAERR;
+			rc = EX_DATAERR;
+			goto out;
 		}
 		pos += nr;
 
@@ -674,22 +759,34 @@ M0_INTERNAL int m0_trace_parse(FILE *trace_file, FILE *output_file,
 		nr = fread(buf, 1, size, trace_file);
 		if (nr != size) {
 			warnx("Got %zu bytes of data (need %zu)", nr, size);
-			return EX_DATAERR;
+			m0_free(buf);
+			rc = EX_DATAERR;
+			goto out;
 		}
 		pos += nr;
 
 		rc = m0_trace_record_print_yaml(yaml_buf, sizeof yaml_buf, &trh,
 			buf, !(flags & M0_TRACE_PARSE_YAML_SINGLE_DOC_OUTPUT));
-		if (rc == 0)
+		if (rc == 0 && sorted != NULL)
+			rc = trace_out_add(sorted, &trh, yaml_buf);
+		else if (rc == 0)
 			fprintf(output_file, "%s", yaml_buf);
+		if (rc == -ENOMEM)
+			warnx("Failed to allocate memory to sort trace records");
 		else if (rc == -ENOBUFS)
 			warnx("Internal buffer is too small to hold trace record");
-		else
+		else if (rc != 0)
 			warnx("Failed to process trace record data for %p"
 			      " descriptor", trh.trh_descr);
 		m0_free(buf);
 	}
-	return EX_OK;
+	rc = EX_OK;
+out:
+	if (sorted != NULL) {
+		trace_out_flush(sorted, output_file);
+		trace_out_fini(sorted);
+	}
+	return rc;
 }
 
 M0_INTERNAL void m0_console_vprintf(const char *fmt, va_list args)
@@ -24,6 +24,7 @@
 #include "lib/hash.h"   /* m0_htable */
 #include "lib/errno.h"  /* Include appropriate errno.h header. */
 #include "motr/magic.h"
+#include "lib/thread.h"	/* M0_THREAD_INIT() */
 #include "ut/ut.h"	/* M0_UT_ASSERT() */
 
 /*
@@ -49,12 +50,17 @@ struct foo {
 enum {
 	BUCKET_NR = 8,
 	FOO_NR    = 19,
+	/* Threads and objects per thread of the concurrent resize test. */
+	CC_THREAD_NR = 8,
+	CC_FOO_NR    = 512,
 	BAR_MAGIC = 0xa817115ad15ababaULL,
 	FOO_MAGIC = 0x911ea3a7096a96e5ULL,
 };
 
 static struct foo foos[FOO_NR];
 static struct bar thebar;
+static struct foo ccfoos[CC_THREAD_NR][CC_FOO_NR];
+static struct m0_thread cc_threads[CC_THREAD_NR];
 
 static uint64_t hash_func(const struct m0_htable *htable, const void *k)
 {
@@ -156,6 +162,121 @@ void test_hashtable(void)
 	M0_UT_ASSERT(thebar.b_hash.h_magic     == 0);
 }
 
+void test_hashtable_resize(void)
+{
+	int                i;
+	int                rc;
+	uint64_t           key;
+	uint64_t           nr;
+	struct foo        *f;
+
+	for (i = 0; i < FOO_NR; ++i) {
+		foos[i].f_magic = FOO_MAGIC;
+		foos[i].f_hkey  = i;
+		m0_tlink_init(&foohash_tl, &foos[i]);
+	}
+	rc = foohash_htable_init_resizable(&thebar.b_hash, 2);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(thebar.b_hash.h_bucket_nr == 2);
+
+	for (i = 0; i < FOO_NR; ++i) {
+		nr = thebar.b_hash.h_bucket_nr;
+		foohash_htable_add(&thebar.b_hash, &foos[i]);
+		M0_UT_ASSERT(m0_htable_is_init(&thebar.b_hash));
+		/* At most one bucket is split by an add. */
+		M0_UT_ASSERT(M0_IN(thebar.b_hash.h_bucket_nr, (nr, nr + 1)));
+		M0_UT_ASSERT(thebar.b_hash.h_bucket_nr * M0_HTABLE_LOAD >= i);
+	}
+	M0_UT_ASSERT(thebar.b_hash.h_bucket_nr > 2);
+	M0_UT_ASSERT(foohash_htable_size(&thebar.b_hash) == FOO_NR);
+	for (i = 0; i < FOO_NR; ++i) {
+		key = i;
+		M0_UT_ASSERT(foohash_htable_lookup(&thebar.b_hash, &key) ==
+			     &foos[i]);
+		M0_UT_ASSERT(foohash_htable_cc_lookup_fast(&thebar.b_hash,
+							   &key) == &foos[i]);
+	}
+	key = FOO_NR;
+	M0_UT_ASSERT(foohash_htable_lookup(&thebar.b_hash, &key) == NULL);
+	M0_UT_ASSERT(foohash_htable_cc_lookup_fast(&thebar.b_hash,
+						   &key) == NULL);
+	i = 0;
+	m0_htable_for(foohash, f, &thebar.b_hash) {
+		++i;
+	} m0_htable_endfor;
+	M0_UT_ASSERT(i == FOO_NR);
+
+	for (i = 0; i < FOO_NR; ++i)
+		foohash_htable_del(&thebar.b_hash, &foos[i]);
+	M0_UT_ASSERT(foohash_htable_is_empty(&thebar.b_hash));
+	M0_UT_ASSERT(foohash_htable_size(&thebar.b_hash) == 0);
+	foohash_htable_fini(&thebar.b_hash);
+	M0_UT_ASSERT(thebar.b_hash.h_buckets == NULL);
+	for (i = 0; i < FOO_NR; ++i)
+		m0_tlink_fini(&foohash_tl, &foos[i]);
+}
+
+static void cc_resize_thread(int idx)
+{
+	struct foo *f;
+	uint64_t    key;
+	int         i;
+	int         j;
+
+	for (i = 0; i < CC_FOO_NR; ++i) {
+		foohash_htable_cc_add(&thebar.b_hash, &ccfoos[idx][i]);
+		/* Objects added before are found while buckets are split. */
+		for (j = i; j >= 0; j -= 7) {
+			f = foohash_htable_cc_lookup_fast(&thebar.b_hash,
+						&ccfoos[idx][j].f_hkey);
+			M0_UT_ASSERT(f == &ccfoos[idx][j]);
+		}
+		key = (uint64_t)idx * CC_FOO_NR + i + 1;
+		if (i + 1 < CC_FOO_NR)
+			M0_UT_ASSERT(foohash_htable_cc_lookup(&thebar.b_hash,
+							      &key) == NULL);
+	}
+}
+
+void test_hashtable_cc_resize(void)
+{
+	int i;
+	int j;
+	int rc;
+
+	for (i = 0; i < CC_THREAD_NR; ++i) {
+		for (j = 0; j < CC_FOO_NR; ++j) {
+			ccfoos[i][j].f_magic = FOO_MAGIC;
+			ccfoos[i][j].f_hkey  = (uint64_t)i * CC_FOO_NR + j;
+			m0_tlink_init(&foohash_tl, &ccfoos[i][j]);
+		}
+	}
+	rc = foohash_htable_init_resizable(&thebar.b_hash, 4);
+	M0_UT_ASSERT(rc == 0);
+	for (i = 0; i < CC_THREAD_NR; ++i) {
+		rc = M0_THREAD_INIT(&cc_threads[i], int, NULL,
+				    &cc_resize_thread, i, "ht-resize");
+		M0_UT_ASSERT(rc == 0);
+	}
+	for (i = 0; i < CC_THREAD_NR; ++i) {
+		m0_thread_join(&cc_threads[i]);
+		m0_thread_fini(&cc_threads[i]);
+	}
+	M0_UT_ASSERT(m0_htable_is_init(&thebar.b_hash));
+	M0_UT_ASSERT(foohash_htable_size(&thebar.b_hash) ==
+		     CC_THREAD_NR * CC_FOO_NR);
+	M0_UT_ASSERT(thebar.b_hash.h_bucket_nr * M0_HTABLE_LOAD * 2 >=
+		     CC_THREAD_NR * CC_FOO_NR);
+	for (i = 0; i < CC_THREAD_NR; ++i) {
+		for (j = 0; j < CC_FOO_NR; ++j) {
+			foohash_htable_cc_del(&thebar.b_hash, &ccfoos[i][j]);
+			m0_tlink_fini(&foohash_tl, &ccfoos[i][j]);
+		}
+	}
+	M0_UT_ASSERT(foohash_htable_is_empty(&thebar.b_hash));
+	foohash_htable_fini(&thebar.b_hash);
+}
+
 /*
  *  Local variables:
  *  c-indentation-style: "K&R"
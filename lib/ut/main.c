@@ -39,6 +39,7 @@ extern void test_lockers(void);
 extern void test_memory(void);
 extern void m0_test_misc(void);
 extern void test_mutex(void);
+extern void test_objcache(void);
 extern void test_processor(void);
 extern void test_queue(void);
 extern void test_refs(void);
@@ -48,12 +49,15 @@ extern void m0_ut_time_test(void);
 extern void test_timer(void);
 extern void test_tlist(void);
 extern void test_trace(void);
+extern void test_trace_wrap(void);
 extern void test_varr(void);
 extern void test_vec(void);
 extern void test_zerovec(void);
 extern void test_locality(void);
 extern void test_locality_chore(void);
 extern void test_hashtable(void);
+extern void test_hashtable_resize(void);
+extern void test_hashtable_cc_resize(void);
 extern void test_fold(void);
 extern void m0_ut_lib_thread_pool_test(void);
 extern void test_combinations(void);
@@ -76,6 +80,8 @@ struct m0_ut_suite libm0_ut = {
 		{ "finject",          test_finject,      "Dima" },
 		{ "getopts",          test_getopts       },
 		{ "hash",	      test_hashtable     },
+		{ "hash-resize",      test_hashtable_resize },
+		{ "hash-cc-resize",   test_hashtable_cc_resize },
 		{ "list",             test_list          },
 		{ "locality",         test_locality,     "Nikita" },
 		{ "locality-chore",   test_locality_chore, "Nikita" },
@@ -83,6 +89,7 @@ struct m0_ut_suite libm0_ut = {
 		{ "memory",           test_memory        },
 		{ "misc",             m0_test_misc       },
 		{ "mutex",            test_mutex         },
+		{ "objcache",         test_objcache      },
 		{ "rwlock",           test_rw            },
 		{ "processor",        test_processor     },
 		{ "queue",            test_queue         },
@@ -92,6 +99,7 @@ struct m0_ut_suite libm0_ut = {
 		{ "timer",            test_timer,        "Max" },
 		{ "tlist",            test_tlist         },
 		{ "trace",            test_trace,        "Dima, Andriy" },
+		{ "trace-wrap",       test_trace_wrap    },
 		{ "uuid",             m0_test_lib_uuid   },
 		{ "varr",             test_varr          },
 		{ "vec",              test_vec,          "Huang Hua"},
@@ -65,7 +65,7 @@ static void static_mutex_test(void)
 	m0_mutex_unlock(&static_m);
 }
 
-void test_mutex(void)
+static void mutex_test_all(void)
 {
 	int i;
 	int sum;
@@ -108,6 +108,22 @@ void test_mutex(void)
 	static_mutex_test();
 }
 
+void test_mutex(void)
+{
+#ifndef __KERNEL__
+	bool adaptive = m0_arch_lock_adaptive();
+
+	/* Spinning mutexes. */
+	m0_lock_adaptive_set(true);
+	mutex_test_all();
+	m0_lock_adaptive_set(false);
+	mutex_test_all();
+	m0_lock_adaptive_set(adaptive);
+#else
+	mutex_test_all();
+#endif
+}
+
 
 /*
  *  Local variables:
@@ -0,0 +1,82 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2011-2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "ut/ut.h"
+#include "lib/objcache.h"
+#include "lib/memory.h"
+#include "lib/misc.h"    /* M0_IS0 */
+
+struct ocobj {
+	uint64_t o_a;
+	char     o_b[100];
+};
+
+void test_objcache(void)
+{
+	struct m0_objcache cache;
+	struct ocobj      *obj[M0_OBJCACHE_DEPTH + 1];
+	struct ocobj      *o;
+	int                i;
+
+	m0_objcache_init(&cache, "ut", sizeof *o);
+	o = m0_objcache_alloc(&cache);
+	M0_UT_ASSERT(o != NULL && M0_IS0(o));
+	o->o_a = 42;
+	m0_objcache_free(&cache, o);
+	/* A reused object is zeroed. */
+	obj[0] = m0_objcache_alloc(&cache);
+	M0_UT_ASSERT(obj[0] != NULL && M0_IS0(obj[0]));
+	m0_objcache_free(&cache, obj[0]);
+	m0_objcache_free(&cache, NULL);
+
+	for (i = 0; i < ARRAY_SIZE(obj); ++i) {
+		obj[i] = m0_objcache_alloc(&cache);
+		M0_UT_ASSERT(obj[i] != NULL);
+	}
+	/* A part keeps at most M0_OBJCACHE_DEPTH objects. */
+	for (i = 0; i < ARRAY_SIZE(obj); ++i)
+		m0_objcache_free(&cache, obj[i]);
+	M0_UT_ASSERT(m0_forall(j, M0_OBJCACHE_NR,
+			       cache.oc_core[j].occ_nr <= M0_OBJCACHE_DEPTH));
+
+	/* Objects from m0_alloc() can be freed to the cache and vice versa. */
+	o = m0_alloc(sizeof *o);
+	M0_UT_ASSERT(o != NULL);
+	m0_objcache_free(&cache, o);
+	m0_free(m0_objcache_alloc(&cache));
+	m0_objcache_fini(&cache);
+
+	/* A finalised cache falls back to the allocator. */
+	o = m0_objcache_alloc(&cache);
+	M0_UT_ASSERT(o != NULL && M0_IS0(o));
+	m0_objcache_free(&cache, o);
+}
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
@@ -294,10 +294,10 @@ static void verify_a_processor(m0_processor_nr_t id,
 	uint32_t    l1_sz;
 	uint32_t    lvl;
 	uint32_t    l2_sz;
+	bool        topology;
 	struct stat statbuf;
 
 	M0_UT_ASSERT(pd->pd_id == id);
-	M0_UT_ASSERT(pd->pd_pipeline == id);
 
 	sprintf(filename, "%s/" NUMA_FILE1, processor_info_dirp,
 		id, pd->pd_numa_node);
@@ -311,12 +311,16 @@ static void verify_a_processor(m0_processor_nr_t id,
 	M0_UT_ASSERT(rc1 == 0 || rc2 == 0 || pd->pd_numa_node == 0);
 
 	sprintf(filename, "%s/" COREID_FILE, processor_info_dirp, id);
+	topology = stat(filename, &statbuf) == 0;
 	coreid = get_num_from_file(filename);
 
 	sprintf(filename, "%s/" PHYSID_FILE, processor_info_dirp, id);
+	topology &= stat(filename, &statbuf) == 0;
 	physid = get_num_from_file(filename);
 
 	mixedid = physid << 16 | coreid;
+	/* Pipeline id is the processor id only when there is no topology. */
+	M0_UT_ASSERT(pd->pd_pipeline == (topology ? mixedid : id));
 	M0_UT_ASSERT(pd->pd_l1 == id || pd->pd_l1 == mixedid);
 	M0_UT_ASSERT(pd->pd_l2 == id || pd->pd_l2 == mixedid ||
 		     pd->pd_l2 == physid);
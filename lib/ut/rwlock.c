@@ -23,8 +23,10 @@
 #include "ut/ut.h"
 #include "lib/thread.h"
 #include "lib/rwlock.h"
+#include "lib/mutex.h"     /* m0_lock_adaptive_set */
 #include "lib/assert.h"
 #include "lib/semaphore.h"
+#include "lib/time.h"      /* m0_nanosleep */
 
 /**
    @addtogroup rwlock
@@ -50,6 +52,7 @@ M0_BASSERT(S + C <= NR);
 static int counter;
 static struct m0_thread t[NR];
 static struct m0_rwlock m;
+static struct m0_rwlock m2;
 static int sum;
 static struct m0_semaphore p;
 static struct m0_semaphore q;
@@ -76,6 +79,29 @@ static void reader(int n)
 	m0_rwlock_read_unlock(&m);
 }
 
+static void rreader(int n)
+{
+	m0_rwlock_read_lock(&m);
+	m0_semaphore_up(&p);
+	m0_semaphore_down(&q);
+	/* A writer is waiting for this reader now. */
+	m0_rwlock_read_lock(&m);
+	M0_UT_ASSERT(counter == 0);
+	m0_rwlock_read_unlock(&m);
+	m0_rwlock_read_unlock(&m);
+}
+
+static void r2reader(int n)
+{
+	m0_rwlock_read_lock(&m2);
+	m0_semaphore_up(&p);
+	/* m is write-held, holding m2 must not let this reader in. */
+	m0_rwlock_read_lock(&m);
+	counter = n;
+	m0_rwlock_read_unlock(&m);
+	m0_rwlock_read_unlock(&m2);
+}
+
 static void wstarver(int x)
 {
 	m0_rwlock_write_lock(&m);
@@ -260,9 +286,61 @@ static void test_rw_wstarve(void)
 	}
 }
 
-void test_rw(void)
+#ifndef __KERNEL__
+/**
+   Unit test: a reader can take the lock again while a writer waits.
+
+   Kernel rw-semaphores do not allow this, so the test is user space only.
+ */
+static void test_rw_recursive(void)
+{
+	int result;
+
+	counter = 0;
+	result = M0_THREAD_INIT(&t[0], int, NULL, &rreader, 0, "rreader");
+	M0_UT_ASSERT(result == 0);
+	m0_semaphore_down(&p);
+	result = M0_THREAD_INIT(&t[1], int, NULL, &writer, 1, "writer");
+	M0_UT_ASSERT(result == 0);
+	if (m.rw_readers != NULL) {
+		while (__atomic_load_n(&m.rw_writer, __ATOMIC_SEQ_CST) == 0)
+			m0_nanosleep(M0_TIME_ONE_MSEC, NULL);
+	} else
+		m0_nanosleep(10 * M0_TIME_ONE_MSEC, NULL);
+	m0_semaphore_up(&q);
+	for (i = 0; i < 2; ++i) {
+		m0_thread_join(&t[i]);
+		m0_thread_fini(&t[i]);
+	}
+	M0_UT_ASSERT(counter == NR);
+}
+#endif
+
+/**
+   Unit test: a reader holding another lock does not get in while a writer
+   holds the lock.
+ */
+static void test_rw_other(void)
+{
+	int result;
+
+	counter = 0;
+	m0_rwlock_write_lock(&m);
+	result = M0_THREAD_INIT(&t[0], int, NULL, &r2reader, 1, "r2reader");
+	M0_UT_ASSERT(result == 0);
+	m0_semaphore_down(&p);
+	m0_nanosleep(10 * M0_TIME_ONE_MSEC, NULL);
+	M0_UT_ASSERT(counter == 0);
+	m0_rwlock_write_unlock(&m);
+	m0_thread_join(&t[0]);
+	m0_thread_fini(&t[0]);
+	M0_UT_ASSERT(counter == 1);
+}
+
+static void rw_test_all(void)
 {
 	m0_rwlock_init(&m);
+	m0_rwlock_init(&m2);
 	m0_semaphore_init(&p, 0);
 	m0_semaphore_init(&q, 0);
 
@@ -271,12 +349,33 @@ void test_rw(void)
 	test_rw_excl();
 	test_rw_rstarve();
 	test_rw_wstarve();
+#ifndef __KERNEL__
+	test_rw_recursive();
+#endif
+	test_rw_other();
 
 	m0_semaphore_fini(&q);
 	m0_semaphore_fini(&p);
+	m0_rwlock_fini(&m2);
 	m0_rwlock_fini(&m);
 }
 
+void test_rw(void)
+{
+#ifndef __KERNEL__
+	bool adaptive = m0_arch_lock_adaptive();
+
+	/* Per-cpu reader counters. */
+	m0_lock_adaptive_set(true);
+	rw_test_all();
+	m0_lock_adaptive_set(false);
+	rw_test_all();
+	m0_lock_adaptive_set(adaptive);
+#else
+	rw_test_all();
+#endif
+}
+
 
 /*
  *  Local variables:
@@ -21,6 +21,7 @@
 
 
 #include "lib/time.h"		/* m0_time_t */
+#include "lib/time_internal.h"	/* m0_clock_tsc_set */
 
 #include "lib/arith.h"		/* max_check */
 #include "lib/assert.h"		/* M0_PRE */
@@ -225,6 +226,30 @@ static void time_test_mt_nr(int threads_nr)
 	}
 }
 
+#ifndef __KERNEL__
+#include <time.h>		/* clock_gettime */
+
+/** Checks that the cycle counter clock follows CLOCK_MONOTONIC. */
+static void time_test_tsc(void)
+{
+	struct timespec ts;
+	m0_time_t       mono;
+	m0_time_t       now;
+	m0_time_t       prev = 0;
+	int             i;
+
+	for (i = 0; i < TIME_VALUES_NR; ++i) {
+		now = m0_clock_gettime_wrapper(M0_CLOCK_SOURCE_MONOTONIC);
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		mono = M0_MKTIME(ts.tv_sec, ts.tv_nsec);
+		M0_UT_ASSERT(now >= prev);
+		M0_UT_ASSERT(now <= mono + DIFF_ACCEPTED &&
+			     mono <= now + DIFF_ACCEPTED);
+		prev = now;
+	}
+}
+#endif
+
 void m0_ut_time_test(void)
 {
 	int t;
@@ -232,6 +257,17 @@ void m0_ut_time_test(void)
 	time_test_simple();
 	for (t = 1; t <= THREADS_NR_MAX; ++t)
 		time_test_mt_nr(t);
+#ifndef __KERNEL__
+	/* The same with the cycle counter clock, if the cpu has one. */
+	if (m0_clock_tsc_set(true)) {
+		time_test_tsc();
+		for (t = 1; t <= THREADS_NR_MAX; t *= 2)
+			time_test_mt_nr(t);
+		/* Back to the clock selected at start. */
+		m0_clock_source_fini();
+		m0_clock_source_init();
+	}
+#endif
 }
 
 enum { UB_TIME_ITER = 0x1000000 };
@@ -20,13 +20,21 @@
  */
 
 
+#include <stdio.h>      /* tmpfile */
+#include <unistd.h>     /* fork */
+#include <sys/wait.h>   /* waitpid */
+
 #include "lib/misc.h"   /* M0_SET0 */
 #include "lib/ub.h"
 #include "ut/ut.h"
 #include "lib/thread.h"
 #include "lib/assert.h"
+#include "lib/memory.h"           /* m0_alloc_aligned */
+#include "lib/semaphore.h"
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_UT
 #include "lib/trace.h"
+#include "lib/trace_internal.h"   /* m0_trace_buf_header_init */
+#include "lib/user_space/trace.h" /* m0_trace_parse */
 
 enum {
 	NR       = 16,
@@ -73,6 +81,128 @@ void test_trace(void)
 		(char *)"foobar");
 }
 
+enum {
+	/** Records of the stale thread after the buffer has wrapped. */
+	WRAP_REC_NR   = 16,
+	/** Smallest chunked buffer. */
+	WRAP_BUF_SIZE = M0_TRACE_CHUNK_BUF_MIN,
+	/** Alignment of the trace area, the header size. */
+	WRAP_SHIFT    = 16
+};
+
+M0_BASSERT((int)M0_TRACE_BUF_HEADER_SIZE == 1 << WRAP_SHIFT);
+
+static struct m0_semaphore wrap_p;
+static struct m0_semaphore wrap_q;
+
+static void wrap_stale(int unused)
+{
+	int i;
+
+	M0_LOG(M0_DEBUG, "stale: %i", -1);
+	m0_semaphore_up(&wrap_p);
+	m0_semaphore_down(&wrap_q);
+	for (i = 0; i < WRAP_REC_NR; ++i)
+		M0_LOG(M0_DEBUG, "stale: %i", i);
+}
+
+/**
+ * Fills a small chunked trace buffer until it laps the chunk of a thread
+ * which traced once, lets that thread trace again and parses the buffer.
+ * Returns true iff all the later records of both threads are intact.
+ */
+static bool trace_wrap_run(void)
+{
+	struct m0_trace_buf_header *tbh;
+	struct m0_thread            stale = {};
+	FILE                       *in;
+	FILE                       *out;
+	char                       *area;
+	char                        line[256];
+	bool                        seen[WRAP_REC_NR] = {};
+	uint64_t                    pos0;
+	int                         nr = 0;
+	int                         v;
+	int                         i;
+	int                         rc;
+
+	area = m0_alloc_aligned(M0_TRACE_BUF_HEADER_SIZE + WRAP_BUF_SIZE,
+				WRAP_SHIFT);
+	if (area == NULL)
+		return false;
+	tbh = (struct m0_trace_buf_header *)area;
+	m0_trace_buf_header_init(tbh, WRAP_BUF_SIZE);
+	if (!(tbh->tbh_buf_flags & M0_TRACE_BUF_CHUNKED))
+		return false;
+	m0_logbuf_header = tbh;
+	m0_logbuf = area + M0_TRACE_BUF_HEADER_SIZE;
+	m0_trace_logbuf_size_set(WRAP_BUF_SIZE);
+
+	m0_semaphore_init(&wrap_p, 0);
+	m0_semaphore_init(&wrap_q, 0);
+	M0_LOG(M0_DEBUG, "filler: %i", -1);
+	pos0 = m0_trace_logbuf_pos_get();
+	rc = M0_THREAD_INIT(&stale, int, NULL, &wrap_stale, 0, "stale");
+	if (rc != 0)
+		return false;
+	m0_semaphore_down(&wrap_p);
+	/* The stale thread owns the chunk right after the main one. */
+	if (m0_trace_logbuf_pos_get() != pos0 + M0_TRACE_CHUNK_SIZE)
+		return false;
+	/* Reserve the chunk at the place of the stale one in the ring. */
+	for (i = 0; m0_trace_logbuf_pos_get() <
+		     pos0 + WRAP_BUF_SIZE + M0_TRACE_CHUNK_SIZE; ++i)
+		M0_LOG(M0_DEBUG, "filler: %i", i);
+	m0_semaphore_up(&wrap_q);
+	m0_thread_join(&stale);
+	m0_thread_fini(&stale);
+	for (i = 0; i < WRAP_REC_NR; ++i)
+		M0_LOG(M0_DEBUG, "filler: %i", -2 - i);
+	m0_semaphore_fini(&wrap_q);
+	m0_semaphore_fini(&wrap_p);
+
+	in  = tmpfile();
+	out = tmpfile();
+	if (in == NULL || out == NULL ||
+	    fwrite(area, M0_TRACE_BUF_HEADER_SIZE + WRAP_BUF_SIZE, 1, in) != 1)
+		return false;
+	rewind(in);
+	rc = m0_trace_parse(in, out, NULL, M0_TRACE_PARSE_DEFAULT_FLAGS,
+			    NULL, 0);
+	if (rc != 0)
+		return false;
+	rewind(out);
+	while (fgets(line, sizeof line, out) != NULL) {
+		if (sscanf(line, " stale: %i", &v) == 1 &&
+		    v >= 0 && v < WRAP_REC_NR && !seen[v]) {
+			seen[v] = true;
+		} else if (sscanf(line, " filler: %i", &v) == 1 &&
+			   v <= -2 && v > -2 - WRAP_REC_NR)
+			++nr;
+	}
+	return m0_forall(j, WRAP_REC_NR, seen[j]) && nr == WRAP_REC_NR;
+}
+
+/**
+ * Unit test: a thread which traces rarely does not write into a chunk that
+ * was re-reserved by another thread after the buffer wrapped.
+ *
+ * The global trace buffer is replaced, so the test runs in a child process,
+ * where no other thread traces.
+ */
+void test_trace_wrap(void)
+{
+	pid_t pid;
+	int   status;
+
+	pid = fork();
+	M0_UT_ASSERT(pid >= 0);
+	if (pid == 0)
+		_exit(trace_wrap_run() ? 0 : 1);
+	M0_UT_ASSERT(waitpid(pid, &status, 0) == pid);
+	M0_UT_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
 enum {
 	UB_ITER = 5000000
 };
@@ -132,6 +132,8 @@ static void test_size(void);
 static void test_depth(uint32_t max_depth);
 /* Tests contents of cache present in m0_varr. */
 static void test_cache(void);
+/* Tests flat arrays and contiguous runs of objects. */
+static void test_run(void);
 /* Iterates over array, for various input objects. */
 static void test_ut_iterate(uint64_t nr);
 static void obj_init(void *obj, uint64_t data, enum data_types dt);
@@ -149,6 +151,7 @@ void test_varr(void)
 	test_size();
 	test_depth(MAX_TEST_DEPTH);
 	test_cache();
+	test_run();
 	test_ut_iterate(MAX_OBJ_NR);
 }
 
@@ -287,6 +290,45 @@ static void test_cache(void)
 	m0_varr_fini(&varr);
 }
 
+static void test_run(void)
+{
+	struct m0_varr        varr;
+	struct m0_varr_cursor cursor;
+	uint64_t             *obj;
+	uint64_t              nr;
+	uint64_t              i;
+	uint64_t              j = 0;
+	int                   rc;
+
+	M0_SET0(&varr);
+	rc = m0_varr_init(&varr, BUFF_SIZE / sizeof *obj, sizeof *obj,
+			  BUFF_SIZE);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(varr.va_flat != NULL);
+	for (i = 0; i < m0_varr_size(&varr); ++i)
+		M0_UT_ASSERT(m0_varr_ele_get(&varr, i) ==
+			     varr.va_flat + i * sizeof *obj);
+	m0_varr_fini(&varr);
+
+	M0_SET0(&varr);
+	rc = m0_varr_init(&varr, MAX_OBJ_NR, sizeof *obj, BUFF_SIZE);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(varr.va_flat == NULL);
+	rc = m0_varr_cursor_init(&cursor, &varr, varr.va_depth);
+	M0_UT_ASSERT(rc == 0);
+	do {
+		nr  = m0_varr_cursor_run(&cursor);
+		obj = m0_varr_cursor_get(&cursor);
+		M0_UT_ASSERT(nr > 0 && nr <= BUFF_SIZE / sizeof *obj);
+		for (i = 0; i < nr; ++i)
+			obj[i] = j++;
+	} while (m0_varr_cursor_move(&cursor, nr));
+	M0_UT_ASSERT(j == MAX_OBJ_NR);
+	for (i = 0; i < m0_varr_size(&varr); ++i)
+		M0_UT_ASSERT(*(uint64_t *)m0_varr_ele_get(&varr, i) == i);
+	m0_varr_fini(&varr);
+}
+
 static uint16_t int_summation(uint8_t n)
 {
 	return (n + 1) * n / 2;
@@ -138,6 +138,7 @@ M0_INTERNAL int m0_varr_init(struct m0_varr *arr, uint64_t nr, size_t size,
 						arr->va_bufptr_nr_shift, <<);
 	m0_varr_bob_init(arr);
 	arr->va_failure_depth   = 0;
+	arr->va_flat            = NULL;
 	M0_ALLOC_PTR(arr->va_cache);
 	if (arr->va_cache != NULL) {
 		arr->va_buff_nr = total_leaf_buffers(arr->va_nr,
@@ -146,6 +147,8 @@ M0_INTERNAL int m0_varr_init(struct m0_varr *arr, uint64_t nr, size_t size,
 						     arr->va_obj_shift);
 		arr->va_depth = depth_find(arr, arr->va_buff_nr);
 		rc = varr_buffers_alloc(arr);
+		if (rc == 0 && arr->va_buff_nr == 1)
+			arr->va_flat = arr->va_tree[0];
 	} else
 		rc = -ENOMEM;
 	if (rc != 0)
@@ -338,6 +341,14 @@ M0_INTERNAL int m0_varr_cursor_move(struct m0_varr_cursor *cursor,
 	M0_PRE(d <= cursor->vc_arr->va_depth);
 
 	pe = &cursor->vc_path[d];
+	/* Fast path: the target is in the same leaf buffer. */
+	if (d == cursor->vc_arr->va_depth && pe->vp_idx + inc < pe->vp_width &&
+	    cursor->vc_done + inc < cursor->vc_arr->va_nr) {
+		pe->vp_buf += inc << cursor->vc_arr->va_obj_shift;
+		pe->vp_idx += inc;
+		cursor->vc_done += inc;
+		return 1;
+	}
 	max_idx_in_level = max_idx_within_level(cursor, d);
 	target_idx = cursor->vc_done + inc;
 	if (target_idx > max_idx_in_level)
@@ -373,6 +384,17 @@ end:
 
 }
 
+M0_INTERNAL uint64_t m0_varr_cursor_run(const struct m0_varr_cursor *cursor)
+{
+	const struct m0_varr_path_element *pe;
+
+	M0_PRE(cursor->vc_depth == cursor->vc_arr->va_depth);
+
+	pe = &cursor->vc_path[cursor->vc_depth];
+	return min64u(pe->vp_width - pe->vp_idx,
+		      cursor->vc_arr->va_nr - cursor->vc_done);
+}
+
 M0_INTERNAL uint64_t max_idx_within_level(const struct m0_varr_cursor *cursor,
 					  uint32_t depth)
 {
@@ -491,6 +513,7 @@ M0_INTERNAL void m0_varr_fini(struct m0_varr *arr)
 	varr_buffers_dealloc(arr);
 	m0_free(arr->va_cache);
 	m0_varr_bob_fini(arr);
+	arr->va_flat   = NULL;
 	arr->va_nr     = arr->va_bufsize = 0;
 	arr->va_depth  = 0;
 }
@@ -510,6 +533,8 @@ M0_INTERNAL void *m0_varr_ele_get(struct m0_varr *arr, uint64_t index)
 	M0_PRE(arr != NULL);
 	M0_PRE(index < arr->va_nr);
 
+	if (arr->va_flat != NULL)
+		return arr->va_flat + (index << arr->va_obj_shift);
 	holder = cache_fetch(arr, index);
 	if (holder != NULL)
 		goto end;
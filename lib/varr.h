@@ -157,6 +157,11 @@ struct m0_varr {
 	void		  *va_tree[M0_VA_TNODE_NR];
 	/** Holds address of a buffer holding recently accessed object. */
 	struct varr_cache *va_cache;
+	/**
+	 * Address of the only leaf buffer when all objects fit in it, NULL
+	 * otherwise. Such an array is accessed as a flat array.
+	 */
+	void              *va_flat;
 	/** Holds the cursor depth in case of a failure. */
 	uint32_t	   va_failure_depth;
 	/** Magic field to cross check sanity of structure. */
@@ -227,6 +232,24 @@ M0_INTERNAL int m0_varr_cursor_next(struct m0_varr_cursor *cursor);
  */
 M0_INTERNAL int m0_varr_cursor_move(struct m0_varr_cursor *cursor,
 				    uint64_t inc);
+/**
+ * Returns the number of objects starting at the current cursor location which
+ * are contiguous in memory, so that a caller can access them as a flat array
+ * starting at m0_varr_cursor_get().
+ *
+ * @code
+ * rc = m0_varr_cursor_init(&c, arr, arr->va_depth);
+ * do {
+ *         nr  = m0_varr_cursor_run(&c);
+ *         obj = m0_varr_cursor_get(&c);
+ *         for (i = 0; i < nr; ++i)
+ *                 obj[i] = ...;
+ * } while (m0_varr_cursor_move(&c, nr));
+ * @endcode
+ *
+ * @pre cursor->vc_depth == cursor->vc_arr->va_depth
+ */
+M0_INTERNAL uint64_t m0_varr_cursor_run(const struct m0_varr_cursor *cursor);
 /**
  * Iterates over an arbitrary arithmetic progression of indices over
  * the range [start, end).
@@ -18,8 +18,8 @@
  *
  */
 
-
 #include <linux/version.h> /* LINUX_VERSION_CODE */
+#include <linux/jiffies.h> /* msecs_to_jiffies */
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(3,10,0)
 #include <linux/cred.h>
 #include <linux/uidgid.h>  /* from_kuid */
@@ -62,6 +62,8 @@ struct cob_req {
 	int32_t             cr_rc;
 	struct m0_fid       cr_fid;
 	struct m0_fid       cr_pver;
+	/** Number of fops sent by an asynchronous request. */
+	int                 cr_nr;
 };
 
 struct cob_fop {
@@ -111,6 +113,52 @@ static const struct m0_rpc_item_ops cob_item_ops = {
 	.rio_replied = cob_rpc_item_cb,
 };
 
+/**
+ * Metadata lease
+ * --------------
+ *
+ * With csb_md_lease set, attributes of an inode fetched from a service (or
+ * set by a create) are used by getattr without an rpc until the lease
+ * expires, and names not found by lookup are kept as negative dentries for
+ * the lease time. Changes made by this client update the cached data, changes
+ * by other clients are seen after the lease expires. Positive dentries are
+ * kept till unlinked, as without the lease.
+ */
+
+static bool attr_lease_is_valid(const struct m0t1fs_inode *ci)
+{
+	return M0T1FS_SB(ci->ci_inode.i_sb)->csb_md_lease != 0 &&
+	       m0_time_now() < ci->ci_attr_expire;
+}
+
+static void attr_lease_renew(struct m0t1fs_inode *ci)
+{
+	struct m0t1fs_sb *csb = M0T1FS_SB(ci->ci_inode.i_sb);
+
+	ci->ci_attr_expire = m0_time_from_now(0, (m0_time_t)csb->csb_md_lease *
+					      M0_TIME_ONE_MSEC);
+}
+
+static void dentry_lease_renew(struct dentry *dentry)
+{
+	struct m0t1fs_sb *csb = M0T1FS_SB(dentry->d_sb);
+
+	dentry->d_time = jiffies + msecs_to_jiffies(csb->csb_md_lease);
+}
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3,10,0)
+static int m0t1fs_d_revalidate(struct dentry *dentry, unsigned int flags)
+#else
+static int m0t1fs_d_revalidate(struct dentry *dentry, struct nameidata *nd)
+#endif
+{
+	struct m0t1fs_sb *csb = M0T1FS_SB(dentry->d_sb);
+
+	/* Does not block, can be called in rcu-walk mode. */
+	return dentry->d_inode != NULL || csb->csb_md_lease == 0 ||
+	       time_before(jiffies, dentry->d_time);
+}
+
 M0_INTERNAL void m0t1fs_inode_bob_init(struct m0t1fs_inode *bob);
 M0_INTERNAL bool m0t1fs_inode_bob_check(struct m0t1fs_inode *bob);
 
@@ -118,6 +166,8 @@ M0_INTERNAL bool m0t1fs_inode_bob_check(struct m0t1fs_inode *bob);
 static int file_lock_acquire(struct m0_rm_incoming *rm_in,
 			     struct m0t1fs_inode *ci);
 static void file_lock_release(struct m0_rm_incoming *rm_in);
+static int m0t1fs_cob_create_launch(struct m0t1fs_inode *ci,
+				    struct m0t1fs_mdop  *mop);
 static int m0t1fs_component_objects_op(struct m0t1fs_inode *ci,
 				       struct m0t1fs_mdop *mop,
 				       int (*func)(struct cob_req *,
@@ -741,7 +791,10 @@ static int m0t1fs_create(struct inode     *dir,
 		}
 	}
 	if (S_ISREG(mode) && csb->csb_oostore) {
-		rc = m0t1fs_component_objects_op(ci, &mo, m0t1fs_ios_cob_create);
+		rc = csb->csb_async_create ?
+			m0t1fs_cob_create_launch(ci, &mo) :
+			m0t1fs_component_objects_op(ci, &mo,
+						    m0t1fs_ios_cob_create);
 		if (rc != 0) {
 			i_err = true;
 			goto out;
@@ -760,6 +813,7 @@ static int m0t1fs_create(struct inode     *dir,
 	m0_mutex_unlock(&csb->csb_inodes_lock);
 	unlock_new_inode(inode);
 	mark_inode_dirty(dir);
+	attr_lease_renew(ci);
 	d_instantiate(dentry, inode);
 
 out:
@@ -871,6 +925,7 @@ static struct dentry *m0t1fs_lookup(struct inode     *dir,
 			i_err = true;
 			goto out;
 		}
+		attr_lease_renew(M0T1FS_I(inode));
 		dcache_splice = true;
 		goto out;
 	}
@@ -880,6 +935,12 @@ static struct dentry *m0t1fs_lookup(struct inode     *dir,
 	m0_buf_init(&mo.mo_attr.ca_name, (char*)dentry->d_name.name,
 		    dentry->d_name.len);
 	rc = m0t1fs_mds_cob_lookup(csb, &mo, &rep_fop);
+	if (rc == -ENOENT && csb->csb_md_lease != 0) {
+		/* Cache the negative dentry. */
+		dentry_lease_renew(dentry);
+		dcache_splice = true;
+		goto out;
+	}
 	if (rc != 0) {
 		M0_LEAVE("rc:%d", rc);
 		goto out;
@@ -893,6 +954,7 @@ static struct dentry *m0t1fs_lookup(struct inode     *dir,
 		err_ptr =  ERR_CAST(inode);
 		goto out;
 	}
+	attr_lease_renew(M0T1FS_I(inode));
 	dcache_splice = true;
 out:
 	m0_fop_put0_lock(rep_fop);
@@ -1275,6 +1337,8 @@ static int m0t1fs_unlink(struct inode *dir, struct dentry *dentry)
 	csb   = M0T1FS_SB(inode->i_sb);
 	ci    = M0T1FS_I(inode);
 
+	/* Cobs are deleted after they are created. */
+	(void)m0t1fs_inode_create_wait(ci);
 	rc = m0t1fs_fs_conf_lock(csb);
 	if (rc != 0)
 		return M0_ERR(rc);
@@ -1358,6 +1422,9 @@ static int m0t1fs_unlink(struct inode *dir, struct dentry *dentry)
 	inode_dec_link_count(inode);
 	mark_inode_dirty(dir);
 out:
+	if (rc == 0)
+		/* The dentry becomes negative. */
+		dentry_lease_renew(dentry);
 	m0_fop_put0_lock(lookup_rep_fop);
 	m0_fop_put0_lock(unlink_rep_fop);
 	m0_fop_put0_lock(setattr_rep_fop);
@@ -1493,8 +1560,17 @@ M0_INTERNAL int m0t1fs_getattr(struct vfsmount *mnt, struct dentry *dentry,
 		m0t1fs_inode_update_stat(inode, NULL, stat);
 		goto out;
 	}
+	rc = m0t1fs_inode_create_wait(ci);
+	if (rc != 0)
+		goto out;
+	if (attr_lease_is_valid(ci)) {
+		m0t1fs_inode_update_stat(inode, NULL, stat);
+		goto out;
+	}
 	if (csb->csb_oostore) {
 		rc = m0t1fs_cob_getattr(inode);
+		if (rc == 0)
+			attr_lease_renew(ci);
 		m0t1fs_inode_update_stat(inode, NULL, stat);
 		goto out;
 	}
@@ -1516,6 +1592,8 @@ M0_INTERNAL int m0t1fs_getattr(struct vfsmount *mnt, struct dentry *dentry,
 	getattr_rep = m0_fop_data(rep_fop);
 	body = &getattr_rep->g_body;
 	rc = m0t1fs_inode_update_stat(inode, body, stat);
+	if (rc == 0)
+		attr_lease_renew(ci);
 out:
 	m0_fop_put0_lock(rep_fop);
 	m0t1fs_fs_conf_unlock(csb);
@@ -1610,6 +1688,10 @@ M0_INTERNAL int m0t1fs_setattr(struct dentry *dentry, struct iattr *attr)
 	if (rc != 0)
 		return M0_ERR(rc);
 
+	rc = m0t1fs_inode_create_wait(ci);
+	if (rc != 0)
+		return M0_ERR(rc);
+
 	rc = m0t1fs_fs_conf_lock(csb);
 	if (rc != 0)
 		return M0_ERR(rc);
@@ -1712,7 +1794,8 @@ M0_INTERNAL int m0t1fs_setattr(struct dentry *dentry, struct iattr *attr)
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(3,10,0)
 	setattr_copy(inode, attr);
 	if (attr->ia_valid & ATTR_SIZE)
-		i_size_write(inode, attr->ia_size);
+		/* Drops cached pages beyond the new size. */
+		truncate_setsize(inode, attr->ia_size);
 #else
 	rc = inode_setattr(inode, attr);
 	if (rc != 0)
@@ -1830,6 +1913,68 @@ out:
 	return M0_RC(rc ?: cob_req.cr_rc);
 }
 
+/**
+ * Launches creation of the meta-data cobs of a new file and returns without
+ * waiting for the replies. Cob fops of creates following each other within
+ * COB_REQ_DEADLINE are packed into the same rpcs by the formation.
+ */
+static int m0t1fs_cob_create_launch(struct m0t1fs_inode *ci,
+				    struct m0t1fs_mdop  *mop)
+{
+	struct m0t1fs_sb *csb = M0T1FS_SB(ci->ci_inode.i_sb);
+	struct cob_req   *cr;
+	int               rc = 0;
+	int               i;
+
+	M0_ENTRY("gob "FID_F, FID_P(m0t1fs_inode_fid(ci)));
+	M0_PRE(csb->csb_oostore);
+	M0_PRE(ci->ci_create_req == NULL);
+
+	M0_ALLOC_PTR(cr);
+	if (cr == NULL)
+		return M0_ERR(-ENOMEM);
+	m0_semaphore_init(&cr->cr_sem, 0);
+	cr->cr_deadline = m0_time_from_now(0, COB_REQ_DEADLINE);
+	cr->cr_csb = csb;
+	cr->cr_rc = 0;
+	cr->cr_fid = *m0t1fs_inode_fid(ci);
+	cr->cr_pver = ci->ci_pver;
+
+	mop->mo_cob_type = M0_COB_MD;
+	for (i = 0; i < csb->csb_pools_common.pc_md_redundancy && rc == 0; i++)
+		rc = m0t1fs_ios_cob_create(cr, ci, mop, i);
+	cr->cr_nr = i;
+	/* The inode is not visible yet. */
+	ci->ci_create_req = cr;
+	if (rc != 0) {
+		(void)m0t1fs_inode_create_wait(ci);
+		return M0_ERR(rc);
+	}
+	return M0_RC(0);
+}
+
+M0_INTERNAL int m0t1fs_inode_create_wait(struct m0t1fs_inode *ci)
+{
+	struct cob_req *cr;
+	int             rc;
+
+	m0_mutex_lock(&ci->ci_create_lock);
+	cr = ci->ci_create_req;
+	if (cr != NULL) {
+		while (cr->cr_nr-- > 0)
+			m0_semaphore_down(&cr->cr_sem);
+		m0_semaphore_fini(&cr->cr_sem);
+		ci->ci_create_rc = cr->cr_rc;
+		ci->ci_create_req = NULL;
+		M0_LOG(M0_DEBUG, "Cob create "FID_F" with %d",
+		       FID_P(&cr->cr_fid), cr->cr_rc);
+		m0_free(cr);
+	}
+	rc = ci->ci_create_rc;
+	m0_mutex_unlock(&ci->ci_create_lock);
+	return rc == 0 ? 0 : M0_ERR(rc);
+}
+
 static int m0t1fs_mds_cob_fop_populate(struct m0t1fs_sb         *csb,
 				       const struct m0t1fs_mdop *mo,
 				       struct m0_fop            *fop)
@@ -2243,18 +2388,18 @@ static void cfop_release(struct m0_ref *ref)
 {
 	struct m0_fop  *fop;
 	struct cob_fop *cfop;
-	struct cob_req *creq;
 
 	M0_ENTRY();
 	M0_PRE(ref != NULL);
 
 	fop  = container_of(ref, struct m0_fop, f_ref);
 	cfop = container_of(fop, struct cob_fop, c_fop);
-	creq = cfop->c_req;
-	M0_LOG(M0_DEBUG, "%p[%u] ri_error %d, cob_req_fop %p, cr_rc %d, "
-	       FID_F, &fop->f_item, m0_fop_opcode(fop),
-	       fop->f_item.ri_error, cfop, creq->cr_rc,
-	       FID_P(&creq->cr_fid));
+	/*
+	 * cfop->c_req is not used: the request can be released by a waiter as
+	 * soon as the reply is received.
+	 */
+	M0_LOG(M0_DEBUG, "%p[%u] ri_error %d, cob_req_fop %p",
+	       &fop->f_item, m0_fop_opcode(fop), fop->f_item.ri_error, cfop);
 	m0_fop_fini(fop);
 	m0_free(cfop);
 
@@ -2606,4 +2751,8 @@ const struct inode_operations m0t1fs_fid_dir_inode_operations = {
 	.listxattr      = m0t1fs_fid_listxattr,
 };
 
+const struct dentry_operations m0t1fs_dentry_operations = {
+	.d_revalidate   = m0t1fs_d_revalidate,
+};
+
 #undef M0_TRACE_SUBSYSTEM
@@ -28,6 +28,10 @@
 #include <linux/mm.h>       /* get_user_pages, get_page, put_page */
 #include <linux/fs.h>       /* struct file_operations */
 #include <linux/mount.h>    /* struct vfsmount (f_path.mnt) */
+#include <linux/pagemap.h>  /* grab_cache_page_write_begin */
+#include <linux/writeback.h> /* write_cache_pages */
+#include <linux/highmem.h>  /* zero_user_segment */
+#include <linux/uaccess.h>  /* set_fs */
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(3,10,0)
 #include <linux/uio.h>      /* struct iovec */
 #include <linux/aio.h>      /* struct kiocb */
@@ -4487,6 +4491,12 @@ static void io_request_fini(struct io_request *req)
  *    req->ir_sns_state == SRS_REPAIR_NOTDONE
  *
  *    This should not be possible.
+ *
+ * 5. device_state == M0_PNDS_SNS_REPAIRING &&
+ *    req->ir_sns_state == SRS_REPAIR_DONE_DIRECT
+ *
+ *    Not redirected. Direct repair has rebuilt the current global fid on
+ *    the replacement device, so the pages are sent to the device itself.
  */
 static bool should_spare_be_mapped(struct io_request  *req,
 				   enum m0_pool_nd_state dev_state)
@@ -4606,7 +4616,9 @@ static int nw_xfer_tioreq_map(struct nw_xfer_request           *xfer,
 
 	if (M0_IN(ioreq_sm_state(req), (IRS_DEGRADED_READING,
 					IRS_DEGRADED_WRITING)) &&
-	    dev_state != M0_PNDS_SNS_REPAIRED)
+	    dev_state != M0_PNDS_SNS_REPAIRED &&
+	    !(dev_state == M0_PNDS_SNS_REPAIRING &&
+	      req->ir_sns_state == SRS_REPAIR_DONE_DIRECT))
 		(*tio)->ti_state = dev_state;
 
 	return M0_RC(rc);
@@ -5071,6 +5083,9 @@ M0_INTERNAL ssize_t m0t1fs_aio(struct kiocb             *kcb,
 	M0_PRE(M0_IN(rw, (IRT_READ, IRT_WRITE)));
 
 	csb   = file_to_sb(kcb->ki_filp);
+	rc = m0t1fs_inode_create_wait(m0t1fs_file_to_m0inode(kcb->ki_filp));
+	if (rc != 0)
+		return M0_ERR(rc);
 again:
 	M0_ALLOC_PTR(req);
 	if (req == NULL)
@@ -5167,8 +5182,396 @@ static struct m0_indexvec_varr *indexvec_create(unsigned long       seg_nr,
 	return ivv;
 }
 
+/* ----------------------------------------------------------------
+ * Page cache
+ * ---------------------------------------------------------------- */
+
+/*
+ * In pagecache mode buffered reads and writes go through the page cache:
+ * reads are served by generic kernel code, which fetches the missing pages
+ * with m0t1fs_readpages() and read-ahead, and writes dirty the pages, which
+ * are written back by m0t1fs_writepages(). Contiguous pages are transferred
+ * by a single io_request. Writeback splits dirty pages at parity group
+ * boundaries, so that fully dirty groups are written without read-modify-write.
+ *
+ * io_request is bound to an open file, while writeback is not. The inode
+ * keeps a reference to one of its open files for that (m0t1fs_inode::
+ * ci_pc_file), which is set when pages are dirtied and dropped when the file
+ * is closed, after dirty pages are written back. Shared writable mappings are
+ * not supported.
+ */
+
+enum {
+	/** Maximal number of pages transferred by a page cache io_request. */
+	M0T1FS_PAGECACHE_PAGES_MAX = 1024
+};
+
+static uint64_t inode_grp_pages(struct inode *inode)
+{
+	struct m0_pdclust_layout *play;
+
+	play = m0_layout_to_pdl(M0T1FS_I(inode)->ci_layout_instance->li_l);
+	return max64u(data_size(play) >> PAGE_SHIFT, 1);
+}
+
+M0_INTERNAL void m0t1fs_pagecache_file_set(struct file *file)
+{
+	struct m0t1fs_inode *ci = m0t1fs_file_to_m0inode(file);
+
+	if (!file_to_sb(file)->csb_pagecache)
+		return;
+	m0_mutex_lock(&ci->ci_pc_lock);
+	if (ci->ci_pc_file == NULL)
+		ci->ci_pc_file = get_file(file);
+	m0_mutex_unlock(&ci->ci_pc_lock);
+}
+
+/** Returns a referenced file to write the inode pages back, or NULL. */
+static struct file *pagecache_file_get(struct inode *inode)
+{
+	struct m0t1fs_inode *ci = M0T1FS_I(inode);
+	struct file         *file;
+
+	m0_mutex_lock(&ci->ci_pc_lock);
+	file = ci->ci_pc_file;
+	if (file != NULL)
+		get_file(file);
+	m0_mutex_unlock(&ci->ci_pc_lock);
+	return file;
+}
+
+M0_INTERNAL int m0t1fs_pagecache_release(struct file *file)
+{
+	struct m0t1fs_inode *ci = m0t1fs_file_to_m0inode(file);
+	struct file         *used = NULL;
+	int                  rc;
+
+	if (!file_to_sb(file)->csb_pagecache)
+		return 0;
+	m0t1fs_pagecache_file_set(file);
+	rc = filemap_write_and_wait(file->f_mapping);
+	m0_mutex_lock(&ci->ci_pc_lock);
+	if (ci->ci_pc_file == file) {
+		used = file;
+		ci->ci_pc_file = NULL;
+	}
+	m0_mutex_unlock(&ci->ci_pc_lock);
+	if (used != NULL)
+		fput(used);
+	return M0_RC(rc);
+}
+
+/**
+ * Transfers contiguous pages with a single io_request. Only the part of the
+ * pages below "size" is transferred.
+ */
+static int pagecache_io(struct file *file, struct page **pages, int nr,
+			loff_t size, enum io_req_type rw)
+{
+	struct m0_indexvec_varr *ivv;
+	struct iovec            *iov;
+	struct kiocb             kcb;
+	mm_segment_t             fs;
+	loff_t                   pos = page_offset(pages[0]);
+	ssize_t                  count = 0;
+	ssize_t                  res = 0;
+	int                      seg_nr;
+	int                      i;
+
+	M0_ENTRY("pos=%lld nr=%d rw=%d", (long long)pos, nr, rw);
+	M0_ALLOC_ARR(iov, nr);
+	if (iov == NULL)
+		return M0_ERR(-ENOMEM);
+	for (i = 0; i < nr && pos + i * PAGE_SIZE < size; ++i) {
+		iov[i].iov_base = kmap(pages[i]);
+		iov[i].iov_len  = min_t(loff_t, PAGE_SIZE,
+					size - pos - i * PAGE_SIZE);
+		count += iov[i].iov_len;
+	}
+	seg_nr = i;
+	if (seg_nr > 0) {
+		ivv = indexvec_create(seg_nr, iov, pos);
+		if (ivv != NULL) {
+			init_sync_kiocb(&kcb, file);
+			/* io_request copies data with {from,to}_user calls. */
+			fs = get_fs();
+			set_fs(KERNEL_DS);
+			res = m0t1fs_aio(&kcb, iov, ivv, rw);
+			set_fs(fs);
+			m0_indexvec_varr_free(ivv);
+			m0_free(ivv);
+		} else
+			res = -ENOMEM;
+	}
+	for (i = 0; i < seg_nr; ++i)
+		kunmap(pages[i]);
+	m0_free(iov);
+	if (res >= 0 && res != count)
+		res = -EIO;
+	return res < 0 ? M0_ERR(res) : M0_RC(0);
+}
+
+/** Reads locked contiguous pages, zeroing them beyond EOF. */
+static int pagecache_read(struct file *file, struct page **pages, int nr)
+{
+	loff_t size = i_size_read(pages[0]->mapping->host);
+	loff_t off;
+	int    rc;
+	int    i;
+
+	rc = file == NULL ? -EINVAL : pagecache_io(file, pages, nr, size,
+						   IRT_READ);
+	for (i = 0; i < nr; ++i) {
+		if (rc != 0) {
+			SetPageError(pages[i]);
+			continue;
+		}
+		off = size - page_offset(pages[i]);
+		if (off < PAGE_SIZE)
+			zero_user_segment(pages[i], max_t(loff_t, off, 0),
+					  PAGE_SIZE);
+		SetPageUptodate(pages[i]);
+	}
+	return rc;
+}
+
+static int m0t1fs_readpage(struct file *file, struct page *page)
+{
+	int rc;
+
+	M0_THREAD_ENTER;
+	rc = pagecache_read(file, &page, 1);
+	unlock_page(page);
+	return rc;
+}
+
+static void pagecache_read_run(struct file *file, struct page **pages,
+			       int nr)
+{
+	int i;
+
+	if (nr == 0)
+		return;
+	(void)pagecache_read(file, pages, nr);
+	for (i = 0; i < nr; ++i) {
+		unlock_page(pages[i]);
+		put_page(pages[i]);
+	}
+}
+
+/** Reads the pages of a read-ahead window, contiguous runs at once. */
+static int m0t1fs_readpages(struct file *file, struct address_space *mapping,
+			    struct list_head *pages, unsigned nr_pages)
+{
+	struct page **run;
+	struct page  *page;
+	int           nr = 0;
+
+	M0_THREAD_ENTER;
+	M0_ENTRY("nr_pages=%u", nr_pages);
+	M0_ALLOC_ARR(run, nr_pages);
+	if (run == NULL)
+		/* Pages are read by m0t1fs_readpage(). */
+		return M0_ERR(-ENOMEM);
+	while (!list_empty(pages)) {
+		page = list_entry(pages->prev, struct page, lru);
+		list_del(&page->lru);
+		if (add_to_page_cache_lru(page, mapping, page->index,
+					  mapping_gfp_mask(mapping)) != 0) {
+			put_page(page);
+			continue;
+		}
+		if (nr > 0 && page->index != run[nr - 1]->index + 1) {
+			pagecache_read_run(file, run, nr);
+			nr = 0;
+		}
+		run[nr++] = page;
+	}
+	pagecache_read_run(file, run, nr);
+	m0_free(run);
+	return M0_RC(0);
+}
+
+/** Lets read-ahead fetch a parity group at once. */
+static void pagecache_ra_init(struct file *file)
+{
+	uint64_t pages = min64u(inode_grp_pages(m0t1fs_file_to_inode(file)),
+				M0T1FS_PAGECACHE_PAGES_MAX);
+
+	if (file->f_ra.ra_pages < pages)
+		file->f_ra.ra_pages = pages;
+}
+
+static int m0t1fs_write_begin(struct file *file, struct address_space *mapping,
+			      loff_t pos, unsigned len, unsigned flags,
+			      struct page **pagep, void **fsdata)
+{
+	struct page *page;
+	unsigned     from = pos & (PAGE_SIZE - 1);
+	int          rc;
+
+	M0_THREAD_ENTER;
+	m0t1fs_pagecache_file_set(file);
+	page = grab_cache_page_write_begin(mapping, pos >> PAGE_SHIFT, flags);
+	if (page == NULL)
+		return M0_ERR(-ENOMEM);
+	if (!PageUptodate(page) && len != PAGE_SIZE) {
+		if (page_offset(page) >= i_size_read(mapping->host)) {
+			zero_user_segments(page, 0, from,
+					   from + len, PAGE_SIZE);
+		} else {
+			/* The page is partially overwritten. */
+			rc = pagecache_read(file, &page, 1);
+			if (rc != 0) {
+				unlock_page(page);
+				put_page(page);
+				return M0_ERR(rc);
+			}
+		}
+	}
+	*pagep = page;
+	return 0;
+}
+
+static int m0t1fs_write_end(struct file *file, struct address_space *mapping,
+			    loff_t pos, unsigned len, unsigned copied,
+			    struct page *page, void *fsdata)
+{
+	struct inode *inode = mapping->host;
+
+	M0_THREAD_ENTER;
+	if (!PageUptodate(page)) {
+		/* The rest of the page is not valid, the write is retried. */
+		if (copied < len)
+			copied = 0;
+		else
+			SetPageUptodate(page);
+	}
+	if (copied > 0) {
+		if (pos + copied > i_size_read(inode))
+			i_size_write(inode, pos + copied);
+		set_page_dirty(page);
+	}
+	unlock_page(page);
+	put_page(page);
+	return copied;
+}
+
+/** Dirty pages being written back. */
+struct pagecache_wb {
+	struct file  *pw_file;
+	struct page **pw_pages;
+	int           pw_nr;
+	/** Pages in a parity group, at most M0T1FS_PAGECACHE_PAGES_MAX. */
+	int           pw_max;
+	int           pw_rc;
+};
+
+static void pagecache_wb_flush(struct pagecache_wb *wb)
+{
+	struct page *page;
+	int          rc;
+	int          i;
+
+	if (wb->pw_nr == 0)
+		return;
+	page = wb->pw_pages[0];
+	rc = pagecache_io(wb->pw_file, wb->pw_pages, wb->pw_nr,
+			  i_size_read(page->mapping->host), IRT_WRITE);
+	for (i = 0; i < wb->pw_nr; ++i) {
+		page = wb->pw_pages[i];
+		if (rc != 0) {
+			SetPageError(page);
+			mapping_set_error(page->mapping, rc);
+		}
+		end_page_writeback(page);
+	}
+	wb->pw_rc = wb->pw_rc ?: rc;
+	wb->pw_nr = 0;
+}
+
+/** Adds a locked page cleaned for i/o to the parity group being written. */
+static int pagecache_wb_add(struct page *page, struct writeback_control *wbc,
+			    void *data)
+{
+	struct pagecache_wb *wb = data;
+
+	if (wb->pw_nr > 0 &&
+	    (page->index != wb->pw_pages[wb->pw_nr - 1]->index + 1 ||
+	     page->index % wb->pw_max == 0))
+		pagecache_wb_flush(wb);
+	if (page_offset(page) >= i_size_read(page->mapping->host)) {
+		/* Truncated. */
+		unlock_page(page);
+		return 0;
+	}
+	set_page_writeback(page);
+	unlock_page(page);
+	wb->pw_pages[wb->pw_nr++] = page;
+	if (wb->pw_nr == wb->pw_max)
+		pagecache_wb_flush(wb);
+	return 0;
+}
+
+static int m0t1fs_writepages(struct address_space     *mapping,
+			     struct writeback_control *wbc)
+{
+	struct pagecache_wb wb = {};
+	int                 rc;
+
+	M0_THREAD_ENTER;
+	M0_ENTRY();
+	wb.pw_file = pagecache_file_get(mapping->host);
+	if (wb.pw_file == NULL)
+		/* Pages are written when a file is closed or synced. */
+		return M0_RC(0);
+	wb.pw_max = min64u(inode_grp_pages(mapping->host),
+			   M0T1FS_PAGECACHE_PAGES_MAX);
+	M0_ALLOC_ARR(wb.pw_pages, wb.pw_max);
+	if (wb.pw_pages == NULL) {
+		fput(wb.pw_file);
+		return M0_ERR(-ENOMEM);
+	}
+	rc = write_cache_pages(mapping, wbc, pagecache_wb_add, &wb);
+	pagecache_wb_flush(&wb);
+	m0_free(wb.pw_pages);
+	fput(wb.pw_file);
+	return M0_RC(rc ?: wb.pw_rc);
+}
+
+static int m0t1fs_writepage(struct page *page, struct writeback_control *wbc)
+{
+	struct page        *pages[1];
+	struct pagecache_wb wb = {
+		.pw_pages = pages,
+		.pw_max   = 1
+	};
+
+	M0_THREAD_ENTER;
+	wb.pw_file = pagecache_file_get(page->mapping->host);
+	if (wb.pw_file == NULL) {
+		redirty_page_for_writepage(wbc, page);
+		unlock_page(page);
+		return 0;
+	}
+	(void)pagecache_wb_add(page, wbc, &wb);
+	fput(wb.pw_file);
+	return wb.pw_rc;
+}
+
+static int m0t1fs_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	if (!file_to_sb(file)->csb_pagecache)
+		return -ENODEV;
+	return generic_file_readonly_mmap(file, vma);
+}
+
+/*
+ * Direct i/o and page cache writes go through the generic kernel code, which
+ * calls m0t1fs_aops methods.
+ */
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(3,16,0)
-static ssize_t file_dio_write(struct kiocb *kcb, struct iov_iter *from)
+static ssize_t file_generic_write(struct kiocb *kcb, struct iov_iter *from)
 {
 	struct file  *file  = kcb->ki_filp;
 	struct inode *inode = m0t1fs_file_to_inode(file);
@@ -5188,10 +5591,10 @@ static ssize_t file_dio_write(struct kiocb *kcb, struct iov_iter *from)
 	return written;
 }
 #else
-static ssize_t file_dio_write(struct kiocb       *kcb,
-			      const struct iovec *iov,
-			      unsigned long       seg_nr,
-			      loff_t              pos)
+static ssize_t file_generic_write(struct kiocb       *kcb,
+				  const struct iovec *iov,
+				  unsigned long       seg_nr,
+				  loff_t              pos)
 {
 	struct file  *file  = kcb->ki_filp;
 	struct inode *inode = m0t1fs_file_to_inode(file);
@@ -5237,8 +5640,9 @@ static ssize_t aio_write(struct kiocb *kcb, struct iov_iter *from)
 		return 0;
 	}
 
-	if (kcb->ki_filp->f_flags & O_DIRECT) {
-		written = file_dio_write(kcb, from);
+	if (kcb->ki_filp->f_flags & O_DIRECT ||
+	    file_to_sb(kcb->ki_filp)->csb_pagecache) {
+		written = file_generic_write(kcb, from);
 		M0_LEAVE();
 		return written;
 	}
@@ -5300,8 +5704,9 @@ static ssize_t aio_write(struct kiocb *kcb, const struct iovec *iov,
 	if (count != saved_count)
 		seg_nr = iov_shorten((struct iovec *)iov, seg_nr, count);
 
-	if (kcb->ki_filp->f_flags & O_DIRECT) {
-		written = file_dio_write(kcb, iov, seg_nr, pos);
+	if (kcb->ki_filp->f_flags & O_DIRECT ||
+	    file_to_sb(kcb->ki_filp)->csb_pagecache) {
+		written = file_generic_write(kcb, iov, seg_nr, pos);
 		M0_LEAVE();
 		return written;
 	}
@@ -5385,6 +5790,13 @@ static ssize_t aio_read(struct kiocb *kcb, struct iov_iter *from)
 		return res;
 	}
 
+	if (file_to_sb(filp)->csb_pagecache) {
+		pagecache_ra_init(filp);
+		res = generic_file_read_iter(kcb, from);
+		M0_LEAVE();
+		return res;
+	}
+
 	count = iov_iter_count(from);
 	if (count == 0)
 		/*
@@ -5465,6 +5877,13 @@ static ssize_t aio_read(struct kiocb *kcb, const struct iovec *iov,
 		return res;
 	}
 
+	if (file_to_sb(filp)->csb_pagecache) {
+		pagecache_ra_init(filp);
+		res = generic_file_aio_read(kcb, iov, seg_nr, pos);
+		M0_LEAVE();
+		return res;
+	}
+
 	/*
 	 * Checks for access privileges and adjusts all segments
 	 * for proper count and total number of segments.
@@ -5565,6 +5984,9 @@ int m0t1fs_flush(struct file *file, fl_owner_t id)
 		 atomic_read(&inode->i_writecount),
 		 (unsigned int)inode->i_size);
 
+	rc = m0t1fs_pagecache_release(file);
+	if (rc != 0)
+		return M0_ERR(rc);
 	if (!csb->csb_oostore || inode->i_nlink == 0 ||
 	    atomic_read(&inode->i_writecount) == 0)
 		return M0_RC(0);
@@ -5601,6 +6023,7 @@ const struct file_operations m0t1fs_reg_file_operations = {
 #endif
 	.fsync          = m0t1fs_fsync,
 	.flush          = m0t1fs_flush,
+	.mmap           = m0t1fs_mmap,
 };
 
 static void client_passive_recv(const struct m0_net_buffer_event *evt)
@@ -6869,7 +7292,14 @@ static ssize_t m0t1fs_direct_IO(int rw,
 #endif
 
 const struct address_space_operations m0t1fs_aops = {
-	.direct_IO = m0t1fs_direct_IO,
+	.direct_IO      = m0t1fs_direct_IO,
+	.readpage       = m0t1fs_readpage,
+	.readpages      = m0t1fs_readpages,
+	.writepage      = m0t1fs_writepage,
+	.writepages     = m0t1fs_writepages,
+	.write_begin    = m0t1fs_write_begin,
+	.write_end      = m0t1fs_write_end,
+	.set_page_dirty = __set_page_dirty_nobuffers,
 };
 
 #undef M0_TRACE_SUBSYSTEM
@@ -365,6 +365,11 @@ int m0t1fs_fsync(struct file *file, struct dentry *dentry, int datasync)
 	M0_PRE(file != NULL);
 	inode = m0t1fs_file_to_m0inode(file);
 	M0_PRE(inode != NULL);
+	/* Lets writeback of the page cache use this file. */
+	m0t1fs_pagecache_file_set(file);
+	rc = m0t1fs_inode_create_wait(inode);
+	if (rc != 0)
+		return M0_ERR(rc);
 
 	/*
 	 * push any relevant changes we don't know about through m0t1fs_aio
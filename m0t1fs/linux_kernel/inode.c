@@ -184,8 +184,14 @@ static void m0t1fs_inode_init(struct m0t1fs_inode *ci)
 	M0_SET0(&ci->ci_fowner);
 	ci->ci_layout_instance = NULL;
 	ci->ci_layout_changed = false;
+	ci->ci_pc_file = NULL;
+	ci->ci_attr_expire = 0;
+	ci->ci_create_req = NULL;
+	ci->ci_create_rc = 0;
 	m0_mutex_init(&ci->ci_layout_lock);
 	m0_mutex_init(&ci->ci_pending_tx_lock);
+	m0_mutex_init(&ci->ci_pc_lock);
+	m0_mutex_init(&ci->ci_create_lock);
 	ispti_tlist_init(&ci->ci_pending_tx);
 	m0t1fs_inode_bob_init(ci);
 	csb_inodes_tlink_init(ci);
@@ -225,6 +231,10 @@ static void m0t1fs_inode_fini(struct m0t1fs_inode *ci)
 	m0t1fs_inode_bob_fini(ci);
 	/* Empty the list, then free the list lock */
 	m0t1fs_inode_ispti_fini(ci);
+	M0_ASSERT(ci->ci_pc_file == NULL);
+	M0_ASSERT(ci->ci_create_req == NULL);
+	m0_mutex_fini(&ci->ci_create_lock);
+	m0_mutex_fini(&ci->ci_pc_lock);
 	m0_mutex_fini(&ci->ci_pending_tx_lock);
 	m0_mutex_fini(&ci->ci_layout_lock);
 	M0_LEAVE();
@@ -260,6 +270,8 @@ M0_INTERNAL void m0t1fs_destroy_inode(struct inode *inode)
 	M0_THREAD_ENTER;
 
 	M0_ENTRY("inode: %p, fid: "FID_F, inode, FID_P(fid));
+	/* Replies of cob creates reference the request. */
+	(void)m0t1fs_inode_create_wait(ci);
 	if (m0_fid_is_set(fid) && !m0t1fs_inode_is_root(inode)) {
 		/**
 		 * The function is called by kernel, and thus can be called
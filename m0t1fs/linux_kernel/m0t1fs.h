@@ -636,6 +636,7 @@
  */
 
 struct m0_pdclust_layout;
+struct cob_req;
 
 M0_INTERNAL int m0t1fs_init(void);
 M0_INTERNAL void m0t1fs_fini(void);
@@ -736,6 +737,19 @@ struct m0t1fs_sb {
 	bool                                    csb_oostore;
 	/** verify mode: verify parity on read */
 	bool                                    csb_verify;
+	/** pagecache mode: buffered i/o goes through the page cache */
+	bool                                    csb_pagecache;
+	/**
+	 * Metadata lease in milliseconds: for how long inode attributes and
+	 * negative dentries fetched from services are used without
+	 * revalidation. 0 (the default) disables caching.
+	 */
+	uint32_t                                csb_md_lease;
+	/**
+	 * oostore mode: creation of a file does not wait for its meta-data
+	 * cobs to be created, see m0t1fs_inode_create_wait().
+	 */
+	bool                                    csb_async_create;
 
 	/** HA service context. */
 	struct m0_reqh_service_ctx             *csb_ha_rsctx;
@@ -844,6 +858,21 @@ struct m0t1fs_inode {
 	struct m0_tlink            ci_sb_linkage;
 	/* Has layout been changed via setfattr? */
 	bool                       ci_layout_changed;
+	/**
+	 * An open file of the inode used for writeback of its dirty pages in
+	 * pagecache mode, see m0t1fs_pagecache_file_set().
+	 */
+	struct file               *ci_pc_file;
+	/** Protects ci_pc_file. */
+	struct m0_mutex            ci_pc_lock;
+	/** Cached attributes are valid till then, see csb_md_lease. */
+	m0_time_t                  ci_attr_expire;
+	/** Cob creates of the file not waited for, if any. */
+	struct cob_req            *ci_create_req;
+	/** Result of the cob creates, once waited for. */
+	int                        ci_create_rc;
+	/** Protects ci_create_req and ci_create_rc. */
+	struct m0_mutex            ci_create_lock;
 };
 
 M0_TL_DESCR_DECLARE(csb_inodes, M0_EXTERN);
@@ -872,6 +901,8 @@ extern const struct inode_operations m0t1fs_reg_inode_operations;
 
 extern const struct address_space_operations m0t1fs_aops;
 
+extern const struct dentry_operations m0t1fs_dentry_operations;
+
 /* super.c */
 
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(3,10,0)
@@ -1036,6 +1067,25 @@ M0_INTERNAL int m0t1fs_mds_cob_delxattr(struct m0t1fs_sb            *csb,
 M0_INTERNAL int m0t1fs_size_update(struct dentry *dentry,
 				   uint64_t newsize);
 
+/**
+ * Makes the file usable for writeback of the inode dirty pages in pagecache
+ * mode: pages are written back with one of the open files of the inode.
+ */
+M0_INTERNAL void m0t1fs_pagecache_file_set(struct file *file);
+
+/**
+ * Writes the dirty pages of the inode back and waits for completion. The file
+ * is not used for writeback anymore. Called when the file is closed.
+ */
+M0_INTERNAL int m0t1fs_pagecache_release(struct file *file);
+
+/**
+ * Waits for the cob creates launched by the creation of the file in
+ * csb_async_create mode and returns their result. Called before the file is
+ * used for anything depending on its cobs.
+ */
+M0_INTERNAL int m0t1fs_inode_create_wait(struct m0t1fs_inode *ci);
+
 M0_INTERNAL int m0t1fs_inode_set_layout_id(struct m0t1fs_inode *ci,
 					   struct m0t1fs_mdop *mo,
 			    		   int layout_id);
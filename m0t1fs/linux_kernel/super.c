@@ -254,6 +254,9 @@ enum m0t1fs_mntopts {
 	M0T1FS_MNTOPT_EP,
 	M0T1FS_MNTOPT_OOSTORE,
 	M0T1FS_MNTOPT_VERIFY,
+	M0T1FS_MNTOPT_PAGECACHE,
+	M0T1FS_MNTOPT_MD_LEASE,
+	M0T1FS_MNTOPT_ASYNC_CREATE,
 	M0T1FS_MNTOPT_ERR
 };
 
@@ -265,6 +268,9 @@ static const match_table_t m0t1fs_mntopt_tokens = {
 	{ M0T1FS_MNTOPT_EP,         "ep=%s"         },
 	{ M0T1FS_MNTOPT_OOSTORE,    "oostore"       },
 	{ M0T1FS_MNTOPT_VERIFY,     "verify"        },
+	{ M0T1FS_MNTOPT_PAGECACHE,  "pagecache"     },
+	{ M0T1FS_MNTOPT_MD_LEASE,   "md_lease=%s"   },
+	{ M0T1FS_MNTOPT_ASYNC_CREATE, "async_create" },
 	/* match_token() requires 2nd field of the last element to be NULL */
 	{ M0T1FS_MNTOPT_ERR, NULL }
 };
@@ -399,6 +405,21 @@ static int mount_opts_parse(struct m0t1fs_sb *csb, char *options,
 			csb->csb_verify = true;
 			M0_LOG(M0_DEBUG, "Parity verify mode!!");
 			break;
+		case M0T1FS_MNTOPT_PAGECACHE:
+			csb->csb_pagecache = true;
+			M0_LOG(M0_DEBUG, "Page cache mode");
+			break;
+		case M0T1FS_MNTOPT_MD_LEASE:
+			rc = num_parse(&csb->csb_md_lease, args);
+			if (rc != 0)
+				goto out;
+			M0_LOG(M0_INFO, "md_lease: %lu ms",
+			       (unsigned long)csb->csb_md_lease);
+			break;
+		case M0T1FS_MNTOPT_ASYNC_CREATE:
+			csb->csb_async_create = true;
+			M0_LOG(M0_DEBUG, "Asynchronous create mode");
+			break;
 		default:
 			return M0_ERR_INFO(-EINVAL, "Unsupported option: %s", op);
 		}
@@ -433,6 +454,9 @@ M0_INTERNAL void m0t1fs_sb_init(struct m0t1fs_sb *csb)
 	m0_atomic64_set(&csb->csb_pending_io_nr, 0);
 	csb->csb_oostore = false;
 	csb->csb_verify  = false;
+	csb->csb_pagecache = false;
+	csb->csb_md_lease = 0;
+	csb->csb_async_create = false;
 	csb->csb_reqs_nr = 0;
 	csb->csb_confc_state.cus_state = M0_CC_REVOKED;
 	m0_mutex_init(&csb->csb_confc_state.cus_lock);
@@ -1311,6 +1335,7 @@ static int m0t1fs_fill_super(struct super_block *sb, void *data,
 	sb->s_blocksize_bits = PAGE_SHIFT;
 	sb->s_maxbytes       = MAX_LFS_FILESIZE;
 	sb->s_op             = &m0t1fs_super_operations;
+	sb->s_d_op           = &m0t1fs_dentry_operations;
 #if LINUX_VERSION_CODE < KERNEL_VERSION(3,10,0)
 	/* for .sync_fs() callback to be called by kernel */
 	sb->s_bdi = NULL;
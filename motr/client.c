@@ -33,6 +33,8 @@
 #include "motr/client_internal.h"
 #include "motr/layout.h"
 #include "motr/sync.h"
+#include "motr/wbc.h"
+#include "motr/ra.h"
 
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_CLIENT
 #include "lib/trace.h"
@@ -424,6 +426,9 @@ void m0_obj_init(struct m0_obj *obj,
 	obj_size = obj->ob_attr.oa_buf_size;
 	obj->ob_attr.oa_layout_id = obj_size == 0 && layout_id == 0 ?
 					M0_DEFAULT_LAYOUT_ID : layout_id;
+	obj->ob_wbc = NULL;
+	obj->ob_ra = NULL;
+	obj->ob_inline = NULL;
 
 #ifdef OSYNC
 	m0_mutex_init(&obj->ob_pending_tx_lock);
@@ -471,6 +476,9 @@ void m0_obj_fini(struct m0_obj *obj)
 	M0_ENTRY();
 	M0_PRE(obj != NULL);
 
+	(void)m0_obj_wbc_disable(obj);
+	m0_obj_ra_disable(obj);
+	m0__obj_inline_fini(obj);
 	/* Cleanup layout. */
 	if (obj->ob_layout != NULL) {
 		m0_client__layout_put(obj->ob_layout);
@@ -727,8 +735,10 @@ void m0_op_launch(struct m0_op **op, uint32_t nr)
 	M0_ENTRY();
 	M0_PRE(op != NULL);
 
+	m0__idx_batch_begin(op, nr);
 	for (i = 0; i < nr; i++)
 		m0_op_launch_one(op[i]);
+	m0__idx_batch_end(op, nr);
 
 	M0_LEAVE();
 }
@@ -762,6 +772,105 @@ int32_t m0_op_wait(struct m0_op *op, uint64_t bits,
 }
 M0_EXPORTED(m0_op_wait);
 
+M0_TL_DESCR_DEFINE(cq, "completed ops", static, struct m0_op,
+		   op_cq_linkage, op_cq_magic, M0_OP_CQ_MAGIC,
+		   M0_OP_CQ_HEAD_MAGIC);
+M0_TL_DEFINE(cq, static, struct m0_op);
+
+/** Queues the operation when it completes. Called under op_sm_group. */
+static bool op_cq_clink_cb(struct m0_clink *clink)
+{
+	struct m0_op *op = container_of(clink, struct m0_op, op_cq_clink);
+	struct m0_cq *cq = op->op_cq;
+
+	if (M0_IN(op->op_sm.sm_state, (M0_OS_STABLE, M0_OS_FAILED))) {
+		m0_mutex_lock(&cq->cq_lock);
+		if (!cq_tlink_is_in(op)) {
+			cq_tlist_add_tail(&cq->cq_done, op);
+			m0_cond_signal(&cq->cq_cond);
+		}
+		m0_mutex_unlock(&cq->cq_lock);
+	}
+	return true;
+}
+
+/** Detaches the operation from its completion queue, if any. */
+static void op_cq_del(struct m0_op *op)
+{
+	struct m0_cq *cq = op->op_cq;
+
+	if (cq == NULL)
+		return;
+	m0_clink_del_lock(&op->op_cq_clink);
+	m0_clink_fini(&op->op_cq_clink);
+	m0_mutex_lock(&cq->cq_lock);
+	if (cq_tlink_is_in(op))
+		cq_tlist_del(op);
+	M0_CNT_DEC(cq->cq_nr);
+	m0_mutex_unlock(&cq->cq_lock);
+	cq_tlink_fini(op);
+	op->op_cq = NULL;
+}
+
+void m0_cq_init(struct m0_cq *cq)
+{
+	M0_PRE(cq != NULL);
+
+	m0_mutex_init(&cq->cq_lock);
+	m0_cond_init(&cq->cq_cond, &cq->cq_lock);
+	cq_tlist_init(&cq->cq_done);
+	cq->cq_nr = 0;
+}
+M0_EXPORTED(m0_cq_init);
+
+void m0_cq_fini(struct m0_cq *cq)
+{
+	M0_PRE(cq->cq_nr == 0);
+
+	cq_tlist_fini(&cq->cq_done);
+	m0_cond_fini(&cq->cq_cond);
+	m0_mutex_fini(&cq->cq_lock);
+}
+M0_EXPORTED(m0_cq_fini);
+
+void m0_op_cq_set(struct m0_op *op, struct m0_cq *cq)
+{
+	M0_PRE(op != NULL && cq != NULL);
+	M0_PRE(op->op_sm.sm_state == M0_OS_INITIALISED);
+	M0_PRE(op->op_cq == NULL);
+
+	op->op_cq = cq;
+	cq_tlink_init(op);
+	m0_mutex_lock(&cq->cq_lock);
+	M0_CNT_INC(cq->cq_nr);
+	m0_mutex_unlock(&cq->cq_lock);
+	m0_clink_init(&op->op_cq_clink, &op_cq_clink_cb);
+	m0_clink_add_lock(&op->op_sm.sm_chan, &op->op_cq_clink);
+}
+M0_EXPORTED(m0_op_cq_set);
+
+int m0_cq_poll(struct m0_cq *cq, struct m0_op **ops, uint32_t nr,
+	       m0_time_t deadline)
+{
+	struct m0_op *op;
+	uint32_t      i = 0;
+
+	M0_ENTRY("cq=%p nr=%u", cq, nr);
+	M0_PRE(ops != NULL && nr > 0);
+
+	m0_mutex_lock(&cq->cq_lock);
+	while (cq_tlist_is_empty(&cq->cq_done) &&
+	       m0_cond_timedwait(&cq->cq_cond, deadline))
+		;
+	while (i < nr && (op = cq_tlist_pop(&cq->cq_done)) != NULL)
+		ops[i++] = op;
+	m0_mutex_unlock(&cq->cq_lock);
+
+	M0_LEAVE("reaped=%u", i);
+	return i;
+}
+M0_EXPORTED(m0_cq_poll);
+
 /**
  * Allocates memory for an operation.
  *
@@ -842,6 +951,7 @@ M0_INTERNAL int m0_op_init(struct m0_op *op,
 	spti_tlist_init(&op->op_pending_tx);
 	op->op_cancelling = false;
 	m0_semaphore_init(&op->op_sema, 0);
+	op->op_cq = NULL;
 
 	return M0_RC(0);
 }
@@ -873,6 +983,7 @@ void m0_op_fini(struct m0_op *op)
 	spti_tlist_fini(&op->op_pending_tx);
 	m0_mutex_fini(&op->op_pending_tx_lock);
 
+	op_cq_del(op);
 	grp = &op->op_sm_group;
 	m0_sm_group_lock(grp);
 	m0_sm_fini(&op->op_sm);
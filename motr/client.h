@@ -27,6 +27,7 @@
 
 #include "lib/vec.h"
 #include "lib/types.h"
+#include "lib/cond.h"           /* struct m0_cond */
 #include "sm/sm.h"             /* struct m0_sm */
 #include "rpc/rpc_machine.h"   /* M0_RPC_DEF_MAX_RPC_MSG_SIZE */
 #include "fid/fid.h"
@@ -725,6 +726,37 @@ struct m0_op {
 	 */
 	void                          *op_priv;
 	struct m0_mutex                op_priv_lock;
+
+	/** Completion queue the operation is associated with, or NULL. */
+	struct m0_cq                  *op_cq;
+	/** Added to op_sm.sm_chan when op_cq is set. */
+	struct m0_clink                op_cq_clink;
+	/** Linkage into m0_cq::cq_done. */
+	struct m0_tlink                op_cq_linkage;
+	uint64_t                       op_cq_magic;
+};
+
+/**
+ * Completion queue.
+ *
+ * Operations associated with a completion queue (m0_op_cq_set()) are queued
+ * to it when they reach M0_OS_STABLE or M0_OS_FAILED. The application reaps
+ * completed operations in batches with m0_cq_poll(), instead of waiting on
+ * every operation. Together with m0_op_launch() of an array of operations
+ * this allows a single thread to keep many operations in flight.
+ *
+ * A completed operation stays in the queue until it is reaped or
+ * finalised. m0_op_fini() removes the operation from its queue.
+ */
+struct m0_cq {
+	/** Protects all fields below. */
+	struct m0_mutex cq_lock;
+	/** Signalled when an operation is queued. */
+	struct m0_cond  cq_cond;
+	/** Completed operations not reaped yet. */
+	struct m0_tl    cq_done;
+	/** Number of operations associated with the queue. */
+	uint64_t        cq_nr;
 };
 
 /**
@@ -827,12 +859,21 @@ enum m0_client_layout_type {
  * attributes.
  */
 struct m0_client_layout;
+struct m0_obj_wbc;
+struct m0_obj_ra;
+struct m0_obj_inline;
 struct m0_obj {
 	struct m0_entity          ob_entity;
 	struct m0_obj_attr        ob_attr;
 	struct m0_client_layout  *ob_layout;
 	/** Cookie associated with a RM context */
 	struct m0_cookie   ob_cookie;
+	/** Write-back cache, see m0_obj_wbc_enable(). */
+	struct m0_obj_wbc        *ob_wbc;
+	/** Read-ahead, see m0_obj_ra_enable(). */
+	struct m0_obj_ra         *ob_ra;
+	/** Inline data state, see m0_config::mc_obj_inline_size. */
+	struct m0_obj_inline     *ob_inline;
 };
 
 struct m0_client_layout {
@@ -1002,6 +1043,57 @@ struct m0_config {
  	 * ADDB size
  	 */
 	m0_bcount_t mc_addb_size;
+
+	/**
+	 * Coalescing of small io requests, disabled when 0.
+	 *
+	 * Io fops of concurrent operations which target the same cob and
+	 * carry at most mc_io_coalesce_size bytes each are held for up to
+	 * mc_io_coalesce_window and sent to the ioservice as a single fop.
+	 * Every operation still gets its own completion.
+	 */
+	m0_time_t   mc_io_coalesce_window;
+	m0_bcount_t mc_io_coalesce_size;
+
+	/**
+	 * Maximal number of objects whose pool version and layout id are
+	 * cached, so that opening them again takes no round trip. Disabled
+	 * when 0.
+	 */
+	uint32_t    mc_obj_attr_cache_nr;
+
+	/**
+	 * Objects of at most mc_obj_inline_size bytes are stored as records
+	 * of the distributed index mc_obj_inline_idx, which must exist.
+	 * Disabled when 0. The size is limited by the maximal rpc message
+	 * size.
+	 */
+	m0_bcount_t   mc_obj_inline_size;
+	struct m0_fid mc_obj_inline_idx;
+
+	/**
+	 * Read fops of at most mc_io_inline_read_max bytes get their data in
+	 * the reply instead of a zero-copy to the client buffers, which saves
+	 * a network round trip. Disabled when 0, limited by
+	 * M0_IO_INLINE_READ_MAX.
+	 */
+	m0_bcount_t   mc_io_inline_read_max;
+
+	/**
+	 * Ask the ioservice to launch stob io of each buffer of a write as
+	 * soon as its bulk transfer completes (M0_IO_FLAG_PIPELINE), instead
+	 * of after the transfer of the whole batch. Disabled by default.
+	 */
+	bool          mc_io_pipelined_write;
+
+	/**
+	 * Don't wait at m0_client_init() for the connections to all services
+	 * of the configuration. The connections are still started in
+	 * parallel at init; an operation waits for the connection to the
+	 * service it uses, if it's not established yet. Useful for short-lived
+	 * applications using a few services of a large configuration.
+	 */
+	bool          mc_lazy_connect;
 };
 
 /** The identifier of the root of realm hierarchy. */
@@ -1166,8 +1258,10 @@ int m0_obj_lock_init(struct m0_obj *obj);
 
 /**
  * Finalizes the object lock and decreased the rm_ctx::rmc_ref::ref_cnt.
- * If the rm_ctx::rmc_ref::ref_cnt becomes 0, then finalize the
- * cached RM context.
+ * If the rm_ctx::rmc_ref::ref_cnt becomes 0, then the cached RM context is
+ * retained with the credits it holds for M0_RM_IDLE_LEASE seconds, so that
+ * locking the object again does not borrow the credits anew. Expired
+ * contexts are finalized.
  *
  * @pre   m0_obj_init()
  * @pre   m0_obj_lock_init()
@@ -1319,6 +1413,52 @@ void m0_op_launch(struct m0_op **op, uint32_t nr);
  */
 int32_t m0_op_wait(struct m0_op *op, uint64_t bits, m0_time_t to);
 
+/** Initialises an empty completion queue. */
+void m0_cq_init(struct m0_cq *cq);
+
+/**
+ * Finalises a completion queue.
+ *
+ * @pre cq->cq_nr == 0, i.e., all operations associated with the queue are
+ * finalised.
+ */
+void m0_cq_fini(struct m0_cq *cq);
+
+/**
+ * Associates an operation with a completion queue. The operation is queued
+ * to cq when it reaches M0_OS_STABLE or M0_OS_FAILED.
+ *
+ * @pre op->op_sm.sm_state == M0_OS_INITIALISED
+ * @pre op->op_cq == NULL
+ */
+void m0_op_cq_set(struct m0_op *op, struct m0_cq *cq);
+
+/**
+ * Reaps completed operations from a completion queue.
+ *
+ * Waits until the queue is not empty or the absolute deadline expires, then
+ * removes up to nr operations from the queue, in the order of completion, and
+ * stores them in ops[]. The caller checks op_sm.sm_state and op_sm.sm_rc of
+ * every returned operation.
+ *
+ * @code
+ * m0_op_launch(ops, nr);
+ * while (inflight > 0) {
+ *         n = m0_cq_poll(&cq, done, ARRAY_SIZE(done), M0_TIME_NEVER);
+ *         for (i = 0; i < n; ++i) {
+ *                 ... check done[i]->op_sm.sm_rc ...
+ *                 m0_op_fini(done[i]);
+ *                 m0_op_free(done[i]);
+ *         }
+ *         inflight -= n;
+ * }
+ * @endcode
+ *
+ * @retval number of operations stored in ops[], 0 if the deadline expired.
+ */
+int m0_cq_poll(struct m0_cq *cq, struct m0_op **ops, uint32_t nr,
+	       m0_time_t deadline);
+
 /**
  * Cancels client operations. Caller is expected to wait
  * for operation to move to one of the terminal states. The process of
@@ -1504,6 +1644,59 @@ int m0_obj_op(struct m0_obj       *obj,
 	      uint32_t             flags,
 	      struct m0_op       **op);
 
+/**
+ * Enables write-back caching of the object.
+ *
+ * WRITE operations that do not cover whole parity groups are copied into the
+ * cache and become STABLE without i/o. Cached blocks are written to the
+ * object with coalesced operations by m0_obj_wbc_flush(), m0_entity_sync(),
+ * m0_sync(), every "period" (unless it is 0) and when the cache holds more
+ * than "size_max" bytes.
+ *
+ * Cached data are seen by READ operations of this client only, they are not
+ * visible to other clients and are not durable until flushed. Errors of
+ * background flushes are returned by the next flush or sync.
+ *
+ * @pre obj->ob_wbc == NULL
+ */
+int m0_obj_wbc_enable(struct m0_obj *obj, m0_bcount_t size_max,
+		      m0_time_t period);
+
+/**
+ * Writes cached blocks to the object and waits until they are STABLE.
+ * Returns the error of this flush or of an earlier background flush.
+ */
+int m0_obj_wbc_flush(struct m0_obj *obj);
+
+/**
+ * Flushes and disables the cache. Called by m0_obj_fini(). Cached data are
+ * lost if the flush fails.
+ */
+int m0_obj_wbc_disable(struct m0_obj *obj);
+
+/**
+ * Enables read-ahead of the object.
+ *
+ * Sequential READ operations (each starting where the previous one ended)
+ * prefetch the following whole parity groups into windows of up to
+ * "size_max" / 2 bytes, fetched asynchronously. Reads within a fetched window
+ * are served from memory. The window grows with the length of the sequential
+ * stream; "size_max" should hold at least two parity groups for read-ahead
+ * to take effect.
+ *
+ * Writes and frees of this client drop overlapped windows. Updates by other
+ * clients may not be seen in data already prefetched.
+ *
+ * @pre obj->ob_ra == NULL
+ */
+int m0_obj_ra_enable(struct m0_obj *obj, m0_bcount_t size_max);
+
+/**
+ * Disables read-ahead, called by m0_obj_fini(). No READ operations on the
+ * object may be launched concurrently.
+ */
+void m0_obj_ra_disable(struct m0_obj *obj);
+
 /**
  * Initialises client index in a given realm.
  *
@@ -1647,6 +1840,31 @@ int m0_entity_delete(struct m0_entity *entity,
 		     struct m0_op    **op);
 /**@}*/
 
+/**
+ * Sets operations to create or delete a batch of entities, an operation per
+ * entity as m0_entity_create() and m0_entity_delete() do.
+ *
+ * When the operations are launched together, cob fops of all objects but the
+ * last one are held in rpc formation for a short while, and the fops of the
+ * last object carry them along, so that the fops going to the same service
+ * are sent in as few rpc packets as possible.
+ *
+ * On failure, the operations set so far are finalised, freed and reset to
+ * NULL.
+ *
+ * @pre ents != NULL && ops != NULL && nr > 0
+ * @pre m0_forall(i, nr, ops[i] == NULL)
+ */
+/**@{*/
+int m0_entity_create_batch(struct m0_fid     *pool,
+			   struct m0_entity **ents,
+			   uint32_t           nr,
+			   struct m0_op     **ops);
+int m0_entity_delete_batch(struct m0_entity **ents,
+			   uint32_t           nr,
+			   struct m0_op     **ops);
+/**@}*/
+
 /**
  * Sets an operation to open an entity.
  *
@@ -45,6 +45,7 @@
 #include "motr/addb.h"
 #include "motr/client_internal.h"
 #include "motr/layout.h"
+#include "motr/wbc.h"                /* m0__obj_wbc_client_init */
 
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_CLIENT
 #include "lib/trace.h"                /* M0_LOG */
@@ -1049,7 +1050,10 @@ static int pools_init(struct m0_client *m0c)
 	if (rc != 0)
 		goto err_pools_destroy;
 
-	m0_pools_common_service_ctx_connect_sync(pools);
+	/* With lazy connect, users of a service wait for its connection. */
+	pools->pc_lazy_connect = m0c->m0c_config->mc_lazy_connect;
+	if (!pools->pc_lazy_connect)
+		m0_pools_common_service_ctx_connect_sync(pools);
 
 	m0_sm_group_lock(&m0c->m0c_sm_group);
 	return M0_RC(0);
@@ -1596,6 +1600,13 @@ int m0_client_init(struct m0_client **m0c_p,
 	/* Initialise state machine group */
 	m0_sm_group_init(&m0c->m0c_sm_group);
 	m0_chan_init(&m0c->m0c_io_wait, &m0c->m0c_sm_group.s_lock);
+	m0_mutex_init(&m0c->m0c_co_lock);
+	m0_sm_timer_init(&m0c->m0c_co_timer);
+	m0__obj_wbc_client_init(m0c);
+	m0__parity_pool_init(m0c, get_online_cpus());
+	if (m0__obj_attr_cache_init(&m0c->m0c_oac,
+				    conf->mc_obj_attr_cache_nr) != 0)
+		M0_LOG(M0_WARN, "Object attribute cache is disabled.");
 
 	/* Move the initlift in its direction of travel */
 	m0_sm_group_lock(&m0c->m0c_sm_group);
@@ -1638,9 +1649,11 @@ int m0_client_init(struct m0_client **m0c_p,
 
 	/* Extra initialisation work for composite layout. */
 	m0__composite_container_init(m0c);
+	m0__obj_inline_client_init(m0c);
 
 	/* Init the hash-table for RM contexts */
 	rm_ctx_htable_init(&m0c->m0c_rm_ctxs, M0_RM_HBUCKET_NR);
+	m0__obj_lock_client_init(m0c);
 
 	if (ENABLE_DTM0) {
 		struct m0_reqh_service *reqh_svc;
@@ -1725,7 +1738,9 @@ void m0_client_fini(struct m0_client *m0c, bool fini_m0)
 	}
 
 	/* Finalize hash-table for RM contexts */
+	m0__obj_lock_client_fini(m0c);
 	rm_ctx_htable_fini(&m0c->m0c_rm_ctxs);
+	m0__obj_inline_client_fini(m0c);
 
 	/* shut down this client instance */
 	m0_sm_group_lock(&m0c->m0c_sm_group);
@@ -1742,6 +1757,12 @@ void m0_client_fini(struct m0_client *m0c, bool fini_m0)
 		initlift_move_next_floor(m0c);
 
 	m0_sm_group_unlock(&m0c->m0c_sm_group);
+	M0_ASSERT(m0c->m0c_co_pending == NULL && !m0c->m0c_co_armed);
+	m0_sm_timer_fini(&m0c->m0c_co_timer);
+	m0_mutex_fini(&m0c->m0c_co_lock);
+	m0__obj_wbc_client_fini(m0c);
+	m0__parity_pool_fini(m0c);
+	m0__obj_attr_cache_fini(&m0c->m0c_oac);
 	m0_chan_fini_lock(&m0c->m0c_io_wait);
 
 	m0_chan_fini_lock(&m0c->m0c_conf_ready_chan);
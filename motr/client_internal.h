@@ -51,6 +51,7 @@
 #include "rm/rm_rwlock.h"       /* enum m0_rm_rwlock_req_type */
 #include "lib/refs.h"
 #include "lib/hash.h"
+#include "lib/thread_pool.h"  /* m0_parallel_pool */
 #include "file/file.h"          /* struct m0_file */
 #include "motr/ha.h"            /* m0_motr_ha */
 #include "addb2/identifier.h"
@@ -62,6 +63,8 @@
 #include "motr/idx.h"  /* m0_idx_* */
 #include "motr/pg.h"          /* nwxfer and friends */
 #include "motr/sync.h"        /* sync_request */
+#include "motr/obj_attr_cache.h"
+#include "motr/obj_inline.h"
 #include "fop/fop.h"
 #include "dtm0/domain.h"        /* m0_dtm0_domain */
 
@@ -91,6 +94,15 @@ enum {
 	M0_RM_HBUCKET_NR = 100
 };
 
+/**
+ * Retention of idle RM contexts, see m0_obj_lock_fini(): the lease in seconds
+ * and the maximal number of retained contexts.
+ */
+enum {
+	M0_RM_IDLE_LEASE = 10,
+	M0_RM_IDLE_MAX   = 1024
+};
+
 enum m0__entity_states {
 	M0_ES_INIT = 1,
 	M0_ES_CREATING,
@@ -241,6 +253,12 @@ struct m0_op_idx {
 
 	/** Distributed transaction associated with the operation */
 	struct m0_dtx      *oi_dtx;
+
+	/**
+	 * Batch the operation is merged into by m0_op_launch(), until it is
+	 * sent. See m0_idx_dix_config::kc_batch.
+	 */
+	struct dix_batch   *oi_batch;
 };
 
 /**
@@ -263,6 +281,16 @@ struct m0_op_obj {
 
 	/* MDS fop */
 	struct m0_fop              *oo_mds_fop;
+	/**
+	 * Part of a batch and not its last operation, see
+	 * m0_entity_create_batch().
+	 */
+	bool                        oo_batched;
+	/**
+	 * Postpones the launch until the services of oo_pver are connected,
+	 * see m0_config::mc_lazy_connect and m0__obj_connect_wait().
+	 */
+	struct m0_reqh_service_connect_waiter oo_conn_wait;
 };
 
 /**
@@ -388,6 +416,12 @@ struct m0_op_io {
 	 * Relying on this to remove duplicate mapping for the same nxfer_req
 	 */
 	int                              ioo_addb2_mapped;
+
+	/**
+	 * I/o of a client cache (write-back flush, read-ahead fetch), which
+	 * bypasses the caches. See m0__obj_cache_io().
+	 */
+	bool                             ioo_cache_io;
 };
 
 struct m0_io_args {
@@ -591,6 +625,43 @@ struct m0_client {
 	/** Channel on which io waiters can wait. */
 	struct m0_chan                          m0c_io_wait;
 
+	/**
+	 * Coalescing of small io fops, enabled by
+	 * m0_config::mc_io_coalesce_window. m0c_co_lock protects the list of
+	 * pending leader fops and m0c_co_armed. The timer runs in
+	 * m0c_sm_group.
+	 */
+	struct m0_mutex                         m0c_co_lock;
+	struct ioreq_fop                       *m0c_co_pending;
+	bool                                    m0c_co_armed;
+	struct m0_sm_ast                        m0c_co_ast;
+	struct m0_sm_timer                      m0c_co_timer;
+
+	/** Objects with write-back caches, see motr/wbc.h. */
+	struct m0_mutex                         m0c_wbc_lock;
+	struct m0_tl                            m0c_wbcs;
+
+	/**
+	 * Threads calculating parity of the groups of large writes in
+	 * parallel, see ioreq_parity_recalc(). m0c_parity_lock serialises
+	 * batches of different operations. The pool is not used when
+	 * m0c_parity_pool_on is false.
+	 */
+	struct m0_parallel_pool                 m0c_parity_pool;
+	struct m0_mutex                         m0c_parity_lock;
+	bool                                    m0c_parity_pool_on;
+
+	/** Pool versions and layouts of recently opened objects. */
+	struct m0_obj_attr_cache                m0c_oac;
+
+	/**
+	 * Index of inline objects, see motr/obj_inline.h. m0c_inline_size is
+	 * 0 when inline objects are disabled.
+	 */
+	struct m0_container                     m0c_inline_container;
+	struct m0_idx                           m0c_inline_idx;
+	m0_bcount_t                             m0c_inline_size;
+
 #ifdef CLIENT_FOR_M0T1FS
 	/** Root fid, retrieved from mdservice in mount time. */
 	struct m0_fid                           m0c_root_fid;
@@ -624,6 +695,14 @@ struct m0_client {
 #endif
 
 	struct m0_htable                        m0c_rm_ctxs;
+	/**
+	 * RM contexts of objects no longer initialised, retained with their
+	 * cached credits until the lease expires, oldest first.
+	 */
+	struct m0_tl                            m0c_rm_idle;
+	/** Protects m0c_rm_idle and m0c_rm_idle_nr. */
+	struct m0_mutex                         m0c_rm_idle_lock;
+	uint32_t                                m0c_rm_idle_nr;
 
 	struct m0_dtm0_service                 *m0c_dtms;
 
@@ -663,11 +742,20 @@ struct m0_rm_lock_ctx {
 	uint64_t                rmc_magic;
 	/** A generation count for cookie associated with this ctx. */
 	uint64_t                rmc_gen;
+	/** Linkage in m0_client::m0c_rm_idle while the ctx is idle. */
+	struct m0_tlink         rmc_idle_link;
+	uint64_t                rmc_idle_magic;
+	/** When the retention of an idle ctx ends. */
+	m0_time_t               rmc_idle_deadline;
 };
 
 /** Methods for hash-table holding rm_ctx for RM locks */
 M0_HT_DECLARE(rm_ctx, M0_INTERNAL, struct m0_rm_lock_ctx, struct m0_fid);
 
+M0_INTERNAL void m0__obj_lock_client_init(struct m0_client *m0c);
+/** Finalises all idle RM contexts, returning their credits. */
+M0_INTERNAL void m0__obj_lock_client_fini(struct m0_client *m0c);
+
 /**
  * A wrapper structure over m0_rm_incoming.
  * It represents a request to borrow/sublet resource
@@ -877,6 +965,17 @@ M0_INTERNAL int m0__obj_namei_cancel(struct m0_op *op);
  */
 M0_INTERNAL int m0__idx_cancel(struct m0_op_idx *oi);
 
+/**
+ * Lets the index service merge index operations of a single m0_op_launch()
+ * call. m0__idx_batch_begin() is called before the operations are launched
+ * and m0__idx_batch_end() after all of them are.
+ *
+ * @param op operations being launched
+ * @param nr number of operations
+ */
+M0_INTERNAL void m0__idx_batch_begin(struct m0_op **op, uint32_t nr);
+M0_INTERNAL void m0__idx_batch_end(struct m0_op **op, uint32_t nr);
+
 /**
  * Get object's attributes from services synchronously.
  *
@@ -973,6 +1072,13 @@ m0__obj_pool_version_is_valid(const struct m0_obj *obj);
 M0_INTERNAL bool m0__obj_is_parity_verify_mode(struct m0_client *instance);
 M0_INTERNAL bool m0__obj_is_di_enabled(struct m0_op_io *ioo);
 M0_INTERNAL bool m0__obj_is_cksum_validation_allowed(struct m0_op_io *ioo);
+/**
+ * Returns true if the launch of the object operation is postponed until the
+ * services it is sent to are connected, see m0_config::mc_lazy_connect. The
+ * launch callback of the operation is called again from an ast in oo_sm_grp
+ * then. Called at the beginning of the launch callbacks of object operations.
+ */
+M0_INTERNAL bool m0__obj_connect_wait(struct m0_op_obj *oo);
 M0_INTERNAL int m0__obj_io_build(struct m0_io_args *args,
 				 struct m0_op     **op);
 M0_INTERNAL void m0__obj_op_done(struct m0_op *op);
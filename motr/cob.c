@@ -51,6 +51,8 @@ struct ios_cob_req {
 enum cob_request_flags {
 	COB_REQ_ASYNC = (1 << 1),
 	COB_REQ_SYNC  = (1 << 2),
+	/** Fops wait in formation for the rest of the batch. */
+	COB_REQ_BATCH = (1 << 3),
 };
 
 /**
@@ -88,6 +90,16 @@ struct cob_req {
  */
 enum {IOS_COB_REQ_DEADLINE = 2000000};
 
+/**
+ * Fops of a batch member but the last are held in formation until the last
+ * member's fops, sent at once, take them along to the same services.
+ */
+static m0_time_t cob_req_deadline(const struct cob_req *cr)
+{
+	return cr->cr_flags & COB_REQ_BATCH ?
+		m0_time_from_now(0, IOS_COB_REQ_DEADLINE) : 0;
+}
+
 const struct m0_bob_type cr_bobtype;
 M0_BOB_DEFINE(M0_INTERNAL, &cr_bobtype, cob_req);
 const struct m0_bob_type cr_bobtype = {
@@ -594,6 +606,14 @@ static void cob_rep_process(struct cob_req *cr)
 		cob_rep_attr_copy(cr);
 		obj = m0__obj_entity(cr->cr_op->op_entity);
 		m0__obj_attr_set(obj, cob_attr->ca_pver, cob_attr->ca_lid);
+		m0__obj_attr_cache_put(&cr->cr_cinst->m0c_oac, &cr->cr_fid,
+				       obj);
+		break;
+	case M0_EO_CREATE:
+		obj = m0__obj_entity(cr->cr_op->op_entity);
+		m0__obj_attr_cache_put(&cr->cr_cinst->m0c_oac, &cr->cr_fid,
+				       obj);
+		m0__obj_inline_created(obj);
 		break;
 	case M0_EO_LAYOUT_GET:
 		cob_rep_attr_copy(cr);
@@ -1199,15 +1219,14 @@ static int cob_ios_prepare(struct cob_req *cr, uint32_t idx)
 
 	/*
 	 * Set and send the rpc item. Note: ri_deadline is set to
-	 * COB_REQ_DEADLINE from 'now' to allow RPC formation to pack the fops
-	 * and to improve network utilization. (See commit 09c0a46368 for
-	 * details).
+	 * COB_REQ_DEADLINE from 'now' for batched requests to allow RPC
+	 * formation to pack the fops and to improve network utilization.
+	 * (See commit 09c0a46368 for details).
 	 */
 	fop->f_item.ri_rmachine = m0_fop_session_machine(session);
 	fop->f_item.ri_session  = session;
 	fop->f_item.ri_prio     = M0_RPC_ITEM_PRIO_MID;
-	fop->f_item.ri_deadline = 0;
-				/*m0_time_from_now(0, IOS_COB_REQ_DEADLINE);*/
+	fop->f_item.ri_deadline = cob_req_deadline(cr);
 	fop->f_item.ri_nr_sent_max = M0_RPC_MAX_RETRIES;
 	fop->f_item.ri_resend_interval = M0_RPC_RESEND_INTERVAL;
 
@@ -1776,7 +1795,7 @@ static int cob_mds_send(struct cob_req *cr)
 	fop->f_opaque                  = cr;
 	fop->f_item.ri_session         = session;
 	fop->f_item.ri_prio            = M0_RPC_ITEM_PRIO_MID;
-	fop->f_item.ri_deadline        = 0;
+	fop->f_item.ri_deadline        = cob_req_deadline(cr);
 	fop->f_item.ri_nr_sent_max     = M0_RPC_MAX_RETRIES;
 	fop->f_item.ri_resend_interval = M0_RPC_RESEND_INTERVAL;
 	cr->cr_mds_fop = fop;
@@ -1832,6 +1851,8 @@ M0_INTERNAL int m0__obj_namei_send(struct m0_op_obj *oo)
 	cr->cr_op        = op;
 	cr->cr_op_sm_grp = oo->oo_sm_grp;
 	cr->cr_flags    |= COB_REQ_ASYNC;
+	if (oo->oo_batched)
+		cr->cr_flags |= COB_REQ_BATCH;
 	/** save cr in op structure, will be used in op cancel operation
 	 * priv_lock can be skipped because it is just initialized.
 	 * set referenced flag in cob request required during free
@@ -1860,6 +1881,12 @@ M0_INTERNAL int m0__obj_namei_send(struct m0_op_obj *oo)
 	if ((M0_IN(cr->cr_opcode, (M0_EO_GETATTR, M0_EO_DELETE))) &&
 	     (obj->ob_entity.en_flags & M0_ENF_META))
 		skip_meta_data = true;
+	/* Pool version and layout of a recently opened object are known. */
+	if (cr->cr_opcode == M0_EO_GETATTR && !skip_meta_data &&
+	    m0__obj_attr_cache_get(&cinst->m0c_oac, &cr->cr_fid, obj))
+		skip_meta_data = true;
+	if (cr->cr_opcode == M0_EO_DELETE)
+		m0__obj_attr_cache_del(&cinst->m0c_oac, &cr->cr_fid);
 
 	/* Set layout id and pver for CREATE op.*/
 	if (cr->cr_opcode == M0_EO_CREATE) {
@@ -1870,6 +1897,7 @@ M0_INTERNAL int m0__obj_namei_send(struct m0_op_obj *oo)
 			* can be skipped */
 			obj->ob_attr.oa_pver = pv->pv_id;
 			skip_meta_data = true;
+			m0__obj_inline_created(obj);
 		 }
 	}
 
@@ -58,6 +58,57 @@ M0_TL_DEFINE(cext, static, struct m0_composite_extent);
 
 static int composite_layout_io_build(struct m0_io_args *args,
 				     struct m0_op **op);
+
+static void composite_ext_idx_fini(struct m0_composite_ext_idx *ei)
+{
+	m0_free0(&ei->cei_exts);
+	ei->cei_nr = 0;
+}
+
+/**
+ * Builds the lookup index of a sorted extent list. Lookups fall back to the
+ * list walk if there is no memory for the index.
+ */
+static void composite_ext_idx_build(struct m0_composite_ext_idx *ei,
+				    struct m0_tl *ext_list)
+{
+	struct m0_composite_extent *ext;
+	uint64_t                    nr = cext_tlist_length(ext_list);
+	uint64_t                    i = 0;
+
+	composite_ext_idx_fini(ei);
+	if (nr == 0)
+		return;
+	M0_ALLOC_ARR(ei->cei_exts, nr);
+	if (ei->cei_exts == NULL)
+		return;
+	m0_tl_for(cext, ext_list, ext) {
+		M0_ASSERT(ergo(i > 0, ei->cei_exts[i - 1]->ce_off <=
+				      ext->ce_off));
+		ei->cei_exts[i++] = ext;
+	} m0_tl_endfor;
+	ei->cei_nr = nr;
+}
+
+/** Returns the first extent ending after the offset, NULL if none. */
+static struct m0_composite_extent *
+composite_ext_idx_find(const struct m0_composite_ext_idx *ei, m0_bindex_t off)
+{
+	struct m0_composite_extent *ext;
+	uint64_t                    lo = 0;
+	uint64_t                    hi = ei->cei_nr;
+	uint64_t                    mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		ext = ei->cei_exts[mid];
+		if (ext->ce_off + ext->ce_len <= off)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo < ei->cei_nr ? ei->cei_exts[lo] : NULL;
+}
 static int
 composite_extents_scan_sync(struct m0_obj *obj,
 			    struct m0_client_composite_layout *clayout);
@@ -492,6 +543,8 @@ static void composite_layout_put(struct m0_client_layout *layout)
 
 	/* Teardown extent lists and layer list. */
 	m0_tl_teardown(clayer, &comp->ccl_layers, layer) {
+		composite_ext_idx_fini(&layer->ccr_rd_idx);
+		composite_ext_idx_fini(&layer->ccr_wr_idx);
 		m0_tl_teardown(cext, &layer->ccr_rd_exts, ext)
 			m0_free(ext);
 		m0_tl_teardown(cext, &layer->ccr_wr_exts, ext)
@@ -602,6 +655,8 @@ void m0_composite_layer_del(struct m0_client_layout *layout,
 		M0_LEAVE();
 		return;
 	}
+	composite_ext_idx_fini(&layer->ccr_rd_idx);
+	composite_ext_idx_fini(&layer->ccr_wr_idx);
 	m0_tl_teardown(cext, &layer->ccr_rd_exts, ext)
 		m0_free(ext);
 	m0_tl_teardown(cext, &layer->ccr_wr_exts, ext)
@@ -725,7 +780,7 @@ static int composite_io_divide(struct m0_client_composite_layout *clayout,
 	int                                 i;
 	int                                 nr_subobjs;
 	int                                 valid_subobj_cnt = 0;
-	m0_bindex_t                         off;
+	m0_bindex_t                         off = ext->iv_index[0];
 	m0_bcount_t                         len = 0;
 	m0_bindex_t                         next_off;
 	struct m0_ivec_cursor               icursor;
@@ -736,6 +791,7 @@ static int composite_io_divide(struct m0_client_composite_layout *clayout,
 	struct m0_composite_extent        **cexts;
 	struct m0_tl                      **cext_tlists;
 	struct m0_tl                       *tl;
+	struct m0_composite_ext_idx        *ei;
 
 	nr_subobjs = clayout->ccl_nr_layers;
 	M0_ASSERT(nr_subobjs != 0);
@@ -756,6 +812,8 @@ static int composite_io_divide(struct m0_client_composite_layout *clayout,
 		     clayer_tlist_next(&clayout->ccl_layers, layer);
 		tl = (opcode == M0_OC_READ)?
 		     &layer->ccr_rd_exts: &layer->ccr_wr_exts;
+		ei = (opcode == M0_OC_READ)?
+		     &layer->ccr_rd_idx: &layer->ccr_wr_idx;
 
 		/* Only those layers with extents are considered valid. */
 		if (cext_tlist_is_empty(tl))
@@ -763,7 +821,8 @@ static int composite_io_divide(struct m0_client_composite_layout *clayout,
 
 		/* Initialise subobj IO. */
 		cext_tlists[valid_subobj_cnt] = tl;
-		cexts[valid_subobj_cnt] = cext_tlist_head(tl);
+		cexts[valid_subobj_cnt] = ei->cei_exts != NULL ?
+			composite_ext_idx_find(ei, off) : cext_tlist_head(tl);
 		sio_ext_tlist_init(&sio_arr[valid_subobj_cnt].si_exts);
 		sio_arr[valid_subobj_cnt].si_id = layer->ccr_subobj;
 		sio_arr[valid_subobj_cnt].si_lid = layer->ccr_lid;
@@ -776,9 +835,10 @@ static int composite_io_divide(struct m0_client_composite_layout *clayout,
 
 	/*
 	 * Skip the first few extents whose end is less than the offset
-	 * of IO range as they are certainly not in the range.
+	 * of IO range as they are certainly not in the range. Layers with
+	 * a lookup index start at the right extent already.
 	 */
-	off = m0_ivec_cursor_index(&icursor);
+	M0_ASSERT(off == m0_ivec_cursor_index(&icursor));
 	advance_layers_cursor(cext_tlists, cexts, valid_subobj_cnt, off);
 
 	while (!m0_ivec_cursor_move(&icursor, len) &&
@@ -1498,6 +1558,9 @@ static int composite_layer_idx_scan(struct m0_composite_layer *layer,
 	}
 
 exit:
+	if (rc == 0)
+		composite_ext_idx_build(is_wr_list ? &layer->ccr_wr_idx :
+					&layer->ccr_rd_idx, ext_list);
 	m0_idx_fini(&idx);
 	m0_bufvec_free(keys);
 	m0_bufvec_free(vals);
@@ -552,6 +552,40 @@ static void idx_op_cb_launch(struct m0_op_common *oc)
 	M0_LEAVE();
 }
 
+static struct m0_idx_query_ops *idx_batch_query_ops(struct m0_op **op,
+						    uint32_t       nr)
+{
+	struct m0_client *m0c;
+	uint32_t          i;
+
+	if (nr < 2)
+		return NULL;
+	for (i = 0; i < nr; i++) {
+		if (op[i]->op_entity != NULL &&
+		    op[i]->op_entity->en_type == M0_ET_IDX) {
+			m0c = m0__op_instance(op[i]);
+			return m0c->m0c_idx_svc_ctx.isc_service->is_query_ops;
+		}
+	}
+	return NULL;
+}
+
+M0_INTERNAL void m0__idx_batch_begin(struct m0_op **op, uint32_t nr)
+{
+	struct m0_idx_query_ops *query_ops = idx_batch_query_ops(op, nr);
+
+	if (query_ops != NULL && query_ops->iqo_batch_begin != NULL)
+		query_ops->iqo_batch_begin(op, nr);
+}
+
+M0_INTERNAL void m0__idx_batch_end(struct m0_op **op, uint32_t nr)
+{
+	struct m0_idx_query_ops *query_ops = idx_batch_query_ops(op, nr);
+
+	if (query_ops != NULL && query_ops->iqo_batch_end != NULL)
+		query_ops->iqo_batch_end(op, nr);
+}
+
 int m0_idx_op(struct m0_idx       *idx,
 	      enum m0_idx_opcode   opcode,
 	      struct m0_bufvec    *keys,
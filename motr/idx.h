@@ -105,7 +105,13 @@ enum m0_op_idx_flags {
 	 * s3 server), passed through layers of motr client stack and is sent to
 	 * the server.
 	 */
-	M0_OIF_NO_DTM = 1 << 5
+	M0_OIF_NO_DTM = 1 << 5,
+	/**
+	 * For M0_IC_GET operation, instructs it to bypass client-side cache
+	 * of index values (see m0_idx_dix_config::kc_cache_size) and to
+	 * retrieve values from the index service.
+	 */
+	M0_OIF_NO_CACHE = 1 << 6
 };
 
 /**
@@ -136,6 +142,14 @@ struct m0_idx_query_ops {
 	int  (*iqo_put)(struct m0_op_idx *oi);
 	int  (*iqo_del)(struct m0_op_idx *oi);
 	int  (*iqo_next)(struct m0_op_idx *oi);
+
+	/*
+	 * Optional. Called by m0_op_launch() before and after launching
+	 * a set of operations, so that the driver can merge queries of
+	 * several operations into one.
+	 */
+	void (*iqo_batch_begin)(struct m0_op **ops, uint32_t nr);
+	void (*iqo_batch_end)(struct m0_op **ops, uint32_t nr);
 };
 
 /** Initialisation and finalisation functions for an index service. */
@@ -200,6 +214,30 @@ struct m0_idx_dix_config {
 	 */
 	struct m0_dix_ldesc kc_ldescr_ldesc;
 
+	/**
+	 * Maximal size in bytes of client-side cache of values retrieved by
+	 * M0_IC_GET operations from distributed indices. Zero disables the
+	 * cache.
+	 *
+	 * Cached values are invalidated by M0_IC_PUT and M0_IC_DEL operations
+	 * of this client. Updates done by other clients become visible after
+	 * kc_cache_ttl at most.
+	 */
+	m0_bcount_t         kc_cache_size;
+
+	/** Time a cached value stays valid. Zero means 1 second. */
+	m0_time_t           kc_cache_ttl;
+
+	/**
+	 * Merges M0_IC_PUT (M0_IC_GET) operations on the same distributed
+	 * index, launched together by a single m0_op_launch() call, into one
+	 * DIX request. Records of all operations are then sent in shared CAS
+	 * fops, and replies are delivered back to every operation.
+	 *
+	 * Operations of a batch fail together if the request fails, and
+	 * cancellation of any of them cancels the whole request.
+	 */
+	bool                kc_batch;
 };
 
 /* BOB types */
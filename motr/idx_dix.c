@@ -26,6 +26,9 @@
 #include "lib/assert.h"
 #include "lib/tlist.h"         /* m0_tl */
 #include "lib/memory.h"
+#include "lib/hash.h"          /* m0_htable */
+#include "lib/hash_fnc.h"      /* m0_hash_fnc_fnv1 */
+#include "lib/mutex.h"
 #include "fid/fid.h"           /* m0_fid */
 #include "pool/pool.h"         /* pools_common_svc_ctx */
 #include "conf/helpers.h"      /* m0_confc_root_open */
@@ -48,12 +51,95 @@
 
 #define OI_IFID(oi) (struct m0_fid *)&(oi)->oi_idx->in_entity.en_id
 
+enum {
+	DIX_CACHE_BUCKETS_NR = 1021,
+	DIX_CACHE_TTL_DEF    = M0_TIME_ONE_SECOND,
+};
+
+/**
+ * Client-side cache of values retrieved by GET operations.
+ *
+ * The cache is bounded by m0_idx_dix_config::kc_cache_size bytes of records
+ * (including keys and values), least recently used records are evicted first.
+ * Every record is valid for m0_idx_dix_config::kc_cache_ttl after it is
+ * retrieved from the index service.
+ *
+ * Records are invalidated on PUT and DEL operations of this client, both on
+ * launch and on completion. All records of an index are dropped when the index
+ * is deleted. Every invalidation increments dc_gen: values retrieved by GET
+ * operations launched before the last invalidation aren't cached, since they
+ * may be older than the update.
+ *
+ * GET operation is completed from the cache only if values of all its keys are
+ * cached, otherwise it is sent to the index service as usual.
+ */
+struct dix_cache {
+	struct m0_mutex  dc_lock;
+	/** Records hashed by (index fid, key). */
+	struct m0_htable dc_recs;
+	/** Records from the most to the least recently used. */
+	struct m0_tl     dc_lru;
+	/** Size of all cached records. */
+	m0_bcount_t      dc_size;
+	/** Maximal size of cached records, 0 if the cache is disabled. */
+	m0_bcount_t      dc_max;
+	m0_time_t        dc_ttl;
+	/** Number of invalidations. */
+	uint64_t         dc_gen;
+	uint64_t         dc_hits;
+	uint64_t         dc_misses;
+};
+
+struct dix_cache_key {
+	struct m0_fid dck_ifid;
+	struct m0_buf dck_key;
+};
+
+struct dix_cache_rec {
+	struct m0_hlink      dcr_hlink;
+	uint64_t             dcr_magic;
+	struct m0_tlink      dcr_lru_link;
+	uint64_t             dcr_lru_magic;
+	struct dix_cache_key dcr_key;
+	struct m0_buf        dcr_val;
+	/** The record is valid till this time. */
+	m0_time_t            dcr_expire;
+};
+
+static uint64_t dix_cache_hash(const struct m0_htable     *htable,
+			       const struct dix_cache_key *key)
+{
+	return (m0_fid_hash(&key->dck_ifid) ^
+		m0_hash_fnc_fnv1(key->dck_key.b_addr, key->dck_key.b_nob)) %
+		htable->h_bucket_nr;
+}
+
+static bool dix_cache_key_eq(const struct dix_cache_key *k1,
+			     const struct dix_cache_key *k2)
+{
+	return m0_fid_eq(&k1->dck_ifid, &k2->dck_ifid) &&
+	       m0_buf_eq(&k1->dck_key, &k2->dck_key);
+}
+
+M0_HT_DESCR_DEFINE(dix_cache, "Cache of DIX index values", static,
+		   struct dix_cache_rec, dcr_hlink, dcr_magic,
+		   M0_DIX_CACHE_MAGIC, M0_DIX_CACHE_HEAD_MAGIC,
+		   dcr_key, dix_cache_hash, dix_cache_key_eq);
+M0_HT_DEFINE(dix_cache, static, struct dix_cache_rec, struct dix_cache_key);
+
+M0_TL_DESCR_DEFINE(dix_cache_lru, "LRU of DIX index values", static,
+		   struct dix_cache_rec, dcr_lru_link, dcr_lru_magic,
+		   M0_DIX_CACHE_LRU_MAGIC, M0_DIX_CACHE_LRU_HEAD_MAGIC);
+M0_TL_DEFINE(dix_cache_lru, static, struct dix_cache_rec);
+
 /**
  * Instance of Motr DIX client index service.
  */
 struct dix_inst {
 	/** Motr DIX client. */
 	struct m0_dix_cli di_dixc;
+	/** Cache of index values. */
+	struct dix_cache  di_cache;
 	/**
 	 * Default motr pool version, where all distributed indices are created.
 	 */
@@ -65,6 +151,8 @@ struct dix_inst {
 	 * object.
 	 */
 	struct m0_fid     di_index_pver;
+	/** Copy of m0_idx_dix_config::kc_batch. */
+	bool              di_batch;
 };
 
 struct dix_req {
@@ -95,6 +183,50 @@ struct dix_req {
 	 * It's true for M0_IC_LOOKUP and M0_IC_LIST operations.
 	 */
 	bool                     idr_meta;
+	/** Value of dix_cache::dc_gen when GET operation is launched. */
+	uint64_t                 idr_cache_gen;
+	/** Batch of operations the request is sent for, or NULL. */
+	struct dix_batch        *idr_batch;
+	/**
+	 * Waits for the connection to the CAS service of a non-distributed
+	 * index, see m0_pools_common::pc_lazy_connect.
+	 */
+	struct m0_reqh_service_connect_waiter idr_conn_wait;
+};
+
+/**
+ * PUT or GET operations merged into a single DIX request.
+ *
+ * A batch is formed by dix_batch_begin() from operations of a single
+ * m0_op_launch() call, which are on the same index and have the same opcode
+ * and flags. An operation joins the batch when it is launched, instead of
+ * creating its own request. dix_batch_end() then sends one request for
+ * all joined operations on behalf of the first of them (the leader): keys
+ * and values of the operations are concatenated into vectors, which
+ * temporarily replace the vectors of the leader. DIX client splits records
+ * of the request between CAS services as usual, so records of different
+ * operations going to the same service share CAS fops.
+ *
+ * When the request completes, return codes (and values for GET) are copied
+ * back to the operations and all of them are completed.
+ */
+struct dix_batch {
+	/** Operations the batch is formed for. */
+	struct m0_op_idx       **db_ops;
+	uint32_t                 db_nr;
+	/** Operations joined the batch when launched, the leader is first. */
+	struct m0_op_idx       **db_members;
+	uint32_t                 db_joined;
+	/** The oldest dix_cache::dc_gen of joined GET operations. */
+	uint64_t                 db_cache_gen;
+	/** Keys, values and return codes of all joined operations. */
+	struct m0_bufvec         db_keys;
+	struct m0_bufvec         db_vals;
+	int32_t                 *db_rcs;
+	/** Own vectors of the leader. */
+	struct m0_bufvec        *db_keys0;
+	struct m0_bufvec        *db_vals0;
+	int32_t                 *db_rcs0;
 };
 
 static bool dixreq_clink_cb(struct m0_clink *cl);
@@ -102,6 +234,8 @@ static bool dixreq_clink_dtx_cb(struct m0_clink *cl);
 static bool dix_meta_req_clink_cb(struct m0_clink *cl);
 static void dix_req_immed_failure(struct dix_req *req, int rc);
 static void dixreq_completed_post(struct dix_req *req, int rc);
+static void cas_req_connected_ast(struct m0_sm_group *grp,
+				  struct m0_sm_ast   *ast);
 
 static bool idx_is_distributed(const struct m0_op_idx *oi)
 {
@@ -206,6 +340,257 @@ M0_INTERNAL struct m0_dix_cli *ol_dixc(const struct m0_op_layout *ol)
 	return &ent_dix_inst(ol->ol_oc.oc_op.op_entity)->di_dixc;
 }
 
+/*--------------------------------------------------------------------------*
+ *                          Cache of index values                           *
+ *--------------------------------------------------------------------------*/
+
+static bool dix_cache_is_enabled(const struct dix_cache *cache)
+{
+	return cache->dc_max != 0;
+}
+
+static int dix_cache_init(struct dix_cache               *cache,
+			  const struct m0_idx_dix_config *config)
+{
+	int rc;
+
+	M0_SET0(cache);
+	if (config->kc_cache_size == 0)
+		return 0;
+	m0_mutex_init(&cache->dc_lock);
+	dix_cache_lru_tlist_init(&cache->dc_lru);
+	rc = dix_cache_htable_init(&cache->dc_recs, DIX_CACHE_BUCKETS_NR);
+	if (rc != 0) {
+		dix_cache_lru_tlist_fini(&cache->dc_lru);
+		m0_mutex_fini(&cache->dc_lock);
+		return M0_ERR(rc);
+	}
+	cache->dc_max = config->kc_cache_size;
+	cache->dc_ttl = config->kc_cache_ttl ?: DIX_CACHE_TTL_DEF;
+	return 0;
+}
+
+static m0_bcount_t dix_cache_rec_size(const struct dix_cache_rec *rec)
+{
+	return sizeof *rec + rec->dcr_key.dck_key.b_nob + rec->dcr_val.b_nob;
+}
+
+static void dix_cache_rec_del(struct dix_cache     *cache,
+			      struct dix_cache_rec *rec)
+{
+	M0_PRE(m0_mutex_is_locked(&cache->dc_lock));
+	dix_cache_htable_del(&cache->dc_recs, rec);
+	m0_tlink_fini(&dix_cache_tl, rec);
+	dix_cache_lru_tlink_del_fini(rec);
+	cache->dc_size -= dix_cache_rec_size(rec);
+	m0_buf_free(&rec->dcr_key.dck_key);
+	m0_buf_free(&rec->dcr_val);
+	m0_free(rec);
+}
+
+static void dix_cache_fini(struct dix_cache *cache)
+{
+	struct dix_cache_rec *rec;
+
+	if (!dix_cache_is_enabled(cache))
+		return;
+	m0_mutex_lock(&cache->dc_lock);
+	while ((rec = dix_cache_lru_tlist_head(&cache->dc_lru)) != NULL)
+		dix_cache_rec_del(cache, rec);
+	m0_mutex_unlock(&cache->dc_lock);
+	M0_ASSERT(cache->dc_size == 0);
+	dix_cache_htable_fini(&cache->dc_recs);
+	dix_cache_lru_tlist_fini(&cache->dc_lru);
+	m0_mutex_fini(&cache->dc_lock);
+}
+
+/** Returns non-expired record of the key, drops it if it is expired. */
+static struct dix_cache_rec *dix_cache_lookup(struct dix_cache    *cache,
+					      const struct m0_fid *ifid,
+					      void                *key,
+					      m0_bcount_t          nob)
+{
+	struct dix_cache_key  k = {
+		.dck_ifid = *ifid,
+		.dck_key  = M0_BUF_INIT(nob, key)
+	};
+	struct dix_cache_rec *rec;
+
+	M0_PRE(m0_mutex_is_locked(&cache->dc_lock));
+	rec = dix_cache_htable_lookup(&cache->dc_recs, &k);
+	if (rec != NULL && rec->dcr_expire < m0_time_now()) {
+		dix_cache_rec_del(cache, rec);
+		rec = NULL;
+	}
+	return rec;
+}
+
+static void dix_cache_add(struct dix_cache    *cache,
+			  const struct m0_fid *ifid,
+			  struct m0_buf       *key,
+			  struct m0_buf       *val)
+{
+	struct dix_cache_rec *rec;
+	m0_bcount_t           size = sizeof *rec + key->b_nob + val->b_nob;
+
+	M0_PRE(m0_mutex_is_locked(&cache->dc_lock));
+	rec = dix_cache_lookup(cache, ifid, key->b_addr, key->b_nob);
+	if (rec != NULL)
+		dix_cache_rec_del(cache, rec);
+	if (size > cache->dc_max)
+		return;
+	M0_ALLOC_PTR(rec);
+	if (rec == NULL)
+		return;
+	if (m0_buf_copy(&rec->dcr_key.dck_key, key) != 0 ||
+	    m0_buf_copy(&rec->dcr_val, val) != 0) {
+		m0_buf_free(&rec->dcr_key.dck_key);
+		m0_free(rec);
+		return;
+	}
+	rec->dcr_key.dck_ifid = *ifid;
+	rec->dcr_expire = m0_time_add(m0_time_now(), cache->dc_ttl);
+	while (cache->dc_size + size > cache->dc_max)
+		dix_cache_rec_del(cache,
+				  dix_cache_lru_tlist_tail(&cache->dc_lru));
+	m0_tlink_init(&dix_cache_tl, rec);
+	dix_cache_htable_add(&cache->dc_recs, rec);
+	dix_cache_lru_tlink_init_at(rec, &cache->dc_lru);
+	cache->dc_size += size;
+}
+
+/**
+ * Completes GET operation from the cache if values of all its keys are cached.
+ * Otherwise returns false and sets "gen" to the current generation of the
+ * cache.
+ */
+static bool dix_cache_get(struct m0_op_idx *oi, uint64_t *gen)
+{
+	struct dix_cache     *cache = &dix_inst(oi)->di_cache;
+	struct m0_bufvec     *keys  = oi->oi_keys;
+	struct m0_bufvec     *vals  = oi->oi_vals;
+	struct dix_cache_rec *rec;
+	uint32_t              nr    = keys->ov_vec.v_nr;
+	uint32_t              i;
+	bool                  hit;
+
+	if (!dix_cache_is_enabled(cache) || oi->oi_flags & M0_OIF_NO_CACHE)
+		return false;
+	m0_mutex_lock(&cache->dc_lock);
+	hit = m0_forall(j, nr, dix_cache_lookup(cache, OI_IFID(oi),
+						keys->ov_buf[j],
+						keys->ov_vec.v_count[j]) !=
+			       NULL);
+	for (i = 0; hit && i < nr; i++) {
+		struct m0_buf val;
+
+		rec = dix_cache_lookup(cache, OI_IFID(oi), keys->ov_buf[i],
+				       keys->ov_vec.v_count[i]);
+		if (m0_buf_copy(&val, &rec->dcr_val) != 0) {
+			while (i-- > 0) {
+				m0_free0(&vals->ov_buf[i]);
+				vals->ov_vec.v_count[i] = 0;
+			}
+			hit = false;
+			break;
+		}
+		vals->ov_buf[i] = val.b_addr;
+		vals->ov_vec.v_count[i] = val.b_nob;
+		oi->oi_rcs[i] = 0;
+		dix_cache_lru_tlist_move(&cache->dc_lru, rec);
+	}
+	if (hit)
+		cache->dc_hits++;
+	else
+		cache->dc_misses++;
+	*gen = cache->dc_gen;
+	m0_mutex_unlock(&cache->dc_lock);
+	return hit;
+}
+
+/**
+ * Caches values retrieved by GET operation, unless the cache was invalidated
+ * after the operation had been launched.
+ */
+static void dix_cache_fill(struct dix_req *req)
+{
+	struct m0_op_idx *oi    = req->idr_oi;
+	struct dix_cache *cache = &dix_inst(oi)->di_cache;
+	struct m0_bufvec *keys  = oi->oi_keys;
+	struct m0_bufvec *vals  = oi->oi_vals;
+	uint32_t          i;
+
+	if (!dix_cache_is_enabled(cache) || oi->oi_flags & M0_OIF_NO_CACHE)
+		return;
+	m0_mutex_lock(&cache->dc_lock);
+	for (i = 0; req->idr_cache_gen == cache->dc_gen &&
+		    i < keys->ov_vec.v_nr; i++) {
+		/* Empty values aren't cached, see dix_cache_get(). */
+		if (oi->oi_rcs[i] == 0 && vals->ov_vec.v_count[i] != 0)
+			dix_cache_add(cache, OI_IFID(oi),
+				      &M0_BUF_INIT(keys->ov_vec.v_count[i],
+						   keys->ov_buf[i]),
+				      &M0_BUF_INIT(vals->ov_vec.v_count[i],
+						   vals->ov_buf[i]));
+	}
+	m0_mutex_unlock(&cache->dc_lock);
+}
+
+/**
+ * Drops cached values of the keys of PUT or DEL operation or all cached values
+ * of the index deleted by the operation.
+ */
+static void dix_cache_invalidate(struct m0_op_idx *oi)
+{
+	struct dix_cache     *cache = &dix_inst(oi)->di_cache;
+	struct m0_bufvec     *keys  = oi->oi_keys;
+	struct dix_cache_rec *rec;
+	uint32_t              i;
+
+	if (!dix_cache_is_enabled(cache))
+		return;
+	m0_mutex_lock(&cache->dc_lock);
+	cache->dc_gen++;
+	if (oi->oi_oc.oc_op.op_code == M0_EO_DELETE) {
+		m0_tl_for(dix_cache_lru, &cache->dc_lru, rec) {
+			if (m0_fid_eq(&rec->dcr_key.dck_ifid, OI_IFID(oi)))
+				dix_cache_rec_del(cache, rec);
+		} m0_tl_endfor;
+	} else {
+		for (i = 0; i < keys->ov_vec.v_nr; i++) {
+			rec = dix_cache_lookup(cache, OI_IFID(oi),
+					       keys->ov_buf[i],
+					       keys->ov_vec.v_count[i]);
+			if (rec != NULL)
+				dix_cache_rec_del(cache, rec);
+		}
+	}
+	m0_mutex_unlock(&cache->dc_lock);
+}
+
+static void dix_cache_update(struct dix_req *req, int rc)
+{
+	struct m0_op_idx *oi = req->idr_oi;
+
+	switch (oi->oi_oc.oc_op.op_code) {
+	case M0_IC_GET:
+		if (rc == 0)
+			dix_cache_fill(req);
+		break;
+	case M0_IC_PUT:
+	case M0_IC_DEL:
+	case M0_EO_DELETE:
+		/*
+		 * Values may be changed even if the operation failed, drop
+		 * them once again, as GET may have cached them meanwhile.
+		 */
+		dix_cache_invalidate(oi);
+		break;
+	default:
+		break;
+	}
+}
+
 /*--------------------------------------------------------------------------*
  *                  Non-distributed (CAS) indices routines                  *
  *--------------------------------------------------------------------------*/
@@ -400,7 +785,7 @@ static void cas_index_create_ast(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 
 	M0_ENTRY();
 	cas_req_prepare(dix_req, &cid, oi);
-	rc = m0_cas_index_create(creq, &cid, 1, NULL);
+	rc = m0_cas_index_create(creq, &cid, 1, NULL, 0);
 	if (rc != 0)
 		dix_req_immed_failure(dix_req, M0_ERR(rc));
 	M0_LEAVE();
@@ -612,6 +997,8 @@ static void cas_req_init(struct dix_req   *req,
 	M0_ASSERT(svc != NULL);
 	m0_cas_req_init(&req->idr_creq, &svc->sc_rlink.rlk_sess, oi->oi_sm_grp);
 	m0_clink_init(&req->idr_clink, casreq_clink_cb);
+	m0_reqh_service_connect_waiter_init(&req->idr_conn_wait, oi->oi_sm_grp,
+					    &cas_req_connected_ast);
 }
 
 static int dix_mreq_create(struct m0_op_idx  *oi,
@@ -685,9 +1072,21 @@ static int dix_req_create(struct m0_op_idx  *oi,
 	return M0_RC(rc);
 }
 
+static void dix_batch_free(struct dix_batch *b)
+{
+	m0_bufvec_free2(&b->db_keys);
+	m0_bufvec_free2(&b->db_vals);
+	m0_free(b->db_rcs);
+	m0_free(b->db_members);
+	m0_free(b->db_ops);
+	m0_free(b);
+}
+
 static void dix_req_destroy(struct dix_req *req)
 {
 	M0_ENTRY();
+	if (req->idr_batch != NULL)
+		dix_batch_free(req->idr_batch);
 	m0_clink_fini(&req->idr_clink);
 	m0_bufvec_free(&req->idr_start_key);
 	if (idx_is_distributed(req->idr_oi)) {
@@ -696,6 +1095,7 @@ static void dix_req_destroy(struct dix_req *req)
 		else
 			m0_dix_req_fini(&req->idr_dreq);
 	} else {
+		m0_reqh_service_connect_waiter_fini(&req->idr_conn_wait);
 		m0_cas_req_fini(&req->idr_creq);
 	}
 	m0_clink_fini(&req->idr_dtx_clink);
@@ -703,13 +1103,9 @@ static void dix_req_destroy(struct dix_req *req)
 	M0_LEAVE();
 }
 
-static void dixreq_completed_ast(struct m0_sm_group *grp, struct m0_sm_ast *ast)
+static void dix_op_completed_post(struct m0_op_idx *oi, int rc)
 {
-	struct dix_req          *req = ast->sa_datum;
-	struct m0_op_idx        *oi = req->idr_oi;
-	int                      rc = oi->oi_ar.ar_rc;
-
-	M0_ENTRY();
+	oi->oi_ar.ar_rc = rc;
 	oi->oi_ar.ar_ast.sa_cb = (rc == 0) ? idx_op_ast_complete :
 					     idx_op_ast_fail;
 	oi->oi_in_completion = true;
@@ -718,6 +1114,47 @@ static void dixreq_completed_ast(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 	 *   oi->oi_ar.ar_ast.sa_cb(oi->oi_sm_grp, &oi->oi_ar.ar_ast)
 	 */
 	m0_sm_ast_post(oi->oi_sm_grp, &oi->oi_ar.ar_ast);
+}
+
+/** Copies results of the batch request to its operations and completes them. */
+static void dix_batch_done(struct dix_batch *b, int rc)
+{
+	struct m0_op_idx *lead = b->db_members[0];
+	struct m0_op_idx *oi;
+	bool              get = lead->oi_oc.oc_op.op_code == M0_IC_GET;
+	uint32_t          off = 0;
+	uint32_t          i;
+	uint32_t          k;
+
+	lead->oi_keys = b->db_keys0;
+	lead->oi_vals = b->db_vals0;
+	lead->oi_rcs  = b->db_rcs0;
+	for (i = 0; i < b->db_joined; i++) {
+		oi = b->db_members[i];
+		for (k = 0; k < oi->oi_keys->ov_vec.v_nr; k++, off++) {
+			oi->oi_rcs[k] = b->db_rcs[off];
+			if (get) {
+				oi->oi_vals->ov_vec.v_count[k] =
+					b->db_vals.ov_vec.v_count[off];
+				oi->oi_vals->ov_buf[k] = b->db_vals.ov_buf[off];
+				b->db_vals.ov_buf[off] = NULL;
+			}
+		}
+		dix_op_completed_post(oi, rc);
+	}
+}
+
+static void dixreq_completed_ast(struct m0_sm_group *grp, struct m0_sm_ast *ast)
+{
+	struct dix_req          *req = ast->sa_datum;
+	struct m0_op_idx        *oi = req->idr_oi;
+	int                      rc = oi->oi_ar.ar_rc;
+
+	M0_ENTRY();
+	if (req->idr_batch != NULL)
+		dix_batch_done(req->idr_batch, rc);
+	else
+		dix_op_completed_post(oi, rc);
 	dix_req_destroy(req);
 	M0_LEAVE();
 }
@@ -729,6 +1166,7 @@ static void dixreq_completed_post(struct dix_req *req, int rc)
 	M0_ENTRY();
 	M0_ASSERT(req->idr_ast.sa_cb != dixreq_completed_ast);
 	oi->oi_ar.ar_rc = rc;
+	dix_cache_update(req, rc);
 	req->idr_ast.sa_cb = dixreq_completed_ast;
 	req->idr_ast.sa_datum = req;
 	m0_sm_ast_post(oi->oi_sm_grp, &req->idr_ast);
@@ -934,6 +1372,20 @@ static bool dixreq_clink_cb(struct m0_clink *cl)
 	return false;
 }
 
+static void cas_req_connected_ast(struct m0_sm_group *grp,
+				  struct m0_sm_ast   *ast)
+{
+	struct dix_req *req = M0_AMB(req, ast, idr_conn_wait.scw_ast);
+	int             rc  = req->idr_conn_wait.scw_rc;
+
+	M0_ENTRY("req=%p rc=%d", req, rc);
+	if (rc != 0)
+		dixreq_completed_post(req, M0_ERR(rc));
+	else
+		req->idr_ast.sa_cb(grp, &req->idr_ast);
+	M0_LEAVE();
+}
+
 static void dix_req_immed_failure(struct dix_req *req, int rc)
 {
 	struct m0_op_idx *oi = req->idr_oi;
@@ -951,9 +1403,20 @@ static void dix_req_exec(struct dix_req  *req,
 			 void           (*exec_fn)(struct m0_sm_group *grp,
 				                   struct m0_sm_ast   *ast))
 {
+	struct m0_reqh_service_ctx *svc;
+
 	M0_ENTRY();
 	req->idr_ast.sa_cb = exec_fn;
 	req->idr_ast.sa_datum = req;
+	if (!idx_is_distributed(req->idr_oi)) {
+		/* Sent by cas_req_connected_ast() if the service connects. */
+		svc = m0_reqh_service_ctx_from_session(req->idr_creq.ccr_sess);
+		if (m0_reqh_service_connect_waiter_arm(&req->idr_conn_wait,
+						       svc)) {
+			M0_LEAVE();
+			return;
+		}
+	}
 	m0_sm_ast_post(req->idr_oi->oi_sm_grp, &req->idr_ast);
 	M0_LEAVE();
 }
@@ -1274,6 +1737,7 @@ static int dix_index_delete(struct m0_op_idx *oi)
  	 * Remove this logic once configuration option is available in S3. 
   	 */	
 	dix_set_idx_flags(oi);
+	dix_cache_invalidate(oi);
 	rc = dix_req_create(oi, &req);
 	if (rc != 0)
 		return M0_ERR(rc);
@@ -1319,6 +1783,161 @@ static int dix_index_list(struct m0_op_idx *oi)
 	return 1;
 }
 
+static struct m0_op_idx *dix_batch_op(struct m0_op *op)
+{
+	if (op->op_entity == NULL || op->op_entity->en_type != M0_ET_IDX ||
+	    !M0_IN(op->op_code, (M0_IC_PUT, M0_IC_GET)))
+		return NULL;
+	return bob_of(op, struct m0_op_idx, oi_oc.oc_op, &oi_bobtype);
+}
+
+static bool dix_batch_can(const struct m0_op_idx *oi)
+{
+	return oi != NULL && oi->oi_batch == NULL && oi->oi_dtx == NULL &&
+	       oi->oi_oc.oc_op.op_sm.sm_state == M0_OS_INITIALISED &&
+	       idx_is_distributed(oi) && dix_inst(oi)->di_batch;
+}
+
+static bool dix_batch_match(const struct m0_op_idx *lead,
+			    const struct m0_op_idx *oi)
+{
+	return oi->oi_idx == lead->oi_idx &&
+	       oi->oi_oc.oc_op.op_code == lead->oi_oc.oc_op.op_code &&
+	       oi->oi_flags == lead->oi_flags;
+}
+
+static void dix_batch_add(struct dix_batch *b, struct m0_op_idx *oi)
+{
+	b->db_ops[b->db_nr++] = oi;
+	oi->oi_batch = b;
+	/* Operations of a batch are completed in the same group. */
+	oi->oi_sm_grp = b->db_ops[0]->oi_sm_grp;
+}
+
+/** Groups operations which can be sent in one request into batches. */
+static void dix_batch_begin(struct m0_op **ops, uint32_t nr)
+{
+	struct dix_batch *b;
+	struct m0_op_idx *lead;
+	struct m0_op_idx *oi;
+	uint32_t          i;
+	uint32_t          j;
+
+	for (i = 0; i < nr; i++) {
+		lead = dix_batch_op(ops[i]);
+		if (!dix_batch_can(lead))
+			continue;
+		b = NULL;
+		for (j = i + 1; j < nr; j++) {
+			oi = dix_batch_op(ops[j]);
+			if (!dix_batch_can(oi) || !dix_batch_match(lead, oi))
+				continue;
+			if (b == NULL) {
+				M0_ALLOC_PTR(b);
+				if (b != NULL) {
+					M0_ALLOC_ARR(b->db_ops, nr - i);
+					M0_ALLOC_ARR(b->db_members, nr - i);
+				}
+				if (b == NULL || b->db_ops == NULL ||
+				    b->db_members == NULL) {
+					/* Launch operations one by one. */
+					if (b != NULL)
+						dix_batch_free(b);
+					return;
+				}
+				dix_batch_add(b, lead);
+			}
+			dix_batch_add(b, oi);
+		}
+	}
+}
+
+static void dix_batch_join(struct m0_op_idx *oi, uint64_t gen)
+{
+	struct dix_batch *b = oi->oi_batch;
+
+	M0_PRE(b->db_joined < b->db_nr);
+	if (b->db_joined == 0 || gen < b->db_cache_gen)
+		b->db_cache_gen = gen;
+	b->db_members[b->db_joined++] = oi;
+}
+
+/** Sends a single request for all operations joined the batch. */
+static void dix_batch_fire(struct dix_batch *b)
+{
+	struct m0_op_idx *lead;
+	struct m0_op_idx *oi;
+	struct dix_req   *req;
+	bool              get;
+	uint32_t          nr = 0;
+	uint32_t          off = 0;
+	uint32_t          i;
+	uint32_t          k;
+	int               rc;
+
+	for (i = 0; i < b->db_nr; i++)
+		b->db_ops[i]->oi_batch = NULL;
+	if (b->db_joined == 0) {
+		dix_batch_free(b);
+		return;
+	}
+	lead = b->db_members[0];
+	get = lead->oi_oc.oc_op.op_code == M0_IC_GET;
+	for (i = 0; i < b->db_joined; i++)
+		nr += b->db_members[i]->oi_keys->ov_vec.v_nr;
+	rc = m0_bufvec_empty_alloc(&b->db_keys, nr) ?:
+	     m0_bufvec_empty_alloc(&b->db_vals, nr);
+	if (rc == 0) {
+		M0_ALLOC_ARR(b->db_rcs, nr);
+		if (b->db_rcs == NULL)
+			rc = M0_ERR(-ENOMEM);
+	}
+	rc = rc ?: dix_req_create(lead, &req);
+	if (rc != 0) {
+		for (i = 0; i < b->db_joined; i++)
+			dix_op_completed_post(b->db_members[i], rc);
+		dix_batch_free(b);
+		return;
+	}
+	for (i = 0; i < b->db_joined; i++) {
+		oi = b->db_members[i];
+		for (k = 0; k < oi->oi_keys->ov_vec.v_nr; k++, off++) {
+			b->db_keys.ov_buf[off] = oi->oi_keys->ov_buf[k];
+			b->db_keys.ov_vec.v_count[off] =
+				oi->oi_keys->ov_vec.v_count[k];
+			if (!get) {
+				b->db_vals.ov_buf[off] = oi->oi_vals->ov_buf[k];
+				b->db_vals.ov_vec.v_count[off] =
+					oi->oi_vals->ov_vec.v_count[k];
+			}
+		}
+		/* Cancellation of any operation cancels the request. */
+		oi->oi_dix_req = req;
+	}
+	b->db_keys0 = lead->oi_keys;
+	b->db_vals0 = lead->oi_vals;
+	b->db_rcs0  = lead->oi_rcs;
+	lead->oi_keys = &b->db_keys;
+	lead->oi_vals = &b->db_vals;
+	lead->oi_rcs  = b->db_rcs;
+	req->idr_batch = b;
+	req->idr_cache_gen = b->db_cache_gen;
+	dix_req_exec(req, get ? dix_get_ast : dix_put_ast);
+}
+
+static void dix_batch_end(struct m0_op **ops, uint32_t nr)
+{
+	struct m0_op_idx *oi;
+	uint32_t          i;
+
+	for (i = 0; i < nr; i++) {
+		oi = dix_batch_op(ops[i]);
+		/* dix_batch_fire() resets oi_batch of all batch operations. */
+		if (oi != NULL && oi->oi_batch != NULL)
+			dix_batch_fire(oi->oi_batch);
+	}
+}
+
 static int dix_put(struct m0_op_idx *oi)
 {
 	struct dix_req *req;
@@ -1330,7 +1949,12 @@ static int dix_put(struct m0_op_idx *oi)
  	 * Remove this logic once configuration option is available in S3. 
   	 */	
 	dix_set_idx_flags(oi);
+	dix_cache_invalidate(oi);
 
+	if (oi->oi_batch != NULL) {
+		dix_batch_join(oi, 0);
+		return 1;
+	}
 	rc = dix_req_create(oi, &req);
 	if (rc != 0)
 		return M0_ERR(rc);
@@ -1341,6 +1965,7 @@ static int dix_put(struct m0_op_idx *oi)
 static int dix_get(struct m0_op_idx *oi)
 {
 	struct dix_req *req;
+	uint64_t        gen;
 	int             rc;
 
 	M0_ASSERT_INFO(oi->oi_keys->ov_vec.v_nr != 0,
@@ -1348,9 +1973,16 @@ static int dix_get(struct m0_op_idx *oi)
 	M0_ASSERT_INFO(!m0_exists(i, oi->oi_keys->ov_vec.v_nr,
 			          oi->oi_keys->ov_buf[i] == NULL),
 		       "NULL key is not allowed");
+	if (dix_cache_get(oi, &gen))
+		return 0;
+	if (oi->oi_batch != NULL) {
+		dix_batch_join(oi, gen);
+		return 1;
+	}
 	rc = dix_req_create(oi, &req);
 	if (rc != 0)
 		return M0_ERR(rc);
+	req->idr_cache_gen = gen;
 	dix_req_exec(req, idx_is_distributed(oi) ? dix_get_ast : cas_get_ast);
 	return 1;
 }
@@ -1360,6 +1992,7 @@ static int dix_del(struct m0_op_idx *oi)
 	struct dix_req *req;
 	int             rc;
 
+	dix_cache_invalidate(oi);
 	rc = dix_req_create(oi, &req);
 	if (rc != 0)
 		return M0_ERR(rc);
@@ -1389,6 +2022,9 @@ static struct m0_idx_query_ops dix_query_ops = {
 	.iqo_put          = dix_put,
 	.iqo_del          = dix_del,
 	.iqo_next         = dix_next,
+
+	.iqo_batch_begin  = dix_batch_begin,
+	.iqo_batch_end    = dix_batch_end,
 };
 
 /*--------------------------------------------------------------------------*
@@ -1463,6 +2099,7 @@ static int dix_client_init(struct dix_inst          *inst,
 	 * extended to allow user providing pool version for new indices.
 	 */
 	inst->di_index_pver = root_pver;
+	inst->di_batch = config->kc_batch;
 	return M0_RC(0);
 
 cli_fini:
@@ -1486,9 +2123,11 @@ static int idx_dix_init(void *svc)
 		return M0_ERR(-ENOMEM);
 	m0c = M0_AMB(m0c, ctx, m0c_idx_svc_ctx);
 
-	rc = dix_client_init(inst, m0c,
+	rc = dix_cache_init(&inst->di_cache, ctx->isc_svc_conf) ?:
+	     dix_client_init(inst, m0c,
 			(struct m0_idx_dix_config *)ctx->isc_svc_conf);
 	if (rc != 0) {
+		dix_cache_fini(&inst->di_cache);
 		m0_free(inst);
 		return M0_ERR(rc);
 	}
@@ -1509,6 +2148,7 @@ static int idx_dix_fini(void *svc)
 	inst = ctx->isc_svc_inst;
 	m0_dix_cli_stop_lock(&inst->di_dixc);
 	m0_dix_cli_fini_lock(&inst->di_dixc);
+	dix_cache_fini(&inst->di_cache);
 	m0_free0(&inst);
 	return M0_RC(0);
 }
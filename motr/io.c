@@ -26,6 +26,8 @@
 #include "motr/addb.h"
 #include "motr/pg.h"
 #include "motr/io.h"
+#include "motr/wbc.h"
+#include "motr/ra.h"
 
 #include "lib/errno.h"             /* ENOMEM */
 #include "fid/fid.h"               /* m0_fid */
@@ -252,6 +254,12 @@ static void obj_io_cb_launch(struct m0_op_common *oc)
 	ioo = bob_of(oo, struct m0_op_io, ioo_oo, &ioo_bobtype);
 	M0_PRE_EX(m0_op_io_invariant(ioo));
 
+	if (m0__obj_connect_wait(oo))
+		goto end;
+	if (m0__obj_inline_launch(ioo) || m0__obj_ra_launch(ioo) ||
+	    m0__obj_wbc_absorb(ioo))
+		goto end;
+
 	rc = ioo->ioo_ops->iro_iomaps_prepare(ioo);
 	if (rc != 0)
 		goto end;
@@ -534,6 +542,7 @@ static int obj_io_init(struct m0_obj      *obj,
 	ioo->ioo_ext = *ext;
 	ioo->ioo_flags = flags;
 	ioo->ioo_flags |= M0_OOF_SYNC;
+	ioo->ioo_cache_io = false;
 	if (M0_IN(opcode, (M0_OC_READ, M0_OC_WRITE))) {
 		ioo->ioo_data = *data;
 		ioo->ioo_attr_mask = mask;
@@ -714,6 +723,63 @@ M0_INTERNAL void m0__obj_op_done(struct m0_op *op)
 	M0_LEAVE();
 }
 
+static void obj_io_cached_done(struct m0_sm_group *grp, struct m0_sm_ast *ast)
+{
+	struct m0_op_io *ioo = bob_of(ast, struct m0_op_io, ioo_ast,
+				      &ioo_bobtype);
+	struct m0_op    *op  = &ioo->ioo_oo.oo_oc.oc_op;
+
+	M0_ENTRY("op=%p rc=%d", op, ioo->ioo_rc);
+
+	op->op_rc = ioo->ioo_rc;
+	m0_sm_group_lock(&op->op_sm_group);
+	m0_sm_move(&op->op_sm, 0, M0_OS_EXECUTED);
+	m0_op_executed(op);
+	m0_sm_move(&op->op_sm, 0, M0_OS_STABLE);
+	m0_op_stable(op);
+	m0_sm_group_unlock(&op->op_sm_group);
+
+	m0__obj_op_done(op);
+	M0_LEAVE();
+}
+
+M0_INTERNAL void m0__obj_io_cached_done(struct m0_op_io *ioo, int rc)
+{
+	M0_PRE(ioreq_sm_state(ioo) == IRS_INITIALIZED);
+
+	ioo->ioo_rc = rc;
+	ioo->ioo_ast.sa_cb = &obj_io_cached_done;
+	m0_sm_ast_post(ioo->ioo_oo.oo_sm_grp, &ioo->ioo_ast);
+}
+
+M0_INTERNAL int m0__obj_cache_io(struct m0_obj *obj,
+				 enum m0_obj_opcode opcode,
+				 struct m0_indexvec *ext,
+				 struct m0_bufvec *data)
+{
+	struct m0_op        *op = NULL;
+	struct m0_op_common *oc;
+	struct m0_op_obj    *oo;
+	struct m0_op_io     *ioo;
+	int                  rc;
+
+	M0_PRE(M0_IN(opcode, (M0_OC_READ, M0_OC_WRITE)));
+
+	rc = m0_obj_op(obj, opcode, ext, data, NULL, 0, 0, &op);
+	if (rc != 0)
+		return M0_ERR(rc);
+	oc = bob_of(op, struct m0_op_common, oc_op, &oc_bobtype);
+	oo = bob_of(oc, struct m0_op_obj, oo_oc, &oo_bobtype);
+	ioo = bob_of(oo, struct m0_op_io, ioo_oo, &ioo_bobtype);
+	ioo->ioo_cache_io = true;
+	m0_op_launch(&op, 1);
+	rc = m0_op_wait(op, M0_BITS(M0_OS_FAILED, M0_OS_STABLE),
+			M0_TIME_NEVER) ?: op->op_rc ?: op->op_sm.sm_rc;
+	m0_op_fini(op);
+	m0_op_free(op);
+	return M0_RC(rc);
+}
+
 int m0_obj_op(struct m0_obj       *obj,
 	      enum m0_obj_opcode   opcode,
 	      struct m0_indexvec  *ext,
@@ -744,6 +810,16 @@ int m0_obj_op(struct m0_obj       *obj,
 	if (*op == NULL)
 		op_pre_allocated = false;
 
+	/* Operations not handled by the write-back cache go after its data. */
+	if (m0__obj_wbc_flush_needed(obj, opcode, ext, attr)) {
+		rc = m0_obj_wbc_flush(obj);
+		if (rc != 0)
+			goto exit;
+	}
+	rc = m0__obj_inline_prepare(obj, opcode, ext, attr, mask);
+	if (rc != 0)
+		goto exit;
+
 	/*
 	 * Lazy retrieve of layout.
 	 * TODO: this is a blocking implementation for composite layout.
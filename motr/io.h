@@ -353,6 +353,30 @@ M0_INTERNAL m0_bindex_t data_page_offset_get(struct pargrp_iomap *map,
  */
 M0_INTERNAL uint32_t ioreq_sm_state(const struct m0_op_io *ioo);
 
+/**
+ * Completes an object i/o operation served by a client cache without any
+ * network i/o. The operation is moved to STABLE in an ast and "rc" is
+ * reported in m0_op::op_rc, as for failed i/o.
+ */
+M0_INTERNAL void m0__obj_io_cached_done(struct m0_op_io *ioo, int rc);
+
+/**
+ * Performs a READ or WRITE on behalf of a client cache and waits until it is
+ * STABLE. The operation bypasses the caches.
+ */
+M0_INTERNAL int m0__obj_cache_io(struct m0_obj *obj,
+				 enum m0_obj_opcode opcode,
+				 struct m0_indexvec *ext,
+				 struct m0_bufvec *data);
+
+/**
+ * Starts the threads calculating parity of write operations of the client
+ * instance. On failure, and in kernel, parity is calculated by the thread
+ * launching the operation.
+ */
+M0_INTERNAL void m0__parity_pool_init(struct m0_client *m0c, int thread_nr);
+M0_INTERNAL void m0__parity_pool_fini(struct m0_client *m0c);
+
 /**
  * @todo This code is not required once MOTR-899 lands into dev.
  * Tolerance for the given level.
@@ -2001,6 +2001,12 @@ out:
  *    req->ir_sns_state == SRS_REPAIR_NOTDONE
  *
  *    This should not be possible.
+ *
+ * 5. device_state == M0_PNDS_SNS_REPAIRING &&
+ *    req->ir_sns_state == SRS_REPAIR_DONE_DIRECT
+ *
+ *    Not redirected. Direct repair has rebuilt the current global fid on
+ *    the replacement device, so the pages are sent to the device itself.
  */
 static bool should_spare_be_mapped(struct m0_op_io *ioo,
 				   enum m0_pool_nd_state dev_state)
@@ -2117,7 +2123,9 @@ static int nw_xfer_tioreq_map(struct nw_xfer_request           *xfer,
 
 	if (M0_IN(ioreq_sm_state(ioo), (IRS_DEGRADED_READING,
 					IRS_DEGRADED_WRITING)) &&
-	    dev_state != M0_PNDS_SNS_REPAIRED)
+	    dev_state != M0_PNDS_SNS_REPAIRED &&
+	    !(dev_state == M0_PNDS_SNS_REPAIRING &&
+	      ioo->ioo_sns_state == SRS_REPAIR_DONE_DIRECT))
 		(*tio)->ti_state = dev_state;
 
 	return M0_RC(rc);
@@ -505,6 +505,32 @@ static int pargrp_iomap_populate_pi_ivec(struct pargrp_iomap     *map,
 	return M0_RC(0);
 }
 
+/** Returns true if the request writes pages of the row. */
+static bool pargrp_iomap_row_is_written(const struct pargrp_iomap *map,
+					uint32_t row)
+{
+	struct m0_pdclust_layout *play = pdlayout_get(map->pi_ioo);
+	uint32_t                  col;
+
+	for (col = 0; col < layout_n(play); ++col) {
+		if (map->pi_databufs[row][col] != NULL &&
+		    map->pi_databufs[row][col]->db_flags & PA_WRITE)
+			return true;
+	}
+	return false;
+}
+
+static uint32_t pargrp_iomap_rows_written_nr(const struct pargrp_iomap *map)
+{
+	struct m0_pdclust_layout *play = pdlayout_get(map->pi_ioo);
+	uint32_t                  row;
+	uint32_t                  nr = 0;
+
+	for (row = 0; row < rows_nr(play, map->pi_ioo->ioo_obj); ++row)
+		nr += pargrp_iomap_row_is_written(map, row);
+	return nr;
+}
+
 /**
  * Decides whether to undertake a read-old or read-rest approach for
  * the parity group RMW IO request based on the total number of pages
@@ -518,9 +544,9 @@ static int pargrp_iomap_populate_pi_ivec(struct pargrp_iomap     *map,
  * and the new parity is calculated based on them and the new data
  * units to be written.
  *
- * In both approaches, the number of units to be written is the same
- * (new data units and udpated parity units), so we compare only the
- * number of units (pages) to be read.
+ * Read-old reads and writes parity only in the rows which are
+ * written to, read-rest writes parity of the whole group. Hence the
+ * total number of pages read and written is compared.
  *
  * By default, the segments in index vector pargrp_iomap::pi_ivec
  * are suitable for read-old approach. Hence the index vector is
@@ -536,19 +562,28 @@ static int pargrp_iomap_select_ro_rr(struct pargrp_iomap *map,
 {
 	int rc;
 	/*
-	 * In read-old the number of pages to be read is the same as
-	 * the number of pages to be written.
+	 * Pages read and written by each approach are compared.
+	 *
+	 * Read-old (read-modify-write) reads the old data of the pages to
+	 * be written and the parity of the rows they belong to, parity is
+	 * updated with the difference of old and new data, and only these
+	 * pages are written back.
 	 *
 	 * TODO: Can use number of data_buf structures instead of using
 	 * indexvec_page_nr().
 	 */
-	uint64_t ro_pages_nr = iomap_page_nr(map) + parity_pages_nr;
+	uint64_t written_nr  = iomap_page_nr(map);
+	uint64_t ro_pages_nr = 2 * (written_nr +
+				    pargrp_iomap_rows_written_nr(map) *
+				    layout_k(pdlayout_get(map->pi_ioo)));
 	/*
-	 * In read-rest the number of pages to be read is all data
-	 * pages which are not fully spanned by the io vector.
+	 * Read-rest (reconstruct-write) reads all data pages which are not
+	 * fully spanned by the io vector, parity of the whole group is
+	 * calculated anew and written.
 	 */
 	uint64_t rr_pages_nr = data_pages_nr -
-	                       map->pi_ops->pi_fullpages_find(map);
+	                       map->pi_ops->pi_fullpages_find(map) +
+			       written_nr + parity_pages_nr;
 
 	if (rr_pages_nr < ro_pages_nr || map->pi_trunc_partial) {
 		M0_LOG(M0_DEBUG, "[%p]: RR selected", map->pi_ioo);
@@ -873,14 +908,35 @@ err:
 	return M0_ERR_INFO(rc, "map=%p seg=%"PRIu32 , map, seg);
 }
 
+/**
+ * Returns true iff the application memory at the cursor can be used as the
+ * data buffer of a block directly (zero copy): it must be network-aligned and
+ * the current segment must cover the whole block, because the buffer is
+ * handed to the network bulk transfer as a single segment.
+ */
+static bool databuf_app_mappable(struct m0_obj           *obj,
+				 struct m0_bufvec_cursor *data)
+{
+	return data != NULL && !m0_bufvec_cursor_move(data, 0) &&
+	       addr_is_network_aligned(m0_bufvec_cursor_addr(data)) &&
+	       m0_bufvec_cursor_step(data) >= obj_buffer_size(obj);
+}
+
 /**
  * Allocates this entry in the column/row table of the iomap.
  * This is heavily based on
  * m0t1fs/linux_kernel/file.c::pargrp_iomap_databuf_alloc
  *
+ * If the application buffer at the cursor is suitable (see
+ * databuf_app_mappable()), it is used for the data_buf and marked with
+ * PA_APP_MEMORY, so that no copy is done between the application and the
+ * network buffers. Otherwise a buffer is allocated and the data are copied by
+ * ioreq_application_data_copy().
+ *
  * @param map The io map in question.
  * @param row The row to allocate the data_buf in.
  * @param col The column to allocate the data_buf in.
+ * @param data Cursor in the application buffers or NULL.
  * @return 0 for success, or -ENOMEM.
  */
 static int pargrp_iomap_databuf_alloc(struct pargrp_iomap     *map,
@@ -908,14 +964,17 @@ static int pargrp_iomap_databuf_alloc(struct pargrp_iomap     *map,
 		return M0_ERR(-ENOMEM);
 	}
 
-	if (data)
+	if (databuf_app_mappable(obj, data)) {
 		addr = m0_bufvec_cursor_addr(data);
-
-	flags = PA_NONE | PA_APP_MEMORY;
-	/* Fall back to allocate-copy route */
-	if (!addr_is_network_aligned(addr) || addr == NULL) {
+		flags = PA_NONE | PA_APP_MEMORY;
+	} else {
+		/* Fall back to allocate-copy route */
 		addr = m0_alloc_aligned(obj_buffer_size(obj),
 				        M0_NETBUF_SHIFT);
+		if (addr == NULL) {
+			m0_free(buf);
+			return M0_ERR(-ENOMEM);
+		}
 		flags = PA_NONE;
 	}
 
@@ -923,7 +982,7 @@ static int pargrp_iomap_databuf_alloc(struct pargrp_iomap     *map,
 	M0_POST_EX(data_buf_invariant(buf));
 	map->pi_databufs[row][col] = buf;
 
-	return M0_RC(map->pi_databufs[row][col] == NULL ?  -ENOMEM : 0);
+	return M0_RC(0);
 }
 
 /**
@@ -1364,6 +1423,15 @@ static int pargrp_iomap_paritybufs_alloc(struct pargrp_iomap *map)
 				M0_LOG(M0_DEBUG, "row=%d col=%d dbuf=%p pbuf=%p ptr=%p",
 				       row, col, dbuf, pbuf, ptr);
 
+				/*
+				 * Read-old updates parity only in the rows
+				 * with written pages.
+				 */
+				if (map->pi_rtype == PIR_READOLD &&
+				    !pargrp_iomap_row_is_written(map,
+						(i * row_per_seg) + row))
+					continue;
+
 				if (M0_IN(op_code, (M0_OC_WRITE,
 						    M0_OC_FREE)))
 					dbuf->db_flags |= PA_WRITE;
@@ -1818,6 +1886,109 @@ par_fail:
 	return M0_ERR(rc);
 }
 
+/**
+ * Returns true if degraded read of the parity group can be limited to the
+ * rows which hold requested pages of failed units.
+ *
+ * A row is the set of pages at the same offset in all units of the group,
+ * parity math recovers each row independently of the others. Read-modify-
+ * write needs whole units to calculate parity, read-verify mode checks
+ * parity of whole units and replicas are recovered by a different path,
+ * so the group is read entirely in these cases.
+ */
+static bool pargrp_iomap_dgmode_is_minimal(struct pargrp_iomap *map)
+{
+	struct m0_op_io  *ioo = map->pi_ioo;
+	struct m0_client *instance;
+
+	instance = m0__op_instance(&ioo->ioo_oo.oo_oc.oc_op);
+	return ioo->ioo_oo.oo_oc.oc_op.op_code == M0_OC_READ &&
+	       !instance->m0c_config->mc_is_read_verify &&
+	       !m0_pdclust_is_replicated(pdlayout_get(ioo));
+}
+
+/** Returns true if the row holds a requested page of a failed data unit. */
+static bool pargrp_iomap_row_is_lost(const struct pargrp_iomap *map,
+				     uint32_t row)
+{
+	struct m0_pdclust_layout *play = pdlayout_get(map->pi_ioo);
+	struct data_buf          *dbuf;
+	uint32_t                  col;
+
+	for (col = 0; col < layout_n(play); ++col) {
+		dbuf = map->pi_databufs[row][col];
+		if (dbuf != NULL && (dbuf->db_flags & PA_READ) &&
+		    (dbuf->db_flags & PA_READ_FAILED))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Reduces the degraded read of the group to the pages needed to
+ * reconstruct the requested pages.
+ *
+ * Rows without requested pages of failed units are not read at all. In
+ * the remaining rows only as many parity units are read as there are
+ * failed data units, the rest of parity units are treated as failed and
+ * are reconstructed along with the data. With LRC not every set of
+ * layout_n() alive units is sufficient, so all parity is read there.
+ */
+static void pargrp_iomap_dgmode_minimise(struct pargrp_iomap *map)
+{
+	struct m0_pdclust_layout *play;
+	struct m0_op_io          *ioo;
+	uint32_t                  row;
+	uint32_t                  col;
+	uint32_t                  failed = 0;
+	uint32_t                  extra;
+
+	ioo = map->pi_ioo;
+	play = pdlayout_get(ioo);
+
+	for (row = 0; row < rows_nr(play, ioo->ioo_obj); ++row) {
+		if (pargrp_iomap_row_is_lost(map, row))
+			continue;
+		for (col = 0; col < layout_n(play); ++col) {
+			if (map->pi_databufs[row][col] != NULL)
+				map->pi_databufs[row][col]->db_flags &=
+					~PA_DGMODE_READ;
+		}
+		for (col = 0; col < layout_k(play); ++col)
+			map->pi_paritybufs[row][col]->db_flags &=
+				~PA_DGMODE_READ;
+	}
+
+	if (parity_math(ioo)->pmi_parity_algo == M0_PARITY_CAL_ALGO_LRC)
+		return;
+
+	for (col = 0; col < layout_n(play); ++col) {
+		if (map->pi_databufs[0][col] != NULL &&
+		    map->pi_databufs[0][col]->db_flags & PA_READ_FAILED)
+			++failed;
+	}
+	for (col = 0; col < layout_k(play); ++col) {
+		if (map->pi_paritybufs[0][col]->db_flags & PA_READ_FAILED)
+			++failed;
+	}
+	if (failed >= layout_k(play))
+		return;
+	extra = layout_k(play) - failed;
+
+	/* Skips alive parity units starting from the last one. */
+	for (col = layout_k(play); col > 0 && extra > 0; --col) {
+		if (map->pi_paritybufs[0][col - 1]->db_flags & PA_READ_FAILED)
+			continue;
+		for (row = 0; row < rows_nr(play, ioo->ioo_obj); ++row) {
+			map->pi_paritybufs[row][col - 1]->db_flags &=
+				~PA_DGMODE_READ;
+			map->pi_paritybufs[row][col - 1]->db_flags |=
+				PA_READ_FAILED;
+		}
+		--extra;
+	}
+}
+
 /**
  * Re-organises and allocates buffers for data and parity matrices.
  * This is heavily based on
@@ -1956,6 +2127,8 @@ static int pargrp_iomap_dgmode_postprocess(struct pargrp_iomap *map)
 	}
 	if (rc != 0)
 		goto err;
+	if (pargrp_iomap_dgmode_is_minimal(map))
+		pargrp_iomap_dgmode_minimise(map);
 	return M0_RC(rc);
 err:
 	return M0_ERR(rc);
@@ -2004,6 +2177,7 @@ static int pargrp_iomap_dgmode_recover(struct pargrp_iomap *map)
 	uint32_t                  col;
 	uint32_t                  k;
 	uint64_t                  pagesize;
+	bool                      minimal;
 	void                     *zpage;
 	struct m0_buf            *data;
 	struct m0_buf            *parity;
@@ -2057,8 +2231,12 @@ static int pargrp_iomap_dgmode_recover(struct pargrp_iomap *map)
 		goto end;
 	}
 
+	minimal = pargrp_iomap_dgmode_is_minimal(map);
 	/* Populates data and failed buffers. */
 	for (row = 0; row < rows_nr(play, ioo->ioo_obj); ++row) {
+		/* Rows without requested lost pages were not read. */
+		if (minimal && !pargrp_iomap_row_is_lost(map, row))
+			continue;
 		for (col = 0; col < layout_n(play); ++col) {
 			data[col].b_nob = pagesize;
 
@@ -25,6 +25,7 @@
 #include "motr/addb.h"
 #include "motr/pg.h"
 #include "motr/io.h"
+#include "motr/wbc.h"             /* m0__obj_wbc_read */
 
 #include "lib/errno.h"
 #include "lib/semaphore.h"       /* m0_semaphore_{down|up}*/
@@ -685,6 +686,8 @@ static void ioreq_iosm_handle_executed(struct m0_sm_group *grp,
 done:
 	ioo->ioo_nwxfer.nxr_ops->nxo_complete(&ioo->ioo_nwxfer, rmw);
 	ioo->ioo_rc = 0;
+	if (op->op_code == M0_OC_READ)
+		m0__obj_wbc_read(ioo);
 
 #ifdef CLIENT_FOR_M0T1FS
 	/* XXX: TODO: update the inode size on the mds */
@@ -971,6 +974,17 @@ static uint64_t data_buf_copy(struct data_buf          *data,
 	M0_PRE(M0_IN(dir, (CD_COPY_FROM_APP, CD_COPY_TO_APP)));
 
 	bytes = data->db_buf.b_nob;
+	/*
+	 * The buffer is the application memory at the cursor (see
+	 * pargrp_iomap_databuf_alloc()), it covers the whole block.
+	 */
+	if ((data->db_flags & PA_APP_MEMORY) &&
+	    m0_bufvec_cursor_addr(app_datacur) == data->db_buf.b_addr &&
+	    m0_bufvec_cursor_step(app_datacur) >= bytes) {
+		m0_bufvec_cursor_move(app_datacur, bytes);
+		M0_LEAVE();
+		return bytes;
+	}
 	while (bytes > 0) {
 		app_data     = m0_bufvec_cursor_addr(app_datacur);
 		app_data_len = m0_bufvec_cursor_step(app_datacur);
@@ -1331,6 +1345,97 @@ static int ioreq_application_data_copy(struct m0_op_io *ioo,
 	return M0_RC(0);
 }
 
+enum {
+	/** Least number of parity groups calculated by m0c_parity_pool. */
+	IOREQ_PARITY_POOL_MIN_NR = 2,
+	/** Number of parity groups passed to m0c_parity_pool at once. */
+	IOREQ_PARITY_JOBS_NR     = 64,
+};
+
+#ifndef __KERNEL__
+M0_INTERNAL void m0__parity_pool_init(struct m0_client *m0c, int thread_nr)
+{
+	int rc;
+
+	m0_mutex_init(&m0c->m0c_parity_lock);
+	rc = m0_parallel_pool_init(&m0c->m0c_parity_pool, thread_nr,
+				   IOREQ_PARITY_JOBS_NR);
+	if (rc != 0)
+		M0_LOG(M0_WARN, "Parity is calculated serially: rc=%d", rc);
+	m0c->m0c_parity_pool_on = rc == 0;
+}
+
+M0_INTERNAL void m0__parity_pool_fini(struct m0_client *m0c)
+{
+	if (m0c->m0c_parity_pool_on) {
+		m0_parallel_pool_terminate_wait(&m0c->m0c_parity_pool);
+		m0_parallel_pool_fini(&m0c->m0c_parity_pool);
+		m0c->m0c_parity_pool_on = false;
+	}
+	m0_mutex_fini(&m0c->m0c_parity_lock);
+}
+#else
+M0_INTERNAL void m0__parity_pool_init(struct m0_client *m0c, int thread_nr)
+{
+	m0_mutex_init(&m0c->m0c_parity_lock);
+	m0c->m0c_parity_pool_on = false;
+}
+
+M0_INTERNAL void m0__parity_pool_fini(struct m0_client *m0c)
+{
+	m0_mutex_fini(&m0c->m0c_parity_lock);
+}
+#endif /* __KERNEL__ */
+
+/** Job of m0c_parity_pool: calculates parity of a single group. */
+static int ioreq_parity_job(void *job)
+{
+	struct pargrp_iomap *iomap = job;
+
+	return iomap->pi_ops->pi_parity_recalc(iomap);
+}
+
+/**
+ * Calculates parity of all groups of the operation by the threads of
+ * m0c_parity_pool. The groups are independent: every job writes the parity
+ * buffers of its own group and reads only immutable layout data.
+ *
+ * @param[out] failed A group for which the calculation failed.
+ */
+static int ioreq_parity_recalc_pool(struct m0_client *m0c,
+				    struct m0_op_io *ioo,
+				    struct pargrp_iomap **failed)
+{
+#ifndef __KERNEL__
+	struct m0_parallel_pool *pool = &m0c->m0c_parity_pool;
+	void                    *job;
+	uint64_t                 i = 0;
+	int                      k;
+	int                      rc = 0;
+
+	/* Jobs of different operations must not be mixed in one batch. */
+	m0_mutex_lock(&m0c->m0c_parity_lock);
+	while (i < ioo->ioo_iomap_nr && rc == 0) {
+		for (k = 0; k < pool->pp_qlinks_nr && i < ioo->ioo_iomap_nr;
+		     ++k, ++i) {
+			rc = m0_parallel_pool_job_add(pool, ioo->ioo_iomaps[i]);
+			M0_ASSERT(rc == 0);
+		}
+		m0_parallel_pool_start(pool, &ioreq_parity_job);
+		if (m0_parallel_pool_wait(pool) != 0) {
+			/* Report the error of the first failed group. */
+			m0_parallel_pool_rc_next(pool, &job, &rc);
+			*failed = job;
+		}
+	}
+	m0_mutex_unlock(&m0c->m0c_parity_lock);
+	return rc;
+#else
+	M0_IMPOSSIBLE("Parity pool is not used in kernel.");
+	return M0_ERR(-ENOSYS);
+#endif
+}
+
 /**
  * Recalculates the parity for each row of this operations io map.
  * This is heavily based on m0t1fs/linux_kernel/file.c::ioreq_partiy_recalc
@@ -1343,17 +1448,24 @@ static int ioreq_parity_recalc(struct m0_op_io *ioo)
 	int                  rc = 0;
 	uint64_t             i;
 	struct pargrp_iomap *iomap;
+	struct m0_client    *m0c;
 
 	M0_ENTRY("io_request : %p", ioo);
 	M0_PRE_EX(m0_op_io_invariant(ioo));
 
+	m0c = m0__op_instance(&ioo->ioo_oo.oo_oc.oc_op);
 	m0_semaphore_down(&cpus_sem);
 
-	for (i = 0; i < ioo->ioo_iomap_nr; ++i) {
-		iomap = ioo->ioo_iomaps[i];
-		rc = iomap->pi_ops->pi_parity_recalc(iomap);
-		if (rc != 0)
-			break;
+	if (m0c->m0c_parity_pool_on &&
+	    ioo->ioo_iomap_nr >= IOREQ_PARITY_POOL_MIN_NR) {
+		rc = ioreq_parity_recalc_pool(m0c, ioo, &iomap);
+	} else {
+		for (i = 0; i < ioo->ioo_iomap_nr; ++i) {
+			iomap = ioo->ioo_iomaps[i];
+			rc = iomap->pi_ops->pi_parity_recalc(iomap);
+			if (rc != 0)
+				break;
+		}
 	}
 
 	m0_semaphore_up(&cpus_sem);
@@ -1498,9 +1610,10 @@ static int device_check(struct m0_op_io *ioo)
 		if (rc != 0)
 			return M0_ERR(rc);
 
-		m0_rwlock_read_lock(&pm->pm_lock);
-		node_state = node_obj->pn_state;
-		m0_rwlock_read_unlock(&pm->pm_lock);
+		rc = m0_poolmach_node_state(pm, node_obj->pn_index,
+					    &node_state);
+		if (rc != 0)
+			return M0_ERR(rc);
 
 		node_id = node_obj->pn_id.f_key;
 
@@ -243,6 +243,34 @@ static void application_attribute_copy(struct m0_indexvec *rep_ivec,
  * @param ast The AST that triggered this callback, used to find the
  *            IO operation.
  */
+/**
+ * Copies the data of an inline read reply to the client buffers, in the order
+ * of the descriptors.
+ */
+static int ioreq_fop_inline_copy(struct m0_rpc_bulk         *rbulk,
+				 struct m0_fop_cob_rw_reply *rw_reply)
+{
+	struct m0_rpc_bulk_buf  *rbuf;
+	struct m0_bufvec_cursor  cur;
+	m0_bcount_t              off = 0;
+	m0_bcount_t              nob;
+
+	if (rw_reply->rwr_data.b_nob != rbulk->rb_bytes)
+		return M0_ERR_INFO(-EPROTO, "inline data: %"PRIu64
+				   " expected: %"PRIu64,
+				   rw_reply->rwr_data.b_nob, rbulk->rb_bytes);
+	m0_mutex_lock(&rbulk->rb_mutex);
+	m0_tl_for(rpcbulk, &rbulk->rb_buflist, rbuf) {
+		nob = rbuf->bb_nbuf->nb_length;
+		m0_bufvec_cursor_init(&cur, &rbuf->bb_zerovec.z_bvec);
+		m0_bufvec_cursor_copyto(&cur, rw_reply->rwr_data.b_addr + off,
+					nob);
+		off += nob;
+	} m0_tl_endfor;
+	m0_mutex_unlock(&rbulk->rb_mutex);
+	return M0_RC(0);
+}
+
 static void io_bottom_half(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 {
 	int                          rc;
@@ -328,6 +356,8 @@ static void io_bottom_half(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 	actual_bytes = rw_reply->rwr_count;
 	rc = gen_rep->gr_rc;
 	rc = rc ?: rw_reply->rwr_rc;
+	if (rc == 0 && (rwfop->crw_flags & M0_IO_FLAG_INLINE))
+		rc = ioreq_fop_inline_copy(rbulk, rw_reply);
 	irfop->irf_reply_rc = rc;
 
 	/* Update pending transaction number */
@@ -337,10 +367,14 @@ static void io_bottom_half(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 
 ref_dec:
 	/* For whatever reason, io didn't complete successfully.
-	 * Reduce expected read bulk count */
-	if (rc < 0 && m0_is_read_fop(&iofop->if_fop))
+	 * Reduce expected read bulk count. Buffers of an inline read are
+	 * never queued, they are released here. */
+	if ((rc < 0 || (rwfop->crw_flags & M0_IO_FLAG_INLINE)) &&
+	    m0_is_read_fop(&iofop->if_fop))
 		m0_atomic64_sub(&xfer->nxr_rdbulk_nr,
 				m0_rpc_bulk_buf_length(rbulk));
+	if (rwfop->crw_flags & M0_IO_FLAG_INLINE)
+		m0_rpc_bulk_buflist_empty(rbulk);
 
 	/* Propogate the error up as many stashed-rc layers as we can */
 	if (tioreq->ti_rc == 0)
@@ -404,6 +438,8 @@ ref_dec:
 	M0_LEAVE();
 }
 
+static void iofop_co_complete(struct ioreq_fop *leader);
+
 /**
  * Callback for the rpc layer when it receives a reply fop. This schedules
  * io_bottom_half.
@@ -444,6 +480,8 @@ static void io_rpc_item_cb(struct m0_rpc_item *item)
 	M0_LOG(M0_INFO, "ioreq_fop %p, target_ioreq %p io_request %p",
 	       reqfop, reqfop->irf_tioreq, ioo);
 
+	if (reqfop->irf_co_members != NULL)
+		iofop_co_complete(reqfop);
 	m0_fop_get(&reqfop->irf_iofop.if_fop);
 	m0_sm_ast_post(ioo->ioo_sm.sm_grp, &reqfop->irf_ast);
 
@@ -659,15 +697,355 @@ const struct m0_net_buffer_callbacks client__buf_bulk_cb  = {
 	}
 };
 
+static int iofop_post(struct m0_io_fop *iofop)
+{
+	struct m0_rpc_item *item = &iofop->if_fop.f_item;
+	int                 rc;
+
+	rc = m0_rpc_post(item);
+	M0_LOG(M0_INFO, "IO fops submitted to rpc, rc = %d", rc);
+
+	M0_ADDB2_ADD(M0_AVI_CLIENT_BULK_TO_RPC, iofop->if_rbulk.rb_id,
+		     m0_sm_id_get(&item->ri_sm));
+	return rc;
+}
+
+enum {
+	/** Maximal number of fops attached to a coalescing leader. */
+	IO_COALESCE_MEMBERS_MAX = 15
+};
+
+static struct m0_op_io *irfop_ioo(const struct ioreq_fop *irfop)
+{
+	return bob_of(irfop->irf_tioreq->ti_nwxfer, struct m0_op_io,
+		      ioo_nwxfer, &ioo_bobtype);
+}
+
+/**
+ * Only small fops of healthy reads and writes without checksums are
+ * coalesced: the reply of the coalesced fop is shared by all its members and
+ * checksums of a read reply cannot be split between them.
+ */
+static bool iofop_co_is_eligible(struct ioreq_fop *irfop)
+{
+	struct m0_op_io      *ioo = irfop_ioo(irfop);
+	struct m0_op         *op = &ioo->ioo_oo.oo_oc.oc_op;
+	struct m0_config     *conf = m0__op_instance(op)->m0c_config;
+	struct m0_fop_cob_rw *rw = io_rw_get(&irfop->irf_iofop.if_fop);
+
+	return conf->mc_io_coalesce_window != 0 &&
+	       irfop->irf_iofop.if_rbulk.rb_bytes <=
+	       conf->mc_io_coalesce_size &&
+	       M0_IN(ioreq_sm_state(ioo), (IRS_READING, IRS_WRITING)) &&
+	       rw->crw_cksum_size == 0 && rw->crw_di_data.b_nob == 0 &&
+	       rw->crw_di_data_cksum.b_nob == 0 &&
+	       !(rw->crw_flags & M0_IO_FLAG_INLINE) &&
+	       !(op->op_code == M0_OC_READ &&
+		 m0__obj_is_cksum_validation_allowed(ioo));
+}
+
+static bool ivec_overlaps(const struct m0_io_indexvec *a,
+			  const struct m0_io_indexvec *b)
+{
+	return m0_exists(i, a->ci_nr, m0_exists(j, b->ci_nr,
+		a->ci_iosegs[i].ci_index <
+		b->ci_iosegs[j].ci_index + b->ci_iosegs[j].ci_count &&
+		b->ci_iosegs[j].ci_index <
+		a->ci_iosegs[i].ci_index + a->ci_iosegs[i].ci_count));
+}
+
+/**
+ * Returns true iff fop can be sent as a member of the leader.
+ *
+ * Writes of the same cob extent are not coalesced, because the ioservice
+ * executes descriptors of a fop concurrently.
+ */
+static bool iofop_co_match(struct ioreq_fop *leader, struct ioreq_fop *irfop)
+{
+	struct m0_fop        *lfop = &leader->irf_iofop.if_fop;
+	struct m0_fop        *fop  = &irfop->irf_iofop.if_fop;
+	struct m0_fop_cob_rw *lrw  = io_rw_get(lfop);
+	struct m0_fop_cob_rw *rw   = io_rw_get(fop);
+	struct ioreq_fop     *m;
+
+	if (lfop->f_item.ri_session != fop->f_item.ri_session ||
+	    lfop->f_type != fop->f_type ||
+	    leader->irf_co_nr >= IO_COALESCE_MEMBERS_MAX ||
+	    !m0_fid_eq(&lrw->crw_fid, &rw->crw_fid) ||
+	    !m0_fid_eq(&lrw->crw_pver, &rw->crw_pver) ||
+	    lrw->crw_lid != rw->crw_lid || lrw->crw_index != rw->crw_index ||
+	    lrw->crw_flags != rw->crw_flags ||
+	    leader->irf_co_size + m0_io_fop_size_get(fop) >
+	    m0_rpc_session_get_max_item_payload_size(fop->f_item.ri_session))
+		return false;
+	if (!m0_is_write_fop(fop))
+		return true;
+	if (ivec_overlaps(&lrw->crw_ivec, &rw->crw_ivec))
+		return false;
+	for (m = leader->irf_co_members; m != NULL; m = m->irf_co_next) {
+		if (ivec_overlaps(&io_rw_get(&m->irf_iofop.if_fop)->crw_ivec,
+				  &rw->crw_ivec))
+			return false;
+	}
+	return true;
+}
+
+static void iofop_co_append(struct m0_fop_cob_rw        *dst,
+			    const struct m0_io_descs    *desc,
+			    const struct m0_io_indexvec *ivec)
+{
+	memcpy(dst->crw_desc.id_descs + dst->crw_desc.id_nr, desc->id_descs,
+	       desc->id_nr * sizeof desc->id_descs[0]);
+	memcpy(dst->crw_ivec.ci_iosegs + dst->crw_ivec.ci_nr, ivec->ci_iosegs,
+	       ivec->ci_nr * sizeof ivec->ci_iosegs[0]);
+	dst->crw_desc.id_nr += desc->id_nr;
+	dst->crw_ivec.ci_nr += ivec->ci_nr;
+}
+
+/**
+ * Replaces descriptors and index vector of the leader with the concatenation
+ * of those of the leader and its members.
+ *
+ * The ioservice splits the index vector between descriptors in order, so
+ * the concatenation describes the same io as the separate fops.
+ */
+static int iofop_co_merge(struct ioreq_fop *leader)
+{
+	struct m0_fop_cob_rw        *lrw = io_rw_get(&leader->irf_iofop.if_fop);
+	struct m0_fop_cob_rw        *rw;
+	struct ioreq_fop            *m;
+	struct m0_net_buf_desc_data *descs;
+	struct m0_ioseg             *segs;
+	uint32_t                     descs_nr = lrw->crw_desc.id_nr;
+	uint32_t                     segs_nr = lrw->crw_ivec.ci_nr;
+
+	for (m = leader->irf_co_members; m != NULL; m = m->irf_co_next) {
+		rw = io_rw_get(&m->irf_iofop.if_fop);
+		descs_nr += rw->crw_desc.id_nr;
+		segs_nr  += rw->crw_ivec.ci_nr;
+	}
+	M0_ALLOC_ARR(descs, descs_nr);
+	M0_ALLOC_ARR(segs, segs_nr);
+	if (descs == NULL || segs == NULL) {
+		m0_free(descs);
+		m0_free(segs);
+		return M0_ERR(-ENOMEM);
+	}
+	leader->irf_co_desc = lrw->crw_desc;
+	leader->irf_co_ivec = lrw->crw_ivec;
+	lrw->crw_desc = (struct m0_io_descs) { .id_descs = descs };
+	lrw->crw_ivec = (struct m0_io_indexvec) { .ci_iosegs = segs };
+	iofop_co_append(lrw, &leader->irf_co_desc, &leader->irf_co_ivec);
+	for (m = leader->irf_co_members; m != NULL; m = m->irf_co_next) {
+		rw = io_rw_get(&m->irf_iofop.if_fop);
+		iofop_co_append(lrw, &rw->crw_desc, &rw->crw_ivec);
+	}
+	M0_POST(lrw->crw_desc.id_nr == descs_nr &&
+		lrw->crw_ivec.ci_nr == segs_nr);
+	leader->irf_iofop.if_fop.f_item.ri_size = 0;
+	return 0;
+}
+
+/** Restores own descriptors and index vector of the leader. */
+static void iofop_co_unmerge(struct ioreq_fop *leader)
+{
+	struct m0_fop_cob_rw *lrw = io_rw_get(&leader->irf_iofop.if_fop);
+
+	M0_PRE(leader->irf_co_members != NULL);
+
+	m0_free(lrw->crw_desc.id_descs);
+	m0_free(lrw->crw_ivec.ci_iosegs);
+	lrw->crw_desc = leader->irf_co_desc;
+	lrw->crw_ivec = leader->irf_co_ivec;
+	M0_SET0(&leader->irf_co_desc);
+	M0_SET0(&leader->irf_co_ivec);
+}
+
+/** Sends the leader, falling back to separate fops if merging fails. */
+static void iofop_co_send(struct ioreq_fop *leader)
+{
+	struct ioreq_fop *m;
+	struct ioreq_fop *next;
+
+	if (leader->irf_co_members != NULL && iofop_co_merge(leader) != 0) {
+		for (m = leader->irf_co_members; m != NULL; m = next) {
+			next = m->irf_co_next;
+			m->irf_co_next = NULL;
+			(void)iofop_post(&m->irf_iofop);
+		}
+		leader->irf_co_members = NULL;
+		leader->irf_co_nr = 0;
+	}
+	M0_LOG(M0_DEBUG, "leader %p members %u", leader, leader->irf_co_nr);
+	(void)iofop_post(&leader->irf_iofop);
+}
+
+static void iofop_co_timer_cb(struct m0_sm_timer *timer)
+{
+	struct m0_client *m0c = container_of(timer, struct m0_client,
+					     m0c_co_timer);
+	struct ioreq_fop *leader;
+	struct ioreq_fop *next;
+
+	m0_mutex_lock(&m0c->m0c_co_lock);
+	leader = m0c->m0c_co_pending;
+	m0c->m0c_co_pending = NULL;
+	m0c->m0c_co_armed = false;
+	m0_mutex_unlock(&m0c->m0c_co_lock);
+
+	for (; leader != NULL; leader = next) {
+		next = leader->irf_co_next;
+		leader->irf_co_next = NULL;
+		iofop_co_send(leader);
+	}
+}
+
+static void iofop_co_arm(struct m0_sm_group *grp, struct m0_sm_ast *ast)
+{
+	struct m0_client *m0c = container_of(ast, struct m0_client,
+					     m0c_co_ast);
+	int               rc;
+
+	m0_sm_timer_fini(&m0c->m0c_co_timer);
+	m0_sm_timer_init(&m0c->m0c_co_timer);
+	rc = m0_sm_timer_start(&m0c->m0c_co_timer, grp, &iofop_co_timer_cb,
+			       m0_time_from_now(0,
+				m0c->m0c_config->mc_io_coalesce_window));
+	if (rc != 0)
+		iofop_co_timer_cb(&m0c->m0c_co_timer);
+}
+
+/**
+ * Attaches the fop to a pending leader or makes it a leader. Returns false
+ * if the fop is not eligible for coalescing.
+ */
+static bool iofop_co_add(struct ioreq_fop *irfop)
+{
+	struct m0_client *m0c;
+	struct ioreq_fop *leader;
+
+	if (!iofop_co_is_eligible(irfop))
+		return false;
+
+	m0c = m0__op_instance(&irfop_ioo(irfop)->ioo_oo.oo_oc.oc_op);
+	m0_mutex_lock(&m0c->m0c_co_lock);
+	for (leader = m0c->m0c_co_pending; leader != NULL;
+	     leader = leader->irf_co_next) {
+		if (iofop_co_match(leader, irfop))
+			break;
+	}
+	if (leader != NULL) {
+		irfop->irf_co_next = leader->irf_co_members;
+		leader->irf_co_members = irfop;
+		leader->irf_co_size += m0_io_fop_size_get(
+						&irfop->irf_iofop.if_fop);
+		++leader->irf_co_nr;
+	} else {
+		irfop->irf_co_size = m0_io_fop_size_get(
+						&irfop->irf_iofop.if_fop);
+		irfop->irf_co_next = m0c->m0c_co_pending;
+		m0c->m0c_co_pending = irfop;
+		if (!m0c->m0c_co_armed) {
+			m0c->m0c_co_armed = true;
+			m0c->m0c_co_ast.sa_cb = &iofop_co_arm;
+			m0_sm_ast_post(&m0c->m0c_sm_group, &m0c->m0c_co_ast);
+		}
+	}
+	m0_mutex_unlock(&m0c->m0c_co_lock);
+	return true;
+}
+
+/**
+ * Hands the reply of a sent leader to its members and schedules their
+ * bottom halves. Called from the rpc callback of the leader, so members
+ * complete together with it.
+ */
+static void iofop_co_complete(struct ioreq_fop *leader)
+{
+	struct m0_rpc_item *litem = &leader->irf_iofop.if_fop.f_item;
+	struct m0_rpc_item *item;
+	struct ioreq_fop   *m;
+	struct ioreq_fop   *next;
+
+	iofop_co_unmerge(leader);
+	for (m = leader->irf_co_members; m != NULL; m = next) {
+		next = m->irf_co_next;
+		m->irf_co_next = NULL;
+		m->irf_co_member = true;
+		item = &m->irf_iofop.if_fop.f_item;
+		item->ri_error = litem->ri_error;
+		if (litem->ri_reply != NULL) {
+			/* One reference for the item, one for the bottom half */
+			item->ri_reply = litem->ri_reply;
+			m0_rpc_item_get(item->ri_reply);
+			m0_rpc_item_get(item->ri_reply);
+		}
+		m0_fop_get(&m->irf_iofop.if_fop);
+		m0_sm_ast_post(irfop_ioo(m)->ioo_sm.sm_grp, &m->irf_ast);
+	}
+	leader->irf_co_members = NULL;
+	leader->irf_co_nr = 0;
+}
+
 /**
  * This is heavily based on m0t1fs/linux_kernel/file.c::iofop_async_submit
+ *
+ * If coalescing is enabled (m0_config::mc_io_coalesce_window), a small fop
+ * is not posted immediately: it waits in the client for other fops of the
+ * same cob and is sent as a part of one of them.
  */
+/**
+ * Small reads get their data in the reply fop (M0_IO_FLAG_INLINE) instead of
+ * a zero-copy to the client buffers. The buffers are not registered and added
+ * to the transfer machine then, only their sizes are sent in the descriptors.
+ */
+static bool ioreq_fop_inline_prepare(struct ioreq_fop *irfop)
+{
+	struct m0_op           *op   = &irfop_ioo(irfop)->ioo_oo.oo_oc.oc_op;
+	struct m0_config       *conf = m0__op_instance(op)->m0c_config;
+	struct m0_io_fop       *iofop = &irfop->irf_iofop;
+	struct m0_fop_cob_rw   *rwfop = io_rw_get(&iofop->if_fop);
+	struct m0_rpc_bulk     *rbulk = &iofop->if_rbulk;
+	struct m0_rpc_bulk_buf *rbuf;
+	struct m0_net_buffer   *nb;
+	m0_bcount_t             nob = 0;
+	int                     cnt = 0;
+
+	if (conf->mc_io_inline_read_max == 0 ||
+	    !m0_is_read_fop(&iofop->if_fop))
+		return false;
+
+	m0_mutex_lock(&rbulk->rb_mutex);
+	m0_tl_for(rpcbulk, &rbulk->rb_buflist, rbuf) {
+		nb = rbuf->bb_nbuf;
+		nob += nb->nb_length ?:
+			m0_vec_count(&rbuf->bb_zerovec.z_bvec.ov_vec);
+	} m0_tl_endfor;
+	if (nob > min64u(conf->mc_io_inline_read_max,
+			 M0_IO_INLINE_READ_MAX)) {
+		m0_mutex_unlock(&rbulk->rb_mutex);
+		return false;
+	}
+	m0_tl_for(rpcbulk, &rbulk->rb_buflist, rbuf) {
+		nb = rbuf->bb_nbuf;
+		if (nb->nb_length == 0)
+			nb->nb_length =
+				m0_vec_count(&rbuf->bb_zerovec.z_bvec.ov_vec);
+		rwfop->crw_desc.id_descs[cnt++].bdd_used = nb->nb_length;
+		rbulk->rb_bytes += nb->nb_length;
+	} m0_tl_endfor;
+	m0_mutex_unlock(&rbulk->rb_mutex);
+	rwfop->crw_flags |= M0_IO_FLAG_INLINE;
+	return true;
+}
+
 M0_INTERNAL int ioreq_fop_async_submit(struct m0_io_fop      *iofop,
 				       struct m0_rpc_session *session)
 {
 	int                   rc;
 	struct m0_fop_cob_rw *rwfop;
 	struct m0_rpc_item   *item;
+	struct ioreq_fop     *irfop;
 
 	M0_ENTRY("m0_io_fop %p m0_rpc_session %p", iofop, session);
 
@@ -677,21 +1055,22 @@ M0_INTERNAL int ioreq_fop_async_submit(struct m0_io_fop      *iofop,
 	rwfop = io_rw_get(&iofop->if_fop);
 	M0_ASSERT(rwfop != NULL);
 
-	rc = m0_rpc_bulk_store(&iofop->if_rbulk, session->s_conn,
-			       rwfop->crw_desc.id_descs,
-			       &client__buf_bulk_cb);
-	if (rc != 0)
-		goto out;
+	irfop = bob_of(iofop, struct ioreq_fop, irf_iofop, &iofop_bobtype);
+	if (!ioreq_fop_inline_prepare(irfop)) {
+		rc = m0_rpc_bulk_store(&iofop->if_rbulk, session->s_conn,
+				       rwfop->crw_desc.id_descs,
+				       &client__buf_bulk_cb);
+		if (rc != 0)
+			goto out;
+	}
 
 	item = &iofop->if_fop.f_item;
 	item->ri_session = session;
+	item->ri_rmachine = session->s_conn->c_rpc_machine;
 	item->ri_nr_sent_max = M0_RPC_MAX_RETRIES;
 	item->ri_resend_interval = M0_RPC_RESEND_INTERVAL;
-	rc = m0_rpc_post(item);
-	M0_LOG(M0_INFO, "IO fops submitted to rpc, rc = %d", rc);
-
-	M0_ADDB2_ADD(M0_AVI_CLIENT_BULK_TO_RPC, iofop->if_rbulk.rb_id,
-		     m0_sm_id_get(&item->ri_sm));
+	if (!iofop_co_add(irfop))
+		(void)iofop_post(iofop);
 	/*
 	 * Ignoring error from m0_rpc_post() so that the subsequent fop
 	 * submission goes on. This is to ensure that the ioreq gets into dgmode
@@ -926,7 +1305,8 @@ static void ioreq_fop_release(struct m0_ref *ref)
 		if (m0_is_read_fop(&iofop->if_fop))
 			m0_atomic64_sub(&xfer->nxr_rdbulk_nr,
 				        non_queued_buf_nr);
-		if (item->ri_sm.sm_state == M0_RPC_ITEM_UNINITIALISED)
+		if (item->ri_sm.sm_state == M0_RPC_ITEM_UNINITIALISED &&
+		    !reqfop->irf_co_member)
 			/* rio_replied() is not invoked for this item. */
 			m0_atomic64_dec(&xfer->nxr_iofop_nr);
 		m0_mutex_unlock(&xfer->nxr_lock);
@@ -975,6 +1355,7 @@ M0_INTERNAL int ioreq_fop_init(struct ioreq_fop    *fop,
 	struct m0_fop_type     *fop_type;
 	struct m0_op_io        *ioo;
 	struct m0_fop_cob_rw   *rwfop;
+	struct m0_config       *conf;
 
 	M0_ENTRY("ioreq_fop %p, target_ioreq %p", fop, ti);
 
@@ -993,6 +1374,10 @@ M0_INTERNAL int ioreq_fop_init(struct ioreq_fop    *fop,
 	fop->irf_pattr     = pattr;
 	fop->irf_tioreq    = ti;
 	fop->irf_reply_rc  = 0;
+	fop->irf_co_members = NULL;
+	fop->irf_co_next   = NULL;
+	fop->irf_co_nr     = 0;
+	fop->irf_co_member = false;
 	fop->irf_ast.sa_cb = io_bottom_half;
 	fop->irf_ast.sa_mach = &ioo->ioo_sm;
 
@@ -1011,6 +1396,10 @@ M0_INTERNAL int ioreq_fop_init(struct ioreq_fop    *fop,
 		if (ioo->ioo_oo.oo_oc.oc_op.op_code == M0_OC_READ) {
 			rwfop->crw_flags &= ~M0_IO_FLAG_CROW;
 		}
+		conf = m0__op_instance(&ioo->ioo_oo.oo_oc.oc_op)->m0c_config;
+		if (fop_type == &m0_fop_cob_writev_fopt &&
+		    conf->mc_io_pipelined_write)
+			rwfop->crw_flags |= M0_IO_FLAG_PIPELINE;
 
 		/*
 		 * Changes ri_ops of rpc item so as to execute client's own
@@ -137,6 +137,15 @@ struct m0_composite_extent {
 	uint64_t          ce_tlink_magic;
 };
 
+/**
+ * Extents of a layer list in offset order, to find the extent covering an
+ * offset by a binary search instead of a walk of the list.
+ */
+struct m0_composite_ext_idx {
+	struct m0_composite_extent **cei_exts;
+	uint64_t                     cei_nr;
+};
+
 struct m0_composite_layer {
 	struct m0_uint128 ccr_subobj;
 	uint64_t          ccr_lid;
@@ -144,6 +153,12 @@ struct m0_composite_layer {
 	int               ccr_priority;
 	struct m0_tl      ccr_rd_exts;
 	struct m0_tl      ccr_wr_exts;
+	/**
+	 * Lookup indices of the extent lists, built when the lists are
+	 * scanned. Empty for lists filled by other means.
+	 */
+	struct m0_composite_ext_idx ccr_rd_idx;
+	struct m0_composite_ext_idx ccr_wr_idx;
 
 	struct m0_mutex   ccr_lock;
 	struct m0_tlink   ccr_tlink;
@@ -53,6 +53,7 @@
 #include "motr/m0crate/parser.h"
 #include "motr/m0crate/crate_client.h"
 #include "motr/m0crate/crate_utils.h"
+#include "motr/m0crate/crate_dist.h"
 
 extern struct crate_conf *conf;
 
@@ -69,6 +70,11 @@ const bcnt_t cr_default_csum_size  = 16;
 const bcnt_t cr_default_key_size   = sizeof(struct m0_fid);
 const bcnt_t cr_default_max_ksize  = 1 << 10; /* default upper limit for key_size parameter. i.e 1KB */
 const bcnt_t cr_default_max_vsize  = 1 << 20; /* default upper limit for value_size parameter. i.e 1MB */
+const int    cr_default_mix_nr_objs  = 16;
+const bcnt_t cr_default_mix_size     = 1024 * 1024;
+const bcnt_t cr_default_mix_obj_size = 64 * 1024 * 1024;
+const int    cr_default_mix_nr_keys  = 1000;
+const int    cr_default_mix_vsize    = 256;
 static struct m0_be_seg *seg;
 static struct m0_btree *tree;
 uint8_t *rnode; /* Root Node */
@@ -86,6 +92,8 @@ const char *cr_workload_name[CWT_NR] = {
 	[CWT_IO]    = "io",
 	[CWT_INDEX] = "index",
 	[CWT_BTREE] = "btree",
+	[CWT_MIX]   = "mix",
+	[CWT_REPLAY] = "replay",
 };
 
 static int hpcs_init  (struct workload *w);
@@ -173,6 +181,26 @@ static const struct workload_type_ops w_ops[CWT_NR] = {
 		.wto_parse  = btree_parse,
 		.wto_check  = btree_check
         },
+
+	[CWT_MIX] = {
+                .wto_init   = init,
+                .wto_fini   = fini,
+                .wto_run    = run_mix,
+                .wto_op_get = NULL,
+                .wto_op_run = m0_op_run_mix,
+		.wto_parse  = NULL,
+		.wto_check  = check
+        },
+
+	[CWT_REPLAY] = {
+                .wto_init   = init,
+                .wto_fini   = fini,
+                .wto_run    = run_replay,
+                .wto_op_get = NULL,
+                .wto_op_run = m0_op_run_replay,
+		.wto_parse  = NULL,
+		.wto_check  = check
+        },
 };
 
 static void fletcher_2_native(void *buf, uint64_t size);
@@ -274,6 +302,19 @@ int workload_init(struct workload *w, enum cr_workload_type wtype)
 		wit->value_size		      = -1;
 		wit->max_key_size	      = cr_default_max_ksize;
 		wit->max_value_size	      = cr_default_max_vsize;
+	} else if (wtype == CWT_MIX) {
+		struct m0_workload_mix *cwm = w->u.cw_mix;
+		cwm->cwm_nr_objs    = cr_default_mix_nr_objs;
+		cwm->cwm_size_dist  = CSD_FIXED;
+		cwm->cwm_size_min   = cr_default_mix_size;
+		cwm->cwm_size_max   = cr_default_mix_size;
+		cwm->cwm_obj_size   = cr_default_mix_obj_size;
+		cwm->cwm_nr_keys    = cr_default_mix_nr_keys;
+		cwm->cwm_value_size = cr_default_mix_vsize;
+	} else if (wtype == CWT_REPLAY) {
+		struct m0_workload_replay *cwr = w->u.cw_replay;
+		/* Replay at the original speed. */
+		cwr->cwr_speed = 100;
 	}
 
 	return wop(w)->wto_init(w);
@@ -367,7 +408,7 @@ static void *worker_thread(void *datum)
 	 * Motr can launch multiple operations in a single go.
 	 * Single operation in a loop won't work for Motr.
 	 */
-	if (w->cw_type == CWT_IO || w->cw_type == CWT_INDEX)
+	if (M0_IN(w->cw_type, (CWT_IO, CWT_INDEX, CWT_MIX, CWT_REPLAY)))
 		wop(w)->wto_op_run(w, wt, NULL);
 	else {
 		while (workload_op_get(w, &op) == 0)
@@ -433,8 +474,8 @@ static void workload_run(struct workload *w)
         cr_log(CLL_INFO, "random seed:           %u\n", w->cw_rstate);
         cr_log(CLL_INFO, "number of threads:     %u\n", w->cw_nr_thread);
 	/* Following params not applicable to IO and INDEX tests */
-	if (CWT_IO != w->cw_type && CWT_INDEX != w->cw_type &&
-	    CWT_BTREE != w->cw_type) {
+	if (!M0_IN(w->cw_type, (CWT_IO, CWT_INDEX, CWT_BTREE, CWT_MIX,
+				CWT_REPLAY))) {
 		cr_log(CLL_INFO, "average size:          %llu\n", w->cw_avg);
 		cr_log(CLL_INFO, "maximal size:          %llu\n", w->cw_max);
 		/*
@@ -1561,7 +1602,11 @@ static void usage(void)
 "Options with [defaults]: \n"
 "      Generic options\n"
 "-v                    increase verbosity level. Can be given multiple times.\n"
-"-h                    print this help message.\n\n"
+"-h                    print this help message.\n"
+"-L PORT:NR_AGENTS     coordinate NR_AGENTS agents: send them the workloads\n"
+"                      of the -S file (given after -L), start them together\n"
+"                      and print cluster-wide statistics.\n"
+"-J HOST:PORT          run as an agent of the coordinator at HOST:PORT.\n\n"
 "      Options common for all workload types\n"
 "-s SEED               set pseudo-random number generator seed to \n"
 "                      a given value. See srand(3).\n"
@@ -1692,10 +1737,11 @@ int main(int argc, char **argv)
 	struct m0_workload_io *cwi;
 	static struct m0       instance;
 	uint64_t               nr_segments;
+	char                   config[64];
 	int                    rc;
 
         static const char opts[] =
-		"k:s:o:f:t:W:a:r:R:ez:D:UM:BA:S:Hw:iF:d:C:c:pqb:Thvl";
+		"k:s:o:f:t:W:a:r:R:ez:D:UM:BA:S:Hw:iF:d:C:c:pqb:ThvlL:J:";
 
 	if (argc == 1) {
 		usage();
@@ -1747,7 +1793,25 @@ int main(int argc, char **argv)
 			if (rc != 0)
 				errx(1, "failed to init the workload: %d", rc);
                         continue;
+		case 'L':
+			if (cr_dist_listen_set(optarg) != 0)
+				errx(1, "invalid coordinator address (%s)",
+				     optarg);
+			continue;
+		case 'J':
+			/* The yaml file is received from the coordinator. */
+			rc = cr_dist_join(optarg, config, sizeof config);
+			if (rc != 0)
+				errx(1, "unable to join the coordinator (%s): "
+				     "%d", optarg, rc);
+			optarg = config;
+			/* fall through */
 		case 'S':
+			if (cr_dist_is_coordinator()) {
+				rc = cr_dist_coordinate(optarg);
+				m0_free(load);
+				return rc == 0 ? 0 : 1;
+			}
 			/* All workloads are specified in a yaml file. */
 			M0_ASSERT(idx == -1);
 			rc = parse_yaml_file(load, CR_WORKLOAD_MAX, &idx,
@@ -1849,12 +1913,16 @@ int main(int argc, char **argv)
         for (i = 0; i <= idx; ++i) {
                 w = &load[i];
 		wop(w)->wto_check(w);
+		rc = cr_dist_barrier();
+		if (rc != 0)
+			errx(1, "coordinator failure: %d", rc);
                 cr_log(CLL_INFO, "starting workload %i\n", i);
                 workload_run(w);
                 workload_fini(w);
                 cr_log(CLL_INFO, "done workload %i\n", i);
                 cr_log(CLL_INFO, "---------------------------------------\n");
         }
+	cr_dist_leave();
 	m0_free(load);
         return 0;
 }
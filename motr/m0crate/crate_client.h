@@ -63,7 +63,9 @@ struct crate_conf {
 enum m0_operation_type {
 	OT_INDEX,
 	OT_IO,
-	OT_BTREE
+	OT_BTREE,
+	OT_MIX,
+	OT_REPLAY
 };
 
 enum cr_opcode {
@@ -117,6 +119,9 @@ struct m0_workload_index {
 	struct m0_fid		index_fid;
 
 	uint64_t		seed;
+
+	/** Latency statistics of CRATE_OP_NR operation types. */
+	struct cr_lat	       *lat;
 };
 
 struct m0_workload_task {
@@ -186,6 +191,8 @@ struct m0_workload_io {
 	m0_time_t         cwi_execution_time;
 	m0_time_t         cwi_time[CR_OPS_NR];
 	char             *cwi_filename;
+	/** Latency statistics of CR_OPS_NR operation types. */
+	struct cr_lat    *cwi_lat;
 };
 
 struct cti_global {
@@ -212,6 +219,67 @@ struct m0_task_io {
 	struct cti_global          cti_g;
 	/** Limit op_launch to max_nr_ops */
 	struct m0_semaphore        cti_max_ops_sem;
+	/** Start times of operations in open-loop arrival models. */
+	struct cr_pace             cti_pace;
+};
+
+/** Operations of the mixed and trace-replay workloads. */
+enum cr_mix_op {
+	CMO_CREATE,
+	CMO_WRITE,
+	CMO_READ,
+	CMO_DELETE,
+	CMO_PUT,
+	CMO_GET,
+	CMO_NEXT,
+	CMO_DEL,
+	CMO_NR
+};
+
+/** Distribution of object i/o sizes. */
+enum cr_size_dist {
+	/** Always the minimal size. */
+	CSD_FIXED,
+	/** Uniform between the minimal and maximal sizes. */
+	CSD_UNIFORM,
+	/** Log-uniform between the minimal and maximal sizes. */
+	CSD_LOG
+};
+
+struct m0_workload_mix {
+	/** Relative weights of the operations in the mix. */
+	int                cwm_weight[CMO_NR];
+	/** Objects of each thread. */
+	int                cwm_nr_objs;
+	enum cr_size_dist  cwm_size_dist;
+	uint64_t           cwm_size_min;
+	uint64_t           cwm_size_max;
+	/** I/O is done within [0, cwm_obj_size) of an object. */
+	uint64_t           cwm_obj_size;
+	/** Index used by PUT, GET, NEXT and DEL. */
+	struct m0_fid      cwm_index_fid;
+	/** Keys of each thread. */
+	int                cwm_nr_keys;
+	int                cwm_value_size;
+	/** Latency statistics of CMO_NR operation types. */
+	struct cr_lat     *cwm_lat;
+};
+
+struct cr_replay_rec;
+struct cr_replay_ent;
+
+struct m0_workload_replay {
+	/** Trace file. */
+	char                 *cwr_file;
+	/** Replay speed, in percents of the original one. */
+	int                   cwr_speed;
+	struct cr_replay_rec *cwr_recs;
+	int                   cwr_nr_recs;
+	/** Entities referred by the trace, sorted by identifier. */
+	struct cr_replay_ent *cwr_ents;
+	int                   cwr_nr_ents;
+	/** Latency statistics of CMO_NR operation types. */
+	struct cr_lat        *cwr_lat;
 };
 
 int parse_crate(int argc, char **argv, struct workload *w);
@@ -221,6 +289,15 @@ void m0_op_run(struct workload *w, struct workload_task *task,
 void run_index(struct workload *w, struct workload_task *tasks);
 void m0_op_run_index(struct workload *w, struct workload_task *task,
 			 const struct workload_op *op);
+void cr_idx_init(struct m0_idx *idx, struct m0_uint128 *id);
+void set_idx_flags(struct m0_op *op);
+int create_index(struct m0_uint128 id);
+void run_mix(struct workload *w, struct workload_task *tasks);
+void m0_op_run_mix(struct workload *w, struct workload_task *task,
+		   const struct workload_op *op);
+void run_replay(struct workload *w, struct workload_task *tasks);
+void m0_op_run_replay(struct workload *w, struct workload_task *task,
+		      const struct workload_op *op);
 
 
 /** @} end of crate group */
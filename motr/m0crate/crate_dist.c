@@ -0,0 +1,625 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+/**
+ * @addtogroup crate_dist
+ *
+ * Messages are a header followed by a payload; all integers are sent in big
+ * endian. A histogram is sent as its label, its parameters and the non-empty
+ * buckets as (index, count) pairs.
+ *
+ * @{
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <endian.h>             /* htobe64 */
+#include <pthread.h>
+#include <sys/socket.h>
+
+#include "lib/arith.h"          /* min64u */
+#include "lib/memory.h"
+#include "motr/m0crate/logger.h"
+#include "motr/m0crate/crate_utils.h"
+#include "motr/m0crate/crate_dist.h"
+
+enum {
+	CR_DIST_MAGIC     = 0x6d306372,          /* "m0cr" */
+	CR_DIST_LABEL_LEN = 32,
+	/** Period statistics kept by the coordinator until complete. */
+	CR_DIST_ROWS_MAX  = 256,
+	/** Header of a histogram: kind, time, period, nr, max and pairs. */
+	CR_DIST_HIST_HDR  = 6,
+	CR_DIST_HIST_MAX  = CR_DIST_LABEL_LEN +
+		(CR_DIST_HIST_HDR + 2 * CR_HIST_NR) * sizeof(uint64_t),
+	CR_DIST_CONFIG_MAX = 1 << 20
+};
+
+enum cr_dist_msg_type {
+	/** Coordinator to agent: the configuration file. */
+	CDM_CONFIG,
+	/** Agent to coordinator: ready to start the next workload. */
+	CDM_READY,
+	/** Coordinator to agent: start the workload. */
+	CDM_START,
+	/** Agent to coordinator: a histogram. */
+	CDM_HIST,
+	/** Agent to coordinator: all workloads are done. */
+	CDM_DONE
+};
+
+struct cr_dist_hdr {
+	uint32_t cdh_magic;
+	uint32_t cdh_type;
+	uint64_t cdh_len;
+};
+
+/** Socket connected to the coordinator in the agent mode, or -1. */
+static int             cr_dist_fd = -1;
+/** Serialises messages sent by workload threads of the agent. */
+static pthread_mutex_t cr_dist_lock = PTHREAD_MUTEX_INITIALIZER;
+static char            cr_dist_config[64];
+static char            cr_dist_port[16];
+static int             cr_dist_nr_agents;
+
+static int cr_dist_write(int fd, const void *buf, size_t len)
+{
+	ssize_t nr;
+
+	while (len > 0) {
+		nr = send(fd, buf, len, MSG_NOSIGNAL);
+		if (nr < 0 && errno == EINTR)
+			continue;
+		if (nr <= 0)
+			return nr < 0 ? -errno : -EPIPE;
+		buf += nr;
+		len -= nr;
+	}
+	return 0;
+}
+
+static int cr_dist_read(int fd, void *buf, size_t len)
+{
+	ssize_t nr;
+
+	while (len > 0) {
+		nr = recv(fd, buf, len, 0);
+		if (nr < 0 && errno == EINTR)
+			continue;
+		if (nr <= 0)
+			return nr < 0 ? -errno : -EPIPE;
+		buf += nr;
+		len -= nr;
+	}
+	return 0;
+}
+
+static int cr_dist_send(int fd, enum cr_dist_msg_type type,
+			const void *payload, uint64_t len)
+{
+	struct cr_dist_hdr hdr = {
+		.cdh_magic = htobe32(CR_DIST_MAGIC),
+		.cdh_type  = htobe32(type),
+		.cdh_len   = htobe64(len)
+	};
+
+	return cr_dist_write(fd, &hdr, sizeof hdr) ?:
+		cr_dist_write(fd, payload, len);
+}
+
+/**
+ * Receives a message. The payload is returned in @payload, which has to be
+ * freed by the caller.
+ */
+static int cr_dist_recv(int fd, enum cr_dist_msg_type *type,
+			void **payload, uint64_t *len)
+{
+	struct cr_dist_hdr hdr;
+	int                rc;
+
+	*payload = NULL;
+	rc = cr_dist_read(fd, &hdr, sizeof hdr);
+	if (rc != 0)
+		return rc;
+	*type = be32toh(hdr.cdh_type);
+	*len = be64toh(hdr.cdh_len);
+	if (be32toh(hdr.cdh_magic) != CR_DIST_MAGIC ||
+	    *len > max64u(CR_DIST_HIST_MAX, CR_DIST_CONFIG_MAX))
+		return -EPROTO;
+	if (*len == 0)
+		return 0;
+	*payload = m0_alloc(*len + 1);
+	if (*payload == NULL)
+		return -ENOMEM;
+	rc = cr_dist_read(fd, *payload, *len);
+	if (rc != 0)
+		m0_free0(payload);
+	return rc;
+}
+
+/** Splits "NAME:PORT" into its parts, @name is modified. */
+static int cr_dist_addr_parse(char *name, char **port)
+{
+	*port = strrchr(name, ':');
+	if (*port == NULL || *port == name || (*port)[1] == 0)
+		return -EINVAL;
+	*(*port)++ = 0;
+	return 0;
+}
+
+/*
+ * Agent.
+ */
+
+int cr_dist_join(const char *addr, char *path, size_t len)
+{
+	struct addrinfo        hints = {
+		.ai_family   = AF_UNSPEC,
+		.ai_socktype = SOCK_STREAM
+	};
+	struct addrinfo       *res;
+	struct addrinfo       *ai;
+	enum cr_dist_msg_type  type;
+	void                  *config = NULL;
+	uint64_t               size = 0;
+	char                  *host;
+	char                  *port;
+	int                    sock = -1;
+	int                    fd;
+	int                    rc;
+
+	host = strdup(addr);
+	if (host == NULL)
+		return -ENOMEM;
+	rc = cr_dist_addr_parse(host, &port);
+	if (rc == 0 && getaddrinfo(host, port, &hints, &res) != 0)
+		rc = -EHOSTUNREACH;
+	free(host);
+	if (rc != 0)
+		return rc;
+	for (ai = res; ai != NULL && sock < 0; ai = ai->ai_next) {
+		sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if (sock >= 0 &&
+		    connect(sock, ai->ai_addr, ai->ai_addrlen) != 0) {
+			close(sock);
+			sock = -1;
+		}
+	}
+	freeaddrinfo(res);
+	if (sock < 0)
+		return -ECONNREFUSED;
+
+	rc = cr_dist_recv(sock, &type, &config, &size);
+	if (rc == 0 && type != CDM_CONFIG)
+		rc = -EPROTO;
+	if (rc == 0) {
+		snprintf(cr_dist_config, sizeof cr_dist_config,
+			 "/tmp/m0crate.XXXXXX");
+		fd = mkstemp(cr_dist_config);
+		if (fd < 0)
+			rc = -errno;
+		else {
+			if (write(fd, config, size) != size)
+				rc = -EIO;
+			close(fd);
+		}
+	}
+	m0_free(config);
+	if (rc != 0) {
+		close(sock);
+		return rc;
+	}
+	snprintf(path, len, "%s", cr_dist_config);
+	cr_dist_fd = sock;
+	cr_log(CLL_INFO, "Joined the coordinator %s.\n", addr);
+	return 0;
+}
+
+bool cr_dist_is_agent(void)
+{
+	return cr_dist_fd >= 0;
+}
+
+int cr_dist_barrier(void)
+{
+	enum cr_dist_msg_type type;
+	void                 *payload;
+	uint64_t              len;
+	int                   rc;
+
+	if (!cr_dist_is_agent())
+		return 0;
+	pthread_mutex_lock(&cr_dist_lock);
+	rc = cr_dist_send(cr_dist_fd, CDM_READY, NULL, 0);
+	pthread_mutex_unlock(&cr_dist_lock);
+	if (rc == 0)
+		rc = cr_dist_recv(cr_dist_fd, &type, &payload, &len);
+	if (rc == 0) {
+		m0_free(payload);
+		if (type != CDM_START)
+			rc = -EPROTO;
+	}
+	return rc;
+}
+
+void cr_dist_hist_send(const char *label, bool total, m0_time_t t,
+		       m0_time_t period, const struct cr_hist *h)
+{
+	static char buf[CR_DIST_HIST_MAX];
+	uint64_t   *v = (uint64_t *)(buf + CR_DIST_LABEL_LEN);
+	int         nr = 0;
+	int         i;
+	int         rc;
+
+	if (!cr_dist_is_agent())
+		return;
+	pthread_mutex_lock(&cr_dist_lock);
+	memset(buf, 0, CR_DIST_LABEL_LEN);
+	strncpy(buf, label, CR_DIST_LABEL_LEN - 1);
+	v[0] = htobe64(total);
+	v[1] = htobe64(t);
+	v[2] = htobe64(period);
+	v[3] = htobe64(h->ch_nr);
+	v[4] = htobe64(h->ch_max);
+	for (i = 0; i < CR_HIST_NR; i++) {
+		if (h->ch_bucket[i] != 0) {
+			v[CR_DIST_HIST_HDR + 2 * nr]     = htobe64(i);
+			v[CR_DIST_HIST_HDR + 2 * nr + 1] =
+				htobe64(h->ch_bucket[i]);
+			nr++;
+		}
+	}
+	v[5] = htobe64(nr);
+	rc = cr_dist_send(cr_dist_fd, CDM_HIST, buf, CR_DIST_LABEL_LEN +
+			  (CR_DIST_HIST_HDR + 2 * nr) * sizeof(uint64_t));
+	pthread_mutex_unlock(&cr_dist_lock);
+	if (rc != 0)
+		cr_log(CLL_ERROR, "Unable to send statistics: %d\n", rc);
+}
+
+void cr_dist_leave(void)
+{
+	if (!cr_dist_is_agent())
+		return;
+	(void)cr_dist_send(cr_dist_fd, CDM_DONE, NULL, 0);
+	close(cr_dist_fd);
+	cr_dist_fd = -1;
+	unlink(cr_dist_config);
+}
+
+/*
+ * Coordinator.
+ */
+
+/** Statistics of an operation type merged over the agents. */
+struct cr_dist_row {
+	char           cdr_label[CR_DIST_LABEL_LEN];
+	bool           cdr_total;
+	m0_time_t      cdr_t;
+	m0_time_t      cdr_period;
+	/** Agents which have reported. */
+	int            cdr_nr;
+	struct cr_hist cdr_hist;
+};
+
+struct cr_dist_coord {
+	int                 cdc_nr_agents;
+	struct pollfd      *cdc_fds;
+	int                 cdc_nr_ready;
+	int                 cdc_nr_done;
+	/** Start of the current workload. */
+	m0_time_t           cdc_start;
+	struct cr_dist_row *cdc_rows;
+	int                 cdc_nr_rows;
+};
+
+int cr_dist_listen_set(const char *addr)
+{
+	char *nr;
+
+	if (strlen(addr) >= sizeof cr_dist_port)
+		return -EINVAL;
+	strcpy(cr_dist_port, addr);
+	nr = strchr(cr_dist_port, ':');
+	if (nr == NULL)
+		return -EINVAL;
+	*nr++ = 0;
+	cr_dist_nr_agents = atoi(nr);
+	return cr_dist_nr_agents > 0 ? 0 : -EINVAL;
+}
+
+bool cr_dist_is_coordinator(void)
+{
+	return cr_dist_nr_agents > 0;
+}
+
+static void cr_dist_row_print(const struct cr_dist_row *r, m0_time_t now,
+			      m0_time_t start)
+{
+	const struct cr_hist *h = &r->cdr_hist;
+	m0_time_t             len = r->cdr_total ? m0_time_sub(now, start) :
+						 r->cdr_period;
+	char                  ts[32] = "latency: ";
+
+	if (!r->cdr_total)
+		snprintf(ts, sizeof ts, "ts: %.3f, ",
+			 (double)r->cdr_t / M0_TIME_ONE_SECOND);
+	printf("cluster %s%s, ops_s, %.1f, ops, %"PRIu64", p50_ns, %"PRIu64
+	       ", p99_ns, %"PRIu64", p99.9_ns, %"PRIu64", max_ns, %"PRIu64"\n",
+	       ts, r->cdr_label,
+	       len == 0 ? 0.0 : (double)h->ch_nr * M0_TIME_ONE_SECOND / len,
+	       h->ch_nr, cr_hist_quantile(h, 0.5), cr_hist_quantile(h, 0.99),
+	       cr_hist_quantile(h, 0.999), h->ch_max);
+	fflush(stdout);
+}
+
+static int cr_dist_row_cmp(const void *a, const void *b)
+{
+	const struct cr_dist_row *r0 = a;
+	const struct cr_dist_row *r1 = b;
+
+	return M0_3WAY(r0->cdr_total, r1->cdr_total) ?:
+		M0_3WAY(r0->cdr_t, r1->cdr_t) ?:
+		strcmp(r0->cdr_label, r1->cdr_label);
+}
+
+/** Prints all statistics of the finished workload. */
+static void cr_dist_rows_flush(struct cr_dist_coord *c)
+{
+	m0_time_t now = m0_time_now();
+	int       i;
+
+	qsort(c->cdc_rows, c->cdc_nr_rows, sizeof c->cdc_rows[0],
+	      cr_dist_row_cmp);
+	for (i = 0; i < c->cdc_nr_rows; i++)
+		cr_dist_row_print(&c->cdc_rows[i], now, c->cdc_start);
+	c->cdc_nr_rows = 0;
+}
+
+static int cr_dist_hist_merge(struct cr_dist_coord *c, const char *buf,
+			      uint64_t len)
+{
+	const uint64_t     *v = (const uint64_t *)(buf + CR_DIST_LABEL_LEN);
+	struct cr_dist_row *r;
+	struct cr_hist     *h;
+	char                label[CR_DIST_LABEL_LEN];
+	bool                total;
+	m0_time_t           t;
+	uint64_t            idx;
+	uint64_t            nr;
+	int                 i;
+
+	if (len < CR_DIST_LABEL_LEN + CR_DIST_HIST_HDR * sizeof(uint64_t))
+		return -EPROTO;
+	nr = be64toh(v[5]);
+	if (len != CR_DIST_LABEL_LEN +
+	    (CR_DIST_HIST_HDR + 2 * nr) * sizeof(uint64_t))
+		return -EPROTO;
+	memcpy(label, buf, sizeof label);
+	label[sizeof label - 1] = 0;
+	total = be64toh(v[0]);
+	t = be64toh(v[1]);
+
+	for (i = 0; i < c->cdc_nr_rows; i++) {
+		r = &c->cdc_rows[i];
+		if (r->cdr_total == total && r->cdr_t == t &&
+		    strcmp(r->cdr_label, label) == 0)
+			break;
+	}
+	if (i == c->cdc_nr_rows) {
+		/* Periods in which some agents were idle are flushed. */
+		if (c->cdc_nr_rows == CR_DIST_ROWS_MAX)
+			cr_dist_rows_flush(c);
+		r = &c->cdc_rows[c->cdc_nr_rows++];
+		M0_SET0(r);
+		strcpy(r->cdr_label, label);
+		r->cdr_total = total;
+		r->cdr_t = t;
+		r->cdr_period = be64toh(v[2]);
+	}
+	h = &r->cdr_hist;
+	h->ch_nr += be64toh(v[3]);
+	h->ch_max = max64u(h->ch_max, be64toh(v[4]));
+	for (i = 0; i < nr; i++) {
+		idx = be64toh(v[CR_DIST_HIST_HDR + 2 * i]);
+		if (idx >= CR_HIST_NR)
+			return -EPROTO;
+		h->ch_bucket[idx] += be64toh(v[CR_DIST_HIST_HDR + 2 * i + 1]);
+	}
+	/* A period reported by all agents is complete. */
+	if (++r->cdr_nr == c->cdc_nr_agents && !total) {
+		cr_dist_row_print(r, m0_time_now(), c->cdc_start);
+		*r = c->cdc_rows[--c->cdc_nr_rows];
+	}
+	return 0;
+}
+
+static int cr_dist_handle(struct cr_dist_coord *c, int fd)
+{
+	enum cr_dist_msg_type type;
+	void                 *payload;
+	uint64_t              len;
+	int                   rc;
+	int                   i;
+
+	rc = cr_dist_recv(fd, &type, &payload, &len);
+	if (rc != 0)
+		return rc;
+	switch (type) {
+	case CDM_READY:
+		if (++c->cdc_nr_ready < c->cdc_nr_agents)
+			break;
+		cr_dist_rows_flush(c);
+		c->cdc_nr_ready = 0;
+		c->cdc_start = m0_time_now();
+		cr_log(CLL_INFO, "Starting the workload on %d agents.\n",
+		       c->cdc_nr_agents);
+		for (i = 0; i < c->cdc_nr_agents && rc == 0; i++)
+			rc = cr_dist_send(c->cdc_fds[i].fd, CDM_START, NULL, 0);
+		break;
+	case CDM_HIST:
+		rc = cr_dist_hist_merge(c, payload, len);
+		break;
+	case CDM_DONE:
+		if (++c->cdc_nr_done == c->cdc_nr_agents)
+			cr_dist_rows_flush(c);
+		rc = +1;
+		break;
+	default:
+		rc = -EPROTO;
+	}
+	m0_free(payload);
+	return rc;
+}
+
+static int cr_dist_listen(void)
+{
+	struct addrinfo  hints = {
+		.ai_family   = AF_UNSPEC,
+		.ai_socktype = SOCK_STREAM,
+		.ai_flags    = AI_PASSIVE
+	};
+	struct addrinfo *res;
+	int              one = 1;
+	int              fd;
+
+	if (getaddrinfo(NULL, cr_dist_port, &hints, &res) != 0)
+		return -EINVAL;
+	fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+	if (fd >= 0 &&
+	    (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one) != 0 ||
+	     bind(fd, res->ai_addr, res->ai_addrlen) != 0 ||
+	     listen(fd, cr_dist_nr_agents) != 0)) {
+		close(fd);
+		fd = -1;
+	}
+	freeaddrinfo(res);
+	return fd >= 0 ? fd : -errno;
+}
+
+static int cr_dist_config_read(const char *path, char **config, size_t *len)
+{
+	FILE *f;
+
+	f = fopen(path, "r");
+	if (f == NULL)
+		return -errno;
+	*config = m0_alloc(CR_DIST_CONFIG_MAX);
+	if (*config == NULL) {
+		fclose(f);
+		return -ENOMEM;
+	}
+	*len = fread(*config, 1, CR_DIST_CONFIG_MAX, f);
+	fclose(f);
+	return *len < CR_DIST_CONFIG_MAX ? 0 : -EFBIG;
+}
+
+int cr_dist_coordinate(const char *path)
+{
+	struct cr_dist_coord c = { .cdc_nr_agents = cr_dist_nr_agents };
+	char                *config = NULL;
+	size_t               len;
+	int                  lfd = -1;
+	int                  nr = 0;
+	int                  rc;
+	int                  i;
+
+	M0_ALLOC_ARR(c.cdc_fds, c.cdc_nr_agents);
+	M0_ALLOC_ARR(c.cdc_rows, CR_DIST_ROWS_MAX);
+	rc = c.cdc_fds == NULL || c.cdc_rows == NULL ? -ENOMEM :
+		cr_dist_config_read(path, &config, &len);
+	if (rc != 0)
+		goto out;
+	lfd = cr_dist_listen();
+	if (lfd < 0) {
+		rc = lfd;
+		goto out;
+	}
+	cr_log(CLL_INFO, "Waiting for %d agents on port %s.\n",
+	       c.cdc_nr_agents, cr_dist_port);
+	for (nr = 0; nr < c.cdc_nr_agents; nr++) {
+		c.cdc_fds[nr].fd = accept(lfd, NULL, NULL);
+		if (c.cdc_fds[nr].fd < 0) {
+			rc = -errno;
+			goto out;
+		}
+		c.cdc_fds[nr].events = POLLIN;
+		rc = cr_dist_send(c.cdc_fds[nr].fd, CDM_CONFIG, config, len);
+		if (rc != 0) {
+			nr++;
+			goto out;
+		}
+	}
+
+	while (c.cdc_nr_done < c.cdc_nr_agents) {
+		if (poll(c.cdc_fds, nr, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			rc = -errno;
+			break;
+		}
+		for (i = 0; i < nr && rc == 0; i++) {
+			if (c.cdc_fds[i].revents == 0)
+				continue;
+			rc = cr_dist_handle(&c, c.cdc_fds[i].fd);
+			if (rc > 0) {
+				/* The agent is done, stop polling it. */
+				c.cdc_fds[i].fd = -c.cdc_fds[i].fd - 1;
+				rc = 0;
+			} else if (rc < 0)
+				cr_log(CLL_ERROR, "Agent %d failed: %d\n",
+				       i, rc);
+		}
+		if (rc != 0)
+			break;
+	}
+out:
+	for (i = 0; i < nr; i++)
+		close(c.cdc_fds[i].fd < 0 ? -c.cdc_fds[i].fd - 1 :
+		      c.cdc_fds[i].fd);
+	if (lfd >= 0)
+		close(lfd);
+	m0_free(config);
+	m0_free(c.cdc_rows);
+	m0_free(c.cdc_fds);
+	return rc;
+}
+
+/** @} end of crate_dist group */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
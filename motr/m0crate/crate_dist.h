@@ -0,0 +1,95 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __MOTR_M0CRATE_CRATE_DIST_H__
+#define __MOTR_M0CRATE_CRATE_DIST_H__
+
+#include <stdbool.h>
+
+#include "lib/time.h"
+
+/**
+ * @defgroup crate_dist Coordinated runs of m0crate on many nodes.
+ *
+ * A coordinator (-L PORT:NR_AGENTS -S CONFIG) waits for NR_AGENTS agents
+ * (-J HOST:PORT) to connect and sends them the workload configuration. Every
+ * workload is started by all agents at once: an agent reports that it is
+ * ready and waits until the coordinator has heard from all of them.
+ *
+ * Agents forward the latency histograms they print (see ::cr_lat) to the
+ * coordinator, which merges them into cluster-wide lines:
+ * ```
+ *	cluster ts: T, LABEL, ops_s, R, ops, N, p50_ns, ...
+ *	cluster latency: LABEL, ops_s, R, ops, N, p50_ns, ...
+ * ```
+ * A period line is printed once all agents have reported the period, or at
+ * the end of the workload for periods in which some agents were idle. The
+ * throughput of the totals is computed over the duration of the workload
+ * measured by the coordinator.
+ *
+ * The coordinator does not connect to Motr and runs no workloads itself.
+ *
+ * @{
+ */
+
+struct cr_hist;
+
+/** Sets up the coordinator mode, @addr is "PORT:NR_AGENTS". */
+int cr_dist_listen_set(const char *addr);
+bool cr_dist_is_coordinator(void);
+/**
+ * Runs the coordinator: distributes the configuration file to the agents,
+ * synchronises the starts of workloads and prints the aggregated statistics.
+ */
+int cr_dist_coordinate(const char *config);
+
+/**
+ * Connects to the coordinator at @addr ("HOST:PORT") and receives the
+ * configuration into a temporary file, the path of which is returned in
+ * @path.
+ */
+int cr_dist_join(const char *addr, char *path, size_t len);
+bool cr_dist_is_agent(void);
+/** Waits until all agents are ready to start the next workload. */
+int cr_dist_barrier(void);
+/** Sends a histogram printed by the agent to the coordinator. */
+void cr_dist_hist_send(const char *label, bool total, m0_time_t t,
+		       m0_time_t period, const struct cr_hist *h);
+/** Tells the coordinator that all workloads are done and disconnects. */
+void cr_dist_leave(void);
+
+/** @} end of crate_dist group */
+#endif /* __MOTR_M0CRATE_CRATE_DIST_H__ */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
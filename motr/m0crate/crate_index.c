@@ -240,7 +240,7 @@ struct cr_time_measure_ctx {
 };
 
 /* CLIENT INDEX RESULT MEASUREMENTS */
-char *cr_idx_op_labels[CRATE_OP_NR] = {
+const char *cr_idx_op_labels[CRATE_OP_NR] = {
 	"PUT",
 	"GET",
 	"NEXT",
@@ -353,6 +353,10 @@ struct cr_idx_w {
 	size_t				exec_time;
 	enum cr_op_selector		op_selector;
 	struct cr_idx_w_results	        ciw_results;
+	/** Start times of operations in open-loop arrival models. */
+	struct cr_pace			pace;
+	/** Latency statistics, NULL during warmup. */
+	struct cr_lat		       *lat;
 };
 
 static int cr_idx_w_init(struct cr_idx_w *ciw,
@@ -996,6 +1000,20 @@ void set_idx_flags(struct m0_op *op)
 
 }
 
+void cr_idx_init(struct m0_idx *idx, struct m0_uint128 *id)
+{
+	m0_idx_init(idx, crate_uber_realm(), id);
+
+	if (conf->is_enf_meta && m0_fid_is_valid(&dix_pool_ver) &&
+	    m0_fid_is_set(&dix_pool_ver)) {
+		idx->in_entity.en_flags |= M0_ENF_META;
+		idx->in_attr.idx_layout_type = DIX_LTYPE_DESCR;
+		idx->in_attr.idx_pver = dix_pool_ver;
+		crlog(CLL_DEBUG, "DIX pool version: "FID_F"",
+		      FID_P(&idx->in_attr.idx_pver));
+	}
+}
+
 static int cr_execute_query(struct m0_fid *id,
 			     struct kv_pair *p,
 			     enum cr_opcode opcode)
@@ -1014,16 +1032,7 @@ static int cr_execute_query(struct m0_fid *id,
 	if (NULL == M0_ALLOC_ARR(rcs, kv_nr))
 		return M0_ERR(-ENOMEM);
 
-	m0_idx_init(&idx, crate_uber_realm(), (struct m0_uint128 *) id);
-
-	if (conf->is_enf_meta && m0_fid_is_valid(&dix_pool_ver) && 
-	    m0_fid_is_set(&dix_pool_ver)) {
-		idx.in_entity.en_flags |= M0_ENF_META;
-		idx.in_attr.idx_layout_type = DIX_LTYPE_DESCR;
-		idx.in_attr.idx_pver = dix_pool_ver;
-		crlog(CLL_DEBUG, "DIX pool version: "FID_F"",
-		      FID_P(&idx.in_attr.idx_pver));
-	}	
+	cr_idx_init(&idx, (struct m0_uint128 *) id);
 
 	rc = m0_idx_op(&idx, op->m0_op, p->k, p->v, rcs, flags, &ops[0]);
 	if (rc != 0) {
@@ -1099,6 +1108,7 @@ static int cr_idx_w_execute(struct cr_idx_w *w,
 	char 			 kpart_one[kpart_one_size];
 	m0_time_t 		 op_start_time;
 	m0_time_t 		 op_time;
+	m0_time_t		 start = 0;
 
 	M0_PRE(nr_keys > 0);
 
@@ -1142,10 +1152,15 @@ static int cr_idx_w_execute(struct cr_idx_w *w,
 		rc = M0_ERR(rc);
 		goto do_exit_kv;
 	}
+	if (w->lat != NULL)
+		start = cr_pace_wait(&w->pace);
 	/* accumulate time required by each op on opcode basis. */
 	op_start_time = m0_time_now();
 	rc = cr_execute_query(&w->wit->index_fid, &kv, opcode);
 	op_time = m0_time_sub(m0_time_now(), op_start_time);
+	if (w->lat != NULL)
+		cr_lat_record(&w->lat[opcode], start ?: op_start_time,
+			      m0_time_add(op_start_time, op_time));
 	w->ciw_results.ciwr_ops_result[opcode].cior_ops_total_time_m0 =
 			m0_time_add(w->ciw_results.ciwr_ops_result[opcode].cior_ops_total_time_m0,
 			op_time);
@@ -1391,7 +1406,7 @@ static M0_UNUSED int delete_index(struct m0_uint128 id)
 }
 
 
-static int create_index(struct m0_uint128 id)
+int create_index(struct m0_uint128 id)
 {
 	int            rc;
 	struct m0_op  *ops[1] = { NULL };
@@ -1555,6 +1570,8 @@ static int index_operation(struct workload *wt,
 	if (rc != 0)
 		goto do_del_idx;
 
+	cr_pace_init(&w.pace, wt->cw_arrival, wt->cw_arrival_rate);
+	w.lat = wit->lat;
 	rc = cr_idx_w_common(&w);
 	if (rc != 0)
 		goto do_del_idx;
@@ -1578,8 +1595,21 @@ do_exit:
 
 void run_index(struct workload *w, struct workload_task *tasks)
 {
+	struct m0_workload_index *wit = w->u.cw_index;
+	int                       i;
+
+	wit->lat = cr_lat_alloc(cr_idx_op_labels, CRATE_OP_NR,
+				w->cw_lat_period, w->cw_lat_log);
+	if (wit->lat == NULL) {
+		crlog(CLL_ERROR, "Latency statistics allocation failed.");
+		return;
+	}
 	workload_start(w, tasks);
 	workload_join(w, tasks);
+	for (i = 0; i < CRATE_OP_NR; i++)
+		cr_lat_report(&wit->lat[i]);
+	cr_lat_free(wit->lat, CRATE_OP_NR);
+	wit->lat = NULL;
 }
 
 void m0_op_run_index(struct workload *w, struct workload_task *task,
@@ -66,10 +66,23 @@
  * * NR_THREADS: - Number of threads.
  * * EXEC_TIME - time limit for executing (seconds or "unlimited").
  * * NR_ROUNDS:  - How many times this workload to be executed.
+ * * ARRIVAL: closed (default), constant or poisson.
+ * * ARRIVAL_RATE: operations per second of each thread (open-loop).
+ * * LATENCY_PERIOD: period of the latency time series (seconds, 0 - none).
+ * * LATENCY_LOG: file of the latency time series (stdout if not set).
  *
  * ## Measurements
- * Currently, only execution time is measured during the test. It measures with
- * `m0_time*` functions. Crate prints result to stdout when test is finished.
+ * Execution time is measured during the test. It measures with `m0_time*`
+ * functions. Crate prints result to stdout when test is finished.
+ *
+ * Latency of every operation is recorded into a histogram of its type, and
+ * p50, p99, p99.9 and max latencies are printed at the end (see ::cr_lat).
+ * By default threads run in closed loop: an operation is launched when one
+ * of MAX_NR_OPS operations in flight completes, and latency is measured from
+ * its launch. In the open-loop models (ARRIVAL: constant or poisson)
+ * operations are launched according to a schedule of ARRIVAL_RATE per second
+ * of each thread, and latency is measured from the scheduled start, so that
+ * a slow server does not slow down the load and hide its own tail latency.
  * ## Logging
  * crate has own logging system, which based on `fprintf(stderr...)`.
  * (see ::crlog and see ::cr_log).
@@ -107,6 +120,8 @@ void integrity(struct m0_uint128 object_id, unsigned char **md5toverify,
 void list_index_return(struct workload *w);
 
 struct m0_op_context {
+	/** Intended start in an open-loop arrival model, 0 otherwise. */
+	m0_time_t              coc_op_start;
 	m0_time_t              coc_op_launch;
 	m0_time_t              coc_op_finish;
 	int                    coc_index;
@@ -166,6 +181,10 @@ void cr_op_stable(struct m0_op *op)
 		op_time = m0_time_sub(op_context->coc_op_finish,
 				      op_context->coc_op_launch);
 		cr_time_acc(&cti->cti_op_acc_time, op_time);
+		cr_lat_record(&cti->cti_cwi->cwi_lat[op_context->coc_op_code],
+			      op_context->coc_op_start ?:
+			      op_context->coc_op_launch,
+			      op_context->coc_op_finish);
 		m0_semaphore_up(&cti->cti_max_ops_sem);
 		op_context->coc_buf_vec = NULL;
 	}
@@ -452,14 +471,17 @@ int cr_execute_ops(struct m0_workload_io *cwi, struct m0_task_io *cti,
 	int                   idx;
 	struct m0_op_context *op_ctx;
 	cr_operation_t        spec_op;
+	m0_time_t             start;
 
 	for (i = 0; i < cti->cti_nr_ops; i++) {
+		start = cr_pace_wait(&cti->cti_pace);
 		m0_semaphore_down(&cti->cti_max_ops_sem);
 		/* We can launch at least one more operation. */
 		idx = cr_free_op_idx(cti, cwi->cwi_max_nr_ops);
 		op_ctx = m0_alloc(sizeof *op_ctx);
 		M0_ASSERT(op_ctx != NULL);
 
+		op_ctx->coc_op_start = start;
 		op_ctx->coc_index = idx;
 		op_ctx->coc_obj_index = obj_idx;
 		op_ctx->coc_task = cti;
@@ -501,6 +523,7 @@ int cr_op_namei(struct m0_workload_io  *cwi, struct m0_task_io *cti,
 	int                   idx;
 	m0_time_t             stime;
 	m0_time_t             etime;
+	m0_time_t             start;
 	struct m0_op_context *op_ctx;
 	struct m0_op_ops     *cbs;
 	cr_operation_t        spec_op;
@@ -518,14 +541,17 @@ int cr_op_namei(struct m0_workload_io  *cwi, struct m0_task_io *cti,
 	       op_code == CR_OPEN ? "Opening" : "Deleting");
 	m0_semaphore_init(&cti->cti_max_ops_sem, cwi->cwi_max_nr_ops);
 	stime = m0_time_now();
+	cti->cti_pace.cp_next = stime;
 
 	for (i = 0; i < cwi->cwi_nr_objs; i++) {
+		start = cr_pace_wait(&cti->cti_pace);
 		m0_semaphore_down(&cti->cti_max_ops_sem);
 		/* We can launch at least one more operation. */
 		idx = cr_free_op_idx(cti, cwi->cwi_max_nr_ops);
 		op_ctx = m0_alloc(sizeof *op_ctx);
 		M0_ASSERT(op_ctx != NULL);
 
+		op_ctx->coc_op_start = start;
 		op_ctx->coc_index = idx;
 		op_ctx->coc_task = cti;
 		op_ctx->coc_op_code = op_code;
@@ -605,6 +631,7 @@ int cr_op_io(struct m0_workload_io  *cwi, struct m0_task_io *cti,
 	       op_code == CR_WRITE ? "Writing" : "Reading");
 	m0_semaphore_init(&cti->cti_max_ops_sem, cwi->cwi_max_nr_ops);
 	stime = m0_time_now();
+	cti->cti_pace.cp_next = stime;
 
 	for (i = 0; i < cwi->cwi_nr_objs; i++) {
 		rc = cr_execute_ops(cwi, cti, &cti->cti_objs[i], cbs, op_code,
@@ -966,6 +993,8 @@ int cr_tasks_prepare(struct workload *w, struct workload_task *tasks)
 		M0_ASSERT(*cti != NULL);
 
 		(*cti)->cti_task_idx = i;
+		cr_pace_init(&(*cti)->cti_pace, w->cw_arrival,
+			     w->cw_arrival_rate);
 	}
 	return 0;
 }
@@ -1001,6 +1030,14 @@ bool cr_time_not_expired(struct workload *w)
 		cwi->cwi_execution_time ? true : false;
 }
 
+static const char *cr_io_op_labels[CR_OPS_NR] = {
+	[CR_CREATE] = "CREATE",
+	[CR_OPEN]   = "OPEN",
+	[CR_WRITE]  = "WRITE",
+	[CR_READ]   = "READ",
+	[CR_DELETE] = "DELETE"
+};
+
 /** Returns bandwidth in bytes / sec. */
 static uint64_t bw(uint64_t bytes, m0_time_t time)
 {
@@ -1017,6 +1054,12 @@ void run(struct workload *w, struct workload_task *tasks)
 	struct m0_uint128      start_obj_id;
 
 	start_obj_id = cwi->cwi_start_obj_id;
+	cwi->cwi_lat = cr_lat_alloc(cr_io_op_labels, CR_OPS_NR,
+				    w->cw_lat_period, w->cw_lat_log);
+	if (cwi->cwi_lat == NULL) {
+		cr_log(CLL_ERROR, "Latency statistics allocation failed.\n");
+		return;
+	}
 	m0_mutex_init(&cwi->cwi_g.cg_mutex);
 	cwi->cwi_start_time = m0_time_now();
 	if (M0_IN(cwi->cwi_opcode, (CR_POPULATE, CR_CLEANUP)) &&
@@ -1029,6 +1072,7 @@ void run(struct workload *w, struct workload_task *tasks)
 		if (rc != 0) {
 			cr_tasks_release(w, tasks);
 			m0_mutex_fini(&cwi->cwi_g.cg_mutex);
+			cr_lat_free(cwi->cwi_lat, CR_OPS_NR);
 			cr_log(CLL_ERROR, "Task preparation failed.\n");
 			return;
 		}
@@ -1054,6 +1098,10 @@ void run(struct workload *w, struct workload_task *tasks)
 	       TIME_P(m0_time_sub(cwi->cwi_finish_time, cwi->cwi_start_time)),
 	       cwi->cwi_nr_objs * w->cw_nr_thread,
 	       cwi->cwi_ops_done[CR_WRITE] + cwi->cwi_ops_done[CR_READ]);
+	for (i = 0; i < CR_OPS_NR; i++)
+		cr_lat_report(&cwi->cwi_lat[i]);
+	cr_lat_free(cwi->cwi_lat, CR_OPS_NR);
+	cwi->cwi_lat = NULL;
 	if (cwi->cwi_ops_done[CR_CREATE] != 0)
 		cr_log(CLL_INFO, "C: "TIME_F" ("TIME_F" per op)\n",
 		       TIME_P(cwi->cwi_time[CR_CREATE]),
@@ -0,0 +1,809 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+/** @defgroup mix_workload Mixed and trace-replay workloads.
+ * \ingroup crate
+ *
+ * Mixed workload
+ * --------------
+ *
+ * Each thread issues OPS operations picked at random with the weights given
+ * by MIX_CREATE, MIX_WRITE, MIX_READ, MIX_DELETE (objects of the thread) and
+ * MIX_PUT, MIX_GET, MIX_NEXT, MIX_DEL (records of MIX_INDEX_FID). An
+ * operation which cannot be done in the current state is replaced: READ by
+ * WRITE when there is no data to read, WRITE and DELETE by CREATE when the
+ * thread has no objects, CREATE by WRITE when all objects exist.
+ *
+ * * MIX_OBJS: objects of each thread.
+ * * MIX_SIZE_DIST: size distribution of i/o: fixed, uniform or log.
+ * * MIX_SIZE_MIN, MIX_SIZE_MAX: i/o size range, rounded to object blocks.
+ * * MIX_OBJ_SIZE: i/o is done within this size of an object.
+ * * MIX_KEYS: keys of each thread.
+ * * MIX_INDEX_FID: index of the records, created if it does not exist.
+ * * MIX_VALUE_SIZE: size of values of PUT.
+ *
+ * Trace-replay workload
+ * ---------------------
+ *
+ * Replays operations of REPLAY_FILE at their original times, scaled by
+ * REPLAY_SPEED percents. Each line of the trace is an operation:
+ * ```
+ *	<time_us> <op> <id> [<offset|key> [<size>]]
+ * ```
+ * where time_us is the start time in microseconds, op is one of create,
+ * write, read, delete (objects) or put, get, next, del (indices), id is the
+ * object or index identifier formatted as `hi:lo` in hex, offset and size
+ * give the object extent (rounded to object blocks) and key and size give
+ * the record key and value size of an index operation. Lines starting with
+ * '#' are ignored. Records must be sorted by time. Objects referred before
+ * they are created are opened on the first reference.
+ *
+ * Operations of an entity are done in the trace order by the thread owning
+ * the entity; entities are distributed over NR_THREADS threads. A thread
+ * falling behind the trace timing issues operations back to back.
+ *
+ * Both workloads record latency as described in ::cr_lat; the mixed one is
+ * paced by ARRIVAL and ARRIVAL_RATE. Latency of a replayed operation is
+ * measured from its start time in the trace.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>            /* strcasecmp */
+#include <inttypes.h>
+#include <math.h>               /* exp, log */
+
+#include "lib/arith.h"          /* m0_round_up */
+#include "lib/memory.h"
+#include "lib/trace.h"
+#include "motr/client.h"
+#include "motr/client_internal.h"
+#include "motr/idx.h"
+
+#include "motr/m0crate/logger.h"
+#include "motr/m0crate/workload.h"
+#include "motr/m0crate/crate_client.h"
+#include "motr/m0crate/crate_client_utils.h"
+
+#define LOG_PREFIX "mix: "
+
+extern struct crate_conf *conf;
+
+enum {
+	/** Object i/o is done in units of the default object block. */
+	CR_MIX_BLOCK   = 1 << M0_DEFAULT_BUF_SHIFT,
+	/** Records returned by NEXT. */
+	CR_MIX_NEXT_NR = 16
+};
+
+static const char *cr_mix_op_labels[CMO_NR] = {
+	[CMO_CREATE] = "CREATE",
+	[CMO_WRITE]  = "WRITE",
+	[CMO_READ]   = "READ",
+	[CMO_DELETE] = "DELETE",
+	[CMO_PUT]    = "PUT",
+	[CMO_GET]    = "GET",
+	[CMO_NEXT]   = "NEXT",
+	[CMO_DEL]    = "DEL"
+};
+
+/** Returns a pseudo-random number in [0, end). */
+static uint64_t cr_mix_rand(uint64_t end)
+{
+	return (((uint64_t)rand() << 31) | rand()) % end;
+}
+
+/** Launches an operation, waits for its completion and releases it. */
+static int cr_op_exec(struct m0_op *op)
+{
+	int rc;
+
+	m0_op_launch(&op, 1);
+	rc = m0_op_wait(op, M0_BITS(M0_OS_FAILED, M0_OS_STABLE),
+			M0_TIME_NEVER) ?: op->op_sm.sm_rc;
+	m0_op_fini(op);
+	m0_op_free(op);
+	return rc;
+}
+
+static int cr_obj_create(struct m0_obj *obj)
+{
+	struct m0_op *op = NULL;
+
+	return m0_entity_create(NULL, &obj->ob_entity, &op) ?: cr_op_exec(op);
+}
+
+static int cr_obj_open(struct m0_obj *obj)
+{
+	struct m0_op *op = NULL;
+
+	return m0_entity_open(&obj->ob_entity, &op) ?: cr_op_exec(op);
+}
+
+static int cr_obj_delete(struct m0_obj *obj)
+{
+	struct m0_op *op = NULL;
+
+	return m0_entity_delete(&obj->ob_entity, &op) ?: cr_op_exec(op);
+}
+
+static int cr_obj_io(struct m0_obj *obj, enum m0_obj_opcode opcode,
+		     m0_bindex_t off, m0_bcount_t size, void *buf)
+{
+	struct m0_indexvec ext;
+	struct m0_bufvec   data;
+	struct m0_op      *op = NULL;
+
+	ext = (struct m0_indexvec) {
+		.iv_vec   = { .v_nr = 1, .v_count = &size },
+		.iv_index = &off
+	};
+	data = M0_BUFVEC_INIT_BUF(&buf, &size);
+	return m0_obj_op(obj, opcode, &ext, &data, NULL, 0, 0, &op) ?:
+		cr_op_exec(op);
+}
+
+/**
+ * Executes an index operation on a single record. NEXT returns up to
+ * CR_MIX_NEXT_NR records starting from the key.
+ */
+static int cr_kv_exec(struct m0_fid *index_fid, enum cr_mix_op op,
+		      const struct m0_fid *key, int vsize)
+{
+	static const enum m0_idx_opcode opcode[CMO_NR] = {
+		[CMO_PUT]  = M0_IC_PUT,
+		[CMO_GET]  = M0_IC_GET,
+		[CMO_NEXT] = M0_IC_NEXT,
+		[CMO_DEL]  = M0_IC_DEL
+	};
+	struct m0_bufvec keys = {};
+	struct m0_bufvec vals = {};
+	int32_t          rcs[CR_MIX_NEXT_NR];
+	int              nr = op == CMO_NEXT ? CR_MIX_NEXT_NR : 1;
+	struct m0_idx    idx = {};
+	struct m0_op    *mop = NULL;
+	int              rc;
+
+	M0_PRE(M0_IN(op, (CMO_PUT, CMO_GET, CMO_NEXT, CMO_DEL)));
+
+	rc = m0_bufvec_empty_alloc(&keys, nr) ?:
+		m0_bufvec_empty_alloc(&vals, nr);
+	if (rc != 0)
+		goto out;
+	keys.ov_buf[0] = m0_alloc(sizeof *key);
+	if (keys.ov_buf[0] == NULL) {
+		rc = -ENOMEM;
+		goto out;
+	}
+	memcpy(keys.ov_buf[0], key, sizeof *key);
+	keys.ov_vec.v_count[0] = sizeof *key;
+	if (op == CMO_PUT) {
+		vals.ov_buf[0] = m0_alloc(vsize);
+		if (vals.ov_buf[0] == NULL) {
+			rc = -ENOMEM;
+			goto out;
+		}
+		memset(vals.ov_buf[0], 'v', vsize);
+		vals.ov_vec.v_count[0] = vsize;
+	}
+
+	cr_idx_init(&idx, (struct m0_uint128 *)index_fid);
+	rc = m0_idx_op(&idx, opcode[op], &keys, op == CMO_DEL ? NULL : &vals,
+		       rcs, op == CMO_PUT ? M0_OIF_OVERWRITE : 0, &mop);
+	if (rc == 0) {
+		set_idx_flags(mop);
+		rc = cr_op_exec(mop);
+	}
+	m0_idx_fini(&idx);
+out:
+	m0_bufvec_free(&keys);
+	m0_bufvec_free(&vals);
+	return rc;
+}
+
+static void cr_obj_id_get(struct m0_uint128 *id)
+{
+	do {
+		id->u_lo = cr_mix_rand(UINT64_MAX);
+		/* Highest 8 bits are left for Motr. */
+		id->u_hi = cr_mix_rand(UINT64_MAX) & ~(0xFFUL << 56);
+	} while (!entity_id_is_valid(id));
+}
+
+/*
+ * Mixed workload.
+ */
+
+struct cr_mix_obj {
+	struct m0_obj cmo_obj;
+	bool          cmo_exists;
+	/** End of the data written to the object. */
+	uint64_t      cmo_size;
+};
+
+/** Context of a thread of the mixed workload. */
+struct cr_mix_task {
+	struct m0_workload_mix *cmt_cwm;
+	/** Keys of the thread have this container. */
+	uint64_t                cmt_key_prefix;
+	struct cr_mix_obj      *cmt_objs;
+	char                   *cmt_buf;
+	struct cr_pace          cmt_pace;
+};
+
+static uint64_t cr_mix_size(const struct m0_workload_mix *cwm)
+{
+	double   lo = cwm->cwm_size_min;
+	double   hi = cwm->cwm_size_max;
+	double   r  = rand() / (RAND_MAX + 1.0);
+	uint64_t size;
+
+	switch (cwm->cwm_size_dist) {
+	case CSD_UNIFORM:
+		size = lo + r * (hi - lo);
+		break;
+	case CSD_LOG:
+		size = exp(log(lo) + r * (log(hi) - log(lo)));
+		break;
+	default:
+		size = lo;
+	}
+	return min64u(m0_round_up(size, CR_MIX_BLOCK), cwm->cwm_size_max);
+}
+
+static enum cr_mix_op cr_mix_op_select(const struct m0_workload_mix *cwm,
+				       int total)
+{
+	int r = cr_mix_rand(total);
+	int i;
+
+	for (i = 0; i < CMO_NR - 1; i++) {
+		r -= cwm->cwm_weight[i];
+		if (r < 0)
+			break;
+	}
+	return i;
+}
+
+/**
+ * Returns a random object of the thread, which exists and has at least
+ * @size bytes of data or does not exist, or NULL.
+ */
+static struct cr_mix_obj *cr_mix_obj_find(struct cr_mix_task *t, bool exists,
+					  uint64_t size)
+{
+	struct cr_mix_obj *o;
+	int                nr = t->cmt_cwm->cwm_nr_objs;
+	int                start = cr_mix_rand(nr);
+	int                i;
+
+	for (i = 0; i < nr; i++) {
+		o = &t->cmt_objs[(start + i) % nr];
+		if (o->cmo_exists == exists && (!exists || o->cmo_size >= size))
+			return o;
+	}
+	return NULL;
+}
+
+/** Executes an operation of the mix, or its replacement returned in @op. */
+static int cr_mix_exec(struct cr_mix_task *t, enum cr_mix_op *op)
+{
+	struct m0_workload_mix *cwm = t->cmt_cwm;
+	struct cr_mix_obj      *o = NULL;
+	struct m0_uint128       id;
+	struct m0_fid           key;
+	uint64_t                size = cr_mix_size(cwm);
+	uint64_t                off;
+	int                     rc;
+
+	if (*op == CMO_READ && (o = cr_mix_obj_find(t, true, size)) == NULL)
+		*op = CMO_WRITE;
+	if (M0_IN(*op, (CMO_WRITE, CMO_DELETE)) &&
+	    (o = cr_mix_obj_find(t, true, 0)) == NULL)
+		*op = CMO_CREATE;
+	if (*op == CMO_CREATE && (o = cr_mix_obj_find(t, false, 0)) == NULL) {
+		*op = CMO_WRITE;
+		o = cr_mix_obj_find(t, true, 0);
+	}
+
+	switch (*op) {
+	case CMO_CREATE:
+		cr_obj_id_get(&id);
+		M0_SET0(&o->cmo_obj);
+		m0_obj_init(&o->cmo_obj, crate_uber_realm(), &id,
+			    conf->layout_id);
+		rc = cr_obj_create(&o->cmo_obj);
+		if (rc == 0) {
+			o->cmo_exists = true;
+			o->cmo_size = 0;
+		} else
+			m0_obj_fini(&o->cmo_obj);
+		break;
+	case CMO_WRITE:
+		off = m0_round_down(cr_mix_rand(cwm->cwm_obj_size - size + 1),
+				    CR_MIX_BLOCK);
+		rc = cr_obj_io(&o->cmo_obj, M0_OC_WRITE, off, size,
+			       t->cmt_buf);
+		if (rc == 0)
+			o->cmo_size = max64u(o->cmo_size, off + size);
+		break;
+	case CMO_READ:
+		off = m0_round_down(cr_mix_rand(o->cmo_size - size + 1),
+				    CR_MIX_BLOCK);
+		rc = cr_obj_io(&o->cmo_obj, M0_OC_READ, off, size, t->cmt_buf);
+		break;
+	case CMO_DELETE:
+		rc = cr_obj_delete(&o->cmo_obj);
+		if (rc == 0) {
+			m0_obj_fini(&o->cmo_obj);
+			o->cmo_exists = false;
+		}
+		break;
+	default:
+		key = M0_FID_INIT(t->cmt_key_prefix,
+				  cr_mix_rand(cwm->cwm_nr_keys));
+		rc = cr_kv_exec(&cwm->cwm_index_fid, *op, &key,
+				cwm->cwm_value_size);
+	}
+	return rc;
+}
+
+static void cr_mix_task_run(struct m0_workload_mix *cwm,
+			    struct workload *w, int task_idx)
+{
+	struct cr_mix_task t = {
+		.cmt_cwm        = cwm,
+		.cmt_key_prefix = task_idx + 1
+	};
+	enum cr_mix_op     op;
+	m0_time_t          start;
+	int                total = 0;
+	int                failed = 0;
+	int                rc;
+	int                i;
+
+	for (i = 0; i < CMO_NR; i++)
+		total += cwm->cwm_weight[i];
+	M0_ALLOC_ARR(t.cmt_objs, cwm->cwm_nr_objs);
+	t.cmt_buf = m0_alloc_aligned(cwm->cwm_size_max, M0_DEFAULT_BUF_SHIFT);
+	if (t.cmt_objs == NULL || t.cmt_buf == NULL) {
+		crlog(CLL_ERROR, "Out of memory.");
+		goto out;
+	}
+	memset(t.cmt_buf, 'd', cwm->cwm_size_max);
+
+	cr_pace_init(&t.cmt_pace, w->cw_arrival, w->cw_arrival_rate);
+	for (i = 0; i < w->cw_ops; i++) {
+		op = cr_mix_op_select(cwm, total);
+		start = cr_pace_wait(&t.cmt_pace) ?: m0_time_now();
+		rc = cr_mix_exec(&t, &op);
+		if (rc == 0)
+			cr_lat_record(&cwm->cwm_lat[op], start, m0_time_now());
+		else {
+			crlog(CLL_DEBUG, "%s failed: %d",
+			      cr_mix_op_labels[op], rc);
+			failed++;
+		}
+	}
+	if (failed != 0)
+		crlog(CLL_WARN, "Thread %d: %d operations failed.",
+		      task_idx, failed);
+
+	for (i = 0; i < cwm->cwm_nr_objs; i++) {
+		if (t.cmt_objs[i].cmo_exists) {
+			(void)cr_obj_delete(&t.cmt_objs[i].cmo_obj);
+			m0_obj_fini(&t.cmt_objs[i].cmo_obj);
+		}
+	}
+out:
+	m0_free_aligned(t.cmt_buf, cwm->cwm_size_max, M0_DEFAULT_BUF_SHIFT);
+	m0_free(t.cmt_objs);
+}
+
+static bool cr_mix_has_index_ops(const struct m0_workload_mix *cwm)
+{
+	return cwm->cwm_weight[CMO_PUT] + cwm->cwm_weight[CMO_GET] +
+		cwm->cwm_weight[CMO_NEXT] + cwm->cwm_weight[CMO_DEL] > 0;
+}
+
+static int cr_mix_check(struct m0_workload_mix *cwm)
+{
+	int total = 0;
+	int i;
+
+	for (i = 0; i < CMO_NR; i++) {
+		if (cwm->cwm_weight[i] < 0)
+			return -EINVAL;
+		total += cwm->cwm_weight[i];
+	}
+	cwm->cwm_size_min = m0_round_up(cwm->cwm_size_min, CR_MIX_BLOCK);
+	cwm->cwm_size_max = m0_round_up(cwm->cwm_size_max, CR_MIX_BLOCK);
+	if (total == 0 || cwm->cwm_nr_objs <= 0 || cwm->cwm_nr_keys <= 0 ||
+	    cwm->cwm_value_size <= 0 || cwm->cwm_size_min == 0 ||
+	    cwm->cwm_size_min > cwm->cwm_size_max ||
+	    cwm->cwm_size_max > cwm->cwm_obj_size ||
+	    (cr_mix_has_index_ops(cwm) && !m0_fid_is_set(&cwm->cwm_index_fid)))
+		return -EINVAL;
+	return 0;
+}
+
+void run_mix(struct workload *w, struct workload_task *tasks)
+{
+	struct m0_workload_mix *cwm = w->u.cw_mix;
+	int                     rc;
+	int                     i;
+
+	rc = cr_mix_check(cwm);
+	if (rc != 0) {
+		crlog(CLL_ERROR, "Invalid mixed workload parameters.");
+		return;
+	}
+	if (cr_mix_has_index_ops(cwm)) {
+		/* The index may be left by a previous run. */
+		rc = create_index(*(struct m0_uint128 *)&cwm->cwm_index_fid);
+		if (rc != 0 && rc != -EEXIST) {
+			crlog(CLL_ERROR, "Unable to create index: %d", rc);
+			return;
+		}
+	}
+	cwm->cwm_lat = cr_lat_alloc(cr_mix_op_labels, CMO_NR,
+				    w->cw_lat_period, w->cw_lat_log);
+	if (cwm->cwm_lat == NULL) {
+		crlog(CLL_ERROR, "Latency statistics allocation failed.");
+		return;
+	}
+	workload_start(w, tasks);
+	workload_join(w, tasks);
+	crlog(CLL_INFO, "Mixed workload is finished.");
+	for (i = 0; i < CMO_NR; i++)
+		cr_lat_report(&cwm->cwm_lat[i]);
+	cr_lat_free(cwm->cwm_lat, CMO_NR);
+	cwm->cwm_lat = NULL;
+}
+
+void m0_op_run_mix(struct workload *w, struct workload_task *task,
+		   const struct workload_op *op)
+{
+	struct m0_workload_task m0_task = {};
+	bool                    is_m0_thread = m0_thread_tls() != NULL;
+
+	if (!is_m0_thread && adopt_motr_thread(&m0_task) != 0)
+		return;
+	cr_mix_task_run(w->u.cw_mix, w, task->wt_thread);
+	if (!is_m0_thread)
+		release_motr_thread(&m0_task);
+}
+
+/*
+ * Trace-replay workload.
+ */
+
+/** An operation of the trace. */
+struct cr_replay_rec {
+	/** Start time, relative to the first operation. */
+	m0_time_t      crr_time;
+	enum cr_mix_op crr_op;
+	/** Index in m0_workload_replay::cwr_ents. */
+	int            crr_ent;
+	/** Offset of object i/o or record key. */
+	uint64_t       crr_off;
+	/** Size of object i/o or record value. */
+	uint64_t       crr_size;
+};
+
+/** An object or index of the trace. */
+struct cr_replay_ent {
+	struct m0_uint128 cre_id;
+	/** The object is initialised and open. */
+	bool              cre_open;
+	struct m0_obj     cre_obj;
+};
+
+static int cr_replay_ent_cmp(const void *a, const void *b)
+{
+	const struct m0_uint128 *id0 = a;
+	const struct m0_uint128 *id1 = b;
+
+	return m0_uint128_cmp(id0, id1);
+}
+
+static int cr_replay_op_parse(const char *name)
+{
+	int i;
+
+	for (i = 0; i < CMO_NR; i++) {
+		if (strcasecmp(name, cr_mix_op_labels[i]) == 0)
+			return i;
+	}
+	return -EINVAL;
+}
+
+/** Parses a line of the trace. Returns +1 for comments and empty lines. */
+static int cr_replay_line_parse(const char *line, uint64_t *time,
+				struct cr_replay_rec *rec,
+				struct m0_uint128 *id)
+{
+	char name[16];
+	int  nr;
+	int  op;
+
+	if (line[strspn(line, " \t\n")] == 0 || line[0] == '#')
+		return +1;
+	*rec = (struct cr_replay_rec) {};
+	nr = sscanf(line, "%"SCNu64" %15s %"SCNx64":%"SCNx64" %"SCNu64
+		    " %"SCNu64, time, name, &id->u_hi, &id->u_lo,
+		    &rec->crr_off, &rec->crr_size);
+	op = nr >= 4 ? cr_replay_op_parse(name) : -EINVAL;
+	if (op < 0)
+		return -EINVAL;
+	rec->crr_op = op;
+	if ((M0_IN(op, (CMO_WRITE, CMO_READ, CMO_PUT)) && nr < 6) ||
+	    (M0_IN(op, (CMO_GET, CMO_NEXT, CMO_DEL)) && nr < 5))
+		return -EINVAL;
+	if (M0_IN(op, (CMO_WRITE, CMO_READ))) {
+		rec->crr_size = m0_round_up(rec->crr_off + rec->crr_size,
+					    CR_MIX_BLOCK);
+		rec->crr_off = m0_round_down(rec->crr_off, CR_MIX_BLOCK);
+		rec->crr_size -= rec->crr_off;
+	}
+	return 0;
+}
+
+/** Reads the trace and builds the table of its entities. */
+static int cr_replay_load(struct m0_workload_replay *cwr)
+{
+	struct cr_replay_rec *rec;
+	struct m0_uint128    *ids = NULL;
+	struct m0_uint128    *id;
+	char                  line[256];
+	uint64_t              time;
+	uint64_t              time0 = 0;
+	FILE                 *f;
+	int                   nr = 0;
+	int                   lineno = 0;
+	int                   rc = 0;
+	int                   i;
+
+	f = fopen(cwr->cwr_file, "r");
+	if (f == NULL) {
+		crlog(CLL_ERROR, "Unable to open a file: %s", cwr->cwr_file);
+		return -errno;
+	}
+	while (fgets(line, sizeof line, f) != NULL)
+		nr++;
+	rewind(f);
+	M0_ALLOC_ARR(cwr->cwr_recs, nr);
+	M0_ALLOC_ARR(ids, nr);
+	if (cwr->cwr_recs == NULL || ids == NULL) {
+		rc = -ENOMEM;
+		goto out;
+	}
+	nr = 0;
+	while (fgets(line, sizeof line, f) != NULL) {
+		lineno++;
+		rec = &cwr->cwr_recs[nr];
+		rc = cr_replay_line_parse(line, &time, rec, &ids[nr]);
+		if (rc > 0)
+			continue;
+		if (rc == 0 && nr > 0 && time < time0 + rec[-1].crr_time / 1000)
+			rc = -EINVAL;
+		if (rc != 0) {
+			crlog(CLL_ERROR, "%s:%d: invalid or unsorted record.",
+			      cwr->cwr_file, lineno);
+			goto out;
+		}
+		if (nr == 0)
+			time0 = time;
+		rec->crr_time = (time - time0) * 1000;
+		nr++;
+	}
+	cwr->cwr_nr_recs = nr;
+
+	/* Entities: sorted unique identifiers of the records. */
+	M0_ALLOC_ARR(cwr->cwr_ents, max32(nr, 1));
+	if (cwr->cwr_ents == NULL) {
+		rc = -ENOMEM;
+		goto out;
+	}
+	for (i = 0; i < nr; i++)
+		cwr->cwr_ents[i].cre_id = ids[i];
+	qsort(cwr->cwr_ents, nr, sizeof cwr->cwr_ents[0], cr_replay_ent_cmp);
+	for (i = 0; i < nr; i++) {
+		if (i == 0 || m0_uint128_cmp(&cwr->cwr_ents[i].cre_id,
+			     &cwr->cwr_ents[cwr->cwr_nr_ents - 1].cre_id) != 0)
+			cwr->cwr_ents[cwr->cwr_nr_ents++] = cwr->cwr_ents[i];
+	}
+	for (i = 0; i < nr; i++) {
+		id = bsearch(&ids[i], cwr->cwr_ents, cwr->cwr_nr_ents,
+			     sizeof cwr->cwr_ents[0], cr_replay_ent_cmp);
+		M0_ASSERT(id != NULL);
+		cwr->cwr_recs[i].crr_ent = (struct cr_replay_ent *)id -
+			cwr->cwr_ents;
+	}
+	crlog(CLL_INFO, "Trace %s: %d operations, %d entities.",
+	      cwr->cwr_file, cwr->cwr_nr_recs, cwr->cwr_nr_ents);
+out:
+	m0_free(ids);
+	fclose(f);
+	return rc;
+}
+
+static int cr_replay_exec(struct m0_workload_replay *cwr,
+			  const struct cr_replay_rec *rec, void *buf)
+{
+	struct cr_replay_ent *ent = &cwr->cwr_ents[rec->crr_ent];
+	struct m0_fid         key;
+	int                   rc;
+
+	if (rec->crr_op < CMO_PUT && !ent->cre_open) {
+		M0_SET0(&ent->cre_obj);
+		m0_obj_init(&ent->cre_obj, crate_uber_realm(), &ent->cre_id,
+			    conf->layout_id);
+		rc = rec->crr_op == CMO_CREATE ? cr_obj_create(&ent->cre_obj) :
+			cr_obj_open(&ent->cre_obj);
+		if (rc != 0) {
+			m0_obj_fini(&ent->cre_obj);
+			return rc;
+		}
+		ent->cre_open = true;
+		if (rec->crr_op == CMO_CREATE)
+			return 0;
+	}
+
+	switch (rec->crr_op) {
+	case CMO_CREATE:
+		rc = -EEXIST;
+		break;
+	case CMO_WRITE:
+	case CMO_READ:
+		rc = cr_obj_io(&ent->cre_obj, rec->crr_op == CMO_WRITE ?
+			       M0_OC_WRITE : M0_OC_READ, rec->crr_off,
+			       rec->crr_size, buf);
+		break;
+	case CMO_DELETE:
+		rc = cr_obj_delete(&ent->cre_obj);
+		m0_obj_fini(&ent->cre_obj);
+		ent->cre_open = false;
+		break;
+	default:
+		key = M0_FID_INIT(0, rec->crr_off);
+		rc = cr_kv_exec((struct m0_fid *)&ent->cre_id, rec->crr_op,
+				&key, rec->crr_size ?: 1);
+	}
+	return rc;
+}
+
+static void cr_replay_task_run(struct m0_workload_replay *cwr, int nr_tasks,
+			       int task_idx)
+{
+	const struct cr_replay_rec *rec;
+	struct cr_replay_ent       *ent;
+	m0_time_t                   start = m0_time_now();
+	m0_time_t                   due;
+	m0_time_t                   now;
+	uint64_t                    size_max = CR_MIX_BLOCK;
+	void                       *buf;
+	int                         failed = 0;
+	int                         rc;
+	int                         i;
+
+	for (i = 0; i < cwr->cwr_nr_recs; i++) {
+		if (M0_IN(cwr->cwr_recs[i].crr_op, (CMO_WRITE, CMO_READ)))
+			size_max = max64u(size_max, cwr->cwr_recs[i].crr_size);
+	}
+	buf = m0_alloc_aligned(size_max, M0_DEFAULT_BUF_SHIFT);
+	if (buf == NULL) {
+		crlog(CLL_ERROR, "Out of memory.");
+		return;
+	}
+	memset(buf, 'd', size_max);
+
+	for (i = 0; i < cwr->cwr_nr_recs; i++) {
+		rec = &cwr->cwr_recs[i];
+		if (rec->crr_ent % nr_tasks != task_idx)
+			continue;
+		due = m0_time_add(start, rec->crr_time * 100 / cwr->cwr_speed);
+		now = m0_time_now();
+		if (due > now)
+			m0_nanosleep(m0_time_sub(due, now), NULL);
+		rc = cr_replay_exec(cwr, rec, buf);
+		if (rc == 0)
+			cr_lat_record(&cwr->cwr_lat[rec->crr_op], due,
+				      m0_time_now());
+		else {
+			crlog(CLL_DEBUG, "%s failed: %d",
+			      cr_mix_op_labels[rec->crr_op], rc);
+			failed++;
+		}
+	}
+	if (failed != 0)
+		crlog(CLL_WARN, "Thread %d: %d operations failed.",
+		      task_idx, failed);
+
+	for (i = task_idx; i < cwr->cwr_nr_ents; i += nr_tasks) {
+		ent = &cwr->cwr_ents[i];
+		if (ent->cre_open) {
+			m0_obj_fini(&ent->cre_obj);
+			ent->cre_open = false;
+		}
+	}
+	m0_free_aligned(buf, size_max, M0_DEFAULT_BUF_SHIFT);
+}
+
+void run_replay(struct workload *w, struct workload_task *tasks)
+{
+	struct m0_workload_replay *cwr = w->u.cw_replay;
+	int                        rc;
+	int                        i;
+
+	if (cwr->cwr_file == NULL || cwr->cwr_speed <= 0) {
+		crlog(CLL_ERROR, "Invalid trace-replay workload parameters.");
+		return;
+	}
+	rc = cr_replay_load(cwr);
+	if (rc != 0)
+		goto out;
+	cwr->cwr_lat = cr_lat_alloc(cr_mix_op_labels, CMO_NR,
+				    w->cw_lat_period, w->cw_lat_log);
+	if (cwr->cwr_lat == NULL) {
+		crlog(CLL_ERROR, "Latency statistics allocation failed.");
+		goto out;
+	}
+	workload_start(w, tasks);
+	workload_join(w, tasks);
+	crlog(CLL_INFO, "Trace replay is finished.");
+	for (i = 0; i < CMO_NR; i++)
+		cr_lat_report(&cwr->cwr_lat[i]);
+	cr_lat_free(cwr->cwr_lat, CMO_NR);
+	cwr->cwr_lat = NULL;
+out:
+	m0_free0(&cwr->cwr_recs);
+	m0_free0(&cwr->cwr_ents);
+	cwr->cwr_nr_recs = 0;
+	cwr->cwr_nr_ents = 0;
+}
+
+void m0_op_run_replay(struct workload *w, struct workload_task *task,
+		      const struct workload_op *op)
+{
+	struct m0_workload_task m0_task = {};
+	bool                    is_m0_thread = m0_thread_tls() != NULL;
+
+	if (!is_m0_thread && adopt_motr_thread(&m0_task) != 0)
+		return;
+	cr_replay_task_run(w->u.cw_replay, w->cw_nr_thread, task->wt_thread);
+	if (!is_m0_thread)
+		release_motr_thread(&m0_task);
+}
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -28,9 +28,12 @@
 
 #include <string.h>
 #include <err.h>
+#include <math.h>       /* log, ceil */
+#include "lib/arith.h"  /* m0_log2 */
 #include "lib/trace.h"
 #include "motr/m0crate/crate_client_utils.h"
 #include "motr/m0crate/logger.h"
+#include "motr/m0crate/crate_dist.h"
 
 /* XXX: io checks are disabled */
 #if 0
@@ -251,6 +254,194 @@ unsigned long long getnum(const char *str, const char *msg)
 	return num;
 }
 
+void cr_pace_init(struct cr_pace *p, enum cr_arrival type, uint64_t rate)
+{
+	*p = (struct cr_pace) {
+		.cp_type = type,
+		.cp_rate = rate,
+		.cp_next = m0_time_now()
+	};
+}
+
+m0_time_t cr_pace_wait(struct cr_pace *p)
+{
+	m0_time_t now = m0_time_now();
+	m0_time_t start;
+	double    gap;
+
+	if (p->cp_type == CRA_CLOSED || p->cp_rate == 0)
+		return 0;
+	start = p->cp_next;
+	if (start > now)
+		m0_nanosleep(m0_time_sub(start, now), NULL);
+	gap = p->cp_type == CRA_CONSTANT ? 1.0 :
+		-log((rand() + 1.0) / (RAND_MAX + 2.0));
+	p->cp_next = m0_time_add(start, gap * M0_TIME_ONE_SECOND / p->cp_rate);
+	return start;
+}
+
+static int cr_hist_idx(m0_time_t val)
+{
+	unsigned shift;
+
+	if (val < 2 * CR_HIST_HALF)
+		return val;
+	shift = m0_log2(val) - (CR_HIST_SUB_BITS - 1);
+	return shift * CR_HIST_HALF + (val >> shift);
+}
+
+/** Returns the highest value counted in the bucket. */
+static m0_time_t cr_hist_val(int idx)
+{
+	unsigned shift;
+
+	if (idx < 2 * CR_HIST_HALF)
+		return idx;
+	shift = idx / CR_HIST_HALF - 1;
+	return ((m0_time_t)(idx - shift * CR_HIST_HALF + 1) << shift) - 1;
+}
+
+void cr_hist_record(struct cr_hist *h, m0_time_t val)
+{
+	h->ch_bucket[cr_hist_idx(val)]++;
+	h->ch_nr++;
+	h->ch_max = max64u(h->ch_max, val);
+}
+
+m0_time_t cr_hist_quantile(const struct cr_hist *h, double q)
+{
+	uint64_t rank = max64u(ceil(q * h->ch_nr), 1);
+	uint64_t nr = 0;
+	int      i;
+
+	for (i = 0; i < CR_HIST_NR; i++) {
+		nr += h->ch_bucket[i];
+		if (nr >= rank)
+			return min64u(cr_hist_val(i), h->ch_max);
+	}
+	return h->ch_max;
+}
+
+void cr_hist_merge(struct cr_hist *dst, const struct cr_hist *src)
+{
+	int i;
+
+	for (i = 0; i < CR_HIST_NR; i++)
+		dst->ch_bucket[i] += src->ch_bucket[i];
+	dst->ch_nr += src->ch_nr;
+	dst->ch_max = max64u(dst->ch_max, src->ch_max);
+}
+
+void cr_hist_print(FILE *f, const char *prefix, const char *label,
+		   const struct cr_hist *h)
+{
+	fprintf(f, "%s%s, ops, %"PRIu64", p50_ns, %"PRIu64", p99_ns, %"PRIu64
+		", p99.9_ns, %"PRIu64", max_ns, %"PRIu64"\n", prefix,
+		label, h->ch_nr, cr_hist_quantile(h, 0.5),
+		cr_hist_quantile(h, 0.99), cr_hist_quantile(h, 0.999),
+		h->ch_max);
+}
+
+static void cr_lat_init(struct cr_lat *l, const char *label,
+			m0_time_t period_len, FILE *ts)
+{
+	M0_SET0(l);
+	l->cl_label = label;
+	m0_mutex_init(&l->cl_lock);
+	l->cl_start = m0_time_now();
+	l->cl_period_len = period_len;
+	l->cl_period_end = m0_time_add(l->cl_start, period_len);
+	l->cl_ts = ts;
+}
+
+static void cr_lat_fini(struct cr_lat *l)
+{
+	m0_mutex_fini(&l->cl_lock);
+}
+
+struct cr_lat *cr_lat_alloc(const char **labels, int nr, m0_time_t period_len,
+			    const char *ts_path)
+{
+	struct cr_lat *lat;
+	FILE          *ts = stdout;
+	int            i;
+
+	if (ts_path != NULL) {
+		ts = fopen(ts_path, "w");
+		if (ts == NULL) {
+			cr_log(CLL_ERROR, "Unable to open a file: %s\n",
+			       ts_path);
+			return NULL;
+		}
+	}
+	M0_ALLOC_ARR(lat, nr);
+	if (lat == NULL) {
+		if (ts != stdout)
+			fclose(ts);
+		return NULL;
+	}
+	for (i = 0; i < nr; i++)
+		cr_lat_init(&lat[i], labels[i], period_len, ts);
+	return lat;
+}
+
+void cr_lat_free(struct cr_lat *lat, int nr)
+{
+	FILE *ts = lat[0].cl_ts;
+	int   i;
+
+	for (i = 0; i < nr; i++)
+		cr_lat_fini(&lat[i]);
+	if (ts != stdout)
+		fclose(ts);
+	m0_free(lat);
+}
+
+static void cr_lat_period_flush(struct cr_lat *l, m0_time_t now)
+{
+	m0_time_t t = m0_time_sub(l->cl_period_end, l->cl_start);
+	char      prefix[32];
+
+	M0_PRE(m0_mutex_is_locked(&l->cl_lock));
+
+	if (l->cl_period.ch_nr != 0) {
+		snprintf(prefix, sizeof prefix, "ts: %.3f, ",
+			 (double)t / M0_TIME_ONE_SECOND);
+		cr_hist_print(l->cl_ts, prefix, l->cl_label, &l->cl_period);
+		fflush(l->cl_ts);
+		cr_dist_hist_send(l->cl_label, false, t, l->cl_period_len,
+				  &l->cl_period);
+		M0_SET0(&l->cl_period);
+	}
+	l->cl_period_end = m0_time_add(l->cl_start, l->cl_period_len *
+			(m0_time_sub(now, l->cl_start) / l->cl_period_len + 1));
+}
+
+void cr_lat_record(struct cr_lat *l, m0_time_t start, m0_time_t end)
+{
+	m0_time_t lat = end > start ? m0_time_sub(end, start) : 0;
+
+	m0_mutex_lock(&l->cl_lock);
+	cr_hist_record(&l->cl_total, lat);
+	if (l->cl_period_len != 0) {
+		if (end >= l->cl_period_end)
+			cr_lat_period_flush(l, end);
+		cr_hist_record(&l->cl_period, lat);
+	}
+	m0_mutex_unlock(&l->cl_lock);
+}
+
+void cr_lat_report(struct cr_lat *l)
+{
+	m0_mutex_lock(&l->cl_lock);
+	if (l->cl_period_len != 0)
+		cr_lat_period_flush(l, m0_time_now());
+	if (l->cl_total.ch_nr != 0) {
+		cr_hist_print(stdout, "latency: ", l->cl_label, &l->cl_total);
+		cr_dist_hist_send(l->cl_label, true, 0, 0, &l->cl_total);
+	}
+	m0_mutex_unlock(&l->cl_lock);
+}
 
 /** @} end of crate_utils group */
 
@@ -34,6 +34,8 @@
 #include <stdarg.h>
 #include <unistd.h>
 
+#include "lib/mutex.h"
+#include "lib/time.h"
 
 /**
  * @defgroup crate_utils
@@ -57,6 +59,98 @@ unsigned long long genrand64_int64(void);
 void cr_get_random_string(char *dest, size_t length);
 void cr_time_acc(m0_time_t *t1, m0_time_t t2);
 
+/** Arrival model of the operations of a workload thread. */
+enum cr_arrival {
+	/** The next operation is issued when a previous one completes. */
+	CRA_CLOSED,
+	/** Operations are issued at a fixed rate. */
+	CRA_CONSTANT,
+	/** Inter-arrival times are exponentially distributed. */
+	CRA_POISSON
+};
+
+/**
+ * Schedule of operation start times of a workload thread.
+ *
+ * In the open-loop models the intended start of the next operation does not
+ * depend on the completion of the previous ones: a thread falling behind the
+ * schedule issues operations back to back until it catches up. Latency is
+ * measured from the intended start, so that the time an operation waited
+ * for its turn is not hidden (coordinated omission).
+ */
+struct cr_pace {
+	enum cr_arrival cp_type;
+	/** Operations per second. */
+	uint64_t        cp_rate;
+	/** Intended start of the next operation. */
+	m0_time_t       cp_next;
+};
+
+void cr_pace_init(struct cr_pace *p, enum cr_arrival type, uint64_t rate);
+/**
+ * Sleeps until the intended start of the next operation and returns it. In
+ * the closed-loop model returns 0 without sleeping: latency is then measured
+ * from the launch of the operation.
+ */
+m0_time_t cr_pace_wait(struct cr_pace *p);
+
+enum {
+	/** Significant bits of a recorded value, precision is 1/64. */
+	CR_HIST_SUB_BITS = 7,
+	CR_HIST_HALF     = 1 << (CR_HIST_SUB_BITS - 1),
+	CR_HIST_NR       = (64 - CR_HIST_SUB_BITS + 2) * CR_HIST_HALF
+};
+
+/**
+ * Log-linear histogram of latencies in nanoseconds, in the manner of HDR
+ * histograms: values below 2^CR_HIST_SUB_BITS are counted exactly, larger
+ * ones are counted in buckets of CR_HIST_HALF sub-buckets per power of two.
+ */
+struct cr_hist {
+	uint64_t  ch_bucket[CR_HIST_NR];
+	uint64_t  ch_nr;
+	m0_time_t ch_max;
+};
+
+void cr_hist_record(struct cr_hist *h, m0_time_t val);
+/** Returns the value below which the given fraction of values falls. */
+m0_time_t cr_hist_quantile(const struct cr_hist *h, double q);
+/** Adds the values counted by @src to @dst. */
+void cr_hist_merge(struct cr_hist *dst, const struct cr_hist *src);
+/** Prints a line with the count and quantiles of the histogram. */
+void cr_hist_print(FILE *f, const char *prefix, const char *label,
+		   const struct cr_hist *h);
+
+/**
+ * Latency statistics of an operation type of a workload, shared by its
+ * threads.
+ *
+ * When a period is set, a line with the statistics of every period in which
+ * operations completed is printed to the time series file.
+ */
+struct cr_lat {
+	const char     *cl_label;
+	struct m0_mutex cl_lock;
+	struct cr_hist  cl_total;
+	struct cr_hist  cl_period;
+	m0_time_t       cl_start;
+	m0_time_t       cl_period_len;
+	m0_time_t       cl_period_end;
+	FILE           *cl_ts;
+};
+
+/**
+ * Allocates statistics of @nr operation types. The time series is written to
+ * the file at @ts_path, or to stdout if it is NULL.
+ */
+struct cr_lat *cr_lat_alloc(const char **labels, int nr, m0_time_t period_len,
+			    const char *ts_path);
+void cr_lat_free(struct cr_lat *lat, int nr);
+/** Records an operation intended to start at @start and completed at @end. */
+void cr_lat_record(struct cr_lat *l, m0_time_t start, m0_time_t end);
+/** Prints the total statistics and flushes the last period. */
+void cr_lat_report(struct cr_lat *l);
+
 
 /** @} end of crate_utils group */
 #endif /* __MOTR_M0CRATE_CRATE_UTILS_H__ */
@@ -103,6 +103,28 @@ enum config_key_val {
 	INSERT,
 	LOOKUP,
 	DELETE,
+	ARRIVAL,
+	ARRIVAL_RATE,
+	LATENCY_PERIOD,
+	LATENCY_LOG,
+	MIX_CREATE,
+	MIX_WRITE,
+	MIX_READ,
+	MIX_DELETE,
+	MIX_PUT,
+	MIX_GET,
+	MIX_NEXT,
+	MIX_DEL,
+	MIX_OBJS,
+	MIX_SIZE_DIST,
+	MIX_SIZE_MIN,
+	MIX_SIZE_MAX,
+	MIX_OBJ_SIZE,
+	MIX_INDEX_FID,
+	MIX_KEYS,
+	MIX_VALUE_SIZE,
+	REPLAY_FILE,
+	REPLAY_SPEED,
 };
 
 struct key_lookup_table {
@@ -171,7 +193,29 @@ struct key_lookup_table lookuptable[] = {
 	{"PATTERN", PATTERN},
 	{"INSERT", INSERT},
 	{"LOOKUP", LOOKUP},
-	{"DELETE", DELETE}
+	{"DELETE", DELETE},
+	{"ARRIVAL", ARRIVAL},
+	{"ARRIVAL_RATE", ARRIVAL_RATE},
+	{"LATENCY_PERIOD", LATENCY_PERIOD},
+	{"LATENCY_LOG", LATENCY_LOG},
+	{"MIX_CREATE", MIX_CREATE},
+	{"MIX_WRITE", MIX_WRITE},
+	{"MIX_READ", MIX_READ},
+	{"MIX_DELETE", MIX_DELETE},
+	{"MIX_PUT", MIX_PUT},
+	{"MIX_GET", MIX_GET},
+	{"MIX_NEXT", MIX_NEXT},
+	{"MIX_DEL", MIX_DEL},
+	{"MIX_OBJS", MIX_OBJS},
+	{"MIX_SIZE_DIST", MIX_SIZE_DIST},
+	{"MIX_SIZE_MIN", MIX_SIZE_MIN},
+	{"MIX_SIZE_MAX", MIX_SIZE_MAX},
+	{"MIX_OBJ_SIZE", MIX_OBJ_SIZE},
+	{"MIX_INDEX_FID", MIX_INDEX_FID},
+	{"MIX_KEYS", MIX_KEYS},
+	{"MIX_VALUE_SIZE", MIX_VALUE_SIZE},
+	{"REPLAY_FILE", REPLAY_FILE},
+	{"REPLAY_SPEED", REPLAY_SPEED}
 };
 
 #define NKEYS (sizeof(lookuptable)/sizeof(struct key_lookup_table))
@@ -250,9 +294,13 @@ static int parse_int(const char *value, enum config_key_val tag)
 #define SIZEOF_CWIDX sizeof(struct m0_workload_index)
 #define SIZEOF_CWIO sizeof(struct m0_workload_io)
 #define SIZEOF_CWBTREE sizeof(struct cr_workload_btree)
+#define SIZEOF_CWMIX sizeof(struct m0_workload_mix)
+#define SIZEOF_CWREPLAY sizeof(struct m0_workload_replay)
 
 #define workload_index(t) (t->u.cw_index)
 #define workload_io(t) (t->u.cw_io)
+#define workload_mix(t) (t->u.cw_mix)
+#define workload_replay(t) (t->u.cw_replay)
 #define workload_btree(t) (t->u.cw_btree)
 
 const char conf_section_name[] = "MOTR_CONFIG";
@@ -266,6 +314,8 @@ int copy_value(struct workload *load, int max_workload, int *index,
 	struct m0_workload_io    *cw;
 	struct m0_workload_index *ciw;
 	struct cr_workload_btree *cbw;
+	struct m0_workload_mix   *cwm;
+	struct m0_workload_replay *cwr;
 	int			 *key_size;
 	int			 *val_size;
 
@@ -373,6 +423,16 @@ int copy_value(struct workload *load, int max_workload, int *index,
 				w->u.cw_io = m0_alloc(SIZEOF_CWIO);
 				if (w->u.cw_io == NULL)
 					return -ENOMEM;
+			} else if (atoi(value) == OT_MIX) {
+				w->cw_type = CWT_MIX;
+				w->u.cw_mix = m0_alloc(SIZEOF_CWMIX);
+				if (w->u.cw_mix == NULL)
+					return -ENOMEM;
+			} else if (atoi(value) == OT_REPLAY) {
+				w->cw_type = CWT_REPLAY;
+				w->u.cw_replay = m0_alloc(SIZEOF_CWREPLAY);
+				if (w->u.cw_replay == NULL)
+					return -ENOMEM;
 			} else {
 				w->cw_type = CWT_BTREE;
 				w->u.cw_btree = m0_alloc(SIZEOF_CWBTREE);
@@ -382,7 +442,7 @@ int copy_value(struct workload *load, int max_workload, int *index,
                         return workload_init(w, w->cw_type);
 		case SEED:
 			w = &load[*index];
-			if (w->cw_type == CWT_IO || w->cw_type == CWT_BTREE) {
+			if (w->cw_type != CWT_INDEX) {
 				if (strcmp(value, "tstamp"))
 					w->cw_rstate = atoi(value);
 			} else {
@@ -694,6 +754,113 @@ int copy_value(struct workload *load, int max_workload, int *index,
 			cbw->cwb_bo[BOT_DELETE].prcnt = parse_int(value,
 								  DELETE);
 			break;
+		case ARRIVAL:
+			w = &load[*index];
+			if (!strcmp(value, "closed"))
+				w->cw_arrival = CRA_CLOSED;
+			else if (!strcmp(value, "constant"))
+				w->cw_arrival = CRA_CONSTANT;
+			else if (!strcmp(value, "poisson"))
+				w->cw_arrival = CRA_POISSON;
+			else
+				parser_emit_error("Unknown arrival model: "
+						  "'%s'", value);
+			break;
+		case ARRIVAL_RATE:
+			w = &load[*index];
+			w->cw_arrival_rate = parse_int_with_units(value,
+								  ARRIVAL_RATE);
+			break;
+		case LATENCY_PERIOD:
+			w = &load[*index];
+			w->cw_lat_period = m0_time(parse_int(value,
+							     LATENCY_PERIOD),
+						   0);
+			break;
+		case LATENCY_LOG:
+			w = &load[*index];
+			w->cw_lat_log = m0_alloc(value_len + 1);
+			if (w->cw_lat_log == NULL)
+				return -ENOMEM;
+			strcpy(w->cw_lat_log, value);
+			break;
+		case MIX_CREATE:
+		case MIX_WRITE:
+		case MIX_READ:
+		case MIX_DELETE:
+		case MIX_PUT:
+		case MIX_GET:
+		case MIX_NEXT:
+		case MIX_DEL:
+			M0_CASSERT(MIX_DEL - MIX_CREATE == CMO_DEL - CMO_CREATE);
+			w = &load[*index];
+			cwm = workload_mix(w);
+			cwm->cwm_weight[get_index_from_key(key) - MIX_CREATE] =
+				parse_int(value, get_index_from_key(key));
+			break;
+		case MIX_OBJS:
+			w = &load[*index];
+			cwm = workload_mix(w);
+			cwm->cwm_nr_objs = parse_int(value, MIX_OBJS);
+			break;
+		case MIX_SIZE_DIST:
+			w = &load[*index];
+			cwm = workload_mix(w);
+			if (!strcmp(value, "fixed"))
+				cwm->cwm_size_dist = CSD_FIXED;
+			else if (!strcmp(value, "uniform"))
+				cwm->cwm_size_dist = CSD_UNIFORM;
+			else if (!strcmp(value, "log"))
+				cwm->cwm_size_dist = CSD_LOG;
+			else
+				parser_emit_error("Unknown size distribution: "
+						  "'%s'", value);
+			break;
+		case MIX_SIZE_MIN:
+			w = &load[*index];
+			cwm = workload_mix(w);
+			cwm->cwm_size_min = getnum(value, "mix size min");
+			break;
+		case MIX_SIZE_MAX:
+			w = &load[*index];
+			cwm = workload_mix(w);
+			cwm->cwm_size_max = getnum(value, "mix size max");
+			break;
+		case MIX_OBJ_SIZE:
+			w = &load[*index];
+			cwm = workload_mix(w);
+			cwm->cwm_obj_size = getnum(value, "mix object size");
+			break;
+		case MIX_INDEX_FID:
+			w = &load[*index];
+			cwm = workload_mix(w);
+			if (0 != m0_fid_sscanf(value, &cwm->cwm_index_fid))
+				parser_emit_error("Unable to parse fid: %s",
+						  value);
+			break;
+		case MIX_KEYS:
+			w = &load[*index];
+			cwm = workload_mix(w);
+			cwm->cwm_nr_keys = parse_int(value, MIX_KEYS);
+			break;
+		case MIX_VALUE_SIZE:
+			w = &load[*index];
+			cwm = workload_mix(w);
+			cwm->cwm_value_size = parse_int(value, MIX_VALUE_SIZE);
+			break;
+		case REPLAY_FILE:
+			w = &load[*index];
+			cwr = workload_replay(w);
+			cwr->cwr_file = m0_alloc(value_len + 1);
+			if (cwr->cwr_file == NULL)
+				return -ENOMEM;
+			strcpy(cwr->cwr_file, value);
+			break;
+		case REPLAY_SPEED:
+			w = &load[*index];
+			cwr = workload_replay(w);
+			cwr->cwr_speed = parse_int(value, REPLAY_SPEED);
+			break;
 		default:
 			break;
 	}
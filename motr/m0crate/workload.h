@@ -59,6 +59,8 @@ enum cr_workload_type {
 	CWT_IO,
 	CWT_INDEX,
 	CWT_BTREE,  /* Btree Operations */
+	CWT_MIX,    /* weighted mix of object and index operations */
+	CWT_REPLAY, /* replay of a trace of operations */
         CWT_NR
 };
 
@@ -96,11 +98,21 @@ struct workload {
 	short                  cw_read_frac;
         struct timeval         cw_rate;
         pthread_mutex_t        cw_lock;
+	/** Arrival model of operations of each thread. */
+	enum cr_arrival        cw_arrival;
+	/** Operations per second of each thread in open-loop models. */
+	unsigned               cw_arrival_rate;
+	/** Period of the latency time series, 0 if disabled. */
+	m0_time_t              cw_lat_period;
+	/** Time series file, stdout if not set. */
+	char                  *cw_lat_log;
 
         union {
 		void *cw_io;
 		void *cw_index;
 		void *cw_btree;
+		void *cw_mix;
+		void *cw_replay;
                 struct cr_hpcs {
                 } cw_hpcs;
                 struct cr_csum {
@@ -224,6 +224,46 @@ static void log_fids(struct m0_fid_arr *fids, struct m0_bufvec *vals)
 			m0_console_printf(FID_F"\n", FID_P(&fids->af_elems[i]));
 }
 
+static int bulk_exec(struct index_cmd *cmd)
+{
+	FILE *keys;
+	FILE *vals;
+	int   rc;
+
+	keys = fopen(cmd->ic_filename, cmd->ic_cmd == DUMP ? "w" : "r");
+	if (keys == NULL)
+		return M0_ERR(-errno);
+	vals = fopen(cmd->ic_vfilename, cmd->ic_cmd == BPUT ? "r" : "w");
+	if (vals == NULL) {
+		rc = M0_ERR(-errno);
+		fclose(keys);
+		return rc;
+	}
+	switch (cmd->ic_cmd) {
+	case BPUT:
+		rc = index_bulk_put(&cc_ctx.cc_parent.co_realm,
+				    &cmd->ic_fids.af_elems[0], keys, vals,
+				    cmd->ic_cnt, cmd->ic_depth);
+		break;
+	case BGET:
+		rc = index_bulk_get(&cc_ctx.cc_parent.co_realm,
+				    &cmd->ic_fids.af_elems[0], keys, vals,
+				    cmd->ic_cnt, cmd->ic_depth);
+		break;
+	case DUMP:
+		rc = index_dump(&cc_ctx.cc_parent.co_realm,
+				&cmd->ic_fids.af_elems[0], keys, vals,
+				cmd->ic_cnt, cmd->ic_depth);
+		break;
+	default:
+		M0_IMPOSSIBLE("Wrong command");
+	}
+	if (fclose(vals) != 0 && rc == 0)
+		rc = M0_ERR(-errno);
+	fclose(keys);
+	return rc;
+}
+
 static int cmd_exec(struct index_cmd *cmd)
 {
 	int rc;
@@ -298,6 +338,18 @@ static int cmd_exec(struct index_cmd *cmd)
 	case WLF:
 		rc = wait_file(cmd->ic_filename);
 		break;
+	case BPUT:
+		rc = bulk_exec(cmd);
+		m0_console_printf("bulkput done, rc: %i\n", rc);
+		break;
+	case BGET:
+		rc = bulk_exec(cmd);
+		m0_console_printf("bulkget done, rc: %i\n", rc);
+		break;
+	case DUMP:
+		rc = bulk_exec(cmd);
+		m0_console_printf("dump done, rc: %i\n", rc);
+		break;
 	default:
 		rc = M0_ERR(-EINVAL);
 		M0_ASSERT(0);
@@ -45,6 +45,9 @@ enum {
 	GENF, /* Generate FID-file. */
 	GENV, /* Generate VAL-file. */
 	WLF,  /* Wait for a file to appear. */
+	BPUT, /* Put records from files, pipelined. */
+	BGET, /* Get values of keys from a file, pipelined. */
+	DUMP, /* Dump records into files, parallel. */
 };
 
 enum {
@@ -60,6 +63,10 @@ struct index_cmd {
 	int               ic_cnt;
 	int               ic_len;
 	char             *ic_filename;
+	/** Values file of bulk commands, ic_filename is the keys file. */
+	char             *ic_vfilename;
+	/** Operations (threads for DUMP) in flight of bulk commands. */
+	int               ic_depth;
 };
 
 struct index_ctx
@@ -29,11 +29,14 @@
 
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_CLIENT
 #include "lib/assert.h"             /* M0_ASSERT */
+#include "lib/arith.h"              /* min32, max64u */
 #include "lib/memory.h"             /* M0_ALLOC_ARR */
 #include "lib/time.h"               /* M0_TIME_NEVER */
 #include "lib/errno.h"
 #include "lib/trace.h"              /* M0_ERR */
+#include "lib/thread.h"             /* M0_THREAD_INIT */
 #include "index_op.h"
+#include "index_parser.h"           /* index_parser_vals_read */
 #include "motr/client.h"
 #include "motr/idx.h"
 #include "index.h"
@@ -395,6 +398,352 @@ fail:
 	return M0_ERR(rc);
 }
 
+/** An operation of a bulk command and its records. */
+struct bulk_slot {
+	struct m0_op     *bs_op;
+	struct m0_bufvec  bs_keys;
+	struct m0_bufvec  bs_vals;
+	int32_t          *bs_rcs;
+};
+
+static void bulk_slot_fini(struct bulk_slot *slot)
+{
+	if (slot->bs_op != NULL) {
+		m0_op_fini(slot->bs_op);
+		m0_op_free(slot->bs_op);
+		slot->bs_op = NULL;
+	}
+	m0_bufvec_free(&slot->bs_keys);
+	m0_bufvec_free(&slot->bs_vals);
+	m0_free0(&slot->bs_rcs);
+}
+
+/**
+ * Reads the next batch of records and launches its operation. Returns the
+ * number of records, 0 at the end of the keys file.
+ */
+static int bulk_slot_launch(struct bulk_slot *slot, struct m0_idx *idx,
+			    enum m0_idx_opcode opcode,
+			    FILE *keys, FILE *vals, int batch)
+{
+	int nr;
+	int rc;
+
+	M0_SET0(slot);
+	M0_ALLOC_ARR(slot->bs_rcs, batch);
+	if (slot->bs_rcs == NULL)
+		return M0_ERR(-ENOMEM);
+	rc = m0_bufvec_empty_alloc(&slot->bs_keys, batch) ?:
+	     m0_bufvec_empty_alloc(&slot->bs_vals, batch);
+	if (rc != 0)
+		goto err;
+	nr = rc = index_parser_vals_read(keys, &slot->bs_keys, batch);
+	if (rc > 0 && opcode == M0_IC_PUT) {
+		rc = index_parser_vals_read(vals, &slot->bs_vals, nr);
+		if (rc >= 0 && rc != nr)
+			/* Fewer values than keys. */
+			rc = M0_ERR(-EPROTO);
+	}
+	if (rc <= 0)
+		goto err;
+	slot->bs_keys.ov_vec.v_nr = nr;
+	slot->bs_vals.ov_vec.v_nr = nr;
+	rc = m0_idx_op(idx, opcode, &slot->bs_keys, &slot->bs_vals,
+		       slot->bs_rcs,
+		       opcode == M0_IC_PUT ? M0_OIF_OVERWRITE : 0,
+		       &slot->bs_op);
+	if (rc != 0)
+		goto err;
+	set_idx_flags(slot->bs_op);
+	m0_op_launch(&slot->bs_op, 1);
+	return nr;
+err:
+	bulk_slot_fini(slot);
+	return M0_RC(rc);
+}
+
+static int bulk_slot_complete(struct bulk_slot *slot,
+			      enum m0_idx_opcode opcode, FILE *vals)
+{
+	int nr = slot->bs_keys.ov_vec.v_nr;
+	int rc;
+	int i;
+
+	rc = m0_op_wait(slot->bs_op, M0_BITS(M0_OS_FAILED, M0_OS_STABLE),
+			M0_TIME_NEVER) ?: slot->bs_op->op_rc ?:
+	     per_item_rcs_analyse(slot->bs_rcs, nr);
+	for (i = 0; rc == 0 && opcode == M0_IC_GET && i < nr; ++i)
+		rc = index_parser_val_write(vals, slot->bs_vals.ov_buf[i],
+					    slot->bs_vals.ov_vec.v_count[i]);
+	bulk_slot_fini(slot);
+	return M0_RC(rc);
+}
+
+/**
+ * Streams records from the files keeping up to depth operations of batch
+ * records in flight. Operations are completed in order, so that values of
+ * GET are written in the order of the keys.
+ */
+static int index_bulk(struct m0_realm    *parent,
+		      struct m0_fid      *fid,
+		      enum m0_idx_opcode  opcode,
+		      FILE               *keys,
+		      FILE               *vals,
+		      int                 batch,
+		      int                 depth)
+{
+	struct m0_idx     idx = {{0}};
+	struct bulk_slot *slots;
+	m0_time_t         start = m0_time_now();
+	uint64_t          total = 0;
+	int               launched = 0;
+	int               done = 0;
+	int               rc;
+	int               rc1;
+
+	M0_PRE(batch > 0 && depth > 0);
+
+	m0_fid_tassume(fid, &m0_dix_fid_type);
+	m0_idx_init(&idx, parent, (struct m0_uint128 *)fid);
+	rc = validate_pool_version(&idx);
+	if (rc != 0)
+		goto out;
+	M0_ALLOC_ARR(slots, depth);
+	if (slots == NULL) {
+		rc = M0_ERR(-ENOMEM);
+		goto out;
+	}
+	while (1) {
+		/* Keep the pipeline full. */
+		while (rc == 0 && launched - done < depth) {
+			rc = bulk_slot_launch(&slots[launched % depth], &idx,
+					      opcode, keys, vals, batch);
+			if (rc <= 0)
+				break;
+			total += rc;
+			launched++;
+			rc = 0;
+		}
+		if (done == launched)
+			break;
+		rc1 = bulk_slot_complete(&slots[done++ % depth], opcode, vals);
+		rc = rc ?: rc1;
+	}
+	m0_free(slots);
+	m0_console_printf("%"PRIu64" records, %"PRIu64" records/sec\n", total,
+			  total * M0_TIME_ONE_SECOND /
+			  max64u(m0_time_now() - start, 1));
+out:
+	m0_entity_fini(&idx.in_entity);
+	return M0_RC(rc);
+}
+
+int index_bulk_put(struct m0_realm *parent,
+		   struct m0_fid   *fid,
+		   FILE            *keys,
+		   FILE            *vals,
+		   int              batch,
+		   int              depth)
+{
+	return index_bulk(parent, fid, M0_IC_PUT, keys, vals, batch, depth);
+}
+
+int index_bulk_get(struct m0_realm *parent,
+		   struct m0_fid   *fid,
+		   FILE            *keys,
+		   FILE            *vals,
+		   int              batch,
+		   int              depth)
+{
+	return index_bulk(parent, fid, M0_IC_GET, keys, vals, batch, depth);
+}
+
+/**
+ * A dump thread. NEXT operations of a thread go through the keys starting
+ * with bytes in [dr_lo, dr_hi).
+ */
+struct dump_range {
+	struct m0_thread  dr_thread;
+	struct m0_realm  *dr_parent;
+	struct m0_fid     dr_fid;
+	unsigned          dr_lo;
+	unsigned          dr_hi;
+	int               dr_batch;
+	FILE             *dr_keys;
+	FILE             *dr_vals;
+	uint64_t          dr_nr;
+	int               dr_rc;
+};
+
+/** Writes the records returned by NEXT, returns true at the range end. */
+static bool dump_records(struct dump_range *dr, struct m0_bufvec *keys,
+			 struct m0_bufvec *vals, int32_t *rcs)
+{
+	int i;
+
+	for (i = 0; i < dr->dr_batch; ++i) {
+		if (rcs[i] != 0 || keys->ov_buf[i] == NULL ||
+		    (dr->dr_hi <= UINT8_MAX && keys->ov_vec.v_count[i] > 0 &&
+		     *(uint8_t *)keys->ov_buf[i] >= dr->dr_hi))
+			return true;
+		dr->dr_rc = index_parser_val_write(dr->dr_keys,
+						   keys->ov_buf[i],
+						   keys->ov_vec.v_count[i]) ?:
+			    index_parser_val_write(dr->dr_vals,
+						   vals->ov_buf[i],
+						   vals->ov_vec.v_count[i]);
+		if (dr->dr_rc != 0)
+			return true;
+		dr->dr_nr++;
+	}
+	return false;
+}
+
+static void dump_thread(struct dump_range *dr)
+{
+	struct m0_idx     idx = {{0}};
+	struct m0_op     *op;
+	struct m0_bufvec  keys;
+	struct m0_bufvec  vals;
+	int32_t          *rcs;
+	uint8_t           lo = dr->dr_lo;
+	void             *start;
+	m0_bcount_t       start_nob = sizeof lo;
+	uint32_t          flags = 0;
+	bool              end = false;
+	int               rc;
+
+	M0_ALLOC_ARR(rcs, dr->dr_batch);
+	start = m0_alloc(start_nob);
+	if (rcs == NULL || start == NULL) {
+		m0_free(rcs);
+		m0_free(start);
+		dr->dr_rc = M0_ERR(-ENOMEM);
+		return;
+	}
+	memcpy(start, &lo, start_nob);
+	m0_fid_tassume(&dr->dr_fid, &m0_dix_fid_type);
+	m0_idx_init(&idx, dr->dr_parent, (struct m0_uint128 *)&dr->dr_fid);
+	rc = validate_pool_version(&idx);
+	while (rc == 0 && !end) {
+		op = NULL;
+		rc = m0_bufvec_empty_alloc(&keys, dr->dr_batch) ?:
+		     m0_bufvec_empty_alloc(&vals, dr->dr_batch);
+		if (rc != 0)
+			break;
+		/* The keys vector owns the start key now. */
+		keys.ov_buf[0] = start;
+		keys.ov_vec.v_count[0] = start_nob;
+		start = NULL;
+		rc = m0_idx_op(&idx, M0_IC_NEXT, &keys, &vals, rcs, flags,
+			       &op);
+		if (rc == 0) {
+			set_idx_flags(op);
+			m0_op_launch(&op, 1);
+			rc = m0_op_wait(op, M0_BITS(M0_OS_FAILED,
+						    M0_OS_STABLE),
+					M0_TIME_NEVER) ?: op->op_rc;
+		}
+		if (rc == 0) {
+			end = dump_records(dr, &keys, &vals, rcs);
+			rc = dr->dr_rc;
+		}
+		if (rc == 0 && !end) {
+			/* Continue after the last key of the batch. */
+			start_nob = keys.ov_vec.v_count[dr->dr_batch - 1];
+			start = m0_alloc(start_nob);
+			if (start == NULL)
+				rc = M0_ERR(-ENOMEM);
+			else
+				memcpy(start,
+				       keys.ov_buf[dr->dr_batch - 1],
+				       start_nob);
+			flags = M0_OIF_EXCLUDE_START_KEY;
+		}
+		if (op != NULL) {
+			m0_op_fini(op);
+			m0_op_free(op);
+		}
+		m0_bufvec_free(&keys);
+		m0_bufvec_free(&vals);
+	}
+	m0_entity_fini(&idx.in_entity);
+	m0_free(start);
+	m0_free(rcs);
+	dr->dr_rc = rc;
+}
+
+static int file_append(FILE *dst, FILE *src)
+{
+	char   buf[4096];
+	size_t nob;
+
+	rewind(src);
+	while ((nob = fread(buf, 1, sizeof buf, src)) > 0) {
+		if (fwrite(buf, 1, nob, dst) != nob)
+			return M0_ERR(-EIO);
+	}
+	return ferror(src) ? M0_ERR(-EIO) : 0;
+}
+
+int index_dump(struct m0_realm *parent,
+	       struct m0_fid   *fid,
+	       FILE            *keys,
+	       FILE            *vals,
+	       int              batch,
+	       int              nr_threads)
+{
+	struct dump_range *dr;
+	m0_time_t          start = m0_time_now();
+	uint64_t           total = 0;
+	int                rc = 0;
+	int                i;
+
+	M0_PRE(batch > 0 && nr_threads > 0);
+
+	/* Ranges are split by the first byte of the key. */
+	nr_threads = min32(nr_threads, UINT8_MAX + 1);
+	M0_ALLOC_ARR(dr, nr_threads);
+	if (dr == NULL)
+		return M0_ERR(-ENOMEM);
+	for (i = 0; i < nr_threads; ++i) {
+		dr[i] = (struct dump_range) {
+			.dr_parent = parent,
+			.dr_fid    = *fid,
+			.dr_lo     = (UINT8_MAX + 1) * i / nr_threads,
+			.dr_hi     = (UINT8_MAX + 1) * (i + 1) / nr_threads,
+			.dr_batch  = batch,
+			.dr_keys   = tmpfile(),
+			.dr_vals   = tmpfile()
+		};
+		dr[i].dr_rc = dr[i].dr_keys == NULL || dr[i].dr_vals == NULL ?
+			      M0_ERR(-errno) :
+			      M0_THREAD_INIT(&dr[i].dr_thread,
+					     struct dump_range *, NULL,
+					     &dump_thread, &dr[i],
+					     "m0kv_dump%d", i);
+	}
+	for (i = 0; i < nr_threads; ++i) {
+		if (dr[i].dr_thread.t_func != NULL) {
+			m0_thread_join(&dr[i].dr_thread);
+			m0_thread_fini(&dr[i].dr_thread);
+		}
+		/* The ranges are sorted, so is the dump. */
+		rc = rc ?: dr[i].dr_rc ?:
+		     file_append(keys, dr[i].dr_keys) ?:
+		     file_append(vals, dr[i].dr_vals);
+		total += dr[i].dr_nr;
+		if (dr[i].dr_keys != NULL)
+			fclose(dr[i].dr_keys);
+		if (dr[i].dr_vals != NULL)
+			fclose(dr[i].dr_vals);
+	}
+	m0_free(dr);
+	m0_console_printf("%"PRIu64" records, %"PRIu64" records/sec\n", total,
+			  total * M0_TIME_ONE_SECOND /
+			  max64u(m0_time_now() - start, 1));
+	return M0_RC(rc);
+}
 
 #undef M0_TRACE_SUBSYSTEM
 
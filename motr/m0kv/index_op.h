@@ -31,6 +31,8 @@
  *
  * @{
  */
+#include <stdio.h>                  /* FILE */
+
 struct m0_realm;
 struct m0_fid_arr;
 struct m0_fid;
@@ -61,6 +63,37 @@ int index_next(struct m0_realm  *parent,
 	       struct m0_fid    *fid,
 	       struct m0_bufvec *keys, int cnt,
 	       struct m0_bufvec *vals);
+/**
+ * Puts records from the keys and values files (genv format), with up to
+ * depth PUT operations of batch records in flight.
+ */
+int index_bulk_put(struct m0_realm *parent,
+		   struct m0_fid   *fid,
+		   FILE            *keys,
+		   FILE            *vals,
+		   int              batch,
+		   int              depth);
+/**
+ * Gets values of the keys from the keys file, with up to depth GET
+ * operations in flight, and writes them to the values file in key order.
+ */
+int index_bulk_get(struct m0_realm *parent,
+		   struct m0_fid   *fid,
+		   FILE            *keys,
+		   FILE            *vals,
+		   int              batch,
+		   int              depth);
+/**
+ * Dumps all records of the index into the files, sorted by key. The key
+ * space is split by the first key byte into nr_threads ranges, each of which
+ * is iterated by its own thread with NEXT operations of batch records.
+ */
+int index_dump(struct m0_realm *parent,
+	       struct m0_fid   *fid,
+	       FILE            *keys,
+	       FILE            *vals,
+	       int              batch,
+	       int              nr_threads);
 
 /** @} end of client group */
 #endif /* __MOTR_M0INDEX_OP_H__ */
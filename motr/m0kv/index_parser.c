@@ -62,6 +62,13 @@ static const struct command_descr commands[] = {
 	{ GENV, "genv",   "genv CNT SIZE FILE, generate file with several "
 			  "KEY_PARAM/VAL_PARAM. Note: SIZE > 16" },
 	{ WLF,  "wait",   "wait FILE, await a file to appear" },
+	{ BPUT, "bulkput", "bulkput FID KFILE VFILE BATCH DEPTH, put records "
+			   "from files, DEPTH operations of BATCH records in "
+			   "flight" },
+	{ BGET, "bulkget", "bulkget FID KFILE VFILE BATCH DEPTH, get values "
+			   "of keys from KFILE into VFILE" },
+	{ DUMP, "dump",    "dump FID KFILE VFILE BATCH THREADS, dump records "
+			   "into files by THREADS parallel NEXT streams" },
 };
 
 static int command_id(const char *name)
@@ -227,6 +234,42 @@ static int vals_load(const char *value, struct m0_bufvec *vals)
 	return rc;
 }
 
+int index_parser_vals_read(FILE *f, struct m0_bufvec *vals, int nr)
+{
+	char *buf;
+	int   size;
+	int   rc = 0;
+	int   i;
+
+	M0_PRE(nr <= vals->ov_vec.v_nr);
+
+	for (i = 0; rc == 0 && i < nr &&
+		    (rc = item_load(f, &buf, &size)) == 0; ++i) {
+		vals->ov_buf[i] = m0_alloc(size);
+		rc = vals->ov_buf[i] == NULL ? M0_ERR(-ENOMEM) :
+		     vals_xcode(buf, vals->ov_buf[i],
+				&vals->ov_vec.v_count[i]);
+		m0_free(buf);
+	}
+	/* item_load() returns 1 at the end of the file. */
+	return rc < 0 ? rc : i;
+}
+
+int index_parser_val_write(FILE *f, const void *buf, m0_bcount_t size)
+{
+	const unsigned char *b = buf;
+	m0_bcount_t          i;
+	char                 head[24];
+	int                  len;
+
+	/* The format of genv: "<text length> [0x<size>:0x01,...,0x05]". */
+	len = sprintf(head, "[0x%x:", (unsigned)size);
+	fprintf(f, "%d %s", len + (int)size * 5, head);
+	for (i = 0; i < size; ++i)
+		fprintf(f, "0x%02x%c", b[i], i + 1 < size ? ',' : ']');
+	return fputc('\n', f) == EOF ? M0_ERR(-EIO) : 0;
+}
+
 static int command_assign(struct index_cmd *cmd, int *argc, char ***argv)
 {
 	char ***params;
@@ -368,6 +411,27 @@ static int command_assign(struct index_cmd *cmd, int *argc, char ***argv)
 		++*params;
 		--*argc;
 		break;
+	case BPUT:
+	case BGET:
+	case DUMP:
+		if (*argc < 5)
+			return M0_ERR(-EINVAL);
+		if (**params[0]=='@')
+			return M0_ERR(-EINVAL);
+		rc = fids_load(**params, &cmd->ic_fids);
+		if (rc < 0)
+			return M0_ERR(rc);
+		++*params;
+		cmd->ic_filename = **params;
+		++*params;
+		cmd->ic_vfilename = **params;
+		++*params;
+		cmd->ic_cnt = strtol(**params, (char **)(NULL), 10);
+		++*params;
+		cmd->ic_depth = strtol(**params, (char **)(NULL), 10);
+		++*params;
+		*argc -= 5;
+		break;
 	default:
 		M0_IMPOSSIBLE("Wrong command");
 	}
@@ -418,6 +482,14 @@ static bool command_is_valid(struct index_cmd *cmd)
 	case WLF:
 		rc = cmd->ic_filename != NULL;
 		break;
+	case BPUT:
+	case BGET:
+	case DUMP:
+		rc = cmd->ic_fids.af_count == 1 &&
+		     cmd->ic_filename != NULL &&
+		     cmd->ic_vfilename != NULL &&
+		     cmd->ic_cnt > 0 && cmd->ic_depth > 0;
+		break;
 	default:
 		M0_IMPOSSIBLE("Wrong command.");
 	}
@@ -479,6 +551,14 @@ void index_parser_print_command_help(void)
 		"\t\t>m0kv [common args] index next \"1:5\" "
 		"'[0x02:0x01,0x02]' 3 \n"
 		"\t\t>m0kv [common args] index next \"1:5\" \"0\" 3 -s \n"
+		"\t\t>m0kv [common args] index bulkput \"1:5\" keys.txt "
+		"vals.txt 100 16 \n"
+		"\t\t>m0kv [common args] index bulkget \"1:5\" keys.txt "
+		"out.txt 100 16 \n"
+		"\t\t>m0kv [common args] index dump \"1:5\" dkeys.txt "
+		"dvals.txt 100 8 \n"
+		"\t\tNote: A dump can be loaded with bulkput; it is sorted by "
+		"key.\n"
 		"\tPossible to supply multiple commands on command line e.g.:\n"
 		"\t\t>m0kv [common args] index create \"1:5\" put \"1:5\""
 		" \"[0x02:0x01,0x02]\" \"[0x09:0x01,0x02,0x03,0x04,0x05,0x06,"
@@ -25,8 +25,12 @@
 #ifndef __MOTR_M0INDEX_PARSER_H__
 #define __MOTR_M0INDEX_PARSER_H__
 
+#include <stdio.h>               /* FILE */
+#include "lib/types.h"           /* m0_bcount_t */
+
 /* Import */
 struct index_ctx;
+struct m0_bufvec;
 
 /**
  * @defgroup client
@@ -36,6 +40,16 @@ struct index_ctx;
 int index_parser_args_process(struct index_ctx *ctx, int argc, char** argv);
 void index_parser_print_command_help(void);
 
+/**
+ * Reads up to nr records in the genv file format into the empty buffers of
+ * vals, starting from the first one. Returns the number of records read, 0
+ * at the end of the file.
+ */
+int index_parser_vals_read(FILE *f, struct m0_bufvec *vals, int nr);
+
+/** Writes a record in the genv file format. */
+int index_parser_val_write(FILE *f, const void *buf, m0_bcount_t size);
+
 /** @} end of client group */
 #endif /* __MOTR_M0INDEX_PARSER_H__ */
 
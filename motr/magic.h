@@ -407,6 +407,12 @@ enum m0_magic_satchel {
 	/* rpc_tl::td_head_magic (delible diazo) */
 	M0_DESIM_NET_RPC_HEAD_MAGIC = 0x33de11b1ed1a2077,
 
+	/* reqh_fom::fo_magic (a face of dice) */
+	M0_DESIM_REQH_FOM_MAGIC = 0x33aface0fd1ce577,
+
+	/* fom_tl::td_head_magic (coalesced lab) */
+	M0_DESIM_REQH_FOM_HEAD_MAGIC = 0x33c0a1e5ced1ab77,
+
 	/* sim_callout::sc_magic (escalade fall) */
 	M0_DESIM_SIM_CALLOUT_MAGIC = 0x33e5ca1adefa1177,
 
@@ -470,6 +476,12 @@ enum m0_magic_satchel {
 	/* thr_tl::td_head_magic (declassified) */
 	M0_FOM_THREAD_HEAD_MAGIC = 0x33dec1a551f1ed77,
 
+	/* m0_fom_stack::fs_magix (alfalfa coddle) */
+	M0_FOM_STACK_MAGIC = 0x33a1fa1fac0dd177,
+
+	/* m0_fom_locality::fl_stacks::td_head_magic (sea-faded cab) */
+	M0_FOM_STACK_HEAD_MAGIC = 0x335eafadedcab077,
+
 	/* m0_long_lock_link::lll_magix (idealised ice) */
 	M0_FOM_LL_LINK_MAGIC = 0x331dea115ed1ce77,
 
@@ -705,6 +717,12 @@ enum m0_magic_satchel {
 	/* net/sock.c: buf list head (bad dada decaf) */
 	M0_NET_SOCK_BUF_HEAD_MAGIC = 0x33baddadadecaf77,
 
+	/* net/sock.c: end-point hash element, ep::e_magix (bade fed cable) */
+	M0_NET_SOCK_EP_MAGIC = 0x33badefedcab1e77,
+
+	/* net/sock.c: end-point hash bucket (faded abacas) */
+	M0_NET_SOCK_EP_HEAD_MAGIC = 0x33fadedabaca5e77,
+
 	/* net/libfab.c: buf list element, buf::b_magix (fed ace dedcde) */
 	M0_NET_LIBFAB_BUF_MAGIC = 0x33fedacededcde77,
 
@@ -735,6 +753,24 @@ enum m0_magic_satchel {
 	/* net/libfab.c: fab_bufhash list head (de4e9 baffess) */
 	M0_NET_LIBFAB_BUF_HT_HEAD_MAGIC = 0x33de4e9baffe5577,
 
+	/* net/libfab.c: mr cache hash magic (ace de4e9 fee) */
+	M0_NET_LIBFAB_MR_HT_MAGIC = 0x33acede4e9f0ee77,
+
+	/* net/libfab.c: mr cache hash head (ace de4e9 fed) */
+	M0_NET_LIBFAB_MR_HT_HEAD_MAGIC = 0x33acede4e9f0ed77,
+
+	/* net/libfab.c: mr cache lru, mr_ent::me_lrumagic (1e55 ace baffee) */
+	M0_NET_LIBFAB_MR_LRU_MAGIC = 0x331e55acebaffe77,
+
+	/* net/libfab.c: mr cache lru head (1e55 ace baffed) */
+	M0_NET_LIBFAB_MR_LRU_HEAD_MAGIC = 0x331e55acebaffd77,
+
+	/* net/libfab.c: endpoint hash, ep::fep_htmagic (ace de4e9 bob1) */
+	M0_NET_LIBFAB_EP_HT_MAGIC = 0x33acede4e9b0b177,
+
+	/* net/libfab.c: endpoint hash head (ace de4e9 bod1) */
+	M0_NET_LIBFAB_EP_HT_HEAD_MAGIC = 0x33acede4e9b0d177,
+
 	/* net/net.h: m0_nep list element, endpoint (obsessed loll) */
 	M0_NET_NEP_MAGIC = 0x330b5e55ed101177,
 
@@ -797,6 +833,10 @@ enum m0_magic_satchel {
 /* State Machine */
 	/* m0_sm_conf::scf_magic (falsie zodiac) */
 	M0_SM_CONF_MAGIC = 0x33FA151E20D1AC77,
+	/* m0_sm_timer::tr_magix (classed oddle) */
+	M0_SM_TIMER_MAGIC = 0x33c1a55ed0dd1e77,
+	/* m0_sm_wheel::sw_slot[][] (boatable seed) */
+	M0_SM_WHEEL_MAGIC = 0x33b0a7ab1e5eed77,
 
 /* State machine operation */
 	/* m0_sm_op_exec::oe_op (alas adobe cod) */
@@ -1117,6 +1157,38 @@ enum m0_magic_satchel {
 	M0_RM_MAGIC           = 0x331CE1CE1C0E2277,
 	/* rm_ctx_tl::td_head_magic (coca cola sea) */
 	M0_RM_HEAD_MAGIC      = 0x33C0CAC01A5EA277,
+	/* m0_rm_lock_ctx::rmc_idle_magic (calico sea) */
+	M0_RM_IDLE_MAGIC      = 0x33ca11c05ea02277,
+	/* rm_idle_tl::td_head_magic (decode idle) */
+	M0_RM_IDLE_HEAD_MAGIC = 0x33dec0de1d1e2277,
+	/* dix_cache_rec::dcr_magic (callable face) */
+	M0_DIX_CACHE_MAGIC    = 0x33ca11ab1eface77,
+	/* dix_cache_ht::td_head_magic (facade decade) */
+	M0_DIX_CACHE_HEAD_MAGIC = 0x33facadedecade77,
+	/* dix_cache_rec::dcr_lru_magic (baseball case) */
+	M0_DIX_CACHE_LRU_MAGIC  = 0x33ba5eba11ca5e77,
+	/* dix_cache_lru_tl::td_head_magic (coffee boiled) */
+	M0_DIX_CACHE_LRU_HEAD_MAGIC = 0x33c0ffeeb0a1ed77,
+	/* wbc_block::wb_magic (baseball bead) */
+	M0_WBC_BLOCK_MAGIC    = 0x33ba5eba11bead77,
+	/* m0_obj_wbc::ow_blocks head magic (accessible zoo) */
+	M0_WBC_BLOCK_HEAD_MAGIC = 0x33acce551b1e2077,
+	/* m0_obj_wbc::ow_magic (cabbage fad) */
+	M0_WBC_MAGIC          = 0x33cabba9ef0ad077,
+	/* m0_client::m0c_wbcs head magic (decoded blob) */
+	M0_WBC_HEAD_MAGIC     = 0x33dec0dedb10b077,
+	/* m0_op::op_cq_magic (coded abode) */
+	M0_OP_CQ_MAGIC        = 0x33c0dedab0de0077,
+	/* m0_cq::cq_done head magic (cabbage deed) */
+	M0_OP_CQ_HEAD_MAGIC   = 0x33cabba9edeed077,
+	/* oac_rec::oar_magic (obsessed fable) */
+	M0_OAC_REC_MAGIC      = 0x330b5e55edfab177,
+	/* m0_obj_attr_cache::oac_recs head magic (accessed dodo) */
+	M0_OAC_REC_HEAD_MAGIC = 0x33acce55edd0d077,
+	/* oac_rec::oar_lru_magic (cached bead) */
+	M0_OAC_LRU_MAGIC      = 0x33cac7edbead0077,
+	/* m0_obj_attr_cache::oac_lru head magic (baffled code) */
+	M0_OAC_LRU_HEAD_MAGIC = 0x33baff1edc0de077,
 
 /* module/param */
 	/* m0_param_source::ps_magic (boozed billie) */
@@ -1154,6 +1226,8 @@ enum m0_magic_satchel {
 	M0_DIX_ROP_HEAD_MAGIC  = 0x33ba51c0ff10ad77,
 	/** struct m0_dix_cm::dcm_magic (dixdixdixdix) */
 	M0_DIX_CM_MAGIC        = 0x33d18d18d18d1877,
+	/** m0_dix_ec_hdr::deh_magic (decode a fragment) */
+	M0_DIX_EC_MAGIC        = 0x33dec0deaf1a6e77,
 /* DTM0 */
 	/** m0_bob_type::bt_magix (zodiacal bass) */
 	M0_DTM0_SVC_MAGIC       = 0x3320d1aca1ba5577,
@@ -1170,6 +1244,8 @@ enum m0_magic_satchel {
 
 	/* m0_fol_fdmi_src_ctx::ffsc_magic (fol decade) */
 	M0_FOL_FDMI_SRC_CTX_MAGIC = 0x33f01decade77,
+	/* m0_fol_fdmi_offset::ffo_magic (offloaded cafe) */
+	M0_FOL_FDMI_OFFSET_MAGIC = 0x330ff10adedcafe7,
 
 	/* m0_fdmi_filter_reg::ffr_magic (scaffold feel) */
 	M0_FDMI_FLTR_MAGIC = 0x335caff01dfee177,
@@ -1203,17 +1279,30 @@ enum m0_magic_satchel {
 	M0_FDMI_SRC_DOCK_PENDING_FOP_MAGIC = 0xf1eece0ff1ce,
 	/* pending_fops list head magic (feosol obsess) */
 	M0_FDMI_SRC_DOCK_PENDING_FOP_HEAD_MAGIC = 0xfe05010b5e55,
+	/* fdmi_sd_plugin::sp_magic */
+	M0_FDMI_SRC_DOCK_PLUGIN_MAGIC = 0x33fd01a9f10c4577,
+	/* sd_plugins list head magic */
+	M0_FDMI_SRC_DOCK_PLUGIN_HEAD_MAGIC = 0x33fd01a9f10de477,
 /* DTM0 */
 	/* be/dtm0_log.c::dlr_tlink (be fifo head) */
 	M0_BE_DTM0_LOG_MAGIX = 0x33d73010600077,
 	/* be/dtm0_log.c::dlr_link (dtm0 log rec) */
 	M0_BE_DTM0_LOG_REC_MAGIX = 0x33d73010673c77,
+	/* be/dtm0_log.c::dlr_hlink (volatile dtm0 log hash bucket head) */
+	M0_BE_DTM0_LOG_HT_MAGIX = 0x33d73010a5c077,
+	/* be/dtm0_log.c::dlr_hmagic (volatile dtm0 log rec in hash) */
+	M0_BE_DTM0_LOG_HREC_MAGIX = 0x33d73010a5c177,
 /* BTREE */	
 	/* nd::n_magic (classic idea) */
 	M0_BTREE_ND_LIST_MAGIC = 0x33c1a551c1dea77,
 
 	/* node descriptor list head magic (soleless boss) */
 	M0_BTREE_ND_LIST_HEAD_MAGIC = 0x33501e1e55b05577,
+/* CAS */
+	/* ctg_vol::cv_magic (cascaded flee) */
+	M0_CAS_CTG_VOL_MAGIC = 0x33ca5cadedf1ee77,
+	/* m0_ctg_store::cs_vol bucket head magic (cascades bald) */
+	M0_CAS_CTG_VOL_HEAD_MAGIC = 0x33ca5cade5ba1d77,
 
 };
 
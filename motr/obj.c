@@ -216,6 +216,66 @@ static void obj_namei_cb_cancel(struct m0_op_common *oc)
  * m0_op_common although it has to be allocated as a
  * m0_op_obj.
  */
+static void obj_connected_ast(struct m0_sm_group *grp, struct m0_sm_ast *ast)
+{
+	struct m0_op_obj *oo = M0_AMB(oo, ast, oo_conn_wait.scw_ast);
+	struct m0_op     *op = &oo->oo_oc.oc_op;
+
+	M0_ENTRY("op=%p rc=%d", op, oo->oo_conn_wait.scw_rc);
+	(void)grp;
+	m0_reqh_service_connect_waiter_fini(&oo->oo_conn_wait);
+	/*
+	 * A failed connection doesn't fail the operation here, the fops sent
+	 * to the service fail, as with the services connected at client
+	 * initialisation.
+	 */
+	m0_sm_group_lock(&op->op_sm_group);
+	oo->oo_oc.oc_cb_launch(&oo->oo_oc);
+	m0_sm_group_unlock(&op->op_sm_group);
+	M0_LEAVE();
+}
+
+M0_INTERNAL bool m0__obj_connect_wait(struct m0_op_obj *oo)
+{
+	struct m0_client                      *m0c = m0__oo_instance(oo);
+	struct m0_pools_common                *pc  = &m0c->m0c_pools_common;
+	struct m0_reqh_service_connect_waiter *w   = &oo->oo_conn_wait;
+	struct m0_pool_version                *pver;
+	struct m0_poolmach_state              *pms;
+	struct m0_pooldev                     *sdev;
+	uint32_t                               i;
+	bool                                   wait = false;
+
+	if (!pc->pc_lazy_connect)
+		return false;
+	m0_reqh_service_connect_waiter_init(w, oo->oo_sm_grp,
+					    &obj_connected_ast);
+	pver = m0_pool_version_find(pc, &oo->oo_pver);
+	if (pver != NULL) {
+		m0_rwlock_read_lock(&pver->pv_mach.pm_lock);
+		pms = pver->pv_mach.pm_state;
+		for (i = 0; i < pms->pst_nr_devices && !wait; i++) {
+			sdev = &pms->pst_devices_array[i];
+			if (M0_IN(sdev->pd_state, (M0_PNDS_ONLINE,
+						   M0_PNDS_SNS_REBALANCING)))
+				wait = m0_reqh_service_connect_waiter_arm(w,
+				     pc->pc_dev2svc[sdev->pd_sdev_idx].pds_ctx);
+		}
+		m0_rwlock_read_unlock(&pver->pv_mach.pm_lock);
+	}
+	/* Namespace operations go to mdservices without oostore. */
+	if (!m0c->m0c_config->mc_is_oostore &&
+	    M0_IN(oo->oo_oc.oc_op.op_code,
+		  (M0_EO_CREATE, M0_EO_DELETE, M0_EO_OPEN))) {
+		for (i = 0; i < pc->pc_nr_svcs[M0_CST_MDS] && !wait; i++)
+			wait = m0_reqh_service_connect_waiter_arm(w,
+							pc->pc_mds_map[i]);
+	}
+	if (!wait)
+		m0_reqh_service_connect_waiter_fini(w);
+	return wait;
+}
+
 static void obj_namei_cb_launch(struct m0_op_common *oc)
 {
 	int               rc;
@@ -239,6 +299,10 @@ static void obj_namei_cb_launch(struct m0_op_common *oc)
 
 	oo = bob_of(oc, struct m0_op_obj, oo_oc, &oo_bobtype);
 	M0_PRE(obj_op_obj_invariant(oo));
+	if (m0__obj_connect_wait(oo)) {
+		M0_LEAVE();
+		return;
+	}
 
 	/* Move to a different state and call the control function. */
 	m0_sm_group_lock(&op->op_entity->en_sm_group);
@@ -824,15 +888,76 @@ M0_EXPORTED(m0_entity_create);
 int m0_entity_delete(struct m0_entity *entity,
 		     struct m0_op **op)
 {
+	int rc;
+
 	M0_ENTRY();
 
 	M0_PRE(entity != NULL);
 	M0_PRE(op != NULL);
 
+	if (entity->en_type == M0_ET_OBJ) {
+		rc = m0__obj_inline_delete(m0__obj_entity(entity));
+		if (rc != 0)
+			return M0_ERR(rc);
+	}
 	return M0_RC(entity_namei_op(entity, op, M0_EO_DELETE));
 }
 M0_EXPORTED(m0_entity_delete);
 
+static int entity_namei_batch(struct m0_fid *pool, struct m0_entity **ents,
+			      uint32_t nr, struct m0_op **ops,
+			      enum m0_entity_opcode opcode)
+{
+	struct m0_op_common *oc;
+	struct m0_op_obj    *oo;
+	uint32_t             i;
+	int                  rc = 0;
+
+	M0_ENTRY("nr=%"PRIu32" opcode=%d", nr, opcode);
+	M0_PRE(ents != NULL && ops != NULL && nr > 0);
+	M0_PRE(m0_forall(j, nr, ops[j] == NULL));
+
+	for (i = 0; i < nr; ++i) {
+		rc = opcode == M0_EO_CREATE ?
+			m0_entity_create(pool, ents[i], &ops[i]) :
+			m0_entity_delete(ents[i], &ops[i]);
+		if (rc != 0)
+			break;
+		if (ents[i]->en_type == M0_ET_OBJ) {
+			oc = bob_of(ops[i], struct m0_op_common, oc_op,
+				    &oc_bobtype);
+			oo = bob_of(oc, struct m0_op_obj, oo_oc, &oo_bobtype);
+			oo->oo_batched = i < nr - 1;
+		}
+	}
+	if (rc != 0) {
+		while (i-- > 0) {
+			m0_op_fini(ops[i]);
+			m0_op_free(ops[i]);
+			ops[i] = NULL;
+		}
+		return M0_ERR(rc);
+	}
+	return M0_RC(0);
+}
+
+int m0_entity_create_batch(struct m0_fid     *pool,
+			   struct m0_entity **ents,
+			   uint32_t           nr,
+			   struct m0_op     **ops)
+{
+	return entity_namei_batch(pool, ents, nr, ops, M0_EO_CREATE);
+}
+M0_EXPORTED(m0_entity_create_batch);
+
+int m0_entity_delete_batch(struct m0_entity **ents,
+			   uint32_t           nr,
+			   struct m0_op     **ops)
+{
+	return entity_namei_batch(NULL, ents, nr, ops, M0_EO_DELETE);
+}
+M0_EXPORTED(m0_entity_delete_batch);
+
 uint64_t m0_obj_unit_size_to_layout_id(int unit_size)
 {
 	uint64_t i;
@@ -0,0 +1,204 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "motr/client.h"
+#include "motr/client_internal.h"     /* m0__obj_attr_set */
+#include "motr/obj_attr_cache.h"
+
+#include "lib/errno.h"
+#include "lib/memory.h"
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_CLIENT
+#include "lib/trace.h"
+
+/**
+ * @addtogroup client
+ *
+ * @{
+ */
+
+enum {
+	/** Initial number of buckets, the table grows with the cache. */
+	OAC_BUCKETS_NR = 64
+};
+
+struct oac_rec {
+	struct m0_hlink oar_hlink;
+	uint64_t        oar_magic;
+	struct m0_tlink oar_lru_link;
+	uint64_t        oar_lru_magic;
+	struct m0_fid   oar_fid;
+	struct m0_fid   oar_pver;
+	uint64_t        oar_lid;
+};
+
+static uint64_t oac_hash(const struct m0_htable *htable,
+			 const struct m0_fid *fid)
+{
+	return m0_fid_hash(fid) % htable->h_bucket_nr;
+}
+
+static bool oac_fid_eq(const struct m0_fid *f0, const struct m0_fid *f1)
+{
+	return m0_fid_eq(f0, f1);
+}
+
+M0_HT_DESCR_DEFINE(oac_recs, "Object attribute cache", static,
+		   struct oac_rec, oar_hlink, oar_magic,
+		   M0_OAC_REC_MAGIC, M0_OAC_REC_HEAD_MAGIC,
+		   oar_fid, oac_hash, oac_fid_eq);
+M0_HT_DEFINE(oac_recs, static, struct oac_rec, struct m0_fid);
+
+M0_TL_DESCR_DEFINE(oac_lru, "LRU of object attributes", static,
+		   struct oac_rec, oar_lru_link, oar_lru_magic,
+		   M0_OAC_LRU_MAGIC, M0_OAC_LRU_HEAD_MAGIC);
+M0_TL_DEFINE(oac_lru, static, struct oac_rec);
+
+static bool oac_is_enabled(const struct m0_obj_attr_cache *oac)
+{
+	return oac->oac_max != 0;
+}
+
+static void oac_rec_del(struct m0_obj_attr_cache *oac, struct oac_rec *rec)
+{
+	M0_PRE(m0_mutex_is_locked(&oac->oac_lock));
+	oac_recs_htable_del(&oac->oac_recs, rec);
+	oac_lru_tlink_del_fini(rec);
+	M0_CNT_DEC(oac->oac_nr);
+	m0_free(rec);
+}
+
+M0_INTERNAL int m0__obj_attr_cache_init(struct m0_obj_attr_cache *oac,
+					uint32_t max)
+{
+	int rc;
+
+	M0_SET0(oac);
+	if (max == 0)
+		return 0;
+	rc = oac_recs_htable_init_resizable(&oac->oac_recs, OAC_BUCKETS_NR);
+	if (rc != 0)
+		return M0_ERR(rc);
+	m0_mutex_init(&oac->oac_lock);
+	oac_lru_tlist_init(&oac->oac_lru);
+	oac->oac_max = max;
+	return 0;
+}
+
+M0_INTERNAL void m0__obj_attr_cache_fini(struct m0_obj_attr_cache *oac)
+{
+	struct oac_rec *rec;
+
+	if (!oac_is_enabled(oac))
+		return;
+	M0_LOG(M0_DEBUG, "hits=%"PRIu64" misses=%"PRIu64,
+	       oac->oac_hits, oac->oac_misses);
+	m0_mutex_lock(&oac->oac_lock);
+	while ((rec = oac_lru_tlist_head(&oac->oac_lru)) != NULL)
+		oac_rec_del(oac, rec);
+	m0_mutex_unlock(&oac->oac_lock);
+	M0_ASSERT(oac->oac_nr == 0);
+	oac_lru_tlist_fini(&oac->oac_lru);
+	m0_mutex_fini(&oac->oac_lock);
+	oac_recs_htable_fini(&oac->oac_recs);
+	oac->oac_max = 0;
+}
+
+M0_INTERNAL bool m0__obj_attr_cache_get(struct m0_obj_attr_cache *oac,
+					const struct m0_fid *fid,
+					struct m0_obj *obj)
+{
+	struct oac_rec *rec;
+
+	if (!oac_is_enabled(oac))
+		return false;
+	m0_mutex_lock(&oac->oac_lock);
+	rec = oac_recs_htable_lookup(&oac->oac_recs, fid);
+	if (rec != NULL) {
+		oac_lru_tlist_move(&oac->oac_lru, rec);
+		m0__obj_attr_set(obj, rec->oar_pver, rec->oar_lid);
+		oac->oac_hits++;
+	} else
+		oac->oac_misses++;
+	m0_mutex_unlock(&oac->oac_lock);
+	return rec != NULL;
+}
+
+M0_INTERNAL void m0__obj_attr_cache_put(struct m0_obj_attr_cache *oac,
+					const struct m0_fid *fid,
+					const struct m0_obj *obj)
+{
+	struct oac_rec *rec;
+
+	if (!oac_is_enabled(oac))
+		return;
+	m0_mutex_lock(&oac->oac_lock);
+	rec = oac_recs_htable_lookup(&oac->oac_recs, fid);
+	if (rec == NULL) {
+		if (oac->oac_nr == oac->oac_max)
+			oac_rec_del(oac, oac_lru_tlist_tail(&oac->oac_lru));
+		M0_ALLOC_PTR(rec);
+		if (rec == NULL) {
+			m0_mutex_unlock(&oac->oac_lock);
+			return;
+		}
+		rec->oar_fid = *fid;
+		oac_recs_htable_add(&oac->oac_recs, rec);
+		oac_lru_tlink_init_at(rec, &oac->oac_lru);
+		M0_CNT_INC(oac->oac_nr);
+	} else
+		oac_lru_tlist_move(&oac->oac_lru, rec);
+	rec->oar_pver = obj->ob_attr.oa_pver;
+	rec->oar_lid = obj->ob_attr.oa_layout_id;
+	m0_mutex_unlock(&oac->oac_lock);
+}
+
+M0_INTERNAL void m0__obj_attr_cache_del(struct m0_obj_attr_cache *oac,
+					const struct m0_fid *fid)
+{
+	struct oac_rec *rec;
+
+	if (!oac_is_enabled(oac))
+		return;
+	m0_mutex_lock(&oac->oac_lock);
+	rec = oac_recs_htable_lookup(&oac->oac_recs, fid);
+	if (rec != NULL)
+		oac_rec_del(oac, rec);
+	m0_mutex_unlock(&oac->oac_lock);
+}
+
+/** @} end of client group */
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
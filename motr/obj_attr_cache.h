@@ -0,0 +1,105 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __MOTR_OBJ_ATTR_CACHE_H__
+#define __MOTR_OBJ_ATTR_CACHE_H__
+
+/**
+ * @defgroup client
+ *
+ * Object attribute cache
+ * ----------------------
+ *
+ * m0_entity_open() of an object looks its pool version and layout id up in
+ * the meta-data service before the first i/o can be built. The client keeps
+ * the attributes of the last m0_config::mc_obj_attr_cache_nr objects it
+ * created or opened, least recently used objects are evicted first. Opening
+ * a cached object completes at launch without a round trip, as it does for
+ * objects with M0_ENF_META set.
+ *
+ * Pool version and layout of an object do not change while the object
+ * exists. Deletion of an object by this client drops its attributes. An
+ * object deleted by another client stays cached, and i/o against it fails as
+ * it fails against any deleted object.
+ *
+ * @{
+ */
+
+#include "lib/types.h"
+#include "lib/mutex.h"
+#include "lib/tlist.h"
+#include "lib/hash.h"
+#include "fid/fid.h"
+
+struct m0_obj;
+
+struct m0_obj_attr_cache {
+	struct m0_mutex  oac_lock;
+	/** Records keyed by object (gob) fid. */
+	struct m0_htable oac_recs;
+	/** Records from the most to the least recently used. */
+	struct m0_tl     oac_lru;
+	uint32_t         oac_nr;
+	/** Maximal number of records, 0 if the cache is disabled. */
+	uint32_t         oac_max;
+	uint64_t         oac_hits;
+	uint64_t         oac_misses;
+};
+
+M0_INTERNAL int  m0__obj_attr_cache_init(struct m0_obj_attr_cache *oac,
+					 uint32_t max);
+M0_INTERNAL void m0__obj_attr_cache_fini(struct m0_obj_attr_cache *oac);
+
+/**
+ * Sets pool version and layout id of the object from the cache.
+ * @retval true the attributes are cached.
+ */
+M0_INTERNAL bool m0__obj_attr_cache_get(struct m0_obj_attr_cache *oac,
+					const struct m0_fid *fid,
+					struct m0_obj *obj);
+
+/** Remembers pool version and layout id of the object. */
+M0_INTERNAL void m0__obj_attr_cache_put(struct m0_obj_attr_cache *oac,
+					const struct m0_fid *fid,
+					const struct m0_obj *obj);
+
+/** Forgets the attributes of the object with the given fid. */
+M0_INTERNAL void m0__obj_attr_cache_del(struct m0_obj_attr_cache *oac,
+					const struct m0_fid *fid);
+
+/** @} end of client group */
+#endif /* __MOTR_OBJ_ATTR_CACHE_H__ */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
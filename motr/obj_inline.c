@@ -0,0 +1,487 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "motr/client.h"
+#include "motr/client_internal.h"
+#include "motr/io.h"                  /* m0__obj_io_cached_done */
+#include "motr/obj_inline.h"
+
+#include "lib/arith.h"                /* max64u */
+#include "lib/errno.h"
+#include "lib/memory.h"
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_CLIENT
+#include "lib/trace.h"
+
+/**
+ * @addtogroup client
+ *
+ * @{
+ */
+
+/** Index operation of an inline object i/o. */
+struct inline_req {
+	struct m0_op_io   *ir_ioo;
+	struct m0_op      *ir_op;
+	struct m0_uint128  ir_key;
+	m0_bcount_t        ir_key_len;
+	void              *ir_key_buf;
+	struct m0_bufvec   ir_keys;
+	/** Value of a PUT, a copy of the object data. */
+	void              *ir_val;
+	m0_bcount_t        ir_val_len;
+	struct m0_bufvec   ir_vals;
+	int                ir_rc;
+	struct m0_sm_ast   ir_ast;
+};
+
+static bool inline_is_enabled(const struct m0_client *m0c)
+{
+	return m0c->m0c_inline_size != 0;
+}
+
+static m0_bindex_t inline_ext_end(const struct m0_indexvec *ext)
+{
+	m0_bindex_t end = 0;
+	uint32_t    i;
+
+	for (i = 0; i < ext->iv_vec.v_nr; ++i)
+		end = max64u(end, ext->iv_index[i] + ext->iv_vec.v_count[i]);
+	return end;
+}
+
+static struct m0_obj_inline *inline_alloc(bool regular)
+{
+	struct m0_obj_inline *oi;
+
+	M0_ALLOC_PTR(oi);
+	if (oi != NULL) {
+		m0_mutex_init(&oi->oi_lock);
+		m0_cond_init(&oi->oi_idle, &oi->oi_lock);
+		oi->oi_regular = regular;
+	}
+	return oi;
+}
+
+static void inline_free(struct m0_obj_inline *oi)
+{
+	M0_PRE(oi->oi_nr == 0);
+	m0_free(oi->oi_buf);
+	m0_cond_fini(&oi->oi_idle);
+	m0_mutex_fini(&oi->oi_lock);
+	m0_free(oi);
+}
+
+/** Executes an index operation on the record of the object synchronously. */
+static int inline_idx_op(struct m0_obj *obj, enum m0_idx_opcode opcode,
+			 struct m0_bufvec *vals, int *rc_rec)
+{
+	struct m0_client *m0c = m0__obj_instance(obj);
+	struct m0_op     *op = NULL;
+	void             *key = &obj->ob_entity.en_id;
+	m0_bcount_t       key_len = sizeof obj->ob_entity.en_id;
+	struct m0_bufvec  keys = M0_BUFVEC_INIT_BUF(&key, &key_len);
+	int               rc;
+
+	rc = m0_idx_op(&m0c->m0c_inline_idx, opcode, &keys, vals, rc_rec,
+		       0, &op);
+	if (rc != 0)
+		return M0_ERR(rc);
+	m0_op_launch(&op, 1);
+	rc = m0_op_wait(op, M0_BITS(M0_OS_FAILED, M0_OS_STABLE),
+			M0_TIME_NEVER) ?: op->op_sm.sm_rc;
+	m0_op_fini(op);
+	m0_op_free(op);
+	return M0_RC(rc);
+}
+
+/** Finds out whether the object has a record and reads the record. */
+static int inline_load(struct m0_obj *obj)
+{
+	struct m0_obj_inline *oi;
+	struct m0_bufvec      vals;
+	int                   rc_rec = 0;
+	int                   rc;
+
+	rc = m0_bufvec_empty_alloc(&vals, 1);
+	if (rc != 0)
+		return M0_ERR(rc);
+	rc = inline_idx_op(obj, M0_IC_GET, &vals, &rc_rec);
+	if (rc == 0 && !M0_IN(rc_rec, (0, -ENOENT)))
+		rc = rc_rec;
+	if (rc == 0) {
+		oi = inline_alloc(rc_rec == -ENOENT);
+		if (oi != NULL) {
+			if (rc_rec == 0) {
+				/* Steal the value. */
+				oi->oi_buf = vals.ov_buf[0];
+				oi->oi_size = vals.ov_vec.v_count[0];
+				vals.ov_buf[0] = NULL;
+			}
+			obj->ob_inline = oi;
+		} else
+			rc = M0_ERR(-ENOMEM);
+	}
+	m0_bufvec_free(&vals);
+	return M0_RC(rc);
+}
+
+/** Moves data of an inline object to its layout. */
+static int inline_promote(struct m0_obj *obj)
+{
+	struct m0_obj_inline *oi = obj->ob_inline;
+	struct m0_indexvec    ext;
+	struct m0_bufvec      data;
+	m0_bindex_t           start = 0;
+	m0_bcount_t           size;
+	void                 *buf;
+	int                   rc_rec = 0;
+	int                   rc = 0;
+
+	M0_ENTRY("obj=%p size=%"PRIu64, obj, oi->oi_size);
+
+	m0_mutex_lock(&oi->oi_lock);
+	oi->oi_regular = true;
+	/* Otherwise a PUT could re-create the record after its deletion. */
+	while (oi->oi_nr != 0)
+		m0_cond_wait(&oi->oi_idle);
+	m0_mutex_unlock(&oi->oi_lock);
+	/* Operations of a regular object do not touch the data anymore. */
+	buf = oi->oi_buf;
+	size = oi->oi_size;
+	if (size != 0) {
+		ext = (struct m0_indexvec) {
+			.iv_vec   = { .v_nr = 1, .v_count = &size },
+			.iv_index = &start
+		};
+		data = M0_BUFVEC_INIT_BUF(&buf, &size);
+		rc = m0__obj_cache_io(obj, M0_OC_WRITE, &ext, &data);
+	}
+	if (rc == 0) {
+		rc = inline_idx_op(obj, M0_IC_DEL, NULL, &rc_rec);
+		if (rc == 0 && !M0_IN(rc_rec, (0, -ENOENT)))
+			rc = rc_rec;
+	}
+	if (rc == 0) {
+		m0_free(oi->oi_buf);
+		oi->oi_buf = NULL;
+		oi->oi_size = 0;
+	} else {
+		m0_mutex_lock(&oi->oi_lock);
+		oi->oi_regular = false;
+		m0_mutex_unlock(&oi->oi_lock);
+	}
+	return M0_RC(rc);
+}
+
+/** Applies a WRITE or a FREE to the in-memory data of an inline object. */
+static int inline_apply(struct m0_obj_inline *oi, struct m0_op_io *ioo,
+			m0_bcount_t bsize)
+{
+	struct m0_indexvec     *ext = &ioo->ioo_ext;
+	struct m0_bufvec_cursor cur;
+	m0_bindex_t             start;
+	m0_bcount_t             count;
+	m0_bcount_t             size;
+	char                   *buf;
+	uint32_t                i;
+	bool                    write;
+
+	M0_PRE(m0_mutex_is_locked(&oi->oi_lock));
+
+	write = ioo->ioo_oo.oo_oc.oc_op.op_code == M0_OC_WRITE;
+	size = round_up(inline_ext_end(ext), bsize);
+	if (write && size > oi->oi_size) {
+		buf = m0_alloc(size);
+		if (buf == NULL)
+			return M0_ERR(-ENOMEM);
+		memcpy(buf, oi->oi_buf, oi->oi_size);
+		m0_free(oi->oi_buf);
+		oi->oi_buf = buf;
+		oi->oi_size = size;
+	}
+	if (write)
+		m0_bufvec_cursor_init(&cur, &ioo->ioo_data);
+	for (i = 0; i < ext->iv_vec.v_nr; ++i) {
+		start = ext->iv_index[i];
+		count = ext->iv_vec.v_count[i];
+		if (write)
+			m0_bufvec_cursor_copyfrom(&cur, oi->oi_buf + start,
+						  count);
+		else if (start < oi->oi_size)
+			memset(oi->oi_buf + start, 0,
+			       min64u(count, oi->oi_size - start));
+	}
+	return 0;
+}
+
+/** Copies the record value into the buffers of a READ, zeroes the rest. */
+static void inline_read_copy(struct m0_op_io *ioo, const char *val,
+			     m0_bcount_t len)
+{
+	struct m0_indexvec     *ext = &ioo->ioo_ext;
+	struct m0_bufvec_cursor cur;
+	m0_bindex_t             start;
+	m0_bcount_t             count;
+	m0_bcount_t             nr;
+	m0_bcount_t             step;
+	uint32_t                i;
+
+	m0_bufvec_cursor_init(&cur, &ioo->ioo_data);
+	for (i = 0; i < ext->iv_vec.v_nr; ++i) {
+		start = ext->iv_index[i];
+		count = ext->iv_vec.v_count[i];
+		nr = start < len ? min64u(count, len - start) : 0;
+		if (nr != 0)
+			m0_bufvec_cursor_copyto(&cur, (void *)val + start, nr);
+		for (count -= nr; count > 0; count -= step) {
+			step = min64u(m0_bufvec_cursor_step(&cur), count);
+			memset(m0_bufvec_cursor_addr(&cur), 0, step);
+			m0_bufvec_cursor_move(&cur, step);
+		}
+	}
+}
+
+static void inline_req_free(struct inline_req *req)
+{
+	if (req->ir_op != NULL) {
+		m0_op_fini(req->ir_op);
+		m0_op_free(req->ir_op);
+	}
+	if (req->ir_val != NULL)
+		m0_free(req->ir_val);
+	else
+		m0_bufvec_free(&req->ir_vals);
+	m0_free(req);
+}
+
+/** Completes the object operation, in its locality. */
+static void inline_req_done(struct m0_sm_group *grp, struct m0_sm_ast *ast)
+{
+	struct inline_req    *req = M0_AMB(req, ast, ir_ast);
+	struct m0_op_io      *ioo = req->ir_ioo;
+	struct m0_obj_inline *oi  = ioo->ioo_obj->ob_inline;
+	struct m0_op         *op  = req->ir_op;
+	int                   rc;
+
+	rc = op->op_sm.sm_rc;
+	if (rc == 0 && !M0_IN(req->ir_rc, (0, -ENOENT)))
+		rc = M0_ERR(req->ir_rc);
+	if (rc == 0 && op->op_code == M0_IC_GET) {
+		if (req->ir_rc == 0)
+			inline_read_copy(ioo, req->ir_vals.ov_buf[0],
+					 req->ir_vals.ov_vec.v_count[0]);
+		else
+			inline_read_copy(ioo, NULL, 0);
+	}
+	inline_req_free(req);
+	m0_mutex_lock(&oi->oi_lock);
+	M0_CNT_DEC(oi->oi_nr);
+	if (oi->oi_nr == 0)
+		m0_cond_broadcast(&oi->oi_idle);
+	m0_mutex_unlock(&oi->oi_lock);
+	m0__obj_io_cached_done(ioo, rc);
+}
+
+static void inline_req_cb(struct m0_op *op)
+{
+	struct inline_req *req = op->op_datum;
+
+	m0_sm_ast_post(req->ir_ioo->ioo_oo.oo_sm_grp, &req->ir_ast);
+}
+
+static const struct m0_op_ops inline_req_cbs = {
+	.oop_executed = NULL,
+	.oop_failed   = &inline_req_cb,
+	.oop_stable   = &inline_req_cb
+};
+
+M0_INTERNAL bool m0__obj_inline_launch(struct m0_op_io *ioo)
+{
+	struct m0_obj        *obj = ioo->ioo_obj;
+	struct m0_obj_inline *oi  = obj->ob_inline;
+	struct m0_client     *m0c = m0__obj_instance(obj);
+	struct m0_op         *op  = &ioo->ioo_oo.oo_oc.oc_op;
+	struct inline_req    *req;
+	enum m0_idx_opcode    opcode;
+	uint32_t              flags = 0;
+	bool                  empty = false;
+	int                   rc;
+
+	if (oi == NULL)
+		return false;
+	m0_mutex_lock(&oi->oi_lock);
+	if (oi->oi_regular) {
+		m0_mutex_unlock(&oi->oi_lock);
+		return false;
+	}
+	M0_ALLOC_PTR(req);
+	rc = req == NULL ? M0_ERR(-ENOMEM) : 0;
+	if (rc == 0) {
+		req->ir_ioo = ioo;
+		req->ir_key = obj->ob_entity.en_id;
+		req->ir_key_buf = &req->ir_key;
+		req->ir_key_len = sizeof req->ir_key;
+		req->ir_keys = M0_BUFVEC_INIT_BUF(&req->ir_key_buf,
+						  &req->ir_key_len);
+		req->ir_ast.sa_cb = &inline_req_done;
+	}
+	if (rc == 0 && op->op_code == M0_OC_READ) {
+		opcode = M0_IC_GET;
+		rc = m0_bufvec_empty_alloc(&req->ir_vals, 1);
+	} else if (rc == 0) {
+		opcode = M0_IC_PUT;
+		flags = M0_OIF_OVERWRITE;
+		rc = inline_apply(oi, ioo,
+				  M0_BITS(obj->ob_attr.oa_bshift));
+		/* A FREE of an empty object has nothing to update. */
+		empty = rc == 0 && oi->oi_size == 0;
+		if (rc == 0 && !empty) {
+			/* Updates go to the index in the order of launch. */
+			req->ir_val_len = oi->oi_size;
+			req->ir_val = m0_alloc(oi->oi_size);
+			rc = req->ir_val == NULL ? M0_ERR(-ENOMEM) : 0;
+		}
+		if (rc == 0 && !empty) {
+			memcpy(req->ir_val, oi->oi_buf, oi->oi_size);
+			req->ir_vals = M0_BUFVEC_INIT_BUF(&req->ir_val,
+							  &req->ir_val_len);
+		}
+	}
+	if (rc == 0 && !empty)
+		rc = m0_idx_op(&m0c->m0c_inline_idx, opcode, &req->ir_keys,
+			       &req->ir_vals, &req->ir_rc, flags,
+			       &req->ir_op);
+	if (rc == 0 && !empty) {
+		M0_CNT_INC(oi->oi_nr);
+		m0_mutex_unlock(&oi->oi_lock);
+		M0_LOG(M0_DEBUG, "op=%p inline: opcode=%d", op, opcode);
+		req->ir_op->op_datum = req;
+		m0_op_setup(req->ir_op, &inline_req_cbs, 0);
+		m0_op_launch(&req->ir_op, 1);
+	} else {
+		m0_mutex_unlock(&oi->oi_lock);
+		if (req != NULL)
+			inline_req_free(req);
+		m0__obj_io_cached_done(ioo, rc);
+	}
+	return true;
+}
+
+M0_INTERNAL int m0__obj_inline_prepare(struct m0_obj *obj,
+				       enum m0_obj_opcode opcode,
+				       const struct m0_indexvec *ext,
+				       const struct m0_bufvec *attr,
+				       uint64_t mask)
+{
+	struct m0_client *m0c = m0__obj_instance(obj);
+	int               rc;
+
+	if (!inline_is_enabled(m0c))
+		return 0;
+	if (obj->ob_inline == NULL) {
+		rc = inline_load(obj);
+		if (rc != 0)
+			return M0_ERR(rc);
+	}
+	if (obj->ob_inline->oi_regular)
+		return 0;
+	if ((opcode == M0_OC_WRITE &&
+	     inline_ext_end(ext) > m0c->m0c_inline_size) ||
+	    (attr != NULL && attr->ov_vec.v_nr != 0 && mask != 0))
+		return inline_promote(obj);
+	return 0;
+}
+
+M0_INTERNAL void m0__obj_inline_created(struct m0_obj *obj)
+{
+	if (!inline_is_enabled(m0__obj_instance(obj)))
+		return;
+	if (obj->ob_inline != NULL)
+		m0__obj_inline_fini(obj);
+	/* If the allocation fails, the object is looked up at first i/o. */
+	obj->ob_inline = inline_alloc(false);
+}
+
+M0_INTERNAL int m0__obj_inline_delete(struct m0_obj *obj)
+{
+	int rc_rec = 0;
+	int rc;
+
+	if (!inline_is_enabled(m0__obj_instance(obj)) ||
+	    (obj->ob_inline != NULL && obj->ob_inline->oi_regular))
+		return 0;
+	rc = inline_idx_op(obj, M0_IC_DEL, NULL, &rc_rec);
+	if (rc == 0 && !M0_IN(rc_rec, (0, -ENOENT)))
+		rc = rc_rec;
+	if (rc == 0)
+		m0__obj_inline_fini(obj);
+	return M0_RC(rc);
+}
+
+M0_INTERNAL void m0__obj_inline_fini(struct m0_obj *obj)
+{
+	if (obj->ob_inline != NULL) {
+		inline_free(obj->ob_inline);
+		obj->ob_inline = NULL;
+	}
+}
+
+M0_INTERNAL void m0__obj_inline_client_init(struct m0_client *m0c)
+{
+	const struct m0_config *conf = m0c->m0c_config;
+
+	if (conf->mc_obj_inline_size == 0 ||
+	    !m0_fid_is_set(&conf->mc_obj_inline_idx))
+		return;
+	m0_container_init(&m0c->m0c_inline_container, NULL,
+			  &M0_UBER_REALM, m0c);
+	m0_idx_init(&m0c->m0c_inline_idx,
+		    &m0c->m0c_inline_container.co_realm,
+		    (struct m0_uint128 *)&conf->mc_obj_inline_idx);
+	m0c->m0c_inline_size = conf->mc_obj_inline_size;
+}
+
+M0_INTERNAL void m0__obj_inline_client_fini(struct m0_client *m0c)
+{
+	if (inline_is_enabled(m0c)) {
+		m0_idx_fini(&m0c->m0c_inline_idx);
+		m0c->m0c_inline_size = 0;
+	}
+}
+
+/** @} end of client group */
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -0,0 +1,123 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __MOTR_OBJ_INLINE_H__
+#define __MOTR_OBJ_INLINE_H__
+
+/**
+ * @defgroup client
+ *
+ * Inline objects
+ * --------------
+ *
+ * Data of small objects can be stored as a single record of a distributed
+ * index, m0_config::mc_obj_inline_idx, instead of the object layout. The
+ * record is keyed by the object id and its value is the object data from
+ * offset 0, rounded up to the object block size. The index must exist and is
+ * replicated according to its own layout.
+ *
+ * An object created by the client while inline objects are enabled starts
+ * inline. Other objects are looked up in the index by their first operation:
+ * an object without a record is a regular one. I/o of an inline object is an
+ * index operation, a GET for a READ and a PUT of the whole updated data for a
+ * WRITE or a FREE, so that neither parity is calculated nor ioservices are
+ * touched. When a WRITE extends the object beyond m0_config::mc_obj_inline_size
+ * (or uses block attributes), the object is promoted before the operation is
+ * created: the inline data are written to the object layout and the record is
+ * deleted. m0_entity_delete() deletes the record.
+ *
+ * The client keeps the data of inline objects it writes in memory, so that a
+ * write needs no read of the record. Updates of an inline object by several
+ * clients at once are not coordinated, the same as read-modify-writes of
+ * parity groups are not.
+ *
+ * @{
+ */
+
+#include "lib/types.h"
+#include "lib/mutex.h"
+#include "lib/cond.h"
+#include "motr/client.h"              /* m0_obj_opcode */
+
+struct m0_op_io;
+struct m0_client;
+
+struct m0_obj_inline {
+	/** Protects the fields below. */
+	struct m0_mutex oi_lock;
+	/** Data of the object are in its layout. */
+	bool            oi_regular;
+	/** Data of an inline object, oi_size bytes. */
+	char           *oi_buf;
+	m0_bcount_t     oi_size;
+	/** Number of index operations in flight. */
+	uint32_t        oi_nr;
+	/** Signalled when oi_nr drops to 0. */
+	struct m0_cond  oi_idle;
+};
+
+M0_INTERNAL void m0__obj_inline_client_init(struct m0_client *m0c);
+M0_INTERNAL void m0__obj_inline_client_fini(struct m0_client *m0c);
+
+/** Marks an object just created by the client as an inline one. */
+M0_INTERNAL void m0__obj_inline_created(struct m0_obj *obj);
+
+/**
+ * Called when an object i/o operation is created. Finds out whether the object
+ * is inline and promotes it if the operation does not fit the index record.
+ */
+M0_INTERNAL int  m0__obj_inline_prepare(struct m0_obj *obj,
+					enum m0_obj_opcode opcode,
+					const struct m0_indexvec *ext,
+					const struct m0_bufvec *attr,
+					uint64_t mask);
+
+/**
+ * Called at launch of an object i/o operation. Returns true iff the object is
+ * inline, in which case the operation is completed asynchronously by an index
+ * operation.
+ */
+M0_INTERNAL bool m0__obj_inline_launch(struct m0_op_io *ioo);
+
+/** Deletes the record of an object being deleted. */
+M0_INTERNAL int  m0__obj_inline_delete(struct m0_obj *obj);
+
+/** Releases the in-memory state, called by m0_obj_fini(). */
+M0_INTERNAL void m0__obj_inline_fini(struct m0_obj *obj);
+
+/** @} end of client group */
+#endif /* __MOTR_OBJ_INLINE_H__ */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -33,6 +33,7 @@
 #include "motr/client_internal.h"
 #include "motr/io.h"
 #include "ioservice/fid_convert.h"
+#include "lib/time.h"
 
 /** Initialises the rm_lock_ctx */
 static void rm_ctx_init(struct m0_rm_lock_ctx *ctx,
@@ -79,6 +80,70 @@ M0_HT_DESCR_DEFINE(rm_ctx, "Hash-table for RM locks", M0_INTERNAL,
 
 M0_HT_DEFINE(rm_ctx, M0_INTERNAL, struct m0_rm_lock_ctx, struct m0_fid);
 
+M0_TL_DESCR_DEFINE(rm_idle, "idle RM contexts", static,
+		   struct m0_rm_lock_ctx, rmc_idle_link, rmc_idle_magic,
+		   M0_RM_IDLE_MAGIC, M0_RM_IDLE_HEAD_MAGIC);
+M0_TL_DEFINE(rm_idle, static, struct m0_rm_lock_ctx);
+
+M0_INTERNAL void m0__obj_lock_client_init(struct m0_client *m0c)
+{
+	rm_idle_tlist_init(&m0c->m0c_rm_idle);
+	m0_mutex_init(&m0c->m0c_rm_idle_lock);
+	m0c->m0c_rm_idle_nr = 0;
+}
+
+/** Drops a reference to the ctx, removing it from the hash-table if last. */
+static void rm_ctx_put(struct m0_rm_lock_ctx *ctx)
+{
+	rm_ctx_hbucket_lock(ctx->rmc_htable, &ctx->rmc_key);
+	if (m0_ref_read(&ctx->rmc_ref) == 1) {
+		rm_ctx_htable_del(ctx->rmc_htable, ctx);
+		rm_ctx_hbucket_unlock(ctx->rmc_htable, &ctx->rmc_key);
+		m0_ref_put(&ctx->rmc_ref);
+	} else {
+		m0_ref_put(&ctx->rmc_ref);
+		rm_ctx_hbucket_unlock(ctx->rmc_htable, &ctx->rmc_key);
+	}
+}
+
+/**
+ * Finalises idle contexts whose lease expired, the oldest ones above
+ * M0_RM_IDLE_MAX or, if "all" is true, all of them.
+ *
+ * An idle ctx holds one reference, owned by the idle list. Once the ctx is
+ * taken off the list the reference belongs to the reaper, which drops it
+ * without the idle lock: m0_obj_lock_init() could have got the ctx from
+ * the hash-table in the meantime, then the ctx stays alive.
+ */
+static void rm_idle_reap(struct m0_client *m0c, bool all)
+{
+	struct m0_rm_lock_ctx *ctx;
+	m0_time_t              now = m0_time_now();
+
+	while (true) {
+		m0_mutex_lock(&m0c->m0c_rm_idle_lock);
+		ctx = rm_idle_tlist_head(&m0c->m0c_rm_idle);
+		if (ctx == NULL ||
+		    !(all || m0c->m0c_rm_idle_nr > M0_RM_IDLE_MAX ||
+		      ctx->rmc_idle_deadline <= now)) {
+			m0_mutex_unlock(&m0c->m0c_rm_idle_lock);
+			break;
+		}
+		rm_idle_tlist_del(ctx);
+		--m0c->m0c_rm_idle_nr;
+		m0_mutex_unlock(&m0c->m0c_rm_idle_lock);
+		rm_ctx_put(ctx);
+	}
+}
+
+M0_INTERNAL void m0__obj_lock_client_fini(struct m0_client *m0c)
+{
+	rm_idle_reap(m0c, true);
+	M0_ASSERT(m0c->m0c_rm_idle_nr == 0);
+	m0_mutex_fini(&m0c->m0c_rm_idle_lock);
+	rm_idle_tlist_fini(&m0c->m0c_rm_idle);
+}
+
 int m0_obj_lock_init(struct m0_obj *obj)
 {
 	struct m0_fid          fid;
@@ -93,9 +158,16 @@ int m0_obj_lock_init(struct m0_obj *obj)
 	M0_LOG(M0_INFO, FID_F, FID_P(&fid));
 	rm_ctx_hbucket_lock(&m0c->m0c_rm_ctxs, &fid);
 	ctx = rm_ctx_htable_lookup(&m0c->m0c_rm_ctxs, &fid);
-	if (ctx != NULL)
-		m0_ref_get(&ctx->rmc_ref);
-	else {
+	if (ctx != NULL) {
+		/* The reference of an idle ctx is taken over. */
+		m0_mutex_lock(&m0c->m0c_rm_idle_lock);
+		if (rm_idle_tlink_is_in(ctx)) {
+			rm_idle_tlist_del(ctx);
+			--m0c->m0c_rm_idle_nr;
+		} else
+			m0_ref_get(&ctx->rmc_ref);
+		m0_mutex_unlock(&m0c->m0c_rm_idle_lock);
+	} else {
 		M0_ALLOC_PTR(ctx);
 		if (ctx == NULL) {
 			rm_ctx_hbucket_unlock(&m0c->m0c_rm_ctxs, &fid);
@@ -128,6 +200,7 @@ static void rm_ctx_init(struct m0_rm_lock_ctx *ctx,
 	ctx->rmc_key = *fid;
 	m0_cookie_new(&ctx->rmc_gen);
 	rm_ctx_tlink_init(ctx);
+	rm_idle_tlink_init(ctx);
 	m0_ref_init(&ctx->rmc_ref, 1, rm_ctx_fini);
 	m0_rw_lockable_init(&ctx->rmc_rw_file, &ctx->rmc_key, rdom);
 	m0_rm_remote_init(&ctx->rmc_creditor, &ctx->rmc_rw_file.rwl_resource);
@@ -144,6 +217,7 @@ static void rm_ctx_init(struct m0_rm_lock_ctx *ctx,
 void m0_obj_lock_fini(struct m0_obj *obj)
 {
 	struct m0_rm_lock_ctx *ctx;
+	struct m0_client      *m0c = m0__obj_instance(obj);
 
 	M0_ENTRY();
 	M0_PRE(obj != NULL);
@@ -153,13 +227,22 @@ void m0_obj_lock_fini(struct m0_obj *obj)
 	M0_ASSERT(ctx != NULL);
 	rm_ctx_hbucket_lock(ctx->rmc_htable, &ctx->rmc_key);
 	if (m0_ref_read(&ctx->rmc_ref) == 1) {
-		rm_ctx_htable_del(ctx->rmc_htable, ctx);
+		/*
+		 * Credits borrowed by the owner stay cached in it until the
+		 * lease expires or the creditor revokes them, so that the
+		 * object can be locked again without a borrow round trip.
+		 */
+		m0_mutex_lock(&m0c->m0c_rm_idle_lock);
+		ctx->rmc_idle_deadline = m0_time_from_now(M0_RM_IDLE_LEASE, 0);
+		rm_idle_tlist_add_tail(&m0c->m0c_rm_idle, ctx);
+		++m0c->m0c_rm_idle_nr;
+		m0_mutex_unlock(&m0c->m0c_rm_idle_lock);
 		rm_ctx_hbucket_unlock(ctx->rmc_htable, &ctx->rmc_key);
-		m0_ref_put(&ctx->rmc_ref);
 	} else {
 		m0_ref_put(&ctx->rmc_ref);
 		rm_ctx_hbucket_unlock(ctx->rmc_htable, &ctx->rmc_key);
 	}
+	rm_idle_reap(m0c, false);
 
 	M0_LEAVE();
 }
@@ -183,6 +266,7 @@ static void rm_ctx_fini(struct m0_ref *ref)
 	m0_rm_remote_fini(&ctx->rmc_creditor);
 	m0_rw_lockable_fini(&ctx->rmc_rw_file);
 	rm_ctx_tlink_fini(ctx);
+	rm_idle_tlink_fini(ctx);
 	m0_free(ctx);
 
 	M0_LEAVE();
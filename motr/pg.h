@@ -879,6 +879,26 @@ struct ioreq_fop {
 	 * are updated.
 	 */
 	struct target_ioreq         *irf_tioreq;
+
+	/**
+	 * Coalescing of small io fops, see ioreq_fop_async_submit().
+	 *
+	 * A fop waiting in m0_client::m0c_co_pending is a leader: fops of
+	 * other operations that target the same cob are attached to it as
+	 * members, linked through irf_co_next, and are sent as a part of the
+	 * leader fop. irf_co_next also links leaders in the pending list.
+	 */
+	struct ioreq_fop            *irf_co_members;
+	struct ioreq_fop            *irf_co_next;
+	/** Number of members of a leader. */
+	uint32_t                     irf_co_nr;
+	/** Estimated size of a leader with its members. */
+	m0_bcount_t                  irf_co_size;
+	/** Own descriptors and index vector of a sent leader. */
+	struct m0_io_descs           irf_co_desc;
+	struct m0_io_indexvec        irf_co_ivec;
+	/** True iff the fop was sent as a member of another fop. */
+	bool                         irf_co_member;
 };
 
 
@@ -0,0 +1,308 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "motr/client.h"
+#include "motr/client_internal.h"
+#include "motr/io.h"                  /* data_size, m0__obj_cache_io */
+#include "motr/wbc.h"                 /* m0__obj_wbc_read */
+#include "motr/ra.h"
+
+#include "lib/arith.h"                /* min64u */
+#include "lib/errno.h"
+#include "lib/memory.h"
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_CLIENT
+#include "lib/trace.h"
+
+/**
+ * @addtogroup client
+ *
+ * @{
+ */
+
+static m0_bindex_t ra_win_end(const struct m0_obj_ra_win *win)
+{
+	return win->rw_start + win->rw_size;
+}
+
+/** Returns a fetched or being fetched window containing the offset. */
+static struct m0_obj_ra_win *ra_win_find(struct m0_obj_ra *ra, m0_bindex_t off)
+{
+	struct m0_obj_ra_win *win;
+	int                   i;
+
+	M0_PRE(m0_mutex_is_locked(&ra->or_lock));
+
+	for (i = 0; i < M0_OBJ_RA_WIN_NR; ++i) {
+		win = &ra->or_win[i];
+		if (win->rw_state != RWS_EMPTY &&
+		    win->rw_start <= off && off < ra_win_end(win))
+			return win;
+	}
+	return NULL;
+}
+
+/** Drops windows overlapping [lo, hi). */
+static void ra_invalidate(struct m0_obj_ra *ra, m0_bindex_t lo, m0_bindex_t hi)
+{
+	struct m0_obj_ra_win *win;
+	int                   i;
+
+	M0_PRE(m0_mutex_is_locked(&ra->or_lock));
+
+	for (i = 0; i < M0_OBJ_RA_WIN_NR; ++i) {
+		win = &ra->or_win[i];
+		if (win->rw_start >= hi || ra_win_end(win) <= lo)
+			continue;
+		if (win->rw_state == RWS_VALID)
+			win->rw_state = RWS_EMPTY;
+		else if (win->rw_state == RWS_FETCHING)
+			win->rw_stale = true;
+	}
+}
+
+/**
+ * Schedules a fetch of the window following the data just read, [lo, hi),
+ * unless it is already fetched or there is no consumed window to reuse.
+ */
+static void ra_schedule(struct m0_obj_ra *ra, m0_bindex_t lo, m0_bindex_t hi)
+{
+	struct m0_obj_ra_win *next;
+	struct m0_obj_ra_win *win;
+	m0_bcount_t           limit = round_down(ra->or_size_max, ra->or_grp);
+	m0_bindex_t           start;
+	int                   i;
+
+	M0_PRE(m0_mutex_is_locked(&ra->or_lock));
+
+	if (limit == 0)
+		return;
+	next = ra_win_find(ra, hi);
+	start = next != NULL ? ra_win_end(next) : round_down(hi, ra->or_grp);
+	if (ra_win_find(ra, start) != NULL)
+		return;
+	for (i = 0; i < M0_OBJ_RA_WIN_NR; ++i) {
+		win = &ra->or_win[i];
+		if (win != next &&
+		    (win->rw_state == RWS_EMPTY ||
+		     (win->rw_state == RWS_VALID && ra_win_end(win) <= lo))) {
+			win->rw_state = RWS_FETCHING;
+			win->rw_start = start;
+			win->rw_size = min64u(ra->or_size, limit);
+			win->rw_stale = false;
+			m0_semaphore_up(&ra->or_wake);
+			return;
+		}
+	}
+}
+
+M0_INTERNAL bool m0__obj_ra_launch(struct m0_op_io *ioo)
+{
+	struct m0_obj_ra       *ra  = ioo->ioo_obj->ob_ra;
+	struct m0_op           *op  = &ioo->ioo_oo.oo_oc.oc_op;
+	struct m0_indexvec     *ext = &ioo->ioo_ext;
+	struct m0_bufvec_cursor cur;
+	struct m0_obj_ra_win   *win;
+	m0_bindex_t             lo;
+	m0_bindex_t             hi;
+	m0_bcount_t             off;
+	bool                    served = false;
+
+	if (ra == NULL || ioo->ioo_cache_io)
+		return false;
+	/* Segments are sorted by m0_obj_op(). */
+	lo = ext->iv_index[0];
+	hi = seg_endpos(ext, ext->iv_vec.v_nr - 1);
+	m0_mutex_lock(&ra->or_lock);
+	if (op->op_code != M0_OC_READ) {
+		ra_invalidate(ra, lo, hi);
+		m0_mutex_unlock(&ra->or_lock);
+		return false;
+	}
+	if (ra->or_grp == 0) {
+		ra->or_grp = data_size(pdlayout_get(ioo));
+		ra->or_size = ra->or_grp;
+	}
+	if (ioo->ioo_attr.ov_vec.v_nr == 0 &&
+	    hi - lo == m0_vec_count(&ext->iv_vec)) {
+		win = ra_win_find(ra, lo);
+		if (win != NULL && win->rw_state == RWS_VALID &&
+		    hi <= ra_win_end(win)) {
+			off = lo - win->rw_start;
+			m0_bufvec_cursor_init(&cur, &ioo->ioo_data);
+			m0_bufvec_cursor_copyto(&cur, win->rw_buf + off,
+						hi - lo);
+			served = true;
+		}
+	}
+	if (lo == ra->or_next) {
+		ra_schedule(ra, lo, hi);
+		ra->or_size = min64u(ra->or_size * 2, ra->or_size_max);
+	} else
+		ra->or_size = ra->or_grp;
+	ra->or_next = hi;
+	m0_mutex_unlock(&ra->or_lock);
+
+	if (served) {
+		M0_LOG(M0_DEBUG, "op=%p served from read-ahead: [%"PRIu64
+		       ", %"PRIu64")", op, lo, hi);
+		/* Writes of this client not flushed yet. */
+		m0__obj_wbc_read(ioo);
+		m0__obj_io_cached_done(ioo, 0);
+	}
+	return served;
+}
+
+static void ra_fetch(struct m0_obj_ra *ra, struct m0_obj_ra_win *win)
+{
+	struct m0_indexvec ext;
+	struct m0_bufvec   data;
+	m0_bindex_t        start;
+	m0_bcount_t        size;
+	void              *buf = win->rw_buf;
+	int                rc;
+
+	m0_mutex_lock(&ra->or_lock);
+	start = win->rw_start;
+	size = win->rw_size;
+	m0_mutex_unlock(&ra->or_lock);
+
+	ext = (struct m0_indexvec) {
+		.iv_vec   = { .v_nr = 1, .v_count = &size },
+		.iv_index = &start
+	};
+	data = M0_BUFVEC_INIT_BUF(&buf, &size);
+	rc = m0__obj_cache_io(ra->or_obj, M0_OC_READ, &ext, &data);
+	if (rc != 0)
+		M0_LOG(M0_WARN, "Read-ahead failed: [%"PRIu64", %"PRIu64") "
+		       "rc=%d", start, size, rc);
+
+	m0_mutex_lock(&ra->or_lock);
+	M0_ASSERT(win->rw_state == RWS_FETCHING);
+	win->rw_state = rc == 0 && !win->rw_stale ? RWS_VALID : RWS_EMPTY;
+	m0_mutex_unlock(&ra->or_lock);
+}
+
+static void ra_thread(struct m0_obj_ra *ra)
+{
+	struct m0_obj_ra_win *win;
+	bool                  fetch;
+	int                   i;
+
+	while (1) {
+		m0_semaphore_down(&ra->or_wake);
+		if (ra->or_shutdown)
+			break;
+		/* Windows are set to RWS_FETCHING only by readers. */
+		for (i = 0; i < M0_OBJ_RA_WIN_NR; ++i) {
+			win = &ra->or_win[i];
+			m0_mutex_lock(&ra->or_lock);
+			fetch = win->rw_state == RWS_FETCHING;
+			m0_mutex_unlock(&ra->or_lock);
+			if (fetch)
+				ra_fetch(ra, win);
+		}
+	}
+}
+
+static void ra_free(struct m0_obj_ra *ra)
+{
+	int i;
+
+	for (i = 0; i < M0_OBJ_RA_WIN_NR; ++i)
+		m0_free_aligned(ra->or_win[i].rw_buf, ra->or_size_max,
+				M0_NETBUF_SHIFT);
+	m0_semaphore_fini(&ra->or_wake);
+	m0_mutex_fini(&ra->or_lock);
+	m0_free(ra);
+}
+
+int m0_obj_ra_enable(struct m0_obj *obj, m0_bcount_t size_max)
+{
+	struct m0_obj_ra *ra;
+	int               rc;
+	int               i;
+
+	M0_ENTRY("obj=%p size_max=%"PRIu64, obj, size_max);
+	M0_PRE(obj->ob_ra == NULL);
+
+	M0_ALLOC_PTR(ra);
+	if (ra == NULL)
+		return M0_ERR(-ENOMEM);
+	ra->or_obj = obj;
+	ra->or_size_max = size_max / M0_OBJ_RA_WIN_NR;
+	m0_mutex_init(&ra->or_lock);
+	m0_semaphore_init(&ra->or_wake, 0);
+	for (i = 0; i < M0_OBJ_RA_WIN_NR; ++i) {
+		ra->or_win[i].rw_buf = m0_alloc_aligned(ra->or_size_max,
+							M0_NETBUF_SHIFT);
+		if (ra->or_win[i].rw_buf == NULL) {
+			ra_free(ra);
+			return M0_ERR(-ENOMEM);
+		}
+	}
+	rc = M0_THREAD_INIT(&ra->or_thread, struct m0_obj_ra *, NULL,
+			    &ra_thread, ra, "m0_obj_ra");
+	if (rc != 0) {
+		ra_free(ra);
+		return M0_ERR(rc);
+	}
+	obj->ob_ra = ra;
+	return M0_RC(0);
+}
+M0_EXPORTED(m0_obj_ra_enable);
+
+void m0_obj_ra_disable(struct m0_obj *obj)
+{
+	struct m0_obj_ra *ra = obj->ob_ra;
+
+	M0_ENTRY("obj=%p", obj);
+
+	if (ra != NULL) {
+		/* Reads are not launched concurrently with disable. */
+		ra->or_shutdown = true;
+		m0_semaphore_up(&ra->or_wake);
+		m0_thread_join(&ra->or_thread);
+		m0_thread_fini(&ra->or_thread);
+		obj->ob_ra = NULL;
+		ra_free(ra);
+	}
+	M0_LEAVE();
+}
+M0_EXPORTED(m0_obj_ra_disable);
+
+/** @} end of client group */
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -0,0 +1,128 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __MOTR_RA_H__
+#define __MOTR_RA_H__
+
+/**
+ * @defgroup client
+ *
+ * Object read-ahead
+ * -----------------
+ *
+ * Optional per-object read-ahead, enabled by m0_obj_ra_enable(). The stream
+ * of READ operations of the object is sequential when every read starts
+ * where the previous one ended. A sequential read schedules a prefetch of the
+ * following data into a window: a buffer of whole parity groups, filled by a
+ * READ operation launched by the read-ahead thread. There are two windows,
+ * so that the next window is fetched while the current one is consumed. The
+ * window size starts at one parity group and doubles with every sequential
+ * read, up to half of the read-ahead memory limit. A non-sequential read
+ * drops the size back.
+ *
+ * A READ operation that is entirely within a fetched window is served from it
+ * at launch and completes without network i/o.
+ *
+ * Consistency: WRITE and FREE operations of this client drop the windows they
+ * overlap (a window being fetched is dropped when the fetch completes).
+ * Updates by other clients are not seen until the window is consumed and
+ * dropped, as with any client-side cache. Reads with block attributes bypass
+ * the read-ahead.
+ *
+ * @{
+ */
+
+#include "lib/types.h"
+#include "lib/mutex.h"
+#include "lib/semaphore.h"
+#include "lib/thread.h"
+
+struct m0_obj;
+struct m0_op_io;
+
+enum m0_obj_ra_win_state {
+	/** The window holds no data. */
+	RWS_EMPTY,
+	/** The window is being fetched. */
+	RWS_FETCHING,
+	/** Data of the window can be used to serve reads. */
+	RWS_VALID
+};
+
+/** A read-ahead window: a contiguous extent of whole parity groups. */
+struct m0_obj_ra_win {
+	enum m0_obj_ra_win_state rw_state;
+	m0_bindex_t              rw_start;
+	m0_bcount_t              rw_size;
+	/** Overlapped by a write while being fetched. */
+	bool                     rw_stale;
+	char                    *rw_buf;
+};
+
+enum {
+	M0_OBJ_RA_WIN_NR = 2
+};
+
+struct m0_obj_ra {
+	struct m0_obj       *or_obj;
+	/** Protects all fields below except the thread and the semaphore. */
+	struct m0_mutex      or_lock;
+	/** Offset where the next read of a sequential stream starts. */
+	m0_bindex_t          or_next;
+	/** Parity group size, known after the first read. */
+	m0_bcount_t          or_grp;
+	/** Size of the next window. */
+	m0_bcount_t          or_size;
+	/** Size of a window buffer. */
+	m0_bcount_t          or_size_max;
+	struct m0_obj_ra_win or_win[M0_OBJ_RA_WIN_NR];
+	struct m0_thread     or_thread;
+	/** Wakes the read-ahead thread up. */
+	struct m0_semaphore  or_wake;
+	bool                 or_shutdown;
+};
+
+/**
+ * Called at launch of an object i/o operation. Returns true iff the operation
+ * is a READ served from a read-ahead window, in which case it is completed
+ * asynchronously without i/o. Otherwise, schedules prefetches for sequential
+ * reads and drops windows overlapped by writes.
+ */
+M0_INTERNAL bool m0__obj_ra_launch(struct m0_op_io *ioo);
+
+/** @} end of client group */
+#endif /* __MOTR_RA_H__ */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -67,6 +67,7 @@
 #include "stob/linux.h"
 #include "conf/ha.h"            /* m0_conf_ha_process_event_post */
 #include "dtm0/helper.h"        /* m0_dtm0_log_create */
+#include "cas/index_gc.h"       /* m0_cas_gc_rate_set */
 
 /**
    @addtogroup m0d
@@ -502,6 +503,7 @@ cs_buffer_pool_get(struct m0_motr *cctx, struct m0_net_domain *ndom)
    @param tm_colour Unique colour to be assigned to each TM in a domain
    @param recv_queue_min_length Minimum number of buffers in TM receive queue
    @param max_rpc_msg_size Maximum RPC message size
+   @param shards_nr Number of send shards of the rpc machine
    @param reqh Request handler to which the newly created
 		rpc_machine belongs
 
@@ -511,6 +513,7 @@ static int cs_rpc_machine_init(struct m0_motr *cctx, const char *xprt_name,
 			       const char *ep, const uint32_t tm_colour,
 			       const uint32_t recv_queue_min_length,
 			       const uint32_t max_rpc_msg_size,
+			       const uint32_t shards_nr,
 			       struct m0_reqh *reqh)
 {
 	struct m0_rpc_machine        *rpcmach;
@@ -534,8 +537,15 @@ static int cs_rpc_machine_init(struct m0_motr *cctx, const char *xprt_name,
 	rc = m0_rpc_machine_init(rpcmach, ndom, ep,
 				 reqh, buffer_pool, tm_colour, max_rpc_msg_size,
 				 recv_queue_min_length);
-	if (rc != 0)
+	if (rc != 0) {
 		m0_free(rpcmach);
+		return M0_ERR(rc);
+	}
+	rc = m0_rpc_machine_shards_init(rpcmach, shards_nr);
+	if (rc != 0) {
+		m0_rpc_machine_fini(rpcmach);
+		m0_free(rpcmach);
+	}
 	return M0_RC(rc);
 }
 
@@ -555,6 +565,7 @@ static int cs_rpc_machines_init(struct m0_motr *cctx)
 					 ep->ex_endpoint, ep->ex_tm_colour,
 					 rctx->rc_recv_queue_min_length,
 					 rctx->rc_max_rpc_msg_size,
+					 rctx->rc_rpc_shards_nr,
 					 &rctx->rc_reqh);
 		if (rc != 0)
 			return M0_RC(rc);
@@ -1601,6 +1612,8 @@ static int cs_storage_setup(struct m0_motr *cctx)
 					rctx->rc_lru_wm_low,
 					rctx->rc_lru_wm_mid,
 					rctx->rc_lru_wm_high);
+	m0_cas_gc_rate_set(rctx->rc_cas_gc_nodes_per_tx,
+			   rctx->rc_cas_gc_delay);
 
 	rctx->rc_be.but_dom_cfg.bc_engine.bec_reqh = &rctx->rc_reqh;
 
@@ -2302,6 +2315,11 @@ static int _args_parse(struct m0_motr *cctx, int argc, char **argv)
 				{
 					rctx->rc_max_rpc_msg_size = size;
 				})),
+			M0_NUMBERARG('W', "Number of RPC send shards",
+				LAMBDA(void, (int64_t nr)
+				{
+					rctx->rc_rpc_shards_nr = nr;
+				})),
 			/*
 			 * XXX TODO Test the following use case: endpoints are
 			 * specified both via `-e' CLI option and via
@@ -2356,6 +2374,17 @@ static int _args_parse(struct m0_motr *cctx, int argc, char **argv)
 				{
 					rctx->rc_lru_wm_high = high;
 				})),
+			M0_NUMBERARG('1', "Index GC btree nodes per tx",
+				LAMBDA(void, (int64_t nr)
+				{
+					rctx->rc_cas_gc_nodes_per_tx = nr;
+				})),
+			M0_NUMBERARG('2', "Index GC delay between txs, ms",
+				LAMBDA(void, (int64_t t)
+				{
+					rctx->rc_cas_gc_delay =
+						t * M0_TIME_ONE_MSEC;
+				})),
 			);
 	/* generate reqh fid in case it is all-zero */
 	process_fid_generate_conditional(rctx);
@@ -331,6 +331,13 @@ struct m0_reqh_context {
 	 */
 	uint32_t                     rc_max_rpc_msg_size;
 
+	/**
+	 * Number of send shards of each rpc machine, 0 to send packets
+	 * from the formation context.
+	 * @see m0_rpc_machine_shards_init()
+	 */
+	uint32_t                     rc_rpc_shards_nr;
+
 	/** Preallocate an entire stob for db emulation BE segment */
 	bool                         rc_be_seg_preallocate;
 
@@ -353,6 +360,13 @@ struct m0_reqh_context {
 	int64_t                      rc_lru_wm_low;
 	int64_t                      rc_lru_wm_mid;
 	int64_t                      rc_lru_wm_high;
+
+	/**
+	 * Rate of index garbage collection, 0 for defaults.
+	 * @see m0_cas_gc_rate_set()
+	 */
+	m0_bcount_t                  rc_cas_gc_nodes_per_tx;
+	m0_time_t                    rc_cas_gc_delay;
 };
 
 /**
@@ -81,7 +81,7 @@ static int cs_dix_create_sync(struct m0_dix      *index,
 
 	/* XXX Locks sm group of locality0 */
 	m0_cas_req_lock(&req);
-	rc = m0_cas_index_create(&req, &cid, 1, NULL /* XXX */);
+	rc = m0_cas_index_create(&req, &cid, 1, NULL /* XXX */, 0);
 	M0_ASSERT(rc == 0);
 	rc = m0_sm_timedwait(&req.ccr_sm, M0_BITS(CASREQ_FINAL, CASREQ_FAILURE),
 			     M0_TIME_NEVER);
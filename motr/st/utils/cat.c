@@ -65,7 +65,10 @@ static void cat_usage(FILE *file, char *prog_name)
 "  -e, --enable-locks             Enables acquiring and releasing RW locks "
 				 "before and after performing IO.\n"
 "  -b, --blocks-per-io  INT       Number of blocks per IO (>=0). \n%*c "
-				 "Default=100 if 0 or nothing is provided.\n"
+				 "Default: whole parity groups, at most 100 "
+				 "blocks, if 0 or nothing is provided.\n"
+"  -D, --ops-in-flight  INT       Number of IO operations in flight (>0). "
+				 "Default=1.\n"
 "  -r, --read-verify              Verify parity after reading the data.\n"
 "  -S, --msg_size       INT       Max RPC msg size 64k i.e 65536\n"
                                  "%*c Note: this should match with m0d's current "
@@ -103,7 +106,8 @@ int main(int argc, char **argv)
 	rc = m0_read(&container, cat_param.cup_id, dest_fname,
 		          cat_param.cup_block_size, cat_param.cup_block_count,
 			  cat_param.cup_offset,
-			  cat_param.cup_blks_per_io, cat_param.cup_take_locks,
+			  cat_param.cup_blks_per_io, cat_param.cup_ops_nr,
+			  cat_param.cup_take_locks,
 			  cat_param.flags, &cat_param.cup_pver);
 	if (rc < 0) {
 		fprintf(stderr, "m0_read failed! rc = %d\n", rc);
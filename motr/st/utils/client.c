@@ -165,7 +165,7 @@ int main(int argc, char **argv)
 				continue;
 			rc = m0_read(&container, id, fname,
 				     block_size, block_count, offset,
-				     blocks_per_io,
+				     blocks_per_io, 1,
 				     params.cup_take_locks,
 				     0, NULL);
 		} else if (strcmp(arg, "write") == 0) {
@@ -195,7 +195,7 @@ int main(int argc, char **argv)
 				continue;
 			rc = m0_write(&container, fname, id,
 				      block_size, block_count, offset,
-				      blocks_per_io, params.cup_take_locks,
+				      blocks_per_io, 1, params.cup_take_locks,
 				      update_flag);
 		} else if (strcmp(arg, "touch") == 0) {
 			GET_ARG(arg, NULL, &saveptr);
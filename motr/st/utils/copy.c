@@ -68,7 +68,10 @@ static void copy_usage(FILE *file, char *prog_name)
 "  -e, --enable-locks             Enables acquiring and releasing RW locks "
 				 "before and after performing IO.\n"
 "  -b, --blocks-per-io  INT       Number of blocks (>=0) per IO. "
-				 "Default=100 if 0 or nothing is provided.\n"
+				 "Default: whole parity groups, at most 100 "
+				 "blocks,\n%*c if 0 or nothing is provided.\n"
+"  -D, --ops-in-flight  INT       Number of IO operations in flight (>0). "
+				 "Default=1.\n"
 "  -O, --offset         INT       Updates the exisiting object from given "
 				 "offset.\n%*c Default=0 if not provided. "
 				 "Offset should be multiple of 4k.\n"
@@ -78,7 +81,8 @@ static void copy_usage(FILE *file, char *prog_name)
 "  -q, --min_queue      INT       Minimum length of the receive queue i.e 16\n"
 "  -u, --update_mode              Object update mode\n"
 "  -h, --help                     Shows this help text and exit.\n"
-, prog_name, WIDTH, ' ', WIDTH, ' ', WIDTH, ' ', WIDTH, ' ', WIDTH, ' ');
+, prog_name, WIDTH, ' ', WIDTH, ' ', WIDTH, ' ', WIDTH, ' ', WIDTH, ' ',
+WIDTH, ' ');
 }
 
 int main(int argc, char **argv)
@@ -112,7 +116,8 @@ int main(int argc, char **argv)
 	rc = m0_write(&container, cp_param.cup_file,
 		      cp_param.cup_id, cp_param.cup_block_size,
 		      cp_param.cup_block_count, cp_param.cup_offset,
-		      cp_param.cup_blks_per_io, cp_param.cup_take_locks,
+		      cp_param.cup_blks_per_io, cp_param.cup_ops_nr,
+		      cp_param.cup_take_locks,
 		      cp_param.cup_update_mode);
 	if (rc < 0) {
 		if (rc == -EEXIST) {
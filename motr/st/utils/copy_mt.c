@@ -52,6 +52,7 @@ static void copy_thread_launch(struct m0_copy_mt_args *args)
 				       args->cma_utility->cup_block_count,
 				       args->cma_utility->cup_offset,
 				       args->cma_utility->cup_blks_per_io,
+				       args->cma_utility->cup_ops_nr,
 				       false,
 				       args->cma_utility->cup_update_mode);
 }
@@ -76,8 +77,11 @@ static void copy_mt_usage(FILE *file, char *prog_name)
 				 "suffix b/k/m/g/K/M/G.\n%*c Ex: 1k=1024, "
 				 "1m=1024*1024, 1K=1000 1M=1000*1000.\n"
 "  -L, --layout-id      INT       Layout ID, Range: [1-14].\n"
-"  -b, --blocks-per-io  INT       Number of blocks (>=0) per IO. Default=100 "
+"  -b, --blocks-per-io  INT       Number of blocks (>=0) per IO. Default: "
+				 "whole parity groups, at most 100 blocks, "
 				 "if 0 or nothing is provided.\n"
+"  -D, --ops-in-flight  INT       Number of IO operations in flight per "
+				 "object (>0). Default=1.\n"
 "  -O, --offset  INT              Updates the exisiting object from given "
 				 "offset. \n%*c Default=0 if not provided. "
 				 "Offset should be multiple of 4k.\n"
@@ -35,6 +35,8 @@
 #include "motr/idx.h"
 #include "motr/st/utils/helper.h"
 #include "lib/getopts.h"
+#include "lib/memory.h"             /* M0_ALLOC_ARR */
+#include "pool/pool.h"              /* m0_pool_version_find */
 #include "motr/client_internal.h"
 
 extern struct m0_addb_ctx m0_addb_ctx;
@@ -349,15 +351,119 @@ init_error:
 	return rc;
 }
 
+/**
+ * Blocks per operation when not given by the user: as many whole parity
+ * groups as fit into M0_MAX_BLOCK_COUNT blocks, so that writes do not need
+ * read-modify-write of the groups.
+ */
+static int blks_per_io_tune(struct m0_obj *obj, uint32_t block_size)
+{
+	struct m0_client       *instance = m0__obj_instance(obj);
+	struct m0_pool_version *pv;
+	uint64_t                max = (uint64_t)M0_MAX_BLOCK_COUNT * block_size;
+	uint64_t                grp;
+
+	if (m0__obj_layout_type(obj) != M0_LT_PDCLUST)
+		return M0_MAX_BLOCK_COUNT;
+	pv = m0_pool_version_find(&instance->m0c_pools_common,
+				  &obj->ob_attr.oa_pver);
+	if (pv == NULL)
+		return M0_MAX_BLOCK_COUNT;
+	grp = (uint64_t)m0_obj_layout_id_to_unit_size(obj->ob_attr.oa_layout_id)
+		* pv->pv_attr.pa_N;
+	if (grp == 0 || grp % block_size != 0 || grp > max)
+		return M0_MAX_BLOCK_COUNT;
+	return max / grp * grp / block_size;
+}
+
+/** An operation of a pipeline and its buffers. */
+struct io_slot {
+	struct m0_indexvec  is_ext;
+	struct m0_bufvec    is_data;
+	struct m0_bufvec    is_attr;
+	/** Number of blocks of the vectors, 0 if not allocated. */
+	uint32_t            is_nr;
+	/** Launched operation, NULL if none. */
+	struct m0_op       *is_op;
+};
+
+/** Prepares the slot for the next bcount blocks starting at *last_index. */
+static int slot_prepare(struct io_slot *slot, uint32_t bcount,
+			uint32_t block_size, uint64_t *last_index)
+{
+	int rc;
+
+	M0_PRE(slot->is_op == NULL);
+
+	if (slot->is_nr != bcount) {
+		if (slot->is_nr != 0)
+			cleanup_vecs(&slot->is_data, &slot->is_attr,
+				     &slot->is_ext);
+		slot->is_nr = 0;
+		rc = alloc_vecs(&slot->is_ext, &slot->is_data, &slot->is_attr,
+				bcount, block_size);
+		if (rc != 0)
+			return rc;
+		slot->is_nr = bcount;
+	}
+	prepare_ext_vecs(&slot->is_ext, &slot->is_attr, bcount, block_size,
+			 last_index);
+	return 0;
+}
+
+static int slot_launch(struct io_slot *slot, struct m0_obj *obj,
+		       enum m0_obj_opcode opcode, uint32_t flags)
+{
+	int rc;
+
+	/** CKSUM_TODO: calculate cksum and pass in attr instead of NULL */
+	rc = m0_obj_op(obj, opcode, &slot->is_ext, &slot->is_data, NULL, 0,
+		       flags, &slot->is_op);
+	if (rc != 0)
+		return M0_ERR(rc);
+	m0_op_launch(&slot->is_op, 1);
+	return 0;
+}
+
+static int slot_wait(struct io_slot *slot)
+{
+	int rc;
+
+	M0_PRE(slot->is_op != NULL);
+
+	rc = m0_op_wait(slot->is_op, M0_BITS(M0_OS_FAILED, M0_OS_STABLE),
+			M0_TIME_NEVER);
+	if (rc == 0)
+		rc = m0_rc(slot->is_op);
+	m0_op_fini(slot->is_op);
+	m0_op_free(slot->is_op);
+	slot->is_op = NULL;
+	return rc;
+}
+
+static void slots_fini(struct io_slot *slots, int nr)
+{
+	int i;
+
+	for (i = 0; i < nr; ++i) {
+		if (slots[i].is_op != NULL)
+			(void)slot_wait(&slots[i]);
+		if (slots[i].is_nr != 0)
+			cleanup_vecs(&slots[i].is_data, &slots[i].is_attr,
+				     &slots[i].is_ext);
+	}
+	m0_free(slots);
+}
+
 int m0_write(struct m0_container *container, char *src,
 	     struct m0_uint128 id, uint32_t block_size,
 	     uint32_t block_count, uint64_t update_offset,
-	     int blks_per_io, bool take_locks, bool update_mode)
+	     int blks_per_io, int ops_nr, bool take_locks, bool update_mode)
 {
 	int                           rc;
-	struct m0_indexvec            ext;
-	struct m0_bufvec              data;
-	struct m0_bufvec              attr;
+	int                           i;
+	struct io_slot               *slots;
+	struct io_slot               *slot;
 	uint32_t                      bcount;
 	uint64_t                      last_index;
 	FILE                         *fp;
@@ -394,38 +500,49 @@ int m0_write(struct m0_container *container, char *src,
 	last_index = update_offset;
 
 	if (blks_per_io == 0)
-		blks_per_io = M0_MAX_BLOCK_COUNT;
+		blks_per_io = blks_per_io_tune(&obj, block_size);
+	if (ops_nr <= 0)
+		ops_nr = 1;
 
-	rc = alloc_vecs(&ext, &data, &attr, blks_per_io, block_size);
-	if (rc != 0)
+	M0_ALLOC_ARR(slots, ops_nr);
+	if (slots == NULL) {
+		rc = -ENOMEM;
 		goto cleanup;
-
-	while (block_count > 0) {
-		bcount = (block_count > blks_per_io)?
-			  blks_per_io:block_count;
-		if (bcount < blks_per_io) {
-			cleanup_vecs(&data, &attr, &ext);
-			rc = alloc_vecs(&ext, &data, &attr, bcount,
-					block_size);
+	}
+	/*
+	 * Up to ops_nr writes are in flight. A slot is reused when its
+	 * previous write completes, the oldest one first.
+	 */
+	for (i = 0; block_count > 0; i = (i + 1) % ops_nr) {
+		slot = &slots[i];
+		if (slot->is_op != NULL) {
+			rc = slot_wait(slot);
 			if (rc != 0)
-				goto cleanup;
+				break;
 		}
-		prepare_ext_vecs(&ext, &attr, bcount,
-				 block_size, &last_index);
+		bcount = (block_count > blks_per_io)?
+			  blks_per_io:block_count;
+		rc = slot_prepare(slot, bcount, block_size, &last_index);
+		if (rc != 0)
+			break;
 
 		/* Read data from source file. */
-		rc = read_data_from_file(fp, &data);
+		rc = read_data_from_file(fp, &slot->is_data);
 		M0_ASSERT(rc == bcount);
 
 		/* Copy data to the object*/
-		rc = write_data_to_object(&obj, &ext, &data, NULL);
-		if (rc != 0) {
-			fprintf(stderr, "Writing to object failed!\n");
+		rc = slot_launch(slot, &obj, M0_OC_WRITE, 0);
+		if (rc != 0)
 			break;
-		}
 		block_count -= bcount;
 	}
-	cleanup_vecs(&data, &attr, &ext);
+	for (i = 0; i < ops_nr; ++i) {
+		if (slots[i].is_op != NULL)
+			rc = slot_wait(&slots[i]) ?: rc;
+	}
+	if (rc != 0)
+		fprintf(stderr, "Writing to object failed!\n");
+	slots_fini(slots, ops_nr);
 	/* fini and release */
 cleanup:
 	lock_ops->olo_lock_put(&req);
@@ -437,36 +554,51 @@ init_error:
 	return rc;
 }
 
-static int read_data_from_object(struct m0_obj *obj,
-				 struct m0_indexvec *ext,
-				 struct m0_bufvec *data,
-				 struct m0_bufvec *attr,
-				 uint32_t flags)
+/** Writes the data read by a slot to the destination file or stdout. */
+static int data_emit(FILE *fp, struct m0_bufvec *data, uint32_t bcount,
+		     uint32_t block_size)
 {
-	int                  rc;
-	struct m0_op        *ops[1] = {NULL};
-
-	/* Create read operation */
-	rc = m0_obj_op(obj, M0_OC_READ, ext, data, attr, 0, flags, &ops[0]);
-	if (rc != 0)
-		return M0_ERR(rc);
+	uint64_t bytes_read = 0;
+	int      i;
+	int      j;
 
-	m0_op_launch(ops, 1);
-	rc = m0_op_wait(ops[0], M0_BITS(M0_OS_FAILED,
-					M0_OS_STABLE), M0_TIME_NEVER);
-	if (rc == 0)
-		rc = m0_rc(ops[0]);
+	if (fp != NULL) {
+		for (i = 0; i < bcount; ++i) {
+			bytes_read += fwrite(data->ov_buf[i], sizeof(char),
+					     data->ov_vec.v_count[i], fp);
+		}
+		if (bytes_read != bcount * block_size) {
+			fprintf(stderr, "Writing to destination "
+				"file failed!\n");
+			return -EIO;
+		}
+	} else {
+		/* putchar the output */
+		for (i = 0; i < bcount; ++i) {
+			for (j = 0; j < data->ov_vec.v_count[i]; ++j)
+				putchar(((char *)data->ov_buf[i])[j]);
+		}
+	}
+	return 0;
+}
 
-	m0_op_fini(ops[0]);
-	m0_op_free(ops[0]);
+/** Waits for the read of the slot and writes its data out. */
+static int slot_read_done(struct io_slot *slot, FILE *fp, uint32_t block_size)
+{
+	int rc;
 
-	return rc;
+	rc = slot_wait(slot);
+	if (rc != 0) {
+		fprintf(stderr, "Reading from object failed!\n");
+		return rc;
+	}
+	return data_emit(fp, &slot->is_data, slot->is_nr, block_size);
 }
 
 int m0_read(struct m0_container *container,
 	    struct m0_uint128 id, char *dest,
 	    uint32_t block_size, uint32_t block_count,
-	    uint64_t offset, int blks_per_io, bool take_locks,
+	    uint64_t offset, int blks_per_io, int ops_nr, bool take_locks,
 	    uint32_t flags, struct m0_fid *read_pver)
 {
 	int                           i;
@@ -474,15 +606,13 @@ int m0_read(struct m0_container *container,
 	int                           rc;
 	uint64_t                      last_index = 0;
 	struct m0_obj                 obj;
-	struct m0_indexvec            ext;
-	struct m0_bufvec              data;
-	struct m0_bufvec              attr;
+	struct io_slot               *slots;
+	struct io_slot               *slot;
 	FILE                         *fp = NULL;
 	struct m0_client             *instance;
 	struct m0_rm_lock_req         req;
 	uint32_t                      bcount;
 	const struct m0_obj_lock_ops *lock_ops;
-	uint64_t                      bytes_read;
 
 	lock_ops = take_locks ? &lock_enabled_ops : &lock_disabled_ops;
 
@@ -522,55 +652,50 @@ int m0_read(struct m0_container *container,
 	last_index = offset;
 
 	if (blks_per_io == 0)
-		blks_per_io = M0_MAX_BLOCK_COUNT;
-	rc = alloc_vecs(&ext, &data, &attr, blks_per_io, block_size);
-	if (rc != 0)
+		blks_per_io = blks_per_io_tune(&obj, block_size);
+	if (ops_nr <= 0)
+		ops_nr = 1;
+
+	M0_ALLOC_ARR(slots, ops_nr);
+	if (slots == NULL) {
+		rc = -ENOMEM;
 		goto cleanup;
-	while (block_count > 0) {
-		bytes_read = 0;
-		bcount = (block_count > blks_per_io) ?
-			  blks_per_io : block_count;
-		if (bcount < blks_per_io) {
-			cleanup_vecs(&data, &attr, &ext);
-			rc = alloc_vecs(&ext, &data, &attr, bcount,
-					block_size);
+	}
+	/*
+	 * Up to ops_nr reads are in flight. The data are written out in the
+	 * order of offsets: a slot is reused after its previous read, always
+	 * the oldest one, completes and its data are written.
+	 */
+	for (i = 0; block_count > 0; i = (i + 1) % ops_nr) {
+		slot = &slots[i];
+		if (slot->is_op != NULL) {
+			rc = slot_read_done(slot, fp, block_size);
 			if (rc != 0)
-				goto cleanup;
+				break;
 		}
-		prepare_ext_vecs(&ext, &attr, bcount,
-				 block_size, &last_index);
+		bcount = (block_count > blks_per_io) ?
+			  blks_per_io : block_count;
+		rc = slot_prepare(slot, bcount, block_size, &last_index);
+		if (rc != 0)
+			break;
 
 		if (block_count == bcount)
 			flags |= M0_OOF_LAST;
 
-		rc = read_data_from_object(&obj, &ext, &data, NULL, flags);
+		rc = slot_launch(slot, &obj, M0_OC_READ, flags);
 		if (rc != 0) {
 			fprintf(stderr, "Reading from object failed!\n");
 			break;
 		}
-
-		if (fp != NULL) {
-			for (i = 0; i < bcount; ++i) {
-				bytes_read += fwrite(data.ov_buf[i], sizeof(char),
-					    data.ov_vec.v_count[i], fp);
-			}
-			if (bytes_read != bcount * block_size) {
-				rc = -EIO;
-				fprintf(stderr, "Writing to destination "
-					"file failed!\n");
-				break;
-			}
-		} else {
-			/* putchar the output */
-			for (i = 0; i < bcount; ++i) {
-				for (j = 0; j < data.ov_vec.v_count[i]; ++j)
-					putchar(((char *)data.ov_buf[i])[j]);
-			}
-		}
 		block_count -= bcount;
 	}
-
-	cleanup_vecs(&data, &attr, &ext);
+	/* Reads still in flight, from the oldest. */
+	for (j = 0; j < ops_nr && rc == 0; ++j) {
+		slot = &slots[(i + j) % ops_nr];
+		if (slot->is_op != NULL)
+			rc = slot_read_done(slot, fp, block_size);
+	}
+	slots_fini(slots, ops_nr);
 
 cleanup:
 	if (fp != NULL) {
@@ -931,6 +1056,7 @@ int m0_utility_args_init(int argc, char **argv,
 	params->cup_take_locks = false;
 	params->cup_update_mode = false;
 	params->cup_offset = 0;
+	params->cup_ops_nr = 1;
 	params->flags = 0;
 	conf->mc_is_read_verify = false;
 	conf->mc_tm_recv_queue_min_len = M0_NET_TM_RECV_QUEUE_DEF_LEN;
@@ -961,6 +1087,7 @@ int m0_utility_args_init(int argc, char **argv,
 				{"msg_size",      required_argument, NULL, 'S'},
 				{"min_queue",     required_argument, NULL, 'q'},
 				{"blks-per-io",   required_argument, NULL, 'b'},
+				{"ops-in-flight", required_argument, NULL, 'D'},
 				{"offset",        required_argument, NULL, 'O'},
 				{"update_mode",   no_argument,       NULL, 'u'},
 				{"enable-locks",  no_argument,       NULL, 'e'},
@@ -969,7 +1096,7 @@ int m0_utility_args_init(int argc, char **argv,
 				{"help",          no_argument,       NULL, 'h'},
 				{0,               0,                 0,     0 }};
 
-        while ((c = getopt_long(argc, argv, ":l:H:p:P:o:s:c:i:t:L:v:n:S:q:b:O:uerzh",
+        while ((c = getopt_long(argc, argv, ":l:H:p:P:o:s:c:i:t:L:v:n:S:q:b:D:O:uerzh",
 				l_opts, &option_index)) != -1)
 	{
 		switch (c) {
@@ -1018,6 +1145,17 @@ int m0_utility_args_init(int argc, char **argv,
 					exit(EXIT_FAILURE);
 				  }
 				  continue;
+			case 'D': if ((params->cup_ops_nr = atoi(optarg)) <= 0)
+				  {
+					fprintf(stderr, "Invalid value "
+							"for option -%c. "
+							"Operations in flight "
+							"should be (> 0)\n", c);
+					utility_usage(stderr,
+						      basename(argv[0]));
+					exit(EXIT_FAILURE);
+				  }
+				  continue;
 			case 'i':
 			case 'c': if (m0_bcount_get(optarg,
 						    &params->cup_block_count) ==
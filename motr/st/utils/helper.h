@@ -71,6 +71,8 @@ struct m0_utility_param {
 	uint64_t          cup_trunc_len;
 	char             *cup_file;
 	int               cup_blks_per_io;
+	/** Number of object operations in flight. */
+	int               cup_ops_nr;
 	bool              cup_update_mode;
 	struct m0_fid     cup_pver;
 	uint32_t          flags;
@@ -118,12 +120,13 @@ int touch(struct m0_container *container,
 int m0_write(struct m0_container *container,
 	     char *src, struct m0_uint128 id, uint32_t block_size,
 	     uint32_t block_count, uint64_t update_offset, int blks_per_io,
-	     bool take_locks, bool update_mode);
+	     int ops_nr, bool take_locks, bool update_mode);
 
 int m0_read(struct m0_container *container,
 	    struct m0_uint128 id, char *dest, uint32_t block_size,
 	    uint32_t block_count, uint64_t offset, int blks_per_io,
-	    bool take_locks, uint32_t flags, struct m0_fid *read_pver);
+	    int ops_nr, bool take_locks, uint32_t flags,
+	    struct m0_fid *read_pver);
 
 int m0_truncate(struct m0_container *container,
 		struct m0_uint128 id, uint32_t block_size,
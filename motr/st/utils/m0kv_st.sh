@@ -50,6 +50,8 @@ keys_bulk_file="${SANDBOX_DIR}/keys_bulk.txt"
 vals_file="${SANDBOX_DIR}/vals.txt"
 vals_bulk_file="${SANDBOX_DIR}/vals_bulk.txt"
 fids_file="${SANDBOX_DIR}/fids.txt"
+dump_keys_file="${SANDBOX_DIR}/dump_keys.txt"
+dump_vals_file="${SANDBOX_DIR}/dump_vals.txt"
 
 genf="genf ${num} ${fids_file}"
 genv_bulk="genv ${num} ${large_size} ${vals_bulk_file}"
@@ -112,6 +114,7 @@ function usage()
 	echo "    'bgetsN'        get several key-values from index (batch)"
 	echo "    'nextsN'        get next key-values from index"
 	echo "    'bnextsN'       get next key-values from index (batch)"
+	echo "    'bulkN'         bulkput, bulkget and dump an index"
 	echo "    'dels1'         delete key from index"
 	echo "    'bdels1'        delete key from index (batch)"
 	echo "    'delsN'         delete keys from index"
@@ -607,6 +610,30 @@ bdelmN()
 	return $rc
 }
 
+bulkN()
+{
+	local rc=0
+	echo "Test:Bulk put, get and dump"
+	emsg="FAILED to bulk load/dump @keys:${keys_file} @vals:${vals_file} with ${fid}"
+	${MOTRTOOL} ${dropf} ${create} ${bulkput} >${out_file}
+	rc=$?
+	[ $rc != 0 ] && return $rc
+	grep -q "bulkput done, rc: 0" ${out_file} || return 1
+	${MOTRTOOL} ${bulkget} >${out_file}
+	rc=$?
+	[ $rc != 0 ] && return $rc
+	cmp -s ${vals_file} ${res_out_file} || return 1
+	${MOTRTOOL} ${dump} >${out_file}
+	rc=$?
+	[ $rc != 0 ] && return $rc
+	# The dump is sorted by key, keys are equal to values in this test.
+	[ "$(sort ${keys_file})" == "$(sort ${dump_keys_file})" ] || return 1
+	cmp -s ${dump_keys_file} ${dump_vals_file} || return 1
+	rm -f ${dump_keys_file} ${dump_vals_file}
+	rm_logs
+	return $rc
+}
+
 st_init()
 {
 	# generate source files for KEYS, VALS, FIDS
@@ -642,6 +669,10 @@ st_init()
 
 	next="next \"${fid}\" ${key} 10"
 
+	bulkput="bulkput \"${fid}\" ${keys_file} ${vals_file} 3 4"
+	bulkget="bulkget \"${fid}\" ${keys_file} ${res_out_file} 3 4"
+	dump="dump \"${fid}\" ${dump_keys_file} ${dump_vals_file} 3 4"
+
 	lookup="lookup \"${fid}\""
 	lookups="lookup @${fids_file}"
 
@@ -788,6 +819,7 @@ if [ ${#tests_list[@]} -eq 0 ]; then
 				bgetsN
 				nextsN
 				bnextsN
+				bulkN
 				dels1
 				bdels1
 				delsN
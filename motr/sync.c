@@ -24,6 +24,7 @@
 #include "motr/client.h"
 #include "motr/client_internal.h"
 #include "motr/sync.h"               /* sync_interactions */
+#include "motr/wbc.h"                /* m0__obj_wbc_flush_all */
 
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_CLIENT
 #include "lib/trace.h"
@@ -78,6 +79,14 @@
  *     is straightforward. For dix, an function pointer
  *     m0_dix_cli::dx_sync_rec_update is added and client related information
  *     (entity and op) is passed to dix via m0_dix_req::dr_sync_datum.
+ *
+ * (7) Concurrent SYNC requests to a service are coalesced. An FSYNC fop asks
+ *     for the largest pending txid of the service (sc_max_pending_tx), so its
+ *     reply covers all transactions of the service this client waits for.
+ *     The first such fop becomes the fop in flight of the service
+ *     (m0_reqh_service_ctx::sc_fsync_txid). Blocking SYNC requests
+ *     (m0_entity_sync(), m0_sync()) for smaller txids wait for its reply
+ *     instead of sending their own fops, see sync_fop_shared_wait().
  */
 
 static const struct m0_bob_type os_bobtype;
@@ -261,6 +270,48 @@ static void sync_fop_stx_update(struct m0_reqh_service_txid *stx,
 	 */
 }
 
+/**
+ * Updates stx of the service in all targets of an SYNC request and in the
+ * Client instance, after txid of the service is known to be logged.
+ */
+static void sync_request_targets_update(struct sync_request        *sreq,
+					struct m0_reqh_service_ctx *service,
+					uint64_t                    txid)
+{
+	struct m0_reqh_service_txid *stx;
+	struct m0_tl                *pending_tx_tl;
+	struct m0_mutex             *pending_tx_lock;
+	struct m0_entity            *ent;
+	struct m0_op                *op;
+	struct sync_target          *tgt;
+
+	/* Update matched stx in all targets of an SYNC request. */
+	m0_tl_for(sync_target, &sreq->sr_targets, tgt) {
+		if (tgt->srt_type == SYNC_ENTITY) {
+			ent = tgt->u.srt_ent;
+			pending_tx_tl = &ent->en_pending_tx;
+			pending_tx_lock = &ent->en_pending_tx_lock;
+		} else if (tgt->srt_type == SYNC_OP) {
+			op = tgt->u.srt_op;
+			pending_tx_tl = &op->op_pending_tx;
+			pending_tx_lock = &op->op_pending_tx_lock;
+		} else
+			M0_IMPOSSIBLE("SYNC type not supported yet.");
+
+		m0_mutex_lock(pending_tx_lock);
+		stx = m0_tl_find(spti, stx, pending_tx_tl,
+				 stx->stx_service_ctx == service);
+		if (stx != NULL)
+			sync_fop_stx_update(stx, txid);
+		m0_mutex_unlock(pending_tx_lock);
+	} m0_tl_endfor;
+
+	/* Updates Client instance wide stx. */
+	m0_mutex_lock(&service->sc_max_pending_tx_lock);
+	sync_fop_stx_update(&service->sc_max_pending_tx, txid);
+	m0_mutex_unlock(&service->sc_max_pending_tx_lock);
+}
+
 /**
  * Processes a reply to an fsync fop.
  */
@@ -272,14 +323,7 @@ static int sync_reply_process(struct sync_fop_wrapper *sfw)
 	struct m0_fop_fsync         *ffd;
 	struct m0_fop_fsync_rep     *ffr;
 	struct m0_rpc_item          *item;
-	struct m0_reqh_service_ctx  *service;
-	struct m0_reqh_service_txid *stx;
-	struct m0_tl                *pending_tx_tl;
-	struct m0_mutex             *pending_tx_lock;
-	struct m0_entity            *ent;
-	struct m0_op                *op;
 	struct sync_request         *sreq;
-	struct sync_target          *tgt;
 
 	M0_ENTRY();
 
@@ -318,36 +362,66 @@ static int sync_reply_process(struct sync_fop_wrapper *sfw)
 
 	/* Update the stx stored in sfw to avoid sending repeated fops. */
 	sync_fop_stx_update(sfw->sfw_stx, reply_txid);
+	sync_request_targets_update(sreq, sfw->sfw_stx->stx_service_ctx,
+				    reply_txid);
 
-	/* Update matched stx in all targets of an SYNC request. */
-	service = sfw->sfw_stx->stx_service_ctx;
-	m0_tl_for(sync_target, &sreq->sr_targets, tgt) {
-		if (tgt->srt_type == SYNC_ENTITY) {
-			ent = tgt->u.srt_ent;
-			pending_tx_tl = &ent->en_pending_tx;
-			pending_tx_lock = &ent->en_pending_tx_lock;
-		} else if (tgt->srt_type == SYNC_OP) {
-			op = tgt->u.srt_op;
-			pending_tx_tl = &op->op_pending_tx;
-			pending_tx_lock = &op->op_pending_tx_lock;
-		} else
-			M0_IMPOSSIBLE("SYNC type not supported yet.");
+out:
+	return M0_RC(rc);
+}
 
-		m0_mutex_lock(pending_tx_lock);
-		stx = m0_tl_find(spti, stx, pending_tx_tl,
-				 stx->stx_service_ctx == service);
-		if (stx != NULL)
-			sync_fop_stx_update(stx, reply_txid);
-		m0_mutex_unlock(pending_tx_lock);
-	} m0_tl_endfor;
+/**
+ * Wakes up SYNC requests waiting for the FSYNC fop of sfw, if it is the fop
+ * in flight of its service.
+ */
+static void sync_fop_unshare(struct sync_fop_wrapper *sfw, int rc)
+{
+	struct m0_reqh_service_ctx *service = sfw->sfw_stx->stx_service_ctx;
 
-	/* Updates Client instance wide stx. */
+	if (!sfw->sfw_shared)
+		return;
 	m0_mutex_lock(&service->sc_max_pending_tx_lock);
-	sync_fop_stx_update(&service->sc_max_pending_tx, reply_txid);
+	service->sc_fsync_txid = 0;
+	service->sc_fsync_rc = rc;
+	++service->sc_fsync_gen;
+	m0_chan_broadcast(&service->sc_fsync_chan);
 	m0_mutex_unlock(&service->sc_max_pending_tx_lock);
+	sfw->sfw_shared = false;
+}
 
-out:
-	return M0_RC(rc);
+/**
+ * Waits for the FSYNC fop in flight to the service, if it asks for txid or
+ * a later transaction.
+ *
+ * The caller must not have a shared fop in flight to the service itself.
+ *
+ * @return true if the fop succeeded, so that txid is logged.
+ */
+static bool sync_fop_shared_wait(struct m0_reqh_service_ctx *service,
+				 uint64_t                    txid)
+{
+	struct m0_clink clink;
+	uint64_t        gen;
+	bool            synced;
+
+	m0_mutex_lock(&service->sc_max_pending_tx_lock);
+	if (service->sc_fsync_txid < txid) {
+		m0_mutex_unlock(&service->sc_max_pending_tx_lock);
+		return false;
+	}
+	gen = service->sc_fsync_gen;
+	m0_clink_init(&clink, NULL);
+	m0_clink_add(&service->sc_fsync_chan, &clink);
+	while (service->sc_fsync_gen == gen) {
+		m0_mutex_unlock(&service->sc_max_pending_tx_lock);
+		m0_chan_wait(&clink);
+		m0_mutex_lock(&service->sc_max_pending_tx_lock);
+	}
+	/* Another fop could be replied in the meantime, don't rely on it. */
+	synced = service->sc_fsync_gen == gen + 1 && service->sc_fsync_rc == 0;
+	m0_clink_del(&clink);
+	m0_mutex_unlock(&service->sc_max_pending_tx_lock);
+	m0_clink_fini(&clink);
+	return synced;
 }
 
 /**
@@ -366,6 +440,7 @@ static void sync_fop_ast(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 
 	sfw = M0_AMB(sfw, ast, sfw_ast);
 	rc = sync_reply_process(sfw);
+	sync_fop_unshare(sfw, rc);
 	sync_fop_done(sfw, rc);
 
 	M0_LEAVE();
@@ -420,6 +495,7 @@ int sync_request_fop_send(struct sync_request         *sreq,
 	struct m0_fop_fsync            *ffd;
 	struct m0_fop_type             *fopt;
 	struct sync_fop_wrapper        *sfw;
+	struct m0_reqh_service_ctx     *service = stx->stx_service_ctx;
 
 	M0_ENTRY();
 
@@ -456,8 +532,18 @@ int sync_request_fop_send(struct sync_request         *sreq,
 	}
 
 	ffd = m0_fop_data(fop);
-	ffd->ff_be_remid = stx->stx_tri;
 	ffd->ff_fsync_mode = mode;
+	m0_mutex_lock(&service->sc_max_pending_tx_lock);
+	ffd->ff_be_remid = stx->stx_tri;
+	/* Covers all transactions of the service this client waits for. */
+	if (service->sc_max_pending_tx.stx_tri.tri_txid >
+	    stx->stx_tri.tri_txid)
+		ffd->ff_be_remid = service->sc_max_pending_tx.stx_tri;
+	if (service->sc_fsync_txid == 0) {
+		service->sc_fsync_txid = ffd->ff_be_remid.tri_txid;
+		sfw->sfw_shared = true;
+	}
+	m0_mutex_unlock(&service->sc_max_pending_tx_lock);
 
 	/*
 	 *  Posts the rpc_item directly so that this is asyncronous.
@@ -473,6 +559,7 @@ int sync_request_fop_send(struct sync_request         *sreq,
 
 	rc = si.si_post_rpc(item);
 	if (rc != 0) {
+		sync_fop_unshare(sfw, rc);
 		si.si_fop_fini(fop);
 		return M0_ERR_INFO(rc, "Calling m0_rpc_post() failed.");
 	}
@@ -491,6 +578,7 @@ static int sync_request_launch(struct sync_request *sreq,
 {
 	int                             rc;
 	int                             saved_error = 0;
+	int                             nr_covered = 0;
 	struct m0_reqh_service_txid    *iter;
 	struct sync_fop_wrapper        *sfw = NULL;
 	struct m0_tl                   *stx_tl;
@@ -500,12 +588,31 @@ static int sync_request_launch(struct sync_request *sreq,
 	if (M0_FI_ENABLED("launch_failed"))
 		return M0_ERR(-EAGAIN);
 
+	stx_tl = &sreq->sr_stxs;
+	/*
+	 * A blocking request piggybacks on FSYNC fops already in flight.
+	 * It's done before any fop of this request is sent, so that the
+	 * request never waits for its own fops.
+	 */
+	if (wait_after_launch) {
+		m0_tl_for(spti, stx_tl, iter) {
+			if (iter->stx_tri.tri_txid == 0 ||
+			    !sync_fop_shared_wait(iter->stx_service_ctx,
+						  iter->stx_tri.tri_txid))
+				continue;
+			sync_request_targets_update(sreq,
+						    iter->stx_service_ctx,
+						    iter->stx_tri.tri_txid);
+			M0_SET0(&iter->stx_tri);
+			nr_covered++;
+		} m0_tl_endfor;
+	}
+
 	/*
 	 * Finds the services with pending transactions for each entry,
 	 * send an fsync fop. This is the fop sending loop.
 	 */
 	m0_mutex_lock(&sreq->sr_fops_lock);
-	stx_tl = &sreq->sr_stxs;
 	m0_tl_for(spti, stx_tl, iter) {
 		/*
 		 * Sends an fsync fop for
@@ -539,10 +646,13 @@ static int sync_request_launch(struct sync_request *sreq,
 	 * client to update its records on FSYNC.
 	 *
 	 * Returns saved_error directly only if no fops are sent, otherwise the
-	 * error is stored in sync_request::sr_rc.
+	 * error is stored in sync_request::sr_rc. Returns 1 if no fops are
+	 * sent as all transactions are logged by fops of other requests.
 	 */
 	if (sreq->sr_nr_fops == 0) {
-		if (saved_error == 0)
+		if (saved_error == 0 && nr_covered > 0)
+			rc = 1;
+		else if (saved_error == 0)
 			/*
 			 * It may happen when there are no pending txid. For
 			 * example, sync op is launched even before
@@ -582,6 +692,7 @@ static int sync_reply_wait(struct sync_fop_wrapper *sfw)
 	rc = sync_reply_process(sfw);
 
 out:
+	sync_fop_unshare(sfw, rc);
 	si.si_fop_put(fop);
 
 	return M0_RC(rc);
@@ -614,7 +725,9 @@ static int sync_request_launch_and_wait(struct sync_request *sreq,
 	 * returning.
 	 */
 	rc = sync_request_launch(sreq, mode, true);
-	if (rc != 0)
+	if (rc == 1)
+		return M0_RC(0);
+	else if (rc != 0)
 		return M0_ERR(rc);
 
 	/* This is the fop-reply receiving loop. */
@@ -1068,6 +1181,13 @@ int m0_entity_sync(struct m0_entity *ent)
 	M0_ENTRY();
 	M0_PRE(ent != NULL);
 
+	if (ent->en_type == M0_ET_OBJ) {
+		rc = m0_obj_wbc_flush(container_of(ent, struct m0_obj,
+						   ob_entity));
+		if (rc != 0)
+			return M0_ERR(rc);
+	}
+
 	sync_request_init(&sreq);
 	rc = sync_request_target_add(&sreq, SYNC_ENTITY, ent);
 	if (rc != 0)
@@ -1089,11 +1209,14 @@ M0_EXPORTED(m0_entity_sync);
  * Entry point for syncing the all pending tx in the Client instance.
  * Unlike sync_core this function acquires the sc_max_pending_tx_lock
  * for each service, as there is not a larger-granularity lock.
+ * Services with an FSYNC fop in flight covering their pending transactions
+ * are not sent another one.
  */
 int m0_sync(struct m0_client *m0c, bool wait)
 {
 	int                             rc;
 	int                             saved_error = 0;
+	uint64_t                        txid;
 	struct m0_reqh_service_txid    *stx;
 	struct m0_reqh_service_ctx     *iter;
 	struct sync_request             sreq;
@@ -1105,8 +1228,27 @@ int m0_sync(struct m0_client *m0c, bool wait)
 	M0_PRE(si.si_wait_for_reply != NULL);
 	M0_PRE(si.si_fop_fini != NULL);
 
+	saved_error = m0__obj_wbc_flush_all(m0c);
 	sync_request_init(&sreq);
 
+	/*
+	 * Piggybacks on FSYNC fops in flight, before sending any fop, see
+	 * sync_request_launch().
+	 */
+	m0_tl_for(pools_common_svc_ctx, &m0c->m0c_pools_common.pc_svc_ctxs,
+		  iter) {
+		m0_mutex_lock(&iter->sc_max_pending_tx_lock);
+		txid = iter->sc_max_pending_tx.stx_tri.tri_txid;
+		m0_mutex_unlock(&iter->sc_max_pending_tx_lock);
+		if (txid == 0 || !M0_IN(iter->sc_type, (M0_CST_MDS, M0_CST_IOS)))
+			continue;
+		if (sync_fop_shared_wait(iter, txid)) {
+			m0_mutex_lock(&iter->sc_max_pending_tx_lock);
+			sync_fop_stx_update(&iter->sc_max_pending_tx, txid);
+			m0_mutex_unlock(&iter->sc_max_pending_tx_lock);
+		}
+	} m0_tl_endfor;
+
 	/*
 	 *  loop over all services associated with this super block,
 	 *  send an fsync fop for those with pending transactions
@@ -1120,26 +1262,28 @@ int m0_sync(struct m0_client *m0c, bool wait)
 		 */
 		m0_mutex_lock(&iter->sc_max_pending_tx_lock);
 		stx = &iter->sc_max_pending_tx;
+		txid = stx->stx_tri.tri_txid;
+		m0_mutex_unlock(&iter->sc_max_pending_tx_lock);
 
 		/*
 		 * Check if this service has any pending transactions.
 		 * Currently for fsync operations are supported only for
 		 * ioservice and mdservice.
 		 */
-		if (stx->stx_tri.tri_txid == 0 ||
+		if (txid == 0 ||
 		    !M0_IN(stx->stx_service_ctx->sc_type,
-			  (M0_CST_MDS, M0_CST_IOS))) {
-			m0_mutex_unlock(&iter->sc_max_pending_tx_lock);
+			  (M0_CST_MDS, M0_CST_IOS)))
 			continue;
-		}
 
-		/* Create and send a request */
+		/*
+		 * Create and send a request. sync_request_fop_send() takes
+		 * sc_max_pending_tx_lock itself.
+		 */
 		rc = sync_request_fop_send(&sreq, stx,
 						  M0_FSYNC_MODE_ACTIVE,
 						  true, &sfw);
 		if (rc != 0) {
 			saved_error = rc;
-			m0_mutex_unlock(&iter->sc_max_pending_tx_lock);
 			break;
 		} else {
 			/* Reset the rpc item ops to NULL. */
@@ -1147,8 +1291,6 @@ int m0_sync(struct m0_client *m0c, bool wait)
 			/* Add to list of pending fops */
 			spf_tlink_init_at(sfw, &sreq.sr_fops);
 		}
-
-		m0_mutex_unlock(&iter->sc_max_pending_tx_lock);
 	} m0_tl_endfor;
 
 	/*
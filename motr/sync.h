@@ -116,6 +116,12 @@ struct sync_fop_wrapper {
 	/* Link to FSYNC fop list in a request. */
 	struct m0_tlink              sfw_tlink;
 	uint64_t                     sfw_tlink_magic;
+
+	/**
+	 * The fop is the FSYNC fop in flight to the service, see
+	 * m0_reqh_service_ctx::sc_fsync_txid.
+	 */
+	bool                         sfw_shared;
 };
 
 /**
@@ -875,6 +875,63 @@ void ut_test_m0_op_wait(void)
 	ut_m0_client_fini(&instance);
 }
 
+/** Unit tests m0_op_cq_set() and m0_cq_poll(). */
+static void ut_test_m0_cq_poll(void)
+{
+	struct m0_op_common cops[2];
+	struct m0_op       *p_ops[2];
+	struct m0_op       *done[2];
+	struct m0_entity    ent;
+	struct m0_realm     realm;
+	struct m0_cq        cq;
+	struct m0_client   *instance = NULL;
+	int                 rc;
+	int                 i;
+
+	ut_m0_client_init(&instance);
+	ut_realm_entity_setup(&realm, &ent, instance);
+	m0_cq_init(&cq);
+	for (i = 0; i < ARRAY_SIZE(cops); ++i) {
+		ut_init_fake_op(&cops[i], &ent, &ut_launch_cb_pass);
+		p_ops[i] = &cops[i].oc_op;
+		m0_op_cq_set(p_ops[i], &cq);
+	}
+	M0_UT_ASSERT(cq.cq_nr == 2);
+	m0_op_launch(p_ops, ARRAY_SIZE(p_ops));
+
+	/* Nothing completed yet. */
+	rc = m0_cq_poll(&cq, done, ARRAY_SIZE(done), m0_time_from_now(0, 1000));
+	M0_UT_ASSERT(rc == 0);
+
+	/* Operations are reaped in the order of completion. */
+	m0_sm_group_lock(&p_ops[1]->op_sm_group);
+	m0_sm_move(&p_ops[1]->op_sm, 0, M0_OS_EXECUTED);
+	m0_sm_move(&p_ops[1]->op_sm, 0, M0_OS_STABLE);
+	m0_sm_group_unlock(&p_ops[1]->op_sm_group);
+	m0_sm_group_lock(&p_ops[0]->op_sm_group);
+	m0_sm_move(&p_ops[0]->op_sm, -EIO, M0_OS_FAILED);
+	m0_sm_group_unlock(&p_ops[0]->op_sm_group);
+	rc = m0_cq_poll(&cq, done, 1, M0_TIME_NEVER);
+	M0_UT_ASSERT(rc == 1 && done[0] == p_ops[1]);
+	rc = m0_cq_poll(&cq, done, ARRAY_SIZE(done), M0_TIME_NEVER);
+	M0_UT_ASSERT(rc == 1 && done[0] == p_ops[0]);
+	M0_UT_ASSERT(done[0]->op_sm.sm_rc == -EIO);
+	rc = m0_cq_poll(&cq, done, ARRAY_SIZE(done), m0_time_from_now(0, 1000));
+	M0_UT_ASSERT(rc == 0);
+
+	for (i = 0; i < ARRAY_SIZE(cops); ++i) {
+		op_cq_del(p_ops[i]);
+		m0_sm_group_lock(&p_ops[i]->op_sm_group);
+		m0_sm_fini(&p_ops[i]->op_sm);
+		m0_sm_group_unlock(&p_ops[i]->op_sm_group);
+		m0_sm_group_fini(&p_ops[i]->op_sm_group);
+	}
+	M0_UT_ASSERT(cq.cq_nr == 0);
+	m0_cq_fini(&cq);
+	m0_entity_fini(&ent);
+	ut_m0_client_fini(&instance);
+}
+
 /**
  * Tests m0_op_alloc(), focusing on its pre-conditions. Also checks the
  * output is right when function succeeds.
@@ -1302,6 +1359,8 @@ struct m0_ut_suite ut_suite = {
 			&ut_test_m0_op_setup},
 		{ "m0_op_wait",
 			&ut_test_m0_op_wait},
+		{ "m0_cq_poll",
+			&ut_test_m0_cq_poll},
 		{ "m0_op_kick",
 			&ut_test_m0_op_kick},
 #if 0
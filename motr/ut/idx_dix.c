@@ -809,6 +809,175 @@ static void ut_dix_record_ops_non_dist_no_dtm(void)
 	ut_dix_record_ops(false, 0, M0_OIF_NO_DTM);
 }
 
+static void ut_dix_cache_op(struct m0_idx *idx, enum m0_idx_opcode opcode,
+			    uint64_t key, uint64_t val, uint32_t flags,
+			    int exp_rc)
+{
+	struct m0_op     *op = NULL;
+	struct m0_bufvec  keys;
+	struct m0_bufvec  vals;
+	int               rcs[1] = { 1 };
+	int               rc;
+
+	rc = m0_bufvec_alloc(&keys, 1, sizeof(uint64_t)) ?:
+	     (opcode == M0_IC_GET ? m0_bufvec_empty_alloc(&vals, 1) :
+				    m0_bufvec_alloc(&vals, 1, sizeof(uint64_t)));
+	M0_UT_ASSERT(rc == 0);
+	*(uint64_t *)keys.ov_buf[0] = dix_key(key);
+	if (opcode == M0_IC_PUT)
+		*(uint64_t *)vals.ov_buf[0] = dix_val(val);
+	rc = m0_idx_op(idx, opcode, &keys, opcode == M0_IC_DEL ? NULL : &vals,
+		       rcs, flags, &op);
+	M0_UT_ASSERT(rc == 0);
+	m0_op_launch(&op, 1);
+	rc = m0_op_wait(op, M0_BITS(M0_OS_STABLE), WAIT_TIMEOUT);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(rcs[0] == exp_rc);
+	if (opcode == M0_IC_GET && exp_rc == 0)
+		M0_UT_ASSERT(vals.ov_vec.v_count[0] == sizeof(uint64_t) &&
+			     *(uint64_t *)vals.ov_buf[0] == dix_val(val));
+	m0_bufvec_free(&keys);
+	m0_bufvec_free(&vals);
+	m0_op_fini(op);
+	m0_free0(&op);
+}
+
+static void ut_dix_record_ops_cache(void)
+{
+	struct m0_container  realm;
+	struct m0_idx        idx;
+	struct m0_fid        ifid;
+	struct m0_op        *op = NULL;
+	int                  rc;
+
+	ut_dix_config.kc_cache_size = 1 << 20;
+	ut_dix_config.kc_cache_ttl = M0_TIME_NEVER;
+	idx_dix_ut_init();
+	general_ifid_fill(&ifid, true);
+	m0_container_init(&realm, NULL, &M0_UBER_REALM, ut_m0c);
+	m0_idx_init(&idx, &realm.co_realm, (struct m0_uint128 *)&ifid);
+	rc = m0_entity_create(NULL, &idx.in_entity, &op);
+	M0_UT_ASSERT(rc == 0);
+	m0_op_launch(&op, 1);
+	rc = m0_op_wait(op, M0_BITS(M0_OS_STABLE), WAIT_TIMEOUT);
+	M0_UT_ASSERT(rc == 0);
+	m0_op_fini(op);
+	m0_free0(&op);
+
+	ut_dix_cache_op(&idx, M0_IC_GET, 1, 0, 0, -ENOENT);
+	ut_dix_cache_op(&idx, M0_IC_PUT, 1, 1, 0, 0);
+	/* The first GET fills the cache, the second one is served from it. */
+	ut_dix_cache_op(&idx, M0_IC_GET, 1, 1, 0, 0);
+	ut_dix_cache_op(&idx, M0_IC_GET, 1, 1, 0, 0);
+	ut_dix_cache_op(&idx, M0_IC_GET, 1, 1, M0_OIF_NO_CACHE, 0);
+	/* Own updates invalidate cached values. */
+	ut_dix_cache_op(&idx, M0_IC_PUT, 1, 2, M0_OIF_OVERWRITE, 0);
+	ut_dix_cache_op(&idx, M0_IC_GET, 1, 2, 0, 0);
+	ut_dix_cache_op(&idx, M0_IC_GET, 1, 2, 0, 0);
+	ut_dix_cache_op(&idx, M0_IC_DEL, 1, 0, 0, 0);
+	ut_dix_cache_op(&idx, M0_IC_GET, 1, 0, 0, -ENOENT);
+
+	rc = m0_entity_delete(&idx.in_entity, &op);
+	M0_UT_ASSERT(rc == 0);
+	m0_op_launch(&op, 1);
+	rc = m0_op_wait(op, M0_BITS(M0_OS_STABLE), WAIT_TIMEOUT);
+	M0_UT_ASSERT(rc == 0);
+	m0_op_fini(op);
+	m0_free0(&op);
+	m0_idx_fini(&idx);
+	idx_dix_ut_fini();
+	ut_dix_config.kc_cache_size = 0;
+	ut_dix_config.kc_cache_ttl = 0;
+}
+
+enum { BATCH_OPS_NR = 8 };
+
+/**
+ * Launches BATCH_OPS_NR single-record operations by one m0_op_launch() call.
+ * Operation i accesses key i + 1, GET of the last key is expected to fail
+ * with -ENOENT.
+ */
+static void ut_dix_batch_ops(struct m0_idx *idx, enum m0_idx_opcode opcode)
+{
+	struct m0_op     *ops[BATCH_OPS_NR] = {};
+	struct m0_bufvec  keys[BATCH_OPS_NR];
+	struct m0_bufvec  vals[BATCH_OPS_NR];
+	int               rcs[BATCH_OPS_NR][1];
+	int               exp_rc;
+	int               rc;
+	int               i;
+
+	for (i = 0; i < BATCH_OPS_NR; i++) {
+		rc = m0_bufvec_alloc(&keys[i], 1, sizeof(uint64_t)) ?:
+		     (opcode == M0_IC_GET ?
+		      m0_bufvec_empty_alloc(&vals[i], 1) :
+		      m0_bufvec_alloc(&vals[i], 1, sizeof(uint64_t)));
+		M0_UT_ASSERT(rc == 0);
+		*(uint64_t *)keys[i].ov_buf[0] = dix_key(i + 1);
+		if (opcode == M0_IC_PUT)
+			*(uint64_t *)vals[i].ov_buf[0] = dix_val(i + 1);
+		rcs[i][0] = 1;
+		rc = m0_idx_op(idx, opcode, &keys[i], &vals[i], rcs[i], 0,
+			       &ops[i]);
+		M0_UT_ASSERT(rc == 0);
+	}
+	m0_op_launch(ops, BATCH_OPS_NR);
+	for (i = 0; i < BATCH_OPS_NR; i++) {
+		rc = m0_op_wait(ops[i], M0_BITS(M0_OS_STABLE), WAIT_TIMEOUT);
+		M0_UT_ASSERT(rc == 0);
+		exp_rc = opcode == M0_IC_GET && i == BATCH_OPS_NR - 1 ?
+			-ENOENT : 0;
+		M0_UT_ASSERT(rcs[i][0] == exp_rc);
+		if (opcode == M0_IC_GET && exp_rc == 0)
+			M0_UT_ASSERT(vals[i].ov_vec.v_count[0] ==
+				     sizeof(uint64_t) &&
+				     *(uint64_t *)vals[i].ov_buf[0] ==
+				     dix_val(i + 1));
+		m0_bufvec_free(&keys[i]);
+		m0_bufvec_free(&vals[i]);
+		m0_op_fini(ops[i]);
+		m0_free0(&ops[i]);
+	}
+}
+
+static void ut_dix_record_ops_batch(void)
+{
+	struct m0_container  realm;
+	struct m0_idx        idx;
+	struct m0_fid        ifid;
+	struct m0_op        *op = NULL;
+	int                  rc;
+
+	ut_dix_config.kc_batch = true;
+	idx_dix_ut_init();
+	general_ifid_fill(&ifid, true);
+	m0_container_init(&realm, NULL, &M0_UBER_REALM, ut_m0c);
+	m0_idx_init(&idx, &realm.co_realm, (struct m0_uint128 *)&ifid);
+	rc = m0_entity_create(NULL, &idx.in_entity, &op);
+	M0_UT_ASSERT(rc == 0);
+	m0_op_launch(&op, 1);
+	rc = m0_op_wait(op, M0_BITS(M0_OS_STABLE), WAIT_TIMEOUT);
+	M0_UT_ASSERT(rc == 0);
+	m0_op_fini(op);
+	m0_free0(&op);
+
+	/* The last key is not inserted. */
+	ut_dix_batch_ops(&idx, M0_IC_PUT);
+	ut_dix_cache_op(&idx, M0_IC_DEL, BATCH_OPS_NR, 0, 0, 0);
+	ut_dix_batch_ops(&idx, M0_IC_GET);
+
+	rc = m0_entity_delete(&idx.in_entity, &op);
+	M0_UT_ASSERT(rc == 0);
+	m0_op_launch(&op, 1);
+	rc = m0_op_wait(op, M0_BITS(M0_OS_STABLE), WAIT_TIMEOUT);
+	M0_UT_ASSERT(rc == 0);
+	m0_op_fini(op);
+	m0_free0(&op);
+	m0_idx_fini(&idx);
+	idx_dix_ut_fini();
+	ut_dix_config.kc_batch = false;
+}
+
 
 struct m0_ut_suite ut_suite_idx_dix = {
 	.ts_name   = "idx-dix",
@@ -841,6 +1010,8 @@ struct m0_ut_suite ut_suite_idx_dix = {
 		   ut_dix_record_ops_dist_no_dtm,     "Huang Hua" },
 		{ "record-ops-non-dist-no-dtm",
 		   ut_dix_record_ops_non_dist_no_dtm, "Huang Hua" },
+		{ "record-ops-cache",     ut_dix_record_ops_cache,    "Egor" },
+		{ "record-ops-batch",     ut_dix_record_ops_batch,    "Egor" },
 		{ NULL, NULL }
 	}
 };
@@ -603,6 +603,11 @@ M0_INTERNAL int ut_dummy_poolmach_create(struct m0_pool_version *pv)
 		return -ENOMEM;
 	}
 
+	/* All nodes and devices are online. */
+	rc = m0_bitmap_init(&state->pst_dud_nodes, state->pst_nr_nodes) ?:
+	     m0_bitmap_init(&state->pst_dud_devs, state->pst_nr_devices);
+	M0_UT_ASSERT(rc == 0);
+
 	for (i = 0; i < state->pst_nr_nodes; i++) {
 		state->pst_nodes_array[i].pn_state = M0_PNDS_ONLINE;
 		M0_SET0(&state->pst_nodes_array[i].pn_id);
@@ -638,6 +643,8 @@ M0_INTERNAL void ut_dummy_poolmach_delete(struct m0_pool_version *pv)
 	pm = &pv->pv_mach;
 	state = pm->pm_state;
 
+	m0_bitmap_fini(&state->pst_dud_devs);
+	m0_bitmap_fini(&state->pst_dud_nodes);
 	m0_free(state->pst_spare_usage_array);
 	m0_free(state->pst_devices_array);
 	m0_free(state->pst_nodes_array);
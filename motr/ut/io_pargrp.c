@@ -528,11 +528,14 @@ static void ut_test_pargrp_iomap_seg_process(void)
  */
 static void ut_test_pargrp_iomap_databuf_alloc(void)
 {
-	int                  rc;
-	struct pargrp_iomap *map;
-	struct m0_op_io     *ioo;
-	struct m0_client    *instance = NULL;
-	struct m0_realm      realm;
+	int                     rc;
+	struct pargrp_iomap    *map;
+	struct m0_op_io        *ioo;
+	struct m0_client       *instance = NULL;
+	struct m0_realm         realm;
+	struct m0_bufvec        app;
+	struct m0_bufvec_cursor cur;
+	uint64_t                size;
 
 	instance = dummy_instance;
 	ioo = ut_dummy_ioo_create(instance, 1);
@@ -563,6 +566,31 @@ static void ut_test_pargrp_iomap_databuf_alloc(void)
 	M0_UT_ASSERT(rc == 0);
 	ut_pargrp_iomap_free_data_buf(map, 0, 0);
 
+	/* Aligned application buffer covering the block is used directly. */
+	size = obj_buffer_size(ioo->ioo_obj);
+	rc = m0_bufvec_alloc_aligned(&app, 1, size, M0_NETBUF_SHIFT);
+	M0_UT_ASSERT(rc == 0);
+	m0_bufvec_cursor_init(&cur, &app);
+	rc = pargrp_iomap_databuf_alloc(map, 0, 1, &cur);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(map->pi_databufs[0][1]->db_flags & PA_APP_MEMORY);
+	M0_UT_ASSERT(map->pi_databufs[0][1]->db_buf.b_addr == app.ov_buf[0]);
+	data_buf_dealloc_fini(map->pi_databufs[0][1]);
+	map->pi_databufs[0][1] = NULL;
+	m0_bufvec_free_aligned(&app, M0_NETBUF_SHIFT);
+
+	/* Application segments shorter than the block are copied. */
+	rc = m0_bufvec_alloc_aligned(&app, 2, size / 2, M0_NETBUF_SHIFT);
+	M0_UT_ASSERT(rc == 0);
+	m0_bufvec_cursor_init(&cur, &app);
+	rc = pargrp_iomap_databuf_alloc(map, 0, 2, &cur);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(!(map->pi_databufs[0][2]->db_flags & PA_APP_MEMORY));
+	M0_UT_ASSERT(map->pi_databufs[0][2]->db_buf.b_addr != app.ov_buf[0]);
+	data_buf_dealloc_fini(map->pi_databufs[0][2]);
+	map->pi_databufs[0][2] = NULL;
+	m0_bufvec_free_aligned(&app, M0_NETBUF_SHIFT);
+
 	m0_free(map->pi_databufs[0]);
 	m0_free(map->pi_databufs);
 	m0_indexvec_free(&map->pi_ivec);
@@ -1007,12 +1035,16 @@ M0_INTERNAL void ut_set_device_state(struct m0_poolmach *pm, int dev,
 				     enum m0_pool_nd_state state)
 {
 	pm->pm_state->pst_devices_array[dev].pd_state = state;
+	m0_bitmap_set(&pm->pm_state->pst_dud_devs, dev,
+		      state != M0_PNDS_ONLINE);
 }
 
 M0_INTERNAL void ut_set_node_state(struct m0_poolmach *pm, int node,
 				   enum m0_pool_nd_state state)
 {
 	pm->pm_state->pst_nodes_array[node].pn_state = state;
+	m0_bitmap_set(&pm->pm_state->pst_dud_nodes, node,
+		      state != M0_PNDS_ONLINE);
 }
 
 static void ut_test_pargrp_src_addr(void)
@@ -1181,6 +1213,54 @@ static void ut_test_pargrp_iomap_dgmode_postprocess(void)
 	ut_dummy_pargrp_iomap_delete(map, instance);
 }
 
+static void ut_test_pargrp_iomap_dgmode_minimise(void)
+{
+	int                  i;
+	struct pargrp_iomap *map;
+	struct m0_client    *instance = NULL;
+	struct m0_realm      realm;
+
+	/* init */
+	instance = dummy_instance;
+
+	map = ut_dummy_pargrp_iomap_create(instance, 1);
+	map->pi_ioo = ut_dummy_ioo_create(instance, 1);
+	ut_realm_entity_setup(&realm,
+		map->pi_ioo->ioo_oo.oo_oc.oc_op.op_entity, instance);
+	map->pi_ioo->ioo_oo.oo_layout_instance->li_ops =
+					&mock_layout_instance_ops;
+	map->pi_state = PI_DEGRADED;
+	ut_dummy_paritybufs_create(map, true);
+	M0_UT_ASSERT(pargrp_iomap_dgmode_is_minimal(map));
+
+	/* Requested page of a healthy unit: the row is not read. */
+	map->pi_databufs[0][0]->db_flags = PA_READ;
+	map->pi_databufs[0][1]->db_flags = PA_READ_FAILED;
+	for (i = 0; i < M0T1FS_LAYOUT_K; i++)
+		map->pi_paritybufs[0][i]->db_flags = PA_DGMODE_READ;
+	M0_UT_ASSERT(!pargrp_iomap_row_is_lost(map, 0));
+	pargrp_iomap_dgmode_minimise(map);
+	for (i = 0; i < M0T1FS_LAYOUT_K; i++)
+		M0_UT_ASSERT(!(map->pi_paritybufs[0][i]->db_flags &
+			       PA_DGMODE_READ));
+
+	/* Requested page of the failed unit: parity is read. */
+	map->pi_databufs[0][1]->db_flags = PA_READ | PA_READ_FAILED;
+	for (i = 0; i < M0T1FS_LAYOUT_K; i++)
+		map->pi_paritybufs[0][i]->db_flags = PA_DGMODE_READ;
+	M0_UT_ASSERT(pargrp_iomap_row_is_lost(map, 0));
+	pargrp_iomap_dgmode_minimise(map);
+	for (i = 0; i < M0T1FS_LAYOUT_K; i++)
+		M0_UT_ASSERT(map->pi_paritybufs[0][i]->db_flags ==
+			     PA_DGMODE_READ);
+
+	/* fini */
+	ut_dummy_paritybufs_delete(map, true);
+	ut_dummy_ioo_delete(map->pi_ioo, instance);
+	map->pi_ioo = NULL;
+	ut_dummy_pargrp_iomap_delete(map, instance);
+}
+
 static void ut_test_pargrp_iomap_dgmode_recover(void)
 {
 	int                    i;
@@ -1222,6 +1302,12 @@ static void ut_test_pargrp_iomap_dgmode_recover(void)
 	rc = pargrp_iomap_dgmode_recover(map);
 	M0_UT_ASSERT(rc == 0);
 
+	/* Requested page of a lost data unit is reconstructed. */
+	map->pi_paritybufs[0][0]->db_flags = 0;
+	map->pi_databufs[0][1]->db_flags = PA_READ | PA_READ_FAILED;
+	rc = pargrp_iomap_dgmode_recover(map);
+	M0_UT_ASSERT(rc == 0);
+
 	/* fini */
 	ut_dummy_paritybufs_delete(map, true);
 	ut_dummy_ioo_delete(map->pi_ioo, instance);
@@ -1333,6 +1419,8 @@ struct m0_ut_suite ut_suite_io_pargrp = {
 				    &ut_test_pargrp_iomap_dgmode_postprocess},
 		{ "pargrp_iomap_dgmode_recover",
 				    &ut_test_pargrp_iomap_dgmode_recover},
+		{ "pargrp_iomap_dgmode_minimise",
+				    &ut_test_pargrp_iomap_dgmode_minimise},
 		{ NULL, NULL },
 	}
 };
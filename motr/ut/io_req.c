@@ -914,6 +914,54 @@ static void ut_test_ioreq_parity_recalc(void)
 	ut_dummy_ioo_delete(ioo, instance);
 }
 
+static struct m0_atomic64 ut_parity_job_nr;
+
+/** Counts calculations, fails the calculation of the group 3. */
+static int ut_pool_pargrp_iomap_parity_recalc(struct pargrp_iomap *map)
+{
+	m0_atomic64_inc(&ut_parity_job_nr);
+	return map->pi_grpid == 3 ? -EIO : 0;
+}
+
+static const struct pargrp_iomap_ops ut_pool_iomap_ops = {
+	.pi_parity_recalc = ut_pool_pargrp_iomap_parity_recalc,
+};
+
+static void ut_test_ioreq_parity_recalc_pool(void)
+{
+	int                  rc;
+	int                  i;
+	struct m0_op_io     *ioo;
+	struct m0_client    *instance;
+	struct m0_realm      realm;
+
+	instance = dummy_instance;
+	M0_UT_ASSERT(instance->m0c_parity_pool_on);
+	ioo = ut_dummy_ioo_create(instance, IOREQ_PARITY_JOBS_NR + 4);
+	ioo->ioo_obj->ob_entity.en_realm = &realm;
+	realm.re_instance = instance;
+	ioo->ioo_oo.oo_oc.oc_op.op_code = M0_OC_WRITE;
+	for (i = 0; i < ioo->ioo_iomap_nr; ++i)
+		ioo->ioo_iomaps[i]->pi_ops = &ut_pool_iomap_ops;
+
+	/* All groups are calculated, in two batches. */
+	ioo->ioo_iomaps[3]->pi_grpid = ioo->ioo_iomap_nr;
+	m0_atomic64_set(&ut_parity_job_nr, 0);
+	rc = ioreq_parity_recalc(ioo);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_atomic64_get(&ut_parity_job_nr) == ioo->ioo_iomap_nr);
+
+	/* Error of a group fails the operation. */
+	ioo->ioo_iomaps[3]->pi_grpid = 3;
+	m0_atomic64_set(&ut_parity_job_nr, 0);
+	rc = ioreq_parity_recalc(ioo);
+	M0_UT_ASSERT(rc == -EIO);
+	M0_UT_ASSERT(m0_atomic64_get(&ut_parity_job_nr) ==
+		     IOREQ_PARITY_JOBS_NR);
+
+	ut_dummy_ioo_delete(ioo, instance);
+}
+
 static void ut_test_ioreq_application_data_copy(void)
 {
 	int                          i;
@@ -1335,6 +1383,8 @@ struct m0_ut_suite ut_suite_io_req = {
 				    &ut_test_ioreq_application_data_copy},
 		{ "ioreq_parity_recalc",
 				    &ut_test_ioreq_parity_recalc},
+		{ "ioreq_parity_recalc_pool",
+				    &ut_test_ioreq_parity_recalc_pool},
 		{ "device_check",
 				    &ut_test_device_check},
 		{ "ioreq_dgmode_recover",
@@ -173,6 +173,82 @@ static void ut_test_ioreq_fop_release(void)
 	ut_dummy_target_ioreq_delete(ti);
 }
 
+static void ut_co_fop_fill(struct ioreq_fop *fop, uint32_t nr,
+			   m0_bindex_t start)
+{
+	struct m0_fop_cob_rw *rw = io_rw_get(&fop->irf_iofop.if_fop);
+	uint32_t              i;
+
+	M0_ALLOC_ARR(rw->crw_desc.id_descs, nr);
+	M0_ALLOC_ARR(rw->crw_ivec.ci_iosegs, nr);
+	M0_UT_ASSERT(rw->crw_desc.id_descs != NULL &&
+		     rw->crw_ivec.ci_iosegs != NULL);
+	rw->crw_desc.id_nr = rw->crw_ivec.ci_nr = nr;
+	for (i = 0; i < nr; ++i) {
+		rw->crw_desc.id_descs[i].bdd_used = 4096;
+		rw->crw_ivec.ci_iosegs[i] = (struct m0_ioseg) {
+			.ci_index = start + i * 8192,
+			.ci_count = 4096
+		};
+	}
+}
+
+/**
+ * Tests merging of coalesced io fops, iofop_co_merge().
+ */
+static void ut_test_iofop_co_merge(void)
+{
+	struct ioreq_fop     *fop[2];
+	struct m0_fop_cob_rw *rw[2];
+	struct target_ioreq  *ti;
+	struct m0_op_io      *ioo;
+	struct m0_client     *instance = dummy_instance;
+	int                   rc;
+	int                   i;
+
+	ti = ut_dummy_target_ioreq_create();
+	ioo = ut_dummy_ioo_create(instance, 1);
+	ti->ti_nwxfer = &ioo->ioo_nwxfer;
+	m0_mutex_init(&ti->ti_nwxfer->nxr_lock);
+	ioo->ioo_sm.sm_state = IRS_READING;
+	for (i = 0; i < ARRAY_SIZE(fop); ++i) {
+		M0_ALLOC_PTR(fop[i]);
+		rc = ioreq_fop_init(fop[i], ti, PA_DATA);
+		M0_UT_ASSERT(rc == 0);
+		rpcbulk_tlist_init(&fop[i]->irf_iofop.if_rbulk.rb_buflist);
+		m0_mutex_init(&fop[i]->irf_iofop.if_rbulk.rb_mutex);
+		rw[i] = io_rw_get(&fop[i]->irf_iofop.if_fop);
+	}
+	ut_co_fop_fill(fop[0], 2, 0);
+	ut_co_fop_fill(fop[1], 3, 4096);
+	M0_UT_ASSERT(!ivec_overlaps(&rw[0]->crw_ivec, &rw[1]->crw_ivec));
+	rw[1]->crw_ivec.ci_iosegs[0].ci_index = 2048;
+	M0_UT_ASSERT(ivec_overlaps(&rw[0]->crw_ivec, &rw[1]->crw_ivec));
+	rw[1]->crw_ivec.ci_iosegs[0].ci_index = 4096;
+
+	fop[0]->irf_co_members = fop[1];
+	fop[0]->irf_co_nr = 1;
+	rc = iofop_co_merge(fop[0]);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(rw[0]->crw_desc.id_nr == 5);
+	M0_UT_ASSERT(rw[0]->crw_ivec.ci_nr == 5);
+	M0_UT_ASSERT(rw[0]->crw_ivec.ci_iosegs[1].ci_index == 8192);
+	M0_UT_ASSERT(rw[0]->crw_ivec.ci_iosegs[2].ci_index == 4096);
+	M0_UT_ASSERT(rw[0]->crw_ivec.ci_iosegs[4].ci_index == 4096 + 16384);
+	iofop_co_unmerge(fop[0]);
+	M0_UT_ASSERT(rw[0]->crw_desc.id_nr == 2);
+	M0_UT_ASSERT(rw[0]->crw_ivec.ci_nr == 2);
+	M0_UT_ASSERT(rw[0]->crw_ivec.ci_iosegs[1].ci_index == 8192);
+	fop[0]->irf_co_members = NULL;
+	fop[0]->irf_co_nr = 0;
+
+	for (i = 0; i < ARRAY_SIZE(fop); ++i)
+		ioreq_fop_release(&fop[i]->irf_iofop.if_fop.f_ref);
+	ioo->ioo_sm.sm_state = IRS_READ_COMPLETE;
+	ut_dummy_ioo_delete(ioo, instance);
+	ut_dummy_target_ioreq_delete(ti);
+}
+
 /**
  * Tests ioreq_fop_init().
  */
@@ -303,6 +379,8 @@ struct m0_ut_suite ut_suite_io_req_fop = {
 				    &ut_test_ioreq_fop_async_submit},
 		{ "ioreq_fop_release",
 				    &ut_test_ioreq_fop_release},
+		{ "iofop_co_merge",
+				    &ut_test_iofop_co_merge},
 		{ "ioreq_fop_init",
 				    &ut_test_ioreq_fop_init},
 		{ "ioreq_fop_fini",
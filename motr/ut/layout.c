@@ -896,6 +896,69 @@ static void ut_composite_layer_idx_extents_extract(void)
 	M0_UT_ASSERT(max_key.cek_off == 4096);
 }
 
+static void ut_composite_ext_idx(void)
+{
+	int                                 i;
+	int                                 rc;
+	int                                 unit_size = 4096;
+	int                                 nr_exts = 10;
+	int                                 nr_sios = 0;
+	struct m0_uint128                  *layer_ids;
+	struct m0_client_layout            *layout;
+	struct m0_client_composite_layout  *clayout;
+	struct m0_composite_layer          *layer;
+	struct m0_composite_extent         *ext;
+	struct m0_composite_ext_idx        *ei;
+	struct composite_sub_io            *sio_arr;
+	struct composite_sub_io_ext        *sio_ext;
+	struct io_seg                       io_seg;
+
+	layout = m0_client_layout_alloc(M0_LT_COMPOSITE);
+	M0_UT_ASSERT(layout != NULL);
+	clayout = M0_AMB(clayout, layout, ccl_layout);
+	M0_ALLOC_ARR(layer_ids, 1);
+	M0_UT_ASSERT(layer_ids != NULL);
+	rc = composite_layout_add_layers(layout, 1, layer_ids);
+	M0_UT_ASSERT(rc == 0);
+
+	/* Extents [2 * i, 2 * i + 1) units with holes between them. */
+	layer = clayer_tlist_head(&clayout->ccl_layers);
+	for (i = 0; i < nr_exts; i++) {
+		M0_ALLOC_PTR(ext);
+		M0_UT_ASSERT(ext != NULL);
+		ext->ce_id = layer_ids[0];
+		ext->ce_off = 2 * i * unit_size;
+		ext->ce_len = unit_size;
+		cext_tlink_init_at_tail(ext, &layer->ccr_rd_exts);
+	}
+	ei = &layer->ccr_rd_idx;
+	composite_ext_idx_build(ei, &layer->ccr_rd_exts);
+	M0_UT_ASSERT(ei->cei_nr == nr_exts);
+	M0_UT_ASSERT(composite_ext_idx_find(ei, 0) == ei->cei_exts[0]);
+	M0_UT_ASSERT(composite_ext_idx_find(ei, unit_size) ==
+		     ei->cei_exts[1]);
+	M0_UT_ASSERT(composite_ext_idx_find(ei, 3 * unit_size - 1) ==
+		     ei->cei_exts[1]);
+	M0_UT_ASSERT(composite_ext_idx_find(ei, 2 * nr_exts * unit_size) ==
+		     NULL);
+
+	/* An IO in the middle of the object starts at the right extent. */
+	io_seg.is_off = 12 * unit_size;
+	io_seg.is_len = unit_size;
+	rc = do_composite_io_divide(clayout, 1, &io_seg, &sio_arr, &nr_sios);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(nr_sios == 1);
+	M0_UT_ASSERT(sio_arr[0].si_nr_exts == 1);
+	sio_ext = sio_ext_tlist_head(&sio_arr[0].si_exts);
+	M0_UT_ASSERT(sio_ext->sie_off == 12 * unit_size);
+	M0_UT_ASSERT(sio_ext->sie_len == unit_size);
+	composite_sub_io_destroy(sio_arr, nr_sios);
+
+	composite_layout_put(layout);
+	m0_client_layout_free(layout);
+	m0_free(layer_ids);
+}
+
 static void ut_composite_layer_idx_scan(void)
 {
 
@@ -957,6 +1020,8 @@ struct m0_ut_suite ut_suite_layout = {
 			&ut_composite_layer_idx_extents_extract},
 		{ "composite_layer_idx_scan",
 			&ut_composite_layer_idx_scan},
+		{ "composite_ext_idx",
+			&ut_composite_ext_idx},
 		{ NULL, NULL },
 	}
 };
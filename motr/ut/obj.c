@@ -746,6 +746,44 @@ static void ut_test_m0_entity_delete(void)
 	ut_m0_client_fini(&instance);
 }
 
+/**
+ * Tests that a failed batch leaves no operation behind.
+ */
+static void ut_test_m0_entity_delete_batch(void)
+{
+	struct m0_obj     obj[2];
+	struct m0_entity *ents[2] = { &obj[0].ob_entity, &obj[1].ob_entity };
+	struct m0_entity  ent;
+	struct m0_realm   realm;
+	struct m0_op     *ops[2] = {NULL, NULL};
+	struct m0_client *instance = NULL;
+	struct m0_uint128 id;
+	int               rc;
+	int               i;
+
+	/* init */
+	rc = ut_m0_client_init(&instance);
+	M0_UT_ASSERT(rc == 0);
+
+	ut_realm_entity_setup(&realm, &ent, instance);
+	ent.en_realm = &realm;
+
+	for (i = 0; i < ARRAY_SIZE(obj); i++) {
+		id = ent.en_id;
+		id.u_lo += i;
+		M0_SET0(&obj[i]);
+		m0_obj_init(&obj[i], &realm, &id,
+			    m0_client_layout_id(instance));
+	}
+
+	m0_fi_enable_once("obj_namei_op_init", "fake_msg_size");
+	rc = m0_entity_delete_batch(ents, ARRAY_SIZE(ents), ops);
+	M0_UT_ASSERT(rc == -EMSGSIZE);
+	M0_UT_ASSERT(ops[0] == NULL && ops[1] == NULL);
+
+	ut_m0_client_fini(&instance);
+}
+
 /**
  * Tests m0__entity_instance().
  */
@@ -1557,6 +1595,8 @@ struct m0_ut_suite ut_suite_obj = {
 			&ut_test_m0_entity_create},
 		{ "m0_entity_delete(object)",
 			&ut_test_m0_entity_delete},
+		{ "m0_entity_delete_batch(object)",
+			&ut_test_m0_entity_delete_batch},
 		{ "m0__obj_layout_instance_build",
 			&ut_test_m0__obj_layout_instance_build},
 		{ "m0_fid_print",
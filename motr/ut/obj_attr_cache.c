@@ -0,0 +1,132 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "ut/ut.h"            /* M0_UT_ASSERT */
+#include "motr/ut/client.h"
+
+/* Include the c file to test static helpers. */
+#include "motr/obj_attr_cache.c"
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_CLIENT
+#include "lib/trace.h"
+
+struct m0_ut_suite ut_suite_obj_attr_cache;
+
+enum {
+	UT_OAC_NR  = 2,
+	UT_OAC_LID = 1
+};
+
+static void ut_oac_obj_init(struct m0_obj *obj, uint64_t key)
+{
+	M0_SET0(obj);
+	obj->ob_attr.oa_pver = M0_FID_TINIT('v', 1, key);
+	obj->ob_attr.oa_layout_id = UT_OAC_LID;
+}
+
+/**
+ * Tests that cached attributes are found and that the least recently used
+ * object is evicted.
+ */
+static void ut_test_oac_put_get(void)
+{
+	struct m0_obj_attr_cache oac;
+	struct m0_obj            obj;
+	struct m0_obj            out;
+	struct m0_fid            fid[UT_OAC_NR + 1];
+	int                      rc;
+	int                      i;
+
+	rc = m0__obj_attr_cache_init(&oac, UT_OAC_NR);
+	M0_UT_ASSERT(rc == 0);
+	for (i = 0; i < ARRAY_SIZE(fid); ++i)
+		fid[i] = M0_FID_TINIT('o', 1, i);
+	M0_SET0(&out);
+	M0_UT_ASSERT(!m0__obj_attr_cache_get(&oac, &fid[0], &out));
+	for (i = 0; i < UT_OAC_NR; ++i) {
+		ut_oac_obj_init(&obj, i);
+		m0__obj_attr_cache_put(&oac, &fid[i], &obj);
+	}
+	M0_UT_ASSERT(oac.oac_nr == UT_OAC_NR);
+	/* Object 0 becomes the most recently used. */
+	M0_UT_ASSERT(m0__obj_attr_cache_get(&oac, &fid[0], &out));
+	M0_UT_ASSERT(out.ob_attr.oa_pver.f_key == 0);
+	M0_UT_ASSERT(out.ob_attr.oa_layout_id == UT_OAC_LID);
+	/* Object 1 is evicted. */
+	ut_oac_obj_init(&obj, UT_OAC_NR);
+	m0__obj_attr_cache_put(&oac, &fid[UT_OAC_NR], &obj);
+	M0_UT_ASSERT(oac.oac_nr == UT_OAC_NR);
+	M0_UT_ASSERT(!m0__obj_attr_cache_get(&oac, &fid[1], &out));
+	M0_UT_ASSERT(m0__obj_attr_cache_get(&oac, &fid[UT_OAC_NR], &out));
+	M0_UT_ASSERT(out.ob_attr.oa_pver.f_key == UT_OAC_NR);
+	M0_UT_ASSERT(oac.oac_hits == 2 && oac.oac_misses == 2);
+	/* Deleted objects are forgotten. */
+	m0__obj_attr_cache_del(&oac, &fid[0]);
+	M0_UT_ASSERT(oac.oac_nr == UT_OAC_NR - 1);
+	M0_UT_ASSERT(!m0__obj_attr_cache_get(&oac, &fid[0], &out));
+	m0__obj_attr_cache_fini(&oac);
+}
+
+/**
+ * Tests that a disabled cache holds nothing.
+ */
+static void ut_test_oac_disabled(void)
+{
+	struct m0_obj_attr_cache oac;
+	struct m0_obj            obj;
+	struct m0_fid            fid = M0_FID_TINIT('o', 1, 1);
+	int                      rc;
+
+	rc = m0__obj_attr_cache_init(&oac, 0);
+	M0_UT_ASSERT(rc == 0);
+	ut_oac_obj_init(&obj, 1);
+	m0__obj_attr_cache_put(&oac, &fid, &obj);
+	M0_UT_ASSERT(!m0__obj_attr_cache_get(&oac, &fid, &obj));
+	m0__obj_attr_cache_del(&oac, &fid);
+	m0__obj_attr_cache_fini(&oac);
+}
+
+struct m0_ut_suite ut_suite_obj_attr_cache = {
+	.ts_name = "obj-attr-cache-ut",
+	.ts_init = NULL,
+	.ts_fini = NULL,
+	.ts_tests = {
+		{ "oac-put-get",  &ut_test_oac_put_get },
+		{ "oac-disabled", &ut_test_oac_disabled },
+		{ NULL, NULL }
+	}
+};
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -0,0 +1,152 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "ut/ut.h"            /* M0_UT_ASSERT */
+#include "motr/ut/client.h"
+
+/* Include the c file to test static helpers. */
+#include "motr/obj_inline.c"
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_CLIENT
+#include "lib/trace.h"
+
+struct m0_ut_suite ut_suite_obj_inline;
+
+enum {
+	UT_INLINE_BLOCK = 1 << 12
+};
+
+static struct m0_op_io *ut_inline_ioo(enum m0_obj_opcode opcode,
+				      m0_bindex_t start, m0_bcount_t count,
+				      char *buf)
+{
+	struct m0_op_io *ioo;
+	int              rc;
+
+	M0_ALLOC_PTR(ioo);
+	M0_UT_ASSERT(ioo != NULL);
+	rc = m0_indexvec_alloc(&ioo->ioo_ext, 1) ?:
+		m0_bufvec_empty_alloc(&ioo->ioo_data, 1);
+	M0_UT_ASSERT(rc == 0);
+	ioo->ioo_oo.oo_oc.oc_op.op_code = opcode;
+	ioo->ioo_ext.iv_index[0] = start;
+	ioo->ioo_ext.iv_vec.v_count[0] = count;
+	ioo->ioo_data.ov_buf[0] = buf;
+	ioo->ioo_data.ov_vec.v_count[0] = count;
+	return ioo;
+}
+
+static void ut_inline_ioo_free(struct m0_op_io *ioo)
+{
+	m0_bufvec_free2(&ioo->ioo_data);
+	m0_indexvec_free(&ioo->ioo_ext);
+	m0_free(ioo);
+}
+
+/**
+ * Tests that writes grow the in-memory data of an inline object in whole
+ * blocks and that FREE zeroes it.
+ */
+static void ut_test_inline_apply(void)
+{
+	struct m0_obj_inline *oi;
+	struct m0_op_io      *ioo;
+	static char           buf[2 * UT_INLINE_BLOCK];
+	int                   rc;
+
+	oi = inline_alloc(false);
+	M0_UT_ASSERT(oi != NULL);
+	m0_mutex_lock(&oi->oi_lock);
+	memset(buf, 'a', sizeof buf);
+	ioo = ut_inline_ioo(M0_OC_WRITE, UT_INLINE_BLOCK, 100, buf);
+	M0_UT_ASSERT(inline_ext_end(&ioo->ioo_ext) == UT_INLINE_BLOCK + 100);
+	rc = inline_apply(oi, ioo, UT_INLINE_BLOCK);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(oi->oi_size == 2 * UT_INLINE_BLOCK);
+	M0_UT_ASSERT(oi->oi_buf[0] == 0);
+	M0_UT_ASSERT(oi->oi_buf[UT_INLINE_BLOCK] == 'a');
+	M0_UT_ASSERT(oi->oi_buf[UT_INLINE_BLOCK + 99] == 'a');
+	M0_UT_ASSERT(oi->oi_buf[UT_INLINE_BLOCK + 100] == 0);
+	ut_inline_ioo_free(ioo);
+	/* A FREE beyond the data does not grow it. */
+	ioo = ut_inline_ioo(M0_OC_FREE, UT_INLINE_BLOCK + 50,
+			    2 * UT_INLINE_BLOCK, NULL);
+	rc = inline_apply(oi, ioo, UT_INLINE_BLOCK);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(oi->oi_size == 2 * UT_INLINE_BLOCK);
+	M0_UT_ASSERT(oi->oi_buf[UT_INLINE_BLOCK + 49] == 'a');
+	M0_UT_ASSERT(oi->oi_buf[UT_INLINE_BLOCK + 50] == 0);
+	ut_inline_ioo_free(ioo);
+	m0_mutex_unlock(&oi->oi_lock);
+	inline_free(oi);
+}
+
+/**
+ * Tests that reads get the record value and zeroes past its end.
+ */
+static void ut_test_inline_read_copy(void)
+{
+	struct m0_op_io *ioo;
+	static char      val[UT_INLINE_BLOCK];
+	static char      buf[2 * UT_INLINE_BLOCK];
+
+	memset(val, 'v', sizeof val);
+	memset(buf, 'x', sizeof buf);
+	ioo = ut_inline_ioo(M0_OC_READ, UT_INLINE_BLOCK / 2,
+			    UT_INLINE_BLOCK, buf);
+	inline_read_copy(ioo, val, sizeof val);
+	M0_UT_ASSERT(buf[0] == 'v');
+	M0_UT_ASSERT(buf[UT_INLINE_BLOCK / 2 - 1] == 'v');
+	M0_UT_ASSERT(buf[UT_INLINE_BLOCK / 2] == 0);
+	M0_UT_ASSERT(buf[UT_INLINE_BLOCK - 1] == 0);
+	M0_UT_ASSERT(buf[UT_INLINE_BLOCK] == 'x');
+	/* No record. */
+	inline_read_copy(ioo, NULL, 0);
+	M0_UT_ASSERT(buf[0] == 0);
+	ut_inline_ioo_free(ioo);
+}
+
+struct m0_ut_suite ut_suite_obj_inline = {
+	.ts_name = "obj-inline-ut",
+	.ts_init = NULL,
+	.ts_fini = NULL,
+	.ts_tests = {
+		{ "inline-apply",     &ut_test_inline_apply },
+		{ "inline-read-copy", &ut_test_inline_read_copy },
+		{ NULL, NULL }
+	}
+};
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -24,6 +24,7 @@
 #endif /* __KERNEL__ */
 
 #include "ut/ut.h"
+#include "lib/ub.h"
 #include "motr/client.h"
 #include "motr/client_internal.h"
 #include "motr/ut/client.h"
@@ -314,6 +315,95 @@ static void ut_test_pi_api_case_third(void)
 }
 
 
+/*
+ * CRC32C: known answer, incremental calculation of data units is the same as
+ * a calculation of all of them in one chunk, verification detects a flipped
+ * bit.
+ */
+static void ut_test_pi_api_crc32c(void)
+{
+	struct m0_crc32c_pi pi;
+	struct m0_crc32c_pi big_pi;
+	struct m0_pi_seed   seed;
+	unsigned char       context[sizeof(uint32_t)];
+	unsigned char       unseeded[sizeof(uint32_t)];
+	unsigned char       big_unseeded[sizeof(uint32_t)];
+	char                check[] = "123456789";
+	int                 j;
+	int                 rc;
+
+	M0_UT_ASSERT(~m0_crc32c(~0U, check, 9) == 0xe3069283);
+	M0_UT_ASSERT(sizeof(struct m0_crc32c_pi) == 32);
+
+	m0_fid_set(&seed.pis_obj_id, OBJ_CONTAINER, OBJ_KEY);
+	seed.pis_data_unit_offset = (DATA_UNIT_COUNT-1)*SEGS_NR*BUFFER_SIZE;
+
+	memset(&pi, 0, sizeof pi);
+	pi.picrc_hdr.pih_type = M0_PI_TYPE_CRC;
+	for (j = 0; j < DATA_UNIT_COUNT; j++) {
+		rc = m0_client_calculate_pi((struct m0_generic_pi *)&pi,
+				j == DATA_UNIT_COUNT - 1 ? &seed : NULL,
+				&user_data[j],
+				j == 0 ? M0_PI_CALC_UNIT_ZERO : M0_PI_NO_FLAG,
+				context,
+				j == DATA_UNIT_COUNT - 1 ? unseeded : NULL);
+		M0_UT_ASSERT(rc == 0);
+		if (j < DATA_UNIT_COUNT - 1)
+			memcpy(pi.picrc_prev_context, context, sizeof context);
+	}
+
+	/* All the data units as one chunk, the big buffer is the same data. */
+	memset(&big_pi, 0, sizeof big_pi);
+	big_pi.picrc_hdr.pih_type = M0_PI_TYPE_CRC;
+	rc = m0_client_calculate_pi((struct m0_generic_pi *)&big_pi, &seed,
+				    big_user_data, M0_PI_CALC_UNIT_ZERO,
+				    context, big_unseeded);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(memcmp(pi.picrc_value, big_pi.picrc_value,
+			    sizeof pi.picrc_value) == 0);
+	M0_UT_ASSERT(memcmp(unseeded, big_unseeded, sizeof unseeded) == 0);
+
+	/* Verification of the last data unit. */
+	M0_UT_ASSERT(m0_calc_verify_cksum_one_unit(
+			     (struct m0_generic_pi *)&pi, &seed,
+			     &user_data[DATA_UNIT_COUNT - 1]));
+	pi.picrc_value[0] ^= 1;
+	M0_UT_ASSERT(!m0_calc_verify_cksum_one_unit(
+			     (struct m0_generic_pi *)&pi, &seed,
+			     &user_data[DATA_UNIT_COUNT - 1]));
+}
+
+/*
+ * CRC32C of the data units combined from the CRCs of its segments is the CRC
+ * of all the data calculated at once.
+ */
+static void ut_test_pi_api_crc32c_combine(void)
+{
+	char     check[] = "123456789";
+	uint32_t crc = 0;
+	uint32_t whole = ~0U;
+	uint32_t seg;
+	int      i;
+	int      j;
+
+	M0_UT_ASSERT(m0_crc32c_combine(~m0_crc32c(~0U, check, 4),
+				       ~m0_crc32c(~0U, check + 4, 5), 5) ==
+		     0xe3069283);
+	M0_UT_ASSERT(m0_crc32c_combine(0xe3069283, ~m0_crc32c(~0U, check, 0),
+				       0) == 0xe3069283);
+	for (j = 0; j < DATA_UNIT_COUNT; j++) {
+		for (i = 0; i < user_data[j].ov_vec.v_nr; i++) {
+			seg = ~m0_crc32c(~0U, user_data[j].ov_buf[i],
+					 BUFFER_SIZE);
+			crc = j == 0 && i == 0 ? seg :
+				m0_crc32c_combine(crc, seg, BUFFER_SIZE);
+			whole = m0_crc32c(whole, user_data[j].ov_buf[i],
+					  BUFFER_SIZE);
+		}
+	}
+	M0_UT_ASSERT(crc == ~whole);
+}
+
 struct m0_ut_suite ut_suite_pi = {
 	.ts_name = "pi_ut",
 	.ts_init = pi_init,
@@ -323,8 +413,109 @@ struct m0_ut_suite ut_suite_pi = {
 		/* Initialising client. */
 		{ "m0_pi_checks_case_one_two", &ut_test_pi_api_case_one_two},
 		{ "m0_pi_checks_case_third", &ut_test_pi_api_case_third},
+		{ "m0_pi_checks_crc32c", &ut_test_pi_api_crc32c},
+		{ "m0_pi_checks_crc32c_combine",
+		  &ut_test_pi_api_crc32c_combine},
 		{ NULL, NULL },
 	}
 };
 
+/*
+ * Checksum throughput: a data unit of UB_UNIT_SIZE bytes per round, in
+ * UB_SEGS_NR segments.
+ */
+enum {
+	UB_ITER      = 1000,
+	UB_SEGS_NR   = 256,
+	UB_SEG_SIZE  = 4096,
+	UB_UNIT_SIZE = UB_SEGS_NR * UB_SEG_SIZE
+};
+
+static struct m0_bufvec ub_data;
+static uint32_t         ub_seg_crc[UB_SEGS_NR];
+
+static int ub_init(const char *opts M0_UNUSED)
+{
+	int rc;
+	int i;
+
+	rc = m0_bufvec_alloc(&ub_data, UB_SEGS_NR, UB_SEG_SIZE);
+	if (rc == 0) {
+		for (i = 0; i < UB_SEGS_NR; ++i) {
+			memset(ub_data.ov_buf[i], 'a' + i % 26, UB_SEG_SIZE);
+			ub_seg_crc[i] = ~m0_crc32c(~0U, ub_data.ov_buf[i],
+						   UB_SEG_SIZE);
+		}
+	}
+	return rc;
+}
+
+static void ub_fini(void)
+{
+	m0_bufvec_free(&ub_data);
+}
+
+static void ub_pi(int type)
+{
+	union {
+		struct m0_md5_inc_context_pi md5c;
+		struct m0_crc32c_pi          crc;
+	}                 pi = {};
+	struct m0_pi_seed seed = { .pis_obj_id = M0_FID_INIT(OBJ_CONTAINER,
+							     OBJ_KEY) };
+	unsigned char     context[sizeof(MD5_CTX)];
+	int               rc;
+
+	((struct m0_generic_pi *)&pi)->pi_hdr.pih_type = type;
+	rc = m0_client_calculate_pi((struct m0_generic_pi *)&pi, &seed,
+				    &ub_data, M0_PI_CALC_UNIT_ZERO, context,
+				    NULL);
+	M0_UB_ASSERT(rc == 0);
+}
+
+static void ub_md5_inc_context(int i)
+{
+	ub_pi(M0_PI_TYPE_MD5_INC_CONTEXT);
+}
+
+static void ub_crc32c(int i)
+{
+	ub_pi(M0_PI_TYPE_CRC);
+}
+
+/* Unit checksum out of the segment ones, no data is touched. */
+static void ub_crc32c_combine(int i)
+{
+	uint32_t crc = ub_seg_crc[0];
+	int      j;
+
+	for (j = 1; j < UB_SEGS_NR; ++j)
+		crc = m0_crc32c_combine(crc, ub_seg_crc[j], UB_SEG_SIZE);
+	M0_UB_ASSERT(crc != 0);
+}
+
+struct m0_ub_set m0_cksum_ub = {
+	.us_name = "cksum-ub",
+	.us_init = ub_init,
+	.us_fini = ub_fini,
+	.us_run  = {
+		{ .ub_name          = "md5-inc-context",
+		  .ub_iter          = UB_ITER,
+		  .ub_block_size    = UB_UNIT_SIZE,
+		  .ub_blocks_per_op = 1,
+		  .ub_round         = ub_md5_inc_context },
+		{ .ub_name          = "crc32c",
+		  .ub_iter          = UB_ITER,
+		  .ub_block_size    = UB_UNIT_SIZE,
+		  .ub_blocks_per_op = 1,
+		  .ub_round         = ub_crc32c },
+		{ .ub_name          = "crc32c-combine",
+		  .ub_iter          = UB_ITER,
+		  .ub_block_size    = UB_UNIT_SIZE,
+		  .ub_blocks_per_op = 1,
+		  .ub_round         = ub_crc32c_combine },
+		{ .ub_name = NULL }
+	}
+};
+
 #undef M0_TRACE_SUBSYSTEM
@@ -0,0 +1,150 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "ut/ut.h"            /* M0_UT_ASSERT */
+#include "motr/ut/client.h"
+
+/* Include the c file to test static helpers. */
+#include "motr/ra.c"
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_CLIENT
+#include "lib/trace.h"
+
+struct m0_ut_suite ut_suite_ra;
+
+enum {
+	UT_RA_GRP = 1 << 16
+};
+
+static struct m0_obj_ra ut_ra;
+
+static void ut_ra_init(void)
+{
+	M0_SET0(&ut_ra);
+	m0_mutex_init(&ut_ra.or_lock);
+	m0_semaphore_init(&ut_ra.or_wake, 0);
+	ut_ra.or_grp = UT_RA_GRP;
+	ut_ra.or_size = UT_RA_GRP;
+	ut_ra.or_size_max = 4 * UT_RA_GRP;
+}
+
+static void ut_ra_fini(void)
+{
+	m0_semaphore_fini(&ut_ra.or_wake);
+	m0_mutex_fini(&ut_ra.or_lock);
+}
+
+/**
+ * Tests that sequential reads fetch the following windows, two at most,
+ * and that consumed windows are reused.
+ */
+static void ut_test_ra_schedule(void)
+{
+	struct m0_obj_ra_win *w0 = &ut_ra.or_win[0];
+	struct m0_obj_ra_win *w1 = &ut_ra.or_win[1];
+
+	ut_ra_init();
+	m0_mutex_lock(&ut_ra.or_lock);
+	/* The first read of the stream fetches the group it ends in. */
+	ra_schedule(&ut_ra, 0, 4096);
+	M0_UT_ASSERT(w0->rw_state == RWS_FETCHING);
+	M0_UT_ASSERT(w0->rw_start == 0 && w0->rw_size == UT_RA_GRP);
+	M0_UT_ASSERT(m0_semaphore_value(&ut_ra.or_wake) == 1);
+	/* The next one is fetched after the window being fetched. */
+	ut_ra.or_size = 2 * UT_RA_GRP;
+	ra_schedule(&ut_ra, 4096, 8192);
+	M0_UT_ASSERT(w1->rw_state == RWS_FETCHING);
+	M0_UT_ASSERT(w1->rw_start == UT_RA_GRP);
+	M0_UT_ASSERT(w1->rw_size == 2 * UT_RA_GRP);
+	/* No free window. */
+	ra_schedule(&ut_ra, 8192, 12288);
+	M0_UT_ASSERT(m0_semaphore_value(&ut_ra.or_wake) == 2);
+	/* The first window is consumed and reused. */
+	w0->rw_state = RWS_VALID;
+	w1->rw_state = RWS_VALID;
+	ut_ra.or_size = 16 * UT_RA_GRP;
+	ra_schedule(&ut_ra, UT_RA_GRP, UT_RA_GRP + 4096);
+	M0_UT_ASSERT(w0->rw_state == RWS_FETCHING);
+	M0_UT_ASSERT(w0->rw_start == 3 * UT_RA_GRP);
+	/* Window size is limited by the buffer size. */
+	M0_UT_ASSERT(w0->rw_size == 4 * UT_RA_GRP);
+	m0_mutex_unlock(&ut_ra.or_lock);
+	ut_ra_fini();
+}
+
+/**
+ * Tests that writes drop overlapped windows.
+ */
+static void ut_test_ra_invalidate(void)
+{
+	struct m0_obj_ra_win *w0 = &ut_ra.or_win[0];
+	struct m0_obj_ra_win *w1 = &ut_ra.or_win[1];
+
+	ut_ra_init();
+	m0_mutex_lock(&ut_ra.or_lock);
+	*w0 = (struct m0_obj_ra_win) {
+		.rw_state = RWS_VALID,
+		.rw_start = 0,
+		.rw_size  = UT_RA_GRP
+	};
+	*w1 = (struct m0_obj_ra_win) {
+		.rw_state = RWS_FETCHING,
+		.rw_start = UT_RA_GRP,
+		.rw_size  = UT_RA_GRP
+	};
+	ra_invalidate(&ut_ra, 2 * UT_RA_GRP, 3 * UT_RA_GRP);
+	M0_UT_ASSERT(w0->rw_state == RWS_VALID);
+	M0_UT_ASSERT(w1->rw_state == RWS_FETCHING && !w1->rw_stale);
+	M0_UT_ASSERT(ra_win_find(&ut_ra, UT_RA_GRP - 1) == w0);
+	ra_invalidate(&ut_ra, UT_RA_GRP - 4096, UT_RA_GRP + 4096);
+	M0_UT_ASSERT(w0->rw_state == RWS_EMPTY);
+	M0_UT_ASSERT(w1->rw_state == RWS_FETCHING && w1->rw_stale);
+	M0_UT_ASSERT(ra_win_find(&ut_ra, 0) == NULL);
+	m0_mutex_unlock(&ut_ra.or_lock);
+	ut_ra_fini();
+}
+
+struct m0_ut_suite ut_suite_ra = {
+	.ts_name = "ra-ut",
+	.ts_init = NULL,
+	.ts_fini = NULL,
+	.ts_tests = {
+		{ "ra-schedule",   &ut_test_ra_schedule },
+		{ "ra-invalidate", &ut_test_ra_invalidate },
+		{ NULL, NULL }
+	}
+};
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
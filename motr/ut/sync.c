@@ -180,6 +180,7 @@ static void fake_setup(void)
 	spti_tlist_init(&obj.ob_entity.en_pending_tx);
 
 	m0_mutex_init(&service.sc_max_pending_tx_lock);
+	m0_chan_init(&service.sc_fsync_chan, &service.sc_max_pending_tx_lock);
 	service.sc_type = M0_CST_IOS;
 	service.sc_rlink.rlk_sess.s_sm.sm_state = M0_RPC_SESSION_IDLE;
 	service.sc_rlink.rlk_sess.s_conn = &conn;
@@ -257,11 +258,35 @@ static void ut_test_sync_request_fop_send(void)
 	M0_UT_ASSERT(ffd->ff_be_remid.tri_locality == stx.stx_tri.tri_locality);
 	M0_UT_ASSERT(ffd->ff_fsync_mode == M0_FSYNC_MODE_ACTIVE);
 	M0_UT_ASSERT(ut_fop_fini_count == 0);
+	/* The first fop to the service is shared with other requests. */
+	M0_UT_ASSERT(sfw->sfw_shared);
+	M0_UT_ASSERT(service.sc_fsync_txid == stx.stx_tri.tri_txid);
 
 	/* reset anything that got initalised */
 	m0_fop_fini(&sfw->sfw_fop);
 	m0_free(sfw);
 	M0_SET0(&stx);
+	service.sc_fsync_txid = 0;
+
+	/* The fop asks for the largest pending txid of the service */
+	ut_reset_stub_counters();
+	ut_post_rpc_return = 0;
+	stx.stx_service_ctx = &service;
+	stx.stx_tri.tri_txid = 4000ULL;
+	stx.stx_tri.tri_locality = 11;
+	service.sc_max_pending_tx.stx_tri.tri_txid = 5000ULL;
+	service.sc_max_pending_tx.stx_tri.tri_locality = 12;
+	rv = sync_request_fop_send(NULL, &stx,
+				   M0_FSYNC_MODE_ACTIVE, false, &sfw);
+	M0_UT_ASSERT(rv == 0);
+	ffd = m0_fop_data(&sfw->sfw_fop);
+	M0_UT_ASSERT(ffd->ff_be_remid.tri_txid == 5000ULL);
+	M0_UT_ASSERT(ffd->ff_be_remid.tri_locality == 12);
+	m0_fop_fini(&sfw->sfw_fop);
+	m0_free(sfw);
+	M0_SET0(&stx);
+	M0_SET0(&service.sc_max_pending_tx);
+	service.sc_fsync_txid = 0;
 
 	/* cause post_rpc to fail */
 	ut_reset_stub_counters();
@@ -0,0 +1,225 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "ut/ut.h"            /* M0_UT_ASSERT */
+#include "motr/ut/client.h"
+
+/* Include the c file to test static helpers. */
+#include "motr/wbc.c"
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_CLIENT
+#include "lib/trace.h"
+
+struct m0_ut_suite         ut_suite_wbc;
+
+enum {
+	UT_WBC_SHIFT = 12,
+	UT_WBC_BLOCK = 1 << UT_WBC_SHIFT
+};
+
+static struct m0_obj     ut_obj;
+static struct m0_obj_wbc ut_wbc;
+
+static void ut_wbc_init(void)
+{
+	int rc;
+
+	M0_SET0(&ut_obj);
+	M0_SET0(&ut_wbc);
+	ut_obj.ob_attr.oa_bshift = UT_WBC_SHIFT;
+	ut_obj.ob_wbc = &ut_wbc;
+	ut_wbc.ow_obj = &ut_obj;
+	ut_wbc.ow_nr_max = 16;
+	rc = wbc_blocks_htable_init(&ut_wbc.ow_blocks, 16);
+	M0_UT_ASSERT(rc == 0);
+	m0_mutex_init(&ut_wbc.ow_lock);
+}
+
+static void ut_wbc_fini(void)
+{
+	struct wbc_block *blk;
+
+	m0_mutex_lock(&ut_wbc.ow_lock);
+	m0_htable_for(wbc_blocks, blk, &ut_wbc.ow_blocks) {
+		wbc_block_del(&ut_wbc, blk);
+	} m0_htable_endfor;
+	M0_UT_ASSERT(ut_wbc.ow_nr == 0);
+	m0_mutex_unlock(&ut_wbc.ow_lock);
+	m0_mutex_fini(&ut_wbc.ow_lock);
+	wbc_blocks_htable_fini(&ut_wbc.ow_blocks);
+}
+
+/**
+ * Tests that contiguous blocks are coalesced into a single segment of a
+ * flush.
+ */
+static void ut_test_wbc_vecs_build(void)
+{
+	static const struct wbc_snap snap[] = {
+		{ .ws_index = 5 }, { .ws_index = 6 }, { .ws_index = 7 },
+		{ .ws_index = 10 }, { .ws_index = 12 }, { .ws_index = 13 }
+	};
+	static char        buf[ARRAY_SIZE(snap) * UT_WBC_BLOCK];
+	struct m0_indexvec ext;
+	struct m0_bufvec   data;
+	int                rc;
+
+	rc = wbc_vecs_build(snap, ARRAY_SIZE(snap), UT_WBC_SHIFT, buf,
+			    &ext, &data);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(ext.iv_vec.v_nr == 3);
+	M0_UT_ASSERT(data.ov_vec.v_nr == 3);
+	M0_UT_ASSERT(ext.iv_index[0] == 5 * UT_WBC_BLOCK);
+	M0_UT_ASSERT(ext.iv_vec.v_count[0] == 3 * UT_WBC_BLOCK);
+	M0_UT_ASSERT(ext.iv_index[1] == 10 * UT_WBC_BLOCK);
+	M0_UT_ASSERT(ext.iv_vec.v_count[1] == UT_WBC_BLOCK);
+	M0_UT_ASSERT(ext.iv_index[2] == 12 * UT_WBC_BLOCK);
+	M0_UT_ASSERT(ext.iv_vec.v_count[2] == 2 * UT_WBC_BLOCK);
+	M0_UT_ASSERT(data.ov_buf[0] == buf);
+	M0_UT_ASSERT(data.ov_buf[1] == buf + 3 * UT_WBC_BLOCK);
+	M0_UT_ASSERT(data.ov_buf[2] == buf + 4 * UT_WBC_BLOCK);
+	M0_UT_ASSERT(m0_vec_count(&data.ov_vec) ==
+		     ARRAY_SIZE(snap) * UT_WBC_BLOCK);
+	m0_bufvec_free2(&data);
+	m0_indexvec_free(&ext);
+}
+
+/**
+ * Tests copying of written data into the cache and overlaying of cached
+ * blocks on read data.
+ */
+static void ut_test_wbc_copy_read(void)
+{
+	struct m0_op_io  *ioo;
+	struct wbc_block *blk;
+	char             *buf;
+	int               rc;
+
+	ut_wbc_init();
+	M0_ALLOC_PTR(ioo);
+	M0_UT_ASSERT(ioo != NULL);
+	buf = m0_alloc(4 * UT_WBC_BLOCK);
+	M0_UT_ASSERT(buf != NULL);
+	ioo->ioo_obj = &ut_obj;
+	rc = m0_indexvec_alloc(&ioo->ioo_ext, 1) ?:
+		m0_bufvec_empty_alloc(&ioo->ioo_data, 1);
+	M0_UT_ASSERT(rc == 0);
+
+	/* Write blocks 1 and 2. */
+	memset(buf, 'a', 2 * UT_WBC_BLOCK);
+	ioo->ioo_ext.iv_index[0] = UT_WBC_BLOCK;
+	ioo->ioo_ext.iv_vec.v_count[0] = 2 * UT_WBC_BLOCK;
+	ioo->ioo_data.ov_buf[0] = buf;
+	ioo->ioo_data.ov_vec.v_count[0] = 2 * UT_WBC_BLOCK;
+	m0_mutex_lock(&ut_wbc.ow_lock);
+	rc = wbc_copy(&ut_wbc, ioo);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(ut_wbc.ow_nr == 2);
+	/* Overwrite block 2. */
+	memset(buf, 'b', UT_WBC_BLOCK);
+	ioo->ioo_ext.iv_index[0] = 2 * UT_WBC_BLOCK;
+	ioo->ioo_ext.iv_vec.v_count[0] = UT_WBC_BLOCK;
+	ioo->ioo_data.ov_vec.v_count[0] = UT_WBC_BLOCK;
+	rc = wbc_copy(&ut_wbc, ioo);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(ut_wbc.ow_nr == 2);
+	blk = wbc_block_lookup(&ut_wbc, 1);
+	M0_UT_ASSERT(blk != NULL && blk->wb_seq == 1);
+	blk = wbc_block_lookup(&ut_wbc, 2);
+	M0_UT_ASSERT(blk != NULL && blk->wb_seq == 2);
+	m0_mutex_unlock(&ut_wbc.ow_lock);
+
+	/* Read blocks 0..3. */
+	memset(buf, 0, 4 * UT_WBC_BLOCK);
+	ioo->ioo_oo.oo_oc.oc_op.op_code = M0_OC_READ;
+	ioo->ioo_ext.iv_index[0] = 0;
+	ioo->ioo_ext.iv_vec.v_count[0] = 4 * UT_WBC_BLOCK;
+	ioo->ioo_data.ov_vec.v_count[0] = 4 * UT_WBC_BLOCK;
+	m0__obj_wbc_read(ioo);
+	M0_UT_ASSERT(buf[0] == 0 && buf[UT_WBC_BLOCK - 1] == 0);
+	M0_UT_ASSERT(buf[UT_WBC_BLOCK] == 'a');
+	M0_UT_ASSERT(buf[2 * UT_WBC_BLOCK - 1] == 'a');
+	M0_UT_ASSERT(buf[2 * UT_WBC_BLOCK] == 'b');
+	M0_UT_ASSERT(buf[3 * UT_WBC_BLOCK] == 0);
+
+	m0_bufvec_free2(&ioo->ioo_data);
+	m0_indexvec_free(&ioo->ioo_ext);
+	m0_free(buf);
+	m0_free(ioo);
+	ut_wbc_fini();
+}
+
+/**
+ * Tests operations that must flush the cache before they are created.
+ */
+static void ut_test_wbc_flush_needed(void)
+{
+	struct m0_indexvec ext;
+	m0_bindex_t        index = UT_WBC_BLOCK;
+	m0_bcount_t        count = UT_WBC_BLOCK;
+
+	ut_wbc_init();
+	ext = (struct m0_indexvec) {
+		.iv_vec = { .v_nr = 1, .v_count = &count },
+		.iv_index = &index
+	};
+	M0_UT_ASSERT(!m0__obj_wbc_flush_needed(&ut_obj, M0_OC_WRITE,
+					       &ext, NULL));
+	M0_UT_ASSERT(!m0__obj_wbc_flush_needed(&ut_obj, M0_OC_READ,
+					       &ext, NULL));
+	M0_UT_ASSERT(m0__obj_wbc_flush_needed(&ut_obj, M0_OC_FREE,
+					      &ext, NULL));
+	index = UT_WBC_BLOCK / 2;
+	M0_UT_ASSERT(m0__obj_wbc_flush_needed(&ut_obj, M0_OC_READ,
+					      &ext, NULL));
+	ut_obj.ob_wbc = NULL;
+	M0_UT_ASSERT(!m0__obj_wbc_flush_needed(&ut_obj, M0_OC_FREE,
+					       &ext, NULL));
+	ut_wbc_fini();
+}
+
+struct m0_ut_suite ut_suite_wbc = {
+	.ts_name = "wbc-ut",
+	.ts_init = NULL,
+	.ts_fini = NULL,
+	.ts_tests = {
+		{ "wbc-vecs-build", &ut_test_wbc_vecs_build },
+		{ "wbc-copy-read",  &ut_test_wbc_copy_read },
+		{ "wbc-flush-needed", &ut_test_wbc_flush_needed },
+		{ NULL, NULL }
+	}
+};
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
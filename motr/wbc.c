@@ -0,0 +1,574 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include <stdlib.h>                   /* qsort */
+
+#include "motr/client.h"
+#include "motr/client_internal.h"
+#include "motr/io.h"                  /* obj_buffer_size, data_size */
+#include "motr/magic.h"
+#include "motr/wbc.h"
+
+#include "lib/arith.h"                /* M0_3WAY, min64u */
+#include "lib/errno.h"
+#include "lib/memory.h"
+#include "lib/misc.h"                 /* memcpy */
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_CLIENT
+#include "lib/trace.h"
+
+/**
+ * @addtogroup client
+ *
+ * @{
+ */
+
+enum {
+	/** Upper limit of the number of hash buckets of a cache. */
+	WBC_BUCKET_NR_MAX = 4096
+};
+
+/** A cached block of an object. */
+struct wbc_block {
+	uint64_t        wb_magic;
+	struct m0_hlink wb_hlink;
+	/** Index of the block in the object. */
+	uint64_t        wb_index;
+	/** m0_obj_wbc::ow_seq of the last write of the block. */
+	uint64_t        wb_seq;
+	char           *wb_data;
+};
+
+/** A block selected to be flushed. */
+struct wbc_snap {
+	uint64_t ws_index;
+	uint64_t ws_seq;
+};
+
+static uint64_t wbc_block_hash(const struct m0_htable *htable,
+			       const uint64_t *index)
+{
+	return m0_hash(*index) % htable->h_bucket_nr;
+}
+
+static bool wbc_block_eq(const uint64_t *i0, const uint64_t *i1)
+{
+	return *i0 == *i1;
+}
+
+M0_HT_DESCR_DEFINE(wbc_blocks, "Object write-back cache", static,
+		   struct wbc_block, wb_hlink, wb_magic,
+		   M0_WBC_BLOCK_MAGIC, M0_WBC_BLOCK_HEAD_MAGIC,
+		   wb_index, wbc_block_hash, wbc_block_eq);
+M0_HT_DEFINE(wbc_blocks, static, struct wbc_block, uint64_t);
+
+M0_TL_DESCR_DEFINE(wbcs, "Object write-back caches", static,
+		   struct m0_obj_wbc, ow_linkage, ow_magic,
+		   M0_WBC_MAGIC, M0_WBC_HEAD_MAGIC);
+M0_TL_DEFINE(wbcs, static, struct m0_obj_wbc);
+
+static uint32_t wbc_bshift(const struct m0_obj_wbc *wbc)
+{
+	return wbc->ow_obj->ob_attr.oa_bshift;
+}
+
+static struct wbc_block *wbc_block_lookup(struct m0_obj_wbc *wbc,
+					  uint64_t index)
+{
+	M0_PRE(m0_mutex_is_locked(&wbc->ow_lock));
+	return wbc_blocks_htable_lookup(&wbc->ow_blocks, &index);
+}
+
+static struct wbc_block *wbc_block_add(struct m0_obj_wbc *wbc, uint64_t index)
+{
+	struct wbc_block *blk;
+
+	M0_PRE(m0_mutex_is_locked(&wbc->ow_lock));
+
+	M0_ALLOC_PTR(blk);
+	if (blk == NULL)
+		return NULL;
+	blk->wb_data = m0_alloc(M0_BITS(wbc_bshift(wbc)));
+	if (blk->wb_data == NULL) {
+		m0_free(blk);
+		return NULL;
+	}
+	blk->wb_index = index;
+	wbc_blocks_tlink_init(blk);
+	wbc_blocks_htable_add(&wbc->ow_blocks, blk);
+	wbc->ow_nr++;
+	return blk;
+}
+
+static void wbc_block_del(struct m0_obj_wbc *wbc, struct wbc_block *blk)
+{
+	M0_PRE(m0_mutex_is_locked(&wbc->ow_lock));
+	M0_PRE(wbc->ow_nr > 0);
+
+	wbc_blocks_htable_del(&wbc->ow_blocks, blk);
+	wbc_blocks_tlink_fini(blk);
+	wbc->ow_nr--;
+	m0_free(blk->wb_data);
+	m0_free(blk);
+}
+
+static bool wbc_ext_is_aligned(const struct m0_indexvec *ext, uint64_t unit)
+{
+	return m0_forall(i, ext->iv_vec.v_nr,
+			 ext->iv_index[i] % unit == 0 &&
+			 ext->iv_vec.v_count[i] % unit == 0);
+}
+
+/**
+ * Iterates over indices of the blocks of block-aligned extents.
+ */
+#define wbc_ext_for(ext, bshift, idx)					\
+({									\
+	const struct m0_indexvec *__ext = (ext);			\
+	uint32_t                  __i;					\
+	uint64_t                  __end;				\
+									\
+	for (__i = 0; __i < __ext->iv_vec.v_nr; ++__i) {		\
+		__end = (__ext->iv_index[__i] +				\
+			 __ext->iv_vec.v_count[__i]) >> (bshift);	\
+		for (idx = __ext->iv_index[__i] >> (bshift);		\
+		     idx < __end; ++idx)
+
+#define wbc_ext_endfor }})
+
+/** Wakes the flusher up, unless it is already woken. */
+static void wbc_wake(struct m0_obj_wbc *wbc)
+{
+	if (m0_semaphore_value(&wbc->ow_wake) == 0)
+		m0_semaphore_up(&wbc->ow_wake);
+}
+
+/** Copies data of a write into the cache. */
+static int wbc_copy(struct m0_obj_wbc *wbc, struct m0_op_io *ioo)
+{
+	struct m0_bufvec_cursor cur;
+	struct wbc_block       *blk;
+	uint32_t                bshift = wbc_bshift(wbc);
+	uint64_t                idx;
+
+	M0_PRE(m0_mutex_is_locked(&wbc->ow_lock));
+
+	++wbc->ow_seq;
+	m0_bufvec_cursor_init(&cur, &ioo->ioo_data);
+	wbc_ext_for(&ioo->ioo_ext, bshift, idx) {
+		blk = wbc_block_lookup(wbc, idx) ?: wbc_block_add(wbc, idx);
+		if (blk == NULL)
+			return M0_ERR(-ENOMEM);
+		m0_bufvec_cursor_copyfrom(&cur, blk->wb_data, M0_BITS(bshift));
+		blk->wb_seq = wbc->ow_seq;
+	} wbc_ext_endfor;
+	return 0;
+}
+
+M0_INTERNAL bool m0__obj_wbc_absorb(struct m0_op_io *ioo)
+{
+	struct m0_obj_wbc *wbc = ioo->ioo_obj->ob_wbc;
+	struct m0_op      *op  = &ioo->ioo_oo.oo_oc.oc_op;
+	uint32_t           bshift;
+	uint64_t           blk_nr = 0;
+	uint64_t           new_nr = 0;
+	uint64_t           idx;
+	struct wbc_block  *blk;
+	int                rc;
+
+	if (wbc == NULL || ioo->ioo_cache_io)
+		return false;
+	bshift = wbc_bshift(wbc);
+	if (op->op_code == M0_OC_FREE) {
+		m0_mutex_lock(&wbc->ow_lock);
+		wbc_ext_for(&ioo->ioo_ext, bshift, idx) {
+			blk = wbc_block_lookup(wbc, idx);
+			if (blk != NULL)
+				wbc_block_del(wbc, blk);
+		} wbc_ext_endfor;
+		m0_mutex_unlock(&wbc->ow_lock);
+		return false;
+	}
+	if (op->op_code != M0_OC_WRITE || ioo->ioo_attr.ov_vec.v_nr != 0 ||
+	    !wbc_ext_is_aligned(&ioo->ioo_ext, M0_BITS(bshift)))
+		return false;
+
+	m0_mutex_lock(&wbc->ow_lock);
+	wbc_ext_for(&ioo->ioo_ext, bshift, idx) {
+		blk_nr++;
+		new_nr += wbc_block_lookup(wbc, idx) == NULL;
+	} wbc_ext_endfor;
+	/*
+	 * A write overlapping cached blocks is always absorbed, otherwise a
+	 * later flush would overwrite it with older data.
+	 */
+	if (new_nr == blk_nr) {
+		if (wbc_ext_is_aligned(&ioo->ioo_ext,
+				       data_size(pdlayout_get(ioo)))) {
+			m0_mutex_unlock(&wbc->ow_lock);
+			return false;
+		}
+		if (wbc->ow_nr + new_nr > wbc->ow_nr_max) {
+			wbc_wake(wbc);
+			m0_mutex_unlock(&wbc->ow_lock);
+			return false;
+		}
+	}
+	rc = wbc_copy(wbc, ioo);
+	if (wbc->ow_nr >= wbc->ow_nr_max)
+		wbc_wake(wbc);
+	m0_mutex_unlock(&wbc->ow_lock);
+
+	M0_LOG(M0_DEBUG, "op=%p absorbed %"PRIu64" blocks, %"PRIu64" new",
+	       op, blk_nr, new_nr);
+	m0__obj_io_cached_done(ioo, rc);
+	return true;
+}
+
+M0_INTERNAL void m0__obj_wbc_read(struct m0_op_io *ioo)
+{
+	struct m0_obj_wbc      *wbc = ioo->ioo_obj->ob_wbc;
+	struct m0_indexvec     *ext = &ioo->ioo_ext;
+	struct m0_bufvec_cursor cur;
+	struct wbc_block       *blk;
+	uint32_t                bshift;
+	uint64_t                end;
+	uint64_t                idx;
+	uint32_t                i;
+
+	M0_PRE(ioo->ioo_oo.oo_oc.oc_op.op_code == M0_OC_READ);
+
+	if (wbc == NULL)
+		return;
+	bshift = wbc_bshift(wbc);
+	m0_mutex_lock(&wbc->ow_lock);
+	m0_bufvec_cursor_init(&cur, &ioo->ioo_data);
+	for (i = 0; wbc->ow_nr > 0 && i < ext->iv_vec.v_nr; ++i) {
+		/* Blocks of unaligned segments were flushed by m0_obj_op(). */
+		if (ext->iv_index[i] % M0_BITS(bshift) != 0 ||
+		    ext->iv_vec.v_count[i] % M0_BITS(bshift) != 0) {
+			m0_bufvec_cursor_move(&cur, ext->iv_vec.v_count[i]);
+			continue;
+		}
+		end = (ext->iv_index[i] + ext->iv_vec.v_count[i]) >> bshift;
+		for (idx = ext->iv_index[i] >> bshift; idx < end; ++idx) {
+			blk = wbc_block_lookup(wbc, idx);
+			if (blk != NULL)
+				m0_bufvec_cursor_copyto(&cur, blk->wb_data,
+							M0_BITS(bshift));
+			else
+				m0_bufvec_cursor_move(&cur, M0_BITS(bshift));
+		}
+	}
+	m0_mutex_unlock(&wbc->ow_lock);
+}
+
+M0_INTERNAL bool m0__obj_wbc_flush_needed(const struct m0_obj *obj,
+					  enum m0_obj_opcode opcode,
+					  const struct m0_indexvec *ext,
+					  const struct m0_bufvec *attr)
+{
+	return obj->ob_wbc != NULL &&
+		(opcode == M0_OC_FREE ||
+		 (opcode == M0_OC_WRITE && attr != NULL &&
+		  attr->ov_vec.v_nr != 0) ||
+		 !wbc_ext_is_aligned(ext, obj_buffer_size(obj)));
+}
+
+static int wbc_snap_cmp(const void *a, const void *b)
+{
+	const struct wbc_snap *s0 = a;
+	const struct wbc_snap *s1 = b;
+
+	return M0_3WAY(s0->ws_index, s1->ws_index);
+}
+
+/**
+ * Builds extents and buffers of a flush. Contiguous blocks are coalesced
+ * into a single segment.
+ */
+static int wbc_vecs_build(const struct wbc_snap *snap, uint64_t nr,
+			  uint32_t bshift, char *buf,
+			  struct m0_indexvec *ext, struct m0_bufvec *data)
+{
+	uint32_t seg_nr = 1;
+	uint32_t seg;
+	uint64_t i;
+	int      rc;
+
+	for (i = 1; i < nr; ++i)
+		seg_nr += snap[i].ws_index != snap[i - 1].ws_index + 1;
+	rc = m0_indexvec_alloc(ext, seg_nr);
+	if (rc != 0)
+		return M0_ERR(rc);
+	rc = m0_bufvec_empty_alloc(data, seg_nr);
+	if (rc != 0) {
+		m0_indexvec_free(ext);
+		return M0_ERR(rc);
+	}
+	for (i = 0, seg = 0; i < nr; ++i) {
+		if (i > 0 && snap[i].ws_index == snap[i - 1].ws_index + 1) {
+			ext->iv_vec.v_count[seg - 1] += M0_BITS(bshift);
+			data->ov_vec.v_count[seg - 1] += M0_BITS(bshift);
+			continue;
+		}
+		ext->iv_index[seg] = snap[i].ws_index << bshift;
+		ext->iv_vec.v_count[seg] = M0_BITS(bshift);
+		data->ov_buf[seg] = buf + (i << bshift);
+		data->ov_vec.v_count[seg] = M0_BITS(bshift);
+		seg++;
+	}
+	M0_POST(seg == seg_nr);
+	return 0;
+}
+
+/**
+ * Writes all cached blocks to the object. Blocks not overwritten while the
+ * flush was in progress are dropped from the cache. On failure, blocks stay
+ * cached and the error is recorded in ->ow_rc.
+ */
+static int wbc_flush(struct m0_obj_wbc *wbc)
+{
+	struct m0_indexvec  ext  = {};
+	struct m0_bufvec    data = {};
+	struct wbc_snap    *snap = NULL;
+	struct wbc_block   *blk;
+	uint32_t            bshift = wbc_bshift(wbc);
+	char               *buf = NULL;
+	uint64_t            nr;
+	uint64_t            i;
+	int                 rc;
+
+	M0_ENTRY("wbc=%p", wbc);
+
+	m0_mutex_lock(&wbc->ow_flush_lock);
+	m0_mutex_lock(&wbc->ow_lock);
+	nr = wbc->ow_nr;
+	if (nr == 0) {
+		m0_mutex_unlock(&wbc->ow_lock);
+		m0_mutex_unlock(&wbc->ow_flush_lock);
+		return M0_RC(0);
+	}
+	M0_ALLOC_ARR(snap, nr);
+	buf = m0_alloc_aligned(nr << bshift, M0_NETBUF_SHIFT);
+	if (snap == NULL || buf == NULL) {
+		m0_mutex_unlock(&wbc->ow_lock);
+		rc = M0_ERR(-ENOMEM);
+		goto out;
+	}
+	i = 0;
+	m0_htable_for(wbc_blocks, blk, &wbc->ow_blocks) {
+		snap[i++] = (struct wbc_snap) {
+			.ws_index = blk->wb_index,
+			.ws_seq   = blk->wb_seq
+		};
+	} m0_htable_endfor;
+	qsort(snap, nr, sizeof snap[0], &wbc_snap_cmp);
+	for (i = 0; i < nr; ++i) {
+		blk = wbc_block_lookup(wbc, snap[i].ws_index);
+		memcpy(buf + (i << bshift), blk->wb_data, M0_BITS(bshift));
+	}
+	m0_mutex_unlock(&wbc->ow_lock);
+
+	rc = wbc_vecs_build(snap, nr, bshift, buf, &ext, &data);
+	if (rc == 0) {
+		rc = m0__obj_cache_io(wbc->ow_obj, M0_OC_WRITE, &ext, &data);
+		m0_bufvec_free2(&data);
+		m0_indexvec_free(&ext);
+	}
+	m0_mutex_lock(&wbc->ow_lock);
+	for (i = 0; rc == 0 && i < nr; ++i) {
+		blk = wbc_block_lookup(wbc, snap[i].ws_index);
+		if (blk != NULL && blk->wb_seq == snap[i].ws_seq)
+			wbc_block_del(wbc, blk);
+	}
+	m0_mutex_unlock(&wbc->ow_lock);
+out:
+	if (rc != 0) {
+		m0_mutex_lock(&wbc->ow_lock);
+		wbc->ow_rc = wbc->ow_rc ?: rc;
+		m0_mutex_unlock(&wbc->ow_lock);
+	}
+	m0_mutex_unlock(&wbc->ow_flush_lock);
+	m0_free_aligned(buf, nr << bshift, M0_NETBUF_SHIFT);
+	m0_free(snap);
+	return M0_RC(rc);
+}
+
+static void wbc_flusher(struct m0_obj_wbc *wbc)
+{
+	while (!wbc->ow_shutdown) {
+		if (wbc->ow_period != 0)
+			m0_semaphore_timeddown(&wbc->ow_wake,
+					       m0_time_add(m0_time_now(),
+							   wbc->ow_period));
+		else
+			m0_semaphore_down(&wbc->ow_wake);
+		if (!wbc->ow_shutdown)
+			(void)wbc_flush(wbc);
+	}
+}
+
+int m0_obj_wbc_enable(struct m0_obj *obj, m0_bcount_t size_max,
+		      m0_time_t period)
+{
+	struct m0_client  *m0c = m0__obj_instance(obj);
+	struct m0_obj_wbc *wbc;
+	int                rc;
+
+	M0_ENTRY("obj=%p size_max=%"PRIu64, obj, size_max);
+	M0_PRE(obj->ob_wbc == NULL);
+	M0_PRE(obj->ob_attr.oa_bshift >= M0_MIN_BUF_SHIFT);
+
+	if (size_max < obj_buffer_size(obj))
+		return M0_ERR(-EINVAL);
+	M0_ALLOC_PTR(wbc);
+	if (wbc == NULL)
+		return M0_ERR(-ENOMEM);
+	wbc->ow_obj = obj;
+	wbc->ow_nr_max = size_max >> obj->ob_attr.oa_bshift;
+	wbc->ow_period = period;
+	rc = wbc_blocks_htable_init(&wbc->ow_blocks,
+				    min64u(wbc->ow_nr_max, WBC_BUCKET_NR_MAX));
+	if (rc != 0) {
+		m0_free(wbc);
+		return M0_ERR(rc);
+	}
+	m0_mutex_init(&wbc->ow_lock);
+	m0_mutex_init(&wbc->ow_flush_lock);
+	m0_semaphore_init(&wbc->ow_wake, 0);
+	rc = M0_THREAD_INIT(&wbc->ow_thread, struct m0_obj_wbc *, NULL,
+			    &wbc_flusher, wbc, "m0_obj_wbc");
+	if (rc != 0) {
+		m0_semaphore_fini(&wbc->ow_wake);
+		m0_mutex_fini(&wbc->ow_flush_lock);
+		m0_mutex_fini(&wbc->ow_lock);
+		wbc_blocks_htable_fini(&wbc->ow_blocks);
+		m0_free(wbc);
+		return M0_ERR(rc);
+	}
+	obj->ob_wbc = wbc;
+	m0_mutex_lock(&m0c->m0c_wbc_lock);
+	wbcs_tlink_init_at_tail(wbc, &m0c->m0c_wbcs);
+	m0_mutex_unlock(&m0c->m0c_wbc_lock);
+	return M0_RC(0);
+}
+M0_EXPORTED(m0_obj_wbc_enable);
+
+int m0_obj_wbc_flush(struct m0_obj *obj)
+{
+	struct m0_obj_wbc *wbc = obj->ob_wbc;
+	int                rc;
+
+	M0_ENTRY("obj=%p", obj);
+
+	if (wbc == NULL)
+		return M0_RC(0);
+	(void)wbc_flush(wbc);
+	m0_mutex_lock(&wbc->ow_lock);
+	rc = wbc->ow_rc;
+	wbc->ow_rc = 0;
+	m0_mutex_unlock(&wbc->ow_lock);
+	return M0_RC(rc);
+}
+M0_EXPORTED(m0_obj_wbc_flush);
+
+int m0_obj_wbc_disable(struct m0_obj *obj)
+{
+	struct m0_client  *m0c = m0__obj_instance(obj);
+	struct m0_obj_wbc *wbc = obj->ob_wbc;
+	struct wbc_block  *blk;
+	int                rc;
+
+	M0_ENTRY("obj=%p", obj);
+
+	if (wbc == NULL)
+		return M0_RC(0);
+	wbc->ow_shutdown = true;
+	m0_semaphore_up(&wbc->ow_wake);
+	m0_thread_join(&wbc->ow_thread);
+	m0_thread_fini(&wbc->ow_thread);
+	rc = m0_obj_wbc_flush(obj);
+	if (rc != 0)
+		M0_LOG(M0_ERROR, "Cached data are lost: obj="U128X_F" rc=%d",
+		       U128_P(&obj->ob_entity.en_id), rc);
+
+	m0_mutex_lock(&m0c->m0c_wbc_lock);
+	wbcs_tlink_del_fini(wbc);
+	m0_mutex_unlock(&m0c->m0c_wbc_lock);
+	obj->ob_wbc = NULL;
+
+	m0_mutex_lock(&wbc->ow_lock);
+	m0_htable_for(wbc_blocks, blk, &wbc->ow_blocks) {
+		wbc_block_del(wbc, blk);
+	} m0_htable_endfor;
+	m0_mutex_unlock(&wbc->ow_lock);
+	wbc_blocks_htable_fini(&wbc->ow_blocks);
+	m0_semaphore_fini(&wbc->ow_wake);
+	m0_mutex_fini(&wbc->ow_flush_lock);
+	m0_mutex_fini(&wbc->ow_lock);
+	m0_free(wbc);
+	return M0_RC(rc);
+}
+M0_EXPORTED(m0_obj_wbc_disable);
+
+M0_INTERNAL int m0__obj_wbc_flush_all(struct m0_client *m0c)
+{
+	struct m0_obj_wbc *wbc;
+	int                rc = 0;
+
+	m0_mutex_lock(&m0c->m0c_wbc_lock);
+	m0_tl_for(wbcs, &m0c->m0c_wbcs, wbc) {
+		rc = m0_obj_wbc_flush(wbc->ow_obj) ?: rc;
+	} m0_tl_endfor;
+	m0_mutex_unlock(&m0c->m0c_wbc_lock);
+	return M0_RC(rc);
+}
+
+M0_INTERNAL void m0__obj_wbc_client_init(struct m0_client *m0c)
+{
+	m0_mutex_init(&m0c->m0c_wbc_lock);
+	wbcs_tlist_init(&m0c->m0c_wbcs);
+}
+
+M0_INTERNAL void m0__obj_wbc_client_fini(struct m0_client *m0c)
+{
+	wbcs_tlist_fini(&m0c->m0c_wbcs);
+	m0_mutex_fini(&m0c->m0c_wbc_lock);
+}
+
+/** @} end of client group */
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -0,0 +1,151 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __MOTR_WBC_H__
+#define __MOTR_WBC_H__
+
+/**
+ * @defgroup client
+ *
+ * Object write-back cache
+ * -----------------------
+ *
+ * Optional per-object cache enabled by m0_obj_wbc_enable(). WRITE operations
+ * that do not cover whole parity groups, and writes overlapping data already
+ * in the cache, are copied into the cache at launch and complete without any
+ * network i/o. Cached blocks are written to the object by a single coalesced
+ * WRITE operation (a flush), so that a stream of small writes costs one
+ * read-modify-write per parity group instead of one per write.
+ *
+ * A flush happens:
+ *
+ *     - on m0_obj_wbc_flush(), m0_entity_sync(), m0_sync() and
+ *       m0_obj_wbc_disable() (m0_obj_fini());
+ *
+ *     - every m0_obj_wbc::ow_period, in the flusher thread;
+ *
+ *     - when a write does not fit into the cache limit (memory pressure). The
+ *       write then goes to the object directly and the flusher is woken.
+ *
+ * Consistency:
+ *
+ *     - an absorbed write is STABLE when it is in the cache; it is neither
+ *       visible to other clients nor durable until flushed;
+ *
+ *     - READ operations of this client see the cached data: cached blocks are
+ *       copied over the data read from the object when the read completes;
+ *
+ *     - errors of background flushes are kept in the cache (the blocks stay
+ *       cached and are retried) and returned by the next m0_obj_wbc_flush(),
+ *       m0_entity_sync() or m0_sync();
+ *
+ *     - FREE operations and operations with segments not aligned to the
+ *       object block size flush the cache before they are created. Ordering
+ *       of such an operation with writes launched concurrently with it is not
+ *       defined, as it is not without the cache.
+ *
+ * Locking order: m0_client::m0c_wbc_lock, m0_obj_wbc::ow_flush_lock,
+ * m0_op::op_sm_group, m0_obj_wbc::ow_lock.
+ *
+ * @{
+ */
+
+#include "lib/types.h"
+#include "lib/mutex.h"
+#include "lib/semaphore.h"
+#include "lib/thread.h"
+#include "lib/time.h"
+#include "lib/tlist.h"
+#include "lib/hash.h"
+#include "motr/client.h"              /* m0_obj_opcode */
+
+struct m0_op_io;
+struct m0_client;
+
+struct m0_obj_wbc {
+	struct m0_obj      *ow_obj;
+	/** Protects cached blocks, counters and ->ow_rc. */
+	struct m0_mutex     ow_lock;
+	/** Cached blocks, keyed by block index. */
+	struct m0_htable    ow_blocks;
+	uint64_t            ow_nr;
+	uint64_t            ow_nr_max;
+	/** Incremented by every absorbed write. */
+	uint64_t            ow_seq;
+	/** First error of a background flush, not reported yet. */
+	int                 ow_rc;
+	/** Serialises flushes. */
+	struct m0_mutex     ow_flush_lock;
+	struct m0_thread    ow_thread;
+	/** Wakes the flusher up. */
+	struct m0_semaphore ow_wake;
+	m0_time_t           ow_period;
+	bool                ow_shutdown;
+	/** Linkage into m0_client::m0c_wbcs. */
+	struct m0_tlink     ow_linkage;
+	uint64_t            ow_magic;
+};
+
+M0_INTERNAL void m0__obj_wbc_client_init(struct m0_client *m0c);
+M0_INTERNAL void m0__obj_wbc_client_fini(struct m0_client *m0c);
+
+/**
+ * Called at launch of an object i/o operation. Returns true iff the operation
+ * is a write absorbed by the cache, in which case it is completed
+ * asynchronously without i/o.
+ *
+ * Drops cached blocks overwritten by a FREE operation.
+ */
+M0_INTERNAL bool m0__obj_wbc_absorb(struct m0_op_io *ioo);
+
+/** Copies cached blocks into the buffers of a completed READ operation. */
+M0_INTERNAL void m0__obj_wbc_read(struct m0_op_io *ioo);
+
+/**
+ * True iff an operation must be preceded by a flush: it is a FREE, a WRITE
+ * with block attributes or has segments not aligned to the object block size.
+ */
+M0_INTERNAL bool m0__obj_wbc_flush_needed(const struct m0_obj *obj,
+					  enum m0_obj_opcode opcode,
+					  const struct m0_indexvec *ext,
+					  const struct m0_bufvec *attr);
+
+/** Flushes all caches of the client instance. */
+M0_INTERNAL int  m0__obj_wbc_flush_all(struct m0_client *m0c);
+
+/** @} end of client group */
+#endif /* __MOTR_WBC_H__ */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -58,6 +58,7 @@ M0_INTERNAL bool m0_net_buffer_pool_invariant(const struct m0_net_buffer_pool
 		_0C(pool->nbp_ops != NULL) &&
 		_0C(m0_net_buffer_pool_is_locked(pool)) &&
 		_0C(pool->nbp_free <= pool->nbp_buf_nr) &&
+		_0C(pool->nbp_free_min <= pool->nbp_free) &&
 		_0C(pool->nbp_free ==
 		    m0_net_pool_tlist_length(&pool->nbp_lru)) &&
 		_0C(pool_colour_check(pool)) &&
@@ -94,6 +95,7 @@ M0_INTERNAL int m0_net_buffer_pool_init(struct m0_net_buffer_pool *pool,
 	pool->nbp_threshold  = threshold;
 	pool->nbp_ndom       = ndom;
 	pool->nbp_free       = 0;
+	pool->nbp_free_min   = 0;
 	pool->nbp_buf_nr     = 0;
 	pool->nbp_seg_nr     = seg_nr;
 	pool->nbp_seg_size   = seg_size;
@@ -101,25 +103,35 @@ M0_INTERNAL int m0_net_buffer_pool_init(struct m0_net_buffer_pool *pool,
 	pool->nbp_align      = shift;
 	pool->nbp_dont_dump  = dont_dump;
 
-	if (colours == 0)
+	if (colours == 0) {
 		pool->nbp_colours = NULL;
-	else {
+		pool->nbp_colour_node = NULL;
+	} else {
 		M0_ALLOC_ARR(pool->nbp_colours, colours);
-		if (pool->nbp_colours == NULL)
+		M0_ALLOC_ARR(pool->nbp_colour_node, colours);
+		if (pool->nbp_colours == NULL ||
+		    pool->nbp_colour_node == NULL) {
+			m0_free(pool->nbp_colours);
+			m0_free(pool->nbp_colour_node);
+			pool->nbp_colours = NULL;
 			return M0_ERR(-ENOMEM);
+		}
 	}
 	m0_mutex_init(&pool->nbp_mutex);
 	m0_net_pool_tlist_init(&pool->nbp_lru);
-	for (i = 0; i < colours; ++i)
+	for (i = 0; i < colours; ++i) {
 		m0_net_tm_tlist_init(&pool->nbp_colours[i]);
+		pool->nbp_colour_node[i] = M0_BUFFER_ANY_NODE;
+	}
 	return 0;
 }
 
 /**
-   Adds a buffer to the pool to increase the capacity.
+   Adds a buffer of the colour to the pool to increase the capacity.
    @pre m0_net_buffer_pool_is_locked(pool)
  */
-static bool net_buffer_pool_grow(struct m0_net_buffer_pool *pool);
+static bool net_buffer_pool_grow(struct m0_net_buffer_pool *pool,
+				 uint32_t colour);
 
 
 M0_INTERNAL int m0_net_buffer_pool_provision(struct m0_net_buffer_pool *pool,
@@ -129,7 +141,24 @@ M0_INTERNAL int m0_net_buffer_pool_provision(struct m0_net_buffer_pool *pool,
 	M0_PRE(m0_net_buffer_pool_invariant(pool));
 
 	while (buf_nr--) {
-		if (!net_buffer_pool_grow(pool))
+		if (!net_buffer_pool_grow(pool, M0_BUFFER_ANY_COLOUR))
+			return buffers;
+		buffers++;
+	}
+	M0_POST(m0_net_buffer_pool_invariant(pool));
+	return buffers;
+}
+
+M0_INTERNAL int m0_net_buffer_pool_provision_colour(struct m0_net_buffer_pool
+						    *pool, uint32_t buf_nr,
+						    uint32_t colour)
+{
+	int buffers = 0;
+	M0_PRE(m0_net_buffer_pool_invariant(pool));
+	M0_PRE(colour < pool->nbp_colours_nr);
+
+	while (buf_nr--) {
+		if (!net_buffer_pool_grow(pool, colour))
 			return buffers;
 		buffers++;
 	}
@@ -137,6 +166,16 @@ M0_INTERNAL int m0_net_buffer_pool_provision(struct m0_net_buffer_pool *pool,
 	return buffers;
 }
 
+M0_INTERNAL void m0_net_buffer_pool_colour_node_set(struct m0_net_buffer_pool
+						    *pool, uint32_t colour,
+						    uint32_t node)
+{
+	M0_PRE(m0_net_buffer_pool_is_locked(pool));
+	M0_PRE(colour < pool->nbp_colours_nr);
+
+	pool->nbp_colour_node[colour] = node;
+}
+
 /** It removes the given buffer from the pool */
 static void buffer_remove(struct m0_net_buffer_pool *pool,
 			  struct m0_net_buffer *nb)
@@ -148,6 +187,7 @@ static void buffer_remove(struct m0_net_buffer_pool *pool,
 	m0_bufvec_free_aligned_packed(&nb->nb_buffer, pool->nbp_align);
 	m0_free(nb);
 	M0_CNT_DEC(pool->nbp_buf_nr);
+	pool->nbp_free_min = min32u(pool->nbp_free_min, pool->nbp_free);
 	M0_POST(m0_net_buffer_pool_invariant(pool));
 }
 
@@ -180,6 +220,7 @@ M0_INTERNAL void m0_net_buffer_pool_fini(struct m0_net_buffer_pool *pool)
 		m0_net_tm_tlist_fini(&pool->nbp_colours[i]);
 	if (pool->nbp_colours != NULL)
 		m0_free(pool->nbp_colours);
+	m0_free(pool->nbp_colour_node);
 	m0_mutex_fini(&pool->nbp_mutex);
 }
 
@@ -211,10 +252,30 @@ static bool colour_is_valid(const struct m0_net_buffer_pool *pool,
 	return colour == M0_BUFFER_ANY_COLOUR || colour < pool->nbp_colours_nr;
 }
 
+/**
+   Returns the most recently used buffer of a colour of the same numa node as
+   the given colour, if any.
+ */
+static struct m0_net_buffer *node_buffer_get(struct m0_net_buffer_pool *pool,
+					     uint32_t colour)
+{
+	uint32_t node = pool->nbp_colour_node[colour];
+	uint32_t i;
+
+	if (node == M0_BUFFER_ANY_NODE)
+		return NULL;
+	for (i = 0; i < pool->nbp_colours_nr; ++i) {
+		if (pool->nbp_colour_node[i] == node &&
+		    !m0_net_tm_tlist_is_empty(&pool->nbp_colours[i]))
+			return m0_net_tm_tlist_head(&pool->nbp_colours[i]);
+	}
+	return NULL;
+}
+
 M0_INTERNAL struct m0_net_buffer *
 m0_net_buffer_pool_get(struct m0_net_buffer_pool *pool, uint32_t colour)
 {
-	struct m0_net_buffer *nb;
+	struct m0_net_buffer *nb = NULL;
 
 	M0_ENTRY();
 	M0_PRE_EX(m0_net_buffer_pool_invariant(pool));
@@ -222,15 +283,16 @@ m0_net_buffer_pool_get(struct m0_net_buffer_pool *pool, uint32_t colour)
 
 	if (pool->nbp_free <= 0)
 		return NULL;
-	if (colour != M0_BUFFER_ANY_COLOUR &&
-	    !m0_net_tm_tlist_is_empty(&pool->nbp_colours[colour]))
-		nb = m0_net_tm_tlist_head(&pool->nbp_colours[colour]);
-	else
+	if (colour != M0_BUFFER_ANY_COLOUR)
+		nb = m0_net_tm_tlist_head(&pool->nbp_colours[colour]) ?:
+		     node_buffer_get(pool, colour);
+	if (nb == NULL)
 		nb = m0_net_pool_tlist_head(&pool->nbp_lru);
 	M0_ASSERT(nb != NULL);
 	m0_net_pool_tlist_del(nb);
 	m0_net_tm_tlist_remove(nb);
 	M0_CNT_DEC(pool->nbp_free);
+	pool->nbp_free_min = min32u(pool->nbp_free_min, pool->nbp_free);
 	if (pool->nbp_free < pool->nbp_threshold)
 		pool->nbp_ops->nbpo_below_threshold(pool);
 	nb->nb_pool = pool;
@@ -267,10 +329,14 @@ M0_INTERNAL void m0_net_buffer_pool_put(struct m0_net_buffer_pool *pool,
 	M0_LEAVE();
 }
 
-static bool net_buffer_pool_grow(struct m0_net_buffer_pool *pool)
+static bool net_buffer_pool_grow(struct m0_net_buffer_pool *pool,
+				 uint32_t colour)
 {
 	int		      rc;
 	struct m0_net_buffer *nb;
+	uint32_t	      node = colour == M0_BUFFER_ANY_COLOUR ?
+				     M0_BUFFER_ANY_NODE :
+				     pool->nbp_colour_node[colour];
 
 	M0_PRE(m0_net_buffer_pool_invariant(pool));
 
@@ -290,6 +356,18 @@ static bool net_buffer_pool_grow(struct m0_net_buffer_pool *pool)
 		}
 	}
 
+#ifndef __KERNEL__
+	/* Segments of a buffer are allocated in one piece (packed). */
+	if (node != M0_BUFFER_ANY_NODE &&
+	    pool->nbp_align >= m0_pageshift_get()) {
+		rc = m0_memory_numa_bind(nb->nb_buffer.ov_buf[0],
+					 pool->nbp_seg_nr * pool->nbp_seg_size,
+					 node);
+		if (rc != 0)
+			M0_LOG(M0_WARN, "numa bind to node %u failed: %d",
+			       node, rc);
+	}
+#endif
 	rc = m0_net_buffer_register(nb, pool->nbp_ndom);
 	if (rc != 0)
 		goto clean;
@@ -297,7 +375,7 @@ static bool net_buffer_pool_grow(struct m0_net_buffer_pool *pool)
 	m0_net_tm_tlink_init(nb);
 
 	M0_CNT_INC(pool->nbp_buf_nr);
-	m0_net_buffer_pool_put(pool, nb, M0_BUFFER_ANY_COLOUR);
+	m0_net_buffer_pool_put(pool, nb, colour);
 	M0_POST(m0_net_buffer_pool_invariant(pool));
 	return true;
 clean:
@@ -322,6 +400,22 @@ M0_INTERNAL bool m0_net_buffer_pool_prune(struct m0_net_buffer_pool *pool)
 	return true;
 }
 
+M0_INTERNAL uint32_t m0_net_buffer_pool_trim(struct m0_net_buffer_pool *pool)
+{
+	uint32_t excess;
+	uint32_t nr;
+
+	M0_PRE(m0_net_buffer_pool_invariant(pool));
+
+	excess = pool->nbp_free_min > pool->nbp_threshold ?
+		 pool->nbp_free_min - pool->nbp_threshold : 0;
+	for (nr = 0; nr < excess && m0_net_buffer_pool_prune(pool); ++nr)
+		;
+	pool->nbp_free_min = pool->nbp_free;
+	M0_POST(m0_net_buffer_pool_invariant(pool));
+	return nr;
+}
+
 #undef M0_TRACE_SUBSYSTEM
 
 /** @} */ /* end of net_buffer_pool */
@@ -53,6 +53,17 @@
 	  (transfer machine), or if none such are found, the least recently
 	  used buffer from the pool, if any.
 
+	  A colour can be associated with a numa node, see
+	  m0_net_buffer_pool_colour_node_set(). Buffers provisioned with
+	  m0_net_buffer_pool_provision_colour() have their memory placed on
+	  the node of the colour, and a get of a colour with an empty list
+	  takes a buffer of another colour of the same node before falling
+	  back to the least recently used buffer.
+
+	  m0_net_buffer_pool_trim() prunes the buffers which were not needed
+	  since the previous call, so that a pool provisioned for a peak load
+	  shrinks back when the load goes away.
+
 	  Pool is protected by a lock, to get or put a buffer into the pool user
 	  must acquire the lock and release the lock once its usage is over.
 
@@ -139,6 +150,7 @@
 
 enum {
 	M0_BUFFER_ANY_COLOUR	     = ~0,
+	M0_BUFFER_ANY_NODE	     = ~0,
 	M0_NET_BUFFER_POOL_THRESHOLD = 2,
 };
 
@@ -241,6 +253,36 @@ M0_INTERNAL void m0_net_buffer_pool_put(struct m0_net_buffer_pool *pool,
  */
 M0_INTERNAL bool m0_net_buffer_pool_prune(struct m0_net_buffer_pool *pool);
 
+/**
+   Associates the colour with a numa node, M0_BUFFER_ANY_NODE to drop the
+   association.
+   @pre m0_net_buffer_pool_is_locked(pool)
+   @pre colour < pool->nbp_colours_nr
+ */
+M0_INTERNAL void m0_net_buffer_pool_colour_node_set(struct m0_net_buffer_pool
+						    *pool, uint32_t colour,
+						    uint32_t node);
+
+/**
+   Adds buf_nr buffers to the list of the colour, with memory placed on the
+   numa node of the colour. Memory is placed only if the pool alignment is
+   at least a page.
+   @pre m0_net_buffer_pool_is_locked(pool)
+   @pre colour < pool->nbp_colours_nr
+   @return result number of buffers it managed to allocate.
+ */
+M0_INTERNAL int m0_net_buffer_pool_provision_colour(struct m0_net_buffer_pool
+						    *pool, uint32_t buf_nr,
+						    uint32_t colour);
+
+/**
+   Prunes the buffers which stayed free since the previous call, keeping at
+   least nbp_threshold free buffers. Returns the number of pruned buffers.
+   To be called periodically.
+   @pre m0_net_buffer_pool_is_locked(pool)
+ */
+M0_INTERNAL uint32_t m0_net_buffer_pool_trim(struct m0_net_buffer_pool *pool);
+
 /** Buffer pool. */
 struct m0_net_buffer_pool {
 	/** Number of free buffers in the pool. */
@@ -271,6 +313,13 @@ struct m0_net_buffer_pool {
 	    lists.
 	*/
 	struct m0_tl			    *nbp_colours;
+	/**
+	   An array of nbp_colours_nr numa node ids of the colours,
+	   M0_BUFFER_ANY_NODE for a colour without a node.
+	 */
+	uint32_t			    *nbp_colour_node;
+	/** Min of nbp_free since the last m0_net_buffer_pool_trim(). */
+	uint32_t			     nbp_free_min;
 	/** Alignment for network buffers */
 	unsigned			     nbp_align;
 	/** Memory in this pool is excluded in core dump or not */
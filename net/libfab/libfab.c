@@ -169,12 +169,46 @@
  * 5) fi_rma: Used for remote memory access operations.
  *    Reference: https://ofiwg.github.io/libfabric/v1.1.1/man/fi_rma.3.html
  *
+ * Bulk completion notification:
+ * -----------------------------
+ *
+ * The passive side completes a bulk buffer when the immediate data carrying
+ * its token arrives in the receive completion queue. An active bulk send puts
+ * it on the last RDMA write, an active bulk receive posts a zero length write
+ * with the immediate data after the RDMA read (libfab_remote_complete()).
+ * Passive bulk send buffers not longer than m0_net_libfab_inline_set() carry
+ * their data in the buffer descriptor, so the active side receives them with
+ * the notification only.
+ *
+ * Local transfers:
+ * ----------------
+ *
+ * The connected FI_EP_MSG endpoints of a transfer machine belong to the
+ * network provider (providers[]), so transfers between processes on the same
+ * node go through tcp or verbs loopback. The shm provider supports only
+ * reliable datagram endpoints (FI_EP_RDM), hence when it is enabled with
+ * m0_net_libfab_shm_set() each transfer machine opens a second fabric and
+ * domain of shm with an RDM endpoint, an address vector and a completion
+ * queue polled by the poller (libfab_shm_init()). Buffers are registered in
+ * both domains. The descriptor of a passive buffer carries the name of the
+ * shm endpoint and the shm registrations next to the network ones. The active
+ * side reads or writes the buffer and posts the notification through shm if
+ * the descriptor comes from the same host (libfab_shm_peer()), and through
+ * the network endpoint otherwise. Messages and connection management always
+ * use the network provider.
+ *
+ * A passive buffer that posts a dummy receive to be consumed by the
+ * notification (a transfer machine without message receive buffers) is not
+ * offered through shm, because a notification through shm consumes no
+ * receive.
+ *
  * @{
  */
 
 
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_NET
 #include "lib/trace.h"          /* M0_ENTRY() */
+#include "net/libfab/libfab.h"  /* m0_net_libfab_mr_invalidate */
 
 #ifdef ENABLE_LIBFAB
 
@@ -191,6 +225,9 @@
 #include "lib/hash.h"           /* m0_htable */
 #include "lib/memory.h"         /* M0_ALLOC_PTR()*/
 #include "lib/processor.h"      /* m0_processor_is_vm()*/
+#include "lib/bitmap.h"         /* m0_bitmap */
+#include "addb2/addb2.h"        /* M0_ADDB2_ADD */
+#include "net/addb2.h"          /* M0_AVI_NET_MR_CACHE */
 #include "libfab_internal.h"
 #include "lib/string.h"         /* m0_streq */
 #include "net/net_internal.h"   /* m0_net__buffer_invariant() */
@@ -254,6 +291,62 @@ M0_HT_DESCR_DEFINE(fab_bufhash, "Hash of bufs", static, struct m0_fab__buf,
 
 M0_HT_DEFINE(fab_bufhash, static, struct m0_fab__buf, uint32_t);
 
+static uint64_t libfab_mr_hash_func(const struct m0_htable *ht,
+				    const void *key)
+{
+	const struct m0_fab__mr_key *k = key;
+
+	return m0_hash((uint64_t)k->mk_addr ^ k->mk_len ^
+		       ((uint64_t)k->mk_dom << 1)) % ht->h_bucket_nr;
+}
+
+static bool libfab_mr_key_eq(const void *key1, const void *key2)
+{
+	const struct m0_fab__mr_key *k1 = key1;
+	const struct m0_fab__mr_key *k2 = key2;
+
+	return k1->mk_addr == k2->mk_addr && k1->mk_len == k2->mk_len &&
+	       k1->mk_dom == k2->mk_dom;
+}
+
+M0_HT_DESCR_DEFINE(fab_mrhash, "Hash of mrs", static, struct m0_fab__mr_ent,
+		   me_htlink, me_htmagic, M0_NET_LIBFAB_MR_HT_MAGIC,
+		   M0_NET_LIBFAB_MR_HT_HEAD_MAGIC,
+		   me_key, libfab_mr_hash_func, libfab_mr_key_eq);
+
+M0_HT_DEFINE(fab_mrhash, static, struct m0_fab__mr_ent, struct m0_fab__mr_key);
+
+static uint64_t libfab_ep_hash_func(const struct m0_htable *ht,
+				    const void *key)
+{
+	const struct m0_net_ip_params *n = &((const struct m0_net_ip_addr *)
+					     key)->nia_n;
+
+	/*
+	 * Only the fields compared by m0_net_ip_addr_eq() for every format
+	 * are hashed: the first word of the address, the port and the format.
+	 */
+	return m0_hash(((uint64_t)n->nip_ip_n.sn[0] << 16 | n->nip_port) ^
+		       ((uint64_t)n->nip_format << 48)) % ht->h_bucket_nr;
+}
+
+static bool libfab_ep_key_eq(const void *key1, const void *key2)
+{
+	return m0_net_ip_addr_eq(key1, key2, true);
+}
+
+M0_HT_DESCR_DEFINE(fab_ephash, "Hash of endpoints", static, struct m0_fab__ep,
+		   fep_htlink, fep_htmagic, M0_NET_LIBFAB_EP_HT_MAGIC,
+		   M0_NET_LIBFAB_EP_HT_HEAD_MAGIC,
+		   fep_name, libfab_ep_hash_func, libfab_ep_key_eq);
+
+M0_HT_DEFINE(fab_ephash, static, struct m0_fab__ep, struct m0_net_ip_addr);
+
+M0_TL_DESCR_DEFINE(fab_mrlru, "libfab_mr_lru",
+		   static, struct m0_fab__mr_ent, me_lru, me_lrumagic,
+		   M0_NET_LIBFAB_MR_LRU_MAGIC, M0_NET_LIBFAB_MR_LRU_HEAD_MAGIC);
+M0_TL_DEFINE(fab_mrlru, static, struct m0_fab__mr_ent);
+
 static int libfab_ep_txres_init(struct m0_fab__active_ep *aep,
 				struct m0_fab__tm *tm, void *ctx);
 static int libfab_ep_rxres_init(struct m0_fab__active_ep *aep,
@@ -283,6 +376,7 @@ static int libfab_ep_txres_free(struct m0_fab__tx_res *tx_res,
 static int libfab_ep_rxres_free(struct m0_fab__rx_res *rx_res,
 				struct m0_fab__tm *tm);
 static void libfab_poller(struct m0_fab__tm *ma);
+static int libfab_poller_wait(struct m0_fab__tm *tm, struct epoll_event *ev);
 static int libfab_waitfd_init(struct m0_fab__tm *tm);
 static void libfab_tm_event_post(struct m0_fab__tm *tm,
 				 enum m0_net_tm_state state);
@@ -308,6 +402,9 @@ static int libfab_buf_dom_reg(struct m0_net_buffer *nb, struct m0_fab__tm *tm);
 static int libfab_buf_dom_dereg(struct m0_fab__buf *fbp);
 static void libfab_pending_bufs_send(struct m0_fab__ep *ep);
 static int libfab_target_notify(struct m0_fab__buf *buf);
+static int libfab_remote_complete(struct m0_fab__active_ep *aep,
+				  struct m0_fab__buf *buf, uint32_t token);
+static void libfab_recv_repost(struct m0_fab__buf *fbp);
 static int libfab_conn_init(struct m0_fab__ep *ep, struct m0_fab__tm *ma,
 			    struct m0_fab__buf *fbp);
 static int libfab_conn_accept(struct m0_fab__ep *ep, struct m0_fab__tm *tm,
@@ -335,6 +432,62 @@ static void libfab_bufq_process(struct m0_fab__tm *tm);
 static uint32_t libfab_buf_token_get(struct m0_fab__tm *tm,
 				     struct m0_fab__buf *fb);
 static bool libfab_buf_invariant(const struct m0_fab__buf *buf);
+static struct m0_fab__fab *libfab_newfab_init(struct m0_fab__ndom *fnd);
+static int libfab_shm_init(struct m0_fab__tm *tm, struct m0_fab__ndom *fnd);
+static void libfab_shm_fini(struct m0_fab__tm *tm);
+static int libfab_shm_comp_read(struct m0_fab__tm *tm);
+static bool libfab_shm_peer(struct m0_fab__tm *tm, struct m0_fab__buf *fb,
+			    struct m0_fab__ep *ep);
+static void libfab_buf_mr_free(struct m0_fab__buf_mr *mr);
+
+/**
+ * How long the poller keeps polling completion queues without blocking after
+ * the last completion, 0 to always block. See m0_net_libfab_busy_poll_set().
+ */
+static m0_time_t libfab_busy_poll = 0;
+
+M0_INTERNAL void m0_net_libfab_busy_poll_set(m0_time_t interval)
+{
+	libfab_busy_poll = interval;
+}
+
+/**
+ * Max number of unused memory registrations kept by a domain, 0 to close a
+ * registration as soon as it is unused. See m0_net_libfab_mr_cache_set().
+ */
+static uint32_t libfab_mr_cache_max = 0;
+
+M0_INTERNAL void m0_net_libfab_mr_cache_set(uint32_t nr)
+{
+	libfab_mr_cache_max = nr;
+}
+
+/**
+ * Max length of passive bulk send buffers which are copied into the buffer
+ * descriptor for a domain. See m0_net_libfab_inline_set().
+ */
+static uint32_t libfab_inline_max = 0;
+
+M0_INTERNAL void m0_net_libfab_inline_set(uint32_t len)
+{
+	libfab_inline_max = len;
+}
+
+/**
+ * Whether transfer machines of a domain use shm for bulk transfers with peers
+ * on the same host. See m0_net_libfab_shm_set().
+ */
+static bool libfab_shm = false;
+
+M0_INTERNAL void m0_net_libfab_shm_set(bool on)
+{
+	libfab_shm = on;
+}
+
+static inline bool libfab_shm_is_on(const struct m0_fab__tm *tm)
+{
+	return tm->ftm_shm.fsh_ep != NULL;
+}
 
 /* libfab init and fini() : initialized in motr init */
 M0_INTERNAL int m0_net_libfab_init(void)
@@ -664,16 +817,18 @@ static void libfab_txep_event_check(struct m0_fab__ep *txep,
 
 /**
  * Check for completion events on the completion queue for the receive endpoint
+ *
+ * Returns the number of completions read.
  */
-static void libfab_rxep_comp_read(struct fid_cq *cq, struct m0_fab__ep *ep,
-				  struct m0_fab__tm *tm)
+static int libfab_rxep_comp_read(struct fid_cq *cq, struct m0_fab__ep *ep,
+				 struct m0_fab__tm *tm)
 {
 	struct m0_fab__buf  *fb = NULL;
 	uint32_t             token[FAB_MAX_COMP_READ];
 	m0_bindex_t          len[FAB_MAX_COMP_READ];
 	uint64_t             data[FAB_MAX_COMP_READ];
 	int                  i;
-	int                  cnt;
+	int                  cnt = 0;
 	uint32_t             rem_token;
 
 	if (cq != NULL) {
@@ -682,7 +837,14 @@ static void libfab_rxep_comp_read(struct fid_cq *cq, struct m0_fab__ep *ep,
 			fb = fab_bufhash_htable_lookup(
 				&tm->ftm_bufhash.bht_hash,
 				&token[i]);
-			if (fb != NULL) {
+			if (fb != NULL && data[i] != 0 && fb->fb_nb != NULL &&
+			    fb->fb_nb->nb_qtype == M0_NET_QT_MSG_RECV) {
+				/*
+				 * The receive was consumed by a remote write
+				 * with immediate data and holds no message.
+				 */
+				libfab_recv_repost(fb);
+			} else if (fb != NULL) {
 				if (fb->fb_length == 0)
 					fb->fb_length = len[i];
 				fb->fb_ev_ep = ep;
@@ -698,56 +860,166 @@ static void libfab_rxep_comp_read(struct fid_cq *cq, struct m0_fab__ep *ep,
 			}
 		}
 	}
+	return max32(cnt, 0);
 }
 
 /**
- * Check for completion events on the completion queue for the transmit endpoint
+ * Handles the completion of an operation posted by the tm with the given
+ * token as the context.
  */
-static void libfab_txep_comp_read(struct fid_cq *cq, struct m0_fab__tm *tm)
+static void libfab_txep_comp(struct m0_fab__tm *tm, uint32_t token)
 {
 	struct m0_fab__active_ep *aep;
 	struct m0_fab__buf       *fb = NULL;
-	uint32_t                  token[FAB_MAX_COMP_READ];
-	int                       i;
-	int                       cnt;
+
+	if (token != 0)
+		fb = fab_bufhash_htable_lookup(&tm->ftm_bufhash.bht_hash,
+					       &token);
+	if (fb != NULL) {
+		aep = libfab_aep_get(fb->fb_txctx);
+		if ((fb->fb_token & M0_NET_QT_NR) == M0_NET_QT_NR) {
+			fab_bufhash_htable_del(&tm->ftm_bufhash.bht_hash, fb);
+			M0_ASSERT(aep->aep_bulk_cnt);
+			--aep->aep_bulk_cnt;
+			aep->aep_txq_full = false;
+			m0_free(fb);
+		} else {
+			if (M0_IN(fb->fb_nb->nb_qtype,
+				(M0_NET_QT_MSG_SEND,
+				 M0_NET_QT_ACTIVE_BULK_RECV,
+				 M0_NET_QT_ACTIVE_BULK_SEND))) {
+				M0_ASSERT(aep->aep_bulk_cnt >= fb->fb_wr_cnt);
+				aep->aep_bulk_cnt -= fb->fb_wr_cnt;
+				aep->aep_txq_full = false;
+			}
+			libfab_target_notify(fb);
+			libfab_buf_done(fb, 0, false);
+		}
+	}
+}
+
+/**
+ * Check for completion events on the completion queue for the transmit endpoint
+ *
+ * Returns the number of completions read.
+ */
+static int libfab_txep_comp_read(struct fid_cq *cq, struct m0_fab__tm *tm)
+{
+	uint32_t token[FAB_MAX_COMP_READ];
+	int      i;
+	int      cnt;
 
 	cnt = libfab_check_for_comp(cq, token, NULL, NULL);
+	for (i = 0; i < cnt; i++)
+		libfab_txep_comp(tm, token[i]);
+	return max32(cnt, 0);
+}
+
+/**
+ * Check for completion events on the completion queue of the shm endpoint.
+ *
+ * The queue has the completions of the operations posted by the tm, handled
+ * as the ones of the transmit queue, and the remote writes with immediate
+ * data which complete the passive buffers of the tm.
+ *
+ * Returns the number of completions read.
+ */
+static int libfab_shm_comp_read(struct m0_fab__tm *tm)
+{
+	struct m0_fab__buf *fb;
+	uint32_t            token[FAB_MAX_COMP_READ];
+	uint64_t            data[FAB_MAX_COMP_READ];
+	uint32_t            rem_token;
+	int                 i;
+	int                 cnt;
+
+	cnt = libfab_check_for_comp(tm->ftm_shm.fsh_cq, token, NULL, data);
 	for (i = 0; i < cnt; i++) {
-		if (token[i] != 0)
+		if (data[i] != 0) {
+			rem_token = (uint32_t)data[i];
 			fb = fab_bufhash_htable_lookup(
 				&tm->ftm_bufhash.bht_hash,
-				&token[i]);
-		else
-			fb = NULL;
-		if (fb != NULL) {
-			aep = libfab_aep_get(fb->fb_txctx);
-			if ((fb->fb_token & M0_NET_QT_NR) == M0_NET_QT_NR) {
-				fab_bufhash_htable_del(
-						 &tm->ftm_bufhash.bht_hash, fb);
-				M0_ASSERT(aep->aep_bulk_cnt);
-				--aep->aep_bulk_cnt;
-				aep->aep_txq_full = false;
-				m0_free(fb);
-			} else {
-				if (M0_IN(fb->fb_nb->nb_qtype,
-					(M0_NET_QT_MSG_SEND,
-					 M0_NET_QT_ACTIVE_BULK_RECV,
-					 M0_NET_QT_ACTIVE_BULK_SEND))) {
-					M0_ASSERT(aep->aep_bulk_cnt >=
-								 fb->fb_wr_cnt);
-					aep->aep_bulk_cnt -= fb->fb_wr_cnt;
-					aep->aep_txq_full = false;
-				}
-				libfab_target_notify(fb);
+				&rem_token);
+			if (fb != NULL)
 				libfab_buf_done(fb, 0, false);
-			}
-		}
+		} else
+			libfab_txep_comp(tm, token[i]);
 	}
+	return max32(cnt, 0);
+}
+
+/**
+ * Waits for events on the wait fds of the transfer machine.
+ *
+ * Returns the number of events returned in "ev" (0 or 1).
+ */
+static int libfab_poller_wait(struct m0_fab__tm *tm, struct epoll_event *ev)
+{
+	struct fid *shm_cq;
+	int         ev_cnt;
+	int         ret;
+	int         err;
+
+	do {
+		do {
+			m0_mutex_lock(&tm->ftm_fids.ftf_lock);
+			ret = fi_trywait(tm->ftm_fab->fab_fab,
+					 tm->ftm_fids.ftf_head,
+					 tm->ftm_fids.ftf_cnt);
+			m0_mutex_unlock(&tm->ftm_fids.ftf_lock);
+		} while (M0_FI_ENABLED("fail-trywait"));
+		/*
+		 * The shm queue belongs to another fabric and is not in
+		 * ftm_fids, its wait fd is in the epoll set nevertheless.
+		 */
+		if (ret == 0 && libfab_shm_is_on(tm)) {
+			shm_cq = &tm->ftm_shm.fsh_cq->fid;
+			if (fi_trywait(tm->ftm_shm.fsh_fab->fab_fab,
+				       &shm_cq, 1) == -FI_EAGAIN)
+				ret = -FI_EAGAIN;
+		}
+		/*
+		 * TBD : Add handling of other return values of
+		 * fi_trywait() if it returns something other than
+		 * -EAGAIN and 0. Also, observed that fi_trywait()
+		 * returns -22(EINVAL) which is not mentioned in
+		 * libfabric documentation, hence added it to the list
+		 * of possible return values of fi_trywait().
+		 */
+		if (!M0_IN(ret, (0, -EAGAIN, -EINVAL)))
+			M0_LOG(M0_ERROR, "Unexpected fi_trywait rc=%d", ret);
+
+		if (ret == 0) {
+			ret = epoll_wait(tm->ftm_epfd, ev, 1,
+					 FAB_WAIT_FD_TMOUT);
+			/*
+			 * M0_ERR is omitted because we expect only one
+			 * particular error, and this error gets
+			 * handled by the loop.
+			 */
+			err = ret < 0 ? -errno : 0;
+			if (!M0_IN(ret, (-1, 0, 1)))
+				M0_LOG(M0_ERROR, "Unexpected epoll_wait rc=%d",
+				       ret);
+			if (ret == -1 && err != -EINTR)
+				M0_LOG(M0_ERROR, "Unexpected epoll_wait err=%d",
+				       err);
+			ev_cnt = ret > 0 ? ret : 0;
+		} else {
+			ev_cnt = 0;
+			err = 0;
+		}
+	} while (err == -EINTR);
+	return ev_cnt;
 }
 
 /**
  * Used to poll for connection events, completion events and process the queued
  * bulk buffer operations.
+ *
+ * If busy polling is enabled (m0_net_libfab_busy_poll_set()), the poller does
+ * not block on the wait fds for libfab_busy_poll after the last completion,
+ * so that a completion following shortly is picked up without a wakeup.
  */
 static void libfab_poller(struct m0_fab__tm *tm)
 {
@@ -757,55 +1029,23 @@ static void libfab_poller(struct m0_fab__tm *tm)
 	struct m0_fab__active_ep *aep;
 	struct fid_cq            *cq;
 	struct epoll_event        ev;
+	m0_time_t                 busy_until = 0;
 	int                       ev_cnt;
+	int                       comp_cnt;
 	int                       ret;
-	int                       err;
 
+	if (tm->ftm_processors.b_nr != 0) {
+		ret = m0_thread_confine(&tm->ftm_poller, &tm->ftm_processors);
+		if (ret != 0)
+			M0_LOG(M0_ERROR, "Cannot confine the poller rc=%d",
+			       ret);
+	}
 	libfab_tm_event_post(tm, M0_NET_TM_STARTED);
 	while (tm->ftm_state != FAB_TM_SHUTDOWN) {
-		do {
-			do {
-				m0_mutex_lock(&tm->ftm_fids.ftf_lock);
-				ret = fi_trywait(tm->ftm_fab->fab_fab,
-						 tm->ftm_fids.ftf_head,
-						 tm->ftm_fids.ftf_cnt);
-				m0_mutex_unlock(&tm->ftm_fids.ftf_lock);
-			} while (M0_FI_ENABLED("fail-trywait"));
-			/*
-			 * TBD : Add handling of other return values of
-			 * fi_trywait() if it returns something other than
-			 * -EAGAIN and 0. Also, observed that fi_trywait()
-			 * returns -22(EINVAL) which is not mentioned in
-			 * libfabric documentation, hence added it to the list
-			 * of possible return values of fi_trywait().
-			 */
-			if (!M0_IN(ret, (0, -EAGAIN, -EINVAL)))
-				M0_LOG(M0_ERROR, "Unexpected fi_trywait rc=%d",
-				       ret);
-
-			if (ret == 0) {
-				ret = epoll_wait(tm->ftm_epfd, &ev, 1,
-						 FAB_WAIT_FD_TMOUT);
-				/*
-				 * M0_ERR is omitted because we expect only one
-				 * particular error, and this error gets
-				 * handled by the loop.
-				 */
-				err = ret < 0 ? -errno : 0;
-				if (!M0_IN(ret, (-1, 0, 1)))
-					M0_LOG(M0_ERROR,
-					       "Unexpected epoll_wait rc=%d",
-					       ret);
-				if (ret == -1 && err != -EINTR)
-					M0_LOG(M0_ERROR,
-					       "Unexpected epoll_wait err=%d",
-					       err);
-				ev_cnt = ret > 0 ? ret : 0;
-			} else {
-				ev_cnt = 0;
-				err = 0;
-			}
-		} while (err == -EINTR);
+		if (m0_time_now() < busy_until)
+			ev_cnt = 0;
+		else
+			ev_cnt = libfab_poller_wait(tm, &ev);
 
 		while (1) {
 			m0_mutex_lock(&tm->ftm_endlock);
@@ -829,7 +1069,9 @@ static void libfab_poller(struct m0_fab__tm *tm)
 
 		/* Check the common queue of the transfer machine for events */
 		libfab_handle_connect_request_events(tm);
-		libfab_txep_comp_read(tm->ftm_tx_cq, tm);
+		comp_cnt = libfab_txep_comp_read(tm->ftm_tx_cq, tm);
+		if (libfab_shm_is_on(tm))
+			comp_cnt += libfab_shm_comp_read(tm);
 
 		if (ev_cnt > 0) {
 			ctx = ev.data.ptr;
@@ -842,7 +1084,7 @@ static void libfab_poller(struct m0_fab__tm *tm)
 				aep = libfab_aep_get(xep);
 				libfab_txep_event_check(xep, aep, tm);
 				cq = aep->aep_rx_res.frr_cq;
-				libfab_rxep_comp_read(cq, xep, tm);
+				comp_cnt += libfab_rxep_comp_read(cq, xep, tm);
 			}
 		}
 
@@ -862,7 +1104,7 @@ static void libfab_poller(struct m0_fab__tm *tm)
 		aep = libfab_aep_get(xep);
 		libfab_txep_event_check(xep, aep, tm);
 		cq = aep->aep_rx_res.frr_cq;
-		libfab_rxep_comp_read(cq, xep, tm);
+		comp_cnt += libfab_rxep_comp_read(cq, xep, tm);
 		/* Release, with TM lock already held. */
 		m0_ref_put(&net->nep_ref);
 
@@ -873,6 +1115,9 @@ static void libfab_poller(struct m0_fab__tm *tm)
 
 		M0_ASSERT(libfab_tm_invariant(tm));
 		libfab_tm_unlock(tm);
+		if (comp_cnt > 0 && libfab_busy_poll != 0)
+			busy_until = m0_time_add(m0_time_now(),
+						 libfab_busy_poll);
 	}
 }
 
@@ -885,26 +1130,42 @@ static inline struct m0_fab__ep *libfab_ep(struct m0_net_end_point *net)
 }
 
 /**
- * Find endpoint in list of endpoints using numeric params.
+ * Adds the endpoint to the list and the hash of endpoints of the tm.
+ */
+static void libfab_ep_link(struct m0_fab__ep *ep, struct m0_fab__tm *tm)
+{
+	m0_nep_tlink_init_at_tail(&ep->fep_nep, &tm->ftm_ntm->ntm_end_points);
+	m0_tlink_init(&fab_ephash_tl, ep);
+	fab_ephash_htable_add(&tm->ftm_ephash, ep);
+}
+
+/**
+ * Removes the endpoint from the hash of endpoints of the tm.
+ */
+static void libfab_ep_unhash(struct m0_fab__ep *ep, struct m0_fab__tm *tm)
+{
+	fab_ephash_htable_del(&tm->ftm_ephash, ep);
+	m0_tlink_fini(&fab_ephash_tl, ep);
+}
+
+/**
+ * Find endpoint in the hash of endpoints using numeric params.
  * If found update output param ep and return true, or else returns false.
  */
 static bool libfab_ep_find_by_num(struct m0_net_ip_addr *addr,
 				  struct m0_net_transfer_mc *ntm,
 				  struct m0_fab__ep **ep)
 {
-	struct m0_net_end_point *net;
-
-	net = m0_tl_find(m0_nep, net, &ntm->ntm_end_points,
-			 m0_net_ip_addr_eq(&(libfab_ep(net))->fep_name,
-					   addr, true));
-
-	*ep = net != NULL ? libfab_ep(net) : NULL;
+	struct m0_fab__tm *tm = ntm->ntm_xprt_private;
 
-	return net != NULL;
+	*ep = fab_ephash_htable_lookup(&tm->ftm_ephash, addr);
+	return *ep != NULL;
 }
 
 /**
- * Find endpoint in list of endpoints using name string.
+ * Find endpoint using name string.
+ * The name is parsed and looked up in the hash, the list of endpoints is
+ * searched only for names which cannot be parsed.
  * If found update output param ep and return true, or else returns false.
  */
 static bool libfab_ep_find_by_str(const char *name,
@@ -914,15 +1175,15 @@ static bool libfab_ep_find_by_str(const char *name,
 	struct m0_net_end_point *net;
 	struct m0_net_ip_addr    addr;
 
+	if (m0_net_ip_parse(name, &addr) == 0 &&
+	    libfab_ep_find_by_num(&addr, ntm, ep))
+		return true;
+
 	net = m0_tl_find(m0_nep, net, &ntm->ntm_end_points,
 			 strcmp((libfab_ep(net))->fep_name.nia_p, name) == 0);
 
 	*ep = net != NULL ? libfab_ep(net) : NULL;
 
-	if (net == NULL && m0_net_ip_parse(name, &addr) == 0) {
-		return libfab_ep_find_by_num(&addr, ntm, ep);
-	}
-
 	return net != NULL;
 }
 
@@ -975,6 +1236,9 @@ static int libfab_ep_find(struct m0_net_transfer_mc *tm, const char *name,
 			if (wc != NULL &&
 			    ep->fep_name.nia_n.nip_port !=
 			    net_ip.nia_n.nip_port) {
+				ma = tm->ntm_xprt_private;
+				/* The key changes, re-hash. */
+				fab_ephash_htable_del(&ma->ftm_ephash, ep);
 				ep->fep_name.nia_n.nip_ip_n.sn[0] =
 					net_ip.nia_n.nip_ip_n.sn[0];
 				ep->fep_name.nia_n.nip_port =
@@ -983,8 +1247,8 @@ static int libfab_ep_find(struct m0_net_transfer_mc *tm, const char *name,
 					net_ip.nia_n.nip_fmt_pvt.la.nla_tmid;
 				libfab_ep_pton(&ep->fep_name,
 					       &ep->fep_name_n);
+				fab_ephash_htable_add(&ma->ftm_ephash, ep);
 				aep = libfab_aep_get(ep);
-				ma = tm->ntm_xprt_private;
 				if (aep->aep_tx_state == FAB_CONNECTED)
 					rc = libfab_txep_init(aep, ma, ep);
 			}
@@ -1088,6 +1352,131 @@ static int libfab_tm_res_init(struct m0_fab__tm *tm)
 	return M0_RC(libfab_txep_init(pep->pep_aep, tm, tm->ftm_pep));
 }
 
+/**
+ * Opens the shm resources of a started transfer machine, see m0_fab__shm.
+ *
+ * The fabric and the domain are added to the fabrics of the network domain
+ * and closed in libfab_dom_fini() together with the cached registrations in
+ * them. On failure the tm does not use shm.
+ */
+static int libfab_shm_init(struct m0_fab__tm *tm, struct m0_fab__ndom *fnd)
+{
+	struct m0_fab__shm *shm = &tm->ftm_shm;
+	struct m0_fab__fab *fab;
+	struct fi_info     *hints;
+	struct fi_info     *fi;
+	struct fi_av_attr   av_attr = {};
+	struct fi_cq_attr   cq_attr = {};
+	struct epoll_event  ev = {};
+	size_t              len = sizeof(shm->fsh_name);
+	int                 fd;
+	int                 rc;
+
+	M0_PRE(!libfab_shm_is_on(tm));
+
+	hints = fi_allocinfo();
+	if (hints == NULL)
+		return M0_ERR(-ENOMEM);
+	hints->ep_attr->type = FI_EP_RDM;
+	hints->caps = FI_RMA | FI_READ | FI_WRITE | FI_REMOTE_READ |
+		      FI_REMOTE_WRITE;
+	hints->addr_format = FI_ADDR_STR;
+	hints->domain_attr->mr_mode = FI_MR_LOCAL | FI_MR_ALLOCATED |
+				      FI_MR_PROV_KEY | FI_MR_VIRT_ADDR;
+	hints->domain_attr->cq_data_size = 4;
+	hints->fabric_attr->prov_name = (char *)"shm";
+	rc = fi_getinfo(LIBFAB_VERSION, NULL, NULL, 0, hints, &fi);
+	hints->fabric_attr->prov_name = NULL;
+	fi_freeinfo(hints);
+	if (rc != 0)
+		return M0_ERR(rc);
+
+	fab = libfab_newfab_init(fnd);
+	if (fab == NULL) {
+		fi_freeinfo(fi);
+		return M0_ERR(-ENOMEM);
+	}
+	fab->fab_fi = fi;
+	fab->fab_prov = FAB_FABRIC_PROV_MAX;
+	fab->fab_max_iov = min32u(fi->tx_attr->iov_limit,
+				  fi->tx_attr->rma_iov_limit);
+	shm->fsh_fab = fab;
+	/* Bulk operations use the iov arrays of the tm. */
+	shm->fsh_max_iov = min32u(fab->fab_max_iov, tm->ftm_fab->fab_max_iov);
+	shm->fsh_virt_addr = (fi->domain_attr->mr_mode & FI_MR_VIRT_ADDR) != 0;
+
+	av_attr.type = FI_AV_UNSPEC;
+	av_attr.count = FAB_SHM_AV_SIZE;
+	cq_attr.wait_obj = FI_WAIT_FD;
+	cq_attr.wait_cond = FI_CQ_COND_NONE;
+	cq_attr.format = FI_CQ_FORMAT_DATA;
+	cq_attr.size = FAB_MAX_SHM_CQ_EV;
+	rc = fi_fabric(fi->fabric_attr, &fab->fab_fab, NULL) ? :
+	     fi_domain(fab->fab_fab, fi, &fab->fab_dom, NULL) ? :
+	     fi_av_open(fab->fab_dom, &av_attr, &shm->fsh_av, NULL) ? :
+	     fi_cq_open(fab->fab_dom, &cq_attr, &shm->fsh_cq, NULL) ? :
+	     fi_endpoint(fab->fab_dom, fi, &shm->fsh_ep, NULL) ? :
+	     fi_ep_bind(shm->fsh_ep, &shm->fsh_av->fid, 0) ? :
+	     fi_ep_bind(shm->fsh_ep, &shm->fsh_cq->fid,
+			FI_TRANSMIT | FI_RECV) ? :
+	     fi_enable(shm->fsh_ep) ? :
+	     fi_getname(&shm->fsh_ep->fid, shm->fsh_name, &len) ? :
+	     fi_control(&shm->fsh_cq->fid, FI_GETWAIT, &fd);
+	if (rc == 0 && (len > sizeof(shm->fsh_name) || len == 0 ||
+			shm->fsh_name[len - 1] != 0))
+		rc = -EINVAL;
+	if (rc == 0) {
+		shm->fsh_cq_ctx.evctx_type = FAB_COMMON_Q_EVENT;
+		shm->fsh_cq_ctx.evctx_ep = NULL;
+		shm->fsh_cq_ctx.evctx_dbg = "shm cq";
+		ev.events = EPOLLIN;
+		ev.data.ptr = &shm->fsh_cq_ctx;
+		if (epoll_ctl(tm->ftm_epfd, EPOLL_CTL_ADD, fd, &ev) != 0)
+			rc = -errno;
+	}
+	if (rc != 0) {
+		libfab_shm_fini(tm);
+		return M0_ERR(rc);
+	}
+	M0_LOG(M0_DEBUG, "tm=%s shm=%s", (char *)tm->ftm_pep->fep_name.nia_p,
+	       (char *)shm->fsh_name);
+	return M0_RC(0);
+}
+
+/**
+ * Closes the shm resources of a transfer machine opened by libfab_shm_init().
+ */
+static void libfab_shm_fini(struct m0_fab__tm *tm)
+{
+	struct m0_fab__shm *shm = &tm->ftm_shm;
+	struct epoll_event  ev = {};
+	int                 fd;
+	int                 rc;
+
+	if (shm->fsh_ep != NULL) {
+		rc = fi_close(&shm->fsh_ep->fid);
+		if (rc != 0)
+			M0_LOG(M0_ERROR, "shm ep fi_close ret=%d", rc);
+		shm->fsh_ep = NULL;
+	}
+	if (shm->fsh_cq != NULL) {
+		/* The fd may be not in the epoll set after a failed init. */
+		if (fi_control(&shm->fsh_cq->fid, FI_GETWAIT, &fd) == 0)
+			epoll_ctl(tm->ftm_epfd, EPOLL_CTL_DEL, fd, &ev);
+		rc = fi_close(&shm->fsh_cq->fid);
+		if (rc != 0)
+			M0_LOG(M0_ERROR, "shm cq fi_close ret=%d", rc);
+		shm->fsh_cq = NULL;
+	}
+	if (shm->fsh_av != NULL) {
+		rc = fi_close(&shm->fsh_av->fid);
+		if (rc != 0)
+			M0_LOG(M0_ERROR, "shm av fi_close ret=%d", rc);
+		shm->fsh_av = NULL;
+	}
+	shm->fsh_fab = NULL;
+}
+
 /**
  * Initialize transmit endpoint resources and associate
  * it to the active transmit endpoint.
@@ -1269,7 +1658,7 @@ static int libfab_active_ep_create(struct m0_fab__ep *ep, struct m0_fab__tm *tm)
 	net->nep_xprt_pvt = ep;
 	net->nep_tm = tm->ftm_ntm;
 	libfab_ep_pton(&ep->fep_name, &ep->fep_name_n);
-	m0_nep_tlink_init_at_tail(net, &tm->ftm_ntm->ntm_end_points);
+	libfab_ep_link(ep, tm);
 	net->nep_addr = (const char *)(&ep->fep_name.nia_p);
 	m0_ref_init(&ep->fep_nep.nep_ref, 1, &libfab_ep_release);
 
@@ -1591,6 +1980,7 @@ static int libfab_tm_param_free(struct m0_fab__tm *tm)
 	M0_ASSERT(libfab_tm_is_locked(tm));
 	m0_tl_teardown(m0_nep, &tm->ftm_ntm->ntm_end_points, net) {
 		xep = libfab_ep(net);
+		libfab_ep_unhash(xep, tm);
 		rc = libfab_ep_param_free(xep, tm);
 	}
 	M0_ASSERT(m0_nep_tlist_is_empty(&tm->ftm_ntm->ntm_end_points));
@@ -1616,6 +2006,7 @@ static int libfab_tm_param_free(struct m0_fab__tm *tm)
 		tm->ftm_tx_cq = NULL;
 	}
 
+	libfab_shm_fini(tm);
 	close(tm->ftm_epfd);
 	m0_free(tm->ftm_fids.ftf_head);
 	m0_free(tm->ftm_fids.ftf_ctx);
@@ -1627,6 +2018,8 @@ static int libfab_tm_param_free(struct m0_fab__tm *tm)
 		fab_bufhash_htable_del(&tm->ftm_bufhash.bht_hash, fbp);
 	} m0_htable_endfor;
 	fab_bufhash_htable_fini(&tm->ftm_bufhash.bht_hash);
+	if (m0_htable_is_init(&tm->ftm_ephash))
+		fab_ephash_htable_fini(&tm->ftm_ephash);
 
 	m0_tl_teardown(fab_bulk, &tm->ftm_bulk, op) {
 		m0_free(op);
@@ -1791,6 +2184,23 @@ static void libfab_buf_complete(struct m0_fab__buf *buf)
 	ma->ftm_ntm->ntm_callback_counter--;
 }
 
+/**
+ * Posts the receive buffer again after a completion which does not complete
+ * the buffer.
+ */
+static void libfab_recv_repost(struct m0_fab__buf *fbp)
+{
+	struct m0_fab__tm    *ma = libfab_buf_tm(fbp);
+	struct m0_net_buffer *nb = fbp->fb_nb;
+	struct iovec          iv;
+
+	fbp->fb_length = nb->nb_length;
+	iv.iov_base = nb->nb_buffer.ov_buf[0];
+	iv.iov_len =  nb->nb_buffer.ov_vec.v_count[0];
+	M0_ASSERT(fi_recvv(ma->ftm_rctx, &iv, fbp->fb_mr.bm_desc, 1, 0,
+			   U32_TO_VPTR(fbp->fb_token)) == 0);
+}
+
 /**
  * This function will check if the received message is a dummy message for
  * notification of RDMA operation completion.
@@ -1801,7 +2211,6 @@ static int libfab_dummy_msg_rcv_chk(struct m0_fab__buf *fbp)
 	struct m0_fab__tm    *ma = libfab_buf_tm(fbp);
 	struct m0_net_buffer *nb = fbp->fb_nb;
 	struct m0_fab__buf   *pas_buf;
-	struct iovec          iv;
 	uint32_t             *ptr;
 	uint32_t              token;
 	int                   ret = -1;
@@ -1822,12 +2231,7 @@ static int libfab_dummy_msg_rcv_chk(struct m0_fab__buf *fbp)
 			 * queue without generating a callback
 			 * as it contains only dummy data
 			 */
-			fbp->fb_length = nb->nb_length;
-			iv.iov_base = nb->nb_buffer.ov_buf[0];
-			iv.iov_len =  nb->nb_buffer.ov_vec.v_count[0];
-			M0_ASSERT(fi_recvv(ma->ftm_rctx, &iv,
-				  fbp->fb_mr.bm_desc, 1, 0,
-				  U32_TO_VPTR(fbp->fb_token)) == 0);
+			libfab_recv_repost(fbp);
 			ret = 0;
 		}
 	}
@@ -1893,6 +2297,7 @@ static void libfab_ep_release(struct m0_ref *ref)
 	M0_LOG(M0_DEBUG, "free endpoint %s", (char*)ep->fep_name.nia_p);
 
 	m0_nep_tlist_del(nep);
+	libfab_ep_unhash(ep, tm);
 	libfab_ep_param_free(ep, tm);
 }
 
@@ -2006,25 +2411,48 @@ static void libfab_tm_fini(struct m0_net_transfer_mc *tm)
 	M0_LEAVE();
 }
 
+/**
+ * Returns true if the buffer is registered in the shm domain of the tm it is
+ * registered with.
+ */
+static bool libfab_buf_shm_is_reg(const struct m0_fab__buf *fb)
+{
+	return fb->fb_shm_mr.bm_ent != NULL && fb->fb_shm_mr.bm_ent[0] != NULL;
+}
+
 /**
  * Encodes the descriptor for a (passive) network buffer.
+ *
+ * The shm name and registrations of the tm are added if "shm" is true and
+ * the buffer is registered in the shm domain, see m0_fab__bdesc.
  */
-static int libfab_bdesc_encode(struct m0_fab__buf *buf)
+static int libfab_bdesc_encode(struct m0_fab__buf *buf, bool shm)
 {
 	struct m0_fab__bdesc   *fbd;
 	struct fi_rma_iov      *iov;
+	struct fi_rma_iov      *shm_iov;
+	char                   *data;
 	struct m0_net_buf_desc *nbd = &buf->fb_nb->nb_desc;
 	struct m0_net_buffer   *nb = buf->fb_nb;
 	struct m0_fab__tm      *tm = libfab_buf_ma(nb);
 	int                     seg_nr = nb->nb_buffer.ov_vec.v_nr;
 	struct m0_fab__ndom    *nd = nb->nb_dom->nd_xprt_private;
+	struct m0_bufvec_cursor cur;
+	uint32_t                inline_len = 0;
 	int                     i;
 	bool                    is_verbs = libfab_is_verbs(tm);
 
 	M0_PRE(seg_nr <= nd->fnd_seg_nr);
 
+	shm = shm && libfab_shm_is_on(tm) && libfab_buf_shm_is_reg(buf);
+	if (nb->nb_qtype == M0_NET_QT_PASSIVE_BULK_SEND &&
+	    nb->nb_length <= nd->fnd_inline_max)
+		inline_len = nb->nb_length;
 	nbd->nbd_len = (sizeof(struct m0_fab__bdesc) +
-			(sizeof(struct fi_rma_iov) * seg_nr));
+			(sizeof(struct fi_rma_iov) * seg_nr) + inline_len);
+	if (shm)
+		nbd->nbd_len += sizeof(struct fi_rma_iov) * seg_nr +
+				FAB_SHM_NAME_MAX;
 	nbd->nbd_data = m0_alloc(nbd->nbd_len);
 	if (nbd->nbd_data == NULL)
 		return M0_RC(-ENOMEM);
@@ -2032,6 +2460,8 @@ static int libfab_bdesc_encode(struct m0_fab__buf *buf)
 	fbd = (struct m0_fab__bdesc *)nbd->nbd_data;
 	fbd->fbd_netaddr = tm->ftm_pep->fep_name.nia_n;
 	fbd->fbd_buftoken = buf->fb_token;
+	fbd->fbd_inline_len = inline_len;
+	fbd->fbd_shm_len = shm ? strlen(tm->ftm_shm.fsh_name) + 1 : 0;
 
 	fbd->fbd_iov_cnt = (uint32_t)seg_nr;
 	iov = (struct fi_rma_iov *)(nbd->nbd_data +
@@ -2042,6 +2472,25 @@ static int libfab_bdesc_encode(struct m0_fab__buf *buf)
 		iov[i].key  = fi_mr_key(buf->fb_mr.bm_mr[i]);
 		iov[i].len  = nb->nb_buffer.ov_vec.v_count[i];
 	}
+	data = (char *)(iov + seg_nr);
+
+	if (shm) {
+		shm_iov = iov + seg_nr;
+		for (i = 0; i < seg_nr; i++) {
+			shm_iov[i].addr = tm->ftm_shm.fsh_virt_addr ?
+				(uint64_t)nb->nb_buffer.ov_buf[i] : 0;
+			shm_iov[i].key  = fi_mr_key(buf->fb_shm_mr.bm_mr[i]);
+			shm_iov[i].len  = nb->nb_buffer.ov_vec.v_count[i];
+		}
+		data = (char *)(shm_iov + seg_nr);
+		memcpy(data, tm->ftm_shm.fsh_name, FAB_SHM_NAME_MAX);
+		data += FAB_SHM_NAME_MAX;
+	}
+
+	if (inline_len != 0) {
+		m0_bufvec_cursor_init(&cur, &nb->nb_buffer);
+		m0_bufvec_to_data_copy(&cur, data, inline_len);
+	}
 
 	return M0_RC(0);
 }
@@ -2054,16 +2503,253 @@ static void libfab_bdesc_decode(struct m0_fab__buf *fb,
 {
 	struct m0_net_buffer *nb = fb->fb_nb;
 	struct m0_fab__ndom  *ndom = nb->nb_dom->nd_xprt_private;
+	const char           *name;
 
 	fb->fb_rbd = (struct m0_fab__bdesc *)(nb->nb_desc.nbd_data);
 	fb->fb_riov = (struct fi_rma_iov *)(nb->nb_desc.nbd_data +
 					    sizeof(struct m0_fab__bdesc));
 	*addr = fb->fb_rbd->fbd_netaddr;
 	M0_ASSERT(fb->fb_rbd->fbd_iov_cnt <= ndom->fnd_seg_nr);
+	fb->fb_shm_riov = NULL;
+	if (fb->fb_rbd->fbd_shm_len != 0) {
+		fb->fb_shm_riov = fb->fb_riov + fb->fb_rbd->fbd_iov_cnt;
+		name = (const char *)(fb->fb_shm_riov +
+				      fb->fb_rbd->fbd_iov_cnt);
+		/* Do not use a corrupted name. */
+		if (fb->fb_rbd->fbd_shm_len > FAB_SHM_NAME_MAX ||
+		    name[fb->fb_rbd->fbd_shm_len - 1] != 0) {
+			M0_LOG(M0_ERROR, "Invalid shm name len=%"PRIu32,
+			       fb->fb_rbd->fbd_shm_len);
+			fb->fb_shm_riov = NULL;
+		}
+	}
+}
+
+/**
+ * Returns the buffer data carried in the decoded descriptor of a (passive)
+ * network buffer.
+ */
+static void *libfab_bdesc_inline_data(const struct m0_fab__buf *fb)
+{
+	uint32_t seg_nr = fb->fb_rbd->fbd_iov_cnt;
+	char    *data = (char *)(fb->fb_riov + seg_nr);
+
+	if (fb->fb_rbd->fbd_shm_len != 0)
+		data += sizeof(struct fi_rma_iov) * seg_nr + FAB_SHM_NAME_MAX;
+	return data;
+}
+
+/**
+ * Closes a memory registration.
+ */
+static int libfab_mr_close(struct fid_mr *mr)
+{
+	m0_time_t tmout;
+	int       ret = -EBUSY;
+
+	/*
+	 * If fi_close returns -EBUSY, that means that the buffer is in use.
+	 * In this case keep retry for a max time of 5 min to deregister
+	 * buffer till fi_close returns success or some other error code.
+	 */
+	tmout = m0_time_from_now(300, 0);
+	while (ret == -EBUSY && !m0_time_is_in_past(tmout))
+		ret = fi_close(&mr->fid);
+	return ret;
+}
+
+/**
+ * Closes the registration of a cache entry and frees the entry, which must
+ * be out of the hash table and the lru list.
+ */
+static int libfab_mr_ent_free(struct m0_fab__mr_ent *ent)
+{
+	int ret;
+
+	M0_PRE(ent->me_ref == 0);
+	ret = libfab_mr_close(ent->me_mr);
+	if (ret != 0)
+		M0_LOG(M0_ERROR, "mr close failed %d addr=%p len=%"PRIu64,
+		       ret, ent->me_key.mk_addr, ent->me_key.mk_len);
+	m0_tlink_fini(&fab_mrhash_tl, ent);
+	fab_mrlru_tlink_fini(ent);
+	m0_free(ent);
+	return ret;
+}
+
+/**
+ * Removes an unused entry from the cache and frees it.
+ */
+static void libfab_mr_evict(struct m0_fab__mr_cache *mc,
+			    struct m0_fab__mr_ent *ent)
+{
+	M0_PRE(m0_mutex_is_locked(&mc->mc_lock));
+	M0_PRE(ent->me_ref == 0 && !ent->me_stale);
+
+	fab_mrlru_tlist_del(ent);
+	M0_CNT_DEC(mc->mc_lru_nr);
+	fab_mrhash_htable_del(&mc->mc_hash, ent);
+	libfab_mr_ent_free(ent);
+}
+
+/**
+ * Returns the registration of the memory range in a domain of the tm.
+ *
+ * An existing registration is reused, otherwise the range is registered and
+ * added to the cache. The entry is released with libfab_mr_put().
+ */
+static int libfab_mr_get(struct m0_fab__mr_cache *mc, struct m0_fab__tm *tm,
+			 struct fid_domain *dom, void *addr, m0_bcount_t len,
+			 struct m0_fab__mr_ent **out)
+{
+	struct m0_fab__mr_ent *ent;
+	struct m0_fab__mr_key  key = {
+		.mk_addr = addr,
+		.mk_len  = len,
+		.mk_dom  = dom
+	};
+	uint64_t               mr_key = 0;
+	uint32_t               retry_cnt;
+	int                    ret = 0;
+
+	m0_mutex_lock(&mc->mc_lock);
+	ent = fab_mrhash_htable_lookup(&mc->mc_hash, &key);
+	if (ent != NULL) {
+		if (ent->me_ref == 0) {
+			fab_mrlru_tlist_del(ent);
+			M0_CNT_DEC(mc->mc_lru_nr);
+		}
+		mc->mc_hit++;
+	} else {
+		M0_ALLOC_PTR(ent);
+		if (ent == NULL) {
+			m0_mutex_unlock(&mc->mc_lock);
+			return M0_ERR(-ENOMEM);
+		}
+		/*
+		 * Sometimes the requested key is not available and
+		 * hence try with some other key for registration
+		 */
+		ret = -1;
+		retry_cnt = 20;
+		while (ret != 0 && retry_cnt > 0) {
+			mr_key = libfab_mr_keygen(tm);
+			ret = fi_mr_reg(key.mk_dom, addr, len, FAB_MR_ACCESS,
+					FAB_MR_OFFSET, mr_key, FAB_MR_FLAG,
+					&ent->me_mr, NULL);
+			--retry_cnt;
+		}
+		if (ret != 0) {
+			m0_mutex_unlock(&mc->mc_lock);
+			M0_LOG(M0_ERROR, "fi_mr_reg failed %d key=0x%"PRIx64,
+			       ret, mr_key);
+			m0_free(ent);
+			return M0_RC(ret);
+		}
+		ent->me_key = key;
+		ent->me_desc = fi_mr_desc(ent->me_mr);
+		m0_tlink_init(&fab_mrhash_tl, ent);
+		fab_mrlru_tlink_init(ent);
+		fab_mrhash_htable_add(&mc->mc_hash, ent);
+		mc->mc_miss++;
+	}
+	ent->me_ref++;
+	if ((mc->mc_hit + mc->mc_miss) % FAB_MR_CACHE_STATS_PERIOD == 0)
+		M0_ADDB2_ADD(M0_AVI_NET_MR_CACHE, mc->mc_hit, mc->mc_miss,
+			     mc->mc_evict, mc->mc_lru_nr);
+	m0_mutex_unlock(&mc->mc_lock);
+	*out = ent;
+	return M0_RC(0);
+}
+
+/**
+ * Releases an entry returned by libfab_mr_get().
+ *
+ * An unused registration is kept on the lru list, the least recently used
+ * ones are closed when the list is longer than m0_fab__mr_cache::mc_max.
+ */
+static int libfab_mr_put(struct m0_fab__mr_cache *mc,
+			 struct m0_fab__mr_ent *ent)
+{
+	int ret = 0;
+
+	m0_mutex_lock(&mc->mc_lock);
+	M0_CNT_DEC(ent->me_ref);
+	if (ent->me_ref == 0) {
+		if (ent->me_stale)
+			ret = libfab_mr_ent_free(ent);
+		else {
+			fab_mrlru_tlist_add_tail(&mc->mc_lru, ent);
+			M0_CNT_INC(mc->mc_lru_nr);
+			while (mc->mc_lru_nr > mc->mc_max) {
+				libfab_mr_evict(mc, fab_mrlru_tlist_head(
+							&mc->mc_lru));
+				mc->mc_evict++;
+			}
+		}
+	}
+	m0_mutex_unlock(&mc->mc_lock);
+	return ret;
+}
+
+/**
+ * Registers the segments of the buffer in the domain, the registrations are
+ * released with libfab_buf_mr_put().
+ */
+static int libfab_buf_mr_get(struct m0_fab__buf_mr *mr,
+			     struct m0_net_buffer *nb, struct m0_fab__tm *tm,
+			     struct fid_domain *dp)
+{
+	struct m0_fab__ndom *ndom = nb->nb_dom->nd_xprt_private;
+	int                  i;
+	int                  ret = 0;
+
+	for (i = 0; i < nb->nb_buffer.ov_vec.v_nr; i++) {
+		ret = libfab_mr_get(&ndom->fnd_mr_cache, tm, dp,
+				    nb->nb_buffer.ov_buf[i],
+				    nb->nb_buffer.ov_vec.v_count[i],
+				    &mr->bm_ent[i]);
+		if (ret != 0)
+			break;
+		mr->bm_mr[i] = mr->bm_ent[i]->me_mr;
+		mr->bm_desc[i] = mr->bm_ent[i]->me_desc;
+	}
+	return M0_RC(ret);
+}
+
+/**
+ * Releases the registrations taken by libfab_buf_mr_get().
+ */
+static int libfab_buf_mr_put(struct m0_fab__buf_mr *mr,
+			     struct m0_fab__buf *fbp)
+{
+	struct m0_fab__ndom *ndom = fbp->fb_nb->nb_dom->nd_xprt_private;
+	uint32_t             seg_nr = fbp->fb_nb->nb_buffer.ov_vec.v_nr;
+	int                  i;
+	int                  rc;
+	int                  ret = 0;
+
+	for (i = 0; i < seg_nr; i++) {
+		if (mr->bm_ent[i] != NULL) {
+			rc = libfab_mr_put(&ndom->fnd_mr_cache, mr->bm_ent[i]);
+			if (rc != 0) {
+				M0_LOG(M0_ERROR,"mr[%d] close failed %d fb=%p",
+				       i, rc, fbp);
+				ret = rc;
+			}
+			mr->bm_ent[i] = NULL;
+			mr->bm_mr[i] = NULL;
+			mr->bm_desc[i] = NULL;
+		}
+	}
+	return ret;
 }
 
 /**
  * Register the buffer with the appropriate access to the domain
+ *
+ * The buffer is also registered in the shm domain of the tm if it has one. A
+ * failure there is not fatal, the buffer is not transferred through shm then.
  */
 static int libfab_buf_dom_reg(struct m0_net_buffer *nb, struct m0_fab__tm *tm)
 {
@@ -2071,10 +2757,7 @@ static int libfab_buf_dom_reg(struct m0_net_buffer *nb, struct m0_fab__tm *tm)
 	struct m0_fab__buf_mr *mr;
 	struct m0_fab__ndom   *ndom;
 	struct fid_domain     *dp;
-	uint64_t               key;
-	uint32_t               retry_cnt;
 	int                    seg_nr;
-	int                    i;
 	int                    ret = 0;
 
 	M0_PRE(nb != NULL && nb->nb_dom != NULL && tm != NULL);
@@ -2090,39 +2773,24 @@ static int libfab_buf_dom_reg(struct m0_net_buffer *nb, struct m0_fab__tm *tm)
 	if (fbp->fb_dp == dp)
 		return M0_RC(ret);
 
-	if (fbp->fb_state == FAB_BUF_REGISTERED)
+	if (fbp->fb_state == FAB_BUF_REGISTERED) {
 		M0_LOG(M0_ERROR,"Re-registration of buffer");
+		libfab_buf_dom_dereg(fbp);
+	}
 
-	for (i = 0; i < seg_nr; i++) {
-		/*
-		 * Sometimes the requested key is not available and
-		 * hence try with some other key for registration
-		 */
-		ret = -1;
-		retry_cnt = 20;
-
-		while (ret != 0 && retry_cnt > 0) {
-			key = libfab_mr_keygen(tm);
-			ret = fi_mr_reg(dp, nb->nb_buffer.ov_buf[i],
-					nb->nb_buffer.ov_vec.v_count[i],
-					FAB_MR_ACCESS, FAB_MR_OFFSET, key,
-					FAB_MR_FLAG, &mr->bm_mr[i], NULL);
-			--retry_cnt;
-		}
-
-		if (ret != 0) {
-			M0_LOG(M0_ERROR, "fi_mr_reg failed %d key=0x%"PRIx64,
-			       ret, key);
-			break;
-		}
-
-		mr->bm_desc[i] = fi_mr_desc(mr->bm_mr[i]);
+	ret = libfab_buf_mr_get(mr, nb, tm, dp);
+	if (ret == 0 && libfab_shm_is_on(tm) && fbp->fb_shm_mr.bm_ent != NULL &&
+	    libfab_buf_mr_get(&fbp->fb_shm_mr, nb, tm,
+			      tm->ftm_shm.fsh_fab->fab_dom) != 0) {
+		M0_LOG(M0_ERROR, "shm registration failed fb=%p", fbp);
+		libfab_buf_mr_put(&fbp->fb_shm_mr, fbp);
 	}
 
 	if (ret == 0) {
 		fbp->fb_dp = dp;
 		fbp->fb_state = FAB_BUF_REGISTERED;
-	}
+	} else
+		libfab_buf_dom_dereg(fbp);
 
 	return M0_RC(ret);
 }
@@ -2161,6 +2829,99 @@ static void libfab_pending_bufs_send(struct m0_fab__ep *ep)
 		libfab_bufq_process(libfab_buf_ma(nb));
 }
 
+/**
+ * Returns true if the data of an active bulk receive buffer is carried in the
+ * descriptor of the passive buffer.
+ */
+static bool libfab_is_inline(const struct m0_fab__buf *fb)
+{
+	return fb->fb_nb->nb_qtype == M0_NET_QT_ACTIVE_BULK_RECV &&
+	       fb->fb_rbd->fbd_inline_len >= fb->fb_nb->nb_length;
+}
+
+/**
+ * Posts a zero length RDMA write with immediate data carrying the token of
+ * the remote passive buffer, so that the remote end completes the buffer in
+ * the same way as after the last write of an active bulk send. Unlike a send
+ * of a message, this needs no receive buffer with a message in it.
+ */
+static int libfab_remote_complete(struct m0_fab__active_ep *aep,
+				  struct m0_fab__buf *buf, uint32_t token)
+{
+	struct m0_fab__tm *tm;
+
+	if (buf->fb_shm) {
+		tm = libfab_buf_tm(buf);
+		return fi_writedata(tm->ftm_shm.fsh_ep, NULL, 0, NULL,
+				    buf->fb_rbd->fbd_buftoken,
+				    buf->fb_txctx->fep_shm_addr,
+				    buf->fb_shm_riov[0].addr,
+				    buf->fb_shm_riov[0].key,
+				    U32_TO_VPTR(token));
+	}
+	return fi_writedata(aep->aep_txep, NULL, 0, NULL,
+			    buf->fb_rbd->fbd_buftoken, 0,
+			    buf->fb_riov[0].addr, buf->fb_riov[0].key,
+			    U32_TO_VPTR(token));
+}
+
+/**
+ * Returns true if the address is the one of the host of the tm.
+ */
+static bool libfab_addr_is_local(const struct m0_fab__tm *tm,
+				 const struct m0_net_ip_params *addr)
+{
+	const struct m0_net_ip_params *loc = &tm->ftm_pep->fep_name.nia_n;
+	const uint8_t                 *ip = (const uint8_t *)addr->nip_ip_n.sn;
+	bool                           inet = (addr->nip_format ==
+					       M0_NET_IP_LNET_FORMAT) ||
+		(addr->nip_fmt_pvt.ia.nia_family == M0_NET_IP_AF_INET);
+
+	return (inet && ip[0] == 127) ||
+	       (addr->nip_ip_n.ln[0] == loc->nip_ip_n.ln[0] &&
+		addr->nip_ip_n.ln[1] == loc->nip_ip_n.ln[1]);
+}
+
+/**
+ * Decides whether the bulk transfer of an active buffer to or from the given
+ * endpoint goes through shm, inserting the shm endpoint of the peer into the
+ * address vector of the tm if needed.
+ *
+ * The peer restarted with the same network address has another shm name, the
+ * old address is removed then.
+ */
+static bool libfab_shm_peer(struct m0_fab__tm *tm, struct m0_fab__buf *fb,
+			    struct m0_fab__ep *ep)
+{
+	struct m0_fab__shm *shm = &tm->ftm_shm;
+	const char         *name;
+	int                 rc;
+
+	if (!libfab_shm_is_on(tm) || !libfab_buf_shm_is_reg(fb) ||
+	    fb->fb_shm_riov == NULL ||
+	    !libfab_addr_is_local(tm, &fb->fb_rbd->fbd_netaddr))
+		return false;
+
+	name = (const char *)(fb->fb_shm_riov + fb->fb_rbd->fbd_iov_cnt);
+	if (strncmp(ep->fep_shm_name, name, FAB_SHM_NAME_MAX) == 0)
+		return true;
+
+	if (ep->fep_shm_name[0] != 0) {
+		rc = fi_av_remove(shm->fsh_av, &ep->fep_shm_addr, 1, 0);
+		if (rc != 0)
+			M0_LOG(M0_ERROR, "shm av remove failed %d name=%s",
+			       rc, (char *)ep->fep_shm_name);
+		ep->fep_shm_name[0] = 0;
+	}
+	rc = fi_av_insert(shm->fsh_av, name, 1, &ep->fep_shm_addr, 0, NULL);
+	if (rc != 1) {
+		M0_LOG(M0_ERROR, "shm av insert failed %d name=%s", rc, name);
+		return false;
+	}
+	memcpy(ep->fep_shm_name, name, FAB_SHM_NAME_MAX);
+	return true;
+}
+
 /**
  * Notify target endpoint about RDMA read completion,
  * so that buffer on remote endpoint shall be released.
@@ -2170,16 +2931,15 @@ static int libfab_target_notify(struct m0_fab__buf *buf)
 	struct m0_fab__active_ep *aep;
 	struct m0_fab__buf       *fbp;
 	struct m0_fab__tm        *tm;
-	struct iovec              iv;
-	struct fi_msg             op_msg;
 	int                       ret = 0;
 
 	M0_PRE(buf != NULL && buf->fb_txctx != NULL);
 	aep = libfab_aep_get(buf->fb_txctx);
 	M0_ASSERT(aep != NULL);
 
+	/* Inline transfers notify the target with libfab_inline_op(). */
 	if (buf->fb_nb->nb_qtype == M0_NET_QT_ACTIVE_BULK_RECV &&
-	    aep->aep_tx_state == FAB_CONNECTED) {
+	    aep->aep_tx_state == FAB_CONNECTED && !libfab_is_inline(buf)) {
 		M0_ALLOC_PTR(fbp);
 		if (fbp == NULL)
 			return M0_ERR(-ENOMEM);
@@ -2194,16 +2954,8 @@ static int libfab_target_notify(struct m0_fab__buf *buf)
 		m0_tlink_init(&fab_bufhash_tl, fbp);
 		fab_bufhash_htable_add(&tm->ftm_bufhash.bht_hash, fbp);
 
-		iv.iov_base = fbp->fb_dummy;
-		iv.iov_len = sizeof(fbp->fb_dummy);
-		op_msg.msg_iov = &iv;
-		op_msg.desc = NULL;
-		op_msg.iov_count = 1;
-		op_msg.addr = 0;
-		op_msg.context = U32_TO_VPTR(fbp->fb_token);
-		op_msg.data = 0;
 		fbp->fb_wr_cnt = 1;
-		ret = fi_sendmsg(aep->aep_txep, &op_msg, FI_COMPLETION);
+		ret = libfab_remote_complete(aep, buf, fbp->fb_token);
 		if (ret != 0) {
 			M0_LOG(M0_ERROR,"tgt notify fail %d opcnt=%d", ret,
 			       aep->aep_bulk_cnt);
@@ -2639,6 +3391,29 @@ static int libfab_ping_op(struct m0_fab__active_ep *aep, struct m0_fab__buf *fb)
 	return ret;
 }
 
+/**
+ * Completes an active bulk receive from the data carried in the descriptor:
+ * copies the data into the buffer and notifies the target, the buffer is
+ * completed when the notification is sent.
+ */
+static int libfab_inline_op(struct m0_fab__active_ep *aep,
+			    struct m0_fab__buf *fb)
+{
+	struct m0_bufvec_cursor cur;
+	struct m0_net_buffer   *nb = fb->fb_nb;
+	void                   *data;
+	int                     ret;
+
+	data = libfab_bdesc_inline_data(fb);
+	m0_bufvec_cursor_init(&cur, &nb->nb_buffer);
+	m0_data_to_bufvec_copy(&cur, data, nb->nb_length);
+	fb->fb_wr_cnt = 1;
+	ret = libfab_remote_complete(aep, fb, fb->fb_token);
+	if (ret == 0)
+		aep->aep_bulk_cnt += fb->fb_wr_cnt;
+	return M0_RC(ret);
+}
+
 /**
  * This function will call the bulk transfer operation (read/write) on the
  * net-buffer.
@@ -2651,7 +3426,10 @@ static int libfab_bulk_op(struct m0_fab__active_ep *aep, struct m0_fab__buf *fb)
 	struct fi_rma_iov             *r_iov;
 	struct fi_rma_iov             *remote = tm->ftm_rem_iov;
 	struct iovec                  *loc_iv = tm->ftm_loc_iov;
+	struct fid_ep                 *txep = aep->aep_txep;
+	void                         **desc = fb->fb_mr.bm_desc;
 	m0_bcount_t                   *v_cnt;
+	fi_addr_t                      dest = 0;
 	uint64_t                       op_flag;
 	uint32_t                       loc_slen;
 	uint32_t                       rem_slen;
@@ -2674,6 +3452,16 @@ static int libfab_bulk_op(struct m0_fab__active_ep *aep, struct m0_fab__buf *fb)
 	xp = fb->fb_xfer_params;
 	r_iov = fb->fb_riov;
 	isread = (fb->fb_nb->nb_qtype == M0_NET_QT_ACTIVE_BULK_RECV);
+	if (libfab_is_inline(fb))
+		return M0_RC(libfab_inline_op(aep, fb));
+	if (fb->fb_shm) {
+		/* Same segments, shm keys and addresses. */
+		txep = tm->ftm_shm.fsh_ep;
+		desc = fb->fb_shm_mr.bm_desc;
+		r_iov = fb->fb_shm_riov;
+		max_iov = tm->ftm_shm.fsh_max_iov;
+		dest = fb->fb_txctx->fep_shm_addr;
+	}
 
 	while (xp.bxp_xfer_len < fb->fb_nb->nb_length) {
 		for (idx = 0; idx < max_iov && !last_seg; idx++) {
@@ -2710,9 +3498,9 @@ static int libfab_bulk_op(struct m0_fab__active_ep *aep, struct m0_fab__buf *fb)
 		}
 
 		op_msg.msg_iov       = &loc_iv[0];
-		op_msg.desc          = &fb->fb_mr.bm_desc[xp.bxp_loc_sidx];
+		op_msg.desc          = &desc[xp.bxp_loc_sidx];
 		op_msg.iov_count     = idx;
-		op_msg.addr          = xp.bxp_rem_soff;
+		op_msg.addr          = fb->fb_shm ? dest : xp.bxp_rem_soff;
 		op_msg.rma_iov       = &remote[0];
 		op_msg.rma_iov_count = idx;
 		op_msg.context       = U32_TO_VPTR(fb->fb_token);
@@ -2722,8 +3510,8 @@ static int libfab_bulk_op(struct m0_fab__active_ep *aep, struct m0_fab__buf *fb)
 		op_flag = (isread || (!last_seg)) ? 0 : FI_REMOTE_CQ_DATA;
 		op_flag |= last_seg ? FI_COMPLETION : 0;
 
-		ret = isread ? fi_readmsg(aep->aep_txep, &op_msg, op_flag) :
-		      fi_writemsg(aep->aep_txep, &op_msg, op_flag);
+		ret = isread ? fi_readmsg(txep, &op_msg, op_flag) :
+		      fi_writemsg(txep, &op_msg, op_flag);
 
 		if (ret != 0) {
 			M0_LOG(M0_ERROR,"bulk-op failed %d b=%p q=%d l_seg=%d \
@@ -2801,44 +3589,79 @@ static int libfab_domain_params_get(struct m0_fab__ndom *fab_ndom)
 
 static int libfab_buf_dom_dereg(struct m0_fab__buf *fbp)
 {
-	m0_time_t tmout;
-	int       i;
-	int       ret = 0;
-	uint32_t  seg_nr;
+	int rc;
+	int ret;
 
 	M0_PRE(fbp != NULL && fbp->fb_nb != NULL);
-	seg_nr = fbp->fb_nb->nb_buffer.ov_vec.v_nr;
 
-	for (i = 0; i < seg_nr; i++) {
-		if (fbp->fb_mr.bm_mr[i] != NULL) {
-			/*
-			 * If fi_close returns -EBUSY, that means that the
-			 * buffer is in use. In this case keep retry for a max
-			 * time of 5 min to deregister buffer till fi_close
-			 * returns success or some other error code.
-			 */
-			tmout = m0_time_from_now(300, 0);
-			ret = -EBUSY;
-			while (ret == -EBUSY && !m0_time_is_in_past(tmout)) {
-				ret = fi_close(&fbp->fb_mr.bm_mr[i]->fid);
-			}
-			if (ret != 0) {
-				M0_LOG(M0_ERROR,"mr[%d] close failed %d fb=%p",
-				       i, ret, fbp);
-				break;
-			}
-			fbp->fb_mr.bm_mr[i] = NULL;
-		}
+	ret = libfab_buf_mr_put(&fbp->fb_mr, fbp);
+	if (fbp->fb_shm_mr.bm_ent != NULL) {
+		rc = libfab_buf_mr_put(&fbp->fb_shm_mr, fbp);
+		ret = ret ?: rc;
 	}
 
-	if (ret == 0) {
-		fbp->fb_dp = NULL;
-		fbp->fb_state = FAB_BUF_DEREGISTERED;
-	}
+	fbp->fb_dp = NULL;
+	fbp->fb_state = FAB_BUF_DEREGISTERED;
 
 	return M0_RC(ret);
 }
 
+static int libfab_mr_cache_init(struct m0_fab__mr_cache *mc)
+{
+	int rc;
+
+	rc = fab_mrhash_htable_init(&mc->mc_hash, FAB_MR_CACHE_BUCKET_NR);
+	if (rc != 0)
+		return M0_ERR(rc);
+	m0_mutex_init(&mc->mc_lock);
+	fab_mrlru_tlist_init(&mc->mc_lru);
+	mc->mc_max = libfab_mr_cache_max;
+	return 0;
+}
+
+/**
+ * Closes the cached registrations. All buffers of the domain are deregistered
+ * by now, so any entry is unused and on the lru list.
+ */
+static void libfab_mr_cache_fini(struct m0_fab__mr_cache *mc)
+{
+	struct m0_fab__mr_ent *ent;
+
+	m0_mutex_lock(&mc->mc_lock);
+	while ((ent = fab_mrlru_tlist_head(&mc->mc_lru)) != NULL)
+		libfab_mr_evict(mc, ent);
+	m0_mutex_unlock(&mc->mc_lock);
+	M0_LOG(M0_DEBUG, "mr cache hit=%"PRIu64" miss=%"PRIu64" evict=%"PRIu64,
+	       mc->mc_hit, mc->mc_miss, mc->mc_evict);
+	fab_mrlru_tlist_fini(&mc->mc_lru);
+	fab_mrhash_htable_fini(&mc->mc_hash);
+	m0_mutex_fini(&mc->mc_lock);
+}
+
+M0_INTERNAL void m0_net_libfab_mr_invalidate(struct m0_net_domain *dom,
+					     void *addr, m0_bcount_t len)
+{
+	struct m0_fab__ndom     *ndom = dom->nd_xprt_private;
+	struct m0_fab__mr_cache *mc = &ndom->fnd_mr_cache;
+	struct m0_fab__mr_ent   *ent;
+	char                    *start = addr;
+	char                    *s;
+
+	m0_mutex_lock(&mc->mc_lock);
+	m0_htable_for(fab_mrhash, ent, &mc->mc_hash) {
+		s = ent->me_key.mk_addr;
+		if (s < start + len && start < s + ent->me_key.mk_len) {
+			if (ent->me_ref == 0)
+				libfab_mr_evict(mc, ent);
+			else {
+				fab_mrhash_htable_del(&mc->mc_hash, ent);
+				ent->me_stale = true;
+			}
+		}
+	} m0_htable_endfor;
+	m0_mutex_unlock(&mc->mc_lock);
+}
+
 /*============================================================================*/
 
 /**
@@ -2856,12 +3679,15 @@ static int libfab_dom_init(const struct m0_net_xprt *xprt,
 	if (fab_ndom == NULL)
 		return M0_ERR(-ENOMEM);
 
-	ret = libfab_domain_params_get(fab_ndom);
+	ret = libfab_domain_params_get(fab_ndom) ?:
+	      libfab_mr_cache_init(&fab_ndom->fnd_mr_cache);
 	if (ret != 0)
 		m0_free(fab_ndom);
 	else {
 		dom->nd_xprt_private = fab_ndom;
 		fab_ndom->fnd_ndom = dom;
+		fab_ndom->fnd_inline_max = libfab_inline_max;
+		fab_ndom->fnd_shm = libfab_shm;
 		m0_mutex_init(&fab_ndom->fnd_lock);
 		fab_fabs_tlist_init(&fab_ndom->fnd_fabrics);
 	}
@@ -2880,6 +3706,7 @@ static void libfab_dom_fini(struct m0_net_domain *dom)
 	M0_ENTRY();
 	libfab_dom_invariant(dom);
 	fnd = dom->nd_xprt_private;
+	libfab_mr_cache_fini(&fnd->fnd_mr_cache);
 	m0_tl_teardown(fab_fabs, &fnd->fnd_fabrics, fab) {
 		if (fab->fab_dom != NULL) {
 			rc = fi_close(&fab->fab_dom->fid);
@@ -2924,6 +3751,8 @@ static void libfab_ma_fini(struct m0_net_transfer_mc *tm)
 	libfab_tm_fini(tm);
 	tm->ntm_xprt_private = NULL;
 
+	if (ma->ftm_processors.b_words != NULL)
+		m0_bitmap_fini(&ma->ftm_processors);
 	fab_buf_tlist_fini(&ma->ftm_done);
 	m0_free(ma);
 
@@ -2963,7 +3792,9 @@ static int libfab_ma_init(struct m0_net_transfer_mc *ntm)
 		ftm->ftm_bufhash.bht_magic = M0_NET_LIBFAB_BUF_HT_HEAD_MAGIC;
 		rc = fab_bufhash_htable_init(&ftm->ftm_bufhash.bht_hash,
 					     ((M0_NET_QT_NR + 1) *
-					      FAB_NUM_BUCKETS_PER_QTYPE));
+					      FAB_NUM_BUCKETS_PER_QTYPE)) ?:
+		     fab_ephash_htable_init(&ftm->ftm_ephash,
+					    FAB_EP_BUCKET_NR);
 	} else
 		rc = M0_ERR(-ENOMEM);
 
@@ -2996,13 +3827,19 @@ static int libfab_ma_start(struct m0_net_transfer_mc *ntm, const char *name)
 		rc = libfab_passive_ep_create(ftm->ftm_pep, ftm);
 		if (rc != 0)
 			return M0_ERR(rc);
+		if (fnd->fnd_shm) {
+			rc = libfab_shm_init(ftm, fnd);
+			if (rc != 0)
+				M0_LOG(M0_WARN, "tm=%s does not use shm rc=%d",
+				       name, rc);
+		}
 
 		nep = &ftm->ftm_pep->fep_nep;
 		nep->nep_xprt_pvt = ftm->ftm_pep;
 		nep->nep_tm = ntm;
 		libfab_ep_pton(&ftm->ftm_pep->fep_name,
 			       &ftm->ftm_pep->fep_name_n);
-		m0_nep_tlink_init_at_tail(nep, &ntm->ntm_end_points);
+		libfab_ep_link(ftm->ftm_pep, ftm);
 		ftm->ftm_pep->fep_nep.nep_addr = ftm->ftm_pep->fep_name.nia_p;
 
 		m0_mutex_init(&ftm->ftm_endlock);
@@ -3047,7 +3884,17 @@ static int libfab_ma_stop(struct m0_net_transfer_mc *net, bool cancel)
 static int libfab_ma_confine(struct m0_net_transfer_mc *ma,
 			     const struct m0_bitmap *processors)
 {
-	return M0_ERR(-ENOSYS);
+	struct m0_fab__tm *tm = ma->ntm_xprt_private;
+	int                rc;
+
+	M0_PRE(m0_mutex_is_locked(&ma->ntm_mutex));
+	M0_PRE(processors != NULL);
+	if (tm->ftm_processors.b_words != NULL)
+		m0_bitmap_fini(&tm->ftm_processors);
+	rc = m0_bitmap_init(&tm->ftm_processors, processors->b_nr);
+	if (rc == 0)
+		m0_bitmap_copy(&tm->ftm_processors, processors);
+	return M0_RC(rc);
 }
 
 /**
@@ -3082,12 +3929,32 @@ static void libfab_buf_deregister(struct m0_net_buffer *nb)
 
 	libfab_buf_dom_dereg(fb);
 	libfab_buf_fini(fb);
-	m0_free(fb->fb_mr.bm_desc);
-	m0_free(fb->fb_mr.bm_mr);
+	libfab_buf_mr_free(&fb->fb_mr);
+	libfab_buf_mr_free(&fb->fb_shm_mr);
 	m0_free(fb);
 	nb->nb_xprt_private = NULL;
 }
 
+static int libfab_buf_mr_alloc(struct m0_fab__buf_mr *mr, uint32_t seg_nr)
+{
+	M0_ALLOC_ARR(mr->bm_desc, seg_nr);
+	M0_ALLOC_ARR(mr->bm_mr, seg_nr);
+	M0_ALLOC_ARR(mr->bm_ent, seg_nr);
+	if (mr->bm_desc == NULL || mr->bm_mr == NULL || mr->bm_ent == NULL) {
+		libfab_buf_mr_free(mr);
+		return M0_ERR(-ENOMEM);
+	}
+	return M0_RC(0);
+}
+
+static void libfab_buf_mr_free(struct m0_fab__buf_mr *mr)
+{
+	m0_free(mr->bm_desc);
+	m0_free(mr->bm_mr);
+	m0_free(mr->bm_ent);
+	M0_SET0(mr);
+}
+
 /**
  * Register a network buffer that can be used for
  * send/recv and local/remote RMA
@@ -3109,12 +3976,10 @@ static int libfab_buf_register(struct m0_net_buffer *nb)
 	if (fb == NULL)
 		return M0_ERR(-ENOMEM);
 
-	M0_ALLOC_ARR(fb->fb_mr.bm_desc, nd->fnd_seg_nr);
-	M0_ALLOC_ARR(fb->fb_mr.bm_mr, nd->fnd_seg_nr);
-
-	if (fb->fb_mr.bm_desc == NULL || fb->fb_mr.bm_mr == NULL) {
-		m0_free(fb->fb_mr.bm_desc);
-		m0_free(fb->fb_mr.bm_mr);
+	if (libfab_buf_mr_alloc(&fb->fb_mr, nd->fnd_seg_nr) != 0 ||
+	    (nd->fnd_shm &&
+	     libfab_buf_mr_alloc(&fb->fb_shm_mr, nd->fnd_seg_nr) != 0)) {
+		libfab_buf_mr_free(&fb->fb_mr);
 		m0_free(fb);
 		return M0_ERR(-ENOMEM);
 	}
@@ -3143,6 +4008,7 @@ static int libfab_buf_add(struct m0_net_buffer *nb)
 	struct iovec              iv;
 	struct m0_net_ip_addr     addr = {};
 	int                       ret = 0;
+	bool                      dummy;
 
 	M0_ENTRY("fb=%p nb=%p q=%d l=%"PRIu64, fbp, nb, nb->nb_qtype,
 		 nb->nb_length);
@@ -3156,6 +4022,7 @@ static int libfab_buf_add(struct m0_net_buffer *nb)
 	fbp->fb_token = libfab_buf_token_get(ma, fbp);
 	libfab_buf_dom_reg(nb, ma);
 	fbp->fb_status = 0;
+	fbp->fb_shm = false;
 
 	switch (nb->nb_qtype) {
 	case M0_NET_QT_MSG_RECV: {
@@ -3195,7 +4062,7 @@ static int libfab_buf_add(struct m0_net_buffer *nb)
 	case M0_NET_QT_PASSIVE_BULK_RECV: {
 		fbp->fb_length = nb->nb_length;
 		if (!libfab_is_verbs(ma)) {
-			ret = libfab_bdesc_encode(fbp);
+			ret = libfab_bdesc_encode(fbp, true);
 			break;
 		}
 		/* else
@@ -3203,14 +4070,16 @@ static int libfab_buf_add(struct m0_net_buffer *nb)
 	}
 
 	case M0_NET_QT_PASSIVE_BULK_SEND: {
-		if (m0_net_tm_tlist_is_empty(
-				  &ma->ftm_ntm->ntm_q[M0_NET_QT_MSG_RECV]))
+		dummy = m0_net_tm_tlist_is_empty(
+				  &ma->ftm_ntm->ntm_q[M0_NET_QT_MSG_RECV]);
+		if (dummy)
 			ret = fi_recv(ma->ftm_rctx, fbp->fb_dummy,
 				      sizeof(fbp->fb_dummy), NULL, 0,
 				      U32_TO_VPTR(fbp->fb_token));
 
+		/* A notification through shm would not consume the dummy. */
 		if (ret == 0)
-			ret = libfab_bdesc_encode(fbp);
+			ret = libfab_bdesc_encode(fbp, !dummy);
 		break;
 	}
 
@@ -3225,6 +4094,7 @@ static int libfab_buf_add(struct m0_net_buffer *nb)
 		if (ret != 0)
 			break;
 		fbp->fb_txctx = ep;
+		fbp->fb_shm = libfab_shm_peer(ma, fbp, ep);
 		aep = libfab_aep_get(ep);
 		if (aep->aep_tx_state != FAB_CONNECTED)
 			ret = libfab_conn_init(ep, ma, fbp);
@@ -3361,7 +4231,10 @@ static m0_bcount_t libfab_get_max_buf_desc_size(const struct m0_net_domain *dom)
 	m0_bcount_t          max_bd_size = sizeof(struct fi_rma_iov);
 
 	max_bd_size = (max_bd_size * nd->fnd_seg_nr) +
-		      sizeof(struct m0_fab__bdesc);
+		      sizeof(struct m0_fab__bdesc) + nd->fnd_inline_max;
+	if (nd->fnd_shm)
+		max_bd_size += sizeof(struct fi_rma_iov) * nd->fnd_seg_nr +
+			       FAB_SHM_NAME_MAX;
 
 	return max_bd_size;
 }
@@ -3458,6 +4331,27 @@ M0_EXPORTED(m0_net_libfab_xprt);
 
 #else /* ENABLE_LIBFAB */
 
+M0_INTERNAL void m0_net_libfab_busy_poll_set(m0_time_t interval)
+{
+}
+
+M0_INTERNAL void m0_net_libfab_mr_cache_set(uint32_t nr)
+{
+}
+
+M0_INTERNAL void m0_net_libfab_inline_set(uint32_t len)
+{
+}
+
+M0_INTERNAL void m0_net_libfab_shm_set(bool on)
+{
+}
+
+M0_INTERNAL void m0_net_libfab_mr_invalidate(struct m0_net_domain *dom,
+					     void *addr, m0_bcount_t len)
+{
+}
+
 /* libfab init and fini() : initialized in motr init */
 M0_INTERNAL int m0_net_libfab_init(void)
 {
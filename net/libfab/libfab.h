@@ -25,9 +25,71 @@
 #ifndef __MOTR_NET_LIBFAB_LIBFAB_H__
 #define __MOTR_NET_LIBFAB_LIBFAB_H__
 
+#include "lib/time.h"           /* m0_time_t */
+#include "lib/types.h"          /* m0_bcount_t */
+
+struct m0_net_domain;
+
 M0_INTERNAL int  m0_net_libfab_init(void);
 M0_INTERNAL void m0_net_libfab_fini(void);
 
+/**
+ * Makes pollers of libfab transfer machines poll completion queues without
+ * blocking for the given interval after each completion, trading processor
+ * time for wakeup latency. 0 (the default) disables busy polling.
+ *
+ * Combine with m0_net_tm_confine() to pin the poller to a processor.
+ */
+M0_INTERNAL void m0_net_libfab_busy_poll_set(m0_time_t interval);
+
+/**
+ * Sets how many unused memory registrations a libfab domain initialised after
+ * the call keeps for reuse. Buffers registered again with the same memory,
+ * e.g. buffers of a pool moved between transfer machines, then skip
+ * fi_mr_reg(). 0 (the default) closes registrations as soon as they are
+ * unused.
+ *
+ * Hit, miss and eviction counts are reported as "net-mr-cache" addb2 records.
+ *
+ * A cached registration pins its memory, so memory of a network buffer that
+ * is freed and may be reused must be passed to m0_net_libfab_mr_invalidate()
+ * when the cache is on.
+ */
+M0_INTERNAL void m0_net_libfab_mr_cache_set(uint32_t nr);
+
+/**
+ * Sets the max length of passive bulk send buffers whose data is carried in
+ * the buffer descriptor of a libfab domain initialised after the call. The
+ * active side copies the data from the descriptor instead of reading it with
+ * RDMA and only notifies the passive side. The max buffer descriptor size of
+ * the domain grows by len. 0 (the default) disables inline transfers.
+ */
+M0_INTERNAL void m0_net_libfab_inline_set(uint32_t len);
+
+/**
+ * Makes transfer machines of a libfab domain initialised after the call use
+ * the shm provider for bulk transfers with peers on the same host. Each
+ * transfer machine opens a shm endpoint next to its network endpoints and
+ * puts its name in the buffer descriptors. The active side reads or writes
+ * the buffer through shm if the descriptor comes from a transfer machine
+ * with the same ip address (or a loopback one) which has a shm endpoint, and
+ * through the network provider otherwise. Messages always go through the
+ * network provider. A transfer machine that fails to set up shm silently
+ * uses the network provider only.
+ *
+ * The max buffer descriptor size of the domain grows by the shm endpoint name
+ * and an iov per segment. false (the default) disables shm.
+ */
+M0_INTERNAL void m0_net_libfab_shm_set(bool on);
+
+/**
+ * Drops the cached registrations of the domain overlapping the given range.
+ * Registrations in use by buffers are closed when the buffers are
+ * deregistered.
+ */
+M0_INTERNAL void m0_net_libfab_mr_invalidate(struct m0_net_domain *dom,
+					     void *addr, m0_bcount_t len);
+
 #ifdef ENABLE_LIBFAB
 extern struct m0_net_xprt m0_net_libfab_xprt;
 
@@ -101,14 +101,26 @@ enum m0_fab__libfab_params {
 	FAB_MAX_RX_CQ_EV               = 256,
 	/** Max receive buffers in a shared receive pool */
 	FAB_MAX_SRX_SIZE               = 4096,
-	/** Max number of buckets per Qtype */
-	FAB_NUM_BUCKETS_PER_QTYPE      = 128,
+	/** Max number of buckets per Qtype, tf_queue_num has 8 bits */
+	FAB_NUM_BUCKETS_PER_QTYPE      = 256,
+	/** Number of buckets of the endpoint hash of a transfer machine */
+	FAB_EP_BUCKET_NR               = 1024,
 	/** Min time interval between buffer timeout check (sec) */
 	FAB_BUF_TMOUT_CHK_INTERVAL     = 1,
 	/** Timeout interval for getting a reply to the CONNREQ (sec) */
 	FAB_CONNECTING_TMOUT           = 5,
+	/** Number of buckets of the memory registration cache */
+	FAB_MR_CACHE_BUCKET_NR         = 256,
+	/** Number of mr cache lookups between addb2 statistics records */
+	FAB_MR_CACHE_STATS_PERIOD      = 1024,
 	/** The step for increasing array size of fids in a tm */
-	FAB_TM_FID_MALLOC_STEP         = 1024
+	FAB_TM_FID_MALLOC_STEP         = 1024,
+	/** Max length of a shm endpoint name, FI_NAME_MAX of libfabric */
+	FAB_SHM_NAME_MAX               = 64,
+	/** Max entries in the completion queue of the shm endpoint */
+	FAB_MAX_SHM_CQ_EV              = 1024,
+	/** Expected number of peers in the address vector of shm */
+	FAB_SHM_AV_SIZE                = 256
 };
 
 /**
@@ -222,6 +234,88 @@ struct m0_fab__bufht {
 	struct m0_htable bht_hash;
 };
 
+/**
+ * Key of a cached memory registration: a registration is reused only for the
+ * same memory range in the same fabric domain.
+ */
+struct m0_fab__mr_key {
+	/** Start of the registered range */
+	void              *mk_addr;
+
+	/** Length of the registered range */
+	m0_bcount_t        mk_len;
+
+	/** Fabric domain of the registration */
+	struct fid_domain *mk_dom;
+};
+
+/**
+ * Cached memory registration of a buffer segment
+ */
+struct m0_fab__mr_ent {
+	/** Key of the registration */
+	struct m0_fab__mr_key me_key;
+
+	/** Memory region registration */
+	struct fid_mr        *me_mr;
+
+	/** Local memory region descriptor */
+	void                 *me_desc;
+
+	/** Number of buffer segments using the registration */
+	uint32_t              me_ref;
+
+	/**
+	 * The range was invalidated while in use, the registration is closed
+	 * when the last user releases it.
+	 */
+	bool                  me_stale;
+
+	/** Link into m0_fab__mr_cache::mc_hash */
+	struct m0_hlink       me_htlink;
+
+	/** Magic number for the hash table */
+	uint64_t              me_htmagic;
+
+	/** Link into m0_fab__mr_cache::mc_lru */
+	struct m0_tlink       me_lru;
+
+	/** Magic number for the lru list */
+	uint64_t              me_lrumagic;
+};
+
+/**
+ * Cache of memory registrations of a network domain.
+ *
+ * Registrations which are not used by any buffer are kept on an lru list and
+ * closed when the list grows over mc_max entries.
+ */
+struct m0_fab__mr_cache {
+	/** Protects the cache, shared by all transfer machines of a domain */
+	struct m0_mutex  mc_lock;
+
+	/** Registrations hashed by m0_fab__mr_key */
+	struct m0_htable mc_hash;
+
+	/** Unused registrations, least recently used first */
+	struct m0_tl     mc_lru;
+
+	/** Length of mc_lru */
+	uint32_t         mc_lru_nr;
+
+	/** Max number of unused registrations kept, 0 disables the cache */
+	uint32_t         mc_max;
+
+	/** Lookups which found a registration */
+	uint64_t         mc_hit;
+
+	/** Lookups which registered the range */
+	uint64_t         mc_miss;
+
+	/** Unused registrations closed to keep mc_lru short */
+	uint64_t         mc_evict;
+};
+
 /**
  * Libfab structure equivalent for network domain
  */
@@ -244,6 +338,15 @@ struct m0_fab__ndom {
 
 	/** Segments size */
 	uint32_t              fnd_seg_size;
+
+	/** Cache of memory registrations of the domain */
+	struct m0_fab__mr_cache fnd_mr_cache;
+
+	/** Max length of passive bulk send data carried in the descriptor */
+	uint32_t              fnd_inline_max;
+
+	/** Whether transfer machines use shm for same-host bulk transfers */
+	bool                  fnd_shm;
 };
 
 /**
@@ -384,6 +487,21 @@ struct m0_fab__ep {
 
 	/** Flag to denote that the connection link status */
 	uint8_t                    fep_connlink;
+
+	/** Linkage in m0_fab__tm::ftm_ephash, keyed by fep_name */
+	struct m0_hlink            fep_htlink;
+
+	/** Magic number for the endpoint hash */
+	uint64_t                   fep_htmagic;
+
+	/**
+	 * Address of the shm endpoint of the peer in m0_fab__shm::fsh_av,
+	 * valid if fep_shm_name is not empty.
+	 */
+	fi_addr_t                  fep_shm_addr;
+
+	/** Name of the shm endpoint of the peer inserted as fep_shm_addr */
+	char                       fep_shm_name[FAB_SHM_NAME_MAX];
 };
 
 /**
@@ -413,6 +531,36 @@ struct m0_fab__tm_fids {
 	volatile uint32_t       ftf_cnt;
 };
 
+/**
+ * Resources of the shm (shared memory) provider of a transfer machine, used
+ * for bulk transfers with peers on the same host, see libfab_shm_init().
+ */
+struct m0_fab__shm {
+	/** Fabric and domain of shm, NULL if shm is not used by the tm */
+	struct m0_fab__fab   *fsh_fab;
+
+	/** Address vector of the shm endpoints of the peers */
+	struct fid_av        *fsh_av;
+
+	/** Reliable datagram endpoint */
+	struct fid_ep        *fsh_ep;
+
+	/** Completion queue of fsh_ep for both directions */
+	struct fid_cq        *fsh_cq;
+
+	/** Completion queue context to be returned in the epoll_wait event */
+	struct m0_fab__ev_ctx fsh_cq_ctx;
+
+	/** Name of fsh_ep, copied into buffer descriptors */
+	char                  fsh_name[FAB_SHM_NAME_MAX];
+
+	/** Max iov limit of fsh_ep */
+	uint32_t              fsh_max_iov;
+
+	/** Whether remote addresses are virtual addresses (FI_MR_VIRT_ADDR) */
+	bool                  fsh_virt_addr;
+};
+
 /**
  * Libfab structure of transfer machine
  */
@@ -433,6 +581,9 @@ struct m0_fab__tm {
 	 *
 	 */
 	struct m0_thread                ftm_poller;
+
+	/** Processors to confine the poller to, see libfab_ma_confine() */
+	struct m0_bitmap                ftm_processors;
 	
 	/** Epoll file descriptor */
 	int                             ftm_epfd;
@@ -482,6 +633,12 @@ struct m0_fab__tm {
 	/** Hash table of buffers associated to the tm */
 	struct m0_fab__bufht            ftm_bufhash;
 
+	/**
+	 * Hash of the endpoints of ntm_end_points keyed by their numeric
+	 * address, see libfab_ep_find_by_num()
+	 */
+	struct m0_htable                ftm_ephash;
+
 	/** Memory registration key index */
 	uint64_t                        ftm_mr_key_idx;
 
@@ -490,6 +647,9 @@ struct m0_fab__tm {
 
 	/** Buffer operation id for the transfer machine */
 	uint32_t                        ftm_op_id;
+
+	/** Shm resources for bulk transfers with same-host peers */
+	struct m0_fab__shm              ftm_shm;
 };
 
 /**
@@ -501,6 +661,9 @@ struct m0_fab__buf_mr {
 	
 	/** Memory region registration */
 	struct fid_mr **bm_mr;
+
+	/** Cache entries of the registrations */
+	struct m0_fab__mr_ent **bm_ent;
 };
 
 /**
@@ -516,6 +679,21 @@ struct m0_fab__bdesc {
 
 	/** Remote buffer token */
 	uint32_t                fbd_buftoken;
+
+	/**
+	 * Length of the buffer data carried at the end of the descriptor, 0 if
+	 * the data has to be read with RDMA.
+	 */
+	uint32_t                fbd_inline_len;
+
+	/**
+	 * Length of the name of the shm endpoint of the remote tm including the
+	 * terminating nul, 0 if the buffer is not offered through shm.
+	 * Otherwise the iov array of the shm registrations (fbd_iov_cnt
+	 * entries) and the name (FAB_SHM_NAME_MAX bytes) sit between the iov
+	 * array and the inline data.
+	 */
+	uint32_t                fbd_shm_len;
 };
 
 /**
@@ -565,6 +743,15 @@ struct m0_fab__buf {
 	
 	/** Domain to which the buffer is registered */
 	struct fid_domain               *fb_dp;
+
+	/** Registrations in the shm domain of the tm, see m0_fab__shm */
+	struct m0_fab__buf_mr            fb_shm_mr;
+
+	/** Array of iov of the shm registrations of the remote buffer */
+	struct fi_rma_iov               *fb_shm_riov;
+
+	/** Whether the bulk transfer of the (active) buffer uses shm */
+	bool                             fb_shm;
 	
 	/** Pointer network buffer structure */
 	struct m0_net_buffer            *fb_nb;
@@ -417,7 +417,9 @@
       circular queue.
    -# It releases the nlx_kcore_transfer_mc::ktm_bevq_lock spin lock.
    -# It signals the nlx_kcore_transfer_mc::ktm_sem semaphore with the
-      m0_semaphore_up() subroutine.
+      m0_semaphore_up() subroutine.  The wait queue that replaced the semaphore
+      is only woken up if there is a waiter, so a consumer busy with a batch of
+      events is not woken up for each new event.
 
    The (single) transport layer event handler thread blocks on the Core
    transfer machine semaphore in the Core API nlx_core_buf_event_wait()
@@ -1114,7 +1116,15 @@ static void nlx_kcore_eq_cb(lnet_event_t *event)
 	nlx_kcore_core_tm_unmap_atomic(ctm);
 	spin_unlock(&ktm->ktm_bevq_lock);
 
-	wake_up(&ktm->ktm_wq);
+	/*
+	 * The consumer drains all the events queued before it blocks again,
+	 * so only a sleeping consumer has to be woken up: under load events
+	 * are coalesced into batches without a wake up each. The barrier
+	 * pairs with the one in prepare_to_wait() of the waiter.
+	 */
+	smp_mb();
+	if (waitqueue_active(&ktm->ktm_wq))
+		wake_up(&ktm->ktm_wq);
 }
 
 /**
@@ -346,6 +346,9 @@
    The user space core nlx_core_buf_event_wait() subroutine completes the
    following tasks to wait for buffer events.
 
+   - It returns immediately if the shared buffer event queue is not empty,
+     so that events produced while the previous batch was being delivered are
+     consumed without a transition to the kernel.
    - It declares a @c m0_lnet_dev_buf_event_wait_params and sets the fields.
    - It performs a @c #M0_LNET_BUF_EVENT_WAIT ioctl request to wait for
      the kernel to generate additional buffer events.
@@ -975,6 +978,9 @@ int nlx_core_buf_event_wait(struct nlx_core_domain *cd,
 	utm = ctm->ctm_upvt;
 	M0_PRE(nlx_ucore_tm_invariant(utm));
 
+	/* The queue is shared with the kernel producer, no ioctl is needed. */
+	if (!bev_cqueue_is_empty(&ctm->ctm_bevq))
+		return 0;
 	bewp.dbw_ktm = ctm->ctm_kpvt;
 	bewp.dbw_timeout = m0_time_to_realtime(timeout);
 	do {
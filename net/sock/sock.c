@@ -151,7 +151,8 @@
  * A reader is associated with every socket (sock::s_reader). It reads incoming
  * packets and copies them to the appropriate buffers. This reader is
  * initialised and finalised together with the socket (sock_init(),
- * sock_fini()).
+ * sock_fini()). Packet payload is read directly into the segments of the
+ * network buffer, only the header goes through mover::m_pkbuf.
  *
  * A writer is associated with every M0_NET_QT_MSG_SEND and every
  * M0_NET_QT_ACTIVE_BULK_SEND buffer (buf::b_writer). This writer is initialised
@@ -168,6 +169,18 @@
  * impossible to parse packets at the other end). While locked, the writer
  * mover::m_sock points to the socket (see sock_writer()).
  *
+ * On stream sockets, payloads larger than sock_zerocopy_min are sent with
+ * MSG_ZEROCOPY (pk_zc_send()). The kernel then reads the buffer memory after
+ * sendmsg(2) returns, so a buffer whose writer is done is not completed until
+ * the socket error queue reports completion of its last zero-copy send
+ * (sock_zc_reap()). Meanwhile the buffer waits on sock::s_zc.
+ *
+ * When multiple writers have packets ready for the same socket, the packets
+ * are written by a single system call (sock_out_batch()): writev(2) for a
+ * stream socket, sendmmsg(2) with a datagram per packet for a datagram
+ * socket. The writers are then advanced as if each had done its own io. At
+ * most sock_batch_max packets and BATCH_IOV_NR segments are written at once.
+ *
  * An address uniquely identifies an end-point in the network. An end-point
  * embeds its address (ep::e_a). An address has address family independent part
  * (address family, socket type, protocol and port, all in processor byte order)
@@ -225,7 +238,10 @@
  * The starting point of asynchronous activity associated with a sock transfer
  * machine is poller(). Currently, this function is ran as a separate thread,
  * but it can easily be adapted to be executed as a chore
- * (m0_locality_chore_init()) within a locality.
+ * (m0_locality_chore_init()) within a locality. A transfer machine can have
+ * multiple poller threads (m0_net_sock_pollers_set()), each with its own epoll
+ * instance. End-points are assigned to the pollers round-robin when created
+ * and all sockets of an end-point are monitored by its poller.
  *
  * poller() gets from epoll_wait(2) a list of readable and writable sockets and
  * calls sock_event(), which is socket state machine transition
@@ -340,7 +356,10 @@
  *       to an invalid memory region. To deal with this, a sock is not freed
  *       immediately. Instead it is moved to S_DELETED state and placed on a
  *       special per-tm list: ma::t_deathrow. Actual freeing is done by
- *       ma_prune() called from poller();
+ *       ma_prune() called from poller(). With multiple pollers, the lock is
+ *       released by completion call-backs invoked while a poller processes
+ *       its events, so the sockets are freed only when no poller is in the
+ *       middle of its event list (ma::t_active);
  *
  *     - buffer completion (buf_done()) includes removing the buffer from its
  *       queue and invoking a user-supplied call-back
@@ -608,9 +627,11 @@
 
 #include <sys/types.h>
 #include <sys/uio.h>
+#include <limits.h>                        /* IOV_MAX */
 #include <sys/socket.h>                    /* epoll_create */
 #include <netinet/in.h>                    /* INET_ADDRSTRLEN */
 #include <netinet/ip.h>
+#include <linux/errqueue.h>                /* sock_extended_err */
 #include <arpa/inet.h>                     /* inet_pton, htons */
 #include <string.h>                        /* strchr */
 #include <unistd.h>                        /* close */
@@ -627,6 +648,8 @@
 #include "lib/memory.h"
 #include "lib/cookie.h"
 #include "lib/bitmap.h"
+#include "lib/hash.h"                      /* m0_htable */
+#include "lib/hash_fnc.h"                  /* m0_hash_fnc_fnv1 */
 #include "lib/refs.h"
 #include "lib/time.h"
 #include "sm/sm.h"
@@ -653,6 +676,7 @@ struct addr;
 struct ep;
 struct buf;
 struct ma;
+struct poller;
 struct bdesc;
 struct packet;
 
@@ -710,7 +734,9 @@ enum sock_flags {
 	/** Non blocking write is possible on the sock. */
 	HAS_WRITE  = M0_BITS(M_WRITE),
 	/** Non-blocking writes are monitored for this sock by epoll(2). */
-	WRITE_POLL = M0_BITS(M_NR + 1)
+	WRITE_POLL = M0_BITS(M_NR + 1),
+	/** Large payloads are sent with MSG_ZEROCOPY, see pk_io(). */
+	ZEROCOPY   = M0_BITS(M_NR + 2)
 };
 
 /**
@@ -760,6 +786,11 @@ struct ep {
 	struct m0_tl            e_sock;
 	/** Writers sending data to this end-point. */
 	struct m0_tl            e_writer;
+	/** Index of the poller monitoring the sockets of this end-point. */
+	uint32_t                e_poller;
+	/** Linkage in ma::t_ephash. */
+	struct m0_hlink         e_hlink;
+	uint64_t                e_magix;
 #ifdef EP_DEBUG
 	int e_r_mover;
 	int e_r_sock;
@@ -768,36 +799,92 @@ struct ep {
 #endif
 };
 
+enum {
+	/** Maximal number of poller threads of a transfer machine. */
+	MA_POLLER_MAX = 16,
+	/** Number of buckets of ma::t_ephash. */
+	MA_EP_BUCKET_NR = 1024
+};
+
+/** Number of pollers of new transfer machines. */
+static uint32_t sock_pollers_nr = 1;
+
+/**
+ * Payloads of at least this many bytes are sent with MSG_ZEROCOPY, 0 disables
+ * zero-copy sends.
+ */
+static m0_bcount_t sock_zerocopy_min = 64 * 1024;
+
+/**
+ * Maximal number of packets written to a socket by a single system call, 1
+ * disables batching, see sock_out_batch().
+ */
+static uint32_t sock_batch_max = 16;
+
+enum {
+	/** Maximal number of segments of a batched write. */
+	BATCH_IOV_NR = 256,
+	/** Maximal number of packets of a batched write. */
+	BATCH_PK_NR  = 64
+};
+M0_BASSERT(BATCH_IOV_NR <= IOV_MAX);
+
+/**
+ * Poller thread.
+ *
+ * All asynchronous activity happens in the poller threads:
+ *
+ *     - notifications about incoming connections;
+ *
+ *     - notifications about possibility of non-blocking socket io;
+ *
+ *     - buffer completion events (ma_buf_done());
+ *
+ *     - buffer timeouts (ma_buf_timeout());
+ *
+ *     - freeing socket structures (ma_prune()).
+ *
+ * A transfer machine has ma::t_poller_nr pollers. Each poller has its own
+ * epoll(2) instance and monitors the sockets of the end-points assigned to it
+ * (ep::e_poller). Pollers process events under the tm lock, but the lock is
+ * released while completion call-backs are invoked, so that call-backs of
+ * different pollers run concurrently.
+ *
+ * Poller can easily be adapter to be a "chore" in a locality.
+ */
+struct poller {
+	struct ma       *p_ma;
+	struct m0_thread p_thread;
+	/** epoll(2) instance file descriptor. */
+	int              p_epollfd;
+};
+
 /** A network transfer machine */
 struct ma {
 	/** Generic transfer machine with buffer queues, etc. */
 	struct m0_net_transfer_mc *t_ma;
+	/** Poller threads, t_poller[0] also handles timeouts. */
+	struct poller              t_poller[MA_POLLER_MAX];
+	/** Number of pollers, set from sock_pollers_nr when ma is created. */
+	uint32_t                   t_poller_nr;
+	/** Poller to assign to the next created end-point. */
+	uint32_t                   t_poller_next;
 	/**
-	 * Poller thread.
-	 *
-	 * All asynchronous activity happens in this thread:
-	 *
-	 *     - notifications about incoming connections;
-	 *
-	 *     - notifications about possibility of non-blocking socket io;
-	 *
-	 *     - buffer completion events (ma_buf_done());
-	 *
-	 *     - buffer timeouts (ma_buf_timeout());
-	 *
-	 *     - freeing socket structures (ma_prune());
-	 *
-	 * Poller can easily be adapter to be a "chore" in a locality.
-	 *
+	 * Number of pollers processing their events. Sockets are not freed
+	 * while this is positive, see ma_prune().
 	 */
-	struct m0_thread           t_poller;
-	/** epoll(2) instance file descriptor. */
-	int                        t_epollfd;
+	uint32_t                   t_active;
 	bool                       t_shutdown;
 	/** List of finalised sock structures. */
 	struct m0_tl               t_deathrow;
 	/** List of completed buffers. */
 	struct m0_tl               t_done;
+	/**
+	 * End-points of the transfer machine, keyed by ep::e_a. End-points are
+	 * also on m0_net_transfer_mc::ntm_end_points, the hash makes lookups
+	 * of a peer (ep_create()) independent of the number of peers.
+	 */
+	struct m0_htable           t_ephash;
 };
 
 /**
@@ -907,6 +994,13 @@ struct buf {
 	 * packet::p_totalsize.
 	 */
 	m0_bindex_t           b_length;
+	/**
+	 * The socket through which the payload was sent with MSG_ZEROCOPY, or
+	 * NULL. The kernel can read the buffer memory until the socket reports
+	 * completion of the send with sequence number b_zc_seq.
+	 */
+	struct sock          *b_zc_sock;
+	uint32_t              b_zc_seq;
 };
 
 /** A socket: connection to an end-point. */
@@ -925,6 +1019,12 @@ struct sock {
 	struct m0_tlink s_linkage;
 	/** Not currently used. Will be used to garbage collect idle sockets. */
 	m0_time_t       s_last;
+	/** Sequence number of the next MSG_ZEROCOPY send. */
+	uint32_t        s_zc_next;
+	/** Sends with sequence numbers before this one are complete. */
+	uint32_t        s_zc_done;
+	/** Completed buffers waiting for their zero-copy sends to complete. */
+	struct m0_tl    s_zc;
 };
 
 /**
@@ -1005,6 +1105,14 @@ M0_TL_DESCR_DEFINE(b, "buffers",
 		   M0_NET_SOCK_BUF_MAGIC, M0_NET_SOCK_BUF_HEAD_MAGIC);
 M0_TL_DEFINE(b, static, struct buf);
 
+static uint64_t ep_hash(const struct m0_htable *ht, const void *key);
+static bool     ep_key_eq(const void *key0, const void *key1);
+
+M0_HT_DESCR_DEFINE(ep, "end-points", static, struct ep,
+		   e_hlink, e_magix, M0_NET_SOCK_EP_MAGIC,
+		   M0_NET_SOCK_EP_HEAD_MAGIC, e_a, ep_hash, ep_key_eq);
+M0_HT_DEFINE(ep, static, struct ep, struct addr);
+
 static int  dom_init(const struct m0_net_xprt *xprt, struct m0_net_domain *dom);
 static void dom_fini(struct m0_net_domain *dom);
 static int  ma_init(struct m0_net_transfer_mc *ma);
@@ -1028,10 +1136,11 @@ static m0_bcount_t get_max_buffer_segment_size(const struct m0_net_domain *);
 static int32_t get_max_buffer_segments(const struct m0_net_domain *dom);
 static m0_bcount_t get_max_buffer_desc_size(const struct m0_net_domain *);
 
-static void poller   (struct ma *ma);
+static void poller   (struct poller *p);
 static void ma__fini (struct ma *ma);
 static void ma_prune (struct ma *ma);
 static void ma_lock  (struct ma *ma);
+static bool ma_is_poller(const struct ma *ma);
 static void ma_unlock(struct ma *ma);
 static bool ma_is_locked(const struct ma *ma);
 static bool ma_invariant(const struct ma *ma);
@@ -1069,6 +1178,7 @@ static bool  addr_eq          (const struct addr *a0, const struct addr *a1);
 
 static int  sock_in(struct sock *s);
 static void sock_out(struct sock *s);
+static int  sock_out_batch(struct sock *s);
 static void sock_close(struct sock *s);
 static void sock_done(struct sock *s, bool balance);
 static void sock_fini(struct sock *s);
@@ -1078,6 +1188,10 @@ static int  sock_init_fd(int fd, struct sock *s, struct ep *ep, uint32_t flags);
 static int  sock_init(int fd, struct ep *src, struct ep *tgt, uint32_t flags);
 static struct mover *sock_writer(struct sock *s);
 static bool sock_invariant(const struct sock *s);
+static void sock_zc_init(struct sock *s);
+static bool sock_zc_reap(struct sock *s);
+static void sock_zc_done(struct sock *s);
+static bool buf_zc_busy(const struct buf *buf);
 
 static struct ma *buf_ma(struct buf *buf);
 static bool buf_invariant(const struct buf *buf);
@@ -1107,6 +1221,9 @@ static int pk_io(struct mover *w, struct sock *s,
 		 uint64_t flag, struct m0_bufvec *bv, m0_bcount_t size);
 static int pk_iov_prep(struct mover *m, struct iovec *iv, int nr,
 		       struct m0_bufvec *bv, m0_bcount_t size, int *count);
+static bool pk_zc(const struct mover *m, const struct sock *s, uint64_t flag);
+static int  pk_zc_send(struct mover *m, struct sock *s,
+		       struct iovec *iv, int *nr, int *count);
 static void pk_header_init(struct mover *m, struct sock *s);
 static int  pk_header_done(struct mover *m);
 static void pk_done  (struct mover *m);
@@ -1223,17 +1340,23 @@ static bool ma_invariant(const struct ma *ma)
 		m0_net__tm_invariant(net) &&
 		s_tlist_invariant(&ma->t_deathrow) &&
 		/* ma is either fully uninitialised or fully initialised. */
-		_0C((ma->t_poller.t_func == NULL && ma->t_epollfd == -1 &&
+		_0C(ma->t_poller_nr > 0 && ma->t_poller_nr <= MA_POLLER_MAX) &&
+		_0C(m0_forall(i, ma->t_poller_nr,
+			      ma->t_poller[i].p_ma == ma)) &&
+		_0C((ma->t_poller[0].p_thread.t_func == NULL &&
+		     ma->t_poller[0].p_epollfd == -1 &&
 		     m0_nep_tlist_is_empty(eps) &&
 		     s_tlist_is_empty(&ma->t_deathrow)) ||
-		    (ma->t_poller.t_func != NULL && ma->t_epollfd >= 0 &&
+		    (ma->t_poller[0].p_thread.t_func != NULL &&
+		     m0_forall(i, ma->t_poller_nr,
+			       ma->t_poller[i].p_epollfd >= 0) &&
 		     m0_tl_exists(m0_nep, nep, eps,
 				  m0_tl_exists(s, s, &ep_net(nep)->e_sock,
 					  s->s_sm.sm_state == S_LISTENING))) ||
 		    ma->t_shutdown) &&
 		/* In STARTED state ma is fully initialised. */
 		_0C(ergo(net->ntm_state == M0_NET_TM_STARTED,
-			 ma->t_epollfd >= 0)) &&
+			 ma->t_poller[0].p_epollfd >= 0)) &&
 		_0C(m0_tl_forall(s, s, &ma->t_deathrow, sock_invariant(s))) &&
 		/* Endpoints are unique. */
 		_0C(m0_tl_forall(m0_nep, p, eps,
@@ -1290,6 +1413,7 @@ static bool ep_invariant(const struct ep *ep)
 		m0_net__ep_invariant((void *)&ep->e_ep,
 				     (void *)ma->t_ma, true) &&
 		_0C(ep->e_ep.nep_addr != NULL) &&
+		_0C(ep->e_poller < ma->t_poller_nr) &&
 #ifdef EP_DEBUG
 		/*
 		 * Reference counters consistency:
@@ -1357,10 +1481,12 @@ static bool ma_is_locked(const struct ma *ma)
 /**
  * Main loop of a per-ma thread that polls sockets.
  */
-static void poller(struct ma *ma)
+static void poller(struct poller *p)
 {
 	enum { EV_NR = 256 };
+	struct ma         *ma = p->p_ma;
 	struct epoll_event ev[EV_NR] = {};
+	bool               first = p == &ma->t_poller[0];
 	int                nr;
 	int                i;
 	/*
@@ -1378,11 +1504,12 @@ static void poller(struct ma *ma)
 	 *
 	 * Because of this, we do not assert ma states here.
 	 */
-	ma_event_post(ma, M0_NET_TM_STARTED);
+	if (first)
+		ma_event_post(ma, M0_NET_TM_STARTED);
 	while (1) {
 		if (ma->t_shutdown)
 			break;
-		nr = epoll_wait(ma->t_epollfd, ev, ARRAY_SIZE(ev), 1000);
+		nr = epoll_wait(p->p_epollfd, ev, ARRAY_SIZE(ev), 1000);
 		if (nr == -1) {
 			M0_LOG(M0_DEBUG, "epoll: %i.", -errno);
 			M0_ASSERT(errno == EINTR);
@@ -1394,6 +1521,12 @@ static void poller(struct ma *ma)
 		M0_LOG(M0_DEBUG, "Got: %d.", nr);
 		ma_lock(ma);
 		M0_ASSERT(ma_is_locked(ma) && ma_invariant(ma));
+		/*
+		 * Completion call-backs invoked from sock_event() release the
+		 * lock. Prevent other pollers from freeing the sockets in ev[]
+		 * in the meantime.
+		 */
+		M0_CNT_INC(ma->t_active);
 		for (i = 0; i < nr; ++i) {
 			struct sock *s = ev[i].data.ptr;
 
@@ -1408,7 +1541,9 @@ static void poller(struct ma *ma)
 				break;
 		}
 		/* @todo close long-unused sockets. */
-		ma_buf_timeout(ma);
+		if (first)
+			ma_buf_timeout(ma);
+		M0_CNT_DEC(ma->t_active);
 		/*
 		 * Deliver buffer completion events and re-provision receive
 		 * queue if necessary.
@@ -1417,14 +1552,23 @@ static void poller(struct ma *ma)
 		M0_ASSERT(ma_invariant(ma));
 		/*
 		 * This is the only place, where sock structures are freed,
-		 * except for ma finalisation.
+		 * except for ma finalisation. The last poller to finish its
+		 * events frees them.
 		 */
-		ma_prune(ma);
+		if (ma->t_active == 0)
+			ma_prune(ma);
 		M0_ASSERT(ma_invariant(ma));
 		ma_unlock(ma);
 	}
 }
 
+/** Returns true iff the current thread is one of the pollers of the ma. */
+static bool ma_is_poller(const struct ma *ma)
+{
+	return m0_exists(i, ma->t_poller_nr,
+			 m0_thread_self() == &ma->t_poller[i].p_thread);
+}
+
 /**
  * Initialises transport-specific part of the transfer machine.
  *
@@ -1434,11 +1578,11 @@ static void poller(struct ma *ma)
  * address to bind, which is supplied as a parameter to
  * m0_net_xprt_ops::xo_tm_start(), is known.
  *
- * Poller thread (ma::t_poller) cannot be started, because a call to
+ * Poller threads (ma::t_poller[]) cannot be started, because a call to
  * m0_net_tm_confine() can be done after initialisation.
  *
- * ->epollfd can be initialised here, but it is easier to initialise everything
- * in ma_start().
+ * ->p_epollfd can be initialised here, but it is easier to initialise
+ * everything in ma_start().
  *
  * Used as m0_net_xprt_ops::xo_tm_init().
  */
@@ -1446,18 +1590,28 @@ static int ma_init(struct m0_net_transfer_mc *net)
 {
 	struct ma *ma;
 	int        result;
+	int        i;
 
 	M0_ASSERT(net->ntm_xprt_private == NULL);
 
 	M0_ALLOC_PTR(ma);
 	if (ma != NULL) {
-		ma->t_epollfd = -1;
+		ma->t_poller_nr = sock_pollers_nr;
+		for (i = 0; i < ma->t_poller_nr; ++i) {
+			ma->t_poller[i].p_ma = ma;
+			ma->t_poller[i].p_epollfd = -1;
+		}
 		ma->t_shutdown = false;
 		net->ntm_xprt_private = ma;
 		ma->t_ma = net;
-		s_tlist_init(&ma->t_deathrow);
-		b_tlist_init(&ma->t_done);
-		result = 0;
+		result = ep_htable_init(&ma->t_ephash, MA_EP_BUCKET_NR);
+		if (result == 0) {
+			s_tlist_init(&ma->t_deathrow);
+			b_tlist_init(&ma->t_done);
+		} else {
+			net->ntm_xprt_private = NULL;
+			m0_free(ma);
+		}
 	} else
 		result = M0_ERR(-ENOMEM);
 	return M0_RC(result);
@@ -1469,6 +1623,7 @@ static void ma_prune(struct ma *ma)
 	struct sock *sock;
 
 	M0_PRE(ma_is_locked(ma));
+	M0_PRE(ma->t_active == 0);
 	m0_tl_for(s, &ma->t_deathrow, sock) {
 		sock_fini(sock);
 	} m0_tl_endfor;
@@ -1484,18 +1639,23 @@ static void ma_prune(struct ma *ma)
 static void ma__fini(struct ma *ma)
 {
 	struct m0_net_end_point *net;
+	struct poller           *p;
+	int                      i;
 
 	M0_PRE(ma_is_locked(ma));
 	if (!ma->t_shutdown) {
 		/* Set the shutdown flag.
-		 * Release the lock and wait for poller(), so that the poller()
+		 * Release the lock and wait for pollers, so that each poller()
 		 * will get a chance to detect this flag and exit.
 		 */
 		ma->t_shutdown = true;
 		ma_unlock(ma);
-		if (ma->t_poller.t_func != NULL) {
-			m0_thread_join(&ma->t_poller);
-			m0_thread_fini(&ma->t_poller);
+		for (i = 0; i < ma->t_poller_nr; ++i) {
+			p = &ma->t_poller[i];
+			if (p->p_thread.t_func != NULL) {
+				m0_thread_join(&p->p_thread);
+				m0_thread_fini(&p->p_thread);
+			}
 		}
 		/* Go on finalizing the ma */
 		ma_lock(ma);
@@ -1510,9 +1670,12 @@ static void ma__fini(struct ma *ma)
 		 * Finalise epoll after sockets, because sock_done() removes the
 		 * socket from the poll set.
 		 */
-		if (ma->t_epollfd >= 0) {
-			close(ma->t_epollfd);
-			ma->t_epollfd = -1;
+		for (i = 0; i < ma->t_poller_nr; ++i) {
+			p = &ma->t_poller[i];
+			if (p->p_epollfd >= 0) {
+				close(p->p_epollfd);
+				p->p_epollfd = -1;
+			}
 		}
 		ma_buf_done(ma);
 		ma_prune(ma);
@@ -1535,6 +1698,7 @@ static void ma_fini(struct m0_net_transfer_mc *net)
 	M0_PRE(ma_is_locked(ma) && ma_invariant(ma));
 	ma__fini(ma);
 	ma_unlock(ma);
+	ep_htable_fini(&ma->t_ephash);
 	net->ntm_xprt_private = NULL;
 	m0_free(ma);
 }
@@ -1551,7 +1715,8 @@ static void ma_fini(struct m0_net_transfer_mc *net)
 static int ma_start(struct m0_net_transfer_mc *net, const char *name)
 {
 	struct ma *ma = net->ntm_xprt_private;
-	int        result;
+	int        result = 0;
+	int        i;
 
 	M0_PRE(ma_is_locked(ma) && ma_invariant(ma));
 	M0_PRE(net->ntm_state == M0_NET_TM_STARTING);
@@ -1563,28 +1728,34 @@ static int ma_start(struct m0_net_transfer_mc *net, const char *name)
 	 *
 	 * - create the listening socket
 	 *
-	 * - start the poller thread.
+	 * - start the poller threads.
 	 *
 	 * Should be done in this order, because the poller thread uses the
 	 * listening socket to get the source endpoint to post a ma state change
 	 * event (outside of ma lock).
 	 */
-	ma->t_epollfd = epoll_create(1);
-	if (ma->t_epollfd >= 0) {
+	for (i = 0; i < ma->t_poller_nr && result == 0; ++i) {
+		ma->t_poller[i].p_epollfd = epoll_create(1);
+		if (ma->t_poller[i].p_epollfd < 0)
+			result = -errno;
+	}
+	if (result == 0) {
 		struct ep *ep;
 
 		result = ep_find(ma, name, &ep);
 		if (result == 0) {
 			result = sock_init(-1, ep, NULL, EPOLLET);
-			if (result == 0) {
-				result = M0_THREAD_INIT(&ma->t_poller,
-							struct ma *, NULL,
-							&poller, ma, "socktm");
+			for (i = 0; i < ma->t_poller_nr && result == 0; ++i) {
+				struct poller *p = &ma->t_poller[i];
+
+				result = M0_THREAD_INIT(&p->p_thread,
+							struct poller *, NULL,
+							&poller, p,
+							"socktm%i", i);
 			}
 			EP_PUT(ep, find);
 		}
-	} else
-		result = -errno;
+	}
 	if (result != 0)
 		ma__fini(ma);
 	M0_POST(ma_invariant(ma));
@@ -1686,11 +1857,14 @@ static void ma_buf_done(struct ma *ma)
 	int         nr = 0;
 
 	M0_PRE(ma_is_locked(ma) && ma_invariant(ma));
-	m0_tl_for(b, &ma->t_done, buf) {
-		b_tlist_del(buf);
+	/*
+	 * buf_complete() releases the lock and another poller can take buffers
+	 * off the list meanwhile, so do not keep a cursor across the call.
+	 */
+	while ((buf = b_tlist_pop(&ma->t_done)) != NULL) {
 		buf_complete(buf);
 		nr++;
-	} m0_tl_endfor;
+	}
 	if (nr > 0 && ma->t_ma->ntm_callback_counter == 0)
 		m0_chan_broadcast(&ma->t_ma->ntm_chan);
 	M0_POST(ma_invariant(ma));
@@ -1979,12 +2153,155 @@ static void sock_out(struct sock *s)
 	 */
 	while ((s->s_flags & HAS_WRITE) &&
 	       (w = m_tlist_head(&s->s_ep->e_writer)) != NULL) {
+		if (sock_out_batch(s) > 0)
+			continue;
 		state = mover_op(w, s, M_WRITE);
 		if (state != R_DONE && w->m_sock != s)
 			m_tlist_move_tail(&s->s_ep->e_writer, w);
 	}
 }
 
+/** A packet of a batched write. */
+struct batch_pk {
+	struct mover *bp_w;
+	/** Index of the first segment of the packet in the batch iovec. */
+	int           bp_idx;
+	/** Number of segments of the packet. */
+	int           bp_nr;
+	/** Number of bytes of the packet in the batch. */
+	int           bp_count;
+};
+
+/**
+ * Writes packets of multiple writers to the socket by a single system call.
+ *
+ * The packet locked to the socket (if any) and the next packets of the
+ * following writers of the end-point are written together. Afterwards each
+ * writer is moved to the state it would have reached writing its own packet:
+ * completely written packets are completed, the partially written packet
+ * (there is at most one, the last in the batch) is locked to the socket and
+ * moved to the head of ep::e_writer, the writers that were not reached stay
+ * in R_PK.
+ *
+ * Returns the number of packets in the batch or 0 if there is nothing to
+ * batch, in which case the caller writes through mover_op(). Errors other
+ * than EWOULDBLOCK and EINTR are left to that path too.
+ */
+static int sock_out_batch(struct sock *s)
+{
+	struct ep      *ep    = s->s_ep;
+	struct iovec    iv[BATCH_IOV_NR];
+	struct mmsghdr  msg[BATCH_PK_NR];
+	struct batch_pk pk[BATCH_PK_NR];
+	struct mover   *w     = m_tlist_head(&ep->e_writer);
+	bool            dgram = ep->e_a.a_socktype == SOCK_DGRAM;
+	int             max   = min32u(sock_batch_max, BATCH_PK_NR);
+	int             idx   = 0;
+	int             nr    = 0;
+	int             total = 0;
+	m0_bcount_t     nob;
+	m0_bcount_t     share;
+	int             state;
+	int             rc;
+	int             i;
+
+	M0_PRE(s->s_flags & HAS_WRITE);
+	for (; w != NULL && nr < max && idx < BATCH_IOV_NR;
+	     w = m_tlist_next(&ep->e_writer, w)) {
+		struct batch_pk *p = &pk[nr];
+
+		if (w->m_sock == s) {
+			/* Only the head can be locked, see ep_invariant(). */
+			M0_ASSERT(nr == 0);
+			if (!M0_IN(w->m_sm.sm_state, (R_HEADER, R_INTERVAL)))
+				break;
+		} else if (w->m_op == &writer_op && w->m_sock == NULL &&
+			   M0_IN(w->m_sm.sm_state, (R_IDLE, R_PK))) {
+			/*
+			 * Prepare the next packet. writer_pk() is repeated
+			 * when the packet is not reached by the write.
+			 */
+			if (w->m_sm.sm_state == R_IDLE)
+				m0_sm_state_set(&w->m_sm, writer_idle(w, s));
+			(void)writer_pk(w, s);
+			w->m_sock = NULL;
+		} else
+			break;
+		if (pk_zc(w, s, HAS_WRITE))
+			break;
+		p->bp_w   = w;
+		p->bp_idx = idx;
+		p->bp_nr  = pk_iov_prep(w, &iv[idx], BATCH_IOV_NR - idx,
+					w->m_buf != NULL ?
+					&w->m_buf->b_buf->nb_buffer : NULL,
+					pk_tsize(w), &p->bp_count);
+		if (w->m_nob + p->bp_count < pk_tsize(w)) {
+			/* Out of segments: a datagram cannot be split. */
+			if (!dgram) {
+				total += p->bp_count;
+				++nr;
+			}
+			break;
+		}
+		idx   += p->bp_nr;
+		total += p->bp_count;
+		++nr;
+	}
+	if (nr < 2)
+		return 0;
+	if (dgram) {
+		for (i = 0; i < nr; ++i)
+			msg[i] = (struct mmsghdr) {
+				.msg_hdr = {
+					.msg_iov    = &iv[pk[i].bp_idx],
+					.msg_iovlen = pk[i].bp_nr
+				}
+			};
+		rc = sendmmsg(s->s_fd, msg, nr, 0);
+	} else
+		rc = writev(s->s_fd, iv, pk[nr - 1].bp_idx + pk[nr - 1].bp_nr);
+	M0_LOG(M0_DEBUG, "nr: %i, total: %i, rc: %i, errno: %i.",
+	       nr, total, rc, errno);
+	if (rc < 0) {
+		if (errno == EWOULDBLOCK)
+			s->s_flags &= ~HAS_WRITE;
+		return M0_IN(errno, (EWOULDBLOCK, EINTR)) ? nr : 0;
+	}
+	if (rc < (dgram ? nr : total))
+		s->s_flags &= ~HAS_WRITE;
+	for (i = 0, nob = rc; i < nr; ++i) {
+		w = pk[i].bp_w;
+		share = dgram ? (i < rc ? pk[i].bp_count : 0) :
+			min64u(nob, pk[i].bp_count);
+		if (share == 0 && w->m_sock != s)
+			break; /* Not reached, stays in R_PK. */
+		if (w->m_sock != s)
+			m0_sm_state_set(&w->m_sm, R_HEADER);
+		if (!dgram)
+			nob -= share;
+		w->m_nob += share;
+		state = pk_state(w);
+		m0_sm_state_set(&w->m_sm, state);
+		if (state == R_PK_DONE)
+			w->m_sock = NULL;
+		else {
+			w->m_sock = s;
+			m_tlist_move(&ep->e_writer, w);
+		}
+	}
+	nr = i;
+	for (i = 0; i < nr; ++i) {
+		w = pk[i].bp_w;
+		if (w->m_sm.sm_state != R_PK_DONE)
+			continue;
+		state = w->m_op->v_op[R_PK_DONE][M_WRITE].o_op(w, s);
+		m0_sm_state_set(&w->m_sm, state);
+		if (state == R_DONE)
+			w->m_op->v_done(w, s);
+	}
+	return nr;
+}
+
 /** Processes an "error" event for a socket. */
 static void sock_close(struct sock *s)
 {
@@ -2022,6 +2339,7 @@ static void sock_fini(struct sock *s)
 	TLOG(SOCK_F, SOCK_P(s));
 	EP_PUT(s->s_ep, sock);
 	s->s_ep = NULL;
+	b_tlist_fini(&s->s_zc);
 	m0_sm_fini(&s->s_sm);
 	s_tlink_del_fini(s);
 	m0_free(s);
@@ -2034,7 +2352,8 @@ static void sock_fini(struct sock *s)
  */
 static void sock_done(struct sock *s, bool balance)
 {
-	struct ma *ma = ep_ma(s->s_ep);
+	struct ma    *ma = ep_ma(s->s_ep);
+	struct mover *w;
 
 	M0_PRE(ma_is_locked(ma));
 	M0_PRE(s->s_ep != NULL);
@@ -2056,6 +2375,13 @@ static void sock_done(struct sock *s, bool balance)
 			close(s->s_fd);
 			s->s_fd = -1;
 		}
+		/* No more zero-copy completions will arrive. */
+		m0_tl_for(m, &s->s_ep->e_writer, w) {
+			if (w->m_buf != NULL && w->m_buf->b_zc_sock == s)
+				w->m_buf->b_zc_sock = NULL;
+		} m0_tl_endfor;
+		s->s_zc_done = s->s_zc_next;
+		sock_zc_done(s);
 		m0_sm_state_set(&s->s_sm, S_DELETED);
 		s_tlist_move(&ma->t_deathrow, s);
 		if (balance)
@@ -2098,10 +2424,13 @@ static int sock_init(int fd, struct ep *src, struct ep *tgt, uint32_t flags)
 	s->s_ep = ep;
 	EP_GET(ep, sock);
 	s_tlink_init_at(s, &ep->e_sock);
+	b_tlist_init(&s->s_zc);
 	m0_sm_init(&s->s_sm, &sock_conf, state, &ma->t_ma->ntm_group);
 	mover_init(&s->s_reader, ma, stype[ep->e_a.a_socktype].st_reader);
 	s->s_reader.m_sock = s;
 	result = sock_init_fd(fd, s, src, flags);
+	if (result == 0 && tgt != NULL && ep->e_a.a_socktype == SOCK_STREAM)
+		sock_zc_init(s);
 	if (result == 0) {
 		if (fd >= 0) {
 			state = S_OPEN;
@@ -2282,6 +2611,13 @@ static bool sock_event(struct sock *s, uint32_t ev)
 		}
 		break;
 	case S_OPEN:
+		/*
+		 * Zero-copy completions are reported through the error
+		 * queue, which makes the socket look as if it had an error.
+		 */
+		if ((ev & EPOLLERR) && s->s_zc_next != s->s_zc_done &&
+		    sock_zc_reap(s))
+			ev &= ~EPOLLERR;
 		if (ev & EPOLLIN) {
 			/* Ran out of buffer on the receive queue. */
 			if (sock_in(s) == -ENOBUFS)
@@ -2304,11 +2640,12 @@ static bool sock_event(struct sock *s, uint32_t ev)
  */
 static int sock_ctl(struct sock *s, int op, uint32_t flags)
 {
-	int result;
+	struct poller *p = &ep_ma(s->s_ep)->t_poller[s->s_ep->e_poller];
+	int            result;
 
 	/* Always monitor errors. */
 	flags |= EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP;
-	result = epoll_ctl(ep_ma(s->s_ep)->t_epollfd, op, s->s_fd,
+	result = epoll_ctl(p->p_epollfd, op, s->s_fd,
 			   &(struct epoll_event){
 				   .events = flags,
 				   .data   = { .ptr = s }});
@@ -2321,6 +2658,86 @@ static int sock_ctl(struct sock *s, int op, uint32_t flags)
 	return result;
 }
 
+/**
+ * Enables zero-copy sends on a stream socket.
+ *
+ * Failure is not an error: the socket then copies as usual.
+ */
+static void sock_zc_init(struct sock *s)
+{
+#ifdef SO_ZEROCOPY
+	int flag = true;
+
+	if (sock_zerocopy_min > 0 &&
+	    setsockopt(s->s_fd, SOL_SOCKET, SO_ZEROCOPY,
+		       &flag, sizeof flag) == 0)
+		s->s_flags |= ZEROCOPY;
+#endif
+}
+
+/**
+ * Reads zero-copy completions from the socket error queue.
+ *
+ * Returns true iff the error queue contained only zero-copy completions,
+ * that is, the socket has no real error.
+ */
+static bool sock_zc_reap(struct sock *s)
+{
+#ifdef SO_EE_ORIGIN_ZEROCOPY
+	struct sock_extended_err *ee;
+	struct cmsghdr           *cm;
+	struct msghdr             msg;
+	char                      control[128];
+	bool                      got = false;
+
+	while (1) {
+		msg = (struct msghdr) {
+			.msg_control    = control,
+			.msg_controllen = sizeof control
+		};
+		if (recvmsg(s->s_fd, &msg, MSG_ERRQUEUE) == -1)
+			break;
+		for (cm = CMSG_FIRSTHDR(&msg); cm != NULL;
+		     cm = CMSG_NXTHDR(&msg, cm)) {
+			ee = (void *)CMSG_DATA(cm);
+			if (ee->ee_origin != SO_EE_ORIGIN_ZEROCOPY ||
+			    ee->ee_errno != 0)
+				return false;
+			/* The kernel copied the data, stop paying for this. */
+			if (ee->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+				s->s_flags &= ~ZEROCOPY;
+			/* Sends [ee_info, ee_data] are complete. */
+			if ((int32_t)(ee->ee_data - s->s_zc_done) >= 0)
+				s->s_zc_done = ee->ee_data + 1;
+			got = true;
+		}
+	}
+	if (got)
+		sock_zc_done(s);
+	return got;
+#else
+	return false;
+#endif
+}
+
+/**
+ * Moves buffers, whose zero-copy sends completed, to ma::t_done, where
+ * ma_buf_done() completes them.
+ */
+static void sock_zc_done(struct sock *s)
+{
+	struct ma  *ma = ep_ma(s->s_ep);
+	struct buf *buf;
+
+	M0_PRE(ma_is_locked(ma));
+	m0_tl_for(b, &s->s_zc, buf) {
+		if (!buf_zc_busy(buf)) {
+			buf->b_zc_sock = NULL;
+			b_tlist_move_tail(&ma->t_done, buf);
+		}
+	} m0_tl_endfor;
+}
+
 /**
  * Returns the end-point with a given address.
  *
@@ -2338,18 +2755,13 @@ static int ep_create(struct ma *ma, struct addr *addr, const char *name,
 	char                    *cname;
 
 	M0_PRE(ma_is_locked(ma) && addr_invariant(addr));
-	/*
-	 * @todo this is duplicated in every transport. Should be factored out
-	 * by exporting ->xo_ep_eq() method.
-	 */
-	m0_tl_for(m0_nep, &ma->t_ma->ntm_end_points, net) {
-		struct ep *xep = ep_net(net);
-		if (ep_eq(xep, addr)) {
-			EP_GET(xep, find);
-			*out = xep;
-			return M0_RC(0);
-		}
-	} m0_tl_endfor;
+	ep = ep_htable_lookup(&ma->t_ephash, addr);
+	if (ep != NULL) {
+		M0_ASSERT(ep_eq(ep, addr));
+		EP_GET(ep, find);
+		*out = ep;
+		return M0_RC(0);
+	}
 	cname = name != NULL ? m0_strdup(name) : addr_print(addr);
 	M0_ALLOC_PTR(ep);
 	if (cname == NULL || ep == NULL) {
@@ -2366,8 +2778,12 @@ static int ep_create(struct ma *ma, struct addr *addr, const char *name,
 	m0_nep_tlink_init_at_tail(net, &ma->t_ma->ntm_end_points);
 	s_tlist_init(&ep->e_sock);
 	m_tlist_init(&ep->e_writer);
+	/* Shard end-points across pollers. */
+	ep->e_poller = ma->t_poller_next++ % ma->t_poller_nr;
 	net->nep_addr = cname;
 	ep->e_a = *addr;
+	m0_tlink_init(&ep_tl, ep);
+	ep_htable_add(&ma->t_ephash, ep);
 	*out = ep;
 	M0_POST(*out != NULL && ep_invariant(*out));
 	M0_POST(ma_is_locked(ma));
@@ -2492,6 +2908,8 @@ static int ep_balance(struct ep *ep)
 /** Finalises the end-point. */
 static void ep_free(struct ep *ep)
 {
+	ep_htable_del(&ep_ma(ep)->t_ephash, ep);
+	m0_tlink_fini(&ep_tl, ep);
 	m0_nep_tlist_del(&ep->e_ep);
 	m_tlist_fini(&ep->e_writer);
 	s_tlist_fini(&ep->e_sock);
@@ -2812,6 +3230,25 @@ static bool addr_eq(const struct addr *a0, const struct addr *a1)
 		       ARRAY_SIZE(a0->a_data.v_data)) == 0;
 }
 
+/** Hashes an end-point address, the key of ma::t_ephash. */
+static uint64_t ep_hash(const struct m0_htable *ht, const void *key)
+{
+	const struct addr *a = key;
+
+	return (m0_hash_fnc_fnv1(a->a_data.v_data,
+				 ARRAY_SIZE(a->a_data.v_data)) ^
+		m0_hash(((uint64_t)a->a_port << 32) | a->a_socktype)) %
+		ht->h_bucket_nr;
+}
+
+static bool ep_key_eq(const void *key0, const void *key1)
+{
+	const struct addr *a0 = key0;
+	const struct addr *a1 = key1;
+
+	return addr_eq(a0, a1) && a0->a_port == a1->a_port;
+}
+
 /** Returns true iff an end-point has a given addr. */
 static bool ep_eq(const struct ep *ep, const struct addr *a0)
 {
@@ -2894,6 +3331,7 @@ static void buf_fini(struct buf *buf)
 	buf->b_offset = 0;
 	buf->b_length = 0;
 	buf->b_writer.m_sm.sm_rc = 0;
+	buf->b_zc_sock = NULL;
 }
 
 /** Completes the buffer operation. */
@@ -2913,7 +3351,13 @@ static void buf_done(struct buf *buf, int rc)
 	 */
 	if (!b_tlink_is_in(buf)) {
 		/* Try to finalise. */
-		if (m0_thread_self() == &ma->t_poller)
+		if (buf_zc_busy(buf))
+			/*
+			 * The kernel can still read the buffer memory, wait
+			 * for the zero-copy completion, see sock_zc_done().
+			 */
+			b_tlist_add_tail(&buf->b_zc_sock->s_zc, buf);
+		else if (ma_is_poller(ma))
 			buf_complete(buf);
 		else
 			/* Otherwise, postpone finalisation to ma_buf_done(). */
@@ -2921,6 +3365,16 @@ static void buf_done(struct buf *buf, int rc)
 	}
 }
 
+/**
+ * Returns true iff the kernel can still read the buffer memory for a
+ * MSG_ZEROCOPY send.
+ */
+static bool buf_zc_busy(const struct buf *buf)
+{
+	return buf->b_zc_sock != NULL &&
+		(int32_t)(buf->b_zc_seq - buf->b_zc_sock->s_zc_done) >= 0;
+}
+
 /** Invokes completion call-back (releasing tm lock). */
 static void buf_complete(struct buf *buf)
 {
@@ -3212,6 +3666,54 @@ static int pk_iov_prep(struct mover *m, struct iovec *iv, int nr,
 	return idx;
 }
 
+/**
+ * Returns true iff the rest of the packet should be sent with MSG_ZEROCOPY.
+ *
+ * Only the payload of a data buffer is sent without copying: the header lives
+ * in mover::m_pkbuf, which is overwritten by the next packet.
+ */
+static bool pk_zc(const struct mover *m, const struct sock *s, uint64_t flag)
+{
+	return  flag == HAS_WRITE && (s->s_flags & ZEROCOPY) &&
+		sock_zerocopy_min > 0 && m->m_buf != NULL &&
+		mover_is_writer(m) &&
+		M0_IN(m->m_buf->b_zc_sock, (NULL, s)) &&
+		m->m_pk.p_size - pk_dnob(m) >= sock_zerocopy_min;
+}
+
+/**
+ * Sends a part of the packet prepared by pk_iov_prep() in zero-copy mode.
+ *
+ * The remaining header is sent (copied) first, with MSG_MORE. The payload is
+ * sent with MSG_ZEROCOPY by the next call and the buffer remembers the
+ * sequence number of the send, see buf_zc_busy().
+ */
+static int pk_zc_send(struct mover *m, struct sock *s,
+		      struct iovec *iv, int *nr, int *count)
+{
+	struct msghdr msg = { .msg_iov = iv, .msg_iovlen = *nr };
+
+	if (m->m_nob < sizeof m->m_pkbuf) {
+		msg.msg_iovlen = *nr = 1;
+		*count = iv[0].iov_len;
+		return sendmsg(s->s_fd, &msg, MSG_MORE);
+	}
+#ifdef MSG_ZEROCOPY
+	{
+		int rc = sendmsg(s->s_fd, &msg, MSG_ZEROCOPY);
+
+		if (rc >= 0) {
+			m->m_buf->b_zc_sock = s;
+			m->m_buf->b_zc_seq  = s->s_zc_next++;
+			return rc;
+		} else if (errno != ENOBUFS)
+			return rc;
+		/* Out of optmem for the notifications, copy this time. */
+	}
+#endif
+	return sendmsg(s->s_fd, &msg, 0);
+}
+
 /**
  * Does packet io.
  *
@@ -3226,13 +3728,17 @@ static int pk_io(struct mover *m, struct sock *s, uint64_t flag,
 	int          count;
 	int          nr;
 	int          rc;
+	bool         zc = pk_zc(m, s, flag);
 
 	M0_PRE(M0_IN(flag, (HAS_READ, HAS_WRITE)));
 	nr = pk_iov_prep(m, iv, ARRAY_SIZE(iv),
 			 bv ?: m->m_buf != NULL ?
 			 &m->m_buf->b_buf->nb_buffer : NULL, tgt, &count);
 	s->s_flags &= ~flag;
-	rc = (flag == HAS_READ ? readv : writev)(s->s_fd, iv, nr);
+	if (zc)
+		rc = pk_zc_send(m, s, iv, &nr, &count);
+	else
+		rc = (flag == HAS_READ ? readv : writev)(s->s_fd, iv, nr);
 	M0_LOG(M0_DEBUG, "flag: %" PRIi64 ", rc: %i, idx: %i, errno: %i.",
 	       flag, rc, nr, errno);
 	if (rc >= 0) {
@@ -3930,6 +4436,23 @@ const struct m0_net_xprt m0_net_sock_xprt = {
 };
 M0_EXPORTED(m0_net_sock_xprt);
 
+M0_INTERNAL void m0_net_sock_pollers_set(uint32_t nr)
+{
+	M0_PRE(nr > 0 && nr <= MA_POLLER_MAX);
+	sock_pollers_nr = nr;
+}
+
+M0_INTERNAL void m0_net_sock_zerocopy_set(m0_bcount_t min_nob)
+{
+	sock_zerocopy_min = min_nob;
+}
+
+M0_INTERNAL void m0_net_sock_batch_set(uint32_t nr)
+{
+	M0_PRE(nr > 0);
+	sock_batch_max = nr;
+}
+
 M0_INTERNAL int m0_net_sock_mod_init(void)
 {
 	int result;
@@ -26,7 +26,32 @@
 #define __MOTR_NET_SOCK_SOCK_H__
 
 #ifndef __KERNEL__
+#include "lib/types.h"                  /* uint32_t, m0_bcount_t */
+
 extern const struct m0_net_xprt m0_net_sock_xprt;
+
+/**
+ * Sets the number of poller threads of sock transfer machines initialised
+ * after this call.
+ *
+ * Each poller has its own epoll(2) instance and end-points of a transfer
+ * machine are assigned to the pollers round-robin. The default is 1.
+ */
+M0_INTERNAL void m0_net_sock_pollers_set(uint32_t nr);
+
+/**
+ * Sets the minimal payload size sent with MSG_ZEROCOPY by stream sockets
+ * opened after this call. 0 disables zero-copy sends.
+ *
+ * Zero-copy is also silently off where the kernel does not support it.
+ */
+M0_INTERNAL void m0_net_sock_zerocopy_set(m0_bcount_t min_nob);
+
+/**
+ * Sets the maximal number of packets of different buffers written to a socket
+ * by a single system call. 1 disables batching.
+ */
+M0_INTERNAL void m0_net_sock_batch_set(uint32_t nr);
 #endif
 /**
  * @defgroup netsock
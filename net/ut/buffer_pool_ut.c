@@ -132,6 +132,58 @@ static void test_prune(void)
 	m0_net_buffer_pool_unlock(&bp);
 }
 
+static void test_colour_node(void)
+{
+	struct m0_net_buffer *nb;
+	uint32_t	      buf_nr = bp.nbp_buf_nr;
+	enum {
+		COLOUR = 2,
+		NEIGHBOUR = 3,
+	};
+	m0_net_buffer_pool_lock(&bp);
+	m0_net_buffer_pool_colour_node_set(&bp, COLOUR, 0);
+	m0_net_buffer_pool_colour_node_set(&bp, NEIGHBOUR, 0);
+	M0_UT_ASSERT(m0_net_buffer_pool_provision_colour(&bp, 1, NEIGHBOUR)
+		     == 1);
+	M0_UT_ASSERT(++buf_nr == bp.nbp_buf_nr);
+	M0_UT_ASSERT(m0_net_tm_tlist_length(&bp.nbp_colours[NEIGHBOUR]) == 1);
+	/* A buffer of the same node is preferred to the lru one. */
+	nb = m0_net_buffer_pool_get(&bp, COLOUR);
+	M0_UT_ASSERT(nb != NULL);
+	M0_UT_ASSERT(m0_net_tm_tlist_is_empty(&bp.nbp_colours[NEIGHBOUR]));
+	m0_net_buffer_pool_put(&bp, nb, COLOUR);
+	M0_UT_ASSERT(m0_net_buffer_pool_invariant(&bp));
+	m0_net_buffer_pool_colour_node_set(&bp, COLOUR, M0_BUFFER_ANY_NODE);
+	m0_net_buffer_pool_colour_node_set(&bp, NEIGHBOUR, M0_BUFFER_ANY_NODE);
+	m0_net_buffer_pool_unlock(&bp);
+}
+
+static void test_trim(void)
+{
+	struct m0_net_buffer *nb;
+	uint32_t	      buf_nr;
+
+	m0_net_buffer_pool_lock(&bp);
+	/* Starts a period. */
+	m0_net_buffer_pool_trim(&bp);
+	buf_nr = bp.nbp_buf_nr;
+	nb = m0_net_buffer_pool_get(&bp, M0_BUFFER_ANY_COLOUR);
+	M0_UT_ASSERT(nb != NULL);
+	m0_net_buffer_pool_put(&bp, nb, M0_BUFFER_ANY_COLOUR);
+	/* All but one buffer and the threshold were not used. */
+	M0_UT_ASSERT(m0_net_buffer_pool_trim(&bp) ==
+		     buf_nr - 1 - bp.nbp_threshold);
+	M0_UT_ASSERT(bp.nbp_buf_nr == bp.nbp_threshold + 1);
+	/* The buffer used in the previous period was not used in this one. */
+	M0_UT_ASSERT(m0_net_buffer_pool_trim(&bp) == 1);
+	M0_UT_ASSERT(bp.nbp_buf_nr == bp.nbp_threshold);
+	M0_UT_ASSERT(m0_net_buffer_pool_trim(&bp) == 0);
+	M0_UT_ASSERT(m0_net_buffer_pool_invariant(&bp));
+	M0_UT_ASSERT(m0_net_buffer_pool_provision(&bp, buf_nr - bp.nbp_buf_nr)
+		     == buf_nr - bp.nbp_buf_nr);
+	m0_net_buffer_pool_unlock(&bp);
+}
+
 static void test_get_put_multiple(void)
 {
 	int		  i;
@@ -218,6 +270,8 @@ struct m0_ut_suite buffer_pool_ut = {
 		{ "buffer_pool_get_put_colour",    test_get_put_colour },
 		{ "buffer_pool_grow",              test_grow },
 		{ "buffer_pool_prune",             test_prune },
+		{ "buffer_pool_colour_node",       test_colour_node },
+		{ "buffer_pool_trim",              test_trim },
 		{ "buffer_pool_get_put_multiple",  test_get_put_multiple },
 		{ "buffer_pool_fini",              test_fini },
 		{ NULL,                            NULL }
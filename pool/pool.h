@@ -235,6 +235,11 @@ struct m0_pools_common {
 	struct m0_clink                   pc_conf_ready_async;
 	/** Pool of cas services used to store dix. */
 	struct m0_pool                   *pc_dix_pool;
+	/**
+	 * Service contexts are not waited for at setup, users of a context
+	 * wait for its connection with m0_reqh_service_connect_waiter_arm().
+	 */
+	bool                              pc_lazy_connect;
 };
 
 M0_TL_DESCR_DECLARE(pools_common_svc_ctx, M0_EXTERN);
@@ -585,6 +590,13 @@ enum sns_repair_state {
 	 */
 	SRS_REPAIR_DONE,
 
+	/**
+	 * Same as SRS_REPAIR_DONE, but the repair is direct: the units of
+	 * the failed device were reconstructed on the replacement device
+	 * itself, which serves IO of given fid, and spare units are not used.
+	 */
+	SRS_REPAIR_DONE_DIRECT,
+
 	SRS_NR,
 };
 
@@ -233,6 +233,89 @@ static bool poolmach_conf_ready_cb(struct m0_clink *clink)
 	return true;
 }
 
+static bool poolmach_in_batch(const struct m0_poolmach *pm)
+{
+	struct m0_chan *chan = pm->pm_batch_clink.cl_chan;
+
+	return chan != NULL && container_of(chan, struct m0_conf_cache,
+					    ca_ha_batch_chan)->ca_ha_batch;
+}
+
+/**
+ * Reports the pool version exceeding its failure tolerance and updates the
+ * pool version flags derived from the number of failures. "event" is NULL
+ * at the end of a batch of HA notes.
+ */
+static void poolmach_failures_check(struct m0_poolmach             *pm,
+				    const struct m0_poolmach_event *event)
+{
+	struct m0_poolmach_state *state = pm->pm_state;
+
+	/** @todo Add ADDB error message here. */
+	if ((event == NULL || event->pe_type == M0_POOL_DEVICE) &&
+	    state->pst_nr_failures > state->pst_max_device_failures &&
+	    state->pst_max_device_failures > 0) { /* Skip mdpool */
+		if (event == NULL)
+			M0_LOG(M0_ERROR, FID_F": nr_failures:%d max_failures:%d"
+					" after a batch of HA notes",
+					FID_P(&pm->pm_pver->pv_id),
+					state->pst_nr_failures,
+					state->pst_max_device_failures);
+		else if (state->pst_nr_failures >
+			 state->pst_max_device_failures + 10)
+			M0_LOG(M0_INFO, FID_F": nr_failures:%d max_failures:%d"
+					" event_index:%d event_state:%d"
+					" (a node failure/restart"
+					" or expander reset?)",
+					FID_P(&pm->pm_pver->pv_id),
+					state->pst_nr_failures,
+					state->pst_max_device_failures,
+					event->pe_index,
+					event->pe_state);
+		else
+			M0_LOG(M0_ERROR, FID_F": nr_failures:%d max_failures:%d"
+					" event_index:%d event_state:%d",
+					FID_P(&pm->pm_pver->pv_id),
+					state->pst_nr_failures,
+					state->pst_max_device_failures,
+					event->pe_index,
+					event->pe_state);
+		m0_poolmach_event_list_dump_locked(pm);
+	}
+	pm->pm_pver->pv_is_dirty = state->pst_nr_failures > 0;
+	/* Clear any dirty sns flags set during previous repair */
+	pm->pm_pver->pv_sns_flags = state->pst_nr_failures <=
+				    state->pst_max_device_failures ?
+				    0 : pm->pm_pver->pv_sns_flags;
+}
+
+/**
+ * Called at the end of a batch of HA notes: does the work deferred by the
+ * state transitions of the batch once.
+ */
+static bool poolmach_batch_end_cb(struct m0_clink *clink)
+{
+	struct m0_poolmach *pm = container_of(clink, struct m0_poolmach,
+					      pm_batch_clink);
+
+	if (pm->pm_batch_dirty) {
+		m0_rwlock_write_lock(&pm->pm_lock);
+		pm->pm_batch_dirty = false;
+		poolmach_failures_check(pm, NULL);
+		m0_rwlock_write_unlock(&pm->pm_lock);
+	}
+	return true;
+}
+
+M0_INTERNAL void m0_poolmach_ha_batch_subscribe(struct m0_poolmach   *pm,
+						struct m0_conf_cache *cache)
+{
+	M0_PRE(pm->pm_batch_clink.cl_chan == NULL);
+
+	m0_clink_init(&pm->pm_batch_clink, &poolmach_batch_end_cb);
+	m0_clink_add_lock(&cache->ca_ha_batch_chan, &pm->pm_batch_clink);
+}
+
 M0_INTERNAL int m0_poolmach_init_by_conf(struct m0_poolmach *pm,
 					 struct m0_conf_pver *pver)
 {
@@ -275,6 +358,7 @@ M0_INTERNAL int m0_poolmach_init_by_conf(struct m0_poolmach *pm,
 			  exp_clink(pm->pm_state));
 	m0_clink_add_lock(&reqh->rh_conf_cache_ready,
 			  ready_clink(pm->pm_state));
+	m0_poolmach_ha_batch_subscribe(pm, &confc->cc_cache);
 	M0_LOG(M0_DEBUG, "nodes:%d devices: %d", idx_nodes, idx_devices);
 	M0_POST(idx_devices <= pm->pm_state->pst_nr_devices);
 	return M0_RC(rc);
@@ -332,6 +416,7 @@ static void state_init(struct m0_poolmach_state   *state,
 				offsetof(struct m0_pooldev, pd_footer)
 		});
 		state->pst_devices_array[i].pd_state = M0_PNDS_UNKNOWN;
+		m0_bitmap_set(&state->pst_dud_devs, i, true);
 		M0_SET0(&state->pst_devices_array[i].pd_id);
 		state->pst_devices_array[i].pd_node = NULL;
 		state->pst_devices_array[i].pd_sdev_idx = 0;
@@ -390,6 +475,8 @@ M0_INTERNAL int m0_poolmach_init(struct m0_poolmach *pm,
 	struct m0_pooldev          *devices_array;
 	struct m0_pool_spare_usage *spare_usage_array;
 
+	int                         rc;
+
 	M0_ALLOC_PTR(state);
 	M0_ALLOC_ARR(nodes_array, nr_nodes);
 	M0_ALLOC_ARR(devices_array, nr_devices);
@@ -402,6 +489,19 @@ M0_INTERNAL int m0_poolmach_init(struct m0_poolmach *pm,
 		m0_free(spare_usage_array);
 		return M0_ERR(-ENOMEM);
 	}
+	rc = m0_bitmap_init(&state->pst_dud_devs, nr_devices);
+	if (rc == 0) {
+		rc = m0_bitmap_init(&state->pst_dud_nodes, nr_nodes);
+		if (rc != 0)
+			m0_bitmap_fini(&state->pst_dud_devs);
+	}
+	if (rc != 0) {
+		m0_free(state);
+		m0_free(nodes_array);
+		m0_free(devices_array);
+		m0_free(spare_usage_array);
+		return M0_ERR(rc);
+	}
 	state_init(state, nodes_array, nr_nodes, devices_array,
 		   nr_devices, spare_usage_array, nr_spare,
 		   max_node_failures, max_device_failures, pm);
@@ -433,6 +533,11 @@ M0_INTERNAL void m0_poolmach_fini(struct m0_poolmach *pm)
 
 	M0_PRE(pm != NULL);
 
+	/* Batch callbacks take pm_lock under the conf cache lock. */
+	if (pm->pm_batch_clink.cl_chan != NULL) {
+		m0_clink_del_lock(&pm->pm_batch_clink);
+		m0_clink_fini(&pm->pm_batch_clink);
+	}
 	m0_rwlock_write_lock(&pm->pm_lock);
 
 	m0_tl_for(poolmach_events, &state->pst_events_list, scan) {
@@ -459,6 +564,8 @@ M0_INTERNAL void m0_poolmach_fini(struct m0_poolmach *pm)
 		m0_clink_cleanup(ready_clink(state));
 		m0_clink_fini(ready_clink(state));
 	}
+	m0_bitmap_fini(&state->pst_dud_nodes);
+	m0_bitmap_fini(&state->pst_dud_devs);
 	m0_free(state->pst_spare_usage_array);
 	m0_free(state->pst_devices_array);
 	m0_free(state->pst_nodes_array);
@@ -632,8 +739,10 @@ M0_INTERNAL int m0_poolmach_state_transit(struct m0_poolmach       *pm,
 			return M0_ERR(-EINVAL);
 		break;
 	case M0_PNDS_SNS_REPAIRING:
+		/* Device, repaired in place by direct repair, is online. */
 		if (!M0_IN(event->pe_state, (M0_PNDS_SNS_REPAIRED,
-					     M0_PNDS_FAILED)))
+					     M0_PNDS_FAILED,
+					     M0_PNDS_ONLINE)))
 			return M0_ERR(-EINVAL);
 		break;
 	case M0_PNDS_SNS_REPAIRED:
@@ -661,9 +770,13 @@ M0_INTERNAL int m0_poolmach_state_transit(struct m0_poolmach       *pm,
 		 */
 		state->pst_nodes_array[event->pe_index].pn_state =
 			event->pe_state;
+		m0_bitmap_set(&state->pst_dud_nodes, event->pe_index,
+			      event->pe_state != M0_PNDS_ONLINE);
 	} else if (event->pe_type == M0_POOL_DEVICE) {
 		state->pst_devices_array[event->pe_index].pd_state =
 			event->pe_state;
+		m0_bitmap_set(&state->pst_dud_devs, event->pe_index,
+			      event->pe_state != M0_PNDS_ONLINE);
 	}
 
 	/* Step 4: Alloc or free a spare slot if necessary.*/
@@ -672,12 +785,16 @@ M0_INTERNAL int m0_poolmach_state_transit(struct m0_poolmach       *pm,
 		pd = &state->pst_devices_array[event->pe_index];
 		switch (event->pe_state) {
 		case M0_PNDS_ONLINE:
-			/* clear spare slot usage if it is from rebalancing */
+			/*
+			 * Clear spare slot usage if it is from rebalancing or
+			 * direct repair.
+			 */
 			for (i = 0; i < state->pst_nr_spares; i++) {
 				if (spare_array[i].psu_device_index ==
 				    event->pe_index) {
 					M0_ASSERT(M0_IN(spare_array[i].psu_device_state,
 							(M0_PNDS_OFFLINE,
+							 M0_PNDS_SNS_REPAIRING,
 							 M0_PNDS_SNS_REBALANCING)));
 					spare_array[i].psu_device_index =
 						POOL_PM_SPARE_SLOT_UNUSED;
@@ -689,6 +806,7 @@ M0_INTERNAL int m0_poolmach_state_transit(struct m0_poolmach       *pm,
 				break;
 			}
 			M0_ASSERT(M0_IN(old_state, (M0_PNDS_OFFLINE,
+						    M0_PNDS_SNS_REPAIRING,
 						    M0_PNDS_SNS_REBALANCING)));
 			M0_CNT_DEC(state->pst_nr_failures);
 			if (pool_failed_devs_tlink_is_in(pd))
@@ -759,35 +877,10 @@ M0_INTERNAL int m0_poolmach_state_transit(struct m0_poolmach       *pm,
 		poolmach_events_tlink_init_at_tail(new_link,
 				&state->pst_events_list);
 	}
-	/** @todo Add ADDB error message here. */
-	if (event->pe_type == M0_POOL_DEVICE &&
-	    state->pst_nr_failures > state->pst_max_device_failures &&
-	    state->pst_max_device_failures > 0) { /* Skip mdpool */
-		if (state->pst_nr_failures > state->pst_max_device_failures + 10)
-			M0_LOG(M0_INFO, FID_F": nr_failures:%d max_failures:%d"
-					" event_index:%d event_state:%d"
-					" (a node failure/restart"
-					" or expander reset?)",
-					FID_P(&pm->pm_pver->pv_id),
-					state->pst_nr_failures,
-					state->pst_max_device_failures,
-					event->pe_index,
-					event->pe_state);
-		else
-			M0_LOG(M0_ERROR, FID_F": nr_failures:%d max_failures:%d"
-					" event_index:%d event_state:%d",
-					FID_P(&pm->pm_pver->pv_id),
-					state->pst_nr_failures,
-					state->pst_max_device_failures,
-					event->pe_index,
-					event->pe_state);
-		m0_poolmach_event_list_dump_locked(pm);
-	}
-	pm->pm_pver->pv_is_dirty = state->pst_nr_failures > 0;
-	/* Clear any dirty sns flags set during previous repair */
-	pm->pm_pver->pv_sns_flags = state->pst_nr_failures <=
-				    state->pst_max_device_failures ?
-				    0 : pm->pm_pver->pv_sns_flags;
+	if (poolmach_in_batch(pm))
+		pm->pm_batch_dirty = true;
+	else
+		poolmach_failures_check(pm, event);
 	/* Finally: unlock the poolmach */
 	m0_rwlock_write_unlock(&pm->pm_lock);
 	return M0_RC(rc);
@@ -824,6 +917,10 @@ M0_INTERNAL int m0_poolmach_device_state(struct m0_poolmach *pm,
 		return M0_ERR_INFO(-EINVAL, "device index:%d total devices:%d",
 				device_index, pm->pm_state->pst_nr_devices);
 
+	if (!m0_bitmap_get(&pm->pm_state->pst_dud_devs, device_index)) {
+		*state_out = M0_PNDS_ONLINE;
+		return 0;
+	}
 	m0_rwlock_read_lock(&pm->pm_lock);
 	*state_out = pm->pm_state->pst_devices_array[device_index].pd_state;
 	m0_rwlock_read_unlock(&pm->pm_lock);
@@ -840,6 +937,10 @@ M0_INTERNAL int m0_poolmach_node_state(struct m0_poolmach *pm,
 	if (node_index >= pm->pm_state->pst_nr_nodes)
 		return M0_ERR(-EINVAL);
 
+	if (!m0_bitmap_get(&pm->pm_state->pst_dud_nodes, node_index)) {
+		*state_out = M0_PNDS_ONLINE;
+		return 0;
+	}
 	m0_rwlock_read_lock(&pm->pm_lock);
 	*state_out = pm->pm_state->pst_nodes_array[node_index].pn_state;
 	m0_rwlock_read_unlock(&pm->pm_lock);
@@ -29,6 +29,7 @@
 #include "lib/tlist.h"
 #include "lib/tlist_xc.h"
 #include "lib/rwlock.h"    /* m0_rwlock */
+#include "lib/bitmap.h"    /* m0_bitmap */
 #include "conf/obj.h"      /* m0_conf_pver_kind */
 
 /**
@@ -45,6 +46,7 @@ struct m0_poolnode;
 struct m0_pooldev;
 struct m0_pool_spare_usage;
 struct m0_pools_common;
+struct m0_conf_cache;
 struct m0_poolmach_event;
 struct m0_poolmach_event_link;
 struct m0_confc;
@@ -152,6 +154,17 @@ struct m0_poolmach_state {
 
 	struct m0_be_clink          pst_conf_exp;
 	struct m0_be_clink          pst_conf_ready;
+
+	/**
+	 * Bit i is set iff device i is not in M0_PNDS_ONLINE state. Updated
+	 * under m0_poolmach::pm_lock together with m0_pooldev::pd_state,
+	 * read without the lock by m0_poolmach_device_state(): a healthy
+	 * device is reported without a walk and without taking the lock.
+	 */
+	struct m0_bitmap            pst_dud_devs;
+
+	/** The same for nodes. */
+	struct m0_bitmap            pst_dud_nodes;
 };
 
 /**
@@ -176,6 +189,18 @@ struct m0_poolmach {
 
 	/** Read write lock to protect the whole pool machine. */
 	struct m0_rwlock           pm_lock;
+
+	/**
+	 * Linked to m0_conf_cache::ca_ha_batch_chan of the cache the pool
+	 * machine is configured from.
+	 */
+	struct m0_clink            pm_batch_clink;
+
+	/**
+	 * State transitions happened during the current batch of HA notes,
+	 * the failure accounting is to be redone at the end of the batch.
+	 */
+	bool                       pm_batch_dirty;
 };
 
 /** Event owner type, node or device. */
@@ -265,6 +290,16 @@ M0_INTERNAL int m0_poolmach_state_transit(struct m0_poolmach *pm,
  */
 M0_INTERNAL void m0_poolmach_state_last_cancel(struct m0_poolmach *pm);
 
+/**
+ * Subscribes the pool machine to the end of HA note batches applied to the
+ * cache (m0_conf_cache::ca_ha_batch_chan). During a batch, the failure
+ * accounting and pool version flags update done by
+ * m0_poolmach_state_transit() is deferred and done once at the end of the
+ * batch. Called by m0_poolmach_init_by_conf().
+ */
+M0_INTERNAL void m0_poolmach_ha_batch_subscribe(struct m0_poolmach   *pm,
+						struct m0_conf_cache *cache);
+
 /**
  * Query the current state of a specified device.
  * @param pm pool machine.
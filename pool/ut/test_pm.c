@@ -28,6 +28,7 @@
 #include "ut/be.h"
 #include "be/ut/helper.h"
 #include "ha/note.h"         /* m0_ha_nvec */
+#include "conf/cache.h"      /* m0_conf_cache */
 
 #undef M0_TRACE_SUBSYSTEM
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_POOL
@@ -112,12 +113,19 @@ static void pm_test_transit(void)
 	events[2].pe_state = M0_PNDS_ONLINE;
 	rc = m0_poolmach_state_transit(pm, &events[2]);
 	M0_UT_ASSERT(rc == 0);
+	rc = m0_poolmach_device_state(pm, 3, &state);
+	M0_UT_ASSERT(rc == 0 && state == M0_PNDS_ONLINE);
+	M0_UT_ASSERT(!m0_bitmap_get(&pm->pm_state->pst_dud_devs, 3));
+	M0_UT_ASSERT(m0_bitmap_get(&pm->pm_state->pst_dud_devs, 1));
 
 	events[3].pe_type  = M0_POOL_NODE;
 	events[3].pe_index = 0;
 	events[3].pe_state = M0_PNDS_OFFLINE;
 	rc = m0_poolmach_state_transit(pm, &events[3]);
 	M0_UT_ASSERT(rc == 0);
+	rc = m0_poolmach_node_state(pm, 0, &state);
+	M0_UT_ASSERT(rc == 0 && state == M0_PNDS_OFFLINE);
+	M0_UT_ASSERT(m0_bitmap_get(&pm->pm_state->pst_dud_nodes, 0));
 
 	/* invalid event. case 1: invalid type*/
 	e_invalid.pe_type  = M0_POOL_NODE + 5;
@@ -188,6 +196,10 @@ static void pm_test_spare_slot(void)
 	enum m0_pool_nd_state     target_state;
 	enum m0_pool_nd_state     state;
 	uint32_t                  spare_slot;
+	int                       i;
+	static const enum m0_pool_nd_state direct[] = {
+		M0_PNDS_FAILED, M0_PNDS_SNS_REPAIRING, M0_PNDS_ONLINE
+	};
 
 	rc = pool_pver_init(6, 2, 2);
 	M0_UT_ASSERT(rc == 0);
@@ -258,7 +270,8 @@ static void pm_test_spare_slot(void)
 	rc = m0_poolmach_sns_repair_spare_query(pm, 2, &spare_slot);
 	M0_UT_ASSERT(rc == -ENOENT);
 	for (state = M0_PNDS_ONLINE; state < M0_PNDS_NR; state++) {
-		if (state == M0_PNDS_SNS_REPAIRED ||
+		if (state == M0_PNDS_ONLINE ||
+		    state == M0_PNDS_SNS_REPAIRED ||
 		    state == M0_PNDS_FAILED ||
 		    state == M0_PNDS_SNS_REPAIRING)
 			continue;
@@ -331,6 +344,18 @@ static void pm_test_spare_slot(void)
 	rc = m0_poolmach_sns_repair_spare_query(pm, 1, &spare_slot);
 	M0_UT_ASSERT(rc == -ENOENT);
 
+	/* direct repair: FAILED -> SNS_REPAIRING -> ONLINE */
+	for (i = 0; i < ARRAY_SIZE(direct); ++i) {
+		event.pe_state = direct[i];
+		rc = m0_poolmach_state_transit(pm, &event);
+		M0_UT_ASSERT(rc == 0);
+	}
+	rc = m0_poolmach_device_state(pm, 1, &state_out);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(state_out == M0_PNDS_ONLINE);
+	rc = m0_poolmach_sns_repair_spare_query(pm, 1, &spare_slot);
+	M0_UT_ASSERT(rc == -ENOENT);
+
 	m0_fi_enable_off_n_on_m("m0_pooldev_clink_del",
 			  "do_nothing_for_poolmach-ut", 0,
 			  (PM_TEST_DEFAULT_DEVICE_NUMBER + 1));
@@ -342,6 +367,50 @@ static void pm_test_spare_slot(void)
 	pool_pver_fini();
 }
 
+/**
+ * Tests that the failure accounting of transitions applied within a batch of
+ * HA notes is done at the end of the batch.
+ */
+static void pm_test_ha_batch(void)
+{
+	struct m0_poolmach       *pm;
+	struct m0_poolmach_event  event;
+	struct m0_ha_nvec         nvec;
+	struct m0_conf_cache      cache;
+	struct m0_mutex           lock;
+	int                       i;
+	int                       rc;
+
+	m0_mutex_init(&lock);
+	m0_conf_cache_init(&cache, &lock);
+	rc = pool_pver_init(4, 1, 1);
+	M0_UT_ASSERT(rc == 0);
+	pm = &pver.pv_mach;
+	M0_SET0(&nvec);
+	m0_poolmach_failvec_apply(pm, &nvec);
+	m0_poolmach_ha_batch_subscribe(pm, &cache);
+
+	event.pe_type  = M0_POOL_DEVICE;
+	event.pe_state = M0_PNDS_FAILED;
+	m0_conf_cache_lock(&cache);
+	cache.ca_ha_batch = true;
+	for (i = 0; i < 3; ++i) {
+		event.pe_index = i;
+		rc = m0_poolmach_state_transit(pm, &event);
+		M0_UT_ASSERT(rc == 0);
+	}
+	M0_UT_ASSERT(pm->pm_state->pst_nr_failures == 3);
+	M0_UT_ASSERT(pm->pm_batch_dirty && !pver.pv_is_dirty);
+	cache.ca_ha_batch = false;
+	m0_chan_broadcast(&cache.ca_ha_batch_chan);
+	m0_conf_cache_unlock(&cache);
+	M0_UT_ASSERT(!pm->pm_batch_dirty && pver.pv_is_dirty);
+
+	pool_pver_fini();
+	m0_conf_cache_fini(&cache);
+	m0_mutex_fini(&lock);
+}
+
 static void pm_test_multi_fail(void)
 {
 	struct m0_poolmach       *pm;
@@ -543,6 +612,7 @@ struct m0_ut_suite poolmach_ut = {
 		{ "pm_test state transit", pm_test_transit                    },
 		{ "pm_test spare slot",    pm_test_spare_slot                 },
 		{ "pm_test multi fail",    pm_test_multi_fail                 },
+		{ "pm_test ha batch",      pm_test_ha_batch                   },
 		{ NULL,                    NULL                               }
 	}
 };
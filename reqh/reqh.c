@@ -89,6 +89,8 @@ struct disallowed_fop_reply {
 	struct m0_fom_simple  ffr_sfom;
 	struct m0_fop        *ffr_fop;
 	int                   ffr_rc;
+	/** The request is refused by reqh_fop_is_refused(). */
+	bool                  ffr_busy;
 };
 
 /**
@@ -434,6 +436,20 @@ extern struct m0_reqh_service_type m0_ha_link_service_type; /* XXX !!! */
 M0_EXTERN struct m0_reqh_service_type m0_cas_service_type; /* XXX !!! */
 #endif
 
+/**
+ * Returns true iff an incoming request, allowed by m0_reqh_fop_allow(), is
+ * refused because its service already has m0_reqh_service::rs_fom_max foms.
+ */
+static bool reqh_fop_is_refused(struct m0_reqh *reqh, struct m0_fop *fop)
+{
+	struct m0_reqh_service *svc;
+
+	svc = m0_reqh_service_find(fop->f_type->ft_fom_type.ft_rstype, reqh);
+	return svc->rs_fom_max != 0 &&
+		m0_rpc_item_is_request(&fop->f_item) &&
+		m0_atomic64_get(&svc->rs_fom_active) >= svc->rs_fom_max;
+}
+
 M0_INTERNAL int m0_reqh_fop_allow(struct m0_reqh *reqh, struct m0_fop *fop)
 {
 	int                                rh_st;
@@ -500,16 +516,19 @@ static int disallowed_fop_tick(struct m0_fom *fom, void *data, int *phase)
 {
 	struct m0_fop               *fop;
 	struct disallowed_fop_reply *reply = data;
-	static const char            msg[] = "No service running.";
+	const char                  *msg = reply->ffr_busy ?
+		"Service is busy." : "No service running.";
 
 	fop = m0_fop_reply_alloc(reply->ffr_fop, &m0_fop_generic_reply_fopt);
 	if (fop != NULL) {
 		struct m0_fop_generic_reply *rep = m0_fop_data(fop);
 
 		rep->gr_rc = reply->ffr_rc;
-		rep->gr_msg.s_buf = m0_alloc(sizeof msg);
+		if (reply->ffr_busy)
+			fop->f_item.ri_flags |= M0_RIF_BUSY;
+		rep->gr_msg.s_buf = m0_alloc(strlen(msg) + 1);
 		if (rep->gr_msg.s_buf != NULL) {
-			rep->gr_msg.s_len = sizeof msg;
+			rep->gr_msg.s_len = strlen(msg) + 1;
 			memcpy(rep->gr_msg.s_buf, msg, rep->gr_msg.s_len);
 		}
 		m0_rpc_reply_post(&reply->ffr_fop->f_item, &fop->f_item);
@@ -524,7 +543,8 @@ static void disallowed_fop_free(struct m0_fom_simple *sfom)
 
 static void fop_disallowed(struct m0_reqh *reqh,
 			   struct m0_fop  *req_fop,
-			   int             rc)
+			   int             rc,
+			   bool            busy)
 {
 	struct disallowed_fop_reply *reply;
 
@@ -538,6 +558,7 @@ static void fop_disallowed(struct m0_reqh *reqh,
 	m0_fop_get(req_fop);
 	reply->ffr_fop = req_fop;
 	reply->ffr_rc = rc;
+	reply->ffr_busy = busy;
 	M0_FOM_SIMPLE_POST(&reply->ffr_sfom, reqh, NULL, disallowed_fop_tick,
 			   disallowed_fop_free, reply, M0_FOM_SIMPLE_HERE);
 
@@ -545,8 +566,10 @@ static void fop_disallowed(struct m0_reqh *reqh,
 
 M0_INTERNAL int m0_reqh_fop_handle(struct m0_reqh *reqh, struct m0_fop *fop)
 {
-	struct m0_fom *fom;
-	int            rc;
+	struct m0_rpc_machine *mach;
+	struct m0_fom         *fom;
+	bool                   busy;
+	int                    rc;
 
 	M0_ENTRY("%p", reqh);
 	M0_PRE(reqh != NULL);
@@ -555,10 +578,15 @@ M0_INTERNAL int m0_reqh_fop_handle(struct m0_reqh *reqh, struct m0_fop *fop)
 	m0_rwlock_read_lock(&reqh->rh_rwlock);
 
 	rc = m0_reqh_fop_allow(reqh, fop);
+	busy = rc == 0 && reqh_fop_is_refused(reqh, fop);
+	if (busy)
+		rc = -EBUSY;
 	if (rc != 0) {
 		m0_rwlock_read_unlock(&reqh->rh_rwlock);
-		M0_LOG(M0_WARN, "fop \"%s\"@%p disallowed: %i.",
-		       m0_fop_name(fop), fop, rc);
+		/* Do not flood the log under overload. */
+		if (!busy)
+			M0_LOG(M0_WARN, "fop \"%s\"@%p disallowed: %i.",
+			       m0_fop_name(fop), fop, rc);
 		if (m0_rpc_item_is_request(&fop->f_item)) {
 			struct m0_reqh_service_type *rst =
 				m0_reqh_service_type_find("simple-fom-service");
@@ -566,7 +594,7 @@ M0_INTERNAL int m0_reqh_fop_handle(struct m0_reqh *reqh, struct m0_fop *fop)
 			    m0_reqh_service_find(rst, reqh) == NULL)
 				return M0_ERR_INFO(-ESHUTDOWN,
 						   "Service shutdown.");
-			fop_disallowed(reqh, fop, M0_ERR(rc));
+			fop_disallowed(reqh, fop, rc, busy);
 		}
 		/*
 		 * Note :
@@ -581,8 +609,15 @@ M0_INTERNAL int m0_reqh_fop_handle(struct m0_reqh *reqh, struct m0_fop *fop)
 	M0_ASSERT(fop->f_type->ft_fom_type.ft_ops->fto_create != NULL);
 
 	rc = fop->f_type->ft_fom_type.ft_ops->fto_create(fop, &fom, reqh);
-	if (rc == 0)
-		m0_fom_queue(fom);
+	if (rc == 0) {
+		mach = fop->f_item.ri_rmachine;
+		/* The fom of an incoming item joins the batch of its packet. */
+		if (mach != NULL && m0_rpc_machine_is_locked(mach) &&
+		    mach->rm_fom_batch != NULL)
+			m0_fom_batch_add(mach->rm_fom_batch, fom);
+		else
+			m0_fom_queue(fom);
+	}
 
 	m0_rwlock_read_unlock(&reqh->rh_rwlock);
 	return M0_RC(rc);
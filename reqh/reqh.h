@@ -176,6 +176,13 @@ struct m0_reqh {
 	/** Process FID. */
 	struct m0_fid                 rh_fid;
 
+	/**
+	 * An incoming request fails with -EBUSY, before the service handles
+	 * it, if the run-queue of its home locality has at least that many
+	 * foms. 0 for no limit, which is the default. See fom_phase_init().
+	 */
+	uint32_t                      rh_runq_max;
+
 	/** Guard for configuration cache events */
 	struct m0_mutex               rh_guard;
 
@@ -443,6 +443,7 @@ M0_INTERNAL void m0_reqh_service_init(struct m0_reqh_service *service,
 	m0_mutex_init(&service->rs_mutex);
 	reqh_service_state_set(service, M0_RST_INITIALISED);
 	m0_atomic64_set(&service->rs_fom_queued, 0);
+	m0_atomic64_set(&service->rs_fom_active, 0);
 
 	/*
 	 * We want to track these services externally so add them to the list
@@ -834,6 +835,70 @@ M0_INTERNAL int m0_reqh_service_disconnect_wait(struct m0_reqh_service_ctx *ctx)
 	return M0_RC(reqh_service_ctx_state_wait(ctx, M0_RSC_OFFLINE));
 }
 
+/** Result of the connection attempt of `ctx', which is not connecting. */
+static int reqh_service_ctx_connect_rc(struct m0_reqh_service_ctx *ctx)
+{
+	M0_PRE(CTX_STATE(ctx) != M0_RSC_CONNECTING);
+	if (CTX_STATE(ctx) != M0_RSC_OFFLINE)
+		return 0;
+	return ctx->sc_rlink.rlk_rc ?: M0_ERR(-ENOTCONN);
+}
+
+/** Called under the context sm group lock on every context state change. */
+static bool reqh_service_connect_waiter_cb(struct m0_clink *clink)
+{
+	struct m0_reqh_service_connect_waiter *w = M0_AMB(w, clink, scw_clink);
+
+	if (CTX_STATE(w->scw_ctx) == M0_RSC_CONNECTING)
+		return true;
+	w->scw_rc = reqh_service_ctx_connect_rc(w->scw_ctx);
+	m0_clink_del(clink);
+	m0_sm_ast_post(w->scw_grp, &w->scw_ast);
+	return true;
+}
+
+M0_INTERNAL void
+m0_reqh_service_connect_waiter_init(struct m0_reqh_service_connect_waiter *w,
+				    struct m0_sm_group *grp,
+				    void (*cb)(struct m0_sm_group *,
+					       struct m0_sm_ast *))
+{
+	M0_SET0(w);
+	w->scw_grp = grp;
+	w->scw_ast.sa_cb = cb;
+	m0_clink_init(&w->scw_clink, &reqh_service_connect_waiter_cb);
+}
+
+M0_INTERNAL void
+m0_reqh_service_connect_waiter_fini(struct m0_reqh_service_connect_waiter *w)
+{
+	M0_PRE(!m0_clink_is_armed(&w->scw_clink));
+	m0_clink_fini(&w->scw_clink);
+}
+
+M0_INTERNAL bool
+m0_reqh_service_connect_waiter_arm(struct m0_reqh_service_connect_waiter *w,
+				   struct m0_reqh_service_ctx            *ctx)
+{
+	bool wait;
+
+	M0_PRE(!m0_clink_is_armed(&w->scw_clink));
+
+	w->scw_ctx = ctx;
+	w->scw_rc  = 0;
+	if (ctx->sc_pc == NULL || !ctx->sc_pc->pc_lazy_connect ||
+	    ctx->sc_service->co_ha_state != M0_NC_ONLINE)
+		return false;
+	reqh_service_ctx_sm_lock(ctx);
+	wait = CTX_STATE(ctx) == M0_RSC_CONNECTING;
+	if (wait)
+		m0_clink_add(&ctx->sc_sm.sm_chan, &w->scw_clink);
+	else
+		w->scw_rc = reqh_service_ctx_connect_rc(ctx);
+	reqh_service_ctx_sm_unlock(ctx);
+	return wait;
+}
+
 static void reqh_service_reconnect_locked(struct m0_reqh_service_ctx *ctx,
 					  const char                 *addr)
 {
@@ -977,6 +1042,7 @@ M0_INTERNAL void m0_reqh_service_ctx_fini(struct m0_reqh_service_ctx *ctx)
 	m0_clink_fini(&ctx->sc_rlink_abort);
 	m0_clink_fini(&ctx->sc_process_event);
 	m0_clink_fini(&ctx->sc_svc_event);
+	m0_chan_fini_lock(&ctx->sc_fsync_chan);
 	m0_mutex_fini(&ctx->sc_max_pending_tx_lock);
 	m0_reqh_service_ctx_bob_fini(ctx);
 	if (reqh_service_ctx_flag_is_set(ctx, M0_RSC_RLINK_INITED))
@@ -1228,6 +1294,7 @@ M0_INTERNAL int m0_reqh_service_ctx_init(struct m0_reqh_service_ctx *ctx,
 	ctx->sc_fid_process = proc_obj->co_id;
 	m0_reqh_service_ctx_bob_init(ctx);
 	m0_mutex_init(&ctx->sc_max_pending_tx_lock);
+	m0_chan_init(&ctx->sc_fsync_chan, &ctx->sc_max_pending_tx_lock);
 	m0_clink_init(&ctx->sc_svc_event, service_event_handler);
 	m0_clink_init(&ctx->sc_process_event, process_event_handler);
 	m0_clink_init(&ctx->sc_rlink_wait, reqh_service_ctx_rlink_cb);
@@ -239,6 +239,17 @@ struct m0_reqh_service {
 	int                                rs_fom_key;
 	/** Fom's posted to queueit() AST */
 	struct m0_atomic64                 rs_fom_queued;
+	/**
+	 * Number of foms of the service from m0_fom_sm_init() to
+	 * m0_fom_fini().
+	 */
+	struct m0_atomic64                 rs_fom_active;
+	/**
+	 * Incoming requests are refused with -EBUSY while rs_fom_active is at
+	 * least that large, see m0_reqh_fop_handle(). 0 for no limit, which is
+	 * the default.
+	 */
+	uint64_t                           rs_fom_max;
 	/**
 	   Service state machine.
 
@@ -774,6 +785,20 @@ struct m0_reqh_service_ctx {
 	/** pending transaction record for this service. */
 	struct m0_reqh_service_txid sc_max_pending_tx;
 	struct m0_mutex             sc_max_pending_tx_lock;
+	/**
+	 * Transaction id requested by the client FSYNC fop in flight to the
+	 * service, 0 if there is none. Concurrent SYNC requests for smaller
+	 * transaction ids wait for that fop instead of sending their own, see
+	 * motr/sync.c. sc_fsync_* fields are protected by
+	 * sc_max_pending_tx_lock.
+	 */
+	uint64_t                    sc_fsync_txid;
+	/** Number of replied FSYNC fops which were in flight. */
+	uint64_t                    sc_fsync_gen;
+	/** Result of the last replied FSYNC fop which was in flight. */
+	int32_t                     sc_fsync_rc;
+	/** Signalled when the FSYNC fop in flight is replied. */
+	struct m0_chan              sc_fsync_chan;
 
 	/** object representing the service the context connects to */
 	struct m0_conf_obj         *sc_service;
@@ -855,6 +880,55 @@ M0_INTERNAL void m0_reqh_service_connect_wait(struct m0_reqh_service_ctx *ctx);
 M0_INTERNAL int
 m0_reqh_service_disconnect_wait(struct m0_reqh_service_ctx *ctx);
 
+/**
+ * Asynchronous wait for the connection of a service context of pools common
+ * connected lazily (m0_pools_common::pc_lazy_connect).
+ *
+ * Unlike m0_reqh_service_connect_wait(), the waiter doesn't block, so it can be
+ * used from ast and locality contexts: the user parks its request and resumes
+ * it from scw_ast.
+ */
+struct m0_reqh_service_connect_waiter {
+	struct m0_reqh_service_ctx *scw_ctx;
+	/** Linked to the channel of scw_ctx->sc_sm while waiting. */
+	struct m0_clink             scw_clink;
+	/** Posted to scw_grp when the connection attempt completes. */
+	struct m0_sm_ast            scw_ast;
+	struct m0_sm_group         *scw_grp;
+	/**
+	 * 0 if the session of scw_ctx can be used, the error of the failed
+	 * connection attempt otherwise.
+	 */
+	int                         scw_rc;
+};
+
+M0_INTERNAL void
+m0_reqh_service_connect_waiter_init(struct m0_reqh_service_connect_waiter *w,
+				    struct m0_sm_group *grp,
+				    void (*cb)(struct m0_sm_group *,
+					       struct m0_sm_ast *));
+
+/**
+ * Finalises the waiter. The user doesn't finalise a request parked on the
+ * waiter, so the waiter is neither armed nor has scw_ast posted here.
+ */
+M0_INTERNAL void
+m0_reqh_service_connect_waiter_fini(struct m0_reqh_service_connect_waiter *w);
+
+/**
+ * Starts waiting for the connection of `ctx'.
+ *
+ * Returns false if there is nothing to wait for: pools common of the context
+ * is not connected lazily, the service is not online in HA, or the connection
+ * is established or has failed. w->scw_rc is set then.
+ *
+ * Otherwise returns true. w->scw_ast is posted to w->scw_grp when the context
+ * becomes online or goes offline, with w->scw_rc set accordingly.
+ */
+M0_INTERNAL bool
+m0_reqh_service_connect_waiter_arm(struct m0_reqh_service_connect_waiter *w,
+				   struct m0_reqh_service_ctx            *ctx);
+
 /**
  * Returns the outer m0_reqh_service_ctx from a m0_rpc_session.
  */
@@ -111,7 +111,8 @@ static int reqh_ut_balloc_init(struct m0_ad_balloc *ballroom,
 	return 0;
 }
 
-static void reqh_ut_balloc_fini(struct m0_ad_balloc *ballroom)
+static void reqh_ut_balloc_fini(struct m0_ad_balloc *ballroom,
+				struct m0_sm_group *grp)
 {
 	struct reqh_ut_balloc *rb = getballoc(ballroom);
 
@@ -122,7 +123,8 @@ static int reqh_ut_balloc_alloc(struct m0_ad_balloc *ballroom,
 				struct m0_dtx *tx,
 				m0_bcount_t count,
 				struct m0_ext *out,
-				uint64_t alloc_zone)
+				uint64_t alloc_zone,
+				uint64_t owner)
 {
 	struct reqh_ut_balloc	*rb = getballoc(ballroom);
 
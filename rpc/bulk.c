@@ -61,7 +61,12 @@ static bool rpc_bulk_invariant(const struct m0_rpc_bulk *rbulk)
 		m0_mutex_is_locked(&rbulk->rb_mutex) &&
 		m0_tl_forall(rpcbulk, buf, &rbulk->rb_buflist,
 			     rpc_bulk_buf_invariant(buf) &&
-			     buf->bb_rbulk == rbulk);
+			     buf->bb_rbulk == rbulk) &&
+		m0_tl_forall(rpcbulk, buf, &rbulk->rb_donelist,
+			     rpc_bulk_buf_invariant(buf) &&
+			     buf->bb_rbulk == rbulk) &&
+		ergo(!rbulk->rb_pipelined,
+		     rpcbulk_tlist_is_empty(&rbulk->rb_donelist));
 }
 
 static void rpc_bulk_buf_deregister(struct m0_rpc_bulk_buf *buf)
@@ -174,14 +179,19 @@ M0_INTERNAL void m0_rpc_bulk_default_cb(const struct m0_net_buffer_event *evt)
 	if (rbulk->rb_rc == 0 && evt->nbe_status != -ECANCELED)
 		rbulk->rb_rc = evt->nbe_status;
 
-	rpcbulk_tlist_del(buf);
-	rpc_bulk_buf_fini(buf);
+	if (rbulk->rb_pipelined) {
+		rpcbulk_tlist_move(&rbulk->rb_donelist, buf);
+	} else {
+		rpcbulk_tlist_del(buf);
+		rpc_bulk_buf_fini(buf);
+	}
 	if (rpcbulk_tlist_is_empty(&rbulk->rb_buflist)) {
 		M0_ADDB2_ADD(M0_AVI_RPC_BULK_OP, rbulk->rb_id,
 			     M0_RPC_BULK_OP_FINISH);
 		if (m0_chan_has_waiters(&rbulk->rb_chan))
 			m0_chan_signal(&rbulk->rb_chan);
-	}
+	} else if (rbulk->rb_pipelined && m0_chan_has_waiters(&rbulk->rb_chan))
+		m0_chan_signal(&rbulk->rb_chan);
 	m0_mutex_unlock(&rbulk->rb_mutex);
 
 	M0_LEAVE("rb_rc=%d", rbulk->rb_rc);
@@ -250,12 +260,14 @@ M0_INTERNAL void m0_rpc_bulk_init(struct m0_rpc_bulk *rbulk)
 	M0_PRE(rbulk != NULL);
 
 	rpcbulk_tlist_init(&rbulk->rb_buflist);
+	rpcbulk_tlist_init(&rbulk->rb_donelist);
 	m0_mutex_init(&rbulk->rb_mutex);
 	m0_chan_init(&rbulk->rb_chan, &rbulk->rb_mutex);
 	rbulk->rb_magic = M0_RPC_BULK_MAGIC;
 	rbulk->rb_bytes = 0;
 	rbulk->rb_rc = 0;
 	rbulk->rb_id = m0_dummy_id_generate();
+	rbulk->rb_pipelined = false;
 	M0_LEAVE();
 }
 M0_EXPORTED(m0_rpc_bulk_init);
@@ -267,10 +279,12 @@ M0_INTERNAL void m0_rpc_bulk_fini(struct m0_rpc_bulk *rbulk)
 	m0_mutex_lock(&rbulk->rb_mutex);
 	M0_PRE_EX(rpc_bulk_invariant(rbulk));
 	M0_PRE(rpcbulk_tlist_is_empty(&rbulk->rb_buflist));
+	M0_PRE(rpcbulk_tlist_is_empty(&rbulk->rb_donelist));
 	m0_mutex_unlock(&rbulk->rb_mutex);
 
 	m0_chan_fini_lock(&rbulk->rb_chan);
 	m0_mutex_fini(&rbulk->rb_mutex);
+	rpcbulk_tlist_fini(&rbulk->rb_donelist);
 	rpcbulk_tlist_fini(&rbulk->rb_buflist);
 	M0_LEAVE();
 }
@@ -285,7 +299,30 @@ M0_INTERNAL void m0_rpc_bulk_buflist_empty(struct m0_rpc_bulk *rbulk)
 	m0_tl_teardown(rpcbulk, &rbulk->rb_buflist, buf) {
 		rpc_bulk_buf_fini(buf);
 	}
+	m0_tl_teardown(rpcbulk, &rbulk->rb_donelist, buf) {
+		rpc_bulk_buf_fini(buf);
+	}
+	m0_mutex_unlock(&rbulk->rb_mutex);
+}
+
+M0_INTERNAL struct m0_net_buffer *
+m0_rpc_bulk_done_pop(struct m0_rpc_bulk *rbulk)
+{
+	struct m0_rpc_bulk_buf *buf;
+	struct m0_net_buffer   *nb = NULL;
+
+	M0_PRE(rbulk->rb_pipelined);
+
+	m0_mutex_lock(&rbulk->rb_mutex);
+	M0_ASSERT_EX(rpc_bulk_invariant(rbulk));
+	buf = rpcbulk_tlist_pop(&rbulk->rb_donelist);
+	if (buf != NULL) {
+		M0_ASSERT(!(buf->bb_flags & M0_RPC_BULK_NETBUF_ALLOCATED));
+		nb = buf->bb_nbuf;
+		rpc_bulk_buf_fini(buf);
+	}
 	m0_mutex_unlock(&rbulk->rb_mutex);
+	return nb;
 }
 
 M0_INTERNAL int m0_rpc_bulk_buf_add(struct m0_rpc_bulk *rbulk,
@@ -265,6 +265,19 @@ struct m0_rpc_bulk {
 	 */
 	int32_t         rb_rc;
 	uint64_t        rb_id;
+	/**
+	 * If true, buffers with completed transfer are moved to rb_donelist
+	 * instead of being finalised and rb_chan is signalled on every
+	 * completion, so the user can process a buffer while others are still
+	 * in transfer. Set before m0_rpc_bulk_load() or m0_rpc_bulk_store().
+	 * @see m0_rpc_bulk_done_pop().
+	 */
+	bool            rb_pipelined;
+	/**
+	 * List of m0_rpc_bulk_buf structures with completed transfer, linked
+	 * through m0_rpc_bulk_buf::bb_link. Used when rb_pipelined is true.
+	 */
+	struct m0_tl    rb_donelist;
 };
 
 /**
@@ -283,6 +296,18 @@ M0_INTERNAL void m0_rpc_bulk_init(struct m0_rpc_bulk *rbulk);
  */
 M0_INTERNAL void m0_rpc_bulk_buflist_empty(struct m0_rpc_bulk *rbulk);
 
+/**
+   Removes a buffer with completed transfer from a pipelined rpc bulk.
+
+   Returns the net buffer of the removed m0_rpc_bulk_buf or NULL if no
+   transfer completed since the last call. The status of the transfer is
+   accounted in m0_rpc_bulk::rb_rc. The net buffer must be provided by the
+   user, see m0_rpc_bulk_buf_add().
+   @pre rbulk->rb_pipelined.
+ */
+M0_INTERNAL struct m0_net_buffer *
+m0_rpc_bulk_done_pop(struct m0_rpc_bulk *rbulk);
+
 /**
    Finalizes the rpc bulk structure.
    @pre rbulk != NULL && rpc_bulk_invariant(rbulk).
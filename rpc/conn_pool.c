@@ -43,19 +43,43 @@ M0_TL_DESCR_DEFINE(rpc_conn_pool_items,
 
 M0_TL_DEFINE(rpc_conn_pool_items, M0_INTERNAL, struct m0_rpc_conn_pool_item);
 
+static bool item_has_ep(const struct m0_rpc_conn_pool_item *pool_item,
+			const char                         *remote_ep)
+{
+	return strcmp(m0_rpc_conn_addr(&pool_item->cpi_rpc_link.rlk_conn),
+		      remote_ep) == 0;
+}
+
+/**
+ * Chooses a connection to remote_ep according to m0_rpc_conn_pool::cp_policy.
+ * Returns NULL if a new connection should be opened.
+ */
 static struct m0_rpc_conn_pool_item *find_item_by_ep(
 		struct m0_rpc_conn_pool *pool,
 		const char              *remote_ep)
 {
 	struct m0_rpc_conn_pool_item *ret = NULL;
 	struct m0_rpc_conn_pool_item *pool_item;
+	uint64_t                      nr;
+	uint64_t                      idx;
 
 	M0_ENTRY();
 	M0_PRE(m0_mutex_is_locked(&pool->cp_mutex));
+	nr = m0_tl_reduce(rpc_conn_pool_items, pi, &pool->cp_items, 0ULL,
+			  + item_has_ep(pi, remote_ep));
+	if (nr < pool->cp_paths_nr) {
+		M0_LEAVE("nr %"PRIu64, nr);
+		return NULL;
+	}
+	idx = pool->cp_next++ % nr;
 	m0_tl_for(rpc_conn_pool_items, &pool->cp_items, pool_item) {
-		if (!strcmp(m0_rpc_conn_addr(&pool_item->cpi_rpc_link.rlk_conn),
-			    remote_ep))
-		{
+		if (!item_has_ep(pool_item, remote_ep))
+			continue;
+		if (pool->cp_policy == M0_RCP_LEAST_USED) {
+			if (ret == NULL ||
+			    pool_item->cpi_users_nr < ret->cpi_users_nr)
+				ret = pool_item;
+		} else if (idx-- == 0) {
 			ret = pool_item;
 			break;
 		}
@@ -336,12 +360,28 @@ M0_INTERNAL int m0_rpc_conn_pool_init(
 	pool->cp_rpc_mach            = rpc_mach;
 	pool->cp_timeout             = conn_timeout;
 	pool->cp_max_rpcs_in_flight  = max_rpcs_in_flight;
+	pool->cp_paths_nr            = 1;
+	pool->cp_policy              = M0_RCP_ROUND_ROBIN;
 	m0_mutex_init(&pool->cp_mutex);
 	m0_mutex_init(&pool->cp_ch_mutex);
 	rpc_conn_pool_items_tlist_init(&pool->cp_items);
 	return M0_RC(0);
 }
 
+M0_INTERNAL void m0_rpc_conn_pool_paths_set(struct m0_rpc_conn_pool *pool,
+					    uint32_t paths_nr,
+					    enum m0_rpc_conn_pool_policy policy)
+{
+	M0_PRE(paths_nr > 0);
+	M0_PRE(policy < M0_RCP_NR);
+
+	m0_mutex_lock(&pool->cp_mutex);
+	M0_PRE(rpc_conn_pool_items_tlist_is_empty(&pool->cp_items));
+	pool->cp_paths_nr = paths_nr;
+	pool->cp_policy   = policy;
+	m0_mutex_unlock(&pool->cp_mutex);
+}
+
 M0_INTERNAL void m0_rpc_conn_pool_fini(struct m0_rpc_conn_pool *pool)
 {
 	struct m0_rpc_conn_pool_item  *item;
@@ -32,6 +32,18 @@
 
 struct m0_rpc_conn_pool;
 
+/**
+ * How a session is chosen among the connections of a pool to the same
+ * endpoint, see m0_rpc_conn_pool_paths_set().
+ */
+enum m0_rpc_conn_pool_policy {
+	/** Connections are handed out in turn. */
+	M0_RCP_ROUND_ROBIN,
+	/** The connection with the least number of users is handed out. */
+	M0_RCP_LEAST_USED,
+	M0_RCP_NR
+};
+
 struct m0_rpc_conn_pool_item {
 	struct m0_rpc_link       cpi_rpc_link;
 	struct m0_chan           cpi_chan;
@@ -51,6 +63,12 @@ struct m0_rpc_conn_pool {
 	m0_time_t                cp_timeout;
 	uint64_t                 cp_max_rpcs_in_flight;
 	struct m0_sm_ast         cp_ast;
+	/** Maximal number of connections to the same endpoint. */
+	uint32_t                 cp_paths_nr;
+	/** Value of enum m0_rpc_conn_pool_policy. */
+	uint32_t                 cp_policy;
+	/** The next connection to hand out with M0_RCP_ROUND_ROBIN. */
+	uint64_t                 cp_next;
 };
 
 M0_INTERNAL int m0_rpc_conn_pool_init(
@@ -61,6 +79,22 @@ M0_INTERNAL int m0_rpc_conn_pool_init(
 
 M0_INTERNAL void m0_rpc_conn_pool_fini(struct m0_rpc_conn_pool *pool);
 
+/**
+ * Makes the pool open up to paths_nr connections, each with its own session,
+ * to the same endpoint and spread m0_rpc_conn_pool_get_*() calls over them
+ * according to the policy. A get opens a new connection while there are less
+ * than paths_nr of them.
+ *
+ * Items sent over connections to the same endpoint share the rpc chan, but
+ * each session has its own slot and max_rpcs_in_flight limits.
+ *
+ * By default the pool has one connection per endpoint. Should be called
+ * before the first m0_rpc_conn_pool_get_*() call.
+ */
+M0_INTERNAL void m0_rpc_conn_pool_paths_set(struct m0_rpc_conn_pool *pool,
+					    uint32_t paths_nr,
+					    enum m0_rpc_conn_pool_policy policy);
+
 M0_INTERNAL int m0_rpc_conn_pool_get_sync(
 		struct m0_rpc_conn_pool *pool,
 		const char              *remote_ep,
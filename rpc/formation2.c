@@ -25,11 +25,14 @@
 #include "lib/misc.h"    /* M0_SET0 */
 #include "lib/memory.h"
 #include "lib/tlist.h"
+#include "lib/arith.h"         /* max64u, min64u */
+#include "addb2/addb2.h"
 #include "motr/magic.h"
 #include "lib/finject.h"       /* M0_FI_ENABLED */
 #include "reqh/reqh.h"
 
 #include "rpc/rpc_internal.h"
+#include "rpc/addb2.h"
 
 /**
  * @addtogroup rpc
@@ -80,6 +83,87 @@ static const char *str_qtype[] = {
 
 M0_BASSERT(ARRAY_SIZE(str_qtype) == FRMQ_NR_QUEUES);
 
+/**
+   Formation policy, see m0_rpc_frm_policy_type.
+ */
+struct frm_policy {
+	const char *fp_name;
+	/**
+	   Should a packet be formed, though there are no urgent items and not
+	   enough bytes are accumulated? Called when a packet can be sent.
+	 */
+	bool      (*fp_is_ready)(const struct m0_rpc_frm *frm);
+	/** Returns deadline of the item being enqueued. */
+	m0_time_t (*fp_deadline)(const struct m0_rpc_frm  *frm,
+				 const struct m0_rpc_item *item);
+};
+
+static bool frm_link_is_idle(const struct m0_rpc_frm *frm)
+{
+	return frm->f_nr_packets_enqed == 0 && frm->f_nr_items > 0;
+}
+
+static bool frm_never_ready(const struct m0_rpc_frm *frm)
+{
+	return false;
+}
+
+static m0_time_t frm_item_deadline(const struct m0_rpc_frm  *frm,
+				   const struct m0_rpc_item *item)
+{
+	return item->ri_deadline;
+}
+
+static m0_time_t frm_hold(const struct m0_rpc_item *item, m0_time_t hold)
+{
+	return max64u(item->ri_deadline, m0_time_from_now(0, hold));
+}
+
+static m0_time_t frm_throughput_deadline(const struct m0_rpc_frm  *frm,
+					 const struct m0_rpc_item *item)
+{
+	return frm_hold(item, frm->f_constraints.fc_hold);
+}
+
+static m0_time_t frm_adaptive_deadline(const struct m0_rpc_frm  *frm,
+				       const struct m0_rpc_item *item)
+{
+	return frm->f_nr_packets_enqed == 0 ? item->ri_deadline :
+		frm_hold(item, min64u(frm->f_constraints.fc_hold,
+				      frm->f_packet_time));
+}
+
+static const struct frm_policy frm_policies[] = {
+	[M0_RPC_FRM_POLICY_DEADLINE] = {
+		.fp_name     = "deadline",
+		.fp_is_ready = &frm_never_ready,
+		.fp_deadline = &frm_item_deadline
+	},
+	[M0_RPC_FRM_POLICY_LATENCY] = {
+		.fp_name     = "latency",
+		.fp_is_ready = &frm_link_is_idle,
+		.fp_deadline = &frm_item_deadline
+	},
+	[M0_RPC_FRM_POLICY_THROUGHPUT] = {
+		.fp_name     = "throughput",
+		.fp_is_ready = &frm_never_ready,
+		.fp_deadline = &frm_throughput_deadline
+	},
+	[M0_RPC_FRM_POLICY_ADAPTIVE] = {
+		.fp_name     = "adaptive",
+		.fp_is_ready = &frm_link_is_idle,
+		.fp_deadline = &frm_adaptive_deadline
+	},
+};
+
+M0_BASSERT(ARRAY_SIZE(frm_policies) == M0_RPC_FRM_POLICY_NR);
+
+static const struct frm_policy *frm_policy(const struct m0_rpc_frm *frm)
+{
+	M0_PRE(frm->f_constraints.fc_policy < M0_RPC_FRM_POLICY_NR);
+	return &frm_policies[frm->f_constraints.fc_policy];
+}
+
 #define frm_first_itemq(frm) (&(frm)->f_itemq[0])
 #define frm_end_itemq(frm) (&(frm)->f_itemq[ARRAY_SIZE((frm)->f_itemq)])
 
@@ -178,6 +262,8 @@ M0_INTERNAL void m0_rpc_frm_constraints_get_defaults(struct
 	c->fc_max_nr_segments          = 128;
 	c->fc_max_packet_size          = 4096;
 	c->fc_max_nr_bytes_accumulated = 4096;
+	c->fc_policy                   = M0_RPC_FRM_POLICY_DEADLINE;
+	c->fc_hold                     = M0_RPC_FRM_HOLD_DEF;
 
 	M0_LEAVE();
 }
@@ -186,7 +272,8 @@ static bool
 constraints_are_valid(const struct m0_rpc_frm_constraints *constraints)
 {
 	/** @todo XXX Check whether constraints are consistent */
-	return constraints != NULL;
+	return constraints != NULL &&
+	       constraints->fc_policy < M0_RPC_FRM_POLICY_NR;
 }
 
 static bool frm_is_idle(const struct m0_rpc_frm *frm)
@@ -274,6 +361,7 @@ static void frm_insert(struct m0_rpc_frm *frm, struct m0_rpc_item *item)
 {
 	enum m0_rpc_frm_itemq_type  qtype;
 	struct m0_tl               *q;
+	m0_time_t                   deadline;
 	int                         rc;
 
 	M0_PRE(item != NULL && !itemq_tlink_is_in(item));
@@ -283,6 +371,15 @@ static void frm_insert(struct m0_rpc_frm *frm, struct m0_rpc_item *item)
 		 (unsigned long)item->ri_header.osr_xid);
 	M0_LOG(M0_DEBUG, "priority: %d", item->ri_prio);
 
+	deadline = frm_policy(frm)->fp_deadline(frm, item);
+	if (deadline != item->ri_deadline) {
+		M0_ADDB2_ADD(M0_AVI_RPC_FRM_HOLD, (uint64_t)frm,
+			     frm->f_constraints.fc_policy,
+			     deadline - max64u(item->ri_deadline,
+					       m0_time_now()));
+		item->ri_deadline = deadline;
+		frm->f_nr_held++;
+	}
 	qtype = frm_which_qtype(frm, item);
 	q     = &frm->f_itemq[qtype];
 
@@ -441,6 +538,9 @@ static void frm_balance(struct m0_rpc_frm *frm)
 		}
 		++packet_count;
 		item_count += p->rp_ow.poh_nr_items;
+		M0_ADDB2_ADD(M0_AVI_RPC_FRM_PACKET, (uint64_t)frm,
+			     frm->f_constraints.fc_policy,
+			     p->rp_ow.poh_nr_items, p->rp_size);
 		rc = frm_packet_ready(frm, p);
 		if (rc == 0) {
 			++frm->f_nr_packets_enqed;
@@ -484,7 +584,8 @@ static bool frm_is_ready(const struct m0_rpc_frm *frm)
 	c = &frm->f_constraints;
 	return frm->f_nr_packets_enqed < c->fc_max_nr_packets_enqed &&
 	       (has_urgent_items ||
-		frm->f_nr_bytes_accumulated >= c->fc_max_nr_bytes_accumulated);
+		frm->f_nr_bytes_accumulated >= c->fc_max_nr_bytes_accumulated ||
+		frm_policy(frm)->fp_is_ready(frm));
 }
 
 /**
@@ -676,7 +777,8 @@ static int frm_packet_ready(struct m0_rpc_frm *frm, struct m0_rpc_packet *p)
 	M0_LOG(M0_DEBUG, "nr_items: %llu",
 	       (unsigned long long)p->rp_ow.poh_nr_items);
 
-	p->rp_frm = frm;
+	p->rp_frm    = frm;
+	p->rp_formed = m0_time_now();
 	/* See packet_ready() in rpc/frmops.c */
 	return M0_RC(frm->f_ops->fo_packet_ready(p));
 }
@@ -709,6 +811,12 @@ M0_INTERNAL void m0_rpc_frm_packet_done(struct m0_rpc_packet *p)
 	M0_CNT_DEC(frm->f_nr_packets_enqed);
 	M0_LOG(M0_DEBUG, "nr_packets_enqed: %llu",
 		(unsigned long long)frm->f_nr_packets_enqed);
+	if (p->rp_formed != 0) {
+		m0_time_t t = m0_time_sub(m0_time_now(), p->rp_formed);
+
+		frm->f_packet_time = frm->f_packet_time == 0 ? t :
+			(7 * frm->f_packet_time + t) / 8;
+	}
 
 	if (frm_is_idle(frm))
 		frm->f_state = FRM_IDLE;
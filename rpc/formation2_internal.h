@@ -61,6 +61,10 @@
    - max_nr_packets_enqed
    @see m0_rpc_frm_constraints for more information.
 
+   When items that are not urgent yet are sent, and how long formation may
+   hold an item to fill packets, is decided by a formation policy, see
+   m0_rpc_frm_policy_type.
+
    It is important to note that Formation has something to do only on
    "outgoing path".
 
@@ -76,6 +80,7 @@
 
 #include "lib/types.h"
 #include "lib/tlist.h"
+#include "lib/time.h"
 
 /* Imports */
 struct m0_rpc_packet;
@@ -85,6 +90,49 @@ struct m0_rpc_session;
 /* Forward references */
 struct m0_rpc_frm_ops;
 
+/**
+   Formation policies.
+
+   A policy decides whether formation forms a packet while there are no
+   urgent items and not enough bytes are accumulated, and sets the
+   deadline of an enqueued item, i.e., how long the item can be held in
+   the formation queue to be sent together with the items enqueued after it.
+
+   @see m0_rpc_frm_constraints::fc_policy
+ */
+enum m0_rpc_frm_policy_type {
+	/**
+	   Items wait until their deadlines pass or until
+	   m0_rpc_frm_constraints::fc_max_nr_bytes_accumulated bytes are
+	   accumulated.
+	 */
+	M0_RPC_FRM_POLICY_DEADLINE,
+	/**
+	   Latency first: in addition, all the queued items are sent as soon as
+	   there are no packets in flight.
+	 */
+	M0_RPC_FRM_POLICY_LATENCY,
+	/**
+	   Throughput first: every item is held for at least
+	   m0_rpc_frm_constraints::fc_hold to fill packets.
+	 */
+	M0_RPC_FRM_POLICY_THROUGHPUT,
+	/**
+	   Latency first while there are no packets in flight. Otherwise items
+	   are held for the average packet completion time, observed by
+	   m0_rpc_frm_packet_done(), but not longer than
+	   m0_rpc_frm_constraints::fc_hold: there is no point to send them
+	   before the packets in flight complete.
+	 */
+	M0_RPC_FRM_POLICY_ADAPTIVE,
+	M0_RPC_FRM_POLICY_NR
+};
+
+enum {
+	/** Default m0_rpc_frm_constraints::fc_hold, 1 msec. */
+	M0_RPC_FRM_HOLD_DEF = 1000000,
+};
+
 /**
    Constraints that should be taken into consideration while forming packets.
  */
@@ -116,6 +164,15 @@ struct m0_rpc_frm_constraints {
 	   form RPC packet out of them.
 	 */
 	m0_bcount_t fc_max_nr_bytes_accumulated;
+
+	/** Formation policy, enum m0_rpc_frm_policy_type. */
+	uint32_t    fc_policy;
+
+	/**
+	   Maximal time an item can be held by M0_RPC_FRM_POLICY_THROUGHPUT and
+	   M0_RPC_FRM_POLICY_ADAPTIVE policies.
+	 */
+	m0_time_t   fc_hold;
 };
 
 /**
@@ -227,6 +284,15 @@ struct m0_rpc_frm {
 	/** Limits that formation should respect */
 	struct m0_rpc_frm_constraints  f_constraints;
 
+	/**
+	   Moving average of the time from forming a packet till its
+	   "Packet done" callback.
+	 */
+	m0_time_t                      f_packet_time;
+
+	/** Number of items held by the formation policy. */
+	uint64_t                       f_nr_held;
+
 	const struct m0_rpc_frm_ops   *f_ops;
 
 	/** FRM_MAGIC */
@@ -31,6 +31,8 @@
 
 #include "motr/magic.h"
 #include "net/net.h"
+#include "fop/fop.h"                 /* M0_FOP_XCODE_OBJ */
+#include "fop/fop_item_type.h"       /* m0_fop_item_type_default_encode */
 #include "rpc/rpc_internal.h"
 #include "rpc/service.h"
 
@@ -83,6 +85,14 @@ enum { M0_RPC_TMO = 8 };
 struct rpc_buffer {
 	struct m0_net_buffer   rb_netbuf;
 	struct m0_rpc_packet  *rb_packet;
+	/** Sends the packet from a shard, see packet_shard_send(). */
+	struct m0_rpc_shard_work rb_work;
+	/**
+	 * Serialised packet, with holes for the byte arrays sent by
+	 * reference, or NULL. See rpc_buffer_zc_init().
+	 */
+	void                  *rb_zc_hdr;
+	m0_bcount_t            rb_zc_size;
 	/** see M0_RPC_BUF_MAGIC */
 	uint64_t               rb_magic;
 };
@@ -99,12 +109,19 @@ M0_BOB_DEFINE(static, &rpc_buffer_bob_type, rpc_buffer);
 static int rpc_buffer_init(struct rpc_buffer    *rpcbuf,
 			   struct m0_rpc_packet *p);
 
+static int rpc_buffer_zc_init(struct rpc_buffer    *rpcbuf,
+			      struct m0_rpc_packet *p,
+			      struct m0_net_domain *ndom,
+			      m0_bcount_t           min);
+
 static int rpc_buffer_submit(struct rpc_buffer *rpcbuf);
 
 static void rpc_buffer_fini(struct rpc_buffer *rpcbuf);
 
 static void buf_send_cb(const struct m0_net_buffer_event *ev);
 
+static void packet_shard_send(struct m0_rpc_shard_work *work);
+
 static const struct m0_net_buffer_callbacks rpc_buf_send_cb = {
 	.nbc_cb = {
 		[M0_NET_QT_MSG_SEND] = buf_send_cb
@@ -130,12 +147,17 @@ rpc_buffer__rmachine(const struct rpc_buffer *rpcbuf)
    Serialises packet p and its items in a network buffer and submits it to
    network layer.
 
+   If the machine has send shards, the packet is handed over to the shard of
+   its rpc channel and is accounted in m0_rpc_machine::rm_active_nb from now
+   on. The shard serialises and submits it without the machine lock.
+
    @see m0_rpc_frm_ops::fo_packet_ready()
  */
 static int packet_ready(struct m0_rpc_packet *p)
 {
-	struct rpc_buffer *rpcbuf;
-	int                rc;
+	struct rpc_buffer     *rpcbuf;
+	struct m0_rpc_machine *machine;
+	int                    rc;
 
 	M0_ENTRY("packet: %p", p);
 	M0_PRE(m0_rpc_packet_invariant(p));
@@ -146,6 +168,18 @@ static int packet_ready(struct m0_rpc_packet *p)
 		M0_LOG(M0_ERROR, "Failed to allocate rpcbuf");
 		goto err;
 	}
+	machine = frm_rmachine(p->rp_frm);
+	if (machine->rm_shards_nr > 0) {
+		/* Xid assignment needs the machine lock. */
+		m0_rpc_packet_xids_assign(p);
+		rpcbuf->rb_packet = p;
+		rpcbuf->rb_work.rsw_func = &packet_shard_send;
+		M0_CNT_INC(machine->rm_active_nb);
+		m0_rpc_machine_shard_post(machine,
+					  frm_rchan(p->rp_frm)->rc_shard,
+					  &rpcbuf->rb_work);
+		return M0_RC(0);
+	}
 	rc = rpc_buffer_init(rpcbuf, p);
 	if (rc != 0)
 		goto err_free;
@@ -165,8 +199,12 @@ static int packet_ready(struct m0_rpc_packet *p)
 	}
 
 	rc = rpc_buffer_submit(rpcbuf);
-	if (rc == 0)
+	if (rc == 0) {
+		M0_CNT_INC(machine->rm_active_nb);
+		M0_LOG(M0_DEBUG,"+%p->rm_active_nb: %" PRIi64 " %p\n",
+		       machine, machine->rm_active_nb, rpcbuf);
 		return M0_RC(rc);
+	}
 out:
 	rpc_buffer_fini(rpcbuf);
 err_free:
@@ -178,6 +216,49 @@ err:
 	return M0_RC(rc);
 }
 
+/**
+   Serialises and submits the packet of a shard work queued by
+   packet_ready().
+
+   Runs in the shard thread without the machine lock. Items of the packet
+   are in SENDING state and the packet is not touched by anybody else until
+   buf_send_cb() is called for it.
+ */
+static void packet_shard_send(struct m0_rpc_shard_work *work)
+{
+	struct rpc_buffer     *rpcbuf;
+	struct m0_rpc_packet  *p;
+	struct m0_rpc_machine *machine;
+	int                    rc;
+
+	rpcbuf  = container_of(work, struct rpc_buffer, rb_work);
+	p       = rpcbuf->rb_packet;
+	machine = frm_rmachine(p->rp_frm);
+	M0_ENTRY("packet: %p", p);
+
+	rc = rpc_buffer_init(rpcbuf, p);
+	if (rc == 0) {
+		rc = rpc_buffer_submit(rpcbuf);
+		if (rc == 0) {
+			M0_LEAVE();
+			return;
+		}
+		rpc_buffer_fini(rpcbuf);
+	}
+	m0_free(rpcbuf);
+
+	m0_rpc_machine_lock(machine);
+	m0_rpc_packet_traverse_items(p, item_fail, rc);
+	/* packet_ready() returned 0, so the packet is accounted by frm. */
+	m0_rpc_frm_packet_done(p);
+	m0_rpc_packet_discard(p);
+	M0_CNT_DEC(machine->rm_active_nb);
+	if (machine->rm_active_nb == 0)
+		m0_chan_broadcast(&machine->rm_nb_idle);
+	m0_rpc_machine_unlock(machine);
+	M0_LEAVE("rc: %d", rc);
+}
+
 /**
    Initialises rpcbuf, allocates network buffer of size enough to
    accomodate serialised packet p.
@@ -199,17 +280,27 @@ static int rpc_buffer_init(struct rpc_buffer    *rpcbuf,
 	M0_ASSERT(ndom != NULL);
 
 	netbuf = &rpcbuf->rb_netbuf;
-	rc = net_buffer_allocate(netbuf, ndom, p->rp_size);
-	if (rc != 0)
-		goto out;
-
-	rc = m0_rpc_packet_encode(p, &netbuf->nb_buffer);
-	if (rc != 0) {
-		net_buffer_free(netbuf, ndom);
+	rchan  = frm_rchan(p->rp_frm);
+	rpcbuf->rb_zc_hdr = NULL;
+	p->rp_compress = machine->rm_compress_min > 0 && rchan->rc_compress &&
+			 p->rp_size >= machine->rm_compress_min;
+	rc = machine->rm_zerocopy_min > 0 && !p->rp_compress ?
+		rpc_buffer_zc_init(rpcbuf, p, ndom, machine->rm_zerocopy_min) :
+		-ENOENT;
+	if (rc == -ENOENT) {
+		rc = net_buffer_allocate(netbuf, ndom, p->rp_size);
+		if (rc != 0)
+			goto out;
+
+		rc = m0_rpc_packet_encode(p, &netbuf->nb_buffer);
+		if (rc != 0) {
+			net_buffer_free(netbuf, ndom);
+			goto out;
+		}
+	} else if (rc != 0)
 		goto out;
-	}
-	rchan = frm_rchan(p->rp_frm);
-	netbuf->nb_length = m0_vec_count(&netbuf->nb_buffer.ov_vec);
+	netbuf->nb_length = p->rp_zsize != 0 ? m0_rpc_packet_onwire_size(p) :
+		m0_vec_count(&netbuf->nb_buffer.ov_vec);
 	netbuf->nb_ep     = rchan->rc_destep;
 
 	rpcbuf->rb_packet = p;
@@ -219,6 +310,181 @@ out:
 	return M0_RC(rc);
 }
 
+enum { RPC_ZC_REFS_MAX = 32 };
+
+/** A byte array sent by reference. */
+struct rpc_zc_ref {
+	/** Offset of the array in the serialised packet. */
+	m0_bcount_t  zr_offset;
+	void        *zr_addr;
+	m0_bcount_t  zr_nob;
+};
+
+/** Byte arrays of a packet to be sent by reference. */
+struct rpc_zc_plan {
+	struct m0_xcode_ctx zp_ctx;
+	/** Offset of the fop being sized in the serialised packet. */
+	m0_bcount_t         zp_base;
+	uint32_t            zp_nr;
+	struct rpc_zc_ref   zp_ref[RPC_ZC_REFS_MAX];
+};
+
+static int zc_array(struct m0_xcode_ctx *ctx, m0_bcount_t offset,
+		    void *addr, m0_bcount_t nob)
+{
+	struct rpc_zc_plan *plan = container_of(ctx, struct rpc_zc_plan,
+						zp_ctx);
+
+	if (plan->zp_nr < ARRAY_SIZE(plan->zp_ref))
+		plan->zp_ref[plan->zp_nr++] = (struct rpc_zc_ref) {
+			.zr_offset = plan->zp_base + offset,
+			.zr_addr   = addr,
+			.zr_nob    = nob
+		};
+	return 0;
+}
+
+/**
+   Collects byte arrays of the packet fops long enough to be sent by
+   reference.
+
+   Only fops encoded by m0_fop_item_type_default_encode() are looked at: for
+   them the offset of the fop in the serialised item is known.
+ */
+static void zc_plan_build(struct rpc_zc_plan *plan, struct m0_rpc_packet *p,
+			  m0_bcount_t min)
+{
+	struct m0_rpc_item *item;
+	m0_bcount_t         offset = m0_rpc_packet_onwire_header_size();
+	int                 rc;
+
+	for_each_item_in_packet(item, p) {
+		if (item->ri_type->rit_ops->rito_encode ==
+		    &m0_fop_item_type_default_encode) {
+			m0_xcode_ctx_init(&plan->zp_ctx, &M0_FOP_XCODE_OBJ(
+					  m0_rpc_item_to_fop(item)));
+			plan->zp_ctx.xcx_array     = &zc_array;
+			plan->zp_ctx.xcx_array_min = min;
+			plan->zp_base = offset +
+				m0_rpc_item_onwire_header_size;
+			rc = m0_xcode_length(&plan->zp_ctx);
+			M0_ASSERT(rc >= 0);
+		}
+		offset += m0_rpc_item_size(item);
+	} end_for_each_item_in_packet;
+}
+
+/**
+   Fills (if bv is not NULL) and counts segments covering nob bytes at addr,
+   starting from segment idx.
+ */
+static uint32_t zc_slice(struct m0_bufvec *bv, uint32_t idx, char *addr,
+			 m0_bcount_t nob, m0_bcount_t seg_max)
+{
+	m0_bcount_t step;
+
+	for (; nob > 0; addr += step, nob -= step, ++idx) {
+		step = min64u(nob, seg_max);
+		if (bv != NULL) {
+			bv->ov_buf[idx] = addr;
+			bv->ov_vec.v_count[idx] = step;
+		}
+	}
+	return idx;
+}
+
+/**
+   Fills (if bv is not NULL) and counts segments of the network buffer:
+   slices of hdr interleaved with the byte arrays of the plan.
+ */
+static uint32_t zc_layout(const struct rpc_zc_plan *plan,
+			  struct m0_bufvec *bv, char *hdr, m0_bcount_t size,
+			  m0_bcount_t seg_max)
+{
+	const struct rpc_zc_ref *ref;
+	m0_bcount_t              pos = 0;
+	uint32_t                 idx = 0;
+	uint32_t                 i;
+
+	for (i = 0; i < plan->zp_nr; ++i) {
+		ref = &plan->zp_ref[i];
+		idx = zc_slice(bv, idx, hdr + pos, ref->zr_offset - pos,
+			       seg_max);
+		idx = zc_slice(bv, idx, ref->zr_addr, ref->zr_nob, seg_max);
+		pos = ref->zr_offset + ref->zr_nob;
+	}
+	return zc_slice(bv, idx, hdr + pos, size - pos, seg_max);
+}
+
+/**
+   Sets up the network buffer to send large byte arrays of packet fops by
+   reference, see m0_rpc_machine::rm_zerocopy_min.
+
+   The rest of the packet is encoded into rb_zc_hdr, a buffer as large as the
+   whole serialised packet, so that the encoding sees the same offsets and
+   alignment as in a contiguous buffer. Holes of rb_zc_hdr under the arrays
+   are not used. The encoder skips an array when the cursor already points
+   to it, see m0_xcode_ctx::xcx_array.
+
+   @retval -ENOENT nothing to send by reference, the packet should be copied
+ */
+static int rpc_buffer_zc_init(struct rpc_buffer    *rpcbuf,
+			      struct m0_rpc_packet *p,
+			      struct m0_net_domain *ndom,
+			      m0_bcount_t           min)
+{
+	struct m0_net_buffer    *netbuf   = &rpcbuf->rb_netbuf;
+	struct m0_bufvec        *bv       = &netbuf->nb_buffer;
+	m0_bcount_t              size     = m0_align(p->rp_size, 8);
+	m0_bcount_t              seg_max  = m0_rpc_max_seg_size(ndom);
+	uint32_t                 segs_max = m0_rpc_max_segs_nr(ndom);
+	struct rpc_zc_plan      *plan;
+	struct m0_bufvec_cursor  cur;
+	uint32_t                 nr;
+	int                      rc;
+
+	M0_ENTRY("rbuf: %p packet: %p", rpcbuf, p);
+
+	M0_ALLOC_PTR(plan);
+	if (plan == NULL)
+		return M0_ERR(-ENOMEM);
+	zc_plan_build(plan, p, min);
+	if (plan->zp_nr == 0) {
+		m0_free(plan);
+		return M0_RC(-ENOENT);
+	}
+	M0_SET0(netbuf);
+	rpcbuf->rb_zc_size = size;
+	rpcbuf->rb_zc_hdr  = m0_alloc_aligned(size, M0_SEG_SHIFT);
+	if (rpcbuf->rb_zc_hdr == NULL) {
+		m0_free(plan);
+		return M0_ERR(-ENOMEM);
+	}
+	/* Send trailing arrays by copy, if segments are not enough. */
+	while ((nr = zc_layout(plan, NULL, rpcbuf->rb_zc_hdr, size,
+			       seg_max)) > segs_max && plan->zp_nr > 0)
+		--plan->zp_nr;
+	rc = plan->zp_nr > 0 ? m0_bufvec_empty_alloc(bv, nr) : -ENOENT;
+	if (rc == 0) {
+		zc_layout(plan, bv, rpcbuf->rb_zc_hdr, size, seg_max);
+		rc = m0_net_buffer_register(netbuf, ndom);
+		if (rc == 0) {
+			m0_bufvec_cursor_init(&cur, bv);
+			rc = m0_rpc_packet_encode_using_cursor(p, &cur);
+			if (rc != 0)
+				m0_net_buffer_deregister(netbuf, ndom);
+		}
+		if (rc != 0)
+			m0_bufvec_free2(bv);
+	}
+	if (rc != 0) {
+		m0_free_aligned(rpcbuf->rb_zc_hdr, size, M0_SEG_SHIFT);
+		rpcbuf->rb_zc_hdr = NULL;
+	}
+	m0_free(plan);
+	return M0_RC(rc);
+}
+
 /**
    Allocates network buffer and register it with network domain ndom.
  */
@@ -336,11 +602,6 @@ static int rpc_buffer_submit(struct rpc_buffer *rpcbuf)
 	machine = rpc_buffer__rmachine(rpcbuf);
 	netbuf->nb_timeout = m0_time_from_now(M0_RPC_TMO, 0);
 	rc = m0_net_buffer_add(netbuf, &machine->rm_tm);
-	if (rc == 0) {
-		M0_CNT_INC(machine->rm_active_nb);
-		M0_LOG(M0_DEBUG,"+%p->rm_active_nb: %" PRIi64 " %p\n",
-		       machine, machine->rm_active_nb, rpcbuf);
-	}
 
 	return M0_RC(rc);
 }
@@ -357,7 +618,13 @@ static void rpc_buffer_fini(struct rpc_buffer *rpcbuf)
 	ndom    = machine->rm_tm.ntm_dom;
 	M0_ASSERT(ndom != NULL);
 
-	net_buffer_free(&rpcbuf->rb_netbuf, ndom);
+	if (rpcbuf->rb_zc_hdr != NULL) {
+		m0_net_buffer_deregister(&rpcbuf->rb_netbuf, ndom);
+		m0_bufvec_free2(&rpcbuf->rb_netbuf.nb_buffer);
+		m0_free_aligned(rpcbuf->rb_zc_hdr, rpcbuf->rb_zc_size,
+				M0_SEG_SHIFT);
+	} else
+		net_buffer_free(&rpcbuf->rb_netbuf, ndom);
 	rpc_buffer_bob_fini(rpcbuf);
 
 	M0_LEAVE();
@@ -405,6 +672,14 @@ static void buf_send_cb(const struct m0_net_buffer_event *ev)
 	if (p->rp_status == 0) {
 		stats->rs_nr_sent_packets++;
 		stats->rs_nr_sent_bytes += p->rp_size;
+		if (p->rp_zsize != 0) {
+			stats->rs_nr_zsent_packets++;
+			stats->rs_nr_zsent_raw_bytes += p->rp_size -
+				m0_rpc_packet_onwire_header_size() -
+				m0_rpc_packet_onwire_footer_size();
+			stats->rs_nr_zsent_bytes += p->rp_zsize;
+			stats->rs_zsent_time += p->rp_ztime;
+		}
 	} else {
                 stats->rs_nr_failed_packets++;
 	}
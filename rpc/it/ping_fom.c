@@ -66,6 +66,8 @@ M0_INTERNAL int m0_fom_ping_state(struct m0_fom *fom)
 	M0_ASSERT(fop != NULL);
 	ping_fop_rep = m0_fop_data(fop);
 	ping_fop_rep->fpr_rc = 0;
+	ping_fop_rep->fpr_svc_time = m0_time_sub(m0_time_now(),
+						 fom_obj->fp_created);
 	item = m0_fop_to_rpc_item(fop);
 	m0_rpc_reply_post(&fom_obj->fp_fop->f_item, item);
 	m0_fom_phase_set(fom, M0_FOPH_FINISH);
@@ -89,6 +91,7 @@ static int ping_fop_fom_create(struct m0_fop *fop, struct m0_fom **m,
 	m0_fom_init(fom, &fop->f_type->ft_fom_type, &m0_fom_ping_ops, fop,
 		    NULL, reqh);
 	fom_obj->fp_fop = fop;
+	fom_obj->fp_created = m0_time_now();
 	*m = fom;
 	return 0;
 }
@@ -36,6 +36,8 @@ struct m0_fom_ping {
         struct m0_fom                    fp_gen;
 	/** FOP associated with this FOM. */
         struct m0_fop			*fp_fop;
+	/** Time of FOM creation. */
+	m0_time_t			 fp_created;
 };
 
 /**
@@ -55,7 +55,9 @@ struct m0_fop_ping {
 } M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
 
 struct m0_fop_ping_rep {
-	int32_t fpr_rc;
+	int32_t  fpr_rc;
+	/** Time the server spent on the fop, from fom creation to reply. */
+	uint64_t fpr_svc_time;
 } M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
 
 /* __MOTR_RPC_IT_PING_FOP_H__ */
@@ -54,6 +54,9 @@
 #  include <arpa/inet.h>
 #  include <netdb.h>
 #  include "module/instance.h"  /* m0 */
+#  include "lib/mutex.h"
+#  include "lib/semaphore.h"
+#  include "net/test/stats.h"   /* m0_net_test_stats */
 #endif
 
 #define SERVER_ENDPOINT_ADDR "0@lo:12345:34:1"
@@ -92,6 +95,79 @@ static int   max_rpc_msg_size  = M0_RPC_DEF_MAX_RPC_MSG_SIZE;
 static char client_endpoint[M0_NET_LNET_XEP_ADDR_LEN];
 static char server_endpoint[M0_NET_LNET_XEP_ADDR_LEN];
 
+#ifndef __KERNEL__
+/**
+ * Load generation.
+ *
+ * Each client thread keeps up to ops_in_flight fops posted. Fops are picked
+ * according to the weights of the mix and the latency of every phase of a
+ * fop is recorded, so that rpc, network and service time can be told apart.
+ */
+
+/** Kinds of fops sent by client threads. */
+enum ping_op {
+	/** Ping fop without payload. */
+	OP_NULL,
+	/** Ping fop of nr_ping_bytes. */
+	OP_PING,
+	OP_NR
+};
+
+/** Phases of a fop, latencies are collected per phase. */
+enum ping_phase {
+	/** From m0_rpc_post() till the item is sent: rpc formation. */
+	PH_QUEUE,
+	/** From sending till the reply, without PH_SERVICE: the network. */
+	PH_WIRE,
+	/** Processing of the fop by the server. */
+	PH_SERVICE,
+	/** From m0_rpc_post() till the reply. */
+	PH_TOTAL,
+	PH_NR
+};
+
+enum {
+	/** Histogram buckets: [2^(i-1), 2^i) microseconds. */
+	HIST_NR = 32,
+};
+
+struct ping_phase_stats {
+	struct m0_net_test_stats pps_stats;
+	uint64_t                 pps_hist[HIST_NR];
+};
+
+/** A posted fop. */
+struct ping_slot {
+	struct m0_fop       *ps_fop;
+	struct m0_semaphore *ps_sem;
+	enum ping_op         ps_op;
+	m0_time_t            ps_posted;
+	m0_time_t            ps_sent;
+	bool                 ps_done;
+};
+
+static const char *op_names[OP_NR] = {
+	[OP_NULL] = "null",
+	[OP_PING] = "ping",
+};
+
+static const char *phase_names[PH_NR] = {
+	[PH_QUEUE]   = "queue",
+	[PH_WIRE]    = "wire",
+	[PH_SERVICE] = "service",
+	[PH_TOTAL]   = "total",
+};
+
+static int                     ops_in_flight = 1;
+static const char             *fop_mix       = "ping:1";
+static uint32_t                mix[OP_NR];
+static uint32_t                mix_total;
+/** Protects load_stats and load_failed. */
+static struct m0_mutex         load_lock;
+static struct ping_phase_stats load_stats[OP_NR][PH_NR];
+static uint64_t                load_failed;
+#endif
+
 
 #ifdef __KERNEL__
 /* Module parameters */
@@ -268,6 +344,223 @@ static void send_ping_fop(struct m0_rpc_session *session)
 	m0_fop_put_lock(fop);
 }
 
+#ifndef __KERNEL__
+/** Parses the fop mix, e.g. "null:1,ping:3". */
+static int mix_parse(const char *str)
+{
+	char     name[16];
+	uint32_t weight;
+	int      n;
+	int      i;
+
+	M0_SET0(&mix);
+	mix_total = 0;
+	while (sscanf(str, " %15[a-z]:%u%n", name, &weight, &n) == 2) {
+		for (i = 0; i < OP_NR; ++i) {
+			if (strcmp(name, op_names[i]) == 0)
+				break;
+		}
+		if (i == OP_NR)
+			return -EINVAL;
+		mix[i] += weight;
+		mix_total += weight;
+		str += n;
+		if (*str == ',')
+			++str;
+	}
+	return *str == 0 && mix_total > 0 ? 0 : -EINVAL;
+}
+
+/** Returns the kind of the n-th fop of a thread, following the mix. */
+static enum ping_op mix_op(uint64_t n)
+{
+	uint32_t pick = n % mix_total;
+	int      i;
+
+	for (i = 0; pick >= mix[i]; ++i)
+		pick -= mix[i];
+	return i;
+}
+
+static void phase_add(enum ping_op op, enum ping_phase ph, m0_time_t t)
+{
+	struct ping_phase_stats *s = &load_stats[op][ph];
+	uint64_t                 us = t / 1000;
+	int                      b = 0;
+
+	m0_net_test_stats_time_add(&s->pps_stats, t);
+	while (us != 0 && b < HIST_NR - 1) {
+		us >>= 1;
+		++b;
+	}
+	s->pps_hist[b]++;
+}
+
+static void load_item_sent(struct m0_rpc_item *item)
+{
+	struct ping_slot *slot = m0_rpc_item_to_fop(item)->f_opaque;
+
+	/* Called again on resend, the first send is what counts. */
+	if (slot->ps_sent == 0)
+		slot->ps_sent = m0_time_now();
+}
+
+static void load_item_replied(struct m0_rpc_item *item)
+{
+	struct ping_slot       *slot = m0_rpc_item_to_fop(item)->f_opaque;
+	struct m0_fop_ping_rep *reply = NULL;
+	m0_time_t               now = m0_time_now();
+	m0_time_t               total;
+	m0_time_t               queue;
+	m0_time_t               svc = 0;
+	int                     rc;
+
+	rc = m0_rpc_item_error(item);
+	if (rc == 0) {
+		reply = m0_fop_data(m0_rpc_item_to_fop(item->ri_reply));
+		rc = reply->fpr_rc;
+		svc = reply->fpr_svc_time;
+	}
+	total = m0_time_sub(now, slot->ps_posted);
+	queue = slot->ps_sent == 0 ? 0 : m0_time_sub(slot->ps_sent,
+						     slot->ps_posted);
+	m0_mutex_lock(&load_lock);
+	if (rc == 0) {
+		phase_add(slot->ps_op, PH_QUEUE, queue);
+		phase_add(slot->ps_op, PH_WIRE, total > queue + svc ?
+			  total - queue - svc : 0);
+		phase_add(slot->ps_op, PH_SERVICE, svc);
+		phase_add(slot->ps_op, PH_TOTAL, total);
+	} else
+		load_failed++;
+	m0_mutex_unlock(&load_lock);
+	slot->ps_done = true;
+	m0_semaphore_up(slot->ps_sem);
+}
+
+static const struct m0_rpc_item_ops load_item_ops = {
+	.rio_sent    = load_item_sent,
+	.rio_replied = load_item_replied,
+};
+
+static void load_fop_post(struct m0_rpc_session *session,
+			  struct ping_slot *slot, enum ping_op op)
+{
+	struct m0_fop      *fop;
+	struct m0_fop_ping *ping_fop;
+	struct m0_rpc_item *item;
+	uint32_t            nr = 0;
+	const size_t        sz = sizeof ping_fop->fp_arr.f_data[0];
+
+	if (op == OP_PING)
+		nr = nr_ping_bytes / sz + !(nr_ping_bytes % sz);
+	fop = m0_fop_alloc_at(session, &m0_fop_ping_fopt);
+	M0_ASSERT(fop != NULL);
+	ping_fop = m0_fop_data(fop);
+	ping_fop->fp_arr.f_count = nr;
+	if (nr != 0) {
+		M0_ALLOC_ARR(ping_fop->fp_arr.f_data, nr);
+		M0_ASSERT(ping_fop->fp_arr.f_data != NULL);
+	}
+	slot->ps_fop = fop;
+	slot->ps_op = op;
+	slot->ps_sent = 0;
+	slot->ps_done = false;
+	fop->f_opaque = slot;
+
+	item = &fop->f_item;
+	item->ri_ops             = &load_item_ops;
+	item->ri_session         = session;
+	item->ri_prio            = M0_RPC_ITEM_PRIO_MID;
+	item->ri_deadline        = M0_TIME_IMMEDIATELY;
+	item->ri_resend_interval = M0_TIME_ONE_MSEC * 50;
+	item->ri_nr_sent_max     = MAX_RETRIES;
+	slot->ps_posted = m0_time_now();
+	M0_ASSERT(m0_rpc_post(item) == 0);
+}
+
+/** Releases the fops which got replies. */
+static void load_slots_reap(struct ping_slot *slots)
+{
+	int i;
+
+	for (i = 0; i < ops_in_flight; ++i) {
+		if (slots[i].ps_fop != NULL && slots[i].ps_done) {
+			m0_fop_put_lock(slots[i].ps_fop);
+			slots[i].ps_fop = NULL;
+		}
+	}
+}
+
+static void rpcping_thread(struct m0_rpc_session *session)
+{
+	struct m0_semaphore  sem;
+	struct ping_slot    *slots;
+	int                  i;
+	int                  j;
+
+	M0_ALLOC_ARR(slots, ops_in_flight);
+	M0_ASSERT(slots != NULL);
+	m0_semaphore_init(&sem, ops_in_flight);
+	for (i = 0; i < ops_in_flight; ++i)
+		slots[i].ps_sem = &sem;
+	for (i = 0; i < nr_ping_item; ++i) {
+		m0_semaphore_down(&sem);
+		load_slots_reap(slots);
+		for (j = 0; slots[j].ps_fop != NULL; ++j)
+			;
+		load_fop_post(session, &slots[j], mix_op(i));
+	}
+	for (i = 0; i < ops_in_flight; ++i)
+		m0_semaphore_down(&sem);
+	load_slots_reap(slots);
+	m0_semaphore_fini(&sem);
+	m0_free(slots);
+}
+
+static void load_stats_print(void)
+{
+	struct ping_phase_stats *s;
+	int                      op;
+	int                      ph;
+	int                      b;
+
+	printf("failed: %llu\n", (unsigned long long)load_failed);
+	for (op = 0; op < OP_NR; ++op) {
+		if (load_stats[op][PH_TOTAL].pps_stats.nts_count == 0)
+			continue;
+		printf("%s: %lu fops, latency in us:\n", op_names[op],
+		       load_stats[op][PH_TOTAL].pps_stats.nts_count);
+		printf("\t%-8s %10s %10s %10s %10s\n", "phase", "min", "avg",
+		       "stddev", "max");
+		for (ph = 0; ph < PH_NR; ++ph) {
+			s = &load_stats[op][ph];
+			printf("\t%-8s %10llu %10llu %10llu %10llu\n",
+			       phase_names[ph],
+			       (unsigned long long)
+			       m0_net_test_stats_time_min(&s->pps_stats) / 1000,
+			       (unsigned long long)
+			       m0_net_test_stats_time_avg(&s->pps_stats) / 1000,
+			       (unsigned long long)
+			       m0_net_test_stats_time_stddev(&s->pps_stats) /
+			       1000,
+			       (unsigned long long)
+			       m0_net_test_stats_time_max(&s->pps_stats) / 1000);
+		}
+		for (ph = 0; ph < PH_NR; ++ph) {
+			s = &load_stats[op][ph];
+			printf("\t%s histogram (us < count):", phase_names[ph]);
+			for (b = 0; b < HIST_NR; ++b) {
+				if (s->pps_hist[b] != 0)
+					printf(" %llu:%llu", 1ULL << b,
+					       (unsigned long long)
+					       s->pps_hist[b]);
+			}
+			printf("\n");
+		}
+	}
+}
+#else
 static void rpcping_thread(struct m0_rpc_session *session)
 {
 	int i;
@@ -275,11 +568,15 @@ static void rpcping_thread(struct m0_rpc_session *session)
 	for (i = 0; i < nr_ping_item; ++i)
 		send_ping_fop(session);
 }
+#endif
 
 static int run_client(void)
 {
 	int               rc;
 	int               i;
+#ifndef __KERNEL__
+	int               j;
+#endif
 	struct m0_thread *client_thread;
 
 	/*
@@ -324,6 +621,13 @@ static int run_client(void)
 		goto net_dom_fini;
 	}
 	M0_ALLOC_ARR(client_thread, nr_client_threads);
+#ifndef __KERNEL__
+	m0_mutex_init(&load_lock);
+	for (i = 0; i < OP_NR; ++i) {
+		for (j = 0; j < PH_NR; ++j)
+			m0_net_test_stats_reset(&load_stats[i][j].pps_stats);
+	}
+#endif
 
 	start = m0_time_now();
 	for (i = 0; i < nr_client_threads; i++) {
@@ -341,6 +645,10 @@ static int run_client(void)
 	}
 
 	delta = m0_time_sub(m0_time_now(), start);
+#ifndef __KERNEL__
+	load_stats_print();
+	m0_mutex_fini(&load_lock);
+#endif
 
 	rc = m0_rpc_client_stop_stats(&cctx, &__print_stats);
 	if (verbose)
@@ -477,10 +785,18 @@ int main(int argc, char *argv[])
 				   "%i", &tm_recv_queue_len),
 		M0_FORMATARG('m', "maximum RPC msg size", "%i",
 						&max_rpc_msg_size),
+		M0_FORMATARG('w', "fops in flight per client thread", "%i",
+						&ops_in_flight),
+		M0_STRINGARG('x', "fop mix, e.g. \"null:1,ping:3\"",
+			LAMBDA(void, (const char *str) { fop_mix = str; })),
 		M0_FLAGARG('v', "verbose", &verbose)
 		);
 	if (rc != 0)
 		return -rc;
+	if (!server_mode && (ops_in_flight < 1 || mix_parse(fop_mix) != 0)) {
+		printf("m0rpcping: invalid -w or -x\n");
+		return EINVAL;
+	}
 
 	if (server_mode)
 		rc = run_server();
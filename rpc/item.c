@@ -37,6 +37,7 @@
 #include "rpc/addb2.h"
 #include "rpc/rpc_internal.h"
 #include "rpc/rpc_opcodes_xc.h" /* m0_xc_M0_RPC_OPCODES_enum */
+#include "fop/fop.h"            /* m0_fop_data */
 #include "motr/iem.h"
 
 /**
@@ -736,6 +737,7 @@ M0_INTERNAL void m0_rpc_item_change_state(struct m0_rpc_item *item,
 	       item_state_name(item), m0_sm_state_name(&item->ri_sm, state),
 	       item->ri_sm.sm_conf->scf_name);
 
+	m0_rpc_item_lat_note(item, state);
 	m0_sm_state_set(&item->ri_sm, state);
 }
 
@@ -1461,6 +1463,32 @@ static void addb2_add_rpc_attrs(const struct m0_rpc_item *req)
 		     M0_AVI_RPC_ATTR_NR_SENT, req->ri_nr_sent);
 }
 
+/**
+ * Returns true iff the receiver refused the request because it was
+ * overloaded. Other -EBUSY replies of services are not refusals.
+ */
+static bool item_reply_is_busy(const struct m0_rpc_item *reply)
+{
+	return (reply->ri_flags & M0_RIF_BUSY) != 0;
+}
+
+/**
+ * Makes the session hold new requests for a while after a busy reply, with
+ * exponential backoff, see m0_rpc_session::s_busy_until.
+ */
+static void item_busy_hold(struct m0_rpc_item *req, struct m0_rpc_item *reply)
+{
+	struct m0_rpc_session *sess = req->ri_session;
+
+	if (item_reply_is_busy(reply)) {
+		sess->s_busy_hold = min64u(max64u(sess->s_busy_hold * 2,
+						  M0_RPC_SESSION_BUSY_HOLD_MIN),
+					   M0_RPC_SESSION_BUSY_HOLD_MAX);
+		sess->s_busy_until = m0_time_from_now(0, sess->s_busy_hold);
+	} else
+		sess->s_busy_hold = 0;
+}
+
 M0_INTERNAL void m0_rpc_item_process_reply(struct m0_rpc_item *req,
 					   struct m0_rpc_item *reply)
 {
@@ -1474,6 +1502,7 @@ M0_INTERNAL void m0_rpc_item_process_reply(struct m0_rpc_item *req,
 	m0_rpc_item_timer_stop(req);
 	m0_rpc_conn_ha_timer_stop(item2conn(req));
 	req->ri_reply = reply;
+	item_busy_hold(req, reply);
 	m0_rpc_item_replied_invoke(req);
 	m0_rpc_item_change_state(req, M0_RPC_ITEM_REPLIED);
 	m0_rpc_item_pending_cache_del(req);
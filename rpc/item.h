@@ -200,6 +200,11 @@ struct m0_rpc_item {
 	const struct m0_rpc_item_type	*ri_type;
 	/** Time spent in rpc layer. */
 	m0_time_t			 ri_rpc_time;
+	/**
+	   Start of the current latency phase of the request, 0 when the
+	   request is not measured, see m0_rpc_opstats.
+	 */
+	m0_time_t			 ri_lat_mark;
 	/** List of compound items. */
 	struct m0_tl			 ri_compound_items;
 	/** Link through which items are anchored on list of
@@ -251,6 +256,12 @@ enum m0_rpc_item_flags {
 	 * Sender already has the reply.
 	 */
 	M0_RIF_REPLIED = 1 << 1,
+	/**
+	 * Set in a reply to a request refused by the admission control of the
+	 * receiver (m0_reqh_service::rs_fom_max, m0_reqh::rh_runq_max). The
+	 * sender session backs off, see m0_rpc_session::s_busy_until.
+	 */
+	M0_RIF_BUSY = 1 << 2,
 };
 
 struct m0_rpc_item_ops {
@@ -58,6 +58,16 @@ M0_INTERNAL void m0_rpc_item_sm_fini(struct m0_rpc_item *item);
 
 M0_INTERNAL void m0_rpc_item_change_state(struct m0_rpc_item *item,
 					  enum m0_rpc_item_state state);
+/**
+   Accounts the transition of the request to state in the latency statistics
+   of its machine. Called before the state is changed.
+
+   @see m0_rpc_opstats
+ */
+M0_INTERNAL void m0_rpc_item_lat_note(struct m0_rpc_item *item,
+				      enum m0_rpc_item_state state);
+/** Accounts the service time of the incoming request, when it is replied. */
+M0_INTERNAL void m0_rpc_item_lat_served(const struct m0_rpc_item *request);
 M0_INTERNAL void m0_rpc_item_failed(struct m0_rpc_item *item, int32_t rc);
 
 M0_INTERNAL int m0_rpc_item_timer_start(struct m0_rpc_item *item);
@@ -67,6 +67,14 @@ enum {
 	M0_RPC_ITEM_FORMAT_VERSION   = M0_RPC_ITEM_FORMAT_VERSION_1,
 };
 
+/** Flags of an rpc packet, m0_rpc_packet_onwire_header::poh_flags. */
+enum m0_rpc_packet_flags {
+	/** Items of the packet are compressed with lz4. */
+	M0_RPC_PACKET_LZ4    = 1 << 0,
+	/** Sender of the packet accepts lz4 compressed packets. */
+	M0_RPC_PACKET_LZ4_OK = 1 << 1,
+};
+
 struct m0_rpc_packet_onwire_header {
 	struct m0_format_header poh_header;
 	/* Version */
@@ -74,6 +82,14 @@ struct m0_rpc_packet_onwire_header {
 	/** Number of RPC items in packet */
 	uint32_t                poh_nr_items;
 	uint64_t                poh_magic;
+	/** Flags, taken from enum m0_rpc_packet_flags. */
+	uint32_t                poh_flags;
+	/**
+	 * Size of the compressed items when M0_RPC_PACKET_LZ4 is set.
+	 * The size of the items before compression is derived from the size
+	 * of the packet in poh_header.
+	 */
+	uint32_t                poh_zsize;
 } M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
 
 struct m0_rpc_packet_onwire_footer {
@@ -37,6 +37,13 @@
 #include "addb2/addb2.h"
 #include "rpc/addb2.h"
 
+#if defined(HAVE_LZ4) && !defined(__KERNEL__)
+#include <lz4.h>                        /* LZ4_compress_default */
+#define RPC_LZ4 (1)
+#else
+#define RPC_LZ4 (0)
+#endif
+
 
 /**
  * @addtogroup rpc
@@ -314,6 +321,135 @@ static int item_encode(struct m0_rpc_item       *item,
 	return M0_RC(rc);
 }
 
+static m0_bcount_t packet_items_size(m0_bcount_t packet_size)
+{
+	return packet_size - m0_rpc_packet_onwire_header_size() -
+		m0_rpc_packet_onwire_footer_size();
+}
+
+M0_INTERNAL m0_bcount_t
+m0_rpc_packet_onwire_size(const struct m0_rpc_packet *p)
+{
+	return m0_align(p->rp_zsize == 0 ? p->rp_size :
+			m0_rpc_packet_onwire_header_size() + p->rp_zsize +
+			m0_rpc_packet_onwire_footer_size(), 8);
+}
+
+/**
+   Encodes the items of the packet into a contiguous buffer and compresses
+   them.
+
+   If the compressed items are smaller, returns them in *zbuf, which is to
+   be freed by the caller, and sets packet->rp_zsize. Otherwise *zbuf is
+   NULL.
+ */
+static int packet_items_compress(struct m0_rpc_packet *packet, void **zbuf)
+{
+#if RPC_LZ4
+	struct m0_rpc_item      *item;
+	struct m0_bufvec_cursor  cur;
+	m0_bcount_t              size  = packet_items_size(packet->rp_size);
+	void                    *buf   = m0_alloc(size);
+	struct m0_bufvec         bv    = M0_BUFVEC_INIT_BUF(&buf, &size);
+	int                      bound = LZ4_compressBound(size);
+	m0_time_t                start = m0_time_now();
+	int                      zsize;
+	int                      rc    = 0;
+
+	M0_PRE(size <= LZ4_MAX_INPUT_SIZE);
+
+	*zbuf = m0_alloc(bound);
+	if (buf == NULL || *zbuf == NULL) {
+		/* Just send the packet uncompressed. */
+		m0_free(buf);
+		m0_free(*zbuf);
+		*zbuf = NULL;
+		return M0_RC(0);
+	}
+	m0_bufvec_cursor_init(&cur, &bv);
+	for_each_item_in_packet(item, packet) {
+		rc = item_encode(item, &cur);
+		if (rc != 0)
+			break;
+	} end_for_each_item_in_packet;
+	if (rc == 0) {
+		zsize = LZ4_compress_default(buf, *zbuf, size, bound);
+		if (zsize > 0 && zsize < size)
+			packet->rp_zsize = zsize;
+	}
+	m0_free(buf);
+	if (packet->rp_zsize == 0) {
+		m0_free(*zbuf);
+		*zbuf = NULL;
+	}
+	packet->rp_ztime = m0_time_sub(m0_time_now(), start);
+	return M0_RC(rc);
+#else
+	*zbuf = NULL;
+	return 0;
+#endif
+}
+
+/**
+   Reads zsize bytes of compressed items from the cursor and decompresses
+   them into *raw, which is to be freed by the caller.
+ */
+static int packet_items_decompress(struct m0_rpc_packet    *p,
+				   struct m0_bufvec_cursor *cursor,
+				   m0_bcount_t zsize, m0_bcount_t size,
+				   void **raw)
+{
+#if RPC_LZ4
+	void      *zbuf;
+	m0_time_t  start = m0_time_now();
+	int        rc;
+
+	/* lz4 does not compress better than 255:1. */
+	if (zsize == 0 || size > LZ4_MAX_INPUT_SIZE || size > zsize * 255)
+		return M0_ERR(-EPROTO);
+	zbuf = m0_alloc(zsize);
+	*raw = m0_alloc(size);
+	if (zbuf == NULL || *raw == NULL) {
+		rc = M0_ERR(-ENOMEM);
+	} else if (m0_bufvec_cursor_copyfrom(cursor, zbuf, zsize) != zsize) {
+		rc = M0_ERR(-EPROTO);
+	} else {
+		rc = LZ4_decompress_safe(zbuf, *raw, zsize, size) == size ?
+			0 : M0_ERR(-EPROTO);
+	}
+	m0_free(zbuf);
+	if (rc != 0) {
+		m0_free(*raw);
+		*raw = NULL;
+	}
+	p->rp_zsize = zsize;
+	p->rp_ztime = m0_time_sub(m0_time_now(), start);
+	return M0_RC(rc);
+#else
+	return M0_ERR(-EPROTONOSUPPORT);
+#endif
+}
+
+M0_INTERNAL void m0_rpc_packet_xids_assign(struct m0_rpc_packet *packet)
+{
+	struct m0_rpc_item *item;
+
+	M0_PRE(!packet->rp_xids_assigned);
+
+	for_each_item_in_packet(item, packet) {
+		uint64_t item_sm_id = m0_sm_id_get(&item->ri_sm);
+
+		m0_rpc_item_xid_assign(item);
+		m0_rpc_item_xid_min_update(item);
+		M0_ADDB2_ADD(M0_AVI_RPC_ITEM_ID_ASSIGN,
+			     item_sm_id,
+			     (uint64_t)item->ri_type->rit_opcode,
+			     item->ri_header.osr_xid,
+			     item->ri_header.osr_session_id);
+	} end_for_each_item_in_packet;
+	packet->rp_xids_assigned = true;
+}
+
 M0_INTERNAL int m0_rpc_packet_encode_using_cursor(struct m0_rpc_packet *packet,
 						  struct m0_bufvec_cursor
 						  *cursor)
@@ -321,7 +457,8 @@ M0_INTERNAL int m0_rpc_packet_encode_using_cursor(struct m0_rpc_packet *packet,
 	struct m0_rpc_item                *item;
 	bool                               end_of_bufvec;
 	struct m0_rpc_packet_onwire_footer pf;
-	int                                rc;
+	void                              *zbuf = NULL;
+	int                                rc   = 0;
 	struct m0_format_tag               packet_format_tag = {
 		.ot_version = M0_RPC_PACKET_FORMAT_VERSION,
 		.ot_type    = M0_FORMAT_TYPE_RPC_PACKET,
@@ -335,24 +472,32 @@ M0_INTERNAL int m0_rpc_packet_encode_using_cursor(struct m0_rpc_packet *packet,
 	packet_format_tag.ot_size = packet->rp_size;
 	m0_format_header_pack(&packet->rp_ow.poh_header, &packet_format_tag);
 
-	rc = packet_header_encdec(&packet->rp_ow, cursor, M0_XCODE_ENCODE);
-	if (rc == 0) {
+	if (!packet->rp_xids_assigned)
+		m0_rpc_packet_xids_assign(packet);
+	packet->rp_ow.poh_flags = RPC_LZ4 ? M0_RPC_PACKET_LZ4_OK : 0;
+	packet->rp_ow.poh_zsize = 0;
+	packet->rp_zsize        = 0;
+	if (packet->rp_compress)
+		rc = packet_items_compress(packet, &zbuf);
+	if (zbuf != NULL) {
+		packet->rp_ow.poh_flags |= M0_RPC_PACKET_LZ4;
+		packet->rp_ow.poh_zsize  = packet->rp_zsize;
+	}
+	if (rc == 0)
+		rc = packet_header_encdec(&packet->rp_ow, cursor,
+					  M0_XCODE_ENCODE);
+	if (rc == 0 && zbuf != NULL) {
+		if (m0_bufvec_cursor_copyto(cursor, zbuf, packet->rp_zsize) !=
+		    packet->rp_zsize)
+			rc = M0_ERR(-EPROTO);
+	} else if (rc == 0) {
 		for_each_item_in_packet(item, packet) {
-			uint64_t item_sm_id = m0_sm_id_get(&item->ri_sm);
-
-			m0_rpc_item_xid_assign(item);
-			m0_rpc_item_xid_min_update(item);
-			M0_ADDB2_ADD(M0_AVI_RPC_ITEM_ID_ASSIGN,
-				     item_sm_id,
-				     (uint64_t)item->ri_type->rit_opcode,
-				     item->ri_header.osr_xid,
-				     item->ri_header.osr_session_id);
-
 			rc = item_encode(item, cursor);
 			if (rc != 0)
 				break;
 		} end_for_each_item_in_packet;
 	}
+	m0_free(zbuf);
 	if (rc == 0) {
 		m0_format_footer_generate(&pf.pof_footer, NULL, 0);
 		rc = packet_footer_encdec(&pf, cursor, M0_XCODE_ENCODE);
@@ -455,6 +600,12 @@ M0_INTERNAL int m0_rpc_packet_decode_using_cursor(struct m0_rpc_packet *p,
 	int                                rc;
 	int                                i;
 	struct m0_format_tag               rpc_t;
+	struct m0_bufvec_cursor           *icur = cursor;
+	struct m0_bufvec_cursor            zcur;
+	void                              *raw  = NULL;
+	m0_bcount_t                        size;
+	struct m0_bufvec                   rawbv = M0_BUFVEC_INIT_BUF(&raw,
+								      &size);
 
 	M0_ENTRY();
 	M0_PRE_EX(m0_rpc_packet_invariant(p) && cursor != NULL);
@@ -478,11 +629,27 @@ M0_INTERNAL int m0_rpc_packet_decode_using_cursor(struct m0_rpc_packet *p,
 	 * the following item_decode().
 	 */
 	p->rp_ow.poh_header = poh.poh_header;
+	p->rp_ow.poh_flags  = poh.poh_flags;
+	p->rp_ow.poh_zsize  = poh.poh_zsize;
+
+	if (poh.poh_flags & M0_RPC_PACKET_LZ4) {
+		if (rpc_t.ot_size <= m0_rpc_packet_onwire_header_size() +
+				     m0_rpc_packet_onwire_footer_size())
+			return M0_ERR(-EPROTO);
+		size = packet_items_size(rpc_t.ot_size);
+		rc = packet_items_decompress(p, cursor, poh.poh_zsize, size,
+					     &raw);
+		if (rc != 0)
+			return M0_ERR(rc);
+		m0_bufvec_cursor_init(&zcur, &rawbv);
+		icur = &zcur;
+	}
 
 	for (i = 0; i < poh.poh_nr_items; ++i) {
-		rc = item_decode(cursor, &item);
+		rc = item_decode(icur, &item);
 		if (item == NULL) {
 			/* Here fop is not allocated, no need to release it. */
+			m0_free(raw);
 			return M0_ERR(rc);
 		} else if (rc != 0) {
 			struct m0_fop *fop = m0_rpc_item_to_fop(item);
@@ -496,6 +663,7 @@ M0_INTERNAL int m0_rpc_packet_decode_using_cursor(struct m0_rpc_packet *p,
 			M0_ASSERT(count == 1);
 			m0_ref_put(&fop->f_ref);
 
+			m0_free(raw);
 			return M0_ERR(rc);
 		}
 		m0_rpc_machine_lock(p->rp_rmachine);
@@ -504,6 +672,7 @@ M0_INTERNAL int m0_rpc_packet_decode_using_cursor(struct m0_rpc_packet *p,
 		m0_rpc_machine_unlock(p->rp_rmachine);
 		item = NULL;
 	}
+	m0_free(raw);
 	rc = packet_footer_encdec(&pof, cursor, M0_XCODE_DECODE);
 	if (rc == 0)
 		rc = m0_format_footer_verify_generic(&pof.pof_footer, NULL, 0,
@@ -63,11 +63,34 @@ struct m0_rpc_packet {
 	struct m0_rpc_frm                 *rp_frm;
 
 	struct m0_rpc_machine             *rp_rmachine;
+
+	/** When the packet was handed over for sending by formation. */
+	m0_time_t                          rp_formed;
+
+	/** Xids of items are assigned, see m0_rpc_packet_xids_assign(). */
+	bool                               rp_xids_assigned;
+
+	/**
+	   Items should be compressed on encoding, see
+	   m0_rpc_machine::rm_compress_min.
+	 */
+	bool                               rp_compress;
+	/** Compressed size of the items, 0 if they were not compressed. */
+	m0_bcount_t                        rp_zsize;
+	/** Time spent compressing or decompressing the items. */
+	m0_time_t                          rp_ztime;
 };
 
 M0_INTERNAL m0_bcount_t m0_rpc_packet_onwire_header_size(void);
 M0_INTERNAL m0_bcount_t m0_rpc_packet_onwire_footer_size(void);
 
+/**
+   Number of bytes the encoded packet takes in a network buffer: less than
+   rp_size when the items are compressed.
+ */
+M0_INTERNAL m0_bcount_t
+m0_rpc_packet_onwire_size(const struct m0_rpc_packet *p);
+
 M0_TL_DESCR_DECLARE(packet_item, M0_EXTERN);
 M0_TL_DECLARE(packet_item, M0_INTERNAL, struct m0_rpc_item);
 
@@ -112,6 +135,17 @@ M0_INTERNAL bool m0_rpc_packet_is_carrying_item(const struct m0_rpc_packet
 						*packet,
 						const struct m0_rpc_item *item);
 
+/**
+   Assigns xids to the items of the packet.
+
+   Called by m0_rpc_packet_encode_using_cursor() if it was not called
+   before. Packets serialised without the machine lock must have their xids
+   assigned beforehand, under the lock.
+
+   @pre m0_rpc_machine_is_locked(packet->rp_rmachine)
+ */
+M0_INTERNAL void m0_rpc_packet_xids_assign(struct m0_rpc_packet *packet);
+
 /**
    Serialises packet in buffer pointed by bufvec.
 
@@ -125,6 +125,10 @@ M0_INTERNAL int m0_rpc__post_locked(struct m0_rpc_item *item)
 		       m0_rpc_item_to_fop(item), session);
 		error = M0_ERR(-ECANCELED);
 	} else {
+		/* Back off from a busy receiver, see item_busy_hold(). */
+		if (session->s_busy_until > item->ri_rpc_time)
+			item->ri_deadline = max64u(item->ri_deadline,
+						   session->s_busy_until);
 		m0_rpc_item_send(item);
 		return M0_RC(item->ri_error);
 	}
@@ -160,6 +164,7 @@ void m0_rpc_reply_post(struct m0_rpc_item *request, struct m0_rpc_item *reply)
 	reply->ri_error    = 0;
 
 	m0_rpc_machine_lock(machine);
+	m0_rpc_item_lat_served(request);
 	m0_rpc_item_sm_init(reply, M0_RPC_ITEM_OUTGOING);
 	m0_rpc_item_send_reply(request, reply);
 	m0_rpc_machine_unlock(machine);
@@ -41,6 +41,7 @@
 #include "rpc/addb2.h"
 #include "rpc/rpc_internal.h"
 #include "net/lnet/lnet.h"
+#include "rpc/rpc_opcodes.h"     /* M0_OPCODES_NR */
 
 /* Forward declarations. */
 static void rpc_tm_cleanup(struct m0_rpc_machine *machine);
@@ -54,6 +55,7 @@ static int rpc_tm_setup(struct m0_net_transfer_mc *tm,
 static int __rpc_machine_init(struct m0_rpc_machine *machine);
 static void __rpc_machine_fini(struct m0_rpc_machine *machine);
 M0_INTERNAL void rpc_worker_thread_fn(struct m0_rpc_machine *machine);
+static void rpc_shards_fini(struct m0_rpc_machine *machine, uint32_t nr);
 static struct m0_rpc_chan *rpc_chan_locate(struct m0_rpc_machine *machine,
 					   struct m0_net_end_point *dest_ep);
 static int rpc_chan_create(struct m0_rpc_chan **chan,
@@ -70,6 +72,8 @@ static void net_buf_received(struct m0_net_buffer    *nb,
 static void packet_received(struct m0_rpc_packet    *p,
 			    struct m0_rpc_machine   *machine,
 			    struct m0_net_end_point *from_ep);
+static void rpc_chan_compress_note(struct m0_rpc_machine   *machine,
+				   struct m0_net_end_point *ep);
 static void item_received(struct m0_rpc_item      *item,
 			  struct m0_net_end_point *from_ep);
 static void net_buf_err(struct m0_net_buffer *nb, int32_t status);
@@ -196,12 +200,30 @@ static int __rpc_machine_init(struct m0_rpc_machine *machine)
 	return M0_RC(0);
 }
 
+static void rpc_opstats_init(struct m0_rpc_opstats *os, uint32_t opcode)
+{
+	M0_SET0(os);
+	os->ros_opcode = opcode;
+}
+
+static void rpc_opstats_fini(struct m0_rpc_machine *machine)
+{
+	int i;
+
+	if (machine->rm_opstats != NULL) {
+		for (i = 0; i < M0_OPCODES_NR; ++i)
+			m0_free(machine->rm_opstats[i]);
+		m0_free0(&machine->rm_opstats);
+	}
+}
+
 static void __rpc_machine_fini(struct m0_rpc_machine *machine)
 {
 	M0_ENTRY("machine %p", machine);
 
 	m0_reqh_rpc_mach_tlink_del_fini(machine);
 	m0_sm_group_fini(&machine->rm_sm_grp);
+	rpc_opstats_fini(machine);
 
 	m0_rpc_service_stop(machine->rm_reqh);
 
@@ -246,6 +268,8 @@ void m0_rpc_machine_fini(struct m0_rpc_machine *machine)
 	M0_LOG(M0_INFO, "Waiting for RPC worker to join");
 	m0_thread_join(&machine->rm_worker);
 	m0_thread_fini(&machine->rm_worker);
+	/* Shard queues are empty, as rm_active_nb counts queued packets. */
+	rpc_shards_fini(machine, machine->rm_shards_nr);
 
 	m0_rpc_machine_lock(machine);
 	M0_PRE(rpc_conn_tlist_is_empty(&machine->rm_outgoing_conns));
@@ -266,6 +290,132 @@ void m0_rpc_machine_fini(struct m0_rpc_machine *machine)
 }
 M0_EXPORTED(m0_rpc_machine_fini);
 
+static void rpc_shard_thread_fn(struct m0_rpc_shard *shard)
+{
+	struct m0_queue_link     *ql;
+	struct m0_rpc_shard_work *work;
+
+	m0_mutex_lock(&shard->rs_lock);
+	while (true) {
+		ql = m0_queue_get(&shard->rs_queue);
+		if (ql != NULL) {
+			m0_mutex_unlock(&shard->rs_lock);
+			work = container_of(ql, struct m0_rpc_shard_work,
+					    rsw_link);
+			work->rsw_func(work);
+			m0_mutex_lock(&shard->rs_lock);
+			shard->rs_nr_works++;
+		} else if (shard->rs_stopping)
+			break;
+		else
+			m0_cond_wait(&shard->rs_cond);
+	}
+	m0_mutex_unlock(&shard->rs_lock);
+}
+
+static void rpc_shards_fini(struct m0_rpc_machine *machine, uint32_t nr)
+{
+	struct m0_rpc_shard *shard;
+	uint32_t             i;
+
+	for (i = 0; i < nr; ++i) {
+		shard = &machine->rm_shards[i];
+		m0_mutex_lock(&shard->rs_lock);
+		shard->rs_stopping = true;
+		m0_cond_signal(&shard->rs_cond);
+		m0_mutex_unlock(&shard->rs_lock);
+		m0_thread_join(&shard->rs_thread);
+		m0_thread_fini(&shard->rs_thread);
+		M0_ASSERT(m0_queue_is_empty(&shard->rs_queue));
+		m0_queue_fini(&shard->rs_queue);
+		m0_cond_fini(&shard->rs_cond);
+		m0_mutex_fini(&shard->rs_lock);
+	}
+	m0_free(machine->rm_shards);
+	machine->rm_shards    = NULL;
+	machine->rm_shards_nr = 0;
+}
+
+M0_INTERNAL int m0_rpc_machine_shards_init(struct m0_rpc_machine *machine,
+					   uint32_t nr)
+{
+	struct m0_rpc_shard *shard;
+	uint32_t             i;
+	int                  rc = 0;
+
+	M0_ENTRY("machine: %p nr: %"PRIu32, machine, nr);
+	M0_PRE(machine->rm_shards == NULL);
+	M0_PRE(rpc_chan_tlist_is_empty(&machine->rm_chans));
+
+	if (nr == 0)
+		return M0_RC(0);
+	M0_ALLOC_ARR(machine->rm_shards, nr);
+	if (machine->rm_shards == NULL)
+		return M0_ERR(-ENOMEM);
+	for (i = 0; i < nr; ++i) {
+		shard = &machine->rm_shards[i];
+		shard->rs_machine = machine;
+		m0_mutex_init(&shard->rs_lock);
+		m0_cond_init(&shard->rs_cond, &shard->rs_lock);
+		m0_queue_init(&shard->rs_queue);
+		rc = M0_THREAD_INIT(&shard->rs_thread, struct m0_rpc_shard *,
+				    NULL, &rpc_shard_thread_fn, shard,
+				    "m0_rpc_shard%u", i);
+		if (rc != 0) {
+			m0_queue_fini(&shard->rs_queue);
+			m0_cond_fini(&shard->rs_cond);
+			m0_mutex_fini(&shard->rs_lock);
+			break;
+		}
+	}
+	if (rc != 0) {
+		rpc_shards_fini(machine, i);
+		return M0_ERR(rc);
+	}
+	m0_rpc_machine_lock(machine);
+	machine->rm_shards_nr = nr;
+	m0_rpc_machine_unlock(machine);
+	return M0_RC(0);
+}
+
+M0_INTERNAL void m0_rpc_machine_shard_post(struct m0_rpc_machine *machine,
+					   uint32_t idx,
+					   struct m0_rpc_shard_work *work)
+{
+	struct m0_rpc_shard *shard;
+
+	M0_PRE(idx < machine->rm_shards_nr);
+	M0_PRE(work->rsw_func != NULL);
+
+	shard = &machine->rm_shards[idx];
+	m0_queue_link_init(&work->rsw_link);
+	m0_mutex_lock(&shard->rs_lock);
+	m0_queue_put(&shard->rs_queue, &work->rsw_link);
+	m0_cond_signal(&shard->rs_cond);
+	m0_mutex_unlock(&shard->rs_lock);
+}
+
+M0_INTERNAL void m0_rpc_machine_frm_set(struct m0_rpc_machine *machine,
+					uint32_t policy, m0_time_t hold)
+{
+	struct m0_rpc_chan *chan;
+
+	M0_ENTRY("machine=%p policy=%"PRIu32" hold=%"PRIu64,
+		 machine, policy, hold);
+	M0_PRE(policy < M0_RPC_FRM_POLICY_NR);
+
+	m0_rpc_machine_lock(machine);
+	machine->rm_frm_policy = policy;
+	machine->rm_frm_hold   = hold;
+	m0_tl_for(rpc_chan, &machine->rm_chans, chan) {
+		chan->rc_frm.f_constraints.fc_policy = policy;
+		chan->rc_frm.f_constraints.fc_hold   =
+			hold ?: M0_RPC_FRM_HOLD_DEF;
+	} m0_tl_endfor;
+	m0_rpc_machine_unlock(machine);
+	M0_LEAVE();
+}
+
 /**
  * Helper structure to link connection with clink allocated on stack.
  * We cannot use clink from m0_rpc_conn structure as it is killed
@@ -577,6 +727,18 @@ m0_rpc_machine_is_not_locked(const struct m0_rpc_machine *machine)
 }
 M0_EXPORTED(m0_rpc_machine_is_not_locked);
 
+static void rpc_opstats_reset(struct m0_rpc_machine *machine)
+{
+	int i;
+
+	if (machine->rm_opstats != NULL) {
+		for (i = 0; i < M0_OPCODES_NR; ++i) {
+			if (machine->rm_opstats[i] != NULL)
+				rpc_opstats_init(machine->rm_opstats[i], i);
+		}
+	}
+}
+
 static void __rpc_machine_get_stats(struct m0_rpc_machine *machine,
 				    struct m0_rpc_stats *stats, bool reset)
 {
@@ -585,8 +747,10 @@ static void __rpc_machine_get_stats(struct m0_rpc_machine *machine,
 	M0_PRE(stats != NULL);
 
 	*stats = machine->rm_stats;
-	if (reset)
+	if (reset) {
 		M0_SET0(&machine->rm_stats);
+		rpc_opstats_reset(machine);
+	}
 }
 
 void m0_rpc_machine_get_stats(struct m0_rpc_machine *machine,
@@ -600,6 +764,175 @@ void m0_rpc_machine_get_stats(struct m0_rpc_machine *machine,
 }
 M0_EXPORTED(m0_rpc_machine_get_stats);
 
+M0_INTERNAL int m0_rpc_machine_get_opstats(struct m0_rpc_machine *machine,
+					   uint32_t opcode,
+					   struct m0_rpc_opstats *stats,
+					   bool reset)
+{
+	struct m0_rpc_opstats *os;
+
+	M0_PRE(machine != NULL);
+	M0_PRE(stats != NULL);
+
+	m0_rpc_machine_lock(machine);
+	os = opcode < M0_OPCODES_NR && machine->rm_opstats != NULL ?
+		machine->rm_opstats[opcode] : NULL;
+	if (os != NULL) {
+		*stats = *os;
+		if (reset)
+			rpc_opstats_init(os, opcode);
+	}
+	m0_rpc_machine_unlock(machine);
+	return os != NULL ? 0 : -ENOENT;
+}
+
+M0_INTERNAL void m0_rpc_lat_hist_add(struct m0_rpc_lat_hist *hist,
+				     m0_time_t lat)
+{
+	unsigned msb;
+	unsigned idx;
+
+	if (lat < M0_BITS(M0_RPC_LAT_SUB_SHIFT)) {
+		idx = lat;
+	} else {
+		msb = m0_log2(lat);
+		idx = (msb - M0_RPC_LAT_SUB_SHIFT + 1) << M0_RPC_LAT_SUB_SHIFT;
+		idx += (lat >> (msb - M0_RPC_LAT_SUB_SHIFT)) &
+			(M0_BITS(M0_RPC_LAT_SUB_SHIFT) - 1);
+		idx = min_check(idx, (unsigned)M0_RPC_LAT_BUCKETS - 1);
+	}
+	hist->rlh_bucket[idx]++;
+	hist->rlh_nr++;
+	hist->rlh_sum += lat;
+	hist->rlh_max = max_check(hist->rlh_max, lat);
+}
+
+/** Returns the largest latency counted by the bucket. */
+static m0_time_t lat_bucket_top(unsigned idx)
+{
+	unsigned msb;
+	unsigned sub;
+
+	if (idx < M0_BITS(M0_RPC_LAT_SUB_SHIFT))
+		return idx;
+	msb = (idx >> M0_RPC_LAT_SUB_SHIFT) + M0_RPC_LAT_SUB_SHIFT - 1;
+	sub = idx & (M0_BITS(M0_RPC_LAT_SUB_SHIFT) - 1);
+	return ((M0_BITS(M0_RPC_LAT_SUB_SHIFT) + sub + 1) <<
+		(msb - M0_RPC_LAT_SUB_SHIFT)) - 1;
+}
+
+M0_INTERNAL m0_time_t m0_rpc_lat_hist_quantile(const struct m0_rpc_lat_hist *h,
+					       uint32_t permille)
+{
+	uint64_t rank;
+	uint64_t seen = 0;
+	unsigned i;
+
+	M0_PRE(permille <= 1000);
+
+	if (h->rlh_nr == 0)
+		return 0;
+	rank = max64u((h->rlh_nr * permille + 999) / 1000, 1);
+	for (i = 0; i < M0_RPC_LAT_BUCKETS; ++i) {
+		seen += h->rlh_bucket[i];
+		if (seen >= rank && i < M0_RPC_LAT_BUCKETS - 1)
+			return min64u(lat_bucket_top(i), h->rlh_max);
+	}
+	return h->rlh_max;
+}
+
+static struct m0_rpc_opstats *rpc_opstats_get(struct m0_rpc_machine *machine,
+					      uint32_t opcode)
+{
+	struct m0_rpc_opstats *os;
+
+	M0_PRE(m0_rpc_machine_is_locked(machine));
+
+	if (opcode >= M0_OPCODES_NR)
+		return NULL;
+	if (machine->rm_opstats == NULL) {
+		M0_ALLOC_ARR(machine->rm_opstats, M0_OPCODES_NR);
+		if (machine->rm_opstats == NULL)
+			return NULL;
+	}
+	os = machine->rm_opstats[opcode];
+	if (os == NULL) {
+		M0_ALLOC_PTR(os);
+		if (os == NULL)
+			return NULL;
+		rpc_opstats_init(os, opcode);
+		machine->rm_opstats[opcode] = os;
+	}
+	return os;
+}
+
+M0_INTERNAL void m0_rpc_item_lat_note(struct m0_rpc_item *item,
+				      enum m0_rpc_item_state state)
+{
+	struct m0_rpc_opstats *os;
+	uint32_t               from = item->ri_sm.sm_state;
+	m0_time_t              now;
+	int                    phase;
+
+	M0_PRE(m0_rpc_machine_is_locked(item->ri_rmachine));
+
+	if (item->ri_sm.sm_conf != &item->ri_type->rit_outgoing_conf ||
+	    !m0_rpc_item_is_request(item) || item->ri_nr_sent != 1)
+		return;
+	if (from == M0_RPC_ITEM_INITIALISED &&
+	    M0_IN(state, (M0_RPC_ITEM_ENQUEUED, M0_RPC_ITEM_URGENT))) {
+		item->ri_lat_mark = item->ri_rpc_time;
+		phase = M0_RPC_LAT_QUEUE;
+	} else if (item->ri_lat_mark == 0) {
+		return;
+	} else if (state == M0_RPC_ITEM_SENDING) {
+		phase = M0_RPC_LAT_FORMATION;
+	} else if (state == M0_RPC_ITEM_SENT) {
+		phase = M0_RPC_LAT_NET;
+	} else if (state == M0_RPC_ITEM_REPLIED &&
+		   M0_IN(from, (M0_RPC_ITEM_SENT,
+				M0_RPC_ITEM_WAITING_FOR_REPLY))) {
+		phase = M0_RPC_LAT_REMOTE;
+	} else if (state == M0_RPC_ITEM_FAILED) {
+		phase = -1;
+	} else {
+		return;
+	}
+	os = rpc_opstats_get(item->ri_rmachine, item->ri_type->rit_opcode);
+	if (os == NULL)
+		return;
+	if (phase < 0) {
+		os->ros_nr_failed++;
+		item->ri_lat_mark = 0;
+		return;
+	}
+	now = m0_time_now();
+	m0_rpc_lat_hist_add(&os->ros_lat[phase],
+			    m0_time_sub(now, item->ri_lat_mark));
+	item->ri_lat_mark = now;
+	if (phase == M0_RPC_LAT_NET)
+		os->ros_nr_sent++;
+	else if (phase == M0_RPC_LAT_REMOTE) {
+		os->ros_nr_replied++;
+		item->ri_lat_mark = 0;
+	}
+}
+
+M0_INTERNAL void m0_rpc_item_lat_served(const struct m0_rpc_item *request)
+{
+	struct m0_rpc_opstats *os;
+
+	M0_PRE(m0_rpc_machine_is_locked(request->ri_rmachine));
+
+	os = rpc_opstats_get(request->ri_rmachine, request->ri_type->rit_opcode);
+	if (os != NULL) {
+		os->ros_nr_served++;
+		m0_rpc_lat_hist_add(&os->ros_lat[M0_RPC_LAT_SERVICE],
+				    m0_time_sub(m0_time_now(),
+						request->ri_rpc_time));
+	}
+}
+
 M0_INTERNAL const char *m0_rpc_machine_ep(const struct m0_rpc_machine *rmach)
 {
 	return rmach->rm_tm.ntm_ep->nep_addr;
@@ -708,6 +1041,8 @@ static int rpc_chan_create(struct m0_rpc_chan **chan,
 
 	ch->rc_rpc_machine = machine;
 	ch->rc_destep = dest_ep;
+	if (machine->rm_shards_nr > 0)
+		ch->rc_shard = machine->rm_shard_next++ % machine->rm_shards_nr;
 	m0_ref_init(&ch->rc_ref, 1, rpc_chan_ref_release);
 	m0_net_end_point_get(dest_ep);
 
@@ -719,6 +1054,8 @@ static int rpc_chan_create(struct m0_rpc_chan **chan,
 				constraints.fc_max_packet_size;
 	constraints.fc_max_nr_segments =
 				m0_net_domain_get_max_buffer_segments(ndom);
+	constraints.fc_policy = machine->rm_frm_policy;
+	constraints.fc_hold   = machine->rm_frm_hold ?: M0_RPC_FRM_HOLD_DEF;
 
 	m0_rpc_frm_init(&ch->rc_frm, &constraints, &m0_rpc_frm_default_ops);
 	rpc_chan_tlink_init_at(ch, &machine->rm_chans);
@@ -801,6 +1138,13 @@ static void net_buf_received(struct m0_net_buffer    *nb,
 	rc = m0_rpc_packet_decode(&p, &nb->nb_buffer, offset, length);
 	if (rc != 0)
 		M0_LOG(M0_ERROR, "Packet decode error: %i.", rc);
+	if (p.rp_zsize != 0) {
+		machine->rm_stats.rs_nr_zrcvd_packets++;
+		machine->rm_stats.rs_zrcvd_time += p.rp_ztime;
+	}
+	if (machine->rm_compress_min > 0 &&
+	    (p.rp_ow.poh_flags & M0_RPC_PACKET_LZ4_OK))
+		rpc_chan_compress_note(machine, from_ep);
 	/* There might be items in packet p, which were successfully decoded
 	   before an error occurred. */
 	packet_received(&p, machine, from_ep);
@@ -808,11 +1152,36 @@ static void net_buf_received(struct m0_net_buffer    *nb,
 	M0_LEAVE();
 }
 
+/** Notes that the peer accepts compressed packets. */
+static void rpc_chan_compress_note(struct m0_rpc_machine   *machine,
+				   struct m0_net_end_point *ep)
+{
+	struct m0_rpc_chan *chan;
+
+	m0_rpc_machine_lock(machine);
+	chan = m0_tl_find(rpc_chan, chan, &machine->rm_chans,
+			  chan->rc_destep == ep);
+	if (chan != NULL)
+		chan->rc_compress = true;
+	m0_rpc_machine_unlock(machine);
+}
+
 static void packet_received(struct m0_rpc_packet    *p,
 			    struct m0_rpc_machine   *machine,
 			    struct m0_net_end_point *from_ep)
 {
-	struct m0_rpc_item *item;
+	struct m0_rpc_item  *item;
+	struct m0_fom_batch *batch = NULL;
+#ifndef __KERNEL__
+	struct m0_fom_batch  foms;
+
+	/*
+	 * Foms created for the items of the packet are queued to their
+	 * localities together, once all items are processed.
+	 */
+	m0_fom_batch_init(&foms);
+	batch = &foms;
+#endif
 
 	M0_ENTRY("p %p", p);
 
@@ -823,11 +1192,16 @@ static void packet_received(struct m0_rpc_packet    *p,
 		item->ri_rmachine = machine;
 		m0_rpc_item_get(item);
 		m0_rpc_machine_lock(machine);
+		machine->rm_fom_batch = batch;
 		m0_rpc_packet_remove_item(p, item);
 		item_received(item, from_ep);
 		m0_rpc_item_put(item);
+		machine->rm_fom_batch = NULL;
 		m0_rpc_machine_unlock(machine);
 	} end_for_each_item_in_packet;
+#ifndef __KERNEL__
+	m0_fom_batch_flush(batch);
+#endif
 
 	M0_LEAVE();
 }
@@ -29,6 +29,9 @@
 #include "lib/tlist.h"
 #include "lib/thread.h"
 #include "lib/chan.h"
+#include "lib/cond.h"
+#include "lib/mutex.h"
+#include "lib/queue.h"
 #include "sm/sm.h"     /* m0_sm_group */
 #include "net/net.h"   /* m0_net_transfer_mc, m0_net_domain */
 
@@ -44,6 +47,7 @@ struct m0_rpc_conn;
 struct m0_rpc_session;
 struct m0_reqh;
 struct m0_dtm;
+struct m0_fom_batch;
 
 enum {
 	/** Default Maximum RPC message size is taken as 128k */
@@ -72,6 +76,109 @@ struct m0_rpc_stats {
 	/* Bytes */
 	uint64_t rs_nr_sent_bytes;
 	uint64_t rs_nr_rcvd_bytes;
+
+	/* Compression, see m0_rpc_machine::rm_compress_min */
+	uint64_t  rs_nr_zsent_packets;
+	/** Size of the items of compressed sent packets before compression. */
+	uint64_t  rs_nr_zsent_raw_bytes;
+	uint64_t  rs_nr_zsent_bytes;
+	m0_time_t rs_zsent_time;
+	uint64_t  rs_nr_zrcvd_packets;
+	m0_time_t rs_zrcvd_time;
+};
+
+/**
+   Phases of the latency of rpc items, see m0_rpc_opstats.
+
+   Request phases are measured for the first transmission of a request only,
+   resent requests are not accounted.
+ */
+enum m0_rpc_lat_phase {
+	/** Request: from m0_rpc_post() to the formation queue. */
+	M0_RPC_LAT_QUEUE,
+	/** Request: in the formation queue, until it is added to a packet. */
+	M0_RPC_LAT_FORMATION,
+	/** Request: from the packet formation to the send completion. */
+	M0_RPC_LAT_NET,
+	/**
+	 * Request: from the send completion to the reply arrival. This is the
+	 * service time of the remote end plus the network trip of the reply.
+	 */
+	M0_RPC_LAT_REMOTE,
+	/** Incoming request: from its arrival to the reply post. */
+	M0_RPC_LAT_SERVICE,
+	M0_RPC_LAT_NR
+};
+
+enum {
+	/** log2 of the number of linear sub-buckets per power of two. */
+	M0_RPC_LAT_SUB_SHIFT   = 2,
+	/** Latencies of 2^(M0_RPC_LAT_MAX_SHIFT + 1) ns and more share the last
+	    bucket. */
+	M0_RPC_LAT_MAX_SHIFT   = 40,
+	M0_RPC_LAT_BUCKETS     = M0_RPC_LAT_MAX_SHIFT << M0_RPC_LAT_SUB_SHIFT,
+	/**
+	 * Stats service object of an opcode has id M0_RPC_OPSTATS_ID_BASE +
+	 * opcode, see stats/stats_srv.c.
+	 */
+	M0_RPC_OPSTATS_ID_BASE = 0x52500000
+};
+
+/**
+   Log-linear latency histogram.
+
+   Latencies are in nanoseconds. Latencies below 4 have a bucket each, bucket
+   i >= 4 counts latencies with the most significant bit at position
+   i / 4 + 1 and the following two bits equal to i % 4, so the width of a
+   bucket is below 25% of its values over the whole range.
+ */
+struct m0_rpc_lat_hist {
+	uint64_t  rlh_nr;
+	m0_time_t rlh_sum;
+	m0_time_t rlh_max;
+	uint64_t  rlh_bucket[M0_RPC_LAT_BUCKETS];
+};
+
+/** Live statistics of an opcode in an rpc machine. */
+struct m0_rpc_opstats {
+	uint32_t               ros_opcode;
+	/** Requests sent for the first time. */
+	uint64_t               ros_nr_sent;
+	uint64_t               ros_nr_replied;
+	uint64_t               ros_nr_failed;
+	/** Replies posted to incoming requests. */
+	uint64_t               ros_nr_served;
+	struct m0_rpc_lat_hist ros_lat[M0_RPC_LAT_NR];
+};
+
+/**
+   Work executed by a send shard of an rpc machine.
+
+   @see m0_rpc_machine_shards_init()
+ */
+struct m0_rpc_shard_work {
+	struct m0_queue_link   rsw_link;
+	void                 (*rsw_func)(struct m0_rpc_shard_work *work);
+};
+
+/**
+   Send shard of an rpc machine: a thread with its own queue of works.
+
+   Packets formed for the rpc channels assigned to the shard are
+   serialised, placed in network buffers and queued to the transfer
+   machine by the shard thread, outside of the machine lock.
+ */
+struct m0_rpc_shard {
+	struct m0_rpc_machine *rs_machine;
+	struct m0_thread       rs_thread;
+	/** Protects rs_queue and rs_stopping. */
+	struct m0_mutex        rs_lock;
+	struct m0_cond         rs_cond;
+	/** Queue of m0_rpc_shard_work-s. */
+	struct m0_queue        rs_queue;
+	bool                   rs_stopping;
+	/** Number of works executed by the shard. */
+	uint64_t               rs_nr_works;
 };
 
 /**
@@ -155,6 +262,56 @@ struct m0_rpc_machine {
 	 * @see m0_rpc_at_buf
 	 */
 	m0_bcount_t                       rm_bulk_cutoff;
+
+	/**
+	 * Formation policy (enum m0_rpc_frm_policy_type) and maximal item
+	 * hold time (0 for the default) of the rpc channels created from now
+	 * on. User is allowed to change them by direct field assignment.
+	 * @see m0_rpc_frm_constraints::fc_policy
+	 */
+	uint32_t                          rm_frm_policy;
+	m0_time_t                         rm_frm_hold;
+
+	/**
+	 * Byte arrays of fops at least that long are sent by reference: the
+	 * network buffer points to the fop memory instead of a copy. 0
+	 * disables this. The transport must accept registration of arbitrary
+	 * memory segments (sock and libfab do). User is allowed to change the
+	 * value by direct field assignment.
+	 */
+	m0_bcount_t                       rm_zerocopy_min;
+
+	/**
+	 * Items of packets at least that long are compressed with lz4, if
+	 * the receiver announced that it accepts compressed packets (see
+	 * M0_RPC_PACKET_LZ4_OK). 0 disables compression. Compression takes
+	 * precedence over rm_zerocopy_min. User is allowed to change the value
+	 * by direct field assignment.
+	 */
+	m0_bcount_t                       rm_compress_min;
+
+	/**
+	 * Send shards, NULL if packets are sent from the formation context.
+	 * @see m0_rpc_machine_shards_init()
+	 */
+	struct m0_rpc_shard              *rm_shards;
+	uint32_t                          rm_shards_nr;
+	/** Shard to assign to the next created rpc channel. */
+	uint32_t                          rm_shard_next;
+
+	/**
+	 * Per-opcode statistics, indexed by opcode and allocated on the first
+	 * use. Protected by the machine lock.
+	 * @see m0_rpc_machine_get_opstats()
+	 */
+	struct m0_rpc_opstats           **rm_opstats;
+
+	/**
+	 * Batch collecting foms of the incoming packet being processed, NULL
+	 * outside of packet processing. Protected by the machine lock.
+	 * @see m0_reqh_fop_handle()
+	 */
+	struct m0_fom_batch              *rm_fom_batch;
 };
 
 /**
@@ -197,6 +354,43 @@ M0_INTERNAL int m0_rpc_machine_init(struct m0_rpc_machine *machine,
 
 void m0_rpc_machine_fini(struct m0_rpc_machine *machine);
 
+/**
+   Starts nr send shards of the machine.
+
+   Rpc channels are assigned to the shards round-robin when they are
+   created. Serialisation of the packets of a channel, allocation and
+   registration of their network buffers and submission to the transfer
+   machine are then done by the thread of its shard, so that the machine
+   lock is only held while packets are formed and their completions are
+   processed. Connection and session state, formation and item state
+   machines are still protected by the machine lock.
+
+   Must be called right after m0_rpc_machine_init(), before any connection
+   is established. Shards are stopped by m0_rpc_machine_fini().
+ */
+M0_INTERNAL int m0_rpc_machine_shards_init(struct m0_rpc_machine *machine,
+					   uint32_t nr);
+
+/**
+   Queues the work to the shard idx of the machine.
+
+   @pre machine->rm_shards_nr > 0
+ */
+M0_INTERNAL void m0_rpc_machine_shard_post(struct m0_rpc_machine *machine,
+					   uint32_t idx,
+					   struct m0_rpc_shard_work *work);
+
+/**
+   Changes the formation policy and the item hold time (0 for the default) of
+   the machine, see m0_rpc_machine::rm_frm_policy. Unlike the direct field
+   assignment, the rpc channels already created are changed too, so that
+   formation can be tuned on a running process.
+
+   @pre policy < M0_RPC_FRM_POLICY_NR
+ */
+M0_INTERNAL void m0_rpc_machine_frm_set(struct m0_rpc_machine *machine,
+					uint32_t policy, m0_time_t hold);
+
 void m0_rpc_machine_get_stats(struct m0_rpc_machine *machine,
 			      struct m0_rpc_stats *stats, bool reset);
 
@@ -206,6 +400,29 @@ m0_rpc_machine_drain_item_sources(struct m0_rpc_machine *machine,
 
 M0_INTERNAL const char *m0_rpc_machine_ep(const struct m0_rpc_machine *rmach);
 
+/**
+   Copies statistics of the opcode to stats, resets them if reset is true.
+
+   @retval -ENOENT no items of the opcode were seen by the machine.
+ */
+M0_INTERNAL int m0_rpc_machine_get_opstats(struct m0_rpc_machine *machine,
+					   uint32_t opcode,
+					   struct m0_rpc_opstats *stats,
+					   bool reset);
+
+/** Adds a latency measurement to the histogram. */
+M0_INTERNAL void m0_rpc_lat_hist_add(struct m0_rpc_lat_hist *hist,
+				     m0_time_t lat);
+
+/**
+   Returns an upper estimate of the latency quantile, permille of the
+   measurements of the histogram are not larger. Returns 0 for an empty
+   histogram.
+ */
+M0_INTERNAL m0_time_t m0_rpc_lat_hist_quantile(const struct m0_rpc_lat_hist *h,
+					       uint32_t permille);
+
+
 M0_INTERNAL void m0_rpc_machine_lock(struct m0_rpc_machine *machine);
 M0_INTERNAL void m0_rpc_machine_unlock(struct m0_rpc_machine *machine);
 M0_INTERNAL bool
@@ -68,6 +68,13 @@ struct m0_rpc_chan {
 	struct m0_net_end_point		 *rc_destep;
 	/** The rpc_machine, this chan structure is associated with.*/
 	struct m0_rpc_machine		 *rc_rpc_machine;
+	/** Send shard of the chan, see m0_rpc_machine_shards_init(). */
+	uint32_t			  rc_shard;
+	/**
+	   The destination accepts compressed packets, see
+	   m0_rpc_machine::rm_compress_min.
+	 */
+	bool				  rc_compress;
 	/** M0_RPC_CHAN_MAGIC */
 	uint64_t			  rc_magic;
 };
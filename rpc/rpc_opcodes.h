@@ -217,6 +217,9 @@ enum M0_RPC_OPCODES {
 	/* cob setattr & reply */
 	M0_IOSERVICE_COB_SETATTR_OPCODE     = 130,
 	M0_IOSERVICE_COB_SETATTR_REP_OPCODE = 131,
+	/* batched cob create & reply */
+	M0_IOSERVICE_COB_CREATE_BATCH_OPCODE     = 132,
+	M0_IOSERVICE_COB_CREATE_BATCH_REP_OPCODE = 133,
 
 	/** Spiel opcodes */
 	M0_SPIEL_CONF_FILE_OPCODE           = 138,
@@ -250,6 +253,12 @@ enum M0_RPC_OPCODES {
 	M0_SNS_CM_REPAIR_SW_REP_FOP_OPCODE  = 164,
 	M0_SNS_CM_REBALANCE_SW_REP_FOP_OPCODE = 165,
 
+	/* SNS repair/rebalance throttle */
+	M0_SNS_REPAIR_THROTTLE_OPCODE       = 166,
+	M0_SNS_REPAIR_THROTTLE_REP_OPCODE   = 167,
+	M0_SNS_REBALANCE_THROTTLE_OPCODE    = 168,
+	M0_SNS_REBALANCE_THROTTLE_REP_OPCODE = 169,
+
 	/** FDMI opcodes */
 	M0_FDMI_RECORD_NOT_OPCODE           = 170,
 	M0_FDMI_RECORD_NOT_REP_OPCODE       = 171,
@@ -257,6 +266,9 @@ enum M0_RPC_OPCODES {
 	M0_FDMI_RECORD_RELEASE_REP_OPCODE   = 173,
 	M0_FDMI_FILTERS_ENABLE_OPCODE       = 174,
 	M0_FDMI_FILTERS_ENABLE_REP_OPCODE   = 175,
+	M0_FDMI_RECORD_BATCH_OPCODE         = 176,
+	M0_FDMI_RECORD_BATCH_REP_OPCODE     = 177,
+	M0_FDMI_RECORD_RELEASE_BATCH_OPCODE = 178,
 
 	/** SSS Service fops */
 	M0_SSS_SVC_REQ_OPCODE               = 200,
@@ -286,6 +298,7 @@ enum M0_RPC_OPCODES {
 	M0_CAS_REP_FOP_OPCODE               = 234,
 	M0_CAS_GCW_FOP_OPCODE               = 235,
 	M0_CAS_GCF_FOP_OPCODE               = 236,
+	M0_CAS_CPF_FOP_OPCODE               = 237,
 
 	/** Fault Injection command fops. */
 	M0_FI_COMMAND_OPCODE                = 260,
@@ -359,6 +372,8 @@ enum M0_RPC_OPCODES {
 	M0_DTM0_RLINK_OPCODE                = 1073,
 	M0_FDMI_SOURCE_DOCK_TIMER_OPCODE    = 1074,
 	M0_DTM0_RECOVERY_FOM_OPCODE         = 1075,
+	M0_UT_CO_FOM_OPCODE                 = 1076,
+	M0_UT_CO_BLOCK_FOM_OPCODE           = 1077,
 
 	M0_OPCODES_NR                       = 2048
 } M0_XCA_ENUM;
@@ -269,6 +269,8 @@ M0_INTERNAL void m0_rpc_session_reset(struct m0_rpc_session *session)
 	session_state_set(session, M0_RPC_SESSION_INITIALISED);
 	session->s_xid = 0;
 	session->s_cancelled = false;
+	session->s_busy_until = 0;
+	session->s_busy_hold = 0;
 	session->s_session_id = SESSION_ID_INVALID;
 	M0_POST(m0_rpc_session_invariant(session));
 	m0_rpc_machine_unlock(machine);
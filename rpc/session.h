@@ -156,6 +156,13 @@ enum m0_rpc_session_state {
 M0_INTERNAL const char *
 m0_rpc_session_state_to_str(enum m0_rpc_session_state state);
 
+enum {
+	/** First hold of requests after a M0_RIF_BUSY reply, in nanoseconds. */
+	M0_RPC_SESSION_BUSY_HOLD_MIN = 1000 * 1000,
+	/** Maximal hold of requests after M0_RIF_BUSY replies, nanoseconds. */
+	M0_RPC_SESSION_BUSY_HOLD_MAX = 256 * 1000 * 1000,
+};
+
 /**
    Rpc connection can be shared by multiple entities (e.g. users) by
    creating their own "session" on the connection.
@@ -359,6 +366,20 @@ struct m0_rpc_session {
 	 */
 	bool                      s_cancelled;
 
+	/**
+	 * Requests posted to the session are held by formation until this
+	 * time, because the receiver refused an earlier request as busy, with
+	 * a reply marked M0_RIF_BUSY.
+	 * See m0_rpc_item_process_reply().
+	 */
+	m0_time_t                 s_busy_until;
+	/**
+	 * Current hold after a M0_RIF_BUSY reply. Doubles with each
+	 * consecutive M0_RIF_BUSY reply up to M0_RPC_SESSION_BUSY_HOLD_MAX and
+	 * is reset by any other reply.
+	 */
+	m0_time_t                 s_busy_hold;
+
 	/**
 	 * Items submitted to formation.
 	 * Required in case RPC session is to be cancelled so as to cancel
@@ -178,11 +178,58 @@ static void rpc_conn_pool_async(void) {
 	stop_rpc_client_and_server();
 }
 
+static void rpc_conn_pool_paths(void)
+{
+	struct m0_rpc_conn_pool  pool = {};
+	struct m0_rpc_session   *s[4];
+	int                      rc;
+	int                      i;
+
+	start_rpc_client_and_server();
+
+	rc = m0_rpc_conn_pool_init(
+			&pool, &cctx.rcx_rpc_machine, M0_TIME_NEVER, 1);
+	M0_ASSERT(rc == 0);
+	m0_rpc_conn_pool_paths_set(&pool, 2, M0_RCP_LEAST_USED);
+
+	/* Two connections are opened. */
+	for (i = 0; i < 2; ++i) {
+		rc = m0_rpc_conn_pool_get_sync(&pool, SERVER_ENDPOINT_ADDR,
+					       &s[i]);
+		M0_UT_ASSERT(rc == 0);
+	}
+	M0_UT_ASSERT(s[0] != s[1]);
+	M0_UT_ASSERT(rpc_conn_pool_items_tlist_length(&pool.cp_items) == 2);
+
+	/* The least used one is handed out. */
+	m0_rpc_conn_pool_put(&pool, s[0]);
+	rc = m0_rpc_conn_pool_get_sync(&pool, SERVER_ENDPOINT_ADDR, &s[2]);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(s[2] == s[0]);
+	M0_UT_ASSERT(rpc_conn_pool_items_tlist_length(&pool.cp_items) == 2);
+
+	/* Round robin. */
+	pool.cp_policy = M0_RCP_ROUND_ROBIN;
+	rc = m0_rpc_conn_pool_get_sync(&pool, SERVER_ENDPOINT_ADDR, &s[3]);
+	M0_UT_ASSERT(rc == 0);
+	m0_rpc_conn_pool_put(&pool, s[3]);
+	rc = m0_rpc_conn_pool_get_sync(&pool, SERVER_ENDPOINT_ADDR, &s[0]);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(s[0] != s[3]);
+	m0_rpc_conn_pool_put(&pool, s[0]);
+
+	m0_rpc_conn_pool_put(&pool, s[1]);
+	m0_rpc_conn_pool_put(&pool, s[2]);
+	m0_rpc_conn_pool_fini(&pool);
+	stop_rpc_client_and_server();
+}
+
 struct m0_ut_suite rpc_conn_pool_ut = {
 	.ts_name = "rpc-conn-pool-ut",
 	.ts_tests = {
 		{ "rpc-conn-pool", rpc_conn_pool},
 		{ "rpc-conn-pool-async", rpc_conn_pool_async},
+		{ "rpc-conn-pool-paths", rpc_conn_pool_paths},
 		{ NULL, NULL },
 	},
 };
@@ -650,6 +650,102 @@ static void frm_test8(void)
 	M0_LEAVE();
 }
 
+static void frm_policy_test(void)
+{
+	struct m0_rpc_item   *item1;
+	struct m0_rpc_item   *item2;
+	struct m0_rpc_packet *p;
+	m0_bcount_t           saved_max_nr_bytes_acc;
+	uint64_t              held;
+	int                   rc;
+
+	M0_ENTRY();
+
+	saved_max_nr_bytes_acc = frm->f_constraints.fc_max_nr_bytes_accumulated;
+	frm->f_constraints.fc_max_nr_bytes_accumulated = ~0;
+
+	/* Latency first: waiting item is sent as soon as the link is idle. */
+	frm->f_constraints.fc_policy = M0_RPC_FRM_POLICY_LATENCY;
+	set_timeout(10000);
+	item1 = new_item(WAITING, NORMAL);
+	item2 = new_item(WAITING, NORMAL);
+	flags_reset();
+	m0_rpc_frm_enq_item(frm, item1);
+	M0_UT_ASSERT(packet_ready_called);
+	check_frm(FRM_BUSY, 0, 1);
+	flags_reset();
+	m0_rpc_frm_enq_item(frm, item2);
+	M0_UT_ASSERT(!packet_ready_called);
+	check_frm(FRM_BUSY, 1, 1);
+	p = packet_stack_pop();
+	M0_UT_ASSERT(m0_rpc_packet_is_carrying_item(p, item1));
+	m0_rpc_frm_packet_done(p);
+	m0_rpc_packet_discard(p);
+	M0_UT_ASSERT(packet_ready_called);
+	check_ready_packet_has_item(item2);
+	m0_rpc_item_fini(item1);
+	m0_rpc_item_fini(item2);
+	m0_free(item1);
+	m0_free(item2);
+
+	/* Throughput first: even timed out item is held for fc_hold. */
+	frm->f_constraints.fc_policy = M0_RPC_FRM_POLICY_THROUGHPUT;
+	frm->f_constraints.fc_hold   = 100 * M0_TIME_ONE_MSEC;
+	held  = frm->f_nr_held;
+	item1 = new_item(TIMEDOUT, NORMAL);
+	flags_reset();
+	m0_rpc_frm_enq_item(frm, item1);
+	M0_UT_ASSERT(!packet_ready_called);
+	M0_UT_ASSERT(frm->f_nr_held == held + 1);
+	check_frm(FRM_BUSY, 1, 0);
+	m0_rpc_machine_unlock(&rmachine);
+	rc = m0_rpc_item_timedwait(item1,
+				   M0_BITS(M0_RPC_ITEM_URGENT,
+					   M0_RPC_ITEM_SENDING),
+				   M0_TIME_NEVER);
+	M0_UT_ASSERT(rc == 0);
+	m0_rpc_machine_lock(&rmachine);
+	M0_UT_ASSERT(packet_ready_called);
+	check_ready_packet_has_item(item1);
+	m0_rpc_item_fini(item1);
+	m0_free(item1);
+
+	/*
+	 * Adaptive: item is sent at once when the link is idle, otherwise it
+	 * is held for the packet completion time.
+	 */
+	frm->f_constraints.fc_policy = M0_RPC_FRM_POLICY_ADAPTIVE;
+	item1 = new_item(TIMEDOUT, NORMAL);
+	item2 = new_item(TIMEDOUT, NORMAL);
+	flags_reset();
+	m0_rpc_frm_enq_item(frm, item1);
+	M0_UT_ASSERT(packet_ready_called);
+	check_frm(FRM_BUSY, 0, 1);
+	/* Machine lock is held, so deadline timer of item2 cannot expire. */
+	frm->f_packet_time = M0_TIME_ONE_SECOND;
+	held = frm->f_nr_held;
+	flags_reset();
+	m0_rpc_frm_enq_item(frm, item2);
+	M0_UT_ASSERT(!packet_ready_called);
+	M0_UT_ASSERT(frm->f_nr_held == held + 1);
+	check_frm(FRM_BUSY, 1, 1);
+	p = packet_stack_pop();
+	m0_rpc_frm_packet_done(p);
+	m0_rpc_packet_discard(p);
+	M0_UT_ASSERT(packet_ready_called);
+	check_ready_packet_has_item(item2);
+	m0_rpc_item_fini(item1);
+	m0_rpc_item_fini(item2);
+	m0_free(item1);
+	m0_free(item2);
+
+	frm->f_constraints.fc_policy = M0_RPC_FRM_POLICY_DEADLINE;
+	frm->f_constraints.fc_hold   = M0_RPC_FRM_HOLD_DEF;
+	frm->f_constraints.fc_max_nr_bytes_accumulated = saved_max_nr_bytes_acc;
+
+	M0_LEAVE();
+}
+
 static void frm_fini_test(void)
 {
 	m0_rpc_frm_fini(frm);
@@ -669,6 +765,7 @@ struct m0_ut_suite frm_ut = {
 		{ "frm-test6",    frm_test6    },
 		{ "frm-test7",    frm_test7    },
 		{ "frm-test8",    frm_test8    },
+		{ "frm-policy",   frm_policy_test },
 		{ "frm-fini",     frm_fini_test},
 		{ NULL,           NULL         }
 	}
@@ -35,6 +35,8 @@
 #include "rpc/ut/clnt_srv_ctx.c"   /* sctx, cctx. NOTE: This is .c file */
 #include "rpc/ut/fops.h"
 #include "rpc/rpc_internal.h"
+#include "fop/fom_generic.h"       /* m0_fop_generic_reply */
+#include "reqh/reqh.h"             /* m0_reqh::rh_runq_max */
 
 enum {
 	TIMEOUT  = 4
@@ -112,6 +114,162 @@ static void test_simple_transitions(void)
 	M0_LOG(M0_DEBUG, "TEST:1:END");
 }
 
+static void test_opstats(void)
+{
+	struct m0_rpc_machine  *smach = m0_rpc_server_ctx_get_rmachine(&sctx);
+	struct m0_rpc_lat_hist  hist = {};
+	struct m0_rpc_opstats   os;
+	uint32_t                opcode;
+	int                     i;
+	int                     rc;
+
+	/* Histogram: exact small buckets, upper estimates of quantiles. */
+	for (i = 0; i < 4; ++i)
+		m0_rpc_lat_hist_add(&hist, i);
+	m0_rpc_lat_hist_add(&hist, 1000);
+	m0_rpc_lat_hist_add(&hist, M0_TIME_ONE_SECOND);
+	M0_UT_ASSERT(hist.rlh_nr == 6 && hist.rlh_max == M0_TIME_ONE_SECOND);
+	M0_UT_ASSERT(m0_rpc_lat_hist_quantile(&hist, 500) == 2);
+	M0_UT_ASSERT(m0_rpc_lat_hist_quantile(&hist, 800) >= 1000 &&
+		     m0_rpc_lat_hist_quantile(&hist, 800) < 1250);
+	M0_UT_ASSERT(m0_rpc_lat_hist_quantile(&hist, 1000) ==
+		     M0_TIME_ONE_SECOND);
+	m0_rpc_lat_hist_add(&hist, M0_TIME_NEVER);
+	M0_UT_ASSERT(hist.rlh_bucket[M0_RPC_LAT_BUCKETS - 1] == 1);
+
+	/* A request is accounted in all phases on both ends. */
+	fop = fop_alloc(machine);
+	item = &fop->f_item;
+	opcode = item->ri_type->rit_opcode;
+	(void)m0_rpc_machine_get_opstats(machine, opcode, &os, true);
+	(void)m0_rpc_machine_get_opstats(smach, opcode, &os, true);
+	rc = m0_rpc_post_sync(fop, session, &cs_ds_req_fop_rpc_item_ops,
+			      0 /* deadline */);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_rpc_machine_get_opstats(machine, opcode, &os, false);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(os.ros_opcode == opcode && os.ros_nr_sent == 1 &&
+		     os.ros_nr_replied == 1 && os.ros_nr_failed == 0);
+	for (i = M0_RPC_LAT_QUEUE; i <= M0_RPC_LAT_REMOTE; ++i)
+		M0_UT_ASSERT(os.ros_lat[i].rlh_nr == 1);
+	M0_UT_ASSERT(os.ros_lat[M0_RPC_LAT_SERVICE].rlh_nr == 0);
+	rc = m0_rpc_machine_get_opstats(smach, opcode, &os, true);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(os.ros_nr_served == 1 &&
+		     os.ros_lat[M0_RPC_LAT_SERVICE].rlh_nr == 1);
+	rc = m0_rpc_machine_get_opstats(smach, opcode, &os, false);
+	M0_UT_ASSERT(rc == 0 && os.ros_nr_served == 0);
+	rc = m0_rpc_machine_get_opstats(machine, M0_OPCODES_NR, &os, false);
+	M0_UT_ASSERT(rc == -ENOENT);
+	m0_fop_put_lock(fop);
+}
+
+static struct m0_semaphore busy_sem;
+
+static void busy_ast_cb(struct m0_sm_group *grp, struct m0_sm_ast *ast)
+{
+	/* Keep the locality handler away from its run-queue. */
+	m0_semaphore_down(&busy_sem);
+}
+
+static bool item_is_busy(const struct m0_rpc_item *item)
+{
+	return item->ri_reply != NULL &&
+		(item->ri_reply->ri_flags & M0_RIF_BUSY) != 0;
+}
+
+static void test_busy(void)
+{
+	struct m0_reqh              *reqh = m0_cs_reqh_get(&sctx.rsx_motr_ctx);
+	struct m0_fom_domain        *dom  = m0_fom_dom();
+	struct m0_sm_ast             ast  = { .sa_cb = &busy_ast_cb };
+	struct m0_reqh_service      *svc;
+	struct m0_fom_locality      *loc;
+	struct m0_fop               *fops[2];
+	struct m0_fop               *reply;
+	struct m0_fop_generic_reply *rep;
+	m0_time_t                    start;
+	int                          busy;
+	int                          i;
+	int                          rc;
+
+	svc = m0_reqh_service_find(cs_ds2_req_fop_fopt.ft_fom_type.ft_rstype,
+				   reqh);
+	M0_UT_ASSERT(svc != NULL);
+
+	/*
+	 * A service at m0_reqh_service::rs_fom_max refuses requests with a
+	 * generic -EBUSY reply, each refusal doubles the session hold.
+	 */
+	svc->rs_fom_max = 1;
+	m0_atomic64_inc(&svc->rs_fom_active);
+	for (i = 0; i < 2; ++i) {
+		start = m0_time_now();
+		fop = fop_alloc(machine);
+		rc = m0_rpc_post_sync(fop, session, NULL, 0 /* deadline */);
+		M0_UT_ASSERT(rc == 0 && item_is_busy(&fop->f_item));
+		reply = m0_rpc_item_to_fop(fop->f_item.ri_reply);
+		M0_UT_ASSERT(reply->f_type == &m0_fop_generic_reply_fopt);
+		rep = m0_fop_data(reply);
+		M0_UT_ASSERT(rep->gr_rc == -EBUSY);
+		M0_UT_ASSERT(session->s_busy_hold ==
+			     (M0_RPC_SESSION_BUSY_HOLD_MIN << i));
+		M0_UT_ASSERT(session->s_busy_until >=
+			     start + session->s_busy_hold);
+		m0_fop_put_lock(fop);
+	}
+	m0_atomic64_dec(&svc->rs_fom_active);
+	svc->rs_fom_max = 0;
+
+	/* A served request resets the hold. */
+	fop = fop_alloc(machine);
+	rc = m0_rpc_post_sync(fop, session, NULL, 0 /* deadline */);
+	M0_UT_ASSERT(rc == 0 && !item_is_busy(&fop->f_item));
+	M0_UT_ASSERT(session->s_busy_hold == 0);
+	m0_fop_put_lock(fop);
+
+	/*
+	 * Requests queued behind each other in a locality with
+	 * m0_reqh::rh_runq_max of 1: the first one to run finds the other one
+	 * in the run-queue and fails in its init phase.
+	 */
+	loc = dom->fd_localities[M0_CS_DS2_REQ_OPCODE % dom->fd_localities_nr];
+	reqh->rh_runq_max = 1;
+	m0_semaphore_init(&busy_sem, 0);
+	m0_sm_ast_post(&loc->fl_group, &ast);
+	for (i = 0; i < ARRAY_SIZE(fops); ++i) {
+		fops[i] = fop_alloc(machine);
+		fops[i]->f_item.ri_session  = session;
+		fops[i]->f_item.ri_deadline = 0;
+		rc = m0_rpc_post(&fops[i]->f_item);
+		M0_UT_ASSERT(rc == 0);
+	}
+	while (m0_atomic64_get(&svc->rs_fom_queued) < ARRAY_SIZE(fops))
+		m0_nanosleep(M0_TIME_ONE_MSEC, NULL);
+	m0_semaphore_up(&busy_sem);
+	for (i = 0, busy = 0; i < ARRAY_SIZE(fops); ++i) {
+		rc = m0_rpc_item_wait_for_reply(&fops[i]->f_item,
+						M0_TIME_NEVER);
+		M0_UT_ASSERT(rc == 0);
+		if (item_is_busy(&fops[i]->f_item)) {
+			/* Replies of failed foms start with the error code. */
+			reply = m0_rpc_item_to_fop(fops[i]->f_item.ri_reply);
+			M0_UT_ASSERT(*(int32_t *)m0_fop_data(reply) == -EBUSY);
+			busy++;
+		}
+		m0_fop_put_lock(fops[i]);
+	}
+	M0_UT_ASSERT(busy >= 1);
+	reqh->rh_runq_max = 0;
+	m0_semaphore_fini(&busy_sem);
+
+	fop = fop_alloc(machine);
+	rc = m0_rpc_post_sync(fop, session, NULL, 0 /* deadline */);
+	M0_UT_ASSERT(rc == 0 && !item_is_busy(&fop->f_item));
+	M0_UT_ASSERT(session->s_busy_hold == 0);
+	m0_fop_put_lock(fop);
+}
+
 void disable_packet_ready_set_reply_error(int arg)
 {
 	m0_nanosleep(m0_time(M0_RPC_ITEM_RESEND_INTERVAL * 2 + 1, 0), NULL);
@@ -1296,7 +1454,9 @@ struct m0_ut_suite item_ut = {
 	.ts_tests = {
 		{ "cache",		    test_item_cache		},
 		{ "simple-transitions",     test_simple_transitions     },
+		{ "opstats",                test_opstats                },
 		{ "reply-item-error",       test_reply_item_error       },
+		{ "busy",                   test_busy                   },
 		{ "item-timeout",           test_timeout                },
 		{ "item-resend",            test_resend                 },
 		{ "failure-before-sending", test_failure_before_sending },
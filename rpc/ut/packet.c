@@ -41,7 +41,7 @@
 
 static struct m0_rpc_machine rmachine;
 
-static struct m0_rpc_item *prepare_ping_fop_item(void);
+static struct m0_rpc_item *prepare_ping_fop_item(uint32_t nr);
 static struct m0_rpc_item *prepare_ping_rep_fop_item(void);
 static void fill_ping_fop_data(struct m0_fop_ping_arr *fp_arr);
 static void populate_item(struct m0_rpc_item *item);
@@ -77,7 +77,7 @@ static void test_packet_encode_decode(void)
 
 	m0_rpc_packet_init(&packet, &rmachine);
 
-	item = prepare_ping_fop_item();
+	item = prepare_ping_fop_item(1);
 	m0_sm_group_lock(&rmachine.rm_sm_grp);
 	m0_rpc_packet_add_item(&packet, item);
 	m0_rpc_item_put(item);
@@ -118,7 +118,52 @@ static void test_packet_encode_decode(void)
 	m0_bufvec_free_aligned(&bufvec, M0_SEG_SHIFT);
 }
 
-static struct m0_rpc_item* prepare_ping_fop_item(void)
+static void test_packet_compress(void)
+{
+	struct m0_rpc_item  *item;
+	struct m0_rpc_packet packet;
+	struct m0_rpc_packet decoded_packet;
+	struct m0_bufvec     bufvec;
+	m0_bcount_t          bufvec_size;
+	m0_bcount_t          size;
+	int		     rc;
+
+	m0_rpc_packet_init(&packet, &rmachine);
+	item = prepare_ping_fop_item(1024);
+	m0_sm_group_lock(&rmachine.rm_sm_grp);
+	m0_rpc_packet_add_item(&packet, item);
+	m0_rpc_item_put(item);
+	m0_sm_group_unlock(&rmachine.rm_sm_grp);
+	bufvec_size = m0_align(packet.rp_size, 8);
+	rc = m0_bufvec_alloc_aligned(&bufvec, 1, bufvec_size, M0_SEG_SHIFT);
+	M0_UT_ASSERT(rc == 0);
+	packet.rp_compress = true;
+	m0_sm_group_lock(&rmachine.rm_sm_grp);
+	rc = m0_rpc_packet_encode(&packet, &bufvec);
+	m0_sm_group_unlock(&rmachine.rm_sm_grp);
+	M0_UT_ASSERT(rc == 0);
+	size = m0_rpc_packet_onwire_size(&packet);
+#if defined(HAVE_LZ4) && !defined(__KERNEL__)
+	/* The array of the ping fop is compressible. */
+	M0_UT_ASSERT(packet.rp_zsize != 0);
+	M0_UT_ASSERT(size < bufvec_size);
+	M0_UT_ASSERT(packet.rp_ow.poh_flags & M0_RPC_PACKET_LZ4);
+#else
+	M0_UT_ASSERT(packet.rp_zsize == 0);
+	M0_UT_ASSERT(size == bufvec_size);
+#endif
+	m0_rpc_packet_init(&decoded_packet, &rmachine);
+	rc = m0_rpc_packet_decode(&decoded_packet, &bufvec, 0, size);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(decoded_packet.rp_zsize == packet.rp_zsize);
+
+	packet_compare(&packet, &decoded_packet);
+	packet_fini(&packet);
+	packet_fini(&decoded_packet);
+	m0_bufvec_free_aligned(&bufvec, M0_SEG_SHIFT);
+}
+
+static struct m0_rpc_item* prepare_ping_fop_item(uint32_t nr)
 {
 	struct m0_fop      *ping_fop;
 	struct m0_fop_ping *ping_fop_data;
@@ -127,7 +172,7 @@ static struct m0_rpc_item* prepare_ping_fop_item(void)
 	ping_fop = m0_fop_alloc(&m0_fop_ping_fopt, NULL, &rmachine);
 	M0_UT_ASSERT(ping_fop != NULL);
 	ping_fop_data = m0_fop_data(ping_fop);
-	ping_fop_data->fp_arr.f_count = 1;
+	ping_fop_data->fp_arr.f_count = nr;
 	M0_ALLOC_ARR(ping_fop_data->fp_arr.f_data,
 		     ping_fop_data->fp_arr.f_count);
 	M0_UT_ASSERT(ping_fop_data->fp_arr.f_data != NULL);
@@ -262,6 +307,7 @@ struct m0_ut_suite packet_encdec_ut = {
 	.ts_fini = packet_encdec_ut_fini,
 	.ts_tests = {
 		{ "packet-encode-decode-test", test_packet_encode_decode},
+		{ "packet-compress-test",      test_packet_compress},
 		{ NULL, NULL}
 	}
 };
@@ -119,6 +119,40 @@ static void rpc_mc_fini_race_test(void)
 	m0_fi_disable("buf_send_cb", "delay_callback");
 }
 
+static void rpc_mc_shards_test(void)
+{
+	enum { SHARDS_NR = 2 };
+	struct m0_rpc_conn    conn;
+	struct m0_rpc_session session;
+	uint64_t              works = 0;
+	uint32_t              i;
+	int                   rc;
+
+	rc = m0_rpc_machine_init(&machine, &client_net_dom, ep_addr,
+				 &reqh, &buf_pool, M0_BUFFER_ANY_COLOUR,
+				 max_rpc_msg_size, tm_recv_queue_min_len);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_rpc_machine_shards_init(&machine, SHARDS_NR);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(machine.rm_shards_nr == SHARDS_NR);
+	/* Connection to itself: packets go both ways through the shards. */
+	rc = m0_rpc_client_connect(&conn, &session,
+	                           &machine,
+	                           machine.rm_tm.ntm_ep->nep_addr,
+				   NULL, MAX_RPCS_IN_FLIGHT,
+				   M0_TIME_NEVER);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_rpc_session_destroy(&session, M0_TIME_NEVER);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_rpc_conn_destroy(&conn, M0_TIME_NEVER);
+	M0_UT_ASSERT(rc == 0);
+	for (i = 0; i < SHARDS_NR; ++i)
+		works += machine.rm_shards[i].rs_nr_works;
+	M0_UT_ASSERT(works > 0);
+	m0_rpc_machine_fini(&machine);
+	M0_UT_ASSERT(machine.rm_shards == NULL);
+}
+
 static void rpc_mc_init_fail_test(void)
 {
 	int rc;
@@ -226,6 +260,7 @@ struct m0_ut_suite rpc_mc_ut = {
 	.ts_tests = {
 		{ "rpc_mc_init_fini", rpc_mc_init_fini_test },
 		{ "rpc_mc_fini_race", rpc_mc_fini_race_test },
+		{ "rpc_mc_shards",    rpc_mc_shards_test },
 		{ "rpc_mc_init_fail", rpc_mc_init_fail_test },
 #ifndef __KERNEL__
 		{ "rpc_mc_watch",     rpc_machine_watch_test},
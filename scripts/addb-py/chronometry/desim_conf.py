@@ -0,0 +1,158 @@
+#
+# Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# For any questions about this software or licensing,
+# please email opensource@seagate.com or cortx-questions@seagate.com.
+#
+
+# Request handler model parameters for desim (desim/reqh.h) from addb2.
+#
+# Foms of the given request opcode are taken from the performance database.
+# For every phase of the most common phase sequence, the time the fom is
+# Running in the phase is its service time and the time it is Waiting is its
+# wait time. The phase in which the fom transaction is closed is marked as
+# transactional. BE group sizes and group logging times are taken from
+# tx-to-gr and be-tx records of the same process.
+#
+# Output is a reqh_conf_load() file, for desim/ut/reqh_test -f. min and max
+# are the given percentiles, as desim draws times uniformly.
+
+import sys
+import argparse
+from collections import Counter
+import numpy as np
+from addb2db import *
+
+def timelines_load(table, pid, ids):
+    timelines = {}
+    with DB.atomic():
+        for r in DB.execute_sql(f"SELECT id, time, state FROM {table} "
+                                f"WHERE pid={pid};"):
+            if r[0] in ids:
+                timelines.setdefault(r[0], []).append((r[1], r[2]))
+    for t in timelines.values():
+        t.sort()
+    return timelines
+
+def overlap(timeline, state, t0, t1):
+    ends = [t for t, _ in timeline[1:]] + [t1]
+    return sum(max(0, min(e, t1) - max(t, t0))
+               for (t, s), e in zip(timeline, ends) if s == state)
+
+def foms_load(pid, opcode):
+    with DB.atomic():
+        return list(DB.execute_sql(
+            "SELECT fom_desc.fom_sm_id, fom_desc.fom_state_sm_id, "
+            "fom_to_tx.tx_id FROM fom_desc LEFT JOIN fom_to_tx ON "
+            "fom_desc.fom_sm_id=fom_to_tx.fom_id AND "
+            "fom_desc.pid=fom_to_tx.pid "
+            f"WHERE fom_desc.pid={pid} AND "
+            f"fom_desc.req_opcode LIKE '%{opcode}%';"))
+
+def phases_get(pid, opcode):
+    foms = foms_load(pid, opcode)
+    phases = timelines_load("fom_req", pid, {f[0] for f in foms})
+    states = timelines_load("fom_req_state", pid, {f[1] for f in foms})
+    txs = timelines_load("be_tx", pid, {f[2] for f in foms if f[2]})
+
+    seqs = Counter(tuple(s for _, s in phases[f[0]])
+                   for f in foms if f[0] in phases)
+    if not seqs:
+        return None
+    seq = seqs.most_common(1)[0][0]
+    cpu = [[] for _ in seq[:-1]]
+    wait = [[] for _ in seq[:-1]]
+    tx = Counter()
+    for fom, state_id, tx_id in foms:
+        ph = phases.get(fom)
+        if ph is None or tuple(s for _, s in ph) != seq:
+            continue
+        st = states.get(state_id, [])
+        closed = next((t for t, s in txs.get(tx_id, []) if s == "closed"),
+                      None)
+        for i, ((t0, _), (t1, _)) in enumerate(zip(ph, ph[1:])):
+            cpu[i].append(overlap(st, "Running", t0, t1))
+            wait[i].append(overlap(st, "Waiting", t0, t1))
+            if closed is not None and t0 <= closed < t1:
+                tx[i] += 1
+    tx_phase = tx.most_common(1)[0][0] if tx else None
+    return [(seq[i], cpu[i], wait[i], i == tx_phase)
+            for i in range(len(seq) - 1)]
+
+def groups_get(pid):
+    with DB.atomic():
+        sizes = Counter(r[0] for r in DB.execute_sql(
+            f"SELECT gr_id FROM tx_to_gr WHERE pid={pid};"))
+        tx = {}
+        for i, t, s in DB.execute_sql(
+                f"SELECT id, time, state FROM be_tx WHERE pid={pid} "
+                "AND state IN ('closed', 'logged');"):
+            tx.setdefault(i, {})[s] = t
+    log = [v['logged'] - v['closed'] for v in tx.values() if len(v) == 2]
+    return list(sizes.values()), log
+
+def localities_get(pid):
+    with DB.atomic():
+        r = list(DB.execute_sql("SELECT COUNT(DISTINCT locality) FROM queues "
+                                f"WHERE pid={pid};"))
+    return r[0][0] if r else 0
+
+def report(pid, opcode, pmin, pmax):
+    def rng(vals):
+        lo, hi = np.percentile(vals, [pmin, pmax]) if vals else (0, 0)
+        return int(lo), int(hi)
+
+    phases = phases_get(pid, opcode)
+    if phases is None:
+        die(f"No {opcode} foms in process {pid}.")
+    print(f"# {opcode} foms of process {pid}, "
+          f"p{pmin}..p{pmax}, nanoseconds")
+    nr = localities_get(pid)
+    if nr > 0:
+        print(f"nr_localities {nr}")
+    sizes, log = groups_get(pid)
+    if sizes:
+        print(f"grp_tx_max {max(sizes)}")
+        lo, hi = rng(log)
+        print(f"log_delay_min {lo}\nlog_delay_max {hi}\nlog_rate 0")
+    for name, cpu, wait, tx in phases:
+        cmin, cmax = rng(cpu)
+        wmin, wmax = (0, 0) if tx else rng(wait)
+        print(f"phase {name.replace(' ', '-')} {cmin} {cmax} {wmin} {wmax}"
+              f"{' tx' if tx else ''}")
+
+def parse_args():
+    parser = argparse.ArgumentParser(prog=sys.argv[0], description="""
+    desim_conf.py: desim request handler model parameters from addb2.
+    """)
+    parser.add_argument("-p", "--pid", type=int, required=True,
+                        help="Server pid to get foms for")
+    parser.add_argument("-o", "--opcode", type=str, default="WRITE",
+                        help="Request opcode pattern, e.g. WRITE or CAS_PUT")
+    parser.add_argument("--min", type=int, default=10,
+                        help="Percentile taken as the minimum")
+    parser.add_argument("--max", type=int, default=90,
+                        help="Percentile taken as the maximum")
+    parser.add_argument("-d", "--db", type=str, default="m0play.db",
+                        help="Performance database (m0play.db)")
+    return parser.parse_args()
+
+if __name__ == '__main__':
+    args = parse_args()
+
+    db_init(args.db)
+    db_connect()
+    report(args.pid, args.opcode, args.min, args.max)
+    db_close()
@@ -0,0 +1,188 @@
+#
+# Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# For any questions about this software or licensing,
+# please email opensource@seagate.com or cortx-questions@seagate.com.
+#
+
+# Per-stage latency breakdown of client object i/o.
+#
+# Every client operation is joined with its ioo request, the client and
+# server rpc items, the ioservice fom, its stob i/o and its BE transaction,
+# as io_req.py does for a single request. For an operation split into
+# several rpcs the chain of the rpc replied last is taken: it is the one
+# determining the latency of the operation.
+#
+# A stage is the time spent by a request in a state, named by the layer
+# and the state ("fom:tx_open"). Network stages are estimated from the
+# client and server timestamps, which are comparable on a single node.
+# Operations are grouped by their i/o size taken from the ioo attributes.
+
+import sys
+import argparse
+import numpy as np
+from addb2db import *
+
+OPCODES = { "write": 42, "read": 41 }
+CONV    = { "us": 1000, "ms": 1000*1000 }
+
+relations_query = """
+SELECT DISTINCT
+client_to_ioo.pid, client_to_ioo.client_id, client_to_ioo.ioo_id,
+ioo_to_rpc.rpc_id, fom_desc.pid, fom_desc.rpc_sm_id, fom_desc.fom_sm_id,
+fom_to_stio.stio_id, fom_to_tx.tx_id
+
+FROM client_to_ioo
+JOIN ioo_to_rpc  on client_to_ioo.ioo_id=ioo_to_rpc.ioo_id
+JOIN rpc_to_sxid on rpc_to_sxid.id=ioo_to_rpc.rpc_id
+JOIN sxid_to_rpc on rpc_to_sxid.xid=sxid_to_rpc.xid AND rpc_to_sxid.session_id=sxid_to_rpc.session_id
+JOIN fom_desc    on sxid_to_rpc.id=fom_desc.rpc_sm_id
+LEFT JOIN fom_to_tx   on fom_desc.fom_sm_id=fom_to_tx.fom_id
+LEFT JOIN fom_to_stio on fom_desc.fom_sm_id=fom_to_stio.fom_id
+
+WHERE sxid_to_rpc.opcode={opcode} AND rpc_to_sxid.opcode={opcode}
+AND   rpc_to_sxid.xid        > 0
+AND   rpc_to_sxid.session_id > 0
+{pid_filter}
+AND   client_to_ioo.pid=ioo_to_rpc.pid AND client_to_ioo.pid=rpc_to_sxid.pid
+AND   sxid_to_rpc.pid=fom_desc.pid
+AND   (fom_to_stio.stio_id is NULL OR fom_desc.pid=fom_to_stio.pid)
+AND   (fom_to_tx.tx_id is NULL OR fom_desc.pid=fom_to_tx.pid);
+"""
+
+def timelines_load(table):
+    timelines = {}
+    with DB.atomic():
+        for r in DB.execute_sql(f"SELECT pid, id, time, state FROM {table};"):
+            timelines.setdefault((r[0], r[1]), []).append((r[2], r[3]))
+    for t in timelines.values():
+        t.sort()
+    return timelines
+
+def sizes_load():
+    attrs = {}
+    with DB.atomic():
+        for pid, eid, name, val in DB.execute_sql(
+                "SELECT pid, entity_id, name, val FROM attr WHERE name IN "
+                "('M0_AVI_IOO_ATTR_BUFS_NR', 'M0_AVI_IOO_ATTR_BUF_SIZE');"):
+            attrs.setdefault((pid, eid), {})[name] = int(val)
+    return {k: v['M0_AVI_IOO_ATTR_BUFS_NR'] * v['M0_AVI_IOO_ATTR_BUF_SIZE']
+            for k, v in attrs.items() if len(v) == 2}
+
+def state_time(timeline, state):
+    return next((t for t, s in timeline if s == state), None)
+
+def stages_add(stages, layer, timeline):
+    for (t0, s), (t1, _) in zip(timeline, timeline[1:]):
+        stages.append((f"{layer}:{s}", t1 - t0))
+
+def op_stages(tl, chain):
+    cli_pid, client_id, ioo_id, crpc_id, srv_pid, srpc_id, fom_id, stio_id, \
+        tx_id = chain
+    client = tl["client_req"].get((cli_pid, client_id), [])
+    ioo    = tl["ioo_req"].get((cli_pid, ioo_id), [])
+    crpc   = tl["rpc_req"].get((cli_pid, crpc_id), [])
+    srpc   = tl["rpc_req"].get((srv_pid, srpc_id), [])
+    if not client or not ioo or not crpc or not srpc:
+        return None
+
+    stages = [("total", client[-1][0] - client[0][0]),
+              ("client:launch", ioo[0][0] - client[0][0])]
+    stages_add(stages, "ioo", ioo)
+    stages_add(stages, "crpc", crpc)
+    sending = state_time(crpc, "SENDING")
+    if sending is not None:
+        stages.append(("net:request", srpc[0][0] - sending))
+    stages_add(stages, "srpc", srpc)
+    stages_add(stages, "fom", tl["fom_req"].get((srv_pid, fom_id), []))
+    if stio_id is not None:
+        stages_add(stages, "stio", tl["stio_req"].get((srv_pid, stio_id), []))
+    if tx_id is not None:
+        stages_add(stages, "tx", tl["be_tx"].get((srv_pid, tx_id), []))
+    replied = state_time(crpc, "REPLIED")
+    if replied is not None:
+        stages.append(("net:reply", replied - srpc[-1][0]))
+    return stages
+
+def breakdown(opcode, pid):
+    pid_filter = f"AND   client_to_ioo.pid={pid}" if pid is not None else ""
+    with DB.atomic():
+        rows = list(DB.execute_sql(relations_query.format(
+            opcode=opcode, pid_filter=pid_filter)))
+
+    tl = { t: timelines_load(t) for t in ("client_req", "ioo_req", "rpc_req",
+                                          "fom_req", "stio_req", "be_tx") }
+    sizes = sizes_load()
+
+    # The chain of the rpc replied last, for each client operation.
+    chains = {}
+    for r in rows:
+        crpc = tl["rpc_req"].get((r[0], r[3]), [])
+        if not crpc:
+            continue
+        key = (r[0], r[1])
+        if key not in chains or crpc[-1][0] > chains[key][0]:
+            chains[key] = (crpc[-1][0], r)
+
+    result = {}
+    for _, chain in chains.values():
+        size = sizes.get((chain[0], chain[2]))
+        stages = op_stages(tl, chain)
+        if size is None or stages is None:
+            continue
+        per_size = result.setdefault(size, {})
+        for name, dur in stages:
+            per_size.setdefault(name, []).append(dur)
+    return result
+
+def report(result, unit):
+    conv = CONV[unit]
+    for size in sorted(result):
+        stages = result[size]
+        total = np.median(stages["total"])
+        print(f"io size: {size}, ops: {len(stages['total'])}")
+        print(f"  {'stage':40} {'nr':>8} {'p50_'+unit:>12} "
+              f"{'p99_'+unit:>12} {'p50_%':>7}")
+        for name, durs in stages.items():
+            p50, p99 = np.percentile(durs, [50, 99])
+            print(f"  {name:40} {len(durs):>8} {p50/conv:>12.1f} "
+                  f"{p99/conv:>12.1f} {100*p50/total if total else 0:>7.1f}")
+
+def parse_args():
+    parser = argparse.ArgumentParser(prog=sys.argv[0], description="""
+    io_breakdown.py: per-stage latency breakdown of client object i/o by
+    i/o size.
+    """)
+    parser.add_argument("-o", "--op", choices=OPCODES.keys(), default="write",
+                        help="Operation to break down")
+    parser.add_argument("-p", "--pid", type=int, default=None,
+                        help="Client pid to get requests for")
+    parser.add_argument("-u", "--time-unit", choices=['ms','us'], default='us',
+                        help="Default time unit")
+    parser.add_argument("-d", "--db", type=str, default="m0play.db",
+                        help="Performance database (m0play.db)")
+    return parser.parse_args()
+
+if __name__ == '__main__':
+    args = parse_args()
+
+    db_init(args.db)
+    db_connect()
+    result = breakdown(OPCODES[args.op], args.pid)
+    db_close()
+
+    if not result:
+        die("No client operations found.")
+    report(result, args.time_unit)
@@ -33,6 +33,7 @@
 #include "lib/locality.h"           /* m0_locality_data_alloc */
 #include "addb2/addb2.h"
 #include "addb2/identifier.h"
+#include "motr/magic.h"
 #include "sm/sm.h"
 
 /**
@@ -144,7 +145,41 @@ M0_INTERNAL void m0_sm_ast_post(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 		       grp, ast, ast->sa_next);
 		*/
 	} while (!M0_ATOMIC64_CAS(&grp->s_forkq, ast->sa_next, ast));
-	m0_clink_signal(&grp->s_clink);
+	/*
+	 * Only the first ast posted to an empty fork queue wakes the group
+	 * up: the woken thread runs m0_sm_asts_run(), which pops asts until
+	 * the queue is empty again, so the asts posted later are picked up
+	 * without more signals. See "Fork queue wakeups" in sm.h.
+	 */
+	if (ast->sa_next == &eoq)
+		m0_clink_signal(&grp->s_clink);
+}
+
+static bool ast_chain_is_valid(const struct m0_sm_ast *head,
+			       const struct m0_sm_ast *tail)
+{
+	const struct m0_sm_ast *ast;
+
+	for (ast = head; ast != NULL && ast->sa_cb != NULL; ast = ast->sa_next) {
+		if (ast == tail)
+			return true;
+	}
+	return false;
+}
+
+M0_INTERNAL void m0_sm_ast_chain_post(struct m0_sm_group *grp,
+				      struct m0_sm_ast *head,
+				      struct m0_sm_ast *tail)
+{
+	M0_PRE(head != NULL && tail != NULL);
+	M0_PRE(tail->sa_next == NULL);
+	M0_PRE(ast_chain_is_valid(head, tail));
+
+	do {
+		tail->sa_next = grp->s_forkq;
+	} while (!M0_ATOMIC64_CAS(&grp->s_forkq, tail->sa_next, head));
+	if (tail->sa_next == &eoq)
+		m0_clink_signal(&grp->s_clink);
 }
 
 M0_INTERNAL void m0_sm_asts_run(struct m0_sm_group *grp)
@@ -518,6 +553,161 @@ enum timer_state {
 	DONE
 };
 
+M0_TL_DESCR_DEFINE(wheel, "sm wheel", static, struct m0_sm_timer, tr_linkage,
+		   tr_magix, M0_SM_TIMER_MAGIC, M0_SM_WHEEL_MAGIC);
+M0_TL_DEFINE(wheel, static, struct m0_sm_timer);
+
+enum { WHEEL_TICK = M0_TIME_ONE_MSEC };
+
+/** Index of the slot of the tick at the level. */
+static uint32_t wheel_idx(uint64_t tick, int level)
+{
+	return (tick >> (M0_SM_WHEEL_BITS * level)) & (M0_SM_WHEEL_SLOTS - 1);
+}
+
+/** The first tick starting not earlier than t. */
+static uint64_t wheel_tick_ceil(const struct m0_sm_wheel *wheel, m0_time_t t)
+{
+	m0_time_t delta = t > wheel->sw_base ? t - wheel->sw_base : 0;
+
+	return delta / WHEEL_TICK + (delta % WHEEL_TICK != 0);
+}
+
+/** The last tick starting not later than t. */
+static uint64_t wheel_tick_floor(const struct m0_sm_wheel *wheel, m0_time_t t)
+{
+	return t > wheel->sw_base ? (t - wheel->sw_base) / WHEEL_TICK : 0;
+}
+
+static void wheel_insert(struct m0_sm_wheel *wheel, struct m0_sm_timer *timer)
+{
+	uint64_t tick  = max64u(timer->tr_tick, wheel->sw_now);
+	uint64_t delta = tick - wheel->sw_now;
+	int      level = 0;
+
+	while (level < M0_SM_WHEEL_LEVELS - 1 &&
+	       (delta >> (M0_SM_WHEEL_BITS * (level + 1))) != 0)
+		++level;
+	if ((delta >> (M0_SM_WHEEL_BITS * M0_SM_WHEEL_LEVELS)) != 0)
+		/* Too far away: park in the farthest slot. */
+		tick = wheel->sw_now +
+			(1ULL << (M0_SM_WHEEL_BITS * M0_SM_WHEEL_LEVELS)) - 1;
+	wheel_tlist_add_tail(&wheel->sw_slot[level][wheel_idx(tick, level)],
+			     timer);
+}
+
+static void wheel_move(struct m0_tl *dst, struct m0_tl *src)
+{
+	struct m0_sm_timer *timer;
+
+	while ((timer = wheel_tlist_pop(src)) != NULL)
+		wheel_tlist_add_tail(dst, timer);
+}
+
+/** Re-distributes the current slot of the level over the lower levels. */
+static void wheel_cascade(struct m0_sm_wheel *wheel, int level)
+{
+	struct m0_sm_timer *timer;
+	struct m0_tl        batch;
+
+	wheel_tlist_init(&batch);
+	wheel_move(&batch,
+		   &wheel->sw_slot[level][wheel_idx(wheel->sw_now, level)]);
+	while ((timer = wheel_tlist_pop(&batch)) != NULL)
+		wheel_insert(wheel, timer);
+	wheel_tlist_fini(&batch);
+}
+
+M0_INTERNAL void m0_sm_wheel_init(struct m0_sm_wheel *wheel,
+				  struct m0_sm_group *grp)
+{
+	int i;
+	int j;
+
+	M0_PRE(grp->s_wheel == NULL);
+
+	M0_SET0(wheel);
+	for (i = 0; i < M0_SM_WHEEL_LEVELS; ++i) {
+		for (j = 0; j < M0_SM_WHEEL_SLOTS; ++j)
+			wheel_tlist_init(&wheel->sw_slot[i][j]);
+	}
+	wheel->sw_base = m0_time_now();
+	wheel->sw_grp  = grp;
+	grp->s_wheel   = wheel;
+}
+
+M0_INTERNAL void m0_sm_wheel_fini(struct m0_sm_wheel *wheel)
+{
+	int i;
+	int j;
+
+	M0_PRE(wheel->sw_nr == 0);
+	M0_PRE(wheel->sw_grp->s_wheel == wheel);
+
+	for (i = 0; i < M0_SM_WHEEL_LEVELS; ++i) {
+		for (j = 0; j < M0_SM_WHEEL_SLOTS; ++j)
+			wheel_tlist_fini(&wheel->sw_slot[i][j]);
+	}
+	wheel->sw_grp->s_wheel = NULL;
+}
+
+M0_INTERNAL void m0_sm_wheel_run(struct m0_sm_wheel *wheel)
+{
+	struct m0_sm_timer *timer;
+	struct m0_tl        expired;
+	uint64_t            last;
+	int                 level;
+
+	M0_PRE(grp_is_locked(wheel->sw_grp));
+
+	if (wheel->sw_nr == 0)
+		return;
+	last = wheel_tick_floor(wheel, m0_time_now());
+	wheel_tlist_init(&expired);
+	while (wheel->sw_now <= last && wheel->sw_nr > 0) {
+		for (level = 1; level < M0_SM_WHEEL_LEVELS &&
+			     wheel_idx(wheel->sw_now, level - 1) == 0; ++level)
+			wheel_cascade(wheel, level);
+		/*
+		 * Detach the slot before running call-backs: a call-back can
+		 * arm a timer that goes into the same slot of the next round.
+		 */
+		wheel_move(&expired,
+			   &wheel->sw_slot[0][wheel_idx(wheel->sw_now, 0)]);
+		++wheel->sw_now;
+		/*
+		 * A call-back can cancel another expired timer, which removes
+		 * it from "expired".
+		 */
+		while ((timer = wheel_tlist_pop(&expired)) != NULL) {
+			M0_ASSERT(timer->tr_state == ARMED);
+			--wheel->sw_nr;
+			timer->tr_state = DONE;
+			timer->tr_cb(timer);
+		}
+	}
+	wheel_tlist_fini(&expired);
+	/* Nothing is armed: skip the idle ticks. */
+	if (wheel->sw_nr == 0)
+		wheel->sw_now = max64u(wheel->sw_now, last + 1);
+}
+
+M0_INTERNAL m0_time_t m0_sm_wheel_next(const struct m0_sm_wheel *wheel)
+{
+	uint64_t tick = wheel->sw_now;
+
+	if (wheel->sw_nr == 0)
+		return M0_TIME_NEVER;
+	/*
+	 * Look for a non-empty slot of level 0 up to the next cascade. Timers
+	 * of the higher levels wake the owner at most once a level 0 round.
+	 */
+	while (wheel_tlist_is_empty(&wheel->sw_slot[0][wheel_idx(tick, 0)]) &&
+	       wheel_idx(tick, 0) != 0)
+		++tick;
+	return wheel->sw_base + tick * WHEEL_TICK;
+}
+
 /**
     Timer call-back for a state machine timer.
 
@@ -568,6 +758,7 @@ M0_INTERNAL void m0_sm_timer_init(struct m0_sm_timer *timer)
 	M0_SET0(timer);
 	timer->tr_state     = INIT;
 	timer->tr_ast.sa_cb = sm_timer_bottom;
+	wheel_tlink_init(timer);
 }
 
 M0_INTERNAL void m0_sm_timer_fini(struct m0_sm_timer *timer)
@@ -575,10 +766,11 @@ M0_INTERNAL void m0_sm_timer_fini(struct m0_sm_timer *timer)
 	M0_PRE(M0_IN(timer->tr_state, (INIT, DONE)));
 	M0_PRE(timer->tr_ast.sa_next == NULL);
 
-	if (timer->tr_state == DONE) {
+	if (timer->tr_state == DONE && timer->tr_wheel == NULL) {
 		M0_ASSERT(!m0_timer_is_started(&timer->tr_timer));
 		m0_timer_fini(&timer->tr_timer);
 	}
+	wheel_tlink_fini(timer);
 }
 
 M0_INTERNAL int m0_sm_timer_start(struct m0_sm_timer *timer,
@@ -601,8 +793,27 @@ M0_INTERNAL int m0_sm_timer_start(struct m0_sm_timer *timer,
 	 *      posted from the timer call-back;
 	 *
 	 *    - the AST invokes user-supplied call-back.
+	 *
+	 * If the group has a timer wheel, the timer is simply linked into it
+	 * instead, and the call-back is invoked by group's owner.
 	 */
-
+	if (group->s_wheel != NULL) {
+		struct m0_sm_wheel *wheel = group->s_wheel;
+
+		if (wheel->sw_nr == 0)
+			/* The wheel was idle, catch up with the clock. */
+			wheel->sw_now = max64u(wheel->sw_now,
+					       wheel_tick_floor(wheel,
+								m0_time_now()));
+		timer->tr_state = ARMED;
+		timer->tr_grp   = group;
+		timer->tr_cb    = cb;
+		timer->tr_wheel = wheel;
+		timer->tr_tick  = wheel_tick_ceil(wheel, deadline);
+		wheel_insert(wheel, timer);
+		++wheel->sw_nr;
+		return 0;
+	}
 	result = m0_timer_init(&timer->tr_timer, M0_TIMER_HARD, NULL,
 			       sm_timer_top, (unsigned long)timer);
 	if (result == 0) {
@@ -619,7 +830,11 @@ M0_INTERNAL void m0_sm_timer_cancel(struct m0_sm_timer *timer)
 	M0_PRE(grp_is_locked(timer->tr_grp));
 	M0_PRE(M0_IN(timer->tr_state, (ARMED, DONE)));
 
-	if (timer->tr_state == ARMED) {
+	if (timer->tr_state == ARMED && timer->tr_wheel != NULL) {
+		wheel_tlist_del(timer);
+		--timer->tr_wheel->sw_nr;
+		timer->tr_state = DONE;
+	} else if (timer->tr_state == ARMED) {
 		timer_done(timer);
 		/*
 		 * Once timer_done() returned, the timer call-back
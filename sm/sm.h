@@ -258,6 +258,12 @@ void event_X(struct foo *f)
    latter case, the worker thread can wait on m0_sm_group::s_clink in addition
    to other channels it waits on (see m0_clink_attach()).
 
+   Fork queue wakeups: m0_sm_group::s_clink is signalled only when an ast is
+   posted to an empty fork queue. A thread woken by the signal must call
+   m0_sm_asts_run(), which executes all asts posted by the time it returns,
+   including those posted without a signal while it was running. Many asts
+   posted in a burst thus cost a single wakeup.
+
    m0_sm_group_init() initialises m0_sm_group::s_clink with a NULL call-back. If
    a user wants to re-initialise it with a different call-back or to attach it
    to a clink group, it should call m0_clink_fini() followed by m0_clink_init()
@@ -273,6 +279,7 @@ struct m0_sm_state_stats;
 struct m0_sm_conf;
 struct m0_sm_group;
 struct m0_sm_ast;
+struct m0_sm_wheel;
 struct m0_sm_addb2_stats;
 struct m0_sm_group_addb2;
 struct m0_sm_ast_wait;
@@ -517,6 +524,11 @@ struct m0_sm_group {
 	struct m0_sm_ast         *s_forkq;
 	struct m0_chan            s_chan;
 	struct m0_sm_group_addb2 *s_addb2;
+	/**
+	 * Timer wheel driving the timers of this group, or NULL if each timer
+	 * uses its own m0_timer. See m0_sm_wheel_init().
+	 */
+	struct m0_sm_wheel       *s_wheel;
 };
 
 /**
@@ -624,6 +636,13 @@ struct m0_sm_timer {
 	 * Timer state from enum timer_state (sm.c).
 	 */
 	int                 tr_state;
+	/** Wheel the timer is armed on, NULL if tr_timer is used. */
+	struct m0_sm_wheel *tr_wheel;
+	/** Expiration tick of the wheel. */
+	uint64_t            tr_tick;
+	/** Linkage into a slot of m0_sm_wheel. */
+	struct m0_tlink     tr_linkage;
+	uint64_t            tr_magix;
 };
 
 M0_INTERNAL void m0_sm_timer_init(struct m0_sm_timer *timer);
@@ -646,6 +665,70 @@ M0_INTERNAL int  m0_sm_timer_start(struct m0_sm_timer *timer,
 M0_INTERNAL void m0_sm_timer_cancel(struct m0_sm_timer *timer);
 M0_INTERNAL bool m0_sm_timer_is_armed(const struct m0_sm_timer *timer);
 
+enum {
+	/** log2 of the number of slots in a level of m0_sm_wheel. */
+	M0_SM_WHEEL_BITS   = 6,
+	M0_SM_WHEEL_SLOTS  = 1 << M0_SM_WHEEL_BITS,
+	M0_SM_WHEEL_LEVELS = 4
+};
+
+/**
+ * Hierarchical timer wheel.
+ *
+ * A wheel drives all timers of a state machine group from the thread that
+ * owns the group, instead of having a separate m0_timer (and a posted AST)
+ * per timer. Time is divided into ticks of 1 millisecond. A timer expiring
+ * in less than M0_SM_WHEEL_SLOTS ticks sits in a slot of level 0, a timer
+ * expiring in less than M0_SM_WHEEL_SLOTS^(k + 1) ticks in a slot of level
+ * k. When level 0 wraps around, the current slot of level 1 is cascaded
+ * down, and so on. Timers further away than the top level are parked in
+ * the top level and re-inserted when it wraps.
+ *
+ * Arming and cancelling are O(1) list operations. The wheel is protected by
+ * the group lock. The owner of the group calls m0_sm_wheel_run() from its
+ * event loop and sleeps at most until m0_sm_wheel_next().
+ *
+ * A timer call-back is executed by m0_sm_wheel_run() under the group lock,
+ * as it is without a wheel, but not later than the owner gets around to
+ * it.
+ */
+struct m0_sm_wheel {
+	struct m0_sm_group *sw_grp;
+	/** Time of the tick 0. */
+	m0_time_t           sw_base;
+	/** The first tick not expired yet. */
+	uint64_t            sw_now;
+	/** Number of armed timers. */
+	uint64_t            sw_nr;
+	struct m0_tl        sw_slot[M0_SM_WHEEL_LEVELS][M0_SM_WHEEL_SLOTS];
+};
+
+/**
+ * Initialises the wheel and makes it drive the timers of the group started
+ * from now on.
+ *
+ * @pre grp->s_wheel == NULL
+ */
+M0_INTERNAL void m0_sm_wheel_init(struct m0_sm_wheel *wheel,
+				  struct m0_sm_group *grp);
+/**
+ * Detaches the wheel from its group.
+ *
+ * @pre no timers are armed on the wheel.
+ */
+M0_INTERNAL void m0_sm_wheel_fini(struct m0_sm_wheel *wheel);
+/**
+ * Executes call-backs of all expired timers.
+ *
+ * @pre m0_sm_group_is_locked(wheel->sw_grp)
+ */
+M0_INTERNAL void m0_sm_wheel_run(struct m0_sm_wheel *wheel);
+/**
+ * Returns the time by which m0_sm_wheel_run() should be called next, or
+ * M0_TIME_NEVER if no timers are armed.
+ */
+M0_INTERNAL m0_time_t m0_sm_wheel_next(const struct m0_sm_wheel *wheel);
+
 
 /**
    Structure used by m0_sm_timeout_arm() to record timeout state.
@@ -720,6 +803,16 @@ M0_INTERNAL bool m0_sm_timeout_is_armed(const struct m0_sm_timeout *to);
  */
 M0_INTERNAL void m0_sm_ast_post(struct m0_sm_group *grp, struct m0_sm_ast *ast);
 
+/**
+ * Posts a chain of ASTs to a group with a single wakeup of the group.
+ *
+ * The chain starts at head, is linked through m0_sm_ast::sa_next and ends at
+ * tail, tail->sa_next must be NULL. The ASTs are executed in chain order.
+ */
+M0_INTERNAL void m0_sm_ast_chain_post(struct m0_sm_group *grp,
+				      struct m0_sm_ast *head,
+				      struct m0_sm_ast *tail);
+
 /**
  * Cancels a posted AST.
  *
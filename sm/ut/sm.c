@@ -207,6 +207,82 @@ static void ast_test(void)
 	m0_sm_group_unlock(&G);
 }
 
+static int chain_seq[3];
+static int chain_nr;
+
+static void ast_chain_cb(struct m0_sm_group *g, struct m0_sm_ast *a)
+{
+	M0_UT_ASSERT(g == &G);
+	M0_UT_ASSERT(chain_nr < ARRAY_SIZE(chain_seq));
+	chain_seq[chain_nr++] = (int)(uint64_t)a->sa_datum;
+}
+
+/**
+   Unit test for m0_sm_ast_chain_post().
+ */
+static void ast_chain_test(void)
+{
+	struct m0_sm_ast asts[3] = {};
+	int              i;
+
+	for (i = 0; i < ARRAY_SIZE(asts); ++i) {
+		asts[i].sa_cb = &ast_chain_cb;
+		asts[i].sa_datum = (void *)(uint64_t)i;
+		if (i > 0)
+			asts[i - 1].sa_next = &asts[i];
+	}
+	chain_nr = 0;
+	m0_sm_ast_chain_post(&G, &asts[0], &asts[ARRAY_SIZE(asts) - 1]);
+	M0_UT_ASSERT(chain_nr == 0);
+	m0_sm_group_lock(&G);
+	M0_UT_ASSERT(chain_nr == ARRAY_SIZE(asts));
+	m0_sm_group_unlock(&G);
+	for (i = 0; i < ARRAY_SIZE(asts); ++i) {
+		M0_UT_ASSERT(chain_seq[i] == i);
+		M0_UT_ASSERT(asts[i].sa_next == NULL);
+	}
+	/* A single ast is a chain too. */
+	chain_nr = 0;
+	m0_sm_ast_chain_post(&G, &asts[1], &asts[1]);
+	m0_sm_group_lock(&G);
+	M0_UT_ASSERT(chain_nr == 1 && chain_seq[0] == 1);
+	m0_sm_group_unlock(&G);
+}
+
+/**
+   Checks that a burst of asts costs a single wakeup of the group.
+ */
+static void ast_wakeup_test(void)
+{
+	struct m0_sm_group grp;
+	struct m0_sm_ast   asts[3] = {};
+	int                i;
+
+	m0_sm_group_init(&grp);
+	for (i = 0; i < ARRAY_SIZE(asts); ++i) {
+		asts[i].sa_cb = &ast_chain_cb;
+		asts[i].sa_datum = (void *)(uint64_t)i;
+	}
+	chain_nr = 0;
+	for (i = 0; i < ARRAY_SIZE(asts); ++i)
+		m0_sm_ast_post(&grp, &asts[i]);
+	M0_UT_ASSERT(m0_chan_trywait(&grp.s_clink));
+	M0_UT_ASSERT(!m0_chan_trywait(&grp.s_clink));
+	m0_sm_group_lock(&grp);
+	m0_sm_asts_run(&grp);
+	M0_UT_ASSERT(chain_nr == ARRAY_SIZE(asts));
+	m0_sm_group_unlock(&grp);
+	/* The fork queue is empty again, the next ast signals. */
+	chain_nr = 0;
+	m0_sm_ast_post(&grp, &asts[0]);
+	M0_UT_ASSERT(m0_chan_trywait(&grp.s_clink));
+	m0_sm_group_lock(&grp);
+	m0_sm_asts_run(&grp);
+	M0_UT_ASSERT(chain_nr == 1);
+	m0_sm_group_unlock(&grp);
+	m0_sm_group_fini(&grp);
+}
+
 /**
    Unit test for m0_sm_timeout_arm().
 
@@ -342,6 +418,72 @@ static void timeout(void)
 	m0_sm_group_unlock(&G);
 }
 
+enum { WHEEL_NR = 4 };
+static struct m0_sm_timer wtimer[WHEEL_NR];
+static int                wfired[WHEEL_NR];
+static int                wseq;
+
+static void wheel_cb(struct m0_sm_timer *timer)
+{
+	M0_UT_ASSERT(!m0_sm_timer_is_armed(timer));
+	wfired[timer - wtimer] = ++wseq;
+}
+
+/* Timers of a group with a wheel, driven by the test thread. */
+static void wheel(void)
+{
+	struct m0_sm_group grp;
+	struct m0_sm_wheel wh;
+	const m0_time_t    delays[WHEEL_NR] = {
+		0,
+		M0_TIME_ONE_MSEC * 5,
+		/* Cascaded from level 1. */
+		M0_TIME_ONE_MSEC * 150,
+		M0_TIME_ONE_MSEC * 20
+	};
+	m0_time_t          start;
+	int                result;
+	int                i;
+
+	m0_sm_group_init(&grp);
+	m0_sm_wheel_init(&wh, &grp);
+	m0_sm_group_lock(&grp);
+	M0_UT_ASSERT(m0_sm_wheel_next(&wh) == M0_TIME_NEVER);
+	start = m0_time_now();
+	for (i = 0; i < WHEEL_NR; ++i) {
+		m0_sm_timer_init(&wtimer[i]);
+		result = m0_sm_timer_start(&wtimer[i], &grp, &wheel_cb,
+					   m0_time_add(start, delays[i]));
+		M0_UT_ASSERT(result == 0);
+		M0_UT_ASSERT(m0_sm_timer_is_armed(&wtimer[i]));
+	}
+	m0_sm_timer_cancel(&wtimer[3]);
+	M0_UT_ASSERT(!m0_sm_timer_is_armed(&wtimer[3]));
+	while (m0_sm_wheel_next(&wh) != M0_TIME_NEVER) {
+		M0_UT_ASSERT(m0_sm_wheel_next(&wh) <=
+			     m0_time_add(start, delays[2] + M0_TIME_ONE_MSEC));
+		m0_nanosleep(M0_TIME_ONE_MSEC, NULL);
+		m0_sm_wheel_run(&wh);
+	}
+	M0_UT_ASSERT(m0_time_now() >= m0_time_add(start, delays[2]));
+	M0_UT_ASSERT(wfired[0] == 1 && wfired[1] == 2 && wfired[2] == 3);
+	M0_UT_ASSERT(wfired[3] == 0);
+
+	/* A far away timer is parked and does not fire. */
+	m0_sm_timer_fini(&wtimer[0]);
+	m0_sm_timer_init(&wtimer[0]);
+	result = m0_sm_timer_start(&wtimer[0], &grp, &wheel_cb, M0_TIME_NEVER);
+	M0_UT_ASSERT(result == 0);
+	m0_sm_wheel_run(&wh);
+	M0_UT_ASSERT(m0_sm_timer_is_armed(&wtimer[0]));
+	m0_sm_timer_cancel(&wtimer[0]);
+	for (i = 0; i < WHEEL_NR; ++i)
+		m0_sm_timer_fini(&wtimer[i]);
+	m0_sm_group_unlock(&grp);
+	m0_sm_wheel_fini(&wh);
+	m0_sm_group_fini(&grp);
+}
+
 struct story {
 	struct m0_sm cain;
 	struct m0_sm abel;
@@ -1062,7 +1204,10 @@ struct m0_ut_suite sm_ut = {
 	.ts_tests = {
 		{ "transition",     &transition },
 		{ "ast",            &ast_test },
+		{ "ast-chain",      &ast_chain_test },
+		{ "ast-wakeup",     &ast_wakeup_test },
 		{ "timeout",        &timeout },
+		{ "wheel",          &wheel },
 		{ "group",          &group },
 		{ "chain",          &chain },
 		{ "wait",           &ast_wait },
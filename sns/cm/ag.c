@@ -131,8 +131,8 @@ static int ai_group_next(struct m0_sns_cm_ag_iter *ai)
 	struct m0_fom            *fom;
 	struct m0_sns_cm_file_ctx *fctx = ai->ai_fctx;
 	struct m0_pool_version    *pver;
-	uint64_t                  group_last = ai->ai_group_last;
 	uint64_t                  group = agid2group(&ai->ai_id_curr);
+	uint64_t                  rank = agid2rank(&ai->ai_id_curr);
 	uint64_t                  i;
 	size_t                    nr_bufs;
 	int                       rc = 0;
@@ -145,8 +145,8 @@ static int ai_group_next(struct m0_sns_cm_ag_iter *ai)
 	if (m0_cm_ag_id_is_set(&ai->ai_id_curr))
 		++group;
 	fom = &fctx->sf_scm->sc_base.cm_sw_update.swu_fom;
-	for (i = group; i <= group_last; ++i) {
-		m0_sns_cm_ag_agid_setup(&ai->ai_fid, i, &ag_id);
+	for (i = group; m0_sns_cm_group_next(scm, fctx, &rank, &i); ++i) {
+		m0_sns_cm_ag_agid_setup(&ai->ai_fid, i, rank, &ag_id);
 		if (!m0_sns_cm_ag_is_relevant(scm, fctx, &ag_id))
 			continue;
 		ag = m0_cm_aggr_group_locate(cm, &ag_id, true);
@@ -393,12 +393,17 @@ M0_INTERNAL struct m0_sns_cm_ag *ag2snsag(const struct m0_cm_aggr_group *ag)
 	return container_of(ag, struct m0_sns_cm_ag, sag_base);
 }
 
-M0_INTERNAL void m0_sns_cm_ag_agid_setup(const struct m0_fid *gob_fid, uint64_t group,
-                                         struct m0_cm_ag_id *agid)
+M0_INTERNAL void m0_sns_cm_ag_agid_setup(const struct m0_fid *gob_fid,
+					 uint64_t group, uint64_t rank,
+					 struct m0_cm_ag_id *agid)
 {
         agid->ai_hi.u_hi = gob_fid->f_container;
         agid->ai_hi.u_lo = gob_fid->f_key;
-        agid->ai_lo.u_hi = 0;
+	/*
+	 * Rank goes before the group number, so that identifiers increase in
+	 * the order the groups of a file are repaired.
+	 */
+        agid->ai_lo.u_hi = rank;
         agid->ai_lo.u_lo = group;
 }
 
@@ -417,6 +422,13 @@ M0_INTERNAL uint64_t agid2group(const struct m0_cm_ag_id *id)
 	return id->ai_lo.u_lo;
 }
 
+M0_INTERNAL uint64_t agid2rank(const struct m0_cm_ag_id *id)
+{
+	M0_PRE(id != NULL);
+
+	return id->ai_lo.u_hi;
+}
+
 M0_INTERNAL uint64_t m0_sns_cm_ag_local_cp_nr(const struct m0_cm_aggr_group *ag)
 {
 	struct m0_fid              fid;
@@ -565,7 +577,7 @@ M0_INTERNAL bool m0_sns_cm_ag_is_frozen_on(struct m0_cm_aggr_group *ag, struct m
 
 	ag->cag_is_frozen = sag->sag_not_coming > 0;
 
-	if (!ag->cag_is_frozen && m0_cm_cp_pump_is_complete(&cm->cm_cp_pump) &&
+	if (!ag->cag_is_frozen && m0_cm_cp_pumps_are_complete(cm) &&
 	    sag->sag_cp_created_nr != ag->cag_cp_local_nr)
 			ag->cag_is_frozen = true;
 
@@ -157,8 +157,11 @@ M0_INTERNAL void agid2fid(const struct m0_cm_ag_id *id,
 
 M0_INTERNAL uint64_t agid2group(const struct m0_cm_ag_id *id);
 
+/** Returns repair rank of the group, see m0_sns_cm_group_rank(). */
+M0_INTERNAL uint64_t agid2rank(const struct m0_cm_ag_id *id);
+
 M0_INTERNAL void m0_sns_cm_ag_agid_setup(const struct m0_fid *gob_fid,
-					 uint64_t group,
+					 uint64_t group, uint64_t rank,
 					 struct m0_cm_ag_id *agid);
 
 M0_INTERNAL struct m0_cm *snsag2cm(const struct m0_sns_cm_ag *sag);
@@ -532,6 +532,15 @@ M0_INTERNAL int m0_sns_cm_setup(struct m0_cm *cm)
 		rc = m0_sns_cm_iter_init(&scm->sc_it);
 		if (rc != 0)
 			return M0_RC(rc);
+		rc = m0_sns_ir_pool_init(&scm->sc_ir_pool,
+					 M0_SNS_CM_IR_THREADS_NR);
+		if (rc != 0) {
+			m0_sns_cm_iter_fini(&scm->sc_it);
+			m0_net_buffer_pool_fini(&scm->sc_obp.sb_bp);
+			m0_net_buffer_pool_fini(&scm->sc_ibp.sb_bp);
+			return M0_RC(rc);
+		}
+		m0_sns_cm_throttle_init(&scm->sc_throttle, reqh);
 		sns_cm_bp_init(&scm->sc_obp);
 		sns_cm_bp_init(&scm->sc_ibp);
 	}
@@ -779,6 +788,8 @@ M0_INTERNAL void m0_sns_cm_fini(struct m0_cm *cm)
 
 	scm = cm2sns(cm);
 	m0_sns_cm_iter_fini(&scm->sc_it);
+	m0_sns_ir_pool_fini(&scm->sc_ir_pool);
+	m0_sns_cm_throttle_fini(&scm->sc_throttle);
 
 	/*
 	 * Finalise parents first to avoid usage of finalised mutexes.
@@ -36,6 +36,8 @@
 #include "lib/hash.h"
 #include "cm/repreb/cm.h" /* m0_cm_op */
 #include "ha/msg.h"	  /* m0_ha_msg */
+#include "sns/parity_math.h"	  /* m0_sns_ir_pool */
+#include "sns/cm/throttle.h"	  /* m0_sns_cm_throttle */
 
 
 /**
@@ -125,6 +127,11 @@ enum m0_sns_cm_status {
 	SNS_CM_STATUS_NR,
 };
 
+enum {
+	/** Number of threads of m0_sns_cm::sc_ir_pool. */
+	M0_SNS_CM_IR_THREADS_NR = 4,
+};
+
 enum m0_sns_cm_local_unit_type {
 	M0_SNS_CM_UNIT_LOCAL,
 	M0_SNS_CM_UNIT_HOLE_EOF,
@@ -208,6 +215,20 @@ struct m0_sns_cm {
 	/** Operation that sns copy machine is going to execute. */
 	enum m0_cm_op                   sc_op;
 
+	/**
+	 * True if the repair is prioritised: in each file groups which lost
+	 * more units are repaired first. See m0_sns_cm_group_rank().
+	 */
+	bool                            sc_prio;
+
+	/**
+	 * True if the repair is direct: the failed devices are already
+	 * replaced and units lost on them are reconstructed in place, on the
+	 * replacement devices, instead of on spare units. Such devices are
+	 * not rebalanced after the repair.
+	 */
+	bool                            sc_direct;
+
 	/**
 	 * Helper functions implemented with respect to specific sns copy
 	 * machine operation, viz. repair or re-balance.
@@ -273,6 +294,16 @@ struct m0_sns_cm {
 	/** Resource manager context for this sns copy machine. */
 	struct m0_sns_cm_rm_ctx         sc_rm_ctx;
 
+	/**
+	 * Threads running incremental recovery of repair aggregation groups,
+	 * so that GF math of wide layouts is not bound to a single locality
+	 * thread.
+	 */
+	struct m0_sns_ir_pool           sc_ir_pool;
+
+	/** Limits the rate of stob I/O of copy packets. */
+	struct m0_sns_cm_throttle       sc_throttle;
+
 	/** Magic denoted by M0_SNS_CM_MAGIC. */
 	uint64_t                        sc_magic;
 
@@ -502,6 +502,70 @@ M0_INTERNAL size_t m0_sns_cm_ag_unrepaired_units(const struct m0_sns_cm *scm,
 	return group_failures;
 }
 
+enum {
+	/** Number of bits in m0_sns_cm_file_ctx::sf_ranks. */
+	SNS_CM_RANK_NR = 64,
+};
+
+M0_INTERNAL uint64_t m0_sns_cm_group_rank(struct m0_sns_cm *scm,
+					  struct m0_sns_cm_file_ctx *fctx,
+					  uint64_t group)
+{
+	struct m0_pdclust_layout *pl;
+	uint64_t                  k;
+	uint64_t                  lost;
+
+	if (!scm->sc_prio)
+		return 0;
+	pl = m0_layout_to_pdl(fctx->sf_layout);
+	k = min64u(m0_pdclust_K(pl), SNS_CM_RANK_NR);
+	if (k <= 1)
+		return 0;
+	lost = m0_sns_cm_ag_unrepaired_units(scm, fctx, group, NULL);
+	return k - min64u(max64u(lost, 1), k);
+}
+
+/** Classifies the groups of the file by rank, once per file context. */
+static uint64_t sns_cm_file_ranks(struct m0_sns_cm *scm,
+				  struct m0_sns_cm_file_ctx *fctx)
+{
+	uint64_t group;
+	uint64_t ranks;
+
+	if (!scm->sc_prio)
+		return M0_BITS(0);
+	m0_sns_cm_fctx_lock(fctx);
+	if (!fctx->sf_ranks_valid) {
+		fctx->sf_ranks = 0;
+		for (group = 0; group <= fctx->sf_max_group; ++group)
+			fctx->sf_ranks |= M0_BITS(m0_sns_cm_group_rank(scm,
+								fctx, group));
+		fctx->sf_ranks_valid = true;
+		M0_LOG(M0_DEBUG, "file "FID_F" ranks %"PRIx64,
+		       FID_P(&fctx->sf_fid), fctx->sf_ranks);
+	}
+	ranks = fctx->sf_ranks;
+	m0_sns_cm_fctx_unlock(fctx);
+	return ranks;
+}
+
+M0_INTERNAL bool m0_sns_cm_group_next(struct m0_sns_cm *scm,
+				      struct m0_sns_cm_file_ctx *fctx,
+				      uint64_t *rank, uint64_t *group)
+{
+	uint64_t ranks = sns_cm_file_ranks(scm, fctx);
+
+	for (; *rank < SNS_CM_RANK_NR; ++*rank, *group = 0) {
+		if ((ranks & M0_BITS(*rank)) == 0)
+			continue;
+		for (; *group <= fctx->sf_max_group; ++*group) {
+			if (m0_sns_cm_group_rank(scm, fctx, *group) == *rank)
+				return true;
+		}
+	}
+	return false;
+}
+
 M0_INTERNAL bool m0_sns_cm_ag_is_relevant(struct m0_sns_cm *scm,
 					  struct m0_sns_cm_file_ctx *fctx,
 					  const struct m0_cm_ag_id *id)
@@ -165,6 +165,36 @@ M0_INTERNAL size_t m0_sns_cm_ag_unrepaired_units(const struct m0_sns_cm *scm,
 						 uint64_t group,
 						 struct m0_bitmap *fmap_out);
 
+/**
+ * Returns repair rank of the group.
+ *
+ * In a prioritised repair (m0_sns_cm::sc_prio) groups of a file are
+ * repaired in order of their ranks, and in order of group numbers within
+ * a rank. A group with all K parity units lost has rank 0, a group with a
+ * single lost unit has rank K - 1. The rank is a part of the aggregation
+ * group identifier (m0_cm_ag_id::ai_lo::u_hi), so that identifiers keep
+ * increasing in repair order, as the sliding window requires. All nodes
+ * compute the same ranks from the same pool machine state.
+ *
+ * Returns 0 for every group if the repair is not prioritised.
+ */
+M0_INTERNAL uint64_t m0_sns_cm_group_rank(struct m0_sns_cm *scm,
+					  struct m0_sns_cm_file_ctx *fctx,
+					  uint64_t group);
+
+/**
+ * Finds the first group of the file in repair order at or after the given
+ * rank and group, and returns it in *rank and *group.
+ *
+ * The first call for a file scans all its groups to find out which ranks are
+ * present, so that the following calls skip passes with no groups.
+ *
+ * @retval false there are no more groups.
+ */
+M0_INTERNAL bool m0_sns_cm_group_next(struct m0_sns_cm *scm,
+				      struct m0_sns_cm_file_ctx *fctx,
+				      uint64_t *rank, uint64_t *group);
+
 /**
  * Returns true if the given aggregation group corresponding to the id is
  * relevant. Thus if a node hosts the spare unit of the given aggregation group
@@ -81,6 +81,18 @@ struct m0_sns_cm_cp {
 
 	/** FOL record frag for storage objects. */
 	struct m0_fol_frag     sc_fol_frag;
+
+	/** True if throttle tokens are taken for the current stob I/O. */
+	bool                   sc_throttle_taken;
+
+	/** True while sc_throttle_to is armed. */
+	bool                   sc_throttle_wait;
+
+	/** Wakes the copy packet fom when the throttle allows the I/O. */
+	struct m0_fom_timeout  sc_throttle_to;
+
+	/** True if a slot of the proxy in-flight window is taken. */
+	bool                   sc_wnd_taken;
 };
 
 M0_INTERNAL struct m0_sns_cm_cp *cp2snscp(const struct m0_cm_cp *cp);
@@ -118,6 +130,9 @@ M0_INTERNAL int m0_sns_cm_cp_send(struct m0_cm_cp *cp, struct m0_fop_type *ft);
 
 M0_INTERNAL int m0_sns_cm_cp_send_wait(struct m0_cm_cp *cp);
 
+/** Returns the proxy in-flight window slot taken by the copy packet. */
+M0_INTERNAL void m0_sns_cm_cp_wnd_put(struct m0_cm_cp *cp);
+
 M0_INTERNAL int m0_sns_cm_cp_buf_acquire(struct m0_cm_cp *cp);
 
 M0_INTERNAL int m0_sns_cm_cp_recv_init(struct m0_cm_cp *cp);
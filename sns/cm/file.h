@@ -121,6 +121,13 @@ struct m0_sns_cm_file_ctx {
 
 	/** Index of the ioservice last visited to get file attributes. */
 	uint64_t                    sf_nr_ios_visited;
+
+	/**
+	 * Bitmap of repair ranks of the groups of the file, valid if
+	 * sf_ranks_valid. See m0_sns_cm_group_next().
+	 */
+	uint64_t                    sf_ranks;
+	bool                        sf_ranks_valid;
 	int                         sf_rc;
 };
 
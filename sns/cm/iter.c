@@ -228,8 +228,11 @@ static int __file_context_init(struct m0_sns_cm_iter *it)
 	out_last = &cm->cm_last_processed_out;
 	if (m0_cm_ag_id_is_set(out_last)) {
 		it->si_fc.ifc_sa.sa_group = agid2group(out_last);
-	 } else
+		it->si_fc.ifc_rank = agid2rank(out_last);
+	 } else {
 		it->si_fc.ifc_sa.sa_group = 0;
+		it->si_fc.ifc_rank = 0;
+	}
 
 	it->si_fc.ifc_sa.sa_unit = 0;
 	it->si_ag = NULL;
@@ -361,13 +364,14 @@ static int iter_fid_next(struct m0_sns_cm_iter *it)
 }
 
 static bool __has_incoming(struct m0_sns_cm *scm,
-			   struct m0_sns_cm_file_ctx *fctx, uint64_t group)
+			   struct m0_sns_cm_file_ctx *fctx, uint64_t group,
+			   uint64_t rank)
 {
 	struct m0_cm_ag_id agid;
 
 	M0_PRE(scm != NULL && fctx != NULL);
 
-	m0_sns_cm_ag_agid_setup(&fctx->sf_fid, group, &agid);
+	m0_sns_cm_ag_agid_setup(&fctx->sf_fid, group, rank, &agid);
 	M0_LOG(M0_DEBUG, "agid [%" PRId64 "] [%" PRId64 "] [%" PRId64 "] [%" PRId64 "]",
 	       agid.ai_hi.u_hi, agid.ai_hi.u_lo,
 	       agid.ai_lo.u_hi, agid.ai_lo.u_lo);
@@ -403,7 +407,8 @@ static bool __group_skip(struct m0_sns_cm_iter *it, uint64_t group)
 
 
 static int __group_alloc(struct m0_sns_cm *scm, struct m0_fid *gfid,
-			 uint64_t group, struct m0_pdclust_layout *pl,
+			 uint64_t group, uint64_t rank,
+			 struct m0_pdclust_layout *pl,
 			 bool has_incoming, struct m0_cm_aggr_group **ag)
 {
 	struct m0_cm        *cm = &scm->sc_base;
@@ -411,7 +416,7 @@ static int __group_alloc(struct m0_sns_cm *scm, struct m0_fid *gfid,
 	size_t               nr_bufs;
 	int                  rc = 0;
 
-	m0_sns_cm_ag_agid_setup(gfid, group, &agid);
+	m0_sns_cm_ag_agid_setup(gfid, group, rank, &agid);
 	/*
 	 * Allocate new aggregation group for the given aggregation
 	 * group identifier.
@@ -466,7 +471,8 @@ out:
 
 /**
  * Finds parity group having units belonging to the failed container.
- * This iterates through each parity group of the file, and its units.
+ * This iterates through each parity group of the file in repair order, and its
+ * units.
  * A COB id is calculated for each unit and checked if ti belongs to the
  * failed container, if yes then the group is selected for processing.
  * This is invoked from ITPH_GROUP_NEXT phase.
@@ -480,6 +486,7 @@ static int __group_next(struct m0_sns_cm_iter *it)
 	struct m0_fid                  *gfid;
 	struct m0_pdclust_layout       *pl;
 	uint64_t                        group;
+	uint64_t                        rank;
 	uint64_t                        nrlu = 0;
 	bool                            has_incoming = false;
 	int                             rc = 0;
@@ -498,16 +505,18 @@ static int __group_next(struct m0_sns_cm_iter *it)
 	pm = fctx->sf_pm;
 	if (m0_sns_cm_pver_is_dirty(pm->pm_pver))
 		goto fid_next;
-	for (group = sa->sa_group; group <= ifc->ifc_group_last; ++group) {
+	rank = ifc->ifc_rank;
+	for (group = sa->sa_group;
+	     m0_sns_cm_group_next(scm, fctx, &rank, &group); ++group) {
 		if (__group_skip(it, group))
 			continue;
-		has_incoming = __has_incoming(scm, ifc->ifc_fctx, group);
+		has_incoming = __has_incoming(scm, ifc->ifc_fctx, group, rank);
 		if (!has_incoming)
 			nrlu = m0_sns_cm_ag_nr_local_units(scm, ifc->ifc_fctx,
 							   group);
 		if (has_incoming || nrlu > 0) {
-			rc = __group_alloc(scm, gfid, group, pl, has_incoming,
-					   &it->si_ag);
+			rc = __group_alloc(scm, gfid, group, rank, pl,
+					   has_incoming, &it->si_ag);
 			if (rc == -ENOENT) {
 				rc = 0;
 				continue;
@@ -529,6 +538,7 @@ static int __group_next(struct m0_sns_cm_iter *it)
 			}
 			ifc->ifc_sa.sa_group = group;
 			ifc->ifc_sa.sa_unit = 0;
+			ifc->ifc_rank = rank;
 			if (rc == 0)
 				iter_phase_set(it, ITPH_COB_NEXT);
 			goto out;
@@ -880,7 +890,7 @@ M0_INTERNAL int m0_sns_cm_iter_init(struct m0_sns_cm_iter *it)
 	m0_sns_cm_iter_bob_init(it);
 	it->si_total_files = 0;
 	if (it->si_fom == NULL)
-		it->si_fom = &scm->sc_base.cm_cp_pump.p_fom;
+		it->si_fom = &scm->sc_base.cm_cp_pump[0].p_fom;
 
 	return M0_RC(0);
 }
@@ -66,6 +66,12 @@ struct m0_sns_cm_iter_file_ctx {
 	/** Total number of parity groups in file. */
 	uint64_t                      ifc_group_last;
 
+	/**
+	 * Repair rank of the parity group being processed,
+	 * see m0_sns_cm_group_rank().
+	 */
+	uint64_t                      ifc_rank;
+
 	/**
 	 * Unit within a particular parity group corresponding to
 	 * m0_sns_cm_iter::si_gob_fid, of which the data is to be read or
@@ -129,7 +135,8 @@ M0_INTERNAL int m0_sns_cm_iter_start(struct m0_sns_cm_iter *it);
 M0_INTERNAL void m0_sns_cm_iter_stop(struct m0_sns_cm_iter *it);
 
 /**
- * Iterates over parity groups in global fid order, calculates next data or
+ * Iterates over parity groups in global fid order (in repair rank order within
+ * a file, see m0_sns_cm_group_rank()), calculates next data or
  * parity unit from the parity group to be read, calculates cob fid for the
  * parity unit, creates and initialises new aggregation group corresponding
  * to the parity group if required, and fills this information in the given
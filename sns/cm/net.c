@@ -301,6 +301,7 @@ M0_INTERNAL int m0_sns_cm_cp_send_wait(struct m0_cm_cp *cp)
 
 	M0_PRE(cp != NULL);
 
+	m0_sns_cm_cp_wnd_put(cp);
 	c_rc = cp->c_rc;
 	if (c_rc != 0 && c_rc != -ENOENT) {
 		M0_LOG(M0_ERROR, "rc=%d", c_rc);
@@ -326,6 +327,25 @@ M0_INTERNAL int m0_sns_cm_cp_send_wait(struct m0_cm_cp *cp)
 	return cp->c_ops->co_phase_next(cp);
 }
 
+M0_INTERNAL void m0_sns_cm_cp_wnd_put(struct m0_cm_cp *cp)
+{
+	struct m0_sns_cm_cp       *scp = cp2snscp(cp);
+	struct m0_net_buffer_pool *obp;
+	uint64_t                   bufs_free;
+
+	if (!scp->sc_wnd_taken)
+		return;
+	obp = &cm2sns(cpfom2cm(&cp->c_fom))->sc_obp.sb_bp;
+	m0_net_buffer_pool_lock(obp);
+	bufs_free = obp->nbp_free;
+	m0_net_buffer_pool_unlock(obp);
+
+	m0_cm_proxy_lock(cp->c_cm_proxy);
+	m0_cm_proxy_wnd_put(cp->c_cm_proxy, bufs_free);
+	m0_cm_proxy_unlock(cp->c_cm_proxy);
+	scp->sc_wnd_taken = false;
+}
+
 static void cp_buf_acquire(struct m0_cm_cp *cp)
 {
 	struct m0_sns_cm *sns_cm = cm2sns(cp->c_ag->cag_cm);
@@ -576,7 +596,17 @@ M0_INTERNAL int m0_sns_cm_cp_sw_check(struct m0_cm_cp *cp)
 	m0_cm_proxy_lock(cm_proxy);
 	if (m0_cm_ag_id_cmp(&cp->c_ag->cag_id, &cm_proxy->px_sw.sw_lo) >= 0 &&
 	    m0_cm_ag_id_cmp(&cp->c_ag->cag_id, &cm_proxy->px_sw.sw_hi) <= 0) {
-		rc = cp->c_ops->co_phase_next(cp);
+		/*
+		 * The in-flight window of the replica is re-checked when the
+		 * copy packet is woken up by m0_cm_proxy_wnd_put().
+		 */
+		if (scp->sc_wnd_taken || m0_cm_proxy_wnd_take(cm_proxy)) {
+			scp->sc_wnd_taken = true;
+			rc = cp->c_ops->co_phase_next(cp);
+		} else {
+			m0_cm_proxy_cp_park(cm_proxy, cp);
+			rc = M0_FSO_WAIT;
+		}
 	} else {
 		/*
 		 * If remote replica has already stopped due to some reason,
@@ -588,7 +618,7 @@ M0_INTERNAL int m0_sns_cm_cp_sw_check(struct m0_cm_cp *cp)
 			m0_fom_phase_move(&cp->c_fom, -ENOENT, M0_CCP_FAIL);
 			rc = M0_FSO_AGAIN;
 		} else {
-			m0_cm_proxy_cp_add(cm_proxy, cp);
+			m0_cm_proxy_cp_park(cm_proxy, cp);
 			rc = M0_FSO_WAIT;
 		}
 	}
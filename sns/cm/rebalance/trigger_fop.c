@@ -49,6 +49,8 @@ M0_INTERNAL void m0_sns_cm_rebalance_trigger_fop_fini(void)
 	m0_cm_trigger_fop_fini(&m0_sns_rebalance_status_rep_fopt);
 	m0_cm_trigger_fop_fini(&m0_sns_rebalance_abort_fopt);
 	m0_cm_trigger_fop_fini(&m0_sns_rebalance_abort_rep_fopt);
+	m0_cm_trigger_fop_fini(&m0_sns_rebalance_throttle_fopt);
+	m0_cm_trigger_fop_fini(&m0_sns_rebalance_throttle_rep_fopt);
 }
 
 M0_INTERNAL void m0_sns_cm_rebalance_trigger_fop_init(void)
@@ -111,6 +113,20 @@ M0_INTERNAL void m0_sns_cm_rebalance_trigger_fop_init(void)
 			       M0_RPC_ITEM_TYPE_REPLY,
 			       &sns_rebalance_cmt,
 			       &m0_sns_trigger_fom_type_ops);
+	m0_cm_trigger_fop_init(&m0_sns_rebalance_throttle_fopt,
+			       M0_SNS_REBALANCE_THROTTLE_OPCODE,
+			       "sns rebalance throttle",
+			       trigger_fop_xc,
+			       M0_RPC_MUTABO_REQ,
+			       &sns_rebalance_cmt,
+			       &m0_sns_trigger_fom_type_ops);
+	m0_cm_trigger_fop_init(&m0_sns_rebalance_throttle_rep_fopt,
+			       M0_SNS_REBALANCE_THROTTLE_REP_OPCODE,
+			       "sns rebalance throttle reply",
+			       trigger_rep_fop_xc,
+			       M0_RPC_ITEM_TYPE_REPLY,
+			       &sns_rebalance_cmt,
+			       &m0_sns_trigger_fom_type_ops);
 }
 
 #undef M0_TRACE_SUBSYSTEM
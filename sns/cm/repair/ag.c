@@ -132,8 +132,10 @@ static int incr_recover_init(struct m0_sns_cm_repair_ag *rag,
 	M0_SET0(&rag->rag_math);
 	M0_SET0(&rag->rag_ir);
 
-	rc = m0_parity_math_init(&rag->rag_math, m0_sns_cm_ag_nr_data_units(pl),
-				 m0_sns_cm_ag_nr_parity_units(pl));
+	rc = m0_parity_math_lrc_init(&rag->rag_math,
+				     m0_sns_cm_ag_nr_data_units(pl),
+				     m0_sns_cm_ag_nr_parity_units(pl),
+				     m0_pdclust_local_nr(pl));
 	if (rc != 0)
 		return M0_RC(rc);
 
@@ -146,6 +148,7 @@ static int incr_recover_init(struct m0_sns_cm_repair_ag *rag,
 		m0_parity_math_fini(&rag->rag_math);
 		return M0_RC(rc);
 	}
+	rag->rag_ir.si_pool = &cm2sns(rag->rag_base.sag_base.cag_cm)->sc_ir_pool;
 
 	rc = incr_recover_failure_register(rag);
 	if (rc != 0)
@@ -405,8 +408,16 @@ static int repair_ag_failure_ctxs_setup(struct m0_sns_cm_repair_ag *rag,
 				continue;
 		}
 
-		tgt_unit = repair_ag_target_unit(sag, pl, pi, index,
-						 data_unit_id_out);
+		/*
+		 * Direct repair reconstructs the failed unit in place, on the
+		 * replacement device. Data of a failed spare unit still goes
+		 * to another spare, as its original device is not replaced.
+		 */
+		if (cm2sns(cm)->sc_direct && data_unit_id_out == i)
+			tgt_unit = i;
+		else
+			tgt_unit = repair_ag_target_unit(sag, pl, pi, index,
+							 data_unit_id_out);
 		rag_fc = &rag->rag_fc[fidx];
 		tgt_cobfid = &rag_fc->fc_tgt_cobfid;
 		rc = m0_sns_cm_ag_tgt_unit2cob(sag, tgt_unit, tgt_cobfid);
@@ -211,8 +211,10 @@ m0_sns_cm_fid_repair_done(struct m0_fid *gfid, struct m0_reqh *reqh,
 		m0_cm_unlock(cm);
 		if (curr_gfid.f_container == 0 && curr_gfid.f_key == 0)
 			break;
-		return m0_fid_cmp(gfid, &curr_gfid) > 0 ? SRS_REPAIR_NOTDONE :
-				  SRS_REPAIR_DONE;
+		if (m0_fid_cmp(gfid, &curr_gfid) > 0)
+			return SRS_REPAIR_NOTDONE;
+		return scm->sc_direct ? SRS_REPAIR_DONE_DIRECT :
+					SRS_REPAIR_DONE;
 	case M0_PNDS_SNS_REBALANCING :
 		return SRS_REPAIR_NOTDONE;
 	default:
@@ -84,7 +84,14 @@ static int repair_ag_in_cp_units(const struct m0_sns_cm *scm,
 		 * on a node. This is required to calculate exact number of
 		 * incoming copy packets.
 		 */
-		if (is_failed && !m0_sns_cm_is_cob_repaired(pm, ta.ta_obj)) {
+		if (is_failed && !m0_sns_cm_is_cob_repaired(pm, ta.ta_obj) &&
+		    scm->sc_direct &&
+		    m0_pdclust_unit_classify(pl, unit) != M0_PUT_SPARE) {
+			/* Direct repair: the unit is rebuilt in place. */
+			if (m0_sns_cm_is_local_cob(cm, pm->pm_pver, &cobfid))
+				M0_CNT_INC(local_spares);
+		} else if (is_failed &&
+			   !m0_sns_cm_is_cob_repaired(pm, ta.ta_obj)) {
 			m0_sns_cm_fctx_lock(fctx);
 			rc = m0_sns_repair_spare_map(pm, &gfid, pl, fctx->sf_pi,
 						     sa.sa_group, unit,
@@ -163,6 +170,7 @@ static bool repair_ag_is_relevant(struct m0_sns_cm *scm,
 	uint32_t                    S;
 	uint32_t                    j;
 	uint32_t                    spare;
+	uint32_t                    hops;
 	struct m0_pdclust_layout   *pl;
 	struct m0_poolmach         *pm;
 	int                         rc;
@@ -176,6 +184,17 @@ static bool repair_ag_is_relevant(struct m0_sns_cm *scm,
 	K = m0_sns_cm_ag_nr_parity_units(pl);
 	S = m0_sns_cm_ag_nr_spare_units(pl);
 	sa.sa_group = group;
+	if (scm->sc_direct) {
+		/* Units of a local replaced device are rebuilt in place. */
+		for (j = 0; j < N + K; ++j) {
+			sa.sa_unit = j;
+			m0_sns_cm_unit2cobfid(fctx, &sa, &ta, &cobfid);
+			if (m0_sns_cm_is_cob_repairing(pm, ta.ta_obj) &&
+			    m0_sns_cm_is_local_cob(&scm->sc_base, pm->pm_pver,
+						   &cobfid))
+				return true;
+		}
+	}
 	for (j = N + K; j < N + K + S; ++j) {
 		sa.sa_unit = j;
 		m0_sns_cm_unit2cobfid(fctx, &sa, &ta, &cobfid);
@@ -184,7 +203,9 @@ static bool repair_ag_is_relevant(struct m0_sns_cm *scm,
 		if (!m0_sns_cm_is_local_cob(&scm->sc_base, pm->pm_pver, &cobfid))
 			continue;
 		spare = j;
+		hops = 0;
 		do {
+			++hops;
 			m0_sns_cm_fctx_lock(fctx);
 			rc = m0_sns_repair_data_map(pm, pl, fctx->sf_pi, group,
 						    spare, &data_unit);
@@ -194,7 +215,11 @@ static bool repair_ag_is_relevant(struct m0_sns_cm *scm,
 			spare = data_unit;
 		} while (m0_sns_cm_unit_is_spare(fctx, group, data_unit));
 
-		if (rc != 0)
+		/*
+		 * In direct repair the spare is used only for the data of
+		 * failed spare units (see repair_ag_failure_ctxs_setup()).
+		 */
+		if (rc != 0 || (scm->sc_direct && hops == 1))
 			continue;
 		sa.sa_unit = data_unit;
 		m0_sns_cm_unit2cobfid(fctx, &sa, &ta, &cobfid);
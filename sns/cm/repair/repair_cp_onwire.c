@@ -36,7 +36,8 @@ static int repair_cp_fom_create(struct m0_fop *fop, struct m0_fom **m,
 				struct m0_reqh *reqh);
 
 M0_INTERNAL const struct m0_fom_type_ops repair_cp_fom_type_ops = {
-        .fto_create = repair_cp_fom_create
+        .fto_create = repair_cp_fom_create,
+        .fto_prio   = M0_FOM_PRIO_LOW
 };
 
 static int repair_cp_fom_create(struct m0_fop *fop, struct m0_fom **m,
@@ -50,6 +50,8 @@ M0_INTERNAL void m0_sns_cm_repair_trigger_fop_fini(void)
 	m0_cm_trigger_fop_fini(&m0_sns_repair_status_rep_fopt);
 	m0_cm_trigger_fop_fini(&m0_sns_repair_abort_fopt);
 	m0_cm_trigger_fop_fini(&m0_sns_repair_abort_rep_fopt);
+	m0_cm_trigger_fop_fini(&m0_sns_repair_throttle_fopt);
+	m0_cm_trigger_fop_fini(&m0_sns_repair_throttle_rep_fopt);
 }
 
 M0_INTERNAL void m0_sns_cm_repair_trigger_fop_init(void)
@@ -112,6 +114,20 @@ M0_INTERNAL void m0_sns_cm_repair_trigger_fop_init(void)
 			       M0_RPC_ITEM_TYPE_REPLY,
 			       &sns_repair_cmt,
 			       &m0_sns_trigger_fom_type_ops);
+	m0_cm_trigger_fop_init(&m0_sns_repair_throttle_fopt,
+			       M0_SNS_REPAIR_THROTTLE_OPCODE,
+			       "sns repair throttle",
+			       trigger_fop_xc,
+			       M0_RPC_MUTABO_REQ,
+			       &sns_repair_cmt,
+			       &m0_sns_trigger_fom_type_ops);
+	m0_cm_trigger_fop_init(&m0_sns_repair_throttle_rep_fopt,
+			       M0_SNS_REPAIR_THROTTLE_REP_OPCODE,
+			       "sns repair throttle reply",
+			       trigger_rep_fop_xc,
+			       M0_RPC_ITEM_TYPE_REPLY,
+			       &sns_repair_cmt,
+			       &m0_sns_trigger_fom_type_ops);
 }
 
 
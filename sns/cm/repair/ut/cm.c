@@ -455,7 +455,7 @@ static void _cpp_tx_start(struct m0_cm *cm)
 {
 	int                      rc;
 	struct m0_be_tx_credit   cred = {};
-	struct m0_be_tx         *tx = &cm->cm_cp_pump.p_fom.fo_tx.tx_betx;
+	struct m0_be_tx         *tx = &cm->cm_cp_pump[0].p_fom.fo_tx.tx_betx;
 	struct m0_sm_group      *grp  = m0_locality0_get()->lo_grp;
 
 	m0_sm_group_lock(grp);
@@ -469,7 +469,7 @@ static void _cpp_tx_start(struct m0_cm *cm)
 static void _cpp_tx_close(struct m0_cm *cm)
 {
 	struct m0_sm_group *grp  = m0_locality0_get()->lo_grp;
-	struct m0_be_tx    *tx = &cm->cm_cp_pump.p_fom.fo_tx.tx_betx;
+	struct m0_be_tx    *tx = &cm->cm_cp_pump[0].p_fom.fo_tx.tx_betx;
 
 	m0_be_tx_close_sync(tx);
 	m0_be_tx_fini(tx);
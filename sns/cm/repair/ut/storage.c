@@ -377,12 +377,65 @@ static void test_cp_write_read(void)
 	cs_fini(&sctx);
 }
 
+static void test_throttle(void)
+{
+	struct m0_sns_cm_throttle     thr;
+	struct m0_sns_cm_throttle_cfg cfg = {
+		.stc_bytes_per_sec = 1 << 20
+	};
+	m0_time_t                     now = M0_TIME_ONE_SECOND;
+	m0_time_t                     retry;
+	int                           i;
+
+	m0_sns_cm_throttle_init(&thr, NULL);
+	/* No limits by default. */
+	M0_UT_ASSERT(m0_sns_cm_throttle_take(&thr, 3, 1 << 30, now) == 0);
+
+	/* Full bucket admits I/O until it goes into debt. */
+	m0_sns_cm_throttle_cfg_set(&thr, &cfg);
+	M0_UT_ASSERT(m0_sns_cm_throttle_take(&thr, 3, 1 << 20, now) == 0);
+	M0_UT_ASSERT(m0_sns_cm_throttle_take(&thr, 3, 1 << 20, now) == 0);
+	retry = m0_sns_cm_throttle_take(&thr, 3, 4096, now);
+	M0_UT_ASSERT(retry == now + M0_TIME_ONE_SECOND);
+	/* Devices are throttled separately. */
+	M0_UT_ASSERT(m0_sns_cm_throttle_take(&thr, 0, 4096, now) == 0);
+	M0_UT_ASSERT(m0_sns_cm_throttle_take(&thr, 3, 4096, retry) == 0);
+
+	/* Operations. */
+	cfg = (struct m0_sns_cm_throttle_cfg) { .stc_iops = 10 };
+	m0_sns_cm_throttle_cfg_set(&thr, &cfg);
+	for (i = 0; i <= 10; ++i)
+		M0_UT_ASSERT(m0_sns_cm_throttle_take(&thr, 3, 1, now) == 0);
+	retry = m0_sns_cm_throttle_take(&thr, 3, 1, now);
+	M0_UT_ASSERT(retry == now + M0_TIME_ONE_SECOND / 10);
+
+	/* Foreground latency feedback. */
+	cfg = (struct m0_sns_cm_throttle_cfg) {
+		.stc_bytes_per_sec = 1 << 20,
+		.stc_latency       = M0_TIME_ONE_MSEC
+	};
+	m0_sns_cm_throttle_cfg_set(&thr, &cfg);
+	m0_sns_cm_throttle_feedback(&thr, 2 * M0_TIME_ONE_MSEC);
+	M0_UT_ASSERT(thr.st_scale == M0_SNS_CM_THROTTLE_SCALE_ONE / 2);
+	M0_UT_ASSERT(m0_sns_cm_throttle_take(&thr, 3, 1 << 20, now) == 0);
+	retry = m0_sns_cm_throttle_take(&thr, 3, 4096, now);
+	M0_UT_ASSERT(retry == now + M0_TIME_ONE_SECOND);
+	for (i = 0; i < 16; ++i)
+		m0_sns_cm_throttle_feedback(&thr, 2 * M0_TIME_ONE_MSEC);
+	M0_UT_ASSERT(thr.st_scale == M0_SNS_CM_THROTTLE_SCALE_MIN);
+	for (i = 0; i < 16; ++i)
+		m0_sns_cm_throttle_feedback(&thr, M0_TIME_ONE_MSEC / 2);
+	M0_UT_ASSERT(thr.st_scale == M0_SNS_CM_THROTTLE_SCALE_ONE);
+	m0_sns_cm_throttle_fini(&thr);
+}
+
 struct m0_ut_suite snscm_storage_ut = {
 	.ts_name = "snscm_storage-ut",
 	.ts_init = NULL,
 	.ts_fini = NULL,
 	.ts_tests = {
 		{ "cp_write_read", test_cp_write_read },
+		{ "throttle",      test_throttle },
 		{ NULL, NULL }
 	}
 };
@@ -174,6 +174,7 @@ static int cp_stob_io_init(struct m0_cm_cp *cp, const enum m0_stob_io_opcode op)
 		m0_stob_io_init(stio);
 		stio->si_flags = 0;
 		stio->si_opcode = op;
+		stio->si_class = SIC_REPAIR;
 		stio->si_fol_frag = &sns_cp->sc_fol_frag;
 		bshift = m0_stob_block_shift(sns_cp->sc_stob);
 
@@ -226,6 +227,38 @@ static bool cp_stob_io_is_initialised(struct m0_stob_io *io)
 	return M0_IN(io->si_state, (SIS_IDLE, SIS_BUSY));
 }
 
+/**
+ * Takes throttle tokens for the stob I/O of the copy packet.
+ *
+ * Returns M0_FSO_WAIT if the I/O has to wait, the copy packet fom is woken
+ * up by sc_throttle_to and re-enters cp_io() then.
+ */
+static int cp_throttle(struct m0_cm_cp *cp)
+{
+	struct m0_sns_cm_cp *sns_cp = cp2snscp(cp);
+	struct m0_sns_cm    *scm    = cm2sns(cp->c_ag->cag_cm);
+	m0_time_t            retry;
+
+	if (sns_cp->sc_throttle_wait) {
+		m0_fom_timeout_fini(&sns_cp->sc_throttle_to);
+		sns_cp->sc_throttle_wait = false;
+	}
+	if (sns_cp->sc_throttle_taken)
+		return 0;
+	retry = m0_sns_cm_throttle_take(&scm->sc_throttle,
+				m0_fid_cob_device_id(&sns_cp->sc_cobfid),
+				m0_vec_count(&sns_cp->sc_stio.si_user.ov_vec),
+				m0_time_now());
+	if (retry == 0) {
+		sns_cp->sc_throttle_taken = true;
+		return 0;
+	}
+	m0_fom_timeout_init(&sns_cp->sc_throttle_to);
+	m0_fom_timeout_wait_on(&sns_cp->sc_throttle_to, &cp->c_fom, retry);
+	sns_cp->sc_throttle_wait = true;
+	return M0_FSO_WAIT;
+}
+
 static int cp_io(struct m0_cm_cp *cp, const enum m0_stob_io_opcode op)
 {
 	struct m0_fom       *cp_fom;
@@ -251,6 +284,9 @@ static int cp_io(struct m0_cm_cp *cp, const enum m0_stob_io_opcode op)
 			goto out;
 	}
 
+	rc = cp_throttle(cp);
+	if (rc != 0)
+		goto out;
 	rc = m0_sns_cm_cp_tx_open(cp);
 	if (rc != 0)
 		goto out;
@@ -308,6 +344,7 @@ static int cp_io(struct m0_cm_cp *cp, const enum m0_stob_io_opcode op)
 		m0_mutex_lock(&stio->si_mutex);
 		m0_fom_callback_cancel(&cp_fom->fo_cb);
 		m0_mutex_unlock(&stio->si_mutex);
+		sns_cp->sc_throttle_taken = false;
 		m0_indexvec_free(&stio->si_stob);
 		bufvec_free(&stio->si_user);
 		m0_stob_io_fini(stio);
@@ -381,6 +418,7 @@ M0_INTERNAL int m0_sns_cm_cp_io_wait(struct m0_cm_cp *cp)
 	cp->c_ops->co_complete(cp);
 
 	/* Cleanup before proceeding to next phase. */
+	sns_cp->sc_throttle_taken = false;
 	m0_indexvec_free(&sns_cp->sc_stio.si_stob);
 	bufvec_free(&sns_cp->sc_stio.si_user);
 	m0_stob_io_fini(&sns_cp->sc_stio);
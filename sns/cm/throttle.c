@@ -0,0 +1,224 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2013-2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_SNSCM
+#include "lib/trace.h"
+#include "lib/memory.h"
+#include "lib/misc.h"              /* M0_SET0 */
+#include "lib/arith.h"             /* min64u */
+
+#include "ioservice/io_service.h"  /* m0_ios_io_latency */
+#include "sns/cm/throttle.h"
+
+/**
+   @addtogroup SNSCMTHROTTLE
+
+   @{
+ */
+
+enum {
+	/** Micro-seconds in a second. */
+	THROTTLE_USEC = 1000000,
+	/** Nano-seconds in a micro-second. */
+	THROTTLE_USEC_NS = M0_TIME_ONE_SECOND / THROTTLE_USEC,
+	/** Additive increase of the rate factor. */
+	THROTTLE_SCALE_STEP = M0_SNS_CM_THROTTLE_SCALE_ONE / 16,
+};
+
+M0_INTERNAL void m0_sns_cm_throttle_init(struct m0_sns_cm_throttle *thr,
+					 struct m0_reqh *reqh)
+{
+	M0_SET0(thr);
+	m0_mutex_init(&thr->st_lock);
+	thr->st_reqh  = reqh;
+	thr->st_scale = M0_SNS_CM_THROTTLE_SCALE_ONE;
+}
+
+M0_INTERNAL void m0_sns_cm_throttle_fini(struct m0_sns_cm_throttle *thr)
+{
+	m0_free(thr->st_buckets);
+	m0_mutex_fini(&thr->st_lock);
+}
+
+M0_INTERNAL void m0_sns_cm_throttle_cfg_set(struct m0_sns_cm_throttle *thr,
+				const struct m0_sns_cm_throttle_cfg *cfg)
+{
+	uint32_t i;
+
+	M0_LOG(M0_INFO, "bytes/s=%"PRIu64" iops=%"PRIu64" latency=%"PRIu64,
+	       cfg->stc_bytes_per_sec, cfg->stc_iops, cfg->stc_latency);
+	m0_mutex_lock(&thr->st_lock);
+	thr->st_cfg = *cfg;
+	thr->st_scale = M0_SNS_CM_THROTTLE_SCALE_ONE;
+	thr->st_feedback_time = 0;
+	for (i = 0; i < thr->st_buckets_nr; ++i)
+		M0_SET0(&thr->st_buckets[i]);
+	m0_mutex_unlock(&thr->st_lock);
+}
+
+static void throttle_feedback(struct m0_sns_cm_throttle *thr,
+			      m0_time_t latency)
+{
+	M0_PRE(m0_mutex_is_locked(&thr->st_lock));
+
+	if (thr->st_cfg.stc_latency == 0)
+		return;
+	if (latency > thr->st_cfg.stc_latency)
+		thr->st_scale = max32u(thr->st_scale / 2,
+				       M0_SNS_CM_THROTTLE_SCALE_MIN);
+	else
+		thr->st_scale = min32u(thr->st_scale + THROTTLE_SCALE_STEP,
+				       M0_SNS_CM_THROTTLE_SCALE_ONE);
+	M0_LOG(M0_DEBUG, "latency=%"PRIu64" scale=%u", latency,
+	       thr->st_scale);
+}
+
+M0_INTERNAL void m0_sns_cm_throttle_feedback(struct m0_sns_cm_throttle *thr,
+					     m0_time_t latency)
+{
+	m0_mutex_lock(&thr->st_lock);
+	throttle_feedback(thr, latency);
+	m0_mutex_unlock(&thr->st_lock);
+}
+
+/** Configured rate scaled by the rate factor, 0 for no limit. */
+static uint64_t throttle_rate(const struct m0_sns_cm_throttle *thr,
+			      uint64_t rate)
+{
+	return rate == 0 ? 0 :
+		max64u(rate * thr->st_scale / M0_SNS_CM_THROTTLE_SCALE_ONE, 1);
+}
+
+static struct m0_sns_cm_throttle_bucket *
+throttle_bucket(struct m0_sns_cm_throttle *thr, uint32_t dev)
+{
+	struct m0_sns_cm_throttle_bucket *buckets;
+	uint32_t                          nr;
+
+	M0_PRE(m0_mutex_is_locked(&thr->st_lock));
+
+	if (dev >= thr->st_buckets_nr) {
+		nr = max32u(dev + 1, thr->st_buckets_nr * 2);
+		M0_ALLOC_ARR(buckets, nr);
+		if (buckets == NULL)
+			return NULL;
+		if (thr->st_buckets_nr > 0)
+			memcpy(buckets, thr->st_buckets,
+			       thr->st_buckets_nr * sizeof buckets[0]);
+		m0_free(thr->st_buckets);
+		thr->st_buckets    = buckets;
+		thr->st_buckets_nr = nr;
+	}
+	return &thr->st_buckets[dev];
+}
+
+/**
+   Adds tokens accumulated since the last refill, at most one second worth.
+   A bucket which has not been used yet is made full.
+ */
+static void throttle_refill(struct m0_sns_cm_throttle_bucket *b,
+			    uint64_t bytes_rate, uint64_t ops_rate,
+			    m0_time_t now)
+{
+	uint64_t usec;
+
+	if (b->stb_time == 0) {
+		usec = THROTTLE_USEC;
+		b->stb_time = now;
+	} else if (now <= b->stb_time) {
+		usec = 0;
+	} else {
+		usec = min64u((now - b->stb_time) / THROTTLE_USEC_NS,
+			      THROTTLE_USEC);
+		/* Keep the remainder of a micro-second for the next time. */
+		b->stb_time = usec == THROTTLE_USEC ? now :
+			      b->stb_time + usec * THROTTLE_USEC_NS;
+	}
+	if (bytes_rate != 0)
+		b->stb_bytes = min64(b->stb_bytes +
+				     bytes_rate * usec / THROTTLE_USEC,
+				     bytes_rate);
+	if (ops_rate != 0)
+		b->stb_ops = min64(b->stb_ops + ops_rate * usec,
+				   ops_rate * THROTTLE_USEC);
+}
+
+M0_INTERNAL m0_time_t m0_sns_cm_throttle_take(struct m0_sns_cm_throttle *thr,
+					      uint32_t dev, m0_bcount_t nob,
+					      m0_time_t now)
+{
+	struct m0_sns_cm_throttle_bucket *b;
+	uint64_t                          bytes_rate;
+	uint64_t                          ops_rate;
+	uint64_t                          usec = 0;
+	m0_time_t                         retry = 0;
+
+	m0_mutex_lock(&thr->st_lock);
+	if (thr->st_cfg.stc_bytes_per_sec == 0 && thr->st_cfg.stc_iops == 0)
+		goto out;
+	if (thr->st_cfg.stc_latency != 0 && thr->st_reqh != NULL &&
+	    now >= thr->st_feedback_time +
+		   M0_SNS_CM_THROTTLE_FEEDBACK_INTERVAL) {
+		throttle_feedback(thr, m0_ios_io_latency(thr->st_reqh));
+		thr->st_feedback_time = now;
+	}
+	b = throttle_bucket(thr, dev);
+	if (b == NULL) {
+		M0_LOG(M0_WARN, "No memory for bucket of device %u.", dev);
+		goto out;
+	}
+	bytes_rate = throttle_rate(thr, thr->st_cfg.stc_bytes_per_sec);
+	ops_rate   = throttle_rate(thr, thr->st_cfg.stc_iops);
+	throttle_refill(b, bytes_rate, ops_rate, now);
+	if (b->stb_bytes >= 0 && b->stb_ops >= 0) {
+		if (bytes_rate != 0)
+			b->stb_bytes -= nob;
+		if (ops_rate != 0)
+			b->stb_ops -= THROTTLE_USEC;
+		goto out;
+	}
+	/* Wait until both debts are paid off, rounding up. */
+	if (b->stb_bytes < 0)
+		usec = (-b->stb_bytes * THROTTLE_USEC + bytes_rate - 1) /
+			bytes_rate;
+	if (b->stb_ops < 0)
+		usec = max64u(usec, (-b->stb_ops + ops_rate - 1) / ops_rate);
+	retry = now + max64u(usec, 1) * THROTTLE_USEC_NS;
+out:
+	m0_mutex_unlock(&thr->st_lock);
+	return retry;
+}
+
+/** @} end group SNSCMTHROTTLE */
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
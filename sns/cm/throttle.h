@@ -0,0 +1,147 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2013-2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+
+#pragma once
+
+#ifndef __MOTR_SNS_CM_THROTTLE_H__
+#define __MOTR_SNS_CM_THROTTLE_H__
+
+#include "lib/types.h"
+#include "lib/mutex.h"
+#include "lib/time.h"
+
+/**
+   @defgroup SNSCMTHROTTLE SNS copy machine throttle
+   @ingroup SNSCM
+
+   Limits the rate of repair and rebalance I/O, so that it does not starve
+   client I/O of the same devices.
+
+   Every device has a token bucket of bytes and a token bucket of I/O
+   operations, refilled at the configured rates and holding at most one
+   second worth of tokens. A copy packet takes tokens before its stob I/O
+   is launched. A bucket may go into debt by the size of one I/O, the next
+   I/O on the device waits until the debt is paid off.
+
+   If a foreground latency target is set, both rates are scaled by a factor
+   adjusted every M0_SNS_CM_THROTTLE_FEEDBACK_INTERVAL against the average
+   latency of client stob I/O measured by the ioservice, see
+   m0_ios_io_latency(): the factor is halved when the latency is above the
+   target and grows by 1/16 otherwise (additive increase, multiplicative
+   decrease). The factor never drops below 1/64, so that repair always
+   progresses.
+
+   Zero rates and zero latency target mean no limit and no feedback, this
+   is the default. The configuration is changed at run time with
+   m0_spiel_sns_repair_throttle() and m0_spiel_sns_rebalance_throttle().
+
+   @{
+ */
+
+struct m0_reqh;
+
+enum {
+	/** Unit of m0_sns_cm_throttle::st_scale. */
+	M0_SNS_CM_THROTTLE_SCALE_ONE = 1024,
+	/** Lower bound of m0_sns_cm_throttle::st_scale. */
+	M0_SNS_CM_THROTTLE_SCALE_MIN = M0_SNS_CM_THROTTLE_SCALE_ONE / 64,
+};
+
+/** Period of the adjustment of the rates to the foreground latency. */
+#define M0_SNS_CM_THROTTLE_FEEDBACK_INTERVAL (100 * M0_TIME_ONE_MSEC)
+
+struct m0_sns_cm_throttle_cfg {
+	/** Repair bytes per second of a device, 0 for no limit. */
+	uint64_t  stc_bytes_per_sec;
+	/** Repair I/O operations per second of a device, 0 for no limit. */
+	uint64_t  stc_iops;
+	/** Target latency of client stob I/O, 0 disables the feedback. */
+	m0_time_t stc_latency;
+};
+
+/** Token buckets of a device. */
+struct m0_sns_cm_throttle_bucket {
+	/** Available bytes, negative when in debt. */
+	int64_t   stb_bytes;
+	/** Available operations in millionths, negative when in debt. */
+	int64_t   stb_ops;
+	/** Time of the last refill. */
+	m0_time_t stb_time;
+};
+
+struct m0_sns_cm_throttle {
+	/** Protects all the fields below. */
+	struct m0_mutex                   st_lock;
+	struct m0_sns_cm_throttle_cfg     st_cfg;
+	/** Request handler of the ioservice providing the feedback. */
+	struct m0_reqh                   *st_reqh;
+	/** Rate factor in 1/M0_SNS_CM_THROTTLE_SCALE_ONE units. */
+	uint32_t                          st_scale;
+	/** Time of the last rate adjustment. */
+	m0_time_t                         st_feedback_time;
+	/** Buckets indexed by device id, grown on demand. */
+	struct m0_sns_cm_throttle_bucket *st_buckets;
+	uint32_t                          st_buckets_nr;
+};
+
+/** Initialises throttle without limits. reqh may be NULL, no feedback then. */
+M0_INTERNAL void m0_sns_cm_throttle_init(struct m0_sns_cm_throttle *thr,
+					 struct m0_reqh *reqh);
+M0_INTERNAL void m0_sns_cm_throttle_fini(struct m0_sns_cm_throttle *thr);
+
+/** Replaces the configuration and resets the buckets and the rate factor. */
+M0_INTERNAL void m0_sns_cm_throttle_cfg_set(struct m0_sns_cm_throttle *thr,
+				const struct m0_sns_cm_throttle_cfg *cfg);
+
+/**
+   Takes tokens for an I/O of nob bytes on the device.
+
+   Returns 0 if the I/O can be launched, otherwise the time to retry at.
+ */
+M0_INTERNAL m0_time_t m0_sns_cm_throttle_take(struct m0_sns_cm_throttle *thr,
+					      uint32_t dev, m0_bcount_t nob,
+					      m0_time_t now);
+
+/**
+   Adjusts the rate factor to the measured foreground latency.
+
+   Called by m0_sns_cm_throttle_take() every
+   M0_SNS_CM_THROTTLE_FEEDBACK_INTERVAL, exported for tests.
+ */
+M0_INTERNAL void m0_sns_cm_throttle_feedback(struct m0_sns_cm_throttle *thr,
+					     m0_time_t latency);
+
+/** @} end group SNSCMTHROTTLE */
+
+/* __MOTR_SNS_CM_THROTTLE_H__ */
+#endif
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
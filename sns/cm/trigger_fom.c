@@ -50,11 +50,13 @@ static int sns_trigger_fom_create(struct m0_fop *fop, struct m0_fom **out,
 static struct m0_fop_type *sns_fop_type(uint32_t op);
 static uint64_t sns_progress(struct m0_fom *fom, bool reinit_counter);
 static void sns_prepare(struct m0_fom *fom);
+static int sns_throttle(struct m0_fom *fom);
 
 static const struct m0_fom_trigger_ops sns_trigger_ops = {
 	.fto_type     = sns_fop_type,
 	.fto_progress = sns_progress,
-	.fto_prepare  = sns_prepare
+	.fto_prepare  = sns_prepare,
+	.fto_throttle = sns_throttle
 };
 
 const struct m0_fom_type_ops m0_sns_trigger_fom_type_ops = {
@@ -99,6 +101,10 @@ static struct m0_fop_type *sns_fop_type(uint32_t op)
 			&m0_sns_repair_abort_rep_fopt,
 		[M0_SNS_REBALANCE_ABORT_OPCODE] =
 			&m0_sns_rebalance_abort_rep_fopt,
+		[M0_SNS_REPAIR_THROTTLE_OPCODE] =
+			&m0_sns_repair_throttle_rep_fopt,
+		[M0_SNS_REBALANCE_THROTTLE_OPCODE] =
+			&m0_sns_rebalance_throttle_rep_fopt,
 	};
 	M0_ASSERT(IS_IN_ARRAY(op, sns_fop_type));
 	return sns_fop_type[op];
@@ -151,9 +157,33 @@ static void sns_prepare(struct m0_fom *fom)
 	if (M0_IN(treq->op, (CM_OP_REPAIR, CM_OP_REBALANCE))) {
 		cm->cm_reset = true;
 		scm->sc_op = treq->op;
-	} else
+		scm->sc_prio = treq->op == CM_OP_REPAIR &&
+			       (treq->flags & CM_OP_FLAG_PRIO) != 0;
+		scm->sc_direct = treq->op == CM_OP_REPAIR &&
+				 (treq->flags & CM_OP_FLAG_DIRECT) != 0;
+	} else {
+		/* Resumed repair keeps the flags it was started with. */
 		scm->sc_op = treq->op == CM_OP_REPAIR_RESUME ? CM_OP_REPAIR :
 			     CM_OP_REBALANCE;
+	}
+}
+
+static int sns_throttle(struct m0_fom *fom)
+{
+	struct m0_cm                  *cm   = M0_AMB(cm, fom->fo_service,
+						     cm_service);
+	struct trigger_fop            *treq = m0_fop_data(fom->fo_fop);
+	struct m0_sns_cm_throttle_cfg  cfg  = {
+		.stc_bytes_per_sec = treq->throttle.tt_bytes_per_sec,
+		.stc_iops          = treq->throttle.tt_iops,
+		.stc_latency       = treq->throttle.tt_latency
+	};
+
+	M0_PRE(M0_IN(treq->op, (CM_OP_REPAIR_THROTTLE,
+				CM_OP_REBALANCE_THROTTLE)));
+
+	m0_sns_cm_throttle_cfg_set(&cm2sns(cm)->sc_throttle, &cfg);
+	return 0;
 }
 
 #undef M0_TRACE_SUBSYSTEM
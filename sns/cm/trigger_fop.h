@@ -39,6 +39,8 @@ extern struct m0_fop_type m0_sns_rebalance_quiesce_fopt;
 extern struct m0_fop_type m0_sns_rebalance_status_fopt;
 extern struct m0_fop_type m0_sns_repair_abort_fopt;
 extern struct m0_fop_type m0_sns_rebalance_abort_fopt;
+extern struct m0_fop_type m0_sns_repair_throttle_fopt;
+extern struct m0_fop_type m0_sns_rebalance_throttle_fopt;
 
 extern struct m0_fop_type m0_sns_repair_trigger_rep_fopt;
 extern struct m0_fop_type m0_sns_repair_quiesce_rep_fopt;
@@ -48,6 +50,8 @@ extern struct m0_fop_type m0_sns_rebalance_quiesce_rep_fopt;
 extern struct m0_fop_type m0_sns_rebalance_status_rep_fopt;
 extern struct m0_fop_type m0_sns_repair_abort_rep_fopt;
 extern struct m0_fop_type m0_sns_rebalance_abort_rep_fopt;
+extern struct m0_fop_type m0_sns_repair_throttle_rep_fopt;
+extern struct m0_fop_type m0_sns_rebalance_throttle_rep_fopt;
 
 
 M0_INTERNAL int m0_sns_cm_trigger_fop_alloc(struct m0_rpc_machine  *mach,
@@ -23,11 +23,12 @@
 #include "lib/assert.h"
 #include "lib/errno.h"
 #include "lib/memory.h"
-#include "lib/misc.h" /* SET0() */
+#include "lib/misc.h" /* SET0(), memcpy() */
 #include "lib/types.h"
 
 #include "sns/parity_ops.h"
 #include "sns/parity_math.h"
+#include "sns/parity_simd.h"
 
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_SNS
 #include "lib/trace.h"
@@ -137,6 +138,17 @@ static void fail_idx_reed_solomon_recover(struct m0_parity_math *math,
 					  struct m0_buf *parity,
 					  const uint32_t failure_index);
 
+/**
+ * This function recovers failed data and/or parity using LRC algorithm.
+ * Local groups with a single failure are repaired by XOR of the group,
+ * remaining failures are recovered as in reed_solomon_recover().
+ */
+static int lrc_recover(struct m0_parity_math *math,
+		       struct m0_buf *data,
+		       struct m0_buf *parity,
+		       struct m0_buf *fails,
+		       enum m0_parity_linsys_algo algo);
+
 /**
  * Initialize fields, specific to Reed Solomon implementation, which are
  * required for incremental recovery.
@@ -225,6 +237,18 @@ static int isal_encode_data_update(struct m0_buf *dest_bufs, struct m0_buf *src_
 				   uint32_t vec_idx, uint8_t *g_tbls,
 				   uint32_t data_nr, uint32_t dest_nr);
 
+/**
+ * Same as isal_encode_data_update() with decode tables of the failed blocks
+ * of ir, with the work split between threads of ir->si_pool.
+ * @param[out] dest_bufs - Buffers of failed blocks, ir->si_rs.rs_failed_nr.
+ * @param[in]  src_buf   - Alive block submitted for recovery.
+ * @param[in]  vec_idx   - Index of src_buf among alive blocks.
+ * @retval     0           on success.
+ * @retval     -ENOMEM     on failure to acquire memory.
+ */
+static int ir_pool_encode_update(struct m0_sns_ir *ir, struct m0_buf *dest_bufs,
+				 struct m0_buf *src_buf, uint32_t vec_idx);
+
 /**
  * Sorts the indices for failed and non-failed data and parity blocks.
  * @param[in,out]  rs            - Pointer to Reed Solomon structure.
@@ -278,6 +302,23 @@ static int isal_gen_recov_coeff_tbl(uint32_t data_count, uint32_t parity_count,
  */
 static void dependency_bitmap_prepare(struct m0_sns_ir_block *f_block,
 				      struct m0_sns_ir *ir);
+
+/**
+ * Replaces local parity rows of the encoding matrix by XOR rows over the
+ * data units of respective local groups. Global parity rows are left as
+ * generated by gf_gen_cauchy1_matrix().
+ */
+static void lrc_encode_matrix_fill(struct m0_parity_math *math);
+
+/**
+ * Reorders rs_alive_idx[0 .. alive_nr) so that its first data_count entries
+ * are linearly independent rows of the encoding matrix. Rows are picked in
+ * the order of rs_alive_idx, skipping rows dependent on the picked ones.
+ * @retval         0              - success
+ * @retval         -EDOM          - alive rows have rank less than data_count.
+ */
+static int lrc_alive_select(struct m0_reed_solomon *rs, uint32_t data_count,
+			    uint32_t alive_nr);
 #endif /* __KERNEL__ */
 
 static void (*calculate[M0_PARITY_CAL_ALGO_NR])(struct m0_parity_math *math,
@@ -285,6 +326,7 @@ static void (*calculate[M0_PARITY_CAL_ALGO_NR])(struct m0_parity_math *math,
 						struct m0_buf *parity) = {
 	[M0_PARITY_CAL_ALGO_XOR] = xor_calculate,
 	[M0_PARITY_CAL_ALGO_REED_SOLOMON] = reed_solomon_encode,
+	[M0_PARITY_CAL_ALGO_LRC] = reed_solomon_encode,
 };
 
 static int (*diff[M0_PARITY_CAL_ALGO_NR])(struct m0_parity_math *math,
@@ -294,6 +336,7 @@ static int (*diff[M0_PARITY_CAL_ALGO_NR])(struct m0_parity_math *math,
 					   uint32_t               index) = {
 	[M0_PARITY_CAL_ALGO_XOR]          = xor_diff,
 	[M0_PARITY_CAL_ALGO_REED_SOLOMON] = reed_solomon_diff,
+	[M0_PARITY_CAL_ALGO_LRC]          = reed_solomon_diff,
 };
 
 static int (*recover[M0_PARITY_CAL_ALGO_NR])(struct m0_parity_math *math,
@@ -303,6 +346,7 @@ static int (*recover[M0_PARITY_CAL_ALGO_NR])(struct m0_parity_math *math,
 					     enum m0_parity_linsys_algo algo) = {
 	[M0_PARITY_CAL_ALGO_XOR] = xor_recover,
 	[M0_PARITY_CAL_ALGO_REED_SOLOMON] = reed_solomon_recover,
+	[M0_PARITY_CAL_ALGO_LRC] = lrc_recover,
 };
 
 static void (*fidx_recover[M0_PARITY_CAL_ALGO_NR])(struct m0_parity_math *math,
@@ -311,6 +355,7 @@ static void (*fidx_recover[M0_PARITY_CAL_ALGO_NR])(struct m0_parity_math *math,
 						   const uint32_t fidx) = {
 	[M0_PARITY_CAL_ALGO_XOR] = fail_idx_xor_recover,
 	[M0_PARITY_CAL_ALGO_REED_SOLOMON] = fail_idx_reed_solomon_recover,
+	[M0_PARITY_CAL_ALGO_LRC] = fail_idx_reed_solomon_recover,
 };
 
 enum {
@@ -318,6 +363,10 @@ enum {
 	BAD_FAIL_INDEX = -1,
 	IR_INVALID_COL = UINT8_MAX,
 	MIN_TABLE_LEN = 32,
+	/* Byte range of a block processed by a single job of m0_sns_ir_pool. */
+	IR_JOB_NOB = 1 << 16,
+	/* Number of jobs of m0_sns_ir_pool started at once. */
+	IR_POOL_JOBS_NR = 64,
 };
 
 /* Parity Math Functions. */
@@ -325,30 +374,43 @@ enum {
 M0_INTERNAL void m0_parity_math_fini(struct m0_parity_math *math)
 {
 	M0_ENTRY();
-	if (math->pmi_parity_algo == M0_PARITY_CAL_ALGO_REED_SOLOMON)
+	if (M0_IN(math->pmi_parity_algo, (M0_PARITY_CAL_ALGO_REED_SOLOMON,
+					  M0_PARITY_CAL_ALGO_LRC)))
 		reed_solomon_fini(math);
 	M0_LEAVE();
 }
 
 M0_INTERNAL int m0_parity_math_init(struct m0_parity_math *math,
 				    uint32_t data_count, uint32_t parity_count)
+{
+	return m0_parity_math_lrc_init(math, data_count, parity_count, 0);
+}
+
+M0_INTERNAL int m0_parity_math_lrc_init(struct m0_parity_math *math,
+					uint32_t data_count,
+					uint32_t parity_count,
+					uint32_t local_nr)
 {
 	int ret = 0;
 
-	M0_ENTRY("data_count=%u parity_count=%u", data_count, parity_count);
+	M0_ENTRY("data_count=%u parity_count=%u local_nr=%u",
+		 data_count, parity_count, local_nr);
 
 	M0_PRE(math != NULL);
 
 	M0_SET0(math);
 	math->pmi_data_count   = data_count;
 	math->pmi_parity_count = parity_count;
+	math->pmi_local_nr     = local_nr;
 
 	M0_PRE(parity_math_invariant(math));
 
 	if (parity_count == 1)
 		math->pmi_parity_algo = M0_PARITY_CAL_ALGO_XOR;
 	else {
-		math->pmi_parity_algo = M0_PARITY_CAL_ALGO_REED_SOLOMON;
+		math->pmi_parity_algo = local_nr == 0 ?
+			M0_PARITY_CAL_ALGO_REED_SOLOMON :
+			M0_PARITY_CAL_ALGO_LRC;
 		ret = reed_solomon_init(math);
 		if (ret != 0) {
 			m0_parity_math_fini(math);
@@ -415,11 +477,7 @@ M0_INTERNAL void m0_parity_math_refine(struct m0_parity_math *math,
 M0_INTERNAL void m0_parity_math_buffer_xor(struct m0_buf *dest,
 					   const struct m0_buf *src)
 {
-        uint32_t ei; /* block element index. */
-
-        for (ei = 0; ei < src[0].b_nob; ++ei)
-		((uint8_t*)dest[0].b_addr)[ei] ^=
-			(m0_parity_elem_t)((uint8_t*)src[0].b_addr)[ei];
+	m0_parity_simd_xor(dest[0].b_addr, src[0].b_addr, src[0].b_nob);
 }
 
 M0_INTERNAL int m0_sns_ir_init(const struct m0_parity_math *math,
@@ -434,10 +492,11 @@ M0_INTERNAL int m0_sns_ir_init(const struct m0_parity_math *math,
 
 	M0_SET0(ir);
 
-	ir->si_data_nr   = math->pmi_data_count;
-	ir->si_parity_nr = math->pmi_parity_count;
-	ir->si_local_nr  = local_nr;
-	ir->si_alive_nr  = ir_blocks_count(ir);
+	ir->si_parity_algo = math->pmi_parity_algo;
+	ir->si_data_nr     = math->pmi_data_count;
+	ir->si_parity_nr   = math->pmi_parity_count;
+	ir->si_local_nr    = local_nr;
+	ir->si_alive_nr    = ir_blocks_count(ir);
 
 	ret = ir_si_blocks_init(ir);
 	if (ret != 0) {
@@ -562,18 +621,44 @@ M0_INTERNAL int m0_sns_ir_recover(struct m0_sns_ir *ir,
 	return M0_RC(0);
 }
 
-/* Parity Math Helper Functions */
+#ifndef __KERNEL__
+M0_INTERNAL int m0_sns_ir_pool_init(struct m0_sns_ir_pool *pool,
+				    int thread_nr)
+{
+	int rc;
+
+	M0_ENTRY("pool=%p, thread_nr=%d", pool, thread_nr);
+	M0_PRE(pool != NULL);
+
+	m0_mutex_init(&pool->sip_lock);
+	rc = m0_parallel_pool_init(&pool->sip_pool, thread_nr,
+				   IR_POOL_JOBS_NR);
+	if (rc != 0)
+		m0_mutex_fini(&pool->sip_lock);
+	return M0_RC(rc);
+}
+
+M0_INTERNAL void m0_sns_ir_pool_fini(struct m0_sns_ir_pool *pool)
+{
+	M0_PRE(pool != NULL);
 
-/* Functions m0_parity_* are too much eclectic. Just more simple names. */
-static int gadd(int x, int y)
+	m0_parallel_pool_terminate_wait(&pool->sip_pool);
+	m0_parallel_pool_fini(&pool->sip_pool);
+	m0_mutex_fini(&pool->sip_lock);
+}
+#else
+M0_INTERNAL int m0_sns_ir_pool_init(struct m0_sns_ir_pool *pool,
+				    int thread_nr)
 {
-	return m0_parity_add(x, y);
+	return M0_ERR(-ENOSYS);
 }
 
-static int gmul(int x, int y)
+M0_INTERNAL void m0_sns_ir_pool_fini(struct m0_sns_ir_pool *pool)
 {
-	return m0_parity_mul(x, y);
 }
+#endif /* __KERNEL__ */
+
+/* Parity Math Helper Functions */
 
 static uint32_t fails_count(uint8_t *fail, uint32_t unit_count)
 {
@@ -591,30 +676,52 @@ static bool parity_math_invariant(const struct m0_parity_math *math)
 	return  _0C(math != NULL) && _0C(math->pmi_data_count >= 1) &&
 		_0C(math->pmi_parity_count >= 1) &&
 		_0C(math->pmi_data_count >= math->pmi_parity_count) &&
-		_0C(math->pmi_data_count <= SNS_PARITY_MATH_DATA_BLOCKS_MAX);
+		_0C(math->pmi_data_count <= SNS_PARITY_MATH_DATA_BLOCKS_MAX) &&
+		_0C(math->pmi_local_nr == 0 ||
+		    (math->pmi_local_nr < math->pmi_parity_count &&
+		     math->pmi_data_count % math->pmi_local_nr == 0));
+}
+
+/* Sets unit fidx of a XOR parity group to XOR of all other units. */
+static void xor_unit_set(struct m0_parity_math *math,
+			 struct m0_buf *data,
+			 struct m0_buf *parity,
+			 uint32_t fidx)
+{
+	uint32_t  ui; /* unit index. */
+	uint32_t  data_count = math->pmi_data_count;
+	uint32_t  block_size = data[0].b_nob;
+	uint8_t  *dst;
+	uint8_t  *src;
+	bool      first = true;
+
+	dst = fidx < data_count ? data[fidx].b_addr : parity[0].b_addr;
+	for (ui = 0; ui <= data_count; ++ui) {
+		if (ui == fidx)
+			continue;
+		src = ui < data_count ? data[ui].b_addr : parity[0].b_addr;
+		if (first)
+			memcpy(dst, src, block_size);
+		else
+			m0_parity_simd_xor(dst, src, block_size);
+		first = false;
+	}
 }
 
 static void xor_calculate(struct m0_parity_math *math,
 			  const struct m0_buf *data,
 			  struct m0_buf *parity)
 {
-	uint32_t          ei; /* block element index. */
 	uint32_t          ui; /* unit index. */
 	uint32_t          block_size = data[0].b_nob;
-	m0_parity_elem_t  pe;
 
 	M0_ENTRY();
 	M0_PRE(block_size == parity[0].b_nob);
 	for (ui = 1; ui < math->pmi_data_count; ++ui)
 		M0_PRE(block_size == data[ui].b_nob);
 
-	for (ei = 0; ei < block_size; ++ei) {
-		pe = 0;
-		for (ui = 0; ui < math->pmi_data_count; ++ui)
-			pe ^= (m0_parity_elem_t)((uint8_t*)data[ui].b_addr)[ei];
-
-		((uint8_t*)parity[0].b_addr)[ei] = pe;
-	}
+	xor_unit_set(math, (struct m0_buf *)data, parity,
+		     math->pmi_data_count);
 	M0_LEAVE();
 }
 
@@ -624,8 +731,6 @@ static int xor_diff(struct m0_parity_math *math,
 		    struct m0_buf         *parity,
 		    uint32_t               index)
 {
-	uint32_t ei;
-
 	M0_PRE(math   != NULL);
 	M0_PRE(old    != NULL);
 	M0_PRE(new    != NULL);
@@ -634,11 +739,10 @@ static int xor_diff(struct m0_parity_math *math,
 	M0_PRE(old[index].b_nob == new[index].b_nob);
 	M0_PRE(new[index].b_nob == parity[0].b_nob);
 
-	for (ei = 0; ei < new[index].b_nob; ++ei) {
-		((uint8_t*)parity[0].b_addr)[ei] ^=
-			((uint8_t *)old[index].b_addr)[ei] ^
-			((uint8_t *)new[index].b_addr)[ei];
-	}
+	m0_parity_simd_xor(parity[0].b_addr, old[index].b_addr,
+			   new[index].b_nob);
+	m0_parity_simd_xor(parity[0].b_addr, new[index].b_addr,
+			   new[index].b_nob);
 
 	return M0_RC(0);
 }
@@ -649,13 +753,11 @@ static int xor_recover(struct m0_parity_math *math,
 		       struct m0_buf *fails,
 		       enum m0_parity_linsys_algo algo)
 {
-	uint32_t          ei; /* block element index. */
 	uint32_t          ui; /* unit index. */
 	uint8_t          *fail;
 	uint32_t          fail_count;
 	uint32_t          unit_count;
 	uint32_t          block_size = data[0].b_nob;
-	m0_parity_elem_t  pe;
 	int               fail_index = BAD_FAIL_INDEX;
 
 	unit_count = math->pmi_data_count + math->pmi_parity_count;
@@ -669,23 +771,12 @@ static int xor_recover(struct m0_parity_math *math,
 	for (ui = 1; ui < math->pmi_data_count; ++ui)
 		M0_PRE(block_size == data[ui].b_nob);
 
-	for (ei = 0; ei < block_size; ++ei) {
-		pe = 0;
-		for (ui = 0; ui < math->pmi_data_count; ++ui) {
-			if (fail[ui] != 1)
-				pe ^= (m0_parity_elem_t)((uint8_t*)
-				       data[ui].b_addr)[ei];
-			else
-				fail_index = ui;
-		}
-		/* Now ui points to parity block, test if it was failed. */
-		if (fail[ui] != 1) {
-			M0_ASSERT(fail_index != BAD_FAIL_INDEX);
-			((uint8_t*)data[fail_index].b_addr)[ei] = pe ^
-				((uint8_t*)parity[0].b_addr)[ei];
-		} else /* Parity was lost, so recover it. */
-			((uint8_t*)parity[0].b_addr)[ei] = pe;
+	for (ui = 0; ui < unit_count; ++ui) {
+		if (fail[ui] == 1)
+			fail_index = ui;
 	}
+	M0_ASSERT(fail_index != BAD_FAIL_INDEX);
+	xor_unit_set(math, data, parity, fail_index);
 	return M0_RC(0);
 }
 
@@ -694,11 +785,9 @@ static void fail_idx_xor_recover(struct m0_parity_math *math,
 				 struct m0_buf *parity,
 				 const uint32_t failure_index)
 {
-	uint32_t          ei; /* block element index. */
 	uint32_t          ui; /* unit index. */
 	uint32_t          unit_count;
 	uint32_t          block_size = data[0].b_nob;
-	m0_parity_elem_t  pe;
 
 	M0_PRE(block_size == parity[0].b_nob);
 
@@ -708,19 +797,7 @@ static void fail_idx_xor_recover(struct m0_parity_math *math,
 	for (ui = 1; ui < math->pmi_data_count; ++ui)
 		M0_ASSERT(block_size == data[ui].b_nob);
 
-	for (ei = 0; ei < block_size; ++ei) {
-		pe = 0;
-		for (ui = 0; ui < math->pmi_data_count; ++ui)
-			if (ui != failure_index)
-				pe ^= (m0_parity_elem_t)((uint8_t*)
-				       data[ui].b_addr)[ei];
-
-		if (ui != failure_index)
-			((uint8_t*)data[failure_index].b_addr)[ei] = pe ^
-				((uint8_t*)parity[0].b_addr)[ei];
-		else /* Parity was lost, so recover it. */
-			((uint8_t*)parity[0].b_addr)[ei] = pe;
-	}
+	xor_unit_set(math, data, parity, failure_index);
 }
 
 /** @todo Iterative reed-solomon decode to be implemented. */
@@ -765,7 +842,6 @@ static inline uint32_t ir_blocks_count(const struct m0_sns_ir *ir)
 static void gfaxpy(struct m0_bufvec *y, struct m0_bufvec *x,
 		   m0_parity_elem_t alpha)
 {
-	uint32_t                i;
 	uint32_t                seg_size;
 	uint8_t                *y_addr;
 	uint8_t                *x_addr;
@@ -789,19 +865,7 @@ static void gfaxpy(struct m0_bufvec *y, struct m0_bufvec *x,
 		x_addr  = m0_bufvec_cursor_addr(&x_cursor);
 		y_addr  = m0_bufvec_cursor_addr(&y_cursor);
 
-		switch (alpha) {
-		/* This is a special case of the 'default' case that follows.
-		 * Here we avoid unnecessary call to gmul.*/
-		case 1:
-			for (i = 0; i <seg_size; ++i)
-				y_addr[i] = gadd(y_addr[i], x_addr[i]);
-			break;
-		default:
-			for (i = 0; i < seg_size; ++i)
-				y_addr[i] = gadd(y_addr[i], gmul(x_addr[i],
-							         alpha));
-			break;
-		}
+		m0_parity_simd_gf_mac(y_addr, x_addr, alpha, seg_size);
 		step = m0_bufvec_cursor_step(&y_cursor);
 	} while (!m0_bufvec_cursor_move(&x_cursor, step) &&
 		 !m0_bufvec_cursor_move(&y_cursor, step));
@@ -823,8 +887,14 @@ static bool is_usable(const struct m0_sns_ir *ir,
 	if (last_usable_bid == ir_blocks_count(ir))
 		return false;
 	for (i = 0; i <= last_usable_bid; ++i) {
+		/*
+		 * With LRC an alive block may be absent from the dependency
+		 * bitmap, its contribution to the incoming block is zero then.
+		 */
 		if (m0_bitmap_get(in_bmap, i) &&
-		    !m0_bitmap_get(&failed_block->sib_bitmap, i))
+		    !m0_bitmap_get(&failed_block->sib_bitmap, i) &&
+		    !(ir->si_parity_algo == M0_PARITY_CAL_ALGO_LRC &&
+		      ir->si_blocks[i].sib_status == M0_SI_BLOCK_ALIVE))
 			return false;
 	}
 	return true;
@@ -847,6 +917,7 @@ static void reed_solomon_fini(struct m0_parity_math *math)
 	m0_free(math->pmi_rs.rs_failed_idx);
 	m0_free(math->pmi_rs.rs_bufs_in);
 	m0_free(math->pmi_rs.rs_bufs_out);
+	m0_free(math->pmi_rs.rs_decode_mat);
 	M0_LEAVE();
 }
 
@@ -890,6 +961,8 @@ static int reed_solomon_init(struct m0_parity_math *math)
 	 */
 	gf_gen_cauchy1_matrix(rs->rs_encode_matrix, total_count,
 			      math->pmi_data_count);
+	if (math->pmi_parity_algo == M0_PARITY_CAL_ALGO_LRC)
+		lrc_encode_matrix_fill(math);
 
 	/* Initialize tables for fast Erasure Code encode. */
 	ec_init_tables(math->pmi_data_count, math->pmi_parity_count,
@@ -917,6 +990,11 @@ static int reed_solomon_init(struct m0_parity_math *math)
 		return BUF_ALLOC_ERR_INFO(-ENOMEM, "output buffers array",
 					  math->pmi_parity_count);
 
+	M0_ALLOC_ARR(rs->rs_decode_mat, tbl_len / MIN_TABLE_LEN);
+	if (rs->rs_decode_mat == NULL)
+		return BUF_ALLOC_ERR_INFO(-ENOMEM, "decode matrix",
+					  tbl_len / MIN_TABLE_LEN);
+
 	return M0_RC(ret);
 }
 
@@ -962,12 +1040,9 @@ static int reed_solomon_diff(struct m0_parity_math *math,
 			     struct m0_buf         *parity,
 			     uint32_t               index)
 {
-	struct m0_buf  diff_data_buf;
-	uint8_t       *diff_data_arr = NULL;
+	const uint8_t *coef;
 	uint32_t       block_size;
-	uint32_t       alignment = sizeof(uint_fast32_t);
 	uint32_t       i;
-	int            ret = 0;
 
 	M0_ENTRY("math=%p, old=%p, new=%p, parity=%p, index=%u",
 		 math, old, new, parity, index);
@@ -987,35 +1062,27 @@ static int reed_solomon_diff(struct m0_parity_math *math,
 
 	block_size = new[index].b_nob;
 
-	/* It is assumed that the buffer size will always be a multiple of
-	 * 8-bytes (especially since block size currently is 4K) and this assert
-	 * is added with the hope that any deviation from this assumption is
-	 * caught during development instead of on the field. */
-	M0_ASSERT_INFO(m0_is_aligned(block_size, alignment),
-		       "block_size=%u is not %u-bytes aligned",
-		       block_size, alignment);
-
-	M0_ALLOC_ARR(diff_data_arr, block_size);
-	if (diff_data_arr == NULL)
-		return BUF_ALLOC_ERR_INFO(-ENOMEM, "differential data block",
-					  block_size);
-
-	m0_buf_init(&diff_data_buf, diff_data_arr, block_size);
-
-	/* Calculate the differential data using old and new data blocks. */
-	for (i = 0; i < (block_size / alignment); i++)
-		((uint_fast32_t *)diff_data_arr)[i] =
-			((uint_fast32_t *)old[index].b_addr)[i] ^
-			((uint_fast32_t *)new[index].b_addr)[i];
-
-	/* Update differential parity using differential data. */
-	ret = isal_encode_data_update(parity, &diff_data_buf, index,
-				      math->pmi_rs.rs_encode_tbls,
-				      math->pmi_data_count,
-				      math->pmi_parity_count);
-
-	m0_free(diff_data_arr);
-	return M0_RC(ret);
+	/*
+	 * Parity is linear in data, so the parity delta is
+	 * c * (old ^ new) = c * old ^ c * new, where c is the coefficient of
+	 * the data block in the row of the parity block in the encode matrix.
+	 * This avoids a temporary buffer for differential data.
+	 */
+	coef = &math->pmi_rs.rs_encode_matrix[math->pmi_data_count *
+					      math->pmi_data_count + index];
+	for (i = 0; i < math->pmi_parity_count; ++i) {
+		BLOCK_SIZE_ASSERT_INFO(block_size, i, parity);
+		if (coef[i * math->pmi_data_count] == 0)
+			continue;
+		m0_parity_simd_gf_mac(parity[i].b_addr, old[index].b_addr,
+				      coef[i * math->pmi_data_count],
+				      block_size);
+		m0_parity_simd_gf_mac(parity[i].b_addr, new[index].b_addr,
+				      coef[i * math->pmi_data_count],
+				      block_size);
+	}
+
+	return M0_RC(0);
 }
 
 static int reed_solomon_recover(struct m0_parity_math *math,
@@ -1093,6 +1160,7 @@ static void ir_rs_init(const struct m0_parity_math *math, struct m0_sns_ir *ir)
 	ir->si_rs.rs_decode_tbls = math->pmi_rs.rs_decode_tbls;
 	ir->si_rs.rs_failed_idx = math->pmi_rs.rs_failed_idx;
 	ir->si_rs.rs_alive_idx = math->pmi_rs.rs_alive_idx;
+	ir->si_rs.rs_decode_mat = math->pmi_rs.rs_decode_mat;
 
 	M0_LEAVE();
 }
@@ -1132,6 +1200,12 @@ static int ir_mat_compute(struct m0_sns_ir *ir)
 
 	VALUE_MISMATCH_ASSERT_INFO(alive_nr, ir->si_alive_nr);
 
+	if (ir->si_parity_algo == M0_PARITY_CAL_ALGO_LRC) {
+		ret = lrc_alive_select(rs, ir->si_data_nr, alive_nr);
+		if (ret != 0)
+			return M0_ERR_INFO(ret, "failed to select alive blocks");
+	}
+
 	ret = isal_gen_recov_coeff_tbl(ir->si_data_nr, ir->si_parity_nr, rs);
 	if (ret != 0)
 		return M0_ERR_INFO(ret, "failed to generate decode matrix");
@@ -1162,9 +1236,11 @@ static int ir_recover(struct m0_sns_ir *ir, struct m0_sns_ir_block *alive_block)
 	/* Check if given alive block is dependecy of any failed block. */
 	for (i = 0; i < rs->rs_failed_nr; i++) {
 		failed_bitmap = &ir->si_blocks[rs->rs_failed_idx[i]].sib_bitmap;
-		if (m0_bitmap_get(failed_bitmap, alive_block->sib_idx) == 0)
-			return M0_RC(ret);
+		if (m0_bitmap_get(failed_bitmap, alive_block->sib_idx))
+			break;
 	}
+	if (i == rs->rs_failed_nr)
+		return M0_RC(ret);
 
 	alive_bufvec = alive_block->sib_addr;
 	length = (uint32_t)m0_vec_count(&alive_bufvec->ov_vec);
@@ -1223,9 +1299,13 @@ static int ir_recover(struct m0_sns_ir *ir, struct m0_sns_ir_block *alive_block)
 	}
 
 	/* Recover the data using input buffer and its index. */
-	ret = isal_encode_data_update(out_bufs, &in_buf, curr_idx,
-				      rs->rs_decode_tbls, ir->si_data_nr,
-				      rs->rs_failed_nr);
+	if (ir->si_pool != NULL)
+		ret = ir_pool_encode_update(ir, out_bufs, &in_buf, curr_idx);
+	else
+		ret = isal_encode_data_update(out_bufs, &in_buf, curr_idx,
+					      rs->rs_decode_tbls,
+					      ir->si_data_nr,
+					      rs->rs_failed_nr);
 	if (ret != 0) {
 		ret = M0_ERR_INFO(ret, "Failed to recover the data.");
 		goto exit;
@@ -1288,6 +1368,90 @@ static int isal_encode_data_update(struct m0_buf *dest_bufs, struct m0_buf *src_
 	return M0_RC(0);
 }
 
+/* Job of m0_sns_ir_pool: updates a byte range of a single failed block. */
+struct ir_job {
+	uint32_t  ij_data_nr;
+	uint32_t  ij_vec_idx;
+	/* Decode tables of the failed block. */
+	uint8_t  *ij_tbls;
+	uint8_t  *ij_src;
+	uint8_t  *ij_dst;
+	uint32_t  ij_nob;
+};
+
+static int ir_job_process(void *arg)
+{
+	struct ir_job *job = arg;
+
+	ec_encode_data_update(job->ij_nob, job->ij_data_nr, 1, job->ij_vec_idx,
+			      job->ij_tbls, job->ij_src, &job->ij_dst);
+	return 0;
+}
+
+static int ir_pool_encode_update(struct m0_sns_ir *ir, struct m0_buf *dest_bufs,
+				 struct m0_buf *src_buf, uint32_t vec_idx)
+{
+	struct m0_reed_solomon  *rs = &ir->si_rs;
+	struct m0_parallel_pool *pool = &ir->si_pool->sip_pool;
+	struct ir_job           *jobs;
+	uint32_t                 block_size = (uint32_t)src_buf->b_nob;
+	uint32_t                 chunk_nr;
+	uint32_t                 job_nr;
+	uint32_t                 off;
+	uint32_t                 i;
+	uint32_t                 j;
+	uint32_t                 k;
+	int                      rc = 0;
+
+	M0_ENTRY("ir=%p, vec_idx=%u", ir, vec_idx);
+
+	chunk_nr = max32u((block_size + IR_JOB_NOB - 1) / IR_JOB_NOB, 1);
+	job_nr = chunk_nr * rs->rs_failed_nr;
+	M0_ALLOC_ARR(jobs, job_nr);
+	if (jobs == NULL)
+		return BUF_ALLOC_ERR_INFO(-ENOMEM, "ir jobs", job_nr);
+
+	for (i = 0, k = 0; i < rs->rs_failed_nr; ++i) {
+		BLOCK_SIZE_ASSERT_INFO(block_size, i, dest_bufs);
+		for (j = 0; j < chunk_nr; ++j, ++k) {
+			off = j * IR_JOB_NOB;
+			jobs[k] = (struct ir_job) {
+				.ij_data_nr = ir->si_data_nr,
+				.ij_vec_idx = vec_idx,
+				.ij_tbls    = rs->rs_decode_tbls +
+					      i * ir->si_data_nr *
+					      MIN_TABLE_LEN,
+				.ij_src     = (uint8_t *)src_buf->b_addr + off,
+				.ij_dst     = (uint8_t *)dest_bufs[i].b_addr +
+					      off,
+				.ij_nob     = min32u(block_size - off,
+						     IR_JOB_NOB)
+			};
+		}
+	}
+	M0_ASSERT(k == job_nr);
+
+	if (job_nr == 1) {
+		rc = ir_job_process(&jobs[0]);
+		m0_free(jobs);
+		return M0_RC(rc);
+	}
+	/* Jobs of different callers must not be mixed in one batch. */
+	m0_mutex_lock(&ir->si_pool->sip_lock);
+	for (j = 0; j < job_nr && rc == 0; ) {
+		for (k = 0; k < pool->pp_qlinks_nr && j < job_nr; ++k, ++j) {
+			rc = m0_parallel_pool_job_add(pool, &jobs[j]);
+			M0_ASSERT(rc == 0);
+		}
+		m0_parallel_pool_start(pool, &ir_job_process);
+		rc = m0_parallel_pool_wait(pool);
+	}
+	m0_mutex_unlock(&ir->si_pool->sip_lock);
+
+	m0_free(jobs);
+	return M0_RC(rc);
+}
+
 static void fails_sort(struct m0_reed_solomon *rs, uint8_t *fail,
 		       uint32_t total_count, uint32_t parity_count)
 {
@@ -1433,6 +1597,9 @@ static int isal_gen_recov_coeff_tbl(uint32_t data_count, uint32_t parity_count,
 
 	ec_init_tables(data_count, rs->rs_failed_nr,
 		       decode_mat, rs->rs_decode_tbls);
+	if (rs->rs_decode_mat != NULL)
+		memcpy(rs->rs_decode_mat, decode_mat,
+		       data_count * rs->rs_failed_nr);
 
 exit:
 	m0_free(decode_mat);
@@ -1445,19 +1612,257 @@ exit:
 static void dependency_bitmap_prepare(struct m0_sns_ir_block *f_block,
 				      struct m0_sns_ir *ir)
 {
-	uint32_t i;
+	struct m0_reed_solomon *rs = &ir->si_rs;
+	uint8_t                *coeff;
+	uint32_t                r;
+	uint32_t                i;
 
 	M0_PRE(f_block != NULL && ir != NULL);
 	M0_PRE(f_block->sib_status == M0_SI_BLOCK_FAILED);
 
+	if (ir->si_parity_algo != M0_PARITY_CAL_ALGO_LRC) {
+		for (i = 0; i < ir->si_data_nr; ++i)
+			m0_bitmap_set(&f_block->sib_bitmap, rs->rs_alive_idx[i],
+				      true);
+		return;
+	}
+	/* Only blocks with non-zero recovery coefficients are required. */
+	for (r = 0; rs->rs_failed_idx[r] != f_block->sib_idx; ++r)
+		M0_ASSERT(r + 1 < rs->rs_failed_nr);
+	coeff = &rs->rs_decode_mat[r * ir->si_data_nr];
 	for (i = 0; i < ir->si_data_nr; ++i)
-		m0_bitmap_set(&f_block->sib_bitmap, ir->si_rs.rs_alive_idx[i], true);
+		m0_bitmap_set(&f_block->sib_bitmap, rs->rs_alive_idx[i],
+			      coeff[i] != 0);
 }
 
 static uint32_t last_usable_block_id(const struct m0_sns_ir *ir,
 				     uint32_t block_idx)
 {
-	return ir->si_rs.rs_alive_idx[ir->si_data_nr - 1];
+	uint32_t i;
+	uint32_t last = 0;
+
+	if (ir->si_parity_algo != M0_PARITY_CAL_ALGO_LRC)
+		return ir->si_rs.rs_alive_idx[ir->si_data_nr - 1];
+	/* Alive blocks picked by lrc_alive_select() are not sorted. */
+	for (i = 0; i < ir->si_data_nr; ++i)
+		last = max32u(last, ir->si_rs.rs_alive_idx[i]);
+	return last;
+}
+
+static void lrc_encode_matrix_fill(struct m0_parity_math *math)
+{
+	uint32_t  data_count = math->pmi_data_count;
+	uint32_t  group_size = data_count / math->pmi_local_nr;
+	uint32_t  g;
+	uint32_t  j;
+	uint8_t  *row;
+
+	for (g = 0; g < math->pmi_local_nr; ++g) {
+		row = &math->pmi_rs.rs_encode_matrix[(data_count + g) *
+						     data_count];
+		for (j = 0; j < data_count; ++j)
+			row[j] = j / group_size == g;
+	}
+}
+
+static int lrc_alive_select(struct m0_reed_solomon *rs, uint32_t data_count,
+			    uint32_t alive_nr)
+{
+	uint8_t  *basis;
+	uint8_t  *pivot;
+	uint8_t  *picked;
+	uint8_t  *rest;
+	uint8_t  *row;
+	uint8_t   c;
+	uint32_t  rank = 0;
+	uint32_t  rest_nr = 0;
+	uint32_t  i;
+	uint32_t  j;
+	uint32_t  k;
+	int       ret = 0;
+
+	M0_ENTRY("rs=%p, data_count=%u, alive_nr=%u",
+		 rs, data_count, alive_nr);
+	M0_PRE(alive_nr >= data_count);
+
+	M0_ALLOC_ARR(basis, data_count * data_count);
+	M0_ALLOC_ARR(pivot, data_count);
+	M0_ALLOC_ARR(picked, data_count);
+	M0_ALLOC_ARR(rest, alive_nr);
+	if (basis == NULL || pivot == NULL || picked == NULL || rest == NULL) {
+		ret = BUF_ALLOC_ERR_INFO(-ENOMEM, "row selection",
+					 data_count * data_count);
+		goto exit;
+	}
+
+	/*
+	 * Gaussian elimination of each candidate row against the rows picked
+	 * so far. Every picked row is normalised to have 1 in its pivot
+	 * column and zeroes in pivot columns of the rows picked before it.
+	 */
+	for (i = 0; i < alive_nr; ++i) {
+		if (rank == data_count) {
+			rest[rest_nr++] = rs->rs_alive_idx[i];
+			continue;
+		}
+		row = &basis[rank * data_count];
+		memcpy(row, &rs->rs_encode_matrix[rs->rs_alive_idx[i] *
+						  data_count], data_count);
+		for (j = 0; j < rank; ++j) {
+			c = row[pivot[j]];
+			if (c == 0)
+				continue;
+			for (k = 0; k < data_count; ++k)
+				row[k] ^= gf_mul(c, basis[j * data_count + k]);
+		}
+		for (k = 0; k < data_count && row[k] == 0; ++k)
+			;
+		if (k == data_count) {
+			rest[rest_nr++] = rs->rs_alive_idx[i];
+			continue;
+		}
+		c = gf_inv(row[k]);
+		for (j = 0; j < data_count; ++j)
+			row[j] = gf_mul(c, row[j]);
+		pivot[rank] = k;
+		picked[rank++] = rs->rs_alive_idx[i];
+	}
+
+	if (rank < data_count) {
+		ret = M0_ERR_INFO(-EDOM, "alive blocks have rank %u < %u",
+				  rank, data_count);
+		goto exit;
+	}
+	memcpy(rs->rs_alive_idx, picked, data_count);
+	memcpy(&rs->rs_alive_idx[data_count], rest, rest_nr);
+exit:
+	m0_free(basis);
+	m0_free(pivot);
+	m0_free(picked);
+	m0_free(rest);
+	return M0_RC(ret);
+}
+
+static struct m0_buf *lrc_block(struct m0_parity_math *math,
+				struct m0_buf *data, struct m0_buf *parity,
+				uint32_t idx)
+{
+	return idx < math->pmi_data_count ? &data[idx] :
+		&parity[idx - math->pmi_data_count];
+}
+
+/* Index of i-th member of local group g, its local parity being the last. */
+static uint32_t lrc_group_member(const struct m0_parity_math *math,
+				 uint32_t g, uint32_t i)
+{
+	uint32_t group_size = math->pmi_data_count / math->pmi_local_nr;
+
+	return i < group_size ? g * group_size + i : math->pmi_data_count + g;
+}
+
+static int lrc_recover(struct m0_parity_math *math,
+		       struct m0_buf *data,
+		       struct m0_buf *parity,
+		       struct m0_buf *fails,
+		       enum m0_parity_linsys_algo algo)
+{
+	struct m0_reed_solomon *rs;
+	struct m0_buf          *dst;
+	uint32_t                fail_count;
+	uint32_t                total_count;
+	uint32_t                group_size;
+	uint32_t                block_size;
+	uint32_t                failed_idx;
+	uint32_t                failed_nr;
+	uint32_t                idx;
+	uint32_t                g;
+	uint32_t                i;
+	uint8_t                *fail;
+	int                     ret = 0;
+
+	M0_ENTRY("math=%p, data=%p, parity=%p, fails=%p",
+		 math, data, parity, fails);
+
+	M0_PRE(parity_math_invariant(math));
+	M0_PRE(data != NULL);
+	M0_PRE(parity != NULL);
+	M0_PRE(fails != NULL);
+
+	total_count = math->pmi_data_count + math->pmi_parity_count;
+	group_size = math->pmi_data_count / math->pmi_local_nr;
+	block_size = data[0].b_nob;
+	rs = &math->pmi_rs;
+
+	fail_count = fails_count((uint8_t *)fails->b_addr, total_count);
+	M0_ASSERT(fail_count > 0);
+	M0_ASSERT(fail_count <= math->pmi_parity_count);
+
+	for (i = 1; i < math->pmi_data_count; ++i)
+		BLOCK_SIZE_ASSERT_INFO(block_size, i, data);
+	for (i = 0; i < math->pmi_parity_count; ++i)
+		BLOCK_SIZE_ASSERT_INFO(block_size, i, parity);
+
+	/* fails is an input parameter, keep track of repaired blocks aside. */
+	M0_ALLOC_ARR(fail, total_count);
+	if (fail == NULL)
+		return BUF_ALLOC_ERR_INFO(-ENOMEM, "fail vector", total_count);
+	memcpy(fail, fails->b_addr, total_count);
+
+	/* Repair local groups with a single failure by XOR of the group. */
+	for (g = 0; g < math->pmi_local_nr; ++g) {
+		failed_idx = total_count;
+		for (i = 0, failed_nr = 0; i <= group_size; ++i) {
+			idx = lrc_group_member(math, g, i);
+			if (fail[idx] != 0) {
+				failed_idx = idx;
+				++failed_nr;
+			}
+		}
+		if (failed_nr != 1)
+			continue;
+		dst = lrc_block(math, data, parity, failed_idx);
+		memset(dst->b_addr, 0, block_size);
+		for (i = 0; i <= group_size; ++i) {
+			idx = lrc_group_member(math, g, i);
+			if (idx != failed_idx)
+				m0_parity_math_buffer_xor(dst,
+					lrc_block(math, data, parity, idx));
+		}
+		fail[failed_idx] = 0;
+		M0_CNT_DEC(fail_count);
+	}
+	if (fail_count == 0)
+		goto exit;
+
+	fails_sort(rs, fail, total_count, math->pmi_parity_count);
+	VALUE_MISMATCH_ASSERT_INFO(fail_count, rs->rs_failed_nr);
+
+	ret = lrc_alive_select(rs, math->pmi_data_count,
+			       total_count - fail_count);
+	if (ret != 0)
+		goto exit;
+
+	for (i = 0; i < math->pmi_data_count; ++i)
+		rs->rs_bufs_in[i] = lrc_block(math, data, parity,
+					      rs->rs_alive_idx[i])->b_addr;
+	for (i = 0; i < fail_count; ++i)
+		rs->rs_bufs_out[i] = lrc_block(math, data, parity,
+					       rs->rs_failed_idx[i])->b_addr;
+
+	ret = isal_gen_recov_coeff_tbl(math->pmi_data_count,
+				       math->pmi_parity_count, rs);
+	if (ret != 0) {
+		ret = M0_ERR_INFO(ret, "failed to generate recovery "
+				  "coefficient tables");
+		goto exit;
+	}
+
+	ec_encode_data(block_size, math->pmi_data_count,
+		       fail_count, rs->rs_decode_tbls,
+		       rs->rs_bufs_in, rs->rs_bufs_out);
+exit:
+	m0_free(fail);
+	return M0_RC(ret);
 }
 #else
 static void reed_solomon_fini(struct m0_parity_math *math)
@@ -1493,6 +1898,15 @@ static int reed_solomon_recover(struct m0_parity_math *math,
 	return 0;
 }
 
+static int lrc_recover(struct m0_parity_math *math,
+		       struct m0_buf *data,
+		       struct m0_buf *parity,
+		       struct m0_buf *fails,
+		       enum m0_parity_linsys_algo algo)
+{
+	return 0;
+}
+
 static void ir_rs_init(const struct m0_parity_math *math, struct m0_sns_ir *ir)
 {
 }
@@ -27,6 +27,8 @@
 #include "lib/vec.h"
 #include "lib/bitmap.h"
 #include "lib/tlist.h"
+#include "lib/mutex.h"
+#include "lib/thread_pool.h"
 #include "matvec.h"
 #include "ls_solve.h"
 
@@ -49,6 +51,13 @@
 enum m0_parity_cal_algo {
 	M0_PARITY_CAL_ALGO_XOR,
 	M0_PARITY_CAL_ALGO_REED_SOLOMON,
+	/**
+	 * Locally repairable code. Data units are split into equal local
+	 * groups, each protected by an XOR local parity, and the remaining
+	 * parity units are Reed-Solomon global parities over all data units.
+	 * A single failure in a group is repaired from the group alone.
+	 */
+	M0_PARITY_CAL_ALGO_LRC,
 	M0_PARITY_CAL_ALGO_NR
 };
 
@@ -115,6 +124,10 @@ struct m0_reed_solomon {
 	/* Array of buffer pointers to be used as destination for encoding or
 	 * recovery. */
 	uint8_t		**rs_bufs_out;
+	/* Decode coefficients of the last recovery, one row of data_count
+	 * coefficients over the first data_count alive blocks per failed
+	 * block. */
+	uint8_t		 *rs_decode_mat;
 };
 
 /**
@@ -126,11 +139,29 @@ struct m0_parity_math {
 
 	uint32_t		     pmi_data_count;
 	uint32_t		     pmi_parity_count;
+	/**
+	 * Number of local parity groups for M0_PARITY_CAL_ALGO_LRC, 0
+	 * otherwise. Parity unit i < pmi_local_nr is the local parity of
+	 * data units [i * N / pmi_local_nr, (i + 1) * N / pmi_local_nr).
+	 */
+	uint32_t		     pmi_local_nr;
 	struct m0_reed_solomon	     pmi_rs;
 };
 
+/**
+ * Threads shared by incremental recoveries. A block submitted to
+ * m0_sns_ir_recover() is applied to every failed block in parallel, large
+ * blocks are split further into byte ranges processed in parallel too.
+ */
+struct m0_sns_ir_pool {
+	struct m0_parallel_pool sip_pool;
+	/* Serialises batches of jobs of different users of sip_pool. */
+	struct m0_mutex         sip_lock;
+};
+
 /* Holds information essential for incremental recovery. */
 struct m0_sns_ir {
+	enum m0_parity_cal_algo	si_parity_algo;
 	uint32_t		si_data_nr;
 	uint32_t		si_parity_nr;
 	uint32_t		si_alive_nr;
@@ -140,6 +171,9 @@ struct m0_sns_ir {
 	/* Array holding all blocks */
 	struct m0_sns_ir_block *si_blocks;
 	struct m0_reed_solomon	si_rs;
+	/* Pool to run the recovery on, NULL to run it in the caller. Set by
+	 * the user after m0_sns_ir_init(). */
+	struct m0_sns_ir_pool  *si_pool;
 };
 
 /**
@@ -151,6 +185,20 @@ struct m0_sns_ir {
 M0_INTERNAL int m0_parity_math_init(struct m0_parity_math *math,
 				    uint32_t data_count, uint32_t parity_count);
 
+/**
+   Initialization of parity math with local parity groups.
+   Same as m0_parity_math_init() when local_nr is 0, otherwise selects
+   M0_PARITY_CAL_ALGO_LRC with local_nr local and parity_count - local_nr
+   global parity units.
+   @param local_nr - count of local parity groups.
+   @pre local_nr == 0 ||
+        (local_nr < parity_count && data_count % local_nr == 0)
+ */
+M0_INTERNAL int m0_parity_math_lrc_init(struct m0_parity_math *math,
+					uint32_t data_count,
+					uint32_t parity_count,
+					uint32_t local_nr);
+
 /**
    Deinitialization of parity math algorithms.
    Frees all memory blocks allocated by m0_parity_math_init().
@@ -462,6 +510,16 @@ M0_INTERNAL void m0_parity_math_buffer_xor(struct m0_buf *dest,
  * @code
  * m0_sns_ir_fini(&ir);
  * @endcode
+ *
+ * @section incremental_recovery-lrc Locally repairable codes
+ * With M0_PARITY_CAL_ALGO_LRC not every set of data_nr alive blocks is
+ * independent. m0_sns_ir_mat_compute() picks alive blocks in index order,
+ * skipping those that are linear combinations of already picked blocks, and
+ * fails with -EDOM if fewer than data_nr independent blocks remain. Hence
+ * alive data blocks are preferred, then local parities, then global ones.
+ * Dependency bitmap of a failed block has only those blocks set that have a
+ * non-zero coefficient in its recovery equation, so a single failure in a
+ * local group depends only on the other members of the group.
  **/
 
 /**
@@ -532,6 +590,14 @@ M0_INTERNAL int m0_sns_ir_recover(struct m0_sns_ir *ir,
  */
 //M0_INTERNAL void m0_sns_ir_local_xform(struct m0_sns_ir *ir);
 M0_INTERNAL void m0_sns_ir_fini(struct m0_sns_ir *ir);
+
+/**
+ * Starts thread_nr threads for incremental recovery.
+ * @retval -ENOSYS in kernel, where recovery always runs in the caller.
+ */
+M0_INTERNAL int m0_sns_ir_pool_init(struct m0_sns_ir_pool *pool,
+				    int thread_nr);
+M0_INTERNAL void m0_sns_ir_pool_fini(struct m0_sns_ir_pool *pool);
 /** @} end group Incremental recovery APIs */
 
 /** @} end group parity_math */
@@ -29,6 +29,7 @@
 #include <isa-l.h>
 #endif /* __KERNEL__ */
 #include "lib/assert.h"
+#include "sns/parity_simd.h"
 
 #define M0_PARITY_ZERO		(0)
 #define M0_PARITY_GALOIS_W	(8)
@@ -53,7 +54,7 @@ static inline m0_parity_elem_t m0_parity_mul(m0_parity_elem_t x, m0_parity_elem_
 #ifndef __KERNEL__
 	return gf_mul(x, y);
 #else
-	return 0;
+	return m0_parity_simd_gf_mul(x, y);
 #endif /* __KERNEL__ */
 }
 
@@ -62,7 +63,7 @@ static inline m0_parity_elem_t m0_parity_div(m0_parity_elem_t x, m0_parity_elem_
 #ifndef __KERNEL__
 	return gf_mul(x, gf_inv(y));
 #else
-	return 0;
+	return m0_parity_simd_gf_mul(x, m0_parity_simd_gf_inv(y));
 #endif /* __KERNEL__ */
 }
 
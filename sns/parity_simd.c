@@ -0,0 +1,425 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2012-2021 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_SNS
+#include "lib/trace.h"
+#include "lib/errno.h"
+#include "lib/misc.h"		/* ARRAY_SIZE */
+#include "lib/string.h"		/* m0_streq */
+#include "sns/parity_simd.h"
+
+#ifndef __KERNEL__
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+#endif /* __KERNEL__ */
+
+/**
+   @addtogroup parity_simd
+   @{
+ */
+
+struct simd_kernels {
+	const char *sk_name;
+	/** Returns true iff the CPU supports the kernels. */
+	bool      (*sk_supported)(void);
+	void      (*sk_xor)(uint8_t *dst, const uint8_t *src, m0_bcount_t nob);
+	/**
+	 * dst ^= c * src, where lo[i] = c * i and hi[i] = c * (i << 4) are
+	 * products of c with nibbles.
+	 */
+	void      (*sk_gf_mac)(uint8_t *dst, const uint8_t *src,
+			       const uint8_t *lo, const uint8_t *hi,
+			       m0_bcount_t nob);
+};
+
+/** Powers of the generator 2 of GF(2^8) modulo 0x11d. */
+static const uint8_t gf_exp[255] = {
+	0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1d, 0x3a, 0x74, 0xe8,
+	0xcd, 0x87, 0x13, 0x26, 0x4c, 0x98, 0x2d, 0x5a, 0xb4, 0x75, 0xea, 0xc9,
+	0x8f, 0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0, 0x9d, 0x27, 0x4e, 0x9c,
+	0x25, 0x4a, 0x94, 0x35, 0x6a, 0xd4, 0xb5, 0x77, 0xee, 0xc1, 0x9f, 0x23,
+	0x46, 0x8c, 0x05, 0x0a, 0x14, 0x28, 0x50, 0xa0, 0x5d, 0xba, 0x69, 0xd2,
+	0xb9, 0x6f, 0xde, 0xa1, 0x5f, 0xbe, 0x61, 0xc2, 0x99, 0x2f, 0x5e, 0xbc,
+	0x65, 0xca, 0x89, 0x0f, 0x1e, 0x3c, 0x78, 0xf0, 0xfd, 0xe7, 0xd3, 0xbb,
+	0x6b, 0xd6, 0xb1, 0x7f, 0xfe, 0xe1, 0xdf, 0xa3, 0x5b, 0xb6, 0x71, 0xe2,
+	0xd9, 0xaf, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0d, 0x1a, 0x34, 0x68,
+	0xd0, 0xbd, 0x67, 0xce, 0x81, 0x1f, 0x3e, 0x7c, 0xf8, 0xed, 0xc7, 0x93,
+	0x3b, 0x76, 0xec, 0xc5, 0x97, 0x33, 0x66, 0xcc, 0x85, 0x17, 0x2e, 0x5c,
+	0xb8, 0x6d, 0xda, 0xa9, 0x4f, 0x9e, 0x21, 0x42, 0x84, 0x15, 0x2a, 0x54,
+	0xa8, 0x4d, 0x9a, 0x29, 0x52, 0xa4, 0x55, 0xaa, 0x49, 0x92, 0x39, 0x72,
+	0xe4, 0xd5, 0xb7, 0x73, 0xe6, 0xd1, 0xbf, 0x63, 0xc6, 0x91, 0x3f, 0x7e,
+	0xfc, 0xe5, 0xd7, 0xb3, 0x7b, 0xf6, 0xf1, 0xff, 0xe3, 0xdb, 0xab, 0x4b,
+	0x96, 0x31, 0x62, 0xc4, 0x95, 0x37, 0x6e, 0xdc, 0xa5, 0x57, 0xae, 0x41,
+	0x82, 0x19, 0x32, 0x64, 0xc8, 0x8d, 0x07, 0x0e, 0x1c, 0x38, 0x70, 0xe0,
+	0xdd, 0xa7, 0x53, 0xa6, 0x51, 0xa2, 0x59, 0xb2, 0x79, 0xf2, 0xf9, 0xef,
+	0xc3, 0x9b, 0x2b, 0x56, 0xac, 0x45, 0x8a, 0x09, 0x12, 0x24, 0x48, 0x90,
+	0x3d, 0x7a, 0xf4, 0xf5, 0xf7, 0xf3, 0xfb, 0xeb, 0xcb, 0x8b, 0x0b, 0x16,
+	0x2c, 0x58, 0xb0, 0x7d, 0xfa, 0xe9, 0xcf, 0x83, 0x1b, 0x36, 0x6c, 0xd8,
+	0xad, 0x47, 0x8e,
+};
+
+/** Discrete logarithms, gf_exp[gf_log[x]] == x for x != 0. */
+static const uint8_t gf_log[256] = {
+	0x00, 0x00, 0x01, 0x19, 0x02, 0x32, 0x1a, 0xc6, 0x03, 0xdf, 0x33, 0xee,
+	0x1b, 0x68, 0xc7, 0x4b, 0x04, 0x64, 0xe0, 0x0e, 0x34, 0x8d, 0xef, 0x81,
+	0x1c, 0xc1, 0x69, 0xf8, 0xc8, 0x08, 0x4c, 0x71, 0x05, 0x8a, 0x65, 0x2f,
+	0xe1, 0x24, 0x0f, 0x21, 0x35, 0x93, 0x8e, 0xda, 0xf0, 0x12, 0x82, 0x45,
+	0x1d, 0xb5, 0xc2, 0x7d, 0x6a, 0x27, 0xf9, 0xb9, 0xc9, 0x9a, 0x09, 0x78,
+	0x4d, 0xe4, 0x72, 0xa6, 0x06, 0xbf, 0x8b, 0x62, 0x66, 0xdd, 0x30, 0xfd,
+	0xe2, 0x98, 0x25, 0xb3, 0x10, 0x91, 0x22, 0x88, 0x36, 0xd0, 0x94, 0xce,
+	0x8f, 0x96, 0xdb, 0xbd, 0xf1, 0xd2, 0x13, 0x5c, 0x83, 0x38, 0x46, 0x40,
+	0x1e, 0x42, 0xb6, 0xa3, 0xc3, 0x48, 0x7e, 0x6e, 0x6b, 0x3a, 0x28, 0x54,
+	0xfa, 0x85, 0xba, 0x3d, 0xca, 0x5e, 0x9b, 0x9f, 0x0a, 0x15, 0x79, 0x2b,
+	0x4e, 0xd4, 0xe5, 0xac, 0x73, 0xf3, 0xa7, 0x57, 0x07, 0x70, 0xc0, 0xf7,
+	0x8c, 0x80, 0x63, 0x0d, 0x67, 0x4a, 0xde, 0xed, 0x31, 0xc5, 0xfe, 0x18,
+	0xe3, 0xa5, 0x99, 0x77, 0x26, 0xb8, 0xb4, 0x7c, 0x11, 0x44, 0x92, 0xd9,
+	0x23, 0x20, 0x89, 0x2e, 0x37, 0x3f, 0xd1, 0x5b, 0x95, 0xbc, 0xcf, 0xcd,
+	0x90, 0x87, 0x97, 0xb2, 0xdc, 0xfc, 0xbe, 0x61, 0xf2, 0x56, 0xd3, 0xab,
+	0x14, 0x2a, 0x5d, 0x9e, 0x84, 0x3c, 0x39, 0x53, 0x47, 0x6d, 0x41, 0xa2,
+	0x1f, 0x2d, 0x43, 0xd8, 0xb7, 0x7b, 0xa4, 0x76, 0xc4, 0x17, 0x49, 0xec,
+	0x7f, 0x0c, 0x6f, 0xf6, 0x6c, 0xa1, 0x3b, 0x52, 0x29, 0x9d, 0x55, 0xaa,
+	0xfb, 0x60, 0x86, 0xb1, 0xbb, 0xcc, 0x3e, 0x5a, 0xcb, 0x59, 0x5f, 0xb0,
+	0x9c, 0xa9, 0xa0, 0x51, 0x0b, 0xf5, 0x16, 0xeb, 0x7a, 0x75, 0x2c, 0xd7,
+	0x4f, 0xae, 0xd5, 0xe9, 0xe6, 0xe7, 0xad, 0xe8, 0x74, 0xd6, 0xf4, 0xea,
+	0xa8, 0x50, 0x58, 0xaf,
+};
+
+M0_INTERNAL uint8_t m0_parity_simd_gf_mul(uint8_t a, uint8_t b)
+{
+	return a == 0 || b == 0 ? 0 :
+		gf_exp[((uint32_t)gf_log[a] + gf_log[b]) % 255];
+}
+
+M0_INTERNAL uint8_t m0_parity_simd_gf_inv(uint8_t a)
+{
+	M0_PRE(a != 0);
+	return gf_exp[(255 - gf_log[a]) % 255];
+}
+
+static void nibble_tables(uint8_t c, uint8_t *lo, uint8_t *hi)
+{
+	uint32_t i;
+
+	for (i = 0; i < 16; ++i) {
+		lo[i] = m0_parity_simd_gf_mul(c, i);
+		hi[i] = m0_parity_simd_gf_mul(c, i << 4);
+	}
+}
+
+static bool word_supported(void)
+{
+	return true;
+}
+
+static void word_xor(uint8_t *dst, const uint8_t *src, m0_bcount_t nob)
+{
+	uint64_t    d;
+	uint64_t    s;
+	m0_bcount_t i;
+
+	/* memcpy() of a word compiles to a single unaligned access. */
+	for (i = 0; i + sizeof d <= nob; i += sizeof d) {
+		memcpy(&d, dst + i, sizeof d);
+		memcpy(&s, src + i, sizeof s);
+		d ^= s;
+		memcpy(dst + i, &d, sizeof d);
+	}
+	for (; i < nob; ++i)
+		dst[i] ^= src[i];
+}
+
+static void word_gf_mac(uint8_t *dst, const uint8_t *src,
+			const uint8_t *lo, const uint8_t *hi, m0_bcount_t nob)
+{
+	m0_bcount_t i;
+
+	for (i = 0; i < nob; ++i)
+		dst[i] ^= lo[src[i] & 0x0f] ^ hi[src[i] >> 4];
+}
+
+#if !defined(__KERNEL__) && defined(__x86_64__)
+
+static bool ssse3_supported(void)
+{
+	return __builtin_cpu_supports("ssse3");
+}
+
+static bool avx2_supported(void)
+{
+	return __builtin_cpu_supports("avx2");
+}
+
+static bool avx512_supported(void)
+{
+	return __builtin_cpu_supports("avx512f") &&
+		__builtin_cpu_supports("avx512bw");
+}
+
+/* SSE2 is a part of x86_64. */
+static void sse2_xor(uint8_t *dst, const uint8_t *src, m0_bcount_t nob)
+{
+	__m128i     d;
+	__m128i     s;
+	m0_bcount_t i;
+
+	for (i = 0; i + sizeof d <= nob; i += sizeof d) {
+		d = _mm_loadu_si128((const __m128i *)(dst + i));
+		s = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(d, s));
+	}
+	word_xor(dst + i, src + i, nob - i);
+}
+
+__attribute__((target("ssse3")))
+static void ssse3_gf_mac(uint8_t *dst, const uint8_t *src,
+			 const uint8_t *lo, const uint8_t *hi, m0_bcount_t nob)
+{
+	__m128i     tlo  = _mm_loadu_si128((const __m128i *)lo);
+	__m128i     thi  = _mm_loadu_si128((const __m128i *)hi);
+	__m128i     mask = _mm_set1_epi8(0x0f);
+	__m128i     x;
+	__m128i     p;
+	m0_bcount_t i;
+
+	for (i = 0; i + sizeof x <= nob; i += sizeof x) {
+		x = _mm_loadu_si128((const __m128i *)(src + i));
+		p = _mm_xor_si128(_mm_shuffle_epi8(tlo, _mm_and_si128(x, mask)),
+				  _mm_shuffle_epi8(thi, _mm_and_si128(
+					  _mm_srli_epi64(x, 4), mask)));
+		p = _mm_xor_si128(p, _mm_loadu_si128((__m128i *)(dst + i)));
+		_mm_storeu_si128((__m128i *)(dst + i), p);
+	}
+	word_gf_mac(dst + i, src + i, lo, hi, nob - i);
+}
+
+__attribute__((target("avx2")))
+static void avx2_xor(uint8_t *dst, const uint8_t *src, m0_bcount_t nob)
+{
+	__m256i     d;
+	__m256i     s;
+	m0_bcount_t i;
+
+	for (i = 0; i + sizeof d <= nob; i += sizeof d) {
+		d = _mm256_loadu_si256((const __m256i *)(dst + i));
+		s = _mm256_loadu_si256((const __m256i *)(src + i));
+		_mm256_storeu_si256((__m256i *)(dst + i),
+				    _mm256_xor_si256(d, s));
+	}
+	sse2_xor(dst + i, src + i, nob - i);
+}
+
+__attribute__((target("avx2")))
+static void avx2_gf_mac(uint8_t *dst, const uint8_t *src,
+			const uint8_t *lo, const uint8_t *hi, m0_bcount_t nob)
+{
+	/* VPSHUFB looks up within 128-bit lanes, replicate the tables. */
+	__m256i     tlo  = _mm256_broadcastsi128_si256(
+				_mm_loadu_si128((const __m128i *)lo));
+	__m256i     thi  = _mm256_broadcastsi128_si256(
+				_mm_loadu_si128((const __m128i *)hi));
+	__m256i     mask = _mm256_set1_epi8(0x0f);
+	__m256i     x;
+	__m256i     p;
+	m0_bcount_t i;
+
+	for (i = 0; i + sizeof x <= nob; i += sizeof x) {
+		x = _mm256_loadu_si256((const __m256i *)(src + i));
+		p = _mm256_xor_si256(
+			_mm256_shuffle_epi8(tlo, _mm256_and_si256(x, mask)),
+			_mm256_shuffle_epi8(thi, _mm256_and_si256(
+				_mm256_srli_epi64(x, 4), mask)));
+		p = _mm256_xor_si256(p, _mm256_loadu_si256(
+					     (const __m256i *)(dst + i)));
+		_mm256_storeu_si256((__m256i *)(dst + i), p);
+	}
+	word_gf_mac(dst + i, src + i, lo, hi, nob - i);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void avx512_xor(uint8_t *dst, const uint8_t *src, m0_bcount_t nob)
+{
+	__m512i     d;
+	__m512i     s;
+	m0_bcount_t i;
+
+	for (i = 0; i + sizeof d <= nob; i += sizeof d) {
+		d = _mm512_loadu_si512((const void *)(dst + i));
+		s = _mm512_loadu_si512((const void *)(src + i));
+		_mm512_storeu_si512((void *)(dst + i), _mm512_xor_si512(d, s));
+	}
+	sse2_xor(dst + i, src + i, nob - i);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void avx512_gf_mac(uint8_t *dst, const uint8_t *src,
+			  const uint8_t *lo, const uint8_t *hi,
+			  m0_bcount_t nob)
+{
+	__m512i     tlo  = _mm512_broadcast_i32x4(
+				_mm_loadu_si128((const __m128i *)lo));
+	__m512i     thi  = _mm512_broadcast_i32x4(
+				_mm_loadu_si128((const __m128i *)hi));
+	__m512i     mask = _mm512_set1_epi8(0x0f);
+	__m512i     x;
+	__m512i     p;
+	m0_bcount_t i;
+
+	for (i = 0; i + sizeof x <= nob; i += sizeof x) {
+		x = _mm512_loadu_si512((const void *)(src + i));
+		p = _mm512_xor_si512(
+			_mm512_shuffle_epi8(tlo, _mm512_and_si512(x, mask)),
+			_mm512_shuffle_epi8(thi, _mm512_and_si512(
+				_mm512_srli_epi64(x, 4), mask)));
+		p = _mm512_xor_si512(p, _mm512_loadu_si512(
+					     (const void *)(dst + i)));
+		_mm512_storeu_si512((void *)(dst + i), p);
+	}
+	word_gf_mac(dst + i, src + i, lo, hi, nob - i);
+}
+
+#elif !defined(__KERNEL__) && defined(__aarch64__)
+
+static bool neon_supported(void)
+{
+	return true;
+}
+
+static void neon_xor(uint8_t *dst, const uint8_t *src, m0_bcount_t nob)
+{
+	m0_bcount_t i;
+
+	for (i = 0; i + 16 <= nob; i += 16)
+		vst1q_u8(dst + i, veorq_u8(vld1q_u8(dst + i),
+					   vld1q_u8(src + i)));
+	word_xor(dst + i, src + i, nob - i);
+}
+
+static void neon_gf_mac(uint8_t *dst, const uint8_t *src,
+			const uint8_t *lo, const uint8_t *hi, m0_bcount_t nob)
+{
+	uint8x16_t  tlo  = vld1q_u8(lo);
+	uint8x16_t  thi  = vld1q_u8(hi);
+	uint8x16_t  mask = vdupq_n_u8(0x0f);
+	uint8x16_t  x;
+	uint8x16_t  p;
+	m0_bcount_t i;
+
+	for (i = 0; i + 16 <= nob; i += 16) {
+		x = vld1q_u8(src + i);
+		p = veorq_u8(vqtbl1q_u8(tlo, vandq_u8(x, mask)),
+			     vqtbl1q_u8(thi, vshrq_n_u8(x, 4)));
+		vst1q_u8(dst + i, veorq_u8(p, vld1q_u8(dst + i)));
+	}
+	word_gf_mac(dst + i, src + i, lo, hi, nob - i);
+}
+
+#endif
+
+/** Kernels in the order of preference. */
+static const struct simd_kernels kernels[] = {
+#if !defined(__KERNEL__) && defined(__x86_64__)
+	{ "avx512", &avx512_supported, &avx512_xor, &avx512_gf_mac },
+	{ "avx2",   &avx2_supported,   &avx2_xor,   &avx2_gf_mac },
+	{ "ssse3",  &ssse3_supported,  &sse2_xor,   &ssse3_gf_mac },
+#elif !defined(__KERNEL__) && defined(__aarch64__)
+	{ "neon",   &neon_supported,   &neon_xor,   &neon_gf_mac },
+#endif
+	{ "word",   &word_supported,   &word_xor,   &word_gf_mac },
+};
+
+/*
+ * Selected lazily on the first use. Concurrent first users select the same
+ * kernels, so the race is harmless.
+ */
+static const struct simd_kernels *simd;
+
+static const struct simd_kernels *simd_get(void)
+{
+	uint32_t i;
+
+	if (simd == NULL) {
+		for (i = 0; !kernels[i].sk_supported(); ++i)
+			;
+		simd = &kernels[i];
+		M0_LOG(M0_INFO, "parity kernels: %s", simd->sk_name);
+	}
+	return simd;
+}
+
+M0_INTERNAL void m0_parity_simd_xor(uint8_t *dst, const uint8_t *src,
+				    m0_bcount_t nob)
+{
+	simd_get()->sk_xor(dst, src, nob);
+}
+
+M0_INTERNAL void m0_parity_simd_gf_mac(uint8_t *dst, const uint8_t *src,
+				       uint8_t c, m0_bcount_t nob)
+{
+	uint8_t lo[16];
+	uint8_t hi[16];
+
+	if (c == 0)
+		return;
+	if (c == 1) {
+		m0_parity_simd_xor(dst, src, nob);
+		return;
+	}
+	nibble_tables(c, lo, hi);
+	simd_get()->sk_gf_mac(dst, src, lo, hi, nob);
+}
+
+M0_INTERNAL const char *m0_parity_simd_name(void)
+{
+	return simd_get()->sk_name;
+}
+
+M0_INTERNAL int m0_parity_simd_select(const char *name)
+{
+	uint32_t i;
+
+	for (i = 0; i < ARRAY_SIZE(kernels); ++i) {
+		if (m0_streq(kernels[i].sk_name, name)) {
+			if (!kernels[i].sk_supported())
+				break;
+			simd = &kernels[i];
+			return 0;
+		}
+	}
+	return M0_ERR(-ENOENT);
+}
+
+/** @} end group parity_simd */
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
@@ -0,0 +1,86 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2012-2021 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __MOTR_SNS_PARITY_SIMD_H__
+#define __MOTR_SNS_PARITY_SIMD_H__
+
+#include "lib/types.h"
+
+/**
+   @defgroup parity_simd Vector kernels of parity math
+   @ingroup parity_math
+
+   XOR and GF(2^8) multiply-accumulate over buffers, independent of ISA-L.
+   GF(2^8) is generated by the polynomial 0x11d, the same as in ISA-L, so
+   results of both can be mixed.
+
+   Multiplication by a constant c is done with two 16-entry tables of
+   products of c with low and high nibbles of the input byte, looked up by
+   byte shuffles: PSHUFB on x86 (SSSE3, AVX2, AVX-512BW) and TBL on aarch64
+   (NEON). x86 kernels are selected at run time according to CPU features,
+   NEON is always present on aarch64. Kernel builds and other architectures
+   use 64-bit word kernels, as vector registers are not available there
+   without saving FPU state.
+
+   @{
+ */
+
+/** dst ^= src. */
+M0_INTERNAL void m0_parity_simd_xor(uint8_t *dst, const uint8_t *src,
+				    m0_bcount_t nob);
+
+/** dst ^= c * src in GF(2^8). */
+M0_INTERNAL void m0_parity_simd_gf_mac(uint8_t *dst, const uint8_t *src,
+				       uint8_t c, m0_bcount_t nob);
+
+/** Product of a and b in GF(2^8). */
+M0_INTERNAL uint8_t m0_parity_simd_gf_mul(uint8_t a, uint8_t b);
+
+/** Inverse of a != 0 in GF(2^8). */
+M0_INTERNAL uint8_t m0_parity_simd_gf_inv(uint8_t a);
+
+/** Name of the kernels in use: "avx512", "avx2", "ssse3", "neon", "word". */
+M0_INTERNAL const char *m0_parity_simd_name(void);
+
+/**
+   Switches to the kernels with the given name, for tests and benchmarks.
+
+   @retval -ENOENT the kernels are not supported by the CPU or the build.
+ */
+M0_INTERNAL int m0_parity_simd_select(const char *name);
+
+/** @} end group parity_simd */
+
+/* __MOTR_SNS_PARITY_SIMD_H__ */
+#endif
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
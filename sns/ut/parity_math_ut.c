@@ -24,10 +24,13 @@
 #include "lib/memory.h"
 #include "lib/errno.h"	     /* EDOM */
 #include "lib/arith.h"	     /* m0_rnd64 */
+#include "lib/misc.h"	     /* ARRAY_SIZE */
+#include "lib/string.h"	     /* m0_streq */
 
 #include "lib/ub.h"
 #include "ut/ut.h"
 #include "sns/parity_math.h"
+#include "sns/parity_simd.h"
 
 #define KB(x)	((x) * 1024)
 #define MB(x)	(KB(x) * 1024)
@@ -45,6 +48,10 @@ enum {
 	PARITY_UNIT_COUNT        = 1,
 	RS_MAX_PARITY_UNIT_COUNT = DATA_UNIT_COUNT - 1,
 	NODES			 = 15,
+	LRC_DATA_UNIT_COUNT	 = 8,
+	LRC_PARITY_UNIT_COUNT	 = 4,
+	LRC_LOCAL_NR		 = 2,
+	LRC_GROUP_SIZE		 = LRC_DATA_UNIT_COUNT / LRC_LOCAL_NR,
 };
 
 enum {
@@ -52,6 +59,13 @@ enum {
 	SEG_SIZE = 64,
 };
 
+enum {
+	/** Length of buffers of test_simd_kernels(). */
+	SIMD_NOB   = 1021,
+	/** Bytes after the largest tested range, checked to stay intact. */
+	SIMD_SLACK = 16,
+};
+
 static uint8_t expected[DATA_UNIT_COUNT_MAX][UNIT_BUFF_SIZE_MAX];
 static uint8_t data    [DATA_UNIT_COUNT_MAX][UNIT_BUFF_SIZE_MAX];
 static uint8_t parity  [DATA_UNIT_COUNT_MAX][UNIT_BUFF_SIZE_MAX];
@@ -62,6 +76,8 @@ static int32_t fuc;
 static uint32_t UNIT_BUFF_SIZE;
 static int32_t fail_index_xor;
 static uint64_t seed;
+/* Pool attached to the m0_sns_ir of incremental recovery tests. */
+static struct m0_sns_ir_pool *ir_pool;
 
 struct mat_collection {
 	struct m0_matrix mc_mat;
@@ -563,6 +579,176 @@ static void test_incr_recov_rs(void)
 	test_invalid_input();
 }
 
+static void test_incr_recov_pool(void)
+{
+	struct m0_sns_ir_pool pool;
+	int                   ret;
+
+	test_init();
+	ret = m0_sns_ir_pool_init(&pool, 3);
+	M0_UT_ASSERT(ret == 0);
+	ir_pool = &pool;
+	test_incr_recov();
+	ir_pool = NULL;
+	m0_sns_ir_pool_fini(&pool);
+}
+
+static void lrc_spoil_recover(struct m0_parity_math *math,
+			      struct m0_buf *data_buf,
+			      struct m0_buf *parity_buf, int exp_rc)
+{
+	struct m0_buf fail_buf;
+	uint32_t      total = LRC_DATA_UNIT_COUNT + LRC_PARITY_UNIT_COUNT;
+	int           ret;
+
+	unit_spoil(UNIT_BUFF_SIZE, total, LRC_DATA_UNIT_COUNT);
+	m0_buf_init(&fail_buf, fail, total);
+	ret = m0_parity_math_recover(math, data_buf, parity_buf, &fail_buf, 0);
+	M0_UT_ASSERT(ret == exp_rc);
+	if (ret == 0)
+		M0_UT_ASSERT(expected_eq(LRC_DATA_UNIT_COUNT, UNIT_BUFF_SIZE));
+	memset(fail, 0, total);
+}
+
+static void test_lrc(void)
+{
+	uint32_t              i;
+	uint32_t              j;
+	uint32_t              total = LRC_DATA_UNIT_COUNT +
+				      LRC_PARITY_UNIT_COUNT;
+	uint8_t               local;
+	struct m0_buf         data_buf[LRC_DATA_UNIT_COUNT];
+	struct m0_buf         parity_buf[LRC_PARITY_UNIT_COUNT];
+	struct m0_bufvec      recov;
+	struct m0_sns_ir      ir;
+	struct m0_parity_math math;
+	int                   ret;
+
+	test_init();
+	ret = m0_parity_math_lrc_init(&math, LRC_DATA_UNIT_COUNT,
+				      LRC_PARITY_UNIT_COUNT, LRC_LOCAL_NR);
+	M0_UT_ASSERT(ret == 0);
+	M0_UT_ASSERT(math.pmi_parity_algo == M0_PARITY_CAL_ALGO_LRC);
+	for (i = 0; i < LRC_DATA_UNIT_COUNT; ++i) {
+		for (j = 0; j < UNIT_BUFF_SIZE; ++j)
+			expected[i][j] = data[i][j] = (uint8_t)m0_rnd64(&seed);
+		m0_buf_init(&data_buf[i], data[i], UNIT_BUFF_SIZE);
+	}
+	for (i = 0; i < LRC_PARITY_UNIT_COUNT; ++i)
+		m0_buf_init(&parity_buf[i], parity[i], UNIT_BUFF_SIZE);
+	m0_parity_math_calculate(&math, data_buf, parity_buf);
+
+	/* Local parities are XORs of their groups. */
+	for (i = 0; i < LRC_LOCAL_NR; ++i) {
+		for (j = 0, local = 0; j < LRC_GROUP_SIZE; ++j)
+			local ^= data[i * LRC_GROUP_SIZE + j][0];
+		M0_UT_ASSERT(parity[i][0] == local);
+	}
+
+	/* Any single and double failure is recoverable. */
+	for (i = 0; i < LRC_DATA_UNIT_COUNT; ++i) {
+		fail[i] = 1;
+		lrc_spoil_recover(&math, data_buf, parity_buf, 0);
+		for (j = i + 1; j < total; ++j) {
+			fail[i] = fail[j] = 1;
+			lrc_spoil_recover(&math, data_buf, parity_buf, 0);
+		}
+	}
+
+	/* A local group cannot lose more units than there are parities. */
+	for (i = 0; i < LRC_GROUP_SIZE; ++i)
+		fail[i] = 1;
+	lrc_spoil_recover(&math, data_buf, parity_buf, -EDOM);
+	for (i = 0; i < LRC_DATA_UNIT_COUNT; ++i)
+		memcpy(data[i], expected[i], UNIT_BUFF_SIZE);
+
+	/* Single failure only depends upon its local group. */
+	ret = m0_bufvec_alloc(&recov, NUM_SEG, SEG_SIZE);
+	M0_UT_ASSERT(ret == 0);
+	ret = m0_sns_ir_init(&math, 0, &ir);
+	M0_UT_ASSERT(ret == 0);
+	ret = m0_sns_ir_failure_register(&recov, 1, &ir);
+	M0_UT_ASSERT(ret == 0);
+	ret = m0_sns_ir_mat_compute(&ir);
+	M0_UT_ASSERT(ret == 0);
+	for (i = 0; i < total; ++i)
+		M0_UT_ASSERT(m0_bitmap_get(&ir.si_blocks[1].sib_bitmap, i) ==
+			     (i != 1 && (i < LRC_GROUP_SIZE ||
+					 i == LRC_DATA_UNIT_COUNT)));
+	m0_sns_ir_fini(&ir);
+	m0_bufvec_free(&recov);
+	m0_parity_math_fini(&math);
+}
+
+static void simd_check(const uint8_t *init, uint32_t off, uint32_t nob,
+		       uint8_t c, bool xor)
+{
+	uint8_t  *src = data[0];
+	uint8_t  *dst = data[1];
+	uint8_t  *ref = expected[0];
+	uint32_t  i;
+
+	memcpy(dst, init, SIMD_NOB + SIMD_SLACK);
+	memcpy(ref, init, SIMD_NOB + SIMD_SLACK);
+	for (i = off; i < off + nob; ++i)
+		ref[i] ^= xor ? src[i] : m0_parity_mul(src[i], c);
+	if (xor)
+		m0_parity_simd_xor(dst + off, src + off, nob);
+	else
+		m0_parity_simd_gf_mac(dst + off, src + off, c, nob);
+	M0_UT_ASSERT(memcmp(dst, ref, SIMD_NOB + SIMD_SLACK) == 0);
+}
+
+static void test_simd_kernels(void)
+{
+	static const char *names[] = { "avx512", "avx2", "ssse3", "neon",
+				       "word" };
+	static const uint32_t nobs[] = { 0, 1, 15, 16, 33, 255, SIMD_NOB };
+	static const uint32_t offs[] = { 0, 1, 7 };
+	static const uint8_t  cs[]   = { 0, 1, 2, 0x1d, 0x8e, 0xff };
+	const char *dflt;
+	uint8_t    *init = parity[0];
+	uint32_t    a;
+	uint32_t    b;
+	uint32_t    n;
+	uint32_t    i;
+	uint32_t    j;
+	uint32_t    k;
+	int         rc;
+
+	test_init();
+	dflt = m0_parity_simd_name();
+	for (i = 0; i < SIMD_NOB + SIMD_SLACK; ++i) {
+		data[0][i] = (uint8_t)m0_rnd64(&seed);
+		init[i]    = (uint8_t)m0_rnd64(&seed);
+	}
+	for (a = 0; a < 256; ++a) {
+		for (b = 0; b < 256; ++b)
+			M0_UT_ASSERT(m0_parity_simd_gf_mul(a, b) ==
+				     m0_parity_mul(a, b));
+		if (a != 0)
+			M0_UT_ASSERT(m0_parity_simd_gf_mul(a,
+				     m0_parity_simd_gf_inv(a)) == 1);
+	}
+	for (n = 0; n < ARRAY_SIZE(names); ++n) {
+		rc = m0_parity_simd_select(names[n]);
+		if (rc == -ENOENT)
+			continue;
+		M0_UT_ASSERT(rc == 0);
+		M0_UT_ASSERT(m0_streq(m0_parity_simd_name(), names[n]));
+		for (i = 0; i < ARRAY_SIZE(nobs); ++i) {
+			for (j = 0; j < ARRAY_SIZE(offs); ++j) {
+				simd_check(init, offs[j], nobs[i], 0, true);
+				for (k = 0; k < ARRAY_SIZE(cs); ++k)
+					simd_check(init, offs[j], nobs[i],
+						   cs[k], false);
+			}
+		}
+	}
+	M0_UT_ASSERT(m0_parity_simd_select("no-such-kernels") == -ENOENT);
+	M0_UT_ASSERT(m0_parity_simd_select(dflt) == 0);
+}
+
 static void test_matrix_inverse(void)
 {
 	uint32_t	      i;
@@ -1031,6 +1217,7 @@ static void sns_ir_nodes_init(struct m0_parity_math *math,
 			node[i].sin_alive_nr = alive_bpn + alive_nr % node_nr;
 		ret = m0_sns_ir_init(math, node[i].sin_alive_nr, &node[i].sin_ir);
 		M0_UT_ASSERT(ret == 0);
+		node[i].sin_ir.si_pool = ir_pool;
 		M0_ALLOC_ARR(node[i].sin_alive, node[i].sin_alive_nr);
 		M0_UT_ASSERT(node[i].sin_alive != NULL);
 		/* Each node has as many accumulator buffers as
@@ -1435,6 +1622,9 @@ static void test_init(void)
 	{ "parity_math_diff_xor", test_parity_math_diff_xor },			\
 	{ "parity_math_diff_rs", test_parity_math_diff_rs },			\
 	{ "incr_recov_rs", test_incr_recov_rs },				\
+	{ "incr_recov_pool", test_incr_recov_pool },				\
+	{ "lrc", test_lrc },							\
+	{ "simd_kernels", test_simd_kernels },					\
 	{ NULL, NULL }
 
 struct m0_ut_suite parity_math_ut = {
@@ -1610,6 +1800,16 @@ static void ub_small_4_2_1M(int iter)
 	parity_math_tb();
 }
 
+static void ub_simd_xor_1M(int iter)
+{
+	m0_parity_simd_xor(data[1], data[0], MB(1));
+}
+
+static void ub_simd_gf_1M(int iter)
+{
+	m0_parity_simd_gf_mac(data[1], data[0], 0x1d, MB(1));
+}
+
 enum { UB_ITER = 100 };
 
 struct m0_ub_set m0_parity_math_ub = {
@@ -1689,6 +1889,18 @@ struct m0_ub_set m0_parity_math_ub = {
 		  .ub_block_size = MB(1),
 		  .ub_blocks_per_op = 6 },
 
+		{ .ub_name  = "simd xor 1M",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_simd_xor_1M,
+		  .ub_block_size = MB(1),
+		  .ub_blocks_per_op = 1 },
+
+		{ .ub_name  = "simd gf  1M",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_simd_gf_1M,
+		  .ub_block_size = MB(1),
+		  .ub_blocks_per_op = 1 },
+
 		{ .ub_name = NULL}
 	}
 };
@@ -902,6 +902,49 @@ int m0_spiel_process_lib_load(struct m0_spiel     *spl,
 }
 M0_EXPORTED(m0_spiel_process_lib_load);
 
+static int spiel_process_knob(struct m0_spiel     *spl,
+			      const struct m0_fid *proc_fid,
+			      const char          *param,
+			      uint64_t            *value)
+{
+	struct m0_ss_process_rep rep = {};
+	const struct m0_buf      buf = M0_BUF_INIT_CONST(strlen(param) + 1,
+						     param);
+	int                      rc;
+
+	rc = spiel_process_command_execute(&spl->spl_core, proc_fid,
+					   M0_PROCESS_KNOB, &buf, &rep);
+	if (rc == 0 && value != NULL)
+		*value = rep.sspr_value;
+	return rc;
+}
+
+int m0_spiel_process_knob_get(struct m0_spiel     *spl,
+			      const struct m0_fid *proc_fid,
+			      const char          *name,
+			      uint64_t            *value)
+{
+	M0_ENTRY("name=%s", name);
+	M0_PRE(value != NULL);
+	return M0_RC(spiel_process_knob(spl, proc_fid, name, value));
+}
+M0_EXPORTED(m0_spiel_process_knob_get);
+
+int m0_spiel_process_knob_set(struct m0_spiel     *spl,
+			      const struct m0_fid *proc_fid,
+			      const char          *name,
+			      uint64_t             value)
+{
+	char param[128];
+
+	M0_ENTRY("name=%s value=%"PRIu64, name, value);
+	if (snprintf(param, sizeof param, "%s=%"PRIu64, name, value) >=
+	    sizeof param)
+		return M0_ERR(-E2BIG);
+	return M0_RC(spiel_process_knob(spl, proc_fid, param, NULL));
+}
+M0_EXPORTED(m0_spiel_process_knob_set);
+
 /****************************************************/
 /*                      Pools                       */
 /****************************************************/
@@ -1001,6 +1044,10 @@ struct _pool_cmd_ctx {
 	struct m0_tl          pl_sdevs_fid;    /**< storage devices fid list */
 	struct m0_tl          pl_services_fid; /**< services fid list */
 	enum m0_repreb_type   pl_service_type; /**< type of service: SNS or DIX */
+	/** Bitmask of enum m0_cm_op_flags sent with the command. */
+	uint32_t              pl_flags;
+	/** Limits sent by CM_OP_*_THROTTLE commands. */
+	const struct m0_spiel_repreb_throttle *pl_throttle;
 };
 
 static int spiel_pool_device_collect(struct _pool_cmd_ctx *ctx,
@@ -1128,8 +1175,9 @@ static int spiel__pool_cmd_send(struct _pool_cmd_ctx *ctx,
 				const enum m0_cm_op   cmd,
 				struct spiel_repreb  *repreb)
 {
-	struct m0_fop *fop;
-	int            rc;
+	struct m0_fop      *fop;
+	struct trigger_fop *treq;
+	int                 rc;
 
 	M0_PRE(repreb != NULL);
 	if (ctx->pl_service_type == M0_REPREB_TYPE_SNS)
@@ -1140,6 +1188,15 @@ static int spiel__pool_cmd_send(struct _pool_cmd_ctx *ctx,
 						 cmd, &fop);
 	if (rc != 0)
 		return M0_ERR(rc);
+	treq = m0_fop_data(fop);
+	treq->flags = ctx->pl_flags;
+	if (ctx->pl_throttle != NULL) {
+		treq->throttle = (struct trigger_throttle) {
+			.tt_bytes_per_sec = ctx->pl_throttle->srt_bytes_per_sec,
+			.tt_iops          = ctx->pl_throttle->srt_iops,
+			.tt_latency       = ctx->pl_throttle->srt_latency
+		};
+	}
 	return M0_RC(spiel_repreb_fop_fill_and_send(ctx->pl_spc, fop, cmd,
 						    repreb));
 }
@@ -1164,6 +1221,14 @@ static int spiel__pool_cmd_status_get(struct _pool_cmd_ctx *ctx,
 	rc = repreb->sr_rc ?: m0_rpc_item_wait_for_reply(item, M0_TIME_NEVER) ?:
 		m0_rpc_item_error(item);
 
+	if (rc == 0 && M0_IN(cmd, (CM_OP_REPAIR_THROTTLE,
+				   CM_OP_REBALANCE_THROTTLE))) {
+		struct trigger_rep_fop *trep;
+
+		trep = m0_fop_data(m0_rpc_item_to_fop(item->ri_reply));
+		rc = trep->rc;
+	}
+
 	if (M0_IN(cmd, (CM_OP_REPAIR_STATUS, CM_OP_REBALANCE_STATUS))) {
 		status->srs_fid = repreb->sr_service->cs_obj.co_id;
 		if (rc == 0) {
@@ -1231,11 +1296,13 @@ leave:
 	return M0_RC(rc);
 }
 
-static int spiel_pool_generic_handler(struct m0_spiel_core           *spc,
-				      const struct m0_fid            *pool_fid,
-				      const enum m0_cm_op             cmd,
-				      struct m0_spiel_repreb_status **statuses,
-				      enum m0_repreb_type             type)
+static int spiel_pool__handler(struct m0_spiel_core                  *spc,
+			       const struct m0_fid                   *pool_fid,
+			       const enum m0_cm_op                    cmd,
+			       uint32_t                               flags,
+			       const struct m0_spiel_repreb_throttle *throttle,
+			       struct m0_spiel_repreb_status        **statuses,
+			       enum m0_repreb_type                    type)
 {
 	int                            rc;
 	int                            service_count;
@@ -1256,6 +1323,8 @@ static int spiel_pool_generic_handler(struct m0_spiel_core           *spc,
 		return M0_ERR(-EINVAL);
 
 	spiel__pool_ctx_init(&ctx, spc, type);
+	ctx.pl_flags    = flags;
+	ctx.pl_throttle = throttle;
 
 	rc = spiel_pool__device_collection_fill(&ctx, pool_fid) ?:
 		SPIEL_CONF_DIR_ITERATE(spc->spc_confc, &ctx,
@@ -1354,6 +1423,16 @@ leave:
 	return M0_RC(rc);
 }
 
+static int spiel_pool_generic_handler(struct m0_spiel_core           *spc,
+				      const struct m0_fid            *pool_fid,
+				      const enum m0_cm_op             cmd,
+				      struct m0_spiel_repreb_status **statuses,
+				      enum m0_repreb_type             type)
+{
+	return spiel_pool__handler(spc, pool_fid, cmd, 0, NULL, statuses,
+				   type);
+}
+
 int m0_spiel_sns_repair_start(struct m0_spiel     *spl,
 			      const struct m0_fid *pool_fid)
 {
@@ -1364,6 +1443,26 @@ int m0_spiel_sns_repair_start(struct m0_spiel     *spl,
 }
 M0_EXPORTED(m0_spiel_sns_repair_start);
 
+int m0_spiel_sns_repair_prio_start(struct m0_spiel     *spl,
+				   const struct m0_fid *pool_fid)
+{
+	M0_ENTRY();
+	return M0_RC(spiel_pool__handler(&spl->spl_core, pool_fid,
+					 CM_OP_REPAIR, CM_OP_FLAG_PRIO, NULL,
+					 NULL, M0_REPREB_TYPE_SNS));
+}
+M0_EXPORTED(m0_spiel_sns_repair_prio_start);
+
+int m0_spiel_sns_repair_direct_start(struct m0_spiel     *spl,
+				     const struct m0_fid *pool_fid)
+{
+	M0_ENTRY();
+	return M0_RC(spiel_pool__handler(&spl->spl_core, pool_fid,
+					 CM_OP_REPAIR, CM_OP_FLAG_DIRECT, NULL,
+					 NULL, M0_REPREB_TYPE_SNS));
+}
+M0_EXPORTED(m0_spiel_sns_repair_direct_start);
+
 int m0_spiel_dix_repair_start(struct m0_spiel     *spl,
 			      const struct m0_fid *pool_fid)
 {
@@ -1648,6 +1747,31 @@ int m0_spiel_dix_rebalance_abort(struct m0_spiel     *spl,
 }
 M0_EXPORTED(m0_spiel_dix_rebalance_abort);
 
+int m0_spiel_sns_repair_throttle(struct m0_spiel     *spl,
+				 const struct m0_fid *pool_fid,
+				 const struct m0_spiel_repreb_throttle *throttle)
+{
+	M0_ENTRY();
+	M0_PRE(throttle != NULL);
+	return M0_RC(spiel_pool__handler(&spl->spl_core, pool_fid,
+					 CM_OP_REPAIR_THROTTLE, 0, throttle,
+					 NULL, M0_REPREB_TYPE_SNS));
+}
+M0_EXPORTED(m0_spiel_sns_repair_throttle);
+
+int m0_spiel_sns_rebalance_throttle(struct m0_spiel     *spl,
+				    const struct m0_fid *pool_fid,
+				    const struct m0_spiel_repreb_throttle
+								*throttle)
+{
+	M0_ENTRY();
+	M0_PRE(throttle != NULL);
+	return M0_RC(spiel_pool__handler(&spl->spl_core, pool_fid,
+					 CM_OP_REBALANCE_THROTTLE, 0,
+					 throttle, NULL, M0_REPREB_TYPE_SNS));
+}
+M0_EXPORTED(m0_spiel_sns_rebalance_throttle);
+
 /** @todo Remove once Halon supports m0_spiel_{sns,dix}_rebalance_abort(). */
 int m0_spiel_pool_rebalance_abort(struct m0_spiel     *spl,
 			          const struct m0_fid *pool_fid)
@@ -170,6 +170,19 @@ struct m0_spiel_repreb_status {
 	unsigned int      srs_progress;
 };
 
+/** Rate limits of SNS repair/rebalance I/O, zeroes mean no limit. */
+struct m0_spiel_repreb_throttle {
+	/* Bytes per second of a storage device */
+	uint64_t  srt_bytes_per_sec;
+	/* I/O operations per second of a storage device */
+	uint64_t  srt_iops;
+	/*
+	 * Target latency of client I/O served by the same service. Rates are
+	 * lowered while client I/O is slower, 0 turns the feedback off.
+	 */
+	m0_time_t srt_latency;
+};
+
 /** @todo Remove once Halon supports successor m0_spiel_repreb_status. */
 struct m0_spiel_sns_status {
 	/* SNS service fid */
@@ -961,6 +974,47 @@ int m0_spiel_process_lib_load(struct m0_spiel     *spl,
 			      const struct m0_fid *proc_fid,
 			      const char          *libname);
 
+/**
+ * Queries a performance parameter of the process.
+ *
+ * Parameters which can be changed without restarting the process:
+ * - "btree.lru_trickle_release", "btree.lru_wm_low", "btree.lru_wm_target",
+ *   "btree.lru_wm_high": btree LRU list purging, see
+ *   m0_btree_lrulist_set_lru_config(). Watermarks must not decrease from
+ *   low to high;
+ * - "be.tx_active_max", "be.group_freeze_timeout_min",
+ *   "be.group_freeze_timeout_max", "be.group_freeze_timeout_limit": BE
+ *   transaction grouping, see m0_be_engine_cfg;
+ * - "rpc.frm_policy", "rpc.frm_hold": rpc formation policy and item hold
+ *   time of the process rpc machines, see m0_rpc_machine::rm_frm_policy.
+ *
+ * Repair and re-balance throttling is changed by
+ * m0_spiel_sns_repair_throttle() and m0_spiel_sns_rebalance_throttle().
+ *
+ * @param spl       spiel instance
+ * @param proc_fid  process fid from configuration DB
+ * @param name      parameter name
+ * @param value     the parameter value is returned here
+ *
+ * @return -ENOENT the process has no such parameter.
+ */
+int m0_spiel_process_knob_get(struct m0_spiel     *spl,
+			      const struct m0_fid *proc_fid,
+			      const char          *name,
+			      uint64_t            *value);
+
+/**
+ * Changes a performance parameter of the process online, see
+ * m0_spiel_process_knob_get() for the list of parameters.
+ *
+ * @return -EINVAL the value is inconsistent with the other parameters, the
+ *         parameter is not changed.
+ */
+int m0_spiel_process_knob_set(struct m0_spiel     *spl,
+			      const struct m0_fid *proc_fid,
+			      const char          *name,
+			      uint64_t             value);
+
 /**
  * Starts pool repair.
  *
@@ -985,6 +1039,36 @@ int m0_spiel_sns_repair_start(struct m0_spiel     *spl,
 int m0_spiel_dix_repair_start(struct m0_spiel     *spl,
 			      const struct m0_fid *pool_fid);
 
+/**
+ * Starts prioritised SNS repair of the pool.
+ *
+ * Same as m0_spiel_sns_repair_start(), but parity groups of every file are
+ * repaired in order of decreasing number of lost units, so that after a
+ * multiple failure the groups closest to data loss regain redundancy first.
+ * Files are still repaired one after another, in fid order.
+ *
+ * @see m0_spiel_sns_repair_start
+ */
+int m0_spiel_sns_repair_prio_start(struct m0_spiel     *spl,
+				   const struct m0_fid *pool_fid);
+
+/**
+ * Starts direct SNS repair of the pool.
+ *
+ * To be used when the failed devices of the pool are already replaced.
+ * Units lost on a failed device are reconstructed in place, on its
+ * replacement, instead of on spare units, so every lost unit is written
+ * once and no rebalance is needed: on completion the devices are to be
+ * transited from M0_PNDS_SNS_REPAIRING directly to M0_PNDS_ONLINE.
+ *
+ * Files which are already repaired are served by the replacement devices
+ * during the repair.
+ *
+ * @see m0_spiel_sns_repair_start
+ */
+int m0_spiel_sns_repair_direct_start(struct m0_spiel     *spl,
+				     const struct m0_fid *pool_fid);
+
 /** @todo Remove once Halon supports m0_spiel_{sns,dix}_repair_start(). */
 int m0_spiel_pool_repair_start(struct m0_spiel     *spl,
 			       const struct m0_fid *pool_fid);
@@ -1246,6 +1330,36 @@ int m0_spiel_sns_rebalance_abort(struct m0_spiel     *spl,
 int m0_spiel_dix_rebalance_abort(struct m0_spiel     *spl,
 				 const struct m0_fid *pool_fid);
 
+/**
+ * Sets rate limits of SNS repair of the pool.
+ *
+ * The command is synchronous, it sends the limits to all the SNS services
+ * of the pool. The limits apply to every storage device of a service
+ * separately, take effect immediately, also for a repair in progress, and
+ * remain in effect until changed.
+ *
+ * @param spl       spiel instance
+ * @param pool_fid  pool fid from configuration DB
+ * @param throttle  new limits
+ *
+ * @return 0 if all services reply with success result code, otherwise an error
+ * code from the first failed service or confc
+ */
+int m0_spiel_sns_repair_throttle(struct m0_spiel     *spl,
+				 const struct m0_fid *pool_fid,
+				 const struct m0_spiel_repreb_throttle
+								*throttle);
+
+/**
+ * Sets rate limits of SNS rebalance of the pool.
+ *
+ * @see m0_spiel_sns_repair_throttle
+ */
+int m0_spiel_sns_rebalance_throttle(struct m0_spiel     *spl,
+				    const struct m0_fid *pool_fid,
+				    const struct m0_spiel_repreb_throttle
+								*throttle);
+
 /** @todo Remove once Halon supports m0_spiel_{sns,dix}_rebalance_abort(). */
 int m0_spiel_pool_rebalance_abort(struct m0_spiel     *spl,
 			          const struct m0_fid *pool_fid);
@@ -53,6 +53,11 @@
  #include "pool/pool_machine.h"     /* m0_pool_machine_state */
  #include "pool/pool.h"             /* m0_pooldev */
  #include "ioservice/storage_dev.h" /* m0_storage_dev_space */
+ #include "btree/btree.h"           /* m0_btree_lrulist_set_lru_config */
+ #include "be/engine.h"             /* m0_be_engine_tunables_set */
+ #include "be/seg.h"                /* m0_be_seg */
+ #include "rpc/rpc_machine.h"       /* m0_rpc_machine_frm_set */
+ #include "rpc/formation2_internal.h" /* M0_RPC_FRM_POLICY_NR */
 #endif
 
 static int ss_process_fom_create(struct m0_fop   *fop,
@@ -75,7 +80,8 @@ enum ss_process_fom_phases {
 	SS_PROCESS_FOM_COUNTER,
 	SS_PROCESS_FOM_QUIESCE,
 	SS_PROCESS_FOM_RUNNING_LIST,
-	SS_PROCESS_FOM_LIB_LOAD
+	SS_PROCESS_FOM_LIB_LOAD,
+	SS_PROCESS_FOM_KNOB
 };
 
 static struct m0_fom_ops ss_process_fom_ops = {
@@ -99,6 +105,7 @@ struct m0_sm_state_descr ss_process_fom_phases[] = {
 				      SS_PROCESS_FOM_QUIESCE,
 				      SS_PROCESS_FOM_RUNNING_LIST,
 				      SS_PROCESS_FOM_LIB_LOAD,
+				      SS_PROCESS_FOM_KNOB,
 				      M0_FOPH_FAILURE),
 	},
 	[SS_PROCESS_FOM_STOP]= {
@@ -137,6 +144,10 @@ struct m0_sm_state_descr ss_process_fom_phases[] = {
 	[SS_PROCESS_FOM_LIB_LOAD]= {
 		.sd_name    = "SS_PROCESS_FOM_LIB_LOAD",
 		.sd_allowed = M0_BITS(M0_FOPH_SUCCESS, M0_FOPH_FAILURE),
+	},
+	[SS_PROCESS_FOM_KNOB]= {
+		.sd_name    = "SS_PROCESS_FOM_KNOB",
+		.sd_allowed = M0_BITS(M0_FOPH_SUCCESS, M0_FOPH_FAILURE),
 	}
 };
 
@@ -235,6 +246,7 @@ static int ss_process_fom_tick__init(struct m0_fom        *fom,
 		[M0_PROCESS_QUIESCE]      = SS_PROCESS_FOM_QUIESCE,
 		[M0_PROCESS_RUNNING_LIST] = SS_PROCESS_FOM_RUNNING_LIST,
 		[M0_PROCESS_LIB_LOAD]     = SS_PROCESS_FOM_LIB_LOAD,
+		[M0_PROCESS_KNOB]         = SS_PROCESS_FOM_KNOB,
 	};
 	int cmd;
 
@@ -651,6 +663,206 @@ static int ss_process_lib_load(struct m0_fom *fom)
 #endif
 }
 
+#if !defined(__KERNEL__)
+/**
+ * A process parameter, which can be queried and changed by M0_PROCESS_KNOB
+ * without restarting the process. spk_arg selects the parameter among the
+ * ones sharing the get and set functions.
+ */
+struct ss_process_knob {
+	const char *spk_name;
+	int       (*spk_get)(struct m0_reqh *reqh, size_t arg, uint64_t *val);
+	int       (*spk_set)(struct m0_reqh *reqh, size_t arg, uint64_t val);
+	size_t      spk_arg;
+};
+
+enum {
+	SS_KNOB_LRU_TRICKLE,
+	SS_KNOB_LRU_WM_LOW,
+	SS_KNOB_LRU_WM_TARGET,
+	SS_KNOB_LRU_WM_HIGH,
+	SS_KNOB_LRU_NR
+};
+
+static void ss_knob_lru_get(int64_t *v)
+{
+	m0_btree_lrulist_get_lru_config(&v[SS_KNOB_LRU_TRICKLE],
+					&v[SS_KNOB_LRU_WM_LOW],
+					&v[SS_KNOB_LRU_WM_TARGET],
+					&v[SS_KNOB_LRU_WM_HIGH]);
+}
+
+static int ss_knob_lru_read(struct m0_reqh *reqh, size_t arg, uint64_t *val)
+{
+	int64_t v[SS_KNOB_LRU_NR];
+
+	ss_knob_lru_get(v);
+	*val = v[arg];
+	return 0;
+}
+
+static int ss_knob_lru_write(struct m0_reqh *reqh, size_t arg, uint64_t val)
+{
+	int64_t v[SS_KNOB_LRU_NR];
+
+	/* 0 stands for the default in m0_btree_lrulist_set_lru_config(). */
+	if (arg != SS_KNOB_LRU_TRICKLE && (val == 0 || val > INT64_MAX))
+		return M0_ERR(-EINVAL);
+	ss_knob_lru_get(v);
+	v[arg] = val;
+	if (v[SS_KNOB_LRU_WM_LOW] > v[SS_KNOB_LRU_WM_TARGET] ||
+	    v[SS_KNOB_LRU_WM_TARGET] > v[SS_KNOB_LRU_WM_HIGH])
+		return M0_ERR_INFO(-EINVAL, "Watermarks must not decrease: "
+				   "%"PRIi64" %"PRIi64" %"PRIi64,
+				   v[SS_KNOB_LRU_WM_LOW],
+				   v[SS_KNOB_LRU_WM_TARGET],
+				   v[SS_KNOB_LRU_WM_HIGH]);
+	m0_btree_lrulist_set_lru_config(v[SS_KNOB_LRU_TRICKLE],
+					v[SS_KNOB_LRU_WM_LOW],
+					v[SS_KNOB_LRU_WM_TARGET],
+					v[SS_KNOB_LRU_WM_HIGH]);
+	return 0;
+}
+
+static struct m0_be_engine *ss_knob_engine(struct m0_reqh *reqh)
+{
+	return reqh->rh_beseg == NULL ? NULL :
+		&reqh->rh_beseg->bs_domain->bd_engine;
+}
+
+static int ss_knob_be_read(struct m0_reqh *reqh, size_t arg, uint64_t *val)
+{
+	struct m0_be_engine          *en = ss_knob_engine(reqh);
+	struct m0_be_engine_tunables  t;
+
+	if (en == NULL)
+		return M0_ERR(-ENOENT);
+	m0_be_engine_tunables_get(en, &t);
+	*val = *(uint64_t *)((char *)&t + arg);
+	return 0;
+}
+
+static int ss_knob_be_write(struct m0_reqh *reqh, size_t arg, uint64_t val)
+{
+	struct m0_be_engine          *en = ss_knob_engine(reqh);
+	struct m0_be_engine_tunables  t;
+
+	if (en == NULL)
+		return M0_ERR(-ENOENT);
+	m0_be_engine_tunables_get(en, &t);
+	*(uint64_t *)((char *)&t + arg) = val;
+	return m0_be_engine_tunables_set(en, &t);
+}
+
+static struct m0_rpc_machine *ss_knob_rpc_machine(struct m0_reqh *reqh)
+{
+	return m0_reqh_rpc_mach_tlist_head(&reqh->rh_rpc_machines);
+}
+
+static int ss_knob_frm_read(struct m0_reqh *reqh, size_t arg, uint64_t *val)
+{
+	struct m0_rpc_machine *mach = ss_knob_rpc_machine(reqh);
+
+	if (mach == NULL)
+		return M0_ERR(-ENOENT);
+	*val = arg == 0 ? mach->rm_frm_policy : mach->rm_frm_hold;
+	return 0;
+}
+
+static int ss_knob_frm_write(struct m0_reqh *reqh, size_t arg, uint64_t val)
+{
+	struct m0_rpc_machine *mach;
+
+	if (ss_knob_rpc_machine(reqh) == NULL)
+		return M0_ERR(-ENOENT);
+	if (arg == 0 && val >= M0_RPC_FRM_POLICY_NR)
+		return M0_ERR(-EINVAL);
+	m0_tl_for(m0_reqh_rpc_mach, &reqh->rh_rpc_machines, mach) {
+		m0_rpc_machine_frm_set(mach,
+				       arg == 0 ? val : mach->rm_frm_policy,
+				       arg == 0 ? mach->rm_frm_hold : val);
+	} m0_tl_endfor;
+	return 0;
+}
+
+#define SS_KNOB_BE(name, field)						\
+	{ "be." name, &ss_knob_be_read, &ss_knob_be_write,		\
+	  offsetof(struct m0_be_engine_tunables, field) }
+
+static const struct ss_process_knob ss_process_knobs[] = {
+	{ "btree.lru_trickle_release", &ss_knob_lru_read, &ss_knob_lru_write,
+	  SS_KNOB_LRU_TRICKLE },
+	{ "btree.lru_wm_low", &ss_knob_lru_read, &ss_knob_lru_write,
+	  SS_KNOB_LRU_WM_LOW },
+	{ "btree.lru_wm_target", &ss_knob_lru_read, &ss_knob_lru_write,
+	  SS_KNOB_LRU_WM_TARGET },
+	{ "btree.lru_wm_high", &ss_knob_lru_read, &ss_knob_lru_write,
+	  SS_KNOB_LRU_WM_HIGH },
+	SS_KNOB_BE("tx_active_max", bet_tx_active_max),
+	SS_KNOB_BE("group_freeze_timeout_min", bet_group_freeze_timeout_min),
+	SS_KNOB_BE("group_freeze_timeout_max", bet_group_freeze_timeout_max),
+	SS_KNOB_BE("group_freeze_timeout_limit",
+		   bet_group_freeze_timeout_limit),
+	{ "rpc.frm_policy", &ss_knob_frm_read, &ss_knob_frm_write, 0 },
+	{ "rpc.frm_hold", &ss_knob_frm_read, &ss_knob_frm_write, 1 },
+};
+
+#undef SS_KNOB_BE
+#endif
+
+/**
+ * Queries or changes a process parameter, see ss_process_knobs[].
+ *
+ * The parameter is "name" or "name=value", value is decimal or, with 0x
+ * prefix, hexadecimal. The current (new) value is returned in the reply.
+ */
+static int ss_process_knob(struct m0_fom *fom)
+{
+#if !defined(__KERNEL__)
+	struct m0_ss_process_req     *req  = m0_ss_fop_process_req(fom->fo_fop);
+	struct m0_ss_process_rep     *rep  = m0_fop_data(fom->fo_rep_fop);
+	struct m0_reqh               *reqh = m0_fom_reqh(fom);
+	const struct ss_process_knob *knob;
+	char                         *name = req->ssp_param.b_addr;
+	char                         *value;
+	char                         *end;
+	uint64_t                      val;
+	size_t                        i;
+	int                           rc;
+
+	M0_ENTRY();
+	if (req->ssp_param.b_nob == 0)
+		return M0_ERR(-EPROTO);
+	/* Space-terminated strings are allowed, see ss_process_lib_load(). */
+	if (name[req->ssp_param.b_nob - 1] == ' ')
+		name[req->ssp_param.b_nob - 1] = 0;
+	if (name[req->ssp_param.b_nob - 1] != 0)
+		return M0_ERR(-EPROTO);
+	value = strchr(name, '=');
+	if (value != NULL)
+		*value++ = 0;
+	for (i = 0; i < ARRAY_SIZE(ss_process_knobs); ++i) {
+		if (strcmp(ss_process_knobs[i].spk_name, name) == 0)
+			break;
+	}
+	if (i == ARRAY_SIZE(ss_process_knobs))
+		return M0_ERR_INFO(-ENOENT, "knob: %s", name);
+	knob = &ss_process_knobs[i];
+	if (value != NULL) {
+		val = m0_strtou64(value, &end, 0);
+		if (*value == 0 || *end != 0)
+			return M0_ERR_INFO(-EINVAL, "%s: %s", name, value);
+		rc = knob->spk_set(reqh, knob->spk_arg, val);
+		if (rc != 0)
+			return M0_ERR(rc);
+		M0_LOG(M0_NOTICE, "%s set to %"PRIu64, name, val);
+	}
+	return M0_RC(knob->spk_get(reqh, knob->spk_arg, &rep->sspr_value));
+#else
+	return M0_ERR(-ENOSYS);
+#endif
+}
+
 static int ss_process_fom_tail(struct m0_fom *fom, int rc)
 {
 	/*
@@ -732,6 +944,8 @@ static int ss_process_fom_tick(struct m0_fom *fom)
 								reqh));
 	case SS_PROCESS_FOM_LIB_LOAD:
 		return ss_process_fom_tail(fom, ss_process_lib_load(fom));
+	case SS_PROCESS_FOM_KNOB:
+		return ss_process_fom_tail(fom, ss_process_knob(fom));
 	default:
 		M0_IMPOSSIBLE("Invalid phase");
 	}
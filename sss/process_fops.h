@@ -53,6 +53,7 @@ enum m0_ss_process_req_cmd {
 	M0_PROCESS_QUIESCE,
 	M0_PROCESS_RUNNING_LIST,
 	M0_PROCESS_LIB_LOAD,
+	M0_PROCESS_KNOB,
 	M0_PROCESS_NR
 };
 
@@ -71,8 +72,9 @@ struct m0_ss_process_req {
 	/**
 	 * Additional parameter.
 	 *
-	 * Currently used only by M0_PROCESS_LIB_LOAD to pass the name of the
-	 * library.
+	 * Used by M0_PROCESS_LIB_LOAD to pass the name of the library and by
+	 * M0_PROCESS_KNOB to pass "name" (query) or "name=value" (change) of a
+	 * process parameter.
 	 */
 	struct m0_buf ssp_param;
 } M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
@@ -131,6 +133,11 @@ struct m0_ss_process_rep {
 	 * Number of key values in key and record buffers
 	 */
 	uint32_t      sspr_kv_count;
+	/**
+	 * Value of the process parameter, after the change if any. Valid for
+	 * M0_PROCESS_KNOB only.
+	 */
+	uint64_t      sspr_value;
 } M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
 
 struct m0_ss_process_svc_item {
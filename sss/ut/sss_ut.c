@@ -330,6 +330,47 @@ static void sss_process_svc_list_test(void)
 	m0_fop_put_lock(fop);
 }
 
+static uint64_t ut_sss_process_knob(const char *param, int rc_exptd)
+{
+	struct m0_fop            *fop;
+	struct m0_ss_process_rep *rep;
+	uint64_t                  value;
+	int                       rc;
+
+	fop = ut_sss_process_create_req(M0_PROCESS_KNOB);
+	ut_sss_process_param_set(fop, param);
+	rc = m0_rpc_post_sync(fop, &cctx.rcx_session, NULL, 0);
+	M0_UT_ASSERT(rc == 0);
+	rep = m0_fop_data(m0_rpc_item_to_fop(fop->f_item.ri_reply));
+	M0_UT_ASSERT(rep->sspr_rc == rc_exptd);
+	value = rep->sspr_value;
+	ut_sss_process_param_set(fop, NULL);
+	m0_fop_put_lock(fop);
+	return value;
+}
+
+static void sss_process_knob_test(void)
+{
+	uint64_t low;
+	uint64_t high;
+	char     param[64];
+
+	low  = ut_sss_process_knob("btree.lru_wm_low", 0);
+	high = ut_sss_process_knob("btree.lru_wm_high", 0);
+	M0_UT_ASSERT(low <= high);
+	/* Watermarks must not decrease. */
+	sprintf(param, "btree.lru_wm_low=%"PRIu64, high + 1);
+	ut_sss_process_knob(param, -EINVAL);
+	M0_UT_ASSERT(ut_sss_process_knob("btree.lru_wm_low", 0) == low);
+	sprintf(param, "btree.lru_wm_low=%"PRIu64, low / 2);
+	M0_UT_ASSERT(ut_sss_process_knob(param, 0) == low / 2);
+	sprintf(param, "btree.lru_wm_low=%"PRIu64, low);
+	M0_UT_ASSERT(ut_sss_process_knob(param, 0) == low);
+	ut_sss_process_knob("btree.lru_wm_low=12apples", -EINVAL);
+	ut_sss_process_knob("no.such.knob", -ENOENT);
+	ut_sss_process_knob("rpc.frm_policy=1000", -EINVAL);
+}
+
 static void sss_process_lib_load_noent_test(void)
 {
 	struct m0_fop *fop;
@@ -483,6 +524,7 @@ struct m0_ut_suite sss_ut = {
 		{ "lib-load-noent", sss_process_lib_load_noent_test },
 		{ "lib-load-libc", sss_process_lib_load_libc_test },
 		{ "lib-testlib", sss_process_lib_load_testlib_test },
+		{ "process-knob", sss_process_knob_test },
 		{ NULL, NULL },
 	},
 };
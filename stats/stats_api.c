@@ -28,6 +28,7 @@
 #include "rpc/rpclib.h"
 #include "stats/stats_fops.h"
 #include "stats/stats_fops_xc.h"
+#include "stats/stats_api.h"
 
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_STATS
 #include "lib/trace.h"
@@ -81,7 +82,7 @@ error:
 	return NULL;
 }
 
-static struct m0_fop *query_fop_alloc(void)
+static struct m0_fop *query_fop_alloc(const struct m0_uint64_seq *stats_ids)
 {
 	struct m0_fop             *fop;
 	struct m0_stats_query_fop *qfop;
@@ -94,10 +95,19 @@ static struct m0_fop *query_fop_alloc(void)
 	if (qfop == NULL)
 		goto free_fop;
 
+	M0_ALLOC_ARR(qfop->sqf_ids.se_data, stats_ids->se_nr);
+	if (qfop->sqf_ids.se_data == NULL)
+		goto free_qfop;
+	qfop->sqf_ids.se_nr = stats_ids->se_nr;
+	memcpy(qfop->sqf_ids.se_data, stats_ids->se_data,
+	       stats_ids->se_nr * sizeof stats_ids->se_data[0]);
+
 	m0_fop_init(fop, &m0_fop_stats_query_fopt, (void *)qfop,
 		    m0_stats_query_fop_release);
 
 	return fop;
+free_qfop:
+	m0_free(qfop);
 free_fop:
 	m0_free(fop);
 error:
@@ -105,6 +115,7 @@ error:
 }
 
 int m0_stats_query(struct m0_rpc_session     *session,
+		   struct m0_uint64_seq      *stats_ids,
 		   struct m0_stats_recs     **stats)
 {
 	int                            rc;
@@ -114,9 +125,10 @@ int m0_stats_query(struct m0_rpc_session     *session,
 	struct m0_stats_query_rep_fop *qrfop;
 
 	M0_PRE(session != NULL);
+	M0_PRE(stats_ids != NULL && stats_ids->se_nr > 0);
 	M0_PRE(stats != NULL);
 
-	fop = query_fop_alloc();
+	fop = query_fop_alloc(stats_ids);
 	if (fop == NULL)
 		return M0_ERR(-ENOMEM);
 
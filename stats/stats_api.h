@@ -32,6 +32,10 @@
  *   m0_stats_query
  *   m0_stats_free
  *
+ * Histogram stats (m0_stats_is_hist()) aggregated by the stats service are
+ * turned into percentile summaries with m0_stats_hist_decode() and
+ * m0_stats_hist_summary(), see stats/stats_hist.h.
+ *
  * @{
  */
 struct m0_uint64_seq;
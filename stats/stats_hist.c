@@ -0,0 +1,240 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2013-2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_STATS
+#include "lib/trace.h"
+#include "lib/errno.h"
+#include "lib/arith.h"                 /* m0_log2, m0_clip64u */
+#include "lib/memory.h"
+#include "lib/misc.h"                  /* M0_SET0 */
+#include "stats/stats_fops.h"          /* m0_stats_sum */
+#include "stats/stats_hist.h"
+
+/**
+ * @addtogroup stats_hist
+ *
+ * @{
+ */
+
+M0_INTERNAL bool m0_stats_is_hist(uint64_t id)
+{
+	return id >= M0_STATS_HIST_ID_BASE && id < M0_STATS_HIST_ID_END;
+}
+
+M0_INTERNAL void m0_stats_hist_init(struct m0_stats_hist *h)
+{
+	M0_SET0(h);
+	h->sh_min = UINT64_MAX;
+}
+
+static unsigned hist_idx(uint64_t val)
+{
+	unsigned msb;
+	unsigned idx;
+
+	if (val < M0_BITS(M0_STATS_HIST_SUB_SHIFT))
+		return val;
+	msb = m0_log2(val);
+	idx = (msb - M0_STATS_HIST_SUB_SHIFT + 1) << M0_STATS_HIST_SUB_SHIFT;
+	idx += (val >> (msb - M0_STATS_HIST_SUB_SHIFT)) &
+		(M0_BITS(M0_STATS_HIST_SUB_SHIFT) - 1);
+	return min_check(idx, (unsigned)M0_STATS_HIST_BUCKETS - 1);
+}
+
+/** Returns the largest value counted by the bucket. */
+static uint64_t hist_bucket_top(unsigned idx)
+{
+	unsigned msb;
+	unsigned sub;
+
+	if (idx < M0_BITS(M0_STATS_HIST_SUB_SHIFT))
+		return idx;
+	msb = (idx >> M0_STATS_HIST_SUB_SHIFT) + M0_STATS_HIST_SUB_SHIFT - 1;
+	sub = idx & (M0_BITS(M0_STATS_HIST_SUB_SHIFT) - 1);
+	return ((M0_BITS(M0_STATS_HIST_SUB_SHIFT) + sub + 1ULL) <<
+		(msb - M0_STATS_HIST_SUB_SHIFT)) - 1;
+}
+
+M0_INTERNAL void m0_stats_hist_add(struct m0_stats_hist *h, uint64_t val)
+{
+	h->sh_bucket[hist_idx(val)]++;
+	h->sh_nr++;
+	h->sh_sum += val;
+	h->sh_min = min64u(h->sh_min, val);
+	h->sh_max = max64u(h->sh_max, val);
+}
+
+M0_INTERNAL void m0_stats_hist_merge(struct m0_stats_hist *dst,
+				     const struct m0_stats_hist *src)
+{
+	int i;
+
+	for (i = 0; i < M0_STATS_HIST_BUCKETS; ++i)
+		dst->sh_bucket[i] += src->sh_bucket[i];
+	dst->sh_nr += src->sh_nr;
+	dst->sh_sum += src->sh_sum;
+	dst->sh_min = min64u(dst->sh_min, src->sh_min);
+	dst->sh_max = max64u(dst->sh_max, src->sh_max);
+}
+
+M0_INTERNAL uint64_t m0_stats_hist_quantile(const struct m0_stats_hist *h,
+					    uint32_t permille)
+{
+	uint64_t rank;
+	uint64_t seen = 0;
+	unsigned i;
+
+	M0_PRE(permille <= 1000);
+
+	if (h->sh_nr == 0)
+		return 0;
+	rank = max64u((h->sh_nr * permille + 999) / 1000, 1);
+	for (i = 0; i < M0_STATS_HIST_BUCKETS; ++i) {
+		seen += h->sh_bucket[i];
+		if (seen >= rank && i < M0_STATS_HIST_BUCKETS - 1)
+			return m0_clip64u(h->sh_min, h->sh_max,
+					  hist_bucket_top(i));
+	}
+	return h->sh_max;
+}
+
+M0_INTERNAL void m0_stats_hist_summary(const struct m0_stats_hist *h,
+				       struct m0_stats_hist_summary *s)
+{
+	*s = (struct m0_stats_hist_summary) {
+		.shs_nr   = h->sh_nr,
+		.shs_min  = h->sh_nr != 0 ? h->sh_min : 0,
+		.shs_max  = h->sh_max,
+		.shs_mean = h->sh_nr != 0 ? h->sh_sum / h->sh_nr : 0,
+		.shs_p50  = m0_stats_hist_quantile(h, 500),
+		.shs_p90  = m0_stats_hist_quantile(h, 900),
+		.shs_p99  = m0_stats_hist_quantile(h, 990),
+		.shs_p999 = m0_stats_hist_quantile(h, 999)
+	};
+}
+
+M0_INTERNAL int m0_stats_hist_encode(const struct m0_stats_hist *h,
+				     uint32_t id, struct m0_stats_sum *sum)
+{
+	uint64_t *data;
+	uint32_t  nr = M0_STATS_HIST_HDR_NR;
+	int       i;
+
+	M0_PRE(m0_stats_is_hist(id));
+
+	for (i = 0; i < M0_STATS_HIST_BUCKETS; ++i)
+		nr += h->sh_bucket[i] != 0 ? 2 : 0;
+	M0_ALLOC_ARR(data, nr);
+	if (data == NULL)
+		return M0_ERR(-ENOMEM);
+	sum->ss_id = id;
+	sum->ss_data.se_nr = nr;
+	sum->ss_data.se_data = data;
+	*data++ = M0_STATS_HIST_FORMAT;
+	*data++ = h->sh_nr;
+	*data++ = h->sh_sum;
+	*data++ = h->sh_min;
+	*data++ = h->sh_max;
+	for (i = 0; i < M0_STATS_HIST_BUCKETS; ++i) {
+		if (h->sh_bucket[i] != 0) {
+			*data++ = i;
+			*data++ = h->sh_bucket[i];
+		}
+	}
+	return 0;
+}
+
+/** Adds the values of an encoded histogram to "h". */
+static int hist_sum_add(struct m0_stats_hist *h,
+			const struct m0_stats_sum *sum)
+{
+	const uint64_t *data = sum->ss_data.se_data;
+	uint32_t        nr   = sum->ss_data.se_nr;
+	uint32_t        i;
+
+	if (!m0_stats_is_hist(sum->ss_id) || nr < M0_STATS_HIST_HDR_NR ||
+	    (nr - M0_STATS_HIST_HDR_NR) % 2 != 0 ||
+	    data[0] != M0_STATS_HIST_FORMAT)
+		return M0_ERR_INFO(-EPROTO, "Malformed histogram: %"PRIu32
+				   " %"PRIu32, sum->ss_id, nr);
+	for (i = M0_STATS_HIST_HDR_NR; i < nr; i += 2) {
+		if (data[i] >= M0_STATS_HIST_BUCKETS)
+			return M0_ERR_INFO(-EPROTO, "Wrong bucket: %"PRIu64,
+					   data[i]);
+	}
+	for (i = M0_STATS_HIST_HDR_NR; i < nr; i += 2)
+		h->sh_bucket[data[i]] += data[i + 1];
+	h->sh_nr += data[1];
+	h->sh_sum += data[2];
+	if (data[1] != 0) {
+		h->sh_min = min64u(h->sh_min, data[3]);
+		h->sh_max = max64u(h->sh_max, data[4]);
+	}
+	return 0;
+}
+
+M0_INTERNAL int m0_stats_hist_decode(const struct m0_stats_sum *sum,
+				     struct m0_stats_hist *h)
+{
+	m0_stats_hist_init(h);
+	return hist_sum_add(h, sum);
+}
+
+M0_INTERNAL int m0_stats_hist_sum_merge(struct m0_stats_sum *dst,
+					const struct m0_stats_sum *src)
+{
+	struct m0_stats_hist *h;
+	struct m0_stats_sum   merged;
+	int                   rc;
+
+	M0_PRE(dst->ss_id == src->ss_id);
+
+	M0_ALLOC_PTR(h);
+	if (h == NULL)
+		return M0_ERR(-ENOMEM);
+	rc = m0_stats_hist_decode(dst, h) ?:
+		hist_sum_add(h, src) ?:
+		m0_stats_hist_encode(h, dst->ss_id, &merged);
+	if (rc == 0) {
+		m0_free(dst->ss_data.se_data);
+		*dst = merged;
+	}
+	m0_free(h);
+	return M0_RC(rc);
+}
+
+/** @} end group stats_hist */
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
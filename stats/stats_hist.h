@@ -0,0 +1,177 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2013-2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __MOTR_STATS_STATS_HIST_H__
+#define __MOTR_STATS_STATS_HIST_H__
+
+/**
+ * @defgroup stats_hist Mergeable stats histograms
+ *
+ * Log-linear histogram of 64-bit values (typically latencies in nanoseconds)
+ * that can be shipped to the stats service in a m0_stats_sum and merged
+ * there.
+ *
+ * Values below 8 have a bucket each, bucket i >= 8 counts values with the
+ * most significant bit at position i / 8 + 2 and the following three bits
+ * equal to i % 8, so the width of a bucket is below 12.5% of its values. The
+ * layout does not depend on the data, hence two histograms are merged by
+ * adding their buckets, which makes the result the same as if all values were
+ * added to a single histogram.
+ *
+ * A histogram is carried in a m0_stats_sum with an identifier from
+ * [M0_STATS_HIST_ID_BASE, M0_STATS_HIST_ID_END), see m0_stats_is_hist().
+ * The stats service merges update of such a stats into the stored one instead
+ * of overwriting it, so that every node can send its histogram of the same
+ * identifier and queries (m0_stats_query()) return the cluster-wide
+ * distribution. The encoding (m0_uint64_seq of the summary) is:
+ *
+ *     - M0_STATS_HIST_FORMAT;
+ *     - number of values, their sum, minimum and maximum;
+ *     - (bucket index, bucket count) pairs of non-empty buckets, in increasing
+ *       bucket order.
+ *
+ * @{
+ */
+
+#include "lib/types.h"
+
+struct m0_stats_sum;
+
+enum {
+	/** log2 of the number of linear sub-buckets per power of two. */
+	M0_STATS_HIST_SUB_SHIFT = 3,
+	/** Values of 2^(M0_STATS_HIST_MAX_SHIFT + 2) and more share the last
+	    bucket. */
+	M0_STATS_HIST_MAX_SHIFT = 48,
+	M0_STATS_HIST_BUCKETS   = M0_STATS_HIST_MAX_SHIFT <<
+				  M0_STATS_HIST_SUB_SHIFT,
+	/** Version of the encoding, the first word of an encoded histogram. */
+	M0_STATS_HIST_FORMAT    = 0x4853000100000000ULL |
+				  M0_STATS_HIST_SUB_SHIFT,
+	/** Number of words of an encoded histogram before the buckets. */
+	M0_STATS_HIST_HDR_NR    = 5
+};
+
+/**
+ * Identifiers of histogram stats.
+ */
+enum m0_stats_hist_id {
+	M0_STATS_HIST_ID_BASE   = 0x48530000,
+	/** Latency of client reads and writes. */
+	M0_STATS_HIST_IO_READ   = M0_STATS_HIST_ID_BASE,
+	M0_STATS_HIST_IO_WRITE,
+	/** Latency of cas requests. */
+	M0_STATS_HIST_CAS,
+	/** Latency of rpc request-reply round-trips. */
+	M0_STATS_HIST_RPC,
+	/** Identifiers of other histograms are allocated from here. */
+	M0_STATS_HIST_ID_USER,
+	M0_STATS_HIST_ID_END    = M0_STATS_HIST_ID_BASE + 0x10000
+};
+
+struct m0_stats_hist {
+	uint64_t sh_nr;
+	uint64_t sh_sum;
+	uint64_t sh_min;
+	uint64_t sh_max;
+	uint64_t sh_bucket[M0_STATS_HIST_BUCKETS];
+};
+
+/**
+ * Summary of a histogram. Quantiles are upper estimates, see
+ * m0_stats_hist_quantile().
+ */
+struct m0_stats_hist_summary {
+	uint64_t shs_nr;
+	uint64_t shs_min;
+	uint64_t shs_max;
+	uint64_t shs_mean;
+	uint64_t shs_p50;
+	uint64_t shs_p90;
+	uint64_t shs_p99;
+	uint64_t shs_p999;
+};
+
+/** True iff the stats with this identifier is a histogram. */
+M0_INTERNAL bool m0_stats_is_hist(uint64_t id);
+
+M0_INTERNAL void m0_stats_hist_init(struct m0_stats_hist *h);
+
+/** Adds a value to the histogram. */
+M0_INTERNAL void m0_stats_hist_add(struct m0_stats_hist *h, uint64_t val);
+
+/** Adds all values of "src" to "dst". */
+M0_INTERNAL void m0_stats_hist_merge(struct m0_stats_hist *dst,
+				     const struct m0_stats_hist *src);
+
+/**
+ * Returns an upper estimate of the quantile: permille of the values of the
+ * histogram are not larger. Returns 0 for an empty histogram.
+ */
+M0_INTERNAL uint64_t m0_stats_hist_quantile(const struct m0_stats_hist *h,
+					    uint32_t permille);
+
+M0_INTERNAL void m0_stats_hist_summary(const struct m0_stats_hist *h,
+				       struct m0_stats_hist_summary *s);
+
+/**
+ * Encodes the histogram into a stats summary with the given identifier.
+ * Summary data are allocated here and must be freed by the caller.
+ *
+ * @pre m0_stats_is_hist(id)
+ */
+M0_INTERNAL int m0_stats_hist_encode(const struct m0_stats_hist *h,
+				     uint32_t id, struct m0_stats_sum *sum);
+
+/**
+ * Decodes a histogram from a stats summary, e.g., returned by
+ * m0_stats_query().
+ *
+ * @retval -EPROTO the summary is not a valid encoded histogram.
+ */
+M0_INTERNAL int m0_stats_hist_decode(const struct m0_stats_sum *sum,
+				     struct m0_stats_hist *h);
+
+/**
+ * Merges encoded histogram "src" into encoded histogram "dst", data of "dst"
+ * are re-allocated. Used by the stats service to aggregate updates.
+ */
+M0_INTERNAL int m0_stats_hist_sum_merge(struct m0_stats_sum *dst,
+					const struct m0_stats_sum *src);
+
+/** @} end group stats_hist */
+#endif /* __MOTR_STATS_STATS_HIST_H__ */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
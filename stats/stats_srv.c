@@ -73,7 +73,8 @@
    @subsection DLD-stats-svc-lspecs-stats_list Stats Object List
    In memory stats object list does not contain any object initially. Stats
    FOM update respective stats object. object is created if not found in
-   stats list.
+   stats list. An update of an existing histogram stats (m0_stats_is_hist())
+   is merged into the object instead of replacing it, see stats/stats_hist.h.
 
    @subsection DLD-stats-svc-lspec-state State Transitions
    State diagram for stats_update FOM:
@@ -181,6 +182,7 @@
 #include "lib/misc.h"
 #include "lib/memory.h"
 #include "rpc/item.h"
+#include "rpc/rpc_machine.h"  /* m0_rpc_machine_get_opstats */
 #include "fop/fop_item_type.h"
 #include "rpc/rpc_opcodes.h"
 #include "stats/stats_srv.h"
@@ -189,6 +191,7 @@
 #include "reqh/reqh_service.h"
 #include "stats/stats_fops.h"
 #include "stats/stats_fops_xc.h"
+#include "stats/stats_hist.h"
 
 M0_TL_DESCR_DEFINE(stats, "statistic objects", M0_INTERNAL, struct m0_stats,
 		   s_linkage, s_magic, M0_STATS_MAGIC, M0_STATS_HEAD_MAGIC);
@@ -380,13 +383,17 @@ M0_INTERNAL struct m0_stats *m0_stats_get(struct m0_tl *stats_list, uint64_t id)
 static int stats_sum_copy(struct m0_stats_sum *s, struct m0_stats_sum *d)
 {
 	M0_PRE(s != NULL && d != NULL);
-	if (d->ss_data.se_data == 0) {
+	/* Histograms are encoded in summaries of variable length. */
+	if (d->ss_data.se_data == NULL ||
+	    d->ss_data.se_nr != s->ss_data.se_nr) {
+		m0_free(d->ss_data.se_data);
+		d->ss_data.se_nr = 0;
 		M0_ALLOC_ARR(d->ss_data.se_data, s->ss_data.se_nr);
 		if (d->ss_data.se_data == NULL)
 			return M0_ERR(-ENOMEM);
 	}
 	d->ss_id = s->ss_id;
-	d->ss_data.se_data = s->ss_data.se_data;
+	d->ss_data.se_nr = s->ss_data.se_nr;
 	memcpy(d->ss_data.se_data, s->ss_data.se_data, SUM_DATA_SIZE(d));
 	return 0;
 }
@@ -440,7 +447,16 @@ static int stats_update(struct m0_fom *fom)
 		struct m0_stats     *stats_obj = m0_stats_get(&svc->ss_stats,
 							      sum->ss_id);
 
-		if (stats_obj != NULL) {
+		if (stats_obj != NULL && m0_stats_is_hist(sum->ss_id)) {
+			/*
+			 * Histograms of the same id coming from different
+			 * nodes are aggregated.
+			 */
+			int rc = m0_stats_hist_sum_merge(&stats_obj->s_sum,
+							 sum);
+			if (rc != 0)
+				return M0_RC(rc);
+		} else if (stats_obj != NULL) {
 			stats_sum_copy(sum, &stats_obj->s_sum);
 		} else {
 			int rc = stats_add(&svc->ss_stats, sum);
@@ -565,6 +581,126 @@ const struct m0_sm_conf stats_query_fom_sm_conf = {
 	.scf_state     = stats_query_phases
 };
 
+enum {
+	/** Counters of m0_rpc_opstats, then OPSTATS_PHASE_NR words per phase. */
+	OPSTATS_CNT_NR   = 4,
+	/** nr, sum, max, median, 99th and 99.9th percentiles of a phase. */
+	OPSTATS_PHASE_NR = 6,
+	OPSTATS_DATA_NR  = OPSTATS_CNT_NR + OPSTATS_PHASE_NR * M0_RPC_LAT_NR
+};
+
+/**
+ * Fills sum with the live rpc statistics of the opcode encoded in the id, see
+ * M0_RPC_OPSTATS_ID_BASE.
+ *
+ * @retval -ENOENT the id is not an opcode statistics id or the rpc machine has
+ *         no statistics of the opcode.
+ */
+static int opstats_read(struct m0_fom *fom, uint64_t id,
+			struct m0_stats_sum *sum)
+{
+	struct m0_rpc_machine *mach = m0_fop_rpc_machine(fom->fo_fop);
+	struct m0_rpc_opstats *os;
+	uint64_t              *data;
+	int                    i;
+	int                    rc;
+
+	if (id < M0_RPC_OPSTATS_ID_BASE ||
+	    id >= M0_RPC_OPSTATS_ID_BASE + M0_OPCODES_NR || mach == NULL)
+		return -ENOENT;
+	M0_ALLOC_PTR(os);
+	if (os == NULL)
+		return M0_ERR(-ENOMEM);
+	rc = m0_rpc_machine_get_opstats(mach, id - M0_RPC_OPSTATS_ID_BASE, os,
+					false);
+	if (rc == 0) {
+		M0_ALLOC_ARR(data, OPSTATS_DATA_NR);
+		if (data == NULL)
+			rc = M0_ERR(-ENOMEM);
+	}
+	if (rc == 0) {
+		data[0] = os->ros_nr_sent;
+		data[1] = os->ros_nr_replied;
+		data[2] = os->ros_nr_failed;
+		data[3] = os->ros_nr_served;
+		for (i = 0; i < M0_RPC_LAT_NR; ++i) {
+			struct m0_rpc_lat_hist *h = &os->ros_lat[i];
+			uint64_t *d = &data[OPSTATS_CNT_NR +
+					    i * OPSTATS_PHASE_NR];
+
+			d[0] = h->rlh_nr;
+			d[1] = h->rlh_sum;
+			d[2] = h->rlh_max;
+			d[3] = m0_rpc_lat_hist_quantile(h, 500);
+			d[4] = m0_rpc_lat_hist_quantile(h, 990);
+			d[5] = m0_rpc_lat_hist_quantile(h, 999);
+		}
+		sum->ss_id = id;
+		sum->ss_data.se_nr = OPSTATS_DATA_NR;
+		sum->ss_data.se_data = data;
+	}
+	m0_free(os);
+	return rc;
+}
+
+enum {
+	/** Time of the read, finished foms, run-queue waits and their time. */
+	FOMSTATS_CNT_NR   = 4,
+	/** Transitions, their time, waits and their time of a phase. */
+	FOMSTATS_PHASE_NR = 4
+};
+
+/**
+ * Fills sum with the live accounting of the fom type encoded in the id, see
+ * M0_FOM_STATS_ID_BASE. Times are in nanoseconds. The completion rate is the
+ * difference of finished foms of two reads divided by the difference of their
+ * times.
+ *
+ * @retval -ENOENT the id is not a fom type statistics id or no fom of the type
+ *         has been executed.
+ */
+static int fomstats_read(struct m0_fom *fom, uint64_t id,
+			 struct m0_stats_sum *sum)
+{
+	struct m0_fom_type_stats *st;
+	uint64_t                 *data;
+	uint32_t                  nr;
+	uint32_t                  i;
+	int                       rc;
+
+	if (id < M0_FOM_STATS_ID_BASE ||
+	    id >= M0_FOM_STATS_ID_BASE + M0_OPCODES_NR)
+		return -ENOENT;
+	rc = m0_fom_domain_type_stats(fom->fo_loc->fl_dom,
+				      id - M0_FOM_STATS_ID_BASE, &st);
+	if (rc != 0)
+		return rc;
+	nr = FOMSTATS_CNT_NR + FOMSTATS_PHASE_NR * st->fts_phase_nr;
+	M0_ALLOC_ARR(data, nr);
+	if (data != NULL) {
+		data[0] = m0_time_now();
+		data[1] = st->fts_done;
+		data[2] = st->fts_queue_nr;
+		data[3] = st->fts_queue;
+		for (i = 0; i < st->fts_phase_nr; ++i) {
+			struct m0_fom_phase_stats *ps = &st->fts_phase[i];
+			uint64_t *d = &data[FOMSTATS_CNT_NR +
+					    i * FOMSTATS_PHASE_NR];
+
+			d[0] = ps->fps_run_nr;
+			d[1] = ps->fps_run;
+			d[2] = ps->fps_wait_nr;
+			d[3] = ps->fps_wait;
+		}
+		sum->ss_id = id;
+		sum->ss_data.se_nr = nr;
+		sum->ss_data.se_data = data;
+	} else
+		rc = M0_ERR(-ENOMEM);
+	m0_free(st);
+	return rc;
+}
+
 static int read_stats(struct m0_fom *fom)
 {
 	struct m0_stats_query_fop     *qfop;
@@ -590,12 +726,23 @@ static int read_stats(struct m0_fom *fom)
 
 		/* Continue getting stats for next id */
 		if (stats_obj == NULL) {
-			rep_fop->sqrf_stats.sf_stats[i].ss_data.se_nr = 0;
-			continue;
-		}
-
-		rc = stats_sum_copy(&stats_obj->s_sum,
-				    &rep_fop->sqrf_stats.sf_stats[i]);
+			uint64_t             id  = qfop->sqf_ids.se_data[i];
+			struct m0_stats_sum *sum =
+				&rep_fop->sqrf_stats.sf_stats[i];
+
+			rc = opstats_read(fom, id, sum);
+			if (rc == -ENOENT)
+				rc = fomstats_read(fom, id, sum);
+			if (rc == -ENOENT) {
+				rep_fop->sqrf_stats.sf_stats[i].ss_data.se_nr =
+					0;
+				rc = 0;
+			}
+			if (rc == 0)
+				continue;
+		} else
+			rc = stats_sum_copy(&stats_obj->s_sum,
+					    &rep_fop->sqrf_stats.sf_stats[i]);
 		if (rc != 0) {
 #undef REP_STATS_SUM_DATA
 #define REP_STATS_SUM_DATA(rep_fop, i) \
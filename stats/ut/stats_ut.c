@@ -43,6 +43,8 @@ struct m0_ut_suite stats_ut = {
 		{ "stats-svc-update-fom", stats_ut_svc_update_fom },
 		{ "stats-svc-query-fom",  stats_ut_svc_query_fom },
 		{ "stats-svc-query-api",  stats_svc_query_api },
+		{ "stats-hist",           stats_hist },
+		{ "stats-svc-hist-merge", stats_svc_hist_merge },
 		{ NULL,	NULL}
 	}
 };
@@ -26,6 +26,7 @@
 #include "stats/stats_fops.h"
 #include "reqh/reqh_service.h"
 #include "stats/stats_api.h"
+#include "stats/stats_hist.h"
 
 #include "stats/stats_srv.c"
 #include "rpc/ut/clnt_srv_ctx.c"
@@ -101,10 +102,10 @@ static void fill_stats_input()
 void check_stats(struct m0_tl *stats_list, int count)
 {
 	int i;
-	int id;
 
-	for (i = 0, id = 1; i < count; ++i, ++id) {
-		struct m0_stats *stats = m0_stats_get(stats_list, id);
+	for (i = 0; i < count; ++i) {
+		struct m0_stats *stats = m0_stats_get(stats_list,
+						      stats_sum[i].ss_id);
 		M0_UT_ASSERT(stats != NULL);
 	}
 }
@@ -540,6 +541,142 @@ static void stats_svc_query_api()
 	sctx = stats_ut_sctx_bk;
 }
 
+/** Adds values [lo, hi] to the histogram. */
+static void hist_fill(struct m0_stats_hist *h, uint64_t lo, uint64_t hi)
+{
+	uint64_t val;
+
+	for (val = lo; val <= hi; ++val)
+		m0_stats_hist_add(h, val);
+}
+
+static void stats_hist(void)
+{
+	struct m0_stats_hist         h;
+	struct m0_stats_hist         h1;
+	struct m0_stats_hist         h2;
+	struct m0_stats_hist_summary s;
+	struct m0_stats_sum          sum;
+	struct m0_stats_sum          sum1;
+	uint64_t                     q;
+	int                          rc;
+
+	m0_stats_hist_init(&h);
+	M0_UT_ASSERT(m0_stats_hist_quantile(&h, 500) == 0);
+	hist_fill(&h, 1, 1000);
+	/* Quantiles are upper estimates within the bucket width. */
+	q = m0_stats_hist_quantile(&h, 500);
+	M0_UT_ASSERT(q >= 500 && q <= 500 + 500 / 8);
+	q = m0_stats_hist_quantile(&h, 990);
+	M0_UT_ASSERT(q >= 990 && q <= 1000);
+	M0_UT_ASSERT(m0_stats_hist_quantile(&h, 1000) == 1000);
+	m0_stats_hist_summary(&h, &s);
+	M0_UT_ASSERT(s.shs_nr == 1000 && s.shs_min == 1 && s.shs_max == 1000);
+	M0_UT_ASSERT(s.shs_mean == 500);
+	M0_UT_ASSERT(s.shs_p50 <= s.shs_p90 && s.shs_p90 <= s.shs_p99 &&
+		     s.shs_p99 <= s.shs_p999);
+
+	/* Encoding round-trip. */
+	rc = m0_stats_hist_encode(&h, M0_STATS_HIST_IO_READ, &sum);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(sum.ss_id == M0_STATS_HIST_IO_READ);
+	rc = m0_stats_hist_decode(&sum, &h1);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(memcmp(&h, &h1, sizeof h) == 0);
+
+	/* Merging summaries is the same as merging histograms. */
+	m0_stats_hist_init(&h2);
+	hist_fill(&h2, 1ULL << 30, (1ULL << 30) + 1000);
+	rc = m0_stats_hist_encode(&h2, M0_STATS_HIST_IO_READ, &sum1);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_stats_hist_sum_merge(&sum, &sum1);
+	M0_UT_ASSERT(rc == 0);
+	m0_stats_hist_merge(&h, &h2);
+	rc = m0_stats_hist_decode(&sum, &h1);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(memcmp(&h, &h1, sizeof h) == 0);
+	M0_UT_ASSERT(h1.sh_nr == 2001 && h1.sh_min == 1 &&
+		     h1.sh_max == (1ULL << 30) + 1000);
+	M0_UT_ASSERT(m0_stats_hist_quantile(&h1, 600) >= 1ULL << 30);
+
+	/* Malformed summaries. */
+	sum1.ss_data.se_data[0]++;
+	rc = m0_stats_hist_decode(&sum1, &h1);
+	M0_UT_ASSERT(rc == -EPROTO);
+	sum1.ss_data.se_data[0]--;
+	sum1.ss_data.se_data[M0_STATS_HIST_HDR_NR] = M0_STATS_HIST_BUCKETS;
+	rc = m0_stats_hist_decode(&sum1, &h1);
+	M0_UT_ASSERT(rc == -EPROTO);
+	sum1.ss_data.se_nr--;
+	rc = m0_stats_hist_decode(&sum1, &h1);
+	M0_UT_ASSERT(rc == -EPROTO);
+	sum1.ss_data.se_nr++;
+	sum1.ss_id = UT_STATS_DISK;
+	rc = m0_stats_hist_decode(&sum1, &h1);
+	M0_UT_ASSERT(rc == -EPROTO);
+	M0_UT_ASSERT(!m0_stats_is_hist(UT_STATS_DISK));
+	M0_UT_ASSERT(m0_stats_is_hist(M0_STATS_HIST_RPC));
+
+	m0_free(sum.ss_data.se_data);
+	m0_free(sum1.ss_data.se_data);
+}
+
+/** Sends the histogram to the stats service in an update fop. */
+static void hist_update(struct stats_svc *srv, struct m0_reqh *reqh,
+			const struct m0_stats_hist *h)
+{
+	int rc;
+
+	rc = m0_stats_hist_encode(h, M0_STATS_HIST_RPC, &stats_sum[0]);
+	M0_UT_ASSERT(rc == 0);
+	update_fom_test(srv, reqh, 1);
+	m0_free(stats_sum[0].ss_data.se_data);
+}
+
+static void stats_svc_hist_merge(void)
+{
+	struct m0_reqh         *reqh;
+	struct m0_reqh_service *reqh_srv;
+	struct stats_svc       *srv;
+	struct m0_stats        *stats;
+	struct m0_stats_hist    h1;
+	struct m0_stats_hist    h2;
+	struct m0_stats_hist    h;
+	int                     rc;
+
+	stats_ut_sctx_bk = sctx;
+
+	sctx.rsx_argv = stats_ut_server_argv;
+	sctx.rsx_argc = ARRAY_SIZE(stats_ut_server_argv);
+
+	start_rpc_client_and_server();
+
+	reqh = m0_cs_reqh_get(&sctx.rsx_motr_ctx);
+	reqh_srv = m0_reqh_service_find(&m0_stats_svc_type, reqh);
+	M0_UT_ASSERT(reqh_srv != NULL);
+	srv = container_of(reqh_srv, struct stats_svc, ss_reqhs);
+	stats_svc_invariant(srv);
+
+	/* Two "nodes" report their histograms of the same stats id. */
+	m0_stats_hist_init(&h1);
+	hist_fill(&h1, 100, 200);
+	hist_update(srv, reqh, &h1);
+	m0_stats_hist_init(&h2);
+	hist_fill(&h2, 10000, 20000);
+	hist_update(srv, reqh, &h2);
+
+	stats = m0_stats_get(&srv->ss_stats, M0_STATS_HIST_RPC);
+	M0_UT_ASSERT(stats != NULL);
+	rc = m0_stats_hist_decode(&stats->s_sum, &h);
+	M0_UT_ASSERT(rc == 0);
+	m0_stats_hist_merge(&h1, &h2);
+	M0_UT_ASSERT(memcmp(&h, &h1, sizeof h) == 0);
+
+	stop_rpc_client_and_server();
+
+	sctx = stats_ut_sctx_bk;
+}
+
 /*
  *  Local variables:
  *  c-indentation-style: "K&R"
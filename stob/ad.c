@@ -30,6 +30,7 @@
 #include "fid/fid.h"		/* m0_fid */
 
 #include "lib/finject.h"
+#include "lib/hash.h"		/* m0_hash */
 #include "lib/errno.h"
 #include "lib/locality.h"	/* m0_locality0_get */
 #include "lib/memory.h"
@@ -42,6 +43,7 @@
 #include "module/instance.h"	/* m0_get */
 
 #include "stob/ad.h"
+#include "stob/ad_defrag.h"	/* m0_stob_ad_defrag_add */
 #include "stob/ad_private.h"
 #include "stob/ad_private_xc.h"
 #include "stob/addb2.h"
@@ -378,6 +380,15 @@ static struct m0_sm_group *stob_ad_sm_group(void)
 	return m0_locality0_get()->lo_grp;
 }
 
+static void stob_ad_balloc_fini(struct m0_ad_balloc *ballroom)
+{
+	struct m0_sm_group *grp = stob_ad_sm_group();
+
+	m0_sm_group_lock(grp);
+	ballroom->ab_ops->bo_fini(ballroom, grp);
+	m0_sm_group_unlock(grp);
+}
+
 static int stob_ad_bstore(struct m0_stob_id *stob_id, struct m0_stob **out)
 {
 	struct m0_stob *stob;
@@ -462,12 +473,13 @@ static int stob_ad_domain_init(struct m0_stob_type *type,
 				  &adom->sad_bstore);
 	if (rc != 0) {
 		if (balloc_inited)
-			ballroom->ab_ops->bo_fini(ballroom);
+			stob_ad_balloc_fini(ballroom);
 		m0_be_emap_fini(&adom->sad_adata);
 		m0_free(dom);
 	} else {
 		m0_stob_ad_domain_bob_init(adom);
 		adom->sad_be_seg   = seg;
+		adom->sad_defrag   = NULL;
 		adom->sad_babshift = adom->sad_bshift -
 				m0_stob_block_shift(adom->sad_bstore);
 		M0_LOG(M0_DEBUG, "sad_bshift = %lu\tstob bshift=%lu",
@@ -486,7 +498,7 @@ static void stob_ad_domain_fini(struct m0_stob_domain *dom)
 	struct m0_stob_ad_domain *adom = stob_ad_domain2ad(dom);
 	struct m0_ad_balloc      *ballroom = adom->sad_ballroom;
 
-	ballroom->ab_ops->bo_fini(ballroom);
+	stob_ad_balloc_fini(ballroom);
 	m0_be_emap_fini(&adom->sad_adata);
 	m0_stob_put(adom->sad_bstore);
 	m0_stob_ad_domain_bob_fini(adom);
@@ -709,16 +721,74 @@ static struct m0_stob *stob_ad_alloc(struct m0_stob_domain *dom,
 	struct m0_stob_ad *adstob;
 
 	M0_ALLOC_PTR(adstob);
-	return adstob == NULL ? NULL : &adstob->ad_stob;
+	if (adstob == NULL)
+		return NULL;
+	m0_mutex_init(&adstob->ad_seg_lock);
+	return &adstob->ad_stob;
 }
 
 static void stob_ad_free(struct m0_stob_domain *dom,
 			 struct m0_stob *stob)
 {
 	struct m0_stob_ad *adstob = stob_ad_stob2ad(stob);
+
+	m0_mutex_fini(&adstob->ad_seg_lock);
 	m0_free(adstob);
 }
 
+static uint64_t stob_ad_seg_cache_gen(struct m0_stob *stob)
+{
+	struct m0_stob_ad *adstob = stob_ad_stob2ad(stob);
+	uint64_t           gen;
+
+	m0_mutex_lock(&adstob->ad_seg_lock);
+	gen = adstob->ad_seg_gen;
+	m0_mutex_unlock(&adstob->ad_seg_lock);
+	return gen;
+}
+
+/**
+   Caches the segment, unless the extent map of the object changed since
+   gen was taken by stob_ad_seg_cache_gen().
+ */
+static void stob_ad_seg_cache_put(struct m0_stob *stob, uint64_t gen,
+				  const struct m0_ext *ext, m0_bindex_t val)
+{
+	struct m0_stob_ad *adstob = stob_ad_stob2ad(stob);
+
+	M0_PRE(val < AET_MIN);
+
+	m0_mutex_lock(&adstob->ad_seg_lock);
+	if (adstob->ad_seg_gen == gen) {
+		adstob->ad_seg_ext = *ext;
+		adstob->ad_seg_val = val;
+	}
+	m0_mutex_unlock(&adstob->ad_seg_lock);
+}
+
+static bool stob_ad_seg_cache_get(struct m0_stob *stob,
+				  struct m0_ext *ext, m0_bindex_t *val)
+{
+	struct m0_stob_ad *adstob = stob_ad_stob2ad(stob);
+
+	m0_mutex_lock(&adstob->ad_seg_lock);
+	*ext = adstob->ad_seg_ext;
+	*val = adstob->ad_seg_val;
+	m0_mutex_unlock(&adstob->ad_seg_lock);
+	return !m0_ext_is_empty(ext);
+}
+
+/** Drops the cached segment. Called after the extent map is changed. */
+static void stob_ad_seg_cache_drop(struct m0_stob *stob)
+{
+	struct m0_stob_ad *adstob = stob_ad_stob2ad(stob);
+
+	m0_mutex_lock(&adstob->ad_seg_lock);
+	M0_SET0(&adstob->ad_seg_ext);
+	++adstob->ad_seg_gen;
+	m0_mutex_unlock(&adstob->ad_seg_lock);
+}
+
 static int stob_ad_cfg_parse(const char *str_cfg_create, void **cfg_create)
 {
 	return 0;
@@ -750,8 +820,22 @@ static int stob_ad_init(struct m0_stob *stob,
 	return rc == -ESRCH ? -ENOENT : rc;
 }
 
+/** Identifies the stob as the owner of balloc preallocation windows. */
+static uint64_t stob_ad_owner(struct m0_stob *stob)
+{
+	return m0_fid_hash(m0_stob_fid_get(stob)) ?: 1;
+}
+
 static void stob_ad_fini(struct m0_stob *stob)
 {
+	struct m0_stob_ad_domain *adom;
+	struct m0_ad_balloc      *ballroom;
+
+	adom = stob_ad_domain2ad(m0_stob_dom_get(stob));
+	ballroom = adom->sad_ballroom;
+
+	if (ballroom->ab_ops->bo_release != NULL)
+		ballroom->ab_ops->bo_release(ballroom, stob_ad_owner(stob));
 }
 
 static void stob_ad_create_credit(struct m0_stob_domain *dom,
@@ -968,6 +1052,7 @@ static int stob_ad_destroy(struct m0_stob *stob, struct m0_dtx *tx)
 						     &tx->tx_betx, &op,
 						     &prefix),
 			       bo_u.u_emap.e_rc);
+	stob_ad_seg_cache_drop(stob);
 
 	return M0_RC(rc);
 }
@@ -977,15 +1062,38 @@ static int stob_ad_destroy(struct m0_stob *stob, struct m0_dtx *tx)
  *
  * Stob is punched at location spanned by the 'range'.
  */
+/**
+   Takes the paste lock of the domain defragmentation shared, if it runs.
+
+   @see stobaddefrag
+ */
+static struct m0_stob_ad_defrag *
+stob_ad_paste_lock(struct m0_stob_ad_domain *adom)
+{
+	struct m0_stob_ad_defrag *defrag = adom->sad_defrag;
+
+	if (defrag != NULL)
+		m0_rwlock_read_lock(&defrag->sd_paste_lock);
+	return defrag;
+}
+
+static void stob_ad_paste_unlock(struct m0_stob_ad_defrag *defrag)
+{
+	if (defrag != NULL)
+		m0_rwlock_read_unlock(&defrag->sd_paste_lock);
+}
+
 static int stob_ad_punch(struct m0_stob *stob, struct m0_indexvec *range,
 			 struct m0_dtx *tx)
 {
-	struct m0_ext         todo;
-	m0_bcount_t           count;
-	m0_bcount_t           offset;
-	struct m0_ivec_cursor cur;
-	int                   rc = 0;
+	struct m0_ext             todo;
+	m0_bcount_t               count;
+	m0_bcount_t               offset;
+	struct m0_ivec_cursor     cur;
+	struct m0_stob_ad_defrag *defrag;
+	int                       rc = 0;
 
+	defrag = stob_ad_paste_lock(stob_ad_domain2ad(m0_stob_dom_get(stob)));
 	m0_ivec_cursor_init(&cur, range);
 	count = 0;
 	while (!m0_ivec_cursor_move(&cur, count)) {
@@ -996,9 +1104,11 @@ static int stob_ad_punch(struct m0_stob *stob, struct m0_indexvec *range,
 		M0_LOG(M0_DEBUG, "stob %p, punching"EXT_F, stob, EXT_P(&todo));
 		rc = ext_punch(stob, tx, &todo);
 		if (rc != 0)
-			return M0_ERR(rc);
+			break;
 	}
-	return M0_RC(0);
+	stob_ad_seg_cache_drop(stob);
+	stob_ad_paste_unlock(defrag);
+	return rc == 0 ? M0_RC(0) : M0_ERR(rc);
 }
 
 static uint32_t stob_ad_block_shift(struct m0_stob *stob)
@@ -1104,18 +1214,25 @@ static void *stob_ad_addr_open(const void *buf, uint32_t shift)
 /**
    Helper function to allocate a given number of blocks in the underlying
    storage object.
+
+   If goal is not 0, allocation is first tried at the goal block.
  */
 static int stob_ad_balloc(struct m0_stob_ad_domain *adom, struct m0_dtx *tx,
-			  m0_bcount_t count, struct m0_ext *out,
-			  uint64_t alloc_type)
+			  m0_bcount_t count, m0_bindex_t goal, uint64_t owner,
+			  struct m0_ext *out, uint64_t alloc_type)
 {
 	struct m0_ad_balloc *ballroom = adom->sad_ballroom;
 	int                  rc;
 
 	count >>= adom->sad_babshift;
-	M0_LOG(M0_DEBUG, "count=%lu", (unsigned long)count);
+	M0_LOG(M0_DEBUG, "count=%lu goal=%lu", (unsigned long)count,
+	       (unsigned long)goal);
 	M0_ASSERT(count > 0);
-	rc = ballroom->ab_ops->bo_alloc(ballroom, tx, count, out, alloc_type);
+	out->e_start = out->e_end = goal >> adom->sad_babshift;
+	if (goal != 0)
+		alloc_type |= M0_BALLOC_HINT_TRY_GOAL;
+	rc = ballroom->ab_ops->bo_alloc(ballroom, tx, count, out, alloc_type,
+				       owner);
 	out->e_start <<= adom->sad_babshift;
 	out->e_end   <<= adom->sad_babshift;
 	m0_ext_init(out);
@@ -1382,7 +1499,8 @@ static int stob_ad_read_prepare(struct m0_stob_io        *io,
 				struct m0_stob_ad_domain *adom,
 				struct m0_vec_cursor     *src,
 				struct m0_vec_cursor     *dst,
-				struct m0_be_emap_caret  *car)
+				struct m0_be_emap_caret  *car,
+				uint64_t                  gen)
 {
 	struct m0_be_emap_cursor *it;
 	struct m0_be_emap_seg    *seg;
@@ -1393,6 +1511,8 @@ static int stob_ad_read_prepare(struct m0_stob_io        *io,
 	uint32_t                  bshift;
 	m0_bcount_t               frag_size; /* measured in blocks */
 	m0_bindex_t               off;       /* measured in blocks */
+	struct m0_ext             last = {};
+	m0_bindex_t               last_val = 0;
 	int                       rc;
 	int                       i;
 	int                       idx;
@@ -1457,6 +1577,10 @@ static int stob_ad_read_prepare(struct m0_stob_io        *io,
 			if (io->si_cksum_sz && io->si_unit_sz)
 				stob_ad_get_checksum_for_fragment(io, it, off, frag_size);
 			frags_not_empty++;
+			if (seg->ee_cksum_buf.b_nob == 0) {
+				last = seg->ee_ext;
+				last_val = seg->ee_val;
+			}
 		}
 
 		eosrc = m0_vec_cursor_move(src, frag_size);
@@ -1470,6 +1594,12 @@ static int stob_ad_read_prepare(struct m0_stob_io        *io,
 
 	M0_LOG(M0_DEBUG, "frags=%d frags_not_empty=%d",
 			(int)frags, (int)frags_not_empty);
+	if (adom->sad_defrag != NULL &&
+	    frags_not_empty >= adom->sad_defrag->sd_cfg.sdc_segs_min)
+		m0_stob_ad_defrag_add(adom->sad_defrag,
+				      m0_stob_fid_get(io->si_obj));
+	if (!m0_ext_is_empty(&last))
+		stob_ad_seg_cache_put(io->si_obj, gen, &last, last_val);
 
 	stob_ad_cursors_fini(it, src, dst, car);
 
@@ -1538,6 +1668,65 @@ static int stob_ad_read_prepare(struct m0_stob_io        *io,
 	return M0_RC(rc);
 }
 
+/**
+ * Constructs back IO for a read that falls entirely into the allocated
+ * segment cached by a previous read, without the extent map lookup.
+ *
+ * @retval -ENOENT the read can not be served from the cache.
+ */
+static int stob_ad_read_prepare_cached(struct m0_stob_io *io)
+{
+	struct m0_stob_ad_io *aio  = io->si_stob_private;
+	struct m0_stob_io    *back = &aio->ai_back;
+	struct m0_indexvec   *iv   = &io->si_stob;
+	struct m0_vec_cursor  src;
+	struct m0_vec_cursor  dst;
+	struct m0_ext         seg;
+	m0_bindex_t           val;
+	m0_bcount_t           frag_size;
+	m0_bindex_t           off;
+	uint32_t              frags;
+	uint32_t              i;
+	int                   rc;
+
+	/* Checksums are copied from the segment, which is not cached. */
+	if ((io->si_cksum_sz && io->si_unit_sz) ||
+	    !stob_ad_seg_cache_get(io->si_obj, &seg, &val) ||
+	    iv->iv_index[0] < seg.e_start ||
+	    iv->iv_index[iv->iv_vec.v_nr - 1] +
+	    iv->iv_vec.v_count[iv->iv_vec.v_nr - 1] > seg.e_end)
+		return -ENOENT;
+
+	frags = 0;
+	m0_vec_cursor_init(&src, &io->si_user.ov_vec);
+	m0_vec_cursor_init(&dst, &iv->iv_vec);
+	do {
+		frag_size = min_check(m0_vec_cursor_step(&src),
+				      m0_vec_cursor_step(&dst));
+		m0_vec_cursor_move(&dst, frag_size);
+		++frags;
+	} while (!m0_vec_cursor_move(&src, frag_size));
+
+	rc = stob_ad_vec_alloc(io->si_obj, back, frags);
+	if (rc != 0)
+		return M0_RC(rc);
+
+	m0_vec_cursor_init(&src, &io->si_user.ov_vec);
+	m0_vec_cursor_init(&dst, &iv->iv_vec);
+	for (i = 0; i < frags; ++i) {
+		off = iv->iv_index[dst.vc_seg] + dst.vc_offset;
+		frag_size = min_check(m0_vec_cursor_step(&src),
+				      m0_vec_cursor_step(&dst));
+		back->si_user.ov_vec.v_count[i] = frag_size;
+		back->si_user.ov_buf[i] = io->si_user.ov_buf[src.vc_seg] +
+					  src.vc_offset;
+		back->si_stob.iv_index[i] = val + (off - seg.e_start);
+		m0_vec_cursor_move(&src, frag_size);
+		m0_vec_cursor_move(&dst, frag_size);
+	}
+	return M0_RC(0);
+}
+
 /**
    A linked list of allocated extents.
  */
@@ -1959,7 +2148,11 @@ static int stob_ad_write_prepare(struct m0_stob_io        *io,
 	struct stob_ad_write_ext   *next;
 	struct m0_stob_io          *back;
 	struct m0_stob_ad_io       *aio = io->si_stob_private;
+	struct m0_stob_ad          *adstob = stob_ad_stob2ad(io->si_obj);
 	struct stob_ad_wext_cursor  wc;
+	m0_bindex_t                 goal;
+	m0_bindex_t                 end;
+	uint32_t                    last;
 
 	M0_PRE(io->si_opcode == SIO_WRITE);
 	M0_ADDB2_ADD(M0_AVI_STOB_IO_REQ, io->si_id, M0_AVI_AD_WR_PREPARE);
@@ -1970,13 +2163,19 @@ static int stob_ad_write_prepare(struct m0_stob_io        *io,
 	M0_SET0(&head);
 	wext = &head;
 	wext->we_next = NULL;
+	/* Continue the storage of the previous write if this one follows it. */
+	last = io->si_stob.iv_vec.v_nr - 1;
+	end  = io->si_stob.iv_index[last] + io->si_stob.iv_vec.v_count[last];
+	goal = io->si_stob.iv_index[0] == adstob->ad_write_end ?
+		adstob->ad_alloc_end : 0;
 	while (1) {
 		m0_bcount_t got;
 
 		M0_ADDB2_ADD(M0_AVI_STOB_IO_REQ, io->si_id,
 			     M0_AVI_AD_BALLOC_START);
 		/* Get the balloc extent (returned in wext->we_ext) */
-		rc = stob_ad_balloc(adom, io->si_tx, todo, &wext->we_ext,
+		rc = stob_ad_balloc(adom, io->si_tx, todo, goal,
+				    stob_ad_owner(io->si_obj), &wext->we_ext,
 				    aio->ai_balloc_flags);
 		M0_ADDB2_ADD(M0_AVI_STOB_IO_REQ, io->si_id,
 			     M0_AVI_AD_BALLOC_END);
@@ -1988,6 +2187,7 @@ static int stob_ad_write_prepare(struct m0_stob_io        *io,
 		M0_LOG(M0_DEBUG, "got=%" PRId64 ": " EXT_F,
 		       got, EXT_P(&wext->we_ext));
 		todo -= got;
+		goal = wext->we_ext.e_end;
 		++bfrags;
 		if (todo > 0) {
 			if (bfrags >= BALLOC_FRAGS_MAX) {
@@ -2037,6 +2237,10 @@ static int stob_ad_write_prepare(struct m0_stob_io        *io,
 			rc = stob_ad_write_map(io, adom, &dst, map, &wc, frags);
 		}
 	}
+	if (rc == 0) {
+		adstob->ad_write_end = end;
+		adstob->ad_alloc_end = wext->we_ext.e_end;
+	}
 	stob_ad_wext_fini(&head);
 	return M0_RC(rc);
 }
@@ -2050,6 +2254,8 @@ static int stob_ad_io_launch_prepare(struct m0_stob_io *io)
 	struct m0_stob_ad_domain *adom;
 	struct m0_stob_ad_io     *aio  = io->si_stob_private;
 	struct m0_stob_io        *back = &aio->ai_back;
+	struct m0_stob_ad_defrag *defrag;
+	uint64_t                  gen;
 	int                       rc;
 
 	M0_PRE(io->si_stob.iv_vec.v_nr > 0);
@@ -2066,21 +2272,32 @@ static int stob_ad_io_launch_prepare(struct m0_stob_io *io)
 
 	M0_ADDB2_ADD(M0_AVI_STOB_IO_REQ, io->si_id, M0_AVI_AD_PREPARE);
 	adom = stob_ad_domain2ad(m0_stob_dom_get(io->si_obj));
-	rc = stob_ad_cursors_init(io, adom, &it, &src, &dst, &map);
-	if (rc != 0)
-		return M0_RC(rc);
 
 	back->si_opcode   = io->si_opcode;
 	back->si_flags    = io->si_flags;
+	back->si_class    = io->si_class;
 	back->si_fol_frag = io->si_fol_frag;
 	back->si_id       = io->si_id;
 
+	if (io->si_opcode == SIO_READ) {
+		rc = stob_ad_read_prepare_cached(io);
+		if (rc != -ENOENT)
+			return M0_RC(rc);
+	}
+	gen = stob_ad_seg_cache_gen(io->si_obj);
+	rc = stob_ad_cursors_init(io, adom, &it, &src, &dst, &map);
+	if (rc != 0)
+		return M0_RC(rc);
+
 	switch (io->si_opcode) {
 	case SIO_READ:
-		rc = stob_ad_read_prepare(io, adom, &src, &dst, &map);
+		rc = stob_ad_read_prepare(io, adom, &src, &dst, &map, gen);
 		break;
 	case SIO_WRITE:
+		defrag = aio->ai_defrag ? NULL : stob_ad_paste_lock(adom);
 		rc = stob_ad_write_prepare(io, adom, &src, &map);
+		stob_ad_seg_cache_drop(io->si_obj);
+		stob_ad_paste_unlock(defrag);
 		break;
 	default:
 		M0_IMPOSSIBLE("Invalid io type.");
@@ -2090,6 +2307,56 @@ static int stob_ad_io_launch_prepare(struct m0_stob_io *io)
 	return rc;
 }
 
+M0_INTERNAL int m0_stob_ad_defrag_run(struct m0_stob *stob,
+				      m0_bindex_t offset, m0_bcount_t max,
+				      struct m0_ext *run, uint32_t *segs_nr,
+				      uint64_t *sig)
+{
+	struct m0_stob_ad_domain *adom;
+	struct m0_be_emap_cursor  it = {};
+	struct m0_be_emap_seg    *seg;
+	bool                      skip;
+	int                       rc;
+
+	M0_PRE(max > 0);
+
+	adom = stob_ad_domain2ad(m0_stob_dom_get(stob));
+	*segs_nr = 0;
+	*sig = 0;
+	M0_SET0(run);
+	rc = stob_ad_cursor(adom, stob, offset, &it);
+	if (rc != 0)
+		return M0_ERR(rc);
+	do {
+		seg = m0_be_emap_seg_get(&it);
+		skip = seg->ee_val >= AET_MIN || seg->ee_cksum_buf.b_nob != 0;
+		if (skip && *segs_nr > 0)
+			break;
+		if (!skip) {
+			if (*segs_nr == 0)
+				run->e_start = max64u(offset,
+						      seg->ee_ext.e_start);
+			run->e_end = min64u(seg->ee_ext.e_end,
+					    run->e_start + max);
+			++*segs_nr;
+			*sig = m0_hash(*sig ^ seg->ee_ext.e_start) ^
+				m0_hash(seg->ee_ext.e_end + seg->ee_val);
+			if (m0_ext_length(run) == max)
+				break;
+		}
+		if (m0_be_emap_ext_is_last(&seg->ee_ext))
+			break;
+		M0_SET0(&it.ec_op);
+		rc = M0_BE_OP_SYNC_RET_WITH(&it.ec_op, m0_be_emap_next(&it),
+					    bo_u.u_emap.e_rc);
+	} while (rc == 0);
+	m0_be_emap_close(&it);
+	if (rc == 0 && *segs_nr == 0)
+		rc = -ENOENT;
+	m0_ext_init(run);
+	return M0_RC(rc);
+}
+
 /**
  * Launch asynchronous IO.
  *
@@ -2203,6 +2470,7 @@ static int stob_ad_rec_frag_undo_redo_op(struct m0_fol_frag *frag,
 	struct m0_stob_ad_domain *adom = stob_ad_domain2ad(dom);
 	struct m0_be_emap_seg    *old_data = arp->arp_seg.ps_old_data;
 	struct m0_be_emap_cursor  it = {};
+	struct m0_stob           *stob;
 	int		          i;
 	int		          rc = 0;
 
@@ -2229,6 +2497,10 @@ static int stob_ad_rec_frag_undo_redo_op(struct m0_fol_frag *frag,
 			m0_be_emap_close(&it);
 		}
 	}
+	if (m0_stob_lookup(&arp->arp_stob_id, &stob) == 0) {
+		stob_ad_seg_cache_drop(stob);
+		m0_stob_put(stob);
+	}
 	return M0_RC(rc);
 }
 
@@ -27,6 +27,8 @@
 
 #include "be/extmap.h"		/* m0_be_emap */
 #include "fid/fid.h"		/* m0_fid */
+#include "lib/ext.h"		/* m0_ext */
+#include "lib/mutex.h"		/* m0_mutex */
 #include "lib/types.h"		/* m0_bcount_t */
 #include "stob/domain.h"	/* m0_stob_domain */
 #include "stob/io.h"		/* m0_stob_io */
@@ -78,13 +80,21 @@ struct m0_ad_balloc_ops {
 			uint32_t bshift, m0_bcount_t container_size,
 			m0_bcount_t blocks_per_group,
 			m0_bcount_t spare_blocks_per_group);
-	/** Finalises and destroys struct m0_balloc instance. */
-	void (*bo_fini)(struct m0_ad_balloc *ballroom);
+	/** Finalises and destroys struct m0_balloc instance.
+	    @param grp sm group for the final super block update, locked by
+		   the caller as for m0_balloc_create()
+	 */
+	void (*bo_fini)(struct m0_ad_balloc *ballroom,
+			struct m0_sm_group *grp);
 	/** Allocates count of blocks. On success, allocated extent, also
-	    measured in blocks, is returned in out parameter. */
+	    measured in blocks, is returned in out parameter. Non-zero owner
+	    identifies the object the blocks are allocated for, allocator
+	    may keep space after the allocated extent for the owner. */
 	int  (*bo_alloc)(struct m0_ad_balloc *ballroom, struct m0_dtx *dtx,
 			 m0_bcount_t count, struct m0_ext *out,
-			 uint64_t alloc_zone);
+			 uint64_t alloc_zone, uint64_t owner);
+	/** Optional. Releases space kept for the owner by bo_alloc(). */
+	void (*bo_release)(struct m0_ad_balloc *ballroom, uint64_t owner);
 	/** Free space (possibly a sub-extent of an extent allocated
 	    earlier). */
 	int  (*bo_free)(struct m0_ad_balloc *ballroom, struct m0_dtx *dtx,
@@ -108,6 +118,8 @@ struct m0_ad_balloc_ops {
 
 enum { AD_PATHLEN = 4096 };
 
+struct m0_stob_ad_defrag;
+
 struct m0_stob_ad_domain {
 	struct m0_format_header sad_header;
 	uint64_t                sad_dom_key;
@@ -132,6 +144,8 @@ struct m0_stob_ad_domain {
 	 */
 	struct m0_stob         *sad_bstore;
 	struct m0_be_seg       *sad_be_seg;
+	/** Defragmentation of the domain, NULL if it is not running. */
+	struct m0_stob_ad_defrag *sad_defrag;
 	uint64_t                sad_magix;
 } M0_XCA_RECORD M0_XCA_DOMAIN(be);
 M0_BASSERT(sizeof(M0_FIELD_VALUE(struct m0_stob_ad_domain, sad_path)) % 8 == 0);
@@ -192,6 +206,35 @@ enum stob_ad_allocation_extent_type {
 
 struct m0_stob_ad {
 	struct m0_stob          ad_stob;
+	/**
+	 * Offset in the object right after the last write that allocated
+	 * space, in object blocks.
+	 */
+	m0_bindex_t             ad_write_end;
+	/**
+	 * Block in the underlying storage right after the space allocated for
+	 * that write. A write starting at ad_write_end asks balloc for space
+	 * starting at this block, so that sequential writes to the object get
+	 * contiguous storage. Both fields are hints and are updated without a
+	 * lock.
+	 */
+	m0_bindex_t             ad_alloc_end;
+	/** Protects the segment cache below. */
+	struct m0_mutex         ad_seg_lock;
+	/**
+	 * Allocated segment of the extent map found by the last read of the
+	 * object, empty when there is none. A read that falls entirely into
+	 * this segment is mapped to the underlying storage without an extent
+	 * map lookup.
+	 */
+	struct m0_ext           ad_seg_ext;
+	/** Physical start of ad_seg_ext. */
+	m0_bindex_t             ad_seg_val;
+	/**
+	 * Incremented on every change of the extent map of the object.
+	 * A segment looked up before a change is not cached after it.
+	 */
+	uint64_t                ad_seg_gen;
 };
 
 struct m0_stob_ad_io {
@@ -205,6 +248,11 @@ struct m0_stob_ad_io {
 	 * they are not set by default. See @enum m0_balloc_allocation_flag.
 	 */
 	uint64_t           ai_balloc_flags;
+	/**
+	 * Set for rewrites of defragmentation, which already hold
+	 * m0_stob_ad_defrag::sd_paste_lock.
+	 */
+	bool               ai_defrag;
 };
 
 extern const struct m0_stob_type m0_stob_ad_type;
@@ -0,0 +1,357 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2013-2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_ADSTOB
+#include "lib/trace.h"
+
+#include "balloc/balloc.h"	/* M0_BALLOC_NORMAL_ZONE */
+#include "be/seg.h"		/* m0_be_seg */
+#include "dtm/dtm.h"		/* m0_dtx */
+#include "lib/errno.h"
+#include "lib/memory.h"
+#include "lib/misc.h"		/* M0_SET0 */
+#include "lib/time.h"		/* m0_time_now */
+#include "sm/sm.h"		/* m0_sm_group_lock */
+#include "stob/ad.h"
+#include "stob/ad_defrag.h"
+#include "stob/ad_private.h"	/* stob_ad_domain2ad */
+#include "stob/domain.h"
+#include "stob/io.h"
+#include "stob/stob.h"
+
+/**
+   @addtogroup stobaddefrag
+
+   @{
+ */
+
+static struct m0_stob_ad_domain *defrag2adom(struct m0_stob_ad_defrag *d)
+{
+	return stob_ad_domain2ad(d->sd_dom);
+}
+
+static void defrag_io_init(struct m0_stob_io *io, struct m0_stob *stob,
+			   enum m0_stob_io_opcode opcode, void **addr,
+			   m0_bcount_t *count, m0_bcount_t *ucount,
+			   m0_bindex_t *index)
+{
+	m0_stob_io_init(io);
+	io->si_opcode = opcode;
+	io->si_flags  = 0;
+	io->si_class  = SIC_BACKGROUND;
+	io->si_user   = M0_BUFVEC_INIT_BUF(addr, ucount);
+	io->si_stob   = (struct m0_indexvec) {
+		.iv_vec   = { .v_nr = 1, .v_count = count },
+		.iv_index = index,
+	};
+}
+
+static int defrag_io_wait(struct m0_stob_io *io, struct m0_clink *clink)
+{
+	m0_chan_wait(clink);
+	m0_clink_del_lock(clink);
+	m0_clink_fini(clink);
+	return io->si_rc;
+}
+
+static int defrag_read(struct m0_stob_ad_defrag *d, struct m0_stob *stob,
+		       const struct m0_ext *run)
+{
+	struct m0_stob_io io;
+	struct m0_clink   clink;
+	m0_bcount_t       count = m0_ext_length(run);
+	m0_bcount_t       ucount = count;
+	m0_bindex_t       index = run->e_start;
+	void             *addr;
+	int               rc;
+
+	addr = m0_stob_addr_pack(d->sd_buf, m0_stob_block_shift(stob));
+	defrag_io_init(&io, stob, SIO_READ, &addr, &count, &ucount,
+		       &index);
+	m0_clink_init(&clink, NULL);
+	m0_clink_add_lock(&io.si_wait, &clink);
+	rc = m0_stob_io_prepare_and_launch(&io, stob, NULL, NULL);
+	if (rc == 0)
+		rc = defrag_io_wait(&io, &clink);
+	else {
+		m0_clink_del_lock(&clink);
+		m0_clink_fini(&clink);
+	}
+	if (rc == 0 && io.si_count != m0_ext_length(run))
+		rc = M0_ERR(-EIO);
+	m0_stob_io_fini(&io);
+	return M0_RC(rc);
+}
+
+/**
+   Writes the run back, unless the extent map of the run changed since
+   it was read.
+
+   @retval -EAGAIN the run was changed by a write or a punch.
+ */
+static int defrag_write(struct m0_stob_ad_defrag *d, struct m0_stob *stob,
+			const struct m0_ext *run, uint64_t sig,
+			struct m0_sm_group *grp)
+{
+	struct m0_stob_ad_domain *adom = defrag2adom(d);
+	struct m0_stob_ad_io     *aio;
+	struct m0_stob_io         io;
+	struct m0_clink           clink;
+	struct m0_dtx             tx = {};
+	struct m0_ext             now;
+	m0_bcount_t               count = m0_ext_length(run);
+	m0_bcount_t               ucount = count;
+	m0_bindex_t               index = run->e_start;
+	uint64_t                  now_sig;
+	uint32_t                  nr;
+	void                     *addr;
+	int                       rc;
+
+	addr = m0_stob_addr_pack(d->sd_buf, m0_stob_block_shift(stob));
+	defrag_io_init(&io, stob, SIO_WRITE, &addr, &count, &ucount,
+		       &index);
+	io.si_fol_frag = &d->sd_fol_frag;
+	rc = m0_stob_io_private_setup(&io, stob);
+	if (rc != 0) {
+		m0_stob_io_fini(&io);
+		return M0_ERR(rc);
+	}
+	m0_stob_ad_balloc_set(&io, M0_BALLOC_NORMAL_ZONE);
+	aio = io.si_stob_private;
+	aio->ai_defrag = true;
+
+	m0_dtx_init(&tx, adom->sad_be_seg->bs_domain, grp);
+	m0_stob_io_credit(&io, d->sd_dom, &tx.tx_betx_cred);
+	rc = m0_dtx_open_sync(&tx);
+	if (rc == 0) {
+		m0_clink_init(&clink, NULL);
+		m0_clink_add_lock(&io.si_wait, &clink);
+		m0_rwlock_write_lock(&d->sd_paste_lock);
+		rc = m0_stob_ad_defrag_run(stob, run->e_start,
+					   m0_ext_length(run), &now, &nr,
+					   &now_sig);
+		if (rc == 0 && (now_sig != sig || !m0_ext_equal(&now, run)))
+			rc = -EAGAIN;
+		if (rc == 0)
+			rc = m0_stob_io_prepare_and_launch(&io, stob, &tx,
+							   NULL);
+		m0_rwlock_write_unlock(&d->sd_paste_lock);
+		rc = m0_dtx_done_sync(&tx) ?: rc;
+		if (rc == 0)
+			rc = defrag_io_wait(&io, &clink);
+		else {
+			m0_clink_del_lock(&clink);
+			m0_clink_fini(&clink);
+		}
+	}
+	m0_dtx_fini(&tx);
+	m0_stob_io_fini(&io);
+	return rc == -EAGAIN ? rc : M0_RC(rc);
+}
+
+/** Waits to keep the rewrite rate under sdc_rate, or until stopped. */
+static void defrag_throttle(struct m0_stob_ad_defrag *d, m0_bcount_t bytes)
+{
+	m0_time_t deadline;
+
+	if (d->sd_cfg.sdc_rate == 0)
+		return;
+	deadline = m0_time_add(m0_time_now(),
+			       bytes * M0_TIME_ONE_SECOND / d->sd_cfg.sdc_rate);
+	m0_mutex_lock(&d->sd_lock);
+	while (!d->sd_stop && m0_cond_timedwait(&d->sd_cond, deadline))
+		;
+	m0_mutex_unlock(&d->sd_lock);
+}
+
+M0_INTERNAL int m0_stob_ad_defrag_stob(struct m0_stob_ad_defrag *defrag,
+				       struct m0_stob *stob,
+				       struct m0_sm_group *grp)
+{
+	struct m0_ext run;
+	m0_bindex_t   offset = 0;
+	uint32_t      bshift = m0_stob_block_shift(stob);
+	uint32_t      nr;
+	uint64_t      sig;
+	int           rc;
+
+	M0_ENTRY("stob="FID_F, FID_P(m0_stob_fid_get(stob)));
+
+	while ((rc = m0_stob_ad_defrag_run(stob, offset,
+					   defrag->sd_cfg.sdc_chunk,
+					   &run, &nr, &sig)) == 0) {
+		offset = run.e_end;
+		if (nr < 2)
+			continue;
+		rc = defrag_read(defrag, stob, &run) ?:
+		     defrag_write(defrag, stob, &run, sig, grp);
+		if (rc == -EAGAIN)
+			continue;
+		if (rc != 0)
+			break;
+		M0_LOG(M0_DEBUG, "rewrote "EXT_F" of %u segments",
+		       EXT_P(&run), nr);
+		++defrag->sd_runs;
+		defrag->sd_blocks += m0_ext_length(&run);
+		defrag_throttle(defrag, m0_ext_length(&run) << bshift);
+		if (defrag->sd_stop)
+			break;
+	}
+	return rc == -ENOENT ? M0_RC(0) : M0_RC(rc);
+}
+
+static void defrag_fid(struct m0_stob_ad_defrag *d, const struct m0_fid *fid)
+{
+	struct m0_sm_group *grp = d->sd_cfg.sdc_sm_group;
+	struct m0_stob     *stob;
+	int                 rc;
+
+	rc = m0_stob_find_by_key(d->sd_dom, fid, &stob);
+	if (rc != 0)
+		return;
+	if (m0_stob_state_get(stob) == CSS_UNKNOWN)
+		rc = m0_stob_locate(stob);
+	if (rc == 0 && m0_stob_state_get(stob) == CSS_EXISTS) {
+		m0_sm_group_lock(grp);
+		rc = m0_stob_ad_defrag_stob(d, stob, grp);
+		m0_sm_group_unlock(grp);
+	}
+	if (rc != 0)
+		M0_LOG(M0_WARN, "stob="FID_F" rc=%d", FID_P(fid), rc);
+	m0_stob_put(stob);
+}
+
+static void defrag_thread(struct m0_stob_ad_defrag *d)
+{
+	struct m0_fid fid;
+
+	m0_mutex_lock(&d->sd_lock);
+	while (!d->sd_stop) {
+		if (d->sd_nr == 0) {
+			m0_cond_wait(&d->sd_cond);
+			continue;
+		}
+		fid = d->sd_queue[d->sd_head];
+		d->sd_head = (d->sd_head + 1) % ARRAY_SIZE(d->sd_queue);
+		--d->sd_nr;
+		m0_mutex_unlock(&d->sd_lock);
+		defrag_fid(d, &fid);
+		m0_mutex_lock(&d->sd_lock);
+	}
+	m0_mutex_unlock(&d->sd_lock);
+}
+
+M0_INTERNAL int m0_stob_ad_defrag_init(struct m0_stob_ad_defrag *defrag,
+				       struct m0_stob_domain *dom,
+				       const struct m0_stob_ad_defrag_cfg *cfg)
+{
+	struct m0_stob_ad_domain *adom = stob_ad_domain2ad(dom);
+	uint32_t                  bshift;
+	int                       rc;
+
+	M0_ENTRY();
+	M0_PRE(adom->sad_defrag == NULL);
+	M0_PRE(cfg->sdc_chunk > 0 && cfg->sdc_segs_min > 1);
+
+	M0_SET0(defrag);
+	defrag->sd_cfg = *cfg;
+	defrag->sd_dom = dom;
+	bshift = m0_stob_block_shift(adom->sad_bstore);
+	defrag->sd_buf = m0_alloc_aligned(cfg->sdc_chunk << adom->sad_bshift,
+					  bshift);
+	if (defrag->sd_buf == NULL)
+		return M0_ERR(-ENOMEM);
+	m0_mutex_init(&defrag->sd_lock);
+	m0_cond_init(&defrag->sd_cond, &defrag->sd_lock);
+	m0_rwlock_init(&defrag->sd_paste_lock);
+	rc = M0_THREAD_INIT(&defrag->sd_thread, struct m0_stob_ad_defrag *,
+			    NULL, &defrag_thread, defrag, "m0_ad_defrag");
+	if (rc != 0) {
+		m0_rwlock_fini(&defrag->sd_paste_lock);
+		m0_cond_fini(&defrag->sd_cond);
+		m0_mutex_fini(&defrag->sd_lock);
+		m0_free_aligned(defrag->sd_buf,
+				cfg->sdc_chunk << adom->sad_bshift, bshift);
+		return M0_ERR(rc);
+	}
+	adom->sad_defrag = defrag;
+	return M0_RC(0);
+}
+
+M0_INTERNAL void m0_stob_ad_defrag_fini(struct m0_stob_ad_defrag *defrag)
+{
+	struct m0_stob_ad_domain *adom = defrag2adom(defrag);
+
+	M0_ENTRY("runs=%"PRIu64" blocks=%"PRIu64,
+		 defrag->sd_runs, defrag->sd_blocks);
+	M0_PRE(adom->sad_defrag == defrag);
+
+	adom->sad_defrag = NULL;
+	m0_mutex_lock(&defrag->sd_lock);
+	defrag->sd_stop = true;
+	m0_cond_signal(&defrag->sd_cond);
+	m0_mutex_unlock(&defrag->sd_lock);
+	m0_thread_join(&defrag->sd_thread);
+	m0_thread_fini(&defrag->sd_thread);
+	m0_rwlock_fini(&defrag->sd_paste_lock);
+	m0_cond_fini(&defrag->sd_cond);
+	m0_mutex_fini(&defrag->sd_lock);
+	m0_free_aligned(defrag->sd_buf,
+			defrag->sd_cfg.sdc_chunk << adom->sad_bshift,
+			m0_stob_block_shift(adom->sad_bstore));
+	M0_LEAVE();
+}
+
+M0_INTERNAL void m0_stob_ad_defrag_add(struct m0_stob_ad_defrag *defrag,
+				       const struct m0_fid *stob_fid)
+{
+	uint32_t i;
+
+	m0_mutex_lock(&defrag->sd_lock);
+	for (i = 0; i < defrag->sd_nr; ++i) {
+		if (m0_fid_eq(&defrag->sd_queue[(defrag->sd_head + i) %
+					ARRAY_SIZE(defrag->sd_queue)],
+			      stob_fid))
+			break;
+	}
+	if (i == defrag->sd_nr && i < ARRAY_SIZE(defrag->sd_queue)) {
+		defrag->sd_queue[(defrag->sd_head + i) %
+				 ARRAY_SIZE(defrag->sd_queue)] = *stob_fid;
+		++defrag->sd_nr;
+		m0_cond_signal(&defrag->sd_cond);
+	}
+	m0_mutex_unlock(&defrag->sd_lock);
+}
+
+/** @} end group stobaddefrag */
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
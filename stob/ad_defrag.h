@@ -0,0 +1,173 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2013-2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __MOTR_STOB_AD_DEFRAG_H__
+#define __MOTR_STOB_AD_DEFRAG_H__
+
+#include "fid/fid.h"		/* m0_fid */
+#include "fol/fol.h"		/* m0_fol_frag */
+#include "lib/cond.h"		/* m0_cond */
+#include "lib/ext.h"		/* m0_ext */
+#include "lib/mutex.h"		/* m0_mutex */
+#include "lib/rwlock.h"		/* m0_rwlock */
+#include "lib/thread.h"		/* m0_thread */
+#include "lib/types.h"		/* m0_bcount_t */
+
+/**
+   @defgroup stobaddefrag Defragmentation of AD storage objects.
+   @ingroup stobad
+
+   Reads of an AD stob are split into one device I/O per allocated segment
+   of its extent map, so long-lived objects written in small pieces become
+   slow to read. Defragmentation rewrites runs of logically adjacent
+   segments: a run is read and then written back in a single transaction.
+   The write allocates new space with one balloc request and pastes one
+   segment over the run, the old segments are freed in the same
+   transaction, so the extent map is switched atomically.
+
+   Candidates are queued by the read path when a read of an object needs
+   at least m0_stob_ad_defrag_cfg::sdc_segs_min device fragments, and are
+   processed by a background thread at a limited rate.
+
+   A run is read without locks. Before it is written back the extent map
+   of the run is checked again under sd_paste_lock taken exclusively, and
+   the run is skipped if a write changed it in the meantime. Regular writes
+   of the domain take the lock shared while they update the extent map.
+
+   Segments with checksums are not rewritten.
+
+   @{
+ */
+
+struct m0_sm_group;
+struct m0_stob;
+struct m0_stob_domain;
+
+enum {
+	/** Maximal number of queued candidate stobs. */
+	M0_STOB_AD_DEFRAG_QUEUE_NR = 64,
+};
+
+struct m0_stob_ad_defrag_cfg {
+	/**
+	 * A stob is queued when a read needs at least this many device
+	 * fragments.
+	 */
+	uint32_t            sdc_segs_min;
+	/** Maximal length of a single rewrite, in blocks of the stob. */
+	m0_bcount_t         sdc_chunk;
+	/** Rewrite rate limit in bytes per second, 0 for no limit. */
+	m0_bcount_t         sdc_rate;
+	/** Group of the transactions of the background thread. */
+	struct m0_sm_group *sdc_sm_group;
+};
+
+struct m0_stob_ad_defrag {
+	struct m0_stob_ad_defrag_cfg  sd_cfg;
+	struct m0_stob_domain        *sd_dom;
+	/** Protects the queue and sd_stop. */
+	struct m0_mutex               sd_lock;
+	struct m0_cond                sd_cond;
+	struct m0_thread              sd_thread;
+	bool                          sd_stop;
+	/** Serialises extent map updates of rewrites and other writes. */
+	struct m0_rwlock              sd_paste_lock;
+	/** Ring of candidate stobs. */
+	struct m0_fid                 sd_queue[M0_STOB_AD_DEFRAG_QUEUE_NR];
+	uint32_t                      sd_head;
+	uint32_t                      sd_nr;
+	/** Buffer for a single rewrite. */
+	void                         *sd_buf;
+	/** Fol fragment of the rewrite transaction. */
+	struct m0_fol_frag            sd_fol_frag;
+	/** Number of rewritten runs. */
+	uint64_t                      sd_runs;
+	/** Number of rewritten blocks. */
+	uint64_t                      sd_blocks;
+};
+
+/**
+   Starts defragmentation of the AD domain.
+
+   Reads of the domain queue fragmented stobs from now on. No I/O should
+   be running on the domain.
+ */
+M0_INTERNAL int m0_stob_ad_defrag_init(struct m0_stob_ad_defrag *defrag,
+				       struct m0_stob_domain *dom,
+				       const struct m0_stob_ad_defrag_cfg *cfg);
+/**
+   Stops the background thread and detaches from the domain.
+
+   No I/O should be running on the domain.
+ */
+M0_INTERNAL void m0_stob_ad_defrag_fini(struct m0_stob_ad_defrag *defrag);
+
+/**
+   Queues the stob for defragmentation.
+
+   Does nothing if the stob is already queued or the queue is full.
+ */
+M0_INTERNAL void m0_stob_ad_defrag_add(struct m0_stob_ad_defrag *defrag,
+				       const struct m0_fid *stob_fid);
+
+/**
+   Rewrites all runs of adjacent segments of the stob.
+
+   Transactions belong to grp. The background thread passes sdc_sm_group
+   and locks it around each transaction. Waits according to sdc_rate after
+   each run.
+ */
+M0_INTERNAL int m0_stob_ad_defrag_stob(struct m0_stob_ad_defrag *defrag,
+				       struct m0_stob *stob,
+				       struct m0_sm_group *grp);
+
+/**
+   Finds the next run of the stob to rewrite.
+
+   Starting at offset, skips holes and segments with checksums and returns
+   in run the longest sequence of logically adjacent allocated segments, at
+   most max blocks long. segs_nr returns the number of segments in it and
+   sig a value that changes when any of these segments changes.
+
+   @retval -ENOENT there are no allocated segments after offset.
+ */
+M0_INTERNAL int m0_stob_ad_defrag_run(struct m0_stob *stob,
+				      m0_bindex_t offset, m0_bcount_t max,
+				      struct m0_ext *run, uint32_t *segs_nr,
+				      uint64_t *sig);
+
+/** @} end group stobaddefrag */
+
+/* __MOTR_STOB_AD_DEFRAG_H__ */
+#endif
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
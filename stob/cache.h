@@ -43,16 +43,20 @@ struct m0_stob_cache;
 
 typedef void (*m0_stob_cache_eviction_cb_t)(struct m0_stob_cache *cache,
 					    struct m0_stob *stob);
+enum {
+	/** Number of stob cache shards, see m0_stob_cache. */
+	M0_STOB_CACHE_SHARD_NR = 16,
+};
+
 /**
- * @todo document
+ * A shard of the stob cache: stobs whose fid hashes to the shard, protected
+ * by the shard lock.
  */
-struct m0_stob_cache {
+struct m0_stob_cache_shard {
 	struct m0_mutex             sc_lock;
 	struct m0_tl		    sc_busy;
 	struct m0_tl		    sc_idle;
-	uint64_t		    sc_idle_size;
 	uint64_t		    sc_idle_used;
-	m0_stob_cache_eviction_cb_t sc_eviction_cb;
 
 	uint64_t		    sc_busy_hits;
 	uint64_t		    sc_idle_hits;
@@ -60,11 +64,29 @@ struct m0_stob_cache {
 	uint64_t		    sc_evictions;
 };
 
+/**
+ * Stob cache of a domain.
+ *
+ * Stobs are distributed over M0_STOB_CACHE_SHARD_NR shards by fid hash, so
+ * that stobs with different fids can be found, added and released without
+ * contending for a lock. All functions operating on a stob or a stob fid
+ * require the lock of the shard of that fid, see m0_stob_cache_lock().
+ *
+ * Every shard keeps its own idle list of at most sc_idle_size stobs. Least
+ * recently released stobs of the shard are evicted first.
+ */
+struct m0_stob_cache {
+	struct m0_stob_cache_shard  sc_shard[M0_STOB_CACHE_SHARD_NR];
+	/** Maximal size of the idle list of a shard. */
+	uint64_t		    sc_idle_size;
+	m0_stob_cache_eviction_cb_t sc_eviction_cb;
+};
+
 /**
  * Initialises stob cache.
  *
  * @param cache stob cache
- * @param idle_size idle list maximum size
+ * @param idle_size idle list maximum size, it is divided between the shards
  */
 M0_INTERNAL int m0_stob_cache_init(struct m0_stob_cache *cache,
 				   uint64_t idle_size,
@@ -72,19 +94,20 @@ M0_INTERNAL int m0_stob_cache_init(struct m0_stob_cache *cache,
 M0_INTERNAL void m0_stob_cache_fini(struct m0_stob_cache *cache);
 
 /**
- * Stob cache invariant.
+ * Invariant of the stob cache shard of stob_fid.
  *
- * @pre m0_stob_cache_is_locked(cache)
- * @post m0_stob_cache_is_locked(cache)
+ * @pre m0_stob_cache_is_locked(cache, stob_fid)
+ * @post m0_stob_cache_is_locked(cache, stob_fid)
  */
-M0_INTERNAL bool m0_stob_cache__invariant(const struct m0_stob_cache *cache);
+M0_INTERNAL bool m0_stob_cache__invariant(const struct m0_stob_cache *cache,
+					  const struct m0_fid *stob_fid);
 
 /**
  * Adds stob to the stob cache. Stob should be deleted from the stob cache using
  * m0_stob_cache_idle().
  *
- * @pre m0_stob_cache_is_locked(cache)
- * @post m0_stob_cache_is_locked(cache)
+ * @pre m0_stob_cache_is_locked(cache, m0_stob_fid_get(stob))
+ * @post m0_stob_cache_is_locked(cache, m0_stob_fid_get(stob))
  */
 M0_INTERNAL void m0_stob_cache_add(struct m0_stob_cache *cache,
 				   struct m0_stob *stob);
@@ -92,8 +115,8 @@ M0_INTERNAL void m0_stob_cache_add(struct m0_stob_cache *cache,
 /**
  * Deletes item from the stob cache.
  *
- * @pre m0_stob_cache_is_locked(cache)
- * @post m0_stob_cache_is_locked(cache)
+ * @pre m0_stob_cache_is_locked(cache, m0_stob_fid_get(stob))
+ * @post m0_stob_cache_is_locked(cache, m0_stob_fid_get(stob))
  */
 M0_INTERNAL void m0_stob_cache_idle(struct m0_stob_cache *cache,
 				   struct m0_stob *stob);
@@ -102,24 +125,28 @@ M0_INTERNAL void m0_stob_cache_idle(struct m0_stob_cache *cache,
  * Finds item in the stob cache. Stob found should be deleted from the stob
  * cache using m0_stob_cache_idle().
  *
- * @pre m0_stob_cache_is_locked(cache)
- * @post m0_stob_cache_is_locked(cache)
+ * @pre m0_stob_cache_is_locked(cache, stob_fid)
+ * @post m0_stob_cache_is_locked(cache, stob_fid)
  */
 M0_INTERNAL struct m0_stob *m0_stob_cache_lookup(struct m0_stob_cache *cache,
 						 const struct m0_fid *stob_fid);
 
 /**
- * Purges at most nr items from the idle stob cache.
+ * Purges at most nr items from the idle list of every stob cache shard.
  *
- * @pre m0_stob_cache_is_not_locked(cache)
- * @post m0_stob_cache_is_not_locked(cache)
+ * @pre shards of the cache are not locked by the caller
  */
 M0_INTERNAL void m0_stob_cache_purge(struct m0_stob_cache *cache, int nr);
 
-M0_INTERNAL void m0_stob_cache_lock(struct m0_stob_cache *cache);
-M0_INTERNAL void m0_stob_cache_unlock(struct m0_stob_cache *cache);
-M0_INTERNAL bool m0_stob_cache_is_locked(const struct m0_stob_cache *cache);
-M0_INTERNAL bool m0_stob_cache_is_not_locked(const struct m0_stob_cache *cache);
+/** Locks the stob cache shard of stob_fid. */
+M0_INTERNAL void m0_stob_cache_lock(struct m0_stob_cache *cache,
+				    const struct m0_fid *stob_fid);
+M0_INTERNAL void m0_stob_cache_unlock(struct m0_stob_cache *cache,
+				      const struct m0_fid *stob_fid);
+M0_INTERNAL bool m0_stob_cache_is_locked(const struct m0_stob_cache *cache,
+					 const struct m0_fid *stob_fid);
+M0_INTERNAL bool m0_stob_cache_is_not_locked(const struct m0_stob_cache *cache,
+					     const struct m0_fid *stob_fid);
 
 M0_INTERNAL void m0_stob_cache__print(struct m0_stob_cache *cache);
 
@@ -279,6 +279,24 @@ enum m0_stob_io_flags {
 	SIF_NOHOLE       = (1 << 1),
 };
 
+/**
+   Scheduling class of an IO operation.
+
+   Storage that queues operations (see stob/ioq.c) dispatches them by class:
+   foreground operations are preferred, repair and background operations
+   get a share of the device bandwidth and have a limited number of
+   operations in flight.
+ */
+enum m0_stob_io_class {
+	/** Client IO and metadata. This is the default. */
+	SIC_FOREGROUND,
+	/** SNS repair and rebalance. */
+	SIC_REPAIR,
+	/** Scrubbing, defragmentation, trace records. */
+	SIC_BACKGROUND,
+	SIC_NR
+};
+
 /**
    Asynchronous direct IO operation against a storage object.
  */
@@ -288,6 +306,10 @@ struct m0_stob_io {
 	   Flags with which this IO operation is queued.
 	 */
 	enum m0_stob_io_flags       si_flags;
+	/**
+	   Scheduling class, SIC_FOREGROUND after m0_stob_io_init().
+	 */
+	enum m0_stob_io_class       si_class;
 	/**
 	   Where data are located in the user address space.
 
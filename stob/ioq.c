@@ -25,6 +25,7 @@
 #include "lib/trace.h"
 
 #include <limits.h>			/* IOV_MAX */
+#include <stdlib.h>			/* qsort */
 #include <sys/uio.h>			/* iovec */
 #include <libaio.h>                     /* io_getevents */
 
@@ -61,7 +62,7 @@
 
    On a high level, adieu IO request is first split into fragments. A fragment
    is initially placed into a per-domain queue (admission queue,
-   linux_domain::ioq_queue) where it is held until there is enough space in the
+   m0_stob_ioq::ioq_class) where it is held until there is enough space in the
    AIO ring buffer (linux_domain::ioq_ctx). Placing a fragment into the ring
    buffer (ioq_queue_submit()) means that kernel AIO is launched for it. When IO
    completes, the kernel delivers an IO completion event via the ring buffer.
@@ -84,6 +85,42 @@
        - potentially do some pre-processing on the pending fragments (like
          elevator does).
 
+   <b>Scheduling classes</b>
+
+   The admission queue consists of a queue per scheduling class
+   (m0_stob_io::si_class): foreground, repair and background. When a ring
+   buffer slot becomes available, ioq_queue_get() picks a class as follows:
+
+       - a class is eligible if it has queued fragments and fewer than
+         m0_stob_ioq_class::ic_inflight_max fragments in the ring buffer;
+
+       - if the oldest fragment of an eligible class has waited longer than
+         the deadline of the class, the first such class is taken;
+
+       - otherwise the eligible class with the smallest pass is taken (stride
+         scheduling). Each dispatch advances the pass of the class by a
+         stride inversely proportional to its weight, so under contention
+         classes get ring buffer slots in proportion to their weights. A
+         class that was idle does not accumulate credit: its pass is moved
+         up to the pass of the last dispatched class.
+
+   <b>Merging</b>
+
+   Fragments taken from the admission queue in one batch are sorted by file
+   and offset, and fragments of the same kind that are contiguous on the
+   file, possibly of different adieu requests, are executed by a single
+   vectored iocb (ioq_merge()). The result of the iocb is split among them on
+   completion (ioq_done()). Merging is adaptive: fragments accumulate in the
+   admission queue only while the ring buffer is full, so merging never
+   delays a fragment, and happens when the device is busy, where it is most
+   useful. m0_stob_ioq::ioq_frags and m0_stob_ioq::ioq_merged count the
+   merge rate.
+
+   With the default parameters (ioq_class_defaults[]) repair and background
+   traffic can not occupy more than a fraction of the ring buffer, so they
+   do not make foreground fragments wait behind a full device queue, and
+   the deadlines keep them from starving under foreground load.
+
    <b>Concurrency control</b>
 
    Per-domain data structures (queue, thresholds, etc.) are protected by
@@ -96,6 +133,26 @@
    implemented, because it requires synchronization between user actions
    (cancellation) and ongoing IO in SIS_BUSY state.
 
+   <b>io_uring</b>
+
+   If the domain is configured with "uring=true" (see stob/linux.c) and
+   io_uring is available, fragments are executed through io_uring(7) instead
+   of Linux AIO. The admission queue, ioq_avail accounting and worker threads
+   are the same. A domain has M0_STOB_IOQ_URING_NR io_uring instances, one per
+   worker thread. A thread submits fragments taken from the admission queue
+   to the instance of its locality, under the lock of that instance only, and
+   each worker thread reaps the completion ring of its own instance, so
+   neither submission nor reaping is serialised domain-wide. With
+   "uring_poll=true" a worker thread busy-polls its completion ring while
+   there are fragments in flight on it, which saves a system call and a
+   wakeup per completion. With "uring_sqpoll=true" the instances share a
+   kernel submission thread, so submission does not enter the kernel while
+   that thread is busy.
+
+   Buffers registered by m0_stob_ioq_buffers_register() (the ioservice
+   registers its network buffer pools) are passed to io_uring as fixed
+   buffers, which saves mapping the pages of each fragment in the kernel.
+
    @todo use explicit state machine instead of ioq threads
 
    @see http://www.kernel.org/doc/man-pages/online/pages/man2/io_setup.2.html
@@ -116,9 +173,18 @@ struct ioq_qev {
 	m0_bcount_t           iq_nbytes;
 	m0_bindex_t           iq_offset;
 	/** Linkage to a per-domain admission queue
-	    (linux_domain::ioq_queue). */
+	    (m0_stob_ioq_class::ic_queue). */
 	struct m0_queue_link  iq_linkage;
 	struct m0_stob_io    *iq_io;
+	/** Scheduling class, copied from m0_stob_io::si_class. */
+	enum m0_stob_io_class iq_class;
+	/** When the fragment was put into the admission queue. */
+	m0_time_t             iq_queued;
+	/** Next fragment merged into the same iocb, see ioq_merge(). */
+	struct ioq_qev       *iq_merged;
+	/** Own iovec array and its size while iq_iocb executes a merge. */
+	const struct iovec   *iq_vec;
+	int                   iq_vec_nr;
 };
 
 /**
@@ -140,7 +206,9 @@ struct stob_linux_io {
 static struct ioq_qev *ioq_queue_get   (struct m0_stob_ioq *ioq);
 static void            ioq_queue_put   (struct m0_stob_ioq *ioq,
 					struct ioq_qev *qev);
-static void            ioq_queue_submit(struct m0_stob_ioq *ioq);
+static void            ioq_queue_unget (struct m0_stob_ioq *ioq,
+					struct ioq_qev *qev);
+static int             ioq_queue_submit(struct m0_stob_ioq *ioq);
 static void            ioq_queue_lock  (struct m0_stob_ioq *ioq);
 static void            ioq_queue_unlock(struct m0_stob_ioq *ioq);
 
@@ -268,6 +336,9 @@ static int stob_linux_io_launch(struct m0_stob_io *io)
 		m0_bcount_t  chunk_size = 0;
 
 		qev->iq_io = io;
+		qev->iq_class = io->si_class;
+		qev->iq_merged = NULL;
+		qev->iq_vec = NULL;
 		m0_queue_link_init(&qev->iq_linkage);
 
 		iocb->u.v.vec = iov;
@@ -345,19 +416,97 @@ static const struct m0_stob_io_op stob_linux_io_op = {
 	.sio_fini    = stob_linux_io_fini
 };
 
+enum {
+	/** Pass increment of a class with weight 1. */
+	STOB_IOQ_STRIDE = 1 << 20,
+};
+
+/** Default parameters of the scheduling classes. */
+static const struct {
+	uint32_t  cd_weight;
+	uint32_t  cd_inflight_max;
+	m0_time_t cd_deadline;
+} ioq_class_defaults[SIC_NR] = {
+	[SIC_FOREGROUND] = {
+		.cd_weight       = 8,
+		.cd_inflight_max = 0,
+		.cd_deadline     = 0
+	},
+	[SIC_REPAIR]     = {
+		.cd_weight       = 2,
+		.cd_inflight_max = M0_STOB_IOQ_RING_SIZE / 4,
+		.cd_deadline     = M0_MKTIME(0, 100 * 1000 * 1000)
+	},
+	[SIC_BACKGROUND] = {
+		.cd_weight       = 1,
+		.cd_inflight_max = M0_STOB_IOQ_RING_SIZE / 8,
+		.cd_deadline     = M0_MKTIME(1, 0)
+	},
+};
+
+static struct ioq_qev *ioq_class_head(struct m0_stob_ioq_class *cl)
+{
+	return container_of(cl->ic_queue.q_head, struct ioq_qev, iq_linkage);
+}
+
+static bool ioq_class_is_eligible(struct m0_stob_ioq_class *cl)
+{
+	return cl->ic_queued > 0 &&
+	       (cl->ic_inflight_max == 0 ||
+		m0_atomic64_get(&cl->ic_inflight) < cl->ic_inflight_max);
+}
+
 /**
-   Removes an element from the (non-empty) admission queue and returns it.
+   Selects the class to dispatch the next fragment from, as described in
+   "Scheduling classes" above. Returns NULL if no class is eligible.
+ */
+static struct m0_stob_ioq_class *ioq_class_select(struct m0_stob_ioq *ioq)
+{
+	struct m0_stob_ioq_class *cl;
+	struct m0_stob_ioq_class *best = NULL;
+	m0_time_t                 now  = 0;
+	int                       i;
+
+	for (i = 0; i < ARRAY_SIZE(ioq->ioq_class); ++i) {
+		cl = &ioq->ioq_class[i];
+		if (!ioq_class_is_eligible(cl))
+			continue;
+		if (cl->ic_deadline != 0) {
+			if (now == 0)
+				now = m0_time_now();
+			if (m0_time_add(ioq_class_head(cl)->iq_queued,
+					cl->ic_deadline) < now)
+				return cl;
+		}
+		if (best == NULL || cl->ic_pass < best->ic_pass)
+			best = cl;
+	}
+	return best;
+}
+
+/**
+   Removes an element from the admission queue and returns it.
+
+   Returns NULL if the admission queue is empty or all classes with queued
+   fragments have reached their inflight limits.
  */
 static struct ioq_qev *ioq_queue_get(struct m0_stob_ioq *ioq)
 {
-	struct m0_queue_link *head;
+	struct m0_stob_ioq_class *cl;
+	struct m0_queue_link     *head;
 
-	M0_ASSERT(!m0_queue_is_empty(&ioq->ioq_queue));
 	M0_ASSERT(m0_mutex_is_locked(&ioq->ioq_lock));
 
-	head = m0_queue_get(&ioq->ioq_queue);
+	cl = ioq_class_select(ioq);
+	if (cl == NULL)
+		return NULL;
+	head = m0_queue_get(&cl->ic_queue);
+	cl->ic_queued--;
+	cl->ic_pass += STOB_IOQ_STRIDE / cl->ic_weight;
+	ioq->ioq_pass = cl->ic_pass;
 	ioq->ioq_queued--;
-	M0_ASSERT_EX(ioq->ioq_queued == m0_queue_length(&ioq->ioq_queue));
+	m0_atomic64_inc(&cl->ic_inflight);
+	M0_ASSERT_EX(cl->ic_queued == m0_queue_length(&cl->ic_queue));
 	return container_of(head, struct ioq_qev, iq_linkage);
 }
 
@@ -367,13 +516,158 @@ static struct ioq_qev *ioq_queue_get(struct m0_stob_ioq *ioq)
 static void ioq_queue_put(struct m0_stob_ioq *ioq,
 			  struct ioq_qev *qev)
 {
+	struct m0_stob_ioq_class *cl;
+
 	M0_ASSERT(!m0_queue_link_is_in(&qev->iq_linkage));
 	M0_ASSERT(m0_mutex_is_locked(&ioq->ioq_lock));
+	M0_PRE(IS_IN_ARRAY(qev->iq_class, ioq->ioq_class));
 	// M0_ASSERT(qev->iq_io->si_obj->so_domain == &ioq->sdl_base);
 
-	m0_queue_put(&ioq->ioq_queue, &qev->iq_linkage);
+	cl = &ioq->ioq_class[qev->iq_class];
+	if (cl->ic_queued == 0)
+		cl->ic_pass = max64u(cl->ic_pass, ioq->ioq_pass);
+	qev->iq_queued = m0_time_now();
+	m0_queue_put(&cl->ic_queue, &qev->iq_linkage);
+	cl->ic_queued++;
 	ioq->ioq_queued++;
-	M0_ASSERT_EX(ioq->ioq_queued == m0_queue_length(&ioq->ioq_queue));
+	M0_ASSERT_EX(cl->ic_queued == m0_queue_length(&cl->ic_queue));
+}
+
+/**
+   Restores the own iovec array of a fragment executing a merge.
+ */
+static void ioq_unmerge(struct ioq_qev *qev)
+{
+	struct iocb *iocb = &qev->iq_iocb;
+
+	if (qev->iq_vec != NULL) {
+		m0_free((void *)iocb->u.v.vec);
+		iocb->u.v.vec = (void *)qev->iq_vec;
+		iocb->u.v.nr  = qev->iq_vec_nr;
+		qev->iq_vec   = NULL;
+	}
+}
+
+/**
+   Returns to the admission queue an element returned by ioq_queue_get() and
+   not submitted, together with the elements merged into it.
+ */
+static void ioq_queue_unget(struct m0_stob_ioq *ioq,
+			    struct ioq_qev *qev)
+{
+	struct ioq_qev *next;
+
+	ioq_unmerge(qev);
+	for (; qev != NULL; qev = next) {
+		next = qev->iq_merged;
+		qev->iq_merged = NULL;
+		m0_atomic64_dec(&ioq->ioq_class[qev->iq_class].ic_inflight);
+		ioq_queue_put(ioq, qev);
+	}
+}
+
+/** Orders fragments by file and offset. */
+static bool ioq_qev_lt(const struct ioq_qev *a, const struct ioq_qev *b)
+{
+	return a->iq_iocb.aio_fildes < b->iq_iocb.aio_fildes ||
+	       (a->iq_iocb.aio_fildes == b->iq_iocb.aio_fildes &&
+		a->iq_offset < b->iq_offset);
+}
+
+/** True iff fragment b continues fragment a on the same file. */
+static bool ioq_qev_adjacent(const struct ioq_qev *a, const struct ioq_qev *b)
+{
+	return a->iq_iocb.aio_fildes == b->iq_iocb.aio_fildes &&
+	       a->iq_iocb.aio_lio_opcode == b->iq_iocb.aio_lio_opcode &&
+	       a->iq_offset + a->iq_nbytes == b->iq_offset;
+}
+
+/**
+   Makes the iocb of qev[0] execute fragments qev[0 .. nr - 1] and chains them
+   through ioq_qev::iq_merged.
+ */
+static int ioq_qev_merge(struct ioq_qev **qev, int nr, int vec_nr)
+{
+	struct iocb  *iocb = &qev[0]->iq_iocb;
+	struct iovec *vec;
+	int           done;
+	int           i;
+
+	M0_ALLOC_ARR(vec, vec_nr);
+	if (vec == NULL)
+		return M0_ERR(-ENOMEM);
+	for (i = 0, done = 0; i < nr; ++i) {
+		memcpy(vec + done, qev[i]->iq_iocb.u.v.vec,
+		       qev[i]->iq_iocb.u.v.nr * sizeof *vec);
+		done += qev[i]->iq_iocb.u.v.nr;
+		qev[i]->iq_merged = i + 1 < nr ? qev[i + 1] : NULL;
+	}
+	M0_ASSERT(done == vec_nr);
+	qev[0]->iq_vec    = iocb->u.v.vec;
+	qev[0]->iq_vec_nr = iocb->u.v.nr;
+	iocb->u.v.vec = vec;
+	iocb->u.v.nr  = vec_nr;
+	return 0;
+}
+
+/**
+   Merges contiguous fragments of a batch taken from the admission queue.
+
+   Sorts qev[0 .. nr - 1] and replaces each run of adjacent fragments with its
+   first fragment, which executes the whole run. Returns the number of
+   fragments left in qev[].
+ */
+static int ioq_merge(struct m0_stob_ioq *ioq, struct ioq_qev **qev, int nr)
+{
+	struct ioq_qev *tmp;
+	int             vec_nr;
+	int             out;
+	int             i;
+	int             j;
+
+	for (i = 1; i < nr; ++i) {
+		for (j = i; j > 0 && ioq_qev_lt(qev[j], qev[j - 1]); --j) {
+			tmp = qev[j];
+			qev[j] = qev[j - 1];
+			qev[j - 1] = tmp;
+		}
+	}
+	for (i = 0, out = 0; i < nr; i = j) {
+		vec_nr = qev[i]->iq_iocb.u.v.nr;
+		for (j = i + 1; j < nr && ioq_qev_adjacent(qev[j - 1], qev[j]) &&
+			     vec_nr + qev[j]->iq_iocb.u.v.nr <= IOV_MAX; ++j)
+			vec_nr += qev[j]->iq_iocb.u.v.nr;
+		if (j - i > 1 && ioq_qev_merge(qev + i, j - i, vec_nr) == 0) {
+			m0_atomic64_add(&ioq->ioq_merged, j - i - 1);
+			qev[out++] = qev[i];
+		} else {
+			memmove(qev + out, qev + i, (j - i) * sizeof qev[0]);
+			out += j - i;
+		}
+	}
+	m0_atomic64_add(&ioq->ioq_frags, nr);
+	return out;
+}
+
+M0_INTERNAL void m0_stob_ioq_class_setup(struct m0_stob_ioq    *ioq,
+					 enum m0_stob_io_class  cls,
+					 uint32_t               weight,
+					 uint32_t               inflight_max,
+					 m0_time_t              deadline)
+{
+	struct m0_stob_ioq_class *cl;
+
+	M0_PRE(IS_IN_ARRAY(cls, ioq->ioq_class));
+	M0_PRE(weight > 0);
+
+	cl = &ioq->ioq_class[cls];
+	ioq_queue_lock(ioq);
+	cl->ic_weight       = weight;
+	cl->ic_inflight_max = inflight_max;
+	cl->ic_deadline     = deadline;
+	ioq_queue_unlock(ioq);
+	/* A raised limit can make queued fragments eligible. */
+	ioq_queue_submit(ioq);
 }
 
 static void ioq_queue_lock(struct m0_stob_ioq *ioq)
@@ -386,46 +680,427 @@ static void ioq_queue_unlock(struct m0_stob_ioq *ioq)
 	m0_mutex_unlock(&ioq->ioq_lock);
 }
 
+enum {
+	/**
+	 * Number of times the completion ring is checked before sleeping in
+	 * M0_STOB_IOQ_URING_POLL mode.
+	 */
+	STOB_IOQ_URING_SPIN_NR = 0x1000,
+	/** Maximal size of an io_uring fixed buffer. */
+	STOB_IOQ_FIXED_MAX     = 1 << 30,
+};
+
+#ifdef HAVE_LIBURING
+
+static int stob_ioq_uring_init(struct m0_stob_ioq *ioq, bool sqpoll)
+{
+	struct m0_stob_ioq_uring *iu;
+	struct io_uring_params    params;
+	int                       rc = 0;
+	int                       i;
+
+	for (i = 0; i < ARRAY_SIZE(ioq->ioq_uring); ++i) {
+		iu = &ioq->ioq_uring[i];
+		M0_SET0(&params);
+		/*
+		 * All fragments in flight may complete on one instance, size
+		 * its completion ring for that.
+		 */
+		params.flags = IORING_SETUP_CQSIZE;
+		params.cq_entries = M0_STOB_IOQ_RING_SIZE;
+		if (sqpoll) {
+			params.flags |= IORING_SETUP_SQPOLL;
+			params.sq_thread_idle = 1000; /* ms */
+			if (i > 0) {
+				params.flags |= IORING_SETUP_ATTACH_WQ;
+				params.wq_fd = ioq->ioq_uring[0].iu_ring.ring_fd;
+			}
+		}
+		rc = io_uring_queue_init_params(M0_STOB_IOQ_RING_SIZE /
+						ARRAY_SIZE(ioq->ioq_uring),
+						&iu->iu_ring, &params);
+		if (rc != 0)
+			break;
+		/*
+		 * Without IORING_FEAT_EXT_ARG io_uring_wait_cqe_timeout()
+		 * submits a timeout request, which would race with
+		 * ioq_queue_submit().
+		 */
+		if ((params.features & IORING_FEAT_EXT_ARG) == 0) {
+			io_uring_queue_exit(&iu->iu_ring);
+			rc = -ENOSYS;
+			break;
+		}
+		m0_mutex_init(&iu->iu_lock);
+		m0_atomic64_set(&iu->iu_inflight, 0);
+	}
+	if (rc != 0) {
+		while (--i >= 0) {
+			m0_mutex_fini(&ioq->ioq_uring[i].iu_lock);
+			io_uring_queue_exit(&ioq->ioq_uring[i].iu_ring);
+		}
+		return M0_ERR(rc);
+	}
+	return M0_RC(0);
+}
+
+static void stob_ioq_uring_fini(struct m0_stob_ioq *ioq)
+{
+	int i;
+
+	m0_stob_ioq_buffers_unregister(ioq);
+	for (i = 0; i < ARRAY_SIZE(ioq->ioq_uring); ++i) {
+		m0_mutex_fini(&ioq->ioq_uring[i].iu_lock);
+		io_uring_queue_exit(&ioq->ioq_uring[i].iu_ring);
+	}
+}
+
+/**
+   Returns the io_uring instance to submit to from the current thread: the
+   own instance for a worker thread, the instance of the locality otherwise.
+ */
+static struct m0_stob_ioq_uring *stob_ioq_uring_here(struct m0_stob_ioq *ioq)
+{
+	struct m0_thread *self = m0_thread_self();
+	uint64_t          idx;
+
+	if (self >= ioq->ioq_thread &&
+	    self < ioq->ioq_thread + ARRAY_SIZE(ioq->ioq_thread))
+		idx = self - ioq->ioq_thread;
+	else
+		idx = m0_locality_here()->lo_idx;
+	return &ioq->ioq_uring[idx % ARRAY_SIZE(ioq->ioq_uring)];
+}
+
+/** Returns the index of the registered buffer containing iov, or -1. */
+static int stob_ioq_fixed_find(const struct m0_stob_ioq *ioq,
+			       const struct iovec *iov)
+{
+	const struct iovec *fixed;
+	int                 lo = 0;
+	int                 hi = ioq->ioq_fixed_nr;
+	int                 mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		fixed = &ioq->ioq_fixed[mid];
+		if (iov->iov_base < fixed->iov_base)
+			hi = mid;
+		else if (iov->iov_base >= fixed->iov_base + fixed->iov_len)
+			lo = mid + 1;
+		else
+			return iov->iov_base + iov->iov_len <=
+				fixed->iov_base + fixed->iov_len ? mid : -1;
+	}
+	return -1;
+}
+
+static void stob_ioq_uring_prep(struct m0_stob_ioq *ioq,
+				struct io_uring_sqe *sqe, struct ioq_qev *qev)
+{
+	struct iocb *iocb = &qev->iq_iocb;
+	struct iovec *iov = iocb->u.v.vec;
+	bool          read = iocb->aio_lio_opcode == IO_CMD_PREADV;
+	int           idx;
+
+	idx = iocb->u.v.nr == 1 ? stob_ioq_fixed_find(ioq, iov) : -1;
+	if (idx >= 0 && read)
+		io_uring_prep_read_fixed(sqe, iocb->aio_fildes, iov->iov_base,
+					 iov->iov_len, iocb->u.v.offset, idx);
+	else if (idx >= 0)
+		io_uring_prep_write_fixed(sqe, iocb->aio_fildes, iov->iov_base,
+					  iov->iov_len, iocb->u.v.offset, idx);
+	else if (read)
+		io_uring_prep_readv(sqe, iocb->aio_fildes, iov, iocb->u.v.nr,
+				    iocb->u.v.offset);
+	else
+		io_uring_prep_writev(sqe, iocb->aio_fildes, iov, iocb->u.v.nr,
+				     iocb->u.v.offset);
+	io_uring_sqe_set_data(sqe, qev);
+}
+
+/**
+   Moves fragments from the admission queue to the submission ring of the
+   io_uring instance of the current thread and submits them.
+
+   Only ioq_queue_get() is done under ioq_lock, the submission ring is filled
+   under the lock of the instance. If io_uring_submit() fails the entries stay
+   in the submission ring and are submitted by the next call.
+
+   Returns the number of fragments merged into others.
+ */
+static int stob_ioq_uring_submit(struct m0_stob_ioq *ioq)
+{
+	struct m0_stob_ioq_uring *iu = stob_ioq_uring_here(ioq);
+	struct ioq_qev           *qev[M0_STOB_IOQ_BATCH_IN_SIZE];
+	int                       got;
+	int                       nr;
+	int                       merged = 0;
+	int                       i;
+	int                       rc;
+
+	m0_mutex_lock(&iu->iu_lock);
+	do {
+		ioq_queue_lock(ioq);
+		nr = min32(m0_atomic64_get(&ioq->ioq_avail),
+			   min32(ARRAY_SIZE(qev),
+				 io_uring_sq_space_left(&iu->iu_ring)));
+		for (got = 0; got < nr; ++got) {
+			qev[got] = ioq_queue_get(ioq);
+			if (qev[got] == NULL)
+				break;
+		}
+		m0_atomic64_sub(&ioq->ioq_avail, got);
+		ioq_queue_unlock(ioq);
+
+		nr = got > 0 ? ioq_merge(ioq, qev, got) : 0;
+		if (nr < got)
+			m0_atomic64_add(&ioq->ioq_avail, got - nr);
+		merged += got - nr;
+		for (i = 0; i < nr; ++i)
+			stob_ioq_uring_prep(ioq, io_uring_get_sqe(&iu->iu_ring),
+					    qev[i]);
+		m0_atomic64_add(&iu->iu_inflight, nr);
+		if (io_uring_sq_ready(&iu->iu_ring) > 0) {
+			rc = io_uring_submit(&iu->iu_ring);
+			if (rc < 0)
+				M0_LOG(M0_ERROR, "got=%d rc=%d", got, rc);
+		}
+	} while (got > 0);
+	m0_mutex_unlock(&iu->iu_lock);
+	return merged;
+}
+
+/**
+   Waits for completion events in the completion ring of the io_uring
+   instance of the worker thread and returns at most @nr of them in @qev and
+   @res.
+ */
+static int stob_ioq_uring_getevents(struct m0_stob_ioq  *ioq,
+				    struct ioq_qev     **qev,
+				    long                *res,
+				    int                  nr)
+{
+	struct m0_stob_ioq_uring *iu = stob_ioq_uring_here(ioq);
+	struct io_uring_cqe      *cqe[M0_STOB_IOQ_BATCH_OUT_SIZE];
+	struct __kernel_timespec  timeout = { .tv_sec = 1 };
+	struct io_uring          *ring = &iu->iu_ring;
+	int                       got;
+	int                       rc;
+	int                       i;
+
+	M0_PRE(nr <= ARRAY_SIZE(cqe));
+
+	got = io_uring_peek_batch_cqe(ring, cqe, nr);
+	if (ioq->ioq_engine == M0_STOB_IOQ_URING_POLL) {
+		for (i = 0; got == 0 && i < STOB_IOQ_URING_SPIN_NR &&
+		     m0_atomic64_get(&iu->iu_inflight) > 0; ++i)
+			got = io_uring_peek_batch_cqe(ring, cqe, nr);
+	}
+	if (got == 0) {
+		rc = io_uring_wait_cqe_timeout(ring, cqe, &timeout);
+		if (rc == 0)
+			got = io_uring_peek_batch_cqe(ring, cqe, nr);
+		else if (!M0_IN(rc, (-ETIME, -EINTR)))
+			M0_LOG(M0_ERROR, "rc=%d", rc);
+	}
+	for (i = 0; i < got; ++i) {
+		qev[i] = io_uring_cqe_get_data(cqe[i]);
+		res[i] = cqe[i]->res;
+	}
+	io_uring_cq_advance(ring, got);
+	m0_atomic64_sub(&iu->iu_inflight, got);
+	return got;
+}
+
+static int stob_ioq_iovec_cmp(const void *a, const void *b)
+{
+	const struct iovec *va = a;
+	const struct iovec *vb = b;
+
+	return va->iov_base < vb->iov_base ? -1 :
+	       va->iov_base > vb->iov_base ? 1 : 0;
+}
+
+static void stob_ioq_uring_lock_all(struct m0_stob_ioq *ioq)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(ioq->ioq_uring); ++i)
+		m0_mutex_lock(&ioq->ioq_uring[i].iu_lock);
+}
+
+static void stob_ioq_uring_unlock_all(struct m0_stob_ioq *ioq)
+{
+	int i;
+
+	for (i = ARRAY_SIZE(ioq->ioq_uring) - 1; i >= 0; --i)
+		m0_mutex_unlock(&ioq->ioq_uring[i].iu_lock);
+}
+
+static void stob_ioq_fixed_drop(struct m0_stob_ioq *ioq, int rings_nr)
+{
+	int i;
+
+	for (i = 0; i < rings_nr; ++i)
+		io_uring_unregister_buffers(&ioq->ioq_uring[i].iu_ring);
+	m0_free0(&ioq->ioq_fixed);
+	ioq->ioq_fixed_nr = 0;
+}
+
+M0_INTERNAL int m0_stob_ioq_buffers_register(struct m0_stob_ioq     *ioq,
+					     const struct m0_bufvec *bufs)
+{
+	struct iovec *fixed;
+	uint32_t      nr;
+	uint32_t      i;
+	int           rc = 0;
+
+	if (ioq->ioq_engine == M0_STOB_IOQ_AIO)
+		return M0_RC(0);
+
+	M0_ALLOC_ARR(fixed, bufs->ov_vec.v_nr);
+	if (fixed == NULL)
+		return M0_ERR(-ENOMEM);
+	for (i = 0; i < bufs->ov_vec.v_nr; ++i) {
+		fixed[i].iov_base = bufs->ov_buf[i];
+		fixed[i].iov_len  = bufs->ov_vec.v_count[i];
+	}
+	qsort(fixed, i, sizeof fixed[0], &stob_ioq_iovec_cmp);
+	/* Merge adjacent segments, pools often allocate them packed. */
+	for (nr = 0, i = 0; i < bufs->ov_vec.v_nr; ++i) {
+		if (nr > 0 && fixed[nr - 1].iov_base + fixed[nr - 1].iov_len ==
+		    fixed[i].iov_base &&
+		    fixed[nr - 1].iov_len + fixed[i].iov_len <=
+		    STOB_IOQ_FIXED_MAX)
+			fixed[nr - 1].iov_len += fixed[i].iov_len;
+		else
+			fixed[nr++] = fixed[i];
+	}
+	nr = min32u(nr, M0_STOB_IOQ_FIXED_NR);
+
+	stob_ioq_uring_lock_all(ioq);
+	if (ioq->ioq_fixed != NULL)
+		stob_ioq_fixed_drop(ioq, ARRAY_SIZE(ioq->ioq_uring));
+	for (i = 0; i < ARRAY_SIZE(ioq->ioq_uring); ++i) {
+		rc = io_uring_register_buffers(&ioq->ioq_uring[i].iu_ring,
+					       fixed, nr);
+		if (rc != 0)
+			break;
+	}
+	ioq->ioq_fixed    = fixed;
+	ioq->ioq_fixed_nr = nr;
+	if (rc != 0) {
+		M0_LOG(M0_WARN, "io_uring buffers are not registered: "
+		       "nr=%u rc=%d", nr, rc);
+		stob_ioq_fixed_drop(ioq, i);
+	}
+	stob_ioq_uring_unlock_all(ioq);
+	return M0_RC(rc);
+}
+
+M0_INTERNAL void m0_stob_ioq_buffers_unregister(struct m0_stob_ioq *ioq)
+{
+	if (ioq->ioq_engine == M0_STOB_IOQ_AIO || ioq->ioq_fixed == NULL)
+		return;
+	stob_ioq_uring_lock_all(ioq);
+	stob_ioq_fixed_drop(ioq, ARRAY_SIZE(ioq->ioq_uring));
+	stob_ioq_uring_unlock_all(ioq);
+}
+
+#else /* HAVE_LIBURING */
+
+static int stob_ioq_uring_init(struct m0_stob_ioq *ioq, bool sqpoll)
+{
+	return M0_ERR(-ENOSYS);
+}
+
+static void stob_ioq_uring_fini(struct m0_stob_ioq *ioq)
+{
+	M0_IMPOSSIBLE("io_uring is not supported");
+}
+
+static int stob_ioq_uring_submit(struct m0_stob_ioq *ioq)
+{
+	M0_IMPOSSIBLE("io_uring is not supported");
+	return 0;
+}
+
+static int stob_ioq_uring_getevents(struct m0_stob_ioq  *ioq,
+				    struct ioq_qev     **qev,
+				    long                *res,
+				    int                  nr)
+{
+	M0_IMPOSSIBLE("io_uring is not supported");
+	return 0;
+}
+
+M0_INTERNAL int m0_stob_ioq_buffers_register(struct m0_stob_ioq     *ioq,
+					     const struct m0_bufvec *bufs)
+{
+	return M0_RC(0);
+}
+
+M0_INTERNAL void m0_stob_ioq_buffers_unregister(struct m0_stob_ioq *ioq)
+{
+}
+
+#endif /* HAVE_LIBURING */
+
 /**
    Transfers fragments from the admission queue to the ring buffer in batches
    until the ring buffer is full.
+
+   Returns the number of fragments merged into others.
  */
-static void ioq_queue_submit(struct m0_stob_ioq *ioq)
+static int ioq_queue_submit(struct m0_stob_ioq *ioq)
 {
 	int got;
 	int put;
 	int avail;
+	int nr;
+	int merged = 0;
 	int i;
 
 	struct ioq_qev  *qev[M0_STOB_IOQ_BATCH_IN_SIZE];
 	struct iocb    *evin[M0_STOB_IOQ_BATCH_IN_SIZE];
 
+	if (ioq->ioq_engine != M0_STOB_IOQ_AIO)
+		return stob_ioq_uring_submit(ioq);
 	do {
 		ioq_queue_lock(ioq);
-		avail = m0_atomic64_get(&ioq->ioq_avail);
-		got = min32(ioq->ioq_queued, min32(avail, ARRAY_SIZE(evin)));
-		m0_atomic64_sub(&ioq->ioq_avail, got);
-		for (i = 0; i < got; ++i) {
-			qev[i] = ioq_queue_get(ioq);
-			evin[i] = &qev[i]->iq_iocb;
+		avail = min32(m0_atomic64_get(&ioq->ioq_avail),
+			      ARRAY_SIZE(evin));
+		for (got = 0; got < avail; ++got) {
+			qev[got] = ioq_queue_get(ioq);
+			if (qev[got] == NULL)
+				break;
 		}
+		m0_atomic64_sub(&ioq->ioq_avail, got);
 		ioq_queue_unlock(ioq);
 
 		if (got > 0) {
-			put = io_submit(ioq->ioq_ctx, got, evin);
+			nr = ioq_merge(ioq, qev, got);
+			if (nr < got)
+				m0_atomic64_add(&ioq->ioq_avail, got - nr);
+			merged += got - nr;
+			for (i = 0; i < nr; ++i)
+				evin[i] = &qev[i]->iq_iocb;
+			put = io_submit(ioq->ioq_ctx, nr, evin);
 			if (put < 0)
-				M0_LOG(M0_ERROR, "got=%d put=%d", got, put);
+				M0_LOG(M0_ERROR, "got=%d put=%d", nr, put);
 			if (put < 0)
 				put = 0;
 			ioq_queue_lock(ioq);
-			for (i = put; i < got; ++i)
-				ioq_queue_put(ioq, qev[i]);
+			for (i = put; i < nr; ++i)
+				ioq_queue_unget(ioq, qev[i]);
 			ioq_queue_unlock(ioq);
 
-			if (got > put)
-				m0_atomic64_add(&ioq->ioq_avail, got - put);
+			if (nr > put)
+				m0_atomic64_add(&ioq->ioq_avail, nr - put);
 		}
 	} while (got > 0);
+	return merged;
 }
 
 /**
@@ -493,7 +1168,7 @@ int64_t emulate_disk_errors_nr = 0;
    m0_stob_io::si_wait.
  */
 static void ioq_complete(struct m0_stob_ioq *ioq, struct ioq_qev *qev,
-			 long res, long res2)
+			 long res)
 {
 	struct m0_stob_io    *io   = qev->iq_io;
 	struct stob_linux_io *lio  = io->si_stob_private;
@@ -593,6 +1268,30 @@ static const struct timespec ioq_timeout_default = {
 	.tv_nsec = 0
 };
 
+/**
+   Waits for AIO completion events in the ring buffer and returns at most @nr
+   of them in @qev and @res.
+ */
+static int stob_ioq_aio_getevents(struct m0_stob_ioq  *ioq,
+				  struct ioq_qev     **qev,
+				  long                *res,
+				  int                  nr)
+{
+	struct io_event evout[M0_STOB_IOQ_BATCH_OUT_SIZE];
+	struct timespec timeout = ioq_timeout_default;
+	int             got;
+	int             i;
+
+	M0_PRE(nr <= ARRAY_SIZE(evout));
+
+	got = io_getevents(ioq->ioq_ctx, 1, nr, evout, &timeout);
+	for (i = 0; i < got; ++i) {
+		qev[i] = container_of(evout[i].obj, struct ioq_qev, iq_iocb);
+		res[i] = evout[i].res;
+	}
+	return got;
+}
+
 static unsigned long stob_ioq_timer_cb(unsigned long data)
 {
 	struct m0_semaphore *stop_sem = (void *)data;
@@ -627,6 +1326,28 @@ static int stob_ioq_thread_init(struct m0_stob_ioq *ioq)
 	return M0_RC(rc);
 }
 
+/**
+   Completes the fragment executed by an iocb and the fragments merged into
+   it, splitting the result of the iocb among them.
+ */
+static void ioq_done(struct m0_stob_ioq *ioq, struct ioq_qev *qev, long res)
+{
+	struct ioq_qev *next;
+	long            part;
+
+	ioq_unmerge(qev);
+	for (; qev != NULL; qev = next) {
+		/* qev can be freed by ioq_complete(). */
+		next = qev->iq_merged;
+		qev->iq_merged = NULL;
+		part = res < 0 ? res : min64(res, qev->iq_nbytes);
+		if (res > 0)
+			res -= part;
+		m0_atomic64_dec(&ioq->ioq_class[qev->iq_class].ic_inflight);
+		ioq_complete(ioq, qev, part);
+	}
+}
+
 /**
    Linux adieu worker thread.
 
@@ -639,11 +1360,12 @@ static void stob_ioq_thread(struct m0_stob_ioq *ioq)
 	int got;
 	int avail;
 	int i;
-	struct io_event      evout[M0_STOB_IOQ_BATCH_OUT_SIZE];
-	struct timespec      timeout;
+	struct ioq_qev      *qev[M0_STOB_IOQ_BATCH_OUT_SIZE];
+	long                 res[M0_STOB_IOQ_BATCH_OUT_SIZE];
 	struct m0_addb2_hist inflight = {};
 	struct m0_addb2_hist queued   = {};
 	struct m0_addb2_hist gotten   = {};
+	struct m0_addb2_hist merges   = {};
 	int                  thread_index;
 
 	thread_index = m0_thread_self() - ioq->ioq_thread;
@@ -651,24 +1373,20 @@ static void stob_ioq_thread(struct m0_stob_ioq *ioq)
 	m0_addb2_hist_add_auto(&inflight, 1000, M0_AVI_STOB_IOQ_INFLIGHT, -1);
 	m0_addb2_hist_add_auto(&queued,   1000, M0_AVI_STOB_IOQ_QUEUED, -1);
 	m0_addb2_hist_add_auto(&gotten,   1000, M0_AVI_STOB_IOQ_GOT, -1);
+	m0_addb2_hist_add_auto(&merges,   1000, M0_AVI_STOB_IOQ_MERGED, -1);
 	while (!m0_semaphore_trydown(&ioq->ioq_stop_sem[thread_index])) {
-		timeout = ioq_timeout_default;
-		got = io_getevents(ioq->ioq_ctx, 1, ARRAY_SIZE(evout),
-				   evout, &timeout);
+		got = ioq->ioq_engine == M0_STOB_IOQ_AIO ?
+		      stob_ioq_aio_getevents(ioq, qev, res, ARRAY_SIZE(qev)) :
+		      stob_ioq_uring_getevents(ioq, qev, res, ARRAY_SIZE(qev));
 		if (got > 0) {
 			avail = m0_atomic64_add_return(&ioq->ioq_avail, got);
 			M0_ASSERT(avail <= M0_STOB_IOQ_RING_SIZE);
 		}
 		for (i = 0; i < got; ++i) {
-			struct ioq_qev  *qev;
-			struct io_event *iev;
-
-			iev = &evout[i];
-			qev = container_of(iev->obj, struct ioq_qev, iq_iocb);
-			M0_ASSERT(!m0_queue_link_is_in(&qev->iq_linkage));
-			ioq_complete(ioq, qev, iev->res, iev->res2);
+			M0_ASSERT(!m0_queue_link_is_in(&qev[i]->iq_linkage));
+			ioq_done(ioq, qev[i], res[i]);
 		}
-		ioq_queue_submit(ioq);
+		m0_addb2_hist_mod(&merges, ioq_queue_submit(ioq));
 		m0_addb2_hist_mod(&gotten, got);
 		m0_addb2_hist_mod(&queued, ioq->ioq_queued);
 		m0_addb2_hist_mod(&inflight, M0_STOB_IOQ_RING_SIZE -
@@ -683,19 +1401,56 @@ static void stob_ioq_thread(struct m0_stob_ioq *ioq)
 	m0_timer_locality_fini(&ioq->ioq_stop_timer_loc[thread_index]);
 }
 
-M0_INTERNAL int m0_stob_ioq_init(struct m0_stob_ioq *ioq)
+M0_INTERNAL int m0_stob_ioq_init(struct m0_stob_ioq      *ioq,
+				 enum m0_stob_ioq_engine  engine)
 {
-	int result;
-	int i;
+	struct m0_stob_ioq_class *cl;
+	int                       result;
+	int                       i;
 
 	ioq->ioq_ctx      = NULL;
+	ioq->ioq_engine   = M0_STOB_IOQ_AIO;
 	m0_atomic64_set(&ioq->ioq_avail, M0_STOB_IOQ_RING_SIZE);
 	ioq->ioq_queued   = 0;
-
-	m0_queue_init(&ioq->ioq_queue);
+	ioq->ioq_pass     = 0;
+	m0_atomic64_set(&ioq->ioq_frags, 0);
+	m0_atomic64_set(&ioq->ioq_merged, 0);
+
+	for (i = 0; i < ARRAY_SIZE(ioq->ioq_class); ++i) {
+		cl = &ioq->ioq_class[i];
+		m0_queue_init(&cl->ic_queue);
+		cl->ic_queued       = 0;
+		m0_atomic64_set(&cl->ic_inflight, 0);
+		cl->ic_weight       = ioq_class_defaults[i].cd_weight;
+		cl->ic_inflight_max = ioq_class_defaults[i].cd_inflight_max;
+		cl->ic_deadline     = ioq_class_defaults[i].cd_deadline;
+		cl->ic_pass         = 0;
+	}
 	m0_mutex_init(&ioq->ioq_lock);
 
-	result = io_setup(M0_STOB_IOQ_RING_SIZE, &ioq->ioq_ctx);
+	ioq->ioq_fixed    = NULL;
+	ioq->ioq_fixed_nr = 0;
+
+	if (engine == M0_STOB_IOQ_URING_SQPOLL) {
+		result = stob_ioq_uring_init(ioq, true);
+		if (result == 0)
+			ioq->ioq_engine = engine;
+		else {
+			M0_LOG(M0_WARN, "io_uring SQPOLL is not available, "
+			       "rc=%d", result);
+			engine = M0_STOB_IOQ_URING;
+		}
+	}
+	if (ioq->ioq_engine == M0_STOB_IOQ_AIO && engine != M0_STOB_IOQ_AIO) {
+		result = stob_ioq_uring_init(ioq, false);
+		if (result == 0)
+			ioq->ioq_engine = engine;
+		else
+			M0_LOG(M0_WARN, "io_uring is not available, rc=%d, "
+			       "falling back to AIO", result);
+	}
+	result = ioq->ioq_engine == M0_STOB_IOQ_AIO ?
+		 io_setup(M0_STOB_IOQ_RING_SIZE, &ioq->ioq_ctx) : 0;
 	if (result == 0) {
 		for (i = 0; i < ARRAY_SIZE(ioq->ioq_thread); ++i) {
 			result = M0_THREAD_INIT(&ioq->ioq_thread[i],
@@ -723,9 +1478,12 @@ M0_INTERNAL void m0_stob_ioq_fini(struct m0_stob_ioq *ioq)
 		if (ioq->ioq_thread[i].t_func != NULL)
 			m0_thread_join(&ioq->ioq_thread[i]);
 	}
-	if (ioq->ioq_ctx != NULL)
+	if (ioq->ioq_engine != M0_STOB_IOQ_AIO)
+		stob_ioq_uring_fini(ioq);
+	else if (ioq->ioq_ctx != NULL)
 		io_destroy(ioq->ioq_ctx);
-	m0_queue_fini(&ioq->ioq_queue);
+	for (i = 0; i < ARRAY_SIZE(ioq->ioq_class); ++i)
+		m0_queue_fini(&ioq->ioq_class[i].ic_queue);
 	m0_mutex_fini(&ioq->ioq_lock);
 }
 
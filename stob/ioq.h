@@ -26,6 +26,9 @@
 #define __MOTR_STOB_IOQ_H__
 
 #include <libaio.h>        /* io_context_t */
+#ifdef HAVE_LIBURING
+#include <liburing.h>      /* io_uring */
+#endif
 
 #include "lib/types.h"     /* bool */
 #include "lib/atomic.h"    /* m0_atomic64 */
@@ -34,6 +37,8 @@
 #include "lib/queue.h"     /* m0_queue */
 #include "lib/timer.h"     /* m0_timer */
 #include "lib/semaphore.h" /* m0_semaphore */
+#include "lib/vec.h"       /* m0_bufvec */
+#include "stob/io.h"       /* m0_stob_io_class */
 
 /**
  * @defgroup stoblinux
@@ -41,6 +46,7 @@
  * @{
  */
 
+struct iovec;
 struct m0_stob;
 struct m0_stob_io;
 
@@ -55,7 +61,70 @@ enum {
 	/** Size of a batch in which completion events are extracted from the
 	    ring buffer. */
 	M0_STOB_IOQ_BATCH_OUT_SIZE = 8,
+	/**
+	 * Number of io_uring instances of a domain. Each worker thread reaps
+	 * completions of its own instance.
+	 */
+	M0_STOB_IOQ_URING_NR       = M0_STOB_IOQ_NR_THREADS,
+	/** Maximal number of regions registered with io_uring. */
+	M0_STOB_IOQ_FIXED_NR       = 1024,
+};
+
+/** Kernel interface used by m0_stob_ioq to execute the fragments. */
+enum m0_stob_ioq_engine {
+	/** Linux AIO: io_submit(2) and io_getevents(2). */
+	M0_STOB_IOQ_AIO,
+	/** io_uring(7). */
+	M0_STOB_IOQ_URING,
+	/**
+	 * io_uring(7) with polled completion: while there are fragments in
+	 * flight, a worker thread spins on the completion ring instead of
+	 * sleeping in io_uring_enter(2).
+	 */
+	M0_STOB_IOQ_URING_POLL,
+	/**
+	 * io_uring(7) with a kernel submission thread (IORING_SETUP_SQPOLL),
+	 * shared by all io_uring instances of the domain. Submission does not
+	 * enter the kernel while the thread is busy.
+	 */
+	M0_STOB_IOQ_URING_SQPOLL,
+};
+
+/**
+ * Admission queue of a scheduling class (enum m0_stob_io_class).
+ *
+ * Fields other than ic_inflight are protected by m0_stob_ioq::ioq_lock.
+ */
+struct m0_stob_ioq_class {
+	/** Fragments of the class waiting for the ring buffer. */
+	struct m0_queue          ic_queue;
+	/** Number of fragments in ic_queue. */
+	uint32_t                 ic_queued;
+	/** Fragments of the class in the ring buffer. */
+	struct m0_atomic64       ic_inflight;
+	/** Maximal value of ic_inflight, 0 for no limit. */
+	uint32_t                 ic_inflight_max;
+	/** Share of the ring buffer slots given to the class. */
+	uint32_t                 ic_weight;
+	/**
+	 * A fragment queued for longer than this is dispatched before the
+	 * fragments of other classes. 0 for no deadline.
+	 */
+	m0_time_t                ic_deadline;
+	/** Virtual time of the class in stride scheduling. */
+	uint64_t                 ic_pass;
+};
+
+#ifdef HAVE_LIBURING
+/** io_uring instance of a domain. */
+struct m0_stob_ioq_uring {
+	struct io_uring          iu_ring;
+	/** Protects the submission ring. */
+	struct m0_mutex          iu_lock;
+	/** Number of fragments submitted and not yet reaped. */
+	struct m0_atomic64       iu_inflight;
 };
+#endif
 
 struct m0_stob_ioq {
 	/**
@@ -73,9 +142,29 @@ struct m0_stob_ioq {
 	    kernel. The kernel delivers AIO completion events through this
 	    buffer. */
 	io_context_t             ioq_ctx;
+	/**
+	 * Engine in use. It is M0_STOB_IOQ_AIO if io_uring was requested but
+	 * is not available.
+	 */
+	enum m0_stob_ioq_engine  ioq_engine;
+#ifdef HAVE_LIBURING
+	/**
+	 * io_uring instances, used instead of ioq_ctx when ioq_engine is not
+	 * M0_STOB_IOQ_AIO. A fragment is submitted to the instance of the
+	 * locality of the submitting thread.
+	 */
+	struct m0_stob_ioq_uring ioq_uring[M0_STOB_IOQ_URING_NR];
+#endif
+	/**
+	 * Buffers registered with io_uring, sorted by address. A fragment
+	 * with a single buffer inside one of them is executed as a fixed
+	 * buffer read or write. Protected by the iu_lock of all instances.
+	 */
+	struct iovec            *ioq_fixed;
+	uint32_t                 ioq_fixed_nr;
 	/** Free slots in the ring buffer. */
 	struct m0_atomic64       ioq_avail;
-	/** Used slots in the ring buffer. */
+	/** Number of fragments in the admission queue. */
 	int                      ioq_queued;
 	/** Worker threads. */
 	struct m0_thread         ioq_thread[M0_STOB_IOQ_NR_THREADS];
@@ -84,15 +173,54 @@ struct m0_stob_ioq {
 	    updated by the kernel asynchronously). */
 	struct m0_mutex          ioq_lock;
 	/** Admission queue where adieu request fragments are kept until there
-	    is free space in the ring buffer.  */
-	struct m0_queue          ioq_queue;
+	    is free space in the ring buffer, one per scheduling class.  */
+	struct m0_stob_ioq_class ioq_class[SIC_NR];
+	/** Pass of the class dispatched last. */
+	uint64_t                 ioq_pass;
+	/** Number of fragments taken from the admission queue. */
+	struct m0_atomic64       ioq_frags;
+	/**
+	 * Number of these fragments executed by the iocb of a contiguous
+	 * fragment.
+	 */
+	struct m0_atomic64       ioq_merged;
 	struct m0_semaphore      ioq_stop_sem[M0_STOB_IOQ_NR_THREADS];
 	struct m0_timer          ioq_stop_timer[M0_STOB_IOQ_NR_THREADS];
 	struct m0_timer_locality ioq_stop_timer_loc[M0_STOB_IOQ_NR_THREADS];
 };
 
-M0_INTERNAL int m0_stob_ioq_init(struct m0_stob_ioq *ioq);
+/**
+ * Initialises the queue. If @engine is not M0_STOB_IOQ_AIO and io_uring is
+ * not supported by the build or by the kernel, Linux AIO is used.
+ */
+M0_INTERNAL int m0_stob_ioq_init(struct m0_stob_ioq      *ioq,
+				 enum m0_stob_ioq_engine  engine);
 M0_INTERNAL void m0_stob_ioq_fini(struct m0_stob_ioq *ioq);
+
+/**
+ * Changes dispatch parameters of a scheduling class, see
+ * struct m0_stob_ioq_class. weight must be positive.
+ */
+M0_INTERNAL void m0_stob_ioq_class_setup(struct m0_stob_ioq    *ioq,
+					 enum m0_stob_io_class  cls,
+					 uint32_t               weight,
+					 uint32_t               inflight_max,
+					 m0_time_t              deadline);
+
+/**
+ * Registers the segments of bufs as io_uring fixed buffers. Adjacent
+ * segments are merged, at most M0_STOB_IOQ_FIXED_NR of the resulting regions
+ * are registered and the rest are used as normal buffers. Previously
+ * registered buffers are unregistered.
+ *
+ * Does nothing if the queue does not use io_uring.
+ *
+ * @note The buffers must stay allocated until m0_stob_ioq_buffers_unregister()
+ * is called.
+ */
+M0_INTERNAL int m0_stob_ioq_buffers_register(struct m0_stob_ioq     *ioq,
+					     const struct m0_bufvec *bufs);
+M0_INTERNAL void m0_stob_ioq_buffers_unregister(struct m0_stob_ioq *ioq);
 M0_INTERNAL void m0_stob_ioq_directio_setup(struct m0_stob_ioq *ioq,
 					    bool use_directio);
 
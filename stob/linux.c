@@ -71,6 +71,14 @@
    somewhere in str_cfg_init for m0_stob_domain_init() or
    m0_stob_domain_create().
 
+   <b>io_uring</b>
+
+   I/O of a stob domain is executed through io_uring(7) instead of Linux AIO
+   if "uring=true" is specified in str_cfg_init. "uring_poll=true" also makes
+   the domain poll for completions (see M0_STOB_IOQ_URING_POLL) and
+   "uring_sqpoll=true" makes it submit through a kernel thread (see
+   M0_STOB_IOQ_URING_SQPOLL). Linux AIO is used if io_uring is not available.
+
    <b>Symlinks</b>
 
    To make stob pointing to other file on the filesystem just pass filename
@@ -196,10 +204,18 @@ static int stob_linux_domain_cfg_init_parse(const char *str_cfg_init,
 			.sldc_file_mode	   = 0700,
 			.sldc_file_flags   = 0,
 			.sldc_use_directio = false,
+			.sldc_ioq_engine   = M0_STOB_IOQ_AIO,
 		};
 		if (str_cfg_init != NULL) {
 			cfg->sldc_use_directio = strstr(str_cfg_init,
 						"directio=true") != NULL;
+			cfg->sldc_ioq_engine =
+				strstr(str_cfg_init, "uring_sqpoll=true") !=
+				NULL ? M0_STOB_IOQ_URING_SQPOLL :
+				strstr(str_cfg_init, "uring_poll=true") !=
+				NULL ? M0_STOB_IOQ_URING_POLL :
+				strstr(str_cfg_init, "uring=true") != NULL ?
+				M0_STOB_IOQ_URING : M0_STOB_IOQ_AIO;
 		}
 	}
 	if (rc == 0)
@@ -246,7 +262,8 @@ static int stob_linux_domain_init(struct m0_stob_type *type,
 
 	rc = rc ?: stob_linux_domain_key_get_set(path, &dom_key, true);
 	rc = rc ?: m0_stob_domain__dom_key_is_valid(dom_key) ? 0 : -EINVAL;
-	rc = rc ?: m0_stob_ioq_init(&ldom->sld_ioq);
+	rc = rc ?: m0_stob_ioq_init(&ldom->sld_ioq,
+				    ldom->sld_cfg.sldc_ioq_engine);
 	if (rc == 0) {
 		m0_stob_ioq_directio_setup(&ldom->sld_ioq,
 					   ldom->sld_cfg.sldc_use_directio);
@@ -634,6 +651,25 @@ M0_INTERNAL bool m0_stob_linux_domain_directio(struct m0_stob_domain *dom)
 	return ldom->sld_cfg.sldc_use_directio;
 }
 
+M0_INTERNAL int m0_stob_linux_domain_buffers_register(
+					struct m0_stob_domain  *dom,
+					const struct m0_bufvec *bufs)
+{
+	M0_PRE(m0_stob_domain_is_of_type(dom, &m0_stob_linux_type));
+
+	return m0_stob_ioq_buffers_register(
+			&m0_stob_linux_domain_container(dom)->sld_ioq, bufs);
+}
+
+M0_INTERNAL void
+m0_stob_linux_domain_buffers_unregister(struct m0_stob_domain *dom)
+{
+	M0_PRE(m0_stob_domain_is_of_type(dom, &m0_stob_linux_type));
+
+	m0_stob_ioq_buffers_unregister(
+			&m0_stob_linux_domain_container(dom)->sld_ioq);
+}
+
 static struct m0_stob_type_ops stob_linux_type_ops = {
 	.sto_register                = &stob_linux_type_register,
 	.sto_deregister              = &stob_linux_type_deregister,
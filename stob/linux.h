@@ -42,6 +42,8 @@ struct m0_stob_linux_domain_cfg {
 	mode_t sldc_file_mode;
 	int    sldc_file_flags;
 	bool   sldc_use_directio;
+	/** Kernel interface used for I/O. */
+	enum m0_stob_ioq_engine sldc_ioq_engine;
 };
 
 struct m0_stob_linux_domain {
@@ -97,6 +99,17 @@ M0_INTERNAL int m0_stob_linux_domain_fd_put(struct m0_stob_domain *dom, int fd);
 
 M0_INTERNAL bool m0_stob_linux_domain_directio(struct m0_stob_domain *dom);
 
+/**
+ * Registers buffers used for I/O of the domain with its io_uring instances.
+ *
+ * @see m0_stob_ioq_buffers_register()
+ */
+M0_INTERNAL int m0_stob_linux_domain_buffers_register(
+					struct m0_stob_domain  *dom,
+					const struct m0_bufvec *bufs);
+M0_INTERNAL void
+m0_stob_linux_domain_buffers_unregister(struct m0_stob_domain *dom);
+
 extern const struct m0_stob_type m0_stob_linux_type;
 
 /** @} end group stoblinux */
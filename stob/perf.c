@@ -29,11 +29,15 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <stdio.h>        /* FILE, fopen */
+#include <stdlib.h>       /* strtoull */
 #include <unistd.h>       /* rmdir */
 
+#include "lib/arith.h"    /* m0_rnd */
+#include "lib/atomic.h"   /* m0_atomic64 */
 #include "lib/errno.h"
 #include "lib/locality.h" /* m0_locality_get */
 #include "lib/memory.h"
+#include "lib/semaphore.h" /* m0_semaphore */
 #include "lib/string.h"   /* m0_strdup */
 #include "lib/timer.h"    /* m0_timer */
 #include "stob/type.h"
@@ -89,15 +93,48 @@
  * All configuration passed to m0_stob interface is ignored here. All necessary
  * configuration is accessible via m0_stob_perf_domain::spd_cfg.
  *
- * <b> Latency emulation. </b>
+ * The configuration is a string of "key=value" options separated by
+ * commas or spaces, given to m0_stob_domain_create():
  *
- * Perfstob emulates latency using a soft timer. Latency pattern is defined by
- * a statefull callback function. Currently, there is only constant latency
- * pattern.
+ *     - null=true: don't store data;
+ *
+ *     - tmpfs_size=<MiB>: size of the tmpfs instance;
+ *
+ *     - latency=<us>: fixed latency of an operation, 1000 by default;
+ *
+ *     - jitter=<us>: maximal random latency added to the fixed latency;
+ *
+ *     - bandwidth=<MiB/s>: bandwidth of the device, unlimited by default;
+ *
+ *     - qdepth=<nr>: number of operations the device executes at the same
+ *       time, unlimited by default.
+ *
+ * <b> Device emulation. </b>
+ *
+ * A perfstob domain emulates a single device shared by all its stobs. When
+ * the linuxstob I/O of an operation completes, the operation enters the
+ * device (stob_perf_consume_io()). If spc_qdepth operations are already
+ * executing, it waits in stob_perf_domain::spd_queue for one of them to
+ * complete. An executing operation first transfers its data, transfers of
+ * the device are serialised at spc_bandwidth, and then waits for the latency
+ * returned by the latency callback: the fixed latency, possibly with a random
+ * jitter. Operations complete in the order they entered execution.
+ *
+ * Completion is emulated with a soft timer of the domain, armed at the
+ * completion time of the oldest executing operation. The timer callback
+ * posts an AST which completes all operations that are due.
  *
  * <b> Statistics. </b>
  *
- * Statistics is not implemented.
+ * The domain counts operations, bytes and latencies, see
+ * m0_stob_perf_domain_stats().
+ *
+ * <b> Benchmark. </b>
+ *
+ * m0_stob_perf_bench() keeps a given number of operations in flight against
+ * any stob which does not need transactions for I/O and reports IOPS,
+ * bandwidth and a latency histogram. Together with a perfstob domain it
+ * allows to evaluate upper layers with a model of a particular device.
  *
  * @{
  */
@@ -107,9 +144,17 @@ struct stob_perf_io;
 typedef m0_time_t (*stob_perf_latency_cb_t)(struct stob_perf_io *);
 
 struct stob_perf_domain_cfg {
+	/** Size of the tmpfs instance in MiB. */
 	size_t                 spc_tmpfs_size;
 	bool                   spc_is_null;
+	/** Fixed latency of an operation. */
 	m0_time_t              spc_latency;
+	/** Maximal random latency added to spc_latency. */
+	m0_time_t              spc_jitter;
+	/** Bandwidth in bytes per second, 0 for unlimited. */
+	uint64_t               spc_bandwidth;
+	/** Maximal number of executing operations, 0 for unlimited. */
+	uint32_t               spc_qdepth;
 	stob_perf_latency_cb_t spc_latency_cb;
 };
 
@@ -119,26 +164,32 @@ struct stob_perf_domain {
 	struct m0_stob_domain       *spd_ldom;
 	struct stob_perf_domain_cfg  spd_cfg;
 	uint64_t                     spd_magic;
-};
 
-/* XXX TODO populate with stats and store it to tmpfs periodically or on stob
- * finalisation */
-struct stob_perf_stats {
-	int unused;
+	/** Protects the device state below. */
+	struct m0_mutex              spd_lock;
+	/** Executing operations, in the order of completion. */
+	struct m0_tl                 spd_ios;
+	/** Operations waiting for a free slot of the device queue. */
+	struct m0_tl                 spd_queue;
+	/** Length of spd_ios. */
+	uint32_t                     spd_inflight;
+	/** When the device finishes data transfers of executing operations. */
+	m0_time_t                    spd_xfer_end;
+	/** Completion time of the last operation which entered execution. */
+	m0_time_t                    spd_done_last;
+	/** Seed of the jitter. */
+	uint64_t                     spd_seed;
+	struct m0_timer              spd_timer;
+	bool                         spd_timer_armed;
+	struct m0_sm_ast             spd_ast;
+	struct m0_stob_perf_stats    spd_stats;
 };
 
 struct stob_perf {
 	struct m0_stob           sp_stob;
 	struct m0_stob          *sp_backstore;
-	struct stob_perf_stats   sp_stats;
 	struct stob_perf_domain *sp_pdom;
 	uint64_t                 sp_magic;
-
-	/* List of I/Os and latency logics */
-	struct m0_tl             sp_ios;
-	struct m0_mutex          sp_lock;
-	struct m0_timer          sp_timer;
-	struct m0_sm_ast         sp_ast;
 };
 
 struct stob_perf_io {
@@ -146,8 +197,15 @@ struct stob_perf_io {
 	struct m0_stob_io  spi_lio;
 	struct stob_perf  *spi_pstob;
 	struct m0_clink    spi_clink;
+	/** Linkage to stob_perf_domain::spd_ios or spd_queue. */
 	struct m0_tlink    spi_link;
 	uint64_t           spi_magic;
+	/** Number of bytes of the operation. */
+	m0_bcount_t        spi_bytes;
+	/** When the operation was launched. */
+	m0_time_t          spi_start;
+	/** When the device completes the operation. */
+	m0_time_t          spi_done;
 };
 
 static struct m0_stob_domain_ops stob_perf_domain_ops;
@@ -155,6 +213,7 @@ static struct m0_stob_ops stob_perf_ops;
 static const struct m0_stob_io_op stob_perf_io_ops;
 
 static void stob_perf_io_completed(struct stob_perf_io *pio);
+static unsigned long stob_perf_timer_cb(unsigned long data);
 
 enum {
 	STOB_TYPE_PERF = 0xFE,
@@ -199,6 +258,15 @@ static m0_time_t stob_perf_latency_const(struct stob_perf_io *pio)
 	return pio->spi_pstob->sp_pdom->spd_cfg.spc_latency;
 }
 
+/** Called under stob_perf_domain::spd_lock. */
+static m0_time_t stob_perf_latency_jitter(struct stob_perf_io *pio)
+{
+	struct stob_perf_domain *pdom = pio->spi_pstob->sp_pdom;
+
+	return pdom->spd_cfg.spc_latency +
+	       m0_rnd(pdom->spd_cfg.spc_jitter, &pdom->spd_seed);
+}
+
 static int stob_perf_domain_cfg_init_parse(const char  *str_cfg_init,
 					   void       **cfg_init)
 {
@@ -259,22 +327,45 @@ static char *stob_perf_domain_ldom_location(const char *location_data)
 	return ldom_location;
 }
 
+/**
+ * Returns the value of option "key=<number>" of the configuration string or
+ * def if there is no such option.
+ */
+static uint64_t stob_perf_cfg_u64(const char *cfg_str, const char *key,
+				  uint64_t def)
+{
+	size_t      len = strlen(key);
+	const char *s;
+
+	for (s = cfg_str; s != NULL && (s = strstr(s, key)) != NULL; s += len) {
+		if ((s == cfg_str || strchr(", ", s[-1]) != NULL) &&
+		    s[len] == '=')
+			return strtoull(s + len + 1, NULL, 0);
+	}
+	return def;
+}
+
 static void stob_perf_domain_cfg_parse(struct stob_perf_domain_cfg *cfg,
 				       const char                  *cfg_str)
 {
-	/* XXX TODO Define config format and parse it properly. */
-
 	cfg->spc_is_null = cfg_str != NULL &&
 			   (strstr(cfg_str, "null=true") != NULL ||
 			    strstr(cfg_str, "null=1") != NULL);
-	M0_LOG(M0_DEBUG, "spc_is_null=%d", !!cfg->spc_is_null);
-
-	cfg->spc_tmpfs_size = cfg->spc_is_null ? 64 : 256; /* XXX */
-	cfg->spc_latency = M0_TIME_ONE_MSEC;
-	cfg->spc_latency_cb = &stob_perf_latency_const;
-
-	/* Don't allow latency longer than 2 seconds, it's converted to long. */
-	M0_POST(cfg->spc_latency < 2 * M0_TIME_ONE_SECOND);
+	cfg->spc_tmpfs_size = stob_perf_cfg_u64(cfg_str, "tmpfs_size",
+						cfg->spc_is_null ? 64 : 256);
+	cfg->spc_latency = stob_perf_cfg_u64(cfg_str, "latency", 1000) *
+			   M0_TIME_ONE_MSEC / 1000;
+	cfg->spc_jitter = stob_perf_cfg_u64(cfg_str, "jitter", 0) *
+			  M0_TIME_ONE_MSEC / 1000;
+	cfg->spc_bandwidth = stob_perf_cfg_u64(cfg_str, "bandwidth", 0) << 20;
+	cfg->spc_qdepth = stob_perf_cfg_u64(cfg_str, "qdepth", 0);
+	cfg->spc_latency_cb = cfg->spc_jitter == 0 ?
+			      &stob_perf_latency_const :
+			      &stob_perf_latency_jitter;
+	M0_LOG(M0_DEBUG, "spc_is_null=%d latency=%"PRIu64" jitter=%"PRIu64
+	       " bandwidth=%"PRIu64" qdepth=%"PRIu32, !!cfg->spc_is_null,
+	       cfg->spc_latency, cfg->spc_jitter, cfg->spc_bandwidth,
+	       cfg->spc_qdepth);
 }
 
 static int stob_perf_domain_read_config(struct stob_perf_domain *pdom,
@@ -380,7 +471,13 @@ static int stob_perf_domain_init(struct m0_stob_type    *type,
 
 	rc = stob_perf_domain_read_config(pdom, location_data);
 	if (rc == 0)
+		rc = m0_timer_init(&pdom->spd_timer, M0_TIMER_SOFT, NULL,
+				   &stob_perf_timer_cb, (unsigned long)pdom);
+	if (rc == 0) {
 		rc = m0_stob_domain_init(ldom_location, NULL, &pdom->spd_ldom);
+		if (rc != 0)
+			m0_timer_fini(&pdom->spd_timer);
+	}
 	M0_ASSERT(ergo(rc == 0, pdom->spd_ldom != NULL));
 
 	if (rc == 0) {
@@ -393,8 +490,13 @@ static int stob_perf_domain_init(struct m0_stob_type    *type,
 
 		pdom->spd_magic = M0_STOB_DOM_PERF_MAGIC;
 		pdom->spd_dom.sd_ops = &stob_perf_domain_ops;
+		m0_mutex_init(&pdom->spd_lock);
+		stob_perf_ios_tlist_init(&pdom->spd_ios);
+		stob_perf_ios_tlist_init(&pdom->spd_queue);
+		pdom->spd_seed = dom_key;
 		*out = &pdom->spd_dom;
-	}
+	} else
+		m0_free(pdom);
 	m0_free(ldom_location);
 
 	return M0_RC(rc);
@@ -404,6 +506,15 @@ static void stob_perf_domain_fini(struct m0_stob_domain *dom)
 {
 	struct stob_perf_domain *pdom = stob_perf_domain_container(dom);
 
+	M0_PRE(pdom->spd_inflight == 0);
+	M0_PRE(stob_perf_ios_tlist_is_empty(&pdom->spd_queue));
+
+	if (pdom->spd_timer_armed)
+		m0_timer_stop(&pdom->spd_timer);
+	m0_timer_fini(&pdom->spd_timer);
+	stob_perf_ios_tlist_fini(&pdom->spd_queue);
+	stob_perf_ios_tlist_fini(&pdom->spd_ios);
+	m0_mutex_fini(&pdom->spd_lock);
 	m0_stob_domain_fini(pdom->spd_ldom);
 	m0_free(pdom);
 }
@@ -598,51 +709,114 @@ static int stob_perf_linux_init_create(struct stob_perf_domain *pdom,
 	return M0_RC(rc);
 }
 
-static void stob_perf_timer_start(struct stob_perf    *pstob,
-				  struct stob_perf_io *pio)
+/**
+ * Arms the timer for the oldest executing operation unless it is armed.
+ * Called under stob_perf_domain::spd_lock.
+ */
+static void stob_perf_timer_start(struct stob_perf_domain *pdom)
+{
+	struct stob_perf_io *pio = stob_perf_ios_tlist_head(&pdom->spd_ios);
+
+	M0_PRE(m0_mutex_is_locked(&pdom->spd_lock));
+
+	if (pio != NULL && !pdom->spd_timer_armed) {
+		pdom->spd_timer_armed = true;
+		m0_timer_start(&pdom->spd_timer, pio->spi_done);
+	}
+}
+
+/**
+ * Starts execution of the operation on the device. Called under
+ * stob_perf_domain::spd_lock.
+ */
+static void stob_perf_dev_start(struct stob_perf_domain *pdom,
+				struct stob_perf_io     *pio,
+				m0_time_t                now)
 {
-	m0_time_t latency;
+	struct stob_perf_domain_cfg *cfg  = &pdom->spd_cfg;
+	m0_time_t                    xfer = 0;
+
+	M0_PRE(m0_mutex_is_locked(&pdom->spd_lock));
+
+	if (cfg->spc_bandwidth != 0)
+		xfer = pio->spi_bytes * M0_TIME_ONE_SECOND /
+		       cfg->spc_bandwidth;
+	pdom->spd_xfer_end = max64u(now, pdom->spd_xfer_end) + xfer;
+	pio->spi_done = max64u(pdom->spd_xfer_end + cfg->spc_latency_cb(pio),
+			       pdom->spd_done_last);
+	pdom->spd_done_last = pio->spi_done;
+	pdom->spd_inflight++;
+	stob_perf_ios_tlist_add_tail(&pdom->spd_ios, pio);
+}
 
-	latency = pstob->sp_pdom->spd_cfg.spc_latency_cb(pio);
-	m0_timer_start(&pstob->sp_timer, m0_time_from_now(0, latency));
+/**
+ * Removes the oldest executing operation if it is due and starts execution
+ * of a waiting one. Called under stob_perf_domain::spd_lock.
+ */
+static struct stob_perf_io *
+stob_perf_dev_complete(struct stob_perf_domain *pdom, m0_time_t now)
+{
+	struct m0_stob_perf_stats *stats = &pdom->spd_stats;
+	struct stob_perf_io       *pio;
+	struct stob_perf_io       *next;
+	m0_time_t                  latency;
+
+	pio = stob_perf_ios_tlist_head(&pdom->spd_ios);
+	if (pio == NULL || pio->spi_done > now)
+		return NULL;
+	stob_perf_ios_tlist_del(pio);
+	pdom->spd_inflight--;
+	next = stob_perf_ios_tlist_pop(&pdom->spd_queue);
+	if (next != NULL)
+		stob_perf_dev_start(pdom, next, now);
+
+	latency = m0_time_sub(now, pio->spi_start);
+	if (pio->spi_io->si_opcode == SIO_READ) {
+		stats->sps_reads++;
+		stats->sps_read_bytes += pio->spi_bytes;
+	} else {
+		stats->sps_writes++;
+		stats->sps_write_bytes += pio->spi_bytes;
+	}
+	stats->sps_latency += latency;
+	stats->sps_latency_max = max64u(stats->sps_latency_max, latency);
+	return pio;
 }
 
 static void stob_perf_ast_cb(struct m0_sm_group *grp, struct m0_sm_ast *ast)
 {
-	struct stob_perf    *pstob =
-				container_of(ast, struct stob_perf, sp_ast);
-	struct stob_perf_io *pio;
-	struct stob_perf_io *pio2;
+	struct stob_perf_domain *pdom =
+			container_of(ast, struct stob_perf_domain, spd_ast);
+	struct stob_perf_io     *pio;
 
-	M0_PRE(pstob == ast->sa_datum);
-	M0_PRE(pstob->sp_magic == M0_STOB_PERF_MAGIC);
+	M0_PRE(pdom == ast->sa_datum);
+	M0_PRE(pdom->spd_magic == M0_STOB_DOM_PERF_MAGIC);
 
-	m0_timer_stop(&pstob->sp_timer);
+	m0_timer_stop(&pdom->spd_timer);
 
-	m0_mutex_lock(&pstob->sp_lock);
-	pio = stob_perf_ios_tlist_pop(&pstob->sp_ios);
-	M0_ASSERT(pio != NULL);
-	if (!stob_perf_ios_tlist_is_empty(&pstob->sp_ios)) {
-		pio2 = stob_perf_ios_tlist_head(&pstob->sp_ios);
-		M0_ASSERT(pio2 != NULL);
-		stob_perf_timer_start(pstob, pio2);
+	m0_mutex_lock(&pdom->spd_lock);
+	pdom->spd_timer_armed = false;
+	while ((pio = stob_perf_dev_complete(pdom, m0_time_now())) != NULL) {
+		m0_mutex_unlock(&pdom->spd_lock);
+		stob_perf_io_completed(pio);
+		m0_mutex_lock(&pdom->spd_lock);
 	}
-	m0_mutex_unlock(&pstob->sp_lock);
-	stob_perf_io_completed(pio);
+	stob_perf_timer_start(pdom);
+	m0_mutex_unlock(&pdom->spd_lock);
 }
 
 static unsigned long stob_perf_timer_cb(unsigned long data)
 {
-	struct stob_perf   *pstob = (struct stob_perf *)data;
-	struct m0_locality *loc;
+	struct stob_perf_domain *pdom = (struct stob_perf_domain *)data;
+	struct m0_locality      *loc;
 
-	M0_PRE(pstob->sp_magic == M0_STOB_PERF_MAGIC);
+	M0_PRE(pdom->spd_magic == M0_STOB_DOM_PERF_MAGIC);
 
 	loc = m0_locality_get(data);
 	M0_ASSERT(loc != NULL);
-	pstob->sp_ast.sa_cb = &stob_perf_ast_cb;
-	pstob->sp_ast.sa_datum = pstob;
-	m0_sm_ast_post(loc->lo_grp, &pstob->sp_ast);
+	pdom->spd_ast.sa_cb = &stob_perf_ast_cb;
+	pdom->spd_ast.sa_datum = pdom;
+	m0_sm_ast_post(loc->lo_grp, &pdom->spd_ast);
 
 	return 0; /* XXX what to return here? */
 }
@@ -658,22 +832,11 @@ static int stob_perf_init(struct m0_stob        *stob,
 
 	M0_ENTRY();
 
-	rc = m0_timer_init(&pstob->sp_timer, M0_TIMER_SOFT, NULL,
-			   &stob_perf_timer_cb, (unsigned long)pstob);
-	if (rc == 0) {
-		rc = stob_perf_linux_init_create(pdom, stob_fid, NULL,
-						 false, &lstob);
-		if (rc != 0)
-			m0_timer_fini(&pstob->sp_timer);
-	}
+	rc = stob_perf_linux_init_create(pdom, stob_fid, NULL, false, &lstob);
 	if (rc == 0) {
 		stob->so_ops = &stob_perf_ops;
 		pstob->sp_pdom = pdom;
 		pstob->sp_backstore = lstob;
-		stob_perf_ios_tlist_init(&pstob->sp_ios);
-		m0_mutex_init(&pstob->sp_lock);
-		M0_SET0(&pstob->sp_ast);
-		/* XXX TODO init stats */
 	}
 	return M0_RC(rc);
 }
@@ -684,12 +847,6 @@ static void stob_perf_fini(struct m0_stob *stob)
 
 	M0_ENTRY();
 
-	/* XXX TODO dump stats? */
-
-	m0_timer_fini(&pstob->sp_timer);
-	m0_mutex_fini(&pstob->sp_lock);
-	stob_perf_ios_tlist_fini(&pstob->sp_ios);
-
 	/* Assume backstore is NULL when the stob is being destroyed. */
 	if (pstob->sp_backstore != NULL) {
 		m0_stob_put(pstob->sp_backstore);
@@ -798,13 +955,18 @@ static int stob_perf_fd(struct m0_stob *stob)
 
 static void stob_perf_consume_io(struct stob_perf_io *pio)
 {
-	struct stob_perf *pstob = pio->spi_pstob;
-
-	m0_mutex_lock(&pstob->sp_lock);
-	if (stob_perf_ios_tlist_is_empty(&pstob->sp_ios))
-		stob_perf_timer_start(pstob, pio);
-	stob_perf_ios_tlist_add_tail(&pstob->sp_ios, pio);
-	m0_mutex_unlock(&pstob->sp_lock);
+	struct stob_perf_domain *pdom = pio->spi_pstob->sp_pdom;
+	uint32_t                 qdepth = pdom->spd_cfg.spc_qdepth;
+
+	m0_mutex_lock(&pdom->spd_lock);
+	if (qdepth == 0 || pdom->spd_inflight < qdepth)
+		stob_perf_dev_start(pdom, pio, m0_time_now());
+	else {
+		stob_perf_ios_tlist_add_tail(&pdom->spd_queue, pio);
+		pdom->spd_stats.sps_queued++;
+	}
+	stob_perf_timer_start(pdom);
+	m0_mutex_unlock(&pdom->spd_lock);
 }
 
 static void stob_perf_io_completed(struct stob_perf_io *pio)
@@ -860,10 +1022,15 @@ static int stob_perf_io_launch(struct m0_stob_io *io)
 	int                  rc;
 
 	lio->si_flags  = io->si_flags;
+	lio->si_class  = io->si_class;
 	lio->si_user   = io->si_user;
 	lio->si_stob   = io->si_stob;
 	lio->si_opcode = io->si_opcode;
 
+	pio->spi_start = m0_time_now();
+	pio->spi_bytes = m0_vec_count(&io->si_user.ov_vec) <<
+			 m0_stob_block_shift(&pstob->sp_stob);
+
 	m0_clink_add_lock(&lio->si_wait, &pio->spi_clink);
 
 	rc = m0_stob_io_prepare_and_launch(lio, pstob->sp_backstore, io->si_tx,
@@ -929,6 +1096,238 @@ const struct m0_stob_type m0_stob_perf_type = {
 	},
 };
 
+M0_INTERNAL void m0_stob_perf_domain_stats(struct m0_stob_domain     *dom,
+					   struct m0_stob_perf_stats *stats)
+{
+	struct stob_perf_domain *pdom = stob_perf_domain_container(dom);
+
+	m0_mutex_lock(&pdom->spd_lock);
+	*stats = pdom->spd_stats;
+	m0_mutex_unlock(&pdom->spd_lock);
+}
+
+/** An operation slot of m0_stob_perf_bench(). */
+struct stob_perf_bench_op {
+	struct m0_stob_io    sbo_io;
+	struct m0_clink      sbo_clink;
+	struct m0_semaphore *sbo_sem;
+	/** Set by the completion callback. */
+	struct m0_atomic64   sbo_done;
+	bool                 sbo_busy;
+	void                *sbo_buf;
+	void                *sbo_addr;
+	m0_bcount_t          sbo_count;
+	m0_bindex_t          sbo_index;
+	m0_time_t            sbo_start;
+};
+
+static bool stob_perf_bench_cb(struct m0_clink *clink)
+{
+	struct stob_perf_bench_op *op =
+			container_of(clink, struct stob_perf_bench_op,
+				     sbo_clink);
+
+	m0_atomic64_set(&op->sbo_done, 1);
+	m0_semaphore_up(op->sbo_sem);
+	return true;
+}
+
+static int stob_perf_bench_launch(struct m0_stob                      *stob,
+				  const struct m0_stob_perf_bench_cfg *cfg,
+				  struct stob_perf_bench_op           *op,
+				  m0_bindex_t                          index)
+{
+	struct m0_stob_io *io = &op->sbo_io;
+	int                rc;
+
+	m0_stob_io_init(io);
+	io->si_opcode = cfg->spb_opcode;
+	io->si_flags  = 0;
+	op->sbo_count = cfg->spb_bsize;
+	op->sbo_index = index;
+	io->si_user   = M0_BUFVEC_INIT_BUF(&op->sbo_addr, &op->sbo_count);
+	io->si_stob   = (struct m0_indexvec) {
+		.iv_vec   = { .v_nr = 1, .v_count = &op->sbo_count },
+		.iv_index = &op->sbo_index,
+	};
+	m0_atomic64_set(&op->sbo_done, 0);
+	m0_clink_add_lock(&io->si_wait, &op->sbo_clink);
+	op->sbo_start = m0_time_now();
+	rc = m0_stob_io_prepare_and_launch(io, stob, NULL, NULL);
+	if (rc == 0)
+		op->sbo_busy = true;
+	else {
+		m0_clink_del_lock(&op->sbo_clink);
+		m0_stob_io_fini(io);
+	}
+	return M0_RC(rc);
+}
+
+static void stob_perf_bench_account(struct m0_stob_perf_bench_result *res,
+				    struct stob_perf_bench_op        *op,
+				    uint32_t                          bshift)
+{
+	struct m0_stob_io *io = &op->sbo_io;
+	m0_time_t          latency = m0_time_sub(m0_time_now(), op->sbo_start);
+	uint64_t           us = latency / (M0_TIME_ONE_MSEC / 1000);
+	int                i;
+
+	for (i = 0; i < M0_STOB_PERF_HIST_NR - 1 && us >= 2ULL << i; ++i)
+		;
+	res->spr_hist[i]++;
+	res->spr_ops++;
+	if (io->si_rc != 0)
+		res->spr_errors++;
+	else
+		res->spr_bytes += io->si_count << bshift;
+	res->spr_lat_avg += latency;
+	res->spr_lat_min = res->spr_ops == 1 ? latency :
+			   min64u(res->spr_lat_min, latency);
+	res->spr_lat_max = max64u(res->spr_lat_max, latency);
+	m0_clink_del_lock(&op->sbo_clink);
+	m0_stob_io_fini(io);
+	op->sbo_busy = false;
+}
+
+/** Waits for completion of an operation and accounts it. */
+static void stob_perf_bench_wait(struct m0_stob_perf_bench_result *res,
+				 struct stob_perf_bench_op        *ops,
+				 uint32_t                          nr,
+				 struct m0_semaphore              *sem,
+				 uint32_t                          bshift)
+{
+	int i;
+
+	/*
+	 * The semaphore is upped once per completion, after sbo_done is set,
+	 * so there is a completed operation which is not accounted yet.
+	 */
+	m0_semaphore_down(sem);
+	for (i = 0; i < nr; ++i) {
+		if (ops[i].sbo_busy && m0_atomic64_get(&ops[i].sbo_done) != 0) {
+			stob_perf_bench_account(res, &ops[i], bshift);
+			return;
+		}
+	}
+	M0_IMPOSSIBLE("No completed operation.");
+}
+
+/** Returns the upper bound of the bucket of the percentile pct. */
+static m0_time_t stob_perf_bench_pct(const struct m0_stob_perf_bench_result *r,
+				     uint32_t pct)
+{
+	uint64_t sum = 0;
+	int      i;
+
+	for (i = 0; i < M0_STOB_PERF_HIST_NR; ++i) {
+		sum += r->spr_hist[i];
+		if (sum * 100 >= r->spr_ops * pct)
+			break;
+	}
+	return (2ULL << min32(i, M0_STOB_PERF_HIST_NR - 1)) *
+	       (M0_TIME_ONE_MSEC / 1000);
+}
+
+M0_INTERNAL int m0_stob_perf_bench(struct m0_stob                      *stob,
+				   const struct m0_stob_perf_bench_cfg *cfg,
+				   struct m0_stob_perf_bench_result    *res)
+{
+	struct stob_perf_bench_op *ops;
+	struct m0_semaphore        sem;
+	uint32_t                   bshift = m0_stob_block_shift(stob);
+	uint64_t                   seed = cfg->spb_seed;
+	uint64_t                   launched = 0;
+	m0_bindex_t                next = 0;
+	m0_bindex_t                index;
+	m0_time_t                  start;
+	int                        busy = 0;
+	int                        rc = 0;
+	int                        i;
+
+	M0_ENTRY("qdepth=%"PRIu32" bsize=%"PRIu64" nr=%"PRIu64,
+		 cfg->spb_qdepth, cfg->spb_bsize, cfg->spb_nr);
+	M0_PRE(M0_IN(cfg->spb_opcode, (SIO_READ, SIO_WRITE)));
+	M0_PRE(cfg->spb_qdepth > 0 && cfg->spb_bsize > 0);
+	M0_PRE(cfg->spb_range >= cfg->spb_bsize);
+
+	M0_SET0(res);
+	M0_ALLOC_ARR(ops, cfg->spb_qdepth);
+	if (ops == NULL)
+		return M0_ERR(-ENOMEM);
+	m0_semaphore_init(&sem, 0);
+	for (i = 0; i < cfg->spb_qdepth; ++i) {
+		ops[i].sbo_sem = &sem;
+		m0_clink_init(&ops[i].sbo_clink, &stob_perf_bench_cb);
+	}
+	for (i = 0; i < cfg->spb_qdepth; ++i) {
+		ops[i].sbo_buf = m0_alloc_aligned(cfg->spb_bsize << bshift,
+						  bshift);
+		if (ops[i].sbo_buf == NULL) {
+			rc = M0_ERR(-ENOMEM);
+			break;
+		}
+		memset(ops[i].sbo_buf, 0x5a, cfg->spb_bsize << bshift);
+		ops[i].sbo_addr = m0_stob_addr_pack(ops[i].sbo_buf, bshift);
+	}
+	start = m0_time_now();
+	while (rc == 0 && (launched < cfg->spb_nr || busy > 0)) {
+		for (i = 0; i < cfg->spb_qdepth && launched < cfg->spb_nr;
+		     ++i) {
+			if (ops[i].sbo_busy)
+				continue;
+			if (cfg->spb_random) {
+				index = m0_rnd(cfg->spb_range / cfg->spb_bsize,
+					       &seed) * cfg->spb_bsize;
+			} else {
+				if (next + cfg->spb_bsize > cfg->spb_range)
+					next = 0;
+				index = next;
+				next += cfg->spb_bsize;
+			}
+			rc = stob_perf_bench_launch(stob, cfg, &ops[i], index);
+			if (rc != 0)
+				break;
+			++launched;
+			++busy;
+		}
+		if (rc == 0 && busy > 0) {
+			stob_perf_bench_wait(res, ops, cfg->spb_qdepth, &sem,
+					     bshift);
+			--busy;
+		}
+	}
+	/* Drain operations left in flight after an error. */
+	for (; busy > 0; --busy)
+		stob_perf_bench_wait(res, ops, cfg->spb_qdepth, &sem, bshift);
+	res->spr_elapsed = m0_time_sub(m0_time_now(), start);
+	if (res->spr_ops > 0) {
+		res->spr_lat_avg /= res->spr_ops;
+		res->spr_lat_p50 = stob_perf_bench_pct(res, 50);
+		res->spr_lat_p99 = stob_perf_bench_pct(res, 99);
+	}
+	if (res->spr_elapsed > 0) {
+		res->spr_iops = res->spr_ops * M0_TIME_ONE_SECOND /
+				res->spr_elapsed;
+		res->spr_bandwidth = res->spr_bytes * M0_TIME_ONE_SECOND /
+				     res->spr_elapsed;
+	}
+	M0_LOG(M0_INFO, "ops=%"PRIu64" errors=%"PRIu64" iops=%"PRIu64
+	       " bw=%"PRIu64" lat avg=%"PRIu64" p50=%"PRIu64" p99=%"PRIu64
+	       " max=%"PRIu64, res->spr_ops, res->spr_errors, res->spr_iops,
+	       res->spr_bandwidth, res->spr_lat_avg, res->spr_lat_p50,
+	       res->spr_lat_p99, res->spr_lat_max);
+
+	for (i = 0; i < cfg->spb_qdepth; ++i) {
+		m0_clink_fini(&ops[i].sbo_clink);
+		if (ops[i].sbo_buf != NULL)
+			m0_free_aligned(ops[i].sbo_buf,
+					cfg->spb_bsize << bshift, bshift);
+	}
+	m0_semaphore_fini(&sem);
+	m0_free(ops);
+	return M0_RC(rc);
+}
+
 /** @} end group stobperf */
 
 #undef M0_TRACE_SUBSYSTEM
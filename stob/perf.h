@@ -25,14 +25,94 @@
 #ifndef __MOTR_STOB_PERF_H__
 #define __MOTR_STOB_PERF_H__
 
+#include "lib/types.h"		/* uint64_t */
+#include "lib/time.h"		/* m0_time_t */
+#include "stob/io.h"		/* m0_stob_io_opcode */
+
 /**
  * @defgroup stobperf Storage object implementation for performance tests.
  *
  * @{
  */
 
+struct m0_stob;
+struct m0_stob_domain;
+
 extern const struct m0_stob_type m0_stob_perf_type;
 
+/** Statistics of a perfstob domain. */
+struct m0_stob_perf_stats {
+	uint64_t    sps_reads;
+	uint64_t    sps_writes;
+	m0_bcount_t sps_read_bytes;
+	m0_bcount_t sps_write_bytes;
+	/** Number of operations which waited for a free device queue slot. */
+	uint64_t    sps_queued;
+	/** Sum of the latencies of all operations. */
+	m0_time_t   sps_latency;
+	m0_time_t   sps_latency_max;
+};
+
+/** Returns the statistics of a perfstob domain. */
+M0_INTERNAL void m0_stob_perf_domain_stats(struct m0_stob_domain     *dom,
+					   struct m0_stob_perf_stats *stats);
+
+enum {
+	/** Number of buckets of the latency histogram. */
+	M0_STOB_PERF_HIST_NR = 32,
+};
+
+/** Parameters of m0_stob_perf_bench(). */
+struct m0_stob_perf_bench_cfg {
+	/** SIO_READ or SIO_WRITE. */
+	enum m0_stob_io_opcode spb_opcode;
+	/** Number of operations in flight. */
+	uint32_t               spb_qdepth;
+	/** Size of an operation in blocks of the stob. */
+	m0_bcount_t            spb_bsize;
+	/** Number of operations. */
+	uint64_t               spb_nr;
+	/** Operations are done within [0, spb_range) blocks of the stob. */
+	m0_bcount_t            spb_range;
+	/** Random offsets instead of sequential ones. */
+	bool                   spb_random;
+	uint64_t               spb_seed;
+};
+
+/** Results of m0_stob_perf_bench(). */
+struct m0_stob_perf_bench_result {
+	uint64_t    spr_ops;
+	/** Number of operations completed with an error. */
+	uint64_t    spr_errors;
+	m0_bcount_t spr_bytes;
+	m0_time_t   spr_elapsed;
+	uint64_t    spr_iops;
+	/** Bytes per second. */
+	uint64_t    spr_bandwidth;
+	m0_time_t   spr_lat_min;
+	m0_time_t   spr_lat_max;
+	m0_time_t   spr_lat_avg;
+	/** Upper bounds of the histogram buckets of the percentiles. */
+	m0_time_t   spr_lat_p50;
+	m0_time_t   spr_lat_p99;
+	/**
+	 * spr_hist[i] is the number of operations with latency in
+	 * [2^i, 2^(i+1)) microseconds, spr_hist[0] also counts shorter ones.
+	 */
+	uint64_t    spr_hist[M0_STOB_PERF_HIST_NR];
+};
+
+/**
+ * Does cfg->spb_nr operations on the stob keeping cfg->spb_qdepth of them in
+ * flight and returns the results in res.
+ *
+ * Operations are launched without a transaction, so the stob must not need
+ * one (linuxstob, perfstob).
+ */
+M0_INTERNAL int m0_stob_perf_bench(struct m0_stob                      *stob,
+				   const struct m0_stob_perf_bench_cfg *cfg,
+				   struct m0_stob_perf_bench_result    *res);
+
 /** @} end of stobperf group */
 #endif /* __MOTR_STOB_PERF_H__ */
 
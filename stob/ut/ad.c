@@ -29,6 +29,7 @@
 
 #include "dtm/dtm.h"		/* m0_dtx */
 #include "stob/ad.h"		/* m0_stob_ad_cfg_make */
+#include "stob/ad_defrag.h"	/* m0_stob_ad_defrag */
 #include "stob/ad_private.h"	/* stob_ad_domain2ad */
 #include "stob/domain.h"
 #include "stob/io.h"
@@ -125,13 +126,14 @@ static int mock_balloc_init(struct m0_ad_balloc *ballroom,
 	return 0;
 }
 
-static void mock_balloc_fini(struct m0_ad_balloc *ballroom)
+static void mock_balloc_fini(struct m0_ad_balloc *ballroom,
+			     struct m0_sm_group *grp)
 {
 }
 
 static int mock_balloc_alloc(struct m0_ad_balloc *ballroom, struct m0_dtx *dtx,
 			     m0_bcount_t count, struct m0_ext *out,
-			     uint64_t alloc_type)
+			     uint64_t alloc_type, uint64_t owner)
 {
 	struct mock_balloc *mb = b2mock(ballroom);
 	m0_bcount_t giveout;
@@ -605,6 +607,146 @@ static void test_ad_undo(void)
 
 }
 
+/** Writes block-sized pieces without checksums, one I/O per piece. */
+static void test_write_pieces(m0_bindex_t start, int nr)
+{
+	struct m0_sm_group *grp = m0_be_ut_backend_sm_group_lookup(&ut_be);
+	struct m0_fol_frag  fol_frag = {};
+	m0_bcount_t         count = buf_size >> block_shift;
+	m0_bcount_t         ucount;
+	m0_bindex_t         index;
+	void               *addr;
+	int                 i;
+	int                 rc;
+
+	for (i = 0; i < nr; ++i) {
+		m0_stob_io_init(&io);
+		ucount = count;
+		index = start + i * count;
+		addr = user_bufs[i];
+		io.si_opcode = SIO_WRITE;
+		io.si_fol_frag = &fol_frag;
+		io.si_user = M0_BUFVEC_INIT_BUF(&addr, &ucount);
+		io.si_stob.iv_vec.v_nr = 1;
+		io.si_stob.iv_vec.v_count = &count;
+		io.si_stob.iv_index = &index;
+		rc = m0_stob_io_private_setup(&io, obj_fore);
+		M0_UT_ASSERT(rc == 0);
+		m0_stob_ad_balloc_set(&io, M0_BALLOC_NORMAL_ZONE);
+		m0_clink_init(&clink, NULL);
+		m0_clink_add_lock(&io.si_wait, &clink);
+		M0_SET0(&g_tx);
+		m0_dtx_init(&g_tx, &ut_be.but_dom, grp);
+		m0_stob_io_credit(&io, dom_fore, &g_tx.tx_betx_cred);
+		rc = m0_dtx_open_sync(&g_tx);
+		M0_UT_ASSERT(rc == 0);
+		rc = m0_stob_io_prepare_and_launch(&io, obj_fore, &g_tx, NULL);
+		M0_UT_ASSERT(rc == 0);
+		rc = m0_dtx_done_sync(&g_tx);
+		M0_UT_ASSERT(rc == 0);
+		m0_dtx_fini(&g_tx);
+		m0_chan_wait(&clink);
+		M0_UT_ASSERT(io.si_rc == 0);
+		m0_clink_del_lock(&clink);
+		m0_clink_fini(&clink);
+		m0_stob_io_fini(&io);
+	}
+}
+
+/** Reads pieces written by test_write_pieces() and checks the data. */
+static void test_read_pieces(m0_bindex_t start, int nr)
+{
+	int i;
+	int rc;
+
+	for (i = 0; i < nr; ++i)
+		stob_vi[i] = start + ((i * buf_size) >> block_shift);
+	m0_stob_io_init(&io);
+	io.si_opcode = SIO_READ;
+	io.si_user.ov_vec.v_nr = nr;
+	io.si_user.ov_vec.v_count = user_vc;
+	io.si_user.ov_buf = (void **)read_bufs;
+	io.si_stob.iv_vec.v_nr = nr;
+	io.si_stob.iv_vec.v_count = stob_vc;
+	io.si_stob.iv_index = stob_vi;
+	m0_clink_init(&clink, NULL);
+	m0_clink_add_lock(&io.si_wait, &clink);
+	rc = m0_stob_io_prepare_and_launch(&io, obj_fore, NULL, NULL);
+	M0_UT_ASSERT(rc == 0);
+	m0_chan_wait(&clink);
+	M0_UT_ASSERT(io.si_rc == 0);
+	M0_UT_ASSERT(io.si_count == (nr * buf_size) >> block_shift);
+	m0_clink_del_lock(&clink);
+	m0_clink_fini(&clink);
+	m0_stob_io_fini(&io);
+	for (i = 0; i < nr; ++i)
+		M0_UT_ASSERT(memcmp(user_buf[i], read_buf[i], buf_size) == 0);
+}
+
+static void test_ad_defrag(void)
+{
+	struct m0_stob_ad_defrag_cfg cfg = {
+		.sdc_segs_min = 2,
+		.sdc_chunk    = (NR * buf_size) >> block_shift,
+		.sdc_sm_group = m0_be_ut_backend_sm_group_lookup(&ut_be),
+	};
+	struct m0_stob_ad_defrag     defrag;
+	struct m0_ext                run;
+	m0_bindex_t                  start = (NR * 4 * buf_size) >> block_shift;
+	uint32_t                     nr;
+	uint64_t                     sig;
+	int                          rc;
+
+	init_vecs();
+	test_write_pieces(start, NR);
+	rc = m0_stob_ad_defrag_run(obj_fore, start, cfg.sdc_chunk,
+				   &run, &nr, &sig);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(run.e_start == start);
+	M0_UT_ASSERT(m0_ext_length(&run) == (NR * buf_size) >> block_shift);
+	M0_UT_ASSERT(nr == NR);
+
+	rc = m0_stob_ad_defrag_init(&defrag, dom_fore, &cfg);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_stob_ad_defrag_stob(&defrag, obj_fore, cfg.sdc_sm_group);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(defrag.sd_runs > 0);
+	rc = m0_stob_ad_defrag_run(obj_fore, start, cfg.sdc_chunk,
+				   &run, &nr, &sig);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_ext_length(&run) == (NR * buf_size) >> block_shift);
+	M0_UT_ASSERT(nr == 1);
+	m0_stob_ad_defrag_fini(&defrag);
+
+	test_read_pieces(start, NR);
+}
+
+static void test_ad_seg_cache(void)
+{
+	struct m0_stob_ad *adstob = container_of(obj_fore, struct m0_stob_ad,
+						 ad_stob);
+	m0_bindex_t        start  = (NR * 8 * buf_size) >> block_shift;
+	struct m0_ext      piece  = {
+		.e_start = start,
+		.e_end   = start + (buf_size >> block_shift),
+	};
+
+	init_vecs();
+	test_write_pieces(start, 1);
+	M0_UT_ASSERT(m0_ext_is_empty(&adstob->ad_seg_ext));
+	test_read_pieces(start, 1);
+	M0_UT_ASSERT(m0_ext_equal(&adstob->ad_seg_ext, &piece));
+	/* Served from the cached segment. */
+	test_read_pieces(start, 1);
+	M0_UT_ASSERT(m0_ext_equal(&adstob->ad_seg_ext, &piece));
+
+	memset(user_buf[0], 'x', buf_size);
+	test_write_pieces(start, 1);
+	M0_UT_ASSERT(m0_ext_is_empty(&adstob->ad_seg_ext));
+	test_read_pieces(start, 1);
+	M0_UT_ASSERT(m0_ext_equal(&adstob->ad_seg_ext, &piece));
+}
+
 void m0_stob_ut_adieu_ad(void)
 {
 	int rc;
@@ -614,6 +756,8 @@ void m0_stob_ut_adieu_ad(void)
 	test_ad();
 	test_ad_rw_unordered();
 	test_ad_undo();
+	test_ad_defrag();
+	test_ad_seg_cache();
 	rc = test_ad_fini();
 	M0_ASSERT(rc == 0);
 
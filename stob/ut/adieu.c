@@ -36,6 +36,7 @@
 #include "lib/arith.h"
 #include "stob/domain.h"
 #include "stob/io.h"
+#include "stob/linux.h"   /* m0_stob_linux_domain_buffers_register */
 #include "stob/stob.h"
 #include "fol/fol.h"
 #include "balloc/balloc.h" /* M0_BALLOC_NON_SPARE_ZONE */
@@ -80,8 +81,10 @@ static struct m0_clink clink;
 static FILE *f;
 static uint32_t block_shift;
 static uint32_t buf_size;
+static enum m0_stob_io_class io_class = SIC_FOREGROUND;
 
 static int test_adieu_init(const char *location,
+			   const char *dom_init_cfg,
 			   const char *dom_cfg,
 			   const char *stob_cfg)
 {
@@ -90,8 +93,8 @@ static int test_adieu_init(const char *location,
 	struct m0_stob_id stob_id;
 	char   cs_char = 'a';
 
-	rc = m0_stob_domain_create(location,
-				   NULL, M0_STOB_UT_DOMAIN_KEY, dom_cfg, &dom);
+	rc = m0_stob_domain_create(location, dom_init_cfg,
+				   M0_STOB_UT_DOMAIN_KEY, dom_cfg, &dom);
 	M0_ASSERT(rc == 0);
 	M0_ASSERT(dom != NULL);
 
@@ -180,6 +183,7 @@ static void test_write(int i)
 
 	io.si_opcode = SIO_WRITE;
 	io.si_flags  = 0;
+	io.si_class  = io_class;
 	io.si_fol_frag = fol_frag;
 	io.si_user.ov_vec.v_nr = i;
 	io.si_user.ov_vec.v_count = user_vec;
@@ -220,6 +224,7 @@ static void test_read(int i)
 
 	io.si_opcode = SIO_READ;
 	io.si_flags  = 0;
+	io.si_class  = io_class;
 	io.si_user.ov_vec.v_nr = i;
 	io.si_user.ov_vec.v_count = user_vec;
 	io.si_user.ov_buf = (void **)read_bufs;
@@ -296,17 +301,159 @@ void m0_stob_ut_adieu_linux(void)
 {
 	int rc;
 
-	rc = test_adieu_init(linux_location, NULL, NULL);
+	rc = test_adieu_init(linux_location, NULL, NULL, NULL);
 	M0_ASSERT(rc == 0);
 	test_adieu(linux_path);
 	test_adieu_fini();
 }
 
+void m0_stob_ut_adieu_linux_uring(void)
+{
+	int rc;
+
+	/* Falls back to AIO if io_uring is not available. */
+	rc = test_adieu_init(linux_location, "uring=true", NULL, NULL);
+	M0_ASSERT(rc == 0);
+	test_adieu(linux_path);
+	test_adieu_fini();
+
+	rc = test_adieu_init(linux_location, "uring_poll=true", NULL, NULL);
+	M0_ASSERT(rc == 0);
+	test_adieu(linux_path);
+	test_adieu_fini();
+
+	rc = test_adieu_init(linux_location, "uring_sqpoll=true", NULL, NULL);
+	M0_ASSERT(rc == 0);
+	test_adieu(linux_path);
+	test_adieu_fini();
+}
+
+void m0_stob_ut_adieu_linux_uring_fixed(void)
+{
+	struct m0_bufvec bufs;
+	int              i;
+	int              rc;
+
+	rc = test_adieu_init(linux_location, "uring=true", NULL, NULL);
+	M0_ASSERT(rc == 0);
+	rc = m0_bufvec_empty_alloc(&bufs, 2 * NR);
+	M0_UT_ASSERT(rc == 0);
+	for (i = 0; i < NR; ++i) {
+		bufs.ov_buf[2 * i]     = user_buf[i];
+		bufs.ov_buf[2 * i + 1] = read_buf[i];
+		bufs.ov_vec.v_count[2 * i]     = buf_size;
+		bufs.ov_vec.v_count[2 * i + 1] = buf_size;
+	}
+	/* May fail if the memory lock limit is too low. */
+	(void)m0_stob_linux_domain_buffers_register(dom, &bufs);
+	test_adieu(linux_path);
+	m0_stob_linux_domain_buffers_unregister(dom);
+	m0_bufvec_free2(&bufs);
+	test_adieu_fini();
+}
+
+void m0_stob_ut_adieu_linux_class(void)
+{
+	struct m0_stob_ioq *ioq;
+	int                 i;
+	int                 rc;
+
+	rc = test_adieu_init(linux_location, NULL, NULL, NULL);
+	M0_ASSERT(rc == 0);
+	ioq = &m0_stob_linux_domain_container(dom)->sld_ioq;
+	for (io_class = 0; io_class < SIC_NR; ++io_class) {
+		/* One fragment in flight, immediate deadline. */
+		m0_stob_ioq_class_setup(ioq, io_class, 1, 1, 1);
+		test_adieu(linux_path);
+		m0_stob_ioq_class_setup(ioq, io_class, 1, 1, 0);
+		test_adieu(linux_path);
+	}
+	io_class = SIC_FOREGROUND;
+	for (i = 0; i < SIC_NR; ++i) {
+		M0_UT_ASSERT(ioq->ioq_class[i].ic_queued == 0);
+		M0_UT_ASSERT(m0_atomic64_get(&ioq->ioq_class[i].
+					     ic_inflight) == 0);
+	}
+	M0_UT_ASSERT(ioq->ioq_queued == 0);
+	test_adieu_fini();
+}
+
+/**
+   Queues NR single buffer writes to adjacent blocks while the ring buffer
+   is full, so that they are submitted in one batch and merged, and reads
+   the blocks back.
+ */
+static void test_adieu_merge(void)
+{
+	struct m0_stob_ioq *ioq = &m0_stob_linux_domain_container(dom)->sld_ioq;
+	struct m0_stob_io   wio[NR];
+	struct m0_clink     wclink[NR];
+	m0_bindex_t         index[NR];
+	int64_t             merged;
+	int                 i;
+	int                 rc;
+
+	merged = m0_atomic64_get(&ioq->ioq_merged);
+	m0_atomic64_set(&ioq->ioq_avail, 0);
+	for (i = 0; i < NR; ++i) {
+		index[i] = i * user_vec[i];
+		m0_stob_io_init(&wio[i]);
+		wio[i].si_opcode = SIO_WRITE;
+		wio[i].si_flags  = 0;
+		wio[i].si_user   = (struct m0_bufvec) {
+			.ov_vec = { .v_nr = 1, .v_count = &user_vec[i] },
+			.ov_buf = (void **)&user_bufs[i],
+		};
+		wio[i].si_stob   = (struct m0_indexvec) {
+			.iv_vec   = { .v_nr = 1, .v_count = &user_vec[i] },
+			.iv_index = &index[i],
+		};
+		m0_clink_init(&wclink[i], NULL);
+		m0_clink_add_lock(&wio[i].si_wait, &wclink[i]);
+		rc = m0_stob_io_prepare_and_launch(&wio[i], obj, NULL, NULL);
+		M0_UT_ASSERT(rc == 0);
+	}
+	m0_atomic64_set(&ioq->ioq_avail, M0_STOB_IOQ_RING_SIZE);
+	/* Kicks the admission queue. */
+	m0_stob_ioq_class_setup(ioq, SIC_FOREGROUND, 8, 0, 0);
+	for (i = 0; i < NR; ++i) {
+		m0_chan_wait(&wclink[i]);
+		M0_UT_ASSERT(wio[i].si_rc == 0);
+		M0_UT_ASSERT(wio[i].si_count == user_vec[i]);
+		m0_clink_del_lock(&wclink[i]);
+		m0_clink_fini(&wclink[i]);
+		m0_stob_io_fini(&wio[i]);
+	}
+	M0_UT_ASSERT(m0_atomic64_get(&ioq->ioq_merged) >= merged + NR - 1);
+
+	for (i = 0; i < NR; ++i)
+		stob_vec[i] = index[i];
+	test_read(NR);
+	for (i = 0; i < NR; ++i)
+		M0_UT_ASSERT(memcmp(user_buf[i], read_buf[i], buf_size) == 0);
+}
+
+void m0_stob_ut_adieu_linux_merge(void)
+{
+	int rc;
+
+	rc = test_adieu_init(linux_location, NULL, NULL, NULL);
+	M0_ASSERT(rc == 0);
+	test_adieu_merge();
+	test_adieu_fini();
+
+	/* Falls back to AIO if io_uring is not available. */
+	rc = test_adieu_init(linux_location, "uring=true", NULL, NULL);
+	M0_ASSERT(rc == 0);
+	test_adieu_merge();
+	test_adieu_fini();
+}
+
 void m0_stob_ut_adieu_perf(void)
 {
 	int rc;
 
-	rc = test_adieu_init(perf_location, NULL, NULL);
+	rc = test_adieu_init(perf_location, NULL, NULL, NULL);
 	M0_ASSERT(rc == 0);
 	test_adieu(perf_path);
 	test_adieu_fini();
@@ -383,7 +530,7 @@ static void ub_iovec_sort_invert()
 
 static int ub_init(const char *opts M0_UNUSED)
 {
-	return test_adieu_init(linux_location, NULL, NULL);
+	return test_adieu_init(linux_location, NULL, NULL, NULL);
 }
 
 static void ub_fini(void)
@@ -64,7 +64,7 @@ static void stob_ut_cache_thread(struct stob_ut_cache_ctx *ctx)
 		stob = &stob_ut_cache_stobs[j];
 		/* add to cache if it hasn't been added yet */
 		/* delete if it has already been added */
-		m0_stob_cache_lock(cache);
+		m0_stob_cache_lock(cache, m0_stob_fid_get(stob));
 		found = m0_stob_cache_lookup(cache, m0_stob_fid_get(stob));
 		if (found == NULL) {
 			m0_stob_cache_add(cache, stob);
@@ -80,7 +80,7 @@ static void stob_ut_cache_thread(struct stob_ut_cache_ctx *ctx)
 		 */
 		if (found != NULL && found2 != NULL)
 			m0_stob_cache_idle(cache, stob);
-		m0_stob_cache_unlock(cache);
+		m0_stob_cache_unlock(cache, m0_stob_fid_get(stob));
 		M0_UT_ASSERT(ergo(found == NULL, found2 != NULL));
 		M0_UT_ASSERT(M0_IN(stob, (found, found2)));
 	}
@@ -129,14 +129,14 @@ static void stob_ut_cache_test(size_t thread_nr,
 	M0_UT_THREADS_STOP(stob_cache);
 
 	/* clear stob cache */
-	m0_stob_cache_lock(&stob_ut_cache);
 	for (i = 0; i < ARRAY_SIZE(stob_ut_cache_stobs); ++i) {
 		stob_fid = m0_stob_fid_get(&stob_ut_cache_stobs[i]);
+		m0_stob_cache_lock(&stob_ut_cache, stob_fid);
 		stob = m0_stob_cache_lookup(&stob_ut_cache, stob_fid);
 		if (stob != NULL)
 			m0_stob_cache_idle(&stob_ut_cache, stob);
+		m0_stob_cache_unlock(&stob_ut_cache, stob_fid);
 	}
-	m0_stob_cache_unlock(&stob_ut_cache);
 
 	m0_stob_cache_fini(&stob_ut_cache);
 	m0_free(ctxs);
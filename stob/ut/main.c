@@ -33,6 +33,10 @@ extern void m0_stob_ut_stob_null(void);
 extern void m0_stob_ut_stob_domain_linux(void);
 extern void m0_stob_ut_stob_linux(void);
 extern void m0_stob_ut_adieu_linux(void);
+extern void m0_stob_ut_adieu_linux_uring(void);
+extern void m0_stob_ut_adieu_linux_uring_fixed(void);
+extern void m0_stob_ut_adieu_linux_class(void);
+extern void m0_stob_ut_adieu_linux_merge(void);
 extern void m0_stob_ut_stobio_linux(void);
 extern void m0_stob_ut_stob_domain_perf(void);
 extern void m0_stob_ut_stob_domain_perf_null(void);
@@ -40,6 +44,7 @@ extern void m0_stob_ut_stob_perf(void);
 extern void m0_stob_ut_stob_perf_null(void);
 extern void m0_stob_ut_adieu_perf(void);
 extern void m0_stob_ut_stobio_perf(void);
+extern void m0_stob_ut_perf_bench(void);
 extern void m0_stob_ut_stob_domain_ad(void);
 extern void m0_stob_ut_stob_ad(void);
 extern void m0_stob_ut_adieu_ad(void);
@@ -57,6 +62,11 @@ struct m0_ut_suite stob_ut = {
 		{ "linux-stob-domain",	m0_stob_ut_stob_domain_linux	},
 		{ "linux-stob",		m0_stob_ut_stob_linux		},
 		{ "linux-adieu",	m0_stob_ut_adieu_linux		},
+		{ "linux-adieu-uring",	m0_stob_ut_adieu_linux_uring	},
+		{ "linux-adieu-uring-fixed",
+					m0_stob_ut_adieu_linux_uring_fixed },
+		{ "linux-adieu-class",	m0_stob_ut_adieu_linux_class	},
+		{ "linux-adieu-merge",	m0_stob_ut_adieu_linux_merge	},
 		{ "linux-stobio",	m0_stob_ut_stobio_linux		},
 		{ "perf-stob-domain",	m0_stob_ut_stob_domain_perf	},
 		{ "perf-stob-domain-null", m0_stob_ut_stob_domain_perf_null },
@@ -64,6 +74,7 @@ struct m0_ut_suite stob_ut = {
 		{ "perf-stob-null",	m0_stob_ut_stob_perf_null	},
 		{ "perf-adieu",		m0_stob_ut_adieu_perf		},
 		{ "perf-stobio",	m0_stob_ut_stobio_perf		},
+		{ "perf-bench",		m0_stob_ut_perf_bench		},
 		{ "ad-stob-domain",	m0_stob_ut_stob_domain_ad	},
 		{ "ad-stob",		m0_stob_ut_stob_ad		},
 		{ "ad-adieu",		m0_stob_ut_adieu_ad		},
@@ -22,10 +22,109 @@
 
 #include "stob/perf.h"
 
+#include <stdio.h>		/* snprintf */
+
+#include "lib/arith.h"		/* min64u */
+#include "lib/time.h"		/* m0_time_t */
+#include "ut/stob.h"		/* m0_ut_stob_create */
+#include "ut/ut.h"		/* M0_UT_ASSERT */
+
 #include "stob/domain.h"
 #include "stob/io.h"
 #include "stob/stob.h"
 
+enum {
+	STOB_UT_PERF_DOM_KEY  = 0x31,
+	STOB_UT_PERF_STOB_KEY = 0x32,
+	STOB_UT_PERF_OP_SIZE  = 1 << 16,
+	STOB_UT_PERF_OP_NR    = 64,
+	STOB_UT_PERF_LATENCY  = 2000,	/* us */
+	STOB_UT_PERF_BW       = 100,	/* MiB/s */
+	STOB_UT_PERF_QDEPTH   = 4,
+};
+
+/**
+ * Runs the benchmark against a perfstob with latency, bandwidth and queue
+ * depth limits and checks that the results follow the device model.
+ */
+void m0_stob_ut_perf_bench(void)
+{
+	struct m0_stob_perf_bench_result res;
+	struct m0_stob_perf_bench_cfg    cfg;
+	struct m0_stob_perf_stats        stats;
+	struct m0_stob_domain           *dom;
+	struct m0_stob                  *stob;
+	struct m0_stob_id                stob_id;
+	char                             dom_cfg[64];
+	uint32_t                         bshift;
+	uint64_t                         max_iops;
+	m0_time_t                        latency;
+	int                              rc;
+
+	snprintf(dom_cfg, sizeof dom_cfg, "latency=%d,jitter=500,"
+		 "bandwidth=%d,qdepth=%d", STOB_UT_PERF_LATENCY,
+		 STOB_UT_PERF_BW, STOB_UT_PERF_QDEPTH);
+	rc = m0_stob_domain_create("perfstob:./__s_perf", NULL,
+				   STOB_UT_PERF_DOM_KEY, dom_cfg, &dom);
+	M0_UT_ASSERT(rc == 0);
+	m0_stob_id_make(0, STOB_UT_PERF_STOB_KEY, &dom->sd_id, &stob_id);
+	rc = m0_stob_find(&stob_id, &stob);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_stob_locate(stob);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_ut_stob_create(stob, NULL, NULL);
+	M0_UT_ASSERT(rc == 0);
+	bshift = m0_stob_block_shift(stob);
+
+	cfg = (struct m0_stob_perf_bench_cfg) {
+		.spb_opcode = SIO_WRITE,
+		/* More than the device queue depth. */
+		.spb_qdepth = 2 * STOB_UT_PERF_QDEPTH,
+		.spb_bsize  = STOB_UT_PERF_OP_SIZE >> bshift,
+		.spb_nr     = STOB_UT_PERF_OP_NR,
+		.spb_range  = (16 * STOB_UT_PERF_OP_SIZE) >> bshift,
+		.spb_random = false,
+		.spb_seed   = 1,
+	};
+	latency = STOB_UT_PERF_LATENCY * (M0_TIME_ONE_MSEC / 1000);
+	/* Bounded by the bandwidth and by the queue depth. */
+	max_iops = min64u(((uint64_t)STOB_UT_PERF_BW << 20) /
+			  STOB_UT_PERF_OP_SIZE,
+			  STOB_UT_PERF_QDEPTH * (uint64_t)M0_TIME_ONE_SECOND /
+			  latency);
+	rc = m0_stob_perf_bench(stob, &cfg, &res);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(res.spr_ops == STOB_UT_PERF_OP_NR);
+	M0_UT_ASSERT(res.spr_errors == 0);
+	M0_UT_ASSERT(res.spr_bytes ==
+		     (m0_bcount_t)STOB_UT_PERF_OP_NR * STOB_UT_PERF_OP_SIZE);
+	M0_UT_ASSERT(res.spr_lat_min >= latency);
+	M0_UT_ASSERT(res.spr_lat_min <= res.spr_lat_avg &&
+		     res.spr_lat_avg <= res.spr_lat_max);
+	M0_UT_ASSERT(res.spr_lat_p50 <= res.spr_lat_p99);
+	M0_UT_ASSERT(res.spr_iops <= max_iops);
+
+	m0_stob_perf_domain_stats(dom, &stats);
+	M0_UT_ASSERT(stats.sps_writes == STOB_UT_PERF_OP_NR);
+	M0_UT_ASSERT(stats.sps_write_bytes == res.spr_bytes);
+	M0_UT_ASSERT(stats.sps_queued > 0);
+	M0_UT_ASSERT(stats.sps_latency_max >= latency);
+
+	cfg.spb_opcode = SIO_READ;
+	cfg.spb_random = true;
+	rc = m0_stob_perf_bench(stob, &cfg, &res);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(res.spr_ops == STOB_UT_PERF_OP_NR);
+	M0_UT_ASSERT(res.spr_errors == 0);
+	M0_UT_ASSERT(res.spr_lat_min >= latency);
+	m0_stob_perf_domain_stats(dom, &stats);
+	M0_UT_ASSERT(stats.sps_reads == STOB_UT_PERF_OP_NR);
+
+	rc = m0_ut_stob_destroy(stob, NULL);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_stob_domain_destroy(dom);
+	M0_UT_ASSERT(rc == 0);
+}
 
 /*
  *  Local variables:
@@ -32,7 +32,10 @@
 extern struct m0_ub_set m0_ad_ub;
 extern struct m0_ub_set m0_adieu_ub;
 extern struct m0_ub_set m0_atomic_ub;
+extern struct m0_ub_set m0_be_tx_ub;
 extern struct m0_ub_set m0_bitmap_ub;
+extern struct m0_ub_set m0_btree_ub;
+extern struct m0_ub_set m0_cksum_ub;
 extern struct m0_ub_set m0_fol_ub;
 extern struct m0_ub_set m0_fom_ub;
 extern struct m0_ub_set m0_list_ub;
@@ -112,6 +115,9 @@ static void ub_add(const struct ub_args *args)
 	m0_ub_set_add(&m0_list_ub);
 	m0_ub_set_add(&m0_fom_ub);
 	m0_ub_set_add(&m0_fol_ub);
+	m0_ub_set_add(&m0_btree_ub);
+	m0_ub_set_add(&m0_be_tx_ub);
+	m0_ub_set_add(&m0_cksum_ub);
 //XXX_BE_DB 	m0_ub_set_add(&m0_bitmap_ub);
 //XXX_BE_DB 	m0_ub_set_add(&m0_atomic_ub);
 	m0_ub_set_add(&m0_adieu_ub);
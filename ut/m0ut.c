@@ -50,6 +50,7 @@
 extern struct m0_ut_suite libm0_ut; /* test lib first */
 extern struct m0_ut_suite addb2_base_ut;
 extern struct m0_ut_suite addb2_consumer_ut;
+extern struct m0_ut_suite addb2_export_ut;
 extern struct m0_ut_suite addb2_hist_ut;
 extern struct m0_ut_suite addb2_net_ut;
 extern struct m0_ut_suite addb2_storage_ut;
@@ -71,6 +72,10 @@ extern struct m0_ut_suite ut_suite_io_pargrp;
 extern struct m0_ut_suite ut_suite_io_req;
 extern struct m0_ut_suite ut_suite_io_req_fop;
 extern struct m0_ut_suite ut_suite_sync;
+extern struct m0_ut_suite ut_suite_wbc;
+extern struct m0_ut_suite ut_suite_ra;
+extern struct m0_ut_suite ut_suite_obj_attr_cache;
+extern struct m0_ut_suite ut_suite_obj_inline;
 extern struct m0_ut_suite ut_suite_idx;
 extern struct m0_ut_suite ut_suite_idx_dix;
 extern struct m0_ut_suite ut_suite_mt_idx_dix;
@@ -116,6 +121,7 @@ extern struct m0_ut_suite fdmi_filter_eval_ut;
 extern struct m0_ut_suite fit_ut;
 extern struct m0_ut_suite fol_ut;
 extern struct m0_ut_suite fom_timedwait_ut;
+extern struct m0_ut_suite fom_co_ut;
 extern struct m0_ut_suite frm_ut;
 extern struct m0_ut_suite ha_ut;
 extern struct m0_ut_suite ha_state_ut;
@@ -201,6 +207,7 @@ static void tests_add(struct m0_ut_module *m)
 	m0_ut_add(m, &libm0_ut, true); /* test lib first */
 	m0_ut_add(m, &addb2_base_ut, true);
 	m0_ut_add(m, &addb2_consumer_ut, true);
+	m0_ut_add(m, &addb2_export_ut, true);
 	m0_ut_add(m, &addb2_hist_ut, true);
 	m0_ut_add(m, &addb2_net_ut, true);
 	m0_ut_add(m, &addb2_storage_ut, true);
@@ -232,6 +239,10 @@ static void tests_add(struct m0_ut_module *m)
 	m0_ut_add(m, &ut_suite_io_req, true);
 	m0_ut_add(m, &ut_suite_io_req_fop, true);
 	m0_ut_add(m, &ut_suite_sync, true);
+	m0_ut_add(m, &ut_suite_wbc, true);
+	m0_ut_add(m, &ut_suite_ra, true);
+	m0_ut_add(m, &ut_suite_obj_attr_cache, true);
+	m0_ut_add(m, &ut_suite_obj_inline, true);
 	m0_ut_add(m, &ut_suite_idx, true);
 	m0_ut_add(m, &ut_suite_idx_dix, true);
 	m0_ut_add(m, &ut_suite_mt_idx_dix, true);
@@ -271,6 +282,7 @@ static void tests_add(struct m0_ut_module *m)
 	m0_ut_add(m, &fit_ut, true);
 	m0_ut_add(m, &fol_ut, true);
 	m0_ut_add(m, &fom_timedwait_ut, true);
+	m0_ut_add(m, &fom_co_ut, true);
 	m0_ut_add(m, &frm_ut, true);
 	m0_ut_add(m, &ha_ut, true);
 	m0_ut_add(m, &ha_state_ut, true);
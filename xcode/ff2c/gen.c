@@ -240,6 +240,8 @@ int ff2c_c_gen(const struct ff2c_ff *ff, const struct ff2c_gen_opt *opt)
 		type_fields(t);
 		out("\n");
 	}
+	for (t = ff->ff_type.l_head; t != NULL; t = t->t_next)
+		out("\tm0_xcode_type_flat_init(%s);\n", t->t_xc_name);
 	out("}\n"
 	    "M0_INTERNAL void m0_xc_%s_fini(void)\n{}\n", opt->go_basename);
 
@@ -34,6 +34,8 @@
 #include "ut/ut.h"
 
 #include "xcode/xcode.h"
+#include "fid/fid.h"                        /* m0_fid_arr */
+#include "fid/fid_xc.h"
 
 struct foo {
 	uint64_t f_x;
@@ -303,6 +305,11 @@ static int xcode_init(void)
 		.xf_tag    = N,
 	};
 
+	m0_xcode_type_flat_init(&xut_foo.xt);
+	m0_xcode_type_flat_init(&xut_tdef.xt);
+	m0_xcode_type_flat_init(&xut_ar.xt);
+	m0_xcode_type_flat_init(&xut_top.xt);
+
 	TD.t_foo.f_x  =  T.t_foo.f_x;
 	TD.t_foo.f_y  =  T.t_foo.f_y;
 	TD.t_flag     =  T.t_flag;
@@ -523,6 +530,65 @@ static void xcode_decode_test(void)
 	m0_xcode_free_obj(&decoded);
 }
 
+static m0_bcount_t array_offset;
+static int         array_nr;
+
+static int array_cb(struct m0_xcode_ctx *c, m0_bcount_t offset,
+		    void *addr, m0_bcount_t nob)
+{
+	M0_UT_ASSERT(addr == data);
+	M0_UT_ASSERT(nob == sizeof data);
+	array_offset = offset;
+	array_nr++;
+	return 0;
+}
+
+static void xcode_array_test(void)
+{
+	int              result;
+	m0_bcount_t      off = offsetof(struct tdata, t_v.v_data);
+	void            *bufs[3];
+	m0_bcount_t      counts[3];
+	struct m0_bufvec bv = {
+		.ov_vec = {
+			.v_nr    = ARRAY_SIZE(bufs),
+			.v_count = counts
+		},
+		.ov_buf = bufs
+	};
+
+	m0_xcode_ctx_init(&ctx, &(struct m0_xcode_obj){ &xut_top.xt, &T });
+	ctx.xcx_array     = &array_cb;
+	ctx.xcx_array_min = sizeof data + 1;
+	result = m0_xcode_length(&ctx);
+	M0_UT_ASSERT(result == sizeof TD);
+	M0_UT_ASSERT(array_nr == 0);
+
+	m0_xcode_ctx_init(&ctx, &(struct m0_xcode_obj){ &xut_top.xt, &T });
+	ctx.xcx_array     = &array_cb;
+	ctx.xcx_array_min = sizeof data;
+	result = m0_xcode_length(&ctx);
+	M0_UT_ASSERT(result == sizeof TD);
+	M0_UT_ASSERT(array_nr == 1);
+	M0_UT_ASSERT(array_offset == off);
+
+	/* The middle segment points to the array: it is not copied. */
+	memset(ebuf, 0, sizeof ebuf);
+	bufs[0]   = ebuf;
+	counts[0] = off;
+	bufs[1]   = data;
+	counts[1] = sizeof data;
+	bufs[2]   = ebuf + off + sizeof data;
+	counts[2] = sizeof TD - off - sizeof data;
+	m0_xcode_ctx_init(&ctx, &(struct m0_xcode_obj){ &xut_top.xt, &T });
+	m0_bufvec_cursor_init(&ctx.xcx_buf, &bv);
+	result = m0_xcode_encode(&ctx);
+	M0_UT_ASSERT(result == 0);
+	M0_UT_ASSERT(m0_forall(i, sizeof data, ebuf[off + i] == 0));
+	memcpy(ebuf + off, data, sizeof data);
+	M0_UT_ASSERT(memcmp(&TD, ebuf, sizeof TD) == 0);
+}
+
 enum {
 	FSIZE = sizeof(uint64_t) + sizeof(uint64_t)
 };
@@ -581,6 +647,8 @@ static void xcode_nonstandard_test(void)
 	int i;
 
 	xut_foo.xt.xct_ops = &foo_ops;
+	m0_xcode_type_flat_init(&xut_ar.xt);
+	M0_UT_ASSERT(!m0_xcode_type_is_flat(&xut_ar.xt));
 
 	m0_xcode_ctx_init(&ctx, &(struct m0_xcode_obj){ &xut_top.xt, &T });
 	result = m0_xcode_length(&ctx);
@@ -600,6 +668,81 @@ static void xcode_nonstandard_test(void)
 		foo_xor((void *)&((struct tdata *)ebuf)->t_ar.a_el[i]);
 	xcode_decode_test();
 	xut_foo.xt.xct_ops = NULL;
+	m0_xcode_type_flat_init(&xut_ar.xt);
+}
+
+static int iter_nr;
+
+static int iter_cb(const struct m0_xcode_cursor *it)
+{
+	iter_nr++;
+	return 0;
+}
+
+static void xcode_flat_test(void)
+{
+	int result;
+	int nr;
+
+	M0_UT_ASSERT(m0_xcode_type_is_flat(&M0_XT_U64));
+	M0_UT_ASSERT(m0_xcode_type_is_flat(&xut_foo.xt));
+	M0_UT_ASSERT(m0_xcode_type_is_flat(&xut_tdef.xt));
+	M0_UT_ASSERT(m0_xcode_type_is_flat(&xut_ar.xt));
+	M0_UT_ASSERT(!m0_xcode_type_is_flat(&xut_v.xt));
+	M0_UT_ASSERT(!m0_xcode_type_is_flat(&xut_un.xt));
+	M0_UT_ASSERT(!m0_xcode_type_is_flat(&xut_top.xt));
+
+	/* Iteration call-back sees every field of flat objects. */
+	m0_xcode_ctx_init(&ctx, &(struct m0_xcode_obj){ &xut_top.xt, &T });
+	ctx.xcx_iter = &iter_cb;
+	result = m0_xcode_length(&ctx);
+	M0_UT_ASSERT(result == sizeof TD);
+	nr = iter_nr;
+	M0_UT_ASSERT(nr > N * 3);
+
+	m0_xcode_ctx_init(&ctx, &(struct m0_xcode_obj){ &xut_top.xt, &T });
+	ctx.xcx_iter = &iter_cb;
+	m0_bufvec_cursor_init(&ctx.xcx_buf, &bvec);
+	result = m0_xcode_encode(&ctx);
+	M0_UT_ASSERT(result == 0);
+	M0_UT_ASSERT(iter_nr == 2 * nr);
+	M0_UT_ASSERT(memcmp(&TD, ebuf, sizeof TD) == 0);
+}
+
+static void xcode_fid_flat_test(void)
+{
+	struct m0_fid        fids[] = {
+		M0_FID_INIT(1, 2),
+		M0_FID_INIT(3, 4),
+		M0_FID_INIT(5, 6)
+	};
+	struct m0_fid_arr    arr = {
+		.af_count = ARRAY_SIZE(fids),
+		.af_elems = fids
+	};
+	struct m0_fid_arr   *out = NULL;
+	struct m0_xcode_obj  obj = M0_XCODE_OBJ(m0_fid_arr_xc, NULL);
+	void                *buf;
+	m0_bcount_t          len;
+	int                  result;
+
+	/* m0_fid_init() installs xto_read(), which keeps m0_fid flat. */
+	M0_UT_ASSERT(m0_fid_xc->xct_ops != NULL);
+	M0_UT_ASSERT(m0_xcode_type_is_flat(m0_fid_xc));
+	m0_xcode_type_flat_init(m0_fid_xc);
+	M0_UT_ASSERT(m0_xcode_type_is_flat(m0_fid_xc));
+
+	result = m0_xcode_obj_enc_to_buf(&M0_XCODE_OBJ(m0_fid_arr_xc, &arr),
+					 &buf, &len);
+	M0_UT_ASSERT(result == 0);
+	M0_UT_ASSERT(len == sizeof arr.af_count + sizeof fids);
+
+	result = m0_xcode_obj_dec_from_buf(&obj, buf, len);
+	M0_UT_ASSERT(result == 0);
+	out = obj.xo_ptr;
+	M0_UT_ASSERT(out != NULL && m0_fid_arr_eq(out, &arr));
+	m0_xcode_free_obj(&obj);
+	m0_free(buf);
 }
 
 static void xcode_cmp_test(void)
@@ -1284,7 +1427,10 @@ struct m0_ut_suite xcode_ut = {
 		{ "xcode-encode", xcode_encode_test },
 		{ "xcode-opaque", xcode_opaque_test },
 		{ "xcode-decode", xcode_decode_test },
+		{ "xcode-array",  xcode_array_test },
 		{ "xcode-nonstandard", xcode_nonstandard_test },
+		{ "xcode-flat",   xcode_flat_test },
+		{ "xcode-fid-flat", xcode_fid_flat_test },
 		{ "xcode-cmp",    xcode_cmp_test },
 		{ "xcode-read",   xcode_read_test },
 #ifndef __KERNEL__
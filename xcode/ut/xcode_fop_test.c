@@ -181,6 +181,8 @@ static void test_fop_encdec(void)
 	int                      j;
 	struct m0_fop           *f1;
 	struct m0_fop           *fd1;
+	struct m0_fop           *fd2;
+	struct m0_fop_test      *ftest;
 	struct m0_net_buffer    *nb;
 	struct m0_fop_test      *ccf1;
 	struct m0_xcode_ctx      xctx;
@@ -301,6 +303,27 @@ static void test_fop_encdec(void)
 	/* Verify the fop data. */
 	fop_verify(fd1);
 
+	/* Decode the payload again, into the arena of the fop. */
+	m0_fop_test_fopt.ft_flags = M0_FOP_TYPE_FLAG_DECODE_ARENA;
+	M0_ALLOC_PTR(fd2);
+	M0_UT_ASSERT(fd2 != NULL);
+	m0_fop_init(fd2, &m0_fop_test_fopt, NULL, m0_fop_release);
+	m0_bufvec_cursor_init(&cur, &nb->nb_buffer);
+	rc = m0_fop_encdec(fd2, &cur, M0_XCODE_DECODE);
+	M0_UT_ASSERT(rc == 0);
+	fop_verify(fd2);
+	ftest = m0_fop_data(fd2);
+	M0_UT_ASSERT(fd2->f_arena != NULL);
+	M0_UT_ASSERT(m0_fop_arena_owns(fd2, ftest));
+	M0_UT_ASSERT(m0_fop_arena_owns(fd2, ftest->ft_arr.fta_data[1].
+				       da_pair[1].p_buf.tb_buf));
+	M0_UT_ASSERT(!m0_fop_arena_owns(fd1, m0_fop_data(fd1)));
+	M0_UT_ASSERT(!m0_fop_arena_owns(fd2, m0_fop_data(fd1)));
+	m0_fop_fini(fd2);
+	M0_UT_ASSERT(fd2->f_arena == NULL);
+	m0_free(fd2);
+	m0_fop_test_fopt.ft_flags = 0;
+
 	/* Clean up and free all the allocated memory. */
 	m0_bufvec_free(&nb->nb_buffer);
 	m0_free(nb);
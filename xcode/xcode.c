@@ -224,6 +224,59 @@ M0_INTERNAL bool m0_xcode_is_byte_array(const struct m0_xcode_type *xt)
 		xt->xct_child[1].xf_type == &M0_XT_U8;
 }
 
+/**
+ * True iff the type has custom encoding, decoding or sizing functions.
+ * m0_xcode_type_ops::xto_read() does not change the serialised layout.
+ */
+static bool xcode_type_has_coding_ops(const struct m0_xcode_type *xt)
+{
+	const struct m0_xcode_type_ops *ops = xt->xct_ops;
+
+	return ops != NULL && (ops->xto_length != NULL ||
+			       ops->xto_encode != NULL ||
+			       ops->xto_decode != NULL);
+}
+
+M0_INTERNAL bool m0_xcode_type_is_flat(const struct m0_xcode_type *xt)
+{
+	return !xcode_type_has_coding_ops(xt) &&
+		(xt->xct_aggr == M0_XA_ATOM ||
+		 (xt->xct_flags & M0_XCODE_TYPE_FLAG_FLAT) != 0);
+}
+
+M0_INTERNAL void m0_xcode_type_flat_init(struct m0_xcode_type *xt)
+{
+	const struct m0_xcode_field *f;
+	size_t                       offset = 0;
+	bool                         flat;
+	int                          i;
+
+	switch (xt->xct_aggr) {
+	case M0_XA_RECORD:
+	case M0_XA_TYPEDEF:
+		for (i = 0, flat = true; flat && i < xt->xct_nr; ++i) {
+			f = &xt->xct_child[i];
+			flat = f->xf_offset == offset &&
+				m0_xcode_type_is_flat(f->xf_type);
+			offset += f->xf_type->xct_sizeof;
+		}
+		flat = flat && offset == xt->xct_sizeof;
+		break;
+	case M0_XA_ARRAY:
+		f = &xt->xct_child[0];
+		flat = m0_xcode_type_is_flat(f->xf_type) &&
+			f->xf_tag * f->xf_type->xct_sizeof == xt->xct_sizeof;
+		break;
+	default:
+		flat = false;
+		break;
+	}
+	if (flat && !xcode_type_has_coding_ops(xt))
+		xt->xct_flags |= M0_XCODE_TYPE_FLAG_FLAT;
+	else
+		xt->xct_flags &= ~M0_XCODE_TYPE_FLAG_FLAT;
+}
+
 M0_INTERNAL ssize_t
 m0_xcode_alloc_obj(struct m0_xcode_cursor *it,
 		   void *(*alloc)(struct m0_xcode_cursor *, size_t))
@@ -254,6 +307,29 @@ M0_INTERNAL void m0_xcode_free_obj(struct m0_xcode_obj *obj)
 	m0_xcode_free(&ctx);
 }
 
+/**
+   Does the buffer vector at the cursor point to nob bytes at addr?
+
+   @see m0_xcode_ctx::xcx_array
+ */
+static bool xcode_is_in_place(const struct m0_bufvec_cursor *dst,
+			      const void *addr, m0_bcount_t nob)
+{
+	struct m0_bufvec_cursor cur = *dst;
+	m0_bcount_t             step;
+
+	while (nob > 0) {
+		if (m0_bufvec_cursor_move(&cur, 0) ||
+		    m0_bufvec_cursor_addr(&cur) != addr)
+			return false;
+		step = min64u(m0_bufvec_cursor_step(&cur), nob);
+		addr += step;
+		nob  -= step;
+		m0_bufvec_cursor_move(&cur, step);
+	}
+	return true;
+}
+
 /**
    Common xcoding function, implementing encoding, decoding and sizing.
  */
@@ -316,19 +392,30 @@ static int ctx_walk(struct m0_xcode_ctx *ctx, enum xcode_op op)
 				M0_IMPOSSIBLE("op");
 			}
 			m0_xcode_skip(it);
-		} else if (xt->xct_aggr == M0_XA_ATOM) {
+		} else if (xt->xct_aggr == M0_XA_ATOM ||
+			   (ctx->xcx_iter == NULL &&
+			    m0_xcode_type_is_flat(xt))) {
 			struct m0_xcode_cursor_frame *prev = top - 1;
 			struct m0_xcode_obj          *par  = &prev->s_obj;
-			bool array = at_array(it, prev, par) &&
-				m0_xcode_is_byte_array(par->xo_type);
+			bool at    = at_array(it, prev, par);
+			bool bytes = at && m0_xcode_is_byte_array(par->xo_type);
+			/* Copy an array of flat objects in one go. */
+			bool array = bytes || (at && ctx->xcx_iter == NULL);
 
 			size = xt->xct_sizeof;
 			if (array)
 				size *= m0_xcode_tag(par);
 
-			if (op == XO_LEN)
+			if (op == XO_LEN) {
+				if (bytes && ctx->xcx_array != NULL &&
+				    size >= ctx->xcx_array_min)
+					result = ctx->xcx_array(ctx, length,
+								ptr, size);
 				length += size;
-			else {
+			} else if (op == XO_ENC && bytes &&
+				   xcode_is_in_place(&ctx->xcx_buf, ptr, size)) {
+				m0_bufvec_cursor_move(&ctx->xcx_buf, size);
+			} else {
 				struct m0_bufvec_cursor *src;
 				struct m0_bufvec_cursor *dst;
 
@@ -355,7 +442,8 @@ static int ctx_walk(struct m0_xcode_ctx *ctx, enum xcode_op op)
 			if (array) {
 				it->xcu_depth--;
 				m0_xcode_skip(it);
-			}
+			} else if (xt->xct_aggr != M0_XA_ATOM)
+				m0_xcode_skip(it);
 		}
 		if (result < 0)
 			break;
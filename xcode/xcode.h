@@ -305,6 +305,11 @@ enum m0_xcode_type_flags {
 	M0_XCODE_TYPE_FLAG_DOM_RPC    = 1 << 1,
 	/** Type belongs to CONF xcode domain, @see M0_XCA_DOMAIN */
 	M0_XCODE_TYPE_FLAG_DOM_CONF   = 1 << 2,
+	/**
+	 * In-memory representation of the type is the same as serialised,
+	 * @see m0_xcode_type_flat_init()
+	 */
+	M0_XCODE_TYPE_FLAG_FLAT       = 1 << 3,
 };
 M0_BASSERT(sizeof(enum m0_xcode_type_flags) <= sizeof(uint32_t));
 
@@ -611,6 +616,19 @@ struct m0_xcode_ctx {
 	   processing of given xcode context and xcode object embeded into it.
 	 */
 	void                  (*xcx_iter_end)(const struct m0_xcode_cursor *it);
+	/**
+	   If not NULL, this function is called by m0_xcode_length() for every
+	   byte array at least xcx_array_min bytes long, with the offset of the
+	   array in the serialised representation of the object.
+
+	   This is used to send byte arrays by reference: encoding does not copy
+	   a byte array if the buffer vector already points to the array at the
+	   cursor position, it just moves the cursor past it.
+	 */
+	int                    (*xcx_array)(struct m0_xcode_ctx *ctx,
+					    m0_bcount_t offset,
+					    void *addr, m0_bcount_t nob);
+	m0_bcount_t              xcx_array_min;
 };
 
 /**
@@ -677,6 +695,25 @@ M0_INTERNAL void *m0_xcode_alloc(struct m0_xcode_cursor *it, size_t nob);
  */
 M0_INTERNAL bool m0_xcode_is_byte_array(const struct m0_xcode_type *xt);
 
+/**
+   Sets M0_XCODE_TYPE_FLAG_FLAT if xt is a record, typedef or array without
+   custom encoding, decoding or sizing operations, all fields of which are flat
+   and packed without holes. m0_xcode_type_ops::xto_read() alone, as installed
+   by m0_fid_init(), keeps the type flat.
+
+   Encoding, decoding and sizing copy flat objects and arrays of flat
+   objects as a whole instead of traversing their fields, unless
+   m0_xcode_ctx::xcx_iter is set.
+
+   Types of the fields should be initialised before. Generated xcode
+   descriptors call this at the end of their initialisation. The call should
+   be repeated if custom coding operations of xt or of its field types change.
+ */
+M0_INTERNAL void m0_xcode_type_flat_init(struct m0_xcode_type *xt);
+
+/** True iff xt is an atom or has M0_XCODE_TYPE_FLAG_FLAT set. */
+M0_INTERNAL bool m0_xcode_type_is_flat(const struct m0_xcode_type *xt);
+
 /**
    Handles memory allocation during decoding.
 